@@ -60,6 +60,7 @@ GalileoE1Pvt::GalileoE1Pvt(ConfigurationInterface* configuration,
     // moving average depth parameters
     int averaging_depth = configuration->property(role + ".averaging_depth", 10);
     bool flag_averaging = configuration->property(role + ".flag_averaging", false);
+    bool flag_kalman = configuration->property(role + ".flag_kalman", false);
 
     // output rate
     int output_rate_ms = configuration->property(role + ".output_rate_ms", 500);
@@ -94,6 +95,7 @@ GalileoE1Pvt::GalileoE1Pvt(ConfigurationInterface* configuration,
             dump_filename_,
             averaging_depth,
             flag_averaging,
+            flag_kalman,
             output_rate_ms,
             display_rate_ms,
             flag_nmea_tty_port,
@@ -107,6 +109,10 @@ GalileoE1Pvt::GalileoE1Pvt(ConfigurationInterface* configuration,
             rtcm_dump_devname);
 
     DLOG(INFO) << "pvt(" << pvt_->unique_id() << ")";
+
+    // binary log of the solutions and observables, see pvt_log.h
+    std::string pvt_log_filename = configuration->property(role + ".pvt_log_filename", std::string(""));
+    pvt_->set_pvt_log(pvt_log_filename);
 }
 
 
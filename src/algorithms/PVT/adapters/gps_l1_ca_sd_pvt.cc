@@ -40,13 +40,15 @@
 #include <boost/serialization/map.hpp>
 #include <glog/logging.h>
 #include "configuration_interface.h"
+#include "rtcm_client.h"
 
 using google::LogMessage;
 
 GpsL1CaSdPvt::GpsL1CaSdPvt(ConfigurationInterface* configuration,
         std::string role,
         unsigned int in_streams,
-        unsigned int out_streams) :
+        unsigned int out_streams,
+        std::shared_ptr<Spoofing_Detector> spoofing_detector) :
                 role_(role),
                 in_streams_(in_streams),
                 out_streams_(out_streams)
@@ -62,6 +64,7 @@ GpsL1CaSdPvt::GpsL1CaSdPvt(ConfigurationInterface* configuration,
     // moving average depth parameters
     int averaging_depth = configuration->property(role + ".averaging_depth", 10);
     bool flag_averaging = configuration->property(role + ".flag_averaging", false);
+    bool flag_kalman = configuration->property(role + ".flag_kalman", false);
 
     // output rate
     int output_rate_ms = configuration->property(role + ".output_rate_ms", 500);
@@ -105,7 +108,12 @@ GpsL1CaSdPvt::GpsL1CaSdPvt(ConfigurationInterface* configuration,
     //std::string ref_time_xml_filename = configuration_->property("GNSS-SDR.SUPL_gps_ref_time_xml", ref_time_default_xml_filename);
     //std::string ref_location_xml_filename = configuration_->property("GNSS-SDR.SUPL_gps_ref_location_xml", ref_location_default_xml_filename);
 
-    Spoofing_Detector *spoofing_detector = new Spoofing_Detector(configuration);
+    //Spoofing detection: the detector is shared with the telemetry decoders. It is
+    //normally owned by the flowgraph, blocks created on their own get a private one.
+    if (!spoofing_detector)
+        {
+            spoofing_detector = std::make_shared<Spoofing_Detector>(configuration);
+        }
 
     // make PVT object
     pvt_ = gps_l1_ca_make_sd_pvt_cc(in_streams_,
@@ -113,6 +121,7 @@ GpsL1CaSdPvt::GpsL1CaSdPvt(ConfigurationInterface* configuration,
             dump_filename_,
             averaging_depth,
             flag_averaging,
+            flag_kalman,
             output_rate_ms,
             display_rate_ms,
             flag_nmea_tty_port,
@@ -124,9 +133,49 @@ GpsL1CaSdPvt::GpsL1CaSdPvt(ConfigurationInterface* configuration,
             rtcm_station_id,
             rtcm_msg_rate_ms,
             rtcm_dump_devname,
-            *spoofing_detector);
+            spoofing_detector);
 
     DLOG(INFO) << "pvt(" << pvt_->unique_id() << ")";
+
+    // binary log of the solutions and observables, see pvt_log.h
+    std::string pvt_log_filename = configuration->property(role + ".pvt_log_filename", std::string(""));
+    pvt_->set_pvt_log(pvt_log_filename);
+
+    // live telemetry of the solutions, channels and alarms, see pvt_telemetry.h
+    std::string telemetry_address = configuration->property(role + ".telemetry_address", std::string(""));
+    unsigned short telemetry_port = configuration->property(role + ".telemetry_port", 2110);
+    unsigned int telemetry_decimation = configuration->property(role + ".telemetry_decimation", 1);
+    int telemetry_multicast_ttl = configuration->property(role + ".telemetry_multicast_ttl", 1);
+    pvt_->set_telemetry(telemetry_address, telemetry_port, telemetry_decimation, telemetry_multicast_ttl);
+
+    // KML and GeoJSON tracks, valid whenever they are read, see track_file_writer.h
+    unsigned int track_decimation = configuration->property(role + ".track_decimation", 1);
+    double track_flush_period_s = configuration->property(role + ".track_flush_period_s", 1.0);
+    double track_rotate_period_h = configuration->property(role + ".track_rotate_period_h", 0.0);
+    pvt_->set_track_files(track_decimation, track_flush_period_s, 3600.0 * track_rotate_period_h);
+
+    // ionospheric correction of the pseudoranges with the broadcast model
+    pvt_->set_iono_correction(configuration->property(role + ".iono_correction", false));
+
+    // differential corrections from the RTCM stream of a reference station
+    std::string rtcm_input_address = configuration->property(role + ".rtcm_input_address", std::string(""));
+    if (!rtcm_input_address.empty())
+        {
+            unsigned short rtcm_input_port = configuration->property(role + ".rtcm_input_port", 2101);
+            std::string rtcm_input_mountpoint = configuration->property(role + ".rtcm_input_mountpoint", std::string(""));
+            std::string rtcm_input_user = configuration->property(role + ".rtcm_input_user", std::string(""));
+            std::string rtcm_input_password = configuration->property(role + ".rtcm_input_password", std::string(""));
+            std::shared_ptr<Rtcm_Client> rtcm_input = std::make_shared<Rtcm_Client>(rtcm_input_address, rtcm_input_port,
+                    rtcm_input_mountpoint, rtcm_input_user, rtcm_input_password);
+            rtcm_input->open();
+            pvt_->set_rtcm_input(rtcm_input, configuration->property(role + ".rtcm_input_max_age_s", 10.0));
+        }
+
+    // solutions in between the output epochs for the spoofing checks, see Observables.low_latency
+    pvt_->set_low_latency_rate(configuration->property(role + ".low_latency_rate_ms", 0));
+
+    // epochs queued for the output thread of the block
+    pvt_->set_output_queue(configuration->property(role + ".output_queue_epochs", 64));
 }
 
 
@@ -39,6 +39,7 @@
 #ifndef GNSS_SDR_GPS_L1_CA_SD_PVT_H_
 #define GNSS_SDR_GPS_L1_CA_SD_PVT_H_
 
+#include <memory>
 #include <string>
 #include "pvt_interface.h"
 #include "gps_l1_ca_sd_pvt_cc.h"
@@ -55,7 +56,8 @@ public:
     GpsL1CaSdPvt(ConfigurationInterface* configuration,
             std::string role,
             unsigned int in_streams,
-            unsigned int out_streams);
+            unsigned int out_streams,
+            std::shared_ptr<Spoofing_Detector> spoofing_detector = nullptr);
 
     virtual ~GpsL1CaSdPvt();
 
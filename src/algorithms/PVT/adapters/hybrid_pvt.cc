@@ -38,6 +38,7 @@
 #include <boost/math/common_factor_rt.hpp>
 #include <boost/serialization/map.hpp>
 #include "configuration_interface.h"
+#include "rtcm_client.h"
 
 
 using google::LogMessage;
@@ -62,6 +63,7 @@ HybridPvt::HybridPvt(ConfigurationInterface* configuration,
     // moving average depth parameters
     int averaging_depth = configuration->property(role + ".averaging_depth", 10);
     bool flag_averaging = configuration->property(role + ".flag_averaging", false);
+    bool flag_kalman = configuration->property(role + ".flag_kalman", false);
 
     // output rate
     int output_rate_ms = configuration->property(role + ".output_rate_ms", 500);
@@ -111,8 +113,26 @@ HybridPvt::HybridPvt(ConfigurationInterface* configuration,
     //std::string ref_location_xml_filename = configuration_->property("GNSS-SDR.SUPL_gps_ref_location_xml", ref_location_default_xml_filename);    
     
     // make PVT object
-    pvt_ = hybrid_make_pvt_cc(in_streams_, dump_, dump_filename_, averaging_depth, flag_averaging, output_rate_ms, display_rate_ms, flag_nmea_tty_port, nmea_dump_filename, nmea_dump_devname, flag_rtcm_server, flag_rtcm_tty_port, rtcm_tcp_port, rtcm_station_id, rtcm_msg_rate_ms, rtcm_dump_devname);
+    pvt_ = hybrid_make_pvt_cc(in_streams_, dump_, dump_filename_, averaging_depth, flag_averaging, flag_kalman, output_rate_ms, display_rate_ms, flag_nmea_tty_port, nmea_dump_filename, nmea_dump_devname, flag_rtcm_server, flag_rtcm_tty_port, rtcm_tcp_port, rtcm_station_id, rtcm_msg_rate_ms, rtcm_dump_devname);
     DLOG(INFO) << "pvt(" << pvt_->unique_id() << ")";
+
+    // binary log of the solutions and observables, see pvt_log.h
+    std::string pvt_log_filename = configuration->property(role + ".pvt_log_filename", std::string(""));
+    pvt_->set_pvt_log(pvt_log_filename);
+
+    // differential corrections from the RTCM stream of a reference station
+    std::string rtcm_input_address = configuration->property(role + ".rtcm_input_address", std::string(""));
+    if (!rtcm_input_address.empty())
+        {
+            unsigned short rtcm_input_port = configuration->property(role + ".rtcm_input_port", 2101);
+            std::string rtcm_input_mountpoint = configuration->property(role + ".rtcm_input_mountpoint", std::string(""));
+            std::string rtcm_input_user = configuration->property(role + ".rtcm_input_user", std::string(""));
+            std::string rtcm_input_password = configuration->property(role + ".rtcm_input_password", std::string(""));
+            std::shared_ptr<Rtcm_Client> rtcm_input = std::make_shared<Rtcm_Client>(rtcm_input_address, rtcm_input_port,
+                    rtcm_input_mountpoint, rtcm_input_user, rtcm_input_password);
+            rtcm_input->open();
+            pvt_->set_rtcm_input(rtcm_input, configuration->property(role + ".rtcm_input_max_age_s", 10.0));
+        }
 }
 
 
@@ -41,14 +41,25 @@
 
 using google::LogMessage;
 
+namespace
+{
+Dump_Schema pvt_raw_dump_schema(unsigned int nchannels)
+{
+    Dump_Schema schema("galileo_e1_pvt_raw");
+    schema.add<double>("Pseudorange_m", nchannels)
+          .add<double>("rx_time_s");
+    return schema;
+}
+}
+
 
 galileo_e1_pvt_cc_sptr galileo_e1_make_pvt_cc(unsigned int nchannels, bool dump, std::string dump_filename, int averaging_depth,
-        bool flag_averaging, int output_rate_ms, int display_rate_ms, bool flag_nmea_tty_port, std::string nmea_dump_filename,
+        bool flag_averaging, bool flag_kalman, int output_rate_ms, int display_rate_ms, bool flag_nmea_tty_port, std::string nmea_dump_filename,
         std::string nmea_dump_devname, bool flag_rtcm_server, bool flag_rtcm_tty_port, unsigned short rtcm_tcp_port,
         unsigned short rtcm_station_id, std::map<int,int> rtcm_msg_rate_ms, std::string rtcm_dump_devname)
 {
     return galileo_e1_pvt_cc_sptr(new galileo_e1_pvt_cc(nchannels, dump, dump_filename, averaging_depth,
-            flag_averaging, output_rate_ms, display_rate_ms, flag_nmea_tty_port, nmea_dump_filename, nmea_dump_devname,
+            flag_averaging, flag_kalman, output_rate_ms, display_rate_ms, flag_nmea_tty_port, nmea_dump_filename, nmea_dump_devname,
             flag_rtcm_server, flag_rtcm_tty_port, rtcm_tcp_port, rtcm_station_id, rtcm_msg_rate_ms, rtcm_dump_devname));
 }
 
@@ -107,7 +118,7 @@ void galileo_e1_pvt_cc::msg_handler_telemetry(pmt::pmt_t msg)
 
 
 galileo_e1_pvt_cc::galileo_e1_pvt_cc(unsigned int nchannels, bool dump, std::string dump_filename, int averaging_depth,
-        bool flag_averaging, int output_rate_ms, int display_rate_ms, bool flag_nmea_tty_port, std::string nmea_dump_filename, std::string nmea_dump_devname,
+        bool flag_averaging, bool flag_kalman, int output_rate_ms, int display_rate_ms, bool flag_nmea_tty_port, std::string nmea_dump_filename, std::string nmea_dump_devname,
         bool flag_rtcm_server, bool flag_rtcm_tty_port, unsigned short rtcm_tcp_port,
         unsigned short rtcm_station_id, std::map<int,int> rtcm_msg_rate_ms, std::string rtcm_dump_devname) :
     gr::block("galileo_e1_pvt_cc", gr::io_signature::make(nchannels, nchannels,  sizeof(Gnss_Synchro)), gr::io_signature::make(0, 0, sizeof(gr_complex)))
@@ -169,6 +180,7 @@ galileo_e1_pvt_cc::galileo_e1_pvt_cc(unsigned int nchannels, bool dump, std::str
 
     d_ls_pvt = std::make_shared<galileo_e1_ls_pvt>(nchannels, dump_ls_pvt_filename, d_dump);
     d_ls_pvt->set_averaging_depth(d_averaging_depth);
+    d_ls_pvt->set_kalman_filter(flag_kalman);
 
     d_sample_counter = 0;
     d_last_sample_nav_output = 0;
@@ -186,16 +198,14 @@ galileo_e1_pvt_cc::galileo_e1_pvt_cc(unsigned int nchannels, bool dump, std::str
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit );
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    if (d_dump_file.open(d_dump_filename, pvt_raw_dump_schema(d_nchannels)))
+                        {
                             LOG(INFO) << "PVT dump enabled Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (const std::ifstream::failure& e)
-                    {
-                            LOG(WARNING) << "Exception opening PVT dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "Cannot open PVT dump file " << d_dump_filename;
+                        }
                 }
         }
 }
@@ -206,6 +216,20 @@ galileo_e1_pvt_cc::~galileo_e1_pvt_cc()
 {}
 
 
+void galileo_e1_pvt_cc::set_pvt_log(const std::string & filename)
+{
+    d_pvt_log.reset();
+    if (!filename.empty())
+        {
+            d_pvt_log = std::make_shared<Pvt_Log_Writer>();
+            if (!d_pvt_log->open(filename))
+                {
+                    d_pvt_log.reset();
+                }
+        }
+}
+
+
 
 bool galileo_e1_pvt_cc::pseudoranges_pairCompare_min(const std::pair<int,Gnss_Synchro>& a, const std::pair<int,Gnss_Synchro>& b)
 {
@@ -230,10 +254,9 @@ void galileo_e1_pvt_cc::print_receiver_status(Gnss_Synchro** channels_synchroniz
 int galileo_e1_pvt_cc::general_work (int noutput_items __attribute__((unused)), gr_vector_int &ninput_items __attribute__((unused)),
         gr_vector_const_void_star &input_items, gr_vector_void_star &output_items  __attribute__((unused)))
 {
+    gnss_pseudoranges_map.clear();
     d_sample_counter++;
 
-    std::map<int,Gnss_Synchro> gnss_pseudoranges_map;
-
     Gnss_Synchro **in = (Gnss_Synchro **)  &input_items[0]; //Get the input pointer
 
     print_receiver_status(in);
@@ -270,6 +293,11 @@ int galileo_e1_pvt_cc::general_work (int noutput_items __attribute__((unused)),
                             d_kml_dump->print_position(d_ls_pvt, d_flag_averaging);
                             d_geojson_printer->print_position(d_ls_pvt, d_flag_averaging);
                             d_nmea_printer->Print_Nmea_Line(d_ls_pvt, d_flag_averaging);
+                            if (d_pvt_log)
+                                {
+                                    d_pvt_log->write_solution(*d_ls_pvt, d_rx_time);
+                                    d_pvt_log->write_observables(gnss_pseudoranges_map, d_rx_time);
+                                }
 
                             if (!b_rinex_header_writen)
                                 {
@@ -362,22 +390,11 @@ int galileo_e1_pvt_cc::general_work (int noutput_items __attribute__((unused)),
             // MULTIPLEXED FILE RECORDING - Record results to file
             if(d_dump == true)
                 {
-                    try
-                    {
-                            double tmp_double;
-                            for (unsigned int i = 0; i < d_nchannels; i++)
-                                {
-                                    tmp_double = in[i][0].Pseudorange_m;
-                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                                    tmp_double = 0;
-                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                                    d_dump_file.write((char*)&d_rx_time, sizeof(double));
-                                }
-                    }
-                    catch (const std::ifstream::failure& e)
-                    {
-                            LOG(WARNING) << "Exception writing observables dump file " << e.what();
-                    }
+                    for (unsigned int i = 0; i < d_nchannels; i++)
+                        {
+                            d_dump_file.put<double>(in[i][0].Pseudorange_m);
+                        }
+                    d_dump_file.put<double>(d_rx_time);
                 }
         }
 
@@ -39,8 +39,10 @@
 #include "kml_printer.h"
 #include "rinex_printer.h"
 #include "geojson_printer.h"
+#include "pvt_log.h"
 #include "rtcm_printer.h"
 #include "galileo_e1_ls_pvt.h"
+#include "dump_writer.h"
 
 
 class galileo_e1_pvt_cc;
@@ -52,6 +54,7 @@ galileo_e1_pvt_cc_sptr galileo_e1_make_pvt_cc(unsigned int n_channels,
                                               std::string dump_filename,
                                               int averaging_depth,
                                               bool flag_averaging,
+                                              bool flag_kalman,
                                               int output_rate_ms,
                                               int display_rate_ms,
                                               bool flag_nmea_tty_port,
@@ -75,6 +78,7 @@ private:
                                                          std::string dump_filename,
                                                          int averaging_depth,
                                                          bool flag_averaging,
+                                                         bool flag_kalman,
                                                          int output_rate_ms,
                                                          int display_rate_ms,
                                                          bool flag_nmea_tty_port,
@@ -90,6 +94,7 @@ private:
                       bool dump, std::string dump_filename,
                       int averaging_depth,
                       bool flag_averaging,
+                      bool flag_kalman,
                       int output_rate_ms,
                       int display_rate_ms,
                       bool flag_nmea_tty_port,
@@ -114,7 +119,7 @@ private:
 
     unsigned int d_nchannels;
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
     int d_averaging_depth;
     bool d_flag_averaging;
     int d_output_rate_ms;
@@ -128,13 +133,23 @@ private:
     std::shared_ptr<Kml_Printer> d_kml_dump;
     std::shared_ptr<Nmea_Printer> d_nmea_printer;
     std::shared_ptr<GeoJSON_Printer> d_geojson_printer;
+    std::shared_ptr<Pvt_Log_Writer> d_pvt_log;
     std::shared_ptr<Rtcm_Printer> d_rtcm_printer;
 
     double d_rx_time;
     std::shared_ptr<galileo_e1_ls_pvt> d_ls_pvt;
+
+    std::map<int,Gnss_Synchro> gnss_pseudoranges_map;
+
     bool pseudoranges_pairCompare_min(const std::pair<int,Gnss_Synchro>& a, const std::pair<int,Gnss_Synchro>& b);
 
 public:
+    /*!
+     * \brief Starts the binary log of the solutions and observables (see pvt_log.h).
+     * An empty file name disables it.
+     */
+    void set_pvt_log(const std::string & filename);
+
     ~galileo_e1_pvt_cc (); //!< Default destructor
 
     int general_work (int noutput_items, gr_vector_int &ninput_items,
@@ -29,6 +29,7 @@
 
 #include "gps_l1_ca_pvt_cc.h"
 #include <algorithm>
+#include <ctime>
 #include <iostream>
 #include <map>
 #include <utility>
@@ -38,16 +39,32 @@
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
 #include "concurrent_map.h"
+#include "gps_ref_location.h"
+#include "gps_ref_time.h"
 #include "sbas_telemetry_data.h"
 #include "sbas_ionospheric_correction.h"
+#include "latency_trace.h"
 
 using google::LogMessage;
 
+namespace
+{
+Dump_Schema pvt_raw_dump_schema(unsigned int nchannels)
+{
+    Dump_Schema schema("gps_l1_ca_pvt_raw");
+    schema.add<double>("Pseudorange_m", nchannels)
+          .add<double>("rx_time_s");
+    return schema;
+}
+}
+
+
 gps_l1_ca_pvt_cc_sptr
 gps_l1_ca_make_pvt_cc(unsigned int nchannels,
         bool dump, std::string dump_filename,
         int averaging_depth,
         bool flag_averaging,
+        bool flag_kalman,
         int output_rate_ms,
         int display_rate_ms,
         bool flag_nmea_tty_port,
@@ -65,6 +82,7 @@ gps_l1_ca_make_pvt_cc(unsigned int nchannels,
             dump_filename,
             averaging_depth,
             flag_averaging,
+            flag_kalman,
             output_rate_ms,
             display_rate_ms,
             flag_nmea_tty_port,
@@ -82,14 +100,14 @@ gps_l1_ca_make_pvt_cc(unsigned int nchannels,
 void gps_l1_ca_pvt_cc::msg_handler_telemetry(pmt::pmt_t msg)
 {
     try {
-            if( pmt::any_ref(msg).type() == typeid(std::shared_ptr<Gps_Ephemeris>) )
+            if( pmt::any_ref(msg).type() == typeid(std::shared_ptr<const Gps_Ephemeris>) )
                 {
                     // ### GPS EPHEMERIS ###
-                    std::shared_ptr<Gps_Ephemeris> gps_eph;
-                    gps_eph = boost::any_cast<std::shared_ptr<Gps_Ephemeris>>(pmt::any_ref(msg));
+                    std::shared_ptr<const Gps_Ephemeris> gps_eph;
+                    gps_eph = boost::any_cast<std::shared_ptr<const Gps_Ephemeris>>(pmt::any_ref(msg));
                     DLOG(INFO) << "Ephemeris record has arrived from SAT ID "
                             << gps_eph->i_satellite_PRN << " (Block "
-                            <<  gps_eph->satelliteBlock[gps_eph->i_satellite_PRN] << ")"
+                            <<  gps_eph->satelliteBlock.at(gps_eph->i_satellite_PRN) << ")"
                             << "inserted with Toe="<< gps_eph->d_Toe<<" and GPS Week="
                             << gps_eph->i_GPS_week;
                     // update/insert new ephemeris record to the global ephemeris map
@@ -183,6 +201,7 @@ gps_l1_ca_pvt_cc::gps_l1_ca_pvt_cc(unsigned int nchannels,
         bool dump, std::string dump_filename,
         int averaging_depth,
         bool flag_averaging,
+        bool flag_kalman,
         int output_rate_ms,
         int display_rate_ms,
         bool flag_nmea_tty_port,
@@ -201,6 +220,7 @@ gps_l1_ca_pvt_cc::gps_l1_ca_pvt_cc(unsigned int nchannels,
     d_display_rate_ms = display_rate_ms;
     d_dump = dump;
     d_nchannels = nchannels;
+    d_metrics = make_block_metrics("pvt", "gps_l1_ca");
     d_dump_filename = dump_filename;
     std::string dump_ls_pvt_filename = dump_filename;
 
@@ -253,8 +273,10 @@ gps_l1_ca_pvt_cc::gps_l1_ca_pvt_cc(unsigned int nchannels,
     d_averaging_depth = averaging_depth;
     d_flag_averaging = flag_averaging;
 
+    d_receiver_state = Receiver_State::current();
     d_ls_pvt = std::make_shared<gps_l1_ca_ls_pvt>((int)nchannels, dump_ls_pvt_filename, d_dump);
     d_ls_pvt->set_averaging_depth(d_averaging_depth);
+    d_ls_pvt->set_kalman_filter(flag_kalman);
 
     d_sample_counter = 0;
     d_last_sample_nav_output = 0;
@@ -272,16 +294,14 @@ gps_l1_ca_pvt_cc::gps_l1_ca_pvt_cc(unsigned int nchannels,
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit );
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    if (d_dump_file.open(d_dump_filename, pvt_raw_dump_schema(d_nchannels)))
+                        {
                             LOG(INFO) << "PVT dump enabled Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (const std::ifstream::failure & e)
-                    {
-                            LOG(INFO) << "Exception opening PVT dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "Cannot open PVT dump file " << d_dump_filename;
+                        }
                 }
         }
 }
@@ -291,6 +311,32 @@ gps_l1_ca_pvt_cc::~gps_l1_ca_pvt_cc()
 {}
 
 
+void gps_l1_ca_pvt_cc::set_pvt_log(const std::string & filename)
+{
+    d_pvt_log.reset();
+    if (!filename.empty())
+        {
+            d_pvt_log = std::make_shared<Pvt_Log_Writer>();
+            if (!d_pvt_log->open(filename))
+                {
+                    d_pvt_log.reset();
+                }
+        }
+}
+
+
+void gps_l1_ca_pvt_cc::set_iono_correction(bool enabled)
+{
+    d_ls_pvt->set_iono_correction(enabled);
+}
+
+
+void gps_l1_ca_pvt_cc::set_rtcm_input(const std::shared_ptr<Rtcm_Client> & client, double max_age_s)
+{
+    d_ls_pvt->set_rtcm_input(client, max_age_s);
+}
+
+
 bool pseudoranges_pairCompare_min(const std::pair<int,Gnss_Synchro>& a, const std::pair<int,Gnss_Synchro>& b)
 {
     return (a.second.Pseudorange_m) < (b.second.Pseudorange_m);
@@ -311,9 +357,10 @@ void gps_l1_ca_pvt_cc::print_receiver_status(Gnss_Synchro** channels_synchroniza
 }
 
 
-int gps_l1_ca_pvt_cc::general_work (int noutput_items __attribute__((unused)), gr_vector_int &ninput_items __attribute__((unused)),
+int gps_l1_ca_pvt_cc::general_work (int noutput_items __attribute__((unused)), gr_vector_int &ninput_items,
         gr_vector_const_void_star &input_items, gr_vector_void_star &output_items __attribute__((unused)))
 {
+    Block_Metrics_Scope metrics_scope(d_metrics.get(), ninput_items.empty() ? 0 : ninput_items[0]);
     gnss_pseudoranges_map.clear();
     d_sample_counter++;
     Gnss_Synchro **in = (Gnss_Synchro **)  &input_items[0]; //Get the input pointer
@@ -349,9 +396,15 @@ int gps_l1_ca_pvt_cc::general_work (int noutput_items __attribute__((unused)), g
                     pvt_result = d_ls_pvt->get_PVT(gnss_pseudoranges_map, d_rx_time, d_flag_averaging);
                     if (pvt_result == true)
                         {
+                            LATENCY_TRACE(LATENCY_PVT, -1, gnss_pseudoranges_map.begin()->second.sample_counter);
                             d_kml_printer->print_position(d_ls_pvt, d_flag_averaging);
                             d_geojson_printer->print_position(d_ls_pvt, d_flag_averaging);
                             d_nmea_printer->Print_Nmea_Line(d_ls_pvt, d_flag_averaging);
+                            if (d_pvt_log)
+                                {
+                                    d_pvt_log->write_solution(*d_ls_pvt, d_rx_time);
+                                    d_pvt_log->write_observables(gnss_pseudoranges_map, d_rx_time);
+                                }
 
                             if (!b_rinex_header_writen)
                                 {
@@ -427,6 +480,22 @@ int gps_l1_ca_pvt_cc::general_work (int noutput_items __attribute__((unused)), g
             // DEBUG MESSAGE: Display position in console output
             if (((d_sample_counter % d_display_rate_ms) == 0) and d_ls_pvt->b_valid_position == true)
                 {
+                    // last fix, for the prediction of the satellites in view (ControlThread)
+                    Gps_Ref_Location fix;
+                    fix.valid = true;
+                    fix.lat = d_ls_pvt->d_latitude_d;
+                    fix.lon = d_ls_pvt->d_longitude_d;
+                    d_receiver_state->gps_ref_location_map.write(0, fix);
+                    if (!d_ls_pvt->gps_ephemeris_map.empty())
+                        {
+                            Gps_Ref_Time fix_time;
+                            fix_time.valid = true;
+                            fix_time.d_TOW = d_rx_time;
+                            fix_time.d_Week = d_ls_pvt->gps_ephemeris_map.begin()->second.i_GPS_week;
+                            fix_time.d_tv_sec = static_cast<double>(std::time(0));
+                            fix_time.d_tv_usec = 0.0;
+                            d_receiver_state->gps_ref_time_map.write(0, fix_time);
+                        }
 /*
                     std::cout << "Position at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
                               << " UTC is Lat = " << d_ls_pvt->d_latitude_d << " [deg], Long = " << d_ls_pvt->d_longitude_d
@@ -449,25 +518,15 @@ int gps_l1_ca_pvt_cc::general_work (int noutput_items __attribute__((unused)), g
             // MULTIPLEXED FILE RECORDING - Record results to file
             if(d_dump == true)
                 {
-                    try
-                    {
-                            double tmp_double;
-                            for (unsigned int i = 0; i < d_nchannels ; i++)
-                                {
-                                    tmp_double = in[i][0].Pseudorange_m;
-                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                                    tmp_double = 0;
-                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                                    d_dump_file.write((char*)&d_rx_time, sizeof(double));
-                                }
-                    }
-                    catch (const std::ifstream::failure & e)
-                    {
-                            LOG(WARNING) << "Exception writing observables dump file " << e.what();
-                    }
+                    for (unsigned int i = 0; i < d_nchannels; i++)
+                        {
+                            d_dump_file.put<double>(in[i][0].Pseudorange_m);
+                        }
+                    d_dump_file.put<double>(d_rx_time);
                 }
         }
 
+    metrics_scope.set_items(1);
     consume_each(1); //one by one
     return 1;
 }
@@ -31,14 +31,19 @@
 #define GNSS_SDR_GPS_L1_CA_PVT_CC_H
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <gnuradio/block.h>
 #include "nmea_printer.h"
 #include "kml_printer.h"
 #include "rinex_printer.h"
 #include "geojson_printer.h"
+#include "pvt_log.h"
 #include "rtcm_printer.h"
 #include "gps_l1_ca_ls_pvt.h"
+#include "receiver_state.h"
+#include "block_metrics.h"
+#include "dump_writer.h"
 
 class gps_l1_ca_pvt_cc;
 
@@ -49,6 +54,7 @@ gps_l1_ca_pvt_cc_sptr gps_l1_ca_make_pvt_cc(unsigned int n_channels,
                                             std::string dump_filename,
                                             int averaging_depth,
                                             bool flag_averaging,
+                                            bool flag_kalman,
                                             int output_rate_ms,
                                             int display_rate_ms,
                                             bool flag_nmea_tty_port,
@@ -73,6 +79,7 @@ private:
                                                        std::string dump_filename,
                                                        int averaging_depth,
                                                        bool flag_averaging,
+                                                       bool flag_kalman,
                                                        int output_rate_ms,
                                                        int display_rate_ms,
                                                        bool flag_nmea_tty_port,
@@ -89,6 +96,7 @@ private:
                      std::string dump_filename,
                      int averaging_depth,
                      bool flag_averaging,
+                     bool flag_kalman,
                      int output_rate_ms,
                      int display_rate_ms,
                      bool flag_nmea_tty_port,
@@ -118,7 +126,8 @@ private:
 
     unsigned int d_nchannels;
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
+    std::shared_ptr<Block_Metrics> d_metrics;
     int d_averaging_depth;
     bool d_flag_averaging;
     int d_output_rate_ms;
@@ -130,9 +139,11 @@ private:
     std::shared_ptr<Kml_Printer> d_kml_printer;
     std::shared_ptr<Nmea_Printer> d_nmea_printer;
     std::shared_ptr<GeoJSON_Printer> d_geojson_printer;
+    std::shared_ptr<Pvt_Log_Writer> d_pvt_log;
     std::shared_ptr<Rtcm_Printer> d_rtcm_printer;
     double d_rx_time;
     std::shared_ptr<gps_l1_ca_ls_pvt> d_ls_pvt;
+    std::shared_ptr<Receiver_State> d_receiver_state; // tables of the receiver, current at construction
 
     std::map<int,Gnss_Synchro> gnss_pseudoranges_map;
 
@@ -145,6 +156,23 @@ public:
      */
     std::map<int,Gps_Ephemeris> get_GPS_L1_ephemeris_map();
     
+    /*!
+     * \brief Starts the binary log of the solutions and observables (see pvt_log.h).
+     * An empty file name disables it.
+     */
+    void set_pvt_log(const std::string & filename);
+
+    /*!
+     * \brief Corrects the pseudoranges with the broadcast ionospheric model
+     */
+    void set_iono_correction(bool enabled);
+
+    /*!
+     * \brief Corrects the pseudoranges with the observations of the reference
+     * station that client receives, if they are at most max_age_s old
+     */
+    void set_rtcm_input(const std::shared_ptr<Rtcm_Client> & client, double max_age_s);
+
     ~gps_l1_ca_pvt_cc (); //!< Default destructor
 
     int general_work (int noutput_items, gr_vector_int &ninput_items,
@@ -32,38 +32,45 @@
 
 #include "gps_l1_ca_sd_pvt_cc.h"
 #include <algorithm>
+#include <ctime>
+#include <functional>
 #include <iostream>
 #include <map>
 #include <utility>
+#include <boost/bind.hpp>
 #include <boost/math/common_factor_rt.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <gnuradio/gr_complex.h>
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
 #include "concurrent_map.h"
+#include "gps_ref_location.h"
+#include "gps_ref_time.h"
 #include "sbas_telemetry_data.h"
 #include "sbas_ionospheric_correction.h"
 #include "spoofing_message.h"
+#include "latency_trace.h"
 
 using google::LogMessage;
 
-extern concurrent_queue<Spoofing_Message> global_spoofing_queue;
-extern concurrent_map<std::map<unsigned int, unsigned int>> global_subframe_check;
-extern concurrent_map<Subframe> global_subframe_map;
-
-struct GPS_time_t{
-    int week;
-    double TOW;
-    int subframe_id;
-};
+namespace
+{
+Dump_Schema pvt_raw_dump_schema(unsigned int nchannels)
+{
+    Dump_Schema schema("gps_l1_ca_sd_pvt_raw");
+    schema.add<double>("Pseudorange_m", nchannels)
+          .add<double>("rx_time_s");
+    return schema;
+}
+}
 
-extern concurrent_map<GPS_time_t> global_gps_time;
 
 gps_l1_ca_sd_pvt_cc_sptr
 gps_l1_ca_make_sd_pvt_cc(unsigned int nchannels,
         bool dump, std::string dump_filename,
         int averaging_depth,
         bool flag_averaging,
+        bool flag_kalman,
         int output_rate_ms,
         int display_rate_ms,
         bool flag_nmea_tty_port,
@@ -75,13 +82,14 @@ gps_l1_ca_make_sd_pvt_cc(unsigned int nchannels,
         unsigned short rtcm_station_id,
         std::map<int,int> rtcm_msg_rate_ms,
         std::string rtcm_dump_devname,
-        Spoofing_Detector spoofing_detector)
+        std::shared_ptr<Spoofing_Detector> spoofing_detector)
 {
     return gps_l1_ca_sd_pvt_cc_sptr(new gps_l1_ca_sd_pvt_cc(nchannels,
             dump,
             dump_filename,
             averaging_depth,
             flag_averaging,
+            flag_kalman,
             output_rate_ms,
             display_rate_ms,
             flag_nmea_tty_port,
@@ -100,14 +108,14 @@ gps_l1_ca_make_sd_pvt_cc(unsigned int nchannels,
 void gps_l1_ca_sd_pvt_cc::msg_handler_telemetry(pmt::pmt_t msg)
 {
     try {
-            if( pmt::any_ref(msg).type() == typeid(std::shared_ptr<Gps_Ephemeris>) )
+            if( pmt::any_ref(msg).type() == typeid(std::shared_ptr<const Gps_Ephemeris>) )
                 {
                     // ### GPS EPHEMERIS ###
-                    std::shared_ptr<Gps_Ephemeris> gps_eph;
-                    gps_eph = boost::any_cast<std::shared_ptr<Gps_Ephemeris>>(pmt::any_ref(msg));
+                    std::shared_ptr<const Gps_Ephemeris> gps_eph;
+                    gps_eph = boost::any_cast<std::shared_ptr<const Gps_Ephemeris>>(pmt::any_ref(msg));
                     DLOG(INFO) << "Ephemeris record has arrived from SAT ID "
                             << gps_eph->i_satellite_PRN << " (Block "
-                            <<  gps_eph->satelliteBlock[gps_eph->i_satellite_PRN] << ")"
+                            <<  gps_eph->satelliteBlock.at(gps_eph->i_satellite_PRN) << ")"
                             << "inserted with Toe="<< gps_eph->d_Toe<<" and GPS Week="
                             << gps_eph->i_GPS_week;
                     // update/insert new ephemeris record to the global ephemeris map
@@ -119,6 +127,7 @@ void gps_l1_ca_sd_pvt_cc::msg_handler_telemetry(pmt::pmt_t msg)
                         {
                             d_ls_pvt->gps_ephemeris_map[gps_eph->i_satellite_PRN] = *gps_eph;
                         }
+                    d_output_navigation.reset();
                 }
             else if (pmt::any_ref(msg).type() == typeid(std::shared_ptr<Gps_Iono>) )
                 {
@@ -126,6 +135,7 @@ void gps_l1_ca_sd_pvt_cc::msg_handler_telemetry(pmt::pmt_t msg)
                     std::shared_ptr<Gps_Iono> gps_iono;
                     gps_iono = boost::any_cast<std::shared_ptr<Gps_Iono>>(pmt::any_ref(msg));
                     d_ls_pvt->gps_iono = *gps_iono;
+                    d_output_navigation.reset();
                     DLOG(INFO) << "New IONO record has arrived ";
                 }
             else if (pmt::any_ref(msg).type() == typeid(std::shared_ptr<Gps_Utc_Model>) )
@@ -134,6 +144,7 @@ void gps_l1_ca_sd_pvt_cc::msg_handler_telemetry(pmt::pmt_t msg)
                     std::shared_ptr<Gps_Utc_Model> gps_utc_model;
                     gps_utc_model = boost::any_cast<std::shared_ptr<Gps_Utc_Model>>(pmt::any_ref(msg));
                     d_ls_pvt->gps_utc_model = *gps_utc_model;
+                    d_output_navigation.reset();
                     DLOG(INFO) << "New UTC record has arrived ";
                 }
             else if (pmt::any_ref(msg).type() == typeid(std::shared_ptr<Sbas_Ionosphere_Correction>) )
@@ -208,6 +219,7 @@ gps_l1_ca_sd_pvt_cc::gps_l1_ca_sd_pvt_cc(unsigned int nchannels,
         bool dump, std::string dump_filename,
         int averaging_depth,
         bool flag_averaging,
+        bool flag_kalman,
         int output_rate_ms,
         int display_rate_ms,
         bool flag_nmea_tty_port,
@@ -219,12 +231,13 @@ gps_l1_ca_sd_pvt_cc::gps_l1_ca_sd_pvt_cc(unsigned int nchannels,
         unsigned short rtcm_station_id,
         std::map<int,int> rtcm_msg_rate_ms,
         std::string rtcm_dump_devname,
-        Spoofing_Detector spoofing_detector) :
+        std::shared_ptr<Spoofing_Detector> spoofing_detector) :
              gr::block("gps_l1_ca_sd_pvt_cc", gr::io_signature::make(nchannels, nchannels,  sizeof(Gnss_Synchro)),
              gr::io_signature::make(0, 0, sizeof(gr_complex)) )
 {
     d_output_rate_ms = output_rate_ms;
     d_display_rate_ms = display_rate_ms;
+    d_low_latency_rate_ms = 0;
     d_dump = dump;
     d_nchannels = nchannels;
     d_dump_filename = dump_filename;
@@ -280,11 +293,14 @@ gps_l1_ca_sd_pvt_cc::gps_l1_ca_sd_pvt_cc(unsigned int nchannels,
     d_averaging_depth = averaging_depth;
     d_flag_averaging = flag_averaging;
 
+    d_receiver_state = Receiver_State::current();
     d_ls_pvt = std::make_shared<gps_l1_ca_ls_pvt>((int)nchannels, dump_ls_pvt_filename, d_dump);
     d_ls_pvt->set_averaging_depth(d_averaging_depth);
+    d_ls_pvt->set_kalman_filter(flag_kalman);
 
     d_sample_counter = 0;
     d_last_sample_nav_output = 0;
+    d_rinex_nav_stored = 0;
     d_rx_time = 0.0;
 
     d_last_status_print_seg = 0;
@@ -294,32 +310,34 @@ gps_l1_ca_sd_pvt_cc::gps_l1_ca_sd_pvt_cc(unsigned int nchannels,
     b_rinex_sbs_header_writen = false;
     rp = std::make_shared<Rinex_Printer>();
 
+    d_output_queue_epochs = 64;
+    d_output_dropped = 0;
+    d_output_stop = false;
+
     // ############# ENABLE DATA FILE LOG #################
     if (d_dump == true)
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit );
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    if (d_dump_file.open(d_dump_filename, pvt_raw_dump_schema(d_nchannels)))
+                        {
                             LOG(INFO) << "PVT dump enabled Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (const std::ifstream::failure & e)
-                    {
-                            LOG(INFO) << "Exception opening PVT dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "Cannot open PVT dump file " << d_dump_filename;
+                        }
                 }
         }
 
     //spoofing
     d_spoofing_detector = spoofing_detector;
-    d_APT = spoofing_detector.get_APT();
-    d_PPE_sampling = spoofing_detector.get_PPE_sampling();
+    d_APT = spoofing_detector->get_APT();
+    d_ls_pvt->set_doppler_static(spoofing_detector->get_Doppler_static());
     bool d_spoofing_report = true;
     if(d_spoofing_report)
         {
-        if (d_spoofing_report_file.is_open() == false)
+        if (!d_spoofing_report_writer)
             {
                 try
                 {
@@ -330,8 +348,15 @@ gps_l1_ca_sd_pvt_cc::gps_l1_ca_sd_pvt_cc(unsigned int nchannels,
                     << boost::posix_time::to_iso_string(t)
                     << ".txt";
                     spoofing_report_filename_full <<  FLAGS_log_dir << spoofing_report_filename.str();
-                    d_spoofing_report_file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-                    d_spoofing_report_file.open(spoofing_report_filename_full.str(), std::ios::out );
+                    std::stringstream spoofing_events_filename_full;
+                    if(spoofing_detector->get_report_json())
+                        {
+                            spoofing_events_filename_full << FLAGS_log_dir << "spoofing_events-"
+                            << boost::posix_time::to_iso_string(t)
+                            << ".json";
+                        }
+                    // alarms are drained and written by the writer thread, not in general_work
+                    d_spoofing_report_writer = std::make_shared<Spoofing_Report_Writer>(spoofing_report_filename_full.str(), spoofing_events_filename_full.str());
 
                     
                     std::stringstream spoofing_report_symlink;
@@ -362,7 +387,343 @@ gps_l1_ca_sd_pvt_cc::gps_l1_ca_sd_pvt_cc(unsigned int nchannels,
 
 gps_l1_ca_sd_pvt_cc::~gps_l1_ca_sd_pvt_cc()
 {
-    d_spoofing_report_file.close();
+    stop_output();
+    d_spoofing_report_writer.reset();
+}
+
+
+bool gps_l1_ca_sd_pvt_cc::start()
+{
+    stop_output();
+    d_output_queue.reset(new concurrent_spsc_queue<std::shared_ptr<const Pvt_Output_Epoch> >(d_output_queue_epochs));
+    d_output_dropped = 0;
+    d_output_stop = false;
+    d_output_thread = boost::thread(boost::bind(&gps_l1_ca_sd_pvt_cc::run_output, this));
+    return true;
+}
+
+
+bool gps_l1_ca_sd_pvt_cc::stop()
+{
+    stop_output();
+    return true;
+}
+
+
+void gps_l1_ca_sd_pvt_cc::stop_output()
+{
+    if (!d_output_thread.joinable())
+        {
+            return;
+        }
+    {
+        boost::mutex::scoped_lock lock(d_output_mutex);
+        d_output_stop = true;
+    }
+    d_output_thread.join();
+}
+
+
+void gps_l1_ca_sd_pvt_cc::set_output_queue(unsigned int epochs)
+{
+    d_output_queue_epochs = std::max(epochs, 2u);
+}
+
+
+void gps_l1_ca_sd_pvt_cc::set_pvt_log(const std::string & filename)
+{
+    d_pvt_log.reset();
+    if (!filename.empty())
+        {
+            d_pvt_log = std::make_shared<Pvt_Log_Writer>();
+            if (!d_pvt_log->open(filename))
+                {
+                    d_pvt_log.reset();
+                }
+        }
+    update_alarm_handler();
+}
+
+
+void gps_l1_ca_sd_pvt_cc::set_telemetry(const std::string & address, unsigned short port, unsigned int decimation, int multicast_ttl)
+{
+    d_telemetry.reset();
+    if (!address.empty())
+        {
+            d_telemetry = std::make_shared<Pvt_Telemetry_Publisher>();
+            if (!d_telemetry->open(address, port, decimation, multicast_ttl))
+                {
+                    d_telemetry.reset();
+                }
+        }
+    update_alarm_handler();
+}
+
+
+void gps_l1_ca_sd_pvt_cc::set_track_files(unsigned int decimation, double flush_period_s, double rotate_period_s)
+{
+    d_kml_printer->set_streaming(decimation, flush_period_s, rotate_period_s);
+    d_geojson_printer->set_streaming(decimation, flush_period_s, rotate_period_s);
+}
+
+
+void gps_l1_ca_sd_pvt_cc::set_iono_correction(bool enabled)
+{
+    d_ls_pvt->set_iono_correction(enabled);
+}
+
+
+void gps_l1_ca_sd_pvt_cc::set_rtcm_input(const std::shared_ptr<Rtcm_Client> & client, double max_age_s)
+{
+    d_ls_pvt->set_rtcm_input(client, max_age_s);
+}
+
+
+void gps_l1_ca_sd_pvt_cc::set_low_latency_rate(int rate_ms)
+{
+    d_low_latency_rate_ms = std::max(rate_ms, 0);
+}
+
+
+void gps_l1_ca_sd_pvt_cc::update_alarm_handler()
+{
+    if (d_spoofing_report_writer)
+        {
+            std::function<void(const Spoofing_Message&)> alarm_handler;
+            if (d_pvt_log || d_telemetry)
+                {
+                    std::shared_ptr<Pvt_Log_Writer> pvt_log = d_pvt_log;
+                    std::shared_ptr<Pvt_Telemetry_Publisher> telemetry = d_telemetry;
+                    alarm_handler = [pvt_log, telemetry](const Spoofing_Message& msg)
+                        {
+                            if (pvt_log) pvt_log->write_alarm(msg);
+                            if (telemetry) telemetry->publish_alarm(msg);
+                        };
+                }
+            d_spoofing_report_writer->set_alarm_handler(alarm_handler);
+        }
+}
+
+
+void gps_l1_ca_sd_pvt_cc::queue_output(bool fix, bool display)
+{
+    if (!d_output_navigation)
+        {
+            std::shared_ptr<Pvt_Output_Navigation> navigation = std::make_shared<Pvt_Output_Navigation>();
+            navigation->ephemeris = d_ls_pvt->gps_ephemeris_map;
+            navigation->iono = d_ls_pvt->gps_iono;
+            navigation->utc = d_ls_pvt->gps_utc_model;
+            d_output_navigation = navigation;
+        }
+    std::shared_ptr<Pvt_Output_Epoch> epoch = std::make_shared<Pvt_Output_Epoch>();
+    epoch->solution = std::make_shared<Pvt_Solution>(static_cast<const Pvt_Solution&>(*d_ls_pvt));
+    epoch->observables = gnss_pseudoranges_map;
+    epoch->navigation = d_output_navigation;
+    if (display)
+        {
+            epoch->pseudoranges = d_ls_pvt->d_pseudoranges;
+        }
+    epoch->rx_time = d_rx_time;
+    epoch->sample_counter = d_sample_counter;
+    epoch->fix = fix;
+    epoch->display = display;
+    if (d_output_queue)
+        {
+            // dropped, and counted, when the output thread is a whole queue behind
+            d_output_queue->push(epoch);
+        }
+    else
+        {
+            // the flowgraph has not started the output thread
+            write_outputs(*epoch, true);
+            if (display)
+                {
+                    display_position(*epoch);
+                }
+        }
+}
+
+
+void gps_l1_ca_sd_pvt_cc::run_output()
+{
+    std::vector<std::shared_ptr<const Pvt_Output_Epoch> > batch;
+    while (true)
+        {
+            bool stop;
+            {
+                boost::mutex::scoped_lock lock(d_output_mutex);
+                stop = d_output_stop;
+            }
+            batch.clear();
+            if (stop)
+                {
+                    // last pass, do not wait
+                    d_output_queue->pop_all(batch);
+                }
+            else
+                {
+                    d_output_queue->wait_and_pop_all(batch, boost::posix_time::milliseconds(100));
+                }
+
+            // behind by more than half the queue, the live outputs skip to the last solution
+            bool behind = batch.size() > d_output_queue_epochs / 2;
+            size_t last_fix = batch.size();
+            size_t last_display = batch.size();
+            for (size_t n = 0; n < batch.size(); n++)
+                {
+                    if (batch[n]->fix) last_fix = n;
+                    if (batch[n]->display) last_display = n;
+                }
+            for (size_t n = 0; n < batch.size(); n++)
+                {
+                    write_outputs(*batch[n], !behind or n == last_fix);
+                    if (batch[n]->display and (!behind or n == last_display))
+                        {
+                            display_position(*batch[n]);
+                        }
+                }
+
+            unsigned long dropped = d_output_queue->dropped();
+            if (dropped != d_output_dropped)
+                {
+                    LOG(WARNING) << "PVT output queue full, " << dropped - d_output_dropped << " output epochs dropped";
+                    d_output_dropped = dropped;
+                }
+            if (stop)
+                {
+                    return;
+                }
+        }
+}
+
+
+void gps_l1_ca_sd_pvt_cc::write_outputs(const Pvt_Output_Epoch& epoch, bool live)
+{
+    if (!epoch.fix)
+        {
+            return;
+        }
+    const std::map<int,Gps_Ephemeris>& gps_ephemeris_map = epoch.navigation->ephemeris;
+    double rx_time = epoch.rx_time;
+
+    // keep track of locking time
+    for(std::map<int,Gnss_Synchro>::const_iterator it = epoch.observables.begin(); it != epoch.observables.end(); ++it)
+        {
+            std::map<int,Gps_Ephemeris>::const_iterator tmp_eph_iter = gps_ephemeris_map.find(it->second.PRN);
+            if(tmp_eph_iter != gps_ephemeris_map.end())
+                {
+                    d_rtcm_printer->lock_time(tmp_eph_iter->second, rx_time, it->second);
+                }
+        }
+
+    if (live)
+        {
+            d_kml_printer->print_position(epoch.solution, d_flag_averaging);
+            d_geojson_printer->print_position(epoch.solution, d_flag_averaging);
+            d_nmea_printer->Print_Nmea_Line(epoch.solution, d_flag_averaging);
+            if (d_telemetry)
+                {
+                    d_telemetry->publish_epoch(*epoch.solution, epoch.observables, rx_time);
+                }
+        }
+    if (d_pvt_log)
+        {
+            d_pvt_log->write_solution(*epoch.solution, rx_time);
+            d_pvt_log->write_observables(epoch.observables, rx_time);
+        }
+
+    if (!b_rinex_header_writen)
+        {
+            std::map<int,Gps_Ephemeris>::const_iterator gps_ephemeris_iter;
+            gps_ephemeris_iter = gps_ephemeris_map.begin();
+            if (gps_ephemeris_iter != gps_ephemeris_map.end())
+                {
+                    rp->rinex_obs_header(rp->obsFile, gps_ephemeris_iter->second, rx_time);
+                    rp->rinex_nav_header(rp->navFile, epoch.navigation->iono, epoch.navigation->utc);
+                    b_rinex_header_writen = true; // do not write header anymore
+                }
+        }
+    if(b_rinex_header_writen) // Put here another condition to separate annotations (e.g 30 s)
+        {
+            // Limit the RINEX navigation output rate to 1/6 seg
+            // Notice that d_sample_counter period is 1ms (for GPS correlators)
+            // Each ephemeris of the history of the receiver is written once
+            if ((epoch.sample_counter - d_last_sample_nav_output) >= 6000)
+                {
+                    std::map<int, Gps_Ephemeris> new_ephemeris = d_receiver_state->ephemeris_history.latest_since(d_rinex_nav_stored);
+                    if (!new_ephemeris.empty())
+                        {
+                            rp->log_rinex_nav(rp->navFile, new_ephemeris);
+                        }
+                    d_last_sample_nav_output = epoch.sample_counter;
+                }
+            std::map<int,Gps_Ephemeris>::const_iterator gps_ephemeris_iter;
+            gps_ephemeris_iter = gps_ephemeris_map.begin();
+            if (gps_ephemeris_iter != gps_ephemeris_map.end())
+                {
+                    rp->log_rinex_obs(rp->obsFile, gps_ephemeris_iter->second, rx_time, epoch.observables);
+                }
+            if (!b_rinex_header_updated && (epoch.navigation->utc.d_A0 != 0))
+                {
+                    rp->update_obs_header(rp->obsFile, epoch.navigation->utc);
+                    rp->update_nav_header(rp->navFile, epoch.navigation->utc, epoch.navigation->iono);
+                    b_rinex_header_updated = true;
+                }
+        }
+    if(b_rtcm_writing_started)
+        {
+            if((epoch.sample_counter % d_rtcm_MT1019_rate_ms) == 0)
+                {
+                    for(std::map<int,Gps_Ephemeris>::const_iterator gps_ephemeris_iter = gps_ephemeris_map.begin(); gps_ephemeris_iter != gps_ephemeris_map.end(); gps_ephemeris_iter++ )
+                        {
+                            d_rtcm_printer->Print_Rtcm_MT1019(gps_ephemeris_iter->second);
+                        }
+                }
+            if((epoch.sample_counter % d_rtcm_MSM_rate_ms) == 0)
+                {
+                    std::map<int,Gps_Ephemeris>::const_iterator gps_ephemeris_iter;
+                    gps_ephemeris_iter = gps_ephemeris_map.begin();
+                    if (gps_ephemeris_iter != gps_ephemeris_map.end())
+                        {
+                            d_rtcm_printer->Print_Rtcm_MSM(7, gps_ephemeris_iter->second, {}, {}, rx_time, epoch.observables, 0, 0, 0, 0, 0);
+                        }
+                }
+        }
+
+    if(!b_rtcm_writing_started) // the first time
+        {
+            for(std::map<int,Gps_Ephemeris>::const_iterator gps_ephemeris_iter = gps_ephemeris_map.begin(); gps_ephemeris_iter != gps_ephemeris_map.end(); gps_ephemeris_iter++ )
+                {
+                    d_rtcm_printer->Print_Rtcm_MT1019(gps_ephemeris_iter->second);
+                }
+
+            std::map<int,Gps_Ephemeris>::const_iterator gps_ephemeris_iter = gps_ephemeris_map.begin();
+
+            if (gps_ephemeris_iter != gps_ephemeris_map.end())
+                {
+                    d_rtcm_printer->Print_Rtcm_MSM(7, gps_ephemeris_iter->second, {}, {}, rx_time, epoch.observables, 0, 0, 0, 0, 0);
+                }
+            b_rtcm_writing_started = true;
+        }
+}
+
+
+void gps_l1_ca_sd_pvt_cc::display_position(const Pvt_Output_Epoch& epoch)
+{
+    const Pvt_Solution& solution = *epoch.solution;
+    std::cout << "Position at " << boost::posix_time::to_simple_string(solution.d_position_UTC_time)
+              << " " << epoch.sample_counter << " "
+              << " is Lat = " << solution.d_latitude_d << " [deg], Long = " << solution.d_longitude_d
+              << " [deg], Height= " << solution.d_height_m << " [m] "
+              << std::setprecision(9)  << epoch.pseudoranges << std::endl;
+
+    LOG(INFO) << "Position at " << boost::posix_time::to_simple_string(solution.d_position_UTC_time)
+              << " UTC is Lat = " << solution.d_latitude_d << " [deg], Long = " << solution.d_longitude_d
+              << " [deg], Height= " << solution.d_height_m << " [m]";
+
+    LOG(INFO) << "Dilution of Precision at " << boost::posix_time::to_simple_string(solution.d_position_UTC_time)
+              << " is HDOP = " << solution.d_HDOP << " VDOP = "
+              << solution.d_VDOP <<" TDOP = " << solution.d_TDOP << " GDOP = " << solution.d_GDOP;
 }
 
 
@@ -406,8 +767,11 @@ int gps_l1_ca_sd_pvt_cc::general_work (int noutput_items __attribute__((unused))
             return 0;
         }
 
-    std::list<unsigned int> channels_used; 
-    std::map<unsigned int, unsigned int> PRN_to_peak;
+    // the temporaries of the epoch live in the arena, reused from one epoch to the next
+    d_epoch_arena.reset();
+    Channel_List channels_used((Arena_Allocator<unsigned int>(&d_epoch_arena)));
+    std::map<unsigned int, unsigned int, std::less<unsigned int>, Arena_Allocator<std::pair<const unsigned int, unsigned int> > >
+            PRN_to_peak((std::less<unsigned int>()), Arena_Allocator<std::pair<const unsigned int, unsigned int> >(&d_epoch_arena));
     for(unsigned int i = 0; i<d_nchannels; ++i)
         {
             if (in[i][0].Flag_valid_pseudorange && d_channels.at(i)->get_state() != 2)
@@ -434,15 +798,12 @@ int gps_l1_ca_sd_pvt_cc::general_work (int noutput_items __attribute__((unused))
         }
 
 
-    if((d_sample_counter % d_PPE_sampling) == 0)
-        {
-            d_spoofing_detector.PPE_moving_var(channels_used, in, d_sample_counter);
-        }
+    d_spoofing_detector->new_epoch(channels_used, in, d_sample_counter);
 
 
     // ############ 1. READ PSEUDORANGES ####
     unsigned int i = 0;
-    for(std::list<unsigned int>::iterator it = channels_used.begin(); it != channels_used.end(); ++it)
+    for(Channel_List::iterator it = channels_used.begin(); it != channels_used.end(); ++it)
         {
             i = *it; 
             int uid = d_channels.at(i)->get_uid(); 
@@ -456,191 +817,84 @@ int gps_l1_ca_sd_pvt_cc::general_work (int noutput_items __attribute__((unused))
                     gnss_pseudoranges_map.insert(std::pair<int,Gnss_Synchro>(in[i][0].PRN, in[i][0])); // store valid pseudoranges in a map
                 }
             d_rx_time = in[i][0].d_TOW_at_current_symbol; // all the channels have the same RX timestamp (common RX time pseudoranges)
-
-            if(d_ls_pvt->gps_ephemeris_map.size() > 0)
-            {
-                std::map<int,Gps_Ephemeris>::iterator tmp_eph_iter = d_ls_pvt->gps_ephemeris_map.find(in[i][0].PRN);
-                if(tmp_eph_iter != d_ls_pvt->gps_ephemeris_map.end())
-                {
-                    d_rtcm_printer->lock_time(d_ls_pvt->gps_ephemeris_map.find(in[i][0].PRN)->second, d_rx_time, in[i][0]); // keep track of locking time
-                }
-            }
         }
 
 
 
-    Spoofing_Message spm;
-    while( !global_spoofing_queue.empty())
-    {
-        global_spoofing_queue.try_pop(spm);
-        try
-        {
-            d_spoofing_report_file << spm.spoofing_report;
-            d_spoofing_report_file.flush();
-        }
-        catch (std::ifstream::failure e)
-        {
-            LOG(WARNING) << "Exception writing to spoofing report " << e.what();
-        }
-    }
-    
-
     // ############ 2 COMPUTE THE PVT ################################
     if (gnss_pseudoranges_map.size() > 0 and d_ls_pvt->gps_ephemeris_map.size() > 0)
         {
             // compute on the fly PVT solution
             //mod 8/4/2012 Set the PVT computation rate in this block
-            if ((d_sample_counter % d_output_rate_ms) == 0)
+            // the low latency solutions in between only feed the spoofing checks
+            bool output_epoch = (d_sample_counter % d_output_rate_ms) == 0;
+            bool low_latency_epoch = d_low_latency_rate_ms > 0 and (d_sample_counter % d_low_latency_rate_ms) == 0;
+            bool fix_epoch = false;
+            if (output_epoch or low_latency_epoch)
                 {
                     bool pvt_result;
-                    pvt_result = d_ls_pvt->get_PVT(gnss_pseudoranges_map, d_rx_time, d_flag_averaging);
+                    pvt_result = d_ls_pvt->get_PVT(gnss_pseudoranges_map, d_rx_time, d_flag_averaging and output_epoch);
                     if (pvt_result == true)
                         {
-                            d_kml_printer->print_position(d_ls_pvt, d_flag_averaging);
-                            d_geojson_printer->print_position(d_ls_pvt, d_flag_averaging);
-                            d_nmea_printer->Print_Nmea_Line(d_ls_pvt, d_flag_averaging);
-
-                            if (!b_rinex_header_writen)
-                                {
-                                    std::map<int,Gps_Ephemeris>::iterator gps_ephemeris_iter;
-                                    gps_ephemeris_iter = d_ls_pvt->gps_ephemeris_map.begin();
-                                    if (gps_ephemeris_iter != d_ls_pvt->gps_ephemeris_map.end())
-                                        {
-                                            rp->rinex_obs_header(rp->obsFile, gps_ephemeris_iter->second, d_rx_time);
-                                            rp->rinex_nav_header(rp->navFile, d_ls_pvt->gps_iono, d_ls_pvt->gps_utc_model);
-                                            b_rinex_header_writen = true; // do not write header anymore
-                                        }
-                                }
-                            if(b_rinex_header_writen) // Put here another condition to separate annotations (e.g 30 s)
-                                {
-                                    // Limit the RINEX navigation output rate to 1/6 seg
-                                    // Notice that d_sample_counter period is 1ms (for GPS correlators)
-                                    if ((d_sample_counter - d_last_sample_nav_output) >= 6000)
-                                        {
-                                            rp->log_rinex_nav(rp->navFile, d_ls_pvt->gps_ephemeris_map);
-                                            d_last_sample_nav_output = d_sample_counter;
-                                        }
-                                    std::map<int,Gps_Ephemeris>::iterator gps_ephemeris_iter;
-                                    gps_ephemeris_iter = d_ls_pvt->gps_ephemeris_map.begin();
-                                    if (gps_ephemeris_iter != d_ls_pvt->gps_ephemeris_map.end())
-                                        {
-                                            rp->log_rinex_obs(rp->obsFile, gps_ephemeris_iter->second, d_rx_time, gnss_pseudoranges_map);
-                                        }
-                                    if (!b_rinex_header_updated && (d_ls_pvt->gps_utc_model.d_A0 != 0))
-                                        {
-                                            rp->update_obs_header(rp->obsFile, d_ls_pvt->gps_utc_model);
-                                            rp->update_nav_header(rp->navFile, d_ls_pvt->gps_utc_model, d_ls_pvt->gps_iono);
-                                            b_rinex_header_updated = true;
-                                        }
-                                }
-                            if(b_rtcm_writing_started)
-                                {
-                                    if((d_sample_counter % d_rtcm_MT1019_rate_ms) == 0)
-                                        {
-                                            for(std::map<int,Gps_Ephemeris>::iterator gps_ephemeris_iter = d_ls_pvt->gps_ephemeris_map.begin(); gps_ephemeris_iter != d_ls_pvt->gps_ephemeris_map.end(); gps_ephemeris_iter++ )
-                                                {
-                                                    d_rtcm_printer->Print_Rtcm_MT1019(gps_ephemeris_iter->second);
-                                                }
-                                        }
-                                    if((d_sample_counter % d_rtcm_MSM_rate_ms) == 0)
-                                        {
-                                            std::map<int,Gps_Ephemeris>::iterator gps_ephemeris_iter;
-                                            gps_ephemeris_iter = d_ls_pvt->gps_ephemeris_map.begin();
-                                            if (gps_ephemeris_iter != d_ls_pvt->gps_ephemeris_map.end())
-                                                {
-                                                    d_rtcm_printer->Print_Rtcm_MSM(7, gps_ephemeris_iter->second, {}, {}, d_rx_time, gnss_pseudoranges_map, 0, 0, 0, 0, 0);
-                                                }
-                                        }
-                                }
-
-                            if(!b_rtcm_writing_started) // the first time
-                                {
-                                    for(std::map<int,Gps_Ephemeris>::iterator gps_ephemeris_iter = d_ls_pvt->gps_ephemeris_map.begin(); gps_ephemeris_iter != d_ls_pvt->gps_ephemeris_map.end(); gps_ephemeris_iter++ )
-                                        {
-                                            d_rtcm_printer->Print_Rtcm_MT1019(gps_ephemeris_iter->second);
-                                        }
-
-                                    std::map<int,Gps_Ephemeris>::iterator gps_ephemeris_iter = d_ls_pvt->gps_ephemeris_map.begin();
-
-                                    if (gps_ephemeris_iter != d_ls_pvt->gps_ephemeris_map.end())
-                                        {
-                                            d_rtcm_printer->Print_Rtcm_MSM(7, gps_ephemeris_iter->second, {}, {}, d_rx_time, gnss_pseudoranges_map, 0, 0, 0, 0, 0);
-                                        }
-                                    b_rtcm_writing_started = true;
-                                }
+                            LATENCY_TRACE(LATENCY_PVT, -1, gnss_pseudoranges_map.begin()->second.sample_counter);
                         }
+                    fix_epoch = pvt_result and output_epoch;
 
                 //Check if the value of the position is logical and if the satellites have movement is probable.
                 if(d_ls_pvt->b_valid_position == true)
                     {
-                        d_spoofing_detector.check_position(d_ls_pvt->d_latitude_d, d_ls_pvt->d_longitude_d, d_ls_pvt->d_height_m, d_sample_counter); 
-                    }
-                /*
-                if(d_satpos_detection)
-                    {
-                        std::map<int,Gps_Ephemeris>::iterator gps_ephemeris_iter2;
-                        std::map<int,Gnss_Synchro>::iterator gnss_pseudoranges_iter;
-                        for(gnss_pseudoranges_iter = gnss_pseudoranges_map.begin();
-                                gnss_pseudoranges_iter != gnss_pseudoranges_map.end();
-                                gnss_pseudoranges_iter++)
-                        {
-                            std::map<int,Gps_Ephemeris>::iterator gps_ephemeris_iter2;
-                            gps_ephemeris_iter2 = d_ls_pvt->gps_ephemeris_map.find(gnss_pseudoranges_iter->first);
-
-
-                            if (gps_ephemeris_iter2 != d_ls_pvt->gps_ephemeris_map.end())
+                        d_spoofing_detector->new_position(d_ls_pvt->d_latitude_d, d_ls_pvt->d_longitude_d, d_ls_pvt->d_height_m, d_sample_counter); 
+                        if(!d_ls_pvt->d_raim_subset_ssr.is_empty())
                             {
-                                d_spoofing_detector.check_satpos(gps_ephemeris_iter2->second.i_satellite_PRN, gps_ephemeris_iter2->second.timestamp , 
-                                        gps_ephemeris_iter2->second.d_satpos_X, gps_ephemeris_iter2->second.d_satpos_Y, 
-                                        gps_ephemeris_iter2->second.d_satpos_Z);
+                                d_spoofing_detector->new_residuals(d_ls_pvt->d_raim_prn, d_ls_pvt->d_valid_observations, d_ls_pvt->d_raim_ssr,
+                                        arma::conv_to<std::vector<double> >::from(d_ls_pvt->d_raim_subset_ssr), d_sample_counter,
+                                        d_ls_pvt->d_differential);
+                            }
+                        if(!d_ls_pvt->d_doppler_residuals.is_empty())
+                            {
+                                d_spoofing_detector->new_doppler_residuals(d_ls_pvt->d_raim_prn,
+                                        arma::conv_to<std::vector<double> >::from(d_ls_pvt->d_doppler_residuals), d_sample_counter);
                             }
-                        }
                     }
-                */
+                // a lookup per satellite, and a validation per new ephemeris
+                d_spoofing_detector->check_ephemeris_satpos(d_ls_pvt->gps_ephemeris_map, d_rx_time, d_sample_counter);
                 }
 
-            // DEBUG MESSAGE: Display position in console output
-            if (((d_sample_counter % d_display_rate_ms) == 0) and d_ls_pvt->b_valid_position == true)
+            // the outputs are written by the output thread, from a copy of the epoch
+            bool display_epoch = ((d_sample_counter % d_display_rate_ms) == 0) and d_ls_pvt->b_valid_position == true;
+            if (fix_epoch or display_epoch)
                 {
-/*
-                    std::cout << "Position at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
-                              << " UTC is Lat = " << d_ls_pvt->d_latitude_d << " [deg], Long = " << d_ls_pvt->d_longitude_d
-                              << " [deg], Height= " << d_ls_pvt->d_height_m << " [m]" << std::endl;
-*/
-                    std::cout << "Position at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
-                              << " " << d_sample_counter << " " 
-                              << " is Lat = " << d_ls_pvt->d_latitude_d << " [deg], Long = " << d_ls_pvt->d_longitude_d
-                              << " [deg], Height= " << d_ls_pvt->d_height_m << " [m] " 
-                              << std::setprecision(9)  << d_ls_pvt->d_pseudoranges << std::endl;
-
-                    LOG(INFO) << "Position at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
-                              << " UTC is Lat = " << d_ls_pvt->d_latitude_d << " [deg], Long = " << d_ls_pvt->d_longitude_d
-                              << " [deg], Height= " << d_ls_pvt->d_height_m << " [m]";
+                    queue_output(fix_epoch, display_epoch);
+                }
 
-                    LOG(INFO) << "Dilution of Precision at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
-                              << " is HDOP = " << d_ls_pvt->d_HDOP << " VDOP = "
-                              << d_ls_pvt->d_VDOP <<" TDOP = " << d_ls_pvt->d_TDOP << " GDOP = " << d_ls_pvt->d_GDOP;
+            // the acquisition ordering of the control thread starts from the last fix
+            if (display_epoch)
+                {
+                    Gps_Ref_Location fix;
+                    fix.valid = true;
+                    fix.lat = d_ls_pvt->d_latitude_d;
+                    fix.lon = d_ls_pvt->d_longitude_d;
+                    d_receiver_state->gps_ref_location_map.write(0, fix);
+                    if (!d_ls_pvt->gps_ephemeris_map.empty())
+                        {
+                            Gps_Ref_Time fix_time;
+                            fix_time.valid = true;
+                            fix_time.d_TOW = d_rx_time;
+                            fix_time.d_Week = d_ls_pvt->gps_ephemeris_map.begin()->second.i_GPS_week;
+                            fix_time.d_tv_sec = static_cast<double>(std::time(0));
+                            fix_time.d_tv_usec = 0.0;
+                            d_receiver_state->gps_ref_time_map.write(0, fix_time);
+                        }
                 }
 
             // MULTIPLEXED FILE RECORDING - Record results to file
             if(d_dump == true)
                 {
-                    try
-                    {
-                            double tmp_double;
-                            for (unsigned int i = 0; i < d_nchannels ; i++)
-                                {
-                                    tmp_double = in[i][0].Pseudorange_m;
-                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                                    tmp_double = 0;
-                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                                    d_dump_file.write((char*)&d_rx_time, sizeof(double));
-                                }
-                    }
-                    catch (const std::ifstream::failure & e)
-                    {
-                            LOG(WARNING) << "Exception writing observables dump file " << e.what();
-                    }
+                    for (unsigned int i = 0; i < d_nchannels; i++)
+                        {
+                            d_dump_file.put<double>(in[i][0].Pseudorange_m);
+                        }
+                    d_dump_file.put<double>(d_rx_time);
                 }
         }
 
@@ -34,16 +34,27 @@
 #define GNSS_SDR_GPS_L1_CA_SD_PVT_CC_H
 
 #include <fstream>
+#include <memory>
 #include <string>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 #include <gnuradio/block.h>
 #include "nmea_printer.h"
 #include "kml_printer.h"
 #include "rinex_printer.h"
 #include "geojson_printer.h"
+#include "pvt_log.h"
+#include "pvt_telemetry.h"
 #include "rtcm_printer.h"
+#include "epoch_arena.h"
 #include "gps_l1_ca_ls_pvt.h"
+#include "receiver_state.h"
 #include "spoofing_detector.h"
+#include "spoofing_report_writer.h"
 #include "channel_interface.h"
+#include "dump_writer.h"
+#include "concurrent_ring_queue.h"
 
 //class ChannelInterface;
 class gps_l1_ca_sd_pvt_cc;
@@ -55,6 +66,7 @@ gps_l1_ca_sd_pvt_cc_sptr gps_l1_ca_make_sd_pvt_cc(unsigned int n_channels,
                                             std::string dump_filename,
                                             int averaging_depth,
                                             bool flag_averaging,
+                                            bool flag_kalman,
                                             int output_rate_ms,
                                             int display_rate_ms,
                                             bool flag_nmea_tty_port,
@@ -66,11 +78,46 @@ gps_l1_ca_sd_pvt_cc_sptr gps_l1_ca_make_sd_pvt_cc(unsigned int n_channels,
                                             unsigned short rtcm_station_id,
                                             std::map<int,int> rtcm_msg_rate_ms,
                                             std::string rtcm_dump_devname,
-                                            Spoofing_Detector spoofing_detector 
+                                            std::shared_ptr<Spoofing_Detector> spoofing_detector
 );
 
+/*!
+ * \brief Navigation data of the output epochs, shared by the epochs until
+ * a new ephemeris, ionospheric or UTC model arrives
+ */
+struct Pvt_Output_Navigation
+{
+    std::map<int,Gps_Ephemeris> ephemeris;
+    Gps_Iono iono;
+    Gps_Utc_Model utc;
+};
+
+/*!
+ * \brief Copy of an epoch of the PVT block, written to the KML, GeoJSON,
+ * NMEA, RINEX and RTCM outputs, PVT log, telemetry and console by the output
+ * thread of the block
+ */
+struct Pvt_Output_Epoch
+{
+    std::shared_ptr<Pvt_Solution> solution;
+    std::map<int,Gnss_Synchro> observables;
+    std::shared_ptr<const Pvt_Output_Navigation> navigation;
+    std::string pseudoranges; // of the display epochs
+    double rx_time;
+    long unsigned int sample_counter;
+    bool fix;     // output epoch with a solution, for the outputs
+    bool display; // display epoch with a valid position, for the console
+};
+
 /*!
  * \brief This class implements a block that computes the PVT solution
+ *
+ * The solutions are written to the outputs by a thread of the block, so
+ * a slow file, serial port or network client never holds back the
+ * channels. When that thread falls behind, the epochs beyond the output
+ * queue are dropped, and the KML, GeoJSON, NMEA, telemetry and console
+ * outputs keep only the last solution of the backlog, while the RINEX,
+ * RTCM and PVT log get all the queued epochs.
  */
 class gps_l1_ca_sd_pvt_cc : public gr::block
 {
@@ -80,6 +127,7 @@ private:
                                                        std::string dump_filename,
                                                        int averaging_depth,
                                                        bool flag_averaging,
+                                                       bool flag_kalman,
                                                        int output_rate_ms,
                                                        int display_rate_ms,
                                                        bool flag_nmea_tty_port,
@@ -91,12 +139,13 @@ private:
                                                        unsigned short rtcm_station_id,
                                                        std::map<int,int> rtcm_msg_rate_ms,
                                                        std::string rtcm_dump_devname,
-                                                       Spoofing_Detector spoofing_detector); 
+                                                       std::shared_ptr<Spoofing_Detector> spoofing_detector);
     gps_l1_ca_sd_pvt_cc(unsigned int nchannels,
                      bool dump,
                      std::string dump_filename,
                      int averaging_depth,
                      bool flag_averaging,
+                     bool flag_kalman,
                      int output_rate_ms,
                      int display_rate_ms,
                      bool flag_nmea_tty_port,
@@ -108,7 +157,7 @@ private:
                      unsigned short rtcm_station_id,
                      std::map<int,int> rtcm_msg_rate_ms,
                      std::string rtcm_dump_devname,
-                     Spoofing_Detector spoofing_detector); 
+                     std::shared_ptr<Spoofing_Detector> spoofing_detector);
 
     void msg_handler_telemetry(pmt::pmt_t msg);
 
@@ -127,30 +176,50 @@ private:
 
     unsigned int d_nchannels;
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
     int d_averaging_depth;
     bool d_flag_averaging;
     int d_output_rate_ms;
     int d_display_rate_ms;
+    int d_low_latency_rate_ms;
     long unsigned int d_sample_counter;
     long unsigned int d_last_sample_nav_output;
+    long unsigned int d_rinex_nav_stored; // Ephemeris_History::stored_count() at the last RINEX navigation output
 
     std::shared_ptr<Rinex_Printer> rp;
     std::shared_ptr<Kml_Printer> d_kml_printer;
     std::shared_ptr<Nmea_Printer> d_nmea_printer;
     std::shared_ptr<GeoJSON_Printer> d_geojson_printer;
+    std::shared_ptr<Pvt_Log_Writer> d_pvt_log;
+    std::shared_ptr<Pvt_Telemetry_Publisher> d_telemetry;
     std::shared_ptr<Rtcm_Printer> d_rtcm_printer;
     double d_rx_time;
     std::shared_ptr<gps_l1_ca_ls_pvt> d_ls_pvt;
+    std::shared_ptr<Receiver_State> d_receiver_state; // tables of the receiver, current at construction
 
     std::map<int,Gnss_Synchro> gnss_pseudoranges_map;
+    Epoch_Arena d_epoch_arena; // channels of the epoch, reset by each general_work
 
-    Spoofing_Detector d_spoofing_detector;
+    std::shared_ptr<Spoofing_Detector> d_spoofing_detector;
     bool d_APT;
-    int d_PPE_sampling;
-    std::ofstream d_spoofing_report_file;
+    std::shared_ptr<Spoofing_Report_Writer> d_spoofing_report_writer;
     bool pseudoranges_pairCompare_min(const std::pair<int,Gnss_Synchro>& a, const std::pair<int,Gnss_Synchro>& b);
     std::vector<std::shared_ptr<ChannelInterface>> d_channels;
+    void update_alarm_handler(); // sends the alarms to the PVT log and the telemetry
+
+    // output thread
+    std::shared_ptr<const Pvt_Output_Navigation> d_output_navigation; // rebuilt by msg_handler_telemetry when needed
+    std::unique_ptr<concurrent_spsc_queue<std::shared_ptr<const Pvt_Output_Epoch> > > d_output_queue;
+    unsigned int d_output_queue_epochs;
+    unsigned long d_output_dropped;
+    bool d_output_stop;
+    boost::mutex d_output_mutex; // d_output_stop
+    boost::thread d_output_thread;
+    void queue_output(bool fix, bool display);
+    void run_output();
+    void write_outputs(const Pvt_Output_Epoch& epoch, bool live);
+    void display_position(const Pvt_Output_Epoch& epoch);
+    void stop_output();
 
 public:
 
@@ -161,8 +230,55 @@ public:
      */
     std::map<int,Gps_Ephemeris> get_GPS_L1_ephemeris_map();
     
+    /*!
+     * \brief Starts the binary log of the solutions, observables and alarms (see pvt_log.h).
+     * An empty file name disables it.
+     */
+    void set_pvt_log(const std::string & filename);
+
+    /*!
+     * \brief Publishes the solutions, channels and alarms to address:port (see pvt_telemetry.h).
+     * An empty address disables it.
+     */
+    void set_telemetry(const std::string & address, unsigned short port, unsigned int decimation, int multicast_ttl);
+
+    /*!
+     * \brief The KML and GeoJSON tracks keep one of every decimation
+     * solutions, are written every flush_period_s and start a new file
+     * every rotate_period_s (0 for never)
+     */
+    void set_track_files(unsigned int decimation, double flush_period_s, double rotate_period_s);
+
+    /*!
+     * \brief Corrects the pseudoranges with the broadcast ionospheric model
+     */
+    void set_iono_correction(bool enabled);
+
+    /*!
+     * \brief Corrects the pseudoranges with the observations of the reference
+     * station that client receives, if they are at most max_age_s old
+     */
+    void set_rtcm_input(const std::shared_ptr<Rtcm_Client> & client, double max_age_s);
+
+    /*!
+     * \brief Computes a solution every rate_ms as well, for the spoofing checks
+     * of the position, residuals and satellites, without the KML, GeoJSON,
+     * NMEA, RINEX and RTCM outputs, which stay on output_rate_ms. Meant for
+     * the low latency observables, see gps_l1_ca_observables_cc. 0 disables it.
+     */
+    void set_low_latency_rate(int rate_ms);
+
+    /*!
+     * \brief Length of the queue of the output thread, in output epochs.
+     * Has effect until the flowgraph starts.
+     */
+    void set_output_queue(unsigned int epochs);
+
     ~gps_l1_ca_sd_pvt_cc (); //!< Default destructor
 
+    bool start(); //!< Starts the output thread
+    bool stop();  //!< Writes the queued epochs and stops the output thread
+
     int general_work (int noutput_items, gr_vector_int &ninput_items,
             gr_vector_const_void_star &input_items, gr_vector_void_star &output_items); //!< PVT Signal Processing
 
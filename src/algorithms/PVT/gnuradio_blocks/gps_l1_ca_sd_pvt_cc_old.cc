@@ -47,6 +47,18 @@
 #include "spoofing_message.h"
 
 using google::LogMessage;
+
+namespace
+{
+Dump_Schema pvt_raw_dump_schema(unsigned int nchannels)
+{
+    Dump_Schema schema("gps_l1_ca_sd_pvt_raw");
+    schema.add<double>("Pseudorange_m", nchannels)
+          .add<double>("rx_time_s");
+    return schema;
+}
+}
+
 //DEFINE_string(spoofing_report_dir, "./", "Use gnss-sdr --spoofing_report_dir=/path/to/report to specify where the spoofing report is stored.");
 
 extern concurrent_map<Gps_Ephemeris> global_gps_ephemeris_map;
@@ -178,16 +190,14 @@ gps_l1_ca_sd_pvt_cc::gps_l1_ca_sd_pvt_cc(unsigned int nchannels,
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit );
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    if (d_dump_file.open(d_dump_filename, pvt_raw_dump_schema(d_nchannels)))
+                        {
                             LOG(INFO) << "PVT dump enabled Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (std::ifstream::failure e)
-                    {
-                            LOG(INFO) << "Exception opening PVT dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "Cannot open PVT dump file " << d_dump_filename;
+                        }
                 }
 
 
@@ -519,22 +529,11 @@ int gps_l1_ca_sd_pvt_cc::general_work (int noutput_items, gr_vector_int &ninput_
             // MULTIPLEXED FILE RECORDING - Record results to file
             if(d_dump == true)
                 {
-                    try
-                    {
-                            double tmp_double;
-                            for (unsigned int i = 0; i < d_nchannels ; i++)
-                                {
-                                    tmp_double = in[i][0].Pseudorange_m;
-                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                                    tmp_double = 0;
-                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                                    d_dump_file.write((char*)&d_rx_time, sizeof(double));
-                                }
-                    }
-                    catch (std::ifstream::failure e)
-                    {
-                            LOG(WARNING) << "Exception writing observables dump file " << e.what();
-                    }
+                    for (unsigned int i = 0; i < d_nchannels; i++)
+                        {
+                            d_dump_file.put<double>(in[i][0].Pseudorange_m);
+                        }
+                    d_dump_file.put<double>(d_rx_time);
                 }
         }
 
@@ -49,6 +49,7 @@
 #include "gps_l1_ca_ls_pvt.h"
 #include "GPS_L1_CA.h"
 #include "configuration_interface.h"
+#include "dump_writer.h"
 
 class gps_l1_ca_sd_pvt_cc;
 
@@ -104,7 +105,7 @@ private:
     Rinex_Printer *rp;
     unsigned int d_nchannels;
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
     std::ofstream d_dump_snr_file;
     int d_averaging_depth;
     bool d_flag_averaging;
@@ -41,12 +41,24 @@
 
 using google::LogMessage;
 
+namespace
+{
+Dump_Schema pvt_raw_dump_schema(unsigned int nchannels)
+{
+    Dump_Schema schema("hybrid_pvt_raw");
+    schema.add<double>("Pseudorange_m", nchannels)
+          .add<double>("rx_time_s");
+    return schema;
+}
+}
+
 hybrid_pvt_cc_sptr
 hybrid_make_pvt_cc(unsigned int nchannels,
         bool dump,
         std::string dump_filename,
         int averaging_depth,
         bool flag_averaging,
+        bool flag_kalman,
         int output_rate_ms,
         int display_rate_ms,
         bool flag_nmea_tty_port,
@@ -64,6 +76,7 @@ hybrid_make_pvt_cc(unsigned int nchannels,
             dump_filename,
             averaging_depth,
             flag_averaging,
+            flag_kalman,
             output_rate_ms,
             display_rate_ms,
             flag_nmea_tty_port,
@@ -81,14 +94,14 @@ hybrid_make_pvt_cc(unsigned int nchannels,
 void hybrid_pvt_cc::msg_handler_telemetry(pmt::pmt_t msg)
 {
     try {
-            if( pmt::any_ref(msg).type() == typeid(std::shared_ptr<Gps_Ephemeris>) )
+            if( pmt::any_ref(msg).type() == typeid(std::shared_ptr<const Gps_Ephemeris>) )
                 {
                     // ### GPS EPHEMERIS ###
-                    std::shared_ptr<Gps_Ephemeris> gps_eph;
-                    gps_eph = boost::any_cast<std::shared_ptr<Gps_Ephemeris>>(pmt::any_ref(msg));
+                    std::shared_ptr<const Gps_Ephemeris> gps_eph;
+                    gps_eph = boost::any_cast<std::shared_ptr<const Gps_Ephemeris>>(pmt::any_ref(msg));
                     DLOG(INFO) << "Ephemeris record has arrived from SAT ID "
                             << gps_eph->i_satellite_PRN << " (Block "
-                            <<  gps_eph->satelliteBlock[gps_eph->i_satellite_PRN] << ")"
+                            <<  gps_eph->satelliteBlock.at(gps_eph->i_satellite_PRN) << ")"
                             << "inserted with Toe="<< gps_eph->d_Toe<<" and GPS Week="
                             << gps_eph->i_GPS_week;
                     // update/insert new ephemeris record to the global ephemeris map
@@ -168,7 +181,7 @@ std::map<int,Gps_Ephemeris> hybrid_pvt_cc::get_GPS_L1_ephemeris_map()
 
 
 hybrid_pvt_cc::hybrid_pvt_cc(unsigned int nchannels, bool dump, std::string dump_filename,
-        int averaging_depth, bool flag_averaging, int output_rate_ms, int display_rate_ms, bool flag_nmea_tty_port,
+        int averaging_depth, bool flag_averaging, bool flag_kalman, int output_rate_ms, int display_rate_ms, bool flag_nmea_tty_port,
         std::string nmea_dump_filename, std::string nmea_dump_devname,
         bool flag_rtcm_server, bool flag_rtcm_tty_port, unsigned short rtcm_tcp_port,
         unsigned short rtcm_station_id, std::map<int,int> rtcm_msg_rate_ms, std::string rtcm_dump_devname) :
@@ -247,6 +260,7 @@ hybrid_pvt_cc::hybrid_pvt_cc(unsigned int nchannels, bool dump, std::string dump
 
     d_ls_pvt = std::make_shared<hybrid_ls_pvt>((int)nchannels, dump_ls_pvt_filename, d_dump);
     d_ls_pvt->set_averaging_depth(d_averaging_depth);
+    d_ls_pvt->set_kalman_filter(flag_kalman);
 
     d_sample_counter = 0;
     d_last_sample_nav_output = 0;
@@ -263,16 +277,14 @@ hybrid_pvt_cc::hybrid_pvt_cc(unsigned int nchannels, bool dump, std::string dump
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit );
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    if (d_dump_file.open(d_dump_filename, pvt_raw_dump_schema(d_nchannels)))
+                        {
                             LOG(INFO) << "PVT dump enabled Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (const std::ifstream::failure& e)
-                    {
-                            LOG(WARNING) << "Exception opening PVT dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "Cannot open PVT dump file " << d_dump_filename;
+                        }
                 }
         }
 }
@@ -283,6 +295,26 @@ hybrid_pvt_cc::~hybrid_pvt_cc()
 {}
 
 
+void hybrid_pvt_cc::set_pvt_log(const std::string & filename)
+{
+    d_pvt_log.reset();
+    if (!filename.empty())
+        {
+            d_pvt_log = std::make_shared<Pvt_Log_Writer>();
+            if (!d_pvt_log->open(filename))
+                {
+                    d_pvt_log.reset();
+                }
+        }
+}
+
+
+void hybrid_pvt_cc::set_rtcm_input(const std::shared_ptr<Rtcm_Client> & client, double max_age_s)
+{
+    d_ls_pvt->set_rtcm_input(client, max_age_s);
+}
+
+
 
 bool hybrid_pvt_cc::pseudoranges_pairCompare_min(const std::pair<int,Gnss_Synchro>& a, const std::pair<int,Gnss_Synchro>& b)
 {
@@ -363,6 +395,11 @@ int hybrid_pvt_cc::general_work (int noutput_items __attribute__((unused)), gr_v
                             d_kml_dump->print_position(d_ls_pvt, d_flag_averaging);
                             d_geojson_printer->print_position(d_ls_pvt, d_flag_averaging);
                             d_nmea_printer->Print_Nmea_Line(d_ls_pvt, d_flag_averaging);
+                            if (d_pvt_log)
+                                {
+                                    d_pvt_log->write_solution(*d_ls_pvt, d_rx_time);
+                                    d_pvt_log->write_observables(gnss_pseudoranges_map, d_rx_time);
+                                }
 
                             if (!b_rinex_header_writen) //  & we have utc data in nav message!
                                 {
@@ -560,22 +597,11 @@ int hybrid_pvt_cc::general_work (int noutput_items __attribute__((unused)), gr_v
             // MULTIPLEXED FILE RECORDING - Record results to file
             if(d_dump == true)
                 {
-                    try
-                    {
-                            double tmp_double;
-                            for (unsigned int i = 0; i < d_nchannels; i++)
-                                {
-                                    tmp_double = in[i][0].Pseudorange_m;
-                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                                    tmp_double = 0;
-                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                                    d_dump_file.write((char*)&d_rx_time, sizeof(double));
-                                }
-                    }
-                    catch (const std::ifstream::failure& e)
-                    {
-                            LOG(WARNING) << "Exception writing observables dump file " << e.what();
-                    }
+                    for (unsigned int i = 0; i < d_nchannels; i++)
+                        {
+                            d_dump_file.put<double>(in[i][0].Pseudorange_m);
+                        }
+                    d_dump_file.put<double>(d_rx_time);
                 }
         }
 
@@ -38,9 +38,11 @@
 #include "nmea_printer.h"
 #include "kml_printer.h"
 #include "geojson_printer.h"
+#include "pvt_log.h"
 #include "rinex_printer.h"
 #include "rtcm_printer.h"
 #include "hybrid_ls_pvt.h"
+#include "dump_writer.h"
 
 
 class hybrid_pvt_cc;
@@ -52,6 +54,7 @@ hybrid_pvt_cc_sptr hybrid_make_pvt_cc(unsigned int n_channels,
                                               std::string dump_filename,
                                               int averaging_depth,
                                               bool flag_averaging,
+                                              bool flag_kalman,
                                               int output_rate_ms,
                                               int display_rate_ms,
                                               bool flag_nmea_tty_port,
@@ -75,6 +78,7 @@ private:
                                                          std::string dump_filename,
                                                          int averaging_depth,
                                                          bool flag_averaging,
+                                                         bool flag_kalman,
                                                          int output_rate_ms,
                                                          int display_rate_ms,
                                                          bool flag_nmea_tty_port,
@@ -90,6 +94,7 @@ private:
                       bool dump, std::string dump_filename,
                       int averaging_depth,
                       bool flag_averaging,
+                      bool flag_kalman,
                       int output_rate_ms,
                       int display_rate_ms,
                       bool flag_nmea_tty_port,
@@ -118,7 +123,7 @@ private:
 
     unsigned int d_nchannels;
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
     int d_averaging_depth;
     bool d_flag_averaging;
     int d_output_rate_ms;
@@ -130,6 +135,7 @@ private:
     std::shared_ptr<Kml_Printer> d_kml_dump;
     std::shared_ptr<Nmea_Printer> d_nmea_printer;
     std::shared_ptr<GeoJSON_Printer> d_geojson_printer;
+    std::shared_ptr<Pvt_Log_Writer> d_pvt_log;
     std::shared_ptr<Rtcm_Printer> d_rtcm_printer;
     double d_rx_time;
     double d_TOW_at_curr_symbol_constellation;
@@ -145,6 +151,18 @@ public:
      */
     std::map<int,Gps_Ephemeris> get_GPS_L1_ephemeris_map();
     
+    /*!
+     * \brief Starts the binary log of the solutions and observables (see pvt_log.h).
+     * An empty file name disables it.
+     */
+    void set_pvt_log(const std::string & filename);
+
+    /*!
+     * \brief Corrects the pseudoranges with the observations of the reference
+     * station that client receives, if they are at most max_age_s old
+     */
+    void set_rtcm_input(const std::shared_ptr<Rtcm_Client> & client, double max_age_s);
+
     ~hybrid_pvt_cc (); //!< Default destructor
 
     int general_work (int noutput_items, gr_vector_int &ninput_items,
@@ -0,0 +1,220 @@
+/*!
+ * \file coarse_time_pvt.cc
+ * \brief Coarse time GPS L1 C/A position fix from the code phases of a
+ * snapshot of samples
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "coarse_time_pvt.h"
+#include <cmath>
+#include "GPS_L1_CA.h"
+#include <glog/logging.h>
+
+#define COARSE_TIME_MAX_ITERATIONS 10
+#define COARSE_TIME_MAX_RESIDUAL_M 1000.0 // larger residuals are taken as a wrong millisecond [m]
+
+using google::LogMessage;
+
+
+Coarse_Time_Pvt::Coarse_Time_Pvt() : Ls_Pvt()
+{
+    d_time_error_s = 0.0;
+    d_GPS_time_s = 0.0;
+    d_state.zeros();
+}
+
+
+double Coarse_Time_Pvt::predicted_pseudorange(Gps_Ephemeris & eph, const arma::vec & x, double t, arma::vec & los, double & range_rate)
+{
+    // the travel time is found by fixed point iterations, from the 72 ms of a satellite at the zenith
+    double traveltime = 0.072;
+    arma::vec sat(3);
+    arma::vec rot_sat;
+    for (int i = 0; i < 3; i++)
+        {
+            eph.satellitePosition(t - traveltime);
+            sat(0) = eph.d_satpos_X;
+            sat(1) = eph.d_satpos_Y;
+            sat(2) = eph.d_satpos_Z;
+            rot_sat = rotateSatellite(traveltime, sat);
+            traveltime = arma::norm(rot_sat - x, 2) / GPS_C_m_s;
+        }
+    double range = traveltime * GPS_C_m_s;
+    los = (rot_sat - x) / range;
+    range_rate = arma::dot(los, rotateSatellite(traveltime, satelliteVelocity(eph, t - traveltime)));
+
+    // the troposphere as leastSquarePos() models it, so that the refined fix starts where this one ends
+    double az, el, distance, dphi, dlambda, h;
+    double trop = 0.0;
+    topocent(&az, &el, &distance, x, rot_sat - x);
+    togeod(&dphi, &dlambda, &h, 6378137.0, 298.257223563, x(0), x(1), x(2));
+    tropo(&trop, sin(el * GPS_PI / 180.0), h / 1000.0, 1013.0, 293.0, 50.0, 0.0, 0.0, 0.0);
+    if (trop > 50.0) trop = 0.0;
+    return range + trop - eph.sv_clock_drift(t - traveltime) * GPS_C_m_s;
+}
+
+
+void Coarse_Time_Pvt::resolve_milliseconds(const std::vector<double> & code_phases_s, double approx_time_s)
+{
+    /*
+     * The code periods of all the satellites start on whole milliseconds of
+     * GPS time, so the pseudoranges are the code phases up to a whole number
+     * of code periods each, and a common offset that goes to the clock bias.
+     * The closest satellite is the reference, and the others take the number
+     * of code periods that brings them closest to their predicted range.
+     */
+    const double code_length_m = GPS_C_m_s * GPS_L1_CA_CODE_PERIOD;
+    unsigned int n = d_ephemeris.size();
+    arma::vec predicted(n);
+    arma::vec los;
+    double range_rate;
+    unsigned int ref = 0;
+    for (unsigned int i = 0; i < n; i++)
+        {
+            predicted(i) = predicted_pseudorange(*d_ephemeris[i], d_state.subvec(0, 2), approx_time_s + d_state(4), los, range_rate);
+            if (predicted(i) < predicted(ref)) ref = i;
+        }
+    double ref_pseudorange = predicted(ref) + d_state(3);
+    for (unsigned int i = 0; i < n; i++)
+        {
+            double fraction_m = (code_phases_s[i] - code_phases_s[ref]) * GPS_C_m_s;
+            double periods = std::floor((predicted(i) + d_state(3) - ref_pseudorange - fraction_m) / code_length_m + 0.5);
+            d_pseudoranges(i) = ref_pseudorange + fraction_m + periods * code_length_m;
+        }
+}
+
+
+double Coarse_Time_Pvt::solve_state(double approx_time_s, bool estimate_time)
+{
+    unsigned int n = d_ephemeris.size();
+    unsigned int n_states = estimate_time ? 5 : 4;
+    arma::mat A(n, n_states);
+    arma::vec omc(n);
+    arma::vec los;
+    double range_rate;
+    for (int iter = 0; iter < COARSE_TIME_MAX_ITERATIONS; iter++)
+        {
+            for (unsigned int i = 0; i < n; i++)
+                {
+                    double predicted = predicted_pseudorange(*d_ephemeris[i], d_state.subvec(0, 2), approx_time_s + d_state(4), los, range_rate);
+                    omc(i) = d_pseudoranges(i) - predicted - d_state(3);
+                    A(i, 0) = -los(0);
+                    A(i, 1) = -los(1);
+                    A(i, 2) = -los(2);
+                    A(i, 3) = 1.0;
+                    if (estimate_time) A(i, 4) = range_rate;
+                }
+            arma::vec dx;
+            if (!arma::solve(dx, A.t() * A, A.t() * omc))
+                {
+                    LOG(WARNING) << "Coarse time position solution failed";
+                    return -1.0;
+                }
+            d_state.subvec(0, n_states - 1) += dx;
+            if (arma::norm(dx.subvec(0, 2), 2) < 1e-3)
+                {
+                    return arma::max(arma::abs(omc - A * dx));
+                }
+        }
+    return -1.0;
+}
+
+
+bool Coarse_Time_Pvt::get_PVT(const std::map<int, double> & code_phases_s, double approx_time_s, const arma::vec & approx_pos)
+{
+    b_valid_position = false;
+    d_ephemeris.clear();
+    std::vector<double> phases;
+    for (std::map<int, double>::const_iterator it = code_phases_s.begin(); it != code_phases_s.end(); ++it)
+        {
+            std::map<int, Gps_Ephemeris>::iterator eph = gps_ephemeris_map.find(it->first);
+            if (eph == gps_ephemeris_map.end())
+                {
+                    DLOG(INFO) << "No ephemeris data for SV " << it->first;
+                    continue;
+                }
+            d_ephemeris.push_back(&eph->second);
+            phases.push_back(it->second);
+            if (d_ephemeris.size() == PVT_MAX_CHANNELS) break;
+        }
+    unsigned int n = d_ephemeris.size();
+    d_valid_observations = n;
+    if (n < 4)
+        {
+            return false;
+        }
+    bool estimate_time = n >= 5;
+
+    // the milliseconds are resolved again at the first solution, in case the approximations were too far
+    d_state.zeros();
+    d_state.subvec(0, 2) = approx_pos;
+    d_pseudoranges.set_size(n);
+    double max_residual = -1.0;
+    for (int pass = 0; pass < 2; pass++)
+        {
+            resolve_milliseconds(phases, approx_time_s);
+            max_residual = solve_state(approx_time_s, estimate_time);
+            if (max_residual < 0.0) return false;
+            if (max_residual < COARSE_TIME_MAX_RESIDUAL_M) break;
+        }
+    if (max_residual >= COARSE_TIME_MAX_RESIDUAL_M)
+        {
+            LOG(INFO) << "Coarse time fix rejected, largest residual " << max_residual << " [m]";
+            return false;
+        }
+    d_time_error_s = d_state(4);
+    d_GPS_time_s = approx_time_s + d_time_error_s;
+
+    // refine with the usual least squares, satellites at the transmit times of the corrected time
+    arma::mat satpos(3, n);
+    arma::vec obs(n);
+    arma::vec los;
+    double range_rate;
+    for (unsigned int i = 0; i < n; i++)
+        {
+            predicted_pseudorange(*d_ephemeris[i], d_state.subvec(0, 2), d_GPS_time_s, los, range_rate);
+            satpos(0, i) = d_ephemeris[i]->d_satpos_X;
+            satpos(1, i) = d_ephemeris[i]->d_satpos_Y;
+            satpos(2, i) = d_ephemeris[i]->d_satpos_Z;
+            obs(i) = d_pseudoranges(i) + d_ephemeris[i]->d_satClkDrift * GPS_C_m_s;
+            d_visible_satellites_IDs[i] = d_ephemeris[i]->i_satellite_PRN;
+        }
+    reset_warm_start();
+    arma::vec mypos = leastSquarePos(satpos, obs, arma::eye(n, n));
+    d_x_m = mypos(0);
+    d_y_m = mypos(1);
+    d_z_m = mypos(2);
+    d_rx_dt_m = mypos(3) / GPS_C_m_s; // Convert RX time offset from meters to seconds
+    cart2geo(d_x_m, d_y_m, d_z_m, 4);
+    compute_DOP();
+    LOG(INFO) << "Coarse time position at TOW=" << d_GPS_time_s << " (time error " << d_time_error_s
+              << " [s]) is Lat = " << d_latitude_d << " [deg], Long = " << d_longitude_d
+              << " [deg], Height= " << d_height_m << " [m]";
+    b_valid_position = d_height_m < 50000;
+    return b_valid_position;
+}
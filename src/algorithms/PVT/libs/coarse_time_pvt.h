@@ -0,0 +1,101 @@
+/*!
+ * \file coarse_time_pvt.h
+ * \brief Coarse time GPS L1 C/A position fix from the code phases of a
+ * snapshot of samples
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_COARSE_TIME_PVT_H_
+#define GNSS_SDR_COARSE_TIME_PVT_H_
+
+#include <map>
+#include <vector>
+#include <armadillo>
+#include "ls_pvt.h"
+#include "gps_ephemeris.h"
+
+/*!
+ * \brief GPS L1 C/A position fix from the code phases of a snapshot of a
+ * few milliseconds, without tracking nor navigation bits
+ *
+ * The code phase of a satellite only gives its pseudorange modulo the
+ * 1 ms of a C/A code, and the time of the snapshot is only known to a few
+ * seconds (from the assistance data or the system clock). The whole
+ * milliseconds are restored from the ranges that the ephemeris predict at
+ * an approximate position, which must be within about 100 km, and the
+ * error of the approximate time is estimated as a fifth unknown from the
+ * range rates of the satellites. The fix is then refined by
+ * leastSquarePos() with the satellites at the estimated time.
+ */
+class Coarse_Time_Pvt : public Ls_Pvt
+{
+public:
+    Coarse_Time_Pvt();
+
+    /*!
+     * \brief Solves the position of the snapshot
+     *
+     * \param[in] code_phases_s  By PRN, receiver time of the start of a code period, from
+     *                           the first sample of the snapshot, modulo 1 ms [s]
+     * \param[in] approx_time_s  Approximate GPS time of week of the first sample [s]
+     * \param[in] approx_pos     Approximate receiver position in ECEF system [X; Y; Z] [m]
+     * \return true if the fix converged. It needs five satellites with
+     * ephemeris, or four if approx_time_s is exact to a few ms.
+     */
+    bool get_PVT(const std::map<int, double> & code_phases_s, double approx_time_s, const arma::vec & approx_pos);
+
+    std::map<int, Gps_Ephemeris> gps_ephemeris_map; //!< Assistance ephemeris, by PRN
+
+    double d_time_error_s; //!< Estimated error of the approximate time of the last fix [s]
+    double d_GPS_time_s;   //!< Corrected GPS time of week of the first sample of the last fix [s]
+
+private:
+    /*
+     * Pseudorange of the satellite of eph seen at x at time t, without the
+     * receiver clock, with the unit vector from x to the satellite and its
+     * range rate. Leaves the satellite position of eph at its transmit time.
+     */
+    double predicted_pseudorange(Gps_Ephemeris & eph, const arma::vec & x, double t, arma::vec & los, double & range_rate);
+
+    /*
+     * Restores the whole milliseconds of the pseudoranges d_pseudoranges
+     * from the code phases, with the predictions at d_state
+     */
+    void resolve_milliseconds(const std::vector<double> & code_phases_s, double approx_time_s);
+
+    /*
+     * Gauss-Newton iterations of d_state; returns the largest residual [m],
+     * or a negative value if they failed
+     */
+    double solve_state(double approx_time_s, bool estimate_time);
+
+    std::vector<Gps_Ephemeris*> d_ephemeris; // of the observations of the fix
+    arma::vec d_pseudoranges;                // [m]
+    arma::vec::fixed<5> d_state;             // [X, Y, Z, clock bias, time error] [m], [s]
+};
+
+#endif
@@ -0,0 +1,128 @@
+/*!
+ * \file dgps_corrections.cc
+ * \brief Pseudorange corrections computed from the observations of a
+ * reference station
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "dgps_corrections.h"
+#include <cmath>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+namespace
+{
+const double LIGHT_MS_M = GPS_C_m_s * 1e-3; // one light millisecond [m]
+const double HALF_WEEK_S = 302400.0;
+}
+
+
+Dgps_Corrections::Dgps_Corrections()
+{
+    d_max_age_s = 10.0;
+    d_station_valid = false;
+    d_station = Rtcm_Reference_Station();
+    d_epoch_valid[0] = false;
+    d_epoch_valid[1] = false;
+}
+
+
+void Dgps_Corrections::update(const Rtcm_Corrections & corrections)
+{
+    if (corrections.content == Rtcm_Corrections::STATION)
+        {
+            if (!d_station_valid or d_station.station_id != corrections.station.station_id)
+                {
+                    LOG(INFO) << "DGPS reference station " << corrections.station.station_id << " at ECEF ("
+                              << corrections.station.ecef_x_m << ", " << corrections.station.ecef_y_m << ", "
+                              << corrections.station.ecef_z_m << ") [m]";
+                }
+            d_station = corrections.station;
+            d_station_valid = true;
+        }
+    else if (corrections.content == Rtcm_Corrections::OBSERVATIONS)
+        {
+            const int index = corrections.epoch.system == 'G' ? 0 : 1;
+            d_epoch[index] = corrections.epoch;
+            d_epoch_valid[index] = true;
+        }
+}
+
+
+const Rtcm_Observation* Dgps_Corrections::find(char system, unsigned int prn, double rx_time_s, double & epoch_s) const
+{
+    const int index = system == 'G' ? 0 : 1;
+    if (!d_station_valid or !d_epoch_valid[index] or d_epoch[index].station_id != d_station.station_id)
+        {
+            return 0;
+        }
+    const Rtcm_Observation_Epoch & epoch = d_epoch[index];
+    double age_s = rx_time_s - epoch.tow_s;
+    if (age_s < -HALF_WEEK_S)
+        {
+            age_s += 2.0 * HALF_WEEK_S;
+        }
+    else if (age_s > HALF_WEEK_S)
+        {
+            age_s -= 2.0 * HALF_WEEK_S;
+        }
+    if (std::fabs(age_s) > d_max_age_s)
+        {
+            return 0;
+        }
+    epoch_s = epoch.tow_s;
+    for (unsigned int i = 0; i < epoch.count; i++)
+        {
+            if (epoch.observations[i].prn == prn)
+                {
+                    return &epoch.observations[i];
+                }
+        }
+    return 0;
+}
+
+
+double Dgps_Corrections::range_from_station(double sat_x, double sat_y, double sat_z) const
+{
+    double dx = sat_x - d_station.ecef_x_m;
+    double dy = sat_y - d_station.ecef_y_m;
+    const double dz = sat_z - d_station.ecef_z_m;
+    const double omegatau = OMEGA_EARTH_DOT * std::sqrt(dx * dx + dy * dy + dz * dz) / GPS_C_m_s;
+    const double c = std::cos(omegatau);
+    const double s = std::sin(omegatau);
+    dx = c * sat_x + s * sat_y - d_station.ecef_x_m;
+    dy = -s * sat_x + c * sat_y - d_station.ecef_y_m;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+
+double Dgps_Corrections::whole_milliseconds(double pseudorange_m, double expected_m)
+{
+    const double fraction_m = std::fmod(pseudorange_m, LIGHT_MS_M);
+    return fraction_m + std::round((expected_m - fraction_m) / LIGHT_MS_M) * LIGHT_MS_M;
+}
@@ -0,0 +1,117 @@
+/*!
+ * \file dgps_corrections.h
+ * \brief Pseudorange corrections computed from the observations of a
+ * reference station
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_DGPS_CORRECTIONS_H_
+#define GNSS_SDR_DGPS_CORRECTIONS_H_
+
+#include "GPS_L1_CA.h"
+#include "rtcm_corrections.h"
+
+/*!
+ * \brief Pseudorange corrections of the satellites from the code
+ * observations of a reference station of known position
+ *
+ * The correction of a satellite is its geometric range from the station,
+ * with the satellite position and clock of the ephemeris that the receiver
+ * uses itself, minus the pseudorange that the station measured: the orbit,
+ * satellite clock and atmospheric errors that the receiver shares with a
+ * nearby station cancel when it is added to the pseudorange of the
+ * receiver. The clock offset of the station is the same in all the
+ * corrections and goes into the clock offset of the fix.
+ */
+class Dgps_Corrections
+{
+public:
+    Dgps_Corrections();
+
+    void set_max_age(double max_age_s) { d_max_age_s = max_age_s; }
+
+    /*!
+     * \brief Keeps the last observations of each GNSS and the last position of the station
+     */
+    void update(const Rtcm_Corrections & corrections);
+
+    bool has_station() const { return d_station_valid; }
+
+    /*!
+     * \brief Correction to add to the pseudorange of satellite prn of system
+     * ('G' or 'E') received at rx_time_s, if the station observed it in the
+     * last max age seconds
+     *
+     * Leaves the satellite position of eph (d_satpos_X, d_satpos_Y, d_satpos_Z)
+     * at the time of transmission of the observation of the station.
+     * \param[in] rx_time_s  Receiver time of the pseudorange, in the time of week of the GNSS [s]
+     * \param[out] correction_m  Correction of the pseudorange [m]
+     */
+    template<typename Ephemeris>
+    bool correction(char system, unsigned int prn, Ephemeris & eph, double rx_time_s, double & correction_m) const
+    {
+        double epoch_s;
+        const Rtcm_Observation* obs = find(system, prn, rx_time_s, epoch_s);
+        if (obs == 0)
+            {
+                return false;
+            }
+        // iterate the time of transmission, from a nominal travel time if the
+        // observation leaves out the whole milliseconds
+        double pseudorange_m = obs->ambiguity_known ? obs->pseudorange_m : 0.075 * GPS_C_m_s;
+        double range_m = 0.0;
+        double clock_bias_s = 0.0;
+        for (int i = 0; i < 2; i++)
+            {
+                const double tx_time_s = epoch_s - pseudorange_m / GPS_C_m_s;
+                clock_bias_s = eph.sv_clock_drift(tx_time_s);
+                eph.satellitePosition(tx_time_s - clock_bias_s);
+                range_m = range_from_station(eph.d_satpos_X, eph.d_satpos_Y, eph.d_satpos_Z);
+                pseudorange_m = obs->ambiguity_known ? obs->pseudorange_m
+                                                     : whole_milliseconds(obs->pseudorange_m, range_m - clock_bias_s * GPS_C_m_s);
+            }
+        correction_m = range_m - (pseudorange_m + clock_bias_s * GPS_C_m_s);
+        return true;
+    }
+
+private:
+    const Rtcm_Observation* find(char system, unsigned int prn, double rx_time_s, double & epoch_s) const;
+
+    // distance from the station to the satellite at sat_*, with the Earth rotation during the travel time [m]
+    double range_from_station(double sat_x, double sat_y, double sat_z) const;
+
+    // pseudorange_m modulo one light millisecond plus the whole light milliseconds closest to expected_m [m]
+    static double whole_milliseconds(double pseudorange_m, double expected_m);
+
+    double d_max_age_s;
+    bool d_station_valid;
+    Rtcm_Reference_Station d_station;
+    bool d_epoch_valid[2];
+    Rtcm_Observation_Epoch d_epoch[2]; // GPS, Galileo
+};
+
+#endif
@@ -36,6 +36,23 @@
 
 using google::LogMessage;
 
+namespace
+{
+Dump_Schema pvt_dump_schema()
+{
+    Dump_Schema schema("galileo_e1_ls_pvt");
+    schema.add<double>("Galileo_time_s")
+          .add<double>("ECEF_X_m")
+          .add<double>("ECEF_Y_m")
+          .add<double>("ECEF_Z_m")
+          .add<double>("clock_offset")
+          .add<double>("latitude_deg")
+          .add<double>("longitude_deg")
+          .add<double>("height_m");
+    return schema;
+}
+}
+
 galileo_e1_ls_pvt::galileo_e1_ls_pvt(int nchannels, std::string dump_filename, bool flag_dump_to_file) : Ls_Pvt()
 {
     // init empty ephemeris for all the available GNSS channels
@@ -51,16 +68,14 @@ galileo_e1_ls_pvt::galileo_e1_ls_pvt(int nchannels, std::string dump_filename, b
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    if (d_dump_file.open(d_dump_filename, pvt_dump_schema()))
+                        {
                             LOG(INFO) << "PVT lib dump enabled Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (const std::ifstream::failure &e)
-                    {
-                            LOG(WARNING) << "Exception opening PVT lib dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "Cannot open PVT lib dump file " << d_dump_filename;
+                        }
                 }
         }
 }
@@ -74,9 +89,9 @@ galileo_e1_ls_pvt::~galileo_e1_ls_pvt()
 
 
 
-bool galileo_e1_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map, double galileo_current_time, bool flag_averaging)
+bool galileo_e1_ls_pvt::get_PVT(const std::map<int,Gnss_Synchro> & gnss_pseudoranges_map, double galileo_current_time, bool flag_averaging)
 {
-    std::map<int,Gnss_Synchro>::iterator gnss_pseudoranges_iter;
+    std::map<int,Gnss_Synchro>::const_iterator gnss_pseudoranges_iter;
     std::map<int,Galileo_Ephemeris>::iterator galileo_ephemeris_iter;
     int valid_pseudoranges = gnss_pseudoranges_map.size();
 
@@ -157,14 +172,19 @@ bool galileo_e1_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map
     d_valid_observations = valid_obs;
     LOG(INFO) << "Galileo PVT: valid observations=" << valid_obs;
 
-    if (valid_obs >= 4)
+    if (valid_obs >= 4 or (kalman_filter_running() and valid_obs > 0))
         {
             arma::vec mypos;
             DLOG(INFO) << "satpos=" << satpos;
             DLOG(INFO) << "obs="<< obs;
             DLOG(INFO) << "W=" << W;
 
-            mypos = leastSquarePos(satpos, obs, W);
+            mypos = solvePos(satpos, obs, W, galileo_current_time);
+            if (mypos.is_empty())
+                {
+                    b_valid_position = false;
+                    return false;
+                }
 
             // Compute Gregorian time
             utc = galileo_utc_model.GST_to_UTC_time(GST, Galileo_week_number);
@@ -181,6 +201,7 @@ bool galileo_e1_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map
             //ToDo: Find an Observables/PVT random bug with some satellite configurations that gives an erratic PVT solution (i.e. height>50 km)
             if (d_height_m > 50000)
                 {
+                    reset_warm_start();
                     b_valid_position = false;
                     return false;
                 }
@@ -195,38 +216,22 @@ bool galileo_e1_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map
             if(d_flag_dump_enabled == true)
                 {
                     // MULTIPLEXED FILE RECORDING - Record results to file
-                    try
-                    {
-                            double tmp_double;
-                            //  PVT GPS time
-                            tmp_double = galileo_current_time;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // ECEF User Position East [m]
-                            tmp_double = mypos(0);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // ECEF User Position North [m]
-                            tmp_double = mypos(1);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // ECEF User Position Up [m]
-                            tmp_double = mypos(2);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // User clock offset [s]
-                            tmp_double = mypos(3);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // GEO user position Latitude [deg]
-                            tmp_double = d_latitude_d;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // GEO user position Longitude [deg]
-                            tmp_double = d_longitude_d;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // GEO user position Height [m]
-                            tmp_double = d_height_m;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                    }
-                    catch (const std::ifstream::failure& e)
-                    {
-                            LOG(WARNING) << "Exception writing PVT LS dump file "<< e.what();
-                    }
+                    //  PVT GPS time
+                    d_dump_file.put<double>(galileo_current_time);
+                    // ECEF User Position East [m]
+                    d_dump_file.put<double>(mypos(0));
+                    // ECEF User Position North [m]
+                    d_dump_file.put<double>(mypos(1));
+                    // ECEF User Position Up [m]
+                    d_dump_file.put<double>(mypos(2));
+                    // User clock offset [s]
+                    d_dump_file.put<double>(mypos(3));
+                    // GEO user position Latitude [deg]
+                    d_dump_file.put<double>(d_latitude_d);
+                    // GEO user position Longitude [deg]
+                    d_dump_file.put<double>(d_longitude_d);
+                    // GEO user position Height [m]
+                    d_dump_file.put<double>(d_height_m);
                 }
 
             // MOVING AVERAGE PVT
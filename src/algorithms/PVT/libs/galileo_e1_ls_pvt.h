@@ -41,6 +41,7 @@
 #include "gnss_synchro.h"
 #include "galileo_ephemeris.h"
 #include "galileo_utc_model.h"
+#include "dump_writer.h"
 
 
 /*!
@@ -52,7 +53,7 @@ public:
     galileo_e1_ls_pvt(int nchannels,std::string dump_filename, bool flag_dump_to_file);
     ~galileo_e1_ls_pvt();
 
-    bool get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map, double galileo_current_time, bool flag_averaging);
+    bool get_PVT(const std::map<int,Gnss_Synchro> & gnss_pseudoranges_map, double galileo_current_time, bool flag_averaging);
 
     int d_nchannels;  //!< Number of available channels for positioning
 
@@ -68,7 +69,7 @@ public:
     bool d_flag_averaging;
 
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
 };
 
 #endif
@@ -31,14 +31,16 @@
 
 
 #include "geojson_printer.h"
+#include <algorithm>
+#include <cstdio>
 #include <ctime>
-#include <iomanip>
-#include <sstream>
 #include <glog/logging.h>
 
 GeoJSON_Printer::GeoJSON_Printer()
 {
-    first_pos = true;
+    decimation_ = 1;
+    rotate_period_s_ = 0.0;
+    positions_ = 0;
 }
 
 
@@ -50,78 +52,42 @@ GeoJSON_Printer::~GeoJSON_Printer ()
 
 
 bool GeoJSON_Printer::set_headers(std::string filename, bool time_tag_name)
+{
+    base_filename_ = filename;
+    return open_file(time_tag_name);
+}
+
+
+bool GeoJSON_Printer::open_file(bool time_tag_name)
 {
     time_t rawtime;
-    struct tm * timeinfo;
     time ( &rawtime );
-    timeinfo = localtime ( &rawtime );
 
     if (time_tag_name)
         {
-            std::stringstream strm0;
-            const int year = timeinfo->tm_year - 100;
-            strm0 << year;
-            const int month = timeinfo->tm_mon + 1;
-            if(month < 10)
-                {
-                    strm0 << "0";
-                }
-            strm0 << month;
-            const int day = timeinfo->tm_mday;
-            if(day < 10)
-                {
-                    strm0 << "0";
-                }
-            strm0 << day << "_";
-            const int hour = timeinfo->tm_hour;
-            if(hour < 10)
-                {
-                    strm0 << "0";
-                }
-            strm0 << hour;
-            const int min = timeinfo->tm_min;
-            if(min < 10)
-                {
-                    strm0 << "0";
-                }
-            strm0 << min;
-            const int sec = timeinfo->tm_sec;
-            if(sec < 10)
-                {
-                    strm0 << "0";
-                }
-            strm0 << sec;
-
-            filename_ = filename + "_" +  strm0.str() + ".geojson";
+            filename_ = base_filename_ + "_" + track_file_time_tag(rawtime) + ".geojson";
         }
     else
         {
-            filename_ = filename + ".geojson";
+            filename_ = base_filename_ + ".geojson";
         }
 
-    geojson_file.open(filename_.c_str());
-
-    first_pos = true;
-    if (geojson_file.is_open())
+    const std::string header = "{\n"
+            "  \"type\":  \"Feature\",\n"
+            "  \"properties\": {\n"
+            "       \"name\": \"Locations generated by GNSS-SDR\" \n"
+            "   },\n"
+            "  \"geometry\": {\n"
+            "      \"type\": \"MultiPoint\",\n"
+            "      \"coordinates\": [\n";
+    const std::string footer = "\n"
+            "       ]\n"
+            "   }\n"
+            "}\n";
+
+    if (geojson_file.open(filename_, header, footer, ",\n"))
         {
-            DLOG(INFO) << "GeoJSON printer writing on " << filename.c_str();
-
-            // Set iostream numeric format and precision
-            geojson_file.setf(geojson_file.fixed, geojson_file.floatfield);
-            geojson_file << std::setprecision(14);
-
-            // Writing the header
-            geojson_file << "{" << std::endl;
-            geojson_file << "  \"type\":  \"Feature\"," << std::endl;
-            geojson_file << "  \"properties\": {" << std::endl;
-            geojson_file << "       \"name\": \"Locations generated by GNSS-SDR\" " << std::endl;
-            geojson_file << "   }," << std::endl;
-
-
-            geojson_file << "  \"geometry\": {" << std::endl;
-            geojson_file << "      \"type\": \"MultiPoint\"," << std::endl;
-            geojson_file << "      \"coordinates\": [" << std::endl;
-
+            DLOG(INFO) << "GeoJSON printer writing on " << filename_;
             return true;
         }
     else
@@ -131,6 +97,13 @@ bool GeoJSON_Printer::set_headers(std::string filename, bool time_tag_name)
 }
 
 
+void GeoJSON_Printer::set_streaming(unsigned int decimation, double flush_period_s, double rotate_period_s)
+{
+    decimation_ = std::max(decimation, 1u);
+    rotate_period_s_ = rotate_period_s;
+    geojson_file.set_flush_policy(64 * 1024, flush_period_s);
+}
+
 
 bool GeoJSON_Printer::print_position(const std::shared_ptr<Pvt_Solution>& position, bool print_average_values)
 {
@@ -138,6 +111,11 @@ bool GeoJSON_Printer::print_position(const std::shared_ptr<Pvt_Solution>& positi
     double longitude;
     double height;
 
+    if (positions_++ % decimation_ != 0)
+        {
+            return geojson_file.is_open();
+        }
+
     std::shared_ptr<Pvt_Solution> position_ = position;
 
     if (print_average_values == false)
@@ -153,18 +131,17 @@ bool GeoJSON_Printer::print_position(const std::shared_ptr<Pvt_Solution>& positi
             height = position_->d_avg_height_m;
         }
 
+    if (geojson_file.is_open() && rotate_period_s_ > 0.0 && geojson_file.age_s() >= rotate_period_s_)
+        {
+            // the track goes on in a new file, with the time it starts in its name
+            close_file();
+            open_file(true);
+        }
     if (geojson_file.is_open())
         {
-            if (first_pos == true)
-                {
-                    geojson_file << "       [" << longitude << ", " << latitude << ", " << height << "]";
-                    first_pos = false;
-                }
-            else
-                {
-                    geojson_file << "," << std::endl;
-                    geojson_file << "       [" << longitude << ", " << latitude << ", " << height << "]";
-                }
+            char record[96];
+            std::snprintf(record, sizeof(record), "       [%.14f, %.14f, %.14f]", longitude, latitude, height);
+            geojson_file.append(record);
             return true;
         }
     else
@@ -179,14 +156,11 @@ bool GeoJSON_Printer::close_file()
 {
     if (geojson_file.is_open())
         {
-            geojson_file << std::endl;
-            geojson_file << "       ]" << std::endl;
-            geojson_file << "   }" << std::endl;
-            geojson_file << "}" << std::endl;
+            const bool empty = geojson_file.records() == 0;
             geojson_file.close();
 
             // if nothing is written, erase the file
-            if (first_pos == true)
+            if (empty)
                 {
                     if(remove(filename_.c_str()) != 0) LOG(INFO) << "Error deleting temporary file";
                 }
@@ -198,5 +172,3 @@ bool GeoJSON_Printer::close_file()
             return false;
         }
 }
-
-
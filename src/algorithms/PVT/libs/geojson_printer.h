@@ -33,27 +33,41 @@
 #ifndef GNSS_SDR_GEOJSON_PRINTER_H_
 #define GNSS_SDR_GEOJSON_PRINTER_H_
 
-#include <fstream>
 #include <memory>
 #include <string>
 #include "pvt_solution.h"
+#include "track_file_writer.h"
 
 
 /*!
  * \brief Prints PVT solutions in GeoJSON format file
  *
+ * The file is valid whenever it is read, see Track_File_Writer.
+ *
  * See http://geojson.org/geojson-spec.html
  */
 class GeoJSON_Printer
 {
 private:
-    std::ofstream geojson_file;
-    bool first_pos;
+    Track_File_Writer geojson_file;
     std::string filename_;
+    std::string base_filename_;
+    unsigned int decimation_;
+    double rotate_period_s_;
+    unsigned long long positions_;
+    bool open_file(bool time_tag_name);
 public:
     GeoJSON_Printer();
     ~GeoJSON_Printer();
     bool set_headers(std::string filename, bool time_tag_name = true);
+
+    /*!
+     * \brief Prints one position out of decimation, writes them every
+     * flush_period_s and starts a new file, with a time tag, every
+     * rotate_period_s (0 for never)
+     */
+    void set_streaming(unsigned int decimation, double flush_period_s, double rotate_period_s);
+
     bool print_position(const std::shared_ptr<Pvt_Solution>& position, bool print_average_values);
     bool close_file();
 };
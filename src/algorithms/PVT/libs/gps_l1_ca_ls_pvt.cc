@@ -36,6 +36,23 @@
 
 using google::LogMessage;
 
+namespace
+{
+Dump_Schema pvt_dump_schema()
+{
+    Dump_Schema schema("gps_l1_ca_ls_pvt");
+    schema.add<double>("GPS_time_s")
+          .add<double>("ECEF_X_m")
+          .add<double>("ECEF_Y_m")
+          .add<double>("ECEF_Z_m")
+          .add<double>("clock_offset")
+          .add<double>("latitude_deg")
+          .add<double>("longitude_deg")
+          .add<double>("height_m");
+    return schema;
+}
+}
+
 
 gps_l1_ca_ls_pvt::gps_l1_ca_ls_pvt(int nchannels, std::string dump_filename, bool flag_dump_to_file) : Ls_Pvt()
 {
@@ -52,16 +69,14 @@ gps_l1_ca_ls_pvt::gps_l1_ca_ls_pvt(int nchannels, std::string dump_filename, boo
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    if (d_dump_file.open(d_dump_filename, pvt_dump_schema()))
+                        {
                             LOG(INFO) << "PVT lib dump enabled Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (const std::ifstream::failure &e)
-                    {
-                            LOG(WARNING) << "Exception opening PVT lib dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "Cannot open PVT lib dump file " << d_dump_filename;
+                        }
                 }
         }
 }
@@ -76,15 +91,31 @@ gps_l1_ca_ls_pvt::~gps_l1_ca_ls_pvt()
 
 
 
-bool gps_l1_ca_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map, double GPS_current_time, bool flag_averaging)
+bool gps_l1_ca_ls_pvt::get_PVT(const std::map<int,Gnss_Synchro> & gnss_pseudoranges_map, double GPS_current_time, bool flag_averaging)
 {
-    std::map<int,Gnss_Synchro>::iterator gnss_pseudoranges_iter;
+    std::map<int,Gnss_Synchro>::const_iterator gnss_pseudoranges_iter;
     std::map<int,Gps_Ephemeris>::iterator gps_ephemeris_iter;
     int valid_pseudoranges = gnss_pseudoranges_map.size();
 
-    arma::mat W = arma::eye(valid_pseudoranges, valid_pseudoranges); //channels weights matrix
-    arma::vec obs = arma::zeros(valid_pseudoranges);                 // pseudoranges observation vector
-    arma::mat satpos = arma::zeros(3, valid_pseudoranges);           //satellite positions matrix
+    // the matrices of the fix use the memory of the arena, kept from one fix to the next
+    d_fix_arena.reset();
+    const arma::uword n = valid_pseudoranges;
+    arma::mat W(d_fix_arena.allocate<double>(n * n), n, n, false, true); //channels weights matrix
+    arma::vec obs(d_fix_arena.allocate<double>(n), n, false, true);        // pseudoranges observation vector
+    arma::mat satpos(d_fix_arena.allocate<double>(3 * n), 3, n, false, true); //satellite positions matrix
+    arma::mat satvel(d_fix_arena.allocate<double>(3 * n), 3, n, false, true); //satellite velocities matrix
+    arma::vec doppler(d_fix_arena.allocate<double>(n), n, false, true);    // carrier Doppler observation vector
+    arma::mat W_vel(d_fix_arena.allocate<double>(n * n), n, n, false, true); // Doppler weights matrix
+    arma::vec correction(d_fix_arena.allocate<double>(n), n, false, true); // differential corrections, NaN if none
+    W.eye();
+    obs.zeros();
+    satpos.zeros();
+    satvel.zeros();
+    doppler.zeros();
+    W_vel.zeros();
+    correction.fill(arma::datum::nan);
+    d_raim_prn.assign(valid_pseudoranges, 0);
+    double rx_timestamp_secs = 0.0;
 
     int GPS_week = 0;
     double utc = 0;
@@ -93,6 +124,7 @@ bool gps_l1_ca_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map,
 
     d_flag_averaging = flag_averaging;
     std::stringstream ss;
+    poll_corrections();
 
     // ********************************************************************************
     // ****** PREPARE THE LEAST SQUARES DATA (SV POSITIONS MATRIX AND OBS VECTORS) ****
@@ -122,9 +154,16 @@ bool gps_l1_ca_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map,
                     // 2- compute the clock drift using the clock model (broadcast) for this SV, including relativistic effect
                     SV_clock_bias_s = gps_ephemeris_iter->second.sv_clock_drift(Tx_time); //- gps_ephemeris_iter->second.d_TGD;
 
-                    // 3- compute the current ECEF position for this SV using corrected TX time
+                    // the differential correction moves the satellite position of the ephemeris, computed again below
+                    double correction_m;
+                    if (differential_input() and d_dgps.correction('G', gnss_pseudoranges_iter->second.PRN, gps_ephemeris_iter->second, GPS_current_time, correction_m))
+                        {
+                            correction(obs_counter) = correction_m;
+                        }
+
+                    // 3- compute the current ECEF position and velocity for this SV using corrected TX time
                     TX_time_corrected_s = Tx_time - SV_clock_bias_s;
-                    gps_ephemeris_iter->second.satellitePosition(TX_time_corrected_s);
+                    satvel.col(obs_counter) = satelliteVelocity(gps_ephemeris_iter->second, TX_time_corrected_s);
 
                     satpos(0, obs_counter) = gps_ephemeris_iter->second.d_satpos_X;
                     satpos(1, obs_counter) = gps_ephemeris_iter->second.d_satpos_Y;
@@ -132,6 +171,11 @@ bool gps_l1_ca_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map,
 
                     // 4- fill the observations vector with the corrected pseudoranges
                     obs(obs_counter) = gnss_pseudoranges_iter->second.Pseudorange_m + SV_clock_bias_s * GPS_C_m_s;
+                    // the Doppler noise variance is inversely proportional to the C/N0
+                    doppler(obs_counter) = gnss_pseudoranges_iter->second.Carrier_Doppler_hz;
+                    W_vel(obs_counter, obs_counter) = sqrt(pow(10.0, gnss_pseudoranges_iter->second.CN0_dB_hz / 10.0));
+                    d_raim_prn[obs_counter] = gnss_pseudoranges_iter->second.PRN;
+                    rx_timestamp_secs = gnss_pseudoranges_iter->second.Tracking_timestamp_secs;
                     d_visible_satellites_IDs[valid_obs] = gps_ephemeris_iter->second.i_satellite_PRN;
                     d_visible_satellites_CN0_dB[valid_obs] = gnss_pseudoranges_iter->second.CN0_dB_hz;
                     valid_obs++;
@@ -168,6 +212,10 @@ bool gps_l1_ca_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map,
         }
 
     d_pseudoranges  = ss.str();
+    if (differential_input())
+        {
+            valid_obs = apply_corrections(obs, W, correction);
+        }
 
     // ********************************************************************************
     // ****** SOLVE LEAST SQUARES******************************************************
@@ -175,14 +223,20 @@ bool gps_l1_ca_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map,
     d_valid_observations = valid_obs;
     LOG(INFO) << "(new)PVT: valid observations=" << valid_obs;
 
-    if (valid_obs >= 4)
+    if (valid_obs >= 4 or (kalman_filter_running() and valid_obs > 0))
         {
             arma::vec mypos;
             DLOG(INFO) << "satpos=" << satpos;
             DLOG(INFO) << "obs=" << obs;
             DLOG(INFO) << "W=" << W;
 
-            mypos = leastSquarePos(satpos, obs, W);
+            set_iono(gps_iono);
+            mypos = solvePos(satpos, obs, W, GPS_current_time);
+            if (mypos.is_empty())
+                {
+                    b_valid_position = false;
+                    return false;
+                }
             DLOG(INFO) << "(new)Position at TOW=" << GPS_current_time << " in ECEF (X,Y,Z) = " << mypos;
 
             cart2geo(static_cast<double>(mypos(0)), static_cast<double>(mypos(1)), static_cast<double>(mypos(2)), 4);
@@ -192,6 +246,7 @@ bool gps_l1_ca_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map,
             //ToDo: Find an Observables/PVT random bug with some satellite configurations that gives an erratic PVT solution (i.e. height>50 km)
             if (d_height_m > 50000)
                 {
+                    reset_warm_start();
                     b_valid_position = false;
                     return false;
                 }
@@ -218,42 +273,45 @@ bool gps_l1_ca_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map,
             // ###### Compute DOPs ########
             compute_DOP();
 
+            // ###### Compute the velocity and aid the tracking channels ########
+            arma::vec myvel;
+            if (valid_obs >= 4)
+                {
+                    myvel = leastSquareVel(satpos, satvel, mypos, doppler, W_vel);
+                }
+            if (!myvel.is_empty())
+                {
+                    d_rx_vel = myvel;
+                    publish_vector_tracking_aid(satpos, satvel, mypos, d_rx_vel, d_raim_prn, rx_timestamp_secs);
+                }
+
+            // ###### Doppler residuals, for the spoofing detector ########
+            d_doppler_residuals.reset();
+            if (!myvel.is_empty() or (d_doppler_static and valid_obs >= 2))
+                {
+                    d_doppler_residuals = dopplerResiduals(satpos, satvel, mypos, doppler, W_vel, d_rx_vel, d_doppler_static);
+                }
+
             // ######## LOG FILE #########
             if(d_flag_dump_enabled == true)
                 {
                     // MULTIPLEXED FILE RECORDING - Record results to file
-                    try
-                    {
-                            double tmp_double;
-                            //  PVT GPS time
-                            tmp_double = GPS_current_time;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // ECEF User Position East [m]
-                            tmp_double = mypos(0);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // ECEF User Position North [m]
-                            tmp_double = mypos(1);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // ECEF User Position Up [m]
-                            tmp_double = mypos(2);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // User clock offset [s]
-                            tmp_double = mypos(3);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // GEO user position Latitude [deg]
-                            tmp_double = d_latitude_d;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // GEO user position Longitude [deg]
-                            tmp_double = d_longitude_d;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // GEO user position Height [m]
-                            tmp_double = d_height_m;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                    }
-                    catch (const std::ifstream::failure &e)
-                    {
-                            LOG(WARNING) << "Exception writing PVT LS dump file " << e.what();
-                    }
+                    //  PVT GPS time
+                    d_dump_file.put<double>(GPS_current_time);
+                    // ECEF User Position East [m]
+                    d_dump_file.put<double>(mypos(0));
+                    // ECEF User Position North [m]
+                    d_dump_file.put<double>(mypos(1));
+                    // ECEF User Position Up [m]
+                    d_dump_file.put<double>(mypos(2));
+                    // User clock offset [s]
+                    d_dump_file.put<double>(mypos(3));
+                    // GEO user position Latitude [deg]
+                    d_dump_file.put<double>(d_latitude_d);
+                    // GEO user position Longitude [deg]
+                    d_dump_file.put<double>(d_longitude_d);
+                    // GEO user position Height [m]
+                    d_dump_file.put<double>(d_height_m);
                 }
 
             // MOVING AVERAGE PVT
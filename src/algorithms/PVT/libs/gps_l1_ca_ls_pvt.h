@@ -35,6 +35,7 @@
 #include <map>
 #include <string>
 #include "ls_pvt.h"
+#include "epoch_arena.h"
 #include "GPS_L1_CA.h"
 #include "gnss_synchro.h"
 #include "gps_ephemeris.h"
@@ -44,6 +45,7 @@
 #include "sbas_ionospheric_correction.h"
 #include "sbas_satellite_correction.h"
 #include "sbas_ephemeris.h"
+#include "dump_writer.h"
 
 
 /*!
@@ -55,7 +57,7 @@ public:
     gps_l1_ca_ls_pvt(int nchannels, std::string dump_filename, bool flag_dump_to_file);
     ~gps_l1_ca_ls_pvt();
 
-    bool get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map, double GPS_current_time, bool flag_averaging);
+    bool get_PVT(const std::map<int,Gnss_Synchro> & gnss_pseudoranges_map, double GPS_current_time, bool flag_averaging);
     int d_nchannels; //!< Number of available channels for positioning
 
     Gps_Navigation_Message* d_ephemeris;
@@ -75,9 +77,12 @@ public:
     bool d_flag_averaging;
 
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
 
     std::string d_pseudoranges;
+
+private:
+    Epoch_Arena d_fix_arena; // matrices of get_PVT
 };
 
 #endif
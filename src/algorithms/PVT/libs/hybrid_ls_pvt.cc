@@ -36,6 +36,23 @@
 
 using google::LogMessage;
 
+namespace
+{
+Dump_Schema pvt_dump_schema()
+{
+    Dump_Schema schema("hybrid_ls_pvt");
+    schema.add<double>("hybrid_time_s")
+          .add<double>("ECEF_X_m")
+          .add<double>("ECEF_Y_m")
+          .add<double>("ECEF_Z_m")
+          .add<double>("clock_offset")
+          .add<double>("latitude_deg")
+          .add<double>("longitude_deg")
+          .add<double>("height_m");
+    return schema;
+}
+}
+
 hybrid_ls_pvt::hybrid_ls_pvt(int nchannels, std::string dump_filename, bool flag_dump_to_file) : Ls_Pvt()
 {
     // init empty ephemeris for all the available GNSS channels
@@ -54,16 +71,14 @@ hybrid_ls_pvt::hybrid_ls_pvt(int nchannels, std::string dump_filename, bool flag
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    if (d_dump_file.open(d_dump_filename, pvt_dump_schema()))
+                        {
                             LOG(INFO) << "PVT lib dump enabled Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (const std::ifstream::failure &e)
-                    {
-                            LOG(WARNING) << "Exception opening PVT lib dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "Cannot open PVT lib dump file " << d_dump_filename;
+                        }
                 }
         }
 }
@@ -77,9 +92,9 @@ hybrid_ls_pvt::~hybrid_ls_pvt()
 }
 
 
-bool hybrid_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map, double hybrid_current_time, bool flag_averaging)
+bool hybrid_ls_pvt::get_PVT(const std::map<int,Gnss_Synchro> & gnss_pseudoranges_map, double hybrid_current_time, bool flag_averaging)
 {
-    std::map<int,Gnss_Synchro>::iterator gnss_pseudoranges_iter;
+    std::map<int,Gnss_Synchro>::const_iterator gnss_pseudoranges_iter;
     std::map<int,Galileo_Ephemeris>::iterator galileo_ephemeris_iter;
     std::map<int,Gps_Ephemeris>::iterator gps_ephemeris_iter;
     int valid_pseudoranges = gnss_pseudoranges_map.size();
@@ -87,6 +102,13 @@ bool hybrid_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map, do
     arma::mat W = arma::eye(valid_pseudoranges, valid_pseudoranges); // channels weights matrix
     arma::vec obs = arma::zeros(valid_pseudoranges);                 // pseudoranges observation vector
     arma::mat satpos = arma::zeros(3, valid_pseudoranges);           // satellite positions matrix
+    arma::mat satvel = arma::zeros(3, valid_pseudoranges);           // satellite velocities matrix
+    arma::vec doppler = arma::zeros(valid_pseudoranges);             // carrier Doppler observation vector
+    arma::mat W_vel = arma::zeros(valid_pseudoranges, valid_pseudoranges); // Doppler weights matrix
+    std::vector<unsigned int> gps_prn(valid_pseudoranges, 0);        // only the GPS channels are aided
+    arma::vec correction(valid_pseudoranges);                        // differential corrections, NaN if none
+    correction.fill(arma::datum::nan);
+    double rx_timestamp_secs = 0.0;
 
     int Galileo_week_number = 0;
     int GPS_week = 0;
@@ -97,6 +119,8 @@ bool hybrid_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map, do
     double SV_clock_bias_s = 0.0;
 
     d_flag_averaging = flag_averaging;
+    poll_corrections();
+    double correction_m;
 
     // ********************************************************************************
     // ****** PREPARE THE LEAST SQUARES DATA (SV POSITIONS MATRIX AND OBS VECTORS) ****
@@ -127,9 +151,15 @@ bool hybrid_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map, do
                             // 2- compute the clock drift using the clock model (broadcast) for this SV
                             SV_clock_bias_s = galileo_ephemeris_iter->second.sv_clock_drift(Tx_time);
 
-                            // 3- compute the current ECEF position for this SV using corrected TX time
+                            // the differential correction moves the satellite position of the ephemeris, computed again below
+                            if (differential_input() and d_dgps.correction('E', gnss_pseudoranges_iter->second.PRN, galileo_ephemeris_iter->second, hybrid_current_time, correction_m))
+                                {
+                                    correction(obs_counter) = correction_m;
+                                }
+
+                            // 3- compute the current ECEF position and velocity for this SV using corrected TX time
                             TX_time_corrected_s = Tx_time - SV_clock_bias_s;
-                            galileo_ephemeris_iter->second.satellitePosition(TX_time_corrected_s);
+                            satvel.col(obs_counter) = satelliteVelocity(galileo_ephemeris_iter->second, TX_time_corrected_s);
 
                             satpos(0,obs_counter) = galileo_ephemeris_iter->second.d_satpos_X;
                             satpos(1,obs_counter) = galileo_ephemeris_iter->second.d_satpos_Y;
@@ -137,6 +167,9 @@ bool hybrid_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map, do
 
                             // 5- fill the observations vector with the corrected pseudoranges
                             obs(obs_counter) = gnss_pseudoranges_iter->second.Pseudorange_m + SV_clock_bias_s * GALILEO_C_m_s;
+                            doppler(obs_counter) = gnss_pseudoranges_iter->second.Carrier_Doppler_hz;
+                            W_vel(obs_counter, obs_counter) = sqrt(pow(10.0, gnss_pseudoranges_iter->second.CN0_dB_hz / 10.0));
+                            rx_timestamp_secs = gnss_pseudoranges_iter->second.Tracking_timestamp_secs;
                             d_visible_satellites_IDs[valid_obs] = galileo_ephemeris_iter->second.i_satellite_PRN;
                             d_visible_satellites_CN0_dB[valid_obs] = gnss_pseudoranges_iter->second.CN0_dB_hz;
                             valid_obs++;
@@ -182,9 +215,15 @@ bool hybrid_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map, do
                             // 2- compute the clock drift using the clock model (broadcast) for this SV
                             SV_clock_bias_s = gps_ephemeris_iter->second.sv_clock_drift(Tx_time);
 
-                            // 3- compute the current ECEF position for this SV using corrected TX time
+                            // the differential correction moves the satellite position of the ephemeris, computed again below
+                            if (differential_input() and d_dgps.correction('G', gnss_pseudoranges_iter->second.PRN, gps_ephemeris_iter->second, hybrid_current_time, correction_m))
+                                {
+                                    correction(obs_counter) = correction_m;
+                                }
+
+                            // 3- compute the current ECEF position and velocity for this SV using corrected TX time
                             TX_time_corrected_s = Tx_time - SV_clock_bias_s;
-                            gps_ephemeris_iter->second.satellitePosition(TX_time_corrected_s);
+                            satvel.col(obs_counter) = satelliteVelocity(gps_ephemeris_iter->second, TX_time_corrected_s);
 
                             satpos(0, obs_counter) = gps_ephemeris_iter->second.d_satpos_X;
                             satpos(1, obs_counter) = gps_ephemeris_iter->second.d_satpos_Y;
@@ -192,6 +231,10 @@ bool hybrid_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map, do
 
                             // 5- fill the observations vector with the corrected pseudorranges
                             obs(obs_counter) = gnss_pseudoranges_iter->second.Pseudorange_m + SV_clock_bias_s * GPS_C_m_s;
+                            doppler(obs_counter) = gnss_pseudoranges_iter->second.Carrier_Doppler_hz;
+                            W_vel(obs_counter, obs_counter) = sqrt(pow(10.0, gnss_pseudoranges_iter->second.CN0_dB_hz / 10.0));
+                            gps_prn[obs_counter] = gnss_pseudoranges_iter->second.PRN;
+                            rx_timestamp_secs = gnss_pseudoranges_iter->second.Tracking_timestamp_secs;
                             d_visible_satellites_IDs[valid_obs] = gps_ephemeris_iter->second.i_satellite_PRN;
                             d_visible_satellites_CN0_dB[valid_obs] = gnss_pseudoranges_iter->second.CN0_dB_hz;
                             valid_obs++;
@@ -219,19 +262,30 @@ bool hybrid_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map, do
     // ********************************************************************************
     // ****** SOLVE LEAST SQUARES******************************************************
     // ********************************************************************************
+    if (differential_input())
+        {
+            valid_obs = apply_corrections(obs, W, correction);
+        }
     d_valid_observations = valid_obs;
+    d_raim_prn = gps_prn;
     d_valid_GPS_obs = valid_obs_GPS_counter;
     d_valid_GAL_obs = valid_obs_GALILEO_counter;
     LOG(INFO) << "HYBRID PVT: valid observations=" << valid_obs;
 
-    if(valid_obs >= 4)
+    if (valid_obs >= 4 or (kalman_filter_running() and valid_obs > 0))
         {
             arma::vec mypos;
             DLOG(INFO) << "satpos=" << satpos;
             DLOG(INFO) << "obs=" << obs;
             DLOG(INFO) << "W=" << W;
 
-            mypos = leastSquarePos(satpos, obs, W);
+            set_iono(gps_iono);
+            mypos = solvePos(satpos, obs, W, hybrid_current_time);
+            if (mypos.is_empty())
+                {
+                    b_valid_position = false;
+                    return false;
+                }
             d_rx_dt_m = mypos(3)/GPS_C_m_s; // Convert RX time offset from meters to seconds
             double secondsperweek = 604800.0;
             // Compute GST and Gregorian time
@@ -256,6 +310,7 @@ bool hybrid_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map, do
             //ToDo: Find an Observables/PVT random bug with some satellite configurations that gives an erratic PVT solution (i.e. height>50 km)
             if (d_height_m > 50000)
                 {
+                    reset_warm_start();
                     b_valid_position = false;
                     LOG(INFO) << "Hybrid Position at " << boost::posix_time::to_simple_string(p_time)
                     << " is Lat = " << d_latitude_d << " [deg], Long = " << d_longitude_d
@@ -270,42 +325,38 @@ bool hybrid_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map, do
             // ###### Compute DOPs ########
             hybrid_ls_pvt::compute_DOP();
 
+            // ###### Compute the velocity and aid the tracking channels ########
+            arma::vec myvel;
+            if (valid_obs >= 4)
+                {
+                    myvel = leastSquareVel(satpos, satvel, mypos, doppler, W_vel);
+                }
+            if (!myvel.is_empty())
+                {
+                    d_rx_vel = myvel;
+                    publish_vector_tracking_aid(satpos, satvel, mypos, d_rx_vel, gps_prn, rx_timestamp_secs);
+                }
+
             // ######## LOG FILE #########
             if(d_flag_dump_enabled == true)
                 {
                     // MULTIPLEXED FILE RECORDING - Record results to file
-                    try
-                    {
-                            double tmp_double;
-                            //  PVT GPS time
-                            tmp_double = hybrid_current_time;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // ECEF User Position East [m]
-                            tmp_double = mypos(0);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // ECEF User Position North [m]
-                            tmp_double = mypos(1);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // ECEF User Position Up [m]
-                            tmp_double = mypos(2);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // User clock offset [s]
-                            tmp_double = mypos(3);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // GEO user position Latitude [deg]
-                            tmp_double = d_latitude_d;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // GEO user position Longitude [deg]
-                            tmp_double = d_longitude_d;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            // GEO user position Height [m]
-                            tmp_double = d_height_m;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                    }
-                    catch (const std::ifstream::failure& e)
-                    {
-                            LOG(WARNING) << "Exception writing PVT LS dump file " << e.what();
-                    }
+                    //  PVT GPS time
+                    d_dump_file.put<double>(hybrid_current_time);
+                    // ECEF User Position East [m]
+                    d_dump_file.put<double>(mypos(0));
+                    // ECEF User Position North [m]
+                    d_dump_file.put<double>(mypos(1));
+                    // ECEF User Position Up [m]
+                    d_dump_file.put<double>(mypos(2));
+                    // User clock offset [s]
+                    d_dump_file.put<double>(mypos(3));
+                    // GEO user position Latitude [deg]
+                    d_dump_file.put<double>(d_latitude_d);
+                    // GEO user position Longitude [deg]
+                    d_dump_file.put<double>(d_longitude_d);
+                    // GEO user position Height [m]
+                    d_dump_file.put<double>(d_height_m);
                 }
 
             // MOVING AVERAGE PVT
@@ -44,6 +44,7 @@
 #include "galileo_utc_model.h"
 #include "gps_ephemeris.h"
 #include "gps_utc_model.h"
+#include "dump_writer.h"
 
 
 /*!
@@ -55,7 +56,7 @@ public:
     hybrid_ls_pvt(int nchannels,std::string dump_filename, bool flag_dump_to_file);
     ~hybrid_ls_pvt();
 
-    bool get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map, double hybrid_current_time, bool flag_averaging);
+    bool get_PVT(const std::map<int,Gnss_Synchro> & gnss_pseudoranges_map, double hybrid_current_time, bool flag_averaging);
     int d_nchannels;                                        //!< Number of available channels for positioning
     int d_valid_GPS_obs;                                    //!< Number of valid GPS pseudorange observations (valid GPS satellites) -- used for hybrid configuration
     int d_valid_GAL_obs;                                    //!< Number of valid GALILEO pseudorange observations (valid GALILEO satellites) -- used for hybrid configuration
@@ -80,7 +81,7 @@ public:
     bool d_flag_averaging;
 
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
 };
 
 #endif
@@ -30,94 +30,68 @@
  */
 
 #include "kml_printer.h"
+#include <algorithm>
+#include <cstdio>
 #include <ctime>
-#include <sstream>
 #include <glog/logging.h>
 
 using google::LogMessage;
 
 bool Kml_Printer::set_headers(std::string filename,  bool time_tag_name)
 {
+    base_filename = filename;
+    return open_file(time_tag_name);
+}
+
 
+bool Kml_Printer::open_file(bool time_tag_name)
+{
     time_t rawtime;
-    struct tm * timeinfo;
     time ( &rawtime );
-    timeinfo = localtime ( &rawtime );
     if (time_tag_name)
         {
-
-
-            std::stringstream strm0;
-            const int year = timeinfo->tm_year - 100;
-            strm0 << year;
-            const int month = timeinfo->tm_mon + 1;
-            if(month < 10)
-                {
-                    strm0 << "0";
-                }
-            strm0 << month;
-            const int day = timeinfo->tm_mday;
-            if(day < 10)
-                {
-                    strm0 << "0";
-                }
-            strm0 << day << "_";
-            const int hour = timeinfo->tm_hour;
-            if(hour < 10)
-                {
-                    strm0 << "0";
-                }
-            strm0 << hour;
-            const int min = timeinfo->tm_min;
-            if(min < 10)
-                {
-                    strm0 << "0";
-                }
-            strm0 << min;
-            const int sec = timeinfo->tm_sec;
-            if(sec < 10)
-                {
-                    strm0 << "0";
-                }
-            strm0 << sec;
-
-            kml_filename = filename + "_" +  strm0.str() + ".kml";
+            kml_filename = base_filename + "_" + track_file_time_tag(rawtime) + ".kml";
         }
     else
         {
-            kml_filename = filename + ".kml";
+            kml_filename = base_filename + ".kml";
         }
-    kml_file.open(kml_filename.c_str());
-    if (kml_file.is_open())
+    char created[32];
+    struct tm timeinfo;
+    asctime_r(localtime_r(&rawtime, &timeinfo), created);
+    const std::string header = std::string("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n")
+            + "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n"
+            + "    <Document>\n"
+            + "    <name>GNSS Track</name>\n"
+            + "    <description>GNSS-SDR Receiver position log file created at " + created
+            + "    </description>\n"
+            + "<Style id=\"yellowLineGreenPoly\">\n"
+            + " <LineStyle>\n"
+            + "     <color>7f00ffff</color>\n"
+            + "        <width>1</width>\n"
+            + "    </LineStyle>\n"
+            + "<PolyStyle>\n"
+            + "    <color>7f00ff00</color>\n"
+            + "</PolyStyle>\n"
+            + "</Style>\n"
+            + "<Placemark>\n"
+            + "<name>GNSS-SDR PVT</name>\n"
+            + "<description>GNSS-SDR position log</description>\n"
+            + "<styleUrl>#yellowLineGreenPoly</styleUrl>\n"
+            + "<LineString>\n"
+            + "<extrude>0</extrude>\n"
+            + "<tessellate>1</tessellate>\n"
+            + "<altitudeMode>absolute</altitudeMode>\n"
+            + "<coordinates>\n";
+    const std::string footer = "\n</coordinates>\n"
+            "</LineString>\n"
+            "</Placemark>\n"
+            "</Document>\n"
+            "</kml>\n";
+    positions_printed = false;
+    if (kml_file.open(kml_filename, header, footer, "\n"))
         {
-            DLOG(INFO) << "KML printer writing on " << filename.c_str();
-            // Set iostream numeric format and precision
-            kml_file.setf(kml_file.fixed, kml_file.floatfield);
-            kml_file << std::setprecision(14);
-            kml_file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl
-                    << "<kml xmlns=\"http://www.opengis.net/kml/2.2\">" << std::endl
-                    << "    <Document>" << std::endl
-                    << "    <name>GNSS Track</name>" << std::endl
-                    << "    <description>GNSS-SDR Receiver position log file created at " << asctime (timeinfo)
-                    << "    </description>" << std::endl
-                    << "<Style id=\"yellowLineGreenPoly\">" << std::endl
-                    << " <LineStyle>" << std::endl
-                    << "     <color>7f00ffff</color>" << std::endl
-                    << "        <width>1</width>" << std::endl
-                    << "    </LineStyle>" << std::endl
-                    << "<PolyStyle>" << std::endl
-                    << "    <color>7f00ff00</color>" << std::endl
-                    << "</PolyStyle>" << std::endl
-                    << "</Style>" << std::endl
-                    << "<Placemark>" << std::endl
-                    << "<name>GNSS-SDR PVT</name>" << std::endl
-                    << "<description>GNSS-SDR position log</description>" << std::endl
-                    << "<styleUrl>#yellowLineGreenPoly</styleUrl>" << std::endl
-                    << "<LineString>" << std::endl
-                    << "<extrude>0</extrude>" << std::endl
-                    << "<tessellate>1</tessellate>" << std::endl
-                    << "<altitudeMode>absolute</altitudeMode>" << std::endl
-                    << "<coordinates>" << std::endl;
+            DLOG(INFO) << "KML printer writing on " << kml_filename;
             return true;
         }
     else
@@ -127,6 +101,13 @@ bool Kml_Printer::set_headers(std::string filename,  bool time_tag_name)
 }
 
 
+void Kml_Printer::set_streaming(unsigned int decimation_, double flush_period_s, double rotate_period_s_)
+{
+    decimation = std::max(decimation_, 1u);
+    rotate_period_s = rotate_period_s_;
+    kml_file.set_flush_policy(64 * 1024, flush_period_s);
+}
+
 
 bool Kml_Printer::print_position(const std::shared_ptr<Pvt_Solution>& position, bool print_average_values)
 {
@@ -134,7 +115,10 @@ bool Kml_Printer::print_position(const std::shared_ptr<Pvt_Solution>& position,
     double longitude;
     double height;
 
-    positions_printed = true;
+    if (positions++ % decimation != 0)
+        {
+            return kml_file.is_open();
+        }
 
     std::shared_ptr<Pvt_Solution> position_ = position;
 
@@ -151,9 +135,18 @@ bool Kml_Printer::print_position(const std::shared_ptr<Pvt_Solution>& position,
             height = position_->d_avg_height_m;
         }
 
+    if (kml_file.is_open() && rotate_period_s > 0.0 && kml_file.age_s() >= rotate_period_s)
+        {
+            // the track goes on in a new file, with the time it starts in its name
+            close_file();
+            open_file(true);
+        }
     if (kml_file.is_open())
         {
-            kml_file << longitude << "," << latitude << "," << height << std::endl;
+            char record[96];
+            std::snprintf(record, sizeof(record), "%.14f,%.14f,%.14f", longitude, latitude, height);
+            kml_file.append(record);
+            positions_printed = true;
             return true;
         }
     else
@@ -167,12 +160,6 @@ bool Kml_Printer::close_file()
 {
     if (kml_file.is_open())
         {
-
-            kml_file << "</coordinates>" << std::endl
-                     << "</LineString>" << std::endl
-                     << "</Placemark>" << std::endl
-                     << "</Document>" << std::endl
-                     << "</kml>";
             kml_file.close();
             return true;
         }
@@ -187,6 +174,9 @@ bool Kml_Printer::close_file()
 Kml_Printer::Kml_Printer ()
 {
     positions_printed = false;
+    decimation = 1;
+    rotate_period_s = 0.0;
+    positions = 0;
 }
 
 
@@ -199,4 +189,3 @@ Kml_Printer::~Kml_Printer ()
             if(remove(kml_filename.c_str()) != 0) LOG(INFO) << "Error deleting temporary KML file";
         }
 }
-
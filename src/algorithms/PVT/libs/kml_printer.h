@@ -33,27 +33,41 @@
 #ifndef GNSS_SDR_KML_PRINTER_H_
 #define GNSS_SDR_KML_PRINTER_H_
 
-#include <iostream>
-#include <fstream>
 #include <memory>
 #include <string>
 #include "pvt_solution.h"
+#include "track_file_writer.h"
 
 /*!
  * \brief Prints PVT information to OGC KML format file (can be viewed with Google Earth)
  *
+ * The file is valid whenever it is read, see Track_File_Writer.
+ *
  * See http://www.opengeospatial.org/standards/kml
  */
 class Kml_Printer
 {
 private:
-    std::ofstream kml_file;
+    Track_File_Writer kml_file;
     bool positions_printed;
     std::string kml_filename;
+    std::string base_filename;
+    unsigned int decimation;
+    double rotate_period_s;
+    unsigned long long positions;
+    bool open_file(bool time_tag_name);
 public:
     Kml_Printer();
     ~Kml_Printer();
     bool set_headers(std::string filename, bool time_tag_name = true);
+
+    /*!
+     * \brief Prints one position out of decimation, writes them every
+     * flush_period_s and starts a new file, with a time tag, every
+     * rotate_period_s (0 for never)
+     */
+    void set_streaming(unsigned int decimation, double flush_period_s, double rotate_period_s);
+
     bool print_position(const std::shared_ptr<Pvt_Solution>& position, bool print_average_values);
     bool close_file();
 };
@@ -30,128 +30,713 @@
  */
 
 #include "ls_pvt.h"
+#include <algorithm>
+#include <cmath>
 #include <exception>
 #include "GPS_L1_CA.h"
+#include "pvt_geometry.h"
+#include "rtcm_client.h"
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
+// Kalman filter position engine (PVT.flag_kalman)
+#define PVT_KF_PSEUDORANGE_SIGMA_M 5.0 // pseudorange noise of a unit weight observation [m]
+#define PVT_KF_ACCELERATION_PSD 1.0    // white acceleration of the receiver [m^2/s^3]
+#define PVT_KF_CLOCK_BIAS_PSD 1.0      // receiver clock offset random walk [m^2/s]
+#define PVT_KF_CLOCK_DRIFT_PSD 0.1     // receiver clock drift random walk [m^2/s^3]
+#define PVT_KF_INITIAL_SIGMA 30.0      // initial uncertainty of every state [m], [m/s]
+#define PVT_KF_MAX_GAP_S 10.0          // longest prediction before restarting from least squares [s]
+#define PVT_KF_CLOCK_JUMP_M 1000.0     // mean residual taken as a receiver clock jump [m]
 
 using google::LogMessage;
 
 
 Ls_Pvt::Ls_Pvt() : Pvt_Solution()
 {
+    d_receiver_state = Receiver_State::current();
     d_x_m = 0.0;
     d_y_m = 0.0;
     d_z_m = 0.0;
+    d_rx_vel = arma::zeros(4);
+    d_warm_start_pos.zeros();
+    d_warm_start_valid = false;
+    d_kf_enabled = false;
+    d_kf_initialized = false;
+    d_kf_time = 0.0;
+    d_kf_x.zeros();
+    d_kf_P.zeros();
+    d_raim_ssr = 0.0;
+    d_doppler_static = false;
+    d_iono_correction = false;
+    d_rx_time_s = 0.0;
+    d_differential = false;
 }
 
+
+/*
+ * Cholesky factorization N = L * L' of a symmetric positive definite 4x4
+ * matrix. L is left in the lower triangle of N.
+ */
+static bool cholesky_4x4(arma::mat::fixed<4,4> & N)
+{
+    for (int j = 0; j < 4; j++)
+        {
+            double d = N(j, j);
+            for (int k = 0; k < j; k++)
+                {
+                    d -= N(j, k) * N(j, k);
+                }
+            if (!(d > 0.0))
+                {
+                    return false;
+                }
+            N(j, j) = sqrt(d);
+            for (int i = j + 1; i < 4; i++)
+                {
+                    double s = N(i, j);
+                    for (int k = 0; k < j; k++)
+                        {
+                            s -= N(i, k) * N(j, k);
+                        }
+                    N(i, j) = s / N(j, j);
+                }
+        }
+    return true;
+}
+
+
+/*
+ * Solves L * L' * x = b, with L from cholesky_4x4(). x holds b on input.
+ */
+static void cholesky_solve_4x4(const arma::mat::fixed<4,4> & L, arma::vec::fixed<4> & x)
+{
+    for (int i = 0; i < 4; i++)
+        {
+            for (int k = 0; k < i; k++)
+                {
+                    x(i) -= L(i, k) * x(k);
+                }
+            x(i) /= L(i, i);
+        }
+    for (int i = 3; i >= 0; i--)
+        {
+            for (int k = i + 1; k < 4; k++)
+                {
+                    x(i) -= L(k, i) * x(k);
+                }
+            x(i) /= L(i, i);
+        }
+}
+
+
+/*
+ * Q = inv(A' * A) of a n x 4 design matrix, or zeros if A' * A is singular
+ */
+static void dop_matrix(const arma::mat & A, arma::mat & Q)
+{
+    arma::mat::fixed<4,4> N;
+    N.zeros();
+    for (unsigned int i = 0; i < A.n_rows; i++)
+        {
+            for (int r = 0; r < 4; r++)
+                {
+                    for (int c = 0; c <= r; c++)
+                        {
+                            N(r, c) += A(i, r) * A(i, c);
+                        }
+                }
+        }
+    Q.zeros(4, 4);
+    if (cholesky_4x4(N))
+        {
+            for (int c = 0; c < 4; c++)
+                {
+                    arma::vec::fixed<4> e;
+                    e.zeros();
+                    e(c) = 1.0;
+                    cholesky_solve_4x4(N, e);
+                    Q.col(c) = e;
+                }
+        }
+}
+
+
 arma::vec Ls_Pvt::leastSquarePos(const arma::mat & satpos, const arma::vec & obs, const arma::mat & w)
 {
     /* Computes the Least Squares Solution.
      *   Inputs:
      *       satpos      - Satellites positions in ECEF system: [X; Y; Z;]
      *       obs         - Observations - the pseudorange measurements to each satellite
-     *       w           - weigths vector
+     *       w           - weigths matrix (only its diagonal is used)
      *
      *   Returns:
      *       pos         - receiver position and receiver clock error
      *                   (in ECEF system: [X, Y, Z, dt])
+     *
+     * The iterations start from the last converged solution, if any, so a
+     * receiver that keeps a fix usually needs one or two of them. The 4x4
+     * normal equations are solved on the stack, and the design matrix and
+     * residuals are members that keep their memory from epoch to epoch.
      */
 
     //=== Initialization =======================================================
     int nmbOfIterations = 10; // TODO: include in config
     int nmbOfSatellites;
     nmbOfSatellites = satpos.n_cols;    //Armadillo
-    arma::vec pos = "0.0 0.0 0.0 0.0";
-    arma::mat A;
-    arma::mat omc;
-    arma::mat az;
-    arma::mat el;
-    A = arma::zeros(nmbOfSatellites, 4);
-    omc = arma::zeros(nmbOfSatellites, 1);
-    az = arma::zeros(1, nmbOfSatellites);
-    el = arma::zeros(1, nmbOfSatellites);
-    arma::mat X = satpos;
-    arma::vec Rot_X;
-    double rho2;
-    double traveltime;
-    double trop = 0.0;
-    double dlambda;
-    double dphi;
-    double h;
-    arma::mat mat_tmp;
-    arma::vec x;
+    bool warm_start = d_warm_start_valid;
+    arma::vec::fixed<4> pos;
+    if (warm_start)
+        {
+            pos = d_warm_start_pos;
+        }
+    else
+        {
+            pos.zeros();
+        }
+    d_A.set_size(nmbOfSatellites, 4);
+    d_omc.set_size(nmbOfSatellites);
+    const arma::mat & X = satpos;
+    arma::mat::fixed<4,4> N;
+    arma::vec::fixed<4> x;
+    bool converged = false;
 
     //=== Iteratively find receiver position ===================================
     for (int iter = 0; iter < nmbOfIterations; iter++)
         {
-            for (int i = 0; i < nmbOfSatellites; i++)
+            if (iter == 0 and !warm_start)
                 {
-                    if (iter == 0)
-                        {
-                            //--- Initialize variables at the first iteration --------------
-                            Rot_X = X.col(i); //Armadillo
-                            trop = 0.0;
-                        }
-                    else
+                    //--- Initialize variables at the first iteration --------------
+                    d_los_x.resize(nmbOfSatellites);
+                    d_los_y.resize(nmbOfSatellites);
+                    d_los_z.resize(nmbOfSatellites);
+                    d_delay.assign(nmbOfSatellites, 0.0);
+                    for (int i = 0; i < nmbOfSatellites; i++)
                         {
-                            //--- Update equations -----------------------------------------
-                            rho2 = (X(0, i) - pos(0)) *
-                                   (X(0, i) - pos(0)) + (X(1, i) - pos(1)) *
-                                   (X(1, i) - pos(1)) + (X(2, i) - pos(2)) *
-                                   (X(2, i) - pos(2));
-                            traveltime = sqrt(rho2) / GPS_C_m_s;
-
-                            //--- Correct satellite position (do to earth rotation) --------
-                            Rot_X = Ls_Pvt::rotateSatellite(traveltime, X.col(i)); //armadillo
-
-                            //--- Find DOA and range of satellites
-                            Ls_Pvt::topocent(&d_visible_satellites_Az[i],
-                                     &d_visible_satellites_El[i],
-                                     &d_visible_satellites_Distance[i],
-                                     pos.subvec(0,2),
-                                     Rot_X - pos.subvec(0, 2));
-                            if(traveltime < 0.1 && nmbOfSatellites > 3)
-                                {
-                                    //--- Find receiver's height
-                                    Ls_Pvt::togeod(&dphi, &dlambda, &h, 6378137.0, 298.257223563, pos(0), pos(1), pos(2));
-
-                                    //--- Find delay due to troposphere (in meters)
-                                    Ls_Pvt::tropo(&trop, sin(d_visible_satellites_El[i] * GPS_PI / 180.0), h / 1000.0, 1013.0, 293.0, 50.0, 0.0, 0.0, 0.0);
-                                    if(trop > 50.0 ) trop = 0.0;
-                                }
+                            d_los_x[i] = X(0, i);
+                            d_los_y[i] = X(1, i);
+                            d_los_z[i] = X(2, i);
                         }
+                }
+            else
+                {
+                    //--- Update equations: DOA, range and delays of the satellites
+                    line_of_sight(X, pos.subvec(0, 2), nmbOfSatellites > 3);
+                }
+            for (int i = 0; i < nmbOfSatellites; i++)
+                {
                     //--- Apply the corrections ----------------------------------------
-                    omc(i) = (obs(i) - norm(Rot_X - pos.subvec(0, 2), 2) - pos(3) - trop); // Armadillo
+                    double range = std::sqrt(d_los_x[i] * d_los_x[i] + d_los_y[i] * d_los_y[i] + d_los_z[i] * d_los_z[i]);
+                    d_omc(i) = obs(i) - range - pos(3) - d_delay[i];
 
                     //--- Construct the A matrix ---------------------------------------
-                    //Armadillo
-                    A(i,0) = (-(Rot_X(0) - pos(0))) / obs(i);
-                    A(i,1) = (-(Rot_X(1) - pos(1))) / obs(i);
-                    A(i,2) = (-(Rot_X(2) - pos(2))) / obs(i);
-                    A(i,3) = 1.0;
+                    d_A(i,0) = -d_los_x[i] / obs(i);
+                    d_A(i,1) = -d_los_y[i] / obs(i);
+                    d_A(i,2) = -d_los_z[i] / obs(i);
+                    d_A(i,3) = 1.0;
                 }
 
-            //--- Find position update ---------------------------------------------
-            x = arma::solve(w*A, w*omc); // Armadillo
+            //--- Find position update: (A' W^2 A) x = A' W^2 omc -----------------
+            N.zeros();
+            x.zeros();
+            for (int i = 0; i < nmbOfSatellites; i++)
+                {
+                    double w2 = w(i, i) * w(i, i);
+                    for (int r = 0; r < 4; r++)
+                        {
+                            double wa = w2 * d_A(i, r);
+                            x(r) += wa * d_omc(i);
+                            for (int c = 0; c <= r; c++)
+                                {
+                                    N(r, c) += wa * d_A(i, c);
+                                }
+                        }
+                }
+            if (!cholesky_4x4(N))
+                {
+                    LOG(WARNING) << "Least squares position solution failed";
+                    break;
+                }
+            cholesky_solve_4x4(N, x);
 
             //--- Apply position update --------------------------------------------
             pos = pos + x;
             if (arma::norm(x,2) < 1e-4)
             {
+                converged = true;
                 break; // exit the loop because we assume that the LS algorithm has converged (err < 0.1 cm)
             }
         }
 
-    try
-    {
-            //-- compute the Dilution Of Precision values
-            d_Q = arma::inv(arma::htrans(A)*A);
-    }
-    catch(std::exception& e)
-    {
-            d_Q = arma::zeros(4,4);
-    }
+    //-- keep the solution as the starting point of the next epoch
+    d_warm_start_valid = converged;
+    if (converged)
+        {
+            d_warm_start_pos = pos;
+            subset_solutions(N, x, w, pos);
+        }
+    else
+        {
+            d_raim_ssr = 0.0;
+            d_raim_subset_ssr.reset();
+            d_raim_subset_pos.reset();
+        }
+
+    //-- compute the Dilution Of Precision values
+    dop_matrix(d_A, d_Q);
+    return pos;
+}
+
+
+void Ls_Pvt::subset_solutions(const arma::mat::fixed<4,4> & L, const arma::vec::fixed<4> & dx, const arma::mat & w, const arma::vec::fixed<4> & pos)
+{
+    /* Leave-one-out solutions of the converged fix, for the residual based
+     * integrity checks. Removing observation i from the normal equations
+     * N = A' W^2 A is a rank-one downdate, so (Sherman-Morrison) its
+     * solution and weighted sum of squared residuals follow from those of
+     * the full set with one 4x4 triangular solve each:
+     *
+     *   z_i   = N^-1 a_i w_i^2,   h_i = a_i' z_i  (leverage of observation i)
+     *   pos_i = pos - z_i v_i / (1 - h_i)
+     *   ssr_i = ssr - w_i^2 v_i^2 / (1 - h_i)
+     *
+     * where v are the post-fit residuals. L is the Cholesky factor of N.
+     */
+    int nmbOfSatellites = d_A.n_rows;
+    d_raim_subset_ssr.set_size(nmbOfSatellites);
+    d_raim_subset_pos.set_size(4, nmbOfSatellites);
+    d_raim_ssr = 0.0;
+    arma::vec v = d_omc - d_A * dx;
+    for (int i = 0; i < nmbOfSatellites; i++)
+        {
+            double w2 = w(i, i) * w(i, i);
+            d_raim_ssr += w2 * v(i) * v(i);
+        }
+    arma::vec::fixed<4> z;
+    for (int i = 0; i < nmbOfSatellites; i++)
+        {
+            double w2 = w(i, i) * w(i, i);
+            for (int r = 0; r < 4; r++)
+                {
+                    z(r) = w2 * d_A(i, r);
+                }
+            cholesky_solve_4x4(L, z);
+            double h = 0.0;
+            for (int r = 0; r < 4; r++)
+                {
+                    h += d_A(i, r) * z(r);
+                }
+            if (w2 == 0.0 or 1.0 - h < 1e-9)
+                {
+                    // an unused observation, or one the geometry cannot do without
+                    d_raim_subset_ssr(i) = (w2 == 0.0) ? d_raim_ssr : -1.0;
+                    d_raim_subset_pos.col(i) = pos;
+                    continue;
+                }
+            d_raim_subset_ssr(i) = std::max(d_raim_ssr - w2 * v(i) * v(i) / (1.0 - h), 0.0);
+            d_raim_subset_pos.col(i) = pos - z * (v(i) / (1.0 - h));
+        }
+}
+
+
+void Ls_Pvt::reset_warm_start()
+{
+    d_warm_start_valid = false;
+    d_kf_initialized = false;
+}
+
+
+void Ls_Pvt::set_kalman_filter(bool enabled)
+{
+    d_kf_enabled = enabled;
+    d_kf_initialized = false;
+}
+
+
+void Ls_Pvt::set_rtcm_input(const std::shared_ptr<Rtcm_Client> & client, double max_age_s)
+{
+    d_rtcm_client = client;
+    d_dgps.set_max_age(max_age_s);
+}
+
+
+void Ls_Pvt::poll_corrections()
+{
+    if (!d_rtcm_client)
+        {
+            return;
+        }
+    d_rtcm_batch.clear();
+    d_rtcm_client->take(d_rtcm_batch);
+    for (unsigned int i = 0; i < d_rtcm_batch.size(); i++)
+        {
+            d_dgps.update(d_rtcm_batch[i]);
+        }
+}
+
+
+int Ls_Pvt::apply_corrections(arma::vec & obs, arma::mat & w, const arma::vec & correction_m)
+{
+    int corrected = 0;
+    int valid = 0;
+    for (unsigned int i = 0; i < obs.n_elem; i++)
+        {
+            if (w(i, i) != 0.0)
+                {
+                    valid++;
+                    if (!std::isnan(correction_m(i)))
+                        {
+                            corrected++;
+                        }
+                }
+        }
+    const bool differential = (corrected >= 4);
+    if (differential != d_differential)
+        {
+            // the clock offset of the reference station moves that of the
+            // fix, and the atmospheric delays are no longer modeled
+            LOG(INFO) << (differential ? "Differential" : "Autonomous") << " fixes from now on, "
+                      << corrected << " of " << valid << " observations with corrections";
+            reset_warm_start();
+            d_differential = differential;
+        }
+    if (!differential)
+        {
+            return valid;
+        }
+    for (unsigned int i = 0; i < obs.n_elem; i++)
+        {
+            if (std::isnan(correction_m(i)))
+                {
+                    w(i, i) = 0.0;
+                }
+            else
+                {
+                    obs(i) += correction_m(i);
+                }
+        }
+    return corrected;
+}
+
+
+arma::vec Ls_Pvt::solvePos(const arma::mat & satpos, const arma::vec & obs, const arma::mat & w, double rx_time_s)
+{
+    d_rx_time_s = rx_time_s;
+    if (d_kf_enabled)
+        {
+            // the residual integrity is only known for the least squares
+            // fixes the filter (re)starts from
+            d_raim_ssr = 0.0;
+            d_raim_subset_ssr.reset();
+            d_raim_subset_pos.reset();
+            return kalmanPos(satpos, obs, w, rx_time_s);
+        }
+    return leastSquarePos(satpos, obs, w);
+}
+
+
+void Ls_Pvt::line_of_sight(const arma::mat & satpos, const arma::vec::fixed<3> & rx_pos, bool atmosphere)
+{
+    const unsigned int n = satpos.n_cols;
+    d_los_x.resize(n);
+    d_los_y.resize(n);
+    d_los_z.resize(n);
+    d_sin_el.resize(n);
+    d_delay.resize(n);
+    for (unsigned int i = 0; i < n; i++)
+        {
+            const double dx = satpos(0, i) - rx_pos(0);
+            const double dy = satpos(1, i) - rx_pos(1);
+            const double dz = satpos(2, i) - rx_pos(2);
+            const double traveltime = std::sqrt(dx * dx + dy * dy + dz * dz) / GPS_C_m_s;
+
+            //--- Correct satellite position (do to earth rotation) --------
+            const double omegatau = OMEGA_EARTH_DOT * traveltime;
+            const double c = std::cos(omegatau);
+            const double s = std::sin(omegatau);
+            d_los_x[i] = c * satpos(0, i) + s * satpos(1, i) - rx_pos(0);
+            d_los_y[i] = -s * satpos(0, i) + c * satpos(1, i) - rx_pos(1);
+            d_los_z[i] = dz;
+            d_delay[i] = traveltime;
+        }
+
+    const Local_Frame frame(rx_pos(0), rx_pos(1), rx_pos(2));
+    frame.azimuth_elevation(d_los_x.data(), d_los_y.data(), d_los_z.data(),
+            d_visible_satellites_Az, d_visible_satellites_El, d_visible_satellites_Distance, n);
+    if (!atmosphere or d_differential)
+        {
+            // the differential corrections remove the atmospheric delays
+            d_delay.assign(n, 0.0);
+            return;
+        }
+
+    //--- Find delay due to troposphere and ionosphere (in meters)
+    d_trop_delay.resize(n);
+    d_iono_delay.assign(n, 0.0);
+    for (unsigned int i = 0; i < n; i++)
+        {
+            d_sin_el[i] = std::sin(d_visible_satellites_El[i] * GPS_PI / 180.0);
+        }
+    Tropo_Model(frame.height_m / 1000.0).delays_m(d_sin_el.data(), d_trop_delay.data(), n);
+    if (d_iono_correction and d_iono.valid)
+        {
+            klobuchar_delays_m(d_iono, frame.latitude_d, frame.longitude_d, d_visible_satellites_Az, d_visible_satellites_El,
+                    d_rx_time_s, d_iono_delay.data(), n);
+        }
+    for (unsigned int i = 0; i < n; i++)
+        {
+            // a travel time this long means that rx_pos is still far off
+            const double trop = d_trop_delay[i] > 50.0 ? 0.0 : d_trop_delay[i];
+            d_delay[i] = d_delay[i] < 0.1 ? trop + d_iono_delay[i] : 0.0;
+        }
+}
+
+
+arma::vec Ls_Pvt::kalmanPos(const arma::mat & satpos, const arma::vec & obs, const arma::mat & w, double rx_time_s)
+{
+    /* Extended Kalman filter with state [X, Y, Z, VX, VY, VZ, b, d]: ECEF
+     * position [m] and velocity [m/s], receiver clock offset [m] and drift
+     * [m/s], under a white acceleration and two-state clock model. The
+     * pseudoranges of each epoch are processed one by one as scalar updates,
+     * so an epoch costs about one least squares iteration and a fix can be
+     * kept with less than four satellites in view.
+     *
+     * The filter is (re)started from leastSquarePos() on the first epoch,
+     * after a gap of more than PVT_KF_MAX_GAP_S, or after reset_warm_start().
+     */
+    int nmbOfSatellites = satpos.n_cols;
+    int valid_obs = 0;
+    for (int i = 0; i < nmbOfSatellites; i++)
+        {
+            if (w(i, i) > 0.0)
+                {
+                    valid_obs++;
+                }
+        }
+
+    double dt = rx_time_s - d_kf_time;
+    if (!d_kf_initialized or dt <= 0.0 or dt > PVT_KF_MAX_GAP_S)
+        {
+            d_kf_initialized = false;
+            if (valid_obs < 4)
+                {
+                    return arma::vec();
+                }
+            d_warm_start_valid = false;
+            arma::vec pos = leastSquarePos(satpos, obs, w);
+            if (d_warm_start_valid)
+                {
+                    d_kf_x.zeros();
+                    d_kf_x.subvec(0, 2) = pos.subvec(0, 2);
+                    d_kf_x.subvec(3, 5) = d_rx_vel.subvec(0, 2);
+                    d_kf_x(6) = pos(3);
+                    d_kf_x(7) = d_rx_vel(3);
+                    d_kf_P.zeros();
+                    d_kf_P.diag().fill(PVT_KF_INITIAL_SIGMA * PVT_KF_INITIAL_SIGMA);
+                    d_kf_time = rx_time_s;
+                    d_kf_initialized = true;
+                }
+            return pos;
+        }
+
+    //=== Prediction ===========================================================
+    arma::mat::fixed<8,8> F;
+    F.eye();
+    arma::mat::fixed<8,8> Q;
+    Q.zeros();
+    for (int k = 0; k < 3; k++)
+        {
+            F(k, k + 3) = dt;
+            Q(k, k) = PVT_KF_ACCELERATION_PSD * dt * dt * dt / 3.0;
+            Q(k, k + 3) = PVT_KF_ACCELERATION_PSD * dt * dt / 2.0;
+            Q(k + 3, k) = Q(k, k + 3);
+            Q(k + 3, k + 3) = PVT_KF_ACCELERATION_PSD * dt;
+        }
+    F(6, 7) = dt;
+    Q(6, 6) = PVT_KF_CLOCK_BIAS_PSD * dt + PVT_KF_CLOCK_DRIFT_PSD * dt * dt * dt / 3.0;
+    Q(6, 7) = PVT_KF_CLOCK_DRIFT_PSD * dt * dt / 2.0;
+    Q(7, 6) = Q(6, 7);
+    Q(7, 7) = PVT_KF_CLOCK_DRIFT_PSD * dt;
+    d_kf_x = F * d_kf_x;
+    d_kf_P = F * d_kf_P * F.t() + Q;
+    d_kf_time = rx_time_s;
+
+    //=== Linearize the pseudoranges at the predicted position =================
+    arma::vec::fixed<3> rx_pos = d_kf_x.subvec(0, 2);
+    line_of_sight(satpos, rx_pos, true);
+    d_A.zeros(nmbOfSatellites, 4);
+    d_omc.zeros(nmbOfSatellites);
+    double mean_residual = 0.0;
+    for (int i = 0; i < nmbOfSatellites; i++)
+        {
+            if (!(w(i, i) > 0.0))
+                {
+                    continue;
+                }
+            double range = d_visible_satellites_Distance[i];
+            d_omc(i) = obs(i) - range - d_kf_x(6) - d_delay[i];
+            d_A(i, 0) = -d_los_x[i] / range;
+            d_A(i, 1) = -d_los_y[i] / range;
+            d_A(i, 2) = -d_los_z[i] / range;
+            d_A(i, 3) = 1.0;
+            mean_residual += d_omc(i) / valid_obs;
+        }
+
+    // the common reception time of the observables may move the receiver
+    // clock by a whole code period or more: restart the clock states then
+    if (std::abs(mean_residual) > PVT_KF_CLOCK_JUMP_M)
+        {
+            DLOG(INFO) << "PVT Kalman filter: receiver clock jump of " << mean_residual << " [m]";
+            d_kf_x(6) += mean_residual;
+            d_omc -= mean_residual;
+            for (int k = 0; k < 8; k++)
+                {
+                    d_kf_P(6, k) = 0.0;
+                    d_kf_P(k, 6) = 0.0;
+                }
+            d_kf_P(6, 6) = PVT_KF_INITIAL_SIGMA * PVT_KF_INITIAL_SIGMA;
+        }
+
+    //=== Sequential scalar updates ============================================
+    const arma::vec::fixed<8> x_predicted = d_kf_x;
+    arma::vec::fixed<8> H;
+    arma::vec::fixed<8> PHt;
+    arma::vec::fixed<8> K;
+    for (int i = 0; i < nmbOfSatellites; i++)
+        {
+            if (!(w(i, i) > 0.0))
+                {
+                    continue;
+                }
+            H.zeros();
+            H(0) = d_A(i, 0);
+            H(1) = d_A(i, 1);
+            H(2) = d_A(i, 2);
+            H(6) = 1.0;
+            // d_omc was linearized at the predicted state
+            double innovation = d_omc(i) - arma::dot(H, d_kf_x - x_predicted);
+            PHt = d_kf_P * H;
+            double S = arma::dot(H, PHt) + PVT_KF_PSEUDORANGE_SIGMA_M * PVT_KF_PSEUDORANGE_SIGMA_M / (w(i, i) * w(i, i));
+            K = PHt / S;
+            d_kf_x += K * innovation;
+            d_kf_P -= K * PHt.t();
+        }
+    d_kf_P = 0.5 * (d_kf_P + d_kf_P.t()); // keep it symmetric
+
+    //-- compute the Dilution Of Precision values
+    dop_matrix(d_A, d_Q);
+
+    arma::vec pos(4);
+    pos.subvec(0, 2) = d_kf_x.subvec(0, 2);
+    pos(3) = d_kf_x(6);
+    d_warm_start_pos = pos;
+    d_warm_start_valid = true;
     return pos;
 }
+
+
+arma::vec Ls_Pvt::leastSquareVel(const arma::mat & satpos, const arma::mat & satvel, const arma::vec & rx_pos,
+        const arma::vec & doppler_hz, const arma::mat & w)
+{
+    /* Computes the Least Squares velocity solution. For each satellite, with
+     * u the line of sight unit vector from the receiver to the satellite:
+     *
+     *       -lambda * doppler = u' * (satvel - vel) + drift
+     *
+     *   Returns:
+     *       vel         - receiver velocity and receiver clock drift
+     *                   (in ECEF system: [VX, VY, VZ, drift] [m/s]), or an
+     *                   empty vector if the system cannot be solved
+     */
+    int nmbOfSatellites = satpos.n_cols;
+    double lambda = GPS_C_m_s / GPS_L1_FREQ_HZ; // same carrier for GPS L1 and Galileo E1
+    arma::mat A = arma::zeros(nmbOfSatellites, 4);
+    arma::vec omc = arma::zeros(nmbOfSatellites);
+    arma::vec los;
+    arma::vec vel;
+
+    for (int i = 0; i < nmbOfSatellites; i++)
+        {
+            los = satpos.col(i) - rx_pos.subvec(0, 2);
+            los = los / arma::norm(los, 2);
+            A(i,0) = -los(0);
+            A(i,1) = -los(1);
+            A(i,2) = -los(2);
+            A(i,3) = 1.0;
+            omc(i) = -lambda * doppler_hz(i) - arma::dot(los, satvel.col(i));
+        }
+    if (!arma::solve(vel, w*A, w*omc))
+        {
+            LOG(WARNING) << "Least squares velocity solution failed";
+            vel.reset();
+        }
+    return vel;
+}
+
+
+arma::vec Ls_Pvt::dopplerResiduals(const arma::mat & satpos, const arma::mat & satvel, const arma::vec & rx_pos,
+        const arma::vec & doppler_hz, const arma::mat & w, const arma::vec & rx_vel, bool static_receiver) const
+{
+    /* Same model as leastSquareVel(), for all the satellites at once:
+     *
+     *       residual = -lambda * doppler - u' * (satvel - vel) - drift
+     */
+    double lambda = GPS_C_m_s / GPS_L1_FREQ_HZ;
+    arma::mat los = satpos;
+    los.each_col() -= rx_pos.subvec(0, 2);
+    arma::rowvec range = arma::sqrt(arma::sum(arma::square(los), 0));
+    arma::vec weights = arma::square(w.diag());
+    weights.elem(arma::find(range.t() <= 0.0)).zeros();
+    range.elem(arma::find(range <= 0.0)).ones();
+    los.each_row() /= range;
+
+    arma::mat relvel = satvel;
+    if (!static_receiver)
+        {
+            relvel.each_col() -= rx_vel.subvec(0, 2);
+        }
+    arma::vec residuals = -lambda * doppler_hz - arma::sum(los % relvel, 0).t();
+
+    double drift = rx_vel(3);
+    if (static_receiver)
+        {
+            double weight_sum = arma::accu(weights);
+            drift = weight_sum > 0.0 ? arma::dot(weights, residuals) / weight_sum : 0.0;
+        }
+    residuals -= drift;
+    residuals.elem(arma::find(weights <= 0.0)).zeros();
+    return residuals;
+}
+
+
+void Ls_Pvt::publish_vector_tracking_aid(const arma::mat & satpos, const arma::mat & satvel, const arma::vec & rx_pos,
+        const arma::vec & rx_vel, const std::vector<unsigned int> & gps_prn, double timestamp_secs)
+{
+    double lambda = GPS_C_m_s / GPS_L1_FREQ_HZ;
+    arma::vec los;
+    std::map<int, Vector_Tracking_Aid>::const_iterator last_aid;
+
+    for (unsigned int i = 0; i < gps_prn.size(); i++)
+        {
+            if (gps_prn[i] == 0)
+                {
+                    continue;
+                }
+            los = satpos.col(i) - rx_pos.subvec(0, 2);
+            los = los / arma::norm(los, 2);
+            Vector_Tracking_Aid aid;
+            aid.Tracking_timestamp_secs = timestamp_secs;
+            aid.Carrier_Doppler_hz = -(arma::dot(los, satvel.col(i) - rx_vel.subvec(0, 2)) + rx_vel(3)) / lambda;
+            aid.Carrier_Doppler_rate_hz_s = 0.0;
+            last_aid = d_vector_tracking_aids.find(gps_prn[i]);
+            if (last_aid != d_vector_tracking_aids.end())
+                {
+                    double elapsed_s = timestamp_secs - last_aid->second.Tracking_timestamp_secs;
+                    if (elapsed_s > 0.0 and elapsed_s < 2.0)
+                        {
+                            aid.Carrier_Doppler_rate_hz_s = (aid.Carrier_Doppler_hz - last_aid->second.Carrier_Doppler_hz) / elapsed_s;
+                        }
+                }
+            d_vector_tracking_aids[gps_prn[i]] = aid;
+            d_receiver_state->vector_tracking_map.write(gps_prn[i], aid);
+        }
+}
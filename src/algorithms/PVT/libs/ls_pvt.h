@@ -33,7 +33,16 @@
 #define GNSS_SDR_LS_PVT_H_
 
 
+#include <map>
+#include <memory>
+#include <vector>
+#include "dgps_corrections.h"
+#include "gps_iono.h"
 #include "pvt_solution.h"
+#include "receiver_state.h"
+#include "vector_tracking_aid.h"
+
+class Rtcm_Client;
 
 /*!
  * \brief Base class for the Least Squares PVT solution
@@ -45,9 +54,189 @@ public:
     Ls_Pvt();
 
     arma::vec leastSquarePos(const arma::mat & satpos, const arma::vec & obs, const arma::mat & w);
+
+    /*!
+     * \brief Extended Kalman filter position, velocity and clock solution
+     *
+     * Same inputs and output as leastSquarePos(), plus the receiver time of
+     * the observations [s]. Needs four valid observations (non-zero weight)
+     * to start, later any number. Returns an empty vector if there is no fix.
+     */
+    arma::vec kalmanPos(const arma::mat & satpos, const arma::vec & obs, const arma::mat & w, double rx_time_s);
+
+    /*!
+     * \brief kalmanPos() if the Kalman filter is enabled, leastSquarePos() otherwise
+     */
+    arma::vec solvePos(const arma::mat & satpos, const arma::vec & obs, const arma::mat & w, double rx_time_s);
+
+    void set_kalman_filter(bool enabled);
+
+    /*!
+     * \brief Corrects the pseudoranges with the ionospheric delay of the
+     * broadcast model (Klobuchar) of the last set_iono(), if it is valid
+     */
+    void set_iono_correction(bool enabled) { d_iono_correction = enabled; }
+    void set_iono(const Gps_Iono & iono) { d_iono = iono; }
+
+    /*!
+     * \brief Corrects the pseudoranges with the observations of the reference
+     * station that client receives, if they are at most max_age_s old (see
+     * Dgps_Corrections). The fixes with less than four corrected observations
+     * are not differential.
+     */
+    void set_rtcm_input(const std::shared_ptr<Rtcm_Client> & client, double max_age_s);
+
+    /*!
+     * \brief True if solvePos() can give a fix with less than four satellites
+     */
+    bool kalman_filter_running() const { return d_kf_enabled and d_kf_initialized; }
+
+    /*!
+     * \brief Makes the next solvePos() start from scratch instead of from the
+     * last solution, e.g. after the solution has been rejected
+     */
+    void reset_warm_start();
+
+    /*!
+     * \brief Least Squares receiver velocity and clock drift from the carrier Doppler measurements
+     *
+     * \param[in] satpos      Satellite positions in ECEF system: [X; Y; Z;] [m]
+     * \param[in] satvel      Satellite velocities in ECEF system: [VX; VY; VZ;] [m/s]
+     * \param[in] rx_pos      Receiver position in ECEF system [m]
+     * \param[in] doppler_hz  Carrier Doppler measurements of the L1 / E1 signals [Hz]
+     * \param[in] w           Weights matrix
+     * \return Receiver velocity and clock drift: [VX, VY, VZ, drift] [m/s]
+     */
+    arma::vec leastSquareVel(const arma::mat & satpos, const arma::mat & satvel, const arma::vec & rx_pos,
+            const arma::vec & doppler_hz, const arma::mat & w);
+
+    /*!
+     * \brief Carrier Doppler residuals: the measured range rate of each
+     * observation minus the one that the satellite velocity and rx_vel predict
+     *
+     * The arguments are those of leastSquareVel(). With static_receiver the
+     * velocity of rx_vel is taken as zero, and the clock drift is the
+     * weighted mean of the residuals instead of that of rx_vel.
+     * \return Residual of each observation, 0 for those of zero weight [m/s]
+     */
+    arma::vec dopplerResiduals(const arma::mat & satpos, const arma::mat & satvel, const arma::vec & rx_pos,
+            const arma::vec & doppler_hz, const arma::mat & w, const arma::vec & rx_vel, bool static_receiver) const;
+
+    /*!
+     * \brief Computes d_doppler_residuals of each fix for a receiver that does not move
+     * (velocity fixed to zero), instead of with the estimated velocity
+     */
+    void set_doppler_static(bool static_receiver) { d_doppler_static = static_receiver; }
+
+    /*!
+     * \brief Publishes in the vector_tracking_map of the receiver the carrier Doppler that
+     * rx_vel predicts for the GPS satellites
+     *
+     * \param[in] gps_prn  PRN of the satellite of each column of satpos, or 0 for the non-GPS ones
+     * \param[in] timestamp_secs  Tracking_timestamp_secs of the observations [s]
+     */
+    void publish_vector_tracking_aid(const arma::mat & satpos, const arma::mat & satvel, const arma::vec & rx_pos,
+            const arma::vec & rx_vel, const std::vector<unsigned int> & gps_prn, double timestamp_secs);
+
+    /*!
+     * \brief ECEF velocity [m/s] of the satellite of eph at time, by central differences of its orbit
+     *
+     * Leaves the satellite position of eph (d_satpos_X, d_satpos_Y, d_satpos_Z) at time.
+     */
+    template<typename Ephemeris>
+    static arma::vec satelliteVelocity(Ephemeris & eph, double time)
+    {
+        arma::vec vel = arma::zeros(3);
+        eph.satellitePosition(time + 0.5);
+        vel(0) = eph.d_satpos_X;
+        vel(1) = eph.d_satpos_Y;
+        vel(2) = eph.d_satpos_Z;
+        eph.satellitePosition(time - 0.5);
+        vel(0) -= eph.d_satpos_X;
+        vel(1) -= eph.d_satpos_Y;
+        vel(2) -= eph.d_satpos_Z;
+        eph.satellitePosition(time);
+        return vel;
+    }
+
     double d_x_m;
     double d_y_m;
     double d_z_m;
+
+    arma::vec d_rx_vel; //!< Last receiver velocity and clock drift estimation: [VX, VY, VZ, drift] [m/s]
+
+    /*
+     * Residual integrity of the last converged leastSquarePos() fix, for the
+     * receiver autonomous integrity monitoring of the spoofing detector.
+     * Empty subsets if the last fix did not converge.
+     */
+    double d_raim_ssr;             //!< Weighted sum of the squared post-fit pseudorange residuals [m^2]
+    arma::vec d_raim_subset_ssr;   //!< d_raim_ssr of the fix without each observation, or -1 if that fix is singular [m^2]
+    arma::mat d_raim_subset_pos;   //!< [X; Y; Z; dt] of the fix without each observation (one column each) [m]
+    std::vector<unsigned int> d_raim_prn; //!< GPS PRN of each observation, 0 for the other systems
+    arma::vec d_doppler_residuals; //!< dopplerResiduals() of the last fix, of the observations of d_raim_prn, empty if not computed [m/s]
+    bool d_differential;           //!< True if the observations of the last fix had differential corrections
+
+protected:
+    /*!
+     * \brief Takes the corrections that the RTCM input received since the last fix
+     */
+    void poll_corrections();
+
+    /*!
+     * \brief Adds to the observations their differential correction, and
+     * drops those without one (NaN in correction_m), if at least four have
+     * one. Leaves obs and w as they are otherwise. Sets d_differential.
+     * \return Number of observations of non-zero weight
+     */
+    int apply_corrections(arma::vec & obs, arma::mat & w, const arma::vec & correction_m);
+
+    bool differential_input() const { return static_cast<bool>(d_rtcm_client); }
+
+    Dgps_Corrections d_dgps;
+
+private:
+    void subset_solutions(const arma::mat::fixed<4,4> & L, const arma::vec::fixed<4> & dx, const arma::mat & w, const arma::vec::fixed<4> & pos);
+
+    /*
+     * Line of sight from rx_pos to each satellite of satpos, corrected for
+     * the Earth rotation during the travel time, into d_los_*, its azimuth,
+     * elevation and length into d_visible_satellites_*, and the atmospheric
+     * delay of each observation into d_delay. All the satellites at once.
+     */
+    void line_of_sight(const arma::mat & satpos, const arma::vec::fixed<3> & rx_pos, bool atmosphere);
+
+    std::shared_ptr<Receiver_State> d_receiver_state; // current at construction
+    std::map<int, Vector_Tracking_Aid> d_vector_tracking_aids; // last published aid of each GPS PRN
+
+    arma::vec::fixed<4> d_warm_start_pos; // last converged leastSquarePos() solution
+    bool d_warm_start_valid;
+    arma::mat d_A;   // leastSquarePos() design matrix, reused from epoch to epoch
+    arma::vec d_omc; // leastSquarePos() residuals, reused from epoch to epoch
+
+    // line_of_sight() of each satellite, reused from epoch to epoch
+    std::vector<double> d_los_x;
+    std::vector<double> d_los_y;
+    std::vector<double> d_los_z;
+    std::vector<double> d_sin_el;
+    std::vector<double> d_delay;
+    std::vector<double> d_trop_delay;
+    std::vector<double> d_iono_delay;
+
+    bool d_iono_correction;
+    Gps_Iono d_iono;
+    double d_rx_time_s; // of the observations being solved, for the ionosphere
+
+    bool d_doppler_static;
+
+    std::shared_ptr<Rtcm_Client> d_rtcm_client;
+    std::vector<Rtcm_Corrections> d_rtcm_batch; // taken from the client, reused from fix to fix
+
+    bool d_kf_enabled;
+    bool d_kf_initialized;
+    double d_kf_time;            // receiver time of d_kf_x [s]
+    arma::vec::fixed<8> d_kf_x;  // [X, Y, Z, VX, VY, VZ, clock offset, clock drift] [m], [m/s]
+    arma::mat::fixed<8,8> d_kf_P;
 };
 
 #endif
@@ -36,6 +36,8 @@
 #include "nmea_printer.h"
 #include <fcntl.h>
 #include <termios.h>
+#include <unistd.h>
+#include <cerrno>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <glog/logging.h>
 #include <gflags/gflags.h>
@@ -44,9 +46,15 @@
 
 using google::LogMessage;
 
+// Epochs queued for the serial device. At 9600 baud an epoch takes about half a second,
+// so this is the longest a slow link can lag behind before epochs are dropped.
+#define NMEA_SERIAL_MAX_EPOCHS 4
+
 //DEFINE_string(NMEA_version, "2.1", "Specifies the NMEA version (2.1)");
 
-Nmea_Printer::Nmea_Printer(std::string filename, bool flag_nmea_tty_port, std::string nmea_dump_devname)
+Nmea_Printer::Nmea_Printer(std::string filename, bool flag_nmea_tty_port, std::string nmea_dump_devname) :
+        d_serial_dropped(0),
+        d_serial_stop(false)
 {
     nmea_filename = filename;
     nmea_file_descriptor.open(nmea_filename.c_str(), std::ios::out);
@@ -62,6 +70,7 @@ Nmea_Printer::Nmea_Printer(std::string filename, bool flag_nmea_tty_port, std::s
             if (nmea_dev_descriptor != -1)
                 {
                     DLOG(INFO) << "NMEA printer writing on " << nmea_devname.c_str();
+                    d_serial_thread = boost::thread(&Nmea_Printer::run_serial, this);
                 }
         }
     else
@@ -128,7 +137,76 @@ void Nmea_Printer::close_serial ()
 {
     if (nmea_dev_descriptor != -1)
         {
+            {
+                boost::mutex::scoped_lock lock(d_serial_mutex);
+                d_serial_stop = true;
+            }
+            d_serial_condition.notify_all();
+            if (d_serial_thread.joinable())
+                {
+                    d_serial_thread.join();
+                }
             close(nmea_dev_descriptor);
+            nmea_dev_descriptor = -1;
+        }
+}
+
+
+void Nmea_Printer::queue_serial(const std::string & epoch)
+{
+    boost::mutex::scoped_lock lock(d_serial_mutex);
+    if (d_serial_queue.size() >= NMEA_SERIAL_MAX_EPOCHS)
+        {
+            // the device does not keep up: a stale position is worse than a missing one
+            d_serial_queue.pop_front();
+            d_serial_dropped++;
+        }
+    d_serial_queue.push_back(epoch);
+    d_serial_condition.notify_one();
+}
+
+
+void Nmea_Printer::run_serial()
+{
+    boost::mutex::scoped_lock lock(d_serial_mutex);
+    unsigned long reported_dropped = 0;
+    while (true)
+        {
+            while (d_serial_queue.empty() && !d_serial_stop)
+                {
+                    d_serial_condition.wait(lock);
+                }
+            if (d_serial_stop)
+                {
+                    return;
+                }
+            std::string epoch;
+            epoch.swap(d_serial_queue.front());
+            d_serial_queue.pop_front();
+            unsigned long dropped = d_serial_dropped;
+            lock.unlock();
+
+            if (dropped != reported_dropped)
+                {
+                    LOG(WARNING) << "NMEA serial device " << nmea_devname << " is too slow, " << dropped - reported_dropped << " epochs dropped";
+                    reported_dropped = dropped;
+                }
+            std::size_t written = 0;
+            while (written < epoch.length())
+                {
+                    ssize_t n = write(nmea_dev_descriptor, epoch.c_str() + written, epoch.length() - written);
+                    if (n == -1)
+                        {
+                            if (errno == EINTR || errno == EAGAIN)
+                                {
+                                    continue;
+                                }
+                            DLOG(INFO) << "NMEA printer cannot write on serial device" << nmea_devname.c_str();
+                            break;
+                        }
+                    written += n;
+                }
+            lock.lock();
         }
 }
 
@@ -155,46 +233,28 @@ bool Nmea_Printer::Print_Nmea_Line(const std::shared_ptr<Pvt_Solution>& pvt_data
     //GPGSV
     GPGSV = get_GPGSV();
 
+    // the sentences of the epoch are written at once
+    std::string epoch;
+    epoch.reserve(GPRMC.length() + GPGGA.length() + GPGSA.length() + GPGSV.length());
+    epoch += GPRMC;
+    epoch += GPGGA;
+    epoch += GPGSA;
+    epoch += GPGSV;
+
     // write to log file
     try
     {
-            //GPRMC
-            nmea_file_descriptor << GPRMC;
-            //GPGGA (Global Positioning System Fixed Data)
-            nmea_file_descriptor << GPGGA;
-            //GPGSA
-            nmea_file_descriptor << GPGSA;
-            //GPGSV
-            nmea_file_descriptor << GPGSV;
+            nmea_file_descriptor << epoch;
     }
     catch(std::exception ex)
     {
             DLOG(INFO) << "NMEA printer can not write on output file" << nmea_filename.c_str();;
     }
 
-    //write to serial device
+    //write to serial device, from the serial writer thread
     if (nmea_dev_descriptor!=-1)
         {
-            if(write(nmea_dev_descriptor, GPRMC.c_str(), GPRMC.length()) == -1)
-                {
-                    DLOG(INFO) << "NMEA printer cannot write on serial device" << nmea_devname.c_str();
-                    return false;
-                }
-            if(write(nmea_dev_descriptor, GPGGA.c_str(), GPGGA.length()) == -1)
-                {
-                    DLOG(INFO) << "NMEA printer cannot write on serial device" << nmea_devname.c_str();
-                    return false;
-                }
-            if(write(nmea_dev_descriptor, GPGSA.c_str(), GPGSA.length()) == -1)
-                {
-                    DLOG(INFO) << "NMEA printer cannot write on serial device" << nmea_devname.c_str();
-                    return false;
-                }
-            if(write(nmea_dev_descriptor, GPGSV.c_str(), GPGSV.length()) == -1)
-                {
-                    DLOG(INFO) << "NMEA printer cannot write on serial device" << nmea_devname.c_str();
-                    return false;
-                }
+            queue_serial(epoch);
         }
     return true;
 }
@@ -37,9 +37,13 @@
 #define GNSS_SDR_NMEA_PRINTER_H_
 
 
+#include <deque>
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 #include "pvt_solution.h"
 
 
@@ -48,6 +52,10 @@
  * marine electronic devices as defined by the National Marine Electronics Association (NMEA).
  *
  * See http://en.wikipedia.org/wiki/NMEA_0183
+ *
+ * The sentences of an epoch are sent to the serial device with a single
+ * write, from a thread of its own, so a slow link never stalls the PVT
+ * block. If the device falls behind, the oldest pending epochs are dropped.
  */
 class Nmea_Printer
 {
@@ -75,6 +83,14 @@ private:
     std::shared_ptr<Pvt_Solution> d_PVT_data;
     int init_serial(std::string serial_device); //serial port control
     void close_serial();
+    void queue_serial(const std::string & epoch); // called by Print_Nmea_Line
+    void run_serial();                            // serial writer thread
+    std::deque<std::string> d_serial_queue;       // pending epochs, bounded
+    unsigned long d_serial_dropped;
+    bool d_serial_stop;
+    boost::mutex d_serial_mutex;
+    boost::condition_variable d_serial_condition;
+    boost::thread d_serial_thread;
     std::string get_GPGGA(); // fix data
     std::string get_GPGSV(); // satellite data
     std::string get_GPGSA(); // overall satellite reception data
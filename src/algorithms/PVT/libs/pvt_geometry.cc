@@ -0,0 +1,236 @@
+/*!
+ * \file pvt_geometry.cc
+ * \brief Coordinate conversions and atmospheric delays of the PVT, over
+ * arrays of satellites or epochs
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "pvt_geometry.h"
+#include <cmath>
+#include "GPS_L1_CA.h"
+
+namespace
+{
+const double WGS84_A = 6378137.0;
+const double WGS84_FINV = 298.257223563;
+const double WGS84_B = WGS84_A * (1.0 - 1.0 / WGS84_FINV);
+const double WGS84_E2 = (2.0 - 1.0 / WGS84_FINV) / WGS84_FINV;
+const double WGS84_EP2 = WGS84_E2 / (1.0 - WGS84_E2);
+const double RAD_TO_DEG = 180.0 / GPS_PI;
+const double DEG_TO_RAD = GPS_PI / 180.0;
+}
+
+
+void ecef_to_geodetic(const double* x, const double* y, const double* z,
+        double* latitude_d, double* longitude_d, double* height_m, unsigned int count)
+{
+    const double a2 = WGS84_A * WGS84_A;
+    const double b2 = WGS84_B * WGS84_B;
+    const double e4 = WGS84_E2 * WGS84_E2;
+    for (unsigned int i = 0; i < count; i++)
+        {
+            const double p2 = x[i] * x[i] + y[i] * y[i];
+            const double p = std::sqrt(p2);
+            const double z2 = z[i] * z[i];
+            const double f = 54.0 * b2 * z2;
+            const double g = p2 + (1.0 - WGS84_E2) * z2 - WGS84_E2 * (a2 - b2);
+            const double c = e4 * f * p2 / (g * g * g);
+            const double s = std::cbrt(1.0 + c + std::sqrt(c * c + 2.0 * c));
+            const double k = s + 1.0 + 1.0 / s;
+            const double pk = f / (3.0 * k * k * g * g);
+            const double q = std::sqrt(1.0 + 2.0 * e4 * pk);
+            const double r0 = -pk * WGS84_E2 * p / (1.0 + q)
+                    + std::sqrt(0.5 * a2 * (1.0 + 1.0 / q) - pk * (1.0 - WGS84_E2) * z2 / (q * (1.0 + q)) - 0.5 * pk * p2);
+            const double pe = p - WGS84_E2 * r0;
+            const double u = std::sqrt(pe * pe + z2);
+            const double v = std::sqrt(pe * pe + (1.0 - WGS84_E2) * z2);
+            const double z0 = b2 * z[i] / (WGS84_A * v);
+            height_m[i] = u * (1.0 - b2 / (WGS84_A * v));
+            latitude_d[i] = std::atan2(z[i] + WGS84_EP2 * z0, p) * RAD_TO_DEG;
+            longitude_d[i] = std::atan2(y[i], x[i]) * RAD_TO_DEG;
+        }
+}
+
+
+void geodetic_to_ecef(const double* latitude_d, const double* longitude_d, const double* height_m,
+        double* x, double* y, double* z, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++)
+        {
+            const double sb = std::sin(latitude_d[i] * DEG_TO_RAD);
+            const double cb = std::cos(latitude_d[i] * DEG_TO_RAD);
+            const double n = WGS84_A / std::sqrt(1.0 - WGS84_E2 * sb * sb);
+            x[i] = (n + height_m[i]) * cb * std::cos(longitude_d[i] * DEG_TO_RAD);
+            y[i] = (n + height_m[i]) * cb * std::sin(longitude_d[i] * DEG_TO_RAD);
+            z[i] = (n * (1.0 - WGS84_E2) + height_m[i]) * sb;
+        }
+}
+
+
+Local_Frame::Local_Frame(double x, double y, double z)
+{
+    ecef_to_geodetic(&x, &y, &z, &latitude_d, &longitude_d, &height_m, 1);
+    const double cl = std::cos(longitude_d * DEG_TO_RAD);
+    const double sl = std::sin(longitude_d * DEG_TO_RAD);
+    const double cb = std::cos(latitude_d * DEG_TO_RAD);
+    const double sb = std::sin(latitude_d * DEG_TO_RAD);
+    d_east[0] = -sl;
+    d_east[1] = cl;
+    d_east[2] = 0.0;
+    d_north[0] = -sb * cl;
+    d_north[1] = -sb * sl;
+    d_north[2] = cb;
+    d_up[0] = cb * cl;
+    d_up[1] = cb * sl;
+    d_up[2] = sb;
+}
+
+
+void Local_Frame::azimuth_elevation(const double* dx, const double* dy, const double* dz,
+        double* azimuth_d, double* elevation_d, double* range_m, unsigned int count) const
+{
+    for (unsigned int i = 0; i < count; i++)
+        {
+            const double e = d_east[0] * dx[i] + d_east[1] * dy[i] + d_east[2] * dz[i];
+            const double n = d_north[0] * dx[i] + d_north[1] * dy[i] + d_north[2] * dz[i];
+            const double u = d_up[0] * dx[i] + d_up[1] * dy[i] + d_up[2] * dz[i];
+            const double horizontal = std::sqrt(e * e + n * n);
+            // straight up the azimuth is 0
+            const double azimuth = std::atan2(e, n) * RAD_TO_DEG;
+            azimuth_d[i] = azimuth < 0.0 ? azimuth + 360.0 : azimuth;
+            elevation_d[i] = std::atan2(u, horizontal) * RAD_TO_DEG;
+            range_m[i] = std::sqrt(dx[i] * dx[i] + dy[i] * dy[i] + dz[i] * dz[i]);
+        }
+}
+
+
+namespace
+{
+const double TROPO_A_E_KM = 6378.137;
+const double TROPO_B0 = 7.839257e-5;
+const double TROPO_TLAPSE = -6.5;
+const double TROPO_EM = -978.77 / (2.8704e6 * TROPO_TLAPSE * 1.0e-5);
+}
+
+
+Tropo_Model::Tropo_Model(double height_km, double p_mb, double t_kel, double hum,
+        double hp_km, double htkel_km, double hhum_km) :
+        d_height_km(height_km)
+{
+    const double tkhum = t_kel + TROPO_TLAPSE * (hhum_km - htkel_km);
+    const double atkel = 7.5 * (tkhum - 273.15) / (237.3 + tkhum - 273.15);
+    const double e0 = 0.0611 * hum * std::pow(10, atkel);
+    const double tksea = t_kel - TROPO_TLAPSE * htkel_km;
+    const double tkelh = tksea + TROPO_TLAPSE * hhum_km;
+    const double e0sea = e0 * std::pow(tksea / tkelh, 4 * TROPO_EM);
+    const double tkelp = tksea + TROPO_TLAPSE * hp_km;
+    const double psea = p_mb * std::pow(tksea / tkelp, TROPO_EM);
+
+    double refsea = 77.624e-6 / tksea;
+    d_htop_km[0] = 1.1385e-5 / refsea;
+    d_ref[0] = refsea * psea * std::pow((d_htop_km[0] - height_km) / d_htop_km[0], 4);
+
+    refsea = (371900.0e-6 / tksea - 12.92e-6) / tksea;
+    d_htop_km[1] = 1.1385e-5 * (1255 / tksea + 0.05) / refsea;
+    d_ref[1] = refsea * e0sea * std::pow((d_htop_km[1] - height_km) / d_htop_km[1], 4);
+}
+
+
+double Tropo_Model::delay_m(double sin_elevation) const
+{
+    double delay;
+    delays_m(&sin_elevation, &delay, 1);
+    return delay;
+}
+
+
+void Tropo_Model::delays_m(const double* sin_elevation, double* delay_m, unsigned int count) const
+{
+    const double rsta = TROPO_A_E_KM + d_height_km;
+    for (unsigned int i = 0; i < count; i++)
+        {
+            const double sinel = sin_elevation[i] < 0.0 ? 0.0 : sin_elevation[i];
+            const double cos2el = 1.0 - sinel * sinel;
+            double delay = 0.0;
+            for (int layer = 0; layer < 2; layer++)
+                {
+                    const double htop = d_htop_km[layer];
+                    double rtop = (TROPO_A_E_KM + htop) * (TROPO_A_E_KM + htop) - rsta * rsta * cos2el;
+                    // check to see if geometry is crazy
+                    rtop = std::sqrt(rtop < 0.0 ? 0.0 : rtop) - rsta * sinel;
+                    const double a = -sinel / (htop - d_height_km);
+                    const double b = -TROPO_B0 * cos2el / (htop - d_height_km);
+                    const double a2 = a * a;
+                    const double b2 = b * b;
+                    const bool small_b = b2 <= 1.0e-35;
+                    const double alpha[8] = {2 * a, 2 * a2 + 4 * b / 3, a * (a2 + 3 * b),
+                            a2 * a2 / 5 + 2.4 * a2 * b + 1.2 * b2, 2 * a * b * (a2 + 3 * b) / 3,
+                            b2 * (6 * a2 + 4 * b) * 1.428571e-1, small_b ? 0.0 : a * b2 * b / 2, small_b ? 0.0 : b2 * b2 / 9};
+                    double dr = rtop;
+                    double rn = rtop;
+                    for (int n = 0; n < 8; n++)
+                        {
+                            rn *= rtop;
+                            dr += alpha[n] * rn;
+                        }
+                    delay += dr * d_ref[layer] * 1000;
+                }
+            delay_m[i] = delay;
+        }
+}
+
+
+void klobuchar_delays_m(const Gps_Iono& iono, double latitude_d, double longitude_d,
+        const double* azimuth_d, const double* elevation_d, double gps_tow_s, double* delay_m, unsigned int count)
+{
+    // angles in semicircles, as the coefficients
+    const double phi_u = latitude_d / 180.0;
+    const double lambda_u = (longitude_d > 180.0 ? longitude_d - 360.0 : longitude_d) / 180.0;
+    for (unsigned int i = 0; i < count; i++)
+        {
+            const double e = elevation_d[i] / 180.0;
+            const double azimuth = azimuth_d[i] * DEG_TO_RAD;
+            const double psi = 0.0137 / (e + 0.11) - 0.022;
+            double phi_i = phi_u + psi * std::cos(azimuth);
+            phi_i = phi_i > 0.416 ? 0.416 : (phi_i < -0.416 ? -0.416 : phi_i);
+            const double lambda_i = lambda_u + psi * std::sin(azimuth) / std::cos(phi_i * GPS_PI);
+            const double phi_m = phi_i + 0.064 * std::cos((lambda_i - 1.617) * GPS_PI);
+            double t = 4.32e4 * lambda_i + gps_tow_s;
+            t -= 86400.0 * std::floor(t / 86400.0);
+            const double f = 1.0 + 16.0 * (0.53 - e) * (0.53 - e) * (0.53 - e);
+            double amplitude = iono.d_alpha0 + phi_m * (iono.d_alpha1 + phi_m * (iono.d_alpha2 + phi_m * iono.d_alpha3));
+            amplitude = amplitude < 0.0 ? 0.0 : amplitude;
+            double period = iono.d_beta0 + phi_m * (iono.d_beta1 + phi_m * (iono.d_beta2 + phi_m * iono.d_beta3));
+            period = period < 72000.0 ? 72000.0 : period;
+            const double x = 2.0 * GPS_PI * (t - 50400.0) / period;
+            const double x2 = x * x;
+            const double night = 5.0e-9;
+            const double day = std::fabs(x) < 1.57 ? amplitude * (1.0 - x2 / 2.0 + x2 * x2 / 24.0) : 0.0;
+            delay_m[i] = f * (night + day) * GPS_C_m_s;
+        }
+}
@@ -0,0 +1,454 @@
+/*!
+ * \file pvt_log.cc
+ * \brief Compact binary log of the PVT solutions, observables and spoofing
+ * alarms, with its background writer and a memory-mapped reader
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "pvt_log.h"
+#include <algorithm>
+#include <memory>
+#include <glog/logging.h>
+#include "geojson_printer.h"
+#include "kml_printer.h"
+#include "nmea_printer.h"
+#include "pvt_solution.h"
+
+using google::LogMessage;
+
+Pvt_Log_Writer::Pvt_Log_Writer(unsigned int buffer_bytes) :
+        d_buffer_bytes(std::max(buffer_bytes, static_cast<unsigned int>(sizeof(Pvt_Log_Alarm)))),
+        d_front(0),
+        d_front_bytes(0),
+        d_back(0),
+        d_back_bytes(0),
+        d_last_rx_time(0.0),
+        d_stop(false)
+{
+    d_buffers[0].resize(d_buffer_bytes);
+    d_buffers[1].resize(d_buffer_bytes);
+    d_front = &d_buffers[0][0];
+    d_back = &d_buffers[1][0];
+}
+
+
+Pvt_Log_Writer::~Pvt_Log_Writer()
+{
+    close();
+}
+
+
+bool Pvt_Log_Writer::open(const std::string& filename)
+{
+    close();
+    try
+    {
+            d_file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+            d_file.open(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            Pvt_Log_File_Header file_header;
+            std::memcpy(file_header.magic, "GSPL", 4);
+            file_header.version = PVT_LOG_VERSION;
+            file_header.record_header_bytes = sizeof(Pvt_Log_Record_Header);
+            d_file.write(reinterpret_cast<const char*>(&file_header), sizeof(file_header));
+    }
+    catch (const std::ofstream::failure &e)
+    {
+            LOG(WARNING) << "Exception opening PVT log file " << filename << " " << e.what();
+            if (d_file.is_open())
+                {
+                    d_file.exceptions(std::ofstream::goodbit);
+                    d_file.close();
+                }
+            d_file.exceptions(std::ofstream::goodbit);
+            d_file.clear();
+            return false;
+    }
+    LOG(INFO) << "PVT log enabled, file: " << filename;
+    d_filename = filename;
+    d_front_bytes = 0;
+    d_back_bytes = 0;
+    d_stop = false;
+    d_thread = boost::thread(&Pvt_Log_Writer::run, this);
+    return true;
+}
+
+
+void pvt_log_solution_record(const Pvt_Solution& solution, double rx_time, Pvt_Log_Solution& record)
+{
+    std::memset(&record, 0, sizeof(record));
+    record.header.type = PVT_LOG_SOLUTION;
+    record.header.length = sizeof(record);
+    record.rx_time = rx_time;
+    if (!solution.d_position_UTC_time.is_special())
+        {
+            boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+            record.utc_time_us = (solution.d_position_UTC_time - epoch).total_microseconds();
+        }
+    record.latitude_d = solution.d_latitude_d;
+    record.longitude_d = solution.d_longitude_d;
+    record.height_m = solution.d_height_m;
+    record.rx_dt_m = solution.d_rx_dt_m;
+    record.GDOP = solution.d_GDOP;
+    record.PDOP = solution.d_PDOP;
+    record.HDOP = solution.d_HDOP;
+    record.VDOP = solution.d_VDOP;
+    record.TDOP = solution.d_TDOP;
+    record.valid_observations = solution.d_valid_observations;
+    record.valid_position = solution.b_valid_position ? 1 : 0;
+}
+
+
+void pvt_log_alarm_record(const Spoofing_Message& msg, double rx_time, Pvt_Log_Alarm& record)
+{
+    std::memset(&record, 0, sizeof(record));
+    record.header.type = PVT_LOG_ALARM;
+    record.header.length = sizeof(record);
+    record.rx_time = rx_time;
+    record.spoofing_case = msg.spoofing_case;
+    record.suppressed = msg.suppressed;
+    for (std::set<unsigned int>::const_iterator it = msg.satellites.begin(); it != msg.satellites.end(); ++it)
+        {
+            if (record.n_satellites == sizeof(record.satellites) / sizeof(record.satellites[0]))
+                {
+                    break;
+                }
+            record.satellites[record.n_satellites++] = *it;
+        }
+    msg.description.copy(record.description, sizeof(record.description) - 1);
+}
+
+
+void Pvt_Log_Writer::write_solution(const Pvt_Solution& solution, double rx_time)
+{
+    Pvt_Log_Solution record;
+    pvt_log_solution_record(solution, rx_time, record);
+    set_last_rx_time(rx_time);
+    append(record);
+}
+
+
+void Pvt_Log_Writer::write_observables(const std::map<int, Gnss_Synchro>& observables, double rx_time)
+{
+    Pvt_Log_Observable record;
+    std::memset(&record, 0, sizeof(record));
+    record.header.type = PVT_LOG_OBSERVABLE;
+    record.header.length = sizeof(record);
+    record.rx_time = rx_time;
+    for (std::map<int, Gnss_Synchro>::const_iterator it = observables.begin(); it != observables.end(); ++it)
+        {
+            record.PRN = it->second.PRN;
+            record.system = it->second.System;
+            std::memcpy(record.signal, it->second.Signal, sizeof(record.signal));
+            record.pseudorange_m = it->second.Pseudorange_m;
+            record.carrier_phase_rads = it->second.Carrier_phase_rads;
+            record.carrier_doppler_hz = it->second.Carrier_Doppler_hz;
+            record.CN0_dB_hz = it->second.CN0_dB_hz;
+            append(record);
+        }
+    set_last_rx_time(rx_time);
+}
+
+
+void Pvt_Log_Writer::write_alarm(const Spoofing_Message& msg)
+{
+    double rx_time;
+    {
+        boost::mutex::scoped_lock lock(d_front_mutex);
+        rx_time = d_last_rx_time;
+    }
+    Pvt_Log_Alarm record;
+    pvt_log_alarm_record(msg, rx_time, record);
+    append(record);
+}
+
+
+void Pvt_Log_Writer::write_record(const Pvt_Log_Record_Header& record)
+{
+    if (record.length < sizeof(Pvt_Log_Record_Header) || record.length > d_buffer_bytes)
+        {
+            LOG(WARNING) << "PVT log record of type " << record.type << " and " << record.length << " bytes not copied";
+            return;
+        }
+    boost::mutex::scoped_lock lock(d_front_mutex);
+    if (d_front_bytes + record.length > d_buffer_bytes)
+        {
+            hand_off();
+        }
+    std::memcpy(d_front + d_front_bytes, &record, record.length);
+    d_front_bytes += record.length;
+}
+
+
+void Pvt_Log_Writer::close()
+{
+    if (!d_file.is_open())
+        {
+            return;
+        }
+    {
+        boost::mutex::scoped_lock lock(d_front_mutex);
+        if (d_front_bytes > 0)
+            {
+                hand_off();
+            }
+    }
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_stop = true;
+    }
+    d_condition.notify_all();
+    d_thread.join();
+    try
+    {
+            d_file.close();
+    }
+    catch (const std::ofstream::failure &e)
+    {
+            LOG(WARNING) << "Exception closing PVT log file " << d_filename << " " << e.what();
+    }
+    d_file.clear();
+}
+
+
+void Pvt_Log_Writer::hand_off()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    while (d_back_bytes > 0)
+        {
+            // the writer thread is still storing the previous buffer
+            d_condition.wait(lock);
+        }
+    std::swap(d_front, d_back);
+    d_back_bytes = d_front_bytes;
+    d_front_bytes = 0;
+    d_condition.notify_all();
+}
+
+
+void Pvt_Log_Writer::run()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    bool failed = false;
+    while (true)
+        {
+            while (d_back_bytes == 0 && !d_stop)
+                {
+                    d_condition.wait(lock);
+                }
+            if (d_back_bytes == 0)
+                {
+                    return;
+                }
+            const char* data = d_back;
+            unsigned int n_bytes = d_back_bytes;
+            lock.unlock();
+            if (!failed)
+                {
+                    try
+                    {
+                            d_file.write(data, n_bytes);
+                    }
+                    catch (const std::ofstream::failure &e)
+                    {
+                            // keep draining the buffers, so the PVT block never blocks on a dead file
+                            LOG(WARNING) << "Exception writing PVT log file " << d_filename << " " << e.what();
+                            failed = true;
+                    }
+                }
+            lock.lock();
+            d_back_bytes = 0;
+            d_condition.notify_all();
+        }
+}
+
+
+Pvt_Log_Reader::Pvt_Log_Reader() :
+        d_data(0),
+        d_size(0),
+        d_offset(0)
+{}
+
+
+bool Pvt_Log_Reader::open(const std::string& filename)
+{
+    d_data = 0;
+    d_size = 0;
+    d_offset = 0;
+    try
+    {
+            boost::interprocess::file_mapping file(filename.c_str(), boost::interprocess::read_only);
+            boost::interprocess::mapped_region region(file, boost::interprocess::read_only);
+            d_file.swap(file);
+            d_region.swap(region);
+    }
+    catch (const boost::interprocess::interprocess_exception &e)
+    {
+            LOG(WARNING) << "Unable to map PVT log file " << filename << " " << e.what();
+            return false;
+    }
+    d_data = static_cast<const char*>(d_region.get_address());
+    d_size = d_region.get_size();
+    if (d_size < sizeof(Pvt_Log_File_Header))
+        {
+            d_size = 0;
+            return false;
+        }
+    const Pvt_Log_File_Header* file_header = reinterpret_cast<const Pvt_Log_File_Header*>(d_data);
+    if (std::memcmp(file_header->magic, "GSPL", 4) != 0 || file_header->version != PVT_LOG_VERSION
+            || file_header->record_header_bytes != sizeof(Pvt_Log_Record_Header))
+        {
+            LOG(WARNING) << filename << " is not a PVT log of version " << PVT_LOG_VERSION;
+            d_size = 0;
+            return false;
+        }
+    rewind();
+    return true;
+}
+
+
+const Pvt_Log_Record_Header* Pvt_Log_Reader::next()
+{
+    if (d_offset + sizeof(Pvt_Log_Record_Header) > d_size)
+        {
+            return 0;
+        }
+    const Pvt_Log_Record_Header* record = reinterpret_cast<const Pvt_Log_Record_Header*>(d_data + d_offset);
+    if (record->length < sizeof(Pvt_Log_Record_Header) || d_offset + record->length > d_size)
+        {
+            // truncated (or corrupted) last record
+            return 0;
+        }
+    d_offset += record->length;
+    return record;
+}
+
+
+int pvt_log_to_text(const std::string& log_filename, const std::string& kml_filename, const std::string& geojson_filename, const std::string& nmea_filename)
+{
+    Pvt_Log_Reader reader;
+    if (!reader.open(log_filename))
+        {
+            return -1;
+        }
+    std::shared_ptr<Kml_Printer> kml_printer;
+    if (!kml_filename.empty())
+        {
+            kml_printer = std::make_shared<Kml_Printer>();
+            kml_printer->set_headers(kml_filename, false);
+        }
+    std::shared_ptr<GeoJSON_Printer> geojson_printer;
+    if (!geojson_filename.empty())
+        {
+            geojson_printer = std::make_shared<GeoJSON_Printer>();
+            geojson_printer->set_headers(geojson_filename, false);
+        }
+    std::shared_ptr<Nmea_Printer> nmea_printer;
+    if (!nmea_filename.empty())
+        {
+            nmea_printer = std::make_shared<Nmea_Printer>(nmea_filename, false, "");
+        }
+
+    std::shared_ptr<Pvt_Solution> solution = std::make_shared<Pvt_Solution>();
+    boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+    int n_solutions = 0;
+    const Pvt_Log_Record_Header* record;
+    while ((record = reader.next()) != 0)
+        {
+            const Pvt_Log_Solution* fix = Pvt_Log_Reader::as<Pvt_Log_Solution>(record, PVT_LOG_SOLUTION);
+            if (fix == 0)
+                {
+                    continue;
+                }
+            solution->d_latitude_d = fix->latitude_d;
+            solution->d_longitude_d = fix->longitude_d;
+            solution->d_height_m = fix->height_m;
+            solution->d_rx_dt_m = fix->rx_dt_m;
+            solution->d_position_UTC_time = epoch + boost::posix_time::microseconds(fix->utc_time_us);
+            solution->b_valid_position = (fix->valid_position != 0);
+            solution->d_valid_observations = fix->valid_observations;
+            solution->d_GDOP = fix->GDOP;
+            solution->d_PDOP = fix->PDOP;
+            solution->d_HDOP = fix->HDOP;
+            solution->d_VDOP = fix->VDOP;
+            solution->d_TDOP = fix->TDOP;
+            if (kml_printer) kml_printer->print_position(solution, false);
+            if (geojson_printer) geojson_printer->print_position(solution, false);
+            if (nmea_printer) nmea_printer->Print_Nmea_Line(solution, false);
+            n_solutions++;
+        }
+    if (kml_printer) kml_printer->close_file();
+    if (geojson_printer) geojson_printer->close_file();
+    return n_solutions;
+}
+
+
+int pvt_log_merge(const std::vector<std::string>& segment_filenames, const std::string& merged_filename)
+{
+    Pvt_Log_Writer writer;
+    if (!writer.open(merged_filename))
+        {
+            return -1;
+        }
+    int n_solutions = 0;
+    bool merged_any = false;
+    double last_rx_time = 0.0;
+    for (std::vector<std::string>::const_iterator it = segment_filenames.begin(); it != segment_filenames.end(); ++it)
+        {
+            Pvt_Log_Reader reader;
+            if (!reader.open(*it))
+                {
+                    LOG(WARNING) << "PVT log " << *it << " not merged";
+                    continue;
+                }
+            double cutoff = last_rx_time;
+            bool keep_all = !merged_any;
+            const Pvt_Log_Record_Header* record;
+            while ((record = reader.next()) != 0)
+                {
+                    if (record->length < sizeof(Pvt_Log_Record_Header) + sizeof(double))
+                        {
+                            continue;
+                        }
+                    double rx_time;
+                    std::memcpy(&rx_time, reinterpret_cast<const char*>(record) + sizeof(Pvt_Log_Record_Header), sizeof(rx_time));
+                    if (!keep_all && rx_time <= cutoff)
+                        {
+                            continue; // already merged from the previous segment
+                        }
+                    writer.write_record(*record);
+                    if (record->type == PVT_LOG_SOLUTION)
+                        {
+                            last_rx_time = rx_time;
+                            merged_any = true;
+                            n_solutions++;
+                        }
+                }
+        }
+    writer.close();
+    return n_solutions;
+}
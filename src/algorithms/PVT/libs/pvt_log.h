@@ -0,0 +1,302 @@
+/*!
+ * \file pvt_log.h
+ * \brief Compact binary log of the PVT solutions, observables and spoofing
+ * alarms, with its background writer and a memory-mapped reader
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_PVT_LOG_H_
+#define GNSS_SDR_PVT_LOG_H_
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include "gnss_synchro.h"
+#include "spoofing_message.h"
+
+class Pvt_Solution;
+
+#define PVT_LOG_VERSION 1
+
+enum Pvt_Log_Record_Type
+{
+    PVT_LOG_SOLUTION = 1,
+    PVT_LOG_OBSERVABLE = 2,
+    PVT_LOG_ALARM = 3,
+    PVT_LOG_CHANNEL = 4
+};
+
+#pragma pack(push, 1)
+/*!
+ * \brief First bytes of a PVT log file: "GSPL", the format version and the
+ * size of the record headers. The records follow, with no padding, in the
+ * byte order of the host (little endian on the supported platforms).
+ */
+struct Pvt_Log_File_Header
+{
+    char magic[4];
+    uint16_t version;
+    uint16_t record_header_bytes;
+};
+
+/*!
+ * \brief Common start of the records. Readers skip the types they do not
+ * know using length, so new record types can be added without a new version.
+ */
+struct Pvt_Log_Record_Header
+{
+    uint16_t type;   //!< One of Pvt_Log_Record_Type
+    uint16_t length; //!< Size of the whole record, header included [bytes]
+};
+
+struct Pvt_Log_Solution
+{
+    Pvt_Log_Record_Header header;
+    double rx_time;              //!< Receiver time of week [s]
+    int64_t utc_time_us;         //!< UTC time of the fix since 1970-01-01 [us], 0 if unknown
+    double latitude_d;
+    double longitude_d;
+    double height_m;
+    double rx_dt_m;
+    double GDOP;
+    double PDOP;
+    double HDOP;
+    double VDOP;
+    double TDOP;
+    int32_t valid_observations;
+    uint8_t valid_position;
+    uint8_t reserved[3];
+};
+
+struct Pvt_Log_Observable
+{
+    Pvt_Log_Record_Header header;
+    double rx_time;
+    uint32_t PRN;
+    char system;
+    char signal[3];
+    double pseudorange_m;
+    double carrier_phase_rads;
+    double carrier_doppler_hz;
+    double CN0_dB_hz;
+};
+
+struct Pvt_Log_Alarm
+{
+    Pvt_Log_Record_Header header;
+    double rx_time;              //!< Receiver time of the last solution or observable logged
+    int32_t spoofing_case;
+    uint32_t suppressed;
+    uint32_t n_satellites;
+    uint32_t satellites[12];
+    char description[64];        //!< Null terminated, truncated if needed
+};
+
+/*!
+ * \brief State of a tracking channel used in the solution, with its
+ * acquisition peak and the uid the APT detection assigns to it
+ */
+struct Pvt_Log_Channel
+{
+    Pvt_Log_Record_Header header;
+    double rx_time;
+    uint32_t uid;
+    uint32_t PRN;
+    uint32_t peak;
+    char system;
+    char signal[3];
+    double CN0_dB_hz;
+    double carrier_doppler_hz;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(Pvt_Log_File_Header) == 8, "the PVT log file header layout has changed");
+static_assert(sizeof(Pvt_Log_Solution) == 100, "the PVT log solution record layout has changed");
+static_assert(sizeof(Pvt_Log_Observable) == 52, "the PVT log observable record layout has changed");
+static_assert(sizeof(Pvt_Log_Alarm) == 136, "the PVT log alarm record layout has changed");
+static_assert(sizeof(Pvt_Log_Channel) == 44, "the PVT log channel record layout has changed");
+
+/*!
+ * \brief Fills a solution record, as stored in the log and in the telemetry datagrams
+ */
+void pvt_log_solution_record(const Pvt_Solution& solution, double rx_time, Pvt_Log_Solution& record);
+
+/*!
+ * \brief Fills an alarm record, as stored in the log and in the telemetry datagrams
+ */
+void pvt_log_alarm_record(const Spoofing_Message& msg, double rx_time, Pvt_Log_Alarm& record);
+
+
+/*!
+ * \brief Appends PVT log records from a background thread.
+ *
+ * The records are copied into the front buffer, without formatting or
+ * system calls, and the writer thread stores the back buffer with a single
+ * write. The write functions can be called from several threads (the PVT
+ * block and the spoofing report writer).
+ */
+class Pvt_Log_Writer
+{
+public:
+    explicit Pvt_Log_Writer(unsigned int buffer_bytes = 65536);
+    ~Pvt_Log_Writer();
+
+    /*!
+     * \brief Creates (or truncates) filename, writes the file header and starts the writer thread
+     * \return false if the file could not be opened.
+     */
+    bool open(const std::string& filename);
+
+    bool is_open() const { return d_file.is_open(); }
+
+    void write_solution(const Pvt_Solution& solution, double rx_time);
+
+    void write_observables(const std::map<int, Gnss_Synchro>& observables, double rx_time);
+
+    void write_alarm(const Spoofing_Message& msg);
+
+    /*!
+     * \brief Copies a record read from another log, of any type
+     */
+    void write_record(const Pvt_Log_Record_Header& record);
+
+    /*!
+     * \brief Writes the pending records, stops the writer thread and closes the file
+     */
+    void close();
+
+private:
+    Pvt_Log_Writer(const Pvt_Log_Writer&);
+    Pvt_Log_Writer& operator=(const Pvt_Log_Writer&);
+
+    template<class T> void append(const T& record)
+    {
+        boost::mutex::scoped_lock lock(d_front_mutex);
+        if (d_front_bytes + sizeof(T) > d_buffer_bytes)
+            {
+                hand_off();
+            }
+        std::memcpy(d_front + d_front_bytes, &record, sizeof(T));
+        d_front_bytes += sizeof(T);
+    }
+
+    void set_last_rx_time(double rx_time)
+    {
+        boost::mutex::scoped_lock lock(d_front_mutex);
+        d_last_rx_time = rx_time;
+    }
+
+    void hand_off();
+    void run();
+
+    unsigned int d_buffer_bytes;
+    std::vector<char> d_buffers[2];
+    char* d_front;
+    unsigned int d_front_bytes;
+    char* d_back;
+    unsigned int d_back_bytes;
+    double d_last_rx_time;
+    bool d_stop;
+    std::ofstream d_file;
+    std::string d_filename;
+    boost::mutex d_front_mutex;
+    boost::mutex d_mutex;
+    boost::condition_variable d_condition;
+    boost::thread d_thread;
+};
+
+
+/*!
+ * \brief Walks the records of a PVT log file, mapped in memory
+ */
+class Pvt_Log_Reader
+{
+public:
+    Pvt_Log_Reader();
+
+    /*!
+     * \return false if the file can not be mapped, or it is not a PVT log of a known version
+     */
+    bool open(const std::string& filename);
+
+    /*!
+     * \brief Returns the next record, or 0 at the end of the file or of its last complete record
+     */
+    const Pvt_Log_Record_Header* next();
+
+    void rewind() { d_offset = sizeof(Pvt_Log_File_Header); }
+
+    /*!
+     * \brief Returns the record as T if it has the given type and the size of T, 0 otherwise
+     */
+    template<class T> static const T* as(const Pvt_Log_Record_Header* record, Pvt_Log_Record_Type type)
+    {
+        if (record == 0 || record->type != type || record->length != sizeof(T))
+            {
+                return 0;
+            }
+        return reinterpret_cast<const T*>(record);
+    }
+
+private:
+    boost::interprocess::file_mapping d_file;
+    boost::interprocess::mapped_region d_region;
+    const char* d_data;
+    std::size_t d_size;
+    std::size_t d_offset;
+};
+
+
+/*!
+ * \brief Converts the solutions of a PVT log to KML, GeoJSON and NMEA files.
+ * An empty file name skips that output.
+ * \return the number of solutions converted, or -1 if the log could not be read.
+ */
+int pvt_log_to_text(const std::string& log_filename, const std::string& kml_filename, const std::string& geojson_filename, const std::string& nmea_filename);
+
+/*!
+ * \brief Joins the logs of consecutive, overlapping segments of a capture into
+ * merged_filename.
+ *
+ * All the records start with the header and the receiver time. The records
+ * of a segment that are not later than the last solution of the previous
+ * segments are the warm-up overlap, and are left out. Logs that can not be
+ * read are skipped.
+ * \return the number of solutions merged, or -1 if merged_filename could not be created.
+ */
+int pvt_log_merge(const std::vector<std::string>& segment_filenames, const std::string& merged_filename);
+
+#endif
@@ -0,0 +1,185 @@
+/*!
+ * \file pvt_telemetry.cc
+ * \brief Publishes the PVT solutions, the tracking channels and the spoofing
+ * alarms as compact UDP datagrams, unicast or multicast
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include "pvt_telemetry.h"
+#include <cstring>
+#include <glog/logging.h>
+#include "pvt_solution.h"
+
+using google::LogMessage;
+
+// Largest UDP payload that fits an Ethernet frame without fragmentation
+#define PVT_TELEMETRY_MAX_DATAGRAM_BYTES 1472
+
+Pvt_Telemetry_Publisher::Pvt_Telemetry_Publisher() :
+        d_socket(d_io_service),
+        d_max_datagram_bytes(PVT_TELEMETRY_MAX_DATAGRAM_BYTES),
+        d_decimation(1),
+        d_epochs(0),
+        d_sequence(0),
+        d_dropped(0),
+        d_last_rx_time(0.0)
+{
+    d_datagram.reserve(d_max_datagram_bytes);
+}
+
+
+Pvt_Telemetry_Publisher::~Pvt_Telemetry_Publisher()
+{
+    close();
+}
+
+
+bool Pvt_Telemetry_Publisher::open(const std::string& address, unsigned short port, unsigned int decimation, int multicast_ttl)
+{
+    close();
+    boost::system::error_code ec;
+    boost::asio::ip::address ip = boost::asio::ip::address::from_string(address, ec);
+    if (ec)
+        {
+            LOG(WARNING) << "Invalid PVT telemetry address " << address << " " << ec.message();
+            return false;
+        }
+    d_endpoint = boost::asio::ip::udp::endpoint(ip, port);
+    d_socket.open(d_endpoint.protocol(), ec);
+    if (!ec && ip.is_multicast())
+        {
+            d_socket.set_option(boost::asio::ip::multicast::hops(multicast_ttl), ec);
+        }
+    if (!ec)
+        {
+            d_socket.non_blocking(true, ec);
+        }
+    if (ec)
+        {
+            LOG(WARNING) << "Unable to open the PVT telemetry socket to " << address << ":" << port << " " << ec.message();
+            d_socket.close(ec);
+            return false;
+        }
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_decimation = decimation > 0 ? decimation : 1;
+    d_epochs = 0;
+    d_dropped = 0;
+    LOG(INFO) << "PVT telemetry enabled to " << d_endpoint << ", one of every " << d_decimation << " epochs";
+    return true;
+}
+
+
+void Pvt_Telemetry_Publisher::close()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    if (d_socket.is_open())
+        {
+            if (d_dropped > 0)
+                {
+                    LOG(INFO) << d_dropped << " PVT telemetry datagrams dropped";
+                }
+            boost::system::error_code ec;
+            d_socket.close(ec);
+        }
+}
+
+
+void Pvt_Telemetry_Publisher::publish_epoch(const Pvt_Solution& solution, const std::map<int, Gnss_Synchro>& observables, double rx_time)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_last_rx_time = rx_time;
+    if (!d_socket.is_open() || (d_epochs++ % d_decimation) != 0)
+        {
+            return;
+        }
+    begin_datagram();
+    Pvt_Log_Solution solution_record;
+    pvt_log_solution_record(solution, rx_time, solution_record);
+    add_record(solution_record);
+
+    Pvt_Log_Channel record;
+    std::memset(&record, 0, sizeof(record));
+    record.header.type = PVT_LOG_CHANNEL;
+    record.header.length = sizeof(record);
+    record.rx_time = rx_time;
+    for (std::map<int, Gnss_Synchro>::const_iterator it = observables.begin(); it != observables.end(); ++it)
+        {
+            record.uid = it->second.uid;
+            record.PRN = it->second.PRN;
+            record.peak = it->second.peak;
+            record.system = it->second.System;
+            std::memcpy(record.signal, it->second.Signal, sizeof(record.signal));
+            record.CN0_dB_hz = it->second.CN0_dB_hz;
+            record.carrier_doppler_hz = it->second.Carrier_Doppler_hz;
+            add_record(record);
+        }
+    send_datagram();
+}
+
+
+void Pvt_Telemetry_Publisher::publish_alarm(const Spoofing_Message& msg)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    if (!d_socket.is_open())
+        {
+            return;
+        }
+    begin_datagram();
+    Pvt_Log_Alarm record;
+    pvt_log_alarm_record(msg, d_last_rx_time, record);
+    add_record(record);
+    send_datagram();
+}
+
+
+void Pvt_Telemetry_Publisher::begin_datagram()
+{
+    Pvt_Telemetry_Header header;
+    std::memcpy(header.magic, "GSPT", 4);
+    header.version = PVT_TELEMETRY_VERSION;
+    header.record_header_bytes = sizeof(Pvt_Log_Record_Header);
+    header.sequence = d_sequence++;
+    const char* bytes = reinterpret_cast<const char*>(&header);
+    d_datagram.assign(bytes, bytes + sizeof(header));
+}
+
+
+void Pvt_Telemetry_Publisher::send_datagram()
+{
+    boost::system::error_code ec;
+    d_socket.send_to(boost::asio::buffer(d_datagram), d_endpoint, 0, ec);
+    if (ec)
+        {
+            // would_block or an unreachable listener: the next epoch is more useful than this one
+            if (d_dropped++ == 0)
+                {
+                    LOG(WARNING) << "PVT telemetry datagram dropped: " << ec.message();
+                }
+        }
+}
@@ -0,0 +1,135 @@
+/*!
+ * \file pvt_telemetry.h
+ * \brief Publishes the PVT solutions, the tracking channels and the spoofing
+ * alarms as compact UDP datagrams, unicast or multicast
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#ifndef GNSS_SDR_PVT_TELEMETRY_H_
+#define GNSS_SDR_PVT_TELEMETRY_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/thread/mutex.hpp>
+#include "gnss_synchro.h"
+#include "pvt_log.h"
+#include "spoofing_message.h"
+
+class Pvt_Solution;
+
+#define PVT_TELEMETRY_VERSION 1
+
+#pragma pack(push, 1)
+/*!
+ * \brief First bytes of a telemetry datagram: "GSPT", the format version,
+ * the size of the record headers and a sequence number that lets the
+ * listeners count the lost datagrams. The records of pvt_log.h follow.
+ */
+struct Pvt_Telemetry_Header
+{
+    char magic[4];
+    uint16_t version;
+    uint16_t record_header_bytes;
+    uint32_t sequence;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(Pvt_Telemetry_Header) == 12, "the PVT telemetry header layout has changed");
+
+
+/*!
+ * \brief Sends the state of the receiver to a UDP address, one datagram per epoch.
+ *
+ * An epoch is a Pvt_Log_Solution followed by a Pvt_Log_Channel for each
+ * observable used, and each alarm is a datagram with a Pvt_Log_Alarm. The
+ * socket is non-blocking: a datagram that can not be sent right away is
+ * dropped and counted, so a slow network never stalls the PVT block.
+ * Epochs longer than a datagram are split, each part with its own header.
+ */
+class Pvt_Telemetry_Publisher
+{
+public:
+    Pvt_Telemetry_Publisher();
+    ~Pvt_Telemetry_Publisher();
+
+    /*!
+     * \brief Opens the socket towards address:port. Only one of every decimation epochs is sent.
+     * multicast_ttl is only used if address is a multicast group.
+     * \return false if the address is not valid or the socket can not be opened.
+     */
+    bool open(const std::string& address, unsigned short port, unsigned int decimation = 1, int multicast_ttl = 1);
+
+    bool is_open() const { return d_socket.is_open(); }
+
+    void publish_epoch(const Pvt_Solution& solution, const std::map<int, Gnss_Synchro>& observables, double rx_time);
+
+    void publish_alarm(const Spoofing_Message& msg);
+
+    void close();
+
+    unsigned long dropped_datagrams() const
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        return d_dropped;
+    }
+
+private:
+    Pvt_Telemetry_Publisher(const Pvt_Telemetry_Publisher&);
+    Pvt_Telemetry_Publisher& operator=(const Pvt_Telemetry_Publisher&);
+
+    void begin_datagram();
+    template<class T> void add_record(const T& record)
+    {
+        if (d_datagram.size() + sizeof(T) > d_max_datagram_bytes)
+            {
+                send_datagram();
+                begin_datagram();
+            }
+        const char* bytes = reinterpret_cast<const char*>(&record);
+        d_datagram.insert(d_datagram.end(), bytes, bytes + sizeof(T));
+    }
+    void send_datagram();
+
+    boost::asio::io_service d_io_service;
+    boost::asio::ip::udp::socket d_socket;
+    boost::asio::ip::udp::endpoint d_endpoint;
+    std::size_t d_max_datagram_bytes;
+    std::vector<char> d_datagram;
+    unsigned int d_decimation;
+    unsigned long d_epochs;
+    uint32_t d_sequence;
+    unsigned long d_dropped;
+    double d_last_rx_time;
+    mutable boost::mutex d_mutex; // the alarms come from the spoofing report writer thread
+};
+
+#endif
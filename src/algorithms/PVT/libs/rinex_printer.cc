@@ -235,6 +235,70 @@ void Rinex_Printer::lengthCheck(const std::string& line)
 
 
 
+void Rinex_Printer::overwrite_header(std::fstream& out, const std::string& filename, const std::vector<std::string>& header)
+{
+    std::vector<std::string> old_header;
+    std::string line_str;
+    out.clear();
+    out.seekg(0);
+    while(std::getline(out, line_str))
+        {
+            old_header.push_back(line_str);
+            if (line_str.find("END OF HEADER", 59) != std::string::npos)
+                {
+                    break;
+                }
+        }
+
+    bool same_layout = (old_header.size() == header.size());
+    for (unsigned int i = 0; same_layout && (i < header.size()); i++)
+        {
+            same_layout = (old_header.at(i).length() == header.at(i).length());
+        }
+
+    out.clear();
+    out.seekp(0, std::ios_base::end);
+    out.flush();
+    if (same_layout)
+        {
+            // RINEX header lines have a fixed width: write the ones that changed in place
+            std::fstream header_file(filename, std::ios::out | std::ios::in);
+            long offset = 0;
+            for (unsigned int i = 0; i < header.size(); i++)
+                {
+                    if (header.at(i).compare(old_header.at(i)) != 0)
+                        {
+                            header_file.seekp(offset);
+                            header_file << header.at(i);
+                        }
+                    offset += old_header.at(i).length() + 1;
+                }
+            header_file.close();
+            return;
+        }
+
+    std::vector<std::string> data(header);
+    out.seekg(0);
+    for (unsigned int i = 0; (i < old_header.size()) && std::getline(out, line_str); i++)
+        {
+            // skip the old header
+        }
+    while(std::getline(out, line_str))
+        {
+            data.push_back(line_str);
+        }
+    out.close();
+    out.open(filename, std::ios::out | std::ios::trunc);
+    for (unsigned int i = 0; i < data.size(); i++)
+        {
+            out << data.at(i) << '\n';
+        }
+    out.close();
+    out.open(filename, std::ios::out | std::ios::in | std::ios::app);
+}
+
+
+
 std::string Rinex_Printer::createFilename(std::string type)
 {
     const std::string stationName = "GSDR"; // 4-character station name designator
@@ -510,7 +574,6 @@ void Rinex_Printer::update_nav_header(std::fstream& out, const Galileo_Iono& gal
     std::vector<std::string> data;
     std::string line_aux;
 
-    long pos = out.tellp();
     out.seekp(0);
     data.clear();
 
@@ -583,20 +646,11 @@ void Rinex_Printer::update_nav_header(std::fstream& out, const Galileo_Iono& gal
                 }
             else
                 {
-                    data.push_back(line_str);
+                    break; // the records after the header are not read
                 }
         }
 
-    out.close();
-    out.open(navGalfilename, std::ios::out | std::ios::trunc);
-    out.seekp(0);
-    for (int i = 0; i < (int) data.size() - 1; i++)
-        {
-            out << data[i] << std::endl;
-        }
-    out.close();
-    out.open(navGalfilename, std::ios::out | std::ios::app);
-    out.seekp(pos);
+    Rinex_Printer::overwrite_header(out, navGalfilename, data);
     std::cout << "The RINEX Navigation file header has been updated with UTC and IONO info." << std::endl;
 }
 
@@ -607,7 +661,6 @@ void Rinex_Printer::update_nav_header(std::fstream& out, const Gps_Utc_Model& ut
     std::vector<std::string> data;
     std::string line_aux;
 
-    long pos = out.tellp();
     out.seekp(0);
     data.clear();
 
@@ -735,20 +788,11 @@ void Rinex_Printer::update_nav_header(std::fstream& out, const Gps_Utc_Model& ut
                 }
             else
                 {
-                    data.push_back(line_str);
+                    break; // the records after the header are not read
                 }
         }
 
-    out.close();
-    out.open(navfilename, std::ios::out | std::ios::trunc);
-    out.seekp(0);
-    for (int i = 0; i < (int) data.size() - 1; i++)
-        {
-            out << data[i] << std::endl;
-        }
-    out.close();
-    out.open(navfilename, std::ios::out | std::ios::app);
-    out.seekp(pos);
+    Rinex_Printer::overwrite_header(out, navfilename, data);
     std::cout << "The RINEX Navigation file header has been updated with UTC and IONO info." << std::endl;
 }
 
@@ -937,7 +981,6 @@ void Rinex_Printer::update_nav_header(std::fstream& out, const Gps_Iono& gps_ion
     std::vector<std::string> data;
     std::string line_aux;
 
-    long pos = out.tellp();
     out.seekp(0);
     data.clear();
 
@@ -1045,20 +1088,11 @@ void Rinex_Printer::update_nav_header(std::fstream& out, const Gps_Iono& gps_ion
                 }
             else
                 {
-                    data.push_back(line_str);
+                    break; // the records after the header are not read
                 }
         }
 
-    out.close();
-    out.open(navMixfilename, std::ios::out | std::ios::trunc);
-    out.seekp(0);
-    for (int i = 0; i < (int) data.size() - 1; i++)
-        {
-            out << data[i] << std::endl;
-        }
-    out.close();
-    out.open(navMixfilename, std::ios::out | std::ios::app);
-    out.seekp(pos);
+    Rinex_Printer::overwrite_header(out, navMixfilename, data);
     std::cout << "The RINEX Navigation file header has been updated with UTC and IONO info." << std::endl;
 }
 
@@ -1420,7 +1454,7 @@ void Rinex_Printer::log_rinex_nav(std::fstream& out, const std::map<int,Gps_Ephe
                     line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_A_f2, 18, 2);
                 }
             Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
+            out << line << '\n';
 
 
             // -------- BROADCAST ORBIT - 1
@@ -1454,7 +1488,7 @@ void Rinex_Printer::log_rinex_nav(std::fstream& out, const std::map<int,Gps_Ephe
                     line += std::string(1, ' ');
                 }
             Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
+            out << line << '\n';
 
 
             // -------- BROADCAST ORBIT - 2
@@ -1479,7 +1513,7 @@ void Rinex_Printer::log_rinex_nav(std::fstream& out, const std::map<int,Gps_Ephe
                     line += std::string(1, ' ');
                 }
             Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
+            out << line << '\n';
 
 
 
@@ -1505,7 +1539,7 @@ void Rinex_Printer::log_rinex_nav(std::fstream& out, const std::map<int,Gps_Ephe
                     line += std::string(1, ' ');
                 }
             Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
+            out << line << '\n';
 
 
 
@@ -1531,7 +1565,7 @@ void Rinex_Printer::log_rinex_nav(std::fstream& out, const std::map<int,Gps_Ephe
                     line += std::string(1, ' ');
                 }
             Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
+            out << line << '\n';
 
 
 
@@ -1558,7 +1592,7 @@ void Rinex_Printer::log_rinex_nav(std::fstream& out, const std::map<int,Gps_Ephe
                     line += std::string(1, ' ');
                 }
             Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
+            out << line << '\n';
 
 
             // -------- BROADCAST ORBIT - 6
@@ -1583,7 +1617,7 @@ void Rinex_Printer::log_rinex_nav(std::fstream& out, const std::map<int,Gps_Ephe
                     line += std::string(1, ' ');
                 }
             Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
+            out << line << '\n';
 
 
             // -------- BROADCAST ORBIT - 7
@@ -1631,7 +1665,7 @@ void Rinex_Printer::log_rinex_nav(std::fstream& out, const std::map<int,Gps_Ephe
                     line += std::string(1, ' ');
                 }
             Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
+            out << line << '\n';
             line.clear();
         }
 }
@@ -1679,7 +1713,7 @@ void Rinex_Printer::log_rinex_nav(std::fstream& out, const std::map<int, Galileo
             line += Rinex_Printer::doub2for(galileo_ephemeris_iter->second.af2_4, 18, 2);
 
             Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
+            out << line << '\n';
 
 
             // -------- BROADCAST ORBIT - 1
@@ -1693,7 +1727,7 @@ void Rinex_Printer::log_rinex_nav(std::fstream& out, const std::map<int, Galileo
             line += std::string(1, ' ');
             line += Rinex_Printer::doub2for(galileo_ephemeris_iter->second.M0_1, 18, 2);
             Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
+            out << line << '\n';
 
 
             // -------- BROADCAST ORBIT - 2
@@ -1707,7 +1741,7 @@ void Rinex_Printer::log_rinex_nav(std::fstream& out, const std::map<int, Galileo
             line += std::string(1, ' ');
             line += Rinex_Printer::doub2for(galileo_ephemeris_iter->second.A_1, 18, 2);
             Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
+            out << line << '\n';
 
 
             // -------- BROADCAST ORBIT - 3
@@ -1721,7 +1755,7 @@ void Rinex_Printer::log_rinex_nav(std::fstream& out, const std::map<int, Galileo
             line += std::string(1, ' ');
             line += Rinex_Printer::doub2for(galileo_ephemeris_iter->second.C_is_4, 18, 2);
             Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
+            out << line << '\n';
 
 
             // -------- BROADCAST ORBIT - 4
@@ -1735,7 +1769,7 @@ void Rinex_Printer::log_rinex_nav(std::fstream& out, const std::map<int, Galileo
             line += std::string(1, ' ');
             line += Rinex_Printer::doub2for(galileo_ephemeris_iter->second.OMEGA_dot_3, 18, 2);
             Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
+            out << line << '\n';
 
 
             // -------- BROADCAST ORBIT - 5
@@ -1756,7 +1790,7 @@ void Rinex_Printer::log_rinex_nav(std::fstream& out, const std::map<int, Galileo
             double zero = 0.0;
             line += Rinex_Printer::doub2for(zero, 18, 2);
             Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
+            out << line << '\n';
 
 
             // -------- BROADCAST ORBIT - 6
@@ -1796,7 +1830,7 @@ void Rinex_Printer::log_rinex_nav(std::fstream& out, const std::map<int, Galileo
             line += std::string(1, ' ');
             line += Rinex_Printer::doub2for(galileo_ephemeris_iter->second.BGD_E1E5b_5, 18, 2);
             Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
+            out << line << '\n';
 
 
             // -------- BROADCAST ORBIT - 7
@@ -1810,7 +1844,7 @@ void Rinex_Printer::log_rinex_nav(std::fstream& out, const std::map<int, Galileo
             line += std::string(1, ' ');
             line += std::string(18, ' '); // spare
             Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
+            out << line << '\n';
             line.clear();
         }
 }
@@ -1845,9 +1879,8 @@ void Rinex_Printer::update_obs_header(std::fstream& out, const Gps_Utc_Model& ut
 
                     if (version == 2)
                         {
-                            if (line_str.find("TIME OF FIRST OBS", 59) != std::string::npos) // TIME OF FIRST OBS last header annotation might change in the future
+                            if (line_str.find("LEAP SECONDS") != std::string::npos) // slot reserved by rinex_obs_header()
                                 {
-                                    data.push_back(line_str);
                                     line_aux += Rinex_Printer::rightJustify(boost::lexical_cast<std::string>(utc_model.d_DeltaT_LS), 6);
                                     line_aux += std::string(54, ' ');
                                     line_aux += Rinex_Printer::leftJustify("LEAP SECONDS", 20);
@@ -1866,9 +1899,8 @@ void Rinex_Printer::update_obs_header(std::fstream& out, const Gps_Utc_Model& ut
 
                     if (version == 3)
                         {
-                            if (line_str.find("TIME OF FIRST OBS", 59) != std::string::npos)
+                            if (line_str.find("LEAP SECONDS") != std::string::npos) // slot reserved by rinex_obs_header()
                                 {
-                                    data.push_back(line_str);
                                     line_aux += Rinex_Printer::rightJustify(boost::lexical_cast<std::string>(utc_model.d_DeltaT_LS), 6);
                                     line_aux += Rinex_Printer::rightJustify(boost::lexical_cast<std::string>(utc_model.d_DeltaT_LSF), 6);
                                     line_aux += Rinex_Printer::rightJustify(boost::lexical_cast<std::string>(utc_model.i_WN_LSF), 6);
@@ -1890,20 +1922,11 @@ void Rinex_Printer::update_obs_header(std::fstream& out, const Gps_Utc_Model& ut
                 }
             else
                 {
-                    data.push_back(line_str);
+                    break; // the records after the header are not read
                 }
         }
 
-    out.close();
-    out.open(obsfilename, std::ios::out | std::ios::trunc);
-    out.seekp(0);
-    for (int i = 0; i < (int) data.size() - 1; i++)
-        {
-            out << data[i] << std::endl;
-        }
-    out.close();
-    out.open(obsfilename, std::ios::out | std::ios::in | std::ios::app);
-    out.seekp(0, std::ios_base::end);
+    Rinex_Printer::overwrite_header(out, obsfilename, data);
 }
 
 
@@ -2157,6 +2180,13 @@ void Rinex_Printer::rinex_obs_header(std::fstream& out, const Gps_Ephemeris& eph
     Rinex_Printer::lengthCheck(line);
     out << line << std::endl;
 
+    // -------- LEAP SECONDS slot, written in place by update_obs_header()
+    line.clear();
+    line += Rinex_Printer::leftJustify("LEAP SECONDS NOT YET AVAILABLE", 60);
+    line += Rinex_Printer::leftJustify("COMMENT", 20);
+    Rinex_Printer::lengthCheck(line);
+    out << line << std::endl;
+
     // -------- SYS /PHASE SHIFTS
 
     // -------- end of header
@@ -2187,9 +2217,8 @@ void Rinex_Printer::update_obs_header(std::fstream& out, const Galileo_Utc_Model
                 {
                     line_aux.clear();
 
-                    if (line_str.find("TIME OF FIRST OBS", 59) != std::string::npos)
+                    if (line_str.find("LEAP SECONDS") != std::string::npos) // slot reserved by rinex_obs_header()
                         {
-                            data.push_back(line_str);
                             line_aux += Rinex_Printer::rightJustify(boost::lexical_cast<std::string>(galileo_utc_model.Delta_tLS_6), 6);
                             line_aux += Rinex_Printer::rightJustify(boost::lexical_cast<std::string>(galileo_utc_model.Delta_tLSF_6), 6);
                             line_aux += Rinex_Printer::rightJustify(boost::lexical_cast<std::string>(galileo_utc_model.WN_LSF_6), 6);
@@ -2211,20 +2240,11 @@ void Rinex_Printer::update_obs_header(std::fstream& out, const Galileo_Utc_Model
                 }
             else
                 {
-                    data.push_back(line_str);
+                    break; // the records after the header are not read
                 }
         }
 
-    out.close();
-    out.open(obsfilename, std::ios::out | std::ios::trunc);
-    out.seekp(0);
-    for (int i = 0; i < (int) data.size() - 1; i++)
-        {
-            out << data[i] << std::endl;
-        }
-    out.close();
-    out.open(obsfilename, std::ios::out | std::ios::in |std::ios::app);
-    out.seekp(0, std::ios_base::end);
+    Rinex_Printer::overwrite_header(out, obsfilename, data);
 }
 
 
@@ -2419,6 +2439,13 @@ void Rinex_Printer::rinex_obs_header(std::fstream& out, const Galileo_Ephemeris&
     Rinex_Printer::lengthCheck(line);
     out << line << std::endl;
 
+    // -------- LEAP SECONDS slot, written in place by update_obs_header()
+    line.clear();
+    line += Rinex_Printer::leftJustify("LEAP SECONDS NOT YET AVAILABLE", 60);
+    line += Rinex_Printer::leftJustify("COMMENT", 20);
+    Rinex_Printer::lengthCheck(line);
+    out << line << std::endl;
+
     // -------- SYS /PHASE SHIFTS
 
     // -------- end of header
@@ -2651,6 +2678,13 @@ void Rinex_Printer::rinex_obs_header(std::fstream& out, const Gps_Ephemeris& gps
     Rinex_Printer::lengthCheck(line);
     out << line << std::endl;
 
+    // -------- LEAP SECONDS slot, written in place by update_obs_header()
+    line.clear();
+    line += Rinex_Printer::leftJustify("LEAP SECONDS NOT YET AVAILABLE", 60);
+    line += Rinex_Printer::leftJustify("COMMENT", 20);
+    Rinex_Printer::lengthCheck(line);
+    out << line << std::endl;
+
     // -------- end of header
     line.clear();
     line += std::string(60, ' ');
@@ -2738,7 +2772,7 @@ void Rinex_Printer::log_rinex_obs(std::fstream& out, const Gps_Ephemeris& eph, c
             //line += rightJustify(asString(clockOffset, 12), 15);
             line += std::string(80 - line.size(), ' ');
             Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
+            out << line << '\n';
 
 
             for(pseudoranges_iter = pseudoranges.begin();
@@ -2791,7 +2825,7 @@ void Rinex_Printer::log_rinex_obs(std::fstream& out, const Gps_Ephemeris& eph, c
                     //GPS L1 SIGNAL STRENGTH
                     lineObs += Rinex_Printer::rightJustify(asString(pseudoranges_iter->second.CN0_dB_hz, 3), 14);
                     if (lineObs.size() < 80) lineObs += std::string(80 - lineObs.size(), ' ');
-                    out << lineObs << std::endl;
+                    out << lineObs << '\n';
                 }
         }
 
@@ -2839,7 +2873,7 @@ void Rinex_Printer::log_rinex_obs(std::fstream& out, const Gps_Ephemeris& eph, c
 
             line += std::string(80 - line.size(), ' ');
             Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
+            out << line << '\n';
 
             for(pseudoranges_iter = pseudoranges.begin();
                     pseudoranges_iter != pseudoranges.end();
@@ -2897,7 +2931,7 @@ void Rinex_Printer::log_rinex_obs(std::fstream& out, const Gps_Ephemeris& eph, c
                     lineObs += Rinex_Printer::rightJustify(asString(pseudoranges_iter->second.CN0_dB_hz, 3), 14);
 
                     if (lineObs.size() < 80) lineObs += std::string(80 - lineObs.size(), ' ');
-                    out << lineObs << std::endl;
+                    out << lineObs << '\n';
                 }
         }
 }
@@ -2962,7 +2996,7 @@ void Rinex_Printer::log_rinex_obs(std::fstream& out, const Galileo_Ephemeris& ep
 
     line += std::string(80 - line.size(), ' ');
     Rinex_Printer::lengthCheck(line);
-    out << line << std::endl;
+    out << line << '\n';
 
     for(pseudoranges_iter = pseudoranges.begin();
             pseudoranges_iter != pseudoranges.end();
@@ -3018,7 +3052,7 @@ void Rinex_Printer::log_rinex_obs(std::fstream& out, const Galileo_Ephemeris& ep
             // Galileo E1B SIGNAL STRENGTH
             lineObs += Rinex_Printer::rightJustify(asString(pseudoranges_iter->second.CN0_dB_hz, 3), 14);
             if (lineObs.size() < 80) lineObs += std::string(80 - lineObs.size(), ' ');
-            out << lineObs << std::endl;
+            out << lineObs << '\n';
         }
 }
 
@@ -3080,7 +3114,7 @@ void Rinex_Printer::log_rinex_obs(std::fstream& out, const Gps_Ephemeris& gps_ep
 
     line += std::string(80 - line.size(), ' ');
     Rinex_Printer::lengthCheck(line);
-    out << line << std::endl;
+    out << line << '\n';
 
     std::string s;
     for(pseudoranges_iter = pseudoranges.begin();
@@ -3140,7 +3174,7 @@ void Rinex_Printer::log_rinex_obs(std::fstream& out, const Gps_Ephemeris& gps_ep
             lineObs += Rinex_Printer::rightJustify(asString(pseudoranges_iter->second.CN0_dB_hz, 3), 14);
 
             if (lineObs.size() < 80) lineObs += std::string(80 - lineObs.size(), ' ');
-            out << lineObs << std::endl;
+            out << lineObs << '\n';
         }
 }
 
@@ -3265,7 +3299,7 @@ void Rinex_Printer::log_rinex_sbs(std::fstream& out, const Sbas_Raw_Msg& sbs_mes
     line1 << "SBA";
     line1 << std::string(35, ' ');
     lengthCheck(line1.str());
-    out << line1.str() << std::endl;
+    out << line1.str() << '\n';
 
     // DATA RECORD - 1
     std::stringstream line2;
@@ -3283,7 +3317,7 @@ void Rinex_Printer::log_rinex_sbs(std::fstream& out, const Sbas_Raw_Msg& sbs_mes
     }
     line2 << std::string(19, ' ');
     lengthCheck(line2.str());
-    out << line2.str() << std::endl;
+    out << line2.str() << '\n';
 
     // DATA RECORD - 2
     std::stringstream line3;
@@ -3296,7 +3330,7 @@ void Rinex_Printer::log_rinex_sbs(std::fstream& out, const Sbas_Raw_Msg& sbs_mes
     }
     line3 << std::string(31, ' ');
     lengthCheck(line3.str());
-    out << line3.str() << std::endl;
+    out << line3.str() << '\n';
 }
 
 
@@ -57,6 +57,7 @@
 #include <sstream>  // for stringstream
 #include <iomanip>  // for setprecision
 #include <map>
+#include <vector>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include "gps_navigation_message.h"
 #include "gps_utc_model.h"
@@ -239,6 +240,13 @@ private:
      */
     void lengthCheck(const std::string & line);
 
+    /*
+     * Replaces the header of the file opened in out by the given lines, up to END OF HEADER.
+     * The lines that changed are written in place, so the observation or navigation
+     * records are not copied. If the header changed its size, the whole file is rewritten.
+     */
+    void overwrite_header(std::fstream & out, const std::string & filename, const std::vector<std::string> & header);
+
     /*
      * If the string is bigger than length, truncate it from the right.
      * otherwise, add pad characters to its right.
@@ -0,0 +1,285 @@
+/*!
+ * \file rtcm_client.cc
+ * \brief TCP / NTRIP client that receives the RTCM 3 corrections of a
+ * reference station
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "rtcm_client.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+namespace
+{
+const int RTCM_CLIENT_RECONNECT_S = 5;     // wait before connecting again
+const std::size_t RTCM_CLIENT_QUEUE = 32;  // corrections waiting for the PVT, several epochs of a few messages
+}
+
+
+Rtcm_Client::Rtcm_Client(const std::string& address, unsigned short port, const std::string& mountpoint,
+        const std::string& user, const std::string& password) :
+        d_address(address),
+        d_port(port),
+        d_mountpoint(mountpoint),
+        d_user(user),
+        d_password(password),
+        d_queue(RTCM_CLIENT_QUEUE),
+        d_buffer(2 * Rtcm_Decoder::max_frame_bytes),
+        d_buffered(0),
+        d_socket(d_io_service),
+        d_resolver(d_io_service),
+        d_timer(d_io_service)
+{
+    std::memset(&d_corrections, 0, sizeof(d_corrections));
+    if (!d_mountpoint.empty())
+        {
+            std::ostringstream request;
+            request << "GET /" << d_mountpoint << " HTTP/1.0\r\n"
+                    << "User-Agent: NTRIP GNSS-SDR\r\n";
+            if (!d_user.empty())
+                {
+                    request << "Authorization: Basic " << base64(d_user + ":" + d_password) << "\r\n";
+                }
+            request << "\r\n";
+            d_ntrip_request = request.str();
+        }
+}
+
+
+Rtcm_Client::~Rtcm_Client()
+{
+    close();
+}
+
+
+void Rtcm_Client::open()
+{
+    close();
+    d_io_service.reset();
+    start_connect();
+    d_thread = boost::thread([this]() { d_io_service.run(); });
+}
+
+
+void Rtcm_Client::close()
+{
+    d_io_service.stop();
+    if (d_thread.joinable())
+        {
+            d_thread.join();
+            LOG(INFO) << "RTCM input from " << d_address << ":" << d_port << ": " << d_decoder.frames() << " messages, "
+                      << d_decoder.crc_errors() << " CRC errors, " << dropped() << " corrections dropped";
+        }
+    boost::system::error_code ec;
+    d_timer.cancel(ec);
+    d_socket.close(ec);
+}
+
+
+void Rtcm_Client::take(std::vector<Rtcm_Corrections>& corrections)
+{
+    d_queue.pop_all(corrections);
+}
+
+
+std::string Rtcm_Client::base64(const std::string& text)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string encoded;
+    for (std::size_t i = 0; i < text.length(); i += 3)
+        {
+            unsigned int group = static_cast<unsigned char>(text[i]) << 16;
+            if (i + 1 < text.length()) group |= static_cast<unsigned char>(text[i + 1]) << 8;
+            if (i + 2 < text.length()) group |= static_cast<unsigned char>(text[i + 2]);
+            encoded += alphabet[(group >> 18) & 0x3F];
+            encoded += alphabet[(group >> 12) & 0x3F];
+            encoded += i + 1 < text.length() ? alphabet[(group >> 6) & 0x3F] : '=';
+            encoded += i + 2 < text.length() ? alphabet[group & 0x3F] : '=';
+        }
+    return encoded;
+}
+
+
+void Rtcm_Client::start_connect()
+{
+    d_buffered = 0;
+    boost::asio::ip::tcp::resolver::query query(d_address, std::to_string(d_port));
+    d_resolver.async_resolve(query,
+            [this](const boost::system::error_code& ec, boost::asio::ip::tcp::resolver::iterator endpoints) { on_resolve(ec, endpoints); });
+}
+
+
+void Rtcm_Client::on_resolve(const boost::system::error_code& ec, boost::asio::ip::tcp::resolver::iterator endpoints)
+{
+    if (ec == boost::asio::error::operation_aborted)
+        {
+            return;
+        }
+    if (ec)
+        {
+            reconnect_later("can not resolve the address: " + ec.message());
+            return;
+        }
+    boost::asio::async_connect(d_socket, endpoints,
+            [this](const boost::system::error_code& connect_ec, boost::asio::ip::tcp::resolver::iterator) { on_connect(connect_ec); });
+}
+
+
+void Rtcm_Client::on_connect(const boost::system::error_code& ec)
+{
+    if (ec == boost::asio::error::operation_aborted)
+        {
+            return;
+        }
+    if (ec)
+        {
+            reconnect_later(ec.message());
+            return;
+        }
+    if (d_mountpoint.empty())
+        {
+            LOG(INFO) << "RTCM input connected to " << d_address << ":" << d_port;
+            start_read();
+            return;
+        }
+    boost::system::error_code write_ec;
+    boost::asio::write(d_socket, boost::asio::buffer(d_ntrip_request), write_ec);
+    if (write_ec)
+        {
+            reconnect_later(write_ec.message());
+            return;
+        }
+    d_ntrip_response.consume(d_ntrip_response.size());
+    boost::asio::async_read_until(d_socket, d_ntrip_response, "\r\n",
+            [this](const boost::system::error_code& read_ec, std::size_t bytes) { on_ntrip_response(read_ec, bytes); });
+}
+
+
+void Rtcm_Client::on_ntrip_response(const boost::system::error_code& ec, std::size_t bytes)
+{
+    if (ec == boost::asio::error::operation_aborted)
+        {
+            return;
+        }
+    if (ec)
+        {
+            reconnect_later(ec.message());
+            return;
+        }
+    std::string status_line(boost::asio::buffers_begin(d_ntrip_response.data()),
+            boost::asio::buffers_begin(d_ntrip_response.data()) + bytes);
+    d_ntrip_response.consume(bytes);
+    if (status_line.compare(0, 10, "ICY 200 OK") != 0 and status_line.compare(0, 15, "HTTP/1.1 200 OK") != 0)
+        {
+            // a SOURCETABLE or an error: the mountpoint or the credentials are wrong
+            reconnect_later("mountpoint " + d_mountpoint + " refused: " + status_line.substr(0, status_line.find('\r')));
+            return;
+        }
+    LOG(INFO) << "RTCM input connected to mountpoint " << d_mountpoint << " of " << d_address << ":" << d_port;
+
+    // the stream may already have started behind the response; the framer skips the empty lines
+    d_buffered = std::min(d_ntrip_response.size(), d_buffer.size());
+    boost::asio::buffer_copy(boost::asio::buffer(d_buffer.data(), d_buffered), d_ntrip_response.data());
+    d_ntrip_response.consume(d_ntrip_response.size());
+    consume(0);
+    start_read();
+}
+
+
+void Rtcm_Client::start_read()
+{
+    d_socket.async_read_some(boost::asio::buffer(d_buffer.data() + d_buffered, d_buffer.size() - d_buffered),
+            [this](const boost::system::error_code& ec, std::size_t bytes) { on_read(ec, bytes); });
+}
+
+
+void Rtcm_Client::on_read(const boost::system::error_code& ec, std::size_t bytes)
+{
+    if (ec == boost::asio::error::operation_aborted)
+        {
+            return;
+        }
+    if (ec)
+        {
+            reconnect_later(ec.message());
+            return;
+        }
+    consume(bytes);
+    start_read();
+}
+
+
+void Rtcm_Client::consume(std::size_t bytes)
+{
+    d_buffered += bytes;
+    const unsigned char* data = d_buffer.data();
+    std::size_t position = 0;
+    while (position < d_buffered)
+        {
+            std::size_t frame_bytes;
+            Rtcm_Decoder::Frame_Status status = d_decoder.frame(data + position, d_buffered - position, frame_bytes);
+            if (status == Rtcm_Decoder::NEED_MORE)
+                {
+                    break;
+                }
+            if (status == Rtcm_Decoder::FRAME
+                    and d_decoder.decode(data + position, frame_bytes, d_corrections)
+                    and d_corrections.content != Rtcm_Corrections::NONE)
+                {
+                    d_queue.push(d_corrections);
+                }
+            position += frame_bytes;
+        }
+    // what is left is shorter than a frame, and the buffer holds two
+    d_buffered -= position;
+    if (d_buffered > 0 and position > 0)
+        {
+            std::memmove(d_buffer.data(), d_buffer.data() + position, d_buffered);
+        }
+}
+
+
+void Rtcm_Client::reconnect_later(const std::string& reason)
+{
+    LOG(WARNING) << "RTCM input from " << d_address << ":" << d_port << ": " << reason
+                 << ". Connecting again in " << RTCM_CLIENT_RECONNECT_S << " s";
+    boost::system::error_code ec;
+    d_socket.close(ec);
+    d_timer.expires_from_now(boost::posix_time::seconds(RTCM_CLIENT_RECONNECT_S));
+    d_timer.async_wait([this](const boost::system::error_code& timer_ec)
+            {
+                if (timer_ec != boost::asio::error::operation_aborted)
+                    {
+                        start_connect();
+                    }
+            });
+}
@@ -0,0 +1,117 @@
+/*!
+ * \file rtcm_client.h
+ * \brief TCP / NTRIP client that receives the RTCM 3 corrections of a
+ * reference station
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_RTCM_CLIENT_H_
+#define GNSS_SDR_RTCM_CLIENT_H_
+
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/thread/thread.hpp>
+#include "concurrent_ring_queue.h"
+#include "rtcm_corrections.h"
+#include "rtcm_decoder.h"
+
+/*!
+ * \brief Receives the RTCM 3 stream of a reference station from a TCP
+ * server, or from a mountpoint of a NTRIP caster, and hands the decoded
+ * observations and station positions to the PVT.
+ *
+ * A thread of the client reads the stream into a fixed buffer and frames
+ * and decodes the messages where they are (see Rtcm_Decoder). The decoded
+ * corrections go through a lock-free queue that the PVT drains with take()
+ * once per fix, so neither side waits for the other; if the PVT does not
+ * keep up, the newest corrections are dropped. The client connects again a
+ * few seconds after the server closes the connection or can not be reached.
+ */
+class Rtcm_Client
+{
+public:
+    /*!
+     * \brief A client of address:port. With a mountpoint, it sends a NTRIP 1.0
+     * request for it first, with basic authentication if user is not empty.
+     */
+    Rtcm_Client(const std::string& address, unsigned short port, const std::string& mountpoint = "",
+            const std::string& user = "", const std::string& password = "");
+    ~Rtcm_Client();
+
+    /*!
+     * \brief Starts the thread of the client, which resolves the address
+     * and connects in the background
+     */
+    void open();
+    void close();
+
+    /*!
+     * \brief Appends to corrections those received since the last call
+     */
+    void take(std::vector<Rtcm_Corrections>& corrections);
+
+    bool is_open() const { return d_thread.joinable(); }
+    unsigned long int dropped() const { return d_queue.dropped(); } //!< Corrections that the PVT did not take in time
+
+    static std::string base64(const std::string& text);
+
+private:
+    Rtcm_Client(const Rtcm_Client&);
+    Rtcm_Client& operator=(const Rtcm_Client&);
+
+    void start_connect();
+    void on_resolve(const boost::system::error_code& ec, boost::asio::ip::tcp::resolver::iterator endpoints);
+    void on_connect(const boost::system::error_code& ec);
+    void on_ntrip_response(const boost::system::error_code& ec, std::size_t bytes);
+    void start_read();
+    void on_read(const boost::system::error_code& ec, std::size_t bytes);
+    void consume(std::size_t bytes);
+    void reconnect_later(const std::string& reason);
+
+    std::string d_address;
+    unsigned short d_port;
+    std::string d_mountpoint;
+    std::string d_user;
+    std::string d_password;
+
+    Rtcm_Decoder d_decoder;
+    Rtcm_Corrections d_corrections; // being decoded, kept out of the stack
+    concurrent_spsc_queue<Rtcm_Corrections> d_queue;
+    std::vector<unsigned char> d_buffer; // receive buffer, twice the longest frame
+    std::size_t d_buffered;
+
+    boost::asio::io_service d_io_service;
+    boost::asio::ip::tcp::socket d_socket;
+    boost::asio::ip::tcp::resolver d_resolver;
+    boost::asio::deadline_timer d_timer;
+    boost::asio::streambuf d_ntrip_response;
+    std::string d_ntrip_request;
+    boost::thread d_thread;
+};
+
+#endif
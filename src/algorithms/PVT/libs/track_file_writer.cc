@@ -0,0 +1,173 @@
+/*!
+ * \file track_file_writer.cc
+ * \brief Appends the records of a text track file (KML, GeoJSON) in chunks,
+ * keeping the file valid after each write
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "track_file_writer.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+Track_File_Writer::Track_File_Writer() :
+        d_fd(-1),
+        d_body_end(0),
+        d_records(0),
+        d_chunk_bytes(64 * 1024),
+        d_flush_period(std::chrono::seconds(1)),
+        d_failed(false)
+{}
+
+
+Track_File_Writer::~Track_File_Writer()
+{
+    close();
+}
+
+
+bool Track_File_Writer::open(const std::string& filename, const std::string& header, const std::string& footer, const std::string& separator)
+{
+    close();
+    d_fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (d_fd < 0)
+        {
+            LOG(WARNING) << "Cannot open track file " << filename << ": " << std::strerror(errno);
+            return false;
+        }
+    d_filename = filename;
+    d_footer = footer;
+    d_separator = separator;
+    d_buffer.clear();
+    d_records = 0;
+    d_failed = false;
+    d_body_end = header.size();
+    d_opened = std::chrono::steady_clock::now();
+    d_last_flush = d_opened;
+    return write_at(header + footer, 0);
+}
+
+
+void Track_File_Writer::close()
+{
+    if (d_fd < 0)
+        {
+            return;
+        }
+    flush();
+    ::close(d_fd);
+    d_fd = -1;
+}
+
+
+void Track_File_Writer::set_flush_policy(size_t chunk_bytes, double flush_period_s)
+{
+    d_chunk_bytes = chunk_bytes;
+    d_flush_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(flush_period_s));
+}
+
+
+void Track_File_Writer::append(const std::string& record)
+{
+    if (d_fd < 0)
+        {
+            return;
+        }
+    if (d_records > 0)
+        {
+            d_buffer += d_separator;
+        }
+    d_buffer += record;
+    d_records++;
+    if (d_buffer.size() >= d_chunk_bytes || std::chrono::steady_clock::now() - d_last_flush >= d_flush_period)
+        {
+            flush();
+        }
+}
+
+
+bool Track_File_Writer::flush()
+{
+    d_last_flush = std::chrono::steady_clock::now();
+    if (d_fd < 0 || d_buffer.empty())
+        {
+            return d_fd >= 0 && !d_failed;
+        }
+    // the footer is the same every time, so the new one always covers the old
+    d_buffer += d_footer;
+    bool written = write_at(d_buffer, d_body_end);
+    d_body_end += d_buffer.size() - d_footer.size();
+    d_buffer.clear();
+    return written;
+}
+
+
+double Track_File_Writer::age_s() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - d_opened).count();
+}
+
+
+bool Track_File_Writer::write_at(const std::string& data, off_t offset)
+{
+    size_t written = 0;
+    while (!d_failed && written < data.size())
+        {
+            ssize_t n = ::pwrite(d_fd, data.data() + written, data.size() - written, offset + written);
+            if (n < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+            if (n <= 0)
+                {
+                    LOG(WARNING) << "Exception writing track file " << d_filename << " " << std::strerror(errno);
+                    d_failed = true;
+                }
+            else
+                {
+                    written += n;
+                }
+        }
+    return !d_failed;
+}
+
+
+std::string track_file_time_tag(time_t time)
+{
+    struct tm timeinfo;
+    localtime_r(&time, &timeinfo);
+    char tag[16];
+    std::snprintf(tag, sizeof(tag), "%02d%02d%02d_%02d%02d%02d", timeinfo.tm_year - 100, timeinfo.tm_mon + 1,
+            timeinfo.tm_mday, timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
+    return tag;
+}
@@ -0,0 +1,98 @@
+/*!
+ * \file track_file_writer.h
+ * \brief Appends the records of a text track file (KML, GeoJSON) in chunks,
+ * keeping the file valid after each write
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_TRACK_FILE_WRITER_H_
+#define GNSS_SDR_TRACK_FILE_WRITER_H_
+
+#include <sys/types.h>
+#include <chrono>
+#include <ctime>
+#include <string>
+
+/*!
+ * \brief A file made of a header, records joined by a separator and a
+ * footer, such as a KML LineString or a GeoJSON MultiPoint.
+ *
+ * The records are kept in memory and written once chunk_bytes of them are
+ * waiting, or flush_period_s after the last write. Each write puts the new
+ * records and the footer over the old footer in one pwrite, so the file on
+ * disk is complete between writes and, after a crash, only loses the
+ * records not written yet.
+ */
+class Track_File_Writer
+{
+public:
+    Track_File_Writer();
+    ~Track_File_Writer();
+
+    /*!
+     * \brief Writes the header and the footer of an empty track
+     */
+    bool open(const std::string& filename, const std::string& header, const std::string& footer, const std::string& separator);
+    void close(); //!< Writes the records left
+
+    void set_flush_policy(size_t chunk_bytes, double flush_period_s);
+
+    void append(const std::string& record);
+    bool flush(); //!< false if the file cannot be written
+
+    bool is_open() const { return d_fd >= 0; }
+    const std::string& filename() const { return d_filename; }
+    unsigned long long records() const { return d_records; } //!< Appended since the file was opened
+    double age_s() const; //!< Since the file was opened
+
+private:
+    Track_File_Writer(const Track_File_Writer&);
+    Track_File_Writer& operator=(const Track_File_Writer&);
+
+    bool write_at(const std::string& data, off_t offset);
+
+    int d_fd;
+    std::string d_filename;
+    std::string d_footer;
+    std::string d_separator;
+    std::string d_buffer;
+    off_t d_body_end; // where the footer starts
+    unsigned long long d_records;
+    size_t d_chunk_bytes;
+    std::chrono::steady_clock::duration d_flush_period;
+    std::chrono::steady_clock::time_point d_opened;
+    std::chrono::steady_clock::time_point d_last_flush;
+    bool d_failed;
+};
+
+/*!
+ * \brief "YYMMDD_hhmmss" of the local time, the suffix of the file names of
+ * the printers
+ */
+std::string track_file_time_tag(time_t time);
+
+#endif
@@ -34,6 +34,7 @@
 #include <boost/math/distributions/exponential.hpp>
 #include <glog/logging.h>
 #include "galileo_e1_signal_processing.h"
+#include "code_bank.h"
 #include "Galileo_E1.h"
 #include "configuration_interface.h"
 
@@ -99,6 +100,9 @@ GalileoE1PcpsAmbiguousAcquisition::GalileoE1PcpsAmbiguousAcquisition(
                         doppler_max_, if_, fs_in_, samples_per_ms, code_length_,
                         bit_transition_flag_, use_CFAR_algorithm_flag_, dump_, dump_filename_);
                 DLOG(INFO) << "acquisition(" << acquisition_cc_->unique_id() << ")";
+                acquisition_cc_->set_frequency_domain_doppler(configuration_->property(role + ".frequency_domain_doppler", false));
+                acquisition_cc_->set_pooled_engine(configuration_->property(role + ".pooled_engine", false));
+                acquisition_cc_->set_non_coherent_integration(configuration_->property(role + ".non_coherent_integration", false));
         }
 
     stream_to_vector_ = gr::blocks::stream_to_vector::make(item_size_, vector_length_);
@@ -246,7 +250,7 @@ void GalileoE1PcpsAmbiguousAcquisition::set_local_code()
 
     std::complex<float> * code = new std::complex<float>[code_length_];
 
-    galileo_e1_code_gen_complex_sampled(code, gnss_synchro_->Signal,
+    Code_Bank::galileo_e1_code_gen_complex_sampled(code, gnss_synchro_->Signal,
                     cboc, gnss_synchro_->PRN, fs_in_, 0, false);
 
     for (unsigned int i = 0; i < sampled_ms_ / 4; i++)
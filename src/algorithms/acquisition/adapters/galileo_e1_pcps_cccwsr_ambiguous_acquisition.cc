@@ -34,6 +34,7 @@
 #include <boost/math/distributions/exponential.hpp>
 #include <glog/logging.h>
 #include "galileo_e1_signal_processing.h"
+#include "code_bank.h"
 #include "Galileo_E1.h"
 #include "configuration_interface.h"
 
@@ -216,12 +217,12 @@ void GalileoE1PcpsCccwsrAmbiguousAcquisition::set_local_code()
 
             strcpy(signal, "1B");
 
-            galileo_e1_code_gen_complex_sampled(code_data_, signal,
+            Code_Bank::galileo_e1_code_gen_complex_sampled(code_data_, signal,
                     cboc, gnss_synchro_->PRN, fs_in_, 0, false);
 
             strcpy(signal, "1C");
 
-            galileo_e1_code_gen_complex_sampled(code_pilot_, signal,
+            Code_Bank::galileo_e1_code_gen_complex_sampled(code_pilot_, signal,
                     cboc, gnss_synchro_->PRN, fs_in_, 0, false);
 
             acquisition_cc_->set_local_code(code_data_, code_pilot_);
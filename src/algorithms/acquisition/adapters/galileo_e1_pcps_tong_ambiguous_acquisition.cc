@@ -34,6 +34,7 @@
 #include <boost/math/distributions/exponential.hpp>
 #include <glog/logging.h>
 #include "galileo_e1_signal_processing.h"
+#include "code_bank.h"
 #include "Galileo_E1.h"
 #include "configuration_interface.h"
 
@@ -216,7 +217,7 @@ void GalileoE1PcpsTongAmbiguousAcquisition::set_local_code()
 
             std::complex<float> * code = new std::complex<float>[code_length_];
 
-            galileo_e1_code_gen_complex_sampled(code, gnss_synchro_->Signal,
+            Code_Bank::galileo_e1_code_gen_complex_sampled(code, gnss_synchro_->Signal,
                     cboc, gnss_synchro_->PRN, fs_in_, 0, false);
 
             for (unsigned int i = 0; i < sampled_ms_/4; i++)
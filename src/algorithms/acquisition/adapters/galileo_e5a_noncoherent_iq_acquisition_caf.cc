@@ -40,6 +40,7 @@
 #include <boost/math/distributions/exponential.hpp>
 #include <glog/logging.h>
 #include "galileo_e5_signal_processing.h"
+#include "code_bank.h"
 #include "Galileo_E5a.h"
 #include "configuration_interface.h"
 
@@ -220,16 +221,16 @@ void GalileoE5aNoncoherentIQAcquisitionCaf::set_local_code()
                 {
                     char a[3];
                     strcpy(a,"5I");
-                    galileo_e5_a_code_gen_complex_sampled(codeI, a,
+                    Code_Bank::galileo_e5_a_code_gen_complex_sampled(codeI, a,
                             gnss_synchro_->PRN, fs_in_, 0);
 
                     strcpy(a,"5Q");
-                    galileo_e5_a_code_gen_complex_sampled(codeQ, a,
+                    Code_Bank::galileo_e5_a_code_gen_complex_sampled(codeQ, a,
                             gnss_synchro_->PRN, fs_in_, 0);
                 }
             else
                 {
-                    galileo_e5_a_code_gen_complex_sampled(codeI, gnss_synchro_->Signal,
+                    Code_Bank::galileo_e5_a_code_gen_complex_sampled(codeI, gnss_synchro_->Signal,
                             gnss_synchro_->PRN, fs_in_, 0);
                 }
             // WARNING: 3ms are coherently integrated. Secondary sequence (1,1,1)
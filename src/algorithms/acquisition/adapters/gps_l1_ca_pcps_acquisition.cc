@@ -34,9 +34,11 @@
  */
 
 #include "gps_l1_ca_pcps_acquisition.h"
+#include <algorithm>
 #include <boost/math/distributions/exponential.hpp>
 #include <glog/logging.h>
 #include "gps_sdr_signal_processing.h"
+#include "code_bank.h"
 #include "GPS_L1_CA.h"
 #include "configuration_interface.h"
 
@@ -95,6 +97,18 @@ GpsL1CaPcpsAcquisition::GpsL1CaPcpsAcquisition(
                         doppler_max_, if_, fs_in_, code_length_, code_length_,
                         bit_transition_flag_, use_CFAR_algorithm_flag_, dump_, dump_filename_);
                 DLOG(INFO) << "acquisition(" << acquisition_cc_->unique_id() << ")";
+                acquisition_cc_->set_frequency_domain_doppler(configuration_->property(role + ".frequency_domain_doppler", false));
+                acquisition_cc_->set_pooled_engine(configuration_->property(role + ".pooled_engine", false));
+                acquisition_cc_->set_non_coherent_integration(configuration_->property(role + ".non_coherent_integration", false));
+                // by default, the code phase window is two chips wide on each side
+                unsigned int code_window_samples = std::max(1, static_cast<int>(2 * code_length_ / GPS_L1_CA_CODE_LENGTH_CHIPS));
+                acquisition_cc_->set_reacquisition(configuration_->property(role + ".reacquisition", false),
+                        configuration_->property(role + ".reacquisition_doppler_window_hz", 500),
+                        configuration_->property(role + ".reacquisition_code_window_samples", code_window_samples),
+                        configuration_->property(role + ".reacquisition_max_age_ms", 30000));
+                acquisition_cc_->set_early_termination(configuration_->property(role + ".early_termination", false),
+                        configuration_->property(role + ".early_termination_confirmation", 2.0),
+                        configuration_->property(role + ".early_termination_lines", 0));
         }
 
     stream_to_vector_ = gr::blocks::stream_to_vector::make(item_size_, vector_length_);
@@ -239,7 +253,7 @@ void GpsL1CaPcpsAcquisition::set_local_code()
 
     std::complex<float>* code = new std::complex<float>[code_length_];
 
-    gps_l1_ca_code_gen_complex_sampled(code, gnss_synchro_->PRN, fs_in_, 0);
+    Code_Bank::gps_l1_ca_code_gen_complex_sampled(code, gnss_synchro_->PRN, fs_in_, 0);
 
     for (unsigned int i = 0; i < sampled_ms_; i++)
         {
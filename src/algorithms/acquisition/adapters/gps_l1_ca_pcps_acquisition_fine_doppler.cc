@@ -35,6 +35,7 @@
 #include "gps_l1_ca_pcps_acquisition_fine_doppler.h"
 #include <glog/logging.h>
 #include "gps_sdr_signal_processing.h"
+#include "code_bank.h"
 #include "GPS_L1_CA.h"
 #include "configuration_interface.h"
 
@@ -142,7 +143,7 @@ void GpsL1CaPcpsAcquisitionFineDoppler::init()
 void GpsL1CaPcpsAcquisitionFineDoppler::set_local_code()
 {
     DLOG(INFO) << "set local code";
-    gps_l1_ca_code_gen_complex_sampled(code_, gnss_synchro_->PRN, fs_in_, 0);
+    Code_Bank::gps_l1_ca_code_gen_complex_sampled(code_, gnss_synchro_->PRN, fs_in_, 0);
     acquisition_cc_->set_local_code(code_);
 }
 
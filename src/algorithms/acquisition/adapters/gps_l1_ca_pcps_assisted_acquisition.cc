@@ -33,8 +33,10 @@
  */
 
 #include "gps_l1_ca_pcps_assisted_acquisition.h"
+#include <algorithm>
 #include <glog/logging.h>
 #include "gps_sdr_signal_processing.h"
+#include "code_bank.h"
 #include "GPS_L1_CA.h"
 #include "configuration_interface.h"
 
@@ -72,6 +74,11 @@ GpsL1CaPcpsAssistedAcquisition::GpsL1CaPcpsAssistedAcquisition(
             acquisition_cc_ = pcps_make_assisted_acquisition_cc(max_dwells_, sampled_ms_,
                     doppler_max_, doppler_min_, if_, fs_in_, vector_length_,
                     dump_, dump_filename_);
+            // by default, the code phase window is two chips wide on each side
+            unsigned int code_window_samples = std::max(1, static_cast<int>(2 * vector_length_ / GPS_L1_CA_CODE_LENGTH_CHIPS));
+            acquisition_cc_->set_narrow_search(configuration->property(role + ".narrow_search", false),
+                    configuration->property(role + ".narrow_search_code_window_samples", code_window_samples),
+                    configuration->property(role + ".narrow_search_max_age_ms", 30000));
 
         }
     else
@@ -142,7 +149,7 @@ void GpsL1CaPcpsAssistedAcquisition::init()
 
 void GpsL1CaPcpsAssistedAcquisition::set_local_code()
 {
-    gps_l1_ca_code_gen_complex_sampled(code_, gnss_synchro_->PRN, fs_in_, 0);
+    Code_Bank::gps_l1_ca_code_gen_complex_sampled(code_, gnss_synchro_->PRN, fs_in_, 0);
     acquisition_cc_->set_local_code(code_);
 }
 
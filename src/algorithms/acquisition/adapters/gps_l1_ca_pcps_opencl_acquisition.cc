@@ -33,8 +33,11 @@
 #include <boost/math/distributions/exponential.hpp>
 #include <glog/logging.h>
 #include "gps_sdr_signal_processing.h"
+#include "code_bank.h"
 #include "GPS_L1_CA.h"
 #include "configuration_interface.h"
+#include "opencl_environment.h"
+#include "opencl_program_cache.h"
 
 using google::LogMessage;
 
@@ -83,6 +86,9 @@ GpsL1CaPcpsOpenClAcquisition::GpsL1CaPcpsOpenClAcquisition(
     if (item_type_.compare("gr_complex") == 0)
         {
             item_size_ = sizeof(gr_complex);
+            // shared by all the OpenCL channels, the first one creates them
+            Opencl_Environment::set_num_queues(configuration_->property("GNSS-SDR.opencl_queues", 4));
+            Opencl_Program_Cache::set_cache_dir(configuration_->property("GNSS-SDR.opencl_cache_dir", std::string("")));
             acquisition_cc_ = pcps_make_opencl_acquisition_cc(sampled_ms_, max_dwells_,
                     doppler_max_, if_, fs_in_, code_length_, code_length_,
                     bit_transition_flag_, dump_, dump_filename_);
@@ -204,7 +210,7 @@ void GpsL1CaPcpsOpenClAcquisition::set_local_code()
         {
             std::complex<float>* code = new std::complex<float>[code_length_];
 
-            gps_l1_ca_code_gen_complex_sampled(code, gnss_synchro_->PRN, fs_in_, 0);
+            Code_Bank::gps_l1_ca_code_gen_complex_sampled(code, gnss_synchro_->PRN, fs_in_, 0);
 
             for (unsigned int i = 0; i < sampled_ms_; i++)
                 {
@@ -34,6 +34,7 @@
 #include <boost/math/distributions/exponential.hpp>
 #include <glog/logging.h>
 #include "gps_sdr_signal_processing.h"
+#include "code_bank.h"
 #include "GPS_L1_CA.h"
 #include "configuration_interface.h"
 
@@ -237,7 +238,7 @@ void GpsL1CaPcpsQuickSyncAcquisition::set_local_code()
         {
             std::complex<float>* code = new std::complex<float>[code_length_]();
 
-            gps_l1_ca_code_gen_complex_sampled(code, gnss_synchro_->PRN, fs_in_, 0);
+            Code_Bank::gps_l1_ca_code_gen_complex_sampled(code, gnss_synchro_->PRN, fs_in_, 0);
 
 
             for (unsigned int i = 0; i < (sampled_ms_/folding_factor_); i++)
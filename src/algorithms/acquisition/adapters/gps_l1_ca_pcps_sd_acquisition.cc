@@ -35,9 +35,12 @@
  */
 
 #include "gps_l1_ca_pcps_sd_acquisition.h"
+#include <algorithm>
+#include <cmath>
 #include <boost/math/distributions/exponential.hpp>
 #include <glog/logging.h>
 #include "gps_sdr_signal_processing.h"
+#include "code_bank.h"
 #include "GPS_L1_CA.h"
 #include "configuration_interface.h"
 
@@ -96,6 +99,23 @@ GpsL1CaPcpsSdAcquisition::GpsL1CaPcpsSdAcquisition(
                         doppler_max_, if_, fs_in_, code_length_, code_length_,
                         bit_transition_flag_, use_CFAR_algorithm_flag_, dump_, dump_filename_);
                 DLOG(INFO) << "acquisition(" << acquisition_cc_->unique_id() << ")";
+                acquisition_cc_->set_frequency_domain_doppler(configuration_->property(role + ".frequency_domain_doppler", false));
+                acquisition_cc_->set_pooled_engine(configuration_->property(role + ".pooled_engine", false));
+                // by default, the code phase window is two chips wide on each side
+                unsigned int code_window_samples = std::max(1, static_cast<int>(2 * code_length_ / GPS_L1_CA_CODE_LENGTH_CHIPS));
+                acquisition_cc_->set_reacquisition(configuration_->property(role + ".reacquisition", false),
+                        configuration_->property(role + ".reacquisition_doppler_window_hz", 500),
+                        configuration_->property(role + ".reacquisition_code_window_samples", code_window_samples),
+                        configuration_->property(role + ".reacquisition_max_age_ms", 30000));
+                acquisition_cc_->set_peak_list_max_age(configuration_->property(role + ".peak_list_max_age_ms", 1000));
+                // by default, the auxiliary peaks are searched as far from the authentic one as SPREE tolerates
+                double max_rx_discrepancy_ns = configuration_->property("Spoofing.APT_max_rx_discrepancy", 500.0);
+                unsigned int apt_code_window_samples = std::max(code_window_samples,
+                        static_cast<unsigned int>(std::ceil(max_rx_discrepancy_ns * 1e-9 * static_cast<double>(fs_in_))));
+                acquisition_cc_->set_apt_window(configuration_->property(role + ".apt_window", false),
+                        configuration_->property(role + ".apt_window_doppler_hz", 500),
+                        configuration_->property(role + ".apt_window_code_samples", apt_code_window_samples),
+                        configuration_->property(role + ".apt_window_max_age_ms", 1000));
         }
 
     stream_to_vector_ = gr::blocks::stream_to_vector::make(item_size_, vector_length_);
@@ -130,6 +150,12 @@ void GpsL1CaPcpsSdAcquisition::set_channel(unsigned int channel)
     else
         {
             acquisition_cc_->set_channel(channel_);
+            if (item_type_.compare("gr_complex") == 0)
+                {
+                    // the samples kept by the flowgraph for the signal conditioner of the channel, if any
+                    history_ = Sample_History::find(configuration_->property("Channel" + std::to_string(channel_) + ".RF_channel_ID", 0));
+                    acquisition_cc_->set_sample_history(history_);
+                }
         }
 
 }
@@ -240,7 +266,7 @@ void GpsL1CaPcpsSdAcquisition::set_local_code()
 
     std::complex<float>* code = new std::complex<float>[code_length_];
 
-    gps_l1_ca_code_gen_complex_sampled(code, gnss_synchro_->PRN, fs_in_, 0);
+    Code_Bank::gps_l1_ca_code_gen_complex_sampled(code, gnss_synchro_->PRN, fs_in_, 0);
 
     for (unsigned int i = 0; i < sampled_ms_; i++)
         {
@@ -312,7 +338,10 @@ void GpsL1CaPcpsSdAcquisition::connect(gr::top_block_sptr top_block)
 {
     if (item_type_.compare("gr_complex") == 0)
         {
-            top_block->connect(stream_to_vector_, 0, acquisition_cc_, 0);
+            if (!history_)
+                {
+                    top_block->connect(stream_to_vector_, 0, acquisition_cc_, 0);
+                }
         }
     else if (item_type_.compare("cshort") == 0)
         {
@@ -336,7 +365,10 @@ void GpsL1CaPcpsSdAcquisition::disconnect(gr::top_block_sptr top_block)
 {
     if (item_type_.compare("gr_complex") == 0)
         {
-            top_block->disconnect(stream_to_vector_, 0, acquisition_cc_, 0);
+            if (!history_)
+                {
+                    top_block->disconnect(stream_to_vector_, 0, acquisition_cc_, 0);
+                }
         }
     else if (item_type_.compare("cshort") == 0)
         {
@@ -362,6 +394,10 @@ gr::basic_block_sptr GpsL1CaPcpsSdAcquisition::get_left_block()
 {
     if (item_type_.compare("gr_complex") == 0)
         {
+            if (history_)
+                {
+                    return acquisition_cc_;
+                }
             return stream_to_vector_;
         }
     else if (item_type_.compare("cshort") == 0)
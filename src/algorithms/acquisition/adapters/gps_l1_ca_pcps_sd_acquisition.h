@@ -143,6 +143,7 @@ private:
     pcps_sd_acquisition_cc_sptr acquisition_cc_;
     pcps_sd_acquisition_sc_sptr acquisition_sc_;
     gr::blocks::stream_to_vector::sptr stream_to_vector_;
+    std::shared_ptr<Sample_History> history_; // of the signal conditioner, replaces stream_to_vector_
     gr::blocks::float_to_complex::sptr float_to_complex_;
     complex_byte_to_float_x2_sptr cbyte_to_float_x2_;
     size_t item_size_;
@@ -0,0 +1,278 @@
+/*!
+ * \file gps_l1_ca_pcps_server_acquisition.cc
+ * \brief Adapts a PCPS acquisition block searching in the acquisition server to an
+ *  AcquisitionInterface for GPS L1 C/A signals
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "gps_l1_ca_pcps_server_acquisition.h"
+#include <boost/math/distributions/exponential.hpp>
+#include <glog/logging.h>
+#include "gps_sdr_signal_processing.h"
+#include "code_bank.h"
+#include "GPS_L1_CA.h"
+#include "configuration_interface.h"
+
+using google::LogMessage;
+
+GpsL1CaPcpsServerAcquisition::GpsL1CaPcpsServerAcquisition(
+        ConfigurationInterface* configuration, std::string role,
+        unsigned int in_streams, unsigned int out_streams) :
+    role_(role), in_streams_(in_streams), out_streams_(out_streams)
+{
+    configuration_ = configuration;
+    std::string default_item_type = "gr_complex";
+
+    DLOG(INFO) << "role " << role;
+
+    item_type_ = configuration_->property(role + ".item_type",
+            default_item_type);
+
+    fs_in_ = configuration_->property("GNSS-SDR.internal_fs_hz", 2048000);
+    if_ = configuration_->property(role + ".if", 0);
+    doppler_max_ = configuration->property(role + ".doppler_max", 5000);
+    sampled_ms_ = configuration_->property(role + ".coherent_integration_time_ms", 1);
+
+    use_CFAR_algorithm_flag_ = configuration_->property(role + ".use_CFAR_algorithm", true); //will be false in future versions
+    max_dwells_ = configuration_->property(role + ".max_dwells", 1);
+    if (configuration_->property("Acquisition.bit_transition_flag", false))
+        {
+            LOG(WARNING) << "The bit transition mode is not implemented in " << implementation();
+        }
+    // the searches run in the acquisition server of the machine, see pcps_server_acquisition_cc
+    std::string default_server_filename = "/dev/shm/gnss-sdr-acquisition";
+    server_filename_ = configuration_->property(role + ".server_filename", default_server_filename);
+    server_timeout_ms_ = configuration_->property(role + ".server_timeout_ms", 1000);
+
+    //--- Find number of samples per spreading code -------------------------
+    code_length_ = round(fs_in_
+            / (GPS_L1_CA_CODE_RATE_HZ / GPS_L1_CA_CODE_LENGTH_CHIPS));
+
+    vector_length_ = code_length_ * sampled_ms_;
+
+    code_ = new gr_complex[vector_length_];
+
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            item_size_ = sizeof(gr_complex);
+            acquisition_cc_ = pcps_make_server_acquisition_cc(sampled_ms_, max_dwells_,
+                    doppler_max_, if_, fs_in_, code_length_, code_length_,
+                    use_CFAR_algorithm_flag_, server_filename_, server_timeout_ms_);
+
+            stream_to_vector_ = gr::blocks::stream_to_vector::make(item_size_, vector_length_);
+
+            DLOG(INFO) << "stream_to_vector(" << stream_to_vector_->unique_id() << ")";
+            DLOG(INFO) << "acquisition(" << acquisition_cc_->unique_id() << ")";
+        }
+    else
+        {
+            item_size_ = sizeof(gr_complex);
+            LOG(WARNING) << item_type_ << " unknown acquisition item type";
+        }
+
+    channel_ = 0;
+    threshold_ = 0.0;
+    doppler_step_ = 0;
+    gnss_synchro_ = 0;
+}
+
+
+GpsL1CaPcpsServerAcquisition::~GpsL1CaPcpsServerAcquisition()
+{
+    delete[] code_;
+}
+
+
+void GpsL1CaPcpsServerAcquisition::set_channel(unsigned int channel)
+{
+    channel_ = channel;
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            acquisition_cc_->set_channel(channel_);
+        }
+}
+
+
+void GpsL1CaPcpsServerAcquisition::set_threshold(float threshold)
+{
+    float pfa = configuration_->property(role_ + boost::lexical_cast<std::string>(channel_) + ".pfa", 0.0);
+
+    if(pfa == 0.0)
+        {
+            pfa = configuration_->property(role_ + ".pfa", 0.0);
+        }
+    if(pfa == 0.0)
+        {
+            threshold_ = threshold;
+        }
+    else
+        {
+            threshold_ = calculate_threshold(pfa);
+        }
+
+    DLOG(INFO) << "Channel " << channel_ << " Threshold = " << threshold_;
+
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            acquisition_cc_->set_threshold(threshold_);
+        }
+}
+
+
+void GpsL1CaPcpsServerAcquisition::set_doppler_max(unsigned int doppler_max)
+{
+    doppler_max_ = doppler_max;
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            acquisition_cc_->set_doppler_max(doppler_max_);
+        }
+}
+
+
+void GpsL1CaPcpsServerAcquisition::set_doppler_step(unsigned int doppler_step)
+{
+    doppler_step_ = doppler_step;
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            acquisition_cc_->set_doppler_step(doppler_step_);
+        }
+
+}
+
+
+void GpsL1CaPcpsServerAcquisition::set_gnss_synchro(Gnss_Synchro* gnss_synchro)
+{
+    gnss_synchro_ = gnss_synchro;
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            acquisition_cc_->set_gnss_synchro(gnss_synchro_);
+        }
+}
+
+
+signed int GpsL1CaPcpsServerAcquisition::mag()
+{
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            return acquisition_cc_->mag();
+        }
+    else
+        {
+            return 0;
+        }
+}
+
+
+void GpsL1CaPcpsServerAcquisition::init()
+{
+    acquisition_cc_->init();
+    set_local_code();
+}
+
+
+void GpsL1CaPcpsServerAcquisition::set_local_code()
+{
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            std::complex<float>* code = new std::complex<float>[code_length_];
+
+            Code_Bank::gps_l1_ca_code_gen_complex_sampled(code, gnss_synchro_->PRN, fs_in_, 0);
+
+            for (unsigned int i = 0; i < sampled_ms_; i++)
+                {
+                    memcpy(&(code_[i*code_length_]), code,
+                            sizeof(gr_complex)*code_length_);
+                }
+
+            acquisition_cc_->set_local_code(code_);
+
+            delete[] code;
+        }
+}
+
+
+void GpsL1CaPcpsServerAcquisition::reset()
+{
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            acquisition_cc_->set_active(true);
+        }
+}
+
+
+float GpsL1CaPcpsServerAcquisition::calculate_threshold(float pfa)
+{
+    //Calculate the threshold
+
+    unsigned int frequency_bins = 0;
+    for (int doppler = (int)(-doppler_max_); doppler <= (int)doppler_max_; doppler += doppler_step_)
+        {
+            frequency_bins++;
+        }
+
+    DLOG(INFO) << "Channel " << channel_ << "  Pfa = " << pfa;
+
+    unsigned int ncells = vector_length_ * frequency_bins;
+    double exponent = 1 / static_cast<double>(ncells);
+    double val = pow(1.0 - pfa, exponent);
+    double lambda = double(vector_length_);
+    boost::math::exponential_distribution<double> mydist (lambda);
+    float threshold = (float)quantile(mydist,val);
+
+    return threshold;
+}
+
+
+void GpsL1CaPcpsServerAcquisition::connect(gr::top_block_sptr top_block)
+{
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            top_block->connect(stream_to_vector_, 0, acquisition_cc_, 0);
+        }
+}
+
+
+void GpsL1CaPcpsServerAcquisition::disconnect(gr::top_block_sptr top_block)
+{
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            top_block->disconnect(stream_to_vector_, 0, acquisition_cc_, 0);
+        }
+}
+
+
+gr::basic_block_sptr GpsL1CaPcpsServerAcquisition::get_left_block()
+{
+    return stream_to_vector_;
+}
+
+
+gr::basic_block_sptr GpsL1CaPcpsServerAcquisition::get_right_block()
+{
+    return acquisition_cc_;
+}
+
@@ -32,9 +32,11 @@
  */
 
 #include "gps_l2_m_pcps_acquisition.h"
+#include <algorithm>
 #include <boost/math/distributions/exponential.hpp>
 #include <glog/logging.h>
 #include "gps_l2c_signal.h"
+#include "code_bank.h"
 #include "GPS_L2C.h"
 #include "configuration_interface.h"
 
@@ -94,6 +96,18 @@ GpsL2MPcpsAcquisition::GpsL2MPcpsAcquisition(
                         doppler_max_, if_, fs_in_, code_length_, code_length_,
                         bit_transition_flag_, use_CFAR_algorithm_flag_, dump_, dump_filename_);
                 DLOG(INFO) << "acquisition(" << acquisition_cc_->unique_id() << ")";
+                acquisition_cc_->set_frequency_domain_doppler(configuration_->property(role + ".frequency_domain_doppler", false));
+                acquisition_cc_->set_pooled_engine(configuration_->property(role + ".pooled_engine", false));
+                acquisition_cc_->set_non_coherent_integration(configuration_->property(role + ".non_coherent_integration", false));
+                // L1 aiding: the GPS L1 tracking of the satellite gives its Doppler, and its code
+                // start modulo the 1 ms of a C/A code, so only a few Doppler bins are searched,
+                // on two chips around each of the 20 candidate code starts by default
+                unsigned int code_window_samples = std::max(1, static_cast<int>(2 * code_length_ / GPS_L2_M_CODE_LENGTH_CHIPS));
+                acquisition_cc_->set_reacquisition(configuration_->property(role + ".l1_aiding", false),
+                        configuration_->property(role + ".l1_aiding_doppler_window_hz", 100),
+                        configuration_->property(role + ".l1_aiding_code_window_samples", code_window_samples),
+                        configuration_->property(role + ".l1_aiding_max_age_ms", 1000));
+                acquisition_cc_->set_hint_carrier(GPS_L2_FREQ_HZ, round(static_cast<double>(fs_in_) / 1000.0));
         }
 
     stream_to_vector_ = gr::blocks::stream_to_vector::make(item_size_, vector_length_);
@@ -240,7 +254,7 @@ void GpsL2MPcpsAcquisition::init()
 void GpsL2MPcpsAcquisition::set_local_code()
 {
 
-    gps_l2c_m_code_gen_complex_sampled(code_, gnss_synchro_->PRN, fs_in_);
+    Code_Bank::gps_l2c_m_code_gen_complex_sampled(code_, gnss_synchro_->PRN, fs_in_);
     
     if (item_type_.compare("cshort") == 0)
         {
@@ -0,0 +1,335 @@
+/*!
+ * \file acquisition_cache.cc
+ * \brief Implementation of the process-wide caches of Doppler wipeoff grids,
+ * local code FFTs and input FFTs shared by the acquisition blocks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "acquisition_cache.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <new>
+#include <string>
+#include <boost/thread/mutex.hpp>
+#include <glog/logging.h>
+#include <volk/volk.h>
+#include <volk_gnsssdr/volk_gnsssdr.h>
+#include "GPS_L1_CA.h" //GPS_TWO_PI
+#include "buffer_allocator.h"
+
+using google::LogMessage;
+
+namespace
+{
+struct Grid_Key
+{
+    long fs_in;
+    long freq;
+    unsigned int doppler_max;
+    unsigned int doppler_step;
+    unsigned int num_doppler_bins;
+    unsigned int length;
+
+    bool operator<(const Grid_Key& other) const
+    {
+        if (fs_in != other.fs_in) return fs_in < other.fs_in;
+        if (freq != other.freq) return freq < other.freq;
+        if (doppler_max != other.doppler_max) return doppler_max < other.doppler_max;
+        if (doppler_step != other.doppler_step) return doppler_step < other.doppler_step;
+        if (num_doppler_bins != other.num_doppler_bins) return num_doppler_bins < other.num_doppler_bins;
+        return length < other.length;
+    }
+};
+
+struct Code_Key
+{
+    char system;
+    std::string signal;
+    unsigned int PRN;
+    unsigned int fft_size;
+    unsigned long long fingerprint;
+
+    bool operator<(const Code_Key& other) const
+    {
+        if (system != other.system) return system < other.system;
+        if (signal != other.signal) return signal < other.signal;
+        if (PRN != other.PRN) return PRN < other.PRN;
+        if (fft_size != other.fft_size) return fft_size < other.fft_size;
+        return fingerprint < other.fingerprint;
+    }
+};
+
+struct Input_Key
+{
+    const Doppler_Wipeoff_Grid* grid;
+    unsigned int fft_size;
+    unsigned long int sample_stamp;
+    unsigned long long fingerprint;
+
+    bool operator<(const Input_Key& other) const
+    {
+        if (grid != other.grid) return grid < other.grid;
+        if (fft_size != other.fft_size) return fft_size < other.fft_size;
+        if (sample_stamp != other.sample_stamp) return sample_stamp < other.sample_stamp;
+        return fingerprint < other.fingerprint;
+    }
+};
+
+// Number of input FFT batches kept alive for the channels lagging behind
+const unsigned int retained_input_batches = 4;
+
+boost::mutex cache_mutex;
+std::map<Grid_Key, std::weak_ptr<const Doppler_Wipeoff_Grid> > grid_cache;
+std::map<Code_Key, std::weak_ptr<const Code_Fft> > code_cache;
+std::map<Input_Key, std::weak_ptr<Input_Fft_Batch> > input_cache;
+std::deque<std::shared_ptr<Input_Fft_Batch> > retained_inputs;
+
+
+template<typename Key, typename Value>
+void remove_expired(std::map<Key, std::weak_ptr<Value> >& cache)
+{
+    typename std::map<Key, std::weak_ptr<Value> >::iterator it = cache.begin();
+    while (it != cache.end())
+        {
+            if (it->second.expired())
+                {
+                    cache.erase(it++);
+                }
+            else
+                {
+                    ++it;
+                }
+        }
+}
+
+
+/*
+ * All the rows in one buffer, so that a search walks through few huge pages,
+ * each row starting on an alignment boundary
+ */
+void allocate_rows(std::vector<gr_complex*>& rows, unsigned int length)
+{
+    size_t stride = (length * sizeof(gr_complex) + Buffer_Allocator::alignment - 1) / Buffer_Allocator::alignment * Buffer_Allocator::alignment;
+    char* buffer = static_cast<char*>(Buffer_Allocator::allocate(stride * rows.size(), "acquisition"));
+    if (buffer == 0)
+        {
+            throw std::bad_alloc();
+        }
+    for (unsigned int i = 0; i < rows.size(); i++)
+        {
+            rows[i] = reinterpret_cast<gr_complex*>(buffer + i * stride);
+        }
+}
+
+
+void release_rows(std::vector<gr_complex*>& rows)
+{
+    if (!rows.empty())
+        {
+            Buffer_Allocator::release(rows[0]);
+        }
+}
+}
+
+
+Doppler_Wipeoff_Grid::Doppler_Wipeoff_Grid(long fs_in, long freq, unsigned int doppler_max, unsigned int doppler_step,
+        unsigned int num_doppler_bins, unsigned int length) :
+        d_wipeoffs(num_doppler_bins),
+        d_length(length)
+{
+    allocate_rows(d_wipeoffs, length);
+    for (unsigned int doppler_index = 0; doppler_index < num_doppler_bins; doppler_index++)
+        {
+            int doppler = -static_cast<int>(doppler_max) + doppler_step * doppler_index;
+            float phase_step_rad = static_cast<float>(GPS_TWO_PI) * (freq + doppler) / static_cast<float>(fs_in);
+            float _phase[1];
+            _phase[0] = 0;
+            volk_gnsssdr_s32f_nco_32fc(d_wipeoffs[doppler_index], - phase_step_rad, _phase, length);
+        }
+}
+
+
+Doppler_Wipeoff_Grid::~Doppler_Wipeoff_Grid()
+{
+    release_rows(d_wipeoffs);
+}
+
+
+Code_Fft::Code_Fft(unsigned int fft_size) :
+        d_fft_size(fft_size)
+{
+    d_fft_code = static_cast<gr_complex*>(Buffer_Allocator::allocate(fft_size * sizeof(gr_complex), "acquisition"));
+    if (d_fft_code == 0)
+        {
+            throw std::bad_alloc();
+        }
+}
+
+
+Code_Fft::~Code_Fft()
+{
+    Buffer_Allocator::release(d_fft_code);
+}
+
+
+Input_Fft_Batch::Input_Fft_Batch(const std::shared_ptr<const Doppler_Wipeoff_Grid>& grid, unsigned int fft_size) :
+        d_grid(grid),
+        d_ffts(grid->num_doppler_bins()),
+        d_ready(false)
+{
+    allocate_rows(d_ffts, fft_size);
+}
+
+
+Input_Fft_Batch::~Input_Fft_Batch()
+{
+    release_rows(d_ffts);
+}
+
+
+// FNV-1a over the samples, taken as 64-bit words
+unsigned long long Acquisition_Cache::fingerprint(const gr_complex* samples, unsigned int length)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    for (unsigned int i = 0; i < length; i++)
+        {
+            unsigned long long word;
+            std::memcpy(&word, &samples[i], sizeof(word));
+            hash ^= word;
+            hash *= 1099511628211ULL;
+        }
+    return hash;
+}
+
+
+std::shared_ptr<const Doppler_Wipeoff_Grid> Acquisition_Cache::doppler_wipeoff_grid(long fs_in, long freq,
+        unsigned int doppler_max, unsigned int doppler_step,
+        unsigned int num_doppler_bins, unsigned int length)
+{
+    Grid_Key key = {fs_in, freq, doppler_max, doppler_step, num_doppler_bins, length};
+    boost::mutex::scoped_lock lock(cache_mutex);
+    std::shared_ptr<const Doppler_Wipeoff_Grid> grid = grid_cache[key].lock();
+    if (!grid)
+        {
+            // built under the lock: the channels are initialized at the same
+            // time and they must not build the same grid concurrently
+            remove_expired(grid_cache);
+            grid = std::make_shared<Doppler_Wipeoff_Grid>(fs_in, freq, doppler_max, doppler_step, num_doppler_bins, length);
+            grid_cache[key] = grid;
+            DLOG(INFO) << "New Doppler wipeoff grid: fs_in " << fs_in << " freq " << freq
+                       << " doppler_max " << doppler_max << " doppler_step " << doppler_step
+                       << " bins " << num_doppler_bins << " length " << length;
+        }
+    return grid;
+}
+
+
+std::shared_ptr<const Code_Fft> Acquisition_Cache::code_fft(char system, const char* signal, unsigned int PRN,
+        gr::fft::fft_complex* fft)
+{
+    unsigned int fft_size = fft->inbuf_length();
+    // Gnss_Synchro::Signal is not always null terminated
+    Code_Key key = {system, std::string(signal, std::find(signal, signal + 3, '\0')), PRN, fft_size, fingerprint(fft->get_inbuf(), fft_size)};
+    {
+        boost::mutex::scoped_lock lock(cache_mutex);
+        std::map<Code_Key, std::weak_ptr<const Code_Fft> >::iterator it = code_cache.find(key);
+        if (it != code_cache.end())
+            {
+                std::shared_ptr<const Code_Fft> code = it->second.lock();
+                if (code)
+                    {
+                        return code;
+                    }
+            }
+    }
+
+    // the FFT runs on the caller's plan, outside the lock
+    fft->execute();
+    std::shared_ptr<Code_Fft> code = std::make_shared<Code_Fft>(fft_size);
+    volk_32fc_conjugate_32fc(code->d_fft_code, fft->get_outbuf(), fft_size);
+
+    boost::mutex::scoped_lock lock(cache_mutex);
+    std::shared_ptr<const Code_Fft> cached = code_cache[key].lock();
+    if (cached)
+        {
+            // another channel computed it in the meantime
+            return cached;
+        }
+    remove_expired(code_cache);
+    code_cache[key] = code;
+    return code;
+}
+
+
+std::shared_ptr<const Input_Fft_Batch> Acquisition_Cache::input_fft_batch(const std::shared_ptr<const Doppler_Wipeoff_Grid>& grid,
+        unsigned long int sample_stamp, const gr_complex* in, gr::fft::fft_complex* fft)
+{
+    unsigned int length = grid->length();
+    unsigned int fft_size = fft->inbuf_length();
+    Input_Key key = {grid.get(), fft_size, sample_stamp, fingerprint(in, length)};
+    std::shared_ptr<Input_Fft_Batch> batch;
+    {
+        boost::mutex::scoped_lock lock(cache_mutex);
+        batch = input_cache[key].lock();
+        if (!batch)
+            {
+                remove_expired(input_cache);
+                batch = std::make_shared<Input_Fft_Batch>(grid, fft_size);
+                input_cache[key] = batch;
+                retained_inputs.push_back(batch);
+                if (retained_inputs.size() > retained_input_batches)
+                    {
+                        retained_inputs.pop_front();
+                    }
+            }
+    }
+
+    // The channels that find the batch being computed wait here for it
+    boost::mutex::scoped_lock lock(batch->d_mutex);
+    if (!batch->d_ready)
+        {
+            const gr_complex* const* wipeoffs = grid->wipeoffs();
+            unsigned int folds = length / fft_size;
+            for (unsigned int doppler_index = 0; doppler_index < batch->d_ffts.size(); doppler_index++)
+                {
+                    if (folds > 1)
+                        {
+                            volk_gnsssdr_32fc_x2_multiply_fold_32fc(fft->get_inbuf(), in, wipeoffs[doppler_index], folds, fft_size);
+                        }
+                    else
+                        {
+                            volk_32fc_x2_multiply_32fc(fft->get_inbuf(), in, wipeoffs[doppler_index], fft_size);
+                        }
+                    fft->execute();
+                    memcpy(batch->d_ffts[doppler_index], fft->get_outbuf(), sizeof(gr_complex) * fft_size);
+                }
+            batch->d_ready = true;
+        }
+    return batch;
+}
@@ -0,0 +1,181 @@
+/*!
+ * \file acquisition_cache.h
+ * \brief Interface of the process-wide caches of Doppler wipeoff grids, local
+ * code FFTs and input FFTs shared by the acquisition blocks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_ACQUISITION_CACHE_H_
+#define GNSS_SDR_ACQUISITION_CACHE_H_
+
+#include <memory>
+#include <vector>
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/fft/fft.h>
+#include <boost/thread/mutex.hpp>
+
+/*!
+ * \brief Carrier Doppler wipeoff signals of an acquisition search grid.
+ *
+ * Bin i holds length samples of exp(-j*2*pi*(freq + doppler_i)*n/fs_in),
+ * with doppler_i = -doppler_max + i*doppler_step. The grid is read-only
+ * once built, so any number of blocks can use it at the same time.
+ */
+class Doppler_Wipeoff_Grid
+{
+public:
+    Doppler_Wipeoff_Grid(long fs_in, long freq, unsigned int doppler_max, unsigned int doppler_step,
+            unsigned int num_doppler_bins, unsigned int length);
+    ~Doppler_Wipeoff_Grid();
+
+    const gr_complex* const* wipeoffs() const { return &d_wipeoffs[0]; } //!< One pointer per Doppler bin
+    unsigned int num_doppler_bins() const { return d_wipeoffs.size(); }
+    unsigned int length() const { return d_length; }
+
+private:
+    Doppler_Wipeoff_Grid(const Doppler_Wipeoff_Grid&);
+    Doppler_Wipeoff_Grid& operator=(const Doppler_Wipeoff_Grid&);
+
+    std::vector<gr_complex*> d_wipeoffs;
+    unsigned int d_length;
+};
+
+
+/*!
+ * \brief Conjugated FFT of a local code replica, as used by the PCPS blocks.
+ */
+class Code_Fft
+{
+public:
+    explicit Code_Fft(unsigned int fft_size);
+    ~Code_Fft();
+
+    const gr_complex* get() const { return d_fft_code; }
+    unsigned int fft_size() const { return d_fft_size; }
+
+private:
+    friend class Acquisition_Cache;
+    Code_Fft(const Code_Fft&);
+    Code_Fft& operator=(const Code_Fft&);
+
+    gr_complex* d_fft_code;
+    unsigned int d_fft_size;
+};
+
+
+/*!
+ * \brief FFTs of one input block wiped off with every bin of a Doppler grid.
+ *
+ * This is the part of the PCPS search that does not depend on the PRN:
+ * the channels that search the same samples with the same grid only have
+ * to multiply these by their code FFT and run the inverse FFT. For the
+ * QuickSync blocks, the wiped off block is folded onto the FFT size first.
+ */
+class Input_Fft_Batch
+{
+public:
+    Input_Fft_Batch(const std::shared_ptr<const Doppler_Wipeoff_Grid>& grid, unsigned int fft_size);
+    ~Input_Fft_Batch();
+
+    const gr_complex* get(unsigned int doppler_index) const { return d_ffts[doppler_index]; }
+
+private:
+    friend class Acquisition_Cache;
+    Input_Fft_Batch(const Input_Fft_Batch&);
+    Input_Fft_Batch& operator=(const Input_Fft_Batch&);
+
+    std::shared_ptr<const Doppler_Wipeoff_Grid> d_grid;
+    std::vector<gr_complex*> d_ffts;
+    bool d_ready;
+    boost::mutex d_mutex;
+};
+
+
+/*!
+ * \brief Process-wide caches of Doppler wipeoff grids and code FFTs.
+ *
+ * All the channels of a receiver usually acquire with the same sampling
+ * frequency, IF and Doppler search parameters, so instead of every block
+ * allocating its own copy of the grid, the blocks get a shared one from
+ * here. Likewise, the conjugated FFT of a code is computed once per
+ * satellite signal and reused when a channel is assigned a PRN that
+ * another channel (or itself, earlier) has already searched for.
+ *
+ * The input FFTs of a dwell are also shared, see input_fft_batch().
+ *
+ * The grid and code caches only keep weak references: an entry is freed
+ * as soon as the last block holding it releases it. All the functions are
+ * thread-safe.
+ */
+class Acquisition_Cache
+{
+public:
+    /*!
+     * \brief Returns the grid for these parameters, building it if no block holds it
+     */
+    static std::shared_ptr<const Doppler_Wipeoff_Grid> doppler_wipeoff_grid(long fs_in, long freq,
+            unsigned int doppler_max, unsigned int doppler_step,
+            unsigned int num_doppler_bins, unsigned int length);
+
+    /*!
+     * \brief Returns the conjugated FFT of the code replica in the input buffer of fft
+     *
+     * The caller fills fft->get_inbuf() with the replica exactly as it
+     * would be transformed (zero padding included). The key is the
+     * satellite signal (system, signal, PRN), the FFT size and a
+     * fingerprint of the replica, so blocks that build different replicas
+     * for the same PRN (e.g. CBOC or zero padded) never share an entry. On
+     * a miss, fft is executed and its output buffer is overwritten.
+     */
+    static std::shared_ptr<const Code_Fft> code_fft(char system, const char* signal, unsigned int PRN,
+            gr::fft::fft_complex* fft);
+
+    /*!
+     * \brief Returns the FFTs of in wiped off with every bin of grid
+     *
+     * All the acquisition channels are fed the same signal, so during a
+     * cold start most of them search the same dwell at the same time. The
+     * first one to get here for a dwell computes the FFTs, using its own
+     * fft plan; the others wait for it and reuse them. The dwell is
+     * identified by its sample stamp and a fingerprint of in, which must
+     * hold grid->length() samples. The last few batches are retained for
+     * the channels that lag behind.
+     *
+     * If the size of fft is smaller than grid->length(), the wiped off
+     * input is folded (its grid->length() / fft size segments are added
+     * together) before the FFT, as in the QuickSync algorithm.
+     */
+    static std::shared_ptr<const Input_Fft_Batch> input_fft_batch(const std::shared_ptr<const Doppler_Wipeoff_Grid>& grid,
+            unsigned long int sample_stamp, const gr_complex* in, gr::fft::fft_complex* fft);
+
+    /*!
+     * \brief Hash of length samples, used to tell apart the inputs of different signal sources
+     */
+    static unsigned long long fingerprint(const gr_complex* samples, unsigned int length);
+};
+
+#endif
@@ -0,0 +1,187 @@
+/*!
+ * \file acquisition_grid_dump.cc
+ * \brief Dump of the acquisition search grids, one file per search,
+ * written in the background
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "acquisition_grid_dump.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <glog/logging.h>
+#include <volk/volk.h>
+
+using google::LogMessage;
+
+Acquisition_Grid_Dump::Acquisition_Grid_Dump(const std::string& dump_filename) :
+    d_dump_filename(dump_filename),
+    d_front(0),
+    d_open(false),
+    d_pending(false),
+    d_stop(false),
+    d_searches(0)
+{
+    d_writer = boost::thread(boost::bind(&Acquisition_Grid_Dump::run, this));
+}
+
+
+Acquisition_Grid_Dump::~Acquisition_Grid_Dump()
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_stop = true;
+    }
+    d_condition.notify_all();
+    d_writer.join();
+}
+
+
+void Acquisition_Grid_Dump::begin(const Gnss_Synchro& synchro, unsigned int channel, unsigned long int sample_stamp, long fs_in,
+        int doppler_min_hz, unsigned int doppler_step_hz, unsigned int num_doppler_bins, unsigned int line_length)
+{
+    Grid& grid = d_grids[d_front];
+    Acquisition_Grid_Header& header = grid.header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "GSACQGRD", sizeof(header.magic));
+    header.version = 1;
+    header.header_bytes = sizeof(Acquisition_Grid_Header);
+    header.sample_stamp = sample_stamp;
+    header.fs_in = fs_in;
+    header.doppler_min_hz = doppler_min_hz;
+    header.doppler_step_hz = doppler_step_hz;
+    header.num_doppler_bins = num_doppler_bins;
+    header.line_length = line_length;
+    header.PRN = synchro.PRN;
+    header.channel = channel;
+    header.system = synchro.System;
+    memcpy(header.signal, synchro.Signal, sizeof(header.signal));
+    grid.values.assign(static_cast<size_t>(num_doppler_bins) * line_length, 0.0);
+
+    std::stringstream filename;
+    boost::filesystem::path p = d_dump_filename;
+    filename << p.parent_path().string()
+             << boost::filesystem::path::preferred_separator
+             << p.stem().string()
+             << "_" << synchro.System
+             << "_" << std::string(synchro.Signal, 2) << "_sat_"
+             << synchro.PRN << "_ch_" << channel
+             << "_" << d_searches
+             << p.extension().string();
+    grid.filename = filename.str();
+    d_searches++;
+    d_open = true;
+}
+
+
+void Acquisition_Grid_Dump::write_line(unsigned int doppler_index, const float* magnitude)
+{
+    Grid& grid = d_grids[d_front];
+    if (!d_open || doppler_index >= grid.header.num_doppler_bins)
+        {
+            return;
+        }
+    memcpy(&grid.values[static_cast<size_t>(doppler_index) * grid.header.line_length], magnitude, grid.header.line_length * sizeof(float));
+    boost::mutex::scoped_lock lock(d_lines_mutex);
+    grid.header.lines_searched++;
+}
+
+
+void Acquisition_Grid_Dump::write_line(unsigned int doppler_index, const gr_complex* correlation)
+{
+    Grid& grid = d_grids[d_front];
+    if (!d_open || doppler_index >= grid.header.num_doppler_bins)
+        {
+            return;
+        }
+    volk_32fc_magnitude_squared_32f(&grid.values[static_cast<size_t>(doppler_index) * grid.header.line_length], correlation, grid.header.line_length);
+    boost::mutex::scoped_lock lock(d_lines_mutex);
+    grid.header.lines_searched++;
+}
+
+
+void Acquisition_Grid_Dump::end()
+{
+    if (!d_open)
+        {
+            return;
+        }
+    d_open = false;
+    boost::mutex::scoped_lock lock(d_mutex);
+    while (d_pending)
+        {
+            d_condition.wait(lock);
+        }
+    // the writer has saved its grid: the buffers swap roles
+    d_front = 1 - d_front;
+    d_pending = true;
+    lock.unlock();
+    d_condition.notify_all();
+}
+
+
+void Acquisition_Grid_Dump::run()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    while (true)
+        {
+            while (!d_pending && !d_stop)
+                {
+                    d_condition.wait(lock);
+                }
+            if (!d_pending)
+                {
+                    return;
+                }
+            const Grid& grid = d_grids[1 - d_front];
+            lock.unlock();
+            save(grid);
+            lock.lock();
+            d_pending = false;
+            d_condition.notify_all();
+        }
+}
+
+
+void Acquisition_Grid_Dump::save(const Grid& grid)
+{
+    DLOG(INFO) << "Writing ACQ grid to " << grid.filename;
+    std::ofstream dump_file(grid.filename.c_str(), std::ios::out | std::ios::binary);
+    dump_file.write(reinterpret_cast<const char*>(&grid.header), sizeof(grid.header));
+    if (!grid.values.empty())
+        {
+            dump_file.write(reinterpret_cast<const char*>(&grid.values[0]), grid.values.size() * sizeof(float));
+        }
+    if (!dump_file)
+        {
+            LOG(WARNING) << "Unable to write the acquisition grid to " << grid.filename;
+        }
+}
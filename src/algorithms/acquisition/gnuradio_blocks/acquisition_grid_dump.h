@@ -0,0 +1,138 @@
+/*!
+ * \file acquisition_grid_dump.h
+ * \brief Dump of the acquisition search grids, one file per search,
+ * written in the background
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_ACQUISITION_GRID_DUMP_H_
+#define GNSS_SDR_ACQUISITION_GRID_DUMP_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <gnuradio/gr_complex.h>
+#include "gnss_synchro.h"
+
+/*!
+ * \brief Header of a grid dump file (64 bytes, little endian as written
+ * by the receiver), followed by num_doppler_bins lines of line_length
+ * float32 squared magnitudes, from doppler_min_hz upwards.
+ */
+struct Acquisition_Grid_Header
+{
+    char magic[8];             //!< "GSACQGRD"
+    uint32_t version;
+    uint32_t header_bytes;     //!< Offset of the grid in the file
+    uint64_t sample_stamp;     //!< Sample stamp of the dwell searched
+    int64_t fs_in;             //!< Sampling frequency [Hz]
+    int32_t doppler_min_hz;    //!< Doppler of the first line [Hz]
+    uint32_t doppler_step_hz;
+    uint32_t num_doppler_bins;
+    uint32_t line_length;      //!< Code phases of a line [samples]
+    uint32_t PRN;
+    uint32_t channel;
+    char system;
+    char signal[3];
+    uint32_t lines_searched;   //!< Lines written by the block, the others are zero
+};
+
+
+/*!
+ * \brief Writes the search grids of an acquisition block, one file per
+ * search of a dwell.
+ *
+ * The block fills the grid of a search line by line, between begin() and
+ * end(), and a writer thread of its own saves it while the block searches
+ * the next one: the grids are double buffered, so the block only waits if
+ * the writer is still busy with the previous grid when it ends a new one.
+ * write_line() can be called for different lines at the same time, as the
+ * lines of a search run in parallel on the Acquisition_Thread_Pool.
+ *
+ * The file of the n-th search of the block is named after dump_filename
+ * as stem_System_Signal_sat_PRN_ch_channel_n.extension, see
+ * src/utils/matlab/libs/read_acq_grid_dump.m.
+ */
+class Acquisition_Grid_Dump
+{
+public:
+    explicit Acquisition_Grid_Dump(const std::string& dump_filename);
+    ~Acquisition_Grid_Dump(); //!< Saves the pending grid
+
+    /*!
+     * \brief Starts the grid of a search, with all its lines at zero
+     */
+    void begin(const Gnss_Synchro& synchro, unsigned int channel, unsigned long int sample_stamp, long fs_in,
+            int doppler_min_hz, unsigned int doppler_step_hz, unsigned int num_doppler_bins, unsigned int line_length);
+
+    /*!
+     * \brief Copies the line_length squared magnitudes of a line
+     */
+    void write_line(unsigned int doppler_index, const float* magnitude);
+
+    /*!
+     * \brief Copies the squared magnitudes of line_length correlation outputs
+     */
+    void write_line(unsigned int doppler_index, const gr_complex* correlation);
+
+    /*!
+     * \brief Hands the grid to the writer thread
+     */
+    void end();
+
+private:
+    Acquisition_Grid_Dump(const Acquisition_Grid_Dump&);
+    Acquisition_Grid_Dump& operator=(const Acquisition_Grid_Dump&);
+
+    struct Grid
+    {
+        Acquisition_Grid_Header header;
+        std::vector<float> values;
+        std::string filename;
+    };
+
+    void run();
+    void save(const Grid& grid);
+
+    std::string d_dump_filename;
+    Grid d_grids[2];
+    unsigned int d_front;         // grid filled by the block, the other one is the writer's
+    bool d_open;                  // begin() without end()
+    bool d_pending;               // the writer has a grid to save
+    bool d_stop;
+    unsigned long int d_searches;
+    boost::mutex d_lines_mutex;
+    boost::mutex d_mutex;
+    boost::condition_variable d_condition;
+    boost::thread d_writer;
+};
+
+#endif
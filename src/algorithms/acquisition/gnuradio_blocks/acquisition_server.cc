@@ -0,0 +1,324 @@
+/*!
+ * \file acquisition_server.cc
+ * \brief Searches the acquisition requests of all the receivers of a
+ * machine in shared batches
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "acquisition_server.h"
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <sstream>
+#include <utility>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <glog/logging.h>
+#include <volk/volk.h>
+#if CUDA_GPU_ACCEL
+#include "cuda_acquisition.h"
+#endif
+
+using google::LogMessage;
+
+namespace
+{
+// Sleep between two looks at the slots while waiting for requests
+const unsigned int poll_interval_us = 100;
+
+typedef std::pair<unsigned long int, unsigned long long> Dwell_Key; // sample stamp, fingerprint
+}
+
+
+class Acquisition_Server::Cuda_Backend
+{
+public:
+#if CUDA_GPU_ACCEL
+    std::map<Acquisition_Server_Grid_Key, std::unique_ptr<cuda_acquisition> > gpus;
+#endif
+};
+
+
+Acquisition_Server::Acquisition_Server(const std::shared_ptr<Acquisition_Server_Link>& link, bool use_cuda,
+        unsigned int max_batch_codes) :
+    d_link(link),
+    d_use_cuda(use_cuda),
+    d_max_batch_codes(max_batch_codes),
+    d_searches(0),
+    d_dwells(0),
+    d_batches(0),
+    d_cuda(new Cuda_Backend())
+{
+#if !CUDA_GPU_ACCEL
+    if (d_use_cuda)
+        {
+            LOG(WARNING) << "The acquisition server was built without CUDA, the searches run on the CPU";
+            d_use_cuda = false;
+        }
+#endif
+}
+
+
+Acquisition_Server::~Acquisition_Server()
+{}
+
+
+unsigned int Acquisition_Server::take_submitted()
+{
+    unsigned int taken = 0;
+    for (unsigned int slot = 0; slot < d_link->num_slots(); slot++)
+        {
+            if (d_link->state(slot) != ACQ_SLOT_SUBMITTED || !d_link->take(slot))
+                {
+                    continue;
+                }
+            const Acquisition_Server_Request& request = d_link->request(slot);
+            Search search;
+            search.slot = slot;
+            Acquisition_Server_Grid_Key key = {static_cast<long>(request.fs_in), static_cast<long>(request.freq),
+                    request.doppler_max, request.doppler_step, request.num_doppler_bins, request.fft_size};
+            search.key = key;
+            search.fingerprint = 0;
+            search.first_task = 0;
+            d_batch.push_back(search);
+            taken++;
+        }
+    return taken;
+}
+
+
+unsigned int Acquisition_Server::run_once(unsigned int wait_us, unsigned int batch_wait_us)
+{
+    if (!d_link->is_open())
+        {
+            return 0;
+        }
+    d_batch.clear();
+    boost::system_time deadline = boost::get_system_time() + boost::posix_time::microseconds(wait_us);
+    while (take_submitted() == 0)
+        {
+            if (boost::get_system_time() >= deadline)
+                {
+                    d_link->reclaim();
+                    return 0;
+                }
+            boost::this_thread::sleep(boost::posix_time::microseconds(poll_interval_us));
+        }
+
+    // the channels of the other receivers usually submit the same dwell within a few hundred microseconds
+    deadline = boost::get_system_time() + boost::posix_time::microseconds(batch_wait_us);
+    while (boost::get_system_time() < deadline)
+        {
+            boost::this_thread::sleep(boost::posix_time::microseconds(poll_interval_us));
+            take_submitted();
+        }
+
+    // grids, code FFTs and, for the CPU, input FFTs, one request per task
+    Acquisition_Thread_Pool::instance().parallel_for(d_batch.size(),
+            boost::bind(&Acquisition_Server::prepare, this, _1, _2));
+
+    if (!d_use_cuda || !search_cuda())
+        {
+            search_cpu();
+        }
+
+    std::set<std::pair<Acquisition_Server_Grid_Key, Dwell_Key> > dwells;
+    for (unsigned int n = 0; n < d_batch.size(); n++)
+        {
+            const Acquisition_Server_Request& request = d_link->request(d_batch[n].slot);
+            dwells.insert(std::make_pair(d_batch[n].key, Dwell_Key(request.sample_stamp, d_batch[n].fingerprint)));
+            d_batch[n].input_ffts.reset();
+            d_link->complete(d_batch[n].slot);
+        }
+    d_searches += d_batch.size();
+    d_dwells += dwells.size();
+    d_batches++;
+    DLOG(INFO) << "Acquisition server batch of " << d_batch.size() << " requests on " << dwells.size() << " dwells";
+    return d_batch.size();
+}
+
+
+void Acquisition_Server::prepare(unsigned int n, Acquisition_Scratch& scratch)
+{
+    Search& search = d_batch[n];
+    const Acquisition_Server_Request& request = d_link->request(search.slot);
+    const Acquisition_Server_Grid_Key& key = search.key;
+    search.fingerprint = Acquisition_Cache::fingerprint(d_link->samples(search.slot), key.fft_size);
+
+    std::stringstream code_key;
+    code_key << request.system << std::string(request.signal, strnlen(request.signal, sizeof(request.signal)))
+             << "_" << request.PRN << "_" << key.fft_size;
+    {
+        boost::mutex::scoped_lock lock(d_cache_mutex);
+        std::shared_ptr<const Doppler_Wipeoff_Grid>& grid = d_grids[key];
+        if (!grid)
+            {
+                grid = Acquisition_Cache::doppler_wipeoff_grid(key.fs_in, key.freq, key.doppler_max, key.doppler_step,
+                        key.num_doppler_bins, key.fft_size);
+            }
+        search.grid = grid;
+    }
+
+    // a hit unless the replica changed, e.g. for a receiver with another sampling frequency
+    gr::fft::fft_complex* fft = scratch.fft(key.fft_size);
+    std::memcpy(fft->get_inbuf(), d_link->code(search.slot), key.fft_size * sizeof(gr_complex));
+    search.code_fft = Acquisition_Cache::code_fft(request.system, request.signal, request.PRN, fft);
+    {
+        // held by the server, so that the cache keeps it between the searches of the receivers
+        boost::mutex::scoped_lock lock(d_cache_mutex);
+        d_code_ffts[code_key.str()] = search.code_fft;
+    }
+    if (!d_use_cuda)
+        {
+            search.input_ffts = Acquisition_Cache::input_fft_batch(search.grid, request.sample_stamp,
+                    d_link->samples(search.slot), fft);
+        }
+}
+
+
+void Acquisition_Server::search_cpu()
+{
+    unsigned int tasks = 0;
+    for (unsigned int n = 0; n < d_batch.size(); n++)
+        {
+            Search& search = d_batch[n];
+            if (!search.input_ffts)
+                {
+                    // after a failed GPU batch
+                    const Acquisition_Server_Request& request = d_link->request(search.slot);
+                    search.input_ffts = Acquisition_Cache::input_fft_batch(search.grid, request.sample_stamp,
+                            d_link->samples(search.slot), Acquisition_Thread_Pool::scratch().fft(search.key.fft_size));
+                }
+            search.first_task = tasks;
+            tasks += search.key.num_doppler_bins;
+        }
+    // all the lines of all the requests, so that the pool is busy even when a single receiver is searching
+    Acquisition_Thread_Pool::instance().parallel_for(tasks,
+            boost::bind(&Acquisition_Server::search_line, this, _1, _2));
+}
+
+
+void Acquisition_Server::search_line(unsigned int task, Acquisition_Scratch& scratch)
+{
+#if VOLK_GT_122
+    uint16_t indext = 0;
+#else
+    unsigned int indext = 0;
+#endif
+    // the request of the task is the last one that starts at or before it
+    unsigned int n = d_batch.size() - 1;
+    while (d_batch[n].first_task > task)
+        {
+            n--;
+        }
+    const Search& search = d_batch[n];
+    unsigned int doppler_index = task - search.first_task;
+    unsigned int fft_size = search.key.fft_size;
+    gr::fft::fft_complex* ifft = scratch.ifft(fft_size);
+    float* magnitude = scratch.magnitude(fft_size);
+
+    volk_32fc_x2_multiply_32fc(ifft->get_inbuf(), search.input_ffts->get(doppler_index), search.code_fft->get(), fft_size);
+    ifft->execute();
+    volk_32fc_magnitude_squared_32f(magnitude, ifft->get_outbuf(), fft_size);
+    volk_32f_index_max_16u(&indext, magnitude, fft_size);
+
+    Doppler_Line_Max& line = d_link->lines(search.slot)[doppler_index];
+    line.index = indext;
+    line.mag = magnitude[indext];
+    line.power = 0.0;
+    volk_32f_accumulator_s32f(&line.power, magnitude, fft_size);
+}
+
+
+bool Acquisition_Server::search_cuda()
+{
+#if CUDA_GPU_ACCEL
+    // the codes searched on each dwell go to the GPU together
+    std::map<std::pair<Acquisition_Server_Grid_Key, Dwell_Key>, std::vector<unsigned int> > dwells;
+    for (unsigned int n = 0; n < d_batch.size(); n++)
+        {
+            const Acquisition_Server_Request& request = d_link->request(d_batch[n].slot);
+            dwells[std::make_pair(d_batch[n].key, Dwell_Key(request.sample_stamp, d_batch[n].fingerprint))].push_back(n);
+        }
+
+    std::map<std::pair<Acquisition_Server_Grid_Key, Dwell_Key>, std::vector<unsigned int> >::const_iterator it;
+    for (it = dwells.begin(); it != dwells.end(); ++it)
+        {
+            const Acquisition_Server_Grid_Key& key = it->first.first;
+            std::unique_ptr<cuda_acquisition>& gpu = d_cuda->gpus[key];
+            if (!gpu)
+                {
+                    std::vector<double> cycles_per_sample(key.num_doppler_bins);
+                    for (unsigned int doppler_index = 0; doppler_index < key.num_doppler_bins; doppler_index++)
+                        {
+                            int doppler = -static_cast<int>(key.doppler_max) + key.doppler_step * doppler_index;
+                            cycles_per_sample[doppler_index] = static_cast<double>(key.freq + doppler) / static_cast<double>(key.fs_in);
+                        }
+                    gpu.reset(new cuda_acquisition());
+                    if (!gpu->init_cuda(key.fft_size, key.num_doppler_bins, d_max_batch_codes, &cycles_per_sample[0]))
+                        {
+                            LOG(ERROR) << "Cannot initialize the CUDA acquisition of the server";
+                            gpu.reset();
+                            return false;
+                        }
+                }
+            const std::vector<unsigned int>& searches = it->second;
+            const gr_complex* in = d_link->samples(d_batch[searches[0]].slot);
+            for (unsigned int first = 0; first < searches.size(); first += d_max_batch_codes)
+                {
+                    unsigned int n_codes = std::min<unsigned int>(d_max_batch_codes, searches.size() - first);
+                    std::vector<const std::complex<float>*> code_ffts(n_codes);
+                    for (unsigned int code = 0; code < n_codes; code++)
+                        {
+                            code_ffts[code] = d_batch[searches[first + code]].code_fft->get();
+                        }
+                    std::vector<Cuda_Line_Max> results(n_codes * key.num_doppler_bins);
+                    if (!gpu->search(in, &code_ffts[0], n_codes, &results[0]))
+                        {
+                            LOG(WARNING) << "CUDA search of the acquisition server failed";
+                            return false;
+                        }
+                    for (unsigned int code = 0; code < n_codes; code++)
+                        {
+                            Doppler_Line_Max* lines = d_link->lines(d_batch[searches[first + code]].slot);
+                            for (unsigned int doppler_index = 0; doppler_index < key.num_doppler_bins; doppler_index++)
+                                {
+                                    const Cuda_Line_Max& result = results[code * key.num_doppler_bins + doppler_index];
+                                    lines[doppler_index].mag = result.mag;
+                                    lines[doppler_index].index = result.index;
+                                    lines[doppler_index].power = result.power;
+                                }
+                        }
+                }
+        }
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,137 @@
+/*!
+ * \file acquisition_server.h
+ * \brief Searches the acquisition requests of all the receivers of a
+ * machine in shared batches
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_ACQUISITION_SERVER_H_
+#define GNSS_SDR_ACQUISITION_SERVER_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include "acquisition_cache.h"
+#include "acquisition_server_link.h"
+#include "acquisition_thread_pool.h"
+
+/*!
+ * \brief Search grid of a request: the requests with the same one share
+ * the Doppler wipeoffs, and their dwells the input FFTs.
+ */
+struct Acquisition_Server_Grid_Key
+{
+    long fs_in;
+    long freq;
+    unsigned int doppler_max;
+    unsigned int doppler_step;
+    unsigned int num_doppler_bins;
+    unsigned int fft_size;
+
+    bool operator<(const Acquisition_Server_Grid_Key& other) const
+    {
+        if (fs_in != other.fs_in) return fs_in < other.fs_in;
+        if (freq != other.freq) return freq < other.freq;
+        if (doppler_max != other.doppler_max) return doppler_max < other.doppler_max;
+        if (doppler_step != other.doppler_step) return doppler_step < other.doppler_step;
+        if (num_doppler_bins != other.num_doppler_bins) return num_doppler_bins < other.num_doppler_bins;
+        return fft_size < other.fft_size;
+    }
+};
+
+
+/*!
+ * \brief Acquisition server: the acquisition engine of the receivers that
+ * submit their searches through an Acquisition_Server_Link.
+ *
+ * Each call to run_once() takes all the submitted requests, whatever the
+ * receiver, as one batch. The grids and the code FFTs come from the
+ * Acquisition_Cache and are held by the server, so they outlive the
+ * searches of any one receiver; the channels of a receiver that search the
+ * same dwell share its input FFTs. The lines of the whole batch are then
+ * searched on the Acquisition_Thread_Pool or, if the server was built with
+ * CUDA and asked to, by one cuda_acquisition per grid, with all the codes
+ * of a dwell in one GPU batch.
+ *
+ * The lines hold the unnormalized maximum and power of the correlation,
+ * as those of cuda_acquisition; the test statistic is left to the block.
+ */
+class Acquisition_Server
+{
+public:
+    Acquisition_Server(const std::shared_ptr<Acquisition_Server_Link>& link, bool use_cuda, unsigned int max_batch_codes);
+    ~Acquisition_Server();
+
+    /*!
+     * \brief Waits up to wait_us for a request, then batch_wait_us for
+     * more to join it, and searches them all
+     * \return the number of requests searched
+     */
+    unsigned int run_once(unsigned int wait_us, unsigned int batch_wait_us);
+
+    unsigned long int searches() const { return d_searches; } //!< Requests searched so far
+    unsigned long int dwells() const { return d_dwells; }     //!< Distinct dwells among them
+    unsigned long int batches() const { return d_batches; }
+
+private:
+    Acquisition_Server(const Acquisition_Server&);
+    Acquisition_Server& operator=(const Acquisition_Server&);
+
+    struct Search
+    {
+        unsigned int slot;
+        Acquisition_Server_Grid_Key key;
+        unsigned long long fingerprint;
+        std::shared_ptr<const Doppler_Wipeoff_Grid> grid;
+        std::shared_ptr<const Input_Fft_Batch> input_ffts;
+        std::shared_ptr<const Code_Fft> code_fft;
+        unsigned int first_task; // of its lines in the batch
+    };
+
+    unsigned int take_submitted();
+    void prepare(unsigned int search, Acquisition_Scratch& scratch);
+    void search_line(unsigned int task, Acquisition_Scratch& scratch);
+    void search_cpu();
+    bool search_cuda();
+
+    std::shared_ptr<Acquisition_Server_Link> d_link;
+    bool d_use_cuda;
+    unsigned int d_max_batch_codes;
+    std::vector<Search> d_batch;
+    boost::mutex d_cache_mutex;
+    std::map<Acquisition_Server_Grid_Key, std::shared_ptr<const Doppler_Wipeoff_Grid> > d_grids;
+    std::map<std::string, std::shared_ptr<const Code_Fft> > d_code_ffts; // by satellite signal and FFT size
+    unsigned long int d_searches;
+    unsigned long int d_dwells;
+    unsigned long int d_batches;
+    class Cuda_Backend;
+    std::unique_ptr<Cuda_Backend> d_cuda;
+};
+
+#endif
@@ -0,0 +1,362 @@
+/*!
+ * \file acquisition_server_link.cc
+ * \brief Shared memory through which the receivers of a machine submit
+ * their acquisition searches to the acquisition server
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "acquisition_server_link.h"
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <boost/thread/mutex.hpp>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+namespace
+{
+    const char link_magic[8] = {'S', 'D', 'A', 'C', 'Q', 'S', 'R', 'V'};
+    const uint32_t link_version = 1;
+    const size_t file_header_bytes = 64; // magic, version, num_slots, max_samples, max_doppler_bins
+
+    // Each slot: atomic uint32 state, int32 pid of the receiver, the request, then the
+    // line maxima, the samples and the code replica, each one on a cache line of its own
+    const size_t slot_header_bytes = 64;
+    const size_t line_bytes = 64;
+
+    typedef std::atomic<uint32_t> Slot_State;
+
+    static_assert(sizeof(Slot_State) == sizeof(uint32_t), "the slot state must be a plain word of the file");
+    static_assert(8 + sizeof(Acquisition_Server_Request) <= slot_header_bytes, "the request must fit in the slot header");
+
+    size_t round_up(size_t bytes)
+    {
+        return (bytes + line_bytes - 1) / line_bytes * line_bytes;
+    }
+
+    size_t lines_bytes(unsigned int max_doppler_bins)
+    {
+        return round_up(max_doppler_bins * sizeof(Doppler_Line_Max));
+    }
+
+    size_t samples_bytes(unsigned int max_samples)
+    {
+        return round_up(max_samples * sizeof(gr_complex));
+    }
+
+    size_t slot_size(unsigned int max_samples, unsigned int max_doppler_bins)
+    {
+        return slot_header_bytes + lines_bytes(max_doppler_bins) + 2 * samples_bytes(max_samples);
+    }
+
+    Slot_State& slot_state(char* slot)
+    {
+        return *reinterpret_cast<Slot_State*>(slot);
+    }
+
+    bool transition(char* slot, uint32_t from, uint32_t to)
+    {
+        return slot_state(slot).compare_exchange_strong(from, to, std::memory_order_acq_rel);
+    }
+
+    boost::mutex links_mutex;
+    std::map<std::string, std::weak_ptr<Acquisition_Server_Link> > links;
+}
+
+
+Acquisition_Server_Link::Acquisition_Server_Link(const std::string& filename, unsigned int num_slots,
+        unsigned int max_samples, unsigned int max_doppler_bins) :
+    d_filename(filename), d_map(0), d_map_bytes(0), d_slot_bytes(0), d_num_slots(num_slots),
+    d_max_samples(max_samples), d_max_doppler_bins(max_doppler_bins), d_server(true)
+{
+    // a new file, so that the receivers still mapping the one of a previous server never see this one change
+    unlink(filename.c_str());
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+    if (fd == -1)
+        {
+            LOG(WARNING) << "Unable to create the acquisition server file " << filename << ": " << strerror(errno);
+            return;
+        }
+    fchmod(fd, 0666); // whatever the umask, the receivers of any user can submit
+    d_slot_bytes = slot_size(max_samples, max_doppler_bins);
+    size_t bytes = file_header_bytes + num_slots * d_slot_bytes;
+    if (ftruncate(fd, bytes) != 0)
+        {
+            LOG(WARNING) << "Unable to size the acquisition server file " << filename << ": " << strerror(errno);
+            close(fd);
+            return;
+        }
+    if (!map(fd, bytes))
+        {
+            return;
+        }
+
+    // all the slots are FREE (0); the magic goes last, once the geometry is there
+    std::memcpy(d_map + 8, &link_version, sizeof(link_version));
+    std::memcpy(d_map + 12, &num_slots, sizeof(num_slots));
+    std::memcpy(d_map + 16, &max_samples, sizeof(max_samples));
+    std::memcpy(d_map + 20, &max_doppler_bins, sizeof(max_doppler_bins));
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(d_map, link_magic, sizeof(link_magic));
+    LOG(INFO) << "Acquisition server file " << filename << ", " << num_slots << " slots of "
+              << max_samples << " samples and " << max_doppler_bins << " Doppler bins";
+}
+
+
+Acquisition_Server_Link::Acquisition_Server_Link(const std::string& filename) :
+    d_filename(filename), d_map(0), d_map_bytes(0), d_slot_bytes(0), d_num_slots(0),
+    d_max_samples(0), d_max_doppler_bins(0), d_server(false)
+{
+    int fd = open(filename.c_str(), O_RDWR);
+    if (fd == -1)
+        {
+            LOG(WARNING) << "Unable to open the acquisition server file " << filename << ": " << strerror(errno);
+            return;
+        }
+    char header[file_header_bytes];
+    uint32_t version = 0;
+    struct stat file_status;
+    if (fstat(fd, &file_status) != 0 || static_cast<size_t>(file_status.st_size) < file_header_bytes
+            || pread(fd, header, file_header_bytes, 0) != static_cast<ssize_t>(file_header_bytes))
+        {
+            LOG(WARNING) << "The acquisition server file " << filename << " is truncated";
+            close(fd);
+            return;
+        }
+    std::memcpy(&version, header + 8, sizeof(version));
+    std::memcpy(&d_num_slots, header + 12, sizeof(d_num_slots));
+    std::memcpy(&d_max_samples, header + 16, sizeof(d_max_samples));
+    std::memcpy(&d_max_doppler_bins, header + 20, sizeof(d_max_doppler_bins));
+    d_slot_bytes = slot_size(d_max_samples, d_max_doppler_bins);
+    size_t bytes = file_header_bytes + d_num_slots * d_slot_bytes;
+    if (std::memcmp(header, link_magic, sizeof(link_magic)) != 0 || version != link_version
+            || static_cast<size_t>(file_status.st_size) != bytes)
+        {
+            LOG(WARNING) << filename << " is not the file of a running acquisition server";
+            close(fd);
+            return;
+        }
+    map(fd, bytes);
+}
+
+
+Acquisition_Server_Link::~Acquisition_Server_Link()
+{
+    if (d_map)
+        {
+            munmap(d_map, d_map_bytes);
+            if (d_server)
+                {
+                    unlink(d_filename.c_str());
+                }
+        }
+}
+
+
+std::shared_ptr<Acquisition_Server_Link> Acquisition_Server_Link::shared(const std::string& filename)
+{
+    boost::mutex::scoped_lock lock(links_mutex);
+    std::shared_ptr<Acquisition_Server_Link> link = links[filename].lock();
+    if (!link || !link->is_open())
+        {
+            // the server may have been started since the last attempt
+            link = std::make_shared<Acquisition_Server_Link>(filename);
+            links[filename] = link;
+        }
+    return link;
+}
+
+
+bool Acquisition_Server_Link::map(int fd, size_t bytes)
+{
+    void* map = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps the file open
+    if (map == MAP_FAILED)
+        {
+            LOG(WARNING) << "Unable to map the acquisition server file " << d_filename << ": " << strerror(errno);
+            return false;
+        }
+    d_map = static_cast<char*>(map);
+    d_map_bytes = bytes;
+    return true;
+}
+
+
+char* Acquisition_Server_Link::slot(unsigned int n) const
+{
+    return d_map + file_header_bytes + n * d_slot_bytes;
+}
+
+
+int Acquisition_Server_Link::submit(const Acquisition_Server_Request& request, const gr_complex* samples, const gr_complex* code)
+{
+    if (!d_map || request.fft_size > d_max_samples || request.num_doppler_bins > d_max_doppler_bins)
+        {
+            return -1;
+        }
+    int32_t pid = getpid();
+    for (unsigned int n = 0; n < d_num_slots; n++)
+        {
+            char* s = slot(n);
+            if (slot_state(s).load(std::memory_order_relaxed) != ACQ_SLOT_FREE
+                    || !transition(s, ACQ_SLOT_FREE, ACQ_SLOT_WRITING))
+                {
+                    continue;
+                }
+            std::memcpy(s + 4, &pid, sizeof(pid));
+            std::memcpy(s + 8, &request, sizeof(request));
+            char* data = s + slot_header_bytes + lines_bytes(d_max_doppler_bins);
+            std::memcpy(data, samples, request.fft_size * sizeof(gr_complex));
+            std::memcpy(data + samples_bytes(d_max_samples), code, request.fft_size * sizeof(gr_complex));
+            slot_state(s).store(ACQ_SLOT_SUBMITTED, std::memory_order_release);
+            return n;
+        }
+    return -1;
+}
+
+
+bool Acquisition_Server_Link::poll(int slot_number, Doppler_Line_Max* lines)
+{
+    if (!d_map || slot_number < 0 || static_cast<unsigned int>(slot_number) >= d_num_slots)
+        {
+            return false;
+        }
+    char* s = slot(slot_number);
+    if (slot_state(s).load(std::memory_order_acquire) != ACQ_SLOT_DONE)
+        {
+            return false;
+        }
+    const Acquisition_Server_Request& searched = request(slot_number);
+    std::memcpy(lines, s + slot_header_bytes, searched.num_doppler_bins * sizeof(Doppler_Line_Max));
+    slot_state(s).store(ACQ_SLOT_FREE, std::memory_order_release);
+    return true;
+}
+
+
+void Acquisition_Server_Link::cancel(int slot_number)
+{
+    if (!d_map || slot_number < 0 || static_cast<unsigned int>(slot_number) >= d_num_slots)
+        {
+            return;
+        }
+    char* s = slot(slot_number);
+    // the server may take or complete the slot meanwhile
+    while (true)
+        {
+            uint32_t state = slot_state(s).load(std::memory_order_acquire);
+            if (state == ACQ_SLOT_SUBMITTED || state == ACQ_SLOT_DONE)
+                {
+                    if (transition(s, state, ACQ_SLOT_FREE)) return;
+                }
+            else if (state == ACQ_SLOT_SEARCHING)
+                {
+                    if (transition(s, state, ACQ_SLOT_CANCELLED)) return;
+                }
+            else
+                {
+                    return;
+                }
+        }
+}
+
+
+unsigned int Acquisition_Server_Link::state(unsigned int slot_number) const
+{
+    return slot_state(slot(slot_number)).load(std::memory_order_acquire);
+}
+
+
+bool Acquisition_Server_Link::take(unsigned int slot_number)
+{
+    return transition(slot(slot_number), ACQ_SLOT_SUBMITTED, ACQ_SLOT_SEARCHING);
+}
+
+
+const Acquisition_Server_Request& Acquisition_Server_Link::request(unsigned int slot_number) const
+{
+    return *reinterpret_cast<const Acquisition_Server_Request*>(slot(slot_number) + 8);
+}
+
+
+const gr_complex* Acquisition_Server_Link::samples(unsigned int slot_number) const
+{
+    return reinterpret_cast<const gr_complex*>(slot(slot_number) + slot_header_bytes + lines_bytes(d_max_doppler_bins));
+}
+
+
+const gr_complex* Acquisition_Server_Link::code(unsigned int slot_number) const
+{
+    return samples(slot_number) + samples_bytes(d_max_samples) / sizeof(gr_complex);
+}
+
+
+Doppler_Line_Max* Acquisition_Server_Link::lines(unsigned int slot_number)
+{
+    return reinterpret_cast<Doppler_Line_Max*>(slot(slot_number) + slot_header_bytes);
+}
+
+
+void Acquisition_Server_Link::complete(unsigned int slot_number)
+{
+    char* s = slot(slot_number);
+    if (!transition(s, ACQ_SLOT_SEARCHING, ACQ_SLOT_DONE))
+        {
+            // cancelled by the receiver meanwhile
+            slot_state(s).store(ACQ_SLOT_FREE, std::memory_order_release);
+        }
+}
+
+
+unsigned int Acquisition_Server_Link::reclaim()
+{
+    unsigned int freed = 0;
+    for (unsigned int n = 0; n < d_num_slots; n++)
+        {
+            char* s = slot(n);
+            uint32_t state = slot_state(s).load(std::memory_order_acquire);
+            // a slot being searched is freed when the search completes, if need be, and
+            // the pid of a slot being written may still be the one of its previous receiver
+            if (state == ACQ_SLOT_FREE || state == ACQ_SLOT_SEARCHING || state == ACQ_SLOT_WRITING)
+                {
+                    continue;
+                }
+            int32_t pid;
+            std::memcpy(&pid, s + 4, sizeof(pid));
+            if (kill(pid, 0) == -1 && errno == ESRCH && transition(s, state, ACQ_SLOT_FREE))
+                {
+                    freed++;
+                }
+        }
+    return freed;
+}
@@ -0,0 +1,180 @@
+/*!
+ * \file acquisition_server_link.h
+ * \brief Shared memory through which the receivers of a machine submit
+ * their acquisition searches to the acquisition server
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_ACQUISITION_SERVER_LINK_H_
+#define GNSS_SDR_ACQUISITION_SERVER_LINK_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <gnuradio/gr_complex.h>
+#include "acquisition_thread_pool.h"
+
+/*!
+ * \brief States of a slot of the link. A slot goes FREE -> WRITING ->
+ * SUBMITTED on the receiver side, SUBMITTED -> SEARCHING -> DONE on the
+ * server side, and back to FREE when the receiver takes the result.
+ */
+enum Acquisition_Slot_State
+{
+    ACQ_SLOT_FREE = 0,
+    ACQ_SLOT_WRITING = 1,   //!< A receiver is writing the request
+    ACQ_SLOT_SUBMITTED = 2, //!< Waiting for the server
+    ACQ_SLOT_SEARCHING = 3, //!< In a batch of the server
+    ACQ_SLOT_DONE = 4,      //!< The lines are ready
+    ACQ_SLOT_CANCELLED = 5  //!< Abandoned by the receiver while searching, freed by the server
+};
+
+
+/*!
+ * \brief One search of one dwell over a whole Doppler grid.
+ */
+struct Acquisition_Server_Request
+{
+    uint64_t sample_stamp;     //!< Sample stamp of the dwell in its receiver
+    int64_t fs_in;             //!< Sampling frequency [Hz]
+    int64_t freq;              //!< Intermediate frequency [Hz]
+    uint32_t doppler_max;      //!< [Hz]
+    uint32_t doppler_step;     //!< [Hz]
+    uint32_t num_doppler_bins;
+    uint32_t fft_size;         //!< Samples of the dwell and of the code replica
+    uint32_t PRN;
+    char system;
+    char signal[3];
+};
+
+
+/*!
+ * \brief File mapped in memory by the acquisition server and by the
+ * acquisition blocks of the receivers that use it.
+ *
+ * The file holds a number of slots. A receiver block claims a free slot,
+ * writes its request, the samples of the dwell and its code replica into
+ * it, and marks it submitted; the server takes the submitted slots in
+ * batches, searches them and writes the maximum of each Doppler line
+ * back. The block polls its slot, so the search is asynchronous and the
+ * flowgraph never waits for the server. The states are atomic words of
+ * the mapping, so neither side takes a lock, and a receiver that dies
+ * leaves slots that the server frees (see reclaim()).
+ *
+ * A link that fails to open or map the file is not open, and all the
+ * operations on it fail.
+ */
+class Acquisition_Server_Link
+{
+public:
+    /*!
+     * \brief Creates the file of a server, replacing any previous one
+     * \param max_samples - Longest dwell (and code replica) of a request
+     * \param max_doppler_bins - Largest Doppler grid of a request
+     */
+    Acquisition_Server_Link(const std::string& filename, unsigned int num_slots,
+            unsigned int max_samples, unsigned int max_doppler_bins);
+
+    /*!
+     * \brief Maps the file of a running server
+     */
+    explicit Acquisition_Server_Link(const std::string& filename);
+
+    ~Acquisition_Server_Link();
+
+    /*!
+     * \brief Link of the blocks of this receiver to the server of filename, opened on first use
+     */
+    static std::shared_ptr<Acquisition_Server_Link> shared(const std::string& filename);
+
+    bool is_open() const { return d_map != 0; }
+    unsigned int num_slots() const { return d_num_slots; }
+    unsigned int max_samples() const { return d_max_samples; }
+    unsigned int max_doppler_bins() const { return d_max_doppler_bins; }
+
+    // Receiver side
+
+    /*!
+     * \brief Copies a request into a free slot and submits it
+     * \return the slot, or -1 if none is free or the request does not fit
+     */
+    int submit(const Acquisition_Server_Request& request, const gr_complex* samples, const gr_complex* code);
+
+    /*!
+     * \brief Copies the num_doppler_bins line maxima of a finished search and frees its slot
+     * \return false while the server has not searched it
+     */
+    bool poll(int slot, Doppler_Line_Max* lines);
+
+    /*!
+     * \brief Gives up a submitted search; its slot is freed as soon as the server is done with it
+     */
+    void cancel(int slot);
+
+    // Server side
+
+    unsigned int state(unsigned int slot) const;
+
+    /*!
+     * \brief Moves a submitted slot to SEARCHING, false if it was not submitted
+     */
+    bool take(unsigned int slot);
+
+    const Acquisition_Server_Request& request(unsigned int slot) const;
+    const gr_complex* samples(unsigned int slot) const;
+    const gr_complex* code(unsigned int slot) const;
+    Doppler_Line_Max* lines(unsigned int slot);
+
+    /*!
+     * \brief Publishes the lines of a slot taken with take()
+     */
+    void complete(unsigned int slot);
+
+    /*!
+     * \brief Frees the slots of receivers that are no longer running
+     * \return the number of slots freed
+     */
+    unsigned int reclaim();
+
+private:
+    Acquisition_Server_Link(const Acquisition_Server_Link&);
+    Acquisition_Server_Link& operator=(const Acquisition_Server_Link&);
+
+    bool map(int fd, size_t bytes);
+    char* slot(unsigned int n) const;
+
+    std::string d_filename;
+    char* d_map;
+    size_t d_map_bytes;
+    size_t d_slot_bytes;
+    unsigned int d_num_slots;
+    unsigned int d_max_samples;
+    unsigned int d_max_doppler_bins;
+    bool d_server;
+};
+
+#endif
@@ -0,0 +1,291 @@
+/*!
+ * \file acquisition_thread_pool.cc
+ * \brief Implementation of the receiver-wide pool of threads that run the
+ * Doppler searches of the acquisition blocks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "acquisition_thread_pool.h"
+#include <algorithm>
+#include <memory>
+#include <boost/bind.hpp>
+#include <boost/thread/tss.hpp>
+#include <glog/logging.h>
+#include <volk/volk.h>
+#include "fft_plan_cache.h"
+
+using google::LogMessage;
+
+namespace
+{
+boost::mutex num_threads_mutex;
+bool num_threads_set = false;
+unsigned int pool_num_threads = 0;
+
+boost::thread_specific_ptr<Acquisition_Scratch> thread_scratch;
+
+// Shared state of one parallel_for()
+struct Batch
+{
+    Acquisition_Thread_Pool::Indexed_Task task;
+    unsigned int count;
+    unsigned int next;
+    unsigned int done;
+    boost::mutex mutex;
+    boost::condition_variable finished;
+};
+
+void run_batch(std::shared_ptr<Batch> batch)
+{
+    Acquisition_Scratch& scratch = Acquisition_Thread_Pool::scratch();
+    boost::mutex::scoped_lock lock(batch->mutex);
+    while (batch->next < batch->count)
+        {
+            unsigned int task = batch->next++;
+            lock.unlock();
+            batch->task(task, scratch);
+            lock.lock();
+            if (++batch->done == batch->count)
+                {
+                    batch->finished.notify_all();
+                }
+        }
+}
+}
+
+
+Acquisition_Scratch::Acquisition_Scratch() :
+        d_magnitude(0),
+        d_magnitude_size(0),
+        d_correlation(0),
+        d_correlation_size(0)
+{}
+
+
+Acquisition_Scratch::~Acquisition_Scratch()
+{
+    for (std::map<unsigned int, gr::fft::fft_complex*>::iterator it = d_ffts.begin(); it != d_ffts.end(); ++it)
+        {
+            Fft_Plan_Cache::release(it->second);
+        }
+    for (std::map<unsigned int, gr::fft::fft_complex*>::iterator it = d_iffts.begin(); it != d_iffts.end(); ++it)
+        {
+            Fft_Plan_Cache::release(it->second);
+        }
+    if (d_magnitude != 0)
+        {
+            volk_free(d_magnitude);
+        }
+    if (d_correlation != 0)
+        {
+            volk_free(d_correlation);
+        }
+}
+
+
+gr::fft::fft_complex* Acquisition_Scratch::fft(unsigned int fft_size)
+{
+    return plan(d_ffts, fft_size, true);
+}
+
+
+gr::fft::fft_complex* Acquisition_Scratch::ifft(unsigned int fft_size)
+{
+    return plan(d_iffts, fft_size, false);
+}
+
+
+gr::fft::fft_complex* Acquisition_Scratch::plan(std::map<unsigned int, gr::fft::fft_complex*>& plans, unsigned int fft_size, bool forward)
+{
+    std::map<unsigned int, gr::fft::fft_complex*>::iterator it = plans.find(fft_size);
+    if (it != plans.end())
+        {
+            return it->second;
+        }
+    gr::fft::fft_complex* new_plan = Fft_Plan_Cache::acquire(fft_size, forward);
+    plans[fft_size] = new_plan;
+    return new_plan;
+}
+
+
+float* Acquisition_Scratch::magnitude(unsigned int size)
+{
+    if (size > d_magnitude_size)
+        {
+            if (d_magnitude != 0)
+                {
+                    volk_free(d_magnitude);
+                }
+            d_magnitude = static_cast<float*>(volk_malloc(size * sizeof(float), volk_get_alignment()));
+            d_magnitude_size = size;
+        }
+    return d_magnitude;
+}
+
+
+gr_complex* Acquisition_Scratch::correlation(unsigned int size)
+{
+    if (size > d_correlation_size)
+        {
+            if (d_correlation != 0)
+                {
+                    volk_free(d_correlation);
+                }
+            d_correlation = static_cast<gr_complex*>(volk_malloc(size * sizeof(gr_complex), volk_get_alignment()));
+            d_correlation_size = size;
+        }
+    return d_correlation;
+}
+
+
+Acquisition_Thread_Pool& Acquisition_Thread_Pool::instance()
+{
+    static Acquisition_Thread_Pool pool(num_threads_set ? pool_num_threads : default_num_threads());
+    return pool;
+}
+
+
+void Acquisition_Thread_Pool::set_num_threads(unsigned int num_threads)
+{
+    boost::mutex::scoped_lock lock(num_threads_mutex);
+    num_threads_set = true;
+    pool_num_threads = num_threads;
+}
+
+
+unsigned int Acquisition_Thread_Pool::default_num_threads()
+{
+    return boost::thread::hardware_concurrency() / 4;
+}
+
+
+Acquisition_Scratch& Acquisition_Thread_Pool::scratch()
+{
+    if (thread_scratch.get() == 0)
+        {
+            thread_scratch.reset(new Acquisition_Scratch());
+        }
+    return *thread_scratch;
+}
+
+
+Acquisition_Thread_Pool::Acquisition_Thread_Pool(unsigned int num_threads) :
+        d_num_threads(num_threads),
+        d_stop(false)
+{
+    for (unsigned int i = 0; i < d_num_threads; i++)
+        {
+            d_threads.create_thread(boost::bind(&Acquisition_Thread_Pool::run, this));
+        }
+    LOG(INFO) << "Acquisition thread pool started with " << d_num_threads << " threads";
+}
+
+
+Acquisition_Thread_Pool::~Acquisition_Thread_Pool()
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_stop = true;
+    }
+    d_condition.notify_all();
+    d_threads.join_all();
+}
+
+
+void Acquisition_Thread_Pool::run()
+{
+    while (true)
+        {
+            boost::function<void()> job;
+            {
+                boost::mutex::scoped_lock lock(d_mutex);
+                while (d_jobs.empty() && !d_stop)
+                    {
+                        d_condition.wait(lock);
+                    }
+                if (d_jobs.empty())
+                    {
+                        return;
+                    }
+                job = d_jobs.front();
+                d_jobs.pop_front();
+            }
+            job();
+        }
+}
+
+
+void Acquisition_Thread_Pool::parallel_for(unsigned int count, const Indexed_Task& task)
+{
+    if (d_num_threads == 0 || count < 2)
+        {
+            Acquisition_Scratch& caller_scratch = scratch();
+            for (unsigned int i = 0; i < count; i++)
+                {
+                    task(i, caller_scratch);
+                }
+            return;
+        }
+
+    std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+    batch->task = task;
+    batch->count = count;
+    batch->next = 0;
+    batch->done = 0;
+    unsigned int helpers = std::min(d_num_threads, count - 1);
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        for (unsigned int i = 0; i < helpers; i++)
+            {
+                d_jobs.push_back(boost::bind(&run_batch, batch));
+            }
+    }
+    d_condition.notify_all();
+
+    // the caller takes tasks too, a helper that starts late finds none left
+    run_batch(batch);
+    boost::mutex::scoped_lock lock(batch->mutex);
+    while (batch->done < batch->count)
+        {
+            batch->finished.wait(lock);
+        }
+}
+
+
+void Acquisition_Thread_Pool::submit(const boost::function<void()>& job)
+{
+    if (d_num_threads == 0)
+        {
+            job();
+            return;
+        }
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_jobs.push_back(job);
+    }
+    d_condition.notify_one();
+}
@@ -0,0 +1,145 @@
+/*!
+ * \file acquisition_thread_pool.h
+ * \brief Interface of the receiver-wide pool of threads that run the
+ * Doppler searches of the acquisition blocks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_ACQUISITION_THREAD_POOL_H_
+#define GNSS_SDR_ACQUISITION_THREAD_POOL_H_
+
+#include <deque>
+#include <map>
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/fft/fft.h>
+
+/*!
+ * \brief FFT plans and buffers owned by one thread, to be used by the
+ * tasks it runs. They are created on first use and kept until the thread
+ * exits.
+ */
+class Acquisition_Scratch
+{
+public:
+    Acquisition_Scratch();
+    ~Acquisition_Scratch();
+
+    gr::fft::fft_complex* fft(unsigned int fft_size);  //!< Forward FFT plan of this size
+    gr::fft::fft_complex* ifft(unsigned int fft_size); //!< Inverse FFT plan of this size
+    float* magnitude(unsigned int size);                //!< Buffer of at least size floats
+    gr_complex* correlation(unsigned int size);         //!< Buffer of at least size complex samples
+
+private:
+    Acquisition_Scratch(const Acquisition_Scratch&);
+    Acquisition_Scratch& operator=(const Acquisition_Scratch&);
+
+    gr::fft::fft_complex* plan(std::map<unsigned int, gr::fft::fft_complex*>& plans, unsigned int fft_size, bool forward);
+
+    std::map<unsigned int, gr::fft::fft_complex*> d_ffts;
+    std::map<unsigned int, gr::fft::fft_complex*> d_iffts;
+    float* d_magnitude;
+    unsigned int d_magnitude_size;
+    gr_complex* d_correlation;
+    unsigned int d_correlation_size;
+};
+
+
+/*!
+ * \brief Maximum of the search grid along one Doppler line.
+ */
+struct Doppler_Line_Max
+{
+    float mag;            //!< Squared magnitude of the maximum
+    unsigned int index;   //!< Index of the maximum in the line
+    float power;          //!< Sum of the squared magnitudes of the line
+};
+
+
+/*!
+ * \brief Receiver-wide pool of threads for the acquisition searches.
+ *
+ * parallel_for() splits a search (usually, one task per Doppler line)
+ * among the pool threads and the calling thread, which take the next
+ * pending task as soon as they are free, and returns when all are done.
+ * Since the caller always takes part, a search completes even when the
+ * pool threads are busy, and a pool of 0 threads is a serial search.
+ * submit() queues a job to be run asynchronously.
+ *
+ * The number of threads is set once, with set_num_threads(), before the
+ * first use (GNSS-SDR.acquisition_threads, see GNSSFlowgraph), so that the
+ * acquisition never takes the cores needed by the tracking.
+ */
+class Acquisition_Thread_Pool
+{
+public:
+    typedef boost::function<void(unsigned int task, Acquisition_Scratch& scratch)> Indexed_Task;
+
+    static Acquisition_Thread_Pool& instance();
+
+    /*!
+     * \brief Sets the number of pool threads. No effect once the pool is running.
+     */
+    static void set_num_threads(unsigned int num_threads);
+
+    static unsigned int default_num_threads(); //!< A quarter of the hardware threads
+
+    static Acquisition_Scratch& scratch(); //!< Scratch of the calling thread
+
+    /*!
+     * \brief Runs task(0) ... task(count - 1), returns when all of them are done
+     */
+    void parallel_for(unsigned int count, const Indexed_Task& task);
+
+    /*!
+     * \brief Runs job in a pool thread, or in the calling one if the pool has no threads
+     */
+    void submit(const boost::function<void()>& job);
+
+    unsigned int num_threads() const { return d_num_threads; }
+
+    ~Acquisition_Thread_Pool();
+
+private:
+    explicit Acquisition_Thread_Pool(unsigned int num_threads);
+    Acquisition_Thread_Pool(const Acquisition_Thread_Pool&);
+    Acquisition_Thread_Pool& operator=(const Acquisition_Thread_Pool&);
+
+    void run();
+
+    unsigned int d_num_threads;
+    std::deque<boost::function<void()> > d_jobs;
+    bool d_stop;
+    boost::mutex d_mutex;
+    boost::condition_variable d_condition;
+    boost::thread_group d_threads;
+};
+
+#endif
@@ -0,0 +1,147 @@
+/*!
+ * \file auxiliary_peak_detector.cc
+ * \brief Implementation of the multi-peak search used by the spoofing
+ * detection (SD) acquisition blocks to acquire auxiliary correlation peaks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "auxiliary_peak_detector.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+const unsigned int block_size = 16;
+
+bool weaker(const Acq_Peak& a, const Acq_Peak& b)
+{
+    return a.mag < b.mag;
+}
+}
+
+
+Auxiliary_Peak_Detector::Auxiliary_Peak_Detector()
+{}
+
+
+void Auxiliary_Peak_Detector::clear()
+{
+    d_candidates.clear();
+}
+
+
+void Auxiliary_Peak_Detector::add_doppler_line(const float* magnitude, unsigned int length, float threshold,
+        int doppler, int samples_per_code, float scale)
+{
+    add_doppler_line(magnitude, length, 0, length, threshold, doppler, samples_per_code, scale);
+}
+
+
+void Auxiliary_Peak_Detector::add_doppler_line(const float* magnitude, unsigned int length, unsigned int first, unsigned int last,
+        float threshold, int doppler, int samples_per_code, float scale)
+{
+    if (length < 3)
+        {
+            return;
+        }
+    // only interior samples can be local maxima
+    unsigned int stop = std::min(last, length - 1);
+    for (unsigned int start = std::max(first, 1u); start < stop; start += block_size)
+        {
+            unsigned int end = std::min(start + block_size, stop);
+            int above = 0;
+            for (unsigned int i = start; i < end; i++)
+                {
+                    above |= (magnitude[i] >= threshold);
+                }
+            if (!above)
+                {
+                    continue;
+                }
+            for (unsigned int i = start; i < end; i++)
+                {
+                    if (magnitude[i] >= threshold && magnitude[i] > magnitude[i - 1] && magnitude[i] >= magnitude[i + 1])
+                        {
+                            Acq_Peak peak;
+                            peak.code_phase = i % samples_per_code;
+                            peak.doppler = doppler;
+                            peak.mag = magnitude[i] / scale;
+                            d_candidates.push_back(peak);
+                        }
+                }
+        }
+}
+
+
+void Auxiliary_Peak_Detector::add_peaks(const Auxiliary_Peak_Detector& other)
+{
+    d_candidates.insert(d_candidates.end(), other.d_candidates.begin(), other.d_candidates.end());
+}
+
+
+bool Auxiliary_Peak_Detector::get_peak(unsigned int n, unsigned int doppler_step, Acq_Peak& peak)
+{
+    if (n == 0 || d_candidates.size() < n)
+        {
+            return false;
+        }
+    get_peaks(n, doppler_step, d_distinct);
+    if (d_distinct.size() < n)
+        {
+            return false;
+        }
+    peak = d_distinct.back();
+    return true;
+}
+
+
+void Auxiliary_Peak_Detector::get_peaks(unsigned int n, unsigned int doppler_step, std::vector<Acq_Peak>& peaks)
+{
+    peaks.clear();
+    std::make_heap(d_candidates.begin(), d_candidates.end(), weaker);
+    std::vector<Acq_Peak>::iterator heap_end = d_candidates.end();
+    while (heap_end != d_candidates.begin() && peaks.size() < n)
+        {
+            std::pop_heap(d_candidates.begin(), heap_end, weaker);
+            --heap_end;
+            const Acq_Peak& candidate = *heap_end;
+            bool distinct = true;
+            for (std::vector<Acq_Peak>::const_iterator it = peaks.begin(); it != peaks.end(); ++it)
+                {
+                    if (std::abs(candidate.code_phase - it->code_phase) <= 1 &&
+                            static_cast<unsigned int>(std::abs(candidate.doppler - it->doppler)) <= doppler_step)
+                        {
+                            distinct = false;
+                            break;
+                        }
+                }
+            if (distinct)
+                {
+                    peaks.push_back(candidate);
+                }
+        }
+}
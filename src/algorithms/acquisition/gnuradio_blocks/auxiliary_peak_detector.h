@@ -0,0 +1,100 @@
+/*!
+ * \file auxiliary_peak_detector.h
+ * \brief Interface of the multi-peak search used by the spoofing detection
+ * (SD) acquisition blocks to acquire auxiliary correlation peaks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_AUXILIARY_PEAK_DETECTOR_H_
+#define GNSS_SDR_AUXILIARY_PEAK_DETECTOR_H_
+
+#include <vector>
+#include "acquired_peaks.h"
+
+
+/*!
+ * \brief Collects the local maxima of the search grid that are above a
+ * threshold and returns the n-th strongest distinct one.
+ *
+ * Each Doppler line is scanned in blocks: a branch-free pass (which the
+ * compiler vectorizes) tells whether any sample of the block reaches the
+ * threshold, and only those blocks are checked for local maxima, so the
+ * cost of a line without strong peaks is a single pass. Peaks closer than
+ * one code phase sample and one Doppler step to a stronger peak are
+ * treated as the same peak. Selecting the n-th peak uses a heap and stops
+ * as soon as n distinct peaks have been found.
+ */
+class Auxiliary_Peak_Detector
+{
+public:
+    Auxiliary_Peak_Detector();
+
+    void clear(); //!< Forgets the peaks of the previous search
+
+    /*!
+     * \brief Adds the local maxima of one Doppler line above threshold
+     * \param magnitude - squared magnitude of the correlation
+     * \param length - number of samples of magnitude
+     * \param threshold - in the units of magnitude
+     * \param doppler - Doppler shift of the line [Hz]
+     * \param samples_per_code - to wrap the index into a code phase
+     * \param scale - the stored peak magnitudes are divided by scale
+     */
+    void add_doppler_line(const float* magnitude, unsigned int length, float threshold,
+            int doppler, int samples_per_code, float scale);
+
+    /*!
+     * \brief As above, for the local maxima among the samples first to last - 1 only,
+     * e.g. around the maximum of a line whose other samples are below threshold
+     */
+    void add_doppler_line(const float* magnitude, unsigned int length, unsigned int first, unsigned int last,
+            float threshold, int doppler, int samples_per_code, float scale);
+
+    /*!
+     * \brief Adds the local maxima collected by other, e.g. for another Doppler line
+     */
+    void add_peaks(const Auxiliary_Peak_Detector& other);
+
+    /*!
+     * \brief Returns in peak the n-th (starting from 1) strongest distinct peak
+     * \return false if there are fewer than n distinct peaks.
+     */
+    bool get_peak(unsigned int n, unsigned int doppler_step, Acq_Peak& peak);
+
+    /*!
+     * \brief Returns in peaks the n (or fewer, if there are not so many) strongest distinct peaks, strongest first
+     */
+    void get_peaks(unsigned int n, unsigned int doppler_step, std::vector<Acq_Peak>& peaks);
+
+    unsigned int size() const { return d_candidates.size(); } //!< Number of local maxima found
+
+private:
+    std::vector<Acq_Peak> d_candidates;
+    std::vector<Acq_Peak> d_distinct;
+};
+
+#endif
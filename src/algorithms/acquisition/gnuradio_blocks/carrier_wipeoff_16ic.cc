@@ -0,0 +1,110 @@
+/*!
+ * \file carrier_wipeoff_16ic.cc
+ * \brief Implementation of the carrier wipeoff of the PCPS acquisition blocks
+ * that work on 16-bit integer complex samples
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "carrier_wipeoff_16ic.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <volk/volk.h>
+#include <volk_gnsssdr/volk_gnsssdr.h>
+#include "GPS_L1_CA.h" //GPS_TWO_PI
+
+namespace
+{
+// largest component of the scaled input, 2^12: a rotated sample is at most sqrt(2) times larger
+const int scaled_max = 4096;
+
+// largest component that can be rotated without overflowing 16 bits, 32767 / sqrt(2)
+const int rotation_max = 23170;
+}
+
+
+Carrier_Wipeoff_16ic::Carrier_Wipeoff_16ic(long fs_in, long freq, unsigned int doppler_max, unsigned int doppler_step,
+        unsigned int num_doppler_bins, unsigned int length) :
+        d_phase_incs(num_doppler_bins),
+        d_length(length)
+{
+    for (unsigned int doppler_index = 0; doppler_index < num_doppler_bins; doppler_index++)
+        {
+            int doppler = -static_cast<int>(doppler_max) + doppler_step * doppler_index;
+            // same sign and initial phase as the Doppler_Wipeoff_Grid
+            float phase_step_rad = - static_cast<float>(GPS_TWO_PI) * (freq + doppler) / static_cast<float>(fs_in);
+            d_phase_incs[doppler_index] = lv_cmake(std::cos(phase_step_rad), std::sin(phase_step_rad));
+        }
+    d_input = static_cast<lv_16sc_t*>(volk_malloc(length * sizeof(lv_16sc_t), volk_get_alignment()));
+    d_rotated = static_cast<lv_16sc_t*>(volk_malloc(length * sizeof(lv_16sc_t), volk_get_alignment()));
+}
+
+
+Carrier_Wipeoff_16ic::~Carrier_Wipeoff_16ic()
+{
+    volk_free(d_input);
+    volk_free(d_rotated);
+}
+
+
+float Carrier_Wipeoff_16ic::set_input(const lv_16sc_t* in)
+{
+    int max_component = 0;
+    for (unsigned int i = 0; i < d_length; i++)
+        {
+            max_component = std::max(max_component, std::max(std::abs(static_cast<int>(lv_creal(in[i]))), std::abs(static_cast<int>(lv_cimag(in[i])))));
+        }
+    // left shift up to the scaled maximum, right shift if a rotated sample could overflow
+    int shift = 0;
+    while (max_component > 0 && (max_component << (shift + 1)) <= scaled_max)
+        {
+            shift++;
+        }
+    while (shift <= 0 && (max_component >> -shift) > rotation_max)
+        {
+            shift--;
+        }
+    long long power = 0;
+    for (unsigned int i = 0; i < d_length; i++)
+        {
+            int re = static_cast<int>(lv_creal(in[i]));
+            int im = static_cast<int>(lv_cimag(in[i]));
+            re = (shift >= 0 ? re * (1 << shift) : re >> -shift);
+            im = (shift >= 0 ? im * (1 << shift) : im >> -shift);
+            d_input[i] = lv_cmake(static_cast<int16_t>(re), static_cast<int16_t>(im));
+            power += static_cast<long long>(re) * re + static_cast<long long>(im) * im;
+        }
+    return static_cast<float>(power) / static_cast<float>(d_length);
+}
+
+
+void Carrier_Wipeoff_16ic::wipeoff(unsigned int doppler_index, gr_complex* out)
+{
+    lv_32fc_t phase = lv_cmake(1.0f, 0.0f);
+    volk_gnsssdr_16ic_s32fc_x2_rotator_16ic(d_rotated, d_input, d_phase_incs[doppler_index], &phase, d_length);
+    volk_gnsssdr_16ic_convert_32fc(out, d_rotated, d_length);
+}
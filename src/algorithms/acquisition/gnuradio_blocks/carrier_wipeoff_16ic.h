@@ -0,0 +1,85 @@
+/*!
+ * \file carrier_wipeoff_16ic.h
+ * \brief Interface of the carrier wipeoff of the PCPS acquisition blocks
+ * that work on 16-bit integer complex samples
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_CARRIER_WIPEOFF_16IC_H_
+#define GNSS_SDR_CARRIER_WIPEOFF_16IC_H_
+
+#include <vector>
+#include <gnuradio/gr_complex.h>
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+
+/*!
+ * \brief Carrier wipeoff of a Doppler search on cshort samples.
+ *
+ * The input stays in 16-bit integers up to the forward FFT: each Doppler
+ * bin is wiped off by rotating the samples with the 16ic rotator kernel,
+ * and only the result is converted to float, in the FFT input buffer. No
+ * float copy of the input nor a grid of wipeoff signals (8 bytes per
+ * sample and bin) is ever read.
+ *
+ * The rotation rounds to integers, so the input is first scaled by a power
+ * of two that brings its largest component to 2^12, which keeps the
+ * rounding noise far below the noise of the front end and leaves headroom
+ * for the rotation. The scale is the same for all the bins of a dwell and
+ * set_input() returns the power of the scaled input, so the test
+ * statistics are not changed by it.
+ */
+class Carrier_Wipeoff_16ic
+{
+public:
+    Carrier_Wipeoff_16ic(long fs_in, long freq, unsigned int doppler_max, unsigned int doppler_step,
+            unsigned int num_doppler_bins, unsigned int length);
+    ~Carrier_Wipeoff_16ic();
+
+    /*!
+     * \brief Scales length samples of in for the wipeoffs of this dwell
+     * \return The mean power of the scaled input
+     */
+    float set_input(const lv_16sc_t* in);
+
+    /*!
+     * \brief Writes the input wiped off with bin doppler_index to out (length samples)
+     */
+    void wipeoff(unsigned int doppler_index, gr_complex* out);
+
+    unsigned int length() const { return d_length; }
+
+private:
+    Carrier_Wipeoff_16ic(const Carrier_Wipeoff_16ic&);
+    Carrier_Wipeoff_16ic& operator=(const Carrier_Wipeoff_16ic&);
+
+    std::vector<lv_32fc_t> d_phase_incs; // one per Doppler bin
+    lv_16sc_t* d_input;
+    lv_16sc_t* d_rotated;
+    unsigned int d_length;
+};
+
+#endif
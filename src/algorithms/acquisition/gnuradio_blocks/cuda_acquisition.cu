@@ -0,0 +1,271 @@
+/*!
+ * \file cuda_acquisition.cu
+ * \brief Implementation of the batched PCPS acquisition search on NVIDIA CUDA GPUs
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "cuda_acquisition.h"
+#include <math.h>
+#include <stdio.h>
+
+// threads per block of the line maximum reduction, a power of two
+#define MAX_THREADS 256
+
+__device__ cufftComplex complex_multiply(cufftComplex a, cufftComplex b)
+{
+    return make_cuFloatComplex(__fmul_rn(a.x, b.x) - __fmul_rn(a.y, b.y), __fmul_rn(a.y, b.x) + __fmul_rn(a.x, b.y));
+}
+
+
+// out[bin][n] = in[n] * exp(-j*2*pi*cycles_per_sample[bin]*n)
+__global__ void doppler_wipeoff_kernel(cufftComplex* out, const cufftComplex* in,
+        const double* cycles_per_sample, int fft_size, int num_doppler_bins)
+{
+    int total = fft_size * num_doppler_bins;
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < total; i += blockDim.x * gridDim.x)
+        {
+            int bin = i / fft_size;
+            int n = i - bin * fft_size;
+            // the phase is reduced to one cycle in double precision, float
+            // would lose the fraction after a few thousand samples
+            double cycles = cycles_per_sample[bin] * n;
+            float phase = static_cast<float>(2.0 * M_PI * (cycles - floor(cycles)));
+            float sin;
+            float cos;
+            __sincosf(phase, &sin, &cos);
+            out[i] = complex_multiply(in[n], make_cuFloatComplex(cos, -sin));
+        }
+}
+
+
+// out[code][bin][n] = input_ffts[bin][n] * code_ffts[code][n]
+__global__ void code_multiply_kernel(cufftComplex* out, const cufftComplex* input_ffts,
+        const cufftComplex* code_ffts, int fft_size, int num_doppler_bins, int n_codes)
+{
+    int grid_size = fft_size * num_doppler_bins;
+    int total = grid_size * n_codes;
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < total; i += blockDim.x * gridDim.x)
+        {
+            int code = i / grid_size;
+            int j = i - code * grid_size;
+            int n = j % fft_size;
+            out[i] = complex_multiply(input_ffts[j], code_ffts[code * fft_size + n]);
+        }
+}
+
+
+// one block per line
+__global__ void line_max_kernel(Cuda_Line_Max* lines, const cufftComplex* correlation, int fft_size)
+{
+    __shared__ float mags[MAX_THREADS];
+    __shared__ int indexs[MAX_THREADS];
+    __shared__ float powers[MAX_THREADS];
+
+    const cufftComplex* line = correlation + static_cast<size_t>(blockIdx.x) * fft_size;
+    float best = -1.0f;
+    int best_index = 0;
+    float power = 0.0f;
+    for (int n = threadIdx.x; n < fft_size; n += blockDim.x)
+        {
+            float mag = line[n].x * line[n].x + line[n].y * line[n].y;
+            power += mag;
+            if (mag > best)
+                {
+                    best = mag;
+                    best_index = n;
+                }
+        }
+    mags[threadIdx.x] = best;
+    indexs[threadIdx.x] = best_index;
+    powers[threadIdx.x] = power;
+
+    for (int stride = blockDim.x / 2; stride > 0; stride >>= 1)
+        {
+            __syncthreads();
+            if (threadIdx.x < stride)
+                {
+                    int other = threadIdx.x + stride;
+                    // ties go to the first sample, as in volk_32f_index_max
+                    if (mags[other] > mags[threadIdx.x] ||
+                            (mags[other] == mags[threadIdx.x] && indexs[other] < indexs[threadIdx.x]))
+                        {
+                            mags[threadIdx.x] = mags[other];
+                            indexs[threadIdx.x] = indexs[other];
+                        }
+                    powers[threadIdx.x] += powers[other];
+                }
+        }
+
+    if (threadIdx.x == 0)
+        {
+            lines[blockIdx.x].mag = mags[0];
+            lines[blockIdx.x].index = indexs[0];
+            lines[blockIdx.x].power = powers[0];
+        }
+}
+
+
+cuda_acquisition::cuda_acquisition() :
+        d_fft_size(0),
+        d_num_doppler_bins(0),
+        d_max_codes(0),
+        d_sig_in(0),
+        d_cycles_per_sample(0),
+        d_input_ffts(0),
+        d_code_ffts(0),
+        d_correlation(0),
+        d_lines(0),
+        d_forward_plan(0),
+        d_forward_plan_created(false),
+        d_stream(0),
+        d_initialized(false)
+{}
+
+
+cuda_acquisition::~cuda_acquisition()
+{
+    free_cuda();
+}
+
+
+bool cuda_acquisition::init_cuda(int fft_size, int num_doppler_bins, int max_codes, const double* cycles_per_sample)
+{
+    free_cuda();
+    d_fft_size = fft_size;
+    d_num_doppler_bins = num_doppler_bins;
+    d_max_codes = max_codes;
+
+    size_t line_bytes = static_cast<size_t>(fft_size) * sizeof(cufftComplex);
+    if (cudaStreamCreate(&d_stream) != cudaSuccess ||
+            cudaMalloc(&d_sig_in, line_bytes) != cudaSuccess ||
+            cudaMalloc(&d_cycles_per_sample, num_doppler_bins * sizeof(double)) != cudaSuccess ||
+            cudaMalloc(&d_input_ffts, line_bytes * num_doppler_bins) != cudaSuccess ||
+            cudaMalloc(&d_code_ffts, line_bytes * max_codes) != cudaSuccess ||
+            cudaMalloc(&d_correlation, line_bytes * num_doppler_bins * max_codes) != cudaSuccess ||
+            cudaMalloc(&d_lines, num_doppler_bins * max_codes * sizeof(Cuda_Line_Max)) != cudaSuccess)
+        {
+            printf("CUDA acquisition: cannot allocate the device buffers\n");
+            free_cuda();
+            return false;
+        }
+    cudaMemcpy(d_cycles_per_sample, cycles_per_sample, num_doppler_bins * sizeof(double), cudaMemcpyHostToDevice);
+
+    if (cufftPlan1d(&d_forward_plan, fft_size, CUFFT_C2C, num_doppler_bins) != CUFFT_SUCCESS)
+        {
+            printf("CUDA acquisition: cannot create the cuFFT plan of size %i\n", fft_size);
+            free_cuda();
+            return false;
+        }
+    d_forward_plan_created = true;
+    cufftSetStream(d_forward_plan, d_stream);
+    d_initialized = true;
+    return true;
+}
+
+
+bool cuda_acquisition::inverse_plan(int n_codes, cufftHandle& plan)
+{
+    std::map<int, cufftHandle>::iterator it = d_inverse_plans.find(n_codes);
+    if (it != d_inverse_plans.end())
+        {
+            plan = it->second;
+            return true;
+        }
+    if (cufftPlan1d(&plan, d_fft_size, CUFFT_C2C, n_codes * d_num_doppler_bins) != CUFFT_SUCCESS)
+        {
+            printf("CUDA acquisition: cannot create the cuFFT plan for %i codes\n", n_codes);
+            return false;
+        }
+    cufftSetStream(plan, d_stream);
+    d_inverse_plans[n_codes] = plan;
+    return true;
+}
+
+
+bool cuda_acquisition::search(const std::complex<float>* in, const std::complex<float>* const* code_ffts, int n_codes,
+        Cuda_Line_Max* lines)
+{
+    if (!d_initialized || n_codes < 1 || n_codes > d_max_codes)
+        {
+            return false;
+        }
+    cufftHandle inverse;
+    if (!inverse_plan(n_codes, inverse))
+        {
+            return false;
+        }
+    size_t line_bytes = static_cast<size_t>(d_fft_size) * sizeof(cufftComplex);
+    cudaMemcpyAsync(d_sig_in, in, line_bytes, cudaMemcpyHostToDevice, d_stream);
+    for (int code = 0; code < n_codes; code++)
+        {
+            cudaMemcpyAsync(d_code_ffts + code * d_fft_size, code_ffts[code], line_bytes, cudaMemcpyHostToDevice, d_stream);
+        }
+
+    int threads_per_block = MAX_THREADS;
+    int grid_samples = d_fft_size * d_num_doppler_bins;
+    int blocks = (grid_samples + threads_per_block - 1) / threads_per_block;
+    doppler_wipeoff_kernel<<<blocks, threads_per_block, 0, d_stream>>>(d_input_ffts, d_sig_in,
+            d_cycles_per_sample, d_fft_size, d_num_doppler_bins);
+    cufftExecC2C(d_forward_plan, d_input_ffts, d_input_ffts, CUFFT_FORWARD);
+
+    blocks = (grid_samples * n_codes + threads_per_block - 1) / threads_per_block;
+    code_multiply_kernel<<<blocks, threads_per_block, 0, d_stream>>>(d_correlation, d_input_ffts,
+            d_code_ffts, d_fft_size, d_num_doppler_bins, n_codes);
+    cufftExecC2C(inverse, d_correlation, d_correlation, CUFFT_INVERSE);
+
+    line_max_kernel<<<n_codes * d_num_doppler_bins, MAX_THREADS, 0, d_stream>>>(d_lines, d_correlation, d_fft_size);
+    cudaMemcpyAsync(lines, d_lines, n_codes * d_num_doppler_bins * sizeof(Cuda_Line_Max), cudaMemcpyDeviceToHost, d_stream);
+    return cudaStreamSynchronize(d_stream) == cudaSuccess;
+}
+
+
+bool cuda_acquisition::free_cuda()
+{
+    for (std::map<int, cufftHandle>::iterator it = d_inverse_plans.begin(); it != d_inverse_plans.end(); ++it)
+        {
+            cufftDestroy(it->second);
+        }
+    d_inverse_plans.clear();
+    if (d_forward_plan_created) cufftDestroy(d_forward_plan);
+    if (d_sig_in != 0) cudaFree(d_sig_in);
+    if (d_cycles_per_sample != 0) cudaFree(d_cycles_per_sample);
+    if (d_input_ffts != 0) cudaFree(d_input_ffts);
+    if (d_code_ffts != 0) cudaFree(d_code_ffts);
+    if (d_correlation != 0) cudaFree(d_correlation);
+    if (d_lines != 0) cudaFree(d_lines);
+    if (d_stream != 0) cudaStreamDestroy(d_stream);
+    d_forward_plan_created = false;
+    d_sig_in = 0;
+    d_cycles_per_sample = 0;
+    d_input_ffts = 0;
+    d_code_ffts = 0;
+    d_correlation = 0;
+    d_lines = 0;
+    d_stream = 0;
+    d_initialized = false;
+    return true;
+}
@@ -0,0 +1,109 @@
+/*!
+ * \file cuda_acquisition.h
+ * \brief Interface of the batched PCPS acquisition search on NVIDIA CUDA GPUs
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_CUDA_ACQUISITION_H_
+#define GNSS_SDR_CUDA_ACQUISITION_H_
+
+#include <complex>
+#include <map>
+#include <cuda_runtime.h>
+#include <cufft.h>
+
+/*!
+ * \brief Maximum of the correlation of one code over one Doppler bin.
+ */
+struct Cuda_Line_Max
+{
+    float mag;   //!< Squared magnitude of the maximum
+    int index;   //!< Sample of the maximum
+    float power; //!< Sum of the squared magnitudes of the line
+};
+
+
+/*!
+ * \brief PCPS search of several codes over all the Doppler bins of a grid
+ * in one batch on a CUDA GPU.
+ *
+ * The input block is wiped off with every Doppler bin and transformed by a
+ * single batched cuFFT plan; then each code FFT is multiplied with all the
+ * bins, the whole code x bin set goes through one batched inverse plan and
+ * the maximum of each line is reduced on the GPU, so only one line maximum
+ * per code and bin is copied back. cuFFT handles any FFT size, so the
+ * samples do not have to be zero padded to a power of two.
+ */
+class cuda_acquisition
+{
+public:
+    cuda_acquisition();
+    ~cuda_acquisition();
+
+    /*!
+     * \brief Allocates the device buffers for up to max_codes codes
+     * \param cycles_per_sample - (IF + Doppler) / fs_in of each bin
+     */
+    bool init_cuda(int fft_size, int num_doppler_bins, int max_codes, const double* cycles_per_sample);
+
+    /*!
+     * \brief Searches n_codes conjugated code FFTs over the Doppler bins of in (fft_size samples)
+     * \param lines - n_codes x num_doppler_bins maxima, code major
+     */
+    bool search(const std::complex<float>* in, const std::complex<float>* const* code_ffts, int n_codes,
+            Cuda_Line_Max* lines);
+
+    bool free_cuda();
+
+    int max_codes() const { return d_max_codes; }
+
+private:
+    cuda_acquisition(const cuda_acquisition&);
+    cuda_acquisition& operator=(const cuda_acquisition&);
+
+    bool inverse_plan(int n_codes, cufftHandle& plan);
+
+    int d_fft_size;
+    int d_num_doppler_bins;
+    int d_max_codes;
+
+    // device buffers
+    cufftComplex* d_sig_in;
+    double* d_cycles_per_sample;
+    cufftComplex* d_input_ffts;  // num_doppler_bins x fft_size
+    cufftComplex* d_code_ffts;   // max_codes x fft_size
+    cufftComplex* d_correlation; // max_codes x num_doppler_bins x fft_size
+    Cuda_Line_Max* d_lines;
+
+    cufftHandle d_forward_plan;
+    bool d_forward_plan_created;
+    std::map<int, cufftHandle> d_inverse_plans; // per number of codes in the batch
+    cudaStream_t d_stream;
+    bool d_initialized;
+};
+
+#endif /* GNSS_SDR_CUDA_ACQUISITION_H_ */
@@ -0,0 +1,142 @@
+/*!
+ * \file fft_plan_cache.cc
+ * \brief Implementation of the cache of FFT plans shared by the acquisition
+ * blocks and of the persistent FFTW wisdom
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "fft_plan_cache.h"
+#include <map>
+#include <utility>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/thread/mutex.hpp>
+#include <fftw3.h>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+namespace
+{
+typedef std::pair<unsigned int, bool> Plan_Key; // size, forward
+
+boost::mutex plans_mutex;
+std::map<Plan_Key, std::vector<gr::fft::fft_complex*> > free_plans;
+std::map<gr::fft::fft_complex*, Plan_Key> used_plans;
+std::string wisdom_file;
+bool new_plans = false;
+}
+
+
+gr::fft::fft_complex* Fft_Plan_Cache::acquire(unsigned int fft_size, bool forward)
+{
+    Plan_Key key(fft_size, forward);
+    {
+        boost::mutex::scoped_lock lock(plans_mutex);
+        std::vector<gr::fft::fft_complex*>& plans = free_plans[key];
+        if (!plans.empty())
+            {
+                gr::fft::fft_complex* plan = plans.back();
+                plans.pop_back();
+                used_plans[plan] = key;
+                return plan;
+            }
+    }
+
+    // planned outside the lock, GNU Radio serializes the FFTW planner itself
+    gr::fft::fft_complex* plan = new gr::fft::fft_complex(fft_size, forward);
+    boost::mutex::scoped_lock lock(plans_mutex);
+    used_plans[plan] = key;
+    new_plans = true;
+    DLOG(INFO) << "New " << (forward ? "forward" : "inverse") << " FFT plan of " << fft_size << " samples";
+    return plan;
+}
+
+
+void Fft_Plan_Cache::release(gr::fft::fft_complex* plan)
+{
+    if (plan == 0)
+        {
+            return;
+        }
+    boost::mutex::scoped_lock lock(plans_mutex);
+    std::map<gr::fft::fft_complex*, Plan_Key>::iterator it = used_plans.find(plan);
+    if (it == used_plans.end())
+        {
+            LOG(WARNING) << "Released an FFT plan that does not come from the plan cache";
+            delete plan;
+            return;
+        }
+    free_plans[it->second].push_back(plan);
+    used_plans.erase(it);
+}
+
+
+void Fft_Plan_Cache::set_wisdom_file(const std::string& filename)
+{
+    {
+        boost::mutex::scoped_lock lock(plans_mutex);
+        wisdom_file = filename;
+    }
+    if (filename.empty() || !boost::filesystem::exists(filename))
+        {
+            return;
+        }
+    gr::fft::planner::scoped_lock lock(gr::fft::planner::mutex());
+    if (fftwf_import_wisdom_from_filename(filename.c_str()))
+        {
+            LOG(INFO) << "FFTW wisdom loaded from " << filename;
+        }
+    else
+        {
+            LOG(WARNING) << "Unable to load the FFTW wisdom from " << filename;
+        }
+}
+
+
+void Fft_Plan_Cache::save_wisdom()
+{
+    std::string filename;
+    {
+        boost::mutex::scoped_lock lock(plans_mutex);
+        if (wisdom_file.empty() || !new_plans)
+            {
+                return;
+            }
+        filename = wisdom_file;
+        new_plans = false;
+    }
+    gr::fft::planner::scoped_lock lock(gr::fft::planner::mutex());
+    if (fftwf_export_wisdom_to_filename(filename.c_str()))
+        {
+            DLOG(INFO) << "FFTW wisdom saved to " << filename;
+        }
+    else
+        {
+            LOG(WARNING) << "Unable to save the FFTW wisdom to " << filename;
+        }
+}
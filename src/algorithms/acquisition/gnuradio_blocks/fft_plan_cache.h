@@ -0,0 +1,79 @@
+/*!
+ * \file fft_plan_cache.h
+ * \brief Interface of the cache of FFT plans shared by the acquisition
+ * blocks and of the persistent FFTW wisdom
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_FFT_PLAN_CACHE_H_
+#define GNSS_SDR_FFT_PLAN_CACHE_H_
+
+#include <string>
+#include <gnuradio/fft/fft.h>
+
+/*!
+ * \brief Process-wide cache of the FFT plans of the acquisition blocks.
+ *
+ * Planning an FFT with FFTW is slow, specially for sizes that are not a
+ * power of two (e.g. 4000 samples for 1 ms at 4 Msps), and every channel
+ * plans the same few sizes. The plans released by a block (or a thread of
+ * the acquisition pool) are kept, keyed by size and direction, and handed
+ * to the next block that needs one, so a size is planned at most as many
+ * times as plans of it are in use at the same time.
+ *
+ * The FFTW wisdom can also be saved to a file (GNSS-SDR.fftw_wisdom_file)
+ * and loaded at startup, so that a restarted receiver does not have to
+ * measure the plans again. All the functions are thread-safe.
+ */
+class Fft_Plan_Cache
+{
+public:
+    /*!
+     * \brief Returns a plan of fft_size samples, planning it if none is free.
+     *
+     * The contents of its buffers are undefined. It must be given back
+     * with release() instead of deleted.
+     */
+    static gr::fft::fft_complex* acquire(unsigned int fft_size, bool forward);
+
+    /*!
+     * \brief Gives back a plan obtained from acquire(). A null plan is ignored.
+     */
+    static void release(gr::fft::fft_complex* plan);
+
+    /*!
+     * \brief Sets the FFTW wisdom file and loads it, if it exists. An empty name disables it.
+     */
+    static void set_wisdom_file(const std::string& filename);
+
+    /*!
+     * \brief Saves the FFTW wisdom to the wisdom file, if set and new plans were made since the last save
+     */
+    static void save_wisdom();
+};
+
+#endif
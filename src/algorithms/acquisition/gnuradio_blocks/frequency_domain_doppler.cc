@@ -0,0 +1,127 @@
+/*!
+ * \file frequency_domain_doppler.cc
+ * \brief Implementation of the Doppler search of the PCPS acquisition blocks done
+ * by rotating the code spectrum instead of wiping off every Doppler bin
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "frequency_domain_doppler.h"
+#include <cmath>
+#include <cstring>
+#include <volk/volk.h>
+#include <volk_gnsssdr/volk_gnsssdr.h>
+#include "GPS_L1_CA.h" //GPS_TWO_PI
+
+
+Frequency_Domain_Doppler::Frequency_Domain_Doppler(long fs_in, long freq, unsigned int doppler_max, unsigned int doppler_step,
+        unsigned int num_doppler_bins, unsigned int fft_size) :
+        d_fft_size(fft_size),
+        d_residual(num_doppler_bins),
+        d_shift(num_doppler_bins)
+{
+    double bin_hz = static_cast<double>(fs_in) / static_cast<double>(fft_size);
+    std::vector<double> residuals_hz;
+    for (unsigned int doppler_index = 0; doppler_index < num_doppler_bins; doppler_index++)
+        {
+            int doppler = -static_cast<int>(doppler_max) + doppler_step * doppler_index;
+            // residuals in [-bin_hz/2, bin_hz/2), so that they repeat across the grid
+            long k = static_cast<long>(std::floor(doppler / bin_hz + 0.5));
+            double residual_hz = doppler - k * bin_hz;
+            unsigned int j = 0;
+            while (j < residuals_hz.size() && std::abs(residuals_hz[j] - residual_hz) > 1e-3)
+                {
+                    j++;
+                }
+            if (j == residuals_hz.size())
+                {
+                    residuals_hz.push_back(residual_hz);
+                }
+            d_residual[doppler_index] = j;
+            d_shift[doppler_index] = ((k % static_cast<long>(fft_size)) + fft_size) % fft_size;
+        }
+
+    for (unsigned int j = 0; j < residuals_hz.size(); j++)
+        {
+            d_input_ffts.push_back(static_cast<gr_complex*>(volk_malloc(fft_size * sizeof(gr_complex), volk_get_alignment())));
+            double carrier_hz = freq + residuals_hz[j];
+            if (std::abs(carrier_hz) < 1e-3)
+                {
+                    d_wipeoffs.push_back(0);
+                    continue;
+                }
+            gr_complex* wipeoff = static_cast<gr_complex*>(volk_malloc(fft_size * sizeof(gr_complex), volk_get_alignment()));
+            float phase_step_rad = static_cast<float>(GPS_TWO_PI * carrier_hz / static_cast<double>(fs_in));
+            float _phase[1];
+            _phase[0] = 0;
+            volk_gnsssdr_s32f_nco_32fc(wipeoff, - phase_step_rad, _phase, fft_size);
+            d_wipeoffs.push_back(wipeoff);
+        }
+}
+
+
+Frequency_Domain_Doppler::~Frequency_Domain_Doppler()
+{
+    for (unsigned int j = 0; j < d_input_ffts.size(); j++)
+        {
+            volk_free(d_input_ffts[j]);
+            if (d_wipeoffs[j] != 0)
+                {
+                    volk_free(d_wipeoffs[j]);
+                }
+        }
+}
+
+
+void Frequency_Domain_Doppler::set_input(const gr_complex* in, gr::fft::fft_complex* fft)
+{
+    for (unsigned int j = 0; j < d_input_ffts.size(); j++)
+        {
+            if (d_wipeoffs[j] != 0)
+                {
+                    volk_32fc_x2_multiply_32fc(fft->get_inbuf(), in, d_wipeoffs[j], d_fft_size);
+                }
+            else
+                {
+                    memcpy(fft->get_inbuf(), in, sizeof(gr_complex) * d_fft_size);
+                }
+            fft->execute();
+            memcpy(d_input_ffts[j], fft->get_outbuf(), sizeof(gr_complex) * d_fft_size);
+        }
+}
+
+
+void Frequency_Domain_Doppler::multiply_code(unsigned int doppler_index, const gr_complex* fft_codes, gr_complex* out) const
+{
+    // out[m] = X[m] * C[(m - shift) mod fft_size], in two contiguous pieces
+    const gr_complex* input_fft = d_input_ffts[d_residual[doppler_index]];
+    unsigned int shift = d_shift[doppler_index];
+    volk_32fc_x2_multiply_32fc(out + shift, input_fft + shift, fft_codes, d_fft_size - shift);
+    if (shift > 0)
+        {
+            volk_32fc_x2_multiply_32fc(out, input_fft, fft_codes + d_fft_size - shift, shift);
+        }
+}
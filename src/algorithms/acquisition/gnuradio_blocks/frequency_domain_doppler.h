@@ -0,0 +1,85 @@
+/*!
+ * \file frequency_domain_doppler.h
+ * \brief Interface of the Doppler search of the PCPS acquisition blocks done
+ * by rotating the code spectrum instead of wiping off every Doppler bin
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_FREQUENCY_DOMAIN_DOPPLER_H_
+#define GNSS_SDR_FREQUENCY_DOMAIN_DOPPLER_H_
+
+#include <vector>
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/fft/fft.h>
+
+/*!
+ * \brief Doppler search of a PCPS acquisition in the frequency domain.
+ *
+ * A Doppler shift of k FFT bins (fs_in / fft_size Hz each) in the input is
+ * the same as a rotation of k bins of its spectrum, so instead of wiping
+ * off the carrier and running a forward FFT per Doppler bin, the input FFT
+ * is computed once per dwell and the code spectrum is rotated when it is
+ * multiplied with it. The rotation only puts a phase ramp on the
+ * correlation, which does not change its magnitude.
+ *
+ * Doppler bins that are not a multiple of the FFT bin spacing are split
+ * into a whole number of FFT bins and a residual below half a bin. A
+ * forward FFT is still needed for each distinct residual; the input is
+ * wiped off with it in the time domain. With a 1 ms dwell and 250 Hz
+ * steps that is 4 forward FFTs per dwell, whatever the Doppler range.
+ */
+class Frequency_Domain_Doppler
+{
+public:
+    Frequency_Domain_Doppler(long fs_in, long freq, unsigned int doppler_max, unsigned int doppler_step,
+            unsigned int num_doppler_bins, unsigned int fft_size);
+    ~Frequency_Domain_Doppler();
+
+    /*!
+     * \brief Computes the FFTs of the fft_size samples of in, using the fft plan
+     */
+    void set_input(const gr_complex* in, gr::fft::fft_complex* fft);
+
+    /*!
+     * \brief Writes to out the input FFT shifted to a Doppler bin times the code FFT
+     */
+    void multiply_code(unsigned int doppler_index, const gr_complex* fft_codes, gr_complex* out) const;
+
+    unsigned int num_input_ffts() const { return d_input_ffts.size(); } //!< Forward FFTs per dwell
+
+private:
+    Frequency_Domain_Doppler(const Frequency_Domain_Doppler&);
+    Frequency_Domain_Doppler& operator=(const Frequency_Domain_Doppler&);
+
+    unsigned int d_fft_size;
+    std::vector<gr_complex*> d_wipeoffs;     // one per residual, 0 if there is no carrier to wipe off
+    std::vector<gr_complex*> d_input_ffts;   // one per residual
+    std::vector<unsigned int> d_residual;    // residual of each Doppler bin
+    std::vector<unsigned int> d_shift;       // code spectrum rotation of each Doppler bin, in [0, fft_size)
+};
+
+#endif
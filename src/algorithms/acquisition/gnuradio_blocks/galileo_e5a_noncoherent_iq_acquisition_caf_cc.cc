@@ -36,15 +36,81 @@
  */
 
 #include "galileo_e5a_noncoherent_iq_acquisition_caf_cc.h"
+#include <algorithm>
+#include <cmath>
 #include <sstream>
+#include <boost/bind.hpp>
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
 #include <volk/volk.h>
 #include <volk_gnsssdr/volk_gnsssdr.h>
 #include "control_message_factory.h"
+#include "fft_plan_cache.h"
+#include "channel_event.h"
 
 using google::LogMessage;
 
+namespace
+{
+// Conjugated FFTs of the real and of the imaginary part of a signal, from its FFT z_fft
+void split_conjugate_spectra(const gr_complex* z_fft, gr_complex* real_fft_conj, gr_complex* imag_fft_conj, unsigned int n)
+{
+    for (unsigned int k = 0; k < n; k++)
+        {
+            gr_complex z_conj = std::conj(z_fft[k]);
+            gr_complex mirror = z_fft[(n - k) % n];
+            real_fft_conj[k] = 0.5f * (z_conj + mirror);
+            imag_fft_conj[k] = 0.5f * (z_conj - mirror);
+        }
+}
+
+// Correlates a component with its code (and with its code B, if any), leaves in best the
+// squared magnitudes of the stronger one, and returns their maximum
+float correlate_component(const gr_complex* input_fft, const gr_complex* fft_code_A, const gr_complex* fft_code_B,
+        gr::fft::fft_complex* ifft, unsigned int fft_size, float*& best, float*& candidate)
+{
+#if VOLK_GT_122
+    uint16_t indext = 0;
+#else
+    unsigned int indext = 0;
+#endif
+    volk_32fc_x2_multiply_32fc(ifft->get_inbuf(), input_fft, fft_code_A, fft_size);
+    ifft->execute();
+    volk_32fc_magnitude_squared_32f(best, ifft->get_outbuf(), fft_size);
+    volk_32f_index_max_16u(&indext, best, fft_size);
+    float best_mag = best[indext];
+    if (fft_code_B)
+        {
+            volk_32fc_x2_multiply_32fc(ifft->get_inbuf(), input_fft, fft_code_B, fft_size);
+            ifft->execute();
+            volk_32fc_magnitude_squared_32f(candidate, ifft->get_outbuf(), fft_size);
+            volk_32f_index_max_16u(&indext, candidate, fft_size);
+            if (candidate[indext] > best_mag)
+                {
+                    best_mag = candidate[indext];
+                    std::swap(best, candidate);
+                }
+        }
+    return best_mag;
+}
+
+// Peak of a component at bin, averaged over the bins within half_bins of it with triangular weights
+float caf_average(const std::vector<Galileo_E5a_Doppler_Line>& lines, bool pilot, int bin, int half_bins, float weighting_factor)
+{
+    float sum = 0.0;
+    float weights = 0.0;
+    int first = std::max(bin - half_bins, 0);
+    int last = std::min(bin + half_bins, static_cast<int>(lines.size()) - 1);
+    for (int i = first; i <= last; i++)
+        {
+            float weight = 1.0 - weighting_factor * std::abs(bin - i);
+            sum += weight * (pilot ? lines[i].peak_Q : lines[i].peak_I);
+            weights += weight;
+        }
+    return sum / weights;
+}
+}
+
 galileo_e5a_noncoherentIQ_acquisition_caf_cc_sptr galileo_e5a_noncoherentIQ_make_acquisition_caf_cc(
         unsigned int sampled_ms,
         unsigned int max_dwells,
@@ -108,47 +174,26 @@ galileo_e5a_noncoherentIQ_acquisition_caf_cc::galileo_e5a_noncoherentIQ_acquisit
 
     d_inbuffer = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
     d_fft_code_I_A = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
-    d_magnitudeIA = static_cast<float*>(volk_malloc(d_fft_size * sizeof(float), volk_get_alignment()));
-
+    d_fft_code_Q_A = 0;
+    d_fft_code_I_B = 0;
+    d_fft_code_Q_B = 0;
     if (d_both_signal_components == true)
         {
             d_fft_code_Q_A = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
-            d_magnitudeQA = static_cast<float*>(volk_malloc(d_fft_size * sizeof(float), volk_get_alignment()));
-        }
-    else
-        {
-            d_fft_code_Q_A = 0;
-            d_magnitudeQA = 0;
         }
     // IF COHERENT INTEGRATION TIME > 1
     if (d_sampled_ms > 1)
         {
             d_fft_code_I_B = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
-            d_magnitudeIB = static_cast<float*>(volk_malloc(d_fft_size * sizeof(float), volk_get_alignment()));
             if (d_both_signal_components == true)
                 {
                     d_fft_code_Q_B = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
-                    d_magnitudeQB = static_cast<float*>(volk_malloc(d_fft_size * sizeof(float), volk_get_alignment()));
-                }
-            else
-                {
-                    d_fft_code_Q_B = 0;
-                    d_magnitudeQB = 0;
                 }
         }
-    else
-        {
-            d_fft_code_I_B = 0;
-            d_magnitudeIB = 0;
-            d_fft_code_Q_B = 0;
-            d_magnitudeQB = 0;
-        }
 
-    // Direct FFT
-    d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
-
-    // Inverse FFT
-    d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+    // Direct FFT, for the local codes and the shared input FFTs. The inverse FFTs
+    // and the magnitudes of the search are in the scratch of the acquisition threads
+    d_fft_if = Fft_Plan_Cache::acquire(d_fft_size, true);
 
     // For dumping samples into a file
     d_dump = dump;
@@ -157,60 +202,33 @@ galileo_e5a_noncoherentIQ_acquisition_caf_cc::galileo_e5a_noncoherentIQ_acquisit
     d_doppler_resolution = 0;
     d_threshold = 0;
     d_doppler_step = 250;
-    d_grid_doppler_wipeoffs = 0;
     d_gnss_synchro = 0;
     d_code_phase = 0;
     d_doppler_freq = 0;
     d_test_statistics = 0;
-    d_CAF_vector = 0;
-    d_CAF_vector_I = 0;
-    d_CAF_vector_Q = 0;
     d_channel = 0;
     d_gr_stream_buffer = 0;
 }
 
 galileo_e5a_noncoherentIQ_acquisition_caf_cc::~galileo_e5a_noncoherentIQ_acquisition_caf_cc()
 {
-    if (d_num_doppler_bins > 0)
-        {
-            for (unsigned int i = 0; i < d_num_doppler_bins; i++)
-                {
-                    volk_free(d_grid_doppler_wipeoffs[i]);
-                }
-            delete[] d_grid_doppler_wipeoffs;
-        }
-
     volk_free(d_inbuffer);
     volk_free(d_fft_code_I_A);
-    volk_free(d_magnitudeIA);
     if (d_both_signal_components == true)
         {
             volk_free(d_fft_code_Q_A);
-            volk_free(d_magnitudeQA);
         }
     // IF INTEGRATION TIME > 1
     if (d_sampled_ms > 1)
         {
             volk_free(d_fft_code_I_B);
-            volk_free(d_magnitudeIB);
             if (d_both_signal_components == true)
                 {
                     volk_free(d_fft_code_Q_B);
-                    volk_free(d_magnitudeQB);
-                }
-        }
-    if (d_CAF_window_hz > 0)
-        {
-            volk_free(d_CAF_vector);
-            volk_free(d_CAF_vector_I);
-            if (d_both_signal_components == true)
-                {
-                    volk_free(d_CAF_vector_Q);
                 }
         }
 
-    delete d_fft_if;
-    delete d_ifft;
+    Fft_Plan_Cache::release(d_fft_if);
 
     if (d_dump)
         {
@@ -221,50 +239,44 @@ galileo_e5a_noncoherentIQ_acquisition_caf_cc::~galileo_e5a_noncoherentIQ_acquisi
 
 void galileo_e5a_noncoherentIQ_acquisition_caf_cc::set_local_code(std::complex<float> * codeI, std::complex<float> * codeQ )
 {
-    // DATA SIGNAL
-    // Three replicas of data primary code. CODE A: (1,1,1)
-    memcpy(d_fft_if->get_inbuf(), codeI, sizeof(gr_complex)*d_fft_size);
-
+    // The data code is real and the pilot code imaginary, so one FFT of
+    // their sum holds both spectra, which are split by their symmetry.
+    // CODE A: three replicas of the primary codes (1,1,1)
+    gr_complex* code = d_fft_if->get_inbuf();
+    for (unsigned int i = 0; i < d_fft_size; i++)
+        {
+            code[i] = d_both_signal_components ? codeI[i] + codeQ[i] : codeI[i];
+        }
     d_fft_if->execute(); // We need the FFT of local code
-
-    //Conjugate the local code
-    volk_32fc_conjugate_32fc(d_fft_code_I_A,d_fft_if->get_outbuf(),d_fft_size);
-
-    // SAME FOR PILOT SIGNAL
     if (d_both_signal_components == true)
         {
-            // Three replicas of pilot primary code. CODE A: (1,1,1)
-            memcpy(d_fft_if->get_inbuf(), codeQ, sizeof(gr_complex)*d_fft_size);
-
-            d_fft_if->execute(); // We need the FFT of local code
-
+            split_conjugate_spectra(d_fft_if->get_outbuf(), d_fft_code_I_A, d_fft_code_Q_A, d_fft_size);
+        }
+    else
+        {
             //Conjugate the local code
-            volk_32fc_conjugate_32fc(d_fft_code_Q_A,d_fft_if->get_outbuf(),d_fft_size);
+            volk_32fc_conjugate_32fc(d_fft_code_I_A, d_fft_if->get_outbuf(), d_fft_size);
         }
+
     // IF INTEGRATION TIME > 1 code, we need to evaluate the other possible combination
     // Note: max integration time allowed = 3ms (dealt in adapter)
     if (d_sampled_ms > 1)
         {
-            // DATA CODE B: First replica is inverted (0,1,1)
-            volk_32fc_s32fc_multiply_32fc(&(d_fft_if->get_inbuf())[0],
-                    &codeI[0], gr_complex(-1,0),
-                    d_samples_per_code);
-
+            // CODE B: First replica is inverted (0,1,1)
+            for (unsigned int i = 0; i < d_fft_size; i++)
+                {
+                    code[i] = d_both_signal_components ? codeI[i] + codeQ[i] : codeI[i];
+                }
+            volk_32fc_s32fc_multiply_32fc(code, code, gr_complex(-1, 0), d_samples_per_code);
             d_fft_if->execute(); // We need the FFT of local code
-
-            //Conjugate the local code
-            volk_32fc_conjugate_32fc(d_fft_code_I_B,d_fft_if->get_outbuf(),d_fft_size);
-
             if (d_both_signal_components == true)
                 {
-                    // PILOT CODE B: First replica is inverted (0,1,1)
-                    volk_32fc_s32fc_multiply_32fc(&(d_fft_if->get_inbuf())[0],
-                            &codeQ[0], gr_complex(-1,0),
-                            d_samples_per_code);
-                    d_fft_if->execute(); // We need the FFT of local code
-
+                    split_conjugate_spectra(d_fft_if->get_outbuf(), d_fft_code_I_B, d_fft_code_Q_B, d_fft_size);
+                }
+            else
+                {
                     //Conjugate the local code
-                    volk_32fc_conjugate_32fc(d_fft_code_Q_B,d_fft_if->get_outbuf(),d_fft_size);
+                    volk_32fc_conjugate_32fc(d_fft_code_I_B, d_fft_if->get_outbuf(), d_fft_size);
                 }
         }
 }
@@ -282,7 +294,6 @@ void galileo_e5a_noncoherentIQ_acquisition_caf_cc::init()
     d_gnss_synchro->Acq_samplestamp_samples = 0;
     d_mag = 0.0;
     d_input_power = 0.0;
-    const double GALILEO_TWO_PI = 6.283185307179600;
 
     // Count the number of bins
     d_num_doppler_bins = 0;
@@ -294,29 +305,8 @@ void galileo_e5a_noncoherentIQ_acquisition_caf_cc::init()
         }
 
     // Create the carrier Doppler wipeoff signals
-    d_grid_doppler_wipeoffs = new gr_complex*[d_num_doppler_bins];
-    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
-        {
-            d_grid_doppler_wipeoffs[doppler_index] = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
-            int doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * doppler_index;
-            float phase_step_rad = GALILEO_TWO_PI * (d_freq + doppler) / static_cast<float>(d_fs_in);
-            float _phase[1];
-            _phase[0] = 0;
-            volk_gnsssdr_s32f_sincos_32fc(d_grid_doppler_wipeoffs[doppler_index], - phase_step_rad, _phase, d_fft_size);
-        }
-
-    /* CAF Filtering to resolve doppler ambiguity. Phase and quadrature must be processed
-     * separately before non-coherent integration */
-    //    if (d_CAF_filter)
-    if (d_CAF_window_hz > 0)
-        {
-            d_CAF_vector = static_cast<float*>(volk_malloc(d_num_doppler_bins * sizeof(float), volk_get_alignment()));
-            d_CAF_vector_I = static_cast<float*>(volk_malloc(d_num_doppler_bins * sizeof(float), volk_get_alignment()));
-            if (d_both_signal_components == true)
-                {
-                    d_CAF_vector_Q = static_cast<float*>(volk_malloc(d_num_doppler_bins * sizeof(float), volk_get_alignment()));
-                }
-        }
+    d_doppler_grid = Acquisition_Cache::doppler_wipeoff_grid(d_fs_in, d_freq, d_doppler_max, d_doppler_step, d_num_doppler_bins, d_fft_size);
+    d_doppler_lines.resize(d_num_doppler_bins);
 }
 
 
@@ -345,6 +335,51 @@ void galileo_e5a_noncoherentIQ_acquisition_caf_cc::set_state(int state)
 
 
 
+void galileo_e5a_noncoherentIQ_acquisition_caf_cc::search_doppler_line(unsigned int doppler_index, Acquisition_Scratch& scratch)
+{
+#if VOLK_GT_122
+    uint16_t indext = 0;
+#else
+    unsigned int indext = 0;
+#endif
+    gr::fft::fft_complex* ifft = scratch.ifft(d_fft_size);
+    float* magnitudes = scratch.magnitude(3 * d_fft_size);
+    float* best_I = magnitudes;
+    float* best_Q = magnitudes + d_fft_size;
+    float* candidate = magnitudes + 2 * d_fft_size;
+    const gr_complex* input_fft = d_input_ffts->get(doppler_index);
+    Galileo_E5a_Doppler_Line& line = d_doppler_lines[doppler_index];
+
+    // 3- Perform the FFT-based convolution  (parallel time search) with the codes of each
+    // component, and keep the best of its two combinations if the integration time > 1 code.
+    // If CAF filter to resolve doppler ambiguity is needed,
+    // peaks are stored before non-coherent integration.
+    line.peak_I = correlate_component(input_fft, d_fft_code_I_A, d_fft_code_I_B, ifft, d_fft_size, best_I, candidate);
+    line.peak_Q = 0.0;
+    if (d_both_signal_components)
+        {
+            line.peak_Q = correlate_component(input_fft, d_fft_code_Q_A, d_fft_code_Q_B, ifft, d_fft_size, best_Q, candidate);
+            // Integrate noncoherently the two best combinations (I² + Q²)
+            volk_32f_x2_add_32f(best_I, best_I, best_Q, d_fft_size);
+        }
+    volk_32f_index_max_16u(&indext, best_I, d_fft_size);
+    line.index = indext;
+    line.mag = best_I[indext];
+
+    // Record results to file if required
+    if (d_dump)
+        {
+            std::stringstream filename;
+            std::streamsize n = sizeof(float) * (d_fft_size); // noncomplex file write
+            int doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * doppler_index;
+            filename << "../data/test_statistics_E5a_sat_"
+                    << d_gnss_synchro->PRN << "_doppler_" <<  doppler << ".dat";
+            std::ofstream dump_file(filename.str().c_str(), std::ios::out | std::ios::binary);
+            dump_file.write((char*)best_I, n);
+        }
+}
+
+
 int galileo_e5a_noncoherentIQ_acquisition_caf_cc::general_work(int noutput_items,
         gr_vector_int &ninput_items, gr_vector_const_void_star &input_items,
         gr_vector_void_star &output_items __attribute__((unused)))
@@ -361,7 +396,6 @@ int galileo_e5a_noncoherentIQ_acquisition_caf_cc::general_work(int noutput_items
      * 7. Declare positive or negative acquisition using a message port
      */
 
-    int acquisition_message = -1; //0=STOP_CHANNEL 1=ACQ_SUCCEES 2=ACQ_FAIL
     /* States:     0 Stop Channel
      *         1 Load the buffer until it reaches fft_size
      *         2 Acquisition algorithm
@@ -424,24 +458,7 @@ int galileo_e5a_noncoherentIQ_acquisition_caf_cc::general_work(int noutput_items
 
             // initialize acquisition algorithm
             int doppler;
-#if VOLK_GT_122
-            uint16_t indext = 0;
-            uint16_t indext_IA = 0;
-            uint16_t indext_IB = 0;
-            uint16_t indext_QA = 0;
-            uint16_t indext_QB = 0;
-#else
-            unsigned int indext = 0;
-            unsigned int indext_IA = 0;
-            unsigned int indext_IB = 0;
-            unsigned int indext_QA = 0;
-            unsigned int indext_QB = 0;
-#endif
             float magt = 0.0;
-            float magt_IA = 0.0;
-            float magt_IB = 0.0;
-            float magt_QA = 0.0;
-            float magt_QB = 0.0;
             float fft_normalization_factor = static_cast<float>(d_fft_size) * static_cast<float>(d_fft_size);
             d_input_power = 0.0;
             d_mag = 0.0;
@@ -454,153 +471,27 @@ int galileo_e5a_noncoherentIQ_acquisition_caf_cc::general_work(int noutput_items
                     << ", doppler_step: " << d_doppler_step;
 
             // 1- Compute the input signal power estimation
-            volk_32fc_magnitude_squared_32f(d_magnitudeIA, d_inbuffer, d_fft_size);
-            volk_32f_accumulator_s32f(&d_input_power, d_magnitudeIA, d_fft_size);
+            float* magnitude = Acquisition_Thread_Pool::scratch().magnitude(d_fft_size);
+            volk_32fc_magnitude_squared_32f(magnitude, d_inbuffer, d_fft_size);
+            volk_32f_accumulator_s32f(&d_input_power, magnitude, d_fft_size);
             d_input_power /= static_cast<float>(d_fft_size);
 
             // 2- Doppler frequency search loop
+            // The FFTs of the carrier wiped--off incoming signal do not depend on the PRN:
+            // they are computed once per dwell for all the channels acquiring on it,
+            // and the Doppler lines are searched in parallel by the acquisition thread pool
+            d_input_ffts = Acquisition_Cache::input_fft_batch(d_doppler_grid, d_sample_counter, d_inbuffer, d_fft_if);
+            Acquisition_Thread_Pool::instance().parallel_for(d_num_doppler_bins,
+                    boost::bind(&galileo_e5a_noncoherentIQ_acquisition_caf_cc::search_doppler_line, this, _1, _2));
+            d_input_ffts.reset();
+
             for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
                 {
                     // doppler search steps
-
                     doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * doppler_index;
-
-                    volk_32fc_x2_multiply_32fc(d_fft_if->get_inbuf(), d_inbuffer,
-                            d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
-
-                    // 3- Perform the FFT-based convolution  (parallel time search)
-                    // Compute the FFT of the carrier wiped--off incoming signal
-                    d_fft_if->execute();
-
-                    // CODE IA
-                    // Multiply carrier wiped--off, Fourier transformed incoming signal
-                    // with the local FFT'd code reference using SIMD operations with VOLK library
-                    volk_32fc_x2_multiply_32fc(d_ifft->get_inbuf(),
-                            d_fft_if->get_outbuf(), d_fft_code_I_A, d_fft_size);
-
-                    // compute the inverse FFT
-                    d_ifft->execute();
-
-                    // Search maximum
-                    volk_32fc_magnitude_squared_32f(d_magnitudeIA, d_ifft->get_outbuf(), d_fft_size);
-                    volk_32f_index_max_16u(&indext_IA, d_magnitudeIA, d_fft_size);
+                    const Galileo_E5a_Doppler_Line& line = d_doppler_lines[doppler_index];
                     // Normalize the maximum value to correct the scale factor introduced by FFTW
-                    magt_IA = d_magnitudeIA[indext_IA] / (fft_normalization_factor * fft_normalization_factor);
-
-                    if (d_both_signal_components == true)
-                        {
-                            // REPEAT FOR ALL CODES. CODE_QA
-                            volk_32fc_x2_multiply_32fc(d_ifft->get_inbuf(),
-                                    d_fft_if->get_outbuf(), d_fft_code_Q_A, d_fft_size);
-                            d_ifft->execute();
-                            volk_32fc_magnitude_squared_32f(d_magnitudeQA, d_ifft->get_outbuf(), d_fft_size);
-                            volk_32f_index_max_16u(&indext_QA, d_magnitudeQA, d_fft_size);
-                            magt_QA = d_magnitudeQA[indext_QA] / (fft_normalization_factor * fft_normalization_factor);
-                        }
-                    if (d_sampled_ms > 1) // If Integration time > 1 code
-                        {
-                            // REPEAT FOR ALL CODES. CODE_IB
-                            volk_32fc_x2_multiply_32fc(d_ifft->get_inbuf(),
-                                    d_fft_if->get_outbuf(), d_fft_code_I_B, d_fft_size);
-                            d_ifft->execute();
-                            volk_32fc_magnitude_squared_32f(d_magnitudeIB, d_ifft->get_outbuf(), d_fft_size);
-                            volk_32f_index_max_16u(&indext_IB, d_magnitudeIB, d_fft_size);
-                            magt_IB = d_magnitudeIB[indext_IB] / (fft_normalization_factor * fft_normalization_factor);
-
-                            if (d_both_signal_components == true)
-                                {
-                                    // REPEAT FOR ALL CODES. CODE_QB
-                                    volk_32fc_x2_multiply_32fc(d_ifft->get_inbuf(),
-                                            d_fft_if->get_outbuf(), d_fft_code_Q_B, d_fft_size);
-                                    d_ifft->execute();
-                                    volk_32fc_magnitude_squared_32f(d_magnitudeQB, d_ifft->get_outbuf(), d_fft_size);
-                                    volk_32f_index_max_16u(&indext_QB, d_magnitudeQB, d_fft_size);
-                                    magt_QB = d_magnitudeIB[indext_QB] / (fft_normalization_factor * fft_normalization_factor);
-                                }
-                        }
-
-                    // Integrate noncoherently the two best combinations (I² + Q²)
-                    // and store the result in the I channel.
-                    // If CAF filter to resolve doppler ambiguity is needed,
-                    // peak is stored before non-coherent integration.
-                    if (d_sampled_ms > 1) // T_integration > 1 code
-                        {
-                            if (magt_IA >= magt_IB)
-                                {
-                                    // if (d_CAF_filter) {d_CAF_vector_I[doppler_index] = magt_IA;}
-                                    if (d_CAF_window_hz > 0) {d_CAF_vector_I[doppler_index] = d_magnitudeIA[indext_IA];}
-                                    if (d_both_signal_components)
-                                        {
-                                            // Integrate non-coherently I+Q
-                                            if (magt_QA >= magt_QB)
-                                                {
-                                                    // if (d_CAF_filter) {d_CAF_vector_Q[doppler_index] = magt_QA;}
-                                                    if (d_CAF_window_hz > 0) {d_CAF_vector_Q[doppler_index] = d_magnitudeQA[indext_QA];}
-                                                    for (unsigned int i=0; i<d_fft_size; i++)
-                                                        {
-                                                            d_magnitudeIA[i] += d_magnitudeQA[i];
-                                                        }
-                                                }
-                                            else
-                                                {
-                                                    // if (d_CAF_filter) {d_CAF_vector_Q[doppler_index] = magt_QB;}
-                                                    if (d_CAF_window_hz > 0) {d_CAF_vector_Q[doppler_index] = d_magnitudeQB[indext_QB];}
-                                                    for (unsigned int i=0; i<d_fft_size; i++)
-                                                        {
-                                                            d_magnitudeIA[i] += d_magnitudeQB[i];
-                                                        }
-                                                }
-                                        }
-                                    volk_32f_index_max_16u(&indext, d_magnitudeIA, d_fft_size);
-                                    magt = d_magnitudeIA[indext] / (fft_normalization_factor * fft_normalization_factor);
-                                }
-                            else
-                                {
-                                    // if (d_CAF_filter) {d_CAF_vector_I[doppler_index] = magt_IB;}
-                                    if (d_CAF_window_hz > 0) {d_CAF_vector_I[doppler_index] = d_magnitudeIB[indext_IB];}
-                                    if (d_both_signal_components)
-                                        {
-                                            // Integrate non-coherently I+Q
-                                            if (magt_QA >= magt_QB)
-                                                {
-                                                    //if (d_CAF_filter) {d_CAF_vector_Q[doppler_index] = magt_QA;}
-                                                    if (d_CAF_window_hz > 0) {d_CAF_vector_Q[doppler_index] = d_magnitudeQA[indext_QA];}
-                                                    for (unsigned int i=0; i<d_fft_size; i++)
-                                                        {
-                                                            d_magnitudeIB[i] += d_magnitudeQA[i];
-                                                        }
-                                                }
-                                            else
-                                                {
-                                                    // if (d_CAF_filter) {d_CAF_vector_Q[doppler_index] = magt_QB;}
-                                                    if (d_CAF_window_hz > 0) {d_CAF_vector_Q[doppler_index] = d_magnitudeQB[indext_QB];}
-                                                    for (unsigned int i=0; i<d_fft_size; i++)
-                                                        {
-                                                            d_magnitudeIB[i] += d_magnitudeQB[i];
-                                                        }
-                                                }
-                                        }
-                                    volk_32f_index_max_16u(&indext, d_magnitudeIB, d_fft_size);
-                                    magt = d_magnitudeIB[indext] / (fft_normalization_factor * fft_normalization_factor);
-                                }
-                        }
-                    else
-                        {
-                            // if (d_CAF_filter) {d_CAF_vector_I[doppler_index] = magt_IA;}
-                            if (d_CAF_window_hz > 0) {d_CAF_vector_I[doppler_index] = d_magnitudeIA[indext_IA];}
-                            if (d_both_signal_components)
-                                {
-                                    // if (d_CAF_filter) {d_CAF_vector_Q[doppler_index] = magt_QA;}
-                                    if (d_CAF_window_hz > 0) {d_CAF_vector_Q[doppler_index] = d_magnitudeQA[indext_QA];}
-                                    // NON-Coherent integration of only 1 code
-                                    for (unsigned int i=0; i<d_fft_size; i++)
-                                        {
-                                            d_magnitudeIA[i] += d_magnitudeQA[i];
-                                        }
-                                }
-                            volk_32f_index_max_16u(&indext, d_magnitudeIA, d_fft_size);
-                            magt = d_magnitudeIA[indext] / (fft_normalization_factor * fft_normalization_factor);
-                        }
+                    magt = line.mag / (fft_normalization_factor * fft_normalization_factor);
 
                     // 4- record the maximum peak and the associated synchronization parameters
                     if (d_mag < magt)
@@ -615,7 +506,7 @@ int galileo_e5a_noncoherentIQ_acquisition_caf_cc::general_work(int noutput_items
                             // restarted between consecutive dwells in multidwell operation.
                             if (d_test_statistics < (d_mag / d_input_power) || !d_bit_transition_flag)
                                 {
-                                    d_gnss_synchro->Acq_delay_samples = static_cast<double>(indext % d_samples_per_code);
+                                    d_gnss_synchro->Acq_delay_samples = static_cast<double>(line.index % d_samples_per_code);
                                     d_gnss_synchro->Acq_doppler_hz = static_cast<double>(doppler);
                                     d_gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
 
@@ -623,121 +514,41 @@ int galileo_e5a_noncoherentIQ_acquisition_caf_cc::general_work(int noutput_items
                                     d_test_statistics = d_mag / d_input_power;
                                 }
                         }
-
-                    // Record results to file if required
-                    if (d_dump)
-                        {
-                            std::stringstream filename;
-                            std::streamsize n = sizeof(float) * (d_fft_size); // noncomplex file write
-                            filename.str("");
-                            filename << "../data/test_statistics_E5a_sat_"
-                                    << d_gnss_synchro->PRN << "_doppler_" <<  doppler << ".dat";
-                            d_dump_file.open(filename.str().c_str(), std::ios::out | std::ios::binary);
-                            if (d_sampled_ms > 1) // If integration time > 1 code
-                                {
-                                    if (magt_IA >= magt_IB)
-                                        {
-                                            d_dump_file.write((char*)d_magnitudeIA, n);
-                                        }
-                                    else
-                                        {
-                                            d_dump_file.write((char*)d_magnitudeIB, n);
-                                        }
-                                }
-                            else
-                                {
-                                    d_dump_file.write((char*)d_magnitudeIA, n);
-                                }
-                            d_dump_file.close();
-                        }
                 }
-            // std::cout << "d_mag " << d_mag << ".d_sample_counter " << d_sample_counter << ". acq delay " << d_gnss_synchro->Acq_delay_samples<< " indext "<< indext << std::endl;
+
             // 6 OPTIONAL: CAF filter to avoid Doppler ambiguity in bit transition.
+            // Only its maximum is needed, the filtered vector is built to be dumped
             if (d_CAF_window_hz > 0)
                 {
-                    int CAF_bins_half;
-                    float* accum = static_cast<float*>(volk_malloc(sizeof(float), volk_get_alignment()));
-                    CAF_bins_half = d_CAF_window_hz / (2 * d_doppler_step);
-                    float weighting_factor;
-                    weighting_factor = 0.5 / static_cast<float>(CAF_bins_half);
-                    // weighting_factor = 0;
-                    // std::cout << "weighting_factor " << weighting_factor << std::endl;
-                    // Initialize first iterations
-                    for (int doppler_index = 0; doppler_index < CAF_bins_half; doppler_index++)
+                    int CAF_bins_half = d_CAF_window_hz / (2 * d_doppler_step);
+                    float weighting_factor = CAF_bins_half > 0 ? 0.5 / static_cast<float>(CAF_bins_half) : 0.0;
+                    std::vector<float> CAF_vector;
+                    if (d_dump)
                         {
-                            d_CAF_vector[doppler_index] = 0;
-                            // volk_32f_accumulator_s32f_a(&d_CAF_vector[doppler_index], d_CAF_vector_I, CAF_bins_half+doppler_index+1);
-                            for (int i = 0; i < CAF_bins_half + doppler_index + 1; i++)
-                                {
-                                    d_CAF_vector[doppler_index] += d_CAF_vector_I[i] * (1 - weighting_factor * static_cast<unsigned int>((doppler_index - i)));
-                                }
-                            // d_CAF_vector[doppler_index] /= CAF_bins_half+doppler_index+1;
-                            d_CAF_vector[doppler_index] /= 1 + CAF_bins_half + doppler_index - weighting_factor * CAF_bins_half * (CAF_bins_half + 1) / 2 - weighting_factor * doppler_index * (doppler_index + 1) / 2; // triangles = [n*(n+1)/2]
-                            if (d_both_signal_components)
-                                {
-                                    accum[0] = 0;
-                                    // volk_32f_accumulator_s32f_a(&accum[0], d_CAF_vector_Q, CAF_bins_half+doppler_index+1);
-                                    for (int i = 0; i < CAF_bins_half + doppler_index + 1; i++)
-                                        {
-                                            accum[0] += d_CAF_vector_Q[i] * (1 - weighting_factor * static_cast<unsigned int>(abs(doppler_index - i)));
-                                        }
-                                    // accum[0] /= CAF_bins_half+doppler_index+1;
-                                    accum[0] /= 1 + CAF_bins_half + doppler_index - weighting_factor * CAF_bins_half * (CAF_bins_half + 1) / 2 - weighting_factor * doppler_index * (doppler_index + 1) / 2; // triangles = [n*(n+1)/2]
-                                    d_CAF_vector[doppler_index] += accum[0];
-                                }
+                            CAF_vector.resize(d_num_doppler_bins);
                         }
-                    // Body loop
-                    for (unsigned int doppler_index = CAF_bins_half; doppler_index < d_num_doppler_bins - CAF_bins_half; doppler_index++)
+                    unsigned int CAF_index = 0;
+                    float CAF_max = -1.0;
+                    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
                         {
-                            d_CAF_vector[doppler_index] = 0;
-                            // volk_32f_accumulator_s32f_a(&d_CAF_vector[doppler_index], &d_CAF_vector_I[doppler_index-CAF_bins_half], 2*CAF_bins_half+1);
-                            for (int i = doppler_index - CAF_bins_half; i < static_cast<int>(doppler_index + CAF_bins_half + 1); i++)
-                                {
-                                    d_CAF_vector[doppler_index] += d_CAF_vector_I[i] * (1 - weighting_factor * static_cast<unsigned int>((doppler_index - i)));
-                                }
-                            // d_CAF_vector[doppler_index] /= 2*CAF_bins_half+1;
-                            d_CAF_vector[doppler_index] /= 1 + 2 * CAF_bins_half - 2 * weighting_factor * CAF_bins_half * (CAF_bins_half + 1) / 2;
+                            float CAF = caf_average(d_doppler_lines, false, doppler_index, CAF_bins_half, weighting_factor);
                             if (d_both_signal_components)
                                 {
-                                    accum[0] = 0;
-                                    // volk_32f_accumulator_s32f_a(&accum[0], &d_CAF_vector_Q[doppler_index-CAF_bins_half], 2*CAF_bins_half);
-                                    for (int i = doppler_index-CAF_bins_half; i < static_cast<int>(doppler_index + CAF_bins_half + 1); i++)
-                                        {
-                                            accum[0] += d_CAF_vector_Q[i] * (1 - weighting_factor * static_cast<unsigned int>((doppler_index - i)));
-                                        }
-                                    // accum[0] /= 2*CAF_bins_half+1;
-                                    accum[0] /= 1 + 2 * CAF_bins_half - 2 * weighting_factor * CAF_bins_half * (CAF_bins_half + 1) / 2;
-                                    d_CAF_vector[doppler_index] += accum[0];
+                                    CAF += caf_average(d_doppler_lines, true, doppler_index, CAF_bins_half, weighting_factor);
                                 }
-                        }
-                    // Final iterations
-                    for (int doppler_index = d_num_doppler_bins - CAF_bins_half; doppler_index < static_cast<int>(d_num_doppler_bins); doppler_index++)
-                        {
-                            d_CAF_vector[doppler_index] = 0;
-                            // volk_32f_accumulator_s32f_a(&d_CAF_vector[doppler_index], &d_CAF_vector_I[doppler_index-CAF_bins_half], CAF_bins_half + (d_num_doppler_bins-doppler_index));
-                            for (int i = doppler_index - CAF_bins_half; i < static_cast<int>(d_num_doppler_bins); i++)
+                            if (d_dump)
                                 {
-                                    d_CAF_vector[doppler_index] += d_CAF_vector_I[i] * (1 - weighting_factor * (abs(doppler_index - i)));
+                                    CAF_vector[doppler_index] = CAF;
                                 }
-                            // d_CAF_vector[doppler_index] /= CAF_bins_half+(d_num_doppler_bins-doppler_index);
-                            d_CAF_vector[doppler_index] /= 1 + CAF_bins_half + (d_num_doppler_bins - doppler_index - 1) - weighting_factor * CAF_bins_half * (CAF_bins_half + 1) / 2 - weighting_factor * (d_num_doppler_bins - doppler_index - 1) * (d_num_doppler_bins - doppler_index) / 2;
-                            if (d_both_signal_components)
+                            if (CAF > CAF_max)
                                 {
-                                    accum[0] = 0;
-                                    // volk_32f_accumulator_s32f_a(&accum[0], &d_CAF_vector_Q[doppler_index-CAF_bins_half], CAF_bins_half + (d_num_doppler_bins-doppler_index));
-                                    for (int i = doppler_index-CAF_bins_half; i < static_cast<int>(d_num_doppler_bins); i++)
-                                        {
-                                            accum[0] += d_CAF_vector_Q[i] * (1 - weighting_factor * (abs(doppler_index - i)));
-                                        }
-                                    // accum[0] /= CAF_bins_half+(d_num_doppler_bins-doppler_index);
-                                    accum[0] /= 1 + CAF_bins_half + (d_num_doppler_bins - doppler_index - 1) - weighting_factor * CAF_bins_half * (CAF_bins_half + 1) / 2 - weighting_factor * (d_num_doppler_bins - doppler_index - 1) * (d_num_doppler_bins - doppler_index) / 2;
-                                    d_CAF_vector[doppler_index] += accum[0];
+                                    CAF_max = CAF;
+                                    CAF_index = doppler_index;
                                 }
                         }
 
                     // Recompute the maximum doppler peak
-                    volk_32f_index_max_16u(&indext, d_CAF_vector, d_num_doppler_bins);
-                    doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * indext;
+                    doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * CAF_index;
                     d_gnss_synchro->Acq_doppler_hz = static_cast<double>(doppler);
                     // Dump if required, appended at the end of the file
                     if (d_dump)
@@ -747,10 +558,9 @@ int galileo_e5a_noncoherentIQ_acquisition_caf_cc::general_work(int noutput_items
                             filename.str("");
                             filename << "../data/test_statistics_E5a_sat_" << d_gnss_synchro->PRN << "_CAF.dat";
                             d_dump_file.open(filename.str().c_str(), std::ios::out | std::ios::binary);
-                            d_dump_file.write((char*)d_CAF_vector, n);
+                            d_dump_file.write((char*)&CAF_vector[0], n);
                             d_dump_file.close();
                         }
-                    volk_free(accum);
                 }
 
             if (d_well_count == d_max_dwells)
@@ -789,8 +599,7 @@ int galileo_e5a_noncoherentIQ_acquisition_caf_cc::general_work(int noutput_items
             d_active = false;
             d_state = 0;
 
-            acquisition_message = 1;
-            this->message_port_pub(pmt::mp("events"), pmt::from_long(acquisition_message));
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_POSITIVE_ACQUISITION));
             d_sample_counter += ninput_items[0]; // sample counter
             consume_each(ninput_items[0]);
             break;
@@ -813,8 +622,7 @@ int galileo_e5a_noncoherentIQ_acquisition_caf_cc::general_work(int noutput_items
 
             d_sample_counter += ninput_items[0]; // sample counter
             consume_each(ninput_items[0]);
-            acquisition_message = 2;
-            this->message_port_pub(pmt::mp("events"), pmt::from_long(acquisition_message));
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_NEGATIVE_ACQUISITION));
             break;
         }
     }
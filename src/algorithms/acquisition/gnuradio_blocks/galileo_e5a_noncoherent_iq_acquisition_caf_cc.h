@@ -39,14 +39,29 @@
 #define GALILEO_E5A_NONCOHERENT_IQ_ACQUISITION_CAF_CC_H_
 
 #include <fstream>
+#include <memory>
 #include <string>
+#include <vector>
 #include <gnuradio/block.h>
 #include <gnuradio/gr_complex.h>
 #include <gnuradio/fft/fft.h>
 #include "gnss_synchro.h"
+#include "acquisition_cache.h"
+#include "acquisition_thread_pool.h"
 
 class galileo_e5a_noncoherentIQ_acquisition_caf_cc;
 
+/*!
+ * \brief Maxima of the E5a search grid along one Doppler line.
+ */
+struct Galileo_E5a_Doppler_Line
+{
+    float mag;          //!< Squared magnitude of the maximum, both components integrated noncoherently
+    unsigned int index; //!< Index of the maximum in the line
+    float peak_I;       //!< Maximum of the data component alone, for the CAF filter
+    float peak_Q;       //!< Maximum of the pilot component alone, for the CAF filter
+};
+
 typedef boost::shared_ptr<galileo_e5a_noncoherentIQ_acquisition_caf_cc> galileo_e5a_noncoherentIQ_acquisition_caf_cc_sptr;
 
 galileo_e5a_noncoherentIQ_acquisition_caf_cc_sptr
@@ -98,6 +113,7 @@ private:
     void calculate_magnitudes(gr_complex* fft_begin, int doppler_shift,
             int doppler_offset);
     float estimate_input_power(gr_complex *in );
+    void search_doppler_line(unsigned int doppler_index, Acquisition_Scratch& scratch);
 
     long d_fs_in;
     long d_freq;
@@ -113,7 +129,9 @@ private:
     unsigned int d_well_count;
     unsigned int d_fft_size;
     unsigned long int d_sample_counter;
-    gr_complex** d_grid_doppler_wipeoffs;
+    std::shared_ptr<const Doppler_Wipeoff_Grid> d_doppler_grid;
+    std::shared_ptr<const Input_Fft_Batch> d_input_ffts; // of the dwell being searched
+    std::vector<Galileo_E5a_Doppler_Line> d_doppler_lines;
     unsigned int d_num_doppler_bins;
     gr_complex* d_fft_code_I_A;
     gr_complex* d_fft_code_I_B;
@@ -121,15 +139,10 @@ private:
     gr_complex* d_fft_code_Q_B;
     gr_complex* d_inbuffer;
     gr::fft::fft_complex* d_fft_if;
-    gr::fft::fft_complex* d_ifft;
     Gnss_Synchro *d_gnss_synchro;
     unsigned int d_code_phase;
     float d_doppler_freq;
     float d_mag;
-    float* d_magnitudeIA;
-    float* d_magnitudeIB;
-    float* d_magnitudeQA;
-    float* d_magnitudeQB;
     float d_input_power;
     float d_test_statistics;
     bool d_bit_transition_flag;
@@ -140,12 +153,6 @@ private:
     bool d_both_signal_components;
 //    bool d_CAF_filter;
     int d_CAF_window_hz;
-    float* d_CAF_vector;
-    float* d_CAF_vector_I;
-    float* d_CAF_vector_Q;
-//    double* d_CAF_vector;
-//    double* d_CAF_vector_I;
-//    double* d_CAF_vector_Q;
     unsigned int d_channel;
     std::string d_dump_filename;
     unsigned int d_peak;
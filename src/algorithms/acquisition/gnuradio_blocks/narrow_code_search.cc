@@ -0,0 +1,142 @@
+/*!
+ * \file narrow_code_search.cc
+ * \brief Implementation of the FFT-free code phase search of a few lags,
+ * for the narrow searches of the PCPS acquisition blocks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "narrow_code_search.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <volk/volk.h>
+#include <volk_gnsssdr/volk_gnsssdr.h>
+#include "GPS_L1_CA.h" //GPS_TWO_PI
+
+namespace
+{
+// RMS of the scaled input
+const float scaled_rms = 128.0;
+
+// largest component of the scaled code
+const float scaled_code_max = 64.0;
+}
+
+
+Narrow_Code_Search::Narrow_Code_Search(long fs_in, unsigned int length) :
+        d_fs_in(fs_in),
+        d_length(length),
+        d_input_scale(1.0),
+        d_code_scale(1.0),
+        d_code_power(0.0),
+        d_line_power(0.0)
+{
+    d_input = static_cast<lv_16sc_t*>(volk_malloc(length * sizeof(lv_16sc_t), volk_get_alignment()));
+    d_code = static_cast<lv_16sc_t*>(volk_malloc(length * sizeof(lv_16sc_t), volk_get_alignment()));
+    d_scaled = static_cast<gr_complex*>(volk_malloc(length * sizeof(gr_complex), volk_get_alignment()));
+}
+
+
+Narrow_Code_Search::~Narrow_Code_Search()
+{
+    volk_free(d_input);
+    volk_free(d_code);
+    volk_free(d_scaled);
+}
+
+
+bool Narrow_Code_Search::cheaper_than_fft(unsigned int num_lags, unsigned int length)
+{
+    // The two FFTs of a Doppler bin cost about 10 length log2(length) operations,
+    // each lag 8 length operations on 16 bits lanes, twice as many per instruction as floats
+    return num_lags > 0 && static_cast<double>(num_lags) <= 2.5 * std::log2(static_cast<double>(length));
+}
+
+
+void Narrow_Code_Search::set_local_code(const gr_complex* code)
+{
+    // the FFT-based search correlates with the conjugated code
+    volk_32fc_conjugate_32fc(d_scaled, code, d_length);
+    float max_component = 0.0;
+    d_code_power = 0.0;
+    for (unsigned int i = 0; i < d_length; i++)
+        {
+            max_component = std::max(max_component, std::max(std::abs(d_scaled[i].real()), std::abs(d_scaled[i].imag())));
+            d_code_power += std::norm(d_scaled[i]);
+        }
+    d_code_power /= static_cast<float>(d_length);
+    d_code_scale = (max_component > 0.0 ? scaled_code_max / max_component : 1.0);
+    volk_32f_s32f_multiply_32f(reinterpret_cast<float*>(d_scaled), reinterpret_cast<const float*>(d_scaled), d_code_scale, 2 * d_length);
+    volk_gnsssdr_32fc_convert_16ic(d_code, d_scaled, d_length);
+}
+
+
+void Narrow_Code_Search::set_input(const gr_complex* in)
+{
+    float power = 0.0;
+    for (unsigned int i = 0; i < d_length; i++)
+        {
+            power += std::norm(in[i]);
+        }
+    power /= static_cast<float>(d_length);
+    d_input_scale = (power > 0.0 ? scaled_rms / std::sqrt(power) : 1.0);
+    volk_32f_s32f_multiply_32f(reinterpret_cast<float*>(d_scaled), reinterpret_cast<const float*>(in), d_input_scale, 2 * d_length);
+    volk_gnsssdr_32fc_convert_16ic(d_input, d_scaled, d_length);
+
+    float length = static_cast<float>(d_length);
+    d_line_power = length * length * length * length * power * d_code_power;
+}
+
+
+void Narrow_Code_Search::search(double carrier_hz, unsigned int first_lag, unsigned int num_lags, float* magnitude) const
+{
+    num_lags = std::min(num_lags, d_length);
+    first_lag = first_lag % d_length;
+    // the lags past the end of the input wrap around, as in the circular FFT-based correlation
+    unsigned int rotated_length = d_length + first_lag + num_lags - 1;
+    lv_16sc_t* rotated = static_cast<lv_16sc_t*>(volk_malloc(rotated_length * sizeof(lv_16sc_t), volk_get_alignment()));
+    lv_32fc_t* correlations = static_cast<lv_32fc_t*>(volk_malloc(num_lags * sizeof(lv_32fc_t), volk_get_alignment()));
+
+    // same sign and initial phase as the Doppler wipeoffs of the FFT-based search
+    float phase_step_rad = - static_cast<float>(GPS_TWO_PI * carrier_hz / static_cast<double>(d_fs_in));
+    lv_32fc_t phase_inc = lv_cmake(std::cos(phase_step_rad), std::sin(phase_step_rad));
+    lv_32fc_t phase = lv_cmake(1.0f, 0.0f);
+    volk_gnsssdr_16ic_s32fc_x2_rotator_16ic(rotated, d_input, phase_inc, &phase, d_length);
+    memcpy(rotated + d_length, rotated, (rotated_length - d_length) * sizeof(lv_16sc_t));
+
+    volk_gnsssdr_16ic_x2_sliding_dot_prod_32fc(correlations, rotated + first_lag, d_code, num_lags, d_length);
+
+    // back to the units of the input and code, times length as the unnormalized inverse FFT
+    float scale = static_cast<float>(d_length) / (d_input_scale * d_code_scale);
+    for (unsigned int k = 0; k < num_lags; k++)
+        {
+            magnitude[(first_lag + k) % d_length] = std::norm(correlations[k]) * scale * scale;
+        }
+    volk_free(correlations);
+    volk_free(rotated);
+}
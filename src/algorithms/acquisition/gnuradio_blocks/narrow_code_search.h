@@ -0,0 +1,101 @@
+/*!
+ * \file narrow_code_search.h
+ * \brief Interface of the FFT-free code phase search of a few lags,
+ * for the narrow searches of the PCPS acquisition blocks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_NARROW_CODE_SEARCH_H_
+#define GNSS_SDR_NARROW_CODE_SEARCH_H_
+
+#include <gnuradio/gr_complex.h>
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+
+/*!
+ * \brief Code phase search of a Doppler bin restricted to a few lags.
+ *
+ * When only a window of code phases around a known one has to be searched
+ * (a reacquisition or an assisted acquisition), correlating them directly
+ * with volk_gnsssdr_16ic_x2_sliding_dot_prod_32fc is cheaper than the
+ * FFT-based correlation of the whole code, which computes all of them.
+ *
+ * The input and the local code are converted once to 16-bit integers, the
+ * input scaled to an RMS of 2^7 and the code to a largest component of
+ * 2^6, which leaves room in the 32-bit accumulators for a few coherent
+ * code periods. The correlation is circular, as the FFT-based one, and the
+ * magnitudes are returned in its units (|IFFT|^2, without the 1/length
+ * normalization), so that the thresholds of the blocks apply unchanged.
+ */
+class Narrow_Code_Search
+{
+public:
+    Narrow_Code_Search(long fs_in, unsigned int length);
+    ~Narrow_Code_Search();
+
+    /*!
+     * \brief Returns true if searching num_lags lags this way is cheaper than the FFTs
+     */
+    static bool cheaper_than_fft(unsigned int num_lags, unsigned int length);
+
+    void set_local_code(const gr_complex* code); //!< length samples
+
+    /*!
+     * \brief Scales length samples of in for the searches of this dwell
+     */
+    void set_input(const gr_complex* in);
+
+    /*!
+     * \brief Writes the squared magnitudes of the lags first_lag to first_lag + num_lags - 1
+     * (modulo length) of the input wiped off with a carrier of carrier_hz to magnitude
+     * (length samples, the other ones are not written). Thread-safe.
+     */
+    void search(double carrier_hz, unsigned int first_lag, unsigned int num_lags, float* magnitude) const;
+
+    /*!
+     * \brief Sum of the squared magnitudes of all the lags, estimated from the input and code powers
+     *
+     * By Parseval, for a code with a flat spectrum; it stands for the noise
+     * floor the few lags searched cannot estimate.
+     */
+    float line_power() const { return d_line_power; }
+
+private:
+    Narrow_Code_Search(const Narrow_Code_Search&);
+    Narrow_Code_Search& operator=(const Narrow_Code_Search&);
+
+    long d_fs_in;
+    unsigned int d_length;
+    lv_16sc_t* d_input;
+    lv_16sc_t* d_code;
+    gr_complex* d_scaled;
+    float d_input_scale;
+    float d_code_scale;
+    float d_code_power;
+    float d_line_power;
+};
+
+#endif
@@ -0,0 +1,108 @@
+/*!
+ * \file opencl_environment.cc
+ * \brief OpenCL device, context and command queues shared by all the
+ * OpenCL acquisition channels
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "opencl_environment.h"
+#include <iostream>
+#include <boost/thread/mutex.hpp>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+namespace
+{
+boost::mutex num_queues_mutex;
+unsigned int environment_num_queues = 4;
+}
+
+
+Opencl_Environment& Opencl_Environment::instance()
+{
+    static Opencl_Environment environment(environment_num_queues);
+    return environment;
+}
+
+
+void Opencl_Environment::set_num_queues(unsigned int num_queues)
+{
+    boost::mutex::scoped_lock lock(num_queues_mutex);
+    environment_num_queues = num_queues > 0 ? num_queues : 1;
+}
+
+
+const cl::CommandQueue& Opencl_Environment::queue()
+{
+    return d_queues[d_next_queue.fetch_add(1, std::memory_order_relaxed) % d_queues.size()];
+}
+
+
+Opencl_Environment::Opencl_Environment(unsigned int num_queues) :
+        d_status(0),
+        d_next_queue(0)
+{
+    //get all platforms (drivers)
+    std::vector<cl::Platform> all_platforms;
+    cl::Platform::get(&all_platforms);
+
+    if (all_platforms.size() == 0)
+        {
+            std::cout << "No OpenCL platforms found. Check OpenCL installation!" << std::endl;
+            d_status = 1;
+            return;
+        }
+
+    d_platform = all_platforms[0]; //get default platform
+    std::cout << "Using platform: " << d_platform.getInfo<CL_PLATFORM_NAME>() << std::endl;
+
+    //get default GPU device of the default platform
+    std::vector<cl::Device> gpu_devices;
+    d_platform.getDevices(CL_DEVICE_TYPE_GPU, &gpu_devices);
+
+    if (gpu_devices.size() == 0)
+        {
+            std::cout << "No GPU devices found. Check OpenCL installation!" << std::endl;
+            d_status = 2;
+            return;
+        }
+
+    d_device = gpu_devices[0];
+    std::cout << "Using device: " << d_device.getInfo<CL_DEVICE_NAME>() << std::endl;
+
+    std::vector<cl::Device> device;
+    device.push_back(d_device);
+    d_context = cl::Context(device);
+
+    for (unsigned int i = 0; i < num_queues; i++)
+        {
+            d_queues.push_back(cl::CommandQueue(d_context, d_device));
+        }
+    LOG(INFO) << "OpenCL context with " << num_queues << " command queues on " << d_device.getInfo<CL_DEVICE_NAME>();
+}
@@ -0,0 +1,98 @@
+/*!
+ * \file opencl_environment.h
+ * \brief OpenCL device, context and command queues shared by all the
+ * OpenCL acquisition channels
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_OPENCL_ENVIRONMENT_H_
+#define GNSS_SDR_OPENCL_ENVIRONMENT_H_
+
+#include <atomic>
+#include <vector>
+
+#ifdef __APPLE__
+   #include "cl.hpp"
+#else
+    #include <CL/cl.hpp>
+#endif
+
+/*!
+ * \brief The OpenCL context of the receiver, on the first GPU of the first
+ * platform.
+ *
+ * Each pcps_opencl_acquisition_cc used to create a context of its own, so
+ * the channels could not share their programs and the driver had one more
+ * context to schedule per channel. All of them now take this context and
+ * one of its command queues, round-robin, so that the searches of several
+ * channels are submitted to the device concurrently instead of behind each
+ * other in a single queue.
+ *
+ * The number of queues is set once, with set_num_queues(), before the first
+ * use (GNSS-SDR.opencl_queues, see GpsL1CaPcpsOpenClAcquisition).
+ */
+class Opencl_Environment
+{
+public:
+    static Opencl_Environment& instance();
+
+    /*!
+     * \brief Sets the number of command queues. No effect once the environment is created.
+     */
+    static void set_num_queues(unsigned int num_queues);
+
+    /*!
+     * \brief 0 if the context was created, 1 if there is no OpenCL
+     * platform, 2 if the platform has no GPU
+     */
+    int status() const { return d_status; }
+
+    const cl::Platform& platform() const { return d_platform; }
+    const cl::Device& device() const { return d_device; }
+    const cl::Context& context() const { return d_context; }
+
+    /*!
+     * \brief The next command queue, round-robin. Commands can be enqueued
+     * from any thread.
+     */
+    const cl::CommandQueue& queue();
+
+private:
+    Opencl_Environment(unsigned int num_queues);
+    Opencl_Environment(const Opencl_Environment&);
+    Opencl_Environment& operator=(const Opencl_Environment&);
+
+    int d_status;
+    cl::Platform d_platform;
+    cl::Device d_device;
+    cl::Context d_context;
+    std::vector<cl::CommandQueue> d_queues;
+    std::atomic<unsigned int> d_next_queue;
+};
+
+#endif
@@ -33,14 +33,19 @@
  */
 
 #include "pcps_acquisition_cc.h"
-#include <sstream>
-#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <cmath>
+#include <boost/bind.hpp>
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
 #include <volk/volk.h>
 #include <volk_gnsssdr/volk_gnsssdr.h>
 #include "control_message_factory.h"
-#include "GPS_L1_CA.h" //GPS_TWO_PI
+#include "fft_plan_cache.h"
+#include "GPS_L1_CA.h" //GPS_TWO_PI, GPS_L1_FREQ_HZ
+#include "channel_event.h"
+#include "trace_log.h"
+#include "latency_trace.h"
 
 
 using google::LogMessage;
@@ -89,6 +94,34 @@ pcps_acquisition_cc::pcps_acquisition_cc(
     d_num_doppler_bins = 0;
     d_bit_transition_flag = bit_transition_flag;
     d_use_CFAR_algorithm_flag = use_CFAR_algorithm_flag;
+    d_frequency_domain_doppler = false;
+    d_pooled_engine = false;
+    d_reacquisition = false;
+    d_reacquisition_doppler_window_hz = 0;
+    d_reacquisition_code_window_samples = 0;
+    d_reacquisition_max_age_ms = 0;
+    d_reacquisition_tried = false;
+    d_narrow_search = false;
+    d_search_window = 0;
+    d_first_doppler_index = 0;
+    d_expected_doppler_hz = 0.0;
+    d_early_termination = false;
+    d_confirmation_factor = 2.0;
+    d_early_termination_lines = 0;
+    d_ordered_search = false;
+    d_early_termination_failed = false;
+    d_batch_first_line = 0;
+    d_verification_pending = false;
+    d_verifying = false;
+    d_verification_hint.doppler_hz = 0.0;
+    d_verification_hint.code_start = 0;
+    d_non_coherent_integration = false;
+    d_noncoherent_surface = 0;
+    d_noncoherent_dwells = 0;
+    d_accumulating = false;
+    d_hint_carrier_freq_hz = GPS_L1_FREQ_HZ;
+    d_code_ambiguity_samples = 0;
+    d_input = 0;
     d_threshold = 0.0;
     d_doppler_step = 0;
     d_code_phase = 0;
@@ -114,45 +147,75 @@ pcps_acquisition_cc::pcps_acquisition_cc(
             d_max_dwells = 1; //Activation of d_bit_transition_flag invalidates the value of d_max_dwells
         }
 
-    d_fft_codes = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
-    d_magnitude = static_cast<float*>(volk_malloc(d_fft_size * sizeof(float), volk_get_alignment()));
+    // Direct FFT, Doppler grid and buffers of the search, attached by the first search
+    d_magnitude = 0;
+    d_fft_if = 0;
 
-    // Direct FFT
-    d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
-
-    // Inverse FFT
-    d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+    // The inverse FFTs run on the plans of the acquisition thread pool
 
     // For dumping samples into a file
     d_dump = dump;
     d_dump_filename = dump_filename;
+    if (d_dump)
+        {
+            d_grid_dump.reset(new Acquisition_Grid_Dump(d_dump_filename));
+        }
 
     d_gnss_synchro = 0;
-    d_grid_doppler_wipeoffs = 0;
+    d_fft_codes = 0;
 }
 
 
 pcps_acquisition_cc::~pcps_acquisition_cc()
 {
-    if (d_num_doppler_bins > 0)
+    detach_engine();
+}
+
+
+void pcps_acquisition_cc::attach_engine()
+{
+    if (!d_frequency_domain_doppler && !d_doppler_grid && d_num_doppler_bins > 0)
         {
-            for (unsigned int i = 0; i < d_num_doppler_bins; i++)
-                {
-                    volk_free(d_grid_doppler_wipeoffs[i]);
-                }
-            delete[] d_grid_doppler_wipeoffs;
+            // Create the carrier Doppler wipeoff signals
+            d_doppler_grid = Acquisition_Cache::doppler_wipeoff_grid(d_fs_in, d_freq, d_doppler_max, d_doppler_step, d_num_doppler_bins, d_fft_size);
         }
+    if (!d_fft_if)
+        {
+            d_fft_if = Fft_Plan_Cache::acquire(d_fft_size, true);
+        }
+    if (!d_magnitude)
+        {
+            d_magnitude = static_cast<float*>(volk_malloc(d_fft_size * sizeof(float), volk_get_alignment()));
+        }
+    if (d_non_coherent_integration && d_max_dwells > 1 && !d_bit_transition_flag && !d_noncoherent_surface && d_num_doppler_bins > 0)
+        {
+            d_noncoherent_surface = static_cast<float*>(volk_malloc(d_num_doppler_bins * d_fft_size * sizeof(float), volk_get_alignment()));
+            d_noncoherent_dwells = 0;
+        }
+    if (d_frequency_domain_doppler && !d_fd_doppler && d_num_doppler_bins > 0)
+        {
+            d_fd_doppler.reset(new Frequency_Domain_Doppler(d_fs_in, d_freq, d_doppler_max, d_doppler_step, d_num_doppler_bins, d_fft_size));
+            DLOG(INFO) << "Frequency domain Doppler search, " << d_fd_doppler->num_input_ffts()
+                       << " input FFTs per dwell for " << d_num_doppler_bins << " Doppler bins";
+        }
+}
 
-    volk_free(d_fft_codes);
-    volk_free(d_magnitude);
-
-    delete d_ifft;
-    delete d_fft_if;
 
-    if (d_dump)
+void pcps_acquisition_cc::detach_engine()
+{
+    d_fd_doppler.reset();
+    if (d_magnitude)
         {
-            d_dump_file.close();
+            volk_free(d_magnitude);
+            d_magnitude = 0;
         }
+    if (d_noncoherent_surface)
+        {
+            volk_free(d_noncoherent_surface);
+            d_noncoherent_surface = 0;
+        }
+    Fft_Plan_Cache::release(d_fft_if);
+    d_fft_if = 0;
 }
 
 
@@ -162,28 +225,28 @@ void pcps_acquisition_cc::set_local_code(std::complex<float> * code)
     // Here we want to create a buffer that looks like this:
     // [ 0 0 0 ... 0 c_0 c_1 ... c_L]
     // where c_i is the local code and there are L zeros and L chips
+    // A pooled engine may be attached or detached by the block thread meanwhile
+    // Before the first search, the code takes a plan of the cache as well
+    bool cached_plan = d_pooled_engine || !d_fft_if;
+    gr::fft::fft_complex* fft_if = cached_plan ? Fft_Plan_Cache::acquire(d_fft_size, true) : d_fft_if;
     if( d_bit_transition_flag )
         {
             int offset = d_fft_size/2;
-            std::fill_n( d_fft_if->get_inbuf(), offset, gr_complex( 0.0, 0.0 ) );
-            memcpy(d_fft_if->get_inbuf() + offset, code, sizeof(gr_complex) * offset);
+            std::fill_n( fft_if->get_inbuf(), offset, gr_complex( 0.0, 0.0 ) );
+            memcpy(fft_if->get_inbuf() + offset, code, sizeof(gr_complex) * offset);
         } 
     else 
         {
-            memcpy(d_fft_if->get_inbuf(), code, sizeof(gr_complex) * d_fft_size);
+            memcpy(fft_if->get_inbuf(), code, sizeof(gr_complex) * d_fft_size);
         }
     
-    d_fft_if->execute(); // We need the FFT of local code
-    volk_32fc_conjugate_32fc(d_fft_codes, d_fft_if->get_outbuf(), d_fft_size);
-}
-
-
-void pcps_acquisition_cc::update_local_carrier(gr_complex* carrier_vector, int correlator_length_samples, float freq)
-{
-    float phase_step_rad = GPS_TWO_PI * freq / static_cast<float>(d_fs_in);
-    float _phase[1];
-    _phase[0] = 0;
-    volk_gnsssdr_s32f_sincos_32fc(carrier_vector, - phase_step_rad, _phase, correlator_length_samples);
+    // The FFT of the local code is shared with the channels searching for the same signal
+    d_code_fft = Acquisition_Cache::code_fft(d_gnss_synchro->System, d_gnss_synchro->Signal, d_gnss_synchro->PRN, fft_if);
+    d_fft_codes = d_code_fft->get();
+    if (cached_plan)
+        {
+            Fft_Plan_Cache::release(fft_if);
+        }
 }
 
 
@@ -203,14 +266,36 @@ void pcps_acquisition_cc::init()
 
     d_num_doppler_bins = ceil( static_cast<double>(static_cast<int>(d_doppler_max) - static_cast<int>(-d_doppler_max)) / static_cast<double>(d_doppler_step));
 
-    // Create the carrier Doppler wipeoff signals
-    d_grid_doppler_wipeoffs = new gr_complex*[d_num_doppler_bins];
+    d_fd_doppler.reset();
+    d_doppler_grid.reset();
+    // the engine (FFT plan, Doppler grid, search buffers) is attached by the first search,
+    // and a pooled one only while the acquisition is active
+    if (d_pooled_engine)
+        {
+            detach_engine();
+        }
+    else if (d_fft_if)
+        {
+            attach_engine(); // grid of the new Doppler settings
+        }
+
+    d_reacquisition_window.reset();
+    if (d_reacquisition && !d_bit_transition_flag)
+        {
+            d_reacquisition_window.reset(new Reacquisition_Window(d_fs_in, d_samples_per_code, d_hint_carrier_freq_hz,
+                    d_doppler_max, d_doppler_step, d_num_doppler_bins,
+                    d_reacquisition_doppler_window_hz, d_reacquisition_code_window_samples));
+            d_reacquisition_window->set_code_ambiguity(d_code_ambiguity_samples);
+        }
 
-    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
+    d_verification_window.reset();
+    if (d_early_termination && !d_bit_transition_flag)
         {
-            d_grid_doppler_wipeoffs[doppler_index] = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
-            int doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * doppler_index;
-            update_local_carrier(d_grid_doppler_wipeoffs[doppler_index], d_fft_size, d_freq + doppler);
+            // the peak is verified in the bins next to it, and about two chips of a C/A code around its code phase
+            d_verification_window.reset(new Reacquisition_Window(d_fs_in, d_samples_per_code, d_hint_carrier_freq_hz,
+                    d_doppler_max, d_doppler_step, d_num_doppler_bins,
+                    d_doppler_step, std::max(2, d_samples_per_code / 512)));
+            d_line_order.reserve(d_num_doppler_bins);
         }
 }
 
@@ -227,6 +312,11 @@ void pcps_acquisition_cc::set_state(int state)
             d_mag = 0.0;
             d_input_power = 0.0;
             d_test_statistics = 0.0;
+            d_reacquisition_tried = false;
+            d_noncoherent_dwells = 0;
+            d_expected_doppler_hz = 0.0;
+            d_early_termination_failed = false;
+            d_verification_pending = false;
         }
     else if (d_state == 0)
         {}
@@ -237,10 +327,190 @@ void pcps_acquisition_cc::set_state(int state)
 }
 
 
+void pcps_acquisition_cc::search_doppler_line(unsigned int line_index, Acquisition_Scratch& scratch)
+{
+#if VOLK_GT_122
+    uint16_t indext = 0;
+#else
+    unsigned int indext = 0;
+#endif
+    unsigned int doppler_index = line_doppler_index(line_index);
+    int effective_fft_size = ( d_bit_transition_flag ? d_fft_size/2 : d_fft_size );
+    gr::fft::fft_complex* ifft = scratch.ifft(d_fft_size);
+    float* magnitude = scratch.magnitude(d_fft_size);
+
+    // 3- Perform the FFT-based convolution  (parallel time search)
+    // Multiply carrier wiped--off, Fourier transformed incoming signal
+    // with the local FFT'd code reference using SIMD operations with VOLK library
+    if (d_fd_doppler)
+        {
+            d_fd_doppler->multiply_code(doppler_index, d_fft_codes, ifft->get_inbuf());
+        }
+    else if (d_narrow_search || d_ordered_search)
+        {
+            // only a few lines are searched, or the search may stop after a few: their input FFTs are not worth sharing
+            gr::fft::fft_complex* fft = scratch.fft(d_fft_size);
+            volk_32fc_x2_multiply_32fc(fft->get_inbuf(), d_input, d_doppler_grid->wipeoffs()[doppler_index], d_fft_size);
+            fft->execute();
+            volk_32fc_x2_multiply_32fc(ifft->get_inbuf(), fft->get_outbuf(), d_fft_codes, d_fft_size);
+        }
+    else
+        {
+            volk_32fc_x2_multiply_32fc(ifft->get_inbuf(), d_input_ffts->get(doppler_index), d_fft_codes, d_fft_size);
+        }
+
+    // compute the inverse FFT
+    ifft->execute();
+
+    // Search maximum
+    size_t offset = ( d_bit_transition_flag ? effective_fft_size : 0 );
+    Doppler_Line_Max& line = d_doppler_lines[line_index];
+    line.power = 0.0;
+    if (!d_accumulating && !d_narrow_search)
+        {
+            // the squared magnitude, its maximum and its sum in a single pass
+            float peaks[3];
+            unsigned int peak_index[2];
+            volk_gnsssdr_32fc_magnitude_squared_peaks_32f(magnitude, peaks, peak_index, ifft->get_outbuf() + offset,
+                    effective_fft_size, effective_fft_size);
+            line.index = peak_index[0];
+            line.mag = peaks[0];
+            if (d_use_CFAR_algorithm_flag == false)
+                {
+                    line.power = peaks[1];
+                }
+        }
+    else
+        {
+            volk_32fc_magnitude_squared_32f(magnitude, ifft->get_outbuf() + offset, effective_fft_size);
+            if (d_accumulating)
+                {
+                    // the line is searched on the mean of the dwells, at the scale of a single one
+                    float* surface = d_noncoherent_surface + doppler_index * d_fft_size;
+                    if (d_noncoherent_dwells == 0)
+                        {
+                            memcpy(surface, magnitude, effective_fft_size * sizeof(float));
+                        }
+                    else
+                        {
+                            volk_32f_x2_add_32f(surface, surface, magnitude, effective_fft_size);
+                            volk_32f_s32f_multiply_32f(magnitude, surface, 1.0 / static_cast<float>(d_noncoherent_dwells + 1), effective_fft_size);
+                        }
+                }
+            if (d_narrow_search)
+                {
+                    indext = d_search_window->index_max(magnitude, effective_fft_size);
+                }
+            else
+                {
+                    volk_32f_index_max_16u(&indext, magnitude, effective_fft_size);
+                }
+            line.index = indext;
+            line.mag = magnitude[indext];
+            if (d_use_CFAR_algorithm_flag == false)
+                {
+                    volk_32f_accumulator_s32f(&line.power, magnitude, effective_fft_size);
+                }
+        }
+
+    // Record results to file if required
+    if (d_grid_dump)
+        {
+            d_grid_dump->write_line(doppler_index, magnitude);
+        }
+}
+
+
+void pcps_acquisition_cc::search_batch_line(unsigned int batch_index, Acquisition_Scratch& scratch)
+{
+    search_doppler_line(d_batch_first_line + batch_index, scratch);
+}
+
+
+unsigned int pcps_acquisition_cc::line_doppler_index(unsigned int line_index) const
+{
+    return d_ordered_search ? d_line_order[line_index] : d_first_doppler_index + line_index;
+}
+
+
+void pcps_acquisition_cc::order_doppler_lines(unsigned int num_doppler_bins)
+{
+    // the bin of the expected Doppler first, then the bins on each side of it in turn
+    int last_bin = static_cast<int>(num_doppler_bins) - 1;
+    int center = static_cast<int>(std::floor((d_expected_doppler_hz + static_cast<double>(d_doppler_max)) / static_cast<double>(d_doppler_step) + 0.5));
+    center = std::max(0, std::min(last_bin, center));
+    d_line_order.clear();
+    d_line_order.push_back(center);
+    for (int offset = 1; d_line_order.size() < num_doppler_bins; offset++)
+        {
+            if (center + offset <= last_bin)
+                {
+                    d_line_order.push_back(center + offset);
+                }
+            if (center - offset >= 0)
+                {
+                    d_line_order.push_back(center - offset);
+                }
+        }
+}
+
+
+void pcps_acquisition_cc::evaluate_lines(unsigned int first_line, unsigned int end_line)
+{
+    int effective_fft_size = ( d_bit_transition_flag ? d_fft_size/2 : d_fft_size );
+    float fft_normalization_factor = static_cast<float>(d_fft_size) * static_cast<float>(d_fft_size);
+
+    for (unsigned int line_index = first_line; line_index < end_line; line_index++)
+        {
+            // doppler search steps
+            int doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * line_doppler_index(line_index);
+            const Doppler_Line_Max& line = d_doppler_lines[line_index];
+            float magt = line.mag;
+
+            if (d_use_CFAR_algorithm_flag == true)
+                {
+                    // Normalize the maximum value to correct the scale factor introduced by FFTW
+                    magt = line.mag / (fft_normalization_factor * fft_normalization_factor);
+                }
+            // 4- record the maximum peak and the associated synchronization parameters
+            if (d_mag < magt)
+                {
+                    d_mag = magt;
+
+                    if (d_use_CFAR_algorithm_flag == false)
+                        {
+                            // Search grid noise floor approximation for this doppler line
+                            d_input_power = (line.power - d_mag) / (effective_fft_size - 1);
+                        }
+
+                    // In case that d_bit_transition_flag = true, we compare the potentially
+                    // new maximum test statistics (d_mag/d_input_power) with the value in
+                    // d_test_statistics. When the second dwell is being processed, the value
+                    // of d_mag/d_input_power could be lower than d_test_statistics (i.e,
+                    // the maximum test statistics in the previous dwell is greater than
+                    // current d_mag/d_input_power). Note that d_test_statistics is not
+                    // restarted between consecutive dwells in multidwell operation.
+
+                    if (d_test_statistics < (d_mag / d_input_power) || !d_bit_transition_flag)
+                        {
+                            d_gnss_synchro->Acq_delay_samples = static_cast<double>(line.index % d_samples_per_code);
+                            d_gnss_synchro->Acq_doppler_hz = static_cast<double>(doppler);
+                            d_gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
+
+                            // 5- Compute the test statistics and compare to the threshold
+                            //d_test_statistics = 2 * d_fft_size * d_mag / d_input_power;
+                            d_test_statistics = d_mag / d_input_power;
+                        }
+                }
+        }
+}
+
+
 int pcps_acquisition_cc::general_work(int noutput_items,
         gr_vector_int &ninput_items, gr_vector_const_void_star &input_items,
         gr_vector_void_star &output_items __attribute__((unused)))
 {
+    Block_Metrics_Scope metrics_scope(d_metrics.get(), ninput_items[0]);
     /*
      * By J.Arribas, L.Esteve and M.Molina
      * Acquisition strategy (Kay Borre book + CFAR threshold):
@@ -252,14 +522,14 @@ int pcps_acquisition_cc::general_work(int noutput_items,
      * 6. Declare positive or negative acquisition using a message port
      */
 
-    int acquisition_message = -1; //0=STOP_CHANNEL 1=ACQ_SUCCEES 2=ACQ_FAIL
-
     switch (d_state)
     {
     case 0:
         {
             if (d_active)
                 {
+                    // the first search attaches the engine, and each one a pooled engine
+                    attach_engine();
                     //restart acquisition variables
                     d_gnss_synchro->Acq_delay_samples = 0.0;
                     d_gnss_synchro->Acq_doppler_hz = 0.0;
@@ -268,11 +538,21 @@ int pcps_acquisition_cc::general_work(int noutput_items,
                     d_mag = 0.0;
                     d_input_power = 0.0;
                     d_test_statistics = 0.0;
+                    d_reacquisition_tried = false;
+                    d_noncoherent_dwells = 0;
+                    d_expected_doppler_hz = 0.0;
+                    d_early_termination_failed = false;
+                    d_verification_pending = false;
 
                     d_state = 1;
                 }
+            else if (d_pooled_engine)
+                {
+                    detach_engine(); // stopped by the flowgraph during a search
+                }
 
             d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
+            metrics_scope.set_items(ninput_items[0]);
             consume_each(ninput_items[0]);
 
             //DLOG(INFO) << "Consumed " << ninput_items[0] << " items";
@@ -283,19 +563,8 @@ int pcps_acquisition_cc::general_work(int noutput_items,
     case 1:
         {
             // initialize acquisition algorithm
-            int doppler;
-#if VOLK_GT_122
-            uint16_t indext = 0;
-#else
-            unsigned int indext = 0;
-#endif
-            float magt = 0.0;
             const gr_complex *in = (const gr_complex *)input_items[0]; //Get the input samples pointer
 
-            int effective_fft_size = ( d_bit_transition_flag ? d_fft_size/2 : d_fft_size );
-
-            float fft_normalization_factor = static_cast<float>(d_fft_size) * static_cast<float>(d_fft_size);
-
             d_input_power = 0.0;
             d_mag = 0.0;
 
@@ -309,6 +578,42 @@ int pcps_acquisition_cc::general_work(int noutput_items,
                     << d_threshold << ", doppler_max: " << d_doppler_max
                     << ", doppler_step: " << d_doppler_step;
 
+            // Reacquisition: the first dwell only searches around where the satellite was last tracked,
+            // and the dwell after an early termination around the peak it found
+            unsigned long int block_start = d_sample_counter - d_fft_size;
+            d_narrow_search = false;
+            d_verifying = false;
+            if (d_verification_pending)
+                {
+                    d_verification_pending = false;
+                    d_search_window = d_verification_window.get();
+                    d_verifying = d_search_window->center(d_verification_hint, block_start);
+                    d_narrow_search = d_verifying;
+                }
+            else if (d_reacquisition_window && !d_reacquisition_tried && d_gnss_synchro->System == 'G')
+                {
+                    d_reacquisition_tried = true;
+                    d_search_window = d_reacquisition_window.get();
+                    Reacquisition_Hint hint;
+                    unsigned long int max_age = static_cast<unsigned long int>(d_reacquisition_max_age_ms) * static_cast<unsigned long int>(d_fs_in / 1000);
+                    if (d_reacquisition_hints.get(d_gnss_synchro->PRN, 0, block_start, max_age, hint))
+                        {
+                            // the hints come from the GPS L1 tracking
+                            hint.doppler_hz *= d_hint_carrier_freq_hz / GPS_L1_FREQ_HZ;
+                            d_expected_doppler_hz = hint.doppler_hz;
+                            d_narrow_search = d_search_window->center(hint, block_start);
+                        }
+                    if (d_narrow_search)
+                        {
+                            DLOG(INFO) << "Reacquisition of satellite " << d_gnss_synchro->PRN << " around doppler "
+                                       << hint.doppler_hz << ", code phase " << d_search_window->code_phase();
+                        }
+                }
+            d_first_doppler_index = d_narrow_search ? d_search_window->first_doppler_index() : 0;
+            unsigned int num_doppler_bins = d_narrow_search ? d_search_window->num_doppler_bins() : d_num_doppler_bins;
+            d_accumulating = d_noncoherent_surface && !d_narrow_search;
+            d_ordered_search = d_verification_window && !d_narrow_search && !d_early_termination_failed && !d_accumulating;
+
             if (d_use_CFAR_algorithm_flag == true)
                 {
                     // 1- (optional) Compute the input signal power estimation
@@ -317,91 +622,85 @@ int pcps_acquisition_cc::general_work(int noutput_items,
                     d_input_power /= static_cast<float>(d_fft_size);
                 }
             // 2- Doppler frequency search loop
-            for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
+            // The FFTs of the carrier wiped--off incoming signal do not depend on the PRN:
+            // they are computed once per dwell for all the channels acquiring on it
+            if (d_fd_doppler)
                 {
-                    // doppler search steps
-                    doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * doppler_index;
-
-                    volk_32fc_x2_multiply_32fc(d_fft_if->get_inbuf(), in,
-                            d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
-
-                    // 3- Perform the FFT-based convolution  (parallel time search)
-                    // Compute the FFT of the carrier wiped--off incoming signal
-                    d_fft_if->execute();
-
-                    // Multiply carrier wiped--off, Fourier transformed incoming signal
-                    // with the local FFT'd code reference using SIMD operations with VOLK library
-                    volk_32fc_x2_multiply_32fc(d_ifft->get_inbuf(),
-                            d_fft_if->get_outbuf(), d_fft_codes, d_fft_size);
-
-                    // compute the inverse FFT
-                    d_ifft->execute();
-
-                    // Search maximum
-                    size_t offset = ( d_bit_transition_flag ? effective_fft_size : 0 );
-                    volk_32fc_magnitude_squared_32f(d_magnitude, d_ifft->get_outbuf() + offset, effective_fft_size);
-                    volk_32f_index_max_16u(&indext, d_magnitude, effective_fft_size);
-                    magt = d_magnitude[indext];
-
-                    if (d_use_CFAR_algorithm_flag == true)
+                    d_fd_doppler->set_input(in, d_fft_if);
+                }
+            else if (d_narrow_search || d_ordered_search)
+                {
+                    d_input = in;
+                }
+            else
+                {
+                    d_input_ffts = Acquisition_Cache::input_fft_batch(d_doppler_grid, d_sample_counter, in, d_fft_if);
+                }
+            // The Doppler lines are searched in parallel by the acquisition thread pool
+            d_doppler_lines.resize(d_num_doppler_bins);
+            if (d_grid_dump)
+                {
+                    d_grid_dump->begin(*d_gnss_synchro, d_channel, d_sample_counter, d_fs_in, -static_cast<int>(d_doppler_max),
+                            d_doppler_step, d_num_doppler_bins, d_bit_transition_flag ? d_fft_size / 2 : d_fft_size);
+                }
+            unsigned int searched_lines = num_doppler_bins;
+            if (d_ordered_search)
+                {
+                    // from the expected Doppler outwards, a batch at a time, until a peak is strong enough
+                    order_doppler_lines(num_doppler_bins);
+                    unsigned int batch_lines = d_early_termination_lines > 0 ? d_early_termination_lines : Acquisition_Thread_Pool::instance().num_threads() + 1;
+                    float confirmation_threshold = d_confirmation_factor * d_threshold;
+                    d_test_statistics = 0.0;
+                    searched_lines = 0;
+                    while (searched_lines < num_doppler_bins && d_test_statistics <= confirmation_threshold)
                         {
-                            // Normalize the maximum value to correct the scale factor introduced by FFTW
-                            magt = d_magnitude[indext] / (fft_normalization_factor * fft_normalization_factor);
+                            d_batch_first_line = searched_lines;
+                            unsigned int lines = std::min(batch_lines, num_doppler_bins - searched_lines);
+                            Acquisition_Thread_Pool::instance().parallel_for(lines,
+                                    boost::bind(&pcps_acquisition_cc::search_batch_line, this, _1, _2));
+                            evaluate_lines(searched_lines, searched_lines + lines);
+                            searched_lines += lines;
                         }
-                    // 4- record the maximum peak and the associated synchronization parameters
-                    if (d_mag < magt)
-                        {
-                            d_mag = magt;
-
-                            if (d_use_CFAR_algorithm_flag == false)
-                                {
-                                    // Search grid noise floor approximation for this doppler line
-                                    volk_32f_accumulator_s32f(&d_input_power, d_magnitude, effective_fft_size);
-                                    d_input_power = (d_input_power - d_mag) / (effective_fft_size - 1);
-                                }
-
-                            // In case that d_bit_transition_flag = true, we compare the potentially
-                            // new maximum test statistics (d_mag/d_input_power) with the value in
-                            // d_test_statistics. When the second dwell is being processed, the value
-                            // of d_mag/d_input_power could be lower than d_test_statistics (i.e,
-                            // the maximum test statistics in the previous dwell is greater than
-                            // current d_mag/d_input_power). Note that d_test_statistics is not
-                            // restarted between consecutive dwells in multidwell operation.
-
-                            if (d_test_statistics < (d_mag / d_input_power) || !d_bit_transition_flag)
-                                {
-                                    d_gnss_synchro->Acq_delay_samples = static_cast<double>(indext % d_samples_per_code);
-                                    d_gnss_synchro->Acq_doppler_hz = static_cast<double>(doppler);
-                                    d_gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
+                }
+            else
+                {
+                    Acquisition_Thread_Pool::instance().parallel_for(num_doppler_bins,
+                            boost::bind(&pcps_acquisition_cc::search_doppler_line, this, _1, _2));
+                    evaluate_lines(0, num_doppler_bins);
+                }
+            d_input_ffts.reset();
+            if (d_grid_dump)
+                {
+                    d_grid_dump->end();
+                }
+            if (d_accumulating)
+                {
+                    d_noncoherent_dwells++;
+                }
 
-                                    // 5- Compute the test statistics and compare to the threshold
-                                    //d_test_statistics = 2 * d_fft_size * d_mag / d_input_power;
-                                    d_test_statistics = d_mag / d_input_power;
-                                }
-                        }
+            if (searched_lines < num_doppler_bins)
+                {
+                    // stopped early: the next dwell looks for the peak again around it, and this one does not count
+                    TRACE_LOG(TRACE_ACQUISITION, 1) << "Early termination for satellite " << d_gnss_synchro->PRN << " after "
+                                                    << searched_lines << " of " << num_doppler_bins << " doppler lines, test statistics "
+                                                    << d_test_statistics;
+                    d_verification_hint.doppler_hz = d_gnss_synchro->Acq_doppler_hz;
+                    d_verification_hint.code_start = block_start + static_cast<unsigned long int>(d_gnss_synchro->Acq_delay_samples);
+                    d_verification_pending = true;
+                    d_well_count--;
+                    d_test_statistics = 0.0;
+                }
 
-                    // Record results to file if required
-                    if (d_dump)
+            if (d_narrow_search && d_test_statistics <= d_threshold)
+                {
+                    // not found close to the hint: the next dwell searches the full grid, and this one does not count
+                    DLOG(INFO) << (d_verifying ? "Verification" : "Reacquisition") << " of satellite " << d_gnss_synchro->PRN
+                               << " failed, searching the full grid";
+                    d_well_count--;
+                    d_test_statistics = 0.0;
+                    if (d_verifying)
                         {
-                            std::stringstream filename;
-                            std::streamsize n = 2 * sizeof(float) * (d_fft_size); // complex file write
-                            filename.str("");
-
-                            boost::filesystem::path p = d_dump_filename;
-                            filename << p.parent_path().string()
-                                     << boost::filesystem::path::preferred_separator
-                                     << p.stem().string()
-                                     << "_" << d_gnss_synchro->System
-                                     <<"_" << d_gnss_synchro->Signal << "_sat_"
-                                     << d_gnss_synchro->PRN << "_doppler_"
-                                     <<  doppler
-                                     << p.extension().string();
-
-                            DLOG(INFO) << "Writing ACQ out to " << filename.str();
-
-                            d_dump_file.open(filename.str().c_str(), std::ios::out | std::ios::binary);
-                            d_dump_file.write((char*)d_ifft->get_outbuf(), n); //write directly |abs(x)|^2 in this Doppler bin?
-                            d_dump_file.close();
+                            d_early_termination_failed = true; // the remaining dwells are exhaustive
                         }
                 }
 
@@ -431,6 +730,7 @@ int pcps_acquisition_cc::general_work(int noutput_items,
                         }
                 }
 
+            metrics_scope.set_items(1);
             consume_each(1);
 
             DLOG(INFO) << "Done. Consumed 1 item.";
@@ -454,10 +754,15 @@ int pcps_acquisition_cc::general_work(int noutput_items,
             d_active = false;
             d_state = 0;
             d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
+            metrics_scope.set_items(ninput_items[0]);
             consume_each(ninput_items[0]);
 
-            acquisition_message = 1;
-            this->message_port_pub(pmt::mp("events"), pmt::from_long(acquisition_message));
+            LATENCY_TRACE(LATENCY_ACQUISITION, d_channel, d_gnss_synchro->Acq_samplestamp_samples);
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_POSITIVE_ACQUISITION));
+            if (d_pooled_engine)
+                {
+                    detach_engine();
+                }
 
             break;
         }
@@ -479,9 +784,14 @@ int pcps_acquisition_cc::general_work(int noutput_items,
             d_state = 0;
 
             d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
+            metrics_scope.set_items(ninput_items[0]);
             consume_each(ninput_items[0]);
-            acquisition_message = 2;
-            this->message_port_pub(pmt::mp("events"), pmt::from_long(acquisition_message));
+            LATENCY_TRACE(LATENCY_ACQUISITION, d_channel, d_gnss_synchro->Acq_samplestamp_samples);
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_NEGATIVE_ACQUISITION));
+            if (d_pooled_engine)
+                {
+                    detach_engine();
+                }
 
             break;
         }
@@ -51,11 +51,19 @@
 #define GNSS_SDR_PCPS_ACQUISITION_CC_H_
 
 #include <fstream>
+#include <memory>
 #include <string>
+#include <vector>
 #include <gnuradio/block.h>
 #include <gnuradio/gr_complex.h>
 #include <gnuradio/fft/fft.h>
 #include "gnss_synchro.h"
+#include "block_metrics.h"
+#include "acquisition_cache.h"
+#include "frequency_domain_doppler.h"
+#include "acquisition_thread_pool.h"
+#include "reacquisition_window.h"
+#include "acquisition_grid_dump.h"
 
 class pcps_acquisition_cc;
 
@@ -93,7 +101,13 @@ private:
             bool dump,
             std::string dump_filename);
 
-    void update_local_carrier(gr_complex* carrier_vector, int correlator_length_samples, float freq);
+    void search_doppler_line(unsigned int line_index, Acquisition_Scratch& scratch);
+    void search_batch_line(unsigned int batch_index, Acquisition_Scratch& scratch);
+    unsigned int line_doppler_index(unsigned int line_index) const;
+    void order_doppler_lines(unsigned int num_doppler_bins);
+    void evaluate_lines(unsigned int first_line, unsigned int end_line);
+    void attach_engine(); // the direct FFT plan and the buffers of the search
+    void detach_engine();
 
     long d_fs_in;
     long d_freq;
@@ -109,11 +123,45 @@ private:
     unsigned int d_well_count;
     unsigned int d_fft_size;
     unsigned long int d_sample_counter;
-    gr_complex** d_grid_doppler_wipeoffs;
+    std::shared_ptr<const Doppler_Wipeoff_Grid> d_doppler_grid;
+    std::unique_ptr<Frequency_Domain_Doppler> d_fd_doppler;
+    std::shared_ptr<const Input_Fft_Batch> d_input_ffts;
+    std::vector<Doppler_Line_Max> d_doppler_lines; // of the searched lines
+    std::unique_ptr<Reacquisition_Window> d_reacquisition_window;
+    Reacquisition_Hints d_reacquisition_hints;
+    bool d_reacquisition;
+    unsigned int d_reacquisition_doppler_window_hz;
+    unsigned int d_reacquisition_code_window_samples;
+    unsigned int d_reacquisition_max_age_ms;
+    bool d_reacquisition_tried;
+    bool d_narrow_search;
+    Reacquisition_Window* d_search_window; // of the narrow search
+    unsigned int d_first_doppler_index;
+    double d_expected_doppler_hz;
+    // early termination of the Doppler search, and verification of its peak
+    bool d_early_termination;
+    float d_confirmation_factor;
+    unsigned int d_early_termination_lines;
+    bool d_ordered_search;
+    bool d_early_termination_failed;
+    std::vector<unsigned int> d_line_order; // Doppler index of each line, from the expected Doppler outwards
+    unsigned int d_batch_first_line;
+    std::unique_ptr<Reacquisition_Window> d_verification_window;
+    bool d_verification_pending;
+    bool d_verifying;
+    Reacquisition_Hint d_verification_hint;
+    // non-coherent integration of the dwells
+    bool d_non_coherent_integration;
+    float* d_noncoherent_surface; // magnitudes summed over the dwells, d_fft_size per Doppler bin
+    unsigned int d_noncoherent_dwells;
+    bool d_accumulating;
+    double d_hint_carrier_freq_hz;
+    unsigned int d_code_ambiguity_samples;
+    const gr_complex* d_input;
     unsigned int d_num_doppler_bins;
-    gr_complex* d_fft_codes;
+    std::shared_ptr<const Code_Fft> d_code_fft;
+    const gr_complex* d_fft_codes;
     gr::fft::fft_complex* d_fft_if;
-    gr::fft::fft_complex* d_ifft;
     Gnss_Synchro *d_gnss_synchro;
     unsigned int d_code_phase;
     float d_doppler_freq;
@@ -123,12 +171,15 @@ private:
     float d_test_statistics;
     bool d_bit_transition_flag;
     bool d_use_CFAR_algorithm_flag;
-    std::ofstream d_dump_file;
+    bool d_frequency_domain_doppler;
+    bool d_pooled_engine;
     bool d_active;
     int d_state;
     bool d_dump;
     unsigned int d_channel;
+    std::shared_ptr<Block_Metrics> d_metrics; // made by set_channel
     std::string d_dump_filename;
+    std::unique_ptr<Acquisition_Grid_Dump> d_grid_dump;
     unsigned int d_peak;
 
 public:
@@ -190,6 +241,7 @@ public:
      void set_channel(unsigned int channel)
      {
          d_channel = channel;
+         d_metrics = make_block_metrics("acquisition", "ch" + std::to_string(channel));
      }
 
      /*!
@@ -220,6 +272,84 @@ public:
          d_doppler_step = doppler_step;
      }
 
+     /*!
+      * \brief Search the Doppler bins by rotating the code spectrum instead
+      * of wiping off each bin (see Frequency_Domain_Doppler). Takes effect
+      * at the next init().
+      */
+     void set_frequency_domain_doppler(bool frequency_domain_doppler)
+     {
+         d_frequency_domain_doppler = frequency_domain_doppler;
+     }
+
+     /*!
+      * \brief Attaches the direct FFT plan and the buffers of the search
+      * (including the Frequency_Domain_Doppler ones) only while an
+      * acquisition is active, and gives them back to the pools when it
+      * ends, so that many channels in standby cost only their block. Takes
+      * effect at the next init().
+      */
+     void set_pooled_engine(bool pooled_engine)
+     {
+         d_pooled_engine = pooled_engine;
+     }
+
+     /*!
+      * \brief Searches first a narrow window around the last known state of a
+      * GPS satellite (see Reacquisition_Hints), if it is at most max_age_ms
+      * old, and the full grid only if it is not found there. Takes effect at
+      * the next init().
+      */
+     void set_reacquisition(bool reacquisition, unsigned int doppler_window_hz,
+             unsigned int code_window_samples, unsigned int max_age_ms)
+     {
+         d_reacquisition = reacquisition;
+         d_reacquisition_doppler_window_hz = doppler_window_hz;
+         d_reacquisition_code_window_samples = code_window_samples;
+         d_reacquisition_max_age_ms = max_age_ms;
+     }
+
+     /*!
+      * \brief Searches the Doppler lines from the expected Doppler (the one of
+      * the reacquisition hint, or 0 Hz) outwards, lines_per_batch at a time
+      * (0 for one per thread of the acquisition thread pool), and stops at
+      * the first batch whose peak is above confirmation_factor times the
+      * threshold. The next dwell then only searches around that peak, and
+      * the acquisition is positive if it is found there again; otherwise the
+      * following dwells search the full grid. Not with the bit transition
+      * search. Takes effect at the next init().
+      */
+     void set_early_termination(bool early_termination, float confirmation_factor, unsigned int lines_per_batch)
+     {
+         d_early_termination = early_termination;
+         d_confirmation_factor = confirmation_factor;
+         d_early_termination_lines = lines_per_batch;
+     }
+
+     /*!
+      * \brief Sums the magnitudes of each Doppler bin and code phase over the
+      * full grid dwells of an acquisition, and runs the detector on the sums,
+      * instead of on each dwell alone. With max_dwells > 1 and without the
+      * bit transition search only. Takes effect at the next init().
+      */
+     void set_non_coherent_integration(bool non_coherent_integration)
+     {
+         d_non_coherent_integration = non_coherent_integration;
+     }
+
+     /*!
+      * \brief Searches a signal other than GPS L1 C/A with the reacquisition
+      * hints of the GPS L1 tracking of the same satellite: their Doppler is
+      * scaled to carrier_freq_hz, and, since they only give the code start
+      * modulo a C/A code period, the code window is repeated every
+      * code_ambiguity_samples. Takes effect at the next init().
+      */
+     void set_hint_carrier(double carrier_freq_hz, unsigned int code_ambiguity_samples)
+     {
+         d_hint_carrier_freq_hz = carrier_freq_hz;
+         d_code_ambiguity_samples = code_ambiguity_samples;
+     }
+
      /*!
       * \brief Parallel Code Phase Search Acquisition signal processing.
       */
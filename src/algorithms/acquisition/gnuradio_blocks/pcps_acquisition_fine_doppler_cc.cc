@@ -39,8 +39,11 @@
 #include <volk_gnsssdr/volk_gnsssdr.h>
 #include "concurrent_map.h"
 #include "gps_sdr_signal_processing.h"
+#include "code_bank.h"
 #include "control_message_factory.h"
+#include "fft_plan_cache.h"
 #include "GPS_L1_CA.h"
+#include "channel_event.h"
 
 using google::LogMessage;
 
@@ -85,14 +88,18 @@ pcps_acquisition_fine_doppler_cc::pcps_acquisition_fine_doppler_cc(
     d_magnitude = static_cast<float*>(volk_malloc(d_fft_size * sizeof(float), volk_get_alignment()));
 
     // Direct FFT
-    d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
+    d_fft_if = Fft_Plan_Cache::acquire(d_fft_size, true);
 
     // Inverse FFT
-    d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+    d_ifft = Fft_Plan_Cache::acquire(d_fft_size, false);
 
     // For dumping samples into a file
     d_dump = dump;
     d_dump_filename = dump_filename;
+    if (d_dump)
+        {
+            d_grid_dump.reset(new Acquisition_Grid_Dump(d_dump_filename));
+        }
 
     d_doppler_resolution = 0;
     d_threshold = 0;
@@ -139,8 +146,8 @@ pcps_acquisition_fine_doppler_cc::~pcps_acquisition_fine_doppler_cc()
     volk_free(d_carrier);
     volk_free(d_fft_codes);
     volk_free(d_magnitude);
-    delete d_ifft;
-    delete d_fft_if;
+    Fft_Plan_Cache::release(d_ifft);
+    Fft_Plan_Cache::release(d_fft_if);
     if (d_dump)
         {
             d_dump_file.close();
@@ -213,7 +220,7 @@ void pcps_acquisition_fine_doppler_cc::update_carrier_wipeoff()
             d_grid_doppler_wipeoffs[doppler_index] = new gr_complex[d_fft_size];
             float _phase[1];
             _phase[0] = 0;
-            volk_gnsssdr_s32f_sincos_32fc(d_grid_doppler_wipeoffs[doppler_index], - phase_step_rad, _phase, d_fft_size);
+            volk_gnsssdr_s32f_nco_32fc(d_grid_doppler_wipeoffs[doppler_index], - phase_step_rad, _phase, d_fft_size);
         }
 }
 
@@ -255,18 +262,15 @@ double pcps_acquisition_fine_doppler_cc::search_maximum()
     d_gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
 
     // Record results to file if required
-    if (d_dump)
+    if (d_grid_dump)
         {
-            std::stringstream filename;
-            std::streamsize n = 2 * sizeof(float) * (d_fft_size); // complex file write
-            filename.str("");
-            filename << "../data/test_statistics_" << d_gnss_synchro->System
-                    <<"_" << d_gnss_synchro->Signal << "_sat_"
-                    << d_gnss_synchro->PRN << "_doppler_" <<  d_gnss_synchro->Acq_doppler_hz << ".dat";
-            d_dump_file.open(filename.str().c_str(), std::ios::out
-                    | std::ios::binary);
-            d_dump_file.write((char*)d_grid_data[index_doppler], n); //write directly |abs(x)|^2 in this Doppler bin?
-            d_dump_file.close();
+            d_grid_dump->begin(*d_gnss_synchro, d_channel, d_sample_counter, d_fs_in, d_config_doppler_min,
+                    d_doppler_step, d_num_doppler_points, d_fft_size);
+            for (int i = 0; i < d_num_doppler_points; i++)
+                {
+                    d_grid_dump->write_line(i, d_grid_data[i]);
+                }
+            d_grid_dump->end();
         }
 
     return d_test_statistics;
@@ -333,7 +337,7 @@ int pcps_acquisition_fine_doppler_cc::estimate_Doppler(gr_vector_const_void_star
     // Direct FFT
     int zero_padding_factor = 2;
     int fft_size_extended = d_fft_size * zero_padding_factor;
-    gr::fft::fft_complex *fft_operator = new gr::fft::fft_complex(fft_size_extended, true);
+    gr::fft::fft_complex *fft_operator = Fft_Plan_Cache::acquire(fft_size_extended, true);
 
     //zero padding the entire vector
     memset(fft_operator->get_inbuf(), 0, fft_size_extended * sizeof(gr_complex));
@@ -341,7 +345,7 @@ int pcps_acquisition_fine_doppler_cc::estimate_Doppler(gr_vector_const_void_star
     //1. generate local code aligned with the acquisition code phase estimation
     gr_complex *code_replica = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
 
-    gps_l1_ca_code_gen_complex_sampled(code_replica, d_gnss_synchro->PRN, d_fs_in, 0);
+    Code_Bank::gps_l1_ca_code_gen_complex_sampled(code_replica, d_gnss_synchro->PRN, d_fs_in, 0);
 
     int shift_index = static_cast<int>(d_gnss_synchro->Acq_delay_samples);
 
@@ -431,7 +435,7 @@ int pcps_acquisition_fine_doppler_cc::estimate_Doppler(gr_vector_const_void_star
 
 
     // free memory!!
-    delete fft_operator;
+    Fft_Plan_Cache::release(fft_operator);
     volk_free(code_replica);
     volk_free(p_tmp_vector);
     return d_fft_size;
@@ -442,6 +446,7 @@ int pcps_acquisition_fine_doppler_cc::general_work(int noutput_items,
         gr_vector_int &ninput_items __attribute__((unused)), gr_vector_const_void_star &input_items,
         gr_vector_void_star &output_items __attribute__((unused)))
 {
+    Block_Metrics_Scope metrics_scope(d_metrics.get(), ninput_items[0]);
 
     /*!
      * TODO:     High sensitivity acquisition algorithm:
@@ -511,7 +516,7 @@ int pcps_acquisition_fine_doppler_cc::general_work(int noutput_items,
 
         d_active = false;
         // Send message to channel port //0=STOP_CHANNEL 1=ACQ_SUCCEES 2=ACQ_FAIL
-        this->message_port_pub(pmt::mp("events"), pmt::from_long(1));
+        this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_POSITIVE_ACQUISITION));
         d_state = 0;
         break;
     case 5: // Negative_Acq
@@ -527,7 +532,7 @@ int pcps_acquisition_fine_doppler_cc::general_work(int noutput_items,
 
         d_active = false;
         // Send message to channel port //0=STOP_CHANNEL 1=ACQ_SUCCEES 2=ACQ_FAIL
-        this->message_port_pub(pmt::mp("events"), pmt::from_long(2));
+        this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_NEGATIVE_ACQUISITION));
         d_state = 0;
         break;
     default:
@@ -537,6 +542,7 @@ int pcps_acquisition_fine_doppler_cc::general_work(int noutput_items,
 
     //DLOG(INFO)<<"d_sample_counter="<<d_sample_counter<<std::endl;
     d_sample_counter += d_fft_size; // sample counter
+    metrics_scope.set_items(d_fft_size);
     consume_each(d_fft_size);
     return noutput_items;
 }
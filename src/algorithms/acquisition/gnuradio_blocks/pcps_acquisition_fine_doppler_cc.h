@@ -49,11 +49,14 @@
 #define GNSS_SDR_PCPS_ACQUISITION_FINE_DOPPLER_CC_H_
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <gnuradio/block.h>
 #include <gnuradio/gr_complex.h>
 #include <gnuradio/fft/fft.h>
 #include "gnss_synchro.h"
+#include "block_metrics.h"
+#include "acquisition_grid_dump.h"
 
 class pcps_acquisition_fine_doppler_cc;
 
@@ -133,8 +136,10 @@ private:
     int d_well_count;
     bool d_dump;
     unsigned int d_channel;
+    std::shared_ptr<Block_Metrics> d_metrics; // made by set_channel
 
     std::string d_dump_filename;
+    std::unique_ptr<Acquisition_Grid_Dump> d_grid_dump;
     unsigned int d_peak;
 
 public:
@@ -190,6 +195,7 @@ public:
     void set_channel(unsigned int channel)
     {
         d_channel = channel;
+        d_metrics = make_block_metrics("acquisition", "ch" + std::to_string(channel));
     }
 
     /*!
@@ -33,14 +33,14 @@
  */
 
 #include "pcps_acquisition_sc.h"
-#include <sstream>
-#include <boost/filesystem.hpp>
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
 #include <volk/volk.h>
 #include <volk_gnsssdr/volk_gnsssdr.h>
 #include "control_message_factory.h"
+#include "fft_plan_cache.h"
 #include "GPS_L1_CA.h" //GPS_TWO_PI
+#include "channel_event.h"
 
 using google::LogMessage;
 
@@ -112,43 +112,33 @@ pcps_acquisition_sc::pcps_acquisition_sc(
             d_max_dwells = 1;
         }
 
-    d_fft_codes = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
     d_magnitude = static_cast<float*>(volk_malloc(d_fft_size * sizeof(float), volk_get_alignment()));
-    //temporary storage for the input conversion from 16sc to float 32fc
-    d_in_32fc = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
 
     // Direct FFT
-    d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
+    d_fft_if = Fft_Plan_Cache::acquire(d_fft_size, true);
 
     // Inverse FFT
-    d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+    d_ifft = Fft_Plan_Cache::acquire(d_fft_size, false);
 
     // For dumping samples into a file
     d_dump = dump;
     d_dump_filename = dump_filename;
+    if (d_dump)
+        {
+            d_grid_dump.reset(new Acquisition_Grid_Dump(d_dump_filename));
+        }
 
     d_gnss_synchro = 0;
-    d_grid_doppler_wipeoffs = 0;
+    d_fft_codes = 0;
 }
 
 
 pcps_acquisition_sc::~pcps_acquisition_sc()
 {
-    if (d_num_doppler_bins > 0)
-        {
-            for (unsigned int i = 0; i < d_num_doppler_bins; i++)
-                {
-                    volk_free(d_grid_doppler_wipeoffs[i]);
-                }
-            delete[] d_grid_doppler_wipeoffs;
-        }
-
-    volk_free(d_fft_codes);
     volk_free(d_magnitude);
-    volk_free(d_in_32fc);
 
-    delete d_ifft;
-    delete d_fft_if;
+    Fft_Plan_Cache::release(d_ifft);
+    Fft_Plan_Cache::release(d_fft_if);
 
     if (d_dump)
         {
@@ -170,17 +160,9 @@ void pcps_acquisition_sc::set_local_code(std::complex<float> * code)
             offset = d_samples_per_code;
         }
     memcpy(d_fft_if->get_inbuf() + offset, code, sizeof(gr_complex) * d_samples_per_code);
-    d_fft_if->execute(); // We need the FFT of local code
-    volk_32fc_conjugate_32fc(d_fft_codes, d_fft_if->get_outbuf(), d_fft_size);
-}
-
-
-void pcps_acquisition_sc::update_local_carrier(gr_complex* carrier_vector, int correlator_length_samples, float freq)
-{
-    float phase_step_rad = GPS_TWO_PI * freq / static_cast<float>(d_fs_in);
-    float _phase[1];
-    _phase[0] = 0;
-    volk_gnsssdr_s32f_sincos_32fc(carrier_vector, - phase_step_rad, _phase, correlator_length_samples);
+    // The FFT of the local code is shared with the channels searching for the same signal
+    d_code_fft = Acquisition_Cache::code_fft(d_gnss_synchro->System, d_gnss_synchro->Signal, d_gnss_synchro->PRN, d_fft_if);
+    d_fft_codes = d_code_fft->get();
 }
 
 
@@ -200,15 +182,8 @@ void pcps_acquisition_sc::init()
 
     d_num_doppler_bins = ceil( static_cast<double>(static_cast<int>(d_doppler_max) - static_cast<int>(-d_doppler_max)) / static_cast<double>(d_doppler_step));
 
-    // Create the carrier Doppler wipeoff signals
-    d_grid_doppler_wipeoffs = new gr_complex*[d_num_doppler_bins];
-
-    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
-        {
-            d_grid_doppler_wipeoffs[doppler_index] = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
-            int doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * doppler_index;
-            update_local_carrier(d_grid_doppler_wipeoffs[doppler_index], d_fft_size, d_freq + doppler);
-        }
+    // The carrier Doppler wipeoffs are done on the 16-bit samples
+    d_wipeoff.reset(new Carrier_Wipeoff_16ic(d_fs_in, d_freq, d_doppler_max, d_doppler_step, d_num_doppler_bins, d_fft_size));
 }
 
 
@@ -249,8 +224,6 @@ int pcps_acquisition_sc::general_work(int noutput_items,
      * 6. Declare positive or negative acquisition using a message port
      */
 
-    int acquisition_message = -1; //0=STOP_CHANNEL 1=ACQ_SUCCEES 2=ACQ_FAIL
-
     switch (d_state)
     {
     case 0:
@@ -290,8 +263,8 @@ int pcps_acquisition_sc::general_work(int noutput_items,
             const lv_16sc_t *in = (const lv_16sc_t *)input_items[0]; //Get the input samples pointer
             int effective_fft_size = ( d_bit_transition_flag ? d_fft_size/2 : d_fft_size );
 
-            //TODO: optimize the signal processing chain to not use gr_complex. This is a temporary solution
-            volk_gnsssdr_16ic_convert_32fc(d_in_32fc,in,effective_fft_size);
+            // the input is only converted to float after the wipeoff of each Doppler bin
+            float scaled_input_power = d_wipeoff->set_input(in);
 
             float fft_normalization_factor = static_cast<float>(d_fft_size) * static_cast<float>(d_fft_size);
 
@@ -309,9 +282,12 @@ int pcps_acquisition_sc::general_work(int noutput_items,
             if (d_use_CFAR_algorithm_flag == true)
                 {
                     // 1- (optional) Compute the input signal power estimation
-                    volk_32fc_magnitude_squared_32f(d_magnitude, d_in_32fc, d_fft_size);
-                    volk_32f_accumulator_s32f(&d_input_power, d_magnitude, d_fft_size);
-                    d_input_power /= static_cast<float>(d_fft_size);
+                    d_input_power = scaled_input_power;
+                }
+            if (d_grid_dump)
+                {
+                    d_grid_dump->begin(*d_gnss_synchro, d_channel, d_sample_counter, d_fs_in, -static_cast<int>(d_doppler_max),
+                            d_doppler_step, d_num_doppler_bins, effective_fft_size);
                 }
             // 2- Doppler frequency search loop
             for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
@@ -320,8 +296,7 @@ int pcps_acquisition_sc::general_work(int noutput_items,
 
                     doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * doppler_index;
 
-                    volk_32fc_x2_multiply_32fc(d_fft_if->get_inbuf(), d_in_32fc,
-                            d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
+                    d_wipeoff->wipeoff(doppler_index, d_fft_if->get_inbuf());
 
                     // 3- Perform the FFT-based convolution  (parallel time search)
                     // Compute the FFT of the carrier wiped--off incoming signal
@@ -381,29 +356,15 @@ int pcps_acquisition_sc::general_work(int noutput_items,
                         }
 
                     // Record results to file if required
-                    if (d_dump)
+                    if (d_grid_dump)
                         {
-                            std::stringstream filename;
-                            std::streamsize n = 2 * sizeof(float) * (d_fft_size); // complex file write
-                            filename.str("");
-
-                            boost::filesystem::path p = d_dump_filename;
-                            filename << p.parent_path().string()
-                                             << boost::filesystem::path::preferred_separator
-                                             << p.stem().string()
-                                             << "_" << d_gnss_synchro->System
-                                             <<"_" << d_gnss_synchro->Signal << "_sat_"
-                                             << d_gnss_synchro->PRN << "_doppler_"
-                                             <<  doppler
-                                             << p.extension().string();
-
-                            DLOG(INFO) << "Writing ACQ out to " << filename.str();
-
-                            d_dump_file.open(filename.str().c_str(), std::ios::out | std::ios::binary);
-                            d_dump_file.write((char*)d_ifft->get_outbuf(), n); //write directly |abs(x)|^2 in this Doppler bin?
-                            d_dump_file.close();
+                            d_grid_dump->write_line(doppler_index, d_magnitude);
                         }
                 }
+            if (d_grid_dump)
+                {
+                    d_grid_dump->end();
+                }
 
             if (!d_bit_transition_flag)
                 {
@@ -457,8 +418,7 @@ int pcps_acquisition_sc::general_work(int noutput_items,
             d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
             consume_each(ninput_items[0]);
 
-            acquisition_message = 1;
-            this->message_port_pub(pmt::mp("events"), pmt::from_long(acquisition_message));
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_POSITIVE_ACQUISITION));
 
             break;
         }
@@ -481,8 +441,7 @@ int pcps_acquisition_sc::general_work(int noutput_items,
 
             d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
             consume_each(ninput_items[0]);
-            acquisition_message = 2;
-            this->message_port_pub(pmt::mp("events"), pmt::from_long(acquisition_message));
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_NEGATIVE_ACQUISITION));
 
             break;
         }
@@ -31,17 +31,16 @@
  */
 
 #include "pcps_assisted_acquisition_cc.h"
-#include <sstream>
+#include <algorithm>
 #include <glog/logging.h>
 #include <gnuradio/io_signature.h>
 #include <volk/volk.h>
 #include <volk_gnsssdr/volk_gnsssdr.h>
-#include "concurrent_map.h"
 #include "control_message_factory.h"
+#include "fft_plan_cache.h"
 #include "gps_acq_assist.h"
 #include "GPS_L1_CA.h"
-
-extern concurrent_map<Gps_Acq_Assist> global_gps_acq_assist_map;
+#include "channel_event.h"
 
 using google::LogMessage;
 
@@ -66,6 +65,7 @@ pcps_assisted_acquisition_cc::pcps_assisted_acquisition_cc(
                         gr::io_signature::make(0, 0, sizeof(gr_complex)))
 {
     this->message_port_register_out(pmt::mp("events"));
+    d_receiver_state = Receiver_State::current();
     d_sample_counter = 0;    // SAMPLE COUNTER
     d_active = false;
     d_freq = freq;
@@ -85,14 +85,18 @@ pcps_assisted_acquisition_cc::pcps_assisted_acquisition_cc(
     d_carrier = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
 
     // Direct FFT
-    d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
+    d_fft_if = Fft_Plan_Cache::acquire(d_fft_size, true);
 
     // Inverse FFT
-    d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+    d_ifft = Fft_Plan_Cache::acquire(d_fft_size, false);
 
     // For dumping samples into a file
     d_dump = dump;
     d_dump_filename = dump_filename;
+    if (d_dump)
+        {
+            d_grid_dump.reset(new Acquisition_Grid_Dump(d_dump_filename));
+        }
 
     d_doppler_resolution = 0;
     d_threshold = 0;
@@ -108,6 +112,9 @@ pcps_assisted_acquisition_cc::pcps_assisted_acquisition_cc(
     d_test_statistics = 0;
     d_well_count = 0;
     d_channel = 0;
+    d_narrow_search = false;
+    d_narrow_search_max_age_ms = 0;
+    d_narrow_code_phases = false;
 }
 
 
@@ -119,6 +126,24 @@ void pcps_assisted_acquisition_cc::set_doppler_step(unsigned int doppler_step)
 
 
 
+void pcps_assisted_acquisition_cc::set_narrow_search(bool narrow_search, unsigned int code_window_samples, unsigned int max_age_ms)
+{
+    // the direct correlation is circular, as the FFT-based one, over a single code period
+    d_narrow_search = narrow_search && d_sampled_ms == 1;
+    d_narrow_search_max_age_ms = max_age_ms;
+    d_code_window.reset();
+    d_narrow_code_search.reset();
+    if (d_narrow_search)
+        {
+            // only its code window is used, the Doppler window is the assisted one
+            d_code_window.reset(new Reacquisition_Window(d_fs_in, d_samples_per_ms, GPS_L1_FREQ_HZ,
+                    0, 1, 1, 0, code_window_samples));
+            d_narrow_code_search.reset(new Narrow_Code_Search(d_fs_in, d_fft_size));
+        }
+}
+
+
+
 void pcps_assisted_acquisition_cc::free_grid_memory()
 {
     for (int i = 0; i < d_num_doppler_points; i++)
@@ -135,8 +160,8 @@ pcps_assisted_acquisition_cc::~pcps_assisted_acquisition_cc()
 {
     volk_free(d_carrier);
     volk_free(d_fft_codes);
-    delete d_ifft;
-    delete d_fft_if;
+    Fft_Plan_Cache::release(d_ifft);
+    Fft_Plan_Cache::release(d_fft_if);
     if (d_dump)
         {
             d_dump_file.close();
@@ -148,6 +173,10 @@ pcps_assisted_acquisition_cc::~pcps_assisted_acquisition_cc()
 void pcps_assisted_acquisition_cc::set_local_code(std::complex<float> * code)
 {
     memcpy(d_fft_if->get_inbuf(), code, sizeof(gr_complex)*d_fft_size);
+    if (d_narrow_code_search)
+        {
+            d_narrow_code_search->set_local_code(code);
+        }
 }
 
 
@@ -188,7 +217,7 @@ void pcps_assisted_acquisition_cc::forecast (int noutput_items,
 void pcps_assisted_acquisition_cc::get_assistance()
 {
     Gps_Acq_Assist gps_acq_assisistance;
-    if (global_gps_acq_assist_map.read(this->d_gnss_synchro->PRN, gps_acq_assisistance)==true)
+    if (d_receiver_state->gps_acq_assist_map.read(this->d_gnss_synchro->PRN, gps_acq_assisistance)==true)
         {
             //TODO: use the LO tolerance here
             if (gps_acq_assisistance.dopplerUncertainty >= 1000)
@@ -214,6 +243,26 @@ void pcps_assisted_acquisition_cc::get_assistance()
 
 
 
+void pcps_assisted_acquisition_cc::center_narrow_search()
+{
+    d_narrow_code_phases = false;
+    if (d_narrow_search)
+        {
+            Reacquisition_Hint hint;
+            unsigned long int max_age = static_cast<unsigned long int>(d_narrow_search_max_age_ms) * static_cast<unsigned long int>(d_fs_in / 1000);
+            if (d_reacquisition_hints.get(d_gnss_synchro->PRN, 0, d_sample_counter, max_age, hint))
+                {
+                    // the dwells are whole code periods, the code phase is the same in all of them
+                    d_code_window->center_code(hint, d_sample_counter);
+                    d_narrow_code_phases = Narrow_Code_Search::cheaper_than_fft(d_code_window->num_code_phases(), d_fft_size);
+                    DLOG(INFO) << "Narrow search of satellite " << d_gnss_synchro->PRN << " around code phase "
+                               << d_code_window->code_phase() << ": " << d_narrow_code_phases;
+                }
+        }
+}
+
+
+
 void pcps_assisted_acquisition_cc::reset_grid()
 {
     d_well_count = 0;
@@ -257,7 +306,7 @@ void pcps_assisted_acquisition_cc::redefine_grid()
             d_grid_doppler_wipeoffs[doppler_index] = new gr_complex[d_fft_size];
             float _phase[1];
             _phase[0] = 0;
-            volk_gnsssdr_s32f_sincos_32fc(d_grid_doppler_wipeoffs[doppler_index], - phase_step_rad, _phase, d_fft_size);
+            volk_gnsssdr_s32f_nco_32fc(d_grid_doppler_wipeoffs[doppler_index], - phase_step_rad, _phase, d_fft_size);
         }
 }
 
@@ -300,17 +349,15 @@ double pcps_assisted_acquisition_cc::search_maximum()
     d_gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
 
     // Record results to file if required
-    if (d_dump)
+    if (d_grid_dump)
         {
-            std::stringstream filename;
-            std::streamsize n = 2 * sizeof(float) * (d_fft_size); // complex file write
-            filename.str("");
-            filename << "../data/test_statistics_" << d_gnss_synchro->System
-                     << "_" << d_gnss_synchro->Signal << "_sat_"
-                     << d_gnss_synchro->PRN << "_doppler_" <<  d_gnss_synchro->Acq_doppler_hz << ".dat";
-            d_dump_file.open(filename.str().c_str(), std::ios::out | std::ios::binary);
-            d_dump_file.write((char*)d_grid_data[index_doppler], n); //write directly |abs(x)|^2 in this Doppler bin?
-            d_dump_file.close();
+            d_grid_dump->begin(*d_gnss_synchro, d_channel, d_sample_counter, d_fs_in, d_doppler_min,
+                    d_doppler_step, d_num_doppler_points, d_fft_size);
+            for (int i = 0; i < d_num_doppler_points; i++)
+                {
+                    d_grid_dump->write_line(i, d_grid_data[i]);
+                }
+            d_grid_dump->end();
         }
 
     return d_test_statistics;
@@ -349,25 +396,39 @@ int pcps_assisted_acquisition_cc::compute_and_accumulate_grid(gr_vector_const_vo
 
     // 2- Doppler frequency search loop
     float* p_tmp_vector = static_cast<float*>(volk_malloc(d_fft_size * sizeof(float), volk_get_alignment()));
+    if (d_narrow_code_phases)
+        {
+            d_narrow_code_search->set_input(in);
+        }
 
     for (int doppler_index = 0; doppler_index < d_num_doppler_points; doppler_index++)
         {
             // doppler search steps
-            // Perform the carrier wipe-off
-            volk_32fc_x2_multiply_32fc(d_fft_if->get_inbuf(), in, d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
-            // 3- Perform the FFT-based convolution  (parallel time search)
-            // Compute the FFT of the carrier wiped--off incoming signal
-            d_fft_if->execute();
-
-            // Multiply carrier wiped--off, Fourier transformed incoming signal
-            // with the local FFT'd code reference using SIMD operations with VOLK library
-            volk_32fc_x2_multiply_32fc(d_ifft->get_inbuf(), d_fft_if->get_outbuf(), d_fft_codes, d_fft_size);
-
-            // compute the inverse FFT
-            d_ifft->execute();
+            if (d_narrow_code_phases)
+                {
+                    // only the code phases of the window are correlated, the other ones add zero
+                    std::fill_n(p_tmp_vector, d_fft_size, 0.0);
+                    d_narrow_code_search->search(static_cast<double>(d_doppler_min + d_doppler_step*doppler_index),
+                            d_code_window->first_code_phase(), d_code_window->num_code_phases(), p_tmp_vector);
+                }
+            else
+                {
+                    // Perform the carrier wipe-off
+                    volk_32fc_x2_multiply_32fc(d_fft_if->get_inbuf(), in, d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
+                    // 3- Perform the FFT-based convolution  (parallel time search)
+                    // Compute the FFT of the carrier wiped--off incoming signal
+                    d_fft_if->execute();
+
+                    // Multiply carrier wiped--off, Fourier transformed incoming signal
+                    // with the local FFT'd code reference using SIMD operations with VOLK library
+                    volk_32fc_x2_multiply_32fc(d_ifft->get_inbuf(), d_fft_if->get_outbuf(), d_fft_codes, d_fft_size);
+
+                    // compute the inverse FFT
+                    d_ifft->execute();
+                    volk_32fc_magnitude_squared_32f(p_tmp_vector, d_ifft->get_outbuf(), d_fft_size);
+                }
 
             // save the grid matrix delay file
-            volk_32fc_magnitude_squared_32f(p_tmp_vector, d_ifft->get_outbuf(), d_fft_size);
             const float* old_vector = d_grid_data[doppler_index];
             volk_32f_x2_add_32f(d_grid_data[doppler_index], old_vector, p_tmp_vector, d_fft_size);
         }
@@ -394,6 +455,7 @@ int pcps_assisted_acquisition_cc::general_work(int noutput_items,
      *                 else if !disable_assist -> S3
      *                 else -> S5.
      *             S3. RedefineGrid. Open the grid search to unasisted acquisition. Reset counters and grid. -> S2
+     *                 (a failed narrow search first searches all the code phases of the assisted grid)
      *             S4. Positive_Acq: Send message and stop acq -> S0
      *             S5. Negative_Acq: Send message and stop acq -> S0
      */
@@ -411,6 +473,7 @@ int pcps_assisted_acquisition_cc::general_work(int noutput_items,
         reset_grid();
         d_sample_counter += ninput_items[0]; // sample counter
         consume_each(ninput_items[0]);
+        center_narrow_search();
         d_state = 2;
         break;
     case 2: // S2. ComputeGrid
@@ -431,6 +494,12 @@ int pcps_assisted_acquisition_cc::general_work(int noutput_items,
             {
                 d_state = 5;
             }
+        else if (d_narrow_code_phases)
+            {
+                // search all the code phases of the same Doppler window
+                d_narrow_code_phases = false;
+                d_state = 4;
+            }
         else
             {
                 if (d_disable_assist == false)
@@ -466,7 +535,7 @@ int pcps_assisted_acquisition_cc::general_work(int noutput_items,
         DLOG(INFO) << "input signal power " << d_input_power;
         d_active = false;
         // Send message to channel port //0=STOP_CHANNEL 1=ACQ_SUCCESS 2=ACQ_FAIL
-        this->message_port_pub(pmt::mp("events"), pmt::from_long(1));
+        this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_POSITIVE_ACQUISITION));
         free_grid_memory();
         // consume samples to not block the GNU Radio flowgraph
         d_sample_counter += ninput_items[0]; // sample counter
@@ -484,7 +553,7 @@ int pcps_assisted_acquisition_cc::general_work(int noutput_items,
         DLOG(INFO) << "input signal power " << d_input_power;
         d_active = false;
         // Send message to channel port //0=STOP_CHANNEL 1=ACQ_SUCCESS 2=ACQ_FAIL
-        this->message_port_pub(pmt::mp("events"), pmt::from_long(2));
+        this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_NEGATIVE_ACQUISITION));
         free_grid_memory();
         // consume samples to not block the GNU Radio flowgraph
         d_sample_counter += ninput_items[0]; // sample counter
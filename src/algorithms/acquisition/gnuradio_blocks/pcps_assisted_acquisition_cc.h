@@ -49,11 +49,15 @@
 #define GNSS_SDR_PCPS_ASSISTED_ACQUISITION_CC_H_
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <gnuradio/block.h>
 #include <gnuradio/gr_complex.h>
 #include <gnuradio/fft/fft.h>
 #include "gnss_synchro.h"
+#include "narrow_code_search.h"
+#include "reacquisition_window.h"
+#include "acquisition_grid_dump.h"
 
 class pcps_assisted_acquisition_cc;
 
@@ -92,6 +96,7 @@ private:
     float estimate_input_power(gr_vector_const_void_star &input_items);
     double search_maximum();
     void get_assistance();
+    void center_narrow_search();
     void reset_grid();
     void redefine_grid();
     void free_grid_memory();
@@ -136,8 +141,17 @@ private:
     unsigned int d_channel;
 
     std::string d_dump_filename;
+    std::unique_ptr<Acquisition_Grid_Dump> d_grid_dump;
     unsigned int d_peak;
 
+    bool d_narrow_search;
+    unsigned int d_narrow_search_max_age_ms;
+    std::unique_ptr<Reacquisition_Window> d_code_window;
+    Reacquisition_Hints d_reacquisition_hints;
+    std::shared_ptr<Receiver_State> d_receiver_state; // current at construction
+    std::unique_ptr<Narrow_Code_Search> d_narrow_code_search;
+    bool d_narrow_code_phases; // this search correlates only the code phases of d_code_window
+
 public:
     /*!
      * \brief Default destructor.
@@ -217,6 +231,13 @@ public:
      */
     void set_doppler_step(unsigned int doppler_step);
 
+    /*!
+     * \brief Enables the narrow search: when the satellite was tracked at most max_age_ms
+     * before (see Reacquisition_Hints), the first search of the assisted Doppler window only
+     * correlates the code phases within code_window_samples of the tracked one, without FFTs.
+     * If it fails, all the code phases are searched. Needs a single code period per search.
+     */
+    void set_narrow_search(bool narrow_search, unsigned int code_window_samples, unsigned int max_age_ms);
 
     /*!
      * \brief Parallel Code Phase Search Acquisition signal processing.
@@ -35,17 +35,89 @@
  */
 
 #include "pcps_cccwsr_acquisition_cc.h"
-#include <sstream>
 #include <glog/logging.h>
 #include <gnuradio/io_signature.h>
 #include <volk/volk.h>
 #include <volk_gnsssdr/volk_gnsssdr.h>
 #include "control_message_factory.h"
+#include "fft_plan_cache.h"
 #include "GPS_L1_CA.h" //GPS_TWO_PI
+#include "channel_event.h"
 
 
 using google::LogMessage;
 
+const gr_complex* Cccwsr_Statistic::line(unsigned int doppler_index __attribute__((unused)),
+        const gr_complex* input_fft, Acquisition_Scratch& scratch, Doppler_Line_Max& max) const
+{
+#if VOLK_GT_122
+    uint16_t indext_plus = 0;
+    uint16_t indext_minus = 0;
+#else
+    unsigned int indext_plus = 0;
+    unsigned int indext_minus = 0;
+#endif
+    gr::fft::fft_complex* ifft = scratch.ifft(fft_size);
+    float* magnitude = scratch.magnitude(fft_size);
+    gr_complex* data_correlation = scratch.correlation(fft_size);
+    float fft_normalization_factor = static_cast<float>(fft_size) * static_cast<float>(fft_size);
+
+    // Multiply carrier wiped--off, Fourier transformed incoming signal
+    // with the local FFT'd data code reference (E1B) using SIMD operations
+    // with VOLK library
+    volk_32fc_x2_multiply_32fc(ifft->get_inbuf(), input_fft, fft_code_data, fft_size);
+
+    // compute the inverse FFT
+    ifft->execute();
+
+    // Copy the result of the correlation between wiped--off signal and data code in
+    // data_correlation.
+    memcpy(data_correlation, ifft->get_outbuf(), sizeof(gr_complex) * fft_size);
+
+    // Multiply carrier wiped--off, Fourier transformed incoming signal
+    // with the local FFT'd pilot code reference (E1C) using SIMD operations
+    // with VOLK library
+    volk_32fc_x2_multiply_32fc(ifft->get_inbuf(), input_fft, fft_code_pilot, fft_size);
+
+    // Compute the inverse FFT, which is left with the pilot correlation
+    ifft->execute();
+    const gr_complex* pilot_correlation = ifft->get_outbuf();
+
+    // |data + j*pilot|^2
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            gr_complex plus(data_correlation[i].real() - pilot_correlation[i].imag(),
+                    data_correlation[i].imag() + pilot_correlation[i].real());
+            magnitude[i] = std::norm(plus);
+        }
+    volk_32f_index_max_16u(&indext_plus, magnitude, fft_size);
+    float magt_plus = magnitude[indext_plus] / (fft_normalization_factor * fft_normalization_factor);
+
+    // |data - j*pilot|^2
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            gr_complex minus(data_correlation[i].real() + pilot_correlation[i].imag(),
+                    data_correlation[i].imag() - pilot_correlation[i].real());
+            magnitude[i] = std::norm(minus);
+        }
+    volk_32f_index_max_16u(&indext_minus, magnitude, fft_size);
+    float magt_minus = magnitude[indext_minus] / (fft_normalization_factor * fft_normalization_factor);
+
+    if (magt_plus >= magt_minus)
+        {
+            max.mag = magt_plus;
+            max.index = indext_plus;
+        }
+    else
+        {
+            max.mag = magt_minus;
+            max.index = indext_minus;
+        }
+    max.power = 0.0;
+    return pilot_correlation;
+}
+
+
 pcps_cccwsr_acquisition_cc_sptr pcps_cccwsr_make_acquisition_cc(
                                 unsigned int sampled_ms, unsigned int max_dwells,
                                 unsigned int doppler_max, long freq, long fs_in,
@@ -83,28 +155,22 @@ pcps_cccwsr_acquisition_cc::pcps_cccwsr_acquisition_cc(
     d_input_power = 0.0;
     d_num_doppler_bins = 0;
 
-    d_fft_code_data = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
-    d_fft_code_pilot = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
-    d_data_correlation = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
-    d_pilot_correlation = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
-    d_correlation_plus = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
-    d_correlation_minus = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
     d_magnitude = static_cast<float*>(volk_malloc(d_fft_size * sizeof(float), volk_get_alignment()));
 
     // Direct FFT
-    d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
+    d_fft_if = Fft_Plan_Cache::acquire(d_fft_size, true);
 
-    // Inverse FFT
-    d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+    // The inverse FFTs are run by the search core, with the plans of its threads
+    d_search.statistic().fft_size = d_fft_size;
 
     // For dumping samples into a file
     d_dump = dump;
     d_dump_filename = dump_filename;
+    d_search.set_dump(d_dump);
 
     d_doppler_resolution = 0;
     d_threshold = 0;
     d_doppler_step = 0;
-    d_grid_doppler_wipeoffs = 0;
     d_gnss_synchro = 0;
     d_code_phase = 0;
     d_doppler_freq = 0;
@@ -114,50 +180,24 @@ pcps_cccwsr_acquisition_cc::pcps_cccwsr_acquisition_cc(
 
 pcps_cccwsr_acquisition_cc::~pcps_cccwsr_acquisition_cc()
 {
-    if (d_num_doppler_bins > 0)
-        {
-            for (unsigned int i = 0; i < d_num_doppler_bins; i++)
-                {
-                    volk_free(d_grid_doppler_wipeoffs[i]);
-                }
-            delete[] d_grid_doppler_wipeoffs;
-        }
-
-    volk_free(d_fft_code_data);
-    volk_free(d_fft_code_pilot);
-    volk_free(d_data_correlation);
-    volk_free(d_pilot_correlation);
-    volk_free(d_correlation_plus);
-    volk_free(d_correlation_minus);
     volk_free(d_magnitude);
 
-    delete d_ifft;
-    delete d_fft_if;
-
-    if (d_dump)
-        {
-            d_dump_file.close();
-        }
+    Fft_Plan_Cache::release(d_fft_if);
 }
 
 void pcps_cccwsr_acquisition_cc::set_local_code(std::complex<float>* code_data,
         std::complex<float>* code_pilot)
 {
+    // The FFTs of the local codes are shared with the channels searching for the same signal
     // Data code (E1B)
     memcpy(d_fft_if->get_inbuf(), code_data, sizeof(gr_complex) * d_fft_size);
-
-    d_fft_if->execute(); // We need the FFT of local code
-
-    //Conjugate the local code
-    volk_32fc_conjugate_32fc(d_fft_code_data,d_fft_if->get_outbuf(),d_fft_size);
+    d_code_fft_data = Acquisition_Cache::code_fft(d_gnss_synchro->System, d_gnss_synchro->Signal, d_gnss_synchro->PRN, d_fft_if);
+    d_search.statistic().fft_code_data = d_code_fft_data->get();
 
     // Pilot code (E1C)
     memcpy(d_fft_if->get_inbuf(), code_pilot, sizeof(gr_complex) * d_fft_size);
-
-    d_fft_if->execute(); // We need the FFT of local code
-
-    //Conjugate the local code,
-    volk_32fc_conjugate_32fc(d_fft_code_pilot, d_fft_if->get_outbuf(), d_fft_size);
+    d_code_fft_pilot = Acquisition_Cache::code_fft(d_gnss_synchro->System, d_gnss_synchro->Signal, d_gnss_synchro->PRN, d_fft_if);
+    d_search.statistic().fft_code_pilot = d_code_fft_pilot->get();
 }
 
 void pcps_cccwsr_acquisition_cc::init()
@@ -184,17 +224,8 @@ void pcps_cccwsr_acquisition_cc::init()
     }
 
     // Create the carrier Doppler wipeoff signals
-    d_grid_doppler_wipeoffs = new gr_complex*[d_num_doppler_bins];
-    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
-        {
-            d_grid_doppler_wipeoffs[doppler_index] = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
-
-            int doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * doppler_index;
-            float phase_step_rad = GPS_TWO_PI * (d_freq + doppler) / static_cast<float>(d_fs_in);
-            float _phase[1];
-            _phase[0] = 0;
-            volk_gnsssdr_s32f_sincos_32fc(d_grid_doppler_wipeoffs[doppler_index], - phase_step_rad, _phase, d_fft_size);
-        }
+    d_doppler_grid = Acquisition_Cache::doppler_wipeoff_grid(d_fs_in, d_freq, d_doppler_max, d_doppler_step, d_num_doppler_bins, d_fft_size);
+    d_search.set_grid(d_doppler_grid, d_doppler_max, d_doppler_step);
 }
 
 
@@ -224,9 +255,6 @@ int pcps_cccwsr_acquisition_cc::general_work(int noutput_items,
         gr_vector_int &ninput_items, gr_vector_const_void_star &input_items,
         gr_vector_void_star &output_items __attribute__((unused)))
 {
-
-    int acquisition_message = -1; //0=STOP_CHANNEL 1=ACQ_SUCCEES 2=ACQ_FAIL
-
     switch (d_state)
     {
     case 0:
@@ -253,22 +281,7 @@ int pcps_cccwsr_acquisition_cc::general_work(int noutput_items,
     case 1:
         {
             // initialize acquisition algorithm
-            int doppler;
-#if VOLK_GT_122
-            uint16_t indext = 0;
-            uint16_t indext_plus = 0;
-            uint16_t indext_minus = 0;
-#else
-
-            unsigned int indext = 0;
-            unsigned int indext_plus = 0;
-            unsigned int indext_minus = 0;
-#endif
-            float magt = 0.0;
-            float magt_plus = 0.0;
-            float magt_minus = 0.0;
             const gr_complex *in = (const gr_complex *)input_items[0]; //Get the input samples pointer
-            float fft_normalization_factor = static_cast<float>(d_fft_size) * static_cast<float>(d_fft_size);
 
             d_sample_counter += d_fft_size; // sample counter
 
@@ -285,98 +298,18 @@ int pcps_cccwsr_acquisition_cc::general_work(int noutput_items,
             volk_32f_accumulator_s32f(&d_input_power, d_magnitude, d_fft_size);
             d_input_power /= static_cast<float>(d_fft_size);
 
-            // 2- Doppler frequency search loop
-            for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
+            // 2- Doppler frequency search
+            d_search.search(d_sample_counter, in, d_fft_if);
+
+            // 4- record the maximum peak and the associated synchronization parameters
+            unsigned int best = d_search.best_line();
+            const Doppler_Line_Max& line = d_search.lines()[best];
+            if (d_mag < line.mag)
                 {
-                    // doppler search steps
-
-                    doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * doppler_index;
-
-                    volk_32fc_x2_multiply_32fc(d_fft_if->get_inbuf(), in,
-                                d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
-
-                    // 3- Perform the FFT-based convolution  (parallel time search)
-                    // Compute the FFT of the carrier wiped--off incoming signal
-                    d_fft_if->execute();
-
-                    // Multiply carrier wiped--off, Fourier transformed incoming signal
-                    // with the local FFT'd data code reference (E1B) using SIMD operations
-                    // with VOLK library
-                    volk_32fc_x2_multiply_32fc(d_ifft->get_inbuf(),
-                                d_fft_if->get_outbuf(), d_fft_code_data, d_fft_size);
-
-                    // compute the inverse FFT
-                    d_ifft->execute();
-
-                    // Copy the result of the correlation between wiped--off signal and data code in
-                    // d_data_correlation.
-                    memcpy(d_data_correlation, d_ifft->get_outbuf(), sizeof(gr_complex)*d_fft_size);
-
-                    // Multiply carrier wiped--off, Fourier transformed incoming signal
-                    // with the local FFT'd pilot code reference (E1C) using SIMD operations
-                    // with VOLK library
-                    volk_32fc_x2_multiply_32fc(d_ifft->get_inbuf(),
-                                d_fft_if->get_outbuf(), d_fft_code_pilot, d_fft_size);
-
-                    // Compute the inverse FFT
-                    d_ifft->execute();
-
-                    // Copy the result of the correlation between wiped--off signal and pilot code in
-                    // d_data_correlation.
-                    memcpy(d_pilot_correlation, d_ifft->get_outbuf(), sizeof(gr_complex)*d_fft_size);
-
-                    for (unsigned int i = 0; i < d_fft_size; i++)
-                        {
-                            d_correlation_plus[i] = std::complex<float>(
-                                                    d_data_correlation[i].real() - d_pilot_correlation[i].imag(),
-                                                    d_data_correlation[i].imag() + d_pilot_correlation[i].real());
-
-                            d_correlation_minus[i] = std::complex<float>(
-                                                     d_data_correlation[i].real() + d_pilot_correlation[i].imag(),
-                                                     d_data_correlation[i].imag() - d_pilot_correlation[i].real());
-                        }
-
-                    volk_32fc_magnitude_squared_32f(d_magnitude, d_correlation_plus, d_fft_size);
-                    volk_32f_index_max_16u(&indext_plus, d_magnitude, d_fft_size);
-                    magt_plus = d_magnitude[indext_plus] / (fft_normalization_factor * fft_normalization_factor);
-
-                    volk_32fc_magnitude_squared_32f(d_magnitude, d_correlation_minus, d_fft_size);
-                    volk_32f_index_max_16u(&indext_minus, d_magnitude, d_fft_size);
-                    magt_minus = d_magnitude[indext_minus] / (fft_normalization_factor * fft_normalization_factor);
-
-                    if (magt_plus >= magt_minus)
-                    {
-                        magt = magt_plus;
-                        indext = indext_plus;
-                    }
-                    else
-                    {
-                        magt = magt_minus;
-                        indext = indext_minus;
-                    }
-
-                    // 4- record the maximum peak and the associated synchronization parameters
-                    if (d_mag < magt)
-                        {
-                            d_mag = magt;
-                            d_gnss_synchro->Acq_delay_samples = static_cast<double>(indext % d_samples_per_code);
-                            d_gnss_synchro->Acq_doppler_hz = static_cast<double>(doppler);
-                            d_gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
-                        }
-
-                    // Record results to file if required
-                    if (d_dump)
-                        {
-                            std::stringstream filename;
-                            std::streamsize n = 2 * sizeof(float) * (d_fft_size); // complex file write
-                            filename.str("");
-                            filename << "../data/test_statistics_" << d_gnss_synchro->System
-                                     <<"_" << d_gnss_synchro->Signal << "_sat_"
-                                     << d_gnss_synchro->PRN << "_doppler_" <<  doppler << ".dat";
-                            d_dump_file.open(filename.str().c_str(), std::ios::out | std::ios::binary);
-                            d_dump_file.write((char*)d_ifft->get_outbuf(), n); //write directly |abs(x)|^2 in this Doppler bin?
-                            d_dump_file.close();
-                        }
+                    d_mag = line.mag;
+                    d_gnss_synchro->Acq_delay_samples = static_cast<double>(line.index % d_samples_per_code);
+                    d_gnss_synchro->Acq_doppler_hz = static_cast<double>(d_search.doppler(best));
+                    d_gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
                 }
 
             // 5- Compute the test statistics and compare to the threshold
@@ -417,8 +350,7 @@ int pcps_cccwsr_acquisition_cc::general_work(int noutput_items,
             d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
             consume_each(ninput_items[0]);
 
-            acquisition_message = 1;
-            this->message_port_pub(pmt::mp("events"), pmt::from_long(acquisition_message));
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_POSITIVE_ACQUISITION));
 
             break;
         }
@@ -442,8 +374,7 @@ int pcps_cccwsr_acquisition_cc::general_work(int noutput_items,
             d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
             consume_each(ninput_items[0]);
 
-            acquisition_message = 2;
-            this->message_port_pub(pmt::mp("events"), pmt::from_long(acquisition_message));
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_NEGATIVE_ACQUISITION));
 
             break;
         }
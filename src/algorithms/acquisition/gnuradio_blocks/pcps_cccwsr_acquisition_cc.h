@@ -37,16 +37,35 @@
 #ifndef GNSS_SDR_PCPS_CCCWSR_ACQUISITION_CC_H_
 #define GNSS_SDR_PCPS_CCCWSR_ACQUISITION_CC_H_
 
-#include <fstream>
+#include <memory>
 #include <string>
 #include <gnuradio/block.h>
 #include <gnuradio/gr_complex.h>
 #include <gnuradio/fft/fft.h>
 #include "gnss_synchro.h"
+#include "acquisition_cache.h"
+#include "pcps_search_core.h"
 
 
 class pcps_cccwsr_acquisition_cc;
 
+/*!
+ * \brief Statistic of the CCCWSR search: the data (E1B) and pilot (E1C)
+ * correlations are combined as data + j*pilot and data - j*pilot, and the
+ * greater normalized squared magnitude of the two is taken.
+ */
+struct Cccwsr_Statistic
+{
+    Cccwsr_Statistic() : fft_code_data(0), fft_code_pilot(0), fft_size(0) {}
+
+    const gr_complex* line(unsigned int doppler_index, const gr_complex* input_fft,
+            Acquisition_Scratch& scratch, Doppler_Line_Max& max) const;
+
+    const gr_complex* fft_code_data;
+    const gr_complex* fft_code_pilot;
+    unsigned int fft_size;
+};
+
 typedef boost::shared_ptr<pcps_cccwsr_acquisition_cc> pcps_cccwsr_acquisition_cc_sptr;
 
 pcps_cccwsr_acquisition_cc_sptr
@@ -90,24 +109,19 @@ private:
     unsigned int d_well_count;
     unsigned int d_fft_size;
     unsigned long int d_sample_counter;
-    gr_complex** d_grid_doppler_wipeoffs;
+    std::shared_ptr<const Doppler_Wipeoff_Grid> d_doppler_grid;
     unsigned int d_num_doppler_bins;
-    gr_complex* d_fft_code_data;
-    gr_complex* d_fft_code_pilot;
+    std::shared_ptr<const Code_Fft> d_code_fft_data;
+    std::shared_ptr<const Code_Fft> d_code_fft_pilot;
+    Pcps_Search_Core<Cccwsr_Statistic> d_search;
     gr::fft::fft_complex* d_fft_if;
-    gr::fft::fft_complex* d_ifft;
     Gnss_Synchro *d_gnss_synchro;
     unsigned int d_code_phase;
     float d_doppler_freq;
     float d_mag;
     float* d_magnitude;
-    gr_complex* d_data_correlation;
-    gr_complex* d_pilot_correlation;
-    gr_complex* d_correlation_plus;
-    gr_complex* d_correlation_minus;
     float d_input_power;
     float d_test_statistics;
-    std::ofstream d_dump_file;
     bool d_active;
     int d_state;
     bool d_dump;
@@ -129,6 +143,7 @@ public:
      void set_gnss_synchro(Gnss_Synchro* p_gnss_synchro)
      {
          d_gnss_synchro = p_gnss_synchro;
+         d_search.set_gnss_synchro(p_gnss_synchro);
      }
 
      /*!
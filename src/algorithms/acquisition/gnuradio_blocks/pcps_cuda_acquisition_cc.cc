@@ -0,0 +1,491 @@
+/*!
+ * \file pcps_cuda_acquisition_cc.cc
+ * \brief This class implements a Parallel Code Phase Search Acquisition
+ * that searches on a NVIDIA CUDA GPU, batched with the other channels.
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "pcps_cuda_acquisition_cc.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+#include <volk/volk.h>
+#include "fft_plan_cache.h"
+#include "channel_event.h"
+
+using google::LogMessage;
+
+namespace
+{
+struct Cuda_Batch
+{
+    unsigned long int sample_stamp;
+    unsigned long long fingerprint;
+    const gr_complex* in;
+    std::vector<const std::complex<float>*> code_ffts;
+    std::vector<Cuda_Line_Max*> lines; // one per code, of the joined blocks
+    bool done;
+    bool ok;
+};
+
+struct Cuda_Grid
+{
+    Cuda_Grid() : searchers(0) {}
+    cuda_acquisition gpu;
+    boost::mutex gpu_mutex;
+    unsigned int searchers; // blocks searching on this grid
+    std::shared_ptr<Cuda_Batch> open;
+};
+
+/*
+ * Gathers the searches of the blocks that acquire on the same grid into
+ * batches. The first block to search a dwell opens the batch and waits
+ * for the other searching blocks to join it (or for the wait time to
+ * expire), then runs it on the GPU for all of them.
+ */
+class Cuda_Acquisition_Batcher
+{
+public:
+    static Cuda_Acquisition_Batcher& instance()
+    {
+        static Cuda_Acquisition_Batcher batcher;
+        return batcher;
+    }
+
+    void add_searcher(const Cuda_Grid_Key& key, int count)
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        Cuda_Grid& grid = get_grid(key);
+        grid.searchers += count;
+        // a batch may now have all the blocks it waits for
+        d_condition.notify_all();
+    }
+
+    bool search(const Cuda_Grid_Key& key, unsigned int max_codes, unsigned int wait_us,
+            unsigned long int sample_stamp, const gr_complex* in, const gr_complex* code_fft, Cuda_Line_Max* lines)
+    {
+        unsigned long long fingerprint = Acquisition_Cache::fingerprint(in, key.fft_size);
+        boost::mutex::scoped_lock lock(d_mutex);
+        Cuda_Grid& grid = get_grid(key);
+        std::shared_ptr<Cuda_Batch> batch = grid.open;
+        if (batch && batch->sample_stamp == sample_stamp && batch->fingerprint == fingerprint
+                && batch->code_ffts.size() < max_codes)
+            {
+                batch->code_ffts.push_back(code_fft);
+                batch->lines.push_back(lines);
+                d_condition.notify_all();
+                while (!batch->done)
+                    {
+                        d_condition.wait(lock);
+                    }
+                return batch->ok;
+            }
+
+        batch = std::make_shared<Cuda_Batch>();
+        batch->sample_stamp = sample_stamp;
+        batch->fingerprint = fingerprint;
+        batch->in = in;
+        batch->code_ffts.push_back(code_fft);
+        batch->lines.push_back(lines);
+        batch->done = false;
+        batch->ok = false;
+        grid.open = batch;
+        boost::system_time deadline = boost::get_system_time() + boost::posix_time::microseconds(wait_us);
+        while (batch->code_ffts.size() < std::min(grid.searchers, max_codes))
+            {
+                if (!d_condition.timed_wait(lock, deadline))
+                    {
+                        break;
+                    }
+            }
+        if (grid.open == batch)
+            {
+                grid.open.reset();
+            }
+        lock.unlock();
+
+        std::vector<Cuda_Line_Max> results(batch->code_ffts.size() * key.num_doppler_bins);
+        bool ok;
+        {
+            boost::mutex::scoped_lock gpu_lock(grid.gpu_mutex);
+            if (grid.gpu.max_codes() == 0)
+                {
+                    std::vector<double> cycles_per_sample(key.num_doppler_bins);
+                    for (unsigned int doppler_index = 0; doppler_index < key.num_doppler_bins; doppler_index++)
+                        {
+                            int doppler = -static_cast<int>(key.doppler_max) + key.doppler_step * doppler_index;
+                            cycles_per_sample[doppler_index] = static_cast<double>(key.freq + doppler) / static_cast<double>(key.fs_in);
+                        }
+                    if (!grid.gpu.init_cuda(key.fft_size, key.num_doppler_bins, max_codes, &cycles_per_sample[0]))
+                        {
+                            LOG(ERROR) << "Cannot initialize the CUDA acquisition";
+                        }
+                }
+            ok = grid.gpu.search(batch->in, &batch->code_ffts[0], batch->code_ffts.size(), &results[0]);
+        }
+        DLOG(INFO) << "CUDA acquisition batch of " << batch->code_ffts.size() << " codes at sample stamp " << sample_stamp;
+
+        lock.lock();
+        for (unsigned int code = 0; code < batch->lines.size(); code++)
+            {
+                std::copy(results.begin() + code * key.num_doppler_bins, results.begin() + (code + 1) * key.num_doppler_bins,
+                        batch->lines[code]);
+            }
+        batch->ok = ok;
+        batch->done = true;
+        d_condition.notify_all();
+        return ok;
+    }
+
+private:
+    Cuda_Grid& get_grid(const Cuda_Grid_Key& key)
+    {
+        std::unique_ptr<Cuda_Grid>& grid = d_grids[key];
+        if (!grid)
+            {
+                grid.reset(new Cuda_Grid());
+            }
+        return *grid;
+    }
+
+    boost::mutex d_mutex;
+    boost::condition_variable d_condition;
+    std::map<Cuda_Grid_Key, std::unique_ptr<Cuda_Grid> > d_grids;
+};
+}
+
+
+pcps_cuda_acquisition_cc_sptr pcps_make_cuda_acquisition_cc(
+                                 unsigned int sampled_ms, unsigned int max_dwells,
+                                 unsigned int doppler_max, long freq, long fs_in,
+                                 int samples_per_ms, int samples_per_code,
+                                 bool use_CFAR_algorithm_flag,
+                                 unsigned int max_batch_codes, unsigned int batch_wait_us)
+{
+    return pcps_cuda_acquisition_cc_sptr(
+            new pcps_cuda_acquisition_cc(sampled_ms, max_dwells, doppler_max, freq, fs_in, samples_per_ms,
+                                     samples_per_code, use_CFAR_algorithm_flag, max_batch_codes, batch_wait_us));
+}
+
+
+pcps_cuda_acquisition_cc::pcps_cuda_acquisition_cc(
+                         unsigned int sampled_ms, unsigned int max_dwells,
+                         unsigned int doppler_max, long freq, long fs_in,
+                         int samples_per_ms, int samples_per_code,
+                         bool use_CFAR_algorithm_flag,
+                         unsigned int max_batch_codes, unsigned int batch_wait_us) :
+    gr::block("pcps_cuda_acquisition_cc",
+    gr::io_signature::make(1, 1, sizeof(gr_complex) * sampled_ms * samples_per_ms),
+    gr::io_signature::make(0, 0, 0))
+{
+    this->message_port_register_out(pmt::mp("events"));
+    d_sample_counter = 0;    // SAMPLE COUNTER
+    d_active = false;
+    d_state = 0;
+    d_freq = freq;
+    d_fs_in = fs_in;
+    d_samples_per_ms = samples_per_ms;
+    d_samples_per_code = samples_per_code;
+    d_sampled_ms = sampled_ms;
+    d_max_dwells = max_dwells;
+    d_well_count = 0;
+    d_doppler_max = doppler_max;
+    d_fft_size = d_sampled_ms * d_samples_per_ms;
+    d_mag = 0;
+    d_input_power = 0.0;
+    d_num_doppler_bins = 0;
+    d_use_CFAR_algorithm_flag = use_CFAR_algorithm_flag;
+    d_threshold = 0.0;
+    d_doppler_step = 0;
+    d_test_statistics = 0.0;
+    d_channel = 0;
+    d_max_batch_codes = max_batch_codes;
+    d_batch_wait_us = batch_wait_us;
+    d_searching = false;
+
+    d_magnitude = static_cast<float*>(volk_malloc(d_fft_size * sizeof(float), volk_get_alignment()));
+
+    // Direct FFT, only for the code FFT: the search runs on the GPU
+    d_fft_if = Fft_Plan_Cache::acquire(d_fft_size, true);
+
+    d_gnss_synchro = 0;
+}
+
+
+pcps_cuda_acquisition_cc::~pcps_cuda_acquisition_cc()
+{
+    set_searching(false);
+    volk_free(d_magnitude);
+    Fft_Plan_Cache::release(d_fft_if);
+}
+
+
+void pcps_cuda_acquisition_cc::set_searching(bool searching)
+{
+    if (searching == d_searching || d_num_doppler_bins == 0)
+        {
+            return;
+        }
+    if (searching)
+        {
+            Cuda_Grid_Key key = {d_fs_in, d_freq, d_doppler_max, d_doppler_step, d_num_doppler_bins, d_fft_size};
+            d_searching_key = key;
+        }
+    // always with the key it was counted with, the Doppler parameters may have changed since
+    Cuda_Acquisition_Batcher::instance().add_searcher(d_searching_key, searching ? 1 : -1);
+    d_searching = searching;
+}
+
+
+void pcps_cuda_acquisition_cc::set_local_code(std::complex<float> * code)
+{
+    memcpy(d_fft_if->get_inbuf(), code, sizeof(gr_complex) * d_fft_size);
+    // The FFT of the local code is shared with the channels searching for the same signal
+    d_code_fft = Acquisition_Cache::code_fft(d_gnss_synchro->System, d_gnss_synchro->Signal, d_gnss_synchro->PRN, d_fft_if);
+}
+
+
+void pcps_cuda_acquisition_cc::init()
+{
+    d_gnss_synchro->Flag_valid_acquisition = false;
+    d_gnss_synchro->Flag_valid_symbol_output = false;
+    d_gnss_synchro->Flag_valid_pseudorange = false;
+    d_gnss_synchro->Flag_valid_word = false;
+    d_gnss_synchro->Flag_preamble = false;
+
+    d_gnss_synchro->Acq_delay_samples = 0.0;
+    d_gnss_synchro->Acq_doppler_hz = 0.0;
+    d_gnss_synchro->Acq_samplestamp_samples = 0;
+    d_mag = 0.0;
+    d_input_power = 0.0;
+
+    // the grid may change: the block is counted again when it searches
+    set_searching(false);
+    d_num_doppler_bins = ceil( static_cast<double>(static_cast<int>(d_doppler_max) - static_cast<int>(-d_doppler_max)) / static_cast<double>(d_doppler_step));
+    d_lines.resize(d_num_doppler_bins);
+}
+
+
+void pcps_cuda_acquisition_cc::set_state(int state)
+{
+    d_state = state;
+    if (d_state == 1)
+        {
+            d_gnss_synchro->Acq_delay_samples = 0.0;
+            d_gnss_synchro->Acq_doppler_hz = 0.0;
+            d_gnss_synchro->Acq_samplestamp_samples = 0;
+            d_well_count = 0;
+            d_mag = 0.0;
+            d_input_power = 0.0;
+            d_test_statistics = 0.0;
+            set_searching(true);
+        }
+    else if (d_state == 0)
+        {
+            set_searching(false);
+        }
+    else
+        {
+            LOG(ERROR) << "State can only be set to 0 or 1";
+        }
+}
+
+
+int pcps_cuda_acquisition_cc::general_work(int noutput_items,
+        gr_vector_int &ninput_items, gr_vector_const_void_star &input_items,
+        gr_vector_void_star &output_items __attribute__((unused)))
+{
+
+    switch (d_state)
+    {
+    case 0:
+        {
+            if (d_active)
+                {
+                    //restart acquisition variables
+                    d_gnss_synchro->Acq_delay_samples = 0.0;
+                    d_gnss_synchro->Acq_doppler_hz = 0.0;
+                    d_gnss_synchro->Acq_samplestamp_samples = 0;
+                    d_well_count = 0;
+                    d_mag = 0.0;
+                    d_input_power = 0.0;
+                    d_test_statistics = 0.0;
+
+                    d_state = 1;
+                    set_searching(true);
+                }
+
+            d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
+            consume_each(ninput_items[0]);
+
+            break;
+        }
+
+    case 1:
+        {
+            const gr_complex *in = (const gr_complex *)input_items[0]; //Get the input samples pointer
+            float fft_normalization_factor = static_cast<float>(d_fft_size) * static_cast<float>(d_fft_size);
+
+            d_input_power = 0.0;
+            d_mag = 0.0;
+
+            d_sample_counter += d_fft_size; // sample counter
+
+            d_well_count++;
+
+            DLOG(INFO) << "Channel: " << d_channel
+                    << " , doing acquisition of satellite: " << d_gnss_synchro->System << " " << d_gnss_synchro->PRN
+                    << " ,sample stamp: " << d_sample_counter << ", threshold: "
+                    << d_threshold << ", doppler_max: " << d_doppler_max
+                    << ", doppler_step: " << d_doppler_step;
+
+            if (d_use_CFAR_algorithm_flag == true)
+                {
+                    // 1- (optional) Compute the input signal power estimation
+                    volk_32fc_magnitude_squared_32f(d_magnitude, in, d_fft_size);
+                    volk_32f_accumulator_s32f(&d_input_power, d_magnitude, d_fft_size);
+                    d_input_power /= static_cast<float>(d_fft_size);
+                }
+
+            // 2- and 3- Doppler search and FFT-based convolution on the GPU, with the other channels
+            Cuda_Grid_Key key = {d_fs_in, d_freq, d_doppler_max, d_doppler_step, d_num_doppler_bins, d_fft_size};
+            if (!Cuda_Acquisition_Batcher::instance().search(key, d_max_batch_codes, d_batch_wait_us,
+                    d_sample_counter, in, d_code_fft->get(), &d_lines[0]))
+                {
+                    LOG(WARNING) << "CUDA acquisition of satellite " << d_gnss_synchro->PRN << " failed";
+                    set_searching(false);
+                    d_state = 3; // Negative acquisition
+                    consume_each(1);
+                    break;
+                }
+
+            for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
+                {
+                    int doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * doppler_index;
+                    const Cuda_Line_Max& line = d_lines[doppler_index];
+                    float magt = line.mag;
+
+                    if (d_use_CFAR_algorithm_flag == true)
+                        {
+                            // Normalize the maximum value to correct the scale factor introduced by the FFTs
+                            magt = line.mag / (fft_normalization_factor * fft_normalization_factor);
+                        }
+
+                    // 4- record the maximum peak and the associated synchronization parameters
+                    if (d_mag < magt)
+                        {
+                            d_mag = magt;
+
+                            if (d_use_CFAR_algorithm_flag == false)
+                                {
+                                    // Search grid noise floor approximation for this doppler line
+                                    d_input_power = (line.power - d_mag) / (d_fft_size - 1);
+                                }
+
+                            d_gnss_synchro->Acq_delay_samples = static_cast<double>(line.index % d_samples_per_code);
+                            d_gnss_synchro->Acq_doppler_hz = static_cast<double>(doppler);
+                            d_gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
+
+                            // 5- Compute the test statistics and compare to the threshold
+                            d_test_statistics = d_mag / d_input_power;
+                        }
+                }
+
+            if (d_test_statistics > d_threshold)
+                {
+                    d_state = 2; // Positive acquisition
+                    set_searching(false);
+                }
+            else if (d_well_count == d_max_dwells)
+                {
+                    d_state = 3; // Negative acquisition
+                    set_searching(false);
+                }
+
+            consume_each(1);
+
+            DLOG(INFO) << "Done. Consumed 1 item.";
+
+            break;
+        }
+
+    case 2:
+        {
+            // 6.1- Declare positive acquisition using a message port
+            DLOG(INFO) << "positive acquisition";
+            DLOG(INFO) << "satellite " << d_gnss_synchro->System << " " << d_gnss_synchro->PRN;
+            DLOG(INFO) << "sample_stamp " << d_sample_counter;
+            DLOG(INFO) << "test statistics value " << d_test_statistics;
+            DLOG(INFO) << "test statistics threshold " << d_threshold;
+            DLOG(INFO) << "code phase " << d_gnss_synchro->Acq_delay_samples;
+            DLOG(INFO) << "doppler " << d_gnss_synchro->Acq_doppler_hz;
+            DLOG(INFO) << "magnitude " << d_mag;
+            DLOG(INFO) << "input signal power " << d_input_power;
+
+            d_active = false;
+            d_state = 0;
+            d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
+            consume_each(ninput_items[0]);
+
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_POSITIVE_ACQUISITION));
+
+            break;
+        }
+
+    case 3:
+        {
+            // 6.2- Declare negative acquisition using a message port
+            DLOG(INFO) << "negative acquisition";
+            DLOG(INFO) << "satellite " << d_gnss_synchro->System << " " << d_gnss_synchro->PRN;
+            DLOG(INFO) << "sample_stamp " << d_sample_counter;
+            DLOG(INFO) << "test statistics value " << d_test_statistics;
+            DLOG(INFO) << "test statistics threshold " << d_threshold;
+            DLOG(INFO) << "code phase " << d_gnss_synchro->Acq_delay_samples;
+            DLOG(INFO) << "doppler " << d_gnss_synchro->Acq_doppler_hz;
+            DLOG(INFO) << "magnitude " << d_mag;
+            DLOG(INFO) << "input signal power " << d_input_power;
+
+            d_active = false;
+            d_state = 0;
+
+            d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
+            consume_each(ninput_items[0]);
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_NEGATIVE_ACQUISITION));
+
+            break;
+        }
+    }
+
+    return noutput_items;
+}
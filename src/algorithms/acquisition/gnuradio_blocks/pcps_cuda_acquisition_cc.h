@@ -0,0 +1,235 @@
+/*!
+ * \file pcps_cuda_acquisition_cc.h
+ * \brief This class implements a Parallel Code Phase Search Acquisition
+ * that searches on a NVIDIA CUDA GPU, batched with the other channels.
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PCPS_CUDA_ACQUISITION_CC_H_
+#define GNSS_SDR_PCPS_CUDA_ACQUISITION_CC_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <gnuradio/block.h>
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/fft/fft.h>
+#include "gnss_synchro.h"
+#include "acquisition_cache.h"
+#include "cuda_acquisition.h"
+
+class pcps_cuda_acquisition_cc;
+
+typedef boost::shared_ptr<pcps_cuda_acquisition_cc> pcps_cuda_acquisition_cc_sptr;
+
+pcps_cuda_acquisition_cc_sptr
+pcps_make_cuda_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
+                         unsigned int doppler_max, long freq, long fs_in,
+                         int samples_per_ms, int samples_per_code,
+                         bool use_CFAR_algorithm_flag,
+                         unsigned int max_batch_codes, unsigned int batch_wait_us);
+
+/*!
+ * \brief Search grid of a CUDA acquisition: the blocks with the same one are batched together.
+ */
+struct Cuda_Grid_Key
+{
+    long fs_in;
+    long freq;
+    unsigned int doppler_max;
+    unsigned int doppler_step;
+    unsigned int num_doppler_bins;
+    unsigned int fft_size;
+
+    bool operator<(const Cuda_Grid_Key& other) const
+    {
+        if (fs_in != other.fs_in) return fs_in < other.fs_in;
+        if (freq != other.freq) return freq < other.freq;
+        if (doppler_max != other.doppler_max) return doppler_max < other.doppler_max;
+        if (doppler_step != other.doppler_step) return doppler_step < other.doppler_step;
+        if (num_doppler_bins != other.num_doppler_bins) return num_doppler_bins < other.num_doppler_bins;
+        return fft_size < other.fft_size;
+    }
+};
+
+
+/*!
+ * \brief This class implements a Parallel Code Phase Search Acquisition on a CUDA GPU.
+ *
+ * The search is the one of pcps_acquisition_cc, but the blocks do not
+ * search on their own: all the blocks that search the same dwell with the
+ * same grid are gathered into one batch (see cuda_acquisition), which runs
+ * on the GPU when all the searching blocks have joined it or after
+ * batch_wait_us, whatever comes first. The bit transition mode is not
+ * implemented.
+ */
+class pcps_cuda_acquisition_cc: public gr::block
+{
+private:
+    friend pcps_cuda_acquisition_cc_sptr
+    pcps_make_cuda_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
+            unsigned int doppler_max, long freq, long fs_in,
+            int samples_per_ms, int samples_per_code,
+            bool use_CFAR_algorithm_flag,
+            unsigned int max_batch_codes, unsigned int batch_wait_us);
+
+    pcps_cuda_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
+            unsigned int doppler_max, long freq, long fs_in,
+            int samples_per_ms, int samples_per_code,
+            bool use_CFAR_algorithm_flag,
+            unsigned int max_batch_codes, unsigned int batch_wait_us);
+
+    void set_searching(bool searching);
+
+    long d_fs_in;
+    long d_freq;
+    int d_samples_per_ms;
+    int d_samples_per_code;
+    float d_threshold;
+    unsigned int d_doppler_max;
+    unsigned int d_doppler_step;
+    unsigned int d_sampled_ms;
+    unsigned int d_max_dwells;
+    unsigned int d_well_count;
+    unsigned int d_fft_size;
+    unsigned long int d_sample_counter;
+    unsigned int d_num_doppler_bins;
+    std::shared_ptr<const Code_Fft> d_code_fft;
+    gr::fft::fft_complex* d_fft_if;
+    Gnss_Synchro *d_gnss_synchro;
+    float d_mag;
+    float* d_magnitude;
+    float d_input_power;
+    float d_test_statistics;
+    bool d_use_CFAR_algorithm_flag;
+    bool d_active;
+    int d_state;
+    unsigned int d_channel;
+    unsigned int d_max_batch_codes;
+    unsigned int d_batch_wait_us;
+    bool d_searching; // counted in the searchers of the grid
+    Cuda_Grid_Key d_searching_key;
+    std::vector<Cuda_Line_Max> d_lines;
+
+public:
+    /*!
+     * \brief Default destructor.
+     */
+     ~pcps_cuda_acquisition_cc();
+
+     /*!
+      * \brief Set acquisition/tracking common Gnss_Synchro object pointer
+      * to exchange synchronization data between acquisition and tracking blocks.
+      * \param p_gnss_synchro Satellite information shared by the processing blocks.
+      */
+     void set_gnss_synchro(Gnss_Synchro* p_gnss_synchro)
+     {
+         d_gnss_synchro = p_gnss_synchro;
+     }
+
+     /*!
+      * \brief Returns the maximum peak of grid search.
+      */
+     unsigned int mag()
+     {
+         return d_mag;
+     }
+
+     /*!
+      * \brief Initializes acquisition algorithm.
+      */
+     void init();
+
+     /*!
+      * \brief Sets local code for PCPS acquisition algorithm.
+      * \param code - Pointer to the PRN code.
+      */
+     void set_local_code(std::complex<float> * code);
+
+     /*!
+      * \brief Starts acquisition algorithm, turning from standby mode to
+      * active mode
+      * \param active - bool that activates/deactivates the block.
+      */
+     void set_active(bool active)
+     {
+         d_active = active;
+     }
+
+     /*!
+      * \brief If set to 1, ensures that acquisition starts at the
+      * first available sample.
+      * \param state - int=1 forces start of acquisition
+      */
+     void set_state(int state);
+
+     /*!
+      * \brief Set acquisition channel unique ID
+      * \param channel - receiver channel.
+      */
+     void set_channel(unsigned int channel)
+     {
+         d_channel = channel;
+     }
+
+     /*!
+      * \brief Set statistics threshold of PCPS algorithm.
+      * \param threshold - Threshold for signal detection (check \ref Navitec2012,
+      * Algorithm 1, for a definition of this threshold).
+      */
+     void set_threshold(float threshold)
+     {
+         d_threshold = threshold;
+     }
+
+     /*!
+      * \brief Set maximum Doppler grid search
+      * \param doppler_max - Maximum Doppler shift considered in the grid search [Hz].
+      */
+     void set_doppler_max(unsigned int doppler_max)
+     {
+         d_doppler_max = doppler_max;
+     }
+
+     /*!
+      * \brief Set Doppler steps for the grid search
+      * \param doppler_step - Frequency bin of the search grid [Hz].
+      */
+     void set_doppler_step(unsigned int doppler_step)
+     {
+         d_doppler_step = doppler_step;
+     }
+
+     /*!
+      * \brief Parallel Code Phase Search Acquisition signal processing.
+      */
+     int general_work(int noutput_items, gr_vector_int &ninput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+};
+
+#endif /* GNSS_SDR_PCPS_CUDA_ACQUISITION_CC_H_*/
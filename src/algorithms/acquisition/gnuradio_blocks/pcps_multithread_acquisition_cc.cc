@@ -33,15 +33,17 @@
  */
 
 #include "pcps_multithread_acquisition_cc.h"
-#include <sstream>
+#include <boost/bind.hpp>
 #include <boost/thread/mutex.hpp>
-#include <boost/thread/thread.hpp>
 #include <glog/logging.h>
 #include <gnuradio/io_signature.h>
 #include <volk/volk.h>
 #include <volk_gnsssdr/volk_gnsssdr.h>
 #include "control_message_factory.h"
+#include "fft_plan_cache.h"
+#include "acquisition_thread_pool.h"
 #include "GPS_L1_CA.h" //GPS_TWO_PI
+#include "channel_event.h"
 
 using google::LogMessage;
 
@@ -97,23 +99,27 @@ pcps_multithread_acquisition_cc::pcps_multithread_acquisition_cc(
         {
             d_in_buffer[i] = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
         }
-    d_fft_codes = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
     d_magnitude = static_cast<float*>(volk_malloc(d_fft_size * sizeof(float), volk_get_alignment()));
 
     // Direct FFT
-    d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
+    d_fft_if = Fft_Plan_Cache::acquire(d_fft_size, true);
 
     // Inverse FFT
-    d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+    d_ifft = Fft_Plan_Cache::acquire(d_fft_size, false);
 
     // For dumping samples into a file
     d_dump = dump;
     d_dump_filename = dump_filename;
+    if (d_dump)
+        {
+            d_grid_dump.reset(new Acquisition_Grid_Dump(d_dump_filename));
+        }
 
     d_doppler_resolution = 0;
     d_threshold = 0;
     d_doppler_step = 0;
     d_grid_doppler_wipeoffs = 0;
+    d_fft_codes = 0;
     d_gnss_synchro = 0;
     d_code_phase = 0;
     d_doppler_freq = 0;
@@ -123,26 +129,16 @@ pcps_multithread_acquisition_cc::pcps_multithread_acquisition_cc(
 
 pcps_multithread_acquisition_cc::~pcps_multithread_acquisition_cc()
 {
-    if (d_num_doppler_bins > 0)
-        {
-            for (unsigned int i = 0; i < d_num_doppler_bins; i++)
-                {
-                    volk_free(d_grid_doppler_wipeoffs[i]);
-                }
-            delete[] d_grid_doppler_wipeoffs;
-        }
-
     for (unsigned int i = 0; i < d_max_dwells; i++)
         {
             volk_free(d_in_buffer[i]);
         }
     delete[] d_in_buffer;
 
-    volk_free(d_fft_codes);
     volk_free(d_magnitude);
 
-    delete d_ifft;
-    delete d_fft_if;
+    Fft_Plan_Cache::release(d_ifft);
+    Fft_Plan_Cache::release(d_fft_if);
 
     if (d_dump)
         {
@@ -174,26 +170,17 @@ void pcps_multithread_acquisition_cc::init()
     }
 
     // Create the carrier Doppler wipeoff signals
-    d_grid_doppler_wipeoffs = new gr_complex*[d_num_doppler_bins];
-    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
-        {
-            d_grid_doppler_wipeoffs[doppler_index] = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
-            int doppler = -(int)d_doppler_max + d_doppler_step * doppler_index;
-            float phase_step_rad = static_cast<float>(GPS_TWO_PI) * (d_freq + doppler) / static_cast<float>(d_fs_in);
-            float _phase[1];
-            _phase[0] = 0;
-            volk_gnsssdr_s32f_sincos_32fc(d_grid_doppler_wipeoffs[doppler_index], - phase_step_rad, _phase, d_fft_size);
-        }
+    d_doppler_grid = Acquisition_Cache::doppler_wipeoff_grid(d_fs_in, d_freq, d_doppler_max, d_doppler_step, d_num_doppler_bins, d_fft_size);
+    d_grid_doppler_wipeoffs = d_doppler_grid->wipeoffs();
 }
 
 void pcps_multithread_acquisition_cc::set_local_code(std::complex<float> * code)
 {
     memcpy(d_fft_if->get_inbuf(), code, sizeof(gr_complex)*d_fft_size);
 
-    d_fft_if->execute(); // We need the FFT of local code
-
-    //Conjugate the local code
-    volk_32fc_conjugate_32fc(d_fft_codes, d_fft_if->get_outbuf(), d_fft_size);
+    // The FFT of the local code is shared with the channels searching for the same signal
+    d_code_fft = Acquisition_Cache::code_fft(d_gnss_synchro->System, d_gnss_synchro->Signal, d_gnss_synchro->PRN, d_fft_if);
+    d_fft_codes = d_code_fft->get();
 }
 
 void pcps_multithread_acquisition_cc::acquisition_core()
@@ -226,6 +213,11 @@ void pcps_multithread_acquisition_cc::acquisition_core()
     volk_32f_accumulator_s32f(&d_input_power, d_magnitude, d_fft_size);
     d_input_power /= (float)d_fft_size;
 
+    if (d_grid_dump)
+        {
+            d_grid_dump->begin(*d_gnss_synchro, d_channel, samplestamp, d_fs_in, -static_cast<int>(d_doppler_max),
+                    d_doppler_step, d_num_doppler_bins, d_fft_size);
+        }
     // 2- Doppler frequency search loop
     for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
         {
@@ -280,19 +272,15 @@ void pcps_multithread_acquisition_cc::acquisition_core()
                 }
 
             // Record results to file if required
-            if (d_dump)
+            if (d_grid_dump)
                 {
-                    std::stringstream filename;
-                    std::streamsize n = 2 * sizeof(float) * (d_fft_size); // complex file write
-                    filename.str("");
-                    filename << "../data/test_statistics_" << d_gnss_synchro->System
-                             <<"_" << d_gnss_synchro->Signal << "_sat_"
-                             << d_gnss_synchro->PRN << "_doppler_" <<  doppler << ".dat";
-                    d_dump_file.open(filename.str().c_str(), std::ios::out | std::ios::binary);
-                    d_dump_file.write((char*)d_ifft->get_outbuf(), n); //write directly |abs(x)|^2 in this Doppler bin?
-                    d_dump_file.close();
+                    d_grid_dump->write_line(doppler_index, d_magnitude);
                 }
         }
+    if (d_grid_dump)
+        {
+            d_grid_dump->end();
+        }
 
     if (!d_bit_transition_flag)
         {
@@ -354,9 +342,6 @@ int pcps_multithread_acquisition_cc::general_work(int noutput_items,
         gr_vector_int &ninput_items, gr_vector_const_void_star &input_items,
         gr_vector_void_star &output_items __attribute__((unused)))
 {
-
-    int acquisition_message = -1; //0=STOP_CHANNEL 1=ACQ_SUCCEES 2=ACQ_FAIL
-
     switch (d_state)
     {
     case 0:
@@ -422,7 +407,7 @@ int pcps_multithread_acquisition_cc::general_work(int noutput_items,
             if ((d_well_count < d_in_dwell_count) && !d_core_working && d_state==1)
                 {
                     d_core_working = true;
-                    boost::thread(&pcps_multithread_acquisition_cc::acquisition_core, this);
+                    Acquisition_Thread_Pool::instance().submit(boost::bind(&pcps_multithread_acquisition_cc::acquisition_core, this));
                 }
 
             break;
@@ -446,8 +431,7 @@ int pcps_multithread_acquisition_cc::general_work(int noutput_items,
 
             d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
 
-            acquisition_message = 1;
-            this->message_port_pub(pmt::mp("events"), pmt::from_long(acquisition_message));
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_POSITIVE_ACQUISITION));
 
             break;
         }
@@ -470,8 +454,7 @@ int pcps_multithread_acquisition_cc::general_work(int noutput_items,
 
             d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
 
-            acquisition_message = 2;
-            this->message_port_pub(pmt::mp("events"), pmt::from_long(acquisition_message));
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_NEGATIVE_ACQUISITION));
 
             break;
         }
@@ -52,12 +52,15 @@
 
 #include <algorithm>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 #include <gnuradio/block.h>
 #include <gnuradio/gr_complex.h>
 #include <gnuradio/fft/fft.h>
 #include "gnss_synchro.h"
+#include "acquisition_cache.h"
+#include "acquisition_grid_dump.h"
 
 class pcps_multithread_acquisition_cc;
 
@@ -114,9 +117,11 @@ private:
     unsigned int d_well_count;
     unsigned int d_fft_size;
     unsigned long int d_sample_counter;
-    gr_complex** d_grid_doppler_wipeoffs;
+    std::shared_ptr<const Doppler_Wipeoff_Grid> d_doppler_grid;
+    const gr_complex* const* d_grid_doppler_wipeoffs;
     unsigned int d_num_doppler_bins;
-    gr_complex* d_fft_codes;
+    std::shared_ptr<const Code_Fft> d_code_fft;
+    const gr_complex* d_fft_codes;
     gr::fft::fft_complex* d_fft_if;
     gr::fft::fft_complex* d_ifft;
     Gnss_Synchro *d_gnss_synchro;
@@ -134,6 +139,7 @@ private:
     bool d_dump;
     unsigned int d_channel;
     std::string d_dump_filename;
+    std::unique_ptr<Acquisition_Grid_Dump> d_grid_dump;
     unsigned int d_peak;
     gr_complex** d_in_buffer;
     std::vector<unsigned long int> d_sample_counter_buffer;
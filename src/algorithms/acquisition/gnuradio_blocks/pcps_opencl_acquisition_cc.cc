@@ -52,15 +52,18 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
-#include <sstream>
 #include <glog/logging.h>
 #include <gnuradio/io_signature.h>
 #include <volk/volk.h>
 #include <volk_gnsssdr/volk_gnsssdr.h>
 #include "control_message_factory.h"
+#include "fft_plan_cache.h"
 #include "fft_base_kernels.h"
 #include "fft_internal.h"
 #include "GPS_L1_CA.h" //GPS_TWO_PI
+#include "channel_event.h"
+#include "opencl_environment.h"
+#include "opencl_program_cache.h"
 
 
 using google::LogMessage;
@@ -131,15 +134,19 @@ pcps_opencl_acquisition_cc::pcps_opencl_acquisition_cc(
     if (d_opencl != 0)
     {
         // Direct FFT
-        d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
+        d_fft_if = Fft_Plan_Cache::acquire(d_fft_size, true);
 
         // Inverse FFT
-        d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+        d_ifft = Fft_Plan_Cache::acquire(d_fft_size, false);
     }
 
     // For dumping samples into a file
     d_dump = dump;
     d_dump_filename = dump_filename;
+    if (d_dump)
+        {
+            d_grid_dump.reset(new Acquisition_Grid_Dump(d_dump_filename));
+        }
 
 }
 
@@ -183,8 +190,8 @@ pcps_opencl_acquisition_cc::~pcps_opencl_acquisition_cc()
         }
     else
         {
-            delete d_ifft;
-            delete d_fft_if;
+            Fft_Plan_Cache::release(d_ifft);
+            Fft_Plan_Cache::release(d_fft_if);
         }
 
     if (d_dump)
@@ -197,40 +204,17 @@ pcps_opencl_acquisition_cc::~pcps_opencl_acquisition_cc()
 
 int pcps_opencl_acquisition_cc::init_opencl_environment(std::string kernel_filename)
 {
-    //get all platforms (drivers)
-    std::vector<cl::Platform> all_platforms;
-    cl::Platform::get(&all_platforms);
-
-    if(all_platforms.size()==0)
+    // context and queues shared with the other channels
+    Opencl_Environment& environment = Opencl_Environment::instance();
+    if (environment.status() != 0)
     {
-        std::cout << "No OpenCL platforms found. Check OpenCL installation!" << std::endl;
-        return 1;
+        return environment.status();
     }
+    d_cl_platform = environment.platform();
+    d_cl_device = environment.device();
+    d_cl_context = environment.context();
 
-    d_cl_platform = all_platforms[0]; //get default platform
-    std::cout << "Using platform: " << d_cl_platform.getInfo<CL_PLATFORM_NAME>()
-              << std::endl;
-
-    //get default GPU device of the default platform
-    std::vector<cl::Device> gpu_devices;
-    d_cl_platform.getDevices(CL_DEVICE_TYPE_GPU, &gpu_devices);
-
-    if(gpu_devices.size()==0)
-    {
-        std::cout << "No GPU devices found. Check OpenCL installation!" << std::endl;
-        return 2;
-    }
-
-    d_cl_device = gpu_devices[0];
-
-    std::vector<cl::Device> device;
-    device.push_back(d_cl_device);
-    std::cout << "Using device: " << d_cl_device.getInfo<CL_DEVICE_NAME>() << std::endl;
-
-    cl::Context context(device);
-    d_cl_context = context;
-
-    // build the program from the source in the file
+    // build the program from the source in the file, or take the one built by another channel
     std::ifstream kernel_file(kernel_filename, std::ifstream::in);
     std::string kernel_code(std::istreambuf_iterator<char>(kernel_file),
         (std::istreambuf_iterator<char>()));
@@ -238,19 +222,21 @@ int pcps_opencl_acquisition_cc::init_opencl_environment(std::string kernel_filen
 
     // std::cout << "Kernel code: \n" << kernel_code << std::endl;
 
-    cl::Program::Sources sources;
-
-    sources.push_back({kernel_code.c_str(),kernel_code.length()});
-
-    cl::Program program(context,sources);
-    if(program.build(device)!=CL_SUCCESS)
+    cl_int build_err;
+    cl_program program = Opencl_Program_Cache::build(d_cl_context(), d_cl_device(), kernel_code, "", &build_err);
+    if (program == 0)
+    {
+        std::cout << " Error creating the OpenCL program" << std::endl;
+        return 3;
+    }
+    d_cl_program = cl::Program(program);
+    if (build_err != CL_SUCCESS)
     {
         std::cout << " Error building: "
-                  << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(device[0])
+                  << d_cl_program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(d_cl_device)
                   << std::endl;
         return 3;
     }
-    d_cl_program = program;
 
     // create buffers on the device
     d_cl_buffer_in = new cl::Buffer(d_cl_context, CL_MEM_READ_WRITE, sizeof(gr_complex)*d_fft_size);
@@ -259,8 +245,8 @@ int pcps_opencl_acquisition_cc::init_opencl_environment(std::string kernel_filen
     d_cl_buffer_2 = new cl::Buffer(d_cl_context, CL_MEM_READ_WRITE, sizeof(gr_complex)*d_fft_size_pow2);
     d_cl_buffer_magnitude = new cl::Buffer(d_cl_context, CL_MEM_READ_WRITE, sizeof(float)*d_fft_size);
 
-    //create queue to which we will push commands for the device.
-    d_cl_queue = new cl::CommandQueue(d_cl_context,d_cl_device);
+    //take the queue to which we will push commands for the device.
+    d_cl_queue = new cl::CommandQueue(environment.queue());
 
     //create FFT plan
     cl_int err;
@@ -325,7 +311,7 @@ void pcps_opencl_acquisition_cc::init()
             float phase_step_rad = static_cast<float>(GPS_TWO_PI) * (d_freq + doppler) / static_cast<float>(d_fs_in);
             float _phase[1];
             _phase[0] = 0;
-            volk_gnsssdr_s32f_sincos_32fc(d_grid_doppler_wipeoffs[doppler_index], - phase_step_rad, _phase, d_fft_size);
+            volk_gnsssdr_s32f_nco_32fc(d_grid_doppler_wipeoffs[doppler_index], - phase_step_rad, _phase, d_fft_size);
 
             if (d_opencl == 0)
                 {
@@ -412,6 +398,11 @@ void pcps_opencl_acquisition_cc::acquisition_core_volk()
     volk_32f_accumulator_s32f(&d_input_power, d_magnitude, d_fft_size);
     d_input_power /= static_cast<float>(d_fft_size);
 
+    if (d_grid_dump)
+        {
+            d_grid_dump->begin(*d_gnss_synchro, d_channel, samplestamp, d_fs_in, -static_cast<int>(d_doppler_max),
+                    d_doppler_step, d_num_doppler_bins, d_fft_size);
+        }
     // 2- Doppler frequency search loop
     for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
         {
@@ -465,19 +456,15 @@ void pcps_opencl_acquisition_cc::acquisition_core_volk()
                 }
 
             // Record results to file if required
-            if (d_dump)
+            if (d_grid_dump)
                 {
-                    std::stringstream filename;
-                    std::streamsize n = 2 * sizeof(float) * (d_fft_size); // complex file write
-                    filename.str("");
-                    filename << "../data/test_statistics_" << d_gnss_synchro->System
-                             <<"_" << d_gnss_synchro->Signal << "_sat_"
-                             << d_gnss_synchro->PRN << "_doppler_" <<  doppler << ".dat";
-                    d_dump_file.open(filename.str().c_str(), std::ios::out | std::ios::binary);
-                    d_dump_file.write((char*)d_ifft->get_outbuf(), n); //write directly |abs(x)|^2 in this Doppler bin?
-                    d_dump_file.close();
+                    d_grid_dump->write_line(doppler_index, d_magnitude);
                 }
         }
+    if (d_grid_dump)
+        {
+            d_grid_dump->end();
+        }
 
     if (!d_bit_transition_flag)
         {
@@ -550,6 +537,11 @@ void pcps_opencl_acquisition_cc::acquisition_core_opencl()
 
     cl::Kernel kernel;
 
+    if (d_grid_dump)
+        {
+            d_grid_dump->begin(*d_gnss_synchro, d_channel, samplestamp, d_fs_in, -static_cast<int>(d_doppler_max),
+                    d_doppler_step, d_num_doppler_bins, d_fft_size);
+        }
     // 2- Doppler frequency search loop
     for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
         {
@@ -631,19 +623,15 @@ void pcps_opencl_acquisition_cc::acquisition_core_opencl()
                 }
 
             // Record results to file if required
-            if (d_dump)
+            if (d_grid_dump)
                 {
-                    std::stringstream filename;
-                    std::streamsize n = 2 * sizeof(float) * (d_fft_size); // complex file write
-                    filename.str("");
-                    filename << "../data/test_statistics_" << d_gnss_synchro->System
-                             << "_" << d_gnss_synchro->Signal << "_sat_"
-                             << d_gnss_synchro->PRN << "_doppler_" <<  doppler << ".dat";
-                    d_dump_file.open(filename.str().c_str(), std::ios::out | std::ios::binary);
-                    d_dump_file.write((char*)d_ifft->get_outbuf(), n); //write directly |abs(x)|^2 in this Doppler bin?
-                    d_dump_file.close();
+                    d_grid_dump->write_line(doppler_index, d_magnitude);
                 }
         }
+    if (d_grid_dump)
+        {
+            d_grid_dump->end();
+        }
 
 //    gettimeofday(&tv, NULL);
 //    end = tv.tv_sec *1e6 + tv.tv_usec;
@@ -706,7 +694,6 @@ int pcps_opencl_acquisition_cc::general_work(int noutput_items,
         gr_vector_int &ninput_items, gr_vector_const_void_star &input_items,
         gr_vector_void_star &output_items __attribute__((unused)))
 {
-    int acquisition_message = -1; //0=STOP_CHANNEL 1=ACQ_SUCCEES 2=ACQ_FAIL
     switch (d_state)
     {
     case 0:
@@ -803,8 +790,7 @@ int pcps_opencl_acquisition_cc::general_work(int noutput_items,
 
             d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
 
-            acquisition_message = 1;
-            this->message_port_pub(pmt::mp("events"), pmt::from_long(acquisition_message));
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_POSITIVE_ACQUISITION));
 
             break;
         }
@@ -827,8 +813,7 @@ int pcps_opencl_acquisition_cc::general_work(int noutput_items,
 
             d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
 
-            acquisition_message = 2;
-            this->message_port_pub(pmt::mp("events"), pmt::from_long(acquisition_message));
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_NEGATIVE_ACQUISITION));
 
             break;
         }
@@ -52,6 +52,7 @@
 #define GNSS_SDR_PCPS_OPENCL_ACQUISITION_CC_H_
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 #include <gnuradio/block.h>
@@ -59,6 +60,7 @@
 #include <gnuradio/fft/fft.h>
 #include "fft_internal.h"
 #include "gnss_synchro.h"
+#include "acquisition_grid_dump.h"
 
 #ifdef __APPLE__
    #include "cl.hpp"
@@ -143,6 +145,7 @@ private:
     bool d_dump;
     unsigned int d_channel;
     std::string d_dump_filename;
+    std::unique_ptr<Acquisition_Grid_Dump> d_grid_dump;
     unsigned int d_peak;
     gr_complex* d_zero_vector;
     gr_complex** d_in_buffer;
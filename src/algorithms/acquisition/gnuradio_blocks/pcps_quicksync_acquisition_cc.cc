@@ -30,13 +30,14 @@
 
 #include "pcps_quicksync_acquisition_cc.h"
 #include <cmath>
-#include <sstream>
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
 #include <volk/volk.h>
 #include <volk_gnsssdr/volk_gnsssdr.h>
 #include "control_message_factory.h"
+#include "fft_plan_cache.h"
 #include "GPS_L1_CA.h"
+#include "channel_event.h"
 
 
 using google::LogMessage;
@@ -93,41 +94,46 @@ pcps_quicksync_acquisition_cc::pcps_quicksync_acquisition_cc(
     //fft size is reduced.
     d_fft_size = (d_samples_per_code) / d_folding_factor;
 
-    d_fft_codes = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
+    d_fft_codes = 0;
     d_magnitude = static_cast<float*>(volk_malloc(d_samples_per_code * d_folding_factor * sizeof(float), volk_get_alignment()));
     d_magnitude_folded = static_cast<float*>(volk_malloc(d_fft_size * sizeof(float), volk_get_alignment()));
 
-    d_possible_delay = new unsigned int[d_folding_factor];
-    d_corr_output_f = new float[d_folding_factor];
+    // Buffers of the correlation in time of the possible delays, allocated once
+    d_possible_delay = static_cast<unsigned int*>(volk_malloc(d_folding_factor * sizeof(unsigned int), volk_get_alignment()));
+    d_corr_acumulator = static_cast<gr_complex*>(volk_malloc(d_folding_factor * sizeof(gr_complex), volk_get_alignment()));
+    d_corr_output_f = static_cast<float*>(volk_malloc(d_folding_factor * sizeof(float), volk_get_alignment()));
+    std::fill_n(d_possible_delay, d_folding_factor, 0);
+    std::fill_n(d_corr_output_f, d_folding_factor, 0.0);
+    d_corr_input = static_cast<gr_complex*>(volk_malloc(d_samples_per_code * sizeof(gr_complex), volk_get_alignment()));
 
     /*Create the d_code signal , which would store the values of the code in its
     original form to perform later correlation in time domain*/
-    d_code = new gr_complex[d_samples_per_code]();
+    d_code = static_cast<gr_complex*>(volk_malloc(d_samples_per_code * sizeof(gr_complex), volk_get_alignment()));
+    std::fill_n(d_code, d_samples_per_code, gr_complex(0.0, 0.0));
 
     // Direct FFT
-    d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
+    d_fft_if = Fft_Plan_Cache::acquire(d_fft_size, true);
     // Inverse FFT
-    d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+    d_ifft = Fft_Plan_Cache::acquire(d_fft_size, false);
 
     // For dumping samples into a file
     d_dump = dump;
     d_dump_filename = dump_filename;
+    if (d_dump)
+        {
+            d_grid_dump.reset(new Acquisition_Grid_Dump(d_dump_filename));
+        }
 
-    d_corr_acumulator = 0;
-    d_signal_folded = 0;
-    d_code_folded = new gr_complex[d_fft_size]();
     d_noise_floor_power = 0;
     d_doppler_resolution = 0;
     d_threshold = 0;
     d_doppler_step = 0;
     d_grid_doppler_wipeoffs = 0;
-    d_fft_if2 = 0;
     d_gnss_synchro = 0;
     d_code_phase = 0;
     d_doppler_freq = 0;
     d_test_statistics = 0;
     d_channel = 0;
-    //d_code_folded = 0;
 
     // DLOG(INFO) << "END CONSTRUCTOR";
 }
@@ -136,25 +142,16 @@ pcps_quicksync_acquisition_cc::pcps_quicksync_acquisition_cc(
 pcps_quicksync_acquisition_cc::~pcps_quicksync_acquisition_cc()
 {
     //DLOG(INFO) << "START DESTROYER";
-    if (d_num_doppler_bins > 0)
-        {
-            for (unsigned int i = 0; i < d_num_doppler_bins; i++)
-                {
-                    volk_free(d_grid_doppler_wipeoffs[i]);
-                }
-            delete[] d_grid_doppler_wipeoffs;
-        }
-
-    volk_free(d_fft_codes);
     volk_free(d_magnitude);
     volk_free(d_magnitude_folded);
+    volk_free(d_possible_delay);
+    volk_free(d_corr_acumulator);
+    volk_free(d_corr_output_f);
+    volk_free(d_corr_input);
+    volk_free(d_code);
 
-    delete d_ifft;
-    delete d_fft_if;
-    delete d_code;
-    delete d_possible_delay;
-    delete d_corr_output_f;
-    delete[] d_code_folded;
+    Fft_Plan_Cache::release(d_ifft);
+    Fft_Plan_Cache::release(d_fft_if);
 
     if (d_dump)
         {
@@ -170,8 +167,7 @@ void pcps_quicksync_acquisition_cc::set_local_code(std::complex<float>* code)
     lation in time in the final steps of the acquisition stage*/
     memcpy(d_code, code, sizeof(gr_complex) * d_samples_per_code);
 
-    //d_code_folded = new gr_complex[d_fft_size]();
-    memcpy(d_fft_if->get_inbuf(), d_code_folded, sizeof(gr_complex) * (d_fft_size));
+    std::fill_n(d_fft_if->get_inbuf(), d_fft_size, gr_complex(0.0, 0.0));
 
     /*perform folding of the code by the factorial factor parameter. Notice that
     folding of the code in the time stage would result in a downsampled spectrum
@@ -183,11 +179,9 @@ void pcps_quicksync_acquisition_cc::set_local_code(std::complex<float>* code)
                     std::plus<gr_complex>());
         }
 
-    d_fft_if->execute(); // We need the FFT of local code
-
-    //Conjugate the local code
-    volk_32fc_conjugate_32fc(d_fft_codes, d_fft_if->get_outbuf(), d_fft_size);
-
+    // The FFT of the folded code is shared with the channels searching for the same signal
+    d_code_fft = Acquisition_Cache::code_fft(d_gnss_synchro->System, d_gnss_synchro->Signal, d_gnss_synchro->PRN, d_fft_if);
+    d_fft_codes = d_code_fft->get();
 }
 
 
@@ -218,16 +212,8 @@ void pcps_quicksync_acquisition_cc::init()
         }
 
     // Create the carrier Doppler wipeoff signals
-    d_grid_doppler_wipeoffs = new gr_complex*[d_num_doppler_bins];
-    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
-        {
-            d_grid_doppler_wipeoffs[doppler_index] = static_cast<gr_complex*>(volk_malloc(d_samples_per_code * d_folding_factor * sizeof(gr_complex), volk_get_alignment()));
-            int doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * doppler_index;
-            float phase_step_rad = GPS_TWO_PI * (d_freq + doppler) / static_cast<float>(d_fs_in);
-            float _phase[1];
-            _phase[0] = 0;
-            volk_gnsssdr_s32f_sincos_32fc(d_grid_doppler_wipeoffs[doppler_index], - phase_step_rad, _phase, d_samples_per_code * d_folding_factor);
-        }
+    d_doppler_grid = Acquisition_Cache::doppler_wipeoff_grid(d_fs_in, d_freq, d_doppler_max, d_doppler_step, d_num_doppler_bins, d_samples_per_code * d_folding_factor);
+    d_grid_doppler_wipeoffs = d_doppler_grid->wipeoffs();
     // DLOG(INFO) << "end init";
 }
 
@@ -269,7 +255,6 @@ int pcps_quicksync_acquisition_cc::general_work(int noutput_items,
      * 6. Declare positive or negative acquisition using a message queue
      */
     //DLOG(INFO) << "START GENERAL WORK";
-    int acquisition_message = -1; //0=STOP_CHANNEL 1=ACQ_SUCCEES 2=ACQ_FAIL
     //std::cout<<"general_work in quicksync gnuradio block"<<std::endl;
     switch (d_state)
     {
@@ -309,20 +294,6 @@ int pcps_quicksync_acquisition_cc::general_work(int noutput_items,
             float magt = 0.0;
             const gr_complex *in = (const gr_complex *)input_items[0]; //Get the input samples pointer
 
-            gr_complex* in_temp = static_cast<gr_complex*>(volk_malloc(d_samples_per_code * d_folding_factor * sizeof(gr_complex), volk_get_alignment()));
-            gr_complex* in_temp_folded = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
-
-            /*Create a signal to store a signal of size 1ms, to perform correlation
-            in time. No folding on this data is required*/
-            gr_complex* in_1code = static_cast<gr_complex*>(volk_malloc(d_samples_per_code * sizeof(gr_complex), volk_get_alignment()));
-
-            /*Stores the values of the correlation output between the local code
-            and the signal with doppler shift corrected */
-            gr_complex* corr_output = static_cast<gr_complex*>(volk_malloc(d_samples_per_code * sizeof(gr_complex), volk_get_alignment()));
-
-            /*Stores a copy of the folded version of the signal.This is used for
-            the FFT operations in future steps of excecution*/
-            // gr_complex in_folded[d_fft_size];
             float fft_normalization_factor = static_cast<float>(d_fft_size) * static_cast<float>(d_fft_size);
 
             d_input_power = 0.0;
@@ -351,47 +322,28 @@ int pcps_quicksync_acquisition_cc::general_work(int noutput_items,
             volk_32f_accumulator_s32f(&d_input_power, d_magnitude, d_samples_per_code * d_folding_factor);
             d_input_power /= static_cast<float>(d_samples_per_code * d_folding_factor);
 
+            /* 2- Carrier wipeoff, folding and FFT of the incoming signal for
+               every Doppler bin. The folding factor in the incoming raw data
+               signal is d_folding_factor^2, since the superlinear method is
+               being used. This does not depend on the PRN, so the channels
+               searching the same dwell share the result */
+            d_input_ffts = Acquisition_Cache::input_fft_batch(d_doppler_grid, d_sample_counter, in, d_fft_if);
+
+            if (d_grid_dump)
+                {
+                    d_grid_dump->begin(*d_gnss_synchro, d_channel, d_sample_counter, d_fs_in, -static_cast<int>(d_doppler_max),
+                            d_doppler_step, d_num_doppler_bins, d_fft_size);
+                }
             for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
                 {
-                    /*Ensure that the signal is going to start with all samples
-                    at zero. This is done to avoid over acumulation when performing
-                    the folding process to be stored in d_fft_if->get_inbuf()*/
-                    d_signal_folded = new gr_complex[d_fft_size]();
-                    memcpy( d_fft_if->get_inbuf(), d_signal_folded, sizeof(gr_complex) * (d_fft_size));
-
-                    /*Doppler search steps and then multiplication of the incoming
-                    signal with the doppler wipeoffs to eliminate frequency offset
-                     */
                     doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * doppler_index;
 
-                    /*Perform multiplication of the incoming signal with the
-                   complex exponential vector. This removes the frequency doppler
-                   shift offset*/
-                    volk_32fc_x2_multiply_32fc(in_temp, in,
-                            d_grid_doppler_wipeoffs[doppler_index],
-                            d_samples_per_code * d_folding_factor);
-
-                    /*Perform folding of the carrier wiped-off incoming signal. Since
-                   superlinear method is being used the folding factor in the
-                   incoming raw data signal is of d_folding_factor^2*/
-                    for ( int i = 0; i < static_cast<int>(d_folding_factor * d_folding_factor); i++)
-                        {
-                            std::transform ((in_temp + i * d_fft_size),
-                                    (in_temp + ((i + 1) * d_fft_size)) ,
-                                    d_fft_if->get_inbuf(),
-                                    d_fft_if->get_inbuf(),
-                                    std::plus<gr_complex>());
-                        }
-
                     /* 3- Perform the FFT-based convolution  (parallel time search)
-                   Compute the FFT of the carrier wiped--off incoming signal*/
-                    d_fft_if->execute();
-
-                    /*Multiply carrier wiped--off, Fourier transformed incoming
+                    Multiply carrier wiped--off, Fourier transformed incoming
                     signal with the local FFT'd code reference using SIMD
                     operations with VOLK library*/
                     volk_32fc_x2_multiply_32fc(d_ifft->get_inbuf(),
-                            d_fft_if->get_outbuf(), d_fft_codes, d_fft_size);
+                            d_input_ffts->get(doppler_index), d_fft_codes, d_fft_size);
 
                     /* compute the inverse FFT of the aliased signal*/
                     d_ifft->execute();
@@ -403,14 +355,10 @@ int pcps_quicksync_acquisition_cc::general_work(int noutput_items,
 
                     /* Normalize the maximum value to correct the scale factor
                    introduced by FFTW*/
-                    //volk_32f_s32f_multiply_32f_a(d_magnitude_folded,d_magnitude_folded,
-                    // (1 / (fft_normalization_factor * fft_normalization_factor)), d_fft_size);
                     volk_32f_index_max_16u(&indext, d_magnitude_folded, d_fft_size);
 
                     magt = d_magnitude_folded[indext] / (fft_normalization_factor * fft_normalization_factor);
 
-                    delete[] d_signal_folded;
-
                     // 4- record the maximum peak and the associated synchronization parameters
                     if (d_mag < magt)
                         {
@@ -427,37 +375,25 @@ int pcps_quicksync_acquisition_cc::general_work(int noutput_items,
                                 {
                                     unsigned int detected_delay_samples_folded = 0;
                                     detected_delay_samples_folded = (indext % d_samples_per_code);
-                                    gr_complex complex_acumulator[100];
-                                    //gr_complex complex_acumulator[d_folding_factor];
 
                                     for (int i = 0; i < static_cast<int>(d_folding_factor); i++)
                                         {
                                             d_possible_delay[i] = detected_delay_samples_folded + (i) * d_fft_size;
                                         }
 
-                                    for ( int i = 0; i < static_cast<int>(d_folding_factor); i++)
+                                    for (int i = 0; i < static_cast<int>(d_folding_factor); i++)
                                         {
-
-                                            /*Copy a signal of 1 code length into suggested buffer.
-                                                                      The copied signal must have doppler effect corrected*/
-                                            memcpy(in_1code,&in_temp[d_possible_delay[i]],
-                                                    sizeof(gr_complex) * (d_samples_per_code));
-
-                                            /*Perform multiplication of the unmodified local
-                                                              generated code with the incoming signal with doppler
-                                                              effect corrected and accumulates its value. This
-                                                              is indeed correlation in time for an specific value
-                                                              of a shift*/
-                                            volk_32fc_x2_multiply_32fc(corr_output, in_1code, d_code, d_samples_per_code);
-
-                                            for(int j = 0; j < d_samples_per_code; j++)
-                                                {
-                                                    complex_acumulator[i] += (corr_output[j]);
-                                                }
-
+                                            /*Wipe off the Doppler of a signal of 1 code length
+                                            starting at the suggested delay, and correlate
+                                            it with the unmodified local generated code.
+                                            This is indeed correlation in time for an
+                                            specific value of a shift*/
+                                            volk_32fc_x2_multiply_32fc(d_corr_input, in + d_possible_delay[i],
+                                                    d_grid_doppler_wipeoffs[doppler_index] + d_possible_delay[i], d_samples_per_code);
+                                            volk_32fc_x2_dot_prod_32fc(&d_corr_acumulator[i], d_corr_input, d_code, d_samples_per_code);
                                         }
                                     /*Obtain maximun value of correlation given the possible delay selected */
-                                    volk_32fc_magnitude_squared_32f(d_corr_output_f, complex_acumulator, d_folding_factor);
+                                    volk_32fc_magnitude_squared_32f(d_corr_output_f, d_corr_acumulator, d_folding_factor);
                                     volk_32f_index_max_16u(&indext, d_corr_output_f, d_folding_factor);
 
                                     /*Now save the real code phase in the gnss_syncro block for use in other stages*/
@@ -467,27 +403,19 @@ int pcps_quicksync_acquisition_cc::general_work(int noutput_items,
 
                                     /* 5- Compute the test statistics and compare to the threshold d_test_statistics = 2 * d_fft_size * d_mag / d_input_power;*/
                                     d_test_statistics = d_mag / d_input_power;
-                                    //delete complex_acumulator;
                                 }
                         }
 
                     // Record results to file if required
-                    if (d_dump)
+                    if (d_grid_dump)
                         {
-                            /*Since QuickSYnc performs a folded correlation in frequency by means
-                            of the FFT, it is esential to also keep the values obtained from the
-                            possible delay to show how it is maximize*/
-                            std::stringstream filename;
-                            std::streamsize n =  sizeof(float) * (d_fft_size); // complex file write
-                            filename.str("");
-                            filename << "../data/test_statistics_" << d_gnss_synchro->System
-                                    << "_" << d_gnss_synchro->Signal << "_sat_"
-                                    << d_gnss_synchro->PRN << "_doppler_" <<  doppler << ".dat";
-                            d_dump_file.open(filename.str().c_str(), std::ios::out | std::ios::binary);
-                            d_dump_file.write((char*)d_magnitude_folded, n); //write directly |abs(x)|^2 in this Doppler bin?
-                            d_dump_file.close();
+                            d_grid_dump->write_line(doppler_index, d_magnitude_folded);
                         }
                 }
+            if (d_grid_dump)
+                {
+                    d_grid_dump->end();
+                }
 
             if (!d_bit_transition_flag)
                 {
@@ -517,10 +445,7 @@ int pcps_quicksync_acquisition_cc::general_work(int noutput_items,
                         }
                 }
 
-            volk_free(in_temp);
-            volk_free(in_temp_folded);
-            volk_free(in_1code);
-            volk_free(corr_output);
+            d_input_ffts.reset();
             consume_each(1);
 
             break;
@@ -549,8 +474,7 @@ int pcps_quicksync_acquisition_cc::general_work(int noutput_items,
             d_sample_counter += d_sampled_ms * d_samples_per_ms * ninput_items[0]; // sample counter
             consume_each(ninput_items[0]);
 
-            acquisition_message = 1;
-            this->message_port_pub(pmt::mp("events"), pmt::from_long(acquisition_message));
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_POSITIVE_ACQUISITION));
             //DLOG(INFO) << "END CASE 2";
             break;
         }
@@ -578,8 +502,7 @@ int pcps_quicksync_acquisition_cc::general_work(int noutput_items,
             d_sample_counter += d_sampled_ms * d_samples_per_ms * ninput_items[0]; // sample counter
             consume_each(ninput_items[0]);
 
-            acquisition_message = 2;
-            this->message_port_pub(pmt::mp("events"), pmt::from_long(acquisition_message));
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_NEGATIVE_ACQUISITION));
             //DLOG(INFO) << "END CASE 3";
             break;
         }
@@ -52,6 +52,7 @@
 #define GNSS_SDR_PCPS_QUICKSYNC_ACQUISITION_CC_H_
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <algorithm>
 #include <functional>
@@ -60,6 +61,8 @@
 #include <gnuradio/gr_complex.h>
 #include <gnuradio/fft/fft.h>
 #include "gnss_synchro.h"
+#include "acquisition_cache.h"
+#include "acquisition_grid_dump.h"
 
 class pcps_quicksync_acquisition_cc;
 
@@ -107,12 +110,11 @@ private:
 
     gr_complex* d_code;
     unsigned int d_folding_factor; // also referred in the paper as 'p'
-    float* d_corr_acumulator;
     unsigned int* d_possible_delay;
+    gr_complex* d_corr_acumulator;
     float* d_corr_output_f;
+    gr_complex* d_corr_input;
     float* d_magnitude_folded;
-    gr_complex* d_signal_folded;
-    gr_complex* d_code_folded;
     float d_noise_floor_power;
 
     long d_fs_in;
@@ -129,11 +131,13 @@ private:
     unsigned int d_well_count;
     unsigned int d_fft_size;
     unsigned long int d_sample_counter;
-    gr_complex** d_grid_doppler_wipeoffs;
+    std::shared_ptr<const Doppler_Wipeoff_Grid> d_doppler_grid;
+    const gr_complex* const* d_grid_doppler_wipeoffs;
     unsigned int d_num_doppler_bins;
-    gr_complex* d_fft_codes;
+    std::shared_ptr<const Code_Fft> d_code_fft;
+    const gr_complex* d_fft_codes;
+    std::shared_ptr<const Input_Fft_Batch> d_input_ffts;
     gr::fft::fft_complex* d_fft_if;
-    gr::fft::fft_complex* d_fft_if2;
     gr::fft::fft_complex* d_ifft;
     Gnss_Synchro *d_gnss_synchro;
     unsigned int d_code_phase;
@@ -149,6 +153,7 @@ private:
     bool d_dump;
     unsigned int d_channel;
     std::string d_dump_filename;
+    std::unique_ptr<Acquisition_Grid_Dump> d_grid_dump;
     unsigned int d_peak;
 
 public:
@@ -34,24 +34,24 @@
  */
 
 #include "pcps_sd_acquisition_cc.h"
-#include <sstream>
-#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <boost/bind.hpp>
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
 #include <volk/volk.h>
 #include <volk_gnsssdr/volk_gnsssdr.h>
 #include "control_message_factory.h"
-#include "GPS_L1_CA.h" //GPS_TWO_PI
-#include "persistence1d.hpp"
+#include "fft_plan_cache.h"
+#include "GPS_L1_CA.h" //GPS_TWO_PI, GPS_L1_FREQ_HZ
+#include "channel_event.h"
+#include "trace_log.h"
+#include "latency_trace.h"
 #include <chrono>
 
 using google::LogMessage;
 
-struct Peak{
-    int code_phase;
-    int doppler;
-    float mag;
-};
+// SPREE acquires the peaks 1 to 5 of each satellite, see GNSSFlowgraph::AssignACQState
+const unsigned int stored_auxiliary_peaks = 5;
 
 
 pcps_sd_acquisition_cc_sptr pcps_make_sd_acquisition_cc(
@@ -98,12 +98,31 @@ pcps_sd_acquisition_cc::pcps_sd_acquisition_cc(
     d_num_doppler_bins = 0;
     d_bit_transition_flag = bit_transition_flag;
     d_use_CFAR_algorithm_flag = use_CFAR_algorithm_flag;
+    d_frequency_domain_doppler = false;
+    d_pooled_engine = false;
+    d_reacquisition = false;
+    d_reacquisition_doppler_window_hz = 0;
+    d_reacquisition_code_window_samples = 0;
+    d_reacquisition_max_age_ms = 0;
+    d_reacquisition_tried = false;
+    d_apt_windowed = false;
+    d_apt_doppler_window_hz = 0;
+    d_apt_code_window_samples = 0;
+    d_apt_max_age_ms = 0;
+    d_apt_search = false;
+    d_window = 0;
+    d_narrow_search = false;
+    d_narrow_code_phases = false;
+    d_peak_list_max_age_ms = 0;
+    d_first_doppler_index = 0;
+    d_input = 0;
     d_threshold = 0.0;
     d_doppler_step = 0;
     d_code_phase = 0;
     d_test_statistics = 0.0;
     d_channel = 0;
     d_doppler_freq = 0.0;
+    d_history_next = 0;
 
     //set_relative_rate( 1.0/d_fft_size );
 
@@ -123,45 +142,66 @@ pcps_sd_acquisition_cc::pcps_sd_acquisition_cc(
             d_max_dwells = 1; //Activation of d_bit_transition_flag invalidates the value of d_max_dwells
         }
 
-    d_fft_codes = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
-    d_magnitude = static_cast<float*>(volk_malloc(d_fft_size * sizeof(float), volk_get_alignment()));
+    // Direct FFT, Doppler grid and buffers of the search, attached by the first search
+    d_magnitude = 0;
+    d_fft_if = 0;
 
-    // Direct FFT
-    d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
-
-    // Inverse FFT
-    d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+    // The inverse FFTs run on the plans of the acquisition thread pool
 
     // For dumping samples into a file
     d_dump = dump;
     d_dump_filename = dump_filename;
+    if (d_dump)
+        {
+            d_grid_dump.reset(new Acquisition_Grid_Dump(d_dump_filename));
+        }
 
     d_gnss_synchro = 0;
-    d_grid_doppler_wipeoffs = 0;
+    d_fft_codes = 0;
 }
 
 
 pcps_sd_acquisition_cc::~pcps_sd_acquisition_cc()
 {
-    if (d_num_doppler_bins > 0)
+    detach_engine();
+}
+
+
+void pcps_sd_acquisition_cc::attach_engine()
+{
+    if (!d_frequency_domain_doppler && !d_doppler_grid && d_num_doppler_bins > 0)
         {
-            for (unsigned int i = 0; i < d_num_doppler_bins; i++)
-                {
-                    volk_free(d_grid_doppler_wipeoffs[i]);
-                }
-            delete[] d_grid_doppler_wipeoffs;
+            // Create the carrier Doppler wipeoff signals
+            d_doppler_grid = Acquisition_Cache::doppler_wipeoff_grid(d_fs_in, d_freq, d_doppler_max, d_doppler_step, d_num_doppler_bins, d_fft_size);
         }
+    if (!d_fft_if)
+        {
+            d_fft_if = Fft_Plan_Cache::acquire(d_fft_size, true);
+        }
+    if (!d_magnitude)
+        {
+            d_magnitude = static_cast<float*>(volk_malloc(d_fft_size * sizeof(float), volk_get_alignment()));
+        }
+    if (d_frequency_domain_doppler && !d_fd_doppler && d_num_doppler_bins > 0)
+        {
+            d_fd_doppler.reset(new Frequency_Domain_Doppler(d_fs_in, d_freq, d_doppler_max, d_doppler_step, d_num_doppler_bins, d_fft_size));
+            DLOG(INFO) << "Frequency domain Doppler search, " << d_fd_doppler->num_input_ffts()
+                       << " input FFTs per dwell for " << d_num_doppler_bins << " Doppler bins";
+        }
+}
 
-    volk_free(d_fft_codes);
-    volk_free(d_magnitude);
-
-    delete d_ifft;
-    delete d_fft_if;
 
-    if (d_dump)
+void pcps_sd_acquisition_cc::detach_engine()
+{
+    d_fd_doppler.reset();
+    if (d_magnitude)
         {
-            d_dump_file.close();
+            volk_free(d_magnitude);
+            d_magnitude = 0;
         }
+    Fft_Plan_Cache::release(d_fft_if);
+    d_fft_if = 0;
+    std::vector<Auxiliary_Peak_Detector>().swap(d_line_peaks);
 }
 
 
@@ -171,28 +211,38 @@ void pcps_sd_acquisition_cc::set_local_code(std::complex<float> * code)
     // Here we want to create a buffer that looks like this:
     // [ 0 0 0 ... 0 c_0 c_1 ... c_L]
     // where c_i is the local code and there are L zeros and L chips
+    // A pooled engine may be attached or detached by the block thread meanwhile
+    // Before the first search, the code takes a plan of the cache as well
+    bool cached_plan = d_pooled_engine || !d_fft_if;
+    gr::fft::fft_complex* fft_if = cached_plan ? Fft_Plan_Cache::acquire(d_fft_size, true) : d_fft_if;
     if( d_bit_transition_flag )
         {
             int offset = d_fft_size/2;
-            std::fill_n( d_fft_if->get_inbuf(), offset, gr_complex( 0.0, 0.0 ) );
-            memcpy(d_fft_if->get_inbuf() + offset, code, sizeof(gr_complex) * offset);
+            std::fill_n( fft_if->get_inbuf(), offset, gr_complex( 0.0, 0.0 ) );
+            memcpy(fft_if->get_inbuf() + offset, code, sizeof(gr_complex) * offset);
         } 
     else 
         {
-            memcpy(d_fft_if->get_inbuf(), code, sizeof(gr_complex) * d_fft_size);
+            memcpy(fft_if->get_inbuf(), code, sizeof(gr_complex) * d_fft_size);
         }
     
-    d_fft_if->execute(); // We need the FFT of local code
-    volk_32fc_conjugate_32fc(d_fft_codes, d_fft_if->get_outbuf(), d_fft_size);
-}
-
+    // The FFT of the local code is shared with the channels searching for the same signal
+    d_code_fft = Acquisition_Cache::code_fft(d_gnss_synchro->System, d_gnss_synchro->Signal, d_gnss_synchro->PRN, fft_if);
+    d_fft_codes = d_code_fft->get();
+    if (cached_plan)
+        {
+            Fft_Plan_Cache::release(fft_if);
+        }
 
-void pcps_sd_acquisition_cc::update_local_carrier(gr_complex* carrier_vector, int correlator_length_samples, float freq)
-{
-    float phase_step_rad = GPS_TWO_PI * freq / static_cast<float>(d_fs_in);
-    float _phase[1];
-    _phase[0] = 0;
-    volk_gnsssdr_s32f_sincos_32fc(carrier_vector, - phase_step_rad, _phase, correlator_length_samples);
+    // The narrow searches of a single code period can correlate the few code phases of their window directly
+    if ((d_reacquisition || d_apt_windowed) && !d_bit_transition_flag && static_cast<int>(d_fft_size) == d_samples_per_code)
+        {
+            if (!d_narrow_code_search)
+                {
+                    d_narrow_code_search.reset(new Narrow_Code_Search(d_fs_in, d_fft_size));
+                }
+            d_narrow_code_search->set_local_code(code);
+        }
 }
 
 
@@ -212,18 +262,44 @@ void pcps_sd_acquisition_cc::init()
 
     d_num_doppler_bins = ceil( static_cast<double>(static_cast<int>(d_doppler_max) - static_cast<int>(-d_doppler_max)) / static_cast<double>(d_doppler_step));
 
-    // Create the carrier Doppler wipeoff signals
-    d_grid_doppler_wipeoffs = new gr_complex*[d_num_doppler_bins];
+    d_fd_doppler.reset();
+    d_doppler_grid.reset();
+    // the engine (FFT plan, Doppler grid, search buffers) is attached by the first search,
+    // and a pooled one only while the acquisition is active
+    if (d_pooled_engine)
+        {
+            detach_engine();
+        }
+    else if (d_fft_if)
+        {
+            attach_engine(); // grid of the new Doppler settings
+        }
 
-    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
+    d_reacquisition_window.reset();
+    if (d_reacquisition && !d_bit_transition_flag)
+        {
+            d_reacquisition_window.reset(new Reacquisition_Window(d_fs_in, d_samples_per_code, GPS_L1_FREQ_HZ,
+                    d_doppler_max, d_doppler_step, d_num_doppler_bins,
+                    d_reacquisition_doppler_window_hz, d_reacquisition_code_window_samples));
+        }
+    d_apt_window.reset();
+    if (d_apt_windowed && !d_bit_transition_flag)
         {
-            d_grid_doppler_wipeoffs[doppler_index] = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
-            int doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * doppler_index;
-            update_local_carrier(d_grid_doppler_wipeoffs[doppler_index], d_fft_size, d_freq + doppler);
+            d_apt_window.reset(new Reacquisition_Window(d_fs_in, d_samples_per_code, GPS_L1_FREQ_HZ,
+                    d_doppler_max, d_doppler_step, d_num_doppler_bins,
+                    d_apt_doppler_window_hz, d_apt_code_window_samples));
         }
 }
 
 
+void pcps_sd_acquisition_cc::set_sample_history(const std::shared_ptr<Sample_History>& history)
+{
+    d_history = history;
+    unsigned int item_samples = d_history ? 1 : d_fft_size;
+    set_input_signature(gr::io_signature::make(1, 1, sizeof(gr_complex) * item_samples));
+}
+
+
 void pcps_sd_acquisition_cc::set_state(int state)
 {
     d_state = state;
@@ -236,6 +312,8 @@ void pcps_sd_acquisition_cc::set_state(int state)
             d_mag = 0.0;
             d_input_power = 0.0;
             d_test_statistics = 0.0;
+            d_reacquisition_tried = false;
+            d_history_next = 0;
         }
     else if (d_state == 0)
         {}
@@ -246,10 +324,135 @@ void pcps_sd_acquisition_cc::set_state(int state)
 }
 
 
+void pcps_sd_acquisition_cc::search_doppler_line(unsigned int line_index, Acquisition_Scratch& scratch,
+        bool acquire_auxiliary_peaks, float threshold_spoofing)
+{
+    unsigned int indext = 0;
+    unsigned int doppler_index = d_first_doppler_index + line_index;
+    int doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * doppler_index;
+    int effective_fft_size = ( d_bit_transition_flag ? d_fft_size/2 : d_fft_size );
+    float fft_normalization_factor = static_cast<float>(d_fft_size) * static_cast<float>(d_fft_size);
+    gr::fft::fft_complex* ifft = scratch.ifft(d_fft_size);
+    float* magnitude = scratch.magnitude(d_fft_size);
+    bool fused = false;
+    float peaks[3];
+    unsigned int peak_index[2];
+
+    if (d_narrow_code_phases)
+        {
+            // only the code phases of the window are correlated, the other ones are left at zero
+            std::fill_n(magnitude, effective_fft_size, 0.0);
+            d_narrow_code_search->search(static_cast<double>(d_freq + doppler), d_window->first_code_phase(),
+                    d_window->num_code_phases(), magnitude);
+        }
+    else
+        {
+            // 3- Perform the FFT-based convolution  (parallel time search)
+            // Multiply carrier wiped--off, Fourier transformed incoming signal
+            // with the local FFT'd code reference using SIMD operations with VOLK library
+            if (d_fd_doppler)
+                {
+                    d_fd_doppler->multiply_code(doppler_index, d_fft_codes, ifft->get_inbuf());
+                }
+            else if (d_narrow_search)
+                {
+                    // only a few lines are searched, their input FFTs are not worth sharing
+                    gr::fft::fft_complex* fft = scratch.fft(d_fft_size);
+                    volk_32fc_x2_multiply_32fc(fft->get_inbuf(), d_input, d_doppler_grid->wipeoffs()[doppler_index], d_fft_size);
+                    fft->execute();
+                    volk_32fc_x2_multiply_32fc(ifft->get_inbuf(), fft->get_outbuf(), d_fft_codes, d_fft_size);
+                }
+            else
+                {
+                    volk_32fc_x2_multiply_32fc(ifft->get_inbuf(), d_input_ffts->get(doppler_index), d_fft_codes, d_fft_size);
+                }
+
+            // compute the inverse FFT
+            ifft->execute();
+
+            size_t offset = ( d_bit_transition_flag ? effective_fft_size : 0 );
+            if (!d_apt_search && !d_narrow_search)
+                {
+                    // the squared magnitude, its maximum, its sum and the highest sample
+                    // more than one code phase sample away from the maximum, in a single pass
+                    volk_gnsssdr_32fc_magnitude_squared_peaks_32f(magnitude, peaks, peak_index, ifft->get_outbuf() + offset,
+                            1, effective_fft_size);
+                    fused = true;
+                }
+            else
+                {
+                    volk_32fc_magnitude_squared_32f(magnitude, ifft->get_outbuf() + offset, effective_fft_size);
+                }
+            if (d_apt_search)
+                {
+                    // the auxiliary peaks are only looked for around the authentic one
+                    d_window->clear_outside(magnitude, effective_fft_size);
+                }
+        }
+
+    // Search maximum
+    if (fused)
+        {
+            indext = peak_index[0];
+        }
+    else if (d_narrow_search)
+        {
+            indext = d_window->index_max(magnitude, effective_fft_size);
+        }
+    else
+        {
+            volk_32f_index_max_16u(&indext, magnitude, effective_fft_size);
+        }
+    Doppler_Line_Max& line = d_doppler_lines[line_index];
+    line.index = indext;
+    line.mag = magnitude[indext];
+    line.power = 0.0;
+    if (d_use_CFAR_algorithm_flag == false)
+        {
+            if (d_narrow_code_phases)
+                {
+                    line.power = d_narrow_code_search->line_power();
+                }
+            else if (fused)
+                {
+                    line.power = peaks[1];
+                }
+            else
+                {
+                    volk_32f_accumulator_s32f(&line.power, magnitude, effective_fft_size);
+                }
+        }
+
+    // only the lines reaching the threshold are searched for local maxima
+    d_line_peaks[line_index].clear();
+    if(acquire_auxiliary_peaks && magnitude[indext] >= threshold_spoofing)
+        {
+            if (fused && peaks[2] < threshold_spoofing)
+                {
+                    // nothing but the neighbours of the maximum reaches the threshold
+                    d_line_peaks[line_index].add_doppler_line(magnitude, effective_fft_size, indext - std::min(indext, 1u), indext + 2,
+                            threshold_spoofing, doppler, d_samples_per_code, fft_normalization_factor * fft_normalization_factor);
+                }
+            else
+                {
+                    d_line_peaks[line_index].add_doppler_line(magnitude, effective_fft_size, threshold_spoofing,
+                            doppler, d_samples_per_code, fft_normalization_factor * fft_normalization_factor);
+                }
+        }
+
+    // Record results to file if required
+    if (d_grid_dump)
+        {
+            d_grid_dump->write_line(doppler_index, magnitude);
+        }
+}
+
+
 int pcps_sd_acquisition_cc::general_work(int noutput_items,
         gr_vector_int &ninput_items, gr_vector_const_void_star &input_items,
         gr_vector_void_star &output_items __attribute__((unused)))
 {
+    Block_Metrics_Scope metrics_scope(d_metrics.get(), ninput_items[0]);
     /*
      * By J.Arribas, L.Esteve and M.Molina
      * Acquisition strategy (Kay Borre book + CFAR threshold):
@@ -261,7 +464,6 @@ int pcps_sd_acquisition_cc::general_work(int noutput_items,
      * 6. Declare positive or negative acquisition using a message port
      */
 
-    int acquisition_message = -1; //0=STOP_CHANNEL 1=ACQ_SUCCEES 2=ACQ_FAIL
     d_peak = d_gnss_synchro->peak;
 
     switch (d_state)
@@ -270,6 +472,8 @@ int pcps_sd_acquisition_cc::general_work(int noutput_items,
         {
             if (d_active)
                 {
+                    // the first search attaches the engine, and each one a pooled engine
+                    attach_engine();
                     //restart acquisition variables
                     d_gnss_synchro->Acq_delay_samples = 0.0;
                     d_gnss_synchro->Acq_doppler_hz = 0.0;
@@ -278,11 +482,18 @@ int pcps_sd_acquisition_cc::general_work(int noutput_items,
                     d_mag = 0.0;
                     d_input_power = 0.0;
                     d_test_statistics = 0.0;
+                    d_reacquisition_tried = false;
+                    d_history_next = 0;
 
                     d_state = 1;
                 }
+            else if (d_pooled_engine)
+                {
+                    detach_engine(); // stopped by the flowgraph during a search
+                }
 
-            d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
+            d_sample_counter += (d_history ? 1 : d_fft_size) * ninput_items[0]; // sample counter
+            metrics_scope.set_items(ninput_items[0]);
             consume_each(ninput_items[0]);
 
             //DLOG(INFO) << "Consumed " << ninput_items[0] << " items";
@@ -296,9 +507,30 @@ int pcps_sd_acquisition_cc::general_work(int noutput_items,
 
             // initialize acquisition algorithm
             int doppler;
-            unsigned int indext = 0;
             float magt = 0.0;
-            const gr_complex *in = (const gr_complex *)input_items[0]; //Get the input samples pointer
+            const gr_complex *in; // the samples of the dwell
+            unsigned long int dwell_end; // sample stamp of the end of the dwell
+            if (d_history)
+                {
+                    // the input only paces the block: the dwell is read from the history, as
+                    // far as both the block and the sink of the history have got
+                    d_sample_counter += ninput_items[0];
+                    metrics_scope.set_items(ninput_items[0]);
+                    consume_each(ninput_items[0]);
+                    dwell_end = std::min(d_sample_counter, d_history->written()) / d_fft_size * d_fft_size;
+                    in = dwell_end >= d_history_next + d_fft_size ? d_history->window(dwell_end - d_fft_size, d_fft_size) : 0;
+                    if (!in)
+                        {
+                            break;
+                        }
+                    d_history_next = dwell_end;
+                }
+            else
+                {
+                    in = (const gr_complex *)input_items[0]; //Get the input samples pointer
+                    d_sample_counter += d_fft_size; // sample counter
+                    dwell_end = d_sample_counter;
+                }
 
             int effective_fft_size = ( d_bit_transition_flag ? d_fft_size/2 : d_fft_size );
 
@@ -307,16 +539,77 @@ int pcps_sd_acquisition_cc::general_work(int noutput_items,
             d_input_power = 0.0;
             d_mag = 0.0;
 
-            d_sample_counter += d_fft_size; // sample counter
-
             d_well_count++;
 
-            DLOG(INFO) << "Channel: " << d_channel
+            TRACE_LOG(TRACE_ACQUISITION, 1) << "Channel: " << d_channel
                     << " , doing acquisition of satellite: " << d_gnss_synchro->System << " " << d_gnss_synchro->PRN
-                    << " ,sample stamp: " << d_sample_counter << ", threshold: "
+                    << " ,sample stamp: " << dwell_end << ", threshold: "
                     << d_threshold << ", doppler_max: " << d_doppler_max
                     << ", doppler_step: " << d_doppler_step;
 
+            // The search for the strongest peak of the satellite ranked all its peaks:
+            // the auxiliary channels start from that list, at the same epoch
+            if (d_peak > 1 && d_peak_list_max_age_ms > 0 && d_well_count == 1
+                    && d_reacquisition_hints.auxiliary_peaks(d_gnss_synchro->PRN, d_acquired_peaks)
+                    && d_acquired_peaks.peaks.size() >= d_peak
+                    && dwell_end - d_acquired_peaks.sample_stamp <= static_cast<unsigned long int>(d_peak_list_max_age_ms) * static_cast<unsigned long int>(d_fs_in / 1000))
+                {
+                    const Acq_Peak& peak = d_acquired_peaks.peaks[d_peak - 1];
+                    d_mag = peak.mag;
+                    d_input_power = d_acquired_peaks.input_power;
+                    d_test_statistics = peak.mag / d_acquired_peaks.input_power;
+                    d_gnss_synchro->Acq_delay_samples = peak.code_phase;
+                    d_gnss_synchro->Acq_doppler_hz = peak.doppler;
+                    d_gnss_synchro->Acq_samplestamp_samples = d_acquired_peaks.sample_stamp;
+                    TRACE_LOG(TRACE_ACQUISITION, 1) << "Peak " << d_peak << " of satellite " << d_gnss_synchro->PRN << " taken from the search at sample stamp "
+                               << d_acquired_peaks.sample_stamp;
+                    d_state = 2; // Positive acquisition
+                    if (!d_history)
+                        {
+                            metrics_scope.set_items(1);
+                            consume_each(1);
+                        }
+                    break;
+                }
+
+            // APT: an auxiliary peak is searched only around the peak tracked by the main channel
+            d_apt_search = false;
+            d_narrow_code_phases = false;
+            if (d_apt_window && d_peak > 1 && d_gnss_synchro->System == 'G')
+                {
+                    Reacquisition_Hint hint;
+                    unsigned long int block_start = dwell_end - d_fft_size;
+                    unsigned long int max_age = static_cast<unsigned long int>(d_apt_max_age_ms) * static_cast<unsigned long int>(d_fs_in / 1000);
+                    d_apt_search = d_reacquisition_hints.get(d_gnss_synchro->PRN, 1, block_start, max_age, hint)
+                            && d_apt_window->center(hint, block_start);
+                    if (d_apt_search)
+                        {
+                            TRACE_LOG(TRACE_ACQUISITION, 1) << "Peak " << d_peak << " of satellite " << d_gnss_synchro->PRN << " searched around doppler "
+                                       << hint.doppler_hz << ", code phase " << d_apt_window->code_phase();
+                        }
+                }
+            d_narrow_search = d_apt_search;
+            d_window = d_apt_window.get();
+
+            // Reacquisition: the first dwell only searches around where the satellite was last tracked
+            if (!d_apt_search && d_reacquisition_window && !d_reacquisition_tried && d_gnss_synchro->System == 'G')
+                {
+                    d_reacquisition_tried = true;
+                    Reacquisition_Hint hint;
+                    unsigned long int block_start = dwell_end - d_fft_size;
+                    unsigned long int max_age = static_cast<unsigned long int>(d_reacquisition_max_age_ms) * static_cast<unsigned long int>(d_fs_in / 1000);
+                    d_narrow_search = d_reacquisition_hints.get(d_gnss_synchro->PRN, d_peak, block_start, max_age, hint)
+                            && d_reacquisition_window->center(hint, block_start);
+                    d_window = d_reacquisition_window.get();
+                    if (d_narrow_search)
+                        {
+                            TRACE_LOG(TRACE_ACQUISITION, 1) << "Reacquisition of satellite " << d_gnss_synchro->PRN << " around doppler "
+                                       << hint.doppler_hz << ", code phase " << d_reacquisition_window->code_phase();
+                        }
+                }
+            d_first_doppler_index = d_narrow_search ? d_window->first_doppler_index() : 0;
+            unsigned int num_doppler_bins = d_narrow_search ? d_window->num_doppler_bins() : d_num_doppler_bins;
+
             //TODO: If we are doing APT and this flag is false 
             if (d_use_CFAR_algorithm_flag == true)
                 {
@@ -328,77 +621,70 @@ int pcps_sd_acquisition_cc::general_work(int noutput_items,
 
             //spoofing
             bool acquire_auxiliary_peaks = false;
-            if(d_peak != 0)  
+            if(d_peak != 0 && (!d_narrow_search || d_apt_search))
                 {
-                    DLOG(INFO) << "acquire aux";
+                    TRACE_LOG(TRACE_ACQUISITION, 1) << "acquire aux";
                     acquire_auxiliary_peaks = true;
                 }
-            std::vector<float> peaks;
             float threshold_spoofing = d_threshold * d_input_power * (fft_normalization_factor * fft_normalization_factor); 
-            std::map<float, Peak> d_highest_peaks;
+            d_aux_peaks.clear();
 
             // 2- Doppler frequency search loop
-            for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
+            // The FFTs of the carrier wiped--off incoming signal do not depend on the PRN:
+            // they are computed once per dwell for all the channels acquiring on it
+            if (d_fd_doppler)
                 {
-                    // doppler search steps
-                    doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * doppler_index;
-
-                    volk_32fc_x2_multiply_32fc(d_fft_if->get_inbuf(), in,
-                            d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
-
-                    // 3- Perform the FFT-based convolution  (parallel time search)
-                    // Compute the FFT of the carrier wiped--off incoming signal
-                    d_fft_if->execute();
-
-                    // Multiply carrier wiped--off, Fourier transformed incoming signal
-                    // with the local FFT'd code reference using SIMD operations with VOLK library
-                    volk_32fc_x2_multiply_32fc(d_ifft->get_inbuf(),
-                            d_fft_if->get_outbuf(), d_fft_codes, d_fft_size);
-
-                    // compute the inverse FFT
-                    d_ifft->execute();
+                    d_fd_doppler->set_input(in, d_fft_if);
+                }
+            else if (d_narrow_search)
+                {
+                    d_input = in;
+                    d_narrow_code_phases = d_narrow_code_search
+                            && Narrow_Code_Search::cheaper_than_fft(d_window->num_code_phases(), d_fft_size);
+                    if (d_narrow_code_phases)
+                        {
+                            d_narrow_code_search->set_input(in);
+                        }
+                }
+            else
+                {
+                    d_input_ffts = Acquisition_Cache::input_fft_batch(d_doppler_grid, dwell_end, in, d_fft_if);
+                }
+            // The Doppler lines are searched in parallel by the acquisition thread pool,
+            // each one collects its auxiliary peaks apart
+            d_doppler_lines.resize(d_num_doppler_bins);
+            d_line_peaks.resize(d_num_doppler_bins);
+            if (d_grid_dump)
+                {
+                    d_grid_dump->begin(*d_gnss_synchro, d_channel, dwell_end, d_fs_in, -static_cast<int>(d_doppler_max),
+                            d_doppler_step, d_num_doppler_bins, d_bit_transition_flag ? d_fft_size / 2 : d_fft_size);
+                }
+            Acquisition_Thread_Pool::instance().parallel_for(num_doppler_bins,
+                    boost::bind(&pcps_sd_acquisition_cc::search_doppler_line, this, _1, _2,
+                            acquire_auxiliary_peaks, threshold_spoofing));
+            d_input_ffts.reset();
+            if (d_grid_dump)
+                {
+                    d_grid_dump->end();
+                }
 
-                    // Search maximum
-                    size_t offset = ( d_bit_transition_flag ? effective_fft_size : 0 );
-                    volk_32fc_magnitude_squared_32f(d_magnitude, d_ifft->get_outbuf() + offset, effective_fft_size);
-                    volk_32f_index_max_16u(&indext, d_magnitude, effective_fft_size);
-                    magt = d_magnitude[indext];
+            for (unsigned int line_index = 0; line_index < num_doppler_bins; line_index++)
+                {
+                    // doppler search steps
+                    doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * (d_first_doppler_index + line_index);
+                    const Doppler_Line_Max& line = d_doppler_lines[line_index];
+                    magt = line.mag;
 
                     if (d_use_CFAR_algorithm_flag == true)
                         {
                             // Normalize the maximum value to correct the scale factor introduced by FFTW
-                            magt = d_magnitude[indext] / (fft_normalization_factor * fft_normalization_factor);
+                            magt = line.mag / (fft_normalization_factor * fft_normalization_factor);
                         }
 
                     if(acquire_auxiliary_peaks)
-                    {    
-                        for(unsigned int i = 0; i < d_fft_size; i++)
                         {
-                            peaks.push_back(d_magnitude[i]);
-                        }
-                        //Find the local maxima for the peaks for each doppler bin
-                        p1d::Persistence1D p;
-                        std::vector<float> dp; 
-                        if(*std::max_element(peaks.begin(), peaks.end()) >= threshold_spoofing) 
-                            {
-                                p.RunPersistence(peaks);
-                                std::vector <p1d::TPairedExtrema> Extrema;
-                                p.GetPairedExtrema(Extrema, 0);
-
-                                for( std::vector< p1d::TPairedExtrema >::iterator it = Extrema.begin(); it != Extrema.end(); it++)
-                                {
-                                    if( peaks.at((*it).MaxIndex) >= threshold_spoofing)
-                                        {
-                                            Peak peak;
-                                            peak.mag = peaks.at((*it).MaxIndex) / (fft_normalization_factor * fft_normalization_factor);
-                                            peak.doppler = (double)doppler; 
-                                            peak.code_phase = (*it).MaxIndex%d_samples_per_code;
-                                            d_highest_peaks[peak.mag] = peak;
-                                        }
-                                }   
+                            d_aux_peaks.add_peaks(d_line_peaks[line_index]);
                         }
-                        peaks.clear();
-                    }
 
                     // 4- record the maximum peak and the associated synchronization parameters
                     if (d_mag < magt)
@@ -408,8 +694,7 @@ int pcps_sd_acquisition_cc::general_work(int noutput_items,
                             if (d_use_CFAR_algorithm_flag == false)
                                 {
                                     // Search grid noise floor approximation for this doppler line
-                                    volk_32f_accumulator_s32f(&d_input_power, d_magnitude, effective_fft_size);
-                                    d_input_power = (d_input_power - d_mag) / (effective_fft_size - 1);
+                                    d_input_power = (line.power - d_mag) / (effective_fft_size - 1);
                                 }
 
                             // In case that d_bit_transition_flag = true, we compare the potentially
@@ -422,110 +707,63 @@ int pcps_sd_acquisition_cc::general_work(int noutput_items,
 
                             if (d_test_statistics < (d_mag / d_input_power) || !d_bit_transition_flag)
                                 {
-                                    d_gnss_synchro->Acq_delay_samples = static_cast<double>(indext % d_samples_per_code);
+                                    d_gnss_synchro->Acq_delay_samples = static_cast<double>(line.index % d_samples_per_code);
                                     d_gnss_synchro->Acq_doppler_hz = static_cast<double>(doppler);
-                                    d_gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
+                                    d_gnss_synchro->Acq_samplestamp_samples = dwell_end;
 
                                     // 5- Compute the test statistics and compare to the threshold
                                     //d_test_statistics = 2 * d_fft_size * d_mag / d_input_power;
                                     d_test_statistics = d_mag / d_input_power;
                                 }
                         }
+                }
 
-                    // Record results to file if required
-                    if (d_dump)
-                        {
-                            std::stringstream filename;
-                            std::streamsize n = 2 * sizeof(float) * (d_fft_size); // complex file write
-                            filename.str("");
-
-                            boost::filesystem::path p = d_dump_filename;
-                            filename << p.parent_path().string()
-                                     << boost::filesystem::path::preferred_separator
-                                     << p.stem().string()
-                                     << "_" << d_gnss_synchro->System
-                                     <<"_" << d_gnss_synchro->Signal << "_sat_"
-                                     << d_gnss_synchro->PRN << "_doppler_"
-                                     <<  doppler
-                                     << p.extension().string();
-
-                            DLOG(INFO) << "Writing ACQ out to " << filename.str();
-
-                            d_dump_file.open(filename.str().c_str(), std::ios::out | std::ios::binary);
-                            d_dump_file.write((char*)d_ifft->get_outbuf(), n); //write directly |abs(x)|^2 in this Doppler bin?
-                            d_dump_file.close();
-                        }
+            if (d_history && !d_history->intact(dwell_end - d_fft_size))
+                {
+                    // the search was slower than the history is long: its result is not that of the dwell
+                    LOG(WARNING) << "Channel " << d_channel << ": the samples of the dwell at " << dwell_end
+                                 << " were overwritten during the search, increase GNSS-SDR.sample_history_ms";
+                    d_well_count--;
+                    d_mag = 0.0;
+                    d_test_statistics = 0.0;
+                    break;
                 }
 
             bool found_peak = false;
             if(acquire_auxiliary_peaks)
-                {    
-                    std::map<float, Peak>::reverse_iterator rit;
-                    std::map<float, Peak>::reverse_iterator rit2;
-                    std::map<float, Peak> d_highest_peaks_reduced;
-                    bool use_peak;
-                    DLOG(INFO) << "### all peaks: ###" << d_highest_peaks.size();
-                    for (rit=d_highest_peaks.rbegin(); rit!=d_highest_peaks.rend(); ++rit)
-                    {
-                        use_peak = true;
-                        DLOG(INFO) << rit->second.code_phase << " " << rit->second.doppler <<" "<< rit->second.mag;
-                        for (rit2=d_highest_peaks_reduced.rbegin(); rit2!=d_highest_peaks_reduced.rend(); ++rit2)
+                {
+                    TRACE_LOG(TRACE_ACQUISITION, 2) << "### all peaks: ###" << d_aux_peaks.size();
+                    // the distinct peaks are kept for the SPREE loop, which acquires them one by one
+                    d_aux_peaks.get_peaks(std::max(d_peak, stored_auxiliary_peaks), d_doppler_step, d_acquired_peaks.peaks);
+                    d_acquired_peaks.block_start = dwell_end - d_fft_size;
+                    d_acquired_peaks.sample_stamp = dwell_end;
+                    d_acquired_peaks.input_power = d_input_power;
+                    if (!d_apt_search)
                         {
-                            if(abs(rit->second.code_phase - rit2->second.code_phase) <= 1 && 
-                               abs(rit->second.doppler - rit2->second.doppler) <= d_doppler_step)
-                                {
-                                    use_peak = false;
-                                }
-
-                        } 
-
-                        if(use_peak)
-                            {
-                                d_highest_peaks_reduced[rit->first] = rit->second;
-                            }
-                    }
-                    
-                    /*DLOG(INFO) << "### ###";
-                    for (rit=d_highest_peaks_reduced.rbegin(); rit!=d_highest_peaks_reduced.rend(); ++rit)
-                    {
-                        DLOG(INFO) << rit->second.code_phase << " " << rit->second.doppler <<" "<< rit->second.mag;
-                    }
-                    DLOG(INFO) << "### ###";
-*/
+                            // the list of a window would hide the peaks of the satellite out of it
+                            d_reacquisition_hints.set_auxiliary_peaks(d_gnss_synchro->PRN, d_acquired_peaks);
+                        }
                     //If there is more than one peak present, acquire the highest
-                    if(d_peak == 1 && d_highest_peaks_reduced.size() > 0)
-                    {
-                        found_peak = true;
-                    }
-                    else if(d_highest_peaks_reduced.size() >= d_peak)
-                    {
-                        std::map<float, Peak>::reverse_iterator rit;
-
-                        unsigned int i = 1;
-                        DLOG(INFO) << "### peaks: ###";
-                        for (rit=d_highest_peaks_reduced.rbegin(); rit!=d_highest_peaks_reduced.rend(); ++rit)
+                    if(d_acquired_peaks.peaks.size() >= d_peak)
                         {
-                            if(i == d_peak)
+                            const Acq_Peak& peak = d_acquired_peaks.peaks[d_peak - 1];
+                            found_peak = true;
+                            if(d_peak > 1)
                                 {
-                                    found_peak = true; 
-                                    DLOG(INFO) << "!!! peak found !!!";
-                                    DLOG(INFO) << "peak " << rit->first; 
-                                    DLOG(INFO) << "d_peak " << d_peak; 
-                                    DLOG(INFO) << "code phase " << rit->second.code_phase; 
-                                    d_test_statistics = rit->first/ d_input_power; 
-                                    d_gnss_synchro->Acq_delay_samples = rit->second.code_phase; 
-                                    d_gnss_synchro->Acq_doppler_hz = rit->second.doppler; 
+                                    TRACE_LOG(TRACE_ACQUISITION, 2) << "!!! peak found !!!";
+                                    TRACE_LOG(TRACE_ACQUISITION, 2) << "peak " << peak.mag;
+                                    TRACE_LOG(TRACE_ACQUISITION, 2) << "d_peak " << d_peak;
+                                    TRACE_LOG(TRACE_ACQUISITION, 2) << "code phase " << peak.code_phase;
+                                    d_test_statistics = peak.mag / d_input_power;
+                                    d_gnss_synchro->Acq_delay_samples = peak.code_phase;
+                                    d_gnss_synchro->Acq_doppler_hz = peak.doppler;
                                 }
-                            
-                            ++i;
                         }
-                    }
-            
                 }
 
            std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
            auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>( t2 - t1 ).count();
-           DLOG(INFO) << "duration " << acquire_auxiliary_peaks << " " << duration;
+           TRACE_LOG(TRACE_ACQUISITION, 1) << "duration " << acquire_auxiliary_peaks << " " << duration;
 
            if(acquire_auxiliary_peaks)
            {
@@ -533,12 +771,20 @@ int pcps_sd_acquisition_cc::general_work(int noutput_items,
                //d_test_statistics = 0;
            }
 
-            DLOG(INFO) << "found peak: " << found_peak << " aux " << acquire_auxiliary_peaks ;
+            if (d_narrow_search && !d_apt_search && d_test_statistics <= d_threshold)
+                {
+                    // not found close to the hint: the next dwell searches the full grid, and this one does not count
+                    TRACE_LOG(TRACE_ACQUISITION, 1) << "Reacquisition of satellite " << d_gnss_synchro->PRN << " failed, searching the full grid";
+                    d_well_count--;
+                    d_test_statistics = 0.0;
+                }
+
+            TRACE_LOG(TRACE_ACQUISITION, 1) << "found peak: " << found_peak << " aux " << acquire_auxiliary_peaks ;
             if (!d_bit_transition_flag)
                 {
                     if(acquire_auxiliary_peaks && !found_peak)
                         {
-                            DLOG(INFO) << "acq + no peak found";
+                            TRACE_LOG(TRACE_ACQUISITION, 1) << "acq + no peak found";
                             d_state = 3; // Negative acquisition
                         }
                     else if (d_test_statistics > d_threshold)
@@ -569,9 +815,12 @@ int pcps_sd_acquisition_cc::general_work(int noutput_items,
                         }
                 }
 
-            consume_each(1);
-
-            DLOG(INFO) << "Done. Consumed 1 item.";
+            if (!d_history)
+                {
+                    metrics_scope.set_items(1);
+                    consume_each(1);
+                    TRACE_LOG(TRACE_ACQUISITION, 1) << "Done. Consumed 1 item.";
+                }
 
             break;
         }
@@ -579,25 +828,30 @@ int pcps_sd_acquisition_cc::general_work(int noutput_items,
     case 2:
         {
             // 6.1- Declare positive acquisition using a message port
-            DLOG(INFO) << "positive acquisition";
-            DLOG(INFO) << "satellite " << d_gnss_synchro->System << " " << d_gnss_synchro->PRN;
-            DLOG(INFO) << "peak: " << d_peak;
-            DLOG(INFO) << "sample_stamp " << d_sample_counter;
-            DLOG(INFO) << "test statistics value " << d_test_statistics;
-            DLOG(INFO) << "test statistics threshold " << d_threshold;
-            DLOG(INFO) << "code phase " << d_gnss_synchro->Acq_delay_samples;
-            DLOG(INFO) << "doppler " << d_gnss_synchro->Acq_doppler_hz;
-            DLOG(INFO) << "magnitude " << d_mag;
-            DLOG(INFO) << "input signal power " << d_input_power;
+            TRACE_LOG(TRACE_ACQUISITION, 1) << "positive acquisition";
+            TRACE_LOG(TRACE_ACQUISITION, 2) << "satellite " << d_gnss_synchro->System << " " << d_gnss_synchro->PRN;
+            TRACE_LOG(TRACE_ACQUISITION, 2) << "peak: " << d_peak;
+            TRACE_LOG(TRACE_ACQUISITION, 2) << "sample_stamp " << d_sample_counter;
+            TRACE_LOG(TRACE_ACQUISITION, 2) << "test statistics value " << d_test_statistics;
+            TRACE_LOG(TRACE_ACQUISITION, 2) << "test statistics threshold " << d_threshold;
+            TRACE_LOG(TRACE_ACQUISITION, 2) << "code phase " << d_gnss_synchro->Acq_delay_samples;
+            TRACE_LOG(TRACE_ACQUISITION, 2) << "doppler " << d_gnss_synchro->Acq_doppler_hz;
+            TRACE_LOG(TRACE_ACQUISITION, 2) << "magnitude " << d_mag;
+            TRACE_LOG(TRACE_ACQUISITION, 2) << "input signal power " << d_input_power;
 
 
             d_active = false;
             d_state = 0;
-            d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
+            d_sample_counter += (d_history ? 1 : d_fft_size) * ninput_items[0]; // sample counter
+            metrics_scope.set_items(ninput_items[0]);
             consume_each(ninput_items[0]);
 
-            acquisition_message = 1;
-            this->message_port_pub(pmt::mp("events"), pmt::from_long(acquisition_message));
+            LATENCY_TRACE(LATENCY_ACQUISITION, d_channel, d_gnss_synchro->Acq_samplestamp_samples);
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_POSITIVE_ACQUISITION));
+            if (d_pooled_engine)
+                {
+                    detach_engine();
+                }
 
             break;
         }
@@ -605,23 +859,28 @@ int pcps_sd_acquisition_cc::general_work(int noutput_items,
     case 3:
         {
             // 6.2- Declare negative acquisition using a message port
-            DLOG(INFO) << "negative acquisition";
-            DLOG(INFO) << "satellite " << d_gnss_synchro->System << " " << d_gnss_synchro->PRN;
-            DLOG(INFO) << "sample_stamp " << d_sample_counter;
-            DLOG(INFO) << "test statistics value " << d_test_statistics;
-            DLOG(INFO) << "test statistics threshold " << d_threshold;
-            DLOG(INFO) << "code phase " << d_gnss_synchro->Acq_delay_samples;
-            DLOG(INFO) << "doppler " << d_gnss_synchro->Acq_doppler_hz;
-            DLOG(INFO) << "magnitude " << d_mag;
-            DLOG(INFO) << "input signal power " << d_input_power;
+            TRACE_LOG(TRACE_ACQUISITION, 1) << "negative acquisition";
+            TRACE_LOG(TRACE_ACQUISITION, 2) << "satellite " << d_gnss_synchro->System << " " << d_gnss_synchro->PRN;
+            TRACE_LOG(TRACE_ACQUISITION, 2) << "sample_stamp " << d_sample_counter;
+            TRACE_LOG(TRACE_ACQUISITION, 2) << "test statistics value " << d_test_statistics;
+            TRACE_LOG(TRACE_ACQUISITION, 2) << "test statistics threshold " << d_threshold;
+            TRACE_LOG(TRACE_ACQUISITION, 2) << "code phase " << d_gnss_synchro->Acq_delay_samples;
+            TRACE_LOG(TRACE_ACQUISITION, 2) << "doppler " << d_gnss_synchro->Acq_doppler_hz;
+            TRACE_LOG(TRACE_ACQUISITION, 2) << "magnitude " << d_mag;
+            TRACE_LOG(TRACE_ACQUISITION, 2) << "input signal power " << d_input_power;
 
             d_active = false;
             d_state = 0;
 
-            d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
+            d_sample_counter += (d_history ? 1 : d_fft_size) * ninput_items[0]; // sample counter
+            metrics_scope.set_items(ninput_items[0]);
             consume_each(ninput_items[0]);
-            acquisition_message = 2;
-            this->message_port_pub(pmt::mp("events"), pmt::from_long(acquisition_message));
+            LATENCY_TRACE(LATENCY_ACQUISITION, d_channel, d_gnss_synchro->Acq_samplestamp_samples);
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_NEGATIVE_ACQUISITION));
+            if (d_pooled_engine)
+                {
+                    detach_engine();
+                }
 
             break;
         }
@@ -52,11 +52,22 @@
 #define GNSS_SDR_PCPS_SD_ACQUISITION_CC_H_
 
 #include <fstream>
+#include <memory>
 #include <string>
+#include <vector>
 #include <gnuradio/block.h>
 #include <gnuradio/gr_complex.h>
 #include <gnuradio/fft/fft.h>
 #include "gnss_synchro.h"
+#include "block_metrics.h"
+#include "acquisition_cache.h"
+#include "frequency_domain_doppler.h"
+#include "auxiliary_peak_detector.h"
+#include "acquisition_thread_pool.h"
+#include "reacquisition_window.h"
+#include "narrow_code_search.h"
+#include "acquisition_grid_dump.h"
+#include "sample_history.h"
 
 class pcps_sd_acquisition_cc;
 
@@ -94,7 +105,10 @@ private:
             bool dump,
             std::string dump_filename);
 
-    void update_local_carrier(gr_complex* carrier_vector, int correlator_length_samples, float freq);
+    void search_doppler_line(unsigned int line_index, Acquisition_Scratch& scratch,
+            bool acquire_auxiliary_peaks, float threshold_spoofing);
+    void attach_engine(); // the direct FFT plan and the buffers of the search
+    void detach_engine();
 
     long d_fs_in;
     long d_freq;
@@ -110,11 +124,33 @@ private:
     unsigned int d_well_count;
     unsigned int d_fft_size;
     unsigned long int d_sample_counter;
-    gr_complex** d_grid_doppler_wipeoffs;
+    std::shared_ptr<const Doppler_Wipeoff_Grid> d_doppler_grid;
+    std::unique_ptr<Frequency_Domain_Doppler> d_fd_doppler;
+    std::shared_ptr<const Input_Fft_Batch> d_input_ffts;
+    std::vector<Doppler_Line_Max> d_doppler_lines; // of the searched lines
+    std::unique_ptr<Reacquisition_Window> d_reacquisition_window;
+    Reacquisition_Hints d_reacquisition_hints;
+    bool d_reacquisition;
+    unsigned int d_reacquisition_doppler_window_hz;
+    unsigned int d_reacquisition_code_window_samples;
+    unsigned int d_reacquisition_max_age_ms;
+    bool d_reacquisition_tried;
+    std::unique_ptr<Reacquisition_Window> d_apt_window;
+    bool d_apt_windowed;
+    unsigned int d_apt_doppler_window_hz;
+    unsigned int d_apt_code_window_samples;
+    unsigned int d_apt_max_age_ms;
+    bool d_apt_search; // the dwell searches an auxiliary peak around the authentic one
+    Reacquisition_Window* d_window; // of the narrow search of the dwell
+    bool d_narrow_search;
+    std::unique_ptr<Narrow_Code_Search> d_narrow_code_search;
+    bool d_narrow_code_phases; // the narrow search correlates its few code phases without FFTs
+    unsigned int d_first_doppler_index;
+    const gr_complex* d_input;
     unsigned int d_num_doppler_bins;
-    gr_complex* d_fft_codes;
+    std::shared_ptr<const Code_Fft> d_code_fft;
+    const gr_complex* d_fft_codes;
     gr::fft::fft_complex* d_fft_if;
-    gr::fft::fft_complex* d_ifft;
     Gnss_Synchro *d_gnss_synchro;
     unsigned int d_code_phase;
     float d_doppler_freq;
@@ -124,13 +160,22 @@ private:
     float d_test_statistics;
     bool d_bit_transition_flag;
     bool d_use_CFAR_algorithm_flag;
-    std::ofstream d_dump_file;
+    bool d_frequency_domain_doppler;
+    bool d_pooled_engine;
     bool d_active;
     int d_state;
     bool d_dump;
     unsigned int d_channel;
+    std::shared_ptr<Block_Metrics> d_metrics; // made by set_channel
     std::string d_dump_filename;
+    std::unique_ptr<Acquisition_Grid_Dump> d_grid_dump;
     unsigned int d_peak;
+    Auxiliary_Peak_Detector d_aux_peaks;
+    std::vector<Auxiliary_Peak_Detector> d_line_peaks; // one per Doppler line
+    Acquired_Peaks d_acquired_peaks;
+    unsigned int d_peak_list_max_age_ms;
+    std::shared_ptr<Sample_History> d_history;
+    unsigned long int d_history_next; // first sample stamp the next dwell may read
 
 public:
     /*!
@@ -191,6 +236,7 @@ public:
      void set_channel(unsigned int channel)
      {
          d_channel = channel;
+         d_metrics = make_block_metrics("acquisition", "ch" + std::to_string(channel));
      }
 
      /*!
@@ -221,6 +267,80 @@ public:
          d_doppler_step = doppler_step;
      }
 
+     /*!
+      * \brief Search the Doppler bins by rotating the code spectrum instead
+      * of wiping off each bin (see Frequency_Domain_Doppler). Takes effect
+      * at the next init().
+      */
+     void set_frequency_domain_doppler(bool frequency_domain_doppler)
+     {
+         d_frequency_domain_doppler = frequency_domain_doppler;
+     }
+
+     /*!
+      * \brief Attaches the direct FFT plan and the buffers of the search
+      * (including the Frequency_Domain_Doppler ones) only while an
+      * acquisition is active, and gives them back to the pools when it
+      * ends, so that many channels in standby cost only their block. Takes
+      * effect at the next init().
+      */
+     void set_pooled_engine(bool pooled_engine)
+     {
+         d_pooled_engine = pooled_engine;
+     }
+
+     /*!
+      * \brief Searches first a narrow window around the last known state of a
+      * GPS satellite (see Reacquisition_Hints), if it is at most max_age_ms
+      * old, and the full grid only if it is not found there. Takes effect at
+      * the next init().
+      */
+     void set_reacquisition(bool reacquisition, unsigned int doppler_window_hz,
+             unsigned int code_window_samples, unsigned int max_age_ms)
+     {
+         d_reacquisition = reacquisition;
+         d_reacquisition_doppler_window_hz = doppler_window_hz;
+         d_reacquisition_code_window_samples = code_window_samples;
+         d_reacquisition_max_age_ms = max_age_ms;
+     }
+
+     /*!
+      * \brief Acquires the auxiliary peaks (peak > 1) from the peak list of
+      * the last full search of the satellite, if it is at most max_age_ms old,
+      * instead of searching again. 0 disables it.
+      */
+     void set_peak_list_max_age(unsigned int max_age_ms)
+     {
+         d_peak_list_max_age_ms = max_age_ms;
+     }
+
+     /*!
+      * \brief Searches the auxiliary peaks (peak > 1) of a GPS satellite only
+      * within doppler_window_hz and code_window_samples of the state of the
+      * channel tracking its strongest peak, if it is at most max_age_ms old,
+      * since a credible spoofer peak is that close to the authentic one. The
+      * full grid is searched only without such a state. Takes effect at the
+      * next init().
+      */
+     void set_apt_window(bool apt_windowed, unsigned int doppler_window_hz,
+             unsigned int code_window_samples, unsigned int max_age_ms)
+     {
+         d_apt_windowed = apt_windowed;
+         d_apt_doppler_window_hz = doppler_window_hz;
+         d_apt_code_window_samples = code_window_samples;
+         d_apt_max_age_ms = max_age_ms;
+     }
+
+     /*!
+      * \brief Reads the dwells from the history of the signal conditioner
+      * instead of the input, which then takes single samples and only paces
+      * the block, so no stream_to_vector copies the stream for it. A dwell
+      * is the newest window of the history aligned to the FFT size, and
+      * its Acq_samplestamp_samples is the stamp of its end. Must be called
+      * before the block is connected.
+      */
+     void set_sample_history(const std::shared_ptr<Sample_History>& history);
+
      /*!
       * \brief Parallel Code Phase Search Acquisition signal processing.
       */
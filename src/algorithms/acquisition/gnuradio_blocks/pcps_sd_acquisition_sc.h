@@ -52,11 +52,16 @@
 #define GNSS_SDR_PCPS_SD_ACQUISITION_SC_H_
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <gnuradio/block.h>
 #include <gnuradio/gr_complex.h>
 #include <gnuradio/fft/fft.h>
 #include "gnss_synchro.h"
+#include "acquisition_cache.h"
+#include "carrier_wipeoff_16ic.h"
+#include "auxiliary_peak_detector.h"
+#include "acquisition_grid_dump.h"
 
 class pcps_sd_acquisition_sc;
 
@@ -94,10 +99,6 @@ private:
             bool dump,
             std::string dump_filename);
 
-    void update_local_carrier(gr_complex* carrier_vector,
-            int correlator_length_samples,
-            float freq);
-
     long d_fs_in;
     long d_freq;
     int d_samples_per_ms;
@@ -112,10 +113,10 @@ private:
     unsigned int d_well_count;
     unsigned int d_fft_size;
     unsigned long int d_sample_counter;
-    gr_complex** d_grid_doppler_wipeoffs;
+    std::unique_ptr<Carrier_Wipeoff_16ic> d_wipeoff;
     unsigned int d_num_doppler_bins;
-    gr_complex* d_fft_codes;
-    gr_complex* d_in_32fc;
+    std::shared_ptr<const Code_Fft> d_code_fft;
+    const gr_complex* d_fft_codes;
     gr::fft::fft_complex* d_fft_if;
     gr::fft::fft_complex* d_ifft;
     Gnss_Synchro *d_gnss_synchro;
@@ -133,7 +134,9 @@ private:
     bool d_dump;
     unsigned int d_channel;
     std::string d_dump_filename;
+    std::unique_ptr<Acquisition_Grid_Dump> d_grid_dump;
     unsigned int d_peak;
+    Auxiliary_Peak_Detector d_aux_peaks;
 
 public:
     /*!
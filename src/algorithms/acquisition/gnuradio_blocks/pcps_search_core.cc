@@ -0,0 +1,111 @@
+/*!
+ * \file pcps_search_core.cc
+ * \brief Detector statistics of the Doppler search shared by the PCPS
+ * acquisition blocks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "pcps_search_core.h"
+#include <volk/volk.h>
+
+const gr_complex* Best_Code_Statistic::line(unsigned int doppler_index __attribute__((unused)),
+        const gr_complex* input_fft, Acquisition_Scratch& scratch, Doppler_Line_Max& max) const
+{
+#if VOLK_GT_122
+    uint16_t indext = 0;
+#else
+    unsigned int indext = 0;
+#endif
+    gr::fft::fft_complex* ifft = scratch.ifft(fft_size);
+    float* magnitude = scratch.magnitude(fft_size);
+    float fft_normalization_factor = static_cast<float>(fft_size) * static_cast<float>(fft_size);
+
+    max.mag = 0.0;
+    max.index = 0;
+    max.power = 0.0;
+    for (unsigned int code = 0; code < fft_codes.size(); code++)
+        {
+            // Multiply carrier wiped--off, Fourier transformed incoming signal
+            // with the local FFT'd code reference using SIMD operations with VOLK library
+            volk_32fc_x2_multiply_32fc(ifft->get_inbuf(), input_fft, fft_codes[code], fft_size);
+
+            // compute the inverse FFT
+            ifft->execute();
+
+            // Search maximum
+            volk_32fc_magnitude_squared_32f(magnitude, ifft->get_outbuf(), fft_size);
+            volk_32f_index_max_16u(&indext, magnitude, fft_size);
+
+            // Normalize the maximum value to correct the scale factor introduced by FFTW
+            float magt = magnitude[indext] / (fft_normalization_factor * fft_normalization_factor);
+
+            // Take the greater magnitude
+            if (code == 0 || max.mag < magt)
+                {
+                    max.mag = magt;
+                    max.index = indext;
+                }
+        }
+    return ifft->get_outbuf();
+}
+
+
+const gr_complex* Accumulated_Statistic::line(unsigned int doppler_index,
+        const gr_complex* input_fft, Acquisition_Scratch& scratch, Doppler_Line_Max& max) const
+{
+#if VOLK_GT_122
+    uint16_t indext = 0;
+#else
+    unsigned int indext = 0;
+#endif
+    gr::fft::fft_complex* ifft = scratch.ifft(fft_size);
+    float* magnitude = scratch.magnitude(fft_size);
+    float fft_normalization_factor = static_cast<float>(fft_size) * static_cast<float>(fft_size);
+
+    // Multiply carrier wiped--off, Fourier transformed incoming signal
+    // with the local FFT'd code reference using SIMD operations with VOLK library
+    volk_32fc_x2_multiply_32fc(ifft->get_inbuf(), input_fft, fft_code, fft_size);
+
+    // compute the inverse FFT
+    ifft->execute();
+
+    // Compute vector of test statistics corresponding to current doppler index.
+    volk_32fc_magnitude_squared_32f(magnitude, ifft->get_outbuf(), fft_size);
+    volk_32f_s32f_multiply_32f(magnitude, magnitude,
+            1 / (fft_normalization_factor * fft_normalization_factor * input_power),
+            fft_size);
+
+    // Accumulate test statistics in grid_data.
+    volk_32f_x2_add_32f(grid_data[doppler_index], magnitude, grid_data[doppler_index], fft_size);
+
+    // Search maximum
+    volk_32f_index_max_16u(&indext, grid_data[doppler_index], fft_size);
+    max.mag = grid_data[doppler_index][indext];
+    max.index = indext;
+    max.power = 0.0;
+    return ifft->get_outbuf();
+}
@@ -0,0 +1,195 @@
+/*!
+ * \file pcps_search_core.h
+ * \brief Doppler search shared by the PCPS acquisition blocks, and the
+ * detector statistics it is parametrized with
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PCPS_SEARCH_CORE_H_
+#define GNSS_SDR_PCPS_SEARCH_CORE_H_
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/fft/fft.h>
+#include "acquisition_cache.h"
+#include "acquisition_thread_pool.h"
+#include "gnss_synchro.h"
+
+/*!
+ * \brief Doppler search of a PCPS acquisition block.
+ *
+ * The blocks only differ in how a Doppler line of the grid turns into a
+ * test statistic, and in how the dwells add up to a decision. The core
+ * does the rest: search() gets the FFTs of the wiped off input from the
+ * Acquisition_Cache, where they are shared by all the channels searching
+ * the same dwell, runs the lines on the Acquisition_Thread_Pool, and
+ * writes the dump files. The dwell strategy stays in the block.
+ *
+ * The Statistic computes one line, from several threads at once:
+ *
+ *     const gr_complex* line(unsigned int doppler_index, const gr_complex* input_fft,
+ *             Acquisition_Scratch& scratch, Doppler_Line_Max& max) const;
+ *
+ * It fills max and returns the correlation to dump, and must only write
+ * to max and to the data of its own line.
+ */
+template <class Statistic>
+class Pcps_Search_Core
+{
+public:
+    Pcps_Search_Core() :
+        d_doppler_max(0),
+        d_doppler_step(0),
+        d_dump(false),
+        d_gnss_synchro(0)
+    {}
+
+    Statistic& statistic() { return d_statistic; }
+
+    void set_gnss_synchro(const Gnss_Synchro* gnss_synchro) { d_gnss_synchro = gnss_synchro; }
+
+    //! Writes the correlation of every line to ../data/test_statistics_*.dat
+    void set_dump(bool dump) { d_dump = dump; }
+
+    void set_grid(const std::shared_ptr<const Doppler_Wipeoff_Grid>& grid, unsigned int doppler_max, unsigned int doppler_step)
+    {
+        d_grid = grid;
+        d_doppler_max = doppler_max;
+        d_doppler_step = doppler_step;
+        d_lines.resize(grid->num_doppler_bins());
+    }
+
+    /*!
+     * \brief Searches the dwell in, of grid length samples, with the fft plan of the block
+     */
+    const std::vector<Doppler_Line_Max>& search(unsigned long int sample_stamp, const gr_complex* in, gr::fft::fft_complex* fft)
+    {
+        d_input_ffts = Acquisition_Cache::input_fft_batch(d_grid, sample_stamp, in, fft);
+        Acquisition_Thread_Pool::instance().parallel_for(d_lines.size(),
+                boost::bind(&Pcps_Search_Core::search_line, this, _1, _2));
+        d_input_ffts.reset();
+        return d_lines;
+    }
+
+    /*!
+     * \brief Line with the greatest maximum in the last search, the first one on ties
+     */
+    unsigned int best_line() const
+    {
+        unsigned int best = 0;
+        for (unsigned int doppler_index = 1; doppler_index < d_lines.size(); doppler_index++)
+            {
+                if (d_lines[best].mag < d_lines[doppler_index].mag)
+                    {
+                        best = doppler_index;
+                    }
+            }
+        return best;
+    }
+
+    const std::vector<Doppler_Line_Max>& lines() const { return d_lines; }
+
+    int doppler(unsigned int doppler_index) const
+    {
+        return -static_cast<int>(d_doppler_max) + d_doppler_step * doppler_index;
+    }
+
+private:
+    void search_line(unsigned int doppler_index, Acquisition_Scratch& scratch)
+    {
+        const gr_complex* correlation = d_statistic.line(doppler_index, d_input_ffts->get(doppler_index),
+                scratch, d_lines[doppler_index]);
+
+        // Record results to file if required
+        if (d_dump)
+            {
+                std::stringstream filename;
+                std::streamsize n = 2 * sizeof(float) * d_grid->length(); // complex file write
+                filename << "../data/test_statistics_" << d_gnss_synchro->System
+                         << "_" << d_gnss_synchro->Signal << "_sat_"
+                         << d_gnss_synchro->PRN << "_doppler_" << doppler(doppler_index) << ".dat";
+                // one file per Doppler line, so the lines can be written concurrently
+                std::ofstream dump_file(filename.str().c_str(), std::ios::out | std::ios::binary);
+                dump_file.write((const char*)correlation, n);
+            }
+    }
+
+    Statistic d_statistic;
+    std::shared_ptr<const Doppler_Wipeoff_Grid> d_grid;
+    std::shared_ptr<const Input_Fft_Batch> d_input_ffts;
+    std::vector<Doppler_Line_Max> d_lines;
+    unsigned int d_doppler_max;
+    unsigned int d_doppler_step;
+    bool d_dump;
+    const Gnss_Synchro* d_gnss_synchro;
+};
+
+
+/*!
+ * \brief Statistic of the searches with several local codes, such as the
+ * two 8 ms codes of galileo_pcps_8ms_acquisition_cc: the greatest
+ * squared magnitude of the correlations with any of them, normalized by
+ * the FFT scale factor. The first code wins on ties.
+ */
+struct Best_Code_Statistic
+{
+    Best_Code_Statistic() : fft_size(0) {}
+
+    const gr_complex* line(unsigned int doppler_index, const gr_complex* input_fft,
+            Acquisition_Scratch& scratch, Doppler_Line_Max& max) const;
+
+    std::vector<const gr_complex*> fft_codes; //!< Conjugated code FFTs
+    unsigned int fft_size;
+};
+
+
+/*!
+ * \brief Statistic of the non-coherent searches of pcps_tong_acquisition_cc:
+ * the squared magnitude of the correlation, normalized by the FFT scale
+ * factor and the input power, is added to the grid of the previous dwells
+ * and the line maximum is taken on the sum. The block clears the grid
+ * when it starts a new acquisition.
+ */
+struct Accumulated_Statistic
+{
+    Accumulated_Statistic() : fft_code(0), fft_size(0), input_power(0.0), grid_data(0) {}
+
+    const gr_complex* line(unsigned int doppler_index, const gr_complex* input_fft,
+            Acquisition_Scratch& scratch, Doppler_Line_Max& max) const;
+
+    const gr_complex* fft_code;
+    unsigned int fft_size;
+    float input_power;  //!< Of the dwell being searched
+    float** grid_data;  //!< fft_size accumulated values per Doppler line
+};
+
+#endif
@@ -0,0 +1,395 @@
+/*!
+ * \file pcps_server_acquisition_cc.cc
+ * \brief This class implements a Parallel Code Phase Search Acquisition
+ * whose searches run in the acquisition server of the machine.
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "pcps_server_acquisition_cc.h"
+#include <cmath>
+#include <cstring>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+#include <volk/volk.h>
+#include "channel_event.h"
+
+using google::LogMessage;
+
+pcps_server_acquisition_cc_sptr pcps_make_server_acquisition_cc(
+                                 unsigned int sampled_ms, unsigned int max_dwells,
+                                 unsigned int doppler_max, long freq, long fs_in,
+                                 int samples_per_ms, int samples_per_code,
+                                 bool use_CFAR_algorithm_flag,
+                                 std::string server_filename, unsigned int server_timeout_ms)
+{
+    return pcps_server_acquisition_cc_sptr(
+            new pcps_server_acquisition_cc(sampled_ms, max_dwells, doppler_max, freq, fs_in, samples_per_ms,
+                                     samples_per_code, use_CFAR_algorithm_flag, server_filename, server_timeout_ms));
+}
+
+
+pcps_server_acquisition_cc::pcps_server_acquisition_cc(
+                         unsigned int sampled_ms, unsigned int max_dwells,
+                         unsigned int doppler_max, long freq, long fs_in,
+                         int samples_per_ms, int samples_per_code,
+                         bool use_CFAR_algorithm_flag,
+                         std::string server_filename, unsigned int server_timeout_ms) :
+    gr::block("pcps_server_acquisition_cc",
+    gr::io_signature::make(1, 1, sizeof(gr_complex) * sampled_ms * samples_per_ms),
+    gr::io_signature::make(0, 0, 0))
+{
+    this->message_port_register_out(pmt::mp("events"));
+    d_sample_counter = 0;    // SAMPLE COUNTER
+    d_active = false;
+    d_state = 0;
+    d_freq = freq;
+    d_fs_in = fs_in;
+    d_samples_per_ms = samples_per_ms;
+    d_samples_per_code = samples_per_code;
+    d_sampled_ms = sampled_ms;
+    d_max_dwells = max_dwells;
+    d_well_count = 0;
+    d_doppler_max = doppler_max;
+    d_fft_size = d_sampled_ms * d_samples_per_ms;
+    d_mag = 0;
+    d_input_power = 0.0;
+    d_num_doppler_bins = 0;
+    d_use_CFAR_algorithm_flag = use_CFAR_algorithm_flag;
+    d_threshold = 0.0;
+    d_doppler_step = 0;
+    d_test_statistics = 0.0;
+    d_channel = 0;
+    d_server_filename = server_filename;
+    d_timeout_samples = static_cast<unsigned long int>(server_timeout_ms) * static_cast<unsigned long int>(fs_in) / 1000;
+    d_slot = -1;
+    d_submitted_stamp = 0;
+    d_submitted_power = 0.0;
+    d_wait_start = 0;
+    d_code.resize(d_fft_size);
+
+    d_magnitude = static_cast<float*>(volk_malloc(d_fft_size * sizeof(float), volk_get_alignment()));
+
+    d_gnss_synchro = 0;
+}
+
+
+pcps_server_acquisition_cc::~pcps_server_acquisition_cc()
+{
+    cancel();
+    volk_free(d_magnitude);
+}
+
+
+void pcps_server_acquisition_cc::set_local_code(std::complex<float> * code)
+{
+    // the server transforms it, and shares its FFT with all the receivers
+    memcpy(&d_code[0], code, sizeof(gr_complex) * d_fft_size);
+}
+
+
+void pcps_server_acquisition_cc::init()
+{
+    d_gnss_synchro->Flag_valid_acquisition = false;
+    d_gnss_synchro->Flag_valid_symbol_output = false;
+    d_gnss_synchro->Flag_valid_pseudorange = false;
+    d_gnss_synchro->Flag_valid_word = false;
+    d_gnss_synchro->Flag_preamble = false;
+
+    d_gnss_synchro->Acq_delay_samples = 0.0;
+    d_gnss_synchro->Acq_doppler_hz = 0.0;
+    d_gnss_synchro->Acq_samplestamp_samples = 0;
+    d_mag = 0.0;
+    d_input_power = 0.0;
+
+    cancel();
+    d_num_doppler_bins = ceil( static_cast<double>(static_cast<int>(d_doppler_max) - static_cast<int>(-d_doppler_max)) / static_cast<double>(d_doppler_step));
+    d_lines.resize(d_num_doppler_bins);
+
+    d_link = Acquisition_Server_Link::shared(d_server_filename);
+    if (d_link->is_open() && (d_fft_size > d_link->max_samples() || d_num_doppler_bins > d_link->max_doppler_bins()))
+        {
+            LOG(WARNING) << "The acquisition server " << d_server_filename << " takes up to " << d_link->max_samples()
+                         << " samples and " << d_link->max_doppler_bins() << " Doppler bins, channel " << d_channel
+                         << " needs " << d_fft_size << " and " << d_num_doppler_bins;
+        }
+}
+
+
+void pcps_server_acquisition_cc::cancel()
+{
+    if (d_slot >= 0)
+        {
+            d_link->cancel(d_slot);
+            d_slot = -1;
+        }
+}
+
+
+void pcps_server_acquisition_cc::set_state(int state)
+{
+    d_state = state;
+    if (d_state == 1)
+        {
+            d_gnss_synchro->Acq_delay_samples = 0.0;
+            d_gnss_synchro->Acq_doppler_hz = 0.0;
+            d_gnss_synchro->Acq_samplestamp_samples = 0;
+            d_well_count = 0;
+            d_mag = 0.0;
+            d_input_power = 0.0;
+            d_test_statistics = 0.0;
+            cancel();
+            d_wait_start = d_sample_counter;
+        }
+    else if (d_state == 0)
+        {
+            cancel();
+        }
+    else
+        {
+            LOG(ERROR) << "State can only be set to 0 or 1";
+        }
+}
+
+
+bool pcps_server_acquisition_cc::submit(const gr_complex* in)
+{
+    if (!d_link || !d_link->is_open())
+        {
+            // the server may have been started since
+            d_link = Acquisition_Server_Link::shared(d_server_filename);
+        }
+    Acquisition_Server_Request request;
+    memset(&request, 0, sizeof(request));
+    request.sample_stamp = d_sample_counter;
+    request.fs_in = d_fs_in;
+    request.freq = d_freq;
+    request.doppler_max = d_doppler_max;
+    request.doppler_step = d_doppler_step;
+    request.num_doppler_bins = d_num_doppler_bins;
+    request.fft_size = d_fft_size;
+    request.PRN = d_gnss_synchro->PRN;
+    request.system = d_gnss_synchro->System;
+    memcpy(request.signal, d_gnss_synchro->Signal, sizeof(request.signal));
+    d_slot = d_link->submit(request, in, &d_code[0]);
+    if (d_slot < 0)
+        {
+            return false;
+        }
+    d_submitted_stamp = d_sample_counter;
+    d_submitted_power = 0.0;
+    if (d_use_CFAR_algorithm_flag == true)
+        {
+            // 1- (optional) Compute the input signal power estimation
+            volk_32fc_magnitude_squared_32f(d_magnitude, in, d_fft_size);
+            volk_32f_accumulator_s32f(&d_submitted_power, d_magnitude, d_fft_size);
+            d_submitted_power /= static_cast<float>(d_fft_size);
+        }
+    return true;
+}
+
+
+void pcps_server_acquisition_cc::evaluate_lines()
+{
+    float fft_normalization_factor = static_cast<float>(d_fft_size) * static_cast<float>(d_fft_size);
+    d_input_power = d_submitted_power;
+    d_mag = 0.0;
+    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
+        {
+            int doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * doppler_index;
+            const Doppler_Line_Max& line = d_lines[doppler_index];
+            float magt = line.mag;
+
+            if (d_use_CFAR_algorithm_flag == true)
+                {
+                    // Normalize the maximum value to correct the scale factor introduced by the FFTs
+                    magt = line.mag / (fft_normalization_factor * fft_normalization_factor);
+                }
+
+            // 4- record the maximum peak and the associated synchronization parameters
+            if (d_mag < magt)
+                {
+                    d_mag = magt;
+
+                    if (d_use_CFAR_algorithm_flag == false)
+                        {
+                            // Search grid noise floor approximation for this doppler line
+                            d_input_power = (line.power - d_mag) / (d_fft_size - 1);
+                        }
+
+                    d_gnss_synchro->Acq_delay_samples = static_cast<double>(line.index % d_samples_per_code);
+                    d_gnss_synchro->Acq_doppler_hz = static_cast<double>(doppler);
+                    d_gnss_synchro->Acq_samplestamp_samples = d_submitted_stamp;
+
+                    // 5- Compute the test statistics and compare to the threshold
+                    d_test_statistics = d_mag / d_input_power;
+                }
+        }
+}
+
+
+int pcps_server_acquisition_cc::general_work(int noutput_items,
+        gr_vector_int &ninput_items, gr_vector_const_void_star &input_items,
+        gr_vector_void_star &output_items __attribute__((unused)))
+{
+
+    switch (d_state)
+    {
+    case 0:
+        {
+            if (d_active)
+                {
+                    //restart acquisition variables
+                    d_gnss_synchro->Acq_delay_samples = 0.0;
+                    d_gnss_synchro->Acq_doppler_hz = 0.0;
+                    d_gnss_synchro->Acq_samplestamp_samples = 0;
+                    d_well_count = 0;
+                    d_mag = 0.0;
+                    d_input_power = 0.0;
+                    d_test_statistics = 0.0;
+                    d_wait_start = d_sample_counter;
+
+                    d_state = 1;
+                }
+
+            d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
+            consume_each(ninput_items[0]);
+
+            break;
+        }
+
+    case 1:
+        {
+            if (d_slot < 0)
+                {
+                    // 2- and 3- Doppler search and FFT-based convolution in the server
+                    const gr_complex *in = (const gr_complex *)input_items[0]; //Get the input samples pointer
+                    d_sample_counter += d_fft_size; // sample counter
+                    consume_each(1);
+
+                    DLOG(INFO) << "Channel: " << d_channel
+                            << " , submitting acquisition of satellite: " << d_gnss_synchro->System << " " << d_gnss_synchro->PRN
+                            << " ,sample stamp: " << d_sample_counter << ", threshold: "
+                            << d_threshold << ", doppler_max: " << d_doppler_max
+                            << ", doppler_step: " << d_doppler_step;
+
+                    if (submit(in))
+                        {
+                            break;
+                        }
+                    if (!d_link->is_open())
+                        {
+                            LOG(WARNING) << "No acquisition server at " << d_server_filename;
+                            d_state = 3; // Negative acquisition
+                            break;
+                        }
+                    // all the slots are busy: the next dwell is submitted instead
+                }
+            else
+                {
+                    // the samples that arrive meanwhile are not searched
+                    d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
+                    consume_each(ninput_items[0]);
+
+                    if (d_link->poll(d_slot, &d_lines[0]))
+                        {
+                            d_slot = -1;
+                            d_wait_start = d_sample_counter;
+                            d_well_count++;
+                            evaluate_lines();
+
+                            if (d_test_statistics > d_threshold)
+                                {
+                                    d_state = 2; // Positive acquisition
+                                }
+                            else if (d_well_count == d_max_dwells)
+                                {
+                                    d_state = 3; // Negative acquisition
+                                }
+                            break;
+                        }
+                }
+
+            if (d_timeout_samples > 0 && d_sample_counter - d_wait_start > d_timeout_samples)
+                {
+                    LOG(WARNING) << "The acquisition server did not search satellite " << d_gnss_synchro->PRN
+                                 << " of channel " << d_channel << " in time";
+                    cancel();
+                    d_state = 3; // Negative acquisition
+                }
+
+            break;
+        }
+
+    case 2:
+        {
+            // 6.1- Declare positive acquisition using a message port
+            DLOG(INFO) << "positive acquisition";
+            DLOG(INFO) << "satellite " << d_gnss_synchro->System << " " << d_gnss_synchro->PRN;
+            DLOG(INFO) << "sample_stamp " << d_sample_counter;
+            DLOG(INFO) << "test statistics value " << d_test_statistics;
+            DLOG(INFO) << "test statistics threshold " << d_threshold;
+            DLOG(INFO) << "code phase " << d_gnss_synchro->Acq_delay_samples;
+            DLOG(INFO) << "doppler " << d_gnss_synchro->Acq_doppler_hz;
+            DLOG(INFO) << "magnitude " << d_mag;
+            DLOG(INFO) << "input signal power " << d_input_power;
+
+            d_active = false;
+            d_state = 0;
+            d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
+            consume_each(ninput_items[0]);
+
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_POSITIVE_ACQUISITION));
+
+            break;
+        }
+
+    case 3:
+        {
+            // 6.2- Declare negative acquisition using a message port
+            DLOG(INFO) << "negative acquisition";
+            DLOG(INFO) << "satellite " << d_gnss_synchro->System << " " << d_gnss_synchro->PRN;
+            DLOG(INFO) << "sample_stamp " << d_sample_counter;
+            DLOG(INFO) << "test statistics value " << d_test_statistics;
+            DLOG(INFO) << "test statistics threshold " << d_threshold;
+            DLOG(INFO) << "code phase " << d_gnss_synchro->Acq_delay_samples;
+            DLOG(INFO) << "doppler " << d_gnss_synchro->Acq_doppler_hz;
+            DLOG(INFO) << "magnitude " << d_mag;
+            DLOG(INFO) << "input signal power " << d_input_power;
+
+            d_active = false;
+            d_state = 0;
+
+            d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
+            consume_each(ninput_items[0]);
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_NEGATIVE_ACQUISITION));
+
+            break;
+        }
+    }
+
+    return noutput_items;
+}
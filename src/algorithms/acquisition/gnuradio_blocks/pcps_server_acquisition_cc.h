@@ -0,0 +1,217 @@
+/*!
+ * \file pcps_server_acquisition_cc.h
+ * \brief This class implements a Parallel Code Phase Search Acquisition
+ * whose searches run in the acquisition server of the machine.
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PCPS_SERVER_ACQUISITION_CC_H_
+#define GNSS_SDR_PCPS_SERVER_ACQUISITION_CC_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <gnuradio/block.h>
+#include <gnuradio/gr_complex.h>
+#include "gnss_synchro.h"
+#include "acquisition_server_link.h"
+
+class pcps_server_acquisition_cc;
+
+typedef boost::shared_ptr<pcps_server_acquisition_cc> pcps_server_acquisition_cc_sptr;
+
+pcps_server_acquisition_cc_sptr
+pcps_make_server_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
+                         unsigned int doppler_max, long freq, long fs_in,
+                         int samples_per_ms, int samples_per_code,
+                         bool use_CFAR_algorithm_flag,
+                         std::string server_filename, unsigned int server_timeout_ms);
+
+/*!
+ * \brief This class implements a Parallel Code Phase Search Acquisition
+ * whose searches run in an acquisition server shared by all the receivers
+ * of the machine (see Acquisition_Server).
+ *
+ * Each dwell is submitted through the Acquisition_Server_Link with the
+ * local code replica, and the block goes on consuming its input until the
+ * line maxima come back, so the flowgraph never waits for the server: the
+ * synchronization parameters refer to the sample stamp of the dwell
+ * searched, as for the other blocks. The test statistic and the dwell
+ * strategy are those of pcps_cuda_acquisition_cc. A search with no answer
+ * after server_timeout_ms, or that finds no server, is a negative
+ * acquisition. The bit transition mode is not implemented.
+ */
+class pcps_server_acquisition_cc: public gr::block
+{
+private:
+    friend pcps_server_acquisition_cc_sptr
+    pcps_make_server_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
+            unsigned int doppler_max, long freq, long fs_in,
+            int samples_per_ms, int samples_per_code,
+            bool use_CFAR_algorithm_flag,
+            std::string server_filename, unsigned int server_timeout_ms);
+
+    pcps_server_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
+            unsigned int doppler_max, long freq, long fs_in,
+            int samples_per_ms, int samples_per_code,
+            bool use_CFAR_algorithm_flag,
+            std::string server_filename, unsigned int server_timeout_ms);
+
+    bool submit(const gr_complex* in);
+    void evaluate_lines();
+    void cancel();
+
+    long d_fs_in;
+    long d_freq;
+    int d_samples_per_ms;
+    int d_samples_per_code;
+    float d_threshold;
+    unsigned int d_doppler_max;
+    unsigned int d_doppler_step;
+    unsigned int d_sampled_ms;
+    unsigned int d_max_dwells;
+    unsigned int d_well_count;
+    unsigned int d_fft_size;
+    unsigned long int d_sample_counter;
+    unsigned int d_num_doppler_bins;
+    std::vector<gr_complex> d_code;
+    Gnss_Synchro *d_gnss_synchro;
+    float d_mag;
+    float* d_magnitude;
+    float d_input_power;
+    float d_test_statistics;
+    bool d_use_CFAR_algorithm_flag;
+    bool d_active;
+    int d_state;
+    unsigned int d_channel;
+    std::string d_server_filename;
+    unsigned long int d_timeout_samples;
+    std::shared_ptr<Acquisition_Server_Link> d_link;
+    int d_slot;                              // of the search in the server, -1 if none
+    unsigned long int d_submitted_stamp;     // sample stamp of the dwell in the server
+    float d_submitted_power;                 // CFAR input power of that dwell
+    unsigned long int d_wait_start;          // sample counter when the block started to wait for the server
+    std::vector<Doppler_Line_Max> d_lines;
+
+public:
+    /*!
+     * \brief Default destructor.
+     */
+     ~pcps_server_acquisition_cc();
+
+     /*!
+      * \brief Set acquisition/tracking common Gnss_Synchro object pointer
+      * to exchange synchronization data between acquisition and tracking blocks.
+      * \param p_gnss_synchro Satellite information shared by the processing blocks.
+      */
+     void set_gnss_synchro(Gnss_Synchro* p_gnss_synchro)
+     {
+         d_gnss_synchro = p_gnss_synchro;
+     }
+
+     /*!
+      * \brief Returns the maximum peak of grid search.
+      */
+     unsigned int mag()
+     {
+         return d_mag;
+     }
+
+     /*!
+      * \brief Initializes acquisition algorithm.
+      */
+     void init();
+
+     /*!
+      * \brief Sets local code for PCPS acquisition algorithm.
+      * \param code - Pointer to the PRN code.
+      */
+     void set_local_code(std::complex<float> * code);
+
+     /*!
+      * \brief Starts acquisition algorithm, turning from standby mode to
+      * active mode
+      * \param active - bool that activates/deactivates the block.
+      */
+     void set_active(bool active)
+     {
+         d_active = active;
+     }
+
+     /*!
+      * \brief If set to 1, ensures that acquisition starts at the
+      * first available sample.
+      * \param state - int=1 forces start of acquisition
+      */
+     void set_state(int state);
+
+     /*!
+      * \brief Set acquisition channel unique ID
+      * \param channel - receiver channel.
+      */
+     void set_channel(unsigned int channel)
+     {
+         d_channel = channel;
+     }
+
+     /*!
+      * \brief Set statistics threshold of PCPS algorithm.
+      * \param threshold - Threshold for signal detection (check \ref Navitec2012,
+      * Algorithm 1, for a definition of this threshold).
+      */
+     void set_threshold(float threshold)
+     {
+         d_threshold = threshold;
+     }
+
+     /*!
+      * \brief Set maximum Doppler grid search
+      * \param doppler_max - Maximum Doppler shift considered in the grid search [Hz].
+      */
+     void set_doppler_max(unsigned int doppler_max)
+     {
+         d_doppler_max = doppler_max;
+     }
+
+     /*!
+      * \brief Set Doppler steps for the grid search
+      * \param doppler_step - Frequency bin of the search grid [Hz].
+      */
+     void set_doppler_step(unsigned int doppler_step)
+     {
+         d_doppler_step = doppler_step;
+     }
+
+     /*!
+      * \brief Parallel Code Phase Search Acquisition signal processing.
+      */
+     int general_work(int noutput_items, gr_vector_int &ninput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+};
+
+#endif /* GNSS_SDR_PCPS_SERVER_ACQUISITION_CC_H_*/
@@ -49,13 +49,14 @@
  */
 
 #include "pcps_tong_acquisition_cc.h"
-#include <sstream>
 #include <glog/logging.h>
 #include <gnuradio/io_signature.h>
 #include <volk/volk.h>
 #include <volk_gnsssdr/volk_gnsssdr.h>
 #include "control_message_factory.h"
+#include "fft_plan_cache.h"
 #include "GPS_L1_CA.h" //GPS_TWO_PI
+#include "channel_event.h"
 
 using google::LogMessage;
 
@@ -100,24 +101,23 @@ pcps_tong_acquisition_cc::pcps_tong_acquisition_cc(
     d_input_power = 0.0;
     d_num_doppler_bins = 0;
 
-    d_fft_codes = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
     d_magnitude = static_cast<float*>(volk_malloc(d_fft_size * sizeof(float), volk_get_alignment()));
 
     // Direct FFT
-    d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
+    d_fft_if = Fft_Plan_Cache::acquire(d_fft_size, true);
 
-    // Inverse FFT
-    d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+    // The inverse FFTs are run by the search core, with the plans of its threads
+    d_search.statistic().fft_size = d_fft_size;
 
     // For dumping samples into a file
     d_dump = dump;
     d_dump_filename = dump_filename;
+    d_search.set_dump(d_dump);
 
     d_doppler_resolution = 0;
     d_threshold = 0;
     d_doppler_step = 0;
     d_grid_data = 0;
-    d_grid_doppler_wipeoffs = 0;
     d_gnss_synchro = 0;
     d_code_phase = 0;
     d_doppler_freq = 0;
@@ -131,33 +131,23 @@ pcps_tong_acquisition_cc::~pcps_tong_acquisition_cc()
         {
             for (unsigned int i = 0; i < d_num_doppler_bins; i++)
                 {
-                    volk_free(d_grid_doppler_wipeoffs[i]);
                     volk_free(d_grid_data[i]);
                 }
-            delete[] d_grid_doppler_wipeoffs;
             delete[] d_grid_data;
         }
 
-    volk_free(d_fft_codes);
     volk_free(d_magnitude);
 
-    delete d_ifft;
-    delete d_fft_if;
-
-    if (d_dump)
-        {
-            d_dump_file.close();
-        }
+    Fft_Plan_Cache::release(d_fft_if);
 }
 
 void pcps_tong_acquisition_cc::set_local_code(std::complex<float> * code)
 {
     memcpy(d_fft_if->get_inbuf(), code, sizeof(gr_complex)*d_fft_size);
 
-    d_fft_if->execute(); // We need the FFT of local code
-
-    //Conjugate the local code
-    volk_32fc_conjugate_32fc(d_fft_codes, d_fft_if->get_outbuf(), d_fft_size);
+    // The FFT of the local code is shared with the channels searching for the same signal
+    d_code_fft = Acquisition_Cache::code_fft(d_gnss_synchro->System, d_gnss_synchro->Signal, d_gnss_synchro->PRN, d_fft_if);
+    d_search.statistic().fft_code = d_code_fft->get();
 }
 
 void pcps_tong_acquisition_cc::init()
@@ -174,6 +164,13 @@ void pcps_tong_acquisition_cc::init()
     d_mag = 0.0;
     d_input_power = 0.0;
 
+    // Free the data grid of the previous init
+    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
+        {
+            volk_free(d_grid_data[doppler_index]);
+        }
+    delete[] d_grid_data;
+
     // Count the number of bins
     d_num_doppler_bins = 0;
     for (int doppler = static_cast<int>(-d_doppler_max);
@@ -184,18 +181,11 @@ void pcps_tong_acquisition_cc::init()
     }
 
     // Create the carrier Doppler wipeoff signals and allocate data grid.
-    d_grid_doppler_wipeoffs = new gr_complex*[d_num_doppler_bins];
+    d_doppler_grid = Acquisition_Cache::doppler_wipeoff_grid(d_fs_in, d_freq, d_doppler_max, d_doppler_step, d_num_doppler_bins, d_fft_size);
+    d_search.set_grid(d_doppler_grid, d_doppler_max, d_doppler_step);
     d_grid_data = new float*[d_num_doppler_bins];
     for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
         {
-            d_grid_doppler_wipeoffs[doppler_index] = static_cast<gr_complex*>(volk_malloc(d_fft_size * sizeof(gr_complex), volk_get_alignment()));
-
-            int doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * doppler_index;
-            float phase_step_rad = GPS_TWO_PI * (d_freq + doppler) / static_cast<float>(d_fs_in);
-            float _phase[1];
-            _phase[0] = 0;
-            volk_gnsssdr_s32f_sincos_32fc(d_grid_doppler_wipeoffs[doppler_index], - phase_step_rad, _phase, d_fft_size);
-
             d_grid_data[doppler_index] = static_cast<float*>(volk_malloc(d_fft_size * sizeof(float), volk_get_alignment()));
 
             for (unsigned int i = 0; i < d_fft_size; i++)
@@ -203,6 +193,7 @@ void pcps_tong_acquisition_cc::init()
                     d_grid_data[doppler_index][i] = 0;
                 }
         }
+    d_search.statistic().grid_data = d_grid_data;
 }
 
 void pcps_tong_acquisition_cc::set_state(int state)
@@ -240,7 +231,6 @@ int pcps_tong_acquisition_cc::general_work(int noutput_items,
         gr_vector_int &ninput_items, gr_vector_const_void_star &input_items,
         gr_vector_void_star &output_items __attribute__((unused)))
 {
-    int acquisition_message = -1; //0=STOP_CHANNEL 1=ACQ_SUCCEES 2=ACQ_FAIL
 
     switch (d_state)
     {
@@ -278,15 +268,7 @@ int pcps_tong_acquisition_cc::general_work(int noutput_items,
     case 1:
         {
             // initialize acquisition algorithm
-            int doppler;
-#if VOLK_GT_122
-            uint16_t indext = 0;
-#else
-            unsigned int indext = 0;
-#endif
-            float magt = 0.0;
             const gr_complex *in = (const gr_complex *)input_items[0]; //Get the input samples pointer
-            float fft_normalization_factor = static_cast<float>(d_fft_size) * static_cast<float>(d_fft_size);
             d_input_power = 0.0;
             d_mag = 0.0;
 
@@ -305,66 +287,19 @@ int pcps_tong_acquisition_cc::general_work(int noutput_items,
             volk_32f_accumulator_s32f(&d_input_power, d_magnitude, d_fft_size);
             d_input_power /= static_cast<float>(d_fft_size);
 
-            // 2- Doppler frequency search loop
-            for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
-                {
-                    // doppler search steps
-
-                    doppler = -static_cast<int>(d_doppler_max) + d_doppler_step * doppler_index;
-
-                    volk_32fc_x2_multiply_32fc(d_fft_if->get_inbuf(), in,
-                                d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
+            // 2- Doppler frequency search, accumulating the test statistics in d_grid_data
+            d_search.statistic().input_power = d_input_power;
+            d_search.search(d_sample_counter, in, d_fft_if);
 
-                    // 3- Perform the FFT-based convolution  (parallel time search)
-                    // Compute the FFT of the carrier wiped--off incoming signal
-                    d_fft_if->execute();
-
-                    // Multiply carrier wiped--off, Fourier transformed incoming signal
-                    // with the local FFT'd code reference using SIMD operations with VOLK library
-                    volk_32fc_x2_multiply_32fc(d_ifft->get_inbuf(),
-                                d_fft_if->get_outbuf(), d_fft_codes, d_fft_size);
-
-                    // compute the inverse FFT
-                    d_ifft->execute();
-
-                    // Compute magnitude
-                    volk_32fc_magnitude_squared_32f(d_magnitude, d_ifft->get_outbuf(), d_fft_size);
-
-                    // Compute vector of test statistics corresponding to current doppler index.
-                    volk_32f_s32f_multiply_32f(d_magnitude, d_magnitude,
-                                                1/(fft_normalization_factor*fft_normalization_factor*d_input_power),
-                                                d_fft_size);
-
-                    // Accumulate test statistics in d_grid_data.
-                    volk_32f_x2_add_32f(d_grid_data[doppler_index], d_magnitude, d_grid_data[doppler_index], d_fft_size);
-
-                    // Search maximum
-                    volk_32f_index_max_16u(&indext, d_grid_data[doppler_index], d_fft_size);
-
-                    magt = d_grid_data[doppler_index][indext];
-
-                    // 4- record the maximum peak and the associated synchronization parameters
-                    if (d_mag < magt)
-                        {
-                            d_mag = magt;
-                            d_gnss_synchro->Acq_delay_samples = static_cast<double>(indext % d_samples_per_code);
-                            d_gnss_synchro->Acq_doppler_hz = static_cast<double>(doppler);
-                            d_gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
-                        }
-
-                    // Record results to file if required
-                    if (d_dump)
-                        {
-                            std::stringstream filename;
-                            std::streamsize n = 2 * sizeof(float) * (d_fft_size); // complex file write
-                            filename.str("");
-                            filename << "../data/test_statistics_" << d_gnss_synchro->System
-                                     <<"_" << d_gnss_synchro->Signal << "_sat_"
-                                     << d_gnss_synchro->PRN << "_doppler_" <<  doppler << ".dat";
-                            d_dump_file.open(filename.str().c_str(), std::ios::out | std::ios::binary);
-                            d_dump_file.write((char*)d_ifft->get_outbuf(), n); //write directly |abs(x)|^2 in this Doppler bin?
-                            d_dump_file.close();
-                        }
+            // 4- record the maximum peak and the associated synchronization parameters
+            unsigned int best = d_search.best_line();
+            const Doppler_Line_Max& line = d_search.lines()[best];
+            if (d_mag < line.mag)
+                {
+                    d_mag = line.mag;
+                    d_gnss_synchro->Acq_delay_samples = static_cast<double>(line.index % d_samples_per_code);
+                    d_gnss_synchro->Acq_doppler_hz = static_cast<double>(d_search.doppler(best));
+                    d_gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
                 }
 
             // 5- Compute the test statistics and compare to the threshold
@@ -411,8 +346,7 @@ int pcps_tong_acquisition_cc::general_work(int noutput_items,
             d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
             consume_each(ninput_items[0]);
 
-            acquisition_message = 1;
-            this->message_port_pub(pmt::mp("events"), pmt::from_long(acquisition_message));
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_POSITIVE_ACQUISITION));
 
             break;
         }
@@ -436,8 +370,7 @@ int pcps_tong_acquisition_cc::general_work(int noutput_items,
             d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
             consume_each(ninput_items[0]);
 
-            acquisition_message = 2;
-            this->message_port_pub(pmt::mp("events"), pmt::from_long(acquisition_message));
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_NEGATIVE_ACQUISITION));
 
             break;
         }
@@ -51,12 +51,14 @@
 #ifndef GNSS_SDR_PCPS_TONG_ACQUISITION_CC_H_
 #define GNSS_SDR_PCPS_TONG_ACQUISITION_CC_H_
 
-#include <fstream>
+#include <memory>
 #include <string>
 #include <gnuradio/block.h>
 #include <gnuradio/gr_complex.h>
 #include <gnuradio/fft/fft.h>
 #include "gnss_synchro.h"
+#include "acquisition_cache.h"
+#include "pcps_search_core.h"
 
 class pcps_tong_acquisition_cc;
 
@@ -108,12 +110,12 @@ private:
     unsigned int d_tong_max_val;
     unsigned int d_fft_size;
     unsigned long int d_sample_counter;
-    gr_complex** d_grid_doppler_wipeoffs;
+    std::shared_ptr<const Doppler_Wipeoff_Grid> d_doppler_grid;
     unsigned int d_num_doppler_bins;
-    gr_complex* d_fft_codes;
+    std::shared_ptr<const Code_Fft> d_code_fft;
     float** d_grid_data;
+    Pcps_Search_Core<Accumulated_Statistic> d_search;
     gr::fft::fft_complex* d_fft_if;
-    gr::fft::fft_complex* d_ifft;
     Gnss_Synchro *d_gnss_synchro;
     unsigned int d_code_phase;
     float d_doppler_freq;
@@ -121,7 +123,6 @@ private:
     float* d_magnitude;
     float d_input_power;
     float d_test_statistics;
-    std::ofstream d_dump_file;
     bool d_active;
     int d_state;
     bool d_dump;
@@ -143,6 +144,7 @@ public:
      void set_gnss_synchro(Gnss_Synchro* p_gnss_synchro)
      {
          d_gnss_synchro = p_gnss_synchro;
+         d_search.set_gnss_synchro(p_gnss_synchro);
      }
 
 
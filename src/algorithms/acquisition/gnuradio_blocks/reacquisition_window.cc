@@ -0,0 +1,198 @@
+/*!
+ * \file reacquisition_window.cc
+ * \brief Implementation of the narrow search window used to reacquire a satellite
+ * signal close to where it was last tracked or found
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "reacquisition_window.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include "gnss_synchro.h"
+
+
+Reacquisition_Hints::Reacquisition_Hints() : d_receiver_state(Receiver_State::current())
+{}
+
+
+bool Reacquisition_Hints::get(unsigned int PRN, unsigned int peak, unsigned long int sample_stamp,
+        unsigned long int max_age, Reacquisition_Hint& hint) const
+{
+    // the tracking state is the most recent and precise one
+    Gnss_Synchro tracked;
+    if (d_receiver_state->gps_reacquisition_map.read(reacquisition_key(PRN, peak), tracked) &&
+            tracked.sample_counter <= sample_stamp && sample_stamp - tracked.sample_counter <= max_age)
+        {
+            hint.doppler_hz = tracked.Carrier_Doppler_hz;
+            hint.code_start = tracked.sample_counter;
+            return true;
+        }
+    if (peak < 2)
+        {
+            return false;
+        }
+    Acquired_Peaks stored;
+    if (!d_receiver_state->auxiliary_peaks_map.read(PRN, stored) || stored.peaks.size() < peak ||
+            stored.block_start > sample_stamp || sample_stamp - stored.block_start > max_age)
+        {
+            return false;
+        }
+    const Acq_Peak& found = stored.peaks[peak - 1];
+    hint.doppler_hz = found.doppler;
+    hint.code_start = stored.block_start + found.code_phase;
+    return true;
+}
+
+
+void Reacquisition_Hints::set_auxiliary_peaks(unsigned int PRN, const Acquired_Peaks& peaks)
+{
+    d_receiver_state->auxiliary_peaks_map.add(PRN, peaks);
+}
+
+
+bool Reacquisition_Hints::auxiliary_peaks(unsigned int PRN, Acquired_Peaks& peaks) const
+{
+    return d_receiver_state->auxiliary_peaks_map.read(PRN, peaks);
+}
+
+
+Reacquisition_Window::Reacquisition_Window(long fs_in, int samples_per_code, double carrier_freq_hz,
+        unsigned int doppler_max, unsigned int doppler_step, unsigned int num_doppler_bins,
+        unsigned int doppler_window_hz, unsigned int code_window_samples) :
+        d_fs_in(fs_in),
+        d_samples_per_code(samples_per_code),
+        d_carrier_freq_hz(carrier_freq_hz),
+        d_doppler_max(doppler_max),
+        d_doppler_step(doppler_step),
+        d_grid_bins(num_doppler_bins),
+        d_doppler_window_hz(doppler_window_hz),
+        d_code_window_samples(code_window_samples),
+        d_first_doppler_index(0),
+        d_num_doppler_bins(num_doppler_bins),
+        d_code_phase(0),
+        d_code_ambiguity(0)
+{}
+
+
+bool Reacquisition_Window::center(const Reacquisition_Hint& hint, unsigned long int block_start)
+{
+    // bins with |doppler - hint.doppler_hz| <= d_doppler_window_hz, the nearest one at least
+    double position = (hint.doppler_hz + static_cast<double>(d_doppler_max)) / static_cast<double>(d_doppler_step);
+    double half_width = static_cast<double>(d_doppler_window_hz) / static_cast<double>(d_doppler_step);
+    double first = std::ceil(position - half_width);
+    double last = std::floor(position + half_width);
+    if (first > last)
+        {
+            first = last = std::floor(position + 0.5);
+        }
+    first = std::max(first, 0.0);
+    last = std::min(last, static_cast<double>(d_grid_bins) - 1.0);
+    if (first > last)
+        {
+            return false;
+        }
+    d_first_doppler_index = static_cast<unsigned int>(first);
+    d_num_doppler_bins = static_cast<unsigned int>(last - first) + 1;
+    center_code(hint, block_start);
+    return true;
+}
+
+
+void Reacquisition_Window::center_code(const Reacquisition_Hint& hint, unsigned long int block_start)
+{
+    // the code period shrinks with the code Doppler
+    double period = static_cast<double>(d_samples_per_code) / (1.0 + hint.doppler_hz / d_carrier_freq_hz);
+    double code_phase = std::fmod(static_cast<double>(hint.code_start) - static_cast<double>(block_start), period);
+    if (code_phase < 0.0)
+        {
+            code_phase += period;
+        }
+    d_code_phase = static_cast<unsigned int>(std::floor(code_phase + 0.5)) % d_samples_per_code;
+}
+
+
+unsigned int Reacquisition_Window::first_code_phase() const
+{
+    int half_width = std::min(static_cast<int>(d_code_window_samples), (d_samples_per_code - 1) / 2);
+    return (static_cast<int>(d_code_phase) - half_width + d_samples_per_code) % d_samples_per_code;
+}
+
+
+unsigned int Reacquisition_Window::num_code_phases() const
+{
+    return 2 * std::min(static_cast<int>(d_code_window_samples), (d_samples_per_code - 1) / 2) + 1;
+}
+
+
+unsigned int Reacquisition_Window::index_max(const float* magnitude, unsigned int length) const
+{
+    // with a code ambiguity, each of its periods holds a candidate code start
+    int period = d_samples_per_code;
+    if (d_code_ambiguity > 0 && static_cast<int>(d_code_ambiguity) < d_samples_per_code)
+        {
+            period = d_code_ambiguity;
+        }
+    int code_phase = static_cast<int>(d_code_phase) % period;
+    unsigned int best = code_phase;
+    float best_mag = -1.0;
+    int half_width = std::min(static_cast<int>(d_code_window_samples), (period - 1) / 2);
+    for (unsigned int start = 0; start < length; start += period)
+        {
+            for (int offset = -half_width; offset <= half_width; offset++)
+                {
+                    int phase = (code_phase + offset + period) % period;
+                    unsigned int i = start + phase;
+                    if (i < length && magnitude[i] > best_mag)
+                        {
+                            best_mag = magnitude[i];
+                            best = i;
+                        }
+                }
+        }
+    return best;
+}
+
+
+void Reacquisition_Window::clear_outside(float* magnitude, unsigned int length) const
+{
+    int period = d_samples_per_code;
+    if (d_code_ambiguity > 0 && static_cast<int>(d_code_ambiguity) < d_samples_per_code)
+        {
+            period = d_code_ambiguity;
+        }
+    int code_phase = static_cast<int>(d_code_phase) % period;
+    int half_width = std::min(static_cast<int>(d_code_window_samples), (period - 1) / 2);
+    for (unsigned int i = 0; i < length; i++)
+        {
+            int distance = std::abs(static_cast<int>(i % period) - code_phase);
+            if (std::min(distance, period - distance) > half_width)
+                {
+                    magnitude[i] = 0.0;
+                }
+        }
+}
@@ -0,0 +1,157 @@
+/*!
+ * \file reacquisition_window.h
+ * \brief Interface of the narrow search window used to reacquire a satellite
+ * signal close to where it was last tracked or found
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_REACQUISITION_WINDOW_H_
+#define GNSS_SDR_REACQUISITION_WINDOW_H_
+
+#include <memory>
+#include <vector>
+#include "auxiliary_peak_detector.h"
+#include "receiver_state.h"
+
+/*!
+ * \brief Where a satellite signal is expected to be found again.
+ */
+struct Reacquisition_Hint
+{
+    double doppler_hz;            //!< Carrier Doppler [Hz]
+    unsigned long int code_start; //!< Sample stamp of the start of a code period [samples]
+};
+
+
+/*!
+ * \brief Sources of reacquisition hints.
+ *
+ * The tracking blocks keep their last in-lock state in the
+ * gps_reacquisition_map of the Receiver_State (see reacquisition_key());
+ * the SD acquisition keeps in its auxiliary_peaks_map the distinct
+ * auxiliary peaks of its last full search of each satellite, so that the
+ * channels the SPREE loop assigns to the other peaks of the satellite do
+ * not have to search the full grid again for each of them.
+ * The hints come from the state current at construction, and all the
+ * functions are thread-safe.
+ */
+class Reacquisition_Hints
+{
+public:
+    Reacquisition_Hints();
+
+    /*!
+     * \brief Returns in hint where the peak-th peak (0 or 1: the strongest one) of PRN
+     * was at most max_age samples before sample_stamp
+     */
+    bool get(unsigned int PRN, unsigned int peak, unsigned long int sample_stamp,
+            unsigned long int max_age, Reacquisition_Hint& hint) const;
+
+    /*!
+     * \brief Keeps the ranked peak list of the last full search of PRN
+     */
+    void set_auxiliary_peaks(unsigned int PRN, const Acquired_Peaks& peaks);
+
+    /*!
+     * \brief Returns in peaks the ranked peak list of the last full search of PRN
+     * \return false if PRN has not been searched for auxiliary peaks yet
+     */
+    bool auxiliary_peaks(unsigned int PRN, Acquired_Peaks& peaks) const;
+
+private:
+    std::shared_ptr<Receiver_State> d_receiver_state;
+};
+
+
+/*!
+ * \brief Narrow search window of a PCPS acquisition grid around a hint.
+ *
+ * The Doppler window holds the bins of the grid within doppler_window_hz
+ * of the hint. The code window holds the code phases within
+ * code_window_samples of the hint propagated to the searched block, with
+ * the code period scaled by the code Doppler. A hint of a shorter code
+ * (GPS L1 C/A for a GPS L2 CM search) only gives the code start modulo its
+ * period: the code window is then repeated every set_code_ambiguity()
+ * samples.
+ */
+class Reacquisition_Window
+{
+public:
+    Reacquisition_Window(long fs_in, int samples_per_code, double carrier_freq_hz,
+            unsigned int doppler_max, unsigned int doppler_step, unsigned int num_doppler_bins,
+            unsigned int doppler_window_hz, unsigned int code_window_samples);
+
+    /*!
+     * \brief Centers the window on hint for the block of samples starting at block_start
+     * \return false if the hint Doppler is out of the grid
+     */
+    bool center(const Reacquisition_Hint& hint, unsigned long int block_start);
+
+    /*!
+     * \brief Centers only the code window on hint, for a search with its own Doppler window
+     */
+    void center_code(const Reacquisition_Hint& hint, unsigned long int block_start);
+
+    /*!
+     * \brief Repeats the code window every ambiguity_samples (0 for none) in index_max().
+     * first_code_phase() and num_code_phases() only describe its first repetition.
+     */
+    void set_code_ambiguity(unsigned int ambiguity_samples) { d_code_ambiguity = ambiguity_samples; }
+
+    unsigned int first_doppler_index() const { return d_first_doppler_index; }
+    unsigned int num_doppler_bins() const { return d_num_doppler_bins; } //!< Bins in the window
+    unsigned int code_phase() const { return d_code_phase; }             //!< Center of the code window
+    unsigned int first_code_phase() const;                               //!< Start of the code window
+    unsigned int num_code_phases() const;                                //!< Code phases in the window
+
+    /*!
+     * \brief Index of the maximum of the samples of magnitude whose code phase is in the window
+     */
+    unsigned int index_max(const float* magnitude, unsigned int length) const;
+
+    /*!
+     * \brief Zeroes the samples of magnitude whose code phase is out of the window,
+     * so that a search for local maxima only finds those in the window
+     */
+    void clear_outside(float* magnitude, unsigned int length) const;
+
+private:
+    long d_fs_in;
+    int d_samples_per_code;
+    double d_carrier_freq_hz;
+    unsigned int d_doppler_max;
+    unsigned int d_doppler_step;
+    unsigned int d_grid_bins;
+    unsigned int d_doppler_window_hz;
+    unsigned int d_code_window_samples;
+    unsigned int d_first_doppler_index;
+    unsigned int d_num_doppler_bins;
+    unsigned int d_code_phase;
+    unsigned int d_code_ambiguity;
+};
+
+#endif
@@ -77,8 +77,6 @@ Channel::Channel(ConfigurationInterface *configuration, unsigned int channel,
 
     acq_->set_threshold(threshold);
 
-    acq_->init();
-
     repeat_ = configuration->property("Acquisition_" + implementation_ + boost::lexical_cast<std::string>(channel_) + ".repeat_satellite", false);
     DLOG(INFO) << "Channel " << channel_ << " satellite repeat = " << repeat_;
 
@@ -88,6 +86,24 @@ Channel::Channel(ConfigurationInterface *configuration, unsigned int channel,
     channel_fsm_.set_queue(queue_);
 
     connected_ = false;
+    elide_pass_through_ = configuration->property("Receiver.elide_pass_through", true);
+
+    fused_telemetry_ = false;
+    if (configuration->property("Receiver.fused_channels", false))
+        {
+            boost::shared_ptr<Gnss_Synchro_Stage_Host> host = boost::dynamic_pointer_cast<Gnss_Synchro_Stage_Host>(trk_->get_right_block());
+            boost::shared_ptr<Gnss_Synchro_Stage> stage = boost::dynamic_pointer_cast<Gnss_Synchro_Stage>(nav_->get_left_block());
+            if (host and stage)
+                {
+                    host->set_synchro_stage(stage);
+                    fused_telemetry_ = true;
+                }
+            else
+                {
+                    LOG(INFO) << "Channel " << channel_ << ": " << trk_->implementation() << " cannot run "
+                              << nav_->implementation() << " inline, they stay separate blocks";
+                }
+        }
 
     gnss_signal_ = Gnss_Signal(implementation_);
 
@@ -107,27 +123,39 @@ void Channel::connect(gr::top_block_sptr top_block)
             LOG(WARNING) << "channel already connected internally";
             return;
         }
-    pass_through_->connect(top_block);
     acq_->connect(top_block);
     trk_->connect(top_block);
     nav_->connect(top_block);
 
     //Synchronous ports
-    top_block->connect(pass_through_->get_right_block(), 0, acq_->get_left_block(), 0);
-    DLOG(INFO) << "pass_through_ -> acquisition";
-    top_block->connect(pass_through_->get_right_block(), 0, trk_->get_left_block(), 0);
-    DLOG(INFO) << "pass_through_ -> tracking";
-    top_block->connect(trk_->get_right_block(), 0, nav_->get_left_block(), 0);
-    DLOG(INFO) << "tracking -> telemetry_decoder";
+    if (!elide_pass_through_)
+        {
+            pass_through_->connect(top_block);
+            top_block->connect(pass_through_->get_right_block(), 0, acq_->get_left_block(), 0);
+            DLOG(INFO) << "pass_through_ -> acquisition";
+            top_block->connect(pass_through_->get_right_block(), 0, trk_->get_left_block(), 0);
+            DLOG(INFO) << "pass_through_ -> tracking";
+        }
+    if (fused_telemetry_)
+        {
+            // the telemetry decoder runs in the tracking block, and publishes on its ports
+            top_block->msg_connect(trk_->get_right_block(), pmt::mp("preamble_timestamp_s"), trk_->get_right_block(), pmt::mp("preamble_timestamp_s"));
+            DLOG(INFO) << "tracking with telemetry decoder inline";
+        }
+    else
+        {
+            top_block->connect(trk_->get_right_block(), 0, nav_->get_left_block(), 0);
+            DLOG(INFO) << "tracking -> telemetry_decoder";
 
-    // Message ports
-    top_block->msg_connect(nav_->get_left_block(), pmt::mp("preamble_timestamp_s"), trk_->get_right_block(), pmt::mp("preamble_timestamp_s"));
-    DLOG(INFO) << "MSG FEEDBACK CHANNEL telemetry_decoder -> tracking";
+            // Message ports
+            top_block->msg_connect(nav_->get_left_block(), pmt::mp("preamble_timestamp_s"), trk_->get_right_block(), pmt::mp("preamble_timestamp_s"));
+            DLOG(INFO) << "MSG FEEDBACK CHANNEL telemetry_decoder -> tracking";
+            top_block->msg_connect(nav_->get_right_block(), pmt::mp("events"), channel_msg_rx, pmt::mp("events"));
+        }
 
     //std::cout<<"has port: "<<trk_->get_right_block()->has_msg_port(pmt::mp("events"))<<std::endl;
     top_block->msg_connect(acq_->get_right_block(), pmt::mp("events"), channel_msg_rx, pmt::mp("events"));
     top_block->msg_connect(trk_->get_right_block(), pmt::mp("events"), channel_msg_rx, pmt::mp("events"));
-    top_block->msg_connect(nav_->get_right_block(), pmt::mp("events"), channel_msg_rx, pmt::mp("events"));
 
     connected_ = true;
 }
@@ -140,10 +168,16 @@ void Channel::disconnect(gr::top_block_sptr top_block)
             LOG(WARNING) << "Channel already disconnected internally";
             return;
         }
-    top_block->disconnect(pass_through_->get_right_block(), 0, acq_->get_left_block(), 0);
-    top_block->disconnect(pass_through_->get_right_block(), 0, trk_->get_left_block(), 0);
-    top_block->disconnect(trk_->get_right_block(), 0, nav_->get_left_block(), 0);
-    pass_through_->disconnect(top_block);
+    if (!elide_pass_through_)
+        {
+            top_block->disconnect(pass_through_->get_right_block(), 0, acq_->get_left_block(), 0);
+            top_block->disconnect(pass_through_->get_right_block(), 0, trk_->get_left_block(), 0);
+            pass_through_->disconnect(top_block);
+        }
+    if (!fused_telemetry_)
+        {
+            top_block->disconnect(trk_->get_right_block(), 0, nav_->get_left_block(), 0);
+        }
     acq_->disconnect(top_block);
     trk_->disconnect(top_block);
     nav_->disconnect(top_block);
@@ -153,12 +187,35 @@ void Channel::disconnect(gr::top_block_sptr top_block)
 
 gr::basic_block_sptr Channel::get_left_block()
 {
+    if (elide_pass_through_)
+        {
+            return trk_->get_left_block();
+        }
     return pass_through_->get_left_block();
 }
 
 
+void Channel::connect_input(gr::top_block_sptr top_block, gr::basic_block_sptr source, int port)
+{
+    if (elide_pass_through_)
+        {
+            top_block->connect(source, port, acq_->get_left_block(), 0);
+            top_block->connect(source, port, trk_->get_left_block(), 0);
+            DLOG(INFO) << "input -> acquisition, tracking";
+        }
+    else
+        {
+            top_block->connect(source, port, pass_through_->get_left_block(), 0);
+        }
+}
+
+
 gr::basic_block_sptr Channel::get_right_block()
 {
+    if (fused_telemetry_)
+        {
+            return trk_->get_right_block();
+        }
     return nav_->get_right_block();
 }
 
@@ -181,6 +238,12 @@ void Channel::set_signal(const Gnss_Signal& gnss_signal)
 }
 
 
+void Channel::init_acquisition()
+{
+    acq_->init();
+}
+
+
 void Channel::start_acquisition()
 {
     channel_fsm_.Event_start_acquisition();
@@ -192,6 +255,16 @@ void Channel::stop_tracking()
     nav_->reset();
 }
 
+double Channel::cn0_db_hz()
+{
+    return trk_->cn0_db_hz();
+}
+
+void Channel::reconfigure(ConfigurationInterface* configuration)
+{
+    trk_->reconfigure(configuration);
+}
+
 void Channel::set_peak(unsigned int peak_)
 {
     peak = peak_;
@@ -43,6 +43,7 @@
 #include "channel_fsm.h"
 #include "gnss_synchro.h"
 #include "channel_msg_receiver_cc.h"
+#include "gnss_synchro_stage.h"
 
 class ConfigurationInterface;
 class AcquisitionInterface;
@@ -54,6 +55,14 @@ class TelemetryDecoderInterface;
  * a Tracking Interface and a TelemetryDecoderInterface, and handles
  * their interaction through a Finite State Machine
  *
+ * Unless Receiver.elide_pass_through=false, the samples go straight to the
+ * acquisition and the tracking, without the copy of the Pass_Through block
+ * in front of them: connect_input() connects both.
+ *
+ * With Receiver.fused_channels=true, a tracking block that can run the
+ * telemetry decoder inline (Gnss_Synchro_Stage_Host) does, and is then the
+ * right block of the channel: the Gnss_Synchro of each code period no
+ * longer goes through a buffer and a thread of the telemetry decoder.
  */
 class Channel: public ChannelInterface
 {
@@ -69,10 +78,15 @@ public:
     virtual ~Channel();
     void connect(gr::top_block_sptr top_block);
     void disconnect(gr::top_block_sptr top_block);
-    gr::basic_block_sptr get_left_block();
+    gr::basic_block_sptr get_left_block(); //!< The tracking block if the Pass_Through is elided
     gr::basic_block_sptr get_right_block();
     std::string role(){ return role_; }
 
+    //! Connects the output port of source to the input of the channel
+    void connect_input(gr::top_block_sptr top_block, gr::basic_block_sptr source, int port);
+    bool pass_through_elided() const { return elide_pass_through_; }
+    bool telemetry_fused() const { return fused_telemetry_; }
+
     //! Returns "Channel"
     std::string implementation(){ return implementation_; }
     size_t item_size(){ return 0; }
@@ -80,12 +94,21 @@ public:
     std::shared_ptr<AcquisitionInterface> acquisition(){ return acq_; }
     std::shared_ptr<TrackingInterface> tracking(){ return trk_; }
     std::shared_ptr<TelemetryDecoderInterface> telemetry(){ return nav_; }
+    /*!
+     * \brief Builds the Doppler grids and the local code of the acquisition.
+     *
+     * Left out of the constructor, which builds the blocks, so that
+     * GNSSBlockFactory::GetChannels can run it for all the channels at once.
+     */
+    void init_acquisition();
     void start_acquisition();                   //!< Start the State Machine
     void set_signal(const Gnss_Signal& gnss_signal_);  //!< Sets the channel GNSS signal
 
     void msg_handler_events(pmt::pmt_t msg);
 
     void stop_tracking();
+    double cn0_db_hz();
+    void reconfigure(ConfigurationInterface* configuration); //!< Reconfigures the tracking
     void set_peak(unsigned int peak_); //!< set whether the satellite of this channel is already acquired
     void set_state(unsigned int state_); //!< set the state of the channel 
     unsigned int get_state(); //!< get the state of the signal 
@@ -103,6 +126,8 @@ private:
     Gnss_Synchro gnss_synchro_;
     Gnss_Signal gnss_signal_;
     bool connected_;
+    bool elide_pass_through_;
+    bool fused_telemetry_;
     bool repeat_;
     ChannelFsm channel_fsm_;
     boost::shared_ptr<gr::msg_queue> queue_;
@@ -1,6 +1,6 @@
 /*!
  * \file channel_fsm.cc
- * \brief Implementation of a State Machine for channel using boost::statechart
+ * \brief Implementation of a State Machine for channel, driven by a transition table
  * \author Luis Esteve, 2011. luis(at)epsilon-formacion.com
  *
  * -------------------------------------------------------------------------
@@ -30,182 +30,242 @@
 
 #include "channel_fsm.h"
 #include <memory>
-#include <boost/statechart/simple_state.hpp>
-#include <boost/statechart/state.hpp>
-#include <boost/statechart/transition.hpp>
-#include <boost/statechart/custom_reaction.hpp>
-#include <boost/mpl/list.hpp>
-#include <glog/logging.h>
+#include <thread>
 #include "control_message_factory.h"
 
 
-struct Ev_channel_start_acquisition: sc::event<Ev_channel_start_acquisition>
-{};
-
-struct Ev_channel_valid_acquisition: sc::event<Ev_channel_valid_acquisition>
-{};
-
-struct Ev_channel_failed_acquisition_repeat: sc::event<Ev_channel_failed_acquisition_repeat>
-{};
-
-struct Ev_channel_failed_acquisition_no_repeat: sc::event<Ev_channel_failed_acquisition_no_repeat>
-{};
-
-struct Ev_channel_failed_tracking_standby: sc::event<Ev_channel_failed_tracking_standby>
-{};
-
-struct Ev_channel_stop_tracking: sc::event<Ev_channel_stop_tracking>
-{};
-
-//struct Ev_channel_failed_tracking_reacq: sc::event<Ev_channel_failed_tracking_reacq>
-//{};
-
-struct channel_idle_fsm_S0: public sc::state<channel_idle_fsm_S0, ChannelFsm>
+namespace
 {
-public:
-    // sc::transition(event, next state)
-    typedef sc::transition<Ev_channel_start_acquisition, channel_acquiring_fsm_S1> reactions;
-    channel_idle_fsm_S0(my_context ctx) : my_base(ctx)
-    {
-        //std::cout << "Enter Channel_Idle_S0 " << std::endl;
-    }
+// transitions[state][event], NO_TRANSITION discards the event
+constexpr ChannelFsm::State transitions[ChannelFsm::STATES][ChannelFsm::EVENTS] =
+{
+    //                        START_ACQUISITION      VALID_ACQUISITION       FAILED_ACQ_REPEAT      FAILED_ACQ_NO_REPEAT   FAILED_TRACKING_STANDBY  STOP_TRACKING              CHECKED
+    /* IDLE */          { ChannelFsm::ACQUIRING, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION },
+    /* ACQUIRING */     { ChannelFsm::NO_TRANSITION, ChannelFsm::TRACKING, ChannelFsm::ACQUIRING, ChannelFsm::WAITING, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION },
+    /* TRACKING */      { ChannelFsm::ACQUIRING, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION, ChannelFsm::IDLE, ChannelFsm::STOP_TRACKING, ChannelFsm::RELEASED },
+    /* WAITING */       { ChannelFsm::ACQUIRING, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION },
+    /* STOP_TRACKING */ { ChannelFsm::ACQUIRING, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION },
+    /* RELEASED */      { ChannelFsm::ACQUIRING, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION, ChannelFsm::NO_TRANSITION }
 };
+}
 
 
-struct channel_acquiring_fsm_S1: public sc::state<channel_acquiring_fsm_S1, ChannelFsm>
-{
-public:
-    typedef mpl::list<sc::transition<Ev_channel_failed_acquisition_no_repeat, channel_waiting_fsm_S3>,
-                      sc::transition<Ev_channel_failed_acquisition_repeat, channel_acquiring_fsm_S1>,
-                      sc::transition<Ev_channel_valid_acquisition, channel_tracking_fsm_S2> > reactions;
+ChannelFsm::ChannelFsm() : ChannelFsm(nullptr)
+{}
 
-    channel_acquiring_fsm_S1(my_context ctx) : my_base(ctx)
-    {
-        //std::cout << "Enter Channel_Acq_S1 " << std::endl;
-        context<ChannelFsm> ().start_acquisition();
-    }
-    ~channel_acquiring_fsm_S1()
-    {
-        //std::cout << "Exit Channel_Acq_S1 " << std::endl;
-    }
-};
 
 
-struct channel_tracking_fsm_S2: public sc::state<channel_tracking_fsm_S2, ChannelFsm>
+ChannelFsm::ChannelFsm(std::shared_ptr<AcquisitionInterface> acquisition) :
+            acq_(acquisition), state_(IDLE)
 {
-public:
-    typedef mpl::list<sc::transition<Ev_channel_failed_tracking_standby, channel_idle_fsm_S0>,
-                      sc::transition<Ev_channel_stop_tracking, channel_stop_tracking_fsm_S4>,
-                      sc::transition<Ev_channel_start_acquisition, channel_acquiring_fsm_S1>> reactions;
+    trk_ = nullptr;
+    channel_ = 0;
+    terminated_ = false;
+    for (unsigned int i = 0; i < INBOX_SIZE; i++)
+        {
+            inbox_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    inbox_pushed_.store(0);
+    inbox_popped_.store(0);
+    processing_.store(false);
+}
 
-    channel_tracking_fsm_S2(my_context ctx) : my_base(ctx)
-    {
-       //std::cout << "Enter Channel_tracking_S2 " << std::endl;
-        context<ChannelFsm> ().start_tracking();
-    }
 
-    ~channel_tracking_fsm_S2()
-    {
-        //std::cout << "Exit Channel_tracking_S2 " << std::endl;
-        context<ChannelFsm> ().notify_stop_tracking();
-    }
 
-};
+void ChannelFsm::Event_start_acquisition()
+{
+    post(START_ACQUISITION);
+}
 
 
-struct channel_waiting_fsm_S3: public sc::state<channel_waiting_fsm_S3, ChannelFsm>
+void ChannelFsm::Event_valid_acquisition()
 {
-public:
-    typedef sc::transition<Ev_channel_start_acquisition,
-            channel_acquiring_fsm_S1> reactions;
+    post(VALID_ACQUISITION);
+}
 
-    channel_waiting_fsm_S3(my_context ctx) :
-        my_base(ctx)
-    {
-        //std::cout << "Enter Channel_waiting_S3 " << std::endl;
-        context<ChannelFsm> ().request_satellite();
-    }
-   // ~channel_waiting_fsm_S3(){}
-};
 
-struct channel_stop_tracking_fsm_S4: public sc::state<channel_stop_tracking_fsm_S4, ChannelFsm>
+void ChannelFsm::Event_failed_acquisition_repeat()
 {
-public:
-    typedef sc::transition<Ev_channel_start_acquisition,
-            channel_acquiring_fsm_S1> reactions;
+    post(FAILED_ACQUISITION_REPEAT);
+}
 
-    channel_stop_tracking_fsm_S4(my_context ctx) : my_base(ctx)
-    {
-       //std::cout << "Enter Channel_stop_tracking_S4 " << std::endl;
-        context<ChannelFsm> ().stop_tracking();
-    }
+void ChannelFsm::Event_failed_acquisition_no_repeat()
+{
+    post(FAILED_ACQUISITION_NO_REPEAT);
+}
 
-    ~channel_stop_tracking_fsm_S4()
-    {
-       //std::cout << "Exit Channel_stop_tracking_S4 " << std::endl;
-    }
 
-};
+void ChannelFsm::Event_failed_tracking_standby()
+{
+    post(FAILED_TRACKING_STANDBY);
+}
 
+void ChannelFsm::Event_stop_tracking()
+{
+    post(STOP_TRACKING_EVENT);
+}
 
-ChannelFsm::ChannelFsm()
+void ChannelFsm::Event_checked()
 {
-    acq_ = nullptr;
-    trk_ = nullptr;
-    channel_ = 0;
-    initiate(); //start the FSM
+    post(CHECKED);
 }
 
+//void ChannelFsm::Event_failed_tracking_reacq() {
+//    this->process_event(Ev_channel_failed_tracking_reacq());
+//}
 
 
-ChannelFsm::ChannelFsm(std::shared_ptr<AcquisitionInterface> acquisition) :
-            acq_(acquisition)
+void ChannelFsm::terminate()
 {
-    trk_ = nullptr;
-    channel_ = 0;
-    initiate(); //start the FSM
+    bool expected = false;
+    while (!processing_.compare_exchange_weak(expected, true))
+        {
+            expected = false; // another thread is processing the inbox
+        }
+    if (!terminated_)
+        {
+            exit(state_.load(), IDLE);
+            terminated_ = true;
+        }
+    processing_.store(false);
 }
 
 
+void ChannelFsm::post(Event event)
+{
+    while (!push(event))
+        {
+            // full: the events are raised faster than they are processed, help
+            process_inbox();
+            std::this_thread::yield();
+        }
+    process_inbox();
+}
+
 
-void ChannelFsm::Event_start_acquisition()
+// Bounded queue of D. Vyukov: a cell is free for the push number p when its
+// sequence is p, and holds the event of the push p when its sequence is p + 1
+bool ChannelFsm::push(Event event)
 {
-    this->process_event(Ev_channel_start_acquisition());
-    //std::cout<<"Ev_channel_start_acquisition launched"<<std::endl;
+    unsigned int pos = inbox_pushed_.load(std::memory_order_relaxed);
+    Inbox_Cell* cell;
+    for (;;)
+        {
+            cell = &inbox_[pos & (INBOX_SIZE - 1)];
+            int diff = static_cast<int>(cell->sequence.load(std::memory_order_acquire) - pos);
+            if (diff == 0)
+                {
+                    if (inbox_pushed_.compare_exchange_weak(pos, pos + 1))
+                        {
+                            break;
+                        }
+                }
+            else if (diff < 0)
+                {
+                    return false;
+                }
+            else
+                {
+                    pos = inbox_pushed_.load(std::memory_order_relaxed);
+                }
+        }
+    cell->event = event;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
 }
 
 
-void ChannelFsm::Event_valid_acquisition()
+bool ChannelFsm::pop(Event& event)
 {
-    this->process_event(Ev_channel_valid_acquisition());
+    unsigned int pos = inbox_popped_.load(std::memory_order_relaxed);
+    Inbox_Cell* cell = &inbox_[pos & (INBOX_SIZE - 1)];
+    if (cell->sequence.load(std::memory_order_acquire) != pos + 1)
+        {
+            return false;
+        }
+    event = cell->event;
+    cell->sequence.store(pos + INBOX_SIZE, std::memory_order_release);
+    inbox_popped_.store(pos + 1);
+    return true;
 }
 
 
-void ChannelFsm::Event_failed_acquisition_repeat()
+void ChannelFsm::process_inbox()
 {
-    this->process_event(Ev_channel_failed_acquisition_repeat());
+    // an event pushed while another thread held the machine is processed by that
+    // thread, or by this one if it released the machine before seeing it
+    while (inbox_pushed_.load() != inbox_popped_.load())
+        {
+            if (processing_.exchange(true))
+                {
+                    return;
+                }
+            Event event;
+            while (pop(event))
+                {
+                    process(event);
+                }
+            processing_.store(false);
+        }
 }
 
-void ChannelFsm::Event_failed_acquisition_no_repeat()
+
+void ChannelFsm::process(Event event)
 {
-    this->process_event(Ev_channel_failed_acquisition_no_repeat());
+    if (terminated_)
+        {
+            return;
+        }
+    State current = state_.load(std::memory_order_relaxed);
+    State next = transitions[current][event];
+    if (next == NO_TRANSITION)
+        {
+            return;
+        }
+    exit(current, next);
+    state_.store(next);
+    enter(next);
 }
 
 
-// Something is wrong here, we are using a memory after it ts freed
-void ChannelFsm::Event_failed_tracking_standby()
+void ChannelFsm::enter(State state)
 {
-    this->process_event(Ev_channel_failed_tracking_standby());
+    switch (state)
+    {
+    case ACQUIRING:
+        start_acquisition();
+        break;
+    case TRACKING:
+        start_tracking();
+        break;
+    case WAITING:
+        request_satellite();
+        break;
+    case STOP_TRACKING:
+    case RELEASED:
+        stop_tracking();
+        break;
+    default:
+        break;
+    }
 }
 
-void ChannelFsm::Event_stop_tracking()
+
+void ChannelFsm::exit(State state, State next)
 {
-    this->process_event(Ev_channel_stop_tracking());
+    if (state == TRACKING)
+        {
+            if (next == RELEASED)
+                {
+                    notify_released();
+                }
+            else
+                {
+                    notify_stop_tracking();
+                }
+        }
 }
 
-//void ChannelFsm::Event_failed_tracking_reacq() {
-//    this->process_event(Ev_channel_failed_tracking_reacq());
-//}
 
 void ChannelFsm::set_acquisition(std::shared_ptr<AcquisitionInterface> acquisition)
 {
@@ -229,38 +289,56 @@ void ChannelFsm::set_channel(unsigned int channel)
 
 void ChannelFsm::start_acquisition()
 {
-    acq_->reset();
+    if (acq_)
+        {
+            acq_->reset();
+        }
 }
 
 void ChannelFsm::start_tracking()
 {
-    trk_->start_tracking();
-    std::unique_ptr<ControlMessageFactory> cmf(new ControlMessageFactory());
-    if (queue_ != gr::msg_queue::make())
+    if (trk_)
         {
-            queue_->handle(cmf->GetQueueMessage(channel_, 1));
+            trk_->start_tracking();
+        }
+    if (queue_)
+        {
+            ControlMessageFactory cmf;
+            queue_->handle(cmf.GetQueueMessage(channel_, 1));
         }
 }
 
 void ChannelFsm::request_satellite()
 {
-    std::unique_ptr<ControlMessageFactory> cmf(new ControlMessageFactory());
-    if (queue_ != gr::msg_queue::make())
+    if (queue_)
         {
-            queue_->handle(cmf->GetQueueMessage(channel_, 0));
+            ControlMessageFactory cmf;
+            queue_->handle(cmf.GetQueueMessage(channel_, 0));
         }
 }
 
 void ChannelFsm::notify_stop_tracking()
 {
-    std::unique_ptr<ControlMessageFactory> cmf(new ControlMessageFactory());
-    if (queue_ != gr::msg_queue::make())
+    if (queue_)
         {
-            queue_->handle(cmf->GetQueueMessage(channel_, 2));
+            ControlMessageFactory cmf;
+            queue_->handle(cmf.GetQueueMessage(channel_, 2));
+        }
+}
+
+void ChannelFsm::notify_released()
+{
+    if (queue_)
+        {
+            ControlMessageFactory cmf;
+            queue_->handle(cmf.GetQueueMessage(channel_, 4));
         }
 }
 
 void ChannelFsm::stop_tracking()
 {
-    trk_->stop_tracking();
+    if (trk_)
+        {
+            trk_->stop_tracking();
+        }
 }
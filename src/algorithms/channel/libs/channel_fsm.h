@@ -1,6 +1,6 @@
 /*!
  * \file channel_fsm.h
- * \brief Interface of the State Machine for channel using boost::statechart
+ * \brief Interface of the State Machine for channel, driven by a transition table
  * \author Luis Esteve, 2011. luis(at)epsilon-formacion.com
  *
  *
@@ -33,28 +33,50 @@
 #define GNSS_SDR_CHANNEL_FSM_H
 
 
-#include <boost/statechart/state_machine.hpp>
+#include <atomic>
+#include <memory>
 #include <gnuradio/msg_queue.h>
 #include "acquisition_interface.h"
 #include "tracking_interface.h"
 #include "telemetry_decoder_interface.h"
 
 
-namespace sc = boost::statechart;
-namespace mpl = boost::mpl;
-
-struct channel_idle_fsm_S0;
-struct channel_acquiring_fsm_S1;
-struct channel_tracking_fsm_S2;
-struct channel_waiting_fsm_S3;
-struct channel_stop_tracking_fsm_S4;
-
 /*!
- * \brief This class implements a State Machine for channel using boost::statechart
+ * \brief This class implements a State Machine for channel.
+ *
+ * The states and the transitions between them are a constant table, so a
+ * transition allocates nothing. The events can be raised from any thread
+ * (the control thread and the GNU Radio message handlers): they go to a
+ * lock-free inbox, and the thread that finds the machine free processes
+ * them in order, including the events raised by the actions of a state.
  */
-class ChannelFsm: public sc::state_machine<ChannelFsm, channel_idle_fsm_S0>
+class ChannelFsm
 {
 public:
+    enum State
+    {
+        IDLE,            // S0
+        ACQUIRING,       // S1
+        TRACKING,        // S2
+        WAITING,         // S3, the acquisition failed and a new satellite is requested
+        STOP_TRACKING,   // S4
+        RELEASED,        // S5, tracking stopped once the APT checks of its peak passed
+        STATES,
+        NO_TRANSITION = STATES
+    };
+
+    enum Event
+    {
+        START_ACQUISITION,
+        VALID_ACQUISITION,
+        FAILED_ACQUISITION_REPEAT,
+        FAILED_ACQUISITION_NO_REPEAT,
+        FAILED_TRACKING_STANDBY,
+        STOP_TRACKING_EVENT,
+        CHECKED,
+        EVENTS
+    };
+
     ChannelFsm();
     ChannelFsm(std::shared_ptr<AcquisitionInterface> acquisition);
 
@@ -66,6 +88,7 @@ public:
     void start_tracking();
     void request_satellite();
     void notify_stop_tracking();
+    void notify_released();
     void stop_tracking();
 
     //FSM EVENTS
@@ -76,12 +99,40 @@ public:
     //void Event_gps_failed_tracking_reacq();
     void Event_failed_tracking_standby();
     void Event_stop_tracking();
+    //! The auxiliary peak tracked agrees with the other peaks of the satellite
+    void Event_checked();
+
+    //! Leaves the current state (running its exit action), the later events are ignored
+    void terminate();
+    State state() const { return state_.load(); }
 
 private:
+    static const unsigned int INBOX_SIZE = 16; // a power of 2
+
+    struct Inbox_Cell
+    {
+        std::atomic<unsigned int> sequence;
+        Event event;
+    };
+
+    void post(Event event);
+    bool push(Event event);
+    bool pop(Event& event);
+    void process_inbox();
+    void process(Event event);
+    void enter(State state);
+    void exit(State state, State next);
+
     std::shared_ptr<AcquisitionInterface> acq_;
     std::shared_ptr<TrackingInterface> trk_;
     boost::shared_ptr<gr::msg_queue> queue_;
     unsigned int channel_;
+    std::atomic<State> state_;
+    bool terminated_;
+    Inbox_Cell inbox_[INBOX_SIZE];
+    std::atomic<unsigned int> inbox_pushed_;
+    std::atomic<unsigned int> inbox_popped_;   // only advanced by the thread processing the inbox
+    std::atomic<bool> processing_;
 };
 
 #endif /*GNSS_SDR_CHANNEL_FSM_H*/
@@ -33,6 +33,7 @@
 #include <gnuradio/gr_complex.h>
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
+#include "channel_event.h"
 
 using google::LogMessage;
 
@@ -50,12 +51,12 @@ void channel_msg_receiver_cc::msg_handler_events(pmt::pmt_t msg)
             DLOG(INFO) << "!!message: " << message;
             switch (message)
             {
-            case 1: //positive acquisition
+            case CHANNEL_EVENT_POSITIVE_ACQUISITION:
                 //DLOG(INFO) << "Channel " << channel_ << " ACQ SUCCESS satellite " <<
                 //    gnss_synchro_.System << " " << gnss_synchro_.PRN;
                 d_channel_fsm->Event_valid_acquisition();
                 break;
-            case 2: //negative acquisition
+            case CHANNEL_EVENT_NEGATIVE_ACQUISITION:
                 //DLOG(INFO) << "Channel " << channel_
                 //    << " ACQ FAILED satellite " << gnss_synchro_.System << " " << gnss_synchro_.PRN;
                 if (d_repeat == true)
@@ -67,13 +68,17 @@ void channel_msg_receiver_cc::msg_handler_events(pmt::pmt_t msg)
                         d_channel_fsm->Event_failed_acquisition_no_repeat();
                     }
                 break;
-            case 3: // tracking loss of lock event
+            case CHANNEL_EVENT_LOSS_OF_LOCK:
                 d_channel_fsm->Event_failed_tracking_standby();
                 break;
-            case 4: // stop tracking 
+            case CHANNEL_EVENT_STOP_TRACKING:
                 DLOG(INFO) << "Channel stop tracking ";
                 d_channel_fsm->Event_stop_tracking();
                 break;
+            case CHANNEL_EVENT_CHECKED:
+                DLOG(INFO) << "Channel released, its peak is checked";
+                d_channel_fsm->Event_checked();
+                break;
             default:
                 LOG(WARNING) << "Default case, invalid message.";
                 break;
@@ -30,7 +30,9 @@
  */
 
 #include "signal_conditioner.h"
+#include <gnuradio/gr_complex.h>
 #include <glog/logging.h>
+#include "configuration_interface.h"
 
 
 using google::LogMessage;
@@ -43,7 +45,52 @@ SignalConditioner::SignalConditioner(ConfigurationInterface *configuration,
                 in_filt_(in_filt), res_(res), role_(role), implementation_(implementation)
 {
     connected_ = false;
-    if(configuration){ };
+    bool elide = !configuration || configuration->property("Receiver.elide_pass_through", true);
+    std::shared_ptr<GNSSBlockInterface> all[] = {data_type_adapt_, in_filt_, res_};
+    for (int i = 0; i < 3; i++)
+        {
+            if (!elide || all[i]->implementation().compare("Pass_Through") != 0)
+                {
+                    stages_.push_back(all[i]);
+                }
+        }
+    if (stages_.empty())
+        {
+            stages_.push_back(res_);
+        }
+    if (configuration && configuration->property(role_ + ".flight_recorder", false))
+        {
+            // keeps the last seconds of conditioned samples, stored around each spoofing alarm
+            size_t item_size = res_->item_size();
+            if (item_size == 0) item_size = sizeof(gr_complex);
+            double fs = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
+            double pre_trigger_s = configuration->property(role_ + ".flight_recorder_pre_trigger_s", 5.0);
+            double post_trigger_s = configuration->property(role_ + ".flight_recorder_post_trigger_s", 5.0);
+            std::string filename = configuration->property(role_ + ".flight_recorder_filename", "./flight_recorder_" + role_);
+            flight_recorder_ = make_flight_recorder(item_size, fs, pre_trigger_s, post_trigger_s, filename);
+        }
+    if (configuration && configuration->property(role_ + ".spectrum_monitor", false)
+            && res_->item_size() != 0 && res_->item_size() != sizeof(gr_complex))
+        {
+            LOG(WARNING) << role_ << ".spectrum_monitor needs gr_complex samples, the spectrum is not monitored";
+        }
+    else if (configuration && configuration->property(role_ + ".spectrum_monitor", false))
+        {
+            // the power and spectrum of the conditioned samples, an early sign of jamming or spoofing
+            double fs = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
+            std::unique_ptr<Spectrum_Monitor> monitor(new Spectrum_Monitor(fs,
+                    configuration->property(role_ + ".spectrum_monitor_fft_size", 64),
+                    configuration->property(role_ + ".spectrum_monitor_period_ms", 1.0),
+                    configuration->property(role_ + ".spectrum_monitor_report_periods", 10),
+                    configuration->property(role_ + ".spectrum_monitor_floor_s", 10.0)));
+            monitor->set_thresholds(configuration->property("Spoofing.spectrum_power_rise_db", 3.0),
+                    configuration->property("Spoofing.spectrum_deviation_db", 6.0));
+            // SignalConditioner is conditioner 0, SignalConditionerN conditioner N
+            size_t digits = role_.find_last_not_of("0123456789") + 1;
+            unsigned int conditioner_id = digits < role_.size() ? std::stoul(role_.substr(digits)) : 0;
+            spectrum_monitor_ = make_spectrum_monitor_sink(std::move(monitor), conditioner_id,
+                    configuration->property(role_ + ".spectrum_monitor_trigger_recorder", true));
+        }
 }
 
 
@@ -59,15 +106,31 @@ void SignalConditioner::connect(gr::top_block_sptr top_block)
             LOG(WARNING) << "Signal conditioner already connected internally";
             return;
         }
-    data_type_adapt_->connect(top_block);
-    in_filt_->connect(top_block);
-    res_->connect(top_block);
-
-    top_block->connect(data_type_adapt_->get_right_block(), 0, in_filt_->get_left_block(), 0);
-    DLOG(INFO) << "data_type_adapter -> input_filter";
+    for (unsigned int i = 0; i < stages_.size(); i++)
+        {
+            stages_.at(i)->connect(top_block);
+            if (i > 0)
+                {
+                    top_block->connect(stages_.at(i - 1)->get_right_block(), 0, stages_.at(i)->get_left_block(), 0);
+                    DLOG(INFO) << stages_.at(i - 1)->role() << " -> " << stages_.at(i)->role();
+                }
+        }
+    if (stages_.size() < 3)
+        {
+            LOG(INFO) << role_ << ": " << elided_stages() << " Pass_Through stages left out, "
+                      << stages_.front()->role() << " is the first of " << stages_.size();
+        }
 
-    top_block->connect(in_filt_->get_right_block(), 0, res_->get_left_block(), 0);
-    DLOG(INFO) << "input_filter -> resampler";
+    if (flight_recorder_)
+        {
+            top_block->connect(get_right_block(), 0, flight_recorder_, 0);
+            DLOG(INFO) << stages_.back()->role() << " -> flight_recorder";
+        }
+    if (spectrum_monitor_)
+        {
+            top_block->connect(get_right_block(), 0, spectrum_monitor_, 0);
+            DLOG(INFO) << stages_.back()->role() << " -> spectrum_monitor";
+        }
     connected_ = true;
 }
 
@@ -80,14 +143,24 @@ void SignalConditioner::disconnect(gr::top_block_sptr top_block)
             return;
         }
 
-    top_block->disconnect(data_type_adapt_->get_right_block(), 0,
-                          in_filt_->get_left_block(), 0);
-    top_block->disconnect(in_filt_->get_right_block(), 0,
-                          res_->get_left_block(), 0);
+    for (unsigned int i = 1; i < stages_.size(); i++)
+        {
+            top_block->disconnect(stages_.at(i - 1)->get_right_block(), 0,
+                                  stages_.at(i)->get_left_block(), 0);
+        }
+    if (flight_recorder_)
+        {
+            top_block->disconnect(get_right_block(), 0, flight_recorder_, 0);
+        }
+    if (spectrum_monitor_)
+        {
+            top_block->disconnect(get_right_block(), 0, spectrum_monitor_, 0);
+        }
 
-    data_type_adapt_->disconnect(top_block);
-    in_filt_->disconnect(top_block);
-    res_->disconnect(top_block);
+    for (unsigned int i = 0; i < stages_.size(); i++)
+        {
+            stages_.at(i)->disconnect(top_block);
+        }
 
     connected_ = false;
 }
@@ -95,11 +168,11 @@ void SignalConditioner::disconnect(gr::top_block_sptr top_block)
 
 gr::basic_block_sptr SignalConditioner::get_left_block()
 {
-    return data_type_adapt_->get_left_block();
+    return stages_.front()->get_left_block();
 }
 
 gr::basic_block_sptr SignalConditioner::get_right_block()
 {
-    return res_->get_right_block();
+    return stages_.back()->get_right_block();
 }
 
@@ -33,7 +33,10 @@
 #define GNSS_SDR_SIGNAL_CONDITIONER_H_
 
 #include <string>
+#include <vector>
 #include "gnss_block_interface.h"
+#include "flight_recorder.h"
+#include "spectrum_monitor_sink.h"
 
 
 class ConfigurationInterface;
@@ -44,6 +47,15 @@ class TelemetryDecoderInterface;
 /*!
  * \brief This class wraps blocks to change data_type_adapter, input_filter and resampler
  * to be applied to the input flow of sampled signal.
+ *
+ * With role.flight_recorder=true, a flight_recorder also taps the output of
+ * the resampler, and stores the samples around each spoofing alarm. With
+ * role.spectrum_monitor=true, a spectrum_monitor_sink taps it as well, for
+ * the spectrum check of the spoofing detector.
+ *
+ * Unless Receiver.elide_pass_through=false, the Pass_Through stages are left
+ * out of the flowgraph: the other stages are connected to each other, and a
+ * conditioner without any keeps one of them, so that it still has a block.
  */
 class SignalConditioner: public GNSSBlockInterface
 {
@@ -70,10 +82,16 @@ public:
     std::shared_ptr<GNSSBlockInterface> input_filter(){ return in_filt_; }
     std::shared_ptr<GNSSBlockInterface> resampler(){ return res_; }
 
+    //! Number of Pass_Through stages left out of the flowgraph
+    unsigned int elided_stages() const { return 3 - stages_.size(); }
+
 private:
     std::shared_ptr<GNSSBlockInterface> data_type_adapt_;
     std::shared_ptr<GNSSBlockInterface> in_filt_;
     std::shared_ptr<GNSSBlockInterface> res_;
+    std::vector<std::shared_ptr<GNSSBlockInterface>> stages_; // the connected ones, in order
+    flight_recorder_sptr flight_recorder_;
+    spectrum_monitor_sink_sptr spectrum_monitor_;
     std::string role_;
     std::string implementation_;
     bool connected_;
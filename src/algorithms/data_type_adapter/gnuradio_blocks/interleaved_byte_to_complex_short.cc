@@ -32,6 +32,7 @@
 #include "interleaved_byte_to_complex_short.h"
 #include <gnuradio/io_signature.h>
 #include <volk/volk.h>
+#include "volk_gnsssdr/volk_gnsssdr.h"
 
 
 interleaved_byte_to_complex_short_sptr make_interleaved_byte_to_complex_short()
@@ -57,15 +58,6 @@ int interleaved_byte_to_complex_short::work(int noutput_items,
 {
     const int8_t *in = (const int8_t *) input_items[0];
     lv_16sc_t *out = (lv_16sc_t *) output_items[0];
-    // This could be put into a Volk kernel
-    int8_t real_part;
-    int8_t imag_part;
-    for(int number = 0; number < noutput_items; number++)
-        {
-            // lv_cmake(r, i) defined at volk/volk_complex.h
-            real_part = *in++;
-            imag_part = *in++;
-            *out++ = lv_cmake((int16_t)real_part, (int16_t)imag_part);
-        }
+    volk_gnsssdr_8ic_convert_16ic(out, (const lv_8sc_t*) in, noutput_items);
     return noutput_items;
 }
@@ -29,8 +29,14 @@
  */
 
 #include "beamformer_filter.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <boost/lexical_cast.hpp>
 #include <glog/logging.h>
 #include <gnuradio/blocks/file_sink.h>
+#include <gnuradio/filter/pm_remez.h>
+#include <volk/volk.h>
 #include "beamformer.h"
 #include "configuration_interface.h"
 
@@ -48,14 +54,66 @@ BeamformerFilter::BeamformerFilter(
     dump_ = configuration->property(role + ".dump", false);
     DLOG(INFO) << "dump_ is " << dump_;
     dump_filename_ = configuration->property(role + ".dump_filename", default_dump_file);
+    bool adaptive = configuration->property(role + ".adaptive", false);
+    unsigned int reference_channel = configuration->property(role + ".reference_channel", 0);
+    unsigned int update_period_samples = configuration->property(role + ".update_period_samples", 400000);
+    unsigned int snapshot_decimation = configuration->property(role + ".snapshot_decimation", 8);
+    unsigned int snapshots = configuration->property(role + ".snapshots", 2048);
+    float diagonal_loading = configuration->property(role + ".diagonal_loading", 0.001);
+
+    // optional FIR filter of the channels, designed as in Fir_Filter
+    std::vector<float> taps;
+    if (configuration->property(role + ".filter", false))
+        {
+            int number_of_taps = configuration->property(role + ".number_of_taps", 6);
+            unsigned int number_of_bands = configuration->property(role + ".number_of_bands", 2);
+            std::vector<double> default_bands = { 0.0, 0.4, 0.6, 1.0 };
+            std::vector<double> bands;
+            std::vector<double> ampl;
+            std::vector<double> error_w;
+            for (unsigned int i = 0; i < number_of_bands; i++)
+                {
+                    std::string band = ".band" + boost::lexical_cast<std::string>(i + 1);
+                    std::string amplitude = ".ampl" + boost::lexical_cast<std::string>(i + 1);
+                    double default_value = i < default_bands.size() ? default_bands[i] : 0.0;
+                    bands.push_back(configuration->property(role + band + "_begin", default_value));
+                    bands.push_back(configuration->property(role + band + "_end", default_value));
+                    ampl.push_back(configuration->property(role + amplitude + "_begin", default_value));
+                    ampl.push_back(configuration->property(role + amplitude + "_end", default_value));
+                    error_w.push_back(configuration->property(role + band + "_error", default_value));
+                }
+            std::string filter_type = configuration->property(role + ".filter_type", std::string("bandpass"));
+            int grid_density = configuration->property(role + ".grid_density", 16);
+            std::vector<double> taps_d = gr::filter::pm_remez(number_of_taps - 1, bands, ampl, error_w, filter_type, grid_density);
+            taps.assign(taps_d.begin(), taps_d.end());
+        }
+
+    // threads: enough for the channel samples per second of the array, unless set
+    unsigned int threads = configuration->property(role + ".threads", 0);
+    if (threads == 0)
+        {
+            double fs_hz = configuration->property("GNSS-SDR.internal_fs_hz", 2048000.0);
+            double samples_per_thread = configuration->property(role + ".channel_samples_per_thread", 80e6);
+            threads = static_cast<unsigned int>(std::ceil(8.0 * fs_hz / samples_per_thread));
+            threads = std::max(1u, std::min(threads, 8u));
+        }
+    LOG(INFO) << "Beamformer with " << taps.size() << " taps and " << threads << " threads";
 
     if (item_type_.compare("gr_complex") == 0)
         {
             item_size_ = sizeof(gr_complex);
-            beamformer_ = make_beamformer();
+            beamformer_ = make_beamformer(BEAMFORMER_GR_COMPLEX, adaptive, reference_channel,
+                    update_period_samples, snapshot_decimation, snapshots, diagonal_loading, taps, threads);
             DLOG(INFO) << "Item size " << item_size_;
-            DLOG(INFO) << "resampler(" << beamformer_->unique_id() << ")";
-
+            DLOG(INFO) << "beamformer(" << beamformer_->unique_id() << ")";
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            item_size_ = sizeof(lv_16sc_t);
+            beamformer_ = make_beamformer(BEAMFORMER_CSHORT, adaptive, reference_channel,
+                    update_period_samples, snapshot_decimation, snapshots, diagonal_loading, taps, threads);
+            DLOG(INFO) << "Item size " << item_size_;
+            DLOG(INFO) << "beamformer(" << beamformer_->unique_id() << ")";
         }
     else
         {
@@ -49,26 +49,16 @@ FirFilter::FirFilter(ConfigurationInterface* configuration, std::string role,
             && (output_item_type_.compare("gr_complex") == 0))
         {
             item_size = sizeof(gr_complex);
-            fir_filter_ccf_ = gr::filter::fir_filter_ccf::make(1, taps_);
-            DLOG(INFO) << "input_filter(" << fir_filter_ccf_->unique_id() << ")";
-            if (dump_)
+            if (taps_.size() >= fft_min_taps_ && fft_min_taps_ > 0)
                 {
-                    DLOG(INFO) << "Dumping output into file " << dump_filename_;
-                    file_sink_ = gr::blocks::file_sink::make(item_size, dump_filename_.c_str());
+                    complex_fir_filter_ = make_complex_fir_filter(COMPLEX_FIR_GR_COMPLEX, COMPLEX_FIR_GR_COMPLEX, taps_, fft_min_taps_);
+                    DLOG(INFO) << "input_filter(" << complex_fir_filter_->unique_id() << ")";
+                }
+            else
+                {
+                    fir_filter_ccf_ = gr::filter::fir_filter_ccf::make(1, taps_);
+                    DLOG(INFO) << "input_filter(" << fir_filter_ccf_->unique_id() << ")";
                 }
-        }
-    else if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("cshort") == 0)
-            && (output_item_type_.compare("cshort") == 0))
-        {
-            item_size = sizeof(lv_16sc_t);
-            cshort_to_float_x2_ = make_cshort_to_float_x2();
-            fir_filter_fff_1_ = gr::filter::fir_filter_fff::make(1, taps_);
-            fir_filter_fff_2_ = gr::filter::fir_filter_fff::make(1, taps_);
-            DLOG(INFO) << "I input_filter(" << fir_filter_fff_1_->unique_id() << ")";
-            DLOG(INFO) << "Q input_filter(" << fir_filter_fff_2_->unique_id() << ")";
-            float_to_short_1_ = gr::blocks::float_to_short::make();
-            float_to_short_2_ = gr::blocks::float_to_short::make();
-            short_x2_to_cshort_ = make_short_x2_to_cshort();
             if (dump_)
                 {
                     DLOG(INFO) << "Dumping output into file " << dump_filename_;
@@ -76,22 +66,24 @@ FirFilter::FirFilter(ConfigurationInterface* configuration, std::string role,
                 }
         }
     else if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("cshort") == 0)
-            && (output_item_type_.compare("gr_complex") == 0))
+            && ((output_item_type_.compare("cshort") == 0) || (output_item_type_.compare("gr_complex") == 0)))
         {
+            // filtered as complex numbers, directly or by FFT depending on the number of taps
+            Complex_Fir_Item_Type output_type = COMPLEX_FIR_GR_COMPLEX;
             item_size = sizeof(gr_complex);
-            cshort_to_float_x2_ = make_cshort_to_float_x2();
-            fir_filter_fff_1_ = gr::filter::fir_filter_fff::make(1, taps_);
-            fir_filter_fff_2_ = gr::filter::fir_filter_fff::make(1, taps_);
-            DLOG(INFO) << "I input_filter(" << fir_filter_fff_1_->unique_id() << ")";
-            DLOG(INFO) << "Q input_filter(" << fir_filter_fff_2_->unique_id() << ")";
-            float_to_complex_ = gr::blocks::float_to_complex::make();
+            if (output_item_type_.compare("cshort") == 0)
+                {
+                    output_type = COMPLEX_FIR_CSHORT;
+                    item_size = sizeof(lv_16sc_t);
+                }
+            complex_fir_filter_ = make_complex_fir_filter(COMPLEX_FIR_CSHORT, output_type, taps_, fft_min_taps_);
+            DLOG(INFO) << "input_filter(" << complex_fir_filter_->unique_id() << ")";
             if (dump_)
                 {
                     DLOG(INFO) << "Dumping output into file " << dump_filename_;
                     file_sink_ = gr::blocks::file_sink::make(item_size, dump_filename_.c_str());
                 }
         }
-
     else if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("cbyte") == 0)
             && (output_item_type_.compare("gr_complex") == 0))
         {
@@ -148,7 +140,14 @@ FirFilter::~FirFilter()
 
 void FirFilter::connect(gr::top_block_sptr top_block)
 {
-    if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("gr_complex") == 0)
+    if (complex_fir_filter_)
+        {
+            if (dump_)
+                {
+                    top_block->connect(complex_fir_filter_, 0, file_sink_, 0);
+                }
+        }
+    else if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("gr_complex") == 0)
             && (output_item_type_.compare("gr_complex") == 0))
         {
             if (dump_)
@@ -160,20 +159,6 @@ void FirFilter::connect(gr::top_block_sptr top_block)
                     DLOG(INFO) << "Nothing to connect internally";
                 }
         }
-    else if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("cshort") == 0)
-            && (output_item_type_.compare("cshort") == 0))
-        {
-            top_block->connect(cshort_to_float_x2_, 0, fir_filter_fff_1_, 0);
-            top_block->connect(cshort_to_float_x2_, 1, fir_filter_fff_2_, 0);
-            top_block->connect(fir_filter_fff_1_, 0, float_to_short_1_, 0);
-            top_block->connect(fir_filter_fff_2_, 0, float_to_short_2_, 0);
-            top_block->connect(float_to_short_1_, 0, short_x2_to_cshort_, 0);
-            top_block->connect(float_to_short_2_, 0, short_x2_to_cshort_, 1);
-            if (dump_)
-                {
-                    top_block->connect(short_x2_to_cshort_, 0, file_sink_, 0);
-                }
-        }
     else if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("cbyte") == 0)
             && (output_item_type_.compare("gr_complex") == 0))
         {
@@ -200,18 +185,6 @@ void FirFilter::connect(gr::top_block_sptr top_block)
                     top_block->connect(char_x2_cbyte_, 0, file_sink_, 0);
                 }
         }
-    else if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("cshort") == 0)
-            && (output_item_type_.compare("gr_complex") == 0))
-        {
-            top_block->connect(cshort_to_float_x2_, 0, fir_filter_fff_1_, 0);
-            top_block->connect(cshort_to_float_x2_, 1, fir_filter_fff_2_, 0);
-            top_block->connect(fir_filter_fff_1_, 0, float_to_complex_, 0);
-            top_block->connect(fir_filter_fff_2_, 0, float_to_complex_, 1);
-            if (dump_)
-                {
-                    top_block->connect(float_to_complex_, 0, file_sink_, 0);
-                }
-        }
     else
         {
             LOG(ERROR) << " Unknown item type conversion";
@@ -222,7 +195,14 @@ void FirFilter::connect(gr::top_block_sptr top_block)
 
 void FirFilter::disconnect(gr::top_block_sptr top_block)
 {
-    if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("gr_complex") == 0)
+    if (complex_fir_filter_)
+        {
+            if (dump_)
+                {
+                    top_block->disconnect(complex_fir_filter_, 0, file_sink_, 0);
+                }
+        }
+    else if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("gr_complex") == 0)
             && (output_item_type_.compare("gr_complex") == 0))
         {
             if (dump_)
@@ -242,20 +222,6 @@ void FirFilter::disconnect(gr::top_block_sptr top_block)
                     top_block->disconnect(float_to_complex_, 0, file_sink_, 0);
                 }
         }
-    else if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("cshort") == 0)
-            && (output_item_type_.compare("cshort") == 0))
-        {
-            top_block->disconnect(cshort_to_float_x2_, 0, fir_filter_fff_1_, 0);
-            top_block->disconnect(cshort_to_float_x2_, 1, fir_filter_fff_2_, 0);
-            top_block->disconnect(fir_filter_fff_1_, 0, float_to_short_1_, 0);
-            top_block->disconnect(fir_filter_fff_2_, 0, float_to_short_2_, 0);
-            top_block->disconnect(float_to_short_1_, 0, short_x2_to_cshort_, 0);
-            top_block->disconnect(float_to_short_2_, 0, short_x2_to_cshort_, 1);
-            if (dump_)
-                {
-                    top_block->disconnect(short_x2_to_cshort_, 0, file_sink_, 0);
-                }
-        }
     else if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("cbyte") == 0)
             && (output_item_type_.compare("cbyte") == 0))
         {
@@ -270,18 +236,6 @@ void FirFilter::disconnect(gr::top_block_sptr top_block)
                     top_block->disconnect(char_x2_cbyte_, 0, file_sink_, 0);
                 }
         }
-    else if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("cshort") == 0)
-            && (output_item_type_.compare("gr_complex") == 0))
-        {
-            top_block->disconnect(cshort_to_float_x2_, 0, fir_filter_fff_1_, 0);
-            top_block->disconnect(cshort_to_float_x2_, 1, fir_filter_fff_2_, 0);
-            top_block->disconnect(fir_filter_fff_1_, 0, float_to_complex_, 0);
-            top_block->disconnect(fir_filter_fff_2_, 0, float_to_complex_, 1);
-            if (dump_)
-                {
-                    top_block->disconnect(float_to_complex_, 0, file_sink_, 0);
-                }
-        }
     else
         {
             LOG(ERROR) << " Unknown item type conversion";
@@ -292,15 +246,14 @@ void FirFilter::disconnect(gr::top_block_sptr top_block)
 
 gr::basic_block_sptr FirFilter::get_left_block()
 {
-    if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("gr_complex") == 0)
-            && (output_item_type_.compare("gr_complex") == 0))
+    if (complex_fir_filter_)
         {
-            return fir_filter_ccf_;
+            return complex_fir_filter_;
         }
-    else if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("cshort") == 0)
-            && (output_item_type_.compare("cshort") == 0))
+    else if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("gr_complex") == 0)
+            && (output_item_type_.compare("gr_complex") == 0))
         {
-            return cshort_to_float_x2_;
+            return fir_filter_ccf_;
         }
     else if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("cbyte") == 0)
             && (output_item_type_.compare("gr_complex") == 0))
@@ -312,11 +265,6 @@ gr::basic_block_sptr FirFilter::get_left_block()
         {
             return cbyte_to_float_x2_;
         }
-    else if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("cshort") == 0)
-            && (output_item_type_.compare("gr_complex") == 0))
-        {
-            return cshort_to_float_x2_;
-        }
     else
         {
             return nullptr;
@@ -328,15 +276,14 @@ gr::basic_block_sptr FirFilter::get_left_block()
 
 gr::basic_block_sptr FirFilter::get_right_block()
 {
-    if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("gr_complex") == 0)
-            && (output_item_type_.compare("gr_complex") == 0))
+    if (complex_fir_filter_)
         {
-            return fir_filter_ccf_;
+            return complex_fir_filter_;
         }
-    else if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("cshort") == 0)
-            && (output_item_type_.compare("cshort") == 0))
+    else if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("gr_complex") == 0)
+            && (output_item_type_.compare("gr_complex") == 0))
         {
-            return short_x2_to_cshort_;
+            return fir_filter_ccf_;
         }
     else if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("cbyte") == 0)
             && (output_item_type_.compare("gr_complex") == 0))
@@ -348,11 +295,6 @@ gr::basic_block_sptr FirFilter::get_right_block()
         {
             return char_x2_cbyte_;
         }
-    else if ((taps_item_type_.compare("float") == 0) && (input_item_type_.compare("cshort") == 0)
-              && (output_item_type_.compare("gr_complex") == 0))
-        {
-            return float_to_complex_;
-        }
     else
         {
             return nullptr;
@@ -369,6 +311,7 @@ void FirFilter::init()
     std::string default_taps_item_type = "float";
     std::string default_dump_filename = "../data/input_filter.dat";
     int default_number_of_taps = 6;
+    unsigned int default_fft_min_taps = 48;
     unsigned int default_number_of_bands = 2;
     std::vector<double> default_bands = { 0.0, 0.4, 0.6, 1.0 };
     std::vector<double> default_ampl = { 1.0, 1.0, 0.0, 0.0 };
@@ -384,6 +327,7 @@ void FirFilter::init()
     dump_ = config_->property(role_ + ".dump", false);
     dump_filename_ = config_->property(role_ + ".dump_filename", default_dump_filename);
     int number_of_taps = config_->property(role_ + ".number_of_taps", default_number_of_taps);
+    fft_min_taps_ = config_->property(role_ + ".fft_min_taps", default_fft_min_taps);
     unsigned int number_of_bands = config_->property(role_ + ".number_of_bands", default_number_of_bands);
 
     std::vector<double> bands;
@@ -0,0 +1,199 @@
+/*!
+ * \file fused_xlating_fir_filter.cc
+ * \brief Adapts the xlating_fir_decimator block, which converts, translates
+ * and decimates the raw samples in one pass
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "fused_xlating_fir_filter.h"
+#include <iostream>
+#include <boost/lexical_cast.hpp>
+#include <gnuradio/filter/pm_remez.h>
+#include <glog/logging.h>
+#include "configuration_interface.h"
+
+using google::LogMessage;
+
+FusedXlatingFirFilter::FusedXlatingFirFilter(ConfigurationInterface* configuration, std::string role,
+        unsigned int in_streams, unsigned int out_streams) :
+                        config_(configuration), role_(role), in_streams_(in_streams),
+                        out_streams_(out_streams)
+{
+    (*this).init();
+    int default_decimation_factor = 1;
+    int decimation_factor = config_->property(role_ + ".decimation_factor", default_decimation_factor);
+
+    Xlating_Fir_Sample_Format sample_format = XLATING_FIR_FLOAT32;
+    unsigned int scalars_per_item = 1;
+    if (input_item_type_.compare("ibyte") == 0)
+        {
+            sample_format = XLATING_FIR_INT8;
+            scalars_per_item = 2;
+        }
+    else if (input_item_type_.compare("cbyte") == 0)
+        {
+            sample_format = XLATING_FIR_INT8;
+        }
+    else if (input_item_type_.compare("ishort") == 0)
+        {
+            sample_format = XLATING_FIR_INT16;
+            scalars_per_item = 2;
+        }
+    else if (input_item_type_.compare("cshort") == 0)
+        {
+            sample_format = XLATING_FIR_INT16;
+        }
+    else if (input_item_type_.compare("gr_complex") != 0)
+        {
+            LOG(ERROR) << input_item_type_ << " unrecognized input item type for " << role_
+                       << ". Using gr_complex.";
+        }
+    if (output_item_type_.compare("gr_complex") != 0)
+        {
+            LOG(ERROR) << role_ << ".output_item_type=" << output_item_type_
+                       << " is not supported by Fused_Xlating_Fir_Filter, the output is gr_complex";
+        }
+
+    xlating_fir_decimator_ = make_xlating_fir_decimator(sample_format, scalars_per_item,
+            decimation_factor, taps_, intermediate_freq_, sampling_freq_);
+    DLOG(INFO) << "input_filter(" << xlating_fir_decimator_->unique_id() << ")";
+
+    if (dump_)
+        {
+            DLOG(INFO) << "Dumping output into file " << dump_filename_;
+            std::cout << "Dumping output into file " << dump_filename_ << std::endl;
+            file_sink_ = gr::blocks::file_sink::make(sizeof(gr_complex), dump_filename_.c_str());
+        }
+}
+
+
+
+FusedXlatingFirFilter::~FusedXlatingFirFilter()
+{}
+
+
+
+void FusedXlatingFirFilter::connect(gr::top_block_sptr top_block)
+{
+    if (dump_)
+        {
+            top_block->connect(xlating_fir_decimator_, 0, file_sink_, 0);
+        }
+}
+
+
+
+void FusedXlatingFirFilter::disconnect(gr::top_block_sptr top_block)
+{
+    if (dump_)
+        {
+            top_block->disconnect(xlating_fir_decimator_, 0, file_sink_, 0);
+        }
+}
+
+
+gr::basic_block_sptr FusedXlatingFirFilter::get_left_block()
+{
+    return xlating_fir_decimator_;
+}
+
+
+gr::basic_block_sptr FusedXlatingFirFilter::get_right_block()
+{
+    return xlating_fir_decimator_;
+}
+
+
+void FusedXlatingFirFilter::init()
+{
+    std::string default_input_item_type = "ibyte";
+    std::string default_output_item_type = "gr_complex";
+    std::string default_dump_filename = "../data/input_filter.dat";
+    double default_intermediate_freq = 0;
+    double default_sampling_freq = 4000000;
+    int default_number_of_taps = 6;
+    unsigned int default_number_of_bands = 2;
+    std::vector<double> default_bands = { 0.0, 0.4, 0.6, 1.0 };
+    std::vector<double> default_ampl = { 1.0, 1.0, 0.0, 0.0 };
+    std::vector<double> default_error_w = { 1.0, 1.0 };
+    std::string default_filter_type = "bandpass";
+    int default_grid_density = 16;
+
+    DLOG(INFO) << "role " << role_;
+
+    input_item_type_ = config_->property(role_ + ".input_item_type", default_input_item_type);
+    output_item_type_ = config_->property(role_ + ".output_item_type", default_output_item_type);
+    dump_ = config_->property(role_ + ".dump", false);
+    dump_filename_ = config_->property(role_ + ".dump_filename", default_dump_filename);
+    intermediate_freq_ = config_->property(role_ + ".IF", default_intermediate_freq);
+    sampling_freq_ = config_->property(role_ + ".sampling_frequency", default_sampling_freq);
+    int number_of_taps = config_->property(role_ + ".number_of_taps", default_number_of_taps);
+    unsigned int number_of_bands = config_->property(role_ + ".number_of_bands", default_number_of_bands);
+
+    std::vector<double> bands;
+    std::vector<double> ampl;
+    std::vector<double> error_w;
+    std::string option;
+    double option_value;
+
+    for (unsigned int i = 0; i < number_of_bands; i++)
+        {
+            option = ".band" + boost::lexical_cast<std::string>(i + 1) + "_begin";
+            option_value = config_->property(role_ + option, default_bands[i]);
+            bands.push_back(option_value);
+
+            option = ".band" + boost::lexical_cast<std::string>(i + 1) + "_end";
+            option_value = config_->property(role_ + option, default_bands[i]);
+            bands.push_back(option_value);
+
+            option = ".ampl" + boost::lexical_cast<std::string>(i + 1) + "_begin";
+            option_value = config_->property(role_ + option, default_bands[i]);
+            ampl.push_back(option_value);
+
+            option = ".ampl" + boost::lexical_cast<std::string>(i + 1) + "_end";
+            option_value = config_->property(role_ + option, default_bands[i]);
+            ampl.push_back(option_value);
+
+            option = ".band" + boost::lexical_cast<std::string>(i + 1) + "_error";
+            option_value = config_->property(role_ + option, default_bands[i]);
+            error_w.push_back(option_value);
+        }
+
+    std::string filter_type = config_->property(role_ + ".filter_type", default_filter_type);
+    int grid_density = config_->property(role_ + ".grid_density", default_grid_density);
+
+    std::vector<double> taps_d = gr::filter::pm_remez(number_of_taps - 1, bands, ampl,
+            error_w, filter_type, grid_density);
+
+    taps_.reserve(taps_d.size());
+    for (std::vector<double>::iterator it = taps_d.begin(); it != taps_d.end(); it++)
+        {
+            taps_.push_back(float(*it));
+        }
+}
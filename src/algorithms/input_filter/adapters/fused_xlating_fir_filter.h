@@ -0,0 +1,100 @@
+/*!
+ * \file fused_xlating_fir_filter.h
+ * \brief Adapts the xlating_fir_decimator block, which converts, translates
+ * and decimates the raw samples in one pass
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_FUSED_XLATING_FIR_FILTER_H_
+#define GNSS_SDR_FUSED_XLATING_FIR_FILTER_H_
+
+#include <string>
+#include <vector>
+#include <gnuradio/blocks/file_sink.h>
+#include "gnss_block_interface.h"
+#include "xlating_fir_decimator.h"
+
+class ConfigurationInterface;
+
+/*!
+ * \brief Input filter that reads the raw samples of the signal source
+ * directly and outputs gr_complex.
+ *
+ * It does the job of a DataTypeAdapter (Ibyte_To_Complex, Ishort_To_Complex...)
+ * followed by Freq_Xlating_Fir_Filter, in a single block, so the
+ * DataTypeAdapter and the Resampler can be set to Pass_Through. The filter
+ * is designed with pm_remez from the same InputFilter keys as
+ * Freq_Xlating_Fir_Filter, and input_item_type can be ibyte, cbyte, ishort,
+ * cshort or gr_complex.
+ */
+class FusedXlatingFirFilter: public GNSSBlockInterface
+{
+public:
+    FusedXlatingFirFilter(ConfigurationInterface* configuration,
+            std::string role, unsigned int in_streams,
+            unsigned int out_streams);
+
+    virtual ~FusedXlatingFirFilter();
+    std::string role()
+    {
+        return role_;
+    }
+
+    //! Returns "Fused_Xlating_Fir_Filter"
+    std::string implementation()
+    {
+        return "Fused_Xlating_Fir_Filter";
+    }
+    size_t item_size()
+    {
+        return sizeof(gr_complex);
+    }
+    void connect(gr::top_block_sptr top_block);
+    void disconnect(gr::top_block_sptr top_block);
+    gr::basic_block_sptr get_left_block();
+    gr::basic_block_sptr get_right_block();
+
+private:
+    xlating_fir_decimator_sptr xlating_fir_decimator_;
+    ConfigurationInterface* config_;
+    bool dump_;
+    std::string dump_filename_;
+    std::string input_item_type_;
+    std::string output_item_type_;
+    std::vector <float> taps_;
+    double intermediate_freq_;
+    double sampling_freq_;
+    std::string role_;
+    unsigned int in_streams_;
+    unsigned int out_streams_;
+    gr::blocks::file_sink::sptr file_sink_;
+    void init();
+};
+
+#endif // GNSS_SDR_FUSED_XLATING_FIR_FILTER_H_
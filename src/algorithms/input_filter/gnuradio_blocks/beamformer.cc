@@ -1,7 +1,7 @@
 /*!
  * \file beamformer.cc
  *
- * \brief Unpacks byte samples to NSR 2 bits samples
+ * \brief Simple spatial filter using RAW array input and beamforming coefficients
  * \author Javier Arribas jarribas (at) cttc.es
  * -------------------------------------------------------------------------
  *
@@ -30,30 +30,206 @@
 
 
 #include "beamformer.h"
-#include <iostream>
-#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <glog/logging.h>
 #include <gnuradio/io_signature.h>
+#include <volk/volk.h>
+#include <volk_gnsssdr/volk_gnsssdr.h>
 
 #define GNSS_SDR_BEAMFORMER_CHANNELS 8
 
+using google::LogMessage;
+
+
+/*
+ * Threads of one beamformer. run_all() runs task(0) in the calling thread
+ * and task(1) ... task(num_threads - 1) in the others, and returns when
+ * all of them are done.
+ */
+class Beamformer_Workers
+{
+public:
+    explicit Beamformer_Workers(unsigned int num_threads) : d_generation(0), d_pending(0), d_stop(false)
+    {
+        for (unsigned int t = 1; t < num_threads; t++)
+            {
+                d_threads.create_thread(boost::bind(&Beamformer_Workers::run, this, t));
+            }
+    }
+
+    ~Beamformer_Workers()
+    {
+        {
+            boost::mutex::scoped_lock lock(d_mutex);
+            d_stop = true;
+        }
+        d_start.notify_all();
+        d_threads.join_all();
+    }
+
+    void run_all(const boost::function<void(unsigned int)>& task)
+    {
+        {
+            boost::mutex::scoped_lock lock(d_mutex);
+            d_task = &task;
+            d_pending = d_threads.size();
+            d_generation++;
+        }
+        d_start.notify_all();
+        task(0);
+        boost::mutex::scoped_lock lock(d_mutex);
+        while (d_pending > 0)
+            {
+                d_done.wait(lock);
+            }
+    }
+
+private:
+    void run(unsigned int thread)
+    {
+        unsigned long long generation = 0;
+        while (true)
+            {
+                const boost::function<void(unsigned int)>* task;
+                {
+                    boost::mutex::scoped_lock lock(d_mutex);
+                    while (!d_stop && d_generation == generation)
+                        {
+                            d_start.wait(lock);
+                        }
+                    if (d_stop)
+                        {
+                            return;
+                        }
+                    generation = d_generation;
+                    task = d_task;
+                }
+                (*task)(thread);
+                boost::mutex::scoped_lock lock(d_mutex);
+                if (--d_pending == 0)
+                    {
+                        d_done.notify_one();
+                    }
+            }
+    }
+
+    const boost::function<void(unsigned int)>* d_task;
+    unsigned long long d_generation;
+    unsigned int d_pending;
+    bool d_stop;
+    boost::mutex d_mutex;
+    boost::condition_variable d_start;
+    boost::condition_variable d_done;
+    boost::thread_group d_threads;
+};
+
+
 beamformer_sptr make_beamformer()
 {
-    return beamformer_sptr(new beamformer());
+    return make_beamformer(BEAMFORMER_GR_COMPLEX, false, 0, 0, 1, 1, 0.0);
+}
+
+
+beamformer_sptr make_beamformer(Beamformer_Item_Type item_type, bool adaptive,
+        unsigned int reference_channel, unsigned int update_period_samples,
+        unsigned int snapshot_decimation, unsigned int snapshots,
+        float diagonal_loading)
+{
+    return make_beamformer(item_type, adaptive, reference_channel, update_period_samples,
+            snapshot_decimation, snapshots, diagonal_loading, std::vector<float>(), 1);
 }
 
 
-beamformer::beamformer()
+beamformer_sptr make_beamformer(Beamformer_Item_Type item_type, bool adaptive,
+        unsigned int reference_channel, unsigned int update_period_samples,
+        unsigned int snapshot_decimation, unsigned int snapshots,
+        float diagonal_loading, const std::vector<float>& taps,
+        unsigned int num_threads)
+{
+    return beamformer_sptr(new beamformer(item_type, adaptive, reference_channel,
+            update_period_samples, snapshot_decimation, snapshots, diagonal_loading,
+            taps, num_threads));
+}
+
+
+beamformer::beamformer(Beamformer_Item_Type item_type, bool adaptive,
+        unsigned int reference_channel, unsigned int update_period_samples,
+        unsigned int snapshot_decimation, unsigned int snapshots,
+        float diagonal_loading, const std::vector<float>& taps,
+        unsigned int num_threads)
 : gr::sync_block("beamformer",
-        gr::io_signature::make(GNSS_SDR_BEAMFORMER_CHANNELS, GNSS_SDR_BEAMFORMER_CHANNELS,sizeof(gr_complex)),
-        gr::io_signature::make(1, 1,sizeof(gr_complex)))
+        gr::io_signature::make(GNSS_SDR_BEAMFORMER_CHANNELS, GNSS_SDR_BEAMFORMER_CHANNELS,
+                item_type == BEAMFORMER_CSHORT ? sizeof(lv_16sc_t) : sizeof(gr_complex)),
+        gr::io_signature::make(1, 1, item_type == BEAMFORMER_CSHORT ? sizeof(lv_16sc_t) : sizeof(gr_complex))),
+        d_item_type(item_type),
+        d_adaptive(adaptive),
+        d_reference_channel(reference_channel),
+        d_update_period_samples(update_period_samples),
+        d_snapshot_decimation(snapshot_decimation),
+        d_snapshots(snapshots),
+        d_diagonal_loading(diagonal_loading),
+        d_reversed_taps(taps.rbegin(), taps.rend()),
+        d_ntaps(taps.size()),
+        d_num_threads(std::max(num_threads, 1u))
 {
+    if (d_reference_channel >= GNSS_SDR_BEAMFORMER_CHANNELS)
+        {
+            LOG(WARNING) << "Beamformer reference channel " << d_reference_channel << " out of range, using channel 0";
+            d_reference_channel = 0;
+        }
+    if (d_snapshot_decimation == 0)
+        {
+            d_snapshot_decimation = 1;
+        }
+    if (d_snapshots == 0)
+        {
+            d_snapshots = 1;
+        }
+    if (d_adaptive && (d_update_period_samples < d_snapshots * d_snapshot_decimation))
+        {
+            // the estimation of the covariance spans snapshots * snapshot_decimation samples
+            LOG(WARNING) << "Beamformer update period shorter than the snapshots, using " << d_snapshots * d_snapshot_decimation << " samples";
+            d_update_period_samples = d_snapshots * d_snapshot_decimation;
+        }
+
     //initialize weight vector
 
     if (posix_memalign((void**)&weight_vector, 16, GNSS_SDR_BEAMFORMER_CHANNELS * sizeof(gr_complex)) == 0){};
 
     for (int i = 0; i< GNSS_SDR_BEAMFORMER_CHANNELS; i++)
         {
-            weight_vector[i]=gr_complex(1,0);
+            if (d_adaptive)
+                {
+                    // the reference channel alone, until the first estimation
+                    weight_vector[i] = gr_complex(i == static_cast<int>(d_reference_channel) ? 1 : 0, 0);
+                }
+            else
+                {
+                    weight_vector[i] = gr_complex(1, 0);
+                }
+        }
+
+    d_covariance.assign(GNSS_SDR_BEAMFORMER_CHANNELS * GNSS_SDR_BEAMFORMER_CHANNELS, std::complex<double>(0, 0));
+    d_collected_snapshots = 0;
+    d_next_snapshot = 0;
+    d_samples_since_estimation = d_update_period_samples; // the first estimation starts right away
+    d_collecting = false;
+
+    if (d_ntaps > 0)
+        {
+            set_history(d_ntaps);
+        }
+    d_scratch.resize(d_num_threads);
+    if (d_num_threads > 1)
+        {
+            d_workers.reset(new Beamformer_Workers(d_num_threads));
         }
 }
 
@@ -64,31 +240,258 @@ beamformer::~beamformer()
 }
 
 
+std::vector<gr_complex> beamformer::weights() const
+{
+    return std::vector<gr_complex>(weight_vector, weight_vector + GNSS_SDR_BEAMFORMER_CHANNELS);
+}
+
+
+void beamformer::accumulate_snapshots(const std::vector<const void*>& inputs, int noutput_items)
+{
+    const unsigned int n_channels = GNSS_SDR_BEAMFORMER_CHANNELS;
+    if (!d_collecting && (d_samples_since_estimation >= d_update_period_samples))
+        {
+            d_collecting = true;
+            d_samples_since_estimation = 0;
+            d_collected_snapshots = 0;
+            d_next_snapshot = 0;
+            std::fill(d_covariance.begin(), d_covariance.end(), std::complex<double>(0, 0));
+        }
+    d_samples_since_estimation += noutput_items;
+    if (!d_collecting)
+        {
+            return;
+        }
+
+    std::complex<double> x[GNSS_SDR_BEAMFORMER_CHANNELS];
+    unsigned int n = d_next_snapshot;
+    for (; (n < static_cast<unsigned int>(noutput_items)) && (d_collected_snapshots < d_snapshots); n += d_snapshot_decimation)
+        {
+            for (unsigned int i = 0; i < n_channels; i++)
+                {
+                    if (d_item_type == BEAMFORMER_CSHORT)
+                        {
+                            const lv_16sc_t sample = static_cast<const lv_16sc_t*>(inputs[i])[n];
+                            x[i] = std::complex<double>(sample.real(), sample.imag());
+                        }
+                    else
+                        {
+                            const gr_complex sample = static_cast<const gr_complex*>(inputs[i])[n];
+                            x[i] = std::complex<double>(sample.real(), sample.imag());
+                        }
+                }
+            for (unsigned int i = 0; i < n_channels; i++)
+                {
+                    for (unsigned int j = i; j < n_channels; j++)
+                        {
+                            d_covariance[i * n_channels + j] += x[i] * std::conj(x[j]);
+                        }
+                }
+            d_collected_snapshots++;
+        }
+
+    if (d_collected_snapshots == d_snapshots)
+        {
+            update_weights();
+            d_collecting = false;
+        }
+    else
+        {
+            d_next_snapshot = n - noutput_items;
+        }
+}
+
+
+void beamformer::update_weights()
+{
+    const unsigned int n_channels = GNSS_SDR_BEAMFORMER_CHANNELS;
+    std::vector<std::complex<double> > r(n_channels * n_channels);
+    double trace = 0.0;
+    for (unsigned int i = 0; i < n_channels; i++)
+        {
+            for (unsigned int j = i; j < n_channels; j++)
+                {
+                    r[i * n_channels + j] = d_covariance[i * n_channels + j] / static_cast<double>(d_collected_snapshots);
+                    r[j * n_channels + i] = std::conj(r[i * n_channels + j]);
+                }
+            trace += r[i * n_channels + i].real();
+        }
+    if (!(trace > 0.0))
+        {
+            // no signal, keep the current weights
+            return;
+        }
+    const double loading = std::max(static_cast<double>(d_diagonal_loading), 1e-9) * trace / n_channels;
+    for (unsigned int i = 0; i < n_channels; i++)
+        {
+            r[i * n_channels + i] += loading;
+        }
+
+    // Cholesky factorization R = L L^H, L overwrites the lower triangle of r
+    for (unsigned int j = 0; j < n_channels; j++)
+        {
+            double d = r[j * n_channels + j].real();
+            for (unsigned int k = 0; k < j; k++)
+                {
+                    d -= std::norm(r[j * n_channels + k]);
+                }
+            if (!(d > 0.0))
+                {
+                    LOG(WARNING) << "Beamformer covariance is not positive definite, keeping the weights";
+                    return;
+                }
+            d = std::sqrt(d);
+            r[j * n_channels + j] = d;
+            for (unsigned int i = j + 1; i < n_channels; i++)
+                {
+                    std::complex<double> s = r[i * n_channels + j];
+                    for (unsigned int k = 0; k < j; k++)
+                        {
+                            s -= r[i * n_channels + k] * std::conj(r[j * n_channels + k]);
+                        }
+                    r[i * n_channels + j] = s / d;
+                }
+        }
+
+    // z = R^-1 e: L y = e, then L^H z = y
+    std::complex<double> z[GNSS_SDR_BEAMFORMER_CHANNELS];
+    for (unsigned int i = 0; i < n_channels; i++)
+        {
+            std::complex<double> s = (i == d_reference_channel) ? 1.0 : 0.0;
+            for (unsigned int k = 0; k < i; k++)
+                {
+                    s -= r[i * n_channels + k] * z[k];
+                }
+            z[i] = s / r[i * n_channels + i].real();
+        }
+    for (int i = n_channels - 1; i >= 0; i--)
+        {
+            std::complex<double> s = z[i];
+            for (unsigned int k = i + 1; k < n_channels; k++)
+                {
+                    s -= std::conj(r[k * n_channels + i]) * z[k];
+                }
+            z[i] = s / r[i * n_channels + i].real();
+        }
+
+    // w = z / (e^H z), and the output is w^H x
+    const double gain = z[d_reference_channel].real();
+    for (unsigned int i = 0; i < n_channels; i++)
+        {
+            const std::complex<double> w = z[i] / gain;
+            weight_vector[i] = gr_complex(static_cast<float>(w.real()), static_cast<float>(-w.imag()));
+        }
+}
+
+
+void beamformer::condition(const std::vector<const void*>& inputs, void* output, unsigned int start, unsigned int count, unsigned int thread)
+{
+    const unsigned int n_channels = GNSS_SDR_BEAMFORMER_CHANNELS;
+    if (d_ntaps == 0)
+        {
+            if (d_item_type == BEAMFORMER_CSHORT)
+                {
+                    const lv_16sc_t* in[GNSS_SDR_BEAMFORMER_CHANNELS];
+                    for (unsigned int i = 0; i < n_channels; i++)
+                        {
+                            in[i] = static_cast<const lv_16sc_t*>(inputs[i]) + start;
+                        }
+                    volk_gnsssdr_16ic_xn_weighted_sum_16ic(static_cast<lv_16sc_t*>(output) + start, in, weight_vector, n_channels, count);
+                }
+            else
+                {
+                    const lv_32fc_t* in[GNSS_SDR_BEAMFORMER_CHANNELS];
+                    for (unsigned int i = 0; i < n_channels; i++)
+                        {
+                            in[i] = static_cast<const lv_32fc_t*>(inputs[i]) + start;
+                        }
+                    volk_gnsssdr_32fc_xn_weighted_sum_32fc(static_cast<lv_32fc_t*>(output) + start, in, weight_vector, n_channels, count);
+                }
+            return;
+        }
+
+    // the sum starts ntaps - 1 samples before the first output, in the history of the block
+    Scratch& scratch = d_scratch[thread];
+    const unsigned int span = count + d_ntaps - 1;
+    if (scratch.sum.size() < span)
+        {
+            scratch.sum.resize(span);
+        }
+    const lv_32fc_t* in[GNSS_SDR_BEAMFORMER_CHANNELS];
+    if (d_item_type == BEAMFORMER_CSHORT)
+        {
+            if (scratch.channels.size() < n_channels * span)
+                {
+                    scratch.channels.resize(n_channels * span);
+                }
+            for (unsigned int i = 0; i < n_channels; i++)
+                {
+                    volk_gnsssdr_16ic_convert_32fc(&scratch.channels[i * span],
+                            static_cast<const lv_16sc_t*>(inputs[i]) + start - (d_ntaps - 1), span);
+                    in[i] = &scratch.channels[i * span];
+                }
+        }
+    else
+        {
+            for (unsigned int i = 0; i < n_channels; i++)
+                {
+                    in[i] = static_cast<const lv_32fc_t*>(inputs[i]) + start - (d_ntaps - 1);
+                }
+        }
+    volk_gnsssdr_32fc_xn_weighted_sum_32fc(&scratch.sum[0], in, weight_vector, n_channels, span);
+
+    gr_complex* filtered = static_cast<gr_complex*>(output) + start;
+    if (d_item_type == BEAMFORMER_CSHORT)
+        {
+            if (scratch.filtered.size() < count)
+                {
+                    scratch.filtered.resize(count);
+                }
+            filtered = &scratch.filtered[0];
+        }
+    for (unsigned int n = 0; n < count; n++)
+        {
+            volk_32fc_32f_dot_prod_32fc(&filtered[n], &scratch.sum[n], &d_reversed_taps[0], d_ntaps);
+        }
+    if (d_item_type == BEAMFORMER_CSHORT)
+        {
+            volk_gnsssdr_32fc_convert_16ic(static_cast<lv_16sc_t*>(output) + start, filtered, count);
+        }
+}
+
+
 int beamformer::work(int noutput_items,gr_vector_const_void_star &input_items,
         gr_vector_void_star &output_items)
 {
-    gr_complex *out = (gr_complex *) output_items[0];
-    // channel output buffers
-    //  gr_complex *ch1 = (gr_complex *) input_items[0];
-    //  gr_complex *ch2 = (gr_complex *) input_items[1];
-    //  gr_complex *ch3 = (gr_complex *) input_items[2];
-    //  gr_complex *ch4 = (gr_complex *) input_items[3];
-    //  gr_complex *ch5 = (gr_complex *) input_items[4];
-    //  gr_complex *ch6 = (gr_complex *) input_items[5];
-    //  gr_complex *ch7 = (gr_complex *) input_items[6];
-    //  gr_complex *ch8 = (gr_complex *) input_items[7];
-
-    // NON-VOLK beamforming operation
-    //TODO: Implement VOLK SIMD-accelerated beamformer!
-    gr_complex sum;
-    for(int n = 0; n < noutput_items; n++)
-        {
-            sum = gr_complex(0,0);
-            for (int i = 0; i < GNSS_SDR_BEAMFORMER_CHANNELS; i++)
-                {
-                    sum = sum + ((gr_complex*)input_items[i])[n] * weight_vector[i];
-                }
-            out[n] = sum;
+    // the current samples of each channel, after the history of the filter
+    const size_t item_size = d_item_type == BEAMFORMER_CSHORT ? sizeof(lv_16sc_t) : sizeof(gr_complex);
+    std::vector<const void*> inputs(GNSS_SDR_BEAMFORMER_CHANNELS);
+    for (unsigned int i = 0; i < GNSS_SDR_BEAMFORMER_CHANNELS; i++)
+        {
+            inputs[i] = static_cast<const char*>(input_items[i]) + (history() - 1) * item_size;
+        }
+
+    const unsigned int chunks = std::min(d_num_threads, std::max(1u, static_cast<unsigned int>(noutput_items) / min_chunk));
+    if (chunks == 1)
+        {
+            condition(inputs, output_items[0], 0, noutput_items, 0);
+        }
+    else
+        {
+            const unsigned int chunk = (noutput_items + chunks - 1) / chunks;
+            void* output = output_items[0];
+            d_workers->run_all([&](unsigned int thread) {
+                const unsigned int start = thread * chunk;
+                if (thread < chunks && start < static_cast<unsigned int>(noutput_items))
+                    {
+                        condition(inputs, output, start, std::min(chunk, noutput_items - start), thread);
+                    }
+            });
+        }
+
+    if (d_adaptive)
+        {
+            accumulate_snapshots(inputs, noutput_items);
         }
 
     return noutput_items;
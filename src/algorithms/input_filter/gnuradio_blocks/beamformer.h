@@ -31,27 +31,145 @@
 #ifndef GNSS_SDR_BEAMFORMER_H
 #define GNSS_SDR_BEAMFORMER_H
 
+#include <complex>
+#include <memory>
+#include <vector>
+#include <boost/shared_ptr.hpp>
 #include <gnuradio/sync_block.h>
 
+/*!
+ * \brief Sample type of the channels and of the output
+ */
+enum Beamformer_Item_Type
+{
+    BEAMFORMER_GR_COMPLEX = 0,
+    BEAMFORMER_CSHORT = 1
+};
+
 class beamformer;
+class Beamformer_Workers;
 typedef boost::shared_ptr<beamformer> beamformer_sptr;
 
+/*!
+ * \brief Makes a beamformer with fixed unit weights
+ */
 beamformer_sptr make_beamformer();
 
+/*!
+ * \brief Makes a beamformer. If adaptive, the weights are estimated every
+ * update_period_samples samples from snapshots taken one every
+ * snapshot_decimation samples, see beamformer.
+ */
+beamformer_sptr make_beamformer(Beamformer_Item_Type item_type, bool adaptive,
+        unsigned int reference_channel, unsigned int update_period_samples,
+        unsigned int snapshot_decimation, unsigned int snapshots,
+        float diagonal_loading);
+
+/*!
+ * \brief Makes a beamformer that also filters the channels with taps (none
+ * if empty), splitting every call to work among num_threads threads
+ */
+beamformer_sptr make_beamformer(Beamformer_Item_Type item_type, bool adaptive,
+        unsigned int reference_channel, unsigned int update_period_samples,
+        unsigned int snapshot_decimation, unsigned int snapshots,
+        float diagonal_loading, const std::vector<float>& taps,
+        unsigned int num_threads);
+
 /*!
  * \brief This class implements a real-time software-defined spatial filter using the CTTC GNSS experimental antenna array input and a set of dynamically reloadable weights
+ *
+ * Each output is the weighted sum of the eight channels, computed with
+ * the VOLK_GNSSSDR weighted sum kernels. In adaptive mode the weights
+ * minimize the output power with the weight of the reference channel held
+ * at one (power inversion, the MVDR beamformer whose steering vector is
+ * the reference channel): w = R^-1 e / (e^H R^-1 e). The GNSS signals are
+ * below the noise floor, so this places nulls on the strong interferers
+ * while the noise of the reference channel goes through. The covariance
+ * R is estimated from the snapshots of one period, with a diagonal
+ * loading of diagonal_loading times its mean eigenvalue to keep the
+ * nulls from eating the noise floor. The new weights apply from the next
+ * call to work.
+ *
+ * The block can also condition the channels with a FIR filter of real
+ * taps, the same for all of them. Since the weighted sum and the filter
+ * are both linear and the weights do not change within a call, the
+ * channels are summed first and the filter runs once on the sum,
+ * instead of once per channel: sum_k w_k (h * x_k) = h * (sum_k w_k x_k).
+ * The samples of the history of the filter are summed again with the
+ * current weights, so the output never mixes two sets of weights. The
+ * cshort channels are converted to gr_complex before the sum, and the
+ * output back to cshort after the filter. The adaptive weights are
+ * estimated from the unfiltered channels.
+ *
+ * With num_threads > 1, every call to work is split into that many
+ * chunks of consecutive outputs, computed in parallel by a set of threads
+ * of the block and the calling one, so that an array whose channels times
+ * sampling rate is more than one core can handle keeps up in real time.
+ * Calls of fewer than min_chunk outputs per thread are not split.
  */
 class beamformer: public gr::sync_block
 {
 private:
-    friend beamformer_sptr
-    make_beamformer_sptr();
+    friend beamformer_sptr make_beamformer(Beamformer_Item_Type item_type, bool adaptive,
+            unsigned int reference_channel, unsigned int update_period_samples,
+            unsigned int snapshot_decimation, unsigned int snapshots,
+            float diagonal_loading, const std::vector<float>& taps,
+            unsigned int num_threads);
+
+    beamformer(Beamformer_Item_Type item_type, bool adaptive,
+            unsigned int reference_channel, unsigned int update_period_samples,
+            unsigned int snapshot_decimation, unsigned int snapshots,
+            float diagonal_loading, const std::vector<float>& taps,
+            unsigned int num_threads);
+
+    void accumulate_snapshots(const std::vector<const void*>& inputs, int noutput_items);
+    void update_weights();
+
+    // computes the outputs [start, start + count) of inputs into output, with the scratch of one thread
+    void condition(const std::vector<const void*>& inputs, void* output, unsigned int start, unsigned int count, unsigned int thread);
+
+    Beamformer_Item_Type d_item_type;
+    bool d_adaptive;
+    unsigned int d_reference_channel;
+    unsigned int d_update_period_samples;
+    unsigned int d_snapshot_decimation;
+    unsigned int d_snapshots;
+    float d_diagonal_loading;
 
     gr_complex* weight_vector;
 
+    // conditioning
+    std::vector<float> d_reversed_taps; // empty if the channels are not filtered
+    unsigned int d_ntaps;
+    unsigned int d_num_threads;
+    std::unique_ptr<Beamformer_Workers> d_workers;
+    struct Scratch
+    {
+        std::vector<gr_complex> channels; // converted cshort channels, one after another
+        std::vector<gr_complex> sum;      // weighted sum, with the history of the filter
+        std::vector<gr_complex> filtered; // filter output before the cshort conversion
+    };
+    std::vector<Scratch> d_scratch; // one per thread
+
+    // adaptive mode
+    std::vector<std::complex<double> > d_covariance; // row major, only the upper triangle is accumulated
+    unsigned int d_collected_snapshots;
+    unsigned int d_next_snapshot;                   // offset of the next snapshot in the next call
+    unsigned long long d_samples_since_estimation;  // since the start of the last estimation
+    bool d_collecting;
+
 public:
-    beamformer();
     ~beamformer();
+
+    static const unsigned int min_chunk = 4096;
+
+    unsigned int num_threads() const { return d_num_threads; }
+
+    /*!
+     * \brief The weights of the current output, y = sum_k weight_k * x_k
+     */
+    std::vector<gr_complex> weights() const;
+
     int work (int noutput_items, gr_vector_const_void_star &input_items,
               gr_vector_void_star &output_items);
 };
@@ -0,0 +1,207 @@
+/*!
+ * \file complex_fir_filter.cc
+ * \brief FIR filter with real taps for gr_complex and cshort samples, in
+ * direct form or by FFT overlap-save
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "complex_fir_filter.h"
+#include <algorithm>
+#include <cstring>
+#include <gnuradio/io_signature.h>
+#include <volk/volk.h>
+
+// Converted input samples per chunk in direct form (32 kB of gr_complex)
+#define COMPLEX_FIR_CHUNK_SAMPLES 4096
+// The FFT is at least this many times longer than the filter, so most of each block is output
+#define COMPLEX_FIR_FFT_OVERSIZE 4
+
+static const size_t complex_fir_item_size[2] = {sizeof(gr_complex), sizeof(lv_16sc_t)};
+
+
+complex_fir_filter_sptr make_complex_fir_filter(Complex_Fir_Item_Type input_type,
+        Complex_Fir_Item_Type output_type, const std::vector<float>& taps,
+        unsigned int fft_min_taps)
+{
+    return complex_fir_filter_sptr(new complex_fir_filter(input_type, output_type, taps, fft_min_taps));
+}
+
+
+
+complex_fir_filter::complex_fir_filter(Complex_Fir_Item_Type input_type,
+        Complex_Fir_Item_Type output_type, const std::vector<float>& taps,
+        unsigned int fft_min_taps) :
+        gr::sync_block("complex_fir_filter",
+                gr::io_signature::make(1, 1, complex_fir_item_size[input_type]),
+                gr::io_signature::make(1, 1, complex_fir_item_size[output_type])),
+        d_input_type(input_type),
+        d_output_type(output_type),
+        d_fft_size(0),
+        d_block_outputs(0),
+        d_fft(0),
+        d_ifft(0)
+{
+    std::vector<float> filter_taps(taps);
+    if (filter_taps.empty())
+        {
+            filter_taps.push_back(1.0);
+        }
+    d_ntaps = filter_taps.size();
+    d_use_fft = (fft_min_taps > 0) && (d_ntaps >= fft_min_taps);
+    set_history(d_ntaps);
+
+    if (d_use_fft)
+        {
+            d_fft_size = 1;
+            while (d_fft_size < COMPLEX_FIR_FFT_OVERSIZE * d_ntaps)
+                {
+                    d_fft_size *= 2;
+                }
+            d_block_outputs = d_fft_size - (d_ntaps - 1);
+            d_fft = new gr::fft::fft_complex(d_fft_size, true);
+            d_ifft = new gr::fft::fft_complex(d_fft_size, false);
+
+            // frequency response of the zero-padded taps, with the 1/N of the inverse FFT
+            gr_complex* fft_in = d_fft->get_inbuf();
+            std::fill(fft_in, fft_in + d_fft_size, gr_complex(0.0, 0.0));
+            for (unsigned int i = 0; i < d_ntaps; i++)
+                {
+                    fft_in[i] = gr_complex(filter_taps[i] / d_fft_size, 0.0);
+                }
+            d_fft->execute();
+            d_frequency_response.assign(d_fft->get_outbuf(), d_fft->get_outbuf() + d_fft_size);
+            set_output_multiple(d_block_outputs);
+        }
+    else
+        {
+            d_reversed_taps.assign(filter_taps.rbegin(), filter_taps.rend());
+            if (d_input_type != COMPLEX_FIR_GR_COMPLEX)
+                {
+                    d_samples.resize(std::max(static_cast<unsigned int>(COMPLEX_FIR_CHUNK_SAMPLES), 2 * d_ntaps));
+                }
+        }
+}
+
+
+
+complex_fir_filter::~complex_fir_filter()
+{
+    delete d_fft;
+    delete d_ifft;
+}
+
+
+
+void complex_fir_filter::convert_input(const void* in, gr_complex* out, unsigned int n_samples)
+{
+    if (d_input_type == COMPLEX_FIR_CSHORT)
+        {
+            volk_16i_s32f_convert_32f(reinterpret_cast<float*>(out), static_cast<const int16_t*>(in), 1.0, 2 * n_samples);
+        }
+    else
+        {
+            std::memcpy(out, in, n_samples * sizeof(gr_complex));
+        }
+}
+
+
+
+void complex_fir_filter::convert_output(const gr_complex* in, void* out, unsigned int n_samples)
+{
+    if (d_output_type == COMPLEX_FIR_CSHORT)
+        {
+            volk_32f_s32f_convert_16i(static_cast<int16_t*>(out), reinterpret_cast<const float*>(in), 1.0, 2 * n_samples);
+        }
+    else if (in != out)
+        {
+            std::memcpy(out, in, n_samples * sizeof(gr_complex));
+        }
+}
+
+
+
+int complex_fir_filter::work(int noutput_items,
+        gr_vector_const_void_star &input_items,
+        gr_vector_void_star &output_items)
+{
+    const char* in = static_cast<const char*>(input_items[0]);
+    char* out = static_cast<char*>(output_items[0]);
+    const size_t in_size = complex_fir_item_size[d_input_type];
+    const size_t out_size = complex_fir_item_size[d_output_type];
+
+    if (d_use_fft)
+        {
+            // overlap-save: each block reads its outputs plus the ntaps - 1 samples before them
+            for (int n = 0; n < noutput_items; n += d_block_outputs)
+                {
+                    convert_input(in + n * in_size, d_fft->get_inbuf(), d_fft_size);
+                    d_fft->execute();
+                    volk_32fc_x2_multiply_32fc(d_ifft->get_inbuf(), d_fft->get_outbuf(), &d_frequency_response[0], d_fft_size);
+                    d_ifft->execute();
+                    convert_output(d_ifft->get_outbuf() + d_ntaps - 1, out + n * out_size, d_block_outputs);
+                }
+            return noutput_items;
+        }
+
+    if (d_input_type == COMPLEX_FIR_GR_COMPLEX && d_output_type == COMPLEX_FIR_GR_COMPLEX)
+        {
+            const gr_complex* samples = reinterpret_cast<const gr_complex*>(in);
+            gr_complex* result = reinterpret_cast<gr_complex*>(out);
+            for (int n = 0; n < noutput_items; n++)
+                {
+                    volk_32fc_32f_dot_prod_32fc(&result[n], &samples[n], &d_reversed_taps[0], d_ntaps);
+                }
+            return noutput_items;
+        }
+
+    // direct form with conversions, one chunk at a time
+    const gr_complex* samples = reinterpret_cast<const gr_complex*>(in);
+    const int chunk_outputs = (d_input_type == COMPLEX_FIR_GR_COMPLEX) ? COMPLEX_FIR_CHUNK_SAMPLES : d_samples.size() - (d_ntaps - 1);
+    d_outputs.resize(std::min(noutput_items, chunk_outputs));
+    for (int produced = 0; produced < noutput_items; )
+        {
+            const int n_out = std::min(noutput_items - produced, chunk_outputs);
+            if (d_input_type != COMPLEX_FIR_GR_COMPLEX)
+                {
+                    convert_input(in + produced * in_size, &d_samples[0], n_out + d_ntaps - 1);
+                    samples = &d_samples[0];
+                }
+            else
+                {
+                    samples = reinterpret_cast<const gr_complex*>(in) + produced;
+                }
+            for (int n = 0; n < n_out; n++)
+                {
+                    volk_32fc_32f_dot_prod_32fc(&d_outputs[n], &samples[n], &d_reversed_taps[0], d_ntaps);
+                }
+            convert_output(&d_outputs[0], out + produced * out_size, n_out);
+            produced += n_out;
+        }
+    return noutput_items;
+}
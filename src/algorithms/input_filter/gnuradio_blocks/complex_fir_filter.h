@@ -0,0 +1,111 @@
+/*!
+ * \file complex_fir_filter.h
+ * \brief FIR filter with real taps for gr_complex and cshort samples, in
+ * direct form or by FFT overlap-save
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_COMPLEX_FIR_FILTER_H_
+#define GNSS_SDR_COMPLEX_FIR_FILTER_H_
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <gnuradio/sync_block.h>
+#include <gnuradio/fft/fft.h>
+
+/*!
+ * \brief Sample type of the input or the output stream
+ */
+enum Complex_Fir_Item_Type
+{
+    COMPLEX_FIR_GR_COMPLEX = 0,
+    COMPLEX_FIR_CSHORT = 1
+};
+
+class complex_fir_filter;
+
+typedef boost::shared_ptr<complex_fir_filter> complex_fir_filter_sptr;
+
+/*!
+ * \brief Makes the block. Filters with fft_min_taps taps or more are
+ * computed by FFT, the shorter ones in direct form.
+ */
+complex_fir_filter_sptr make_complex_fir_filter(Complex_Fir_Item_Type input_type,
+        Complex_Fir_Item_Type output_type, const std::vector<float>& taps,
+        unsigned int fft_min_taps);
+
+/*!
+ * \brief Filters complex samples with real taps, converting cshort on
+ * the fly.
+ *
+ * The cshort samples are filtered as complex numbers, instead of being
+ * split into I and Q streams for two real filters and merged back. In
+ * direct form each output is one VOLK dot product. For long filters the
+ * block uses overlap-save: blocks of fft_size - (ntaps - 1) outputs are
+ * computed with a forward FFT, a product with the frequency response and
+ * an inverse FFT, which costs O(log fft_size) instead of O(ntaps) per
+ * output. The output is the same as gr::filter::fir_filter_ccf.
+ */
+class complex_fir_filter : public gr::sync_block
+{
+private:
+    friend complex_fir_filter_sptr make_complex_fir_filter(Complex_Fir_Item_Type input_type,
+            Complex_Fir_Item_Type output_type, const std::vector<float>& taps,
+            unsigned int fft_min_taps);
+
+    complex_fir_filter(Complex_Fir_Item_Type input_type, Complex_Fir_Item_Type output_type,
+            const std::vector<float>& taps, unsigned int fft_min_taps);
+
+    void convert_input(const void* in, gr_complex* out, unsigned int n_samples);
+    void convert_output(const gr_complex* in, void* out, unsigned int n_samples);
+
+    Complex_Fir_Item_Type d_input_type;
+    Complex_Fir_Item_Type d_output_type;
+    unsigned int d_ntaps;
+    bool d_use_fft;
+    std::vector<float> d_reversed_taps;         // direct form
+    std::vector<gr_complex> d_samples;          // direct form: converted input of one chunk
+    std::vector<gr_complex> d_outputs;          // outputs before the cshort conversion
+    unsigned int d_fft_size;
+    unsigned int d_block_outputs;               // outputs per FFT block
+    std::vector<gr_complex> d_frequency_response; // scaled by 1 / d_fft_size
+    gr::fft::fft_complex* d_fft;
+    gr::fft::fft_complex* d_ifft;
+
+public:
+    ~complex_fir_filter();
+
+    bool uses_fft() const { return d_use_fft; }
+
+    int work(int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items);
+};
+
+#endif
@@ -0,0 +1,131 @@
+/*!
+ * \file xlating_fir_decimator.cc
+ * \brief Decodes raw samples, translates them in frequency and filters and
+ * decimates them in a single pass
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "xlating_fir_decimator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <gnuradio/io_signature.h>
+#include <volk/volk.h>
+
+// Converted input samples per chunk (32 kB of gr_complex)
+#define XLATING_FIR_CHUNK_SAMPLES 4096
+
+static const unsigned int xlating_fir_scalar_size[3] = {sizeof(int8_t), sizeof(int16_t), sizeof(float)};
+
+
+xlating_fir_decimator_sptr make_xlating_fir_decimator(Xlating_Fir_Sample_Format sample_format,
+        unsigned int scalars_per_item, unsigned int decimation, const std::vector<float>& taps,
+        double intermediate_freq, double sampling_freq)
+{
+    return xlating_fir_decimator_sptr(new xlating_fir_decimator(sample_format, scalars_per_item,
+            decimation, taps, intermediate_freq, sampling_freq));
+}
+
+
+
+xlating_fir_decimator::xlating_fir_decimator(Xlating_Fir_Sample_Format sample_format,
+        unsigned int scalars_per_item, unsigned int decimation, const std::vector<float>& taps,
+        double intermediate_freq, double sampling_freq) :
+        gr::sync_decimator("xlating_fir_decimator",
+                gr::io_signature::make(1, 1, 2 * xlating_fir_scalar_size[sample_format] / scalars_per_item),
+                gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                scalars_per_item * std::max(decimation, 1u))
+{
+    d_sample_format = sample_format;
+    d_sample_size = 2 * xlating_fir_scalar_size[sample_format];
+    d_decimation = std::max(decimation, 1u);
+
+    // Same composite filter as gr::filter::freq_xlating_fir_filter
+    const double fwT0 = 2.0 * M_PI * intermediate_freq / sampling_freq;
+    const unsigned int ntaps = std::max(static_cast<unsigned int>(taps.size()), 1u);
+    d_taps.resize(ntaps, gr_complex(1.0, 0.0));
+    for (unsigned int i = 0; i < taps.size(); i++)
+        {
+            d_taps[ntaps - 1 - i] = taps[i] * gr_complex(std::cos(i * fwT0), std::sin(i * fwT0));
+        }
+    d_phase = gr_complex(1.0, 0.0);
+    d_phase_inc = gr_complex(std::cos(fwT0 * d_decimation), -std::sin(fwT0 * d_decimation));
+
+    set_history(scalars_per_item * (ntaps - 1) + 1);
+    d_samples.resize(std::max(static_cast<unsigned int>(XLATING_FIR_CHUNK_SAMPLES), ntaps + d_decimation));
+}
+
+
+
+void xlating_fir_decimator::convert(const char* in, unsigned int n_samples)
+{
+    float* out = reinterpret_cast<float*>(&d_samples[0]);
+    switch (d_sample_format)
+    {
+    case XLATING_FIR_INT8:
+        volk_8i_s32f_convert_32f(out, reinterpret_cast<const int8_t*>(in), 1.0, 2 * n_samples);
+        break;
+    case XLATING_FIR_INT16:
+        volk_16i_s32f_convert_32f(out, reinterpret_cast<const int16_t*>(in), 1.0, 2 * n_samples);
+        break;
+    default:
+        std::memcpy(out, in, n_samples * sizeof(gr_complex));
+    }
+}
+
+
+
+int xlating_fir_decimator::work(int noutput_items,
+        gr_vector_const_void_star &input_items,
+        gr_vector_void_star &output_items)
+{
+    const char *in = (const char *) input_items[0];
+    gr_complex *out = (gr_complex *) output_items[0];
+    const unsigned int ntaps = d_taps.size();
+    const int chunk_outputs = (d_samples.size() - ntaps) / d_decimation + 1;
+
+    int produced = 0;
+    while (produced < noutput_items)
+        {
+            const int n_out = std::min(noutput_items - produced, chunk_outputs);
+            convert(in + static_cast<size_t>(produced) * d_decimation * d_sample_size,
+                    (n_out - 1) * d_decimation + ntaps);
+            for (int m = 0; m < n_out; m++)
+                {
+                    gr_complex acc;
+                    volk_32fc_x2_dot_prod_32fc(&acc, &d_samples[m * d_decimation], &d_taps[0], ntaps);
+                    out[produced + m] = acc * d_phase;
+                    d_phase *= d_phase_inc;
+                }
+            // keep the rotator on the unit circle
+            d_phase /= std::abs(d_phase);
+            produced += n_out;
+        }
+    return noutput_items;
+}
@@ -0,0 +1,103 @@
+/*!
+ * \file xlating_fir_decimator.h
+ * \brief Decodes raw samples, translates them in frequency and filters and
+ * decimates them in a single pass
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_XLATING_FIR_DECIMATOR_H_
+#define GNSS_SDR_XLATING_FIR_DECIMATOR_H_
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <gnuradio/sync_decimator.h>
+
+/*!
+ * \brief Scalar type of the raw input samples
+ */
+enum Xlating_Fir_Sample_Format
+{
+    XLATING_FIR_INT8 = 0,
+    XLATING_FIR_INT16 = 1,
+    XLATING_FIR_FLOAT32 = 2
+};
+
+class xlating_fir_decimator;
+
+typedef boost::shared_ptr<xlating_fir_decimator> xlating_fir_decimator_sptr;
+
+/*!
+ * \brief Makes the block. Each complex sample is an I/Q pair of
+ * sample_format scalars, arriving as scalars_per_item items: 2 for the
+ * interleaved formats (ibyte, ishort), 1 for the complex ones (cbyte,
+ * cshort, gr_complex).
+ */
+xlating_fir_decimator_sptr make_xlating_fir_decimator(Xlating_Fir_Sample_Format sample_format,
+        unsigned int scalars_per_item, unsigned int decimation, const std::vector<float>& taps,
+        double intermediate_freq, double sampling_freq);
+
+/*!
+ * \brief Replaces the data type adapter + freq_xlating_fir_filter chain
+ * with one block.
+ *
+ * Computes the same output as gr::filter::freq_xlating_fir_filter_ccf fed
+ * with the converted samples: the taps are rotated to the intermediate
+ * frequency, each output is one dot product over the decimated input and
+ * a rotator brings the result down to zero Hz. The input is converted to
+ * gr_complex in chunks small enough to stay in the cache while they are
+ * filtered, so no intermediate stream is written to the GNU Radio buffers.
+ */
+class xlating_fir_decimator : public gr::sync_decimator
+{
+private:
+    friend xlating_fir_decimator_sptr make_xlating_fir_decimator(Xlating_Fir_Sample_Format sample_format,
+            unsigned int scalars_per_item, unsigned int decimation, const std::vector<float>& taps,
+            double intermediate_freq, double sampling_freq);
+
+    xlating_fir_decimator(Xlating_Fir_Sample_Format sample_format, unsigned int scalars_per_item,
+            unsigned int decimation, const std::vector<float>& taps,
+            double intermediate_freq, double sampling_freq);
+
+    void convert(const char* in, unsigned int n_samples);
+
+    Xlating_Fir_Sample_Format d_sample_format;
+    unsigned int d_sample_size;   // bytes of one complex input sample
+    unsigned int d_decimation;
+    std::vector<gr_complex> d_taps;    // rotated and reversed
+    std::vector<gr_complex> d_samples; // converted input of one chunk
+    gr_complex d_phase;
+    gr_complex d_phase_inc;
+
+public:
+    int work(int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items);
+};
+
+#endif
@@ -0,0 +1,207 @@
+/*!
+ * \file allocation_guard.cc
+ * \brief Counts the heap allocations of each thread, to find the blocks that
+ * allocate in their steady state
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "allocation_guard.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <set>
+#include <sstream>
+#include <boost/thread/mutex.hpp>
+
+
+namespace
+{
+std::atomic<unsigned long long> & warmup_calls()
+{
+    static std::atomic<unsigned long long> calls(1000);
+    return calls;
+}
+
+std::atomic<bool> & abort_switch()
+{
+    static std::atomic<bool> abort(false);
+    return abort;
+}
+
+boost::mutex & hot_blocks_mutex()
+{
+    static boost::mutex mutex;
+    return mutex;
+}
+
+std::set<std::string> & hot_blocks()
+{
+    static std::set<std::string> blocks;
+    return blocks;
+}
+
+#ifdef GNSS_SDR_ALLOCATION_GUARD
+// plain data, so that they need no initialization before the first new
+thread_local unsigned long long thread_allocations = 0;
+thread_local unsigned long long thread_bytes = 0;
+
+void * counted_malloc(std::size_t size)
+{
+    thread_allocations++;
+    thread_bytes += size;
+    return std::malloc(size == 0 ? 1 : size);
+}
+#endif
+}
+
+
+#ifdef GNSS_SDR_ALLOCATION_GUARD
+void * operator new(std::size_t size)
+{
+    void* p = counted_malloc(size);
+    if (p == 0)
+        {
+            throw std::bad_alloc();
+        }
+    return p;
+}
+
+
+void * operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+
+void * operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return counted_malloc(size);
+}
+
+
+void * operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return counted_malloc(size);
+}
+
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+#endif
+
+
+Allocation_Count thread_allocation_count()
+{
+    Allocation_Count count;
+#ifdef GNSS_SDR_ALLOCATION_GUARD
+    count.allocations = thread_allocations;
+    count.bytes = thread_bytes;
+#else
+    count.allocations = 0;
+    count.bytes = 0;
+#endif
+    return count;
+}
+
+
+bool allocation_guard_compiled()
+{
+#ifdef GNSS_SDR_ALLOCATION_GUARD
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+void set_allocation_guard_hot(const std::string& blocks)
+{
+    std::set<std::string> hot;
+    std::istringstream list(blocks);
+    std::string block;
+    while (std::getline(list, block, ','))
+        {
+            size_t first = block.find_first_not_of(" \t");
+            if (first != std::string::npos)
+                {
+                    hot.insert(block.substr(first, block.find_last_not_of(" \t") - first + 1));
+                }
+        }
+    boost::mutex::scoped_lock lock(hot_blocks_mutex());
+    hot_blocks().swap(hot);
+}
+
+
+bool allocation_guard_hot(const std::string& block)
+{
+    boost::mutex::scoped_lock lock(hot_blocks_mutex());
+    return hot_blocks().count(block) > 0;
+}
+
+
+void set_allocation_guard_warmup_calls(unsigned long long calls)
+{
+    warmup_calls().store(calls, std::memory_order_relaxed);
+}
+
+
+unsigned long long allocation_guard_warmup_calls()
+{
+    return warmup_calls().load(std::memory_order_relaxed);
+}
+
+
+void set_allocation_guard_abort(bool abort)
+{
+    abort_switch().store(abort, std::memory_order_relaxed);
+}
+
+
+bool allocation_guard_abort()
+{
+    return abort_switch().load(std::memory_order_relaxed);
+}
@@ -0,0 +1,77 @@
+/*!
+ * \file allocation_guard.h
+ * \brief Counts the heap allocations of each thread, to find the blocks that
+ * allocate in their steady state
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_ALLOCATION_GUARD_H_
+#define GNSS_SDR_ALLOCATION_GUARD_H_
+
+#include <string>
+
+/*
+ * The build option ENABLE_ALLOCATION_GUARD=ON (GNSS_SDR_ALLOCATION_GUARD)
+ * replaces the global operator new with one that counts the allocations and
+ * the bytes allocated by each thread. Block_Metrics_Scope takes the counts
+ * at the start and at the end of a call, so the metrics of each block and
+ * spoofing check tell how much the call allocated. Without the option the
+ * counts stay at zero and cost nothing.
+ */
+
+struct Allocation_Count
+{
+    unsigned long long allocations;
+    unsigned long long bytes;
+};
+
+//! Allocations made so far by the calling thread
+Allocation_Count thread_allocation_count();
+
+//! true if the build counts the allocations
+bool allocation_guard_compiled();
+
+/*!
+ * \brief Marks the blocks whose calls must not allocate once they are in
+ * their steady state (Receiver.allocation_guard_hot), a comma separated list
+ * of block names of make_block_metrics(), e.g. "tracking,telemetry"
+ */
+void set_allocation_guard_hot(const std::string& blocks);
+bool allocation_guard_hot(const std::string& block);
+
+/*!
+ * \brief Calls of a hot block that may still allocate, while it fills its
+ * buffers (Receiver.allocation_guard_warmup_calls)
+ */
+void set_allocation_guard_warmup_calls(unsigned long long calls);
+unsigned long long allocation_guard_warmup_calls();
+
+//! Abort the receiver, instead of logging an error, when a hot block allocates
+void set_allocation_guard_abort(bool abort);
+bool allocation_guard_abort();
+
+#endif
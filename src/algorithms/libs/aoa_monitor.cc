@@ -0,0 +1,119 @@
+/*!
+ * \file aoa_monitor.cc
+ * \brief Implementation of the spatial signature accumulator of a tracking
+ * channel fed by an antenna array
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "aoa_monitor.h"
+#include <algorithm>
+#include <cmath>
+
+Aoa_Monitor::Aoa_Monitor(int decimation, unsigned int averages)
+{
+    d_metrics = Aoa_Metrics();
+    d_decimation = std::max(decimation, 0);
+    d_averages = std::max(averages, 1u);
+    d_products.resize(AOA_MAX_ELEMENTS);
+    d_magnitudes.resize(AOA_MAX_ELEMENTS);
+    reset(0);
+}
+
+
+void Aoa_Monitor::reset(unsigned int PRN)
+{
+    d_metrics.PRN = PRN;
+    d_metrics.sample_counter = 0;
+    d_metrics.n_elements = 0;
+    d_metrics.coherence = 0.0;
+    for (unsigned int k = 0; k < AOA_MAX_ELEMENTS; k++)
+        {
+            d_metrics.steering[k] = gr_complex(0.0, 0.0);
+        }
+    d_periods = 0;
+    d_added = 0;
+    std::fill(d_products.begin(), d_products.end(), gr_complex(0.0, 0.0));
+    std::fill(d_magnitudes.begin(), d_magnitudes.end(), 0.0);
+}
+
+
+bool Aoa_Monitor::next_period()
+{
+    if (!enabled() or ++d_periods < d_decimation)
+        {
+            return false;
+        }
+    d_periods = 0;
+    return true;
+}
+
+
+bool Aoa_Monitor::add(const gr_complex* element_prompts, unsigned int n_elements, unsigned long int sample_counter)
+{
+    n_elements = std::min<unsigned int>(n_elements, AOA_MAX_ELEMENTS);
+    if (n_elements < 2)
+        {
+            return false;
+        }
+    // relative to the first element, which wipes off the carrier phase and the data bit
+    gr_complex reference = std::conj(element_prompts[0]);
+    for (unsigned int k = 0; k < n_elements; k++)
+        {
+            gr_complex product = element_prompts[k] * reference;
+            d_products[k] += product;
+            d_magnitudes[k] += std::abs(product);
+        }
+    if (++d_added < d_averages)
+        {
+            return false;
+        }
+
+    float norm = 0.0;
+    float coherence = 0.0;
+    for (unsigned int k = 0; k < n_elements; k++)
+        {
+            norm += std::norm(d_products[k]);
+            if (k > 0)
+                {
+                    coherence += d_magnitudes[k] > 0.0 ? std::abs(d_products[k]) / d_magnitudes[k] : 0.0;
+                }
+        }
+    norm = std::sqrt(norm);
+    for (unsigned int k = 0; k < AOA_MAX_ELEMENTS; k++)
+        {
+            d_metrics.steering[k] = (k < n_elements and norm > 0.0) ? d_products[k] / norm : gr_complex(0.0, 0.0);
+        }
+    d_metrics.n_elements = n_elements;
+    d_metrics.coherence = coherence / static_cast<float>(n_elements - 1);
+    d_metrics.sample_counter = sample_counter;
+
+    d_added = 0;
+    std::fill(d_products.begin(), d_products.end(), gr_complex(0.0, 0.0));
+    std::fill(d_magnitudes.begin(), d_magnitudes.end(), 0.0);
+    return true;
+}
@@ -0,0 +1,86 @@
+/*!
+ * \file aoa_monitor.h
+ * \brief Interface of the spatial signature accumulator of a tracking
+ * channel fed by an antenna array
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_AOA_MONITOR_H_
+#define GNSS_SDR_AOA_MONITOR_H_
+
+#include <vector>
+#include <gnuradio/gr_complex.h>
+#include "aoa_metrics.h"
+
+/*!
+ * \brief Turns the Prompt of each antenna element of a channel into
+ * Aoa_Metrics.
+ *
+ * The tracking block asks next_period() once per code period, and only
+ * correlates the elements in the periods it returns true for, one in
+ * decimation of them, so the array costs little more than the single
+ * stream. The Prompt of each element, times the conjugate of that of the
+ * first element, is added to running sums, which removes the carrier
+ * phase and the data bit. The steering vector and its coherence are
+ * computed from the sums once every averages correlations.
+ */
+class Aoa_Monitor
+{
+public:
+    /*!
+     * \param decimation - code periods between two correlations of the elements, 0 disables it
+     * \param averages - correlations averaged in each metrics
+     */
+    Aoa_Monitor(int decimation = 0, unsigned int averages = 10);
+
+    bool enabled() const { return d_decimation > 0; }
+
+    //! Starts over, for a new satellite
+    void reset(unsigned int PRN);
+
+    //! Counts a code period, true if the elements are to be correlated in it
+    bool next_period();
+
+    /*!
+     * \brief Adds the Prompt of the n_elements elements of one code period
+     * \return true when the metrics have been updated
+     */
+    bool add(const gr_complex* element_prompts, unsigned int n_elements, unsigned long int sample_counter);
+
+    const Aoa_Metrics& metrics() const { return d_metrics; }
+
+private:
+    Aoa_Metrics d_metrics;
+    int d_decimation;
+    unsigned int d_averages;
+    int d_periods;
+    unsigned int d_added;
+    std::vector<gr_complex> d_products; // of each element with the first one
+    std::vector<float> d_magnitudes;    // sums of the magnitudes of the products
+};
+
+#endif
@@ -0,0 +1,276 @@
+/*!
+ * \file block_metrics.cc
+ * \brief Counters of the cost of the calls to the blocks of the receiver,
+ * and their export in the Prometheus text format
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "block_metrics.h"
+#include <limits>
+#include <map>
+#include <sstream>
+#include <boost/thread/mutex.hpp>
+#include <glog/logging.h>
+
+
+namespace
+{
+std::atomic<bool> & block_metrics_switch()
+{
+    static std::atomic<bool> enabled(false);
+    return enabled;
+}
+
+boost::mutex & block_metrics_registry_mutex()
+{
+    static boost::mutex mutex;
+    return mutex;
+}
+
+std::vector<std::weak_ptr<Block_Metrics> > & block_metrics_registry()
+{
+    static std::vector<std::weak_ptr<Block_Metrics> > registry;
+    return registry;
+}
+
+std::string block_metrics_labels(const Block_Metrics& metrics)
+{
+    return "block=\"" + metrics.block() + "\",instance=\"" + metrics.instance() + "\"";
+}
+}
+
+
+Block_Metrics::Block_Metrics(const std::string& block, const std::string& instance) :
+        d_block(block),
+        d_instance(instance),
+        d_calls(0),
+        d_items(0),
+        d_input_items(0),
+        d_busy_ns(0),
+        d_max_ns(0),
+        d_allocations(0),
+        d_allocated_bytes(0),
+        d_allocation_reported(false)
+{
+    for (int n = 0; n < BUCKETS; n++)
+        {
+            d_buckets[n].store(0, std::memory_order_relaxed);
+        }
+}
+
+
+void Block_Metrics::add_call(std::chrono::steady_clock::duration duration, unsigned long long items, unsigned long long input_items)
+{
+    unsigned long long ns = static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+    d_calls.fetch_add(1, std::memory_order_relaxed);
+    d_items.fetch_add(items, std::memory_order_relaxed);
+    d_input_items.fetch_add(input_items, std::memory_order_relaxed);
+    d_busy_ns.fetch_add(ns, std::memory_order_relaxed);
+    unsigned long long max_ns = d_max_ns.load(std::memory_order_relaxed);
+    while (ns > max_ns && !d_max_ns.compare_exchange_weak(max_ns, ns, std::memory_order_relaxed))
+        {}
+    int n = 0;
+    unsigned long long us = ns / 1000;
+    while (us > 0 && n < BUCKETS - 1)
+        {
+            us >>= 1;
+            n++;
+        }
+    d_buckets[n].fetch_add(1, std::memory_order_relaxed);
+}
+
+
+void Block_Metrics::add_allocations(unsigned long long allocations, unsigned long long bytes)
+{
+    if (allocations == 0)
+        {
+            return;
+        }
+    d_allocations.fetch_add(allocations, std::memory_order_relaxed);
+    d_allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    if (d_calls.load(std::memory_order_relaxed) <= allocation_guard_warmup_calls() || !allocation_guard_hot(d_block))
+        {
+            return;
+        }
+    if (allocation_guard_abort())
+        {
+            LOG(FATAL) << "Hot block " << d_block << " " << d_instance << " made " << allocations
+                       << " heap allocations (" << bytes << " bytes) in a call of its steady state";
+        }
+    if (!d_allocation_reported.exchange(true, std::memory_order_relaxed))
+        {
+            LOG(ERROR) << "Hot block " << d_block << " " << d_instance << " made " << allocations
+                       << " heap allocations (" << bytes << " bytes) in a call of its steady state";
+        }
+}
+
+
+Block_Metrics::Snapshot Block_Metrics::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.calls = d_calls.load(std::memory_order_relaxed);
+    snapshot.items = d_items.load(std::memory_order_relaxed);
+    snapshot.input_items = d_input_items.load(std::memory_order_relaxed);
+    snapshot.busy_ns = d_busy_ns.load(std::memory_order_relaxed);
+    snapshot.max_ns = d_max_ns.load(std::memory_order_relaxed);
+    for (int n = 0; n < BUCKETS; n++)
+        {
+            snapshot.buckets[n] = d_buckets[n].load(std::memory_order_relaxed);
+        }
+    snapshot.allocations = d_allocations.load(std::memory_order_relaxed);
+    snapshot.allocated_bytes = d_allocated_bytes.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+
+double Block_Metrics::bucket_limit_s(int n)
+{
+    if (n >= BUCKETS - 1)
+        {
+            return std::numeric_limits<double>::infinity();
+        }
+    return static_cast<double>(1ULL << n) * 1e-6;
+}
+
+
+std::shared_ptr<Block_Metrics> make_block_metrics(const std::string& block, const std::string& instance)
+{
+    std::shared_ptr<Block_Metrics> metrics = std::make_shared<Block_Metrics>(block, instance);
+    boost::mutex::scoped_lock lock(block_metrics_registry_mutex());
+    std::vector<std::weak_ptr<Block_Metrics> >& registry = block_metrics_registry();
+    for (unsigned int i = 0; i < registry.size(); i++)
+        {
+            if (registry[i].expired())
+                {
+                    registry[i] = metrics;
+                    return metrics;
+                }
+        }
+    registry.push_back(metrics);
+    return metrics;
+}
+
+
+std::vector<std::shared_ptr<Block_Metrics> > block_metrics_registered()
+{
+    std::vector<std::shared_ptr<Block_Metrics> > metrics;
+    boost::mutex::scoped_lock lock(block_metrics_registry_mutex());
+    std::vector<std::weak_ptr<Block_Metrics> >& registry = block_metrics_registry();
+    for (unsigned int i = 0; i < registry.size(); i++)
+        {
+            std::shared_ptr<Block_Metrics> block = registry[i].lock();
+            if (block)
+                {
+                    metrics.push_back(block);
+                }
+        }
+    return metrics;
+}
+
+
+bool block_metrics_enabled()
+{
+    return block_metrics_switch().load(std::memory_order_relaxed);
+}
+
+
+void set_block_metrics_enabled(bool enabled)
+{
+    block_metrics_switch().store(enabled, std::memory_order_relaxed);
+}
+
+
+std::string block_metrics_prometheus_text()
+{
+    std::vector<std::shared_ptr<Block_Metrics> > metrics = block_metrics_registered();
+    std::vector<Block_Metrics::Snapshot> snapshots;
+    for (unsigned int i = 0; i < metrics.size(); i++)
+        {
+            snapshots.push_back(metrics[i]->snapshot());
+        }
+
+    // each metric family is written once, with a line for each block
+    std::ostringstream text;
+    text.precision(9);
+    text << "# HELP gnss_sdr_block_calls_total Calls to the block\n"
+         << "# TYPE gnss_sdr_block_calls_total counter\n";
+    for (unsigned int i = 0; i < metrics.size(); i++)
+        {
+            text << "gnss_sdr_block_calls_total{" << block_metrics_labels(*metrics[i]) << "} " << snapshots[i].calls << "\n";
+        }
+    text << "# HELP gnss_sdr_block_items_total Items consumed by the block\n"
+         << "# TYPE gnss_sdr_block_items_total counter\n";
+    for (unsigned int i = 0; i < metrics.size(); i++)
+        {
+            text << "gnss_sdr_block_items_total{" << block_metrics_labels(*metrics[i]) << "} " << snapshots[i].items << "\n";
+        }
+    text << "# HELP gnss_sdr_block_input_items_total Items waiting at the input of the block, summed over the calls\n"
+         << "# TYPE gnss_sdr_block_input_items_total counter\n";
+    for (unsigned int i = 0; i < metrics.size(); i++)
+        {
+            text << "gnss_sdr_block_input_items_total{" << block_metrics_labels(*metrics[i]) << "} " << snapshots[i].input_items << "\n";
+        }
+    if (allocation_guard_compiled())
+        {
+            text << "# HELP gnss_sdr_block_allocations_total Heap allocations made by the calls to the block\n"
+                 << "# TYPE gnss_sdr_block_allocations_total counter\n";
+            for (unsigned int i = 0; i < metrics.size(); i++)
+                {
+                    text << "gnss_sdr_block_allocations_total{" << block_metrics_labels(*metrics[i]) << "} " << snapshots[i].allocations << "\n";
+                }
+            text << "# HELP gnss_sdr_block_allocated_bytes_total Bytes allocated by the calls to the block\n"
+                 << "# TYPE gnss_sdr_block_allocated_bytes_total counter\n";
+            for (unsigned int i = 0; i < metrics.size(); i++)
+                {
+                    text << "gnss_sdr_block_allocated_bytes_total{" << block_metrics_labels(*metrics[i]) << "} " << snapshots[i].allocated_bytes << "\n";
+                }
+        }
+    text << "# HELP gnss_sdr_block_call_max_seconds Longest call to the block\n"
+         << "# TYPE gnss_sdr_block_call_max_seconds gauge\n";
+    for (unsigned int i = 0; i < metrics.size(); i++)
+        {
+            text << "gnss_sdr_block_call_max_seconds{" << block_metrics_labels(*metrics[i]) << "} " << snapshots[i].max_ns * 1e-9 << "\n";
+        }
+    text << "# HELP gnss_sdr_block_call_seconds Duration of the calls to the block\n"
+         << "# TYPE gnss_sdr_block_call_seconds histogram\n";
+    for (unsigned int i = 0; i < metrics.size(); i++)
+        {
+            const std::string labels = block_metrics_labels(*metrics[i]);
+            unsigned long long cumulative = 0;
+            for (int n = 0; n < Block_Metrics::BUCKETS - 1; n++)
+                {
+                    cumulative += snapshots[i].buckets[n];
+                    text << "gnss_sdr_block_call_seconds_bucket{" << labels << ",le=\"" << Block_Metrics::bucket_limit_s(n) << "\"} " << cumulative << "\n";
+                }
+            // from the buckets, which may be a call ahead of the other counters
+            cumulative += snapshots[i].buckets[Block_Metrics::BUCKETS - 1];
+            text << "gnss_sdr_block_call_seconds_bucket{" << labels << ",le=\"+Inf\"} " << cumulative << "\n"
+                 << "gnss_sdr_block_call_seconds_sum{" << labels << "} " << snapshots[i].busy_ns * 1e-9 << "\n"
+                 << "gnss_sdr_block_call_seconds_count{" << labels << "} " << cumulative << "\n";
+        }
+    return text.str();
+}
@@ -0,0 +1,164 @@
+/*!
+ * \file block_metrics.h
+ * \brief Counters of the cost of the calls to the blocks of the receiver,
+ * and their export in the Prometheus text format
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_BLOCK_METRICS_H_
+#define GNSS_SDR_BLOCK_METRICS_H_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "allocation_guard.h"
+
+/*!
+ * \brief Cost of the calls to one block, or one check, of the receiver.
+ *
+ * The thread of the block adds each call to relaxed atomic counters,
+ * which any thread can read without stopping it: a call costs two reads
+ * of the steady clock and a few increments, and nothing at all while the
+ * metrics are disabled. The duration of the calls is kept in a histogram
+ * of power of two microseconds, from below 1 us up to 1 s and more.
+ * With the allocation guard compiled in, it also counts the heap
+ * allocations made by the calls.
+ */
+class Block_Metrics
+{
+public:
+    static const int BUCKETS = 22; //!< bucket n counts the calls shorter than 2^n us, the last one the rest
+
+    struct Snapshot
+    {
+        unsigned long long calls;
+        unsigned long long items;       //!< items consumed
+        unsigned long long input_items; //!< items waiting at the input, summed over the calls
+        unsigned long long busy_ns;
+        unsigned long long max_ns;
+        unsigned long long buckets[BUCKETS];
+        unsigned long long allocations;     //!< heap allocations made by the calls
+        unsigned long long allocated_bytes;
+    };
+
+    Block_Metrics(const std::string& block, const std::string& instance);
+
+    const std::string& block() const { return d_block; }
+    const std::string& instance() const { return d_instance; }
+
+    void add_call(std::chrono::steady_clock::duration duration, unsigned long long items, unsigned long long input_items);
+
+    /*!
+     * \brief Adds the allocations of the last call. Once the block is past
+     * its warm-up calls, any allocation of a hot block is an error.
+     */
+    void add_allocations(unsigned long long allocations, unsigned long long bytes);
+
+    Snapshot snapshot() const;
+
+    //! Upper limit of bucket n [s], infinity for the last one
+    static double bucket_limit_s(int n);
+
+private:
+    Block_Metrics(const Block_Metrics&);
+    Block_Metrics& operator=(const Block_Metrics&);
+
+    std::string d_block;
+    std::string d_instance;
+    std::atomic<unsigned long long> d_calls;
+    std::atomic<unsigned long long> d_items;
+    std::atomic<unsigned long long> d_input_items;
+    std::atomic<unsigned long long> d_busy_ns;
+    std::atomic<unsigned long long> d_max_ns;
+    std::atomic<unsigned long long> d_buckets[BUCKETS];
+    std::atomic<unsigned long long> d_allocations;
+    std::atomic<unsigned long long> d_allocated_bytes;
+    std::atomic<bool> d_allocation_reported; // the error is logged once per block
+};
+
+
+/*!
+ * \brief Makes the counters of one block, e.g. ("tracking", "ch3"). They
+ * are exported while the returned pointer lives.
+ */
+std::shared_ptr<Block_Metrics> make_block_metrics(const std::string& block, const std::string& instance);
+
+//! The counters of all the living blocks
+std::vector<std::shared_ptr<Block_Metrics> > block_metrics_registered();
+
+//! Switched at runtime (Receiver.metrics_enabled), disabled by default
+bool block_metrics_enabled();
+void set_block_metrics_enabled(bool enabled);
+
+//! All the counters in the Prometheus text exposition format
+std::string block_metrics_prometheus_text();
+
+
+/*!
+ * \brief Adds the call that lasts as long as the object to the metrics of
+ * a block, if the metrics are enabled when it starts. The object must live
+ * on the thread of the call, for the allocation counts are per thread.
+ */
+class Block_Metrics_Scope
+{
+public:
+    Block_Metrics_Scope(Block_Metrics* metrics, unsigned long long input_items) :
+            d_metrics(block_metrics_enabled() ? metrics : 0),
+            d_items(0),
+            d_input_items(input_items)
+    {
+        if (d_metrics)
+            {
+                d_allocated = thread_allocation_count();
+                d_start = std::chrono::steady_clock::now();
+            }
+    }
+
+    ~Block_Metrics_Scope()
+    {
+        if (d_metrics)
+            {
+                d_metrics->add_call(std::chrono::steady_clock::now() - d_start, d_items, d_input_items);
+                Allocation_Count allocated = thread_allocation_count();
+                d_metrics->add_allocations(allocated.allocations - d_allocated.allocations, allocated.bytes - d_allocated.bytes);
+            }
+    }
+
+    //! Items consumed by the call
+    void set_items(unsigned long long items) { d_items = items; }
+
+private:
+    Block_Metrics* d_metrics;
+    unsigned long long d_items;
+    unsigned long long d_input_items;
+    std::chrono::steady_clock::time_point d_start;
+    Allocation_Count d_allocated;
+};
+
+#endif
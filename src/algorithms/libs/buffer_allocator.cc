@@ -0,0 +1,427 @@
+/*!
+ * \file buffer_allocator.cc
+ * \brief Aligned allocation of the large signal processing buffers, with huge
+ * pages, NUMA placement and usage accounting per subsystem
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "buffer_allocator.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <boost/thread/mutex.hpp>
+#include <glog/logging.h>
+#include "static_limits.h"
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using google::LogMessage;
+
+namespace
+{
+/*
+ * Stored in the alignment bytes before every buffer
+ */
+struct Buffer_Header
+{
+    void* base;                       // start of the allocation or the mapping
+    size_t mapped_size;               // 0 if it comes from posix_memalign
+    size_t size;
+    size_t huge_page_bytes;
+    size_t arena_size;                // size of the arena block, 0 if it does not come from the arena
+    Buffer_Allocator::Usage* usage;
+};
+
+static_assert(sizeof(Buffer_Header) <= Buffer_Allocator::alignment, "The buffer header does not fit before the buffer");
+
+const size_t huge_page_size = 2 * 1024 * 1024;
+
+boost::mutex allocator_mutex;
+Buffer_Allocator::Hints receiver_hints;
+std::map<std::string, Buffer_Allocator::Usage> subsystem_usage; // nodes never move, the headers point to them
+bool huge_page_warning = false;
+bool numa_warning = false;
+
+#if defined(GNSS_SDR_STATIC_LIMITS)
+/*
+ * Stored at the start of a released arena block, in place of its header
+ */
+struct Free_Block
+{
+    Free_Block* next;
+    size_t size;
+};
+
+char* arena = 0;
+size_t arena_used = 0;          // bytes handed out from the start of the arena
+Free_Block* free_blocks = 0;    // released blocks, reused before arena_used grows
+#endif
+
+
+#if defined(__linux__)
+/*
+ * Maps size bytes at an address multiple of unit, a multiple of the page size
+ */
+void* map_aligned(size_t size, size_t unit)
+{
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t slack = unit > page ? unit : 0;
+    void* raw = mmap(0, size + slack, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        {
+            return 0;
+        }
+    char* begin = static_cast<char*>(raw);
+    char* aligned = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(begin) + unit - 1) / unit * unit);
+    if (slack > 0)
+        {
+            if (aligned > begin)
+                {
+                    munmap(begin, aligned - begin);
+                }
+            if (begin + slack > aligned)
+                {
+                    munmap(aligned + size, begin + slack - aligned);
+                }
+        }
+    return aligned;
+}
+
+
+bool bind_to_node(void* base, size_t size, int node)
+{
+    unsigned long nodemask[16] = {};
+    const int bits = 8 * sizeof(unsigned long);
+    if (node >= 16 * bits)
+        {
+            return false;
+        }
+    nodemask[node / bits] = 1UL << (node % bits);
+    return syscall(SYS_mbind, base, size, MPOL_PREFERRED, nodemask, 16 * bits + 1, 0) == 0;
+}
+
+
+/*
+ * Maps the buffer if the hints need it, before it is ever touched so that
+ * the NUMA policy applies to all of its pages
+ */
+void* map_buffer(size_t total, const Buffer_Allocator::Hints& hints, size_t& mapped_size, size_t& huge_page_bytes)
+{
+    size_t page = sysconf(_SC_PAGESIZE);
+    bool huge = hints.pages != Buffer_Allocator::Default_Pages && total >= huge_page_size / 2;
+    if (!huge && (hints.numa_node < 0 || total < page))
+        {
+            return 0;
+        }
+    size_t unit = huge ? huge_page_size : page;
+    size_t size = (total + unit - 1) / unit * unit;
+    void* base = 0;
+    if (huge && hints.pages == Buffer_Allocator::Explicit_Huge_Pages)
+        {
+            base = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (base == MAP_FAILED)
+                {
+                    base = 0;
+                    if (!huge_page_warning)
+                        {
+                            huge_page_warning = true;
+                            LOG(WARNING) << "No explicit huge pages left (see /proc/sys/vm/nr_hugepages), using transparent ones";
+                        }
+                }
+            else
+                {
+                    huge_page_bytes = size;
+                }
+        }
+    if (base == 0)
+        {
+            base = map_aligned(size, unit);
+            if (base == 0)
+                {
+                    return 0;
+                }
+            if (huge && madvise(base, size, MADV_HUGEPAGE) == 0)
+                {
+                    huge_page_bytes = size;
+                }
+        }
+    if (hints.numa_node >= 0 && !bind_to_node(base, size, hints.numa_node) && !numa_warning)
+        {
+            numa_warning = true;
+            LOG(WARNING) << "Unable to place the buffers on NUMA node " << hints.numa_node;
+        }
+    mapped_size = size;
+    return base;
+}
+#endif
+
+
+#if defined(GNSS_SDR_STATIC_LIMITS)
+/*
+ * Maps the arena with the receiver-wide hints and touches all of its
+ * pages, so that the signal processing never takes a page fault in it.
+ * Called with allocator_mutex held.
+ */
+bool reserve_arena()
+{
+    if (arena != 0)
+        {
+            return true;
+        }
+    size_t size = Static_Limits::arena_bytes();
+    void* base = 0;
+#if defined(__linux__)
+    size_t mapped_size = 0;
+    size_t huge_page_bytes = 0;
+    base = map_buffer(size, receiver_hints, mapped_size, huge_page_bytes);
+    if (base == 0)
+        {
+            base = map_aligned(size, sysconf(_SC_PAGESIZE));
+        }
+    if (base != 0 && mlock(base, size) != 0)
+        {
+            LOG(WARNING) << "Unable to lock the " << size << " bytes of the buffer arena in memory (see ulimit -l)";
+        }
+#else
+    if (posix_memalign(&base, Buffer_Allocator::alignment, size) != 0)
+        {
+            base = 0;
+        }
+#endif
+    if (base == 0)
+        {
+            LOG(ERROR) << "Error reserving the " << size << " bytes of the buffer arena";
+            return false;
+        }
+    std::memset(base, 0, size);
+    arena = static_cast<char*>(base);
+    LOG(INFO) << "Reserved a buffer arena of " << size << " bytes";
+    return true;
+}
+
+
+/*
+ * The smallest released block that holds block_size bytes, or a new one
+ * at the end of the used part of the arena. Called with allocator_mutex held.
+ */
+void* arena_block(size_t& block_size)
+{
+    if (!reserve_arena())
+        {
+            return 0;
+        }
+    Free_Block** best = 0;
+    for (Free_Block** it = &free_blocks; *it != 0; it = &(*it)->next)
+        {
+            if ((*it)->size >= block_size && (best == 0 || (*it)->size < (*best)->size))
+                {
+                    best = it;
+                    if ((*it)->size == block_size)
+                        {
+                            break;
+                        }
+                }
+        }
+    if (best != 0)
+        {
+            Free_Block* block = *best;
+            *best = block->next;
+            block_size = block->size;
+            return block;
+        }
+    if (block_size > Static_Limits::arena_bytes() - arena_used)
+        {
+            return 0;
+        }
+    void* block = arena + arena_used;
+    arena_used += block_size;
+    return block;
+}
+#endif
+}
+
+
+void* Buffer_Allocator::allocate(size_t size, const char* subsystem)
+{
+    return allocate(size, subsystem, default_hints());
+}
+
+
+void* Buffer_Allocator::allocate(size_t size, const char* subsystem, const Hints& hints)
+{
+    size_t total = size + alignment;
+    size_t mapped_size = 0;
+    size_t huge_page_bytes = 0;
+    size_t arena_size = 0;
+    void* base = 0;
+#if defined(GNSS_SDR_STATIC_LIMITS)
+    (void)hints; // the arena was placed with the receiver-wide hints
+    {
+        boost::mutex::scoped_lock lock(allocator_mutex);
+        arena_size = (total + alignment - 1) / alignment * alignment;
+        base = arena_block(arena_size);
+    }
+    if (base == 0)
+        {
+            LOG(ERROR) << "Error allocating " << size << " bytes for " << subsystem << ": the buffer arena of "
+                       << Static_Limits::arena_bytes() << " bytes is full (see GNSS_SDR_ARENA_MB)";
+            return 0;
+        }
+#elif defined(__linux__)
+    {
+        boost::mutex::scoped_lock lock(allocator_mutex); // for the warnings
+        base = map_buffer(total, hints, mapped_size, huge_page_bytes);
+    }
+#endif
+    if (base == 0)
+        {
+            int err = posix_memalign(&base, alignment, total);
+            if (err != 0)
+                {
+                    LOG(ERROR) << "Error allocating " << size << " bytes for " << subsystem << ": " << std::strerror(err);
+                    return 0;
+                }
+        }
+
+    Buffer_Header* header = static_cast<Buffer_Header*>(base);
+    header->base = base;
+    header->mapped_size = mapped_size;
+    header->size = size;
+    header->huge_page_bytes = huge_page_bytes;
+    header->arena_size = arena_size;
+    boost::mutex::scoped_lock lock(allocator_mutex);
+    Usage& usage = subsystem_usage[subsystem];
+    usage.bytes += size;
+    usage.huge_page_bytes += huge_page_bytes;
+    usage.buffers++;
+    if (usage.bytes > usage.peak_bytes)
+        {
+            usage.peak_bytes = usage.bytes;
+        }
+    header->usage = &usage;
+    return static_cast<char*>(base) + alignment;
+}
+
+
+void Buffer_Allocator::release(void* buffer)
+{
+    if (buffer == 0)
+        {
+            return;
+        }
+    Buffer_Header* header = reinterpret_cast<Buffer_Header*>(static_cast<char*>(buffer) - alignment);
+    void* base = header->base;
+    size_t mapped_size = header->mapped_size;
+    {
+        boost::mutex::scoped_lock lock(allocator_mutex);
+        header->usage->bytes -= header->size;
+        header->usage->huge_page_bytes -= header->huge_page_bytes;
+        header->usage->buffers--;
+#if defined(GNSS_SDR_STATIC_LIMITS)
+        Free_Block* block = static_cast<Free_Block*>(base);
+        block->size = header->arena_size;
+        block->next = free_blocks;
+        free_blocks = block;
+        return;
+#endif
+    }
+#if defined(__linux__)
+    if (mapped_size > 0)
+        {
+            munmap(base, mapped_size);
+            return;
+        }
+#endif
+    std::free(base);
+}
+
+
+bool Buffer_Allocator::reserve()
+{
+#if defined(GNSS_SDR_STATIC_LIMITS)
+    boost::mutex::scoped_lock lock(allocator_mutex);
+    return reserve_arena();
+#else
+    return true;
+#endif
+}
+
+
+void Buffer_Allocator::set_default_hints(const Hints& hints)
+{
+    boost::mutex::scoped_lock lock(allocator_mutex);
+    receiver_hints = hints;
+}
+
+
+Buffer_Allocator::Hints Buffer_Allocator::default_hints()
+{
+    boost::mutex::scoped_lock lock(allocator_mutex);
+    return receiver_hints;
+}
+
+
+Buffer_Allocator::Page_Mode Buffer_Allocator::page_mode(const std::string& name)
+{
+    if (name == "transparent")
+        {
+            return Transparent_Huge_Pages;
+        }
+    if (name == "explicit")
+        {
+            return Explicit_Huge_Pages;
+        }
+    if (name != "off" && !name.empty())
+        {
+            LOG(WARNING) << "Unknown huge page mode " << name << ", using the default pages";
+        }
+    return Default_Pages;
+}
+
+
+std::map<std::string, Buffer_Allocator::Usage> Buffer_Allocator::usage()
+{
+    boost::mutex::scoped_lock lock(allocator_mutex);
+    return subsystem_usage;
+}
+
+
+void Buffer_Allocator::log_usage()
+{
+    std::map<std::string, Usage> all = usage();
+    for (std::map<std::string, Usage>::const_iterator it = all.begin(); it != all.end(); ++it)
+        {
+            LOG(INFO) << "Buffers of " << it->first << ": " << it->second.buffers << " in use, "
+                      << it->second.bytes << " bytes (" << it->second.huge_page_bytes << " on huge pages), peak "
+                      << it->second.peak_bytes << " bytes";
+        }
+}
@@ -0,0 +1,129 @@
+/*!
+ * \file buffer_allocator.h
+ * \brief Aligned allocation of the large signal processing buffers, with huge
+ * pages, NUMA placement and usage accounting per subsystem
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_BUFFER_ALLOCATOR_H_
+#define GNSS_SDR_BUFFER_ALLOCATOR_H_
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+/*!
+ * \brief Allocator of the buffers that the signal processing reads at
+ * every sample: the acquisition grids, the tracking replicas and the
+ * sample histories.
+ *
+ * Such buffers take many megabytes per receiver, and with 4 KB pages they
+ * miss the TLB all the time. A buffer can be placed on 2 MB pages, either
+ * transparent huge pages (madvise) or explicit ones from the hugetlbfs
+ * pool, which fall back to transparent ones if the pool is empty. On a
+ * multi-socket machine it can also be placed on the memory of a NUMA
+ * node, preferably, that of the cores that run the receiver.
+ *
+ * Buffers without any hint, and those smaller than a page, come from
+ * posix_memalign like the VOLK ones. All of them are aligned to
+ * Buffer_Allocator::alignment bytes, enough for any VOLK kernel, and the
+ * bytes in use by each subsystem are accounted. All the functions are
+ * thread-safe.
+ *
+ * In a build with ENABLE_STATIC_LIMITS=ON (see Static_Limits) the memory
+ * never grows: every buffer is a block of an arena of GNSS_SDR_ARENA_MB,
+ * mapped with the receiver-wide hints and locked once at startup.
+ * Released blocks are kept in a free list and reused by later buffers
+ * that fit in them, and allocate() returns 0 once the arena is full.
+ */
+class Buffer_Allocator
+{
+public:
+    enum Page_Mode
+    {
+        Default_Pages,          //!< The pages of malloc
+        Transparent_Huge_Pages, //!< 2 MB pages if the kernel can find them, madvise(MADV_HUGEPAGE)
+        Explicit_Huge_Pages     //!< 2 MB pages of the hugetlbfs pool, MAP_HUGETLB
+    };
+
+    struct Hints
+    {
+        Page_Mode pages;
+        int numa_node; //!< Preferred node, -1 for the default policy
+        Hints(Page_Mode pages_ = Default_Pages, int numa_node_ = -1) : pages(pages_), numa_node(numa_node_) {}
+    };
+
+    struct Usage
+    {
+        size_t bytes;           //!< Bytes in use, as requested
+        size_t peak_bytes;      //!< Largest bytes in use
+        size_t huge_page_bytes; //!< Bytes in use on huge pages, as mapped
+        unsigned int buffers;   //!< Buffers in use
+        Usage() : bytes(0), peak_bytes(0), huge_page_bytes(0), buffers(0) {}
+    };
+
+    static const size_t alignment = 64;
+
+    /*!
+     * \brief Allocates size bytes for subsystem (e.g. "acquisition") with
+     * the receiver-wide hints. Returns 0 if there is no memory.
+     */
+    static void* allocate(size_t size, const char* subsystem);
+
+    static void* allocate(size_t size, const char* subsystem, const Hints& hints);
+
+    /*!
+     * \brief Frees a buffer from allocate(). A null pointer is ignored.
+     */
+    static void release(void* buffer);
+
+    /*!
+     * \brief Reserves the arena of a build with ENABLE_STATIC_LIMITS=ON,
+     * false if there is no memory for it. Does nothing in the other builds.
+     */
+    static bool reserve();
+
+    /*!
+     * \brief Sets the hints of allocate(size, subsystem) (GNSS-SDR.huge_pages
+     * and GNSS-SDR.numa_node, see GNSSFlowgraph)
+     */
+    static void set_default_hints(const Hints& hints);
+
+    static Hints default_hints();
+
+    /*!
+     * \brief Page mode named "off", "transparent" or "explicit", Default_Pages for any other name
+     */
+    static Page_Mode page_mode(const std::string& name);
+
+    static std::map<std::string, Usage> usage(); //!< Usage of every subsystem that allocated a buffer
+
+    static void log_usage(); //!< Logs usage() at the INFO level
+};
+
+#endif
@@ -32,6 +32,7 @@
 #include "byte_x2_to_complex_byte.h"
 #include <gnuradio/io_signature.h>
 #include <volk/volk.h>
+#include "volk_gnsssdr/volk_gnsssdr.h"
 
 
 byte_x2_to_complex_byte_sptr make_byte_x2_to_complex_byte()
@@ -57,15 +58,6 @@ int byte_x2_to_complex_byte::work(int noutput_items,
     const int8_t *in0 = (const int8_t *) input_items[0];
     const int8_t *in1 = (const int8_t *) input_items[1];
     lv_8sc_t *out = (lv_8sc_t *) output_items[0];
-    // This could be put into a volk kernel
-    int8_t real_part;
-    int8_t imag_part;
-    for(int number = 0; number < noutput_items; number++)
-        {
-            // lv_cmake(r, i) defined at volk/volk_complex.h
-            real_part = *in0++;
-            imag_part = *in1++;
-            *out++ = lv_cmake(real_part, imag_part);
-        }
+    volk_gnsssdr_8i_x2_interleave_8ic(out, (const char*) in0, (const char*) in1, noutput_items);
     return noutput_items;
 }
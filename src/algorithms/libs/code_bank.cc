@@ -0,0 +1,315 @@
+/*!
+ * \file code_bank.cc
+ * \brief Process-wide cache of the local code replicas of the GNSS signals
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "code_bank.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+#include <boost/thread/mutex.hpp>
+#include "GPS_L1_CA.h"
+#include "GPS_L2C.h"
+#include "Galileo_E1.h"
+#include "Galileo_E5a.h"
+#include "gps_sdr_signal_processing.h"
+#include "gps_l2c_signal.h"
+#include "galileo_e1_signal_processing.h"
+#include "galileo_e5_signal_processing.h"
+
+namespace
+{
+enum Code_Kind { GPS_L1_CA, GPS_L2C_M, GALILEO_E1, GALILEO_E5_A };
+
+struct Replica_Key
+{
+    Code_Kind kind;
+    std::string signal;
+    bool cboc;
+    unsigned int PRN;
+    signed int fs;
+    unsigned int chip_shift;
+    bool secondary_flag;
+
+    bool operator<(const Replica_Key& other) const
+    {
+        if (kind != other.kind) return kind < other.kind;
+        if (signal != other.signal) return signal < other.signal;
+        if (cboc != other.cboc) return cboc < other.cboc;
+        if (PRN != other.PRN) return PRN < other.PRN;
+        if (fs != other.fs) return fs < other.fs;
+        if (chip_shift != other.chip_shift) return chip_shift < other.chip_shift;
+        return secondary_flag < other.secondary_flag;
+    }
+};
+
+struct Bank_Entry
+{
+    Code_Bank::Replica replica;
+    unsigned long int last_use;
+};
+
+boost::mutex bank_mutex;
+std::map<Replica_Key, Bank_Entry> bank;
+unsigned long int bank_bytes = 0;
+unsigned long int bank_max_bytes = 64 * 1024 * 1024;
+unsigned long int bank_uses = 0;
+unsigned long int bank_hits = 0;
+unsigned long int bank_misses = 0;
+
+
+unsigned long int replica_bytes(const Code_Bank::Replica& replica)
+{
+    return replica->size() * sizeof(std::complex<float>);
+}
+
+
+// drops the least recently used replicas until the bank fits in bank_max_bytes
+void trim()
+{
+    while (bank_bytes > bank_max_bytes and !bank.empty())
+        {
+            std::map<Replica_Key, Bank_Entry>::iterator oldest = bank.begin();
+            for (std::map<Replica_Key, Bank_Entry>::iterator it = bank.begin(); it != bank.end(); ++it)
+                {
+                    if (it->second.last_use < oldest->second.last_use) oldest = it;
+                }
+            bank_bytes -= replica_bytes(oldest->second.replica);
+            bank.erase(oldest);
+        }
+}
+
+
+// the generators take a writable char[3], Gnss_Synchro::Signal is not always null terminated
+std::string signal_of(const char* signal)
+{
+    return std::string(signal, std::find(signal, signal + 2, '\0'));
+}
+
+
+std::vector<std::complex<float> >* generate(const Replica_Key& key)
+{
+    char signal[3] = {'\0', '\0', '\0'};
+    key.signal.copy(signal, 2);
+    std::vector<std::complex<float> >* samples = 0;
+    switch (key.kind)
+    {
+    case GPS_L1_CA:
+        if (key.fs == 0)
+            {
+                samples = new std::vector<std::complex<float> >(static_cast<unsigned int>(GPS_L1_CA_CODE_LENGTH_CHIPS));
+                gps_l1_ca_code_gen_complex(samples->data(), key.PRN, key.chip_shift);
+            }
+        else
+            {
+                // as in gps_l1_ca_code_gen_complex_sampled
+                samples = new std::vector<std::complex<float> >(static_cast<signed int>(static_cast<double>(key.fs) / static_cast<double>(1023000 / 1023)));
+                gps_l1_ca_code_gen_complex_sampled(samples->data(), key.PRN, key.fs, key.chip_shift);
+            }
+        break;
+    case GPS_L2C_M:
+        if (key.fs == 0)
+            {
+                samples = new std::vector<std::complex<float> >(GPS_L2_M_CODE_LENGTH_CHIPS);
+                gps_l2c_m_code_gen_complex(samples->data(), key.PRN);
+            }
+        else
+            {
+                samples = new std::vector<std::complex<float> >(static_cast<int>(static_cast<double>(key.fs) / (static_cast<double>(GPS_L2_M_CODE_RATE_HZ) / static_cast<double>(GPS_L2_M_CODE_LENGTH_CHIPS))));
+                gps_l2c_m_code_gen_complex_sampled(samples->data(), key.PRN, key.fs);
+            }
+        break;
+    case GALILEO_E1:
+        {
+            unsigned int samples_per_code = static_cast<unsigned int>(static_cast<double>(key.fs) / (static_cast<double>(static_cast<int>(Galileo_E1_CODE_CHIP_RATE_HZ)) / static_cast<double>(Galileo_E1_B_CODE_LENGTH_CHIPS)));
+            if (key.secondary_flag and key.signal.rfind("1C") != std::string::npos)
+                {
+                    samples_per_code *= static_cast<unsigned int>(Galileo_E1_C_SECONDARY_CODE_LENGTH);
+                }
+            samples = new std::vector<std::complex<float> >(samples_per_code);
+            galileo_e1_code_gen_complex_sampled(samples->data(), signal, key.cboc, key.PRN, key.fs, key.chip_shift, key.secondary_flag);
+        }
+        break;
+    case GALILEO_E5_A:
+        samples = new std::vector<std::complex<float> >(static_cast<unsigned int>(static_cast<double>(key.fs) / (static_cast<double>(static_cast<int>(Galileo_E5a_CODE_CHIP_RATE_HZ)) / static_cast<double>(Galileo_E5a_CODE_LENGTH_CHIPS))));
+        galileo_e5_a_code_gen_complex_sampled(samples->data(), signal, key.PRN, key.fs, key.chip_shift);
+        break;
+    }
+    return samples;
+}
+
+
+Code_Bank::Replica lookup(const Replica_Key& key)
+{
+    {
+        boost::mutex::scoped_lock lock(bank_mutex);
+        std::map<Replica_Key, Bank_Entry>::iterator it = bank.find(key);
+        if (it != bank.end())
+            {
+                it->second.last_use = ++bank_uses;
+                bank_hits++;
+                return it->second.replica;
+            }
+    }
+
+    // the replica is built outside the lock, the other channels keep reading the bank
+    Code_Bank::Replica replica(generate(key));
+
+    boost::mutex::scoped_lock lock(bank_mutex);
+    bank_misses++;
+    std::map<Replica_Key, Bank_Entry>::iterator it = bank.find(key);
+    if (it != bank.end())
+        {
+            // another channel built it in the meantime
+            it->second.last_use = ++bank_uses;
+            return it->second.replica;
+        }
+    Bank_Entry entry = {replica, ++bank_uses};
+    bank[key] = entry;
+    bank_bytes += replica_bytes(replica);
+    trim();
+    return replica;
+}
+
+
+void copy(const Code_Bank::Replica& replica, std::complex<float>* dest)
+{
+    std::memcpy(dest, replica->data(), replica_bytes(replica));
+}
+}
+
+
+Code_Bank::Replica Code_Bank::gps_l1_ca(unsigned int PRN, signed int fs, unsigned int chip_shift)
+{
+    Replica_Key key = {GPS_L1_CA, std::string(), false, PRN, fs, chip_shift, false};
+    return lookup(key);
+}
+
+
+Code_Bank::Replica Code_Bank::gps_l2c_m(unsigned int PRN, signed int fs)
+{
+    Replica_Key key = {GPS_L2C_M, std::string(), false, PRN, fs, 0, false};
+    return lookup(key);
+}
+
+
+Code_Bank::Replica Code_Bank::galileo_e1(const char* signal, bool cboc, unsigned int PRN, signed int fs, unsigned int chip_shift, bool secondary_flag)
+{
+    Replica_Key key = {GALILEO_E1, signal_of(signal), cboc, PRN, fs, chip_shift, secondary_flag};
+    return lookup(key);
+}
+
+
+Code_Bank::Replica Code_Bank::galileo_e5_a(const char* signal, unsigned int PRN, signed int fs, unsigned int chip_shift)
+{
+    Replica_Key key = {GALILEO_E5_A, signal_of(signal), false, PRN, fs, chip_shift, false};
+    return lookup(key);
+}
+
+
+void Code_Bank::gps_l1_ca_code_gen_complex(std::complex<float>* _dest, signed int _prn, unsigned int _chip_shift)
+{
+    copy(gps_l1_ca(_prn, 0, _chip_shift), _dest);
+}
+
+
+void Code_Bank::gps_l1_ca_code_gen_complex_sampled(std::complex<float>* _dest, unsigned int _prn, signed int _fs, unsigned int _chip_shift)
+{
+    copy(gps_l1_ca(_prn, _fs, _chip_shift), _dest);
+}
+
+
+void Code_Bank::gps_l2c_m_code_gen_complex(std::complex<float>* _dest, unsigned int _prn)
+{
+    copy(gps_l2c_m(_prn, 0), _dest);
+}
+
+
+void Code_Bank::gps_l2c_m_code_gen_complex_sampled(std::complex<float>* _dest, unsigned int _prn, signed int _fs)
+{
+    copy(gps_l2c_m(_prn, _fs), _dest);
+}
+
+
+void Code_Bank::galileo_e1_code_gen_complex_sampled(std::complex<float>* _dest, const char* _Signal,
+        bool _cboc, unsigned int _prn, signed int _fs, unsigned int _chip_shift, bool _secondary_flag)
+{
+    copy(galileo_e1(_Signal, _cboc, _prn, _fs, _chip_shift, _secondary_flag), _dest);
+}
+
+
+void Code_Bank::galileo_e5_a_code_gen_complex_sampled(std::complex<float>* _dest, const char* _Signal,
+        unsigned int _prn, signed int _fs, unsigned int _chip_shift)
+{
+    copy(galileo_e5_a(_Signal, _prn, _fs, _chip_shift), _dest);
+}
+
+
+void Code_Bank::set_max_bytes(unsigned long int max_bytes)
+{
+    boost::mutex::scoped_lock lock(bank_mutex);
+    bank_max_bytes = max_bytes;
+    trim();
+}
+
+
+unsigned long int Code_Bank::max_bytes()
+{
+    boost::mutex::scoped_lock lock(bank_mutex);
+    return bank_max_bytes;
+}
+
+
+unsigned long int Code_Bank::bytes()
+{
+    boost::mutex::scoped_lock lock(bank_mutex);
+    return bank_bytes;
+}
+
+
+void Code_Bank::clear()
+{
+    boost::mutex::scoped_lock lock(bank_mutex);
+    bank.clear();
+    bank_bytes = 0;
+}
+
+
+unsigned long int Code_Bank::hits()
+{
+    boost::mutex::scoped_lock lock(bank_mutex);
+    return bank_hits;
+}
+
+
+unsigned long int Code_Bank::misses()
+{
+    boost::mutex::scoped_lock lock(bank_mutex);
+    return bank_misses;
+}
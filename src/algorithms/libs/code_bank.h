@@ -0,0 +1,86 @@
+/*!
+ * \file code_bank.h
+ * \brief Process-wide cache of the local code replicas of the GNSS signals
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_CODE_BANK_H_
+#define GNSS_SDR_CODE_BANK_H_
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+/*!
+ * \brief Read-only local code replicas, shared by all the channels.
+ *
+ * The acquisition and tracking blocks generate the replica of their code
+ * each time a channel is assigned a satellite, and the Galileo E1 CBOC
+ * replica alone is built at 12 samples per chip before it is resampled.
+ * The bank builds each replica once per process, with the generators of
+ * gps_sdr_signal_processing.h, gps_l2c_signal.h,
+ * galileo_e1_signal_processing.h and galileo_e5_signal_processing.h,
+ * keyed by all their arguments (signal, BOC modulation, PRN, sampling
+ * frequency, chip shift and secondary code), and hands out the same
+ * samples to every channel that asks for them again.
+ *
+ * The functions named after a generator take the same arguments and copy
+ * the replica into _dest, so they are drop-in replacements. The bank keeps
+ * max_bytes() of replicas, and drops the least recently used ones beyond
+ * that; the replicas handed out stay valid as long as they are held. All
+ * the functions are thread-safe.
+ */
+class Code_Bank
+{
+public:
+    typedef std::shared_ptr<const std::vector<std::complex<float> > > Replica;
+
+    static Replica gps_l1_ca(unsigned int PRN, signed int fs, unsigned int chip_shift); //!< fs = 0 for one sample per chip
+    static Replica gps_l2c_m(unsigned int PRN, signed int fs); //!< fs = 0 for one sample per chip
+    static Replica galileo_e1(const char* signal, bool cboc, unsigned int PRN, signed int fs, unsigned int chip_shift, bool secondary_flag);
+    static Replica galileo_e5_a(const char* signal, unsigned int PRN, signed int fs, unsigned int chip_shift);
+
+    static void gps_l1_ca_code_gen_complex(std::complex<float>* _dest, signed int _prn, unsigned int _chip_shift);
+    static void gps_l1_ca_code_gen_complex_sampled(std::complex<float>* _dest, unsigned int _prn, signed int _fs, unsigned int _chip_shift);
+    static void gps_l2c_m_code_gen_complex(std::complex<float>* _dest, unsigned int _prn);
+    static void gps_l2c_m_code_gen_complex_sampled(std::complex<float>* _dest, unsigned int _prn, signed int _fs);
+    static void galileo_e1_code_gen_complex_sampled(std::complex<float>* _dest, const char* _Signal,
+            bool _cboc, unsigned int _prn, signed int _fs, unsigned int _chip_shift, bool _secondary_flag = false);
+    static void galileo_e5_a_code_gen_complex_sampled(std::complex<float>* _dest, const char* _Signal,
+            unsigned int _prn, signed int _fs, unsigned int _chip_shift);
+
+    static void set_max_bytes(unsigned long int max_bytes);
+    static unsigned long int max_bytes();
+    static unsigned long int bytes(); //!< Of the replicas in the bank
+    static void clear();
+
+    //! Lookups served from the bank, and replicas built
+    static unsigned long int hits();
+    static unsigned long int misses();
+};
+
+#endif
@@ -0,0 +1,117 @@
+/*!
+ * \file dump_reader.cc
+ * \brief Maps a binary dump file written by a Dump_Writer in memory
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "dump_reader.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdint>
+
+Dump_Reader::Dump_Reader() :
+        d_map(0),
+        d_map_bytes(0),
+        d_records(0),
+        d_num_records(0)
+{}
+
+
+Dump_Reader::~Dump_Reader()
+{
+    close();
+}
+
+
+bool Dump_Reader::open(const std::string& filename)
+{
+    close();
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        {
+            return false;
+        }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size == 0)
+        {
+            ::close(fd);
+            return false;
+        }
+    void* map = mmap(0, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+        {
+            return false;
+        }
+    d_map = static_cast<char*>(map);
+    d_map_bytes = status.st_size;
+
+    size_t header_bytes = 0;
+    if (!Dump_Schema::parse(d_map, d_map_bytes, d_schema, header_bytes) || d_schema.record_bytes() == 0)
+        {
+            close();
+            return false;
+        }
+    d_records = d_map + header_bytes;
+    d_num_records = (d_map_bytes - header_bytes) / d_schema.record_bytes();
+    return true;
+}
+
+
+void Dump_Reader::close()
+{
+    if (d_map != 0)
+        {
+            munmap(d_map, d_map_bytes);
+        }
+    d_map = 0;
+    d_map_bytes = 0;
+    d_records = 0;
+    d_num_records = 0;
+    d_schema = Dump_Schema();
+}
+
+
+double Dump_Reader::value(unsigned long long n, unsigned int field, unsigned int element) const
+{
+    switch (d_schema.fields()[field].type)
+    {
+    case DUMP_INT8: return get<int8_t>(n, field, element);
+    case DUMP_UINT8: return get<uint8_t>(n, field, element);
+    case DUMP_INT16: return get<int16_t>(n, field, element);
+    case DUMP_UINT16: return get<uint16_t>(n, field, element);
+    case DUMP_INT32: return get<int32_t>(n, field, element);
+    case DUMP_UINT32: return get<uint32_t>(n, field, element);
+    case DUMP_INT64: return static_cast<double>(get<int64_t>(n, field, element));
+    case DUMP_UINT64: return static_cast<double>(get<uint64_t>(n, field, element));
+    case DUMP_FLOAT32: return get<float>(n, field, element);
+    case DUMP_FLOAT64: return get<double>(n, field, element);
+    }
+    return 0.0;
+}
@@ -0,0 +1,91 @@
+/*!
+ * \file dump_reader.h
+ * \brief Maps a binary dump file written by a Dump_Writer in memory
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_DUMP_READER_H_
+#define GNSS_SDR_DUMP_READER_H_
+
+#include <cstring>
+#include <string>
+#include "dump_schema.h"
+
+/*!
+ * \brief Read-only mapping of a dump file: its schema and its records,
+ * which are not copied. The last record of a file that was not closed may
+ * be incomplete, and is left out.
+ */
+class Dump_Reader
+{
+public:
+    Dump_Reader();
+    ~Dump_Reader();
+
+    /*!
+     * \return false if the file cannot be mapped or has no valid dump header
+     */
+    bool open(const std::string& filename);
+    void close();
+
+    bool is_open() const { return d_map != 0; }
+    const Dump_Schema& schema() const { return d_schema; }
+    unsigned long long num_records() const { return d_num_records; }
+
+    const char* record(unsigned long long n) const
+    {
+        return d_records + n * d_schema.record_bytes();
+    }
+
+    /*!
+     * \brief Value element of field in record n, which must be of type T
+     */
+    template<typename T>
+    T get(unsigned long long n, unsigned int field, unsigned int element = 0) const
+    {
+        T value;
+        std::memcpy(&value, record(n) + d_schema.fields()[field].offset + element * sizeof(T), sizeof(T));
+        return value;
+    }
+
+    /*!
+     * \brief Value element of field in record n, whatever its type
+     */
+    double value(unsigned long long n, unsigned int field, unsigned int element = 0) const;
+
+private:
+    Dump_Reader(const Dump_Reader&);
+    Dump_Reader& operator=(const Dump_Reader&);
+
+    Dump_Schema d_schema;
+    char* d_map;
+    size_t d_map_bytes;
+    const char* d_records;
+    unsigned long long d_num_records;
+};
+
+#endif
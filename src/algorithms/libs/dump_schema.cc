@@ -0,0 +1,202 @@
+/*!
+ * \file dump_schema.cc
+ * \brief Layout of the records of the binary dump files, stored in the
+ * header of each file
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "dump_schema.h"
+#include <cstring>
+#include <sstream>
+
+#define DUMP_MAGIC "GNSS-SDR dump"
+#define DUMP_VERSION 1
+
+namespace
+{
+const char* type_names[] = {"int8", "uint8", "int16", "uint16", "int32", "uint32", "int64", "uint64", "float32", "float64"};
+const size_t type_bytes[] = {1, 1, 2, 2, 4, 4, 8, 8, 4, 8};
+const unsigned int num_types = sizeof(type_names) / sizeof(type_names[0]);
+
+const char* host_byte_order()
+{
+    const unsigned short one = 1;
+    return *reinterpret_cast<const unsigned char*>(&one) == 1 ? "little" : "big";
+}
+}
+
+
+const char* dump_field_type_name(Dump_Field_Type type)
+{
+    return type_names[type];
+}
+
+
+size_t dump_field_type_bytes(Dump_Field_Type type)
+{
+    return type_bytes[type];
+}
+
+
+Dump_Schema::Dump_Schema(const std::string& name) :
+        d_name(name),
+        d_record_bytes(0)
+{}
+
+
+Dump_Schema& Dump_Schema::add(const std::string& field, Dump_Field_Type type, unsigned int count)
+{
+    Dump_Field f;
+    f.name = field;
+    f.type = type;
+    f.count = count;
+    f.offset = d_record_bytes;
+    d_fields.push_back(f);
+    d_record_bytes += count * dump_field_type_bytes(type);
+    return *this;
+}
+
+
+int Dump_Schema::find(const std::string& field) const
+{
+    for (unsigned int i = 0; i < d_fields.size(); i++)
+        {
+            if (d_fields[i].name == field)
+                {
+                    return i;
+                }
+        }
+    return -1;
+}
+
+
+std::string Dump_Schema::header() const
+{
+    std::ostringstream body;
+    body << "byte_order " << host_byte_order() << "\n";
+    body << "name " << d_name << "\n";
+    body << "record_bytes " << d_record_bytes << "\n";
+    for (unsigned int i = 0; i < d_fields.size(); i++)
+        {
+            const Dump_Field& f = d_fields[i];
+            body << "field " << f.name << " " << dump_field_type_name(f.type) << " " << f.count << " " << f.offset << "\n";
+        }
+    body << "end\n";
+
+    // room for the first two lines, whatever the digits of header_bytes
+    size_t text_bytes = body.str().size() + 64;
+    size_t header_bytes = (text_bytes + DUMP_HEADER_ALIGNMENT - 1) / DUMP_HEADER_ALIGNMENT * DUMP_HEADER_ALIGNMENT;
+    std::ostringstream header;
+    header << DUMP_MAGIC << " " << DUMP_VERSION << "\n";
+    header << "header_bytes " << header_bytes << "\n";
+    header << body.str();
+    std::string text = header.str();
+    text.resize(header_bytes, '\0');
+    return text;
+}
+
+
+bool Dump_Schema::parse(const char* header, size_t bytes, Dump_Schema& schema, size_t& header_bytes)
+{
+    size_t magic_bytes = std::strlen(DUMP_MAGIC);
+    if (bytes < magic_bytes || std::memcmp(header, DUMP_MAGIC, magic_bytes) != 0)
+        {
+            return false;
+        }
+    // the text ends at the first zero of the padding
+    std::istringstream text(std::string(header, strnlen(header, bytes)));
+    std::string line;
+    std::getline(text, line);
+    int version = 0;
+    if (!(std::istringstream(line.substr(magic_bytes)) >> version) || version != DUMP_VERSION)
+        {
+            return false;
+        }
+
+    Dump_Schema result;
+    size_t record_bytes = 0;
+    header_bytes = 0;
+    bool ended = false;
+    while (!ended && std::getline(text, line))
+        {
+            std::istringstream words(line);
+            std::string key;
+            words >> key;
+            if (key == "header_bytes")
+                {
+                    words >> header_bytes;
+                }
+            else if (key == "byte_order")
+                {
+                    std::string order;
+                    words >> order;
+                    if (order != host_byte_order())
+                        {
+                            return false;
+                        }
+                }
+            else if (key == "name")
+                {
+                    words >> result.d_name;
+                }
+            else if (key == "record_bytes")
+                {
+                    words >> record_bytes;
+                }
+            else if (key == "field")
+                {
+                    std::string name;
+                    std::string type_name;
+                    unsigned int count = 0;
+                    size_t offset = 0;
+                    if (!(words >> name >> type_name >> count >> offset))
+                        {
+                            return false;
+                        }
+                    unsigned int type = 0;
+                    while (type < num_types && type_name != type_names[type])
+                        {
+                            type++;
+                        }
+                    if (type == num_types || offset != result.d_record_bytes)
+                        {
+                            return false;
+                        }
+                    result.add(name, static_cast<Dump_Field_Type>(type), count);
+                }
+            else if (key == "end")
+                {
+                    ended = true;
+                }
+        }
+    if (!ended || header_bytes == 0 || header_bytes > bytes || record_bytes != result.d_record_bytes)
+        {
+            return false;
+        }
+    schema = result;
+    return true;
+}
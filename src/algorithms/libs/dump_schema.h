@@ -0,0 +1,147 @@
+/*!
+ * \file dump_schema.h
+ * \brief Layout of the records of the binary dump files, stored in the
+ * header of each file
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_DUMP_SCHEMA_H_
+#define GNSS_SDR_DUMP_SCHEMA_H_
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// The records start at a multiple of this offset, for O_DIRECT and mmap
+#define DUMP_HEADER_ALIGNMENT 4096
+
+enum Dump_Field_Type
+{
+    DUMP_INT8 = 0,
+    DUMP_UINT8,
+    DUMP_INT16,
+    DUMP_UINT16,
+    DUMP_INT32,
+    DUMP_UINT32,
+    DUMP_INT64,
+    DUMP_UINT64,
+    DUMP_FLOAT32,
+    DUMP_FLOAT64
+};
+
+/*!
+ * \brief Name of a type in the header, as the precision of the MATLAB fread
+ */
+const char* dump_field_type_name(Dump_Field_Type type);
+
+size_t dump_field_type_bytes(Dump_Field_Type type);
+
+/*!
+ * \brief Field type of a C++ arithmetic type, e.g. DUMP_UINT64 for unsigned long on LP64
+ */
+template<typename T>
+constexpr Dump_Field_Type dump_field_type_of()
+{
+    static_assert(std::is_arithmetic<T>::value && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8),
+            "only integers and floating point values of 1 to 8 bytes can be dumped");
+    return std::is_floating_point<T>::value ? (sizeof(T) == 4 ? DUMP_FLOAT32 : DUMP_FLOAT64)
+            : std::is_signed<T>::value ? (sizeof(T) == 1 ? DUMP_INT8 : sizeof(T) == 2 ? DUMP_INT16 : sizeof(T) == 4 ? DUMP_INT32 : DUMP_INT64)
+            : (sizeof(T) == 1 ? DUMP_UINT8 : sizeof(T) == 2 ? DUMP_UINT16 : sizeof(T) == 4 ? DUMP_UINT32 : DUMP_UINT64);
+}
+
+
+struct Dump_Field
+{
+    std::string name;
+    Dump_Field_Type type;
+    unsigned int count;  //!< Values of the field in each record, e.g. one per channel
+    size_t offset;       //!< In the record [bytes]
+};
+
+
+/*!
+ * \brief Names, types and offsets of the fields of the records of a dump
+ * file, in the order they are stored. There is no padding between fields.
+ *
+ * The header of a file is plain text, so that `head -c 4096 file` shows
+ * it, padded with zeros to a multiple of DUMP_HEADER_ALIGNMENT bytes:
+ *
+ *     GNSS-SDR dump 1
+ *     header_bytes 4096
+ *     byte_order little
+ *     name gps_l1_ca_telemetry
+ *     record_bytes 24
+ *     field symbol_TOW_s float64 1 0
+ *     field tracking_timestamp_s float64 1 8
+ *     field decoder_TOW_s float64 1 16
+ *     end
+ *
+ * Each field line holds the name, type, count and offset of a field.
+ */
+class Dump_Schema
+{
+public:
+    explicit Dump_Schema(const std::string& name = "");
+
+    Dump_Schema& add(const std::string& field, Dump_Field_Type type, unsigned int count = 1);
+
+    template<typename T>
+    Dump_Schema& add(const std::string& field, unsigned int count = 1)
+    {
+        return add(field, dump_field_type_of<T>(), count);
+    }
+
+    const std::string& name() const { return d_name; }
+    const std::vector<Dump_Field>& fields() const { return d_fields; }
+    size_t record_bytes() const { return d_record_bytes; }
+
+    /*!
+     * \brief Index of the field called name, -1 if none
+     */
+    int find(const std::string& field) const;
+
+    /*!
+     * \brief Header of a file with these records, padded to its header_bytes
+     */
+    std::string header() const;
+
+    /*!
+     * \brief Reads the schema from the start of a file
+     * \param bytes - Bytes available at header, at least DUMP_HEADER_ALIGNMENT or the whole file
+     * \param header_bytes - Offset of the first record
+     * \return false if header is not a valid dump header, or is longer than bytes
+     */
+    static bool parse(const char* header, size_t bytes, Dump_Schema& schema, size_t& header_bytes);
+
+private:
+    std::string d_name;
+    std::vector<Dump_Field> d_fields;
+    size_t d_record_bytes;
+};
+
+#endif
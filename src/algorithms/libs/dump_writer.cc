@@ -0,0 +1,377 @@
+/*!
+ * \file dump_writer.cc
+ * \brief Writes the binary dump files of the blocks from one thread of
+ * the receiver, in large sequential writes
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "dump_writer.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <set>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+// Period of the dump thread, and longest time the records of a writer wait for the disk
+#define DUMP_SERVICE_PERIOD_MS 100
+#define DUMP_WRITER_FLUSH_PERIOD_MS 1000
+
+namespace
+{
+std::atomic<bool> dump_direct_io(false);
+}
+
+
+void set_dump_direct_io(bool enabled)
+{
+    dump_direct_io.store(enabled);
+}
+
+
+/*!
+ * \brief Thread that moves the rings of the open Dump_Writers to their files
+ */
+class Dump_Service
+{
+public:
+    static Dump_Service& instance()
+    {
+        static Dump_Service service;
+        return service;
+    }
+
+    void add(Dump_Writer* writer)
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_writers.insert(writer);
+    }
+
+    /*!
+     * \brief Once it returns, the thread no longer touches writer
+     */
+    void remove(Dump_Writer* writer)
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_writers.erase(writer);
+    }
+
+    void wake()
+    {
+        d_condition.notify_all();
+    }
+
+private:
+    Dump_Service() : d_stop(false)
+    {
+        d_thread = boost::thread(&Dump_Service::run, this);
+    }
+
+    ~Dump_Service()
+    {
+        {
+            boost::mutex::scoped_lock lock(d_mutex);
+            d_stop = true;
+        }
+        d_condition.notify_all();
+        d_thread.join();
+    }
+
+    void run()
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        while (!d_stop)
+            {
+                for (std::set<Dump_Writer*>::iterator it = d_writers.begin(); it != d_writers.end(); ++it)
+                    {
+                        (*it)->drain(false);
+                    }
+                d_condition.wait_for(lock, boost::chrono::milliseconds(DUMP_SERVICE_PERIOD_MS));
+            }
+        // writers still open at exit
+        for (std::set<Dump_Writer*>::iterator it = d_writers.begin(); it != d_writers.end(); ++it)
+            {
+                (*it)->drain(true);
+            }
+    }
+
+    std::set<Dump_Writer*> d_writers;
+    bool d_stop;
+    boost::mutex d_mutex;
+    boost::condition_variable d_condition;
+    boost::thread d_thread;
+};
+
+
+Dump_Writer::Dump_Writer(size_t buffer_bytes) :
+        d_buffer_bytes(std::max(buffer_bytes, static_cast<size_t>(DUMP_HEADER_ALIGNMENT))),
+        d_fd(-1),
+        d_direct(false),
+        d_failed(false),
+        d_records(0),
+        d_value(0),
+        d_record_dropped(false),
+        d_mismatch_logged(false),
+        d_head(0),
+        d_tail(0),
+        d_wake_pending(false),
+        d_staging(0),
+        d_staging_bytes(0),
+        d_staged(0)
+{}
+
+
+Dump_Writer::~Dump_Writer()
+{
+    close();
+}
+
+
+bool Dump_Writer::open(const std::string& filename, const Dump_Schema& schema)
+{
+    close();
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+    d_direct = false;
+#ifdef O_DIRECT
+    if (dump_direct_io.load())
+        {
+            d_fd = ::open(filename.c_str(), flags | O_DIRECT, 0644);
+            if (d_fd >= 0)
+                {
+                    d_direct = true;
+                }
+            else
+                {
+                    LOG(INFO) << "Dump file " << filename << " without O_DIRECT: " << std::strerror(errno);
+                }
+        }
+#endif
+    if (d_fd < 0)
+        {
+            d_fd = ::open(filename.c_str(), flags, 0644);
+        }
+    if (d_fd < 0)
+        {
+            LOG(WARNING) << "Cannot open dump file " << filename << ": " << std::strerror(errno);
+            return false;
+        }
+    d_filename = filename;
+    d_schema = schema;
+    d_failed = false;
+    d_records = 0;
+
+    d_record.assign(std::max(schema.record_bytes(), static_cast<size_t>(1)), 0);
+    d_value_types.clear();
+    d_value_offsets.clear();
+    for (unsigned int i = 0; i < schema.fields().size(); i++)
+        {
+            const Dump_Field& field = schema.fields()[i];
+            for (unsigned int n = 0; n < field.count; n++)
+                {
+                    d_value_types.push_back(field.type);
+                    d_value_offsets.push_back(field.offset + n * dump_field_type_bytes(field.type));
+                }
+        }
+    d_value = 0;
+    d_record_dropped = false;
+    d_mismatch_logged = false;
+
+    // the ring holds at least two records, the staging buffer the header
+    std::string header = schema.header();
+    d_ring.assign(std::max(d_buffer_bytes, 2 * schema.record_bytes()), 0);
+    d_head.store(0);
+    d_tail.store(0);
+    d_wake_pending.store(false);
+    d_staging_bytes = (std::max(d_buffer_bytes, header.size()) + DUMP_HEADER_ALIGNMENT - 1) / DUMP_HEADER_ALIGNMENT * DUMP_HEADER_ALIGNMENT;
+    d_staging_memory.assign(d_staging_bytes + DUMP_HEADER_ALIGNMENT, 0);
+    size_t misalignment = reinterpret_cast<size_t>(&d_staging_memory[0]) % DUMP_HEADER_ALIGNMENT;
+    d_staging = &d_staging_memory[0] + (misalignment == 0 ? 0 : DUMP_HEADER_ALIGNMENT - misalignment);
+    std::memcpy(d_staging, header.data(), header.size());
+    d_staged = header.size();
+    d_last_flush = boost::chrono::steady_clock::now();
+
+    Dump_Service::instance().add(this);
+    return true;
+}
+
+
+void Dump_Writer::close()
+{
+    if (d_fd < 0)
+        {
+            return;
+        }
+    Dump_Service::instance().remove(this);
+    drain(true);
+    ::close(d_fd);
+    d_fd = -1;
+    d_value_types.clear();
+    d_value_offsets.clear();
+    d_value = 0;
+}
+
+
+void Dump_Writer::write(const void* record)
+{
+    if (d_fd < 0)
+        {
+            return;
+        }
+    const size_t bytes = d_schema.record_bytes();
+    const size_t capacity = d_ring.size();
+    unsigned long long head = d_head.load(std::memory_order_relaxed);
+    if (head + bytes - d_tail.load(std::memory_order_acquire) > capacity)
+        {
+            wait_for_room(bytes);
+        }
+    size_t position = head % capacity;
+    size_t first = std::min(bytes, capacity - position);
+    std::memcpy(&d_ring[position], record, first);
+    std::memcpy(&d_ring[0], static_cast<const char*>(record) + first, bytes - first);
+    d_head.store(head + bytes, std::memory_order_release);
+    d_records++;
+    if (head + bytes - d_tail.load(std::memory_order_relaxed) > capacity / 2 && !d_wake_pending.exchange(true))
+        {
+            Dump_Service::instance().wake();
+        }
+}
+
+
+void Dump_Writer::type_mismatch(unsigned int value)
+{
+    d_record_dropped = true;
+    if (!d_mismatch_logged)
+        {
+            unsigned int field = 0;
+            while (field + 1 < d_schema.fields().size() && d_schema.fields()[field + 1].offset <= d_value_offsets[value])
+                {
+                    field++;
+                }
+            LOG(WARNING) << "Dump file " << d_filename << ": value of the wrong type for field "
+                         << d_schema.fields()[field].name << ", its records are dropped";
+            d_mismatch_logged = true;
+        }
+}
+
+
+void Dump_Writer::end_record()
+{
+    if (!d_record_dropped)
+        {
+            write(&d_record[0]);
+        }
+    d_record_dropped = false;
+    d_value = 0;
+}
+
+
+void Dump_Writer::wait_for_room(size_t bytes)
+{
+    const unsigned long long head = d_head.load(std::memory_order_relaxed);
+    while (head + bytes - d_tail.load(std::memory_order_acquire) > d_ring.size())
+        {
+            d_wake_pending.store(true);
+            Dump_Service::instance().wake();
+            boost::this_thread::sleep_for(boost::chrono::microseconds(200));
+        }
+}
+
+
+void Dump_Writer::drain(bool final)
+{
+    const size_t capacity = d_ring.size();
+    unsigned long long tail = d_tail.load(std::memory_order_relaxed);
+    const unsigned long long head = d_head.load(std::memory_order_acquire);
+    d_wake_pending.store(false);
+    while (tail < head)
+        {
+            size_t position = tail % capacity;
+            size_t bytes = std::min(static_cast<size_t>(head - tail), d_staging_bytes - d_staged);
+            size_t first = std::min(bytes, capacity - position);
+            std::memcpy(d_staging + d_staged, &d_ring[position], first);
+            std::memcpy(d_staging + d_staged + first, &d_ring[0], bytes - first);
+            d_staged += bytes;
+            tail += bytes;
+            d_tail.store(tail, std::memory_order_release);
+            if (d_staged == d_staging_bytes)
+                {
+                    flush_staging(false);
+                }
+        }
+    if (final || boost::chrono::steady_clock::now() - d_last_flush >= boost::chrono::milliseconds(DUMP_WRITER_FLUSH_PERIOD_MS))
+        {
+            flush_staging(final);
+        }
+}
+
+
+void Dump_Writer::flush_staging(bool final)
+{
+    d_last_flush = boost::chrono::steady_clock::now();
+    size_t bytes = d_staged;
+#ifdef O_DIRECT
+    if (d_direct)
+        {
+            if (final)
+                {
+                    // the tail of the file is not a whole block
+                    ::fcntl(d_fd, F_SETFL, ::fcntl(d_fd, F_GETFL) & ~O_DIRECT);
+                    d_direct = false;
+                }
+            else
+                {
+                    bytes -= bytes % DUMP_HEADER_ALIGNMENT;
+                }
+        }
+#endif
+    size_t written = 0;
+    while (!d_failed && written < bytes)
+        {
+            ssize_t n = ::write(d_fd, d_staging + written, bytes - written);
+            if (n < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+            if (n <= 0)
+                {
+                    // keep draining the ring, so the block never waits for a dead file
+                    LOG(WARNING) << "Exception writing dump file " << d_filename << " " << std::strerror(errno);
+                    d_failed = true;
+                }
+            else
+                {
+                    written += n;
+                }
+        }
+    std::memmove(d_staging, d_staging + bytes, d_staged - bytes);
+    d_staged -= bytes;
+}
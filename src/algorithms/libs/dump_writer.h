@@ -0,0 +1,169 @@
+/*!
+ * \file dump_writer.h
+ * \brief Writes the binary dump files of the blocks from one thread of
+ * the receiver, in large sequential writes
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_DUMP_WRITER_H_
+#define GNSS_SDR_DUMP_WRITER_H_
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <boost/chrono.hpp>
+#include "dump_schema.h"
+
+#define DUMP_WRITER_DEFAULT_BUFFER_BYTES (512 * 1024)
+
+/*!
+ * \brief Opens the dump files with O_DIRECT from now on, where the file
+ * system supports it, so that the dumps do not fill the page cache.
+ */
+void set_dump_direct_io(bool enabled);
+
+
+/*!
+ * \brief Dump file of a block: a header with the Dump_Schema of its
+ * records (see dump_schema.h), then the records.
+ *
+ * The block either writes whole records, laid out as the schema, or puts
+ * the values of each record one by one, in the order of the schema:
+ *
+ *     d_dump_writer.put(d_TOW_at_current_symbol);
+ *     d_dump_writer.put(d_tracking_timestamp_s);
+ *
+ * Either way the values are only buffered: they are copied into a ring
+ * buffer of the writer, with no lock and no system call, and the file is
+ * written by the dump writer thread. That one thread of the receiver moves
+ * the rings of all the open writers to the files, in writes of up to
+ * buffer_bytes.
+ * If the disk falls behind by a whole ring the block waits for it: the
+ * dump is never truncated. A value whose type is not that of the schema
+ * drops its record and is logged once.
+ *
+ * A writer is used by one thread at a time.
+ */
+class Dump_Writer
+{
+public:
+    explicit Dump_Writer(size_t buffer_bytes = DUMP_WRITER_DEFAULT_BUFFER_BYTES);
+    ~Dump_Writer();
+
+    /*!
+     * \brief Creates (or truncates) filename and writes the header of schema
+     * \return false if the file could not be opened.
+     */
+    bool open(const std::string& filename, const Dump_Schema& schema);
+
+    bool is_open() const { return d_fd >= 0; }
+    const Dump_Schema& schema() const { return d_schema; }
+    const std::string& filename() const { return d_filename; }
+
+    /*!
+     * \brief Records written since the file was opened
+     */
+    unsigned long long records() const { return d_records; }
+
+    /*!
+     * \brief Writes schema().record_bytes() bytes
+     */
+    void write(const void* record);
+
+    /*!
+     * \brief Writes the next value of the current record, and the record once it is complete
+     */
+    template<typename T>
+    void put(const T& value)
+    {
+        if (d_value == d_value_types.size())
+            {
+                return; // not open
+            }
+        if (d_value_types[d_value] == dump_field_type_of<T>())
+            {
+                std::memcpy(&d_record[d_value_offsets[d_value]], &value, sizeof(T));
+            }
+        else
+            {
+                type_mismatch(d_value);
+            }
+        if (++d_value == d_value_types.size())
+            {
+                end_record();
+            }
+    }
+
+    /*!
+     * \brief Writes the pending records and closes the file
+     */
+    void close();
+
+private:
+    friend class Dump_Service;
+
+    Dump_Writer(const Dump_Writer&);
+    Dump_Writer& operator=(const Dump_Writer&);
+
+    void type_mismatch(unsigned int value);
+    void end_record();
+    void wait_for_room(size_t bytes);
+    void drain(bool final);   // by the dump thread, and by close()
+    void flush_staging(bool final);
+
+    size_t d_buffer_bytes;
+    Dump_Schema d_schema;
+    std::string d_filename;
+    int d_fd;
+    bool d_direct;
+    bool d_failed;
+    unsigned long long d_records;
+
+    // record being put
+    std::vector<char> d_record;
+    std::vector<Dump_Field_Type> d_value_types;
+    std::vector<size_t> d_value_offsets;
+    unsigned int d_value;
+    bool d_record_dropped;
+    bool d_mismatch_logged;
+
+    // single producer, single consumer ring
+    std::vector<char> d_ring;
+    std::atomic<unsigned long long> d_head;   // bytes written by the block
+    std::atomic<unsigned long long> d_tail;   // bytes taken by the dump thread
+    std::atomic<bool> d_wake_pending;
+
+    // aligned buffer of the next write to the file
+    std::vector<char> d_staging_memory;
+    char* d_staging;
+    size_t d_staging_bytes;
+    size_t d_staged;
+    boost::chrono::steady_clock::time_point d_last_flush;
+};
+
+#endif
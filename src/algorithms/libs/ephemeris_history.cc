@@ -0,0 +1,308 @@
+/*!
+ * \file ephemeris_history.cc
+ * \brief Bounded history of the GPS ephemeris of every satellite, indexed by
+ * issue of data
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "ephemeris_history.h"
+#include <cstring>
+#include <string>
+#include "nav_data_fields.h"
+
+namespace
+{
+const std::vector<Nav_Field<Gps_Ephemeris> >& fields()
+{
+    return gps_ephemeris_fields();
+}
+
+unsigned int field_index(const std::string& name)
+{
+    unsigned int i = 0;
+    while (i < fields().size() && name != fields()[i].name) i++;
+    return i;
+}
+
+// the TOW is left out of the hash and the comparisons
+unsigned int tow_field()
+{
+    static const unsigned int tow = field_index("d_TOW");
+    return tow;
+}
+
+unsigned int toe_field()
+{
+    static const unsigned int toe = field_index("d_Toe");
+    return toe;
+}
+
+// FNV-1a of the bytes of x, with -0.0 hashed as 0.0 so that it matches the comparisons
+uint64_t hash_value(uint64_t h, double x)
+{
+    x += 0.0;
+    unsigned char bytes[sizeof(double)];
+    std::memcpy(bytes, &x, sizeof(double));
+    for (unsigned int i = 0; i < sizeof(double); i++)
+        {
+            h = (h ^ bytes[i]) * 1099511628211ULL;
+        }
+    return h;
+}
+}
+
+
+unsigned int Ephemeris_History::record_size()
+{
+    // the fields, then both IODE, which the fields leave out
+    return fields().size() + 2;
+}
+
+
+uint64_t Ephemeris_History::hash(const Gps_Ephemeris& eph)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned int i = 0; i < fields().size(); i++)
+        {
+            if (i != tow_field()) h = hash_value(h, fields()[i].value(eph));
+        }
+    h = hash_value(h, eph.d_IODE_SF2);
+    return hash_value(h, eph.d_IODE_SF3);
+}
+
+
+const double* Ephemeris_History::row(const Ring& ring, unsigned long int record) const
+{
+    return &ring.fields[(record % d_depth) * record_size()];
+}
+
+
+bool Ephemeris_History::same_fields(const Ring& ring, unsigned long int record, const Gps_Ephemeris& eph) const
+{
+    const double* values = row(ring, record);
+    for (unsigned int i = 0; i < fields().size(); i++)
+        {
+            if (i != tow_field() && values[i] != fields()[i].value(eph)) return false;
+        }
+    return values[fields().size()] == eph.d_IODE_SF2 && values[fields().size() + 1] == eph.d_IODE_SF3;
+}
+
+
+sEph Ephemeris_History::unpack(unsigned int PRN, const Ring& ring, unsigned long int record) const
+{
+    sEph eph;
+    const double* values = row(ring, record);
+    for (unsigned int i = 0; i < fields().size(); i++)
+        {
+            fields()[i].set_value(eph.ephemeris, values[i]);
+        }
+    eph.ephemeris.d_IODE_SF2 = values[fields().size()];
+    eph.ephemeris.d_IODE_SF3 = values[fields().size() + 1];
+    eph.ephemeris.i_satellite_PRN = PRN;
+    eph.time = ring.time[record % d_depth];
+    eph.changed = record > 0;
+    return eph;
+}
+
+
+bool Ephemeris_History::store(unsigned int PRN, const Gps_Ephemeris& eph, double time)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    Ring& ring = d_rings[PRN];
+    const uint64_t h = hash(eph);
+    if (ring.count == 0)
+        {
+            ring.fields.resize(d_depth * record_size());
+            ring.time.resize(d_depth);
+            ring.hash.resize(d_depth);
+            ring.order.resize(d_depth);
+        }
+    else if (ring.hash[(ring.count - 1) % d_depth] == h && same_fields(ring, ring.count - 1, eph))
+        {
+            return false;
+        }
+
+    const unsigned long int record = ring.count;
+    const unsigned int slot = record % d_depth;
+    if (record >= d_depth)
+        {
+            // forget the record that this one overwrites
+            const unsigned long int old = record - d_depth;
+            typedef std::multimap<uint64_t, unsigned long int>::iterator Hash_Iterator;
+            std::pair<Hash_Iterator, Hash_Iterator> range = ring.by_hash.equal_range(ring.hash[slot]);
+            for (Hash_Iterator it = range.first; it != range.second; ++it)
+                {
+                    if (it->second == old)
+                        {
+                            ring.by_hash.erase(it);
+                            break;
+                        }
+                }
+            const double* values = row(ring, old);
+            std::map<Issue, unsigned long int>::iterator it = ring.by_issue.find(Issue(values[toe_field()], values[fields().size()]));
+            if (it != ring.by_issue.end() && it->second == old)
+                {
+                    ring.by_issue.erase(it);
+                }
+        }
+
+    double* values = &ring.fields[slot * record_size()];
+    for (unsigned int i = 0; i < fields().size(); i++)
+        {
+            values[i] = fields()[i].value(eph);
+        }
+    values[fields().size()] = eph.d_IODE_SF2;
+    values[fields().size() + 1] = eph.d_IODE_SF3;
+    ring.time[slot] = time;
+    ring.hash[slot] = h;
+    ring.order[slot] = ++d_stored;
+    ring.count++;
+    ring.by_issue[issue(eph)] = record;
+    ring.by_hash.insert(std::make_pair(h, record));
+    return true;
+}
+
+
+bool Ephemeris_History::latest(unsigned int PRN, sEph& eph) const
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::map<unsigned int, Ring>::const_iterator it = d_rings.find(PRN);
+    if (it == d_rings.end() || it->second.count == 0)
+        {
+            return false;
+        }
+    eph = unpack(PRN, it->second, it->second.count - 1);
+    return true;
+}
+
+
+bool Ephemeris_History::find_issue(unsigned int PRN, double toe, double IODE, sEph& eph) const
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::map<unsigned int, Ring>::const_iterator it = d_rings.find(PRN);
+    if (it == d_rings.end())
+        {
+            return false;
+        }
+    std::map<Issue, unsigned long int>::const_iterator found = it->second.by_issue.find(Issue(toe, IODE));
+    if (found == it->second.by_issue.end())
+        {
+            return false;
+        }
+    eph = unpack(PRN, it->second, found->second);
+    return true;
+}
+
+
+bool Ephemeris_History::find_same(unsigned int PRN, const Gps_Ephemeris& eph, sEph& found) const
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::map<unsigned int, Ring>::const_iterator it = d_rings.find(PRN);
+    if (it == d_rings.end())
+        {
+            return false;
+        }
+    typedef std::multimap<uint64_t, unsigned long int>::const_iterator Hash_Iterator;
+    std::pair<Hash_Iterator, Hash_Iterator> range = it->second.by_hash.equal_range(hash(eph));
+    bool any = false;
+    unsigned long int newest = 0;
+    for (Hash_Iterator h = range.first; h != range.second; ++h)
+        {
+            if ((!any || h->second > newest) && same_fields(it->second, h->second, eph))
+                {
+                    newest = h->second;
+                    any = true;
+                }
+        }
+    if (any)
+        {
+            found = unpack(PRN, it->second, newest);
+        }
+    return any;
+}
+
+
+std::vector<sEph> Ephemeris_History::records(unsigned int PRN) const
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::vector<sEph> result;
+    std::map<unsigned int, Ring>::const_iterator it = d_rings.find(PRN);
+    if (it != d_rings.end())
+        {
+            const unsigned long int first = it->second.count > d_depth ? it->second.count - d_depth : 0;
+            for (unsigned long int record = first; record < it->second.count; record++)
+                {
+                    result.push_back(unpack(PRN, it->second, record));
+                }
+        }
+    return result;
+}
+
+
+std::vector<unsigned int> Ephemeris_History::satellites() const
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::vector<unsigned int> PRNs;
+    for (std::map<unsigned int, Ring>::const_iterator it = d_rings.begin(); it != d_rings.end(); ++it)
+        {
+            if (it->second.count > 0) PRNs.push_back(it->first);
+        }
+    return PRNs;
+}
+
+
+std::map<int, Gps_Ephemeris> Ephemeris_History::latest_since(unsigned long int& stored) const
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::map<int, Gps_Ephemeris> result;
+    for (std::map<unsigned int, Ring>::const_iterator it = d_rings.begin(); it != d_rings.end(); ++it)
+        {
+            const Ring& ring = it->second;
+            if (ring.count > 0 && ring.order[(ring.count - 1) % d_depth] > stored)
+                {
+                    result[it->first] = unpack(it->first, ring, ring.count - 1).ephemeris;
+                }
+        }
+    stored = d_stored;
+    return result;
+}
+
+
+unsigned long int Ephemeris_History::stored_count() const
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_stored;
+}
+
+
+void Ephemeris_History::clear()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_rings.clear();
+    d_stored = 0;
+}
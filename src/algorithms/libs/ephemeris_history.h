@@ -0,0 +1,156 @@
+/*!
+ * \file ephemeris_history.h
+ * \brief Bounded history of the GPS ephemeris of every satellite, indexed by
+ * issue of data
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_EPHEMERIS_HISTORY_H_
+#define GNSS_SDR_EPHEMERIS_HISTORY_H_
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include "gps_ephemeris.h"
+
+/*!
+ * \brief Ephemeris of a satellite checked by the spoofing detector, with
+ * the time it arrived.
+ */
+struct sEph
+{
+    Gps_Ephemeris ephemeris;
+    double time;  //!< Receiver time of its first arrival [ms]
+    bool changed; //!< True if it replaced an earlier ephemeris of the satellite
+};
+
+
+/*!
+ * \brief Last depth ephemeris of every GPS satellite, shared by the NAVI
+ * checks of the spoofing detector, its checkpoint and the RINEX printer.
+ *
+ * Each satellite has a ring of depth records, allocated at its first
+ * ephemeris. A record is packed as the values of gps_ephemeris_fields()
+ * plus the IODE, one row of a single array, with its arrival time, a hash
+ * of the fields but the TOW and its record number. Two indexes over the
+ * ring, one by reference time and IODE and one by hash, find the earlier
+ * records in O(log depth), and forget a record when the ring overwrites
+ * it.
+ *
+ * store() only keeps an ephemeris that differs from the newest record of
+ * its satellite in something else than the TOW, so it can be called with
+ * every subframe 3. Every method takes the lock of the history.
+ */
+class Ephemeris_History
+{
+public:
+    explicit Ephemeris_History(unsigned int depth = 16) : d_depth(depth > 1 ? depth : 2), d_stored(0) {}
+
+    /*!
+     * \brief Stores eph of satellite PRN, received at time [ms], unless it is
+     * the newest record of PRN but the TOW
+     * \return true if eph was stored
+     */
+    bool store(unsigned int PRN, const Gps_Ephemeris& eph, double time);
+
+    /*!
+     * \brief Newest record of PRN
+     */
+    bool latest(unsigned int PRN, sEph& eph) const;
+
+    /*!
+     * \brief Newest record of PRN with reference time toe [s] and IODE
+     */
+    bool find_issue(unsigned int PRN, double toe, double IODE, sEph& eph) const;
+
+    /*!
+     * \brief Newest record of PRN equal to eph but the TOW
+     */
+    bool find_same(unsigned int PRN, const Gps_Ephemeris& eph, sEph& found) const;
+
+    /*!
+     * \brief Records of PRN, oldest first
+     */
+    std::vector<sEph> records(unsigned int PRN) const;
+
+    /*!
+     * \brief Satellites with a record, in ascending order
+     */
+    std::vector<unsigned int> satellites() const;
+
+    /*!
+     * \brief Newest record of each satellite, by PRN, if it is newer than
+     * the stored first ephemeris of the history. Sets stored to
+     * stored_count(), so the next call only returns the ones stored since.
+     */
+    std::map<int, Gps_Ephemeris> latest_since(unsigned long int& stored) const;
+
+    //! Number of ephemeris stored so far, of all the satellites
+    unsigned long int stored_count() const;
+
+    unsigned int depth() const { return d_depth; }
+
+    void clear();
+
+    //! Hash of the fields of eph but the TOW
+    static uint64_t hash(const Gps_Ephemeris& eph);
+
+private:
+    Ephemeris_History(const Ephemeris_History&);
+    Ephemeris_History& operator=(const Ephemeris_History&);
+
+    typedef std::pair<double, double> Issue; // reference time [s], IODE
+
+    struct Ring
+    {
+        Ring() : count(0) {}
+        std::vector<double> fields;           // one row of record_size() values per slot
+        std::vector<double> time;             // arrival of each slot [ms]
+        std::vector<uint64_t> hash;    // hash() of each slot
+        std::vector<unsigned long int> order; // stored_count() after each slot was stored
+        unsigned long int count;              // records stored, the newest one in slot (count - 1) % depth
+        std::map<Issue, unsigned long int> by_issue;               // newest record number of each issue
+        std::multimap<uint64_t, unsigned long int> by_hash;        // record numbers of each hash
+    };
+
+    static unsigned int record_size();
+    static Issue issue(const Gps_Ephemeris& eph) { return Issue(eph.d_Toe, eph.d_IODE_SF2); }
+
+    const double* row(const Ring& ring, unsigned long int record) const;
+    bool same_fields(const Ring& ring, unsigned long int record, const Gps_Ephemeris& eph) const;
+    sEph unpack(unsigned int PRN, const Ring& ring, unsigned long int record) const;
+
+    unsigned int d_depth;
+    unsigned long int d_stored;
+    std::map<unsigned int, Ring> d_rings;
+    mutable boost::mutex d_mutex;
+};
+
+#endif
@@ -48,6 +48,7 @@
 
 #include "fft_internal.h"
 #include "fft_base_kernels.h"
+#include "opencl_program_cache.h"
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
@@ -239,6 +240,7 @@ clFFT_CreatePlan(cl_context context, clFFT_Dim3 n, clFFT_Dimension dim, clFFT_Da
 	int num_devices;
 	int gpu_found = 0;
 	cl_device_id devices[16];
+	cl_device_id gpu_device = 0;
 	size_t ret_size;
 	cl_device_type device_type;
 	
@@ -287,10 +289,6 @@ patch_kernel_source:
 
 	getBlockConfigAndKernelString(plan);
 	
-	const char *source_str = plan->kernel_string->c_str();
-	plan->program = clCreateProgramWithSource(context, 1, (const char**) &source_str, NULL, &err);
-    ERR_MACRO(err);
-
 	err = clGetContextInfo(context, CL_CONTEXT_DEVICES, sizeof(devices), devices, &ret_size);
 	ERR_MACRO(err);
 	
@@ -304,36 +302,45 @@ patch_kernel_source:
 		if(device_type == CL_DEVICE_TYPE_GPU)
 		{	
 			gpu_found = 1;
-	        err = clBuildProgram(plan->program, 1, &devices[i], "-cl-mad-enable", NULL, NULL);
-	        if (err != CL_SUCCESS)
-	        {
-		        char *build_log;				
-				char devicename[200];
-		        size_t log_size;
-				
-		        err = clGetProgramBuildInfo(plan->program, devices[i], CL_PROGRAM_BUILD_LOG, 0, NULL, &log_size);
-				ERR_MACRO(err);
-				
-		        build_log = (char *) malloc(log_size + 1);
-				
-			    err = clGetProgramBuildInfo(plan->program, devices[i], CL_PROGRAM_BUILD_LOG, log_size, build_log, NULL);
-				ERR_MACRO(err);
-				
-				err = clGetDeviceInfo(devices[i], CL_DEVICE_NAME, sizeof(devicename), devicename, NULL);
-				ERR_MACRO(err);
-				
-				fprintf(stdout, "FFT program build log on device %s\n", devicename);
-		        fprintf(stdout, "%s\n", build_log);
-		        free(build_log);
-				
-				ERR_MACRO(err);
-			}	
+			gpu_device = devices[i];
+			break;
 		}	
 	}
 	
 	if(!gpu_found)
 		ERR_MACRO(CL_INVALID_CONTEXT);
 	
+	// every channel asks for the same sizes: the program is built once per
+	// device and source, or loaded from the binary of a previous run
+	plan->program = Opencl_Program_Cache::build(context, gpu_device, *plan->kernel_string, "-cl-mad-enable", &err);
+	if(!plan->program)
+		ERR_MACRO(err);
+	
+	if(err != CL_SUCCESS)
+	{
+		char *build_log;				
+		char devicename[200];
+		size_t log_size;
+		cl_int build_err = err;
+		
+		err = clGetProgramBuildInfo(plan->program, gpu_device, CL_PROGRAM_BUILD_LOG, 0, NULL, &log_size);
+		ERR_MACRO(err);
+		
+		build_log = (char *) malloc(log_size + 1);
+		
+		err = clGetProgramBuildInfo(plan->program, gpu_device, CL_PROGRAM_BUILD_LOG, log_size, build_log, NULL);
+		ERR_MACRO(err);
+		
+		err = clGetDeviceInfo(gpu_device, CL_DEVICE_NAME, sizeof(devicename), devicename, NULL);
+		ERR_MACRO(err);
+		
+		fprintf(stdout, "FFT program build log on device %s\n", devicename);
+		fprintf(stdout, "%s\n", build_log);
+		free(build_log);
+		
+		ERR_MACRO(build_err);
+	}
+	
 	err = createKernelList(plan); 
     ERR_MACRO(err);
     
@@ -341,7 +348,7 @@ patch_kernel_source:
     // may be larger than what kernel may execute with ... if thats the case we need to regenerate the kernel source 
     // setting this as limit i.e max group size and rebuild. 
 	unsigned int max_kernel_wg_size; 
-	int patching_req = getMaxKernelWorkGroupSize(plan, &max_kernel_wg_size, num_devices, devices);
+	int patching_req = getMaxKernelWorkGroupSize(plan, &max_kernel_wg_size, 1, &gpu_device);
 	if(patching_req == -1)
 	{
 	    ERR_MACRO(err);
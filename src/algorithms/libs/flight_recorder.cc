@@ -0,0 +1,286 @@
+/*!
+ * \file flight_recorder.cc
+ * \brief GNU Radio sink that keeps the last seconds of samples in memory
+ * and stores them, with the following ones, when it is triggered
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "flight_recorder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+// Items copied from the ring to the file at a time
+#define FLIGHT_RECORDER_STAGING_BYTES (1024 * 1024)
+
+
+namespace
+{
+boost::mutex & flight_recorder_registry_mutex()
+{
+    static boost::mutex mutex;
+    return mutex;
+}
+
+std::set<flight_recorder *> & flight_recorder_registry()
+{
+    static std::set<flight_recorder *> registry;
+    return registry;
+}
+}
+
+
+void flight_recorder_trigger_all(const std::string & reason)
+{
+    boost::mutex::scoped_lock lock(flight_recorder_registry_mutex());
+    for (std::set<flight_recorder *>::iterator it = flight_recorder_registry().begin(); it != flight_recorder_registry().end(); ++it)
+        {
+            (*it)->trigger(reason);
+        }
+}
+
+
+flight_recorder_sptr make_flight_recorder(size_t item_size, double sampling_frequency,
+        double pre_trigger_s, double post_trigger_s, const std::string & filename)
+{
+    return flight_recorder_sptr(new flight_recorder(item_size, sampling_frequency, pre_trigger_s, post_trigger_s, filename));
+}
+
+
+flight_recorder::flight_recorder(size_t item_size, double sampling_frequency,
+        double pre_trigger_s, double post_trigger_s, const std::string & filename) : gr::sync_block("flight_recorder",
+                gr::io_signature::make(1, 1, item_size),
+                gr::io_signature::make(0, 0, 0)),
+        d_item_size(item_size),
+        d_sampling_frequency(sampling_frequency),
+        d_pre_items(static_cast<unsigned long long>(std::ceil(std::max(pre_trigger_s, 0.0) * sampling_frequency))),
+        d_post_items(static_cast<unsigned long long>(std::ceil(std::max(post_trigger_s, 0.0) * sampling_frequency))),
+        d_filename(filename),
+        d_writing(0),
+        d_written(0),
+        d_capture_end(0),
+        d_trigger(false),
+        d_captures(0),
+        d_capture_pending(false),
+        d_capturing(false),
+        d_stop(false)
+{
+    // one second more than the capture, for the writer to keep up with the disk
+    d_ring_items = d_pre_items + d_post_items + static_cast<unsigned long long>(std::ceil(sampling_frequency)) + 1;
+    d_ring.resize(d_ring_items * d_item_size);
+    d_thread = boost::thread(&flight_recorder::write_captures, this);
+    {
+        boost::mutex::scoped_lock lock(flight_recorder_registry_mutex());
+        flight_recorder_registry().insert(this);
+    }
+    LOG(INFO) << "flight_recorder: " << d_pre_items << " items before and " << d_post_items
+              << " items after a trigger, " << d_ring.size() / (1024 * 1024) << " MB of ring, to " << d_filename << "_N.dat";
+}
+
+
+flight_recorder::~flight_recorder()
+{
+    {
+        boost::mutex::scoped_lock lock(flight_recorder_registry_mutex());
+        flight_recorder_registry().erase(this);
+    }
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_stop = true;
+    }
+    d_condition.notify_all();
+    d_thread.join();
+}
+
+
+void flight_recorder::trigger(const std::string & reason)
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_trigger_reason = reason;
+    }
+    d_trigger.store(true);
+}
+
+
+void flight_recorder::start_capture(unsigned long long trigger_item)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    if (d_capturing)
+        {
+            d_capture_end.store(trigger_item + d_post_items);
+            LOG(INFO) << "flight_recorder: capture extended by " << d_trigger_reason;
+            return;
+        }
+    d_capture.trigger_item = trigger_item;
+    d_capture.first_item = (trigger_item > d_pre_items) ? trigger_item - d_pre_items : 0;
+    d_capture.reason = d_trigger_reason;
+    d_capture_end.store(trigger_item + d_post_items);
+    d_capture_pending = true;
+    d_capturing = true;
+    d_condition.notify_all();
+}
+
+
+void flight_recorder::write_captures()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    unsigned int number = 0;
+    while (true)
+        {
+            while (!d_stop && !d_capture_pending)
+                {
+                    d_condition.wait(lock);
+                }
+            if (!d_capture_pending)
+                {
+                    return;
+                }
+            Capture capture = d_capture;
+            d_capture_pending = false;
+            lock.unlock();
+            write_capture(capture, number++);
+            lock.lock();
+            d_captures++;
+        }
+}
+
+
+void flight_recorder::write_capture(const Capture & capture, unsigned int number)
+{
+    std::stringstream name;
+    name << d_filename << "_" << number;
+    FILE * file = std::fopen((name.str() + ".dat").c_str(), "wb");
+    if (file == 0)
+        {
+            LOG(WARNING) << "flight_recorder: unable to create " << name.str() << ".dat, capture lost";
+            boost::mutex::scoped_lock lock(d_mutex);
+            d_capturing = false;
+            return;
+        }
+    const unsigned long long staging_items = std::max(static_cast<size_t>(1), FLIGHT_RECORDER_STAGING_BYTES / d_item_size);
+    std::vector<char> staging(staging_items * d_item_size);
+    unsigned long long item = capture.first_item;
+    unsigned long long lost = 0;
+    bool write_error = false;
+    while (true)
+        {
+            unsigned long long end = d_capture_end.load();
+            if (item >= end)
+                {
+                    boost::mutex::scoped_lock lock(d_mutex);
+                    if (item >= d_capture_end.load())
+                        {
+                            d_capturing = false; // the next trigger starts a new capture
+                            break;
+                        }
+                    continue; // extended meanwhile
+                }
+            unsigned long long available = d_written.load(std::memory_order_acquire);
+            if (available <= item)
+                {
+                    boost::mutex::scoped_lock lock(d_mutex);
+                    if (d_stop)
+                        {
+                            d_capturing = false; // the flowgraph ended before the end of the capture
+                            break;
+                        }
+                    d_condition.timed_wait(lock, boost::posix_time::milliseconds(10));
+                    continue;
+                }
+            unsigned long long items = std::min(std::min(available, end) - item, staging_items);
+            unsigned long long position = item % d_ring_items;
+            unsigned long long first_part = std::min(items, d_ring_items - position);
+            std::memcpy(&staging[0], &d_ring[position * d_item_size], first_part * d_item_size);
+            std::memcpy(&staging[first_part * d_item_size], &d_ring[0], (items - first_part) * d_item_size);
+            // the items the producer may have reached before or during the copy are not valid
+            std::atomic_thread_fence(std::memory_order_acquire);
+            unsigned long long writing = d_writing.load(std::memory_order_relaxed);
+            unsigned long long oldest = (writing > d_ring_items) ? writing - d_ring_items : 0;
+            if (oldest > item)
+                {
+                    unsigned long long overwritten = std::min(oldest - item, items);
+                    std::memset(&staging[0], 0, overwritten * d_item_size);
+                    lost += overwritten;
+                }
+            if (!write_error && std::fwrite(&staging[0], d_item_size, items, file) != items)
+                {
+                    LOG(WARNING) << "flight_recorder: error writing " << name.str() << ".dat";
+                    write_error = true;
+                }
+            item += items;
+        }
+    std::fclose(file);
+
+    std::ofstream description((name.str() + ".txt").c_str());
+    description << "reason: " << capture.reason << std::endl
+                << "trigger_item: " << capture.trigger_item << std::endl
+                << "first_item: " << capture.first_item << std::endl
+                << "items: " << item - capture.first_item << std::endl
+                << "lost_items: " << lost << std::endl
+                << "item_size: " << d_item_size << std::endl
+                << "sampling_frequency: " << d_sampling_frequency << std::endl;
+    LOG(INFO) << "flight_recorder: stored " << item - capture.first_item << " items around item "
+              << capture.trigger_item << " (" << capture.reason << ") in " << name.str() << ".dat";
+    if (lost > 0)
+        {
+            LOG(WARNING) << "flight_recorder: the disk did not keep up, " << lost << " items of "
+                         << name.str() << ".dat are zeros";
+        }
+}
+
+
+int flight_recorder::work(int noutput_items,
+        gr_vector_const_void_star &input_items,
+        gr_vector_void_star &output_items __attribute__((unused)))
+{
+    const char * in = static_cast<const char *>(input_items[0]);
+    unsigned long long written = d_written.load(std::memory_order_relaxed);
+    if (d_trigger.load(std::memory_order_relaxed) && d_trigger.exchange(false))
+        {
+            start_capture(written);
+        }
+    unsigned long long items = std::min(static_cast<unsigned long long>(noutput_items), d_ring_items);
+    in += (noutput_items - items) * d_item_size; // only the last d_ring_items items can be kept
+    written += noutput_items - items;
+    d_writing.store(written + items, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    unsigned long long position = written % d_ring_items;
+    unsigned long long first_part = std::min(items, d_ring_items - position);
+    std::memcpy(&d_ring[position * d_item_size], in, first_part * d_item_size);
+    std::memcpy(&d_ring[0], in + first_part * d_item_size, (items - first_part) * d_item_size);
+    d_written.store(written + items, std::memory_order_release);
+    return noutput_items;
+}
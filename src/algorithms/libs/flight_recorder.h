@@ -0,0 +1,130 @@
+/*!
+ * \file flight_recorder.h
+ * \brief GNU Radio sink that keeps the last seconds of samples in memory
+ * and stores them, with the following ones, when it is triggered
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_FLIGHT_RECORDER_H_
+#define GNSS_SDR_FLIGHT_RECORDER_H_
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <gnuradio/sync_block.h>
+
+class flight_recorder;
+
+typedef boost::shared_ptr<flight_recorder> flight_recorder_sptr;
+
+/*!
+ * \brief Makes a recorder of items of item_size bytes at sampling_frequency
+ * items per second. Each capture is stored in filename_N.dat, with its
+ * description in filename_N.txt.
+ */
+flight_recorder_sptr make_flight_recorder(size_t item_size, double sampling_frequency,
+        double pre_trigger_s, double post_trigger_s, const std::string & filename);
+
+/*!
+ * \brief Triggers every flight recorder of the receiver. It can be called
+ * from any thread, and only sets a flag in each recorder.
+ */
+void flight_recorder_trigger_all(const std::string & reason);
+
+/*!
+ * \brief Sink that keeps the last pre_trigger_s seconds of its input in a
+ * preallocated ring buffer, and writes them with the next post_trigger_s
+ * seconds to a file when triggered.
+ *
+ * work() only copies the input into the ring and publishes the number of
+ * items written: it never waits for the disk. A writer thread stores the
+ * capture from the ring while new items arrive. The ring holds one second
+ * more than the capture, for the disk to keep up; if it does not, the
+ * overwritten items are stored as zeros, so the capture keeps its timing.
+ * A trigger during a capture extends it.
+ */
+class flight_recorder: public gr::sync_block
+{
+private:
+    friend flight_recorder_sptr make_flight_recorder(size_t item_size, double sampling_frequency,
+            double pre_trigger_s, double post_trigger_s, const std::string & filename);
+    flight_recorder(size_t item_size, double sampling_frequency,
+            double pre_trigger_s, double post_trigger_s, const std::string & filename);
+
+    struct Capture
+    {
+        unsigned long long trigger_item;
+        unsigned long long first_item;
+        std::string reason;
+    };
+
+    void start_capture(unsigned long long trigger_item);
+    void write_captures();
+    void write_capture(const Capture & capture, unsigned int number);
+
+    size_t d_item_size;
+    double d_sampling_frequency;
+    unsigned long long d_pre_items;
+    unsigned long long d_post_items;
+    unsigned long long d_ring_items;
+    std::string d_filename;
+    std::vector<char> d_ring;
+    std::atomic<unsigned long long> d_writing;       // items being written to the ring
+    std::atomic<unsigned long long> d_written;       // items written to the ring
+    std::atomic<unsigned long long> d_capture_end;   // item after the last one of the capture in progress
+    std::atomic<bool> d_trigger;
+    std::atomic<unsigned int> d_captures;
+    std::string d_trigger_reason;
+    Capture d_capture;
+    bool d_capture_pending;
+    bool d_capturing;          // a capture is pending or being written
+    bool d_stop;
+    boost::mutex d_mutex;
+    boost::condition_variable d_condition;
+    boost::thread d_thread;
+
+public:
+    ~flight_recorder();
+
+    /*!
+     * \brief Starts a capture at the next input item
+     */
+    void trigger(const std::string & reason);
+
+    unsigned long long items() const { return d_written.load(); }
+    unsigned int captures() const { return d_captures.load(); }
+
+    int work(int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items);
+};
+
+#endif /*GNSS_SDR_FLIGHT_RECORDER_H_*/
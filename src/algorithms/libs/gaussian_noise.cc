@@ -0,0 +1,120 @@
+/*!
+ * \file gaussian_noise.cc
+ * \brief Fast generator of white Gaussian noise, for the synthesized signals
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "gaussian_noise.h"
+
+// right edge of the base layer of the 128 layer Ziggurat, and its area
+#define GAUSSIAN_NOISE_R 3.442619855899
+#define GAUSSIAN_NOISE_V 9.91256303526217e-3
+
+
+Gaussian_Noise::Gaussian_Noise(unsigned long long seed)
+{
+    // Marsaglia and Tsang, "The Ziggurat Method for Generating Random Variables", 2000
+    const double m1 = 2147483648.0;
+    double dn = GAUSSIAN_NOISE_R;
+    double tn = dn;
+    const double q = GAUSSIAN_NOISE_V / std::exp(-0.5 * dn * dn);
+    d_kn[0] = static_cast<unsigned int>((dn / q) * m1);
+    d_kn[1] = 0;
+    d_wn[0] = static_cast<float>(q / m1);
+    d_wn[127] = static_cast<float>(dn / m1);
+    d_fn[0] = 1.0f;
+    d_fn[127] = static_cast<float>(std::exp(-0.5 * dn * dn));
+    for (int i = 126; i >= 1; i--)
+        {
+            dn = std::sqrt(-2.0 * std::log(GAUSSIAN_NOISE_V / dn + std::exp(-0.5 * dn * dn)));
+            d_kn[i + 1] = static_cast<unsigned int>((dn / tn) * m1);
+            tn = dn;
+            d_fn[i] = static_cast<float>(std::exp(-0.5 * dn * dn));
+            d_wn[i] = static_cast<float>(dn / m1);
+        }
+    this->seed(seed);
+}
+
+
+void Gaussian_Noise::seed(unsigned long long seed)
+{
+    // splitmix64, so that close seeds give unrelated states, and never the all-zero one
+    for (int i = 0; i < 2; i++)
+        {
+            seed += 0x9E3779B97F4A7C15ULL;
+            unsigned long long z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            d_state[i] = z ^ (z >> 31);
+        }
+    if ((d_state[0] | d_state[1]) == 0)
+        {
+            d_state[0] = 1;
+        }
+}
+
+
+float Gaussian_Noise::gauss_tail(int hz, unsigned int iz)
+{
+    while (true)
+        {
+            const float x = static_cast<float>(hz) * d_wn[iz];
+            if (iz == 0)
+                {
+                    // beyond the base layer, from the exponential tail
+                    float xt, yt;
+                    do
+                        {
+                            xt = -std::log(uniform()) / static_cast<float>(GAUSSIAN_NOISE_R);
+                            yt = -std::log(uniform());
+                        }
+                    while (yt + yt < xt * xt);
+                    return (hz > 0) ? static_cast<float>(GAUSSIAN_NOISE_R) + xt : -static_cast<float>(GAUSSIAN_NOISE_R) - xt;
+                }
+            if (d_fn[iz] + uniform() * (d_fn[iz - 1] - d_fn[iz]) < std::exp(-0.5f * x * x))
+                {
+                    return x;
+                }
+            const unsigned long long u = next_uint64();
+            hz = static_cast<int>(static_cast<unsigned int>(u >> 32));
+            iz = u & 127;
+            if (static_cast<unsigned int>(std::abs(static_cast<long long>(hz))) < d_kn[iz])
+                {
+                    return static_cast<float>(hz) * d_wn[iz];
+                }
+        }
+}
+
+
+void Gaussian_Noise::add_complex(gr_complex* out, unsigned int n, float sigma)
+{
+    float* samples = reinterpret_cast<float*>(out);
+    for (unsigned int i = 0; i < 2 * n; i++)
+        {
+            samples[i] += sigma * gauss();
+        }
+}
@@ -0,0 +1,100 @@
+/*!
+ * \file gaussian_noise.h
+ * \brief Fast generator of white Gaussian noise, for the synthesized signals
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_GAUSSIAN_NOISE_H_
+#define GNSS_SDR_GAUSSIAN_NOISE_H_
+
+#include <cmath>
+#include <gnuradio/gr_complex.h>
+
+/*!
+ * \brief Normal N(0,1) variates with the Ziggurat method over a xorshift128+
+ * generator.
+ *
+ * gr::random::gasdev() costs two calls to the minimal standard generator
+ * and a logarithm and a square root per pair of samples. Here over 98 % of
+ * the variates take one 64 bit xorshift step, a table look-up, a compare
+ * and a multiplication; the rest are resolved with an exponential. The 64
+ * bits of each step are split: the low 7 bits select the layer and the high
+ * 32 bits give the value, so they are independent. The generator is not for
+ * cryptography, and the same seed always gives the same sequence.
+ */
+class Gaussian_Noise
+{
+public:
+    explicit Gaussian_Noise(unsigned long long seed = 0x9E3779B97F4A7C15ULL);
+
+    void seed(unsigned long long seed);
+
+    unsigned long long next_uint64()
+    {
+        unsigned long long x = d_state[0];
+        const unsigned long long y = d_state[1];
+        d_state[0] = y;
+        x ^= x << 23;
+        d_state[1] = x ^ y ^ (x >> 17) ^ (y >> 26);
+        return d_state[1] + y;
+    }
+
+    //! Uniform in (0, 1)
+    float uniform()
+    {
+        return (static_cast<float>(next_uint64() >> 40) + 0.5f) * (1.0f / 16777216.0f);
+    }
+
+    //! Normal with zero mean and unit variance
+    float gauss()
+    {
+        const unsigned long long u = next_uint64();
+        const int hz = static_cast<int>(static_cast<unsigned int>(u >> 32));
+        const unsigned int iz = u & 127;
+        if (static_cast<unsigned int>(std::abs(static_cast<long long>(hz))) < d_kn[iz])
+            {
+                return static_cast<float>(hz) * d_wn[iz];
+            }
+        return gauss_tail(hz, iz);
+    }
+
+    /*!
+     * \brief Adds complex noise with a variance of sigma^2 on each of the real
+     * and the imaginary parts to the n samples of out
+     */
+    void add_complex(gr_complex* out, unsigned int n, float sigma = 1.0f);
+
+private:
+    float gauss_tail(int hz, unsigned int iz);
+
+    unsigned long long d_state[2];
+    unsigned int d_kn[128];
+    float d_wn[128];
+    float d_fn[128];
+};
+
+#endif
@@ -0,0 +1,320 @@
+/*!
+ * \file latency_trace.cc
+ * \brief Tracepoints from the signal source to the PVT fixes and spoofing
+ * alarms, correlated by sample counter
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "latency_trace.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <boost/thread/mutex.hpp>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+std::atomic<bool> latency_trace_enabled(false);
+
+namespace
+{
+/*
+ * A slot is a seqlock: sequence is 0 while the event is written, then its
+ * index + 1, so a reader can tell a complete event from a torn one
+ */
+struct Event_Slot
+{
+    std::atomic<unsigned long long> sequence;
+    std::atomic<unsigned long long> sample_counter;
+    std::atomic<long long> time_ns;
+    std::atomic<int> stage;
+    std::atomic<int> id;
+};
+
+struct Event
+{
+    Latency_Stage stage;
+    int id;
+    unsigned long long sample_counter;
+    long long time_ns;
+};
+
+boost::mutex ring_mutex;
+std::unique_ptr<Event_Slot[]> ring;
+unsigned long long ring_size = 0;
+std::atomic<unsigned long long> next_slot(0);
+std::atomic<unsigned long long> newest_processed(0);
+
+const char* stage_names[LATENCY_STAGES] = {"source", "conditioner", "acquisition", "tracking",
+        "telemetry", "observables", "pvt", "spoofing_alarm"};
+
+
+// returns true if no event has been overwritten
+bool read_events(std::vector<Event>& events)
+{
+    events.clear();
+    unsigned long long last = next_slot.load(std::memory_order_acquire);
+    unsigned long long first = last > ring_size ? last - ring_size : 0;
+    for (unsigned long long index = first; index < last; index++)
+        {
+            const Event_Slot& slot = ring[index & (ring_size - 1)];
+            unsigned long long sequence = slot.sequence.load(std::memory_order_acquire);
+            Event event;
+            event.stage = static_cast<Latency_Stage>(slot.stage.load(std::memory_order_relaxed));
+            event.id = slot.id.load(std::memory_order_relaxed);
+            event.sample_counter = slot.sample_counter.load(std::memory_order_relaxed);
+            event.time_ns = slot.time_ns.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence == index + 1 && slot.sequence.load(std::memory_order_relaxed) == sequence)
+                {
+                    events.push_back(event);
+                }
+        }
+    return first == 0;
+}
+
+
+/*
+ * Times at which the first source delivered the samples. The source event
+ * k, with counter C_k, delivered the samples from C_(k-1) to C_k; those
+ * before the first event in the ring are known only if it is the first of
+ * the trace.
+ */
+class Source_Times
+{
+public:
+    Source_Times(const std::vector<Event>& events, bool from_start) :
+        d_from_start(from_start)
+    {
+        for (unsigned int i = 0; i < events.size(); i++)
+            {
+                if (events[i].stage == LATENCY_SOURCE && events[i].id == 0)
+                    {
+                        d_counters.push_back(events[i].sample_counter);
+                        d_times_ns.push_back(events[i].time_ns);
+                    }
+            }
+    }
+
+    //! Time the sample arrived at the source, false if it is not known
+    bool arrival_ns(unsigned long long sample_counter, long long& time_ns) const
+    {
+        std::vector<unsigned long long>::const_iterator it = std::upper_bound(d_counters.begin(), d_counters.end(), sample_counter);
+        if (it == d_counters.end() || (it == d_counters.begin() && !d_from_start))
+            {
+                return false;
+            }
+        time_ns = d_times_ns[it - d_counters.begin()];
+        return true;
+    }
+
+private:
+    bool d_from_start;
+    std::vector<unsigned long long> d_counters;
+    std::vector<long long> d_times_ns;
+};
+}
+
+
+void Latency_Trace::start(unsigned int capacity)
+{
+    boost::mutex::scoped_lock lock(ring_mutex);
+    latency_trace_enabled.store(false);
+    unsigned long long size = 1;
+    while (size < capacity)
+        {
+            size *= 2;
+        }
+    ring.reset(new Event_Slot[size]);
+    for (unsigned long long i = 0; i < size; i++)
+        {
+            ring[i].sequence.store(0);
+        }
+    ring_size = size;
+    next_slot.store(0);
+    newest_processed.store(0);
+    latency_trace_enabled.store(true);
+    LOG(INFO) << "Latency trace of the last " << size << " events started";
+}
+
+
+void Latency_Trace::stop()
+{
+    latency_trace_enabled.store(false);
+}
+
+
+void Latency_Trace::record(Latency_Stage stage, int id, unsigned long long sample_counter)
+{
+    long long now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    unsigned long long index = next_slot.fetch_add(1, std::memory_order_relaxed);
+    Event_Slot& slot = ring[index & (ring_size - 1)];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.stage.store(stage, std::memory_order_relaxed);
+    slot.id.store(id, std::memory_order_relaxed);
+    slot.sample_counter.store(sample_counter, std::memory_order_relaxed);
+    slot.time_ns.store(now_ns, std::memory_order_relaxed);
+    slot.sequence.store(index + 1, std::memory_order_release);
+
+    if (stage >= LATENCY_TRACKING && stage <= LATENCY_PVT)
+        {
+            unsigned long long newest = newest_processed.load(std::memory_order_relaxed);
+            while (sample_counter > newest && !newest_processed.compare_exchange_weak(newest, sample_counter, std::memory_order_relaxed))
+                {
+                }
+        }
+}
+
+
+void Latency_Trace::record_alarm(int spoofing_case)
+{
+    if (latency_trace_on())
+        {
+            record(LATENCY_SPOOFING_ALARM, spoofing_case, newest_processed.load(std::memory_order_relaxed));
+        }
+}
+
+
+void Latency_Trace::latencies_s(Latency_Stage stage, std::vector<double>& latencies)
+{
+    latencies.clear();
+    std::vector<Event> events;
+    bool from_start;
+    {
+        boost::mutex::scoped_lock lock(ring_mutex);
+        if (ring_size == 0)
+            {
+                return;
+            }
+        from_start = read_events(events);
+    }
+    Source_Times source(events, from_start);
+    for (unsigned int i = 0; i < events.size(); i++)
+        {
+            long long arrival_ns;
+            if (events[i].stage == stage && source.arrival_ns(events[i].sample_counter, arrival_ns))
+                {
+                    latencies.push_back(static_cast<double>(events[i].time_ns - arrival_ns) * 1e-9);
+                }
+        }
+}
+
+
+bool Latency_Trace::write_chrome_trace(const std::string& filename)
+{
+    std::vector<Event> events;
+    bool from_start;
+    {
+        boost::mutex::scoped_lock lock(ring_mutex);
+        if (ring_size == 0)
+            {
+                return false;
+            }
+        from_start = read_events(events);
+    }
+    std::ofstream file(filename.c_str(), std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+        {
+            LOG(WARNING) << "Unable to write the latency trace " << filename;
+            return false;
+        }
+    Source_Times source(events, from_start);
+    long long origin_ns = events.empty() ? 0 : events.front().time_ns;
+    for (unsigned int i = 0; i < events.size(); i++)
+        {
+            origin_ns = std::min(origin_ns, events[i].time_ns);
+        }
+
+    // one row per stage and id
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    std::set<int> rows;
+    bool first = true;
+    file.setf(std::ios::fixed);
+    file.precision(3);
+    for (unsigned int i = 0; i < events.size(); i++)
+        {
+            const Event& event = events[i];
+            int tid = 1000 * event.stage + event.id + 1;
+            if (rows.insert(tid).second)
+                {
+                    file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+                         << ",\"args\":{\"name\":\"" << stage_names[event.stage] << " " << event.id << "\"}}";
+                    first = false;
+                }
+            long long arrival_ns;
+            file << ",\n{\"name\":\"" << stage_names[event.stage] << "\",\"cat\":\"latency\",\"pid\":1,\"tid\":" << tid;
+            if (event.stage != LATENCY_SOURCE && source.arrival_ns(event.sample_counter, arrival_ns) && arrival_ns <= event.time_ns)
+                {
+                    file << ",\"ph\":\"X\",\"ts\":" << (arrival_ns - origin_ns) / 1e3 << ",\"dur\":" << (event.time_ns - arrival_ns) / 1e3
+                         << ",\"args\":{\"sample\":" << event.sample_counter << ",\"latency_ms\":" << (event.time_ns - arrival_ns) / 1e6 << "}}";
+                }
+            else
+                {
+                    file << ",\"ph\":\"i\",\"s\":\"t\",\"ts\":" << (event.time_ns - origin_ns) / 1e3
+                         << ",\"args\":{\"sample\":" << event.sample_counter << "}}";
+                }
+        }
+    file << "\n]}\n";
+    if (!file)
+        {
+            LOG(WARNING) << "Unable to write the latency trace " << filename;
+            return false;
+        }
+    LOG(INFO) << "Latency trace of " << events.size() << " events written to " << filename;
+    return true;
+}
+
+
+void Latency_Trace::log_summary()
+{
+    for (int stage = LATENCY_CONDITIONER; stage < LATENCY_STAGES; stage++)
+        {
+            std::vector<double> latencies;
+            latencies_s(static_cast<Latency_Stage>(stage), latencies);
+            if (latencies.empty())
+                {
+                    continue;
+                }
+            double sum = 0.0;
+            for (unsigned int i = 0; i < latencies.size(); i++)
+                {
+                    sum += latencies[i];
+                }
+            LOG(INFO) << "Latency of " << stage_names[stage] << " over " << latencies.size() << " events: mean "
+                      << 1e3 * sum / latencies.size() << " ms, max " << 1e3 * *std::max_element(latencies.begin(), latencies.end()) << " ms";
+        }
+}
+
+
+const char* Latency_Trace::stage_name(Latency_Stage stage)
+{
+    return stage < LATENCY_STAGES ? stage_names[stage] : "";
+}
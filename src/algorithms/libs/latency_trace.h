@@ -0,0 +1,132 @@
+/*!
+ * \file latency_trace.h
+ * \brief Tracepoints from the signal source to the PVT fixes and spoofing
+ * alarms, correlated by sample counter
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_LATENCY_TRACE_H_
+#define GNSS_SDR_LATENCY_TRACE_H_
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+//! Stages of the receiver with a tracepoint, in signal order
+enum Latency_Stage
+{
+    LATENCY_SOURCE = 0,
+    LATENCY_CONDITIONER,
+    LATENCY_ACQUISITION,
+    LATENCY_TRACKING,
+    LATENCY_TELEMETRY,
+    LATENCY_OBSERVABLES,
+    LATENCY_PVT,
+    LATENCY_SPOOFING_ALARM,
+    LATENCY_STAGES
+};
+
+//! true while the tracepoints record. Read with latency_trace_on()
+extern std::atomic<bool> latency_trace_enabled;
+
+inline bool latency_trace_on()
+{
+    return latency_trace_enabled.load(std::memory_order_relaxed);
+}
+
+/*!
+ * \brief Records that stage is done with the sample sample_counter, at the
+ * internal sampling frequency: the end of the input of a source or
+ * conditioner, the dwell of an acquisition, Gnss_Synchro::sample_counter
+ * (the start of the epoch) from the tracking on. A trace that is off
+ * costs a relaxed load.
+ */
+#define LATENCY_TRACE(stage, id, sample_counter) \
+    do { if (latency_trace_on()) Latency_Trace::record(stage, id, sample_counter); } while (0)
+
+//! The tracking blocks trace one epoch in this many, a navigation bit of GPS L1 C/A
+const unsigned int LATENCY_TRACE_EPOCHS = 20;
+
+
+/*!
+ * \brief Ring of the latest tracepoint events of the receiver.
+ *
+ * Each event holds its stage, an id (the signal conditioner or the channel,
+ * -1 if none), a sample counter and the steady clock time. record() takes a
+ * slot with one atomic increment and never blocks, so any block can call it
+ * at every work(). The oldest events are overwritten.
+ *
+ * The latency of an event is the time since the source delivered the
+ * sample it refers to: the first LATENCY_SOURCE event of the first source
+ * with a counter beyond it. A spoofing alarm refers to the newest sample
+ * that the tracking, telemetry, observables or PVT stages had recorded
+ * when it was raised, the latest data it can depend on.
+ *
+ * write_chrome_trace() stores the ring as a Chrome trace (chrome://tracing,
+ * Perfetto), with one bar per event from the arrival of its sample at the
+ * source to the event.
+ */
+class Latency_Trace
+{
+public:
+    /*!
+     * \brief Clears the ring, sized to hold capacity events (rounded up to a
+     * power of two), and starts recording
+     */
+    static void start(unsigned int capacity);
+
+    static void stop(); //!< Stops recording, the ring is kept
+
+    static void record(Latency_Stage stage, int id, unsigned long long sample_counter);
+
+    /*!
+     * \brief Records a spoofing alarm, for the newest sample processed so far
+     */
+    static void record_alarm(int spoofing_case);
+
+    /*!
+     * \brief Writes the events in the ring to filename as a Chrome trace JSON
+     * file. Returns false if it cannot be written.
+     */
+    static bool write_chrome_trace(const std::string& filename);
+
+    /*!
+     * \brief Logs the number of events and the mean and maximum latency of each stage
+     */
+    static void log_summary();
+
+    /*!
+     * \brief Latencies [s] of the events of stage in the ring, oldest first.
+     * The events without a source event for their sample are skipped.
+     */
+    static void latencies_s(Latency_Stage stage, std::vector<double>& latencies);
+
+    static const char* stage_name(Latency_Stage stage);
+};
+
+#endif
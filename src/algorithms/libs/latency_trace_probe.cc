@@ -0,0 +1,64 @@
+/*!
+ * \file latency_trace_probe.cc
+ * \brief GNU Radio block that records a latency tracepoint for the
+ * samples of a stream
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include "latency_trace_probe.h"
+#include <cmath>
+#include <gnuradio/io_signature.h>
+
+
+latency_trace_probe_sptr make_latency_trace_probe(size_t item_size, Latency_Stage stage, int id,
+        double internal_samples_per_item)
+{
+    return latency_trace_probe_sptr(new latency_trace_probe(item_size, stage, id, internal_samples_per_item));
+}
+
+
+latency_trace_probe::latency_trace_probe(size_t item_size, Latency_Stage stage, int id, double internal_samples_per_item) :
+        gr::sync_block("latency_trace_probe",
+                gr::io_signature::make(1, 1, item_size),
+                gr::io_signature::make(0, 0, 0)),
+        d_stage(stage),
+        d_id(id),
+        d_internal_samples_per_item(internal_samples_per_item),
+        d_items(0)
+{}
+
+
+int latency_trace_probe::work(int noutput_items,
+        gr_vector_const_void_star &input_items __attribute__((unused)),
+        gr_vector_void_star &output_items __attribute__((unused)))
+{
+    d_items += noutput_items;
+    LATENCY_TRACE(d_stage, d_id, std::llround(d_items * d_internal_samples_per_item));
+    return noutput_items;
+}
@@ -0,0 +1,76 @@
+/*!
+ * \file latency_trace_probe.h
+ * \brief GNU Radio block that records a latency tracepoint for the
+ * samples of a stream
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#ifndef GNSS_SDR_LATENCY_TRACE_PROBE_H_
+#define GNSS_SDR_LATENCY_TRACE_PROBE_H_
+
+#include <boost/shared_ptr.hpp>
+#include <gnuradio/sync_block.h>
+#include "latency_trace.h"
+
+class latency_trace_probe;
+
+typedef boost::shared_ptr<latency_trace_probe> latency_trace_probe_sptr;
+
+/*!
+ * \brief Makes a probe of a stream of items of item_size bytes, each one
+ * internal_samples_per_item samples at the internal sampling frequency
+ * (the ratio of the internal and the source sampling frequencies for a
+ * signal source)
+ */
+latency_trace_probe_sptr make_latency_trace_probe(size_t item_size, Latency_Stage stage, int id,
+        double internal_samples_per_item);
+
+/*!
+ * \brief Implementation of a GNU Radio sink that records a Latency_Trace
+ * event of stage at every work(), with the sample counter of the end of
+ * its input
+ */
+class latency_trace_probe : public gr::sync_block
+{
+private:
+    friend latency_trace_probe_sptr make_latency_trace_probe(size_t item_size, Latency_Stage stage, int id,
+            double internal_samples_per_item);
+    latency_trace_probe(size_t item_size, Latency_Stage stage, int id, double internal_samples_per_item);
+    Latency_Stage d_stage;
+    int d_id;
+    double d_internal_samples_per_item;
+    unsigned long long d_items;
+
+public:
+    int work(int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items);
+};
+
+#endif
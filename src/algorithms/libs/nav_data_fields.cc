@@ -0,0 +1,135 @@
+/*!
+ * \file nav_data_fields.cc
+ * \brief Tables of the fields of the GPS navigation data structures
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "nav_data_fields.h"
+
+const std::vector<Nav_Field<Gps_Ephemeris> >& gps_ephemeris_fields()
+{
+    typedef Nav_Field<Gps_Ephemeris> F;
+    static const std::vector<F> fields = {
+        F("i_peak", &Gps_Ephemeris::i_peak),
+        F("d_TOW", &Gps_Ephemeris::d_TOW),
+        // Subframe 1
+        F("i_GPS_week", &Gps_Ephemeris::i_GPS_week),
+        F("i_code_on_L2", &Gps_Ephemeris::i_code_on_L2),
+        F("b_L2_P_data_flag", &Gps_Ephemeris::b_L2_P_data_flag),
+        F("i_SV_accuracy", &Gps_Ephemeris::i_SV_accuracy),
+        F("i_SV_health", &Gps_Ephemeris::i_SV_health),
+        F("d_TGD", &Gps_Ephemeris::d_TGD),
+        F("d_IODC", &Gps_Ephemeris::d_IODC),
+        F("d_Toc", &Gps_Ephemeris::d_Toc),
+        F("d_A_f0", &Gps_Ephemeris::d_A_f0, "A_f0", 0.0011874),
+        F("d_A_f1", &Gps_Ephemeris::d_A_f1, "A_f1", 1.1607e-10),
+        F("d_A_f2", &Gps_Ephemeris::d_A_f2, "A_f2", 1e-17),
+        // Subframe 2
+        F("d_Crs", &Gps_Ephemeris::d_Crs, "Crs", 271.5938),
+        F("d_Delta_n", &Gps_Ephemeris::d_Delta_n, "Delta_n", 5.5642e-09),
+        F("d_M_0", &Gps_Ephemeris::d_M_0, "M_0", 5.9478),
+        F("d_Cuc", &Gps_Ephemeris::d_Cuc, "Cuc", 1.3784e-05),
+        F("d_e_eccentricity", &Gps_Ephemeris::d_e_eccentricity, "e_eccentricity", 0.01506),
+        F("d_Cus", &Gps_Ephemeris::d_Cus, "Cus", 1.1379e-05),
+        F("d_sqrt_A", &Gps_Ephemeris::d_sqrt_A, "sqrt_A", 3.2586),
+        F("d_Toe", &Gps_Ephemeris::d_Toe),
+        F("b_fit_interval_flag", &Gps_Ephemeris::b_fit_interval_flag),
+        F("i_AODO", &Gps_Ephemeris::i_AODO),
+        // Subframe 3
+        F("d_Cic", &Gps_Ephemeris::d_Cic, "Cic", 8.7544e-07),
+        F("d_OMEGA0", &Gps_Ephemeris::d_OMEGA0, "OMEGA0", 6.2831),
+        F("d_Cis", &Gps_Ephemeris::d_Cis, "Cis", 1.0622e-05),
+        F("d_i_0", &Gps_Ephemeris::d_i_0, "i_0", 0.066267),
+        F("d_Crc", &Gps_Ephemeris::d_Crc, "Crc", 293.7188),
+        F("d_OMEGA", &Gps_Ephemeris::d_OMEGA, "OMEGA", 6.2832),
+        F("d_OMEGA_DOT", &Gps_Ephemeris::d_OMEGA_DOT, "OMEGA_DOT", 1.2847e-09),
+        F("d_IDOT", &Gps_Ephemeris::d_IDOT, "IDOT", 1.3097e-09),
+        // Flags and spares
+        F("d_spare1", &Gps_Ephemeris::d_spare1),
+        F("d_spare2", &Gps_Ephemeris::d_spare2),
+        F("b_integrity_status_flag", &Gps_Ephemeris::b_integrity_status_flag),
+        F("b_alert_flag", &Gps_Ephemeris::b_alert_flag),
+        F("b_antispoofing_flag", &Gps_Ephemeris::b_antispoofing_flag)
+    };
+    return fields;
+}
+
+
+const std::vector<Nav_Field<Gps_Almanac> >& gps_almanac_fields()
+{
+    typedef Nav_Field<Gps_Almanac> F;
+    // i_SV_health is left out, as it is not always in the almanac pages received
+    static const std::vector<F> fields = {
+        F("d_Delta_i", &Gps_Almanac::d_Delta_i),
+        F("d_Toa", &Gps_Almanac::d_Toa),
+        F("d_M_0", &Gps_Almanac::d_M_0),
+        F("d_e_eccentricity", &Gps_Almanac::d_e_eccentricity),
+        F("d_sqrt_A", &Gps_Almanac::d_sqrt_A),
+        F("d_OMEGA0", &Gps_Almanac::d_OMEGA0),
+        F("d_OMEGA", &Gps_Almanac::d_OMEGA),
+        F("d_OMEGA_DOT", &Gps_Almanac::d_OMEGA_DOT),
+        F("d_A_f0", &Gps_Almanac::d_A_f0),
+        F("d_A_f1", &Gps_Almanac::d_A_f1)
+    };
+    return fields;
+}
+
+
+const std::vector<Nav_Field<Gps_Iono> >& gps_iono_fields()
+{
+    typedef Nav_Field<Gps_Iono> F;
+    static const std::vector<F> fields = {
+        F("d_alpha0", &Gps_Iono::d_alpha0),
+        F("d_alpha1", &Gps_Iono::d_alpha1),
+        F("d_alpha2", &Gps_Iono::d_alpha2),
+        F("d_alpha3", &Gps_Iono::d_alpha3),
+        F("d_beta0", &Gps_Iono::d_beta0),
+        F("d_beta1", &Gps_Iono::d_beta1),
+        F("d_beta2", &Gps_Iono::d_beta2),
+        F("d_beta3", &Gps_Iono::d_beta3),
+        F("valid", &Gps_Iono::valid)
+    };
+    return fields;
+}
+
+
+const std::vector<Nav_Field<Gps_Utc_Model> >& gps_utc_fields()
+{
+    typedef Nav_Field<Gps_Utc_Model> F;
+    static const std::vector<F> fields = {
+        F("valid", &Gps_Utc_Model::valid),
+        F("d_A1", &Gps_Utc_Model::d_A1),
+        F("d_A0", &Gps_Utc_Model::d_A0),
+        F("d_t_OT", &Gps_Utc_Model::d_t_OT),
+        F("i_WN_T", &Gps_Utc_Model::i_WN_T),
+        F("d_DeltaT_LS", &Gps_Utc_Model::d_DeltaT_LS),
+        F("i_WN_LSF", &Gps_Utc_Model::i_WN_LSF),
+        F("i_DN", &Gps_Utc_Model::i_DN),
+        F("d_DeltaT_LSF", &Gps_Utc_Model::d_DeltaT_LSF)
+    };
+    return fields;
+}
@@ -0,0 +1,228 @@
+/*!
+ * \file nav_data_fields.h
+ * \brief Tables of the fields of the GPS navigation data structures, used
+ * to compare two of them field by field
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_NAV_DATA_FIELDS_H_
+#define GNSS_SDR_NAV_DATA_FIELDS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "configuration_interface.h"
+#include "gps_almanac.h"
+#include "gps_ephemeris.h"
+#include "gps_iono.h"
+#include "gps_utc_model.h"
+
+/*!
+ * \brief Bit i is set when field i of a table differs. A table has at most
+ * 64 fields.
+ */
+typedef uint64_t Nav_Field_Mask;
+
+/*!
+ * \brief A field of the navigation data structure Nav: its name, the member
+ * holding it and, for the fields whose change between two messages is
+ * checked by the spoofing detector, the Spoofing.<threshold_key> property
+ * of the largest change expected.
+ *
+ * The members are reached through pointers to members rather than offsets,
+ * since the structures are not standard layout.
+ */
+template<class Nav>
+class Nav_Field
+{
+public:
+    Nav_Field(const char* name_, double Nav::* member, const char* threshold_key_ = nullptr, double default_threshold_ = 0.0) :
+        name(name_), threshold_key(threshold_key_), default_threshold(default_threshold_), d_type(Double)
+    {
+        d_member.d = member;
+    }
+    Nav_Field(const char* name_, int Nav::* member) :
+        name(name_), threshold_key(nullptr), default_threshold(0.0), d_type(Int)
+    {
+        d_member.i = member;
+    }
+    Nav_Field(const char* name_, unsigned int Nav::* member) :
+        name(name_), threshold_key(nullptr), default_threshold(0.0), d_type(Unsigned)
+    {
+        d_member.u = member;
+    }
+    Nav_Field(const char* name_, bool Nav::* member) :
+        name(name_), threshold_key(nullptr), default_threshold(0.0), d_type(Bool)
+    {
+        d_member.b = member;
+    }
+
+    //! Value of the field in nav. It is exact for all the integer fields.
+    double value(const Nav& nav) const
+    {
+        switch (d_type)
+        {
+        case Int: return nav.*d_member.i;
+        case Unsigned: return nav.*d_member.u;
+        case Bool: return nav.*d_member.b;
+        default: return nav.*d_member.d;
+        }
+    }
+
+    //! Sets the field in nav to a value returned by value()
+    void set_value(Nav& nav, double x) const
+    {
+        switch (d_type)
+        {
+        case Int: nav.*d_member.i = static_cast<int>(x); break;
+        case Unsigned: nav.*d_member.u = static_cast<unsigned int>(x); break;
+        case Bool: nav.*d_member.b = x != 0.0; break;
+        default: nav.*d_member.d = x;
+        }
+    }
+
+    const char* name;
+    const char* threshold_key;
+    double default_threshold;
+
+private:
+    enum Type { Double, Int, Unsigned, Bool };
+    Type d_type;
+    union
+    {
+        double Nav::* d;
+        int Nav::* i;
+        unsigned int Nav::* u;
+        bool Nav::* b;
+    } d_member;
+};
+
+//! Fields compared between two ephemeris, in subframe order
+const std::vector<Nav_Field<Gps_Ephemeris> >& gps_ephemeris_fields();
+
+//! Fields compared between two almanacs
+const std::vector<Nav_Field<Gps_Almanac> >& gps_almanac_fields();
+
+//! Fields compared between two ionospheric models
+const std::vector<Nav_Field<Gps_Iono> >& gps_iono_fields();
+
+//! Fields compared between two UTC models
+const std::vector<Nav_Field<Gps_Utc_Model> >& gps_utc_fields();
+
+
+//! Bit of the field called name in fields, 0 if there is none
+template<class Nav>
+Nav_Field_Mask nav_field_bit(const std::vector<Nav_Field<Nav> >& fields, const std::string& name)
+{
+    for (unsigned int i = 0; i < fields.size(); i++)
+        {
+            if (name == fields[i].name) return Nav_Field_Mask(1) << i;
+        }
+    return 0;
+}
+
+//! Fields of the checked ones that differ between a and b
+template<class Nav>
+Nav_Field_Mask nav_fields_differ(const std::vector<Nav_Field<Nav> >& fields, const Nav& a, const Nav& b,
+        Nav_Field_Mask checked = ~Nav_Field_Mask(0))
+{
+    Nav_Field_Mask differ = 0;
+    for (unsigned int i = 0; i < fields.size(); i++)
+        {
+            differ |= Nav_Field_Mask(fields[i].value(a) != fields[i].value(b)) << i;
+        }
+    return differ & checked;
+}
+
+/*!
+ * \brief Fields of the checked ones that differ between a and b by more
+ * than relative_tolerance of the larger value, for a copy of the data
+ * rounded to a number of digits, such as a RINEX file
+ */
+template<class Nav>
+Nav_Field_Mask nav_fields_differ_relative(const std::vector<Nav_Field<Nav> >& fields, const Nav& a, const Nav& b,
+        double relative_tolerance, Nav_Field_Mask checked = ~Nav_Field_Mask(0))
+{
+    Nav_Field_Mask differ = 0;
+    for (unsigned int i = 0; i < fields.size(); i++)
+        {
+            const double x = fields[i].value(a);
+            const double y = fields[i].value(b);
+            differ |= Nav_Field_Mask(std::fabs(x - y) > relative_tolerance * std::max(std::fabs(x), std::fabs(y))) << i;
+        }
+    return differ & checked;
+}
+
+/*!
+ * \brief Thresholds of the change of each field, read from the Spoofing.*
+ * properties. Fields without a threshold get a negative one.
+ */
+template<class Nav>
+std::vector<double> nav_field_thresholds(const std::vector<Nav_Field<Nav> >& fields, ConfigurationInterface* configuration)
+{
+    std::vector<double> thresholds(fields.size(), -1.0);
+    for (unsigned int i = 0; i < fields.size(); i++)
+        {
+            if (fields[i].threshold_key)
+                {
+                    thresholds[i] = configuration->property(std::string("Spoofing.") + fields[i].threshold_key, fields[i].default_threshold);
+                }
+        }
+    return thresholds;
+}
+
+//! Fields that changed from a to b by more than their threshold
+template<class Nav>
+Nav_Field_Mask nav_fields_exceed(const std::vector<Nav_Field<Nav> >& fields, const std::vector<double>& thresholds, const Nav& a, const Nav& b)
+{
+    Nav_Field_Mask exceed = 0;
+    for (unsigned int i = 0; i < fields.size(); i++)
+        {
+            exceed |= Nav_Field_Mask(thresholds[i] >= 0.0 && std::fabs(fields[i].value(a) - fields[i].value(b)) > thresholds[i]) << i;
+        }
+    return exceed;
+}
+
+//! One "<name> not the same: <a> <b>" line per field of mask
+template<class Nav>
+std::string nav_fields_report(const std::vector<Nav_Field<Nav> >& fields, Nav_Field_Mask mask, const Nav& a, const Nav& b)
+{
+    std::stringstream report;
+    for (unsigned int i = 0; i < fields.size(); i++)
+        {
+            if (mask & (Nav_Field_Mask(1) << i))
+                {
+                    report << fields[i].name << " not the same: " << fields[i].value(a) << " " << fields[i].value(b) << "\n";
+                }
+        }
+    return report.str();
+}
+
+#endif
@@ -0,0 +1,74 @@
+/*!
+ * \file observables_extrapolation.cc
+ * \brief Pseudoranges of the channels extrapolated to the newest sample of
+ * an epoch, for the low latency observables
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "observables_extrapolation.h"
+#include <algorithm>
+#include "GPS_L1_CA.h"
+
+
+void extrapolate_observables(Gnss_Synchro* synchro, const std::vector<unsigned int>& channels,
+        double Gnss_Synchro::*tow_s, double start_offset_ms)
+{
+    if (channels.empty())
+        {
+            return;
+        }
+    double rx_time_ms = synchro[channels[0]].Prn_timestamp_ms;
+    for (unsigned int n = 1; n < channels.size(); n++)
+        {
+            rx_time_ms = std::max(rx_time_ms, synchro[channels[n]].Prn_timestamp_ms);
+        }
+
+    // TOW of each channel at the reception time: its code runs at (1 + Doppler / carrier) times the nominal rate
+    double reference_tow_s = 0.0;
+    for (unsigned int n = 0; n < channels.size(); n++)
+        {
+            Gnss_Synchro& channel = synchro[channels[n]];
+            double delta_s = (rx_time_ms - channel.Prn_timestamp_ms) / 1000.0;
+            channel.*tow_s += delta_s * (1.0 + channel.Carrier_Doppler_hz / GPS_L1_FREQ_HZ);
+            // the tracking accumulates the phase of the carrier replica, which falls with the Doppler
+            channel.Carrier_phase_rads -= GPS_TWO_PI * channel.Carrier_Doppler_hz * delta_s;
+            channel.Prn_timestamp_ms = rx_time_ms;
+            if (n == 0 || channel.*tow_s > reference_tow_s)
+                {
+                    reference_tow_s = channel.*tow_s;
+                }
+        }
+
+    for (unsigned int n = 0; n < channels.size(); n++)
+        {
+            Gnss_Synchro& channel = synchro[channels[n]];
+            channel.Pseudorange_m = ((reference_tow_s - channel.*tow_s) * 1000.0 + start_offset_ms) * GPS_C_m_ms;
+            channel.Flag_valid_pseudorange = true;
+            channel.*tow_s = reference_tow_s + start_offset_ms / 1000.0;
+        }
+}
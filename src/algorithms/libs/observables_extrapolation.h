@@ -0,0 +1,56 @@
+/*!
+ * \file observables_extrapolation.h
+ * \brief Pseudoranges of the channels extrapolated to the newest sample of
+ * an epoch, for the low latency observables
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_OBSERVABLES_EXTRAPOLATION_H_
+#define GNSS_SDR_OBSERVABLES_EXTRAPOLATION_H_
+
+#include <vector>
+#include "gnss_synchro.h"
+
+/*!
+ * \brief Forms the pseudoranges of the channels of an epoch at a common
+ * reception time, the newest PRN start among them, instead of at the
+ * symbol of the channel with the most recent TOW.
+ *
+ * The TOW of every channel is carried from its own PRN start
+ * (Prn_timestamp_ms) to the reception time with the code rate of its
+ * Doppler, and its carrier phase with the Doppler, so no channel has to
+ * wait for the others nor for the history of the observables. The signals
+ * are in the L1 band (GPS L1 C/A, Galileo E1). tow_s is the TOW field of
+ * the epoch, d_TOW_at_current_symbol or d_TOW_hybrid_at_current_symbol,
+ * which is set to the reception time as in the aligned pseudoranges.
+ * Prn_timestamp_ms is set to the reception time as well.
+ */
+void extrapolate_observables(Gnss_Synchro* synchro, const std::vector<unsigned int>& channels,
+        double Gnss_Synchro::*tow_s, double start_offset_ms);
+
+#endif
@@ -0,0 +1,114 @@
+/*!
+ * \file observables_history.cc
+ * \brief Fixed-capacity carrier phase, Doppler and TOW history of the
+ * observables channels
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "observables_history.h"
+#include <algorithm>
+
+Observables_History::Observables_History(unsigned int n_channels, unsigned int depth) :
+        d_depth(std::max(depth, 1u)),
+        d_tow_s(n_channels * d_depth, 0.0),
+        d_carrier_phase_rads(n_channels * d_depth, 0.0),
+        d_carrier_doppler_hz(n_channels * d_depth, 0.0),
+        d_newest(n_channels, 0),
+        d_size(n_channels, 0)
+{}
+
+
+void Observables_History::push_back(unsigned int channel, double tow_s, double carrier_phase_rads, double carrier_doppler_hz)
+{
+    unsigned int slot = d_newest[channel] + 1;
+    if (slot == d_depth || d_size[channel] == 0)
+        {
+            slot = 0;
+        }
+    unsigned int index = channel * d_depth + slot;
+    d_tow_s[index] = tow_s;
+    d_carrier_phase_rads[index] = carrier_phase_rads;
+    d_carrier_doppler_hz[index] = carrier_doppler_hz;
+    d_newest[channel] = slot;
+    if (d_size[channel] < d_depth)
+        {
+            d_size[channel]++;
+        }
+}
+
+
+void Observables_History::clear(unsigned int channel)
+{
+    d_newest[channel] = 0;
+    d_size[channel] = 0;
+}
+
+
+void Observables_History::linear_fit(unsigned int channel, double delta_s, double& carrier_phase_rads, double& carrier_doppler_hz) const
+{
+    // a ring that is not full holds its samples in slots 0 .. size - 1
+    const unsigned int n = d_size[channel];
+    const unsigned int first = channel * d_depth;
+    const unsigned int newest = first + d_newest[channel];
+    const double* tow = &d_tow_s[first];
+    const double* phase = &d_carrier_phase_rads[first];
+    const double* doppler = &d_carrier_doppler_hz[first];
+    const double t0 = d_tow_s[newest];
+    const double phase0 = d_carrier_phase_rads[newest];
+    const double doppler0 = d_carrier_doppler_hz[newest];
+
+    double sum_t = 0.0;
+    double sum_tt = 0.0;
+    double sum_phase = 0.0;
+    double sum_t_phase = 0.0;
+    double sum_doppler = 0.0;
+    double sum_t_doppler = 0.0;
+    for (unsigned int i = 0; i < n; i++)
+        {
+            double t = tow[i] - t0;
+            double p = phase[i] - phase0;
+            double d = doppler[i] - doppler0;
+            sum_t += t;
+            sum_tt += t * t;
+            sum_phase += p;
+            sum_t_phase += t * p;
+            sum_doppler += d;
+            sum_t_doppler += t * d;
+        }
+
+    const double det = n * sum_tt - sum_t * sum_t;
+    double phase_slope = 0.0;
+    double doppler_slope = 0.0;
+    if (det != 0.0)
+        {
+            phase_slope = (n * sum_t_phase - sum_t * sum_phase) / det;
+            doppler_slope = (n * sum_t_doppler - sum_t * sum_doppler) / det;
+        }
+    carrier_phase_rads = phase0 + (sum_phase - phase_slope * sum_t) / n + phase_slope * delta_s;
+    carrier_doppler_hz = doppler0 + (sum_doppler - doppler_slope * sum_t) / n + doppler_slope * delta_s;
+}
@@ -0,0 +1,84 @@
+/*!
+ * \file observables_history.h
+ * \brief Fixed-capacity carrier phase, Doppler and TOW history of the
+ * observables channels
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_OBSERVABLES_HISTORY_H_
+#define GNSS_SDR_OBSERVABLES_HISTORY_H_
+
+#include <vector>
+
+/*!
+ * \brief Last depth samples of TOW, accumulated carrier phase and carrier
+ * Doppler of every channel of an observables block.
+ *
+ * The three signals are kept as separate arrays (structure of arrays),
+ * with one ring of depth slots per channel, all allocated once in the
+ * constructor. A sample is stored by overwriting the oldest slot, so the
+ * history never allocates nor moves data once the block is running.
+ *
+ * linear_fit() fits a straight line to the whole window by least squares.
+ * The fit does not depend on the order of the samples, so it runs over
+ * the contiguous slots of the ring without unwrapping it, in loops the
+ * compiler vectorizes. Time is taken relative to the newest sample, which
+ * keeps the normal equations well conditioned in spite of TOW values of
+ * up to 604800 s.
+ */
+class Observables_History
+{
+public:
+    Observables_History(unsigned int n_channels, unsigned int depth);
+
+    void push_back(unsigned int channel, double tow_s, double carrier_phase_rads, double carrier_doppler_hz);
+    void clear(unsigned int channel);
+
+    unsigned int size(unsigned int channel) const { return d_size[channel]; }
+    unsigned int depth() const { return d_depth; }
+    bool full(unsigned int channel) const { return d_size[channel] == d_depth; }
+
+    double newest_tow_s(unsigned int channel) const { return d_tow_s[channel * d_depth + d_newest[channel]]; }
+
+    /*!
+     * \brief Evaluates the least squares lines through the carrier phase and
+     * Doppler history of channel at delta_s seconds after its newest TOW.
+     * The channel must hold at least two samples.
+     */
+    void linear_fit(unsigned int channel, double delta_s, double& carrier_phase_rads, double& carrier_doppler_hz) const;
+
+private:
+    unsigned int d_depth;
+    std::vector<double> d_tow_s;
+    std::vector<double> d_carrier_phase_rads;
+    std::vector<double> d_carrier_doppler_hz;
+    std::vector<unsigned int> d_newest;
+    std::vector<unsigned int> d_size;
+};
+
+#endif
@@ -0,0 +1,294 @@
+/*!
+ * \file opencl_program_cache.cc
+ * \brief Builds OpenCL programs once per process and keeps their binaries
+ * on disk for the next runs
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "opencl_program_cache.h"
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <utility>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/thread/mutex.hpp>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+namespace
+{
+typedef std::pair<std::pair<cl_context, cl_device_id>, std::string> Program_Key; // context, device, binary key
+
+boost::mutex programs_mutex;
+std::map<Program_Key, cl_program> programs;
+std::string cache_dir;
+
+
+std::string device_info(cl_device_id device, cl_device_info param)
+{
+    size_t size = 0;
+    if (clGetDeviceInfo(device, param, 0, NULL, &size) != CL_SUCCESS || size == 0)
+        {
+            return "";
+        }
+    std::vector<char> value(size);
+    if (clGetDeviceInfo(device, param, size, value.data(), NULL) != CL_SUCCESS)
+        {
+            return "";
+        }
+    return std::string(value.data());
+}
+
+
+std::string binary_filename(const std::string& key)
+{
+    std::ostringstream name;
+    name << std::hex << std::hash<std::string>()(key) << ".clbin";
+    return (boost::filesystem::path(cache_dir) / name.str()).string();
+}
+
+
+/*
+ * A binary file holds the length of its key, the key, the length of the
+ * binary and the binary. The key is checked, the name is only its hash.
+ */
+bool load_binary(const std::string& filename, const std::string& key, std::vector<unsigned char>& binary)
+{
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        {
+            return false;
+        }
+    uint64_t key_size = 0;
+    file.read(reinterpret_cast<char*>(&key_size), sizeof(key_size));
+    if (!file || key_size != key.size())
+        {
+            return false;
+        }
+    std::string file_key(key_size, '\0');
+    file.read(&file_key[0], key_size);
+    uint64_t binary_size = 0;
+    file.read(reinterpret_cast<char*>(&binary_size), sizeof(binary_size));
+    if (!file || file_key != key || binary_size == 0)
+        {
+            return false;
+        }
+    binary.resize(binary_size);
+    file.read(reinterpret_cast<char*>(binary.data()), binary_size);
+    return static_cast<bool>(file);
+}
+
+
+void save_binary(cl_program program, cl_device_id device, const std::string& filename, const std::string& key)
+{
+    // the program has a binary for each device of its context, built or not
+    cl_uint num_devices = 0;
+    if (clGetProgramInfo(program, CL_PROGRAM_NUM_DEVICES, sizeof(num_devices), &num_devices, NULL) != CL_SUCCESS || num_devices == 0)
+        {
+            return;
+        }
+    std::vector<cl_device_id> devices(num_devices);
+    std::vector<size_t> sizes(num_devices);
+    if (clGetProgramInfo(program, CL_PROGRAM_DEVICES, num_devices * sizeof(cl_device_id), devices.data(), NULL) != CL_SUCCESS
+            || clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, num_devices * sizeof(size_t), sizes.data(), NULL) != CL_SUCCESS)
+        {
+            return;
+        }
+    std::vector<std::vector<unsigned char> > binaries(num_devices);
+    std::vector<unsigned char*> binary_ptrs(num_devices);
+    unsigned int index = num_devices;
+    for (unsigned int i = 0; i < num_devices; i++)
+        {
+            binaries[i].resize(sizes[i]);
+            binary_ptrs[i] = sizes[i] > 0 ? binaries[i].data() : NULL;
+            if (devices[i] == device)
+                {
+                    index = i;
+                }
+        }
+    if (index == num_devices || sizes[index] == 0
+            || clGetProgramInfo(program, CL_PROGRAM_BINARIES, num_devices * sizeof(unsigned char*), binary_ptrs.data(), NULL) != CL_SUCCESS)
+        {
+            return;
+        }
+
+    // written aside and renamed, so that another receiver never loads half a file
+    std::string temp_filename = filename + ".tmp";
+    {
+        std::ofstream file(temp_filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        uint64_t key_size = key.size();
+        uint64_t binary_size = sizes[index];
+        file.write(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
+        file.write(key.data(), key_size);
+        file.write(reinterpret_cast<const char*>(&binary_size), sizeof(binary_size));
+        file.write(reinterpret_cast<const char*>(binaries[index].data()), binary_size);
+        if (!file)
+            {
+                LOG(WARNING) << "Unable to save the OpenCL program binary " << filename;
+                return;
+            }
+    }
+    boost::system::error_code ec;
+    boost::filesystem::rename(temp_filename, filename, ec);
+    if (ec)
+        {
+            LOG(WARNING) << "Unable to save the OpenCL program binary " << filename << ": " << ec.message();
+            return;
+        }
+    DLOG(INFO) << "OpenCL program binary saved to " << filename;
+}
+}
+
+
+cl_program Opencl_Program_Cache::build(cl_context context, cl_device_id device, const std::string& source,
+        const std::string& options, cl_int* error_code)
+{
+    std::string key = device_info(device, CL_DEVICE_NAME) + "\n" + device_info(device, CL_DEVICE_VENDOR) + "\n"
+            + device_info(device, CL_DRIVER_VERSION) + "\n" + options + "\n" + source;
+    Program_Key program_key(std::make_pair(context, device), key);
+    std::string filename;
+    {
+        boost::mutex::scoped_lock lock(programs_mutex);
+        std::map<Program_Key, cl_program>::iterator it = programs.find(program_key);
+        if (it != programs.end())
+            {
+                clRetainProgram(it->second);
+                if (error_code)
+                    {
+                        *error_code = CL_SUCCESS;
+                    }
+                return it->second;
+            }
+        if (!cache_dir.empty())
+            {
+                filename = binary_filename(key);
+            }
+    }
+
+    cl_int err = CL_SUCCESS;
+    cl_program program = 0;
+    std::vector<unsigned char> binary;
+    if (!filename.empty() && load_binary(filename, key, binary))
+        {
+            const unsigned char* binary_ptr = binary.data();
+            size_t binary_size = binary.size();
+            cl_int binary_status = CL_SUCCESS;
+            program = clCreateProgramWithBinary(context, 1, &device, &binary_size, &binary_ptr, &binary_status, &err);
+            if (err == CL_SUCCESS && binary_status == CL_SUCCESS)
+                {
+                    err = clBuildProgram(program, 1, &device, options.c_str(), NULL, NULL);
+                }
+            if (err != CL_SUCCESS || binary_status != CL_SUCCESS)
+                {
+                    LOG(WARNING) << "Unable to load the OpenCL program binary " << filename << ", building it from source";
+                    if (program)
+                        {
+                            clReleaseProgram(program);
+                        }
+                    program = 0;
+                }
+            else
+                {
+                    DLOG(INFO) << "OpenCL program loaded from " << filename;
+                }
+        }
+
+    if (program == 0)
+        {
+            const char* source_str = source.c_str();
+            size_t source_size = source.size();
+            program = clCreateProgramWithSource(context, 1, &source_str, &source_size, &err);
+            if (err != CL_SUCCESS)
+                {
+                    if (error_code)
+                        {
+                            *error_code = err;
+                        }
+                    return 0;
+                }
+            err = clBuildProgram(program, 1, &device, options.c_str(), NULL, NULL);
+            if (err != CL_SUCCESS)
+                {
+                    if (error_code)
+                        {
+                            *error_code = err;
+                        }
+                    return program;
+                }
+            if (!filename.empty())
+                {
+                    save_binary(program, device, filename, key);
+                }
+        }
+
+    if (error_code)
+        {
+            *error_code = CL_SUCCESS;
+        }
+    boost::mutex::scoped_lock lock(programs_mutex);
+    std::pair<std::map<Program_Key, cl_program>::iterator, bool> inserted = programs.insert(std::make_pair(program_key, program));
+    if (!inserted.second)
+        {
+            // built by another thread in the meantime
+            clReleaseProgram(program);
+            program = inserted.first->second;
+        }
+    clRetainProgram(program); // one reference for the cache, one for the caller
+    return program;
+}
+
+
+void Opencl_Program_Cache::set_cache_dir(const std::string& dirname)
+{
+    if (!dirname.empty())
+        {
+            boost::system::error_code ec;
+            boost::filesystem::create_directories(dirname, ec);
+            if (ec)
+                {
+                    LOG(WARNING) << "Unable to create the OpenCL program cache " << dirname << ": " << ec.message();
+                }
+        }
+    boost::mutex::scoped_lock lock(programs_mutex);
+    cache_dir = dirname;
+}
+
+
+void Opencl_Program_Cache::clear()
+{
+    boost::mutex::scoped_lock lock(programs_mutex);
+    for (std::map<Program_Key, cl_program>::iterator it = programs.begin(); it != programs.end(); ++it)
+        {
+            clReleaseProgram(it->second);
+        }
+    programs.clear();
+}
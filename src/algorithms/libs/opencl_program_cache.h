@@ -0,0 +1,82 @@
+/*!
+ * \file opencl_program_cache.h
+ * \brief Builds OpenCL programs once per process and keeps their binaries
+ * on disk for the next runs
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_OPENCL_PROGRAM_CACHE_H_
+#define GNSS_SDR_OPENCL_PROGRAM_CACHE_H_
+
+#include <string>
+
+#ifdef __APPLE__
+    #include <OpenCL/opencl.h>
+#else
+    #include <CL/cl.h>
+#endif
+
+/*!
+ * \brief Process-wide cache of built OpenCL programs.
+ *
+ * The FFT kernels of clFFT are generated for each transform size, and every
+ * acquisition channel used to compile the same source again. A program is
+ * now built once per context, device, source and build options, and the
+ * next requests get the same program, retained.
+ *
+ * If a cache directory is set (GNSS-SDR.opencl_cache_dir), the binary of
+ * each program built from source is also saved there, from
+ * clGetProgramInfo(CL_PROGRAM_BINARIES), and loaded instead of the source
+ * by the next runs. The file is keyed by the device name, the driver
+ * version, the build options and the source, which holds the FFT size, so
+ * a driver update or a new size just builds and saves again. All the
+ * functions are thread-safe.
+ */
+class Opencl_Program_Cache
+{
+public:
+    /*!
+     * \brief Returns the program of source built for device with options.
+     *
+     * The caller owns one reference to it and releases it with
+     * clReleaseProgram(). If the build fails, *error_code holds the error
+     * and the program is still returned, for its build log, but not cached.
+     * It returns 0 if not even the program could be created.
+     */
+    static cl_program build(cl_context context, cl_device_id device, const std::string& source,
+            const std::string& options, cl_int* error_code);
+
+    /*!
+     * \brief Sets the directory of the program binaries, creating it if
+     * needed. An empty name keeps the binaries in memory only.
+     */
+    static void set_cache_dir(const std::string& dirname);
+
+    static void clear(); //!< Releases the programs kept in memory
+};
+
+#endif
@@ -0,0 +1,216 @@
+/*!
+ * \file receiver_checkpoint.cc
+ * \brief Implementation of the checkpoint file of the receiver
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "receiver_checkpoint.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <boost/crc.hpp>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+namespace
+{
+    const char checkpoint_magic[8] = {'S', 'D', 'C', 'H', 'E', 'C', 'K', 'P'};
+    const uint32_t checkpoint_version = 1;
+    const size_t file_header_bytes = 16; // magic, version, slot_bytes
+
+    // Each slot: uint64 sequence (0 if empty), double wall time, uint32 length, uint32 CRC and the payload
+    const size_t slot_header_bytes = 24;
+
+    size_t file_bytes(uint32_t slot_bytes)
+    {
+        return file_header_bytes + 2 * (slot_header_bytes + slot_bytes);
+    }
+
+    uint32_t crc(const char* data, size_t length)
+    {
+        boost::crc_32_type crc32;
+        crc32.process_bytes(data, length);
+        return crc32.checksum();
+    }
+
+    // Sequence of a complete checkpoint in the slot, 0 if there is none
+    uint64_t valid_sequence(const char* slot, uint32_t slot_bytes)
+    {
+        uint64_t sequence;
+        uint32_t length;
+        uint32_t checksum;
+        std::memcpy(&sequence, slot, sizeof(sequence));
+        std::memcpy(&length, slot + 16, sizeof(length));
+        std::memcpy(&checksum, slot + 20, sizeof(checksum));
+        if (sequence == 0 || length > slot_bytes || crc(slot + slot_header_bytes, length) != checksum)
+            {
+                return 0;
+            }
+        return sequence;
+    }
+}
+
+
+Receiver_Checkpoint::Receiver_Checkpoint(const std::string& filename, unsigned int slot_bytes) :
+    d_map(0), d_map_bytes(0), d_slot_bytes(slot_bytes), d_sequence(0)
+{
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd == -1)
+        {
+            LOG(WARNING) << "Unable to open the checkpoint file " << filename << ": " << strerror(errno);
+            return;
+        }
+
+    // keep the slots of an existing checkpoint file
+    bool existing = false;
+    struct stat file_status;
+    if (fstat(fd, &file_status) == 0 && static_cast<size_t>(file_status.st_size) >= file_header_bytes)
+        {
+            char header[file_header_bytes];
+            uint32_t version;
+            uint32_t existing_slot_bytes;
+            if (pread(fd, header, file_header_bytes, 0) == static_cast<ssize_t>(file_header_bytes))
+                {
+                    std::memcpy(&version, header + 8, sizeof(version));
+                    std::memcpy(&existing_slot_bytes, header + 12, sizeof(existing_slot_bytes));
+                    existing = std::memcmp(header, checkpoint_magic, sizeof(checkpoint_magic)) == 0
+                            && version == checkpoint_version
+                            && static_cast<size_t>(file_status.st_size) == file_bytes(existing_slot_bytes);
+                    if (existing)
+                        {
+                            d_slot_bytes = existing_slot_bytes;
+                        }
+                }
+        }
+    if (!existing)
+        {
+            if (ftruncate(fd, 0) != 0 || ftruncate(fd, file_bytes(d_slot_bytes)) != 0)
+                {
+                    LOG(WARNING) << "Unable to size the checkpoint file " << filename << ": " << strerror(errno);
+                    close(fd);
+                    return;
+                }
+        }
+
+    d_map_bytes = file_bytes(d_slot_bytes);
+    void* map = mmap(0, d_map_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps the file open
+    if (map == MAP_FAILED)
+        {
+            LOG(WARNING) << "Unable to map the checkpoint file " << filename << ": " << strerror(errno);
+            d_map_bytes = 0;
+            return;
+        }
+    d_map = static_cast<char*>(map);
+
+    if (!existing)
+        {
+            std::memcpy(d_map, checkpoint_magic, sizeof(checkpoint_magic));
+            std::memcpy(d_map + 8, &checkpoint_version, sizeof(checkpoint_version));
+            std::memcpy(d_map + 12, &d_slot_bytes, sizeof(d_slot_bytes));
+        }
+    d_sequence = std::max(valid_sequence(slot(0), d_slot_bytes), valid_sequence(slot(1), d_slot_bytes));
+    LOG(INFO) << "Checkpoint file " << filename << ", last checkpoint " << d_sequence;
+}
+
+
+Receiver_Checkpoint::~Receiver_Checkpoint()
+{
+    if (d_map)
+        {
+            msync(d_map, d_map_bytes, MS_ASYNC);
+            munmap(d_map, d_map_bytes);
+        }
+}
+
+
+unsigned int Receiver_Checkpoint::capacity() const
+{
+    return d_slot_bytes;
+}
+
+
+char* Receiver_Checkpoint::slot(unsigned int n) const
+{
+    return d_map + file_header_bytes + n * (slot_header_bytes + d_slot_bytes);
+}
+
+
+bool Receiver_Checkpoint::save(const std::string& payload, double wall_time_s)
+{
+    if (!d_map || payload.size() > d_slot_bytes)
+        {
+            return false;
+        }
+    uint64_t sequence = d_sequence + 1;
+    char* s = slot(sequence % 2);
+    uint64_t empty = 0;
+    uint32_t length = payload.size();
+    uint32_t checksum = crc(payload.data(), payload.size());
+
+    // the slot holds no checkpoint until all of it is written
+    std::memcpy(s, &empty, sizeof(empty));
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(s + 8, &wall_time_s, sizeof(wall_time_s));
+    std::memcpy(s + 16, &length, sizeof(length));
+    std::memcpy(s + 20, &checksum, sizeof(checksum));
+    std::memcpy(s + slot_header_bytes, payload.data(), payload.size());
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(s, &sequence, sizeof(sequence));
+    d_sequence = sequence;
+
+    // writeback in the background, from the page holding the slot
+    long page_bytes = sysconf(_SC_PAGESIZE);
+    size_t begin = (s - d_map) / page_bytes * page_bytes;
+    msync(d_map + begin, (s - d_map) + slot_header_bytes + payload.size() - begin, MS_ASYNC);
+    return true;
+}
+
+
+bool Receiver_Checkpoint::load(std::string& payload, double& wall_time_s) const
+{
+    if (!d_map)
+        {
+            return false;
+        }
+    uint64_t sequence[2] = {valid_sequence(slot(0), d_slot_bytes), valid_sequence(slot(1), d_slot_bytes)};
+    if (sequence[0] == 0 && sequence[1] == 0)
+        {
+            return false;
+        }
+    const char* s = slot(sequence[1] > sequence[0] ? 1 : 0);
+    uint32_t length;
+    std::memcpy(&wall_time_s, s + 8, sizeof(wall_time_s));
+    std::memcpy(&length, s + 16, sizeof(length));
+    payload.assign(s + slot_header_bytes, length);
+    return true;
+}
@@ -0,0 +1,120 @@
+/*!
+ * \file receiver_checkpoint.h
+ * \brief File mapped in memory that keeps the state of the receiver and of
+ * the spoofing detector across restarts
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_RECEIVER_CHECKPOINT_H_
+#define GNSS_SDR_RECEIVER_CHECKPOINT_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/*!
+ * \brief Payload of a checkpoint: values appended in host byte order, and
+ * read back in the same order.
+ */
+class Checkpoint_Buffer
+{
+public:
+    Checkpoint_Buffer() : d_position(0) {}
+    explicit Checkpoint_Buffer(const std::string& data) : d_data(data), d_position(0) {}
+
+    template<typename T>
+    void put(const T& value)
+    {
+        d_data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    //! Reads the next value, false if the payload is too short
+    template<typename T>
+    bool get(T& value)
+    {
+        if (d_position + sizeof(T) > d_data.size())
+            {
+                return false;
+            }
+        std::memcpy(&value, d_data.data() + d_position, sizeof(T));
+        d_position += sizeof(T);
+        return true;
+    }
+
+    const std::string& data() const { return d_data; }
+
+private:
+    std::string d_data;
+    size_t d_position;
+};
+
+
+/*!
+ * \brief Keeps the last checkpoint of the receiver in a file mapped in
+ * memory, so that a restarted receiver takes up where it stopped.
+ *
+ * The file holds two slots, each one with a sequence number, the wall
+ * clock time of the checkpoint, and the CRC of the payload. save() writes
+ * the slot of the older checkpoint and its sequence number last, so a
+ * process that dies in the middle of a save leaves the previous checkpoint
+ * to load(). Saving copies the payload into the page cache and leaves the
+ * writeback to the kernel, so it costs no system call but an asynchronous
+ * msync, and survives the crash of the process, but not of the machine
+ * before the writeback.
+ */
+class Receiver_Checkpoint
+{
+public:
+    /*!
+     * \param slot_bytes - largest payload; a file written with a different
+     * one is kept as it is
+     */
+    Receiver_Checkpoint(const std::string& filename, unsigned int slot_bytes = 1 << 20);
+    ~Receiver_Checkpoint();
+
+    bool is_open() const { return d_map != 0; }
+    unsigned int capacity() const; //!< Largest payload [bytes]
+
+    //! false if the file is not open or the payload does not fit
+    bool save(const std::string& payload, double wall_time_s);
+
+    //! The newest checkpoint that is complete, false if there is none
+    bool load(std::string& payload, double& wall_time_s) const;
+
+private:
+    Receiver_Checkpoint(const Receiver_Checkpoint&);
+    Receiver_Checkpoint& operator=(const Receiver_Checkpoint&);
+
+    char* slot(unsigned int n) const;
+
+    char* d_map;
+    size_t d_map_bytes;
+    uint32_t d_slot_bytes;
+    uint64_t d_sequence; // of the newest checkpoint in the file
+};
+
+#endif
@@ -0,0 +1,344 @@
+/*!
+ * \file rinex_nav_reader.cc
+ * \brief Streaming parser of the GPS records of RINEX 2 and 3 navigation files
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "rinex_nav_reader.h"
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+const int RINEX_GPS_EPOCH_DAYS = 3657; // 1980-01-06 in days since 1970-01-01
+
+//! Value of the fixed-width column [start, start + width) of line, 0 if blank
+double rinex_double(const char* line, size_t length, size_t start, size_t width)
+{
+    char field[32];
+    size_t n = 0;
+    for (size_t i = start; i < start + width && i < length && n < sizeof(field) - 1; i++)
+        {
+            field[n++] = (line[i] == 'D' || line[i] == 'd') ? 'E' : line[i];
+        }
+    field[n] = '\0';
+    return std::strtod(field, 0);
+}
+
+
+int rinex_int(const char* line, size_t length, size_t start, size_t width)
+{
+    char field[32];
+    size_t n = 0;
+    for (size_t i = start; i < start + width && i < length && n < sizeof(field) - 1; i++)
+        {
+            field[n++] = line[i];
+        }
+    field[n] = '\0';
+    return static_cast<int>(std::strtol(field, 0, 10));
+}
+
+
+bool rinex_label(const char* line, size_t length, const char* label)
+{
+    size_t label_length = std::strlen(label);
+    return length >= 60 + label_length && std::strncmp(line + 60, label, label_length) == 0;
+}
+
+
+//! Days since 1970-01-01 of a date of the proleptic Gregorian calendar
+int days_from_civil(int year, int month, int day)
+{
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int year_of_era = year - era * 400;
+    const int day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+
+//! URA index of a user range accuracy in meters (IS-GPS-200E 20.3.3.3.1.3)
+int ura_index(double ura_m)
+{
+    static const double ura_max_m[15] = {2.4, 3.4, 4.85, 6.85, 9.65, 13.65, 24.0, 48.0,
+            96.0, 192.0, 384.0, 768.0, 1536.0, 3072.0, 6144.0};
+    int index = 0;
+    while (index < 15 && ura_m > ura_max_m[index])
+        {
+            index++;
+        }
+    return index;
+}
+}
+
+
+Rinex_Nav_Reader::Rinex_Nav_Reader()
+{
+    reset();
+}
+
+
+void Rinex_Nav_Reader::reset()
+{
+    d_lines = 0;
+    d_navigation = false;
+    d_header = false;
+    d_version = 0.0;
+    d_alpha = false;
+    d_beta = false;
+    d_records.clear();
+    d_iono = Gps_Iono();
+    d_utc = Gps_Utc_Model();
+    d_gps_record = false;
+    d_record_lines = 0;
+}
+
+
+bool Rinex_Nav_Reader::read_file(const std::string& filename)
+{
+    reset();
+    std::FILE* file = std::fopen(filename.c_str(), "r");
+    if (file == 0)
+        {
+            return false;
+        }
+    char line[256];
+    while (std::fgets(line, sizeof(line), file) != 0)
+        {
+            size_t length = std::strlen(line);
+            bool complete = length > 0 && line[length - 1] == '\n';
+            while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r'))
+                {
+                    length--;
+                }
+            add_line(line, length);
+            // the columns past the buffer are not part of the format
+            int c = 0;
+            while (!complete && (c = std::fgetc(file)) != EOF && c != '\n') {}
+            if (!d_navigation)
+                {
+                    break;
+                }
+        }
+    std::fclose(file);
+    return d_navigation;
+}
+
+
+void Rinex_Nav_Reader::add_line(const char* line, size_t length)
+{
+    if (d_lines++ == 0)
+        {
+            if (rinex_label(line, length, "RINEX VERSION / TYPE"))
+                {
+                    d_version = rinex_double(line, length, 0, 9);
+                    const char type = length > 20 ? line[20] : ' ';
+                    const char system = length > 40 ? line[40] : ' ';
+                    d_navigation = type == 'N' && (d_version < 3.0 || system == 'G' || system == 'M');
+                    d_header = true;
+                }
+            return;
+        }
+    if (!d_navigation)
+        {
+            return;
+        }
+    if (d_header)
+        {
+            add_header_line(line, length);
+            return;
+        }
+
+    const bool version3 = d_version >= 3.0;
+    const bool record_start = version3 ? (length > 0 && std::isalpha(static_cast<unsigned char>(line[0])))
+            : (length > 1 && std::isdigit(static_cast<unsigned char>(line[1])));
+    if (record_start)
+        {
+            // an incomplete record before is dropped
+            d_record_lines = 1;
+            size_t values_start;
+            if (version3)
+                {
+                    d_gps_record = line[0] == 'G';
+                    d_prn = rinex_int(line, length, 1, 2);
+                    d_epoch[0] = rinex_int(line, length, 4, 4);
+                    d_epoch[1] = rinex_int(line, length, 9, 2);
+                    d_epoch[2] = rinex_int(line, length, 12, 2);
+                    d_epoch[3] = rinex_int(line, length, 15, 2);
+                    d_epoch[4] = rinex_int(line, length, 18, 2);
+                    d_epoch_s = rinex_int(line, length, 21, 2);
+                    values_start = 23;
+                }
+            else
+                {
+                    d_gps_record = true;
+                    d_prn = rinex_int(line, length, 0, 2);
+                    d_epoch[0] = rinex_int(line, length, 2, 3);
+                    d_epoch[0] += d_epoch[0] < 80 ? 2000 : 1900;
+                    d_epoch[1] = rinex_int(line, length, 5, 3);
+                    d_epoch[2] = rinex_int(line, length, 8, 3);
+                    d_epoch[3] = rinex_int(line, length, 11, 3);
+                    d_epoch[4] = rinex_int(line, length, 14, 3);
+                    d_epoch_s = rinex_double(line, length, 17, 5);
+                    values_start = 22;
+                }
+            if (d_gps_record)
+                {
+                    for (unsigned int i = 0; i < 3; i++)
+                        {
+                            d_values[i] = rinex_double(line, length, values_start + 19 * i, 19);
+                        }
+                }
+            return;
+        }
+    if (d_record_lines == 0 || d_record_lines >= 8)
+        {
+            return;
+        }
+    if (d_gps_record)
+        {
+            const size_t values_start = version3 ? 4 : 3;
+            for (unsigned int i = 0; i < 4; i++)
+                {
+                    d_values[3 + 4 * (d_record_lines - 1) + i] = rinex_double(line, length, values_start + 19 * i, 19);
+                }
+        }
+    if (++d_record_lines == 8 && d_gps_record)
+        {
+            end_record();
+        }
+}
+
+
+void Rinex_Nav_Reader::add_header_line(const char* line, size_t length)
+{
+    if (rinex_label(line, length, "END OF HEADER"))
+        {
+            d_header = false;
+        }
+    else if (rinex_label(line, length, "ION ALPHA")
+            || (rinex_label(line, length, "IONOSPHERIC CORR") && std::strncmp(line, "GPSA", 4) == 0))
+        {
+            const size_t start = d_version >= 3.0 ? 5 : 2;
+            d_iono.d_alpha0 = rinex_double(line, length, start, 12);
+            d_iono.d_alpha1 = rinex_double(line, length, start + 12, 12);
+            d_iono.d_alpha2 = rinex_double(line, length, start + 24, 12);
+            d_iono.d_alpha3 = rinex_double(line, length, start + 36, 12);
+            d_alpha = true;
+        }
+    else if (rinex_label(line, length, "ION BETA")
+            || (rinex_label(line, length, "IONOSPHERIC CORR") && std::strncmp(line, "GPSB", 4) == 0))
+        {
+            const size_t start = d_version >= 3.0 ? 5 : 2;
+            d_iono.d_beta0 = rinex_double(line, length, start, 12);
+            d_iono.d_beta1 = rinex_double(line, length, start + 12, 12);
+            d_iono.d_beta2 = rinex_double(line, length, start + 24, 12);
+            d_iono.d_beta3 = rinex_double(line, length, start + 36, 12);
+            d_beta = true;
+        }
+    else if (rinex_label(line, length, "DELTA-UTC: A0,A1,T,W"))
+        {
+            d_utc.d_A0 = rinex_double(line, length, 3, 19);
+            d_utc.d_A1 = rinex_double(line, length, 22, 19);
+            d_utc.d_t_OT = rinex_int(line, length, 41, 9);
+            d_utc.i_WN_T = rinex_int(line, length, 50, 9) % 256;
+            d_utc.valid = true;
+        }
+    else if (rinex_label(line, length, "TIME SYSTEM CORR") && std::strncmp(line, "GPUT", 4) == 0)
+        {
+            d_utc.d_A0 = rinex_double(line, length, 5, 17);
+            d_utc.d_A1 = rinex_double(line, length, 22, 16);
+            d_utc.d_t_OT = rinex_int(line, length, 38, 7);
+            d_utc.i_WN_T = rinex_int(line, length, 45, 5) % 256;
+            d_utc.valid = true;
+        }
+    else if (rinex_label(line, length, "LEAP SECONDS"))
+        {
+            d_utc.d_DeltaT_LS = rinex_int(line, length, 0, 6);
+            d_utc.d_DeltaT_LSF = d_utc.d_DeltaT_LS;
+            if (d_version >= 3.0 && length > 12 && line[11] != ' ')
+                {
+                    d_utc.d_DeltaT_LSF = rinex_int(line, length, 6, 6);
+                    d_utc.i_WN_LSF = rinex_int(line, length, 12, 6) % 256;
+                    d_utc.i_DN = rinex_int(line, length, 18, 6);
+                }
+        }
+    d_iono.valid = d_alpha && d_beta;
+}
+
+
+void Rinex_Nav_Reader::end_record()
+{
+    Rinex_Gps_Record record;
+    Gps_Ephemeris& e = record.ephemeris;
+    const double* v = d_values;
+    e.i_satellite_PRN = d_prn;
+    int days = days_from_civil(d_epoch[0], d_epoch[1], d_epoch[2]) - RINEX_GPS_EPOCH_DAYS;
+    e.d_Toc = (days % 7) * 86400.0 + d_epoch[3] * 3600.0 + d_epoch[4] * 60.0 + d_epoch_s;
+    e.d_A_f0 = v[0];
+    e.d_A_f1 = v[1];
+    e.d_A_f2 = v[2];
+    e.d_IODE_SF2 = v[3];
+    e.d_IODE_SF3 = v[3];
+    e.d_Crs = v[4];
+    e.d_Delta_n = v[5];
+    e.d_M_0 = v[6];
+    e.d_Cuc = v[7];
+    e.d_e_eccentricity = v[8];
+    e.d_Cus = v[9];
+    e.d_sqrt_A = v[10];
+    e.d_Toe = v[11];
+    e.d_Cic = v[12];
+    e.d_OMEGA0 = v[13];
+    e.d_Cis = v[14];
+    e.d_i_0 = v[15];
+    e.d_Crc = v[16];
+    e.d_OMEGA = v[17];
+    e.d_OMEGA_DOT = v[18];
+    e.d_IDOT = v[19];
+    e.i_code_on_L2 = static_cast<int>(v[20]);
+    record.week = static_cast<int>(v[21]);
+    e.i_GPS_week = record.week % 1024;
+    e.b_L2_P_data_flag = v[22] != 0.0;
+    e.i_SV_accuracy = ura_index(v[23]);
+    e.i_SV_health = static_cast<int>(v[24]);
+    e.d_TGD = v[25];
+    e.d_IODC = v[26];
+    // the transmission time may be given relative to the week of Toe
+    e.d_TOW = std::fmod(v[27], 604800.0);
+    if (e.d_TOW < 0.0)
+        {
+            e.d_TOW += 604800.0;
+        }
+    e.b_fit_interval_flag = v[28] > 4.0;
+    d_records.push_back(record);
+}
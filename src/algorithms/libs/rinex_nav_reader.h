@@ -0,0 +1,117 @@
+/*!
+ * \file rinex_nav_reader.h
+ * \brief Streaming parser of the GPS records of RINEX 2 and 3 navigation files
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_RINEX_NAV_READER_H_
+#define GNSS_SDR_RINEX_NAV_READER_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "gps_ephemeris.h"
+#include "gps_iono.h"
+#include "gps_utc_model.h"
+
+/*!
+ * \brief GPS ephemeris of a navigation file, with the continuous week of
+ * its Toe (the ephemeris keeps the 10 bits of the broadcast week).
+ */
+struct Rinex_Gps_Record
+{
+    Gps_Ephemeris ephemeris;
+    int week;
+
+    //! Toe in seconds since the GPS epoch
+    double toe_gps_s() const { return week * 604800.0 + ephemeris.d_Toe; }
+};
+
+
+/*!
+ * \brief Reads the GPS records, ionospheric model and UTC model of RINEX
+ * 2.x GPS navigation files and RINEX 3.x GPS or mixed navigation files
+ * (the records of the other systems are skipped).
+ *
+ * The file is fed line by line, and each value is converted in place from
+ * its fixed-width column, Fortran 'D' exponents included: nothing is
+ * tokenized, and no stream is involved.
+ */
+class Rinex_Nav_Reader
+{
+public:
+    Rinex_Nav_Reader();
+
+    void reset();
+
+    /*!
+     * \brief Parses the next line of the file, without its end of line
+     */
+    void add_line(const char* line, size_t length);
+
+    /*!
+     * \brief Parses a whole file, after a reset()
+     * \return false if it cannot be read or is not a GPS navigation file
+     */
+    bool read_file(const std::string& filename);
+
+    //! The first line was a RINEX GPS or mixed navigation header
+    bool is_navigation() const { return d_navigation; }
+    double version() const { return d_version; }
+
+    //! Complete GPS records, in file order
+    const std::vector<Rinex_Gps_Record>& records() const { return d_records; }
+
+    //! From the header, valid if it had the parameters
+    const Gps_Iono& iono() const { return d_iono; }
+    const Gps_Utc_Model& utc() const { return d_utc; }
+
+private:
+    void add_header_line(const char* line, size_t length);
+    void end_record();
+
+    unsigned int d_lines;
+    bool d_navigation;
+    bool d_header;
+    double d_version;
+    bool d_alpha;
+    bool d_beta;
+    std::vector<Rinex_Gps_Record> d_records;
+    Gps_Iono d_iono;
+    Gps_Utc_Model d_utc;
+
+    // record being read
+    bool d_gps_record;
+    unsigned int d_record_lines;
+    unsigned int d_prn;
+    int d_epoch[5];       // year, month, day, hour, minute of Toc
+    double d_epoch_s;
+    double d_values[31];
+};
+
+#endif
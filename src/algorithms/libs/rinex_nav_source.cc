@@ -0,0 +1,236 @@
+/*!
+ * \file rinex_nav_source.cc
+ * \brief Keeps the GPS navigation data of the RINEX files of a directory, re-reading them when they change
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "rinex_nav_source.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <boost/bind.hpp>
+#include <glog/logging.h>
+#include "rinex_nav_reader.h"
+
+
+Rinex_Nav_Source::Rinex_Nav_Source(const std::string& path) :
+        d_path(path),
+        d_stop(false)
+{}
+
+
+Rinex_Nav_Source::~Rinex_Nav_Source()
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_stop = true;
+    }
+    d_cond.notify_all();
+    if (d_thread.joinable())
+        {
+            d_thread.join();
+        }
+}
+
+
+void Rinex_Nav_Source::start(double period_s, Callback on_update)
+{
+    d_on_update = on_update;
+    d_thread = boost::thread(boost::bind(&Rinex_Nav_Source::run, this, period_s));
+}
+
+
+void Rinex_Nav_Source::run(double period_s)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    while (!d_stop)
+        {
+            lock.unlock();
+            if (poll() && d_on_update)
+                {
+                    d_on_update();
+                }
+            lock.lock();
+            d_cond.wait_for(lock, boost::chrono::milliseconds(static_cast<long long>(period_s * 1000.0)));
+        }
+}
+
+
+std::vector<std::string> Rinex_Nav_Source::files() const
+{
+    std::vector<std::string> names;
+    struct stat status;
+    if (stat(d_path.c_str(), &status) != 0)
+        {
+            return names;
+        }
+    if (!S_ISDIR(status.st_mode))
+        {
+            names.push_back(d_path);
+            return names;
+        }
+    DIR* directory = opendir(d_path.c_str());
+    if (directory == 0)
+        {
+            return names;
+        }
+    struct dirent* entry;
+    while ((entry = readdir(directory)) != 0)
+        {
+            std::string name(entry->d_name);
+            if (name.empty() || name[0] == '.' || (name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0))
+                {
+                    continue;
+                }
+            names.push_back(d_path + "/" + name);
+        }
+    closedir(directory);
+    return names;
+}
+
+
+bool Rinex_Nav_Source::poll(std::vector<unsigned int>* updated)
+{
+    boost::mutex::scoped_lock poll_lock(d_poll_mutex);
+    bool found = false;
+    std::vector<std::string> names = files();
+    Rinex_Nav_Reader reader;
+    for (unsigned int n = 0; n < names.size(); n++)
+        {
+            struct stat status;
+            if (stat(names[n].c_str(), &status) != 0 || !S_ISREG(status.st_mode))
+                {
+                    continue;
+                }
+            std::pair<std::time_t, long long> version(status.st_mtime, status.st_size);
+            std::map<std::string, std::pair<std::time_t, long long> >::const_iterator read = d_read.find(names[n]);
+            if (read != d_read.end() && read->second == version)
+                {
+                    continue;
+                }
+            d_read[names[n]] = version;
+            if (!reader.read_file(names[n]))
+                {
+                    DLOG(INFO) << "RINEX: " << names[n] << " is not a GPS navigation file";
+                    continue;
+                }
+            unsigned int added = 0;
+            boost::mutex::scoped_lock lock(d_mutex);
+            for (unsigned int i = 0; i < reader.records().size(); i++)
+                {
+                    const Rinex_Gps_Record& record = reader.records()[i];
+                    std::map<double, Gps_Ephemeris>& prn = d_ephemeris[record.ephemeris.i_satellite_PRN];
+                    if (prn.count(record.toe_gps_s()) == 0)
+                        {
+                            added++;
+                            if (updated)
+                                {
+                                    updated->push_back(record.ephemeris.i_satellite_PRN);
+                                }
+                        }
+                    prn[record.toe_gps_s()] = record.ephemeris;
+                }
+            if (reader.iono().valid)
+                {
+                    d_iono = reader.iono();
+                    found = true;
+                }
+            if (reader.utc().valid)
+                {
+                    d_utc = reader.utc();
+                    found = true;
+                }
+            found = found || added > 0;
+            LOG(INFO) << "RINEX: read " << names[n] << " (version " << reader.version() << "), "
+                      << reader.records().size() << " GPS ephemeris, " << added << " new";
+        }
+    return found;
+}
+
+
+bool Rinex_Nav_Source::get_ephemeris(unsigned int PRN, double toe, double IODE, Gps_Ephemeris& ephemeris) const
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::map<unsigned int, std::map<double, Gps_Ephemeris> >::const_iterator prn = d_ephemeris.find(PRN);
+    if (prn == d_ephemeris.end())
+        {
+            return false;
+        }
+    // the newest week first
+    for (std::map<double, Gps_Ephemeris>::const_reverse_iterator it = prn->second.rbegin(); it != prn->second.rend(); ++it)
+        {
+            if (it->second.d_Toe == toe && it->second.d_IODE_SF2 == IODE)
+                {
+                    ephemeris = it->second;
+                    return true;
+                }
+        }
+    return false;
+}
+
+
+bool Rinex_Nav_Source::get_ephemeris_at(unsigned int PRN, double gps_time_s, Gps_Ephemeris& ephemeris) const
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::map<unsigned int, std::map<double, Gps_Ephemeris> >::const_iterator prn = d_ephemeris.find(PRN);
+    if (prn == d_ephemeris.end() || prn->second.empty())
+        {
+            return false;
+        }
+    std::map<double, Gps_Ephemeris>::const_iterator after = prn->second.lower_bound(gps_time_s);
+    if (after == prn->second.end())
+        {
+            --after;
+        }
+    else if (after != prn->second.begin())
+        {
+            std::map<double, Gps_Ephemeris>::const_iterator before = after;
+            --before;
+            if (gps_time_s - before->first < after->first - gps_time_s)
+                {
+                    after = before;
+                }
+        }
+    ephemeris = after->second;
+    return true;
+}
+
+
+bool Rinex_Nav_Source::get_iono(Gps_Iono& iono) const
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    iono = d_iono;
+    return d_iono.valid;
+}
+
+
+bool Rinex_Nav_Source::get_utc(Gps_Utc_Model& utc) const
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    utc = d_utc;
+    return d_utc.valid;
+}
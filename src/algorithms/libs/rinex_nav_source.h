@@ -0,0 +1,122 @@
+/*!
+ * \file rinex_nav_source.h
+ * \brief Keeps the GPS navigation data of the RINEX files of a directory, re-reading them when they change
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_RINEX_NAV_SOURCE_H_
+#define GNSS_SDR_RINEX_NAV_SOURCE_H_
+
+#include <ctime>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include "gps_ephemeris.h"
+#include "gps_iono.h"
+#include "gps_utc_model.h"
+
+/*!
+ * \brief GPS navigation data of RINEX navigation files (see
+ * Rinex_Nav_Reader), such as the IGS broadcast files.
+ *
+ * The path is a file, or a directory whose files are all tried. poll()
+ * reads the files that are new or changed since the last poll, and
+ * keeps every ephemeris by PRN and Toe, so that a receiver can take the
+ * one in force and a check the one with the Toe it decoded. Files are
+ * fetched into the directory by other means (a download ending with a
+ * rename, so that a file is never read half written; names ending in
+ * .tmp are skipped).
+ *
+ * poll() is either called by the owner, or every period_s by a thread of
+ * the source after start(), which then calls on_update when something
+ * was read. The getters can be called from any thread.
+ */
+class Rinex_Nav_Source
+{
+public:
+    typedef boost::function<void()> Callback;
+
+    explicit Rinex_Nav_Source(const std::string& path);
+
+    /*!
+     * \brief Stops the thread, waiting for a poll in progress to finish.
+     */
+    ~Rinex_Nav_Source();
+
+    /*!
+     * \brief Reads the new and changed files
+     * \return true if they had a new ephemeris, or an iono or UTC model.
+     * The PRNs of the new ephemeris are added to updated.
+     */
+    bool poll(std::vector<unsigned int>* updated = 0);
+
+    void start(double period_s, Callback on_update);
+
+    /*!
+     * \brief Ephemeris of PRN with this Toe and IODE, in any week
+     */
+    bool get_ephemeris(unsigned int PRN, double toe, double IODE, Gps_Ephemeris& ephemeris) const;
+
+    /*!
+     * \brief Ephemeris of PRN whose Toe is closest to gps_time_s, in
+     * seconds since the GPS epoch
+     */
+    bool get_ephemeris_at(unsigned int PRN, double gps_time_s, Gps_Ephemeris& ephemeris) const;
+
+    bool get_iono(Gps_Iono& iono) const;
+    bool get_utc(Gps_Utc_Model& utc) const;
+
+    const std::string& path() const { return d_path; }
+
+private:
+    void run(double period_s);
+    std::vector<std::string> files() const;
+
+    std::string d_path;
+    Callback d_on_update;
+
+    // only used by poll(), one at a time
+    boost::mutex d_poll_mutex;
+    std::map<std::string, std::pair<std::time_t, long long> > d_read; // file -> (mtime, size) when read
+
+    // guarded by d_mutex
+    std::map<unsigned int, std::map<double, Gps_Ephemeris> > d_ephemeris; // PRN -> Toe since the GPS epoch
+    Gps_Iono d_iono;
+    Gps_Utc_Model d_utc;
+    bool d_stop;
+    mutable boost::mutex d_mutex;
+    boost::condition_variable d_cond;
+    boost::thread d_thread;
+};
+
+#endif
@@ -0,0 +1,500 @@
+/*!
+ * \file rolling_statistics.cc
+ * \brief Implementation of incremental moving-window mean, variance and
+ * covariance estimators
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "rolling_statistics.h"
+#include <algorithm>
+
+
+Rolling_Statistics::Rolling_Statistics(unsigned int window_size) :
+    d_window(window_size > 0 ? window_size : 1)
+{
+    clear();
+}
+
+
+void Rolling_Statistics::clear()
+{
+    d_window.clear();
+    d_mean = 0.0;
+    d_m2 = 0.0;
+    d_evictions = 0;
+}
+
+
+void Rolling_Statistics::push_back(double x)
+{
+    if (d_window.full())
+        {
+            // remove the oldest sample (inverse Welford update)
+            double old = d_window.front();
+            d_window.pop_front();
+            unsigned int n = d_window.size();
+            if (n == 0)
+                {
+                    d_mean = 0.0;
+                    d_m2 = 0.0;
+                }
+            else
+                {
+                    double mean_prev = d_mean;
+                    d_mean -= (old - d_mean) / n;
+                    d_m2 -= (old - d_mean) * (old - mean_prev);
+                }
+            d_evictions++;
+        }
+
+    d_window.push_back(x);
+    double delta = x - d_mean;
+    d_mean += delta / d_window.size();
+    d_m2 += delta * (x - d_mean);
+
+    if (d_evictions >= d_window.capacity())
+        {
+            recompute();
+        }
+}
+
+
+double Rolling_Statistics::var() const
+{
+    if (d_window.empty())
+        {
+            return 0.0;
+        }
+    // the add/evict updates can leave a tiny negative round-off residue
+    return d_m2 > 0.0 ? d_m2 / d_window.size() : 0.0;
+}
+
+
+void Rolling_Statistics::recompute()
+{
+    d_mean = 0.0;
+    d_m2 = 0.0;
+    unsigned int n = 0;
+    for (boost::circular_buffer<double>::const_iterator it = d_window.begin(); it != d_window.end(); ++it)
+        {
+            n++;
+            double delta = *it - d_mean;
+            d_mean += delta / n;
+            d_m2 += delta * (*it - d_mean);
+        }
+    d_evictions = 0;
+}
+
+
+Rolling_Covariance::Rolling_Covariance(unsigned int window_size) :
+    d_window(window_size > 0 ? window_size : 1)
+{
+    clear();
+}
+
+
+void Rolling_Covariance::clear()
+{
+    d_window.clear();
+    d_mean_x = 0.0;
+    d_mean_y = 0.0;
+    d_m2_x = 0.0;
+    d_m2_y = 0.0;
+    d_c = 0.0;
+    d_evictions = 0;
+}
+
+
+void Rolling_Covariance::push_back(double x, double y)
+{
+    if (d_window.full())
+        {
+            // remove the oldest pair (inverse Welford update)
+            std::pair<double, double> old = d_window.front();
+            d_window.pop_front();
+            unsigned int n = d_window.size();
+            if (n == 0)
+                {
+                    d_mean_x = 0.0;
+                    d_mean_y = 0.0;
+                    d_m2_x = 0.0;
+                    d_m2_y = 0.0;
+                    d_c = 0.0;
+                }
+            else
+                {
+                    double mean_x_prev = d_mean_x;
+                    double mean_y_prev = d_mean_y;
+                    d_mean_x -= (old.first - d_mean_x) / n;
+                    d_mean_y -= (old.second - d_mean_y) / n;
+                    d_m2_x -= (old.first - d_mean_x) * (old.first - mean_x_prev);
+                    d_m2_y -= (old.second - d_mean_y) * (old.second - mean_y_prev);
+                    d_c -= (old.first - d_mean_x) * (old.second - mean_y_prev);
+                }
+            d_evictions++;
+        }
+
+    d_window.push_back(std::make_pair(x, y));
+    unsigned int n = d_window.size();
+    double delta_x = x - d_mean_x;
+    double delta_y = y - d_mean_y;
+    d_mean_x += delta_x / n;
+    d_mean_y += delta_y / n;
+    d_m2_x += delta_x * (x - d_mean_x);
+    d_m2_y += delta_y * (y - d_mean_y);
+    d_c += delta_x * (y - d_mean_y);
+
+    if (d_evictions >= d_window.capacity())
+        {
+            recompute();
+        }
+}
+
+
+double Rolling_Covariance::var_x() const
+{
+    if (d_window.empty())
+        {
+            return 0.0;
+        }
+    return d_m2_x > 0.0 ? d_m2_x / d_window.size() : 0.0;
+}
+
+
+double Rolling_Covariance::var_y() const
+{
+    if (d_window.empty())
+        {
+            return 0.0;
+        }
+    return d_m2_y > 0.0 ? d_m2_y / d_window.size() : 0.0;
+}
+
+
+double Rolling_Covariance::cov() const
+{
+    if (d_window.empty())
+        {
+            return 0.0;
+        }
+    return d_c / d_window.size();
+}
+
+
+void Rolling_Covariance::recompute()
+{
+    d_mean_x = 0.0;
+    d_mean_y = 0.0;
+    d_m2_x = 0.0;
+    d_m2_y = 0.0;
+    d_c = 0.0;
+    unsigned int n = 0;
+    for (boost::circular_buffer<std::pair<double, double> >::const_iterator it = d_window.begin(); it != d_window.end(); ++it)
+        {
+            n++;
+            double delta_x = it->first - d_mean_x;
+            double delta_y = it->second - d_mean_y;
+            d_mean_x += delta_x / n;
+            d_mean_y += delta_y / n;
+            d_m2_x += delta_x * (it->first - d_mean_x);
+            d_m2_y += delta_y * (it->second - d_mean_y);
+            d_c += delta_x * (it->second - d_mean_y);
+        }
+    d_evictions = 0;
+}
+
+
+Rolling_Correlation_Matrix::Rolling_Correlation_Matrix(unsigned int window_size) :
+    d_window_size(window_size > 0 ? window_size : 1)
+{
+    clear();
+}
+
+
+void Rolling_Correlation_Matrix::clear()
+{
+    d_slots = 0;
+    d_head = 0;
+    d_pushes = 0;
+    d_slot_of.clear();
+    d_ids.clear();
+    d_active.clear();
+    d_count.clear();
+    d_offset.clear();
+    d_windows.clear();
+    d_sum.clear();
+    d_sum_sq.clear();
+    d_sum_prod.clear();
+    d_in.clear();
+    d_out.clear();
+    d_out_mask.clear();
+}
+
+
+void Rolling_Correlation_Matrix::grow()
+{
+    unsigned int slots = std::max(2 * d_slots, 4u);
+    std::vector<double> sum(slots * slots, 0.0);
+    std::vector<double> sum_sq(slots * slots, 0.0);
+    std::vector<double> sum_prod(slots * slots, 0.0);
+    for (unsigned int a = 0; a < d_slots; a++)
+        {
+            std::copy(d_sum.begin() + a * d_slots, d_sum.begin() + (a + 1) * d_slots, sum.begin() + a * slots);
+            std::copy(d_sum_sq.begin() + a * d_slots, d_sum_sq.begin() + (a + 1) * d_slots, sum_sq.begin() + a * slots);
+            std::copy(d_sum_prod.begin() + a * d_slots, d_sum_prod.begin() + (a + 1) * d_slots, sum_prod.begin() + a * slots);
+        }
+    d_sum.swap(sum);
+    d_sum_sq.swap(sum_sq);
+    d_sum_prod.swap(sum_prod);
+    d_ids.resize(slots, 0);
+    d_active.resize(slots, 0.0);
+    d_count.resize(slots, 0);
+    d_offset.resize(slots, 0.0);
+    d_windows.resize(slots * d_window_size, 0.0);
+    d_in.resize(slots, 0.0);
+    d_out.resize(slots, 0.0);
+    d_out_mask.resize(slots, 0.0);
+    d_slots = slots;
+}
+
+
+unsigned int Rolling_Correlation_Matrix::add_slot(unsigned int id, double offset)
+{
+    unsigned int slot = std::find(d_active.begin(), d_active.end(), 0.0) - d_active.begin();
+    if (slot == d_slots)
+        {
+            grow();
+        }
+    d_slot_of[id] = slot;
+    d_ids[slot] = id;
+    d_active[slot] = 1.0;
+    d_count[slot] = 0;
+    d_offset[slot] = offset;
+    for (unsigned int b = 0; b < d_slots; b++)
+        {
+            d_sum[slot * d_slots + b] = 0.0;
+            d_sum[b * d_slots + slot] = 0.0;
+            d_sum_sq[slot * d_slots + b] = 0.0;
+            d_sum_sq[b * d_slots + slot] = 0.0;
+            d_sum_prod[slot * d_slots + b] = 0.0;
+            d_sum_prod[b * d_slots + slot] = 0.0;
+        }
+    return slot;
+}
+
+
+void Rolling_Correlation_Matrix::remove(unsigned int id)
+{
+    std::map<unsigned int, unsigned int>::iterator it = d_slot_of.find(id);
+    if (it == d_slot_of.end())
+        {
+            return;
+        }
+    d_active[it->second] = 0.0;
+    d_count[it->second] = 0;
+    d_slot_of.erase(it);
+}
+
+
+void Rolling_Correlation_Matrix::push_back(const std::map<unsigned int, double>& samples)
+{
+    for (std::map<unsigned int, unsigned int>::iterator it = d_slot_of.begin(); it != d_slot_of.end(); )
+        {
+            unsigned int id = it->first;
+            ++it;
+            if (!samples.count(id))
+                {
+                    remove(id);
+                }
+        }
+    for (std::map<unsigned int, double>::const_iterator it = samples.begin(); it != samples.end(); ++it)
+        {
+            std::map<unsigned int, unsigned int>::iterator slot = d_slot_of.find(it->first);
+            unsigned int a = (slot == d_slot_of.end()) ? add_slot(it->first, it->second) : slot->second;
+            d_in[a] = it->second - d_offset[a];
+        }
+
+    // the oldest sample of a full window leaves the pairs where both windows are full
+    for (unsigned int a = 0; a < d_slots; a++)
+        {
+            bool out = d_active[a] != 0.0 and d_count[a] == d_window_size;
+            d_out[a] = out ? d_windows[a * d_window_size + d_head] : 0.0;
+            d_out_mask[a] = out ? 1.0 : 0.0;
+            if (d_active[a] == 0.0)
+                {
+                    d_in[a] = 0.0;
+                }
+        }
+    for (unsigned int a = 0; a < d_slots; a++)
+        {
+            if (d_active[a] == 0.0)
+                {
+                    continue;
+                }
+            double in = d_in[a];
+            double out = d_out[a];
+            double* sum = &d_sum[a * d_slots];
+            double* sum_sq = &d_sum_sq[a * d_slots];
+            double* sum_prod = &d_sum_prod[a * d_slots];
+            for (unsigned int b = 0; b < d_slots; b++)
+                {
+                    sum[b] += in * d_active[b] - out * d_out_mask[b];
+                    sum_sq[b] += in * in * d_active[b] - out * out * d_out_mask[b];
+                    sum_prod[b] += in * d_in[b] - out * d_out[b];
+                }
+        }
+    for (unsigned int a = 0; a < d_slots; a++)
+        {
+            if (d_active[a] != 0.0)
+                {
+                    d_windows[a * d_window_size + d_head] = d_in[a];
+                    d_count[a] = std::min(d_count[a] + 1, d_window_size);
+                }
+        }
+    d_head = (d_head + 1) % d_window_size;
+
+    if (++d_pushes >= d_window_size)
+        {
+            recompute();
+        }
+}
+
+
+void Rolling_Correlation_Matrix::insert(unsigned int id, const std::vector<double>& samples)
+{
+    remove(id);
+    if (samples.empty())
+        {
+            return;
+        }
+    unsigned int a = add_slot(id, samples.front());
+    unsigned int n = std::min(static_cast<unsigned int>(samples.size()), d_window_size);
+    for (unsigned int k = 1; k <= n; k++)
+        {
+            unsigned int position = (d_head + d_window_size - k) % d_window_size;
+            d_windows[a * d_window_size + position] = samples[samples.size() - k] - d_offset[a];
+        }
+    d_count[a] = n;
+    for (unsigned int b = 0; b < d_slots; b++)
+        {
+            if (d_active[b] != 0.0)
+                {
+                    recompute(a, b);
+                }
+        }
+}
+
+
+unsigned int Rolling_Correlation_Matrix::size(unsigned int a, unsigned int b) const
+{
+    return std::min(d_count[a], d_count[b]);
+}
+
+
+double Rolling_Correlation_Matrix::cov(unsigned int a, unsigned int b) const
+{
+    unsigned int n = size(a, b);
+    if (n == 0)
+        {
+            return 0.0;
+        }
+    double mean_a = d_sum[a * d_slots + b] / n;
+    double mean_b = d_sum[b * d_slots + a] / n;
+    return d_sum_prod[a * d_slots + b] / n - mean_a * mean_b;
+}
+
+
+double Rolling_Correlation_Matrix::var(unsigned int a, unsigned int b) const
+{
+    unsigned int n = size(a, b);
+    if (n == 0)
+        {
+            return 0.0;
+        }
+    double mean_a = d_sum[a * d_slots + b] / n;
+    double var = d_sum_sq[a * d_slots + b] / n - mean_a * mean_a;
+    // the add/evict updates can leave a tiny negative round-off residue
+    return var > 0.0 ? var : 0.0;
+}
+
+
+std::vector<double> Rolling_Correlation_Matrix::samples(unsigned int id) const
+{
+    std::vector<double> window;
+    std::map<unsigned int, unsigned int>::const_iterator it = d_slot_of.find(id);
+    if (it == d_slot_of.end())
+        {
+            return window;
+        }
+    unsigned int a = it->second;
+    for (unsigned int k = d_count[a]; k >= 1; k--)
+        {
+            unsigned int position = (d_head + d_window_size - k) % d_window_size;
+            window.push_back(d_windows[a * d_window_size + position] + d_offset[a]);
+        }
+    return window;
+}
+
+
+void Rolling_Correlation_Matrix::recompute(unsigned int a, unsigned int b)
+{
+    double sum_a = 0.0, sum_b = 0.0, sum_sq_a = 0.0, sum_sq_b = 0.0, sum_prod = 0.0;
+    unsigned int n = size(a, b);
+    for (unsigned int k = 1; k <= n; k++)
+        {
+            unsigned int position = (d_head + d_window_size - k) % d_window_size;
+            double x = d_windows[a * d_window_size + position];
+            double y = d_windows[b * d_window_size + position];
+            sum_a += x;
+            sum_b += y;
+            sum_sq_a += x * x;
+            sum_sq_b += y * y;
+            sum_prod += x * y;
+        }
+    d_sum[a * d_slots + b] = sum_a;
+    d_sum[b * d_slots + a] = sum_b;
+    d_sum_sq[a * d_slots + b] = sum_sq_a;
+    d_sum_sq[b * d_slots + a] = sum_sq_b;
+    d_sum_prod[a * d_slots + b] = sum_prod;
+    d_sum_prod[b * d_slots + a] = sum_prod;
+}
+
+
+void Rolling_Correlation_Matrix::recompute()
+{
+    for (unsigned int a = 0; a < d_slots; a++)
+        {
+            for (unsigned int b = a; b < d_slots; b++)
+                {
+                    if (d_active[a] != 0.0 and d_active[b] != 0.0)
+                        {
+                            recompute(a, b);
+                        }
+                }
+        }
+    d_pushes = 0;
+}
@@ -0,0 +1,197 @@
+/*!
+ * \file rolling_statistics.h
+ * \brief Interface of incremental moving-window mean, variance and
+ * covariance estimators
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_ROLLING_STATISTICS_H_
+#define GNSS_SDR_ROLLING_STATISTICS_H_
+
+#include <map>
+#include <utility>
+#include <vector>
+#include <boost/circular_buffer.hpp>
+
+/*!
+ * \brief Mean and variance of the last N samples of a signal.
+ *
+ * The statistics are updated with Welford's recurrence when a sample
+ * enters or leaves the window, so push_back() costs O(1) regardless of
+ * the window length. To bound the round-off accumulated by the add/evict
+ * updates, the running sums are recomputed from the window once every
+ * N evictions (O(1) amortized).
+ */
+class Rolling_Statistics
+{
+public:
+    Rolling_Statistics(unsigned int window_size = 1);
+
+    void push_back(double x); //!< Adds a sample, evicting the oldest one if the window is full
+    void clear();
+
+    unsigned int size() const { return d_window.size(); }
+    unsigned int capacity() const { return d_window.capacity(); }
+    bool full() const { return d_window.full(); }
+
+    double mean() const { return d_mean; }
+    double var() const; //!< Population variance (normalized by size()) of the window
+
+    //! The samples of the window, oldest first
+    std::vector<double> samples() const { return std::vector<double>(d_window.begin(), d_window.end()); }
+
+private:
+    void recompute();
+
+    boost::circular_buffer<double> d_window;
+    double d_mean;
+    double d_m2;
+    unsigned int d_evictions;
+};
+
+
+/*!
+ * \brief Covariance of the last N sample pairs of two signals.
+ *
+ * Same scheme as Rolling_Statistics, extended with the running
+ * co-moment of the two signals. The samples of both signals share one
+ * window, so the i-th sample of x is always paired with the i-th sample
+ * of y.
+ */
+class Rolling_Covariance
+{
+public:
+    Rolling_Covariance(unsigned int window_size = 1);
+
+    void push_back(double x, double y); //!< Adds a pair, evicting the oldest one if the window is full
+    void clear();
+
+    unsigned int size() const { return d_window.size(); }
+    unsigned int capacity() const { return d_window.capacity(); }
+    bool full() const { return d_window.full(); }
+
+    double mean_x() const { return d_mean_x; }
+    double mean_y() const { return d_mean_y; }
+    double var_x() const;
+    double var_y() const;
+    double cov() const; //!< Population covariance (normalized by size()) of the window
+
+    //! The sample pairs of the window, oldest first
+    std::vector<std::pair<double, double> > samples() const
+    {
+        return std::vector<std::pair<double, double> >(d_window.begin(), d_window.end());
+    }
+
+private:
+    void recompute();
+
+    boost::circular_buffer<std::pair<double, double> > d_window;
+    double d_mean_x;
+    double d_mean_y;
+    double d_m2_x;
+    double d_m2_y;
+    double d_c;
+    unsigned int d_evictions;
+};
+
+
+/*!
+ * \brief Covariances of the last N samples of every pair of a set of
+ * signals that are sampled together, such as the CN0 of the satellites.
+ *
+ * Each signal takes a slot, and keeps its samples once, in the window of
+ * its slot. The running sums of every pair of slots are kept in flat
+ * slots x slots arrays, so that a push_back() of one sample per signal is
+ * a few multiply-adds per pair in contiguous loops that the compiler
+ * vectorizes, with no copy of the windows. The window of a pair covers the
+ * samples since the later of its two signals was added, up to N. The
+ * signals missing from a push_back() are removed and their slot is reused.
+ * The samples are taken relative to the first one of their signal, and
+ * the sums are recomputed from the windows once every N samples, to bound
+ * the round-off.
+ */
+class Rolling_Correlation_Matrix
+{
+public:
+    Rolling_Correlation_Matrix(unsigned int window_size = 1);
+
+    /*!
+     * \brief Adds one sample of each signal of the epoch, by id. The
+     * signals seen for the first time take a free slot, those missing are
+     * removed.
+     */
+    void push_back(const std::map<unsigned int, double>& samples);
+
+    /*!
+     * \brief Adds a signal with the samples of an earlier run, oldest
+     * first, as if the last one had come with the last push_back()
+     */
+    void insert(unsigned int id, const std::vector<double>& samples);
+    void remove(unsigned int id);
+    void clear();
+
+    unsigned int capacity() const { return d_window_size; }
+    unsigned int slots() const { return d_slots; }
+    bool active(unsigned int slot) const { return d_active[slot] != 0.0; }
+    unsigned int id(unsigned int slot) const { return d_ids[slot]; }
+
+    //! Samples of the window of the pair of slots a and b
+    unsigned int size(unsigned int a, unsigned int b) const;
+    bool full(unsigned int a, unsigned int b) const { return size(a, b) == d_window_size; }
+    double cov(unsigned int a, unsigned int b) const; //!< Population covariance of the slots a and b over the window of the pair
+    double var(unsigned int a, unsigned int b) const; //!< Population variance of the slot a over the window of the pair
+
+    //! The samples of the window of a signal, oldest first
+    std::vector<double> samples(unsigned int id) const;
+
+private:
+    unsigned int add_slot(unsigned int id, double offset);
+    void grow();
+    void recompute(unsigned int a, unsigned int b);
+    void recompute();
+
+    unsigned int d_window_size;
+    unsigned int d_slots;
+    unsigned int d_head;      // position of the next sample in the windows
+    unsigned int d_pushes;    // since the last recompute()
+    std::map<unsigned int, unsigned int> d_slot_of; // by id
+    std::vector<unsigned int> d_ids;
+    std::vector<double> d_active;  // 1.0 or 0.0, by slot
+    std::vector<unsigned int> d_count; // samples since the signal was added, up to N
+    std::vector<double> d_offset;
+    std::vector<double> d_windows; // slot after slot, N samples each
+    // sums of slot a over the window of the pair (a, b), at a * d_slots + b
+    std::vector<double> d_sum;
+    std::vector<double> d_sum_sq;
+    std::vector<double> d_sum_prod; // of the products of a and b
+    // samples entering and leaving the windows in a push_back()
+    std::vector<double> d_in;
+    std::vector<double> d_out;
+    std::vector<double> d_out_mask;
+};
+
+#endif
@@ -0,0 +1,131 @@
+/*!
+ * \file sample_history.cc
+ * \brief Ring of the latest conditioned samples of a signal conditioner,
+ * shared by the acquisition blocks of its channels
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "sample_history.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <new>
+#include <boost/thread/mutex.hpp>
+#include "buffer_allocator.h"
+
+namespace
+{
+boost::mutex histories_mutex;
+std::map<unsigned int, std::shared_ptr<Sample_History> > histories;
+}
+
+
+Sample_History::Sample_History(unsigned int capacity) :
+        d_capacity(std::max(capacity, 1u)),
+        d_written(0),
+        d_writing(0)
+{
+    // left untouched: the pages are faulted in by the writer, on its NUMA node
+    d_samples = static_cast<gr_complex*>(Buffer_Allocator::allocate(2 * d_capacity * sizeof(gr_complex), "sample_history"));
+    if (d_samples == 0)
+        {
+            throw std::bad_alloc();
+        }
+}
+
+
+Sample_History::~Sample_History()
+{
+    Buffer_Allocator::release(d_samples);
+}
+
+
+void Sample_History::write(const gr_complex* samples, unsigned int count)
+{
+    while (count > 0)
+        {
+            unsigned long int start = d_written.load(std::memory_order_relaxed);
+            unsigned int n = std::min(count, d_capacity);
+            // readers of the slots about to be overwritten see it in intact()
+            d_writing.store(start + n, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            unsigned int slot = start % d_capacity;
+            unsigned int first = std::min(n, d_capacity - slot);
+            gr_complex* ring = d_samples;
+            std::memcpy(ring + slot, samples, first * sizeof(gr_complex));
+            std::memcpy(ring + slot + d_capacity, samples, first * sizeof(gr_complex));
+            std::memcpy(ring, samples + first, (n - first) * sizeof(gr_complex));
+            std::memcpy(ring + d_capacity, samples + first, (n - first) * sizeof(gr_complex));
+
+            d_written.store(start + n, std::memory_order_release);
+            samples += n;
+            count -= n;
+        }
+}
+
+
+const gr_complex* Sample_History::window(unsigned long int start, unsigned int length) const
+{
+    if (length > d_capacity || start + length > written() || !intact(start))
+        {
+            return nullptr;
+        }
+    return d_samples + start % d_capacity;
+}
+
+
+bool Sample_History::intact(unsigned long int start) const
+{
+    // the slot of sample start is reused by sample start + capacity
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return d_writing.load(std::memory_order_relaxed) <= start + d_capacity;
+}
+
+
+std::shared_ptr<Sample_History> Sample_History::create(unsigned int conditioner_id, unsigned int capacity)
+{
+    std::shared_ptr<Sample_History> history = std::make_shared<Sample_History>(capacity);
+    boost::mutex::scoped_lock lock(histories_mutex);
+    histories[conditioner_id] = history;
+    return history;
+}
+
+
+std::shared_ptr<Sample_History> Sample_History::find(unsigned int conditioner_id)
+{
+    boost::mutex::scoped_lock lock(histories_mutex);
+    std::map<unsigned int, std::shared_ptr<Sample_History> >::const_iterator it = histories.find(conditioner_id);
+    return it == histories.end() ? std::shared_ptr<Sample_History>() : it->second;
+}
+
+
+void Sample_History::clear()
+{
+    boost::mutex::scoped_lock lock(histories_mutex);
+    histories.clear();
+}
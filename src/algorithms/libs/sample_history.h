@@ -0,0 +1,103 @@
+/*!
+ * \file sample_history.h
+ * \brief Ring of the latest conditioned samples of a signal conditioner,
+ * shared by the acquisition blocks of its channels
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_SAMPLE_HISTORY_H_
+#define GNSS_SDR_SAMPLE_HISTORY_H_
+
+#include <atomic>
+#include <memory>
+#include <gnuradio/gr_complex.h>
+
+/*!
+ * \brief The last capacity samples of a stream, indexed by their sample
+ * stamp (the number of samples written before them).
+ *
+ * There is one writer, the sample_history_sink of a signal conditioner,
+ * and any number of readers, which get a pointer to a window of the ring
+ * instead of a copy of it. Every sample is stored twice, capacity samples
+ * apart, so that any window of up to capacity samples is contiguous in
+ * memory.
+ *
+ * The ring takes no lock: a reader takes window(), uses the samples and
+ * then checks intact() to know whether the writer overwrote any of them
+ * in the meantime, in which case the result must be discarded.
+ */
+class Sample_History
+{
+public:
+    explicit Sample_History(unsigned int capacity);
+    ~Sample_History();
+
+    /*!
+     * \brief Appends count samples, the writer only
+     */
+    void write(const gr_complex* samples, unsigned int count);
+
+    /*!
+     * \brief Pointer to the length samples from sample stamp start, or
+     * nullptr if they have not been written yet or are already overwritten
+     */
+    const gr_complex* window(unsigned long int start, unsigned int length) const;
+
+    /*!
+     * \brief true if the samples from stamp start that window() returned
+     * have not been overwritten since
+     */
+    bool intact(unsigned long int start) const;
+
+    unsigned long int written() const { return d_written.load(std::memory_order_acquire); }
+    unsigned int capacity() const { return d_capacity; }
+
+    /*!
+     * \brief Creates the history of the signal conditioner conditioner_id,
+     * replacing the previous one
+     */
+    static std::shared_ptr<Sample_History> create(unsigned int conditioner_id, unsigned int capacity);
+
+    /*!
+     * \brief The history of the signal conditioner conditioner_id, or an
+     * empty pointer if the receiver keeps none
+     */
+    static std::shared_ptr<Sample_History> find(unsigned int conditioner_id);
+
+    static void clear(); //!< Forgets all the histories
+
+private:
+    Sample_History(const Sample_History&);
+    Sample_History& operator=(const Sample_History&);
+
+    unsigned int d_capacity;
+    gr_complex* d_samples; // 2 * d_capacity, the second half mirrors the first
+    std::atomic<unsigned long int> d_written;
+    std::atomic<unsigned long int> d_writing; // end of the samples being written
+};
+
+#endif
@@ -0,0 +1,57 @@
+/*!
+ * \file sample_history_sink.cc
+ * \brief GNU Radio block that writes a stream of samples into a
+ * Sample_History
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "sample_history_sink.h"
+#include <gnuradio/io_signature.h>
+
+
+sample_history_sink_sptr make_sample_history_sink(const std::shared_ptr<Sample_History>& history)
+{
+    return sample_history_sink_sptr(new sample_history_sink(history));
+}
+
+
+sample_history_sink::sample_history_sink(const std::shared_ptr<Sample_History>& history) :
+        gr::sync_block("sample_history_sink",
+                gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                gr::io_signature::make(0, 0, 0)),
+        d_history(history)
+{}
+
+
+int sample_history_sink::work(int noutput_items,
+        gr_vector_const_void_star &input_items,
+        gr_vector_void_star &output_items __attribute__((unused)))
+{
+    d_history->write(static_cast<const gr_complex*>(input_items[0]), noutput_items);
+    return noutput_items;
+}
@@ -0,0 +1,65 @@
+/*!
+ * \file sample_history_sink.h
+ * \brief GNU Radio block that writes a stream of samples into a
+ * Sample_History
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_SAMPLE_HISTORY_SINK_H_
+#define GNSS_SDR_SAMPLE_HISTORY_SINK_H_
+
+#include <memory>
+#include <boost/shared_ptr.hpp>
+#include <gnuradio/sync_block.h>
+#include "sample_history.h"
+
+class sample_history_sink;
+
+typedef boost::shared_ptr<sample_history_sink> sample_history_sink_sptr;
+
+sample_history_sink_sptr make_sample_history_sink(const std::shared_ptr<Sample_History>& history);
+
+/*!
+ * \brief Implementation of a GNU Radio block that keeps the gr_complex
+ * samples of its input in a Sample_History, so that the acquisition blocks
+ * fed by the same signal conditioner read them from there
+ */
+class sample_history_sink : public gr::sync_block
+{
+private:
+    friend sample_history_sink_sptr make_sample_history_sink(const std::shared_ptr<Sample_History>& history);
+    sample_history_sink(const std::shared_ptr<Sample_History>& history);
+    std::shared_ptr<Sample_History> d_history;
+
+public:
+    int work(int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items);
+};
+
+#endif
@@ -0,0 +1,199 @@
+/*!
+ * \file spectrum_monitor.cc
+ * \brief Decimated power, coarse spectrum and noise floor of a sample stream,
+ * for an early warning of jamming and spoofing
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "spectrum_monitor.h"
+#include <algorithm>
+#include <cmath>
+#include <volk/volk.h>
+
+
+namespace
+{
+const float MIN_POWER = 1e-30f; // keeps the logarithms finite on a silent input
+}
+
+
+Spectrum_Monitor::Spectrum_Monitor(double fs_hz, unsigned int fft_size, double period_ms,
+        unsigned int report_periods, double floor_time_constant_s) :
+        d_fft_size(std::max(fft_size, 2u)),
+        d_report_periods(std::max(report_periods, 1u)),
+        d_power_rise_db(3.0),
+        d_deviation_db(6.0),
+        d_samples(0),
+        d_in_period(0),
+        d_blocks(0),
+        d_power_sum(0.0),
+        d_reports(0),
+        d_floor_var(0.0)
+{
+    d_period_samples = std::max(static_cast<unsigned long int>(std::floor(fs_hz * period_ms * 1e-3 + 0.5)),
+            static_cast<unsigned long int>(d_fft_size));
+    double report_s = static_cast<double>(d_period_samples * d_report_periods) / fs_hz;
+    d_alpha = static_cast<float>(std::min(std::max(report_s / floor_time_constant_s, 1e-6), 1.0));
+    d_warmup_reports = static_cast<unsigned int>(std::ceil(1.0 / d_alpha));
+
+    d_block.resize(d_fft_size);
+    d_magnitude.resize(d_fft_size);
+    d_spectrum.assign(d_fft_size, 0.0);
+    d_mean_spectrum.assign(d_fft_size, 0.0);
+    // Hann window, for the leakage of a narrowband jammer not to hide the other bins
+    d_window.resize(d_fft_size);
+    for (unsigned int i = 0; i < d_fft_size; i++)
+        {
+            d_window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * M_PI * i / d_fft_size));
+        }
+    d_fft.reset(new gr::fft::fft_complex(d_fft_size, true));
+
+    d_metrics.sample_counter = 0;
+    d_metrics.power_db = 0.0;
+    d_metrics.floor_db = 0.0;
+    d_metrics.floor_sigma_db = 0.0;
+    d_metrics.deviation_db = 0.0;
+    d_metrics.flatness = 1.0;
+    d_metrics.anomaly = false;
+    d_metrics.onsets = 0;
+}
+
+
+void Spectrum_Monitor::set_thresholds(double power_rise_db, double deviation_db)
+{
+    d_power_rise_db = static_cast<float>(power_rise_db);
+    d_deviation_db = static_cast<float>(deviation_db);
+}
+
+
+bool Spectrum_Monitor::add(const gr_complex* samples, unsigned int count)
+{
+    bool reported = false;
+    unsigned int i = 0;
+    while (i < count)
+        {
+            unsigned long int n;
+            if (d_in_period < d_fft_size)
+                {
+                    // the head of the period is looked at
+                    n = std::min(static_cast<unsigned long int>(count - i), d_fft_size - d_in_period);
+                    std::copy(samples + i, samples + i + n, d_block.begin() + d_in_period);
+                }
+            else
+                {
+                    // the rest is skipped
+                    n = std::min(static_cast<unsigned long int>(count - i), d_period_samples - d_in_period);
+                }
+            i += n;
+            d_samples += n;
+            d_in_period += n;
+            if (d_in_period == d_fft_size)
+                {
+                    add_block();
+                    if (d_blocks == d_report_periods)
+                        {
+                            report();
+                            reported = true;
+                        }
+                }
+            if (d_in_period == d_period_samples)
+                {
+                    d_in_period = 0;
+                }
+        }
+    return reported;
+}
+
+
+void Spectrum_Monitor::add_block()
+{
+    float power = 0.0;
+    volk_32fc_magnitude_squared_32f(d_magnitude.data(), d_block.data(), d_fft_size);
+    volk_32f_accumulator_s32f(&power, d_magnitude.data(), d_fft_size);
+    d_power_sum += power / static_cast<float>(d_fft_size);
+
+    volk_32fc_32f_multiply_32fc(d_fft->get_inbuf(), d_block.data(), d_window.data(), d_fft_size);
+    d_fft->execute();
+    volk_32fc_magnitude_squared_32f(d_magnitude.data(), d_fft->get_outbuf(), d_fft_size);
+    volk_32f_x2_add_32f(d_spectrum.data(), d_spectrum.data(), d_magnitude.data(), d_fft_size);
+    d_blocks++;
+}
+
+
+void Spectrum_Monitor::report()
+{
+    float power_db = 10.0f * std::log10(std::max(d_power_sum / static_cast<float>(d_blocks), MIN_POWER));
+    float total = 0.0;
+    volk_32f_accumulator_s32f(&total, d_spectrum.data(), d_fft_size);
+    total = std::max(total, MIN_POWER);
+
+    // flatness and the largest rise of a bin of the normalized spectrum over its mean
+    float log_sum = 0.0;
+    float deviation_db = 0.0;
+    for (unsigned int k = 0; k < d_fft_size; k++)
+        {
+            float bin = std::max(d_spectrum[k] / total, MIN_POWER);
+            log_sum += std::log(bin);
+            d_spectrum[k] = bin;
+            if (d_reports > 0)
+                {
+                    deviation_db = std::max(deviation_db, 10.0f * std::log10(bin / std::max(d_mean_spectrum[k], MIN_POWER)));
+                }
+        }
+    float flatness = std::exp(log_sum / static_cast<float>(d_fft_size)) * static_cast<float>(d_fft_size);
+
+    bool warmed_up = d_reports >= d_warmup_reports;
+    bool anomaly = warmed_up && (power_db - d_metrics.floor_db > d_power_rise_db || deviation_db > d_deviation_db);
+    if (anomaly && !d_metrics.anomaly)
+        {
+            d_metrics.onsets++;
+        }
+    if (!anomaly)
+        {
+            // while warming up, the means are plain averages of the reports so far
+            float alpha = std::max(d_alpha, 1.0f / static_cast<float>(d_reports + 1));
+            float error_db = power_db - d_metrics.floor_db;
+            d_metrics.floor_db += alpha * error_db;
+            d_floor_var = d_reports == 0 ? 0.0f : (1.0f - alpha) * (d_floor_var + alpha * error_db * error_db);
+            for (unsigned int k = 0; k < d_fft_size; k++)
+                {
+                    d_mean_spectrum[k] += alpha * (d_spectrum[k] - d_mean_spectrum[k]);
+                }
+            d_reports++;
+        }
+
+    d_metrics.sample_counter = d_samples;
+    d_metrics.power_db = power_db;
+    d_metrics.floor_sigma_db = std::sqrt(d_floor_var);
+    d_metrics.deviation_db = deviation_db;
+    d_metrics.flatness = flatness;
+    d_metrics.anomaly = anomaly;
+
+    d_blocks = 0;
+    d_power_sum = 0.0;
+    std::fill(d_spectrum.begin(), d_spectrum.end(), 0.0);
+}
@@ -0,0 +1,104 @@
+/*!
+ * \file spectrum_monitor.h
+ * \brief Decimated power, coarse spectrum and noise floor of a sample stream,
+ * for an early warning of jamming and spoofing
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_SPECTRUM_MONITOR_H_
+#define GNSS_SDR_SPECTRUM_MONITOR_H_
+
+#include <memory>
+#include <vector>
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/fft/fft.h>
+#include "spectrum_metrics.h"
+
+/*!
+ * \brief Turns a stream of samples into Spectrum_Metrics.
+ *
+ * Only the first fft_size samples of each period are looked at: their
+ * power is added to the report, and they are windowed and transformed, so
+ * that a report of report_periods periods holds a coarse spectrum averaged
+ * over as many blocks. At 4 Msps, with the defaults, that is 64 of every
+ * 4000 samples and a 64 point FFT every ms, reported every 10 ms.
+ *
+ * The floor and its spread are exponential means of the reports over
+ * floor_time_constant_s, and the spectrum of each bin likewise, all of
+ * them updated in place. They are frozen while an anomaly lasts, so that
+ * a jammer does not become the floor, and no anomaly is raised before
+ * they have settled over a time constant.
+ */
+class Spectrum_Monitor
+{
+public:
+    Spectrum_Monitor(double fs_hz, unsigned int fft_size = 64, double period_ms = 1.0,
+            unsigned int report_periods = 10, double floor_time_constant_s = 10.0);
+
+    /*!
+     * \brief An anomaly is a power over the floor by more than power_rise_db,
+     * or a bin of the normalized spectrum over its mean by more than
+     * deviation_db
+     */
+    void set_thresholds(double power_rise_db, double deviation_db);
+
+    /*!
+     * \brief Adds count samples of the stream
+     * \return true if a report ended in them, and metrics() was updated
+     */
+    bool add(const gr_complex* samples, unsigned int count);
+
+    const Spectrum_Metrics& metrics() const { return d_metrics; }
+
+private:
+    void add_block();
+    void report();
+
+    unsigned int d_fft_size;
+    unsigned long int d_period_samples;
+    unsigned int d_report_periods;
+    float d_alpha; // weight of a report in the means
+    unsigned int d_warmup_reports;
+    float d_power_rise_db;
+    float d_deviation_db;
+
+    unsigned long int d_samples;   // of the stream so far
+    unsigned long int d_in_period; // samples of the current period seen
+    unsigned int d_blocks;         // in the current report
+    float d_power_sum;
+    unsigned int d_reports;
+    std::vector<gr_complex> d_block;
+    std::vector<float> d_window;
+    std::vector<float> d_magnitude;
+    std::vector<float> d_spectrum;      // of the current report
+    std::vector<float> d_mean_spectrum; // normalized
+    std::unique_ptr<gr::fft::fft_complex> d_fft;
+    float d_floor_var;
+    Spectrum_Metrics d_metrics;
+};
+
+#endif
@@ -0,0 +1,84 @@
+/*!
+ * \file spectrum_monitor_sink.cc
+ * \brief GNU Radio block that monitors the power and spectrum of the samples
+ * of a signal conditioner
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "spectrum_monitor_sink.h"
+#include <sstream>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+#include "flight_recorder.h"
+
+
+spectrum_monitor_sink_sptr make_spectrum_monitor_sink(std::unique_ptr<Spectrum_Monitor> monitor,
+        unsigned int conditioner_id, bool trigger_flight_recorder)
+{
+    return spectrum_monitor_sink_sptr(new spectrum_monitor_sink(std::move(monitor), conditioner_id, trigger_flight_recorder));
+}
+
+
+spectrum_monitor_sink::spectrum_monitor_sink(std::unique_ptr<Spectrum_Monitor> monitor,
+        unsigned int conditioner_id, bool trigger_flight_recorder) :
+        gr::sync_block("spectrum_monitor_sink",
+                gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                gr::io_signature::make(0, 0, 0)),
+        d_monitor(std::move(monitor)),
+        d_receiver_state(Receiver_State::current()),
+        d_conditioner_id(conditioner_id),
+        d_trigger_flight_recorder(trigger_flight_recorder),
+        d_onsets(0)
+{}
+
+
+int spectrum_monitor_sink::work(int noutput_items,
+        gr_vector_const_void_star &input_items,
+        gr_vector_void_star &output_items __attribute__((unused)))
+{
+    if (!d_monitor->add(static_cast<const gr_complex*>(input_items[0]), noutput_items))
+        {
+            return noutput_items;
+        }
+    const Spectrum_Metrics& metrics = d_monitor->metrics();
+    d_receiver_state->spectrum_map.write(d_conditioner_id, metrics);
+    if (metrics.onsets != d_onsets)
+        {
+            d_onsets = metrics.onsets;
+            std::ostringstream reason;
+            reason.precision(3);
+            reason << "Signal conditioner " << d_conditioner_id << ": power " << metrics.power_db - metrics.floor_db
+                   << " dB over the floor, spectrum deviation " << metrics.deviation_db << " dB";
+            LOG(WARNING) << reason.str();
+            if (d_trigger_flight_recorder)
+                {
+                    flight_recorder_trigger_all(reason.str());
+                }
+        }
+    return noutput_items;
+}
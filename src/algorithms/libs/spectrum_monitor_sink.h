@@ -0,0 +1,76 @@
+/*!
+ * \file spectrum_monitor_sink.h
+ * \brief GNU Radio block that monitors the power and spectrum of the samples
+ * of a signal conditioner
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_SPECTRUM_MONITOR_SINK_H_
+#define GNSS_SDR_SPECTRUM_MONITOR_SINK_H_
+
+#include <memory>
+#include <boost/shared_ptr.hpp>
+#include <gnuradio/sync_block.h>
+#include "receiver_state.h"
+#include "spectrum_monitor.h"
+
+class spectrum_monitor_sink;
+
+typedef boost::shared_ptr<spectrum_monitor_sink> spectrum_monitor_sink_sptr;
+
+spectrum_monitor_sink_sptr make_spectrum_monitor_sink(std::unique_ptr<Spectrum_Monitor> monitor,
+        unsigned int conditioner_id, bool trigger_flight_recorder);
+
+/*!
+ * \brief Implementation of a GNU Radio block that feeds the gr_complex
+ * samples of its input to a Spectrum_Monitor, and publishes its metrics in
+ * the spectrum_map of the Receiver_State, under conditioner_id, where the
+ * spoofing detector checks them (Spoofing.spectrum). At the onset of an
+ * anomaly it can also trigger the flight recorders at once, without
+ * waiting for the detector.
+ */
+class spectrum_monitor_sink : public gr::sync_block
+{
+private:
+    friend spectrum_monitor_sink_sptr make_spectrum_monitor_sink(std::unique_ptr<Spectrum_Monitor> monitor,
+            unsigned int conditioner_id, bool trigger_flight_recorder);
+    spectrum_monitor_sink(std::unique_ptr<Spectrum_Monitor> monitor,
+            unsigned int conditioner_id, bool trigger_flight_recorder);
+    std::unique_ptr<Spectrum_Monitor> d_monitor;
+    std::shared_ptr<Receiver_State> d_receiver_state;
+    unsigned int d_conditioner_id;
+    bool d_trigger_flight_recorder;
+    unsigned int d_onsets;
+
+public:
+    int work(int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items);
+};
+
+#endif
@@ -0,0 +1,300 @@
+/*!
+ * \file spoofing_check_scheduler.cc
+ * \brief Implementation of the scheduler of the checks of the spoofing
+ * detector
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "spoofing_check_scheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+namespace
+{
+const double COST_SMOOTHING = 0.1;     // weight of the last run in the moving average of the cost
+const unsigned int MAX_DECIMATION = 1000;
+}
+
+
+Spoofing_Check_Scheduler::Spoofing_Check_Scheduler(unsigned int queue_capacity, double batch_interval_ms)
+{
+    d_queue_capacity = std::max(queue_capacity, 1u);
+    d_batch_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double, std::milli>(std::max(batch_interval_ms, 0.0)));
+    d_next_batch = std::chrono::steady_clock::now();
+    d_running = 0;
+    d_stop = false;
+}
+
+
+Spoofing_Check_Scheduler::~Spoofing_Check_Scheduler()
+{
+    {
+        boost::lock_guard<boost::mutex> lock(d_mutex);
+        d_stop = true;
+    }
+    d_wake.notify_all();
+    if (d_thread.joinable())
+        {
+            d_thread.join();
+        }
+}
+
+
+int Spoofing_Check_Scheduler::add_check(const std::string& name, Context context, double min_interval_ms, double budget_us)
+{
+    Check check;
+    check.name = name;
+    check.context = context;
+    check.min_interval_ms = std::max(min_interval_ms, 0.0);
+    check.budget_us = std::max(budget_us, 0.0);
+    check.admitted_once = false;
+    check.last_time_ms = 0.0;
+    check.offered = 0;
+    check.runs = 0;
+    check.skipped_rate = 0;
+    check.skipped_budget = 0;
+    check.dropped = 0;
+    check.mean_us = 0.0;
+    check.max_us = 0.0;
+    check.decimation = 1;
+    check.metrics = make_block_metrics("spoofing_check", name);
+
+    boost::lock_guard<boost::mutex> lock(d_mutex);
+    d_checks.push_back(check);
+    if (context != INLINE and not d_thread.joinable())
+        {
+            d_thread = boost::thread(&Spoofing_Check_Scheduler::work, this);
+        }
+    return d_checks.size() - 1;
+}
+
+
+bool Spoofing_Check_Scheduler::admit(int check, double time_ms)
+{
+    boost::lock_guard<boost::mutex> lock(d_mutex);
+    Check& c = d_checks.at(check);
+    if (c.admitted_once and time_ms - c.last_time_ms < c.min_interval_ms)
+        {
+            c.skipped_rate++;
+            return false;
+        }
+    if (c.offered++ % c.decimation != 0)
+        {
+            c.skipped_budget++;
+            return false;
+        }
+    c.admitted_once = true;
+    c.last_time_ms = time_ms;
+    return true;
+}
+
+
+void Spoofing_Check_Scheduler::dispatch(int check, const std::function<void()>& call)
+{
+    {
+        boost::lock_guard<boost::mutex> lock(d_mutex);
+        Check& c = d_checks.at(check);
+        if (c.context == DEFERRED)
+            {
+                if (d_deferred.size() >= d_queue_capacity)
+                    {
+                        c.dropped++;
+                        return;
+                    }
+                Task task = { check, call };
+                d_deferred.push_back(task);
+                d_wake.notify_one();
+                return;
+            }
+        if (c.context == BATCHED)
+            {
+                if (d_batched.size() >= d_queue_capacity)
+                    {
+                        c.dropped++;
+                        return;
+                    }
+                if (d_batched.empty())
+                    {
+                        d_next_batch = std::chrono::steady_clock::now() + d_batch_interval;
+                    }
+                Task task = { check, call };
+                d_batched.push_back(task);
+                d_wake.notify_one();
+                return;
+            }
+    }
+    run(check, call);
+}
+
+
+bool Spoofing_Check_Scheduler::is_inline(int check) const
+{
+    boost::lock_guard<boost::mutex> lock(d_mutex);
+    return d_checks.at(check).context == INLINE;
+}
+
+
+void Spoofing_Check_Scheduler::flush()
+{
+    boost::unique_lock<boost::mutex> lock(d_mutex);
+    if (not d_thread.joinable())
+        {
+            return;
+        }
+    // the pending batch runs now rather than at the end of its interval
+    d_next_batch = std::chrono::steady_clock::now();
+    d_wake.notify_one();
+    while (not d_deferred.empty() or not d_batched.empty() or d_running > 0)
+        {
+            d_idle.wait(lock);
+        }
+}
+
+
+std::vector<Spoofing_Check_Scheduler::Check_Stats> Spoofing_Check_Scheduler::stats() const
+{
+    boost::lock_guard<boost::mutex> lock(d_mutex);
+    std::vector<Check_Stats> stats;
+    for (unsigned int i = 0; i < d_checks.size(); i++)
+        {
+            const Check& c = d_checks[i];
+            Check_Stats s;
+            s.name = c.name;
+            s.context = c.context;
+            s.runs = c.runs;
+            s.skipped_rate = c.skipped_rate;
+            s.skipped_budget = c.skipped_budget;
+            s.dropped = c.dropped;
+            s.mean_us = c.mean_us;
+            s.max_us = c.max_us;
+            s.budget_us = c.budget_us;
+            s.decimation = c.decimation;
+            stats.push_back(s);
+        }
+    return stats;
+}
+
+
+Spoofing_Check_Scheduler::Context Spoofing_Check_Scheduler::context_from_string(const std::string& context, Context default_context)
+{
+    if (context == "inline") return INLINE;
+    if (context == "deferred") return DEFERRED;
+    if (context == "batched") return BATCHED;
+    return default_context;
+}
+
+
+std::string Spoofing_Check_Scheduler::context_name(Context context)
+{
+    switch (context)
+    {
+    case DEFERRED:
+        return "deferred";
+    case BATCHED:
+        return "batched";
+    default:
+        return "inline";
+    }
+}
+
+
+void Spoofing_Check_Scheduler::run(int check, const std::function<void()>& call)
+{
+    Allocation_Count allocated = thread_allocation_count();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    call();
+    std::chrono::steady_clock::duration duration = std::chrono::steady_clock::now() - start;
+    Allocation_Count allocated_after = thread_allocation_count();
+    double cost_us = std::chrono::duration<double, std::micro>(duration).count();
+
+    boost::lock_guard<boost::mutex> lock(d_mutex);
+    Check& c = d_checks.at(check);
+    c.mean_us = c.runs == 0 ? cost_us : (1.0 - COST_SMOOTHING) * c.mean_us + COST_SMOOTHING * cost_us;
+    c.max_us = std::max(c.max_us, cost_us);
+    c.runs++;
+    if (c.budget_us > 0.0)
+        {
+            double decimation = std::ceil(c.mean_us / c.budget_us);
+            c.decimation = std::max(1u, std::min(MAX_DECIMATION, static_cast<unsigned int>(decimation)));
+        }
+    if (block_metrics_enabled())
+        {
+            c.metrics->add_call(duration, 1, 0);
+            c.metrics->add_allocations(allocated_after.allocations - allocated.allocations, allocated_after.bytes - allocated.bytes);
+        }
+}
+
+
+void Spoofing_Check_Scheduler::work()
+{
+    boost::unique_lock<boost::mutex> lock(d_mutex);
+    while (not d_stop)
+        {
+            std::vector<Task> tasks;
+            if (not d_deferred.empty())
+                {
+                    tasks.push_back(d_deferred.front());
+                    d_deferred.pop_front();
+                }
+            else if (not d_batched.empty() and std::chrono::steady_clock::now() >= d_next_batch)
+                {
+                    tasks.swap(d_batched);
+                }
+            else if (d_batched.empty())
+                {
+                    d_wake.wait(lock);
+                    continue;
+                }
+            else
+                {
+                    long int wait_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                            d_next_batch - std::chrono::steady_clock::now()).count();
+                    d_wake.timed_wait(lock, boost::posix_time::microseconds(std::max(wait_us, 1L)));
+                    continue;
+                }
+
+            d_running++;
+            lock.unlock();
+            for (unsigned int i = 0; i < tasks.size(); i++)
+                {
+                    run(tasks[i].check, tasks[i].call);
+                }
+            lock.lock();
+            d_running--;
+            if (d_deferred.empty() and d_batched.empty() and d_running == 0)
+                {
+                    d_idle.notify_all();
+                }
+        }
+    // the calls still queued when the scheduler is destroyed are not run
+    d_deferred.clear();
+    d_batched.clear();
+    d_idle.notify_all();
+}
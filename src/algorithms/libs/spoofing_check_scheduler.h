@@ -0,0 +1,160 @@
+/*!
+ * \file spoofing_check_scheduler.h
+ * \brief Runs the checks of the spoofing detector inline, on a worker
+ * thread or in batches, within a time budget per check
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_SPOOFING_CHECK_SCHEDULER_H_
+#define GNSS_SDR_SPOOFING_CHECK_SCHEDULER_H_
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include "block_metrics.h"
+
+/*!
+ * \brief Decides when and where each check of the spoofing detector runs.
+ *
+ * A check is registered with its execution context, the shortest interval
+ * between two of its runs, in the time of its input, and a time budget.
+ * The thread that has a new input asks admit() whether the check takes
+ * it, and then gives the call to dispatch():
+ *  - INLINE checks run in the calling thread, as before;
+ *  - DEFERRED checks are queued to the worker thread, which runs them as
+ *    soon as it can, so they add no latency to the caller. A full queue
+ *    drops the call;
+ *  - BATCHED checks are also queued, but the worker only wakes up for
+ *    them once every batch interval, and runs all of them at once.
+ *
+ * The budget is the mean cost of a check per input it is offered [us].
+ * The scheduler keeps a moving average of the cost of each run, and when
+ * it exceeds the budget it only admits one of every ceil(cost / budget)
+ * inputs. Every run is counted in the ("spoofing_check", name)
+ * Block_Metrics, and stats() tells the calls admitted, skipped and
+ * dropped of each check.
+ */
+class Spoofing_Check_Scheduler
+{
+public:
+    enum Context { INLINE, DEFERRED, BATCHED };
+
+    struct Check_Stats
+    {
+        std::string name;
+        Context context;
+        unsigned long long runs;
+        unsigned long long skipped_rate;   //!< inputs closer than the interval to the previous one
+        unsigned long long skipped_budget; //!< inputs skipped to keep within the budget
+        unsigned long long dropped;        //!< calls dropped by a full queue
+        double mean_us;                    //!< moving average of the cost of a run
+        double max_us;
+        double budget_us;
+        unsigned int decimation;           //!< one of every decimation inputs is admitted
+    };
+
+    Spoofing_Check_Scheduler(unsigned int queue_capacity = 256, double batch_interval_ms = 100.0);
+    ~Spoofing_Check_Scheduler();
+
+    /*!
+     * \brief Registers a check
+     * \param min_interval_ms - shortest interval between two admitted inputs, 0 for none [ms]
+     * \param budget_us - mean cost per input offered, 0 for none [us]
+     * \return the id of the check
+     */
+    int add_check(const std::string& name, Context context, double min_interval_ms, double budget_us);
+
+    /*!
+     * \brief Whether the check takes an input of time time_ms. The caller
+     * only prepares and dispatches the call if it does.
+     */
+    bool admit(int check, double time_ms);
+
+    //! Runs the call of an admitted input, or queues it
+    void dispatch(int check, const std::function<void()>& call);
+
+    bool is_inline(int check) const;
+
+    //! Waits until the worker has run all the queued calls
+    void flush();
+
+    std::vector<Check_Stats> stats() const;
+
+    //! "inline", "deferred" or "batched", default_context for anything else
+    static Context context_from_string(const std::string& context, Context default_context);
+    static std::string context_name(Context context);
+
+private:
+    struct Check
+    {
+        std::string name;
+        Context context;
+        double min_interval_ms;
+        double budget_us;
+        bool admitted_once;
+        double last_time_ms;
+        unsigned long long offered;
+        unsigned long long runs;
+        unsigned long long skipped_rate;
+        unsigned long long skipped_budget;
+        unsigned long long dropped;
+        double mean_us;
+        double max_us;
+        unsigned int decimation;
+        std::shared_ptr<Block_Metrics> metrics;
+    };
+
+    struct Task
+    {
+        int check;
+        std::function<void()> call;
+    };
+
+    void run(int check, const std::function<void()>& call);
+    void work();
+
+    std::vector<Check> d_checks;
+    std::deque<Task> d_deferred;
+    std::vector<Task> d_batched;
+    unsigned int d_queue_capacity;
+    std::chrono::steady_clock::duration d_batch_interval;
+    std::chrono::steady_clock::time_point d_next_batch;
+    unsigned int d_running;
+    bool d_stop;
+    mutable boost::mutex d_mutex;
+    boost::condition_variable d_wake;
+    boost::condition_variable d_idle;
+    boost::thread d_thread; // started by the first check that is not inline
+};
+
+#endif
@@ -37,1327 +37,1534 @@
 #include "control_message_factory.h"
 #include "concurrent_map.h"
 #include "concurrent_map_str.h"
-#include "concurrent_queue.h"
+#include "concurrent_snapshot_map.h"
+#include "concurrent_ring_queue.h"
+#include "correlator_taps.h"
+#include "sqm_metrics.h"
+#include "aoa_metrics.h"
+#include "spectrum_metrics.h"
+#include "latency_trace.h"
+#include "flight_recorder.h"
+#include "block_metrics.h"
+#include "trace_log.h"
+#include "nav_data_fields.h"
+#include "spoofing_replay.h"
+#include "spoofing_check_scheduler.h"
+#include "receiver_checkpoint.h"
+#include "spoofing_peers.h"
+#include "gps_acq_assist.h"
+#include "gps_ref_location.h"
+#include <algorithm>
 #include <cmath>
 #include <numeric>
+#include <random>
 #include <iomanip>
-#include "gnss_sdr_supl_client.h"
 #include <chrono>
+#include <boost/bind.hpp>
+#include <boost/math/distributions/chi_squared.hpp>
+#include <boost/tokenizer.hpp>
 #include <iomanip>
 
-extern concurrent_map<bool> global_spoofing_status;
-extern concurrent_map<Subframe> global_subframe_map;
-extern concurrent_map<sEph> global_sEph_map;
-
-struct RX_time{
-    unsigned int subframe_id;
-    unsigned int PRN;
-    double timestamp;
-};
-extern concurrent_map<RX_time> global_RX_map;
-
-
 const int seconds_per_week = 604800; 
 
 /*!
- *  Contains all spoofing alarms.
- */
-extern concurrent_queue<Spoofing_Message> global_spoofing_queue;
-
-/*!
- *   Contains the last received GPS time
- *   key 0 contains the week.
- *   key 1 contains the TOW (time of week).
- *   key 2 contains the timestamp of when the GPS time was received.
- */
-extern concurrent_map<double> global_last_gps_time;
-
-extern concurrent_map<Subframe> global_subframe_map;
-
-/*!
- *   Contains the GPS time, that is the GPS week and the time of week (TOW).
- *   In addition it contains the timestamp of when this information was received 
- *   and the id of the subframe that this information arrived in.
+ *  Max number of records of one type waiting for external assistance data.
  */
-struct GPS_time_t{
-    int week;
-    double TOW;
-    double timestamp;
-    int subframe_id;
-};
+const unsigned int max_pending_external = 32;
 
-/*!
- *   Contains the latest received GPS time of all currently tracked channels. 
- */
-extern concurrent_map<GPS_time_t> global_gps_time;
-/*!
- *  For each unique peak that is being tracked this maps it to all other peaks
- *  that it has been compared to i.e., has been tested for spoofing against. 
- */
+template<typename T>
+void push_pending(std::vector<T>& pending, const T& record)
+{
+    if(pending.size() >= max_pending_external)
+        {
+            pending.erase(pending.begin());
+        }
+    pending.push_back(record);
+}
 
 
 using google::LogMessage;
 Spoofing_Detector::Spoofing_Detector()
 {
-
+    d_receiver_state = Receiver_State::current();
 }
 
 Spoofing_Detector::Spoofing_Detector(ConfigurationInterface* configuration)
 {
+    d_receiver_state = Receiver_State::current();
+
     // APT configuration 
     bool APT = configuration->property("Spoofing.APT", false);
     d_APT = APT;
-    int APT_ch_per_sat = configuration->property("Spoofing.APT_ch_per_sat", 2);
-    d_APT_ch_per_sat = APT_ch_per_sat;
-    double APT_max_rx_discrepancy = configuration->property("Spoofing.APT_max_rx_discrepancy", 500);
-    d_APT_max_rx_discrepancy = APT_max_rx_discrepancy/1e6; //in [ms]
 
     //PPE configuration
     bool PPE = configuration->property("Spoofing.PPE", false);
     d_PPE = PPE;
     int PPE_window_size = configuration->property("Spoofing.PPE_window_size", 50);
     d_PPE_window_size = PPE_window_size;
-    ppe_cb = boost::circular_buffer<double> (d_PPE_window_size);
+    ppe_cb = Rolling_Statistics(d_PPE_window_size);
+    sat_buffs.init(d_PPE_window_size);
+    satellite_SNR_corr = Rolling_Correlation_Matrix(1000);
 
-    double  PPE_sampling = configuration->property("Spoofing.PPE_sampling", 1e3);
-    d_PPE_sampling = PPE_sampling;
-    double CN0_threshold = configuration->property("Spoofing.CN0_threshold", 15);
-    d_CN0_threshold = CN0_threshold;
-    double RT_threshold = configuration->property("Spoofing.RT_threshold", 0.1);
-    d_RT_threshold = RT_threshold;
-    double Delta_threshold = configuration->property("Spoofing.Delta_threshold", 0.07);
-    d_Delta_threshold = Delta_threshold;
+    //SQM configuration
+    d_SQM = configuration->property("Spoofing.SQM", false);
+
+    //AoA configuration
+    d_AoA = configuration->property("Spoofing.AoA", false);
+
+    //spectrum configuration
+    d_spectrum = configuration->property("Spoofing.spectrum", false);
 
     //NAVI configuration
     bool NAVI_TOW = configuration->property("Spoofing.NAVI_TOW", false);
     d_NAVI_TOW = NAVI_TOW;
-    double NAVI_TOW_max_discrepancy = configuration->property("Spoofing.NAVI_TOW_max_discrepancy", 100);
-    d_NAVI_TOW_max_discrepancy = NAVI_TOW_max_discrepancy;
     bool NAVI_inter_satellite = configuration->property("Spoofing.NAVI_inter_satellite", false);
     d_NAVI_inter_satellite = NAVI_inter_satellite;
     bool NAVI_external = configuration->property("Spoofing.NAVI_external", false);
     d_NAVI_external = NAVI_external;
     bool NAVI_alt = configuration->property("Spoofing.NAVI_alt", false);
     d_NAVI_alt = NAVI_alt;
-    double NAVI_max_alt = configuration->property("Spoofing.NAVI_max_alt", 2e3);
-    d_NAVI_max_alt = NAVI_max_alt;
 
     d_NAVI_exp_eph = configuration->property("Spoofing.NAVI_exp_eph", false);
-    //Ephemeris thresholds
-    //Subframe 1
-    d_A_f0 = configuration->property("Spoofing.A_f0", 0.0011874);
-    d_A_f1 = configuration->property("Spoofing.A_f1", 1.1607e-10);
-    d_A_f2 = configuration->property("Spoofing.A_f2", 1e-17);
-
-    //Subframe 2
-    d_Crs = configuration->property("Spoofing.Crs", 271.5938);
-    d_Delta_n = configuration->property("Spoofing.Delta_n", 5.5642e-09);
-    d_M_0 = configuration->property("Spoofing.M_0", 5.9478);
-    d_Cuc = configuration->property("Spoofing.Cuc", 1.3784e-05);
-    d_e_eccentricity = configuration->property("Spoofing.e_eccentricity", 0.01506);
-    d_Cus = configuration->property("Spoofing.Cus", 1.1379e-05);
-    d_sqrt_A = configuration->property("Spoofing.sqrt_A", 3.2586);
-
-    //Subframe 3
-    d_Cic = configuration->property("Spoofing.Cic", 8.7544e-07);
-    d_OMEGA0 = configuration->property("Spoofing.OMEGA0", 6.2831);
-    d_Cis = configuration->property("Spoofing.Cis", 1.0622e-05);
-    d_i_0 = configuration->property("Spoofing.i_0", 0.066267);
-    d_Crc = configuration->property("Spoofing.Crc", 293.7188);
-    d_OMEGA = configuration->property("Spoofing.OMEGA", 6.2832);
-    d_OMEGA_DOT = configuration->property("Spoofing.OMEGA_DOT", 1.2847e-09);
-    d_IDOT = configuration->property("Spoofing.IDOT", 1.3097e-09);
+
+    //satellite positions
+    d_satpos_detection = configuration->property("Spoofing.satpos_detection", false);
+
+    //RAIM configuration
+    d_RAIM = configuration->property("Spoofing.RAIM", false);
+
+    //Doppler configuration
+    d_Doppler = configuration->property("Spoofing.Doppler", false);
+    d_Doppler_static = configuration->property("Spoofing.Doppler_static", false);
+    d_Doppler_window = std::max(configuration->property("Spoofing.Doppler_window", 20), 1);
 
     //sampling freq, to get timestamp from sample counter
     double fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
     d_fs_in = fs_in;
-    
-}
 
-Spoofing_Detector::~Spoofing_Detector()
-{
-}
+    //alarms
+    d_report_json = configuration->property("Spoofing.report_json", false);
 
-/*!
- *  Logs the occurance of a spoofing alarm.
- */
-void Spoofing_Detector::spoofing_detected(Spoofing_Message msg)
-{
-    int width = 80;
-    std::string sp = "SPOOFING DETECTED";
+    //inputs recorded for the spoofing-replay utility
+    std::string replay_filename = configuration->property("Spoofing.replay_filename", std::string(""));
+    if( !replay_filename.empty() )
+        {
+            d_replay_writer.reset(new Spoofing_Replay_Writer(replay_filename, d_fs_in));
+        }
 
-    std::string description = msg.description;
-    std::stringstream s;
-    s << '+' << std::setw(width-3) << std::setfill('-') << "+\n"; 
-    s << std::setw( (width+sp.length())/2 ) << std::setfill(' ') << sp << std::setw( (width-sp.length())/2 ) << std::setfill(' ') << "\n\n";
-    s << std::setw(2) << std::setfill(' ') << description << "\n";
-    s << '+' << std::setw(width-2) << std::setfill('-') << "+\n\n"; 
+    reconfigure(configuration);
 
-    std::cout << s.str();
-    DLOG(INFO) << sp << " " << description;
+    //where and how often the checks run
+    int scheduler_queue_size = configuration->property("Spoofing.scheduler_queue_size", 256);
+    double scheduler_batch_ms = configuration->property("Spoofing.scheduler_batch_ms", 100.0);
+    d_scheduler.reset(new Spoofing_Check_Scheduler(std::max(scheduler_queue_size, 1), scheduler_batch_ms));
+    d_check_PPE = add_check(configuration, "PPE");
+    d_check_SQM = add_check(configuration, "SQM");
+    d_check_AoA = add_check(configuration, "AoA");
+    d_check_spectrum = add_check(configuration, "spectrum");
+    d_check_position = add_check(configuration, "position");
+    d_check_RAIM = add_check(configuration, "RAIM");
+    d_check_Doppler = add_check(configuration, "Doppler");
+    d_check_subframe = add_check(configuration, "subframe");
+    d_check_nav_unit = add_check(configuration, "nav_unit");
 
-    global_spoofing_queue.push(msg);
-    for(std::set<unsigned int>::iterator it = msg.satellites.begin(); it != msg.satellites.end(); it++)
+    //state kept across restarts
+    std::string checkpoint_filename = configuration->property("Spoofing.checkpoint_filename", std::string(""));
+    if( !checkpoint_filename.empty() )
         {
-            global_spoofing_status.add(*it, 1);
+            int checkpoint_max_kb = configuration->property("Spoofing.checkpoint_max_kb", 1024);
+            d_checkpoint.reset(new Receiver_Checkpoint(checkpoint_filename, std::max(checkpoint_max_kb, 1) * 1024));
+            d_checkpoint_interval_ms = configuration->property("Spoofing.checkpoint_interval_s", 10.0) * 1e3;
+            restore_checkpoint(configuration->property("Spoofing.checkpoint_max_age_s", 4.0 * 3600.0),
+                    configuration->property("Spoofing.checkpoint_adopt_s", 300.0));
         }
-}
-
-int Spoofing_Detector::get_APT()
-{
-    return d_APT;
-}
-    
-double Spoofing_Detector::get_PPE_sampling()
-{
-    return d_PPE_sampling;
-}
-
-/*! 
- *  Check that the estimated receiver position has normal values, that is is non negative and 
- *  below the configurable value alt 
- */
-void Spoofing_Detector::check_position(double lat, double lng, double alt, double sample_counter) 
-{
-    if(~d_NAVI_alt)
-        return;
 
-    Spoofing_Message msg;
-    msg.spoofing_case = 4;
-    std::set<unsigned int> sats = {};
-    msg.satellites = sats;
-    if(alt < 0)
+    //collaborative checks with the other receivers of the site
+    if( configuration->property("Spoofing.peers", false) )
         {
-            std::stringstream s;
-            s << "Height of position is negative";
-            std::stringstream sr;
-            sr << "At " << sample_counter/(d_fs_in*1e3) << " the height of the calculated position was negative. The height was " << alt << " km.\n";
-            msg.description = s.str();
-            msg.spoofing_report = sr.str();
-            spoofing_detected(msg);
+            unsigned int peers_id = configuration->property("Spoofing.peers_id", 0u);
+            if( peers_id == 0 )
+                {
+                    std::random_device random;
+                    peers_id = std::max(static_cast<unsigned int>(random()), 1u);
+                }
+            std::string peers_address = configuration->property("Spoofing.peers_address", std::string("239.255.0.87"));
+            unsigned short peers_port = configuration->property("Spoofing.peers_port", static_cast<unsigned short>(7387));
+            unsigned short peers_listen_port = configuration->property("Spoofing.peers_listen_port", peers_port);
+            double peers_period_ms = configuration->property("Spoofing.peers_period_ms", 1000.0);
+            int peers_max = configuration->property("Spoofing.peers_max", 8);
+            d_peers_window = std::max(configuration->property("Spoofing.peers_window", 10), 1);
+            d_peer_link.reset(new Spoofing_Peer_Link(peers_id, std::max(peers_period_ms, 100.0), std::max(peers_max, 1)));
+            if( !d_peer_link->open(peers_address, peers_port, peers_listen_port,
+                    [this](const Spoofing_Peer_Summary& local, const Spoofing_Peer_Summary& peer) { check_peer(local, peer); }) )
+                {
+                    d_peer_link.reset();
+                }
         }
-    else if(alt > d_NAVI_max_alt)
+
+    //NAVI_external: assistance data is fetched in the background
+    if( d_NAVI_external && configuration->property("Spoofing.NAVI_external_supl", true) )
         {
-            std::stringstream s;
-            s << "Height of position is above " <<alt << " km";
-            std::stringstream sr;
-            sr << "At " << sample_counter/(d_fs_in*1e3) << " the height of the calculated position was " << alt 
-               << " km. SPREE is configured to raise an alarm if the altitude goes above " << d_NAVI_max_alt << ".\n";
-            msg.description = s.str();
-            msg.spoofing_report = sr.str();
-            spoofing_detected(msg);
+            std::string servers_str = configuration->property("Spoofing.NAVI_external_servers", std::string("supl.nokia.com"));
+            std::vector<std::string> servers;
+            boost::char_separator<char> sep(", ");
+            boost::tokenizer<boost::char_separator<char> > tokens(servers_str, sep);
+            for(boost::tokenizer<boost::char_separator<char> >::iterator it = tokens.begin(); it != tokens.end(); ++it)
+                {
+                    servers.push_back(*it);
+                }
+            int port = configuration->property("Spoofing.NAVI_external_port", 7275);
+            int mcc = configuration->property("Spoofing.NAVI_external_MCC", 244);
+            int mns = configuration->property("Spoofing.NAVI_external_MNS", 5);
+            int lac = configuration->property("Spoofing.NAVI_external_LAC", 0x59e2);
+            int ci = configuration->property("Spoofing.NAVI_external_CI", 0x31b0);
+            double ttl_s = configuration->property("Spoofing.NAVI_external_ttl_s", 1800.0);
+            double retry_s = configuration->property("Spoofing.NAVI_external_retry_s", 60.0);
+            std::string snapshot_file = configuration->property("Spoofing.NAVI_external_snapshot", std::string("../data/assistance.snap"));
+            bool export_xml = configuration->property("Spoofing.NAVI_external_xml", false);
+            d_supl_service.reset(new Supl_Assistance_Service(servers, port, mcc, mns, lac, ci, ttl_s, retry_s,
+                    boost::bind(&Spoofing_Detector::on_external_nav_data, this, _1), snapshot_file, export_xml));
+        }
+    //and the ephemeris are also checked against RINEX navigation files, read as they are updated
+    std::string rinex_path = configuration->property("Spoofing.NAVI_external_rinex", std::string(""));
+    if( d_NAVI_external && !rinex_path.empty() )
+        {
+            d_NAVI_external_rinex_tolerance = configuration->property("Spoofing.NAVI_external_rinex_tolerance", 1e-9);
+            d_rinex_source.reset(new Rinex_Nav_Source(rinex_path));
+            d_rinex_source->start(configuration->property("Spoofing.NAVI_external_rinex_poll_s", 60.0),
+                    boost::bind(&Spoofing_Detector::on_rinex_nav_data, this));
         }
 }
 
 /*!
- *  check that new ephemeris TOW (from a certain satellite) is consistent with the latest received TOW
- *  and the time duration between them. If the difference in these values is above the maximum allowed
- *  value a spoofing alarm is raised.
+ *  Thresholds of the checks. They are single words read by the channels,
+ *  the PVT and the telemetry decoders without a lock, so a check running
+ *  during the change can use some old and some new values.
  */
-void Spoofing_Detector::check_new_TOW(double current_timestamp_ms, int new_week, double new_TOW)
+void Spoofing_Detector::reconfigure(ConfigurationInterface* configuration)
 {
-    if( new_TOW == 0 )
-        return;
+    // APT
+    d_APT_ch_per_sat = configuration->property("Spoofing.APT_ch_per_sat", 2);
+    double APT_max_rx_discrepancy = configuration->property("Spoofing.APT_max_rx_discrepancy", 500);
+    d_APT_max_rx_discrepancy = APT_max_rx_discrepancy/1e6; //in [ms]
 
-    std::map<int, double> old_GPS_time;
-    old_GPS_time = global_last_gps_time.get_map_copy();
-    //DLOG(INFO) << "TOW " << new_TOW << " " << new_week << " " << old_GPS_time.size();
+    // PPE
+    d_PPE_sampling = configuration->property("Spoofing.PPE_sampling", 1e3);
+    d_CN0_threshold = configuration->property("Spoofing.CN0_threshold", 15);
+    d_RT_threshold = configuration->property("Spoofing.RT_threshold", 0.1);
+    d_Delta_threshold = configuration->property("Spoofing.Delta_threshold", 0.07);
 
-    int old_gps_time, new_gps_time;
-    double duration;
-    if(old_GPS_time.size() > 2)
-    {
-        DLOG(INFO) << "TOW " << new_TOW << " " << new_week << "\n"
-                   << "old TOW " << old_GPS_time.at(0) << " " << old_GPS_time.at(1);
-        if( old_GPS_time.at(0) == 0)
-            old_GPS_time.at(0) = new_week;
-        else if( new_week == 0)
-            new_week = old_GPS_time.at(0);
+    // SQM
+    d_SQM_ratio_threshold = configuration->property("Spoofing.SQM_ratio_threshold", 0.1);
+    d_SQM_delta_threshold = configuration->property("Spoofing.SQM_delta_threshold", 0.1);
+    d_SQM_asymmetry_threshold = configuration->property("Spoofing.SQM_asymmetry_threshold", 0.1);
 
-        double old_timestamp_ms = old_GPS_time.at(2);
+    // AoA
+    d_AoA_max_similarity = configuration->property("Spoofing.AoA_max_similarity", 0.9);
+    d_AoA_min_coherence = configuration->property("Spoofing.AoA_min_coherence", 0.5);
+    d_AoA_min_satellites = std::max(configuration->property("Spoofing.AoA_min_satellites", 4), 2);
 
-        old_gps_time = old_GPS_time.at(0)*seconds_per_week+old_GPS_time.at(1);
-        new_gps_time = new_week*seconds_per_week+new_TOW;
-        //duration = round((current_timestamp_ms-old_timestamp_ms)/1000.0);
-        duration = (current_timestamp_ms-old_timestamp_ms)/1000.0;
-        //DLOG(INFO) << "check new TOW " << duration << " " << std::abs(new_gps_time-old_gps_time);
+    // NAVI
+    d_NAVI_TOW_max_discrepancy = configuration->property("Spoofing.NAVI_TOW_max_discrepancy", 100);
+    d_NAVI_max_alt = configuration->property("Spoofing.NAVI_max_alt", 2e3);
+    d_satpos_max_jump_m = configuration->property("Spoofing.satpos_max_jump_m", 1000.0);
 
-        if( std::abs(std::abs(new_gps_time-old_gps_time)-duration) > d_NAVI_TOW_max_discrepancy) 
+    // RAIM
+    {
+        boost::mutex::scoped_lock lock(d_raim_mutex);
+        d_RAIM_sigma_m = configuration->property("Spoofing.RAIM_sigma_m", 5.0);
+        d_RAIM_sigma_dgps_m = configuration->property("Spoofing.RAIM_sigma_dgps_m", 1.0);
+        double RAIM_pfa = configuration->property("Spoofing.RAIM_pfa", 1e-5);
+        if (RAIM_pfa != d_RAIM_pfa)
             {
-                std::stringstream s;
-                std::stringstream sr;
-                s << "Navigational message manipulation detected\n";
-                s << "Time between the reception of the two navigational messages: " << duration << " s\n";
-                s << "Difference in TOW values: " << new_gps_time-old_gps_time << " s\n";
-                sr << "At " << current_timestamp_ms/1e3 << " s a navigational message manipulation was detected. ";
-                sr << "The time between the reception of the two navigational messages was " << duration << " s and the ";
-                sr << " difference in the TOW values was " << new_gps_time-old_gps_time << " s\n";
-                Spoofing_Message msg;
-                msg.spoofing_case = 3;
-                std::set<unsigned int> sats = {};
-                msg.satellites = sats;
-                msg.description = s.str();
-                msg.spoofing_report = sr.str();
-                spoofing_detected(msg);
+                d_RAIM_pfa = RAIM_pfa;
+                d_RAIM_thresholds.clear();
             }
     }
 
-    global_last_gps_time.write(0, new_week);
-    global_last_gps_time.write(1, new_TOW);
-    global_last_gps_time.write(2, current_timestamp_ms);
-}
+    // Doppler
+    d_Doppler_max_mps = configuration->property("Spoofing.Doppler_max_mps", 5.0);
 
-/*!
- * Check the change in epehemeris data. Whether it changes more frequently than 2 hours and if the 
- * change for certain values is too great.
- */
-void Spoofing_Detector::check_and_update_ephemeris(unsigned int PRN, Gps_Ephemeris eph, double time)
-{ 
-    std::map<int, sEph> sat_eph = global_sEph_map.get_map_copy();
-    sEph new_eph;
-    new_eph.time = time;
-    new_eph.ephemeris = eph;
+    // peers
+    d_peers_min_satellites = std::max(configuration->property("Spoofing.peers_min_satellites", 4), 2);
+    d_peers_CN0_min_spread_db = configuration->property("Spoofing.peers_CN0_min_spread_db", 0.5);
+    d_peers_max_subframe_offset_ms = configuration->property("Spoofing.peers_max_subframe_offset_ms", 1.0);
 
-    if(sat_eph.count(PRN))
-    {
+    // navigation message units
+    d_NAVI_time_max_discrepancy_ms = configuration->property("Spoofing.NAVI_time_max_discrepancy_ms", 50.0);
+    d_NAVI_unit_max_age_s = configuration->property("Spoofing.NAVI_unit_max_age_s", 60.0);
 
-        sEph old_ephemeris  = sat_eph.at(PRN); 
-        bool the_same = compare_ephemeris_dTOW(eph, old_ephemeris.ephemeris);
-        if(the_same)
-            return;
+    //Ephemeris thresholds, updated in place once the vector exists
+    std::vector<double> ephemeris_thresholds = nav_field_thresholds(gps_ephemeris_fields(), configuration);
+    if (d_ephemeris_thresholds.size() == ephemeris_thresholds.size())
+        {
+            std::copy(ephemeris_thresholds.begin(), ephemeris_thresholds.end(), d_ephemeris_thresholds.begin());
+        }
+    else
+        {
+            d_ephemeris_thresholds = ephemeris_thresholds;
+        }
 
-        Spoofing_Message msg;
-        msg.spoofing_case = 5;
-        std::set<unsigned int> sats = {PRN};
-        msg.satellites = sats;
-        
-        double TWO_HOURS_MS = 2*60*60*1000; //2 hours in ms 
-        double TEN_MIN_MS= 10*60*1000; //10 min in ms 
-        double TWENTYFOUR_HOURS_MS= 24*60*60*1000; //24 hours in ms 
-        if(old_ephemeris.changed && time > old_ephemeris.time &&  abs( (old_ephemeris.time - time) -TWO_HOURS_MS) < TEN_MIN_MS)
-            {
-                std::string s = "The Ephemeris has changed, though less than two hours have passed since the last change";
-                msg.description = s;
-                std::stringstream sr;
-                sr << "At " << time/1e3 << " s an ephemeris message was received that is different from the last one received" 
-                    << " even though less than 2 hours have passed since the last change in ephemeris data.\n";
-                msg.spoofing_report = sr.str();
-                spoofing_detected(msg);
-            }
+    //alarms
+    {
+        boost::mutex::scoped_lock lock(d_alarm_mutex);
+        double alarm_min_interval_ms = configuration->property("Spoofing.alarm_min_interval_ms", 1000.0);
+        d_alarm_min_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(alarm_min_interval_ms));
+    }
+}
 
-        if ( (time - old_ephemeris.time) < TWENTYFOUR_HOURS_MS) 
-            {
-                if(abs(eph.d_A_f0-old_ephemeris.ephemeris.d_A_f0) > d_A_f0) 
-                    {
-                        std::string s = "A_f0 change too great";
-                        msg.description = s;
-                        std::stringstream sr;
-                        sr << "At " << time/1e3 << " s an ephemeris message was received where the change in the value of A_f0" 
-                            << " was greater than is expected. Old value of A_f0: " << old_ephemeris.ephemeris.d_A_f0 << " New value of A_f0: " << eph.d_A_f0
-                            << ". SPREE is configured to raise an alarm if the change in A_f0 is above " << d_A_f0 << ".\n" ;
-                        msg.spoofing_report = sr.str();
-                        spoofing_detected(msg);
-                    }
+Spoofing_Detector::~Spoofing_Detector()
+{
+    if(d_scheduler)
+        {
+            std::vector<Spoofing_Check_Scheduler::Check_Stats> stats = d_scheduler->stats();
+            for(unsigned int i = 0; i < stats.size(); i++)
+                {
+                    LOG(INFO) << "Spoofing check " << stats[i].name
+                              << " (" << Spoofing_Check_Scheduler::context_name(stats[i].context) << "): "
+                              << stats[i].runs << " runs, mean " << stats[i].mean_us << " us, max " << stats[i].max_us << " us, "
+                              << stats[i].skipped_rate << " skipped by the interval, "
+                              << stats[i].skipped_budget << " by the budget (1 in " << stats[i].decimation << "), "
+                              << stats[i].dropped << " dropped";
+                }
+        }
+}
 
-                if(abs(eph.d_A_f1-old_ephemeris.ephemeris.d_A_f1) > d_A_f1) 
-                    {
-                        std::string s = "A_f1 change too great";
-                        msg.description = s;
-                        std::stringstream sr;
-                        sr << "At " << time/1e3 << " s an ephemeris message was received where the change in the value of A_f1" 
-                            << " was greater than is expected. Old value of A_f1: " << old_ephemeris.ephemeris.d_A_f1 << " New value of A_f1: " << eph.d_A_f1
-                            << ". SPREE is configured to raise an alarm if the change in A_f1 is above " << d_A_f1 << ".\n" ;
-                        msg.spoofing_report = sr.str();
-                        spoofing_detected(msg);
-                    }
+/*!
+ *  Registers a check in the scheduler, with its Spoofing.<name>_context
+ *  (inline, deferred or batched), _min_interval_ms and _budget_us. By
+ *  default the checks run inline on every input, as the blocks used to
+ *  call them.
+ */
+int Spoofing_Detector::add_check(ConfigurationInterface* configuration, const std::string& name)
+{
+    std::string context = configuration->property("Spoofing." + name + "_context", std::string("inline"));
+    double min_interval_ms = configuration->property("Spoofing." + name + "_min_interval_ms", 0.0);
+    double budget_us = configuration->property("Spoofing." + name + "_budget_us", 0.0);
+    return d_scheduler->add_check(name, Spoofing_Check_Scheduler::context_from_string(context, Spoofing_Check_Scheduler::INLINE),
+            min_interval_ms, budget_us);
+}
 
-                if(abs(eph.d_A_f2-old_ephemeris.ephemeris.d_A_f2) > d_A_f2) 
-                    {
-                        std::string s = "A_f2 change too great";
-                        msg.description = s;
-                        std::stringstream sr;
-                        sr << "At " << time/1e3 << " s an ephemeris message was received where the change in the value of A_f2" 
-                            << " was greater than is expected. Old value of A_f2: " << old_ephemeris.ephemeris.d_A_f2 << " New value of A_f2: " << eph.d_A_f2
-                            << ". SPREE is configured to raise an alarm if the change in A_f2 is above " << d_A_f2 << ".\n" ;
-                        msg.spoofing_report = sr.str();
-                        spoofing_detected(msg);
-                    }
+bool Spoofing_Detector::admit(int check, double time_ms)
+{
+    return !d_scheduler || d_scheduler->admit(check, time_ms);
+}
 
-                if(abs(eph.d_Crs-old_ephemeris.ephemeris.d_Crs) > d_Crs) 
-                    {
-                        std::string s = "Crs change too great";
-                        msg.description = s;
-                        std::stringstream sr;
-                        sr << "At " << time/1e3 << " s an ephemeris message was received where the change in the value of Crs" 
-                            << " was greater than is expected. Old value of Crs: " << old_ephemeris.ephemeris.d_Crs << " New value of Crs: " << eph.d_Crs
-                            << ". SPREE is configured to raise an alarm if the change in Crs is above " << d_Crs << ".\n" ;
-                        msg.spoofing_report = sr.str();
-                        spoofing_detected(msg);
-                    }
+bool Spoofing_Detector::is_inline(int check) const
+{
+    return !d_scheduler || d_scheduler->is_inline(check);
+}
 
-                if(abs(eph.d_Delta_n-old_ephemeris.ephemeris.d_Delta_n) > d_Delta_n) 
-                    {
-                        std::string s = "Delta_n change too great";
-                        msg.description = s;
-                        std::stringstream sr;
-                        sr << "At " << time/1e3 << " s an ephemeris message was received where the change in the value of Delta_n" 
-                            << " was greater than is expected. Old value of Delta_n: " << old_ephemeris.ephemeris.d_Delta_n << " New value of Delta_n: " << eph.d_Delta_n
-                            << ". SPREE is configured to raise an alarm if the change in Delta_n is above " << d_Delta_n << ".\n" ;
-                        msg.spoofing_report = sr.str();
-                        spoofing_detected(msg);
-                    }
+void Spoofing_Detector::dispatch(int check, const std::function<void()>& call)
+{
+    if(d_scheduler)
+        d_scheduler->dispatch(check, call);
+    else
+        call();
+}
 
-                if(abs(eph.d_M_0-old_ephemeris.ephemeris.d_M_0) > d_M_0) 
-                    {
-                        std::string s = "M_0 change too great";
-                        msg.description = s;
-                        std::stringstream sr;
-                        sr << "At " << time/1e3 << " s an ephemeris message was received where the change in the value of M_0" 
-                            << " was greater than is expected. Old value of M_0: " << old_ephemeris.ephemeris.d_M_0 << " New value of M_0: " << eph.d_M_0
-                            << ". SPREE is configured to raise an alarm if the change in M_0 is above " << d_M_0 << ".\n" ;
-                        msg.spoofing_report = sr.str();
-                        spoofing_detected(msg);
-                    }
+void Spoofing_Detector::flush_checks()
+{
+    if(d_scheduler)
+        d_scheduler->flush();
+}
 
-                if(abs(eph.d_Cuc-old_ephemeris.ephemeris.d_Cuc) > d_Cuc) 
-                    {
-                        std::string s = "Cuc change too great";
-                        msg.description = s;
-                        std::stringstream sr;
-                        sr << "At " << time/1e3 << " s an ephemeris message was received where the change in the value of Cuc" 
-                            << " was greater than is expected. Old value of Cuc: " << old_ephemeris.ephemeris.d_Cuc << " New value of Cuc: " << eph.d_Cuc
-                            << ". SPREE is configured to raise an alarm if the change in Cuc is above " << d_Cuc << ".\n" ;
-                        msg.spoofing_report = sr.str();
-                        spoofing_detected(msg);
-                    }
+namespace
+{
+// The inputs of the epoch checks, kept for the ones that do not run inline
+struct Epoch_copy
+{
+    Channel_List channels; // on the heap, it outlives the epoch
+    std::vector<Gnss_Synchro> synchros; // by channel
+    std::vector<Gnss_Synchro*> in;
+    int sample_counter;
+};
 
-                if(abs(eph.d_e_eccentricity-old_ephemeris.ephemeris.d_e_eccentricity) > d_e_eccentricity) 
-                    {
-                        std::string s = "e_eccentricity change too great";
-                        msg.description = s;
-                        std::stringstream sr;
-                        sr << "At " << time/1e3 << " s an ephemeris message was received where the change in the value of e_eccentricity" 
-                            << " was greater than is expected. Old value of e_eccentricity: " 
-                            << old_ephemeris.ephemeris.d_e_eccentricity << " New value of e_eccentricity: " << eph.d_e_eccentricity
-                            << ". SPREE is configured to raise an alarm if the change in e_eccentricity is above " << d_e_eccentricity << ".\n" ;
-                        msg.spoofing_report = sr.str();
-                        spoofing_detected(msg);
-                    }
+std::shared_ptr<Epoch_copy> copy_epoch(const Channel_List& channels, Gnss_Synchro **in, int sample_counter)
+{
+    std::shared_ptr<Epoch_copy> epoch = std::make_shared<Epoch_copy>();
+    epoch->channels = channels;
+    epoch->sample_counter = sample_counter;
+    unsigned int n_channels = 0;
+    for(Channel_List::const_iterator it = channels.begin(); it != channels.end(); ++it)
+        {
+            n_channels = std::max(n_channels, *it + 1);
+        }
+    epoch->synchros.resize(n_channels);
+    epoch->in.resize(n_channels);
+    for(unsigned int i = 0; i < n_channels; i++)
+        {
+            epoch->in[i] = &epoch->synchros[i];
+        }
+    for(Channel_List::const_iterator it = channels.begin(); it != channels.end(); ++it)
+        {
+            epoch->synchros[*it] = in[*it][0];
+        }
+    return epoch;
+}
+}
 
-                if(abs(eph.d_Cus-old_ephemeris.ephemeris.d_Cus) > d_Cus) 
-                    {
-                        std::string s = "Cus change too great";
-                        msg.description = s;
-                        std::stringstream sr;
-                        sr << "At " << time/1e3 << " s an ephemeris message was received where the change in the value of Cus" 
-                            << " was greater than is expected. Old value of Cus: " << old_ephemeris.ephemeris.d_Cus << " New value of Cus: " << eph.d_Cus
-                            << ". SPREE is configured to raise an alarm if the change in Cus is above " << d_Cus << ".\n" ;
-                        msg.spoofing_report = sr.str();
-                        spoofing_detected(msg);
-                    }
+/*!
+ *  An output of the PVT. One in Spoofing.PPE_sampling times the PPE
+ *  decimation of them is an epoch of the PPE, SQM and AoA checks.
+ */
+void Spoofing_Detector::new_epoch(const Channel_List& channels, Gnss_Synchro **in, int sample_counter)
+{
+    if(d_checkpoint && (d_last_checkpoint_ms < 0.0 || sample_counter - d_last_checkpoint_ms >= d_checkpoint_interval_ms))
+        {
+            d_last_checkpoint_ms = sample_counter;
+            save_checkpoint(channels, in, sample_counter);
+        }
+    if(d_peer_link && (d_last_peer_update_ms < 0.0 || sample_counter - d_last_peer_update_ms >= 100.0))
+        {
+            d_last_peer_update_ms = sample_counter;
+            for(Channel_List::const_iterator it = channels.begin(); it != channels.end(); ++it)
+                {
+                    d_peer_link->update_CN0(in[*it][0].PRN, in[*it][0].CN0_dB_hz);
+                }
+        }
 
-                if(abs(eph.d_sqrt_A-old_ephemeris.ephemeris.d_sqrt_A) > d_sqrt_A) 
-                    {
-                        std::string s = "sqrt_A change too great";
-                        msg.description = s;
-                        std::stringstream sr;
-                        sr << "At " << time/1e3 << " s an ephemeris message was received where the change in the value of sqrt_A" 
-                            << " was greater than is expected. Old value of sqrt_A: " << old_ephemeris.ephemeris.d_sqrt_A << " New value of sqrt_A: " << eph.d_sqrt_A
-                            << ". SPREE is configured to raise an alarm if the change in sqrt_A is above " << d_sqrt_A << ".\n" ;
-                        msg.spoofing_report = sr.str();
-                        spoofing_detected(msg);
-                    }
+    if(d_spectrum && admit(d_check_spectrum, sample_counter))
+        dispatch(d_check_spectrum, [this, sample_counter]() { check_spectrum(sample_counter); });
 
-                if(abs(eph.d_Cic-old_ephemeris.ephemeris.d_Cic) > d_Cic) 
-                    {
-                        std::string s = "Cic change too great";
-                        msg.description = s;
-                        std::stringstream sr;
-                        sr << "At " << time/1e3 << " s an ephemeris message was received where the change in the value of Cic" 
-                            << " was greater than is expected. Old value of Cic: " << old_ephemeris.ephemeris.d_Cic << " New value of Cic: " << eph.d_Cic
-                            << ". SPREE is configured to raise an alarm if the change in Cic is above " << d_Cic << ".\n" ;
-                        msg.spoofing_report = sr.str();
-                        spoofing_detected(msg);
-                    }
+    long int period = static_cast<long int>(d_PPE_sampling) * get_PPE_decimation();
+    if(period > 0 && sample_counter % period != 0)
+        return;
+    if(d_replay_writer)
+        d_replay_writer->write_epoch(channels, in, sample_counter);
 
-                if(abs(eph.d_OMEGA0-old_ephemeris.ephemeris.d_OMEGA0) > d_OMEGA0) 
-                    {
-                        std::string s = "OMEGA0 change too great";
-                        msg.description = s;
-                        std::stringstream sr;
-                        sr << "At " << time/1e3 << " s an ephemeris message was received where the change in the value of OMEGA0" 
-                            << " was greater than is expected. Old value of OMEGA0: " << old_ephemeris.ephemeris.d_OMEGA0 << " New value of OMEGA0: " << eph.d_OMEGA0
-                            << ". SPREE is configured to raise an alarm if the change in OMEGA0 is above " << d_OMEGA0 << ".\n" ;
-                        msg.spoofing_report = sr.str();
-                        spoofing_detected(msg);
-                    }
+    bool PPE = admit(d_check_PPE, sample_counter);
+    bool SQM = admit(d_check_SQM, sample_counter);
+    bool AoA = admit(d_check_AoA, sample_counter);
+    std::shared_ptr<Epoch_copy> epoch;
+    if((PPE && !is_inline(d_check_PPE)) || (SQM && !is_inline(d_check_SQM)) || (AoA && !is_inline(d_check_AoA)))
+        {
+            epoch = copy_epoch(channels, in, sample_counter);
+        }
+    if(PPE)
+        {
+            if(epoch)
+                dispatch(d_check_PPE, [this, epoch]() { PPE_moving_var(epoch->channels, epoch->in.data(), epoch->sample_counter); });
+            else
+                dispatch(d_check_PPE, [&]() { PPE_moving_var(channels, in, sample_counter); });
+        }
+    if(SQM)
+        {
+            if(epoch)
+                dispatch(d_check_SQM, [this, epoch]() { check_SQM(epoch->channels, epoch->in.data(), epoch->sample_counter); });
+            else
+                dispatch(d_check_SQM, [&]() { check_SQM(channels, in, sample_counter); });
+        }
+    if(AoA)
+        {
+            if(epoch)
+                dispatch(d_check_AoA, [this, epoch]() { check_AoA(epoch->channels, epoch->in.data(), epoch->sample_counter); });
+            else
+                dispatch(d_check_AoA, [&]() { check_AoA(channels, in, sample_counter); });
+        }
+}
 
-                if(abs(eph.d_Cis-old_ephemeris.ephemeris.d_Cis) > d_Cis) 
-                    {
-                        std::string s = "Cis change too great";
-                        msg.description = s;
-                        std::stringstream sr;
-                        sr << "At " << time/1e3 << " s an ephemeris message was received where the change in the value of Cis" 
-                            << " was greater than is expected. Old value of Cis: " << old_ephemeris.ephemeris.d_Cis << " New value of Cis: " << eph.d_Cis
-                            << ". SPREE is configured to raise an alarm if the change in Cis is above " << d_Cis << ".\n" ;
-                        msg.spoofing_report = sr.str();
-                        spoofing_detected(msg);
-                    }
+void Spoofing_Detector::new_position(double lat, double lng, double alt, double sample_counter)
+{
+    if(d_replay_writer)
+        d_replay_writer->write_position(lat, lng, alt, sample_counter);
+    if(admit(d_check_position, sample_counter))
+        dispatch(d_check_position, [this, lat, lng, alt, sample_counter]() { check_position(lat, lng, alt, sample_counter); });
+}
 
-                if(abs(eph.d_i_0-old_ephemeris.ephemeris.d_i_0) > d_i_0) 
-                    {
-                        std::string s = "i_0 change too great";
-                        msg.description = s;
-                        std::stringstream sr;
-                        sr << "At " << time/1e3 << " s an ephemeris message was received where the change in the value of i_0" 
-                            << " was greater than is expected. Old value of i_0: " << old_ephemeris.ephemeris.d_i_0 << " New value of i_0: " << eph.d_i_0
-                            << ". SPREE is configured to raise an alarm if the change in i_0 is above " << d_i_0 << ".\n" ;
-                        msg.spoofing_report = sr.str();
-                        spoofing_detected(msg);
-                    }
+void Spoofing_Detector::new_residuals(const std::vector<unsigned int>& prn, int n_obs, double ssr,
+        const std::vector<double>& subset_ssr, double sample_counter, bool differential)
+{
+    if(d_replay_writer)
+        d_replay_writer->write_residuals(prn, n_obs, ssr, subset_ssr, sample_counter, differential);
+    if(!admit(d_check_RAIM, sample_counter))
+        return;
+    if(is_inline(d_check_RAIM))
+        dispatch(d_check_RAIM, [&]() { check_residuals(prn, n_obs, ssr, subset_ssr, sample_counter, differential); });
+    else
+        dispatch(d_check_RAIM, [this, prn, n_obs, ssr, subset_ssr, sample_counter, differential]() { check_residuals(prn, n_obs, ssr, subset_ssr, sample_counter, differential); });
+}
 
-                if(abs(eph.d_Crc-old_ephemeris.ephemeris.d_Crc) > d_Crc) 
-                    {
-                        std::string s = "Crc change too great";
-                        msg.description = s;
-                        std::stringstream sr;
-                        sr << "At " << time/1e3 << " s an ephemeris message was received where the change in the value of Crc" 
-                           << " was greater than is expected. Old value of Crc: " << old_ephemeris.ephemeris.d_Crc << " New value of Crc: " << eph.d_Crc
-                           << ". SPREE is configured to raise an alarm if the change in Crc is above " << d_Crc << ".\n" ;
-                        msg.spoofing_report = sr.str();
-                        spoofing_detected(msg);
-                    }
+void Spoofing_Detector::new_doppler_residuals(const std::vector<unsigned int>& prn, const std::vector<double>& residuals, double sample_counter)
+{
+    if(d_replay_writer)
+        d_replay_writer->write_doppler(prn, residuals, sample_counter);
+    if(d_peer_link)
+        {
+            for(unsigned int i = 0; i < prn.size() && i < residuals.size(); i++)
+                {
+                    if(residuals[i] != 0.0)
+                        d_peer_link->update_doppler_residual(prn[i], residuals[i]);
+                }
+        }
+    if(!admit(d_check_Doppler, sample_counter))
+        return;
+    if(is_inline(d_check_Doppler))
+        dispatch(d_check_Doppler, [&]() { check_doppler(prn, residuals, sample_counter); });
+    else
+        dispatch(d_check_Doppler, [this, prn, residuals, sample_counter]() { check_doppler(prn, residuals, sample_counter); });
+}
 
-                if(abs(eph.d_OMEGA-old_ephemeris.ephemeris.d_OMEGA) > d_OMEGA) 
-                    {
-                        std::string s = "OMEGA change too great";
-                        msg.description = s;
-                        std::stringstream sr;
-                        sr << "At " << time/1e3 << " s an ephemeris message was received where the change in the value of OMEGA" 
-                            << " was greater than is expected. Old value of OMEGA: " << old_ephemeris.ephemeris.d_OMEGA << " New value of OMEGA: " << eph.d_OMEGA
-                            << ". SPREE is configured to raise an alarm if the change in OMEGA is above " << d_OMEGA << ".\n" ;
-                        msg.spoofing_report = sr.str();
-                        spoofing_detected(msg);
-                    }
-                
-                if(abs(eph.d_OMEGA_DOT-old_ephemeris.ephemeris.d_OMEGA_DOT) > d_OMEGA_DOT) 
-                    {
-                        std::string s = "OMEGA_DOT change too great";
-                        msg.description = s;
-                        std::stringstream sr;
-                        sr << "At " << time/1e3 << " s an ephemeris message was received where the change in the value of OMEGA_DOT" 
-                            << " was greater than is expected. Old value of OMEGA_DOT: " << old_ephemeris.ephemeris.d_OMEGA_DOT << " New value of OMEGA_DOT: " << eph.d_OMEGA_DOT
-                            << ". SPREE is configured to raise an alarm if the change in OMEGA_DOT is above " << d_OMEGA_DOT << ".\n" ;
-                        msg.spoofing_report = sr.str();
-                        spoofing_detected(msg);
-                    }
-
-                if(abs(eph.d_IDOT-old_ephemeris.ephemeris.d_IDOT) > d_IDOT) 
-                    {
-                        std::string s = "IDOT change too great";
-                        msg.description = s;
-                        std::stringstream sr;
-                        sr << "At " << time/1e3 << " s an ephemeris message was received where the change in the value of IDOT" 
-                            << " was greater than is expected. Old value of IDOT: " << old_ephemeris.ephemeris.d_IDOT << " New value of IDOT: " << eph.d_IDOT
-                            << ". SPREE is configured to raise an alarm if the change in IDOT is above " << d_IDOT << ".\n" ;
-                        msg.spoofing_report = sr.str();
-                        spoofing_detected(msg);
-                    }
-            }
+void Spoofing_Detector::new_subframe(int subframe_ID, int PRN, const Gps_Navigation_Message& nav, double time)
+{
+    if(!admit(d_check_subframe, time))
+        return;
+    if(is_inline(d_check_subframe))
+        dispatch(d_check_subframe, [&]() { New_subframe(subframe_ID, PRN, nav, time); });
+    else
+        dispatch(d_check_subframe, [this, subframe_ID, PRN, nav, time]() { New_subframe(subframe_ID, PRN, nav, time); });
+}
 
-        new_eph.changed = true;
-    }
-    global_sEph_map.write(PRN, new_eph); 
-}  
+void Spoofing_Detector::new_nav_unit(const Spoofing_Nav_Unit& unit)
+{
+    if(d_replay_writer)
+        d_replay_writer->write_nav_unit(unit);
+    if(!admit(d_check_nav_unit, unit.time_ms))
+        return;
+    if(is_inline(d_check_nav_unit))
+        dispatch(d_check_nav_unit, [&]() { check_nav_unit(unit); });
+    else
+        dispatch(d_check_nav_unit, [this, unit]() { check_nav_unit(unit); });
+}
 
+namespace
+{
+const uint32_t checkpoint_payload_version = 2;
+const double MAX_DOPPLER_RATE_HZ_S = 1.0;    // of a GPS satellite seen from the ground, about 0.9 Hz/s
+const double MAX_RESTORED_DOPPLER_UNCERTAINTY_HZ = 5e3;
 
-/*!
- *  Check for middle of earth attack
- */
-void Spoofing_Detector::check_middle_earth(unsigned int PRN, double sqrtA, double timestamp)
-{ 
-    if(sqrtA == 0)
-    {
-        std::stringstream s;
-        s << "Middle of the earth attack detected for satellite " << PRN;
-        std::stringstream sr;
-        sr << "At " << timestamp/1e3 << " s a middle of the earth attack was detected for satellite " << PRN << ".\n";
-        Spoofing_Message msg;
-        msg.spoofing_case = 5;
-        std::set<unsigned int> sats = {PRN};
-        msg.satellites = sats;
-        msg.description = s.str();
-        msg.spoofing_report = sr.str();
-        spoofing_detected(msg);
-    }
+double wall_time_s()
+{
+    return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
 
-}  
+void put_window(Checkpoint_Buffer& buffer, unsigned int capacity, const std::vector<double>& samples)
+{
+    buffer.put(static_cast<uint32_t>(capacity));
+    buffer.put(static_cast<uint32_t>(samples.size()));
+    for(unsigned int i = 0; i < samples.size(); i++)
+        buffer.put(samples[i]);
+}
 
-/*!
- *  Checks whether the change in the estimated satellite position is changing faster then made
- *  possible given the satellites speed given that the receiver is moving at a "normal" speed.
- */
-void Spoofing_Detector::check_satpos(unsigned int PRN, double time, double x, double y, double z) 
+void put_window(Checkpoint_Buffer& buffer, const Rolling_Statistics& window)
 {
-    Satpos p;
-    if(Satpos_map.count(PRN))
-        {
-            p = Satpos_map.at(PRN);
-            double sat_speed = 1400e3/(60*60); // [m/s]
-            double distance = sqrt(pow(p.x-x, 2)+pow(p.y-y, 2)+pow(p.z-z, 2));
-            double time_diff = std::abs(time-p.time)/1000.0;
-            //what to set as the max difference in position
-            if(distance != 0  && ((distance - time_diff*sat_speed) > 500 || (distance - time_diff*sat_speed) < 10e3))
-                {
-                    std::stringstream s;
-                    s << "New satellite position for sat: " << PRN << " is further away from last reported position." << std::endl;
-                    s << "  Distance: " << distance/1e3 << " [km] " << " time difference: " << time_diff << std::endl;
-                    s << "  New pos: (" << p.x << ", " << p.y << ", " << p.z << ") old pos: (" << x << ", " << y << ", " << z << ")";
-                    std::stringstream sr;
-                    sr << "At " << time/1e3 << " s a new satellite position for sat: " << PRN << " was calculated that is further away from last reported position"
-                       << " than was expected." 
-                       << "  Distance: " << distance/1e3 << " [km] " << " time difference: " << time_diff 
-                       << "  New pos: (" << p.x << ", " << p.y << ", " << p.z << ") old pos: (" << x << ", " << y << ", " << z << ")\n";
-                    Spoofing_Message msg;
-                    msg.spoofing_case = 5;
-                    std::set<unsigned int> sats = {PRN};
-                    msg.satellites = sats;
-                    msg.description = s.str();
-                    msg.spoofing_report = sr.str();
-                    spoofing_detected(msg);
+    put_window(buffer, window.capacity(), window.samples());
+}
 
-                }
-        }
+bool get_window(Checkpoint_Buffer& buffer, Rolling_Statistics& window)
+{
+    uint32_t capacity, n;
+    if(!buffer.get(capacity) || !buffer.get(n) || n > capacity)
+        return false;
+    window = Rolling_Statistics(capacity);
+    double x;
+    for(unsigned int i = 0; i < n; i++)
+        {
+            if(!buffer.get(x))
+                return false;
+            window.push_back(x);
+        }
+    return true;
+}
 
-    p.x = x;
-    p.y = y;
-    p.y = z;
-    p.time = time;
-    Satpos_map[PRN] = p;
+bool get_window(Checkpoint_Buffer& buffer, Rolling_Covariance& window)
+{
+    uint32_t capacity, n;
+    if(!buffer.get(capacity) || !buffer.get(n) || n > capacity)
+        return false;
+    window = Rolling_Covariance(capacity);
+    double x, y;
+    for(unsigned int i = 0; i < n; i++)
+        {
+            if(!buffer.get(x) || !buffer.get(y))
+                return false;
+            window.push_back(x, y);
+        }
+    return true;
+}
 }
 
 /*!
- *  Checks whether all tracked satellite signals are reporting the same GPS time.
+ *  Writes what takes the longest to rebuild after a restart: the ephemeris
+ *  history and the last GPS time of the NAVI checks, the windows of the PPE
+ *  checks, and the last fix and Doppler of every tracked satellite, which
+ *  let the acquisition start with the satellites in view. The times of the
+ *  detector count from the start of the receiver, so the receiver time of
+ *  the checkpoint is kept to carry them over to the next run.
  */
-void Spoofing_Detector::check_GPS_time()
+void Spoofing_Detector::save_checkpoint(const Channel_List& channels, Gnss_Synchro **in, int sample_counter)
 {
-    std::map<int, GPS_time_t> gps_times = global_gps_time.get_map_copy();
-    std::set<int> GPS_TOW;
-    int GPS_week, TOW;
-    std::set<int> subframe_IDs;
-    double smallest = 0; 
-    double largest = 0;
-    GPS_time_t gps_time;
-    //check that the GPS week is consistent between all satellites
-    for(std::map<int, GPS_time_t>::iterator it = gps_times.begin(); it != gps_times.end(); ++it)
-        {
-            gps_time = it->second;
-            GPS_week = gps_time.week; 
-            if(GPS_week == 0)
-                continue;
-
-            if(gps_time.timestamp > largest)
-                largest = gps_time.timestamp;
-            if(gps_time.timestamp < smallest)
-                smallest  = gps_time.timestamp;
-
-            TOW = GPS_week*604800+gps_time.TOW;
-            GPS_TOW.insert(TOW);
-            subframe_IDs.insert(gps_time.subframe_id);
-            DLOG(INFO) << "ts " << gps_time.timestamp << " TOW: " << TOW << " subframe: " << gps_time.subframe_id << " " << it->first;
+    static const std::shared_ptr<Block_Metrics> metrics = make_block_metrics("spoofing", "save_checkpoint");
+    Block_Metrics_Scope metrics_scope(metrics.get(), 0);
+    metrics_scope.set_items(1);
+
+    Checkpoint_Buffer buffer;
+    buffer.put(checkpoint_payload_version);
+    buffer.put(static_cast<double>(sample_counter));
+
+    // NAVI: last GPS time and ephemeris history
+    std::map<int, double> last_gps_time = d_receiver_state->last_gps_time.get_map_copy();
+    uint8_t has_gps_time = last_gps_time.count(0) && last_gps_time.count(1) && last_gps_time.count(2);
+    buffer.put(has_gps_time);
+    if(has_gps_time)
+        {
+            buffer.put(last_gps_time[0]);
+            buffer.put(last_gps_time[1]);
+            buffer.put(last_gps_time[2]);
+        }
+    std::vector<unsigned int> ephemeris_PRNs = d_receiver_state->ephemeris_history.satellites();
+    const std::vector<Nav_Field<Gps_Ephemeris> >& fields = gps_ephemeris_fields();
+    buffer.put(static_cast<uint32_t>(ephemeris_PRNs.size()));
+    buffer.put(static_cast<uint32_t>(fields.size()));
+    for(unsigned int n = 0; n < ephemeris_PRNs.size(); n++)
+        {
+            std::vector<sEph> records = d_receiver_state->ephemeris_history.records(ephemeris_PRNs[n]);
+            buffer.put(static_cast<int32_t>(ephemeris_PRNs[n]));
+            buffer.put(static_cast<uint32_t>(records.size()));
+            for(unsigned int r = 0; r < records.size(); r++)
+                {
+                    buffer.put(records[r].time);
+                    for(unsigned int i = 0; i < fields.size(); i++)
+                        buffer.put(fields[i].value(records[r].ephemeris));
+                    buffer.put(records[r].ephemeris.d_IODE_SF2);
+                    buffer.put(records[r].ephemeris.d_IODE_SF3);
+                }
         }
 
+    // last fix and Doppler of the tracked satellites
+    Gps_Ref_Location location;
+    Gps_Ref_Time ref_time;
+    uint8_t has_fix = d_receiver_state->gps_ref_location_map.read(0, location) && location.valid
+            && d_receiver_state->gps_ref_time_map.read(0, ref_time) && ref_time.valid;
+    buffer.put(has_fix);
+    if(has_fix)
+        {
+            buffer.put(location.lat);
+            buffer.put(location.lon);
+            buffer.put(location.uncertainty);
+            buffer.put(ref_time.d_TOW);
+            buffer.put(ref_time.d_Week);
+            buffer.put(ref_time.d_tv_sec);
+            buffer.put(ref_time.d_tv_usec);
+        }
+    std::map<unsigned int, double> dopplers;
+    for(Channel_List::const_iterator it = channels.begin(); it != channels.end(); ++it)
+        {
+            dopplers[in[*it][0].PRN] = in[*it][0].Carrier_Doppler_hz;
+        }
+    buffer.put(static_cast<uint32_t>(dopplers.size()));
+    for(std::map<unsigned int, double>::const_iterator it = dopplers.begin(); it != dopplers.end(); ++it)
+        {
+            buffer.put(static_cast<uint32_t>(it->first));
+            buffer.put(it->second);
+        }
 
-    if(GPS_TOW.size() > subframe_IDs.size())
+    // PPE windows
     {
-        std::string s =  "Satellites GPS TOW are not synced";
-        std::stringstream sr;
-        sr << "At " << largest/1e3 << " s a navigational message manipulation was detected. ";
-        sr <<  "The TOW of the satellites are not synced.\n";
-        Spoofing_Message msg;
-        msg.spoofing_case = 4;
-        std::set<unsigned int> sats = {};
-        msg.satellites = sats;
-        msg.description = s;
-        msg.spoofing_report = sr.str();
-        spoofing_detected(msg);
-
-        for(std::set<int>::iterator it = GPS_TOW.begin(); it != GPS_TOW.end(); ++it)
+        boost::mutex::scoped_lock lock(d_ppe_mutex);
+        put_window(buffer, ppe_cb);
+        buffer.put(static_cast<uint32_t>(sat_buffs.size()));
+        for(int PRN = 0; PRN <= Sat_Buff_Table::max_PRN; PRN++)
             {
-                DLOG(INFO) << "TOW " << *it; 
+                if(!sat_buffs.count(PRN))
+                    continue;
+                const SatBuff& sb = sat_buffs.at(PRN);
+                buffer.put(static_cast<int32_t>(PRN));
+                buffer.put(sb.last_snr);
+                buffer.put(sb.last_rt);
+                buffer.put(sb.last_delta);
+                buffer.put(static_cast<int32_t>(sb.count));
+                put_window(buffer, sb.SNR_cb);
+                put_window(buffer, sb.delta_cb);
+                put_window(buffer, sb.RT_cb);
             }
-        for(std::set<int>::iterator it = subframe_IDs.begin(); it != subframe_IDs.end(); ++it)
+        std::vector<unsigned int> SNR_slots;
+        for(unsigned int a = 0; a < satellite_SNR_corr.slots(); a++)
             {
-                DLOG(INFO) << "subframe " << *it; 
+                if(satellite_SNR_corr.active(a))
+                    SNR_slots.push_back(a);
             }
+        buffer.put(static_cast<uint32_t>(SNR_slots.size()));
+        for(unsigned int n = 0; n < SNR_slots.size(); n++)
+            {
+                unsigned int PRN = satellite_SNR_corr.id(SNR_slots[n]);
+                buffer.put(static_cast<int32_t>(PRN));
+                put_window(buffer, satellite_SNR_corr.capacity(), satellite_SNR_corr.samples(PRN));
+            }
+        // the pairs are rebuilt from the windows of the satellites
+        buffer.put(static_cast<uint32_t>(0));
     }
-}
-
-float get_Delta(gr_complex early_s1, gr_complex late_s1, gr_complex prompt_s1)
-{
-    return (early_s1.real() - late_s1.real()) / (2*prompt_s1.real());
-
-}
 
-float get_RT(gr_complex early_s1, gr_complex late_s1, gr_complex prompt_s1)
-{
-    return (early_s1.real() + late_s1.real()) / (2*prompt_s1.real());
+    if(!d_checkpoint->save(buffer.data(), wall_time_s()))
+        {
+            LOG(WARNING) << "Spoofing detector checkpoint of " << buffer.data().size() << " bytes not saved, the file holds "
+                         << d_checkpoint->capacity();
+        }
 }
 
-
 /*!
- *  Spoofing detection based on: calculating the variance of SNR, delta and RT over a given window for each satellite
- *  and calulate the mean of this. 
+ *  Restores the last checkpoint, unless it is older than max_age_s. The
+ *  receiver times of the last run become negative times of this one, as if
+ *  the receiver had kept running since. The windows of the PPE checks wait
+ *  for their satellites to be tracked again, for at most adopt_s.
  */
-//TODO: find better name
-void Spoofing_Detector::PPE_moving_var(std::list<unsigned int> channels, Gnss_Synchro **in, int sample_counter)
+void Spoofing_Detector::restore_checkpoint(double max_age_s, double adopt_s)
 {
-    std::vector<unsigned int> PRNs;
-    unsigned int PRN, i;
-    for(std::list<unsigned int>::iterator it = channels.begin(); it != channels.end(); ++it)
-    {
-        i = *it;
-        PRN  = in[i][0].PRN;
-        PRNs.push_back(PRN);
-
-        float CN0 = in[i][0].CN0_dB_hz;
-        float RT = get_RT(*in[i][0].Early, *in[i][0].Late, *in[i][0].Prompt);
-        float Delta = get_Delta(*in[i][0].Early, *in[i][0].Late, *in[i][0].Prompt);
+    std::string payload;
+    double checkpoint_wall_time_s;
+    if(!d_checkpoint->load(payload, checkpoint_wall_time_s))
+        return;
+    double age_s = wall_time_s() - checkpoint_wall_time_s;
+    if(age_s < 0.0 || age_s > max_age_s)
+        {
+            LOG(INFO) << "Spoofing detector checkpoint of " << age_s << " s ago not restored";
+            return;
+        }
 
-        //we have a buffer with previous SNR samples
-        if(!sat_buffs.count(PRN)) 
-            {
-                SatBuff satbuff;
-                satbuff.init(d_PPE_window_size);
-                satbuff.PRN = PRN;
-                sat_buffs[PRN] = satbuff; 
-            }
-        sat_buffs.at(PRN).add(CN0, RT, Delta);
-    }
+    Checkpoint_Buffer buffer(payload);
+    uint32_t version;
+    double checkpoint_ms;
+    if(!buffer.get(version) || version != checkpoint_payload_version || !buffer.get(checkpoint_ms))
+        {
+            LOG(WARNING) << "Spoofing detector checkpoint of an unknown version not restored";
+            return;
+        }
+    double offset_ms = - checkpoint_ms - age_s * 1e3;
 
-    //remove satellites from the buffers if they are no longer being tracked
-    std::list<unsigned int> sats_to_be_removed;
-    for(std::map<int, SatBuff>::iterator it = sat_buffs.begin(); it != sat_buffs.end(); it++)
+    // NAVI
+    uint8_t has_gps_time;
+    if(!buffer.get(has_gps_time))
+        return;
+    if(has_gps_time)
         {
-            if( std::find(PRNs.begin(), PRNs.end(), it->first) == PRNs.end())
+            double week, TOW, timestamp;
+            if(!buffer.get(week) || !buffer.get(TOW) || !buffer.get(timestamp))
+                return;
+            d_receiver_state->last_gps_time.write(0, week);
+            d_receiver_state->last_gps_time.write(1, TOW);
+            d_receiver_state->last_gps_time.write(2, timestamp + offset_ms);
+        }
+    uint32_t n_ephemeris, n_fields;
+    if(!buffer.get(n_ephemeris) || !buffer.get(n_fields))
+        return;
+    const std::vector<Nav_Field<Gps_Ephemeris> >& fields = gps_ephemeris_fields();
+    for(unsigned int n = 0; n < n_ephemeris; n++)
+        {
+            int32_t PRN;
+            uint32_t n_records;
+            if(!buffer.get(PRN) || !buffer.get(n_records))
+                return;
+            for(unsigned int r = 0; r < n_records; r++)
                 {
-                    sats_to_be_removed.push_back(it->first);
+                    Gps_Ephemeris eph;
+                    double time;
+                    if(!buffer.get(time))
+                        return;
+                    for(unsigned int i = 0; i < n_fields; i++)
+                        {
+                            double value;
+                            if(!buffer.get(value))
+                                return;
+                            if(i < fields.size())
+                                fields[i].set_value(eph, value);
+                        }
+                    if(!buffer.get(eph.d_IODE_SF2) || !buffer.get(eph.d_IODE_SF3))
+                        return;
+                    eph.i_satellite_PRN = PRN;
+                    d_receiver_state->ephemeris_history.store(PRN, eph, time + offset_ms);
                 }
         }
 
-    for(std::list<unsigned int>::iterator it = sats_to_be_removed.begin(); it != sats_to_be_removed.end(); ++it)
-    {
-        sat_buffs.erase(*it); 
-    }
-    
-    //caluclate the mean of the variances
-    //calc_mean_var(sample_counter);
-    //caluclate the max of the variances
-    calc_max_var(sample_counter);
-    
-}
-
-double get_mean(boost::circular_buffer<double> v)
-{
-    double sum = 0;
+    // last fix and Doppler, unless this run already has better ones
+    uint8_t has_fix;
+    if(!buffer.get(has_fix))
+        return;
+    Gps_Ref_Location location;
+    Gps_Ref_Time ref_time;
+    if(has_fix)
+        {
+            if(!buffer.get(location.lat) || !buffer.get(location.lon) || !buffer.get(location.uncertainty)
+                    || !buffer.get(ref_time.d_TOW) || !buffer.get(ref_time.d_Week)
+                    || !buffer.get(ref_time.d_tv_sec) || !buffer.get(ref_time.d_tv_usec))
+                return;
+            location.valid = true;
+            ref_time.valid = true;
+            Gps_Ref_Location current_location;
+            if(!d_receiver_state->gps_ref_location_map.read(0, current_location) || !current_location.valid)
+                {
+                    d_receiver_state->gps_ref_location_map.write(0, location);
+                    d_receiver_state->gps_ref_time_map.write(0, ref_time);
+                }
+        }
+    uint32_t n_dopplers;
+    if(!buffer.get(n_dopplers))
+        return;
+    double doppler_uncertainty = std::max(1e3, MAX_DOPPLER_RATE_HZ_S * age_s);
+    for(unsigned int n = 0; n < n_dopplers; n++)
+        {
+            uint32_t PRN;
+            double doppler;
+            if(!buffer.get(PRN) || !buffer.get(doppler))
+                return;
+            Gps_Acq_Assist assist;
+            if(doppler_uncertainty > MAX_RESTORED_DOPPLER_UNCERTAINTY_HZ || d_receiver_state->gps_acq_assist_map.read(PRN, assist))
+                continue;
+            assist.i_satellite_PRN = PRN;
+            assist.d_TOW = has_fix ? ref_time.d_TOW + age_s : 0.0;
+            assist.d_Doppler0 = doppler;
+            assist.dopplerUncertainty = doppler_uncertainty;
+            d_receiver_state->gps_acq_assist_map.write(PRN, assist);
+        }
 
-    for(boost::circular_buffer<double>::iterator it = v.begin(); it != v.end(); it++)
+    // PPE windows
+    boost::mutex::scoped_lock lock(d_ppe_mutex);
+    if(!get_window(buffer, ppe_cb))
+        return;
+    uint32_t n;
+    if(!buffer.get(n))
+        return;
+    for(unsigned int i = 0; i < n; i++)
+        {
+            int32_t PRN, count;
+            SatBuff satbuff;
+            if(!buffer.get(PRN) || !buffer.get(satbuff.last_snr) || !buffer.get(satbuff.last_rt)
+                    || !buffer.get(satbuff.last_delta) || !buffer.get(count)
+                    || !get_window(buffer, satbuff.SNR_cb) || !get_window(buffer, satbuff.delta_cb)
+                    || !get_window(buffer, satbuff.RT_cb))
+                return;
+            satbuff.PRN = PRN;
+            satbuff.count = count;
+            d_restored_sat_buffs[PRN] = satbuff;
+        }
+    if(!buffer.get(n))
+        return;
+    for(unsigned int i = 0; i < n; i++)
         {
-            sum += *it;
+            int32_t PRN;
+            Rolling_Statistics window;
+            if(!buffer.get(PRN) || !get_window(buffer, window))
+                return;
+            d_restored_SNR[PRN] = window;
         }
-
-    return (sum / v.size());
+    if(!buffer.get(n))
+        return;
+    for(unsigned int i = 0; i < n; i++)
+        {
+            // pair windows of older checkpoints
+            int32_t a, b;
+            Rolling_Covariance window;
+            if(!buffer.get(a) || !buffer.get(b) || !get_window(buffer, window))
+                return;
+        }
+    d_restored_until_ms = adopt_s * 1e3;
+    LOG(INFO) << "Spoofing detector checkpoint of " << age_s << " s ago restored: " << n_ephemeris << " ephemeris, "
+              << d_restored_sat_buffs.size() << " PPE windows";
 }
 
-
-
-double get_var(boost::circular_buffer<double> a)
+/*!
+ *  Logs the occurance of a spoofing alarm.
+ */
+void Spoofing_Detector::spoofing_detected(Spoofing_Message msg)
 {
-    double mean_a = get_mean(a);
-    
-    double sum = 0;
-    if( a.size() == 0)
+    Latency_Trace::record_alarm(msg.spoofing_case);
+    for(std::set<unsigned int>::iterator it = msg.satellites.begin(); it != msg.satellites.end(); it++)
         {
-            DLOG(INFO) << "vectors are empty, can't calculate convariance";
-            return 0;
+            d_receiver_state->spoofing_status.add(*it, 1);
+            if(d_peer_link)
+                d_peer_link->update_alarm(*it, msg.spoofing_case);
+        }
+
+    // rate limit the alarms with the same case and satellites, counting the repetitions
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    boost::mutex::scoped_lock lock(d_alarm_mutex);
+    Alarm_state& state = d_alarm_states[std::make_pair(msg.spoofing_case, msg.satellites)];
+    if(state.reported && now - state.last_report < d_alarm_min_interval)
+        {
+            state.suppressed++;
+            return;
         }
+    msg.suppressed = state.suppressed;
+    state.reported = true;
+    state.last_report = now;
+    state.suppressed = 0;
+    lock.unlock();
 
-    for(unsigned int i = 0; i < a.size(); i++)
+    // store the samples around the alarm, if the signal conditioners keep them
+    flight_recorder_trigger_all(msg.description);
+
+    // the report text is written by the Spoofing_Report_Writer thread
+    if(!d_receiver_state->spoofing_queue.push(msg))
         {
-            sum += ( a[i]-mean_a ) * ( a[i]-mean_a ); 
+            DLOG(INFO) << "Spoofing alarm queue full, alarm dropped: " << msg.description;
         }
-    return sum / a.size();
 }
 
-void Spoofing_Detector::calc_max_var(int sample_counter)
+int Spoofing_Detector::get_APT()
 {
-    double max_snr_var = 0;
-    double max_delta_var = 0;
-    double max_rt_var = 0;
+    return d_APT;
+}
     
-    for(std::map<int, SatBuff>::iterator it = sat_buffs.begin(); it != sat_buffs.end(); it++)
-        {
-            SatBuff sb = it->second;
-            if( sb.count < d_PPE_window_size )
-                continue;
+double Spoofing_Detector::get_PPE_sampling()
+{
+    return d_PPE_sampling;
+}
 
-            if(max_snr_var < get_var(sb.SNR_cb))
-                max_snr_var = get_var(sb.SNR_cb);
-            if(max_delta_var < get_var(sb.delta_cb))
-                max_delta_var = get_var(sb.delta_cb);
-            if(max_rt_var < get_var(sb.RT_cb))
-                max_rt_var = get_var(sb.RT_cb);
-        }
+void Spoofing_Detector::set_PPE_decimation(int decimation)
+{
+    d_PPE_decimation.store(std::max(decimation, 1), std::memory_order_relaxed);
+}
+
+bool Spoofing_Detector::get_report_json()
+{
+    return d_report_json;
+}
+
+/*! 
+ *  Check that the estimated receiver position has normal values, that is is non negative and 
+ *  below the configurable value alt 
+ */
+void Spoofing_Detector::check_position(double lat, double lng, double alt, double sample_counter) 
+{
+    if(~d_NAVI_alt)
+        return;
 
     Spoofing_Message msg;
-    msg.spoofing_case = 10;
+    msg.spoofing_case = 4;
     std::set<unsigned int> sats = {};
     msg.satellites = sats;
-    if( max_snr_var >= d_CN0_threshold )
+    if(alt < 0)
         {
             std::stringstream s;
-            s << " The CN0 indicates a spoofing attack"; 
-            s << " CN0: " << max_snr_var;
-            s << ", " << sample_counter; 
-            msg.description = s.str();
+            s << "Height of position is negative";
             std::stringstream sr;
-            sr << "At " << sample_counter/(d_fs_in*1e3) << " s the moving standard variantion of CN0 was above the expected value." 
-              << " CN0: " << max_snr_var << ". SPREE is configured to raise an alarm if it is above " << d_CN0_threshold << ".\n";
-            msg.spoofing_report = sr.str();
-            spoofing_detected(msg);
-        }
-    if( max_rt_var >= d_RT_threshold )
-        {
-            std::stringstream s;
-            s << " The RT indicates a spoofing attack"; 
-            s << " RT: " << max_rt_var;
-            s << ", " << sample_counter; 
+            sr << "At " << sample_counter/(d_fs_in*1e3) << " the height of the calculated position was negative. The height was " << alt << " km.\n";
             msg.description = s.str();
-            std::stringstream sr;
-            sr << "At " << sample_counter/(d_fs_in*1e3) << " s the moving standard variantion of RT was above the expected value." 
-              << " RT: " << max_rt_var << ". SPREE is configured to raise an alarm if it is above " << d_RT_threshold << ".\n";
             msg.spoofing_report = sr.str();
             spoofing_detected(msg);
         }
-    if( max_delta_var >= d_Delta_threshold )
+    else if(alt > d_NAVI_max_alt)
         {
             std::stringstream s;
-            s << " The Delta indicates a spoofing attack"; 
-            s << " Delta: " << max_delta_var;
-            s << ", " << sample_counter; 
-            msg.description = s.str();
+            s << "Height of position is above " <<alt << " km";
             std::stringstream sr;
-            sr << "At " << sample_counter/(d_fs_in*1e3) << " s the moving standard variantion of delta was above the expected value." 
-              << " Delta: " << max_delta_var << ". SPREE is configured to raise an alarm if it is above " << d_Delta_threshold << ".\n";
+            sr << "At " << sample_counter/(d_fs_in*1e3) << " the height of the calculated position was " << alt 
+               << " km. SPREE is configured to raise an alarm if the altitude goes above " << d_NAVI_max_alt << ".\n";
+            msg.description = s.str();
             msg.spoofing_report = sr.str();
             spoofing_detected(msg);
         }
 }
 
-
-double get_cov(boost::circular_buffer<double> a, boost::circular_buffer<double> b)
+/*!
+ *  Chi-square threshold that the normalized sum of squared residuals of a fix
+ *  with dof degrees of freedom exceeds with probability d_RAIM_pfa.
+ */
+double Spoofing_Detector::raim_threshold(int dof)
 {
-    double mean_a = get_mean(a);
-    double mean_b = get_mean(b);
-    
-    double sum = 0;
-    if(a.size() != b.size())
-        {
-            DLOG(ERROR) << "vectors are not same length, can't calculate convariance";
-            return 0;
-        }
-    if( a.size() == 0)
-        {
-            DLOG(INFO) << "vectors are empty, can't calculate convariance";
-            return 0;
-        }
-
-    for(unsigned int i = 0; i < a.size(); i++)
+    boost::mutex::scoped_lock lock(d_raim_mutex);
+    std::map<int, double>::iterator it = d_RAIM_thresholds.find(dof);
+    if(it != d_RAIM_thresholds.end())
         {
-            sum += ( a[i]-mean_a ) * ( b[i]-mean_b ); 
+            return it->second;
         }
-    return sum / a.size();
+    boost::math::chi_squared chi2(static_cast<double>(dof));
+    double threshold = boost::math::quantile(boost::math::complement(chi2, d_RAIM_pfa));
+    d_RAIM_thresholds[dof] = threshold;
+    return threshold;
 }
 
-double Spoofing_Detector::StdDeviation(std::vector<double> v)
+/*!
+ *  Residual based integrity check of the position fix. With more than four
+ *  satellites the least squares fix is overdetermined, and the sum of the
+ *  squared residuals, normalized by the pseudorange noise, follows a
+ *  chi-square distribution. A larger value means that some pseudoranges do not
+ *  agree with the others, as when a spoofer takes over some of the channels.
+ *  The leave-one-out fixes tell which satellite (or which APT peak, as each
+ *  channel is an observation of its own) is the outlier.
+ */
+void Spoofing_Detector::check_residuals(const std::vector<unsigned int>& prn, int n_obs, double ssr,
+        const std::vector<double>& subset_ssr, double sample_counter, bool differential)
 {
-    double sum = std::accumulate(v.begin(), v.end(), 0.0);
-    double mean = sum / v.size();
-    std::vector<double> diff(v.size());
-    std::transform(v.begin(), v.end(), diff.begin(),
-        std::bind2nd(std::minus<double>(), mean));
-
-    double sq_sum = std::inner_product(diff.begin(), diff.end(), diff.begin(), 0.0);
-    double stdev = std::sqrt(sq_sum / v.size());
-    return stdev;
-}
+    if(!d_RAIM)
+        return;
+    // the checks of all the detectors add to the same counters
+    static const std::shared_ptr<Block_Metrics> metrics = make_block_metrics("spoofing", "check_residuals");
+    Block_Metrics_Scope metrics_scope(metrics.get(), prn.size());
+    metrics_scope.set_items(1);
 
+    int dof = n_obs - 4;
+    if(dof < 1 || subset_ssr.size() != prn.size())
+        return;
 
-double get_stdDev(std::vector<double> v, double mean)
-{
-    double sum = 0;
+    double sigma = differential ? d_RAIM_sigma_dgps_m : d_RAIM_sigma_m;
+    double sigma2 = sigma * sigma;
+    double test = ssr / sigma2;
+    double threshold = raim_threshold(dof);
+    if(test <= threshold)
+        return;
 
-    for(std::vector<double>::iterator it = v.begin(); it != v.end(); it++)
+    // fault exclusion: the subset with the smallest residuals, if they are consistent
+    int excluded = -1;
+    if(dof > 1)
         {
-            sum += (*it-mean)*(*it-mean); 
+            for(unsigned int i = 0; i < subset_ssr.size(); i++)
+                {
+                    if(subset_ssr[i] >= 0 && subset_ssr[i] < ssr && (excluded < 0 || subset_ssr[i] < subset_ssr[excluded]))
+                        {
+                            excluded = i;
+                        }
+                }
+            if(excluded >= 0 && subset_ssr[excluded] / sigma2 > raim_threshold(dof - 1))
+                {
+                    excluded = -1;
+                }
         }
-    return std::sqrt(sum / v.size());
 
+    Spoofing_Message msg;
+    msg.spoofing_case = 7;
+    std::set<unsigned int> sats = {};
+    std::stringstream s;
+    std::stringstream sr;
+    sr << "At " << sample_counter/(d_fs_in*1e3) << " the pseudorange residuals of the position fix were "
+       << std::sqrt(ssr / n_obs) << " m RMS over " << n_obs << " observations, the test statistic "
+       << test << " was above the threshold " << threshold << ".";
+    if(excluded >= 0 && prn[excluded] != 0)
+        {
+            sats.insert(prn[excluded]);
+            s << "Pseudorange residuals are inconsistent, PRN " << prn[excluded] << " is the outlier";
+            sr << " Without PRN " << prn[excluded] << " the test statistic is " << subset_ssr[excluded] / sigma2 << ".\n";
+        }
+    else
+        {
+            s << "Pseudorange residuals are inconsistent";
+            sr << " No single satellite explains the inconsistency.\n";
+        }
+    msg.satellites = sats;
+    msg.description = s.str();
+    msg.spoofing_report = sr.str();
+    spoofing_detected(msg);
 }
 
-
-
-double Spoofing_Detector::get_SNR_corr(std::list<unsigned int> channels, Gnss_Synchro **in, int sample_counter)
+/*!
+ *  Doppler consistency check. The PVT predicts the carrier Doppler of each
+ *  satellite from its ephemeris and the receiver velocity and clock drift,
+ *  and hands the differences with the measured ones to the detector. A
+ *  spoofer that does not reproduce the motion of the satellites relative to
+ *  the receiver leaves a lasting offset in the residuals of the satellites
+ *  it takes over, while the noise averages out over the window. The windows
+ *  are only updated by this check, which runs in one thread at a time.
+ */
+void Spoofing_Detector::check_doppler(const std::vector<unsigned int>& prn, const std::vector<double>& residuals, double sample_counter)
 {
-    int window_size = 1e3;
-    std::vector<unsigned int> PRNs;
-    unsigned int PRN, i;
-    for(std::list<unsigned int>::iterator it = channels.begin(); it != channels.end(); ++it)
-    {
-        i = *it;
-        PRN  = in[i][0].PRN;
-        PRNs.push_back(PRN);
-        //we have a buffer with previous SNR samples
-        if(!satellite_SNR.count(PRN)) 
-            {
-                satellite_SNR[PRN] =  boost::circular_buffer<double> (window_size); 
-            }
-        satellite_SNR.at(PRN).push_back(in[i][0].CN0_dB_hz);
-    }
+    if(!d_Doppler)
+        return;
+    // the checks of all the detectors add to the same counters
+    static const std::shared_ptr<Block_Metrics> metrics = make_block_metrics("spoofing", "check_doppler");
+    Block_Metrics_Scope metrics_scope(metrics.get(), prn.size());
+    metrics_scope.set_items(1);
 
-    std::list<unsigned int> sats_to_be_removed;
-    //remove satellites from the buffers if they are no longer being tracked
-    for(std::map<int, boost::circular_buffer<double>>::iterator it = satellite_SNR.begin(); it != satellite_SNR.end(); it++)
+    if(residuals.size() != prn.size())
+        return;
+
+    std::set<unsigned int> used;
+    for(unsigned int i = 0; i < prn.size(); i++)
         {
-            if( std::find(PRNs.begin(), PRNs.end(), it->first) == PRNs.end())
+            if(prn[i] == 0 or residuals[i] == 0.0)
+                continue;
+            used.insert(prn[i]);
+            std::map<unsigned int, Rolling_Statistics>::iterator it = d_doppler_stats.find(prn[i]);
+            if(it == d_doppler_stats.end())
                 {
-                    sats_to_be_removed.push_back(it->first);
+                    it = d_doppler_stats.insert(std::make_pair(prn[i], Rolling_Statistics(d_Doppler_window))).first;
                 }
+            it->second.push_back(residuals[i]);
         }
 
-    for(std::list<unsigned int>::iterator it = sats_to_be_removed.begin(); it != sats_to_be_removed.end(); ++it)
-    {
-        satellite_SNR.erase(*it); 
-    }
-
-    double p_corr;
-    int PRN_a, PRN_b;
-    double corr_sum = 0;
-    for(unsigned int i = 0; i < PRNs.size(); i++) 
-    {
-        PRN_a  = PRNs.at(i); 
-        for(unsigned int j = i+1; j < PRNs.size(); j++) 
+    // a satellite that is lost starts again with an empty window
+    double max_mps = d_Doppler_max_mps;
+    std::set<unsigned int> sats = {};
+    std::stringstream sr;
+    for(std::map<unsigned int, Rolling_Statistics>::iterator it = d_doppler_stats.begin(); it != d_doppler_stats.end(); )
         {
-            PRN_b = PRNs.at(j);
-            p_corr = get_corr(satellite_SNR.at(PRN_a), satellite_SNR.at(PRN_b));
-            corr_sum += p_corr;
-        } 
-    }
+            if(used.count(it->first) == 0)
+                {
+                    d_doppler_stats.erase(it++);
+                    continue;
+                }
+            if(it->second.full() and std::abs(it->second.mean()) > max_mps)
+                {
+                    sats.insert(it->first);
+                    sr << " PRN " << it->first << ": " << it->second.mean() << " m/s.";
+                }
+            ++it;
+        }
+    if(sats.empty())
+        return;
 
     Spoofing_Message msg;
-    msg.spoofing_case = 10;
-    std::set<unsigned int> sats = {};
+    msg.spoofing_case = 8;
     msg.satellites = sats;
-
-    if(corr_sum > 3)
-    {
-        std::stringstream s;
-        s << " The SNR correlation is above expected values, "; 
-        s << " SNR: " << corr_sum; 
-        s << ", " << sample_counter; 
-        msg.description = s.str();
-        std::stringstream sr;
-        sr << "At " << sample_counter/(d_fs_in*1e3) << " s the CN0 correlation was above the expected value." 
-          << " CN0: " << corr_sum << ". SPREE is configured to raise an alarm if it is above 3.\n";
-        msg.spoofing_report = sr.str();
-        spoofing_detected(msg);
-    }
-    return corr_sum;
-
+    std::stringstream s;
+    s << "Doppler of " << sats.size() << " satellite(s) is inconsistent with the ephemeris";
+    std::stringstream report;
+    report << "At " << sample_counter/(d_fs_in*1e3) << " the mean carrier Doppler residual of the last "
+           << d_Doppler_window << " fixes was above " << max_mps << " m/s for" << sr.str() << "\n";
+    msg.description = s.str();
+    msg.spoofing_report = report.str();
+    spoofing_detected(msg);
 }
 
-double Spoofing_Detector::get_corr(boost::circular_buffer<double> a, boost::circular_buffer<double> b)
+/*!
+ *  Collaborative checks between two receivers of a site. The signals of
+ *  one spoofer reach each antenna along one path, so the CN0 of all its
+ *  satellites changes by the same amount from one antenna to the other,
+ *  while the real satellites come from all directions and their CN0
+ *  differences depend on the gain pattern and the multipath of each
+ *  antenna. The antennas are expected to be apart enough for that. And as
+ *  the receivers are close, a subframe start reaches both at the same
+ *  time, after the common offset between their clocks is removed; a
+ *  satellite whose signal is delayed at only one of them stands out.
+ *  Only the thread of the peer link runs it, so d_peer_CN0 needs no lock.
+ */
+void Spoofing_Detector::check_peer(const Spoofing_Peer_Summary& local, const Spoofing_Peer_Summary& peer)
 {
-    unsigned int window_size = 1e3;
-    if(a.size() < window_size || b.size() < window_size)
-        {
-            //DLOG(INFO) << "don't have enough SNR values to calculate correlation";
-            return 0; 
+    static const std::shared_ptr<Block_Metrics> metrics = make_block_metrics("spoofing", "check_peer");
+    Block_Metrics_Scope metrics_scope(metrics.get(), peer.satellites.size());
+    metrics_scope.set_items(1);
+
+    // the satellites seen by both receivers, both lists by increasing PRN
+    std::vector<std::pair<const Spoofing_Peer_Satellite*, const Spoofing_Peer_Satellite*> > common;
+    std::vector<Spoofing_Peer_Satellite>::const_iterator a = local.satellites.begin();
+    std::vector<Spoofing_Peer_Satellite>::const_iterator b = peer.satellites.begin();
+    while(a != local.satellites.end() and b != peer.satellites.end())
+        {
+            if(a->PRN < b->PRN)
+                ++a;
+            else if(b->PRN < a->PRN)
+                ++b;
+            else
+                common.push_back(std::make_pair(&*a++, &*b++));
         }
-    
-    double corr = get_cov(a, b) / (get_cov(a, a) * get_cov(b, b)); 
-    return corr;
 
-}
-
-double Spoofing_Detector::check_SNR(std::list<unsigned int> channels, Gnss_Synchro **in, int sample_counter)
-{
-    unsigned int d_cno_count =4;
-    double d_cno_min = 1;
-    if(channels.size() < d_cno_count)
+    // CN0 differences, kept over a window of summaries for each satellite
+    std::map<unsigned int, Rolling_Statistics>& CN0 = d_peer_CN0[peer.receiver_id];
+    std::map<unsigned int, Rolling_Statistics> seen;
+    for(unsigned int i = 0; i < common.size(); i++)
         {
-            return 0;
+            unsigned int PRN = common[i].first->PRN;
+            std::map<unsigned int, Rolling_Statistics>::iterator it = CN0.find(PRN);
+            if(it == CN0.end())
+                it = CN0.insert(std::make_pair(PRN, Rolling_Statistics(d_peers_window))).first;
+            it->second.push_back(common[i].first->CN0_dB_hz - common[i].second->CN0_dB_hz);
+            seen.insert(*it);
         }
+    CN0.swap(seen);
 
-    std::vector<double> SNRs;
-    unsigned int i;
-    for(std::list<unsigned int>::iterator it = channels.begin(); it != channels.end(); ++it)
-    {
-        i = *it;
-        SNRs.push_back(in[i][0].CN0_dB_hz);
-    }
-
-    double stdev = StdDeviation(SNRs); 
-    double mv_avg;
-    
-    Spoofing_Message msg;
-    msg.spoofing_case = 10;
-    std::set<unsigned int> sats = {};
-    msg.satellites = sats;
-    ppe_cb.push_back(stdev);
-    if(ppe_cb.size() >= 1000)
+    std::vector<double> CN0_diff;
+    std::set<unsigned int> CN0_sats;
+    for(std::map<unsigned int, Rolling_Statistics>::const_iterator it = CN0.begin(); it != CN0.end(); ++it)
         {
-            double sum = std::accumulate(ppe_cb.begin(), ppe_cb.end(), 0);
-            mv_avg = sum/ppe_cb.size();
-            if(mv_avg < d_cno_min)
+            if(it->second.full())
                 {
+                    CN0_diff.push_back(it->second.mean());
+                    CN0_sats.insert(it->first);
+                }
+        }
+    double CN0_min_spread_db = d_peers_CN0_min_spread_db;
+    if(CN0_diff.size() >= d_peers_min_satellites)
+        {
+            double spread = StdDeviation(CN0_diff);
+            if(spread < CN0_min_spread_db)
+                {
+                    Spoofing_Message msg;
+                    msg.spoofing_case = 9;
+                    msg.satellites = CN0_sats;
                     std::stringstream s;
-                    s << " The SNR stdev is below expected values, "; 
-                    s << " SNR: " << mv_avg; 
-                    s << ", " << sample_counter; 
-                    msg.description = s.str();
+                    s << "CN0 of " << CN0_sats.size() << " satellites differs by the same amount at receiver " << peer.receiver_id;
                     std::stringstream sr;
-                    sr << "At " << sample_counter/(d_fs_in*1e3) << " s the CN0 standard deviation was below the expected value." 
-                      << " CN0: " << mv_avg << ". SPREE is configured to raise an alarm if it is below " << d_cno_min << ".\n";
+                    sr << "The CN0 differences of the satellites between this receiver and receiver " << peer.receiver_id
+                       << " spread by " << spread << " dB over the last " << d_peers_window << " summaries, less than "
+                       << CN0_min_spread_db << " dB, as if they all came from the same transmitter.\n";
+                    msg.description = s.str();
                     msg.spoofing_report = sr.str();
                     spoofing_detected(msg);
                 }
         }
-    
-    //calculate pearson correlation
-    //double p_corr = get_cov(SNR
 
-   /* 
-    if(stdev < d_cno_min)
+    // subframe starts of the same TOW, less the common clock offset
+    std::vector<std::pair<double, unsigned int> > offsets;
+    for(unsigned int i = 0; i < common.size(); i++)
         {
-            std::stringstream s;
-            s << " the SNR stdev is below expected values, "; 
-            s << " SNR: " << stdev; 
-            s << ", " << sample_counter; 
-            spoofing_detected(s.str(), 10);
-        }*/
-    return stdev;
+            if(common[i].first->subframe_TOW >= 0 and common[i].first->subframe_TOW == common[i].second->subframe_TOW)
+                {
+                    offsets.push_back(std::make_pair(common[i].first->subframe_offset_ms - common[i].second->subframe_offset_ms,
+                            static_cast<unsigned int>(common[i].first->PRN)));
+                }
+        }
+    if(offsets.size() < d_peers_min_satellites)
+        return;
+    std::vector<double> sorted;
+    for(unsigned int i = 0; i < offsets.size(); i++)
+        sorted.push_back(offsets[i].first);
+    std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+    double median = sorted[sorted.size() / 2];
+
+    double max_offset_ms = d_peers_max_subframe_offset_ms;
+    std::set<unsigned int> sats = {};
+    std::stringstream sr;
+    for(unsigned int i = 0; i < offsets.size(); i++)
+        {
+            double offset = offsets[i].first - median;
+            if(std::abs(offset) > max_offset_ms)
+                {
+                    sats.insert(offsets[i].second);
+                    sr << " PRN " << offsets[i].second << ": " << offset << " ms.";
+                }
+        }
+    if(sats.empty())
+        return;
+    Spoofing_Message msg;
+    msg.spoofing_case = 9;
+    msg.satellites = sats;
+    std::stringstream s;
+    s << "Subframes of " << sats.size() << " satellite(s) arrive at a different time at receiver " << peer.receiver_id;
+    std::stringstream report;
+    report << "The reception time of the subframe starts at this receiver, less that at receiver " << peer.receiver_id
+           << " and the offset between their clocks, was above " << max_offset_ms << " ms for" << sr.str() << "\n";
+    msg.description = s.str();
+    msg.spoofing_report = report.str();
+    spoofing_detected(msg);
 }
 
-/*!
- *  Check whether we have examined all subframe reception times
+namespace
+{
+/*
+ * Bits of a Galileo I/NAV word (1..128, as numbered in Galileo_E1.h) that
+ * all the satellites broadcast alike: the ionosphere parameters and
+ * region flags of word 5, the GST-UTC parameters of word 6 and the
+ * GST-GPS parameters of word 10. The other bits are left out.
  */
-bool Spoofing_Detector::stop_tracking(unsigned int PRN, unsigned int uid)
+std::vector<uint8_t> galileo_common_bits(int word_type, const std::vector<uint8_t>& payload)
 {
-    std::map<int, Subframe> subframes = global_subframe_map.get_map_copy();
-    Subframe subframe;
-    
-    std::set<int> subframe_ids;     
-    unsigned int min_uid = uid; 
-    int n = 0;     
-
-    //DLOG(INFO) << "checked?: ";
-    for (std::map<int, Subframe>::iterator it = subframes.begin(); it!= subframes.end(); ++it)
+    int first = 0;
+    int last = 0;
+    switch(word_type)
     {
-        subframe = it->second;
-        //DLOG(INFO) << "uid: " << it->first << " sub: " << subframe.subframe_id ;
-        
-        if(subframe.PRN != PRN) 
-            continue;
-
-        subframe_ids.insert(subframe.subframe_id);    
-        n++;
-        if( subframe.uid < min_uid )
-            {
-                min_uid = subframe.uid;
-            }
+    case 5:
+        first = 7; last = 47;
+        break;
+    case 6:
+        first = 7; last = 104;
+        break;
+    case 10:
+        first = 87; last = 128;
+        break;
+    default:
+        return std::vector<uint8_t>();
     }
-
-
-    //stop tracking if the channel has been checked against all others and
-    //it isn't tracking the lowest numbered peak and no spoofing has been detected 
-    DLOG(INFO) << "Stop tracking ? " << subframe_ids.size() << " " << n << " " << uid << " " << min_uid;
-    if( subframe_ids.size() == 1 && n > 1 && uid > min_uid) 
+    std::vector<uint8_t> bits(16, 0);
+    for(int n = first; n <= last && (n - 1) / 8 < static_cast<int>(payload.size()); n++)
         {
-            std::map<int, bool> spoofing_status = global_spoofing_status.get_map_copy();
-            if(!spoofing_status.count(PRN))
-                {
-                    return true;
-                }
-        }   
-    return false;
+            uint8_t bit = 0x80 >> ((n - 1) % 8);
+            bits[(n - 1) / 8] |= payload[(n - 1) / 8] & bit;
+        }
+    return bits;
+}
 }
-
 
 /*!
- *  Check whether the reception time of two different peaks of the same satellite
- *  are within the configurable value d_maximum_deviation
- *  also determine if we should stop tracking this channels peak
+ *  Inter-satellite checks of the units of the navigation message, for all
+ *  the constellations. Every unit gives the receiver time of a symbol and
+ *  its TOW in the GPS time scale, so their difference is the receiver
+ *  clock offset plus the travel time, the same for all the satellites to
+ *  within some 20 ms. A satellite whose TOW is shifted stands out from the
+ *  median of the others, and a hybrid receiver compares it with the
+ *  satellites of both constellations. The Galileo words that carry the same
+ *  parameters for all the satellites are compared too, as the GPS
+ *  subframes 4 and 5 are in check_inter_satellite_subframe().
  */
-void Spoofing_Detector::check_RX_time(unsigned int PRN)
+void Spoofing_Detector::check_nav_unit(const Spoofing_Nav_Unit& unit)
 {
-    DLOG(INFO) << "check rx time";
-
-    std::map<int, Subframe> subframes = global_subframe_map.get_map_copy();
-     
-    Subframe smallest;
-    Subframe largest;
-    Subframe subframe;
-
-    for (std::map<int, Subframe>::iterator it = subframes.begin(); it!= subframes.end(); ++it)
+    if(!d_NAVI_inter_satellite)
+        return;
+    static const std::shared_ptr<Block_Metrics> metrics = make_block_metrics("spoofing", "check_nav_unit");
+    Block_Metrics_Scope metrics_scope(metrics.get(), 0);
+    metrics_scope.set_items(1);
+
+    std::string name = unit.system + std::to_string(unit.PRN);
+    double offset_ms = unit.time_ms - unit.TOW * 1e3;
+    std::vector<uint8_t> common;
+    if(unit.system == 'E')
+        common = galileo_common_bits(unit.unit_id, unit.payload);
+
+    std::vector<double> offsets;
+    std::map<std::vector<uint8_t>, int> votes;
+    double max_age_ms = d_NAVI_unit_max_age_s * 1e3;
     {
-        subframe = it->second;
-        
-        if(subframe.PRN != PRN) 
-            continue;
-        smallest = subframe;
-        largest = subframe;
-        break;
+        boost::mutex::scoped_lock lock(d_nav_unit_mutex);
+        std::tuple<char, unsigned int, unsigned int> key(unit.system, unit.PRN, unit.uid);
+        for(std::map<std::tuple<char, unsigned int, unsigned int>, Nav_Unit_State>::iterator it = d_nav_units.begin(); it != d_nav_units.end(); )
+            {
+                if(unit.time_ms - it->second.time_ms > max_age_ms)
+                    {
+                        d_nav_units.erase(it++);
+                        continue;
+                    }
+                if(it->first != key)
+                    {
+                        offsets.push_back(it->second.offset_ms);
+                        std::map<int, std::vector<uint8_t> >::const_iterator c = it->second.common.find(unit.unit_id);
+                        if(!common.empty() and std::get<0>(it->first) == unit.system and c != it->second.common.end())
+                            votes[c->second]++;
+                    }
+                ++it;
+            }
+        Nav_Unit_State& state = d_nav_units[key];
+        state.time_ms = unit.time_ms;
+        state.offset_ms = offset_ms;
+        if(!common.empty())
+            state.common[unit.unit_id] = common;
     }
-    
-    for (std::map<int, Subframe>::iterator it = subframes.begin(); it!= subframes.end(); ++it)
-    {
-        subframe = it->second;
-        
-        if(subframe.PRN != PRN)
-            continue;
 
-    //    DLOG(INFO) << "id: " << it->first << " subframe: " << subframe.subframe_id << " timestamp " << std::setprecision(10)<< subframe.timestamp;
-    
-        if(smallest.timestamp > subframe.timestamp) 
+    // the TOW of the other satellites, unless they are fewer than three
+    if(offsets.size() >= 3)
         {
-            smallest = subframe;
+            std::nth_element(offsets.begin(), offsets.begin() + offsets.size() / 2, offsets.end());
+            double deviation = std::remainder(offset_ms - offsets[offsets.size() / 2], seconds_per_week * 1e3);
+            double max_ms = d_NAVI_time_max_discrepancy_ms;
+            if(std::abs(deviation) > max_ms)
+                {
+                    Spoofing_Message msg;
+                    msg.spoofing_case = 4;
+                    msg.satellites = {unit.PRN};
+                    std::stringstream s;
+                    s << "TOW of " << name << " is not synced with the other " << offsets.size() << " satellites";
+                    std::stringstream sr;
+                    sr << "At " << unit.time_ms/1e3 << " s the TOW of " << name << " was " << deviation
+                       << " ms away from that of the other satellites, more than " << max_ms << " ms\n";
+                    msg.description = s.str();
+                    msg.spoofing_report = sr.str();
+                    spoofing_detected(msg);
+                }
         }
 
-        if(largest.timestamp < subframe.timestamp) 
+    // the parameters of the majority of at least two other satellites
+    std::map<std::vector<uint8_t>, int>::const_iterator majority = votes.end();
+    int total = 0;
+    for(std::map<std::vector<uint8_t>, int>::const_iterator it = votes.begin(); it != votes.end(); ++it)
         {
-            largest = subframe;
+            total += it->second;
+            if(majority == votes.end() or it->second > majority->second)
+                majority = it;
         }
-    }
-    
-    //the earliest and latest reception times
-    double largest_t = largest.timestamp;
-    double smallest_t = smallest.timestamp;
-    bool spoofed = false;
-    int diff = 0;
-
-    if(std::abs(largest_t-smallest_t) >= d_APT_max_rx_discrepancy)
-        {
-            if(largest.subframe_id != smallest.subframe_id)
-                {
-                    diff = largest.subframe_id-smallest.subframe_id;
-                    if(std::abs(largest_t-smallest_t)/std::fmod(diff, 5) > 6001) 
-                        {
-                            spoofed = true;
-                        }
-                }
-            else
-                {
-                    spoofed = true;
-                }
-        }
-
-    if(spoofed)
+    if(majority != votes.end() and majority->second >= 2 and 2 * majority->second > total and majority->first != common)
         {
-            double distance = std::abs(largest_t-smallest_t)*GPS_C_m_s/1e3; 
+            Spoofing_Message msg;
+            msg.spoofing_case = 2;
+            msg.satellites = {unit.PRN};
             std::stringstream s;
+            s << "Word type " << unit.unit_id << " of " << name << " differs from that of " << majority->second << " other satellites";
             std::stringstream sr;
-            s << "Auxiliary peak detected for satellite " << PRN << "\n";
-            s << "Peak seperation: " << std::setprecision(16) << std::abs(largest_t-smallest_t)*1e6 << " [ns]\n"; 
-            s << "Pseudorange change: " << std::setprecision(16) << distance <<" [m]\n"; 
-            Spoofing_Message msg;
-            msg.spoofing_case = 1;
-            std::set<unsigned int> sats = {PRN};
-            msg.satellites = sats;
+            sr << "At " << unit.time_ms/1e3 << " s a navigational message manipulation was detected. The parameters of word type "
+               << unit.unit_id << " of " << name << " differed from those broadcast by " << majority->second << " other satellites\n";
             msg.description = s.str();
-
-            sr << "At " << largest_t/1e3 << " s an auxiliary peak was detected for satellite " << PRN
-               << " with peak seperation of " << std::setprecision(16) << std::abs(largest_t-smallest_t)*1e6 << " [ns] which translates to a" 
-               << " pseudorange change of " << std::setprecision(16) << distance <<" [m]. "
-               << "SPREE is configured to raise an alarm if a peak seperation of more than " << d_APT_max_rx_discrepancy*1e6 << " [ns] is detected.\n"; 
-            
             msg.spoofing_report = sr.str();
             spoofing_detected(msg);
         }
-
 }
 
 /*!
- *  Check if two subframes contain the same values, if not raise a spoofing alarm.
- *  Return true if the subframes were compared but false if they were not.
+ *  check that new ephemeris TOW (from a certain satellite) is consistent with the latest received TOW
+ *  and the time duration between them. If the difference in these values is above the maximum allowed
+ *  value a spoofing alarm is raised.
  */
-bool Spoofing_Detector::compare_subframes(Subframe subframeA, Subframe subframeB)
+void Spoofing_Detector::check_new_TOW(double current_timestamp_ms, int new_week, double new_TOW)
 {
-        DLOG(INFO) << "check subframe "<< subframeA.subframe_id << std::endl
-        << subframeA.subframe << std::endl
-        << subframeB.subframe;
+    if( new_TOW == 0 )
+        return;
+    static const std::shared_ptr<Block_Metrics> metrics = make_block_metrics("spoofing", "check_new_TOW");
+    Block_Metrics_Scope metrics_scope(metrics.get(), 0);
+    metrics_scope.set_items(1);
 
-        //one of the ephemeris data has not been updated.
-        if(subframeA.timestamp == 0 ||  subframeB.timestamp == 0)
-            {
-                DLOG(INFO) << "Subframes timestamps are zero";
-                return 0;
-            }
+    std::map<int, double> old_GPS_time;
+    old_GPS_time = d_receiver_state->last_gps_time.get_map_copy();
+    //DLOG(INFO) << "TOW " << new_TOW << " " << new_week << " " << old_GPS_time.size();
 
-        if( subframeA.toa != subframeB.toa && subframeA.PRN != subframeB.PRN)
-            {
-                DLOG(INFO) << "Almanac data doesn't have the same toa";
-                //std::cout << "Almanac data doesn't have the same toa" << std::endl;
-                return 1;
-            }
+    int old_gps_time, new_gps_time;
+    double duration;
+    if(old_GPS_time.size() > 2)
+    {
+        TRACE_LOG(TRACE_SPOOFING, 1) << "TOW " << new_TOW << " " << new_week << "\n"
+                   << "old TOW " << old_GPS_time.at(0) << " " << old_GPS_time.at(1);
+        if( old_GPS_time.at(0) == 0)
+            old_GPS_time.at(0) = new_week;
+        else if( new_week == 0)
+            new_week = old_GPS_time.at(0);
 
-/*
-        //one of the ephemeris data has not been updated.
-        if(std::abs(subframeA.timestamp -subframeB.timestamp) > 3000)
-            {
-                DLOG(INFO) << "Subframes timestamps differ more than one" << std::endl
-                << subframeA.timestamp << " " << subframeB.timestamp << std::endl
-                << subframeA.subframe_id << " " << subframeB.subframe_id << std::endl
-                << subframeA.subframe << std::endl << subframeB.subframe << std::endl;
-                return 0;
-            }
-  */          
-        if(subframeA.subframe != subframeB.subframe && subframeA.subframe != "" && subframeB.subframe != "")
+        double old_timestamp_ms = old_GPS_time.at(2);
+
+        old_gps_time = old_GPS_time.at(0)*seconds_per_week+old_GPS_time.at(1);
+        new_gps_time = new_week*seconds_per_week+new_TOW;
+        //duration = round((current_timestamp_ms-old_timestamp_ms)/1000.0);
+        duration = (current_timestamp_ms-old_timestamp_ms)/1000.0;
+        //DLOG(INFO) << "check new TOW " << duration << " " << std::abs(new_gps_time-old_gps_time);
+
+        if( std::abs(std::abs(new_gps_time-old_gps_time)-duration) > d_NAVI_TOW_max_discrepancy) 
             {
                 std::stringstream s;
                 std::stringstream sr;
                 s << "Navigational message manipulation detected\n";
-                sr << "At " << subframeA.timestamp/1e3 << " s a navigational message manipulation was detected. ";
-                if( subframeA.PRN == subframeB.PRN)
-                    {
-                        s << "Subframe " << subframeA.subframe_id << " not the same for two peaks of satellite " << subframeA.PRN << "\n"; 
-                        sr << "Subframe " << subframeA.subframe_id << " was not the same for two peaks of satellite " << subframeA.PRN << "\n"; 
-                    }
-                else
-                    {
-                        s << "Subframe " << subframeA.subframe_id << " not the same for satellites " << subframeA.PRN << " and " << subframeB.PRN << "\n"; 
-                        sr << "Subframe " << subframeA.subframe_id << " was not the same for satellites " << subframeA.PRN << " and " << subframeB.PRN << "\n"; 
-                    }
+                s << "Time between the reception of the two navigational messages: " << duration << " s\n";
+                s << "Difference in TOW values: " << new_gps_time-old_gps_time << " s\n";
+                sr << "At " << current_timestamp_ms/1e3 << " s a navigational message manipulation was detected. ";
+                sr << "The time between the reception of the two navigational messages was " << duration << " s and the ";
+                sr << " difference in the TOW values was " << new_gps_time-old_gps_time << " s\n";
                 Spoofing_Message msg;
-                msg.spoofing_case = 2;
-                std::set<unsigned int> sats = {subframeA.PRN, subframeB.PRN};
+                msg.spoofing_case = 3;
+                std::set<unsigned int> sats = {};
                 msg.satellites = sats;
                 msg.description = s.str();
                 msg.spoofing_report = sr.str();
                 spoofing_detected(msg);
             }
-        else
-            {
-                DLOG(INFO) << " subframes: " << std::endl
-                << subframeA.timestamp << " " << subframeB.timestamp << std::endl
-                << subframeA.subframe_id << " " << subframeB.subframe_id << std::endl
-                << subframeA.subframe << std::endl << subframeB.subframe << std::endl;
-            }
-    return 1;
+    }
+
+    d_receiver_state->last_gps_time.write(0, new_week);
+    d_receiver_state->last_gps_time.write(1, new_TOW);
+    d_receiver_state->last_gps_time.write(2, current_timestamp_ms);
 }
 
 /*!
- *  Check if the subframes for two peaks is the same 
+ * Stores a new ephemeris in the history of the satellite and, with the NAVI_exp_eph check, checks
+ * the change from the last one: whether it changes more frequently than 2 hours, if the change for
+ * certain values is too great, and whether it repeats the issue of data of an earlier ephemeris of
+ * less than 6 hours ago, which the control segment never does (IS-GPS-200 20.3.4.4).
  */
-void Spoofing_Detector::check_APT_subframe(unsigned int uid, unsigned int subframe_id)
-{
-    Subframe subframeA, subframeB;
-    unsigned int idA, idB;
-    std::map<int, Subframe> subframes = global_subframe_map.get_map_copy();
-    if(subframes.count(uid))
+void Spoofing_Detector::check_and_update_ephemeris(unsigned int PRN, const Gps_Ephemeris& eph, double time)
+{ 
+    static const std::shared_ptr<Block_Metrics> metrics = make_block_metrics("spoofing", "check_and_update_ephemeris");
+    Block_Metrics_Scope metrics_scope(metrics.get(), 0);
+    metrics_scope.set_items(1);
+
+    Ephemeris_History& history = d_receiver_state->ephemeris_history;
+    sEph old_ephemeris;
+    bool has_old = history.latest(PRN, old_ephemeris);
+    sEph same_issue;
+    bool repeated_issue = has_old && history.find_issue(PRN, eph.d_Toe, eph.d_IODE_SF2, same_issue);
+    if(!history.store(PRN, eph, time) || !has_old || !d_NAVI_exp_eph)
+        return;
+
+    Spoofing_Message msg;
+    msg.spoofing_case = 5;
+    std::set<unsigned int> sats = {PRN};
+    msg.satellites = sats;
+
+    double TWO_HOURS_MS = 2*60*60*1000; //2 hours in ms 
+    double SIX_HOURS_MS = 6*60*60*1000; //6 hours in ms 
+    double TEN_MIN_MS= 10*60*1000; //10 min in ms 
+    double TWENTYFOUR_HOURS_MS= 24*60*60*1000; //24 hours in ms 
+    if(old_ephemeris.changed && time > old_ephemeris.time &&  abs( (old_ephemeris.time - time) -TWO_HOURS_MS) < TEN_MIN_MS)
         {
-            subframeA = subframes.at(uid);
-            idA = uid;
+            std::string s = "The Ephemeris has changed, though less than two hours have passed since the last change";
+            msg.description = s;
+            std::stringstream sr;
+            sr << "At " << time/1e3 << " s an ephemeris message was received that is different from the last one received" 
+                << " even though less than 2 hours have passed since the last change in ephemeris data.\n";
+            msg.spoofing_report = sr.str();
+            spoofing_detected(msg);
         }
-    else
+
+    if(repeated_issue && time - same_issue.time < SIX_HOURS_MS)
         {
-            DLOG(INFO) << "check subframe - but subframe for sat " << uid << " subframe: " << subframe_id << " not in subframe map"; 
-            return;
+            bool reverted = same_issue.time < old_ephemeris.time;
+            msg.description = reverted ? "The Ephemeris has reverted to an earlier issue of data"
+                                       : "The Ephemeris has changed without a new issue of data";
+            std::stringstream sr;
+            sr << "At " << time/1e3 << " s an ephemeris message was received with the reference time " << eph.d_Toe
+                << " and IODE " << eph.d_IODE_SF2 << " of an ephemeris received at " << same_issue.time/1e3 << " s, "
+                << (reverted ? "older than the last one." : "but with different data.")
+                << " The control segment does not repeat an issue of data within 6 hours.\n";
+            msg.spoofing_report = sr.str();
+            spoofing_detected(msg);
         }
 
-    for (std::map<int, Subframe>::iterator it = subframes.begin(); it!= subframes.end(); ++it)
-    {
-        idB = it->first;
-        subframeB = it->second;
-        if( subframeB.PRN != subframeA.PRN)
-            continue;
+    if ( (time - old_ephemeris.time) < TWENTYFOUR_HOURS_MS) 
+        {
+            const std::vector<Nav_Field<Gps_Ephemeris> >& fields = gps_ephemeris_fields();
+            Nav_Field_Mask exceed = nav_fields_exceed(fields, d_ephemeris_thresholds, eph, old_ephemeris.ephemeris);
+            for (unsigned int i = 0; exceed != 0; i++, exceed >>= 1)
+                {
+                    if (!(exceed & 1)) continue;
+                    std::string name = fields[i].threshold_key;
+                    std::string s = name + " change too great";
+                    msg.description = s;
+                    std::stringstream sr;
+                    sr << "At " << time/1e3 << " s an ephemeris message was received where the change in the value of " << name
+                        << " was greater than is expected. Old value of " << name << ": " << fields[i].value(old_ephemeris.ephemeris)
+                        << " New value of " << name << ": " << fields[i].value(eph)
+                        << ". SPREE is configured to raise an alarm if the change in " << name << " is above " << d_ephemeris_thresholds[i] << ".\n" ;
+                    msg.spoofing_report = sr.str();
+                    spoofing_detected(msg);
+                }
+        }
+}  
 
-        DLOG(INFO) << "subframeB " << subframeB.subframe_id << " " << idB << " " << subframeB.PRN;
-        DLOG(INFO) <<  (subframeB.subframe_id != subframe_id) << " " << (idB == idA);
-        if(subframeB.subframe_id != subframe_id || idB == idA)
-            continue;
-        
-        compare_subframes(subframeA, subframeB);
-    }
-}
 
 /*!
- *  Check if the shared subframes 4 and 5 are the same from all satellites
+ *  Check for middle of earth attack
  */
-void Spoofing_Detector::check_inter_satellite_subframe(unsigned int uid, unsigned int subframe_id)
-{
- //   std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();                                                                                                          
-//    DLOG(INFO) << "check subframe " << subframe_id << " for " << uid;
-
-    Subframe subframeA, subframeB;
-    unsigned int idA, idB;
-    std::map<int, Subframe> subframes = global_subframe_map.get_map_copy();
-    if(subframes.count(uid))
-        {
-            subframeA = subframes.at(uid);
-            idA = uid;
-        }
-    else
-        {
-            DLOG(INFO) << "check subframe - but subframe for sat " << uid << " subframe: " << subframe_id << " not in subframe map"; 
-            return;
-        }
-
-    for (std::map<int, Subframe>::iterator it = subframes.begin(); it!= subframes.end(); ++it)
+void Spoofing_Detector::check_middle_earth(unsigned int PRN, double sqrtA, double timestamp)
+{ 
+    if(sqrtA == 0)
     {
-        subframeB = it->second;
-        idB = it->first;
-        DLOG(INFO) << "subframeB " << subframeB.subframe_id << " " << idB << " " << subframeB.PRN;
-        DLOG(INFO) <<  (subframeB.subframe_id != subframe_id) << " " << (idB == idA);
-        if(subframeB.subframe_id != subframe_id || idB == idA)
-            continue;
-        
-        compare_subframes(subframeA, subframeB);
+        std::stringstream s;
+        s << "Middle of the earth attack detected for satellite " << PRN;
+        std::stringstream sr;
+        sr << "At " << timestamp/1e3 << " s a middle of the earth attack was detected for satellite " << PRN << ".\n";
+        Spoofing_Message msg;
+        msg.spoofing_case = 5;
+        std::set<unsigned int> sats = {PRN};
+        msg.satellites = sats;
+        msg.description = s.str();
+        msg.spoofing_report = sr.str();
+        spoofing_detected(msg);
     }
-/*
-    std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();                                                                                                          
-    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>( t2 - t1 ).count(); 
-    DLOG(INFO) << "dur_sf: " << duration;
-*/
-}
+
+}  
 
 /*!
- *  Check whether the ephemeris data received from the satellites is consistent with
- *  ephemeris data received from an external source
+ *  Checks whether the change in the estimated satellite position is changing faster then made
+ *  possible given the satellites speed given that the receiver is moving at a "normal" speed.
  */
-void Spoofing_Detector::check_external_ephemeris(Gps_Ephemeris eph_internal, unsigned int PRN, double timestamp)
+void Spoofing_Detector::check_satpos(unsigned int PRN, double time, double x, double y, double z) 
 {
-    lookup_external_nav_data(1,1);
-    std::map<int,Gps_Ephemeris> external;
-    external = supl_client_.gps_ephemeris_map;    
-        
-    if(external.count( PRN) )
+    if(d_replay_writer)
+        d_replay_writer->write_satpos(PRN, time, x, y, z);
+    static const std::shared_ptr<Block_Metrics> metrics = make_block_metrics("spoofing", "check_satpos");
+    Block_Metrics_Scope metrics_scope(metrics.get(), 0);
+    metrics_scope.set_items(1);
+    boost::mutex::scoped_lock lock(d_ppe_mutex);
+    Satpos p;
+    if(Satpos_map.count(PRN))
         {
-            //create strings from the the ephemeris object for easy comparison
-            Gps_Ephemeris eph_external = external.at( PRN );  
-            bool the_same = compare_ephemeris(eph_internal, eph_external);
-
-            if( !the_same )
+            p = Satpos_map.at(PRN);
+            double sat_speed = 1400e3/(60*60); // [m/s]
+            double distance = sqrt(pow(p.x-x, 2)+pow(p.y-y, 2)+pow(p.z-z, 2));
+            double time_diff = std::abs(time-p.time)/1000.0;
+            //what to set as the max difference in position
+            if(distance != 0  && ((distance - time_diff*sat_speed) > 500 || (distance - time_diff*sat_speed) < 10e3))
                 {
-                    std::cout << "External ephemeris not consistent with ephemeris records from satellite " << PRN << std::endl;
-                    LOG(INFO) << "External ephemeris not consistent with ephemeris records from satellite " << PRN; 
                     std::stringstream s;
-                    s << "External ephemeris not consistent with ephemeris records from satellite " << PRN;
+                    s << "New satellite position for sat: " << PRN << " is further away from last reported position." << std::endl;
+                    s << "  Distance: " << distance/1e3 << " [km] " << " time difference: " << time_diff << std::endl;
+                    s << "  New pos: (" << p.x << ", " << p.y << ", " << p.z << ") old pos: (" << x << ", " << y << ", " << z << ")";
                     std::stringstream sr;
-                    sr << "At " << timestamp/1e3 << " ephemeris records for satellite " << PRN 
-                       << "was received that is not consistent with ephemeris records from external sources.\n"; 
+                    sr << "At " << time/1e3 << " s a new satellite position for sat: " << PRN << " was calculated that is further away from last reported position"
+                       << " than was expected." 
+                       << "  Distance: " << distance/1e3 << " [km] " << " time difference: " << time_diff 
+                       << "  New pos: (" << p.x << ", " << p.y << ", " << p.z << ") old pos: (" << x << ", " << y << ", " << z << ")\n";
                     Spoofing_Message msg;
-                    msg.spoofing_case = 0;
+                    msg.spoofing_case = 5;
                     std::set<unsigned int> sats = {PRN};
                     msg.satellites = sats;
                     msg.description = s.str();
@@ -1365,978 +1572,1377 @@ void Spoofing_Detector::check_external_ephemeris(Gps_Ephemeris eph_internal, uns
                     spoofing_detected(msg);
 
                 }
-            else
+        }
+
+    p.x = x;
+    p.y = y;
+    p.y = z;
+    p.time = time;
+    Satpos_map[PRN] = p;
+}
+
+/*!
+ *  Validates the ephemerides that changed since the last fix, and looks up
+ *  the result of the others.
+ */
+int Spoofing_Detector::check_ephemeris_satpos(const std::map<int, Gps_Ephemeris>& ephemerides, double rx_time_s, double sample_counter)
+{
+    if(!d_satpos_detection)
+        return 0;
+    static const std::shared_ptr<Block_Metrics> metrics = make_block_metrics("spoofing", "check_ephemeris_satpos");
+    Block_Metrics_Scope metrics_scope(metrics.get(), 0);
+    boost::mutex::scoped_lock lock(d_ppe_mutex);
+    d_satpos_changed.clear();
+    int invalid = 0;
+    for(std::map<int, Gps_Ephemeris>::const_iterator it = ephemerides.begin(); it != ephemerides.end(); ++it)
+        {
+            std::map<unsigned int, Satpos_Validation>::iterator validation = d_satpos_validations.find(it->second.i_satellite_PRN);
+            if(validation == d_satpos_validations.end() || validation->second.IODE != it->second.d_IODE_SF2)
                 {
-                    LOG(INFO) << "External ephemeris are consistent with ephemeris records from satellite " << PRN;
+                    d_satpos_changed.push_back(&it->second);
+                }
+            else if(!validation->second.valid)
+                {
+                    invalid++;
+                    spoofing_detected(validation->second.alarm);
                 }
         }
-    else
+    metrics_scope.set_items(d_satpos_changed.size());
+
+    for(unsigned int i = 0; i < d_satpos_changed.size(); i++)
         {
-            LOG(INFO) << "No external ephemeris record for satellite " << PRN;
+            const Gps_Ephemeris& eph = *d_satpos_changed[i];
+            std::map<unsigned int, Satpos_Validation>::iterator validation = d_satpos_validations.find(eph.i_satellite_PRN);
+            if(validation == d_satpos_validations.end())
+                {
+                    Satpos_Validation first;
+                    first.has_reference = false;
+                    validation = d_satpos_validations.insert(std::make_pair(eph.i_satellite_PRN, first)).first;
+                }
+            if(!validate_satpos(validation->second, eph, rx_time_s, sample_counter))
+                {
+                    invalid++;
+                    spoofing_detected(validation->second.alarm);
+                }
         }
+    return invalid;
 }
 
-/*! 
- *  check whether the UTC Model data received from the satellites is consistent with
- *  UTC model data received from an external source
- */
-void Spoofing_Detector::check_external_utc(Gps_Utc_Model internal, double timestamp)
+bool Spoofing_Detector::validate_satpos(Satpos_Validation& validation, const Gps_Ephemeris& eph, double rx_time_s, double sample_counter)
 {
-    if(~d_NAVI_external)
-        return;
-    lookup_external_nav_data(1,0);
-    Gps_Utc_Model external;
-    external = supl_client_.gps_utc;
-        
-    if( external.valid && internal.valid )
+    // the radius of the GPS orbits, with their largest eccentricity
+    const double min_orbit_radius_m = 25.5e6;
+    const double max_orbit_radius_m = 27.6e6;
+    const double fit_interval_s = 4.0 * 3600.0;
+
+    validation.IODE = eph.d_IODE_SF2;
+    validation.valid = true;
+    Gps_Ephemeris current = eph;
+    current.satellitePosition(rx_time_s);
+    double radius = sqrt(pow(current.d_satpos_X, 2) + pow(current.d_satpos_Y, 2) + pow(current.d_satpos_Z, 2));
+    std::stringstream s;
+    std::stringstream sr;
+    if(!(radius >= min_orbit_radius_m && radius <= max_orbit_radius_m)) // NaN too
         {
-            //create strings from the the ephemeris object for easy comparison
-            bool the_same = compare_utc(internal, external);
-
-            if( !the_same )
-                {
-                    std::cout << "External utc model not consistent with records from satellites " << std::endl;
-                    LOG(INFO) << "Externautc utc model not consistent with records from satellites "; 
-
-                    std::stringstream s;
-                    s << "External utc utc model not consistent with records from satellites "; 
-                    std::stringstream sr;
-                    sr << "At " << timestamp/1e3 << " s UTC GPS time data was received that was not consistent with records from external sources.\n"; 
-                    Spoofing_Message msg;
-                    msg.spoofing_case = 6;
-                    std::set<unsigned int> sats = {};
-                    msg.satellites = sats;
-                    msg.description = s.str();
-                    msg.spoofing_report = sr.str();
-                    spoofing_detected(msg);
-                }
-            else
+            validation.valid = false;
+            s << "The ephemeris " << eph.d_IODE_SF2 << " of satellite " << eph.i_satellite_PRN << " is not a GPS orbit." << std::endl;
+            s << "  Orbit radius: " << radius/1e3 << " [km]";
+            sr << "At " << sample_counter/1e3 << " s the ephemeris " << eph.d_IODE_SF2 << " of satellite " << eph.i_satellite_PRN
+               << " put it " << radius/1e3 << " km from the center of the Earth, out of the GPS orbits.\n";
+        }
+    else if(validation.has_reference)
+        {
+            double age_s = rx_time_s - validation.reference.d_Toe;
+            if(age_s > 302400.0) age_s -= 604800.0;
+            if(age_s < -302400.0) age_s += 604800.0;
+            if(std::abs(age_s) <= fit_interval_s)
                 {
-                    LOG(INFO) << "External utc model are consistent with records from satellites ";
+                    validation.reference.satellitePosition(rx_time_s);
+                    double distance = sqrt(pow(current.d_satpos_X - validation.reference.d_satpos_X, 2)
+                            + pow(current.d_satpos_Y - validation.reference.d_satpos_Y, 2)
+                            + pow(current.d_satpos_Z - validation.reference.d_satpos_Z, 2));
+                    if(distance > d_satpos_max_jump_m)
+                        {
+                            validation.valid = false;
+                            s << "The ephemeris " << eph.d_IODE_SF2 << " moves satellite " << eph.i_satellite_PRN
+                              << " away from the position of the ephemeris " << validation.reference.d_IODE_SF2 << "." << std::endl;
+                            s << "  Distance: " << distance/1e3 << " [km]";
+                            sr << "At " << sample_counter/1e3 << " s the new ephemeris " << eph.d_IODE_SF2 << " of satellite " << eph.i_satellite_PRN
+                               << " put it " << distance/1e3 << " km away from where the ephemeris " << validation.reference.d_IODE_SF2
+                               << " did. SPREE is configured to raise an alarm if the distance is above " << d_satpos_max_jump_m << " m.\n";
+                        }
                 }
         }
-    else
+    if(validation.valid)
         {
-            LOG(INFO) << "No external utc model record for satellites ";
+            validation.reference = eph;
+            validation.has_reference = true;
+            return true;
         }
+    validation.alarm = Spoofing_Message();
+    validation.alarm.spoofing_case = 5;
+    validation.alarm.satellites = {static_cast<unsigned int>(eph.i_satellite_PRN)};
+    validation.alarm.description = s.str();
+    validation.alarm.spoofing_report = sr.str();
+    return false;
 }
 
 /*!
- *  Check whether the Iono Model data received from the satellites is consistent with
- *  Iono model data received from an external source.
+ *  Checks whether all tracked satellite signals are reporting the same GPS time.
  */
-void Spoofing_Detector::check_external_iono(Gps_Iono internal, double timestamp)
+void Spoofing_Detector::check_GPS_time()
 {
-    if(~d_NAVI_external)
-        return;
+    static const std::shared_ptr<Block_Metrics> metrics = make_block_metrics("spoofing", "check_GPS_time");
+    Block_Metrics_Scope metrics_scope(metrics.get(), 0);
+    metrics_scope.set_items(1);
+    concurrent_snapshot_map<GPS_time_t>::Snapshot snapshot = d_receiver_state->gps_time.get_snapshot();
+    const std::map<int, GPS_time_t>& gps_times = *snapshot;
+    std::set<int> GPS_TOW;
+    int GPS_week, TOW;
+    std::set<int> subframe_IDs;
+    double smallest = 0; 
+    double largest = 0;
+    GPS_time_t gps_time;
+    //check that the GPS week is consistent between all satellites
+    for(std::map<int, GPS_time_t>::const_iterator it = gps_times.begin(); it != gps_times.end(); ++it)
+        {
+            gps_time = it->second;
+            GPS_week = gps_time.week; 
+            if(GPS_week == 0)
+                continue;
 
-    lookup_external_nav_data(1,0);
-    Gps_Iono external;
-    external = supl_client_.gps_iono;
-        
-    if( external.valid && internal.valid )
+            if(gps_time.timestamp > largest)
+                largest = gps_time.timestamp;
+            if(gps_time.timestamp < smallest)
+                smallest  = gps_time.timestamp;
+
+            TOW = GPS_week*604800+gps_time.TOW;
+            GPS_TOW.insert(TOW);
+            subframe_IDs.insert(gps_time.subframe_id);
+            TRACE_LOG(TRACE_SPOOFING, 2) << "ts " << gps_time.timestamp << " TOW: " << TOW << " subframe: " << gps_time.subframe_id << " " << it->first;
+        }
+
+
+    if(GPS_TOW.size() > subframe_IDs.size())
+    {
+        std::string s =  "Satellites GPS TOW are not synced";
+        std::stringstream sr;
+        sr << "At " << largest/1e3 << " s a navigational message manipulation was detected. ";
+        sr <<  "The TOW of the satellites are not synced.\n";
+        Spoofing_Message msg;
+        msg.spoofing_case = 4;
+        std::set<unsigned int> sats = {};
+        msg.satellites = sats;
+        msg.description = s;
+        msg.spoofing_report = sr.str();
+        spoofing_detected(msg);
+
+        for(std::set<int>::iterator it = GPS_TOW.begin(); it != GPS_TOW.end(); ++it)
+            {
+                TRACE_LOG(TRACE_SPOOFING, 2) << "TOW " << *it; 
+            }
+        for(std::set<int>::iterator it = subframe_IDs.begin(); it != subframe_IDs.end(); ++it)
+            {
+                TRACE_LOG(TRACE_SPOOFING, 2) << "subframe " << *it; 
+            }
+    }
+}
+
+float get_Delta(gr_complex early_s1, gr_complex late_s1, gr_complex prompt_s1)
+{
+    return (early_s1.real() - late_s1.real()) / (2*prompt_s1.real());
+
+}
+
+float get_RT(gr_complex early_s1, gr_complex late_s1, gr_complex prompt_s1)
+{
+    return (early_s1.real() + late_s1.real()) / (2*prompt_s1.real());
+}
+
+
+/*!
+ *  Spoofing detection based on: calculating the variance of SNR, delta and RT over a given window for each satellite
+ *  and calulate the mean of this. 
+ */
+//TODO: find better name
+void Spoofing_Detector::PPE_moving_var(const Channel_List& channels, Gnss_Synchro **in, int sample_counter)
+{
+    static const std::shared_ptr<Block_Metrics> metrics = make_block_metrics("spoofing", "PPE_moving_var");
+    Block_Metrics_Scope metrics_scope(metrics.get(), channels.size());
+    metrics_scope.set_items(1);
+    boost::mutex::scoped_lock lock(d_ppe_mutex);
+    // the windows of the last run are only taken up by the satellites tracked again soon after the restart
+    if(sample_counter > d_restored_until_ms && !(d_restored_sat_buffs.empty() && d_restored_SNR.empty()))
         {
-            //create strings from the the ephemeris object for easy comparison
-            bool the_same = compare_iono(internal, external);
+            d_restored_sat_buffs.clear();
+            d_restored_SNR.clear();
+        }
+    std::vector<unsigned int> PRNs;
+    unsigned int PRN, i;
+    for(Channel_List::const_iterator it = channels.begin(); it != channels.end(); ++it)
+    {
+        i = *it;
+        PRN  = in[i][0].PRN;
+        PRNs.push_back(PRN);
 
-            if( !the_same )
-                {
-                    std::cout << "External iono data not consistent with records from satellites " << std::endl;
-                    LOG(INFO) << "Externautc iono data not consistent with records from satellites "; 
-                    std::stringstream s;
-                    s << "Externautc iono data not consistent with records from satellites "; 
-                    std::stringstream sr;
-                    sr << "At " << timestamp/1e3 << " s Ionospheric GPS time data was received that was not consistent with records from external sources.\n"; 
-                    Spoofing_Message msg;
-                    msg.spoofing_case = 6;
-                    std::set<unsigned int> sats = {};
-                    msg.satellites = sats;
-                    msg.description = s.str();
-                    msg.spoofing_report = sr.str();
-                    spoofing_detected(msg);
-                }
-            else
+        Correlator_Taps taps;
+        if(!d_receiver_state->correlator_taps_map.read(in[i][0].Channel_ID, taps) or taps.PRN != PRN)
+            {
+                continue;
+            }
+        float CN0 = in[i][0].CN0_dB_hz;
+        float RT = get_RT(taps.Early, taps.Late, taps.Prompt);
+        float Delta = get_Delta(taps.Early, taps.Late, taps.Prompt);
+
+        //we have a buffer with previous SNR samples
+        if(!sat_buffs.count(PRN) && d_restored_sat_buffs.count(PRN) && sat_buffs.insert(PRN))
+            {
+                sat_buffs.at(PRN) = d_restored_sat_buffs[PRN];
+                d_restored_sat_buffs.erase(PRN);
+            }
+        if(!sat_buffs.count(PRN) && !sat_buffs.insert(PRN))
+            {
+                continue;
+            }
+        sat_buffs.at(PRN).add(CN0, RT, Delta);
+    }
+
+    //remove satellites from the buffers if they are no longer being tracked
+    for(int n = 0; n <= Sat_Buff_Table::max_PRN; n++)
+        {
+            if(sat_buffs.count(n) && std::find(PRNs.begin(), PRNs.end(), static_cast<unsigned int>(n)) == PRNs.end())
                 {
-                    LOG(INFO) << "External iono data are consistent with records from satellites ";
+                    sat_buffs.erase(n);
                 }
         }
-    else
-        {
-            LOG(INFO) << "No external iono data record for satellites ";
-        }
+    
+    //caluclate the mean of the variances
+    //calc_mean_var(sample_counter);
+    //caluclate the max of the variances
+    calc_max_var(sample_counter);
+    
 }
 
-/*! 
- *  Check whether the Gps time received from the satellites is consistent with
- *  Gps_Ref_Time model data received from an external source
+/*!
+ *  Signal quality monitoring: checks the distortion of the correlation peak of each satellite,
+ *  from the extra correlator taps of its tracking channel (see Sqm_Monitor). An undistorted peak
+ *  is symmetric, so delta and asymmetry are compared to 0. The filtering of the front-end rounds
+ *  the peak the same way for all the satellites, so ratio is compared to its mean over the
+ *  satellites tracked.
  */
-void Spoofing_Detector::check_external_gps_time(int internal_week, int internal_TOW, double timestamp)
+void Spoofing_Detector::check_SQM(const Channel_List& channels, Gnss_Synchro **in, int sample_counter)
 {
-    lookup_external_nav_data(1,0);
-    Gps_Ref_Time external;
-    external = supl_client_.gps_time;
+    if( !d_SQM )
+        return;
+    static const std::shared_ptr<Block_Metrics> metrics = make_block_metrics("spoofing", "check_SQM");
+    Block_Metrics_Scope metrics_scope(metrics.get(), channels.size());
+    metrics_scope.set_items(1);
 
-    int internal_time = internal_week*seconds_per_week+internal_TOW;
-    
-    if( external.valid )
+    std::vector<Sqm_Metrics> sqms;
+    for(Channel_List::const_iterator it = channels.begin(); it != channels.end(); ++it)
         {
-            int external_time = external.d_Week*seconds_per_week+external.d_TOW; 
-            //create strings from the the ephemeris object for easy comparison
-            bool the_same = external_time == internal_time; 
+            Sqm_Metrics sqm;
+            if(d_receiver_state->sqm_map.read(in[*it][0].Channel_ID, sqm) and sqm.PRN == in[*it][0].PRN and sqm.sample_counter != 0)
+                {
+                    sqms.push_back(sqm);
+                }
+        }
+    if( sqms.empty() )
+        return;
 
-            if( !the_same )
+    double mean_ratio[SQM_MAX_PAIRS] = {};
+    for(unsigned int k = 0; k < sqms.size(); k++)
+        {
+            for(unsigned int p = 0; p < sqms[k].n_pairs; p++)
                 {
-                    std::cout << "External gps time not consistent with records from satellites " << std::endl;
-                    LOG(INFO) << "External gps time not consistent with records from satellites "; 
-                    std::stringstream s;
-                    s << "External gps time not consistent with records from satellites "; 
-                    std::stringstream sr;
-                    sr << "At " << timestamp/1e3 << " s GPS time data was received that was not consistent with records from external sources.\n"; 
+                    mean_ratio[p] += sqms[k].ratio[p] / sqms.size();
+                }
+        }
+
+    for(unsigned int k = 0; k < sqms.size(); k++)
+        {
+            const Sqm_Metrics& sqm = sqms[k];
+            for(unsigned int p = 0; p < sqm.n_pairs; p++)
+                {
+                    bool ratio_alarm = sqms.size() > 1 and std::abs(sqm.ratio[p] - mean_ratio[p]) > d_SQM_ratio_threshold;
+                    bool delta_alarm = std::abs(sqm.delta[p]) > d_SQM_delta_threshold;
+                    bool asymmetry_alarm = std::abs(sqm.asymmetry[p]) > d_SQM_asymmetry_threshold;
+                    if( !ratio_alarm and !delta_alarm and !asymmetry_alarm )
+                        continue;
+
                     Spoofing_Message msg;
-                    msg.spoofing_case = 6;
-                    std::set<unsigned int> sats = {};
-                    msg.satellites = sats;
+                    msg.spoofing_case = 10;
+                    msg.satellites = {sqm.PRN};
+                    std::stringstream s;
+                    s << "Distorted correlation peak of satellite " << sqm.PRN << " at " << sqm.spacing_chips[p] << " chips:";
+                    s << " ratio " << sqm.ratio[p] << " (mean " << mean_ratio[p] << "), delta " << sqm.delta[p] << ", asymmetry " << sqm.asymmetry[p];
                     msg.description = s.str();
+                    std::stringstream sr;
+                    sr << "At " << sample_counter/(d_fs_in*1e3) << " s the correlation peak of satellite " << sqm.PRN
+                       << " was distorted at " << sqm.spacing_chips[p] << " chips from the prompt. Ratio: " << sqm.ratio[p]
+                       << " (mean of the satellites: " << mean_ratio[p] << "), delta: " << sqm.delta[p] << ", asymmetry: " << sqm.asymmetry[p]
+                       << ". SPREE is configured to raise an alarm if the ratio is off its mean by more than " << d_SQM_ratio_threshold
+                       << ", or if delta or asymmetry are above " << d_SQM_delta_threshold << " and " << d_SQM_asymmetry_threshold << ".\n";
                     msg.spoofing_report = sr.str();
                     spoofing_detected(msg);
+                    break;
                 }
-            else
-                {
-                    LOG(INFO) << "External gps time is consistent with records from satellites ";
-                }
-        }
-    else
-        {
-            LOG(INFO) << "No external gps time record for satellites ";
         }
 }
 
 /*!
- *  Check whether the Almanac data received from the satellites is consistent with
- *  Almanac data received from an external source
+ *  Angle of arrival: the signals of a spoofer leave one antenna, so they reach the elements of the
+ *  array with the same steering vector whatever the satellite, while those of the satellites come
+ *  from their own directions. The steering vectors of two satellites are compared by the magnitude
+ *  of their inner product, 1 for the same direction, which needs no calibration of the array.
+ *  Satellites whose Prompt is not coherent across the elements (multipath, low CN0) are left out.
  */
-void Spoofing_Detector::check_external_almanac(std::map<int, Gps_Almanac> internal_map, double timestamp)
+void Spoofing_Detector::check_AoA(const Channel_List& channels, Gnss_Synchro **in, int sample_counter)
 {
-    lookup_external_nav_data(1,0);
-    std::map< int, Gps_Almanac> external_map;
-    external_map = supl_client_.gps_almanac_map;
-    
-    unsigned int PRN;
-    Gps_Almanac internal;
-    for(std::map<int, Gps_Almanac>::iterator it = internal_map.begin(); it != internal_map.end(); it++)
-        { 
-            PRN = it->first;
-            internal = it->second; 
-            if(external_map.count( PRN) )
+    if( !d_AoA )
+        return;
+    static const std::shared_ptr<Block_Metrics> metrics = make_block_metrics("spoofing", "check_AoA");
+    Block_Metrics_Scope metrics_scope(metrics.get(), channels.size());
+    metrics_scope.set_items(1);
+
+    std::vector<Aoa_Metrics> aoas;
+    for(Channel_List::const_iterator it = channels.begin(); it != channels.end(); ++it)
+        {
+            Aoa_Metrics aoa;
+            if(d_receiver_state->aoa_map.read(in[*it][0].Channel_ID, aoa) and aoa.PRN == in[*it][0].PRN and aoa.sample_counter != 0
+                    and aoa.n_elements > 1 and aoa.coherence >= d_AoA_min_coherence)
                 {
-                    //create strings from the the ephemeris object for easy comparison
-                    Gps_Almanac external= external_map.at( PRN );  
-                    bool the_same = compare_almanac(internal, external);
+                    aoas.push_back(aoa);
+                }
+        }
+    if( aoas.size() < d_AoA_min_satellites )
+        return;
 
-                    if( !the_same )
+    // the satellites that arrive from the direction of each one
+    std::vector<unsigned int> largest;
+    double similarity_sum = 0;
+    for(unsigned int i = 0; i < aoas.size(); i++)
+        {
+            std::vector<unsigned int> group;
+            double sum = 0;
+            for(unsigned int j = 0; j < aoas.size(); j++)
+                {
+                    if( aoas[j].n_elements != aoas[i].n_elements )
+                        continue;
+                    std::complex<float> dot(0, 0);
+                    for(unsigned int k = 0; k < aoas[i].n_elements; k++)
                         {
-                            std::cout << "External almanac data not consistent with records from satellite " << PRN << std::endl;
-                            LOG(INFO) << "Externautc almanac data not consistent with records from satellite " << PRN; 
-                            std::stringstream s;
-                            s << "Externautc almanac data not consistent with records from satellite " << PRN; 
-                            std::stringstream sr;
-                            sr << "At " << timestamp/1e3 << " s almanac data not was recevied from satellite " << PRN 
-                               << " that was not consistent with records from external sources.\n"; 
-                            Spoofing_Message msg;
-                            msg.spoofing_case = 0;
-                            std::set<unsigned int> sats = {PRN};
-                            msg.satellites = sats;
-                            msg.description = s.str();
-                            msg.spoofing_report = sr.str();
-                            spoofing_detected(msg);
+                            dot += aoas[i].steering[k] * std::conj(aoas[j].steering[k]);
                         }
-                    else
+                    if( std::abs(dot) >= d_AoA_max_similarity )
                         {
-                            LOG(INFO) << "External almanac data is consistent with records from satellite " << PRN;
+                            group.push_back(j);
+                            sum += std::abs(dot);
                         }
                 }
-            else
+            if( group.size() > largest.size() )
                 {
-                    LOG(INFO) << "No external almanac data record for satellite " << PRN;
+                    largest = group;
+                    similarity_sum = sum;
                 }
         }
+    if( largest.size() < d_AoA_min_satellites )
+        return;
+
+    Spoofing_Message msg;
+    msg.spoofing_case = 11;
+    std::stringstream prns;
+    for(unsigned int n = 0; n < largest.size(); n++)
+        {
+            msg.satellites.insert(aoas[largest[n]].PRN);
+            prns << (n ? ", " : "") << aoas[largest[n]].PRN;
+        }
+    std::stringstream s;
+    s << "Satellites " << prns.str() << " arrive from the same direction, mean similarity " << similarity_sum / largest.size();
+    msg.description = s.str();
+    std::stringstream sr;
+    sr << "At " << sample_counter/(d_fs_in*1e3) << " s the signals of satellites " << prns.str()
+       << " reached the antenna array with the same steering vector, mean similarity: " << similarity_sum / largest.size()
+       << ". SPREE is configured to raise an alarm if " << d_AoA_min_satellites << " satellites or more have a similarity above "
+       << d_AoA_max_similarity << ".\n";
+    msg.spoofing_report = sr.str();
+    spoofing_detected(msg);
 }
 
 /*!
- *  Loopup external ephemeris, ionospheric, almanac data or utc model
- *  source states from where this information is retrieved (e.g. 1:supl server, 2:file)
- *  type specifies the type of data that is asked for (1: ephemeris, 0: iono, alma, utc)
+ *  Power and spectrum of the signal conditioners: an alarm for each anomaly that the
+ *  spectrum_monitor_sink of a conditioner found since the last check. The thresholds are
+ *  those of the monitor (Spoofing.spectrum_power_rise_db and spectrum_deviation_db).
  */
-void Spoofing_Detector::lookup_external_nav_data(int source, int type)
-{
-    //std::string d_default_eph_server = "supl.google.com";
-    std::string d_default_eph_server = "supl.nokia.com";
-    supl_client_.server_name = d_default_eph_server;
-    supl_client_.server_port = 7275;
-    int supl_mcc = 244;
-    int supl_mns = 5; 
-    int supl_lac = 0x59e2;
-    int supl_ci = 0x31b0;
-
-    std::map<int,Gps_Ephemeris> result;
-    switch( source )
-    {
-    case 1:
-        // Request ephemeris from SUPL server
-        int error;
-        supl_client_.request = type;
-        error = supl_client_.get_assistance(supl_mcc, supl_mns, supl_lac, supl_ci);
-        if (error == 0)
-        {
-            if( type == 1 )
-                {
-                    std::cout << "SUPL: Try to read GPS ephemeris from SUPL server.." << std::endl;
-                    //Save ephemeris to XML file
-                    std::string eph_xml_filename = "../data/ephemeris.xml"; 
-                    if (supl_client_.save_ephemeris_map_xml(eph_xml_filename, supl_client_.gps_ephemeris_map) == true)
-                    {
-                        std::cout << "SUPL: XML Ephemeris file created" << std::endl;
-                    }
-                    else
-                    {
-                        std::cout << "SUPL: Failed to create XML Ephemeris file" << std::endl;
-                    }
-                }
-            else if( type == 0)
-                {
-                    std::cout << "SUPL: Try to iono, alamanc and utc model from SUPL server.." << std::endl;
-                    //Save iono, utc model and almanac to XML file
-                    std::string utc_xml_filename = "../data/utc.xml"; 
-                    std::map<int, Gps_Utc_Model> utc_map;
-                    utc_map[0] = supl_client_.gps_utc;
-                    if (supl_client_.save_utc_map_xml(utc_xml_filename, utc_map) == true)
-                    {
-                        std::cout << "SUPL: XML Utc model file created" << std::endl;
-                    }
-                    else
-                    {
-                        std::cout << "SUPL: Failed to create XML Utc model file" << std::endl;
-                    }
-
-                    std::string iono_xml_filename = "../data/iono.xml"; 
-                    std::map<int, Gps_Iono> iono_map;
-                    iono_map[0] = supl_client_.gps_iono;
-                    if (supl_client_.save_iono_map_xml(iono_xml_filename, iono_map) == true)
-                    {
-                        std::cout << "SUPL: XML iono model file created" << std::endl;
-                    }
-                    else
-                    {
-                        std::cout << "SUPL: Failed to create XML iono model file" << std::endl;
-                    }
+void Spoofing_Detector::check_spectrum(int sample_counter)
+{
+    if( !d_spectrum )
+        return;
+    static const std::shared_ptr<Block_Metrics> metrics = make_block_metrics("spoofing", "check_spectrum");
+    Block_Metrics_Scope metrics_scope(metrics.get(), 1);
+    metrics_scope.set_items(1);
 
-                    std::string ref_time_xml_filename = "../data/ref_time.xml"; 
-                    std::map<int, Gps_Ref_Time> ref_time_map;
-                    ref_time_map[0] = supl_client_.gps_time;
-                    if (supl_client_.save_ref_time_map_xml(ref_time_xml_filename, ref_time_map) == true)
-                        {
-                            LOG(INFO) << "SUPL: Successfully saved Ref Time XML file";
-                        }
-                    else
-                        {
-                            LOG(INFO) << "SUPL: Error while trying to save ref time XML file";
-                        }
-                }
-        }
-        else
+    std::map<int, Spectrum_Metrics> spectra = d_receiver_state->spectrum_map.get_map_copy();
+    for(std::map<int, Spectrum_Metrics>::const_iterator it = spectra.begin(); it != spectra.end(); ++it)
         {
-            std::cout << "ERROR: SUPL client returned " << error << std::endl;
-            std::cout << "Please check internet connection and SUPL server configuration" << error << std::endl;
+            const Spectrum_Metrics& spectrum = it->second;
+            unsigned int& reported = d_spectrum_onsets[it->first];
+            if( spectrum.onsets == reported )
+                continue;
+            reported = spectrum.onsets;
+
+            Spoofing_Message msg;
+            msg.spoofing_case = 12;
+            std::stringstream s;
+            s.precision(3);
+            s << "Signal conditioner " << it->first << ": power " << spectrum.power_db - spectrum.floor_db
+              << " dB over the noise floor, spectrum deviation " << spectrum.deviation_db << " dB";
+            msg.description = s.str();
+            std::stringstream sr;
+            sr.precision(3);
+            sr << "At " << sample_counter/(d_fs_in*1e3) << " s the input of signal conditioner " << it->first
+               << " had a power of " << spectrum.power_db << " dB, " << spectrum.power_db - spectrum.floor_db
+               << " dB over its noise floor (standard deviation " << spectrum.floor_sigma_db
+               << " dB), and a bin of its spectrum " << spectrum.deviation_db << " dB over its mean, spectral flatness "
+               << spectrum.flatness << ". The jamming or the takeover of a spoofer starts with such a change,"
+               << " before any satellite is affected.\n";
+            msg.spoofing_report = sr.str();
+            spoofing_detected(msg);
         }
-        break;
-            
-    case 2:
-        std::string eph_xml_filename = "gps_ephemeris.xml"; 
-        std::string utc_xml_filename = "gps_utc.xml"; 
-        std::string iono_xml_filename = "gps_iono.xml"; 
+}
 
-        // Try to read ephemeris from XML
-        if (supl_client_.load_ephemeris_xml(eph_xml_filename) == true)
-            {
-                LOG(INFO) << "SUPL: Read XML Ephemeris data";
-            }
-        else
+void Spoofing_Detector::calc_max_var(int sample_counter)
+{
+    double max_snr_var = 0;
+    double max_delta_var = 0;
+    double max_rt_var = 0;
+    
+    for(int PRN = 0; PRN <= Sat_Buff_Table::max_PRN; PRN++)
+        {
+            if(!sat_buffs.count(PRN))
+                continue;
+            const SatBuff& sb = sat_buffs.at(PRN);
+            if( sb.count < d_PPE_window_size )
+                continue;
+
+            if(max_snr_var < sb.SNR_cb.var())
+                max_snr_var = sb.SNR_cb.var();
+            if(max_delta_var < sb.delta_cb.var())
+                max_delta_var = sb.delta_cb.var();
+            if(max_rt_var < sb.RT_cb.var())
+                max_rt_var = sb.RT_cb.var();
+        }
+
+    Spoofing_Message msg;
+    msg.spoofing_case = 10;
+    std::set<unsigned int> sats = {};
+    msg.satellites = sats;
+    if( max_snr_var >= d_CN0_threshold )
+        {
+            std::stringstream s;
+            s << " The CN0 indicates a spoofing attack"; 
+            s << " CN0: " << max_snr_var;
+            s << ", " << sample_counter; 
+            msg.description = s.str();
+            std::stringstream sr;
+            sr << "At " << sample_counter/(d_fs_in*1e3) << " s the moving standard variantion of CN0 was above the expected value." 
+              << " CN0: " << max_snr_var << ". SPREE is configured to raise an alarm if it is above " << d_CN0_threshold << ".\n";
+            msg.spoofing_report = sr.str();
+            spoofing_detected(msg);
+        }
+    if( max_rt_var >= d_RT_threshold )
+        {
+            std::stringstream s;
+            s << " The RT indicates a spoofing attack"; 
+            s << " RT: " << max_rt_var;
+            s << ", " << sample_counter; 
+            msg.description = s.str();
+            std::stringstream sr;
+            sr << "At " << sample_counter/(d_fs_in*1e3) << " s the moving standard variantion of RT was above the expected value." 
+              << " RT: " << max_rt_var << ". SPREE is configured to raise an alarm if it is above " << d_RT_threshold << ".\n";
+            msg.spoofing_report = sr.str();
+            spoofing_detected(msg);
+        }
+    if( max_delta_var >= d_Delta_threshold )
+        {
+            std::stringstream s;
+            s << " The Delta indicates a spoofing attack"; 
+            s << " Delta: " << max_delta_var;
+            s << ", " << sample_counter; 
+            msg.description = s.str();
+            std::stringstream sr;
+            sr << "At " << sample_counter/(d_fs_in*1e3) << " s the moving standard variantion of delta was above the expected value." 
+              << " Delta: " << max_delta_var << ". SPREE is configured to raise an alarm if it is above " << d_Delta_threshold << ".\n";
+            msg.spoofing_report = sr.str();
+            spoofing_detected(msg);
+        }
+}
+
+
+double Spoofing_Detector::StdDeviation(std::vector<double> v)
+{
+    double sum = std::accumulate(v.begin(), v.end(), 0.0);
+    double mean = sum / v.size();
+    std::vector<double> diff(v.size());
+    std::transform(v.begin(), v.end(), diff.begin(),
+        std::bind2nd(std::minus<double>(), mean));
+
+    double sq_sum = std::inner_product(diff.begin(), diff.end(), diff.begin(), 0.0);
+    double stdev = std::sqrt(sq_sum / v.size());
+    return stdev;
+}
+
+
+double get_stdDev(std::vector<double> v, double mean)
+{
+    double sum = 0;
+
+    for(std::vector<double>::iterator it = v.begin(); it != v.end(); it++)
+        {
+            sum += (*it-mean)*(*it-mean); 
+        }
+    return std::sqrt(sum / v.size());
+
+}
+
+
+double Spoofing_Detector::get_SNR_corr(const Channel_List& channels, Gnss_Synchro **in, int sample_counter)
+{
+    // CN0 of this epoch, one sample per satellite
+    std::map<unsigned int, double> epoch_SNR;
+    unsigned int i;
+    for(Channel_List::const_iterator it = channels.begin(); it != channels.end(); ++it)
+    {
+        i = *it;
+        epoch_SNR[in[i][0].PRN] = in[i][0].CN0_dB_hz;
+    }
+
+    //we have a buffer with previous SNR samples
+    for(std::map<unsigned int, double>::iterator it = epoch_SNR.begin(); it != epoch_SNR.end(); ++it)
+    {
+        std::map<int, Rolling_Statistics>::iterator restored = d_restored_SNR.find(it->first);
+        if(restored != d_restored_SNR.end())
+            {
+                if(satellite_SNR_corr.samples(it->first).empty())
+                    satellite_SNR_corr.insert(it->first, restored->second.samples());
+                d_restored_SNR.erase(restored);
+            }
+    }
+
+    // the satellites that are no longer tracked leave the matrix, and the sums
+    // of all the pairs are updated with the samples of the epoch
+    satellite_SNR_corr.push_back(epoch_SNR);
+
+    double p_corr;
+    double corr_sum = 0;
+    for(unsigned int a = 0; a < satellite_SNR_corr.slots(); a++)
+    {
+        if(!satellite_SNR_corr.active(a))
+            continue;
+        for(unsigned int b = a + 1; b < satellite_SNR_corr.slots(); b++)
+        {
+            if(!satellite_SNR_corr.active(b))
+                continue;
+            p_corr = get_corr(a, b);
+            corr_sum += p_corr;
+        }
+    }
+
+    Spoofing_Message msg;
+    msg.spoofing_case = 10;
+    std::set<unsigned int> sats = {};
+    msg.satellites = sats;
+
+    if(corr_sum > 3)
+    {
+        std::stringstream s;
+        s << " The SNR correlation is above expected values, "; 
+        s << " SNR: " << corr_sum; 
+        s << ", " << sample_counter; 
+        msg.description = s.str();
+        std::stringstream sr;
+        sr << "At " << sample_counter/(d_fs_in*1e3) << " s the CN0 correlation was above the expected value." 
+          << " CN0: " << corr_sum << ". SPREE is configured to raise an alarm if it is above 3.\n";
+        msg.spoofing_report = sr.str();
+        spoofing_detected(msg);
+    }
+    return corr_sum;
+
+}
+
+double Spoofing_Detector::get_corr(unsigned int a, unsigned int b)
+{
+    if(!satellite_SNR_corr.full(a, b))
+        {
+            //DLOG(INFO) << "don't have enough SNR values to calculate correlation";
+            return 0; 
+        }
+    
+    double corr = satellite_SNR_corr.cov(a, b) / (satellite_SNR_corr.var(a, b) * satellite_SNR_corr.var(b, a)); 
+    return corr;
+
+}
+
+double Spoofing_Detector::check_SNR(const Channel_List& channels, Gnss_Synchro **in, int sample_counter)
+{
+    static const std::shared_ptr<Block_Metrics> metrics = make_block_metrics("spoofing", "check_SNR");
+    Block_Metrics_Scope metrics_scope(metrics.get(), channels.size());
+    metrics_scope.set_items(1);
+    boost::mutex::scoped_lock lock(d_ppe_mutex);
+    unsigned int d_cno_count =4;
+    double d_cno_min = 1;
+    if(channels.size() < d_cno_count)
+        {
+            return 0;
+        }
+
+    std::vector<double> SNRs;
+    unsigned int i;
+    for(Channel_List::const_iterator it = channels.begin(); it != channels.end(); ++it)
+    {
+        i = *it;
+        SNRs.push_back(in[i][0].CN0_dB_hz);
+    }
+
+    double stdev = StdDeviation(SNRs); 
+    double mv_avg;
+    
+    Spoofing_Message msg;
+    msg.spoofing_case = 10;
+    std::set<unsigned int> sats = {};
+    msg.satellites = sats;
+    ppe_cb.push_back(stdev);
+    if(ppe_cb.size() >= 1000)
+        {
+            mv_avg = ppe_cb.mean();
+            if(mv_avg < d_cno_min)
+                {
+                    std::stringstream s;
+                    s << " The SNR stdev is below expected values, "; 
+                    s << " SNR: " << mv_avg; 
+                    s << ", " << sample_counter; 
+                    msg.description = s.str();
+                    std::stringstream sr;
+                    sr << "At " << sample_counter/(d_fs_in*1e3) << " s the CN0 standard deviation was below the expected value." 
+                      << " CN0: " << mv_avg << ". SPREE is configured to raise an alarm if it is below " << d_cno_min << ".\n";
+                    msg.spoofing_report = sr.str();
+                    spoofing_detected(msg);
+                }
+        }
+    
+    //calculate pearson correlation
+    //double p_corr = get_cov(SNR
+
+   /* 
+    if(stdev < d_cno_min)
+        {
+            std::stringstream s;
+            s << " the SNR stdev is below expected values, "; 
+            s << " SNR: " << stdev; 
+            s << ", " << sample_counter; 
+            spoofing_detected(s.str(), 10);
+        }*/
+    return stdev;
+}
+
+/*!
+ *  Check whether we have examined all subframe reception times. The subframe
+ *  ids of the peaks of the satellite are collected in a mask, the peaks have
+ *  been compared against each other when it has a single bit set.
+ */
+void Spoofing_Detector::update_APT_releases(unsigned int PRN)
+{
+    concurrent_subframe_map::Snapshot snapshot = d_receiver_state->subframe_map.get_snapshot();
+    std::map<unsigned int, Prn_subframes>::const_iterator prn_iter = snapshot->by_prn.find(PRN);
+    if(prn_iter == snapshot->by_prn.end())
+        return;
+    const std::map<int, Subframe_ptr>& channels = prn_iter->second.channels;
+
+    unsigned int subframe_ids = 0;
+    unsigned int min_uid = 0;
+    for (std::map<int, Subframe_ptr>::const_iterator it = channels.begin(); it != channels.end(); ++it)
+    {
+        const Subframe& subframe = *it->second;
+        subframe_ids |= 1u << (subframe.subframe_id & 31);
+        if( it == channels.begin() || subframe.uid < min_uid )
+            {
+                min_uid = subframe.uid;
+            }
+    }
+
+    //stop tracking the channels that have been checked against all others and
+    //aren't tracking the lowest numbered peak, if no spoofing has been detected
+    TRACE_LOG(TRACE_SPOOFING, 1) << "Stop tracking ? " << std::hex << subframe_ids << std::dec << " " << channels.size() << " " << min_uid;
+    bool spoofed;
+    if( (subframe_ids & (subframe_ids - 1)) != 0 || channels.size() < 2 || d_receiver_state->spoofing_status.read(PRN, spoofed) )
+        return;
+    boost::mutex::scoped_lock lock(d_APT_release_mutex);
+    for (std::map<int, Subframe_ptr>::const_iterator it = channels.begin(); it != channels.end(); ++it)
+    {
+        if( it->second->uid > min_uid )
+            {
+                d_APT_releases.insert(it->second->uid);
+            }
+    }
+    d_APT_pending_releases.store(d_APT_releases.size(), std::memory_order_release);
+}
+
+
+bool Spoofing_Detector::APT_release(unsigned int PRN, unsigned int uid)
+{
+    if( d_APT_pending_releases.load(std::memory_order_acquire) == 0 )
+        return false;
+    boost::mutex::scoped_lock lock(d_APT_release_mutex);
+    if( d_APT_releases.erase(uid) == 0 )
+        return false;
+    d_APT_pending_releases.store(d_APT_releases.size(), std::memory_order_release);
+    lock.unlock();
+    // an alarm raised after the decision keeps the peak
+    bool spoofed;
+    return !d_receiver_state->spoofing_status.read(PRN, spoofed);
+}
+
+
+void Spoofing_Detector::forget_APT_release(unsigned int uid)
+{
+    boost::mutex::scoped_lock lock(d_APT_release_mutex);
+    if( d_APT_releases.erase(uid) != 0 )
+        {
+            d_APT_pending_releases.store(d_APT_releases.size(), std::memory_order_release);
+        }
+}
+
+
+/*!
+ *  Check whether the reception time of two different peaks of the same satellite
+ *  are within the configurable value d_maximum_deviation
+ *  also determine if we should stop tracking this channels peak
+ */
+void Spoofing_Detector::check_RX_time(unsigned int PRN)
+{
+    static const std::shared_ptr<Block_Metrics> metrics = make_block_metrics("spoofing", "check_RX_time");
+    Block_Metrics_Scope metrics_scope(metrics.get(), 0);
+    metrics_scope.set_items(1);
+    TRACE_LOG(TRACE_SPOOFING, 1) << "check rx time";
+
+    //the earliest and latest reception times are kept by the PRN index
+    concurrent_subframe_map::Snapshot snapshot = d_receiver_state->subframe_map.get_snapshot();
+    std::map<unsigned int, Prn_subframes>::const_iterator prn_iter = snapshot->by_prn.find(PRN);
+    if(prn_iter == snapshot->by_prn.end())
+        return;
+    const Subframe* smallest = prn_iter->second.earliest.get();
+    const Subframe* largest = prn_iter->second.latest.get();
+    
+    double largest_t = largest->timestamp;
+    double smallest_t = smallest->timestamp;
+    bool spoofed = false;
+    int diff = 0;
+
+    if(std::abs(largest_t-smallest_t) >= d_APT_max_rx_discrepancy)
+        {
+            if(largest->subframe_id != smallest->subframe_id)
+                {
+                    diff = largest->subframe_id-smallest->subframe_id;
+                    if(std::abs(largest_t-smallest_t)/std::fmod(diff, 5) > 6001) 
+                        {
+                            spoofed = true;
+                        }
+                }
+            else
+                {
+                    spoofed = true;
+                }
+        }
+
+    if(spoofed)
+        {
+            double distance = std::abs(largest_t-smallest_t)*GPS_C_m_s/1e3; 
+            std::stringstream s;
+            std::stringstream sr;
+            s << "Auxiliary peak detected for satellite " << PRN << "\n";
+            s << "Peak seperation: " << std::setprecision(16) << std::abs(largest_t-smallest_t)*1e6 << " [ns]\n"; 
+            s << "Pseudorange change: " << std::setprecision(16) << distance <<" [m]\n"; 
+            Spoofing_Message msg;
+            msg.spoofing_case = 1;
+            std::set<unsigned int> sats = {PRN};
+            msg.satellites = sats;
+            msg.description = s.str();
+
+            sr << "At " << largest_t/1e3 << " s an auxiliary peak was detected for satellite " << PRN
+               << " with peak seperation of " << std::setprecision(16) << std::abs(largest_t-smallest_t)*1e6 << " [ns] which translates to a" 
+               << " pseudorange change of " << std::setprecision(16) << distance <<" [m]. "
+               << "SPREE is configured to raise an alarm if a peak seperation of more than " << d_APT_max_rx_discrepancy*1e6 << " [ns] is detected.\n"; 
+            
+            msg.spoofing_report = sr.str();
+            spoofing_detected(msg);
+        }
+
+}
+
+/*!
+ *  Check if two subframes contain the same values, if not raise a spoofing alarm.
+ *  Return true if the subframes were compared but false if they were not.
+ */
+bool Spoofing_Detector::compare_subframes(const Subframe& subframeA, const Subframe& subframeB)
+{
+        TRACE_LOG(TRACE_SPOOFING, 2) << "check subframe "<< subframeA.subframe_id << std::endl
+        << subframeA.subframe.to_string() << std::endl
+        << subframeB.subframe.to_string();
+
+        //one of the ephemeris data has not been updated.
+        if(subframeA.timestamp == 0 ||  subframeB.timestamp == 0)
             {
-                LOG(INFO) << "SUPL: couldn't read Ephemeris data XML";
+                TRACE_LOG(TRACE_SPOOFING, 1) << "Subframes timestamps are zero";
+                return 0;
             }
 
-        // Try to read utc model from XML
-        if (supl_client_.load_utc_xml(utc_xml_filename) == true)
+        if( subframeA.toa != subframeB.toa && subframeA.PRN != subframeB.PRN)
             {
-                LOG(INFO) << "SUPL: Read XML UTC model";
+                TRACE_LOG(TRACE_SPOOFING, 1) << "Almanac data doesn't have the same toa";
+                //std::cout << "Almanac data doesn't have the same toa" << std::endl;
+                return 1;
             }
-        else
+
+/*
+        //one of the ephemeris data has not been updated.
+        if(std::abs(subframeA.timestamp -subframeB.timestamp) > 3000)
             {
-                LOG(INFO) << "SUPL: couldn't read UTC model XML";
+                TRACE_LOG(TRACE_SPOOFING, 2) << "Subframes timestamps differ more than one" << std::endl
+                << subframeA.timestamp << " " << subframeB.timestamp << std::endl
+                << subframeA.subframe_id << " " << subframeB.subframe_id << std::endl
+                << subframeA.subframe.to_string() << std::endl << subframeB.subframe.to_string() << std::endl;
+                return 0;
             }
-
-        // Try to read Iono model from XML
-        if (supl_client_.load_iono_xml(iono_xml_filename) == true)
+  */          
+        if(!subframeA.subframe.empty() && !subframeB.subframe.empty() && !subframeA.subframe.same_data(subframeB.subframe))
             {
-                LOG(INFO) << "SUPL: Read XML IONO model";
+                std::stringstream s;
+                std::stringstream sr;
+                s << "Navigational message manipulation detected\n";
+                sr << "At " << subframeA.timestamp/1e3 << " s a navigational message manipulation was detected. ";
+                if( subframeA.PRN == subframeB.PRN)
+                    {
+                        s << "Subframe " << subframeA.subframe_id << " not the same for two peaks of satellite " << subframeA.PRN << "\n"; 
+                        sr << "Subframe " << subframeA.subframe_id << " was not the same for two peaks of satellite " << subframeA.PRN << "\n"; 
+                    }
+                else
+                    {
+                        s << "Subframe " << subframeA.subframe_id << " not the same for satellites " << subframeA.PRN << " and " << subframeB.PRN << "\n"; 
+                        sr << "Subframe " << subframeA.subframe_id << " was not the same for satellites " << subframeA.PRN << " and " << subframeB.PRN << "\n"; 
+                    }
+                Spoofing_Message msg;
+                msg.spoofing_case = 2;
+                std::set<unsigned int> sats = {subframeA.PRN, subframeB.PRN};
+                msg.satellites = sats;
+                msg.description = s.str();
+                msg.spoofing_report = sr.str();
+                spoofing_detected(msg);
             }
         else
             {
-                LOG(INFO) << "SUPL: couldn't read IONO model XML";
+                TRACE_LOG(TRACE_SPOOFING, 2) << " subframes: " << std::endl
+                << subframeA.timestamp << " " << subframeB.timestamp << std::endl
+                << subframeA.subframe_id << " " << subframeB.subframe_id << std::endl
+                << subframeA.subframe.to_string() << std::endl << subframeB.subframe.to_string() << std::endl;
             }
-
-        break;
-    }
-
+    return 1;
 }
 
 /*!
- * Compare two sets of ephemeris data for the same TOW.
+ *  Check if the subframes for two peaks is the same 
  */
-bool Spoofing_Detector::compare_ephemeris(Gps_Ephemeris a, Gps_Ephemeris b)
+void Spoofing_Detector::check_APT_subframe(unsigned int uid, unsigned int subframe_id)
 {
-    if( a.i_satellite_PRN != b.i_satellite_PRN)
+    unsigned int idA, idB;
+    concurrent_subframe_map::Snapshot snapshot = d_receiver_state->subframe_map.get_snapshot();
+    std::map<int, Subframe_ptr>::const_iterator itA = snapshot->by_uid.find(uid);
+    if(itA == snapshot->by_uid.end())
         {
-            DLOG(INFO) << "Comparing ephemeris of two different satellites";
-            return true;
+            TRACE_LOG(TRACE_SPOOFING, 1) << "check subframe - but subframe for sat " << uid << " subframe: " << subframe_id << " not in subframe map"; 
+            return;
         }
-    bool the_same = true; 
+    const Subframe& subframeA = *itA->second;
+    idA = uid;
 
-    if( a.i_peak != b.i_peak )
-        {
-            the_same = false;
-            DLOG(INFO) << "i_peak not the same: " << a.i_peak << " " << b.i_peak;
-        }
-    if( a.d_TOW != b.d_TOW )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_TOW not the same: " << a.d_TOW << " " << b.d_TOW;
-        }
-    if( a.d_Crs != b.d_Crs )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Crs not the same: " << a.d_Crs << " " << b.d_Crs;
-        }
-    if( a.d_Delta_n != b.d_Delta_n )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Delta_n not the same: " << a.d_Delta_n << " " << b.d_Delta_n;
-        }
-    if( a.d_M_0 != b.d_M_0 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_M_0 not the same: " << a.d_M_0 << " " << b.d_M_0;
-        }
-    if( a.d_Cuc != b.d_Cuc )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Cuc not the same: " << a.d_Cuc << " " << b.d_Cuc;
-        }
-    if( a.d_e_eccentricity != b.d_e_eccentricity )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_e_eccentricity not the same: " << a.d_e_eccentricity << " " << b.d_e_eccentricity;
-        }
-    if( a.d_Cus != b.d_Cus )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Cus not the same: " << a.d_Cus << " " << b.d_Cus;
-        }
-    if( a.d_sqrt_A != b.d_sqrt_A )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_sqrt_A not the same: " << a.d_sqrt_A << " " << b.d_sqrt_A;
-        }
-    if( a.d_Toe != b.d_Toe )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Toe not the same: " << a.d_Toe << " " << b.d_Toe;
-        }
-    if( a.d_Toc != b.d_Toc )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Toc not the same: " << a.d_Toc << " " << b.d_Toc;
-        }
-    if( a.d_Cic != b.d_Cic )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Cic not the same: " << a.d_Cic << " " << b.d_Cic;
-        }
-    if( a.d_OMEGA0 != b.d_OMEGA0 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_OMEGA0 not the same: " << a.d_OMEGA0 << " " << b.d_OMEGA0;
-        }
-    if( a.d_Cis != b.d_Cis )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Cis not the same: " << a.d_Cis << " " << b.d_Cis;
-        }
-    if( a.d_i_0 != b.d_i_0 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_i_0 not the same: " << a.d_i_0 << " " << b.d_i_0;
-        }
-    if( a.d_Crc != b.d_Crc )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Crc not the same: " << a.d_Crc << " " << b.d_Crc;
-        }
-    if( a.d_OMEGA != b.d_OMEGA )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_OMEGA not the same: " << a.d_OMEGA << " " << b.d_OMEGA;
-        }
-    if( a.d_OMEGA_DOT != b.d_OMEGA_DOT )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_OMEGA_DOT not the same: " << a.d_OMEGA_DOT << " " << b.d_OMEGA_DOT;
-        }
-    if( a.d_IDOT != b.d_IDOT )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_IDOT not the same: " << a.d_IDOT << " " << b.d_IDOT;
-        }
-    if( a.i_code_on_L2 != b.i_code_on_L2 )
-        {
-            the_same = false;
-            DLOG(INFO) << "i_code_on_L2 not the same: " << a.i_code_on_L2 << " " << b.i_code_on_L2;
-        }
-    if( a.i_GPS_week != b.i_GPS_week )
-        {
-            the_same = false;
-            DLOG(INFO) << "i_GPS_week not the same: " << a.i_GPS_week << " " << b.i_GPS_week;
-        }
-    if( a.b_L2_P_data_flag != b.b_L2_P_data_flag )
-        {
-            the_same = false;
-            DLOG(INFO) << "b_L2_P_data_flag not the same: " << a.b_L2_P_data_flag << " " << b.b_L2_P_data_flag;
-        }
-    if( a.i_SV_accuracy != b.i_SV_accuracy )
-        {
-            the_same = false;
-            DLOG(INFO) << "i_SV_accuracy not the same: " << a.i_SV_accuracy << " " << b.i_SV_accuracy;
-        }
-    if( a.i_SV_health != b.i_SV_health )
-        {
-            the_same = false;
-            DLOG(INFO) << "i_SV_health not the same: " << a.i_SV_health << " " << b.i_SV_health;
-        }
-    if( a.d_TGD != b.d_TGD )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_TGD not the same: " << a.d_TGD << " " << b.d_TGD;
-        }
-    if( a.d_IODC != b.d_IODC )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_IODC not the same: " << a.d_IODC << " " << b.d_IODC;
-        }
-    if( a.i_AODO != b.i_AODO )
-        {
-            the_same = false;
-            DLOG(INFO) << "i_AODO not the same: " << a.i_AODO << " " << b.i_AODO;
-        }
-    if( a.b_fit_interval_flag != b.b_fit_interval_flag )
-        {
-            the_same = false;
-            DLOG(INFO) << "b_fit_interval_flag not the same: " << a.b_fit_interval_flag << " " << b.b_fit_interval_flag;
-        }
-    if( a.d_spare1 != b.d_spare1 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_spare1 not the same: " << a.d_spare1 << " " << b.d_spare1;
-        }
-    if( a.d_spare2 != b.d_spare2 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_spare2 not the same: " << a.d_spare2 << " " << b.d_spare2;
-        }
-    if( a.d_A_f0 != b.d_A_f0 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_A_f0 not the same: " << a.d_A_f0 << " " << b.d_A_f0;
-        }
-    if( a.d_A_f1 != b.d_A_f1 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_A_f1 not the same: " << a.d_A_f1 << " " << b.d_A_f1;
-        }
-    if( a.d_A_f2 != b.d_A_f2 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_A_f2 not the same: " << a.d_A_f2 << " " << b.d_A_f2;
-        }
-    if( a.b_integrity_status_flag != b.b_integrity_status_flag )
-        {
-            the_same = false;
-            DLOG(INFO) << "b_integrity_status_flag not the same: " << a.b_integrity_status_flag << " " << b.b_integrity_status_flag;
-        }
-    if( a.b_alert_flag != b.b_alert_flag )
-        {
-            the_same = false;
-            DLOG(INFO) << "b_alert_flag not the same: " << a.b_alert_flag << " " << b.b_alert_flag;
-        }
-    if( a.b_antispoofing_flag != b.b_antispoofing_flag )
-        {
-            the_same = false;
-            DLOG(INFO) << "b_antispoofing_flag not the same: " << a.b_antispoofing_flag << " " << b.b_antispoofing_flag;
-        }
-    if( a.d_spare1 != b.d_spare1 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_spare1 not the same: " << a.d_spare1 << " " << b.d_spare1;
-        }
-    if( a.d_spare2 != b.d_spare2 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_spare2 not the same: " << a.d_spare2 << " " << b.d_spare2;
-        }
-    if( a.d_A_f0 != b.d_A_f0 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_A_f0 not the same: " << a.d_A_f0 << " " << b.d_A_f0;
-        }
-    if( a.d_A_f1 != b.d_A_f1 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_A_f1 not the same: " << a.d_A_f1 << " " << b.d_A_f1;
-        }
-    if( a.d_A_f2 != b.d_A_f2 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_A_f2 not the same: " << a.d_A_f2 << " " << b.d_A_f2;
-        }
-    if( a.b_integrity_status_flag != b.b_integrity_status_flag )
-        {
-            the_same = false;
-            DLOG(INFO) << "b_integrity_status_flag not the same: " << a.b_integrity_status_flag << " " << b.b_integrity_status_flag;
-        }
-    if( a.b_alert_flag != b.b_alert_flag )
-        {
-            the_same = false;
-            DLOG(INFO) << "b_alert_flag not the same: " << a.b_alert_flag << " " << b.b_alert_flag;
-        }
-    if( a.b_antispoofing_flag != b.b_antispoofing_flag )
-        {
-            the_same = false;
-            DLOG(INFO) << "b_antispoofing_flag not the same: " << a.b_antispoofing_flag << " " << b.b_antispoofing_flag;
-        }
+    //only the peaks of the same satellite are visited
+    const std::map<int, Subframe_ptr>& channels = snapshot->by_prn.at(subframeA.PRN).channels;
+    for (std::map<int, Subframe_ptr>::const_iterator it = channels.begin(); it!= channels.end(); ++it)
+    {
+        idB = it->first;
+        const Subframe& subframeB = *it->second;
 
-    return the_same;
+        TRACE_LOG(TRACE_SPOOFING, 2) << "subframeB " << subframeB.subframe_id << " " << idB << " " << subframeB.PRN;
+        TRACE_LOG(TRACE_SPOOFING, 2) <<  (subframeB.subframe_id != subframe_id) << " " << (idB == idA);
+        if(subframeB.subframe_id != subframe_id || idB == idA)
+            continue;
+        
+        compare_subframes(subframeA, subframeB);
+    }
 }
 
 /*!
- * Compare two sets of ephemeris data for different TOW.
+ *  Check if the shared subframes 4 and 5 are the same from all satellites
  */
-bool Spoofing_Detector::compare_ephemeris_dTOW(Gps_Ephemeris a, Gps_Ephemeris b)
+void Spoofing_Detector::check_inter_satellite_subframe(unsigned int uid, unsigned int subframe_id)
 {
-    if( a.i_satellite_PRN != b.i_satellite_PRN)
-        {
-            DLOG(INFO) << "Comparing ephemeris of two different satellites";
-            return true;
-        }
-    bool the_same = true; 
+ //   std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();                                                                                                          
+//    DLOG(INFO) << "check subframe " << subframe_id << " for " << uid;
 
-    if( a.i_peak != b.i_peak )
-        {
-            the_same = false;
-            DLOG(INFO) << "i_peak not the same: " << a.i_peak << " " << b.i_peak;
-        }
-    if( a.d_Crs != b.d_Crs )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Crs not the same: " << a.d_Crs << " " << b.d_Crs;
-        }
-    if( a.d_Delta_n != b.d_Delta_n )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Delta_n not the same: " << a.d_Delta_n << " " << b.d_Delta_n;
-        }
-    if( a.d_M_0 != b.d_M_0 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_M_0 not the same: " << a.d_M_0 << " " << b.d_M_0;
-        }
-    if( a.d_Cuc != b.d_Cuc )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Cuc not the same: " << a.d_Cuc << " " << b.d_Cuc;
-        }
-    if( a.d_e_eccentricity != b.d_e_eccentricity )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_e_eccentricity not the same: " << a.d_e_eccentricity << " " << b.d_e_eccentricity;
-        }
-    if( a.d_Cus != b.d_Cus )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Cus not the same: " << a.d_Cus << " " << b.d_Cus;
-        }
-    if( a.d_sqrt_A != b.d_sqrt_A )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_sqrt_A not the same: " << a.d_sqrt_A << " " << b.d_sqrt_A;
-        }
-    if( a.d_Toe != b.d_Toe )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Toe not the same: " << a.d_Toe << " " << b.d_Toe;
-        }
-    if( a.d_Toc != b.d_Toc )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Toc not the same: " << a.d_Toc << " " << b.d_Toc;
-        }
-    if( a.d_Cic != b.d_Cic )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Cic not the same: " << a.d_Cic << " " << b.d_Cic;
-        }
-    if( a.d_OMEGA0 != b.d_OMEGA0 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_OMEGA0 not the same: " << a.d_OMEGA0 << " " << b.d_OMEGA0;
-        }
-    if( a.d_Cis != b.d_Cis )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Cis not the same: " << a.d_Cis << " " << b.d_Cis;
-        }
-    if( a.d_i_0 != b.d_i_0 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_i_0 not the same: " << a.d_i_0 << " " << b.d_i_0;
-        }
-    if( a.d_Crc != b.d_Crc )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Crc not the same: " << a.d_Crc << " " << b.d_Crc;
-        }
-    if( a.d_OMEGA != b.d_OMEGA )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_OMEGA not the same: " << a.d_OMEGA << " " << b.d_OMEGA;
-        }
-    if( a.d_OMEGA_DOT != b.d_OMEGA_DOT )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_OMEGA_DOT not the same: " << a.d_OMEGA_DOT << " " << b.d_OMEGA_DOT;
-        }
-    if( a.d_IDOT != b.d_IDOT )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_IDOT not the same: " << a.d_IDOT << " " << b.d_IDOT;
-        }
-    if( a.i_code_on_L2 != b.i_code_on_L2 )
-        {
-            the_same = false;
-            DLOG(INFO) << "i_code_on_L2 not the same: " << a.i_code_on_L2 << " " << b.i_code_on_L2;
-        }
-    if( a.i_GPS_week != b.i_GPS_week )
-        {
-            the_same = false;
-            DLOG(INFO) << "i_GPS_week not the same: " << a.i_GPS_week << " " << b.i_GPS_week;
-        }
-    if( a.b_L2_P_data_flag != b.b_L2_P_data_flag )
-        {
-            the_same = false;
-            DLOG(INFO) << "b_L2_P_data_flag not the same: " << a.b_L2_P_data_flag << " " << b.b_L2_P_data_flag;
-        }
-    if( a.i_SV_accuracy != b.i_SV_accuracy )
-        {
-            the_same = false;
-            DLOG(INFO) << "i_SV_accuracy not the same: " << a.i_SV_accuracy << " " << b.i_SV_accuracy;
-        }
-    if( a.i_SV_health != b.i_SV_health )
-        {
-            the_same = false;
-            DLOG(INFO) << "i_SV_health not the same: " << a.i_SV_health << " " << b.i_SV_health;
-        }
-    if( a.d_TGD != b.d_TGD )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_TGD not the same: " << a.d_TGD << " " << b.d_TGD;
-        }
-    if( a.d_IODC != b.d_IODC )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_IODC not the same: " << a.d_IODC << " " << b.d_IODC;
-        }
-    if( a.i_AODO != b.i_AODO )
-        {
-            the_same = false;
-            DLOG(INFO) << "i_AODO not the same: " << a.i_AODO << " " << b.i_AODO;
-        }
-    if( a.b_fit_interval_flag != b.b_fit_interval_flag )
-        {
-            the_same = false;
-            DLOG(INFO) << "b_fit_interval_flag not the same: " << a.b_fit_interval_flag << " " << b.b_fit_interval_flag;
-        }
-    if( a.d_spare1 != b.d_spare1 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_spare1 not the same: " << a.d_spare1 << " " << b.d_spare1;
-        }
-    if( a.d_spare2 != b.d_spare2 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_spare2 not the same: " << a.d_spare2 << " " << b.d_spare2;
-        }
-    if( a.d_A_f0 != b.d_A_f0 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_A_f0 not the same: " << a.d_A_f0 << " " << b.d_A_f0;
-        }
-    if( a.d_A_f1 != b.d_A_f1 )
+    unsigned int idA, idB;
+    concurrent_subframe_map::Snapshot snapshot = d_receiver_state->subframe_map.get_snapshot();
+    std::map<int, Subframe_ptr>::const_iterator itA = snapshot->by_uid.find(uid);
+    if(itA == snapshot->by_uid.end())
         {
-            the_same = false;
-            DLOG(INFO) << "d_A_f1 not the same: " << a.d_A_f1 << " " << b.d_A_f1;
+            TRACE_LOG(TRACE_SPOOFING, 1) << "check subframe - but subframe for sat " << uid << " subframe: " << subframe_id << " not in subframe map"; 
+            return;
         }
-    if( a.d_A_f2 != b.d_A_f2 )
+    const Subframe& subframeA = *itA->second;
+    idA = uid;
+
+    //only the channels whose last subframe has the same id are visited
+    std::map<unsigned int, std::set<int> >::const_iterator ids_iter = snapshot->by_subframe_id.find(subframe_id);
+    if(ids_iter == snapshot->by_subframe_id.end())
+        return;
+    for (std::set<int>::const_iterator it = ids_iter->second.begin(); it!= ids_iter->second.end(); ++it)
+    {
+        idB = *it;
+        if(idB == idA)
+            continue;
+        const Subframe& subframeB = *snapshot->by_uid.at(idB);
+        TRACE_LOG(TRACE_SPOOFING, 2) << "subframeB " << subframeB.subframe_id << " " << idB << " " << subframeB.PRN;
+        
+        compare_subframes(subframeA, subframeB);
+    }
+/*
+    std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();                                                                                                          
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>( t2 - t1 ).count(); 
+    DLOG(INFO) << "dur_sf: " << duration;
+*/
+}
+
+/*!
+ *  Check whether the ephemeris data received from the satellites is consistent with
+ *  ephemeris data received from an external source
+ */
+void Spoofing_Detector::check_external_ephemeris(Gps_Ephemeris eph_internal, unsigned int PRN, double timestamp)
+{
+    if(d_rinex_source)
+        compare_rinex_ephemeris(eph_internal, PRN, timestamp);
+    if(!d_supl_service)
+        return;
+    boost::mutex::scoped_lock lock(d_supl_mutex);
+    d_pending_ephemeris[PRN] = std::make_pair(eph_internal, timestamp);
+    lock.unlock();
+    if(d_supl_service->request(Supl_Assistance_Service::EPHEMERIS))
+        on_external_nav_data(Supl_Assistance_Service::EPHEMERIS);
+}
+
+void Spoofing_Detector::compare_external_ephemeris(Gps_Ephemeris eph_internal, unsigned int PRN, double timestamp)
+{
+    Gps_Ephemeris eph_external;
+    if(d_supl_service->get_ephemeris(PRN, eph_external))
         {
-            the_same = false;
-            DLOG(INFO) << "d_A_f2 not the same: " << a.d_A_f2 << " " << b.d_A_f2;
+            bool the_same = compare_ephemeris(eph_internal, eph_external);
+
+            if( !the_same )
+                {
+                    std::cout << "External ephemeris not consistent with ephemeris records from satellite " << PRN << std::endl;
+                    LOG(INFO) << "External ephemeris not consistent with ephemeris records from satellite " << PRN; 
+                    std::stringstream s;
+                    s << "External ephemeris not consistent with ephemeris records from satellite " << PRN;
+                    std::stringstream sr;
+                    sr << "At " << timestamp/1e3 << " ephemeris records for satellite " << PRN 
+                       << "was received that is not consistent with ephemeris records from external sources.\n"; 
+                    Spoofing_Message msg;
+                    msg.spoofing_case = 0;
+                    std::set<unsigned int> sats = {PRN};
+                    msg.satellites = sats;
+                    msg.description = s.str();
+                    msg.spoofing_report = sr.str();
+                    spoofing_detected(msg);
+
+                }
+            else
+                {
+                    LOG(INFO) << "External ephemeris are consistent with ephemeris records from satellite " << PRN;
+                }
         }
-    if( a.b_integrity_status_flag != b.b_integrity_status_flag )
+    else
         {
-            the_same = false;
-            DLOG(INFO) << "b_integrity_status_flag not the same: " << a.b_integrity_status_flag << " " << b.b_integrity_status_flag;
+            LOG(INFO) << "No external ephemeris record for satellite " << PRN;
         }
-    if( a.b_alert_flag != b.b_alert_flag )
+}
+
+/*!
+ *  Compares the ephemeris received from the satellite with the one of the RINEX
+ *  navigation files with the same Toe and IODE. The files round the values to 12
+ *  digits, so they are compared within a relative tolerance. An ephemeris not
+ *  in the files yet waits for the next file read.
+ */
+void Spoofing_Detector::compare_rinex_ephemeris(const Gps_Ephemeris& eph_internal, unsigned int PRN, double timestamp)
+{
+    Gps_Ephemeris eph_rinex;
+    if(!d_rinex_source->get_ephemeris(PRN, eph_internal.d_Toe, eph_internal.d_IODE_SF2, eph_rinex))
         {
-            the_same = false;
-            DLOG(INFO) << "b_alert_flag not the same: " << a.b_alert_flag << " " << b.b_alert_flag;
+            LOG(INFO) << "No RINEX ephemeris record for satellite " << PRN << " with Toe " << eph_internal.d_Toe;
+            boost::mutex::scoped_lock lock(d_supl_mutex);
+            d_pending_rinex_ephemeris[PRN] = std::make_pair(eph_internal, timestamp);
+            return;
         }
-    if( a.b_antispoofing_flag != b.b_antispoofing_flag )
-        {
-            the_same = false;
-            DLOG(INFO) << "b_antispoofing_flag not the same: " << a.b_antispoofing_flag << " " << b.b_antispoofing_flag;
+    // the fields of a RINEX record; the others (flags, spares, AODO) are not in the files
+    static const Nav_Field_Mask checked = [] {
+        const std::vector<Nav_Field<Gps_Ephemeris> >& fields = gps_ephemeris_fields();
+        Nav_Field_Mask mask = nav_field_bit(fields, "d_Toc") | nav_field_bit(fields, "d_IODC") | nav_field_bit(fields, "i_SV_health");
+        for(unsigned int i = 0; i < fields.size(); i++)
+            {
+                if(fields[i].threshold_key)
+                    mask |= Nav_Field_Mask(1) << i;
+            }
+        return mask;
+    }();
+    Nav_Field_Mask differ = nav_fields_differ_relative(gps_ephemeris_fields(), eph_internal, eph_rinex, d_NAVI_external_rinex_tolerance, checked);
+    if( differ )
+        {
+            DLOG(INFO) << nav_fields_report(gps_ephemeris_fields(), differ, eph_internal, eph_rinex);
+            std::cout << "RINEX ephemeris not consistent with ephemeris records from satellite " << PRN << std::endl;
+            LOG(INFO) << "RINEX ephemeris not consistent with ephemeris records from satellite " << PRN;
+            std::stringstream s;
+            s << "RINEX ephemeris not consistent with ephemeris records from satellite " << PRN;
+            std::stringstream sr;
+            sr << "At " << timestamp/1e3 << " ephemeris records for satellite " << PRN
+               << " was received that is not consistent with the RINEX navigation files.\n";
+            Spoofing_Message msg;
+            msg.spoofing_case = 0;
+            std::set<unsigned int> sats = {PRN};
+            msg.satellites = sats;
+            msg.description = s.str();
+            msg.spoofing_report = sr.str();
+            spoofing_detected(msg);
         }
-    if( a.d_spare1 != b.d_spare1 )
+    else
         {
-            the_same = false;
-            DLOG(INFO) << "d_spare1 not the same: " << a.d_spare1 << " " << b.d_spare1;
+            LOG(INFO) << "RINEX ephemeris are consistent with ephemeris records from satellite " << PRN;
         }
-    if( a.d_spare2 != b.d_spare2 )
+}
+
+/*!
+ *  Runs the RINEX checks that were waiting for a file with their ephemeris.
+ *  Called from the thread of the RINEX source when it has read new data.
+ */
+void Spoofing_Detector::on_rinex_nav_data()
+{
+    std::map<unsigned int, std::pair<Gps_Ephemeris, double> > ephemeris;
+    boost::mutex::scoped_lock lock(d_supl_mutex);
+    ephemeris.swap(d_pending_rinex_ephemeris);
+    lock.unlock();
+    for(std::map<unsigned int, std::pair<Gps_Ephemeris, double> >::iterator it = ephemeris.begin(); it != ephemeris.end(); it++)
         {
-            the_same = false;
-            DLOG(INFO) << "d_spare2 not the same: " << a.d_spare2 << " " << b.d_spare2;
+            compare_rinex_ephemeris(it->second.first, it->first, it->second.second);
         }
-    if( a.d_A_f0 != b.d_A_f0 )
+}
+
+/*! 
+ *  check whether the UTC Model data received from the satellites is consistent with
+ *  UTC model data received from an external source
+ */
+void Spoofing_Detector::check_external_utc(Gps_Utc_Model internal, double timestamp)
+{
+    if(!d_supl_service)
+        return;
+    boost::mutex::scoped_lock lock(d_supl_mutex);
+    push_pending(d_pending_utc, std::make_pair(internal, timestamp));
+    lock.unlock();
+    if(d_supl_service->request(Supl_Assistance_Service::ALMANAC_UTC_IONO))
+        on_external_nav_data(Supl_Assistance_Service::ALMANAC_UTC_IONO);
+}
+
+void Spoofing_Detector::compare_external_utc(Gps_Utc_Model internal, double timestamp)
+{
+    Gps_Utc_Model external;
+    if( d_supl_service->get_utc(external) && external.valid && internal.valid )
         {
-            the_same = false;
-            DLOG(INFO) << "d_A_f0 not the same: " << a.d_A_f0 << " " << b.d_A_f0;
+            //create strings from the the ephemeris object for easy comparison
+            bool the_same = compare_utc(internal, external);
+
+            if( !the_same )
+                {
+                    std::cout << "External utc model not consistent with records from satellites " << std::endl;
+                    LOG(INFO) << "Externautc utc model not consistent with records from satellites "; 
+
+                    std::stringstream s;
+                    s << "External utc utc model not consistent with records from satellites "; 
+                    std::stringstream sr;
+                    sr << "At " << timestamp/1e3 << " s UTC GPS time data was received that was not consistent with records from external sources.\n"; 
+                    Spoofing_Message msg;
+                    msg.spoofing_case = 6;
+                    std::set<unsigned int> sats = {};
+                    msg.satellites = sats;
+                    msg.description = s.str();
+                    msg.spoofing_report = sr.str();
+                    spoofing_detected(msg);
+                }
+            else
+                {
+                    LOG(INFO) << "External utc model are consistent with records from satellites ";
+                }
         }
-    if( a.d_A_f1 != b.d_A_f1 )
+    else
         {
-            the_same = false;
-            DLOG(INFO) << "d_A_f1 not the same: " << a.d_A_f1 << " " << b.d_A_f1;
+            LOG(INFO) << "No external utc model record for satellites ";
         }
-    if( a.d_A_f2 != b.d_A_f2 )
+}
+
+/*!
+ *  Check whether the Iono Model data received from the satellites is consistent with
+ *  Iono model data received from an external source.
+ */
+void Spoofing_Detector::check_external_iono(Gps_Iono internal, double timestamp)
+{
+    if(!d_supl_service)
+        return;
+    boost::mutex::scoped_lock lock(d_supl_mutex);
+    push_pending(d_pending_iono, std::make_pair(internal, timestamp));
+    lock.unlock();
+    if(d_supl_service->request(Supl_Assistance_Service::ALMANAC_UTC_IONO))
+        on_external_nav_data(Supl_Assistance_Service::ALMANAC_UTC_IONO);
+}
+
+void Spoofing_Detector::compare_external_iono(Gps_Iono internal, double timestamp)
+{
+    Gps_Iono external;
+    if( d_supl_service->get_iono(external) && external.valid && internal.valid )
         {
-            the_same = false;
-            DLOG(INFO) << "d_A_f2 not the same: " << a.d_A_f2 << " " << b.d_A_f2;
+            //create strings from the the ephemeris object for easy comparison
+            bool the_same = compare_iono(internal, external);
+
+            if( !the_same )
+                {
+                    std::cout << "External iono data not consistent with records from satellites " << std::endl;
+                    LOG(INFO) << "Externautc iono data not consistent with records from satellites "; 
+                    std::stringstream s;
+                    s << "Externautc iono data not consistent with records from satellites "; 
+                    std::stringstream sr;
+                    sr << "At " << timestamp/1e3 << " s Ionospheric GPS time data was received that was not consistent with records from external sources.\n"; 
+                    Spoofing_Message msg;
+                    msg.spoofing_case = 6;
+                    std::set<unsigned int> sats = {};
+                    msg.satellites = sats;
+                    msg.description = s.str();
+                    msg.spoofing_report = sr.str();
+                    spoofing_detected(msg);
+                }
+            else
+                {
+                    LOG(INFO) << "External iono data are consistent with records from satellites ";
+                }
         }
-    if( a.b_integrity_status_flag != b.b_integrity_status_flag )
+    else
         {
-            the_same = false;
-            DLOG(INFO) << "b_integrity_status_flag not the same: " << a.b_integrity_status_flag << " " << b.b_integrity_status_flag;
+            LOG(INFO) << "No external iono data record for satellites ";
         }
-    if( a.b_alert_flag != b.b_alert_flag )
+}
+
+/*! 
+ *  Check whether the Gps time received from the satellites is consistent with
+ *  Gps_Ref_Time model data received from an external source
+ */
+void Spoofing_Detector::check_external_gps_time(int internal_week, int internal_TOW, double timestamp)
+{
+    if(!d_supl_service)
+        return;
+    boost::mutex::scoped_lock lock(d_supl_mutex);
+    push_pending(d_pending_gps_time, std::make_pair(std::make_pair(internal_week, internal_TOW), timestamp));
+    lock.unlock();
+    if(d_supl_service->request(Supl_Assistance_Service::ALMANAC_UTC_IONO))
+        on_external_nav_data(Supl_Assistance_Service::ALMANAC_UTC_IONO);
+}
+
+void Spoofing_Detector::compare_external_gps_time(int internal_week, int internal_TOW, double timestamp)
+{
+    Gps_Ref_Time external;
+    int internal_time = internal_week*seconds_per_week+internal_TOW;
+    
+    if( d_supl_service->get_ref_time(external) && external.valid )
         {
-            the_same = false;
-            DLOG(INFO) << "b_alert_flag not the same: " << a.b_alert_flag << " " << b.b_alert_flag;
+            int external_time = external.d_Week*seconds_per_week+external.d_TOW; 
+            //create strings from the the ephemeris object for easy comparison
+            bool the_same = external_time == internal_time; 
+
+            if( !the_same )
+                {
+                    std::cout << "External gps time not consistent with records from satellites " << std::endl;
+                    LOG(INFO) << "External gps time not consistent with records from satellites "; 
+                    std::stringstream s;
+                    s << "External gps time not consistent with records from satellites "; 
+                    std::stringstream sr;
+                    sr << "At " << timestamp/1e3 << " s GPS time data was received that was not consistent with records from external sources.\n"; 
+                    Spoofing_Message msg;
+                    msg.spoofing_case = 6;
+                    std::set<unsigned int> sats = {};
+                    msg.satellites = sats;
+                    msg.description = s.str();
+                    msg.spoofing_report = sr.str();
+                    spoofing_detected(msg);
+                }
+            else
+                {
+                    LOG(INFO) << "External gps time is consistent with records from satellites ";
+                }
         }
-    if( a.b_antispoofing_flag != b.b_antispoofing_flag )
+    else
         {
-            the_same = false;
-            DLOG(INFO) << "b_antispoofing_flag not the same: " << a.b_antispoofing_flag << " " << b.b_antispoofing_flag;
+            LOG(INFO) << "No external gps time record for satellites ";
         }
-
-    return the_same;
 }
 
-
 /*!
- * Compare two sets of almanac data.
+ *  Check whether the Almanac data received from the satellites is consistent with
+ *  Almanac data received from an external source
  */
-bool Spoofing_Detector::compare_almanac(Gps_Almanac a, Gps_Almanac b)
+void Spoofing_Detector::check_external_almanac(std::map<int, Gps_Almanac> internal_map, double timestamp)
 {
-    if( a.i_satellite_PRN != b.i_satellite_PRN)
-        {
-            DLOG(INFO) << "Comparing almanac data of two different satellites";
-            return true;
+    if(!d_supl_service)
+        return;
+    boost::mutex::scoped_lock lock(d_supl_mutex);
+    for(std::map<int, Gps_Almanac>::iterator it = internal_map.begin(); it != internal_map.end(); it++)
+        { 
+            d_pending_almanac[it->first] = std::make_pair(it->second, timestamp);
         }
+    lock.unlock();
+    if(d_supl_service->request(Supl_Assistance_Service::ALMANAC_UTC_IONO))
+        on_external_nav_data(Supl_Assistance_Service::ALMANAC_UTC_IONO);
+}
 
-    bool the_same = true; 
-    if( a.d_Delta_i != b.d_Delta_i )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Delta_i not the same: " << a.d_Delta_i << " " << b.d_Delta_i;
-        }
-    if( a.d_Toa != b.d_Toa )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_Toa not the same: " << a.d_Toa << " " << b.d_Toa;
-        }
-    if( a.d_M_0 != b.d_M_0 )
+void Spoofing_Detector::compare_external_almanac(Gps_Almanac internal, unsigned int PRN, double timestamp)
+{
+    Gps_Almanac external;
+    if(d_supl_service->get_almanac(PRN, external))
         {
-            the_same = false;
-            DLOG(INFO) << "d_M_0 not the same: " << a.d_M_0 << " " << b.d_M_0;
+            bool the_same = compare_almanac(internal, external);
+
+            if( !the_same )
+                {
+                    std::cout << "External almanac data not consistent with records from satellite " << PRN << std::endl;
+                    LOG(INFO) << "Externautc almanac data not consistent with records from satellite " << PRN; 
+                    std::stringstream s;
+                    s << "Externautc almanac data not consistent with records from satellite " << PRN; 
+                    std::stringstream sr;
+                    sr << "At " << timestamp/1e3 << " s almanac data not was recevied from satellite " << PRN 
+                       << " that was not consistent with records from external sources.\n"; 
+                    Spoofing_Message msg;
+                    msg.spoofing_case = 0;
+                    std::set<unsigned int> sats = {PRN};
+                    msg.satellites = sats;
+                    msg.description = s.str();
+                    msg.spoofing_report = sr.str();
+                    spoofing_detected(msg);
+                }
+            else
+                {
+                    LOG(INFO) << "External almanac data is consistent with records from satellite " << PRN;
+                }
         }
-    if( a.d_e_eccentricity != b.d_e_eccentricity )
+    else
         {
-            the_same = false;
-            DLOG(INFO) << "d_e_eccentricity not the same: " << a.d_e_eccentricity << " " << b.d_e_eccentricity;
+            LOG(INFO) << "No external almanac data record for satellite " << PRN;
         }
-    if( a.d_sqrt_A != b.d_sqrt_A )
+}
+
+/*!
+ *  Runs the external checks that were waiting for assistance data of this type.
+ *  Called from the SUPL worker thread when new data arrives, or directly when
+ *  the cached data is still fresh.
+ */
+void Spoofing_Detector::on_external_nav_data(int type)
+{
+    boost::mutex::scoped_lock lock(d_supl_mutex);
+    if(type == Supl_Assistance_Service::EPHEMERIS)
         {
-            the_same = false;
-            DLOG(INFO) << "d_sqrt_A not the same: " << a.d_sqrt_A << " " << b.d_sqrt_A;
+            std::map<unsigned int, std::pair<Gps_Ephemeris, double> > ephemeris;
+            ephemeris.swap(d_pending_ephemeris);
+            lock.unlock();
+            for(std::map<unsigned int, std::pair<Gps_Ephemeris, double> >::iterator it = ephemeris.begin(); it != ephemeris.end(); it++)
+                {
+                    compare_external_ephemeris(it->second.first, it->first, it->second.second);
+                }
+            return;
         }
-    if( a.d_OMEGA0 != b.d_OMEGA0 )
+
+    std::map<unsigned int, std::pair<Gps_Almanac, double> > almanac;
+    std::vector<std::pair<Gps_Utc_Model, double> > utc;
+    std::vector<std::pair<Gps_Iono, double> > iono;
+    std::vector<std::pair<std::pair<int, int>, double> > gps_time;
+    almanac.swap(d_pending_almanac);
+    utc.swap(d_pending_utc);
+    iono.swap(d_pending_iono);
+    gps_time.swap(d_pending_gps_time);
+    lock.unlock();
+    for(std::map<unsigned int, std::pair<Gps_Almanac, double> >::iterator it = almanac.begin(); it != almanac.end(); it++)
         {
-            the_same = false;
-            DLOG(INFO) << "d_OMEGA0 not the same: " << a.d_OMEGA0 << " " << b.d_OMEGA0;
+            compare_external_almanac(it->second.first, it->first, it->second.second);
         }
-    if( a.d_OMEGA != b.d_OMEGA )
+    for(unsigned int i = 0; i < utc.size(); i++)
         {
-            the_same = false;
-            DLOG(INFO) << "d_OMEGA not the same: " << a.d_OMEGA << " " << b.d_OMEGA;
+            compare_external_utc(utc.at(i).first, utc.at(i).second);
         }
-    if( a.d_OMEGA_DOT != b.d_OMEGA_DOT )
+    for(unsigned int i = 0; i < iono.size(); i++)
         {
-            the_same = false;
-            DLOG(INFO) << "d_OMEGA_DOT not the same: " << a.d_OMEGA_DOT << " " << b.d_OMEGA_DOT;
+            compare_external_iono(iono.at(i).first, iono.at(i).second);
         }
-    /*
-    if( a.i_SV_health != b.i_SV_health )
+    for(unsigned int i = 0; i < gps_time.size(); i++)
         {
-            the_same = false;
-            DLOG(INFO) << "i_SV_health not the same: " << a.i_SV_health << " " << b.i_SV_health;
+            compare_external_gps_time(gps_time.at(i).first.first, gps_time.at(i).first.second, gps_time.at(i).second);
         }
-    */
-    if( a.d_A_f0 != b.d_A_f0 )
+}
+
+/*!
+ * Compare two sets of ephemeris data for the same TOW.
+ */
+bool Spoofing_Detector::compare_ephemeris(const Gps_Ephemeris& a, const Gps_Ephemeris& b)
+{
+    if( a.i_satellite_PRN != b.i_satellite_PRN)
         {
-            the_same = false;
-            DLOG(INFO) << "d_A_f0 not the same: " << a.d_A_f0 << " " << b.d_A_f0;
+            TRACE_LOG(TRACE_SPOOFING, 1) << "Comparing ephemeris of two different satellites";
+            return true;
         }
-    if( a.d_A_f1 != b.d_A_f1 )
+    Nav_Field_Mask differ = nav_fields_differ(gps_ephemeris_fields(), a, b);
+    DLOG_IF(INFO, differ) << nav_fields_report(gps_ephemeris_fields(), differ, a, b);
+    return differ == 0;
+}
+
+/*!
+ * Compare two sets of almanac data.
+ */
+bool Spoofing_Detector::compare_almanac(const Gps_Almanac& a, const Gps_Almanac& b)
+{
+    if( a.i_satellite_PRN != b.i_satellite_PRN)
         {
-            the_same = false;
-            DLOG(INFO) << "d_A_f1 not the same: " << a.d_A_f1 << " " << b.d_A_f1;
+            TRACE_LOG(TRACE_SPOOFING, 1) << "Comparing almanac data of two different satellites";
+            return true;
         }
-
-    return the_same;
+    Nav_Field_Mask differ = nav_fields_differ(gps_almanac_fields(), a, b);
+    DLOG_IF(INFO, differ) << nav_fields_report(gps_almanac_fields(), differ, a, b);
+    return differ == 0;
 }
 
 /*!
  * Compare two Gps Iono models
  */
-bool Spoofing_Detector::compare_iono(Gps_Iono a, Gps_Iono b)
+bool Spoofing_Detector::compare_iono(const Gps_Iono& a, const Gps_Iono& b)
 {
-    bool the_same = true; 
-    if( a.d_alpha0 != b.d_alpha0 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_alpha0 not the same: " << a.d_alpha0 << " " << b.d_alpha0;
-        }
-    if( a.d_alpha1 != b.d_alpha1 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_alpha1 not the same: " << a.d_alpha1 << " " << b.d_alpha1;
-        }
-    if( a.d_alpha2 != b.d_alpha2 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_alpha2 not the same: " << a.d_alpha2 << " " << b.d_alpha2;
-        }
-    if( a.d_alpha3 != b.d_alpha3 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_alpha3 not the same: " << a.d_alpha3 << " " << b.d_alpha3;
-        }
-    if( a.d_beta0 != b.d_beta0 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_beta0 not the same: " << a.d_beta0 << " " << b.d_beta0;
-        }
-    if( a.d_beta1 != b.d_beta1 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_beta1 not the same: " << a.d_beta1 << " " << b.d_beta1;
-        }
-    if( a.d_beta2 != b.d_beta2 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_beta2 not the same: " << a.d_beta2 << " " << b.d_beta2;
-        }
-    if( a.d_beta3 != b.d_beta3 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_beta3 not the same: " << a.d_beta3 << " " << b.d_beta3;
-        }
-    if( a.valid != b.valid )
-        {
-            the_same = false;
-            DLOG(INFO) << "valid not the same: " << a.valid << " " << b.valid;
-        }
-    return the_same;
+    Nav_Field_Mask differ = nav_fields_differ(gps_iono_fields(), a, b);
+    DLOG_IF(INFO, differ) << nav_fields_report(gps_iono_fields(), differ, a, b);
+    return differ == 0;
 }
 
 /*!
  * Compare two Gps Utc models
  */
-bool Spoofing_Detector::compare_utc(Gps_Utc_Model a, Gps_Utc_Model b)
+bool Spoofing_Detector::compare_utc(const Gps_Utc_Model& a, const Gps_Utc_Model& b)
 {
-    bool the_same = true;
-    if( a.valid != b.valid )
-        {
-            the_same = false;
-            DLOG(INFO) << "valid not the same: " << a.valid << " " << b.valid;
-        }
-    if( a.d_A1 != b.d_A1 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_A1 not the same: " << a.d_A1 << " " << b.d_A1;
-        }
-    if( a.d_A0 != b.d_A0 )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_A0 not the same: " << a.d_A0 << " " << b.d_A0;
-        }
-    if( a.d_t_OT != b.d_t_OT )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_t_OT not the same: " << a.d_t_OT << " " << b.d_t_OT;
-        }
-    if( a.i_WN_T != b.i_WN_T )
-        {
-            the_same = false;
-            DLOG(INFO) << "i_WN_T not the same: " << a.i_WN_T << " " << b.i_WN_T;
-        }
-    if( a.d_DeltaT_LS != b.d_DeltaT_LS )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_DeltaT_LS not the same: " << a.d_DeltaT_LS << " " << b.d_DeltaT_LS;
-        }
-    if( a.i_WN_LSF != b.i_WN_LSF )
-        {
-            the_same = false;
-            DLOG(INFO) << "i_WN_LSF not the same: " << a.i_WN_LSF << " " << b.i_WN_LSF;
-        }
-    if( a.i_DN != b.i_DN )
-        {
-            the_same = false;
-            DLOG(INFO) << "i_DN not the same: " << a.i_DN << " " << b.i_DN;
-        }
-    if( a.d_DeltaT_LSF != b.d_DeltaT_LSF )
-        {
-            the_same = false;
-            DLOG(INFO) << "d_DeltaT_LSF not the same: " << a.d_DeltaT_LSF << " " << b.d_DeltaT_LSF;
-        } 
-    return the_same;
+    Nav_Field_Mask differ = nav_fields_differ(gps_utc_fields(), a, b);
+    DLOG_IF(INFO, differ) << nav_fields_report(gps_utc_fields(), differ, a, b);
+    return differ == 0;
 }
 
 
@@ -2352,30 +2958,24 @@ void Spoofing_Detector::New_subframe(int subframe_ID, int PRN, Gps_Navigation_Me
     subframe.subframe = nav.get_subframe(subframe_ID); 
     subframe.toa = nav.d_Toa;
     subframe.uid = uid;
-    global_subframe_map.add((int)uid, subframe);
+    d_receiver_state->subframe_map.add((int)uid, subframe);
+    if( d_peer_link )
+        {
+            d_peer_link->update_subframe(PRN, TOW, time);
+        }
 
-    std::map<int, Subframe> subframes = global_subframe_map.get_map_copy();
-    DLOG(INFO) << "New subframe: " << uid;
-    for (std::map<int, Subframe>::iterator it = subframes.begin(); it!= subframes.end(); ++it)
-    {
-        subframe = it->second;
-        DLOG(INFO) << "uid: " << it->first << " sub: " << subframe.subframe_id ;
-    }
+    TRACE_LOG(TRACE_SPOOFING, 1) << "New subframe: " << uid;
 
     if( d_APT )
         {
-            DLOG(INFO) << "check APT";
+            TRACE_LOG(TRACE_SPOOFING, 1) << "check APT";
             check_RX_time(PRN);
             check_APT_subframe(uid, subframe_ID);
         }
+    update_APT_releases(PRN);
 
     GPS_time_t gps_time;
-    std::map<int, GPS_time_t> gps_times = global_gps_time.get_map_copy();
-    if(gps_times.count(uid))
-        {
-            gps_time = gps_times.at(uid);
-        }
-    else
+    if(!d_receiver_state->gps_time.read((int)uid, gps_time))
         {
             gps_time.week = 0;
         }
@@ -2386,13 +2986,13 @@ void Spoofing_Detector::New_subframe(int subframe_ID, int PRN, Gps_Navigation_Me
 
     if( d_NAVI_inter_satellite )
         {
-            global_gps_time.add((int)uid, gps_time);
+            d_receiver_state->gps_time.add((int)uid, gps_time);
             check_GPS_time();
         }
 
     if( d_NAVI_TOW )
         {
-            DLOG(INFO) << "Check new TOW";
+            TRACE_LOG(TRACE_SPOOFING, 1) << "Check new TOW";
             check_new_TOW(time, GPS_week, TOW);
         }
 
@@ -2415,8 +3015,7 @@ void Spoofing_Detector::New_subframe(int subframe_ID, int PRN, Gps_Navigation_Me
         if (nav.satellite_validation() )
             {
                 Gps_Ephemeris ephemeris = nav.get_ephemeris();
-                if( d_NAVI_exp_eph )
-                    check_and_update_ephemeris(PRN, ephemeris, time);
+                check_and_update_ephemeris(PRN, ephemeris, time);
                 if (d_NAVI_external)
                     check_external_ephemeris(ephemeris, PRN, time); 
             }
@@ -40,26 +40,40 @@
 #include <map>
 #include <vector>
 #include <set>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <memory>
+#include <functional>
+#include <utility>
+#include <tuple>
+#include <boost/thread/mutex.hpp>
 #include "concurrent_map.h"
+#include "concurrent_snapshot_map.h"
+#include "concurrent_subframe_map.h"
+#include "epoch_arena.h"
 #include "gps_ephemeris.h"
 #include <string>
 #include "gnss_synchro.h"
-#include <boost/circular_buffer.hpp>
 #include "gps_iono.h"
 #include "gps_almanac.h"
 #include "gps_utc_model.h"
 #include "gps_ref_time.h"
-#include "gnss_sdr_supl_client.h"
+#include "supl_assistance_service.h"
+#include "rinex_nav_source.h"
 #include "configuration_interface.h"
 #include "gps_navigation_message.h"
 #include "gps_ephemeris.h"
 #include "spoofing_message.h"
+#include "spoofing_nav_unit.h"
+#include "rolling_statistics.h"
+#include "receiver_state.h"
 
-struct sEph{
-    Gps_Ephemeris ephemeris;
-    double time;
-    bool changed;
-};
+class Spoofing_Replay_Writer;
+class Spoofing_Check_Scheduler;
+class Receiver_Checkpoint;
+class Spoofing_Peer_Link;
+struct Spoofing_Peer_Summary;
 
 struct Satpos{
     double x;
@@ -68,30 +82,20 @@ struct Satpos{
     double time;
 };
 
-
-struct Subframe{
-    std::string subframe;
-    unsigned int subframe_id;
-    unsigned int PRN;
-    double timestamp;
-    unsigned int toa;
-    unsigned int uid;
-};
-
 struct SatBuff{
     int PRN;
-    boost::circular_buffer<double> SNR_cb; 
-    boost::circular_buffer<double> delta_cb; 
-    boost::circular_buffer<double> RT_cb;
-    double last_snr;
-    double last_rt;
-    double last_delta;
+    Rolling_Statistics SNR_cb; 
+    Rolling_Statistics delta_cb; 
+    Rolling_Statistics RT_cb;
+    double last_snr = 0;
+    double last_rt = 0;
+    double last_delta = 0;
     int count = 0;
 
     void init(int cb_window){
-        SNR_cb = boost::circular_buffer<double> (cb_window); 
-        delta_cb = boost::circular_buffer<double> (cb_window); 
-        RT_cb = boost::circular_buffer<double> (cb_window); 
+        SNR_cb = Rolling_Statistics(cb_window); 
+        delta_cb = Rolling_Statistics(cb_window); 
+        RT_cb = Rolling_Statistics(cb_window); 
     };
 
     void add(float CN0, float RT, float Delta){
@@ -123,6 +127,72 @@ struct SatBuff{
         last_delta = delta; 
         last_rt = rt; 
     }
+
+    void clear(){
+        SNR_cb.clear();
+        delta_cb.clear();
+        RT_cb.clear();
+        last_snr = 0;
+        last_rt = 0;
+        last_delta = 0;
+        count = 0;
+    }
+};
+
+
+/*!
+ * \brief The SatBuff of each tracked satellite, indexed by PRN.
+ *
+ * The windows of every PRN are sized once, by init(), so that tracking a
+ * new satellite only clears the windows of its entry and the detector
+ * never allocates while the receiver runs. PRNs beyond max_PRN are not
+ * kept.
+ */
+class Sat_Buff_Table
+{
+public:
+    static const int max_PRN = 63;
+
+    Sat_Buff_Table() : d_size(0) { for(int i = 0; i <= max_PRN; i++) d_used[i] = false; }
+
+    void init(int cb_window){
+        for(int i = 0; i <= max_PRN; i++)
+            {
+                d_buffs[i].init(cb_window);
+                d_buffs[i].PRN = i;
+                d_used[i] = false;
+            }
+        d_size = 0;
+    }
+
+    bool count(int PRN) const { return PRN >= 0 && PRN <= max_PRN && d_used[PRN]; }
+    unsigned int size() const { return d_size; }
+    SatBuff& at(int PRN) { return d_buffs[PRN]; }
+    const SatBuff& at(int PRN) const { return d_buffs[PRN]; }
+
+    //! Starts the entry of PRN with empty windows, false if PRN is out of range
+    bool insert(int PRN){
+        if(PRN < 0 || PRN > max_PRN)
+            return false;
+        if(!d_used[PRN])
+            d_size++;
+        d_used[PRN] = true;
+        d_buffs[PRN].clear();
+        return true;
+    }
+
+    void erase(int PRN){
+        if(count(PRN))
+            {
+                d_used[PRN] = false;
+                d_size--;
+            }
+    }
+
+private:
+    SatBuff d_buffs[max_PRN + 1];
+    bool d_used[max_PRN + 1];
+    unsigned int d_size;
 };
 
 
@@ -142,12 +212,136 @@ public:
     void New_subframe(int subframe_ID, int PRN, Gps_Navigation_Message nav, double time);
     std::map<unsigned int, Satpos> Satpos_map;
     void check_position(double lat, double lng, double alt, double sample_counter);
+
+    /*!
+     * \brief Receiver autonomous integrity monitoring of a least squares fix
+     *
+     * Raises an alarm if the post-fit pseudorange residuals are larger than
+     * the noise explains, and names the satellite whose exclusion makes them
+     * consistent again, if there is one.
+     * \param[in] prn         PRN of each observation, 0 for the non-GPS ones
+     * \param[in] n_obs       Number of observations used in the fix
+     * \param[in] ssr         Weighted sum of the squared post-fit residuals [m^2]
+     * \param[in] subset_ssr  The same for the fix without each observation, -1 if singular [m^2]
+     * \param[in] differential  True if the pseudoranges had differential corrections,
+     * which leave less noise (Spoofing.RAIM_sigma_dgps_m instead of RAIM_sigma_m)
+     */
+    void check_residuals(const std::vector<unsigned int>& prn, int n_obs, double ssr,
+            const std::vector<double>& subset_ssr, double sample_counter, bool differential = false);
+
+    /*!
+     * \brief Raises an alarm for the satellites whose carrier Doppler keeps
+     * disagreeing with the one that their ephemeris and the receiver velocity
+     * predict (Spoofing.Doppler)
+     * \param[in] prn        PRN of each observation, 0 for the non-GPS ones
+     * \param[in] residuals  Doppler residual of each observation, 0 if unused [m/s]
+     */
+    void check_doppler(const std::vector<unsigned int>& prn, const std::vector<double>& residuals, double sample_counter);
     void check_satpos(unsigned int sat, double time, double x, double y, double z); 
-    double check_SNR(std::list<unsigned int> channels, Gnss_Synchro **in, int sample_counter);
+
+    /*!
+     * \brief Satellite position checks of the ephemerides of a fix (Spoofing.satpos_detection)
+     *
+     * The positions are deterministic from the ephemeris, so each ephemeris
+     * (PRN and IODE) is validated once: at rx_time_s its satellite must be on
+     * a GPS orbit, and within Spoofing.satpos_max_jump_m of the position that
+     * the last valid ephemeris of the PRN gives, if that one is still in its
+     * fit interval. The ephemerides that changed since the last call are
+     * validated in one pass, the others are a lookup of their result, and the
+     * satellites with an invalid ephemeris raise their alarm again.
+     * \param[in] rx_time_s  GPS time of week of the fix [s]
+     * \return Number of satellites of ephemerides with an invalid position
+     */
+    int check_ephemeris_satpos(const std::map<int, Gps_Ephemeris>& ephemerides, double rx_time_s, double sample_counter);
+
+    /*!
+     * \brief Collaborative checks with another receiver of the site
+     * (Spoofing.peers), run by the thread of the peer link with the last
+     * summaries of both receivers. Raises an alarm if the CN0 of the
+     * satellites differs by the same amount at both antennas, as with a
+     * single transmitter, or if a satellite arrives earlier or later than
+     * the others at one of the receivers.
+     */
+    void check_peer(const Spoofing_Peer_Summary& local, const Spoofing_Peer_Summary& peer);
+
+    /*!
+     * \brief Inter-satellite checks of the navigation message units of all
+     * the constellations (Spoofing.NAVI_inter_satellite). Raises an alarm if
+     * the receiver time of a unit, less its TOW, is away from that of the
+     * units of the other satellites, and if a Galileo word carries other
+     * ionosphere, UTC or GGTO parameters than those of the other satellites.
+     */
+    void check_nav_unit(const Spoofing_Nav_Unit& unit);
+    double check_SNR(const Channel_List& channels, Gnss_Synchro **in, int sample_counter);
     void check_external_utc(Gps_Utc_Model time_internal, double timestamp);
     void check_external_iono(Gps_Iono internal, double timestamp);
-    bool stop_tracking(unsigned int PRN, unsigned int uid);
-    void PPE_moving_var(std::list<unsigned int> channels, Gnss_Synchro **in, int sample_counter);
+
+    /*!
+     * \brief true, once, when the APT check of the peak uid of satellite PRN
+     * is complete: all the peaks of the satellite are on the same subframe,
+     * uid is not the lowest numbered one and no alarm is active for the
+     * satellite. The decision is taken when a subframe arrives, so the
+     * telemetry decoders ask on every word for the cost of an atomic load.
+     */
+    bool APT_release(unsigned int PRN, unsigned int uid);
+
+    //! Drops the pending release of a peak that is no longer tracked
+    void forget_APT_release(unsigned int uid);
+
+    void PPE_moving_var(const Channel_List& channels, Gnss_Synchro **in, int sample_counter);
+
+    /*!
+     * \brief Raises an alarm for the satellites whose correlation peak is
+     * distorted (Spoofing.SQM), from the metrics that the tracking channels
+     * publish in the sqm_map of the receiver. The PVT runs it with the PPE checks.
+     */
+    void check_SQM(const Channel_List& channels, Gnss_Synchro **in, int sample_counter);
+
+    /*!
+     * \brief Raises an alarm when Spoofing.AoA_min_satellites satellites or
+     * more arrive from the same direction on the antenna array (Spoofing.AoA),
+     * from the metrics that the tracking channels publish in the aoa_map of the receiver.
+     * The PVT runs it with the PPE checks.
+     */
+    void check_AoA(const Channel_List& channels, Gnss_Synchro **in, int sample_counter);
+
+    /*!
+     * \brief Raises an alarm at the onset of a rise of the input power or a
+     * change of the spectrum of a signal conditioner (Spoofing.spectrum), from
+     * the metrics that its spectrum_monitor_sink publishes in the spectrum_map
+     * of the receiver. It needs no satellite, so the PVT runs it on every epoch.
+     */
+    void check_spectrum(int sample_counter);
+
+    /*!
+     * \brief Inputs of the checks. The PVT hands every output, fix and RAIM
+     * result and Doppler residuals to the detector, and the telemetry
+     * decoders every subframe and navigation message unit. The check scheduler
+     * decides which of them the checks PPE, SQM, AoA, spectrum, position, RAIM, Doppler,
+     * subframe and nav_unit take, and whether they run in the calling
+     * thread or on the worker of the detector (Spoofing.<check>_context,
+     * _min_interval_ms and _budget_us).
+     */
+    void new_epoch(const Channel_List& channels, Gnss_Synchro **in, int sample_counter);
+    void new_position(double lat, double lng, double alt, double sample_counter);
+    void new_residuals(const std::vector<unsigned int>& prn, int n_obs, double ssr,
+            const std::vector<double>& subset_ssr, double sample_counter, bool differential = false);
+    void new_doppler_residuals(const std::vector<unsigned int>& prn, const std::vector<double>& residuals, double sample_counter);
+    void new_subframe(int subframe_ID, int PRN, const Gps_Navigation_Message& nav, double time);
+    void new_nav_unit(const Spoofing_Nav_Unit& unit);
+
+    //! Waits until the checks that do not run inline have run on all their inputs
+    void flush_checks();
+
+    /*!
+     * \brief Reads again the thresholds of the checks (Spoofing.*_threshold,
+     * *_max_discrepancy, NAVI_max_alt, satpos_max_jump_m, RAIM_sigma_m, RAIM_sigma_dgps_m, RAIM_pfa, Doppler_max_mps,
+     * peers_CN0_min_spread_db, peers_max_subframe_offset_ms,
+     * NAVI_time_max_discrepancy_ms, NAVI_unit_max_age_s, the ephemeris
+     * limits, APT_ch_per_sat and alarm_min_interval_ms). Enabling or
+     * disabling a check still needs a restart.
+     */
+    void reconfigure(ConfigurationInterface* configuration);
 
     // APT 
     int get_APT();
@@ -156,68 +350,146 @@ public:
     //PPE 
     double get_PPE_sampling();
 
+    /*!
+     * \brief The PVT runs the PPE checks on one in decimation of its
+     * Spoofing.PPE_sampling epochs, 1 by default. Raised by the control
+     * thread when the receiver falls behind the signal.
+     */
+    void set_PPE_decimation(int decimation);
+    int get_PPE_decimation() const { return d_PPE_decimation.load(std::memory_order_relaxed); }
+
+    /*!
+     * \brief Recording of the inputs of the detector for the spoofing-replay
+     * utility (Spoofing.replay_filename), nullptr if there is none. The
+     * detector records its inputs; the telemetry decoders record
+     * the undecoded subframes through it.
+     */
+    Spoofing_Replay_Writer* replay_writer() const { return d_replay_writer.get(); }
+
+    // Whether the PVT computes the Doppler residuals of a receiver that does not move
+    bool get_Doppler_static() const { return d_Doppler_static; }
+
+    // Whether the PVT should also write the alarms as JSON events
+    bool get_report_json();
+
     /*!
      * \brief Default destructor.
      */
     ~Spoofing_Detector();
 
+    //! Tables of the receiver the detector checks, current at its construction
+    std::shared_ptr<Receiver_State> state() const { return d_receiver_state; }
+
 private:
+    std::shared_ptr<Receiver_State> d_receiver_state;
+
     // APT 
     bool d_APT;
     int d_APT_ch_per_sat;
     double d_APT_max_rx_discrepancy;
+    std::set<unsigned int> d_APT_releases; // peaks whose APT check is complete
+    std::atomic<unsigned int> d_APT_pending_releases{0};
+    boost::mutex d_APT_release_mutex; // guards d_APT_releases
+    void update_APT_releases(unsigned int PRN);
 
     //PPE 
     bool d_PPE;
     int d_PPE_window_size;
-    boost::circular_buffer<double> ppe_cb;
+    Rolling_Statistics ppe_cb;
 
     double  d_CN0_threshold;
     double d_RT_threshold;
     double d_Delta_threshold;
     double d_PPE_sampling;
+    std::atomic<int> d_PPE_decimation{1};
+
+    //SQM
+    bool d_SQM = false;
+    double d_SQM_ratio_threshold;
+    double d_SQM_delta_threshold;
+    double d_SQM_asymmetry_threshold;
+
+    //AoA
+    bool d_AoA = false;
+    double d_AoA_max_similarity;
+    double d_AoA_min_coherence;
+    unsigned int d_AoA_min_satellites;
+
+    //spectrum
+    bool d_spectrum = false;
+    std::map<int, unsigned int> d_spectrum_onsets; // reported, by conditioner
+
+    //RAIM
+    bool d_RAIM = false;
+    double d_RAIM_sigma_m = 5.0;
+    double d_RAIM_sigma_dgps_m = 1.0; // of the differentially corrected pseudoranges
+    double d_RAIM_pfa = 1e-5;
+    std::map<int, double> d_RAIM_thresholds; // chi-square test threshold of each number of degrees of freedom
+    boost::mutex d_raim_mutex; // guards d_RAIM_pfa and d_RAIM_thresholds
+    double raim_threshold(int dof);
+
+    //satellite positions, validated once per ephemeris
+    bool d_satpos_detection = false;
+    double d_satpos_max_jump_m = 1000.0;
+    struct Satpos_Validation
+    {
+        int IODE;                  // of the last ephemeris validated
+        bool valid;
+        bool has_reference;
+        Gps_Ephemeris reference;   // last valid ephemeris
+        Spoofing_Message alarm;    // if not valid
+    };
+    std::map<unsigned int, Satpos_Validation> d_satpos_validations; // by PRN, guarded by d_ppe_mutex
+    std::vector<const Gps_Ephemeris*> d_satpos_changed; // reused from call to call
+    bool validate_satpos(Satpos_Validation& validation, const Gps_Ephemeris& eph, double rx_time_s, double sample_counter);
+
+    //Doppler
+    bool d_Doppler = false;
+    bool d_Doppler_static = false;
+    int d_Doppler_window = 20;
+    double d_Doppler_max_mps = 5.0;
+    std::map<unsigned int, Rolling_Statistics> d_doppler_stats; // residuals of each PRN, only used by check_doppler()
+
+    //collaborative checks with the other receivers of the site
+    unsigned int d_peers_min_satellites = 4;
+    int d_peers_window = 10;
+    double d_peers_CN0_min_spread_db = 0.5;
+    double d_peers_max_subframe_offset_ms = 1.0;
+    double d_last_peer_update_ms = -1.0;
+    std::map<uint32_t, std::map<unsigned int, Rolling_Statistics> > d_peer_CN0; // CN0 differences with each peer by PRN, only used by check_peer()
 
     //NAVI configuration
     bool d_NAVI_TOW;
     double d_NAVI_TOW_max_discrepancy;
     bool d_NAVI_inter_satellite;
     bool d_NAVI_external;
+    double d_NAVI_external_rinex_tolerance = 1e-9;
     bool d_NAVI_alt;
     double d_NAVI_max_alt;
 
     bool d_NAVI_exp_eph;
 
-    //Subframe 1
-    double d_A_f0;
-    double d_A_f1;
-    double d_A_f2;
-
-    //Subframe 2
-    double d_Crs;
-    double d_Delta_n;
-    double d_M_0;
-    double d_Cuc;
-    double d_e_eccentricity;
-    double d_Cus;
-    double d_sqrt_A;
-
-    //Subframe 3
-    double d_Cic;
-    double d_OMEGA0;
-    double d_Cis;
-    double d_i_0;
-    double d_Crc;
-    double d_OMEGA;
-    double d_OMEGA_DOT;
-    double d_IDOT;
+    // last navigation message unit of each (system, PRN, uid), see check_nav_unit()
+    struct Nav_Unit_State
+    {
+        double time_ms;
+        double offset_ms; // time_ms less the TOW
+        std::map<int, std::vector<uint8_t> > common; // bits shared by all the satellites, by unit id
+    };
+    std::map<std::tuple<char, unsigned int, unsigned int>, Nav_Unit_State> d_nav_units;
+    double d_NAVI_time_max_discrepancy_ms = 50.0;
+    double d_NAVI_unit_max_age_s = 60.0;
+    boost::mutex d_nav_unit_mutex; // guards d_nav_units
+
+    std::vector<double> d_ephemeris_thresholds; // of the change of each field of gps_ephemeris_fields(), < 0 if not checked
 
     double d_fs_in;
 
-    std::map<int, boost::circular_buffer<double>> satellite_SNR;
-    double get_SNR_corr(std::list<unsigned int> channels, Gnss_Synchro **in, int sample_counter);
-    double get_corr(boost::circular_buffer<double> a, boost::circular_buffer<double> b);
+    Rolling_Correlation_Matrix satellite_SNR_corr; // CN0 of the tracked satellites, and of each pair of them
+    double get_SNR_corr(const Channel_List& channels, Gnss_Synchro **in, int sample_counter);
+    double get_corr(unsigned int a, unsigned int b);
 
-    std::map<int, SatBuff> sat_buffs;
+    Sat_Buff_Table sat_buffs;
     void calc_mean_var(int sample_counter);
     void calc_max_var(int sample_counter);
     int snr_sum = 0;
@@ -225,19 +497,37 @@ private:
     int rt_sum = 0; 
     int count = 0;
     
-    //supl
-    gnss_sdr_supl_client supl_client_;
+    // One detector is shared by the PVT and all the telemetry decoders
+    boost::mutex d_supl_mutex; // guards the pending external checks
+    boost::mutex d_ppe_mutex;  // guards Satpos_map, d_satpos_validations, sat_buffs, ppe_cb and satellite_SNR_corr
 
     void spoofing_detected(Spoofing_Message msg); 
+
+    // alarm rate limiting, per (spoofing case, satellites)
+    struct Alarm_state
+    {
+        bool reported = false;
+        std::chrono::steady_clock::time_point last_report;
+        unsigned int suppressed = 0;
+    };
+    std::map<std::pair<int, std::set<unsigned int> >, Alarm_state> d_alarm_states;
+    std::chrono::steady_clock::duration d_alarm_min_interval = std::chrono::seconds(1);
+    bool d_report_json = false;
+    boost::mutex d_alarm_mutex;
     double StdDeviation(std::vector<double> v);
-    bool compare_ephemeris(Gps_Ephemeris a, Gps_Ephemeris b);
-    bool compare_ephemeris_dTOW(Gps_Ephemeris a, Gps_Ephemeris b);
-    bool compare_utc(Gps_Utc_Model a, Gps_Utc_Model b);
-    bool compare_iono(Gps_Iono a, Gps_Iono b);
-    bool compare_subframes(Subframe subframeA, Subframe subframeB);
-    bool compare_almanac(Gps_Almanac a, Gps_Almanac b);
-    void lookup_external_nav_data(int source, int type);
-    void set_supl_client();
+    bool compare_ephemeris(const Gps_Ephemeris& a, const Gps_Ephemeris& b);
+    bool compare_utc(const Gps_Utc_Model& a, const Gps_Utc_Model& b);
+    bool compare_iono(const Gps_Iono& a, const Gps_Iono& b);
+    bool compare_subframes(const Subframe& subframeA, const Subframe& subframeB);
+    bool compare_almanac(const Gps_Almanac& a, const Gps_Almanac& b);
+    void on_external_nav_data(int type);
+    void compare_external_ephemeris(Gps_Ephemeris internal, unsigned int PRN, double timestamp);
+    void on_rinex_nav_data();
+    void compare_rinex_ephemeris(const Gps_Ephemeris& internal, unsigned int PRN, double timestamp);
+    void compare_external_almanac(Gps_Almanac internal, unsigned int PRN, double timestamp);
+    void compare_external_utc(Gps_Utc_Model internal, double timestamp);
+    void compare_external_iono(Gps_Iono internal, double timestamp);
+    void compare_external_gps_time(int internal_week, int internal_TOW, double timestamp);
     void check_new_TOW(double current_time_ms, int new_week, double new_TOW);
     void check_middle_earth(unsigned int PRN, double sqrtA, double timestamp);
     void check_GPS_time();
@@ -247,7 +537,49 @@ private:
     void check_external_almanac(std::map<int,Gps_Almanac> internal, double timestamp);
     void check_external_gps_time(int internal_week, int internal_TOW, double timestamp);
     void check_external_ephemeris(Gps_Ephemeris internal, unsigned int PRN, double timestamp);
-    void check_and_update_ephemeris(unsigned int PRN, Gps_Ephemeris eph, double time);
+    void check_and_update_ephemeris(unsigned int PRN, const Gps_Ephemeris& eph, double time);
+
+    // NAVI_external: records waiting for the external assistance data (value, timestamp)
+    std::map<unsigned int, std::pair<Gps_Ephemeris, double> > d_pending_ephemeris;
+    std::map<unsigned int, std::pair<Gps_Ephemeris, double> > d_pending_rinex_ephemeris; // until a RINEX file has their Toe
+    std::map<unsigned int, std::pair<Gps_Almanac, double> > d_pending_almanac;
+    std::vector<std::pair<Gps_Utc_Model, double> > d_pending_utc;
+    std::vector<std::pair<Gps_Iono, double> > d_pending_iono;
+    std::vector<std::pair<std::pair<int, int>, double> > d_pending_gps_time; // (week, TOW)
+
+    // check scheduler
+    int d_check_PPE = -1;
+    int d_check_SQM = -1;
+    int d_check_AoA = -1;
+    int d_check_spectrum = -1;
+    int d_check_position = -1;
+    int d_check_RAIM = -1;
+    int d_check_Doppler = -1;
+    int d_check_subframe = -1;
+    int d_check_nav_unit = -1;
+    int add_check(ConfigurationInterface* configuration, const std::string& name);
+    bool admit(int check, double time_ms);
+    bool is_inline(int check) const;
+    void dispatch(int check, const std::function<void()>& call);
+
+    std::unique_ptr<Spoofing_Replay_Writer> d_replay_writer;
+
+    // checkpoints (Spoofing.checkpoint_filename)
+    std::unique_ptr<Receiver_Checkpoint> d_checkpoint;
+    double d_checkpoint_interval_ms = 10e3;
+    double d_last_checkpoint_ms = -1.0;
+    void save_checkpoint(const Channel_List& channels, Gnss_Synchro **in, int sample_counter);
+    void restore_checkpoint(double max_age_s, double adopt_s);
+    // windows of the last run, taken up by the satellites that are tracked again before d_restored_until_ms
+    std::map<int, SatBuff> d_restored_sat_buffs;
+    std::map<int, Rolling_Statistics> d_restored_SNR;
+    double d_restored_until_ms = 0.0;
+
+    // Declared last, so that their worker threads are stopped before the rest of the detector is destroyed
+    std::unique_ptr<Supl_Assistance_Service> d_supl_service;
+    std::unique_ptr<Rinex_Nav_Source> d_rinex_source;
+    std::unique_ptr<Spoofing_Check_Scheduler> d_scheduler;
+    std::unique_ptr<Spoofing_Peer_Link> d_peer_link;
 };
 
 #endif
@@ -0,0 +1,388 @@
+/*!
+ * \file spoofing_peers.cc
+ * \brief Exchange of per-satellite summaries between the spoofing
+ * detectors of several receivers, for the collaborative checks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "spoofing_peers.h"
+#include <algorithm>
+#include <cstring>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+namespace
+{
+const unsigned int MAX_PRN = 32;
+const std::size_t MAX_DATAGRAM_BYTES = sizeof(Spoofing_Peer_Header) + MAX_PRN * sizeof(Spoofing_Peer_Satellite);
+const int STALE_PEER_PERIODS = 10;  // a peer silent for this long frees its place
+}
+
+
+Spoofing_Peer_Link::Spoofing_Peer_Link(uint32_t receiver_id, double period_ms, unsigned int max_peers) :
+        d_receiver_id(receiver_id),
+        d_max_peers(std::max(max_peers, 1u)),
+        d_sequence(0),
+        d_sent(0),
+        d_received(0),
+        d_dropped(0),
+        d_socket(d_io_service),
+        d_timer(d_io_service),
+        d_receive_buffer(MAX_DATAGRAM_BYTES + 1)
+{
+    d_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double, std::milli>(std::max(period_ms, 1.0)));
+    for (unsigned int prn = 0; prn < d_local.size(); prn++)
+        {
+            std::memset(&d_local[prn].record, 0, sizeof(Spoofing_Peer_Satellite));
+            d_local[prn].record.PRN = prn;
+            d_local[prn].record.subframe_TOW = -1;
+        }
+}
+
+
+Spoofing_Peer_Link::~Spoofing_Peer_Link()
+{
+    close();
+}
+
+
+bool Spoofing_Peer_Link::open(const std::string& address, unsigned short port, unsigned short listen_port, const Peer_Handler& handler)
+{
+    close();
+    boost::system::error_code ec;
+    boost::asio::ip::address ip = boost::asio::ip::address::from_string(address, ec);
+    if (ec)
+        {
+            LOG(WARNING) << "Invalid spoofing peers address " << address << " " << ec.message();
+            return false;
+        }
+    d_endpoint = boost::asio::ip::udp::endpoint(ip, port);
+    d_socket.open(d_endpoint.protocol(), ec);
+    if (!ec)
+        {
+            // the receivers of a site may share a host
+            d_socket.set_option(boost::asio::ip::udp::socket::reuse_address(true), ec);
+        }
+    if (!ec)
+        {
+            boost::asio::ip::address any = ip.is_v6() ? boost::asio::ip::address(boost::asio::ip::address_v6::any())
+                                                      : boost::asio::ip::address(boost::asio::ip::address_v4::any());
+            d_socket.bind(boost::asio::ip::udp::endpoint(any, listen_port), ec);
+        }
+    if (!ec && ip.is_multicast())
+        {
+            d_socket.set_option(boost::asio::ip::multicast::join_group(ip), ec);
+            if (!ec)
+                {
+                    d_socket.set_option(boost::asio::ip::multicast::hops(1), ec);
+                }
+        }
+    if (!ec)
+        {
+            d_socket.non_blocking(true, ec);
+        }
+    if (ec)
+        {
+            LOG(WARNING) << "Unable to open the spoofing peers socket to " << address << ":" << port << " " << ec.message();
+            d_socket.close(ec);
+            return false;
+        }
+
+    d_handler = handler;
+    d_peers.clear();
+    d_io_service.reset();
+    start_receive();
+    start_timer();
+    d_thread = boost::thread([this]() { d_io_service.run(); });
+    LOG(INFO) << "Spoofing peers: receiver " << d_receiver_id << " sends to " << d_endpoint
+              << " and listens on port " << listen_port;
+    return true;
+}
+
+
+void Spoofing_Peer_Link::close()
+{
+    d_io_service.stop();
+    if (d_thread.joinable())
+        {
+            d_thread.join();
+        }
+    if (d_socket.is_open())
+        {
+            LOG(INFO) << "Spoofing peers: " << sent() << " datagrams sent, " << dropped() << " dropped, "
+                      << received() << " received from " << d_peers.size() << " peers";
+            boost::system::error_code ec;
+            d_timer.cancel(ec);
+            d_socket.close(ec);
+        }
+}
+
+
+Spoofing_Peer_Link::Local_Satellite& Spoofing_Peer_Link::local_satellite(unsigned int PRN)
+{
+    Local_Satellite& satellite = d_local[PRN];
+    satellite.last_update = std::chrono::steady_clock::now();
+    satellite.seen = true;
+    return satellite;
+}
+
+
+void Spoofing_Peer_Link::update_CN0(unsigned int PRN, double CN0_dB_hz)
+{
+    if (PRN == 0 || PRN > MAX_PRN)
+        {
+            return;
+        }
+    boost::mutex::scoped_lock lock(d_mutex);
+    local_satellite(PRN).record.CN0_dB_hz = CN0_dB_hz;
+}
+
+
+void Spoofing_Peer_Link::update_doppler_residual(unsigned int PRN, double residual_mps)
+{
+    if (PRN == 0 || PRN > MAX_PRN)
+        {
+            return;
+        }
+    boost::mutex::scoped_lock lock(d_mutex);
+    local_satellite(PRN).record.doppler_residual_mps = residual_mps;
+}
+
+
+void Spoofing_Peer_Link::update_subframe(unsigned int PRN, int TOW, double time_ms)
+{
+    if (PRN == 0 || PRN > MAX_PRN)
+        {
+            return;
+        }
+    boost::mutex::scoped_lock lock(d_mutex);
+    Spoofing_Peer_Satellite& record = local_satellite(PRN).record;
+    record.subframe_TOW = TOW;
+    record.subframe_offset_ms = time_ms - TOW * 1000.0;
+}
+
+
+void Spoofing_Peer_Link::update_alarm(unsigned int PRN, int spoofing_case)
+{
+    if (PRN == 0 || PRN > MAX_PRN || spoofing_case < 0 || spoofing_case >= 16)
+        {
+            return;
+        }
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_local[PRN].record.alarm_cases |= (1 << spoofing_case);
+}
+
+
+Spoofing_Peer_Summary Spoofing_Peer_Link::local_summary() const
+{
+    Spoofing_Peer_Summary summary;
+    summary.receiver_id = d_receiver_id;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    boost::mutex::scoped_lock lock(d_mutex);
+    summary.sequence = d_sequence;
+    for (unsigned int prn = 1; prn <= MAX_PRN; prn++)
+        {
+            if (d_local[prn].seen && now - d_local[prn].last_update <= 2 * d_period)
+                {
+                    summary.satellites.push_back(d_local[prn].record);
+                }
+        }
+    return summary;
+}
+
+
+unsigned long Spoofing_Peer_Link::sent() const
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_sent;
+}
+
+
+unsigned long Spoofing_Peer_Link::received() const
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_received;
+}
+
+
+unsigned long Spoofing_Peer_Link::dropped() const
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_dropped;
+}
+
+
+std::vector<char> Spoofing_Peer_Link::encode(const Spoofing_Peer_Summary& summary)
+{
+    Spoofing_Peer_Header header;
+    std::memcpy(header.magic, "SDPR", 4);
+    header.version = SPOOFING_PEERS_VERSION;
+    header.n_satellites = std::min<std::size_t>(summary.satellites.size(), MAX_PRN);
+    header.receiver_id = summary.receiver_id;
+    header.sequence = summary.sequence;
+    std::vector<char> datagram(sizeof(header) + header.n_satellites * sizeof(Spoofing_Peer_Satellite));
+    std::memcpy(&datagram[0], &header, sizeof(header));
+    if (header.n_satellites > 0)
+        {
+            std::memcpy(&datagram[sizeof(header)], &summary.satellites[0], header.n_satellites * sizeof(Spoofing_Peer_Satellite));
+        }
+    return datagram;
+}
+
+
+bool Spoofing_Peer_Link::decode(const char* data, std::size_t size, Spoofing_Peer_Summary& summary)
+{
+    Spoofing_Peer_Header header;
+    if (size < sizeof(header))
+        {
+            return false;
+        }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, "SDPR", 4) != 0 || header.version != SPOOFING_PEERS_VERSION
+            || header.n_satellites > MAX_PRN
+            || size != sizeof(header) + header.n_satellites * sizeof(Spoofing_Peer_Satellite))
+        {
+            return false;
+        }
+    summary.receiver_id = header.receiver_id;
+    summary.sequence = header.sequence;
+    summary.satellites.resize(header.n_satellites);
+    if (header.n_satellites > 0)
+        {
+            std::memcpy(&summary.satellites[0], data + sizeof(header), header.n_satellites * sizeof(Spoofing_Peer_Satellite));
+        }
+    return true;
+}
+
+
+void Spoofing_Peer_Link::start_timer()
+{
+    d_timer.expires_from_now(boost::posix_time::microseconds(
+            std::chrono::duration_cast<std::chrono::microseconds>(d_period).count()));
+    d_timer.async_wait([this](const boost::system::error_code& ec) { on_timer(ec); });
+}
+
+
+void Spoofing_Peer_Link::on_timer(const boost::system::error_code& ec)
+{
+    if (ec == boost::asio::error::operation_aborted)
+        {
+            return;
+        }
+    Spoofing_Peer_Summary summary = local_summary();
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_sequence++;
+        // the alarms are those of the period just summarized
+        for (unsigned int prn = 1; prn <= MAX_PRN; prn++)
+            {
+                d_local[prn].record.alarm_cases = 0;
+            }
+    }
+    if (!summary.satellites.empty())
+        {
+            std::vector<char> datagram = encode(summary);
+            boost::system::error_code send_ec;
+            d_socket.send_to(boost::asio::buffer(datagram), d_endpoint, 0, send_ec);
+            boost::mutex::scoped_lock lock(d_mutex);
+            if (send_ec)
+                {
+                    // would_block or an unreachable peer: the next summary is more useful than this one
+                    if (d_dropped++ == 0)
+                        {
+                            LOG(WARNING) << "Spoofing peers datagram dropped: " << send_ec.message();
+                        }
+                }
+            else
+                {
+                    d_sent++;
+                }
+        }
+    start_timer();
+}
+
+
+void Spoofing_Peer_Link::start_receive()
+{
+    d_socket.async_receive_from(boost::asio::buffer(d_receive_buffer), d_sender,
+            [this](const boost::system::error_code& ec, std::size_t bytes) { on_receive(ec, bytes); });
+}
+
+
+void Spoofing_Peer_Link::on_receive(const boost::system::error_code& ec, std::size_t bytes)
+{
+    if (ec == boost::asio::error::operation_aborted)
+        {
+            return;
+        }
+    Spoofing_Peer_Summary peer;
+    if (!ec && decode(d_receive_buffer.data(), bytes, peer) && peer.receiver_id != d_receiver_id)
+        {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            std::map<uint32_t, std::chrono::steady_clock::time_point>::iterator it = d_peers.find(peer.receiver_id);
+            if (it == d_peers.end() && d_peers.size() >= d_max_peers)
+                {
+                    for (std::map<uint32_t, std::chrono::steady_clock::time_point>::iterator stale = d_peers.begin(); stale != d_peers.end(); )
+                        {
+                            if (now - stale->second > STALE_PEER_PERIODS * d_period)
+                                {
+                                    d_peers.erase(stale++);
+                                }
+                            else
+                                {
+                                    ++stale;
+                                }
+                        }
+                }
+            bool handle = false;
+            if (it != d_peers.end())
+                {
+                    handle = now - it->second >= d_period / 2;
+                }
+            else
+                {
+                    handle = d_peers.size() < d_max_peers;
+                }
+            if (handle)
+                {
+                    d_peers[peer.receiver_id] = now;
+                    {
+                        boost::mutex::scoped_lock lock(d_mutex);
+                        d_received++;
+                    }
+                    if (d_handler)
+                        {
+                            d_handler(local_summary(), peer);
+                        }
+                }
+        }
+    start_receive();
+}
@@ -0,0 +1,177 @@
+/*!
+ * \file spoofing_peers.h
+ * \brief Exchange of per-satellite summaries between the spoofing
+ * detectors of several receivers, for the collaborative checks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_SPOOFING_PEERS_H_
+#define GNSS_SDR_SPOOFING_PEERS_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#define SPOOFING_PEERS_VERSION 1
+
+#pragma pack(push, 1)
+/*!
+ * \brief First bytes of a peer datagram: "SDPR", the format version, the
+ * number of Spoofing_Peer_Satellite records that follow, the id of the
+ * sending receiver and a sequence number. Host byte order.
+ */
+struct Spoofing_Peer_Header
+{
+    char magic[4];
+    uint16_t version;
+    uint16_t n_satellites;
+    uint32_t receiver_id;
+    uint32_t sequence;
+};
+
+/*!
+ * \brief What a receiver saw of one satellite during the last period
+ */
+struct Spoofing_Peer_Satellite
+{
+    uint8_t PRN;
+    uint8_t reserved;
+    uint16_t alarm_cases;        //!< bit n is set if an alarm of spoofing case n named the satellite during the period
+    float CN0_dB_hz;             //!< last C/N0 of the channels of the satellite
+    float doppler_residual_mps;  //!< last carrier Doppler residual of the fix, 0 if unknown
+    int32_t subframe_TOW;        //!< TOW of the last subframe decoded, -1 if none yet [s]
+    double subframe_offset_ms;   //!< reception time of the start of that subframe minus its TOW, in the receiver time [ms]
+};
+#pragma pack(pop)
+
+static_assert(sizeof(Spoofing_Peer_Header) == 16, "the spoofing peer header layout has changed");
+static_assert(sizeof(Spoofing_Peer_Satellite) == 24, "the spoofing peer satellite layout has changed");
+
+struct Spoofing_Peer_Summary
+{
+    uint32_t receiver_id;
+    uint32_t sequence;
+    std::vector<Spoofing_Peer_Satellite> satellites; // by increasing PRN
+};
+
+
+/*!
+ * \brief Shares the view of the satellites of one receiver with the other
+ * receivers of a site, and hands their views to a collaborative check.
+ *
+ * The detector updates the local view with the CN0 of the channels, the
+ * Doppler residuals of the fixes, the subframe starts and the alarms; the
+ * updates only store a few numbers under a lock. A thread of the link
+ * sends the view once per period as a single datagram, of at most
+ * 16 + 32 * 24 bytes, to a UDP address that is usually a multicast group
+ * joined by all the receivers. The datagrams of each peer are handed to
+ * the handler on the same thread, together with the local view, at most
+ * twice per period and for at most max_peers peers, so neither the
+ * bandwidth nor the cost of the checks grows with the traffic. The socket
+ * is non-blocking: a datagram that can not be sent right away is dropped.
+ */
+class Spoofing_Peer_Link
+{
+public:
+    typedef std::function<void(const Spoofing_Peer_Summary& local, const Spoofing_Peer_Summary& peer)> Peer_Handler;
+
+    Spoofing_Peer_Link(uint32_t receiver_id, double period_ms = 1000.0, unsigned int max_peers = 8);
+    ~Spoofing_Peer_Link();
+
+    /*!
+     * \brief Listens on listen_port and sends to address:port, joining
+     * address if it is a multicast group, and starts the thread of the link
+     * \return false if the address is not valid or the socket can not be opened
+     */
+    bool open(const std::string& address, unsigned short port, unsigned short listen_port, const Peer_Handler& handler);
+    void close();
+    bool is_open() const { return d_socket.is_open(); }
+
+    void update_CN0(unsigned int PRN, double CN0_dB_hz);
+    void update_doppler_residual(unsigned int PRN, double residual_mps);
+    void update_subframe(unsigned int PRN, int TOW, double time_ms);
+    void update_alarm(unsigned int PRN, int spoofing_case);
+
+    //! The satellites seen during the last two periods
+    Spoofing_Peer_Summary local_summary() const;
+
+    uint32_t receiver_id() const { return d_receiver_id; }
+    unsigned long sent() const;
+    unsigned long received() const;
+    unsigned long dropped() const;
+
+    static std::vector<char> encode(const Spoofing_Peer_Summary& summary);
+    //! \return false if data is not a complete datagram of this version
+    static bool decode(const char* data, std::size_t size, Spoofing_Peer_Summary& summary);
+
+private:
+    struct Local_Satellite
+    {
+        Spoofing_Peer_Satellite record;
+        std::chrono::steady_clock::time_point last_update;
+        bool seen = false;
+    };
+
+    Spoofing_Peer_Link(const Spoofing_Peer_Link&);
+    Spoofing_Peer_Link& operator=(const Spoofing_Peer_Link&);
+
+    Local_Satellite& local_satellite(unsigned int PRN);
+    void start_timer();
+    void on_timer(const boost::system::error_code& ec);
+    void start_receive();
+    void on_receive(const boost::system::error_code& ec, std::size_t bytes);
+
+    uint32_t d_receiver_id;
+    std::chrono::steady_clock::duration d_period;
+    unsigned int d_max_peers;
+    std::array<Local_Satellite, 33> d_local; // by PRN
+    uint32_t d_sequence;
+    unsigned long d_sent;
+    unsigned long d_received;
+    unsigned long d_dropped;
+    std::map<uint32_t, std::chrono::steady_clock::time_point> d_peers; // last datagram handed to the handler, by receiver id
+    Peer_Handler d_handler;
+    mutable boost::mutex d_mutex; // guards d_local and the counters
+
+    boost::asio::io_service d_io_service;
+    boost::asio::ip::udp::socket d_socket;
+    boost::asio::ip::udp::endpoint d_endpoint;
+    boost::asio::ip::udp::endpoint d_sender;
+    boost::asio::deadline_timer d_timer;
+    std::vector<char> d_receive_buffer;
+    boost::thread d_thread;
+};
+
+#endif
@@ -0,0 +1,510 @@
+/*!
+ * \file spoofing_replay.cc
+ * \brief Recording of the inputs of the spoofing detector during a run,
+ * and their replay through another detector
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "spoofing_replay.h"
+#include <cstdint>
+#include <cstring>
+#include <glog/logging.h>
+#include "GPS_L1_CA.h"
+#include "concurrent_map.h"
+#include "concurrent_snapshot_map.h"
+#include "concurrent_subframe_map.h"
+#include "correlator_taps.h"
+#include "sqm_metrics.h"
+#include "aoa_metrics.h"
+#include "spoofing_detector.h"
+
+using google::LogMessage;
+
+namespace
+{
+    const char replay_magic[8] = {'S', 'D', 'R', 'E', 'P', 'L', 'A', 'Y'};
+    const uint32_t replay_version = 2; // 2: single precision Prompt_I, Prompt_Q and CN0_dB_hz in Gnss_Synchro
+
+    // flags of the channels of an epoch
+    const uint8_t epoch_has_taps = 1;
+    const uint8_t epoch_has_sqm = 2;
+    const uint8_t epoch_has_aoa = 4;
+
+    template<typename T>
+    void append(std::string& buffer, const T& value)
+    {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    // Reads the next value of the payload, false if it is too short
+    template<typename T>
+    bool take(const std::string& buffer, size_t& position, T& value)
+    {
+        if (position + sizeof(T) > buffer.size())
+            {
+                return false;
+            }
+        std::memcpy(&value, buffer.data() + position, sizeof(T));
+        position += sizeof(T);
+        return true;
+    }
+}
+
+
+Spoofing_Replay_Writer::Spoofing_Replay_Writer(const std::string& filename, double fs_in) :
+    d_fs_in(fs_in), d_time_s(0.0), d_receiver_state(Receiver_State::current())
+{
+    d_file.open(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!d_file.is_open())
+        {
+            LOG(WARNING) << "Unable to open the spoofing replay file " << filename;
+            return;
+        }
+    d_file.write(replay_magic, sizeof(replay_magic));
+    d_file.write(reinterpret_cast<const char*>(&replay_version), sizeof(replay_version));
+    d_file.write(reinterpret_cast<const char*>(&d_fs_in), sizeof(d_fs_in));
+    LOG(INFO) << "Recording the inputs of the spoofing detector to " << filename;
+}
+
+
+Spoofing_Replay_Writer::~Spoofing_Replay_Writer()
+{
+    if (d_file.is_open())
+        {
+            d_file.close();
+        }
+}
+
+
+void Spoofing_Replay_Writer::write_record(Spoofing_Replay_Record type, double time_s, const std::string& payload)
+{
+    uint8_t type_byte = static_cast<uint8_t>(type);
+    uint32_t length = static_cast<uint32_t>(payload.size());
+    boost::mutex::scoped_lock lock(d_mutex);
+    if (!d_file.is_open())
+        {
+            return;
+        }
+    if (time_s < 0.0)
+        {
+            time_s = d_time_s;
+        }
+    d_time_s = time_s;
+    d_file.write(reinterpret_cast<const char*>(&type_byte), sizeof(type_byte));
+    d_file.write(reinterpret_cast<const char*>(&time_s), sizeof(time_s));
+    d_file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    d_file.write(payload.data(), payload.size());
+}
+
+
+void Spoofing_Replay_Writer::write_epoch(const Channel_List& channels, Gnss_Synchro** in, int sample_counter)
+{
+    std::string payload;
+    append(payload, static_cast<int32_t>(sample_counter));
+    append(payload, static_cast<uint32_t>(channels.size()));
+    for (Channel_List::const_iterator it = channels.begin(); it != channels.end(); ++it)
+        {
+            const Gnss_Synchro& synchro = in[*it][0];
+            Correlator_Taps taps;
+            Sqm_Metrics sqm;
+            Aoa_Metrics aoa;
+            uint8_t flags = 0;
+            if (d_receiver_state->correlator_taps_map.read(synchro.Channel_ID, taps)) flags |= epoch_has_taps;
+            if (d_receiver_state->sqm_map.read(synchro.Channel_ID, sqm)) flags |= epoch_has_sqm;
+            if (d_receiver_state->aoa_map.read(synchro.Channel_ID, aoa)) flags |= epoch_has_aoa;
+            append(payload, static_cast<uint32_t>(*it));
+            append(payload, synchro);
+            append(payload, flags);
+            if (flags & epoch_has_taps) append(payload, taps);
+            if (flags & epoch_has_sqm) append(payload, sqm);
+            if (flags & epoch_has_aoa) append(payload, aoa);
+        }
+    write_record(SPOOFING_REPLAY_EPOCH, sample_counter / 1000.0, payload);
+}
+
+
+void Spoofing_Replay_Writer::write_subframe(const char* subframe, int PRN, int channel, unsigned int uid, unsigned int peak, double time_ms)
+{
+    std::string payload;
+    append(payload, static_cast<int32_t>(PRN));
+    append(payload, static_cast<int32_t>(channel));
+    append(payload, static_cast<uint32_t>(uid));
+    append(payload, static_cast<uint32_t>(peak));
+    append(payload, time_ms);
+    payload.append(subframe, GPS_SUBFRAME_LENGTH);
+    write_record(SPOOFING_REPLAY_SUBFRAME, time_ms / 1000.0, payload);
+}
+
+
+void Spoofing_Replay_Writer::write_position(double lat, double lng, double alt, double sample_counter)
+{
+    std::string payload;
+    append(payload, lat);
+    append(payload, lng);
+    append(payload, alt);
+    append(payload, sample_counter);
+    write_record(SPOOFING_REPLAY_POSITION, sample_counter / 1000.0, payload);
+}
+
+
+void Spoofing_Replay_Writer::write_residuals(const std::vector<unsigned int>& prn, int n_obs, double ssr,
+        const std::vector<double>& subset_ssr, double sample_counter, bool differential)
+{
+    std::string payload;
+    append(payload, static_cast<int32_t>(n_obs));
+    append(payload, ssr);
+    append(payload, sample_counter);
+    append(payload, static_cast<uint32_t>(prn.size()));
+    for (unsigned int i = 0; i < prn.size(); i++)
+        {
+            append(payload, static_cast<uint32_t>(prn[i]));
+        }
+    append(payload, static_cast<uint32_t>(subset_ssr.size()));
+    for (unsigned int i = 0; i < subset_ssr.size(); i++)
+        {
+            append(payload, subset_ssr[i]);
+        }
+    append(payload, static_cast<uint8_t>(differential));
+    write_record(SPOOFING_REPLAY_RESIDUALS, sample_counter / 1000.0, payload);
+}
+
+
+void Spoofing_Replay_Writer::write_doppler(const std::vector<unsigned int>& prn, const std::vector<double>& residuals,
+        double sample_counter)
+{
+    std::string payload;
+    append(payload, sample_counter);
+    append(payload, static_cast<uint32_t>(prn.size()));
+    for (unsigned int i = 0; i < prn.size(); i++)
+        {
+            append(payload, static_cast<uint32_t>(prn[i]));
+            append(payload, i < residuals.size() ? residuals[i] : 0.0);
+        }
+    write_record(SPOOFING_REPLAY_DOPPLER, sample_counter / 1000.0, payload);
+}
+
+
+void Spoofing_Replay_Writer::write_nav_unit(const Spoofing_Nav_Unit& unit)
+{
+    std::string payload;
+    append(payload, static_cast<int8_t>(unit.system));
+    append(payload, static_cast<uint32_t>(unit.PRN));
+    append(payload, static_cast<uint32_t>(unit.uid));
+    append(payload, static_cast<int32_t>(unit.unit_id));
+    append(payload, static_cast<int32_t>(unit.week));
+    append(payload, unit.TOW);
+    append(payload, unit.time_ms);
+    append(payload, static_cast<uint32_t>(unit.payload.size()));
+    payload.append(unit.payload.begin(), unit.payload.end());
+    write_record(SPOOFING_REPLAY_NAV_UNIT, unit.time_ms / 1000.0, payload);
+}
+
+
+void Spoofing_Replay_Writer::write_satpos(unsigned int sat, double time, double x, double y, double z)
+{
+    std::string payload;
+    append(payload, static_cast<uint32_t>(sat));
+    append(payload, time);
+    append(payload, x);
+    append(payload, y);
+    append(payload, z);
+    write_record(SPOOFING_REPLAY_SATPOS, -1.0, payload);
+}
+
+
+void Spoofing_Replay_Writer::write_release(unsigned int uid)
+{
+    std::string payload;
+    append(payload, static_cast<uint32_t>(uid));
+    write_record(SPOOFING_REPLAY_RELEASE, -1.0, payload);
+}
+
+
+Spoofing_Replay_Player::Spoofing_Replay_Player(const std::string& filename) :
+    d_open(false), d_fs_in(0.0), d_time_s(0.0), d_records(0)
+{
+    d_file.open(filename.c_str(), std::ios::in | std::ios::binary);
+    char magic[sizeof(replay_magic)];
+    uint32_t version = 0;
+    d_file.read(magic, sizeof(magic));
+    d_file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    d_file.read(reinterpret_cast<char*>(&d_fs_in), sizeof(d_fs_in));
+    if (!d_file || std::memcmp(magic, replay_magic, sizeof(magic)) != 0 || version != replay_version)
+        {
+            LOG(WARNING) << filename << " is not a spoofing replay file of version " << replay_version;
+            return;
+        }
+    d_open = true;
+}
+
+
+bool Spoofing_Replay_Player::play_next(Spoofing_Detector& detector)
+{
+    if (!d_open)
+        {
+            return false;
+        }
+    uint8_t type;
+    double time_s;
+    uint32_t length;
+    d_file.read(reinterpret_cast<char*>(&type), sizeof(type));
+    d_file.read(reinterpret_cast<char*>(&time_s), sizeof(time_s));
+    d_file.read(reinterpret_cast<char*>(&length), sizeof(length));
+    if (!d_file)
+        {
+            return false;
+        }
+    std::string payload(length, '\0');
+    d_file.read(&payload[0], length);
+    if (!d_file)
+        {
+            LOG(WARNING) << "Truncated spoofing replay record after " << d_records << " records";
+            return false;
+        }
+    d_time_s = time_s;
+    d_records++;
+
+    size_t position = 0;
+    switch (type)
+    {
+    case SPOOFING_REPLAY_EPOCH:
+        play_epoch(detector, payload);
+        break;
+    case SPOOFING_REPLAY_SUBFRAME:
+        play_subframe(detector, payload);
+        break;
+    case SPOOFING_REPLAY_POSITION:
+        {
+            double lat, lng, alt, sample_counter;
+            if (take(payload, position, lat) and take(payload, position, lng) and take(payload, position, alt)
+                    and take(payload, position, sample_counter))
+                {
+                    detector.new_position(lat, lng, alt, sample_counter);
+                }
+        }
+        break;
+    case SPOOFING_REPLAY_RESIDUALS:
+        {
+            int32_t n_obs;
+            double ssr, sample_counter;
+            uint32_t n_prn, n_subset;
+            if (!(take(payload, position, n_obs) and take(payload, position, ssr) and take(payload, position, sample_counter)
+                    and take(payload, position, n_prn)))
+                {
+                    break;
+                }
+            std::vector<unsigned int> prn(n_prn);
+            for (unsigned int i = 0; i < n_prn; i++)
+                {
+                    uint32_t p = 0;
+                    take(payload, position, p);
+                    prn[i] = p;
+                }
+            if (!take(payload, position, n_subset))
+                {
+                    break;
+                }
+            std::vector<double> subset_ssr(n_subset, -1.0);
+            for (unsigned int i = 0; i < n_subset; i++)
+                {
+                    take(payload, position, subset_ssr[i]);
+                }
+            // the recordings made before the differential fixes end here
+            uint8_t differential = 0;
+            take(payload, position, differential);
+            detector.new_residuals(prn, n_obs, ssr, subset_ssr, sample_counter, differential != 0);
+        }
+        break;
+    case SPOOFING_REPLAY_DOPPLER:
+        {
+            double sample_counter;
+            uint32_t n_prn;
+            if (!(take(payload, position, sample_counter) and take(payload, position, n_prn)))
+                {
+                    break;
+                }
+            std::vector<unsigned int> prn(n_prn, 0);
+            std::vector<double> residuals(n_prn, 0.0);
+            for (unsigned int i = 0; i < n_prn; i++)
+                {
+                    uint32_t p = 0;
+                    take(payload, position, p);
+                    take(payload, position, residuals[i]);
+                    prn[i] = p;
+                }
+            detector.new_doppler_residuals(prn, residuals, sample_counter);
+        }
+        break;
+    case SPOOFING_REPLAY_NAV_UNIT:
+        {
+            Spoofing_Nav_Unit unit;
+            int8_t system;
+            uint32_t PRN, uid, size;
+            int32_t unit_id, week;
+            if (!(take(payload, position, system) and take(payload, position, PRN) and take(payload, position, uid)
+                    and take(payload, position, unit_id) and take(payload, position, week) and take(payload, position, unit.TOW)
+                    and take(payload, position, unit.time_ms) and take(payload, position, size)
+                    and position + size <= payload.size()))
+                {
+                    break;
+                }
+            unit.system = static_cast<char>(system);
+            unit.PRN = PRN;
+            unit.uid = uid;
+            unit.unit_id = unit_id;
+            unit.week = week;
+            unit.payload.assign(payload.begin() + position, payload.begin() + position + size);
+            detector.new_nav_unit(unit);
+        }
+        break;
+    case SPOOFING_REPLAY_SATPOS:
+        {
+            uint32_t sat;
+            double time, x, y, z;
+            if (take(payload, position, sat) and take(payload, position, time) and take(payload, position, x)
+                    and take(payload, position, y) and take(payload, position, z))
+                {
+                    detector.check_satpos(sat, time, x, y, z);
+                }
+        }
+        break;
+    case SPOOFING_REPLAY_RELEASE:
+        {
+            // what the telemetry decoder removes when it drops the subframes of a channel
+            uint32_t uid;
+            if (take(payload, position, uid))
+                {
+                    detector.state()->subframe_map.remove(static_cast<int>(uid));
+                    detector.state()->subframe_check.remove(static_cast<int>(uid));
+                    detector.state()->gps_time.remove(static_cast<int>(uid));
+                }
+        }
+        break;
+    default:
+        break;
+    }
+    return true;
+}
+
+
+void Spoofing_Replay_Player::play_epoch(Spoofing_Detector& detector, const std::string& payload)
+{
+    size_t position = 0;
+    int32_t sample_counter;
+    uint32_t n_channels;
+    if (!(take(payload, position, sample_counter) and take(payload, position, n_channels)))
+        {
+            return;
+        }
+    Channel_List channels;
+    for (unsigned int n = 0; n < n_channels; n++)
+        {
+            uint32_t channel;
+            Gnss_Synchro synchro;
+            uint8_t flags;
+            if (!(take(payload, position, channel) and take(payload, position, synchro) and take(payload, position, flags)))
+                {
+                    return;
+                }
+            if (channel >= d_synchros.size())
+                {
+                    d_synchros.resize(channel + 1, Gnss_Synchro());
+                    d_synchro_ptrs.resize(channel + 1);
+                    for (unsigned int i = 0; i < d_synchros.size(); i++)
+                        {
+                            d_synchro_ptrs[i] = &d_synchros[i];
+                        }
+                }
+            d_synchros[channel] = synchro;
+            channels.push_back(channel);
+            Correlator_Taps taps;
+            Sqm_Metrics sqm;
+            Aoa_Metrics aoa;
+            if ((flags & epoch_has_taps) and take(payload, position, taps))
+                {
+                    detector.state()->correlator_taps_map.write(synchro.Channel_ID, taps);
+                }
+            if ((flags & epoch_has_sqm) and take(payload, position, sqm))
+                {
+                    detector.state()->sqm_map.write(synchro.Channel_ID, sqm);
+                }
+            if ((flags & epoch_has_aoa) and take(payload, position, aoa))
+                {
+                    detector.state()->aoa_map.write(synchro.Channel_ID, aoa);
+                }
+        }
+    if (channels.empty())
+        {
+            return;
+        }
+    detector.new_epoch(channels, d_synchro_ptrs.data(), sample_counter);
+}
+
+
+void Spoofing_Replay_Player::play_subframe(Spoofing_Detector& detector, const std::string& payload)
+{
+    size_t position = 0;
+    int32_t PRN, channel;
+    uint32_t uid, peak;
+    double time_ms;
+    char subframe[GPS_SUBFRAME_LENGTH];
+    if (!(take(payload, position, PRN) and take(payload, position, channel) and take(payload, position, uid)
+            and take(payload, position, peak) and take(payload, position, time_ms) and take(payload, position, subframe)))
+        {
+            return;
+        }
+
+    // the same steps as GpsL1CaSdSubframeFsm::decode
+    Gps_Navigation_Message& nav = d_navs[channel];
+    if (nav.i_satellite_PRN != PRN or nav.uid != uid)
+        {
+            // the channel has been reassigned
+            nav.reset();
+        }
+    int subframe_ID = nav.subframe_decoder(subframe);
+    nav.i_satellite_PRN = PRN;
+    nav.i_channel_ID = channel;
+    nav.d_subframe_timestamp_ms = time_ms;
+    if (subframe_ID < 1 or subframe_ID > 5)
+        {
+            return;
+        }
+    nav.i_peak = peak;
+    nav.uid = uid;
+    detector.new_subframe(subframe_ID, PRN, nav, time_ms);
+    if (subframe_ID == 4)
+        {
+            if (nav.flag_iono_valid == true)
+                {
+                    detector.check_external_iono(nav.get_iono(), time_ms);
+                }
+            if (nav.flag_utc_model_valid == true)
+                {
+                    detector.check_external_utc(nav.get_utc_model(), time_ms);
+                }
+        }
+}
@@ -0,0 +1,152 @@
+/*!
+ * \file spoofing_replay.h
+ * \brief Recording of the inputs of the spoofing detector during a run,
+ * and their replay through another detector
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_SPOOFING_REPLAY_H_
+#define GNSS_SDR_SPOOFING_REPLAY_H_
+
+#include <fstream>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include "epoch_arena.h"
+#include "gnss_synchro.h"
+#include "gps_navigation_message.h"
+#include "receiver_state.h"
+#include "spoofing_nav_unit.h"
+
+class Spoofing_Detector;
+
+/*!
+ * \brief Kinds of records of a replay file.
+ *
+ * The file starts with the 8 bytes "SDREPLAY", a uint32 version and the
+ * double sampling frequency of the run. Each record is a uint8 type, the
+ * double receiver time of the record [s], a uint32 payload length and the
+ * payload, in host byte order. Readers skip the records of unknown types.
+ * The sample counters of the PVT count its 1 ms outputs, so the time of
+ * an epoch or a fix is its sample counter / 1000.
+ */
+enum Spoofing_Replay_Record
+{
+    SPOOFING_REPLAY_EPOCH = 1,     //!< Arguments of new_epoch that make an epoch, with the taps, SQM and AoA metrics of the channels
+    SPOOFING_REPLAY_SUBFRAME = 2,  //!< Undecoded subframe of a channel, before the telemetry decoder decodes it
+    SPOOFING_REPLAY_POSITION = 3,  //!< Arguments of new_position
+    SPOOFING_REPLAY_RESIDUALS = 4, //!< Arguments of new_residuals
+    SPOOFING_REPLAY_SATPOS = 5,    //!< Arguments of check_satpos
+    SPOOFING_REPLAY_RELEASE = 6,   //!< The telemetry decoder dropped the subframes of a channel
+    SPOOFING_REPLAY_DOPPLER = 7,   //!< Arguments of new_doppler_residuals
+    SPOOFING_REPLAY_NAV_UNIT = 8   //!< Arguments of new_nav_unit
+};
+
+
+/*!
+ * \brief Appends the inputs of a Spoofing_Detector to a replay file.
+ *
+ * The detector records its inputs; the telemetry decoders
+ * record the subframes and their release through
+ * Spoofing_Detector::replay_writer(). Records are built outside of the
+ * lock and written in one call, so the channels only share the file.
+ */
+class Spoofing_Replay_Writer
+{
+public:
+    Spoofing_Replay_Writer(const std::string& filename, double fs_in);
+    ~Spoofing_Replay_Writer();
+
+    bool is_open() const { return d_file.is_open(); }
+
+    void write_epoch(const Channel_List& channels, Gnss_Synchro** in, int sample_counter);
+    void write_subframe(const char* subframe, int PRN, int channel, unsigned int uid, unsigned int peak, double time_ms);
+    void write_position(double lat, double lng, double alt, double sample_counter);
+    void write_residuals(const std::vector<unsigned int>& prn, int n_obs, double ssr,
+            const std::vector<double>& subset_ssr, double sample_counter, bool differential = false);
+    void write_doppler(const std::vector<unsigned int>& prn, const std::vector<double>& residuals, double sample_counter);
+    void write_nav_unit(const Spoofing_Nav_Unit& unit);
+    void write_satpos(unsigned int sat, double time, double x, double y, double z);
+    void write_release(unsigned int uid);
+
+private:
+    void write_record(Spoofing_Replay_Record type, double time_s, const std::string& payload);
+
+    double d_fs_in;
+    double d_time_s; // time of the last record, for the records without one
+    std::ofstream d_file;
+    boost::mutex d_mutex;
+    std::shared_ptr<Receiver_State> d_receiver_state; // where the epochs read the taps, SQM and AoA metrics
+};
+
+
+/*!
+ * \brief Feeds the records of a replay file to a Spoofing_Detector.
+ *
+ * Epochs restore the correlator taps, SQM and AoA metrics of the channels in
+ * the Receiver_State of the detector before calling new_epoch, as the PVT
+ * does. Subframes are decoded by one Gps_Navigation_Message per channel and
+ * passed to new_subframe and the ionosphere and UTC checks, as the telemetry
+ * decoder does. The detector keeps its state in the same tables as in the
+ * receiver, so a player is meant to run once per detector.
+ */
+class Spoofing_Replay_Player
+{
+public:
+    explicit Spoofing_Replay_Player(const std::string& filename);
+
+    bool is_open() const { return d_open; }
+    double fs_in() const { return d_fs_in; }
+
+    /*!
+     * \brief Plays the next record.
+     * \return false at the end of the file, or on a truncated record
+     */
+    bool play_next(Spoofing_Detector& detector);
+
+    //! Receiver time of the last record played [s]
+    double time_s() const { return d_time_s; }
+    unsigned long int records() const { return d_records; }
+
+private:
+    void play_epoch(Spoofing_Detector& detector, const std::string& payload);
+    void play_subframe(Spoofing_Detector& detector, const std::string& payload);
+
+    std::ifstream d_file;
+    bool d_open;
+    double d_fs_in;
+    double d_time_s;
+    unsigned long int d_records;
+    std::vector<Gnss_Synchro> d_synchros;
+    std::vector<Gnss_Synchro*> d_synchro_ptrs;
+    std::map<int, Gps_Navigation_Message> d_navs; // by channel
+};
+
+#endif
@@ -0,0 +1,224 @@
+/*!
+ * \file spoofing_report_writer.cc
+ * \brief Implementation of the thread that writes the spoofing alarms to the
+ * spoofing report and event files
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "spoofing_report_writer.h"
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <boost/bind.hpp>
+#include <glog/logging.h>
+#include "concurrent_ring_queue.h"
+
+Spoofing_Report_Writer::Spoofing_Report_Writer(const std::string& report_filename, const std::string& events_filename) :
+        d_dropped(0),
+        d_stop(false),
+        d_receiver_state(Receiver_State::current())
+{
+    if (!report_filename.empty())
+        {
+            d_report_file.open(report_filename.c_str(), std::ios::out);
+            if (!d_report_file.is_open())
+                {
+                    LOG(WARNING) << "Unable to open spoofing report file " << report_filename;
+                }
+        }
+    if (!events_filename.empty())
+        {
+            d_events_file.open(events_filename.c_str(), std::ios::out);
+            if (!d_events_file.is_open())
+                {
+                    LOG(WARNING) << "Unable to open spoofing events file " << events_filename;
+                }
+            else
+                {
+                    LOG(INFO) << "Spoofing events enabled, file: " << events_filename;
+                }
+        }
+    d_thread = boost::thread(boost::bind(&Spoofing_Report_Writer::run, this));
+}
+
+
+Spoofing_Report_Writer::~Spoofing_Report_Writer()
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_stop = true;
+    }
+    d_thread.join();
+    d_report_file.close();
+    d_events_file.close();
+}
+
+
+void Spoofing_Report_Writer::set_alarm_handler(const std::function<void(const Spoofing_Message&)>& handler)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_alarm_handler = handler;
+}
+
+
+void Spoofing_Report_Writer::run()
+{
+    std::vector<Spoofing_Message> batch;
+    while (true)
+        {
+            bool stop;
+            {
+                boost::mutex::scoped_lock lock(d_mutex);
+                stop = d_stop;
+            }
+            batch.clear();
+            if (stop)
+                {
+                    // last pass, do not wait
+                    d_receiver_state->spoofing_queue.pop_all(batch);
+                }
+            else
+                {
+                    d_receiver_state->spoofing_queue.wait_and_pop_all(batch, boost::posix_time::milliseconds(100));
+                }
+            if (!batch.empty())
+                {
+                    write_batch(batch);
+                }
+            unsigned long dropped = d_receiver_state->spoofing_queue.dropped();
+            if (dropped != d_dropped)
+                {
+                    LOG(WARNING) << "Spoofing alarm queue full, " << dropped - d_dropped << " alarms dropped";
+                    d_dropped = dropped;
+                }
+            if (stop)
+                {
+                    return;
+                }
+        }
+}
+
+
+void Spoofing_Report_Writer::write_batch(const std::vector<Spoofing_Message>& batch)
+{
+    std::function<void(const Spoofing_Message&)> alarm_handler;
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        alarm_handler = d_alarm_handler;
+    }
+    std::stringstream console;
+    for (std::vector<Spoofing_Message>::const_iterator it = batch.begin(); it != batch.end(); ++it)
+        {
+            console << banner(*it);
+            DLOG(INFO) << "SPOOFING DETECTED " << it->description;
+            if (d_report_file.is_open())
+                {
+                    d_report_file << it->spoofing_report;
+                    if (it->suppressed > 0)
+                        {
+                            d_report_file << "(" << it->suppressed << " similar alarms were suppressed since the previous one)\n";
+                        }
+                }
+            if (d_events_file.is_open())
+                {
+                    d_events_file << json_event(*it) << "\n";
+                }
+            if (alarm_handler)
+                {
+                    alarm_handler(*it);
+                }
+        }
+    std::cout << console.str();
+    if (d_report_file.is_open())
+        {
+            d_report_file.flush();
+        }
+    if (d_events_file.is_open())
+        {
+            d_events_file.flush();
+        }
+    if (d_report_file.fail() || d_events_file.fail())
+        {
+            LOG(WARNING) << "Exception writing to spoofing report";
+            d_report_file.clear();
+            d_events_file.clear();
+        }
+}
+
+
+std::string Spoofing_Report_Writer::banner(const Spoofing_Message& msg)
+{
+    int width = 80;
+    std::string sp = "SPOOFING DETECTED";
+    std::stringstream s;
+    s << '+' << std::setw(width-3) << std::setfill('-') << "+\n";
+    s << std::setw( (width+sp.length())/2 ) << std::setfill(' ') << sp << std::setw( (width-sp.length())/2 ) << std::setfill(' ') << "\n\n";
+    s << std::setw(2) << std::setfill(' ') << msg.description << "\n";
+    if (msg.suppressed > 0)
+        {
+            s << "  (" << msg.suppressed << " similar alarms suppressed)\n";
+        }
+    s << '+' << std::setw(width-2) << std::setfill('-') << "+\n\n";
+    return s.str();
+}
+
+
+std::string Spoofing_Report_Writer::json_event(const Spoofing_Message& msg)
+{
+    std::stringstream s;
+    s << "{\"case\": " << msg.spoofing_case << ", \"satellites\": [";
+    for (std::set<unsigned int>::const_iterator it = msg.satellites.begin(); it != msg.satellites.end(); ++it)
+        {
+            if (it != msg.satellites.begin())
+                {
+                    s << ", ";
+                }
+            s << *it;
+        }
+    s << "], \"suppressed\": " << msg.suppressed << ", \"description\": \"";
+    for (std::string::const_iterator c = msg.description.begin(); c != msg.description.end(); ++c)
+        {
+            switch (*c)
+            {
+            case '"':  s << "\\\""; break;
+            case '\\': s << "\\\\"; break;
+            case '\n': s << "\\n"; break;
+            case '\t': s << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(*c) < 0x20)
+                    {
+                        s << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(*c) << std::dec;
+                    }
+                else
+                    {
+                        s << *c;
+                    }
+            }
+        }
+    s << "\"}";
+    return s.str();
+}
@@ -0,0 +1,89 @@
+/*!
+ * \file spoofing_report_writer.h
+ * \brief Interface of the thread that writes the spoofing alarms to the
+ * spoofing report and event files
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_SPOOFING_REPORT_WRITER_H_
+#define GNSS_SDR_SPOOFING_REPORT_WRITER_H_
+
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include "receiver_state.h"
+#include "spoofing_message.h"
+
+/*!
+ * \brief Drains the spoofing_queue of the Receiver_State current at its
+ * construction, in its own thread.
+ *
+ * The alarms are taken from the queue in batches. For each one the
+ * console banner is printed and the report text is appended to the
+ * spoofing report file; optionally, one JSON object per line is also
+ * written to an event file. Files are flushed once per batch, so the
+ * detection threads never wait for the console or the disk.
+ */
+class Spoofing_Report_Writer
+{
+public:
+    /*!
+     * \brief Starts the writer. An empty file name disables that output.
+     */
+    Spoofing_Report_Writer(const std::string& report_filename, const std::string& events_filename);
+
+    /*!
+     * \brief Writes the alarms still queued and stops the thread.
+     */
+    ~Spoofing_Report_Writer();
+
+    /*!
+     * \brief Also passes every alarm to handler, from the writer thread. An empty handler removes it.
+     */
+    void set_alarm_handler(const std::function<void(const Spoofing_Message&)>& handler);
+
+private:
+    void run();
+    void write_batch(const std::vector<Spoofing_Message>& batch);
+    static std::string banner(const Spoofing_Message& msg);
+    static std::string json_event(const Spoofing_Message& msg);
+
+    std::ofstream d_report_file;
+    std::ofstream d_events_file;
+    unsigned long d_dropped;
+    bool d_stop;
+    std::shared_ptr<Receiver_State> d_receiver_state;
+    std::function<void(const Spoofing_Message&)> d_alarm_handler;
+    boost::mutex d_mutex;
+    boost::thread d_thread;
+};
+
+#endif
@@ -0,0 +1,117 @@
+/*!
+ * \file sqm_monitor.cc
+ * \brief Implementation of the signal quality monitoring accumulator of a
+ * tracking channel
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "sqm_monitor.h"
+#include <algorithm>
+#include <cmath>
+
+Sqm_Monitor::Sqm_Monitor(const std::vector<float>& spacings_chips, int decimation, unsigned int window)
+{
+    d_metrics = Sqm_Metrics();
+    d_metrics.n_pairs = std::min<unsigned int>(spacings_chips.size(), SQM_MAX_PAIRS);
+    for (unsigned int i = 0; i < d_metrics.n_pairs; i++)
+        {
+            d_metrics.spacing_chips[i] = spacings_chips[i];
+        }
+    d_decimation = std::max(decimation, 1);
+    d_tap_sums.resize(n_taps());
+    d_ratio_stats.assign(d_metrics.n_pairs, Rolling_Statistics(std::max(window, 1u)));
+    d_delta_stats.assign(d_metrics.n_pairs, Rolling_Statistics(std::max(window, 1u)));
+    reset(0);
+}
+
+
+void Sqm_Monitor::shifts(float* shifts_chips) const
+{
+    for (unsigned int i = 0; i < d_metrics.n_pairs; i++)
+        {
+            shifts_chips[2 * i] = - d_metrics.spacing_chips[i];
+            shifts_chips[2 * i + 1] = d_metrics.spacing_chips[i];
+        }
+}
+
+
+void Sqm_Monitor::reset(unsigned int PRN)
+{
+    d_metrics.PRN = PRN;
+    d_metrics.sample_counter = 0;
+    for (unsigned int i = 0; i < d_metrics.n_pairs; i++)
+        {
+            d_metrics.ratio[i] = 0.0;
+            d_metrics.delta[i] = 0.0;
+            d_metrics.asymmetry[i] = 0.0;
+            d_metrics.ratio_var[i] = 0.0;
+            d_metrics.delta_var[i] = 0.0;
+            d_ratio_stats[i].clear();
+            d_delta_stats[i].clear();
+        }
+    d_periods = 0;
+    d_prompt_sum = gr_complex(0.0, 0.0);
+    std::fill(d_tap_sums.begin(), d_tap_sums.end(), gr_complex(0.0, 0.0));
+}
+
+
+bool Sqm_Monitor::add(const gr_complex& prompt, const gr_complex* taps, unsigned long int sample_counter)
+{
+    // wipe off the data bit, so that the periods of different bits add up
+    float bit = prompt.real() < 0.0 ? -1.0 : 1.0;
+    d_prompt_sum += bit * prompt;
+    for (unsigned int n = 0; n < d_tap_sums.size(); n++)
+        {
+            d_tap_sums[n] += bit * taps[n];
+        }
+    if (++d_periods < d_decimation)
+        {
+            return false;
+        }
+
+    float two_prompt = 2.0 * d_prompt_sum.real();
+    for (unsigned int i = 0; i < d_metrics.n_pairs; i++)
+        {
+            const gr_complex& early = d_tap_sums[2 * i];
+            const gr_complex& late = d_tap_sums[2 * i + 1];
+            float abs_early = std::abs(early);
+            float abs_late = std::abs(late);
+            d_metrics.ratio[i] = two_prompt != 0.0 ? (early.real() + late.real()) / two_prompt : 0.0;
+            d_metrics.delta[i] = two_prompt != 0.0 ? (early.real() - late.real()) / two_prompt : 0.0;
+            d_metrics.asymmetry[i] = abs_early + abs_late > 0.0 ? (abs_early - abs_late) / (abs_early + abs_late) : 0.0;
+            d_ratio_stats[i].push_back(d_metrics.ratio[i]);
+            d_delta_stats[i].push_back(d_metrics.delta[i]);
+            d_metrics.ratio_var[i] = d_ratio_stats[i].var();
+            d_metrics.delta_var[i] = d_delta_stats[i].var();
+        }
+    d_metrics.sample_counter = sample_counter;
+
+    d_periods = 0;
+    d_prompt_sum = gr_complex(0.0, 0.0);
+    std::fill(d_tap_sums.begin(), d_tap_sums.end(), gr_complex(0.0, 0.0));
+    return true;
+}
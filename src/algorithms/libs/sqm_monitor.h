@@ -0,0 +1,89 @@
+/*!
+ * \file sqm_monitor.h
+ * \brief Interface of the signal quality monitoring accumulator of a
+ * tracking channel
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_SQM_MONITOR_H_
+#define GNSS_SDR_SQM_MONITOR_H_
+
+#include <vector>
+#include <gnuradio/gr_complex.h>
+#include "rolling_statistics.h"
+#include "sqm_metrics.h"
+
+/*!
+ * \brief Turns the extra correlator taps of a channel into Sqm_Metrics.
+ *
+ * The tracking block appends the taps of shifts() to its Early, Prompt and
+ * Late taps, so they come out of the same multicorrelator call, and passes
+ * them to add() once per code period. Each period only adds the taps,
+ * with the data bit wiped off by the sign of the prompt, to running sums.
+ * The metrics are computed from the sums once every decimation periods,
+ * which should divide the 20 periods of a bit, and their variances are
+ * kept over the last window of them with Rolling_Statistics.
+ */
+class Sqm_Monitor
+{
+public:
+    /*!
+     * \param spacings_chips - offset from Prompt of each pair of taps, at most SQM_MAX_PAIRS of them [chips]
+     * \param decimation - code periods averaged in each metrics
+     * \param window - metrics the variances are computed over
+     */
+    Sqm_Monitor(const std::vector<float>& spacings_chips = std::vector<float>(), int decimation = 20, unsigned int window = 50);
+
+    bool enabled() const { return d_metrics.n_pairs > 0; }
+    unsigned int n_taps() const { return 2 * d_metrics.n_pairs; }
+
+    //! Code shifts of the extra taps [chips]: -d and +d for each spacing d
+    void shifts(float* shifts_chips) const;
+
+    //! Starts over, for a new satellite
+    void reset(unsigned int PRN);
+
+    /*!
+     * \brief Adds the taps of one code period. taps holds the n_taps()
+     * outputs of the shifts() taps, in the same order.
+     * \return true when the metrics have been updated
+     */
+    bool add(const gr_complex& prompt, const gr_complex* taps, unsigned long int sample_counter);
+
+    const Sqm_Metrics& metrics() const { return d_metrics; }
+
+private:
+    Sqm_Metrics d_metrics;
+    int d_decimation;
+    int d_periods;
+    gr_complex d_prompt_sum;
+    std::vector<gr_complex> d_tap_sums;
+    std::vector<Rolling_Statistics> d_ratio_stats;
+    std::vector<Rolling_Statistics> d_delta_stats;
+};
+
+#endif
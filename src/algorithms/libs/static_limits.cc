@@ -0,0 +1,201 @@
+/*!
+ * \file static_limits.cc
+ * \brief Compile-time limits of the receiver (ENABLE_STATIC_LIMITS)
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "static_limits.h"
+#include <cmath>
+#include <boost/lexical_cast.hpp>
+#include <glog/logging.h>
+#include "configuration_interface.h"
+
+using google::LogMessage;
+
+namespace
+{
+struct Signal_Limits
+{
+    const char* name;
+    double code_period_ms; // of the primary code, sampled by the acquisition per coherent_integration_time_ms
+    bool supported;
+};
+
+const Signal_Limits signals[] =
+{
+#if defined(GNSS_SDR_STATIC_LIMITS)
+#if defined(GNSS_SDR_SIGNAL_1C)
+    { "1C", 1.0, true },
+#else
+    { "1C", 1.0, false },
+#endif
+#if defined(GNSS_SDR_SIGNAL_2S)
+    { "2S", 20.0, true },
+#else
+    { "2S", 20.0, false },
+#endif
+#if defined(GNSS_SDR_SIGNAL_1B)
+    { "1B", 4.0, true },
+#else
+    { "1B", 4.0, false },
+#endif
+#if defined(GNSS_SDR_SIGNAL_5X)
+    { "5X", 1.0, true },
+#else
+    { "5X", 1.0, false },
+#endif
+#else
+    { "1C", 1.0, true },
+    { "2S", 20.0, true },
+    { "1B", 4.0, true },
+    { "5X", 1.0, true },
+#endif
+};
+
+const unsigned int num_signals = sizeof(signals) / sizeof(signals[0]);
+}
+
+
+bool Static_Limits::enabled()
+{
+#if defined(GNSS_SDR_STATIC_LIMITS)
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+unsigned int Static_Limits::max_channels()
+{
+#if defined(GNSS_SDR_STATIC_LIMITS)
+    return GNSS_SDR_MAX_CHANNELS;
+#else
+    return 0;
+#endif
+}
+
+
+unsigned int Static_Limits::max_fft_size()
+{
+#if defined(GNSS_SDR_STATIC_LIMITS)
+    return GNSS_SDR_MAX_FFT_SIZE;
+#else
+    return 0;
+#endif
+}
+
+
+unsigned int Static_Limits::max_taps()
+{
+#if defined(GNSS_SDR_STATIC_LIMITS)
+    return GNSS_SDR_MAX_TAPS;
+#else
+    return 0;
+#endif
+}
+
+
+size_t Static_Limits::arena_bytes()
+{
+#if defined(GNSS_SDR_STATIC_LIMITS)
+    return static_cast<size_t>(GNSS_SDR_ARENA_MB) * 1024 * 1024;
+#else
+    return 0;
+#endif
+}
+
+
+bool Static_Limits::supports_signal(const std::string& signal)
+{
+    for (unsigned int i = 0; i < num_signals; i++)
+        {
+            if (signal == signals[i].name)
+                {
+                    return signals[i].supported;
+                }
+        }
+    return false;
+}
+
+
+bool Static_Limits::check(ConfigurationInterface* configuration)
+{
+    if (!enabled())
+        {
+            return true;
+        }
+    bool fits = true;
+    unsigned int total_channels = 0;
+    long fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
+    for (unsigned int i = 0; i < num_signals; i++)
+        {
+            std::string signal = signals[i].name;
+            unsigned int count = configuration->property("Channels_" + signal + ".count", 0);
+            if (count == 0)
+                {
+                    continue;
+                }
+            total_channels += count;
+            if (!signals[i].supported)
+                {
+                    LOG(ERROR) << "Channels_" << signal << ".count=" << count << ", but this build does not support the " << signal << " signal";
+                    fits = false;
+                    continue;
+                }
+            // as the acquisition adapters size their FFTs
+            unsigned int sampled_ms = configuration->property("Acquisition_" + signal + ".coherent_integration_time_ms", 1);
+            bool bit_transition = configuration->property("Acquisition_" + signal + ".bit_transition_flag", false);
+            double fft_size = std::round(fs_in * signals[i].code_period_ms / 1000.0) * sampled_ms * (bit_transition ? 2 : 1);
+            if (fft_size > max_fft_size())
+                {
+                    LOG(ERROR) << "The acquisition of the " << signal << " channels needs FFTs of " << fft_size
+                               << " samples, this build is limited to " << max_fft_size();
+                    fits = false;
+                }
+        }
+    if (total_channels > max_channels())
+        {
+            LOG(ERROR) << total_channels << " channels configured, this build is limited to " << max_channels();
+            fits = false;
+        }
+
+    // the input filter of each signal conditioner, "InputFilter" or "InputFilter<source>", as GNSSBlockFactory names them
+    unsigned int sources = configuration->property("Receiver.sources_count", 1);
+    for (unsigned int i = 0; i <= sources; i++)
+        {
+            std::string role = (i == 0) ? std::string("InputFilter") : "InputFilter" + boost::lexical_cast<std::string>(i - 1);
+            int taps = configuration->property(role + ".number_of_taps", 0);
+            if (taps > static_cast<int>(max_taps()))
+                {
+                    LOG(ERROR) << role << ".number_of_taps=" << taps << ", this build is limited to " << max_taps();
+                    fits = false;
+                }
+        }
+    return fits;
+}
@@ -0,0 +1,78 @@
+/*!
+ * \file static_limits.h
+ * \brief Compile-time limits of the receiver (ENABLE_STATIC_LIMITS)
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_STATIC_LIMITS_H_
+#define GNSS_SDR_STATIC_LIMITS_H_
+
+#include <cstddef>
+#include <string>
+
+class ConfigurationInterface;
+
+/*!
+ * \brief Limits fixed at compile time by a build with
+ * ENABLE_STATIC_LIMITS=ON (GNSS_SDR_STATIC_LIMITS), for the embedded
+ * units that need a predictable memory use.
+ *
+ * Such a build supports at most GNSS_SDR_MAX_CHANNELS channels of the
+ * signals GNSS_SDR_SIGNAL_<signal>, acquisition FFTs of up to
+ * GNSS_SDR_MAX_FFT_SIZE samples and input filters of up to
+ * GNSS_SDR_MAX_TAPS taps. GNSSFlowgraph refuses a configuration beyond
+ * them before building any block, and Buffer_Allocator takes the signal
+ * buffers from an arena of GNSS_SDR_ARENA_MB reserved at startup, which
+ * never grows.
+ *
+ * In the other builds there are no limits, and check() accepts any
+ * configuration.
+ */
+class Static_Limits
+{
+public:
+    static bool enabled(); //!< True in a build with ENABLE_STATIC_LIMITS=ON
+
+    static unsigned int max_channels(); //!< 0 if not limited
+    static unsigned int max_fft_size(); //!< 0 if not limited
+    static unsigned int max_taps();     //!< 0 if not limited
+    static size_t arena_bytes();        //!< Bytes of the Buffer_Allocator arena, 0 without one
+
+    /*!
+     * \brief True if the build supports the channels of signal ("1C", "2S", "1B" or "5X")
+     */
+    static bool supports_signal(const std::string& signal);
+
+    /*!
+     * \brief True if the configuration fits the limits, logs every limit
+     * it goes beyond
+     */
+    static bool check(ConfigurationInterface* configuration);
+};
+
+#endif
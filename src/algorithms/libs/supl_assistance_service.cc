@@ -0,0 +1,323 @@
+/*!
+ * \file supl_assistance_service.cc
+ * \brief Implementation of a background SUPL assistance fetcher with a
+ * time-to-live cache, used by the spoofing detector NAVI_external checks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "supl_assistance_service.h"
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <glog/logging.h>
+
+
+Supl_Assistance_Service::Supl_Assistance_Service(const std::vector<std::string>& servers, int port,
+        int mcc, int mns, int lac, int ci,
+        double ttl_s, double retry_s, Callback on_update,
+        const std::string& snapshot_file, bool export_xml) :
+        d_servers(servers),
+        d_next_server(0),
+        d_port(port),
+        d_mcc(mcc),
+        d_mns(mns),
+        d_lac(lac),
+        d_ci(ci),
+        d_ttl(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(ttl_s))),
+        d_retry(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(retry_s))),
+        d_on_update(on_update),
+        d_snapshot_file(snapshot_file),
+        d_export_xml(export_xml),
+        d_stop(false)
+{
+    d_thread = boost::thread(boost::bind(&Supl_Assistance_Service::run, this));
+}
+
+
+Supl_Assistance_Service::~Supl_Assistance_Service()
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_stop = true;
+    }
+    d_cond.notify_all();
+    d_thread.join();
+}
+
+
+bool Supl_Assistance_Service::fresh(const Clock::time_point& t) const
+{
+    return Clock::now() - t < d_ttl;
+}
+
+
+bool Supl_Assistance_Service::request(int type)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::map<int, Clock::time_point>::const_iterator fetched = d_fetch_time.find(type);
+    if (fetched != d_fetch_time.end() && fresh(fetched->second))
+        {
+            return true;
+        }
+    if (d_pending.count(type))
+        {
+            return false;
+        }
+    std::map<int, Clock::time_point>::const_iterator attempt = d_attempt_time.find(type);
+    if (attempt != d_attempt_time.end() && Clock::now() - attempt->second < d_retry)
+        {
+            // the last attempt failed recently, do not hammer the servers
+            return false;
+        }
+    d_pending.insert(type);
+    lock.unlock();
+    d_cond.notify_one();
+    return false;
+}
+
+
+bool Supl_Assistance_Service::get_ephemeris(unsigned int PRN, Gps_Ephemeris& ephemeris) const
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::map<int, Gps_Ephemeris>::const_iterator it = d_ephemeris.find(PRN);
+    if (it == d_ephemeris.end() || !fresh(d_ephemeris_time.at(PRN)))
+        {
+            return false;
+        }
+    ephemeris = it->second;
+    return true;
+}
+
+
+bool Supl_Assistance_Service::get_almanac(unsigned int PRN, Gps_Almanac& almanac) const
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::map<int, Gps_Almanac>::const_iterator it = d_almanac.find(PRN);
+    if (it == d_almanac.end() || !fresh(d_almanac_time.at(PRN)))
+        {
+            return false;
+        }
+    almanac = it->second;
+    return true;
+}
+
+
+bool Supl_Assistance_Service::get_utc(Gps_Utc_Model& utc) const
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::map<int, Clock::time_point>::const_iterator fetched = d_fetch_time.find(ALMANAC_UTC_IONO);
+    if (fetched == d_fetch_time.end() || !fresh(fetched->second))
+        {
+            return false;
+        }
+    utc = d_utc;
+    return true;
+}
+
+
+bool Supl_Assistance_Service::get_iono(Gps_Iono& iono) const
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::map<int, Clock::time_point>::const_iterator fetched = d_fetch_time.find(ALMANAC_UTC_IONO);
+    if (fetched == d_fetch_time.end() || !fresh(fetched->second))
+        {
+            return false;
+        }
+    iono = d_iono;
+    return true;
+}
+
+
+bool Supl_Assistance_Service::get_ref_time(Gps_Ref_Time& ref_time) const
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::map<int, Clock::time_point>::const_iterator fetched = d_fetch_time.find(ALMANAC_UTC_IONO);
+    if (fetched == d_fetch_time.end() || !fresh(fetched->second))
+        {
+            return false;
+        }
+    ref_time = d_ref_time;
+    return true;
+}
+
+
+void Supl_Assistance_Service::load_snapshot()
+{
+    double age_s = 0.0;
+    if (d_snapshot_file.empty() || !d_client.load_assistance_snapshot(d_snapshot_file, &age_s))
+        {
+            return;
+        }
+    // as old as when it was saved
+    Clock::time_point saved = Clock::now() - std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(std::max(age_s, 0.0)));
+    boost::mutex::scoped_lock lock(d_mutex);
+    for (std::map<int, Gps_Ephemeris>::const_iterator it = d_client.gps_ephemeris_map.begin(); it != d_client.gps_ephemeris_map.end(); ++it)
+        {
+            d_ephemeris[it->first] = it->second;
+            d_ephemeris_time[it->first] = saved;
+        }
+    if (!d_client.gps_ephemeris_map.empty())
+        {
+            d_fetch_time[EPHEMERIS] = saved;
+        }
+    if (d_client.gps_utc.valid)
+        {
+            d_utc = d_client.gps_utc;
+            d_iono = d_client.gps_iono;
+            d_ref_time = d_client.gps_time;
+            d_fetch_time[ALMANAC_UTC_IONO] = saved;
+        }
+    LOG(INFO) << "SUPL: assistance snapshot " << d_snapshot_file << " of " << age_s << " s ago";
+}
+
+
+void Supl_Assistance_Service::run()
+{
+    // before any fetch, the data of the last run
+    load_snapshot();
+    while (true)
+        {
+            int type;
+            {
+                boost::mutex::scoped_lock lock(d_mutex);
+                while (!d_stop && d_pending.empty())
+                    {
+                        d_cond.wait(lock);
+                    }
+                if (d_stop)
+                    {
+                        return;
+                    }
+                type = *d_pending.begin();
+                d_attempt_time[type] = Clock::now();
+            }
+
+            // the network round trip runs without holding the cache lock
+            bool ok = fetch(type);
+
+            {
+                boost::mutex::scoped_lock lock(d_mutex);
+                d_pending.erase(type);
+            }
+            if (ok && d_on_update)
+                {
+                    d_on_update(type);
+                }
+        }
+}
+
+
+bool Supl_Assistance_Service::fetch(int type)
+{
+    for (unsigned int n = 0; n < d_servers.size(); n++)
+        {
+            unsigned int i = (d_next_server + n) % d_servers.size();
+            d_client.server_name = d_servers.at(i);
+            d_client.server_port = d_port;
+            d_client.request = type;
+            int error = d_client.get_assistance(d_mcc, d_mns, d_lac, d_ci);
+            if (error != 0)
+                {
+                    LOG(WARNING) << "SUPL: server " << d_servers.at(i) << ":" << d_port << " returned " << error;
+                    continue;
+                }
+            d_next_server = i; // start with the server that answered next time
+
+            Clock::time_point now = Clock::now();
+            boost::mutex::scoped_lock lock(d_mutex);
+            if (type == EPHEMERIS)
+                {
+                    for (std::map<int, Gps_Ephemeris>::const_iterator it = d_client.gps_ephemeris_map.begin(); it != d_client.gps_ephemeris_map.end(); ++it)
+                        {
+                            d_ephemeris[it->first] = it->second;
+                            d_ephemeris_time[it->first] = now;
+                        }
+                }
+            else
+                {
+                    for (std::map<int, Gps_Almanac>::const_iterator it = d_client.gps_almanac_map.begin(); it != d_client.gps_almanac_map.end(); ++it)
+                        {
+                            d_almanac[it->first] = it->second;
+                            d_almanac_time[it->first] = now;
+                        }
+                    d_utc = d_client.gps_utc;
+                    d_iono = d_client.gps_iono;
+                    d_ref_time = d_client.gps_time;
+                }
+            d_fetch_time[type] = now;
+            lock.unlock();
+            LOG(INFO) << "SUPL: assistance data of type " << type << " received from " << d_servers.at(i);
+            if (!d_snapshot_file.empty() && !d_client.save_assistance_snapshot(d_snapshot_file))
+                {
+                    LOG(INFO) << "SUPL: Failed to save the assistance snapshot " << d_snapshot_file;
+                }
+            if (d_export_xml)
+                {
+                    save_xml(type);
+                }
+            return true;
+        }
+    LOG(WARNING) << "SUPL: no assistance server answered. Please check internet connection and SUPL server configuration";
+    return false;
+}
+
+
+void Supl_Assistance_Service::save_xml(int type)
+{
+    if (type == EPHEMERIS)
+        {
+            std::string eph_xml_filename = "../data/ephemeris.xml";
+            if (!d_client.save_ephemeris_map_xml(eph_xml_filename, d_client.gps_ephemeris_map))
+                {
+                    LOG(INFO) << "SUPL: Failed to create XML Ephemeris file";
+                }
+            return;
+        }
+
+    std::string utc_xml_filename = "../data/utc.xml";
+    std::map<int, Gps_Utc_Model> utc_map;
+    utc_map[0] = d_client.gps_utc;
+    if (!d_client.save_utc_map_xml(utc_xml_filename, utc_map))
+        {
+            LOG(INFO) << "SUPL: Failed to create XML Utc model file";
+        }
+
+    std::string iono_xml_filename = "../data/iono.xml";
+    std::map<int, Gps_Iono> iono_map;
+    iono_map[0] = d_client.gps_iono;
+    if (!d_client.save_iono_map_xml(iono_xml_filename, iono_map))
+        {
+            LOG(INFO) << "SUPL: Failed to create XML iono model file";
+        }
+
+    std::string ref_time_xml_filename = "../data/ref_time.xml";
+    std::map<int, Gps_Ref_Time> ref_time_map;
+    ref_time_map[0] = d_client.gps_time;
+    if (!d_client.save_ref_time_map_xml(ref_time_xml_filename, ref_time_map))
+        {
+            LOG(INFO) << "SUPL: Error while trying to save ref time XML file";
+        }
+}
@@ -0,0 +1,145 @@
+/*!
+ * \file supl_assistance_service.h
+ * \brief Interface of a background SUPL assistance fetcher with a
+ * time-to-live cache, used by the spoofing detector NAVI_external checks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_SUPL_ASSISTANCE_SERVICE_H_
+#define GNSS_SDR_SUPL_ASSISTANCE_SERVICE_H_
+
+#include <chrono>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include "gnss_sdr_supl_client.h"
+#include "gps_almanac.h"
+#include "gps_ephemeris.h"
+#include "gps_iono.h"
+#include "gps_ref_time.h"
+#include "gps_utc_model.h"
+
+/*!
+ * \brief Fetches GPS assistance data from SUPL servers in its own thread.
+ *
+ * Lookups never block on the network: request() only schedules a fetch
+ * when the cached data of that kind is missing or older than the
+ * configured time-to-live, and the getters return what is in the cache.
+ * When a fetch completes, the callback is invoked from the worker thread
+ * with the type of data that was refreshed, so that the caller can run
+ * its comparisons then. The servers are tried in order until one answers.
+ *
+ * Each fetch is saved by the worker thread to a binary assistance snapshot
+ * (see gnss_sdr_supl_client::save_assistance_snapshot), which seeds the
+ * cache of the next run, with the age it had then: data still within its
+ * time-to-live is used from the start, without waiting for the servers.
+ */
+class Supl_Assistance_Service
+{
+public:
+    /*!
+     * \brief Kinds of assistance data, with the values of gnss_sdr_supl_client::request
+     */
+    enum Assistance_type
+    {
+        ALMANAC_UTC_IONO = 0, //!< Almanac, UTC model, ionospheric model and reference time
+        EPHEMERIS = 1         //!< Ephemeris
+    };
+
+    typedef boost::function<void(int)> Callback;
+
+    Supl_Assistance_Service(const std::vector<std::string>& servers, int port,
+            int mcc, int mns, int lac, int ci,
+            double ttl_s, double retry_s, Callback on_update,
+            const std::string& snapshot_file = "", bool export_xml = false);
+
+    /*!
+     * \brief Stops the worker thread, waiting for a fetch in progress to finish.
+     */
+    ~Supl_Assistance_Service();
+
+    /*!
+     * \brief Returns true if the cached data of this type is fresh. Otherwise
+     * schedules a fetch (at most one per type, and not more often than
+     * retry_s after a failure) and returns false. Never blocks.
+     */
+    bool request(int type);
+
+    bool get_ephemeris(unsigned int PRN, Gps_Ephemeris& ephemeris) const;
+    bool get_almanac(unsigned int PRN, Gps_Almanac& almanac) const;
+    bool get_utc(Gps_Utc_Model& utc) const;
+    bool get_iono(Gps_Iono& iono) const;
+    bool get_ref_time(Gps_Ref_Time& ref_time) const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void run();
+    bool fetch(int type);
+    void load_snapshot();
+    void save_xml(int type);
+    bool fresh(const Clock::time_point& t) const;
+
+    std::vector<std::string> d_servers;
+    unsigned int d_next_server;
+    int d_port;
+    int d_mcc;
+    int d_mns;
+    int d_lac;
+    int d_ci;
+    Clock::duration d_ttl;
+    Clock::duration d_retry;
+    Callback d_on_update;
+    std::string d_snapshot_file;
+    bool d_export_xml;
+
+    // cache, guarded by d_mutex
+    std::map<int, Gps_Ephemeris> d_ephemeris;
+    std::map<int, Clock::time_point> d_ephemeris_time;
+    std::map<int, Gps_Almanac> d_almanac;
+    std::map<int, Clock::time_point> d_almanac_time;
+    Gps_Utc_Model d_utc;
+    Gps_Iono d_iono;
+    Gps_Ref_Time d_ref_time;
+    std::map<int, Clock::time_point> d_fetch_time;   // type -> last successful fetch
+    std::map<int, Clock::time_point> d_attempt_time; // type -> last attempt
+
+    std::set<int> d_pending;
+    bool d_stop;
+    mutable boost::mutex d_mutex;
+    boost::condition_variable d_cond;
+
+    gnss_sdr_supl_client d_client; // only used by the worker thread
+    boost::thread d_thread;
+};
+
+#endif
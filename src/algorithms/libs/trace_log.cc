@@ -0,0 +1,194 @@
+/*!
+ * \file trace_log.cc
+ * \brief Trace logs of the per-sample and per-epoch paths of the receiver,
+ * with a verbosity per module, and a writer of the log files on a thread
+ * of its own
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "trace_log.h"
+#include <boost/bind.hpp>
+
+
+std::atomic<int> trace_log_levels[TRACE_MODULES];
+
+namespace
+{
+const char* const trace_module_names[TRACE_MODULES] = { "acquisition", "tracking", "telemetry", "pvt", "spoofing" };
+
+boost::mutex & async_log_mutex()
+{
+    static boost::mutex mutex;
+    return mutex;
+}
+
+Async_Log_Writer* async_log_writer = 0;
+}
+
+
+void set_trace_log_level(Trace_Module module, int level)
+{
+    trace_log_levels[module].store(level, std::memory_order_relaxed);
+}
+
+
+const char* trace_module_name(Trace_Module module)
+{
+    return trace_module_names[module];
+}
+
+
+Async_Log_Writer::Async_Log_Writer(google::base::Logger* wrapped, std::size_t max_bytes) :
+        d_wrapped(wrapped),
+        d_max_bytes(max_bytes),
+        d_timestamp(0),
+        d_force_flush(false),
+        d_requested(0),
+        d_done(0),
+        d_stop(false),
+        d_dropped(0)
+{
+    d_pending.reserve(max_bytes);
+    d_writing.reserve(max_bytes);
+    d_thread = boost::thread(boost::bind(&Async_Log_Writer::run, this));
+}
+
+
+Async_Log_Writer::~Async_Log_Writer()
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_stop = true;
+    }
+    d_condition.notify_one();
+    d_thread.join();
+}
+
+
+void Async_Log_Writer::Write(bool force_flush, time_t timestamp, const char* message, int message_len)
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        if (d_pending.size() + message_len > d_max_bytes)
+            {
+                d_dropped++;
+                return;
+            }
+        d_pending.append(message, message_len);
+        d_timestamp = timestamp;
+        d_force_flush = d_force_flush || force_flush;
+    }
+    d_condition.notify_one();
+}
+
+
+void Async_Log_Writer::Flush()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    unsigned long long request = ++d_requested;
+    d_condition.notify_one();
+    while (d_done < request)
+        {
+            d_flushed.wait(lock);
+        }
+}
+
+
+google::uint32 Async_Log_Writer::LogSize()
+{
+    return d_wrapped->LogSize();
+}
+
+
+void Async_Log_Writer::run()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    while (true)
+        {
+            while (d_pending.empty() && d_done == d_requested && !d_stop)
+                {
+                    d_condition.wait(lock);
+                }
+            if (d_pending.empty() && d_done == d_requested)
+                {
+                    break; // stopped, and nothing left to write
+                }
+            d_writing.swap(d_pending);
+            bool force_flush = d_force_flush;
+            d_force_flush = false;
+            time_t timestamp = d_timestamp;
+            unsigned long long requested = d_requested;
+            lock.unlock();
+
+            if (!d_writing.empty())
+                {
+                    d_wrapped->Write(force_flush, timestamp, d_writing.data(), d_writing.size());
+                    d_writing.clear();
+                }
+            if (requested != d_done)
+                {
+                    d_wrapped->Flush();
+                }
+
+            lock.lock();
+            d_done = requested;
+            d_flushed.notify_all();
+        }
+    lock.unlock();
+    d_wrapped->Flush();
+}
+
+
+void start_async_log(std::size_t max_kb)
+{
+    boost::mutex::scoped_lock lock(async_log_mutex());
+    if (async_log_writer)
+        {
+            return;
+        }
+    async_log_writer = new Async_Log_Writer(google::base::GetLogger(google::GLOG_INFO), max_kb * 1024);
+    google::base::SetLogger(google::GLOG_INFO, async_log_writer);
+}
+
+
+void stop_async_log()
+{
+    boost::mutex::scoped_lock lock(async_log_mutex());
+    if (!async_log_writer)
+        {
+            return;
+        }
+    // glog writes under its own lock, so no message reaches the writer after SetLogger
+    google::base::SetLogger(google::GLOG_INFO, async_log_writer->wrapped());
+    if (async_log_writer->dropped() > 0)
+        {
+            LOG(WARNING) << async_log_writer->dropped() << " log messages dropped, the log file did not keep up";
+        }
+    delete async_log_writer;
+    async_log_writer = 0;
+}
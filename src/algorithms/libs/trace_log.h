@@ -0,0 +1,137 @@
+/*!
+ * \file trace_log.h
+ * \brief Trace logs of the per-sample and per-epoch paths of the receiver,
+ * with a verbosity per module, and a writer of the log files on a thread
+ * of its own
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_TRACE_LOG_H_
+#define GNSS_SDR_TRACE_LOG_H_
+
+#include <atomic>
+#include <cstddef>
+#include <ctime>
+#include <string>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <glog/logging.h>
+
+//! Modules of the receiver with a trace verbosity of their own
+enum Trace_Module
+{
+    TRACE_ACQUISITION = 0,
+    TRACE_TRACKING,
+    TRACE_TELEMETRY,
+    TRACE_PVT,
+    TRACE_SPOOFING,
+    TRACE_MODULES
+};
+
+//! Verbosity of each module, 0 (no trace) by default. Read with trace_log_on()
+extern std::atomic<int> trace_log_levels[TRACE_MODULES];
+
+inline bool trace_log_on(Trace_Module module, int level)
+{
+    return trace_log_levels[module].load(std::memory_order_relaxed) >= level;
+}
+
+void set_trace_log_level(Trace_Module module, int level);
+
+//! Name of a module in the configuration, as in Receiver.trace_<name>
+const char* trace_module_name(Trace_Module module);
+
+/*!
+ * \brief Logs at INFO the message that follows, if the verbosity of the
+ * module is level or more. The verbosity is checked by one branch before
+ * the message is evaluated, so a trace that is off costs a relaxed load.
+ * The build option ENABLE_TRACE_LOG=OFF (GNSS_SDR_STRIP_TRACE_LOG) compiles
+ * all of them out.
+ */
+#ifdef GNSS_SDR_STRIP_TRACE_LOG
+#define TRACE_LOG_IS_ON(module, level) false
+#else
+#define TRACE_LOG_IS_ON(module, level) trace_log_on(module, level)
+#endif
+#define TRACE_LOG(module, level) LOG_IF(INFO, TRACE_LOG_IS_ON(module, level))
+
+
+/*!
+ * \brief Logger of glog that hands the messages to another one on a thread
+ * of its own, so that the blocks never wait for the log file.
+ *
+ * Write() only appends the message to a buffer under a mutex; the thread
+ * swaps it with a second one and writes it to the wrapped logger. Messages
+ * that do not fit in max_bytes while the thread writes are dropped and
+ * counted, never waited for.
+ */
+class Async_Log_Writer : public google::base::Logger
+{
+public:
+    Async_Log_Writer(google::base::Logger* wrapped, std::size_t max_bytes);
+    ~Async_Log_Writer();
+
+    void Write(bool force_flush, time_t timestamp, const char* message, int message_len);
+    //! Returns once the messages written so far are in the wrapped logger, and flushed
+    void Flush();
+    google::uint32 LogSize();
+
+    google::base::Logger* wrapped() const { return d_wrapped; }
+    unsigned long int dropped() const { return d_dropped.load(); }
+
+private:
+    Async_Log_Writer(const Async_Log_Writer&);
+    Async_Log_Writer& operator=(const Async_Log_Writer&);
+
+    void run();
+
+    google::base::Logger* d_wrapped;
+    std::size_t d_max_bytes;
+    std::string d_pending;     // messages not handed to the thread yet
+    std::string d_writing;     // messages being written by the thread
+    time_t d_timestamp;        // of the last message
+    bool d_force_flush;
+    unsigned long long d_requested; // flushes requested
+    unsigned long long d_done;      // flushes done
+    bool d_stop;
+    std::atomic<unsigned long int> d_dropped;
+    boost::mutex d_mutex;
+    boost::condition_variable d_condition;
+    boost::condition_variable d_flushed;
+    boost::thread d_thread;
+};
+
+/*!
+ * \brief Writes the INFO log file of glog through an Async_Log_Writer, until
+ * stop_async_log(). Warnings and errors are still written at once.
+ */
+void start_async_log(std::size_t max_kb);
+void stop_async_log();
+
+#endif
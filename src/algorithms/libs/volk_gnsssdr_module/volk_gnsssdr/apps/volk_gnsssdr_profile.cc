@@ -23,7 +23,11 @@
 #include <volk_gnsssdr/volk_gnsssdr.h>
 #include <volk_gnsssdr/volk_gnsssdr_prefs.h>
 
+#include <algorithm>
 #include <ciso646>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
 #include <vector>
 #include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
@@ -50,6 +54,9 @@ int main(int argc, char *argv[]) {
       ("vlen,v",
             boost::program_options::value<int>()->default_value( 8111 ), //it is also prime
             "Set the default vector length for tests") // default is a mersenne prime
+      ("sizes,s",
+            boost::program_options::value<std::string>(),
+            "Comma separated vector lengths to profile instead of vlen: the kernels get the best implementations for each size range")
       ("iter,i",
             boost::program_options::value<int>()->default_value( 1987 ),
             "Set the default number of test iterations per kernel")
@@ -82,6 +89,7 @@ int main(int argc, char *argv[]) {
     std::string def_kernel_regex;
     bool update_mode = false;
     bool dry_run = false;
+    std::vector<int> sizes;
 
     // Handle the provided options
     try {
@@ -103,6 +111,19 @@ int main(int argc, char *argv[]) {
         def_kernel_regex = kernel_regex;
         update_mode = vm["update"].as<bool>();
         dry_run = vm["dry-run"].as<bool>();
+        if ( vm.count("sizes") ) {
+            std::stringstream sizes_stream(vm["sizes"].as<std::string>());
+            std::string size;
+            while(std::getline(sizes_stream, size, ',')) {
+                int vlen = atoi(size.c_str());
+                if(vlen > 0) sizes.push_back(vlen);
+            }
+            std::sort(sizes.begin(), sizes.end());
+            sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+        }
+        if(sizes.empty()) {
+            sizes.push_back(def_vlen);
+        }
     }
     catch (boost::program_options::error& error) {
         std::cerr << "Error: " << error.what() << std::endl << std::endl;
@@ -129,19 +150,13 @@ int main(int argc, char *argv[]) {
         json_file.open( filename.c_str() );
     }
 
-    volk_gnsssdr_test_params_t test_params(def_tol, def_scalar, def_vlen, def_iter,
-        def_benchmark_mode, def_kernel_regex);
-
     // Run tests
     std::vector<volk_gnsssdr_test_results_t> results;
     if(update_mode) {
         read_results(&results);
     }
+    size_t n_previous_results = results.size();
 
-
-    // Initialize the list of tests
-    // the default test parameters come from options
-    std::vector<volk_gnsssdr_test_case_t> test_cases = init_test_list(test_params);
     boost::xpressive::sregex kernel_expression;
     try {
         kernel_expression = boost::xpressive::sregex::compile(kernel_regex);
@@ -151,41 +166,60 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    // Iteratate through list of tests running each one
-    for(unsigned int ii = 0; ii < test_cases.size(); ++ii) {
-        bool regex_match = true;
-
-        volk_gnsssdr_test_case_t test_case = test_cases[ii];
-        // if the kernel name matches regex then do the test
-        if(boost::xpressive::regex_search(test_case.name(), kernel_expression)) {
-            regex_match = true;
-        }
-        else {
-            regex_match = false;
+    // Each size is profiled apart. The choice for a size is used up to the geometric
+    // mean with the next size, the choice for the largest one for any larger size.
+    for(unsigned int si = 0; si < sizes.size(); ++si) {
+        volk_gnsssdr_test_params_t test_params(def_tol, def_scalar, sizes[si], def_iter,
+            def_benchmark_mode, def_kernel_regex);
+        unsigned int max_points = 0;
+        if(si + 1 < sizes.size()) {
+            max_points = static_cast<unsigned int>(std::sqrt(static_cast<double>(sizes[si]) * static_cast<double>(sizes[si + 1])));
         }
+        size_t first_result = results.size();
 
-        // if we are in update mode check if we've already got results
-        // if we have any, then no need to test that kernel
-        bool update = true;
-        if(update_mode) {
-            for(unsigned int jj=0; jj < results.size(); ++jj) {
-                if(results[jj].name == test_case.name() ||
-                    results[jj].name == test_case.puppet_master_name()) {
-                    update = false;
-                    break;
-                }
-            }
-        }
+        // Initialize the list of tests
+        // the default test parameters come from options
+        std::vector<volk_gnsssdr_test_case_t> test_cases = init_test_list(test_params);
 
-        if( regex_match && update ) {
-            try {
-            run_volk_gnsssdr_tests(test_case.desc(), test_case.kernel_ptr(), test_case.name(),
-                test_case.test_parameters(), &results, test_case.puppet_master_name());
+        // Iteratate through list of tests running each one
+        for(unsigned int ii = 0; ii < test_cases.size(); ++ii) {
+            bool regex_match = true;
+
+            volk_gnsssdr_test_case_t test_case = test_cases[ii];
+            // if the kernel name matches regex then do the test
+            if(boost::xpressive::regex_search(test_case.name(), kernel_expression)) {
+                regex_match = true;
+            }
+            else {
+                regex_match = false;
             }
-            catch (std::string error) {
-                std::cerr << "Caught Exception in 'run_volk_gnsssdr_tests': " << error << std::endl;
+
+            // if we are in update mode check if we've already got results
+            // if we have any, then no need to test that kernel
+            bool update = true;
+            if(update_mode) {
+                for(unsigned int jj=0; jj < n_previous_results; ++jj) {
+                    if(results[jj].name == test_case.name() ||
+                        results[jj].name == test_case.puppet_master_name()) {
+                        update = false;
+                        break;
+                    }
+                }
             }
 
+            if( regex_match && update ) {
+                try {
+                run_volk_gnsssdr_tests(test_case.desc(), test_case.kernel_ptr(), test_case.name(),
+                    test_case.test_parameters(), &results, test_case.puppet_master_name());
+                }
+                catch (std::string error) {
+                    std::cerr << "Caught Exception in 'run_volk_gnsssdr_tests': " << error << std::endl;
+                }
+
+            }
+        }
+        for(size_t ri = first_result; ri < results.size(); ++ri) {
+            results[ri].max_points = max_points;
         }
     }
 
@@ -242,12 +276,16 @@ void read_results(std::vector<volk_gnsssdr_test_results_t> *results)
                 config_str.erase(0, found+1);
             }
 
-            if(single_kernel_result.size() == 3) {
+            if(single_kernel_result.size() == 3 || single_kernel_result.size() == 4) {
                 volk_gnsssdr_test_results_t kernel_result;
                 kernel_result.name = std::string(single_kernel_result[0]);
                 kernel_result.config_name = std::string(single_kernel_result[0]);
                 kernel_result.best_arch_u = std::string(single_kernel_result[1]);
                 kernel_result.best_arch_a = std::string(single_kernel_result[2]);
+                kernel_result.max_points = 0;
+                if(single_kernel_result.size() == 4) {
+                    kernel_result.max_points = atoi(single_kernel_result[3].c_str());
+                }
                 results->push_back(kernel_result);
             }
         }
@@ -288,6 +326,7 @@ void write_results(const std::vector<volk_gnsssdr_test_results_t> *results, bool
         config << "\
 #this file is generated by volk_gnsssdr_profile.\n\
 #the function name is followed by the preferred architecture.\n\
+#a last number is the largest num_points the architecture is preferred for.\n\
 ";
     }
 
@@ -295,7 +334,11 @@ void write_results(const std::vector<volk_gnsssdr_test_results_t> *results, bool
     for(profile_results = results->begin(); profile_results != results->end(); ++profile_results) {
         config << profile_results->config_name << " "
             << profile_results->best_arch_a << " "
-            << profile_results->best_arch_u << std::endl;
+            << profile_results->best_arch_u;
+        if(profile_results->max_points != 0) {
+            config << " " << profile_results->max_points;
+        }
+        config << std::endl;
     }
     config.close();
 }
@@ -312,6 +355,7 @@ void write_json(std::ofstream &json_file, std::vector<volk_gnsssdr_test_results_
         json_file << "   \"name\": \"" << result->name << "\"," << std::endl;
         json_file << "   \"vlen\": " << (int)(result->vlen) << "," << std::endl;
         json_file << "   \"iter\": " << result->iter << "," << std::endl;
+        json_file << "   \"max_points\": " << result->max_points << "," << std::endl;
         json_file << "   \"best_arch_a\": \"" << result->best_arch_a
             << "\"," << std::endl;
         json_file << "   \"best_arch_u\": \"" << result->best_arch_u
@@ -47,4 +47,12 @@ static inline int16_t sat_muls16i(int16_t x, int16_t y)
     return res;
 }
 
+static inline int16_t sat_s32_to_s16i(int32_t x)
+{
+    if (x < SHRT_MIN) return SHRT_MIN;
+    if (x > SHRT_MAX) return SHRT_MAX;
+
+    return (int16_t) x;
+}
+
 #endif /* INCLUDED_VOLK_GNSSSDR_SATURATION_ARITHMETIC_H_ */
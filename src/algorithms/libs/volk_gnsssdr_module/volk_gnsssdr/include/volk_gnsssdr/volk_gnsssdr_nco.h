@@ -0,0 +1,65 @@
+/*!
+ * \file volk_gnsssdr_nco.h
+ * \brief Scalar helpers of the table-based numerically controlled oscillator kernels
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * The phase is held in a 32 bits unsigned integer, where 2^32 is a full cycle,
+ * so it wraps around by itself and an increment is a single integer addition.
+ * Sine and cosine are then read from sine_table_10bits with linear interpolation.
+ *
+ * Copyright (C) 2010-2015 (see AUTHORS file for a list of contributors)
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef INCLUDED_VOLK_GNSSSDR_NCO_H_
+#define INCLUDED_VOLK_GNSSSDR_NCO_H_
+
+#include <volk_gnsssdr/volk_gnsssdr_sine_table.h>
+#include <math.h>
+#include <stdint.h>
+
+/* Samples between two corrections of the fixed point phase against the exact one,
+ * so that the rounding of the phase increment does not accumulate */
+#define VOLK_GNSSSDR_NCO_RELOAD 1024
+
+/* Converts a phase in radians to fixed point (2^32 is 2 pi), wrapped to [0, 2 pi) */
+static inline uint32_t nco_rad_to_fxpt(double phase_rad)
+{
+    double cycles = phase_rad / 6.28318530717958647692;
+    cycles -= floor(cycles);
+    return (uint32_t)(int64_t)(cycles * 4294967296.0 + 0.5);
+}
+
+/* Phase of sample n, from the initial phase and the increment per sample, in fixed point */
+static inline uint32_t nco_fxpt_phase_at(float phase_rad, float phase_inc_rad, unsigned int n)
+{
+    return nco_rad_to_fxpt((double)phase_rad + (double)n * (double)phase_inc_rad);
+}
+
+/* Sine and cosine of a fixed point phase, by linear interpolation on a 1024 points table */
+static inline void nco_fxpt_sincos(uint32_t fxpt_phase, float* s, float* c)
+{
+    uint32_t ux = fxpt_phase;
+    uint32_t index = ux >> 22;
+    *s = sine_table_10bits[index][0] * (float)(ux >> 1) + sine_table_10bits[index][1];
+    ux += 0x40000000;
+    index = ux >> 22;
+    *c = sine_table_10bits[index][0] * (float)(ux >> 1) + sine_table_10bits[index][1];
+}
+
+#endif /* INCLUDED_VOLK_GNSSSDR_NCO_H_ */
@@ -35,6 +35,7 @@ typedef struct volk_gnsssdr_arch_pref
     char name[128];   //name of the kernel
     char impl_a[128]; //best aligned impl
     char impl_u[128]; //best unaligned impl
+    unsigned int max_points; //largest num_points the impls are best for, 0 for any
 } volk_gnsssdr_arch_pref_t;
 
 ////////////////////////////////////////////////////////////////////////
@@ -45,6 +46,12 @@ VOLK_API void volk_gnsssdr_get_config_path(char *);
 
 ////////////////////////////////////////////////////////////////////////
 // load prefs into global prefs struct
+// A line of the config file is "kernel impl_a impl_u [max_points]":
+// the lines with max_points are the choices for the calls of at most
+// that many points, the line without it the choice for any other call.
+// If the config file does not exist and VOLK_GNSSSDR_AUTO_PROFILE is
+// set, volk_gnsssdr_profile (or the command in the variable, if it is
+// not "1") is run first to generate it.
 ////////////////////////////////////////////////////////////////////////
 VOLK_API size_t volk_gnsssdr_load_preferences(volk_gnsssdr_arch_pref_t **);
 
@@ -0,0 +1,183 @@
+/*!
+ * \file volk_gnsssdr_16i_x2_interleave_16ic.h
+ * \brief VOLK_GNSSSDR kernel: interleaves two 16 bits vectors into a
+ * 32 bits complex vector.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * VOLK_GNSSSDR kernel that builds a complex vector (16 bits the real part and
+ * 16 bits the imaginary part) from the vectors of its real and imaginary parts
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+/*!
+ * \page volk_gnsssdr_16i_x2_interleave_16ic
+ *
+ * \b Overview
+ *
+ * Interleaves the real and imaginary parts of num_points complex samples.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_gnsssdr_16i_x2_interleave_16ic(lv_16sc_t* cVector, const int16_t* aVector, const int16_t* bVector, unsigned int num_points);
+ * \endcode
+ *
+ * \b Inputs
+ * \li aVector: The real parts.
+ * \li bVector: The imaginary parts.
+ * \li num_points: The number of complex data points.
+ *
+ * \b Outputs
+ * \li cVector: The complex samples.
+ *
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_16i_x2_interleave_16ic_H
+#define INCLUDED_volk_gnsssdr_16i_x2_interleave_16ic_H
+
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_gnsssdr_16i_x2_interleave_16ic_generic(lv_16sc_t* cVector, const int16_t* aVector, const int16_t* bVector, unsigned int num_points)
+{
+    int16_t* c = (int16_t*)cVector;
+    unsigned int n;
+    for(n = 0; n < num_points; n++)
+        {
+            *c++ = aVector[n];
+            *c++ = bVector[n];
+        }
+}
+#endif /* LV_HAVE_GENERIC */
+
+
+#ifdef LV_HAVE_SSE2
+#include <emmintrin.h>
+
+static inline void volk_gnsssdr_16i_x2_interleave_16ic_u_sse2(lv_16sc_t* cVector, const int16_t* aVector, const int16_t* bVector, unsigned int num_points)
+{
+    const unsigned int sse_iters = num_points / 8;
+    unsigned int number;
+    unsigned int n;
+    const int16_t* aPtr = aVector;
+    const int16_t* bPtr = bVector;
+    int16_t* cPtr = (int16_t*)cVector;
+    __m128i a, b;
+
+    for(number = 0; number < sse_iters; number++)
+        {
+            a = _mm_loadu_si128((__m128i*)aPtr);
+            b = _mm_loadu_si128((__m128i*)bPtr);
+            _mm_storeu_si128((__m128i*)cPtr, _mm_unpacklo_epi16(a, b));
+            _mm_storeu_si128((__m128i*)(cPtr + 8), _mm_unpackhi_epi16(a, b));
+
+            aPtr += 8;
+            bPtr += 8;
+            cPtr += 16;
+        }
+
+    for(n = sse_iters * 8; n < num_points; n++)
+        {
+            *cPtr++ = *aPtr++;
+            *cPtr++ = *bPtr++;
+        }
+}
+#endif /* LV_HAVE_SSE2 */
+
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void volk_gnsssdr_16i_x2_interleave_16ic_u_avx2(lv_16sc_t* cVector, const int16_t* aVector, const int16_t* bVector, unsigned int num_points)
+{
+    const unsigned int avx_iters = num_points / 16;
+    unsigned int number;
+    unsigned int n;
+    const int16_t* aPtr = aVector;
+    const int16_t* bPtr = bVector;
+    int16_t* cPtr = (int16_t*)cVector;
+    __m256i a, b, lo, hi;
+
+    for(number = 0; number < avx_iters; number++)
+        {
+            a = _mm256_loadu_si256((__m256i*)aPtr);
+            b = _mm256_loadu_si256((__m256i*)bPtr);
+            // the unpacks work within each 128 bits lane, the permutes put the lanes back in order
+            lo = _mm256_unpacklo_epi16(a, b);
+            hi = _mm256_unpackhi_epi16(a, b);
+            _mm256_storeu_si256((__m256i*)cPtr, _mm256_permute2x128_si256(lo, hi, 0x20));
+            _mm256_storeu_si256((__m256i*)(cPtr + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+
+            aPtr += 16;
+            bPtr += 16;
+            cPtr += 32;
+        }
+
+    for(n = avx_iters * 16; n < num_points; n++)
+        {
+            *cPtr++ = *aPtr++;
+            *cPtr++ = *bPtr++;
+        }
+}
+#endif /* LV_HAVE_AVX2 */
+
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_16i_x2_interleave_16ic_neon(lv_16sc_t* cVector, const int16_t* aVector, const int16_t* bVector, unsigned int num_points)
+{
+    const unsigned int neon_iters = num_points / 8;
+    unsigned int number;
+    unsigned int n;
+    const int16_t* aPtr = aVector;
+    const int16_t* bPtr = bVector;
+    int16_t* cPtr = (int16_t*)cVector;
+    int16x8x2_t c;
+
+    for(number = 0; number < neon_iters; number++)
+        {
+            c.val[0] = vld1q_s16(aPtr);
+            c.val[1] = vld1q_s16(bPtr);
+            vst2q_s16(cPtr, c);
+
+            aPtr += 8;
+            bPtr += 8;
+            cPtr += 16;
+        }
+
+    for(n = neon_iters * 8; n < num_points; n++)
+        {
+            *cPtr++ = *aPtr++;
+            *cPtr++ = *bPtr++;
+        }
+}
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_gnsssdr_16i_x2_interleave_16ic_H */
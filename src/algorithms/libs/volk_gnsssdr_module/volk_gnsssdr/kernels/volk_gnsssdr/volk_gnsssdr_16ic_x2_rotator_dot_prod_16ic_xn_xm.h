@@ -0,0 +1,615 @@
+/*!
+ * \file volk_gnsssdr_16ic_x2_rotator_dot_prod_16ic_xn_xm.h
+ * \brief VOLK_GNSSSDR kernel: correlates a common 16 bits complex vector with M groups
+ * of N vectors, rotating it with a different phase for each group.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * VOLK_GNSSSDR kernel that extends volk_gnsssdr_16ic_x2_rotator_dot_prod_16ic_xn to
+ * several output groups (e.g., several channels fed by the same signal), each one with
+ * its own phase offset, phase increment and set of N local codes. Every chunk of the common
+ * vector is loaded once and used by all the groups. The products are accumulated in
+ * 32 bits integers and saturated to 16 bits only once, when the results are stored.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+/*!
+ * \page volk_gnsssdr_16ic_x2_rotator_dot_prod_16ic_xn_xm
+ *
+ * \b Overview
+ *
+ * For each one of \p num_out_groups groups, rotates the reference complex vector at the rate
+ * \p phase_inc[m] per sample, from the initial phase \p phase[m], multiplies it with the
+ * \p num_a_vectors vectors of the group, accumulates the results and stores them in the output vector.
+ * The vectors of group m are in_a[m * num_a_vectors] to in_a[(m + 1) * num_a_vectors - 1],
+ * and their results are stored in the same positions of \p result.
+ * This function can be used for Doppler wipe-off and multiple correlator of several channels sharing the same input.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_gnsssdr_16ic_x2_rotator_dot_prod_16ic_xn_xm(lv_16sc_t* result, const lv_16sc_t* in_common, const lv_32fc_t* phase_inc, lv_32fc_t* phase, const lv_16sc_t** in_a, int num_a_vectors, int num_out_groups, unsigned int num_points)
+ * \endcode
+ *
+ * \b Inputs
+ * \li in_common:      Pointer to one of the vectors to be rotated, multiplied and accumulated (reference vector).
+ * \li phase_inc:      Phase increment of each group = lv_cmake(cos(phase_step_rad), sin(phase_step_rad))
+ * \li phase:          Initial phase of each group = lv_cmake(cos(initial_phase_rad), sin(initial_phase_rad))
+ * \li in_a:           Pointer to an array of \p num_out_groups * \p num_a_vectors pointers to the vectors to be multiplied and accumulated.
+ * \li num_a_vectors:  Number of vectors of each group.
+ * \li num_out_groups: Number of groups.
+ * \li num_points:     Number of complex values to be multiplied together, accumulated and stored into \p result.
+ *
+ * \b Outputs
+ * \li phase:          Final phase of each group.
+ * \li result:         Vector of \p num_out_groups * \p num_a_vectors components with the vectors of \p in_a multiplied by the rotated \p in_common and accumulated.
+ *
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_16ic_x2_rotator_dot_prod_16ic_xn_xm_H
+#define INCLUDED_volk_gnsssdr_16ic_x2_rotator_dot_prod_16ic_xn_xm_H
+
+
+#include <volk_gnsssdr/volk_gnsssdr.h>
+#include <volk_gnsssdr/volk_gnsssdr_malloc.h>
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+#include <volk_gnsssdr/saturation_arithmetic.h>
+#include <math.h>
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_gnsssdr_16ic_x2_rotator_dot_prod_16ic_xn_xm_generic(lv_16sc_t* result, const lv_16sc_t* in_common, const lv_32fc_t* phase_inc, lv_32fc_t* phase, const lv_16sc_t** in_a, int num_a_vectors, int num_out_groups, unsigned int num_points)
+{
+    lv_16sc_t tmp16;
+    lv_32fc_t tmp32;
+    const unsigned int ROTATOR_RELOAD = 256;
+    const int num_out_vectors = num_out_groups * num_a_vectors;
+
+    int32_t* acc = (int32_t*)volk_gnsssdr_malloc(2 * num_out_vectors * sizeof(int32_t), volk_gnsssdr_get_alignment());
+    int32_t* acc_real = acc;
+    int32_t* acc_imag = acc + num_out_vectors;
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            acc_real[n_vec] = 0;
+            acc_imag[n_vec] = 0;
+        }
+
+    for (unsigned int n = 0; n < num_points; n++)
+        {
+            for (int n_group = 0; n_group < num_out_groups; n_group++)
+                {
+                    tmp16 = in_common[n];
+                    tmp32 = lv_cmake((float)lv_creal(tmp16), (float)lv_cimag(tmp16)) * phase[n_group];
+                    tmp16 = lv_cmake((int16_t)rintf(lv_creal(tmp32)), (int16_t)rintf(lv_cimag(tmp32)));
+                    phase[n_group] *= phase_inc[n_group];
+
+                    for (int n_vec = n_group * num_a_vectors; n_vec < (n_group + 1) * num_a_vectors; n_vec++)
+                        {
+                            acc_real[n_vec] += (int32_t)lv_creal(tmp16) * lv_creal(in_a[n_vec][n]) - (int32_t)lv_cimag(tmp16) * lv_cimag(in_a[n_vec][n]);
+                            acc_imag[n_vec] += (int32_t)lv_creal(tmp16) * lv_cimag(in_a[n_vec][n]) + (int32_t)lv_cimag(tmp16) * lv_creal(in_a[n_vec][n]);
+                        }
+
+                    // Regenerate phase
+                    if ((n % ROTATOR_RELOAD) == ROTATOR_RELOAD - 1)
+                        {
+#ifdef __cplusplus
+                            phase[n_group] /= std::abs(phase[n_group]);
+#else
+                            phase[n_group] /= hypotf(lv_creal(phase[n_group]), lv_cimag(phase[n_group]));
+#endif
+                        }
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            result[n_vec] = lv_cmake(sat_s32_to_s16i(acc_real[n_vec]), sat_s32_to_s16i(acc_imag[n_vec]));
+        }
+    volk_gnsssdr_free(acc);
+}
+
+#endif /*LV_HAVE_GENERIC*/
+
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void volk_gnsssdr_16ic_x2_rotator_dot_prod_16ic_xn_xm_a_avx2(lv_16sc_t* result, const lv_16sc_t* in_common, const lv_32fc_t* phase_inc, lv_32fc_t* phase, const lv_16sc_t** in_a, int num_a_vectors, int num_out_groups, unsigned int num_points)
+{
+    const unsigned int avx2_iters = num_points / 8;
+    const unsigned int ROTATOR_RELOAD = 32; // iterations of 8 samples, as the 256 samples of the generic version
+    const int num_out_vectors = num_out_groups * num_a_vectors;
+
+    const lv_16sc_t* _in_common = in_common;
+    lv_16sc_t tmp16;
+    lv_32fc_t tmp32;
+
+    __VOLK_ATTR_ALIGNED(32) int32_t accVector[8];
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t phase_lo[4];
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t phase_hi[4];
+
+    int32_t* acc = (int32_t*)volk_gnsssdr_malloc(2 * num_out_vectors * sizeof(int32_t), volk_gnsssdr_get_alignment());
+    int32_t* acc_real = acc;
+    int32_t* acc_imag = acc + num_out_vectors;
+    __m256i* acc_reg = (__m256i*)volk_gnsssdr_malloc(2 * num_out_vectors * sizeof(__m256i), 32);
+    __m256i* acc_real_reg = acc_reg;
+    __m256i* acc_imag_reg = acc_reg + num_out_vectors;
+    // samples 0 to 3 and 4 to 7 of each iteration are rotated by phase_lo and phase_hi, for each group
+    __m256* phase_reg = (__m256*)volk_gnsssdr_malloc(3 * num_out_groups * sizeof(__m256), 32);
+    __m256* phase_lo_reg = phase_reg;
+    __m256* phase_hi_reg = phase_reg + num_out_groups;
+    __m256* phase_inc8_reg = phase_reg + 2 * num_out_groups;
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            acc_real_reg[n_vec] = _mm256_setzero_si256();
+            acc_imag_reg[n_vec] = _mm256_setzero_si256();
+        }
+
+    for (int n_group = 0; n_group < num_out_groups; n_group++)
+        {
+            lv_32fc_t phase_n = phase[n_group];
+            for (int i = 0; i < 4; i++)
+                {
+                    phase_lo[i] = phase_n;
+                    phase_n *= phase_inc[n_group];
+                }
+            for (int i = 0; i < 4; i++)
+                {
+                    phase_hi[i] = phase_n;
+                    phase_n *= phase_inc[n_group];
+                }
+            phase_lo_reg[n_group] = _mm256_load_ps((float*)phase_lo);
+            phase_hi_reg[n_group] = _mm256_load_ps((float*)phase_hi);
+            lv_32fc_t phase_inc_8 = phase_inc[n_group] * phase_inc[n_group];
+            phase_inc_8 *= phase_inc_8;
+            phase_inc_8 *= phase_inc_8;
+            phase_inc8_reg[n_group] = _mm256_setr_ps(lv_creal(phase_inc_8), lv_cimag(phase_inc_8), lv_creal(phase_inc_8), lv_cimag(phase_inc_8),
+                    lv_creal(phase_inc_8), lv_cimag(phase_inc_8), lv_creal(phase_inc_8), lv_cimag(phase_inc_8));
+        }
+
+    const __m256i conj_sign = _mm256_set_epi16(-1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1);
+
+    __m256i a, rotated, code_reg;
+    __m256 sample_lo, sample_hi, rot_lo, rot_hi, yl, yh, ylp, yhp, tmp1, tmp2;
+
+    for(unsigned int number = 0; number < avx2_iters; number++)
+        {
+            // the common input is loaded and promoted to float once for all the groups
+            a = _mm256_load_si256((__m256i*)_in_common);
+            __builtin_prefetch(_in_common + 16);
+            _in_common += 8;
+            sample_lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(a)));
+            sample_hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(a, 1)));
+
+            for (int n_group = 0; n_group < num_out_groups; n_group++)
+                {
+                    yl = _mm256_moveldup_ps(phase_lo_reg[n_group]);
+                    yh = _mm256_movehdup_ps(phase_lo_reg[n_group]);
+                    rot_lo = _mm256_addsub_ps(_mm256_mul_ps(sample_lo, yl), _mm256_mul_ps(_mm256_permute_ps(sample_lo, 0xB1), yh));
+                    yl = _mm256_moveldup_ps(phase_hi_reg[n_group]);
+                    yh = _mm256_movehdup_ps(phase_hi_reg[n_group]);
+                    rot_hi = _mm256_addsub_ps(_mm256_mul_ps(sample_hi, yl), _mm256_mul_ps(_mm256_permute_ps(sample_hi, 0xB1), yh));
+
+                    ylp = _mm256_moveldup_ps(phase_inc8_reg[n_group]);
+                    yhp = _mm256_movehdup_ps(phase_inc8_reg[n_group]);
+                    phase_lo_reg[n_group] = _mm256_addsub_ps(_mm256_mul_ps(phase_lo_reg[n_group], ylp), _mm256_mul_ps(_mm256_permute_ps(phase_lo_reg[n_group], 0xB1), yhp));
+                    phase_hi_reg[n_group] = _mm256_addsub_ps(_mm256_mul_ps(phase_hi_reg[n_group], ylp), _mm256_mul_ps(_mm256_permute_ps(phase_hi_reg[n_group], 0xB1), yhp));
+
+                    // round to nearest and pack back to 16 bits (packs works per lane: restore the sample order)
+                    rotated = _mm256_packs_epi32(_mm256_cvtps_epi32(rot_lo), _mm256_cvtps_epi32(rot_hi));
+                    rotated = _mm256_permute4x64_epi64(rotated, 0xD8);
+
+                    for (int n_vec = n_group * num_a_vectors; n_vec < (n_group + 1) * num_a_vectors; n_vec++)
+                        {
+                            code_reg = _mm256_load_si256((__m256i*)&(in_a[n_vec][number * 8]));
+
+                            // real: sr * cr - si * ci, imag: sr * ci + si * cr, both in 32 bits
+                            acc_real_reg[n_vec] = _mm256_add_epi32(acc_real_reg[n_vec], _mm256_madd_epi16(rotated, _mm256_sign_epi16(code_reg, conj_sign)));
+                            code_reg = _mm256_or_si256(_mm256_slli_epi32(code_reg, 16), _mm256_srli_epi32(code_reg, 16));
+                            acc_imag_reg[n_vec] = _mm256_add_epi32(acc_imag_reg[n_vec], _mm256_madd_epi16(rotated, code_reg));
+                        }
+
+                    // Regenerate phase
+                    if ((number % ROTATOR_RELOAD) == ROTATOR_RELOAD - 1)
+                        {
+                            tmp1 = _mm256_mul_ps(phase_lo_reg[n_group], phase_lo_reg[n_group]);
+                            tmp2 = _mm256_add_ps(tmp1, _mm256_permute_ps(tmp1, 0xB1));
+                            phase_lo_reg[n_group] = _mm256_div_ps(phase_lo_reg[n_group], _mm256_sqrt_ps(tmp2));
+                            tmp1 = _mm256_mul_ps(phase_hi_reg[n_group], phase_hi_reg[n_group]);
+                            tmp2 = _mm256_add_ps(tmp1, _mm256_permute_ps(tmp1, 0xB1));
+                            phase_hi_reg[n_group] = _mm256_div_ps(phase_hi_reg[n_group], _mm256_sqrt_ps(tmp2));
+                        }
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            _mm256_store_si256((__m256i*)accVector, acc_real_reg[n_vec]);
+            acc_real[n_vec] = accVector[0] + accVector[1] + accVector[2] + accVector[3] + accVector[4] + accVector[5] + accVector[6] + accVector[7];
+            _mm256_store_si256((__m256i*)accVector, acc_imag_reg[n_vec]);
+            acc_imag[n_vec] = accVector[0] + accVector[1] + accVector[2] + accVector[3] + accVector[4] + accVector[5] + accVector[6] + accVector[7];
+        }
+
+    for (int n_group = 0; n_group < num_out_groups; n_group++)
+        {
+            _mm256_store_ps((float*)phase_lo, phase_lo_reg[n_group]);
+            phase[n_group] = phase_lo[0];
+        }
+    _mm256_zeroupper();
+
+    for(unsigned int n = avx2_iters * 8; n < num_points; n++)
+        {
+            for (int n_group = 0; n_group < num_out_groups; n_group++)
+                {
+                    tmp16 = in_common[n];
+                    tmp32 = lv_cmake((float)lv_creal(tmp16), (float)lv_cimag(tmp16)) * phase[n_group];
+                    tmp16 = lv_cmake((int16_t)rintf(lv_creal(tmp32)), (int16_t)rintf(lv_cimag(tmp32)));
+                    phase[n_group] *= phase_inc[n_group];
+                    for (int n_vec = n_group * num_a_vectors; n_vec < (n_group + 1) * num_a_vectors; n_vec++)
+                        {
+                            acc_real[n_vec] += (int32_t)lv_creal(tmp16) * lv_creal(in_a[n_vec][n]) - (int32_t)lv_cimag(tmp16) * lv_cimag(in_a[n_vec][n]);
+                            acc_imag[n_vec] += (int32_t)lv_creal(tmp16) * lv_cimag(in_a[n_vec][n]) + (int32_t)lv_cimag(tmp16) * lv_creal(in_a[n_vec][n]);
+                        }
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            result[n_vec] = lv_cmake(sat_s32_to_s16i(acc_real[n_vec]), sat_s32_to_s16i(acc_imag[n_vec]));
+        }
+    volk_gnsssdr_free(phase_reg);
+    volk_gnsssdr_free(acc_reg);
+    volk_gnsssdr_free(acc);
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void volk_gnsssdr_16ic_x2_rotator_dot_prod_16ic_xn_xm_u_avx2(lv_16sc_t* result, const lv_16sc_t* in_common, const lv_32fc_t* phase_inc, lv_32fc_t* phase, const lv_16sc_t** in_a, int num_a_vectors, int num_out_groups, unsigned int num_points)
+{
+    const unsigned int avx2_iters = num_points / 8;
+    const unsigned int ROTATOR_RELOAD = 32; // iterations of 8 samples, as the 256 samples of the generic version
+    const int num_out_vectors = num_out_groups * num_a_vectors;
+
+    const lv_16sc_t* _in_common = in_common;
+    lv_16sc_t tmp16;
+    lv_32fc_t tmp32;
+
+    __VOLK_ATTR_ALIGNED(32) int32_t accVector[8];
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t phase_lo[4];
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t phase_hi[4];
+
+    int32_t* acc = (int32_t*)volk_gnsssdr_malloc(2 * num_out_vectors * sizeof(int32_t), volk_gnsssdr_get_alignment());
+    int32_t* acc_real = acc;
+    int32_t* acc_imag = acc + num_out_vectors;
+    __m256i* acc_reg = (__m256i*)volk_gnsssdr_malloc(2 * num_out_vectors * sizeof(__m256i), 32);
+    __m256i* acc_real_reg = acc_reg;
+    __m256i* acc_imag_reg = acc_reg + num_out_vectors;
+    // samples 0 to 3 and 4 to 7 of each iteration are rotated by phase_lo and phase_hi, for each group
+    __m256* phase_reg = (__m256*)volk_gnsssdr_malloc(3 * num_out_groups * sizeof(__m256), 32);
+    __m256* phase_lo_reg = phase_reg;
+    __m256* phase_hi_reg = phase_reg + num_out_groups;
+    __m256* phase_inc8_reg = phase_reg + 2 * num_out_groups;
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            acc_real_reg[n_vec] = _mm256_setzero_si256();
+            acc_imag_reg[n_vec] = _mm256_setzero_si256();
+        }
+
+    for (int n_group = 0; n_group < num_out_groups; n_group++)
+        {
+            lv_32fc_t phase_n = phase[n_group];
+            for (int i = 0; i < 4; i++)
+                {
+                    phase_lo[i] = phase_n;
+                    phase_n *= phase_inc[n_group];
+                }
+            for (int i = 0; i < 4; i++)
+                {
+                    phase_hi[i] = phase_n;
+                    phase_n *= phase_inc[n_group];
+                }
+            phase_lo_reg[n_group] = _mm256_load_ps((float*)phase_lo);
+            phase_hi_reg[n_group] = _mm256_load_ps((float*)phase_hi);
+            lv_32fc_t phase_inc_8 = phase_inc[n_group] * phase_inc[n_group];
+            phase_inc_8 *= phase_inc_8;
+            phase_inc_8 *= phase_inc_8;
+            phase_inc8_reg[n_group] = _mm256_setr_ps(lv_creal(phase_inc_8), lv_cimag(phase_inc_8), lv_creal(phase_inc_8), lv_cimag(phase_inc_8),
+                    lv_creal(phase_inc_8), lv_cimag(phase_inc_8), lv_creal(phase_inc_8), lv_cimag(phase_inc_8));
+        }
+
+    const __m256i conj_sign = _mm256_set_epi16(-1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1);
+
+    __m256i a, rotated, code_reg;
+    __m256 sample_lo, sample_hi, rot_lo, rot_hi, yl, yh, ylp, yhp, tmp1, tmp2;
+
+    for(unsigned int number = 0; number < avx2_iters; number++)
+        {
+            // the common input is loaded and promoted to float once for all the groups
+            a = _mm256_loadu_si256((__m256i*)_in_common);
+            __builtin_prefetch(_in_common + 16);
+            _in_common += 8;
+            sample_lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(a)));
+            sample_hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(a, 1)));
+
+            for (int n_group = 0; n_group < num_out_groups; n_group++)
+                {
+                    yl = _mm256_moveldup_ps(phase_lo_reg[n_group]);
+                    yh = _mm256_movehdup_ps(phase_lo_reg[n_group]);
+                    rot_lo = _mm256_addsub_ps(_mm256_mul_ps(sample_lo, yl), _mm256_mul_ps(_mm256_permute_ps(sample_lo, 0xB1), yh));
+                    yl = _mm256_moveldup_ps(phase_hi_reg[n_group]);
+                    yh = _mm256_movehdup_ps(phase_hi_reg[n_group]);
+                    rot_hi = _mm256_addsub_ps(_mm256_mul_ps(sample_hi, yl), _mm256_mul_ps(_mm256_permute_ps(sample_hi, 0xB1), yh));
+
+                    ylp = _mm256_moveldup_ps(phase_inc8_reg[n_group]);
+                    yhp = _mm256_movehdup_ps(phase_inc8_reg[n_group]);
+                    phase_lo_reg[n_group] = _mm256_addsub_ps(_mm256_mul_ps(phase_lo_reg[n_group], ylp), _mm256_mul_ps(_mm256_permute_ps(phase_lo_reg[n_group], 0xB1), yhp));
+                    phase_hi_reg[n_group] = _mm256_addsub_ps(_mm256_mul_ps(phase_hi_reg[n_group], ylp), _mm256_mul_ps(_mm256_permute_ps(phase_hi_reg[n_group], 0xB1), yhp));
+
+                    // round to nearest and pack back to 16 bits (packs works per lane: restore the sample order)
+                    rotated = _mm256_packs_epi32(_mm256_cvtps_epi32(rot_lo), _mm256_cvtps_epi32(rot_hi));
+                    rotated = _mm256_permute4x64_epi64(rotated, 0xD8);
+
+                    for (int n_vec = n_group * num_a_vectors; n_vec < (n_group + 1) * num_a_vectors; n_vec++)
+                        {
+                            code_reg = _mm256_loadu_si256((__m256i*)&(in_a[n_vec][number * 8]));
+
+                            // real: sr * cr - si * ci, imag: sr * ci + si * cr, both in 32 bits
+                            acc_real_reg[n_vec] = _mm256_add_epi32(acc_real_reg[n_vec], _mm256_madd_epi16(rotated, _mm256_sign_epi16(code_reg, conj_sign)));
+                            code_reg = _mm256_or_si256(_mm256_slli_epi32(code_reg, 16), _mm256_srli_epi32(code_reg, 16));
+                            acc_imag_reg[n_vec] = _mm256_add_epi32(acc_imag_reg[n_vec], _mm256_madd_epi16(rotated, code_reg));
+                        }
+
+                    // Regenerate phase
+                    if ((number % ROTATOR_RELOAD) == ROTATOR_RELOAD - 1)
+                        {
+                            tmp1 = _mm256_mul_ps(phase_lo_reg[n_group], phase_lo_reg[n_group]);
+                            tmp2 = _mm256_add_ps(tmp1, _mm256_permute_ps(tmp1, 0xB1));
+                            phase_lo_reg[n_group] = _mm256_div_ps(phase_lo_reg[n_group], _mm256_sqrt_ps(tmp2));
+                            tmp1 = _mm256_mul_ps(phase_hi_reg[n_group], phase_hi_reg[n_group]);
+                            tmp2 = _mm256_add_ps(tmp1, _mm256_permute_ps(tmp1, 0xB1));
+                            phase_hi_reg[n_group] = _mm256_div_ps(phase_hi_reg[n_group], _mm256_sqrt_ps(tmp2));
+                        }
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            _mm256_store_si256((__m256i*)accVector, acc_real_reg[n_vec]);
+            acc_real[n_vec] = accVector[0] + accVector[1] + accVector[2] + accVector[3] + accVector[4] + accVector[5] + accVector[6] + accVector[7];
+            _mm256_store_si256((__m256i*)accVector, acc_imag_reg[n_vec]);
+            acc_imag[n_vec] = accVector[0] + accVector[1] + accVector[2] + accVector[3] + accVector[4] + accVector[5] + accVector[6] + accVector[7];
+        }
+
+    for (int n_group = 0; n_group < num_out_groups; n_group++)
+        {
+            _mm256_store_ps((float*)phase_lo, phase_lo_reg[n_group]);
+            phase[n_group] = phase_lo[0];
+        }
+    _mm256_zeroupper();
+
+    for(unsigned int n = avx2_iters * 8; n < num_points; n++)
+        {
+            for (int n_group = 0; n_group < num_out_groups; n_group++)
+                {
+                    tmp16 = in_common[n];
+                    tmp32 = lv_cmake((float)lv_creal(tmp16), (float)lv_cimag(tmp16)) * phase[n_group];
+                    tmp16 = lv_cmake((int16_t)rintf(lv_creal(tmp32)), (int16_t)rintf(lv_cimag(tmp32)));
+                    phase[n_group] *= phase_inc[n_group];
+                    for (int n_vec = n_group * num_a_vectors; n_vec < (n_group + 1) * num_a_vectors; n_vec++)
+                        {
+                            acc_real[n_vec] += (int32_t)lv_creal(tmp16) * lv_creal(in_a[n_vec][n]) - (int32_t)lv_cimag(tmp16) * lv_cimag(in_a[n_vec][n]);
+                            acc_imag[n_vec] += (int32_t)lv_creal(tmp16) * lv_cimag(in_a[n_vec][n]) + (int32_t)lv_cimag(tmp16) * lv_creal(in_a[n_vec][n]);
+                        }
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            result[n_vec] = lv_cmake(sat_s32_to_s16i(acc_real[n_vec]), sat_s32_to_s16i(acc_imag[n_vec]));
+        }
+    volk_gnsssdr_free(phase_reg);
+    volk_gnsssdr_free(acc_reg);
+    volk_gnsssdr_free(acc);
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_16ic_x2_rotator_dot_prod_16ic_xn_xm_neon(lv_16sc_t* result, const lv_16sc_t* in_common, const lv_32fc_t* phase_inc, lv_32fc_t* phase, const lv_16sc_t** in_a, int num_a_vectors, int num_out_groups, unsigned int num_points)
+{
+    const unsigned int neon_iters = num_points / 4;
+    const unsigned int ROTATOR_RELOAD = 64; // iterations of 4 samples, as the 256 samples of the generic version
+    const int num_out_vectors = num_out_groups * num_a_vectors;
+
+    const lv_16sc_t* _in_common = in_common;
+    lv_16sc_t tmp16_;
+    lv_32fc_t tmp32_;
+
+    __VOLK_ATTR_ALIGNED(16) float32_t __phase_real[4];
+    __VOLK_ATTR_ALIGNED(16) float32_t __phase_imag[4];
+    __VOLK_ATTR_ALIGNED(16) int32_t accVector[4];
+
+    int32_t* acc = (int32_t*)volk_gnsssdr_malloc(2 * num_out_vectors * sizeof(int32_t), volk_gnsssdr_get_alignment());
+    int32_t* acc_real = acc;
+    int32_t* acc_imag = acc + num_out_vectors;
+    int32x4x2_t* accumulator = (int32x4x2_t*)volk_gnsssdr_malloc(num_out_vectors * sizeof(int32x4x2_t), volk_gnsssdr_get_alignment());
+    // phase of the four current samples (real, imag) and phase increment of four samples (real, imag), for each group
+    float32x4_t* phase_regs = (float32x4_t*)volk_gnsssdr_malloc(4 * num_out_groups * sizeof(float32x4_t), volk_gnsssdr_get_alignment());
+    float32x4_t* _phase_real = phase_regs;
+    float32x4_t* _phase_imag = phase_regs + num_out_groups;
+    float32x4_t* _phase4_real = phase_regs + 2 * num_out_groups;
+    float32x4_t* _phase4_imag = phase_regs + 3 * num_out_groups;
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            accumulator[n_vec].val[0] = vdupq_n_s32(0);
+            accumulator[n_vec].val[1] = vdupq_n_s32(0);
+        }
+
+    for (int n_group = 0; n_group < num_out_groups; n_group++)
+        {
+            lv_32fc_t phase_n = phase[n_group];
+            for (int i = 0; i < 4; i++)
+                {
+                    __phase_real[i] = lv_creal(phase_n);
+                    __phase_imag[i] = lv_cimag(phase_n);
+                    phase_n *= phase_inc[n_group];
+                }
+            _phase_real[n_group] = vld1q_f32(__phase_real);
+            _phase_imag[n_group] = vld1q_f32(__phase_imag);
+            lv_32fc_t ___phase4 = phase_inc[n_group] * phase_inc[n_group] * phase_inc[n_group] * phase_inc[n_group];
+            _phase4_real[n_group] = vdupq_n_f32(lv_creal(___phase4));
+            _phase4_imag[n_group] = vdupq_n_f32(lv_cimag(___phase4));
+        }
+
+    const float32x4_t half = vdupq_n_f32(0.5f);
+
+    int16x4x2_t tmp16, code_val;
+    int32x4x2_t tmp32i;
+    float32x4x2_t samples, tmp32f, tmp32_real, tmp32_imag;
+    float32x4_t sign, PlusHalf, Round, mag2, inv_mag;
+
+    for(unsigned int number = 0; number < neon_iters; number++)
+        {
+            /* load 4 complex numbers (int 16 bits each component) and promote them to float 32 bits, once for all the groups */
+            tmp16 = vld2_s16((int16_t*)_in_common);
+            __builtin_prefetch(_in_common + 8);
+            _in_common += 4;
+            samples.val[0] = vcvtq_f32_s32(vmovl_s16(tmp16.val[0]));
+            samples.val[1] = vcvtq_f32_s32(vmovl_s16(tmp16.val[1]));
+
+            for (int n_group = 0; n_group < num_out_groups; n_group++)
+                {
+                    /* complex multiplication of four complex samples by the phases of this group */
+                    tmp32_real.val[0] = vmulq_f32(samples.val[0], _phase_real[n_group]);
+                    tmp32_real.val[1] = vmulq_f32(samples.val[1], _phase_imag[n_group]);
+                    tmp32_imag.val[0] = vmulq_f32(samples.val[0], _phase_imag[n_group]);
+                    tmp32_imag.val[1] = vmulq_f32(samples.val[1], _phase_real[n_group]);
+
+                    tmp32f.val[0] = vsubq_f32(tmp32_real.val[0], tmp32_real.val[1]);
+                    tmp32f.val[1] = vaddq_f32(tmp32_imag.val[0], tmp32_imag.val[1]);
+
+                    /* downcast results to int32, rounding to nearest */
+                    sign = vcvtq_f32_u32((vshrq_n_u32(vreinterpretq_u32_f32(tmp32f.val[0]), 31)));
+                    PlusHalf = vaddq_f32(tmp32f.val[0], half);
+                    Round = vsubq_f32(PlusHalf, sign);
+                    tmp32i.val[0] = vcvtq_s32_f32(Round);
+
+                    sign = vcvtq_f32_u32((vshrq_n_u32(vreinterpretq_u32_f32(tmp32f.val[1]), 31)));
+                    PlusHalf = vaddq_f32(tmp32f.val[1], half);
+                    Round = vsubq_f32(PlusHalf, sign);
+                    tmp32i.val[1] = vcvtq_s32_f32(Round);
+
+                    /* downcast results to int16 */
+                    tmp16.val[0] = vqmovn_s32(tmp32i.val[0]);
+                    tmp16.val[1] = vqmovn_s32(tmp32i.val[1]);
+
+                    /* compute next four phases */
+                    tmp32_real.val[0] = vmulq_f32(_phase_real[n_group], _phase4_real[n_group]);
+                    tmp32_real.val[1] = vmulq_f32(_phase_imag[n_group], _phase4_imag[n_group]);
+                    tmp32_imag.val[0] = vmulq_f32(_phase_real[n_group], _phase4_imag[n_group]);
+                    tmp32_imag.val[1] = vmulq_f32(_phase_imag[n_group], _phase4_real[n_group]);
+
+                    _phase_real[n_group] = vsubq_f32(tmp32_real.val[0], tmp32_real.val[1]);
+                    _phase_imag[n_group] = vaddq_f32(tmp32_imag.val[0], tmp32_imag.val[1]);
+
+                    for (int n_vec = n_group * num_a_vectors; n_vec < (n_group + 1) * num_a_vectors; n_vec++)
+                        {
+                            code_val = vld2_s16((int16_t*)&(in_a[n_vec][number * 4]));
+
+                            // widening multiply-accumulate: no saturation in the loop
+                            accumulator[n_vec].val[0] = vmlal_s16(accumulator[n_vec].val[0], tmp16.val[0], code_val.val[0]);
+                            accumulator[n_vec].val[0] = vmlsl_s16(accumulator[n_vec].val[0], tmp16.val[1], code_val.val[1]);
+                            accumulator[n_vec].val[1] = vmlal_s16(accumulator[n_vec].val[1], tmp16.val[0], code_val.val[1]);
+                            accumulator[n_vec].val[1] = vmlal_s16(accumulator[n_vec].val[1], tmp16.val[1], code_val.val[0]);
+                        }
+
+                    // Regenerate phase
+                    if ((number % ROTATOR_RELOAD) == ROTATOR_RELOAD - 1)
+                        {
+                            mag2 = vaddq_f32(vmulq_f32(_phase_real[n_group], _phase_real[n_group]), vmulq_f32(_phase_imag[n_group], _phase_imag[n_group]));
+                            inv_mag = vrsqrteq_f32(mag2);
+                            inv_mag = vmulq_f32(vrsqrtsq_f32(vmulq_f32(mag2, inv_mag), inv_mag), inv_mag);
+                            inv_mag = vmulq_f32(vrsqrtsq_f32(vmulq_f32(mag2, inv_mag), inv_mag), inv_mag);
+                            _phase_real[n_group] = vmulq_f32(_phase_real[n_group], inv_mag);
+                            _phase_imag[n_group] = vmulq_f32(_phase_imag[n_group], inv_mag);
+                        }
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            vst1q_s32(accVector, accumulator[n_vec].val[0]);
+            acc_real[n_vec] = accVector[0] + accVector[1] + accVector[2] + accVector[3];
+            vst1q_s32(accVector, accumulator[n_vec].val[1]);
+            acc_imag[n_vec] = accVector[0] + accVector[1] + accVector[2] + accVector[3];
+        }
+
+    for (int n_group = 0; n_group < num_out_groups; n_group++)
+        {
+            vst1q_f32(__phase_real, _phase_real[n_group]);
+            vst1q_f32(__phase_imag, _phase_imag[n_group]);
+            phase[n_group] = lv_cmake(__phase_real[0], __phase_imag[0]);
+        }
+
+    for(unsigned int n = neon_iters * 4; n < num_points; n++)
+        {
+            for (int n_group = 0; n_group < num_out_groups; n_group++)
+                {
+                    tmp16_ = in_common[n];
+                    tmp32_ = lv_cmake((float32_t)lv_creal(tmp16_), (float32_t)lv_cimag(tmp16_)) * phase[n_group];
+                    tmp16_ = lv_cmake((int16_t)rintf(lv_creal(tmp32_)), (int16_t)rintf(lv_cimag(tmp32_)));
+                    phase[n_group] *= phase_inc[n_group];
+                    for (int n_vec = n_group * num_a_vectors; n_vec < (n_group + 1) * num_a_vectors; n_vec++)
+                        {
+                            acc_real[n_vec] += (int32_t)lv_creal(tmp16_) * lv_creal(in_a[n_vec][n]) - (int32_t)lv_cimag(tmp16_) * lv_cimag(in_a[n_vec][n]);
+                            acc_imag[n_vec] += (int32_t)lv_creal(tmp16_) * lv_cimag(in_a[n_vec][n]) + (int32_t)lv_cimag(tmp16_) * lv_creal(in_a[n_vec][n]);
+                        }
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            result[n_vec] = lv_cmake(sat_s32_to_s16i(acc_real[n_vec]), sat_s32_to_s16i(acc_imag[n_vec]));
+        }
+    volk_gnsssdr_free(phase_regs);
+    volk_gnsssdr_free(accumulator);
+    volk_gnsssdr_free(acc);
+}
+
+#endif /* LV_HAVE_NEON */
+
+#endif /*INCLUDED_volk_gnsssdr_16ic_x2_rotator_dot_prod_16ic_xn_xm_H*/
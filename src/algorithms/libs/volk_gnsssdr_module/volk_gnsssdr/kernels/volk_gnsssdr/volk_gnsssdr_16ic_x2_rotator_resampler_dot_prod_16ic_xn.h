@@ -0,0 +1,651 @@
+/*!
+ * \file volk_gnsssdr_16ic_x2_rotator_resampler_dot_prod_16ic_xn.h
+ * \brief VOLK_GNSSSDR kernel: resamples a 16 bits local code into N taps and
+ * correlates them with a phase-rotated common vector, accumulating in 32 bits.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * volk_gnsssdr_16ic_x2_rotator_resampler_dot_prod_16ic_xn does the work of the
+ * resampler and of the rotator dot product kernels in a single pass. The N resampled
+ * code replicas are generated on the fly inside the correlation loop instead of being
+ * written to memory and read back. The products are accumulated in 32 bits integers
+ * and saturated to 16 bits only once, when the results are stored.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+/*!
+ * \page volk_gnsssdr_16ic_x2_rotator_resampler_dot_prod_16ic_xn
+ *
+ * \b Overview
+ *
+ * Rotates the reference complex vector at a fixed rate per sample, from an initial \p phase offset,
+ * and multiplies it by \p num_out_vectors replicas of \p local_code resampled with a common code phase
+ * step and a different code phase offset each. The products are accumulated and stored in the output vector.
+ * The sample n of replica k is local_code[floor(code_phase_step_chips * n + rem_code_phase_chips[k])].
+ * WARNING: the code phase cannot reach more than twice the length of \p local_code, either positive or negative.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_gnsssdr_16ic_x2_rotator_resampler_dot_prod_16ic_xn(lv_16sc_t* result, const lv_16sc_t* in_common, const lv_32fc_t phase_inc, lv_32fc_t* phase, const lv_16sc_t* local_code, const float* rem_code_phase_chips, float code_phase_step_chips, unsigned int code_length_chips, int num_out_vectors, unsigned int num_points)
+ * \endcode
+ *
+ * \b Inputs
+ * \li in_common:             Pointer to the vector to be rotated, multiplied and accumulated (reference vector).
+ * \li phase_inc:             Phase increment = lv_cmake(cos(phase_step_rad), sin(phase_step_rad))
+ * \li phase:                 Initial phase = lv_cmake(cos(initial_phase_rad), sin(initial_phase_rad))
+ * \li local_code:            Local code, one sample per chip.
+ * \li rem_code_phase_chips:  Code phase of the first sample of each replica [chips].
+ * \li code_phase_step_chips: Phase increment per sample [chips/sample].
+ * \li code_length_chips:     Code length in chips.
+ * \li num_out_vectors:       Number of replicas (correlator taps).
+ * \li num_points:            Number of complex values to be multiplied together, accumulated and stored into \p result.
+ *
+ * \b Outputs
+ * \li phase:                 Final phase.
+ * \li result:                Vector of \p num_out_vectors components with the correlation of the rotated \p in_common with each replica.
+ *
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_16ic_x2_rotator_resampler_dot_prod_16ic_xn_H
+#define INCLUDED_volk_gnsssdr_16ic_x2_rotator_resampler_dot_prod_16ic_xn_H
+
+
+#include <volk_gnsssdr/volk_gnsssdr.h>
+#include <volk_gnsssdr/volk_gnsssdr_malloc.h>
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+#include <volk_gnsssdr/saturation_arithmetic.h>
+#include <math.h>
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_gnsssdr_16ic_x2_rotator_resampler_dot_prod_16ic_xn_generic(lv_16sc_t* result, const lv_16sc_t* in_common, const lv_32fc_t phase_inc, lv_32fc_t* phase, const lv_16sc_t* local_code, const float* rem_code_phase_chips, float code_phase_step_chips, unsigned int code_length_chips, int num_out_vectors, unsigned int num_points)
+{
+    lv_16sc_t tmp16, code;
+    lv_32fc_t tmp32;
+    int local_code_chip_index;
+    const unsigned int ROTATOR_RELOAD = 256;
+
+    int32_t* acc = (int32_t*)volk_gnsssdr_malloc(2 * num_out_vectors * sizeof(int32_t), volk_gnsssdr_get_alignment());
+    int32_t* acc_real = acc;
+    int32_t* acc_imag = acc + num_out_vectors;
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            acc_real[n_vec] = 0;
+            acc_imag[n_vec] = 0;
+        }
+
+    for (unsigned int n = 0; n < num_points; n++)
+        {
+            tmp16 = *in_common++;
+            tmp32 = lv_cmake((float)lv_creal(tmp16), (float)lv_cimag(tmp16)) * (*phase);
+            tmp16 = lv_cmake((int16_t)rintf(lv_creal(tmp32)), (int16_t)rintf(lv_cimag(tmp32)));
+            (*phase) *= phase_inc;
+
+            for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+                {
+                    // resample code for current tap
+                    local_code_chip_index = (int)floorf(code_phase_step_chips * (float)n + rem_code_phase_chips[n_vec]);
+                    if (local_code_chip_index < 0) local_code_chip_index += code_length_chips;
+                    if (local_code_chip_index > (int)code_length_chips - 1) local_code_chip_index -= code_length_chips;
+                    code = local_code[local_code_chip_index];
+
+                    acc_real[n_vec] += (int32_t)lv_creal(tmp16) * lv_creal(code) - (int32_t)lv_cimag(tmp16) * lv_cimag(code);
+                    acc_imag[n_vec] += (int32_t)lv_creal(tmp16) * lv_cimag(code) + (int32_t)lv_cimag(tmp16) * lv_creal(code);
+                }
+
+            // Regenerate phase
+            if ((n % ROTATOR_RELOAD) == ROTATOR_RELOAD - 1)
+                {
+#ifdef __cplusplus
+                    (*phase) /= std::abs((*phase));
+#else
+                    (*phase) /= hypotf(lv_creal(*phase), lv_cimag(*phase));
+#endif
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            result[n_vec] = lv_cmake(sat_s32_to_s16i(acc_real[n_vec]), sat_s32_to_s16i(acc_imag[n_vec]));
+        }
+    volk_gnsssdr_free(acc);
+}
+
+#endif /*LV_HAVE_GENERIC*/
+
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void volk_gnsssdr_16ic_x2_rotator_resampler_dot_prod_16ic_xn_a_avx2(lv_16sc_t* result, const lv_16sc_t* in_common, const lv_32fc_t phase_inc, lv_32fc_t* phase, const lv_16sc_t* local_code, const float* rem_code_phase_chips, float code_phase_step_chips, unsigned int code_length_chips, int num_out_vectors, unsigned int num_points)
+{
+    const unsigned int avx2_iters = num_points / 8;
+    const unsigned int ROTATOR_RELOAD = 32; // iterations of 8 samples, as the 256 samples of the generic version
+
+    const lv_16sc_t* _in_common = in_common;
+    lv_32fc_t _phase = (*phase);
+    lv_16sc_t tmp16, code;
+    lv_32fc_t tmp32;
+    int local_code_chip_index;
+
+    __VOLK_ATTR_ALIGNED(32) int32_t accVector[8];
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t phase_lo[4];
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t phase_hi[4];
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t phase_inc8[4];
+
+    int32_t* acc = (int32_t*)volk_gnsssdr_malloc(2 * num_out_vectors * sizeof(int32_t), volk_gnsssdr_get_alignment());
+    int32_t* acc_real = acc;
+    int32_t* acc_imag = acc + num_out_vectors;
+    __m256i* acc_reg = (__m256i*)volk_gnsssdr_malloc(2 * num_out_vectors * sizeof(__m256i), 32);
+    __m256i* acc_real_reg = acc_reg;
+    __m256i* acc_imag_reg = acc_reg + num_out_vectors;
+    __m256* rem_code_phase_reg = (__m256*)volk_gnsssdr_malloc(num_out_vectors * sizeof(__m256), 32);
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            acc_real_reg[n_vec] = _mm256_setzero_si256();
+            acc_imag_reg[n_vec] = _mm256_setzero_si256();
+            rem_code_phase_reg[n_vec] = _mm256_set1_ps(rem_code_phase_chips[n_vec]);
+        }
+
+    // samples 0 to 3 and 4 to 7 of each iteration are rotated by phase_lo and phase_hi
+    lv_32fc_t phase_n = _phase;
+    for (int i = 0; i < 4; i++)
+        {
+            phase_lo[i] = phase_n;
+            phase_n *= phase_inc;
+        }
+    for (int i = 0; i < 4; i++)
+        {
+            phase_hi[i] = phase_n;
+            phase_n *= phase_inc;
+        }
+    lv_32fc_t phase_inc_8 = phase_inc * phase_inc;
+    phase_inc_8 *= phase_inc_8;
+    phase_inc_8 *= phase_inc_8;
+    for (int i = 0; i < 4; i++)
+        {
+            phase_inc8[i] = phase_inc_8;
+        }
+
+    __m256 phase_lo_reg = _mm256_load_ps((float*)phase_lo);
+    __m256 phase_hi_reg = _mm256_load_ps((float*)phase_hi);
+    const __m256 phase_inc8_reg = _mm256_load_ps((float*)phase_inc8);
+    const __m256 ylp = _mm256_moveldup_ps(phase_inc8_reg);
+    const __m256 yhp = _mm256_movehdup_ps(phase_inc8_reg);
+
+    const __m256 eights = _mm256_set1_ps(8.0f);
+    const __m256 code_phase_step_chips_reg = _mm256_set1_ps(code_phase_step_chips);
+    const __m256i zeros = _mm256_setzero_si256();
+    const __m256i code_length_chips_reg = _mm256_set1_epi32((int)code_length_chips);
+    const __m256i code_length_chips_minus1_reg = _mm256_set1_epi32((int)code_length_chips - 1);
+    const __m256i conj_sign = _mm256_set_epi16(-1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1);
+    __m256 indexn = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+
+    __m256i a, rotated, code_reg, index, mask;
+    __m256 sample_lo, sample_hi, yl, yh, tmp1, tmp2, code_phase;
+
+    for(unsigned int number = 0; number < avx2_iters; number++)
+        {
+            // Phase rotation on operand in_common starts here:
+            a = _mm256_load_si256((__m256i*)_in_common);
+            _in_common += 8;
+            sample_lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(a)));
+            sample_hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(a, 1)));
+
+            yl = _mm256_moveldup_ps(phase_lo_reg);
+            yh = _mm256_movehdup_ps(phase_lo_reg);
+            sample_lo = _mm256_addsub_ps(_mm256_mul_ps(sample_lo, yl), _mm256_mul_ps(_mm256_permute_ps(sample_lo, 0xB1), yh));
+            yl = _mm256_moveldup_ps(phase_hi_reg);
+            yh = _mm256_movehdup_ps(phase_hi_reg);
+            sample_hi = _mm256_addsub_ps(_mm256_mul_ps(sample_hi, yl), _mm256_mul_ps(_mm256_permute_ps(sample_hi, 0xB1), yh));
+
+            phase_lo_reg = _mm256_addsub_ps(_mm256_mul_ps(phase_lo_reg, ylp), _mm256_mul_ps(_mm256_permute_ps(phase_lo_reg, 0xB1), yhp));
+            phase_hi_reg = _mm256_addsub_ps(_mm256_mul_ps(phase_hi_reg, ylp), _mm256_mul_ps(_mm256_permute_ps(phase_hi_reg, 0xB1), yhp));
+
+            // round to nearest and pack back to 16 bits (packs works per lane: restore the sample order)
+            rotated = _mm256_packs_epi32(_mm256_cvtps_epi32(sample_lo), _mm256_cvtps_epi32(sample_hi));
+            rotated = _mm256_permute4x64_epi64(rotated, 0xD8);
+
+            code_phase = _mm256_mul_ps(code_phase_step_chips_reg, indexn);
+            for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+                {
+                    // resample code for current tap
+                    index = _mm256_cvtps_epi32(_mm256_floor_ps(_mm256_add_ps(code_phase, rem_code_phase_reg[n_vec])));
+                    mask = _mm256_cmpgt_epi32(zeros, index);
+                    index = _mm256_add_epi32(index, _mm256_and_si256(mask, code_length_chips_reg));
+                    mask = _mm256_cmpgt_epi32(index, code_length_chips_minus1_reg);
+                    index = _mm256_sub_epi32(index, _mm256_and_si256(mask, code_length_chips_reg));
+                    code_reg = _mm256_i32gather_epi32((const int*)local_code, index, 4);
+
+                    // real: sr * cr - si * ci, imag: sr * ci + si * cr, both in 32 bits
+                    acc_real_reg[n_vec] = _mm256_add_epi32(acc_real_reg[n_vec], _mm256_madd_epi16(rotated, _mm256_sign_epi16(code_reg, conj_sign)));
+                    code_reg = _mm256_or_si256(_mm256_slli_epi32(code_reg, 16), _mm256_srli_epi32(code_reg, 16));
+                    acc_imag_reg[n_vec] = _mm256_add_epi32(acc_imag_reg[n_vec], _mm256_madd_epi16(rotated, code_reg));
+                }
+            indexn = _mm256_add_ps(indexn, eights);
+
+            // Regenerate phase
+            if ((number % ROTATOR_RELOAD) == ROTATOR_RELOAD - 1)
+                {
+                    tmp1 = _mm256_mul_ps(phase_lo_reg, phase_lo_reg);
+                    tmp2 = _mm256_add_ps(tmp1, _mm256_permute_ps(tmp1, 0xB1));
+                    phase_lo_reg = _mm256_div_ps(phase_lo_reg, _mm256_sqrt_ps(tmp2));
+                    tmp1 = _mm256_mul_ps(phase_hi_reg, phase_hi_reg);
+                    tmp2 = _mm256_add_ps(tmp1, _mm256_permute_ps(tmp1, 0xB1));
+                    phase_hi_reg = _mm256_div_ps(phase_hi_reg, _mm256_sqrt_ps(tmp2));
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            _mm256_store_si256((__m256i*)accVector, acc_real_reg[n_vec]);
+            acc_real[n_vec] = accVector[0] + accVector[1] + accVector[2] + accVector[3] + accVector[4] + accVector[5] + accVector[6] + accVector[7];
+            _mm256_store_si256((__m256i*)accVector, acc_imag_reg[n_vec]);
+            acc_imag[n_vec] = accVector[0] + accVector[1] + accVector[2] + accVector[3] + accVector[4] + accVector[5] + accVector[6] + accVector[7];
+        }
+
+    _mm256_store_ps((float*)phase_lo, phase_lo_reg);
+    _phase = phase_lo[0];
+    _mm256_zeroupper();
+
+    for(unsigned int n = avx2_iters * 8; n < num_points; n++)
+        {
+            tmp16 = *_in_common++;
+            tmp32 = lv_cmake((float)lv_creal(tmp16), (float)lv_cimag(tmp16)) * _phase;
+            tmp16 = lv_cmake((int16_t)rintf(lv_creal(tmp32)), (int16_t)rintf(lv_cimag(tmp32)));
+            _phase *= phase_inc;
+            for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+                {
+                    local_code_chip_index = (int)floorf(code_phase_step_chips * (float)n + rem_code_phase_chips[n_vec]);
+                    if (local_code_chip_index < 0) local_code_chip_index += code_length_chips;
+                    if (local_code_chip_index > (int)code_length_chips - 1) local_code_chip_index -= code_length_chips;
+                    code = local_code[local_code_chip_index];
+
+                    acc_real[n_vec] += (int32_t)lv_creal(tmp16) * lv_creal(code) - (int32_t)lv_cimag(tmp16) * lv_cimag(code);
+                    acc_imag[n_vec] += (int32_t)lv_creal(tmp16) * lv_cimag(code) + (int32_t)lv_cimag(tmp16) * lv_creal(code);
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            result[n_vec] = lv_cmake(sat_s32_to_s16i(acc_real[n_vec]), sat_s32_to_s16i(acc_imag[n_vec]));
+        }
+    (*phase) = _phase;
+    volk_gnsssdr_free(rem_code_phase_reg);
+    volk_gnsssdr_free(acc_reg);
+    volk_gnsssdr_free(acc);
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void volk_gnsssdr_16ic_x2_rotator_resampler_dot_prod_16ic_xn_u_avx2(lv_16sc_t* result, const lv_16sc_t* in_common, const lv_32fc_t phase_inc, lv_32fc_t* phase, const lv_16sc_t* local_code, const float* rem_code_phase_chips, float code_phase_step_chips, unsigned int code_length_chips, int num_out_vectors, unsigned int num_points)
+{
+    const unsigned int avx2_iters = num_points / 8;
+    const unsigned int ROTATOR_RELOAD = 32; // iterations of 8 samples, as the 256 samples of the generic version
+
+    const lv_16sc_t* _in_common = in_common;
+    lv_32fc_t _phase = (*phase);
+    lv_16sc_t tmp16, code;
+    lv_32fc_t tmp32;
+    int local_code_chip_index;
+
+    __VOLK_ATTR_ALIGNED(32) int32_t accVector[8];
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t phase_lo[4];
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t phase_hi[4];
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t phase_inc8[4];
+
+    int32_t* acc = (int32_t*)volk_gnsssdr_malloc(2 * num_out_vectors * sizeof(int32_t), volk_gnsssdr_get_alignment());
+    int32_t* acc_real = acc;
+    int32_t* acc_imag = acc + num_out_vectors;
+    __m256i* acc_reg = (__m256i*)volk_gnsssdr_malloc(2 * num_out_vectors * sizeof(__m256i), 32);
+    __m256i* acc_real_reg = acc_reg;
+    __m256i* acc_imag_reg = acc_reg + num_out_vectors;
+    __m256* rem_code_phase_reg = (__m256*)volk_gnsssdr_malloc(num_out_vectors * sizeof(__m256), 32);
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            acc_real_reg[n_vec] = _mm256_setzero_si256();
+            acc_imag_reg[n_vec] = _mm256_setzero_si256();
+            rem_code_phase_reg[n_vec] = _mm256_set1_ps(rem_code_phase_chips[n_vec]);
+        }
+
+    // samples 0 to 3 and 4 to 7 of each iteration are rotated by phase_lo and phase_hi
+    lv_32fc_t phase_n = _phase;
+    for (int i = 0; i < 4; i++)
+        {
+            phase_lo[i] = phase_n;
+            phase_n *= phase_inc;
+        }
+    for (int i = 0; i < 4; i++)
+        {
+            phase_hi[i] = phase_n;
+            phase_n *= phase_inc;
+        }
+    lv_32fc_t phase_inc_8 = phase_inc * phase_inc;
+    phase_inc_8 *= phase_inc_8;
+    phase_inc_8 *= phase_inc_8;
+    for (int i = 0; i < 4; i++)
+        {
+            phase_inc8[i] = phase_inc_8;
+        }
+
+    __m256 phase_lo_reg = _mm256_load_ps((float*)phase_lo);
+    __m256 phase_hi_reg = _mm256_load_ps((float*)phase_hi);
+    const __m256 phase_inc8_reg = _mm256_load_ps((float*)phase_inc8);
+    const __m256 ylp = _mm256_moveldup_ps(phase_inc8_reg);
+    const __m256 yhp = _mm256_movehdup_ps(phase_inc8_reg);
+
+    const __m256 eights = _mm256_set1_ps(8.0f);
+    const __m256 code_phase_step_chips_reg = _mm256_set1_ps(code_phase_step_chips);
+    const __m256i zeros = _mm256_setzero_si256();
+    const __m256i code_length_chips_reg = _mm256_set1_epi32((int)code_length_chips);
+    const __m256i code_length_chips_minus1_reg = _mm256_set1_epi32((int)code_length_chips - 1);
+    const __m256i conj_sign = _mm256_set_epi16(-1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1);
+    __m256 indexn = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+
+    __m256i a, rotated, code_reg, index, mask;
+    __m256 sample_lo, sample_hi, yl, yh, tmp1, tmp2, code_phase;
+
+    for(unsigned int number = 0; number < avx2_iters; number++)
+        {
+            // Phase rotation on operand in_common starts here:
+            a = _mm256_loadu_si256((__m256i*)_in_common);
+            _in_common += 8;
+            sample_lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(a)));
+            sample_hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(a, 1)));
+
+            yl = _mm256_moveldup_ps(phase_lo_reg);
+            yh = _mm256_movehdup_ps(phase_lo_reg);
+            sample_lo = _mm256_addsub_ps(_mm256_mul_ps(sample_lo, yl), _mm256_mul_ps(_mm256_permute_ps(sample_lo, 0xB1), yh));
+            yl = _mm256_moveldup_ps(phase_hi_reg);
+            yh = _mm256_movehdup_ps(phase_hi_reg);
+            sample_hi = _mm256_addsub_ps(_mm256_mul_ps(sample_hi, yl), _mm256_mul_ps(_mm256_permute_ps(sample_hi, 0xB1), yh));
+
+            phase_lo_reg = _mm256_addsub_ps(_mm256_mul_ps(phase_lo_reg, ylp), _mm256_mul_ps(_mm256_permute_ps(phase_lo_reg, 0xB1), yhp));
+            phase_hi_reg = _mm256_addsub_ps(_mm256_mul_ps(phase_hi_reg, ylp), _mm256_mul_ps(_mm256_permute_ps(phase_hi_reg, 0xB1), yhp));
+
+            // round to nearest and pack back to 16 bits (packs works per lane: restore the sample order)
+            rotated = _mm256_packs_epi32(_mm256_cvtps_epi32(sample_lo), _mm256_cvtps_epi32(sample_hi));
+            rotated = _mm256_permute4x64_epi64(rotated, 0xD8);
+
+            code_phase = _mm256_mul_ps(code_phase_step_chips_reg, indexn);
+            for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+                {
+                    // resample code for current tap
+                    index = _mm256_cvtps_epi32(_mm256_floor_ps(_mm256_add_ps(code_phase, rem_code_phase_reg[n_vec])));
+                    mask = _mm256_cmpgt_epi32(zeros, index);
+                    index = _mm256_add_epi32(index, _mm256_and_si256(mask, code_length_chips_reg));
+                    mask = _mm256_cmpgt_epi32(index, code_length_chips_minus1_reg);
+                    index = _mm256_sub_epi32(index, _mm256_and_si256(mask, code_length_chips_reg));
+                    code_reg = _mm256_i32gather_epi32((const int*)local_code, index, 4);
+
+                    // real: sr * cr - si * ci, imag: sr * ci + si * cr, both in 32 bits
+                    acc_real_reg[n_vec] = _mm256_add_epi32(acc_real_reg[n_vec], _mm256_madd_epi16(rotated, _mm256_sign_epi16(code_reg, conj_sign)));
+                    code_reg = _mm256_or_si256(_mm256_slli_epi32(code_reg, 16), _mm256_srli_epi32(code_reg, 16));
+                    acc_imag_reg[n_vec] = _mm256_add_epi32(acc_imag_reg[n_vec], _mm256_madd_epi16(rotated, code_reg));
+                }
+            indexn = _mm256_add_ps(indexn, eights);
+
+            // Regenerate phase
+            if ((number % ROTATOR_RELOAD) == ROTATOR_RELOAD - 1)
+                {
+                    tmp1 = _mm256_mul_ps(phase_lo_reg, phase_lo_reg);
+                    tmp2 = _mm256_add_ps(tmp1, _mm256_permute_ps(tmp1, 0xB1));
+                    phase_lo_reg = _mm256_div_ps(phase_lo_reg, _mm256_sqrt_ps(tmp2));
+                    tmp1 = _mm256_mul_ps(phase_hi_reg, phase_hi_reg);
+                    tmp2 = _mm256_add_ps(tmp1, _mm256_permute_ps(tmp1, 0xB1));
+                    phase_hi_reg = _mm256_div_ps(phase_hi_reg, _mm256_sqrt_ps(tmp2));
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            _mm256_store_si256((__m256i*)accVector, acc_real_reg[n_vec]);
+            acc_real[n_vec] = accVector[0] + accVector[1] + accVector[2] + accVector[3] + accVector[4] + accVector[5] + accVector[6] + accVector[7];
+            _mm256_store_si256((__m256i*)accVector, acc_imag_reg[n_vec]);
+            acc_imag[n_vec] = accVector[0] + accVector[1] + accVector[2] + accVector[3] + accVector[4] + accVector[5] + accVector[6] + accVector[7];
+        }
+
+    _mm256_store_ps((float*)phase_lo, phase_lo_reg);
+    _phase = phase_lo[0];
+    _mm256_zeroupper();
+
+    for(unsigned int n = avx2_iters * 8; n < num_points; n++)
+        {
+            tmp16 = *_in_common++;
+            tmp32 = lv_cmake((float)lv_creal(tmp16), (float)lv_cimag(tmp16)) * _phase;
+            tmp16 = lv_cmake((int16_t)rintf(lv_creal(tmp32)), (int16_t)rintf(lv_cimag(tmp32)));
+            _phase *= phase_inc;
+            for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+                {
+                    local_code_chip_index = (int)floorf(code_phase_step_chips * (float)n + rem_code_phase_chips[n_vec]);
+                    if (local_code_chip_index < 0) local_code_chip_index += code_length_chips;
+                    if (local_code_chip_index > (int)code_length_chips - 1) local_code_chip_index -= code_length_chips;
+                    code = local_code[local_code_chip_index];
+
+                    acc_real[n_vec] += (int32_t)lv_creal(tmp16) * lv_creal(code) - (int32_t)lv_cimag(tmp16) * lv_cimag(code);
+                    acc_imag[n_vec] += (int32_t)lv_creal(tmp16) * lv_cimag(code) + (int32_t)lv_cimag(tmp16) * lv_creal(code);
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            result[n_vec] = lv_cmake(sat_s32_to_s16i(acc_real[n_vec]), sat_s32_to_s16i(acc_imag[n_vec]));
+        }
+    (*phase) = _phase;
+    volk_gnsssdr_free(rem_code_phase_reg);
+    volk_gnsssdr_free(acc_reg);
+    volk_gnsssdr_free(acc);
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_16ic_x2_rotator_resampler_dot_prod_16ic_xn_neon(lv_16sc_t* result, const lv_16sc_t* in_common, const lv_32fc_t phase_inc, lv_32fc_t* phase, const lv_16sc_t* local_code, const float* rem_code_phase_chips, float code_phase_step_chips, unsigned int code_length_chips, int num_out_vectors, unsigned int num_points)
+{
+    const unsigned int neon_iters = num_points / 4;
+    const unsigned int ROTATOR_RELOAD = 64; // iterations of 4 samples, as the 256 samples of the generic version
+
+    const lv_16sc_t* _in_common = in_common;
+    lv_32fc_t _phase = (*phase);
+    lv_16sc_t tmp16_, code;
+    lv_32fc_t tmp32_;
+    int local_code_chip_index_;
+
+    __VOLK_ATTR_ALIGNED(16) int32_t local_code_chip_index[4];
+    __VOLK_ATTR_ALIGNED(16) lv_16sc_t code_samples[4];
+    __VOLK_ATTR_ALIGNED(16) int32_t accVector[4];
+
+    int32_t* acc = (int32_t*)volk_gnsssdr_malloc(2 * num_out_vectors * sizeof(int32_t), volk_gnsssdr_get_alignment());
+    int32_t* acc_real = acc;
+    int32_t* acc_imag = acc + num_out_vectors;
+    int32x4x2_t* accumulator = (int32x4x2_t*)volk_gnsssdr_malloc(num_out_vectors * sizeof(int32x4x2_t), volk_gnsssdr_get_alignment());
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            accumulator[n_vec].val[0] = vdupq_n_s32(0);
+            accumulator[n_vec].val[1] = vdupq_n_s32(0);
+        }
+
+    lv_32fc_t phase2 = _phase * phase_inc;
+    lv_32fc_t phase3 = phase2 * phase_inc;
+    lv_32fc_t phase4 = phase3 * phase_inc;
+    lv_32fc_t ___phase4 = phase_inc * phase_inc * phase_inc * phase_inc;
+
+    __VOLK_ATTR_ALIGNED(16) float32_t __phase_real[4] = { lv_creal(_phase), lv_creal(phase2), lv_creal(phase3), lv_creal(phase4) };
+    __VOLK_ATTR_ALIGNED(16) float32_t __phase_imag[4] = { lv_cimag(_phase), lv_cimag(phase2), lv_cimag(phase3), lv_cimag(phase4) };
+    __VOLK_ATTR_ALIGNED(16) const float32_t __vec[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+
+    float32x4_t _phase_real = vld1q_f32(__phase_real);
+    float32x4_t _phase_imag = vld1q_f32(__phase_imag);
+    const float32x4_t _phase4_real = vdupq_n_f32(lv_creal(___phase4));
+    const float32x4_t _phase4_imag = vdupq_n_f32(lv_cimag(___phase4));
+
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    const float32x4_t fours = vdupq_n_f32(4.0f);
+    const float32x4_t code_phase_step_chips_reg = vdupq_n_f32(code_phase_step_chips);
+    const int32x4_t zeros = vdupq_n_s32(0);
+    const int32x4_t code_length_chips_reg = vdupq_n_s32((int32_t)code_length_chips);
+    const int32x4_t code_length_chips_minus1_reg = vdupq_n_s32((int32_t)code_length_chips - 1);
+    float32x4_t indexn = vld1q_f32(__vec);
+
+    int16x4x2_t tmp16, code_val;
+    int32x4x2_t tmp32i;
+    float32x4x2_t tmp32f, tmp32_real, tmp32_imag;
+    float32x4_t sign, PlusHalf, Round, code_phase, aux, mag2, inv_mag;
+    int32x4_t index;
+
+    for(unsigned int number = 0; number < neon_iters; number++)
+        {
+            /* load 4 complex numbers (int 16 bits each component) and promote them to float 32 bits */
+            tmp16 = vld2_s16((int16_t*)_in_common);
+            __builtin_prefetch(_in_common + 8);
+            _in_common += 4;
+            tmp32f.val[0] = vcvtq_f32_s32(vmovl_s16(tmp16.val[0]));
+            tmp32f.val[1] = vcvtq_f32_s32(vmovl_s16(tmp16.val[1]));
+
+            /* complex multiplication of four complex samples (float 32 bits each component) */
+            tmp32_real.val[0] = vmulq_f32(tmp32f.val[0], _phase_real);
+            tmp32_real.val[1] = vmulq_f32(tmp32f.val[1], _phase_imag);
+            tmp32_imag.val[0] = vmulq_f32(tmp32f.val[0], _phase_imag);
+            tmp32_imag.val[1] = vmulq_f32(tmp32f.val[1], _phase_real);
+
+            tmp32f.val[0] = vsubq_f32(tmp32_real.val[0], tmp32_real.val[1]);
+            tmp32f.val[1] = vaddq_f32(tmp32_imag.val[0], tmp32_imag.val[1]);
+
+            /* downcast results to int32, rounding to nearest */
+            sign = vcvtq_f32_u32((vshrq_n_u32(vreinterpretq_u32_f32(tmp32f.val[0]), 31)));
+            PlusHalf = vaddq_f32(tmp32f.val[0], half);
+            Round = vsubq_f32(PlusHalf, sign);
+            tmp32i.val[0] = vcvtq_s32_f32(Round);
+
+            sign = vcvtq_f32_u32((vshrq_n_u32(vreinterpretq_u32_f32(tmp32f.val[1]), 31)));
+            PlusHalf = vaddq_f32(tmp32f.val[1], half);
+            Round = vsubq_f32(PlusHalf, sign);
+            tmp32i.val[1] = vcvtq_s32_f32(Round);
+
+            /* downcast results to int16 */
+            tmp16.val[0] = vqmovn_s32(tmp32i.val[0]);
+            tmp16.val[1] = vqmovn_s32(tmp32i.val[1]);
+
+            /* compute next four phases */
+            tmp32_real.val[0] = vmulq_f32(_phase_real, _phase4_real);
+            tmp32_real.val[1] = vmulq_f32(_phase_imag, _phase4_imag);
+            tmp32_imag.val[0] = vmulq_f32(_phase_real, _phase4_imag);
+            tmp32_imag.val[1] = vmulq_f32(_phase_imag, _phase4_real);
+
+            _phase_real = vsubq_f32(tmp32_real.val[0], tmp32_real.val[1]);
+            _phase_imag = vaddq_f32(tmp32_imag.val[0], tmp32_imag.val[1]);
+
+            code_phase = vmulq_f32(code_phase_step_chips_reg, indexn);
+            for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+                {
+                    // resample code for current tap: floor, then wrap into [0, code_length_chips)
+                    aux = vaddq_f32(code_phase, vdupq_n_f32(rem_code_phase_chips[n_vec]));
+                    index = vcvtq_s32_f32(aux);
+                    index = vaddq_s32(index, vreinterpretq_s32_u32(vcgtq_f32(vcvtq_f32_s32(index), aux)));
+                    index = vaddq_s32(index, vandq_s32(code_length_chips_reg, vreinterpretq_s32_u32(vcltq_s32(index, zeros))));
+                    index = vsubq_s32(index, vandq_s32(code_length_chips_reg, vreinterpretq_s32_u32(vcgtq_s32(index, code_length_chips_minus1_reg))));
+                    vst1q_s32(local_code_chip_index, index);
+
+                    code_samples[0] = local_code[local_code_chip_index[0]];
+                    code_samples[1] = local_code[local_code_chip_index[1]];
+                    code_samples[2] = local_code[local_code_chip_index[2]];
+                    code_samples[3] = local_code[local_code_chip_index[3]];
+                    code_val = vld2_s16((int16_t*)code_samples);
+
+                    // widening multiply-accumulate: no saturation in the loop
+                    accumulator[n_vec].val[0] = vmlal_s16(accumulator[n_vec].val[0], tmp16.val[0], code_val.val[0]);
+                    accumulator[n_vec].val[0] = vmlsl_s16(accumulator[n_vec].val[0], tmp16.val[1], code_val.val[1]);
+                    accumulator[n_vec].val[1] = vmlal_s16(accumulator[n_vec].val[1], tmp16.val[0], code_val.val[1]);
+                    accumulator[n_vec].val[1] = vmlal_s16(accumulator[n_vec].val[1], tmp16.val[1], code_val.val[0]);
+                }
+            indexn = vaddq_f32(indexn, fours);
+
+            // Regenerate phase
+            if ((number % ROTATOR_RELOAD) == ROTATOR_RELOAD - 1)
+                {
+                    mag2 = vaddq_f32(vmulq_f32(_phase_real, _phase_real), vmulq_f32(_phase_imag, _phase_imag));
+                    inv_mag = vrsqrteq_f32(mag2);
+                    inv_mag = vmulq_f32(vrsqrtsq_f32(vmulq_f32(mag2, inv_mag), inv_mag), inv_mag);
+                    inv_mag = vmulq_f32(vrsqrtsq_f32(vmulq_f32(mag2, inv_mag), inv_mag), inv_mag);
+                    _phase_real = vmulq_f32(_phase_real, inv_mag);
+                    _phase_imag = vmulq_f32(_phase_imag, inv_mag);
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            vst1q_s32(accVector, accumulator[n_vec].val[0]);
+            acc_real[n_vec] = accVector[0] + accVector[1] + accVector[2] + accVector[3];
+            vst1q_s32(accVector, accumulator[n_vec].val[1]);
+            acc_imag[n_vec] = accVector[0] + accVector[1] + accVector[2] + accVector[3];
+        }
+
+    vst1q_f32(__phase_real, _phase_real);
+    vst1q_f32(__phase_imag, _phase_imag);
+    _phase = lv_cmake(__phase_real[0], __phase_imag[0]);
+
+    for(unsigned int n = neon_iters * 4; n < num_points; n++)
+        {
+            tmp16_ = *_in_common++;
+            tmp32_ = lv_cmake((float32_t)lv_creal(tmp16_), (float32_t)lv_cimag(tmp16_)) * _phase;
+            tmp16_ = lv_cmake((int16_t)rintf(lv_creal(tmp32_)), (int16_t)rintf(lv_cimag(tmp32_)));
+            _phase *= phase_inc;
+            for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+                {
+                    local_code_chip_index_ = (int)floorf(code_phase_step_chips * (float)n + rem_code_phase_chips[n_vec]);
+                    if (local_code_chip_index_ < 0) local_code_chip_index_ += code_length_chips;
+                    if (local_code_chip_index_ > (int)code_length_chips - 1) local_code_chip_index_ -= code_length_chips;
+                    code = local_code[local_code_chip_index_];
+
+                    acc_real[n_vec] += (int32_t)lv_creal(tmp16_) * lv_creal(code) - (int32_t)lv_cimag(tmp16_) * lv_cimag(code);
+                    acc_imag[n_vec] += (int32_t)lv_creal(tmp16_) * lv_cimag(code) + (int32_t)lv_cimag(tmp16_) * lv_creal(code);
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            result[n_vec] = lv_cmake(sat_s32_to_s16i(acc_real[n_vec]), sat_s32_to_s16i(acc_imag[n_vec]));
+        }
+    (*phase) = _phase;
+    volk_gnsssdr_free(accumulator);
+    volk_gnsssdr_free(acc);
+}
+
+#endif /* LV_HAVE_NEON */
+
+#endif /*INCLUDED_volk_gnsssdr_16ic_x2_rotator_resampler_dot_prod_16ic_xn_H*/
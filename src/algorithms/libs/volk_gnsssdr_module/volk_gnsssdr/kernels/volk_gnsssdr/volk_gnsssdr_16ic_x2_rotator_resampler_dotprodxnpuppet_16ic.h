@@ -0,0 +1,130 @@
+/*!
+ * \file volk_gnsssdr_16ic_x2_rotator_resampler_dotprodxnpuppet_16ic.h
+ * \brief Volk puppet for the fused resampler and multiple 16-bit complex dot product kernel.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * Volk puppet for integrating the fused resampler and dot product into volk's test system
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_16ic_x2_rotator_resampler_dotprodxnpuppet_16ic_H
+#define INCLUDED_volk_gnsssdr_16ic_x2_rotator_resampler_dotprodxnpuppet_16ic_H
+
+#include "volk_gnsssdr/volk_gnsssdr_16ic_x2_rotator_resampler_dot_prod_16ic_xn.h"
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+#include <volk_gnsssdr/volk_gnsssdr.h>
+#include <math.h>
+
+#ifdef LV_HAVE_GENERIC
+static inline void volk_gnsssdr_16ic_x2_rotator_resampler_dotprodxnpuppet_16ic_generic(lv_16sc_t* result, const lv_16sc_t* local_code, const lv_16sc_t* in, unsigned int num_points)
+{
+    // phases must be normalized. Phase rotator expects a complex exponential input!
+    float rem_carrier_phase_in_rad = 0.345;
+    float phase_step_rad = 0.1;
+    lv_32fc_t phase[1];
+    phase[0] = lv_cmake(cos(rem_carrier_phase_in_rad), sin(rem_carrier_phase_in_rad));
+    lv_32fc_t phase_inc[1];
+    phase_inc[0] = lv_cmake(cos(phase_step_rad), sin(phase_step_rad));
+
+    // the second input plays the role of a code of num_points chips
+    float code_phase_step_chips = 0.5;
+    int num_out_vectors = 3;
+    float rem_code_phase_chips[3] = { -0.734, -0.234, 0.266 };
+
+    volk_gnsssdr_16ic_x2_rotator_resampler_dot_prod_16ic_xn_generic(result, local_code, phase_inc[0], phase, in, rem_code_phase_chips, code_phase_step_chips, num_points, num_out_vectors, num_points);
+}
+
+#endif  // Generic
+
+
+#ifdef LV_HAVE_AVX2
+static inline void volk_gnsssdr_16ic_x2_rotator_resampler_dotprodxnpuppet_16ic_a_avx2(lv_16sc_t* result, const lv_16sc_t* local_code, const lv_16sc_t* in, unsigned int num_points)
+{
+    // phases must be normalized. Phase rotator expects a complex exponential input!
+    float rem_carrier_phase_in_rad = 0.345;
+    float phase_step_rad = 0.1;
+    lv_32fc_t phase[1];
+    phase[0] = lv_cmake(cos(rem_carrier_phase_in_rad), sin(rem_carrier_phase_in_rad));
+    lv_32fc_t phase_inc[1];
+    phase_inc[0] = lv_cmake(cos(phase_step_rad), sin(phase_step_rad));
+
+    // the second input plays the role of a code of num_points chips
+    float code_phase_step_chips = 0.5;
+    int num_out_vectors = 3;
+    float rem_code_phase_chips[3] = { -0.734, -0.234, 0.266 };
+
+    volk_gnsssdr_16ic_x2_rotator_resampler_dot_prod_16ic_xn_a_avx2(result, local_code, phase_inc[0], phase, in, rem_code_phase_chips, code_phase_step_chips, num_points, num_out_vectors, num_points);
+}
+
+#endif  // AVX2
+
+
+#ifdef LV_HAVE_AVX2
+static inline void volk_gnsssdr_16ic_x2_rotator_resampler_dotprodxnpuppet_16ic_u_avx2(lv_16sc_t* result, const lv_16sc_t* local_code, const lv_16sc_t* in, unsigned int num_points)
+{
+    // phases must be normalized. Phase rotator expects a complex exponential input!
+    float rem_carrier_phase_in_rad = 0.345;
+    float phase_step_rad = 0.1;
+    lv_32fc_t phase[1];
+    phase[0] = lv_cmake(cos(rem_carrier_phase_in_rad), sin(rem_carrier_phase_in_rad));
+    lv_32fc_t phase_inc[1];
+    phase_inc[0] = lv_cmake(cos(phase_step_rad), sin(phase_step_rad));
+
+    // the second input plays the role of a code of num_points chips
+    float code_phase_step_chips = 0.5;
+    int num_out_vectors = 3;
+    float rem_code_phase_chips[3] = { -0.734, -0.234, 0.266 };
+
+    volk_gnsssdr_16ic_x2_rotator_resampler_dot_prod_16ic_xn_u_avx2(result, local_code, phase_inc[0], phase, in, rem_code_phase_chips, code_phase_step_chips, num_points, num_out_vectors, num_points);
+}
+
+#endif  // AVX2
+
+
+#ifdef LV_HAVE_NEON
+static inline void volk_gnsssdr_16ic_x2_rotator_resampler_dotprodxnpuppet_16ic_neon(lv_16sc_t* result, const lv_16sc_t* local_code, const lv_16sc_t* in, unsigned int num_points)
+{
+    // phases must be normalized. Phase rotator expects a complex exponential input!
+    float rem_carrier_phase_in_rad = 0.345;
+    float phase_step_rad = 0.1;
+    lv_32fc_t phase[1];
+    phase[0] = lv_cmake(cos(rem_carrier_phase_in_rad), sin(rem_carrier_phase_in_rad));
+    lv_32fc_t phase_inc[1];
+    phase_inc[0] = lv_cmake(cos(phase_step_rad), sin(phase_step_rad));
+
+    // the second input plays the role of a code of num_points chips
+    float code_phase_step_chips = 0.5;
+    int num_out_vectors = 3;
+    float rem_code_phase_chips[3] = { -0.734, -0.234, 0.266 };
+
+    volk_gnsssdr_16ic_x2_rotator_resampler_dot_prod_16ic_xn_neon(result, local_code, phase_inc[0], phase, in, rem_code_phase_chips, code_phase_step_chips, num_points, num_out_vectors, num_points);
+}
+
+#endif  // NEON
+
+#endif  // INCLUDED_volk_gnsssdr_16ic_x2_rotator_resampler_dotprodxnpuppet_16ic_H
@@ -0,0 +1,275 @@
+/*!
+ * \file volk_gnsssdr_16ic_x2_sliding_dot_prod_32fc.h
+ * \brief VOLK_GNSSSDR kernel: correlates a 16 bits complex code with consecutive
+ * lags of a 16 bits complex input vector.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * VOLK_GNSSSDR kernel that computes the dot product of a code with the input vector
+ * delayed by 0, 1, ..., K-1 samples, i.e. K consecutive points of their cross-correlation.
+ * When only a few code phases have to be searched (e.g., around an assisted or a previously
+ * acquired code phase) this is cheaper than the FFT-based circular correlation of the whole code.
+ * The lags are computed four at a time, so that every chunk of the code is loaded once
+ * for the four of them. The products are accumulated in 32 bits integers.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+/*!
+ * \page volk_gnsssdr_16ic_x2_sliding_dot_prod_32fc
+ *
+ * \b Overview
+ *
+ * For each lag k from 0 to \p num_lags - 1, multiplies \p num_points samples of the input vector,
+ * starting at sample k, with the code vector and accumulates them:
+ * result[k] = sum_{n=0}^{num_points-1} in[n + k] * code[n]
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_gnsssdr_16ic_x2_sliding_dot_prod_32fc(lv_32fc_t* result, const lv_16sc_t* in, const lv_16sc_t* code, unsigned int num_lags, unsigned int num_points)
+ * \endcode
+ *
+ * \b Inputs
+ * \li in:            Input vector, of at least \p num_points + \p num_lags - 1 samples.
+ * \li code:          Code vector, of \p num_points samples.
+ * \li num_lags:      Number of consecutive lags to be computed.
+ * \li num_points:    Number of complex values to be multiplied together and accumulated for each lag.
+ *
+ * \b Outputs
+ * \li result:        Vector of \p num_lags dot products, one per lag.
+ *
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_16ic_x2_sliding_dot_prod_32fc_H
+#define INCLUDED_volk_gnsssdr_16ic_x2_sliding_dot_prod_32fc_H
+
+#include <volk_gnsssdr/volk_gnsssdr_common.h>
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_gnsssdr_16ic_x2_sliding_dot_prod_32fc_generic(lv_32fc_t* result, const lv_16sc_t* in, const lv_16sc_t* code, unsigned int num_lags, unsigned int num_points)
+{
+    unsigned int lag;
+    unsigned int n;
+    for (lag = 0; lag < num_lags; lag++)
+        {
+            const lv_16sc_t* in_lag = in + lag;
+            int32_t acc_real = 0;
+            int32_t acc_imag = 0;
+            for (n = 0; n < num_points; n++)
+                {
+                    acc_real += (int32_t)lv_creal(in_lag[n]) * (int32_t)lv_creal(code[n]) - (int32_t)lv_cimag(in_lag[n]) * (int32_t)lv_cimag(code[n]);
+                    acc_imag += (int32_t)lv_creal(in_lag[n]) * (int32_t)lv_cimag(code[n]) + (int32_t)lv_cimag(in_lag[n]) * (int32_t)lv_creal(code[n]);
+                }
+            result[lag] = lv_cmake((float)acc_real, (float)acc_imag);
+        }
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void volk_gnsssdr_16ic_x2_sliding_dot_prod_32fc_u_avx2(lv_32fc_t* result, const lv_16sc_t* in, const lv_16sc_t* code, unsigned int num_lags, unsigned int num_points)
+{
+    const unsigned int avx2_iters = num_points / 8;
+    const __m256i conj_sign = _mm256_set_epi16(-1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1);
+    __VOLK_ATTR_ALIGNED(32) int32_t real_vector[8];
+    __VOLK_ATTR_ALIGNED(32) int32_t imag_vector[8];
+    __m256i acc_real[4];
+    __m256i acc_imag[4];
+    __m256i c, c_real, c_imag, a;
+    unsigned int first_lag, lags, k, number, i;
+
+    for (first_lag = 0; first_lag < num_lags; first_lag += 4)
+        {
+            lags = num_lags - first_lag < 4 ? num_lags - first_lag : 4;
+            for (k = 0; k < lags; k++)
+                {
+                    acc_real[k] = _mm256_setzero_si256();
+                    acc_imag[k] = _mm256_setzero_si256();
+                }
+            for (number = 0; number < avx2_iters; number++)
+                {
+                    // (cr, -ci) and (ci, cr) pairs: madd with the input pairs gives the real and imaginary parts
+                    c = _mm256_loadu_si256((__m256i*)(code + 8 * number));
+                    c_real = _mm256_sign_epi16(c, conj_sign);
+                    c_imag = _mm256_or_si256(_mm256_slli_epi32(c, 16), _mm256_srli_epi32(c, 16));
+                    for (k = 0; k < lags; k++)
+                        {
+                            a = _mm256_loadu_si256((__m256i*)(in + first_lag + k + 8 * number));
+                            acc_real[k] = _mm256_add_epi32(acc_real[k], _mm256_madd_epi16(a, c_real));
+                            acc_imag[k] = _mm256_add_epi32(acc_imag[k], _mm256_madd_epi16(a, c_imag));
+                        }
+                }
+            for (k = 0; k < lags; k++)
+                {
+                    const lv_16sc_t* in_lag = in + first_lag + k;
+                    int32_t sum_real = 0;
+                    int32_t sum_imag = 0;
+                    _mm256_store_si256((__m256i*)real_vector, acc_real[k]);
+                    _mm256_store_si256((__m256i*)imag_vector, acc_imag[k]);
+                    for (i = 0; i < 8; i++)
+                        {
+                            sum_real += real_vector[i];
+                            sum_imag += imag_vector[i];
+                        }
+                    for (number = avx2_iters * 8; number < num_points; number++)
+                        {
+                            sum_real += (int32_t)lv_creal(in_lag[number]) * (int32_t)lv_creal(code[number]) - (int32_t)lv_cimag(in_lag[number]) * (int32_t)lv_cimag(code[number]);
+                            sum_imag += (int32_t)lv_creal(in_lag[number]) * (int32_t)lv_cimag(code[number]) + (int32_t)lv_cimag(in_lag[number]) * (int32_t)lv_creal(code[number]);
+                        }
+                    result[first_lag + k] = lv_cmake((float)sum_real, (float)sum_imag);
+                }
+        }
+    _mm256_zeroupper();
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void volk_gnsssdr_16ic_x2_sliding_dot_prod_32fc_a_avx2(lv_32fc_t* result, const lv_16sc_t* in, const lv_16sc_t* code, unsigned int num_lags, unsigned int num_points)
+{
+    // only the code is aligned, the lags of the input are necessarily read unaligned
+    const unsigned int avx2_iters = num_points / 8;
+    const __m256i conj_sign = _mm256_set_epi16(-1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1);
+    __VOLK_ATTR_ALIGNED(32) int32_t real_vector[8];
+    __VOLK_ATTR_ALIGNED(32) int32_t imag_vector[8];
+    __m256i acc_real[4];
+    __m256i acc_imag[4];
+    __m256i c, c_real, c_imag, a;
+    unsigned int first_lag, lags, k, number, i;
+
+    for (first_lag = 0; first_lag < num_lags; first_lag += 4)
+        {
+            lags = num_lags - first_lag < 4 ? num_lags - first_lag : 4;
+            for (k = 0; k < lags; k++)
+                {
+                    acc_real[k] = _mm256_setzero_si256();
+                    acc_imag[k] = _mm256_setzero_si256();
+                }
+            for (number = 0; number < avx2_iters; number++)
+                {
+                    c = _mm256_load_si256((__m256i*)(code + 8 * number));
+                    c_real = _mm256_sign_epi16(c, conj_sign);
+                    c_imag = _mm256_or_si256(_mm256_slli_epi32(c, 16), _mm256_srli_epi32(c, 16));
+                    for (k = 0; k < lags; k++)
+                        {
+                            a = _mm256_loadu_si256((__m256i*)(in + first_lag + k + 8 * number));
+                            acc_real[k] = _mm256_add_epi32(acc_real[k], _mm256_madd_epi16(a, c_real));
+                            acc_imag[k] = _mm256_add_epi32(acc_imag[k], _mm256_madd_epi16(a, c_imag));
+                        }
+                }
+            for (k = 0; k < lags; k++)
+                {
+                    const lv_16sc_t* in_lag = in + first_lag + k;
+                    int32_t sum_real = 0;
+                    int32_t sum_imag = 0;
+                    _mm256_store_si256((__m256i*)real_vector, acc_real[k]);
+                    _mm256_store_si256((__m256i*)imag_vector, acc_imag[k]);
+                    for (i = 0; i < 8; i++)
+                        {
+                            sum_real += real_vector[i];
+                            sum_imag += imag_vector[i];
+                        }
+                    for (number = avx2_iters * 8; number < num_points; number++)
+                        {
+                            sum_real += (int32_t)lv_creal(in_lag[number]) * (int32_t)lv_creal(code[number]) - (int32_t)lv_cimag(in_lag[number]) * (int32_t)lv_cimag(code[number]);
+                            sum_imag += (int32_t)lv_creal(in_lag[number]) * (int32_t)lv_cimag(code[number]) + (int32_t)lv_cimag(in_lag[number]) * (int32_t)lv_creal(code[number]);
+                        }
+                    result[first_lag + k] = lv_cmake((float)sum_real, (float)sum_imag);
+                }
+        }
+    _mm256_zeroupper();
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_16ic_x2_sliding_dot_prod_32fc_neon(lv_32fc_t* result, const lv_16sc_t* in, const lv_16sc_t* code, unsigned int num_lags, unsigned int num_points)
+{
+    const unsigned int neon_iters = num_points / 4;
+    __VOLK_ATTR_ALIGNED(16) int32_t real_vector[4];
+    __VOLK_ATTR_ALIGNED(16) int32_t imag_vector[4];
+    int32x4_t acc_real[4];
+    int32x4_t acc_imag[4];
+    int16x4x2_t c, a;
+    unsigned int first_lag, lags, k, number, i;
+
+    for (first_lag = 0; first_lag < num_lags; first_lag += 4)
+        {
+            lags = num_lags - first_lag < 4 ? num_lags - first_lag : 4;
+            for (k = 0; k < lags; k++)
+                {
+                    acc_real[k] = vdupq_n_s32(0);
+                    acc_imag[k] = vdupq_n_s32(0);
+                }
+            for (number = 0; number < neon_iters; number++)
+                {
+                    c = vld2_s16((int16_t*)(code + 4 * number));
+                    for (k = 0; k < lags; k++)
+                        {
+                            a = vld2_s16((int16_t*)(in + first_lag + k + 4 * number));
+                            acc_real[k] = vmlal_s16(acc_real[k], a.val[0], c.val[0]);
+                            acc_real[k] = vmlsl_s16(acc_real[k], a.val[1], c.val[1]);
+                            acc_imag[k] = vmlal_s16(acc_imag[k], a.val[0], c.val[1]);
+                            acc_imag[k] = vmlal_s16(acc_imag[k], a.val[1], c.val[0]);
+                        }
+                }
+            for (k = 0; k < lags; k++)
+                {
+                    const lv_16sc_t* in_lag = in + first_lag + k;
+                    int32_t sum_real = 0;
+                    int32_t sum_imag = 0;
+                    vst1q_s32(real_vector, acc_real[k]);
+                    vst1q_s32(imag_vector, acc_imag[k]);
+                    for (i = 0; i < 4; i++)
+                        {
+                            sum_real += real_vector[i];
+                            sum_imag += imag_vector[i];
+                        }
+                    for (number = neon_iters * 4; number < num_points; number++)
+                        {
+                            sum_real += (int32_t)lv_creal(in_lag[number]) * (int32_t)lv_creal(code[number]) - (int32_t)lv_cimag(in_lag[number]) * (int32_t)lv_cimag(code[number]);
+                            sum_imag += (int32_t)lv_creal(in_lag[number]) * (int32_t)lv_cimag(code[number]) + (int32_t)lv_cimag(in_lag[number]) * (int32_t)lv_creal(code[number]);
+                        }
+                    result[first_lag + k] = lv_cmake((float)sum_real, (float)sum_imag);
+                }
+        }
+}
+
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_gnsssdr_16ic_x2_sliding_dot_prod_32fc_H */
@@ -0,0 +1,202 @@
+/*!
+ * \file volk_gnsssdr_16ic_xn_weighted_sum_16ic.h
+ * \brief VOLK_GNSSSDR kernel: sums N 16 bits complex vectors, each one
+ * multiplied by its own floating point complex weight.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * VOLK_GNSSSDR kernel that combines the short complex channels of an
+ * antenna array into one output (spatial filtering, beamforming)
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+/*!
+ * \page volk_gnsssdr_16ic_xn_weighted_sum_16ic
+ *
+ * \b Overview
+ *
+ * Computes result[n] = sum_k weights[k] * in[k][n], for k from 0 to
+ * num_in_vectors - 1. The sum is accumulated in floating point and then
+ * rounded to the nearest integer and saturated to the 16 bits range, so
+ * the weights are not limited to integers.
+ *
+ * There are no aligned versions: the dispatcher would only check the
+ * alignment of the array of pointers, not of the vectors it points to.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_gnsssdr_16ic_xn_weighted_sum_16ic(lv_16sc_t* result, const lv_16sc_t** in, const lv_32fc_t* weights, int num_in_vectors, unsigned int num_points);
+ * \endcode
+ *
+ * \b Inputs
+ * \li in:             Pointer to an array of pointers to the vectors to be combined.
+ * \li weights:        The num_in_vectors complex weights.
+ * \li num_in_vectors: Number of vectors in \p in.
+ * \li num_points:     Number of complex values in each vector.
+ *
+ * \b Outputs
+ * \li result:         The num_points weighted sums.
+ *
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_16ic_xn_weighted_sum_16ic_H
+#define INCLUDED_volk_gnsssdr_16ic_xn_weighted_sum_16ic_H
+
+#include <limits.h>
+#include <math.h>
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+
+
+static inline int16_t volk_gnsssdr_16ic_xn_weighted_sum_16ic_round(float x)
+{
+    if (x > (float)SHRT_MAX)
+        {
+            x = (float)SHRT_MAX;
+        }
+    else if (x < (float)SHRT_MIN)
+        {
+            x = (float)SHRT_MIN;
+        }
+    return (int16_t)rintf(x);
+}
+
+
+static inline lv_16sc_t volk_gnsssdr_16ic_xn_weighted_sum_16ic_point(const lv_16sc_t** in, const lv_32fc_t* weights, int num_in_vectors, unsigned int n)
+{
+    float sum_real = 0.0f;
+    float sum_imag = 0.0f;
+    for (int k = 0; k < num_in_vectors; k++)
+        {
+            const float x_real = (float)lv_creal(in[k][n]);
+            const float x_imag = (float)lv_cimag(in[k][n]);
+            sum_real += x_real * lv_creal(weights[k]) - x_imag * lv_cimag(weights[k]);
+            sum_imag += x_imag * lv_creal(weights[k]) + x_real * lv_cimag(weights[k]);
+        }
+    return lv_cmake(volk_gnsssdr_16ic_xn_weighted_sum_16ic_round(sum_real), volk_gnsssdr_16ic_xn_weighted_sum_16ic_round(sum_imag));
+}
+
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_gnsssdr_16ic_xn_weighted_sum_16ic_generic(lv_16sc_t* result, const lv_16sc_t** in, const lv_32fc_t* weights, int num_in_vectors, unsigned int num_points)
+{
+    for (unsigned int n = 0; n < num_points; n++)
+        {
+            result[n] = volk_gnsssdr_16ic_xn_weighted_sum_16ic_point(in, weights, num_in_vectors, n);
+        }
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+
+#ifdef LV_HAVE_SSE3
+#include <pmmintrin.h>
+
+static inline void volk_gnsssdr_16ic_xn_weighted_sum_16ic_u_sse3(lv_16sc_t* result, const lv_16sc_t** in, const lv_32fc_t* weights, int num_in_vectors, unsigned int num_points)
+{
+    const unsigned int sse_iters = num_points / 4;
+    const __m128 max_val = _mm_set1_ps((float)SHRT_MAX);
+    const __m128 min_val = _mm_set1_ps((float)SHRT_MIN);
+    __m128i x;
+    __m128 x_lo, x_hi, w_real, w_imag, acc_lo, acc_hi;
+
+    for (unsigned int number = 0; number < sse_iters; number++)
+        {
+            acc_lo = _mm_setzero_ps();
+            acc_hi = _mm_setzero_ps();
+            for (int k = 0; k < num_in_vectors; k++)
+                {
+                    w_real = _mm_set1_ps(lv_creal(weights[k]));
+                    w_imag = _mm_set1_ps(lv_cimag(weights[k]));
+                    x = _mm_loadu_si128((const __m128i*)(in[k] + 4 * number)); // four short complex samples of channel k
+                    // sign extend to 32 bits and convert, two complex samples per register
+                    x_lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+                    x_hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+                    acc_lo = _mm_add_ps(acc_lo, _mm_addsub_ps(_mm_mul_ps(x_lo, w_real), _mm_mul_ps(_mm_shuffle_ps(x_lo, x_lo, 0xB1), w_imag)));
+                    acc_hi = _mm_add_ps(acc_hi, _mm_addsub_ps(_mm_mul_ps(x_hi, w_real), _mm_mul_ps(_mm_shuffle_ps(x_hi, x_hi, 0xB1), w_imag)));
+                }
+            // round to nearest (the default MXCSR mode, as rintf) and pack with saturation
+            acc_lo = _mm_min_ps(_mm_max_ps(acc_lo, min_val), max_val);
+            acc_hi = _mm_min_ps(_mm_max_ps(acc_hi, min_val), max_val);
+            _mm_storeu_si128((__m128i*)(result + 4 * number), _mm_packs_epi32(_mm_cvtps_epi32(acc_lo), _mm_cvtps_epi32(acc_hi)));
+        }
+
+    for (unsigned int n = sse_iters * 4; n < num_points; n++)
+        {
+            result[n] = volk_gnsssdr_16ic_xn_weighted_sum_16ic_point(in, weights, num_in_vectors, n);
+        }
+}
+
+#endif /* LV_HAVE_SSE3 */
+
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_16ic_xn_weighted_sum_16ic_neon(lv_16sc_t* result, const lv_16sc_t** in, const lv_32fc_t* weights, int num_in_vectors, unsigned int num_points)
+{
+    const unsigned int neon_iters = num_points / 4;
+    const float32x4_t max_val = vdupq_n_f32((float)SHRT_MAX);
+    const float32x4_t min_val = vdupq_n_f32((float)SHRT_MIN);
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    int16x4x2_t x, out;
+    float32x4_t x_real, x_imag, w_real, w_imag, acc_real, acc_imag;
+
+    for (unsigned int number = 0; number < neon_iters; number++)
+        {
+            acc_real = vdupq_n_f32(0.0f);
+            acc_imag = vdupq_n_f32(0.0f);
+            for (int k = 0; k < num_in_vectors; k++)
+                {
+                    w_real = vdupq_n_f32(lv_creal(weights[k]));
+                    w_imag = vdupq_n_f32(lv_cimag(weights[k]));
+                    x = vld2_s16((const int16_t*)(in[k] + 4 * number)); // deinterleaved: val[0] real, val[1] imag
+                    x_real = vcvtq_f32_s32(vmovl_s16(x.val[0]));
+                    x_imag = vcvtq_f32_s32(vmovl_s16(x.val[1]));
+                    acc_real = vmlaq_f32(acc_real, x_real, w_real);
+                    acc_real = vmlsq_f32(acc_real, x_imag, w_imag);
+                    acc_imag = vmlaq_f32(acc_imag, x_imag, w_real);
+                    acc_imag = vmlaq_f32(acc_imag, x_real, w_imag);
+                }
+            acc_real = vminq_f32(vmaxq_f32(acc_real, min_val), max_val);
+            acc_imag = vminq_f32(vmaxq_f32(acc_imag, min_val), max_val);
+            // vcvtq truncates: round half away from zero, rintf only differs on exact ties
+            out.val[0] = vmovn_s32(vcvtq_s32_f32(vaddq_f32(acc_real, vbslq_f32(vcltq_f32(acc_real, vdupq_n_f32(0.0f)), vnegq_f32(half), half))));
+            out.val[1] = vmovn_s32(vcvtq_s32_f32(vaddq_f32(acc_imag, vbslq_f32(vcltq_f32(acc_imag, vdupq_n_f32(0.0f)), vnegq_f32(half), half))));
+            vst2_s16((int16_t*)(result + 4 * number), out);
+        }
+
+    for (unsigned int n = neon_iters * 4; n < num_points; n++)
+        {
+            result[n] = volk_gnsssdr_16ic_xn_weighted_sum_16ic_point(in, weights, num_in_vectors, n);
+        }
+}
+
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_gnsssdr_16ic_xn_weighted_sum_16ic_H */
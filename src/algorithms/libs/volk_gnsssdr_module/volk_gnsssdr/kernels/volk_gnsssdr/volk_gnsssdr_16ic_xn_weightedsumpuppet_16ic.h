@@ -0,0 +1,75 @@
+/*!
+ * \file volk_gnsssdr_16ic_xn_weightedsumpuppet_16ic.h
+ * \brief VOLK_GNSSSDR puppet for the weighted sum kernel.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * Wrapper of volk_gnsssdr_16ic_xn_weighted_sum_16ic with a single input vector,
+ * for the QA and the profiler
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_16ic_xn_weightedsumpuppet_16ic_H
+#define INCLUDED_volk_gnsssdr_16ic_xn_weightedsumpuppet_16ic_H
+
+#include "volk_gnsssdr/volk_gnsssdr_16ic_xn_weighted_sum_16ic.h"
+
+// The input is fed as the three channels of the sum, each one with its own weight
+#define VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_16IC_VECTORS 3
+
+
+#ifdef LV_HAVE_GENERIC
+static inline void volk_gnsssdr_16ic_xn_weightedsumpuppet_16ic_generic(lv_16sc_t* result, const lv_16sc_t* in, unsigned int num_points)
+{
+    const lv_16sc_t* in_a[VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_16IC_VECTORS] = {in, in, in};
+    const lv_32fc_t weights[VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_16IC_VECTORS] = {lv_cmake(0.5f, -0.25f), lv_cmake(-0.125f, 0.375f), lv_cmake(0.25f, 0.0625f)};
+    volk_gnsssdr_16ic_xn_weighted_sum_16ic_generic(result, in_a, weights, VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_16IC_VECTORS, num_points);
+}
+#endif /* LV_HAVE_GENERIC */
+
+
+#ifdef LV_HAVE_SSE3
+static inline void volk_gnsssdr_16ic_xn_weightedsumpuppet_16ic_u_sse3(lv_16sc_t* result, const lv_16sc_t* in, unsigned int num_points)
+{
+    const lv_16sc_t* in_a[VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_16IC_VECTORS] = {in, in, in};
+    const lv_32fc_t weights[VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_16IC_VECTORS] = {lv_cmake(0.5f, -0.25f), lv_cmake(-0.125f, 0.375f), lv_cmake(0.25f, 0.0625f)};
+    volk_gnsssdr_16ic_xn_weighted_sum_16ic_u_sse3(result, in_a, weights, VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_16IC_VECTORS, num_points);
+}
+#endif /* LV_HAVE_SSE3 */
+
+
+#ifdef LV_HAVE_NEON
+static inline void volk_gnsssdr_16ic_xn_weightedsumpuppet_16ic_neon(lv_16sc_t* result, const lv_16sc_t* in, unsigned int num_points)
+{
+    const lv_16sc_t* in_a[VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_16IC_VECTORS] = {in, in, in};
+    const lv_32fc_t weights[VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_16IC_VECTORS] = {lv_cmake(0.5f, -0.25f), lv_cmake(-0.125f, 0.375f), lv_cmake(0.25f, 0.0625f)};
+    volk_gnsssdr_16ic_xn_weighted_sum_16ic_neon(result, in_a, weights, VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_16IC_VECTORS, num_points);
+}
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_gnsssdr_16ic_xn_weightedsumpuppet_16ic_H */
@@ -0,0 +1,261 @@
+/*!
+ * \file volk_gnsssdr_32fc_lock_statistics_32f.h
+ * \brief VOLK_GNSSSDR kernel: sums of the prompt correlator outputs used by
+ * the CN0 estimator and the carrier lock detector.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * VOLK_GNSSSDR kernel that computes, in a single pass over a buffer of
+ * prompt correlator outputs, the sums needed by the SNV CN0 estimator and
+ * by the carrier lock detector
+ *
+ * -------------------------------------------------------------------------
+ *
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+/*!
+ * \page volk_gnsssdr_32fc_lock_statistics_32f
+ *
+ * \b Overview
+ *
+ * Computes, over the num_points prompt outputs of inputBuffer:
+ * \li stats[0] = sum of |Re(P)|, for the signal power of the SNV estimator
+ * \li stats[1] = sum of |P|^2, for the total power of the SNV estimator
+ * \li stats[2] = sum of Re(P) and stats[3] = sum of Im(P), for the narrowband
+ * power and difference of the carrier lock detector
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_gnsssdr_32fc_lock_statistics_32f(float* stats, const lv_32fc_t* inputBuffer, unsigned int num_points);
+ * \endcode
+ *
+ * \b Inputs
+ * \li inputBuffer: The prompt correlator outputs.
+ * \li num_points: Number of prompt correlator outputs.
+ *
+ * \b Outputs
+ * \li stats: The four sums above.
+ *
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_32fc_lock_statistics_32f_H
+#define INCLUDED_volk_gnsssdr_32fc_lock_statistics_32f_H
+
+#include <math.h>
+#include <volk_gnsssdr/volk_gnsssdr_common.h>
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_gnsssdr_32fc_lock_statistics_32f_generic(float* stats, const lv_32fc_t* inputBuffer, unsigned int num_points)
+{
+    float sum_abs_re = 0;
+    float sum_power = 0;
+    float sum_re = 0;
+    float sum_im = 0;
+    unsigned int n;
+    for(n = 0; n < num_points; n++)
+        {
+            float re = lv_creal(inputBuffer[n]);
+            float im = lv_cimag(inputBuffer[n]);
+            sum_abs_re += fabsf(re);
+            sum_power += re * re + im * im;
+            sum_re += re;
+            sum_im += im;
+        }
+    stats[0] = sum_abs_re;
+    stats[1] = sum_power;
+    stats[2] = sum_re;
+    stats[3] = sum_im;
+}
+#endif /* LV_HAVE_GENERIC */
+
+
+#ifdef LV_HAVE_SSE3
+#include <pmmintrin.h>
+
+static inline void volk_gnsssdr_32fc_lock_statistics_32f_u_sse3(float* stats, const lv_32fc_t* inputBuffer, unsigned int num_points)
+{
+    const unsigned int sse_iters = num_points / 2;
+    unsigned int number;
+    const float* aPtr = (const float*)inputBuffer;
+
+    __VOLK_ATTR_ALIGNED(16) float abs_buffer[4];
+    __VOLK_ATTR_ALIGNED(16) float power_buffer[4];
+    __VOLK_ATTR_ALIGNED(16) float sum_buffer[4];
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 x;
+    __m128 acc_abs = _mm_setzero_ps();
+    __m128 acc_power = _mm_setzero_ps();
+    __m128 acc_sum = _mm_setzero_ps();
+
+    for(number = 0; number < sse_iters; number++)
+        {
+            x = _mm_loadu_ps(aPtr); // re0, im0, re1, im1
+            acc_abs = _mm_add_ps(acc_abs, _mm_and_ps(x, abs_mask));
+            acc_power = _mm_add_ps(acc_power, _mm_mul_ps(x, x));
+            acc_sum = _mm_add_ps(acc_sum, x);
+            aPtr += 4;
+        }
+
+    _mm_store_ps(abs_buffer, acc_abs);
+    _mm_store_ps(power_buffer, acc_power);
+    _mm_store_ps(sum_buffer, acc_sum);
+    // the even lanes hold the real parts, the odd lanes the imaginary parts
+    stats[0] = abs_buffer[0] + abs_buffer[2];
+    stats[1] = power_buffer[0] + power_buffer[1] + power_buffer[2] + power_buffer[3];
+    stats[2] = sum_buffer[0] + sum_buffer[2];
+    stats[3] = sum_buffer[1] + sum_buffer[3];
+
+    for(number = sse_iters * 2; number < num_points; number++)
+        {
+            float re = lv_creal(inputBuffer[number]);
+            float im = lv_cimag(inputBuffer[number]);
+            stats[0] += fabsf(re);
+            stats[1] += re * re + im * im;
+            stats[2] += re;
+            stats[3] += im;
+        }
+}
+#endif /* LV_HAVE_SSE3 */
+
+
+#ifdef LV_HAVE_AVX
+#include <immintrin.h>
+
+static inline void volk_gnsssdr_32fc_lock_statistics_32f_u_avx(float* stats, const lv_32fc_t* inputBuffer, unsigned int num_points)
+{
+    const unsigned int avx_iters = num_points / 4;
+    unsigned int number;
+    unsigned int i;
+    const float* aPtr = (const float*)inputBuffer;
+
+    __VOLK_ATTR_ALIGNED(32) float abs_buffer[8];
+    __VOLK_ATTR_ALIGNED(32) float power_buffer[8];
+    __VOLK_ATTR_ALIGNED(32) float sum_buffer[8];
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 x;
+    __m256 acc_abs = _mm256_setzero_ps();
+    __m256 acc_power = _mm256_setzero_ps();
+    __m256 acc_sum = _mm256_setzero_ps();
+
+    for(number = 0; number < avx_iters; number++)
+        {
+            x = _mm256_loadu_ps(aPtr); // re0, im0, ... re3, im3
+            acc_abs = _mm256_add_ps(acc_abs, _mm256_and_ps(x, abs_mask));
+            acc_power = _mm256_add_ps(acc_power, _mm256_mul_ps(x, x));
+            acc_sum = _mm256_add_ps(acc_sum, x);
+            aPtr += 8;
+        }
+
+    _mm256_store_ps(abs_buffer, acc_abs);
+    _mm256_store_ps(power_buffer, acc_power);
+    _mm256_store_ps(sum_buffer, acc_sum);
+    _mm256_zeroupper();
+    stats[0] = 0;
+    stats[1] = 0;
+    stats[2] = 0;
+    stats[3] = 0;
+    for(i = 0; i < 8; i += 2)
+        {
+            stats[0] += abs_buffer[i];
+            stats[1] += power_buffer[i] + power_buffer[i + 1];
+            stats[2] += sum_buffer[i];
+            stats[3] += sum_buffer[i + 1];
+        }
+
+    for(number = avx_iters * 4; number < num_points; number++)
+        {
+            float re = lv_creal(inputBuffer[number]);
+            float im = lv_cimag(inputBuffer[number]);
+            stats[0] += fabsf(re);
+            stats[1] += re * re + im * im;
+            stats[2] += re;
+            stats[3] += im;
+        }
+}
+#endif /* LV_HAVE_AVX */
+
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_32fc_lock_statistics_32f_neon(float* stats, const lv_32fc_t* inputBuffer, unsigned int num_points)
+{
+    const unsigned int neon_iters = num_points / 4;
+    unsigned int number;
+    unsigned int i;
+
+    __VOLK_ATTR_ALIGNED(16) float abs_buffer[4];
+    __VOLK_ATTR_ALIGNED(16) float power_buffer[4];
+    __VOLK_ATTR_ALIGNED(16) float re_buffer[4];
+    __VOLK_ATTR_ALIGNED(16) float im_buffer[4];
+    float32x4x2_t x;
+    float32x4_t acc_abs = vdupq_n_f32(0);
+    float32x4_t acc_power = vdupq_n_f32(0);
+    float32x4_t acc_re = vdupq_n_f32(0);
+    float32x4_t acc_im = vdupq_n_f32(0);
+
+    for(number = 0; number < neon_iters; number++)
+        {
+            x = vld2q_f32((const float32_t*)(inputBuffer + 4 * number)); // re0|re1|re2|re3 || im0|im1|im2|im3
+            acc_abs = vaddq_f32(acc_abs, vabsq_f32(x.val[0]));
+            acc_power = vmlaq_f32(acc_power, x.val[0], x.val[0]);
+            acc_power = vmlaq_f32(acc_power, x.val[1], x.val[1]);
+            acc_re = vaddq_f32(acc_re, x.val[0]);
+            acc_im = vaddq_f32(acc_im, x.val[1]);
+        }
+
+    vst1q_f32(abs_buffer, acc_abs);
+    vst1q_f32(power_buffer, acc_power);
+    vst1q_f32(re_buffer, acc_re);
+    vst1q_f32(im_buffer, acc_im);
+    stats[0] = 0;
+    stats[1] = 0;
+    stats[2] = 0;
+    stats[3] = 0;
+    for(i = 0; i < 4; i++)
+        {
+            stats[0] += abs_buffer[i];
+            stats[1] += power_buffer[i];
+            stats[2] += re_buffer[i];
+            stats[3] += im_buffer[i];
+        }
+
+    for(number = neon_iters * 4; number < num_points; number++)
+        {
+            float re = lv_creal(inputBuffer[number]);
+            float im = lv_cimag(inputBuffer[number]);
+            stats[0] += fabsf(re);
+            stats[1] += re * re + im * im;
+            stats[2] += re;
+            stats[3] += im;
+        }
+}
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_gnsssdr_32fc_lock_statistics_32f_H */
@@ -0,0 +1,376 @@
+/*!
+ * \file volk_gnsssdr_32fc_magnitude_squared_peaks_32f.h
+ * \brief VOLK_GNSSSDR kernel: squared magnitude of a correlation, with its
+ * maximum, its sum and its second highest peak.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * VOLK_GNSSSDR kernel that computes, in a single pass over the output of the
+ * inverse FFT of an acquisition search, the squared magnitude of the
+ * correlation, its maximum, its sum and the highest sample outside an
+ * exclusion window around the maximum
+ *
+ * -------------------------------------------------------------------------
+ *
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+/*!
+ * \page volk_gnsssdr_32fc_magnitude_squared_peaks_32f
+ *
+ * \b Overview
+ *
+ * Writes the squared magnitude of the num_points samples of inputBuffer to
+ * magnitude and returns:
+ * \li peaks[0] = the maximum of magnitude, and peak_index[0] its first index
+ * \li peaks[1] = the sum of magnitude, for the noise floor
+ * \li peaks[2] = the maximum of magnitude at more than exclusion samples
+ * from peak_index[0], in circular distance, and peak_index[1] its first
+ * index. If no sample is that far, peaks[2] = 0 and peak_index[1] = peak_index[0].
+ *
+ * The pass keeps the maximum of each of (at most) 64 blocks of the input,
+ * so that finding the second peak afterwards only reads the blocks that
+ * overlap the exclusion window again.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_gnsssdr_32fc_magnitude_squared_peaks_32f(float* magnitude, float* peaks, unsigned int* peak_index, const lv_32fc_t* inputBuffer, unsigned int exclusion, unsigned int num_points);
+ * \endcode
+ *
+ * \b Inputs
+ * \li inputBuffer: The correlation, e.g. the output of the inverse FFT.
+ * \li exclusion: Half width of the window around the maximum that is not searched for the second peak.
+ * \li num_points: Number of samples of inputBuffer.
+ *
+ * \b Outputs
+ * \li magnitude: The squared magnitude of inputBuffer.
+ * \li peaks: The maximum, the sum and the second peak above.
+ * \li peak_index: The indices of the maximum and of the second peak.
+ *
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_32fc_magnitude_squared_peaks_32f_H
+#define INCLUDED_volk_gnsssdr_32fc_magnitude_squared_peaks_32f_H
+
+#include <volk_gnsssdr/volk_gnsssdr_common.h>
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+
+#define VOLK_GNSSSDR_MAGNITUDE_PEAKS_BLOCKS 64
+
+// a multiple of 8 samples, so that the vector loops run over whole blocks
+static inline unsigned int volk_gnsssdr_32fc_magnitude_squared_peaks_block_size(unsigned int num_points)
+{
+    unsigned int block_size = (num_points + VOLK_GNSSSDR_MAGNITUDE_PEAKS_BLOCKS - 1) / VOLK_GNSSSDR_MAGNITUDE_PEAKS_BLOCKS;
+    block_size = (block_size + 7) & ~7u;
+    return block_size > 0 ? block_size : 8;
+}
+
+
+// the maximum and the second peak, from the maxima of the blocks
+static inline void volk_gnsssdr_32fc_magnitude_squared_peaks_search(float* peaks, unsigned int* peak_index, const float* magnitude,
+        const float* block_max, unsigned int block_size, unsigned int exclusion, unsigned int num_points)
+{
+    const unsigned int num_blocks = (num_points + block_size - 1) / block_size;
+    unsigned int best_block = 0;
+    unsigned int second_block = num_blocks;
+    unsigned int second_index = 0;
+    float second = -1.0f;
+    unsigned int b, n, start, end, offset;
+
+    for(b = 1; b < num_blocks; b++)
+        {
+            if(block_max[b] > block_max[best_block])
+                {
+                    best_block = b;
+                }
+        }
+    n = best_block * block_size;
+    while(magnitude[n] != block_max[best_block])
+        {
+            n++;
+        }
+    peaks[0] = block_max[best_block];
+    peak_index[0] = n;
+
+    if(num_points < 2 || exclusion > (num_points - 2) / 2)
+        {
+            // every sample is in the exclusion window
+            peaks[2] = 0.0f;
+            peak_index[1] = peak_index[0];
+            return;
+        }
+    for(b = 0; b < num_blocks; b++)
+        {
+            start = b * block_size;
+            end = start + block_size < num_points ? start + block_size : num_points;
+            offset = (start + num_points - peak_index[0]) % num_points;
+            if(offset > exclusion && offset + (end - start - 1) < num_points - exclusion)
+                {
+                    // the whole block is outside the window
+                    if(block_max[b] > second)
+                        {
+                            second = block_max[b];
+                            second_block = b;
+                        }
+                }
+            else
+                {
+                    for(n = start; n < end; n++)
+                        {
+                            offset = (n + num_points - peak_index[0]) % num_points;
+                            if(offset > exclusion && offset < num_points - exclusion && magnitude[n] > second)
+                                {
+                                    second = magnitude[n];
+                                    second_block = num_blocks;
+                                    second_index = n;
+                                }
+                        }
+                }
+        }
+    if(second_block < num_blocks)
+        {
+            second_index = second_block * block_size;
+            while(magnitude[second_index] != second)
+                {
+                    second_index++;
+                }
+        }
+    peaks[2] = second;
+    peak_index[1] = second_index;
+}
+
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_gnsssdr_32fc_magnitude_squared_peaks_32f_generic(float* magnitude, float* peaks, unsigned int* peak_index, const lv_32fc_t* inputBuffer, unsigned int exclusion, unsigned int num_points)
+{
+    float block_max[VOLK_GNSSSDR_MAGNITUDE_PEAKS_BLOCKS];
+    const unsigned int block_size = volk_gnsssdr_32fc_magnitude_squared_peaks_block_size(num_points);
+    float sum = 0;
+    unsigned int b, n, end;
+
+    if(num_points == 0)
+        {
+            peaks[0] = peaks[1] = peaks[2] = 0.0f;
+            peak_index[0] = peak_index[1] = 0;
+            return;
+        }
+    for(b = 0; b * block_size < num_points; b++)
+        {
+            float max = 0;
+            end = (b + 1) * block_size < num_points ? (b + 1) * block_size : num_points;
+            for(n = b * block_size; n < end; n++)
+                {
+                    float re = lv_creal(inputBuffer[n]);
+                    float im = lv_cimag(inputBuffer[n]);
+                    float mag = re * re + im * im;
+                    magnitude[n] = mag;
+                    sum += mag;
+                    max = mag > max ? mag : max;
+                }
+            block_max[b] = max;
+        }
+    peaks[1] = sum;
+    volk_gnsssdr_32fc_magnitude_squared_peaks_search(peaks, peak_index, magnitude, block_max, block_size, exclusion, num_points);
+}
+#endif /* LV_HAVE_GENERIC */
+
+
+#ifdef LV_HAVE_SSE3
+#include <pmmintrin.h>
+
+static inline void volk_gnsssdr_32fc_magnitude_squared_peaks_32f_u_sse3(float* magnitude, float* peaks, unsigned int* peak_index, const lv_32fc_t* inputBuffer, unsigned int exclusion, unsigned int num_points)
+{
+    float block_max[VOLK_GNSSSDR_MAGNITUDE_PEAKS_BLOCKS];
+    const unsigned int block_size = volk_gnsssdr_32fc_magnitude_squared_peaks_block_size(num_points);
+    __VOLK_ATTR_ALIGNED(16) float buffer[4];
+    __m128 x0, x1, mag, acc_max;
+    __m128 acc_sum = _mm_setzero_ps();
+    float sum = 0;
+    unsigned int b, n, end, i;
+
+    if(num_points == 0)
+        {
+            peaks[0] = peaks[1] = peaks[2] = 0.0f;
+            peak_index[0] = peak_index[1] = 0;
+            return;
+        }
+    for(b = 0; b * block_size < num_points; b++)
+        {
+            float max = 0;
+            end = (b + 1) * block_size < num_points ? (b + 1) * block_size : num_points;
+            acc_max = _mm_setzero_ps();
+            for(n = b * block_size; n + 4 <= end; n += 4)
+                {
+                    x0 = _mm_loadu_ps((const float*)(inputBuffer + n)); // re0, im0, re1, im1
+                    x1 = _mm_loadu_ps((const float*)(inputBuffer + n + 2)); // re2, im2, re3, im3
+                    mag = _mm_hadd_ps(_mm_mul_ps(x0, x0), _mm_mul_ps(x1, x1));
+                    _mm_storeu_ps(magnitude + n, mag);
+                    acc_sum = _mm_add_ps(acc_sum, mag);
+                    acc_max = _mm_max_ps(acc_max, mag);
+                }
+            _mm_store_ps(buffer, acc_max);
+            for(i = 0; i < 4; i++)
+                {
+                    max = buffer[i] > max ? buffer[i] : max;
+                }
+            for(; n < end; n++)
+                {
+                    float re = lv_creal(inputBuffer[n]);
+                    float im = lv_cimag(inputBuffer[n]);
+                    float m = re * re + im * im;
+                    magnitude[n] = m;
+                    sum += m;
+                    max = m > max ? m : max;
+                }
+            block_max[b] = max;
+        }
+    _mm_store_ps(buffer, acc_sum);
+    peaks[1] = sum + buffer[0] + buffer[1] + buffer[2] + buffer[3];
+    volk_gnsssdr_32fc_magnitude_squared_peaks_search(peaks, peak_index, magnitude, block_max, block_size, exclusion, num_points);
+}
+#endif /* LV_HAVE_SSE3 */
+
+
+#ifdef LV_HAVE_AVX
+#include <immintrin.h>
+
+static inline void volk_gnsssdr_32fc_magnitude_squared_peaks_32f_u_avx(float* magnitude, float* peaks, unsigned int* peak_index, const lv_32fc_t* inputBuffer, unsigned int exclusion, unsigned int num_points)
+{
+    float block_max[VOLK_GNSSSDR_MAGNITUDE_PEAKS_BLOCKS];
+    const unsigned int block_size = volk_gnsssdr_32fc_magnitude_squared_peaks_block_size(num_points);
+    __VOLK_ATTR_ALIGNED(32) float buffer[8];
+    __m256 x0, x1, mag, acc_max;
+    __m256 acc_sum = _mm256_setzero_ps();
+    float sum = 0;
+    unsigned int b, n, end, i;
+
+    if(num_points == 0)
+        {
+            peaks[0] = peaks[1] = peaks[2] = 0.0f;
+            peak_index[0] = peak_index[1] = 0;
+            return;
+        }
+    for(b = 0; b * block_size < num_points; b++)
+        {
+            float max = 0;
+            end = (b + 1) * block_size < num_points ? (b + 1) * block_size : num_points;
+            acc_max = _mm256_setzero_ps();
+            for(n = b * block_size; n + 8 <= end; n += 8)
+                {
+                    x0 = _mm256_loadu_ps((const float*)(inputBuffer + n)); // samples 0..3
+                    x1 = _mm256_loadu_ps((const float*)(inputBuffer + n + 4)); // samples 4..7
+                    x0 = _mm256_mul_ps(x0, x0);
+                    x1 = _mm256_mul_ps(x1, x1);
+                    // samples 0, 1, 4, 5 and 2, 3, 6, 7, so that the pairwise sums come out in order
+                    mag = _mm256_hadd_ps(_mm256_permute2f128_ps(x0, x1, 0x20), _mm256_permute2f128_ps(x0, x1, 0x31));
+                    _mm256_storeu_ps(magnitude + n, mag);
+                    acc_sum = _mm256_add_ps(acc_sum, mag);
+                    acc_max = _mm256_max_ps(acc_max, mag);
+                }
+            _mm256_store_ps(buffer, acc_max);
+            for(i = 0; i < 8; i++)
+                {
+                    max = buffer[i] > max ? buffer[i] : max;
+                }
+            for(; n < end; n++)
+                {
+                    float re = lv_creal(inputBuffer[n]);
+                    float im = lv_cimag(inputBuffer[n]);
+                    float m = re * re + im * im;
+                    magnitude[n] = m;
+                    sum += m;
+                    max = m > max ? m : max;
+                }
+            block_max[b] = max;
+        }
+    _mm256_store_ps(buffer, acc_sum);
+    _mm256_zeroupper();
+    for(i = 0; i < 8; i++)
+        {
+            sum += buffer[i];
+        }
+    peaks[1] = sum;
+    volk_gnsssdr_32fc_magnitude_squared_peaks_search(peaks, peak_index, magnitude, block_max, block_size, exclusion, num_points);
+}
+#endif /* LV_HAVE_AVX */
+
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_32fc_magnitude_squared_peaks_32f_neon(float* magnitude, float* peaks, unsigned int* peak_index, const lv_32fc_t* inputBuffer, unsigned int exclusion, unsigned int num_points)
+{
+    float block_max[VOLK_GNSSSDR_MAGNITUDE_PEAKS_BLOCKS];
+    const unsigned int block_size = volk_gnsssdr_32fc_magnitude_squared_peaks_block_size(num_points);
+    __VOLK_ATTR_ALIGNED(16) float buffer[4];
+    float32x4x2_t x;
+    float32x4_t mag, acc_max;
+    float32x4_t acc_sum = vdupq_n_f32(0);
+    float sum = 0;
+    unsigned int b, n, end, i;
+
+    if(num_points == 0)
+        {
+            peaks[0] = peaks[1] = peaks[2] = 0.0f;
+            peak_index[0] = peak_index[1] = 0;
+            return;
+        }
+    for(b = 0; b * block_size < num_points; b++)
+        {
+            float max = 0;
+            end = (b + 1) * block_size < num_points ? (b + 1) * block_size : num_points;
+            acc_max = vdupq_n_f32(0);
+            for(n = b * block_size; n + 4 <= end; n += 4)
+                {
+                    x = vld2q_f32((const float32_t*)(inputBuffer + n)); // re0|re1|re2|re3 || im0|im1|im2|im3
+                    mag = vaddq_f32(vmulq_f32(x.val[0], x.val[0]), vmulq_f32(x.val[1], x.val[1]));
+                    vst1q_f32(magnitude + n, mag);
+                    acc_sum = vaddq_f32(acc_sum, mag);
+                    acc_max = vmaxq_f32(acc_max, mag);
+                }
+            vst1q_f32(buffer, acc_max);
+            for(i = 0; i < 4; i++)
+                {
+                    max = buffer[i] > max ? buffer[i] : max;
+                }
+            for(; n < end; n++)
+                {
+                    float re = lv_creal(inputBuffer[n]);
+                    float im = lv_cimag(inputBuffer[n]);
+                    float m = re * re + im * im;
+                    magnitude[n] = m;
+                    sum += m;
+                    max = m > max ? m : max;
+                }
+            block_max[b] = max;
+        }
+    vst1q_f32(buffer, acc_sum);
+    peaks[1] = sum + buffer[0] + buffer[1] + buffer[2] + buffer[3];
+    volk_gnsssdr_32fc_magnitude_squared_peaks_search(peaks, peak_index, magnitude, block_max, block_size, exclusion, num_points);
+}
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_gnsssdr_32fc_magnitude_squared_peaks_32f_H */
@@ -0,0 +1,100 @@
+/*!
+ * \file volk_gnsssdr_32fc_magnitudesquaredpeakspuppet_32f.h
+ * \brief VOLK_GNSSSDR puppet for the squared magnitude and peaks kernel.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * VOLK_GNSSSDR puppet for integrating the squared magnitude and peaks kernel into the test system
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_32fc_magnitudesquaredpeakspuppet_32f_H
+#define INCLUDED_volk_gnsssdr_32fc_magnitudesquaredpeakspuppet_32f_H
+
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+#include "volk_gnsssdr/volk_gnsssdr_32fc_magnitude_squared_peaks_32f.h"
+
+// The second peak is searched at more than num_points / 8 samples from the maximum.
+// The first samples of the output are overwritten with the peaks and their indices,
+// so that the test system compares them too.
+static inline void volk_gnsssdr_magnitudesquaredpeakspuppet_results(float* magnitude, const float* peaks, const unsigned int* peak_index, unsigned int num_points)
+{
+    if(num_points >= 5)
+        {
+            magnitude[0] = peaks[0];
+            magnitude[1] = peaks[1];
+            magnitude[2] = peaks[2];
+            magnitude[3] = (float)peak_index[0];
+            magnitude[4] = (float)peak_index[1];
+        }
+}
+
+
+#ifdef LV_HAVE_GENERIC
+static inline void volk_gnsssdr_32fc_magnitudesquaredpeakspuppet_32f_generic(float* magnitude, const lv_32fc_t* inputBuffer, unsigned int num_points)
+{
+    float peaks[3];
+    unsigned int peak_index[2];
+    volk_gnsssdr_32fc_magnitude_squared_peaks_32f_generic(magnitude, peaks, peak_index, inputBuffer, num_points / 8, num_points);
+    volk_gnsssdr_magnitudesquaredpeakspuppet_results(magnitude, peaks, peak_index, num_points);
+}
+#endif /* LV_HAVE_GENERIC */
+
+
+#ifdef LV_HAVE_SSE3
+static inline void volk_gnsssdr_32fc_magnitudesquaredpeakspuppet_32f_u_sse3(float* magnitude, const lv_32fc_t* inputBuffer, unsigned int num_points)
+{
+    float peaks[3];
+    unsigned int peak_index[2];
+    volk_gnsssdr_32fc_magnitude_squared_peaks_32f_u_sse3(magnitude, peaks, peak_index, inputBuffer, num_points / 8, num_points);
+    volk_gnsssdr_magnitudesquaredpeakspuppet_results(magnitude, peaks, peak_index, num_points);
+}
+#endif /* LV_HAVE_SSE3 */
+
+
+#ifdef LV_HAVE_AVX
+static inline void volk_gnsssdr_32fc_magnitudesquaredpeakspuppet_32f_u_avx(float* magnitude, const lv_32fc_t* inputBuffer, unsigned int num_points)
+{
+    float peaks[3];
+    unsigned int peak_index[2];
+    volk_gnsssdr_32fc_magnitude_squared_peaks_32f_u_avx(magnitude, peaks, peak_index, inputBuffer, num_points / 8, num_points);
+    volk_gnsssdr_magnitudesquaredpeakspuppet_results(magnitude, peaks, peak_index, num_points);
+}
+#endif /* LV_HAVE_AVX */
+
+
+#ifdef LV_HAVE_NEON
+static inline void volk_gnsssdr_32fc_magnitudesquaredpeakspuppet_32f_neon(float* magnitude, const lv_32fc_t* inputBuffer, unsigned int num_points)
+{
+    float peaks[3];
+    unsigned int peak_index[2];
+    volk_gnsssdr_32fc_magnitude_squared_peaks_32f_neon(magnitude, peaks, peak_index, inputBuffer, num_points / 8, num_points);
+    volk_gnsssdr_magnitudesquaredpeakspuppet_results(magnitude, peaks, peak_index, num_points);
+}
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_gnsssdr_32fc_magnitudesquaredpeakspuppet_32f_H */
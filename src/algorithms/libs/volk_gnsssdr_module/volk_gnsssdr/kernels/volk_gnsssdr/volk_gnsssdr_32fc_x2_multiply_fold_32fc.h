@@ -0,0 +1,219 @@
+/*!
+ * \file volk_gnsssdr_32fc_x2_multiply_fold_32fc.h
+ * \brief VOLK_GNSSSDR kernel: multiplies two complex vectors and folds the
+ * product onto a shorter vector.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * VOLK_GNSSSDR kernel that multiplies two complex vectors of
+ * num_folds * num_points samples and adds the num_folds consecutive
+ * segments of num_points samples of the product together
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+/*!
+ * \page volk_gnsssdr_32fc_x2_multiply_fold_32fc
+ *
+ * \b Overview
+ *
+ * Multiplies aVector by bVector sample by sample and folds the product:
+ * cVector[k] = sum over f of aVector[f * num_points + k] * bVector[f * num_points + k],
+ * for f = 0 ... num_folds - 1. This is the carrier wipeoff and the folding
+ * of the input signal of the QuickSync acquisition in a single pass, so
+ * the wiped off signal is never written to memory.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_gnsssdr_32fc_x2_multiply_fold_32fc(lv_32fc_t* cVector, const lv_32fc_t* aVector, const lv_32fc_t* bVector, unsigned int num_folds, unsigned int num_points);
+ * \endcode
+ *
+ * \b Inputs
+ * \li aVector: One of the vectors to be multiplied, with num_folds * num_points samples.
+ * \li bVector: The other vector to be multiplied, with num_folds * num_points samples.
+ * \li num_folds: Number of segments of num_points samples that are added together.
+ * \li num_points: Number of samples of the folded output.
+ *
+ * \b Outputs
+ * \li cVector: The folded product, with num_points samples.
+ *
+ * The segments of aVector and bVector are only aligned if num_points is a
+ * multiple of the SIMD width, so there are no aligned implementations.
+ *
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_32fc_x2_multiply_fold_32fc_H
+#define INCLUDED_volk_gnsssdr_32fc_x2_multiply_fold_32fc_H
+
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_gnsssdr_32fc_x2_multiply_fold_32fc_generic(lv_32fc_t* cVector, const lv_32fc_t* aVector, const lv_32fc_t* bVector, unsigned int num_folds, unsigned int num_points)
+{
+    unsigned int n;
+    unsigned int f;
+    for(n = 0; n < num_points; n++)
+        {
+            lv_32fc_t acc = lv_cmake(0, 0);
+            for(f = 0; f < num_folds; f++)
+                {
+                    acc += aVector[f * num_points + n] * bVector[f * num_points + n];
+                }
+            cVector[n] = acc;
+        }
+}
+#endif /* LV_HAVE_GENERIC */
+
+
+#ifdef LV_HAVE_SSE3
+#include <pmmintrin.h>
+
+static inline void volk_gnsssdr_32fc_x2_multiply_fold_32fc_u_sse3(lv_32fc_t* cVector, const lv_32fc_t* aVector, const lv_32fc_t* bVector, unsigned int num_folds, unsigned int num_points)
+{
+    const unsigned int sse_iters = num_points / 2;
+    unsigned int number;
+    unsigned int f;
+
+    __m128 x, y, yl, yh, tmp1, tmp2, acc;
+
+    for(number = 0; number < sse_iters; number++)
+        {
+            acc = _mm_setzero_ps();
+            for(f = 0; f < num_folds; f++)
+                {
+                    x = _mm_loadu_ps((const float*)(aVector + f * num_points + 2 * number)); // Load ar,ai,br,bi
+                    y = _mm_loadu_ps((const float*)(bVector + f * num_points + 2 * number)); // Load cr,ci,dr,di
+                    yl = _mm_moveldup_ps(y); // Load yl with cr,cr,dr,dr
+                    yh = _mm_movehdup_ps(y); // Load yh with ci,ci,di,di
+                    tmp1 = _mm_mul_ps(x, yl); // tmp1 = ar*cr,ai*cr,br*dr,bi*dr
+                    x = _mm_shuffle_ps(x, x, 0xB1); // Re-arrange x to be ai,ar,bi,br
+                    tmp2 = _mm_mul_ps(x, yh); // tmp2 = ai*ci,ar*ci,bi*di,br*di
+                    acc = _mm_add_ps(acc, _mm_addsub_ps(tmp1, tmp2)); // ar*cr-ai*ci, ai*cr+ar*ci, br*dr-bi*di, bi*dr+br*di
+                }
+            _mm_storeu_ps((float*)(cVector + 2 * number), acc);
+        }
+
+    for(number = sse_iters * 2; number < num_points; number++)
+        {
+            lv_32fc_t acc32 = lv_cmake(0, 0);
+            for(f = 0; f < num_folds; f++)
+                {
+                    acc32 += aVector[f * num_points + number] * bVector[f * num_points + number];
+                }
+            cVector[number] = acc32;
+        }
+}
+#endif /* LV_HAVE_SSE3 */
+
+
+#ifdef LV_HAVE_AVX
+#include <immintrin.h>
+
+static inline void volk_gnsssdr_32fc_x2_multiply_fold_32fc_u_avx(lv_32fc_t* cVector, const lv_32fc_t* aVector, const lv_32fc_t* bVector, unsigned int num_folds, unsigned int num_points)
+{
+    const unsigned int avx_iters = num_points / 4;
+    unsigned int number;
+    unsigned int f;
+
+    __m256 x, y, yl, yh, tmp1, tmp2, acc;
+
+    for(number = 0; number < avx_iters; number++)
+        {
+            acc = _mm256_setzero_ps();
+            for(f = 0; f < num_folds; f++)
+                {
+                    x = _mm256_loadu_ps((const float*)(aVector + f * num_points + 4 * number));
+                    y = _mm256_loadu_ps((const float*)(bVector + f * num_points + 4 * number));
+                    yl = _mm256_moveldup_ps(y);
+                    yh = _mm256_movehdup_ps(y);
+                    tmp1 = _mm256_mul_ps(x, yl);
+                    x = _mm256_shuffle_ps(x, x, 0xB1);
+                    tmp2 = _mm256_mul_ps(x, yh);
+                    acc = _mm256_add_ps(acc, _mm256_addsub_ps(tmp1, tmp2));
+                }
+            _mm256_storeu_ps((float*)(cVector + 4 * number), acc);
+        }
+    _mm256_zeroupper();
+
+    for(number = avx_iters * 4; number < num_points; number++)
+        {
+            lv_32fc_t acc32 = lv_cmake(0, 0);
+            for(f = 0; f < num_folds; f++)
+                {
+                    acc32 += aVector[f * num_points + number] * bVector[f * num_points + number];
+                }
+            cVector[number] = acc32;
+        }
+}
+#endif /* LV_HAVE_AVX */
+
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_32fc_x2_multiply_fold_32fc_neon(lv_32fc_t* cVector, const lv_32fc_t* aVector, const lv_32fc_t* bVector, unsigned int num_folds, unsigned int num_points)
+{
+    const unsigned int neon_iters = num_points / 4;
+    unsigned int number;
+    unsigned int f;
+
+    float32x4x2_t a_val, b_val, acc;
+    float32x4_t tmp_real, tmp_imag;
+
+    for(number = 0; number < neon_iters; number++)
+        {
+            acc.val[0] = vdupq_n_f32(0);
+            acc.val[1] = vdupq_n_f32(0);
+            for(f = 0; f < num_folds; f++)
+                {
+                    a_val = vld2q_f32((const float32_t*)(aVector + f * num_points + 4 * number)); // a0r|a1r|a2r|a3r || a0i|a1i|a2i|a3i
+                    b_val = vld2q_f32((const float32_t*)(bVector + f * num_points + 4 * number));
+                    // real = ar*br - ai*bi, imag = ar*bi + ai*br
+                    tmp_real = vmulq_f32(a_val.val[0], b_val.val[0]);
+                    tmp_imag = vmulq_f32(a_val.val[0], b_val.val[1]);
+                    tmp_real = vmlsq_f32(tmp_real, a_val.val[1], b_val.val[1]);
+                    tmp_imag = vmlaq_f32(tmp_imag, a_val.val[1], b_val.val[0]);
+                    acc.val[0] = vaddq_f32(acc.val[0], tmp_real);
+                    acc.val[1] = vaddq_f32(acc.val[1], tmp_imag);
+                }
+            vst2q_f32((float32_t*)(cVector + 4 * number), acc);
+        }
+
+    for(number = neon_iters * 4; number < num_points; number++)
+        {
+            lv_32fc_t acc32 = lv_cmake(0, 0);
+            for(f = 0; f < num_folds; f++)
+                {
+                    acc32 += aVector[f * num_points + number] * bVector[f * num_points + number];
+                }
+            cVector[number] = acc32;
+        }
+}
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_gnsssdr_32fc_x2_multiply_fold_32fc_H */
@@ -0,0 +1,76 @@
+/*!
+ * \file volk_gnsssdr_32fc_x2_multiplyfoldpuppet_32fc.h
+ * \brief VOLK_GNSSSDR puppet for the multiply and fold kernel.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * VOLK_GNSSSDR puppet for integrating the multiply and fold kernel into the test system
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_32fc_x2_multiplyfoldpuppet_32fc_H
+#define INCLUDED_volk_gnsssdr_32fc_x2_multiplyfoldpuppet_32fc_H
+
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+#include "volk_gnsssdr/volk_gnsssdr_32fc_x2_multiply_fold_32fc.h"
+
+// The inputs are folded 4 times: only the first num_points / 4 output samples are written
+#define VOLK_GNSSSDR_MULTIPLYFOLDPUPPET_FOLDS 4
+
+
+#ifdef LV_HAVE_GENERIC
+static inline void volk_gnsssdr_32fc_x2_multiplyfoldpuppet_32fc_generic(lv_32fc_t* cVector, const lv_32fc_t* aVector, const lv_32fc_t* bVector, unsigned int num_points)
+{
+    volk_gnsssdr_32fc_x2_multiply_fold_32fc_generic(cVector, aVector, bVector, VOLK_GNSSSDR_MULTIPLYFOLDPUPPET_FOLDS, num_points / VOLK_GNSSSDR_MULTIPLYFOLDPUPPET_FOLDS);
+}
+#endif /* LV_HAVE_GENERIC */
+
+
+#ifdef LV_HAVE_SSE3
+static inline void volk_gnsssdr_32fc_x2_multiplyfoldpuppet_32fc_u_sse3(lv_32fc_t* cVector, const lv_32fc_t* aVector, const lv_32fc_t* bVector, unsigned int num_points)
+{
+    volk_gnsssdr_32fc_x2_multiply_fold_32fc_u_sse3(cVector, aVector, bVector, VOLK_GNSSSDR_MULTIPLYFOLDPUPPET_FOLDS, num_points / VOLK_GNSSSDR_MULTIPLYFOLDPUPPET_FOLDS);
+}
+#endif /* LV_HAVE_SSE3 */
+
+
+#ifdef LV_HAVE_AVX
+static inline void volk_gnsssdr_32fc_x2_multiplyfoldpuppet_32fc_u_avx(lv_32fc_t* cVector, const lv_32fc_t* aVector, const lv_32fc_t* bVector, unsigned int num_points)
+{
+    volk_gnsssdr_32fc_x2_multiply_fold_32fc_u_avx(cVector, aVector, bVector, VOLK_GNSSSDR_MULTIPLYFOLDPUPPET_FOLDS, num_points / VOLK_GNSSSDR_MULTIPLYFOLDPUPPET_FOLDS);
+}
+#endif /* LV_HAVE_AVX */
+
+
+#ifdef LV_HAVE_NEON
+static inline void volk_gnsssdr_32fc_x2_multiplyfoldpuppet_32fc_neon(lv_32fc_t* cVector, const lv_32fc_t* aVector, const lv_32fc_t* bVector, unsigned int num_points)
+{
+    volk_gnsssdr_32fc_x2_multiply_fold_32fc_neon(cVector, aVector, bVector, VOLK_GNSSSDR_MULTIPLYFOLDPUPPET_FOLDS, num_points / VOLK_GNSSSDR_MULTIPLYFOLDPUPPET_FOLDS);
+}
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_gnsssdr_32fc_x2_multiplyfoldpuppet_32fc_H */
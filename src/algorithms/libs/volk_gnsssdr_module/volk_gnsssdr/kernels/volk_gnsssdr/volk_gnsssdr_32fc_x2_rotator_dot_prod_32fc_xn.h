@@ -620,6 +620,480 @@ static inline void volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_a_avx(lv_32fc_t
 #endif /* LV_HAVE_AVX */
 
 
+#if LV_HAVE_AVX2 && LV_HAVE_FMA
+#include <immintrin.h>
+static inline void volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_u_avx2(lv_32fc_t* result, const lv_32fc_t* in_common, const lv_32fc_t phase_inc, lv_32fc_t* phase, const lv_32fc_t** in_a, int num_a_vectors, unsigned int num_points)
+{
+    lv_32fc_t dotProduct = lv_cmake(0,0);
+    lv_32fc_t tmp32_1, tmp32_2;
+    const unsigned int avx2_iters = num_points / 4;
+    const unsigned int ROTATOR_RELOAD = 64; // iterations of 4 samples, as the 256 samples of the generic_reload version
+
+    const lv_32fc_t** _in_a = in_a;
+    const lv_32fc_t* _in_common = in_common;
+    lv_32fc_t _phase = (*phase);
+
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t dotProductVector[4];
+
+    // the products by the real and by the imaginary part of the rotated sample are accumulated
+    // apart, with FMA, and combined at the end: the sum of addsub(x, y) is addsub(sum x, sum y)
+    __m256* acc = (__m256*)volk_gnsssdr_malloc(2 * num_a_vectors * sizeof(__m256), volk_gnsssdr_get_alignment());
+    __m256* acc_l = acc;
+    __m256* acc_h = acc + num_a_vectors;
+
+    for (int n_vec = 0; n_vec < num_a_vectors; n_vec++)
+        {
+            acc_l[n_vec] = _mm256_setzero_ps();
+            acc_h[n_vec] = _mm256_setzero_ps();
+            result[n_vec] = lv_cmake(0, 0);
+        }
+
+    // phase rotation registers
+    __m256 a, b, four_phase_acc_reg, yl, yh, tmp1, tmp2, z;
+
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t four_phase_inc[4];
+    const lv_32fc_t phase_inc2 = phase_inc * phase_inc;
+    const lv_32fc_t phase_inc3 = phase_inc2 * phase_inc;
+    const lv_32fc_t phase_inc4 = phase_inc3 * phase_inc;
+    four_phase_inc[0] = phase_inc4;
+    four_phase_inc[1] = phase_inc4;
+    four_phase_inc[2] = phase_inc4;
+    four_phase_inc[3] = phase_inc4;
+    const __m256 four_phase_inc_reg = _mm256_load_ps((float*)four_phase_inc);
+
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t four_phase_acc[4];
+    four_phase_acc[0] = _phase;
+    four_phase_acc[1] = _phase * phase_inc;
+    four_phase_acc[2] = _phase * phase_inc2;
+    four_phase_acc[3] = _phase * phase_inc3;
+    four_phase_acc_reg = _mm256_load_ps((float*)four_phase_acc);
+
+    const __m256 ylp = _mm256_moveldup_ps(four_phase_inc_reg);
+    const __m256 yhp = _mm256_movehdup_ps(four_phase_inc_reg);
+
+    for(unsigned int number = 0; number < avx2_iters; number++)
+        {
+            // Phase rotation on operand in_common starts here:
+            a = _mm256_loadu_ps((float*)_in_common);
+            yl = _mm256_moveldup_ps(four_phase_acc_reg); // Load yl with cr,cr,dr,dr
+            yh = _mm256_movehdup_ps(four_phase_acc_reg);
+            tmp2 = _mm256_mul_ps(_mm256_permute_ps(a, 0xB1), yh);
+            z = _mm256_fmaddsub_ps(a, yl, tmp2);
+            tmp2 = _mm256_mul_ps(_mm256_permute_ps(four_phase_acc_reg, 0xB1), yhp);
+            four_phase_acc_reg = _mm256_fmaddsub_ps(four_phase_acc_reg, ylp, tmp2);
+
+            yl = _mm256_moveldup_ps(z); // Load yl with cr,cr,dr,dr
+            yh = _mm256_movehdup_ps(z);
+
+            //next four samples
+            _in_common += 4;
+
+            for (int n_vec = 0; n_vec < num_a_vectors; n_vec++)
+                {
+                    b = _mm256_loadu_ps((float*)&(_in_a[n_vec][number * 4]));
+                    acc_l[n_vec] = _mm256_fmadd_ps(b, yl, acc_l[n_vec]);
+                    acc_h[n_vec] = _mm256_fmadd_ps(_mm256_permute_ps(b, 0xB1), yh, acc_h[n_vec]);
+                }
+            // Regenerate phase
+            if ((number % ROTATOR_RELOAD) == ROTATOR_RELOAD - 1)
+                {
+                    tmp1 = _mm256_mul_ps(four_phase_acc_reg, four_phase_acc_reg);
+                    tmp2 = _mm256_add_ps(tmp1, _mm256_permute_ps(tmp1, 0xB1));
+                    four_phase_acc_reg = _mm256_div_ps(four_phase_acc_reg, _mm256_sqrt_ps(tmp2));
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_a_vectors; n_vec++)
+        {
+            z = _mm256_addsub_ps(acc_l[n_vec], acc_h[n_vec]);
+            _mm256_store_ps((float*)dotProductVector, z); // Store the results back into the dot product vector
+            dotProduct = lv_cmake(0,0);
+            for (int i = 0; i < 4; ++i)
+                {
+                    dotProduct = dotProduct + dotProductVector[i];
+                }
+            result[n_vec] = dotProduct;
+        }
+    volk_gnsssdr_free(acc);
+
+    tmp1 = _mm256_mul_ps(four_phase_acc_reg, four_phase_acc_reg);
+    tmp2 = _mm256_add_ps(tmp1, _mm256_permute_ps(tmp1, 0xB1));
+    four_phase_acc_reg = _mm256_div_ps(four_phase_acc_reg, _mm256_sqrt_ps(tmp2));
+
+    _mm256_store_ps((float*)four_phase_acc, four_phase_acc_reg);
+    _phase  = four_phase_acc[0];
+    _mm256_zeroupper();
+
+    for(unsigned int n  = avx2_iters * 4; n < num_points; n++)
+        {
+            tmp32_1 = *_in_common++ * _phase;
+            _phase *= phase_inc;
+            for (int n_vec = 0; n_vec < num_a_vectors; n_vec++)
+                {
+                    tmp32_2 = tmp32_1 * _in_a[n_vec][n];
+                    result[n_vec] += tmp32_2;
+                }
+        }
+    (*phase) = _phase;
+}
+#endif /* LV_HAVE_AVX2 && LV_HAVE_FMA */
+
+
+#if LV_HAVE_AVX2 && LV_HAVE_FMA
+#include <immintrin.h>
+static inline void volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_a_avx2(lv_32fc_t* result, const lv_32fc_t* in_common, const lv_32fc_t phase_inc, lv_32fc_t* phase, const lv_32fc_t** in_a, int num_a_vectors, unsigned int num_points)
+{
+    lv_32fc_t dotProduct = lv_cmake(0,0);
+    lv_32fc_t tmp32_1, tmp32_2;
+    const unsigned int avx2_iters = num_points / 4;
+    const unsigned int ROTATOR_RELOAD = 64; // iterations of 4 samples, as the 256 samples of the generic_reload version
+
+    const lv_32fc_t** _in_a = in_a;
+    const lv_32fc_t* _in_common = in_common;
+    lv_32fc_t _phase = (*phase);
+
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t dotProductVector[4];
+
+    // the products by the real and by the imaginary part of the rotated sample are accumulated
+    // apart, with FMA, and combined at the end: the sum of addsub(x, y) is addsub(sum x, sum y)
+    __m256* acc = (__m256*)volk_gnsssdr_malloc(2 * num_a_vectors * sizeof(__m256), volk_gnsssdr_get_alignment());
+    __m256* acc_l = acc;
+    __m256* acc_h = acc + num_a_vectors;
+
+    for (int n_vec = 0; n_vec < num_a_vectors; n_vec++)
+        {
+            acc_l[n_vec] = _mm256_setzero_ps();
+            acc_h[n_vec] = _mm256_setzero_ps();
+            result[n_vec] = lv_cmake(0, 0);
+        }
+
+    // phase rotation registers
+    __m256 a, b, four_phase_acc_reg, yl, yh, tmp1, tmp2, z;
+
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t four_phase_inc[4];
+    const lv_32fc_t phase_inc2 = phase_inc * phase_inc;
+    const lv_32fc_t phase_inc3 = phase_inc2 * phase_inc;
+    const lv_32fc_t phase_inc4 = phase_inc3 * phase_inc;
+    four_phase_inc[0] = phase_inc4;
+    four_phase_inc[1] = phase_inc4;
+    four_phase_inc[2] = phase_inc4;
+    four_phase_inc[3] = phase_inc4;
+    const __m256 four_phase_inc_reg = _mm256_load_ps((float*)four_phase_inc);
+
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t four_phase_acc[4];
+    four_phase_acc[0] = _phase;
+    four_phase_acc[1] = _phase * phase_inc;
+    four_phase_acc[2] = _phase * phase_inc2;
+    four_phase_acc[3] = _phase * phase_inc3;
+    four_phase_acc_reg = _mm256_load_ps((float*)four_phase_acc);
+
+    const __m256 ylp = _mm256_moveldup_ps(four_phase_inc_reg);
+    const __m256 yhp = _mm256_movehdup_ps(four_phase_inc_reg);
+
+    for(unsigned int number = 0; number < avx2_iters; number++)
+        {
+            // Phase rotation on operand in_common starts here:
+            a = _mm256_load_ps((float*)_in_common);
+            yl = _mm256_moveldup_ps(four_phase_acc_reg); // Load yl with cr,cr,dr,dr
+            yh = _mm256_movehdup_ps(four_phase_acc_reg);
+            tmp2 = _mm256_mul_ps(_mm256_permute_ps(a, 0xB1), yh);
+            z = _mm256_fmaddsub_ps(a, yl, tmp2);
+            tmp2 = _mm256_mul_ps(_mm256_permute_ps(four_phase_acc_reg, 0xB1), yhp);
+            four_phase_acc_reg = _mm256_fmaddsub_ps(four_phase_acc_reg, ylp, tmp2);
+
+            yl = _mm256_moveldup_ps(z); // Load yl with cr,cr,dr,dr
+            yh = _mm256_movehdup_ps(z);
+
+            //next four samples
+            _in_common += 4;
+
+            for (int n_vec = 0; n_vec < num_a_vectors; n_vec++)
+                {
+                    b = _mm256_load_ps((float*)&(_in_a[n_vec][number * 4]));
+                    acc_l[n_vec] = _mm256_fmadd_ps(b, yl, acc_l[n_vec]);
+                    acc_h[n_vec] = _mm256_fmadd_ps(_mm256_permute_ps(b, 0xB1), yh, acc_h[n_vec]);
+                }
+            // Regenerate phase
+            if ((number % ROTATOR_RELOAD) == ROTATOR_RELOAD - 1)
+                {
+                    tmp1 = _mm256_mul_ps(four_phase_acc_reg, four_phase_acc_reg);
+                    tmp2 = _mm256_add_ps(tmp1, _mm256_permute_ps(tmp1, 0xB1));
+                    four_phase_acc_reg = _mm256_div_ps(four_phase_acc_reg, _mm256_sqrt_ps(tmp2));
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_a_vectors; n_vec++)
+        {
+            z = _mm256_addsub_ps(acc_l[n_vec], acc_h[n_vec]);
+            _mm256_store_ps((float*)dotProductVector, z); // Store the results back into the dot product vector
+            dotProduct = lv_cmake(0,0);
+            for (int i = 0; i < 4; ++i)
+                {
+                    dotProduct = dotProduct + dotProductVector[i];
+                }
+            result[n_vec] = dotProduct;
+        }
+    volk_gnsssdr_free(acc);
+
+    tmp1 = _mm256_mul_ps(four_phase_acc_reg, four_phase_acc_reg);
+    tmp2 = _mm256_add_ps(tmp1, _mm256_permute_ps(tmp1, 0xB1));
+    four_phase_acc_reg = _mm256_div_ps(four_phase_acc_reg, _mm256_sqrt_ps(tmp2));
+
+    _mm256_store_ps((float*)four_phase_acc, four_phase_acc_reg);
+    _phase  = four_phase_acc[0];
+    _mm256_zeroupper();
+
+    for(unsigned int n  = avx2_iters * 4; n < num_points; n++)
+        {
+            tmp32_1 = *_in_common++ * _phase;
+            _phase *= phase_inc;
+            for (int n_vec = 0; n_vec < num_a_vectors; n_vec++)
+                {
+                    tmp32_2 = tmp32_1 * _in_a[n_vec][n];
+                    result[n_vec] += tmp32_2;
+                }
+        }
+    (*phase) = _phase;
+}
+#endif /* LV_HAVE_AVX2 && LV_HAVE_FMA */
+
+
+#ifdef LV_HAVE_AVX512F
+#include <immintrin.h>
+static inline void volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_u_avx512f(lv_32fc_t* result, const lv_32fc_t* in_common, const lv_32fc_t phase_inc, lv_32fc_t* phase, const lv_32fc_t** in_a, int num_a_vectors, unsigned int num_points)
+{
+    lv_32fc_t dotProduct = lv_cmake(0,0);
+    lv_32fc_t tmp32_1, tmp32_2;
+    const unsigned int avx512_iters = num_points / 8;
+    const unsigned int ROTATOR_RELOAD = 32; // iterations of 8 samples, as the 256 samples of the generic_reload version
+
+    const lv_32fc_t** _in_a = in_a;
+    const lv_32fc_t* _in_common = in_common;
+    lv_32fc_t _phase = (*phase);
+
+    __VOLK_ATTR_ALIGNED(64) lv_32fc_t dotProductVector[8];
+
+    // the products by the real and by the imaginary part of the rotated sample are accumulated
+    // apart, with FMA, and combined at the end: the sum of addsub(x, y) is addsub(sum x, sum y)
+    __m512* acc = (__m512*)volk_gnsssdr_malloc(2 * num_a_vectors * sizeof(__m512), 64); // __m512 needs 64-byte alignment
+    __m512* acc_l = acc;
+    __m512* acc_h = acc + num_a_vectors;
+
+    for (int n_vec = 0; n_vec < num_a_vectors; n_vec++)
+        {
+            acc_l[n_vec] = _mm512_setzero_ps();
+            acc_h[n_vec] = _mm512_setzero_ps();
+            result[n_vec] = lv_cmake(0, 0);
+        }
+
+    // phase rotation registers
+    __m512 a, b, eight_phase_acc_reg, yl, yh, tmp1, tmp2, z;
+
+    __VOLK_ATTR_ALIGNED(64) lv_32fc_t eight_phase_inc[8];
+    __VOLK_ATTR_ALIGNED(64) lv_32fc_t eight_phase_acc[8];
+    lv_32fc_t phase_inc_n = lv_cmake(1, 0);
+    for (int i = 0; i < 8; i++)
+        {
+            eight_phase_acc[i] = _phase * phase_inc_n;
+            phase_inc_n *= phase_inc;
+        }
+    for (int i = 0; i < 8; i++)
+        {
+            eight_phase_inc[i] = phase_inc_n;
+        }
+    const __m512 eight_phase_inc_reg = _mm512_load_ps((float*)eight_phase_inc);
+    eight_phase_acc_reg = _mm512_load_ps((float*)eight_phase_acc);
+
+    const __m512 ylp = _mm512_moveldup_ps(eight_phase_inc_reg);
+    const __m512 yhp = _mm512_movehdup_ps(eight_phase_inc_reg);
+
+    for(unsigned int number = 0; number < avx512_iters; number++)
+        {
+            // Phase rotation on operand in_common starts here:
+            a = _mm512_loadu_ps((float*)_in_common);
+            yl = _mm512_moveldup_ps(eight_phase_acc_reg);
+            yh = _mm512_movehdup_ps(eight_phase_acc_reg);
+            tmp2 = _mm512_mul_ps(_mm512_permute_ps(a, 0xB1), yh);
+            z = _mm512_fmaddsub_ps(a, yl, tmp2);
+            tmp2 = _mm512_mul_ps(_mm512_permute_ps(eight_phase_acc_reg, 0xB1), yhp);
+            eight_phase_acc_reg = _mm512_fmaddsub_ps(eight_phase_acc_reg, ylp, tmp2);
+
+            yl = _mm512_moveldup_ps(z);
+            yh = _mm512_movehdup_ps(z);
+
+            //next eight samples
+            _in_common += 8;
+
+            for (int n_vec = 0; n_vec < num_a_vectors; n_vec++)
+                {
+                    b = _mm512_loadu_ps((float*)&(_in_a[n_vec][number * 8]));
+                    acc_l[n_vec] = _mm512_fmadd_ps(b, yl, acc_l[n_vec]);
+                    acc_h[n_vec] = _mm512_fmadd_ps(_mm512_permute_ps(b, 0xB1), yh, acc_h[n_vec]);
+                }
+            // Regenerate phase
+            if ((number % ROTATOR_RELOAD) == ROTATOR_RELOAD - 1)
+                {
+                    tmp1 = _mm512_mul_ps(eight_phase_acc_reg, eight_phase_acc_reg);
+                    tmp2 = _mm512_add_ps(tmp1, _mm512_permute_ps(tmp1, 0xB1));
+                    eight_phase_acc_reg = _mm512_div_ps(eight_phase_acc_reg, _mm512_sqrt_ps(tmp2));
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_a_vectors; n_vec++)
+        {
+            // there is no 512-bit addsub: acc_l * 1 -/+ acc_h
+            z = _mm512_fmaddsub_ps(acc_l[n_vec], _mm512_set1_ps(1.0f), acc_h[n_vec]);
+            _mm512_store_ps((float*)dotProductVector, z); // Store the results back into the dot product vector
+            dotProduct = lv_cmake(0,0);
+            for (int i = 0; i < 8; ++i)
+                {
+                    dotProduct = dotProduct + dotProductVector[i];
+                }
+            result[n_vec] = dotProduct;
+        }
+    volk_gnsssdr_free(acc);
+
+    tmp1 = _mm512_mul_ps(eight_phase_acc_reg, eight_phase_acc_reg);
+    tmp2 = _mm512_add_ps(tmp1, _mm512_permute_ps(tmp1, 0xB1));
+    eight_phase_acc_reg = _mm512_div_ps(eight_phase_acc_reg, _mm512_sqrt_ps(tmp2));
+
+    _mm512_store_ps((float*)eight_phase_acc, eight_phase_acc_reg);
+    _phase  = eight_phase_acc[0];
+    _mm256_zeroupper();
+
+    for(unsigned int n  = avx512_iters * 8; n < num_points; n++)
+        {
+            tmp32_1 = *_in_common++ * _phase;
+            _phase *= phase_inc;
+            for (int n_vec = 0; n_vec < num_a_vectors; n_vec++)
+                {
+                    tmp32_2 = tmp32_1 * _in_a[n_vec][n];
+                    result[n_vec] += tmp32_2;
+                }
+        }
+    (*phase) = _phase;
+}
+#endif /* LV_HAVE_AVX512F */
+
+
+#ifdef LV_HAVE_AVX512F
+#include <immintrin.h>
+static inline void volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_a_avx512f(lv_32fc_t* result, const lv_32fc_t* in_common, const lv_32fc_t phase_inc, lv_32fc_t* phase, const lv_32fc_t** in_a, int num_a_vectors, unsigned int num_points)
+{
+    lv_32fc_t dotProduct = lv_cmake(0,0);
+    lv_32fc_t tmp32_1, tmp32_2;
+    const unsigned int avx512_iters = num_points / 8;
+    const unsigned int ROTATOR_RELOAD = 32; // iterations of 8 samples, as the 256 samples of the generic_reload version
+
+    const lv_32fc_t** _in_a = in_a;
+    const lv_32fc_t* _in_common = in_common;
+    lv_32fc_t _phase = (*phase);
+
+    __VOLK_ATTR_ALIGNED(64) lv_32fc_t dotProductVector[8];
+
+    // the products by the real and by the imaginary part of the rotated sample are accumulated
+    // apart, with FMA, and combined at the end: the sum of addsub(x, y) is addsub(sum x, sum y)
+    __m512* acc = (__m512*)volk_gnsssdr_malloc(2 * num_a_vectors * sizeof(__m512), 64); // __m512 needs 64-byte alignment
+    __m512* acc_l = acc;
+    __m512* acc_h = acc + num_a_vectors;
+
+    for (int n_vec = 0; n_vec < num_a_vectors; n_vec++)
+        {
+            acc_l[n_vec] = _mm512_setzero_ps();
+            acc_h[n_vec] = _mm512_setzero_ps();
+            result[n_vec] = lv_cmake(0, 0);
+        }
+
+    // phase rotation registers
+    __m512 a, b, eight_phase_acc_reg, yl, yh, tmp1, tmp2, z;
+
+    __VOLK_ATTR_ALIGNED(64) lv_32fc_t eight_phase_inc[8];
+    __VOLK_ATTR_ALIGNED(64) lv_32fc_t eight_phase_acc[8];
+    lv_32fc_t phase_inc_n = lv_cmake(1, 0);
+    for (int i = 0; i < 8; i++)
+        {
+            eight_phase_acc[i] = _phase * phase_inc_n;
+            phase_inc_n *= phase_inc;
+        }
+    for (int i = 0; i < 8; i++)
+        {
+            eight_phase_inc[i] = phase_inc_n;
+        }
+    const __m512 eight_phase_inc_reg = _mm512_load_ps((float*)eight_phase_inc);
+    eight_phase_acc_reg = _mm512_load_ps((float*)eight_phase_acc);
+
+    const __m512 ylp = _mm512_moveldup_ps(eight_phase_inc_reg);
+    const __m512 yhp = _mm512_movehdup_ps(eight_phase_inc_reg);
+
+    for(unsigned int number = 0; number < avx512_iters; number++)
+        {
+            // Phase rotation on operand in_common starts here:
+            a = _mm512_load_ps((float*)_in_common);
+            yl = _mm512_moveldup_ps(eight_phase_acc_reg);
+            yh = _mm512_movehdup_ps(eight_phase_acc_reg);
+            tmp2 = _mm512_mul_ps(_mm512_permute_ps(a, 0xB1), yh);
+            z = _mm512_fmaddsub_ps(a, yl, tmp2);
+            tmp2 = _mm512_mul_ps(_mm512_permute_ps(eight_phase_acc_reg, 0xB1), yhp);
+            eight_phase_acc_reg = _mm512_fmaddsub_ps(eight_phase_acc_reg, ylp, tmp2);
+
+            yl = _mm512_moveldup_ps(z);
+            yh = _mm512_movehdup_ps(z);
+
+            //next eight samples
+            _in_common += 8;
+
+            for (int n_vec = 0; n_vec < num_a_vectors; n_vec++)
+                {
+                    b = _mm512_load_ps((float*)&(_in_a[n_vec][number * 8]));
+                    acc_l[n_vec] = _mm512_fmadd_ps(b, yl, acc_l[n_vec]);
+                    acc_h[n_vec] = _mm512_fmadd_ps(_mm512_permute_ps(b, 0xB1), yh, acc_h[n_vec]);
+                }
+            // Regenerate phase
+            if ((number % ROTATOR_RELOAD) == ROTATOR_RELOAD - 1)
+                {
+                    tmp1 = _mm512_mul_ps(eight_phase_acc_reg, eight_phase_acc_reg);
+                    tmp2 = _mm512_add_ps(tmp1, _mm512_permute_ps(tmp1, 0xB1));
+                    eight_phase_acc_reg = _mm512_div_ps(eight_phase_acc_reg, _mm512_sqrt_ps(tmp2));
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_a_vectors; n_vec++)
+        {
+            // there is no 512-bit addsub: acc_l * 1 -/+ acc_h
+            z = _mm512_fmaddsub_ps(acc_l[n_vec], _mm512_set1_ps(1.0f), acc_h[n_vec]);
+            _mm512_store_ps((float*)dotProductVector, z); // Store the results back into the dot product vector
+            dotProduct = lv_cmake(0,0);
+            for (int i = 0; i < 8; ++i)
+                {
+                    dotProduct = dotProduct + dotProductVector[i];
+                }
+            result[n_vec] = dotProduct;
+        }
+    volk_gnsssdr_free(acc);
+
+    tmp1 = _mm512_mul_ps(eight_phase_acc_reg, eight_phase_acc_reg);
+    tmp2 = _mm512_add_ps(tmp1, _mm512_permute_ps(tmp1, 0xB1));
+    eight_phase_acc_reg = _mm512_div_ps(eight_phase_acc_reg, _mm512_sqrt_ps(tmp2));
+
+    _mm512_store_ps((float*)eight_phase_acc, eight_phase_acc_reg);
+    _phase  = eight_phase_acc[0];
+    _mm256_zeroupper();
+
+    for(unsigned int n  = avx512_iters * 8; n < num_points; n++)
+        {
+            tmp32_1 = *_in_common++ * _phase;
+            _phase *= phase_inc;
+            for (int n_vec = 0; n_vec < num_a_vectors; n_vec++)
+                {
+                    tmp32_2 = tmp32_1 * _in_a[n_vec][n];
+                    result[n_vec] += tmp32_2;
+                }
+        }
+    (*phase) = _phase;
+}
+#endif /* LV_HAVE_AVX512F */
+
+
 #ifdef LV_HAVE_NEON
 #include <arm_neon.h>
 
@@ -0,0 +1,512 @@
+/*!
+ * \file volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_xm.h
+ * \brief VOLK_GNSSSDR kernel: correlates a common complex (32-bit float per component) vector
+ * with M groups of N vectors, rotating it with a different phase for each group.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * VOLK_GNSSSDR kernel that extends volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn to
+ * several output groups (e.g., several channels fed by the same signal), each one with
+ * its own phase offset, phase increment and set of N local codes. Every chunk of the common
+ * vector is loaded once and used by all the groups.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+/*!
+ * \page volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_xm
+ *
+ * \b Overview
+ *
+ * For each one of \p num_out_groups groups, rotates the reference complex vector at the rate
+ * \p phase_inc[m] per sample, from the initial phase \p phase[m], multiplies it with the
+ * \p num_a_vectors vectors of the group, accumulates the results and stores them in the output vector.
+ * The vectors of group m are in_a[m * num_a_vectors] to in_a[(m + 1) * num_a_vectors - 1],
+ * and their results are stored in the same positions of \p result.
+ * This function can be used for Doppler wipe-off and multiple correlator of several channels sharing the same input.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_xm(lv_32fc_t* result, const lv_32fc_t* in_common, const lv_32fc_t* phase_inc, lv_32fc_t* phase, const lv_32fc_t** in_a, int num_a_vectors, int num_out_groups, unsigned int num_points)
+ * \endcode
+ *
+ * \b Inputs
+ * \li in_common:      Pointer to one of the vectors to be rotated, multiplied and accumulated (reference vector).
+ * \li phase_inc:      Phase increment of each group = lv_cmake(cos(phase_step_rad), sin(phase_step_rad))
+ * \li phase:          Initial phase of each group = lv_cmake(cos(initial_phase_rad), sin(initial_phase_rad))
+ * \li in_a:           Pointer to an array of \p num_out_groups * \p num_a_vectors pointers to the vectors to be multiplied and accumulated.
+ * \li num_a_vectors:  Number of vectors of each group.
+ * \li num_out_groups: Number of groups.
+ * \li num_points:     Number of complex values to be multiplied together, accumulated and stored into \p result.
+ *
+ * \b Outputs
+ * \li phase:          Final phase of each group.
+ * \li result:         Vector of \p num_out_groups * \p num_a_vectors components with the vectors of \p in_a multiplied by the rotated \p in_common and accumulated.
+ *
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_xm_H
+#define INCLUDED_volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_xm_H
+
+
+#include <volk_gnsssdr/volk_gnsssdr.h>
+#include <volk_gnsssdr/volk_gnsssdr_malloc.h>
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+#include <math.h>
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_xm_generic(lv_32fc_t* result, const lv_32fc_t* in_common, const lv_32fc_t* phase_inc, lv_32fc_t* phase, const lv_32fc_t** in_a, int num_a_vectors, int num_out_groups, unsigned int num_points)
+{
+    lv_32fc_t tmp32_1, tmp32_2;
+    const unsigned int ROTATOR_RELOAD = 256;
+    for (int n_vec = 0; n_vec < num_out_groups * num_a_vectors; n_vec++)
+        {
+            result[n_vec] = lv_cmake(0,0);
+        }
+
+    for (unsigned int n = 0; n < num_points; n++)
+        {
+            tmp32_1 = in_common[n];
+            for (int n_group = 0; n_group < num_out_groups; n_group++)
+                {
+                    tmp32_2 = tmp32_1 * phase[n_group];
+                    phase[n_group] *= phase_inc[n_group];
+                    for (int n_vec = n_group * num_a_vectors; n_vec < (n_group + 1) * num_a_vectors; n_vec++)
+                        {
+                            result[n_vec] += tmp32_2 * in_a[n_vec][n];
+                        }
+                }
+
+            // Regenerate phases
+            if ((n % ROTATOR_RELOAD) == ROTATOR_RELOAD - 1)
+                {
+                    for (int n_group = 0; n_group < num_out_groups; n_group++)
+                        {
+#ifdef __cplusplus
+                            phase[n_group] /= std::abs(phase[n_group]);
+#else
+                            phase[n_group] /= hypotf(lv_creal(phase[n_group]), lv_cimag(phase[n_group]));
+#endif
+                        }
+                }
+        }
+}
+
+#endif /*LV_HAVE_GENERIC*/
+
+
+#ifdef LV_HAVE_AVX
+#include <immintrin.h>
+
+static inline void volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_xm_u_avx(lv_32fc_t* result, const lv_32fc_t* in_common, const lv_32fc_t* phase_inc, lv_32fc_t* phase, const lv_32fc_t** in_a, int num_a_vectors, int num_out_groups, unsigned int num_points)
+{
+    lv_32fc_t dotProduct = lv_cmake(0,0);
+    lv_32fc_t tmp32_1, tmp32_2;
+    const unsigned int avx_iters = num_points / 4;
+    const int num_out_vectors = num_out_groups * num_a_vectors;
+
+    const lv_32fc_t** _in_a = in_a;
+    const lv_32fc_t* _in_common = in_common;
+
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t dotProductVector[4];
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t four_phase_acc[4];
+
+    __m256* acc = (__m256*)volk_gnsssdr_malloc(num_out_vectors * sizeof(__m256), volk_gnsssdr_get_alignment());
+    // phase of the four current samples and phase increment of four samples, for each group
+    __m256* four_phase_acc_reg = (__m256*)volk_gnsssdr_malloc(num_out_groups * sizeof(__m256), volk_gnsssdr_get_alignment());
+    __m256* four_phase_inc_reg = (__m256*)volk_gnsssdr_malloc(num_out_groups * sizeof(__m256), volk_gnsssdr_get_alignment());
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            acc[n_vec] = _mm256_setzero_ps();
+        }
+
+    for (int n_group = 0; n_group < num_out_groups; n_group++)
+        {
+            const lv_32fc_t phase_inc2 = phase_inc[n_group] * phase_inc[n_group];
+            const lv_32fc_t phase_inc4 = phase_inc2 * phase_inc2;
+            four_phase_acc[0] = phase[n_group];
+            four_phase_acc[1] = phase[n_group] * phase_inc[n_group];
+            four_phase_acc[2] = phase[n_group] * phase_inc2;
+            four_phase_acc[3] = four_phase_acc[1] * phase_inc2;
+            four_phase_acc_reg[n_group] = _mm256_load_ps((float*)four_phase_acc);
+            four_phase_acc[0] = phase_inc4;
+            four_phase_acc[1] = phase_inc4;
+            four_phase_acc[2] = phase_inc4;
+            four_phase_acc[3] = phase_inc4;
+            four_phase_inc_reg[n_group] = _mm256_load_ps((float*)four_phase_acc);
+        }
+
+    __m256 a, b, z, yl, yh, tmp1, tmp2;
+
+    for(unsigned int number = 0; number < avx_iters; number++)
+        {
+            // the common input is loaded once for all the groups
+            a = _mm256_loadu_ps((float*)_in_common);
+            __builtin_prefetch(_in_common + 16);
+            _in_common += 4;
+
+            for (int n_group = 0; n_group < num_out_groups; n_group++)
+                {
+                    // Phase rotation of in_common for this group
+                    yl = _mm256_moveldup_ps(four_phase_acc_reg[n_group]); // Load yl with cr,cr,dr,dr
+                    yh = _mm256_movehdup_ps(four_phase_acc_reg[n_group]);
+                    tmp1 = _mm256_mul_ps(a, yl);
+                    tmp2 = _mm256_mul_ps(_mm256_shuffle_ps(a, a, 0xB1), yh);
+                    b = _mm256_addsub_ps(tmp1, tmp2);
+
+                    yl = _mm256_moveldup_ps(four_phase_inc_reg[n_group]);
+                    yh = _mm256_movehdup_ps(four_phase_inc_reg[n_group]);
+                    tmp1 = _mm256_mul_ps(four_phase_acc_reg[n_group], yl);
+                    tmp2 = _mm256_mul_ps(_mm256_shuffle_ps(four_phase_acc_reg[n_group], four_phase_acc_reg[n_group], 0xB1), yh);
+                    four_phase_acc_reg[n_group] = _mm256_addsub_ps(tmp1, tmp2);
+
+                    yl = _mm256_moveldup_ps(b);
+                    yh = _mm256_movehdup_ps(b);
+                    for (int n_vec = n_group * num_a_vectors; n_vec < (n_group + 1) * num_a_vectors; n_vec++)
+                        {
+                            z = _mm256_loadu_ps((float*)&(_in_a[n_vec][number * 4]));
+                            tmp1 = _mm256_mul_ps(z, yl);
+                            z = _mm256_shuffle_ps(z, z, 0xB1);
+                            tmp2 = _mm256_mul_ps(z, yh);
+                            z = _mm256_addsub_ps(tmp1, tmp2);
+                            acc[n_vec] = _mm256_add_ps(acc[n_vec], z);
+                        }
+
+                    // Regenerate phase
+                    if ((number % 64) == 63)
+                        {
+                            tmp1 = _mm256_mul_ps(four_phase_acc_reg[n_group], four_phase_acc_reg[n_group]);
+                            tmp2 = _mm256_add_ps(tmp1, _mm256_shuffle_ps(tmp1, tmp1, 0xB1));
+                            four_phase_acc_reg[n_group] = _mm256_div_ps(four_phase_acc_reg[n_group], _mm256_sqrt_ps(tmp2));
+                        }
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            _mm256_store_ps((float*)dotProductVector, acc[n_vec]); // Store the results back into the dot product vector
+            dotProduct = lv_cmake(0,0);
+            for (int i = 0; i < 4; ++i)
+                {
+                    dotProduct = dotProduct + dotProductVector[i];
+                }
+            result[n_vec] = dotProduct;
+        }
+
+    for (int n_group = 0; n_group < num_out_groups; n_group++)
+        {
+            _mm256_store_ps((float*)four_phase_acc, four_phase_acc_reg[n_group]);
+            phase[n_group] = four_phase_acc[0];
+        }
+    volk_gnsssdr_free(acc);
+    volk_gnsssdr_free(four_phase_acc_reg);
+    volk_gnsssdr_free(four_phase_inc_reg);
+    _mm256_zeroupper();
+
+    for(unsigned int n = avx_iters * 4; n < num_points; n++)
+        {
+            for (int n_group = 0; n_group < num_out_groups; n_group++)
+                {
+                    tmp32_1 = in_common[n] * phase[n_group];
+                    phase[n_group] *= phase_inc[n_group];
+                    for (int n_vec = n_group * num_a_vectors; n_vec < (n_group + 1) * num_a_vectors; n_vec++)
+                        {
+                            tmp32_2 = tmp32_1 * in_a[n_vec][n];
+                            result[n_vec] += tmp32_2;
+                        }
+                }
+        }
+}
+
+#endif /* LV_HAVE_AVX */
+
+
+#ifdef LV_HAVE_AVX
+#include <immintrin.h>
+
+static inline void volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_xm_a_avx(lv_32fc_t* result, const lv_32fc_t* in_common, const lv_32fc_t* phase_inc, lv_32fc_t* phase, const lv_32fc_t** in_a, int num_a_vectors, int num_out_groups, unsigned int num_points)
+{
+    lv_32fc_t dotProduct = lv_cmake(0,0);
+    lv_32fc_t tmp32_1, tmp32_2;
+    const unsigned int avx_iters = num_points / 4;
+    const int num_out_vectors = num_out_groups * num_a_vectors;
+
+    const lv_32fc_t** _in_a = in_a;
+    const lv_32fc_t* _in_common = in_common;
+
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t dotProductVector[4];
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t four_phase_acc[4];
+
+    __m256* acc = (__m256*)volk_gnsssdr_malloc(num_out_vectors * sizeof(__m256), volk_gnsssdr_get_alignment());
+    // phase of the four current samples and phase increment of four samples, for each group
+    __m256* four_phase_acc_reg = (__m256*)volk_gnsssdr_malloc(num_out_groups * sizeof(__m256), volk_gnsssdr_get_alignment());
+    __m256* four_phase_inc_reg = (__m256*)volk_gnsssdr_malloc(num_out_groups * sizeof(__m256), volk_gnsssdr_get_alignment());
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            acc[n_vec] = _mm256_setzero_ps();
+        }
+
+    for (int n_group = 0; n_group < num_out_groups; n_group++)
+        {
+            const lv_32fc_t phase_inc2 = phase_inc[n_group] * phase_inc[n_group];
+            const lv_32fc_t phase_inc4 = phase_inc2 * phase_inc2;
+            four_phase_acc[0] = phase[n_group];
+            four_phase_acc[1] = phase[n_group] * phase_inc[n_group];
+            four_phase_acc[2] = phase[n_group] * phase_inc2;
+            four_phase_acc[3] = four_phase_acc[1] * phase_inc2;
+            four_phase_acc_reg[n_group] = _mm256_load_ps((float*)four_phase_acc);
+            four_phase_acc[0] = phase_inc4;
+            four_phase_acc[1] = phase_inc4;
+            four_phase_acc[2] = phase_inc4;
+            four_phase_acc[3] = phase_inc4;
+            four_phase_inc_reg[n_group] = _mm256_load_ps((float*)four_phase_acc);
+        }
+
+    __m256 a, b, z, yl, yh, tmp1, tmp2;
+
+    for(unsigned int number = 0; number < avx_iters; number++)
+        {
+            // the common input is loaded once for all the groups
+            a = _mm256_load_ps((float*)_in_common);
+            __builtin_prefetch(_in_common + 16);
+            _in_common += 4;
+
+            for (int n_group = 0; n_group < num_out_groups; n_group++)
+                {
+                    // Phase rotation of in_common for this group
+                    yl = _mm256_moveldup_ps(four_phase_acc_reg[n_group]); // Load yl with cr,cr,dr,dr
+                    yh = _mm256_movehdup_ps(four_phase_acc_reg[n_group]);
+                    tmp1 = _mm256_mul_ps(a, yl);
+                    tmp2 = _mm256_mul_ps(_mm256_shuffle_ps(a, a, 0xB1), yh);
+                    b = _mm256_addsub_ps(tmp1, tmp2);
+
+                    yl = _mm256_moveldup_ps(four_phase_inc_reg[n_group]);
+                    yh = _mm256_movehdup_ps(four_phase_inc_reg[n_group]);
+                    tmp1 = _mm256_mul_ps(four_phase_acc_reg[n_group], yl);
+                    tmp2 = _mm256_mul_ps(_mm256_shuffle_ps(four_phase_acc_reg[n_group], four_phase_acc_reg[n_group], 0xB1), yh);
+                    four_phase_acc_reg[n_group] = _mm256_addsub_ps(tmp1, tmp2);
+
+                    yl = _mm256_moveldup_ps(b);
+                    yh = _mm256_movehdup_ps(b);
+                    for (int n_vec = n_group * num_a_vectors; n_vec < (n_group + 1) * num_a_vectors; n_vec++)
+                        {
+                            z = _mm256_load_ps((float*)&(_in_a[n_vec][number * 4]));
+                            tmp1 = _mm256_mul_ps(z, yl);
+                            z = _mm256_shuffle_ps(z, z, 0xB1);
+                            tmp2 = _mm256_mul_ps(z, yh);
+                            z = _mm256_addsub_ps(tmp1, tmp2);
+                            acc[n_vec] = _mm256_add_ps(acc[n_vec], z);
+                        }
+
+                    // Regenerate phase
+                    if ((number % 64) == 63)
+                        {
+                            tmp1 = _mm256_mul_ps(four_phase_acc_reg[n_group], four_phase_acc_reg[n_group]);
+                            tmp2 = _mm256_add_ps(tmp1, _mm256_shuffle_ps(tmp1, tmp1, 0xB1));
+                            four_phase_acc_reg[n_group] = _mm256_div_ps(four_phase_acc_reg[n_group], _mm256_sqrt_ps(tmp2));
+                        }
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            _mm256_store_ps((float*)dotProductVector, acc[n_vec]); // Store the results back into the dot product vector
+            dotProduct = lv_cmake(0,0);
+            for (int i = 0; i < 4; ++i)
+                {
+                    dotProduct = dotProduct + dotProductVector[i];
+                }
+            result[n_vec] = dotProduct;
+        }
+
+    for (int n_group = 0; n_group < num_out_groups; n_group++)
+        {
+            _mm256_store_ps((float*)four_phase_acc, four_phase_acc_reg[n_group]);
+            phase[n_group] = four_phase_acc[0];
+        }
+    volk_gnsssdr_free(acc);
+    volk_gnsssdr_free(four_phase_acc_reg);
+    volk_gnsssdr_free(four_phase_inc_reg);
+    _mm256_zeroupper();
+
+    for(unsigned int n = avx_iters * 4; n < num_points; n++)
+        {
+            for (int n_group = 0; n_group < num_out_groups; n_group++)
+                {
+                    tmp32_1 = in_common[n] * phase[n_group];
+                    phase[n_group] *= phase_inc[n_group];
+                    for (int n_vec = n_group * num_a_vectors; n_vec < (n_group + 1) * num_a_vectors; n_vec++)
+                        {
+                            tmp32_2 = tmp32_1 * in_a[n_vec][n];
+                            result[n_vec] += tmp32_2;
+                        }
+                }
+        }
+}
+
+#endif /* LV_HAVE_AVX */
+
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_xm_neon(lv_32fc_t* result, const lv_32fc_t* in_common, const lv_32fc_t* phase_inc, lv_32fc_t* phase, const lv_32fc_t** in_a, int num_a_vectors, int num_out_groups, unsigned int num_points)
+{
+    const unsigned int neon_iters = num_points / 4;
+    const int num_out_vectors = num_out_groups * num_a_vectors;
+
+    const lv_32fc_t* _in_common = in_common;
+    lv_32fc_t dotProduct = lv_cmake(0,0);
+    lv_32fc_t tmp32_1, tmp32_2;
+
+    __VOLK_ATTR_ALIGNED(16) float32_t __phase_real[4];
+    __VOLK_ATTR_ALIGNED(16) float32_t __phase_imag[4];
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t dotProductVector[4];
+
+    float32x4x2_t* accumulator = (float32x4x2_t*)volk_gnsssdr_malloc(num_out_vectors * sizeof(float32x4x2_t), volk_gnsssdr_get_alignment());
+    // phase of the four current samples (real, imag) and phase increment of four samples (real, imag), for each group
+    float32x4_t* phase_regs = (float32x4_t*)volk_gnsssdr_malloc(4 * num_out_groups * sizeof(float32x4_t), volk_gnsssdr_get_alignment());
+    float32x4_t* _phase_real = phase_regs;
+    float32x4_t* _phase_imag = phase_regs + num_out_groups;
+    float32x4_t* _phase4_real = phase_regs + 2 * num_out_groups;
+    float32x4_t* _phase4_imag = phase_regs + 3 * num_out_groups;
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            accumulator[n_vec].val[0] = vdupq_n_f32(0.0f);
+            accumulator[n_vec].val[1] = vdupq_n_f32(0.0f);
+        }
+
+    for (int n_group = 0; n_group < num_out_groups; n_group++)
+        {
+            lv_32fc_t phase_n = phase[n_group];
+            for (int i = 0; i < 4; i++)
+                {
+                    __phase_real[i] = lv_creal(phase_n);
+                    __phase_imag[i] = lv_cimag(phase_n);
+                    phase_n *= phase_inc[n_group];
+                }
+            _phase_real[n_group] = vld1q_f32(__phase_real);
+            _phase_imag[n_group] = vld1q_f32(__phase_imag);
+            lv_32fc_t ___phase4 = phase_inc[n_group] * phase_inc[n_group] * phase_inc[n_group] * phase_inc[n_group];
+            _phase4_real[n_group] = vdupq_n_f32(lv_creal(___phase4));
+            _phase4_imag[n_group] = vdupq_n_f32(lv_cimag(___phase4));
+        }
+
+    float32x4x2_t a_val, b_val, c_val, tmp32_real, tmp32_imag;
+    float32x4_t mag2, inv_mag;
+
+    for(unsigned int number = 0; number < neon_iters; number++)
+        {
+            /* the common input is loaded once for all the groups */
+            a_val = vld2q_f32((float32_t*)_in_common);
+            __builtin_prefetch(_in_common + 8);
+            _in_common += 4;
+
+            for (int n_group = 0; n_group < num_out_groups; n_group++)
+                {
+                    /* complex multiplication of four complex samples by the phases of this group */
+                    tmp32_real.val[0] = vmulq_f32(a_val.val[0], _phase_real[n_group]);
+                    tmp32_real.val[1] = vmulq_f32(a_val.val[1], _phase_imag[n_group]);
+                    tmp32_imag.val[0] = vmulq_f32(a_val.val[0], _phase_imag[n_group]);
+                    tmp32_imag.val[1] = vmulq_f32(a_val.val[1], _phase_real[n_group]);
+
+                    b_val.val[0] = vsubq_f32(tmp32_real.val[0], tmp32_real.val[1]);
+                    b_val.val[1] = vaddq_f32(tmp32_imag.val[0], tmp32_imag.val[1]);
+
+                    /* compute next four phases */
+                    tmp32_real.val[0] = vmulq_f32(_phase_real[n_group], _phase4_real[n_group]);
+                    tmp32_real.val[1] = vmulq_f32(_phase_imag[n_group], _phase4_imag[n_group]);
+                    tmp32_imag.val[0] = vmulq_f32(_phase_real[n_group], _phase4_imag[n_group]);
+                    tmp32_imag.val[1] = vmulq_f32(_phase_imag[n_group], _phase4_real[n_group]);
+
+                    _phase_real[n_group] = vsubq_f32(tmp32_real.val[0], tmp32_real.val[1]);
+                    _phase_imag[n_group] = vaddq_f32(tmp32_imag.val[0], tmp32_imag.val[1]);
+
+                    for (int n_vec = n_group * num_a_vectors; n_vec < (n_group + 1) * num_a_vectors; n_vec++)
+                        {
+                            c_val = vld2q_f32((float32_t*)&(in_a[n_vec][number * 4]));
+
+                            accumulator[n_vec].val[0] = vmlaq_f32(accumulator[n_vec].val[0], c_val.val[0], b_val.val[0]);
+                            accumulator[n_vec].val[0] = vmlsq_f32(accumulator[n_vec].val[0], c_val.val[1], b_val.val[1]);
+                            accumulator[n_vec].val[1] = vmlaq_f32(accumulator[n_vec].val[1], c_val.val[0], b_val.val[1]);
+                            accumulator[n_vec].val[1] = vmlaq_f32(accumulator[n_vec].val[1], c_val.val[1], b_val.val[0]);
+                        }
+
+                    // Regenerate phase
+                    if ((number % 64) == 63)
+                        {
+                            mag2 = vaddq_f32(vmulq_f32(_phase_real[n_group], _phase_real[n_group]), vmulq_f32(_phase_imag[n_group], _phase_imag[n_group]));
+                            inv_mag = vrsqrteq_f32(mag2);
+                            inv_mag = vmulq_f32(vrsqrtsq_f32(vmulq_f32(mag2, inv_mag), inv_mag), inv_mag);
+                            inv_mag = vmulq_f32(vrsqrtsq_f32(vmulq_f32(mag2, inv_mag), inv_mag), inv_mag);
+                            _phase_real[n_group] = vmulq_f32(_phase_real[n_group], inv_mag);
+                            _phase_imag[n_group] = vmulq_f32(_phase_imag[n_group], inv_mag);
+                        }
+                }
+        }
+
+    for (int n_vec = 0; n_vec < num_out_vectors; n_vec++)
+        {
+            vst2q_f32((float32_t*)dotProductVector, accumulator[n_vec]); // Store the results back into the dot product vector
+            dotProduct = lv_cmake(0,0);
+            for (int i = 0; i < 4; ++i)
+                {
+                    dotProduct = dotProduct + dotProductVector[i];
+                }
+            result[n_vec] = dotProduct;
+        }
+
+    for (int n_group = 0; n_group < num_out_groups; n_group++)
+        {
+            vst1q_f32(__phase_real, _phase_real[n_group]);
+            vst1q_f32(__phase_imag, _phase_imag[n_group]);
+            phase[n_group] = lv_cmake(__phase_real[0], __phase_imag[0]);
+        }
+    volk_gnsssdr_free(accumulator);
+    volk_gnsssdr_free(phase_regs);
+
+    for(unsigned int n = neon_iters * 4; n < num_points; n++)
+        {
+            for (int n_group = 0; n_group < num_out_groups; n_group++)
+                {
+                    tmp32_1 = in_common[n] * phase[n_group];
+                    phase[n_group] *= phase_inc[n_group];
+                    for (int n_vec = n_group * num_a_vectors; n_vec < (n_group + 1) * num_a_vectors; n_vec++)
+                        {
+                            tmp32_2 = tmp32_1 * in_a[n_vec][n];
+                            result[n_vec] += tmp32_2;
+                        }
+                }
+        }
+}
+
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_xm_H */
@@ -0,0 +1,183 @@
+/*!
+ * \file volk_gnsssdr_32fc_x2_rotator_dotprodxnxmpuppet_32fc.h
+ * \brief Volk puppet for the multiple group 32-bit complex rotator dot product kernel.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * Volk puppet for integrating the multiple group rotator dot product into volk's test system
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_32fc_x2_rotator_dotprodxnxmpuppet_32fc_H
+#define INCLUDED_volk_gnsssdr_32fc_x2_rotator_dotprodxnxmpuppet_32fc_H
+
+#include "volk_gnsssdr/volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_xm.h"
+#include <volk_gnsssdr/volk_gnsssdr_malloc.h>
+#include <volk_gnsssdr/volk_gnsssdr.h>
+#include <string.h>
+
+#ifdef LV_HAVE_GENERIC
+static inline void volk_gnsssdr_32fc_x2_rotator_dotprodxnxmpuppet_32fc_generic(lv_32fc_t* result, const lv_32fc_t* local_code,  const lv_32fc_t* in, unsigned int num_points)
+{
+    // phases must be normalized. Phase rotator expects a complex exponential input!
+    // two groups with different carrier phase and Doppler
+    float rem_carrier_phase_in_rad[2] = { 0.345, -1.2 };
+    float phase_step_rad[2] = { 0.1, -0.03 };
+    lv_32fc_t phase[2];
+    lv_32fc_t phase_inc[2];
+    int num_out_groups = 2;
+    for(int n = 0; n < num_out_groups; n++)
+        {
+            phase[n] = lv_cmake(cos(rem_carrier_phase_in_rad[n]), sin(rem_carrier_phase_in_rad[n]));
+            phase_inc[n] = lv_cmake(cos(phase_step_rad[n]), sin(phase_step_rad[n]));
+        }
+
+    int num_a_vectors = 3;
+    lv_32fc_t** in_a = (lv_32fc_t**)volk_gnsssdr_malloc(sizeof(lv_32fc_t*) * num_a_vectors * num_out_groups, volk_gnsssdr_get_alignment());
+    for(int n = 0; n < num_a_vectors * num_out_groups; n++)
+        {
+            in_a[n] = (lv_32fc_t*)volk_gnsssdr_malloc(sizeof(lv_32fc_t) * num_points, volk_gnsssdr_get_alignment());
+            memcpy((lv_32fc_t*)in_a[n], (lv_32fc_t*)in, sizeof(lv_32fc_t) * num_points);
+        }
+    volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_xm_generic(result, local_code, phase_inc, phase, (const lv_32fc_t**) in_a, num_a_vectors, num_out_groups, num_points);
+
+    for(int n = 0; n < num_a_vectors * num_out_groups; n++)
+        {
+            volk_gnsssdr_free(in_a[n]);
+        }
+    volk_gnsssdr_free(in_a);
+}
+
+#endif  // Generic
+
+
+#ifdef LV_HAVE_AVX
+static inline void volk_gnsssdr_32fc_x2_rotator_dotprodxnxmpuppet_32fc_a_avx(lv_32fc_t* result, const lv_32fc_t* local_code,  const lv_32fc_t* in, unsigned int num_points)
+{
+    // phases must be normalized. Phase rotator expects a complex exponential input!
+    // two groups with different carrier phase and Doppler
+    float rem_carrier_phase_in_rad[2] = { 0.345, -1.2 };
+    float phase_step_rad[2] = { 0.1, -0.03 };
+    lv_32fc_t phase[2];
+    lv_32fc_t phase_inc[2];
+    int num_out_groups = 2;
+    for(int n = 0; n < num_out_groups; n++)
+        {
+            phase[n] = lv_cmake(cos(rem_carrier_phase_in_rad[n]), sin(rem_carrier_phase_in_rad[n]));
+            phase_inc[n] = lv_cmake(cos(phase_step_rad[n]), sin(phase_step_rad[n]));
+        }
+
+    int num_a_vectors = 3;
+    lv_32fc_t** in_a = (lv_32fc_t**)volk_gnsssdr_malloc(sizeof(lv_32fc_t*) * num_a_vectors * num_out_groups, volk_gnsssdr_get_alignment());
+    for(int n = 0; n < num_a_vectors * num_out_groups; n++)
+        {
+            in_a[n] = (lv_32fc_t*)volk_gnsssdr_malloc(sizeof(lv_32fc_t) * num_points, volk_gnsssdr_get_alignment());
+            memcpy((lv_32fc_t*)in_a[n], (lv_32fc_t*)in, sizeof(lv_32fc_t) * num_points);
+        }
+    volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_xm_a_avx(result, local_code, phase_inc, phase, (const lv_32fc_t**) in_a, num_a_vectors, num_out_groups, num_points);
+
+    for(int n = 0; n < num_a_vectors * num_out_groups; n++)
+        {
+            volk_gnsssdr_free(in_a[n]);
+        }
+    volk_gnsssdr_free(in_a);
+}
+
+#endif  // AVX
+
+
+#ifdef LV_HAVE_AVX
+static inline void volk_gnsssdr_32fc_x2_rotator_dotprodxnxmpuppet_32fc_u_avx(lv_32fc_t* result, const lv_32fc_t* local_code,  const lv_32fc_t* in, unsigned int num_points)
+{
+    // phases must be normalized. Phase rotator expects a complex exponential input!
+    // two groups with different carrier phase and Doppler
+    float rem_carrier_phase_in_rad[2] = { 0.345, -1.2 };
+    float phase_step_rad[2] = { 0.1, -0.03 };
+    lv_32fc_t phase[2];
+    lv_32fc_t phase_inc[2];
+    int num_out_groups = 2;
+    for(int n = 0; n < num_out_groups; n++)
+        {
+            phase[n] = lv_cmake(cos(rem_carrier_phase_in_rad[n]), sin(rem_carrier_phase_in_rad[n]));
+            phase_inc[n] = lv_cmake(cos(phase_step_rad[n]), sin(phase_step_rad[n]));
+        }
+
+    int num_a_vectors = 3;
+    lv_32fc_t** in_a = (lv_32fc_t**)volk_gnsssdr_malloc(sizeof(lv_32fc_t*) * num_a_vectors * num_out_groups, volk_gnsssdr_get_alignment());
+    for(int n = 0; n < num_a_vectors * num_out_groups; n++)
+        {
+            in_a[n] = (lv_32fc_t*)volk_gnsssdr_malloc(sizeof(lv_32fc_t) * num_points, volk_gnsssdr_get_alignment());
+            memcpy((lv_32fc_t*)in_a[n], (lv_32fc_t*)in, sizeof(lv_32fc_t) * num_points);
+        }
+    volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_xm_u_avx(result, local_code, phase_inc, phase, (const lv_32fc_t**) in_a, num_a_vectors, num_out_groups, num_points);
+
+    for(int n = 0; n < num_a_vectors * num_out_groups; n++)
+        {
+            volk_gnsssdr_free(in_a[n]);
+        }
+    volk_gnsssdr_free(in_a);
+}
+
+#endif  // AVX
+
+
+#ifdef LV_HAVE_NEON
+static inline void volk_gnsssdr_32fc_x2_rotator_dotprodxnxmpuppet_32fc_neon(lv_32fc_t* result, const lv_32fc_t* local_code,  const lv_32fc_t* in, unsigned int num_points)
+{
+    // phases must be normalized. Phase rotator expects a complex exponential input!
+    // two groups with different carrier phase and Doppler
+    float rem_carrier_phase_in_rad[2] = { 0.345, -1.2 };
+    float phase_step_rad[2] = { 0.1, -0.03 };
+    lv_32fc_t phase[2];
+    lv_32fc_t phase_inc[2];
+    int num_out_groups = 2;
+    for(int n = 0; n < num_out_groups; n++)
+        {
+            phase[n] = lv_cmake(cos(rem_carrier_phase_in_rad[n]), sin(rem_carrier_phase_in_rad[n]));
+            phase_inc[n] = lv_cmake(cos(phase_step_rad[n]), sin(phase_step_rad[n]));
+        }
+
+    int num_a_vectors = 3;
+    lv_32fc_t** in_a = (lv_32fc_t**)volk_gnsssdr_malloc(sizeof(lv_32fc_t*) * num_a_vectors * num_out_groups, volk_gnsssdr_get_alignment());
+    for(int n = 0; n < num_a_vectors * num_out_groups; n++)
+        {
+            in_a[n] = (lv_32fc_t*)volk_gnsssdr_malloc(sizeof(lv_32fc_t) * num_points, volk_gnsssdr_get_alignment());
+            memcpy((lv_32fc_t*)in_a[n], (lv_32fc_t*)in, sizeof(lv_32fc_t) * num_points);
+        }
+    volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_xm_neon(result, local_code, phase_inc, phase, (const lv_32fc_t**) in_a, num_a_vectors, num_out_groups, num_points);
+
+    for(int n = 0; n < num_a_vectors * num_out_groups; n++)
+        {
+            volk_gnsssdr_free(in_a[n]);
+        }
+    volk_gnsssdr_free(in_a);
+}
+
+#endif  // NEON
+
+
+#endif  // INCLUDED_volk_gnsssdr_32fc_x2_rotator_dotprodxnxmpuppet_32fc_H
@@ -0,0 +1,218 @@
+/*!
+ * \file volk_gnsssdr_32fc_xn_weighted_sum_32fc.h
+ * \brief VOLK_GNSSSDR kernel: sums N complex vectors, each one multiplied
+ * by its own complex weight.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * VOLK_GNSSSDR kernel that combines the channels of an antenna array into
+ * one output (spatial filtering, beamforming)
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+/*!
+ * \page volk_gnsssdr_32fc_xn_weighted_sum_32fc
+ *
+ * \b Overview
+ *
+ * Computes result[n] = sum_k weights[k] * in[k][n], for k from 0 to
+ * num_in_vectors - 1.
+ *
+ * There are no aligned versions: the dispatcher would only check the
+ * alignment of the array of pointers, not of the vectors it points to.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_gnsssdr_32fc_xn_weighted_sum_32fc(lv_32fc_t* result, const lv_32fc_t** in, const lv_32fc_t* weights, int num_in_vectors, unsigned int num_points);
+ * \endcode
+ *
+ * \b Inputs
+ * \li in:             Pointer to an array of pointers to the vectors to be combined.
+ * \li weights:        The num_in_vectors complex weights.
+ * \li num_in_vectors: Number of vectors in \p in.
+ * \li num_points:     Number of complex values in each vector.
+ *
+ * \b Outputs
+ * \li result:         The num_points weighted sums.
+ *
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_32fc_xn_weighted_sum_32fc_H
+#define INCLUDED_volk_gnsssdr_32fc_xn_weighted_sum_32fc_H
+
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_gnsssdr_32fc_xn_weighted_sum_32fc_generic(lv_32fc_t* result, const lv_32fc_t** in, const lv_32fc_t* weights, int num_in_vectors, unsigned int num_points)
+{
+    for (unsigned int n = 0; n < num_points; n++)
+        {
+            float sum_real = 0.0f;
+            float sum_imag = 0.0f;
+            for (int k = 0; k < num_in_vectors; k++)
+                {
+                    const float x_real = lv_creal(in[k][n]);
+                    const float x_imag = lv_cimag(in[k][n]);
+                    sum_real += x_real * lv_creal(weights[k]) - x_imag * lv_cimag(weights[k]);
+                    sum_imag += x_imag * lv_creal(weights[k]) + x_real * lv_cimag(weights[k]);
+                }
+            result[n] = lv_cmake(sum_real, sum_imag);
+        }
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+
+#ifdef LV_HAVE_SSE3
+#include <pmmintrin.h>
+
+static inline void volk_gnsssdr_32fc_xn_weighted_sum_32fc_u_sse3(lv_32fc_t* result, const lv_32fc_t** in, const lv_32fc_t* weights, int num_in_vectors, unsigned int num_points)
+{
+    const unsigned int sse_iters = num_points / 2;
+    __m128 x, x_swap, w_real, w_imag, acc;
+
+    for (unsigned int number = 0; number < sse_iters; number++)
+        {
+            acc = _mm_setzero_ps();
+            for (int k = 0; k < num_in_vectors; k++)
+                {
+                    w_real = _mm_set1_ps(lv_creal(weights[k]));
+                    w_imag = _mm_set1_ps(lv_cimag(weights[k]));
+                    x = _mm_loadu_ps((const float*)(in[k] + 2 * number)); // two complex samples of channel k
+                    x_swap = _mm_shuffle_ps(x, x, 0xB1); // imag, real
+                    // (xr * wr - xi * wi, xi * wr + xr * wi)
+                    acc = _mm_add_ps(acc, _mm_addsub_ps(_mm_mul_ps(x, w_real), _mm_mul_ps(x_swap, w_imag)));
+                }
+            _mm_storeu_ps((float*)(result + 2 * number), acc);
+        }
+
+    for (unsigned int n = sse_iters * 2; n < num_points; n++)
+        {
+            float sum_real = 0.0f;
+            float sum_imag = 0.0f;
+            for (int k = 0; k < num_in_vectors; k++)
+                {
+                    const float x_real = lv_creal(in[k][n]);
+                    const float x_imag = lv_cimag(in[k][n]);
+                    sum_real += x_real * lv_creal(weights[k]) - x_imag * lv_cimag(weights[k]);
+                    sum_imag += x_imag * lv_creal(weights[k]) + x_real * lv_cimag(weights[k]);
+                }
+            result[n] = lv_cmake(sum_real, sum_imag);
+        }
+}
+
+#endif /* LV_HAVE_SSE3 */
+
+
+#ifdef LV_HAVE_AVX
+#include <immintrin.h>
+
+static inline void volk_gnsssdr_32fc_xn_weighted_sum_32fc_u_avx(lv_32fc_t* result, const lv_32fc_t** in, const lv_32fc_t* weights, int num_in_vectors, unsigned int num_points)
+{
+    const unsigned int avx_iters = num_points / 4;
+    __m256 x, x_swap, w_real, w_imag, acc;
+
+    for (unsigned int number = 0; number < avx_iters; number++)
+        {
+            acc = _mm256_setzero_ps();
+            for (int k = 0; k < num_in_vectors; k++)
+                {
+                    w_real = _mm256_set1_ps(lv_creal(weights[k]));
+                    w_imag = _mm256_set1_ps(lv_cimag(weights[k]));
+                    x = _mm256_loadu_ps((const float*)(in[k] + 4 * number)); // four complex samples of channel k
+                    x_swap = _mm256_permute_ps(x, 0xB1);
+                    acc = _mm256_add_ps(acc, _mm256_addsub_ps(_mm256_mul_ps(x, w_real), _mm256_mul_ps(x_swap, w_imag)));
+                }
+            _mm256_storeu_ps((float*)(result + 4 * number), acc);
+        }
+    _mm256_zeroupper();
+
+    for (unsigned int n = avx_iters * 4; n < num_points; n++)
+        {
+            float sum_real = 0.0f;
+            float sum_imag = 0.0f;
+            for (int k = 0; k < num_in_vectors; k++)
+                {
+                    const float x_real = lv_creal(in[k][n]);
+                    const float x_imag = lv_cimag(in[k][n]);
+                    sum_real += x_real * lv_creal(weights[k]) - x_imag * lv_cimag(weights[k]);
+                    sum_imag += x_imag * lv_creal(weights[k]) + x_real * lv_cimag(weights[k]);
+                }
+            result[n] = lv_cmake(sum_real, sum_imag);
+        }
+}
+
+#endif /* LV_HAVE_AVX */
+
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_32fc_xn_weighted_sum_32fc_neon(lv_32fc_t* result, const lv_32fc_t** in, const lv_32fc_t* weights, int num_in_vectors, unsigned int num_points)
+{
+    const unsigned int neon_iters = num_points / 4;
+    float32x4x2_t x, acc;
+    float32x4_t w_real, w_imag;
+
+    for (unsigned int number = 0; number < neon_iters; number++)
+        {
+            acc.val[0] = vdupq_n_f32(0.0f);
+            acc.val[1] = vdupq_n_f32(0.0f);
+            for (int k = 0; k < num_in_vectors; k++)
+                {
+                    w_real = vdupq_n_f32(lv_creal(weights[k]));
+                    w_imag = vdupq_n_f32(lv_cimag(weights[k]));
+                    x = vld2q_f32((const float32_t*)(in[k] + 4 * number)); // deinterleaved: val[0] real, val[1] imag
+                    acc.val[0] = vmlaq_f32(acc.val[0], x.val[0], w_real);
+                    acc.val[0] = vmlsq_f32(acc.val[0], x.val[1], w_imag);
+                    acc.val[1] = vmlaq_f32(acc.val[1], x.val[1], w_real);
+                    acc.val[1] = vmlaq_f32(acc.val[1], x.val[0], w_imag);
+                }
+            vst2q_f32((float32_t*)(result + 4 * number), acc);
+        }
+
+    for (unsigned int n = neon_iters * 4; n < num_points; n++)
+        {
+            float sum_real = 0.0f;
+            float sum_imag = 0.0f;
+            for (int k = 0; k < num_in_vectors; k++)
+                {
+                    const float x_real = lv_creal(in[k][n]);
+                    const float x_imag = lv_cimag(in[k][n]);
+                    sum_real += x_real * lv_creal(weights[k]) - x_imag * lv_cimag(weights[k]);
+                    sum_imag += x_imag * lv_creal(weights[k]) + x_real * lv_cimag(weights[k]);
+                }
+            result[n] = lv_cmake(sum_real, sum_imag);
+        }
+}
+
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_gnsssdr_32fc_xn_weighted_sum_32fc_H */
@@ -0,0 +1,85 @@
+/*!
+ * \file volk_gnsssdr_32fc_xn_weightedsumpuppet_32fc.h
+ * \brief VOLK_GNSSSDR puppet for the weighted sum kernel.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * Wrapper of volk_gnsssdr_32fc_xn_weighted_sum_32fc with a single input vector,
+ * for the QA and the profiler
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_32fc_xn_weightedsumpuppet_32fc_H
+#define INCLUDED_volk_gnsssdr_32fc_xn_weightedsumpuppet_32fc_H
+
+#include "volk_gnsssdr/volk_gnsssdr_32fc_xn_weighted_sum_32fc.h"
+
+// The input is fed as the three channels of the sum, each one with its own weight
+#define VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_32FC_VECTORS 3
+
+
+#ifdef LV_HAVE_GENERIC
+static inline void volk_gnsssdr_32fc_xn_weightedsumpuppet_32fc_generic(lv_32fc_t* result, const lv_32fc_t* in, unsigned int num_points)
+{
+    const lv_32fc_t* in_a[VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_32FC_VECTORS] = {in, in, in};
+    const lv_32fc_t weights[VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_32FC_VECTORS] = {lv_cmake(0.5f, -0.25f), lv_cmake(-0.125f, 0.375f), lv_cmake(0.25f, 0.0625f)};
+    volk_gnsssdr_32fc_xn_weighted_sum_32fc_generic(result, in_a, weights, VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_32FC_VECTORS, num_points);
+}
+#endif /* LV_HAVE_GENERIC */
+
+
+#ifdef LV_HAVE_SSE3
+static inline void volk_gnsssdr_32fc_xn_weightedsumpuppet_32fc_u_sse3(lv_32fc_t* result, const lv_32fc_t* in, unsigned int num_points)
+{
+    const lv_32fc_t* in_a[VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_32FC_VECTORS] = {in, in, in};
+    const lv_32fc_t weights[VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_32FC_VECTORS] = {lv_cmake(0.5f, -0.25f), lv_cmake(-0.125f, 0.375f), lv_cmake(0.25f, 0.0625f)};
+    volk_gnsssdr_32fc_xn_weighted_sum_32fc_u_sse3(result, in_a, weights, VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_32FC_VECTORS, num_points);
+}
+#endif /* LV_HAVE_SSE3 */
+
+
+#ifdef LV_HAVE_AVX
+static inline void volk_gnsssdr_32fc_xn_weightedsumpuppet_32fc_u_avx(lv_32fc_t* result, const lv_32fc_t* in, unsigned int num_points)
+{
+    const lv_32fc_t* in_a[VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_32FC_VECTORS] = {in, in, in};
+    const lv_32fc_t weights[VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_32FC_VECTORS] = {lv_cmake(0.5f, -0.25f), lv_cmake(-0.125f, 0.375f), lv_cmake(0.25f, 0.0625f)};
+    volk_gnsssdr_32fc_xn_weighted_sum_32fc_u_avx(result, in_a, weights, VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_32FC_VECTORS, num_points);
+}
+#endif /* LV_HAVE_AVX */
+
+
+#ifdef LV_HAVE_NEON
+static inline void volk_gnsssdr_32fc_xn_weightedsumpuppet_32fc_neon(lv_32fc_t* result, const lv_32fc_t* in, unsigned int num_points)
+{
+    const lv_32fc_t* in_a[VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_32FC_VECTORS] = {in, in, in};
+    const lv_32fc_t weights[VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_32FC_VECTORS] = {lv_cmake(0.5f, -0.25f), lv_cmake(-0.125f, 0.375f), lv_cmake(0.25f, 0.0625f)};
+    volk_gnsssdr_32fc_xn_weighted_sum_32fc_neon(result, in_a, weights, VOLK_GNSSSDR_WEIGHTEDSUMPUPPET_32FC_VECTORS, num_points);
+}
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_gnsssdr_32fc_xn_weightedsumpuppet_32fc_H */
@@ -149,6 +149,42 @@ static inline void volk_gnsssdr_8i_accumulator_s8i_a_sse3(char* result, const ch
 #endif /* LV_HAVE_SSE3 */
 
 
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_8i_accumulator_s8i_neon(char* result, const char* inputBuffer, unsigned int num_points)
+{
+    char returnValue = 0;
+    const unsigned int neon_iters = num_points / 16;
+
+    const char* aPtr = inputBuffer;
+    __VOLK_ATTR_ALIGNED(16) char tempBuffer[16];
+
+    int8x16_t accumulator = vdupq_n_s8(0);
+
+    for(unsigned int number = 0; number < neon_iters; number++)
+        {
+            accumulator = vaddq_s8(accumulator, vld1q_s8((const int8_t*)aPtr));
+            __builtin_prefetch(aPtr + 64);
+            aPtr += 16;
+        }
+    vst1q_s8((int8_t*)tempBuffer, accumulator);
+
+    for(unsigned int i = 0; i < 16; ++i)
+        {
+            returnValue += tempBuffer[i];
+        }
+
+    for(unsigned int i = neon_iters * 16; i < num_points; ++i)
+        {
+            returnValue += (*aPtr++);
+        }
+
+    *result = returnValue;
+}
+#endif /* LV_HAVE_NEON */
+
+
 #ifdef LV_HAVE_ORC
 
 extern void volk_gnsssdr_8i_accumulator_s8i_a_orc_impl(short* result, const char* inputBuffer, unsigned int num_points);
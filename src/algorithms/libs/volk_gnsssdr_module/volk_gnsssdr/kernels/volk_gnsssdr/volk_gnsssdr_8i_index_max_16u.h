@@ -56,6 +56,7 @@
 #ifndef INCLUDED_volk_gnsssdr_8i_index_max_16u_H
 #define INCLUDED_volk_gnsssdr_8i_index_max_16u_H
 
+#include <limits.h>
 #include <volk_gnsssdr/volk_gnsssdr_common.h>
 
 #ifdef LV_HAVE_AVX
@@ -454,4 +455,59 @@ static inline void volk_gnsssdr_8i_index_max_16u_a_sse2(unsigned int* target, co
 #endif /*LV_HAVE_SSE2*/
 
 
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_8i_index_max_16u_neon(unsigned int* target, const char* src0, unsigned int num_points)
+{
+    if(num_points > 0)
+        {
+            const unsigned int neon_iters = num_points / 16;
+
+            const char* inputPtr = src0;
+            char max = src0[0];
+            unsigned int index = 0;
+            uint8x16_t compareResults;
+            uint8x8_t anyGreater;
+
+            for(unsigned int number = 0; number < neon_iters; number++)
+                {
+                    // char is unsigned on most ARM ABIs: compare the way the generic version does
+#if CHAR_MIN < 0
+                    compareResults = vcgtq_s8(vld1q_s8((const int8_t*)inputPtr), vdupq_n_s8(max));
+#else
+                    compareResults = vcgtq_u8(vld1q_u8((const uint8_t*)inputPtr), vdupq_n_u8(max));
+#endif
+                    anyGreater = vorr_u8(vget_low_u8(compareResults), vget_high_u8(compareResults));
+
+                    if (vget_lane_u64(vreinterpret_u64_u8(anyGreater), 0) != 0)
+                        {
+                            for(unsigned int i = 0; i < 16; i++)
+                                {
+                                    if(inputPtr[i] > max)
+                                        {
+                                            index = number * 16 + i;
+                                            max = inputPtr[i];
+                                        }
+                                }
+                        }
+
+                    inputPtr += 16;
+                }
+
+            for(unsigned int i = neon_iters * 16; i < num_points; ++i)
+                {
+                    if(src0[i] > max)
+                        {
+                            index = i;
+                            max = src0[i];
+                        }
+                }
+            target[0] = index;
+        }
+}
+
+#endif /*LV_HAVE_NEON*/
+
+
 #endif /*INCLUDED_volk_gnsssdr_8i_index_max_16u_H*/
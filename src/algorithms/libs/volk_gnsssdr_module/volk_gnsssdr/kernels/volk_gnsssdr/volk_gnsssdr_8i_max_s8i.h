@@ -56,6 +56,7 @@
 #ifndef INCLUDED_volk_gnsssdr_8i_max_s8i_H
 #define INCLUDED_volk_gnsssdr_8i_max_s8i_H
 
+#include <limits.h>
 #include <volk_gnsssdr/volk_gnsssdr_common.h>
 
 #ifdef LV_HAVE_SSE4_1
@@ -294,4 +295,58 @@ static inline void volk_gnsssdr_8i_max_s8i_a_sse2(char* target, const char* src0
 #endif /*LV_HAVE_SSE2*/
 
 
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_8i_max_s8i_neon(char* target, const char* src0, unsigned int num_points)
+{
+    if(num_points > 0)
+        {
+            const unsigned int neon_iters = num_points / 16;
+
+            const char* inputPtr = src0;
+            char max = src0[0];
+            __VOLK_ATTR_ALIGNED(16) char maxValuesBuffer[16];
+
+            // char is unsigned on most ARM ABIs: compare the way the generic version does
+#if CHAR_MIN < 0
+            int8x16_t maxValues = vdupq_n_s8(max);
+            for(unsigned int number = 0; number < neon_iters; number++)
+                {
+                    maxValues = vmaxq_s8(maxValues, vld1q_s8((const int8_t*)inputPtr));
+                    inputPtr += 16;
+                }
+            vst1q_s8((int8_t*)maxValuesBuffer, maxValues);
+#else
+            uint8x16_t maxValues = vdupq_n_u8(max);
+            for(unsigned int number = 0; number < neon_iters; number++)
+                {
+                    maxValues = vmaxq_u8(maxValues, vld1q_u8((const uint8_t*)inputPtr));
+                    inputPtr += 16;
+                }
+            vst1q_u8((uint8_t*)maxValuesBuffer, maxValues);
+#endif
+
+            for(unsigned int i = 0; i < 16; ++i)
+                {
+                    if(maxValuesBuffer[i] > max)
+                        {
+                            max = maxValuesBuffer[i];
+                        }
+                }
+
+            for(unsigned int i = neon_iters * 16; i < num_points; ++i)
+                {
+                    if(src0[i] > max)
+                        {
+                            max = src0[i];
+                        }
+                }
+            target[0] = max;
+        }
+}
+
+#endif /*LV_HAVE_NEON*/
+
+
 #endif /*INCLUDED_volk_gnsssdr_8i_max_s8i_H*/
@@ -145,6 +145,41 @@ static inline void volk_gnsssdr_8i_x2_add_8i_a_sse2(char* cVector, const char* a
 #endif /* LV_HAVE_SSE2 */
 
 
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_8i_x2_add_8i_neon(char* cVector, const char* aVector, const char* bVector, unsigned int num_points)
+{
+    const unsigned int neon_iters = num_points / 16;
+
+    char* cPtr = cVector;
+    const char* aPtr = aVector;
+    const char* bPtr =  bVector;
+
+    int8x16_t aVal, bVal;
+
+    for(unsigned int number = 0; number < neon_iters; number++)
+        {
+            aVal = vld1q_s8((const int8_t*)aPtr);
+            bVal = vld1q_s8((const int8_t*)bPtr);
+            __builtin_prefetch(aPtr + 64);
+            __builtin_prefetch(bPtr + 64);
+
+            vst1q_s8((int8_t*)cPtr, vaddq_s8(aVal, bVal));
+
+            aPtr += 16;
+            bPtr += 16;
+            cPtr += 16;
+        }
+
+    for(unsigned int i = neon_iters * 16; i < num_points; ++i)
+        {
+            *cPtr++ = (*aPtr++) + (*bPtr++);
+        }
+}
+#endif /* LV_HAVE_NEON */
+
+
 #ifdef LV_HAVE_ORC
 
 extern void volk_gnsssdr_8i_x2_add_8i_a_orc_impl(char* cVector, const char* aVector, const char* bVector, unsigned int num_points);
@@ -0,0 +1,183 @@
+/*!
+ * \file volk_gnsssdr_8i_x2_interleave_8ic.h
+ * \brief VOLK_GNSSSDR kernel: interleaves two 8 bits vectors into a
+ * 16 bits complex vector.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * VOLK_GNSSSDR kernel that builds a complex vector (8 bits the real part and
+ * 8 bits the imaginary part) from the vectors of its real and imaginary parts
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+/*!
+ * \page volk_gnsssdr_8i_x2_interleave_8ic
+ *
+ * \b Overview
+ *
+ * Interleaves the real and imaginary parts of num_points complex samples.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_gnsssdr_8i_x2_interleave_8ic(lv_8sc_t* cVector, const char* aVector, const char* bVector, unsigned int num_points);
+ * \endcode
+ *
+ * \b Inputs
+ * \li aVector: The real parts.
+ * \li bVector: The imaginary parts.
+ * \li num_points: The number of complex data points.
+ *
+ * \b Outputs
+ * \li cVector: The complex samples.
+ *
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_8i_x2_interleave_8ic_H
+#define INCLUDED_volk_gnsssdr_8i_x2_interleave_8ic_H
+
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_gnsssdr_8i_x2_interleave_8ic_generic(lv_8sc_t* cVector, const char* aVector, const char* bVector, unsigned int num_points)
+{
+    char* c = (char*)cVector;
+    unsigned int n;
+    for(n = 0; n < num_points; n++)
+        {
+            *c++ = aVector[n];
+            *c++ = bVector[n];
+        }
+}
+#endif /* LV_HAVE_GENERIC */
+
+
+#ifdef LV_HAVE_SSE2
+#include <emmintrin.h>
+
+static inline void volk_gnsssdr_8i_x2_interleave_8ic_u_sse2(lv_8sc_t* cVector, const char* aVector, const char* bVector, unsigned int num_points)
+{
+    const unsigned int sse_iters = num_points / 16;
+    unsigned int number;
+    unsigned int n;
+    const char* aPtr = aVector;
+    const char* bPtr = bVector;
+    char* cPtr = (char*)cVector;
+    __m128i a, b;
+
+    for(number = 0; number < sse_iters; number++)
+        {
+            a = _mm_loadu_si128((__m128i*)aPtr);
+            b = _mm_loadu_si128((__m128i*)bPtr);
+            _mm_storeu_si128((__m128i*)cPtr, _mm_unpacklo_epi8(a, b));
+            _mm_storeu_si128((__m128i*)(cPtr + 16), _mm_unpackhi_epi8(a, b));
+
+            aPtr += 16;
+            bPtr += 16;
+            cPtr += 32;
+        }
+
+    for(n = sse_iters * 16; n < num_points; n++)
+        {
+            *cPtr++ = *aPtr++;
+            *cPtr++ = *bPtr++;
+        }
+}
+#endif /* LV_HAVE_SSE2 */
+
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void volk_gnsssdr_8i_x2_interleave_8ic_u_avx2(lv_8sc_t* cVector, const char* aVector, const char* bVector, unsigned int num_points)
+{
+    const unsigned int avx_iters = num_points / 32;
+    unsigned int number;
+    unsigned int n;
+    const char* aPtr = aVector;
+    const char* bPtr = bVector;
+    char* cPtr = (char*)cVector;
+    __m256i a, b, lo, hi;
+
+    for(number = 0; number < avx_iters; number++)
+        {
+            a = _mm256_loadu_si256((__m256i*)aPtr);
+            b = _mm256_loadu_si256((__m256i*)bPtr);
+            // the unpacks work within each 128 bits lane, the permutes put the lanes back in order
+            lo = _mm256_unpacklo_epi8(a, b);
+            hi = _mm256_unpackhi_epi8(a, b);
+            _mm256_storeu_si256((__m256i*)cPtr, _mm256_permute2x128_si256(lo, hi, 0x20));
+            _mm256_storeu_si256((__m256i*)(cPtr + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+
+            aPtr += 32;
+            bPtr += 32;
+            cPtr += 64;
+        }
+
+    for(n = avx_iters * 32; n < num_points; n++)
+        {
+            *cPtr++ = *aPtr++;
+            *cPtr++ = *bPtr++;
+        }
+}
+#endif /* LV_HAVE_AVX2 */
+
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_8i_x2_interleave_8ic_neon(lv_8sc_t* cVector, const char* aVector, const char* bVector, unsigned int num_points)
+{
+    const unsigned int neon_iters = num_points / 16;
+    unsigned int number;
+    unsigned int n;
+    const char* aPtr = aVector;
+    const char* bPtr = bVector;
+    char* cPtr = (char*)cVector;
+    int8x16x2_t c;
+
+    for(number = 0; number < neon_iters; number++)
+        {
+            c.val[0] = vld1q_s8((const int8_t*)aPtr);
+            c.val[1] = vld1q_s8((const int8_t*)bPtr);
+            vst2q_s8((int8_t*)cPtr, c);
+
+            aPtr += 16;
+            bPtr += 16;
+            cPtr += 32;
+        }
+
+    for(n = neon_iters * 16; n < num_points; n++)
+        {
+            *cPtr++ = *aPtr++;
+            *cPtr++ = *bPtr++;
+        }
+}
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_gnsssdr_8i_x2_interleave_8ic_H */
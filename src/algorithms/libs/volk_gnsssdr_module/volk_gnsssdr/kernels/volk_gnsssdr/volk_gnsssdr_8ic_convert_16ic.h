@@ -0,0 +1,172 @@
+/*!
+ * \file volk_gnsssdr_8ic_convert_16ic.h
+ * \brief VOLK_GNSSSDR kernel: converts a 16 bits complex vector into
+ * a 32 bits complex vector.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * VOLK_GNSSSDR kernel that widens the real and imaginary parts of a complex
+ * vector from 8 to 16 bits, without scaling
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+/*!
+ * \page volk_gnsssdr_8ic_convert_16ic
+ *
+ * \b Overview
+ *
+ * Sign extends the parts of num_points complex samples from 8 to 16 bits.
+ * The values are kept, not scaled.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_gnsssdr_8ic_convert_16ic(lv_16sc_t* outputVector, const lv_8sc_t* inputVector, unsigned int num_points);
+ * \endcode
+ *
+ * \b Inputs
+ * \li inputVector: The 8 bits complex samples.
+ * \li num_points: The number of complex data points.
+ *
+ * \b Outputs
+ * \li outputVector: The 16 bits complex samples.
+ *
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_8ic_convert_16ic_H
+#define INCLUDED_volk_gnsssdr_8ic_convert_16ic_H
+
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_gnsssdr_8ic_convert_16ic_generic(lv_16sc_t* outputVector, const lv_8sc_t* inputVector, unsigned int num_points)
+{
+    const signed char* in = (const signed char*)inputVector;
+    int16_t* out = (int16_t*)outputVector;
+    unsigned int n;
+    for(n = 0; n < 2 * num_points; n++)
+        {
+            *out++ = (int16_t)(*in++);
+        }
+}
+#endif /* LV_HAVE_GENERIC */
+
+
+#ifdef LV_HAVE_SSE2
+#include <emmintrin.h>
+
+static inline void volk_gnsssdr_8ic_convert_16ic_u_sse2(lv_16sc_t* outputVector, const lv_8sc_t* inputVector, unsigned int num_points)
+{
+    const unsigned int sse_iters = num_points / 8;
+    unsigned int number;
+    unsigned int n;
+    const signed char* in = (const signed char*)inputVector;
+    int16_t* out = (int16_t*)outputVector;
+    const __m128i zero = _mm_setzero_si128();
+    __m128i x, sign;
+
+    for(number = 0; number < sse_iters; number++)
+        {
+            x = _mm_loadu_si128((__m128i*)in);
+            // the high byte of each 16 bits value is 0xFF for the negative ones
+            sign = _mm_cmpgt_epi8(zero, x);
+            _mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi8(x, sign));
+            _mm_storeu_si128((__m128i*)(out + 8), _mm_unpackhi_epi8(x, sign));
+
+            in += 16;
+            out += 16;
+        }
+
+    for(n = sse_iters * 16; n < 2 * num_points; n++)
+        {
+            *out++ = (int16_t)(*in++);
+        }
+}
+#endif /* LV_HAVE_SSE2 */
+
+
+#ifdef LV_HAVE_SSE4_1
+#include <smmintrin.h>
+
+static inline void volk_gnsssdr_8ic_convert_16ic_u_sse4_1(lv_16sc_t* outputVector, const lv_8sc_t* inputVector, unsigned int num_points)
+{
+    const unsigned int sse_iters = num_points / 8;
+    unsigned int number;
+    unsigned int n;
+    const signed char* in = (const signed char*)inputVector;
+    int16_t* out = (int16_t*)outputVector;
+    __m128i x;
+
+    for(number = 0; number < sse_iters; number++)
+        {
+            x = _mm_loadu_si128((__m128i*)in);
+            _mm_storeu_si128((__m128i*)out, _mm_cvtepi8_epi16(x));
+            _mm_storeu_si128((__m128i*)(out + 8), _mm_cvtepi8_epi16(_mm_srli_si128(x, 8)));
+
+            in += 16;
+            out += 16;
+        }
+
+    for(n = sse_iters * 16; n < 2 * num_points; n++)
+        {
+            *out++ = (int16_t)(*in++);
+        }
+}
+#endif /* LV_HAVE_SSE4_1 */
+
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_8ic_convert_16ic_neon(lv_16sc_t* outputVector, const lv_8sc_t* inputVector, unsigned int num_points)
+{
+    const unsigned int neon_iters = num_points / 8;
+    unsigned int number;
+    unsigned int n;
+    const signed char* in = (const signed char*)inputVector;
+    int16_t* out = (int16_t*)outputVector;
+    int8x16_t x;
+
+    for(number = 0; number < neon_iters; number++)
+        {
+            x = vld1q_s8((const int8_t*)in);
+            vst1q_s16(out, vmovl_s8(vget_low_s8(x)));
+            vst1q_s16(out + 8, vmovl_s8(vget_high_s8(x)));
+
+            in += 16;
+            out += 16;
+        }
+
+    for(n = neon_iters * 16; n < 2 * num_points; n++)
+        {
+            *out++ = (int16_t)(*in++);
+        }
+}
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_gnsssdr_8ic_convert_16ic_H */
@@ -267,6 +267,46 @@ static inline void volk_gnsssdr_8ic_magnitude_squared_8i_a_sse3(char* magnitudeV
 //#endif /* LV_HAVE_SSE */
 
 
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_8ic_magnitude_squared_8i_neon(char* magnitudeVector, const lv_8sc_t* complexVector, unsigned int num_points)
+{
+    const unsigned int neon_iters = num_points / 16;
+
+    const char* complexVectorPtr = (char*)complexVector;
+    char* magnitudeVectorPtr = magnitudeVector;
+
+    int8x16x2_t a_val;
+    int16x8_t mag_lo, mag_hi;
+
+    for(unsigned int number = 0; number < neon_iters; number++)
+        {
+            a_val = vld2q_s8((const int8_t*)complexVectorPtr);
+            __builtin_prefetch(complexVectorPtr + 64);
+
+            // widen the products to 16 bits and keep the low byte, as the generic version does
+            mag_lo = vmull_s8(vget_low_s8(a_val.val[0]), vget_low_s8(a_val.val[0]));
+            mag_lo = vmlal_s8(mag_lo, vget_low_s8(a_val.val[1]), vget_low_s8(a_val.val[1]));
+            mag_hi = vmull_s8(vget_high_s8(a_val.val[0]), vget_high_s8(a_val.val[0]));
+            mag_hi = vmlal_s8(mag_hi, vget_high_s8(a_val.val[1]), vget_high_s8(a_val.val[1]));
+
+            vst1q_s8((int8_t*)magnitudeVectorPtr, vcombine_s8(vmovn_s16(mag_lo), vmovn_s16(mag_hi)));
+
+            complexVectorPtr += 32;
+            magnitudeVectorPtr += 16;
+        }
+
+    for (unsigned int i = neon_iters * 16; i < num_points; ++i)
+        {
+            const char valReal = *complexVectorPtr++;
+            const char valImag = *complexVectorPtr++;
+            *magnitudeVectorPtr++ = (valReal * valReal) + (valImag * valImag);
+        }
+}
+#endif /* LV_HAVE_NEON */
+
+
 #ifdef LV_HAVE_ORC
 
 extern void volk_gnsssdr_8ic_magnitude_squared_8i_a_orc_impl(char* magnitudeVector, const lv_8sc_t* complexVector, unsigned int num_points);
@@ -209,6 +209,42 @@ static inline void volk_gnsssdr_8ic_s8ic_multiply_8ic_a_sse3(lv_8sc_t* cVector,
 #endif /* LV_HAVE_SSE3 */
 
 
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_8ic_s8ic_multiply_8ic_neon(lv_8sc_t* cVector, const lv_8sc_t* aVector, const lv_8sc_t scalar, unsigned int num_points)
+{
+    const unsigned int neon_iters = num_points / 16;
+
+    lv_8sc_t* c = cVector;
+    const lv_8sc_t* a = aVector;
+
+    const int8x16_t scalar_real = vdupq_n_s8((int8_t)lv_creal(scalar));
+    const int8x16_t scalar_imag = vdupq_n_s8((int8_t)lv_cimag(scalar));
+    int8x16x2_t a_val, c_val;
+
+    for(unsigned int number = 0; number < neon_iters; number++)
+        {
+            a_val = vld2q_s8((const int8_t*)a);
+            __builtin_prefetch(a + 32);
+
+            c_val.val[0] = vmlsq_s8(vmulq_s8(a_val.val[0], scalar_real), a_val.val[1], scalar_imag);
+            c_val.val[1] = vmlaq_s8(vmulq_s8(a_val.val[0], scalar_imag), a_val.val[1], scalar_real);
+
+            vst2q_s8((int8_t*)c, c_val);
+
+            a += 16;
+            c += 16;
+        }
+
+    for (unsigned int i = neon_iters * 16; i < num_points; ++i)
+        {
+            *c++ = (*a++) * scalar;
+        }
+}
+#endif /* LV_HAVE_NEON */
+
+
 #ifdef LV_HAVE_ORC
 
 extern void volk_gnsssdr_8ic_s8ic_multiply_8ic_a_orc_impl(lv_8sc_t* cVector, const lv_8sc_t* aVector, const char scalarreal, const char scalarimag, unsigned int num_points);
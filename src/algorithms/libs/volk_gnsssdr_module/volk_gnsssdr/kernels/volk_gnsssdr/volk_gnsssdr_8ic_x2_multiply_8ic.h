@@ -296,6 +296,46 @@ static inline void volk_gnsssdr_8ic_x2_multiply_8ic_a_sse4_1(lv_8sc_t* cVector,
 #endif /* LV_HAVE_SSE4_1 */
 
 
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_8ic_x2_multiply_8ic_neon(lv_8sc_t* cVector, const lv_8sc_t* aVector, const lv_8sc_t* bVector, unsigned int num_points)
+{
+    const unsigned int neon_iters = num_points / 16;
+
+    lv_8sc_t* c = cVector;
+    const lv_8sc_t* a = aVector;
+    const lv_8sc_t* b = bVector;
+
+    // for 2-lane vectors, 1st lane holds the real part,
+    // 2nd lane holds the imaginary part
+    int8x16x2_t a_val, b_val, c_val;
+
+    for(unsigned int number = 0; number < neon_iters; number++)
+        {
+            a_val = vld2q_s8((const int8_t*)a);
+            b_val = vld2q_s8((const int8_t*)b);
+            __builtin_prefetch(a + 32);
+            __builtin_prefetch(b + 32);
+
+            c_val.val[0] = vmlsq_s8(vmulq_s8(a_val.val[0], b_val.val[0]), a_val.val[1], b_val.val[1]);
+            c_val.val[1] = vmlaq_s8(vmulq_s8(a_val.val[0], b_val.val[1]), a_val.val[1], b_val.val[0]);
+
+            vst2q_s8((int8_t*)c, c_val);
+
+            a += 16;
+            b += 16;
+            c += 16;
+        }
+
+    for (unsigned int i = neon_iters * 16; i < num_points; ++i)
+        {
+            *c++ = (*a++) * (*b++);
+        }
+}
+#endif /* LV_HAVE_NEON */
+
+
 #ifdef LV_HAVE_ORC
 
 extern void volk_gnsssdr_8ic_x2_multiply_8ic_a_orc_impl(lv_8sc_t* cVector, const lv_8sc_t* aVector, const lv_8sc_t* bVector, unsigned int num_points);
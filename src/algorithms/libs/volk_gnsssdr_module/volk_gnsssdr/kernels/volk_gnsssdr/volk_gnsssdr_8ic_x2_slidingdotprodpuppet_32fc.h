@@ -0,0 +1,85 @@
+/*!
+ * \file volk_gnsssdr_8ic_x2_slidingdotprodpuppet_32fc.h
+ * \brief VOLK_GNSSSDR puppet for the volk_gnsssdr_8ic_x2_sliding_dot_prod_32fc kernel.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * VOLK_GNSSSDR puppet for integrating the sliding dot product into the test system
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_8ic_x2_slidingdotprodpuppet_32fc_H
+#define INCLUDED_volk_gnsssdr_8ic_x2_slidingdotprodpuppet_32fc_H
+
+
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+#include "volk_gnsssdr/volk_gnsssdr_8ic_x2_sliding_dot_prod_32fc.h"
+#include <string.h>
+
+// five lags, so that both a full group of four lags and a remaining one are computed
+#define VOLK_GNSSSDR_SLIDING_PUPPET_LAGS 5
+
+#ifdef LV_HAVE_GENERIC
+static inline void volk_gnsssdr_8ic_x2_slidingdotprodpuppet_32fc_generic(lv_32fc_t* result, const lv_8sc_t* in, const lv_8sc_t* code, unsigned int num_points)
+{
+    memset(result, 0, sizeof(lv_32fc_t) * num_points);
+    if (num_points < VOLK_GNSSSDR_SLIDING_PUPPET_LAGS) return;
+    volk_gnsssdr_8ic_x2_sliding_dot_prod_32fc_generic(result, in, code, VOLK_GNSSSDR_SLIDING_PUPPET_LAGS, num_points - VOLK_GNSSSDR_SLIDING_PUPPET_LAGS + 1);
+}
+#endif  /* LV_HAVE_GENERIC  */
+
+
+#ifdef LV_HAVE_AVX2
+static inline void volk_gnsssdr_8ic_x2_slidingdotprodpuppet_32fc_a_avx2(lv_32fc_t* result, const lv_8sc_t* in, const lv_8sc_t* code, unsigned int num_points)
+{
+    memset(result, 0, sizeof(lv_32fc_t) * num_points);
+    if (num_points < VOLK_GNSSSDR_SLIDING_PUPPET_LAGS) return;
+    volk_gnsssdr_8ic_x2_sliding_dot_prod_32fc_a_avx2(result, in, code, VOLK_GNSSSDR_SLIDING_PUPPET_LAGS, num_points - VOLK_GNSSSDR_SLIDING_PUPPET_LAGS + 1);
+}
+#endif  /* LV_HAVE_AVX2  */
+
+
+#ifdef LV_HAVE_AVX2
+static inline void volk_gnsssdr_8ic_x2_slidingdotprodpuppet_32fc_u_avx2(lv_32fc_t* result, const lv_8sc_t* in, const lv_8sc_t* code, unsigned int num_points)
+{
+    memset(result, 0, sizeof(lv_32fc_t) * num_points);
+    if (num_points < VOLK_GNSSSDR_SLIDING_PUPPET_LAGS) return;
+    volk_gnsssdr_8ic_x2_sliding_dot_prod_32fc_u_avx2(result, in, code, VOLK_GNSSSDR_SLIDING_PUPPET_LAGS, num_points - VOLK_GNSSSDR_SLIDING_PUPPET_LAGS + 1);
+}
+#endif  /* LV_HAVE_AVX2  */
+
+
+#ifdef LV_HAVE_NEON
+static inline void volk_gnsssdr_8ic_x2_slidingdotprodpuppet_32fc_neon(lv_32fc_t* result, const lv_8sc_t* in, const lv_8sc_t* code, unsigned int num_points)
+{
+    memset(result, 0, sizeof(lv_32fc_t) * num_points);
+    if (num_points < VOLK_GNSSSDR_SLIDING_PUPPET_LAGS) return;
+    volk_gnsssdr_8ic_x2_sliding_dot_prod_32fc_neon(result, in, code, VOLK_GNSSSDR_SLIDING_PUPPET_LAGS, num_points - VOLK_GNSSSDR_SLIDING_PUPPET_LAGS + 1);
+}
+#endif  /* LV_HAVE_NEON  */
+
+#endif  /* INCLUDED_volk_gnsssdr_8ic_x2_slidingdotprodpuppet_32fc_H */
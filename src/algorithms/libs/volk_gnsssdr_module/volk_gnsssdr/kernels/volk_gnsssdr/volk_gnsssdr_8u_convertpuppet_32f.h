@@ -0,0 +1,77 @@
+/*!
+ * \file volk_gnsssdr_8u_convertpuppet_32f.h
+ * \brief VOLK_GNSSSDR puppet for the unsigned 8 bits conversion kernel.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * Wrapper of volk_gnsssdr_8u_s32f_convert_32f with the offset and the
+ * scale of the RTL-SDR dongles, for the QA and the profiler
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_8u_convertpuppet_32f_H
+#define INCLUDED_volk_gnsssdr_8u_convertpuppet_32f_H
+
+#include "volk_gnsssdr/volk_gnsssdr_8u_s32f_convert_32f.h"
+
+#define VOLK_GNSSSDR_CONVERTPUPPET_OFFSET 127.4f
+#define VOLK_GNSSSDR_CONVERTPUPPET_SCALE (1.0f / 128.0f)
+
+
+#ifdef LV_HAVE_GENERIC
+static inline void volk_gnsssdr_8u_convertpuppet_32f_generic(float* result, const unsigned char* in, unsigned int num_points)
+{
+    volk_gnsssdr_8u_s32f_convert_32f_generic(result, in, VOLK_GNSSSDR_CONVERTPUPPET_OFFSET, VOLK_GNSSSDR_CONVERTPUPPET_SCALE, num_points);
+}
+#endif /* LV_HAVE_GENERIC */
+
+
+#ifdef LV_HAVE_SSE2
+static inline void volk_gnsssdr_8u_convertpuppet_32f_u_sse2(float* result, const unsigned char* in, unsigned int num_points)
+{
+    volk_gnsssdr_8u_s32f_convert_32f_u_sse2(result, in, VOLK_GNSSSDR_CONVERTPUPPET_OFFSET, VOLK_GNSSSDR_CONVERTPUPPET_SCALE, num_points);
+}
+#endif /* LV_HAVE_SSE2 */
+
+
+#ifdef LV_HAVE_SSE2
+static inline void volk_gnsssdr_8u_convertpuppet_32f_a_sse2(float* result, const unsigned char* in, unsigned int num_points)
+{
+    volk_gnsssdr_8u_s32f_convert_32f_a_sse2(result, in, VOLK_GNSSSDR_CONVERTPUPPET_OFFSET, VOLK_GNSSSDR_CONVERTPUPPET_SCALE, num_points);
+}
+#endif /* LV_HAVE_SSE2 */
+
+
+#ifdef LV_HAVE_NEON
+static inline void volk_gnsssdr_8u_convertpuppet_32f_neon(float* result, const unsigned char* in, unsigned int num_points)
+{
+    volk_gnsssdr_8u_s32f_convert_32f_neon(result, in, VOLK_GNSSSDR_CONVERTPUPPET_OFFSET, VOLK_GNSSSDR_CONVERTPUPPET_SCALE, num_points);
+}
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_gnsssdr_8u_convertpuppet_32f_H */
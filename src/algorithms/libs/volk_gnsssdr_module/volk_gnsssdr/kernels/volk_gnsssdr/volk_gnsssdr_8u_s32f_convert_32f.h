@@ -0,0 +1,177 @@
+/*!
+ * \file volk_gnsssdr_8u_s32f_convert_32f.h
+ * \brief VOLK_GNSSSDR kernel: converts unsigned 8 bits samples to float,
+ * removing an offset and applying a scale.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * VOLK_GNSSSDR kernel that converts the offset binary I/Q bytes of
+ * front-ends such as the RTL-SDR dongles to floating point
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+/*!
+ * \page volk_gnsssdr_8u_s32f_convert_32f
+ *
+ * \b Overview
+ *
+ * Computes result[n] = (in[n] - offset) * scale. Interleaved I/Q bytes
+ * give interleaved float I/Q, that is, num_points / 2 complex samples.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_gnsssdr_8u_s32f_convert_32f(float* result, const unsigned char* in, const float offset, const float scale, unsigned int num_points);
+ * \endcode
+ *
+ * \b Inputs
+ * \li in:         The unsigned 8 bits samples.
+ * \li offset:     The value that maps to zero (127.4 for the RTL-SDR).
+ * \li scale:      The factor applied after removing the offset.
+ * \li num_points: Number of samples.
+ *
+ * \b Outputs
+ * \li result:     The num_points converted samples.
+ *
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_8u_s32f_convert_32f_H
+#define INCLUDED_volk_gnsssdr_8u_s32f_convert_32f_H
+
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_gnsssdr_8u_s32f_convert_32f_generic(float* result, const unsigned char* in, const float offset, const float scale, unsigned int num_points)
+{
+    for (unsigned int n = 0; n < num_points; n++)
+        {
+            result[n] = ((float)in[n] - offset) * scale;
+        }
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+
+#ifdef LV_HAVE_SSE2
+#include <emmintrin.h>
+
+static inline void volk_gnsssdr_8u_s32f_convert_32f_u_sse2(float* result, const unsigned char* in, const float offset, const float scale, unsigned int num_points)
+{
+    const unsigned int sse_iters = num_points / 16;
+    const __m128 offset_val = _mm_set1_ps(offset);
+    const __m128 scale_val = _mm_set1_ps(scale);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i bytes, words;
+    float* _out = result;
+
+    for (unsigned int number = 0; number < sse_iters; number++)
+        {
+            bytes = _mm_loadu_si128((const __m128i*)(in + 16 * number));
+            words = _mm_unpacklo_epi8(bytes, zero);
+            _mm_storeu_ps(_out, _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero)), offset_val), scale_val));
+            _mm_storeu_ps(_out + 4, _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero)), offset_val), scale_val));
+            words = _mm_unpackhi_epi8(bytes, zero);
+            _mm_storeu_ps(_out + 8, _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero)), offset_val), scale_val));
+            _mm_storeu_ps(_out + 12, _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero)), offset_val), scale_val));
+            _out += 16;
+        }
+
+    for (unsigned int n = sse_iters * 16; n < num_points; n++)
+        {
+            result[n] = ((float)in[n] - offset) * scale;
+        }
+}
+
+#endif /* LV_HAVE_SSE2 */
+
+
+#ifdef LV_HAVE_SSE2
+#include <emmintrin.h>
+
+static inline void volk_gnsssdr_8u_s32f_convert_32f_a_sse2(float* result, const unsigned char* in, const float offset, const float scale, unsigned int num_points)
+{
+    const unsigned int sse_iters = num_points / 16;
+    const __m128 offset_val = _mm_set1_ps(offset);
+    const __m128 scale_val = _mm_set1_ps(scale);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i bytes, words;
+    float* _out = result;
+
+    for (unsigned int number = 0; number < sse_iters; number++)
+        {
+            bytes = _mm_load_si128((const __m128i*)(in + 16 * number));
+            words = _mm_unpacklo_epi8(bytes, zero);
+            _mm_store_ps(_out, _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero)), offset_val), scale_val));
+            _mm_store_ps(_out + 4, _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero)), offset_val), scale_val));
+            words = _mm_unpackhi_epi8(bytes, zero);
+            _mm_store_ps(_out + 8, _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero)), offset_val), scale_val));
+            _mm_store_ps(_out + 12, _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero)), offset_val), scale_val));
+            _out += 16;
+        }
+
+    for (unsigned int n = sse_iters * 16; n < num_points; n++)
+        {
+            result[n] = ((float)in[n] - offset) * scale;
+        }
+}
+
+#endif /* LV_HAVE_SSE2 */
+
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_8u_s32f_convert_32f_neon(float* result, const unsigned char* in, const float offset, const float scale, unsigned int num_points)
+{
+    const unsigned int neon_iters = num_points / 16;
+    const float32x4_t offset_val = vdupq_n_f32(offset);
+    const float32x4_t scale_val = vdupq_n_f32(scale);
+    uint8x16_t bytes;
+    uint16x8_t words;
+    float* _out = result;
+
+    for (unsigned int number = 0; number < neon_iters; number++)
+        {
+            bytes = vld1q_u8(in + 16 * number);
+            words = vmovl_u8(vget_low_u8(bytes));
+            vst1q_f32(_out, vmulq_f32(vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(words))), offset_val), scale_val));
+            vst1q_f32(_out + 4, vmulq_f32(vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(words))), offset_val), scale_val));
+            words = vmovl_u8(vget_high_u8(bytes));
+            vst1q_f32(_out + 8, vmulq_f32(vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(words))), offset_val), scale_val));
+            vst1q_f32(_out + 12, vmulq_f32(vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(words))), offset_val), scale_val));
+            _out += 16;
+        }
+
+    for (unsigned int n = neon_iters * 16; n < num_points; n++)
+        {
+            result[n] = ((float)in[n] - offset) * scale;
+        }
+}
+
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_gnsssdr_8u_s32f_convert_32f_H */
@@ -0,0 +1,73 @@
+/*!
+ * \file volk_gnsssdr_8u_unpack1bitpuppet_8i.h
+ * \brief VOLK_GNSSSDR puppet for the 1-bit unpacking kernel.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * Wrapper of volk_gnsssdr_8u_unpack_1bit_8i with an input and an output
+ * of the same length, for the QA and the profiler
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_8u_unpack1bitpuppet_8i_H
+#define INCLUDED_volk_gnsssdr_8u_unpack1bitpuppet_8i_H
+
+#include "volk_gnsssdr/volk_gnsssdr_8u_unpack_1bit_8i.h"
+
+// Only the first num_points / 8 input bytes are unpacked, into the num_points output samples,
+// most significant sample first
+#define VOLK_GNSSSDR_UNPACK1BITPUPPET_SAMPLES_PER_BYTE 8
+#define VOLK_GNSSSDR_UNPACK1BITPUPPET_ORDER_MASK 7
+
+
+#ifdef LV_HAVE_GENERIC
+static inline void volk_gnsssdr_8u_unpack1bitpuppet_8i_generic(char* result, const unsigned char* packed, unsigned int num_points)
+{
+    const char levels[] = {-1, 1};
+    volk_gnsssdr_8u_unpack_1bit_8i_generic(result, packed, levels, VOLK_GNSSSDR_UNPACK1BITPUPPET_ORDER_MASK, num_points / VOLK_GNSSSDR_UNPACK1BITPUPPET_SAMPLES_PER_BYTE);
+}
+#endif /* LV_HAVE_GENERIC */
+
+
+#ifdef LV_HAVE_SSSE3
+static inline void volk_gnsssdr_8u_unpack1bitpuppet_8i_u_ssse3(char* result, const unsigned char* packed, unsigned int num_points)
+{
+    const char levels[] = {-1, 1};
+    volk_gnsssdr_8u_unpack_1bit_8i_u_ssse3(result, packed, levels, VOLK_GNSSSDR_UNPACK1BITPUPPET_ORDER_MASK, num_points / VOLK_GNSSSDR_UNPACK1BITPUPPET_SAMPLES_PER_BYTE);
+}
+#endif /* LV_HAVE_SSSE3 */
+
+
+#ifdef LV_HAVE_NEON
+static inline void volk_gnsssdr_8u_unpack1bitpuppet_8i_neon(char* result, const unsigned char* packed, unsigned int num_points)
+{
+    const char levels[] = {-1, 1};
+    volk_gnsssdr_8u_unpack_1bit_8i_neon(result, packed, levels, VOLK_GNSSSDR_UNPACK1BITPUPPET_ORDER_MASK, num_points / VOLK_GNSSSDR_UNPACK1BITPUPPET_SAMPLES_PER_BYTE);
+}
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_gnsssdr_8u_unpack1bitpuppet_8i_H */
@@ -0,0 +1,164 @@
+/*!
+ * \file volk_gnsssdr_8u_unpack_1bit_8i.h
+ * \brief VOLK_GNSSSDR kernel: unpacks bytes of eight 1-bit samples into
+ * 8 bits (char) samples.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * VOLK_GNSSSDR kernel that decodes the packed 1-bit (sign) samples of the
+ * front-ends, eight per byte, into two output levels
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+/*!
+ * \page volk_gnsssdr_8u_unpack_1bit_8i
+ *
+ * \b Overview
+ *
+ * Each input byte is unpacked into eight samples, where sample k is
+ * levels[1] if the bit (k ^ order_mask) of the byte is set, and levels[0]
+ * otherwise. An order mask of 0 takes the least significant bit first, and
+ * 7 the most significant bit first.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_gnsssdr_8u_unpack_1bit_8i(char* result, const unsigned char* packed, const char* levels, unsigned int order_mask, unsigned int num_bytes);
+ * \endcode
+ *
+ * \b Inputs
+ * \li packed: The packed samples.
+ * \li levels: The values of a clear and of a set bit.
+ * \li order_mask: From 0 to 7, the order of the samples in a byte.
+ * \li num_bytes: Number of packed bytes.
+ *
+ * \b Outputs
+ * \li result: The 8 * num_bytes samples.
+ *
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_8u_unpack_1bit_8i_H
+#define INCLUDED_volk_gnsssdr_8u_unpack_1bit_8i_H
+
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_gnsssdr_8u_unpack_1bit_8i_generic(char* result, const unsigned char* packed, const char* levels, unsigned int order_mask, unsigned int num_bytes)
+{
+    unsigned int n;
+    unsigned int k;
+    char* out = result;
+    for(n = 0; n < num_bytes; n++)
+        {
+            const unsigned char byte = packed[n];
+            for(k = 0; k < 8; k++)
+                {
+                    *out++ = levels[(byte >> (k ^ order_mask)) & 1];
+                }
+        }
+}
+#endif /* LV_HAVE_GENERIC */
+
+
+#ifdef LV_HAVE_SSSE3
+#include <tmmintrin.h>
+
+static inline void volk_gnsssdr_8u_unpack_1bit_8i_u_ssse3(char* result, const unsigned char* packed, const char* levels, unsigned int order_mask, unsigned int num_bytes)
+{
+    const unsigned int sse_iters = num_bytes / 16;
+    unsigned int number;
+    unsigned int j;
+    unsigned int n;
+    unsigned int k;
+    const unsigned char* aPtr = packed;
+    char* cPtr = result;
+
+    __VOLK_ATTR_ALIGNED(16) unsigned char bit_table[16];
+    for(k = 0; k < 16; k++)
+        {
+            bit_table[k] = (unsigned char)(1 << ((k & 7) ^ (order_mask & 7)));
+        }
+    const __m128i bits = _mm_load_si128((__m128i*)bit_table);
+    const __m128i low = _mm_set1_epi8(levels[0]);
+    const __m128i flip = _mm_xor_si128(low, _mm_set1_epi8(levels[1]));
+    // lanes 0 to 7 read byte 2j, lanes 8 to 15 byte 2j + 1
+    const __m128i first_index = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1);
+    const __m128i two = _mm_set1_epi8(2);
+    __m128i x, index, set;
+
+    for(number = 0; number < sse_iters; number++)
+        {
+            x = _mm_loadu_si128((__m128i*)aPtr);
+            index = first_index;
+            for(j = 0; j < 8; j++)
+                {
+                    set = _mm_cmpeq_epi8(_mm_and_si128(_mm_shuffle_epi8(x, index), bits), bits);
+                    _mm_storeu_si128((__m128i*)cPtr, _mm_xor_si128(low, _mm_and_si128(set, flip)));
+                    index = _mm_add_epi8(index, two);
+                    cPtr += 16;
+                }
+            aPtr += 16;
+        }
+
+    for(n = sse_iters * 16; n < num_bytes; n++)
+        {
+            const unsigned char byte = *aPtr++;
+            for(k = 0; k < 8; k++)
+                {
+                    *cPtr++ = levels[(byte >> (k ^ order_mask)) & 1];
+                }
+        }
+}
+#endif /* LV_HAVE_SSSE3 */
+
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_8u_unpack_1bit_8i_neon(char* result, const unsigned char* packed, const char* levels, unsigned int order_mask, unsigned int num_bytes)
+{
+    unsigned int n;
+    unsigned int k;
+    unsigned char bit_table[8];
+    for(k = 0; k < 8; k++)
+        {
+            bit_table[k] = (unsigned char)(1 << (k ^ (order_mask & 7)));
+        }
+    const uint8x8_t bits = vld1_u8(bit_table);
+    const uint8x8_t low = vdup_n_u8((unsigned char)levels[0]);
+    const uint8x8_t high = vdup_n_u8((unsigned char)levels[1]);
+    char* cPtr = result;
+
+    for(n = 0; n < num_bytes; n++)
+        {
+            uint8x8_t set = vtst_u8(vdup_n_u8(packed[n]), bits);
+            vst1_u8((unsigned char*)cPtr, vbsl_u8(set, high, low));
+            cPtr += 8;
+        }
+}
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_gnsssdr_8u_unpack_1bit_8i_H */
@@ -0,0 +1,174 @@
+/*!
+ * \file volk_gnsssdr_8u_unpack_4bit_8i.h
+ * \brief VOLK_GNSSSDR kernel: unpacks bytes of two 4-bit samples into
+ * 8 bits (char) samples.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * VOLK_GNSSSDR kernel that decodes packed 4-bit samples (two per byte)
+ * through a table of sixteen output levels
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+/*!
+ * \page volk_gnsssdr_8u_unpack_4bit_8i
+ *
+ * \b Overview
+ *
+ * Each input byte holds two 4-bit codes: code k is (byte >> 4k) & 15. The
+ * byte is unpacked into two samples, where sample k is
+ * levels[code (k ^ order_mask)]:
+ * \li 0: the least significant nibble first
+ * \li 1: the most significant nibble first
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_gnsssdr_8u_unpack_4bit_8i(char* result, const unsigned char* packed, const char* levels, unsigned int order_mask, unsigned int num_bytes);
+ * \endcode
+ *
+ * \b Inputs
+ * \li packed: The packed samples.
+ * \li levels: The values of the sixteen codes.
+ * \li order_mask: 0 or 1, the order of the samples in a byte.
+ * \li num_bytes: Number of packed bytes.
+ *
+ * \b Outputs
+ * \li result: The 2 * num_bytes samples.
+ *
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_8u_unpack_4bit_8i_H
+#define INCLUDED_volk_gnsssdr_8u_unpack_4bit_8i_H
+
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_gnsssdr_8u_unpack_4bit_8i_generic(char* result, const unsigned char* packed, const char* levels, unsigned int order_mask, unsigned int num_bytes)
+{
+    unsigned int n;
+    unsigned int k;
+    char* out = result;
+    for(n = 0; n < num_bytes; n++)
+        {
+            const unsigned char byte = packed[n];
+            for(k = 0; k < 2; k++)
+                {
+                    *out++ = levels[(byte >> (4 * ((k ^ order_mask) & 1))) & 15];
+                }
+        }
+}
+#endif /* LV_HAVE_GENERIC */
+
+
+#ifdef LV_HAVE_SSSE3
+#include <tmmintrin.h>
+
+static inline void volk_gnsssdr_8u_unpack_4bit_8i_u_ssse3(char* result, const unsigned char* packed, const char* levels, unsigned int order_mask, unsigned int num_bytes)
+{
+    const unsigned int sse_iters = num_bytes / 16;
+    unsigned int number;
+    unsigned int n;
+    unsigned int k;
+    const unsigned char* aPtr = packed;
+    char* cPtr = result;
+
+    // the sixteen levels are exactly one shuffle table
+    const __m128i lut = _mm_loadu_si128((const __m128i*)levels);
+    const __m128i mask = _mm_set1_epi8(15);
+    __m128i x, codes[2], s0, s1;
+
+    for(number = 0; number < sse_iters; number++)
+        {
+            x = _mm_loadu_si128((__m128i*)aPtr);
+            // the 16 bits shift is fine: the bits crossing into the next byte are masked out
+            codes[0] = _mm_shuffle_epi8(lut, _mm_and_si128(x, mask));
+            codes[1] = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(x, 4), mask));
+            s0 = codes[order_mask & 1];
+            s1 = codes[(1 ^ order_mask) & 1];
+            _mm_storeu_si128((__m128i*)cPtr, _mm_unpacklo_epi8(s0, s1));
+            _mm_storeu_si128((__m128i*)(cPtr + 16), _mm_unpackhi_epi8(s0, s1));
+
+            aPtr += 16;
+            cPtr += 32;
+        }
+
+    for(n = sse_iters * 16; n < num_bytes; n++)
+        {
+            const unsigned char byte = *aPtr++;
+            for(k = 0; k < 2; k++)
+                {
+                    *cPtr++ = levels[(byte >> (4 * ((k ^ order_mask) & 1))) & 15];
+                }
+        }
+}
+#endif /* LV_HAVE_SSSE3 */
+
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_8u_unpack_4bit_8i_neon(char* result, const unsigned char* packed, const char* levels, unsigned int order_mask, unsigned int num_bytes)
+{
+    const unsigned int neon_iters = num_bytes / 8;
+    unsigned int number;
+    unsigned int n;
+    unsigned int k;
+    const unsigned char* aPtr = packed;
+    char* cPtr = result;
+
+    uint8x8x2_t lut;
+    lut.val[0] = vld1_u8((const unsigned char*)levels);
+    lut.val[1] = vld1_u8((const unsigned char*)levels + 8);
+    const uint8x8_t mask = vdup_n_u8(15);
+    uint8x8_t x, codes[2];
+    uint8x8x2_t samples;
+
+    for(number = 0; number < neon_iters; number++)
+        {
+            x = vld1_u8(aPtr);
+            codes[0] = vtbl2_u8(lut, vand_u8(x, mask));
+            codes[1] = vtbl2_u8(lut, vshr_n_u8(x, 4));
+            samples.val[0] = codes[order_mask & 1];
+            samples.val[1] = codes[(1 ^ order_mask) & 1];
+            vst2_u8((unsigned char*)cPtr, samples); // interleaves the two samples of each byte
+
+            aPtr += 8;
+            cPtr += 16;
+        }
+
+    for(n = neon_iters * 8; n < num_bytes; n++)
+        {
+            const unsigned char byte = *aPtr++;
+            for(k = 0; k < 2; k++)
+                {
+                    *cPtr++ = levels[(byte >> (4 * ((k ^ order_mask) & 1))) & 15];
+                }
+        }
+}
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_gnsssdr_8u_unpack_4bit_8i_H */
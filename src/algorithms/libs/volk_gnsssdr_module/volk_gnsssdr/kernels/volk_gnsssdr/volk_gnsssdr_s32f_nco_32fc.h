@@ -0,0 +1,317 @@
+/*!
+ * \file volk_gnsssdr_s32f_nco_32fc.h
+ * \brief VOLK_GNSSSDR kernel: generates a complex exponential (32-bit float per component)
+ * with a phase accumulator and a sine table.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * VOLK_GNSSSDR kernel that computes the sine and cosine of a phase that grows at a fixed rate
+ * per sample, as volk_gnsssdr_s32f_sincos_32fc, but without polynomial evaluations: the phase is
+ * accumulated in a 32 bits integer and sine and cosine are read from a table.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+/*!
+ * \page volk_gnsssdr_s32f_nco_32fc
+ *
+ * \b Overview
+ *
+ * Numerically controlled oscillator: computes the sine and cosine of a phase with a fixed
+ * increment \p phase_inc per sample, providing the output in a complex vector (cosine, sine).
+ * The phase is accumulated in fixed point (2^32 is 2 pi), and it is corrected against the
+ * exact phase every 1024 samples, so that the rounding of the increment does not accumulate.
+ * Sine and cosine are interpolated on a 1024 points table. The maximum absolute error is below 3e-6,
+ * and it does not depend on the magnitude of the phase.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_gnsssdr_s32f_nco_32fc(lv_32fc_t* out, const float phase_inc, float* phase, unsigned int num_points)
+ * \endcode
+ *
+ * \b Inputs
+ * \li phase_inc:      Phase increment per sample, in radians.
+ * \li phase:          Pointer to a float containing the initial phase, in radians.
+ * \li num_points:     Number of components in \p out to be computed.
+ *
+ * \b Outputs
+ * \li out:            Vector of the form lv_32fc_t out[n] = lv_cmake(cos(phase + n * phase_inc), sin(phase + n * phase_inc))
+ * \li phase:          Pointer to a float containing the final phase, in radians.
+ *
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_s32f_nco_32fc_H
+#define INCLUDED_volk_gnsssdr_s32f_nco_32fc_H
+
+#include <volk_gnsssdr/volk_gnsssdr_common.h>
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+#include <volk_gnsssdr/volk_gnsssdr_nco.h>
+
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_gnsssdr_s32f_nco_32fc_generic(lv_32fc_t* out, const float phase_inc, float* phase, unsigned int num_points)
+{
+    const uint32_t fxpt_phase_inc = nco_rad_to_fxpt((double)phase_inc);
+    uint32_t fxpt_phase = 0;
+    float s, c;
+    for(unsigned int n = 0; n < num_points; n++)
+        {
+            // Periodic correction of the accumulated phase
+            if ((n % VOLK_GNSSSDR_NCO_RELOAD) == 0)
+                {
+                    fxpt_phase = nco_fxpt_phase_at(*phase, phase_inc, n);
+                }
+            nco_fxpt_sincos(fxpt_phase, &s, &c);
+            *out++ = lv_cmake(c, s);
+            fxpt_phase += fxpt_phase_inc;
+        }
+    (*phase) = (float)((double)(*phase) + (double)num_points * (double)phase_inc);
+}
+
+#endif /* LV_HAVE_GENERIC  */
+
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void volk_gnsssdr_s32f_nco_32fc_a_avx2(lv_32fc_t* out, const float phase_inc, float* phase, unsigned int num_points)
+{
+    const unsigned int avx2_iters = num_points / 8;
+    const uint32_t fxpt_phase_inc = nco_rad_to_fxpt((double)phase_inc);
+    uint32_t fxpt_phase = 0;
+    float s, c;
+
+    const __m256i fxpt_phase_inc8 = _mm256_set1_epi32((int)(fxpt_phase_inc * 8));
+    const __m256i fxpt_offsets = _mm256_setr_epi32(0, (int)fxpt_phase_inc, (int)(fxpt_phase_inc * 2), (int)(fxpt_phase_inc * 3),
+            (int)(fxpt_phase_inc * 4), (int)(fxpt_phase_inc * 5), (int)(fxpt_phase_inc * 6), (int)(fxpt_phase_inc * 7));
+    const __m256i quarter_cycle = _mm256_set1_epi32(0x40000000);
+    const float* table = (const float*)sine_table_10bits;
+    __m256i fxpt_phase_reg = _mm256_setzero_si256();
+    __m256i ux, index;
+    __m256 slope, offset, s_reg, c_reg, aux1, aux2;
+
+    for(unsigned int number = 0; number < avx2_iters; number++)
+        {
+            // Periodic correction of the accumulated phase
+            if ((number % (VOLK_GNSSSDR_NCO_RELOAD / 8)) == 0)
+                {
+                    fxpt_phase = nco_fxpt_phase_at(*phase, phase_inc, number * 8);
+                    fxpt_phase_reg = _mm256_add_epi32(_mm256_set1_epi32((int)fxpt_phase), fxpt_offsets);
+                }
+
+            // sine: table entry given by the 10 most significant bits of the phase
+            ux = fxpt_phase_reg;
+            index = _mm256_slli_epi32(_mm256_srli_epi32(ux, 22), 1);
+            slope = _mm256_i32gather_ps(table, index, 4);
+            offset = _mm256_i32gather_ps(table + 1, index, 4);
+            s_reg = _mm256_add_ps(_mm256_mul_ps(slope, _mm256_cvtepi32_ps(_mm256_srli_epi32(ux, 1))), offset);
+
+            // cosine: same, a quarter of cycle ahead
+            ux = _mm256_add_epi32(ux, quarter_cycle);
+            index = _mm256_slli_epi32(_mm256_srli_epi32(ux, 22), 1);
+            slope = _mm256_i32gather_ps(table, index, 4);
+            offset = _mm256_i32gather_ps(table + 1, index, 4);
+            c_reg = _mm256_add_ps(_mm256_mul_ps(slope, _mm256_cvtepi32_ps(_mm256_srli_epi32(ux, 1))), offset);
+
+            // interleave cosines and sines (unpack works per lane: restore the sample order)
+            aux1 = _mm256_unpacklo_ps(c_reg, s_reg);
+            aux2 = _mm256_unpackhi_ps(c_reg, s_reg);
+            _mm256_store_ps((float*)out, _mm256_permute2f128_ps(aux1, aux2, 0x20));
+            _mm256_store_ps((float*)(out + 4), _mm256_permute2f128_ps(aux1, aux2, 0x31));
+            out += 8;
+
+            fxpt_phase_reg = _mm256_add_epi32(fxpt_phase_reg, fxpt_phase_inc8);
+        }
+    _mm256_zeroupper();
+
+    fxpt_phase = (uint32_t)_mm256_extract_epi32(fxpt_phase_reg, 0);
+    for(unsigned int n = avx2_iters * 8; n < num_points; n++)
+        {
+            if ((n % VOLK_GNSSSDR_NCO_RELOAD) == 0)
+                {
+                    fxpt_phase = nco_fxpt_phase_at(*phase, phase_inc, n);
+                }
+            nco_fxpt_sincos(fxpt_phase, &s, &c);
+            *out++ = lv_cmake(c, s);
+            fxpt_phase += fxpt_phase_inc;
+        }
+    (*phase) = (float)((double)(*phase) + (double)num_points * (double)phase_inc);
+}
+
+#endif /* LV_HAVE_AVX2  */
+
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void volk_gnsssdr_s32f_nco_32fc_u_avx2(lv_32fc_t* out, const float phase_inc, float* phase, unsigned int num_points)
+{
+    const unsigned int avx2_iters = num_points / 8;
+    const uint32_t fxpt_phase_inc = nco_rad_to_fxpt((double)phase_inc);
+    uint32_t fxpt_phase = 0;
+    float s, c;
+
+    const __m256i fxpt_phase_inc8 = _mm256_set1_epi32((int)(fxpt_phase_inc * 8));
+    const __m256i fxpt_offsets = _mm256_setr_epi32(0, (int)fxpt_phase_inc, (int)(fxpt_phase_inc * 2), (int)(fxpt_phase_inc * 3),
+            (int)(fxpt_phase_inc * 4), (int)(fxpt_phase_inc * 5), (int)(fxpt_phase_inc * 6), (int)(fxpt_phase_inc * 7));
+    const __m256i quarter_cycle = _mm256_set1_epi32(0x40000000);
+    const float* table = (const float*)sine_table_10bits;
+    __m256i fxpt_phase_reg = _mm256_setzero_si256();
+    __m256i ux, index;
+    __m256 slope, offset, s_reg, c_reg, aux1, aux2;
+
+    for(unsigned int number = 0; number < avx2_iters; number++)
+        {
+            // Periodic correction of the accumulated phase
+            if ((number % (VOLK_GNSSSDR_NCO_RELOAD / 8)) == 0)
+                {
+                    fxpt_phase = nco_fxpt_phase_at(*phase, phase_inc, number * 8);
+                    fxpt_phase_reg = _mm256_add_epi32(_mm256_set1_epi32((int)fxpt_phase), fxpt_offsets);
+                }
+
+            // sine: table entry given by the 10 most significant bits of the phase
+            ux = fxpt_phase_reg;
+            index = _mm256_slli_epi32(_mm256_srli_epi32(ux, 22), 1);
+            slope = _mm256_i32gather_ps(table, index, 4);
+            offset = _mm256_i32gather_ps(table + 1, index, 4);
+            s_reg = _mm256_add_ps(_mm256_mul_ps(slope, _mm256_cvtepi32_ps(_mm256_srli_epi32(ux, 1))), offset);
+
+            // cosine: same, a quarter of cycle ahead
+            ux = _mm256_add_epi32(ux, quarter_cycle);
+            index = _mm256_slli_epi32(_mm256_srli_epi32(ux, 22), 1);
+            slope = _mm256_i32gather_ps(table, index, 4);
+            offset = _mm256_i32gather_ps(table + 1, index, 4);
+            c_reg = _mm256_add_ps(_mm256_mul_ps(slope, _mm256_cvtepi32_ps(_mm256_srli_epi32(ux, 1))), offset);
+
+            // interleave cosines and sines (unpack works per lane: restore the sample order)
+            aux1 = _mm256_unpacklo_ps(c_reg, s_reg);
+            aux2 = _mm256_unpackhi_ps(c_reg, s_reg);
+            _mm256_storeu_ps((float*)out, _mm256_permute2f128_ps(aux1, aux2, 0x20));
+            _mm256_storeu_ps((float*)(out + 4), _mm256_permute2f128_ps(aux1, aux2, 0x31));
+            out += 8;
+
+            fxpt_phase_reg = _mm256_add_epi32(fxpt_phase_reg, fxpt_phase_inc8);
+        }
+    _mm256_zeroupper();
+
+    fxpt_phase = (uint32_t)_mm256_extract_epi32(fxpt_phase_reg, 0);
+    for(unsigned int n = avx2_iters * 8; n < num_points; n++)
+        {
+            if ((n % VOLK_GNSSSDR_NCO_RELOAD) == 0)
+                {
+                    fxpt_phase = nco_fxpt_phase_at(*phase, phase_inc, n);
+                }
+            nco_fxpt_sincos(fxpt_phase, &s, &c);
+            *out++ = lv_cmake(c, s);
+            fxpt_phase += fxpt_phase_inc;
+        }
+    (*phase) = (float)((double)(*phase) + (double)num_points * (double)phase_inc);
+}
+
+#endif /* LV_HAVE_AVX2  */
+
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_gnsssdr_s32f_nco_32fc_neon(lv_32fc_t* out, const float phase_inc, float* phase, unsigned int num_points)
+{
+    const unsigned int neon_iters = num_points / 4;
+    const uint32_t fxpt_phase_inc = nco_rad_to_fxpt((double)phase_inc);
+    uint32_t fxpt_phase = 0;
+    float s, c;
+
+    __VOLK_ATTR_ALIGNED(16) uint32_t __fxpt_phase[4];
+    __VOLK_ATTR_ALIGNED(16) uint32_t __index[4];
+    __VOLK_ATTR_ALIGNED(16) float32_t __slope[4];
+    __VOLK_ATTR_ALIGNED(16) float32_t __offset[4];
+    const uint32x4_t fxpt_phase_inc4 = vdupq_n_u32(fxpt_phase_inc * 4);
+    const uint32x4_t quarter_cycle = vdupq_n_u32(0x40000000);
+    uint32x4_t fxpt_phase_reg = vdupq_n_u32(0);
+    uint32x4_t ux;
+    float32x4_t s_reg, c_reg;
+    float32x4x2_t result;
+
+    for(unsigned int number = 0; number < neon_iters; number++)
+        {
+            /* Periodic correction of the accumulated phase */
+            if ((number % (VOLK_GNSSSDR_NCO_RELOAD / 4)) == 0)
+                {
+                    fxpt_phase = nco_fxpt_phase_at(*phase, phase_inc, number * 4);
+                    for (int i = 0; i < 4; i++)
+                        {
+                            __fxpt_phase[i] = fxpt_phase + i * fxpt_phase_inc;
+                        }
+                    fxpt_phase_reg = vld1q_u32(__fxpt_phase);
+                }
+
+            /* sine: table entry given by the 10 most significant bits of the phase */
+            ux = fxpt_phase_reg;
+            vst1q_u32(__index, vshrq_n_u32(ux, 22));
+            for (int i = 0; i < 4; i++)
+                {
+                    __slope[i] = sine_table_10bits[__index[i]][0];
+                    __offset[i] = sine_table_10bits[__index[i]][1];
+                }
+            s_reg = vmlaq_f32(vld1q_f32(__offset), vld1q_f32(__slope), vcvtq_f32_u32(vshrq_n_u32(ux, 1)));
+
+            /* cosine: same, a quarter of cycle ahead */
+            ux = vaddq_u32(ux, quarter_cycle);
+            vst1q_u32(__index, vshrq_n_u32(ux, 22));
+            for (int i = 0; i < 4; i++)
+                {
+                    __slope[i] = sine_table_10bits[__index[i]][0];
+                    __offset[i] = sine_table_10bits[__index[i]][1];
+                }
+            c_reg = vmlaq_f32(vld1q_f32(__offset), vld1q_f32(__slope), vcvtq_f32_u32(vshrq_n_u32(ux, 1)));
+
+            result.val[0] = c_reg;
+            result.val[1] = s_reg;
+            vst2q_f32((float32_t*)out, result);
+            out += 4;
+
+            fxpt_phase_reg = vaddq_u32(fxpt_phase_reg, fxpt_phase_inc4);
+        }
+
+    vst1q_u32(__fxpt_phase, fxpt_phase_reg);
+    fxpt_phase = __fxpt_phase[0];
+    for(unsigned int n = neon_iters * 4; n < num_points; n++)
+        {
+            if ((n % VOLK_GNSSSDR_NCO_RELOAD) == 0)
+                {
+                    fxpt_phase = nco_fxpt_phase_at(*phase, phase_inc, n);
+                }
+            nco_fxpt_sincos(fxpt_phase, &s, &c);
+            *out++ = lv_cmake(c, s);
+            fxpt_phase += fxpt_phase_inc;
+        }
+    (*phase) = (float)((double)(*phase) + (double)num_points * (double)phase_inc);
+}
+
+#endif /* LV_HAVE_NEON  */
+
+#endif /* INCLUDED_volk_gnsssdr_s32f_nco_32fc_H */
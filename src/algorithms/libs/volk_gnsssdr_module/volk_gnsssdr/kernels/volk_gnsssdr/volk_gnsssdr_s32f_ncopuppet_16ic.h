@@ -0,0 +1,83 @@
+/*!
+ * \file volk_gnsssdr_s32f_ncopuppet_16ic.h
+ * \brief VOLK_GNSSSDR puppet for the volk_gnsssdr_s32f_nco_16ic kernel.
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * VOLK_GNSSSDR puppet for integrating the numerically controlled oscillator into the test system
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef INCLUDED_volk_gnsssdr_s32f_ncopuppet_16ic_H
+#define INCLUDED_volk_gnsssdr_s32f_ncopuppet_16ic_H
+
+
+#include <volk_gnsssdr/volk_gnsssdr_complex.h>
+#include "volk_gnsssdr/volk_gnsssdr_s32f_nco_16ic.h"
+#include <math.h>
+
+
+#ifdef LV_HAVE_GENERIC
+static inline void volk_gnsssdr_s32f_ncopuppet_16ic_generic(lv_16sc_t* out, const float phase_inc, unsigned int num_points)
+{
+    float phase[1];
+    phase[0] = 3;
+    volk_gnsssdr_s32f_nco_16ic_generic(out, phase_inc, phase, num_points);
+}
+#endif  /* LV_HAVE_GENERIC  */
+
+
+#ifdef LV_HAVE_AVX2
+static inline void volk_gnsssdr_s32f_ncopuppet_16ic_a_avx2(lv_16sc_t* out, const float phase_inc, unsigned int num_points)
+{
+    float phase[1];
+    phase[0] = 3;
+    volk_gnsssdr_s32f_nco_16ic_a_avx2(out, phase_inc, phase, num_points);
+}
+#endif  /* LV_HAVE_AVX2  */
+
+
+#ifdef LV_HAVE_AVX2
+static inline void volk_gnsssdr_s32f_ncopuppet_16ic_u_avx2(lv_16sc_t* out, const float phase_inc, unsigned int num_points)
+{
+    float phase[1];
+    phase[0] = 3;
+    volk_gnsssdr_s32f_nco_16ic_u_avx2(out, phase_inc, phase, num_points);
+}
+#endif  /* LV_HAVE_AVX2  */
+
+
+#ifdef LV_HAVE_NEON
+static inline void volk_gnsssdr_s32f_ncopuppet_16ic_neon(lv_16sc_t* out, const float phase_inc, unsigned int num_points)
+{
+    float phase[1];
+    phase[0] = 3;
+    volk_gnsssdr_s32f_nco_16ic_neon(out, phase_inc, phase, num_points);
+}
+#endif  /* LV_HAVE_NEON  */
+
+#endif  /* INCLUDED_volk_gnsssdr_s32f_ncopuppet_16ic_H */
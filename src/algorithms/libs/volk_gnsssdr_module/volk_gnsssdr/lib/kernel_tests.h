@@ -70,9 +70,12 @@ std::vector<volk_gnsssdr_test_case_t> init_test_list(volk_gnsssdr_test_params_t
         (VOLK_INIT_TEST(volk_gnsssdr_8i_index_max_16u, test_params_more_iters))
         (VOLK_INIT_TEST(volk_gnsssdr_8i_max_s8i, test_params_more_iters))
         (VOLK_INIT_TEST(volk_gnsssdr_8i_x2_add_8i, test_params_more_iters))
+        (VOLK_INIT_TEST(volk_gnsssdr_8i_x2_interleave_8ic, test_params_more_iters))
         (VOLK_INIT_TEST(volk_gnsssdr_8ic_conjugate_8ic, test_params_more_iters))
+        (VOLK_INIT_TEST(volk_gnsssdr_8ic_convert_16ic, test_params_more_iters))
         (VOLK_INIT_TEST(volk_gnsssdr_8ic_magnitude_squared_8i, test_params_more_iters))
         (VOLK_INIT_TEST(volk_gnsssdr_8ic_x2_dot_prod_8ic, test_params))
+        (VOLK_INIT_PUPP(volk_gnsssdr_8ic_x2_slidingdotprodpuppet_32fc, volk_gnsssdr_8ic_x2_sliding_dot_prod_32fc, test_params))
         (VOLK_INIT_TEST(volk_gnsssdr_8ic_x2_multiply_8ic, test_params))
         (VOLK_INIT_TEST(volk_gnsssdr_8ic_s8ic_multiply_8ic, test_params))
         (VOLK_INIT_TEST(volk_gnsssdr_8u_x2_multiply_8u, test_params_more_iters))
@@ -83,7 +86,10 @@ std::vector<volk_gnsssdr_test_case_t> init_test_list(volk_gnsssdr_test_params_t
         (VOLK_INIT_TEST(volk_gnsssdr_16ic_x2_dot_prod_16ic, test_params))
         (VOLK_INIT_TEST(volk_gnsssdr_16ic_x2_multiply_16ic, test_params_more_iters))
         (VOLK_INIT_TEST(volk_gnsssdr_16ic_convert_32fc, test_params_more_iters))
+        (VOLK_INIT_TEST(volk_gnsssdr_16i_x2_interleave_16ic, test_params_more_iters))
         (VOLK_INIT_PUPP(volk_gnsssdr_s32f_sincospuppet_32fc, volk_gnsssdr_s32f_sincos_32fc, test_params_inacc2))
+        (VOLK_INIT_PUPP(volk_gnsssdr_s32f_ncopuppet_32fc, volk_gnsssdr_s32f_nco_32fc, test_params_inacc))
+        (VOLK_INIT_PUPP(volk_gnsssdr_s32f_ncopuppet_16ic, volk_gnsssdr_s32f_nco_16ic, test_params_int1))
         (VOLK_INIT_PUPP(volk_gnsssdr_16ic_rotatorpuppet_16ic, volk_gnsssdr_16ic_s32fc_x2_rotator_16ic, test_params_int1))
         (VOLK_INIT_PUPP(volk_gnsssdr_16ic_resamplerfastpuppet_16ic, volk_gnsssdr_16ic_resampler_fast_16ic, test_params))
         (VOLK_INIT_PUPP(volk_gnsssdr_16ic_resamplerfastxnpuppet_16ic, volk_gnsssdr_16ic_xn_resampler_fast_16ic_xn, test_params))
@@ -91,7 +97,20 @@ std::vector<volk_gnsssdr_test_case_t> init_test_list(volk_gnsssdr_test_params_t
         (VOLK_INIT_PUPP(volk_gnsssdr_32fc_resamplerxnpuppet_32fc, volk_gnsssdr_32fc_xn_resampler_32fc_xn, test_params))
         (VOLK_INIT_PUPP(volk_gnsssdr_16ic_x2_dotprodxnpuppet_16ic, volk_gnsssdr_16ic_x2_dot_prod_16ic_xn, test_params))
         (VOLK_INIT_PUPP(volk_gnsssdr_16ic_x2_rotator_dotprodxnpuppet_16ic, volk_gnsssdr_16ic_x2_rotator_dot_prod_16ic_xn, test_params_int16))
+        (VOLK_INIT_PUPP(volk_gnsssdr_16ic_x2_rotator_resampler_dotprodxnpuppet_16ic, volk_gnsssdr_16ic_x2_rotator_resampler_dot_prod_16ic_xn, test_params_int16))
+        (VOLK_INIT_PUPP(volk_gnsssdr_16ic_x2_rotator_dotprodxnxmpuppet_16ic, volk_gnsssdr_16ic_x2_rotator_dot_prod_16ic_xn_xm, test_params_int16))
+        (VOLK_INIT_PUPP(volk_gnsssdr_16ic_x2_slidingdotprodpuppet_32fc, volk_gnsssdr_16ic_x2_sliding_dot_prod_32fc, test_params))
         (VOLK_INIT_PUPP(volk_gnsssdr_32fc_x2_rotator_dotprodxnpuppet_32fc, volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn, test_params_int1))
+        (VOLK_INIT_PUPP(volk_gnsssdr_32fc_x2_rotator_dotprodxnxmpuppet_32fc, volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn_xm, test_params_int1))
+        (VOLK_INIT_PUPP(volk_gnsssdr_32fc_x2_multiplyfoldpuppet_32fc, volk_gnsssdr_32fc_x2_multiply_fold_32fc, test_params_inacc))
+        (VOLK_INIT_TEST(volk_gnsssdr_32fc_lock_statistics_32f, test_params_int1))
+        (VOLK_INIT_PUPP(volk_gnsssdr_32fc_magnitudesquaredpeakspuppet_32f, volk_gnsssdr_32fc_magnitude_squared_peaks_32f, test_params_inacc))
+        (VOLK_INIT_PUPP(volk_gnsssdr_8u_unpack2bitpuppet_8i, volk_gnsssdr_8u_unpack_2bit_8i, test_params))
+        (VOLK_INIT_PUPP(volk_gnsssdr_8u_unpack4bitpuppet_8i, volk_gnsssdr_8u_unpack_4bit_8i, test_params))
+        (VOLK_INIT_PUPP(volk_gnsssdr_8u_unpack1bitpuppet_8i, volk_gnsssdr_8u_unpack_1bit_8i, test_params))
+        (VOLK_INIT_PUPP(volk_gnsssdr_32fc_xn_weightedsumpuppet_32fc, volk_gnsssdr_32fc_xn_weighted_sum_32fc, test_params_inacc))
+        (VOLK_INIT_PUPP(volk_gnsssdr_16ic_xn_weightedsumpuppet_16ic, volk_gnsssdr_16ic_xn_weighted_sum_16ic, test_params_int1))
+        (VOLK_INIT_PUPP(volk_gnsssdr_8u_convertpuppet_32f, volk_gnsssdr_8u_s32f_convert_32f, test_params))
         ;
 
     return test_cases;
@@ -418,6 +418,7 @@ bool run_volk_gnsssdr_tests(volk_gnsssdr_func_desc_t desc,
     results->back().name = name;
     results->back().vlen = vlen;
     results->back().iter = iter;
+    results->back().max_points = 0;
     std::cout << "RUN_VOLK_GNSSSDR_TESTS: " << name << "(" << vlen << "," << iter << ")" << std::endl;
 
     // vlen_twiddle will increase vlen for malloc and data generation
@@ -57,6 +57,7 @@ class volk_gnsssdr_test_results_t {
         std::map<std::string, volk_gnsssdr_test_time_t> results;
         std::string best_arch_a;
         std::string best_arch_u;
+        unsigned int max_points; // largest num_points the best archs are chosen for, 0 for any
 };
 
 class volk_gnsssdr_test_params_t {
@@ -38,17 +38,52 @@ void volk_gnsssdr_get_config_path(char *path)
     strcat(path, suffix);
 }
 
+// Runs the profiler to write the missing config file, if VOLK_GNSSSDR_AUTO_PROFILE asks for it
+static void volk_gnsssdr_auto_profile(void)
+{
+    char command[512];
+    const char *auto_profile = getenv("VOLK_GNSSSDR_AUTO_PROFILE");
+    if (auto_profile == NULL || auto_profile[0] == 0) return;
+    if (!strcmp(auto_profile, "1"))
+        {
+            // the block sizes of tracking and of acquisition
+            strcpy(command, "volk_gnsssdr_profile --sizes 2048,16384");
+        }
+    else
+        {
+            strncpy(command, auto_profile, sizeof(command) - 1);
+            command[sizeof(command) - 1] = 0;
+        }
+    // the profiler dispatches kernels too: it must not profile again
+#ifdef _WIN32
+    _putenv("VOLK_GNSSSDR_AUTO_PROFILE=");
+#else
+    unsetenv("VOLK_GNSSSDR_AUTO_PROFILE");
+#endif
+    fprintf(stderr, "VOLK_GNSSSDR: no profile found, running %s\n", command);
+    if (system(command) != 0)
+        {
+            fprintf(stderr, "VOLK_GNSSSDR warning: profiling failed, using the default kernels\n");
+        }
+}
+
 size_t volk_gnsssdr_load_preferences(volk_gnsssdr_arch_pref_t **prefs_res)
 {
     FILE *config_file;
     char path[512], line[512];
     size_t n_arch_prefs = 0;
     volk_gnsssdr_arch_pref_t *prefs = NULL;
+    int n_fields;
 
     //get the config path
     volk_gnsssdr_get_config_path(path);
     if (!path[0]) return n_arch_prefs; //no prefs found
     config_file = fopen(path, "r");
+    if(!config_file)
+        {
+            volk_gnsssdr_auto_profile();
+            config_file = fopen(path, "r");
+        }
     if(!config_file) return n_arch_prefs; //no prefs found
 
     //reset the file pointer and write the prefs into volk_gnsssdr_arch_prefs
@@ -56,8 +91,10 @@ size_t volk_gnsssdr_load_preferences(volk_gnsssdr_arch_pref_t **prefs_res)
         {
             prefs = (volk_gnsssdr_arch_pref_t *) realloc(prefs, (n_arch_prefs+1) * sizeof(*prefs));
             volk_gnsssdr_arch_pref_t *p = prefs + n_arch_prefs;
-            if(sscanf(line, "%s %s %s", p->name, p->impl_a, p->impl_u) == 3 && !strncmp(p->name, "volk_gnsssdr_", 5))
+            n_fields = sscanf(line, "%s %s %s %u", p->name, p->impl_a, p->impl_u, &p->max_points);
+            if(n_fields >= 3 && !strncmp(p->name, "volk_gnsssdr_", 5))
                 {
+                    if (n_fields == 3) p->max_points = 0; //for any size
                     n_arch_prefs++;
                 }
         }
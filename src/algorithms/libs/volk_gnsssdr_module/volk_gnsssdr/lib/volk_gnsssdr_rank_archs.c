@@ -19,6 +19,7 @@
 
 #include <volk_gnsssdr_rank_archs.h>
 #include <volk_gnsssdr/volk_gnsssdr_prefs.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -38,6 +39,22 @@ inline unsigned __popcnt(unsigned num)
 }
 #endif
 
+// The preferences are loaded once, at the first ranking
+static size_t volk_gnsssdr_get_prefs(volk_gnsssdr_arch_pref_t **prefs)
+{
+    static volk_gnsssdr_arch_pref_t *volk_gnsssdr_arch_prefs;
+    static size_t n_arch_prefs = 0;
+    static int prefs_loaded = 0;
+    if(!prefs_loaded)
+        {
+            n_arch_prefs = volk_gnsssdr_load_preferences(&volk_gnsssdr_arch_prefs);
+            prefs_loaded = 1;
+        }
+    *prefs = volk_gnsssdr_arch_prefs;
+    return n_arch_prefs;
+}
+
+
 int volk_gnsssdr_get_index(
         const char *impl_names[], //list of implementations by name
         const size_t n_impls,     //number of implementations available
@@ -69,14 +86,8 @@ int volk_gnsssdr_rank_archs(
 )
 {
     size_t i;
-    static volk_gnsssdr_arch_pref_t *volk_gnsssdr_arch_prefs;
-    static size_t n_arch_prefs = 0;
-    static int prefs_loaded = 0;
-    if(!prefs_loaded)
-        {
-            n_arch_prefs = volk_gnsssdr_load_preferences(&volk_gnsssdr_arch_prefs);
-            prefs_loaded = 1;
-        }
+    volk_gnsssdr_arch_pref_t *volk_gnsssdr_arch_prefs;
+    size_t n_arch_prefs = volk_gnsssdr_get_prefs(&volk_gnsssdr_arch_prefs);
 
     // If we've defined VOLK_GENERIC to be anything, always return the
     // 'generic' kernel. Used in GR's QA code.
@@ -86,10 +97,11 @@ int volk_gnsssdr_rank_archs(
             return volk_gnsssdr_get_index(impl_names, n_impls, "generic");
         }
 
-    //now look for the function name in the prefs list
+    //now look for the function name in the prefs list, for any size
     for(i = 0; i < n_arch_prefs; i++)
         {
-            if(!strncmp(kern_name, volk_gnsssdr_arch_prefs[i].name, sizeof(volk_gnsssdr_arch_prefs[i].name))) //found it
+            if(volk_gnsssdr_arch_prefs[i].max_points == 0 &&
+                    !strncmp(kern_name, volk_gnsssdr_arch_prefs[i].name, sizeof(volk_gnsssdr_arch_prefs[i].name))) //found it
                 {
                     const char *impl_name = align? volk_gnsssdr_arch_prefs[i].impl_a : volk_gnsssdr_arch_prefs[i].impl_u;
                     return volk_gnsssdr_get_index(impl_names, n_impls, impl_name);
@@ -122,3 +134,55 @@ int volk_gnsssdr_rank_archs(
     //otherwise return the best unaligned
     return best_index_u;
 }
+
+
+int volk_gnsssdr_rank_archs_sized(
+        const char *kern_name,    //name of the kernel to rank
+        const char *impl_names[], //list of implementations by name
+        const int* impl_deps,     //requirement mask per implementation
+        const bool* alignment,    //alignment status of each implementation
+        size_t n_impls,           //number of implementations available
+        const bool align,         //if false, filter aligned implementations
+        size_t bucket,            //size bucket, from the smallest sizes
+        unsigned int *max_points  //largest num_points of the bucket
+)
+{
+    size_t i, j;
+    volk_gnsssdr_arch_pref_t *volk_gnsssdr_arch_prefs;
+    size_t n_arch_prefs = volk_gnsssdr_get_prefs(&volk_gnsssdr_arch_prefs);
+    const volk_gnsssdr_arch_pref_t *found = NULL;
+
+    // the bucket-th smallest max_points of the kernel
+    if(!getenv("VOLK_GENERIC"))
+        {
+            for(i = 0; i < n_arch_prefs; i++)
+                {
+                    const volk_gnsssdr_arch_pref_t *pref = volk_gnsssdr_arch_prefs + i;
+                    size_t smaller = 0;
+                    if(pref->max_points == 0 || strncmp(kern_name, pref->name, sizeof(pref->name))) continue;
+                    for(j = 0; j < n_arch_prefs; j++)
+                        {
+                            const volk_gnsssdr_arch_pref_t *other = volk_gnsssdr_arch_prefs + j;
+                            if(other->max_points != 0 && other->max_points < pref->max_points &&
+                                    !strncmp(kern_name, other->name, sizeof(other->name)))
+                                {
+                                    smaller++;
+                                }
+                        }
+                    if(smaller == bucket)
+                        {
+                            found = pref;
+                            break;
+                        }
+                }
+        }
+    if(found)
+        {
+            *max_points = found->max_points;
+            return volk_gnsssdr_get_index(impl_names, n_impls, align ? found->impl_a : found->impl_u);
+        }
+
+    //past the sized choices, the choice for any size
+    *max_points = UINT_MAX;
+    return volk_gnsssdr_rank_archs(kern_name, impl_names, impl_deps, alignment, n_impls, align);
+}
@@ -26,6 +26,10 @@
 extern "C" {
 #endif
 
+// Number of num_points ranges each kernel with a num_points argument can
+// choose a different implementation for (see volk_gnsssdr_rank_archs_sized)
+#define VOLK_GNSSSDR_SIZE_BUCKETS 4
+
 int volk_gnsssdr_get_index(
     const char *impl_names[], //list of implementations by name
     const size_t n_impls,     //number of implementations available
@@ -41,6 +45,23 @@ int volk_gnsssdr_rank_archs(
     const bool align          //if false, filter aligned implementations
 );
 
+/*
+ * Ranks the implementations for the calls in a range of num_points: the
+ * profile lines of the kernel with a max_points, from the smallest one, are
+ * the buckets 0, 1, ..., and the bucket past them is the choice for any size.
+ * max_points is set to the largest num_points of the bucket (UINT_MAX for any).
+ */
+int volk_gnsssdr_rank_archs_sized(
+    const char *kern_name,    //name of the kernel to rank
+    const char *impl_names[], //list of implementations by name
+    const int* impl_deps,     //requirement mask per implementation
+    const bool* alignment,    //alignment status of each implementation
+    size_t n_impls,           //number of implementations available
+    const bool align,         //if false, filter aligned implementations
+    size_t bucket,            //size bucket, from the smallest sizes
+    unsigned int *max_points  //largest num_points of the bucket
+);
+
 #ifdef __cplusplus
 }
 #endif
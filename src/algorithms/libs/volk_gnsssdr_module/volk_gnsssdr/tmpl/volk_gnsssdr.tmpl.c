@@ -116,8 +116,31 @@ bool volk_gnsssdr_is_aligned(const void *ptr)
 #include <volk_gnsssdr/$(kern.name).h> //pulls in the dispatcher
 #end if
 
+## the kernels with a num_points argument can choose an implementation per size bucket
+#set $size_arg = ''
+#for $arg_type, $arg_name in $kern.args
+#if $arg_name == 'num_points' and not $kern.has_dispatcher
+#set $size_arg = $arg_name
+#end if
+#end for
+#if $size_arg
+static unsigned int __$(kern.name)_max_points[VOLK_GNSSSDR_SIZE_BUCKETS - 1];
+static $kern.pname __$(kern.name)_bucket_a[VOLK_GNSSSDR_SIZE_BUCKETS];
+static $kern.pname __$(kern.name)_bucket_u[VOLK_GNSSSDR_SIZE_BUCKETS];
+#end if
+
 static inline void __$(kern.name)_d($kern.arglist_full)
 {
+    #if $size_arg
+    // size bucket of the call, without branches: the buckets past the profiled sizes end at UINT_MAX
+    unsigned int bucket = 0;
+    unsigned int b;
+    for (b = 0; b < VOLK_GNSSSDR_SIZE_BUCKETS - 1; b++)
+        {
+            bucket += ((unsigned int)$size_arg > __$(kern.name)_max_points[b]);
+        }
+    #end if
+
     #if $kern.has_dispatcher
     $(kern.name)_dispatcher($kern.arglist_names);
     return;
@@ -133,10 +156,18 @@ static inline void __$(kern.name)_d($kern.arglist_full)
     #end for
         0$(')'*$num_open_parens)
     )){
+        #if $size_arg
+        __$(kern.name)_bucket_a[bucket]($kern.arglist_names);
+        #else
         $(kern.name)_a($kern.arglist_names);
+        #end if
     }
     else{
+        #if $size_arg
+        __$(kern.name)_bucket_u[bucket]($kern.arglist_names);
+        #else
         $(kern.name)_u($kern.arglist_names);
+        #end if
     }
 }
 
@@ -149,12 +180,30 @@ static inline void __init_$(kern.name)(void)
     const size_t n_impls = get_machine()->$(kern.name)_n_impls;
     const size_t index_a = volk_gnsssdr_rank_archs(name, impl_names, impl_deps, alignment, n_impls, true/*aligned*/);
     const size_t index_u = volk_gnsssdr_rank_archs(name, impl_names, impl_deps, alignment, n_impls, false/*unaligned*/);
+    #if $size_arg
+    size_t bucket;
+    #end if
     $(kern.name)_a = get_machine()->$(kern.name)_impls[index_a];
     $(kern.name)_u = get_machine()->$(kern.name)_impls[index_u];
 
     assert($(kern.name)_a);
     assert($(kern.name)_u);
 
+    #if $size_arg
+    for (bucket = 0; bucket < VOLK_GNSSSDR_SIZE_BUCKETS - 1; bucket++)
+        {
+            const size_t bucket_index_a = volk_gnsssdr_rank_archs_sized(name, impl_names, impl_deps, alignment, n_impls, true/*aligned*/,
+                    bucket, &__$(kern.name)_max_points[bucket]);
+            const size_t bucket_index_u = volk_gnsssdr_rank_archs_sized(name, impl_names, impl_deps, alignment, n_impls, false/*unaligned*/,
+                    bucket, &__$(kern.name)_max_points[bucket]);
+            __$(kern.name)_bucket_a[bucket] = get_machine()->$(kern.name)_impls[bucket_index_a];
+            __$(kern.name)_bucket_u[bucket] = get_machine()->$(kern.name)_impls[bucket_index_u];
+        }
+    // the last bucket is the choice for any size
+    __$(kern.name)_bucket_a[VOLK_GNSSSDR_SIZE_BUCKETS - 1] = $(kern.name)_a;
+    __$(kern.name)_bucket_u[VOLK_GNSSSDR_SIZE_BUCKETS - 1] = $(kern.name)_u;
+    #end if
+
     $(kern.name) = &__$(kern.name)_d;
 }
 
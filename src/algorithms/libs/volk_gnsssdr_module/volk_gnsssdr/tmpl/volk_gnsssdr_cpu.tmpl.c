@@ -115,6 +115,14 @@ static inline unsigned int get_avx2_enabled(void) {
 #endif
 }
 
+static inline unsigned int get_avx512f_enabled(void) {
+#if defined(VOLK_CPU_x86)
+    return (__xgetbv() & 0xE6) == 0xE6; // XMM, YMM, opmask and both halves of the ZMM state
+#else
+    return 0;
+#endif
+}
+
 //neon detection is linux specific
 #if defined(__arm__) && defined(__linux__)
     #include <asm/hwcap.h>
@@ -45,14 +45,15 @@ GalileoE1Observables::GalileoE1Observables(ConfigurationInterface* configuration
                     out_streams_(out_streams)
 {
     int output_rate_ms;
-    output_rate_ms = configuration->property(role + ".output_rate_ms", 500);
+    output_rate_ms = configuration->property(role + ".output_rate_ms", configuration->property("PVT.output_rate_ms", 500));
     std::string default_dump_filename = "./observables.dat";
     DLOG(INFO) << "role " << role;
     bool flag_averaging;
     flag_averaging = configuration->property(role + ".flag_averaging", false);
+    bool decimate = configuration->property(role + ".decimate", false);
     dump_ = configuration->property(role + ".dump", false);
     dump_filename_ = configuration->property(role + ".dump_filename", default_dump_filename);
-    observables_ = galileo_e1_make_observables_cc(in_streams_, dump_, dump_filename_, output_rate_ms, flag_averaging);
+    observables_ = galileo_e1_make_observables_cc(in_streams_, dump_, dump_filename_, output_rate_ms, flag_averaging, decimate);
     DLOG(INFO) << "pseudorange(" << observables_->unique_id() << ")";
 }
 
@@ -34,10 +34,7 @@
 #include <algorithm>
 #include <cmath>
 #include <iostream>
-#include <map>
-#include <utility>
 #include <vector>
-#include <armadillo>
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
 #include "gnss_synchro.h"
@@ -48,17 +45,32 @@
 
 using google::LogMessage;
 
+namespace
+{
+Dump_Schema observables_dump_schema(unsigned int nchannels)
+{
+    Dump_Schema schema("galileo_e1_observables");
+    schema.add<double>("TOW_at_current_symbol_s", nchannels)
+          .add<double>("Prn_timestamp_ms", nchannels)
+          .add<double>("Pseudorange_m", nchannels)
+          .add<double>("Flag_valid_pseudorange", nchannels)
+          .add<double>("PRN", nchannels);
+    return schema;
+}
+}
+
 
 galileo_e1_observables_cc_sptr
-galileo_e1_make_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging)
+galileo_e1_make_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging, bool decimate)
 {
-    return galileo_e1_observables_cc_sptr(new galileo_e1_observables_cc(nchannels, dump, dump_filename, output_rate_ms, flag_averaging));
+    return galileo_e1_observables_cc_sptr(new galileo_e1_observables_cc(nchannels, dump, dump_filename, output_rate_ms, flag_averaging, decimate));
 }
 
 
-galileo_e1_observables_cc::galileo_e1_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging) :
+galileo_e1_observables_cc::galileo_e1_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging, bool decimate) :
      gr::block("galileo_e1_observables_cc", gr::io_signature::make(nchannels, nchannels, sizeof(Gnss_Synchro)),
-     gr::io_signature::make(nchannels, nchannels, sizeof(Gnss_Synchro)))
+     gr::io_signature::make(nchannels, nchannels, sizeof(Gnss_Synchro))),
+     d_history(nchannels, GALILEO_E1_HISTORY_DEEP)
 {
     // initialize internal vars
     d_dump = dump;
@@ -66,29 +78,26 @@ galileo_e1_observables_cc::galileo_e1_observables_cc(unsigned int nchannels, boo
     d_output_rate_ms = output_rate_ms;
     d_dump_filename = dump_filename;
     d_flag_averaging = flag_averaging;
-
-    for (unsigned int i = 0; i < d_nchannels; i++)
+    d_decimate = decimate;
+    if (d_output_rate_ms < 1)
         {
-            d_acc_carrier_phase_queue_rads.push_back(std::deque<double>(d_nchannels));
-            d_carrier_doppler_queue_hz.push_back(std::deque<double>(d_nchannels));
-            d_symbol_TOW_queue_s.push_back(std::deque<double>(d_nchannels));
+            d_output_rate_ms = 1;
         }
+    d_sample_counter = 0;
 
     // ############# ENABLE DATA FILE LOG #################
     if (d_dump == true)
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit );
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    if (d_dump_file.open(d_dump_filename, observables_dump_schema(d_nchannels)))
+                        {
                             LOG(INFO) << "Observables dump enabled Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (const std::ifstream::failure & e)
-                    {
-                            LOG(WARNING) << "Exception opening observables dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "Cannot open observables dump file " << d_dump_filename;
+                        }
                 }
         }
 }
@@ -102,20 +111,6 @@ galileo_e1_observables_cc::~galileo_e1_observables_cc()
 
 
 
-bool Galileo_pairCompare_gnss_synchro_Prn_delay_ms(const std::pair<int,Gnss_Synchro>& a, const std::pair<int,Gnss_Synchro>& b)
-{
-    return (a.second.Prn_timestamp_ms) < (b.second.Prn_timestamp_ms);
-}
-
-
-
-bool Galileo_pairCompare_gnss_synchro_d_TOW_at_current_symbol(const std::pair<int,Gnss_Synchro>& a, const std::pair<int,Gnss_Synchro>& b)
-{
-    return (a.second.d_TOW_at_current_symbol) < (b.second.d_TOW_at_current_symbol);
-}
-
-
-
 int galileo_e1_observables_cc::general_work (int noutput_items, gr_vector_int &ninput_items,
         gr_vector_const_void_star &input_items,    gr_vector_void_star &output_items)
 {
@@ -123,8 +118,10 @@ int galileo_e1_observables_cc::general_work (int noutput_items, gr_vector_int &n
     Gnss_Synchro **out = (Gnss_Synchro **)  &output_items[0]; // Get the output pointer
 
     Gnss_Synchro current_gnss_synchro[d_nchannels];
-    std::map<int,Gnss_Synchro> current_gnss_synchro_map;
-    std::map<int,Gnss_Synchro>::iterator gnss_synchro_iter;
+    d_sample_counter++;
+    // in decimated mode, the pseudoranges are only formed on the PVT output epochs
+    bool output_epoch = !d_decimate or (d_sample_counter % d_output_rate_ms) == 0;
+
     if (d_nchannels != ninput_items.size())
         {
             LOG(WARNING) << "The Observables block is not well connected";
@@ -133,6 +130,7 @@ int galileo_e1_observables_cc::general_work (int noutput_items, gr_vector_int &n
     /*
      * 1. Read the GNSS SYNCHRO objects from available channels
      */
+    d_valid_channels.clear();
     for (unsigned int i = 0; i < d_nchannels; i++)
         {
             //Copy the telemetry decoder data to local copy
@@ -142,103 +140,68 @@ int galileo_e1_observables_cc::general_work (int noutput_items, gr_vector_int &n
              */
             current_gnss_synchro[i].Flag_valid_pseudorange = false;
             current_gnss_synchro[i].Pseudorange_m = 0.0;
-
             if (current_gnss_synchro[i].Flag_valid_word) //if this channel have valid word
                 {
-                    //record the word structure in a map for pseudorange computation
-                    current_gnss_synchro_map.insert(std::pair<int, Gnss_Synchro>(current_gnss_synchro[i].Channel_ID, current_gnss_synchro[i]));
+                    //record the channel for pseudorange computation
+                    d_valid_channels.push_back(i);
 
                     //################### SAVE DOPPLER AND ACC CARRIER PHASE HISTORIC DATA FOR INTERPOLATION IN OBSERVABLE MODULE #######
-                    d_carrier_doppler_queue_hz[i].push_back(current_gnss_synchro[i].Carrier_Doppler_hz);
-                    d_acc_carrier_phase_queue_rads[i].push_back(current_gnss_synchro[i].Carrier_phase_rads);
-                    // save TOW history
-                    d_symbol_TOW_queue_s[i].push_back(current_gnss_synchro[i].d_TOW_at_current_symbol);
-
-                    if (d_carrier_doppler_queue_hz[i].size() > GALILEO_E1_HISTORY_DEEP)
-                        {
-                            d_carrier_doppler_queue_hz[i].pop_front();
-                        }
-                    if (d_acc_carrier_phase_queue_rads[i].size() > GALILEO_E1_HISTORY_DEEP)
-                        {
-                            d_acc_carrier_phase_queue_rads[i].pop_front();
-                        }
-                    if (d_symbol_TOW_queue_s[i].size() > GALILEO_E1_HISTORY_DEEP)
-                        {
-                            d_symbol_TOW_queue_s[i].pop_front();
-                        }
+                    d_history.push_back(i, current_gnss_synchro[i].d_TOW_at_current_symbol,
+                            current_gnss_synchro[i].Carrier_phase_rads,
+                            current_gnss_synchro[i].Carrier_Doppler_hz);
                 }
             else
                 {
                     // Clear the observables history for this channel
-                    if (d_symbol_TOW_queue_s[i].size() > 0)
-                        {
-                            d_symbol_TOW_queue_s[i].clear();
-                            d_carrier_doppler_queue_hz[i].clear();
-                            d_acc_carrier_phase_queue_rads[i].clear();
-                        }
+                    d_history.clear(i);
                 }
         }
 
     /*
      * 2. Compute RAW pseudoranges using COMMON RECEPTION TIME algorithm. Use only the valid channels (channels that are tracking a satellite)
      */
-    if(current_gnss_synchro_map.size() > 0)
+    if(output_epoch and d_valid_channels.size() > 0)
         {
             /*
              *  2.1 Use CURRENT set of measurements and find the nearest satellite
              *  common RX time algorithm
              */
             // what is the most recent symbol TOW in the current set? -> this will be the reference symbol
-            gnss_synchro_iter = max_element(current_gnss_synchro_map.begin(), current_gnss_synchro_map.end(), Galileo_pairCompare_gnss_synchro_d_TOW_at_current_symbol);
-            double d_TOW_reference = gnss_synchro_iter->second.d_TOW_at_current_symbol;
-            double d_ref_PRN_rx_time_ms = gnss_synchro_iter->second.Prn_timestamp_ms;
-            //int reference_channel= gnss_synchro_iter->second.Channel_ID;
+            unsigned int reference_channel = d_valid_channels[0];
+            for (unsigned int n = 1; n < d_valid_channels.size(); n++)
+                {
+                    if (current_gnss_synchro[d_valid_channels[n]].d_TOW_at_current_symbol > current_gnss_synchro[reference_channel].d_TOW_at_current_symbol)
+                        {
+                            reference_channel = d_valid_channels[n];
+                        }
+                }
+            double d_TOW_reference = current_gnss_synchro[reference_channel].d_TOW_at_current_symbol;
+            double d_ref_PRN_rx_time_ms = current_gnss_synchro[reference_channel].Prn_timestamp_ms;
 
             // Now compute RX time differences due to the PRN alignment in the correlators
             double traveltime_ms;
             double pseudorange_m;
             double delta_rx_time_ms;
-            arma::vec symbol_TOW_vec_s;
-            arma::vec dopper_vec_hz;
-            arma::vec dopper_vec_interp_hz;
-            arma::vec acc_phase_vec_rads;
-            arma::vec acc_phase_vec_interp_rads;
-            arma::vec desired_symbol_TOW(1);
-            for(gnss_synchro_iter = current_gnss_synchro_map.begin(); gnss_synchro_iter != current_gnss_synchro_map.end(); gnss_synchro_iter++)
+            for (unsigned int n = 0; n < d_valid_channels.size(); n++)
                 {
+                    unsigned int i = d_valid_channels[n];
                     // compute the required symbol history shift in order to match the reference symbol
-                    delta_rx_time_ms = gnss_synchro_iter->second.Prn_timestamp_ms - d_ref_PRN_rx_time_ms;
+                    delta_rx_time_ms = current_gnss_synchro[i].Prn_timestamp_ms - d_ref_PRN_rx_time_ms;
                     //compute the pseudorange
-                    traveltime_ms = (d_TOW_reference-gnss_synchro_iter->second.d_TOW_at_current_symbol) * 1000.0 + delta_rx_time_ms + GALILEO_STARTOFFSET_ms;
+                    traveltime_ms = (d_TOW_reference - current_gnss_synchro[i].d_TOW_at_current_symbol) * 1000.0 + delta_rx_time_ms + GALILEO_STARTOFFSET_ms;
                     pseudorange_m = traveltime_ms * GALILEO_C_m_ms; // [m]
                     // update the pseudorange object
-                    current_gnss_synchro[gnss_synchro_iter->second.Channel_ID] = gnss_synchro_iter->second;
-                    current_gnss_synchro[gnss_synchro_iter->second.Channel_ID].Pseudorange_m = pseudorange_m;
-                    current_gnss_synchro[gnss_synchro_iter->second.Channel_ID].Flag_valid_pseudorange = true;
-                    current_gnss_synchro[gnss_synchro_iter->second.Channel_ID].d_TOW_at_current_symbol = round(d_TOW_reference * 1000.0) / 1000.0 + GALILEO_STARTOFFSET_ms / 1000.0;
+                    current_gnss_synchro[i].Pseudorange_m = pseudorange_m;
+                    current_gnss_synchro[i].Flag_valid_pseudorange = true;
+                    current_gnss_synchro[i].d_TOW_at_current_symbol = round(d_TOW_reference * 1000.0) / 1000.0 + GALILEO_STARTOFFSET_ms / 1000.0;
 
-                    if (d_symbol_TOW_queue_s[gnss_synchro_iter->second.Channel_ID].size() >= GALILEO_E1_HISTORY_DEEP)
+                    if (d_history.full(i))
                         {
-                            // compute interpolated observation values for Doppler and Accumulate carrier phase
-                            symbol_TOW_vec_s = arma::vec(std::vector<double>(d_symbol_TOW_queue_s[gnss_synchro_iter->second.Channel_ID].begin(), d_symbol_TOW_queue_s[gnss_synchro_iter->second.Channel_ID].end()));
-                            acc_phase_vec_rads = arma::vec(std::vector<double>(d_acc_carrier_phase_queue_rads[gnss_synchro_iter->second.Channel_ID].begin(), d_acc_carrier_phase_queue_rads[gnss_synchro_iter->second.Channel_ID].end()));
-                            dopper_vec_hz = arma::vec(std::vector<double>(d_carrier_doppler_queue_hz[gnss_synchro_iter->second.Channel_ID].begin(), d_carrier_doppler_queue_hz[gnss_synchro_iter->second.Channel_ID].end()));
-                            desired_symbol_TOW[0] = symbol_TOW_vec_s[GALILEO_E1_HISTORY_DEEP - 1] + delta_rx_time_ms / 1000.0;
-                            // Curve fitting to cuadratic function
-                            arma::mat A = arma::ones<arma::mat>(GALILEO_E1_HISTORY_DEEP, 2);
-                            A.col(1) = symbol_TOW_vec_s;
-                            //A.col(2)=symbol_TOW_vec_s % symbol_TOW_vec_s;
-                            arma::mat coef_acc_phase(1,3);
-                            arma::mat pinv_A = arma::pinv(A.t() * A) * A.t();
-                            coef_acc_phase = pinv_A * acc_phase_vec_rads;
-                            arma::mat coef_doppler(1,3);
-                            coef_doppler = pinv_A * dopper_vec_hz;
-                            arma::vec acc_phase_lin;
-                            arma::vec carrier_doppler_lin;
-                            acc_phase_lin = coef_acc_phase[0] + coef_acc_phase[1] * desired_symbol_TOW[0];//+coef_acc_phase[2]*desired_symbol_TOW[0]*desired_symbol_TOW[0];
-                            carrier_doppler_lin = coef_doppler[0] + coef_doppler[1] * desired_symbol_TOW[0];//+coef_doppler[2]*desired_symbol_TOW[0]*desired_symbol_TOW[0];
-                            current_gnss_synchro[gnss_synchro_iter->second.Channel_ID].Carrier_phase_rads = acc_phase_lin[0];
-                            current_gnss_synchro[gnss_synchro_iter->second.Channel_ID].Carrier_Doppler_hz = carrier_doppler_lin[0];
+                            // least squares line through the Doppler and accumulated carrier phase history,
+                            // evaluated at the reference reception time
+                            d_history.linear_fit(i, delta_rx_time_ms / 1000.0,
+                                    current_gnss_synchro[i].Carrier_phase_rads,
+                                    current_gnss_synchro[i].Carrier_Doppler_hz);
                         }
                 }
         }
@@ -246,27 +209,27 @@ int galileo_e1_observables_cc::general_work (int noutput_items, gr_vector_int &n
     if(d_dump == true)
         {
             // MULTIPLEXED FILE RECORDING - Record results to file
-            try
-            {
-                    double tmp_double;
-                    for (unsigned int i = 0; i < d_nchannels ; i++)
-                        {
-                            tmp_double = current_gnss_synchro[i].d_TOW_at_current_symbol;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = current_gnss_synchro[i].Prn_timestamp_ms;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = current_gnss_synchro[i].Pseudorange_m;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = (double)(current_gnss_synchro[i].Flag_valid_pseudorange==true);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = current_gnss_synchro[i].PRN;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                        }
-            }
-            catch (const std::ifstream::failure& e)
-            {
-                    LOG(WARNING) << "Exception writing observables dump file " << e.what();
-            }
+            // each field holds the values of all the channels
+            for (unsigned int i = 0; i < d_nchannels; i++)
+                {
+                    d_dump_file.put<double>(current_gnss_synchro[i].d_TOW_at_current_symbol);
+                }
+            for (unsigned int i = 0; i < d_nchannels; i++)
+                {
+                    d_dump_file.put<double>(current_gnss_synchro[i].Prn_timestamp_ms);
+                }
+            for (unsigned int i = 0; i < d_nchannels; i++)
+                {
+                    d_dump_file.put<double>(current_gnss_synchro[i].Pseudorange_m);
+                }
+            for (unsigned int i = 0; i < d_nchannels; i++)
+                {
+                    d_dump_file.put<double>(current_gnss_synchro[i].Flag_valid_pseudorange==true);
+                }
+            for (unsigned int i = 0; i < d_nchannels; i++)
+                {
+                    d_dump_file.put<double>(current_gnss_synchro[i].PRN);
+                }
         }
 
     consume_each(1); //one by one
@@ -36,7 +36,10 @@
 
 #include <fstream>
 #include <string>
+#include <vector>
 #include <gnuradio/block.h>
+#include "observables_history.h"
+#include "dump_writer.h"
 
 
 class galileo_e1_observables_cc;
@@ -44,7 +47,7 @@ class galileo_e1_observables_cc;
 typedef boost::shared_ptr<galileo_e1_observables_cc> galileo_e1_observables_cc_sptr;
 
 galileo_e1_observables_cc_sptr
-galileo_e1_make_observables_cc(unsigned int n_channels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging);
+galileo_e1_make_observables_cc(unsigned int n_channels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging, bool decimate);
 
 /*!
  * \brief This class implements a block that computes Galileo observables
@@ -59,21 +62,22 @@ public:
 
 private:
     friend galileo_e1_observables_cc_sptr
-    galileo_e1_make_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging);
-    galileo_e1_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging);
+    galileo_e1_make_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging, bool decimate);
+    galileo_e1_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging, bool decimate);
 
     //Tracking observable history
-    std::vector<std::deque<double>> d_acc_carrier_phase_queue_rads;
-    std::vector<std::deque<double>> d_carrier_doppler_queue_hz;
-    std::vector<std::deque<double>> d_symbol_TOW_queue_s;
+    Observables_History d_history;
+    std::vector<unsigned int> d_valid_channels;
 
     // class private vars
     bool d_dump;
     bool d_flag_averaging;
+    bool d_decimate;
+    unsigned long int d_sample_counter;
     unsigned int d_nchannels;
     int d_output_rate_ms;
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
 };
 
 #endif
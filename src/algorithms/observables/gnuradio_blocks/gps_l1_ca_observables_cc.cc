@@ -31,31 +31,45 @@
 #include <algorithm>
 #include <cmath>
 #include <iostream>
-#include <map>
 #include <vector>
-#include <utility>
-#include <armadillo>
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
 #include "control_message_factory.h"
 #include "gnss_synchro.h"
 #include "GPS_L1_CA.h"
+#include "latency_trace.h"
+#include "observables_extrapolation.h"
 
 
 
 using google::LogMessage;
 
+namespace
+{
+Dump_Schema observables_dump_schema(unsigned int nchannels)
+{
+    Dump_Schema schema("gps_l1_ca_observables");
+    schema.add<double>("TOW_at_current_symbol_s", nchannels)
+          .add<double>("Carrier_Doppler_hz", nchannels)
+          .add<double>("Carrier_phase_cycles", nchannels)
+          .add<double>("Pseudorange_m", nchannels)
+          .add<double>("PRN", nchannels);
+    return schema;
+}
+}
+
 
 gps_l1_ca_observables_cc_sptr
-gps_l1_ca_make_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging)
+gps_l1_ca_make_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging, bool decimate)
 {
-    return gps_l1_ca_observables_cc_sptr(new gps_l1_ca_observables_cc(nchannels, dump, dump_filename, output_rate_ms, flag_averaging));
+    return gps_l1_ca_observables_cc_sptr(new gps_l1_ca_observables_cc(nchannels, dump, dump_filename, output_rate_ms, flag_averaging, decimate));
 }
 
 
-gps_l1_ca_observables_cc::gps_l1_ca_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging) :
+gps_l1_ca_observables_cc::gps_l1_ca_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging, bool decimate) :
                                 gr::block("gps_l1_ca_observables_cc", gr::io_signature::make(nchannels, nchannels, sizeof(Gnss_Synchro)),
-                                gr::io_signature::make(nchannels, nchannels, sizeof(Gnss_Synchro)))
+                                gr::io_signature::make(nchannels, nchannels, sizeof(Gnss_Synchro))),
+                                d_history(nchannels, GPS_L1_CA_HISTORY_DEEP)
 {
     // initialize internal vars
     d_dump = dump;
@@ -63,29 +77,29 @@ gps_l1_ca_observables_cc::gps_l1_ca_observables_cc(unsigned int nchannels, bool
     d_output_rate_ms = output_rate_ms;
     d_dump_filename = dump_filename;
     d_flag_averaging = flag_averaging;
-
-    for (unsigned int i = 0; i < d_nchannels; i++)
+    d_decimate = decimate;
+    d_low_latency = false;
+    d_batch_epochs = 1;
+    if (d_output_rate_ms < 1)
         {
-            d_acc_carrier_phase_queue_rads.push_back(std::deque<double>(d_nchannels));
-            d_carrier_doppler_queue_hz.push_back(std::deque<double>(d_nchannels));
-            d_symbol_TOW_queue_s.push_back(std::deque<double>(d_nchannels));
+            d_output_rate_ms = 1;
         }
+    d_sample_counter = 0;
+    d_metrics = make_block_metrics("observables", "gps_l1_ca");
 
     // ############# ENABLE DATA FILE LOG #################
     if (d_dump == true)
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit );
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    if (d_dump_file.open(d_dump_filename, observables_dump_schema(d_nchannels)))
+                        {
                             LOG(INFO) << "Observables dump enabled Log file: " << d_dump_filename.c_str() << std::endl;
-                    }
-                    catch (const std::ifstream::failure & e)
-                    {
-                            LOG(WARNING) << "Exception opening observables dump file " << e.what() << std::endl;
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "Cannot open observables dump file " << d_dump_filename;
+                        }
                 }
         }
 }
@@ -98,192 +112,159 @@ gps_l1_ca_observables_cc::~gps_l1_ca_observables_cc()
 }
 
 
-bool pairCompare_gnss_synchro_Prn_delay_ms(const std::pair<int,Gnss_Synchro>& a, const std::pair<int,Gnss_Synchro>& b)
-{
-    return (a.second.Prn_timestamp_ms) < (b.second.Prn_timestamp_ms);
-}
-
-
-bool pairCompare_gnss_synchro_d_TOW_at_current_symbol(const std::pair<int,Gnss_Synchro>& a, const std::pair<int,Gnss_Synchro>& b)
-{
-    return (a.second.d_TOW_at_current_symbol) < (b.second.d_TOW_at_current_symbol);
-}
-
-
 int gps_l1_ca_observables_cc::general_work (int noutput_items, gr_vector_int &ninput_items,
         gr_vector_const_void_star &input_items,    gr_vector_void_star &output_items)
 {
+    Block_Metrics_Scope metrics_scope(d_metrics.get(), ninput_items.empty() ? 0 : ninput_items[0]);
     Gnss_Synchro **in = (Gnss_Synchro **)  &input_items[0];   // Get the input pointer
     Gnss_Synchro **out = (Gnss_Synchro **)  &output_items[0]; // Get the output pointer
 
-    Gnss_Synchro current_gnss_synchro[d_nchannels];
-    std::map<int,Gnss_Synchro> current_gnss_synchro_map;
-    std::map<int,Gnss_Synchro>::iterator gnss_synchro_iter;
-    
     if (d_nchannels != ninput_items.size())
         {
             LOG(WARNING) << "The Observables block is not well connected";
         }
 
-    /*
-     * 1. Read the GNSS SYNCHRO objects from available channels
-     */
+    // all the epochs that every channel has delivered, in whole batches
+    int epochs = noutput_items;
     for (unsigned int i = 0; i < d_nchannels; i++)
         {
-            //Copy the telemetry decoder data to local copy
-            current_gnss_synchro[i] = in[i][0];
+            epochs = std::min(epochs, ninput_items[i]);
+        }
+    epochs -= epochs % d_batch_epochs;
+
+    for (int epoch = 0; epoch < epochs; epoch++)
+        {
+            Gnss_Synchro current_gnss_synchro[d_nchannels];
+            d_sample_counter++;
+            // in decimated mode, the pseudoranges are only formed on the PVT output epochs
+            bool output_epoch = !d_decimate or (d_sample_counter % d_output_rate_ms) == 0;
+            // in low latency mode, the other epochs are extrapolated to their newest sample
+            bool extrapolated_epoch = d_low_latency and (d_sample_counter % d_output_rate_ms) != 0;
+
             /*
-             * 1.2 Assume no valid pseudoranges
+             * 1. Read the GNSS SYNCHRO objects from available channels
              */
-            current_gnss_synchro[i].Flag_valid_pseudorange = false;
-            current_gnss_synchro[i].Pseudorange_m = 0.0;
-            if (current_gnss_synchro[i].Flag_valid_word) //if this channel have valid word
+            d_valid_channels.clear();
+            for (unsigned int i = 0; i < d_nchannels; i++)
                 {
-                    //record the word structure in a map for pseudorange computation
-                    current_gnss_synchro_map.insert(std::pair<int, Gnss_Synchro>(current_gnss_synchro[i].Channel_ID, current_gnss_synchro[i]));
-
-                    //################### SAVE DOPPLER AND ACC CARRIER PHASE HISTORIC DATA FOR INTERPOLATION IN OBSERVABLE MODULE #######
-                    d_carrier_doppler_queue_hz[i].push_back(current_gnss_synchro[i].Carrier_Doppler_hz);
-                    d_acc_carrier_phase_queue_rads[i].push_back(current_gnss_synchro[i].Carrier_phase_rads);
-                    // save TOW history
-                    d_symbol_TOW_queue_s[i].push_back(current_gnss_synchro[i].d_TOW_at_current_symbol);
-
-                    if (d_carrier_doppler_queue_hz[i].size() > GPS_L1_CA_HISTORY_DEEP)
-                        {
-                            d_carrier_doppler_queue_hz[i].pop_front();
-                        }
-                    if (d_acc_carrier_phase_queue_rads[i].size() > GPS_L1_CA_HISTORY_DEEP)
+                    //Copy the telemetry decoder data to local copy
+                    current_gnss_synchro[i] = in[i][epoch];
+                    /*
+                     * 1.2 Assume no valid pseudoranges
+                     */
+                    current_gnss_synchro[i].Flag_valid_pseudorange = false;
+                    current_gnss_synchro[i].Pseudorange_m = 0.0;
+                    if (current_gnss_synchro[i].Flag_valid_word) //if this channel have valid word
                         {
-                            d_acc_carrier_phase_queue_rads[i].pop_front();
-                        }
-                    if (d_symbol_TOW_queue_s[i].size() > GPS_L1_CA_HISTORY_DEEP)
-                        {
-                            d_symbol_TOW_queue_s[i].pop_front();
+                            //record the channel for pseudorange computation
+                            d_valid_channels.push_back(i);
+
+                            //################### SAVE DOPPLER AND ACC CARRIER PHASE HISTORIC DATA FOR INTERPOLATION IN OBSERVABLE MODULE #######
+                            d_history.push_back(i, current_gnss_synchro[i].d_TOW_at_current_symbol,
+                                    current_gnss_synchro[i].Carrier_phase_rads,
+                                    current_gnss_synchro[i].Carrier_Doppler_hz);
                         }
-                }
-            else
-                {
-                    // Clear the observables history for this channel
-                    if (d_symbol_TOW_queue_s[i].size() > 0)
+                    else
                         {
-                            d_symbol_TOW_queue_s[i].clear();
-                            d_carrier_doppler_queue_hz[i].clear();
-                            d_acc_carrier_phase_queue_rads[i].clear();
+                            // Clear the observables history for this channel
+                            d_history.clear(i);
                         }
                 }
-        }
 
-    /*
-     * 2. Compute RAW pseudoranges using COMMON RECEPTION TIME algorithm. Use only the valid channels (channels that are tracking a satellite)
-     */
-    if(current_gnss_synchro_map.size() > 0)
-        {
             /*
-             *  2.1 Use CURRENT set of measurements and find the nearest satellite
-             *  common RX time algorithm
+             * 2. Compute RAW pseudoranges using COMMON RECEPTION TIME algorithm. Use only the valid channels (channels that are tracking a satellite)
              */
-            // what is the most recent symbol TOW in the current set? -> this will be the reference symbol
-            gnss_synchro_iter = max_element(current_gnss_synchro_map.begin(), current_gnss_synchro_map.end(), pairCompare_gnss_synchro_d_TOW_at_current_symbol);
-            double d_TOW_reference = gnss_synchro_iter->second.d_TOW_at_current_symbol;
-            double d_ref_PRN_rx_time_ms = gnss_synchro_iter->second.Prn_timestamp_ms;
-            //int reference_channel= gnss_synchro_iter->second.Channel_ID;
-
-            // Now compute RX time differences due to the PRN alignment in the correlators
-            double traveltime_ms;
-            double pseudorange_m;
-            double delta_rx_time_ms;
-            arma::vec symbol_TOW_vec_s;
-            arma::vec dopper_vec_hz;
-            arma::vec dopper_vec_interp_hz;
-            arma::vec acc_phase_vec_rads;
-            arma::vec acc_phase_vec_interp_rads;
-            arma::vec desired_symbol_TOW(1);
-            for(gnss_synchro_iter = current_gnss_synchro_map.begin(); gnss_synchro_iter != current_gnss_synchro_map.end(); gnss_synchro_iter++)
+            if(extrapolated_epoch)
                 {
-                    // compute the required symbol history shift in order to match the reference symbol
-                    delta_rx_time_ms = gnss_synchro_iter->second.Prn_timestamp_ms - d_ref_PRN_rx_time_ms;
-                    //compute the pseudorange
-                    traveltime_ms = (d_TOW_reference-gnss_synchro_iter->second.d_TOW_at_current_symbol) * 1000.0 + delta_rx_time_ms + GPS_STARTOFFSET_ms;
-                    pseudorange_m = traveltime_ms * GPS_C_m_ms; // [m]
-                    // update the pseudorange object
-                    current_gnss_synchro[gnss_synchro_iter->second.Channel_ID] = gnss_synchro_iter->second;
-                    current_gnss_synchro[gnss_synchro_iter->second.Channel_ID].Pseudorange_m = pseudorange_m;
-                    current_gnss_synchro[gnss_synchro_iter->second.Channel_ID].Flag_valid_pseudorange = true;
-                    current_gnss_synchro[gnss_synchro_iter->second.Channel_ID].d_TOW_at_current_symbol = round(d_TOW_reference*1000.0)/1000.0 + GPS_STARTOFFSET_ms/1000.0;
-
-                    if (d_symbol_TOW_queue_s[gnss_synchro_iter->second.Channel_ID].size()>=GPS_L1_CA_HISTORY_DEEP)
+                    extrapolate_observables(current_gnss_synchro, d_valid_channels, &Gnss_Synchro::d_TOW_at_current_symbol, GPS_STARTOFFSET_ms);
+                }
+            else if(output_epoch and d_valid_channels.size() > 0)
+                {
+                    /*
+                     *  2.1 Use CURRENT set of measurements and find the nearest satellite
+                     *  common RX time algorithm
+                     */
+                    // what is the most recent symbol TOW in the current set? -> this will be the reference symbol
+                    unsigned int reference_channel = d_valid_channels[0];
+                    for (unsigned int n = 1; n < d_valid_channels.size(); n++)
                         {
-                            // compute interpolated observation values for Doppler and Accumulate carrier phase
-                            symbol_TOW_vec_s = arma::vec(std::vector<double>(d_symbol_TOW_queue_s[gnss_synchro_iter->second.Channel_ID].begin(), d_symbol_TOW_queue_s[gnss_synchro_iter->second.Channel_ID].end()));
-                            acc_phase_vec_rads = arma::vec(std::vector<double>(d_acc_carrier_phase_queue_rads[gnss_synchro_iter->second.Channel_ID].begin(), d_acc_carrier_phase_queue_rads[gnss_synchro_iter->second.Channel_ID].end()));
-                            dopper_vec_hz = arma::vec(std::vector<double>(d_carrier_doppler_queue_hz[gnss_synchro_iter->second.Channel_ID].begin(), d_carrier_doppler_queue_hz[gnss_synchro_iter->second.Channel_ID].end()));
-
-                            desired_symbol_TOW[0] = symbol_TOW_vec_s[GPS_L1_CA_HISTORY_DEEP - 1] + delta_rx_time_ms / 1000.0;
-                            //    arma::interp1(symbol_TOW_vec_s,dopper_vec_hz,desired_symbol_TOW,dopper_vec_interp_hz);
-                            //    arma::interp1(symbol_TOW_vec_s,acc_phase_vec_rads,desired_symbol_TOW,acc_phase_vec_interp_rads);
-
-                            // Curve fitting to cuadratic function
-                            arma::mat A = arma::ones<arma::mat> (GPS_L1_CA_HISTORY_DEEP, 2);
-                            A.col(1) = symbol_TOW_vec_s;
-
-                            arma::mat coef_acc_phase(1,3);
-                            arma::mat pinv_A = arma::pinv(A.t() * A) * A.t();
-                            coef_acc_phase = pinv_A * acc_phase_vec_rads;
-                            arma::mat coef_doppler(1,3);
-                            coef_doppler = pinv_A * dopper_vec_hz;
-                            arma::vec acc_phase_lin;
-                            arma::vec carrier_doppler_lin;
-                            acc_phase_lin = coef_acc_phase[0] + coef_acc_phase[1] * desired_symbol_TOW[0];   // +coef_acc_phase[2]*desired_symbol_TOW[0]*desired_symbol_TOW[0];
-                            carrier_doppler_lin = coef_doppler[0] + coef_doppler[1] * desired_symbol_TOW[0]; // +coef_doppler[2]*desired_symbol_TOW[0]*desired_symbol_TOW[0];
-                            //std::cout<<"acc_phase_vec_interp_rads="<<acc_phase_vec_interp_rads[0]<<std::endl;
-                            //std::cout<<"dopper_vec_interp_hz="<<dopper_vec_interp_hz[0]<<std::endl;
-                            current_gnss_synchro[gnss_synchro_iter->second.Channel_ID].Carrier_phase_rads = acc_phase_lin[0];
-                            current_gnss_synchro[gnss_synchro_iter->second.Channel_ID].Carrier_Doppler_hz = carrier_doppler_lin[0];
+                            if (current_gnss_synchro[d_valid_channels[n]].d_TOW_at_current_symbol > current_gnss_synchro[reference_channel].d_TOW_at_current_symbol)
+                                {
+                                    reference_channel = d_valid_channels[n];
+                                }
                         }
-
+                    double d_TOW_reference = current_gnss_synchro[reference_channel].d_TOW_at_current_symbol;
+                    double d_ref_PRN_rx_time_ms = current_gnss_synchro[reference_channel].Prn_timestamp_ms;
+
+                    // Now compute RX time differences due to the PRN alignment in the correlators
+                    double traveltime_ms;
+                    double pseudorange_m;
+                    double delta_rx_time_ms;
+                    for (unsigned int n = 0; n < d_valid_channels.size(); n++)
+                        {
+                            unsigned int i = d_valid_channels[n];
+                            // compute the required symbol history shift in order to match the reference symbol
+                            delta_rx_time_ms = current_gnss_synchro[i].Prn_timestamp_ms - d_ref_PRN_rx_time_ms;
+                            //compute the pseudorange
+                            traveltime_ms = (d_TOW_reference - current_gnss_synchro[i].d_TOW_at_current_symbol) * 1000.0 + delta_rx_time_ms + GPS_STARTOFFSET_ms;
+                            pseudorange_m = traveltime_ms * GPS_C_m_ms; // [m]
+                            // update the pseudorange object
+                            current_gnss_synchro[i].Pseudorange_m = pseudorange_m;
+                            current_gnss_synchro[i].Flag_valid_pseudorange = true;
+                            current_gnss_synchro[i].d_TOW_at_current_symbol = round(d_TOW_reference * 1000.0) / 1000.0 + GPS_STARTOFFSET_ms / 1000.0;
+
+                            if (d_history.full(i))
+                                {
+                                    // least squares line through the Doppler and accumulated carrier phase history,
+                                    // evaluated at the reference reception time
+                                    d_history.linear_fit(i, delta_rx_time_ms / 1000.0,
+                                            current_gnss_synchro[i].Carrier_phase_rads,
+                                            current_gnss_synchro[i].Carrier_Doppler_hz);
+                                }
+                        }
+                    LATENCY_TRACE(LATENCY_OBSERVABLES, -1, current_gnss_synchro[reference_channel].sample_counter);
                 }
-        }
 
-    if(d_dump == true)
-        {
-            // MULTIPLEXED FILE RECORDING - Record results to file
-            try
-            {
-                    double tmp_double;
+            if(d_dump == true)
+                {
+                    // MULTIPLEXED FILE RECORDING - Record results to file
+                    // each field holds the values of all the channels
                     for (unsigned int i = 0; i < d_nchannels; i++)
                         {
-                            tmp_double = current_gnss_synchro[i].d_TOW_at_current_symbol;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            //tmp_double = current_gnss_synchro[i].Prn_timestamp_ms;
-                            tmp_double = current_gnss_synchro[i].Carrier_Doppler_hz;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = current_gnss_synchro[i].Carrier_phase_rads/GPS_TWO_PI;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = current_gnss_synchro[i].Pseudorange_m;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            //tmp_double = (double)(current_gnss_synchro[i].Flag_valid_pseudorange==true);
-                            //tmp_double = current_gnss_synchro[i].debug_var1;
-                            //tmp_double = current_gnss_synchro[i].debug_var2;
-                            //d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = current_gnss_synchro[i].PRN;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
+                            d_dump_file.put<double>(current_gnss_synchro[i].d_TOW_at_current_symbol);
                         }
-            }
-            catch (const std::ifstream::failure& e)
-            {
-                    LOG(WARNING) << "Exception writing observables dump file " << e.what() << std::endl;
-            }
-        }
+                    for (unsigned int i = 0; i < d_nchannels; i++)
+                        {
+                            d_dump_file.put<double>(current_gnss_synchro[i].Carrier_Doppler_hz);
+                        }
+                    for (unsigned int i = 0; i < d_nchannels; i++)
+                        {
+                            d_dump_file.put<double>(current_gnss_synchro[i].Carrier_phase_rads/GPS_TWO_PI);
+                        }
+                    for (unsigned int i = 0; i < d_nchannels; i++)
+                        {
+                            d_dump_file.put<double>(current_gnss_synchro[i].Pseudorange_m);
+                        }
+                    for (unsigned int i = 0; i < d_nchannels; i++)
+                        {
+                            d_dump_file.put<double>(current_gnss_synchro[i].PRN);
+                        }
+                }
 
-    consume_each(1); //one by one
-    for (unsigned int i = 0; i < d_nchannels; i++)
-        {
-            *out[i] = current_gnss_synchro[i];
-        }
-    if (noutput_items == 0)
-        {
-            LOG(WARNING) << "noutput_items = 0";
+            for (unsigned int i = 0; i < d_nchannels; i++)
+                {
+                    out[i][epoch] = current_gnss_synchro[i];
+                }
         }
-    return 1;
+
+    metrics_scope.set_items(epochs);
+    consume_each(epochs);
+    return epochs;
 }
 
+
+void gps_l1_ca_observables_cc::set_batch(int epochs)
+{
+    d_batch_epochs = std::max(epochs, 1);
+    set_output_multiple(d_batch_epochs);
+}
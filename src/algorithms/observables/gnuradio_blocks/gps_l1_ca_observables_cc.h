@@ -31,12 +31,15 @@
 #ifndef GNSS_SDR_GPS_L1_CA_OBSERVABLES_CC_H
 #define GNSS_SDR_GPS_L1_CA_OBSERVABLES_CC_H
 
-#include <deque>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 #include <boost/shared_ptr.hpp>
 #include <gnuradio/block.h>
+#include "observables_history.h"
+#include "block_metrics.h"
+#include "dump_writer.h"
 
 
 class gps_l1_ca_observables_cc;
@@ -44,7 +47,7 @@ class gps_l1_ca_observables_cc;
 typedef boost::shared_ptr<gps_l1_ca_observables_cc> gps_l1_ca_observables_cc_sptr;
 
 gps_l1_ca_observables_cc_sptr
-gps_l1_ca_make_observables_cc(unsigned int n_channels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging);
+gps_l1_ca_make_observables_cc(unsigned int n_channels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging, bool decimate);
 
 /*!
  * \brief This class implements a block that computes GPS L1 C/A observables
@@ -57,24 +60,43 @@ public:
     int general_work (int noutput_items, gr_vector_int &ninput_items,
             gr_vector_const_void_star &input_items, gr_vector_void_star &output_items);
 
+    /*!
+     * \brief In low latency mode the pseudoranges are formed on every epoch,
+     * extrapolated to its newest sample (see observables_extrapolation.h)
+     * without the carrier history. The PVT output epochs, one in
+     * output_rate_ms, keep the aligned and smoothed pseudoranges that the
+     * RINEX files are written with.
+     */
+    void set_low_latency(bool enabled) { d_low_latency = enabled; }
+
+    /*!
+     * \brief Processes the epochs (ms) in batches of epochs, which the PVT
+     * then also gets together: fewer calls, and up to epochs ms of latency
+     */
+    void set_batch(int epochs);
+
 private:
     friend gps_l1_ca_observables_cc_sptr
-    gps_l1_ca_make_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging);
-    gps_l1_ca_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging);
+    gps_l1_ca_make_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging, bool decimate);
+    gps_l1_ca_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging, bool decimate);
 
 
     //Tracking observable history
-    std::vector<std::deque<double>> d_acc_carrier_phase_queue_rads;
-    std::vector<std::deque<double>> d_carrier_doppler_queue_hz;
-    std::vector<std::deque<double>> d_symbol_TOW_queue_s;
+    Observables_History d_history;
+    std::vector<unsigned int> d_valid_channels;
 
     // class private vars
     bool d_dump;
     bool d_flag_averaging;
+    bool d_decimate;
+    bool d_low_latency;
+    int d_batch_epochs;
+    unsigned long int d_sample_counter;
     unsigned int d_nchannels;
     int d_output_rate_ms;
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
+    std::shared_ptr<Block_Metrics> d_metrics;
 };
 
 #endif
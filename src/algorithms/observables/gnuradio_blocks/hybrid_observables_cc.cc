@@ -33,28 +33,42 @@
 #include <algorithm>
 #include <cmath>
 #include <iostream>
-#include <map>
-#include <utility>
 #include <vector>
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
 #include "gnss_synchro.h"
 #include "Galileo_E1.h"
 #include "GPS_L1_CA.h"
+#include "observables_extrapolation.h"
 
 
 
 using google::LogMessage;
 
+namespace
+{
+Dump_Schema observables_dump_schema(unsigned int nchannels)
+{
+    Dump_Schema schema("hybrid_observables");
+    schema.add<double>("TOW_at_current_symbol_s", nchannels)
+          .add<double>("TOW_hybrid_at_current_symbol_s", nchannels)
+          .add<double>("Prn_timestamp_ms", nchannels)
+          .add<double>("Pseudorange_m", nchannels)
+          .add<double>("Flag_valid_pseudorange", nchannels)
+          .add<double>("PRN", nchannels);
+    return schema;
+}
+}
+
 
 hybrid_observables_cc_sptr
-hybrid_make_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging)
+hybrid_make_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging, bool decimate)
 {
-    return hybrid_observables_cc_sptr(new hybrid_observables_cc(nchannels, dump, dump_filename, output_rate_ms, flag_averaging));
+    return hybrid_observables_cc_sptr(new hybrid_observables_cc(nchannels, dump, dump_filename, output_rate_ms, flag_averaging, decimate));
 }
 
 
-hybrid_observables_cc::hybrid_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging) :
+hybrid_observables_cc::hybrid_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging, bool decimate) :
                                 gr::block("hybrid_observables_cc", gr::io_signature::make(nchannels, nchannels, sizeof(Gnss_Synchro)),
                                 gr::io_signature::make(nchannels, nchannels, sizeof(Gnss_Synchro)))
 {
@@ -64,22 +78,27 @@ hybrid_observables_cc::hybrid_observables_cc(unsigned int nchannels, bool dump,
     d_output_rate_ms = output_rate_ms;
     d_dump_filename = dump_filename;
     d_flag_averaging = flag_averaging;
+    d_decimate = decimate;
+    d_low_latency = false;
+    if (d_output_rate_ms < 1)
+        {
+            d_output_rate_ms = 1;
+        }
+    d_sample_counter = 0;
 
     // ############# ENABLE DATA FILE LOG #################
     if (d_dump == true)
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit );
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    if (d_dump_file.open(d_dump_filename, observables_dump_schema(d_nchannels)))
+                        {
                             LOG(INFO) << "Observables dump enabled Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (const std::ifstream::failure & e)
-                    {
-                            LOG(WARNING) << "Exception opening observables dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "Cannot open observables dump file " << d_dump_filename;
+                        }
                 }
         }
 }
@@ -93,23 +112,6 @@ hybrid_observables_cc::~hybrid_observables_cc()
 
 
 
-bool Hybrid_pairCompare_gnss_synchro_Prn_delay_ms(const std::pair<int,Gnss_Synchro>& a, const std::pair<int,Gnss_Synchro>& b)
-{
-    return (a.second.Prn_timestamp_ms) < (b.second.Prn_timestamp_ms);
-}
-
-
-bool Hybrid_pairCompare_gnss_synchro_d_TOW_hybrid_at_current_symbol(const std::pair<int,Gnss_Synchro>& a, const std::pair<int,Gnss_Synchro>& b)
-{
-    return (a.second.d_TOW_hybrid_at_current_symbol) < (b.second.d_TOW_hybrid_at_current_symbol);
-}
-
-bool Hybrid_pairCompare_gnss_synchro_d_TOW_at_current_symbol(const std::pair<int,Gnss_Synchro>& a, const std::pair<int,Gnss_Synchro>& b)
-{
-    return (a.second.d_TOW_at_current_symbol) < (b.second.d_TOW_at_current_symbol);
-}
-
-
 int hybrid_observables_cc::general_work (int noutput_items, gr_vector_int &ninput_items,
         gr_vector_const_void_star &input_items,    gr_vector_void_star &output_items)
 {
@@ -117,9 +119,11 @@ int hybrid_observables_cc::general_work (int noutput_items, gr_vector_int &ninpu
     Gnss_Synchro **out = (Gnss_Synchro **)  &output_items[0]; // Get the output pointer
 
     Gnss_Synchro current_gnss_synchro[d_nchannels];
-    std::map<int,Gnss_Synchro> current_gnss_synchro_map;
-    std::map<int,Gnss_Synchro> current_gnss_synchro_map_gps_only;
-    std::map<int,Gnss_Synchro>::iterator gnss_synchro_iter;
+    d_sample_counter++;
+    // in decimated mode, the pseudoranges are only formed on the PVT output epochs
+    bool output_epoch = !d_decimate or (d_sample_counter % d_output_rate_ms) == 0;
+    // in low latency mode, the other epochs are extrapolated to their newest sample
+    bool extrapolated_epoch = d_low_latency and (d_sample_counter % d_output_rate_ms) != 0;
 
     if (d_nchannels != ninput_items.size())
         {
@@ -129,6 +133,7 @@ int hybrid_observables_cc::general_work (int noutput_items, gr_vector_int &ninpu
     /*
      * 1. Read the GNSS SYNCHRO objects from available channels
      */
+    d_valid_channels.clear();
     for (unsigned int i = 0; i < d_nchannels; i++)
         {
             //Copy the telemetry decoder data to local copy
@@ -140,90 +145,97 @@ int hybrid_observables_cc::general_work (int noutput_items, gr_vector_int &ninpu
             current_gnss_synchro[i].Pseudorange_m = 0.0;
             if (current_gnss_synchro[i].Flag_valid_word)
                 {
-                    //record the word structure in a map for pseudorange computation
-                    current_gnss_synchro_map.insert(std::pair<int, Gnss_Synchro>(current_gnss_synchro[i].Channel_ID, current_gnss_synchro[i]));
-                    if (current_gnss_synchro[i].System == 'G')
-                        {
-                            current_gnss_synchro_map_gps_only.insert(std::pair<int, Gnss_Synchro>(current_gnss_synchro[i].Channel_ID, current_gnss_synchro[i]));
-                        }
+                    //record the channel for pseudorange computation
+                    d_valid_channels.push_back(i);
                 }
         }
 
     /*
      * 2. Compute RAW pseudoranges using COMMON RECEPTION TIME algorithm. Use only the valid channels (channels that are tracking a satellite)
      */
-    DLOG(INFO) << "gnss_synchro set size=" << current_gnss_synchro_map.size();
+    DLOG(INFO) << "gnss_synchro set size=" << d_valid_channels.size();
 
-    if(current_gnss_synchro_map.size() > 0)// and current_gnss_synchro_map_gps_only.size()>0)
+    if(extrapolated_epoch)
+        {
+            extrapolate_observables(current_gnss_synchro, d_valid_channels, &Gnss_Synchro::d_TOW_hybrid_at_current_symbol, GALILEO_STARTOFFSET_ms);
+        }
+    else if(output_epoch and d_valid_channels.size() > 0)
         {
             /*
              *  2.1 Use CURRENT set of measurements and find the nearest satellite
              *  common RX time algorithm
              */
             // what is the most recent symbol TOW in the current set? -> this will be the reference symbol
-            gnss_synchro_iter = max_element(current_gnss_synchro_map.begin(), current_gnss_synchro_map.end(), Hybrid_pairCompare_gnss_synchro_d_TOW_hybrid_at_current_symbol);
-            //gnss_synchro_iter = max_element(current_gnss_synchro_map_gps_only.begin(), current_gnss_synchro_map_gps_only.end(), Hybrid_pairCompare_gnss_synchro_d_TOW_hybrid_at_current_symbol);
-            double d_TOW_reference = gnss_synchro_iter->second.d_TOW_hybrid_at_current_symbol;
+            unsigned int reference_channel = d_valid_channels[0];
+            for (unsigned int n = 1; n < d_valid_channels.size(); n++)
+                {
+                    if (current_gnss_synchro[d_valid_channels[n]].d_TOW_hybrid_at_current_symbol > current_gnss_synchro[reference_channel].d_TOW_hybrid_at_current_symbol)
+                        {
+                            reference_channel = d_valid_channels[n];
+                        }
+                }
+            double d_TOW_reference = current_gnss_synchro[reference_channel].d_TOW_hybrid_at_current_symbol;
             DLOG(INFO) << "d_TOW_hybrid_reference [ms] = " << d_TOW_reference * 1000;
-            double d_ref_PRN_rx_time_ms = gnss_synchro_iter->second.Prn_timestamp_ms;
+            double d_ref_PRN_rx_time_ms = current_gnss_synchro[reference_channel].Prn_timestamp_ms;
             DLOG(INFO) << "ref_PRN_rx_time_ms [ms] = " << d_ref_PRN_rx_time_ms;
-            //int reference_channel= gnss_synchro_iter->second.Channel_ID;
 
             // Now compute RX time differences due to the PRN alignment in the correlators
             double traveltime_ms;
             double pseudorange_m;
             double delta_rx_time_ms;
             double delta_TOW_ms;
-            for(gnss_synchro_iter = current_gnss_synchro_map.begin(); gnss_synchro_iter != current_gnss_synchro_map.end(); gnss_synchro_iter++)
+            for (unsigned int n = 0; n < d_valid_channels.size(); n++)
                 {
+                    unsigned int i = d_valid_channels[n];
                     // check and correct synchronization in cross-system pseudoranges!
-                    delta_rx_time_ms = gnss_synchro_iter->second.Prn_timestamp_ms - d_ref_PRN_rx_time_ms;
-                    delta_TOW_ms = (d_TOW_reference - gnss_synchro_iter->second.d_TOW_hybrid_at_current_symbol) * 1000.0;
+                    delta_rx_time_ms = current_gnss_synchro[i].Prn_timestamp_ms - d_ref_PRN_rx_time_ms;
+                    delta_TOW_ms = (d_TOW_reference - current_gnss_synchro[i].d_TOW_hybrid_at_current_symbol) * 1000.0;
 
                     //compute the pseudorange
                     traveltime_ms =  delta_TOW_ms + delta_rx_time_ms + GALILEO_STARTOFFSET_ms;
                     pseudorange_m = traveltime_ms * GALILEO_C_m_ms; // [m]
-                    DLOG(INFO) << "CH " << gnss_synchro_iter->second.Channel_ID << " tracking GNSS System "
-                               << gnss_synchro_iter->second.System << " has PRN start at= " << gnss_synchro_iter->second.Prn_timestamp_ms
-                               << " [ms], d_TOW_at_current_symbol = " << (gnss_synchro_iter->second.d_TOW_at_current_symbol) * 1000
-                               << " [ms], d_TOW_hybrid_at_current_symbol = "<< (gnss_synchro_iter->second.d_TOW_hybrid_at_current_symbol) * 1000
+                    DLOG(INFO) << "CH " << current_gnss_synchro[i].Channel_ID << " tracking GNSS System "
+                               << current_gnss_synchro[i].System << " has PRN start at= " << current_gnss_synchro[i].Prn_timestamp_ms
+                               << " [ms], d_TOW_at_current_symbol = " << (current_gnss_synchro[i].d_TOW_at_current_symbol) * 1000
+                               << " [ms], d_TOW_hybrid_at_current_symbol = "<< (current_gnss_synchro[i].d_TOW_hybrid_at_current_symbol) * 1000
                                << "[ms], delta_rx_time_ms = " << delta_rx_time_ms << "[ms], travel_time = " << traveltime_ms
                                << ", pseudorange[m] = "<< pseudorange_m;
 
                     // update the pseudorange object
-                    //current_gnss_synchro[gnss_synchro_iter->second.Channel_ID] = gnss_synchro_iter->second;
-                    current_gnss_synchro[gnss_synchro_iter->second.Channel_ID].Pseudorange_m = pseudorange_m;
-                    current_gnss_synchro[gnss_synchro_iter->second.Channel_ID].Flag_valid_pseudorange = true;
-                    current_gnss_synchro[gnss_synchro_iter->second.Channel_ID].d_TOW_hybrid_at_current_symbol = round(d_TOW_reference * 1000) / 1000 + GALILEO_STARTOFFSET_ms / 1000.0;
+                    current_gnss_synchro[i].Pseudorange_m = pseudorange_m;
+                    current_gnss_synchro[i].Flag_valid_pseudorange = true;
+                    current_gnss_synchro[i].d_TOW_hybrid_at_current_symbol = round(d_TOW_reference * 1000) / 1000 + GALILEO_STARTOFFSET_ms / 1000.0;
                 }
         }
 
     if(d_dump == true)
         {
             // MULTIPLEXED FILE RECORDING - Record results to file
-            try
-            {
-                    double tmp_double;
-                    for (unsigned int i = 0; i < d_nchannels ; i++)
-                        {
-                            tmp_double = current_gnss_synchro[i].d_TOW_at_current_symbol;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = current_gnss_synchro[i].d_TOW_hybrid_at_current_symbol;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = current_gnss_synchro[i].Prn_timestamp_ms;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = current_gnss_synchro[i].Pseudorange_m;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = (double)(current_gnss_synchro[i].Flag_valid_pseudorange==true);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = current_gnss_synchro[i].PRN;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                        }
-            }
-            catch (const std::ifstream::failure& e)
-            {
-                    LOG(WARNING) << "Exception writing observables dump file " << e.what();
-            }
+            // each field holds the values of all the channels
+            for (unsigned int i = 0; i < d_nchannels; i++)
+                {
+                    d_dump_file.put<double>(current_gnss_synchro[i].d_TOW_at_current_symbol);
+                }
+            for (unsigned int i = 0; i < d_nchannels; i++)
+                {
+                    d_dump_file.put<double>(current_gnss_synchro[i].d_TOW_hybrid_at_current_symbol);
+                }
+            for (unsigned int i = 0; i < d_nchannels; i++)
+                {
+                    d_dump_file.put<double>(current_gnss_synchro[i].Prn_timestamp_ms);
+                }
+            for (unsigned int i = 0; i < d_nchannels; i++)
+                {
+                    d_dump_file.put<double>(current_gnss_synchro[i].Pseudorange_m);
+                }
+            for (unsigned int i = 0; i < d_nchannels; i++)
+                {
+                    d_dump_file.put<double>(current_gnss_synchro[i].Flag_valid_pseudorange==true);
+                }
+            for (unsigned int i = 0; i < d_nchannels; i++)
+                {
+                    d_dump_file.put<double>(current_gnss_synchro[i].PRN);
+                }
         }
 
     consume_each(1); //consume one by one
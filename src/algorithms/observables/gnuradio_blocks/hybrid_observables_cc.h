@@ -35,7 +35,9 @@
 
 #include <fstream>
 #include <string>
+#include <vector>
 #include <gnuradio/block.h>
+#include "dump_writer.h"
 
 
 class hybrid_observables_cc;
@@ -43,7 +45,7 @@ class hybrid_observables_cc;
 typedef boost::shared_ptr<hybrid_observables_cc> hybrid_observables_cc_sptr;
 
 hybrid_observables_cc_sptr
-hybrid_make_observables_cc(unsigned int n_channels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging);
+hybrid_make_observables_cc(unsigned int n_channels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging, bool decimate);
 
 /*!
  * \brief This class implements a block that computes Galileo observables
@@ -55,18 +57,31 @@ public:
     int general_work (int noutput_items, gr_vector_int &ninput_items,
             gr_vector_const_void_star &input_items, gr_vector_void_star &output_items);
 
+    /*!
+     * \brief In low latency mode the pseudoranges are formed on every epoch,
+     * extrapolated to its newest sample (see observables_extrapolation.h).
+     * The PVT output epochs, one in output_rate_ms, keep the pseudoranges
+     * aligned to the reference TOW.
+     */
+    void set_low_latency(bool enabled) { d_low_latency = enabled; }
+
 private:
     friend hybrid_observables_cc_sptr
-    hybrid_make_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging);
-    hybrid_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging);
+    hybrid_make_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging, bool decimate);
+    hybrid_observables_cc(unsigned int nchannels, bool dump, std::string dump_filename, int output_rate_ms, bool flag_averaging, bool decimate);
+
+    std::vector<unsigned int> d_valid_channels;
 
     // class private vars
     bool d_dump;
     bool d_flag_averaging;
+    bool d_decimate;
+    bool d_low_latency;
+    unsigned long int d_sample_counter;
     unsigned int d_nchannels;
     int d_output_rate_ms;
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
 };
 
 #endif
@@ -36,6 +36,7 @@
 #include "direct_resampler_conditioner_cc.h"
 #include "direct_resampler_conditioner_cs.h"
 #include "direct_resampler_conditioner_cb.h"
+#include "polyphase_resampler_conditioner.h"
 #include "configuration_interface.h"
 
 
@@ -51,6 +52,14 @@ DirectResamplerConditioner::DirectResamplerConditioner(
     sample_freq_in_ = configuration->property(role_ + ".sample_freq_in", (double)4000000.0);
     sample_freq_out_ = configuration->property(role_ + ".sample_freq_out", (double)2048000.0);
     item_type_ = configuration->property(role + ".item_type", default_item_type);
+    std::string default_interpolation = "nearest";
+    interpolation_ = configuration->property(role + ".interpolation", default_interpolation);
+    unsigned int taps_per_phase = configuration->property(role + ".taps_per_phase", 16);
+    bool polyphase = (interpolation_.compare("polyphase") == 0);
+    if (!polyphase && (interpolation_.compare("nearest") != 0))
+        {
+            LOG(WARNING) << interpolation_ << " unrecognized interpolation for resampler, using nearest";
+        }
     dump_ = configuration->property(role + ".dump", false);
     DLOG(INFO) << "dump_ is " << dump_;
     dump_filename_ = configuration->property(role + ".dump_filename", default_dump_file);
@@ -58,7 +67,14 @@ DirectResamplerConditioner::DirectResamplerConditioner(
     if (item_type_.compare("gr_complex") == 0)
         {
             item_size_ = sizeof(gr_complex);
-            resampler_ = direct_resampler_make_conditioner_cc(sample_freq_in_, sample_freq_out_);
+            if (polyphase)
+                {
+                    resampler_ = polyphase_resampler_make_conditioner(POLYPHASE_RESAMPLER_GR_COMPLEX, sample_freq_in_, sample_freq_out_, taps_per_phase);
+                }
+            else
+                {
+                    resampler_ = direct_resampler_make_conditioner_cc(sample_freq_in_, sample_freq_out_);
+                }
             DLOG(INFO) << "sample_freq_in " << sample_freq_in_;
             DLOG(INFO) << "sample_freq_out" << sample_freq_out_;
             DLOG(INFO) << "Item size " << item_size_;
@@ -67,7 +83,14 @@ DirectResamplerConditioner::DirectResamplerConditioner(
     else if (item_type_.compare("cshort") == 0)
         {
             item_size_ = sizeof(lv_16sc_t);
-            resampler_ = direct_resampler_make_conditioner_cs(sample_freq_in_, sample_freq_out_);
+            if (polyphase)
+                {
+                    resampler_ = polyphase_resampler_make_conditioner(POLYPHASE_RESAMPLER_CSHORT, sample_freq_in_, sample_freq_out_, taps_per_phase);
+                }
+            else
+                {
+                    resampler_ = direct_resampler_make_conditioner_cs(sample_freq_in_, sample_freq_out_);
+                }
             DLOG(INFO) << "sample_freq_in " << sample_freq_in_;
             DLOG(INFO) << "sample_freq_out" << sample_freq_out_;
             DLOG(INFO) << "Item size " << item_size_;
@@ -76,7 +99,14 @@ DirectResamplerConditioner::DirectResamplerConditioner(
     else if (item_type_.compare("cbyte") == 0)
         {
             item_size_ = sizeof(lv_8sc_t);
-            resampler_ = direct_resampler_make_conditioner_cb(sample_freq_in_, sample_freq_out_);
+            if (polyphase)
+                {
+                    resampler_ = polyphase_resampler_make_conditioner(POLYPHASE_RESAMPLER_CBYTE, sample_freq_in_, sample_freq_out_, taps_per_phase);
+                }
+            else
+                {
+                    resampler_ = direct_resampler_make_conditioner_cb(sample_freq_in_, sample_freq_out_);
+                }
             DLOG(INFO) << "sample_freq_in " << sample_freq_in_;
             DLOG(INFO) << "sample_freq_out" << sample_freq_out_;
             DLOG(INFO) << "Item size " << item_size_;
@@ -74,6 +74,7 @@ private:
     unsigned int in_stream_;
     unsigned int out_stream_;
     std::string item_type_;
+    std::string interpolation_;
     size_t item_size_;
     bool dump_;
     std::string dump_filename_;
@@ -0,0 +1,199 @@
+/*!
+ * \file polyphase_resampler_conditioner.cc
+ * \brief Fractional resampler with a precomputed polyphase filter bank
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include "polyphase_resampler_conditioner.h"
+#include <algorithm>
+#include <cmath>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+// Filters in the bank, as a power of two: the output instant is rounded to 1/128 of an input sample
+#define POLYPHASE_RESAMPLER_PHASES_LOG2 7
+#define POLYPHASE_RESAMPLER_PHASES (1 << POLYPHASE_RESAMPLER_PHASES_LOG2)
+// Input samples converted at once for cshort and cbyte (32 kB of gr_complex)
+#define POLYPHASE_RESAMPLER_CHUNK_SAMPLES 4096
+
+static const size_t polyphase_resampler_item_size[3] = {sizeof(gr_complex), sizeof(lv_16sc_t), sizeof(lv_8sc_t)};
+
+
+polyphase_resampler_conditioner_sptr polyphase_resampler_make_conditioner(
+        Polyphase_Resampler_Item_Type item_type, double sample_freq_in,
+        double sample_freq_out, unsigned int taps_per_phase)
+{
+    return polyphase_resampler_conditioner_sptr(
+            new polyphase_resampler_conditioner(item_type, sample_freq_in,
+                    sample_freq_out, taps_per_phase));
+}
+
+
+
+polyphase_resampler_conditioner::polyphase_resampler_conditioner(
+        Polyphase_Resampler_Item_Type item_type, double sample_freq_in,
+        double sample_freq_out, unsigned int taps_per_phase) :
+            gr::block("polyphase_resampler_conditioner",
+                    gr::io_signature::make(1, 1, polyphase_resampler_item_size[item_type]),
+                    gr::io_signature::make(1, 1, polyphase_resampler_item_size[item_type])),
+                    d_item_type(item_type), d_sample_freq_in(sample_freq_in),
+                    d_sample_freq_out(sample_freq_out), d_frac(0), d_index(0)
+{
+    // an even number of taps, so the filters are symmetric around the middle of the window
+    d_taps_per_phase = std::max(2u, taps_per_phase + (taps_per_phase % 2));
+
+    const double two_32 = 4294967296.0;
+    const double step = sample_freq_in / sample_freq_out;
+    d_step_int = static_cast<unsigned int>(std::floor(step));
+    d_step_frac = static_cast<uint32_t>(std::floor(two_32 * (step - d_step_int)));
+
+    // Blackman-windowed sinc, cut at the Nyquist frequency of the slower rate
+    const double cutoff = 0.5 * std::min(1.0, sample_freq_out / sample_freq_in); // cycles per input sample
+    const double half = d_taps_per_phase / 2.0;
+    d_bank.resize(POLYPHASE_RESAMPLER_PHASES * d_taps_per_phase);
+    for (unsigned int p = 0; p < POLYPHASE_RESAMPLER_PHASES; p++)
+        {
+            float* filter = &d_bank[p * d_taps_per_phase];
+            double sum = 0.0;
+            for (unsigned int k = 0; k < d_taps_per_phase; k++)
+                {
+                    // distance from the output instant to input sample k
+                    const double t = k - (half - 1.0) - static_cast<double>(p) / POLYPHASE_RESAMPLER_PHASES;
+                    const double x = 2.0 * cutoff * t;
+                    const double sinc = (std::fabs(x) < 1e-12) ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+                    const double window = 0.42 + 0.5 * std::cos(M_PI * t / half) + 0.08 * std::cos(2.0 * M_PI * t / half);
+                    filter[k] = sinc * window;
+                    sum += filter[k];
+                }
+            // unit gain at DC in every phase, so the amplitude of the samples is kept
+            for (unsigned int k = 0; k < d_taps_per_phase; k++)
+                {
+                    filter[k] = filter[k] / sum;
+                }
+        }
+    if (d_item_type != POLYPHASE_RESAMPLER_GR_COMPLEX)
+        {
+            d_samples.resize(std::max(static_cast<unsigned int>(POLYPHASE_RESAMPLER_CHUNK_SAMPLES), 2 * d_taps_per_phase + d_step_int));
+        }
+    set_relative_rate(1.0 * sample_freq_out / sample_freq_in);
+    set_output_multiple(1);
+}
+
+
+
+polyphase_resampler_conditioner::~polyphase_resampler_conditioner()
+{
+
+}
+
+
+
+void polyphase_resampler_conditioner::forecast(int noutput_items,
+        gr_vector_int &ninput_items_required)
+{
+    int nreqd = static_cast<int>(static_cast<double>(noutput_items + 1)
+            * sample_freq_in() / sample_freq_out()) + d_index + d_taps_per_phase;
+    unsigned ninputs = ninput_items_required.size();
+    for (unsigned i = 0; i < ninputs; i++)
+    {
+        ninput_items_required[i] = nreqd;
+    }
+}
+
+
+
+int polyphase_resampler_conditioner::general_work(int noutput_items,
+        gr_vector_int &ninput_items, gr_vector_const_void_star &input_items,
+        gr_vector_void_star &output_items)
+{
+    const unsigned int shift = 32 - POLYPHASE_RESAMPLER_PHASES_LOG2;
+    const uint64_t rounding = 1ULL << (shift - 1);
+    unsigned int available = ninput_items[0];
+    const gr_complex* in = (const gr_complex*) input_items[0];
+    gr_complex* out = (gr_complex*) output_items[0];
+
+    // cshort and cbyte go through gr_complex buffers, one chunk per call
+    if (d_item_type != POLYPHASE_RESAMPLER_GR_COMPLEX)
+        {
+            const unsigned int needed = static_cast<unsigned int>(std::ceil(static_cast<double>(noutput_items)
+                    * sample_freq_in() / sample_freq_out())) + d_index + d_taps_per_phase + 1;
+            available = std::min(std::min(available, needed), static_cast<unsigned int>(d_samples.size()));
+            float* samples = reinterpret_cast<float*>(&d_samples[0]);
+            if (d_item_type == POLYPHASE_RESAMPLER_CSHORT)
+                {
+                    volk_16i_s32f_convert_32f(samples, (const int16_t*) input_items[0], 1.0, 2 * available);
+                }
+            else
+                {
+                    volk_8i_s32f_convert_32f(samples, (const int8_t*) input_items[0], 1.0, 2 * available);
+                }
+            in = &d_samples[0];
+            noutput_items = std::min(noutput_items, static_cast<int>(available));
+            d_outputs.resize(noutput_items);
+            out = &d_outputs[0];
+        }
+
+    int lcv = 0;
+    while (lcv < noutput_items)
+        {
+            unsigned int index = d_index;
+            unsigned int phase = static_cast<unsigned int>((d_frac + rounding) >> shift);
+            if (phase == POLYPHASE_RESAMPLER_PHASES)
+                {
+                    phase = 0;
+                    index++;
+                }
+            if (index + d_taps_per_phase > available)
+                {
+                    break;
+                }
+            volk_32fc_32f_dot_prod_32fc(&out[lcv], &in[index], &d_bank[phase * d_taps_per_phase], d_taps_per_phase);
+            lcv++;
+            const uint32_t frac = d_frac + d_step_frac;
+            d_index += d_step_int + (frac < d_frac ? 1 : 0);
+            d_frac = frac;
+        }
+
+    if (d_item_type == POLYPHASE_RESAMPLER_CSHORT)
+        {
+            volk_32f_s32f_convert_16i((int16_t*) output_items[0], reinterpret_cast<const float*>(out), 1.0, 2 * lcv);
+        }
+    else if (d_item_type == POLYPHASE_RESAMPLER_CBYTE)
+        {
+            volk_32f_s32f_convert_8i((int8_t*) output_items[0], reinterpret_cast<const float*>(out), 1.0, 2 * lcv);
+        }
+
+    const unsigned int consumed = std::min(d_index, available);
+    d_index -= consumed;
+    consume_each(consumed);
+    return lcv;
+}
@@ -0,0 +1,106 @@
+/*!
+ * \file polyphase_resampler_conditioner.h
+ * \brief Fractional resampler with a precomputed polyphase filter bank
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_POLYPHASE_RESAMPLER_CONDITIONER_H
+#define GNSS_SDR_POLYPHASE_RESAMPLER_CONDITIONER_H
+
+#include <vector>
+#include <gnuradio/block.h>
+#include <volk/volk.h>
+
+/*!
+ * \brief Sample type of the input and output streams
+ */
+enum Polyphase_Resampler_Item_Type
+{
+    POLYPHASE_RESAMPLER_GR_COMPLEX = 0,
+    POLYPHASE_RESAMPLER_CSHORT = 1,
+    POLYPHASE_RESAMPLER_CBYTE = 2
+};
+
+class polyphase_resampler_conditioner;
+typedef boost::shared_ptr<polyphase_resampler_conditioner> polyphase_resampler_conditioner_sptr;
+polyphase_resampler_conditioner_sptr
+polyphase_resampler_make_conditioner(Polyphase_Resampler_Item_Type item_type,
+        double sample_freq_in, double sample_freq_out, unsigned int taps_per_phase);
+
+/*!
+ * \brief This class implements a fractional resampler conditioner for
+ * gr_complex, cshort and cbyte data
+ *
+ * Each output sample is interpolated from taps_per_phase input samples
+ * with one of POLYPHASE_RESAMPLER_PHASES windowed-sinc filters, so the
+ * output instant is set to 1/POLYPHASE_RESAMPLER_PHASES of an input sample
+ * instead of to the nearest input sample. The low pass cutoff is the
+ * Nyquist frequency of the slower of the two rates, which also removes the
+ * aliasing of the direct resampler when decimating. The filters are
+ * computed once, and each output is one VOLK dot product. The output is
+ * delayed by taps_per_phase / 2 - 1 input samples.
+ */
+class polyphase_resampler_conditioner: public gr::block
+{
+private:
+    friend polyphase_resampler_conditioner_sptr
+    polyphase_resampler_make_conditioner(Polyphase_Resampler_Item_Type item_type,
+            double sample_freq_in, double sample_freq_out, unsigned int taps_per_phase);
+    polyphase_resampler_conditioner(Polyphase_Resampler_Item_Type item_type,
+            double sample_freq_in, double sample_freq_out, unsigned int taps_per_phase);
+
+    Polyphase_Resampler_Item_Type d_item_type;
+    double d_sample_freq_in;  //! Specifies the sampling frequency of the input signal
+    double d_sample_freq_out; //! Specifies the sampling frequency of the output signal
+    unsigned int d_taps_per_phase;
+    std::vector<float> d_bank;           // POLYPHASE_RESAMPLER_PHASES filters of d_taps_per_phase taps
+    unsigned int d_step_int;             // input samples per output sample: integer part...
+    uint32_t d_step_frac;                // ... and fractional part, times 2^32
+    uint32_t d_frac;                     // position of the next output between two input samples, times 2^32
+    unsigned int d_index;                // input sample where the window of the next output starts
+    std::vector<gr_complex> d_samples;   // converted cshort / cbyte input
+    std::vector<gr_complex> d_outputs;   // gr_complex output before the cshort / cbyte conversion
+
+public:
+    ~polyphase_resampler_conditioner();
+    double sample_freq_in() const
+    {
+        return d_sample_freq_in;
+    }
+    double sample_freq_out() const
+    {
+        return d_sample_freq_out;
+    }
+    void forecast(int noutput_items, gr_vector_int &ninput_items_required);
+    int general_work(int noutput_items, gr_vector_int &ninput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items);
+};
+
+#endif /* GNSS_SDR_POLYPHASE_RESAMPLER_CONDITIONER_H */
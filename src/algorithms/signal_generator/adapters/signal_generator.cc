@@ -31,8 +31,12 @@
 
 
 #include "signal_generator.h"
+#include <cmath>
 #include <glog/logging.h>
 #include "configuration_interface.h"
+#include "gps_lnav_encoder.h"
+#include "nav_data_fields.h"
+#include "rinex_nav_reader.h"
 #include "Galileo_E1.h"
 #include "GPS_L1_CA.h"
 #include "Galileo_E5a.h"
@@ -40,6 +44,80 @@
 
 using google::LogMessage;
 
+namespace
+{
+/*
+ * A nominal GPS ephemeris, with the satellites spread over the orbits by
+ * their PRN, for the navigation message when there is no RINEX file
+ */
+Gps_Ephemeris nominal_ephemeris(unsigned int PRN, int week, double toe_s)
+{
+    Gps_Ephemeris eph;
+    eph.i_satellite_PRN = PRN;
+    eph.i_GPS_week = week;
+    eph.i_code_on_L2 = 1;
+    eph.i_SV_accuracy = 2;
+    eph.i_SV_health = 0;
+    eph.d_IODC = PRN;
+    eph.d_IODE_SF2 = PRN;
+    eph.d_IODE_SF3 = PRN;
+    eph.d_Toc = toe_s;
+    eph.d_Toe = toe_s;
+    eph.d_e_eccentricity = 0.01;
+    eph.d_sqrt_A = 5153.6;
+    eph.d_i_0 = 0.9599;
+    eph.d_Delta_n = 4.5e-9;
+    eph.d_OMEGA0 = std::fmod(PRN * 1.0472, 2.0 * GPS_PI) - GPS_PI;
+    eph.d_M_0 = std::fmod(PRN * 0.7854, 2.0 * GPS_PI) - GPS_PI;
+    eph.d_OMEGA = 0.5;
+    eph.d_OMEGA_DOT = -8.1e-9;
+    return eph;
+}
+
+
+/*
+ * Schedule of a signal, from the properties prefix<key>suffix. The edit of
+ * the ephemeris changes one field of ephemeris.
+ */
+Signal_Generator_Schedule read_schedule(ConfigurationInterface* configuration,
+        const std::string& prefix, const std::string& suffix, const Gps_Ephemeris& ephemeris)
+{
+    Signal_Generator_Schedule schedule;
+    schedule.start_s = configuration->property(prefix + "start_s" + suffix, 0.0);
+    schedule.stop_s = configuration->property(prefix + "stop_s" + suffix, 0.0);
+    schedule.power_ramp_dB_per_s = configuration->property(prefix + "power_ramp_dB_per_s" + suffix, 0.0);
+    schedule.power_ramp_max_dB = configuration->property(prefix + "power_ramp_max_dB" + suffix, 0.0);
+    schedule.power_swing_dB = configuration->property(prefix + "power_swing_dB" + suffix, 0.0);
+    schedule.power_swing_period_s = configuration->property(prefix + "power_swing_period_s" + suffix, 0.0);
+    schedule.delay_drift_chips_per_s = configuration->property(prefix + "delay_drift_chips_per_s" + suffix, 0.0);
+    schedule.delay_drift_max_chips = configuration->property(prefix + "delay_drift_max_chips" + suffix, 0.0);
+    schedule.nav_edit_s = configuration->property(prefix + "nav_edit_s" + suffix, -1.0);
+    schedule.tow_jump_s = configuration->property(prefix + "tow_jump_s" + suffix, 0);
+
+    std::string field_name = configuration->property(prefix + "ephemeris_field" + suffix, std::string(""));
+    if (!field_name.empty())
+        {
+            const std::vector<Nav_Field<Gps_Ephemeris> >& fields = gps_ephemeris_fields();
+            Nav_Field_Mask bit = nav_field_bit(fields, field_name);
+            for (unsigned int i = 0; i < fields.size(); i++)
+                {
+                    if (bit == (Nav_Field_Mask(1) << i))
+                        {
+                            schedule.edited_ephemeris = ephemeris;
+                            fields[i].set_value(schedule.edited_ephemeris,
+                                    fields[i].value(ephemeris) + configuration->property(prefix + "ephemeris_delta" + suffix, 0.0));
+                            schedule.edit_ephemeris = true;
+                        }
+                }
+            if (!schedule.edit_ephemeris)
+                {
+                    LOG(WARNING) << prefix << "ephemeris_field" << suffix << "=" << field_name << " is not an ephemeris field";
+                }
+        }
+    return schedule;
+}
+}
+
 SignalGenerator::SignalGenerator(ConfigurationInterface* configuration,
         std::string role, unsigned int in_stream,
         unsigned int out_stream, boost::shared_ptr<gr::msg_queue> queue) :
@@ -67,6 +145,9 @@ SignalGenerator::SignalGenerator(ConfigurationInterface* configuration,
     std::vector<float> doppler_Hz;
     std::vector<unsigned int> delay_chips;
     std::vector<unsigned int> delay_sec;
+    std::vector<unsigned int> data_source;
+    std::vector<std::string> schedule_prefix;
+    std::vector<std::string> schedule_suffix;
 
     for (unsigned int sat_idx = 0; sat_idx < num_satellites; sat_idx++)
         {
@@ -78,6 +159,41 @@ SignalGenerator::SignalGenerator(ConfigurationInterface* configuration,
             doppler_Hz.push_back(configuration->property("SignalSource.doppler_Hz_" + sat, 0));
             delay_chips.push_back(configuration->property("SignalSource.delay_chips_" + sat, 0));
             delay_sec.push_back(configuration->property("SignalSource.delay_sec_" + sat, 0));
+            data_source.push_back(sat_idx);
+            schedule_prefix.push_back("SignalSource.");
+            schedule_suffix.push_back("_" + sat);
+        }
+
+    // Spoofing replicas: a copy of a satellite, with the same code and data bits,
+    // delayed by an integer number of chips, with its own power and Doppler offset
+    unsigned int num_replicas = configuration->property("SignalSource.spoofer_replicas", 0);
+    for (unsigned int replica_idx = 0; replica_idx < num_replicas; replica_idx++)
+        {
+            std::string replica = std::to_string(replica_idx);
+            unsigned int sat_idx = configuration->property("SignalSource.spoofer_sat_" + replica, 0);
+            if (sat_idx >= num_satellites)
+                {
+                    LOG(WARNING) << "SignalSource.spoofer_sat_" << replica << "=" << sat_idx << " is not a satellite, replica ignored";
+                    continue;
+                }
+            unsigned int code_length_chips = static_cast<unsigned int>(GPS_L1_CA_CODE_LENGTH_CHIPS);
+            if (system.at(sat_idx) == "E")
+                {
+                    code_length_chips = static_cast<unsigned int>((signal1.at(sat_idx).at(0) == '5') ? Galileo_E5a_CODE_LENGTH_CHIPS : Galileo_E1_B_CODE_LENGTH_CHIPS);
+                }
+            unsigned int offset_chips = configuration->property("SignalSource.spoofer_delay_chips_" + replica, 0);
+            signal1.push_back(signal1.at(sat_idx));
+            system.push_back(system.at(sat_idx));
+            PRN.push_back(PRN.at(sat_idx));
+            CN0_dB.push_back(CN0_dB.at(sat_idx) + configuration->property("SignalSource.spoofer_power_dB_" + replica, 3.0));
+            doppler_Hz.push_back(doppler_Hz.at(sat_idx) + configuration->property("SignalSource.spoofer_doppler_Hz_" + replica, 0.0));
+            delay_chips.push_back((delay_chips.at(sat_idx) + offset_chips) % code_length_chips);
+            delay_sec.push_back(delay_sec.at(sat_idx));
+            data_source.push_back(sat_idx);
+            schedule_prefix.push_back("SignalSource.spoofer_");
+            schedule_suffix.push_back("_" + replica);
+            LOG(INFO) << "Spoofing replica " << replica << " of " << system.at(sat_idx) << " PRN " << PRN.at(sat_idx)
+                      << ": " << offset_chips << " chips later, " << CN0_dB.back() << " dB-Hz";
         }
 
     // If Galileo signal is present -> vector duration = 100 ms (25 * 4 ms)
@@ -108,10 +224,12 @@ SignalGenerator::SignalGenerator(ConfigurationInterface* configuration,
             item_size_ = sizeof(gr_complex);
             DLOG(INFO) << "Item size " << item_size_;
             gen_source_ = signal_make_generator_c(signal1, system, PRN, CN0_dB, doppler_Hz, delay_chips, delay_sec,
-                    data_flag, noise_flag, fs_in, vector_length, BW_BB);
+                    data_flag, noise_flag, fs_in, vector_length, BW_BB, data_source);
 
             vector_to_stream_ = gr::blocks::vector_to_stream::make(item_size_, vector_length);
 
+            set_scenario(configuration, system, PRN, data_source, schedule_prefix, schedule_suffix);
+
             DLOG(INFO) << "vector_to_stream(" << vector_to_stream_->unique_id() << ")";
             DLOG(INFO) << "gen_source(" << gen_source_->unique_id() << ")";
         }
@@ -138,6 +256,73 @@ SignalGenerator::~SignalGenerator()
 {}
 
 
+void SignalGenerator::set_scenario(ConfigurationInterface* configuration, const std::vector<std::string>& system,
+        const std::vector<unsigned int>& PRN, const std::vector<unsigned int>& data_source,
+        const std::vector<std::string>& schedule_prefix, const std::vector<std::string>& schedule_suffix)
+{
+    // Navigation message of the GPS signals: random bits, or the LNAV subframes
+    // of a RINEX navigation file or of a nominal orbit. A replica starts with
+    // the message of its satellite.
+    std::string nav_message = configuration->property("SignalSource.nav_message", std::string("random"));
+    bool lnav = nav_message == "lnav";
+    if (!lnav && nav_message != "random")
+        {
+            LOG(WARNING) << "SignalSource.nav_message=" << nav_message << " unknown, random data bits sent";
+        }
+    double nav_tow_s = configuration->property("SignalSource.nav_tow_s", 352800.0);
+    int nav_week = configuration->property("SignalSource.nav_week", 1873);
+    std::string rinex_nav_file = configuration->property("SignalSource.rinex_nav_file", std::string(""));
+    Rinex_Nav_Reader rinex;
+    if (lnav && !rinex_nav_file.empty() && !rinex.read_file(rinex_nav_file))
+        {
+            LOG(WARNING) << "Cannot read the GPS navigation file " << rinex_nav_file << ", nominal orbits sent";
+        }
+
+    std::vector<Gps_Lnav_Encoder> encoders(system.size());
+    for (unsigned int source = 0; source < system.size(); source++)
+        {
+            Gps_Lnav_Encoder& encoder = encoders[source];
+            if (data_source[source] != source)
+                {
+                    encoder = encoders[data_source[source]];
+                }
+            else
+                {
+                    Gps_Ephemeris ephemeris = nominal_ephemeris(PRN[source], nav_week, std::floor(nav_tow_s / 7200.0) * 7200.0);
+                    for (unsigned int i = 0; i < rinex.records().size(); i++)
+                        {
+                            if (rinex.records()[i].ephemeris.i_satellite_PRN == PRN[source])
+                                {
+                                    ephemeris = rinex.records()[i].ephemeris;
+                                    break;
+                                }
+                        }
+                    encoder.set_ephemeris(ephemeris);
+                    if (rinex.iono().valid) encoder.set_iono(rinex.iono());
+                    if (rinex.utc().valid) encoder.set_utc_model(rinex.utc());
+                    encoder.start(nav_tow_s);
+                }
+
+            Signal_Generator_Schedule schedule = read_schedule(configuration, schedule_prefix[source], schedule_suffix[source], encoder.ephemeris());
+            if (system[source] != "G" && schedule.delay_drift_chips_per_s != 0.0)
+                {
+                    LOG(WARNING) << schedule_prefix[source] << "delay_drift_chips_per_s" << schedule_suffix[source]
+                                 << " ignored, the delay drifts only for GPS";
+                }
+            if ((schedule.nav_edit_s >= 0.0) && !(lnav && system[source] == "G"))
+                {
+                    LOG(WARNING) << schedule_prefix[source] << "nav_edit_s" << schedule_suffix[source]
+                                 << " ignored, the navigation message is only sent for GPS with SignalSource.nav_message=lnav";
+                }
+            gen_source_->set_schedule(source, schedule);
+            if (lnav && system[source] == "G")
+                {
+                    gen_source_->set_navigation_message(source, encoder);
+                }
+        }
+}
+
+
 void SignalGenerator::connect(gr::top_block_sptr top_block)
 {
     if (item_type_.compare("gr_complex") == 0)
@@ -48,6 +48,11 @@ class ConfigurationInterface;
 /*!
 * \brief This class generates synthesized GNSS signal.
 *
+* Besides the satellites (SignalSource.num_satellites, .PRN_N, .CN0_dB_N...),
+* SignalSource.spoofer_replicas adds as many spoofing replicas. The replica
+* K copies the code and data bits of the satellite .spoofer_sat_K, with
+* .spoofer_delay_chips_K more chips of delay (an integer number of chips),
+* .spoofer_power_dB_K more C/N0 [3] and .spoofer_doppler_Hz_K more Doppler [0].
 */
 class SignalGenerator: public GNSSBlockInterface
 {
@@ -80,6 +85,15 @@ public:
     gr::basic_block_sptr get_right_block();
 
 private:
+    /*
+     * Schedules and navigation messages of the signals (the satellites,
+     * then the spoofing replicas), read from the properties
+     * <prefix><key><suffix> of each signal
+     */
+    void set_scenario(ConfigurationInterface* configuration, const std::vector<std::string>& system,
+            const std::vector<unsigned int>& PRN, const std::vector<unsigned int>& data_source,
+            const std::vector<std::string>& schedule_prefix, const std::vector<std::string>& schedule_suffix);
+
     std::string role_;
     unsigned int in_stream_;
     unsigned int out_stream_;
@@ -87,7 +101,7 @@ private:
     size_t item_size_;
     bool dump_;
     std::string dump_filename_;
-    boost::shared_ptr<gr::block> gen_source_;
+    signal_generator_c_sptr gen_source_;
     gr::blocks::vector_to_stream::sptr vector_to_stream_;
     gr::blocks::file_sink::sptr file_sink_;
     boost::shared_ptr<gr::msg_queue> queue_;
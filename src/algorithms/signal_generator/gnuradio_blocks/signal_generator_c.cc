@@ -29,6 +29,8 @@
 */
 
 #include "signal_generator_c.h"
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
@@ -50,19 +52,83 @@ signal_generator_c_sptr
 signal_make_generator_c (std::vector<std::string> signal1, std::vector<std::string> system, const std::vector<unsigned int> &PRN,
                     const std::vector<float> &CN0_dB, const std::vector<float> &doppler_Hz,
                     const std::vector<unsigned int> &delay_chips, const std::vector<unsigned int> &delay_sec,bool data_flag, bool noise_flag,
-                    unsigned int fs_in, unsigned int vector_length, float BW_BB)
+                    unsigned int fs_in, unsigned int vector_length, float BW_BB,
+                    const std::vector<unsigned int> &data_source)
 {
     return gnuradio::get_initial_sptr(new signal_generator_c(signal1, system, PRN, CN0_dB, doppler_Hz, delay_chips,delay_sec,
-                                                        data_flag, noise_flag, fs_in, vector_length, BW_BB));
+                                                        data_flag, noise_flag, fs_in, vector_length, BW_BB, data_source));
 }
 
+
+/*
+ * Next data bit of a satellite (splitmix64), +1 or -1. A replica seeded
+ * like its satellite sends the same sequence of bits.
+ */
+static int signal_generator_c_data_bit(unsigned long long &state)
+{
+    state += 0x9E3779B97F4A7C15ULL;
+    unsigned long long z = state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return ((z ^ (z >> 31)) >> 63) ? 1 : -1;
+}
+
+
+/*
+ * out += gain * in, a loop the compiler vectorizes
+ */
+static void signal_generator_c_accumulate(gr_complex* out, const gr_complex* in, float gain, unsigned int n)
+{
+    float* out_f = reinterpret_cast<float*>(out);
+    const float* in_f = reinterpret_cast<const float*>(in);
+    for (unsigned int i = 0; i < 2 * n; i++)
+        {
+            out_f[i] += gain * in_f[i];
+        }
+}
+
+double Signal_Generator_Schedule::amplitude(double t_s) const
+{
+    if (t_s < start_s || (stop_s > start_s && t_s >= stop_s))
+        {
+            return 0.0;
+        }
+    double power_dB = power_ramp_dB_per_s * (t_s - start_s);
+    if (power_ramp_max_dB > 0.0 && std::fabs(power_dB) > power_ramp_max_dB)
+        {
+            power_dB = std::copysign(power_ramp_max_dB, power_dB);
+        }
+    if (power_swing_period_s > 0.0)
+        {
+            power_dB += power_swing_dB * std::sin(GPS_TWO_PI * t_s / power_swing_period_s);
+        }
+    return std::pow(10.0, power_dB / 20.0);
+}
+
+
+double Signal_Generator_Schedule::delay_drift_chips(double t_s) const
+{
+    if (t_s < start_s)
+        {
+            return 0.0;
+        }
+    double drift = delay_drift_chips_per_s * (t_s - start_s);
+    if (delay_drift_max_chips > 0.0 && std::fabs(drift) > delay_drift_max_chips)
+        {
+            drift = std::copysign(delay_drift_max_chips, drift);
+        }
+    return drift;
+}
+
+
 /*
 * The private constructor
 */
 signal_generator_c::signal_generator_c (std::vector<std::string> signal1, std::vector<std::string> system, const std::vector<unsigned int> &PRN,
         const std::vector<float> &CN0_dB, const std::vector<float> &doppler_Hz,
         const std::vector<unsigned int> &delay_chips,const std::vector<unsigned int> &delay_sec ,bool data_flag, bool noise_flag,
-        unsigned int fs_in, unsigned int vector_length, float BW_BB) :
+        unsigned int fs_in, unsigned int vector_length, float BW_BB,
+        const std::vector<unsigned int> &data_source) :
              gr::block ("signal_gen_cc", gr::io_signature::make(0, 0, sizeof(gr_complex)),
                   gr::io_signature::make(1, 1, sizeof(gr_complex) * vector_length)),
                   signal_(signal1),
@@ -79,6 +145,14 @@ signal_generator_c::signal_generator_c (std::vector<std::string> signal1, std::v
                   vector_length_(vector_length),
                   BW_BB_(BW_BB * static_cast<float>(fs_in) / 2.0)
 {
+    for (unsigned int sat = 0; sat < num_sats_; sat++)
+        {
+            unsigned int source = (sat < data_source.size()) ? data_source.at(sat) : sat;
+            data_bit_state_.push_back(0x2545F4914F6CDD1DULL * (source + 1));
+        }
+    schedule_.resize(num_sats_);
+    navigation_message_.resize(num_sats_);
+    nav_edited_.assign(num_sats_, false);
     init();
     generate_codes();
 }
@@ -88,6 +162,8 @@ void signal_generator_c::init()
     work_counter_ = 0;
 
     complex_phase_ = static_cast<gr_complex*>(volk_malloc(vector_length_ * sizeof(gr_complex), volk_get_alignment()));
+    mixed_data_ = static_cast<gr_complex*>(volk_malloc(vector_length_ * sizeof(gr_complex), volk_get_alignment()));
+    mixed_pilot_ = static_cast<gr_complex*>(volk_malloc(vector_length_ * sizeof(gr_complex), volk_get_alignment()));
 
     // True if Galileo satellites are present
     bool galileo_signal = std::find(system_.begin(), system_.end(), "E") != system_.end();
@@ -130,7 +206,6 @@ void signal_generator_c::init()
                         }
                 }
         }
-    random_ = new gr::random();
 }
 
 
@@ -141,7 +216,8 @@ void signal_generator_c::generate_codes()
 
     for (unsigned int sat = 0; sat < num_sats_; sat++)
         {
-            sampled_code_data_[sat] = static_cast<gr_complex*>(std::malloc(vector_length_ * sizeof(gr_complex)));
+            // one more code period, read from a later start when the delay drifts
+            sampled_code_data_[sat] = static_cast<gr_complex*>(std::malloc((vector_length_ + samples_per_code_[sat]) * sizeof(gr_complex)));
 
             gr_complex code[64000]; //[samples_per_code_[sat]];
 
@@ -160,8 +236,8 @@ void signal_generator_c::generate_codes()
                                 }
                         }
 
-                    // Concatenate "num_of_codes_per_vector_" codes
-                    for (unsigned int i = 0; i < num_of_codes_per_vector_[sat]; i++)
+                    // Concatenate "num_of_codes_per_vector_" codes, and one more
+                    for (unsigned int i = 0; i <= num_of_codes_per_vector_[sat]; i++)
                         {
                             memcpy(&(sampled_code_data_[sat][i * samples_per_code_[sat]]),
                                     code, sizeof(gr_complex) * samples_per_code_[sat]);
@@ -234,6 +310,39 @@ void signal_generator_c::generate_codes()
 
 
 
+void signal_generator_c::set_schedule(unsigned int sat, const Signal_Generator_Schedule& schedule)
+{
+    schedule_.at(sat) = schedule;
+}
+
+
+void signal_generator_c::set_navigation_message(unsigned int sat, const Gps_Lnav_Encoder& encoder)
+{
+    navigation_message_.at(sat) = std::make_shared<Gps_Lnav_Encoder>(encoder);
+}
+
+
+int signal_generator_c::next_data_bit(unsigned int sat, double t_s)
+{
+    if (!navigation_message_[sat])
+        {
+            return signal_generator_c_data_bit(data_bit_state_[sat]);
+        }
+    const Signal_Generator_Schedule& schedule = schedule_[sat];
+    if (!nav_edited_[sat] && schedule.nav_edit_s >= 0.0 && t_s >= schedule.nav_edit_s)
+        {
+            // transmitted from the next subframe
+            if (schedule.edit_ephemeris)
+                {
+                    navigation_message_[sat]->set_ephemeris(schedule.edited_ephemeris);
+                }
+            navigation_message_[sat]->jump_tow(schedule.tow_jump_s);
+            nav_edited_[sat] = true;
+        }
+    return navigation_message_[sat]->next_bit();
+}
+
+
 signal_generator_c::~signal_generator_c()
 {
     /*  for (unsigned int sat = 0; sat < num_sats_; sat++)
@@ -245,7 +354,8 @@ signal_generator_c::~signal_generator_c()
                 }
         } */
     volk_free(complex_phase_);
-    delete random_;
+    volk_free(mixed_data_);
+    volk_free(mixed_pilot_);
 }
 
 
@@ -256,55 +366,64 @@ int signal_generator_c::general_work (int noutput_items __attribute__((unused)),
 {
     gr_complex *out = (gr_complex *) output_items[0];
 
+    // time of the first sample of the vector
+    const double t_s = static_cast<double>(work_counter_) * vector_length_ / fs_in_;
     work_counter_++;
 
     unsigned int out_idx = 0;
     unsigned int i = 0;
-    unsigned int k = 0;
 
-    for (out_idx = 0; out_idx < vector_length_; out_idx++)
-        {
-            out[out_idx] = gr_complex(0.0,0.0);
-        }
+    std::fill(out, out + vector_length_, gr_complex(0.0, 0.0));
 
     for (unsigned int sat = 0; sat < num_sats_; sat++)
         {
+            // a signal that is off keeps its phase, data bits and counters running
+            const float amplitude = static_cast<float>(schedule_[sat].amplitude(t_s));
+            const bool on = amplitude > 0.0f;
+            auto accumulate = [on, amplitude](gr_complex* out_samples, const gr_complex* in, float gain, unsigned int n)
+                {
+                    if (on) signal_generator_c_accumulate(out_samples, in, gain * amplitude, n);
+                };
             float phase_step_rad = -static_cast<float>(GPS_TWO_PI) * doppler_Hz_[sat] / static_cast<float>(fs_in_);
             float _phase[1];
             _phase[0] = -start_phase_rad_[sat];
-            volk_gnsssdr_s32f_sincos_32fc(complex_phase_, -phase_step_rad, _phase, vector_length_);
-            start_phase_rad_[sat] += vector_length_ * phase_step_rad;
+            if (on)
+                {
+                    volk_gnsssdr_s32f_nco_32fc(complex_phase_, -phase_step_rad, _phase, vector_length_);
+                }
+            // wrapped, so that the float phase keeps its resolution in long runs
+            start_phase_rad_[sat] = std::fmod(start_phase_rad_[sat] + vector_length_ * phase_step_rad, static_cast<float>(GPS_TWO_PI));
 
             out_idx = 0;
 
             if (system_[sat] == "G")
                 {
-                    unsigned int delay_samples = (delay_chips_[sat] % static_cast<int>(GPS_L1_CA_CODE_LENGTH_CHIPS))
-                                                            * samples_per_code_[sat] / GPS_L1_CA_CODE_LENGTH_CHIPS;
+                    // a drift of the delay reads the code table from a later start
+                    int samples_per_code = static_cast<int>(samples_per_code_[sat]);
+                    int drift_samples = static_cast<int>(std::floor(schedule_[sat].delay_drift_chips(t_s)
+                            * samples_per_code / GPS_L1_CA_CODE_LENGTH_CHIPS + 0.5));
+                    int shift = (drift_samples % samples_per_code + samples_per_code) % samples_per_code;
+                    unsigned int delay_samples = (static_cast<int>((delay_chips_[sat] % static_cast<int>(GPS_L1_CA_CODE_LENGTH_CHIPS))
+                                                            * samples_per_code_[sat] / GPS_L1_CA_CODE_LENGTH_CHIPS) + shift) % samples_per_code;
+                    if (on)
+                        {
+                            volk_32fc_x2_multiply_32fc(mixed_data_, sampled_code_data_[sat] + (samples_per_code - shift) % samples_per_code,
+                                    complex_phase_, vector_length_);
+                        }
 
                     for (i = 0; i < num_of_codes_per_vector_[sat]; i++)
                         {
-                            for (k = 0; k < delay_samples; k++)
-                                {
-                                    out[out_idx] += sampled_code_data_[sat][out_idx]
-                                                                            * current_data_bits_[sat]
-                                                                                                 * complex_phase_[out_idx];
-                                    out_idx++;
-                                }
+                            accumulate(out + out_idx, mixed_data_ + out_idx, current_data_bits_[sat].real(), delay_samples);
+                            out_idx += delay_samples;
 
                             if (ms_counter_[sat] == 0 && data_flag_)
                                 {
-                                    // New random data bit
-                                    current_data_bits_[sat] = gr_complex((rand() % 2) == 0 ? 1 : -1, 0);
+                                    // New data bit
+                                    current_data_bits_[sat] = gr_complex(next_data_bit(sat, t_s), 0);
                                 }
 
-                            for (k = delay_samples; k < samples_per_code_[sat]; k++)
-                                {
-                                    out[out_idx] += sampled_code_data_[sat][out_idx]
-                                                                            * current_data_bits_[sat]
-                                                                                                 * complex_phase_[out_idx];
-                                    out_idx++;
-                                }
+                            accumulate(out + out_idx, mixed_data_ + out_idx, current_data_bits_[sat].real(), samples_per_code_[sat] - delay_samples);
+                            out_idx += samples_per_code_[sat] - delay_samples;
 
                             ms_counter_[sat] = (ms_counter_[sat] + static_cast<int>(round(1e3*GPS_L1_CA_CODE_PERIOD)))
                                                         % data_bit_duration_ms_[sat];
@@ -319,59 +438,56 @@ int signal_generator_c::general_work (int noutput_items __attribute__((unused)),
                             int codelen = static_cast<int>(Galileo_E5a_CODE_LENGTH_CHIPS);
                             unsigned int delay_samples = (delay_chips_[sat] % codelen)
                                                   * samples_per_code_[sat] / codelen;
-                            for (k = 0; k < delay_samples; k++)
+                            // (I d + j Q p) is d times the code if p == d, or d times its conjugate otherwise
+                            if (on)
                                 {
-                                    out[out_idx] += (gr_complex(sampled_code_data_[sat][out_idx].real()*data_modulation_[sat],
-                                            sampled_code_data_[sat][out_idx].imag()*pilot_modulation_[sat]) )
-                                            * complex_phase_[out_idx];
-                                    out_idx++;
+                                    volk_32fc_x2_multiply_32fc(mixed_data_, sampled_code_data_[sat], complex_phase_, vector_length_);
+                                    volk_32fc_x2_multiply_conjugate_32fc(mixed_pilot_, complex_phase_, sampled_code_data_[sat], vector_length_);
                                 }
 
+                            accumulate(out, (data_modulation_[sat] == pilot_modulation_[sat]) ? mixed_data_ : mixed_pilot_,
+                                    data_modulation_[sat], delay_samples);
+                            out_idx = delay_samples;
+
                             if (ms_counter_[sat]%data_bit_duration_ms_[sat] == 0 && data_flag_)
                                 {
-                                    // New random data bit
-                                    current_data_bit_int_[sat] = (rand()%2) == 0 ? 1 : -1;
+                                    // New data bit
+                                    current_data_bit_int_[sat] = next_data_bit(sat, t_s);
                                 }
                             data_modulation_[sat] = current_data_bit_int_[sat] * (Galileo_E5a_I_SECONDARY_CODE.at((ms_counter_[sat]+delay_sec_[sat]) % 20) == '0' ? 1 : -1);
                             pilot_modulation_[sat] = (Galileo_E5a_Q_SECONDARY_CODE[PRN_[sat] - 1].at((ms_counter_[sat] + delay_sec_[sat]) % 100) == '0' ? 1 : -1);
 
                             ms_counter_[sat] = ms_counter_[sat] + static_cast<int>(round(1e3*GALILEO_E5a_CODE_PERIOD));
 
-                            for (k = delay_samples; k < samples_per_code_[sat]; k++)
-                                {
-                                    out[out_idx] += (gr_complex(sampled_code_data_[sat][out_idx].real() * data_modulation_[sat] ,
-                                            sampled_code_data_[sat][out_idx].imag() * pilot_modulation_[sat]) )
-                                            * complex_phase_[out_idx];
-                                    out_idx++;
-                                }
+                            accumulate(out + out_idx,
+                                    ((data_modulation_[sat] == pilot_modulation_[sat]) ? mixed_data_ : mixed_pilot_) + out_idx,
+                                    data_modulation_[sat], samples_per_code_[sat] - delay_samples);
                         }
                     else
                         {
                             unsigned int delay_samples = (delay_chips_[sat] % static_cast<int>(Galileo_E1_B_CODE_LENGTH_CHIPS))
                                                   * samples_per_code_[sat] / Galileo_E1_B_CODE_LENGTH_CHIPS;
+                            if (on)
+                                {
+                                    volk_32fc_x2_multiply_32fc(mixed_data_, sampled_code_data_[sat], complex_phase_, vector_length_);
+                                    volk_32fc_x2_multiply_32fc(mixed_pilot_, sampled_code_pilot_[sat], complex_phase_, vector_length_);
+                                }
+                            // the pilot does not depend on the data bits
+                            accumulate(out, mixed_pilot_, -1.0, vector_length_);
 
                             for (i = 0; i < num_of_codes_per_vector_[sat]; i++)
                                 {
-                                    for (k = 0; k < delay_samples; k++)
-                                        {
-                                            out[out_idx] += (sampled_code_data_[sat][out_idx] * current_data_bits_[sat]
-                                                                                                                   - sampled_code_pilot_[sat][out_idx]) * complex_phase_[out_idx];
-                                            out_idx++;
-                                        }
+                                    accumulate(out + out_idx, mixed_data_ + out_idx, current_data_bits_[sat].real(), delay_samples);
+                                    out_idx += delay_samples;
 
                                     if (ms_counter_[sat] == 0 && data_flag_)
                                         {
-                                            // New random data bit
-                                            current_data_bits_[sat] = gr_complex((rand() % 2) == 0 ? 1 : -1, 0);
+                                            // New data bit
+                                            current_data_bits_[sat] = gr_complex(next_data_bit(sat, t_s), 0);
                                         }
 
-                                    for (k = delay_samples; k < samples_per_code_[sat]; k++)
-                                        {
-                                            out[out_idx] += (sampled_code_data_[sat][out_idx] * current_data_bits_[sat]
-                                                                                                                   - sampled_code_pilot_[sat][out_idx])
-                                                                                                                   * complex_phase_[out_idx];
-                                            out_idx++;
-                                        }
+                                    accumulate(out + out_idx, mixed_data_ + out_idx, current_data_bits_[sat].real(), samples_per_code_[sat] - delay_samples);
+                                    out_idx += samples_per_code_[sat] - delay_samples;
 
                                     ms_counter_[sat] = (ms_counter_[sat] + static_cast<int>(round(1e3 * Galileo_E1_CODE_PERIOD))) % data_bit_duration_ms_[sat];
                                 }
@@ -381,10 +497,7 @@ int signal_generator_c::general_work (int noutput_items __attribute__((unused)),
 
     if (noise_flag_)
         {
-            for (out_idx = 0; out_idx < vector_length_; out_idx++)
-                {
-                    out[out_idx] += gr_complex(random_->gasdev(),random_->gasdev());
-                }
+            noise_.add_complex(out, vector_length_);
         }
 
     // Tell runtime system how many output items we produced.
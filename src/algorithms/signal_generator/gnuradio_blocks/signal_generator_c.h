@@ -31,12 +31,47 @@
 #ifndef GNSS_SDR_SIGNAL_GENERATOR_C_H
 #define GNSS_SDR_SIGNAL_GENERATOR_C_H
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <boost/scoped_array.hpp>
-#include <gnuradio/random.h>
 #include <gnuradio/block.h>
+#include "gaussian_noise.h"
 #include "gnss_signal.h"
+#include "gps_lnav_encoder.h"
+
+/*!
+ * \brief Changes of a signal of signal_generator_c during the run, times in
+ * seconds of generated signal
+ */
+struct Signal_Generator_Schedule
+{
+    Signal_Generator_Schedule() :
+        start_s(0.0), stop_s(0.0),
+        power_ramp_dB_per_s(0.0), power_ramp_max_dB(0.0),
+        power_swing_dB(0.0), power_swing_period_s(0.0),
+        delay_drift_chips_per_s(0.0), delay_drift_max_chips(0.0),
+        nav_edit_s(-1.0), tow_jump_s(0), edit_ephemeris(false)
+    {}
+
+    double start_s;                  //!< The signal is off before
+    double stop_s;                   //!< and from stop_s on, if it is later than start_s
+    double power_ramp_dB_per_s;      //!< Power change from start_s on
+    double power_ramp_max_dB;        //!< Largest change of the ramp, in magnitude, no limit if 0
+    double power_swing_dB;           //!< Amplitude of a sinusoidal change of the power (C/N0 pattern)
+    double power_swing_period_s;
+    double delay_drift_chips_per_s;  //!< Code delay change from start_s on (GPS L1 C/A), in whole samples
+    double delay_drift_max_chips;    //!< Largest change of the delay, in magnitude, no limit if 0
+    double nav_edit_s;               //!< Time of the navigation message edits (GPS L1 C/A), none if negative
+    int tow_jump_s;                  //!< Added to the transmitted TOW from nav_edit_s on
+    bool edit_ephemeris;             //!< If true, edited_ephemeris is transmitted from nav_edit_s on
+    Gps_Ephemeris edited_ephemeris;
+
+    //! Amplitude gain at time t_s, 0 while the signal is off
+    double amplitude(double t_s) const;
+    //! Delay added at time t_s [chips]
+    double delay_drift_chips(double t_s) const;
+};
 
 class signal_generator_c;
 
@@ -63,12 +98,27 @@ signal_generator_c_sptr
 signal_make_generator_c (std::vector<std::string> signal1, std::vector<std::string> system, const std::vector<unsigned int> &PRN,
                     const std::vector<float> &CN0_dB, const std::vector<float> &doppler_Hz,
                     const std::vector<unsigned int> &delay_chips,const std::vector<unsigned int> &delay_sec, bool data_flag, bool noise_flag,
-                    unsigned int fs_in, unsigned int vector_length, float BW_BB);
+                    unsigned int fs_in, unsigned int vector_length, float BW_BB,
+                    const std::vector<unsigned int> &data_source = std::vector<unsigned int>());
 
 /*!
 * \brief This class generates synthesized GNSS signal.
 * \ingroup block
 *
+* The carrier of each satellite comes from volk_gnsssdr_s32f_nco_32fc,
+* and is mixed with the sampled code tables of the satellite, computed
+* once in the constructor, with VOLK multiplies. The data bits are then
+* applied as gains of whole code periods, and the noise comes from
+* Gaussian_Noise, so a vector costs a few passes over the samples per
+* satellite. data_source[sat] is the satellite whose data bits sat
+* transmits (itself by default): a spoofing replica of a satellite, with
+* its own delay, Doppler and power, sends the same navigation message.
+*
+* The power, delay and navigation message of each signal can change along
+* the run (set_schedule()), and the GPS L1 C/A satellites can transmit a
+* real navigation message (set_navigation_message()) instead of random
+* bits, to synthesize spoofing scenarios.
+*
 * \sa gen_source for a version that subclasses gr_block.
 */
 class signal_generator_c : public gr::block
@@ -82,15 +132,18 @@ private:
     signal_make_generator_c (std::vector<std::string> signal1, std::vector<std::string> system, const std::vector<unsigned int> &PRN,
             const std::vector<float> &CN0_dB, const std::vector<float> &doppler_Hz,
             const std::vector<unsigned int> &delay_chips,const std::vector<unsigned int> &delay_sec, bool data_flag, bool noise_flag,
-            unsigned int fs_in, unsigned int vector_length, float BW_BB);
+            unsigned int fs_in, unsigned int vector_length, float BW_BB,
+            const std::vector<unsigned int> &data_source);
 
     signal_generator_c (std::vector<std::string> signal1, std::vector<std::string> system, const std::vector<unsigned int> &PRN,
             const std::vector<float> &CN0_dB, const std::vector<float> &doppler_Hz,
             const std::vector<unsigned int> &delay_chips,const std::vector<unsigned int> &delay_sec, bool data_flag, bool noise_flag,
-            unsigned int fs_in, unsigned int vector_length, float BW_BB);
+            unsigned int fs_in, unsigned int vector_length, float BW_BB,
+            const std::vector<unsigned int> &data_source);
 
     void init();
     void generate_codes();
+    int next_data_bit(unsigned int sat, double t_s);
 
     std::vector<std::string> signal_;
     std::vector<std::string> system_;
@@ -116,16 +169,35 @@ private:
     std::vector<signed int> data_modulation_;
     std::vector<signed int> pilot_modulation_;
 
+    std::vector<unsigned long long> data_bit_state_; // seeded from the data source of each satellite
+    std::vector<Signal_Generator_Schedule> schedule_;
+    std::vector<std::shared_ptr<Gps_Lnav_Encoder> > navigation_message_;  // none for random bits
+    std::vector<bool> nav_edited_;
+
     boost::scoped_array<gr_complex*> sampled_code_data_;
     boost::scoped_array<gr_complex*> sampled_code_pilot_;
-    gr::random* random_;
+    Gaussian_Noise noise_;
     gr_complex* complex_phase_;
+    gr_complex* mixed_data_;  // code times carrier of the current satellite
+    gr_complex* mixed_pilot_;
 
     unsigned int work_counter_;
 
 public:
     ~signal_generator_c();    // public destructor
 
+    /*!
+     * \brief Power, delay and navigation message changes of signal sat,
+     * set before the flowgraph starts
+     */
+    void set_schedule(unsigned int sat, const Signal_Generator_Schedule& schedule);
+
+    /*!
+     * \brief Data bits of the GPS L1 C/A signal sat, from the first
+     * subframe of encoder on, set before the flowgraph starts
+     */
+    void set_navigation_message(unsigned int sat, const Gps_Lnav_Encoder& encoder);
+
     // Where all the action really happens
 
     int general_work (int noutput_items,
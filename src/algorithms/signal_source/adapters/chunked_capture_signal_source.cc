@@ -0,0 +1,225 @@
+/*!
+ * \file chunked_capture_signal_source.cc
+ * \brief Implementation of a class that reads the samples of a chunked
+ * capture file and adapts it to a SignalSourceInterface
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "chunked_capture_signal_source.h"
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include "gnss_sdr_valve.h"
+#include "configuration_interface.h"
+
+using google::LogMessage;
+
+DEFINE_string(chunked_capture_signal_source, "-",
+        "If defined, path to the chunked capture file containing the signal samples (overrides the configuration file)");
+
+
+ChunkedCaptureSignalSource::ChunkedCaptureSignalSource(ConfigurationInterface* configuration,
+        std::string role, unsigned int in_streams, unsigned int out_streams,
+        boost::shared_ptr<gr::msg_queue> queue) :
+                        role_(role), in_streams_(in_streams), out_streams_(out_streams), queue_(queue)
+{
+    std::string default_filename = "./example_capture.ccap";
+    std::string default_dump_filename = "./my_capture.dat";
+
+    samples_ = configuration->property(role + ".samples", 0);
+    filename_ = configuration->property(role + ".filename", default_filename);
+
+    // override value with commandline flag, if present
+    if (FLAGS_chunked_capture_signal_source.compare("-") != 0) filename_= FLAGS_chunked_capture_signal_source;
+
+    repeat_ = configuration->property(role + ".repeat", false);
+    dump_ = configuration->property(role + ".dump", false);
+    dump_filename_ = configuration->property(role + ".dump_filename", default_dump_filename);
+    enable_throttle_control_ = configuration->property(role + ".enable_throttle_control", false);
+    double seconds_to_skip = configuration->property(role + ".seconds_to_skip", 0.0);
+    unsigned int decoding_threads = configuration->property(role + ".decoding_threads", 2);
+
+    // the type and the rate are stored in the file: read them before the skipped values can be computed
+    Chunked_Capture_Reader reader;
+    if (!reader.open(filename_))
+        {
+            std::cerr
+            << "The receiver was configured to work with a chunked capture signal source "
+            << std::endl
+            << "but the specified file is unreachable by GNSS-SDR or is not a chunked capture."
+            << std::endl
+            <<  "Please modify your configuration file"
+            << std::endl
+            <<  "and point SignalSource.filename to a file written by capture-pack. Then:"
+            << std::endl
+            << "$ gnss-sdr --config_file=/path/to/my_GNSS_SDR_configuration.conf"
+            << std::endl;
+            LOG(WARNING) << "chunked_capture_signal_source: Unable to open the samples file "
+                         << filename_.c_str() << ", exiting the program.";
+            throw std::runtime_error("chunked_capture_signal_source: unable to open " + filename_);
+        }
+    Chunked_Capture_Header header = reader.header();
+    reader.close();
+    item_type_ = chunked_capture_item_type(header);
+    item_size_ = header.value_bytes;
+    std::string configured_item_type = configuration->property(role + ".item_type", item_type_);
+    if (configured_item_type.compare(item_type_) != 0)
+        {
+            LOG(WARNING) << role << ".item_type=" << configured_item_type << " ignored: " << filename_
+                         << " holds " << item_type_ << " samples";
+        }
+    sampling_frequency_ = configuration->property(role + ".sampling_frequency", static_cast<long>(header.sampling_frequency));
+    if (static_cast<double>(sampling_frequency_) != header.sampling_frequency)
+        {
+            LOG(WARNING) << role << ".sampling_frequency=" << sampling_frequency_ << " differs from the "
+                         << header.sampling_frequency << " Hz stored in " << filename_;
+        }
+
+    unsigned long long values_to_skip = 0;
+    if (seconds_to_skip > 0)
+        {
+            values_to_skip = static_cast<unsigned long long>(seconds_to_skip * sampling_frequency_);
+            if (header.is_complex)
+                {
+                    values_to_skip *= 2;
+                }
+        }
+    try
+    {
+            source_ = make_chunked_capture_source(filename_, repeat_, values_to_skip, decoding_threads);
+    }
+    catch (const std::exception &e)
+    {
+            LOG(WARNING) << "chunked_capture_signal_source: " << e.what();
+            throw;
+    }
+    DLOG(INFO) << "chunked_capture_source(" << source_->unique_id() << ")";
+
+    if (samples_ == 0) // read all file
+        {
+            // the exact number of values is in the header, and the source stops at the end of the file
+            samples_ = header.total_values - values_to_skip;
+        }
+
+    CHECK(samples_ > 0) << "File does not contain enough samples to process.";
+    double signal_duration_s = static_cast<double>(samples_) * (1 / static_cast<double>(sampling_frequency_));
+    if (header.is_complex)
+        {
+            signal_duration_s /= 2.0;
+        }
+    DLOG(INFO) << "Total number samples to be processed= " << samples_ << " GNSS signal duration= " << signal_duration_s << " [s]";
+    std::cout << "GNSS signal recorded time to be processed: " << signal_duration_s << " [s]" << std::endl;
+
+    valve_ = gnss_sdr_make_valve(item_size_, samples_, queue_);
+    DLOG(INFO) << "valve(" << valve_->unique_id() << ")";
+
+    if (dump_)
+        {
+            sink_ = gr::blocks::file_sink::make(item_size_, dump_filename_.c_str());
+            DLOG(INFO) << "file_sink(" << sink_->unique_id() << ")";
+        }
+
+    if (enable_throttle_control_)
+        {
+            throttle_ = gr::blocks::throttle::make(item_size_, sampling_frequency_);
+        }
+    DLOG(INFO) << "Chunked capture filename " << filename_;
+    DLOG(INFO) << "Samples " << samples_;
+    DLOG(INFO) << "Sampling frequency " << sampling_frequency_;
+    DLOG(INFO) << "Item type " << item_type_;
+    DLOG(INFO) << "Item size " << item_size_;
+    DLOG(INFO) << "Repeat " << repeat_;
+    DLOG(INFO) << "Dump " << dump_;
+    DLOG(INFO) << "Dump filename " << dump_filename_;
+}
+
+
+
+
+ChunkedCaptureSignalSource::~ChunkedCaptureSignalSource()
+{}
+
+
+
+
+void ChunkedCaptureSignalSource::connect(gr::top_block_sptr top_block)
+{
+    gr::basic_block_sptr last = source_;
+    if (enable_throttle_control_ == true)
+        {
+            top_block->connect(last, 0, throttle_, 0);
+            DLOG(INFO) << "connected chunked capture source to throttle";
+            last = throttle_;
+        }
+    top_block->connect(last, 0, valve_, 0);
+    DLOG(INFO) << "connected chunked capture source to valve";
+    if (dump_)
+        {
+            top_block->connect(valve_, 0, sink_, 0);
+            DLOG(INFO) << "connected valve to file sink";
+        }
+}
+
+
+
+
+void ChunkedCaptureSignalSource::disconnect(gr::top_block_sptr top_block)
+{
+    gr::basic_block_sptr last = source_;
+    if (enable_throttle_control_ == true)
+        {
+            top_block->disconnect(last, 0, throttle_, 0);
+            DLOG(INFO) << "disconnected chunked capture source to throttle";
+            last = throttle_;
+        }
+    top_block->disconnect(last, 0, valve_, 0);
+    DLOG(INFO) << "disconnected chunked capture source to valve";
+    if (dump_)
+        {
+            top_block->disconnect(valve_, 0, sink_, 0);
+            DLOG(INFO) << "disconnected valve to file sink";
+        }
+}
+
+
+
+
+gr::basic_block_sptr ChunkedCaptureSignalSource::get_left_block()
+{
+    LOG(WARNING) << "Left block of a signal source should not be retrieved";
+    return gr::block_sptr();
+}
+
+
+
+
+gr::basic_block_sptr ChunkedCaptureSignalSource::get_right_block()
+{
+    return valve_;
+}
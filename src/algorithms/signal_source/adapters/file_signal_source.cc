@@ -40,6 +40,7 @@
 #include <glog/logging.h>
 #include <volk/volk.h>
 #include "gnss_sdr_valve.h"
+#include "mmap_file_source.h"
 #include "configuration_interface.h"
 
 using google::LogMessage;
@@ -72,6 +73,8 @@ FileSignalSource::FileSignalSource(ConfigurationInterface* configuration,
     dump_ = configuration->property(role + ".dump", false);
     dump_filename_ = configuration->property(role + ".dump_filename", default_dump_filename);
     enable_throttle_control_ = configuration->property(role + ".enable_throttle_control", false);
+    bool use_mmap = configuration->property(role + ".use_mmap", false);
+    bool mmap_huge_pages = configuration->property(role + ".mmap_huge_pages", false);
     std::string s = "InputFilter";
     //double IF = configuration->property(s + ".IF", 0.0);
     double seconds_to_skip = configuration->property(role + ".seconds_to_skip", default_seconds_to_skip );
@@ -114,8 +117,6 @@ FileSignalSource::FileSignalSource(ConfigurationInterface* configuration,
         }
     try
     {
-            file_source_ = gr::blocks::file_source::make(item_size_, filename_.c_str(), repeat_);
-
             if( seconds_to_skip > 0 )
             {
                 samples_to_skip = static_cast< long >(
@@ -131,12 +132,22 @@ FileSignalSource::FileSignalSource(ConfigurationInterface* configuration,
                 samples_to_skip += header_size;
             }
 
-            if( samples_to_skip > 0 )
+            if( use_mmap )
+            {
+                // the skipped samples are just an offset into the mapping
+                source_ = make_mmap_file_source(item_size_, filename_, repeat_, samples_to_skip, mmap_huge_pages);
+            }
+            else
             {
-                LOG(INFO) << "Skipping " << samples_to_skip << " samples of the input file";
-                if( not file_source_->seek( samples_to_skip, SEEK_SET ) )
+                file_source_ = gr::blocks::file_source::make(item_size_, filename_.c_str(), repeat_);
+                source_ = file_source_;
+                if( samples_to_skip > 0 )
                 {
-                    LOG(INFO) << "Error skipping bytes!";
+                    LOG(INFO) << "Skipping " << samples_to_skip << " samples of the input file";
+                    if( not file_source_->seek( samples_to_skip, SEEK_SET ) )
+                    {
+                        LOG(INFO) << "Error skipping bytes!";
+                    }
                 }
             }
 
@@ -180,7 +191,7 @@ FileSignalSource::FileSignalSource(ConfigurationInterface* configuration,
             throw(e);
     }
 
-    DLOG(INFO) << "file_source(" << file_source_->unique_id() << ")";
+    DLOG(INFO) << "file_source(" << source_->unique_id() << ")";
 
     if (samples_ == 0) // read all file
         {
@@ -264,7 +275,7 @@ void FileSignalSource::connect(gr::top_block_sptr top_block)
         {
             if (enable_throttle_control_ == true)
                 {
-                    top_block->connect(file_source_, 0, throttle_, 0);
+                    top_block->connect(source_, 0, throttle_, 0);
                     DLOG(INFO) << "connected file source to throttle";
                     top_block->connect(throttle_, 0, valve_, 0);
                     DLOG(INFO) << "connected throttle to valve";
@@ -276,7 +287,7 @@ void FileSignalSource::connect(gr::top_block_sptr top_block)
                 }
             else
                 {
-                    top_block->connect(file_source_, 0, valve_, 0);
+                    top_block->connect(source_, 0, valve_, 0);
                     DLOG(INFO) << "connected file source to valve";
                     if (dump_)
                         {
@@ -289,11 +300,11 @@ void FileSignalSource::connect(gr::top_block_sptr top_block)
         {
             if (enable_throttle_control_ == true)
                 {
-                    top_block->connect(file_source_, 0, throttle_, 0);
+                    top_block->connect(source_, 0, throttle_, 0);
                     DLOG(INFO) << "connected file source to throttle";
                     if (dump_)
                         {
-                            top_block->connect(file_source_, 0, sink_, 0);
+                            top_block->connect(source_, 0, sink_, 0);
                             DLOG(INFO) << "connected file source to sink";
                         }
                 }
@@ -301,7 +312,7 @@ void FileSignalSource::connect(gr::top_block_sptr top_block)
                 {
                     if (dump_)
                         {
-                            top_block->connect(file_source_, 0, sink_, 0);
+                            top_block->connect(source_, 0, sink_, 0);
                             DLOG(INFO) << "connected file source to sink";
                         }
                 }
@@ -319,7 +330,7 @@ void FileSignalSource::disconnect(gr::top_block_sptr top_block)
         {
             if (enable_throttle_control_ == true)
                 {
-                    top_block->disconnect(file_source_, 0, throttle_, 0);
+                    top_block->disconnect(source_, 0, throttle_, 0);
                     DLOG(INFO) << "disconnected file source to throttle";
                     top_block->disconnect(throttle_, 0, valve_, 0);
                     DLOG(INFO) << "disconnected throttle to valve";
@@ -331,7 +342,7 @@ void FileSignalSource::disconnect(gr::top_block_sptr top_block)
                 }
             else
                 {
-                    top_block->disconnect(file_source_, 0, valve_, 0);
+                    top_block->disconnect(source_, 0, valve_, 0);
                     DLOG(INFO) << "disconnected file source to valve";
                     if (dump_)
                         {
@@ -344,11 +355,11 @@ void FileSignalSource::disconnect(gr::top_block_sptr top_block)
         {
             if (enable_throttle_control_ == true)
                 {
-                    top_block->disconnect(file_source_, 0, throttle_, 0);
+                    top_block->disconnect(source_, 0, throttle_, 0);
                     DLOG(INFO) << "disconnected file source to throttle";
                     if (dump_)
                         {
-                            top_block->disconnect(file_source_, 0, sink_, 0);
+                            top_block->disconnect(source_, 0, sink_, 0);
                             DLOG(INFO) << "disconnected file source to sink";
                         }
                 }
@@ -356,7 +367,7 @@ void FileSignalSource::disconnect(gr::top_block_sptr top_block)
                 {
                     if (dump_)
                         {
-                            top_block->disconnect(file_source_, 0, sink_, 0);
+                            top_block->disconnect(source_, 0, sink_, 0);
                             DLOG(INFO) << "disconnected file source to sink";
                         }
                 }
@@ -391,7 +402,7 @@ gr::basic_block_sptr FileSignalSource::get_right_block()
                 }
             else
                 {
-                    return file_source_;
+                    return source_;
                 }
         }
 }
@@ -111,6 +111,7 @@ private:
     unsigned int in_streams_;
     unsigned int out_streams_;
     gr::blocks::file_source::sptr file_source_;
+    gr::block_sptr source_; // file_source_, or the mmap_file_source if use_mmap is set
     boost::shared_ptr<gr::block> valve_;
     gr::blocks::file_sink::sptr sink_;
     gr::blocks::throttle::sptr  throttle_;
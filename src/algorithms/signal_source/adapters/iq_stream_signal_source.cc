@@ -0,0 +1,178 @@
+/*!
+ * \file iq_stream_signal_source.cc
+ * \brief Implementation of a class that receives the I/Q stream of a remote
+ * front end and adapts it to a SignalSourceInterface
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "iq_stream_signal_source.h"
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <glog/logging.h>
+#include "gnss_sdr_valve.h"
+#include "configuration_interface.h"
+
+using google::LogMessage;
+
+
+IqStreamSignalSource::IqStreamSignalSource(ConfigurationInterface* configuration,
+        std::string role, unsigned int in_streams, unsigned int out_streams,
+        boost::shared_ptr<gr::msg_queue> queue) :
+                        role_(role), in_streams_(in_streams), out_streams_(out_streams), queue_(queue)
+{
+    std::string default_dump_filename = "./my_capture.dat";
+
+    samples_ = configuration->property(role + ".samples", 0);
+    sampling_frequency_ = configuration->property(role + ".sampling_frequency", 4000000);
+    protocol_ = configuration->property(role + ".protocol", std::string("tcp"));
+    address_ = configuration->property(role + ".address", std::string("127.0.0.1"));
+    port_ = configuration->property(role + ".port", 1235);
+    bits_ = configuration->property(role + ".bits", 8);
+    double jitter_ms = configuration->property(role + ".jitter_ms", 50.0);
+    dump_ = configuration->property(role + ".dump", false);
+    dump_filename_ = configuration->property(role + ".dump_filename", default_dump_filename);
+
+    // the type follows from the width of the stream
+    item_type_ = iq_stream_item_type(bits_);
+    item_size_ = iq_stream_value_bytes(bits_);
+    std::string configured_item_type = configuration->property(role + ".item_type", item_type_);
+    if (configured_item_type.compare(item_type_) != 0)
+        {
+            LOG(WARNING) << role << ".item_type=" << configured_item_type << " ignored: a stream of "
+                         << bits_ << " bits is output as " << item_type_;
+        }
+
+    unsigned long long jitter_samples = static_cast<unsigned long long>(jitter_ms * 1e-3 * sampling_frequency_);
+    try
+    {
+            source_ = make_iq_stream_source(protocol_, address_, port_, bits_, jitter_samples);
+    }
+    catch (const std::exception &e)
+    {
+            std::cerr
+            << "The receiver was configured to work with an I/Q stream signal source "
+            << std::endl
+            << "but " << e.what()
+            << std::endl
+            <<  "Please check " << role << ".protocol, " << role << ".address, " << role << ".port and " << role << ".bits."
+            << std::endl;
+            LOG(WARNING) << "iq_stream_signal_source: " << e.what();
+            throw;
+    }
+    DLOG(INFO) << "iq_stream_source(" << source_->unique_id() << ")";
+
+    if (samples_ > 0)
+        {
+            // the items are the I and Q values
+            valve_ = gnss_sdr_make_valve(item_size_, 2 * samples_, queue_);
+            DLOG(INFO) << "valve(" << valve_->unique_id() << ")";
+        }
+
+    if (dump_)
+        {
+            sink_ = gr::blocks::file_sink::make(item_size_, dump_filename_.c_str());
+            DLOG(INFO) << "file_sink(" << sink_->unique_id() << ")";
+        }
+    DLOG(INFO) << "Protocol " << protocol_;
+    DLOG(INFO) << "Address " << address_ << ":" << port_;
+    DLOG(INFO) << "Bits " << bits_;
+    DLOG(INFO) << "Jitter buffer " << jitter_samples << " samples";
+    DLOG(INFO) << "Samples " << samples_;
+    DLOG(INFO) << "Sampling frequency " << sampling_frequency_;
+    DLOG(INFO) << "Item type " << item_type_;
+    DLOG(INFO) << "Item size " << item_size_;
+    DLOG(INFO) << "Dump " << dump_;
+    DLOG(INFO) << "Dump filename " << dump_filename_;
+}
+
+
+
+
+IqStreamSignalSource::~IqStreamSignalSource()
+{
+    if (source_)
+        {
+            LOG(INFO) << "iq_stream_signal_source: " << source_->lost_samples() << " samples lost, "
+                      << source_->late_blocks() << " blocks late, " << source_->bad_blocks() << " blocks corrupt";
+        }
+}
+
+
+
+
+void IqStreamSignalSource::connect(gr::top_block_sptr top_block)
+{
+    if (valve_)
+        {
+            top_block->connect(source_, 0, valve_, 0);
+            DLOG(INFO) << "connected I/Q stream source to valve";
+        }
+    if (dump_)
+        {
+            top_block->connect(get_right_block(), 0, sink_, 0);
+            DLOG(INFO) << "connected I/Q stream source to file sink";
+        }
+}
+
+
+
+
+void IqStreamSignalSource::disconnect(gr::top_block_sptr top_block)
+{
+    if (valve_)
+        {
+            top_block->disconnect(source_, 0, valve_, 0);
+            DLOG(INFO) << "disconnected I/Q stream source to valve";
+        }
+    if (dump_)
+        {
+            top_block->disconnect(get_right_block(), 0, sink_, 0);
+            DLOG(INFO) << "disconnected I/Q stream source to file sink";
+        }
+}
+
+
+
+
+gr::basic_block_sptr IqStreamSignalSource::get_left_block()
+{
+    LOG(WARNING) << "Left block of a signal source should not be retrieved";
+    return gr::block_sptr();
+}
+
+
+
+
+gr::basic_block_sptr IqStreamSignalSource::get_right_block()
+{
+    if (valve_)
+        {
+            return valve_;
+        }
+    return source_;
+}
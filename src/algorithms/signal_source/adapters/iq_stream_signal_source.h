@@ -0,0 +1,122 @@
+/*!
+ * \file iq_stream_signal_source.h
+ * \brief Interface of a class that receives the I/Q stream of a remote
+ * front end and adapts it to a SignalSourceInterface
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_IQ_STREAM_SIGNAL_SOURCE_H_
+#define GNSS_SDR_IQ_STREAM_SIGNAL_SOURCE_H_
+
+#include <string>
+#include <gnuradio/blocks/file_sink.h>
+#include <gnuradio/msg_queue.h>
+#include "gnss_block_interface.h"
+#include "iq_stream_source.h"
+
+
+class ConfigurationInterface;
+
+/*!
+ * \brief Class that receives the I/Q stream that the iq-streamer utility
+ * sends from a remote front end, and adapts it to a SignalSourceInterface.
+ *
+ * The output is ibyte items for streams of 2, 4 and 8 bits per value and
+ * ishort items for 16 bits, so that the signal conditioner takes them
+ * as they are. The samples of the lost blocks are zeros (see
+ * iq_stream_source).
+ */
+class IqStreamSignalSource: public GNSSBlockInterface
+{
+public:
+    IqStreamSignalSource(ConfigurationInterface* configuration, std::string role,
+            unsigned int in_streams, unsigned int out_streams,
+            boost::shared_ptr<gr::msg_queue> queue);
+
+    virtual ~IqStreamSignalSource();
+    std::string role()
+    {
+        return role_;
+    }
+
+    /*!
+     * \brief Returns "Iq_Stream_Signal_Source".
+     */
+    std::string implementation()
+    {
+        return "Iq_Stream_Signal_Source";
+    }
+    size_t item_size()
+    {
+        return item_size_;
+    }
+    void connect(gr::top_block_sptr top_block);
+    void disconnect(gr::top_block_sptr top_block);
+    gr::basic_block_sptr get_left_block();
+    gr::basic_block_sptr get_right_block();
+    std::string address()
+    {
+        return address_;
+    }
+    unsigned short port()
+    {
+        return port_;
+    }
+    std::string item_type()
+    {
+        return item_type_;
+    }
+    long sampling_frequency()
+    {
+        return sampling_frequency_;
+    }
+    long samples()
+    {
+        return samples_;
+    }
+
+private:
+    unsigned long long samples_;
+    long sampling_frequency_;
+    std::string protocol_;
+    std::string address_;
+    unsigned short port_;
+    unsigned int bits_;
+    std::string item_type_;
+    bool dump_;
+    std::string dump_filename_;
+    std::string role_;
+    unsigned int in_streams_;
+    unsigned int out_streams_;
+    iq_stream_source_sptr source_;
+    boost::shared_ptr<gr::block> valve_;
+    gr::blocks::file_sink::sptr sink_;
+    boost::shared_ptr<gr::msg_queue> queue_;
+    size_t item_size_;
+};
+
+#endif /*GNSS_SDR_IQ_STREAM_SIGNAL_SOURCE_H_*/
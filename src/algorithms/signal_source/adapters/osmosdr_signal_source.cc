@@ -36,6 +36,7 @@
 #include <gnuradio/blocks/file_sink.h>
 #include "configuration_interface.h"
 #include "gnss_sdr_valve.h"
+#include "rx_time_gap_filler.h"
 #include "GPS_L1_CA.h"
 
 
@@ -66,6 +67,8 @@ OsmosdrSignalSource::OsmosdrSignalSource(ConfigurationInterface* configuration,
     sample_rate_ = configuration->property(role + ".sampling_frequency", (double)2.0e6);
     item_type_ = configuration->property(role + ".item_type", default_item_type);
     osmosdr_args_ = configuration->property(role + ".osmosdr_args", std::string( ));
+    // only the devices that tag their samples with rx_time (UHD) can fill the gaps of their overflows
+    fill_gaps_ = configuration->property(role + ".fill_gaps", false);
 
     if (item_type_.compare("short") == 0)
         {
@@ -126,6 +129,12 @@ OsmosdrSignalSource::OsmosdrSignalSource(ConfigurationInterface* configuration,
             item_size_ = sizeof(short);
         }
 
+    if (fill_gaps_ && osmosdr_source_)
+        {
+            gap_filler_ = make_rx_time_gap_filler(item_size_, osmosdr_source_->get_sample_rate());
+            DLOG(INFO) << "gap_filler(" << gap_filler_->unique_id() << ")";
+        }
+
     if (samples_ != 0)
         {
             DLOG(INFO) << "Send STOP signal after " << samples_ << " samples";
@@ -150,9 +159,16 @@ OsmosdrSignalSource::~OsmosdrSignalSource()
 
 void OsmosdrSignalSource::connect(gr::top_block_sptr top_block)
 {
+    gr::basic_block_sptr source = osmosdr_source_;
+    if (gap_filler_)
+        {
+            top_block->connect(osmosdr_source_, 0, gap_filler_, 0);
+            DLOG(INFO) << "connected osmosdr source to gap filler";
+            source = gap_filler_;
+        }
     if (samples_ != 0)
         {
-            top_block->connect(osmosdr_source_, 0, valve_, 0);
+            top_block->connect(source, 0, valve_, 0);
             DLOG(INFO) << "connected osmosdr source to valve";
             if (dump_)
                 {
@@ -164,7 +180,7 @@ void OsmosdrSignalSource::connect(gr::top_block_sptr top_block)
         {
             if (dump_)
                 {
-                    top_block->connect(osmosdr_source_, 0, file_sink_, 0);
+                    top_block->connect(source, 0, file_sink_, 0);
                     DLOG(INFO) << "connected osmosdr source to file sink";
                 }
         }
@@ -174,9 +190,15 @@ void OsmosdrSignalSource::connect(gr::top_block_sptr top_block)
 
 void OsmosdrSignalSource::disconnect(gr::top_block_sptr top_block)
 {
+    gr::basic_block_sptr source = osmosdr_source_;
+    if (gap_filler_)
+        {
+            top_block->disconnect(osmosdr_source_, 0, gap_filler_, 0);
+            source = gap_filler_;
+        }
     if (samples_ != 0)
         {
-            top_block->disconnect(osmosdr_source_, 0, valve_, 0);
+            top_block->disconnect(source, 0, valve_, 0);
             if (dump_)
                 {
                     top_block->disconnect(valve_, 0, file_sink_, 0);
@@ -186,7 +208,7 @@ void OsmosdrSignalSource::disconnect(gr::top_block_sptr top_block)
         {
             if (dump_)
                 {
-                    top_block->disconnect(osmosdr_source_, 0, file_sink_, 0);
+                    top_block->disconnect(source, 0, file_sink_, 0);
                 }
         }
 }
@@ -207,6 +229,10 @@ gr::basic_block_sptr OsmosdrSignalSource::get_right_block()
         {
             return valve_;
         }
+    else if (gap_filler_)
+        {
+            return gap_filler_;
+        }
     else
         {
             return osmosdr_source_;
@@ -39,6 +39,7 @@
 #include <gnuradio/blocks/file_sink.h>
 #include <osmosdr/source.h>
 #include "gnss_block_interface.h"
+#include "rx_time_gap_filler.h"
 
 class ConfigurationInterface;
 
@@ -101,6 +102,8 @@ private:
 
     osmosdr::source::sptr osmosdr_source_;
     std::string osmosdr_args_;
+    bool fill_gaps_;
+    rx_time_gap_filler_sptr gap_filler_;
 
     boost::shared_ptr<gr::block> valve_;
     gr::blocks::file_sink::sptr file_sink_;
@@ -0,0 +1,178 @@
+/*!
+ * \file shared_ring_signal_source.cc
+ * \brief Implementation of a class that reads the samples a sample server
+ * publishes in a shared sample ring and adapts it to a SignalSourceInterface
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "shared_ring_signal_source.h"
+#include <iostream>
+#include <stdexcept>
+#include <glog/logging.h>
+#include "gnss_sdr_valve.h"
+#include "configuration_interface.h"
+
+using google::LogMessage;
+
+
+SharedRingSignalSource::SharedRingSignalSource(ConfigurationInterface* configuration,
+        std::string role, unsigned int in_streams, unsigned int out_streams,
+        boost::shared_ptr<gr::msg_queue> queue) :
+                        role_(role), in_streams_(in_streams), out_streams_(out_streams), queue_(queue)
+{
+    std::string default_ring_filename = "/dev/shm/gnss-sdr-samples";
+    std::string default_dump_filename = "./my_capture.dat";
+
+    samples_ = configuration->property(role + ".samples", 0);
+    ring_filename_ = configuration->property(role + ".ring_filename", default_ring_filename);
+    dump_ = configuration->property(role + ".dump", false);
+    dump_filename_ = configuration->property(role + ".dump_filename", default_dump_filename);
+
+    ring_ = std::make_shared<Shared_Sample_Ring>(ring_filename_);
+    if (!ring_->is_open())
+        {
+            std::cerr
+            << "The receiver was configured to work with a shared ring signal source "
+            << std::endl
+            << "but there is no sample server publishing in " << ring_filename_ << "."
+            << std::endl
+            <<  "Please start it first with the same ring file:"
+            << std::endl
+            << "$ sample-server --config_file=/path/to/my_front_end.conf --ring_filename=" << ring_filename_
+            << std::endl;
+            LOG(WARNING) << "shared_ring_signal_source: Unable to attach to the sample ring "
+                         << ring_filename_ << ", exiting the program.";
+            throw std::runtime_error("shared_ring_signal_source: unable to attach to " + ring_filename_);
+        }
+
+    // the type and the rate are those of the publisher
+    item_type_ = ring_->item_type();
+    item_size_ = ring_->item_size();
+    std::string configured_item_type = configuration->property(role + ".item_type", item_type_);
+    if (configured_item_type.compare(item_type_) != 0)
+        {
+            LOG(WARNING) << role << ".item_type=" << configured_item_type << " ignored: " << ring_filename_
+                         << " holds " << item_type_ << " samples";
+        }
+    sampling_frequency_ = configuration->property(role + ".sampling_frequency", static_cast<long>(ring_->sampling_frequency()));
+    if (static_cast<double>(sampling_frequency_) != ring_->sampling_frequency())
+        {
+            LOG(WARNING) << role << ".sampling_frequency=" << sampling_frequency_ << " differs from the "
+                         << ring_->sampling_frequency() << " Hz published in " << ring_filename_;
+        }
+
+    source_ = make_shared_ring_source(ring_);
+    DLOG(INFO) << "shared_ring_source(" << source_->unique_id() << ")";
+
+    if (samples_ > 0)
+        {
+            valve_ = gnss_sdr_make_valve(item_size_, samples_, queue_);
+            DLOG(INFO) << "valve(" << valve_->unique_id() << ")";
+        }
+
+    if (dump_)
+        {
+            sink_ = gr::blocks::file_sink::make(item_size_, dump_filename_.c_str());
+            DLOG(INFO) << "file_sink(" << sink_->unique_id() << ")";
+        }
+    DLOG(INFO) << "Ring filename " << ring_filename_;
+    DLOG(INFO) << "Ring capacity " << ring_->capacity();
+    DLOG(INFO) << "Samples " << samples_;
+    DLOG(INFO) << "Sampling frequency " << sampling_frequency_;
+    DLOG(INFO) << "Item type " << item_type_;
+    DLOG(INFO) << "Item size " << item_size_;
+    DLOG(INFO) << "Dump " << dump_;
+    DLOG(INFO) << "Dump filename " << dump_filename_;
+}
+
+
+
+
+SharedRingSignalSource::~SharedRingSignalSource()
+{
+    if (source_ && (source_->overruns() > 0))
+        {
+            LOG(INFO) << "shared_ring_signal_source: " << source_->missed_items() << " samples lost in "
+                      << source_->overruns() << " overruns";
+        }
+}
+
+
+
+
+void SharedRingSignalSource::connect(gr::top_block_sptr top_block)
+{
+    if (valve_)
+        {
+            top_block->connect(source_, 0, valve_, 0);
+            DLOG(INFO) << "connected shared ring source to valve";
+        }
+    if (dump_)
+        {
+            top_block->connect(get_right_block(), 0, sink_, 0);
+            DLOG(INFO) << "connected shared ring source to file sink";
+        }
+}
+
+
+
+
+void SharedRingSignalSource::disconnect(gr::top_block_sptr top_block)
+{
+    if (valve_)
+        {
+            top_block->disconnect(source_, 0, valve_, 0);
+            DLOG(INFO) << "disconnected shared ring source to valve";
+        }
+    if (dump_)
+        {
+            top_block->disconnect(get_right_block(), 0, sink_, 0);
+            DLOG(INFO) << "disconnected shared ring source to file sink";
+        }
+}
+
+
+
+
+gr::basic_block_sptr SharedRingSignalSource::get_left_block()
+{
+    LOG(WARNING) << "Left block of a signal source should not be retrieved";
+    return gr::block_sptr();
+}
+
+
+
+
+gr::basic_block_sptr SharedRingSignalSource::get_right_block()
+{
+    if (valve_)
+        {
+            return valve_;
+        }
+    return source_;
+}
@@ -0,0 +1,118 @@
+/*!
+ * \file shared_ring_signal_source.h
+ * \brief Interface of a class that reads the samples a sample server
+ * publishes in a shared sample ring and adapts it to a SignalSourceInterface
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_SHARED_RING_SIGNAL_SOURCE_H_
+#define GNSS_SDR_SHARED_RING_SIGNAL_SOURCE_H_
+
+#include <memory>
+#include <string>
+#include <gnuradio/blocks/file_sink.h>
+#include <gnuradio/msg_queue.h>
+#include "gnss_block_interface.h"
+#include "shared_ring_source.h"
+
+
+class ConfigurationInterface;
+
+/*!
+ * \brief Class that attaches to the shared sample ring of a sample server
+ * and adapts it to a SignalSourceInterface.
+ *
+ * The sample server owns the front end, so any number of receivers of
+ * the machine can process its samples at once. The item type and the
+ * sampling frequency are those the server publishes; the samples a slow
+ * receiver misses are output as zeros (see shared_ring_source).
+ */
+class SharedRingSignalSource: public GNSSBlockInterface
+{
+public:
+    SharedRingSignalSource(ConfigurationInterface* configuration, std::string role,
+            unsigned int in_streams, unsigned int out_streams,
+            boost::shared_ptr<gr::msg_queue> queue);
+
+    virtual ~SharedRingSignalSource();
+    std::string role()
+    {
+        return role_;
+    }
+
+    /*!
+     * \brief Returns "Shared_Ring_Signal_Source".
+     */
+    std::string implementation()
+    {
+        return "Shared_Ring_Signal_Source";
+    }
+    size_t item_size()
+    {
+        return item_size_;
+    }
+    void connect(gr::top_block_sptr top_block);
+    void disconnect(gr::top_block_sptr top_block);
+    gr::basic_block_sptr get_left_block();
+    gr::basic_block_sptr get_right_block();
+    std::string ring_filename()
+    {
+        return ring_filename_;
+    }
+    std::string item_type()
+    {
+        return item_type_;
+    }
+    long sampling_frequency()
+    {
+        return sampling_frequency_;
+    }
+    long samples()
+    {
+        return samples_;
+    }
+
+private:
+    unsigned long long samples_;
+    long sampling_frequency_;
+    std::string ring_filename_;
+    std::string item_type_;
+    bool dump_;
+    std::string dump_filename_;
+    std::string role_;
+    unsigned int in_streams_;
+    unsigned int out_streams_;
+    std::shared_ptr<Shared_Sample_Ring> ring_;
+    shared_ring_source_sptr source_;
+    boost::shared_ptr<gr::block> valve_;
+    gr::blocks::file_sink::sptr sink_;
+    boost::shared_ptr<gr::msg_queue> queue_;
+    size_t item_size_;
+};
+
+#endif /*GNSS_SDR_SHARED_RING_SIGNAL_SOURCE_H_*/
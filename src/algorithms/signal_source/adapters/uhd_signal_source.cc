@@ -36,6 +36,7 @@
 #include <glog/logging.h>
 #include "configuration_interface.h"
 #include "gnss_sdr_valve.h"
+#include "rx_time_gap_filler.h"
 #include "GPS_L1_CA.h"
 
 using google::LogMessage;
@@ -52,7 +53,10 @@ UhdSignalSource::UhdSignalSource(ConfigurationInterface* configuration,
     std::string default_item_type = "cshort";
 
     // UHD COMMON PARAMETERS
-    uhd::device_addr_t dev_addr;
+    // device_args: extra device arguments, such as the transport buffers
+    // for high rates (e.g. "num_recv_frames=512,recv_frame_size=8000")
+    device_args_ = configuration->property(role + ".device_args", empty);
+    uhd::device_addr_t dev_addr(device_args_);
     device_address_ = configuration->property(role + ".device_address", empty);
     // When left empty, the device discovery routines will search all
     // available transports on the system (ethernet, usb...).
@@ -68,6 +72,8 @@ UhdSignalSource::UhdSignalSource(ConfigurationInterface* configuration,
     RF_channels_ = configuration->property(role + ".RF_channels", 1);
     sample_rate_ = configuration->property(role + ".sampling_frequency", (double)4.0e6);
     item_type_ = configuration->property(role + ".item_type", default_item_type);
+    fill_gaps_ = configuration->property(role + ".fill_gaps", true);
+    min_output_buffer_ = configuration->property(role + ".min_output_buffer", 0);
 
     if (RF_channels_ == 1)
         {
@@ -150,6 +156,13 @@ UhdSignalSource::UhdSignalSource(ConfigurationInterface* configuration,
 
     uhd_source_->set_subdev_spec(subdevice_, 0);
 
+    // The source receives straight into the GNU Radio output buffers, so at
+    // high rates these buffers have to absorb the latency of the flowgraph
+    if (min_output_buffer_ > 0)
+        {
+            uhd_source_->set_min_output_buffer(min_output_buffer_); // in items
+        }
+
     // 2.1 set sampling clock reference
     // Set the clock source for the usrp device.
     // Options: internal, external, or MIMO
@@ -211,6 +224,13 @@ UhdSignalSource::UhdSignalSource(ConfigurationInterface* configuration,
 
     for (int i = 0; i < RF_channels_; i++)
         {
+            if (fill_gaps_)
+                {
+                    // keeps the sample count in step with the rx_time tags after an overflow
+                    gap_filler_.push_back(make_rx_time_gap_filler(item_size_, uhd_source_->get_samp_rate()));
+                    DLOG(INFO) << "gap_filler(" << gap_filler_.at(i)->unique_id() << ")";
+                }
+
             if (samples_.at(i) != 0)
                 {
                     LOG(INFO) << "RF_channel "<< i << " Send STOP signal after " << samples_.at(i) << " samples";
@@ -237,9 +257,18 @@ void UhdSignalSource::connect(gr::top_block_sptr top_block)
 {
     for (int i = 0; i < RF_channels_; i++)
         {
+            gr::basic_block_sptr channel_block = uhd_source_;
+            int channel_port = i;
+            if (fill_gaps_)
+                {
+                    top_block->connect(uhd_source_, i, gap_filler_.at(i), 0);
+                    DLOG(INFO) << "connected usrp source to gap filler RF Channel " << i;
+                    channel_block = gap_filler_.at(i);
+                    channel_port = 0;
+                }
             if (samples_.at(i) != 0)
                 {
-                    top_block->connect(uhd_source_, i, valve_.at(i), 0);
+                    top_block->connect(channel_block, channel_port, valve_.at(i), 0);
                     DLOG(INFO) << "connected usrp source to valve RF Channel " << i;
                     if (dump_.at(i))
                         {
@@ -251,7 +280,7 @@ void UhdSignalSource::connect(gr::top_block_sptr top_block)
                 {
                     if (dump_.at(i))
                         {
-                            top_block->connect(uhd_source_, i, file_sink_.at(i), 0);
+                            top_block->connect(channel_block, channel_port, file_sink_.at(i), 0);
                             DLOG(INFO) << "connected usrp source to file sink RF Channel " << i;
                         }
                 }
@@ -264,9 +293,17 @@ void UhdSignalSource::disconnect(gr::top_block_sptr top_block)
 {
     for (int i = 0; i < RF_channels_; i++)
         {
+            gr::basic_block_sptr channel_block = uhd_source_;
+            int channel_port = i;
+            if (fill_gaps_)
+                {
+                    top_block->disconnect(uhd_source_, i, gap_filler_.at(i), 0);
+                    channel_block = gap_filler_.at(i);
+                    channel_port = 0;
+                }
             if (samples_.at(i) != 0)
                 {
-                    top_block->disconnect(uhd_source_, i, valve_.at(i), 0);
+                    top_block->disconnect(channel_block, channel_port, valve_.at(i), 0);
                     LOG(INFO) << "UHD source disconnected";
                     if (dump_.at(i))
                         {
@@ -277,7 +314,7 @@ void UhdSignalSource::disconnect(gr::top_block_sptr top_block)
                 {
                     if (dump_.at(i))
                         {
-                            top_block->disconnect(uhd_source_, i, file_sink_.at(i), 0);
+                            top_block->disconnect(channel_block, channel_port, file_sink_.at(i), 0);
                         }
                 }
         }
@@ -306,6 +343,10 @@ gr::basic_block_sptr UhdSignalSource::get_right_block(int RF_channel)
         {
             return valve_.at(RF_channel);
         }
+    else if (fill_gaps_)
+        {
+            return gap_filler_.at(RF_channel);
+        }
     else
         {
             return uhd_source_;
@@ -39,6 +39,7 @@
 #include <gnuradio/blocks/file_sink.h>
 #include <gnuradio/msg_queue.h>
 #include "gnss_block_interface.h"
+#include "rx_time_gap_filler.h"
 
 class ConfigurationInterface;
 
@@ -88,6 +89,7 @@ private:
     // UHD SETTINGS
     uhd::stream_args_t uhd_stream_args_;
     std::string device_address_;
+    std::string device_args_;
     double sample_rate_;
     int RF_channels_;
     std::string item_type_;
@@ -95,6 +97,8 @@ private:
 
     std::string subdevice_;
     std::string clock_source_;
+    bool fill_gaps_;
+    int min_output_buffer_;
 
     std::vector<double> freq_;
     std::vector<double> gain_;
@@ -103,6 +107,7 @@ private:
     std::vector<bool> dump_;
     std::vector<std::string> dump_filename_;
 
+    std::vector<rx_time_gap_filler_sptr> gap_filler_;
     std::vector<boost::shared_ptr<gr::block>> valve_;
     std::vector<gr::blocks::file_sink::sptr> file_sink_;
 
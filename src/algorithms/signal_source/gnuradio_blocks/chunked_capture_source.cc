@@ -0,0 +1,197 @@
+/*!
+ * \file chunked_capture_source.cc
+ * \brief GNU Radio source block that reads a chunked capture file,
+ * decoding its chunks in parallel
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "chunked_capture_source.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+
+chunked_capture_source_sptr make_chunked_capture_source(const std::string & filename,
+        bool repeat, unsigned long long values_to_skip, unsigned int decoding_threads)
+{
+    return chunked_capture_source_sptr(new chunked_capture_source(filename, repeat, values_to_skip, decoding_threads));
+}
+
+
+chunked_capture_source::chunked_capture_source(const std::string & filename,
+        bool repeat, unsigned long long values_to_skip, unsigned int decoding_threads) : gr::sync_block("chunked_capture_source",
+                gr::io_signature::make(0, 0, 0),
+                gr::io_signature::make(0, 0, 0)),
+        d_value_bytes(0),
+        d_first_chunk(0),
+        d_first_value(0),
+        d_end(0),
+        d_next_decode(0),
+        d_next_output(0),
+        d_position(0),
+        d_stop(false)
+{
+    if (!d_reader.open(filename))
+        {
+            throw std::runtime_error("chunked_capture_source: " + filename + " is not a readable chunked capture file");
+        }
+    const Chunked_Capture_Header & header = d_reader.header();
+    if (values_to_skip >= header.total_values)
+        {
+            throw std::runtime_error("chunked_capture_source: " + filename + " has no values after the skipped ones");
+        }
+    d_value_bytes = header.value_bytes;
+    set_output_signature(gr::io_signature::make(1, 1, d_value_bytes));
+
+    // random access: the skipped values are not decoded
+    d_first_chunk = values_to_skip / header.chunk_values;
+    d_first_value = static_cast<unsigned int>(values_to_skip % header.chunk_values);
+    d_position = d_first_value;
+    d_end = repeat ? std::numeric_limits<unsigned long long>::max() : header.chunks - d_first_chunk;
+
+    decoding_threads = std::max(decoding_threads, 1u);
+    d_slots.resize(2 * decoding_threads);
+    for (unsigned int i = 0; i < d_slots.size(); i++)
+        {
+            d_slots[i].values.resize(static_cast<size_t>(header.chunk_values) * d_value_bytes);
+            d_slots[i].sequence = 0;
+            d_slots[i].ready = false;
+            d_slots[i].valid = false;
+        }
+    for (unsigned int i = 0; i < decoding_threads; i++)
+        {
+            d_threads.create_thread(boost::bind(&chunked_capture_source::decode_chunks, this));
+        }
+    LOG(INFO) << "chunked_capture_source: " << filename << ", " << header.total_values << " "
+              << chunked_capture_item_type(header) << " values in " << header.chunks << " chunks, starting at chunk "
+              << d_first_chunk << ", " << decoding_threads << " decoding threads";
+}
+
+
+chunked_capture_source::~chunked_capture_source()
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_stop = true;
+    }
+    d_condition.notify_all();
+    d_threads.join_all();
+}
+
+
+unsigned long long chunked_capture_source::chunk_of(unsigned long long sequence) const
+{
+    return d_first_chunk + sequence % (d_reader.header().chunks - d_first_chunk);
+}
+
+
+void chunked_capture_source::decode_chunks()
+{
+    std::vector<unsigned char> encoded;
+    boost::mutex::scoped_lock lock(d_mutex);
+    while (true)
+        {
+            while (!d_stop && !(d_next_decode < d_end && d_next_decode < d_next_output + d_slots.size()))
+                {
+                    d_condition.wait(lock);
+                }
+            if (d_stop)
+                {
+                    return;
+                }
+            unsigned long long sequence = d_next_decode++;
+            Decoded_Chunk & slot = d_slots[sequence % d_slots.size()];
+            slot.sequence = sequence;
+            slot.ready = false;
+            lock.unlock();
+            bool valid = d_reader.decode_chunk(chunk_of(sequence), encoded, &slot.values[0]);
+            lock.lock();
+            slot.valid = valid;
+            slot.ready = true;
+            d_condition.notify_all();
+        }
+}
+
+
+int chunked_capture_source::work(int noutput_items,
+        gr_vector_const_void_star &input_items __attribute__((unused)),
+        gr_vector_void_star &output_items)
+{
+    char * out = static_cast<char *>(output_items[0]);
+    int produced = 0;
+    while (produced < noutput_items && d_next_output < d_end)
+        {
+            Decoded_Chunk & slot = d_slots[d_next_output % d_slots.size()];
+            {
+                boost::mutex::scoped_lock lock(d_mutex);
+                while (!(slot.ready && slot.sequence == d_next_output))
+                    {
+                        if (produced > 0)
+                            {
+                                // do not hold back the values already copied
+                                return produced;
+                            }
+                        d_condition.wait(lock);
+                    }
+            }
+            unsigned long long chunk = chunk_of(d_next_output);
+            if (!slot.valid)
+                {
+                    LOG(ERROR) << "chunked_capture_source: chunk " << chunk << " is corrupt, stopping";
+                    boost::mutex::scoped_lock lock(d_mutex);
+                    d_end = d_next_output;
+                    break;
+                }
+            unsigned int chunk_values = d_reader.chunk_values(chunk);
+            unsigned int values = std::min(static_cast<unsigned int>(noutput_items - produced), chunk_values - d_position);
+            std::memcpy(out + static_cast<size_t>(produced) * d_value_bytes,
+                    &slot.values[static_cast<size_t>(d_position) * d_value_bytes],
+                    static_cast<size_t>(values) * d_value_bytes);
+            produced += values;
+            d_position += values;
+            if (d_position == chunk_values)
+                {
+                    boost::mutex::scoped_lock lock(d_mutex);
+                    slot.ready = false;
+                    d_next_output++;
+                    d_position = (chunk_of(d_next_output) == d_first_chunk) ? d_first_value : 0;
+                    d_condition.notify_all();
+                }
+        }
+    if (produced == 0)
+        {
+            return -1; // WORK_DONE: end of the file
+        }
+    return produced;
+}
@@ -0,0 +1,106 @@
+/*!
+ * \file chunked_capture_source.h
+ * \brief GNU Radio source block that reads a chunked capture file,
+ * decoding its chunks in parallel
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_CHUNKED_CAPTURE_SOURCE_H
+#define GNSS_SDR_CHUNKED_CAPTURE_SOURCE_H
+
+#include <string>
+#include <vector>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <gnuradio/sync_block.h>
+#include "chunked_capture.h"
+
+class chunked_capture_source;
+
+typedef boost::shared_ptr<chunked_capture_source> chunked_capture_source_sptr;
+
+/*!
+ * \brief Opens filename and outputs its values from values_to_skip on.
+ * Throws std::runtime_error if the file is not a valid chunked capture.
+ */
+chunked_capture_source_sptr make_chunked_capture_source(const std::string & filename,
+        bool repeat, unsigned long long values_to_skip, unsigned int decoding_threads);
+
+/*!
+ * \brief Outputs the values of a chunked capture file (see Chunked_Capture_Header),
+ * one item per value, as a gr::blocks::file_source on the raw capture would.
+ *
+ * The skipped values cost a look up in the index of the file. A pool of
+ * decoding_threads threads decodes the next chunks ahead of the output
+ * into twice as many slots, so work() only copies decoded values.
+ * With repeat, the output restarts at values_to_skip.
+ */
+class chunked_capture_source: public gr::sync_block
+{
+private:
+    friend chunked_capture_source_sptr make_chunked_capture_source(const std::string & filename,
+            bool repeat, unsigned long long values_to_skip, unsigned int decoding_threads);
+    chunked_capture_source(const std::string & filename,
+            bool repeat, unsigned long long values_to_skip, unsigned int decoding_threads);
+
+    struct Decoded_Chunk
+    {
+        std::vector<char> values;
+        unsigned long long sequence;    // position of the chunk in the output
+        bool ready;
+        bool valid;
+    };
+
+    void decode_chunks();
+    unsigned long long chunk_of(unsigned long long sequence) const;
+
+    Chunked_Capture_Reader d_reader;
+    unsigned int d_value_bytes;
+    unsigned long long d_first_chunk;
+    unsigned int d_first_value;        // first value output of the first chunk
+    unsigned long long d_end;          // sequence after the last chunk to output
+    std::vector<Decoded_Chunk> d_slots;
+    unsigned long long d_next_decode;  // sequence of the next chunk to decode
+    unsigned long long d_next_output;  // sequence of the chunk being output
+    unsigned int d_position;           // next value of the chunk being output
+    bool d_stop;
+    boost::mutex d_mutex;
+    boost::condition_variable d_condition;
+    boost::thread_group d_threads;
+
+public:
+    ~chunked_capture_source();
+
+    const Chunked_Capture_Header & header() const { return d_reader.header(); }
+
+    int work (int noutput_items,
+              gr_vector_const_void_star &input_items,
+              gr_vector_void_star &output_items);
+};
+
+#endif
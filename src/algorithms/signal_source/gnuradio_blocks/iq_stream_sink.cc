@@ -0,0 +1,308 @@
+/*!
+ * \file iq_stream_sink.cc
+ * \brief GNU Radio sink block that quantizes its input and streams it to a
+ * remote receiver over TCP or UDP
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "iq_stream_sink.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+namespace
+{
+    const size_t max_queued_blocks = 64;
+    // the largest UDP payload, less the header and the worst case of the compression
+    const size_t max_datagram_payload_bytes = 65507 - iq_stream_header_bytes - 8;
+}
+
+
+iq_stream_sink_sptr make_iq_stream_sink(const std::string & protocol, const std::string & address,
+        unsigned short port, size_t item_size, unsigned int bits, bool compress,
+        unsigned int block_samples, double sampling_frequency)
+{
+    return iq_stream_sink_sptr(new iq_stream_sink(protocol, address, port, item_size, bits, compress,
+            block_samples, sampling_frequency));
+}
+
+
+iq_stream_sink::iq_stream_sink(const std::string & protocol, const std::string & address,
+        unsigned short port, size_t item_size, unsigned int bits, bool compress,
+        unsigned int block_samples, double sampling_frequency) : gr::sync_block("iq_stream_sink",
+                gr::io_signature::make(1, 1, item_size),
+                gr::io_signature::make(0, 0, 0)),
+        d_tcp(protocol != "udp"),
+        d_item_size(item_size),
+        d_bits(bits),
+        d_compress(compress),
+        d_sampling_frequency(sampling_frequency),
+        d_raw(bits == 16 && item_size == 4),
+        d_scale(1.0),
+        d_filled(0),
+        d_sequence(0),
+        d_first_sample(0),
+        d_acceptor(d_io_service),
+        d_tcp_socket(d_io_service),
+        d_udp_socket(d_io_service),
+        d_connected(false),
+        d_stop(false),
+        d_sent_blocks(0),
+        d_dropped_blocks(0)
+{
+    if (!iq_stream_valid_bits(bits))
+        {
+            throw std::runtime_error("iq_stream_sink: an I/Q stream has 2, 4, 8 or 16 bits per value");
+        }
+    if (item_size != 8 && item_size != 4)
+        {
+            throw std::runtime_error("iq_stream_sink: the input must be gr_complex or cshort samples");
+        }
+    unsigned long long max_samples = iq_stream_max_samples;
+    if (!d_tcp)
+        {
+            max_samples = std::min(max_samples, static_cast<unsigned long long>(max_datagram_payload_bytes * 8 / (2 * bits)));
+        }
+    d_block_samples = static_cast<unsigned int>(std::min(std::max(block_samples, 2u), static_cast<unsigned int>(max_samples))) & ~1u;
+    if (d_block_samples != block_samples)
+        {
+            LOG(WARNING) << "iq_stream_sink: blocks of " << d_block_samples << " samples instead of " << block_samples;
+        }
+    d_values.resize(2 * d_block_samples);
+    d_levels.resize(2 * d_block_samples);
+
+    boost::system::error_code ec;
+    boost::asio::ip::address ip = boost::asio::ip::address::from_string(address, ec);
+    if (ec)
+        {
+            throw std::runtime_error("iq_stream_sink: " + address + " is not an IP address");
+        }
+    if (d_tcp)
+        {
+            boost::asio::ip::tcp::endpoint endpoint(ip, port);
+            d_acceptor.open(endpoint.protocol(), ec);
+            if (!ec) d_acceptor.set_option(boost::asio::socket_base::reuse_address(true), ec);
+            if (!ec) d_acceptor.bind(endpoint, ec);
+            if (!ec) d_acceptor.listen(1, ec);
+            // polled, so that the sending thread can stop
+            if (!ec) d_acceptor.non_blocking(true, ec);
+        }
+    else
+        {
+            d_destination = boost::asio::ip::udp::endpoint(ip, port);
+            d_udp_socket.open(d_destination.protocol(), ec);
+        }
+    if (ec)
+        {
+            throw std::runtime_error("iq_stream_sink: unable to open " + protocol + " " + address + ": " + ec.message());
+        }
+    d_thread = boost::thread(boost::bind(&iq_stream_sink::send_blocks, this));
+}
+
+
+iq_stream_sink::~iq_stream_sink()
+{
+    stop();
+    if (d_dropped_blocks.load() > 0)
+        {
+            LOG(INFO) << "iq_stream_sink: " << d_dropped_blocks.load() << " blocks dropped, "
+                      << d_sent_blocks.load() << " sent";
+        }
+}
+
+
+bool iq_stream_sink::stop()
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_stop = true;
+    }
+    d_condition.notify_all();
+    if (d_thread.joinable())
+        {
+            d_thread.join();
+        }
+    return true;
+}
+
+
+int iq_stream_sink::work(int noutput_items,
+        gr_vector_const_void_star &input_items,
+        gr_vector_void_star &output_items __attribute__((unused)))
+{
+    const char * in = static_cast<const char *>(input_items[0]);
+    unsigned int consumed = 0;
+    while (consumed < static_cast<unsigned int>(noutput_items))
+        {
+            unsigned int n = std::min(static_cast<unsigned int>(noutput_items) - consumed, d_block_samples - d_filled);
+            float * values = &d_values[2 * d_filled];
+            if (d_item_size == 8)
+                {
+                    std::memcpy(values, in + static_cast<size_t>(consumed) * d_item_size, n * d_item_size);
+                }
+            else
+                {
+                    const short * samples = reinterpret_cast<const short *>(in + static_cast<size_t>(consumed) * d_item_size);
+                    for (unsigned int k = 0; k < 2 * n; k++)
+                        {
+                            values[k] = samples[k];
+                        }
+                }
+            d_filled += n;
+            consumed += n;
+            if (d_filled == d_block_samples)
+                {
+                    send_block();
+                }
+        }
+    return noutput_items;
+}
+
+
+void iq_stream_sink::send_block()
+{
+    const unsigned int n_values = 2 * d_block_samples;
+    if (!d_raw)
+        {
+            double power = 0.0;
+            for (unsigned int n = 0; n < n_values; n++)
+                {
+                    power += d_values[n] * d_values[n];
+                }
+            float scale = iq_stream_scale(d_bits, static_cast<float>(std::sqrt(power / n_values)));
+            if (std::fabs(20.0 * std::log10(scale / d_scale)) > 1.0)
+                {
+                    d_scale = scale;
+                }
+        }
+    iq_stream_quantize(&d_values[0], n_values, d_scale, d_bits, &d_levels[0]);
+
+    Iq_Stream_Header header;
+    header.bits = d_bits;
+    header.compressed = d_compress;
+    header.sequence = d_sequence++;
+    header.first_sample = d_first_sample;
+    header.samples = d_block_samples;
+    // the first sample of the block came in a block duration ago
+    long long now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    header.timestamp_ns = now_ns - static_cast<long long>(1e9 * d_block_samples / d_sampling_frequency);
+    header.gain_db = 20.0 * std::log10(d_scale);
+    header.payload_bytes = 0;
+    d_first_sample += d_block_samples;
+    d_filled = 0;
+
+    std::vector<unsigned char> block;
+    iq_stream_encode(header, &d_levels[0], block);
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        if (d_queue.size() >= max_queued_blocks)
+            {
+                d_dropped_blocks++;
+                return;
+            }
+        d_queue.push_back(std::vector<unsigned char>());
+        d_queue.back().swap(block);
+    }
+    d_condition.notify_one();
+}
+
+
+void iq_stream_sink::send_blocks()
+{
+    while (true)
+        {
+            boost::system::error_code ec;
+            if (d_tcp && !d_connected)
+                {
+                    d_acceptor.accept(d_tcp_socket, ec);
+                    if (!ec)
+                        {
+                            boost::system::error_code ignored;
+                            d_tcp_socket.non_blocking(false, ignored);
+                            d_tcp_socket.set_option(boost::asio::ip::tcp::no_delay(true), ignored);
+                            d_connected = true;
+                            LOG(INFO) << "iq_stream_sink: receiver connected from " << d_tcp_socket.remote_endpoint(ignored);
+                        }
+                }
+            std::vector<unsigned char> block;
+            {
+                boost::mutex::scoped_lock lock(d_mutex);
+                if (!d_stop && d_queue.empty())
+                    {
+                        d_condition.timed_wait(lock, boost::posix_time::milliseconds(100));
+                    }
+                if (d_stop)
+                    {
+                        break;
+                    }
+                if (d_tcp && !d_connected)
+                    {
+                        // nobody to send them to
+                        d_dropped_blocks += d_queue.size();
+                        d_queue.clear();
+                        continue;
+                    }
+                if (d_queue.empty())
+                    {
+                        continue;
+                    }
+                block.swap(d_queue.front());
+                d_queue.pop_front();
+            }
+            if (d_tcp)
+                {
+                    boost::asio::write(d_tcp_socket, boost::asio::buffer(block), ec);
+                    if (ec)
+                        {
+                            LOG(WARNING) << "iq_stream_sink: receiver disconnected: " << ec.message();
+                            boost::system::error_code ignored;
+                            d_tcp_socket.close(ignored);
+                            d_connected = false;
+                            d_dropped_blocks++;
+                            continue;
+                        }
+                }
+            else
+                {
+                    d_udp_socket.send_to(boost::asio::buffer(block), d_destination, 0, ec);
+                    if (ec)
+                        {
+                            d_dropped_blocks++;
+                            continue;
+                        }
+                }
+            d_sent_blocks++;
+        }
+}
@@ -0,0 +1,127 @@
+/*!
+ * \file iq_stream_sink.h
+ * \brief GNU Radio sink block that quantizes its input and streams it to a
+ * remote receiver over TCP or UDP
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_IQ_STREAM_SINK_H
+#define GNSS_SDR_IQ_STREAM_SINK_H
+
+#include <atomic>
+#include <deque>
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <gnuradio/sync_block.h>
+#include "iq_stream.h"
+
+class iq_stream_sink;
+
+typedef boost::shared_ptr<iq_stream_sink> iq_stream_sink_sptr;
+
+/*!
+ * \brief Streams gr_complex (item_size 8) or cshort (item_size 4) samples
+ * in blocks of block_samples samples of bits bits per value: with "tcp"
+ * the block listens on address:port for the receiver to connect, with
+ * "udp" it sends the blocks to address:port
+ */
+iq_stream_sink_sptr make_iq_stream_sink(const std::string & protocol, const std::string & address,
+        unsigned short port, size_t item_size, unsigned int bits, bool compress,
+        unsigned int block_samples, double sampling_frequency);
+
+/*!
+ * \brief Quantizes its input into the blocks of an I/Q stream (see
+ * Iq_Stream_Header) and sends them to a remote receiver.
+ *
+ * An automatic gain keeps the input at the amplitude that the quantizer
+ * resolves best; it only changes when it is more than 1 dB off, and the
+ * gain of each block is in its header. 16 bit cshort input is sent as
+ * it is. A thread sends the blocks, so that the network never holds the
+ * front end back: the blocks that do not fit in its queue, or that come
+ * while no receiver is connected over TCP, are dropped and counted.
+ */
+class iq_stream_sink: public gr::sync_block
+{
+private:
+    friend iq_stream_sink_sptr make_iq_stream_sink(const std::string & protocol, const std::string & address,
+            unsigned short port, size_t item_size, unsigned int bits, bool compress,
+            unsigned int block_samples, double sampling_frequency);
+    iq_stream_sink(const std::string & protocol, const std::string & address,
+            unsigned short port, size_t item_size, unsigned int bits, bool compress,
+            unsigned int block_samples, double sampling_frequency);
+
+    void send_blocks();
+    void send_block();
+
+    bool d_tcp;
+    size_t d_item_size;
+    unsigned int d_bits;
+    bool d_compress;
+    unsigned int d_block_samples;
+    double d_sampling_frequency;
+    bool d_raw;                         // 16 bit cshort input, sent as it is
+    float d_scale;
+
+    std::vector<float> d_values;        // of the block being filled
+    unsigned int d_filled;              // samples of the block being filled
+    std::vector<short> d_levels;
+    unsigned long long d_sequence;
+    unsigned long long d_first_sample;
+
+    // sending thread
+    boost::asio::io_service d_io_service;
+    boost::asio::ip::tcp::acceptor d_acceptor;
+    boost::asio::ip::tcp::socket d_tcp_socket;
+    boost::asio::ip::udp::socket d_udp_socket;
+    boost::asio::ip::udp::endpoint d_destination;
+    bool d_connected;
+    std::deque<std::vector<unsigned char> > d_queue;
+    bool d_stop;
+    boost::mutex d_mutex;
+    boost::condition_variable d_condition;
+    boost::thread d_thread;
+    std::atomic<unsigned long long> d_sent_blocks;
+    std::atomic<unsigned long long> d_dropped_blocks;
+
+public:
+    ~iq_stream_sink();
+
+    bool stop();
+
+    unsigned long long sent_blocks() const { return d_sent_blocks.load(); }
+    unsigned long long dropped_blocks() const { return d_dropped_blocks.load(); }
+
+    int work (int noutput_items,
+              gr_vector_const_void_star &input_items,
+              gr_vector_void_star &output_items);
+};
+
+#endif
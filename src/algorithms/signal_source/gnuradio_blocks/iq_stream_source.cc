@@ -0,0 +1,342 @@
+/*!
+ * \file iq_stream_source.cc
+ * \brief GNU Radio source block that receives the I/Q stream of a remote
+ * front end over TCP or UDP
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "iq_stream_source.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+namespace
+{
+    // the largest UDP payload
+    const size_t max_datagram_bytes = 65536;
+}
+
+
+iq_stream_source_sptr make_iq_stream_source(const std::string & protocol, const std::string & address,
+        unsigned short port, unsigned int bits, unsigned long long jitter_samples)
+{
+    return iq_stream_source_sptr(new iq_stream_source(protocol, address, port, bits, jitter_samples));
+}
+
+
+iq_stream_source::iq_stream_source(const std::string & protocol, const std::string & address,
+        unsigned short port, unsigned int bits, unsigned long long jitter_samples) : gr::sync_block("iq_stream_source",
+                gr::io_signature::make(0, 0, 0),
+                gr::io_signature::make(1, 1, iq_stream_value_bytes(bits))),
+        d_tcp(protocol != "udp"),
+        d_bits(bits),
+        d_value_bytes(iq_stream_value_bytes(bits)),
+        d_tcp_socket(d_io_service),
+        d_udp_socket(d_io_service),
+        d_retry_timer(d_io_service),
+        d_bad_blocks(0),
+        d_jitter_buffer(jitter_samples),
+        d_position(0),
+        d_gap_values(0),
+        d_gain_db(0.0),
+        d_delay_s(0.0)
+{
+    if (!iq_stream_valid_bits(bits))
+        {
+            throw std::runtime_error("iq_stream_source: an I/Q stream has 2, 4, 8 or 16 bits per value");
+        }
+    boost::system::error_code ec;
+    boost::asio::ip::address ip = boost::asio::ip::address::from_string(address, ec);
+    if (ec)
+        {
+            throw std::runtime_error("iq_stream_source: " + address + " is not an IP address");
+        }
+    if (d_tcp)
+        {
+            d_tcp_endpoint = boost::asio::ip::tcp::endpoint(ip, port);
+            start_connect();
+        }
+    else
+        {
+            boost::asio::ip::udp::endpoint endpoint(ip, port);
+            d_udp_socket.open(endpoint.protocol(), ec);
+            if (!ec)
+                {
+                    // room for the jitter of a few blocks in the kernel too
+                    d_udp_socket.set_option(boost::asio::socket_base::receive_buffer_size(8 * 1024 * 1024), ec);
+                    d_udp_socket.bind(endpoint, ec);
+                }
+            if (ec)
+                {
+                    throw std::runtime_error("iq_stream_source: unable to bind to " + address + ": " + ec.message());
+                }
+            start_receive();
+        }
+    d_thread = boost::thread(boost::bind(&boost::asio::io_service::run, &d_io_service));
+}
+
+
+iq_stream_source::~iq_stream_source()
+{
+    stop();
+    if (lost_samples() > 0 || d_bad_blocks > 0)
+        {
+            LOG(INFO) << "iq_stream_source: " << lost_samples() << " samples lost, " << late_blocks()
+                      << " blocks late, " << d_bad_blocks << " blocks corrupt";
+        }
+}
+
+
+bool iq_stream_source::stop()
+{
+    d_io_service.stop();
+    if (d_thread.joinable())
+        {
+            d_thread.join();
+        }
+    d_condition.notify_all();
+    return true;
+}
+
+
+unsigned long long iq_stream_source::lost_samples()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_jitter_buffer.lost_samples();
+}
+
+
+unsigned long long iq_stream_source::late_blocks()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_jitter_buffer.late_blocks();
+}
+
+
+void iq_stream_source::start_connect()
+{
+    d_tcp_socket.async_connect(d_tcp_endpoint, boost::bind(&iq_stream_source::handle_connect, this, _1));
+}
+
+
+void iq_stream_source::handle_connect(const boost::system::error_code & ec)
+{
+    if (ec)
+        {
+            reconnect();
+            return;
+        }
+    boost::system::error_code ignored;
+    d_tcp_socket.set_option(boost::asio::ip::tcp::no_delay(true), ignored);
+    LOG(INFO) << "iq_stream_source: connected to " << d_tcp_endpoint;
+    start_read_header();
+}
+
+
+void iq_stream_source::reconnect()
+{
+    boost::system::error_code ignored;
+    d_tcp_socket.close(ignored);
+    d_retry_timer.expires_from_now(boost::posix_time::seconds(1));
+    d_retry_timer.async_wait(boost::bind(&iq_stream_source::start_connect, this));
+}
+
+
+void iq_stream_source::start_read_header()
+{
+    d_received.resize(iq_stream_header_bytes);
+    boost::asio::async_read(d_tcp_socket, boost::asio::buffer(d_received),
+            boost::bind(&iq_stream_source::handle_header, this, _1, _2));
+}
+
+
+void iq_stream_source::handle_header(const boost::system::error_code & ec, size_t bytes_transferred __attribute__((unused)))
+{
+    if (ec)
+        {
+            LOG(WARNING) << "iq_stream_source: connection to " << d_tcp_endpoint << " lost: " << ec.message();
+            reconnect();
+            return;
+        }
+    if (!iq_stream_read_header(&d_received[0], d_received_header))
+        {
+            // the blocks cannot be found again in the byte stream
+            LOG(WARNING) << "iq_stream_source: " << d_tcp_endpoint << " does not send a valid I/Q stream";
+            d_bad_blocks++;
+            reconnect();
+            return;
+        }
+    d_received.resize(iq_stream_header_bytes + d_received_header.payload_bytes);
+    boost::asio::async_read(d_tcp_socket, boost::asio::buffer(&d_received[iq_stream_header_bytes], d_received_header.payload_bytes),
+            boost::bind(&iq_stream_source::handle_payload, this, _1, _2));
+}
+
+
+void iq_stream_source::handle_payload(const boost::system::error_code & ec, size_t bytes_transferred __attribute__((unused)))
+{
+    if (ec)
+        {
+            LOG(WARNING) << "iq_stream_source: connection to " << d_tcp_endpoint << " lost: " << ec.message();
+            reconnect();
+            return;
+        }
+    take_block(d_received.size());
+    start_read_header();
+}
+
+
+void iq_stream_source::start_receive()
+{
+    d_received.resize(max_datagram_bytes);
+    d_udp_socket.async_receive_from(boost::asio::buffer(d_received), d_sender,
+            boost::bind(&iq_stream_source::handle_datagram, this, _1, _2));
+}
+
+
+void iq_stream_source::handle_datagram(const boost::system::error_code & ec, size_t bytes_transferred)
+{
+    if (ec)
+        {
+            LOG(WARNING) << "iq_stream_source: " << ec.message();
+        }
+    else if (bytes_transferred < iq_stream_header_bytes || !iq_stream_read_header(&d_received[0], d_received_header)
+            || bytes_transferred != iq_stream_header_bytes + d_received_header.payload_bytes)
+        {
+            d_bad_blocks++;
+        }
+    else
+        {
+            take_block(bytes_transferred);
+        }
+    start_receive();
+}
+
+
+bool iq_stream_source::take_block(size_t bytes)
+{
+    if (d_received_header.bits != d_bits)
+        {
+            LOG_IF(WARNING, d_bad_blocks == 0) << "iq_stream_source: the stream has " << d_received_header.bits
+                    << " bits per value, not " << d_bits;
+            d_bad_blocks++;
+            return false;
+        }
+    d_received.resize(bytes);
+    boost::mutex::scoped_lock lock(d_mutex);
+    bool taken = d_jitter_buffer.push(d_received_header, d_received);
+    d_condition.notify_one();
+    return taken;
+}
+
+
+int iq_stream_source::work(int noutput_items,
+        gr_vector_const_void_star &input_items __attribute__((unused)),
+        gr_vector_void_star &output_items)
+{
+    char * out = static_cast<char *>(output_items[0]);
+    size_t produced = 0;
+    const size_t wanted = noutput_items;
+    while (produced < wanted)
+        {
+            if (d_gap_values > 0)
+                {
+                    size_t n = std::min(static_cast<size_t>(d_gap_values), wanted - produced);
+                    std::memset(out + produced * d_value_bytes, 0, n * d_value_bytes);
+                    produced += n;
+                    d_gap_values -= n;
+                    continue;
+                }
+            if (d_position < d_values.size())
+                {
+                    size_t n = std::min((d_values.size() - d_position) / d_value_bytes, wanted - produced);
+                    std::memcpy(out + produced * d_value_bytes, &d_values[d_position], n * d_value_bytes);
+                    produced += n;
+                    d_position += n * d_value_bytes;
+                    continue;
+                }
+
+            unsigned long long gap_samples = 0;
+            bool popped = false;
+            {
+                boost::mutex::scoped_lock lock(d_mutex);
+                popped = d_jitter_buffer.pop(d_header, d_block, gap_samples);
+                if (!popped && produced == 0 && !d_io_service.stopped())
+                    {
+                        d_condition.timed_wait(lock, boost::posix_time::milliseconds(100));
+                        popped = d_jitter_buffer.pop(d_header, d_block, gap_samples);
+                    }
+            }
+            if (!popped)
+                {
+                    if (produced == 0 && d_io_service.stopped())
+                        {
+                            return -1; // WORK_DONE: the block was stopped
+                        }
+                    break;
+                }
+            if (gap_samples > 0)
+                {
+                    d_gap_values = 2 * gap_samples;
+                    continue;
+                }
+
+            if (d_header.gain_db != d_gain_db)
+                {
+                    DLOG(INFO) << "iq_stream_source: streamer gain " << d_header.gain_db << " dB from sample " << d_header.first_sample;
+                    d_gain_db = d_header.gain_db;
+                }
+            d_delay_s = 1e-9 * static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count() - d_header.timestamp_ns);
+
+            // a block that fits is decoded straight into the output
+            size_t n_values = 2 * static_cast<size_t>(d_header.samples);
+            bool fits = n_values <= wanted - produced;
+            if (!fits)
+                {
+                    d_values.resize(n_values * d_value_bytes);
+                    d_position = 0;
+                }
+            char * values = fits ? out + produced * d_value_bytes : &d_values[0];
+            if (!iq_stream_decode(d_header, &d_block[iq_stream_header_bytes], values))
+                {
+                    d_bad_blocks++;
+                    std::memset(values, 0, n_values * d_value_bytes);
+                }
+            if (fits)
+                {
+                    produced += n_values;
+                }
+        }
+    return static_cast<int>(produced);
+}
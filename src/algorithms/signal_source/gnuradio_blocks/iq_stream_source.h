@@ -0,0 +1,131 @@
+/*!
+ * \file iq_stream_source.h
+ * \brief GNU Radio source block that receives the I/Q stream of a remote
+ * front end over TCP or UDP
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_IQ_STREAM_SOURCE_H
+#define GNSS_SDR_IQ_STREAM_SOURCE_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <gnuradio/sync_block.h>
+#include "iq_stream.h"
+
+class iq_stream_source;
+
+typedef boost::shared_ptr<iq_stream_source> iq_stream_source_sptr;
+
+/*!
+ * \brief Receives the stream of bits bits per value from address:port:
+ * with "tcp" the block connects to the streamer, with "udp" it binds to
+ * the address and port that the streamer sends to
+ */
+iq_stream_source_sptr make_iq_stream_source(const std::string & protocol, const std::string & address,
+        unsigned short port, unsigned int bits, unsigned long long jitter_samples);
+
+/*!
+ * \brief Outputs the I and Q values of an I/Q stream (see Iq_Stream_Header),
+ * interleaved, one item per value: ibyte items up to 8 bits, ishort items
+ * for 16 bits.
+ *
+ * A network thread puts the blocks in an Iq_Jitter_Buffer of
+ * jitter_samples samples. work() decodes every block straight into its
+ * output, with the VOLK_GNSSSDR unpacking kernels for 2 and 4 bits and
+ * no conversion at all for 8 and 16 bits, and outputs zeros for the
+ * samples of the lost blocks. Over TCP, the block reconnects whenever
+ * the connection drops.
+ */
+class iq_stream_source: public gr::sync_block
+{
+private:
+    friend iq_stream_source_sptr make_iq_stream_source(const std::string & protocol, const std::string & address,
+            unsigned short port, unsigned int bits, unsigned long long jitter_samples);
+    iq_stream_source(const std::string & protocol, const std::string & address,
+            unsigned short port, unsigned int bits, unsigned long long jitter_samples);
+
+    void start_connect();
+    void handle_connect(const boost::system::error_code & ec);
+    void start_read_header();
+    void handle_header(const boost::system::error_code & ec, size_t bytes_transferred);
+    void handle_payload(const boost::system::error_code & ec, size_t bytes_transferred);
+    void start_receive();
+    void handle_datagram(const boost::system::error_code & ec, size_t bytes_transferred);
+    bool take_block(size_t bytes);
+    void reconnect();
+
+    bool d_tcp;
+    unsigned int d_bits;
+    size_t d_value_bytes;
+
+    // network thread
+    boost::asio::io_service d_io_service;
+    boost::asio::ip::tcp::endpoint d_tcp_endpoint;
+    boost::asio::ip::tcp::socket d_tcp_socket;
+    boost::asio::ip::udp::socket d_udp_socket;
+    boost::asio::ip::udp::endpoint d_sender;
+    boost::asio::deadline_timer d_retry_timer;
+    std::vector<unsigned char> d_received;   // the block being received
+    Iq_Stream_Header d_received_header;
+    std::atomic<unsigned long long> d_bad_blocks;
+    boost::thread d_thread;
+
+    Iq_Jitter_Buffer d_jitter_buffer;
+    boost::mutex d_mutex;
+    boost::condition_variable d_condition;
+
+    // the block being output
+    Iq_Stream_Header d_header;
+    std::vector<unsigned char> d_block;
+    std::vector<char> d_values;              // of a block that did not fit in the output
+    size_t d_position;                       // next value of d_values
+    unsigned long long d_gap_values;         // zeros still to output
+    float d_gain_db;
+    double d_delay_s;                        // from the front end to the output, of the last block
+
+public:
+    ~iq_stream_source();
+
+    bool stop();
+
+    unsigned long long lost_samples();
+    unsigned long long late_blocks();
+    unsigned long long bad_blocks() const { return d_bad_blocks.load(); }
+    double delay_s() const { return d_delay_s; }
+
+    int work (int noutput_items,
+              gr_vector_const_void_star &input_items,
+              gr_vector_void_star &output_items);
+};
+
+#endif
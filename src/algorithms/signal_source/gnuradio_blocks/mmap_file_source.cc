@@ -0,0 +1,175 @@
+/*!
+ * \file mmap_file_source.cc
+ * \brief Signal source block that reads the samples of a file mapped in memory
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ * \author Javier Arribas jarribas (at) cttc.es
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "mmap_file_source.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+// Bytes prefetched ahead of the read position, and released behind it
+#define MMAP_FILE_SOURCE_WINDOW_BYTES (16 * 1024 * 1024)
+
+
+mmap_file_source_sptr make_mmap_file_source(size_t item_size, const std::string & filename,
+        bool repeat, unsigned long long items_to_skip, bool huge_pages)
+{
+    return mmap_file_source_sptr(new mmap_file_source(item_size, filename, repeat, items_to_skip, huge_pages));
+}
+
+
+mmap_file_source::mmap_file_source(size_t item_size, const std::string & filename,
+        bool repeat, unsigned long long items_to_skip, bool huge_pages) : gr::sync_block("mmap_file_source",
+                gr::io_signature::make(0, 0, 0),
+                gr::io_signature::make(1, 1, item_size)),
+        d_item_size(item_size),
+        d_repeat(repeat),
+        d_map(0),
+        d_map_bytes(0),
+        d_begin(0),
+        d_end(0),
+        d_pos(0),
+        d_window(0),
+        d_page_bytes(sysconf(_SC_PAGESIZE))
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+        {
+            throw std::runtime_error("mmap_file_source: unable to open " + filename + ": " + strerror(errno));
+        }
+    struct stat file_status;
+    if (fstat(fd, &file_status) == -1 || file_status.st_size == 0)
+        {
+            close(fd);
+            throw std::runtime_error("mmap_file_source: " + filename + " is empty or can not be read");
+        }
+    d_map_bytes = file_status.st_size;
+    void * map = mmap(0, d_map_bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps the file open
+    if (map == MAP_FAILED)
+        {
+            throw std::runtime_error("mmap_file_source: unable to map " + filename + ": " + strerror(errno));
+        }
+    d_map = static_cast<const char *>(map);
+
+    if (madvise(map, d_map_bytes, MADV_SEQUENTIAL) != 0)
+        {
+            DLOG(INFO) << "mmap_file_source: sequential access advice ignored for " << filename;
+        }
+    if (huge_pages)
+        {
+#ifdef MADV_HUGEPAGE
+            // only honoured by file systems with huge page support in the page cache
+            if (madvise(map, d_map_bytes, MADV_HUGEPAGE) != 0)
+                {
+                    LOG(WARNING) << "mmap_file_source: huge pages not available for " << filename << ": " << strerror(errno);
+                }
+#else
+            LOG(WARNING) << "mmap_file_source: huge pages not supported on this platform";
+#endif
+        }
+
+    d_begin = std::min(static_cast<size_t>(items_to_skip * item_size), d_map_bytes);
+    d_end = d_begin + (d_map_bytes - d_begin) / d_item_size * d_item_size;
+    d_pos = d_begin;
+    d_window = d_begin - d_begin % d_page_bytes;
+    advance_window();
+    LOG(INFO) << "mmap_file_source: mapped " << filename << ", " << (d_end - d_begin) / d_item_size
+              << " items after skipping " << items_to_skip;
+}
+
+
+mmap_file_source::~mmap_file_source()
+{
+    if (d_map)
+        {
+            munmap(const_cast<char *>(d_map), d_map_bytes);
+        }
+}
+
+
+void mmap_file_source::advance_window()
+{
+    // release the window before the one being read: the pages stay in the page cache for the other readers
+    if (d_window >= 2 * MMAP_FILE_SOURCE_WINDOW_BYTES)
+        {
+            madvise(const_cast<char *>(d_map) + d_window - 2 * MMAP_FILE_SOURCE_WINDOW_BYTES, MMAP_FILE_SOURCE_WINDOW_BYTES, MADV_DONTNEED);
+        }
+    size_t prefetch = std::min(static_cast<size_t>(MMAP_FILE_SOURCE_WINDOW_BYTES), d_map_bytes - d_window);
+    if (prefetch > 0)
+        {
+            madvise(const_cast<char *>(d_map) + d_window, prefetch, MADV_WILLNEED);
+        }
+    d_window += prefetch;
+}
+
+
+int mmap_file_source::work(int noutput_items,
+        gr_vector_const_void_star &input_items __attribute__((unused)),
+        gr_vector_void_star &output_items)
+{
+    char * out = static_cast<char *>(output_items[0]);
+    int produced = 0;
+    while (produced < noutput_items)
+        {
+            if (d_pos == d_end)
+                {
+                    if (!d_repeat || d_end == d_begin)
+                        {
+                            break;
+                        }
+                    d_pos = d_begin;
+                    d_window = d_begin - d_begin % d_page_bytes;
+                    advance_window();
+                }
+            int items = std::min(static_cast<size_t>(noutput_items - produced), (d_end - d_pos) / d_item_size);
+            std::memcpy(out + produced * d_item_size, d_map + d_pos, items * d_item_size);
+            d_pos += items * d_item_size;
+            produced += items;
+            if (d_pos + MMAP_FILE_SOURCE_WINDOW_BYTES / 2 > d_window && d_window < d_map_bytes)
+                {
+                    advance_window();
+                }
+        }
+    if (produced == 0)
+        {
+            return -1; // WORK_DONE: end of the file
+        }
+    return produced;
+}
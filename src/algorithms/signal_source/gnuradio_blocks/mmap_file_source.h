@@ -0,0 +1,86 @@
+/*!
+ * \file mmap_file_source.h
+ * \brief Signal source block that reads the samples of a file mapped in memory
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ * \author Javier Arribas jarribas (at) cttc.es
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_MMAP_FILE_SOURCE_H
+#define GNSS_SDR_MMAP_FILE_SOURCE_H
+
+#include <string>
+#include <gnuradio/sync_block.h>
+
+class mmap_file_source;
+
+typedef boost::shared_ptr<mmap_file_source> mmap_file_source_sptr;
+
+/*!
+ * \brief Maps filename and reads its items from items_to_skip on.
+ * Throws std::runtime_error if the file can not be mapped.
+ */
+mmap_file_source_sptr make_mmap_file_source(size_t item_size, const std::string & filename,
+        bool repeat, unsigned long long items_to_skip, bool huge_pages);
+
+/*!
+ * \brief Reads the samples of a file through a read-only shared mapping,
+ * as a replacement of gr::blocks::file_source.
+ *
+ * The samples are copied once, from the page cache straight into the
+ * output buffer, instead of going through the stdio buffer of fread. The
+ * mapping is advised as sequential and the next window is prefetched, and
+ * the pages already read are released from the mapping, so the resident
+ * set does not grow with the file. Since the mapping is shared, several
+ * receivers replaying the same capture read the same pages of the cache.
+ */
+class mmap_file_source: public gr::sync_block
+{
+private:
+    friend mmap_file_source_sptr make_mmap_file_source(size_t item_size, const std::string & filename,
+            bool repeat, unsigned long long items_to_skip, bool huge_pages);
+    mmap_file_source(size_t item_size, const std::string & filename,
+            bool repeat, unsigned long long items_to_skip, bool huge_pages);
+
+    void advance_window();
+
+    size_t d_item_size;
+    bool d_repeat;
+    const char * d_map;
+    size_t d_map_bytes;
+    size_t d_begin;     // first byte of the first item
+    size_t d_end;       // end of the last complete item
+    size_t d_pos;
+    size_t d_window;    // next byte to prefetch and release around
+    size_t d_page_bytes;
+
+public:
+    ~mmap_file_source();
+    int work (int noutput_items,
+              gr_vector_const_void_star &input_items,
+              gr_vector_void_star &output_items);
+};
+
+#endif
@@ -32,9 +32,11 @@
 
 #include "rtl_tcp_signal_source_c.h"
 #include "rtl_tcp_commands.h"
+#include <algorithm>
+#include <map>
 #include <glog/logging.h>
 #include <boost/thread/thread.hpp>
-#include <map>
+#include <volk_gnsssdr/volk_gnsssdr.h>
 
 using google::LogMessage;
 
@@ -44,10 +46,14 @@ using boost::asio::ip::tcp;
 // Buffer constants
 // TODO: Make these configurable
 enum {
-    RTL_TCP_BUFFER_SIZE = 1024 * 16, // 16 KB
-    RTL_TCP_PAYLOAD_SIZE = 1024 * 4  //  4 KB
+    RTL_TCP_BUFFER_SIZE = 1024 * 1024 * 4, // 4 MB, about 0.9 s at 2.4 Msps. A power of two
+    RTL_TCP_PAYLOAD_SIZE = 1024 * 4        // 4 KB, divides RTL_TCP_BUFFER_SIZE
 };
 
+// the offset binary samples of the dongle, 127.4 is the zero
+#define RTL_TCP_SAMPLE_OFFSET 127.4f
+#define RTL_TCP_SAMPLE_SCALE (1.0f / 128.0f)
+
 rtl_tcp_signal_source_c_sptr
 rtl_tcp_make_signal_source_c(const std::string &address,
         short port,
@@ -68,18 +74,15 @@ rtl_tcp_signal_source_c::rtl_tcp_signal_source_c(const std::string &address,
         socket_ (io_service_),
         data_ (RTL_TCP_PAYLOAD_SIZE),
         flip_iq_(flip_iq),
-        buffer_ (RTL_TCP_BUFFER_SIZE),
-        unread_ (0)
+        ring_ (RTL_TCP_BUFFER_SIZE),
+        ring_write_ (0),
+        ring_read_ (0),
+        dropped_bytes_ (0),
+        overflows_ (0)
 {
     boost::system::error_code ec;
 
-    // 1. Setup lookup table
-    for (unsigned i = 0; i < 0xff; i++)
-        {
-            lookup_[i] = ((float)(i & 0xff) - 127.4f) * (1.0f / 128.0f);
-        }
-
-    // 2. Set socket options
+    // 1. Set socket options
     ip::address addr = ip::address::from_string (address, ec);
     if (ec)
         {
@@ -108,7 +111,7 @@ rtl_tcp_signal_source_c::rtl_tcp_signal_source_c(const std::string &address,
             LOG (WARNING)  << "Failed to set linger option";
         }
 
-    // 3. Connect socket
+    // 2. Connect socket
 
     socket_.connect(ep, ec);
     if (ec)
@@ -122,7 +125,7 @@ rtl_tcp_signal_source_c::rtl_tcp_signal_source_c(const std::string &address,
     std::cout << "Connected to " << addr << ":" << port << std::endl;
     LOG (INFO)  << "Connected to " << addr << ":" << port;
 
-    // 4. Set nodelay
+    // 3. Set nodelay
     socket_.set_option (tcp::no_delay (true), ec);
     if (ec)
         {
@@ -130,7 +133,7 @@ rtl_tcp_signal_source_c::rtl_tcp_signal_source_c(const std::string &address,
             LOG (WARNING)  << "Failed to set no delay option";
         }
 
-    // 5. Receive dongle info
+    // 4. Receive dongle info
     ec = info_.read (socket_);
     if (ec)
         {
@@ -143,10 +146,8 @@ rtl_tcp_signal_source_c::rtl_tcp_signal_source_c(const std::string &address,
             LOG (INFO)  << "Found " << info_.get_type_name() << " tuner.";
         }
 
-    // 6. Start reading
-    boost::asio::async_read (socket_, boost::asio::buffer (data_),
-            boost::bind (&rtl_tcp_signal_source_c::handle_read,
-                    this, _1, _2));
+    // 5. Start reading
+    start_read ();
     boost::thread (boost::bind (&boost::asio::io_service::run, &io_service_));
 }
 
@@ -154,6 +155,11 @@ rtl_tcp_signal_source_c::rtl_tcp_signal_source_c(const std::string &address,
 rtl_tcp_signal_source_c::~rtl_tcp_signal_source_c()
 {
    io_service_.stop ();
+   if (overflows_.load () > 0)
+       {
+           LOG (INFO) << "rtl_tcp source dropped " << dropped_samples ()
+                   << " samples in " << overflows_.load () << " overflows";
+       }
 }
 
 
@@ -162,33 +168,46 @@ int rtl_tcp_signal_source_c::work (int noutput_items,
         gr_vector_void_star &output_items)
 {
     gr_complex *out = reinterpret_cast <gr_complex *>( output_items[0] );
-    int i = 0;
-    if (io_service_.stopped ())
+    if (!not_empty ())
         {
+            boost::mutex::scoped_lock lock (mutex_);
+            not_empty_.wait (lock, boost::bind (&rtl_tcp_signal_source_c::not_empty,
+                    this));
+        }
+
+    const unsigned long long write = ring_write_.load (std::memory_order_acquire);
+    const unsigned long long read = ring_read_.load (std::memory_order_relaxed);
+    // whole I/Q pairs only: the payloads, and so the ring contents, have an even size
+    const size_t n_bytes = std::min<unsigned long long> ((write - read) & ~1ULL,
+            2 * static_cast<unsigned long long> (noutput_items));
+    if (n_bytes == 0)
+        {
+            // the reader has stopped
             return -1;
         }
 
-    {
-        boost::mutex::scoped_lock lock (mutex_);
-        not_empty_.wait (lock, boost::bind (&rtl_tcp_signal_source_c::not_empty,
-                this));
+    // at most two spans, before and after the end of the ring
+    const size_t offset = read & (RTL_TCP_BUFFER_SIZE - 1);
+    const size_t first = std::min<size_t> (n_bytes, RTL_TCP_BUFFER_SIZE - offset);
+    float *out_float = reinterpret_cast <float *>( out );
+    volk_gnsssdr_8u_s32f_convert_32f (out_float, &ring_[offset],
+            RTL_TCP_SAMPLE_OFFSET, RTL_TCP_SAMPLE_SCALE, first);
+    if (first < n_bytes)
+        {
+            volk_gnsssdr_8u_s32f_convert_32f (out_float + first, &ring_[0],
+                    RTL_TCP_SAMPLE_OFFSET, RTL_TCP_SAMPLE_SCALE, n_bytes - first);
+        }
+    ring_read_.store (read + n_bytes, std::memory_order_release);
 
-        for ( ; i < noutput_items && unread_ > 1; i++ )
-            {
-                float re = buffer_[--unread_];
-                float im = buffer_[--unread_];
-                if (flip_iq_)
-                    {
-                        out[i] = gr_complex (im, re);
-                    }
-                else
-                    {
-                        out[i] = gr_complex (re, im);
-                    }
-            }
-    }
-    not_full_.notify_one ();
-    return i == 0 ? -1 : i;
+    const int n_samples = n_bytes / 2;
+    if (flip_iq_)
+        {
+            for (int i = 0; i < n_samples; i++)
+                {
+                    out[i] = gr_complex (out[i].imag (), out[i].real ());
+                }
+        }
+    return n_samples;
 }
 
 
@@ -314,8 +333,30 @@ void rtl_tcp_signal_source_c::set_if_gain (int gain)
 
 
 
+void rtl_tcp_signal_source_c::start_read ()
+{
+    const unsigned long long write = ring_write_.load (std::memory_order_relaxed);
+    const unsigned long long read = ring_read_.load (std::memory_order_acquire);
+    if (RTL_TCP_BUFFER_SIZE - (write - read) >= RTL_TCP_PAYLOAD_SIZE)
+        {
+            // the payloads never wrap around the end of the ring
+            boost::asio::async_read (socket_,
+                    boost::asio::buffer (&ring_[write & (RTL_TCP_BUFFER_SIZE - 1)], RTL_TCP_PAYLOAD_SIZE),
+                    boost::bind (&rtl_tcp_signal_source_c::handle_read,
+                            this, _1, _2, true));
+        }
+    else
+        {
+            boost::asio::async_read (socket_,
+                    boost::asio::buffer (data_),
+                    boost::bind (&rtl_tcp_signal_source_c::handle_read,
+                            this, _1, _2, false));
+        }
+}
+
+
 void rtl_tcp_signal_source_c::handle_read (const boost::system::error_code &ec,
-        size_t bytes_transferred)
+        size_t bytes_transferred, bool into_ring)
 {
     if (ec)
         {
@@ -324,38 +365,31 @@ void rtl_tcp_signal_source_c::handle_read (const boost::system::error_code &ec,
             boost::mutex::scoped_lock lock (mutex_);
             io_service_.stop ();
             not_empty_.notify_one ();
+            return;
         }
-    else
+
+    if (into_ring)
         {
+            ring_write_.store (ring_write_.load (std::memory_order_relaxed) + bytes_transferred,
+                    std::memory_order_release);
             {
-                // Unpack read data
+                // work checks the ring under this lock before sleeping, so the notification is not lost
                 boost::mutex::scoped_lock lock (mutex_);
-                not_full_.wait (lock,
-                        boost::bind (&rtl_tcp_signal_source_c::not_full,
-                                this));
-
-                for (size_t i = 0; i < bytes_transferred; i++)
-                    {
-                        while (!not_full( ))
-                            {
-                                // uh-oh, buffer overflow
-                                // wait until there's space for more
-                                not_empty_.notify_one (); // needed?
-                                not_full_.wait (lock,
-                                        boost::bind (&rtl_tcp_signal_source_c::not_full,
-                                                this));
-                            }
-
-                        buffer_.push_front (lookup_[data_[i]]);
-                        unread_++;
-                    }
             }
-            // let woker know that more data is available
+            // let worker know that more data is available
             not_empty_.notify_one ();
-            // Read some more
-            boost::asio::async_read (socket_,
-                    boost::asio::buffer (data_),
-                    boost::bind (&rtl_tcp_signal_source_c::handle_read,
-                            this, _1, _2));
         }
+    else
+        {
+            // uh-oh, buffer overflow: the payload is dropped
+            dropped_bytes_.fetch_add (bytes_transferred);
+            unsigned long long overflows = overflows_.fetch_add (1) + 1;
+            if (overflows == 1 || overflows % 100 == 0)
+                {
+                    LOG (WARNING) << "rtl_tcp buffer overflow, " << dropped_samples ()
+                            << " samples dropped in " << overflows << " overflows";
+                }
+        }
+    // Read some more
+    start_read ();
 }
@@ -41,11 +41,11 @@
 #include "rtl_tcp_dongle_info.h"
 #include <boost/asio.hpp>
 #include <gnuradio/sync_block.h>
+#include <atomic>
 #include <string>
+#include <vector>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition.hpp>
-#include <boost/array.hpp>
-#include <boost/circular_buffer.hpp>
 
 class rtl_tcp_signal_source_c;
 
@@ -60,6 +60,13 @@ rtl_tcp_make_signal_source_c(const std::string &address,
 /*!
  * \brief This class reads interleaved I/Q samples
  * from an rtl_tcp server and outputs complex types.
+ *
+ * The network thread reads the bytes straight into a preallocated single
+ * producer, single consumer ring, and work converts whole spans of it with
+ * a VOLK_GNSSSDR kernel. Neither side takes a lock to move the samples:
+ * the mutex is only used by work to sleep while the ring is empty. When
+ * the ring is full, the payloads are read and dropped, so the network is
+ * never stalled, and the dropped samples are counted.
  */
 class rtl_tcp_signal_source_c : public gr::sync_block
 {
@@ -76,8 +83,21 @@ public:
     void set_gain (int gain);
     void set_if_gain (int gain);
 
+    /*!
+     * \brief Number of complex samples dropped because the ring was full
+     */
+    unsigned long long dropped_samples () const {
+        return dropped_bytes_.load () / 2;
+    }
+
+    /*!
+     * \brief Number of payloads dropped because the ring was full
+     */
+    unsigned long long overflows () const {
+        return overflows_.load ();
+    }
+
 private:
-    typedef boost::circular_buffer_space_optimized<float> buffer_type;
 
     friend rtl_tcp_signal_source_c_sptr
     rtl_tcp_make_signal_source_c(const std::string &address,
@@ -93,29 +113,33 @@ private:
     // IO members
     boost::asio::io_service io_service_;
     boost::asio::ip::tcp::socket socket_;
-    std::vector<unsigned char> data_;
+    std::vector<unsigned char> data_; // payloads dropped on overflow
     bool flip_iq_;
 
-    // producer-consumer helpers
+    // single producer, single consumer ring of raw I/Q bytes. The counters
+    // only grow, the position in the ring is the counter modulo its size.
+    std::vector<unsigned char> ring_;
+    std::atomic<unsigned long long> ring_write_;
+    std::atomic<unsigned long long> ring_read_;
+
+    // overflow statistics
+    std::atomic<unsigned long long> dropped_bytes_;
+    std::atomic<unsigned long long> overflows_;
+
+    // to let work sleep while the ring is empty
     boost::mutex mutex_;
-    boost::condition not_full_;
     boost::condition not_empty_;
-    buffer_type buffer_;
-    size_t unread_;
 
-    // lookup for scaling data
-    boost::array<float, 0xff> lookup_;
+    // starts the next read, into the ring if a whole payload fits
+    void start_read ();
 
     // async read callback
     void handle_read (const boost::system::error_code &ec,
-            size_t bytes_transferred);
-
-    inline bool not_full ( ) const {
-        return unread_ < buffer_.capacity( );
-    }
+            size_t bytes_transferred, bool into_ring);
 
     inline bool not_empty ( ) const {
-        return unread_ > 0 || io_service_.stopped ();
+        return ring_write_.load (std::memory_order_acquire) - ring_read_.load (std::memory_order_relaxed) > 1
+                || io_service_.stopped ();
     }
 };
 
@@ -0,0 +1,187 @@
+/*!
+ * \file rx_time_gap_filler.cc
+ * \brief Block that keeps the sample count of a stream in step with the
+ * rx_time tags of its source, filling the gaps of the overflows with zeros
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "rx_time_gap_filler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+
+rx_time_gap_filler_sptr make_rx_time_gap_filler(size_t item_size, double sample_rate_hz)
+{
+    return rx_time_gap_filler_sptr(new rx_time_gap_filler(item_size, sample_rate_hz));
+}
+
+
+rx_time_gap_filler::rx_time_gap_filler(size_t item_size, double sample_rate_hz) : gr::block("rx_time_gap_filler",
+        gr::io_signature::make(1, 1, item_size),
+        gr::io_signature::make(1, 1, item_size)),
+        d_item_size(item_size),
+        d_sample_rate_hz(sample_rate_hz),
+        d_have_reference(false),
+        d_reference_secs(0),
+        d_reference_frac_secs(0.0),
+        d_reference_offset(0),
+        d_pending_zeros(0),
+        d_checked_offset(0),
+        d_inserted_samples(0),
+        d_gaps(0)
+{
+    // the tags are moved by the inserted zeros in general_work
+    set_tag_propagation_policy(TPP_DONT);
+}
+
+
+rx_time_gap_filler::~rx_time_gap_filler()
+{
+    if (d_gaps > 0)
+        {
+            LOG(INFO) << "rx_time gap filler inserted " << d_inserted_samples << " samples in " << d_gaps << " gaps";
+        }
+}
+
+
+void rx_time_gap_filler::forecast (int noutput_items, gr_vector_int &ninput_items_required)
+{
+    ninput_items_required[0] = d_pending_zeros > 0 ? 0 : noutput_items;
+}
+
+
+void rx_time_gap_filler::check_time(const pmt::pmt_t & rx_time, unsigned long long output_offset)
+{
+    if (!pmt::is_tuple(rx_time) || pmt::length(rx_time) != 2)
+        {
+            LOG(WARNING) << "Malformed rx_time tag, ignored";
+            return;
+        }
+    const unsigned long long secs = pmt::to_uint64(pmt::tuple_ref(rx_time, 0));
+    const double frac_secs = pmt::to_double(pmt::tuple_ref(rx_time, 1));
+    if (d_have_reference)
+        {
+            const double elapsed_s = (static_cast<double>(secs) - static_cast<double>(d_reference_secs))
+                    + (frac_secs - d_reference_frac_secs);
+            const long long missing = static_cast<long long>(d_reference_offset)
+                    + std::llround(elapsed_s * d_sample_rate_hz) - static_cast<long long>(output_offset);
+            if (missing > 0)
+                {
+                    LOG(WARNING) << "Overflow at rx_time " << static_cast<double>(secs) + frac_secs << " s: "
+                            << missing << " missing samples filled with zeros";
+                    d_pending_zeros = missing;
+                    d_inserted_samples += missing;
+                    d_gaps++;
+                    return;
+                }
+            if (missing == 0)
+                {
+                    return;
+                }
+            // the device time went back, it was probably set again
+            LOG(WARNING) << "rx_time " << static_cast<double>(secs) + frac_secs << " s is "
+                    << -missing << " samples early, taking it as the new reference";
+        }
+    d_have_reference = true;
+    d_reference_secs = secs;
+    d_reference_frac_secs = frac_secs;
+    d_reference_offset = output_offset;
+}
+
+
+int rx_time_gap_filler::general_work (int noutput_items, gr_vector_int &ninput_items,
+        gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
+{
+    const char *in = static_cast<const char *>(input_items[0]);
+    char *out = static_cast<char *>(output_items[0]);
+    const unsigned long long first_in = nitems_read(0);
+    const unsigned long long first_out = nitems_written(0);
+    const int n_in = ninput_items[0];
+
+    std::vector<gr::tag_t> tags;
+    get_tags_in_range(tags, 0, first_in, first_in + n_in);
+    std::sort(tags.begin(), tags.end(), gr::tag_t::offset_compare);
+    const pmt::pmt_t rx_time_key = pmt::mp("rx_time");
+    size_t next_time_tag = 0;
+    size_t next_tag = 0;
+
+    int produced = 0;
+    int consumed = 0;
+    while (produced < noutput_items)
+        {
+            if (d_pending_zeros > 0)
+                {
+                    const int n = static_cast<int>(std::min<unsigned long long>(d_pending_zeros, noutput_items - produced));
+                    std::memset(out + produced * d_item_size, 0, n * d_item_size);
+                    d_pending_zeros -= n;
+                    produced += n;
+                    continue;
+                }
+            if (consumed == n_in)
+                {
+                    break;
+                }
+
+            const unsigned long long in_offset = first_in + consumed;
+            while ((next_time_tag < tags.size()) && ((tags[next_time_tag].offset < d_checked_offset)
+                    || !pmt::eqv(tags[next_time_tag].key, rx_time_key)))
+                {
+                    next_time_tag++;
+                }
+            if ((next_time_tag < tags.size()) && (tags[next_time_tag].offset == in_offset))
+                {
+                    // the zeros, if any, go before the tagged item
+                    check_time(tags[next_time_tag].value, first_out + produced);
+                    d_checked_offset = in_offset + 1;
+                    continue;
+                }
+
+            // copy up to the next rx_time tag
+            unsigned long long n = std::min(noutput_items - produced, n_in - consumed);
+            if (next_time_tag < tags.size())
+                {
+                    n = std::min(n, tags[next_time_tag].offset - in_offset);
+                }
+            std::memcpy(out + produced * d_item_size, in + consumed * d_item_size, n * d_item_size);
+            const unsigned long long shift = first_out + produced - in_offset;
+            for (; (next_tag < tags.size()) && (tags[next_tag].offset < in_offset + n); next_tag++)
+                {
+                    add_item_tag(0, tags[next_tag].offset + shift, tags[next_tag].key, tags[next_tag].value, tags[next_tag].srcid);
+                }
+            produced += n;
+            consumed += n;
+        }
+
+    consume_each(consumed);
+    return produced;
+}
@@ -0,0 +1,90 @@
+/*!
+ * \file rx_time_gap_filler.h
+ * \brief Block that keeps the sample count of a stream in step with the
+ * rx_time tags of its source, filling the gaps of the overflows with zeros
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_RX_TIME_GAP_FILLER_H
+#define GNSS_SDR_RX_TIME_GAP_FILLER_H
+
+#include <gnuradio/block.h>
+
+class rx_time_gap_filler;
+
+typedef boost::shared_ptr<rx_time_gap_filler> rx_time_gap_filler_sptr;
+
+/*!
+ * \brief Makes the block for a stream of items of item_size bytes, sampled
+ * at sample_rate_hz
+ */
+rx_time_gap_filler_sptr make_rx_time_gap_filler(size_t item_size, double sample_rate_hz);
+
+/*!
+ * \brief Inserts zeros where the rx_time tags show that samples are missing.
+ *
+ * The receiver measures time by counting samples (d_sample_counter,
+ * Acq_samplestamp_samples), so a single overflow of the front-end would
+ * shift all the later time stamps. UHD tags the first sample after an
+ * overflow with its rx_time. This block compares each tag with the time
+ * of the first tag plus the number of items written since, and outputs
+ * as many zeros as samples are missing before passing the tagged item.
+ * The stream then keeps one item per sample period: the channels see a
+ * few milliseconds of no signal, but the reception time stays right.
+ * The tags are propagated, moved by the inserted zeros.
+ */
+class rx_time_gap_filler: public gr::block
+{
+private:
+    friend rx_time_gap_filler_sptr make_rx_time_gap_filler(size_t item_size, double sample_rate_hz);
+    rx_time_gap_filler(size_t item_size, double sample_rate_hz);
+
+    void check_time(const pmt::pmt_t & rx_time, unsigned long long output_offset);
+
+    size_t d_item_size;
+    double d_sample_rate_hz;
+    bool d_have_reference;
+    unsigned long long d_reference_secs;      // rx_time of the reference item
+    double d_reference_frac_secs;
+    unsigned long long d_reference_offset;    // output offset of the reference item
+    unsigned long long d_pending_zeros;
+    unsigned long long d_checked_offset;      // input offset of the last rx_time tag checked, plus one
+    unsigned long long d_inserted_samples;
+    unsigned int d_gaps;
+
+public:
+    ~rx_time_gap_filler();
+
+    unsigned long long inserted_samples() const { return d_inserted_samples; }
+    unsigned int gaps() const { return d_gaps; }
+
+    void forecast (int noutput_items, gr_vector_int &ninput_items_required);
+
+    int general_work (int noutput_items, gr_vector_int &ninput_items,
+            gr_vector_const_void_star &input_items, gr_vector_void_star &output_items);
+};
+
+#endif
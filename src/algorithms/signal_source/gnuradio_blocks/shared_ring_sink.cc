@@ -0,0 +1,63 @@
+/*!
+ * \file shared_ring_sink.cc
+ * \brief GNU Radio sink block that publishes its input in a shared sample ring
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include "shared_ring_sink.h"
+#include <gnuradio/io_signature.h>
+
+
+shared_ring_sink_sptr make_shared_ring_sink(std::shared_ptr<Shared_Sample_Ring> ring)
+{
+    return shared_ring_sink_sptr(new shared_ring_sink(ring));
+}
+
+
+shared_ring_sink::shared_ring_sink(std::shared_ptr<Shared_Sample_Ring> ring) : gr::sync_block("shared_ring_sink",
+                gr::io_signature::make(1, 1, ring->item_size()),
+                gr::io_signature::make(0, 0, 0)),
+        d_ring(ring)
+{}
+
+
+bool shared_ring_sink::stop()
+{
+    d_ring->close();
+    return true;
+}
+
+
+int shared_ring_sink::work(int noutput_items,
+        gr_vector_const_void_star &input_items,
+        gr_vector_void_star &output_items __attribute__((unused)))
+{
+    d_ring->write(input_items[0], noutput_items);
+    return noutput_items;
+}
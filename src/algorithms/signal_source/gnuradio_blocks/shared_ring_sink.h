@@ -0,0 +1,66 @@
+/*!
+ * \file shared_ring_sink.h
+ * \brief GNU Radio sink block that publishes its input in a shared sample ring
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_SHARED_RING_SINK_H
+#define GNSS_SDR_SHARED_RING_SINK_H
+
+#include <memory>
+#include <gnuradio/sync_block.h>
+#include "shared_sample_ring.h"
+
+class shared_ring_sink;
+
+typedef boost::shared_ptr<shared_ring_sink> shared_ring_sink_sptr;
+
+shared_ring_sink_sptr make_shared_ring_sink(std::shared_ptr<Shared_Sample_Ring> ring);
+
+/*!
+ * \brief Writes its input, one ring item per input item, into the
+ * Shared_Sample_Ring of a publisher, and closes the ring when the
+ * flowgraph stops
+ */
+class shared_ring_sink: public gr::sync_block
+{
+private:
+    friend shared_ring_sink_sptr make_shared_ring_sink(std::shared_ptr<Shared_Sample_Ring> ring);
+    shared_ring_sink(std::shared_ptr<Shared_Sample_Ring> ring);
+
+    std::shared_ptr<Shared_Sample_Ring> d_ring;
+
+public:
+    bool stop();
+
+    int work (int noutput_items,
+              gr_vector_const_void_star &input_items,
+              gr_vector_void_star &output_items);
+};
+
+#endif
@@ -0,0 +1,123 @@
+/*!
+ * \file shared_ring_source.cc
+ * \brief GNU Radio source block that outputs the samples of a shared sample
+ * ring, from the newest one at start up on
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include "shared_ring_source.h"
+#include <algorithm>
+#include <cstring>
+#include <boost/thread/thread.hpp>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+
+shared_ring_source_sptr make_shared_ring_source(std::shared_ptr<Shared_Sample_Ring> ring)
+{
+    return shared_ring_source_sptr(new shared_ring_source(ring));
+}
+
+
+shared_ring_source::shared_ring_source(std::shared_ptr<Shared_Sample_Ring> ring) : gr::sync_block("shared_ring_source",
+                gr::io_signature::make(0, 0, 0),
+                gr::io_signature::make(1, 1, ring->item_size())),
+        d_ring(ring),
+        d_next(ring->written()),
+        d_missed(0),
+        d_overruns(0),
+        d_catching_up(false)
+{}
+
+
+int shared_ring_source::output_zeros(char * out, int noutput_items, unsigned long long items)
+{
+    int n = static_cast<int>(std::min(items, static_cast<unsigned long long>(noutput_items)));
+    std::memset(out, 0, static_cast<size_t>(n) * d_ring->item_size());
+    d_next += n;
+    d_missed += n;
+    return n;
+}
+
+
+int shared_ring_source::work(int noutput_items,
+        gr_vector_const_void_star &input_items __attribute__((unused)),
+        gr_vector_void_star &output_items)
+{
+    char * out = static_cast<char *>(output_items[0]);
+    unsigned long long written = d_ring->written();
+    // wait briefly for the publisher, the scheduler calls again right away
+    for (int wait = 0; written <= d_next && wait < 50; wait++)
+        {
+            if (d_ring->closed())
+                {
+                    return -1; // WORK_DONE: the publisher has stopped
+                }
+            boost::this_thread::sleep(boost::posix_time::microseconds(200));
+            written = d_ring->written();
+        }
+    if (written <= d_next)
+        {
+            return 0;
+        }
+
+    // catch up at half a ring from the newest item, to leave the publisher some room
+    unsigned long long capacity = d_ring->capacity();
+    if (written - d_next > capacity - capacity / 4)
+        {
+            if (!d_catching_up)
+                {
+                    d_catching_up = true;
+                    d_overruns++;
+                    LOG(WARNING) << "shared_ring_source: the receiver fell behind the publisher ("
+                                 << d_overruns << " overruns), " << written - capacity / 2 - d_next << " samples lost";
+                }
+            return output_zeros(out, noutput_items, written - capacity / 2 - d_next);
+        }
+
+    unsigned long long n = std::min(written - d_next, static_cast<unsigned long long>(noutput_items));
+    d_catching_up = false;
+    const void * items = d_ring->window(d_next, n);
+    if (items != nullptr)
+        {
+            std::memcpy(out, items, n * d_ring->item_size());
+            if (d_ring->intact(d_next))
+                {
+                    d_next += n;
+                    return static_cast<int>(n);
+                }
+        }
+    // the publisher overwrote the items during the copy
+    d_overruns++;
+    LOG(WARNING) << "shared_ring_source: the receiver fell behind the publisher ("
+                 << d_overruns << " overruns), " << n << " samples lost";
+    return output_zeros(out, noutput_items, n);
+}
@@ -0,0 +1,79 @@
+/*!
+ * \file shared_ring_source.h
+ * \brief GNU Radio source block that outputs the samples of a shared sample
+ * ring, from the newest one at start up on
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_SHARED_RING_SOURCE_H
+#define GNSS_SDR_SHARED_RING_SOURCE_H
+
+#include <memory>
+#include <gnuradio/sync_block.h>
+#include "shared_sample_ring.h"
+
+class shared_ring_source;
+
+typedef boost::shared_ptr<shared_ring_source> shared_ring_source_sptr;
+
+shared_ring_source_sptr make_shared_ring_source(std::shared_ptr<Shared_Sample_Ring> ring);
+
+/*!
+ * \brief Outputs the items of a Shared_Sample_Ring as the publisher writes
+ * them, one ring item per output item.
+ *
+ * The output starts at the newest item of the ring. A receiver that falls
+ * more than the ring behind has lost items: they are output as zeros, so
+ * that the sample counter of the receiver keeps counting the samples of
+ * the front end, and are counted in missed_items(). The output ends when
+ * the publisher closes the ring.
+ */
+class shared_ring_source: public gr::sync_block
+{
+private:
+    friend shared_ring_source_sptr make_shared_ring_source(std::shared_ptr<Shared_Sample_Ring> ring);
+    shared_ring_source(std::shared_ptr<Shared_Sample_Ring> ring);
+
+    int output_zeros(char * out, int noutput_items, unsigned long long items);
+
+    std::shared_ptr<Shared_Sample_Ring> d_ring;
+    unsigned long long d_next;      // ring number of the next item to output
+    unsigned long long d_missed;
+    unsigned int d_overruns;
+    bool d_catching_up;             // zeros of an overrun still to output
+
+public:
+    unsigned long long missed_items() const { return d_missed; }
+    unsigned int overruns() const { return d_overruns; }
+
+    int work (int noutput_items,
+              gr_vector_const_void_star &input_items,
+              gr_vector_void_star &output_items);
+};
+
+#endif
@@ -0,0 +1,375 @@
+/*!
+ * \file source_aligner.cc
+ * \brief Block that brings the streams of several signal sources to a
+ * common first sample, and keeps them in step
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "source_aligner.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+
+source_aligner_sptr make_source_aligner(const std::vector<size_t> & item_sizes,
+        const std::vector<double> & sample_rates_hz,
+        const std::vector<long long> & offset_samples,
+        bool use_rx_time, double max_latency_s, double max_skew_s)
+{
+    return source_aligner_sptr(new source_aligner(item_sizes, sample_rates_hz, offset_samples,
+            use_rx_time, max_latency_s, max_skew_s));
+}
+
+
+source_aligner::source_aligner(const std::vector<size_t> & item_sizes,
+        const std::vector<double> & sample_rates_hz,
+        const std::vector<long long> & offset_samples,
+        bool use_rx_time, double max_latency_s, double max_skew_s) : gr::block("source_aligner",
+        gr::io_signature::makev(item_sizes.size(), item_sizes.size(), std::vector<int>(item_sizes.begin(), item_sizes.end())),
+        gr::io_signature::makev(item_sizes.size(), item_sizes.size(), std::vector<int>(item_sizes.begin(), item_sizes.end()))),
+        d_item_sizes(item_sizes),
+        d_sample_rates_hz(sample_rates_hz),
+        d_offset_samples(offset_samples),
+        d_use_rx_time(use_rx_time),
+        d_max_latency_s(max_latency_s),
+        d_max_skew_s(max_skew_s),
+        d_aligned(false)
+{
+    const size_t streams = item_sizes.size();
+    d_sample_rates_hz.resize(streams, d_sample_rates_hz.empty() ? 1.0 : d_sample_rates_hz.back());
+    d_offset_samples.resize(streams, 0);
+    d_have_reference.assign(streams, false);
+    d_reference_secs.assign(streams, 0);
+    d_reference_frac_secs.assign(streams, 0.0);
+    d_reference_offset.assign(streams, 0);
+    d_start_secs.assign(streams, 0);
+    d_start_frac_secs.assign(streams, 0.0);
+    d_pending_drop.assign(streams, 0);
+    d_pending_zeros.assign(streams, 0);
+    d_checked_offset.assign(streams, 0);
+    d_dropped_samples.assign(streams, 0);
+    d_inserted_samples.assign(streams, 0);
+    // the tags are moved by the dropped items and the inserted zeros in general_work
+    set_tag_propagation_policy(TPP_DONT);
+}
+
+
+source_aligner::~source_aligner()
+{
+    for (unsigned int i = 0; i < d_item_sizes.size(); i++)
+        {
+            LOG(INFO) << "source aligner stream " << i << ": " << d_dropped_samples.at(i) << " samples dropped, "
+                    << d_inserted_samples.at(i) << " zeros inserted";
+        }
+}
+
+
+void source_aligner::forecast (int noutput_items __attribute__((unused)), gr_vector_int &ninput_items_required)
+{
+    for (unsigned int i = 0; i < ninput_items_required.size(); i++)
+        {
+            ninput_items_required[i] = (d_pending_zeros.at(i) > 0) ? 0 : 1;
+        }
+}
+
+
+bool source_aligner::search(gr_vector_int &ninput_items, std::vector<int> & consumed)
+{
+    const pmt::pmt_t rx_time_key = pmt::mp("rx_time");
+    double waited_s = 0.0;
+    bool all_referenced = true;
+    for (unsigned int i = 0; i < d_item_sizes.size(); i++)
+        {
+            const unsigned long long first_in = nitems_read(i);
+            if (!d_have_reference.at(i))
+                {
+                    std::vector<gr::tag_t> tags;
+                    get_tags_in_range(tags, i, first_in, first_in + ninput_items[i], rx_time_key);
+                    std::sort(tags.begin(), tags.end(), gr::tag_t::offset_compare);
+                    for (size_t t = 0; t < tags.size(); t++)
+                        {
+                            const pmt::pmt_t & rx_time = tags[t].value;
+                            if (pmt::is_tuple(rx_time) && (pmt::length(rx_time) == 2))
+                                {
+                                    d_have_reference.at(i) = true;
+                                    d_reference_secs.at(i) = pmt::to_uint64(pmt::tuple_ref(rx_time, 0));
+                                    d_reference_frac_secs.at(i) = pmt::to_double(pmt::tuple_ref(rx_time, 1));
+                                    d_reference_offset.at(i) = tags[t].offset;
+                                    break;
+                                }
+                        }
+                }
+            all_referenced = all_referenced && d_have_reference.at(i);
+            // the items before the common first sample are dropped anyway, and holding
+            // them would stall a device that feeds several of the streams
+            consumed.at(i) = ninput_items[i];
+            d_dropped_samples.at(i) += ninput_items[i];
+            waited_s = std::max(waited_s, static_cast<double>(first_in + ninput_items[i]) / d_sample_rates_hz.at(i));
+        }
+    if (all_referenced)
+        {
+            return true;
+        }
+    if (waited_s < d_max_latency_s)
+        {
+            return false;
+        }
+    LOG(WARNING) << "No rx_time tag on every source after " << waited_s << " s, aligning them with the configured offsets";
+    for (unsigned int i = 0; i < d_item_sizes.size(); i++)
+        {
+            d_have_reference.at(i) = false;
+        }
+    return true;
+}
+
+
+void source_aligner::align(const std::vector<unsigned long long> & next_offsets)
+{
+    // time of the next item of each stream, relative to the one of stream 0
+    const size_t streams = d_item_sizes.size();
+    const bool use_rx_time = d_have_reference.at(0);
+    std::vector<double> next_frac_secs(streams);
+    std::vector<double> relative_s(streams);
+    unsigned int latest = 0;
+    for (unsigned int i = 0; i < streams; i++)
+        {
+            if (!use_rx_time)
+                {
+                    // the item offset_samples of each stream was sampled at time 0
+                    d_reference_secs.at(i) = 0;
+                    d_reference_frac_secs.at(i) = -static_cast<double>(d_offset_samples.at(i)) / d_sample_rates_hz.at(i);
+                    d_reference_offset.at(i) = 0;
+                }
+            next_frac_secs.at(i) = d_reference_frac_secs.at(i)
+                    + static_cast<double>(next_offsets.at(i) - d_reference_offset.at(i)) / d_sample_rates_hz.at(i);
+            relative_s.at(i) = (static_cast<double>(d_reference_secs.at(i)) - static_cast<double>(d_reference_secs.at(0)))
+                    + (next_frac_secs.at(i) - next_frac_secs.at(0));
+            if (relative_s.at(i) > relative_s.at(latest))
+                {
+                    latest = i;
+                }
+        }
+
+    const double whole_secs = std::floor(next_frac_secs.at(latest));
+    const unsigned long long start_secs = d_reference_secs.at(latest) + static_cast<long long>(whole_secs);
+    const double start_frac_secs = next_frac_secs.at(latest) - whole_secs;
+    for (unsigned int i = 0; i < streams; i++)
+        {
+            d_start_secs.at(i) = start_secs;
+            d_start_frac_secs.at(i) = start_frac_secs;
+            d_pending_drop.at(i) = std::max(0LL, std::llround((relative_s.at(latest) - relative_s.at(i)) * d_sample_rates_hz.at(i)));
+            d_checked_offset.at(i) = next_offsets.at(i);
+            if (use_rx_time)
+                {
+                    add_item_tag(i, 0, pmt::mp("rx_time"),
+                            pmt::make_tuple(pmt::from_uint64(start_secs), pmt::from_double(start_frac_secs)));
+                }
+            else
+                {
+                    d_checked_offset.at(i) = ~0ULL; // the rx_time tags, if any, are ignored
+                }
+            LOG(INFO) << "source aligner stream " << i << ": first sample at input item "
+                    << next_offsets.at(i) + d_pending_drop.at(i);
+        }
+    if (use_rx_time)
+        {
+            LOG(INFO) << "Sources aligned at rx_time " << static_cast<double>(start_secs) + start_frac_secs << " s";
+        }
+    d_aligned = true;
+}
+
+
+void source_aligner::check_time(unsigned int stream, const pmt::pmt_t & rx_time, unsigned long long output_offset)
+{
+    if (!pmt::is_tuple(rx_time) || pmt::length(rx_time) != 2)
+        {
+            LOG(WARNING) << "Malformed rx_time tag, ignored";
+            return;
+        }
+    const unsigned long long secs = pmt::to_uint64(pmt::tuple_ref(rx_time, 0));
+    const double frac_secs = pmt::to_double(pmt::tuple_ref(rx_time, 1));
+    const double fs = d_sample_rates_hz.at(stream);
+    const double elapsed_s = (static_cast<double>(secs) - static_cast<double>(d_start_secs.at(stream)))
+            + (frac_secs - d_start_frac_secs.at(stream));
+    const long long missing = std::llround(elapsed_s * fs) - static_cast<long long>(output_offset);
+    // the tag knows better than a drop still pending from an earlier one
+    d_pending_drop.at(stream) = 0;
+    if (missing > 0)
+        {
+            LOG(WARNING) << "Source aligner stream " << stream << " at rx_time " << static_cast<double>(secs) + frac_secs
+                    << " s: " << missing << " missing samples filled with zeros";
+            d_pending_zeros.at(stream) = missing;
+            d_inserted_samples.at(stream) += missing;
+        }
+    else if ((missing < 0) && (static_cast<double>(-missing) <= std::max(d_max_latency_s, 1.0) * fs))
+        {
+            LOG(WARNING) << "Source aligner stream " << stream << " at rx_time " << static_cast<double>(secs) + frac_secs
+                    << " s: " << -missing << " extra samples dropped";
+            d_pending_drop.at(stream) = -missing;
+        }
+    else if (missing < 0)
+        {
+            // the device time went back, it was probably set again
+            LOG(WARNING) << "Source aligner stream " << stream << ": rx_time " << static_cast<double>(secs) + frac_secs
+                    << " s is " << -missing << " samples early, taking it as the new reference."
+                    << " The stream may no longer be aligned with the others";
+            d_start_secs.at(stream) = secs;
+            d_start_frac_secs.at(stream) = frac_secs - static_cast<double>(output_offset) / fs;
+        }
+}
+
+
+int source_aligner::work_stream(unsigned int stream, int noutput_items, unsigned long long first_in, int n_in,
+        const char *in, char *out, int & consumed)
+{
+    const size_t item_size = d_item_sizes.at(stream);
+    const unsigned long long first_out = nitems_written(stream);
+    std::vector<gr::tag_t> tags;
+    get_tags_in_range(tags, stream, first_in, first_in + n_in);
+    std::sort(tags.begin(), tags.end(), gr::tag_t::offset_compare);
+    const pmt::pmt_t rx_time_key = pmt::mp("rx_time");
+    size_t next_time_tag = 0;
+    size_t next_tag = 0;
+
+    int produced = 0;
+    consumed = 0;
+    while (produced < noutput_items)
+        {
+            if (d_pending_zeros.at(stream) > 0)
+                {
+                    const int n = static_cast<int>(std::min<unsigned long long>(d_pending_zeros.at(stream), noutput_items - produced));
+                    std::memset(out + produced * item_size, 0, n * item_size);
+                    d_pending_zeros.at(stream) -= n;
+                    produced += n;
+                    continue;
+                }
+            if (consumed == n_in)
+                {
+                    break;
+                }
+
+            const unsigned long long in_offset = first_in + consumed;
+            while ((next_time_tag < tags.size()) && ((tags[next_time_tag].offset < d_checked_offset.at(stream))
+                    || !pmt::eqv(tags[next_time_tag].key, rx_time_key)))
+                {
+                    next_time_tag++;
+                }
+            if ((next_time_tag < tags.size()) && (tags[next_time_tag].offset == in_offset))
+                {
+                    check_time(stream, tags[next_time_tag].value, first_out + produced);
+                    d_checked_offset.at(stream) = in_offset + 1;
+                    continue;
+                }
+
+            // drop or copy up to the next rx_time tag
+            unsigned long long n = n_in - consumed;
+            if (next_time_tag < tags.size())
+                {
+                    n = std::min(n, tags[next_time_tag].offset - in_offset);
+                }
+            if (d_pending_drop.at(stream) > 0)
+                {
+                    n = std::min(n, d_pending_drop.at(stream));
+                    d_pending_drop.at(stream) -= n;
+                    d_dropped_samples.at(stream) += n;
+                    while ((next_tag < tags.size()) && (tags[next_tag].offset < in_offset + n))
+                        {
+                            next_tag++; // the tags of the dropped items are lost
+                        }
+                    consumed += n;
+                    continue;
+                }
+            n = std::min<unsigned long long>(n, noutput_items - produced);
+            std::memcpy(out + produced * item_size, in + consumed * item_size, n * item_size);
+            const unsigned long long shift = first_out + produced - in_offset;
+            for (; (next_tag < tags.size()) && (tags[next_tag].offset < in_offset + n); next_tag++)
+                {
+                    if (!pmt::eqv(tags[next_tag].key, rx_time_key))
+                        {
+                            add_item_tag(stream, tags[next_tag].offset + shift, tags[next_tag].key, tags[next_tag].value, tags[next_tag].srcid);
+                        }
+                }
+            produced += n;
+            consumed += n;
+        }
+    return produced;
+}
+
+
+int source_aligner::general_work (int noutput_items, gr_vector_int &ninput_items,
+        gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
+{
+    const size_t streams = d_item_sizes.size();
+    std::vector<int> consumed(streams, 0);
+    if (!d_aligned)
+        {
+            if (!d_use_rx_time || search(ninput_items, consumed))
+                {
+                    std::vector<unsigned long long> next_offsets(streams);
+                    for (unsigned int i = 0; i < streams; i++)
+                        {
+                            next_offsets.at(i) = nitems_read(i) + consumed.at(i);
+                        }
+                    align(next_offsets);
+                }
+            else
+                {
+                    for (unsigned int i = 0; i < streams; i++)
+                        {
+                            consume(i, consumed.at(i));
+                        }
+                    return 0;
+                }
+        }
+
+    // the time written on the slowest stream bounds the others
+    double slowest_s = 0.0;
+    for (unsigned int i = 0; i < streams; i++)
+        {
+            const double written_s = static_cast<double>(nitems_written(i)) / d_sample_rates_hz.at(i);
+            slowest_s = (i == 0) ? written_s : std::min(slowest_s, written_s);
+        }
+    for (unsigned int i = 0; i < streams; i++)
+        {
+            int limit = noutput_items;
+            if (d_max_skew_s > 0.0)
+                {
+                    const double allowed = std::floor((slowest_s + d_max_skew_s) * d_sample_rates_hz.at(i)) - static_cast<double>(nitems_written(i));
+                    limit = static_cast<int>(std::max(0.0, std::min(allowed, static_cast<double>(noutput_items))));
+                }
+            int stream_consumed = 0;
+            const int produced = work_stream(i, limit, nitems_read(i) + consumed.at(i), ninput_items[i] - consumed.at(i),
+                    static_cast<const char *>(input_items[i]) + consumed.at(i) * d_item_sizes.at(i),
+                    static_cast<char *>(output_items[i]), stream_consumed);
+            consume(i, consumed.at(i) + stream_consumed);
+            produce(i, produced);
+        }
+    return WORK_CALLED_PRODUCE;
+}
@@ -0,0 +1,133 @@
+/*!
+ * \file source_aligner.h
+ * \brief Block that brings the streams of several signal sources to a
+ * common first sample, and keeps them in step
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_SOURCE_ALIGNER_H
+#define GNSS_SDR_SOURCE_ALIGNER_H
+
+#include <vector>
+#include <gnuradio/block.h>
+
+class source_aligner;
+
+typedef boost::shared_ptr<source_aligner> source_aligner_sptr;
+
+/*!
+ * \brief Makes the block for one stream per entry of item_sizes.
+ *
+ * sample_rates_hz are the sampling rates of the streams, and
+ * offset_samples the number of leading samples each stream has more than
+ * the others when there are no rx_time tags to measure it. With use_rx_time,
+ * the block waits up to max_latency_s of samples for an rx_time tag on
+ * every stream. A stream is never let ahead of the slowest one by more than
+ * max_skew_s (0 disables the limit).
+ */
+source_aligner_sptr make_source_aligner(const std::vector<size_t> & item_sizes,
+        const std::vector<double> & sample_rates_hz,
+        const std::vector<long long> & offset_samples,
+        bool use_rx_time, double max_latency_s, double max_skew_s);
+
+/*!
+ * \brief Aligns the sample streams of several front-ends before the signal
+ * conditioners.
+ *
+ * Every stream counts its own samples, and the channels take that count as
+ * their time, so the observables of channels fed by different sources are
+ * only consistent if the item n of every stream was sampled at the same
+ * time. A multichannel device starts all its streams together, but separate
+ * front-ends (or files recorded by them) do not.
+ *
+ * The block first gives each stream a time for each item: from its first
+ * rx_time tag or, without tags, from its configured offset. It then drops the
+ * leading items of every stream up to the latest first sample among them,
+ * so the output item 0 of all the streams is the same instant. After that,
+ * every rx_time tag is checked against that common time: missing samples are
+ * filled with zeros and extra samples are dropped, and the streams keep in
+ * step through overflows. Each output stream starts with an rx_time tag with
+ * the common time. The rx_time tags of the inputs are not propagated, since
+ * they no longer match the output items; the other tags are.
+ */
+class source_aligner: public gr::block
+{
+private:
+    friend source_aligner_sptr make_source_aligner(const std::vector<size_t> & item_sizes,
+            const std::vector<double> & sample_rates_hz,
+            const std::vector<long long> & offset_samples,
+            bool use_rx_time, double max_latency_s, double max_skew_s);
+    source_aligner(const std::vector<size_t> & item_sizes,
+            const std::vector<double> & sample_rates_hz,
+            const std::vector<long long> & offset_samples,
+            bool use_rx_time, double max_latency_s, double max_skew_s);
+
+    bool search(gr_vector_int &ninput_items, std::vector<int> & consumed);
+    void align(const std::vector<unsigned long long> & next_offsets);
+    void check_time(unsigned int stream, const pmt::pmt_t & rx_time, unsigned long long output_offset);
+    int work_stream(unsigned int stream, int noutput_items, unsigned long long first_in, int n_in,
+            const char *in, char *out, int & consumed);
+
+    std::vector<size_t> d_item_sizes;
+    std::vector<double> d_sample_rates_hz;
+    std::vector<long long> d_offset_samples;
+    bool d_use_rx_time;
+    double d_max_latency_s;
+    double d_max_skew_s;
+    bool d_aligned;
+
+    // time of the item d_reference_offset of each stream, while aligning
+    std::vector<bool> d_have_reference;
+    std::vector<unsigned long long> d_reference_secs;
+    std::vector<double> d_reference_frac_secs;
+    std::vector<unsigned long long> d_reference_offset;
+
+    // time of the output item 0 of each stream, the same for all unless the time of a source jumps back
+    std::vector<unsigned long long> d_start_secs;
+    std::vector<double> d_start_frac_secs;
+
+    std::vector<unsigned long long> d_pending_drop;
+    std::vector<unsigned long long> d_pending_zeros;
+    std::vector<unsigned long long> d_checked_offset; // input offset of the last rx_time tag checked, plus one
+    std::vector<unsigned long long> d_dropped_samples;
+    std::vector<unsigned long long> d_inserted_samples;
+
+public:
+    ~source_aligner();
+
+    bool aligned() const { return d_aligned; }
+    //! Leading and extra samples dropped from the stream
+    unsigned long long dropped_samples(unsigned int stream) const { return d_dropped_samples.at(stream); }
+    //! Zeros inserted in the stream for missing samples
+    unsigned long long inserted_samples(unsigned int stream) const { return d_inserted_samples.at(stream); }
+
+    void forecast (int noutput_items, gr_vector_int &ninput_items_required);
+
+    int general_work (int noutput_items, gr_vector_int &ninput_items,
+            gr_vector_const_void_star &input_items, gr_vector_void_star &output_items);
+};
+
+#endif
@@ -31,20 +31,7 @@
 
 #include "unpack_2bit_samples.h"
 #include <gnuradio/io_signature.h>
-
-struct byte_2bit_struct
-{
-  signed sample_0:2;  // <- 2 bits wide only
-  signed sample_1:2;  // <- 2 bits wide only
-  signed sample_2:2;  // <- 2 bits wide only
-  signed sample_3:2;  // <- 2 bits wide only
-};
-
-union byte_and_samples
-{
-    int8_t byte;
-    byte_2bit_struct samples;
-};
+#include <volk_gnsssdr/volk_gnsssdr.h>
 
 bool systemIsBigEndian()
 {
@@ -57,14 +44,6 @@ bool systemIsBigEndian()
     return test_int.c[0] == 1; 
 }
 
-bool systemBytesAreBigEndian()
-{
-    byte_and_samples b;
-    b.byte = static_cast< int8_t>(0x1B);
-
-    return b.samples.sample_0 == 0x3;
-}
-
 void swapEndianness( int8_t const *in, std::vector< int8_t > &out, size_t item_size, unsigned int ninput_items )
 {
     unsigned int i;
@@ -119,10 +98,15 @@ unpack_2bit_samples::unpack_2bit_samples( bool big_endian_bytes,
     swap_endian_items_ = ( item_size_ > 1 ) && 
                          ( big_endian_system != big_endian_items);
 
-    bool big_endian_bytes_system = systemBytesAreBigEndian();
-
-    swap_endian_bytes_ = ( big_endian_bytes_system != big_endian_bytes_ );
-
+    // 2-bit code k of a byte is (byte >> 2k) & 3. Its sample is 2*s + 1
+    // for the signed 2-bit value s of the code
+    levels_[0] = 1;
+    levels_[1] = 3;
+    levels_[2] = -3;
+    levels_[3] = -1;
+    // the most significant pair first if the samples are big endian in the
+    // byte, and the pairs swapped if the interleaving is reversed
+    sample_order_mask_ = ( big_endian_bytes_ ? 3 : 0 ) ^ ( reverse_interleaving_ ? 1 : 0 );
 }
 
 unpack_2bit_samples::~unpack_2bit_samples()
@@ -141,83 +125,16 @@ int unpack_2bit_samples::work(int noutput_items,
     // Handle endian swap if needed
     if( swap_endian_items_ )
     {
-        work_buffer_.reserve( ninput_bytes );
+        work_buffer_.resize( ninput_bytes );
         swapEndianness( in, work_buffer_, item_size_, ninput_items );
 
         in = const_cast< signed char const *> ( &work_buffer_[0] );
     }
 
     // Here the in pointer can be interpreted as a stream of bytes to be
-    // converted. But we now have two possibilities:
-    // 1) The samples in a byte are in big endian order
-    // 2) The samples in a byte are in little endian order
-
-    byte_and_samples raw_byte;
-    int n = 0;
-
-    if( !reverse_interleaving_ )
-    {
-        if( swap_endian_bytes_ )
-        {
-            for(unsigned int i = 0; i < ninput_bytes; ++i)
-            {
-                // Read packed input sample (1 byte = 4 samples)
-                raw_byte.byte = in[i];
-
-                out[n++] = (int8_t)( 2*raw_byte.samples.sample_3 + 1 );
-                out[n++] = (int8_t)( 2*raw_byte.samples.sample_2 + 1 );
-                out[n++] = (int8_t)( 2*raw_byte.samples.sample_1 + 1 );
-                out[n++] = (int8_t)( 2*raw_byte.samples.sample_0 + 1 );
-
-            }
-        }
-        else
-        {
-            for(unsigned int i = 0; i < ninput_bytes; ++i )
-            {
-
-                // Read packed input sample (1 byte = 4 samples)
-                raw_byte.byte = in[i];
-
-                out[n++] = (int8_t)( 2*raw_byte.samples.sample_0 + 1 );
-                out[n++] = (int8_t)( 2*raw_byte.samples.sample_1 + 1 );
-                out[n++] = (int8_t)( 2*raw_byte.samples.sample_2 + 1 );
-                out[n++] = (int8_t)( 2*raw_byte.samples.sample_3 + 1 );
-            }
-        }
-    }
-    else
-    {
-
-        if( swap_endian_bytes_ )
-        {
-            for(unsigned int i = 0; i < ninput_bytes; ++i)
-            {
-                // Read packed input sample (1 byte = 4 samples)
-                raw_byte.byte = in[i];
-
-                out[n++] = (int8_t)( 2*raw_byte.samples.sample_2 + 1 );
-                out[n++] = (int8_t)( 2*raw_byte.samples.sample_3 + 1 );
-                out[n++] = (int8_t)( 2*raw_byte.samples.sample_0 + 1 );
-                out[n++] = (int8_t)( 2*raw_byte.samples.sample_1 + 1 );
-
-            }
-        }
-        else
-        {
-            for(unsigned int i = 0; i < ninput_bytes; ++i )
-            {
-
-                // Read packed input sample (1 byte = 4 samples)
-                raw_byte.byte = in[i];
-
-                out[n++] = (int8_t)( 2*raw_byte.samples.sample_1 + 1 );
-                out[n++] = (int8_t)( 2*raw_byte.samples.sample_0 + 1 );
-                out[n++] = (int8_t)( 2*raw_byte.samples.sample_3 + 1 );
-                out[n++] = (int8_t)( 2*raw_byte.samples.sample_2 + 1 );
-            }
-        }
-    }
+    // converted, with the samples of a byte in the order given by
+    // sample_order_mask_
+    volk_gnsssdr_8u_unpack_2bit_8i((char*)out, (const unsigned char*)in, levels_, sample_order_mask_, ninput_bytes);
 
     return noutput_items;
 }
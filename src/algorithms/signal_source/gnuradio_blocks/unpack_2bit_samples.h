@@ -98,8 +98,9 @@ private:
     size_t item_size_;
     bool big_endian_items_;
     bool swap_endian_items_;
-    bool swap_endian_bytes_;
     bool reverse_interleaving_;
+    char levels_[4];                 // sample of each 2-bit code
+    unsigned int sample_order_mask_; // see volk_gnsssdr_8u_unpack_2bit_8i
     std::vector< int8_t > work_buffer_;
 
 public:
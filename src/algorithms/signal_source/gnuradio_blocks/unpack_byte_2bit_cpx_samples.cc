@@ -35,11 +35,10 @@
 
 #include "unpack_byte_2bit_cpx_samples.h"
 #include <gnuradio/io_signature.h>
+#include <volk_gnsssdr/volk_gnsssdr.h>
 
-struct byte_2bit_struct
-{
-    signed two_bit_sample:2;  // <- 2 bits wide only
-};
+// 2*s + 1 for the signed value s of each 2-bit code
+static const char unpack_byte_2bit_cpx_levels[4] = {1, 3, -3, -1};
 
 
 unpack_byte_2bit_cpx_samples_sptr make_unpack_byte_2bit_cpx_samples()
@@ -60,47 +59,20 @@ int unpack_byte_2bit_cpx_samples::work(int noutput_items,
         gr_vector_const_void_star &input_items,
         gr_vector_void_star &output_items)
 {
-    const signed char *in = (const signed char *)input_items[0];
+    const unsigned char *in = (const unsigned char *)input_items[0];
     short *out = (short*)output_items[0];
 
-    byte_2bit_struct sample;
-    int n = 0;
-    for(int i = 0; i < noutput_items/4; i++)
+    // Read packed input samples (1 byte = 2 complex samples)
+    //*     Packing Order
+    //*     Most Significant Nibble  - Sample n
+    //*     Least Significant Nibble - Sample n+1
+    //*     Packing order in Nibble Q1 Q0 I1 I0
+    // with I/Q swap: I[n] Q[n] I[n+1] Q[n+1] are the codes 2, 3, 0 and 1 of the byte
+    work_buffer_.resize(noutput_items);
+    volk_gnsssdr_8u_unpack_2bit_8i(&work_buffer_[0], in, unpack_byte_2bit_cpx_levels, 2, noutput_items / 4);
+    for(int i = 0; i < noutput_items; i++)
         {
-            // Read packed input sample (1 byte = 2 complex samples)
-            //*     Packing Order
-            //*     Most Significant Nibble  - Sample n
-            //*     Least Significant Nibble - Sample n+1
-            //*     Packing order in Nibble Q1 Q0 I1 I0
-            //normal
-            //  signed char c = in[i];
-            //  //Q[n]
-            //  sample.two_bit_sample = (c>>6) & 3;
-            //  out[n++] = (2*(short)sample.two_bit_sample+1);
-            //  //I[n]
-            //  sample.two_bit_sample = (c>>4) & 3;
-            //  out[n++] = (2*(short)sample.two_bit_sample+1);
-            //  //Q[n+1]
-            //  sample.two_bit_sample = (c>>2) & 3;
-            //  out[n++] = (2*(short)sample.two_bit_sample+1);
-            //  //I[n+1]
-            //  sample.two_bit_sample = c & 3;
-            //  out[n++] = (2*(short)sample.two_bit_sample+1);
-
-            //I/Q swap
-            signed char c = in[i];
-            //I[n]
-            sample.two_bit_sample = (c >> 4) & 3;
-            out[n++] = (2*(short)sample.two_bit_sample + 1);
-            //Q[n]
-            sample.two_bit_sample = (c >> 6) & 3;
-            out[n++] = (2*(short)sample.two_bit_sample + 1);
-            //I[n+1]
-            sample.two_bit_sample = c & 3;
-            out[n++] = (2*(short)sample.two_bit_sample + 1);
-            //Q[n+1]
-            sample.two_bit_sample = (c >> 2) & 3;
-            out[n++] = (2*(short)sample.two_bit_sample + 1);
+            out[i] = work_buffer_[i];
         }
     return noutput_items;
 }
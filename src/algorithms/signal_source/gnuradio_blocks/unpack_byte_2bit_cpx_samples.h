@@ -35,6 +35,7 @@
 #ifndef GNSS_SDR_UNPACK_BYTE_2BIT_CPX_SAMPLES_H
 #define GNSS_SDR_UNPACK_BYTE_2BIT_CPX_SAMPLES_H
 
+#include <vector>
 #include <gnuradio/sync_interpolator.h>
 
 class unpack_byte_2bit_cpx_samples;
@@ -51,6 +52,7 @@ class unpack_byte_2bit_cpx_samples: public gr::sync_interpolator
 {
 private:
     friend unpack_byte_2bit_cpx_samples_sptr make_unpack_byte_2bit_cpx_samples_sptr();
+    std::vector<char> work_buffer_;
 
 public:
     unpack_byte_2bit_cpx_samples();
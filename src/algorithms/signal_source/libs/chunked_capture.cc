@@ -0,0 +1,636 @@
+/*!
+ * \file chunked_capture.cc
+ * \brief Chunked capture files: losslessly compressed raw samples with an
+ * index, so that any sample can be reached without decoding the file
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "chunked_capture.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define CHUNKED_CAPTURE_MAGIC "GNSSCCAP"
+#define CHUNKED_CAPTURE_VERSION 1
+#define CHUNKED_CAPTURE_HEADER_BYTES 64
+#define CHUNKED_CAPTURE_FLAG_COMPLEX 1
+#define CHUNK_HEADER_BYTES 8
+#define CHUNK_RAW 0
+#define CHUNK_PACKED 1
+#define CHUNK_TABLE 2
+#define CHUNK_RICE 3
+#define CHUNK_TABLE_MAX 16
+#define RICE_MAX_K 15
+#define RICE_ESCAPE 24   // unary prefixes this long are followed by the raw value
+
+
+namespace
+{
+
+void put_u32(unsigned char* p, unsigned int v)
+{
+    for (int i = 0; i < 4; i++) p[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+void put_u64(unsigned char* p, unsigned long long v)
+{
+    for (int i = 0; i < 8; i++) p[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+unsigned int get_u32(const unsigned char* p)
+{
+    unsigned int v = 0;
+    for (int i = 0; i < 4; i++) v |= static_cast<unsigned int>(p[i]) << (8 * i);
+    return v;
+}
+
+unsigned long long get_u64(const unsigned char* p)
+{
+    unsigned long long v = 0;
+    for (int i = 0; i < 8; i++) v |= static_cast<unsigned long long>(p[i]) << (8 * i);
+    return v;
+}
+
+unsigned int bits_of(unsigned int v)
+{
+    unsigned int bits = 0;
+    while (v >> bits) bits++;
+    return bits;
+}
+
+int value_at(const void* values, unsigned int value_bytes, unsigned int n)
+{
+    if (value_bytes == 1) return static_cast<const signed char*>(values)[n];
+    return static_cast<const short*>(values)[n];
+}
+
+void set_value(void* values, unsigned int value_bytes, unsigned int n, int v)
+{
+    if (value_bytes == 1) static_cast<signed char*>(values)[n] = static_cast<signed char>(v);
+    else static_cast<short*>(values)[n] = static_cast<short>(v);
+}
+
+unsigned int zigzag(int v)
+{
+    return (static_cast<unsigned int>(v) << 1) ^ static_cast<unsigned int>(v >> 31);
+}
+
+int unzigzag(unsigned int u)
+{
+    return static_cast<int>(u >> 1) ^ -static_cast<int>(u & 1);
+}
+
+
+/*
+ * Bits are stored from the least significant bit of each byte on
+ */
+class Bit_Writer
+{
+public:
+    explicit Bit_Writer(std::vector<unsigned char>& out) : d_out(out), d_acc(0), d_bits(0) {}
+
+    void put(unsigned int value, unsigned int bits)   // bits <= 32
+    {
+        d_acc |= static_cast<unsigned long long>(value) << d_bits;
+        d_bits += bits;
+        while (d_bits >= 8)
+            {
+                d_out.push_back(static_cast<unsigned char>(d_acc));
+                d_acc >>= 8;
+                d_bits -= 8;
+            }
+    }
+
+    void flush()
+    {
+        if (d_bits > 0) d_out.push_back(static_cast<unsigned char>(d_acc));
+        d_acc = 0;
+        d_bits = 0;
+    }
+
+private:
+    std::vector<unsigned char>& d_out;
+    unsigned long long d_acc;
+    unsigned int d_bits;
+};
+
+
+class Bit_Reader
+{
+public:
+    Bit_Reader(const unsigned char* begin, const unsigned char* end) :
+        d_p(begin), d_end(end), d_acc(0), d_bits(0), d_padding(0) {}
+
+    unsigned int get(unsigned int bits)   // bits <= 32
+    {
+        refill(bits);
+        unsigned int value = static_cast<unsigned int>(d_acc & ((1ULL << bits) - 1));
+        d_acc >>= bits;
+        d_bits -= bits;
+        return value;
+    }
+
+    // number of one bits before the next zero, up to limit; the zero is consumed
+    unsigned int unary(unsigned int limit)
+    {
+        refill(limit + 1);
+        unsigned int ones = __builtin_ctzll(~d_acc);
+        if (ones >= limit)
+            {
+                d_acc >>= limit;
+                d_bits -= limit;
+                return limit;
+            }
+        d_acc >>= ones + 1;
+        d_bits -= ones + 1;
+        return ones;
+    }
+
+    // true if bits past the end were consumed
+    bool overrun() const { return d_padding > d_bits; }
+
+private:
+    void refill(unsigned int bits)
+    {
+        while (d_bits < bits)
+            {
+                if (d_p == d_end)
+                    {
+                        // reading past the end gives ones, so that unary() stops
+                        d_acc |= 0xFFULL << d_bits;
+                        d_padding += 8;
+                    }
+                else
+                    {
+                        d_acc |= static_cast<unsigned long long>(*d_p++) << d_bits;
+                    }
+                d_bits += 8;
+            }
+    }
+
+    const unsigned char* d_p;
+    const unsigned char* d_end;
+    unsigned long long d_acc;
+    unsigned int d_bits;
+    unsigned int d_padding;
+};
+
+}  // namespace
+
+
+
+std::string chunked_capture_item_type(const Chunked_Capture_Header& header)
+{
+    if (header.value_bytes == 1)
+        {
+            return header.is_complex ? "ibyte" : "byte";
+        }
+    return header.is_complex ? "ishort" : "short";
+}
+
+
+
+void chunked_capture_encode(const void* values, unsigned int n_values, unsigned int value_bytes,
+        std::vector<unsigned char>& encoded)
+{
+    const int first = (value_bytes == 1) ? -128 : -32768;
+    const unsigned int range = (value_bytes == 1) ? 256 : 65536;
+    std::vector<unsigned int> histogram(range, 0);
+    for (unsigned int n = 0; n < n_values; n++)
+        {
+            histogram[value_at(values, value_bytes, n) - first]++;
+        }
+
+    int min = 0;
+    int max = 0;
+    bool empty = true;
+    std::vector<int> table;
+    for (unsigned int i = 0; i < range; i++)
+        {
+            if (histogram[i] == 0) continue;
+            int v = first + static_cast<int>(i);
+            if (empty) min = v;
+            max = v;
+            empty = false;
+            if (table.size() <= CHUNK_TABLE_MAX) table.push_back(v);
+        }
+
+    // size of the payload of each format, in bits
+    const unsigned long long raw_bits = 8ULL * value_bytes * n_values;
+    unsigned int packed_width = bits_of(static_cast<unsigned int>(max - min));
+    unsigned long long packed_bits = static_cast<unsigned long long>(packed_width) * n_values;
+    unsigned int table_width = 0;
+    unsigned long long table_bits = raw_bits + 1;
+    if (table.size() <= CHUNK_TABLE_MAX && !table.empty())
+        {
+            table_width = bits_of(static_cast<unsigned int>(table.size() - 1));
+            table_bits = 16ULL * table.size() + static_cast<unsigned long long>(table_width) * n_values;
+        }
+    unsigned int rice_k = 0;
+    unsigned long long rice_bits = raw_bits + 1;
+    for (unsigned int k = 0; k <= RICE_MAX_K && k < 8 * value_bytes; k++)
+        {
+            unsigned long long bits = 0;
+            for (unsigned int i = 0; i < range; i++)
+                {
+                    if (histogram[i] == 0) continue;
+                    unsigned int q = zigzag(first + static_cast<int>(i)) >> k;
+                    unsigned long long code = (q < RICE_ESCAPE) ? q + 1 + k : RICE_ESCAPE + 8 * value_bytes;
+                    bits += code * histogram[i];
+                }
+            if (bits < rice_bits)
+                {
+                    rice_bits = bits;
+                    rice_k = k;
+                }
+        }
+
+    unsigned char method = CHUNK_RAW;
+    unsigned long long best = raw_bits;
+    if (packed_bits < best) { method = CHUNK_PACKED; best = packed_bits; }
+    if (table_bits < best) { method = CHUNK_TABLE; best = table_bits; }
+    if (rice_bits < best) { method = CHUNK_RICE; best = rice_bits; }
+
+    encoded.clear();
+    encoded.reserve(CHUNK_HEADER_BYTES + (best + 7) / 8);
+    encoded.resize(CHUNK_HEADER_BYTES, 0);
+    encoded[0] = method;
+    Bit_Writer writer(encoded);
+    switch (method)
+    {
+    case CHUNK_PACKED:
+        encoded[1] = static_cast<unsigned char>(packed_width);
+        put_u32(&encoded[4], static_cast<unsigned int>(min));
+        for (unsigned int n = 0; n < n_values; n++)
+            {
+                writer.put(static_cast<unsigned int>(value_at(values, value_bytes, n) - min), packed_width);
+            }
+        break;
+    case CHUNK_TABLE:
+        {
+            encoded[1] = static_cast<unsigned char>(table_width);
+            encoded[2] = static_cast<unsigned char>(table.size());
+            unsigned char index[65536];
+            for (unsigned int i = 0; i < table.size(); i++)
+                {
+                    writer.put(static_cast<unsigned int>(table[i]) & 0xFFFF, 16);
+                    index[table[i] - first] = static_cast<unsigned char>(i);
+                }
+            for (unsigned int n = 0; n < n_values; n++)
+                {
+                    writer.put(index[value_at(values, value_bytes, n) - first], table_width);
+                }
+            break;
+        }
+    case CHUNK_RICE:
+        encoded[1] = static_cast<unsigned char>(rice_k);
+        for (unsigned int n = 0; n < n_values; n++)
+            {
+                unsigned int u = zigzag(value_at(values, value_bytes, n));
+                unsigned int q = u >> rice_k;
+                if (q < RICE_ESCAPE)
+                    {
+                        writer.put((1U << q) - 1, q + 1);   // q ones and a zero
+                        writer.put(u & ((1U << rice_k) - 1), rice_k);
+                    }
+                else
+                    {
+                        writer.put((1U << RICE_ESCAPE) - 1, RICE_ESCAPE);
+                        writer.put(u, 8 * value_bytes);
+                    }
+            }
+        break;
+    default:
+        for (unsigned int n = 0; n < n_values; n++)
+            {
+                writer.put(static_cast<unsigned int>(value_at(values, value_bytes, n)) & ((1U << (8 * value_bytes)) - 1), 8 * value_bytes);
+            }
+        break;
+    }
+    writer.flush();
+}
+
+
+
+bool chunked_capture_decode(const unsigned char* encoded, size_t encoded_bytes, unsigned int value_bytes,
+        unsigned int n_values, void* values)
+{
+    if (encoded_bytes < CHUNK_HEADER_BYTES || (value_bytes != 1 && value_bytes != 2))
+        {
+            return false;
+        }
+    const unsigned int method = encoded[0];
+    const unsigned int param = encoded[1];
+    Bit_Reader reader(encoded + CHUNK_HEADER_BYTES, encoded + encoded_bytes);
+    const unsigned int value_bits = 8 * value_bytes;
+    switch (method)
+    {
+    case CHUNK_RAW:
+        for (unsigned int n = 0; n < n_values; n++)
+            {
+                unsigned int u = reader.get(value_bits);
+                set_value(values, value_bytes, n, (value_bytes == 1) ? static_cast<signed char>(u) : static_cast<short>(u));
+            }
+        break;
+    case CHUNK_PACKED:
+        {
+            if (param > value_bits) return false;
+            int min = static_cast<int>(get_u32(encoded + 4));
+            for (unsigned int n = 0; n < n_values; n++)
+                {
+                    set_value(values, value_bytes, n, min + static_cast<int>(reader.get(param)));
+                }
+            break;
+        }
+    case CHUNK_TABLE:
+        {
+            unsigned int entries = encoded[2];
+            if (entries == 0 || entries > CHUNK_TABLE_MAX || param > 4) return false;
+            int table[1 << 4];
+            for (unsigned int i = 0; i < entries; i++)
+                {
+                    table[i] = static_cast<short>(reader.get(16));
+                }
+            for (unsigned int n = 0; n < n_values; n++)
+                {
+                    unsigned int i = reader.get(param);
+                    if (i >= entries) return false;
+                    set_value(values, value_bytes, n, table[i]);
+                }
+            break;
+        }
+    case CHUNK_RICE:
+        {
+            if (param > RICE_MAX_K) return false;
+            for (unsigned int n = 0; n < n_values; n++)
+                {
+                    unsigned int q = reader.unary(RICE_ESCAPE);
+                    unsigned int u;
+                    if (q < RICE_ESCAPE)
+                        {
+                            u = (q << param) | reader.get(param);
+                        }
+                    else
+                        {
+                            u = reader.get(value_bits);
+                        }
+                    set_value(values, value_bytes, n, unzigzag(u));
+                }
+            break;
+        }
+    default:
+        return false;
+    }
+    return !reader.overrun();
+}
+
+
+
+Chunked_Capture_Writer::Chunked_Capture_Writer() :
+        d_pending_values(0),
+        d_offset(0)
+{
+    std::memset(&d_header, 0, sizeof(d_header));
+}
+
+
+Chunked_Capture_Writer::~Chunked_Capture_Writer()
+{
+    close();
+}
+
+
+bool Chunked_Capture_Writer::open(const std::string& filename, unsigned int value_bytes, bool is_complex,
+        double sampling_frequency, unsigned int chunk_values)
+{
+    close();
+    if ((value_bytes != 1 && value_bytes != 2) || chunk_values == 0)
+        {
+            return false;
+        }
+    d_file.open(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!d_file.is_open())
+        {
+            return false;
+        }
+    d_header.value_bytes = value_bytes;
+    d_header.is_complex = is_complex;
+    d_header.chunk_values = chunk_values;
+    d_header.sampling_frequency = sampling_frequency;
+    d_header.total_values = 0;
+    d_header.chunks = 0;
+    d_pending.assign(static_cast<size_t>(chunk_values) * value_bytes, 0);
+    d_pending_values = 0;
+    d_index.clear();
+    // the header is written again by close(), with the index offset
+    unsigned char header[CHUNKED_CAPTURE_HEADER_BYTES] = {0};
+    d_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    d_offset = sizeof(header);
+    return d_file.good();
+}
+
+
+bool Chunked_Capture_Writer::flush_chunk()
+{
+    chunked_capture_encode(&d_pending[0], d_pending_values, d_header.value_bytes, d_encoded);
+    d_file.write(reinterpret_cast<const char*>(&d_encoded[0]), d_encoded.size());
+    d_index.push_back(d_offset);
+    d_offset += d_encoded.size();
+    d_header.chunks++;
+    d_pending_values = 0;
+    return d_file.good();
+}
+
+
+bool Chunked_Capture_Writer::write(const void* values, unsigned long long n_values)
+{
+    if (!d_file.is_open())
+        {
+            return false;
+        }
+    const unsigned char* p = static_cast<const unsigned char*>(values);
+    while (n_values > 0)
+        {
+            unsigned int n = static_cast<unsigned int>(std::min<unsigned long long>(n_values, d_header.chunk_values - d_pending_values));
+            std::memcpy(&d_pending[static_cast<size_t>(d_pending_values) * d_header.value_bytes], p, static_cast<size_t>(n) * d_header.value_bytes);
+            p += static_cast<size_t>(n) * d_header.value_bytes;
+            d_pending_values += n;
+            d_header.total_values += n;
+            n_values -= n;
+            if (d_pending_values == d_header.chunk_values && !flush_chunk())
+                {
+                    return false;
+                }
+        }
+    return true;
+}
+
+
+bool Chunked_Capture_Writer::close()
+{
+    if (!d_file.is_open())
+        {
+            return false;
+        }
+    if (d_pending_values > 0)
+        {
+            flush_chunk();
+        }
+    unsigned long long index_offset = d_offset;
+    d_index.push_back(index_offset);
+    std::vector<unsigned char> index(8 * d_index.size());
+    for (unsigned int i = 0; i < d_index.size(); i++)
+        {
+            put_u64(&index[8 * i], d_index[i]);
+        }
+    d_file.write(reinterpret_cast<const char*>(&index[0]), index.size());
+    d_offset += index.size();
+
+    unsigned char header[CHUNKED_CAPTURE_HEADER_BYTES] = {0};
+    std::memcpy(header, CHUNKED_CAPTURE_MAGIC, 8);
+    put_u32(header + 8, CHUNKED_CAPTURE_VERSION);
+    put_u32(header + 12, d_header.value_bytes);
+    put_u32(header + 16, d_header.is_complex ? CHUNKED_CAPTURE_FLAG_COMPLEX : 0);
+    put_u32(header + 20, d_header.chunk_values);
+    unsigned long long fs;
+    std::memcpy(&fs, &d_header.sampling_frequency, sizeof(fs));
+    put_u64(header + 24, fs);
+    put_u64(header + 32, d_header.total_values);
+    put_u64(header + 40, d_header.chunks);
+    put_u64(header + 48, index_offset);
+    d_file.seekp(0);
+    d_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    bool ok = d_file.good();
+    d_file.close();
+    d_file.clear();
+    return ok;
+}
+
+
+
+Chunked_Capture_Reader::Chunked_Capture_Reader() :
+        d_fd(-1)
+{
+    std::memset(&d_header, 0, sizeof(d_header));
+}
+
+
+Chunked_Capture_Reader::~Chunked_Capture_Reader()
+{
+    close();
+}
+
+
+bool Chunked_Capture_Reader::open(const std::string& filename)
+{
+    close();
+    d_fd = ::open(filename.c_str(), O_RDONLY);
+    if (d_fd < 0)
+        {
+            return false;
+        }
+    unsigned char header[CHUNKED_CAPTURE_HEADER_BYTES];
+    if (::pread(d_fd, header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))
+            || std::memcmp(header, CHUNKED_CAPTURE_MAGIC, 8) != 0
+            || get_u32(header + 8) != CHUNKED_CAPTURE_VERSION)
+        {
+            close();
+            return false;
+        }
+    d_header.value_bytes = get_u32(header + 12);
+    d_header.is_complex = (get_u32(header + 16) & CHUNKED_CAPTURE_FLAG_COMPLEX) != 0;
+    d_header.chunk_values = get_u32(header + 20);
+    unsigned long long fs = get_u64(header + 24);
+    std::memcpy(&d_header.sampling_frequency, &fs, sizeof(fs));
+    d_header.total_values = get_u64(header + 32);
+    d_header.chunks = get_u64(header + 40);
+    unsigned long long index_offset = get_u64(header + 48);
+    if ((d_header.value_bytes != 1 && d_header.value_bytes != 2) || d_header.chunk_values == 0
+            || index_offset < CHUNKED_CAPTURE_HEADER_BYTES
+            || d_header.chunks != (d_header.total_values + d_header.chunk_values - 1) / d_header.chunk_values)
+        {
+            close();
+            return false;
+        }
+
+    std::vector<unsigned char> index(8 * (d_header.chunks + 1));
+    if (::pread(d_fd, &index[0], index.size(), index_offset) != static_cast<ssize_t>(index.size()))
+        {
+            close();
+            return false;
+        }
+    d_index.resize(d_header.chunks + 1);
+    for (unsigned long long i = 0; i <= d_header.chunks; i++)
+        {
+            d_index[i] = get_u64(&index[8 * i]);
+            if ((i > 0 && d_index[i] < d_index[i - 1]) || d_index[i] > index_offset)
+                {
+                    close();
+                    return false;
+                }
+        }
+    return true;
+}
+
+
+void Chunked_Capture_Reader::close()
+{
+    if (d_fd >= 0)
+        {
+            ::close(d_fd);
+            d_fd = -1;
+        }
+    d_index.clear();
+}
+
+
+unsigned int Chunked_Capture_Reader::chunk_values(unsigned long long chunk) const
+{
+    if (chunk >= d_header.chunks)
+        {
+            return 0;
+        }
+    unsigned long long first = chunk * d_header.chunk_values;
+    return static_cast<unsigned int>(std::min<unsigned long long>(d_header.chunk_values, d_header.total_values - first));
+}
+
+
+bool Chunked_Capture_Reader::decode_chunk(unsigned long long chunk, std::vector<unsigned char>& encoded, void* values) const
+{
+    if (d_fd < 0 || chunk >= d_header.chunks)
+        {
+            return false;
+        }
+    size_t bytes = static_cast<size_t>(d_index[chunk + 1] - d_index[chunk]);
+    encoded.resize(std::max<size_t>(bytes, 1));
+    if (::pread(d_fd, &encoded[0], bytes, d_index[chunk]) != static_cast<ssize_t>(bytes))
+        {
+            return false;
+        }
+    return chunked_capture_decode(&encoded[0], bytes, d_header.value_bytes, chunk_values(chunk), values);
+}
@@ -0,0 +1,186 @@
+/*!
+ * \file chunked_capture.h
+ * \brief Chunked capture files: losslessly compressed raw samples with an
+ * index, so that any sample can be reached without decoding the file
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_CHUNKED_CAPTURE_H_
+#define GNSS_SDR_CHUNKED_CAPTURE_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Description of a chunked capture file.
+ *
+ * The file holds the values of a raw capture of one of the integer item
+ * types (byte, ibyte, short, ishort): signed values of 1 or 2 bytes, the I
+ * and Q values interleaved for the complex types. They are split in
+ * chunks of chunk_values values, only the last one being shorter, and
+ * each chunk is encoded on its own with the smallest of:
+ *
+ *  - raw: the values as they are;
+ *  - packed: value - min with the number of bits of max - min;
+ *  - table: an index into the list of the values present, when there are
+ *    at most 16 of them (the output of 1 to 4 bit quantizers);
+ *  - rice: Rice code of the zig-zag mapped value, for wider Gaussian noise.
+ *
+ * Layout, little endian:
+ *
+ * | offset       | size           | content                                         |
+ * |--------------|----------------|-------------------------------------------------|
+ * |            0 | 64             | header: "GNSSCCAP", version, value_bytes, flags,|
+ * |              |                | chunk_values, sampling_frequency, total_values, |
+ * |              |                | chunks, index_offset                            |
+ * |           64 | variable       | the encoded chunks, one after the other         |
+ * | index_offset | 8 (chunks + 1) | file offset of each chunk, then index_offset    |
+ *
+ * Reaching a sample is one read of the index entry plus the decoding of a
+ * single chunk, and the chunks can be decoded in parallel.
+ */
+struct Chunked_Capture_Header
+{
+    unsigned int value_bytes;           // 1 or 2
+    bool is_complex;                    // interleaved I and Q values
+    unsigned int chunk_values;          // values per chunk
+    double sampling_frequency;          // [samples/s]
+    unsigned long long total_values;
+    unsigned long long chunks;
+};
+
+
+/*!
+ * \brief Item type of the values of the file: "byte", "ibyte", "short" or "ishort"
+ */
+std::string chunked_capture_item_type(const Chunked_Capture_Header& header);
+
+/*!
+ * \brief Encodes n_values signed values of value_bytes bytes each into encoded
+ */
+void chunked_capture_encode(const void* values, unsigned int n_values, unsigned int value_bytes,
+        std::vector<unsigned char>& encoded);
+
+/*!
+ * \brief Decodes a chunk of n_values values into values
+ * \return false if the chunk is corrupt.
+ */
+bool chunked_capture_decode(const unsigned char* encoded, size_t encoded_bytes, unsigned int value_bytes,
+        unsigned int n_values, void* values);
+
+
+/*!
+ * \brief Writes a chunked capture file from a stream of raw values
+ */
+class Chunked_Capture_Writer
+{
+public:
+    Chunked_Capture_Writer();
+    ~Chunked_Capture_Writer();
+
+    /*!
+     * \brief Creates (or truncates) filename
+     * \return false if the file could not be opened or the parameters are wrong.
+     */
+    bool open(const std::string& filename, unsigned int value_bytes, bool is_complex,
+            double sampling_frequency, unsigned int chunk_values = 1048576);
+
+    bool is_open() const { return d_file.is_open(); }
+
+    /*!
+     * \brief Appends n_values values, encoding every chunk completed
+     */
+    bool write(const void* values, unsigned long long n_values);
+
+    /*!
+     * \brief Encodes the last chunk, writes the index and the header and closes the file
+     */
+    bool close();
+
+    unsigned long long total_values() const { return d_header.total_values; }
+    unsigned long long file_bytes() const { return d_offset; }
+
+private:
+    Chunked_Capture_Writer(const Chunked_Capture_Writer&);
+    Chunked_Capture_Writer& operator=(const Chunked_Capture_Writer&);
+
+    bool flush_chunk();
+
+    Chunked_Capture_Header d_header;
+    std::ofstream d_file;
+    std::vector<unsigned char> d_pending;
+    unsigned int d_pending_values;
+    std::vector<unsigned char> d_encoded;
+    std::vector<unsigned long long> d_index;
+    unsigned long long d_offset;
+};
+
+
+/*!
+ * \brief Gives random access to the chunks of a chunked capture file.
+ *
+ * read_chunk and decode_chunk do not change the reader, so several threads
+ * can decode different chunks at the same time.
+ */
+class Chunked_Capture_Reader
+{
+public:
+    Chunked_Capture_Reader();
+    ~Chunked_Capture_Reader();
+
+    /*!
+     * \brief Opens filename and loads its header and index
+     * \return false if the file can not be read or is not a complete chunked capture.
+     */
+    bool open(const std::string& filename);
+    void close();
+    bool is_open() const { return d_fd >= 0; }
+
+    const Chunked_Capture_Header& header() const { return d_header; }
+
+    /*!
+     * \brief Number of values of chunk
+     */
+    unsigned int chunk_values(unsigned long long chunk) const;
+
+    /*!
+     * \brief Decodes chunk into values, which must hold chunk_values(chunk)
+     * values. encoded is used as the read buffer.
+     */
+    bool decode_chunk(unsigned long long chunk, std::vector<unsigned char>& encoded, void* values) const;
+
+private:
+    Chunked_Capture_Reader(const Chunked_Capture_Reader&);
+    Chunked_Capture_Reader& operator=(const Chunked_Capture_Reader&);
+
+    int d_fd;
+    Chunked_Capture_Header d_header;
+    std::vector<unsigned long long> d_index;
+};
+
+#endif
@@ -0,0 +1,323 @@
+/*!
+ * \file iq_stream.cc
+ * \brief Blocks of quantized, optionally compressed I/Q samples streamed from
+ * a remote front end, and the jitter buffer that puts them back in order
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "iq_stream.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <volk_gnsssdr/volk_gnsssdr.h>
+#include "chunked_capture.h"
+
+namespace
+{
+    const char iq_stream_magic[4] = {'G', 'I', 'Q', 'S'};
+    const unsigned char iq_stream_version = 1;
+    const unsigned char compressed_flag = 1;
+
+    // levels of the codes of the 2 and 4 bit quantizers
+    const char levels_2bit[4] = {-3, -1, 1, 3};
+    const char levels_4bit[16] = {-15, -13, -11, -9, -7, -5, -3, -1, 1, 3, 5, 7, 9, 11, 13, 15};
+
+    size_t raw_payload_bytes(unsigned int bits, unsigned int samples)
+    {
+        return static_cast<size_t>(samples) * 2 * bits / 8;
+    }
+
+    template <class T>
+    void put(unsigned char* bytes, size_t offset, T value)
+    {
+        std::memcpy(bytes + offset, &value, sizeof(T));
+    }
+
+    template <class T>
+    T get(const unsigned char* bytes, size_t offset)
+    {
+        T value;
+        std::memcpy(&value, bytes + offset, sizeof(T));
+        return value;
+    }
+}
+
+
+bool iq_stream_valid_bits(unsigned int bits)
+{
+    return bits == 2 || bits == 4 || bits == 8 || bits == 16;
+}
+
+
+std::string iq_stream_item_type(unsigned int bits)
+{
+    return bits == 16 ? "ishort" : "ibyte";
+}
+
+
+size_t iq_stream_value_bytes(unsigned int bits)
+{
+    return bits == 16 ? 2 : 1;
+}
+
+
+void iq_stream_write_header(const Iq_Stream_Header& header, unsigned char* bytes)
+{
+    std::memset(bytes, 0, iq_stream_header_bytes);
+    std::memcpy(bytes, iq_stream_magic, sizeof(iq_stream_magic));
+    bytes[4] = iq_stream_version;
+    bytes[5] = static_cast<unsigned char>(header.bits);
+    bytes[6] = header.compressed ? compressed_flag : 0;
+    put<unsigned long long>(bytes, 8, header.sequence);
+    put<unsigned long long>(bytes, 16, header.first_sample);
+    put<long long>(bytes, 24, header.timestamp_ns);
+    put<unsigned int>(bytes, 32, header.samples);
+    put<unsigned int>(bytes, 36, header.payload_bytes);
+    put<float>(bytes, 40, header.gain_db);
+}
+
+
+bool iq_stream_read_header(const unsigned char* bytes, Iq_Stream_Header& header)
+{
+    if (std::memcmp(bytes, iq_stream_magic, sizeof(iq_stream_magic)) != 0 || bytes[4] != iq_stream_version)
+        {
+            return false;
+        }
+    header.bits = bytes[5];
+    header.compressed = (bytes[6] & compressed_flag) != 0;
+    header.sequence = get<unsigned long long>(bytes, 8);
+    header.first_sample = get<unsigned long long>(bytes, 16);
+    header.timestamp_ns = get<long long>(bytes, 24);
+    header.samples = get<unsigned int>(bytes, 32);
+    header.payload_bytes = get<unsigned int>(bytes, 36);
+    header.gain_db = get<float>(bytes, 40);
+    if (!iq_stream_valid_bits(header.bits) || header.samples == 0 || header.samples > iq_stream_max_samples
+            || (header.bits == 2 && header.samples % 2 != 0))
+        {
+            return false;
+        }
+    size_t raw_bytes = raw_payload_bytes(header.bits, header.samples);
+    if (header.compressed)
+        {
+            // a chunk never takes more than its raw values and its own header
+            return header.bits >= 8 && header.payload_bytes <= raw_bytes + 8;
+        }
+    return header.payload_bytes == raw_bytes;
+}
+
+
+float iq_stream_scale(unsigned int bits, float rms)
+{
+    // the 2 bit threshold at one sigma; the wider quantizers keep 3 to 4 sigma from clipping
+    float target = 2.0;
+    switch (bits)
+    {
+    case 4:
+        target = 5.0;
+        break;
+    case 8:
+        target = 32.0;
+        break;
+    case 16:
+        target = 8192.0;
+        break;
+    default:
+        break;
+    }
+    return rms > 0.0 ? target / rms : 1.0;
+}
+
+
+void iq_stream_quantize(const float* values, unsigned int n_values, float scale, unsigned int bits, short* levels)
+{
+    if (bits <= 4)
+        {
+            // mid-rise: code c covers [2 (c - half), 2 (c - half + 1)) and stands for its centre
+            const float half = static_cast<float>(1 << (bits - 1));
+            const float max_code = static_cast<float>((1 << bits) - 1);
+            for (unsigned int n = 0; n < n_values; n++)
+                {
+                    float code = std::min(std::max(std::floor(values[n] * scale * 0.5f) + half, 0.0f), max_code);
+                    levels[n] = static_cast<short>(2.0f * code - max_code);
+                }
+        }
+    else
+        {
+            const float max_value = static_cast<float>((1 << (bits - 1)) - 1);
+            for (unsigned int n = 0; n < n_values; n++)
+                {
+                    levels[n] = static_cast<short>(std::min(std::max(std::round(values[n] * scale), -max_value - 1.0f), max_value));
+                }
+        }
+}
+
+
+void iq_stream_encode(Iq_Stream_Header& header, const short* levels, std::vector<unsigned char>& block)
+{
+    const unsigned int n_values = 2 * header.samples;
+    const size_t raw_bytes = raw_payload_bytes(header.bits, header.samples);
+    block.resize(iq_stream_header_bytes + raw_bytes);
+    unsigned char* payload = &block[iq_stream_header_bytes];
+    const int max_level = (1 << header.bits) - 1;
+    switch (header.bits)
+    {
+    case 2:
+        for (unsigned int n = 0; n < n_values / 4; n++)
+            {
+                unsigned char byte = 0;
+                for (unsigned int k = 0; k < 4; k++)
+                    {
+                        byte |= static_cast<unsigned char>(((levels[4 * n + k] + max_level) / 2) << (2 * k));
+                    }
+                payload[n] = byte;
+            }
+        break;
+    case 4:
+        for (unsigned int n = 0; n < n_values / 2; n++)
+            {
+                payload[n] = static_cast<unsigned char>(((levels[2 * n] + max_level) / 2) | (((levels[2 * n + 1] + max_level) / 2) << 4));
+            }
+        break;
+    case 8:
+        for (unsigned int n = 0; n < n_values; n++)
+            {
+                payload[n] = static_cast<unsigned char>(static_cast<signed char>(levels[n]));
+            }
+        break;
+    default:
+        std::memcpy(payload, levels, raw_bytes);
+        break;
+    }
+
+    bool compressed = false;
+    if (header.compressed && header.bits >= 8)
+        {
+            std::vector<unsigned char> encoded;
+            chunked_capture_encode(payload, n_values, iq_stream_value_bytes(header.bits), encoded);
+            if (encoded.size() < raw_bytes)
+                {
+                    block.resize(iq_stream_header_bytes + encoded.size());
+                    std::memcpy(&block[iq_stream_header_bytes], &encoded[0], encoded.size());
+                    compressed = true;
+                }
+        }
+    header.compressed = compressed;
+    header.payload_bytes = block.size() - iq_stream_header_bytes;
+    iq_stream_write_header(header, &block[0]);
+}
+
+
+bool iq_stream_decode(const Iq_Stream_Header& header, const unsigned char* payload, void* values)
+{
+    const unsigned int n_values = 2 * header.samples;
+    switch (header.bits)
+    {
+    case 2:
+        volk_gnsssdr_8u_unpack_2bit_8i(static_cast<char*>(values), payload, levels_2bit, 0, n_values / 4);
+        return true;
+    case 4:
+        volk_gnsssdr_8u_unpack_4bit_8i(static_cast<char*>(values), payload, levels_4bit, 0, n_values / 2);
+        return true;
+    default:
+        if (header.compressed)
+            {
+                return chunked_capture_decode(payload, header.payload_bytes, iq_stream_value_bytes(header.bits), n_values, values);
+            }
+        std::memcpy(values, payload, header.payload_bytes);
+        return true;
+    }
+}
+
+
+Iq_Jitter_Buffer::Iq_Jitter_Buffer(unsigned long long depth_samples) :
+        d_depth(depth_samples),
+        d_buffered(0),
+        d_next(0),
+        d_started(false),
+        d_late(0),
+        d_lost(0)
+{}
+
+
+bool Iq_Jitter_Buffer::push(const Iq_Stream_Header& header, std::vector<unsigned char>& block)
+{
+    if ((d_started && header.first_sample < d_next) || d_blocks.count(header.first_sample) != 0)
+        {
+            d_late++;
+            return false;
+        }
+    Buffered_Block& buffered = d_blocks[header.first_sample];
+    buffered.header = header;
+    buffered.bytes.swap(block);
+    d_buffered += header.samples;
+
+    // a reader that does not keep up loses the oldest blocks
+    while (d_started && d_buffered > 8 * d_depth && d_blocks.size() > 1)
+        {
+            std::map<unsigned long long, Buffered_Block>::iterator oldest = d_blocks.begin();
+            d_lost += oldest->first + oldest->second.header.samples - d_next;
+            d_next = oldest->first + oldest->second.header.samples;
+            d_buffered -= oldest->second.header.samples;
+            d_blocks.erase(oldest);
+        }
+    return true;
+}
+
+
+bool Iq_Jitter_Buffer::pop(Iq_Stream_Header& header, std::vector<unsigned char>& block, unsigned long long& gap_samples)
+{
+    gap_samples = 0;
+    if (d_blocks.empty() || (!d_started && d_buffered < d_depth))
+        {
+            return false;
+        }
+    std::map<unsigned long long, Buffered_Block>::iterator next = d_blocks.begin();
+    if (!d_started)
+        {
+            d_started = true;
+            d_next = next->first;
+        }
+    if (next->first > d_next)
+        {
+            // the missing blocks may still come, until the buffer is full
+            if (d_buffered < d_depth)
+                {
+                    return false;
+                }
+            gap_samples = next->first - d_next;
+            d_lost += gap_samples;
+            d_next = next->first;
+            block.clear();
+            return true;
+        }
+    header = next->second.header;
+    block.swap(next->second.bytes);
+    d_next += header.samples;
+    d_buffered -= header.samples;
+    d_blocks.erase(next);
+    return true;
+}
@@ -0,0 +1,163 @@
+/*!
+ * \file iq_stream.h
+ * \brief Blocks of quantized, optionally compressed I/Q samples streamed from
+ * a remote front end, and the jitter buffer that puts them back in order
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_IQ_STREAM_H_
+#define GNSS_SDR_IQ_STREAM_H_
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Header of a block of an I/Q stream.
+ *
+ * A block is the header, iq_stream_header_bytes long, then the payload:
+ * the 2 * samples I and Q values, interleaved, of bits bits each:
+ *
+ *  - 2 and 4 bits: the codes of a mid-rise quantizer, whose levels are the
+ *    odd values from -(2^bits - 1) to 2^bits - 1, packed least significant
+ *    code first;
+ *  - 8 and 16 bits: signed values, little endian. If compressed, they are
+ *    one chunk of chunked_capture_encode(), which is lossless.
+ *
+ * Over TCP the blocks follow each other; over UDP each one is a datagram.
+ * Blocks that are lost or arrive too late are zeros for the receiver, so
+ * first_sample always matches its sample counter.
+ */
+struct Iq_Stream_Header
+{
+    unsigned int bits;                  // of each I or Q value: 2, 4, 8 or 16
+    bool compressed;
+    unsigned long long sequence;        // of the block, from 0
+    unsigned long long first_sample;    // number of the first I/Q sample of the block
+    unsigned int samples;               // I/Q samples of the block
+    long long timestamp_ns;             // host time (CLOCK_REALTIME) of the first sample
+    float gain_db;                      // gain of the streamer before the quantization
+    unsigned int payload_bytes;
+};
+
+const size_t iq_stream_header_bytes = 48;
+const unsigned int iq_stream_max_samples = 65536;  //!< Longest block
+
+bool iq_stream_valid_bits(unsigned int bits);
+
+/*!
+ * \brief Item type of the values the receiver outputs: "ibyte" up to 8 bits, "ishort" for 16 bits
+ */
+std::string iq_stream_item_type(unsigned int bits);
+
+size_t iq_stream_value_bytes(unsigned int bits); //!< Size of the items of iq_stream_item_type()
+
+void iq_stream_write_header(const Iq_Stream_Header& header, unsigned char* bytes);
+
+/*!
+ * \brief Reads the iq_stream_header_bytes of a block
+ * \return false if they are not the header of a valid block.
+ */
+bool iq_stream_read_header(const unsigned char* bytes, Iq_Stream_Header& header);
+
+/*!
+ * \brief Scale that brings input of RMS amplitude rms (of I and Q) to the
+ * amplitude that the bits bits quantizer resolves best
+ */
+float iq_stream_scale(unsigned int bits, float rms);
+
+/*!
+ * \brief Quantizes n_values I and Q values, multiplied by scale, to the
+ * levels of bits bits
+ */
+void iq_stream_quantize(const float* values, unsigned int n_values, float scale, unsigned int bits, short* levels);
+
+/*!
+ * \brief Writes a block of the 2 * header.samples levels, setting
+ * header.payload_bytes. The compression is only used if it saves space.
+ */
+void iq_stream_encode(Iq_Stream_Header& header, const short* levels, std::vector<unsigned char>& block);
+
+/*!
+ * \brief Decodes the payload of a block into 2 * header.samples values of
+ * iq_stream_value_bytes(header.bits) bytes
+ * \return false if the payload is corrupt.
+ */
+bool iq_stream_decode(const Iq_Stream_Header& header, const unsigned char* payload, void* values);
+
+
+/*!
+ * \brief Puts the blocks of a stream back in sample order.
+ *
+ * The output starts once depth_samples samples are buffered, and a
+ * missing block is only given up (as a gap of zeros) while the buffer
+ * holds at least as many: this is the delay that the network jitter may
+ * take. A block that arrives after its samples have been output is late
+ * and dropped. If the reader falls far behind, the oldest blocks are
+ * dropped too, so the buffer never holds more than 8 * depth_samples.
+ */
+class Iq_Jitter_Buffer
+{
+public:
+    explicit Iq_Jitter_Buffer(unsigned long long depth_samples);
+
+    /*!
+     * \brief Takes the block (header and payload) described by header
+     * \return false if the block is late or a duplicate.
+     */
+    bool push(const Iq_Stream_Header& header, std::vector<unsigned char>& block);
+
+    /*!
+     * \brief The next block in sample order, or gap_samples > 0 with an
+     * empty block for the samples of the missing ones
+     * \return false if nothing can be output yet.
+     */
+    bool pop(Iq_Stream_Header& header, std::vector<unsigned char>& block, unsigned long long& gap_samples);
+
+    unsigned long long buffered_samples() const { return d_buffered; }
+    unsigned long long next_sample() const { return d_next; }
+    unsigned long long late_blocks() const { return d_late; }
+    unsigned long long lost_samples() const { return d_lost; }
+
+private:
+    struct Buffered_Block
+    {
+        Iq_Stream_Header header;
+        std::vector<unsigned char> bytes;
+    };
+
+    unsigned long long d_depth;
+    std::map<unsigned long long, Buffered_Block> d_blocks; // by first sample
+    unsigned long long d_buffered;
+    unsigned long long d_next;      // first sample not output yet
+    bool d_started;
+    unsigned long long d_late;
+    unsigned long long d_lost;
+};
+
+#endif
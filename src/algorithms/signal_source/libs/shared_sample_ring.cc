@@ -0,0 +1,295 @@
+
+#include "shared_sample_ring.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+namespace
+{
+    const char ring_magic[8] = {'G', 'N', 'S', 'S', 'R', 'I', 'N', 'G'};
+    const uint32_t ring_version = 1;
+
+    // Fixed fields of the header: magic, version, item_size, capacity, sampling_frequency,
+    // header_bytes (the offset of the data, a page), item_type and the pid of the publisher
+    const size_t version_offset = 8;
+    const size_t item_size_offset = 12;
+    const size_t capacity_offset = 16;
+    const size_t sampling_frequency_offset = 24;
+    const size_t header_bytes_offset = 32;
+    const size_t item_type_offset = 40;
+    const size_t item_type_bytes = 16;
+    const size_t pid_offset = 56;
+    const size_t fixed_header_bytes = 64;
+
+    // the counters, the one the publisher writes most on a cache line of its own
+    const size_t written_offset = 64;
+    const size_t writing_offset = 128;
+    const size_t write_time_offset = 192;
+    const size_t start_time_offset = 200;
+    const size_t closed_offset = 208;
+
+    typedef std::atomic<uint64_t> Ring_Counter;
+    typedef std::atomic<int64_t> Ring_Time;
+    typedef std::atomic<uint32_t> Ring_Flag;
+
+    static_assert(sizeof(Ring_Counter) == sizeof(uint64_t), "the ring counters must be plain words of the file");
+    static_assert(sizeof(Ring_Time) == sizeof(int64_t), "the ring times must be plain words of the file");
+
+    template <class T>
+    T& field(char* header, size_t offset)
+    {
+        return *reinterpret_cast<T*>(header + offset);
+    }
+
+    long long realtime_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+}
+
+
+Shared_Sample_Ring::Shared_Sample_Ring(const std::string& filename, size_t item_size, unsigned long long capacity,
+        const std::string& item_type, double sampling_frequency) :
+    d_filename(filename), d_map(0), d_map_bytes(0), d_data(0), d_item_size(item_size),
+    d_capacity(0), d_item_type(item_type.substr(0, item_type_bytes - 1)), d_sampling_frequency(sampling_frequency),
+    d_publisher(true)
+{
+    if (item_size == 0 || (item_size & (item_size - 1)) != 0)
+        {
+            LOG(WARNING) << "The items of the sample ring " << filename << " must be a power of two bytes long, not " << item_size;
+            return;
+        }
+    // the data is mapped twice in a row, so it spans a whole number of pages
+    size_t page = sysconf(_SC_PAGESIZE);
+    d_capacity = page > item_size ? page / item_size : 1;
+    while (d_capacity < capacity)
+        {
+            d_capacity *= 2;
+        }
+    size_t header_bytes = page;
+    size_t data_bytes = d_capacity * d_item_size;
+
+    // a new file, so that the receivers still mapping the one of a previous publisher never see this one change
+    unlink(filename.c_str());
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+    if (fd == -1)
+        {
+            LOG(WARNING) << "Unable to create the sample ring " << filename << ": " << strerror(errno);
+            return;
+        }
+    fchmod(fd, 0666); // whatever the umask, the receivers of any user can attach
+    if (ftruncate(fd, header_bytes + data_bytes) != 0)
+        {
+            LOG(WARNING) << "Unable to size the sample ring " << filename << ": " << strerror(errno);
+            ::close(fd);
+            unlink(filename.c_str());
+            return;
+        }
+    if (!map(fd, header_bytes, data_bytes, true))
+        {
+            unlink(filename.c_str());
+            return;
+        }
+
+    // the counters are 0; the magic goes last, once the geometry is there
+    uint32_t item_size_field = d_item_size;
+    uint64_t capacity_field = d_capacity;
+    uint64_t header_bytes_field = header_bytes;
+    int32_t pid = getpid();
+    std::memcpy(d_map + version_offset, &ring_version, sizeof(ring_version));
+    std::memcpy(d_map + item_size_offset, &item_size_field, sizeof(item_size_field));
+    std::memcpy(d_map + capacity_offset, &capacity_field, sizeof(capacity_field));
+    std::memcpy(d_map + sampling_frequency_offset, &d_sampling_frequency, sizeof(d_sampling_frequency));
+    std::memcpy(d_map + header_bytes_offset, &header_bytes_field, sizeof(header_bytes_field));
+    std::memcpy(d_map + item_type_offset, d_item_type.c_str(), d_item_type.size());
+    std::memcpy(d_map + pid_offset, &pid, sizeof(pid));
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(d_map, ring_magic, sizeof(ring_magic));
+    LOG(INFO) << "Sample ring " << filename << " of " << d_capacity << " " << d_item_type << " items at "
+              << d_sampling_frequency << " samples/s";
+}
+
+
+Shared_Sample_Ring::Shared_Sample_Ring(const std::string& filename) :
+    d_filename(filename), d_map(0), d_map_bytes(0), d_data(0), d_item_size(0),
+    d_capacity(0), d_sampling_frequency(0.0), d_publisher(false)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+        {
+            LOG(WARNING) << "Unable to open the sample ring " << filename << ": " << strerror(errno);
+            return;
+        }
+    char header[fixed_header_bytes];
+    struct stat file_status;
+    if (fstat(fd, &file_status) != 0 || static_cast<size_t>(file_status.st_size) < fixed_header_bytes
+            || pread(fd, header, fixed_header_bytes, 0) != static_cast<ssize_t>(fixed_header_bytes))
+        {
+            LOG(WARNING) << "The sample ring " << filename << " is truncated";
+            ::close(fd);
+            return;
+        }
+    uint32_t version = 0;
+    uint32_t item_size = 0;
+    uint64_t capacity = 0;
+    uint64_t header_bytes = 0;
+    char item_type[item_type_bytes] = {0};
+    std::memcpy(&version, header + version_offset, sizeof(version));
+    std::memcpy(&item_size, header + item_size_offset, sizeof(item_size));
+    std::memcpy(&capacity, header + capacity_offset, sizeof(capacity));
+    std::memcpy(&d_sampling_frequency, header + sampling_frequency_offset, sizeof(d_sampling_frequency));
+    std::memcpy(&header_bytes, header + header_bytes_offset, sizeof(header_bytes));
+    std::memcpy(item_type, header + item_type_offset, item_type_bytes - 1);
+    size_t page = sysconf(_SC_PAGESIZE);
+    if (std::memcmp(header, ring_magic, sizeof(ring_magic)) != 0 || version != ring_version
+            || capacity == 0 || (capacity & (capacity - 1)) != 0
+            || header_bytes % page != 0 || (capacity * item_size) % page != 0
+            || static_cast<size_t>(file_status.st_size) != header_bytes + capacity * item_size)
+        {
+            LOG(WARNING) << filename << " is not the sample ring of a running publisher";
+            ::close(fd);
+            return;
+        }
+    d_item_size = item_size;
+    d_capacity = capacity;
+    d_item_type = item_type;
+    map(fd, header_bytes, capacity * item_size, false);
+}
+
+
+Shared_Sample_Ring::~Shared_Sample_Ring()
+{
+    if (d_map)
+        {
+            if (d_publisher)
+                {
+                    close();
+                    unlink(d_filename.c_str());
+                }
+            munmap(d_map, d_map_bytes);
+        }
+}
+
+
+bool Shared_Sample_Ring::map(int fd, size_t header_bytes, size_t data_bytes, bool writable)
+{
+    // reserve the address range first, then map the header and the data and the data once more after it
+    size_t bytes = header_bytes + 2 * data_bytes;
+    void* area = mmap(0, bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (area == MAP_FAILED)
+        {
+            LOG(WARNING) << "Unable to reserve the memory of the sample ring " << d_filename << ": " << strerror(errno);
+            ::close(fd);
+            return false;
+        }
+    char* base = static_cast<char*>(area);
+    int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    bool mapped = mmap(base, header_bytes + data_bytes, protection, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED
+            && mmap(base + header_bytes + data_bytes, data_bytes, protection, MAP_SHARED | MAP_FIXED, fd, header_bytes) != MAP_FAILED;
+    ::close(fd); // the mappings keep the file open
+    if (!mapped)
+        {
+            LOG(WARNING) << "Unable to map the sample ring " << d_filename << ": " << strerror(errno);
+            munmap(area, bytes);
+            return false;
+        }
+    d_map = base;
+    d_map_bytes = bytes;
+    d_data = base + header_bytes;
+    return true;
+}
+
+
+void Shared_Sample_Ring::write(const void* items, unsigned long long count)
+{
+    if (!d_map || !d_publisher)
+        {
+            return;
+        }
+    const char* in = static_cast<const char*>(items);
+    Ring_Counter& written = field<Ring_Counter>(d_map, written_offset);
+    Ring_Counter& writing = field<Ring_Counter>(d_map, writing_offset);
+    while (count > 0)
+        {
+            uint64_t start = written.load(std::memory_order_relaxed);
+            unsigned long long n = std::min(count, d_capacity);
+            // readers of the slots about to be overwritten see it in intact()
+            writing.store(start + n, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            // the mirror makes the slots contiguous across the end of the ring
+            std::memcpy(d_data + (start & (d_capacity - 1)) * d_item_size, in, n * d_item_size);
+            written.store(start + n, std::memory_order_release);
+            in += n * d_item_size;
+            count -= n;
+        }
+
+    long long now_ns = realtime_ns();
+    Ring_Time& start_time = field<Ring_Time>(d_map, start_time_offset);
+    if (start_time.load(std::memory_order_relaxed) == 0 && d_sampling_frequency > 0.0)
+        {
+            double elapsed_ns = static_cast<double>(written.load(std::memory_order_relaxed)) / d_sampling_frequency * 1e9;
+            start_time.store(now_ns - static_cast<long long>(elapsed_ns), std::memory_order_relaxed);
+        }
+    field<Ring_Time>(d_map, write_time_offset).store(now_ns, std::memory_order_release);
+}
+
+
+void Shared_Sample_Ring::close()
+{
+    if (d_map && d_publisher)
+        {
+            field<Ring_Flag>(d_map, closed_offset).store(1, std::memory_order_release);
+        }
+}
+
+
+unsigned long long Shared_Sample_Ring::written() const
+{
+    return d_map ? field<Ring_Counter>(d_map, written_offset).load(std::memory_order_acquire) : 0;
+}
+
+
+const void* Shared_Sample_Ring::window(unsigned long long start, unsigned long long length) const
+{
+    if (!d_map || length > d_capacity || start + length > written() || !intact(start))
+        {
+            return nullptr;
+        }
+    return d_data + (start & (d_capacity - 1)) * d_item_size;
+}
+
+
+bool Shared_Sample_Ring::intact(unsigned long long start) const
+{
+    // the slot of item start is reused by item start + capacity
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return d_map && field<Ring_Counter>(d_map, writing_offset).load(std::memory_order_relaxed) <= start + d_capacity;
+}
+
+
+bool Shared_Sample_Ring::closed() const
+{
+    return !d_map || field<Ring_Flag>(d_map, closed_offset).load(std::memory_order_acquire) != 0;
+}
+
+
+long long Shared_Sample_Ring::write_time_ns() const
+{
+    return d_map ? field<Ring_Time>(d_map, write_time_offset).load(std::memory_order_acquire) : 0;
+}
+
+
+long long Shared_Sample_Ring::start_time_ns() const
+{
+    return d_map ? field<Ring_Time>(d_map, start_time_offset).load(std::memory_order_relaxed) : 0;
+}
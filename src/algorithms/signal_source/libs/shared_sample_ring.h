@@ -0,0 +1,143 @@
+/*!
+ * \file shared_sample_ring.h
+ * \brief Ring of samples in a file mapped by one publishing process and any
+ * number of receivers
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_SHARED_SAMPLE_RING_H_
+#define GNSS_SDR_SHARED_SAMPLE_RING_H_
+
+#include <cstddef>
+#include <string>
+
+/*!
+ * \brief Ring of the latest samples of a front end, in a file (usually in
+ * /dev/shm) that one process writes and the receivers of the machine map.
+ *
+ * The publisher owns the device and writes its samples with write(); each
+ * receiver attaches to the file and reads them where they are, with no
+ * copy besides the one into its own flowgraph. The samples are numbered
+ * from 0, the first one written, so that every receiver knows which
+ * samples it has missed. The data area is mapped twice in a row, so any
+ * window of up to capacity() samples is contiguous in memory.
+ *
+ * As in Sample_History, a reader takes window(), copies the samples and
+ * checks intact() to know whether the publisher overwrote them in the
+ * meantime. The counters are atomic words of the file: neither side takes
+ * a lock, and a slow receiver never holds the publisher back.
+ *
+ * A ring that fails to create, open or map its file is not open, and all
+ * the operations on it fail.
+ */
+class Shared_Sample_Ring
+{
+public:
+    /*!
+     * \brief Creates the file of a publisher, replacing any previous one.
+     * capacity is rounded up to a power of two of at least a page of items,
+     * and item_size must be a power of two.
+     */
+    Shared_Sample_Ring(const std::string& filename, size_t item_size, unsigned long long capacity,
+            const std::string& item_type, double sampling_frequency);
+
+    /*!
+     * \brief Maps the file of a running publisher, read only
+     */
+    explicit Shared_Sample_Ring(const std::string& filename);
+
+    /*!
+     * \brief Unmaps the file; the publisher marks it closed and removes it
+     */
+    ~Shared_Sample_Ring();
+
+    bool is_open() const { return d_map != 0; }
+    size_t item_size() const { return d_item_size; }
+    unsigned long long capacity() const { return d_capacity; }
+    const std::string& item_type() const { return d_item_type; }
+    double sampling_frequency() const { return d_sampling_frequency; }
+
+    // Publisher side
+
+    /*!
+     * \brief Appends count items
+     */
+    void write(const void* items, unsigned long long count);
+
+    /*!
+     * \brief Tells the receivers that no more samples will be written
+     */
+    void close();
+
+    // Receiver side
+
+    unsigned long long written() const; //!< Items written since the ring was created
+
+    /*!
+     * \brief Pointer to the length items from number start, or nullptr if
+     * they have not been written yet or are already overwritten
+     */
+    const void* window(unsigned long long start, unsigned long long length) const;
+
+    /*!
+     * \brief true if the items from number start that window() returned
+     * have not been overwritten since
+     */
+    bool intact(unsigned long long start) const;
+
+    bool closed() const; //!< true once the publisher is done
+
+    /*!
+     * \brief Host time (CLOCK_REALTIME) [ns] of the write that brought
+     * written() to its current value, 0 before the first one
+     */
+    long long write_time_ns() const;
+
+    /*!
+     * \brief Host time [ns] of item 0, from the first write and the sampling frequency
+     */
+    long long start_time_ns() const;
+
+private:
+    Shared_Sample_Ring(const Shared_Sample_Ring&);
+    Shared_Sample_Ring& operator=(const Shared_Sample_Ring&);
+
+    bool map(int fd, size_t header_bytes, size_t data_bytes, bool writable);
+
+    std::string d_filename;
+    char* d_map;
+    size_t d_map_bytes;
+    char* d_data;      // 2 * capacity items, the second half mirrors the first
+    size_t d_item_size;
+    unsigned long long d_capacity;
+    std::string d_item_type;
+    double d_sampling_frequency;
+    bool d_publisher;
+};
+
+#endif
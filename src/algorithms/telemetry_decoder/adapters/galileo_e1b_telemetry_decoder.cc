@@ -46,7 +46,8 @@ using google::LogMessage;
 GalileoE1BTelemetryDecoder::GalileoE1BTelemetryDecoder(ConfigurationInterface* configuration,
         std::string role,
         unsigned int in_streams,
-        unsigned int out_streams) :
+        unsigned int out_streams,
+        std::shared_ptr<Spoofing_Detector> spoofing_detector) :
         role_(role),
         in_streams_(in_streams),
         out_streams_(out_streams)
@@ -56,8 +57,9 @@ GalileoE1BTelemetryDecoder::GalileoE1BTelemetryDecoder(ConfigurationInterface* c
     DLOG(INFO) << "role " << role;
     dump_ = configuration->property(role + ".dump", false);
     dump_filename_ = configuration->property(role + ".dump_filename", default_dump_filename);
-    // make telemetry decoder object
-    telemetry_decoder_ = galileo_e1b_make_telemetry_decoder_cc(satellite_, dump_); // TODO fix me
+    // make telemetry decoder object. The detector, if any, is the one shared
+    // with the GPS channels of a hybrid receiver
+    telemetry_decoder_ = galileo_e1b_make_telemetry_decoder_cc(satellite_, dump_, spoofing_detector); // TODO fix me
     DLOG(INFO) << "telemetry_decoder(" << telemetry_decoder_->unique_id() << ")";
 
     //decimation factor
@@ -34,6 +34,7 @@
 #ifndef GNSS_SDR_GALILEO_E1B_TELEMETRY_DECODER_H_
 #define GNSS_SDR_GALILEO_E1B_TELEMETRY_DECODER_H_
 
+#include <memory>
 #include <string>
 #include "telemetry_decoder_interface.h"
 #include "galileo_e1b_telemetry_decoder_cc.h"
@@ -52,7 +53,8 @@ public:
     GalileoE1BTelemetryDecoder(ConfigurationInterface* configuration,
             std::string role,
             unsigned int in_streams,
-            unsigned int out_streams);
+            unsigned int out_streams,
+            std::shared_ptr<Spoofing_Detector> spoofing_detector = nullptr);
 
     virtual ~GalileoE1BTelemetryDecoder();
     std::string role()
@@ -48,7 +48,8 @@ using google::LogMessage;
 GpsL1CaSdTelemetryDecoder::GpsL1CaSdTelemetryDecoder(ConfigurationInterface* configuration,
         std::string role,
         unsigned int in_streams,
-        unsigned int out_streams) :
+        unsigned int out_streams,
+        std::shared_ptr<Spoofing_Detector> spoofing_detector) :
         role_(role),
         in_streams_(in_streams),
         out_streams_(out_streams)
@@ -59,11 +60,15 @@ GpsL1CaSdTelemetryDecoder::GpsL1CaSdTelemetryDecoder(ConfigurationInterface* con
     dump_ = configuration->property(role + ".dump", false);
     dump_filename_ = configuration->property(role + ".dump_filename", default_dump_filename);
 
-    //Spoofing detection
-    Spoofing_Detector *spoofing_detector = new Spoofing_Detector(configuration);
+    //Spoofing detection: the detector is shared by all channels. It is normally
+    //owned by the flowgraph, blocks created on their own get a private one.
+    if (!spoofing_detector)
+        {
+            spoofing_detector = std::make_shared<Spoofing_Detector>(configuration);
+        }
 
     // make telemetry decoder object
-    telemetry_decoder_ = gps_l1_ca_make_sd_telemetry_decoder_cc(satellite_, dump_, *spoofing_detector); // TODO fix me
+    telemetry_decoder_ = gps_l1_ca_make_sd_telemetry_decoder_cc(satellite_, dump_, spoofing_detector);
     DLOG(INFO) << "telemetry_decoder(" << telemetry_decoder_->unique_id() << ")";
 
     //decimation factor
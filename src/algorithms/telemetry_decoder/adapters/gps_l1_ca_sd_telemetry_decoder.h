@@ -36,6 +36,7 @@
 #ifndef GNSS_SDR_GPS_L1_CA_SD_TELEMETRY_DECODER_H_
 #define GNSS_SDR_GPS_L1_CA_SD_TELEMETRY_DECODER_H_
 
+#include <memory>
 #include <string>
 #include "telemetry_decoder_interface.h"
 #include "gps_l1_ca_sd_telemetry_decoder_cc.h"
@@ -52,7 +53,8 @@ public:
     GpsL1CaSdTelemetryDecoder(ConfigurationInterface* configuration,
             std::string role,
             unsigned int in_streams,
-            unsigned int out_streams);
+            unsigned int out_streams,
+            std::shared_ptr<Spoofing_Detector> spoofing_detector = nullptr);
 
     virtual ~GpsL1CaSdTelemetryDecoder();
     std::string role()
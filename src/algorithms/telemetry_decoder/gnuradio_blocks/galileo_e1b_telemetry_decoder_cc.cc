@@ -39,18 +39,30 @@
 #include <glog/logging.h>
 #include "control_message_factory.h"
 #include "gnss_synchro.h"
-#include "convolutional.h"
+#include "spoofing_detector.h"
 
 
 #define CRC_ERROR_LIMIT 6
 
 using google::LogMessage;
 
+namespace
+{
+Dump_Schema telemetry_dump_schema()
+{
+    Dump_Schema schema("galileo_e1b_telemetry");
+    schema.add<double>("TOW_at_current_symbol_s")
+          .add<double>("Prn_timestamp_ms")
+          .add<double>("TOW_at_Preamble_s");
+    return schema;
+}
+}
+
 
 galileo_e1b_telemetry_decoder_cc_sptr
-galileo_e1b_make_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump)
+galileo_e1b_make_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump, std::shared_ptr<Spoofing_Detector> spoofing_detector)
 {
-    return galileo_e1b_telemetry_decoder_cc_sptr(new galileo_e1b_telemetry_decoder_cc(satellite, dump));
+    return galileo_e1b_telemetry_decoder_cc_sptr(new galileo_e1b_telemetry_decoder_cc(satellite, dump, spoofing_detector));
 }
 
 
@@ -64,60 +76,13 @@ void galileo_e1b_telemetry_decoder_cc::forecast (int noutput_items, gr_vector_in
 }
 
 
-void galileo_e1b_telemetry_decoder_cc::viterbi_decoder(double *page_part_symbols, int *page_part_bits)
-{
-    int CodeLength = 240;
-    int DataLength;
-    int nn, KK, mm, max_states;
-    int g_encoder[2];
-
-    nn = 2;             // Coding rate 1/n
-    KK = 7;             // Constraint Length
-    g_encoder[0] = 121; // Polynomial G1
-    g_encoder[1] = 91;  // Polynomial G2
-
-    mm = KK - 1;
-    max_states = 1 << mm; /* 2^mm */
-    DataLength = (CodeLength/nn) - mm;
-
-    /* create appropriate transition matrices */
-    int *out0, *out1, *state0, *state1;
-    out0 = (int*)calloc( max_states, sizeof(int) );
-    out1 = (int*)calloc( max_states, sizeof(int) );
-    state0 = (int*)calloc( max_states, sizeof(int) );
-    state1 = (int*)calloc( max_states, sizeof(int) );
-
-    nsc_transit( out0, state0, 0, g_encoder, KK, nn );
-    nsc_transit( out1, state1, 1, g_encoder, KK, nn );
-
-    Viterbi(page_part_bits, out0, state0, out1, state1,
-            page_part_symbols, KK, nn, DataLength );
-
-    /* Clean up memory */
-    free( out0 );
-    free( out1 );
-    free( state0 );
-    free( state1 );
-}
-
-
-void galileo_e1b_telemetry_decoder_cc::deinterleaver(int rows, int cols, double *in, double *out)
-{
-    for (int r = 0; r < rows; r++)
-        {
-            for(int c = 0; c < cols; c++)
-                {
-                    out[c*rows + r] = in[r*cols + c];
-                }
-        }
-}
-
-
 galileo_e1b_telemetry_decoder_cc::galileo_e1b_telemetry_decoder_cc(
         Gnss_Satellite satellite,
-        bool dump) :
+        bool dump,
+        std::shared_ptr<Spoofing_Detector> spoofing_detector) :
                    gr::block("galileo_e1b_telemetry_decoder_cc", gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)),
-                           gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)))
+                           gr::io_signature::make(1, 1, sizeof(Gnss_Synchro))),
+                   d_fec(GALILEO_INAV_INTERLEAVER_ROWS, GALILEO_INAV_INTERLEAVER_COLS)
 {
     this->message_port_register_out(pmt::mp("events"));
     // Telemetry Bit transition synchronization port out
@@ -174,6 +139,7 @@ galileo_e1b_telemetry_decoder_cc::galileo_e1b_telemetry_decoder_cc(
     flag_TOW_set = false;
     d_average_count = 0;
     d_decimation_output_factor = 1;
+    d_spoofing_detector = spoofing_detector;
 }
 
 
@@ -184,25 +150,12 @@ galileo_e1b_telemetry_decoder_cc::~galileo_e1b_telemetry_decoder_cc()
 }
 
 
-void galileo_e1b_telemetry_decoder_cc::decode_word(double *page_part_symbols,int frame_length)
+void galileo_e1b_telemetry_decoder_cc::decode_word(float *page_part_symbols, int frame_length)
 {
-    double page_part_symbols_deint[frame_length];
-    // 1. De-interleave
-    deinterleaver(GALILEO_INAV_INTERLEAVER_ROWS, GALILEO_INAV_INTERLEAVER_COLS, page_part_symbols, page_part_symbols_deint);
-
+    // 1. De-interleave, taking into account the NOT gate in G2 polynomial (Galileo ICD Figure 13, FEC encoder)
     // 2. Viterbi decoder
-    // 2.1 Take into account the NOT gate in G2 polynomial (Galileo ICD Figure 13, FEC encoder)
-    // 2.2 Take into account the possible inversion of the polarity due to PLL lock at 180�
-    for (int i = 0; i < frame_length; i++)
-        {
-            if ((i + 1) % 2 == 0)
-                {
-                    page_part_symbols_deint[i] = -page_part_symbols_deint[i];
-                }
-        }
-
     int page_part_bits[frame_length/2];
-    viterbi_decoder(page_part_symbols_deint, page_part_bits);
+    d_fec.decode(page_part_symbols, page_part_bits);
 
     // 3. Call the Galileo page decoder
     std::string page_String;
@@ -245,7 +198,7 @@ void galileo_e1b_telemetry_decoder_cc::decode_word(double *page_part_symbols,int
     if (d_nav.have_new_ephemeris() == true)
         {
             // get object for this SV (mandatory)
-            std::shared_ptr<Galileo_Ephemeris> tmp_obj = std::make_shared<Galileo_Ephemeris>(d_nav.get_ephemeris());
+            std::shared_ptr<Galileo_Ephemeris> tmp_obj = d_ephemeris_pool.acquire(d_nav.get_ephemeris());
 
             this->message_port_pub(pmt::mp("telemetry"), pmt::make_any(tmp_obj));
 
@@ -253,18 +206,18 @@ void galileo_e1b_telemetry_decoder_cc::decode_word(double *page_part_symbols,int
     if (d_nav.have_new_iono_and_GST() == true)
         {
             // get object for this SV (mandatory)
-            std::shared_ptr<Galileo_Iono> tmp_obj = std::make_shared<Galileo_Iono>(d_nav.get_iono());
+            std::shared_ptr<Galileo_Iono> tmp_obj = d_iono_pool.acquire(d_nav.get_iono());
             this->message_port_pub(pmt::mp("telemetry"), pmt::make_any(tmp_obj));
         }
     if (d_nav.have_new_utc_model() == true)
         {
             // get object for this SV (mandatory)
-            std::shared_ptr<Galileo_Utc_Model> tmp_obj = std::make_shared<Galileo_Utc_Model>(d_nav.get_utc_model());
+            std::shared_ptr<Galileo_Utc_Model> tmp_obj = d_utc_model_pool.acquire(d_nav.get_utc_model());
             this->message_port_pub(pmt::mp("telemetry"), pmt::make_any(tmp_obj));
         }
     if (d_nav.have_new_almanac() == true)
         {
-            std::shared_ptr<Galileo_Almanac> tmp_obj= std::make_shared<Galileo_Almanac>(d_nav.get_almanac());
+            std::shared_ptr<Galileo_Almanac> tmp_obj= d_almanac_pool.acquire(d_nav.get_almanac());
             this->message_port_pub(pmt::mp("telemetry"), pmt::make_any(tmp_obj));
             //debug
             std::cout << "Galileo almanac received!" << std::endl;
@@ -350,18 +303,18 @@ int galileo_e1b_telemetry_decoder_cc::general_work (int noutput_items __attribut
                     // NEW Galileo page part is received
                     // 0. fetch the symbols into an array
                     int frame_length = GALILEO_INAV_PAGE_PART_SYMBOLS - d_symbols_per_preamble;
-                    double page_part_symbols[frame_length];
+                    float page_part_symbols[frame_length];
 
                     for (int i = 0; i < frame_length; i++)
                         {
                             if (corr_value > 0)
                                 {
-                                    page_part_symbols[i] = in[0][i + d_symbols_per_preamble].Prompt_I; // because last symbol of the preamble is just received now!
+                                    page_part_symbols[i] = static_cast<float>(in[0][i + d_symbols_per_preamble].Prompt_I); // because last symbol of the preamble is just received now!
 
                                 }
                             else
                                 {
-                                    page_part_symbols[i] = -in[0][i + d_symbols_per_preamble].Prompt_I; // because last symbol of the preamble is just received now!
+                                    page_part_symbols[i] = -static_cast<float>(in[0][i + d_symbols_per_preamble].Prompt_I); // because last symbol of the preamble is just received now!
                                 }
                         }
 
@@ -437,6 +390,20 @@ int galileo_e1b_telemetry_decoder_cc::general_work (int noutput_items __attribut
                     d_TOW_at_Preamble = d_TOW_at_Preamble + GALILEO_INAV_PAGE_SECONDS;
                     d_TOW_at_current_symbol = d_TOW_at_current_symbol + GALILEO_E1_CODE_PERIOD;// + GALILEO_INAV_PAGE_PART_SYMBOLS*GALILEO_E1_CODE_PERIOD;
                 }
+            if (d_spoofing_detector)
+                {
+                    // the word just decoded, in the time base of the GPS channels
+                    Spoofing_Nav_Unit unit;
+                    unit.system = 'E';
+                    unit.PRN = d_satellite.get_PRN();
+                    unit.uid = in[0][0].uid;
+                    unit.unit_id = d_nav.Page_type_time_stamp;
+                    unit.week = static_cast<int>(d_nav.WN_5);
+                    unit.TOW = d_TOW_at_current_symbol - delta_t;
+                    unit.time_ms = Prn_timestamp_at_preamble_ms;
+                    unit.set_bits(d_nav.word_jk);
+                    d_spoofing_detector->new_nav_unit(unit);
+                }
         }
     else //if there is not a new preamble, we define the TOW of the current symbol
         {
@@ -469,20 +436,9 @@ int galileo_e1b_telemetry_decoder_cc::general_work (int noutput_items __attribut
     if(d_dump == true)
         {
             // MULTIPLEXED FILE RECORDING - Record results to file
-            try
-            {
-                    double tmp_double;
-                    tmp_double = d_TOW_at_current_symbol;
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                    tmp_double = current_synchro_data.Prn_timestamp_ms;
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                    tmp_double = d_TOW_at_Preamble;
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-            }
-            catch (const std::ifstream::failure& e)
-            {
-                    LOG(WARNING) << "Exception writing observables dump file " << e.what();
-            }
+            d_dump_file.put<double>(d_TOW_at_current_symbol);
+            d_dump_file.put<double>(current_synchro_data.Prn_timestamp_ms);
+            d_dump_file.put<double>(d_TOW_at_Preamble);
         }
     //todo: implement averaging
     d_average_count++;
@@ -526,19 +482,17 @@ void galileo_e1b_telemetry_decoder_cc::set_channel(int channel)
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_filename = "telemetry";
-                            d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
-                            d_dump_filename.append(".dat");
-                            d_dump_file.exceptions ( std::ifstream::failbit | std::ifstream::badbit );
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    d_dump_filename = "telemetry";
+                    d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                    d_dump_filename.append(".dat");
+                    if (d_dump_file.open(d_dump_filename, telemetry_dump_schema()))
+                        {
                             LOG(INFO) << "Telemetry decoder dump enabled on channel " << d_channel << " Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (const std::ifstream::failure& e)
-                    {
-                            LOG(WARNING) << "channel " << d_channel << " Exception opening trk dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << d_channel << " cannot open telemetry dump file " << d_dump_filename;
+                        }
                 }
         }
 }
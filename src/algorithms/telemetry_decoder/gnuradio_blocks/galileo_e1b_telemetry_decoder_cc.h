@@ -33,24 +33,29 @@
 #define GNSS_SDR_GALILEO_E1B_TELEMETRY_DECODER_CC_H
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <gnuradio/block.h>
 #include "Galileo_E1.h"
+#include "message_pool.h"
 #include "concurrent_queue.h"
 #include "gnss_satellite.h"
+#include "galileo_fec_decoder.h"
 #include "galileo_navigation_message.h"
 #include "galileo_ephemeris.h"
 #include "galileo_almanac.h"
 #include "galileo_iono.h"
 #include "galileo_utc_model.h"
+#include "dump_writer.h"
 
 
-
+class Spoofing_Detector;
 class galileo_e1b_telemetry_decoder_cc;
 
 typedef boost::shared_ptr<galileo_e1b_telemetry_decoder_cc> galileo_e1b_telemetry_decoder_cc_sptr;
 
-galileo_e1b_telemetry_decoder_cc_sptr galileo_e1b_make_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump);
+galileo_e1b_telemetry_decoder_cc_sptr galileo_e1b_make_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump,
+        std::shared_ptr<Spoofing_Detector> spoofing_detector = nullptr);
 
 /*!
  * \brief This class implements a block that decodes the INAV data defined in Galileo ICD
@@ -83,14 +88,10 @@ public:
 
 private:
     friend galileo_e1b_telemetry_decoder_cc_sptr
-    galileo_e1b_make_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump);
-    galileo_e1b_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump);
-
-    void viterbi_decoder(double *page_part_symbols, int *page_part_bits);
-
-    void deinterleaver(int rows, int cols, double *in, double *out);
+    galileo_e1b_make_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump, std::shared_ptr<Spoofing_Detector> spoofing_detector);
+    galileo_e1b_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump, std::shared_ptr<Spoofing_Detector> spoofing_detector);
 
-    void decode_word(double *symbols,int frame_length);
+    void decode_word(float *symbols, int frame_length);
 
     unsigned short int d_preambles_bits[GALILEO_INAV_PREAMBLE_LENGTH_BITS];
 
@@ -107,6 +108,9 @@ private:
     bool d_flag_preamble;
     int d_CRC_error_counter;
 
+    // deinterleaver and Viterbi decoder of the pages
+    Galileo_Fec_Decoder d_fec;
+
     // navigation message vars
     Galileo_Navigation_Message d_nav;
 
@@ -128,8 +132,17 @@ private:
     double delta_t; //GPS-GALILEO time offset
 
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
     unsigned int channel_state;
+
+    // inter-satellite checks of a hybrid receiver, nullptr if there are none
+    std::shared_ptr<Spoofing_Detector> d_spoofing_detector;
+
+    // payloads of the navigation data messages to the PVT
+    Message_Pool<Galileo_Ephemeris> d_ephemeris_pool;
+    Message_Pool<Galileo_Iono> d_iono_pool;
+    Message_Pool<Galileo_Utc_Model> d_utc_model_pool;
+    Message_Pool<Galileo_Almanac> d_almanac_pool;
 };
 
 #endif
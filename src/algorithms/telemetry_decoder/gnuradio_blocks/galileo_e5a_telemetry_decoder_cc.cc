@@ -42,13 +42,24 @@
 #include <glog/logging.h>
 #include "control_message_factory.h"
 #include "gnss_synchro.h"
-#include "convolutional.h"
 
 
 #define CRC_ERROR_LIMIT 6
 
 using google::LogMessage;
 
+namespace
+{
+Dump_Schema telemetry_dump_schema()
+{
+    Dump_Schema schema("galileo_e5a_telemetry");
+    schema.add<double>("TOW_at_current_symbol_s")
+          .add<double>("Prn_timestamp_ms")
+          .add<double>("TOW_at_Preamble_s");
+    return schema;
+}
+}
+
 
 galileo_e5a_telemetry_decoder_cc_sptr
 galileo_e5a_make_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump)
@@ -67,82 +78,16 @@ void galileo_e5a_telemetry_decoder_cc::forecast (int noutput_items, gr_vector_in
 }
 
 
-void galileo_e5a_telemetry_decoder_cc::viterbi_decoder(double *page_part_symbols, int *page_part_bits)
-{
-    //    int CodeLength = 240;
-    int CodeLength = 488;
-    int DataLength;
-    int nn, KK, mm, max_states;
-    int g_encoder[2];
-
-    nn = 2;             // Coding rate 1/n
-    KK = 7;             // Constraint Length
-    g_encoder[0] = 121; // Polynomial G1
-    g_encoder[1] = 91;  // Polynomial G2
-    //    g_encoder[0] = 171; // Polynomial G1
-    //    g_encoder[1] = 133;  // Polynomial G2
-
-    mm = KK - 1;
-    max_states = 1 << mm; // 2^mm
-    DataLength = (CodeLength/nn) - mm;
-
-    //create appropriate transition matrices
-
-    int *out0, *out1, *state0, *state1;
-    out0 = (int*)calloc( max_states, sizeof(int) );
-    out1 = (int*)calloc( max_states, sizeof(int) );
-    state0 = (int*)calloc( max_states, sizeof(int) );
-    state1 = (int*)calloc( max_states, sizeof(int) );
-
-    nsc_transit( out0, state0, 0, g_encoder, KK, nn );
-    nsc_transit( out1, state1, 1, g_encoder, KK, nn );
-
-    Viterbi(page_part_bits, out0, state0, out1, state1,
-            page_part_symbols, KK, nn, DataLength );
-
-    //Clean up memory
-    free( out0 );
-    free( out1 );
-    free( state0 );
-    free( state1 );
-}
-
-
-void galileo_e5a_telemetry_decoder_cc::deinterleaver(int rows, int cols, double *in, double *out)
-{
-    for (int r = 0; r < rows; r++)
-        {
-            for(int c = 0; c < cols; c++)
-                {
-                    out[c*rows + r] = in[r*cols + c];
-                }
-        }
-}
-
-
-void galileo_e5a_telemetry_decoder_cc::decode_word(double *page_symbols,int frame_length)
+void galileo_e5a_telemetry_decoder_cc::decode_word(float *page_symbols, int frame_length)
 {
-    double page_symbols_deint[frame_length];
-    // 1. De-interleave
-
-    galileo_e5a_telemetry_decoder_cc::deinterleaver(GALILEO_FNAV_INTERLEAVER_ROWS, GALILEO_FNAV_INTERLEAVER_COLS, page_symbols, page_symbols_deint);
-
+    // 1. De-interleave, taking into account the NOT gate in G2 polynomial (Galileo ICD Figure 13, FEC encoder)
     // 2. Viterbi decoder
-    // 2.1 Take into account the NOT gate in G2 polynomial (Galileo ICD Figure 13, FEC encoder)
-    // 2.2 Take into account the possible inversion of the polarity due to PLL lock at 180�
-    for (int i = 0; i < frame_length; i++)
-        {
-            if ((i + 1) % 2 == 0)
-                {
-                    page_symbols_deint[i] = -page_symbols_deint[i];
-                }
-        }
     int page_bits[frame_length/2];
-    galileo_e5a_telemetry_decoder_cc::viterbi_decoder(page_symbols_deint, page_bits);
+    d_fec.decode(page_symbols, page_bits);
 
     // 3. Call the Galileo page decoder
     std::string page_String;
-    for(int i = 0; i < frame_length; i++)
+    for(int i = 0; i < (frame_length/2); i++)
         {
             if (page_bits[i] > 0)
                 {
@@ -170,17 +115,17 @@ void galileo_e5a_telemetry_decoder_cc::decode_word(double *page_symbols,int fram
     // 4. Push the new navigation data to the queues
     if (d_nav.have_new_ephemeris() == true)
         {
-            std::shared_ptr<Galileo_Ephemeris> tmp_obj= std::make_shared<Galileo_Ephemeris>(d_nav.get_ephemeris());
+            std::shared_ptr<Galileo_Ephemeris> tmp_obj= d_ephemeris_pool.acquire(d_nav.get_ephemeris());
             this->message_port_pub(pmt::mp("telemetry"), pmt::make_any(tmp_obj));
         }
     if (d_nav.have_new_iono_and_GST() == true)
         {
-            std::shared_ptr<Galileo_Iono> tmp_obj= std::make_shared<Galileo_Iono>(d_nav.get_iono());
+            std::shared_ptr<Galileo_Iono> tmp_obj= d_iono_pool.acquire(d_nav.get_iono());
             this->message_port_pub(pmt::mp("telemetry"), pmt::make_any(tmp_obj));
         }
     if (d_nav.have_new_utc_model() == true)
         {
-            std::shared_ptr<Galileo_Utc_Model> tmp_obj= std::make_shared<Galileo_Utc_Model>(d_nav.get_utc_model());
+            std::shared_ptr<Galileo_Utc_Model> tmp_obj= d_utc_model_pool.acquire(d_nav.get_utc_model());
             this->message_port_pub(pmt::mp("telemetry"), pmt::make_any(tmp_obj));
         }
 
@@ -190,7 +135,8 @@ galileo_e5a_telemetry_decoder_cc::galileo_e5a_telemetry_decoder_cc(
         Gnss_Satellite satellite,
         bool dump) :
                    gr::block("galileo_e5a_telemetry_decoder_cc", gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)),
-                           gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)))
+                           gr::io_signature::make(1, 1, sizeof(Gnss_Synchro))),
+                   d_fec(GALILEO_FNAV_INTERLEAVER_ROWS, GALILEO_FNAV_INTERLEAVER_COLS)
 {
     this->message_port_register_out(pmt::mp("events"));
     // Telemetry Bit transition synchronization port out
@@ -548,20 +494,9 @@ int galileo_e5a_telemetry_decoder_cc::general_work (int noutput_items __attribut
     if(d_dump == true)
         {
             // MULTIPLEXED FILE RECORDING - Record results to file
-            try
-            {
-                    double tmp_double;
-                    tmp_double = d_TOW_at_current_symbol;
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                    tmp_double = current_synchro_data.Prn_timestamp_ms;
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                    tmp_double = d_TOW_at_Preamble;
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-            }
-            catch (const std::ifstream::failure& e)
-            {
-                    LOG(WARNING) << "Exception writing observables dump file " << e.what();
-            }
+            d_dump_file.put<double>(d_TOW_at_current_symbol);
+            d_dump_file.put<double>(current_synchro_data.Prn_timestamp_ms);
+            d_dump_file.put<double>(d_TOW_at_Preamble);
         }
     d_sample_counter++; //count for the processed samples
     //3. Make the output (copy the object contents to the GNURadio reserved memory)
@@ -587,19 +522,17 @@ void galileo_e5a_telemetry_decoder_cc::set_channel(int channel)
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_filename = "telemetry";
-                            d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
-                            d_dump_filename.append(".dat");
-                            d_dump_file.exceptions ( std::ifstream::failbit | std::ifstream::badbit );
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    d_dump_filename = "telemetry";
+                    d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                    d_dump_filename.append(".dat");
+                    if (d_dump_file.open(d_dump_filename, telemetry_dump_schema()))
+                        {
                             LOG(INFO) << "Telemetry decoder dump enabled on channel " << d_channel << " Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (const std::ifstream::failure& e)
-                    {
-                            LOG(WARNING) << "channel " << d_channel << " Exception opening trk dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << d_channel << " cannot open telemetry dump file " << d_dump_filename;
+                        }
                 }
         }
 }
@@ -40,13 +40,16 @@
 #include <string>
 #include <gnuradio/block.h>
 #include "Galileo_E5a.h"
+#include "message_pool.h"
 #include "concurrent_queue.h"
 #include "gnss_satellite.h"
+#include "galileo_fec_decoder.h"
 #include "galileo_fnav_message.h"
 #include "galileo_ephemeris.h"
 #include "galileo_almanac.h"
 #include "galileo_iono.h"
 #include "galileo_utc_model.h"
+#include "dump_writer.h"
 
 //#include "convolutional.h"
 
@@ -85,15 +88,11 @@ private:
     galileo_e5a_make_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump);
     galileo_e5a_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump);
 
-    void viterbi_decoder(double *page_part_symbols, int *page_part_bits);
-
-    void deinterleaver(int rows, int cols, double *in, double *out);
-
-    void decode_word(double *page_symbols,int frame_length);
+    void decode_word(float *page_symbols, int frame_length);
 
     int d_preamble_bits[GALILEO_FNAV_PREAMBLE_LENGTH_BITS];
     // signed int d_page_symbols[GALILEO_FNAV_SYMBOLS_PER_PAGE + GALILEO_FNAV_PREAMBLE_LENGTH_BITS];
-    double d_page_symbols[GALILEO_FNAV_SYMBOLS_PER_PAGE + GALILEO_FNAV_PREAMBLE_LENGTH_BITS];
+    float d_page_symbols[GALILEO_FNAV_SYMBOLS_PER_PAGE + GALILEO_FNAV_PREAMBLE_LENGTH_BITS];
     // signed int *d_preamble_symbols;
     double d_current_symbol;
     long unsigned int d_symbol_counter;
@@ -110,6 +109,9 @@ private:
     bool d_flag_preamble;
     int d_CRC_error_counter;
 
+    // deinterleaver and Viterbi decoder of the pages
+    Galileo_Fec_Decoder d_fec;
+
     // navigation message vars
     Galileo_Fnav_Message d_nav;
 
@@ -125,8 +127,13 @@ private:
     bool flag_TOW_set;
 
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
     unsigned int channel_state;
+
+    // payloads of the navigation data messages to the PVT
+    Message_Pool<Galileo_Ephemeris> d_ephemeris_pool;
+    Message_Pool<Galileo_Iono> d_iono_pool;
+    Message_Pool<Galileo_Utc_Model> d_utc_model_pool;
 };
 
 #endif /* GNSS_SDR_GALILEO_E5A_TELEMETRY_DECODER_CC_H_ */
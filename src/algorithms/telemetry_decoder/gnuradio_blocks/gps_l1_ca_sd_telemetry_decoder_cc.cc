@@ -34,20 +34,34 @@
 
 #include "gps_l1_ca_sd_telemetry_decoder_cc.h"
 #include <iostream>
+#include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
 #include "control_message_factory.h"
 #include "gnss_synchro.h"
-
-#ifndef _rotl
-#define _rotl(X,N)  ((X << N) ^ (X >> (32-N)))  // Used in the parity check algorithm
-#endif
+#include "spoofing_replay.h"
+#include "channel_event.h"
+#include "telemetry_decode_pool.h"
+#include "trace_log.h"
+#include "latency_trace.h"
 
 using google::LogMessage;
 
+namespace
+{
+Dump_Schema telemetry_dump_schema()
+{
+    Dump_Schema schema("gps_l1_ca_sd_telemetry");
+    schema.add<double>("TOW_at_current_symbol_s")
+          .add<double>("Prn_timestamp_ms")
+          .add<double>("TOW_at_Preamble_s");
+    return schema;
+}
+}
+
 gps_l1_ca_sd_telemetry_decoder_cc_sptr
-gps_l1_ca_make_sd_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump, Spoofing_Detector spoofing_detector)
+gps_l1_ca_make_sd_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump, std::shared_ptr<Spoofing_Detector> spoofing_detector)
 {
     return gps_l1_ca_sd_telemetry_decoder_cc_sptr(new gps_l1_ca_sd_telemetry_decoder_cc(satellite, dump, spoofing_detector));
 }
@@ -58,23 +72,76 @@ void gps_l1_ca_sd_telemetry_decoder_cc::forecast (int noutput_items __attribute_
 }
 
 
-void gps_l1_ca_sd_telemetry_decoder_cc::stop_tracking(unsigned int uid)
+void gps_l1_ca_sd_telemetry_decoder_cc::stop_tracking(unsigned int uid, bool checked)
 {
     if( channel_state != 2 )
         {
-            global_subframe_map.remove(uid);
-            global_gps_time.remove(uid);
-            global_subframe_check.remove(uid);
+            // after the subframes already submitted, which would add the uid back
+            Telemetry_Decode_Pool::instance().submit(d_decode_lane,
+                    boost::bind(&gps_l1_ca_sd_telemetry_decoder_cc::release_uid,
+                            boost::dynamic_pointer_cast<gps_l1_ca_sd_telemetry_decoder_cc>(shared_from_this()), uid));
             channel_state = 2; 
             DLOG(INFO) << "send stop tracking " << uid; 
-            this->message_port_pub(pmt::mp("events"), pmt::from_long(4));//4 -> stop tracking
+            this->message_port_pub(pmt::mp("events"), channel_event_pmt(checked ? CHANNEL_EVENT_CHECKED : CHANNEL_EVENT_STOP_TRACKING));
+        }
+}
+
+
+void gps_l1_ca_sd_telemetry_decoder_cc::release_uid(unsigned int uid)
+{
+    if (Spoofing_Replay_Writer* replay = d_spoofing_detector->replay_writer())
+        {
+            replay->write_release(uid);
         }
+    d_receiver_state->subframe_map.remove(uid);
+    d_receiver_state->gps_time.remove(uid);
+    d_receiver_state->subframe_check.remove(uid);
+    d_receiver_state->navigation_data.remove(uid);
+    d_spoofing_detector->forget_APT_release(uid);
+}
+
+
+void gps_l1_ca_sd_telemetry_decoder_cc::decode_subframe(const Gps_Lnav_Subframe& subframe)
+{
+    // send TLM data to PVT using asynchronous message queues
+    switch (d_GPS_FSM.decode(subframe))
+    {
+    case 3: //we have a new set of ephemeris data for the current SV
+        if (d_GPS_FSM.d_nav.satellite_validation() == true)
+            {
+                // get ephemeris object for this SV (mandatory), sent to the PVT only when it is a new issue
+                Gps_Ephemeris_Record record;
+                if (d_receiver_state->navigation_data.publish_ephemeris(subframe.uid, d_GPS_FSM.d_nav.get_ephemeris(), subframe.preamble_time_ms, record))
+                    {
+                        this->message_port_pub(pmt::mp("telemetry"), pmt::make_any(record.ephemeris));
+                    }
+            }
+        break;
+    case 4: // Possible IONOSPHERE and UTC model update (page 18)
+        if (d_GPS_FSM.d_nav.flag_iono_valid == true)
+            {
+                std::shared_ptr<Gps_Iono> tmp_obj = d_iono_pool.acquire(d_GPS_FSM.d_nav.get_iono());
+                this->message_port_pub(pmt::mp("telemetry"), pmt::make_any(tmp_obj));
+            }
+        if (d_GPS_FSM.d_nav.flag_utc_model_valid == true)
+            {
+                std::shared_ptr<Gps_Utc_Model> tmp_obj = d_utc_model_pool.acquire(d_GPS_FSM.d_nav.get_utc_model());
+                this->message_port_pub(pmt::mp("telemetry"), pmt::make_any(tmp_obj));
+            }
+        break;
+    case 5:
+        // get almanac (if available)
+        //TODO: implement almanac reader in navigation_message
+        break;
+    default:
+        break;
+    }
 }
 
 gps_l1_ca_sd_telemetry_decoder_cc::gps_l1_ca_sd_telemetry_decoder_cc(
         Gnss_Satellite satellite,
         bool dump,
-        Spoofing_Detector spoofing_detector) :
+        std::shared_ptr<Spoofing_Detector> spoofing_detector) :
         gr::block("gps_navigation_cc", gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)),
         gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)))
 {
@@ -110,14 +177,10 @@ gps_l1_ca_sd_telemetry_decoder_cc::gps_l1_ca_sd_telemetry_decoder_cc(
                     n++;
                 }
         }
+    d_preamble_correlator = new Preamble_Correlator(d_preambles_symbols, GPS_CA_PREAMBLE_LENGTH_SYMBOLS);
     d_stat = 0;
-    d_symbol_accumulator = 0;
-    d_symbol_accumulator_counter = 0;
-    d_frame_bit_index = 0;
     d_preamble_time_seconds = 0;
     d_flag_frame_sync = false;
-    d_GPS_frame_4bytes = 0;
-    d_prev_GPS_frame_4bytes = 0;
     d_flag_parity = false;
     d_TOW_at_Preamble = 0;
     d_TOW_at_current_symbol = 0;
@@ -132,44 +195,24 @@ gps_l1_ca_sd_telemetry_decoder_cc::gps_l1_ca_sd_telemetry_decoder_cc(
 
     //Spoofing
     d_spoofing_detector = spoofing_detector;
-    d_GPS_FSM.spoofing_detector = spoofing_detector; 
+    d_GPS_FSM.spoofing_detector = d_spoofing_detector.get();
     this->message_port_register_out(pmt::mp("events"));
+    d_receiver_state = Receiver_State::current();
+    d_decode_lane = Telemetry_Decode_Pool::instance().lane();
 }
 
 
 gps_l1_ca_sd_telemetry_decoder_cc::~gps_l1_ca_sd_telemetry_decoder_cc()
 {
     delete d_preambles_symbols;
+    delete d_preamble_correlator;
     d_dump_file.close();
 }
 
-bool gps_l1_ca_sd_telemetry_decoder_cc::gps_word_parityCheck(unsigned int gpsword)
-{
-    unsigned int d1, d2, d3, d4, d5, d6, d7, t, parity;
-    /* XOR as many bits in parallel as possible.  The magic constants pick
-       up bits which are to be XOR'ed together to implement the GPS parity
-       check algorithm described in IS-GPS-200E.  This avoids lengthy shift-
-       and-xor loops. */
-    d1 = gpsword & 0xFBFFBF00;
-    d2 = _rotl(gpsword,1) & 0x07FFBF01;
-    d3 = _rotl(gpsword,2) & 0xFC0F8100;
-    d4 = _rotl(gpsword,3) & 0xF81FFE02;
-    d5 = _rotl(gpsword,4) & 0xFC00000E;
-    d6 = _rotl(gpsword,5) & 0x07F00001;
-    d7 = _rotl(gpsword,6) & 0x00003000;
-    t = d1 ^ d2 ^ d3 ^ d4 ^ d5 ^ d6 ^ d7;
-    // Now XOR the 5 6-bit fields together to produce the 6-bit final result.
-    parity = t ^ _rotl(t,6) ^ _rotl(t,12) ^ _rotl(t,18) ^ _rotl(t,24);
-    parity = parity & 0x3F;
-    if (parity == (gpsword & 0x3F)) return(true);
-    else return(false);
-}
-
-
-int gps_l1_ca_sd_telemetry_decoder_cc::general_work (int noutput_items __attribute__((unused)), gr_vector_int &ninput_items __attribute__((unused)),
+int gps_l1_ca_sd_telemetry_decoder_cc::general_work (int noutput_items __attribute__((unused)), gr_vector_int &ninput_items,
         gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
 {
-
+    Block_Metrics_Scope metrics_scope(d_metrics.get(), ninput_items[0]);
     int corr_value = 0;
     int preamble_diff_ms = 0;
 
@@ -190,21 +233,8 @@ int gps_l1_ca_sd_telemetry_decoder_cc::general_work (int noutput_items __attribu
     unsigned int uid = in[0][0].uid;
 
     //******* preamble correlation ********
-    for (unsigned int i = 0; i < GPS_CA_PREAMBLE_LENGTH_SYMBOLS; i++)
-        {
-            if (in[0][i].Flag_valid_symbol_output == true)
-                {
-                    if (in[0][i].Prompt_I < 0)  // symbols clipping
-                        {
-                            corr_value -= d_preambles_symbols[i] * in[0][i].correlation_length_ms;
-                        }
-                    else
-                        {
-                            corr_value += d_preambles_symbols[i] * in[0][i].correlation_length_ms;
-                        }
-                }
-            if (corr_value >= GPS_CA_PREAMBLE_LENGTH_SYMBOLS) break;
-        }
+    // the window moves by one symbol per call, only the new symbol is packed into the history
+    corr_value = d_preamble_correlator->correlate(in[0]);
     d_flag_preamble = false;
 
     //******* frame sync ******************
@@ -216,10 +246,9 @@ int gps_l1_ca_sd_telemetry_decoder_cc::general_work (int noutput_items __attribu
                     d_GPS_FSM.Event_gps_word_preamble();
                     //record the preamble sample stamp
                     d_preamble_time_seconds = in[0][0].Tracking_timestamp_secs; // record the preamble sample stamp
-                    DLOG(INFO)  << "Preamble detection for SAT " << this->d_satellite << "in[0][0].Tracking_timestamp_secs=" << round(in[0][0].Tracking_timestamp_secs * 1000.0);
+                    TRACE_LOG(TRACE_TELEMETRY, 1)  << "Preamble detection for SAT " << this->d_satellite << "in[0][0].Tracking_timestamp_secs=" << round(in[0][0].Tracking_timestamp_secs * 1000.0);
                     //sync the symbol to bits integrator
-                    d_symbol_accumulator = 0;                    d_symbol_accumulator_counter = 0;
-                    d_frame_bit_index = 0;
+                    d_lnav_framer.sync_bits();
                     d_stat = 1; // enter into frame pre-detection status
                 }
             else if (d_stat == 1) //check 6 seconds of preamble separation
@@ -227,7 +256,7 @@ int gps_l1_ca_sd_telemetry_decoder_cc::general_work (int noutput_items __attribu
                     preamble_diff_ms = round((in[0][0].Tracking_timestamp_secs - d_preamble_time_seconds) * 1000.0);
                     if (abs(preamble_diff_ms - GPS_SUBFRAME_MS) < 1)
                         {
-                            DLOG(INFO) << "Preamble confirmation for SAT " << this->d_satellite  << "in[0][0].Tracking_timestamp_secs=" << round(in[0][0].Tracking_timestamp_secs * 1000.0);
+                            TRACE_LOG(TRACE_TELEMETRY, 1) << "Preamble confirmation for SAT " << this->d_satellite  << "in[0][0].Tracking_timestamp_secs=" << round(in[0][0].Tracking_timestamp_secs * 1000.0);
                             d_GPS_FSM.Event_gps_word_preamble();
                             d_flag_preamble = true;
                             d_preamble_time_seconds = in[0][0].Tracking_timestamp_secs;// - d_preamble_duration_seconds; //record the PRN start sample index associated to the preamble
@@ -241,13 +270,13 @@ int gps_l1_ca_sd_telemetry_decoder_cc::general_work (int noutput_items __attribu
                                     if (corr_value < 0)
                                         {
                                             flag_PLL_180_deg_phase_locked = true; // PLL is locked to opposite phase!
-                                            DLOG(INFO)  << " PLL in opposite phase for Sat "<< this->d_satellite.get_PRN();
+                                            TRACE_LOG(TRACE_TELEMETRY, 1)  << " PLL in opposite phase for Sat "<< this->d_satellite.get_PRN();
                                         }
                                     else
                                         {
                                             flag_PLL_180_deg_phase_locked = false;
                                         }
-                                    DLOG(INFO)  << " Frame sync SAT " << this->d_satellite << " with preamble start at " << d_preamble_time_seconds << " [s]";
+                                    TRACE_LOG(TRACE_TELEMETRY, 1)  << " Frame sync SAT " << this->d_satellite << " with preamble start at " << d_preamble_time_seconds << " [s]";
                                 }
                         }
                 }
@@ -259,7 +288,7 @@ int gps_l1_ca_sd_telemetry_decoder_cc::general_work (int noutput_items __attribu
                 {
                     if (preamble_diff_ms > GPS_SUBFRAME_MS+1)
                         {
-                            DLOG(INFO) << "Lost of frame sync SAT " << this->d_satellite << " preamble_diff= " << preamble_diff_ms;
+                            TRACE_LOG(TRACE_TELEMETRY, 1) << "Lost of frame sync SAT " << this->d_satellite << " preamble_diff= " << preamble_diff_ms;
                             d_stat = 0; //lost of frame sync
                             d_flag_frame_sync = false;
                             flag_TOW_set = false;
@@ -270,136 +299,80 @@ int gps_l1_ca_sd_telemetry_decoder_cc::general_work (int noutput_items __attribu
             //Send stop tracking to tracking module
             else if (preamble_diff_ms > GPS_SUBFRAME_MS+1000)
                 {
-                    DLOG(INFO) << "No frame sync SAT: " <<  this->d_satellite << " preamble_diff= " << preamble_diff_ms << "\n"
+                    TRACE_LOG(TRACE_TELEMETRY, 1) << "No frame sync SAT: " <<  this->d_satellite << " preamble_diff= " << preamble_diff_ms << "\n"
                                << "Send stop tracking to tracking module for sat " << this->d_satellite << " ch: " << d_channel;
                     stop_tracking(uid);
                 }
 
         }
 
-    //******* SYMBOL TO BIT *******
-    if (in[0][0].Flag_valid_symbol_output == true)
+    //******* SYMBOL TO BIT, BITS TO WORD *******
+    if (d_lnav_framer.push_symbol(in[0][0]))
         {
-            // extended correlation to bit period is enabled in tracking!
-            d_symbol_accumulator += in[0][0].Prompt_I; // accumulate the input value in d_symbol_accumulator
-            d_symbol_accumulator_counter += in[0][0].correlation_length_ms;
+            if (d_lnav_framer.parity_ok())
+                {
+                    if( d_spoofing_detector->APT_release(d_satellite.get_PRN(), uid) )
+                        {
+                            TRACE_LOG(TRACE_TELEMETRY, 1) << "No spoofing - stop tracking channel";
+                            stop_tracking(uid, true);
+                        }
+
+                    d_GPS_FSM.d_preamble_time_ms = d_preamble_time_seconds * 1000.0;
+                    d_GPS_FSM.Event_gps_word(d_lnav_framer);
+                    // only the header is read here, the subframe is decoded in the decode pool
+                    if (d_GPS_FSM.d_flag_new_subframe == true)
+                        {
+                            if (d_GPS_FSM.d_subframe_ID >= 1 and d_GPS_FSM.d_subframe_ID <= 5)
+                                {
+                                    LATENCY_TRACE(LATENCY_TELEMETRY, d_channel, in[0][0].sample_counter);
+                                }
+                            Telemetry_Decode_Pool::instance().submit(d_decode_lane,
+                                    boost::bind(&gps_l1_ca_sd_telemetry_decoder_cc::decode_subframe,
+                                            boost::dynamic_pointer_cast<gps_l1_ca_sd_telemetry_decoder_cc>(shared_from_this()), d_GPS_FSM.subframe()));
+                            d_GPS_FSM.clear_flag_new_subframe();
+                        }
+
+                    d_flag_parity = true;
+                }
+            else
+                {
+                    d_GPS_FSM.Event_gps_word(d_lnav_framer);
+                    d_flag_parity = false;
+                }
         }
-    if (d_symbol_accumulator_counter >= 20)
-         {
-             if (d_symbol_accumulator > 0)
-                 { //symbol to bit
-                     d_GPS_frame_4bytes += 1; //insert the telemetry bit in LSB
-                 }
-             d_symbol_accumulator = 0;
-             d_symbol_accumulator_counter = 0;
-             //******* bits to words ******
-             d_frame_bit_index++;
-             if (d_frame_bit_index == 30)
-                 {
-                     d_frame_bit_index = 0;
-                     // parity check
-                     // Each word in wordbuff is composed of:
-                     //      Bits 0 to 29 = the GPS data word
-                     //      Bits 30 to 31 = 2 LSBs of the GPS word ahead.
-                     // prepare the extended frame [-2 -1 0 ... 30]
-                     if (d_prev_GPS_frame_4bytes & 0x00000001)
-                         {
-                             d_GPS_frame_4bytes = d_GPS_frame_4bytes | 0x40000000;
-                         }
-                     if (d_prev_GPS_frame_4bytes & 0x00000002)
-                         {
-                             d_GPS_frame_4bytes = d_GPS_frame_4bytes | 0x80000000;
-                         }
-                     /* Check that the 2 most recently logged words pass parity. Have to first
-                      invert the data bits according to bit 30 of the previous word. */
-                     if(d_GPS_frame_4bytes & 0x40000000)
-                         {
-                             d_GPS_frame_4bytes ^= 0x3FFFFFC0; // invert the data bits (using XOR)
-                         }
-                     if (gps_l1_ca_sd_telemetry_decoder_cc::gps_word_parityCheck(d_GPS_frame_4bytes))
-                         {
-                             if( d_spoofing_detector.stop_tracking(d_satellite.get_PRN(), uid) )
-                                 {
-                                     DLOG(INFO) << "No spoofing - stop tracking channel";
-                                     stop_tracking(uid);
-                                 }
-
-                             memcpy(&d_GPS_FSM.d_GPS_frame_4bytes, &d_GPS_frame_4bytes, sizeof(char)*4);
-                             d_GPS_FSM.d_preamble_time_ms = d_preamble_time_seconds * 1000.0;
-                             d_GPS_FSM.Event_gps_word_valid();
-                             // send TLM data to PVT using asynchronous message queues
-                             if (d_GPS_FSM.d_flag_new_subframe == true)
-                                 {
-                                     switch (d_GPS_FSM.d_subframe_ID)
-                                     {
-                                     case 3: //we have a new set of ephemeris data for the current SV
-                                         if (d_GPS_FSM.d_nav.satellite_validation() == true)
-                                             {
-                                                 // get ephemeris object for this SV (mandatory)
-                                                 std::shared_ptr<Gps_Ephemeris> tmp_obj = std::make_shared<Gps_Ephemeris>(d_GPS_FSM.d_nav.get_ephemeris());
-                                                 this->message_port_pub(pmt::mp("telemetry"), pmt::make_any(tmp_obj));
-                                             }
-                                         break;
-                                     case 4: // Possible IONOSPHERE and UTC model update (page 18)
-                                         if (d_GPS_FSM.d_nav.flag_iono_valid == true)
-                                             {
-                                                 std::shared_ptr<Gps_Iono> tmp_obj = std::make_shared<Gps_Iono>( d_GPS_FSM.d_nav.get_iono());
-                                                 this->message_port_pub(pmt::mp("telemetry"), pmt::make_any(tmp_obj));
-                                             }
-                                         if (d_GPS_FSM.d_nav.flag_utc_model_valid == true)
-                                             {
-                                                 std::shared_ptr<Gps_Utc_Model> tmp_obj = std::make_shared<Gps_Utc_Model>(d_GPS_FSM.d_nav.get_utc_model());
-                                                 this->message_port_pub(pmt::mp("telemetry"), pmt::make_any(tmp_obj));
-                                             }
-                                         break;
-                                     case 5:
-                                         // get almanac (if available)
-                                         //TODO: implement almanac reader in navigation_message
-                                         break;
-                                     default:
-                                         break;
-                                     }
-                                     d_GPS_FSM.clear_flag_new_subframe();
-
-                                     
-                                 }
-
-                             d_flag_parity = true;
-                         }
-                     else
-                         {
-                             d_GPS_FSM.Event_gps_word_invalid();
-                             d_flag_parity = false;
-                         }
-                     d_prev_GPS_frame_4bytes = d_GPS_frame_4bytes; // save the actual frame
-                     d_GPS_frame_4bytes = d_GPS_frame_4bytes & 0;
-                 }
-             else
-                 {
-                     d_GPS_frame_4bytes <<= 1; //shift 1 bit left the telemetry word
-                 }
-         }
      }
      // output the frame
+     metrics_scope.set_items(1);
      consume_each(1); //one by one
      Gnss_Synchro current_synchro_data; //structure to save the synchronization information and send the output object to the next block
      //1. Copy the current tracking output
      current_synchro_data = in[0][0];
      //2. Add the telemetry decoder information
-     if (this->d_flag_preamble == true and d_GPS_FSM.d_nav.d_TOW > 0)
+     if (this->d_flag_preamble == true and d_GPS_FSM.d_TOW > 0)
          //update TOW at the preamble instant (todo: check for valid d_TOW)
          // JAVI: 30/06/2014
          // TOW, in GPS, is referred to the START of the SUBFRAME, that is, THE FIRST SYMBOL OF THAT SUBFRAME, NOT THE PREAMBLE.
          // thus, no correction should be done. d_TOW_at_Preamble should be renamed to d_TOW_at_subframe_start.
          // Sice we detected the preable, then, we are in the last symbol of that preamble, or just at the start of the first subframe symbol.
          {
-             d_TOW_at_Preamble = d_GPS_FSM.d_nav.d_TOW + GPS_SUBFRAME_SECONDS; //we decoded the current TOW when the last word of the subframe arrive, so, we have a lag of ONE SUBFRAME
+             d_TOW_at_Preamble = d_GPS_FSM.d_TOW + GPS_SUBFRAME_SECONDS; //we decoded the current TOW when the last word of the subframe arrive, so, we have a lag of ONE SUBFRAME
              d_TOW_at_current_symbol = d_TOW_at_Preamble;
              Prn_timestamp_at_preamble_ms = in[0][0].Tracking_timestamp_secs * 1000.0;
              if (flag_TOW_set == false)
                  {
                      flag_TOW_set = true;
                  }
+             // the subframe just decoded, timed by the start of the next one
+             Spoofing_Nav_Unit unit;
+             unit.system = 'G';
+             unit.PRN = d_satellite.get_PRN();
+             unit.uid = in[0][0].uid;
+             unit.unit_id = d_GPS_FSM.d_subframe_ID;
+             unit.week = d_GPS_FSM.i_GPS_week;
+             unit.TOW = d_TOW_at_current_symbol;
+             unit.time_ms = Prn_timestamp_at_preamble_ms;
+             unit.set_words(d_GPS_FSM.d_subframe_words);
+             d_spoofing_detector->new_nav_unit(unit);
          }
      else
          {
@@ -420,9 +393,14 @@ int gps_l1_ca_sd_telemetry_decoder_cc::general_work (int noutput_items __attribu
             int unique_id = std::stoi(tmp);
            // DLOG(INFO) << "flag valid word: remove " << (int)unique_id << " "
             //<< d_flag_frame_sync << " " << d_flag_parity << " " <<  flag_TOW_set;
-            global_subframe_map.remove((int)unique_id);
-            global_subframe_check.remove((int)unique_id);
-            global_gps_time.remove((int)unique_id);
+            Spoofing_Replay_Writer* replay = d_spoofing_detector->replay_writer();
+            if (replay and d_receiver_state->subframe_map.get_snapshot()->by_uid.count(unique_id))
+                {
+                    replay->write_release(unique_id);
+                }
+            d_receiver_state->subframe_map.remove((int)unique_id);
+            d_receiver_state->subframe_check.remove((int)unique_id);
+            d_receiver_state->gps_time.remove((int)unique_id);
         }
 
      if (flag_PLL_180_deg_phase_locked == true)
@@ -434,20 +412,9 @@ int gps_l1_ca_sd_telemetry_decoder_cc::general_work (int noutput_items __attribu
      if(d_dump == true)
          {
              // MULTIPLEXED FILE RECORDING - Record results to file
-             try
-             {
-                     double tmp_double;
-                     tmp_double = d_TOW_at_current_symbol;
-                     d_dump_file.write((char*)&tmp_double, sizeof(double));
-                     tmp_double = current_synchro_data.Prn_timestamp_ms;
-                     d_dump_file.write((char*)&tmp_double, sizeof(double));
-                     tmp_double = d_TOW_at_Preamble;
-                     d_dump_file.write((char*)&tmp_double, sizeof(double));
-             }
-             catch (const std::ifstream::failure & e)
-             {
-                     LOG(WARNING) << "Exception writing observables dump file " << e.what();
-             }
+             d_dump_file.put<double>(d_TOW_at_current_symbol);
+             d_dump_file.put<double>(current_synchro_data.Prn_timestamp_ms);
+             d_dump_file.put<double>(d_TOW_at_Preamble);
          }
 
      //todo: implement averaging
@@ -485,6 +452,7 @@ int gps_l1_ca_sd_telemetry_decoder_cc::general_work (int noutput_items __attribu
  void gps_l1_ca_sd_telemetry_decoder_cc::set_channel(int channel)
  {
      d_channel = channel;
+     d_metrics = make_block_metrics("telemetry", "ch" + std::to_string(channel));
      d_GPS_FSM.i_channel_ID = channel;
      DLOG(INFO) << "Navigation channel set to " << channel;
      // ############# ENABLE DATA FILE LOG #################
@@ -492,20 +460,18 @@ int gps_l1_ca_sd_telemetry_decoder_cc::general_work (int noutput_items __attribu
          {
              if (d_dump_file.is_open() == false)
                  {
-                     try
-                     {
-                             d_dump_filename = "telemetry";
-                             d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
-                             d_dump_filename.append(".dat");
-                             d_dump_file.exceptions ( std::ifstream::failbit | std::ifstream::badbit );
-                             d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                     d_dump_filename = "telemetry";
+                     d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                     d_dump_filename.append(".dat");
+                     if (d_dump_file.open(d_dump_filename, telemetry_dump_schema()))
+                         {
                              LOG(INFO) << "Telemetry decoder dump enabled on channel " << d_channel
                                      << " Log file: " << d_dump_filename.c_str();
-                     }
-                     catch (const std::ifstream::failure &e)
-                     {
-                             LOG(WARNING) << "channel " << d_channel << " Exception opening trk dump file " << e.what();
-                     }
+                         }
+                     else
+                         {
+                             LOG(WARNING) << "channel " << d_channel << " cannot open telemetry dump file " << d_dump_filename;
+                         }
                  }
          }
  }
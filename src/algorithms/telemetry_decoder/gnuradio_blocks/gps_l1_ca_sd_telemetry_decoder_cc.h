@@ -35,30 +35,29 @@
 #define GNSS_SDR_GPS_L1_CA_SD_TELEMETRY_DECODER_CC_H
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <gnuradio/block.h>
 #include <deque>
 #include "GPS_L1_CA.h"
 #include "gps_l1_ca_sd_subframe_fsm.h"
+#include "message_pool.h"
 #include "concurrent_queue.h"
 #include "gnss_satellite.h"
+#include "preamble_correlator.h"
+#include "lnav_word_framer.h"
+#include "navigation_data_bus.h"
+#include "receiver_state.h"
+#include "block_metrics.h"
+#include "dump_writer.h"
 
 class gps_l1_ca_sd_telemetry_decoder_cc;
 
 typedef boost::shared_ptr<gps_l1_ca_sd_telemetry_decoder_cc> gps_l1_ca_sd_telemetry_decoder_cc_sptr;
 
-extern concurrent_map<Subframe> global_subframe_map;
-extern concurrent_map<std::map<unsigned int, unsigned int>> global_subframe_check;
-struct GPS_time_t{
-    int week;
-    double TOW;
-    double timestamp;
-    int subframe_id;
-};
-extern concurrent_map<GPS_time_t> global_gps_time;
 
 gps_l1_ca_sd_telemetry_decoder_cc_sptr
-gps_l1_ca_make_sd_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump, Spoofing_Detector spoofing_detector);
+gps_l1_ca_make_sd_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump, std::shared_ptr<Spoofing_Detector> spoofing_detector);
 
 /*!
  * \brief This class implements a block that decodes the NAV data defined in IS-GPS-200E
@@ -88,37 +87,33 @@ public:
     void forecast (int noutput_items, gr_vector_int &ninput_items_required);
 
     /*!
-     * \brief Sends a stop tracking message to the channel 
+     * \brief Sends a stop tracking message to the channel, or a checked
+     * one when the APT checks of the peak tracked passed
      */
-    void stop_tracking(unsigned int uid);
+    void stop_tracking(unsigned int uid, bool checked = false);
     void set_state(unsigned int state);
 
 private:
     friend gps_l1_ca_sd_telemetry_decoder_cc_sptr
-    gps_l1_ca_make_sd_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump, Spoofing_Detector spoofing_detector);
-
-    gps_l1_ca_sd_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump, Spoofing_Detector spoofing_detector);
+    gps_l1_ca_make_sd_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump, std::shared_ptr<Spoofing_Detector> spoofing_detector);
 
-    bool gps_word_parityCheck(unsigned int gpsword);
+    gps_l1_ca_sd_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump, std::shared_ptr<Spoofing_Detector> spoofing_detector);
 
     // constants
     //unsigned short int d_preambles_bits[GPS_CA_PREAMBLE_LENGTH_BITS];
     // class private vars
 
     int *d_preambles_symbols;
+    Preamble_Correlator* d_preamble_correlator;
     unsigned int d_stat;
     bool d_flag_frame_sync;
 
     // symbols
     std::deque<double> d_symbol_history;
     std::deque<int> d_correlation_length_ms_history;
-    double d_symbol_accumulator;
-    short int d_symbol_accumulator_counter;
 
     //bits and frame
-    unsigned short int d_frame_bit_index;
-    unsigned int d_GPS_frame_4bytes;
-    unsigned int d_prev_GPS_frame_4bytes;
+    Lnav_Word_Framer d_lnav_framer;
     bool d_flag_parity;
     bool d_flag_preamble;
     int d_word_number;
@@ -134,7 +129,9 @@ private:
 
     bool d_dump;
     Gnss_Satellite d_satellite;
+    std::shared_ptr<Receiver_State> d_receiver_state; // tables of the receiver, current at construction
     int d_channel;
+    std::shared_ptr<Block_Metrics> d_metrics; // made by set_channel
 
     double d_preamble_time_seconds;
 
@@ -146,12 +143,22 @@ private:
     bool flag_PLL_180_deg_phase_locked;
 
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
 
     void stop_tracking();
+
+    // subframe decoding, in the lane of the decode pool taken by this channel
+    void decode_subframe(const Gps_Lnav_Subframe& subframe);
+    void release_uid(unsigned int uid);
+    unsigned int d_decode_lane;
+
     unsigned int channel_state;
-    Spoofing_Detector d_spoofing_detector;
+    std::shared_ptr<Spoofing_Detector> d_spoofing_detector;
     //tells us if the tracking module is actually providing us valid input
+
+    // payloads of the navigation data messages to the PVT
+    Message_Pool<Gps_Iono> d_iono_pool;
+    Message_Pool<Gps_Utc_Model> d_utc_model_pool;
 };
 
 #endif
@@ -51,6 +51,19 @@
 #endif
 
 using google::LogMessage;
+
+namespace
+{
+Dump_Schema telemetry_dump_schema()
+{
+    Dump_Schema schema("gps_l1_ca_sd_telemetry_old");
+    schema.add<double>("TOW_at_current_symbol_s")
+          .add<double>("Prn_timestamp_ms")
+          .add<double>("TOW_at_Preamble_s");
+    return schema;
+}
+}
+
 /*!
  * \todo name and move the magic numbers to GPS_L1_CA.h
  */
@@ -379,20 +392,9 @@ int gps_l1_ca_sd_telemetry_decoder_cc::general_work (int noutput_items, gr_vecto
     if(d_dump == true)
         {
             // MULTIPLEXED FILE RECORDING - Record results to file
-            try
-            {
-                    double tmp_double;
-                    tmp_double = d_TOW_at_current_symbol;
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                    tmp_double = current_synchro_data.Prn_timestamp_ms;
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                    tmp_double = d_TOW_at_Preamble;
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-            }
-            catch (std::ifstream::failure e)
-            {
-                    LOG(WARNING) << "Exception writing observables dump file " << e.what();
-            }
+            d_dump_file.put<double>(d_TOW_at_current_symbol);
+            d_dump_file.put<double>(current_synchro_data.Prn_timestamp_ms);
+            d_dump_file.put<double>(d_TOW_at_Preamble);
         }
     //3. Make the output (copy the object contents to the GNURadio reserved memory)
     //*out[0] = current_synchro_data;
@@ -455,20 +457,18 @@ void gps_l1_ca_sd_telemetry_decoder_cc::set_channel(int channel)
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_filename = "telemetry";
-                            d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
-                            d_dump_filename.append(".dat");
-                            d_dump_file.exceptions ( std::ifstream::failbit | std::ifstream::badbit );
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    d_dump_filename = "telemetry";
+                    d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                    d_dump_filename.append(".dat");
+                    if (d_dump_file.open(d_dump_filename, telemetry_dump_schema()))
+                        {
                             LOG(INFO) << "Telemetry decoder dump enabled on channel " << d_channel
                                       << " Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (std::ifstream::failure e)
-                    {
-                            LOG(WARNING) << "channel " << d_channel << " Exception opening trk dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << d_channel << " cannot open telemetry dump file " << d_dump_filename;
+                        }
                 }
         }
     std::stringstream filename;
@@ -39,6 +39,7 @@
 #include "gps_l1_ca_sd_subframe_fsm.h"
 #include "concurrent_queue.h"
 #include "gnss_satellite.h"
+#include "dump_writer.h"
 #include <iostream>
 
 
@@ -160,7 +161,7 @@ private:
     bool flag_TOW_set;
 
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
     std::ofstream file_corr_value;
 
 };
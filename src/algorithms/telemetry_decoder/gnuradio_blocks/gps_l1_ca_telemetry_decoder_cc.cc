@@ -36,13 +36,22 @@
 #include <glog/logging.h>
 #include "control_message_factory.h"
 #include "gnss_synchro.h"
-
-#ifndef _rotl
-#define _rotl(X,N)  ((X << N) ^ (X >> (32-N)))  // Used in the parity check algorithm
-#endif
+#include "latency_trace.h"
 
 using google::LogMessage;
 
+namespace
+{
+Dump_Schema telemetry_dump_schema()
+{
+    Dump_Schema schema("gps_l1_ca_telemetry");
+    schema.add<double>("TOW_at_current_symbol_s")
+          .add<double>("Prn_timestamp_ms")
+          .add<double>("TOW_at_Preamble_s");
+    return schema;
+}
+}
+
 gps_l1_ca_telemetry_decoder_cc_sptr
 gps_l1_ca_make_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump)
 {
@@ -61,6 +70,7 @@ gps_l1_ca_telemetry_decoder_cc::gps_l1_ca_telemetry_decoder_cc(
         gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)))
 {
     this->message_port_register_out(pmt::mp("events"));
+    d_receiver_state = Receiver_State::current();
     // Telemetry Bit transition synchronization port out
     this->message_port_register_out(pmt::mp("preamble_timestamp_s"));
     // Ephemeris data port out
@@ -92,14 +102,10 @@ gps_l1_ca_telemetry_decoder_cc::gps_l1_ca_telemetry_decoder_cc(
                     n++;
                 }
         }
+    d_preamble_correlator = new Preamble_Correlator(d_preambles_symbols, GPS_CA_PREAMBLE_LENGTH_SYMBOLS);
     d_stat = 0;
-    d_symbol_accumulator = 0;
-    d_symbol_accumulator_counter = 0;
-    d_frame_bit_index = 0;
     d_preamble_time_seconds = 0;
     d_flag_frame_sync = false;
-    d_GPS_frame_4bytes = 0;
-    d_prev_GPS_frame_4bytes = 0;
     d_flag_parity = false;
     d_TOW_at_Preamble = 0;
     d_TOW_at_current_symbol = 0;
@@ -111,65 +117,94 @@ gps_l1_ca_telemetry_decoder_cc::gps_l1_ca_telemetry_decoder_cc(
     d_channel = 0;
     Prn_timestamp_at_preamble_ms = 0.0;
     flag_PLL_180_deg_phase_locked = false;
+    d_message_host = this;
+    d_lookahead_first = 0;
 }
 
 
 gps_l1_ca_telemetry_decoder_cc::~gps_l1_ca_telemetry_decoder_cc()
 {
     delete d_preambles_symbols;
+    delete d_preamble_correlator;
     d_dump_file.close();
 }
 
-bool gps_l1_ca_telemetry_decoder_cc::gps_word_parityCheck(unsigned int gpsword)
+int gps_l1_ca_telemetry_decoder_cc::general_work (int noutput_items, gr_vector_int &ninput_items,
+        gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
 {
-    unsigned int d1, d2, d3, d4, d5, d6, d7, t, parity;
-    /* XOR as many bits in parallel as possible.  The magic constants pick
-       up bits which are to be XOR'ed together to implement the GPS parity
-       check algorithm described in IS-GPS-200E.  This avoids lengthy shift-
-       and-xor loops. */
-    d1 = gpsword & 0xFBFFBF00;
-    d2 = _rotl(gpsword,1) & 0x07FFBF01;
-    d3 = _rotl(gpsword,2) & 0xFC0F8100;
-    d4 = _rotl(gpsword,3) & 0xF81FFE02;
-    d5 = _rotl(gpsword,4) & 0xFC00000E;
-    d6 = _rotl(gpsword,5) & 0x07F00001;
-    d7 = _rotl(gpsword,6) & 0x00003000;
-    t = d1 ^ d2 ^ d3 ^ d4 ^ d5 ^ d6 ^ d7;
-    // Now XOR the 5 6-bit fields together to produce the 6-bit final result.
-    parity = t ^ _rotl(t,6) ^ _rotl(t,12) ^ _rotl(t,18) ^ _rotl(t,24);
-    parity = parity & 0x3F;
-    if (parity == (gpsword & 0x3F)) return(true);
-    else return(false);
+    Block_Metrics_Scope metrics_scope(d_metrics.get(), ninput_items[0]);
+    const Gnss_Synchro *in = static_cast<const Gnss_Synchro *>(input_items[0]);
+    Gnss_Synchro *out = static_cast<Gnss_Synchro *>(output_items[0]);
+
+    // decodes all the symbols that have the preamble length of symbols after
+    // them, so that the observables get them in one batch
+    int consumed = 0;
+    int produced = 0;
+    while (produced < noutput_items and consumed < ninput_items[0]
+            and (dormant_synchro(in[consumed]) or ninput_items[0] - consumed >= GPS_CA_PREAMBLE_LENGTH_SYMBOLS))
+        {
+            produced += decode_symbol(in + consumed, out + produced);
+            consumed++;
+        }
+    metrics_scope.set_items(consumed);
+    consume_each(consumed);
+    return produced;
 }
 
 
-int gps_l1_ca_telemetry_decoder_cc::general_work (int noutput_items __attribute__((unused)), gr_vector_int &ninput_items __attribute__((unused)),
-        gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
+void gps_l1_ca_telemetry_decoder_cc::attach_to(gr::basic_block* host)
 {
-    int corr_value = 0;
-    int preamble_diff_ms = 0;
+    // the "events" of the decoder are already a port of the tracking blocks
+    host->message_port_register_out(pmt::mp("preamble_timestamp_s"));
+    host->message_port_register_out(pmt::mp("telemetry"));
+    d_message_host = host;
+    d_lookahead.clear();
+    d_lookahead.reserve(2 * GPS_CA_PREAMBLE_LENGTH_SYMBOLS);
+    d_lookahead_first = 0;
+}
 
-    Gnss_Synchro **out = (Gnss_Synchro **) &output_items[0];
 
-    // ########### Output the tracking data to navigation and PVT ##########
-    const Gnss_Synchro **in = (const Gnss_Synchro **)  &input_items[0]; //Get the input samples pointer
+int gps_l1_ca_telemetry_decoder_cc::push_epoch(const Gnss_Synchro& epoch, Gnss_Synchro* out)
+{
+    if (d_lookahead.size() == d_lookahead.capacity())
+        {
+            d_lookahead.erase(d_lookahead.begin(), d_lookahead.begin() + d_lookahead_first);
+            d_lookahead_first = 0;
+        }
+    d_lookahead.push_back(epoch);
+    // the same symbols are decoded as in general_work, one per epoch pushed
+    const Gnss_Synchro* in = &d_lookahead[d_lookahead_first];
+    if (dormant_synchro(*in) or d_lookahead.size() - d_lookahead_first >= GPS_CA_PREAMBLE_LENGTH_SYMBOLS)
+        {
+            d_lookahead_first++;
+            return decode_symbol(in, out);
+        }
+    return 0;
+}
 
-    //******* preamble correlation ********
-    for (unsigned int i = 0; i < GPS_CA_PREAMBLE_LENGTH_SYMBOLS; i++)
+
+int gps_l1_ca_telemetry_decoder_cc::decode_symbol(const Gnss_Synchro* in, Gnss_Synchro* out)
+{
+    int corr_value = 0;
+    int preamble_diff_ms = 0;
+
+    if (dormant_synchro(in[0]))
         {
-            if (in[0][i].Flag_valid_symbol_output == true)
+            // idle tracking channel: passes the zeroed epoch on without decoding it
+            d_preamble_correlator->clear();
+            d_average_count++;
+            if (d_average_count == d_decimation_output_factor)
                 {
-                    if (in[0][i].Prompt_I < 0)  // symbols clipping
-                        {
-                            corr_value -= d_preambles_symbols[i] * in[0][i].correlation_length_ms;
-                        }
-                    else
-                        {
-                            corr_value += d_preambles_symbols[i] * in[0][i].correlation_length_ms;
-                        }
+                    d_average_count = 0;
+                    *out = in[0];
+                    return 1;
                 }
-            if (corr_value >= GPS_CA_PREAMBLE_LENGTH_SYMBOLS) break;
+            return 0;
         }
+
+    //******* preamble correlation ********
+    // the window moves by one symbol at a time, only the new symbol is packed into the history
+    corr_value = d_preamble_correlator->correlate(in);
     d_flag_preamble = false;
 
     //******* frame sync ******************
@@ -180,28 +215,27 @@ int gps_l1_ca_telemetry_decoder_cc::general_work (int noutput_items __attribute_
                 {
                     d_GPS_FSM.Event_gps_word_preamble();
                     //record the preamble sample stamp
-                    d_preamble_time_seconds = in[0][0].Tracking_timestamp_secs; // record the preamble sample stamp
-                    DLOG(INFO)  << "Preamble detection for SAT " << this->d_satellite << "in[0][0].Tracking_timestamp_secs=" << round(in[0][0].Tracking_timestamp_secs * 1000.0);
+                    d_preamble_time_seconds = in[0].Tracking_timestamp_secs; // record the preamble sample stamp
+                    DLOG(INFO)  << "Preamble detection for SAT " << this->d_satellite << "in[0].Tracking_timestamp_secs=" << round(in[0].Tracking_timestamp_secs * 1000.0);
                     //sync the symbol to bits integrator
-                    d_symbol_accumulator = 0;                    d_symbol_accumulator_counter = 0;
-                    d_frame_bit_index = 0;
+                    d_lnav_framer.sync_bits();
                     d_stat = 1; // enter into frame pre-detection status
                 }
             else if (d_stat == 1) //check 6 seconds of preamble separation
                 {
-                    preamble_diff_ms = round((in[0][0].Tracking_timestamp_secs - d_preamble_time_seconds) * 1000.0);
+                    preamble_diff_ms = round((in[0].Tracking_timestamp_secs - d_preamble_time_seconds) * 1000.0);
                     if (abs(preamble_diff_ms - GPS_SUBFRAME_MS) < 1)
                         {
-                            DLOG(INFO) << "Preamble confirmation for SAT " << this->d_satellite  << "in[0][0].Tracking_timestamp_secs=" << round(in[0][0].Tracking_timestamp_secs * 1000.0);
+                            DLOG(INFO) << "Preamble confirmation for SAT " << this->d_satellite  << "in[0].Tracking_timestamp_secs=" << round(in[0].Tracking_timestamp_secs * 1000.0);
                             d_GPS_FSM.Event_gps_word_preamble();
                             d_flag_preamble = true;
-                            d_preamble_time_seconds = in[0][0].Tracking_timestamp_secs;// - d_preamble_duration_seconds; //record the PRN start sample index associated to the preamble
+                            d_preamble_time_seconds = in[0].Tracking_timestamp_secs;// - d_preamble_duration_seconds; //record the PRN start sample index associated to the preamble
 
                             if (!d_flag_frame_sync)
                                 {
                                     // send asynchronous message to tracking to inform of frame sync and extend correlation time
                                     pmt::pmt_t value = pmt::from_double(d_preamble_time_seconds - 0.001);
-                                    this->message_port_pub(pmt::mp("preamble_timestamp_s"), value);
+                                    d_message_host->message_port_pub(pmt::mp("preamble_timestamp_s"), value);
                                     d_flag_frame_sync = true;
                                     if (corr_value < 0)
                                         {
@@ -221,7 +255,7 @@ int gps_l1_ca_telemetry_decoder_cc::general_work (int noutput_items __attribute_
         {
             if (d_stat == 1)
                 {
-                    preamble_diff_ms = round((in[0][0].Tracking_timestamp_secs - d_preamble_time_seconds) * 1000.0);
+                    preamble_diff_ms = round((in[0].Tracking_timestamp_secs - d_preamble_time_seconds) * 1000.0);
                     if (preamble_diff_ms > GPS_SUBFRAME_MS+1)
                         {
                             DLOG(INFO) << "Lost of frame sync SAT " << this->d_satellite << " preamble_diff= " << preamble_diff_ms;
@@ -232,105 +266,64 @@ int gps_l1_ca_telemetry_decoder_cc::general_work (int noutput_items __attribute_
                 }
         }
 
-    //******* SYMBOL TO BIT *******
-    if (in[0][0].Flag_valid_symbol_output == true)
+    //******* SYMBOL TO BIT, BITS TO WORD *******
+    if (d_lnav_framer.push_symbol(in[0]))
         {
-            // extended correlation to bit period is enabled in tracking!
-            d_symbol_accumulator += in[0][0].Prompt_I; // accumulate the input value in d_symbol_accumulator
-            d_symbol_accumulator_counter += in[0][0].correlation_length_ms;
+            if (d_lnav_framer.parity_ok())
+                {
+                    d_GPS_FSM.d_preamble_time_ms = d_preamble_time_seconds * 1000.0;
+                    d_GPS_FSM.Event_gps_word(d_lnav_framer);
+                    // send TLM data to PVT using asynchronous message queues
+                    if (d_GPS_FSM.d_flag_new_subframe == true)
+                        {
+                            LATENCY_TRACE(LATENCY_TELEMETRY, d_channel, in[0].sample_counter);
+                            switch (d_GPS_FSM.d_subframe_ID)
+                            {
+                            case 3: //we have a new set of ephemeris data for the current SV
+                                if (d_GPS_FSM.d_nav.satellite_validation() == true)
+                                    {
+                                        // get ephemeris object for this SV (mandatory), sent to the PVT only when it is a new issue
+                                        Gps_Ephemeris_Record record;
+                                        if (d_receiver_state->navigation_data.publish_ephemeris(d_satellite.get_PRN(), d_GPS_FSM.d_nav.get_ephemeris(), d_preamble_time_seconds * 1000.0, record))
+                                            {
+                                                d_message_host->message_port_pub(pmt::mp("telemetry"), pmt::make_any(record.ephemeris));
+                                            }
+                                    }
+                                break;
+                            case 4: // Possible IONOSPHERE and UTC model update (page 18)
+                                if (d_GPS_FSM.d_nav.flag_iono_valid == true)
+                                    {
+                                        std::shared_ptr<Gps_Iono> tmp_obj = d_iono_pool.acquire(d_GPS_FSM.d_nav.get_iono());
+                                        d_message_host->message_port_pub(pmt::mp("telemetry"), pmt::make_any(tmp_obj));
+                                    }
+                                if (d_GPS_FSM.d_nav.flag_utc_model_valid == true)
+                                    {
+                                        std::shared_ptr<Gps_Utc_Model> tmp_obj = d_utc_model_pool.acquire(d_GPS_FSM.d_nav.get_utc_model());
+                                        d_message_host->message_port_pub(pmt::mp("telemetry"), pmt::make_any(tmp_obj));
+                                    }
+                                break;
+                            case 5:
+                                // get almanac (if available)
+                                //TODO: implement almanac reader in navigation_message
+                                break;
+                            default:
+                                break;
+                            }
+                            d_GPS_FSM.clear_flag_new_subframe();
+                        }
+
+                    d_flag_parity = true;
+                }
+            else
+                {
+                    d_GPS_FSM.Event_gps_word(d_lnav_framer);
+                    d_flag_parity = false;
+                }
         }
-    if (d_symbol_accumulator_counter >= 20)
-         {
-             if (d_symbol_accumulator > 0)
-                 { //symbol to bit
-                     d_GPS_frame_4bytes += 1; //insert the telemetry bit in LSB
-                 }
-             d_symbol_accumulator = 0;
-             d_symbol_accumulator_counter = 0;
-             //******* bits to words ******
-             d_frame_bit_index++;
-             if (d_frame_bit_index == 30)
-                 {
-                     d_frame_bit_index = 0;
-                     // parity check
-                     // Each word in wordbuff is composed of:
-                     //      Bits 0 to 29 = the GPS data word
-                     //      Bits 30 to 31 = 2 LSBs of the GPS word ahead.
-                     // prepare the extended frame [-2 -1 0 ... 30]
-                     if (d_prev_GPS_frame_4bytes & 0x00000001)
-                         {
-                             d_GPS_frame_4bytes = d_GPS_frame_4bytes | 0x40000000;
-                         }
-                     if (d_prev_GPS_frame_4bytes & 0x00000002)
-                         {
-                             d_GPS_frame_4bytes = d_GPS_frame_4bytes | 0x80000000;
-                         }
-                     /* Check that the 2 most recently logged words pass parity. Have to first
-                      invert the data bits according to bit 30 of the previous word. */
-                     if(d_GPS_frame_4bytes & 0x40000000)
-                         {
-                             d_GPS_frame_4bytes ^= 0x3FFFFFC0; // invert the data bits (using XOR)
-                         }
-                     if (gps_l1_ca_telemetry_decoder_cc::gps_word_parityCheck(d_GPS_frame_4bytes))
-                         {
-                             memcpy(&d_GPS_FSM.d_GPS_frame_4bytes, &d_GPS_frame_4bytes, sizeof(char)*4);
-                             d_GPS_FSM.d_preamble_time_ms = d_preamble_time_seconds * 1000.0;
-                             d_GPS_FSM.Event_gps_word_valid();
-                             // send TLM data to PVT using asynchronous message queues
-                             if (d_GPS_FSM.d_flag_new_subframe == true)
-                                 {
-                                     switch (d_GPS_FSM.d_subframe_ID)
-                                     {
-                                     case 3: //we have a new set of ephemeris data for the current SV
-                                         if (d_GPS_FSM.d_nav.satellite_validation() == true)
-                                             {
-                                                 // get ephemeris object for this SV (mandatory)
-                                                 std::shared_ptr<Gps_Ephemeris> tmp_obj = std::make_shared<Gps_Ephemeris>(d_GPS_FSM.d_nav.get_ephemeris());
-                                                 this->message_port_pub(pmt::mp("telemetry"), pmt::make_any(tmp_obj));
-                                             }
-                                         break;
-                                     case 4: // Possible IONOSPHERE and UTC model update (page 18)
-                                         if (d_GPS_FSM.d_nav.flag_iono_valid == true)
-                                             {
-                                                 std::shared_ptr<Gps_Iono> tmp_obj = std::make_shared<Gps_Iono>( d_GPS_FSM.d_nav.get_iono());
-                                                 this->message_port_pub(pmt::mp("telemetry"), pmt::make_any(tmp_obj));
-                                             }
-                                         if (d_GPS_FSM.d_nav.flag_utc_model_valid == true)
-                                             {
-                                                 std::shared_ptr<Gps_Utc_Model> tmp_obj = std::make_shared<Gps_Utc_Model>(d_GPS_FSM.d_nav.get_utc_model());
-                                                 this->message_port_pub(pmt::mp("telemetry"), pmt::make_any(tmp_obj));
-                                             }
-                                         break;
-                                     case 5:
-                                         // get almanac (if available)
-                                         //TODO: implement almanac reader in navigation_message
-                                         break;
-                                     default:
-                                         break;
-                                     }
-                                     d_GPS_FSM.clear_flag_new_subframe();
-                                 }
-
-                             d_flag_parity = true;
-                         }
-                     else
-                         {
-                             d_GPS_FSM.Event_gps_word_invalid();
-                             d_flag_parity = false;
-                         }
-                     d_prev_GPS_frame_4bytes = d_GPS_frame_4bytes; // save the actual frame
-                     d_GPS_frame_4bytes = d_GPS_frame_4bytes & 0;
-                 }
-             else
-                 {
-                     d_GPS_frame_4bytes <<= 1; //shift 1 bit left the telemetry word
-                 }
-         }
      // output the frame
-     consume_each(1); //one by one
      Gnss_Synchro current_synchro_data; //structure to save the synchronization information and send the output object to the next block
      //1. Copy the current tracking output
-     current_synchro_data = in[0][0];
+     current_synchro_data = in[0];
      //2. Add the telemetry decoder information
      if (this->d_flag_preamble == true and d_GPS_FSM.d_nav.d_TOW > 0)
          //update TOW at the preamble instant (todo: check for valid d_TOW)
@@ -341,7 +334,7 @@ int gps_l1_ca_telemetry_decoder_cc::general_work (int noutput_items __attribute_
          {
              d_TOW_at_Preamble = d_GPS_FSM.d_nav.d_TOW + GPS_SUBFRAME_SECONDS; //we decoded the current TOW when the last word of the subframe arrive, so, we have a lag of ONE SUBFRAME
              d_TOW_at_current_symbol = d_TOW_at_Preamble;
-             Prn_timestamp_at_preamble_ms = in[0][0].Tracking_timestamp_secs * 1000.0;
+             Prn_timestamp_at_preamble_ms = in[0].Tracking_timestamp_secs * 1000.0;
              if (flag_TOW_set == false)
                  {
                      flag_TOW_set = true;
@@ -357,7 +350,7 @@ int gps_l1_ca_telemetry_decoder_cc::general_work (int noutput_items __attribute_
      current_synchro_data.d_TOW_hybrid_at_current_symbol = current_synchro_data.d_TOW_at_current_symbol; // to be  used in the hybrid configuration
      current_synchro_data.Flag_valid_word = (d_flag_frame_sync == true and d_flag_parity == true and flag_TOW_set == true);
      current_synchro_data.Flag_preamble = d_flag_preamble;
-     current_synchro_data.Prn_timestamp_ms = in[0][0].Tracking_timestamp_secs * 1000.0;
+     current_synchro_data.Prn_timestamp_ms = in[0].Tracking_timestamp_secs * 1000.0;
      current_synchro_data.Prn_timestamp_at_preamble_ms = Prn_timestamp_at_preamble_ms;
 
      if (flag_PLL_180_deg_phase_locked == true)
@@ -369,20 +362,9 @@ int gps_l1_ca_telemetry_decoder_cc::general_work (int noutput_items __attribute_
      if(d_dump == true)
          {
              // MULTIPLEXED FILE RECORDING - Record results to file
-             try
-             {
-                     double tmp_double;
-                     tmp_double = d_TOW_at_current_symbol;
-                     d_dump_file.write((char*)&tmp_double, sizeof(double));
-                     tmp_double = current_synchro_data.Prn_timestamp_ms;
-                     d_dump_file.write((char*)&tmp_double, sizeof(double));
-                     tmp_double = d_TOW_at_Preamble;
-                     d_dump_file.write((char*)&tmp_double, sizeof(double));
-             }
-             catch (const std::ifstream::failure & e)
-             {
-                     LOG(WARNING) << "Exception writing observables dump file " << e.what();
-             }
+             d_dump_file.put<double>(d_TOW_at_current_symbol);
+             d_dump_file.put<double>(current_synchro_data.Prn_timestamp_ms);
+             d_dump_file.put<double>(d_TOW_at_Preamble);
          }
 
      //todo: implement averaging
@@ -392,7 +374,7 @@ int gps_l1_ca_telemetry_decoder_cc::general_work (int noutput_items __attribute_
          {
              d_average_count = 0;
              //3. Make the output (copy the object contents to the GNURadio reserved memory)
-             *out[0] = current_synchro_data;
+             *out = current_synchro_data;
              //std::cout<<"GPS L1 TLM output on CH="<<this->d_channel << " SAMPLE STAMP="<<d_sample_counter/d_decimation_output_factor<<std::endl;
              return 1;
          }
@@ -420,6 +402,7 @@ int gps_l1_ca_telemetry_decoder_cc::general_work (int noutput_items __attribute_
  void gps_l1_ca_telemetry_decoder_cc::set_channel(int channel)
  {
      d_channel = channel;
+     d_metrics = make_block_metrics("telemetry", "ch" + std::to_string(channel));
      d_GPS_FSM.i_channel_ID = channel;
      DLOG(INFO) << "Navigation channel set to " << channel;
      // ############# ENABLE DATA FILE LOG #################
@@ -427,20 +410,18 @@ int gps_l1_ca_telemetry_decoder_cc::general_work (int noutput_items __attribute_
          {
              if (d_dump_file.is_open() == false)
                  {
-                     try
-                     {
-                             d_dump_filename = "telemetry";
-                             d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
-                             d_dump_filename.append(".dat");
-                             d_dump_file.exceptions ( std::ifstream::failbit | std::ifstream::badbit );
-                             d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                     d_dump_filename = "telemetry";
+                     d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                     d_dump_filename.append(".dat");
+                     if (d_dump_file.open(d_dump_filename, telemetry_dump_schema()))
+                         {
                              LOG(INFO) << "Telemetry decoder dump enabled on channel " << d_channel
                                      << " Log file: " << d_dump_filename.c_str();
-                     }
-                     catch (const std::ifstream::failure &e)
-                     {
-                             LOG(WARNING) << "channel " << d_channel << " Exception opening trk dump file " << e.what();
-                     }
+                         }
+                     else
+                         {
+                             LOG(WARNING) << "channel " << d_channel << " cannot open telemetry dump file " << d_dump_filename;
+                         }
                  }
          }
  }
@@ -32,13 +32,23 @@
 #define GNSS_SDR_GPS_L1_CA_TELEMETRY_DECODER_CC_H
 
 #include <fstream>
+#include <memory>
 #include <string>
+#include <vector>
 #include <gnuradio/block.h>
 #include <deque>
 #include "GPS_L1_CA.h"
 #include "gps_l1_ca_subframe_fsm.h"
+#include "message_pool.h"
 #include "concurrent_queue.h"
 #include "gnss_satellite.h"
+#include "preamble_correlator.h"
+#include "lnav_word_framer.h"
+#include "navigation_data_bus.h"
+#include "receiver_state.h"
+#include "block_metrics.h"
+#include "dump_writer.h"
+#include "gnss_synchro_stage.h"
 
 
 
@@ -52,8 +62,10 @@ gps_l1_ca_make_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump);
 /*!
  * \brief This class implements a block that decodes the NAV data defined in IS-GPS-200E
  *
+ * It can also run inline in the tracking block of its channel (see
+ * Gnss_Synchro_Stage), which then has no buffer and thread between them.
  */
-class gps_l1_ca_telemetry_decoder_cc : public gr::block
+class gps_l1_ca_telemetry_decoder_cc : public gr::block, public Gnss_Synchro_Stage
 {
 public:
     ~gps_l1_ca_telemetry_decoder_cc();
@@ -77,6 +89,9 @@ public:
     void forecast (int noutput_items, gr_vector_int &ninput_items_required);
     void set_state(unsigned int state);
 
+    void attach_to(gr::basic_block* host);
+    int push_epoch(const Gnss_Synchro& epoch, Gnss_Synchro* out);
+
 
 private:
     friend gps_l1_ca_telemetry_decoder_cc_sptr
@@ -84,26 +99,24 @@ private:
 
     gps_l1_ca_telemetry_decoder_cc(Gnss_Satellite satellite, bool dump);
 
-    bool gps_word_parityCheck(unsigned int gpsword);
+    // decodes in[0], with the preamble length of symbols from in[0] on
+    int decode_symbol(const Gnss_Synchro* in, Gnss_Synchro* out);
 
     // constants
     //unsigned short int d_preambles_bits[GPS_CA_PREAMBLE_LENGTH_BITS];
     // class private vars
 
     int *d_preambles_symbols;
+    Preamble_Correlator* d_preamble_correlator;
     unsigned int d_stat;
     bool d_flag_frame_sync;
 
     // symbols
     std::deque<double> d_symbol_history;
     std::deque<int> d_correlation_length_ms_history;
-    double d_symbol_accumulator;
-    short int d_symbol_accumulator_counter;
 
     //bits and frame
-    unsigned short int d_frame_bit_index;
-    unsigned int d_GPS_frame_4bytes;
-    unsigned int d_prev_GPS_frame_4bytes;
+    Lnav_Word_Framer d_lnav_framer;
     bool d_flag_parity;
     bool d_flag_preamble;
     int d_word_number;
@@ -119,7 +132,9 @@ private:
 
     bool d_dump;
     Gnss_Satellite d_satellite;
+    std::shared_ptr<Receiver_State> d_receiver_state; // tables of the receiver, current at construction
     int d_channel;
+    std::shared_ptr<Block_Metrics> d_metrics; // made by set_channel
 
     double d_preamble_time_seconds;
 
@@ -131,8 +146,18 @@ private:
     bool flag_PLL_180_deg_phase_locked;
 
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
     unsigned int channel_state;
+
+    // payloads of the navigation data messages to the PVT
+    Message_Pool<Gps_Iono> d_iono_pool;
+    Message_Pool<Gps_Utc_Model> d_utc_model_pool;
+
+    // inline in a tracking block: the host of the message ports, and the
+    // symbols pushed but not decoded yet, from d_lookahead_first on
+    gr::basic_block* d_message_host;
+    std::vector<Gnss_Synchro> d_lookahead;
+    unsigned int d_lookahead_first;
 };
 
 #endif
@@ -200,14 +200,14 @@ int gps_l2_m_telemetry_decoder_cc::general_work (int noutput_items __attribute__
                                             if (d_CNAV_Message.have_new_ephemeris() == true)
                                                 {
                                                     // get ephemeris object for this SV
-                                                    std::shared_ptr<Gps_CNAV_Ephemeris> tmp_obj= std::make_shared<Gps_CNAV_Ephemeris>(d_CNAV_Message.get_ephemeris());
+                                                    std::shared_ptr<Gps_CNAV_Ephemeris> tmp_obj= d_ephemeris_pool.acquire(d_CNAV_Message.get_ephemeris());
                                                     std::cout << "New GPS CNAV Ephemeris received for SV " << tmp_obj->i_satellite_PRN << std::endl;
                                                     this->message_port_pub(pmt::mp("telemetry"), pmt::make_any(tmp_obj));
 
                                                 }
                                             if (d_CNAV_Message.have_new_iono() == true)
                                                 {
-                                                    std::shared_ptr<Gps_CNAV_Iono> tmp_obj= std::make_shared<Gps_CNAV_Iono>(d_CNAV_Message.get_iono());
+                                                    std::shared_ptr<Gps_CNAV_Iono> tmp_obj= d_iono_pool.acquire(d_CNAV_Message.get_iono());
                                                     std::cout << "New GPS CNAV IONO model received for SV " << d_satellite.get_PRN() << std::endl;
                                                     this->message_port_pub(pmt::mp("telemetry"), pmt::make_any(tmp_obj));
                                                 }
@@ -443,7 +443,7 @@ void gps_l2_m_telemetry_decoder_cc::crc_verifier::get_valid_frames(const std::ve
             std::vector<unsigned char> candidate_bytes;
             zerropad_back_and_convert_to_bytes(candidate_it->second, candidate_bytes);
             // verify CRC
-            d_checksum_agent.reset(0);
+            d_checksum_agent.reset();
             d_checksum_agent.process_bytes(candidate_bytes.data(), candidate_bytes.size());
             unsigned int crc = d_checksum_agent.checksum();
             //LOG(INFO) << "candidate " << ": final crc remainder= " << std::hex << crc
@@ -37,13 +37,14 @@
 #include <string>
 #include <utility> // for pair
 #include <vector>
-#include <boost/crc.hpp>
 #include <gnuradio/block.h>
+#include "crc24q.h"
 #include "gnss_satellite.h"
 #include "viterbi_decoder.h"
 #include "gps_cnav_navigation_message.h"
 #include "gps_cnav_ephemeris.h"
 #include "gps_cnav_iono.h"
+#include "message_pool.h"
 #include "concurrent_queue.h"
 #include "GPS_L2C.h"
 
@@ -142,14 +143,17 @@ private:
         void reset();
         void get_valid_frames(const std::vector<msg_candiate_int_t> & msg_candidates, std::vector<msg_candiate_int_t> & valid_msgs);
     private:
-        typedef boost::crc_optimal<24, 0x1864CFBu, 0x0, 0x0, false, false> crc_24_q_type;
-        crc_24_q_type d_checksum_agent;
+        Crc24q d_checksum_agent;
         void zerropad_front_and_convert_to_bytes(const std::vector<int> & msg_candidate, std::vector<unsigned char> & bytes);
         void zerropad_back_and_convert_to_bytes(const std::vector<int> & msg_candidate, std::vector<unsigned char> & bytes);
     } d_crc_verifier;
 
     Gps_CNAV_Navigation_Message d_CNAV_Message;
     unsigned int channel_state;
+
+    // payloads of the navigation data messages to the PVT
+    Message_Pool<Gps_CNAV_Ephemeris> d_ephemeris_pool;
+    Message_Pool<Gps_CNAV_Iono> d_iono_pool;
 };
 
 
@@ -28,6 +28,8 @@
  * -------------------------------------------------------------------------
  */
 
+#include <algorithm>
+#include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <gnuradio/io_signature.h>
@@ -131,7 +133,7 @@ int sbas_l1_telemetry_decoder_cc::general_work (int noutput_items __attribute__(
 
             // search for preambles
             // and extract the corresponding message candidates
-            std::vector<msg_candiate_int_t> msg_candidates;
+            std::vector<msg_candiate_frame_t> msg_candidates;
             d_frame_detector.get_frame_candidates(bits, msg_candidates);
 
             // verify checksum
@@ -358,64 +360,36 @@ bool sbas_l1_telemetry_decoder_cc::symbol_aligner_and_decoder::get_bits(const st
 // ### helper class for detecting the preamble and collect the corresponding message candidates ###
 void sbas_l1_telemetry_decoder_cc::frame_detector::reset()
 {
-    d_buffer.clear();
+    d_frame.clear();
 }
 
 
-void sbas_l1_telemetry_decoder_cc::frame_detector::get_frame_candidates(const std::vector<int> bits, std::vector<std::pair<int,std::vector<int>>> &msg_candidates)
+void sbas_l1_telemetry_decoder_cc::frame_detector::get_frame_candidates(const std::vector<int> bits, std::vector<msg_candiate_frame_t> &msg_candidates)
 {
-    std::stringstream ss;
-    unsigned int sbas_msg_length = 250;
-    std::vector<std::vector<int>> preambles = {{0, 1, 0, 1, 0, 0, 1 ,1},
-                                               {1, 0, 0, 1, 1, 0, 1, 0},
-                                               {1, 1, 0, 0, 0, 1, 1, 0}};
-    VLOG(FLOW) << "get_frame_candidates(): " << "d_buffer.size()=" << d_buffer.size() << "\tbits.size()=" << bits.size();
-    ss << "copy bits ";
-    int count = 0;
-    // copy new bits into the working buffer
-    for (std::vector<int>::const_iterator bit_it = bits.begin(); bit_it < bits.end(); ++bit_it)
-        {
-            d_buffer.push_back(*bit_it);
-            ss << *bit_it;
-            count++;
-        }
-    VLOG(SAMP_SYNC) << ss.str() << " into working buffer (" << count << " bits)";
-    int relative_preamble_start = 0;
-    while(d_buffer.size() >= sbas_msg_length)
+    // the three rotating preambles 01010011, 10011010 and 11000110
+    const unsigned char preambles[3] = {0x53, 0x9A, 0xC6};
+    VLOG(FLOW) << "get_frame_candidates(): " << "d_frame.size()=" << d_frame.size() << "\tbits.size()=" << bits.size();
+    // bits of the previous call that can still start a frame
+    unsigned int n_previous = std::min(d_frame.size(), Sbas_Frame::BITS - 1);
+    for (unsigned int i = 0; i < bits.size(); i++)
         {
-            // compare with all preambles
-            for (std::vector<std::vector<int>>::iterator preample_it = preambles.begin(); preample_it < preambles.end(); ++preample_it)
+            d_frame.push_back(bits[i]);
+            if (!d_frame.full()) continue;
+            int relative_preamble_start = n_previous + i + 1 - Sbas_Frame::BITS;
+            for (int p = 0; p < 3; p++)
                 {
-                    bool preamble_detected = true;
-                    bool inv_preamble_detected = true;
-                    // compare the buffer bits with the preamble bits
-                    for (std::vector<int>::iterator preample_bit_it = preample_it->begin(); preample_bit_it < preample_it->end(); ++preample_bit_it)
-                        {
-                            preamble_detected = *preample_bit_it == d_buffer[preample_bit_it - preample_it->begin()] ? preamble_detected : false ;
-                            inv_preamble_detected = *preample_bit_it != d_buffer[preample_bit_it - preample_it->begin()] ? inv_preamble_detected : false ;
-                        }
+                    bool preamble_detected = d_frame.preamble() == preambles[p];
+                    bool inv_preamble_detected = d_frame.preamble() == static_cast<unsigned char>(~preambles[p]);
                     if (preamble_detected || inv_preamble_detected)
                         {
-                            // copy candidate
-                            std::vector<int> candidate;
-                            std::copy(d_buffer.begin(), d_buffer.begin() + sbas_msg_length, std::back_inserter(candidate));
-                            if(inv_preamble_detected)
+                            msg_candidates.push_back(msg_candiate_frame_t(relative_preamble_start, d_frame));
+                            if (inv_preamble_detected)
                                 {
-                                    // invert bits
-                                    for (std::vector<int>::iterator candidate_bit_it = candidate.begin(); candidate_bit_it != candidate.end(); candidate_bit_it++)
-                                        *candidate_bit_it = *candidate_bit_it == 0 ? 1 : 0;
+                                    msg_candidates.back().second.invert();
                                 }
-                            msg_candidates.push_back(std::pair<int,std::vector<int>>(relative_preamble_start, candidate));
-                            ss.str("");
-                            ss << "preamble " << preample_it - preambles.begin() << (inv_preamble_detected?" inverted":" normal") << " detected! candidate=";
-                            for (std::vector<int>::iterator bit_it = candidate.begin(); bit_it < candidate.end(); ++bit_it)
-                                ss << *bit_it;
-                            VLOG(EVENT) << ss.str();
+                            VLOG(EVENT) << "preamble " << p << (inv_preamble_detected ? " inverted" : " normal") << " detected at " << relative_preamble_start;
                         }
                 }
-            relative_preamble_start++;
-            // remove bit in front
-            d_buffer.pop_front();
         }
 }
 
@@ -428,27 +402,18 @@ void sbas_l1_telemetry_decoder_cc::crc_verifier::reset()
 
 }
 
-void sbas_l1_telemetry_decoder_cc::crc_verifier::get_valid_frames(const std::vector<msg_candiate_int_t> msg_candidates, std::vector<msg_candiate_char_t> &valid_msgs)
+void sbas_l1_telemetry_decoder_cc::crc_verifier::get_valid_frames(const std::vector<msg_candiate_frame_t> &msg_candidates, std::vector<msg_candiate_char_t> &valid_msgs)
 {
     std::stringstream ss;
     VLOG(FLOW) << "get_valid_frames(): " << "msg_candidates.size()=" << msg_candidates.size();
     // for each candidate
-    for (std::vector<msg_candiate_int_t>::const_iterator candidate_it = msg_candidates.begin(); candidate_it < msg_candidates.end(); ++candidate_it)
+    for (std::vector<msg_candiate_frame_t>::const_iterator candidate_it = msg_candidates.begin(); candidate_it < msg_candidates.end(); ++candidate_it)
         {
-            // convert to bytes
-            std::vector<unsigned char> candidate_bytes;
-            zerropad_back_and_convert_to_bytes(candidate_it->second, candidate_bytes);
-            // verify CRC
-            d_checksum_agent.reset(0);
-            d_checksum_agent.process_bytes(candidate_bytes.data(), candidate_bytes.size());
-            unsigned int crc = d_checksum_agent.checksum();
-            VLOG(SAMP_SYNC) << "candidate " << candidate_it - msg_candidates.begin()
-                            << ": final crc remainder= " << std::hex << crc
-                            << std::setfill(' ') << std::resetiosflags(std::ios::hex);
             //  the final remainder must be zero for a valid message, because the CRC is done over the received CRC value
-            if (crc == 0)
+            ss.str("");
+            if (candidate_it->second.crc_ok())
                 {
-                    valid_msgs.push_back(msg_candiate_char_t(candidate_it->first, candidate_bytes));
+                    valid_msgs.push_back(msg_candiate_char_t(candidate_it->first, candidate_it->second.bytes()));
                     ss << "Valid message found!";
                 }
             else
@@ -456,71 +421,15 @@ void sbas_l1_telemetry_decoder_cc::crc_verifier::get_valid_frames(const std::vec
                     ss << "Not a valid message.";
                 }
             ss << " Relbitoffset=" << candidate_it->first << " content=";
-            for (std::vector<unsigned char>::iterator byte_it = candidate_bytes.begin(); byte_it < candidate_bytes.end(); ++byte_it)
+            for (unsigned int i = 0; i < Sbas_Frame::BYTES; i++)
                 {
-                    ss << std::setw(2) << std::setfill('0') << std::hex << (unsigned int)(*byte_it);
+                    ss << std::setw(2) << std::setfill('0') << std::hex << (unsigned int)(candidate_it->second.data()[i]);
                 }
             VLOG(SAMP_SYNC) << ss.str() << std::setfill(' ') << std::resetiosflags(std::ios::hex) << std::endl;
         }
 }
 
 
-
-
-
-void sbas_l1_telemetry_decoder_cc::crc_verifier::zerropad_back_and_convert_to_bytes(const std::vector<int> msg_candidate, std::vector<unsigned char> &bytes)
-{
-    std::stringstream ss;
-    const size_t bits_per_byte = 8;
-    unsigned char byte = 0;
-    VLOG(LMORE) << "zerropad_back_and_convert_to_bytes():" << byte;
-    for (std::vector<int>::const_iterator candidate_bit_it = msg_candidate.begin(); candidate_bit_it < msg_candidate.end(); ++candidate_bit_it)
-        {
-            int idx_bit = candidate_bit_it - msg_candidate.begin();
-            int bit_pos_in_current_byte = (bits_per_byte - 1) - (idx_bit % bits_per_byte);
-            byte |= (unsigned char)(*candidate_bit_it) << bit_pos_in_current_byte;
-            ss << *candidate_bit_it;
-            if (idx_bit % bits_per_byte == bits_per_byte - 1)
-                {
-                    bytes.push_back(byte);
-                    VLOG(LMORE) << ss.str() << " -> byte=" << std::setw(2) << std::setfill('0') << std::hex << (unsigned int)byte; ss.str("");
-                    byte = 0;
-                }
-        }
-    bytes.push_back(byte); // implies: insert 6 zeros at the end to fit the 250bits into a multiple of bytes
-    VLOG(LMORE) << " -> byte=" << std::setw(2)
-                << std::setfill('0') << std::hex << (unsigned int)byte
-                << std::setfill(' ') << std::resetiosflags(std::ios::hex);
-}
-
-
-
-void sbas_l1_telemetry_decoder_cc::crc_verifier::zerropad_front_and_convert_to_bytes(const std::vector<int> msg_candidate, std::vector<unsigned char> &bytes)
-{
-    std::stringstream ss;
-    const size_t bits_per_byte = 8;
-    unsigned char byte = 0;
-    int idx_bit = 6; // insert 6 zeros at the front to fit the 250bits into a multiple of bytes
-    VLOG(LMORE) << "zerropad_front_and_convert_to_bytes():" << byte;
-    for (std::vector<int>::const_iterator candidate_bit_it = msg_candidate.begin(); candidate_bit_it < msg_candidate.end(); ++candidate_bit_it)
-        {
-            int bit_pos_in_current_byte = (bits_per_byte - 1) - (idx_bit % bits_per_byte);
-            byte |= (unsigned char)(*candidate_bit_it) << bit_pos_in_current_byte;
-            ss << *candidate_bit_it;
-            if (idx_bit % bits_per_byte == bits_per_byte - 1)
-                {
-                    bytes.push_back(byte);
-                    VLOG(LMORE) << ss.str() << " -> byte=" << std::setw(2)
-                                << std::setfill('0') << std::hex << (unsigned int)byte; ss.str("");
-                    byte = 0;
-                }
-            idx_bit++;
-        }
-    VLOG(LMORE) << " -> byte=" << std::setw(2)
-                << std::setfill('0') << std::hex << (unsigned int)byte
-                << std::setfill(' ') << std::resetiosflags(std::ios::hex);
-}
-
 void sbas_l1_telemetry_decoder_cc::set_state(unsigned int state)
  {
     channel_state = state;
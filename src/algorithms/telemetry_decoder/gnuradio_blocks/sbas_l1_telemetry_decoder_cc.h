@@ -31,13 +31,10 @@
 #ifndef GNSS_SDR_SBAS_L1_TELEMETRY_DECODER_CC_H
 #define GNSS_SDR_SBAS_L1_TELEMETRY_DECODER_CC_H
 
-#include <algorithm> // for copy
-#include <deque>
 #include <fstream>
 #include <string>
 #include <utility> // for pair
 #include <vector>
-#include <boost/crc.hpp>
 #include <gnuradio/block.h>
 #include "gnss_satellite.h"
 #include "viterbi_decoder.h"
@@ -96,7 +93,7 @@ private:
     size_t d_block_size; //!< number of samples which are processed during one invocation of the algorithms
     std::vector<double> d_sample_buf; //!< input buffer holding the samples to be processed in one block
 
-    typedef std::pair<int,std::vector<int>> msg_candiate_int_t;
+    typedef std::pair<int,Sbas_Frame> msg_candiate_frame_t;
     typedef std::pair<int,std::vector<unsigned char>> msg_candiate_char_t;
     unsigned int channel_state;
 
@@ -142,9 +139,9 @@ private:
     {
     public:
         void reset();
-        void get_frame_candidates(const std::vector<int> bits, std::vector<std::pair<int, std::vector<int>>> &msg_candidates);
+        void get_frame_candidates(const std::vector<int> bits, std::vector<msg_candiate_frame_t> &msg_candidates);
     private:
-        std::deque<int> d_buffer;
+        Sbas_Frame d_frame; // the last 250 bits
     } d_frame_detector;
 
 
@@ -153,12 +150,7 @@ private:
     {
     public:
         void reset();
-        void get_valid_frames(const std::vector<msg_candiate_int_t> msg_candidates, std::vector<msg_candiate_char_t> &valid_msgs);
-    private:
-        typedef boost::crc_optimal<24, 0x1864CFBu, 0x0, 0x0, false, false> crc_24_q_type;
-        crc_24_q_type d_checksum_agent;
-        void zerropad_front_and_convert_to_bytes(const std::vector<int> msg_candidate, std::vector<unsigned char> &bytes);
-        void zerropad_back_and_convert_to_bytes(const std::vector<int> msg_candidate, std::vector<unsigned char> &bytes);
+        void get_valid_frames(const std::vector<msg_candiate_frame_t> &msg_candidates, std::vector<msg_candiate_char_t> &valid_msgs);
     } d_crc_verifier;
 
 
@@ -0,0 +1,99 @@
+/*!
+ * \file galileo_fec_decoder.cc
+ * \brief Soft-decision FEC decoding of the Galileo I/NAV and F/NAV pages:
+ * block deinterleaver and Viterbi decoder
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "galileo_fec_decoder.h"
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+// FEC encoder of the Galileo ICD, Figure 13: K=7, rate 1/2, G1 = 171o and G2 = 133o
+const int galileo_fec_KK = 7;
+const int galileo_fec_nn = 2;
+const int galileo_fec_g[2] = {121, 91};
+}
+
+
+Galileo_Fec_Decoder::Galileo_Fec_Decoder(int rows, int cols) :
+        d_rows(rows),
+        d_cols(cols),
+        d_viterbi(galileo_fec_g, galileo_fec_KK, galileo_fec_nn),
+        d_deinterleaved(rows * cols)
+{}
+
+
+void Galileo_Fec_Decoder::decode(const float* page_symbols, int* bits)
+{
+    deinterleave(d_rows, d_cols, page_symbols, &d_deinterleaved[0]);
+    int tail = galileo_fec_KK - 1;
+    int data_bits = symbols() / galileo_fec_nn - tail;
+    d_viterbi.decode_block(&d_deinterleaved[0], bits, data_bits);
+    std::fill(bits + data_bits, bits + data_bits + tail, 0);
+}
+
+
+void Galileo_Fec_Decoder::deinterleave(int rows, int cols, const float* in, float* out)
+{
+    // out[c * rows + r] = in[r * cols + c], and the odd symbols of out are negated
+    int c = 0;
+#ifdef __SSE2__
+    if (rows % 4 == 0)
+        {
+            // the odd symbols of out are the odd rows
+            const __m128 g2_not = _mm_set_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+            for (; c + 4 <= cols; c += 4)
+                {
+                    for (int r = 0; r < rows; r += 4)
+                        {
+                            __m128 col0 = _mm_loadu_ps(in + r * cols + c);
+                            __m128 col1 = _mm_loadu_ps(in + (r + 1) * cols + c);
+                            __m128 col2 = _mm_loadu_ps(in + (r + 2) * cols + c);
+                            __m128 col3 = _mm_loadu_ps(in + (r + 3) * cols + c);
+                            _MM_TRANSPOSE4_PS(col0, col1, col2, col3);
+                            _mm_storeu_ps(out + c * rows + r, _mm_xor_ps(col0, g2_not));
+                            _mm_storeu_ps(out + (c + 1) * rows + r, _mm_xor_ps(col1, g2_not));
+                            _mm_storeu_ps(out + (c + 2) * rows + r, _mm_xor_ps(col2, g2_not));
+                            _mm_storeu_ps(out + (c + 3) * rows + r, _mm_xor_ps(col3, g2_not));
+                        }
+                }
+        }
+#endif
+    for (; c < cols; c++)
+        {
+            for (int r = 0; r < rows; r++)
+                {
+                    int n = c * rows + r;
+                    out[n] = (n % 2) ? -in[r * cols + c] : in[r * cols + c];
+                }
+        }
+}
@@ -0,0 +1,82 @@
+/*!
+ * \file galileo_fec_decoder.h
+ * \brief Soft-decision FEC decoding of the Galileo I/NAV and F/NAV pages:
+ * block deinterleaver and Viterbi decoder
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_GALILEO_FEC_DECODER_H_
+#define GNSS_SDR_GALILEO_FEC_DECODER_H_
+
+#include <vector>
+#include "viterbi_decoder.h"
+
+/*!
+ * \brief Decodes the pages of a Galileo telemetry decoder: block
+ * deinterleaver, NOT gate of G2 and the K=7 rate 1/2 Viterbi decoder.
+ *
+ * The soft symbols are single precision and the buffers are allocated once,
+ * so a page costs one deinterleaving pass and one Viterbi run. The same
+ * decoder serves the I/NAV page parts of E1B (8 x 30) and the F/NAV pages
+ * of E5a (8 x 61).
+ */
+class Galileo_Fec_Decoder
+{
+public:
+    Galileo_Fec_Decoder(int rows, int cols);
+
+    //! Number of symbols of a page, without the preamble
+    int symbols() const { return d_rows * d_cols; }
+
+    /*!
+     * \brief Decodes a page.
+     *
+     * \param[in]  page_symbols  symbols() soft symbols after the preamble, with the polarity of the preamble
+     * \param[out] bits          symbols() / 2 bits, of which the last 6 are the zero tail
+     */
+    void decode(const float* page_symbols, int* bits);
+
+    /*!
+     * \brief Writes the symbols of a rows x cols block interleaver in their
+     * transmission order, negating those that went through the NOT gate of G2.
+     *
+     * With SSE2 and a multiple of 4 rows, the blocks of 4 x 4 symbols are
+     * transposed in registers.
+     */
+    static void deinterleave(int rows, int cols, const float* in, float* out);
+
+private:
+    Galileo_Fec_Decoder(const Galileo_Fec_Decoder&);
+    Galileo_Fec_Decoder& operator=(const Galileo_Fec_Decoder&);
+
+    int d_rows;
+    int d_cols;
+    Viterbi_Decoder d_viterbi;
+    std::vector<float> d_deinterleaved;
+};
+
+#endif
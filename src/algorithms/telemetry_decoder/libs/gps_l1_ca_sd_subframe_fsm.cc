@@ -32,207 +32,10 @@
  */
 
 #include "gps_l1_ca_sd_subframe_fsm.h"
+#include <iostream>
 #include <string>
-#include <boost/statechart/simple_state.hpp>
-#include <boost/statechart/state.hpp>
-#include <boost/statechart/transition.hpp>
-#include <boost/statechart/custom_reaction.hpp>
-#include <boost/mpl/list.hpp>
 #include "gnss_satellite.h"
-
-//************ GPS WORD TO SUBFRAME DECODER STATE MACHINE **********
-
-struct Ev_gps_word_valid : sc::event<Ev_gps_word_valid> {};
-struct Ev_gps_word_invalid : sc::event<Ev_gps_word_invalid>{};
-struct Ev_gps_word_preamble : sc::event<Ev_gps_word_preamble>{};
-
-
-struct gps_sd_subframe_fsm_S0: public sc::state<gps_sd_subframe_fsm_S0, GpsL1CaSdSubframeFsm>
-{
-public:
-    // sc::transition(event,next_status)
-    typedef sc::transition< Ev_gps_word_preamble, gps_sd_subframe_fsm_S1 > reactions;
-    gps_sd_subframe_fsm_S0(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S0 "<<std::endl;
-    }
-};
-
-
-
-
-struct gps_sd_subframe_fsm_S1: public sc::state<gps_sd_subframe_fsm_S1, GpsL1CaSdSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_sd_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_sd_subframe_fsm_S2 > > reactions;
-
-    gps_sd_subframe_fsm_S1(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S1 "<<std::endl;
-    }
-};
-
-
-
-
-struct gps_sd_subframe_fsm_S2: public sc::state<gps_sd_subframe_fsm_S2, GpsL1CaSdSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_sd_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_sd_subframe_fsm_S3 > > reactions;
-
-    gps_sd_subframe_fsm_S2(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S2 "<<std::endl;
-        context< GpsL1CaSdSubframeFsm >().gps_word_to_subframe(0);
-    }
-};
-
-
-
-
-struct gps_sd_subframe_fsm_S3: public sc::state<gps_sd_subframe_fsm_S3, GpsL1CaSdSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_sd_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_sd_subframe_fsm_S4 > > reactions;
-
-    gps_sd_subframe_fsm_S3(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S3 "<<std::endl;
-        context< GpsL1CaSdSubframeFsm >().gps_word_to_subframe(1);
-    }
-};
-
-
-
-
-struct gps_sd_subframe_fsm_S4: public sc::state<gps_sd_subframe_fsm_S4, GpsL1CaSdSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_sd_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_sd_subframe_fsm_S5 > > reactions;
-
-    gps_sd_subframe_fsm_S4(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S4 "<<std::endl;
-        context< GpsL1CaSdSubframeFsm >().gps_word_to_subframe(2);
-    }
-};
-
-
-
-
-struct gps_sd_subframe_fsm_S5: public sc::state<gps_sd_subframe_fsm_S5, GpsL1CaSdSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_sd_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_sd_subframe_fsm_S6 > > reactions;
-
-    gps_sd_subframe_fsm_S5(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S5 "<<std::endl;
-        context< GpsL1CaSdSubframeFsm >().gps_word_to_subframe(3);
-    }
-};
-
-
-
-
-
-struct gps_sd_subframe_fsm_S6: public sc::state<gps_sd_subframe_fsm_S6, GpsL1CaSdSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_sd_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_sd_subframe_fsm_S7 > > reactions;
-
-    gps_sd_subframe_fsm_S6(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S6 "<<std::endl;
-        context< GpsL1CaSdSubframeFsm >().gps_word_to_subframe(4);
-    }
-};
-
-
-
-struct gps_sd_subframe_fsm_S7: public sc::state<gps_sd_subframe_fsm_S7, GpsL1CaSdSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_sd_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_sd_subframe_fsm_S8 > > reactions;
-
-    gps_sd_subframe_fsm_S7(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S7 "<<std::endl;
-        context< GpsL1CaSdSubframeFsm >().gps_word_to_subframe(5);
-    }
-};
-
-
-
-struct gps_sd_subframe_fsm_S8: public sc::state<gps_sd_subframe_fsm_S8, GpsL1CaSdSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_sd_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_sd_subframe_fsm_S9 > > reactions;
-
-    gps_sd_subframe_fsm_S8(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S8 "<<std::endl;
-        context< GpsL1CaSdSubframeFsm >().gps_word_to_subframe(6);
-    }
-};
-
-
-
-
-struct gps_sd_subframe_fsm_S9: public sc::state<gps_sd_subframe_fsm_S9, GpsL1CaSdSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_sd_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_sd_subframe_fsm_S10 > > reactions;
-
-    gps_sd_subframe_fsm_S9(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S9 "<<std::endl;
-        context< GpsL1CaSdSubframeFsm >().gps_word_to_subframe(7);
-    }
-};
-
-
-
-struct gps_sd_subframe_fsm_S10: public sc::state<gps_sd_subframe_fsm_S10, GpsL1CaSdSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_sd_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_sd_subframe_fsm_S11 > > reactions;
-
-    gps_sd_subframe_fsm_S10(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S10 "<<std::endl;
-        context< GpsL1CaSdSubframeFsm >().gps_word_to_subframe(8);
-    }
-};
-
-
-
-struct gps_sd_subframe_fsm_S11: public sc::state<gps_sd_subframe_fsm_S11, GpsL1CaSdSubframeFsm>
-{
-public:
-    typedef sc::transition< Ev_gps_word_preamble, gps_sd_subframe_fsm_S1 > reactions;
-
-    gps_sd_subframe_fsm_S11(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Completed GPS Subframe!"<<std::endl;
-        context< GpsL1CaSdSubframeFsm >().gps_word_to_subframe(9);
-        context< GpsL1CaSdSubframeFsm >().gps_sd_subframe_to_nav_msg(); //decode the subframe
-        // DECODE SUBFRAME
-        //std::cout<<"Enter S11"<<std::endl;
-    }
-};
-
-
+#include "spoofing_replay.h"
 
 
 GpsL1CaSdSubframeFsm::GpsL1CaSdSubframeFsm()
@@ -243,78 +46,158 @@ GpsL1CaSdSubframeFsm::GpsL1CaSdSubframeFsm()
     d_preamble_time_ms = 0;
     d_subframe_ID=0;
     d_flag_new_subframe=false;
-    initiate(); //start the FSM
+    d_GPS_word = 0;
+    d_TOW = 0;
+    i_GPS_week = 0;
+    for (int i = 0; i < GPS_SUBFRAME_WORDS; i++)
+        {
+            d_subframe[i] = 0;
+        }
+    d_word_index = -1; // waits for a preamble
+    spoofing_detector = nullptr;
+    i_peak = 0;
 }
 
 
 
-void GpsL1CaSdSubframeFsm::gps_word_to_subframe(int position)
-{
-    // insert the word in the correct position of the subframe
-    std::memcpy(&d_subframe[position*GPS_WORD_LENGTH], &d_GPS_frame_4bytes, sizeof(char)*GPS_WORD_LENGTH);
-}
-
 void GpsL1CaSdSubframeFsm::clear_flag_new_subframe()
 {
     d_flag_new_subframe=false;
 }
 
-void GpsL1CaSdSubframeFsm::gps_sd_subframe_to_nav_msg()
+void GpsL1CaSdSubframeFsm::read_subframe_header()
+{
+    Gps_Subframe_Words words;
+    for (int i = 0; i < GPS_SUBFRAME_WORDS; i++)
+        {
+            words.words[i] = d_subframe[i] & 0x3FFFFFFF;
+        }
+    // the same values as Gps_Navigation_Message::subframe_decoder, which runs later
+    d_subframe_ID = words.subframe_id();
+    if (d_subframe_ID >= 1 && d_subframe_ID <= 5)
+        {
+            d_TOW = static_cast<double>(words.tow_count()) * 6 - 6;
+            if (d_subframe_ID == 1)
+                {
+                    i_GPS_week = words.week();
+                }
+            d_subframe_words = words;
+        }
+    else
+        {
+            d_subframe_words.clear();
+        }
+    d_flag_new_subframe = true;
+}
+
+
+Gps_Lnav_Subframe GpsL1CaSdSubframeFsm::subframe() const
 {
-    //int subframe_ID;
-    // NEW GPS SUBFRAME HAS ARRIVED!
-    d_subframe_ID = d_nav.subframe_decoder(this->d_subframe); //decode the subframe
-    d_nav.i_satellite_PRN = i_satellite_PRN;
-    d_nav.i_channel_ID = i_channel_ID;
-    d_nav.d_subframe_timestamp_ms = this->d_preamble_time_ms;
+    Gps_Lnav_Subframe subframe;
+    for (int i = 0; i < GPS_SUBFRAME_WORDS; i++)
+        {
+            subframe.words[i] = d_subframe[i];
+        }
+    subframe.preamble_time_ms = d_preamble_time_ms;
+    subframe.PRN = i_satellite_PRN;
+    subframe.channel = i_channel_ID;
+    subframe.uid = uid;
+    subframe.peak = i_peak;
+    return subframe;
+}
 
-    
-    if( d_subframe_ID < 1 || d_subframe_ID > 5)
-        return;
 
-    d_nav.i_peak = i_peak; 
-    d_nav.uid = uid; 
+int GpsL1CaSdSubframeFsm::decode(const Gps_Lnav_Subframe& subframe)
+{
+    // NEW GPS SUBFRAME HAS ARRIVED!
+    if (Spoofing_Replay_Writer* replay = spoofing_detector->replay_writer())
+        {
+            replay->write_subframe(reinterpret_cast<const char*>(subframe.words), subframe.PRN, subframe.channel, subframe.uid, subframe.peak, subframe.preamble_time_ms);
+        }
+    int subframe_ID = d_nav.subframe_decoder(subframe.words); //decode the subframe
+    d_nav.i_satellite_PRN = subframe.PRN;
+    d_nav.i_channel_ID = subframe.channel;
+    d_nav.d_subframe_timestamp_ms = subframe.preamble_time_ms;
+
+    if( subframe_ID < 1 || subframe_ID > 5)
+        return subframe_ID;
+
+    d_nav.i_peak = subframe.peak;
+    d_nav.uid = subframe.uid;
     std::cout << "NAV Message: received subframe "
-        << d_subframe_ID << " from satellite "
-        << Gnss_Satellite(std::string("GPS"), i_satellite_PRN) 
-        << " tow: " << d_nav.get_TOW() 
-        << " at time: " << this->d_preamble_time_ms
-        << " in channel: " << i_channel_ID 
-        << " id: "  << d_nav.uid << std::endl << std::endl; 
-        //<<  "subframe: " << d_nav.get_subframe(d_subframe_ID) << std::endl << std::endl;
-    spoofing_detector.New_subframe(d_subframe_ID, i_satellite_PRN, d_nav, this->d_preamble_time_ms);
-
-    if(  d_subframe_ID == 4 )
+        << subframe_ID << " from satellite "
+        << Gnss_Satellite(std::string("GPS"), subframe.PRN)
+        << " tow: " << d_nav.get_TOW()
+        << " at time: " << subframe.preamble_time_ms
+        << " in channel: " << subframe.channel
+        << " id: "  << d_nav.uid << std::endl << std::endl;
+    spoofing_detector->new_subframe(subframe_ID, subframe.PRN, d_nav, subframe.preamble_time_ms);
+
+    if(  subframe_ID == 4 )
     {
         if (d_nav.flag_iono_valid == true)
             {
                 Gps_Iono iono = d_nav.get_iono(); //notice that the read operation will clear the valid flag
-                spoofing_detector.check_external_iono(iono, this->d_preamble_time_ms); 
+                spoofing_detector->check_external_iono(iono, subframe.preamble_time_ms);
             }
         if (d_nav.flag_utc_model_valid == true)
             {
                 Gps_Utc_Model utc_model = d_nav.get_utc_model(); //notice that the read operation will clear the valid flag
-                spoofing_detector.check_external_utc(utc_model, this->d_preamble_time_ms); 
+                spoofing_detector->check_external_utc(utc_model, subframe.preamble_time_ms);
             }
     }
-    d_flag_new_subframe=true;
-
+    return subframe_ID;
 }
 
 void GpsL1CaSdSubframeFsm::Event_gps_word_valid()
 {
-    this->process_event(Ev_gps_word_valid());
+    switch (d_word_index)
+    {
+    case -1:
+    case GPS_SUBFRAME_WORDS:
+        // no subframe in progress
+        break;
+    case GPS_SUBFRAME_WORDS - 1:
+        d_subframe[d_word_index] = d_GPS_word;
+        d_word_index = GPS_SUBFRAME_WORDS;
+        read_subframe_header(); // the rest is decoded by decode()
+        break;
+    default:
+        d_subframe[d_word_index] = d_GPS_word;
+        d_word_index++;
+        break;
+    }
 }
 
 
 void GpsL1CaSdSubframeFsm::Event_gps_word_invalid()
 {
-    this->process_event(Ev_gps_word_invalid());
+    if (d_word_index < GPS_SUBFRAME_WORDS)
+        {
+            d_word_index = -1;
+        }
 }
 
 
 void GpsL1CaSdSubframeFsm::Event_gps_word_preamble()
 {
-    this->process_event(Ev_gps_word_preamble());
+    // a preamble in the middle of a subframe is part of its data
+    if (d_word_index == -1 || d_word_index == GPS_SUBFRAME_WORDS)
+        {
+            d_word_index = 0;
+        }
 }
 
+
+void GpsL1CaSdSubframeFsm::Event_gps_word(const Lnav_Word_Framer& framer)
+{
+    if (framer.parity_ok())
+        {
+            d_GPS_word = framer.word();
+            Event_gps_word_valid();
+        }
+    else
+        {
+            Event_gps_word_invalid();
+        }
+}
@@ -32,38 +32,44 @@
 #ifndef GNSS_SDR_GPS_L1_CA_SD_SUBFRAME_FSM_H_
 #define GNSS_SDR_GPS_L1_CA_SD_SUBFRAME_FSM_H_
 
-#include <boost/statechart/state_machine.hpp>
-#include "concurrent_queue.h"
 #include "GPS_L1_CA.h"
 #include "gps_navigation_message.h"
 #include "gps_ephemeris.h"
 #include "gps_iono.h"
 #include "gps_almanac.h"
 #include "gps_utc_model.h"
+#include "gps_subframe_words.h"
+#include "lnav_word_framer.h"
 #include "spoofing_detector.h"
 
-namespace sc = boost::statechart;
-namespace mpl = boost::mpl;
 
-struct gps_sd_subframe_fsm_S0;
-struct gps_sd_subframe_fsm_S1;
-struct gps_sd_subframe_fsm_S2;
-struct gps_sd_subframe_fsm_S3;
-struct gps_sd_subframe_fsm_S4;
-struct gps_sd_subframe_fsm_S5;
-struct gps_sd_subframe_fsm_S6;
-struct gps_sd_subframe_fsm_S7;
-struct gps_sd_subframe_fsm_S8;
-struct gps_sd_subframe_fsm_S9;
-struct gps_sd_subframe_fsm_S10;
-struct gps_sd_subframe_fsm_S11;
+/*!
+ * \brief A completed subframe, with the channel and time it was received in,
+ * as passed to GpsL1CaSdSubframeFsm::decode()
+ */
+struct Gps_Lnav_Subframe
+{
+    unsigned int words[GPS_SUBFRAME_WORDS]; //!< As extended by Lnav_Word_Framer
+    double preamble_time_ms;
+    unsigned int PRN;
+    int channel;
+    int uid;
+    unsigned int peak;
+};
 
 
 /*!
  * \brief This class implements a Finite State Machine that handles the decoding
- *  of the GPS L1 C/A NAV message
+ *  of the GPS L1 C/A NAV message, and passes the subframes to the spoofing
+ *  detector
+ *
+ * The words are assembled as in GpsL1CaSubframeFsm. Only the header of a
+ * completed subframe (ID, TOW and week) is read as it arrives, for the
+ * timing of the channel. The whole subframe is decoded by decode(), which
+ * may run in another thread (see Telemetry_Decode_Pool): from then on,
+ * d_nav belongs to that thread.
  */
-class GpsL1CaSdSubframeFsm : public sc::state_machine< GpsL1CaSdSubframeFsm, gps_sd_subframe_fsm_S0 >
+class GpsL1CaSdSubframeFsm
 {
 public:
     GpsL1CaSdSubframeFsm(); //!< The constructor starts the Finite State Machine
@@ -80,28 +86,42 @@ public:
     Gps_Utc_Model utc_model;  //!< Object that handles UTM model parameters
     Gps_Iono iono;            //!< Object that handles ionospheric parameters
 
-    char d_subframe[GPS_SUBFRAME_LENGTH];
-    int d_subframe_ID;
-    bool d_flag_new_subframe;
-    char d_GPS_frame_4bytes[GPS_WORD_LENGTH];
+    unsigned int d_subframe[GPS_SUBFRAME_WORDS]; //!< Words of the subframe, as extended by Lnav_Word_Framer
+    int d_subframe_ID;        //!< ID of the last completed subframe
+    bool d_flag_new_subframe; //!< A subframe has been completed, see subframe()
+    unsigned int d_GPS_word; //!< Last word, as extended by Lnav_Word_Framer
     double d_preamble_time_ms;
 
-    void gps_word_to_subframe(int position); //!< inserts the word in the correct position of the subframe
+    // header of the last subframes, as the TOW and week of d_nav, kept by the channel thread
+    double d_TOW;                         //!< Start time of the last subframe with a valid ID [s]
+    int i_GPS_week;                       //!< Week of the last subframe 1
+    Gps_Subframe_Words d_subframe_words;  //!< Last completed subframe, empty if its ID is not valid
 
     /*!
-     * \brief This function decodes a NAv message subframe and pushes the information to the right queues
+     * \brief The last completed subframe, to be passed to decode()
      */
-    void gps_sd_subframe_to_nav_msg();
+    Gps_Lnav_Subframe subframe() const;
+
+    /*!
+     * \brief Decodes a NAV message subframe into d_nav and passes it to the
+     * spoofing detector, returns its ID
+     */
+    int decode(const Gps_Lnav_Subframe& subframe);
 
     //FSM EVENTS
     void Event_gps_word_valid();    //!< FSM event: the received word is valid
     void Event_gps_word_invalid();  //!< FSM event: the received word is not valid
     void Event_gps_word_preamble(); //!< FSM event: word preamble detected
+    void Event_gps_word(const Lnav_Word_Framer& framer); //!< FSM event: the framer completed a word, valid or not
 
     //Spoofing detection
-    Spoofing_Detector spoofing_detector;
+    Spoofing_Detector* spoofing_detector; //!< Detector shared by all channels, kept alive by the telemetry decoder
     int uid = 0;
     unsigned int i_peak;  //!< which peak this channel is tracking 
+
+private:
+    void read_subframe_header();
+    int d_word_index; // of the next word, GPS_SUBFRAME_WORDS once complete, -1 before a preamble
 };
 
 #endif
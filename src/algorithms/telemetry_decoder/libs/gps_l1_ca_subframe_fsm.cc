@@ -29,208 +29,10 @@
  */
 
 #include "gps_l1_ca_subframe_fsm.h"
+#include <iostream>
 #include <string>
-#include <boost/statechart/simple_state.hpp>
-#include <boost/statechart/state.hpp>
-#include <boost/statechart/transition.hpp>
-#include <boost/statechart/custom_reaction.hpp>
-#include <boost/mpl/list.hpp>
 #include "gnss_satellite.h"
 
-//************ GPS WORD TO SUBFRAME DECODER STATE MACHINE **********
-
-struct Ev_gps_word_valid : sc::event<Ev_gps_word_valid> {};
-struct Ev_gps_word_invalid : sc::event<Ev_gps_word_invalid>{};
-struct Ev_gps_word_preamble : sc::event<Ev_gps_word_preamble>{};
-
-
-struct gps_subframe_fsm_S0: public sc::state<gps_subframe_fsm_S0, GpsL1CaSubframeFsm>
-{
-public:
-    // sc::transition(event,next_status)
-    typedef sc::transition< Ev_gps_word_preamble, gps_subframe_fsm_S1 > reactions;
-    gps_subframe_fsm_S0(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S0 "<<std::endl;
-    }
-};
-
-
-
-
-struct gps_subframe_fsm_S1: public sc::state<gps_subframe_fsm_S1, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S2 > > reactions;
-
-    gps_subframe_fsm_S1(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S1 "<<std::endl;
-    }
-};
-
-
-
-
-struct gps_subframe_fsm_S2: public sc::state<gps_subframe_fsm_S2, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S3 > > reactions;
-
-    gps_subframe_fsm_S2(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S2 "<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(0);
-    }
-};
-
-
-
-
-struct gps_subframe_fsm_S3: public sc::state<gps_subframe_fsm_S3, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S4 > > reactions;
-
-    gps_subframe_fsm_S3(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S3 "<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(1);
-    }
-};
-
-
-
-
-struct gps_subframe_fsm_S4: public sc::state<gps_subframe_fsm_S4, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S5 > > reactions;
-
-    gps_subframe_fsm_S4(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S4 "<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(2);
-    }
-};
-
-
-
-
-struct gps_subframe_fsm_S5: public sc::state<gps_subframe_fsm_S5, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S6 > > reactions;
-
-    gps_subframe_fsm_S5(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S5 "<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(3);
-    }
-};
-
-
-
-
-
-struct gps_subframe_fsm_S6: public sc::state<gps_subframe_fsm_S6, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S7 > > reactions;
-
-    gps_subframe_fsm_S6(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S6 "<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(4);
-    }
-};
-
-
-
-struct gps_subframe_fsm_S7: public sc::state<gps_subframe_fsm_S7, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S8 > > reactions;
-
-    gps_subframe_fsm_S7(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S7 "<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(5);
-    }
-};
-
-
-
-struct gps_subframe_fsm_S8: public sc::state<gps_subframe_fsm_S8, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S9 > > reactions;
-
-    gps_subframe_fsm_S8(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S8 "<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(6);
-    }
-};
-
-
-
-
-struct gps_subframe_fsm_S9: public sc::state<gps_subframe_fsm_S9, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S10 > > reactions;
-
-    gps_subframe_fsm_S9(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S9 "<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(7);
-    }
-};
-
-
-
-struct gps_subframe_fsm_S10: public sc::state<gps_subframe_fsm_S10, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S11 > > reactions;
-
-    gps_subframe_fsm_S10(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S10 "<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(8);
-    }
-};
-
-
-
-struct gps_subframe_fsm_S11: public sc::state<gps_subframe_fsm_S11, GpsL1CaSubframeFsm>
-{
-public:
-    typedef sc::transition< Ev_gps_word_preamble, gps_subframe_fsm_S1 > reactions;
-
-    gps_subframe_fsm_S11(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Completed GPS Subframe!"<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(9);
-        context< GpsL1CaSubframeFsm >().gps_subframe_to_nav_msg(); //decode the subframe
-        // DECODE SUBFRAME
-        //std::cout<<"Enter S11"<<std::endl;
-    }
-};
-
-
-
 
 GpsL1CaSubframeFsm::GpsL1CaSubframeFsm()
 {
@@ -240,17 +42,16 @@ GpsL1CaSubframeFsm::GpsL1CaSubframeFsm()
     d_preamble_time_ms = 0;
     d_subframe_ID=0;
     d_flag_new_subframe=false;
-    initiate(); //start the FSM
+    d_GPS_word = 0;
+    for (int i = 0; i < GPS_SUBFRAME_WORDS; i++)
+        {
+            d_subframe[i] = 0;
+        }
+    d_word_index = -1; // waits for a preamble
 }
 
 
 
-void GpsL1CaSubframeFsm::gps_word_to_subframe(int position)
-{
-    // insert the word in the correct position of the subframe
-    std::memcpy(&d_subframe[position*GPS_WORD_LENGTH], &d_GPS_frame_4bytes, sizeof(char)*GPS_WORD_LENGTH);
-}
-
 void GpsL1CaSubframeFsm::clear_flag_new_subframe()
 {
     d_flag_new_subframe=false;
@@ -272,20 +73,56 @@ void GpsL1CaSubframeFsm::gps_subframe_to_nav_msg()
 
 void GpsL1CaSubframeFsm::Event_gps_word_valid()
 {
-    this->process_event(Ev_gps_word_valid());
+    switch (d_word_index)
+    {
+    case -1:
+    case GPS_SUBFRAME_WORDS:
+        // no subframe in progress
+        break;
+    case GPS_SUBFRAME_WORDS - 1:
+        d_subframe[d_word_index] = d_GPS_word;
+        d_word_index = GPS_SUBFRAME_WORDS;
+        gps_subframe_to_nav_msg(); //decode the subframe
+        break;
+    default:
+        d_subframe[d_word_index] = d_GPS_word;
+        d_word_index++;
+        break;
+    }
 }
 
 
 
 void GpsL1CaSubframeFsm::Event_gps_word_invalid()
 {
-    this->process_event(Ev_gps_word_invalid());
+    if (d_word_index < GPS_SUBFRAME_WORDS)
+        {
+            d_word_index = -1;
+        }
 }
 
 
 
 void GpsL1CaSubframeFsm::Event_gps_word_preamble()
 {
-    this->process_event(Ev_gps_word_preamble());
+    // a preamble in the middle of a subframe is part of its data
+    if (d_word_index == -1 || d_word_index == GPS_SUBFRAME_WORDS)
+        {
+            d_word_index = 0;
+        }
 }
 
+
+
+void GpsL1CaSubframeFsm::Event_gps_word(const Lnav_Word_Framer& framer)
+{
+    if (framer.parity_ok())
+        {
+            d_GPS_word = framer.word();
+            Event_gps_word_valid();
+        }
+    else
+        {
+            Event_gps_word_invalid();
+        }
+}
@@ -32,37 +32,26 @@
 #ifndef GNSS_SDR_GPS_L1_CA_SUBFRAME_FSM_H_
 #define GNSS_SDR_GPS_L1_CA_SUBFRAME_FSM_H_
 
-#include <boost/statechart/state_machine.hpp>
-#include "concurrent_queue.h"
 #include "GPS_L1_CA.h"
 #include "gps_navigation_message.h"
 #include "gps_ephemeris.h"
 #include "gps_iono.h"
 #include "gps_almanac.h"
 #include "gps_utc_model.h"
-
-namespace sc = boost::statechart;
-namespace mpl = boost::mpl;
-
-struct gps_subframe_fsm_S0;
-struct gps_subframe_fsm_S1;
-struct gps_subframe_fsm_S2;
-struct gps_subframe_fsm_S3;
-struct gps_subframe_fsm_S4;
-struct gps_subframe_fsm_S5;
-struct gps_subframe_fsm_S6;
-struct gps_subframe_fsm_S7;
-struct gps_subframe_fsm_S8;
-struct gps_subframe_fsm_S9;
-struct gps_subframe_fsm_S10;
-struct gps_subframe_fsm_S11;
+#include "lnav_word_framer.h"
 
 
 /*!
  * \brief This class implements a Finite State Machine that handles the decoding
  *  of the GPS L1 C/A NAV message
+ *
+ * The state is the index of the next word of the subframe: a preamble
+ * starts a subframe, each valid word goes into the slot of its index, an
+ * invalid word drops the subframe and the tenth word has it decoded. The
+ * words go straight from the framer into a fixed buffer, so assembling a
+ * subframe allocates nothing.
  */
-class GpsL1CaSubframeFsm : public sc::state_machine< GpsL1CaSubframeFsm, gps_subframe_fsm_S0 >
+class GpsL1CaSubframeFsm
 {
 public:
     GpsL1CaSubframeFsm(); //!< The constructor starts the Finite State Machine
@@ -79,14 +68,12 @@ public:
     Gps_Utc_Model utc_model;  //!< Object that handles UTM model parameters
     Gps_Iono iono;            //!< Object that handles ionospheric parameters
 
-    char d_subframe[GPS_SUBFRAME_LENGTH];
+    unsigned int d_subframe[GPS_SUBFRAME_WORDS]; //!< Words of the subframe, as extended by Lnav_Word_Framer
     int d_subframe_ID;
     bool d_flag_new_subframe;
-    char d_GPS_frame_4bytes[GPS_WORD_LENGTH];
+    unsigned int d_GPS_word; //!< Last word, as extended by Lnav_Word_Framer
     double d_preamble_time_ms;
 
-    void gps_word_to_subframe(int position); //!< inserts the word in the correct position of the subframe
-
     /*!
      * \brief This function decodes a NAv message subframe and pushes the information to the right queues
      */
@@ -96,6 +83,10 @@ public:
     void Event_gps_word_valid();    //!< FSM event: the received word is valid
     void Event_gps_word_invalid();  //!< FSM event: the received word is not valid
     void Event_gps_word_preamble(); //!< FSM event: word preamble detected
+    void Event_gps_word(const Lnav_Word_Framer& framer); //!< FSM event: the framer completed a word, valid or not
+
+private:
+    int d_word_index; // of the next word, GPS_SUBFRAME_WORDS once complete, -1 before a preamble
 };
 
 #endif
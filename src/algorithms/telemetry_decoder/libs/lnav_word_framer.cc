@@ -0,0 +1,132 @@
+/*!
+ * \file lnav_word_framer.cc
+ * \brief Bit synchronization, word assembly and parity check of the GPS
+ * L1 C/A navigation message (LNAV)
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "lnav_word_framer.h"
+
+namespace
+{
+// Bit 31 is D29 and bit 30 is D30 of the previous word, bits 29 to 6 are d1
+// to d24 and bits 5 to 0 are D25 to D30. Each mask selects the bits of a
+// parity equation of IS-GPS-200 Table 20-XIV, the parity bit included, so
+// the word passes when all of them select an even number of ones.
+const unsigned int parity_masks[6] = {
+        0xBB1F34A0, // D25
+        0x5D8F9A50, // D26
+        0xAEC7CD08, // D27
+        0x5763E684, // D28
+        0x6BB1F342, // D29
+        0x8B7A89C1  // D30
+};
+
+const unsigned int word_bits = 0x3FFFFFFF;
+const unsigned int data_bits = 0x3FFFFFC0;
+const int bit_ms = 20;
+}
+
+
+Lnav_Word_Framer::Lnav_Word_Framer()
+{
+    reset();
+}
+
+
+bool Lnav_Word_Framer::push_symbol(const Gnss_Synchro& symbol)
+{
+    if (symbol.Flag_valid_symbol_output)
+        {
+            // with extended correlation in tracking a symbol spans several ms
+            d_symbol_accumulator += symbol.Prompt_I;
+            d_symbol_accumulator_ms += symbol.correlation_length_ms;
+        }
+    if (d_symbol_accumulator_ms < bit_ms)
+        {
+            return false;
+        }
+    bool bit = d_symbol_accumulator > 0;
+    d_symbol_accumulator = 0.0;
+    d_symbol_accumulator_ms = 0;
+    return push_bit(bit);
+}
+
+
+bool Lnav_Word_Framer::push_bit(bool bit)
+{
+    d_bits = (d_bits << 1) | (bit ? 1 : 0);
+    if (++d_bit_count < 30)
+        {
+            return false;
+        }
+    d_word = restore_polarity(d_bits & word_bits, d_word);
+    d_parity_ok = parity_check(d_word);
+    d_bits = 0;
+    d_bit_count = 0;
+    return true;
+}
+
+
+void Lnav_Word_Framer::sync_bits()
+{
+    d_symbol_accumulator = 0.0;
+    d_symbol_accumulator_ms = 0;
+    d_bits = 0;
+    d_bit_count = 0;
+}
+
+
+void Lnav_Word_Framer::reset()
+{
+    sync_bits();
+    d_word = 0;
+    d_parity_ok = false;
+}
+
+
+unsigned int Lnav_Word_Framer::restore_polarity(unsigned int raw_word, unsigned int previous_word)
+{
+    unsigned int word = (raw_word & word_bits) | (previous_word << 30);
+    if (word & 0x40000000)
+        {
+            word ^= data_bits;
+        }
+    return word;
+}
+
+
+bool Lnav_Word_Framer::parity_check(unsigned int word)
+{
+    unsigned int failed = 0;
+    for (int i = 0; i < 6; i++)
+        {
+            failed |= __builtin_popcount(word & parity_masks[i]) & 1;
+        }
+    return failed == 0;
+}
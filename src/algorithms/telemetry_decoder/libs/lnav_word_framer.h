@@ -0,0 +1,99 @@
+/*!
+ * \file lnav_word_framer.h
+ * \brief Bit synchronization, word assembly and parity check of the GPS
+ * L1 C/A navigation message (LNAV)
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_LNAV_WORD_FRAMER_H_
+#define GNSS_SDR_LNAV_WORD_FRAMER_H_
+
+#include "gnss_synchro.h"
+
+/*!
+ * \brief Turns the prompt symbols of a GPS L1 C/A channel into the 30-bit
+ * words of the navigation message.
+ *
+ * The symbols are integrated over 20 ms into bits, which are shifted into
+ * the word in progress. Once it holds 30 bits, the word is handled at
+ * once: the D29 and D30 bits of the previous word are put on top of it,
+ * its data bits are inverted if D30 was set (IS-GPS-200, 20.3.5.2), and
+ * each of its six parity equations is the parity of the popcount of the
+ * word and a precomputed mask.
+ */
+class Lnav_Word_Framer
+{
+public:
+    Lnav_Word_Framer();
+
+    /*!
+     * \brief Integrates a symbol, true when it completes a word
+     */
+    bool push_symbol(const Gnss_Synchro& symbol);
+
+    /*!
+     * \brief Appends a bit, true when it completes a word
+     */
+    bool push_bit(bool bit);
+
+    /*!
+     * \brief The next symbol starts a bit, and the next bit a word (at a preamble)
+     */
+    void sync_bits();
+
+    void reset(); //!< Also forgets the previous word
+
+    /*!
+     * \brief The last word: D29 and D30 of the previous word in bits 31
+     * and 30, the 24 data bits with their polarity restored in bits 29 to 6
+     * and the parity bits in bits 5 to 0
+     */
+    unsigned int word() const { return d_word; }
+    bool parity_ok() const { return d_parity_ok; }
+
+    /*!
+     * \brief Extended word of the 30 received bits of raw_word, given the
+     * previous extended word
+     */
+    static unsigned int restore_polarity(unsigned int raw_word, unsigned int previous_word);
+
+    /*!
+     * \brief true if the six parity bits of the extended word match its data
+     */
+    static bool parity_check(unsigned int word);
+
+private:
+    double d_symbol_accumulator;
+    int d_symbol_accumulator_ms;
+    unsigned int d_bits;      // of the word in progress, the newest in bit 0
+    unsigned int d_bit_count; // in d_bits
+    unsigned int d_word;
+    bool d_parity_ok;
+};
+
+#endif
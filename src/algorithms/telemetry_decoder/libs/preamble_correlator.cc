@@ -0,0 +1,151 @@
+/*!
+ * \file preamble_correlator.cc
+ * \brief Sliding correlation of the navigation symbols with a preamble,
+ * on a bit-packed symbol history
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "preamble_correlator.h"
+
+namespace
+{
+void shift_in(std::vector<unsigned long long>& words, bool bit, unsigned long long top_word_mask)
+{
+    unsigned long long carry = bit ? 1ULL : 0ULL;
+    for (unsigned int w = 0; w < words.size(); w++)
+        {
+            unsigned long long out = words[w] >> 63;
+            words[w] = (words[w] << 1) | carry;
+            carry = out;
+        }
+    words.back() &= top_word_mask;
+}
+}
+
+
+Preamble_Correlator::Preamble_Correlator(const int* preamble_symbols, unsigned int length) :
+        d_preamble_symbols(preamble_symbols, preamble_symbols + length),
+        d_length(length)
+{
+    unsigned int n_words = (length + 63) / 64;
+    d_preamble_bits.assign(n_words, 0);
+    d_sign_bits.assign(n_words, 0);
+    d_regular_bits.assign(n_words, 0);
+    unsigned int top_bits = length - 64 * (n_words - 1);
+    d_top_word_mask = top_bits == 64 ? ~0ULL : (1ULL << top_bits) - 1;
+    for (unsigned int i = 0; i < length; i++)
+        {
+            // in[0] is the oldest symbol of the window
+            unsigned int k = length - 1 - i;
+            if (preamble_symbols[i] > 0)
+                {
+                    d_preamble_bits[k / 64] |= 1ULL << (k % 64);
+                }
+        }
+    clear();
+}
+
+
+void Preamble_Correlator::clear()
+{
+    d_sign_bits.assign(d_sign_bits.size(), 0);
+    d_regular_bits.assign(d_regular_bits.size(), 0);
+    d_symbols = 0;
+    d_newest_timestamp_secs = 0.0;
+}
+
+
+void Preamble_Correlator::push(const Gnss_Synchro& symbol)
+{
+    bool regular = symbol.Flag_valid_symbol_output == true and symbol.correlation_length_ms == 1;
+    shift_in(d_sign_bits, !(symbol.Prompt_I < 0), d_top_word_mask);
+    shift_in(d_regular_bits, regular, d_top_word_mask);
+    if (d_symbols < d_length)
+        {
+            d_symbols++;
+        }
+    d_newest_timestamp_secs = symbol.Tracking_timestamp_secs;
+}
+
+
+int Preamble_Correlator::correlate(const Gnss_Synchro* in)
+{
+    if (d_length == 0)
+        {
+            return 0;
+        }
+    if (d_length > 1 and d_symbols == d_length and in[d_length - 2].Tracking_timestamp_secs == d_newest_timestamp_secs)
+        {
+            // the window moved by one symbol
+            push(in[d_length - 1]);
+        }
+    else
+        {
+            clear();
+            for (unsigned int i = 0; i < d_length; i++)
+                {
+                    push(in[i]);
+                }
+        }
+
+    bool regular = true;
+    int mismatches = 0;
+    for (unsigned int w = 0; w < d_regular_bits.size(); w++)
+        {
+            unsigned long long all = (w + 1 == d_regular_bits.size()) ? d_top_word_mask : ~0ULL;
+            regular = regular and d_regular_bits[w] == all;
+            mismatches += __builtin_popcountll(d_sign_bits[w] ^ d_preamble_bits[w]);
+        }
+    if (regular)
+        {
+            return static_cast<int>(d_length) - 2 * mismatches;
+        }
+    return correlate_weighted(in);
+}
+
+
+int Preamble_Correlator::correlate_weighted(const Gnss_Synchro* in) const
+{
+    int corr_value = 0;
+    for (unsigned int i = 0; i < d_length; i++)
+        {
+            if (in[i].Flag_valid_symbol_output == true)
+                {
+                    if (in[i].Prompt_I < 0)  // symbols clipping
+                        {
+                            corr_value -= d_preamble_symbols[i] * in[i].correlation_length_ms;
+                        }
+                    else
+                        {
+                            corr_value += d_preamble_symbols[i] * in[i].correlation_length_ms;
+                        }
+                }
+            if (corr_value >= static_cast<int>(d_length)) break;
+        }
+    return corr_value;
+}
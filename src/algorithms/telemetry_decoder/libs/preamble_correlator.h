@@ -0,0 +1,85 @@
+/*!
+ * \file preamble_correlator.h
+ * \brief Sliding correlation of the navigation symbols with a preamble,
+ * on a bit-packed symbol history
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_PREAMBLE_CORRELATOR_H_
+#define GNSS_SDR_PREAMBLE_CORRELATOR_H_
+
+#include <vector>
+#include "gnss_synchro.h"
+
+/*!
+ * \brief Correlates the last symbols of a telemetry decoder input with a preamble.
+ *
+ * The signs of the symbols in the window are kept in a bit-packed history.
+ * When the window moves by one symbol between calls, as it does when
+ * the decoder consumes one symbol per general_work, only the new symbol is
+ * pushed. The correlation of a window of valid 1 ms symbols is then a
+ * popcount of a few words instead of a loop over the whole preamble. Windows
+ * holding symbols of other correlation lengths, or invalid symbols, are
+ * correlated with the weighted loop the decoders always used.
+ */
+class Preamble_Correlator
+{
+public:
+    /*!
+     * \param preamble_symbols - the preamble sampled at the symbol rate, +1 or -1
+     */
+    Preamble_Correlator(const int* preamble_symbols, unsigned int length);
+
+    /*!
+     * \brief Correlation of in[0 .. length - 1] with the preamble, each
+     * symbol weighted by its correlation_length_ms. The sum stops as soon as
+     * it reaches length.
+     */
+    int correlate(const Gnss_Synchro* in);
+
+    /*!
+     * \brief Forgets the history, the next window is read in full
+     */
+    void clear();
+
+private:
+    void push(const Gnss_Synchro& symbol);
+    int correlate_weighted(const Gnss_Synchro* in) const;
+
+    std::vector<int> d_preamble_symbols;
+    unsigned int d_length;
+    // bit k is the symbol k positions before the newest one
+    std::vector<unsigned long long> d_preamble_bits;
+    std::vector<unsigned long long> d_sign_bits;    // Prompt_I >= 0
+    std::vector<unsigned long long> d_regular_bits; // valid 1 ms symbol
+    unsigned long long d_top_word_mask;
+    unsigned int d_symbols;
+    double d_newest_timestamp_secs;
+};
+
+#endif
@@ -0,0 +1,156 @@
+/*!
+ * \file telemetry_decode_pool.cc
+ * \brief Implementation of the receiver-wide pool of threads that decode the
+ * navigation message subframes of the telemetry decoders
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "telemetry_decode_pool.h"
+#include <boost/bind.hpp>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+namespace
+{
+boost::mutex num_threads_mutex;
+bool num_threads_set = false;
+unsigned int pool_num_threads = 0;
+
+// jobs queued per lane, a few subframes of every channel of the lane
+const size_t LANE_CAPACITY = 1024;
+}
+
+
+Telemetry_Decode_Pool& Telemetry_Decode_Pool::instance()
+{
+    static Telemetry_Decode_Pool pool(num_threads_set ? pool_num_threads : default_num_threads());
+    return pool;
+}
+
+
+void Telemetry_Decode_Pool::set_num_threads(unsigned int num_threads)
+{
+    boost::mutex::scoped_lock lock(num_threads_mutex);
+    num_threads_set = true;
+    pool_num_threads = num_threads;
+}
+
+
+unsigned int Telemetry_Decode_Pool::default_num_threads()
+{
+    return boost::thread::hardware_concurrency() / 8;
+}
+
+
+Telemetry_Decode_Pool::Telemetry_Decode_Pool(unsigned int num_threads) :
+        d_num_threads(num_threads),
+        d_next_lane(0),
+        d_stop(false)
+{
+    for (unsigned int i = 0; i < d_num_threads; i++)
+        {
+            d_lanes.push_back(std::unique_ptr<concurrent_mpsc_queue<Job> >(new concurrent_mpsc_queue<Job>(LANE_CAPACITY)));
+        }
+    for (unsigned int i = 0; i < d_num_threads; i++)
+        {
+            d_threads.create_thread(boost::bind(&Telemetry_Decode_Pool::run, this, i));
+        }
+    LOG(INFO) << "Telemetry decode pool started with " << d_num_threads << " threads";
+}
+
+
+Telemetry_Decode_Pool::~Telemetry_Decode_Pool()
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_stop = true;
+    }
+    d_threads.join_all();
+}
+
+
+unsigned int Telemetry_Decode_Pool::lane()
+{
+    if (d_num_threads == 0)
+        {
+            return 0;
+        }
+    boost::mutex::scoped_lock lock(d_mutex);
+    unsigned int lane = d_next_lane;
+    d_next_lane = (d_next_lane + 1) % d_num_threads;
+    return lane;
+}
+
+
+void Telemetry_Decode_Pool::submit(unsigned int lane, const Job& job)
+{
+    if (d_num_threads == 0)
+        {
+            job();
+            return;
+        }
+    concurrent_mpsc_queue<Job>& jobs = *d_lanes[lane % d_num_threads];
+    // a subframe lost here would be missed by the spoofing checks, the channel waits instead
+    while (!jobs.push(job))
+        {
+            boost::this_thread::yield();
+        }
+}
+
+
+void Telemetry_Decode_Pool::run(unsigned int lane)
+{
+    concurrent_mpsc_queue<Job>& jobs = *d_lanes[lane];
+    std::vector<Job> batch;
+    while (true)
+        {
+            bool stop;
+            {
+                boost::mutex::scoped_lock lock(d_mutex);
+                stop = d_stop;
+            }
+            batch.clear();
+            if (stop)
+                {
+                    // last pass, do not wait
+                    jobs.pop_all(batch);
+                }
+            else
+                {
+                    jobs.wait_and_pop_all(batch, boost::posix_time::milliseconds(100));
+                }
+            for (std::vector<Job>::iterator it = batch.begin(); it != batch.end(); ++it)
+                {
+                    (*it)();
+                }
+            if (stop)
+                {
+                    return;
+                }
+        }
+}
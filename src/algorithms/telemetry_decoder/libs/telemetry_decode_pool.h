@@ -0,0 +1,103 @@
+/*!
+ * \file telemetry_decode_pool.h
+ * \brief Interface of the receiver-wide pool of threads that decode the
+ * navigation message subframes of the telemetry decoders
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_TELEMETRY_DECODE_POOL_H_
+#define GNSS_SDR_TELEMETRY_DECODE_POOL_H_
+
+#include <memory>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include "concurrent_ring_queue.h"
+
+/*!
+ * \brief Receiver-wide pool of threads for the subframe decoding of the
+ * telemetry decoders.
+ *
+ * The channel threads keep the symbol accumulation and the preamble
+ * synchronization, and submit each completed subframe to be decoded (and
+ * checked by the spoofing detector) by a pool thread. Each decoder takes
+ * a lane, served by one pool thread through a lock-free queue, so that its
+ * jobs run in the order they were submitted, while the decoders of the
+ * other channels share the remaining threads.
+ *
+ * The number of threads is set once, with set_num_threads(), before the
+ * first use (GNSS-SDR.telemetry_threads, see GNSSFlowgraph). With no
+ * threads the jobs run in the submitting thread, as before.
+ */
+class Telemetry_Decode_Pool
+{
+public:
+    typedef boost::function<void()> Job;
+
+    static Telemetry_Decode_Pool& instance();
+
+    /*!
+     * \brief Sets the number of pool threads. No effect once the pool is running.
+     */
+    static void set_num_threads(unsigned int num_threads);
+
+    static unsigned int default_num_threads(); //!< An eighth of the hardware threads
+
+    /*!
+     * \brief Lane for the jobs of a new decoder, taken in turns
+     */
+    unsigned int lane();
+
+    /*!
+     * \brief Runs job in the thread of the lane, after the jobs submitted
+     * before to the same lane, or in the calling thread if the pool has no threads
+     *
+     * It waits, instead of dropping the job, if the lane is full.
+     */
+    void submit(unsigned int lane, const Job& job);
+
+    unsigned int num_threads() const { return d_num_threads; }
+
+    ~Telemetry_Decode_Pool();
+
+private:
+    explicit Telemetry_Decode_Pool(unsigned int num_threads);
+    Telemetry_Decode_Pool(const Telemetry_Decode_Pool&);
+    Telemetry_Decode_Pool& operator=(const Telemetry_Decode_Pool&);
+
+    void run(unsigned int lane);
+
+    unsigned int d_num_threads;
+    std::vector<std::unique_ptr<concurrent_mpsc_queue<Job> > > d_lanes;
+    unsigned int d_next_lane;
+    bool d_stop;
+    boost::mutex d_mutex;
+    boost::thread_group d_threads;
+};
+
+#endif
@@ -30,8 +30,13 @@
  */
 
 #include "viterbi_decoder.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <glog/logging.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 // logging
 #define EVENT 2    // logs important events which don't occur every block
@@ -43,6 +48,11 @@
 
 const float MAXLOG = 1e7;  /* Define infinity */
 
+// decisions of the survivor ring
+const unsigned char FROM_EVEN_STATE = 0;
+const unsigned char FROM_ODD_STATE = 1;
+const unsigned char NO_SURVIVOR = 2; // both branches below -MAXLOG
+
 Viterbi_Decoder::Viterbi_Decoder(const int g_encoder[], const int KK, const int nn)
 {
     d_nn = nn; // Coding rate 1/n
@@ -62,8 +72,35 @@ Viterbi_Decoder::Viterbi_Decoder(const int g_encoder[], const int KK, const int
     nsc_transit(d_out0, d_state0, 0, g_encoder, d_KK, d_nn);
     nsc_transit(d_out1, d_state1, 1, g_encoder, d_KK, d_nn);
 
+    /* state ns is reached from states 2j and 2j+1, j = ns mod 2^(mm-1), with the info bit ns >> (mm-1) */
+    d_sign_even_r0.resize(d_states);
+    d_sign_even_r1.resize(d_states);
+    d_sign_odd_r0.resize(d_states);
+    d_sign_odd_r1.resize(d_states);
+    for (int ns = 0; ns < d_states; ns++)
+        {
+            int half = ns & ((d_states >> 1) - 1);
+            const int* out = (ns >> (d_mm - 1)) ? d_out1 : d_out0;
+            int sym_even = d_mm > 0 ? out[2 * half] : 0;
+            int sym_odd = d_mm > 0 ? out[2 * half + 1] : 0;
+            // as in gamma(): bit 0 of the symbol multiplies the last received value
+            d_sign_even_r1[ns] = (sym_even & 1) ? 1.0 : -1.0;
+            d_sign_even_r0[ns] = (sym_even & 2) ? 1.0 : -1.0;
+            d_sign_odd_r1[ns] = (sym_odd & 1) ? 1.0 : -1.0;
+            d_sign_odd_r0[ns] = (sym_odd & 2) ? 1.0 : -1.0;
+        }
+
+    d_pm_t.resize(d_states);
+    d_pm_t_next.resize(d_states);
+    d_pm_even.resize(std::max(d_states / 2, 1));
+    d_pm_odd.resize(std::max(d_states / 2, 1));
+    d_rec_array = new float[d_nn];
+    d_metric_c = new float[d_number_symbols];
+    d_capacity = 0;
+    d_newest = 0;
+    d_size = 0;
+
     // initialise trellis state
-    d_trellis_state_is_initialised = false;
     Viterbi_Decoder::init_trellis_state();
 }
 
@@ -76,8 +113,7 @@ Viterbi_Decoder::~Viterbi_Decoder()
     delete[] d_state0;
     delete[] d_state1;
 
-    // init trellis state
-    delete[] d_pm_t;
+    // trellis state
     delete[] d_rec_array;
     delete[] d_metric_c;
 }
@@ -101,6 +137,19 @@ void Viterbi_Decoder::reset()
  output_u_int[]    Hard decisions on the data bits (without the mm zero-tail-bits)
  */
 float Viterbi_Decoder::decode_block(const double input_c[], int output_u_int[], const int LL)
+{
+    return do_decode_block(input_c, output_u_int, LL);
+}
+
+
+float Viterbi_Decoder::decode_block(const float input_c[], int output_u_int[], const int LL)
+{
+    return do_decode_block(input_c, output_u_int, LL);
+}
+
+
+template<typename T>
+float Viterbi_Decoder::do_decode_block(const T input_c[], int output_u_int[], const int LL)
 {
     int state;
     int decoding_length_mismatch;
@@ -153,27 +202,14 @@ float Viterbi_Decoder::decode_continuous(const double sym[],
 void Viterbi_Decoder::init_trellis_state()
 {
     int state;
-    // if trellis state has been initialised, free old state memory
-    if(d_trellis_state_is_initialised)
-        {
-            // init trellis state
-            delete[] d_pm_t;
-            delete[] d_rec_array;
-            delete[] d_metric_c;
-        }
-
-    // reserve new trellis state memory
-    d_pm_t = new float[d_states];
-    d_trellis_paths = std::deque<Prev>();
-    d_rec_array = new float[d_nn];
-    d_metric_c = new float[d_number_symbols];
-    d_trellis_state_is_initialised = true;
+    // the survivor memory is kept, only the sections are dropped
+    d_size = 0;
+    d_newest = 0;
 
     /* initialize trellis */
     for (state = 0; state < d_states; state++)
         {
             d_pm_t[state] = -MAXLOG;
-            //d_pm_t_next[state] = -MAXLOG;
         }
     d_pm_t[0] = 0; /* start in all-zeros state */
 
@@ -182,25 +218,84 @@ void Viterbi_Decoder::init_trellis_state()
 
 
 
+void Viterbi_Decoder::reserve_sections(int sections)
+{
+    if (sections <= d_capacity)
+        {
+            return;
+        }
+    int capacity = std::max(sections, 2 * d_capacity);
+    std::vector<unsigned char> decisions(static_cast<size_t>(capacity) * d_states);
+    std::vector<float> branch_metrics(static_cast<size_t>(capacity) * d_states);
+    std::vector<int> section_t(capacity);
+    // unroll the ring: the oldest section goes to slot 0 and the newest to slot d_size - 1
+    for (int k = 0; k < d_size; k++)
+        {
+            int from = section_slot(k);
+            int to = d_size - 1 - k;
+            std::copy(d_decisions.begin() + from * d_states, d_decisions.begin() + (from + 1) * d_states, decisions.begin() + to * d_states);
+            std::copy(d_branch_metrics.begin() + from * d_states, d_branch_metrics.begin() + (from + 1) * d_states, branch_metrics.begin() + to * d_states);
+            section_t[to] = d_section_t[from];
+        }
+    d_decisions.swap(decisions);
+    d_branch_metrics.swap(branch_metrics);
+    d_section_t.swap(section_t);
+    d_capacity = capacity;
+    d_newest = d_size > 0 ? d_size - 1 : capacity - 1;
+}
+
+
+int Viterbi_Decoder::section_slot(int k) const
+{
+    int slot = d_newest - k;
+    return slot < 0 ? slot + d_capacity : slot;
+}
+
+
+int Viterbi_Decoder::get_ancestor_state(int k, int state) const
+{
+    unsigned char decision = d_decisions[section_slot(k) * d_states + state];
+    if (decision == NO_SURVIVOR)
+        {
+            return 0;
+        }
+    return ((state << 1) & (d_states - 1)) | decision;
+}
 
-int Viterbi_Decoder::do_acs(const double sym[], int nbits)
+
+int Viterbi_Decoder::get_bit(int k, int state) const
+{
+    if (d_decisions[section_slot(k) * d_states + state] == NO_SURVIVOR)
+        {
+            return 0;
+        }
+    return state >> (d_mm - 1);
+}
+
+
+float Viterbi_Decoder::get_branch_metric(int k, int state) const
+{
+    return d_branch_metrics[section_slot(k) * d_states + state];
+}
+
+
+
+
+template<typename T>
+int Viterbi_Decoder::do_acs(const T sym[], int nbits)
 {
     int t, i, state_at_t;
-    float metric;
     float max_val;
-    float * pm_t_next = new float[d_states];
+    float* pm_t_next = &d_pm_t_next[0];
 
     /* t:
      *    - state: state at t
-     *    - d_prev_section[state_at_t]: path metric at t for state state_at_t
+     *    - d_pm_t[state_at_t]: path metric at t for state state_at_t
      *    - d_out0[state_at_t]: sent symbols for a data bit 0 if state is state_at_t at time t
      *
      */
-
-    for (state_at_t = 0; state_at_t < d_states; state_at_t++)
-        {
-            pm_t_next[state_at_t] = -MAXLOG;
-        }
+    reserve_sections(d_size + nbits);
+    bool rate_half = d_nn == 2 && d_states >= 8;
 
     /* go through trellis */
     for (t = 0; t < nbits; t++)
@@ -209,54 +304,38 @@ int Viterbi_Decoder::do_acs(const double sym[], int nbits)
             for (i = 0; i < d_nn; i++)
                 d_rec_array[i] = static_cast<float>(sym[d_nn * t + i]);
 
-            /* precompute all possible branch metrics */
-            for (i = 0; i < d_number_symbols; i++)
+            // find the survivor branches leading the trellis states at t+1
+            d_newest = d_newest + 1 == d_capacity ? 0 : d_newest + 1;
+            d_size++;
+            d_section_t[d_newest] = t + 1;
+            unsigned char* decisions = &d_decisions[d_newest * d_states];
+            float* branch_metrics = &d_branch_metrics[d_newest * d_states];
+            if (rate_half)
                 {
-                    d_metric_c[i] = gamma(d_rec_array, i, d_nn);
-                    VLOG(LMORE) << "metric for (tx_sym=" << i << "|ry_sym=(" << d_rec_array[0] << ", " << d_rec_array[1] << ") = " << d_metric_c[i];
+                    acs_rate_half(pm_t_next, decisions, branch_metrics);
                 }
-
-            // find the survivor branches leading the trellis states at t+1
-            Prev next_trellis_states(d_states, t+1);
-            /* step through all states */
-            for (state_at_t = 0; state_at_t < d_states; state_at_t++)
+            else
                 {
-                    int next_state_if_0 = d_state0[state_at_t];
-                    int next_state_if_1 = d_state1[state_at_t];
-
-                    /* hypothesis: info bit is a zero */
-                    int bm_0 = d_metric_c[d_out0[state_at_t]];
-                    metric = d_pm_t[state_at_t] + bm_0; // path metric + zerobranch metric
-
-                    /* store new metric if more than metric in storage */
-                    if (metric > pm_t_next[next_state_if_0])
-                        {
-                            pm_t_next[next_state_if_0] = metric;
-                            next_trellis_states.set_current_state_as_ancestor_of_next_state(next_state_if_0, state_at_t);
-                            next_trellis_states.set_decoded_bit_for_next_state(next_state_if_0, 0);
-                            next_trellis_states.set_survivor_branch_metric_of_next_state(next_state_if_0, bm_0);
-                        }
-
-                    /* hypothesis: info bit is a one */
-                    int bm_1 = d_metric_c[d_out1[state_at_t]];
-                    metric = d_pm_t[state_at_t] + bm_1; // path metric + onebranch metric
-
-                    /* store new metric if more than metric in storage */
-                    if (metric > pm_t_next[next_state_if_1])
-                        {
-                            pm_t_next[next_state_if_1] = metric;
-                            next_trellis_states.set_current_state_as_ancestor_of_next_state(next_state_if_1, state_at_t);
-                            next_trellis_states.set_decoded_bit_for_next_state(next_state_if_1, 1);
-                            next_trellis_states.set_survivor_branch_metric_of_next_state(next_state_if_1, bm_1);
-                        }
+                    acs_scalar(pm_t_next, decisions, branch_metrics);
                 }
 
-            d_trellis_paths.push_front(next_trellis_states);
-
             /* normalize -> afterwards, the largest metric value is always 0 */
-            //max_val = 0;
             max_val = -MAXLOG;
-            for (state_at_t = 0; state_at_t < d_states; state_at_t++)
+            state_at_t = 0;
+#ifdef __SSE2__
+            if (rate_half)
+                {
+                    __m128 max4 = _mm_set1_ps(-MAXLOG);
+                    for (; state_at_t < d_states; state_at_t += 4)
+                        {
+                            max4 = _mm_max_ps(max4, _mm_loadu_ps(pm_t_next + state_at_t));
+                        }
+                    max4 = _mm_max_ps(max4, _mm_shuffle_ps(max4, max4, _MM_SHUFFLE(1, 0, 3, 2)));
+                    max4 = _mm_max_ps(max4, _mm_shuffle_ps(max4, max4, _MM_SHUFFLE(2, 3, 0, 1)));
+                    max_val = _mm_cvtss_f32(max4);
+                }
+#endif
+            for (; state_at_t < d_states; state_at_t++)
                 {
                     if (pm_t_next[state_at_t] > max_val)
                         {
@@ -264,37 +343,171 @@ int Viterbi_Decoder::do_acs(const double sym[], int nbits)
                         }
                 }
             VLOG(LMORE) << "max_val at t=" << t << ": " << max_val;
-            for (state_at_t = 0; state_at_t < d_states; state_at_t++)
+            state_at_t = 0;
+#ifdef __SSE2__
+            if (rate_half)
+                {
+                    __m128 max4 = _mm_set1_ps(max_val);
+                    for (; state_at_t < d_states; state_at_t += 4)
+                        {
+                            _mm_storeu_ps(&d_pm_t[state_at_t], _mm_sub_ps(_mm_loadu_ps(pm_t_next + state_at_t), max4));
+                        }
+                }
+#endif
+            for (; state_at_t < d_states; state_at_t++)
                 {
                     d_pm_t[state_at_t] = pm_t_next[state_at_t] - max_val;
-                    pm_t_next[state_at_t] = -MAXLOG;
                 }
         }
 
-    delete[] pm_t_next;
-
     return t;
 }
 
 
 
-int Viterbi_Decoder::do_traceback(size_t traceback_length)
+void Viterbi_Decoder::acs_scalar(float* pm_t_next, unsigned char* decisions, float* branch_metrics)
+{
+    /* precompute all possible branch metrics */
+    for (int i = 0; i < d_number_symbols; i++)
+        {
+            d_metric_c[i] = gamma(d_rec_array, i, d_nn);
+        }
+
+    int half_states = std::max(d_states >> 1, 1);
+    for (int next_state = 0; next_state < d_states; next_state++)
+        {
+            int even_state = 2 * (next_state & (half_states - 1)) & (d_states - 1);
+            int odd_state = even_state | (d_states > 1 ? 1 : 0);
+            const int* out = (d_mm > 0 && (next_state >> (d_mm - 1))) ? d_out1 : d_out0;
+            // the branch metrics are truncated to integers, as they always were
+            int bm_even = d_metric_c[out[even_state]];
+            int bm_odd = d_metric_c[out[odd_state]];
+            float metric_even = d_pm_t[even_state] + bm_even;
+            float metric_odd = d_pm_t[odd_state] + bm_odd;
+
+            // the survivor branch, ties go to the even state
+            float best = -MAXLOG;
+            unsigned char decision = NO_SURVIVOR;
+            float bm = 0;
+            if (metric_even > best)
+                {
+                    best = metric_even;
+                    decision = FROM_EVEN_STATE;
+                    bm = bm_even;
+                }
+            if (metric_odd > best)
+                {
+                    best = metric_odd;
+                    decision = FROM_ODD_STATE;
+                    bm = bm_odd;
+                }
+            pm_t_next[next_state] = best;
+            decisions[next_state] = decision;
+            branch_metrics[next_state] = bm;
+        }
+}
+
+
+
+void Viterbi_Decoder::acs_rate_half(float* pm_t_next, unsigned char* decisions, float* branch_metrics)
+{
+    int half_states = d_states >> 1;
+    float* pm_even = &d_pm_even[0];
+    float* pm_odd = &d_pm_odd[0];
+#ifdef __SSE2__
+    for (int j = 0; j < half_states; j += 4)
+        {
+            __m128 a = _mm_loadu_ps(&d_pm_t[2 * j]);
+            __m128 b = _mm_loadu_ps(&d_pm_t[2 * j + 4]);
+            _mm_storeu_ps(pm_even + j, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(pm_odd + j, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+
+    const __m128 r0 = _mm_set1_ps(d_rec_array[0]);
+    const __m128 r1 = _mm_set1_ps(d_rec_array[1]);
+    const __m128 floor = _mm_set1_ps(-MAXLOG);
+    for (int next_state = 0; next_state < d_states; next_state += 4)
+        {
+            int j = next_state & (half_states - 1);
+            // gamma() truncated to integers, one branch per predecessor
+            __m128 bm_even = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&d_sign_even_r1[next_state]), r1),
+                    _mm_mul_ps(_mm_loadu_ps(&d_sign_even_r0[next_state]), r0));
+            __m128 bm_odd = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&d_sign_odd_r1[next_state]), r1),
+                    _mm_mul_ps(_mm_loadu_ps(&d_sign_odd_r0[next_state]), r0));
+            bm_even = _mm_cvtepi32_ps(_mm_cvttps_epi32(bm_even));
+            bm_odd = _mm_cvtepi32_ps(_mm_cvttps_epi32(bm_odd));
+            __m128 metric_even = _mm_add_ps(_mm_loadu_ps(pm_even + j), bm_even);
+            __m128 metric_odd = _mm_add_ps(_mm_loadu_ps(pm_odd + j), bm_odd);
+
+            // the same comparisons as acs_scalar(), ties go to the even state
+            __m128 take_odd = _mm_cmpgt_ps(metric_odd, _mm_max_ps(metric_even, floor));
+            __m128 take_even = _mm_andnot_ps(take_odd, _mm_cmpgt_ps(metric_even, floor));
+            __m128 none = _mm_andnot_ps(_mm_or_ps(take_odd, take_even), _mm_castsi128_ps(_mm_set1_epi32(-1)));
+            _mm_storeu_ps(pm_t_next + next_state, _mm_or_ps(_mm_or_ps(_mm_and_ps(take_odd, metric_odd), _mm_and_ps(take_even, metric_even)),
+                    _mm_and_ps(none, floor)));
+            _mm_storeu_ps(branch_metrics + next_state, _mm_or_ps(_mm_and_ps(take_odd, bm_odd), _mm_and_ps(take_even, bm_even)));
+            // FROM_ODD_STATE, FROM_EVEN_STATE or NO_SURVIVOR in 4 bytes
+            __m128i decision = _mm_or_si128(_mm_and_si128(_mm_castps_si128(take_odd), _mm_set1_epi32(FROM_ODD_STATE)),
+                    _mm_and_si128(_mm_castps_si128(none), _mm_set1_epi32(NO_SURVIVOR)));
+            decision = _mm_packus_epi16(_mm_packs_epi32(decision, decision), decision);
+            int decision_bytes = _mm_cvtsi128_si32(decision);
+            std::memcpy(decisions + next_state, &decision_bytes, 4);
+        }
+#else
+    for (int j = 0; j < half_states; j++)
+        {
+            pm_even[j] = d_pm_t[2 * j];
+            pm_odd[j] = d_pm_t[2 * j + 1];
+        }
+    const float r0 = d_rec_array[0];
+    const float r1 = d_rec_array[1];
+    for (int next_state = 0; next_state < d_states; next_state++)
+        {
+            int j = next_state & (half_states - 1);
+            int bm_even = d_sign_even_r1[next_state] * r1 + d_sign_even_r0[next_state] * r0;
+            int bm_odd = d_sign_odd_r1[next_state] * r1 + d_sign_odd_r0[next_state] * r0;
+            float metric_even = pm_even[j] + bm_even;
+            float metric_odd = pm_odd[j] + bm_odd;
+            float best = -MAXLOG;
+            unsigned char decision = NO_SURVIVOR;
+            float bm = 0;
+            if (metric_even > best)
+                {
+                    best = metric_even;
+                    decision = FROM_EVEN_STATE;
+                    bm = bm_even;
+                }
+            if (metric_odd > best)
+                {
+                    best = metric_odd;
+                    decision = FROM_ODD_STATE;
+                    bm = bm_odd;
+                }
+            pm_t_next[next_state] = best;
+            decisions[next_state] = decision;
+            branch_metrics[next_state] = bm;
+        }
+#endif
+}
+
+
+
+int Viterbi_Decoder::do_traceback(std::size_t traceback_length)
 {
     // traceback_length is in bits
     int state;
-    std::deque<Prev>::iterator it;
 
     VLOG(FLOW) << "do_traceback(): traceback_length=" << traceback_length << std::endl;
 
-    if (d_trellis_paths.size() < traceback_length)
+    if (static_cast<std::size_t>(d_size) < traceback_length)
         {
-            traceback_length = d_trellis_paths.size();
+            traceback_length = d_size;
         }
 
     state = 0; // maybe start not at state 0, but at state with best metric
-    for (it = d_trellis_paths.begin(); it < d_trellis_paths.begin() + traceback_length; ++it)
+    for (int k = 0; k < static_cast<int>(traceback_length); k++)
         {
-            state = it->get_anchestor_state_of_current_state(state);
+            state = get_ancestor_state(k, state);
         }
     return state;
 }
@@ -306,35 +519,35 @@ int Viterbi_Decoder::do_tb_and_decode(int traceback_length, int requested_decodi
 {
     int n_of_branches_for_indicator_metric = 500;
     int t_out;
-    std::deque<Prev>::iterator it;
     int decoding_length_mismatch;
     int overstep_length;
     int n_im = 0;
 
     VLOG(FLOW) << "do_tb_and_decode(): requested_decoding_length=" << requested_decoding_length;
     // decode only decode_length bits -> overstep newer bits which are too much
-    decoding_length_mismatch = d_trellis_paths.size() - (traceback_length + requested_decoding_length);
+    decoding_length_mismatch = d_size - (traceback_length + requested_decoding_length);
     VLOG(BLOCK) << "decoding_length_mismatch=" << decoding_length_mismatch;
     overstep_length = decoding_length_mismatch >= 0 ? decoding_length_mismatch : 0;
     VLOG(BLOCK) << "overstep_length=" << overstep_length;
 
-    for (it = d_trellis_paths.begin() + traceback_length;
-            it < d_trellis_paths.begin() + traceback_length + overstep_length; ++it)
+    int k;
+    for (k = traceback_length; k < traceback_length + overstep_length; k++)
         {
-            state = it->get_anchestor_state_of_current_state(state);
+            state = get_ancestor_state(k, state);
         }
-    t_out = d_trellis_paths.end() - (d_trellis_paths.begin() + traceback_length + overstep_length) - 1;//requested_decoding_length-1;
+    int first_decoded = traceback_length + overstep_length;
+    t_out = d_size - first_decoded - 1;
     indicator_metric = 0;
-    for (it = d_trellis_paths.begin() + traceback_length + overstep_length; it < d_trellis_paths.end(); ++it)
+    for (k = first_decoded; k < d_size; k++)
         {
-            if(it - (d_trellis_paths.begin() + traceback_length + overstep_length) < n_of_branches_for_indicator_metric)
+            if(k - first_decoded < n_of_branches_for_indicator_metric)
                 {
                     n_im++;
-                    indicator_metric += it->get_metric_of_current_state(state);
-                    VLOG(SAMPLE) << "@t=" << it->get_t() << " b=" << it->get_bit_of_current_state(state) << " sm=" << indicator_metric << " d=" << it->get_metric_of_current_state(state);
+                    indicator_metric += get_branch_metric(k, state);
+                    VLOG(SAMPLE) << "@t=" << d_section_t[section_slot(k)] << " b=" << get_bit(k, state) << " sm=" << indicator_metric << " d=" << get_branch_metric(k, state);
                 }
-            output_u_int[t_out] = it->get_bit_of_current_state(state);
-            state = it->get_anchestor_state_of_current_state(state);
+            output_u_int[t_out] = get_bit(k, state);
+            state = get_ancestor_state(k, state);
             t_out--;
         }
     if(n_im > 0)
@@ -344,10 +557,9 @@ int Viterbi_Decoder::do_tb_and_decode(int traceback_length, int requested_decodi
 
     VLOG(BLOCK) << "indicator metric: " << indicator_metric;
     // remove old states
-    if (d_trellis_paths.begin() + traceback_length + overstep_length <= d_trellis_paths.end())
+    if (first_decoded <= d_size)
         {
-
-            d_trellis_paths.erase(d_trellis_paths.begin() + traceback_length+overstep_length, d_trellis_paths.end());
+            d_size = first_decoded;
         }
     return decoding_length_mismatch;
 }
@@ -471,171 +683,3 @@ int Viterbi_Decoder::parity_counter(int symbol, int length)
         }
     return (temp_parity);
 }
-
-
-
-// prev helper class
-Viterbi_Decoder::Prev::Prev(int states, int t)
-{
-    this->t = t;
-    num_states = states;
-    state = new int[states];
-    bit = new int[states];
-    metric = new float[states];
-    refcount = new int;
-    *refcount = 1;
-    memset(state, 0, sizeof(int) * num_states);
-    memset(bit, 0, sizeof(int) * num_states);
-    memset(metric, 0, sizeof(float) * num_states);
-}
-
-
-
-// copy constructor
-Viterbi_Decoder::Prev::Prev(const Prev& prev)
-{
-    refcount = prev.refcount;
-    (*refcount)++;
-    t = prev.t;
-    state = prev.state;
-    num_states = prev.num_states;
-    bit = prev.bit;
-    metric = prev.metric;
-    VLOG(LMORE) << "Prev(" << "?" << ", " << t << ")" << " copy, new refcount = " << *refcount;
-}
-
-
-
-// assignment constructor
-Viterbi_Decoder::Prev& Viterbi_Decoder::Prev::operator=(const Prev& other)
-{
-    // check for self-assignment
-    if(&other == this)
-        {
-            return *this;
-        }
-
-    // handle old resources
-    if(*refcount == 1)
-        { // if they are not used anymore -> unallocate them
-            delete[] state;
-            delete[] bit;
-            delete[] metric;
-            delete refcount;
-        }
-    else
-        { // this object is not anymore using them
-            (*refcount)--;
-        }
-
-    // increase ref counter for this resource set
-    refcount = other.refcount;
-    (*refcount)++;
-
-    // take over resources
-    t = other.t;
-    state = other.state;
-    bit = other.bit;
-    metric = other.metric;
-
-    VLOG(LMORE) << "Prev(" << "?" << ", " << t << ")" << " assignment, new refcount = " << *refcount;
-    return *this;
-}
-
-
-
-
-Viterbi_Decoder::Prev::~Prev()
-{
-    if (*refcount == 1)
-        {
-            delete[] state;
-            delete[] bit;
-            delete[] metric;
-            delete refcount;
-            //std::cout << "~Prev(" << "?" << ", " << t << ")" << " destructor with delete" << std::endl;
-        }
-    else
-        {
-            (*refcount)--;
-            VLOG(LMORE) << "~Prev(" << "?" << ", " << t << ")" << " destructor after copy, new refcount = " << *refcount;
-        }
-}
-
-
-
-int Viterbi_Decoder::Prev::get_anchestor_state_of_current_state(int current_state)
-{
-    //std::cout << "get prev state: for state " << current_state << " at time " << t << ", the prev state at time " << t-1 << " is " << state[current_state] << std::endl;
-    if (num_states > current_state)
-        {
-            return state[current_state];
-        }
-    else
-        {
-            //std::cout<<"alarm "<<"num_states="<<num_states<<" current_state="<<current_state<<std::endl;
-            //return state[current_state];
-            return 0;
-        }
-}
-
-
-
-int Viterbi_Decoder::Prev::get_bit_of_current_state(int current_state)
-{
-    //std::cout << "get prev bit  : for state " << current_state << " at time " << t << ", the send bit is " << bit[current_state] << std::endl;
-    if (num_states > current_state)
-        {
-            return bit[current_state];
-        }
-    else
-        {
-            return 0;
-        }
-}
-
-
-float Viterbi_Decoder::Prev::get_metric_of_current_state(int current_state)
-{
-    if (num_states > current_state)
-        {
-            return metric[current_state];
-        }
-    else
-        {
-            return 0;
-        }
-}
-
-
-int Viterbi_Decoder::Prev::get_t()
-{
-    return t;
-}
-
-
-void Viterbi_Decoder::Prev::set_current_state_as_ancestor_of_next_state(int next_state, int current_state)
-{
-    if (num_states > next_state)
-        {
-            state[next_state] = current_state;
-        }
-}
-
-
-void Viterbi_Decoder::Prev::set_decoded_bit_for_next_state(int next_state, int bit)
-{
-    if (num_states > next_state)
-        {
-            this->bit[next_state] = bit;
-        }
-}
-
-
-void Viterbi_Decoder::Prev::set_survivor_branch_metric_of_next_state(int next_state, float metric)
-{
-    if (num_states > next_state)
-        {
-            this->metric[next_state] = metric;
-        }
-}
@@ -32,11 +32,17 @@
 #ifndef GNSS_SDR_VITERBI_DECODER_H_
 #define GNSS_SDR_VITERBI_DECODER_H_
 
-#include <deque>
-#include <cstdio>
+#include <cstddef>
+#include <vector>
 
 /*!
  * \brief Class that implements a Viterbi decoder
+ *
+ * The survivors of the trellis sections are kept in a ring of preallocated
+ * memory: one decision byte and one branch metric per state and section.
+ * For rate 1/2 codes (as the K=7 code of Galileo E1B, E5a, SBAS and GPS L2C)
+ * the add-compare-select runs on four states at a time with SSE2, and it
+ * takes exactly the same decisions as the scalar one.
  */
 class Viterbi_Decoder
 {
@@ -55,34 +61,15 @@ public:
      */
     float decode_block(const double input_c[], int* output_u_int, const int LL);
 
+    //! Same as above, on single precision soft symbols
+    float decode_block(const float input_c[], int* output_u_int, const int LL);
+
     float decode_continuous(const double sym[], const int traceback_depth, int output_u_int[],
             const int nbits_requested, int &nbits_decoded);
 
 private:
-    class Prev
-    {
-    public:
-        int num_states;
-        Prev(int states, int t);
-        Prev(const Prev& prev);
-        Prev& operator=(const Prev& other);
-        ~Prev();
-
-        int get_anchestor_state_of_current_state(int current_state);
-        int get_bit_of_current_state(int current_state);
-        float get_metric_of_current_state(int current_state);
-        int get_t();
-        void set_current_state_as_ancestor_of_next_state(int next_state, int current_state);
-        void set_decoded_bit_for_next_state(int next_state, int bit);
-        void set_survivor_branch_metric_of_next_state(int next_state, float metric);
-
-    private:
-        int t;
-        int * state;
-        int * bit;
-        float * metric;
-        int * refcount;
-    };
+    Viterbi_Decoder(const Viterbi_Decoder&);
+    Viterbi_Decoder& operator=(const Viterbi_Decoder&);
 
     // code properties
     int d_KK;
@@ -99,22 +86,50 @@ private:
     int* d_out1;
     int* d_state1;
 
+    // branch signs of the two predecessors of each state, for the rate 1/2 ACS
+    std::vector<float> d_sign_even_r0;
+    std::vector<float> d_sign_even_r1;
+    std::vector<float> d_sign_odd_r0;
+    std::vector<float> d_sign_odd_r1;
+
     // trellis state
-    float *d_pm_t;
-    std::deque<Prev> d_trellis_paths;
+    std::vector<float> d_pm_t;
+    std::vector<float> d_pm_t_next;
+    std::vector<float> d_pm_even; // path metrics of the even and odd states
+    std::vector<float> d_pm_odd;
     float *d_metric_c; /* Set of all possible branch metrics */
     float *d_rec_array; /* Received values for one trellis section */
-    bool d_trellis_state_is_initialised;
+
+    /*
+     * Survivor ring, section k (0 is the newest) is at slot (d_newest - k) mod d_capacity.
+     * The decision of a state says which of its two predecessors survived.
+     */
+    std::vector<unsigned char> d_decisions;
+    std::vector<float> d_branch_metrics;
+    std::vector<int> d_section_t;
+    int d_capacity;
+    int d_newest;
+    int d_size;
 
     // measures
     float d_indicator_metric;
 
     // operations on the trellis (change decoder state)
     void init_trellis_state();
-    int do_acs(const double sym[], int nbits);
-    int do_traceback(size_t traceback_length);
+    template<typename T> float do_decode_block(const T input_c[], int* output_u_int, const int LL);
+    template<typename T> int do_acs(const T sym[], int nbits);
+    void acs_scalar(float* pm_t_next, unsigned char* decisions, float* branch_metrics);
+    void acs_rate_half(float* pm_t_next, unsigned char* decisions, float* branch_metrics);
+    int do_traceback(std::size_t traceback_length);
     int do_tb_and_decode(int traceback_length, int requested_decoding_length, int state, int bits[], float& indicator_metric);
 
+    // survivor ring
+    void reserve_sections(int sections);
+    int section_slot(int k) const;
+    int get_ancestor_state(int k, int state) const;
+    int get_bit(int k, int state) const;
+    float get_branch_metric(int k, int state) const;
+
     // branch metric function
     float gamma(float rec_array[], int symbol, int nn);
 
@@ -54,14 +54,19 @@ GalileoE1DllPllVemlTracking::GalileoE1DllPllVemlTracking(
     int f_if;
     bool dump;
     std::string dump_filename;
-    std::string item_type;
     std::string default_item_type = "gr_complex";
     float pll_bw_hz;
     float dll_bw_hz;
     float early_late_space_chips;
     float very_early_late_space_chips;
-
-    item_type = configuration->property(role + ".item_type", default_item_type);
+    unsigned int replica_cache_sets;
+    float replica_cache_tolerance_chips;
+    bool track_pilot;
+    int extend_correlation_ms;
+    float pll_bw_narrow_hz;
+    float dll_bw_narrow_hz;
+
+    item_type_ = configuration->property(role + ".item_type", default_item_type);
     fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
     f_if = configuration->property(role + ".if", 0);
     dump = configuration->property(role + ".dump", false);
@@ -69,6 +74,12 @@ GalileoE1DllPllVemlTracking::GalileoE1DllPllVemlTracking(
     dll_bw_hz = configuration->property(role + ".dll_bw_hz", 2.0);
     early_late_space_chips = configuration->property(role + ".early_late_space_chips", 0.15);
     very_early_late_space_chips = configuration->property(role + ".very_early_late_space_chips", 0.6);
+    replica_cache_sets = configuration->property(role + ".replica_cache_sets", 0);
+    replica_cache_tolerance_chips = configuration->property(role + ".replica_cache_tolerance_chips", 0.01);
+    track_pilot = configuration->property(role + ".track_pilot", false);
+    extend_correlation_ms = configuration->property(role + ".extend_correlation_ms", 4);
+    pll_bw_narrow_hz = configuration->property(role + ".pll_bw_narrow_hz", 5.0);
+    dll_bw_narrow_hz = configuration->property(role + ".dll_bw_narrow_hz", 0.5);
 
     std::string default_dump_filename = "./track_ch";
     dump_filename = configuration->property(role + ".dump_filename",
@@ -76,10 +87,27 @@ GalileoE1DllPllVemlTracking::GalileoE1DllPllVemlTracking(
     vector_length = std::round(fs_in / (Galileo_E1_CODE_CHIP_RATE_HZ / Galileo_E1_B_CODE_LENGTH_CHIPS));
 
     //################# MAKE TRACKING GNURadio object ###################
-    if (item_type.compare("gr_complex") == 0)
+    if (item_type_.compare("gr_complex") == 0)
         {
             item_size_ = sizeof(gr_complex);
-            tracking_ = galileo_e1_dll_pll_veml_make_tracking_cc(
+            tracking_cc = galileo_e1_dll_pll_veml_make_tracking_cc(
+                    f_if,
+                    fs_in,
+                    vector_length,
+                    dump,
+                    dump_filename,
+                    pll_bw_hz,
+                    dll_bw_hz,
+                    early_late_space_chips,
+                    very_early_late_space_chips);
+            tracking_cc->set_pilot_tracking(track_pilot, extend_correlation_ms, pll_bw_narrow_hz, dll_bw_narrow_hz);
+            tracking_cc->set_replica_cache(replica_cache_sets, replica_cache_tolerance_chips);
+            DLOG(INFO) << "tracking(" << tracking_cc->unique_id() << ")";
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            item_size_ = sizeof(lv_16sc_t);
+            tracking_sc = galileo_e1_dll_pll_veml_make_tracking_sc(
                     f_if,
                     fs_in,
                     vector_length,
@@ -89,16 +117,20 @@ GalileoE1DllPllVemlTracking::GalileoE1DllPllVemlTracking(
                     dll_bw_hz,
                     early_late_space_chips,
                     very_early_late_space_chips);
+            if (track_pilot)
+                {
+                    LOG(WARNING) << "Pilot tracking is not supported with cshort items, ignoring " << role << ".track_pilot";
+                }
+            DLOG(INFO) << "tracking(" << tracking_sc->unique_id() << ")";
         }
     else
         {
             item_size_ = sizeof(gr_complex);
-            LOG(WARNING) << item_type << " unknown tracking item type.";
+            LOG(WARNING) << item_type_ << " unknown tracking item type.";
         }
 
     channel_ = 0;
 
-    DLOG(INFO) << "tracking(" << tracking_->unique_id() << ")";
 }
 
 GalileoE1DllPllVemlTracking::~GalileoE1DllPllVemlTracking()
@@ -106,12 +138,34 @@ GalileoE1DllPllVemlTracking::~GalileoE1DllPllVemlTracking()
 
 void GalileoE1DllPllVemlTracking::stop_tracking()
 {
-    tracking_->stop_tracking();
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            tracking_cc->stop_tracking();
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            tracking_sc->stop_tracking();
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+        }
 }
 
 void GalileoE1DllPllVemlTracking::start_tracking()
 {
-    tracking_->start_tracking();
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            tracking_cc->start_tracking();
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            tracking_sc->start_tracking();
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+        }
 }
 
 /*
@@ -120,13 +174,35 @@ void GalileoE1DllPllVemlTracking::start_tracking()
 void GalileoE1DllPllVemlTracking::set_channel(unsigned int channel)
 {
     channel_ = channel;
-    tracking_->set_channel(channel);
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            tracking_cc->set_channel(channel);
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            tracking_sc->set_channel(channel);
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+        }
 }
 
 
 void GalileoE1DllPllVemlTracking::set_gnss_synchro(Gnss_Synchro* p_gnss_synchro)
 {
-    tracking_->set_gnss_synchro(p_gnss_synchro);
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            tracking_cc->set_gnss_synchro(p_gnss_synchro);
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            tracking_sc->set_gnss_synchro(p_gnss_synchro);
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+        }
 }
 
 void GalileoE1DllPllVemlTracking::connect(gr::top_block_sptr top_block)
@@ -143,11 +219,35 @@ void GalileoE1DllPllVemlTracking::disconnect(gr::top_block_sptr top_block)
 
 gr::basic_block_sptr GalileoE1DllPllVemlTracking::get_left_block()
 {
-    return tracking_;
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            return tracking_cc;
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            return tracking_sc;
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+            return nullptr;
+        }
 }
 
 gr::basic_block_sptr GalileoE1DllPllVemlTracking::get_right_block()
 {
-    return tracking_;
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            return tracking_cc;
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            return tracking_sc;
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+            return nullptr;
+        }
 }
 
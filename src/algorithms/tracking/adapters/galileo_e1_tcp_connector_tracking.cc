@@ -62,6 +62,7 @@ GalileoE1TcpConnectorTracking::GalileoE1TcpConnectorTracking(
     float early_late_space_chips;
     float very_early_late_space_chips;
     size_t port_ch0;
+    bool pipelined_loop;
     item_type = configuration->property(role + ".item_type",default_item_type);
     fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
     f_if = configuration->property(role + ".if", 0);
@@ -71,6 +72,7 @@ GalileoE1TcpConnectorTracking::GalileoE1TcpConnectorTracking(
     early_late_space_chips = configuration->property(role + ".early_late_space_chips", 0.15);
     very_early_late_space_chips = configuration->property(role + ".very_early_late_space_chips", 0.6);
     port_ch0 = configuration->property(role + ".port_ch0", 2060);
+    pipelined_loop = configuration->property(role + ".pipelined_loop", false);
     std::string default_dump_filename = "./track_ch";
     dump_filename = configuration->property(role + ".dump_filename", default_dump_filename); //unused!
     vector_length = std::round(fs_in / (Galileo_E1_CODE_CHIP_RATE_HZ / Galileo_E1_B_CODE_LENGTH_CHIPS));
@@ -90,6 +92,7 @@ GalileoE1TcpConnectorTracking::GalileoE1TcpConnectorTracking(
                     early_late_space_chips,
                     very_early_late_space_chips,
                     port_ch0);
+            tracking_->set_pipelined_loop(pipelined_loop);
         }
     else
         {
@@ -56,7 +56,6 @@ GalileoE5aDllPllTracking::GalileoE5aDllPllTracking(
     int f_if;
     bool dump;
     std::string dump_filename;
-    std::string item_type;
     std::string default_item_type = "gr_complex";
     float pll_bw_hz;
     float dll_bw_hz;
@@ -64,7 +63,7 @@ GalileoE5aDllPllTracking::GalileoE5aDllPllTracking(
     float dll_bw_init_hz;
     int ti_ms;
     float early_late_space_chips;
-    item_type = configuration->property(role + ".item_type", default_item_type);
+    item_type_ = configuration->property(role + ".item_type", default_item_type);
     //vector_length = configuration->property(role + ".vector_length", 2048);
     fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 12000000);
     f_if = configuration->property(role + ".if", 0);
@@ -82,10 +81,10 @@ GalileoE5aDllPllTracking::GalileoE5aDllPllTracking(
     vector_length = std::round(fs_in / (Galileo_E5a_CODE_CHIP_RATE_HZ / Galileo_E5a_CODE_LENGTH_CHIPS));
 
     //################# MAKE TRACKING GNURadio object ###################
-    if (item_type.compare("gr_complex") == 0)
+    if (item_type_.compare("gr_complex") == 0)
         {
             item_size_ = sizeof(gr_complex);
-            tracking_ = galileo_e5a_dll_pll_make_tracking_cc(
+            tracking_cc = galileo_e5a_dll_pll_make_tracking_cc(
                     f_if,
                     fs_in,
                     vector_length,
@@ -97,14 +96,31 @@ GalileoE5aDllPllTracking::GalileoE5aDllPllTracking(
                     dll_bw_init_hz,
                     ti_ms,
                     early_late_space_chips);
+            DLOG(INFO) << "tracking(" << tracking_cc->unique_id() << ")";
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            item_size_ = sizeof(lv_16sc_t);
+            tracking_sc = galileo_e5a_dll_pll_make_tracking_sc(
+                    f_if,
+                    fs_in,
+                    vector_length,
+                    dump,
+                    dump_filename,
+                    pll_bw_hz,
+                    dll_bw_hz,
+                    pll_bw_init_hz,
+                    dll_bw_init_hz,
+                    ti_ms,
+                    early_late_space_chips);
+            DLOG(INFO) << "tracking(" << tracking_sc->unique_id() << ")";
         }
     else
         {
             item_size_ = sizeof(gr_complex);
-            LOG(WARNING) << item_type << " unknown tracking item type.";
+            LOG(WARNING) << item_type_ << " unknown tracking item type.";
         }
     channel_ = 0;
-    DLOG(INFO) << "tracking(" << tracking_->unique_id() << ")";
 }
 
 
@@ -114,13 +130,35 @@ GalileoE5aDllPllTracking::~GalileoE5aDllPllTracking()
 
 void GalileoE5aDllPllTracking::start_tracking()
 {
-    tracking_->start_tracking();
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            tracking_cc->start_tracking();
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            tracking_sc->start_tracking();
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+        }
 
 }
 
 void GalileoE5aDllPllTracking::stop_tracking()
 {
-    tracking_->stop_tracking();
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            tracking_cc->stop_tracking();
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            tracking_sc->stop_tracking();
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+        }
 }
 
 /*
@@ -129,13 +167,35 @@ void GalileoE5aDllPllTracking::stop_tracking()
 void GalileoE5aDllPllTracking::set_channel(unsigned int channel)
 {
     channel_ = channel;
-    tracking_->set_channel(channel);
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            tracking_cc->set_channel(channel);
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            tracking_sc->set_channel(channel);
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+        }
 }
 
 
 void GalileoE5aDllPllTracking::set_gnss_synchro(Gnss_Synchro* p_gnss_synchro)
 {
-    tracking_->set_gnss_synchro(p_gnss_synchro);
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            tracking_cc->set_gnss_synchro(p_gnss_synchro);
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            tracking_sc->set_gnss_synchro(p_gnss_synchro);
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+        }
 }
 
 void GalileoE5aDllPllTracking::connect(gr::top_block_sptr top_block)
@@ -152,12 +212,36 @@ void GalileoE5aDllPllTracking::disconnect(gr::top_block_sptr top_block)
 
 gr::basic_block_sptr GalileoE5aDllPllTracking::get_left_block()
 {
-    return tracking_;
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            return tracking_cc;
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            return tracking_sc;
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+            return nullptr;
+        }
 }
 
 gr::basic_block_sptr GalileoE5aDllPllTracking::get_right_block()
 {
-    return tracking_;
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            return tracking_cc;
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            return tracking_sc;
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+            return nullptr;
+        }
 }
 
 
@@ -42,6 +42,7 @@
 #include <string>
 #include "tracking_interface.h"
 #include "galileo_e5a_dll_pll_tracking_cc.h"
+#include "galileo_e5a_dll_pll_tracking_sc.h"
 
 
 class ConfigurationInterface;
@@ -95,8 +96,10 @@ public:
     void stop_tracking();
 
 private:
-    galileo_e5a_dll_pll_tracking_cc_sptr tracking_;
+    galileo_e5a_dll_pll_tracking_cc_sptr tracking_cc;
+    galileo_e5a_dll_pll_tracking_sc_sptr tracking_sc;
     size_t item_size_;
+    std::string item_type_;
     unsigned int channel_;
     std::string role_;
     unsigned int in_streams_;
@@ -37,6 +37,9 @@
 
 
 #include "gps_l1_ca_dll_pll_tracking.h"
+#include <vector>
+#include <boost/lexical_cast.hpp>
+#include <boost/tokenizer.hpp>
 #include <glog/logging.h>
 #include "GPS_L1_CA.h"
 #include "configuration_interface.h"
@@ -56,27 +59,82 @@ GpsL1CaDllPllTracking::GpsL1CaDllPllTracking(
     int f_if;
     bool dump;
     std::string dump_filename;
-    std::string item_type;
     std::string default_item_type = "gr_complex";
     float pll_bw_hz;
+    float pll_bw_narrow_hz;
     float dll_bw_hz;
+    float dll_bw_narrow_hz;
+    int extend_correlation_ms;
     float early_late_space_chips;
-    item_type = configuration->property(role + ".item_type", default_item_type);
+    bool batch_correlators;
+    unsigned int batch_wait_us;
+    bool prn_group;
+    float prn_group_doppler_hz;
+    bool vector_tracking;
+    int vector_max_age_ms;
+    int vector_max_coast_ms;
+    bool bandwidth_schedule;
+    float pll_bw_steady_hz;
+    float dll_bw_steady_hz;
+    float steady_cn0_dbhz;
+    int lock_check_decimation;
+    std::string sqm_spacings;
+    std::vector<float> sqm_spacings_chips;
+    int sqm_decimation;
+    unsigned int sqm_window;
+    int aoa_decimation;
+    unsigned int aoa_averages;
+    int fine_pull_in_ms;
+    item_type_ = configuration->property(role + ".item_type", default_item_type);
     fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
     f_if = configuration->property(role + ".if", 0);
     dump = configuration->property(role + ".dump", false);
     pll_bw_hz = configuration->property(role + ".pll_bw_hz", 50.0);
     dll_bw_hz = configuration->property(role + ".dll_bw_hz", 2.0);
+    pll_bw_narrow_hz = configuration->property(role + ".pll_bw_narrow_hz", 20.0);
+    dll_bw_narrow_hz = configuration->property(role + ".dll_bw_narrow_hz", 2.0);
+    extend_correlation_ms = configuration->property(role + ".extend_correlation_ms", 1);
     early_late_space_chips = configuration->property(role + ".early_late_space_chips", 0.5);
+    batch_correlators = configuration->property(role + ".batch_correlators", false);
+    batch_wait_us = configuration->property(role + ".batch_wait_us", 200);
+    prn_group = configuration->property(role + ".prn_group", false);
+    prn_group_doppler_hz = configuration->property(role + ".prn_group_doppler_hz", 50.0);
+    vector_tracking = configuration->property(role + ".vector_tracking", false);
+    vector_max_age_ms = configuration->property(role + ".vector_max_age_ms", 2000);
+    vector_max_coast_ms = configuration->property(role + ".vector_max_coast_ms", 5000);
+    bandwidth_schedule = configuration->property(role + ".bandwidth_schedule", false);
+    pll_bw_steady_hz = configuration->property(role + ".pll_bw_steady_hz", 15.0);
+    dll_bw_steady_hz = configuration->property(role + ".dll_bw_steady_hz", 1.0);
+    steady_cn0_dbhz = configuration->property(role + ".steady_cn0_dbhz", 35.0);
+    lock_check_decimation = configuration->property(role + ".lock_check_decimation", 5);
+    sqm_spacings = configuration->property(role + ".sqm_spacings_chips", std::string(""));
+    sqm_decimation = configuration->property(role + ".sqm_decimation", 20);
+    sqm_window = configuration->property(role + ".sqm_window", 50);
+    aoa_decimation = configuration->property(role + ".aoa_decimation", 0);
+    aoa_averages = configuration->property(role + ".aoa_averages", 10);
+    fine_pull_in_ms = configuration->property(role + ".fine_pull_in_ms", 0);
+    boost::char_separator<char> separator(", ");
+    boost::tokenizer<boost::char_separator<char>> tokens(sqm_spacings, separator);
+    for (boost::tokenizer<boost::char_separator<char>>::iterator it = tokens.begin(); it != tokens.end(); ++it)
+        {
+            try
+            {
+                    sqm_spacings_chips.push_back(boost::lexical_cast<float>(*it));
+            }
+            catch(const boost::bad_lexical_cast& e)
+            {
+                    LOG(WARNING) << "Ignoring the SQM spacing " << *it << " of " << role;
+            }
+        }
     std::string default_dump_filename = "./track_ch";
     dump_filename = configuration->property(role + ".dump_filename", default_dump_filename); //unused!
     vector_length = std::round(fs_in / (GPS_L1_CA_CODE_RATE_HZ / GPS_L1_CA_CODE_LENGTH_CHIPS));
 
     //################# MAKE TRACKING GNURadio object ###################
-    if (item_type.compare("gr_complex") == 0)
+    if (item_type_.compare("gr_complex") == 0)
         {
             item_size_ = sizeof(gr_complex);
-            tracking_ = gps_l1_ca_dll_pll_make_tracking_cc(
+            tracking_cc = gps_l1_ca_dll_pll_make_tracking_cc(
                     f_if,
                     fs_in,
                     vector_length,
@@ -85,14 +143,57 @@ GpsL1CaDllPllTracking::GpsL1CaDllPllTracking(
                     pll_bw_hz,
                     dll_bw_hz,
                     early_late_space_chips);
+            tracking_cc->set_batch_correlators(batch_correlators, batch_wait_us);
+            tracking_cc->set_prn_group(prn_group, prn_group_doppler_hz);
+            tracking_cc->set_extended_integration(extend_correlation_ms, pll_bw_narrow_hz, dll_bw_narrow_hz);
+            tracking_cc->set_vector_tracking(vector_tracking, vector_max_age_ms / 1000.0, vector_max_coast_ms);
+            tracking_cc->set_bandwidth_schedule(bandwidth_schedule, pll_bw_steady_hz, dll_bw_steady_hz, steady_cn0_dbhz, lock_check_decimation);
+            if (!sqm_spacings_chips.empty())
+                {
+                    tracking_cc->set_sqm(sqm_spacings_chips, sqm_decimation, sqm_window);
+                }
+            if (aoa_decimation > 0)
+                {
+                    tracking_cc->set_aoa(aoa_decimation, aoa_averages);
+                }
+            tracking_cc->set_fine_pull_in(fine_pull_in_ms);
+            DLOG(INFO) << "tracking(" << tracking_cc->unique_id() << ")";
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            item_size_ = sizeof(lv_16sc_t);
+            tracking_sc = gps_l1_ca_dll_pll_make_tracking_sc(
+                    f_if,
+                    fs_in,
+                    vector_length,
+                    dump,
+                    dump_filename,
+                    pll_bw_hz,
+                    dll_bw_hz,
+                    early_late_space_chips);
+            tracking_sc->set_extended_integration(extend_correlation_ms, pll_bw_narrow_hz, dll_bw_narrow_hz);
+            tracking_sc->set_vector_tracking(vector_tracking, vector_max_age_ms / 1000.0, vector_max_coast_ms);
+            tracking_sc->set_bandwidth_schedule(bandwidth_schedule, pll_bw_steady_hz, dll_bw_steady_hz, steady_cn0_dbhz, lock_check_decimation);
+            if (!sqm_spacings_chips.empty())
+                {
+                    LOG(WARNING) << "Signal quality monitoring is not supported with cshort items, ignoring " << role << ".sqm_spacings_chips";
+                }
+            if (aoa_decimation > 0)
+                {
+                    LOG(WARNING) << "Angle of arrival is not supported with cshort items, ignoring " << role << ".aoa_decimation";
+                }
+            if (fine_pull_in_ms > 0)
+                {
+                    LOG(WARNING) << "The fine pull-in is not supported with cshort items, ignoring " << role << ".fine_pull_in_ms";
+                }
+            DLOG(INFO) << "tracking(" << tracking_sc->unique_id() << ")";
         }
     else
         {
             item_size_ = sizeof(gr_complex);
-            LOG(WARNING) << item_type << " unknown tracking item type.";
+            LOG(WARNING) << item_type_ << " unknown tracking item type.";
         }
     channel_ = 0;
-    DLOG(INFO) << "tracking(" << tracking_->unique_id() << ")";
 }
 
 
@@ -101,12 +202,63 @@ GpsL1CaDllPllTracking::~GpsL1CaDllPllTracking()
 
 void GpsL1CaDllPllTracking::stop_tracking()
 {
-    tracking_->stop_tracking();
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            tracking_cc->stop_tracking();
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            tracking_sc->stop_tracking();
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+        }
 }
 
 void GpsL1CaDllPllTracking::start_tracking()
 {
-    tracking_->start_tracking();
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            tracking_cc->start_tracking();
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            tracking_sc->start_tracking();
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+        }
+}
+
+
+double GpsL1CaDllPllTracking::cn0_db_hz()
+{
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            return tracking_cc->cn0_db_hz();
+        }
+    return 0.0;
+}
+
+
+void GpsL1CaDllPllTracking::reconfigure(ConfigurationInterface* configuration)
+{
+    pmt::pmt_t bandwidths = pmt::make_dict();
+    bandwidths = pmt::dict_add(bandwidths, pmt::mp("pll_bw_hz"), pmt::from_double(configuration->property(role_ + ".pll_bw_hz", 50.0)));
+    bandwidths = pmt::dict_add(bandwidths, pmt::mp("dll_bw_hz"), pmt::from_double(configuration->property(role_ + ".dll_bw_hz", 2.0)));
+    bandwidths = pmt::dict_add(bandwidths, pmt::mp("pll_bw_narrow_hz"), pmt::from_double(configuration->property(role_ + ".pll_bw_narrow_hz", 20.0)));
+    bandwidths = pmt::dict_add(bandwidths, pmt::mp("dll_bw_narrow_hz"), pmt::from_double(configuration->property(role_ + ".dll_bw_narrow_hz", 2.0)));
+    bandwidths = pmt::dict_add(bandwidths, pmt::mp("pll_bw_steady_hz"), pmt::from_double(configuration->property(role_ + ".pll_bw_steady_hz", 15.0)));
+    bandwidths = pmt::dict_add(bandwidths, pmt::mp("dll_bw_steady_hz"), pmt::from_double(configuration->property(role_ + ".dll_bw_steady_hz", 1.0)));
+    bandwidths = pmt::dict_add(bandwidths, pmt::mp("steady_cn0_dbhz"), pmt::from_double(configuration->property(role_ + ".steady_cn0_dbhz", 35.0)));
+    // handled in the thread of the block
+    gr::basic_block_sptr block = get_left_block();
+    if (block)
+        {
+            block->_post(pmt::mp("loop_bandwidths"), bandwidths);
+        }
 }
 
 
@@ -116,13 +268,35 @@ void GpsL1CaDllPllTracking::start_tracking()
 void GpsL1CaDllPllTracking::set_channel(unsigned int channel)
 {
     channel_ = channel;
-    tracking_->set_channel(channel);
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            tracking_cc->set_channel(channel);
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            tracking_sc->set_channel(channel);
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+        }
 }
 
 
 void GpsL1CaDllPllTracking::set_gnss_synchro(Gnss_Synchro* p_gnss_synchro)
 {
-    tracking_->set_gnss_synchro(p_gnss_synchro);
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            tracking_cc->set_gnss_synchro(p_gnss_synchro);
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            tracking_sc->set_gnss_synchro(p_gnss_synchro);
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+        }
 }
 
 
@@ -142,12 +316,36 @@ void GpsL1CaDllPllTracking::disconnect(gr::top_block_sptr top_block)
 
 gr::basic_block_sptr GpsL1CaDllPllTracking::get_left_block()
 {
-    return tracking_;
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            return tracking_cc;
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            return tracking_sc;
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+            return nullptr;
+        }
 }
 
 
 gr::basic_block_sptr GpsL1CaDllPllTracking::get_right_block()
 {
-    return tracking_;
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            return tracking_cc;
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            return tracking_sc;
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+            return nullptr;
+        }
 }
 
@@ -41,6 +41,7 @@
 #include <string>
 #include "tracking_interface.h"
 #include "gps_l1_ca_dll_pll_tracking_cc.h"
+#include "gps_l1_ca_dll_pll_tracking_sc.h"
 
 
 class ConfigurationInterface;
@@ -92,10 +93,19 @@ public:
 
     void start_tracking();
     void stop_tracking();
+    double cn0_db_hz(); //!< 0 for the cshort implementation
+
+    /*!
+     * \brief Changes the loop bandwidths (role.pll_bw_hz, dll_bw_hz, pll_bw_narrow_hz,
+     * dll_bw_narrow_hz, pll_bw_steady_hz, dll_bw_steady_hz, steady_cn0_dbhz) in place
+     */
+    void reconfigure(ConfigurationInterface* configuration);
 
 private:
-    gps_l1_ca_dll_pll_tracking_cc_sptr tracking_;
+    gps_l1_ca_dll_pll_tracking_cc_sptr tracking_cc;
+    gps_l1_ca_dll_pll_tracking_sc_sptr tracking_sc;
     size_t item_size_;
+    std::string item_type_;
     unsigned int channel_;
     std::string role_;
     unsigned int in_streams_;
@@ -60,6 +60,8 @@ GpsL1CaDllPllTrackingGPU::GpsL1CaDllPllTrackingGPU(
     float pll_bw_hz;
     float dll_bw_hz;
     float early_late_space_chips;
+    bool batch_correlators;
+    unsigned int batch_wait_us;
     item_type = configuration->property(role + ".item_type", default_item_type);
     //vector_length = configuration->property(role + ".vector_length", 2048);
     fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
@@ -68,6 +70,8 @@ GpsL1CaDllPllTrackingGPU::GpsL1CaDllPllTrackingGPU(
     pll_bw_hz = configuration->property(role + ".pll_bw_hz", 50.0);
     dll_bw_hz = configuration->property(role + ".dll_bw_hz", 2.0);
     early_late_space_chips = configuration->property(role + ".early_late_space_chips", 0.5);
+    batch_correlators = configuration->property(role + ".batch_correlators", false);
+    batch_wait_us = configuration->property(role + ".batch_wait_us", 200);
     std::string default_dump_filename = "./track_ch";
     dump_filename = configuration->property(role + ".dump_filename",
             default_dump_filename); //unused!
@@ -86,6 +90,8 @@ GpsL1CaDllPllTrackingGPU::GpsL1CaDllPllTrackingGPU(
                     pll_bw_hz,
                     dll_bw_hz,
                     early_late_space_chips);
+            tracking_->set_batch_correlators(batch_correlators, batch_wait_us);
+            tracking_->set_zero_copy(configuration->property(role + ".zero_copy", false));
         }
     else
         {
@@ -59,6 +59,7 @@ GpsL1CaTcpConnectorTracking::GpsL1CaTcpConnectorTracking(
     std::string default_item_type = "gr_complex";
     float early_late_space_chips;
     size_t port_ch0;
+    bool pipelined_loop;
     item_type = configuration->property(role + ".item_type",default_item_type);
     //vector_length = configuration->property(role + ".vector_length", 2048);
     fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
@@ -66,6 +67,7 @@ GpsL1CaTcpConnectorTracking::GpsL1CaTcpConnectorTracking(
     dump = configuration->property(role + ".dump", false);
     early_late_space_chips = configuration->property(role + ".early_late_space_chips", 0.5);
     port_ch0 = configuration->property(role + ".port_ch0", 2060);
+    pipelined_loop = configuration->property(role + ".pipelined_loop", false);
     std::string default_dump_filename = "./track_ch";
     dump_filename = configuration->property(role + ".dump_filename", default_dump_filename); //unused!
     vector_length = std::round(fs_in / (GPS_L1_CA_CODE_RATE_HZ / GPS_L1_CA_CODE_LENGTH_CHIPS));
@@ -82,6 +84,7 @@ GpsL1CaTcpConnectorTracking::GpsL1CaTcpConnectorTracking(
                     dump_filename,
                     early_late_space_chips,
                     port_ch0);
+            tracking_->set_pipelined_loop(pipelined_loop);
         }
     else
         {
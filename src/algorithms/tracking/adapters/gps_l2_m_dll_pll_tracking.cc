@@ -55,28 +55,29 @@ GpsL2MDllPllTracking::GpsL2MDllPllTracking(
     int f_if;
     bool dump;
     std::string dump_filename;
-    std::string item_type;
     std::string default_item_type = "gr_complex";
     float pll_bw_hz;
     float dll_bw_hz;
     float early_late_space_chips;
-    item_type = configuration->property(role + ".item_type", default_item_type);
+    item_type_ = configuration->property(role + ".item_type", default_item_type);
     fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
     f_if = configuration->property(role + ".if", 0);
     dump = configuration->property(role + ".dump", false);
     pll_bw_hz = configuration->property(role + ".pll_bw_hz", 50.0);
     dll_bw_hz = configuration->property(role + ".dll_bw_hz", 2.0);
     early_late_space_chips = configuration->property(role + ".early_late_space_chips", 0.5);
+    bool l1_aiding = configuration->property(role + ".l1_aiding", false);
+    unsigned int l1_aiding_max_age_ms = configuration->property(role + ".l1_aiding_max_age_ms", 1000);
     std::string default_dump_filename = "./track_ch";
     dump_filename = configuration->property(role + ".dump_filename",
             default_dump_filename); //unused!
     vector_length = std::round(fs_in / (GPS_L2_M_CODE_RATE_HZ / GPS_L2_M_CODE_LENGTH_CHIPS));
 
     //################# MAKE TRACKING GNURadio object ###################
-    if (item_type.compare("gr_complex") == 0)
+    if (item_type_.compare("gr_complex") == 0)
         {
             item_size_ = sizeof(gr_complex);
-            tracking_ = gps_l2_m_dll_pll_make_tracking_cc(
+            tracking_cc = gps_l2_m_dll_pll_make_tracking_cc(
                     f_if,
                     fs_in,
                     vector_length,
@@ -85,14 +86,30 @@ GpsL2MDllPllTracking::GpsL2MDllPllTracking(
                     pll_bw_hz,
                     dll_bw_hz,
                     early_late_space_chips);
+            tracking_cc->set_l1_aiding(l1_aiding, l1_aiding_max_age_ms);
+            DLOG(INFO) << "tracking(" << tracking_cc->unique_id() << ")";
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            item_size_ = sizeof(lv_16sc_t);
+            tracking_sc = gps_l2_m_dll_pll_make_tracking_sc(
+                    f_if,
+                    fs_in,
+                    vector_length,
+                    dump,
+                    dump_filename,
+                    pll_bw_hz,
+                    dll_bw_hz,
+                    early_late_space_chips);
+            tracking_sc->set_l1_aiding(l1_aiding, l1_aiding_max_age_ms);
+            DLOG(INFO) << "tracking(" << tracking_sc->unique_id() << ")";
         }
     else
         {
             item_size_ = sizeof(gr_complex);
-            LOG(WARNING) << item_type << " unknown tracking item type.";
+            LOG(WARNING) << item_type_ << " unknown tracking item type.";
         }
     channel_ = 0;
-    DLOG(INFO) << "tracking(" << tracking_->unique_id() << ")";
 }
 
 
@@ -101,12 +118,34 @@ GpsL2MDllPllTracking::~GpsL2MDllPllTracking()
 
 void GpsL2MDllPllTracking::stop_tracking()
 {
-    tracking_->stop_tracking();
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            tracking_cc->stop_tracking();
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            tracking_sc->stop_tracking();
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+        }
 }
 
 void GpsL2MDllPllTracking::start_tracking()
 {
-    tracking_->start_tracking();
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            tracking_cc->start_tracking();
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            tracking_sc->start_tracking();
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+        }
 }
 
 /*
@@ -115,13 +154,35 @@ void GpsL2MDllPllTracking::start_tracking()
 void GpsL2MDllPllTracking::set_channel(unsigned int channel)
 {
     channel_ = channel;
-    tracking_->set_channel(channel);
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            tracking_cc->set_channel(channel);
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            tracking_sc->set_channel(channel);
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+        }
 }
 
 
 void GpsL2MDllPllTracking::set_gnss_synchro(Gnss_Synchro* p_gnss_synchro)
 {
-    tracking_->set_gnss_synchro(p_gnss_synchro);
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            tracking_cc->set_gnss_synchro(p_gnss_synchro);
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            tracking_sc->set_gnss_synchro(p_gnss_synchro);
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+        }
 }
 
 void GpsL2MDllPllTracking::connect(gr::top_block_sptr top_block)
@@ -138,11 +199,35 @@ void GpsL2MDllPllTracking::disconnect(gr::top_block_sptr top_block)
 
 gr::basic_block_sptr GpsL2MDllPllTracking::get_left_block()
 {
-    return tracking_;
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            return tracking_cc;
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            return tracking_sc;
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+            return nullptr;
+        }
 }
 
 gr::basic_block_sptr GpsL2MDllPllTracking::get_right_block()
 {
-    return tracking_;
+    if (item_type_.compare("gr_complex") == 0)
+        {
+            return tracking_cc;
+        }
+    else if (item_type_.compare("cshort") == 0)
+        {
+            return tracking_sc;
+        }
+    else
+        {
+            LOG(WARNING) << item_type_ << " unknown tracking item type";
+            return nullptr;
+        }
 }
 
@@ -35,6 +35,7 @@
  */
 
 #include "galileo_e1_dll_pll_veml_tracking_cc.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <memory>
@@ -44,10 +45,13 @@
 #include <glog/logging.h>
 #include <volk/volk.h>
 #include "galileo_e1_signal_processing.h"
+#include "code_bank.h"
 #include "tracking_discriminators.h"
 #include "lock_detectors.h"
 #include "Galileo_E1.h"
+#include "tracking_signal.h"
 #include "control_message_factory.h"
+#include "channel_event.h"
 
 
 
@@ -62,6 +66,36 @@
 
 using google::LogMessage;
 
+namespace
+{
+Dump_Schema tracking_block_dump_schema()
+{
+    Dump_Schema schema("galileo_e1_dll_pll_veml_tracking_cc");
+    schema.add<float>("abs_VE")
+          .add<float>("abs_E")
+          .add<float>("abs_P")
+          .add<float>("abs_L")
+          .add<float>("abs_VL")
+          .add<float>("prompt_I")
+          .add<float>("prompt_Q")
+          .add<unsigned long int>("PRN_start_sample")
+          .add<float>("acc_carrier_phase_rad")
+          .add<float>("carrier_doppler_hz")
+          .add<float>("code_freq_chips")
+          .add<float>("carr_error_hz")
+          .add<float>("carr_nco_hz")
+          .add<float>("code_error_chips")
+          .add<float>("code_nco_chips")
+          .add<float>("CN0_SNV_dB_Hz")
+          .add<float>("carrier_lock_test")
+          .add<float>("rem_code_phase_samples")
+          .add<double>("next_PRN_start_sample");
+    return schema;
+}
+}
+
+typedef Tracking_Nco<Galileo_E1_Signal> E1_Nco;
+
 galileo_e1_dll_pll_veml_tracking_cc_sptr
 galileo_e1_dll_pll_veml_make_tracking_cc(
         long if_freq,
@@ -122,6 +156,8 @@ galileo_e1_dll_pll_veml_tracking_cc::galileo_e1_dll_pll_veml_tracking_cc(
     // Set bandwidth of code and carrier loop filters
     d_code_loop_filter.set_DLL_BW(dll_bw_hz);
     d_carrier_loop_filter.set_PLL_BW(pll_bw_hz);
+    d_pll_bw_hz = pll_bw_hz;
+    d_dll_bw_hz = dll_bw_hz;
 
     // Correlator spacing
     d_early_late_spc_chips = early_late_space_chips; // Define early-late offset (in chips)
@@ -132,7 +168,7 @@ galileo_e1_dll_pll_veml_tracking_cc::galileo_e1_dll_pll_veml_tracking_cc(
     d_ca_code = static_cast<gr_complex*>(volk_malloc((2 * Galileo_E1_B_CODE_LENGTH_CHIPS) * sizeof(gr_complex), volk_get_alignment()));
 
     // correlator outputs (scalar)
-    d_n_correlator_taps = 5; // Very-Early, Early, Prompt, Late, Very-Late
+    d_n_correlator_taps = Galileo_E1_Signal::n_taps; // Very-Early, Early, Prompt, Late, Very-Late
     d_correlator_outs = static_cast<gr_complex*>(volk_malloc(d_n_correlator_taps * sizeof(gr_complex), volk_get_alignment()));
     for (int n = 0; n < d_n_correlator_taps; n++)
         {
@@ -147,11 +183,7 @@ galileo_e1_dll_pll_veml_tracking_cc::galileo_e1_dll_pll_veml_tracking_cc(
 
     d_local_code_shift_chips = static_cast<float*>(volk_malloc(d_n_correlator_taps * sizeof(float), volk_get_alignment()));
     // Set TAPs delay values [chips]
-    d_local_code_shift_chips[0] = - d_very_early_late_spc_chips * 2.0;
-    d_local_code_shift_chips[1] = - d_very_early_late_spc_chips;
-    d_local_code_shift_chips[2] = 0.0;
-    d_local_code_shift_chips[3] = d_very_early_late_spc_chips;
-    d_local_code_shift_chips[4] = d_very_early_late_spc_chips * 2.0;
+    E1_Nco::tap_shifts(d_very_early_late_spc_chips, d_local_code_shift_chips);
 
     d_correlation_length_samples = d_vector_length;
 
@@ -197,8 +229,53 @@ galileo_e1_dll_pll_veml_tracking_cc::galileo_e1_dll_pll_veml_tracking_cc(
     d_carrier_doppler_hz = 0.0;
     d_acc_carrier_phase_rad = 0.0;
     d_acc_code_phase_secs = 0.0;
+
+    // E1B data tracking, until set_pilot_tracking
+    d_track_pilot = false;
+    d_extend_periods = 1;
+    d_pll_bw_narrow_hz = pll_bw_hz;
+    d_dll_bw_narrow_hz = dll_bw_hz;
+    d_data_code = 0;
+    d_Prompt_data = static_cast<gr_complex*>(volk_malloc(sizeof(gr_complex), volk_get_alignment()));
+    *d_Prompt_data = gr_complex(0,0);
+    d_secondary_sync = Secondary_Code_Sync(Galileo_E1_C_SECONDARY_CODE);
+    d_correlator_sums = static_cast<gr_complex*>(volk_malloc(d_n_correlator_taps * sizeof(gr_complex), volk_get_alignment()));
+    d_integrated_periods = 0;
+    d_carr_error_filt_hz = 0.0;
+    d_code_error_filt_chips = 0.0;
+}
+
+
+void galileo_e1_dll_pll_veml_tracking_cc::set_pilot_tracking(bool track_pilot, int extend_correlation_ms, float pll_bw_narrow_hz, float dll_bw_narrow_hz)
+{
+    int code_period_ms = static_cast<int>(Galileo_E1_CODE_PERIOD * 1000.0);
+    int max_ms = code_period_ms * static_cast<int>(Galileo_E1_C_SECONDARY_CODE_LENGTH);
+    if (extend_correlation_ms < code_period_ms or extend_correlation_ms > max_ms or extend_correlation_ms % code_period_ms != 0)
+        {
+            LOG(WARNING) << "extend_correlation_ms must be a multiple of " << code_period_ms << " up to " << max_ms
+                         << ", using " << code_period_ms << " instead of " << extend_correlation_ms;
+            extend_correlation_ms = code_period_ms;
+        }
+    d_track_pilot = track_pilot;
+    d_extend_periods = extend_correlation_ms / code_period_ms;
+    d_pll_bw_narrow_hz = pll_bw_narrow_hz;
+    d_dll_bw_narrow_hz = dll_bw_narrow_hz;
+
+    multicorrelator_cpu_data.free();
+    if (d_data_code != 0)
+        {
+            volk_free(d_data_code);
+            d_data_code = 0;
+        }
+    if (d_track_pilot)
+        {
+            // the E1B prompt is the only tap of the data correlator
+            d_data_code = static_cast<gr_complex*>(volk_malloc((2 * Galileo_E1_B_CODE_LENGTH_CHIPS) * sizeof(gr_complex), volk_get_alignment()));
+            multicorrelator_cpu_data.init(2 * d_correlation_length_samples, 1);
+        }
 }
 
+
 void galileo_e1_dll_pll_veml_tracking_cc::stop_tracking()
 {
     d_enable_tracking = false;
@@ -214,13 +291,34 @@ void galileo_e1_dll_pll_veml_tracking_cc::start_tracking()
     d_carrier_loop_filter.initialize(); // initialize the carrier filter
     d_code_loop_filter.initialize();    // initialize the code filter
 
+    d_carrier_loop_filter.set_pdi(Galileo_E1_CODE_PERIOD);
+    d_carrier_loop_filter.set_PLL_BW(d_pll_bw_hz);
+    d_code_loop_filter.set_pdi(Galileo_E1_CODE_PERIOD);
+    d_code_loop_filter.set_DLL_BW(d_dll_bw_hz);
+
     // generate local reference ALWAYS starting at chip 1 (2 samples per chip)
-    galileo_e1_code_gen_complex_sampled(d_ca_code,
-                                        d_acquisition_gnss_synchro->Signal,
-                                        false,
-                                        d_acquisition_gnss_synchro->PRN,
-                                        2 * Galileo_E1_CODE_CHIP_RATE_HZ,
-                                        0);
+    if (d_track_pilot)
+        {
+            Code_Bank::galileo_e1_code_gen_complex_sampled(d_ca_code, "1C", false, d_acquisition_gnss_synchro->PRN, 2 * Galileo_E1_CODE_CHIP_RATE_HZ, 0);
+            // E1C enters the signal with the opposite sign of E1B, so that a pilot
+            // locked in phase with this replica leaves the E1B symbols in phase too
+            for (int i = 0; i < static_cast<int>(2 * Galileo_E1_B_CODE_LENGTH_CHIPS); i++)
+                {
+                    d_ca_code[i] = -d_ca_code[i];
+                }
+            Code_Bank::galileo_e1_code_gen_complex_sampled(d_data_code, "1B", false, d_acquisition_gnss_synchro->PRN, 2 * Galileo_E1_CODE_CHIP_RATE_HZ, 0);
+            multicorrelator_cpu_data.set_local_code_and_taps(static_cast<int>(2 * Galileo_E1_B_CODE_LENGTH_CHIPS), d_data_code,
+                    &d_local_code_shift_chips[Galileo_E1_Signal::prompt_tap]);
+        }
+    else
+        {
+            Code_Bank::galileo_e1_code_gen_complex_sampled(d_ca_code,
+                                                           d_acquisition_gnss_synchro->Signal,
+                                                           false,
+                                                           d_acquisition_gnss_synchro->PRN,
+                                                           2 * Galileo_E1_CODE_CHIP_RATE_HZ,
+                                                           0);
+        }
 
     multicorrelator_cpu.set_local_code_and_taps(static_cast<int>(2 * Galileo_E1_B_CODE_LENGTH_CHIPS), d_ca_code, d_local_code_shift_chips);
     for (int n = 0; n < d_n_correlator_taps; n++)
@@ -228,6 +326,12 @@ void galileo_e1_dll_pll_veml_tracking_cc::start_tracking()
             d_correlator_outs[n] = gr_complex(0,0);
         }
 
+    *d_Prompt_data = gr_complex(0,0);
+    d_secondary_sync.reset();
+    d_integrated_periods = 0;
+    d_carr_error_filt_hz = 0.0;
+    d_code_error_filt_chips = 0.0;
+
     d_carrier_lock_fail_counter = 0;
     d_rem_code_phase_samples = 0.0;
     d_rem_carr_phase_rad = 0.0;
@@ -259,9 +363,16 @@ galileo_e1_dll_pll_veml_tracking_cc::~galileo_e1_dll_pll_veml_tracking_cc()
     volk_free(d_local_code_shift_chips);
     volk_free(d_correlator_outs);
     volk_free(d_ca_code);
+    volk_free(d_Prompt_data);
+    volk_free(d_correlator_sums);
+    if (d_data_code != 0)
+        {
+            volk_free(d_data_code);
+        }
 
     delete[] d_Prompt_buffer;
     multicorrelator_cpu.free();
+    multicorrelator_cpu_data.free();
 }
 
 
@@ -307,96 +418,169 @@ int galileo_e1_dll_pll_veml_tracking_cc::general_work (int noutput_items __attri
             // perform carrier wipe-off and compute Early, Prompt and Late correlation
             multicorrelator_cpu.set_input_output_vectors(d_correlator_outs,in);
 
-            double carr_phase_step_rad = GALILEO_TWO_PI * d_carrier_doppler_hz / static_cast<double>(d_fs_in);
-            double code_phase_step_half_chips = (2.0 * d_code_freq_chips) / (static_cast<double>(d_fs_in));
-            double rem_code_phase_half_chips = d_rem_code_phase_samples * (2.0*d_code_freq_chips / d_fs_in);
+            double carr_phase_step_rad = E1_Nco::carrier_phase_step_rad(d_carrier_doppler_hz, d_fs_in);
+            double code_phase_step_half_chips = E1_Nco::code_phase_step(d_code_freq_chips, d_fs_in);
+            double rem_code_phase_half_chips = E1_Nco::rem_code_phase(d_rem_code_phase_samples, d_code_freq_chips, d_fs_in);
             multicorrelator_cpu.Carrier_wipeoff_multicorrelator_resampler(
                     d_rem_carr_phase_rad,
                     carr_phase_step_rad,
                     rem_code_phase_half_chips,
                     code_phase_step_half_chips,
                     d_correlation_length_samples);
+            if (d_track_pilot)
+                {
+                    // E1B prompt for the telemetry decoder
+                    multicorrelator_cpu_data.set_input_output_vectors(d_Prompt_data, in);
+                    multicorrelator_cpu_data.Carrier_wipeoff_multicorrelator_resampler(
+                            d_rem_carr_phase_rad,
+                            carr_phase_step_rad,
+                            rem_code_phase_half_chips,
+                            code_phase_step_half_chips,
+                            d_correlation_length_samples);
+                }
+
+            // ################## PILOT SECONDARY CODE AND COHERENT INTEGRATION ################
+            // once the secondary code of the pilot is found, it is stripped from the taps,
+            // and the loops are closed once per d_extend_periods code periods
+            const gr_complex* loop_outs = d_correlator_outs;
+            int integration_periods = 1;
+            bool close_loops = true;
+            bool secondary_stripped = d_track_pilot and d_secondary_sync.locked();
+            bool secondary_found = false;
+            if (secondary_stripped)
+                {
+                    float chip_sign = d_secondary_sync.next_sign();
+                    for (int n = 0; n < d_n_correlator_taps; n++)
+                        {
+                            d_correlator_sums[n] = (d_integrated_periods == 0) ? d_correlator_outs[n] * chip_sign : d_correlator_sums[n] + d_correlator_outs[n] * chip_sign;
+                        }
+                    d_integrated_periods++;
+                    if (d_integrated_periods == d_extend_periods)
+                        {
+                            loop_outs = d_correlator_sums;
+                            integration_periods = d_extend_periods;
+                            d_integrated_periods = 0;
+                        }
+                    else
+                        {
+                            // the NCOs keep the last loop commands
+                            close_loops = false;
+                        }
+                }
+            else if (d_track_pilot)
+                {
+                    secondary_found = d_secondary_sync.add(*d_Prompt);
+                }
 
             // ################## PLL ##########################################################
-            // PLL discriminator
-            carr_error_hz = pll_cloop_two_quadrant_atan(*d_Prompt) / GALILEO_TWO_PI;
-            // Carrier discriminator filter
-            carr_error_filt_hz = d_carrier_loop_filter.get_carrier_nco(carr_error_hz);
+            if (close_loops)
+                {
+                    // PLL discriminator, the stripped pilot has no sign changes left
+                    if (secondary_stripped)
+                        {
+                            carr_error_hz = pll_four_quadrant_atan(loop_outs[Galileo_E1_Signal::prompt_tap]) / GALILEO_TWO_PI;
+                        }
+                    else
+                        {
+                            carr_error_hz = pll_cloop_two_quadrant_atan(loop_outs[Galileo_E1_Signal::prompt_tap]) / GALILEO_TWO_PI;
+                        }
+                    // Carrier discriminator filter
+                    d_carr_error_filt_hz = d_carrier_loop_filter.get_carrier_nco(carr_error_hz);
+                }
+            carr_error_filt_hz = d_carr_error_filt_hz;
             // New carrier Doppler frequency estimation
             d_carrier_doppler_hz = d_acq_carrier_doppler_hz + carr_error_filt_hz;
             // New code Doppler frequency estimation
-            d_code_freq_chips = Galileo_E1_CODE_CHIP_RATE_HZ + ((d_carrier_doppler_hz * Galileo_E1_CODE_CHIP_RATE_HZ) / Galileo_E1_FREQ_HZ);
+            d_code_freq_chips = E1_Nco::code_freq_chips(d_carrier_doppler_hz);
             //carrier phase accumulator for (K) Doppler estimation-
             d_acc_carrier_phase_rad -= GALILEO_TWO_PI * d_carrier_doppler_hz * static_cast<double>(d_current_prn_length_samples) / static_cast<double>(d_fs_in);
             //remnant carrier phase to prevent overflow in the code NCO
             d_rem_carr_phase_rad = d_rem_carr_phase_rad + GALILEO_TWO_PI * d_carrier_doppler_hz * static_cast<double>(d_current_prn_length_samples) / static_cast<double>(d_fs_in);
-            d_rem_carr_phase_rad = std::fmod(d_rem_carr_phase_rad, GALILEO_TWO_PI);
+            d_rem_carr_phase_rad = E1_Nco::wrap_phase_rad(d_rem_carr_phase_rad);
 
             // ################## DLL ##########################################################
-            // DLL discriminator
-            code_error_chips = dll_nc_vemlp_normalized(*d_Very_Early, *d_Early, *d_Late, *d_Very_Late); //[chips/Ti]
-            // Code discriminator filter
-            code_error_filt_chips = d_code_loop_filter.get_code_nco(code_error_chips); //[chips/second]
+            if (close_loops)
+                {
+                    // DLL discriminator
+                    code_error_chips = dll_nc_vemlp_normalized(loop_outs[0], loop_outs[1], loop_outs[3], loop_outs[4]); //[chips/Ti]
+                    // Code discriminator filter
+                    d_code_error_filt_chips = d_code_loop_filter.get_code_nco(code_error_chips); //[chips/second]
+                }
+            code_error_filt_chips = d_code_error_filt_chips;
             //Code phase accumulator
             double code_error_filt_secs;
-            code_error_filt_secs = (Galileo_E1_CODE_PERIOD * code_error_filt_chips) / Galileo_E1_CODE_CHIP_RATE_HZ; //[seconds]
+            code_error_filt_secs = E1_Nco::code_error_secs(code_error_filt_chips); //[seconds]
             //code_error_filt_secs=T_prn_seconds*code_error_filt_chips*T_chip_seconds*static_cast<float>(d_fs_in); //[seconds]
             d_acc_code_phase_secs = d_acc_code_phase_secs  + code_error_filt_secs;
 
             // ################## CARRIER AND CODE NCO BUFFER ALIGNEMENT #######################
             // keep alignment parameters for the next input buffer
-            double T_chip_seconds;
-            double T_prn_seconds;
-            double T_prn_samples;
-            double K_blk_samples;
             // Compute the next buffer length based in the new period of the PRN sequence and the code phase error estimation
-            T_chip_seconds = 1.0 / d_code_freq_chips;
-            T_prn_seconds = T_chip_seconds * Galileo_E1_B_CODE_LENGTH_CHIPS;
-            T_prn_samples = T_prn_seconds * static_cast<double>(d_fs_in);
-            K_blk_samples = T_prn_samples + d_rem_code_phase_samples + code_error_filt_secs * static_cast<double>(d_fs_in);
+            double K_blk_samples = E1_Nco::next_period_samples(d_code_freq_chips, d_rem_code_phase_samples, code_error_filt_secs, d_fs_in);
             d_current_prn_length_samples = std::round(K_blk_samples); //round to a discrete samples
             //d_rem_code_phase_samples = K_blk_samples - d_current_prn_length_samples; //rounding error < 1 sample
 
             // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
-            if (d_cn0_estimation_counter < CN0_ESTIMATION_SAMPLES)
+            // they run at the rate of the loops, on the integrated prompt outputs
+            if (close_loops and d_cn0_estimation_counter < CN0_ESTIMATION_SAMPLES)
                 {
                     // fill buffer with prompt correlator output values
-                    d_Prompt_buffer[d_cn0_estimation_counter] = *d_Prompt;
+                    d_Prompt_buffer[d_cn0_estimation_counter] = loop_outs[Galileo_E1_Signal::prompt_tap];
                     d_cn0_estimation_counter++;
                 }
-            else
+            else if (close_loops)
                 {
                     d_cn0_estimation_counter = 0;
 
                     // Code lock indicator
-                    d_CN0_SNV_dB_Hz = cn0_svn_estimator(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in, Galileo_E1_B_CODE_LENGTH_CHIPS);
+                    d_CN0_SNV_dB_Hz = cn0_svn_estimator(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in, integration_periods * Galileo_E1_B_CODE_LENGTH_CHIPS);
 
                     // Carrier lock indicator
                     d_carrier_lock_test = carrier_lock_detector(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES);
 
-                    // Loss of lock detection
+                    // Loss of lock detection, a check of integrated outputs counts once per code period
                     if (d_carrier_lock_test < d_carrier_lock_threshold or d_CN0_SNV_dB_Hz < MINIMUM_VALID_CN0)
                         {
-                            d_carrier_lock_fail_counter++;
+                            d_carrier_lock_fail_counter += integration_periods;
                         }
                     else
                         {
-                            if (d_carrier_lock_fail_counter > 0) d_carrier_lock_fail_counter--;
+                            d_carrier_lock_fail_counter = std::max(d_carrier_lock_fail_counter - integration_periods, 0);
                         }
                     if (d_carrier_lock_fail_counter > MAXIMUM_LOCK_FAIL_COUNTER)
                         {
                             std::cout << "Loss of lock in channel " << d_channel << "!" << std::endl;
                             LOG(INFO) << "Loss of lock in channel " << d_channel << "!";
-                            this->message_port_pub(pmt::mp("events"), pmt::from_long(3));//3 -> loss of lock
+                            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_LOSS_OF_LOCK));
                             d_carrier_lock_fail_counter = 0;
                             d_enable_tracking = false; // TODO: check if disabling tracking is consistent with the channel state machine
                         }
                 }
+            if (secondary_found)
+                {
+                    if (d_secondary_sync.polarity() < 0)
+                        {
+                            // the PLL settled half a cycle off
+                            d_rem_carr_phase_rad = E1_Nco::wrap_phase_rad(d_rem_carr_phase_rad + GALILEO_PI);
+                            d_acc_carrier_phase_rad -= GALILEO_PI;
+                        }
+                    d_integrated_periods = 0;
+                    d_cn0_estimation_counter = 0;
+                    d_carrier_loop_filter.set_pdi(static_cast<double>(d_extend_periods) * Galileo_E1_CODE_PERIOD);
+                    d_carrier_loop_filter.set_PLL_BW(d_pll_bw_narrow_hz);
+                    d_code_loop_filter.set_pdi(static_cast<double>(d_extend_periods) * Galileo_E1_CODE_PERIOD);
+                    d_code_loop_filter.set_DLL_BW(d_dll_bw_narrow_hz);
+                    LOG(INFO) << "E1C secondary code found for CH " << d_channel << " : Satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN)
+                              << ", " << d_extend_periods * Galileo_E1_CODE_PERIOD * 1000.0 << " [ms] coherent integration, pll_narrow_bw = " << d_pll_bw_narrow_hz
+                              << " [Hz], dll_narrow_bw = " << d_dll_bw_narrow_hz << " [Hz]";
+                }
 
             // ########### Output the tracking results to Telemetry block ##########
 
-            current_synchro_data.Prompt_I = static_cast<double>((*d_Prompt).real());
-            current_synchro_data.Prompt_Q = static_cast<double>((*d_Prompt).imag());
+            // the symbols are on the E1B prompt
+            const gr_complex& symbol_prompt = d_track_pilot ? *d_Prompt_data : *d_Prompt;
+            current_synchro_data.Prompt_I = static_cast<double>(symbol_prompt.real());
+            current_synchro_data.Prompt_Q = static_cast<double>(symbol_prompt.imag());
             // Tracking_timestamp_secs is aligned with the CURRENT PRN start sample (Hybridization OK!)
             current_synchro_data.Tracking_timestamp_secs = (static_cast<double>(d_sample_counter) + static_cast<double>(d_rem_code_phase_samples)) / static_cast<double>(d_fs_in);
             //compute remnant code phase samples AFTER the Tracking timestamp
@@ -431,62 +615,42 @@ int galileo_e1_dll_pll_veml_tracking_cc::general_work (int noutput_items __attri
             float prompt_I;
             float prompt_Q;
             float tmp_VE, tmp_E, tmp_P, tmp_L, tmp_VL;
-            float tmp_float;
-            double tmp_double;
-            prompt_I = (*d_Prompt).real();
-            prompt_Q = (*d_Prompt).imag();
+            prompt_I = d_track_pilot ? (*d_Prompt_data).real() : (*d_Prompt).real();
+            prompt_Q = d_track_pilot ? (*d_Prompt_data).imag() : (*d_Prompt).imag();
             tmp_VE = std::abs<float>(*d_Very_Early);
             tmp_E = std::abs<float>(*d_Early);
             tmp_P = std::abs<float>(*d_Prompt);
             tmp_L = std::abs<float>(*d_Late);
             tmp_VL = std::abs<float>(*d_Very_Late);
 
-            try
-            {
-                    // Dump correlators output
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_VE), sizeof(float));
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_E), sizeof(float));
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_P), sizeof(float));
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_L), sizeof(float));
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_VL), sizeof(float));
-                    // PROMPT I and Q (to analyze navigation symbols)
-                    d_dump_file.write(reinterpret_cast<char*>(&prompt_I), sizeof(float));
-                    d_dump_file.write(reinterpret_cast<char*>(&prompt_Q), sizeof(float));
-                    // PRN start sample stamp
-                    d_dump_file.write(reinterpret_cast<char*>(&d_sample_counter), sizeof(unsigned long int));
-                    // accumulated carrier phase
-                    tmp_float = d_acc_carrier_phase_rad;
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_float), sizeof(float));
-                    // carrier and code frequency
-                    tmp_float = d_carrier_doppler_hz;
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_float), sizeof(float));
-                    tmp_float = d_code_freq_chips;
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_float), sizeof(float));
-                    //PLL commands
-                    tmp_float = carr_error_hz;
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_float), sizeof(float));
-                    tmp_float = carr_error_filt_hz;
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_float), sizeof(float));
-                    //DLL commands
-                    tmp_float = code_error_chips;
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_float), sizeof(float));
-                    tmp_float = code_error_filt_chips;
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_float), sizeof(float));
-                    // CN0 and carrier lock test
-                    tmp_float = d_CN0_SNV_dB_Hz;
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_float), sizeof(float));
-                    tmp_float = d_carrier_lock_test;
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_float), sizeof(float));
-                    // AUX vars (for debug purposes)
-                    tmp_float = d_rem_code_phase_samples;
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_float), sizeof(float));
-                    tmp_double = static_cast<double>(d_sample_counter + d_current_prn_length_samples);
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_double), sizeof(double));
-            }
-            catch (const std::ifstream::failure &e)
-            {
-                    LOG(WARNING) << "Exception writing trk dump file " << e.what() << std::endl;
-            }
+            // Dump correlators output
+            d_dump_file.put<float>(tmp_VE);
+            d_dump_file.put<float>(tmp_E);
+            d_dump_file.put<float>(tmp_P);
+            d_dump_file.put<float>(tmp_L);
+            d_dump_file.put<float>(tmp_VL);
+            // PROMPT I and Q (to analyze navigation symbols)
+            d_dump_file.put<float>(prompt_I);
+            d_dump_file.put<float>(prompt_Q);
+            // PRN start sample stamp
+            d_dump_file.put<unsigned long int>(d_sample_counter);
+            // accumulated carrier phase
+            d_dump_file.put<float>(d_acc_carrier_phase_rad);
+            // carrier and code frequency
+            d_dump_file.put<float>(d_carrier_doppler_hz);
+            d_dump_file.put<float>(d_code_freq_chips);
+            //PLL commands
+            d_dump_file.put<float>(carr_error_hz);
+            d_dump_file.put<float>(carr_error_filt_hz);
+            //DLL commands
+            d_dump_file.put<float>(code_error_chips);
+            d_dump_file.put<float>(code_error_filt_chips);
+            // CN0 and carrier lock test
+            d_dump_file.put<float>(d_CN0_SNV_dB_Hz);
+            d_dump_file.put<float>(d_carrier_lock_test);
+            // AUX vars (for debug purposes)
+            d_dump_file.put<float>(d_rem_code_phase_samples);
+            d_dump_file.put<double>(static_cast<double>(d_sample_counter + d_current_prn_length_samples));
         }
     consume_each(d_current_prn_length_samples); // this is required for gr_block derivates
     d_sample_counter += d_current_prn_length_samples; //count for the processed samples
@@ -505,18 +669,16 @@ void galileo_e1_dll_pll_veml_tracking_cc::set_channel(unsigned int channel)
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
-                            d_dump_filename.append(".dat");
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                    d_dump_filename.append(".dat");
+                    if (d_dump_file.open(d_dump_filename, tracking_block_dump_schema()))
+                        {
                             LOG(INFO) << "Tracking dump enabled on channel " << d_channel << " Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (const std::ifstream::failure &e)
-                    {
-                            LOG(WARNING) << "channel " << d_channel << " Exception opening trk dump file " << e.what() << std::endl;
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << d_channel << " cannot open trk dump file " << d_dump_filename;
+                        }
                 }
         }
 }
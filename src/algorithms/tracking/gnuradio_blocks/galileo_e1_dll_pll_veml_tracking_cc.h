@@ -40,6 +40,8 @@
 #include "tracking_2nd_DLL_filter.h"
 #include "tracking_2nd_PLL_filter.h"
 #include "cpu_multicorrelator.h"
+#include "secondary_code_sync.h"
+#include "dump_writer.h"
 
 class galileo_e1_dll_pll_veml_tracking_cc;
 
@@ -70,6 +72,28 @@ public:
     void start_tracking();
     void stop_tracking();
 
+    /*!
+     * \brief Reuses up to max_sets resampled code replicas whose code phase is
+     * within tolerance_chips of the exact one, see cpu_multicorrelator::set_replica_cache
+     */
+    void set_replica_cache(unsigned int max_sets, float tolerance_chips)
+    {
+        multicorrelator_cpu.set_replica_cache(max_sets, tolerance_chips);
+        multicorrelator_cpu_data.set_replica_cache(max_sets, tolerance_chips);
+    }
+
+    /*!
+     * \brief Tracks the E1C pilot instead of the E1B data component
+     *
+     * The taps correlate the E1C code, and a single prompt the E1B code for
+     * the symbols of the telemetry decoder. Once the signs of the E1C prompts
+     * match its 25 chip secondary code, the code is stripped, and
+     * extend_correlation_ms (a multiple of the 4 ms code period, up to 100)
+     * are integrated coherently before the loops, with the narrow
+     * bandwidths, are closed.
+     */
+    void set_pilot_tracking(bool track_pilot, int extend_correlation_ms, float pll_bw_narrow_hz, float dll_bw_narrow_hz);
+
     /*!
      * \brief Code DLL + carrier PLL according to the algorithms described in:
      * K.Borre, D.M.Akos, N.Bertelsen, P.Rinder, and S.H.Jensen,
@@ -132,6 +156,22 @@ private:
     gr_complex *d_Late;
     gr_complex *d_Very_Late;
 
+    // E1C pilot tracking
+    bool d_track_pilot;
+    int d_extend_periods;
+    float d_pll_bw_hz;
+    float d_dll_bw_hz;
+    float d_pll_bw_narrow_hz;
+    float d_dll_bw_narrow_hz;
+    gr_complex* d_data_code;
+    gr_complex* d_Prompt_data;
+    cpu_multicorrelator multicorrelator_cpu_data;
+    Secondary_Code_Sync d_secondary_sync;
+    gr_complex* d_correlator_sums;
+    int d_integrated_periods;
+    double d_carr_error_filt_hz;
+    double d_code_error_filt_chips;
+
     // remaining code phase and carrier phase between tracking loops
     double d_rem_code_phase_samples;
     double d_rem_carr_phase_rad;
@@ -171,7 +211,7 @@ private:
 
     // file dump
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
 
     std::map<std::string, std::string> systemName;
     std::string sys;
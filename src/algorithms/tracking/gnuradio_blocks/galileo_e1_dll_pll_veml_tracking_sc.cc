@@ -0,0 +1,547 @@
+/*!
+ * \file galileo_e1_dll_pll_veml_tracking_sc.cc
+ * \brief Implementation of a code DLL + carrier PLL VEML (Very Early
+ *  Minus Late) tracking block for Galileo E1 signals with 16-bit integer
+ *  complex input samples
+ * \author Luis Esteve, 2012. luis(at)epsilon-formacion.com
+ *
+ * Code DLL + carrier PLL according to the algorithms described in:
+ * [1] K.Borre, D.M.Akos, N.Bertelsen, P.Rinder, and S.H.Jensen,
+ * A Software-Defined GPS and Galileo Receiver. A Single-Frequency
+ * Approach, Birkhauser, 2007
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "galileo_e1_dll_pll_veml_tracking_sc.h"
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <boost/lexical_cast.hpp>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+#include <volk/volk.h>
+#include <volk_gnsssdr/volk_gnsssdr.h>
+#include "galileo_e1_signal_processing.h"
+#include "code_bank.h"
+#include "tracking_discriminators.h"
+#include "lock_detectors.h"
+#include "Galileo_E1.h"
+#include "control_message_factory.h"
+#include "channel_event.h"
+
+
+
+/*!
+ * \todo Include in definition header file
+ */
+#define CN0_ESTIMATION_SAMPLES 20
+#define MINIMUM_VALID_CN0 25
+#define MAXIMUM_LOCK_FAIL_COUNTER 50
+#define CARRIER_LOCK_THRESHOLD 0.85
+
+
+using google::LogMessage;
+
+namespace
+{
+Dump_Schema tracking_block_dump_schema()
+{
+    Dump_Schema schema("galileo_e1_dll_pll_veml_tracking_sc");
+    schema.add<float>("abs_VE")
+          .add<float>("abs_E")
+          .add<float>("abs_P")
+          .add<float>("abs_L")
+          .add<float>("abs_VL")
+          .add<float>("prompt_I")
+          .add<float>("prompt_Q")
+          .add<unsigned long int>("PRN_start_sample")
+          .add<float>("acc_carrier_phase_rad")
+          .add<float>("carrier_doppler_hz")
+          .add<float>("code_freq_chips")
+          .add<float>("carr_error_hz")
+          .add<float>("carr_nco_hz")
+          .add<float>("code_error_chips")
+          .add<float>("code_nco_chips")
+          .add<float>("CN0_SNV_dB_Hz")
+          .add<float>("carrier_lock_test")
+          .add<float>("rem_code_phase_samples")
+          .add<double>("next_PRN_start_sample");
+    return schema;
+}
+}
+
+galileo_e1_dll_pll_veml_tracking_sc_sptr
+galileo_e1_dll_pll_veml_make_tracking_sc(
+        long if_freq,
+        long fs_in,
+        unsigned int vector_length,
+        bool dump,
+        std::string dump_filename,
+        float pll_bw_hz,
+        float dll_bw_hz,
+        float early_late_space_chips,
+        float very_early_late_space_chips)
+{
+    return galileo_e1_dll_pll_veml_tracking_sc_sptr(new galileo_e1_dll_pll_veml_tracking_sc(if_freq,
+            fs_in, vector_length, dump, dump_filename, pll_bw_hz, dll_bw_hz, early_late_space_chips, very_early_late_space_chips));
+}
+
+
+void galileo_e1_dll_pll_veml_tracking_sc::forecast (int noutput_items,
+        gr_vector_int &ninput_items_required)
+{
+    if (noutput_items != 0)
+        {
+            ninput_items_required[0] = static_cast<int>(d_vector_length) * 2; //set the required available samples in each call
+        }
+}
+
+
+galileo_e1_dll_pll_veml_tracking_sc::galileo_e1_dll_pll_veml_tracking_sc(
+        long if_freq,
+        long fs_in,
+        unsigned int vector_length,
+        bool dump,
+        std::string dump_filename,
+        float pll_bw_hz,
+        float dll_bw_hz,
+        float early_late_space_chips,
+        float very_early_late_space_chips):
+        gr::block("galileo_e1_dll_pll_veml_tracking_sc", gr::io_signature::make(1, 1, sizeof(lv_16sc_t)),
+                gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)))
+{
+    // Telemetry bit synchronization message port input
+    this->message_port_register_in(pmt::mp("preamble_timestamp_s"));
+    this->set_relative_rate(1.0 / vector_length);
+
+    this->message_port_register_out(pmt::mp("events"));
+
+    // initialize internal vars
+    d_dump = dump;
+    d_if_freq = if_freq;
+    d_fs_in = fs_in;
+    d_vector_length = vector_length;
+    d_dump_filename = dump_filename;
+    d_code_loop_filter = Tracking_2nd_DLL_filter(Galileo_E1_CODE_PERIOD);
+    d_carrier_loop_filter = Tracking_2nd_PLL_filter(Galileo_E1_CODE_PERIOD);
+
+    // Initialize tracking  ==========================================
+
+    // Set bandwidth of code and carrier loop filters
+    d_code_loop_filter.set_DLL_BW(dll_bw_hz);
+    d_carrier_loop_filter.set_PLL_BW(pll_bw_hz);
+
+    // Correlator spacing
+    d_early_late_spc_chips = early_late_space_chips; // Define early-late offset (in chips)
+    d_very_early_late_spc_chips = very_early_late_space_chips; // Define very-early-late offset (in chips)
+
+    // Initialization of local code replica
+    // Get space for a vector with the sinboc(1,1) replica sampled 2x/chip
+    d_ca_code = static_cast<gr_complex*>(volk_malloc((2 * Galileo_E1_B_CODE_LENGTH_CHIPS) * sizeof(gr_complex), volk_get_alignment()));
+    d_ca_code_16sc = static_cast<lv_16sc_t*>(volk_malloc((2 * Galileo_E1_B_CODE_LENGTH_CHIPS) * sizeof(lv_16sc_t), volk_get_alignment()));
+
+    // correlator outputs (scalar)
+    d_n_correlator_taps = 5; // Very-Early, Early, Prompt, Late, Very-Late
+    d_correlator_outs = static_cast<gr_complex*>(volk_malloc(d_n_correlator_taps * sizeof(gr_complex), volk_get_alignment()));
+    d_correlator_outs_16sc = static_cast<lv_16sc_t*>(volk_malloc(d_n_correlator_taps * sizeof(lv_16sc_t), volk_get_alignment()));
+    for (int n = 0; n < d_n_correlator_taps; n++)
+        {
+            d_correlator_outs[n] = gr_complex(0,0);
+        }
+    // map memory pointers of correlator outputs
+    d_Very_Early = &d_correlator_outs[0];
+    d_Early = &d_correlator_outs[1];
+    d_Prompt = &d_correlator_outs[2];
+    d_Late = &d_correlator_outs[3];
+    d_Very_Late = &d_correlator_outs[4];
+
+    d_local_code_shift_chips = static_cast<float*>(volk_malloc(d_n_correlator_taps * sizeof(float), volk_get_alignment()));
+    // Set TAPs delay values [chips]
+    d_local_code_shift_chips[0] = - d_very_early_late_spc_chips * 2.0;
+    d_local_code_shift_chips[1] = - d_very_early_late_spc_chips;
+    d_local_code_shift_chips[2] = 0.0;
+    d_local_code_shift_chips[3] = d_very_early_late_spc_chips;
+    d_local_code_shift_chips[4] = d_very_early_late_spc_chips * 2.0;
+
+    d_correlation_length_samples = d_vector_length;
+
+    multicorrelator_cpu.init(2 * d_correlation_length_samples, d_n_correlator_taps);
+
+    //--- Initializations ------------------------------
+    // Initial code frequency basis of NCO
+    d_code_freq_chips = static_cast<double>(Galileo_E1_CODE_CHIP_RATE_HZ);
+    // Residual code phase (in chips)
+    d_rem_code_phase_samples = 0.0;
+    // Residual carrier phase
+    d_rem_carr_phase_rad = 0.0;
+
+    // sample synchronization
+    d_sample_counter = 0;
+    //d_sample_counter_seconds = 0;
+    d_acq_sample_stamp = 0;
+
+    d_enable_tracking = false;
+    d_pull_in = false;
+
+    d_current_prn_length_samples = static_cast<int>(d_vector_length);
+
+    // CN0 estimation and lock detector buffers
+    d_cn0_estimation_counter = 0;
+    d_Prompt_buffer = new gr_complex[CN0_ESTIMATION_SAMPLES];
+    d_carrier_lock_test = 1;
+    d_CN0_SNV_dB_Hz = 0;
+    d_carrier_lock_fail_counter = 0;
+    d_carrier_lock_threshold = CARRIER_LOCK_THRESHOLD;
+
+    systemName["E"] = std::string("Galileo");
+    *d_Very_Early = gr_complex(0,0);
+    *d_Early = gr_complex(0,0);
+    *d_Prompt = gr_complex(0,0);
+    *d_Late = gr_complex(0,0);
+    *d_Very_Late = gr_complex(0,0);
+
+    d_acquisition_gnss_synchro = 0;
+    d_channel = 0;
+    d_acq_code_phase_samples = 0.0;
+    d_acq_carrier_doppler_hz = 0.0;
+    d_carrier_doppler_hz = 0.0;
+    d_acc_carrier_phase_rad = 0.0;
+    d_acc_code_phase_secs = 0.0;
+}
+
+void galileo_e1_dll_pll_veml_tracking_sc::stop_tracking()
+{
+    d_enable_tracking = false;
+}
+
+void galileo_e1_dll_pll_veml_tracking_sc::start_tracking()
+{
+    d_acq_code_phase_samples = d_acquisition_gnss_synchro->Acq_delay_samples;
+    d_acq_carrier_doppler_hz = d_acquisition_gnss_synchro->Acq_doppler_hz;
+    d_acq_sample_stamp = d_acquisition_gnss_synchro->Acq_samplestamp_samples;
+
+    // DLL/PLL filter initialization
+    d_carrier_loop_filter.initialize(); // initialize the carrier filter
+    d_code_loop_filter.initialize();    // initialize the code filter
+
+    // generate local reference ALWAYS starting at chip 1 (2 samples per chip)
+    Code_Bank::galileo_e1_code_gen_complex_sampled(d_ca_code,
+                                                   d_acquisition_gnss_synchro->Signal,
+                                                   false,
+                                                   d_acquisition_gnss_synchro->PRN,
+                                                   2 * Galileo_E1_CODE_CHIP_RATE_HZ,
+                                                   0);
+    volk_gnsssdr_32fc_convert_16ic(d_ca_code_16sc, d_ca_code, static_cast<int>(2 * Galileo_E1_B_CODE_LENGTH_CHIPS));
+
+    multicorrelator_cpu.set_local_code_and_taps(static_cast<int>(2 * Galileo_E1_B_CODE_LENGTH_CHIPS), d_ca_code_16sc, d_local_code_shift_chips);
+    for (int n = 0; n < d_n_correlator_taps; n++)
+        {
+            d_correlator_outs[n] = gr_complex(0,0);
+        }
+
+    d_carrier_lock_fail_counter = 0;
+    d_rem_code_phase_samples = 0.0;
+    d_rem_carr_phase_rad = 0.0;
+    d_acc_carrier_phase_rad = 0.0;
+
+    d_acc_code_phase_secs = 0.0;
+    d_carrier_doppler_hz = d_acq_carrier_doppler_hz;
+    d_current_prn_length_samples = d_vector_length;
+
+    std::string sys_ = &d_acquisition_gnss_synchro->System;
+    sys = sys_.substr(0, 1);
+
+    // DEBUG OUTPUT
+    std::cout << "Tracking start on channel " << d_channel << " for satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN) << std::endl;
+    LOG(INFO) << "Starting tracking of satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN) << " on channel " << d_channel;
+
+    // enable tracking
+    d_pull_in = true;
+    d_enable_tracking = true;
+
+    LOG(INFO) << "PULL-IN Doppler [Hz]=" << d_carrier_doppler_hz
+              << " PULL-IN Code Phase [samples]=" << d_acq_code_phase_samples;
+}
+
+galileo_e1_dll_pll_veml_tracking_sc::~galileo_e1_dll_pll_veml_tracking_sc()
+{
+    d_dump_file.close();
+
+    volk_free(d_local_code_shift_chips);
+    volk_free(d_correlator_outs);
+    volk_free(d_ca_code);
+    volk_free(d_ca_code_16sc);
+    volk_free(d_correlator_outs_16sc);
+
+    delete[] d_Prompt_buffer;
+    multicorrelator_cpu.free();
+}
+
+
+
+int galileo_e1_dll_pll_veml_tracking_sc::general_work (int noutput_items __attribute__((unused)), gr_vector_int &ninput_items __attribute__((unused)),
+        gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
+{
+    double carr_error_hz = 0.0;
+    double carr_error_filt_hz = 0.0;
+    double code_error_chips = 0.0;
+    double code_error_filt_chips = 0.0;
+
+    // Block input data and block output stream pointers
+    const lv_16sc_t* in = (lv_16sc_t*) input_items[0];
+    Gnss_Synchro **out = (Gnss_Synchro **) &output_items[0];
+    // GNSS_SYNCHRO OBJECT to interchange data between tracking->telemetry_decoder
+    Gnss_Synchro current_synchro_data = Gnss_Synchro();
+
+    if (d_enable_tracking == true)
+        {
+            // Fill the acquisition data
+            current_synchro_data = *d_acquisition_gnss_synchro;
+            if (d_pull_in == true)
+                {
+                    /*
+                     * Signal alignment (skip samples until the incoming signal is aligned with local replica)
+                     */
+                    int samples_offset;
+                    double acq_trk_shif_correction_samples;
+                    int acq_to_trk_delay_samples;
+                    acq_to_trk_delay_samples = d_sample_counter - d_acq_sample_stamp;
+                    acq_trk_shif_correction_samples = d_current_prn_length_samples - std::fmod(static_cast<double>(acq_to_trk_delay_samples), static_cast<double>(d_current_prn_length_samples));
+                    samples_offset = std::round(d_acq_code_phase_samples + acq_trk_shif_correction_samples);
+                    current_synchro_data.Tracking_timestamp_secs = (static_cast<double>(d_sample_counter) + static_cast<double>(d_rem_code_phase_samples)) / static_cast<double>(d_fs_in);
+                    *out[0] = current_synchro_data;
+                    d_sample_counter = d_sample_counter + samples_offset; //count for the processed samples
+                    d_pull_in = false;
+                    consume_each(samples_offset); //shift input to perform alignment with local replica
+                    return 1;
+                }
+
+            // ################# CARRIER WIPEOFF AND CORRELATORS ##############################
+            // perform carrier wipe-off and compute Early, Prompt and Late correlation
+            multicorrelator_cpu.set_input_output_vectors(d_correlator_outs_16sc, in);
+
+            double carr_phase_step_rad = GALILEO_TWO_PI * d_carrier_doppler_hz / static_cast<double>(d_fs_in);
+            double code_phase_step_half_chips = (2.0 * d_code_freq_chips) / (static_cast<double>(d_fs_in));
+            double rem_code_phase_half_chips = d_rem_code_phase_samples * (2.0*d_code_freq_chips / d_fs_in);
+            multicorrelator_cpu.Carrier_wipeoff_multicorrelator_resampler(
+                    d_rem_carr_phase_rad,
+                    carr_phase_step_rad,
+                    rem_code_phase_half_chips,
+                    code_phase_step_half_chips,
+                    d_correlation_length_samples);
+            // the loop discriminators work in floating point
+            volk_gnsssdr_16ic_convert_32fc(d_correlator_outs, d_correlator_outs_16sc, d_n_correlator_taps);
+
+            // ################## PLL ##########################################################
+            // PLL discriminator
+            carr_error_hz = pll_cloop_two_quadrant_atan(*d_Prompt) / GALILEO_TWO_PI;
+            // Carrier discriminator filter
+            carr_error_filt_hz = d_carrier_loop_filter.get_carrier_nco(carr_error_hz);
+            // New carrier Doppler frequency estimation
+            d_carrier_doppler_hz = d_acq_carrier_doppler_hz + carr_error_filt_hz;
+            // New code Doppler frequency estimation
+            d_code_freq_chips = Galileo_E1_CODE_CHIP_RATE_HZ + ((d_carrier_doppler_hz * Galileo_E1_CODE_CHIP_RATE_HZ) / Galileo_E1_FREQ_HZ);
+            //carrier phase accumulator for (K) Doppler estimation-
+            d_acc_carrier_phase_rad -= GALILEO_TWO_PI * d_carrier_doppler_hz * static_cast<double>(d_current_prn_length_samples) / static_cast<double>(d_fs_in);
+            //remnant carrier phase to prevent overflow in the code NCO
+            d_rem_carr_phase_rad = d_rem_carr_phase_rad + GALILEO_TWO_PI * d_carrier_doppler_hz * static_cast<double>(d_current_prn_length_samples) / static_cast<double>(d_fs_in);
+            d_rem_carr_phase_rad = std::fmod(d_rem_carr_phase_rad, GALILEO_TWO_PI);
+
+            // ################## DLL ##########################################################
+            // DLL discriminator
+            code_error_chips = dll_nc_vemlp_normalized(*d_Very_Early, *d_Early, *d_Late, *d_Very_Late); //[chips/Ti]
+            // Code discriminator filter
+            code_error_filt_chips = d_code_loop_filter.get_code_nco(code_error_chips); //[chips/second]
+            //Code phase accumulator
+            double code_error_filt_secs;
+            code_error_filt_secs = (Galileo_E1_CODE_PERIOD * code_error_filt_chips) / Galileo_E1_CODE_CHIP_RATE_HZ; //[seconds]
+            //code_error_filt_secs=T_prn_seconds*code_error_filt_chips*T_chip_seconds*static_cast<float>(d_fs_in); //[seconds]
+            d_acc_code_phase_secs = d_acc_code_phase_secs  + code_error_filt_secs;
+
+            // ################## CARRIER AND CODE NCO BUFFER ALIGNEMENT #######################
+            // keep alignment parameters for the next input buffer
+            double T_chip_seconds;
+            double T_prn_seconds;
+            double T_prn_samples;
+            double K_blk_samples;
+            // Compute the next buffer length based in the new period of the PRN sequence and the code phase error estimation
+            T_chip_seconds = 1.0 / d_code_freq_chips;
+            T_prn_seconds = T_chip_seconds * Galileo_E1_B_CODE_LENGTH_CHIPS;
+            T_prn_samples = T_prn_seconds * static_cast<double>(d_fs_in);
+            K_blk_samples = T_prn_samples + d_rem_code_phase_samples + code_error_filt_secs * static_cast<double>(d_fs_in);
+            d_current_prn_length_samples = std::round(K_blk_samples); //round to a discrete samples
+            //d_rem_code_phase_samples = K_blk_samples - d_current_prn_length_samples; //rounding error < 1 sample
+
+            // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
+            if (d_cn0_estimation_counter < CN0_ESTIMATION_SAMPLES)
+                {
+                    // fill buffer with prompt correlator output values
+                    d_Prompt_buffer[d_cn0_estimation_counter] = *d_Prompt;
+                    d_cn0_estimation_counter++;
+                }
+            else
+                {
+                    d_cn0_estimation_counter = 0;
+
+                    // Code lock indicator
+                    d_CN0_SNV_dB_Hz = cn0_svn_estimator(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in, Galileo_E1_B_CODE_LENGTH_CHIPS);
+
+                    // Carrier lock indicator
+                    d_carrier_lock_test = carrier_lock_detector(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES);
+
+                    // Loss of lock detection
+                    if (d_carrier_lock_test < d_carrier_lock_threshold or d_CN0_SNV_dB_Hz < MINIMUM_VALID_CN0)
+                        {
+                            d_carrier_lock_fail_counter++;
+                        }
+                    else
+                        {
+                            if (d_carrier_lock_fail_counter > 0) d_carrier_lock_fail_counter--;
+                        }
+                    if (d_carrier_lock_fail_counter > MAXIMUM_LOCK_FAIL_COUNTER)
+                        {
+                            std::cout << "Loss of lock in channel " << d_channel << "!" << std::endl;
+                            LOG(INFO) << "Loss of lock in channel " << d_channel << "!";
+                            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_LOSS_OF_LOCK));
+                            d_carrier_lock_fail_counter = 0;
+                            d_enable_tracking = false; // TODO: check if disabling tracking is consistent with the channel state machine
+                        }
+                }
+
+            // ########### Output the tracking results to Telemetry block ##########
+
+            current_synchro_data.Prompt_I = static_cast<double>((*d_Prompt).real());
+            current_synchro_data.Prompt_Q = static_cast<double>((*d_Prompt).imag());
+            // Tracking_timestamp_secs is aligned with the CURRENT PRN start sample (Hybridization OK!)
+            current_synchro_data.Tracking_timestamp_secs = (static_cast<double>(d_sample_counter) + static_cast<double>(d_rem_code_phase_samples)) / static_cast<double>(d_fs_in);
+            //compute remnant code phase samples AFTER the Tracking timestamp
+            d_rem_code_phase_samples = K_blk_samples - d_current_prn_length_samples; //rounding error < 1 sample
+            // This tracking block aligns the Tracking_timestamp_secs with the start sample of the PRN, thus, Code_phase_secs=0
+            current_synchro_data.Code_phase_secs = 0;
+            current_synchro_data.Carrier_phase_rads = d_acc_carrier_phase_rad;
+            current_synchro_data.Carrier_Doppler_hz = d_carrier_doppler_hz;
+            current_synchro_data.CN0_dB_hz = d_CN0_SNV_dB_Hz;
+            current_synchro_data.Flag_valid_symbol_output = true;
+            current_synchro_data.correlation_length_ms = 4;
+
+        }
+    else
+    {
+        *d_Early = gr_complex(0,0);
+        *d_Prompt = gr_complex(0,0);
+        *d_Late = gr_complex(0,0);
+        // GNSS_SYNCHRO OBJECT to interchange data between tracking->telemetry_decoder
+        current_synchro_data.Tracking_timestamp_secs = (static_cast<double>(d_sample_counter) + static_cast<double>(d_rem_code_phase_samples)) / static_cast<double>(d_fs_in);
+    }
+    //assign the GNURadio block output data
+    current_synchro_data.System = {'E'};
+    std::string str_aux = "1B";
+    const char * str = str_aux.c_str(); // get a C style null terminated string
+    std::memcpy((void*)current_synchro_data.Signal, str, 3);
+    *out[0] = current_synchro_data;
+
+    if(d_dump)
+        {
+            // Dump results to file
+            float prompt_I;
+            float prompt_Q;
+            float tmp_VE, tmp_E, tmp_P, tmp_L, tmp_VL;
+            prompt_I = (*d_Prompt).real();
+            prompt_Q = (*d_Prompt).imag();
+            tmp_VE = std::abs<float>(*d_Very_Early);
+            tmp_E = std::abs<float>(*d_Early);
+            tmp_P = std::abs<float>(*d_Prompt);
+            tmp_L = std::abs<float>(*d_Late);
+            tmp_VL = std::abs<float>(*d_Very_Late);
+
+            // Dump correlators output
+            d_dump_file.put<float>(tmp_VE);
+            d_dump_file.put<float>(tmp_E);
+            d_dump_file.put<float>(tmp_P);
+            d_dump_file.put<float>(tmp_L);
+            d_dump_file.put<float>(tmp_VL);
+            // PROMPT I and Q (to analyze navigation symbols)
+            d_dump_file.put<float>(prompt_I);
+            d_dump_file.put<float>(prompt_Q);
+            // PRN start sample stamp
+            d_dump_file.put<unsigned long int>(d_sample_counter);
+            // accumulated carrier phase
+            d_dump_file.put<float>(d_acc_carrier_phase_rad);
+            // carrier and code frequency
+            d_dump_file.put<float>(d_carrier_doppler_hz);
+            d_dump_file.put<float>(d_code_freq_chips);
+            //PLL commands
+            d_dump_file.put<float>(carr_error_hz);
+            d_dump_file.put<float>(carr_error_filt_hz);
+            //DLL commands
+            d_dump_file.put<float>(code_error_chips);
+            d_dump_file.put<float>(code_error_filt_chips);
+            // CN0 and carrier lock test
+            d_dump_file.put<float>(d_CN0_SNV_dB_Hz);
+            d_dump_file.put<float>(d_carrier_lock_test);
+            // AUX vars (for debug purposes)
+            d_dump_file.put<float>(d_rem_code_phase_samples);
+            d_dump_file.put<double>(static_cast<double>(d_sample_counter + d_current_prn_length_samples));
+        }
+    consume_each(d_current_prn_length_samples); // this is required for gr_block derivates
+    d_sample_counter += d_current_prn_length_samples; //count for the processed samples
+
+    return 1; //output tracking result ALWAYS even in the case of d_enable_tracking==false
+}
+
+
+
+void galileo_e1_dll_pll_veml_tracking_sc::set_channel(unsigned int channel)
+{
+    d_channel = channel;
+    LOG(INFO) << "Tracking Channel set to " << d_channel;
+    // ############# ENABLE DATA FILE LOG #################
+    if (d_dump == true)
+        {
+            if (d_dump_file.is_open() == false)
+                {
+                    d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                    d_dump_filename.append(".dat");
+                    if (d_dump_file.open(d_dump_filename, tracking_block_dump_schema()))
+                        {
+                            LOG(INFO) << "Tracking dump enabled on channel " << d_channel << " Log file: " << d_dump_filename.c_str();
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << d_channel << " cannot open trk dump file " << d_dump_filename;
+                        }
+                }
+        }
+}
+
+
+
+
+void galileo_e1_dll_pll_veml_tracking_sc::set_gnss_synchro(Gnss_Synchro* p_gnss_synchro)
+{
+    d_acquisition_gnss_synchro = p_gnss_synchro;
+}
@@ -47,6 +47,7 @@
 #include <glog/logging.h>
 #include <volk/volk.h>
 #include "galileo_e1_signal_processing.h"
+#include "code_bank.h"
 #include "tracking_discriminators.h"
 #include "lock_detectors.h"
 #include "GPS_L1_CA.h"
@@ -54,6 +55,7 @@
 #include "control_message_factory.h"
 #include "tcp_communication.h"
 #include "tcp_packet_data.h"
+#include "channel_event.h"
 
 /*!
  * \todo Include in definition header file
@@ -65,6 +67,34 @@
 
 using google::LogMessage;
 
+namespace
+{
+Dump_Schema tracking_block_dump_schema()
+{
+    Dump_Schema schema("galileo_e1_tcp_connector_tracking_cc");
+    schema.add<float>("abs_VE")
+          .add<float>("abs_E")
+          .add<float>("abs_P")
+          .add<float>("abs_L")
+          .add<float>("abs_VL")
+          .add<float>("prompt_I")
+          .add<float>("prompt_Q")
+          .add<unsigned long int>("PRN_start_sample")
+          .add<float>("acc_carrier_phase_rad")
+          .add<float>("carrier_doppler_hz")
+          .add<float>("code_freq_chips")
+          .add<float>("carr_error_hz")
+          .add<float>("carr_nco_hz")
+          .add<float>("code_error_chips")
+          .add<float>("code_nco_chips")
+          .add<float>("CN0_SNV_dB_Hz")
+          .add<float>("carrier_lock_test")
+          .add<float>("rem_code_phase_samples")
+          .add<double>("next_PRN_start_sample");
+    return schema;
+}
+}
+
 galileo_e1_tcp_connector_tracking_cc_sptr galileo_e1_tcp_connector_make_tracking_cc(
         long if_freq,
         long fs_in,
@@ -127,6 +157,8 @@ Galileo_E1_Tcp_Connector_Tracking_cc::Galileo_E1_Tcp_Connector_Tracking_cc(
     d_port = 0;
     d_listen_connection = true;
     d_control_id = 0;
+    d_pipelined_loop = false;
+    d_pipeline_restarted = false;
 
     // Initialization of local code replica
     // Get space for a vector with the sinboc(1,1) replica sampled 2x/chip
@@ -209,12 +241,12 @@ void Galileo_E1_Tcp_Connector_Tracking_cc::start_tracking()
     d_acq_sample_stamp =  d_acquisition_gnss_synchro->Acq_samplestamp_samples;
 
     // generate local reference ALWAYS starting at chip 1 (2 samples per chip)
-    galileo_e1_code_gen_complex_sampled(d_ca_code,
-                                        d_acquisition_gnss_synchro->Signal,
-                                        false,
-                                        d_acquisition_gnss_synchro->PRN,
-                                        2 * Galileo_E1_CODE_CHIP_RATE_HZ,
-                                        0);
+    Code_Bank::galileo_e1_code_gen_complex_sampled(d_ca_code,
+                                                   d_acquisition_gnss_synchro->Signal,
+                                                   false,
+                                                   d_acquisition_gnss_synchro->PRN,
+                                                   2 * Galileo_E1_CODE_CHIP_RATE_HZ,
+                                                   0);
 
     multicorrelator_cpu.set_local_code_and_taps(static_cast<int>(2*Galileo_E1_B_CODE_LENGTH_CHIPS), d_ca_code, d_local_code_shift_chips);
     for (int n = 0; n < d_n_correlator_taps; n++)
@@ -241,6 +273,7 @@ void Galileo_E1_Tcp_Connector_Tracking_cc::start_tracking()
     // enable tracking
     d_pull_in = true;
     d_enable_tracking = true;
+    d_pipeline_restarted = true;
 
     LOG(INFO) << "PULL-IN Doppler [Hz]=" << d_carrier_doppler_hz << " PULL-IN Code Phase [samples]=" << d_acq_code_phase_samples;
 }
@@ -328,7 +361,7 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items __attr
                                                                                     (*d_Prompt).imag(),
                                                                                     d_acq_carrier_doppler_hz,
                                                                                     1}};
-            d_tcp_com.send_receive_tcp_packet_galileo_e1(tx_variables_array, &tcp_data);
+            send_receive_tcp_packet(tx_variables_array, &tcp_data);
 
             // ################## PLL ##########################################################
             // PLL discriminator, carrier loop filter implementation and NCO command generation (TCP_connector)
@@ -395,7 +428,7 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items __attr
                         {
                             std::cout << "Loss of lock in channel " << d_channel << "!" << std::endl;
                             LOG(INFO) << "Loss of lock in channel " << d_channel << "!";
-                            this->message_port_pub(pmt::mp("events"), pmt::from_long(3));//3 -> loss of lock
+                            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_LOSS_OF_LOCK));
 
                             d_carrier_lock_fail_counter = 0;
                             d_enable_tracking = false; // TODO: check if disabling tracking is consistent with the channel state machine
@@ -426,7 +459,7 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items __attr
             current_synchro_data.Tracking_timestamp_secs = (static_cast<double>(d_sample_counter) + static_cast<double>(d_rem_code_phase_samples)) / static_cast<double>(d_fs_in);
             //! When tracking is disabled an array of 1's is sent to maintain the TCP connection
             boost::array<float, NUM_TX_VARIABLES_GALILEO_E1> tx_variables_array = {{1,1,1,1,1,1,1,1,1,1,1,1,0}};
-            d_tcp_com.send_receive_tcp_packet_galileo_e1(tx_variables_array, &tcp_data);
+            send_receive_tcp_packet(tx_variables_array, &tcp_data);
         }
     //assign the GNURadio block output data
     current_synchro_data.System = {'E'};
@@ -442,9 +475,6 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items __attr
             float prompt_I;
             float prompt_Q;
             float tmp_VE, tmp_E, tmp_P, tmp_L, tmp_VL;
-            float tmp_float;
-            tmp_float = 0;
-            double tmp_double;
             prompt_I = (*d_Prompt).real();
             prompt_Q = (*d_Prompt).imag();
             tmp_VE = std::abs<float>(*d_Very_Early);
@@ -453,48 +483,34 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items __attr
             tmp_L = std::abs<float>(*d_Late);
             tmp_VL = std::abs<float>(*d_Very_Late);
 
-            try
-            {
-                    // EPR
-                    d_dump_file.write((char*)&tmp_VE, sizeof(float));
-                    d_dump_file.write((char*)&tmp_E, sizeof(float));
-                    d_dump_file.write((char*)&tmp_P, sizeof(float));
-                    d_dump_file.write((char*)&tmp_L, sizeof(float));
-                    d_dump_file.write((char*)&tmp_VL, sizeof(float));
-                    // PROMPT I and Q (to analyze navigation symbols)
-                    d_dump_file.write((char*)&prompt_I, sizeof(float));
-                    d_dump_file.write((char*)&prompt_Q, sizeof(float));
-                    // PRN start sample stamp
-                    d_dump_file.write((char*)&d_sample_counter, sizeof(unsigned long int));
-                    // accumulated carrier phase
-                    d_dump_file.write((char*)&d_acc_carrier_phase_rad, sizeof(float));
-
-                    // carrier and code frequency
-                    d_dump_file.write((char*)&d_carrier_doppler_hz, sizeof(float));
-                    d_dump_file.write((char*)&d_code_freq_chips, sizeof(float));
-
-                    //PLL commands
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    d_dump_file.write((char*)&carr_error_filt_hz, sizeof(float));
-
-                    //DLL commands
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    d_dump_file.write((char*)&code_error_filt_chips, sizeof(float));
-
-                    // CN0 and carrier lock test
-                    d_dump_file.write((char*)&d_CN0_SNV_dB_Hz, sizeof(float));
-                    d_dump_file.write((char*)&d_carrier_lock_test, sizeof(float));
-
-                    // AUX vars (for debug purposes)
-                    tmp_float = d_rem_code_phase_samples;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    tmp_double = (double)(d_sample_counter+d_current_prn_length_samples);
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-            }
-            catch (const std::ifstream::failure &e)
-            {
-                    LOG(WARNING) << "Exception writing trk dump file " << e.what();
-            }
+            // EPR
+            d_dump_file.put<float>(tmp_VE);
+            d_dump_file.put<float>(tmp_E);
+            d_dump_file.put<float>(tmp_P);
+            d_dump_file.put<float>(tmp_L);
+            d_dump_file.put<float>(tmp_VL);
+            // PROMPT I and Q (to analyze navigation symbols)
+            d_dump_file.put<float>(prompt_I);
+            d_dump_file.put<float>(prompt_Q);
+            // PRN start sample stamp
+            d_dump_file.put<unsigned long int>(d_sample_counter);
+            // accumulated carrier phase
+            d_dump_file.put<float>(d_acc_carrier_phase_rad);
+            // carrier and code frequency
+            d_dump_file.put<float>(d_carrier_doppler_hz);
+            d_dump_file.put<float>(d_code_freq_chips);
+            //PLL commands
+            d_dump_file.put<float>(0);
+            d_dump_file.put<float>(carr_error_filt_hz);
+            //DLL commands
+            d_dump_file.put<float>(0);
+            d_dump_file.put<float>(code_error_filt_chips);
+            // CN0 and carrier lock test
+            d_dump_file.put<float>(d_CN0_SNV_dB_Hz);
+            d_dump_file.put<float>(d_carrier_lock_test);
+            // AUX vars (for debug purposes)
+            d_dump_file.put<float>(d_rem_code_phase_samples);
+            d_dump_file.put<double>((double)(d_sample_counter+d_current_prn_length_samples));
         }
     consume_each(d_current_prn_length_samples); // this is needed in gr::block derivates
     d_sample_counter += d_current_prn_length_samples; //count for the processed samples
@@ -513,18 +529,16 @@ void Galileo_E1_Tcp_Connector_Tracking_cc::set_channel(unsigned int channel)
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
-                            d_dump_filename.append(".dat");
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                    d_dump_filename.append(".dat");
+                    if (d_dump_file.open(d_dump_filename, tracking_block_dump_schema()))
+                        {
                             LOG(INFO) << "Tracking dump enabled on channel " << d_channel << " Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (const std::ifstream::failure &e)
-                    {
-                            LOG(WARNING) << "channel " << d_channel << " Exception opening trk dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << d_channel << " cannot open trk dump file " << d_dump_filename;
+                        }
                 }
         }
 
@@ -538,6 +552,31 @@ void Galileo_E1_Tcp_Connector_Tracking_cc::set_channel(unsigned int channel)
 
 
 
+void Galileo_E1_Tcp_Connector_Tracking_cc::send_receive_tcp_packet(const boost::array<float, NUM_TX_VARIABLES_GALILEO_E1>& tx_variables_array, tcp_packet_data* tcp_data)
+{
+    if (!d_pipelined_loop)
+        {
+            d_tcp_com.send_receive_tcp_packet_galileo_e1(tx_variables_array, tcp_data);
+            return;
+        }
+    // the answer is the one to the previous code period, and it is ignored
+    // if that packet was sent before the tracking started
+    tcp_packet_data answer;
+    if (d_tcp_com.send_receive_tcp_packet_galileo_e1_pipelined(tx_variables_array, &answer) and !d_pipeline_restarted)
+        {
+            *tcp_data = answer;
+        }
+    else
+        {
+            // no answer yet, the NCOs keep their commands
+            tcp_data->proc_pack_code_error = 0;
+            tcp_data->proc_pack_carr_error = d_carrier_doppler_hz - d_acq_carrier_doppler_hz;
+            tcp_data->proc_pack_carrier_doppler_hz = d_carrier_doppler_hz;
+        }
+    d_pipeline_restarted = false;
+}
+
+
 void Galileo_E1_Tcp_Connector_Tracking_cc::set_gnss_synchro(Gnss_Synchro* p_gnss_synchro)
 {
     d_acquisition_gnss_synchro = p_gnss_synchro;
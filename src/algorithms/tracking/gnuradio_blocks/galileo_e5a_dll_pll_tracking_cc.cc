@@ -46,8 +46,10 @@
 #include "tracking_discriminators.h"
 #include "lock_detectors.h"
 #include "Galileo_E5a.h"
+#include "tracking_signal.h"
 #include "Galileo_E1.h"
 #include "control_message_factory.h"
+#include "channel_event.h"
 
 
 /*!
@@ -61,6 +63,34 @@
 
 using google::LogMessage;
 
+namespace
+{
+Dump_Schema tracking_block_dump_schema()
+{
+    Dump_Schema schema("galileo_e5a_dll_pll_tracking_cc");
+    schema.add<float>("abs_E")
+          .add<float>("abs_P")
+          .add<float>("abs_L")
+          .add<float>("prompt_I")
+          .add<float>("prompt_Q")
+          .add<unsigned long int>("PRN_start_sample")
+          .add<double>("acc_carrier_phase_rad")
+          .add<double>("carrier_doppler_hz")
+          .add<double>("code_freq_chips")
+          .add<double>("carr_error_hz")
+          .add<double>("carr_nco_hz")
+          .add<double>("code_error_chips")
+          .add<double>("code_nco_chips")
+          .add<double>("CN0_SNV_dB_Hz")
+          .add<double>("carrier_lock_test")
+          .add<double>("rem_code_phase_samples")
+          .add<double>("next_PRN_start_sample");
+    return schema;
+}
+}
+
+typedef Tracking_Nco<Galileo_E5a_Signal> E5a_Nco;
+
 galileo_e5a_dll_pll_tracking_cc_sptr
 galileo_e5a_dll_pll_make_tracking_cc(
         long if_freq,
@@ -137,7 +167,7 @@ Galileo_E5a_Dll_Pll_Tracking_cc::Galileo_E5a_Dll_Pll_Tracking_cc(
     d_codeI = static_cast<gr_complex*>(volk_malloc(Galileo_E5a_CODE_LENGTH_CHIPS * sizeof(gr_complex), volk_get_alignment()));
 
     // correlator Q outputs (scalar)
-    d_n_correlator_taps = 3; //  Early, Prompt, Late
+    d_n_correlator_taps = Galileo_E5a_Signal::n_taps; //  Early, Prompt, Late
     d_correlator_outs = static_cast<gr_complex*>(volk_malloc(d_n_correlator_taps*sizeof(gr_complex), volk_get_alignment()));
     for (int n = 0; n < d_n_correlator_taps; n++)
         {
@@ -151,9 +181,7 @@ Galileo_E5a_Dll_Pll_Tracking_cc::Galileo_E5a_Dll_Pll_Tracking_cc(
 
     d_local_code_shift_chips = static_cast<float*>(volk_malloc(d_n_correlator_taps * sizeof(float), volk_get_alignment()));
     // Set TAPs delay values [chips]
-    d_local_code_shift_chips[0] = - d_early_late_spc_chips;
-    d_local_code_shift_chips[1] = 0.0;
-    d_local_code_shift_chips[2] = d_early_late_spc_chips;
+    E5a_Nco::tap_shifts(d_early_late_spc_chips, d_local_code_shift_chips);
 
     multicorrelator_cpu_Q.init(2 * d_vector_length, d_n_correlator_taps);
 
@@ -322,8 +350,8 @@ void Galileo_E5a_Dll_Pll_Tracking_cc::start_tracking()
 void Galileo_E5a_Dll_Pll_Tracking_cc::acquire_secondary()
 {
     // 1. Transform replica to 1 and -1
-    int sec_code_signed[Galileo_E5a_Q_SECONDARY_CODE_LENGTH];
-    for (unsigned int i = 0; i < Galileo_E5a_Q_SECONDARY_CODE_LENGTH; i++)
+    int sec_code_signed[Galileo_E5a_Signal::secondary_code_length];
+    for (unsigned int i = 0; i < Galileo_E5a_Signal::secondary_code_length; i++)
         {
             if (Galileo_E5a_Q_SECONDARY_CODE[d_acquisition_gnss_synchro->PRN - 1].at(i) == '0')
                 {
@@ -350,13 +378,13 @@ void Galileo_E5a_Dll_Pll_Tracking_cc::acquire_secondary()
     // 3. Serial search
     int out_corr;
     int current_best_ = 0;
-    for (unsigned int i = 0; i < Galileo_E5a_Q_SECONDARY_CODE_LENGTH; i++)
+    for (unsigned int i = 0; i < Galileo_E5a_Signal::secondary_code_length; i++)
         {
             out_corr = 0;
             for (unsigned int j = 0; j < CN0_ESTIMATION_SAMPLES; j++)
                 {
                     //reverse replica sign since i*i=-1 (conjugated complex)
-                    out_corr += in_corr[j] * -sec_code_signed[(j + i) % Galileo_E5a_Q_SECONDARY_CODE_LENGTH];
+                    out_corr += in_corr[j] * -sec_code_signed[(j + i) % Galileo_E5a_Signal::secondary_code_length];
                 }
             if (abs(out_corr) > current_best_)
                 {
@@ -367,7 +395,7 @@ void Galileo_E5a_Dll_Pll_Tracking_cc::acquire_secondary()
     if (current_best_ == CN0_ESTIMATION_SAMPLES) // all bits correlate
         {
             d_secondary_lock = true;
-            d_secondary_delay = (d_secondary_delay + CN0_ESTIMATION_SAMPLES - 1) % Galileo_E5a_Q_SECONDARY_CODE_LENGTH;
+            d_secondary_delay = (d_secondary_delay + CN0_ESTIMATION_SAMPLES - 1) % Galileo_E5a_Signal::secondary_code_length;
         }
 }
 
@@ -477,9 +505,9 @@ int Galileo_E5a_Dll_Pll_Tracking_cc::general_work (int noutput_items __attribute
             multicorrelator_cpu_Q.set_input_output_vectors(d_correlator_outs,in);
             multicorrelator_cpu_I.set_input_output_vectors(d_Single_Prompt_data,in);
 
-            double carr_phase_step_rad = GALILEO_TWO_PI * d_carrier_doppler_hz / static_cast<double>(d_fs_in);
-            double code_phase_step_chips = d_code_freq_chips / (static_cast<double>(d_fs_in));
-            double rem_code_phase_chips = d_rem_code_phase_samples * (d_code_freq_chips / d_fs_in);
+            double carr_phase_step_rad = E5a_Nco::carrier_phase_step_rad(d_carrier_doppler_hz, d_fs_in);
+            double code_phase_step_chips = E5a_Nco::code_phase_step(d_code_freq_chips, d_fs_in);
+            double rem_code_phase_chips = E5a_Nco::rem_code_phase(d_rem_code_phase_samples, d_code_freq_chips, d_fs_in);
             multicorrelator_cpu_Q.Carrier_wipeoff_multicorrelator_resampler(
                     d_rem_carr_phase_rad,
                     carr_phase_step_rad,
@@ -521,13 +549,12 @@ int Galileo_E5a_Dll_Pll_Tracking_cc::general_work (int noutput_items __attribute
                     // New carrier Doppler frequency estimation
                     d_carrier_doppler_hz = d_acq_carrier_doppler_hz + carr_error_filt_hz;
                     // New code Doppler frequency estimation
-                    d_code_freq_chips = Galileo_E5a_CODE_CHIP_RATE_HZ + ((d_carrier_doppler_hz * Galileo_E5a_CODE_CHIP_RATE_HZ) / Galileo_E5a_FREQ_HZ);
+                    d_code_freq_chips = E5a_Nco::code_freq_chips(d_carrier_doppler_hz);
                 }
             //carrier phase accumulator for (K) doppler estimation
-            d_acc_carrier_phase_rad -= 2.0 * GALILEO_PI * d_carrier_doppler_hz * GALILEO_E5a_CODE_PERIOD;
+            d_acc_carrier_phase_rad -= E5a_Nco::period_phase_rad(d_carrier_doppler_hz);
             //remanent carrier phase to prevent overflow in the code NCO
-            d_rem_carr_phase_rad = d_rem_carr_phase_rad + 2.0 * GALILEO_PI * d_carrier_doppler_hz * GALILEO_E5a_CODE_PERIOD;
-            d_rem_carr_phase_rad = fmod(d_rem_carr_phase_rad, 2.0 * GALILEO_PI);
+            d_rem_carr_phase_rad = E5a_Nco::wrap_phase_rad(d_rem_carr_phase_rad + E5a_Nco::period_phase_rad(d_carrier_doppler_hz));
 
             // ################## DLL ##########################################################
             if (d_integration_counter == d_current_ti_ms)
@@ -537,21 +564,14 @@ int Galileo_E5a_Dll_Pll_Tracking_cc::general_work (int noutput_items __attribute
                     // Code discriminator filter
                     code_error_filt_chips = d_code_loop_filter.get_code_nco(code_error_chips); //[chips/second]
                     //Code phase accumulator
-                    d_code_error_filt_secs = (GALILEO_E5a_CODE_PERIOD * code_error_filt_chips) / Galileo_E5a_CODE_CHIP_RATE_HZ; //[seconds]
+                    d_code_error_filt_secs = E5a_Nco::code_error_secs(code_error_filt_chips); //[seconds]
                 }
             d_acc_code_phase_secs = d_acc_code_phase_secs + d_code_error_filt_secs;
 
             // ################## CARRIER AND CODE NCO BUFFER ALIGNMENT #######################
             // keep alignment parameters for the next input buffer
-            double T_chip_seconds;
-            double T_prn_seconds;
-            double T_prn_samples;
-            double K_blk_samples;
             // Compute the next buffer length based in the new period of the PRN sequence and the code phase error estimation
-            T_chip_seconds = 1.0 / d_code_freq_chips;
-            T_prn_seconds = T_chip_seconds * Galileo_E5a_CODE_LENGTH_CHIPS;
-            T_prn_samples = T_prn_seconds * static_cast<double>(d_fs_in);
-            K_blk_samples = T_prn_samples + d_rem_code_phase_samples + d_code_error_filt_secs * static_cast<double>(d_fs_in);
+            double K_blk_samples = E5a_Nco::next_period_samples(d_code_freq_chips, d_rem_code_phase_samples, d_code_error_filt_secs, d_fs_in);
             d_current_prn_length_samples = round(K_blk_samples); //round to a discrete samples
             d_rem_code_phase_samples = K_blk_samples - d_current_prn_length_samples; //rounding error < 1 sample
 
@@ -587,7 +607,7 @@ int Galileo_E5a_Dll_Pll_Tracking_cc::general_work (int noutput_items __attribute
                                         {
                                             std::cout << "Loss of lock in channel " << d_channel << "!" << std::endl;
                                             LOG(INFO) << "Loss of lock in channel " << d_channel << "!";
-                                            this->message_port_pub(pmt::mp("events"), pmt::from_long(3));//3 -> loss of lock
+                                            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_LOSS_OF_LOCK));
                                             d_carrier_lock_fail_counter = 0;
                                             d_state = 0; // TODO: check if disabling tracking is consistent with the channel state machine
                                         }
@@ -612,7 +632,7 @@ int Galileo_E5a_Dll_Pll_Tracking_cc::general_work (int noutput_items __attribute
                                         {
                                             std::cout << "Loss of lock in channel " << d_channel << "!" << std::endl;
                                             LOG(INFO) << "Loss of lock in channel " << d_channel << "!";
-                                            this->message_port_pub(pmt::mp("events"), pmt::from_long(3));//3 -> loss of lock
+                                            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_LOSS_OF_LOCK));
                                             d_carrier_lock_fail_counter = 0;
                                             d_state = 0;
                                         }
@@ -660,7 +680,6 @@ int Galileo_E5a_Dll_Pll_Tracking_cc::general_work (int noutput_items __attribute
             // MULTIPLEXED FILE RECORDING - Record results to file
             float prompt_I;
             float prompt_Q;
-            double tmp_double;
             prompt_I = (d_Prompt_data).real();
             prompt_Q = (d_Prompt_data).imag();
             if (d_integration_counter == d_current_ti_ms)
@@ -669,51 +688,36 @@ int Galileo_E5a_Dll_Pll_Tracking_cc::general_work (int noutput_items __attribute
                     tmp_P = std::abs<float>(d_Prompt);
                     tmp_L = std::abs<float>(d_Late);
                 }
-            try
-            {
-                    // EPR
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_E), sizeof(float));
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_P), sizeof(float));
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_L), sizeof(float));
-                    // PROMPT I and Q (to analyze navigation symbols)
-                    d_dump_file.write(reinterpret_cast<char*>(&prompt_I), sizeof(float));
-                    d_dump_file.write(reinterpret_cast<char*>(&prompt_Q), sizeof(float));
-                    // PRN start sample stamp
-                    //tmp_float=(float)d_sample_counter;
-                    d_dump_file.write(reinterpret_cast<char*>(&d_sample_counter), sizeof(unsigned long int));
-                    // accumulated carrier phase
-                    d_dump_file.write(reinterpret_cast<char*>(&d_acc_carrier_phase_rad), sizeof(double));
-
-                    // carrier and code frequency
-                    d_dump_file.write(reinterpret_cast<char*>(&d_carrier_doppler_hz), sizeof(double));
-                    d_dump_file.write(reinterpret_cast<char*>(&d_code_freq_chips), sizeof(double));
-
-                    //PLL commands
-                    d_dump_file.write(reinterpret_cast<char*>(&carr_error_hz), sizeof(double));
-                    d_dump_file.write(reinterpret_cast<char*>(&carr_error_filt_hz), sizeof(double));
-
-                    //DLL commands
-                    d_dump_file.write(reinterpret_cast<char*>(&code_error_chips), sizeof(double));
-                    d_dump_file.write(reinterpret_cast<char*>(&code_error_filt_chips), sizeof(double));
-
-                    // CN0 and carrier lock test
-                    d_dump_file.write(reinterpret_cast<char*>(&d_CN0_SNV_dB_Hz), sizeof(double));
-                    d_dump_file.write(reinterpret_cast<char*>(&d_carrier_lock_test), sizeof(double));
-
-                    // AUX vars (for debug purposes)
-                    tmp_double = d_rem_code_phase_samples;
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_double), sizeof(double));
-                    tmp_double = static_cast<double>(d_sample_counter + d_current_prn_length_samples);
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_double), sizeof(double));
-
-            }
-            catch (const std::ifstream::failure & e)
-            {
-                    LOG(WARNING) << "Exception writing trk dump file " << e.what();
-            }
+            // EPR
+            d_dump_file.put<float>(tmp_E);
+            d_dump_file.put<float>(tmp_P);
+            d_dump_file.put<float>(tmp_L);
+            // PROMPT I and Q (to analyze navigation symbols)
+            d_dump_file.put<float>(prompt_I);
+            d_dump_file.put<float>(prompt_Q);
+            // PRN start sample stamp
+            //tmp_float=(float)d_sample_counter;
+            d_dump_file.put<unsigned long int>(d_sample_counter);
+            // accumulated carrier phase
+            d_dump_file.put<double>(d_acc_carrier_phase_rad);
+            // carrier and code frequency
+            d_dump_file.put<double>(d_carrier_doppler_hz);
+            d_dump_file.put<double>(d_code_freq_chips);
+            //PLL commands
+            d_dump_file.put<double>(carr_error_hz);
+            d_dump_file.put<double>(carr_error_filt_hz);
+            //DLL commands
+            d_dump_file.put<double>(code_error_chips);
+            d_dump_file.put<double>(code_error_filt_chips);
+            // CN0 and carrier lock test
+            d_dump_file.put<double>(d_CN0_SNV_dB_Hz);
+            d_dump_file.put<double>(d_carrier_lock_test);
+            // AUX vars (for debug purposes)
+            d_dump_file.put<double>(d_rem_code_phase_samples);
+            d_dump_file.put<double>(static_cast<double>(d_sample_counter + d_current_prn_length_samples));
         }
 
-    d_secondary_delay = (d_secondary_delay + 1) % Galileo_E5a_Q_SECONDARY_CODE_LENGTH;
+    d_secondary_delay = (d_secondary_delay + 1) % Galileo_E5a_Signal::secondary_code_length;
     d_sample_counter += d_current_prn_length_samples; //count for the processed samples
     consume_each(d_current_prn_length_samples); // this is necessary in gr::block derivates
     return 1; //output tracking result ALWAYS even in the case of d_enable_tracking==false
@@ -729,18 +733,16 @@ void Galileo_E5a_Dll_Pll_Tracking_cc::set_channel(unsigned int channel)
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
-                            d_dump_filename.append(".dat");
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                    d_dump_filename.append(".dat");
+                    if (d_dump_file.open(d_dump_filename, tracking_block_dump_schema()))
+                        {
                             LOG(INFO) << "Tracking dump enabled on channel " << d_channel << " Log file: " << d_dump_filename.c_str() << std::endl;
-                    }
-                    catch (const std::ifstream::failure &e)
-                    {
-                            LOG(WARNING) << "channel " << d_channel << " Exception opening trk dump file " << e.what() << std::endl;
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << d_channel << " cannot open trk dump file " << d_dump_filename;
+                        }
                 }
         }
 }
@@ -45,6 +45,7 @@
 #include "tracking_2nd_DLL_filter.h"
 #include "tracking_2nd_PLL_filter.h"
 #include "cpu_multicorrelator.h"
+#include "dump_writer.h"
 
 class Galileo_E5a_Dll_Pll_Tracking_cc;
 
@@ -201,7 +202,7 @@ private:
 
     // file dump
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
 
     std::map<std::string, std::string> systemName;
     std::string sys;
@@ -48,6 +48,7 @@
 #include "tracking_FLL_PLL_filter.h"
 #include "tracking_loop_filter.h"
 #include "cpu_multicorrelator.h"
+#include "dump_writer.h"
 
 class gps_l1_ca_dll_pll_c_aid_tracking_cc;
 
@@ -194,7 +195,7 @@ private:
 
     // file dump
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
 
     std::map<std::string, std::string> systemName;
     std::string sys;
@@ -49,6 +49,7 @@
 #include "tracking_2nd_DLL_filter.h"
 #include "tracking_FLL_PLL_filter.h"
 #include "cpu_multicorrelator_16sc.h"
+#include "dump_writer.h"
 
 class gps_l1_ca_dll_pll_c_aid_tracking_sc;
 
@@ -179,7 +180,7 @@ private:
 
     // file dump
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
 
     std::map<std::string, std::string> systemName;
     std::string sys;
@@ -44,10 +44,12 @@
 #include <glog/logging.h>
 #include "gnss_synchro.h"
 #include "gps_sdr_signal_processing.h"
+#include "code_bank.h"
 #include "tracking_discriminators.h"
 #include "lock_detectors.h"
 #include "GPS_L1_CA.h"
 #include "control_message_factory.h"
+#include "correlator_taps.h"
 
 
 /*!
@@ -78,7 +80,6 @@ gps_l1_ca_dll_pll_ec_make_tracking_cc(
 }
 
 
-
 void Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc::forecast (int noutput_items,
         gr_vector_int &ninput_items_required)
 {
@@ -86,7 +87,6 @@ void Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc::forecast (int noutput_items,
 }
 
 
-
 Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc::Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc(
         long if_freq,
         long fs_in,
@@ -103,6 +103,7 @@ Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc::Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc(
 
     // initialize internal vars
     d_queue = queue;
+    d_receiver_state = Receiver_State::current();
     d_dump = dump;
     d_if_freq = if_freq;
     d_fs_in = fs_in;
@@ -248,7 +249,7 @@ void Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc::start_tracking()
     d_code_loop_filter.initialize();    // initialize the code filter
 
     // generate local reference ALWAYS starting at chip 1 (1 sample per chip)
-    gps_l1_ca_code_gen_complex(&d_ca_code[1], d_acquisition_gnss_synchro->PRN, 0);
+    Code_Bank::gps_l1_ca_code_gen_complex(&d_ca_code[1], d_acquisition_gnss_synchro->PRN, 0);
     d_ca_code[0] = d_ca_code[(int)GPS_L1_CA_CODE_LENGTH_CHIPS];
     d_ca_code[(int)GPS_L1_CA_CODE_LENGTH_CHIPS + 1] = d_ca_code[1];
 
@@ -278,9 +279,6 @@ void Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc::start_tracking()
 }
 
 
-
-
-
 void Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc::update_local_code()
 {
     double tcode_chips;
@@ -313,8 +311,6 @@ void Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc::update_local_code()
 }
 
 
-
-
 void Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc::update_local_carrier()
 {
     float phase_rad, phase_step_rad;
@@ -331,8 +327,6 @@ void Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc::update_local_carrier()
 }
 
 
-
-
 Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc::~Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc()
 {
     d_dump_file.close();
@@ -358,7 +352,6 @@ Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc::~Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc()
 }
 
 
-
 int Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc::general_work (int noutput_items, gr_vector_int &ninput_items,
         gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
 {
@@ -538,23 +531,16 @@ int Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc::general_work (int noutput_items, gr_vector
             current_synchro_data.CN0_dB_hz = (double)d_CN0_SNV_dB_Hz;
 
 
-            //Vestigial - flog
-            float delta_ = delta(*d_Early, *d_Late, *d_Prompt);
-            float RT_ = RT(*d_Early, *d_Late, *d_Prompt);
-            float Extra_RT_ = RT(*d_Extra_Early, *d_Extra_Late, *d_Prompt);
-            float ELP_ = ELP(*d_Early, *d_Late, *d_Prompt);
-            float MD_ = MD(*d_Early, *d_Late, *d_Prompt);
-            current_synchro_data.delta = delta_;
-            current_synchro_data.RT = RT_;
-            current_synchro_data.Extra_RT = Extra_RT_;
-            current_synchro_data.ELP = ELP_;
-            current_synchro_data.MD = MD_;
-            current_synchro_data.Early_I = (double)(*d_Early).real();
-            current_synchro_data.Early_Q = (double)(*d_Late).imag();
-            current_synchro_data.Late_I = (double)(*d_Late).real();
-            current_synchro_data.Late_Q = (double)(*d_Late).imag();
             current_synchro_data.sample_counter = d_sample_counter;
 
+            // correlator taps for the spoofing checks, outside Gnss_Synchro
+            Correlator_Taps taps;
+            taps.PRN = d_acquisition_gnss_synchro->PRN;
+            taps.sample_counter = d_sample_counter;
+            taps.Early = *d_Early;
+            taps.Prompt = *d_Prompt;
+            taps.Late = *d_Late;
+            d_receiver_state->correlator_taps_map.write(d_channel, taps);
 
             *out[0] = current_synchro_data;
 
@@ -738,7 +724,6 @@ int Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc::general_work (int noutput_items, gr_vector
 }
 
 
-
 void Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc::set_channel(unsigned int channel)
 {
     d_channel = channel;
@@ -821,7 +806,6 @@ void Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc::set_channel(unsigned int channel)
 }
 
 
-
 void Gps_L1_Ca_Dll_Pll_Ec_Tracking_cc::set_channel_queue(concurrent_queue<int> *channel_internal_queue)
 {
     d_channel_internal_queue = channel_internal_queue;
@@ -48,6 +48,7 @@
 #include "concurrent_queue.h"
 #include "gps_sdr_signal_processing.h"
 #include "gnss_synchro.h"
+#include "receiver_state.h"
 #include "tracking_2nd_DLL_filter.h"
 #include "tracking_2nd_PLL_filter.h"
 #include "correlator.h"
@@ -120,6 +121,7 @@ private:
     bool d_dump;
 
     Gnss_Synchro* d_acquisition_gnss_synchro;
+    std::shared_ptr<Receiver_State> d_receiver_state; // tables of the receiver, current at construction
     unsigned int d_channel;
     int d_last_seg;
     long d_if_freq;
@@ -35,19 +35,30 @@
  */
 
 #include "gps_l1_ca_dll_pll_tracking_cc.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <memory>
 #include <sstream>
+#include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
 #include <gnuradio/io_signature.h>
+#include <pmt/pmt.h>
 #include <glog/logging.h>
 #include <volk/volk.h>
 #include "gps_sdr_signal_processing.h"
+#include "code_bank.h"
 #include "tracking_discriminators.h"
 #include "lock_detectors.h"
+#include "tracking_signal.h"
 #include "GPS_L1_CA.h"
 #include "control_message_factory.h"
+#include "correlator_taps.h"
+#include "sqm_metrics.h"
+#include "aoa_metrics.h"
+#include "vector_tracking_aid.h"
+#include "channel_event.h"
+#include "latency_trace.h"
 
 
 /*!
@@ -55,8 +66,13 @@
  */
 #define CN0_ESTIMATION_SAMPLES 20
 #define MINIMUM_VALID_CN0 25
+#define MINIMUM_VALID_CN0_EXTENDED 20
 #define MAXIMUM_LOCK_FAIL_COUNTER 50
 #define CARRIER_LOCK_THRESHOLD 0.85
+#define STEADY_CARRIER_LOCK_THRESHOLD 0.95
+#define STEADY_LOCK_CHECKS 5
+
+typedef Tracking_Nco<Gps_L1_Ca_Signal> L1_Ca_Nco;
 
 
 using google::LogMessage;
@@ -77,18 +93,20 @@ gps_l1_ca_dll_pll_make_tracking_cc(
 }
 
 
-
 void Gps_L1_Ca_Dll_Pll_Tracking_cc::forecast (int noutput_items,
         gr_vector_int &ninput_items_required)
 {
     if (noutput_items != 0)
         {
-            ninput_items_required[0] = static_cast<int>(d_vector_length) * 2; //set the required available samples in each call
+            // the elements of an antenna array, if any, are consumed along with input 0
+            for (unsigned int i = 0; i < ninput_items_required.size(); i++)
+                {
+                    ninput_items_required[i] = static_cast<int>(d_vector_length) * 2; //set the required available samples in each call
+                }
         }
 }
 
 
-
 Gps_L1_Ca_Dll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Pll_Tracking_cc(
         long if_freq,
         long fs_in,
@@ -98,12 +116,18 @@ Gps_L1_Ca_Dll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Pll_Tracking_cc(
         float pll_bw_hz,
         float dll_bw_hz,
         float early_late_space_chips) :
-        gr::block("Gps_L1_Ca_Dll_Pll_Tracking_cc", gr::io_signature::make(1, 1, sizeof(gr_complex)),
+        gr::block("Gps_L1_Ca_Dll_Pll_Tracking_cc", gr::io_signature::make(1, 1 + AOA_MAX_ELEMENTS, sizeof(gr_complex)),
                 gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)))
 {
     // Telemetry bit synchronization message port input
     this->message_port_register_in(pmt::mp("preamble_timestamp_s"));
+    this->set_msg_handler(pmt::mp("preamble_timestamp_s"),
+            boost::bind(&Gps_L1_Ca_Dll_Pll_Tracking_cc::msg_handler_preamble_index, this, _1));
+    this->message_port_register_in(pmt::mp("loop_bandwidths"));
+    this->set_msg_handler(pmt::mp("loop_bandwidths"),
+            boost::bind(&Gps_L1_Ca_Dll_Pll_Tracking_cc::msg_handler_loop_bandwidths, this, _1));
     this->message_port_register_out(pmt::mp("events"));
+    d_receiver_state = Receiver_State::current();
 
     // initialize internal vars
     d_dump = dump;
@@ -117,6 +141,17 @@ Gps_L1_Ca_Dll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Pll_Tracking_cc(
     // Initialize tracking  ==========================================
     d_code_loop_filter.set_DLL_BW(dll_bw_hz);
     d_carrier_loop_filter.set_PLL_BW(pll_bw_hz);
+    d_pll_bw_hz = pll_bw_hz;
+    d_dll_bw_hz = dll_bw_hz;
+    d_pll_bw_narrow_hz = pll_bw_hz;
+    d_dll_bw_narrow_hz = dll_bw_hz;
+    d_extend_correlation_ms = 1;
+    d_enable_extended_integration = false;
+    d_preamble_synchronized = false;
+    d_preamble_timestamp_s = 0.0;
+    d_integrated_epochs = 0;
+    d_carr_error_filt_hz = 0.0;
+    d_code_error_filt_chips = 0.0;
 
     //--- DLL variables --------------------------------------------------------
     d_early_late_spc_chips = early_late_space_chips; // Define early-late offset (in chips)
@@ -126,19 +161,23 @@ Gps_L1_Ca_Dll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Pll_Tracking_cc(
     d_ca_code = static_cast<gr_complex*>(volk_malloc(static_cast<int>(GPS_L1_CA_CODE_LENGTH_CHIPS) * sizeof(gr_complex), volk_get_alignment()));
 
     // correlator outputs (scalar)
-    d_n_correlator_taps = 3; // Early, Prompt, and Late
+    d_n_correlator_taps = Gps_L1_Ca_Signal::n_taps; // Early, Prompt, and Late
     d_correlator_outs = static_cast<gr_complex*>(volk_malloc(d_n_correlator_taps*sizeof(gr_complex), volk_get_alignment()));
     for (int n = 0; n < d_n_correlator_taps; n++)
         {
             d_correlator_outs[n] = gr_complex(0,0);
         }
+    d_correlator_sums = static_cast<gr_complex*>(volk_malloc(d_n_correlator_taps*sizeof(gr_complex), volk_get_alignment()));
     d_local_code_shift_chips = static_cast<float*>(volk_malloc(d_n_correlator_taps*sizeof(float), volk_get_alignment()));
     // Set TAPs delay values [chips]
-    d_local_code_shift_chips[0] = - d_early_late_spc_chips;
-    d_local_code_shift_chips[1] = 0.0;
-    d_local_code_shift_chips[2] = d_early_late_spc_chips;
+    L1_Ca_Nco::tap_shifts(d_early_late_spc_chips, d_local_code_shift_chips);
 
     multicorrelator_cpu.init(2 * d_current_prn_length_samples, d_n_correlator_taps);
+    d_batch_correlators = false;
+    d_batch_wait_us = 0;
+    d_batch_channel = false;
+    d_prn_group = false;
+    d_prn_group_doppler_hz = 0.0;
 
     //--- Perform initializations ------------------------------
     // define initial code frequency basis of NCO
@@ -157,15 +196,31 @@ Gps_L1_Ca_Dll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Pll_Tracking_cc(
     d_pull_in = false;
 
     d_last_seg = 0;
+    d_latency_trace_epochs = 0;
 
     // CN0 estimation and lock detector buffers
     d_cn0_estimation_counter = 0;
     d_Prompt_buffer = new gr_complex[CN0_ESTIMATION_SAMPLES];
     d_carrier_lock_test = 1;
     d_CN0_SNV_dB_Hz = 0;
+    d_last_cn0_db_hz.store(0.0, std::memory_order_relaxed);
     d_carrier_lock_fail_counter = 0;
     d_carrier_lock_threshold = CARRIER_LOCK_THRESHOLD;
 
+    d_vector_tracking = false;
+    d_vector_max_age_s = 2.0;
+    d_vector_max_coast_ms = 5000;
+    d_vector_coasting = false;
+    d_vector_coast_epochs = 0;
+
+    d_bandwidth_schedule = false;
+    d_pll_bw_steady_hz = pll_bw_hz;
+    d_dll_bw_steady_hz = dll_bw_hz;
+    d_steady_cn0_db_hz = 35.0;
+    d_lock_check_decimation = 1;
+    d_steady_state = false;
+    d_steady_checks = 0;
+
     systemName["G"] = std::string("GPS");
     systemName["S"] = std::string("SBAS");
 
@@ -190,6 +245,7 @@ void Gps_L1_Ca_Dll_Pll_Tracking_cc::stop_tracking()
         //std::cout << "stopped tracking" << std::endl;
         //d_carrier_lock_fail_counter = 0;
         d_enable_tracking = false; 
+        d_last_cn0_db_hz.store(0.0, std::memory_order_relaxed);
         //this->message_port_pub(pmt::mp("events"), pmt::from_long(3));//3 -> loss of lock
         d_carrier_lock_fail_counter = MAXIMUM_LOCK_FAIL_COUNTER+1;
     }
@@ -239,22 +295,42 @@ void Gps_L1_Ca_Dll_Pll_Tracking_cc::start_tracking()
     d_acq_code_phase_samples = corrected_acq_phase_samples;
 
     d_carrier_doppler_hz = d_acq_carrier_doppler_hz;
-    d_carrier_phase_step_rad = GPS_TWO_PI * d_carrier_doppler_hz / static_cast<double>(d_fs_in);
+    d_carrier_phase_step_rad = L1_Ca_Nco::carrier_phase_step_rad(d_carrier_doppler_hz, d_fs_in);
+
+    // one code period integrations until the bits are synchronized again
+    d_enable_extended_integration = false;
+    d_preamble_synchronized = false;
+    d_integrated_epochs = 0;
+    d_carr_error_filt_hz = 0.0;
+    d_code_error_filt_chips = 0.0;
+    d_carrier_loop_filter.set_pdi(GPS_L1_CA_CODE_PERIOD);
+    d_carrier_loop_filter.set_PLL_BW(d_pll_bw_hz);
+    d_code_loop_filter.set_pdi(GPS_L1_CA_CODE_PERIOD);
+    d_code_loop_filter.set_DLL_BW(d_dll_bw_hz);
 
     // DLL/PLL filter initialization
     d_carrier_loop_filter.initialize(); // initialize the carrier filter
     d_code_loop_filter.initialize();    // initialize the code filter
 
     // generate local reference ALWAYS starting at chip 1 (1 sample per chip)
-    gps_l1_ca_code_gen_complex(d_ca_code, d_acquisition_gnss_synchro->PRN, 0);
+    Code_Bank::gps_l1_ca_code_gen_complex(d_ca_code, d_acquisition_gnss_synchro->PRN, 0);
 
     multicorrelator_cpu.set_local_code_and_taps(static_cast<int>(GPS_L1_CA_CODE_LENGTH_CHIPS), d_ca_code, d_local_code_shift_chips);
+    d_sqm.reset(d_acquisition_gnss_synchro->PRN);
+    d_array_correlator.set_local_code(static_cast<int>(GPS_L1_CA_CODE_LENGTH_CHIPS), d_ca_code);
+    d_aoa.reset(d_acquisition_gnss_synchro->PRN);
     for (int n = 0; n < d_n_correlator_taps; n++)
         {
             d_correlator_outs[n] = gr_complex(0,0);
         }
 
     d_carrier_lock_fail_counter = 0;
+    d_cn0_estimation_counter = 0;
+    d_vector_coasting = false;
+    d_vector_coast_epochs = 0;
+    d_steady_state = false;
+    d_steady_checks = 0;
+    d_fine_pull_in.reset();
     d_rem_code_phase_samples = 0;
     d_rem_carr_phase_rad = 0.0;
     d_rem_code_phase_chips = 0.0;
@@ -286,22 +362,238 @@ Gps_L1_Ca_Dll_Pll_Tracking_cc::~Gps_L1_Ca_Dll_Pll_Tracking_cc()
 
     volk_free(d_local_code_shift_chips);
     volk_free(d_correlator_outs);
+    volk_free(d_correlator_sums);
     volk_free(d_ca_code);
 
     delete[] d_Prompt_buffer;
     multicorrelator_cpu.free();
+    d_array_correlator.free();
+    set_batch_channel(false);
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_cc::set_batch_channel(bool batch_channel)
+{
+    if (batch_channel != d_batch_channel)
+        {
+            Correlator_Batcher::add_channels(batch_channel ? 1 : -1);
+            d_batch_channel = batch_channel;
+        }
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_cc::set_extended_integration(int extend_correlation_ms, float pll_bw_narrow_hz, float dll_bw_narrow_hz)
+{
+    if (extend_correlation_ms < 1 or GPS_CA_TELEMETRY_SYMBOLS_PER_BIT % extend_correlation_ms != 0)
+        {
+            LOG(WARNING) << "extend_correlation_ms must divide the " << GPS_CA_TELEMETRY_SYMBOLS_PER_BIT
+                         << " code periods of a bit, using 1 instead of " << extend_correlation_ms;
+            extend_correlation_ms = 1;
+        }
+    d_extend_correlation_ms = extend_correlation_ms;
+    d_pll_bw_narrow_hz = pll_bw_narrow_hz;
+    d_dll_bw_narrow_hz = dll_bw_narrow_hz;
 }
 
 
+void Gps_L1_Ca_Dll_Pll_Tracking_cc::set_bandwidth_schedule(bool bandwidth_schedule, float pll_bw_steady_hz, float dll_bw_steady_hz, double steady_cn0_db_hz, int lock_check_decimation)
+{
+    d_bandwidth_schedule = bandwidth_schedule;
+    d_pll_bw_steady_hz = pll_bw_steady_hz;
+    d_dll_bw_steady_hz = dll_bw_steady_hz;
+    d_steady_cn0_db_hz = steady_cn0_db_hz;
+    d_lock_check_decimation = std::max(lock_check_decimation, 1);
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_cc::set_sqm(const std::vector<float>& spacings_chips, int decimation, unsigned int window)
+{
+    if (decimation < 1 or GPS_CA_TELEMETRY_SYMBOLS_PER_BIT % decimation != 0)
+        {
+            LOG(WARNING) << "sqm_decimation must divide the " << GPS_CA_TELEMETRY_SYMBOLS_PER_BIT
+                         << " code periods of a bit, using " << GPS_CA_TELEMETRY_SYMBOLS_PER_BIT << " instead of " << decimation;
+            decimation = GPS_CA_TELEMETRY_SYMBOLS_PER_BIT;
+        }
+    if (spacings_chips.size() > SQM_MAX_PAIRS)
+        {
+            LOG(WARNING) << "Only the first " << SQM_MAX_PAIRS << " SQM spacings are monitored";
+        }
+    d_sqm = Sqm_Monitor(spacings_chips, decimation, window);
+
+    // the extra taps ride along Early, Prompt and Late in the same multicorrelator call
+    volk_free(d_local_code_shift_chips);
+    volk_free(d_correlator_outs);
+    volk_free(d_correlator_sums);
+    d_n_correlator_taps = Gps_L1_Ca_Signal::n_taps + d_sqm.n_taps();
+    d_correlator_outs = static_cast<gr_complex*>(volk_malloc(d_n_correlator_taps*sizeof(gr_complex), volk_get_alignment()));
+    for (int n = 0; n < d_n_correlator_taps; n++)
+        {
+            d_correlator_outs[n] = gr_complex(0,0);
+        }
+    d_correlator_sums = static_cast<gr_complex*>(volk_malloc(d_n_correlator_taps*sizeof(gr_complex), volk_get_alignment()));
+    d_local_code_shift_chips = static_cast<float*>(volk_malloc(d_n_correlator_taps*sizeof(float), volk_get_alignment()));
+    L1_Ca_Nco::tap_shifts(d_early_late_spc_chips, d_local_code_shift_chips);
+    d_sqm.shifts(d_local_code_shift_chips + Gps_L1_Ca_Signal::n_taps);
+
+    multicorrelator_cpu.free();
+    multicorrelator_cpu.init(2 * d_vector_length, d_n_correlator_taps);
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_cc::set_aoa(int decimation, unsigned int averages)
+{
+    d_aoa = Aoa_Monitor(decimation, std::max(averages, 1u));
+    d_array_correlator.free();
+    if (d_aoa.enabled())
+        {
+            d_array_correlator.init(2 * d_vector_length);
+        }
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_cc::set_fine_pull_in(int periods)
+{
+    d_fine_pull_in.configure(periods, GPS_L1_CA_CODE_PERIOD, d_early_late_spc_chips);
+}
 
-int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items __attribute__((unused)), gr_vector_int &ninput_items __attribute__((unused)),
+
+void Gps_L1_Ca_Dll_Pll_Tracking_cc::update_bandwidth_schedule()
+{
+    bool stable = d_carrier_lock_test >= STEADY_CARRIER_LOCK_THRESHOLD and d_CN0_SNV_dB_Hz >= d_steady_cn0_db_hz and !d_vector_coasting;
+    if (!d_steady_state and stable and ++d_steady_checks >= STEADY_LOCK_CHECKS)
+        {
+            d_steady_state = true;
+            if (!d_preamble_synchronized)
+                {
+                    d_carrier_loop_filter.set_PLL_BW(d_pll_bw_steady_hz);
+                    d_code_loop_filter.set_DLL_BW(d_dll_bw_steady_hz);
+                }
+            DLOG(INFO) << "Tracking CH " << d_channel << " steady, pll_bw = " << d_pll_bw_steady_hz << " [Hz], dll_bw = " << d_dll_bw_steady_hz << " [Hz]";
+        }
+    else if (!stable)
+        {
+            if (d_steady_state)
+                {
+                    if (!d_preamble_synchronized)
+                        {
+                            d_carrier_loop_filter.set_PLL_BW(d_pll_bw_hz);
+                            d_code_loop_filter.set_DLL_BW(d_dll_bw_hz);
+                        }
+                    DLOG(INFO) << "Tracking CH " << d_channel << " back to the pull-in bandwidths, CN0 = " << d_CN0_SNV_dB_Hz
+                               << " [dB-Hz], lock = " << d_carrier_lock_test;
+                }
+            d_steady_state = false;
+            d_steady_checks = 0;
+        }
+    if (d_steady_state)
+        {
+            // skip the prompt outputs of the next (decimation - 1) lock checks
+            d_cn0_estimation_counter = -(d_lock_check_decimation - 1) * CN0_ESTIMATION_SAMPLES;
+        }
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_cc::msg_handler_preamble_index(pmt::pmt_t msg)
+{
+    // the telemetry decoder has synchronized the frames, so the bit edges are known
+    if (d_extend_correlation_ms > 1 and d_enable_extended_integration == false) //avoid re-setting preamble indicator
+        {
+            DLOG(INFO) << "Extended correlation enabled for Tracking CH " << d_channel <<  ": Satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN);
+            d_preamble_timestamp_s = pmt::to_double(msg);
+            d_enable_extended_integration = true;
+            d_preamble_synchronized = false;
+        }
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_cc::msg_handler_loop_bandwidths(pmt::pmt_t msg)
+{
+    if (!pmt::is_dict(msg))
+        {
+            LOG(WARNING) << "Tracking CH " << d_channel << ": loop_bandwidths message is not a dictionary";
+            return;
+        }
+    d_pll_bw_hz = pmt::to_double(pmt::dict_ref(msg, pmt::mp("pll_bw_hz"), pmt::from_double(d_pll_bw_hz)));
+    d_dll_bw_hz = pmt::to_double(pmt::dict_ref(msg, pmt::mp("dll_bw_hz"), pmt::from_double(d_dll_bw_hz)));
+    d_pll_bw_narrow_hz = pmt::to_double(pmt::dict_ref(msg, pmt::mp("pll_bw_narrow_hz"), pmt::from_double(d_pll_bw_narrow_hz)));
+    d_dll_bw_narrow_hz = pmt::to_double(pmt::dict_ref(msg, pmt::mp("dll_bw_narrow_hz"), pmt::from_double(d_dll_bw_narrow_hz)));
+    d_pll_bw_steady_hz = pmt::to_double(pmt::dict_ref(msg, pmt::mp("pll_bw_steady_hz"), pmt::from_double(d_pll_bw_steady_hz)));
+    d_dll_bw_steady_hz = pmt::to_double(pmt::dict_ref(msg, pmt::mp("dll_bw_steady_hz"), pmt::from_double(d_dll_bw_steady_hz)));
+    d_steady_cn0_db_hz = pmt::to_double(pmt::dict_ref(msg, pmt::mp("steady_cn0_dbhz"), pmt::from_double(d_steady_cn0_db_hz)));
+
+    // the bandwidths of the current stage of the loops, which keep their state
+    if (d_preamble_synchronized)
+        {
+            d_carrier_loop_filter.set_PLL_BW(d_pll_bw_narrow_hz);
+            d_code_loop_filter.set_DLL_BW(d_dll_bw_narrow_hz);
+        }
+    else if (d_bandwidth_schedule and d_steady_state)
+        {
+            d_carrier_loop_filter.set_PLL_BW(d_pll_bw_steady_hz);
+            d_code_loop_filter.set_DLL_BW(d_dll_bw_steady_hz);
+        }
+    else
+        {
+            d_carrier_loop_filter.set_PLL_BW(d_pll_bw_hz);
+            d_code_loop_filter.set_DLL_BW(d_dll_bw_hz);
+        }
+    LOG(INFO) << "Tracking CH " << d_channel << " reconfigured, pll_bw = " << d_pll_bw_hz << " [Hz], dll_bw = " << d_dll_bw_hz << " [Hz]";
+}
+
+
+bool Gps_L1_Ca_Dll_Pll_Tracking_cc::predicted_doppler(double timestamp_secs, double& doppler_hz)
+{
+    Vector_Tracking_Aid aid;
+    if (sys.compare("G") != 0 or !d_receiver_state->vector_tracking_map.read(d_acquisition_gnss_synchro->PRN, aid))
+        {
+            return false;
+        }
+    double age_s = timestamp_secs - aid.Tracking_timestamp_secs;
+    if (std::abs(age_s) > d_vector_max_age_s)
+        {
+            return false;
+        }
+    doppler_hz = aid.Carrier_Doppler_hz + aid.Carrier_Doppler_rate_hz_s * age_s;
+    return true;
+}
+
+
+int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items, gr_vector_int &ninput_items,
         gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
 {
+    Block_Metrics_Scope metrics_scope(d_metrics.get(), ninput_items[0]);
+    if (d_enable_tracking == false)
+        {
+            // dormant channel: skips in one call all the whole code periods
+            // available, with an idle output (and dump record) for each of
+            // them. The batches must not wait for this channel.
+            set_batch_channel(false);
+            for (int n = 0; n < d_n_correlator_taps; n++)
+                {
+                    d_correlator_outs[n] = gr_complex(0,0);
+                }
+            int epochs = std::min(noutput_items, ninput_items[0] / d_current_prn_length_samples);
+            Gnss_Synchro *dormant = static_cast<Gnss_Synchro *>(output_items[0]);
+            for (int epoch = 0; epoch < epochs; epoch++)
+                {
+                    dormant[epoch] = Gnss_Synchro();
+                    dormant[epoch].System = 'G';
+                    dormant[epoch].Tracking_timestamp_secs = (static_cast<double>(d_sample_counter) + static_cast<double>(d_rem_code_phase_samples)) / static_cast<double>(d_fs_in);
+                    if (d_dump)
+                        {
+                            write_dump_record(0.0, 0.0, 0.0);
+                        }
+                    d_sample_counter += d_current_prn_length_samples;
+                }
+            metrics_scope.set_items(epochs * d_current_prn_length_samples);
+            consume_each(epochs * d_current_prn_length_samples);
+            return output_epochs(dormant, epochs);
+        }
     // process vars
-    double carr_error_hz = 0.0;
-    double carr_error_filt_hz = 0.0;
-    double code_error_chips = 0.0;
-    double code_error_filt_chips = 0.0;
+    float carr_error_hz = 0.0;
+    float carr_error_filt_hz = 0.0;
+    float code_error_chips = 0.0;
+    float code_error_filt_chips = 0.0;
 
     // Block input data and block output stream pointers
     const gr_complex* in = (gr_complex*) input_items[0]; //PRN start block alignment
@@ -327,101 +619,270 @@ int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items __attribute__
                     d_sample_counter = d_sample_counter + samples_offset; //count for the processed samples
                     d_pull_in = false;
                     *out[0] = current_synchro_data;
+                    metrics_scope.set_items(samples_offset);
                     consume_each(samples_offset); //shift input to perform alignment with local replica
-                    return 1;
+                    return output_epochs(out[0], 1);
                 }
 
             // ################# CARRIER WIPEOFF AND CORRELATORS ##############################
             // perform carrier wipe-off and compute Early, Prompt and Late correlation
-            multicorrelator_cpu.set_input_output_vectors(d_correlator_outs, in);
-            multicorrelator_cpu.Carrier_wipeoff_multicorrelator_resampler(d_rem_carr_phase_rad,
-                    d_carrier_phase_step_rad,
-                    d_rem_code_phase_chips,
-                    d_code_phase_step_chips,
-                    d_current_prn_length_samples);
+            set_batch_channel(d_batch_correlators);
+            if (d_batch_correlators)
+                {
+                    // the input is correlated once for all the channels of the batch
+                    Correlator_Job job;
+                    job.sig_in = in;
+                    job.sample_stamp = d_sample_counter;
+                    job.signal_length_samples = d_current_prn_length_samples;
+                    job.rem_carrier_phase_in_rad = d_rem_carr_phase_rad;
+                    job.phase_step_rad = d_carrier_phase_step_rad;
+                    job.rem_code_phase_chips = d_rem_code_phase_chips;
+                    job.code_phase_step_chips = d_code_phase_step_chips;
+                    job.local_code_in = d_ca_code;
+                    job.code_length_chips = static_cast<int>(GPS_L1_CA_CODE_LENGTH_CHIPS);
+                    job.shifts_chips = d_local_code_shift_chips;
+                    job.n_correlators = d_n_correlator_taps;
+                    job.corr_out = d_correlator_outs;
+                    job.prn_group = d_prn_group ? d_acquisition_gnss_synchro->PRN : 0;
+                    job.group_phase_step_rad = static_cast<float>(GPS_TWO_PI * d_prn_group_doppler_hz / static_cast<double>(d_fs_in));
+                    Correlator_Batcher::correlate(job, d_batch_wait_us);
+                }
+            else
+                {
+                    multicorrelator_cpu.set_input_output_vectors(d_correlator_outs, in);
+                    multicorrelator_cpu.Carrier_wipeoff_multicorrelator_resampler(d_rem_carr_phase_rad,
+                            d_carrier_phase_step_rad,
+                            d_rem_code_phase_chips,
+                            d_code_phase_step_chips,
+                            d_current_prn_length_samples);
+                }
+
+            // Prompt of the elements of the antenna array, once every aoa_decimation code periods
+            if (d_aoa.enabled() and input_items.size() > 1 and d_aoa.next_period())
+                {
+                    const gr_complex* elements[AOA_MAX_ELEMENTS];
+                    int n_elements = std::min(static_cast<int>(input_items.size()) - 1, AOA_MAX_ELEMENTS);
+                    for (int k = 0; k < n_elements; k++)
+                        {
+                            elements[k] = static_cast<const gr_complex*>(input_items[1 + k]);
+                        }
+                    if (d_array_correlator.Carrier_wipeoff_array_correlator(d_element_prompts, elements, n_elements,
+                            d_rem_carr_phase_rad, d_carrier_phase_step_rad, d_rem_code_phase_chips, d_code_phase_step_chips,
+                            d_current_prn_length_samples)
+                            and d_aoa.add(d_element_prompts, n_elements, d_sample_counter))
+                        {
+                            d_receiver_state->aoa_map.write(d_channel, d_aoa.metrics());
+                        }
+                }
+
+            // ################## FINE PULL-IN ################################################
+            // the first code periods run on the acquisition NCOs, and refine them at once
+            bool refining = d_fine_pull_in.active();
+            double pull_in_code_error_secs = 0.0;
+            if (refining and d_fine_pull_in.add(d_correlator_outs[0], d_correlator_outs[1], d_correlator_outs[2])
+                    and d_fine_pull_in.reliable())
+                {
+                    d_acq_carrier_doppler_hz += d_fine_pull_in.doppler_error_hz();
+                    pull_in_code_error_secs = d_fine_pull_in.code_error_chips() / GPS_L1_CA_CODE_RATE_HZ;
+                    DLOG(INFO) << "Fine pull-in of CH " << d_channel << ": Doppler error " << d_fine_pull_in.doppler_error_hz()
+                               << " [Hz], code phase error " << d_fine_pull_in.code_error_chips() << " [chips]";
+                }
+
+            // ################## COHERENT INTEGRATION EXTENSION ##############################
+            // once the bits are synchronized, the code periods of a bit are integrated coherently,
+            // and the loops are closed once per extend_correlation_ms periods
+            const gr_complex* loop_outs = d_correlator_outs;
+            int integration_ms = 1;
+            bool close_loops = !refining;
+            bool start_extended_integration = false;
+            if (d_preamble_synchronized)
+                {
+                    for (int n = 0; n < d_n_correlator_taps; n++)
+                        {
+                            d_correlator_sums[n] = (d_integrated_epochs == 0) ? d_correlator_outs[n] : d_correlator_sums[n] + d_correlator_outs[n];
+                        }
+                    d_integrated_epochs++;
+                    if (d_integrated_epochs == d_extend_correlation_ms)
+                        {
+                            loop_outs = d_correlator_sums;
+                            integration_ms = d_extend_correlation_ms;
+                            d_integrated_epochs = 0;
+                        }
+                    else
+                        {
+                            // the NCOs keep the last loop commands
+                            close_loops = false;
+                        }
+                }
+            else if (d_enable_extended_integration)
+                {
+                    long int symbol_diff = round(1000.0 * ((static_cast<double>(d_sample_counter) + d_rem_code_phase_samples) / static_cast<double>(d_fs_in) - d_preamble_timestamp_s));
+                    // this code period is the last one of a bit
+                    start_extended_integration = (symbol_diff > 0 and symbol_diff % d_extend_correlation_ms == 0);
+                }
 
             // ################## PLL ##########################################################
-            // PLL discriminator
-            // Update PLL discriminator [rads/Ti -> Secs/Ti]
-            carr_error_hz = pll_cloop_two_quadrant_atan(d_correlator_outs[1]) / GPS_TWO_PI; //prompt output
-            // Carrier discriminator filter
-            carr_error_filt_hz = d_carrier_loop_filter.get_carrier_nco(carr_error_hz);
+            if (close_loops)
+                {
+                    // PLL discriminator
+                    // Update PLL discriminator [rads/Ti -> Secs/Ti]
+                    carr_error_hz = pll_cloop_two_quadrant_atan(loop_outs[1]) / static_cast<float>(GPS_TWO_PI); //prompt output
+                    // Carrier discriminator filter
+                    d_carr_error_filt_hz = d_carrier_loop_filter.get_carrier_nco(carr_error_hz);
+                }
+            carr_error_filt_hz = d_carr_error_filt_hz;
+            if (d_vector_coasting)
+                {
+                    // the loop only tracks the residual of the Doppler predicted by the PVT solution
+                    double vector_doppler_hz;
+                    if (predicted_doppler((static_cast<double>(d_sample_counter) + d_rem_code_phase_samples) / static_cast<double>(d_fs_in), vector_doppler_hz))
+                        {
+                            d_acq_carrier_doppler_hz = vector_doppler_hz;
+                        }
+                    d_vector_coast_epochs++;
+                }
             // New carrier Doppler frequency estimation
             d_carrier_doppler_hz = d_acq_carrier_doppler_hz + carr_error_filt_hz;
 
             // New code Doppler frequency estimation
-            d_code_freq_chips = GPS_L1_CA_CODE_RATE_HZ + ((d_carrier_doppler_hz * GPS_L1_CA_CODE_RATE_HZ) / GPS_L1_FREQ_HZ);
+            d_code_freq_chips = L1_Ca_Nco::code_freq_chips(d_carrier_doppler_hz);
             //carrier phase accumulator for (K) doppler estimation
-            d_acc_carrier_phase_rad -= GPS_TWO_PI * d_carrier_doppler_hz * GPS_L1_CA_CODE_PERIOD;
+            d_acc_carrier_phase_rad -= L1_Ca_Nco::period_phase_rad(d_carrier_doppler_hz);
             //remanent carrier phase to prevent overflow in the code NCO
-            d_rem_carr_phase_rad = d_rem_carr_phase_rad + GPS_TWO_PI * ( d_if_freq + d_carrier_doppler_hz ) * GPS_L1_CA_CODE_PERIOD;
-            d_rem_carr_phase_rad = fmod(d_rem_carr_phase_rad, GPS_TWO_PI);
+            d_rem_carr_phase_rad = L1_Ca_Nco::wrap_phase_rad(d_rem_carr_phase_rad + L1_Ca_Nco::period_phase_rad(d_if_freq + d_carrier_doppler_hz));
 
             // ################## DLL ##########################################################
-            // DLL discriminator
-            code_error_chips = dll_nc_e_minus_l_normalized(d_correlator_outs[0], d_correlator_outs[2]); //[chips/Ti] //early and late
-            // Code discriminator filter
-            code_error_filt_chips = d_code_loop_filter.get_code_nco(code_error_chips); //[chips/second]
+            if (close_loops)
+                {
+                    // DLL discriminator
+                    code_error_chips = dll_nc_e_minus_l_normalized(loop_outs[0], loop_outs[2]); //[chips/Ti] //early and late
+                    // Code discriminator filter
+                    if (d_vector_coasting)
+                        {
+                            // the code NCO is only aided by the carrier, the discriminator is noise
+                            d_code_error_filt_chips = 0.0;
+                        }
+                    else
+                        {
+                            d_code_error_filt_chips = d_code_loop_filter.get_code_nco(code_error_chips); //[chips/second]
+                        }
+                }
+            code_error_filt_chips = d_code_error_filt_chips;
             //Code phase accumulator
             double code_error_filt_secs;
-            code_error_filt_secs = (GPS_L1_CA_CODE_PERIOD * code_error_filt_chips) / GPS_L1_CA_CODE_RATE_HZ; //[seconds]
+            code_error_filt_secs = L1_Ca_Nco::code_error_secs(code_error_filt_chips) + pull_in_code_error_secs; //[seconds]
             d_acc_code_phase_secs = d_acc_code_phase_secs + code_error_filt_secs;
 
             // ################## CARRIER AND CODE NCO BUFFER ALIGNEMENT #######################
             // keep alignment parameters for the next input buffer
-            double T_chip_seconds;
-            double T_prn_seconds;
-            double T_prn_samples;
-            double K_blk_samples;
             // Compute the next buffer length based in the new period of the PRN sequence and the code phase error estimation
-            T_chip_seconds = 1 / static_cast<double>(d_code_freq_chips);
-            T_prn_seconds = T_chip_seconds * GPS_L1_CA_CODE_LENGTH_CHIPS;
-            T_prn_samples = T_prn_seconds * static_cast<double>(d_fs_in);
-            K_blk_samples = T_prn_samples + d_rem_code_phase_samples + code_error_filt_secs * static_cast<double>(d_fs_in);
+            double K_blk_samples = L1_Ca_Nco::next_period_samples(d_code_freq_chips, d_rem_code_phase_samples, code_error_filt_secs, d_fs_in);
             d_current_prn_length_samples = round(K_blk_samples); //round to a discrete samples
 
             //################### PLL COMMANDS #################################################
             //carrier phase step (NCO phase increment per sample) [rads/sample]
-            d_carrier_phase_step_rad = GPS_TWO_PI * d_carrier_doppler_hz / static_cast<double>(d_fs_in);
+            d_carrier_phase_step_rad = L1_Ca_Nco::carrier_phase_step_rad(d_carrier_doppler_hz, d_fs_in);
 
             //################### DLL COMMANDS #################################################
             //code phase step (Code resampler phase increment per sample) [chips/sample]
-            d_code_phase_step_chips = d_code_freq_chips / static_cast<double>(d_fs_in);
+            d_code_phase_step_chips = L1_Ca_Nco::code_phase_step(d_code_freq_chips, d_fs_in);
             //remnant code phase [chips]
-            d_rem_code_phase_chips = d_rem_code_phase_samples * (d_code_freq_chips / static_cast<double>(d_fs_in));
+            d_rem_code_phase_chips = L1_Ca_Nco::rem_code_phase(d_rem_code_phase_samples, d_code_freq_chips, d_fs_in);
 
             // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
-            if (d_cn0_estimation_counter < CN0_ESTIMATION_SAMPLES)
+            // they run at the rate of the loops, on the integrated prompt outputs
+            if (close_loops and d_cn0_estimation_counter < 0)
+                {
+                    // steady channel, this period is not checked
+                    d_cn0_estimation_counter++;
+                }
+            else if (close_loops and d_cn0_estimation_counter < CN0_ESTIMATION_SAMPLES)
                 {
                     // fill buffer with prompt correlator output values
-                    d_Prompt_buffer[d_cn0_estimation_counter] = d_correlator_outs[1]; //prompt
+                    d_Prompt_buffer[d_cn0_estimation_counter] = loop_outs[1]; //prompt
                     d_cn0_estimation_counter++;
                 }
-            else
+            else if (close_loops)
                 {
                     d_cn0_estimation_counter = 0;
-                    // Code lock indicator
-                    d_CN0_SNV_dB_Hz = cn0_svn_estimator(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in, GPS_L1_CA_CODE_LENGTH_CHIPS);
-                    // Carrier lock indicator
-                    d_carrier_lock_test = carrier_lock_detector(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES);
-                    // Loss of lock detection
-                    if (d_carrier_lock_test < d_carrier_lock_threshold or d_CN0_SNV_dB_Hz < MINIMUM_VALID_CN0)
+                    // Code and carrier lock indicators, in one pass over the prompt buffer
+                    float cn0_db_hz;
+                    float carrier_lock_test;
+                    cn0_and_carrier_lock(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in, integration_ms * GPS_L1_CA_CODE_LENGTH_CHIPS,
+                            &cn0_db_hz, &carrier_lock_test);
+                    d_CN0_SNV_dB_Hz = cn0_db_hz;
+                    d_last_cn0_db_hz.store(cn0_db_hz, std::memory_order_relaxed);
+                    d_carrier_lock_test = carrier_lock_test;
+                    // Loss of lock detection, the counter is kept in code periods
+                    // and a check stands for the periods skipped since the previous one
+                    int checked_ms = integration_ms * (d_steady_state ? d_lock_check_decimation : 1);
+                    if (d_carrier_lock_test < d_carrier_lock_threshold or
+                            d_CN0_SNV_dB_Hz < (integration_ms > 1 ? MINIMUM_VALID_CN0_EXTENDED : MINIMUM_VALID_CN0))
                         {
-                            d_carrier_lock_fail_counter++;
+                            d_carrier_lock_fail_counter += checked_ms;
                         }
                     else
                         {
-                            if (d_carrier_lock_fail_counter > 0) d_carrier_lock_fail_counter--;
+                            d_carrier_lock_fail_counter = std::max(d_carrier_lock_fail_counter - checked_ms, 0);
+                            if (d_vector_coasting)
+                                {
+                                    LOG(INFO) << "Channel " << d_channel << " recovered the signal after coasting " << d_vector_coast_epochs << " ms";
+                                    d_vector_coasting = false;
+                                    d_vector_coast_epochs = 0;
+                                }
+                            // last in-lock state, to reacquire the satellite close to it if the lock is lost
+                            Gnss_Synchro lock_state = *d_acquisition_gnss_synchro;
+                            lock_state.Carrier_Doppler_hz = d_carrier_doppler_hz;
+                            lock_state.sample_counter = d_sample_counter + static_cast<long int>(round(d_rem_code_phase_samples));
+                            d_receiver_state->gps_reacquisition_map.write(reacquisition_key(lock_state.PRN, lock_state.peak), lock_state);
+                        }
+                    double vector_doppler_hz;
+                    if (d_carrier_lock_fail_counter > MAXIMUM_LOCK_FAIL_COUNTER and d_vector_tracking
+                            and d_vector_coast_epochs < d_vector_max_coast_ms
+                            and predicted_doppler((static_cast<double>(d_sample_counter) + d_rem_code_phase_samples) / static_cast<double>(d_fs_in), vector_doppler_hz))
+                        {
+                            // coast on the PVT solution instead of dropping the satellite
+                            if (!d_vector_coasting)
+                                {
+                                    LOG(INFO) << "Channel " << d_channel << " lost the lock, coasting on the PVT Doppler " << vector_doppler_hz << " [Hz]";
+                                    d_vector_coasting = true;
+                                    d_acq_carrier_doppler_hz = vector_doppler_hz;
+                                    d_carrier_loop_filter.initialize();
+                                    d_carr_error_filt_hz = 0.0;
+                                    d_code_error_filt_chips = 0.0;
+                                }
+                            d_carrier_lock_fail_counter = MAXIMUM_LOCK_FAIL_COUNTER;
+                        }
+                    if (d_bandwidth_schedule)
+                        {
+                            update_bandwidth_schedule();
                         }
                     if (d_carrier_lock_fail_counter > MAXIMUM_LOCK_FAIL_COUNTER)
                         {
+                            d_vector_coasting = false;
+                            d_vector_coast_epochs = 0;
                             std::cout << "Loss of lock in channel " << d_channel << "!" << std::endl;
                             LOG(INFO) << "Loss of lock in channel " << d_channel << "!";
-                            this->message_port_pub(pmt::mp("events"), pmt::from_long(3));//3 -> loss of lock
+                            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_LOSS_OF_LOCK));
                             d_carrier_lock_fail_counter = 0;
+                            d_last_cn0_db_hz.store(0.0, std::memory_order_relaxed);
                             d_enable_tracking = false; // TODO: check if disabling tracking is consistent with the channel state machine
                         }
                 }
+            if (start_extended_integration)
+                {
+                    d_preamble_synchronized = true;
+                    d_integrated_epochs = 0;
+                    d_cn0_estimation_counter = 0;
+                    d_carrier_loop_filter.set_pdi(static_cast<double>(d_extend_correlation_ms) * GPS_L1_CA_CODE_PERIOD);
+                    d_carrier_loop_filter.set_PLL_BW(d_pll_bw_narrow_hz);
+                    d_code_loop_filter.set_pdi(static_cast<double>(d_extend_correlation_ms) * GPS_L1_CA_CODE_PERIOD);
+                    d_code_loop_filter.set_DLL_BW(d_dll_bw_narrow_hz);
+                    LOG(INFO) << "Enabled " << d_extend_correlation_ms << " [ms] extended correlator for CH " << d_channel
+                              << " : Satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN)
+                              << " pll_narrow_bw = " << d_pll_bw_narrow_hz << " [Hz], dll_narrow_bw = " << d_dll_bw_narrow_hz << " [Hz]";
+                }
+
             // ########### Output the tracking data to navigation and PVT ##########
             current_synchro_data.Prompt_I = static_cast<double>((d_correlator_outs[1]).real());
             current_synchro_data.Prompt_Q = static_cast<double>((d_correlator_outs[1]).imag());
@@ -437,26 +898,28 @@ int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items __attribute__
             current_synchro_data.Carrier_phase_rads = d_acc_carrier_phase_rad;
             current_synchro_data.Carrier_Doppler_hz = d_carrier_doppler_hz;
             current_synchro_data.CN0_dB_hz = d_CN0_SNV_dB_Hz;
-            current_synchro_data.Flag_valid_symbol_output = true;
+            current_synchro_data.Flag_valid_symbol_output = !refining;
             current_synchro_data.correlation_length_ms = 1;
 
-            //Vestigial - flog
-            float delta_ = delta(d_correlator_outs[0], d_correlator_outs[1], d_correlator_outs[2]);
-            float RT_ = RT(d_correlator_outs[0], d_correlator_outs[1], d_correlator_outs[2]);
-            float ELP_ = ELP(d_correlator_outs[0], d_correlator_outs[1], d_correlator_outs[2]);
-            float MD_ = MD(d_correlator_outs[0], d_correlator_outs[1], d_correlator_outs[2]);
-            current_synchro_data.delta = delta_;
-            current_synchro_data.RT = RT_;
-            current_synchro_data.ELP = ELP_;
-            current_synchro_data.MD = MD_;
-            current_synchro_data.Early_I = (double)(d_correlator_outs[0]).real();
-            current_synchro_data.Early_Q = (double)(d_correlator_outs[0]).imag();
-            current_synchro_data.Late_I = (double)(d_correlator_outs[2]).real();
-            current_synchro_data.Late_Q = (double)(d_correlator_outs[2]).imag();
             current_synchro_data.sample_counter = d_sample_counter;
-            current_synchro_data.Early = &d_correlator_outs[0];
-            current_synchro_data.Prompt = &d_correlator_outs[1];
-            current_synchro_data.Late = &d_correlator_outs[2];
+            if (++d_latency_trace_epochs == LATENCY_TRACE_EPOCHS)
+                {
+                    d_latency_trace_epochs = 0;
+                    LATENCY_TRACE(LATENCY_TRACKING, d_channel, d_sample_counter);
+                }
+
+            // correlator taps for the spoofing checks, outside Gnss_Synchro
+            Correlator_Taps taps;
+            taps.PRN = d_acquisition_gnss_synchro->PRN;
+            taps.sample_counter = d_sample_counter;
+            taps.Early = d_correlator_outs[0];
+            taps.Prompt = d_correlator_outs[1];
+            taps.Late = d_correlator_outs[2];
+            d_receiver_state->correlator_taps_map.write(d_channel, taps);
+            if (d_sqm.enabled() and d_sqm.add(d_correlator_outs[1], d_correlator_outs + Gps_L1_Ca_Signal::n_taps, d_sample_counter))
+                {
+                    d_receiver_state->sqm_map.write(d_channel, d_sqm.metrics());
+                }
 
             if (floor(d_sample_counter / d_fs_in) != d_last_seg)
             {
@@ -466,95 +929,91 @@ int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items __attribute__
             }
 
         }
-    else
-        {
-            for (int n = 0; n < d_n_correlator_taps; n++)
-                {
-                    d_correlator_outs[n] = gr_complex(0,0);
-                }
-
-            current_synchro_data.Tracking_timestamp_secs = (static_cast<double>(d_sample_counter) + static_cast<double>(d_rem_code_phase_samples)) / static_cast<double>(d_fs_in);
-            current_synchro_data.System = {'G'};
-        }
 
     //assign the GNURadio block output data
     *out[0] = current_synchro_data;
     if(d_dump)
         {
-            // MULTIPLEXED FILE RECORDING - Record results to file
-            float prompt_I;
-            float prompt_Q;
-            float tmp_E, tmp_P, tmp_L;
-            double tmp_double;
-            prompt_I = d_correlator_outs[1].real();
-            prompt_Q = d_correlator_outs[1].imag();
-            tmp_E = std::abs<float>(d_correlator_outs[0]);
-            tmp_P = std::abs<float>(d_correlator_outs[1]);
-            tmp_L = std::abs<float>(d_correlator_outs[2]);
-            float delta_ = delta(d_correlator_outs[0], d_correlator_outs[1], d_correlator_outs[2]);
-            float RT_ = RT(d_correlator_outs[0], d_correlator_outs[1], d_correlator_outs[2]);
-            float ELP_ = ELP(d_correlator_outs[0], d_correlator_outs[1], d_correlator_outs[2]);
-            float MD_ = MD(d_correlator_outs[0], d_correlator_outs[1], d_correlator_outs[2]);
-            try
-            {
-                // EPR
-                d_dump_file.write(reinterpret_cast<char*>(&tmp_E), sizeof(float));
-                d_dump_file.write(reinterpret_cast<char*>(&tmp_P), sizeof(float));
-                d_dump_file.write(reinterpret_cast<char*>(&tmp_L), sizeof(float));
-                // PROMPT I and Q (to analyze navigation symbols)
-                d_dump_file.write(reinterpret_cast<char*>(&prompt_I), sizeof(float));
-                d_dump_file.write(reinterpret_cast<char*>(&prompt_Q), sizeof(float));
-                // PRN start sample stamp
-                //tmp_float=(float)d_sample_counter;
-                d_dump_file.write(reinterpret_cast<char*>(&d_sample_counter), sizeof(unsigned long int));
-                // accumulated carrier phase
-                d_dump_file.write(reinterpret_cast<char*>(&d_acc_carrier_phase_rad), sizeof(double));
-
-                // carrier and code frequency
-                d_dump_file.write(reinterpret_cast<char*>(&d_carrier_doppler_hz), sizeof(double));
-                d_dump_file.write(reinterpret_cast<char*>(&d_code_freq_chips), sizeof(double));
-
-                //PLL commands
-                d_dump_file.write(reinterpret_cast<char*>(&carr_error_hz), sizeof(double));
-                d_dump_file.write(reinterpret_cast<char*>(&d_carrier_doppler_hz), sizeof(double));
-
-                //DLL commands
-                d_dump_file.write(reinterpret_cast<char*>(&code_error_chips), sizeof(double));
-                d_dump_file.write(reinterpret_cast<char*>(&code_error_filt_chips), sizeof(double));
-
-                // CN0 and carrier lock test
-                d_dump_file.write(reinterpret_cast<char*>(&d_CN0_SNV_dB_Hz), sizeof(double));
-                d_dump_file.write(reinterpret_cast<char*>(&d_carrier_lock_test), sizeof(double));
-
-                // AUX vars (for debug purposes)
-                tmp_double = d_rem_code_phase_samples;
-                d_dump_file.write(reinterpret_cast<char*>(&tmp_double), sizeof(double));
-                tmp_double = static_cast<double>(d_sample_counter + d_current_prn_length_samples);
-                d_dump_file.write(reinterpret_cast<char*>(&tmp_double), sizeof(double));
-
-                // vestigial signal defense paramenters
-                d_dump_file.write((char*)&delta_, sizeof(float));
-                d_dump_file.write((char*)&RT_, sizeof(float));
-                d_dump_file.write((char*)&ELP_, sizeof(float));
-                d_dump_file.write((char*)&MD_, sizeof(float));
-            }
-            catch (const std::ifstream::failure &e)
-            {
-                    LOG(WARNING) << "Exception writing trk dump file " << e.what();
-            }
+            write_dump_record(carr_error_hz, code_error_chips, code_error_filt_chips);
         }
 
+    metrics_scope.set_items(d_current_prn_length_samples);
     consume_each(d_current_prn_length_samples); // this is necessary in gr::block derivates
     d_sample_counter += d_current_prn_length_samples; //count for the processed samples
 
-    return 1; //output tracking result ALWAYS even in the case of d_enable_tracking==false
+    return output_epochs(out[0], 1);
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_cc::write_dump_record(float carr_error_hz, float code_error_chips, float code_error_filt_chips)
+{
+    // MULTIPLEXED FILE RECORDING - Record results to file
+    Tracking_Dump_Record record;
+    // EPR
+    record.abs_E = std::abs<float>(d_correlator_outs[0]);
+    record.abs_P = std::abs<float>(d_correlator_outs[1]);
+    record.abs_L = std::abs<float>(d_correlator_outs[2]);
+    // PROMPT I and Q (to analyze navigation symbols)
+    record.prompt_I = d_correlator_outs[1].real();
+    record.prompt_Q = d_correlator_outs[1].imag();
+    // PRN start sample stamp
+    record.PRN_start_sample = d_sample_counter;
+    // accumulated carrier phase
+    record.acc_carrier_phase_rad = d_acc_carrier_phase_rad;
+    // carrier and code frequency
+    record.carrier_doppler_hz = d_carrier_doppler_hz;
+    record.code_freq_chips = d_code_freq_chips;
+    //PLL commands
+    record.carr_error_hz = carr_error_hz;
+    record.carr_nco_hz = d_carrier_doppler_hz;
+    //DLL commands
+    record.code_error_chips = code_error_chips;
+    record.code_nco_chips = code_error_filt_chips;
+    // CN0 and carrier lock test
+    record.CN0_SNV_dB_Hz = d_CN0_SNV_dB_Hz;
+    record.carrier_lock_test = d_carrier_lock_test;
+    // AUX vars (for debug purposes)
+    record.rem_code_phase_samples = d_rem_code_phase_samples;
+    record.next_PRN_start_sample = static_cast<double>(d_sample_counter + d_current_prn_length_samples);
+    // vestigial signal defense paramenters
+    record.delta = delta(d_correlator_outs[0], d_correlator_outs[1], d_correlator_outs[2]);
+    record.RT = RT(d_correlator_outs[0], d_correlator_outs[1], d_correlator_outs[2]);
+    record.ELP = ELP(d_correlator_outs[0], d_correlator_outs[1], d_correlator_outs[2]);
+    record.MD = MD(d_correlator_outs[0], d_correlator_outs[1], d_correlator_outs[2]);
+    d_dump_file.write(record);
 }
 
 
+void Gps_L1_Ca_Dll_Pll_Tracking_cc::set_synchro_stage(boost::shared_ptr<Gnss_Synchro_Stage> stage)
+{
+    d_synchro_stage = stage;
+    if (d_synchro_stage)
+        {
+            d_synchro_stage->attach_to(this);
+        }
+}
+
+
+int Gps_L1_Ca_Dll_Pll_Tracking_cc::output_epochs(Gnss_Synchro* out, int epochs)
+{
+    if (!d_synchro_stage)
+        {
+            return epochs;
+        }
+    // the stage writes at most one output per epoch, so out[i] is read before it is overwritten
+    int produced = 0;
+    for (int i = 0; i < epochs; i++)
+        {
+            produced += d_synchro_stage->push_epoch(out[i], out + produced);
+        }
+    return produced;
+}
+
 
 void Gps_L1_Ca_Dll_Pll_Tracking_cc::set_channel(unsigned int channel)
 {
     d_channel = channel;
+    d_metrics = make_block_metrics("tracking", "ch" + std::to_string(channel));
     LOG(INFO) << "Tracking Channel set to " << d_channel;
     std::string d_dump_signal_filename = "input_signal_";
     std::string d_dump_signal_filename_wo = "carrier_wipeoff_";
@@ -563,18 +1022,16 @@ void Gps_L1_Ca_Dll_Pll_Tracking_cc::set_channel(unsigned int channel)
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
-                            d_dump_filename.append(".dat");
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                    d_dump_filename.append(".dat");
+                    if (d_dump_file.open(d_dump_filename))
+                        {
                             LOG(INFO) << "Tracking dump enabled on channel " << d_channel << " Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (const std::ifstream::failure &e)
-                    {
-                            LOG(WARNING) << "channel " << d_channel << " Exception opening trk dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << d_channel << " cannot open trk dump file " << d_dump_filename;
+                        }
                 }
 
 /*
@@ -37,14 +37,24 @@
 #ifndef GNSS_SDR_GPS_L1_CA_DLL_PLL_TRACKING_CC_H
 #define GNSS_SDR_GPS_L1_CA_DLL_PLL_TRACKING_CC_H
 
+#include <atomic>
 #include <fstream>
 #include <map>
 #include <string>
 #include <gnuradio/block.h>
 #include "gnss_synchro.h"
+#include "receiver_state.h"
 #include "tracking_2nd_DLL_filter.h"
 #include "tracking_2nd_PLL_filter.h"
+#include "tracking_dump_writer.h"
 #include "cpu_multicorrelator.h"
+#include "cpu_multicorrelator_batch.h"
+#include "block_metrics.h"
+#include "sqm_monitor.h"
+#include "aoa_monitor.h"
+#include "cpu_array_correlator.h"
+#include "fine_pull_in.h"
+#include "gnss_synchro_stage.h"
 
 class Gps_L1_Ca_Dll_Pll_Tracking_cc;
 
@@ -66,7 +76,7 @@ gps_l1_ca_dll_pll_make_tracking_cc(long if_freq,
 /*!
  * \brief This class implements a DLL + PLL tracking loop block
  */
-class Gps_L1_Ca_Dll_Pll_Tracking_cc: public gr::block
+class Gps_L1_Ca_Dll_Pll_Tracking_cc: public gr::block, public Gnss_Synchro_Stage_Host
 {
 public:
     ~Gps_L1_Ca_Dll_Pll_Tracking_cc();
@@ -76,6 +86,103 @@ public:
     void start_tracking();
     void stop_tracking();
 
+    //! Last C/N0 estimate [dB-Hz], 0 while not tracking. It can be read from any thread.
+    double cn0_db_hz() const { return d_last_cn0_db_hz.load(std::memory_order_relaxed); }
+
+    /*!
+     * \brief Correlates in batches with the other tracking channels (see Correlator_Batcher)
+     * \param wait_us - maximum wait for the other channels to join a batch [us]
+     */
+    void set_batch_correlators(bool batch_correlators, unsigned int wait_us)
+    {
+        d_batch_correlators = batch_correlators;
+        d_batch_wait_us = wait_us;
+    }
+
+    /*!
+     * \brief With the batch correlators, shares the carrier wipeoff and the
+     * resampler call of the batch with the other channels of the same PRN
+     * whose carrier Doppler is at most max_doppler_distance_hz away, such as
+     * the auxiliary channels of APT (see cpu_multicorrelator_batch). Each
+     * channel keeps its own loops.
+     */
+    void set_prn_group(bool prn_group, float max_doppler_distance_hz)
+    {
+        d_prn_group = prn_group;
+        d_prn_group_doppler_hz = max_doppler_distance_hz;
+    }
+
+    /*!
+     * \brief Integrates coherently extend_correlation_ms code periods once the bits are synchronized
+     *
+     * The loops then run once per integration, with the narrow bandwidths.
+     * extend_correlation_ms must divide the 20 code periods of a bit, 1 disables it.
+     */
+    void set_extended_integration(int extend_correlation_ms, float pll_bw_narrow_hz, float dll_bw_narrow_hz);
+
+    /*!
+     * \brief Coasts on the carrier Doppler predicted by the PVT solution when the signal is lost
+     * \param max_age_s - oldest prediction the channel can coast on [s]
+     * \param max_coast_ms - longest coasting before the loss of lock is declared [ms]
+     */
+    void set_vector_tracking(bool vector_tracking, double max_age_s, int max_coast_ms)
+    {
+        d_vector_tracking = vector_tracking;
+        d_vector_max_age_s = max_age_s;
+        d_vector_max_coast_ms = max_coast_ms;
+    }
+
+    /*!
+     * \brief Narrows the loops once the channel is steady, and widens them again when it is not
+     *
+     * The channel pulls in with the configured bandwidths. After a few lock
+     * checks in a row with a carrier lock test above 0.95 and a CN0 above
+     * steady_cn0_db_hz, the loops switch to the steady bandwidths and the
+     * lock detectors only use one of every lock_check_decimation buffers of
+     * prompt outputs. Once the bits are synchronized the extended
+     * integration bandwidths take precedence.
+     */
+    void set_bandwidth_schedule(bool bandwidth_schedule, float pll_bw_steady_hz, float dll_bw_steady_hz, double steady_cn0_db_hz, int lock_check_decimation);
+
+    /*!
+     * \brief Monitors the distortion of the correlation peak (see Sqm_Monitor)
+     *
+     * A pair of taps at -d and +d chips from Prompt is added for each spacing
+     * d, and the metrics are written to the sqm_map of the receiver once every decimation
+     * code periods. An empty spacings_chips disables it.
+     */
+    void set_sqm(const std::vector<float>& spacings_chips, int decimation, unsigned int window);
+
+    /*!
+     * \brief Estimates the direction of arrival on an antenna array (see Aoa_Monitor)
+     *
+     * Inputs 1 to AOA_MAX_ELEMENTS take the samples of the elements, aligned
+     * with input 0. Their Prompt is correlated once every decimation code
+     * periods, and the metrics are written to the aoa_map of the receiver. A decimation
+     * of 0 disables it.
+     */
+    void set_aoa(int decimation, unsigned int averages);
+
+    /*!
+     * \brief Refines the acquisition Doppler and code phase before the loops are closed (see Fine_Pull_In)
+     *
+     * The first periods code periods after the alignment with the
+     * acquisition are correlated with open loops, and their Doppler and code
+     * phase errors are removed from the NCOs at once. 0 disables it.
+     */
+    void set_fine_pull_in(int periods);
+
+    //! Runs the telemetry decoder of the channel inline, at the end of each call
+    void set_synchro_stage(boost::shared_ptr<Gnss_Synchro_Stage> stage);
+
+    /*
+     * The "loop_bandwidths" message input takes a pmt dictionary with any of
+     * pll_bw_hz, dll_bw_hz, pll_bw_narrow_hz, dll_bw_narrow_hz,
+     * pll_bw_steady_hz, dll_bw_steady_hz [Hz] and steady_cn0_dbhz [dB-Hz].
+     * They are changed in the block thread, between two calls to
+     * general_work, so the loops keep their lock.
+     */
+
     int general_work (int noutput_items, gr_vector_int &ninput_items,
             gr_vector_const_void_star &input_items, gr_vector_void_star &output_items);
 
@@ -106,13 +213,19 @@ private:
     bool d_dump;
 
     Gnss_Synchro* d_acquisition_gnss_synchro;
+    std::shared_ptr<Receiver_State> d_receiver_state; // tables of the receiver, current at construction
     unsigned int d_channel;
+    std::shared_ptr<Block_Metrics> d_metrics; // made by set_channel
+    boost::shared_ptr<Gnss_Synchro_Stage> d_synchro_stage;
+    int output_epochs(Gnss_Synchro* out, int epochs); // through d_synchro_stage, if any
+    void write_dump_record(float carr_error_hz, float code_error_chips, float code_error_filt_chips); // of the current epoch
 
     long d_if_freq;
     long d_fs_in;
     int d_last_seg;
+    unsigned int d_latency_trace_epochs; // one tracking epoch in LATENCY_TRACE_EPOCHS is traced
 
-    double d_early_late_spc_chips;
+    float d_early_late_spc_chips;
 
     // remaining code phase and carrier phase between tracking loops
     double d_rem_code_phase_samples;
@@ -132,6 +245,12 @@ private:
     float* d_local_code_shift_chips;
     gr_complex* d_correlator_outs;
     cpu_multicorrelator multicorrelator_cpu;
+    bool d_batch_correlators;
+    unsigned int d_batch_wait_us;
+    bool d_batch_channel; // counted by Correlator_Batcher
+    bool d_prn_group;
+    float d_prn_group_doppler_hz;
+    void set_batch_channel(bool batch_channel);
 
 
     // tracking vars
@@ -153,18 +272,64 @@ private:
     // CN0 estimation and lock detector
     int d_cn0_estimation_counter;
     gr_complex* d_Prompt_buffer;
-    double d_carrier_lock_test;
-    double d_CN0_SNV_dB_Hz;
-    double d_carrier_lock_threshold;
+    float d_carrier_lock_test;
+    float d_CN0_SNV_dB_Hz;
+    std::atomic<float> d_last_cn0_db_hz; // d_CN0_SNV_dB_Hz for the control thread
+    float d_carrier_lock_threshold;
     int d_carrier_lock_fail_counter;
 
+    // extended coherent integration, aligned with the navigation bits
+    float d_pll_bw_hz;
+    float d_dll_bw_hz;
+    float d_pll_bw_narrow_hz;
+    float d_dll_bw_narrow_hz;
+    int d_extend_correlation_ms;
+    bool d_enable_extended_integration;
+    bool d_preamble_synchronized;
+    double d_preamble_timestamp_s;
+    int d_integrated_epochs;
+    gr_complex* d_correlator_sums;
+
+    // signal quality monitoring, on the taps after Early, Prompt and Late
+    Sqm_Monitor d_sqm;
+
+    // angle of arrival, on the Prompt of the elements of an antenna array
+    Aoa_Monitor d_aoa;
+    cpu_array_correlator d_array_correlator;
+    gr_complex d_element_prompts[AOA_MAX_ELEMENTS];
+    float d_carr_error_filt_hz;
+    float d_code_error_filt_chips;
+    void msg_handler_preamble_index(pmt::pmt_t msg);
+    void msg_handler_loop_bandwidths(pmt::pmt_t msg); // "loop_bandwidths" port, see below
+
+    // vector tracking aid (see Vector_Tracking_Aid)
+    bool d_vector_tracking;
+    double d_vector_max_age_s;
+    int d_vector_max_coast_ms;
+    bool d_vector_coasting;
+    int d_vector_coast_epochs; // [ms]
+    bool predicted_doppler(double timestamp_secs, double& doppler_hz);
+
+    // adaptive loop bandwidths, wide during the pull-in and narrow once steady
+    bool d_bandwidth_schedule;
+    float d_pll_bw_steady_hz;
+    float d_dll_bw_steady_hz;
+    float d_steady_cn0_db_hz;
+    int d_lock_check_decimation;
+    bool d_steady_state;
+    int d_steady_checks;
+    void update_bandwidth_schedule();
+
+    // refinement of the acquisition, before the loops are closed
+    Fine_Pull_In d_fine_pull_in;
+
     // control vars
     bool d_enable_tracking;
     bool d_pull_in;
 
     // file dump
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Tracking_Dump_Writer d_dump_file;
     std::ofstream d_dump_signal;
     std::ofstream d_dump_signal_wo;
 
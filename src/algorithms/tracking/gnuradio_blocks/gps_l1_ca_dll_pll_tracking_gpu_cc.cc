@@ -34,14 +34,18 @@
 #include <memory>
 #include <sstream>
 #include <boost/lexical_cast.hpp>
+#include <gnuradio/block_detail.h>
+#include <gnuradio/buffer.h>
 #include <gnuradio/io_signature.h>
 #include <volk/volk.h>
 #include <glog/logging.h>
 #include "gps_sdr_signal_processing.h"
+#include "code_bank.h"
 #include "tracking_discriminators.h"
 #include "lock_detectors.h"
 #include "GPS_L1_CA.h"
 #include "control_message_factory.h"
+#include "channel_event.h"
 // includes
 #include <cuda_profiler_api.h>
 
@@ -57,6 +61,32 @@
 
 using google::LogMessage;
 
+namespace
+{
+Dump_Schema tracking_block_dump_schema()
+{
+    Dump_Schema schema("gps_l1_ca_dll_pll_tracking_gpu_cc");
+    schema.add<float>("abs_E")
+          .add<float>("abs_P")
+          .add<float>("abs_L")
+          .add<float>("prompt_I")
+          .add<float>("prompt_Q")
+          .add<unsigned long int>("PRN_start_sample")
+          .add<double>("acc_carrier_phase_cycles")
+          .add<double>("carrier_doppler_hz")
+          .add<double>("code_freq_chips")
+          .add<double>("carr_error_s")
+          .add<double>("carr_nco_hz")
+          .add<double>("code_error_chips")
+          .add<double>("code_nco_chips")
+          .add<double>("CN0_SNV_dB_Hz")
+          .add<double>("carrier_lock_test")
+          .add<double>("rem_code_phase_samples")
+          .add<double>("next_PRN_start_sample");
+    return schema;
+}
+}
+
 gps_l1_ca_dll_pll_tracking_gpu_cc_sptr
 gps_l1_ca_dll_pll_make_tracking_gpu_cc(
         long if_freq,
@@ -121,12 +151,14 @@ Gps_L1_Ca_Dll_Pll_Tracking_GPU_cc::Gps_L1_Ca_Dll_Pll_Tracking_GPU_cc(
     //pinned memory mode - use special function to get OS-pinned memory
     d_n_correlator_taps = 3; // Early, Prompt, and Late
     // Get space for a vector with the C/A code replica sampled 1x/chip
-    cudaHostAlloc((void**)&d_ca_code, (static_cast<int>(GPS_L1_CA_CODE_LENGTH_CHIPS)* sizeof(gr_complex)), cudaHostAllocMapped || cudaHostAllocWriteCombined);
+    // the batches read the code and the taps on the host, and the loops read the
+    // outputs, so only the input copy can be write-combined
+    cudaHostAlloc((void**)&d_ca_code, (static_cast<int>(GPS_L1_CA_CODE_LENGTH_CHIPS)* sizeof(gr_complex)), cudaHostAllocMapped);
     // Get space for the resampled early / prompt / late local replicas
-    cudaHostAlloc((void**)&d_local_code_shift_chips, d_n_correlator_taps * sizeof(float),  cudaHostAllocMapped || cudaHostAllocWriteCombined);
-    cudaHostAlloc((void**)&in_gpu, 2 * d_vector_length * sizeof(gr_complex), cudaHostAllocMapped || cudaHostAllocWriteCombined);
+    cudaHostAlloc((void**)&d_local_code_shift_chips, d_n_correlator_taps * sizeof(float), cudaHostAllocMapped);
+    cudaHostAlloc((void**)&in_gpu, 2 * d_vector_length * sizeof(gr_complex), cudaHostAllocMapped | cudaHostAllocWriteCombined);
     // correlator outputs (scalar)
-    cudaHostAlloc((void**)&d_correlator_outs ,sizeof(gr_complex)*d_n_correlator_taps, cudaHostAllocMapped ||  cudaHostAllocWriteCombined );
+    cudaHostAlloc((void**)&d_correlator_outs ,sizeof(gr_complex)*d_n_correlator_taps, cudaHostAllocMapped);
 
     // Set TAPs delay values [chips]
     d_local_code_shift_chips[0] = - d_early_late_spc_chips;
@@ -139,6 +171,12 @@ Gps_L1_Ca_Dll_Pll_Tracking_GPU_cc::Gps_L1_Ca_Dll_Pll_Tracking_GPU_cc(
     //local code resampler on GPU
     multicorrelator_gpu->init_cuda_integrated_resampler(2 * d_vector_length, GPS_L1_CA_CODE_LENGTH_CHIPS, d_n_correlator_taps);
     multicorrelator_gpu->set_input_output_vectors(d_correlator_outs, in_gpu);
+    d_batch_correlators = false;
+    d_batch_wait_us = 0;
+    d_batch_channel = false;
+    d_zero_copy = false;
+    d_input_map_tried = false;
+    d_mapped_input = NULL;
 
     // define initial code frequency basis of NCO
     d_code_freq_chips = GPS_L1_CA_CODE_RATE_HZ;
@@ -236,7 +274,7 @@ void Gps_L1_Ca_Dll_Pll_Tracking_GPU_cc::start_tracking()
     d_code_loop_filter.initialize();    // initialize the code filter
 
     // generate local reference ALWAYS starting at chip 1 (1 sample per chip)
-    gps_l1_ca_code_gen_complex(d_ca_code, d_acquisition_gnss_synchro->PRN, 0);
+    Code_Bank::gps_l1_ca_code_gen_complex(d_ca_code, d_acquisition_gnss_synchro->PRN, 0);
 
     multicorrelator_gpu->set_local_code_and_taps(static_cast<int>(GPS_L1_CA_CODE_LENGTH_CHIPS), d_ca_code, d_local_code_shift_chips, d_n_correlator_taps);
 
@@ -282,6 +320,52 @@ Gps_L1_Ca_Dll_Pll_Tracking_GPU_cc::~Gps_L1_Ca_Dll_Pll_Tracking_GPU_cc()
     multicorrelator_gpu->free_cuda();
     delete[] d_Prompt_buffer;
     delete(multicorrelator_gpu);
+    set_batch_channel(false);
+    if (d_mapped_input != NULL)
+        {
+            cuda_unmap_host_range(d_mapped_input);
+        }
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_GPU_cc::set_zero_copy(bool zero_copy)
+{
+    d_zero_copy = zero_copy and cuda_zero_copy_device();
+    if (zero_copy and !d_zero_copy)
+        {
+            LOG(INFO) << "The GPU does not share the memory of the host, the tracking copies the samples to it";
+        }
+    Cuda_Correlator_Batcher::set_zero_copy(d_zero_copy);
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_GPU_cc::map_input_buffer(const gr_complex* in)
+{
+    // GNU Radio maps its buffers twice in a row, so that the items from any
+    // position are contiguous: both copies are mapped for the device
+    d_input_map_tried = true;
+    gr::buffer_sptr buffer = detail()->input(0)->buffer();
+    size_t bytes = static_cast<size_t>(buffer->bufsize()) * sizeof(gr_complex);
+    char* base = reinterpret_cast<char*>(const_cast<gr_complex*>(in)) - (nitems_read(0) % buffer->bufsize()) * sizeof(gr_complex);
+    if (cuda_map_host_range(base, 2 * bytes))
+        {
+            d_mapped_input = base;
+            LOG(INFO) << "Channel " << d_channel << " correlates the input buffer in place (" << bytes << " bytes)";
+        }
+    else
+        {
+            LOG(WARNING) << "Channel " << d_channel << " cannot map its input buffer for the GPU, it copies the samples";
+        }
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_GPU_cc::set_batch_channel(bool batch_channel)
+{
+    if (batch_channel != d_batch_channel)
+        {
+            Cuda_Correlator_Batcher::add_channels(batch_channel ? 1 : -1);
+            d_batch_channel = batch_channel;
+        }
 }
 
 
@@ -331,14 +415,45 @@ int Gps_L1_Ca_Dll_Pll_Tracking_GPU_cc::general_work (int noutput_items __attribu
             // ################# CARRIER WIPEOFF AND CORRELATORS ##############################
             // perform carrier wipe-off and compute Early, Prompt and Late correlation
 
-            memcpy(in_gpu, in, sizeof(gr_complex) * d_correlation_length_samples);
-            cudaProfilerStart();
-            multicorrelator_gpu->Carrier_wipeoff_multicorrelator_resampler_cuda( static_cast<float>(d_rem_carrier_phase_rad),
-                    static_cast<float>(d_carrier_phase_step_rad),
-                    static_cast<float>(d_code_phase_step_chips),
-                    static_cast<float>(d_rem_code_phase_chips),
-                    d_correlation_length_samples, d_n_correlator_taps);
-            cudaProfilerStop();
+            set_batch_channel(d_batch_correlators);
+            if (d_zero_copy and !d_input_map_tried)
+                {
+                    map_input_buffer(in);
+                }
+            if (d_batch_correlators)
+                {
+                    // one upload, kernel launch and download for all the channels of the batch
+                    Correlator_Job job;
+                    job.sig_in = in;
+                    job.sample_stamp = d_sample_counter;
+                    job.signal_length_samples = d_correlation_length_samples;
+                    job.rem_carrier_phase_in_rad = static_cast<float>(d_rem_carrier_phase_rad);
+                    job.phase_step_rad = static_cast<float>(d_carrier_phase_step_rad);
+                    job.rem_code_phase_chips = static_cast<float>(d_rem_code_phase_chips);
+                    job.code_phase_step_chips = static_cast<float>(d_code_phase_step_chips);
+                    job.local_code_in = d_ca_code;
+                    job.code_length_chips = static_cast<int>(GPS_L1_CA_CODE_LENGTH_CHIPS);
+                    job.shifts_chips = d_local_code_shift_chips;
+                    job.n_correlators = d_n_correlator_taps;
+                    job.corr_out = d_correlator_outs;
+                    job.prn_group = 0;
+                    job.group_phase_step_rad = 0.0;
+                    Cuda_Correlator_Batcher::correlate(job, d_batch_wait_us);
+                }
+            else
+                {
+                    if (!multicorrelator_gpu->set_input_vector(d_mapped_input != NULL ? in : NULL, d_correlation_length_samples))
+                        {
+                            memcpy(in_gpu, in, sizeof(gr_complex) * d_correlation_length_samples);
+                        }
+                    cudaProfilerStart();
+                    multicorrelator_gpu->Carrier_wipeoff_multicorrelator_resampler_cuda( static_cast<float>(d_rem_carrier_phase_rad),
+                            static_cast<float>(d_carrier_phase_step_rad),
+                            static_cast<float>(d_code_phase_step_chips),
+                            static_cast<float>(d_rem_code_phase_chips),
+                            d_correlation_length_samples, d_n_correlator_taps);
+                    cudaProfilerStop();
+                }
             //std::cout<<"c_out[0]="<<d_correlator_outs[0]<<"c_out[1]="<<d_correlator_outs[1]<<"c_out[2]="<<d_correlator_outs[2]<<std::endl;
 
             // UPDATE INTEGRATION TIME
@@ -428,7 +543,7 @@ int Gps_L1_Ca_Dll_Pll_Tracking_GPU_cc::general_work (int noutput_items __attribu
                         {
                             std::cout << "Loss of lock in channel " << d_channel << "!" << std::endl;
                             LOG(INFO) << "Loss of lock in channel " << d_channel << "!";
-                            this->message_port_pub(pmt::mp("events"), pmt::from_long(3));//3 -> loss of lock
+                            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_LOSS_OF_LOCK));
                             d_carrier_lock_fail_counter = 0;
                             d_enable_tracking = false; // TODO: check if disabling tracking is consistent with the channel state machine
                         }
@@ -450,7 +565,8 @@ int Gps_L1_Ca_Dll_Pll_Tracking_GPU_cc::general_work (int noutput_items __attribu
         }
     else
         {
-
+            // the batches must not wait for this channel
+            set_batch_channel(false);
             for (int n = 0; n < d_n_correlator_taps; n++)
                 {
                     d_correlator_outs[n] = gr_complex(0,0);
@@ -469,53 +585,38 @@ int Gps_L1_Ca_Dll_Pll_Tracking_GPU_cc::general_work (int noutput_items __attribu
             float prompt_I;
             float prompt_Q;
             float tmp_E, tmp_P, tmp_L;
-            double tmp_double;
             prompt_I = d_correlator_outs[1].real();
             prompt_Q = d_correlator_outs[1].imag();
             tmp_E = std::abs<float>(d_correlator_outs[0]);
             tmp_P = std::abs<float>(d_correlator_outs[1]);
             tmp_L = std::abs<float>(d_correlator_outs[2]);
-            try
-            {
-                    // EPR
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_E), sizeof(float));
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_P), sizeof(float));
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_L), sizeof(float));
-                    // PROMPT I and Q (to analyze navigation symbols)
-                    d_dump_file.write(reinterpret_cast<char*>(&prompt_I), sizeof(float));
-                    d_dump_file.write(reinterpret_cast<char*>(&prompt_Q), sizeof(float));
-                    // PRN start sample stamp
-                    //tmp_float=(float)d_sample_counter;
-                    d_dump_file.write(reinterpret_cast<char*>(&d_sample_counter), sizeof(unsigned long int));
-                    // accumulated carrier phase
-                    d_dump_file.write(reinterpret_cast<char*>(&d_acc_carrier_phase_cycles), sizeof(double));
-
-                    // carrier and code frequency
-                    d_dump_file.write(reinterpret_cast<char*>(&d_carrier_doppler_hz), sizeof(double));
-                    d_dump_file.write(reinterpret_cast<char*>(&d_code_freq_chips), sizeof(double));
-
-                    //PLL commands
-                    d_dump_file.write(reinterpret_cast<char*>(&carr_phase_error_secs_Ti), sizeof(double));
-                    d_dump_file.write(reinterpret_cast<char*>(&d_carrier_doppler_hz), sizeof(double));
-
-                    //DLL commands
-                    d_dump_file.write(reinterpret_cast<char*>(&code_error_chips_Ti), sizeof(double));
-                    d_dump_file.write(reinterpret_cast<char*>(&code_error_filt_chips), sizeof(double));
-
-                    // CN0 and carrier lock test
-                    d_dump_file.write(reinterpret_cast<char*>(&d_CN0_SNV_dB_Hz), sizeof(double));
-                    d_dump_file.write(reinterpret_cast<char*>(&d_carrier_lock_test), sizeof(double));
-
-                    // AUX vars (for debug purposes)
-                    tmp_double = d_rem_code_phase_samples;
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_double), sizeof(double));
-                    tmp_double = static_cast<double>(d_sample_counter + d_correlation_length_samples);
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_double), sizeof(double));
-            }
-            catch (const std::ifstream::failure* e)
-            {
-                    LOG(WARNING) << "Exception writing trk dump file " << e->what();
-            }
+            // EPR
+            d_dump_file.put<float>(tmp_E);
+            d_dump_file.put<float>(tmp_P);
+            d_dump_file.put<float>(tmp_L);
+            // PROMPT I and Q (to analyze navigation symbols)
+            d_dump_file.put<float>(prompt_I);
+            d_dump_file.put<float>(prompt_Q);
+            // PRN start sample stamp
+            //tmp_float=(float)d_sample_counter;
+            d_dump_file.put<unsigned long int>(d_sample_counter);
+            // accumulated carrier phase
+            d_dump_file.put<double>(d_acc_carrier_phase_cycles);
+            // carrier and code frequency
+            d_dump_file.put<double>(d_carrier_doppler_hz);
+            d_dump_file.put<double>(d_code_freq_chips);
+            //PLL commands
+            d_dump_file.put<double>(carr_phase_error_secs_Ti);
+            d_dump_file.put<double>(d_carrier_doppler_hz);
+            //DLL commands
+            d_dump_file.put<double>(code_error_chips_Ti);
+            d_dump_file.put<double>(code_error_filt_chips);
+            // CN0 and carrier lock test
+            d_dump_file.put<double>(d_CN0_SNV_dB_Hz);
+            d_dump_file.put<double>(d_carrier_lock_test);
+            // AUX vars (for debug purposes)
+            d_dump_file.put<double>(d_rem_code_phase_samples);
+            d_dump_file.put<double>(static_cast<double>(d_sample_counter + d_correlation_length_samples));
         }
 
     consume_each(d_correlation_length_samples); // this is necessary in gr::block derivates
@@ -533,18 +634,16 @@ void Gps_L1_Ca_Dll_Pll_Tracking_GPU_cc::set_channel(unsigned int channel)
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
-                            d_dump_filename.append(".dat");
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                    d_dump_filename.append(".dat");
+                    if (d_dump_file.open(d_dump_filename, tracking_block_dump_schema()))
+                        {
                             LOG(INFO) << "Tracking dump enabled on channel " << d_channel << " Log file: " << d_dump_filename.c_str() << std::endl;
-                    }
-                    catch (const std::ifstream::failure* e)
-                    {
-                            LOG(WARNING) << "channel " << d_channel << " Exception opening trk dump file " << e->what() << std::endl;
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << d_channel << " cannot open trk dump file " << d_dump_filename;
+                        }
                 }
         }
 }
@@ -44,6 +44,7 @@
 #include "tracking_2nd_DLL_filter.h"
 #include "tracking_FLL_PLL_filter.h"
 #include "cuda_multicorrelator.h"
+#include "dump_writer.h"
 
 class Gps_L1_Ca_Dll_Pll_Tracking_GPU_cc;
 
@@ -74,6 +75,24 @@ public:
     void set_gnss_synchro(Gnss_Synchro* p_gnss_synchro);
     void start_tracking();
 
+    /*!
+     * \brief Correlates in one kernel launch with the other GPU tracking channels (see Cuda_Correlator_Batcher)
+     * \param wait_us - maximum wait for the other channels to join a batch [us]
+     */
+    void set_batch_correlators(bool batch_correlators, unsigned int wait_us)
+    {
+        d_batch_correlators = batch_correlators;
+        d_batch_wait_us = wait_us;
+    }
+
+    /*!
+     * \brief On a GPU that shares the memory of the host, the kernels read
+     * the samples in the GNU Radio input buffer, mapped for the device, and
+     * the batches run without copies (see cuda_map_host_range). Other GPUs
+     * keep the copies.
+     */
+    void set_zero_copy(bool zero_copy);
+
     int general_work (int noutput_items, gr_vector_int &ninput_items,
             gr_vector_const_void_star &input_items, gr_vector_void_star &output_items);
 
@@ -121,6 +140,14 @@ private:
     gr_complex* d_correlator_outs;
     cuda_multicorrelator *multicorrelator_gpu;
     gr_complex* d_ca_code;
+    bool d_batch_correlators;
+    unsigned int d_batch_wait_us;
+    bool d_batch_channel; // counted by Cuda_Correlator_Batcher
+    void set_batch_channel(bool batch_channel);
+    bool d_zero_copy;
+    bool d_input_map_tried;
+    void* d_mapped_input; // base of the input buffer, if mapped
+    void map_input_buffer(const gr_complex* in);
 
     gr_complex *d_Early;
     gr_complex *d_Prompt;
@@ -170,7 +197,7 @@ private:
 
     // file dump
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
 
     std::map<std::string, std::string> systemName;
     std::string sys;
@@ -0,0 +1,876 @@
+/*!
+ * \file gps_l1_ca_dll_pll_tracking_sc.cc
+ * \brief Implementation of a code DLL + carrier PLL tracking block for 16-bit
+ * integer complex input samples
+ * \author Carlos Aviles, 2010. carlos.avilesr(at)googlemail.com
+ *         Javier Arribas, 2011. jarribas(at)cttc.es
+ *
+ * Code DLL + carrier PLL according to the algorithms described in:
+ * [1] K.Borre, D.M.Akos, N.Bertelsen, P.Rinder, and S.H.Jensen,
+ * A Software-Defined GPS and Galileo Receiver. A Single-Frequency
+ * Approach, Birkhauser, 2007
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "gps_l1_ca_dll_pll_tracking_sc.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <gnuradio/io_signature.h>
+#include <pmt/pmt.h>
+#include <glog/logging.h>
+#include <volk/volk.h>
+#include <volk_gnsssdr/volk_gnsssdr.h>
+#include "gps_sdr_signal_processing.h"
+#include "code_bank.h"
+#include "tracking_discriminators.h"
+#include "lock_detectors.h"
+#include "GPS_L1_CA.h"
+#include "control_message_factory.h"
+#include "correlator_taps.h"
+#include "vector_tracking_aid.h"
+#include "channel_event.h"
+
+
+/*!
+ * \todo Include in definition header file
+ */
+#define CN0_ESTIMATION_SAMPLES 20
+#define MINIMUM_VALID_CN0 25
+#define MINIMUM_VALID_CN0_EXTENDED 20
+#define MAXIMUM_LOCK_FAIL_COUNTER 50
+#define CARRIER_LOCK_THRESHOLD 0.85
+#define STEADY_CARRIER_LOCK_THRESHOLD 0.95
+#define STEADY_LOCK_CHECKS 5
+
+
+using google::LogMessage;
+
+gps_l1_ca_dll_pll_tracking_sc_sptr
+gps_l1_ca_dll_pll_make_tracking_sc(
+        long if_freq,
+        long fs_in,
+        unsigned int vector_length,
+        bool dump,
+        std::string dump_filename,
+        float pll_bw_hz,
+        float dll_bw_hz,
+        float early_late_space_chips)
+{
+    return gps_l1_ca_dll_pll_tracking_sc_sptr(new Gps_L1_Ca_Dll_Pll_Tracking_sc(if_freq,
+            fs_in, vector_length, dump, dump_filename, pll_bw_hz, dll_bw_hz, early_late_space_chips));
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_sc::forecast (int noutput_items,
+        gr_vector_int &ninput_items_required)
+{
+    if (noutput_items != 0)
+        {
+            ninput_items_required[0] = static_cast<int>(d_vector_length) * 2; //set the required available samples in each call
+        }
+}
+
+
+Gps_L1_Ca_Dll_Pll_Tracking_sc::Gps_L1_Ca_Dll_Pll_Tracking_sc(
+        long if_freq,
+        long fs_in,
+        unsigned int vector_length,
+        bool dump,
+        std::string dump_filename,
+        float pll_bw_hz,
+        float dll_bw_hz,
+        float early_late_space_chips) :
+        gr::block("Gps_L1_Ca_Dll_Pll_Tracking_sc", gr::io_signature::make(1, 1, sizeof(lv_16sc_t)),
+                gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)))
+{
+    // Telemetry bit synchronization message port input
+    this->message_port_register_in(pmt::mp("preamble_timestamp_s"));
+    this->set_msg_handler(pmt::mp("preamble_timestamp_s"),
+            boost::bind(&Gps_L1_Ca_Dll_Pll_Tracking_sc::msg_handler_preamble_index, this, _1));
+    this->message_port_register_in(pmt::mp("loop_bandwidths"));
+    this->set_msg_handler(pmt::mp("loop_bandwidths"),
+            boost::bind(&Gps_L1_Ca_Dll_Pll_Tracking_sc::msg_handler_loop_bandwidths, this, _1));
+    this->message_port_register_out(pmt::mp("events"));
+    d_receiver_state = Receiver_State::current();
+
+    // initialize internal vars
+    d_dump = dump;
+    d_if_freq = if_freq;
+    d_fs_in = fs_in;
+    d_vector_length = vector_length;
+    d_dump_filename = dump_filename;
+
+    d_current_prn_length_samples = static_cast<int>(d_vector_length);
+
+    // Initialize tracking  ==========================================
+    d_code_loop_filter.set_DLL_BW(dll_bw_hz);
+    d_carrier_loop_filter.set_PLL_BW(pll_bw_hz);
+    d_pll_bw_hz = pll_bw_hz;
+    d_dll_bw_hz = dll_bw_hz;
+    d_pll_bw_narrow_hz = pll_bw_hz;
+    d_dll_bw_narrow_hz = dll_bw_hz;
+    d_extend_correlation_ms = 1;
+    d_enable_extended_integration = false;
+    d_preamble_synchronized = false;
+    d_preamble_timestamp_s = 0.0;
+    d_integrated_epochs = 0;
+    d_carr_error_filt_hz = 0.0;
+    d_code_error_filt_chips = 0.0;
+
+    //--- DLL variables --------------------------------------------------------
+    d_early_late_spc_chips = early_late_space_chips; // Define early-late offset (in chips)
+
+    // Initialization of local code replica
+    // Get space for a vector with the C/A code replica sampled 1x/chip
+    d_ca_code = static_cast<gr_complex*>(volk_malloc(static_cast<int>(GPS_L1_CA_CODE_LENGTH_CHIPS) * sizeof(gr_complex), volk_get_alignment()));
+    d_ca_code_16sc = static_cast<lv_16sc_t*>(volk_malloc(static_cast<int>(GPS_L1_CA_CODE_LENGTH_CHIPS) * sizeof(lv_16sc_t), volk_get_alignment()));
+
+    // correlator outputs (scalar)
+    d_n_correlator_taps = 3; // Early, Prompt, and Late
+    d_correlator_outs = static_cast<gr_complex*>(volk_malloc(d_n_correlator_taps*sizeof(gr_complex), volk_get_alignment()));
+    d_correlator_outs_16sc = static_cast<lv_16sc_t*>(volk_malloc(d_n_correlator_taps*sizeof(lv_16sc_t), volk_get_alignment()));
+    for (int n = 0; n < d_n_correlator_taps; n++)
+        {
+            d_correlator_outs[n] = gr_complex(0,0);
+        }
+    d_correlator_sums = static_cast<gr_complex*>(volk_malloc(d_n_correlator_taps*sizeof(gr_complex), volk_get_alignment()));
+    d_local_code_shift_chips = static_cast<float*>(volk_malloc(d_n_correlator_taps*sizeof(float), volk_get_alignment()));
+    // Set TAPs delay values [chips]
+    d_local_code_shift_chips[0] = - d_early_late_spc_chips;
+    d_local_code_shift_chips[1] = 0.0;
+    d_local_code_shift_chips[2] = d_early_late_spc_chips;
+
+    multicorrelator_cpu.init(2 * d_current_prn_length_samples, d_n_correlator_taps);
+
+    //--- Perform initializations ------------------------------
+    // define initial code frequency basis of NCO
+    d_code_freq_chips = GPS_L1_CA_CODE_RATE_HZ;
+    // define residual code phase (in chips)
+    d_rem_code_phase_samples = 0.0;
+    // define residual carrier phase
+    d_rem_carr_phase_rad = 0.0;
+
+    // sample synchronization
+    d_sample_counter = 0;
+    //d_sample_counter_seconds = 0;
+    d_acq_sample_stamp = 0;
+
+    d_enable_tracking = false;
+    d_pull_in = false;
+
+    d_last_seg = 0;
+
+    // CN0 estimation and lock detector buffers
+    d_cn0_estimation_counter = 0;
+    d_Prompt_buffer = new gr_complex[CN0_ESTIMATION_SAMPLES];
+    d_carrier_lock_test = 1;
+    d_CN0_SNV_dB_Hz = 0;
+    d_carrier_lock_fail_counter = 0;
+    d_carrier_lock_threshold = CARRIER_LOCK_THRESHOLD;
+
+    d_vector_tracking = false;
+    d_vector_max_age_s = 2.0;
+    d_vector_max_coast_ms = 5000;
+    d_vector_coasting = false;
+    d_vector_coast_epochs = 0;
+
+    d_bandwidth_schedule = false;
+    d_pll_bw_steady_hz = pll_bw_hz;
+    d_dll_bw_steady_hz = dll_bw_hz;
+    d_steady_cn0_db_hz = 35.0;
+    d_lock_check_decimation = 1;
+    d_steady_state = false;
+    d_steady_checks = 0;
+
+    systemName["G"] = std::string("GPS");
+    systemName["S"] = std::string("SBAS");
+
+    d_acquisition_gnss_synchro = 0;
+    d_channel = 0;
+    d_acq_code_phase_samples = 0.0;
+    d_acq_carrier_doppler_hz = 0.0;
+    d_carrier_doppler_hz = 0.0;
+    d_acc_carrier_phase_rad = 0.0;
+    d_code_phase_samples = 0.0;
+    d_acc_code_phase_secs = 0.0;
+    d_rem_code_phase_chips = 0.0;
+    d_code_phase_step_chips = 0.0;
+    d_carrier_phase_step_rad = 0.0;
+
+    set_relative_rate(1.0 / static_cast<double>(d_vector_length));
+}
+
+void Gps_L1_Ca_Dll_Pll_Tracking_sc::stop_tracking()
+    {
+        DLOG(INFO) << "stopped tracking";
+        //std::cout << "stopped tracking" << std::endl;
+        //d_carrier_lock_fail_counter = 0;
+        d_enable_tracking = false; 
+        //this->message_port_pub(pmt::mp("events"), pmt::from_long(3));//3 -> loss of lock
+        d_carrier_lock_fail_counter = MAXIMUM_LOCK_FAIL_COUNTER+1;
+    }
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_sc::start_tracking()
+{
+    /*
+     *  correct the code phase according to the delay between acq and trk
+     */
+    d_acq_code_phase_samples = d_acquisition_gnss_synchro->Acq_delay_samples;
+    d_acq_carrier_doppler_hz = d_acquisition_gnss_synchro->Acq_doppler_hz;
+    d_acq_sample_stamp = d_acquisition_gnss_synchro->Acq_samplestamp_samples;
+
+    long int acq_trk_diff_samples;
+    double acq_trk_diff_seconds;
+    acq_trk_diff_samples = static_cast<long int>(d_sample_counter) - static_cast<long int>(d_acq_sample_stamp);//-d_vector_length;
+    DLOG(INFO) << "Number of samples between Acquisition and Tracking =" << acq_trk_diff_samples;
+    acq_trk_diff_seconds = static_cast<float>(acq_trk_diff_samples) / static_cast<float>(d_fs_in);
+    //doppler effect
+    // Fd=(C/(C+Vr))*F
+    double radial_velocity = (GPS_L1_FREQ_HZ + d_acq_carrier_doppler_hz) / GPS_L1_FREQ_HZ;
+    // new chip and prn sequence periods based on acq Doppler
+    double T_chip_mod_seconds;
+    double T_prn_mod_seconds;
+    double T_prn_mod_samples;
+    d_code_freq_chips = radial_velocity * GPS_L1_CA_CODE_RATE_HZ;
+    d_code_phase_step_chips = static_cast<double>(d_code_freq_chips) / static_cast<double>(d_fs_in);
+    T_chip_mod_seconds = 1/d_code_freq_chips;
+    T_prn_mod_seconds = T_chip_mod_seconds * GPS_L1_CA_CODE_LENGTH_CHIPS;
+    T_prn_mod_samples = T_prn_mod_seconds * static_cast<double>(d_fs_in);
+
+    d_current_prn_length_samples = round(T_prn_mod_samples);
+
+    double T_prn_true_seconds = GPS_L1_CA_CODE_LENGTH_CHIPS / GPS_L1_CA_CODE_RATE_HZ;
+    double T_prn_true_samples = T_prn_true_seconds * static_cast<double>(d_fs_in);
+    double T_prn_diff_seconds = T_prn_true_seconds - T_prn_mod_seconds;
+    double N_prn_diff = acq_trk_diff_seconds / T_prn_true_seconds;
+    double corrected_acq_phase_samples, delay_correction_samples;
+    corrected_acq_phase_samples = fmod((d_acq_code_phase_samples + T_prn_diff_seconds * N_prn_diff * static_cast<double>(d_fs_in)), T_prn_true_samples);
+    if (corrected_acq_phase_samples < 0)
+        {
+            corrected_acq_phase_samples = T_prn_mod_samples + corrected_acq_phase_samples;
+        }
+    delay_correction_samples = d_acq_code_phase_samples - corrected_acq_phase_samples;
+
+    d_acq_code_phase_samples = corrected_acq_phase_samples;
+
+    d_carrier_doppler_hz = d_acq_carrier_doppler_hz;
+    d_carrier_phase_step_rad = GPS_TWO_PI * d_carrier_doppler_hz / static_cast<double>(d_fs_in);
+
+    // one code period integrations until the bits are synchronized again
+    d_enable_extended_integration = false;
+    d_preamble_synchronized = false;
+    d_integrated_epochs = 0;
+    d_carr_error_filt_hz = 0.0;
+    d_code_error_filt_chips = 0.0;
+    d_carrier_loop_filter.set_pdi(GPS_L1_CA_CODE_PERIOD);
+    d_carrier_loop_filter.set_PLL_BW(d_pll_bw_hz);
+    d_code_loop_filter.set_pdi(GPS_L1_CA_CODE_PERIOD);
+    d_code_loop_filter.set_DLL_BW(d_dll_bw_hz);
+
+    // DLL/PLL filter initialization
+    d_carrier_loop_filter.initialize(); // initialize the carrier filter
+    d_code_loop_filter.initialize();    // initialize the code filter
+
+    // generate local reference ALWAYS starting at chip 1 (1 sample per chip)
+    Code_Bank::gps_l1_ca_code_gen_complex(d_ca_code, d_acquisition_gnss_synchro->PRN, 0);
+    volk_gnsssdr_32fc_convert_16ic(d_ca_code_16sc, d_ca_code, static_cast<int>(GPS_L1_CA_CODE_LENGTH_CHIPS));
+
+    multicorrelator_cpu.set_local_code_and_taps(static_cast<int>(GPS_L1_CA_CODE_LENGTH_CHIPS), d_ca_code_16sc, d_local_code_shift_chips);
+    for (int n = 0; n < d_n_correlator_taps; n++)
+        {
+            d_correlator_outs[n] = gr_complex(0,0);
+        }
+
+    d_carrier_lock_fail_counter = 0;
+    d_cn0_estimation_counter = 0;
+    d_vector_coasting = false;
+    d_vector_coast_epochs = 0;
+    d_steady_state = false;
+    d_steady_checks = 0;
+    d_rem_code_phase_samples = 0;
+    d_rem_carr_phase_rad = 0.0;
+    d_rem_code_phase_chips = 0.0;
+    d_acc_carrier_phase_rad = 0.0;
+    d_acc_code_phase_secs = 0.0;
+
+    d_code_phase_samples = d_acq_code_phase_samples;
+
+    std::string sys_ = &d_acquisition_gnss_synchro->System;
+    sys = sys_.substr(0,1);
+
+    // DEBUG OUTPUT
+    std::cout << "Tracking start on channel " << d_channel << " for satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN) << " " <<   d_acquisition_gnss_synchro->peak << std::endl;
+    LOG(INFO) << "Starting tracking of satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN) << " on channel " << d_channel;
+
+    // enable tracking
+    d_pull_in = true;
+    d_enable_tracking = true;
+
+    LOG(INFO) << "PULL-IN Doppler [Hz]=" << d_carrier_doppler_hz
+            << " Code Phase correction [samples]=" << delay_correction_samples
+            << " PULL-IN Code Phase [samples]=" << d_acq_code_phase_samples;
+}
+
+Gps_L1_Ca_Dll_Pll_Tracking_sc::~Gps_L1_Ca_Dll_Pll_Tracking_sc()
+{
+    d_dump_file.close();
+    d_dump_signal.close();
+
+    volk_free(d_local_code_shift_chips);
+    volk_free(d_correlator_outs);
+    volk_free(d_correlator_sums);
+    volk_free(d_ca_code);
+    volk_free(d_ca_code_16sc);
+    volk_free(d_correlator_outs_16sc);
+
+    delete[] d_Prompt_buffer;
+    multicorrelator_cpu.free();
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_sc::set_extended_integration(int extend_correlation_ms, float pll_bw_narrow_hz, float dll_bw_narrow_hz)
+{
+    if (extend_correlation_ms < 1 or GPS_CA_TELEMETRY_SYMBOLS_PER_BIT % extend_correlation_ms != 0)
+        {
+            LOG(WARNING) << "extend_correlation_ms must divide the " << GPS_CA_TELEMETRY_SYMBOLS_PER_BIT
+                         << " code periods of a bit, using 1 instead of " << extend_correlation_ms;
+            extend_correlation_ms = 1;
+        }
+    d_extend_correlation_ms = extend_correlation_ms;
+    d_pll_bw_narrow_hz = pll_bw_narrow_hz;
+    d_dll_bw_narrow_hz = dll_bw_narrow_hz;
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_sc::set_bandwidth_schedule(bool bandwidth_schedule, float pll_bw_steady_hz, float dll_bw_steady_hz, double steady_cn0_db_hz, int lock_check_decimation)
+{
+    d_bandwidth_schedule = bandwidth_schedule;
+    d_pll_bw_steady_hz = pll_bw_steady_hz;
+    d_dll_bw_steady_hz = dll_bw_steady_hz;
+    d_steady_cn0_db_hz = steady_cn0_db_hz;
+    d_lock_check_decimation = std::max(lock_check_decimation, 1);
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_sc::update_bandwidth_schedule()
+{
+    bool stable = d_carrier_lock_test >= STEADY_CARRIER_LOCK_THRESHOLD and d_CN0_SNV_dB_Hz >= d_steady_cn0_db_hz and !d_vector_coasting;
+    if (!d_steady_state and stable and ++d_steady_checks >= STEADY_LOCK_CHECKS)
+        {
+            d_steady_state = true;
+            if (!d_preamble_synchronized)
+                {
+                    d_carrier_loop_filter.set_PLL_BW(d_pll_bw_steady_hz);
+                    d_code_loop_filter.set_DLL_BW(d_dll_bw_steady_hz);
+                }
+            DLOG(INFO) << "Tracking CH " << d_channel << " steady, pll_bw = " << d_pll_bw_steady_hz << " [Hz], dll_bw = " << d_dll_bw_steady_hz << " [Hz]";
+        }
+    else if (!stable)
+        {
+            if (d_steady_state)
+                {
+                    if (!d_preamble_synchronized)
+                        {
+                            d_carrier_loop_filter.set_PLL_BW(d_pll_bw_hz);
+                            d_code_loop_filter.set_DLL_BW(d_dll_bw_hz);
+                        }
+                    DLOG(INFO) << "Tracking CH " << d_channel << " back to the pull-in bandwidths, CN0 = " << d_CN0_SNV_dB_Hz
+                               << " [dB-Hz], lock = " << d_carrier_lock_test;
+                }
+            d_steady_state = false;
+            d_steady_checks = 0;
+        }
+    if (d_steady_state)
+        {
+            // skip the prompt outputs of the next (decimation - 1) lock checks
+            d_cn0_estimation_counter = -(d_lock_check_decimation - 1) * CN0_ESTIMATION_SAMPLES;
+        }
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_sc::msg_handler_preamble_index(pmt::pmt_t msg)
+{
+    // the telemetry decoder has synchronized the frames, so the bit edges are known
+    if (d_extend_correlation_ms > 1 and d_enable_extended_integration == false) //avoid re-setting preamble indicator
+        {
+            DLOG(INFO) << "Extended correlation enabled for Tracking CH " << d_channel <<  ": Satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN);
+            d_preamble_timestamp_s = pmt::to_double(msg);
+            d_enable_extended_integration = true;
+            d_preamble_synchronized = false;
+        }
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_sc::msg_handler_loop_bandwidths(pmt::pmt_t msg)
+{
+    if (!pmt::is_dict(msg))
+        {
+            LOG(WARNING) << "Tracking CH " << d_channel << ": loop_bandwidths message is not a dictionary";
+            return;
+        }
+    d_pll_bw_hz = pmt::to_double(pmt::dict_ref(msg, pmt::mp("pll_bw_hz"), pmt::from_double(d_pll_bw_hz)));
+    d_dll_bw_hz = pmt::to_double(pmt::dict_ref(msg, pmt::mp("dll_bw_hz"), pmt::from_double(d_dll_bw_hz)));
+    d_pll_bw_narrow_hz = pmt::to_double(pmt::dict_ref(msg, pmt::mp("pll_bw_narrow_hz"), pmt::from_double(d_pll_bw_narrow_hz)));
+    d_dll_bw_narrow_hz = pmt::to_double(pmt::dict_ref(msg, pmt::mp("dll_bw_narrow_hz"), pmt::from_double(d_dll_bw_narrow_hz)));
+    d_pll_bw_steady_hz = pmt::to_double(pmt::dict_ref(msg, pmt::mp("pll_bw_steady_hz"), pmt::from_double(d_pll_bw_steady_hz)));
+    d_dll_bw_steady_hz = pmt::to_double(pmt::dict_ref(msg, pmt::mp("dll_bw_steady_hz"), pmt::from_double(d_dll_bw_steady_hz)));
+    d_steady_cn0_db_hz = pmt::to_double(pmt::dict_ref(msg, pmt::mp("steady_cn0_dbhz"), pmt::from_double(d_steady_cn0_db_hz)));
+
+    // the bandwidths of the current stage of the loops, which keep their state
+    if (d_preamble_synchronized)
+        {
+            d_carrier_loop_filter.set_PLL_BW(d_pll_bw_narrow_hz);
+            d_code_loop_filter.set_DLL_BW(d_dll_bw_narrow_hz);
+        }
+    else if (d_bandwidth_schedule and d_steady_state)
+        {
+            d_carrier_loop_filter.set_PLL_BW(d_pll_bw_steady_hz);
+            d_code_loop_filter.set_DLL_BW(d_dll_bw_steady_hz);
+        }
+    else
+        {
+            d_carrier_loop_filter.set_PLL_BW(d_pll_bw_hz);
+            d_code_loop_filter.set_DLL_BW(d_dll_bw_hz);
+        }
+    LOG(INFO) << "Tracking CH " << d_channel << " reconfigured, pll_bw = " << d_pll_bw_hz << " [Hz], dll_bw = " << d_dll_bw_hz << " [Hz]";
+}
+
+
+bool Gps_L1_Ca_Dll_Pll_Tracking_sc::predicted_doppler(double timestamp_secs, double& doppler_hz)
+{
+    Vector_Tracking_Aid aid;
+    if (sys.compare("G") != 0 or !d_receiver_state->vector_tracking_map.read(d_acquisition_gnss_synchro->PRN, aid))
+        {
+            return false;
+        }
+    double age_s = timestamp_secs - aid.Tracking_timestamp_secs;
+    if (std::abs(age_s) > d_vector_max_age_s)
+        {
+            return false;
+        }
+    doppler_hz = aid.Carrier_Doppler_hz + aid.Carrier_Doppler_rate_hz_s * age_s;
+    return true;
+}
+
+
+int Gps_L1_Ca_Dll_Pll_Tracking_sc::general_work (int noutput_items __attribute__((unused)), gr_vector_int &ninput_items __attribute__((unused)),
+        gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
+{
+    // process vars
+    float carr_error_hz = 0.0;
+    float carr_error_filt_hz = 0.0;
+    float code_error_chips = 0.0;
+    float code_error_filt_chips = 0.0;
+
+    // Block input data and block output stream pointers
+    const lv_16sc_t* in = (lv_16sc_t*) input_items[0]; //PRN start block alignment
+    Gnss_Synchro **out = (Gnss_Synchro **) &output_items[0];
+
+    // GNSS_SYNCHRO OBJECT to interchange data between tracking->telemetry_decoder
+    Gnss_Synchro current_synchro_data = Gnss_Synchro();
+
+    if (d_enable_tracking == true)
+        {
+            // Fill the acquisition data
+            current_synchro_data = *d_acquisition_gnss_synchro;
+            // Receiver signal alignment
+            if (d_pull_in == true)
+                {
+                    int samples_offset;
+                    double acq_trk_shif_correction_samples;
+                    int acq_to_trk_delay_samples;
+                    acq_to_trk_delay_samples = d_sample_counter - d_acq_sample_stamp;
+                    acq_trk_shif_correction_samples = d_current_prn_length_samples - fmod(static_cast<float>(acq_to_trk_delay_samples), static_cast<float>(d_current_prn_length_samples));
+                    samples_offset = round(d_acq_code_phase_samples + acq_trk_shif_correction_samples);
+                    current_synchro_data.Tracking_timestamp_secs = (static_cast<double>(d_sample_counter) + static_cast<double>(d_rem_code_phase_samples)) / static_cast<double>(d_fs_in);
+                    d_sample_counter = d_sample_counter + samples_offset; //count for the processed samples
+                    d_pull_in = false;
+                    *out[0] = current_synchro_data;
+                    consume_each(samples_offset); //shift input to perform alignment with local replica
+                    return 1;
+                }
+
+            // ################# CARRIER WIPEOFF AND CORRELATORS ##############################
+            // perform carrier wipe-off and compute Early, Prompt and Late correlation
+            multicorrelator_cpu.set_input_output_vectors(d_correlator_outs_16sc, in);
+            multicorrelator_cpu.Carrier_wipeoff_multicorrelator_resampler(d_rem_carr_phase_rad,
+                    d_carrier_phase_step_rad,
+                    d_rem_code_phase_chips,
+                    d_code_phase_step_chips,
+                    d_current_prn_length_samples);
+            // the loop discriminators work in floating point
+            volk_gnsssdr_16ic_convert_32fc(d_correlator_outs, d_correlator_outs_16sc, d_n_correlator_taps);
+
+            // ################## COHERENT INTEGRATION EXTENSION ##############################
+            // once the bits are synchronized, the code periods of a bit are integrated coherently,
+            // and the loops are closed once per extend_correlation_ms periods
+            const gr_complex* loop_outs = d_correlator_outs;
+            int integration_ms = 1;
+            bool close_loops = true;
+            bool start_extended_integration = false;
+            if (d_preamble_synchronized)
+                {
+                    for (int n = 0; n < d_n_correlator_taps; n++)
+                        {
+                            d_correlator_sums[n] = (d_integrated_epochs == 0) ? d_correlator_outs[n] : d_correlator_sums[n] + d_correlator_outs[n];
+                        }
+                    d_integrated_epochs++;
+                    if (d_integrated_epochs == d_extend_correlation_ms)
+                        {
+                            loop_outs = d_correlator_sums;
+                            integration_ms = d_extend_correlation_ms;
+                            d_integrated_epochs = 0;
+                        }
+                    else
+                        {
+                            // the NCOs keep the last loop commands
+                            close_loops = false;
+                        }
+                }
+            else if (d_enable_extended_integration)
+                {
+                    long int symbol_diff = round(1000.0 * ((static_cast<double>(d_sample_counter) + d_rem_code_phase_samples) / static_cast<double>(d_fs_in) - d_preamble_timestamp_s));
+                    // this code period is the last one of a bit
+                    start_extended_integration = (symbol_diff > 0 and symbol_diff % d_extend_correlation_ms == 0);
+                }
+
+            // ################## PLL ##########################################################
+            if (close_loops)
+                {
+                    // PLL discriminator
+                    // Update PLL discriminator [rads/Ti -> Secs/Ti]
+                    carr_error_hz = pll_cloop_two_quadrant_atan(loop_outs[1]) / static_cast<float>(GPS_TWO_PI); //prompt output
+                    // Carrier discriminator filter
+                    d_carr_error_filt_hz = d_carrier_loop_filter.get_carrier_nco(carr_error_hz);
+                }
+            carr_error_filt_hz = d_carr_error_filt_hz;
+            if (d_vector_coasting)
+                {
+                    // the loop only tracks the residual of the Doppler predicted by the PVT solution
+                    double vector_doppler_hz;
+                    if (predicted_doppler((static_cast<double>(d_sample_counter) + d_rem_code_phase_samples) / static_cast<double>(d_fs_in), vector_doppler_hz))
+                        {
+                            d_acq_carrier_doppler_hz = vector_doppler_hz;
+                        }
+                    d_vector_coast_epochs++;
+                }
+            // New carrier Doppler frequency estimation
+            d_carrier_doppler_hz = d_acq_carrier_doppler_hz + carr_error_filt_hz;
+
+            // New code Doppler frequency estimation
+            d_code_freq_chips = GPS_L1_CA_CODE_RATE_HZ + ((d_carrier_doppler_hz * GPS_L1_CA_CODE_RATE_HZ) / GPS_L1_FREQ_HZ);
+            //carrier phase accumulator for (K) doppler estimation
+            d_acc_carrier_phase_rad -= GPS_TWO_PI * d_carrier_doppler_hz * GPS_L1_CA_CODE_PERIOD;
+            //remanent carrier phase to prevent overflow in the code NCO
+            d_rem_carr_phase_rad = d_rem_carr_phase_rad + GPS_TWO_PI * ( d_if_freq + d_carrier_doppler_hz ) * GPS_L1_CA_CODE_PERIOD;
+            d_rem_carr_phase_rad = fmod(d_rem_carr_phase_rad, GPS_TWO_PI);
+
+            // ################## DLL ##########################################################
+            if (close_loops)
+                {
+                    // DLL discriminator
+                    code_error_chips = dll_nc_e_minus_l_normalized(loop_outs[0], loop_outs[2]); //[chips/Ti] //early and late
+                    // Code discriminator filter
+                    if (d_vector_coasting)
+                        {
+                            // the code NCO is only aided by the carrier, the discriminator is noise
+                            d_code_error_filt_chips = 0.0;
+                        }
+                    else
+                        {
+                            d_code_error_filt_chips = d_code_loop_filter.get_code_nco(code_error_chips); //[chips/second]
+                        }
+                }
+            code_error_filt_chips = d_code_error_filt_chips;
+            //Code phase accumulator
+            double code_error_filt_secs;
+            code_error_filt_secs = (GPS_L1_CA_CODE_PERIOD * code_error_filt_chips) / GPS_L1_CA_CODE_RATE_HZ; //[seconds]
+            d_acc_code_phase_secs = d_acc_code_phase_secs + code_error_filt_secs;
+
+            // ################## CARRIER AND CODE NCO BUFFER ALIGNEMENT #######################
+            // keep alignment parameters for the next input buffer
+            double T_chip_seconds;
+            double T_prn_seconds;
+            double T_prn_samples;
+            double K_blk_samples;
+            // Compute the next buffer length based in the new period of the PRN sequence and the code phase error estimation
+            T_chip_seconds = 1 / static_cast<double>(d_code_freq_chips);
+            T_prn_seconds = T_chip_seconds * GPS_L1_CA_CODE_LENGTH_CHIPS;
+            T_prn_samples = T_prn_seconds * static_cast<double>(d_fs_in);
+            K_blk_samples = T_prn_samples + d_rem_code_phase_samples + code_error_filt_secs * static_cast<double>(d_fs_in);
+            d_current_prn_length_samples = round(K_blk_samples); //round to a discrete samples
+
+            //################### PLL COMMANDS #################################################
+            //carrier phase step (NCO phase increment per sample) [rads/sample]
+            d_carrier_phase_step_rad = GPS_TWO_PI * d_carrier_doppler_hz / static_cast<double>(d_fs_in);
+
+            //################### DLL COMMANDS #################################################
+            //code phase step (Code resampler phase increment per sample) [chips/sample]
+            d_code_phase_step_chips = d_code_freq_chips / static_cast<double>(d_fs_in);
+            //remnant code phase [chips]
+            d_rem_code_phase_chips = d_rem_code_phase_samples * (d_code_freq_chips / static_cast<double>(d_fs_in));
+
+            // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
+            // they run at the rate of the loops, on the integrated prompt outputs
+            if (close_loops and d_cn0_estimation_counter < 0)
+                {
+                    // steady channel, this period is not checked
+                    d_cn0_estimation_counter++;
+                }
+            else if (close_loops and d_cn0_estimation_counter < CN0_ESTIMATION_SAMPLES)
+                {
+                    // fill buffer with prompt correlator output values
+                    d_Prompt_buffer[d_cn0_estimation_counter] = loop_outs[1]; //prompt
+                    d_cn0_estimation_counter++;
+                }
+            else if (close_loops)
+                {
+                    d_cn0_estimation_counter = 0;
+                    // Code and carrier lock indicators, in one pass over the prompt buffer
+                    float cn0_db_hz;
+                    float carrier_lock_test;
+                    cn0_and_carrier_lock(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in, integration_ms * GPS_L1_CA_CODE_LENGTH_CHIPS,
+                            &cn0_db_hz, &carrier_lock_test);
+                    d_CN0_SNV_dB_Hz = cn0_db_hz;
+                    d_carrier_lock_test = carrier_lock_test;
+                    // Loss of lock detection, the counter is kept in code periods
+                    // and a check stands for the periods skipped since the previous one
+                    int checked_ms = integration_ms * (d_steady_state ? d_lock_check_decimation : 1);
+                    if (d_carrier_lock_test < d_carrier_lock_threshold or
+                            d_CN0_SNV_dB_Hz < (integration_ms > 1 ? MINIMUM_VALID_CN0_EXTENDED : MINIMUM_VALID_CN0))
+                        {
+                            d_carrier_lock_fail_counter += checked_ms;
+                        }
+                    else
+                        {
+                            d_carrier_lock_fail_counter = std::max(d_carrier_lock_fail_counter - checked_ms, 0);
+                            if (d_vector_coasting)
+                                {
+                                    LOG(INFO) << "Channel " << d_channel << " recovered the signal after coasting " << d_vector_coast_epochs << " ms";
+                                    d_vector_coasting = false;
+                                    d_vector_coast_epochs = 0;
+                                }
+                            // last in-lock state, to reacquire the satellite close to it if the lock is lost
+                            Gnss_Synchro lock_state = *d_acquisition_gnss_synchro;
+                            lock_state.Carrier_Doppler_hz = d_carrier_doppler_hz;
+                            lock_state.sample_counter = d_sample_counter + static_cast<long int>(round(d_rem_code_phase_samples));
+                            d_receiver_state->gps_reacquisition_map.write(reacquisition_key(lock_state.PRN, lock_state.peak), lock_state);
+                        }
+                    double vector_doppler_hz;
+                    if (d_carrier_lock_fail_counter > MAXIMUM_LOCK_FAIL_COUNTER and d_vector_tracking
+                            and d_vector_coast_epochs < d_vector_max_coast_ms
+                            and predicted_doppler((static_cast<double>(d_sample_counter) + d_rem_code_phase_samples) / static_cast<double>(d_fs_in), vector_doppler_hz))
+                        {
+                            // coast on the PVT solution instead of dropping the satellite
+                            if (!d_vector_coasting)
+                                {
+                                    LOG(INFO) << "Channel " << d_channel << " lost the lock, coasting on the PVT Doppler " << vector_doppler_hz << " [Hz]";
+                                    d_vector_coasting = true;
+                                    d_acq_carrier_doppler_hz = vector_doppler_hz;
+                                    d_carrier_loop_filter.initialize();
+                                    d_carr_error_filt_hz = 0.0;
+                                    d_code_error_filt_chips = 0.0;
+                                }
+                            d_carrier_lock_fail_counter = MAXIMUM_LOCK_FAIL_COUNTER;
+                        }
+                    if (d_bandwidth_schedule)
+                        {
+                            update_bandwidth_schedule();
+                        }
+                    if (d_carrier_lock_fail_counter > MAXIMUM_LOCK_FAIL_COUNTER)
+                        {
+                            d_vector_coasting = false;
+                            d_vector_coast_epochs = 0;
+                            std::cout << "Loss of lock in channel " << d_channel << "!" << std::endl;
+                            LOG(INFO) << "Loss of lock in channel " << d_channel << "!";
+                            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_LOSS_OF_LOCK));
+                            d_carrier_lock_fail_counter = 0;
+                            d_enable_tracking = false; // TODO: check if disabling tracking is consistent with the channel state machine
+                        }
+                }
+            if (start_extended_integration)
+                {
+                    d_preamble_synchronized = true;
+                    d_integrated_epochs = 0;
+                    d_cn0_estimation_counter = 0;
+                    d_carrier_loop_filter.set_pdi(static_cast<double>(d_extend_correlation_ms) * GPS_L1_CA_CODE_PERIOD);
+                    d_carrier_loop_filter.set_PLL_BW(d_pll_bw_narrow_hz);
+                    d_code_loop_filter.set_pdi(static_cast<double>(d_extend_correlation_ms) * GPS_L1_CA_CODE_PERIOD);
+                    d_code_loop_filter.set_DLL_BW(d_dll_bw_narrow_hz);
+                    LOG(INFO) << "Enabled " << d_extend_correlation_ms << " [ms] extended correlator for CH " << d_channel
+                              << " : Satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN)
+                              << " pll_narrow_bw = " << d_pll_bw_narrow_hz << " [Hz], dll_narrow_bw = " << d_dll_bw_narrow_hz << " [Hz]";
+                }
+
+            // ########### Output the tracking data to navigation and PVT ##########
+            current_synchro_data.Prompt_I = static_cast<double>((d_correlator_outs[1]).real());
+            current_synchro_data.Prompt_Q = static_cast<double>((d_correlator_outs[1]).imag());
+
+            // Tracking_timestamp_secs is aligned with the CURRENT PRN start sample (Hybridization OK!, but some glitches??)
+            current_synchro_data.Tracking_timestamp_secs = (static_cast<double>(d_sample_counter) + static_cast<double>(d_rem_code_phase_samples)) / static_cast<double>(d_fs_in);
+            //compute remnant code phase samples AFTER the Tracking timestamp
+            d_rem_code_phase_samples = K_blk_samples - d_current_prn_length_samples; //rounding error < 1 sample
+
+            //current_synchro_data.Tracking_timestamp_secs = ((double)d_sample_counter)/static_cast<double>(d_fs_in);
+            // This tracking block aligns the Tracking_timestamp_secs with the start sample of the PRN, thus, Code_phase_secs=0
+            current_synchro_data.Code_phase_secs = 0;
+            current_synchro_data.Carrier_phase_rads = d_acc_carrier_phase_rad;
+            current_synchro_data.Carrier_Doppler_hz = d_carrier_doppler_hz;
+            current_synchro_data.CN0_dB_hz = d_CN0_SNV_dB_Hz;
+            current_synchro_data.Flag_valid_symbol_output = true;
+            current_synchro_data.correlation_length_ms = 1;
+
+            current_synchro_data.sample_counter = d_sample_counter;
+
+            // correlator taps for the spoofing checks, outside Gnss_Synchro
+            Correlator_Taps taps;
+            taps.PRN = d_acquisition_gnss_synchro->PRN;
+            taps.sample_counter = d_sample_counter;
+            taps.Early = d_correlator_outs[0];
+            taps.Prompt = d_correlator_outs[1];
+            taps.Late = d_correlator_outs[2];
+            d_receiver_state->correlator_taps_map.write(d_channel, taps);
+
+            if (floor(d_sample_counter / d_fs_in) != d_last_seg)
+            {
+                d_last_seg = floor(d_sample_counter / d_fs_in);
+                DLOG(INFO) << "GPS L1 C/A Tracking CH " << d_channel <<  ": Satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN)
+                    << ", CN0 = " << d_CN0_SNV_dB_Hz << " [dB-Hz]" << ", lock = " << d_carrier_lock_test;
+            }
+
+        }
+    else
+        {
+            for (int n = 0; n < d_n_correlator_taps; n++)
+                {
+                    d_correlator_outs[n] = gr_complex(0,0);
+                }
+
+            current_synchro_data.Tracking_timestamp_secs = (static_cast<double>(d_sample_counter) + static_cast<double>(d_rem_code_phase_samples)) / static_cast<double>(d_fs_in);
+            current_synchro_data.System = {'G'};
+        }
+
+    //assign the GNURadio block output data
+    *out[0] = current_synchro_data;
+    if(d_dump)
+        {
+            // MULTIPLEXED FILE RECORDING - Record results to file
+            Tracking_Dump_Record record;
+            // EPR
+            record.abs_E = std::abs<float>(d_correlator_outs[0]);
+            record.abs_P = std::abs<float>(d_correlator_outs[1]);
+            record.abs_L = std::abs<float>(d_correlator_outs[2]);
+            // PROMPT I and Q (to analyze navigation symbols)
+            record.prompt_I = d_correlator_outs[1].real();
+            record.prompt_Q = d_correlator_outs[1].imag();
+            // PRN start sample stamp
+            record.PRN_start_sample = d_sample_counter;
+            // accumulated carrier phase
+            record.acc_carrier_phase_rad = d_acc_carrier_phase_rad;
+            // carrier and code frequency
+            record.carrier_doppler_hz = d_carrier_doppler_hz;
+            record.code_freq_chips = d_code_freq_chips;
+            //PLL commands
+            record.carr_error_hz = carr_error_hz;
+            record.carr_nco_hz = d_carrier_doppler_hz;
+            //DLL commands
+            record.code_error_chips = code_error_chips;
+            record.code_nco_chips = code_error_filt_chips;
+            // CN0 and carrier lock test
+            record.CN0_SNV_dB_Hz = d_CN0_SNV_dB_Hz;
+            record.carrier_lock_test = d_carrier_lock_test;
+            // AUX vars (for debug purposes)
+            record.rem_code_phase_samples = d_rem_code_phase_samples;
+            record.next_PRN_start_sample = static_cast<double>(d_sample_counter + d_current_prn_length_samples);
+            // vestigial signal defense paramenters
+            record.delta = delta(d_correlator_outs[0], d_correlator_outs[1], d_correlator_outs[2]);
+            record.RT = RT(d_correlator_outs[0], d_correlator_outs[1], d_correlator_outs[2]);
+            record.ELP = ELP(d_correlator_outs[0], d_correlator_outs[1], d_correlator_outs[2]);
+            record.MD = MD(d_correlator_outs[0], d_correlator_outs[1], d_correlator_outs[2]);
+            d_dump_file.write(record);
+        }
+
+    consume_each(d_current_prn_length_samples); // this is necessary in gr::block derivates
+    d_sample_counter += d_current_prn_length_samples; //count for the processed samples
+
+    return 1; //output tracking result ALWAYS even in the case of d_enable_tracking==false
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_sc::set_channel(unsigned int channel)
+{
+    d_channel = channel;
+    LOG(INFO) << "Tracking Channel set to " << d_channel;
+    std::string d_dump_signal_filename = "input_signal_";
+    std::string d_dump_signal_filename_wo = "carrier_wipeoff_";
+    // ############# ENABLE DATA FILE LOG #################
+    if (d_dump == true)
+        {
+            if (d_dump_file.is_open() == false)
+                {
+                    d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                    d_dump_filename.append(".dat");
+                    if (d_dump_file.open(d_dump_filename))
+                        {
+                            LOG(INFO) << "Tracking dump enabled on channel " << d_channel << " Log file: " << d_dump_filename.c_str();
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << d_channel << " cannot open trk dump file " << d_dump_filename;
+                        }
+                }
+
+/*
+            if (d_dump_signal_wo.is_open() == false)
+                {
+                    try
+                    {
+                            d_dump_signal_filename_wo.append(boost::lexical_cast<std::string>(d_channel));
+                            d_dump_signal_filename_wo.append(".dat");
+                            d_dump_signal_wo.exceptions (std::ifstream::failbit | std::ifstream::badbit);
+                            d_dump_signal_wo.open(d_dump_signal_filename_wo.c_str(), std::ios::out | std::ios::binary);
+                            LOG(INFO) << "Tracking signal dump enabled on channel " << d_channel << " Log file: " << d_dump_signal_filename_wo.c_str() << std::endl;
+                    }
+                    catch (std::ifstream::failure e)
+                    {
+                            LOG(WARNING) << "channel " << d_channel << " Exception opening trk signal dump file " << e.what() << std::endl;
+                    }
+                }
+*/
+        }
+}
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_sc::set_gnss_synchro(Gnss_Synchro* p_gnss_synchro)
+{
+    d_acquisition_gnss_synchro = p_gnss_synchro;
+}
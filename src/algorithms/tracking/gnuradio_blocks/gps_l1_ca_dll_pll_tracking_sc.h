@@ -0,0 +1,255 @@
+/*!
+ * \file gps_l1_ca_dll_pll_tracking_sc.h
+ * \brief Interface of a code DLL + carrier PLL tracking block for 16-bit
+ * integer complex input samples
+ * \author Carlos Aviles, 2010. carlos.avilesr(at)googlemail.com
+ *         Javier Arribas, 2011. jarribas(at)cttc.es
+ *
+ * Code DLL + carrier PLL according to the algorithms described in:
+ * K.Borre, D.M.Akos, N.Bertelsen, P.Rinder, and S.H.Jensen,
+ * A Software-Defined GPS and Galileo Receiver. A Single-Frequency Approach,
+ * Birkhauser, 2007
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_GPS_L1_CA_DLL_PLL_TRACKING_SC_H
+#define GNSS_SDR_GPS_L1_CA_DLL_PLL_TRACKING_SC_H
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <gnuradio/block.h>
+#include "gnss_synchro.h"
+#include "receiver_state.h"
+#include "tracking_2nd_DLL_filter.h"
+#include "tracking_2nd_PLL_filter.h"
+#include "tracking_dump_writer.h"
+#include "cpu_multicorrelator_16sc.h"
+
+class Gps_L1_Ca_Dll_Pll_Tracking_sc;
+
+typedef boost::shared_ptr<Gps_L1_Ca_Dll_Pll_Tracking_sc>
+        gps_l1_ca_dll_pll_tracking_sc_sptr;
+
+gps_l1_ca_dll_pll_tracking_sc_sptr
+gps_l1_ca_dll_pll_make_tracking_sc(long if_freq,
+                                   long fs_in, unsigned
+                                   int vector_length,
+                                   bool dump,
+                                   std::string dump_filename,
+                                   float pll_bw_hz,
+                                   float dll_bw_hz,
+                                   float early_late_space_chips);
+
+
+
+/*!
+ * \brief This class implements a DLL + PLL tracking loop block
+ */
+class Gps_L1_Ca_Dll_Pll_Tracking_sc: public gr::block
+{
+public:
+    ~Gps_L1_Ca_Dll_Pll_Tracking_sc();
+
+    void set_channel(unsigned int channel);
+    void set_gnss_synchro(Gnss_Synchro* p_gnss_synchro);
+    void start_tracking();
+    void stop_tracking();
+
+    /*!
+     * \brief Integrates coherently extend_correlation_ms code periods once the bits are synchronized
+     *
+     * The loops then run once per integration, with the narrow bandwidths.
+     * extend_correlation_ms must divide the 20 code periods of a bit, 1 disables it.
+     */
+    void set_extended_integration(int extend_correlation_ms, float pll_bw_narrow_hz, float dll_bw_narrow_hz);
+
+    /*!
+     * \brief Coasts on the carrier Doppler predicted by the PVT solution when the signal is lost
+     * \param max_age_s - oldest prediction the channel can coast on [s]
+     * \param max_coast_ms - longest coasting before the loss of lock is declared [ms]
+     */
+    void set_vector_tracking(bool vector_tracking, double max_age_s, int max_coast_ms)
+    {
+        d_vector_tracking = vector_tracking;
+        d_vector_max_age_s = max_age_s;
+        d_vector_max_coast_ms = max_coast_ms;
+    }
+
+    /*!
+     * \brief Narrows the loops once the channel is steady, and widens them again when it is not
+     *
+     * The channel pulls in with the configured bandwidths. After a few lock
+     * checks in a row with a carrier lock test above 0.95 and a CN0 above
+     * steady_cn0_db_hz, the loops switch to the steady bandwidths and the
+     * lock detectors only use one of every lock_check_decimation buffers of
+     * prompt outputs. Once the bits are synchronized the extended
+     * integration bandwidths take precedence.
+     */
+    void set_bandwidth_schedule(bool bandwidth_schedule, float pll_bw_steady_hz, float dll_bw_steady_hz, double steady_cn0_db_hz, int lock_check_decimation);
+
+    /*
+     * The "loop_bandwidths" message input takes a pmt dictionary with any of
+     * pll_bw_hz, dll_bw_hz, pll_bw_narrow_hz, dll_bw_narrow_hz,
+     * pll_bw_steady_hz, dll_bw_steady_hz [Hz] and steady_cn0_dbhz [dB-Hz].
+     * They are changed in the block thread, between two calls to
+     * general_work, so the loops keep their lock.
+     */
+
+    int general_work (int noutput_items, gr_vector_int &ninput_items,
+            gr_vector_const_void_star &input_items, gr_vector_void_star &output_items);
+
+    void forecast (int noutput_items, gr_vector_int &ninput_items_required);
+
+private:
+    friend gps_l1_ca_dll_pll_tracking_sc_sptr
+    gps_l1_ca_dll_pll_make_tracking_sc(long if_freq,
+            long fs_in, unsigned
+            int vector_length,
+            bool dump,
+            std::string dump_filename,
+            float pll_bw_hz,
+            float dll_bw_hz,
+            float early_late_space_chips);
+
+    Gps_L1_Ca_Dll_Pll_Tracking_sc(long if_freq,
+            long fs_in, unsigned
+            int vector_length,
+            bool dump,
+            std::string dump_filename,
+            float pll_bw_hz,
+            float dll_bw_hz,
+            float early_late_space_chips);
+
+    // tracking configuration vars
+    unsigned int d_vector_length;
+    bool d_dump;
+
+    Gnss_Synchro* d_acquisition_gnss_synchro;
+    std::shared_ptr<Receiver_State> d_receiver_state; // tables of the receiver, current at construction
+    unsigned int d_channel;
+
+    long d_if_freq;
+    long d_fs_in;
+    int d_last_seg;
+
+    float d_early_late_spc_chips;
+
+    // remaining code phase and carrier phase between tracking loops
+    double d_rem_code_phase_samples;
+    double d_rem_code_phase_chips;
+    double d_rem_carr_phase_rad;
+
+    // PLL and DLL filter library
+    Tracking_2nd_DLL_filter d_code_loop_filter;
+    Tracking_2nd_PLL_filter d_carrier_loop_filter;
+
+    // acquisition
+    double d_acq_code_phase_samples;
+    double d_acq_carrier_doppler_hz;
+    // correlator
+    int d_n_correlator_taps;
+    gr_complex* d_ca_code;
+    lv_16sc_t* d_ca_code_16sc;
+    float* d_local_code_shift_chips;
+    gr_complex* d_correlator_outs;
+    lv_16sc_t* d_correlator_outs_16sc;
+    cpu_multicorrelator_16sc multicorrelator_cpu;
+
+
+    // tracking vars
+    double d_code_freq_chips;
+    double d_code_phase_step_chips;
+    double d_carrier_doppler_hz;
+    double d_carrier_phase_step_rad;
+    double d_acc_carrier_phase_rad;
+    double d_code_phase_samples;
+    double d_acc_code_phase_secs;
+
+    //PRN period in samples
+    int d_current_prn_length_samples;
+
+    //processing samples counters
+    unsigned long int d_sample_counter;
+    unsigned long int d_acq_sample_stamp;
+
+    // CN0 estimation and lock detector
+    int d_cn0_estimation_counter;
+    gr_complex* d_Prompt_buffer;
+    float d_carrier_lock_test;
+    float d_CN0_SNV_dB_Hz;
+    float d_carrier_lock_threshold;
+    int d_carrier_lock_fail_counter;
+
+    // extended coherent integration, aligned with the navigation bits
+    float d_pll_bw_hz;
+    float d_dll_bw_hz;
+    float d_pll_bw_narrow_hz;
+    float d_dll_bw_narrow_hz;
+    int d_extend_correlation_ms;
+    bool d_enable_extended_integration;
+    bool d_preamble_synchronized;
+    double d_preamble_timestamp_s;
+    int d_integrated_epochs;
+    gr_complex* d_correlator_sums;
+    float d_carr_error_filt_hz;
+    float d_code_error_filt_chips;
+    void msg_handler_preamble_index(pmt::pmt_t msg);
+    void msg_handler_loop_bandwidths(pmt::pmt_t msg); // "loop_bandwidths" port, see below
+
+    // vector tracking aid (see Vector_Tracking_Aid)
+    bool d_vector_tracking;
+    double d_vector_max_age_s;
+    int d_vector_max_coast_ms;
+    bool d_vector_coasting;
+    int d_vector_coast_epochs; // [ms]
+    bool predicted_doppler(double timestamp_secs, double& doppler_hz);
+
+    // adaptive loop bandwidths, wide during the pull-in and narrow once steady
+    bool d_bandwidth_schedule;
+    float d_pll_bw_steady_hz;
+    float d_dll_bw_steady_hz;
+    float d_steady_cn0_db_hz;
+    int d_lock_check_decimation;
+    bool d_steady_state;
+    int d_steady_checks;
+    void update_bandwidth_schedule();
+
+    // control vars
+    bool d_enable_tracking;
+    bool d_pull_in;
+
+    // file dump
+    std::string d_dump_filename;
+    Tracking_Dump_Writer d_dump_file;
+    std::ofstream d_dump_signal;
+    std::ofstream d_dump_signal_wo;
+
+    std::map<std::string, std::string> systemName;
+    std::string sys;
+};
+
+#endif //GNSS_SDR_GPS_L1_CA_DLL_PLL_TRACKING_SC_H
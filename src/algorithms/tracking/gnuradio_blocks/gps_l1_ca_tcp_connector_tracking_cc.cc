@@ -45,12 +45,14 @@
 #include <glog/logging.h>
 #include <volk/volk.h>
 #include "gps_sdr_signal_processing.h"
+#include "code_bank.h"
 #include "tracking_discriminators.h"
 #include "lock_detectors.h"
 #include "GPS_L1_CA.h"
 #include "control_message_factory.h"
 #include "tcp_communication.h"
 #include "tcp_packet_data.h"
+#include "channel_event.h"
 
 /*!
  * \todo Include in definition header file
@@ -62,6 +64,32 @@
 
 using google::LogMessage;
 
+namespace
+{
+Dump_Schema tracking_block_dump_schema()
+{
+    Dump_Schema schema("gps_l1_ca_tcp_connector_tracking_cc");
+    schema.add<float>("abs_E")
+          .add<float>("abs_P")
+          .add<float>("abs_L")
+          .add<float>("prompt_I")
+          .add<float>("prompt_Q")
+          .add<unsigned long int>("PRN_start_sample")
+          .add<float>("acc_carrier_phase_rad")
+          .add<float>("carrier_doppler_hz")
+          .add<float>("code_freq_hz")
+          .add<float>("carr_error")
+          .add<float>("carr_nco")
+          .add<float>("code_error")
+          .add<float>("code_nco")
+          .add<float>("CN0_SNV_dB_Hz")
+          .add<float>("carrier_lock_test")
+          .add<float>("unused")
+          .add<double>("sample_counter_s");
+    return schema;
+}
+}
+
 gps_l1_ca_tcp_connector_tracking_cc_sptr
 gps_l1_ca_tcp_connector_make_tracking_cc(
         long if_freq,
@@ -118,6 +146,8 @@ Gps_L1_Ca_Tcp_Connector_Tracking_cc::Gps_L1_Ca_Tcp_Connector_Tracking_cc(
     d_port = 0;
     d_listen_connection = true;
     d_control_id = 0;
+    d_pipelined_loop = false;
+    d_pipeline_restarted = false;
 
     // Initialization of local code replica
     // Get space for a vector with the C/A code replica sampled 1x/chip
@@ -253,7 +283,7 @@ void Gps_L1_Ca_Tcp_Connector_Tracking_cc::start_tracking()
     d_carrier_doppler_hz = d_acq_carrier_doppler_hz;
 
     // generate local reference ALWAYS starting at chip 1 (1 sample per chip)
-    gps_l1_ca_code_gen_complex(d_ca_code, d_acquisition_gnss_synchro->PRN, 0);
+    Code_Bank::gps_l1_ca_code_gen_complex(d_ca_code, d_acquisition_gnss_synchro->PRN, 0);
 
     multicorrelator_cpu.set_local_code_and_taps(static_cast<int>(GPS_L1_CA_CODE_LENGTH_CHIPS), d_ca_code, d_local_code_shift_chips);
     for (int n = 0; n < d_n_correlator_taps; n++)
@@ -280,6 +310,7 @@ void Gps_L1_Ca_Tcp_Connector_Tracking_cc::start_tracking()
     // enable tracking
     d_pull_in = true;
     d_enable_tracking = true;
+    d_pipeline_restarted = true;
 
     LOG(INFO) << "PULL-IN Doppler [Hz]=" << d_carrier_doppler_hz
             << " Code Phase correction [samples]=" << delay_correction_samples
@@ -378,7 +409,7 @@ int Gps_L1_Ca_Tcp_Connector_Tracking_cc::general_work (int noutput_items __attri
                                                                                    (*d_Prompt).imag(),
                                                                                    d_acq_carrier_doppler_hz,
                                                                                    1}};
-            d_tcp_com.send_receive_tcp_packet_gps_l1_ca(tx_variables_array, &tcp_data);
+            send_receive_tcp_packet(tx_variables_array, &tcp_data);
 
             //! Recover the tracking data
             code_error = tcp_data.proc_pack_code_error;
@@ -445,7 +476,7 @@ int Gps_L1_Ca_Tcp_Connector_Tracking_cc::general_work (int noutput_items __attri
                         {
                             std::cout << "Loss of lock in channel " << d_channel << "!" << std::endl;
                             LOG(INFO) << "Loss of lock in channel " << d_channel << "!";
-                            this->message_port_pub(pmt::mp("events"), pmt::from_long(3));//3 -> loss of lock
+                            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_LOSS_OF_LOCK));
                             d_carrier_lock_fail_counter = 0;
                             d_enable_tracking = false; // TODO: check if disabling tracking is consistent with the channel state machine
 
@@ -481,7 +512,7 @@ int Gps_L1_Ca_Tcp_Connector_Tracking_cc::general_work (int noutput_items __attri
             current_synchro_data.Tracking_timestamp_secs = ((double)d_sample_counter + (double)d_rem_code_phase_samples)/(double)d_fs_in;
             //! When tracking is disabled an array of 1's is sent to maintain the TCP connection
             boost::array<float, NUM_TX_VARIABLES_GPS_L1_CA> tx_variables_array = {{1,1,1,1,1,1,1,1,0}};
-            d_tcp_com.send_receive_tcp_packet_gps_l1_ca(tx_variables_array, &tcp_data);
+            send_receive_tcp_packet(tx_variables_array, &tcp_data);
         }
 
     //assign the GNURadio block output data
@@ -504,46 +535,33 @@ int Gps_L1_Ca_Tcp_Connector_Tracking_cc::general_work (int noutput_items __attri
             tmp_E = std::abs<float>(*d_Early);
             tmp_P = std::abs<float>(*d_Prompt);
             tmp_L = std::abs<float>(*d_Late);
-            try
-            {
-                    // EPR
-                    d_dump_file.write((char*)&tmp_E, sizeof(float));
-                    d_dump_file.write((char*)&tmp_P, sizeof(float));
-                    d_dump_file.write((char*)&tmp_L, sizeof(float));
-                    // PROMPT I and Q (to analyze navigation symbols)
-                    d_dump_file.write((char*)&prompt_I, sizeof(float));
-                    d_dump_file.write((char*)&prompt_Q, sizeof(float));
-                    // PRN start sample stamp
-                    //tmp_float=(float)d_sample_counter;
-                    d_dump_file.write((char*)&d_sample_counter, sizeof(unsigned long int));
-                    // accumulated carrier phase
-                    d_dump_file.write((char*)&d_acc_carrier_phase_rad, sizeof(float));
-
-                    // carrier and code frequency
-                    d_dump_file.write((char*)&d_carrier_doppler_hz, sizeof(float));
-                    d_dump_file.write((char*)&d_code_freq_hz, sizeof(float));
-
-                    //PLL commands
-                    d_dump_file.write((char*)&carr_error, sizeof(float));
-                    d_dump_file.write((char*)&carr_nco, sizeof(float));
-
-                    //DLL commands
-                    d_dump_file.write((char*)&code_error, sizeof(float));
-                    d_dump_file.write((char*)&code_nco, sizeof(float));
-
-                    // CN0 and carrier lock test
-                    d_dump_file.write((char*)&d_CN0_SNV_dB_Hz, sizeof(float));
-                    d_dump_file.write((char*)&d_carrier_lock_test, sizeof(float));
-
-                    // AUX vars (for debug purposes)
-                    tmp_float = 0;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    d_dump_file.write((char*)&d_sample_counter_seconds, sizeof(double));
-            }
-            catch (const std::ifstream::failure &e)
-            {
-                    LOG(WARNING) << "Exception writing trk dump file " << e.what();
-            }
+            // EPR
+            d_dump_file.put<float>(tmp_E);
+            d_dump_file.put<float>(tmp_P);
+            d_dump_file.put<float>(tmp_L);
+            // PROMPT I and Q (to analyze navigation symbols)
+            d_dump_file.put<float>(prompt_I);
+            d_dump_file.put<float>(prompt_Q);
+            // PRN start sample stamp
+            //tmp_float=(float)d_sample_counter;
+            d_dump_file.put<unsigned long int>(d_sample_counter);
+            // accumulated carrier phase
+            d_dump_file.put<float>(d_acc_carrier_phase_rad);
+            // carrier and code frequency
+            d_dump_file.put<float>(d_carrier_doppler_hz);
+            d_dump_file.put<float>(d_code_freq_hz);
+            //PLL commands
+            d_dump_file.put<float>(carr_error);
+            d_dump_file.put<float>(carr_nco);
+            //DLL commands
+            d_dump_file.put<float>(code_error);
+            d_dump_file.put<float>(code_nco);
+            // CN0 and carrier lock test
+            d_dump_file.put<float>(d_CN0_SNV_dB_Hz);
+            d_dump_file.put<float>(d_carrier_lock_test);
+            // AUX vars (for debug purposes)
+            d_dump_file.put<float>(0);
+            d_dump_file.put<double>(d_sample_counter_seconds);
         }
 
     consume_each(d_current_prn_length_samples); // this is necessary in gr::block derivates
@@ -564,18 +582,16 @@ void Gps_L1_Ca_Tcp_Connector_Tracking_cc::set_channel(unsigned int channel)
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
-                            d_dump_filename.append(".dat");
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                    d_dump_filename.append(".dat");
+                    if (d_dump_file.open(d_dump_filename, tracking_block_dump_schema()))
+                        {
                             LOG(INFO) << "Tracking dump enabled on channel " << d_channel << " Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (const std::ifstream::failure &e)
-                    {
-                            LOG(WARNING) << "channel " << d_channel << " Exception opening trk dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << d_channel << " cannot open trk dump file " << d_dump_filename;
+                        }
                 }
         }
 
@@ -588,6 +604,31 @@ void Gps_L1_Ca_Tcp_Connector_Tracking_cc::set_channel(unsigned int channel)
 }
 
 
+void Gps_L1_Ca_Tcp_Connector_Tracking_cc::send_receive_tcp_packet(const boost::array<float, NUM_TX_VARIABLES_GPS_L1_CA>& tx_variables_array, tcp_packet_data* tcp_data)
+{
+    if (!d_pipelined_loop)
+        {
+            d_tcp_com.send_receive_tcp_packet_gps_l1_ca(tx_variables_array, tcp_data);
+            return;
+        }
+    // the answer is the one to the previous code period, and it is ignored
+    // if that packet was sent before the tracking started
+    tcp_packet_data answer;
+    if (d_tcp_com.send_receive_tcp_packet_gps_l1_ca_pipelined(tx_variables_array, &answer) and !d_pipeline_restarted)
+        {
+            *tcp_data = answer;
+        }
+    else
+        {
+            // no answer yet, the NCOs keep their commands
+            tcp_data->proc_pack_code_error = GPS_L1_CA_CODE_LENGTH_CHIPS * (1 / GPS_L1_CA_CODE_RATE_HZ - 1 / d_code_freq_hz);
+            tcp_data->proc_pack_carr_error = 0;
+            tcp_data->proc_pack_carrier_doppler_hz = d_carrier_doppler_hz;
+        }
+    d_pipeline_restarted = false;
+}
+
+
 void Gps_L1_Ca_Tcp_Connector_Tracking_cc::set_gnss_synchro(Gnss_Synchro* p_gnss_synchro)
 {
     d_acquisition_gnss_synchro = p_gnss_synchro;
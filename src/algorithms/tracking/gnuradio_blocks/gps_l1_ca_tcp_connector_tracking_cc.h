@@ -44,6 +44,7 @@
 #include "gnss_synchro.h"
 #include "cpu_multicorrelator.h"
 #include "tcp_communication.h"
+#include "dump_writer.h"
 
 
 
@@ -74,6 +75,15 @@ public:
     void start_tracking();
     void stop_tracking();
 
+    /*!
+     * \brief Applies the loop commands of the external process one epoch late,
+     * instead of waiting for them on every code period (see tcp_communication)
+     */
+    void set_pipelined_loop(bool pipelined_loop)
+    {
+        d_pipelined_loop = pipelined_loop;
+    }
+
     /*
      * \brief just like gr_block::general_work, only this arranges to call consume_each for you
      *
@@ -145,6 +155,9 @@ private:
     int d_listen_connection;
     float d_control_id;
     tcp_communication d_tcp_com;
+    bool d_pipelined_loop;
+    bool d_pipeline_restarted; // the next answer belongs to a packet of the previous tracking
+    void send_receive_tcp_packet(const boost::array<float, NUM_TX_VARIABLES_GPS_L1_CA>& tx_variables_array, tcp_packet_data* tcp_data);
 
     //PRN period in samples
     int d_current_prn_length_samples;
@@ -169,7 +182,7 @@ private:
 
     // file dump
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
 
     std::map<std::string, std::string> systemName;
     std::string sys;
@@ -44,10 +44,14 @@
 #include <glog/logging.h>
 #include <volk/volk.h>
 #include "gps_l2c_signal.h"
+#include "code_bank.h"
 #include "tracking_discriminators.h"
 #include "lock_detectors.h"
+#include "GPS_L1_CA.h"
 #include "GPS_L2C.h"
+#include "tracking_signal.h"
 #include "control_message_factory.h"
+#include "channel_event.h"
 
 
 /*!
@@ -59,8 +63,37 @@
 #define GPS_L2M_CARRIER_LOCK_THRESHOLD 0.75
 
 
+typedef Tracking_Nco<Gps_L2_M_Signal> L2_M_Nco;
+
+
 using google::LogMessage;
 
+namespace
+{
+Dump_Schema tracking_block_dump_schema()
+{
+    Dump_Schema schema("gps_l2_m_dll_pll_tracking_cc");
+    schema.add<float>("abs_E")
+          .add<float>("abs_P")
+          .add<float>("abs_L")
+          .add<float>("prompt_I")
+          .add<float>("prompt_Q")
+          .add<unsigned long int>("PRN_start_sample")
+          .add<double>("acc_carrier_phase_rad")
+          .add<double>("carrier_doppler_hz")
+          .add<double>("code_freq_chips")
+          .add<double>("carr_error_hz")
+          .add<double>("carr_nco_hz")
+          .add<double>("code_error_chips")
+          .add<double>("code_nco_chips")
+          .add<double>("CN0_SNV_dB_Hz")
+          .add<double>("carrier_lock_test")
+          .add<double>("rem_code_phase_samples")
+          .add<double>("next_PRN_start_sample");
+    return schema;
+}
+}
+
 gps_l2_m_dll_pll_tracking_cc_sptr
 gps_l2_m_dll_pll_make_tracking_cc(
         long if_freq,
@@ -87,7 +120,6 @@ void gps_l2_m_dll_pll_tracking_cc::forecast (int noutput_items,
 }
 
 
-
 gps_l2_m_dll_pll_tracking_cc::gps_l2_m_dll_pll_tracking_cc(
         long if_freq,
         long fs_in,
@@ -103,6 +135,7 @@ gps_l2_m_dll_pll_tracking_cc::gps_l2_m_dll_pll_tracking_cc(
     // Telemetry bit synchronization message port input
     this->message_port_register_in(pmt::mp("preamble_timestamp_s"));
     this->message_port_register_out(pmt::mp("events"));
+    d_receiver_state = Receiver_State::current();
     // initialize internal vars
     d_dump = dump;
     d_if_freq = if_freq;
@@ -126,7 +159,7 @@ gps_l2_m_dll_pll_tracking_cc::gps_l2_m_dll_pll_tracking_cc(
     d_ca_code = static_cast<gr_complex*>(volk_malloc(static_cast<int>(GPS_L2_M_CODE_LENGTH_CHIPS) * sizeof(gr_complex), volk_get_alignment()));
 
     // correlator outputs (scalar)
-    d_n_correlator_taps = 3; // Early, Prompt, and Late
+    d_n_correlator_taps = Gps_L2_M_Signal::n_taps; // Early, Prompt, and Late
     d_correlator_outs = static_cast<gr_complex*>(volk_malloc(d_n_correlator_taps*sizeof(gr_complex), volk_get_alignment()));
     for (int n = 0; n < d_n_correlator_taps; n++)
         {
@@ -134,9 +167,7 @@ gps_l2_m_dll_pll_tracking_cc::gps_l2_m_dll_pll_tracking_cc(
         }
     d_local_code_shift_chips = static_cast<float*>(volk_malloc(d_n_correlator_taps*sizeof(float), volk_get_alignment()));
     // Set TAPs delay values [chips]
-    d_local_code_shift_chips[0] = - d_early_late_spc_chips;
-    d_local_code_shift_chips[1] = 0.0;
-    d_local_code_shift_chips[2] = d_early_late_spc_chips;
+    L2_M_Nco::tap_shifts(d_early_late_spc_chips, d_local_code_shift_chips);
 
     multicorrelator_cpu.init(2 * d_vector_length, d_n_correlator_taps);
 
@@ -185,9 +216,20 @@ gps_l2_m_dll_pll_tracking_cc::gps_l2_m_dll_pll_tracking_cc(
     d_code_phase_step_chips = 0.0;
     d_carrier_phase_step_rad = 0.0;
 
+    d_l1_aiding = false;
+    d_l1_aiding_max_age = 0;
+    d_carrier_aid_hz = 0.0;
+
     LOG(INFO) << "d_vector_length" << d_vector_length;
 }
 
+void gps_l2_m_dll_pll_tracking_cc::set_l1_aiding(bool l1_aiding, unsigned int max_age_ms)
+{
+    d_l1_aiding = l1_aiding;
+    d_l1_aiding_max_age = static_cast<unsigned long int>(max_age_ms) * static_cast<unsigned long int>(d_fs_in / 1000);
+}
+
+
 void gps_l2_m_dll_pll_tracking_cc::stop_tracking()
 {
     d_enable_tracking = false; 
@@ -238,14 +280,15 @@ void gps_l2_m_dll_pll_tracking_cc::start_tracking()
     //d_acq_code_phase_samples = corrected_acq_phase_samples;
 
     d_carrier_doppler_hz = d_acq_carrier_doppler_hz;
-    d_carrier_phase_step_rad = GPS_L2_TWO_PI * d_carrier_doppler_hz / static_cast<double>(d_fs_in);
+    d_carrier_aid_hz = d_acq_carrier_doppler_hz;
+    d_carrier_phase_step_rad = L2_M_Nco::carrier_phase_step_rad(d_carrier_doppler_hz, d_fs_in);
 
     // DLL/PLL filter initialization
     d_carrier_loop_filter.initialize(); // initialize the carrier filter
     d_code_loop_filter.initialize();    // initialize the code filter
 
     // generate local reference ALWAYS starting at chip 1 (1 sample per chip)
-    gps_l2c_m_code_gen_complex(d_ca_code, d_acquisition_gnss_synchro->PRN);
+    Code_Bank::gps_l2c_m_code_gen_complex(d_ca_code, d_acquisition_gnss_synchro->PRN);
 
     multicorrelator_cpu.set_local_code_and_taps(static_cast<int>(GPS_L2_M_CODE_LENGTH_CHIPS), d_ca_code, d_local_code_shift_chips);
     for (int n = 0; n < d_n_correlator_taps; n++)
@@ -292,7 +335,6 @@ gps_l2_m_dll_pll_tracking_cc::~gps_l2_m_dll_pll_tracking_cc()
 }
 
 
-
 int gps_l2_m_dll_pll_tracking_cc::general_work (int noutput_items __attribute__((unused)), gr_vector_int &ninput_items __attribute__((unused)),
         gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
 {
@@ -344,15 +386,24 @@ int gps_l2_m_dll_pll_tracking_cc::general_work (int noutput_items __attribute__(
             carr_error_hz = pll_cloop_two_quadrant_atan(d_correlator_outs[1]) / GPS_L2_TWO_PI;
             // Carrier discriminator filter
             carr_error_filt_hz = d_carrier_loop_filter.get_carrier_nco(carr_error_hz);
+            if (d_l1_aiding)
+                {
+                    // the L1 carrier follows the satellite dynamics, the loop only tracks what is left
+                    Gnss_Synchro l1_state;
+                    if (d_receiver_state->gps_reacquisition_map.read(reacquisition_key(d_acquisition_gnss_synchro->PRN, 0), l1_state)
+                            && std::abs(static_cast<double>(d_sample_counter) - static_cast<double>(l1_state.sample_counter)) <= d_l1_aiding_max_age)
+                        {
+                            d_carrier_aid_hz = l1_state.Carrier_Doppler_hz * GPS_L2_FREQ_HZ / GPS_L1_FREQ_HZ;
+                        }
+                }
             // New carrier Doppler frequency estimation
-            d_carrier_doppler_hz = d_acq_carrier_doppler_hz + carr_error_filt_hz;
+            d_carrier_doppler_hz = d_carrier_aid_hz + carr_error_filt_hz;
             // New code Doppler frequency estimation
-            d_code_freq_chips = GPS_L2_M_CODE_RATE_HZ + ((d_carrier_doppler_hz * GPS_L2_M_CODE_RATE_HZ) / GPS_L2_FREQ_HZ);
+            d_code_freq_chips = L2_M_Nco::code_freq_chips(d_carrier_doppler_hz);
             //carrier phase accumulator for (K) doppler estimation
-            d_acc_carrier_phase_rad -= GPS_L2_TWO_PI * d_carrier_doppler_hz * GPS_L2_M_PERIOD;
+            d_acc_carrier_phase_rad -= L2_M_Nco::period_phase_rad(d_carrier_doppler_hz);
             //remanent carrier phase to prevent overflow in the code NCO
-            d_rem_carr_phase_rad = d_rem_carr_phase_rad + GPS_L2_TWO_PI * d_carrier_doppler_hz * GPS_L2_M_PERIOD;
-            d_rem_carr_phase_rad = fmod(d_rem_carr_phase_rad, GPS_L2_TWO_PI);
+            d_rem_carr_phase_rad = L2_M_Nco::wrap_phase_rad(d_rem_carr_phase_rad + L2_M_Nco::period_phase_rad(d_carrier_doppler_hz));
 
             // ################## DLL ##########################################################
             // DLL discriminator
@@ -361,32 +412,25 @@ int gps_l2_m_dll_pll_tracking_cc::general_work (int noutput_items __attribute__(
             code_error_filt_chips = d_code_loop_filter.get_code_nco(code_error_chips); //[chips/second]
             //Code phase accumulator
             double code_error_filt_secs;
-            code_error_filt_secs = (GPS_L2_M_PERIOD * code_error_filt_chips) / GPS_L2_M_CODE_RATE_HZ; //[seconds]
+            code_error_filt_secs = L2_M_Nco::code_error_secs(code_error_filt_chips); //[seconds]
             d_acc_code_phase_secs = d_acc_code_phase_secs + code_error_filt_secs;
 
             // ################## CARRIER AND CODE NCO BUFFER ALIGNEMENT #######################
             // keep alignment parameters for the next input buffer
-            double T_chip_seconds;
-            double T_prn_seconds;
-            double T_prn_samples;
-            double K_blk_samples;
             // Compute the next buffer length based in the new period of the PRN sequence and the code phase error estimation
-            T_chip_seconds = 1.0 / d_code_freq_chips;
-            T_prn_seconds = T_chip_seconds * GPS_L2_M_CODE_LENGTH_CHIPS;
-            T_prn_samples = T_prn_seconds * static_cast<double>(d_fs_in);
-            K_blk_samples = T_prn_samples + d_rem_code_phase_samples + code_error_filt_secs * static_cast<double>(d_fs_in);
+            double K_blk_samples = L2_M_Nco::next_period_samples(d_code_freq_chips, d_rem_code_phase_samples, code_error_filt_secs, d_fs_in);
             d_current_prn_length_samples = round(K_blk_samples); //round to a discrete samples
 
             //################### PLL COMMANDS #################################################
             //carrier phase step (NCO phase increment per sample) [rads/sample]
-            d_carrier_phase_step_rad = GPS_L2_TWO_PI * d_carrier_doppler_hz / static_cast<double>(d_fs_in);
+            d_carrier_phase_step_rad = L2_M_Nco::carrier_phase_step_rad(d_carrier_doppler_hz, d_fs_in);
 
             //################### DLL COMMANDS #################################################
             //code phase step (Code resampler phase increment per sample) [chips/sample]
-            d_code_phase_step_chips = d_code_freq_chips / static_cast<double>(d_fs_in);
+            d_code_phase_step_chips = L2_M_Nco::code_phase_step(d_code_freq_chips, d_fs_in);
 
             //remnant code phase [chips]
-            d_rem_code_phase_chips = d_rem_code_phase_samples * (d_code_freq_chips / static_cast<double>(d_fs_in));
+            d_rem_code_phase_chips = L2_M_Nco::rem_code_phase(d_rem_code_phase_samples, d_code_freq_chips, d_fs_in);
 
             // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
             if (d_cn0_estimation_counter < GPS_L2M_CN0_ESTIMATION_SAMPLES)
@@ -415,7 +459,7 @@ int gps_l2_m_dll_pll_tracking_cc::general_work (int noutput_items __attribute__(
                         {
                             std::cout << "Loss of lock in channel " << d_channel << "!" << std::endl;
                             LOG(INFO) << "Loss of lock in channel " << d_channel << "!";
-                            this->message_port_pub(pmt::mp("events"), pmt::from_long(3));//3 -> loss of lock
+                            this->message_port_pub(pmt::mp("events"), channel_event_pmt(CHANNEL_EVENT_LOSS_OF_LOCK));
                             d_carrier_lock_fail_counter = 0;
                             d_enable_tracking = false; // TODO: check if disabling tracking is consistent with the channel state machine
                         }
@@ -456,53 +500,38 @@ int gps_l2_m_dll_pll_tracking_cc::general_work (int noutput_items __attribute__(
             float prompt_I;
             float prompt_Q;
             float tmp_E, tmp_P, tmp_L;
-            double tmp_double;
             prompt_I = d_correlator_outs[1].real();
             prompt_Q = d_correlator_outs[1].imag();
             tmp_E = std::abs<float>(d_correlator_outs[0]);
             tmp_P = std::abs<float>(d_correlator_outs[1]);
             tmp_L = std::abs<float>(d_correlator_outs[2]);
-            try
-            {
-                    // EPR
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_E), sizeof(float));
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_P), sizeof(float));
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_L), sizeof(float));
-                    // PROMPT I and Q (to analyze navigation symbols)
-                    d_dump_file.write(reinterpret_cast<char*>(&prompt_I), sizeof(float));
-                    d_dump_file.write(reinterpret_cast<char*>(&prompt_Q), sizeof(float));
-                    // PRN start sample stamp
-                    //tmp_float=(float)d_sample_counter;
-                    d_dump_file.write(reinterpret_cast<char*>(&d_sample_counter), sizeof(unsigned long int));
-                    // accumulated carrier phase
-                    d_dump_file.write(reinterpret_cast<char*>(&d_acc_carrier_phase_rad), sizeof(double));
-
-                    // carrier and code frequency
-                    d_dump_file.write(reinterpret_cast<char*>(&d_carrier_doppler_hz), sizeof(double));
-                    d_dump_file.write(reinterpret_cast<char*>(&d_code_freq_chips), sizeof(double));
-
-                    //PLL commands
-                    d_dump_file.write(reinterpret_cast<char*>(&carr_error_hz), sizeof(double));
-                    d_dump_file.write(reinterpret_cast<char*>(&d_carrier_doppler_hz), sizeof(double));
-
-                    //DLL commands
-                    d_dump_file.write(reinterpret_cast<char*>(&code_error_chips), sizeof(double));
-                    d_dump_file.write(reinterpret_cast<char*>(&code_error_filt_chips), sizeof(double));
-
-                    // CN0 and carrier lock test
-                    d_dump_file.write(reinterpret_cast<char*>(&d_CN0_SNV_dB_Hz), sizeof(double));
-                    d_dump_file.write(reinterpret_cast<char*>(&d_carrier_lock_test), sizeof(double));
-
-                    // AUX vars (for debug purposes)
-                    tmp_double = d_rem_code_phase_samples;
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_double), sizeof(double));
-                    tmp_double = static_cast<double>(d_sample_counter + d_current_prn_length_samples);
-                    d_dump_file.write(reinterpret_cast<char*>(&tmp_double), sizeof(double));
-            }
-            catch (std::ifstream::failure& e)
-            {
-                    LOG(WARNING) << "Exception writing trk dump file " << e.what();
-            }
+            // EPR
+            d_dump_file.put<float>(tmp_E);
+            d_dump_file.put<float>(tmp_P);
+            d_dump_file.put<float>(tmp_L);
+            // PROMPT I and Q (to analyze navigation symbols)
+            d_dump_file.put<float>(prompt_I);
+            d_dump_file.put<float>(prompt_Q);
+            // PRN start sample stamp
+            //tmp_float=(float)d_sample_counter;
+            d_dump_file.put<unsigned long int>(d_sample_counter);
+            // accumulated carrier phase
+            d_dump_file.put<double>(d_acc_carrier_phase_rad);
+            // carrier and code frequency
+            d_dump_file.put<double>(d_carrier_doppler_hz);
+            d_dump_file.put<double>(d_code_freq_chips);
+            //PLL commands
+            d_dump_file.put<double>(carr_error_hz);
+            d_dump_file.put<double>(d_carrier_doppler_hz);
+            //DLL commands
+            d_dump_file.put<double>(code_error_chips);
+            d_dump_file.put<double>(code_error_filt_chips);
+            // CN0 and carrier lock test
+            d_dump_file.put<double>(d_CN0_SNV_dB_Hz);
+            d_dump_file.put<double>(d_carrier_lock_test);
+            // AUX vars (for debug purposes)
+            d_dump_file.put<double>(d_rem_code_phase_samples);
+            d_dump_file.put<double>(static_cast<double>(d_sample_counter + d_current_prn_length_samples));
         }
     consume_each(d_current_prn_length_samples); // this is necessary in gr::block derivates
     d_sample_counter += d_current_prn_length_samples; //count for the processed samples
@@ -510,7 +539,6 @@ int gps_l2_m_dll_pll_tracking_cc::general_work (int noutput_items __attribute__(
 }
 
 
-
 void gps_l2_m_dll_pll_tracking_cc::set_channel(unsigned int channel)
 {
     d_channel = channel;
@@ -520,24 +548,21 @@ void gps_l2_m_dll_pll_tracking_cc::set_channel(unsigned int channel)
         {
             if (d_dump_file.is_open() == false)
                 {
-                    try
-                    {
-                            d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
-                            d_dump_filename.append(".dat");
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                    d_dump_filename.append(".dat");
+                    if (d_dump_file.open(d_dump_filename, tracking_block_dump_schema()))
+                        {
                             LOG(INFO) << "Tracking dump enabled on channel " << d_channel << " Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (std::ifstream::failure& e)
-                    {
-                            LOG(WARNING) << "channel " << d_channel << " Exception opening trk dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << d_channel << " cannot open trk dump file " << d_dump_filename;
+                        }
                 }
         }
 }
 
 
-
 void gps_l2_m_dll_pll_tracking_cc::set_gnss_synchro(Gnss_Synchro* p_gnss_synchro)
 {
     d_acquisition_gnss_synchro = p_gnss_synchro;
@@ -41,9 +41,11 @@
 #include <string>
 #include <gnuradio/block.h>
 #include "gnss_synchro.h"
+#include "receiver_state.h"
 #include "tracking_2nd_DLL_filter.h"
 #include "tracking_2nd_PLL_filter.h"
 #include "cpu_multicorrelator.h"
+#include "dump_writer.h"
 
 class gps_l2_m_dll_pll_tracking_cc;
 
@@ -75,6 +77,13 @@ public:
     void start_tracking();
     void stop_tracking();
 
+    /*!
+     * \brief Aids the carrier loop with the GPS L1 tracking of the same satellite: its
+     * Doppler scaled to L2, if at most max_age_ms old, replaces the acquisition
+     * Doppler the output of the loop filter is added to
+     */
+    void set_l1_aiding(bool l1_aiding, unsigned int max_age_ms);
+
     int general_work (int noutput_items, gr_vector_int &ninput_items,
             gr_vector_const_void_star &input_items, gr_vector_void_star &output_items);
 
@@ -105,6 +114,7 @@ private:
     bool d_dump;
 
     Gnss_Synchro* d_acquisition_gnss_synchro;
+    std::shared_ptr<Receiver_State> d_receiver_state; // tables of the receiver, current at construction
     unsigned int d_channel;
     long d_if_freq;
     long d_fs_in;
@@ -158,9 +168,14 @@ private:
     bool d_enable_tracking;
     bool d_pull_in;
 
+    // L1 aiding
+    bool d_l1_aiding;
+    unsigned long int d_l1_aiding_max_age;
+    double d_carrier_aid_hz;
+
     // file dump
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    Dump_Writer d_dump_file;
 
     std::map<std::string, std::string> systemName;
     std::string sys;
@@ -0,0 +1,110 @@
+/*!
+ * \file cpu_array_correlator.cc
+ * \brief CPU correlator of the Prompt of a tracking channel on each element
+ * of an antenna array
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * Class that implements the carrier wipe-off and Prompt correlation of
+ * several time-aligned input streams with the same local replica
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "cpu_array_correlator.h"
+#include <cmath>
+#include <volk_gnsssdr/volk_gnsssdr.h>
+
+
+cpu_array_correlator::cpu_array_correlator()
+{
+    d_prompt_code = nullptr;
+    d_local_code_in = nullptr;
+    d_code_length_chips = 0;
+    d_max_signal_length_samples = 0;
+}
+
+
+cpu_array_correlator::~cpu_array_correlator()
+{
+    if (d_prompt_code != nullptr)
+        {
+            cpu_array_correlator::free();
+        }
+}
+
+
+bool cpu_array_correlator::init(int max_signal_length_samples)
+{
+    d_prompt_code = static_cast<std::complex<float>**>(volk_gnsssdr_malloc(sizeof(std::complex<float>*), volk_gnsssdr_get_alignment()));
+    d_prompt_code[0] = static_cast<std::complex<float>*>(volk_gnsssdr_malloc(max_signal_length_samples * sizeof(std::complex<float>), volk_gnsssdr_get_alignment()));
+    d_max_signal_length_samples = max_signal_length_samples;
+    return true;
+}
+
+
+bool cpu_array_correlator::set_local_code(int code_length_chips, const std::complex<float>* local_code_in)
+{
+    d_local_code_in = local_code_in;
+    d_code_length_chips = code_length_chips;
+    return true;
+}
+
+
+bool cpu_array_correlator::Carrier_wipeoff_array_correlator(std::complex<float>* corr_out, const std::complex<float>** elements_in, int n_elements,
+        float rem_carrier_phase_in_rad, float phase_step_rad, float rem_code_phase_chips, float code_phase_step_chips, int signal_length_samples)
+{
+    if (d_prompt_code == nullptr or d_local_code_in == nullptr or signal_length_samples > d_max_signal_length_samples)
+        {
+            return false;
+        }
+    float prompt_shift_chips[1] = {0.0};
+    volk_gnsssdr_32fc_xn_resampler_32fc_xn(d_prompt_code,
+            d_local_code_in,
+            rem_code_phase_chips,
+            code_phase_step_chips,
+            prompt_shift_chips,
+            d_code_length_chips,
+            1,
+            signal_length_samples);
+    // the replica is the common vector, so the elements are the N inputs of one call
+    lv_32fc_t phase_offset_as_complex[1];
+    phase_offset_as_complex[0] = lv_cmake(std::cos(rem_carrier_phase_in_rad), -std::sin(rem_carrier_phase_in_rad));
+    volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn(corr_out, d_prompt_code[0], std::exp(lv_32fc_t(0, - phase_step_rad)), phase_offset_as_complex, (const lv_32fc_t**)elements_in, n_elements, signal_length_samples);
+    return true;
+}
+
+
+bool cpu_array_correlator::free()
+{
+    if (d_prompt_code != nullptr)
+        {
+            volk_gnsssdr_free(d_prompt_code[0]);
+            volk_gnsssdr_free(d_prompt_code);
+            d_prompt_code = nullptr;
+        }
+    return true;
+}
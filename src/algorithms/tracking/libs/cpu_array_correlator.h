@@ -0,0 +1,74 @@
+/*!
+ * \file cpu_array_correlator.h
+ * \brief CPU correlator of the Prompt of a tracking channel on each element
+ * of an antenna array
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * Class that implements the carrier wipe-off and Prompt correlation of
+ * several time-aligned input streams with the same local replica
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_CPU_ARRAY_CORRELATOR_H_
+#define GNSS_SDR_CPU_ARRAY_CORRELATOR_H_
+
+#include <complex>
+
+/*!
+ * \brief Class that implements carrier wipe-off and the Prompt correlator
+ * of a tracking channel on each element of an antenna array.
+ *
+ * The elements see the same code and Doppler, so the Prompt code is
+ * resampled once and carries the carrier rotation, and all the elements
+ * are correlated with it in a single call of the VOLK_GNSSSDR multi-input
+ * dot product kernel, as cpu_multicorrelator does with the taps.
+ */
+class cpu_array_correlator
+{
+public:
+    cpu_array_correlator();
+    ~cpu_array_correlator();
+    bool init(int max_signal_length_samples);
+    bool set_local_code(int code_length_chips, const std::complex<float>* local_code_in);
+
+    /*!
+     * \brief Correlates the n_elements streams of elements_in with the
+     * Prompt replica, and stores the n_elements outputs in corr_out
+     */
+    bool Carrier_wipeoff_array_correlator(std::complex<float>* corr_out, const std::complex<float>** elements_in, int n_elements,
+            float rem_carrier_phase_in_rad, float phase_step_rad, float rem_code_phase_chips, float code_phase_step_chips, int signal_length_samples);
+    bool free();
+
+private:
+    std::complex<float>** d_prompt_code; // the resampled Prompt replica, a single vector
+    const std::complex<float>* d_local_code_in;
+    int d_code_length_chips;
+    int d_max_signal_length_samples;
+};
+
+#endif /* GNSS_SDR_CPU_ARRAY_CORRELATOR_H_ */
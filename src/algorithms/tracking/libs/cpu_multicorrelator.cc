@@ -36,6 +36,34 @@
 #include <cmath>
 #include <iostream>
 #include <volk_gnsssdr/volk_gnsssdr.h>
+#include "buffer_allocator.h"
+
+namespace
+{
+/*
+ * The replicas of all the correlators in one buffer, each one starting on
+ * an alignment boundary. codes[0] is always the start of the buffer.
+ */
+std::complex<float>** allocate_codes(int n_correlators, int length_samples)
+{
+    int n_codes = n_correlators > 0 ? n_correlators : 1;
+    std::complex<float>** codes = static_cast<std::complex<float>**>(volk_gnsssdr_malloc(n_codes * sizeof(std::complex<float>*), volk_gnsssdr_get_alignment()));
+    size_t stride = (length_samples * sizeof(std::complex<float>) + Buffer_Allocator::alignment - 1) / Buffer_Allocator::alignment * Buffer_Allocator::alignment;
+    char* buffer = static_cast<char*>(Buffer_Allocator::allocate(stride * n_codes, "tracking"));
+    for (int n = 0; n < n_codes; n++)
+        {
+            codes[n] = reinterpret_cast<std::complex<float>*>(buffer + n * stride);
+        }
+    return codes;
+}
+
+
+void free_codes(std::complex<float>** codes)
+{
+    Buffer_Allocator::release(codes[0]);
+    volk_gnsssdr_free(codes);
+}
+}
 
 
 cpu_multicorrelator::cpu_multicorrelator()
@@ -47,6 +75,12 @@ cpu_multicorrelator::cpu_multicorrelator()
     d_local_codes_resampled = nullptr;
     d_code_length_chips = 0;
     d_n_correlators = 0;
+    d_max_signal_length_samples = 0;
+    d_replica_max_sets = 0;
+    d_replica_tolerance_chips = 0.0;
+    d_replica_hits = 0;
+    d_replica_misses = 0;
+    d_local_codes_active = nullptr;
 }
 
 
@@ -64,14 +98,10 @@ bool cpu_multicorrelator::init(
         int n_correlators)
 {
     // ALLOCATE MEMORY FOR INTERNAL vectors
-    size_t size = max_signal_length_samples * sizeof(std::complex<float>);
-
-    d_local_codes_resampled = static_cast<std::complex<float>**>(volk_gnsssdr_malloc(n_correlators * sizeof(std::complex<float>*), volk_gnsssdr_get_alignment()));
-    for (int n = 0; n < n_correlators; n++)
-        {
-            d_local_codes_resampled[n] = static_cast<std::complex<float>*>(volk_gnsssdr_malloc(size, volk_gnsssdr_get_alignment()));
-        }
+    d_local_codes_resampled = allocate_codes(n_correlators, max_signal_length_samples);
     d_n_correlators = n_correlators;
+    d_max_signal_length_samples = max_signal_length_samples;
+    d_local_codes_active = d_local_codes_resampled;
     return true;
 }
 
@@ -85,6 +115,7 @@ bool cpu_multicorrelator::set_local_code_and_taps(
     d_local_code_in = local_code_in;
     d_shifts_chips = shifts_chips;
     d_code_length_chips = code_length_chips;
+    clear_replica_cache();
     return true;
 }
 
@@ -98,16 +129,98 @@ bool cpu_multicorrelator::set_input_output_vectors(std::complex<float>* corr_out
 }
 
 
+void cpu_multicorrelator::set_replica_cache(unsigned int max_sets, float tolerance_chips)
+{
+    clear_replica_cache();
+    d_replica_max_sets = max_sets;
+    d_replica_tolerance_chips = tolerance_chips;
+    if (d_replica_tolerance_chips <= 0.0)
+        {
+            d_replica_max_sets = 0;
+        }
+    d_replica_hits = 0;
+    d_replica_misses = 0;
+}
+
+
+void cpu_multicorrelator::clear_replica_cache()
+{
+    for (std::list<Replica_Set>::iterator it = d_replica_sets.begin(); it != d_replica_sets.end(); ++it)
+        {
+            free_codes(it->codes);
+        }
+    d_replica_sets.clear();
+    d_replica_index.clear();
+    d_local_codes_active = d_local_codes_resampled;
+}
+
+
 void cpu_multicorrelator::update_local_code(int correlator_length_samples, float rem_code_phase_chips, float code_phase_step_chips)
 {
-    volk_gnsssdr_32fc_xn_resampler_32fc_xn(d_local_codes_resampled,
+    if (d_replica_max_sets == 0 or correlator_length_samples > d_max_signal_length_samples)
+        {
+            volk_gnsssdr_32fc_xn_resampler_32fc_xn(d_local_codes_resampled,
+                    d_local_code_in,
+                    rem_code_phase_chips,
+                    code_phase_step_chips,
+                    d_shifts_chips,
+                    d_code_length_chips,
+                    d_n_correlators,
+                    correlator_length_samples);
+            d_local_codes_active = d_local_codes_resampled;
+            return;
+        }
+
+    // Half a quantum of remnant phase plus half a quantum of step accumulated
+    // over the longest signal keep the replica within the tolerance
+    double rem_quantum_chips = d_replica_tolerance_chips;
+    double step_quantum_chips = d_replica_tolerance_chips / static_cast<double>(d_max_signal_length_samples);
+    Replica_Key key(std::llround(code_phase_step_chips / step_quantum_chips), std::llround(rem_code_phase_chips / rem_quantum_chips));
+
+    std::map<Replica_Key, std::list<Replica_Set>::iterator>::iterator found = d_replica_index.find(key);
+    if (found != d_replica_index.end())
+        {
+            // most recently used goes first; list iterators stay valid when spliced
+            d_replica_sets.splice(d_replica_sets.begin(), d_replica_sets, found->second);
+            if (found->second->length_samples >= correlator_length_samples)
+                {
+                    d_replica_hits++;
+                    d_local_codes_active = found->second->codes;
+                    return;
+                }
+        }
+    else if (d_replica_sets.size() < d_replica_max_sets)
+        {
+            Replica_Set set;
+            set.key = key;
+            set.length_samples = 0;
+            set.codes = allocate_codes(d_n_correlators, d_max_signal_length_samples);
+            d_replica_sets.push_front(set);
+            d_replica_index[key] = d_replica_sets.begin();
+        }
+    else
+        {
+            // recycle the buffers of the least recently used set
+            d_replica_index.erase(d_replica_sets.back().key);
+            d_replica_sets.splice(d_replica_sets.begin(), d_replica_sets, --d_replica_sets.end());
+            d_replica_sets.front().key = key;
+            d_replica_sets.front().length_samples = 0;
+            d_replica_index[key] = d_replica_sets.begin();
+        }
+
+    // resample at the centre of the quantization cell, so every call that maps to it gets the same replicas
+    Replica_Set& set = d_replica_sets.front();
+    d_replica_misses++;
+    volk_gnsssdr_32fc_xn_resampler_32fc_xn(set.codes,
             d_local_code_in,
-            rem_code_phase_chips,
-            code_phase_step_chips,
+            static_cast<float>(key.second * rem_quantum_chips),
+            static_cast<float>(key.first * step_quantum_chips),
             d_shifts_chips,
             d_code_length_chips,
             d_n_correlators,
             correlator_length_samples);
+    set.length_samples = correlator_length_samples;
+    d_local_codes_active = set.codes;
 }
 
 
@@ -123,7 +236,7 @@ bool cpu_multicorrelator::Carrier_wipeoff_multicorrelator_resampler(
     lv_32fc_t phase_offset_as_complex[1];
     phase_offset_as_complex[0] = lv_cmake(std::cos(rem_carrier_phase_in_rad), -std::sin(rem_carrier_phase_in_rad));
     // call VOLK_GNSSSDR kernel
-    volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn(d_corr_out, d_sig_in, std::exp(lv_32fc_t(0, - phase_step_rad)), phase_offset_as_complex, (const lv_32fc_t**)d_local_codes_resampled, d_n_correlators, signal_length_samples);
+    volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn(d_corr_out, d_sig_in, std::exp(lv_32fc_t(0, - phase_step_rad)), phase_offset_as_complex, (const lv_32fc_t**)d_local_codes_active, d_n_correlators, signal_length_samples);
     return true;
 }
 
@@ -131,15 +244,13 @@ bool cpu_multicorrelator::Carrier_wipeoff_multicorrelator_resampler(
 bool cpu_multicorrelator::free()
 {
     // Free memory
+    clear_replica_cache();
     if (d_local_codes_resampled != nullptr)
         {
-            for (int n = 0; n < d_n_correlators; n++)
-                {
-                    volk_gnsssdr_free(d_local_codes_resampled[n]);
-                }
-            volk_gnsssdr_free(d_local_codes_resampled);
+            free_codes(d_local_codes_resampled);
             d_local_codes_resampled = nullptr;
         }
+    d_local_codes_active = nullptr;
     return true;
 }
 
@@ -37,6 +37,9 @@
 
 
 #include <complex>
+#include <list>
+#include <map>
+#include <utility>
 
 /*!
  * \brief Class that implements carrier wipe-off and correlators.
@@ -53,6 +56,22 @@ public:
     bool Carrier_wipeoff_multicorrelator_resampler(float rem_carrier_phase_in_rad, float phase_step_rad, float rem_code_phase_chips, float code_phase_step_chips, int signal_length_samples);
     bool free();
 
+    /*!
+     * \brief Keeps up to max_sets resampled replica sets, instead of resampling the code on every call
+     *
+     * The code phase step and the remnant code phase are quantized so that,
+     * for any signal length up to the one passed to init(), the code phase
+     * of the replicas is off by at most tolerance_chips. Calls that fall
+     * in the same quantization cell reuse the same replicas; the least
+     * recently used set is recycled when the cache is full. The cache costs
+     * max_sets * n_correlators * max_signal_length_samples complex samples,
+     * and is emptied whenever the local code or the taps change.
+     * max_sets = 0 (the default) resamples exactly on every call.
+     */
+    void set_replica_cache(unsigned int max_sets, float tolerance_chips);
+    unsigned long long replica_cache_hits() const { return d_replica_hits; }
+    unsigned long long replica_cache_misses() const { return d_replica_misses; }
+
 private:
     // Allocate the device input vectors
     const std::complex<float> *d_sig_in;
@@ -62,6 +81,24 @@ private:
     float *d_shifts_chips;
     int d_code_length_chips;
     int d_n_correlators;
+    int d_max_signal_length_samples;
+
+    // resampled replica cache, most recently used set first
+    typedef std::pair<long long, long long> Replica_Key; // quantized code phase step and remnant code phase
+    struct Replica_Set
+    {
+        Replica_Key key;
+        int length_samples; // samples resampled so far
+        std::complex<float> **codes;
+    };
+    std::list<Replica_Set> d_replica_sets;
+    std::map<Replica_Key, std::list<Replica_Set>::iterator> d_replica_index;
+    unsigned int d_replica_max_sets;
+    float d_replica_tolerance_chips;
+    unsigned long long d_replica_hits;
+    unsigned long long d_replica_misses;
+    std::complex<float> **d_local_codes_active; // d_local_codes_resampled, or the cached set in use
+    void clear_replica_cache();
 };
 
 
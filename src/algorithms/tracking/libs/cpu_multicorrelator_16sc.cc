@@ -38,20 +38,13 @@
 
 
 bool cpu_multicorrelator_16sc::init(
-        int max_signal_length_samples,
+        int max_signal_length_samples __attribute__((unused)),
         int n_correlators)
 {
-    // ALLOCATE MEMORY FOR INTERNAL vectors
-    size_t size = max_signal_length_samples * sizeof(lv_16sc_t);
-
+    // The code replicas are resampled on the fly by the correlation kernel:
+    // only the code phase of each tap needs to be stored
     d_n_correlators = n_correlators;
     d_tmp_code_phases_chips = static_cast<float*>(volk_gnsssdr_malloc(n_correlators * sizeof(float), volk_gnsssdr_get_alignment()));
-
-    d_local_codes_resampled = static_cast<lv_16sc_t**>(volk_gnsssdr_malloc(n_correlators * sizeof(lv_16sc_t*), volk_gnsssdr_get_alignment()));
-    for (int n = 0; n < n_correlators; n++)
-        {
-            d_local_codes_resampled[n] = static_cast<lv_16sc_t*>(volk_gnsssdr_malloc(size, volk_gnsssdr_get_alignment()));
-        }
     return true;
 }
 
@@ -78,23 +71,6 @@ bool cpu_multicorrelator_16sc::set_input_output_vectors(lv_16sc_t* corr_out, con
 }
 
 
-void cpu_multicorrelator_16sc::update_local_code(int correlator_length_samples, float rem_code_phase_chips, float code_phase_step_chips)
-{
-    for (int n = 0; n < d_n_correlators; n++)
-        {
-            d_tmp_code_phases_chips[n] = d_shifts_chips[n] - rem_code_phase_chips;
-        }
-
-    volk_gnsssdr_16ic_xn_resampler_fast_16ic_xn(d_local_codes_resampled,
-            d_local_code_in,
-            d_tmp_code_phases_chips,
-            code_phase_step_chips,
-            correlator_length_samples,
-            d_n_correlators,
-            d_code_length_chips);
-}
-
-
 bool cpu_multicorrelator_16sc::Carrier_wipeoff_multicorrelator_resampler(
         float rem_carrier_phase_in_rad,
         float phase_step_rad,
@@ -102,12 +78,16 @@ bool cpu_multicorrelator_16sc::Carrier_wipeoff_multicorrelator_resampler(
         float code_phase_step_chips,
         int signal_length_samples)
 {
-    update_local_code(signal_length_samples, rem_code_phase_chips, code_phase_step_chips);
+    for (int n = 0; n < d_n_correlators; n++)
+        {
+            d_tmp_code_phases_chips[n] = d_shifts_chips[n] - rem_code_phase_chips;
+        }
     // Regenerate phase at each call in order to avoid numerical issues
     lv_32fc_t phase_offset_as_complex[1];
     phase_offset_as_complex[0] = lv_cmake(std::cos(rem_carrier_phase_in_rad), -std::sin(rem_carrier_phase_in_rad));
-    // call VOLK_GNSSSDR kernel
-    volk_gnsssdr_16ic_x2_rotator_dot_prod_16ic_xn(d_corr_out, d_sig_in, std::exp(lv_32fc_t(0, -phase_step_rad)), phase_offset_as_complex, (const lv_16sc_t**)d_local_codes_resampled, d_n_correlators, signal_length_samples);
+    // call VOLK_GNSSSDR kernel: resampling, carrier wipe-off and correlation in a single pass
+    volk_gnsssdr_16ic_x2_rotator_resampler_dot_prod_16ic_xn(d_corr_out, d_sig_in, std::exp(lv_32fc_t(0, -phase_step_rad)), phase_offset_as_complex,
+            d_local_code_in, d_tmp_code_phases_chips, code_phase_step_chips, d_code_length_chips, d_n_correlators, signal_length_samples);
     return true;
 }
 
@@ -118,7 +98,6 @@ cpu_multicorrelator_16sc::cpu_multicorrelator_16sc()
     d_local_code_in = nullptr;
     d_shifts_chips = nullptr;
     d_corr_out = nullptr;
-    d_local_codes_resampled = nullptr;
     d_tmp_code_phases_chips = nullptr;
     d_code_length_chips = 0;
     d_n_correlators = 0;
@@ -127,7 +106,7 @@ cpu_multicorrelator_16sc::cpu_multicorrelator_16sc()
 
 cpu_multicorrelator_16sc::~cpu_multicorrelator_16sc()
 {
-    if(d_local_codes_resampled != nullptr)
+    if(d_tmp_code_phases_chips != nullptr)
         {
             cpu_multicorrelator_16sc::free();
         }
@@ -142,15 +121,6 @@ bool cpu_multicorrelator_16sc::free()
             volk_gnsssdr_free(d_tmp_code_phases_chips);
             d_tmp_code_phases_chips = nullptr;
         }
-    if (d_local_codes_resampled != nullptr)
-        {
-            for (int n = 0; n < d_n_correlators; n++)
-                {
-                    volk_gnsssdr_free(d_local_codes_resampled[n]);
-                }
-            volk_gnsssdr_free(d_local_codes_resampled);
-            d_local_codes_resampled = nullptr;
-        }
     return true;
 }
 
@@ -49,7 +49,6 @@ public:
     bool init(int max_signal_length_samples, int n_correlators);
     bool set_local_code_and_taps(int code_length_chips, const lv_16sc_t* local_code_in, float *shifts_chips);
     bool set_input_output_vectors(lv_16sc_t* corr_out, const lv_16sc_t* sig_in);
-    void update_local_code(int correlator_length_samples, float rem_code_phase_chips, float code_phase_step_chips);
     bool Carrier_wipeoff_multicorrelator_resampler(float rem_carrier_phase_in_rad, float phase_step_rad, float rem_code_phase_chips, float code_phase_step_chips, int signal_length_samples);
     bool free();
 
@@ -57,7 +56,6 @@ private:
     // Allocate the device input vectors
     const lv_16sc_t *d_sig_in;
     float *d_tmp_code_phases_chips;
-    lv_16sc_t **d_local_codes_resampled;
     const lv_16sc_t *d_local_code_in;
     lv_16sc_t *d_corr_out;
     float *d_shifts_chips;
@@ -0,0 +1,446 @@
+/*!
+ * \file cpu_multicorrelator_batch.cc
+ * \brief CPU multiTAP correlator that processes the correlations of several
+ * tracking channels in a single pass over the input
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * Class that implements a cache-blocked multiTAP correlator for a batch of
+ * tracking channels, and the batcher that gathers their correlations
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "cpu_multicorrelator_batch.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <volk_gnsssdr/volk_gnsssdr.h>
+
+namespace
+{
+// 1024 samples of input and of each of 3 taps take 32 KB
+const int tile_samples = 1024;
+
+// Most receivers do not have more channels
+const unsigned int max_batch_jobs = 64;
+
+struct Correlator_Batch
+{
+    std::vector<Correlator_Job> jobs;
+    bool done;
+    bool ok;
+};
+
+boost::mutex batcher_mutex;
+boost::condition_variable batcher_condition;
+int batcher_channels = 0;
+std::shared_ptr<Correlator_Batch> open_batch;
+// the correlators of the batches that are not running
+std::vector<std::unique_ptr<cpu_multicorrelator_batch> > idle_correlators;
+
+
+// carrier phase of job at sample stamp [rad]
+double carrier_phase(const Correlator_Job& job, unsigned long int sample)
+{
+    return static_cast<double>(job.rem_carrier_phase_in_rad)
+            + static_cast<double>(job.phase_step_rad) * (static_cast<double>(sample) - static_cast<double>(job.sample_stamp));
+}
+
+
+// local code chip of the zero tap of job at sample stamp, in [0, code_length_chips)
+double code_phase(const Correlator_Job& job, unsigned long int sample)
+{
+    double chips = static_cast<double>(job.code_phase_step_chips) * (static_cast<double>(sample) - static_cast<double>(job.sample_stamp))
+            - static_cast<double>(job.rem_code_phase_chips);
+    chips = std::fmod(chips, static_cast<double>(job.code_length_chips));
+    return chips < 0.0 ? chips + static_cast<double>(job.code_length_chips) : chips;
+}
+
+
+bool can_share_wipeoff(const Correlator_Job& a, const Correlator_Job& b)
+{
+    return a.prn_group != 0 and a.prn_group == b.prn_group
+            and a.code_length_chips == b.code_length_chips
+            and std::abs(a.phase_step_rad - b.phase_step_rad) <= std::min(a.group_phase_step_rad, b.group_phase_step_rad)
+            and std::max(a.sample_stamp, b.sample_stamp) < std::min(a.sample_stamp + a.signal_length_samples, b.sample_stamp + b.signal_length_samples);
+}
+
+
+// joins each job to the group of the first job it can share the wipeoff with, up to max_taps taps per group
+void assign_groups(const Correlator_Job* jobs, int n_jobs, int max_taps, std::vector<int>& leader, std::vector<int>& group_taps)
+{
+    leader.resize(n_jobs);
+    group_taps.resize(n_jobs);
+    for (int j = 0; j < n_jobs; j++)
+        {
+            leader[j] = j;
+            group_taps[j] = jobs[j].n_correlators;
+            for (int l = 0; l < j; l++)
+                {
+                    if (leader[l] == l and group_taps[l] + jobs[j].n_correlators <= max_taps
+                            and can_share_wipeoff(jobs[l], jobs[j]))
+                        {
+                            leader[j] = l;
+                            group_taps[l] += jobs[j].n_correlators;
+                            group_taps[j] = 0;
+                            break;
+                        }
+                }
+        }
+}
+}
+
+
+cpu_multicorrelator_batch::cpu_multicorrelator_batch()
+{
+    d_local_codes_resampled = nullptr;
+    d_partial_corr_out = nullptr;
+    d_n_correlators = 0;
+}
+
+
+cpu_multicorrelator_batch::~cpu_multicorrelator_batch()
+{
+    if(d_local_codes_resampled != nullptr)
+        {
+            cpu_multicorrelator_batch::free();
+        }
+}
+
+
+bool cpu_multicorrelator_batch::init(int n_correlators)
+{
+    // ALLOCATE MEMORY FOR INTERNAL vectors: one tile per tap
+    size_t size = tile_samples * sizeof(std::complex<float>);
+
+    d_local_codes_resampled = static_cast<std::complex<float>**>(volk_gnsssdr_malloc(n_correlators * sizeof(std::complex<float>*), volk_gnsssdr_get_alignment()));
+    for (int n = 0; n < n_correlators; n++)
+        {
+            d_local_codes_resampled[n] = static_cast<std::complex<float>*>(volk_gnsssdr_malloc(size, volk_gnsssdr_get_alignment()));
+        }
+    d_partial_corr_out = static_cast<std::complex<float>*>(volk_gnsssdr_malloc(n_correlators * sizeof(std::complex<float>), volk_gnsssdr_get_alignment()));
+    d_n_correlators = n_correlators;
+    return true;
+}
+
+
+bool cpu_multicorrelator_batch::Carrier_wipeoff_multicorrelator_resampler(const Correlator_Job* jobs, int n_jobs)
+{
+    if (n_jobs == 0)
+        {
+            return true;
+        }
+    unsigned long int first_sample = jobs[0].sample_stamp;
+    unsigned long int last_sample = jobs[0].sample_stamp + jobs[0].signal_length_samples;
+    d_phases.resize(n_jobs);
+    d_phase_incs.resize(n_jobs);
+    for (int j = 0; j < n_jobs; j++)
+        {
+            if (jobs[j].n_correlators > d_n_correlators)
+                {
+                    return false;
+                }
+            first_sample = std::min(first_sample, jobs[j].sample_stamp);
+            last_sample = std::max(last_sample, jobs[j].sample_stamp + jobs[j].signal_length_samples);
+            // Regenerate phase at each call in order to avoid numerical issues
+            d_phases[j] = lv_cmake(std::cos(jobs[j].rem_carrier_phase_in_rad), -std::sin(jobs[j].rem_carrier_phase_in_rad));
+            d_phase_incs[j] = std::exp(lv_32fc_t(0, - jobs[j].phase_step_rad));
+            std::fill_n(jobs[j].corr_out, jobs[j].n_correlators, std::complex<float>(0, 0));
+        }
+
+    group_jobs(jobs, n_jobs);
+
+    for (unsigned long int tile = first_sample; tile < last_sample; tile += tile_samples)
+        {
+            for (int j = 0; j < n_jobs; j++)
+                {
+                    if (d_leader[j] != j)
+                        {
+                            continue; // correlated with the group of its leader
+                        }
+                    if (d_group_taps[j] > jobs[j].n_correlators)
+                        {
+                            correlate_group(jobs, n_jobs, j, tile, tile + tile_samples);
+                            continue;
+                        }
+                    const Correlator_Job& job = jobs[j];
+                    unsigned long int begin = std::max(tile, job.sample_stamp);
+                    unsigned long int end = std::min(tile + tile_samples, job.sample_stamp + job.signal_length_samples);
+                    if (begin >= end)
+                        {
+                            continue;
+                        }
+                    int offset = static_cast<int>(begin - job.sample_stamp);
+                    int length = static_cast<int>(end - begin);
+                    // the code phase at the first sample of the tile
+                    float rem_code_phase_chips = static_cast<float>(static_cast<double>(job.rem_code_phase_chips)
+                            - static_cast<double>(offset) * static_cast<double>(job.code_phase_step_chips));
+                    volk_gnsssdr_32fc_xn_resampler_32fc_xn(d_local_codes_resampled,
+                            job.local_code_in,
+                            rem_code_phase_chips,
+                            job.code_phase_step_chips,
+                            job.shifts_chips,
+                            job.code_length_chips,
+                            job.n_correlators,
+                            length);
+                    volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn(d_partial_corr_out, job.sig_in + offset, d_phase_incs[j], &d_phases[j],
+                            (const lv_32fc_t**)d_local_codes_resampled, job.n_correlators, length);
+                    for (int n = 0; n < job.n_correlators; n++)
+                        {
+                            job.corr_out[n] += d_partial_corr_out[n];
+                        }
+                }
+        }
+    return true;
+}
+
+
+int cpu_multicorrelator_batch::tap_set_size(const Correlator_Job* jobs, int n_jobs)
+{
+    std::vector<int> leader;
+    std::vector<int> group_taps;
+    assign_groups(jobs, n_jobs, std::numeric_limits<int>::max(), leader, group_taps);
+    int n_correlators = 0;
+    for (int j = 0; j < n_jobs; j++)
+        {
+            n_correlators = std::max(n_correlators, std::max(group_taps[j], jobs[j].n_correlators));
+        }
+    return n_correlators;
+}
+
+
+void cpu_multicorrelator_batch::group_jobs(const Correlator_Job* jobs, int n_jobs)
+{
+    assign_groups(jobs, n_jobs, d_n_correlators, d_leader, d_group_taps);
+}
+
+
+void cpu_multicorrelator_batch::correlate_group(const Correlator_Job* jobs, int n_jobs, int leader,
+        unsigned long int tile_begin, unsigned long int tile_end)
+{
+    // the samples of the tile that all the jobs of the group correlate
+    unsigned long int begin = tile_begin;
+    unsigned long int end = tile_end;
+    for (int j = leader; j < n_jobs; j++)
+        {
+            if (d_leader[j] == leader)
+                {
+                    begin = std::max(begin, jobs[j].sample_stamp);
+                    end = std::min(end, jobs[j].sample_stamp + jobs[j].signal_length_samples);
+                }
+        }
+    for (int j = leader; j < n_jobs; j++)
+        {
+            if (d_leader[j] != leader)
+                {
+                    continue;
+                }
+            unsigned long int job_begin = std::max(tile_begin, jobs[j].sample_stamp);
+            unsigned long int job_end = std::min(tile_end, jobs[j].sample_stamp + jobs[j].signal_length_samples);
+            if (begin >= end)
+                {
+                    correlate_samples(jobs[j], job_begin, job_end);
+                    continue;
+                }
+            correlate_samples(jobs[j], job_begin, std::min(job_end, begin));
+            correlate_samples(jobs[j], std::max(job_begin, end), job_end);
+        }
+    if (begin >= end)
+        {
+            return;
+        }
+
+    // one wipeoff with the carrier of the leader, and the taps of all the jobs
+    const Correlator_Job& first = jobs[leader];
+    d_group_shifts.resize(d_group_taps[leader]);
+    int n_taps = 0;
+    for (int j = leader; j < n_jobs; j++)
+        {
+            if (d_leader[j] == leader)
+                {
+                    float chips = static_cast<float>(code_phase(jobs[j], begin));
+                    for (int n = 0; n < jobs[j].n_correlators; n++)
+                        {
+                            d_group_shifts[n_taps + n] = jobs[j].shifts_chips[n] + chips;
+                        }
+                    n_taps += jobs[j].n_correlators;
+                }
+        }
+    int length = static_cast<int>(end - begin);
+    volk_gnsssdr_32fc_xn_resampler_32fc_xn(d_local_codes_resampled,
+            first.local_code_in,
+            0.0,
+            first.code_phase_step_chips,
+            d_group_shifts.data(),
+            first.code_length_chips,
+            n_taps,
+            length);
+    double first_phase_rad = carrier_phase(first, begin);
+    lv_32fc_t phase = lv_cmake(static_cast<float>(std::cos(first_phase_rad)), static_cast<float>(-std::sin(first_phase_rad)));
+    lv_32fc_t phase_inc = std::exp(lv_32fc_t(0, - first.phase_step_rad));
+    volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn(d_partial_corr_out, first.sig_in + (begin - first.sample_stamp), phase_inc, &phase,
+            (const lv_32fc_t**)d_local_codes_resampled, n_taps, length);
+
+    // each job takes its taps back, with its own carrier phase at the middle of the samples
+    unsigned long int middle = begin + (end - begin) / 2;
+    n_taps = 0;
+    for (int j = leader; j < n_jobs; j++)
+        {
+            if (d_leader[j] == leader)
+                {
+                    double difference_rad = carrier_phase(jobs[j], middle) - carrier_phase(first, middle);
+                    std::complex<float> rotation(static_cast<float>(std::cos(difference_rad)), static_cast<float>(-std::sin(difference_rad)));
+                    for (int n = 0; n < jobs[j].n_correlators; n++)
+                        {
+                            jobs[j].corr_out[n] += d_partial_corr_out[n_taps + n] * rotation;
+                        }
+                    n_taps += jobs[j].n_correlators;
+                }
+        }
+}
+
+
+void cpu_multicorrelator_batch::correlate_samples(const Correlator_Job& job, unsigned long int begin, unsigned long int end)
+{
+    if (begin >= end)
+        {
+            return;
+        }
+    int length = static_cast<int>(end - begin);
+    volk_gnsssdr_32fc_xn_resampler_32fc_xn(d_local_codes_resampled,
+            job.local_code_in,
+            static_cast<float>(-code_phase(job, begin)),
+            job.code_phase_step_chips,
+            job.shifts_chips,
+            job.code_length_chips,
+            job.n_correlators,
+            length);
+    double phase_rad = carrier_phase(job, begin);
+    lv_32fc_t phase = lv_cmake(static_cast<float>(std::cos(phase_rad)), static_cast<float>(-std::sin(phase_rad)));
+    lv_32fc_t phase_inc = std::exp(lv_32fc_t(0, - job.phase_step_rad));
+    volk_gnsssdr_32fc_x2_rotator_dot_prod_32fc_xn(d_partial_corr_out, job.sig_in + (begin - job.sample_stamp), phase_inc, &phase,
+            (const lv_32fc_t**)d_local_codes_resampled, job.n_correlators, length);
+    for (int n = 0; n < job.n_correlators; n++)
+        {
+            job.corr_out[n] += d_partial_corr_out[n];
+        }
+}
+
+
+bool cpu_multicorrelator_batch::free()
+{
+    // Free memory
+    if (d_local_codes_resampled != nullptr)
+        {
+            for (int n = 0; n < d_n_correlators; n++)
+                {
+                    volk_gnsssdr_free(d_local_codes_resampled[n]);
+                }
+            volk_gnsssdr_free(d_local_codes_resampled);
+            volk_gnsssdr_free(d_partial_corr_out);
+            d_local_codes_resampled = nullptr;
+            d_partial_corr_out = nullptr;
+            d_n_correlators = 0;
+        }
+    return true;
+}
+
+
+void Correlator_Batcher::add_channels(int count)
+{
+    boost::mutex::scoped_lock lock(batcher_mutex);
+    batcher_channels += count;
+    // a batch may now have all the channels it waits for
+    batcher_condition.notify_all();
+}
+
+
+bool Correlator_Batcher::correlate(const Correlator_Job& job, unsigned int wait_us)
+{
+    boost::mutex::scoped_lock lock(batcher_mutex);
+    std::shared_ptr<Correlator_Batch> batch = open_batch;
+    if (batch && batch->jobs.size() < max_batch_jobs)
+        {
+            batch->jobs.push_back(job);
+            batcher_condition.notify_all();
+            while (!batch->done)
+                {
+                    batcher_condition.wait(lock);
+                }
+            return batch->ok;
+        }
+
+    batch = std::make_shared<Correlator_Batch>();
+    batch->jobs.reserve(max_batch_jobs);
+    batch->jobs.push_back(job);
+    batch->done = false;
+    batch->ok = false;
+    open_batch = batch;
+    boost::system_time deadline = boost::get_system_time() + boost::posix_time::microseconds(wait_us);
+    while (static_cast<int>(batch->jobs.size()) < std::min(batcher_channels, static_cast<int>(max_batch_jobs)))
+        {
+            if (!batcher_condition.timed_wait(lock, deadline))
+                {
+                    break;
+                }
+        }
+    if (open_batch == batch)
+        {
+            open_batch.reset();
+        }
+    std::unique_ptr<cpu_multicorrelator_batch> correlator;
+    if (!idle_correlators.empty())
+        {
+            correlator = std::move(idle_correlators.back());
+            idle_correlators.pop_back();
+        }
+    lock.unlock();
+
+    int n_correlators = cpu_multicorrelator_batch::tap_set_size(&batch->jobs[0], batch->jobs.size());
+    if (!correlator)
+        {
+            correlator.reset(new cpu_multicorrelator_batch());
+        }
+    if (correlator->n_correlators() < n_correlators)
+        {
+            correlator->free();
+            correlator->init(n_correlators);
+        }
+    bool ok = correlator->Carrier_wipeoff_multicorrelator_resampler(&batch->jobs[0], batch->jobs.size());
+
+    lock.lock();
+    idle_correlators.push_back(std::move(correlator));
+    batch->ok = ok;
+    batch->done = true;
+    batcher_condition.notify_all();
+    return ok;
+}
@@ -0,0 +1,147 @@
+/*!
+ * \file cpu_multicorrelator_batch.h
+ * \brief CPU multiTAP correlator that processes the correlations of several
+ * tracking channels in a single pass over the input
+ * \authors <ul>
+ *          <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * Class that implements a cache-blocked multiTAP correlator for a batch of
+ * tracking channels, and the batcher that gathers their correlations
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_CPU_MULTICORRELATOR_BATCH_H_
+#define GNSS_SDR_CPU_MULTICORRELATOR_BATCH_H_
+
+#include <complex>
+#include <vector>
+
+/*!
+ * \brief The correlation of one code period of a tracking channel: the
+ * input samples, the carrier and code NCO commands and the taps, as would
+ * be passed to cpu_multicorrelator
+ */
+struct Correlator_Job
+{
+    const std::complex<float>* sig_in;
+    unsigned long int sample_stamp; //!< Sample counter of sig_in[0]
+    int signal_length_samples;
+    float rem_carrier_phase_in_rad;
+    float phase_step_rad;
+    float rem_code_phase_chips;
+    float code_phase_step_chips;
+    const std::complex<float>* local_code_in;
+    int code_length_chips;
+    float* shifts_chips;
+    int n_correlators;
+    std::complex<float>* corr_out; //!< n_correlators outputs
+    unsigned int prn_group;        //!< PRN of the channel to share the carrier wipeoff with the others of the same PRN, or 0
+    float group_phase_step_rad;    //!< Largest difference of phase_step_rad with the channels it shares the wipeoff with
+};
+
+
+/*!
+ * \brief Class that implements carrier wipe-off and correlators for a batch
+ * of tracking channels.
+ *
+ * The samples are processed in tiles that fit in the L1 cache, ordered by
+ * their sample stamp: each tile is read from memory once and then
+ * correlated by all the channels whose code period overlaps it. All the
+ * channels read the same output buffer of the signal conditioner, so with
+ * N channels the input is streamed from memory once instead of N times.
+ * Within a tile, the code is resampled for all the taps and the carrier is
+ * wiped off once for all of them with the same VOLK_GNSSSDR kernels as
+ * cpu_multicorrelator. The carrier phase of each channel is carried on from
+ * tile to tile.
+ *
+ * The jobs of the same prn_group whose carrier Doppler is within their
+ * group_phase_step_rad of each other (e.g. the authentic and the auxiliary
+ * peaks of one PRN that APT tracks) form a group. Where their code periods
+ * overlap, the carrier of a group is wiped off once, with the NCO of its
+ * first job, and a single resampler call makes the taps of all its jobs,
+ * each one shifted by the code phase of its job. The outputs of each job
+ * are then rotated by its carrier phase difference with the first job at
+ * the middle of the samples, so each channel keeps its own loops. The rest
+ * of the samples of each job are correlated on their own.
+ */
+class cpu_multicorrelator_batch
+{
+public:
+    cpu_multicorrelator_batch();
+    ~cpu_multicorrelator_batch();
+    bool init(int n_correlators);
+    bool Carrier_wipeoff_multicorrelator_resampler(const Correlator_Job* jobs, int n_jobs);
+    bool free();
+    int n_correlators() const { return d_n_correlators; }
+
+    /*!
+     * \brief Taps that init() needs for the jobs, with those of the PRN groups together
+     */
+    static int tap_set_size(const Correlator_Job* jobs, int n_jobs);
+
+private:
+    void group_jobs(const Correlator_Job* jobs, int n_jobs);
+    void correlate_group(const Correlator_Job* jobs, int n_jobs, int leader, unsigned long int tile_begin, unsigned long int tile_end);
+    void correlate_samples(const Correlator_Job& job, unsigned long int begin, unsigned long int end);
+
+    std::complex<float>** d_local_codes_resampled; // one tile per tap
+    std::complex<float>* d_partial_corr_out;
+    std::vector<std::complex<float> > d_phases;
+    std::vector<std::complex<float> > d_phase_incs;
+    std::vector<int> d_leader;   // first job of the group of each job, itself if it is on its own
+    std::vector<int> d_group_taps; // taps of the group that each job leads
+    std::vector<float> d_group_shifts;
+    int d_n_correlators;
+};
+
+
+/*!
+ * \brief Gathers the correlations of the tracking channels into batches
+ * for cpu_multicorrelator_batch.
+ *
+ * The first channel to submit a job opens a batch and waits for the other
+ * channels to join it, or for wait_us microseconds, whichever comes first.
+ * Then it correlates the whole batch while the others wait for their
+ * outputs. The channels that run ahead of the others pay the wait, so the
+ * channels converge to submitting their code periods together. All the
+ * functions are thread-safe.
+ */
+class Correlator_Batcher
+{
+public:
+    /*!
+     * \brief Changes by count the number of channels that submit a job every code period
+     */
+    static void add_channels(int count);
+
+    /*!
+     * \brief Correlates job in the next batch. Returns when job.corr_out holds the outputs
+     */
+    static bool correlate(const Correlator_Job& job, unsigned int wait_us);
+};
+
+#endif /* GNSS_SDR_CPU_MULTICORRELATOR_BATCH_H_ */
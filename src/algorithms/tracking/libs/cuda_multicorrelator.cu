@@ -35,7 +35,14 @@
 #include "cuda_multicorrelator.h"
 
 #include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
 // For the CUDA runtime routines (prefixed with "cuda_")
 #include <cuda_runtime.h>
 
@@ -135,6 +142,61 @@ __global__ void Doppler_wippe_scalarProdGPUCPXxN_shifts_chips(
     }
 }
 
+__global__ void Doppler_wippe_scalarProdGPUCPXxN_shifts_chips_batch(
+    GPU_Complex *d_corr_out,
+    GPU_Complex *d_sig_in,
+    GPU_Complex *d_local_codes_in,
+    float *d_shifts_chips,
+    GPU_Correlator_Job *d_jobs
+)
+{
+    // one thread block per tap (blockIdx.x) and job (blockIdx.y), with ACCUM_N threads
+    __shared__ GPU_Complex accumResult[ACCUM_N];
+
+    const GPU_Correlator_Job job = d_jobs[blockIdx.y];
+    const int vec = blockIdx.x;
+    if (vec >= job.n_correlators)
+    {
+        // the whole block leaves, so the reduction below does not deadlock
+        return;
+    }
+    GPU_Complex *sig_in = d_sig_in + job.sig_offset;
+    GPU_Complex *local_code_in = d_local_codes_in + job.code_offset;
+    const float code_length_chips = __int2float_rn(job.code_length_chips);
+    const float shift_chips = d_shifts_chips[job.taps_offset + vec];
+
+    GPU_Complex sum = GPU_Complex(0,0);
+    float sin;
+    float cos;
+    for (int pos = threadIdx.x; pos < job.signal_length_samples; pos += ACCUM_N)
+    {
+        // carrier wipe-off and code resampling on the fly, no intermediate vectors
+        __sincosf(job.rem_carrier_phase_in_rad + pos * job.phase_step_rad, &sin, &cos);
+        float local_code_chip_index = fmodf(job.code_phase_step_chips * __int2float_rd(pos) + shift_chips - job.rem_code_phase_chips, code_length_chips);
+        // the shifts can be negative
+        if (local_code_chip_index < 0.0) local_code_chip_index += code_length_chips;
+        int chip = min(__float2int_rd(local_code_chip_index), job.code_length_chips - 1);
+        GPU_Complex sample = sig_in[pos];
+        sum.multiply_acc(sample * GPU_Complex(cos,-sin), local_code_in[chip]);
+    }
+    accumResult[threadIdx.x] = sum;
+
+    // tree-like reduction of the accumulators, ACCUM_N is a power of two
+    for (int stride = ACCUM_N / 2; stride > 0; stride >>= 1)
+    {
+        __syncthreads();
+        if (threadIdx.x < stride)
+        {
+            accumResult[threadIdx.x] += accumResult[stride + threadIdx.x];
+        }
+    }
+
+    if (threadIdx.x == 0)
+    {
+        d_corr_out[job.taps_offset + vec] = accumResult[0];
+    }
+}
+
 bool cuda_multicorrelator::init_cuda_integrated_resampler(
 		int signal_length_samples,
 		int code_length_chips,
@@ -289,10 +351,23 @@ bool cuda_multicorrelator::set_input_output_vectors(
 	{
 		printf("cuda cudaHostGetDevicePointer error \r\n");
 	}
+	d_sig_in_staging = d_sig_in;
 	return true;
 
 }
 
+
+bool cuda_multicorrelator::set_input_vector(const std::complex<float>* sig_in, int n_samples)
+{
+    GPU_Complex* mapped = NULL;
+    if (sig_in != NULL)
+    {
+        mapped = cuda_mapped_device_pointer(sig_in, n_samples * sizeof(GPU_Complex));
+    }
+    d_sig_in = (mapped != NULL) ? mapped : d_sig_in_staging;
+    return mapped != NULL;
+}
+
 #define gpuErrchk(ans) { gpuAssert((ans), __FILE__, __LINE__); }
 inline void gpuAssert(cudaError_t code, const char *file, int line, bool abort=true)
 {
@@ -357,6 +432,7 @@ cuda_multicorrelator::cuda_multicorrelator()
 	d_shifts_samples=NULL;
 	d_shifts_chips=NULL;
 	d_corr_out=NULL;
+	d_sig_in_staging=NULL;
 	threadsPerBlock=0;
 	blocksPerGrid=0;
 	d_code_length_chips=0;
@@ -364,12 +440,10 @@ cuda_multicorrelator::cuda_multicorrelator()
 
 bool cuda_multicorrelator::free_cuda()
 {
-	// Free device global memory
-	if (d_sig_in!=NULL) cudaFree(d_sig_in);
+	// Free device global memory, d_sig_in and d_corr_out are mapped host memory
 	if (d_nco_in!=NULL) cudaFree(d_nco_in);
 	if (d_sig_doppler_wiped!=NULL) cudaFree(d_sig_doppler_wiped);
 	if (d_local_codes_in!=NULL) cudaFree(d_local_codes_in);
-	if (d_corr_out!=NULL) cudaFree(d_corr_out);
 	if (d_shifts_samples!=NULL) cudaFree(d_shifts_samples);
 	if (d_shifts_chips!=NULL) cudaFree(d_shifts_chips);
     // Reset the device and exit
@@ -382,3 +456,479 @@ bool cuda_multicorrelator::free_cuda()
 	return true;
 }
 
+
+
+namespace
+{
+// Most receivers do not have more channels
+const unsigned int max_batch_jobs = 64;
+
+struct Cuda_Correlator_Batch
+{
+    std::vector<Correlator_Job> jobs;
+    bool done;
+    bool ok;
+};
+
+std::mutex cuda_batcher_mutex;
+std::condition_variable cuda_batcher_condition;
+int cuda_batcher_channels = 0;
+std::shared_ptr<Cuda_Correlator_Batch> cuda_open_batch;
+// the correlators of the batches that are not running
+std::vector<std::unique_ptr<cuda_multicorrelator_batch> > cuda_idle_correlators;
+
+bool cuda_check(cudaError_t code, const char *what)
+{
+    if (code != cudaSuccess)
+    {
+        fprintf(stderr, "cuda_multicorrelator_batch: %s: %s\n", what, cudaGetErrorString(code));
+        return false;
+    }
+    return true;
+}
+
+bool job_stamp_less(const Correlator_Job* a, const Correlator_Job* b)
+{
+    return a->sample_stamp < b->sample_stamp;
+}
+
+bool cuda_zero_copy_batches = false;
+
+// a pinned host buffer and the device buffer that the kernel uses: the
+// mapping of the host one in zero copy mode, or a buffer of its own
+template <typename Host, typename Device>
+bool cuda_alloc_staging(Host** host, Device** device, size_t bytes, bool zero_copy)
+{
+    if (zero_copy)
+    {
+        return cuda_check(cudaHostAlloc((void**)host, bytes, cudaHostAllocMapped), "cudaHostAlloc")
+                && cuda_check(cudaHostGetDevicePointer((void**)device, (void*)*host, 0), "cudaHostGetDevicePointer");
+    }
+    return cuda_check(cudaHostAlloc((void**)host, bytes, cudaHostAllocDefault), "cudaHostAlloc")
+            && cuda_check(cudaMalloc((void**)device, bytes), "cudaMalloc");
+}
+
+template <typename Host, typename Device>
+void cuda_free_staging(Host** host, Device** device, bool zero_copy)
+{
+    if (*host != NULL) cudaFreeHost(*host);
+    if (*device != NULL && !zero_copy) cudaFree(*device);
+    *host = NULL;
+    *device = NULL;
+}
+
+struct Cuda_Mapped_Range
+{
+    char* base;
+    size_t bytes;
+    char* device_base;
+    int registrations;
+};
+
+std::mutex cuda_mapped_ranges_mutex;
+std::vector<Cuda_Mapped_Range> cuda_mapped_ranges;
+}
+
+
+bool cuda_zero_copy_device()
+{
+    int device;
+    cudaDeviceProp properties;
+    if (cudaGetDevice(&device) != cudaSuccess || cudaGetDeviceProperties(&properties, device) != cudaSuccess)
+    {
+        return false;
+    }
+    return properties.integrated && properties.canMapHostMemory;
+}
+
+
+bool cuda_map_host_range(void* base, size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(cuda_mapped_ranges_mutex);
+    for (unsigned int i = 0; i < cuda_mapped_ranges.size(); i++)
+    {
+        if (cuda_mapped_ranges[i].base == base && cuda_mapped_ranges[i].bytes == bytes)
+        {
+            cuda_mapped_ranges[i].registrations++;
+            return true;
+        }
+    }
+    if (!cuda_check(cudaHostRegister(base, bytes, cudaHostRegisterMapped), "cudaHostRegister"))
+    {
+        return false;
+    }
+    void* device_base = NULL;
+    if (!cuda_check(cudaHostGetDevicePointer(&device_base, base, 0), "cudaHostGetDevicePointer"))
+    {
+        cudaHostUnregister(base);
+        return false;
+    }
+    Cuda_Mapped_Range range = {static_cast<char*>(base), bytes, static_cast<char*>(device_base), 1};
+    cuda_mapped_ranges.push_back(range);
+    return true;
+}
+
+
+void cuda_unmap_host_range(void* base)
+{
+    std::lock_guard<std::mutex> lock(cuda_mapped_ranges_mutex);
+    for (unsigned int i = 0; i < cuda_mapped_ranges.size(); i++)
+    {
+        if (cuda_mapped_ranges[i].base == base)
+        {
+            if (--cuda_mapped_ranges[i].registrations == 0)
+            {
+                cudaHostUnregister(base);
+                cuda_mapped_ranges.erase(cuda_mapped_ranges.begin() + i);
+            }
+            return;
+        }
+    }
+}
+
+
+GPU_Complex* cuda_mapped_device_pointer(const void* host, size_t bytes, const void** range_base)
+{
+    const char* begin = static_cast<const char*>(host);
+    std::lock_guard<std::mutex> lock(cuda_mapped_ranges_mutex);
+    for (unsigned int i = 0; i < cuda_mapped_ranges.size(); i++)
+    {
+        const Cuda_Mapped_Range& range = cuda_mapped_ranges[i];
+        if (begin >= range.base && begin + bytes <= range.base + range.bytes)
+        {
+            if (range_base != NULL)
+            {
+                *range_base = range.base;
+            }
+            return reinterpret_cast<GPU_Complex*>(range.device_base + (begin - range.base));
+        }
+    }
+    return NULL;
+}
+
+
+cuda_multicorrelator_batch::cuda_multicorrelator_batch()
+{
+	h_sig_in = NULL;
+	h_local_codes_in = NULL;
+	h_shifts_chips = NULL;
+	h_jobs = NULL;
+	h_corr_out = NULL;
+	d_sig_in = NULL;
+	d_local_codes_in = NULL;
+	d_shifts_chips = NULL;
+	d_jobs = NULL;
+	d_corr_out = NULL;
+	d_max_samples = 0;
+	d_max_chips = 0;
+	d_max_taps = 0;
+	d_max_jobs = 0;
+	d_device = 0;
+	d_stream = 0;
+	d_initialized = false;
+	d_zero_copy = false;
+}
+
+
+cuda_multicorrelator_batch::~cuda_multicorrelator_batch()
+{
+	free_cuda();
+}
+
+
+bool cuda_multicorrelator_batch::init_cuda()
+{
+    // all the batches run on the device with the most multiprocessors
+    int num_devices = 0;
+    if (!cuda_check(cudaGetDeviceCount(&num_devices), "cudaGetDeviceCount") || num_devices == 0)
+    {
+        return false;
+    }
+    int max_multiprocessors = 0;
+    for (int device = 0; device < num_devices; device++)
+    {
+        cudaDeviceProp properties;
+        cudaGetDeviceProperties(&properties, device);
+        if (max_multiprocessors < properties.multiProcessorCount)
+        {
+            max_multiprocessors = properties.multiProcessorCount;
+            d_device = device;
+        }
+    }
+    int previous_device;
+    cudaGetDevice(&previous_device);
+    cudaSetDevice(d_device);
+    d_zero_copy = cuda_zero_copy_batches && cuda_zero_copy_device();
+    bool ok = cuda_check(cudaStreamCreate(&d_stream), "cudaStreamCreate");
+    cudaSetDevice(previous_device);
+    d_initialized = ok;
+    return ok;
+}
+
+
+bool cuda_multicorrelator_batch::reserve(int n_samples, int n_chips, int n_taps, int n_jobs)
+{
+    bool ok = true;
+    if (n_samples > d_max_samples)
+    {
+        cuda_free_staging(&h_sig_in, &d_sig_in, d_zero_copy);
+        ok = ok && cuda_alloc_staging(&h_sig_in, &d_sig_in, n_samples * sizeof(GPU_Complex), d_zero_copy);
+        d_max_samples = n_samples;
+    }
+    if (n_chips > d_max_chips)
+    {
+        cuda_free_staging(&h_local_codes_in, &d_local_codes_in, d_zero_copy);
+        ok = ok && cuda_alloc_staging(&h_local_codes_in, &d_local_codes_in, n_chips * sizeof(GPU_Complex), d_zero_copy);
+        d_max_chips = n_chips;
+    }
+    if (n_taps > d_max_taps)
+    {
+        cuda_free_staging(&h_shifts_chips, &d_shifts_chips, d_zero_copy);
+        cuda_free_staging(&h_corr_out, &d_corr_out, d_zero_copy);
+        ok = ok && cuda_alloc_staging(&h_shifts_chips, &d_shifts_chips, n_taps * sizeof(float), d_zero_copy);
+        ok = ok && cuda_alloc_staging(&h_corr_out, &d_corr_out, n_taps * sizeof(GPU_Complex), d_zero_copy);
+        d_max_taps = n_taps;
+    }
+    if (n_jobs > d_max_jobs)
+    {
+        cuda_free_staging(&h_jobs, &d_jobs, d_zero_copy);
+        ok = ok && cuda_alloc_staging(&h_jobs, &d_jobs, n_jobs * sizeof(GPU_Correlator_Job), d_zero_copy);
+        d_max_jobs = n_jobs;
+    }
+    if (!ok)
+    {
+        // start over on the next batch
+        free_cuda();
+        init_cuda();
+    }
+    return ok;
+}
+
+
+bool cuda_multicorrelator_batch::Carrier_wipeoff_multicorrelator_resampler_cuda(const Correlator_Job* jobs, int n_jobs)
+{
+    if (n_jobs == 0)
+    {
+        return true;
+    }
+    if (!d_initialized && !init_cuda())
+    {
+        return false;
+    }
+    int previous_device;
+    cudaGetDevice(&previous_device);
+    cudaSetDevice(d_device);
+
+    int n_samples = 0;
+    int n_chips = 0;
+    int n_taps = 0;
+    int max_correlators = 0;
+    std::vector<const Correlator_Job*> sorted_jobs(n_jobs);
+    for (int j = 0; j < n_jobs; j++)
+    {
+        n_samples += jobs[j].signal_length_samples;
+        n_chips += jobs[j].code_length_chips;
+        n_taps += jobs[j].n_correlators;
+        max_correlators = std::max(max_correlators, jobs[j].n_correlators);
+        sorted_jobs[j] = &jobs[j];
+    }
+    if (!reserve(n_samples, n_chips, n_taps, n_jobs))
+    {
+        cudaSetDevice(previous_device);
+        return false;
+    }
+
+    // in zero copy mode, the kernel reads the samples in place if all of them are in one mapped range
+    GPU_Complex* sig_in = d_sig_in;
+    bool in_place = d_zero_copy;
+    const void* range_base = NULL;
+    for (int j = 0; in_place && j < n_jobs; j++)
+    {
+        const void* job_range_base = NULL;
+        in_place = cuda_mapped_device_pointer(jobs[j].sig_in, jobs[j].signal_length_samples * sizeof(GPU_Complex), &job_range_base) != NULL
+                && (j == 0 || job_range_base == range_base);
+        range_base = job_range_base;
+    }
+    if (in_place)
+    {
+        sig_in = cuda_mapped_device_pointer(range_base, sizeof(GPU_Complex));
+        for (int j = 0; j < n_jobs; j++)
+        {
+            h_jobs[j].sig_offset = static_cast<int>(jobs[j].sig_in - static_cast<const std::complex<float>*>(range_base));
+        }
+        sorted_jobs.clear();
+    }
+
+    // otherwise, pack the union of the code periods: the overlapping samples are copied once
+    std::sort(sorted_jobs.begin(), sorted_jobs.end(), job_stamp_less);
+    int packed_samples = 0;
+    int segment_base = 0;
+    unsigned long int segment_begin = 0;
+    unsigned long int segment_end = 0;
+    for (int j = 0; j < static_cast<int>(sorted_jobs.size()); j++)
+    {
+        const Correlator_Job& job = *sorted_jobs[j];
+        unsigned long int job_end = job.sample_stamp + job.signal_length_samples;
+        if (j == 0 || job.sample_stamp >= segment_end)
+        {
+            segment_base = packed_samples;
+            segment_begin = job.sample_stamp;
+            segment_end = job.sample_stamp;
+        }
+        if (job_end > segment_end)
+        {
+            int n = static_cast<int>(job_end - segment_end);
+            memcpy(h_sig_in + packed_samples, job.sig_in + (segment_end - job.sample_stamp), n * sizeof(GPU_Complex));
+            packed_samples += n;
+            segment_end = job_end;
+        }
+        h_jobs[sorted_jobs[j] - jobs].sig_offset = segment_base + static_cast<int>(job.sample_stamp - segment_begin);
+    }
+
+    int code_offset = 0;
+    int taps_offset = 0;
+    for (int j = 0; j < n_jobs; j++)
+    {
+        const Correlator_Job& job = jobs[j];
+        GPU_Correlator_Job& gpu_job = h_jobs[j];
+        gpu_job.signal_length_samples = job.signal_length_samples;
+        gpu_job.rem_carrier_phase_in_rad = job.rem_carrier_phase_in_rad;
+        gpu_job.phase_step_rad = job.phase_step_rad;
+        gpu_job.rem_code_phase_chips = job.rem_code_phase_chips;
+        gpu_job.code_phase_step_chips = job.code_phase_step_chips;
+        gpu_job.code_offset = code_offset;
+        gpu_job.code_length_chips = job.code_length_chips;
+        gpu_job.taps_offset = taps_offset;
+        gpu_job.n_correlators = job.n_correlators;
+        memcpy(h_local_codes_in + code_offset, job.local_code_in, job.code_length_chips * sizeof(GPU_Complex));
+        memcpy(h_shifts_chips + taps_offset, job.shifts_chips, job.n_correlators * sizeof(float));
+        code_offset += job.code_length_chips;
+        taps_offset += job.n_correlators;
+    }
+
+    // upload the batch, correlate all the jobs in one launch and download all the outputs
+    if (!d_zero_copy)
+    {
+        cudaMemcpyAsync(d_sig_in, h_sig_in, packed_samples * sizeof(GPU_Complex), cudaMemcpyHostToDevice, d_stream);
+        cudaMemcpyAsync(d_local_codes_in, h_local_codes_in, code_offset * sizeof(GPU_Complex), cudaMemcpyHostToDevice, d_stream);
+        cudaMemcpyAsync(d_shifts_chips, h_shifts_chips, taps_offset * sizeof(float), cudaMemcpyHostToDevice, d_stream);
+        cudaMemcpyAsync(d_jobs, h_jobs, n_jobs * sizeof(GPU_Correlator_Job), cudaMemcpyHostToDevice, d_stream);
+    }
+
+    dim3 blocks(max_correlators, n_jobs);
+    Doppler_wippe_scalarProdGPUCPXxN_shifts_chips_batch<<<blocks, ACCUM_N, 0, d_stream>>>(
+            d_corr_out,
+            sig_in,
+            d_local_codes_in,
+            d_shifts_chips,
+            d_jobs);
+    bool ok = cuda_check(cudaPeekAtLastError(), "kernel launch");
+
+    if (!d_zero_copy)
+    {
+        cudaMemcpyAsync(h_corr_out, d_corr_out, taps_offset * sizeof(GPU_Complex), cudaMemcpyDeviceToHost, d_stream);
+    }
+    ok = cuda_check(cudaStreamSynchronize(d_stream), "cudaStreamSynchronize") && ok;
+    cudaSetDevice(previous_device);
+    if (!ok)
+    {
+        return false;
+    }
+    for (int j = 0; j < n_jobs; j++)
+    {
+        std::copy(h_corr_out + h_jobs[j].taps_offset, h_corr_out + h_jobs[j].taps_offset + jobs[j].n_correlators, jobs[j].corr_out);
+    }
+    return true;
+}
+
+
+bool cuda_multicorrelator_batch::free_cuda()
+{
+	cuda_free_staging(&h_sig_in, &d_sig_in, d_zero_copy);
+	cuda_free_staging(&h_local_codes_in, &d_local_codes_in, d_zero_copy);
+	cuda_free_staging(&h_shifts_chips, &d_shifts_chips, d_zero_copy);
+	cuda_free_staging(&h_jobs, &d_jobs, d_zero_copy);
+	cuda_free_staging(&h_corr_out, &d_corr_out, d_zero_copy);
+	if (d_initialized) cudaStreamDestroy(d_stream);
+	d_max_samples = 0;
+	d_max_chips = 0;
+	d_max_taps = 0;
+	d_max_jobs = 0;
+	d_initialized = false;
+	// no cudaDeviceReset here: the device is shared with the other channels
+	return true;
+}
+
+
+void Cuda_Correlator_Batcher::set_zero_copy(bool zero_copy)
+{
+    std::unique_lock<std::mutex> lock(cuda_batcher_mutex);
+    cuda_zero_copy_batches = zero_copy;
+    // the idle correlators were made for the previous mode
+    cuda_idle_correlators.clear();
+}
+
+
+void Cuda_Correlator_Batcher::add_channels(int count)
+{
+    std::unique_lock<std::mutex> lock(cuda_batcher_mutex);
+    cuda_batcher_channels += count;
+    // a batch may now have all the channels it waits for
+    cuda_batcher_condition.notify_all();
+}
+
+
+bool Cuda_Correlator_Batcher::correlate(const Correlator_Job& job, unsigned int wait_us)
+{
+    std::unique_lock<std::mutex> lock(cuda_batcher_mutex);
+    std::shared_ptr<Cuda_Correlator_Batch> batch = cuda_open_batch;
+    if (batch && batch->jobs.size() < max_batch_jobs)
+    {
+        batch->jobs.push_back(job);
+        cuda_batcher_condition.notify_all();
+        while (!batch->done)
+        {
+            cuda_batcher_condition.wait(lock);
+        }
+        return batch->ok;
+    }
+
+    batch = std::make_shared<Cuda_Correlator_Batch>();
+    batch->jobs.reserve(max_batch_jobs);
+    batch->jobs.push_back(job);
+    batch->done = false;
+    batch->ok = false;
+    cuda_open_batch = batch;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(wait_us);
+    while (static_cast<int>(batch->jobs.size()) < std::min(cuda_batcher_channels, static_cast<int>(max_batch_jobs)))
+    {
+        if (cuda_batcher_condition.wait_until(lock, deadline) == std::cv_status::timeout)
+        {
+            break;
+        }
+    }
+    if (cuda_open_batch == batch)
+    {
+        cuda_open_batch.reset();
+    }
+    std::unique_ptr<cuda_multicorrelator_batch> correlator;
+    if (!cuda_idle_correlators.empty())
+    {
+        correlator = std::move(cuda_idle_correlators.back());
+        cuda_idle_correlators.pop_back();
+    }
+    lock.unlock();
+
+    if (!correlator)
+    {
+        correlator.reset(new cuda_multicorrelator_batch());
+    }
+    bool ok = correlator->Carrier_wipeoff_multicorrelator_resampler_cuda(&batch->jobs[0], batch->jobs.size());
+
+    lock.lock();
+    cuda_idle_correlators.push_back(std::move(correlator));
+    batch->ok = ok;
+    batch->done = true;
+    cuda_batcher_condition.notify_all();
+    return ok;
+}
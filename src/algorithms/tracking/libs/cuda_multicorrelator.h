@@ -47,6 +47,7 @@
 #include <complex>
 #include <cuda.h>
 #include <cuda_runtime.h>
+#include "cpu_multicorrelator_batch.h"
 
 // GPU new internal data types for complex numbers
 
@@ -109,6 +110,31 @@ struct GPU_Complex_Short
 };
 
 
+/*!
+ * \brief true if the current device shares the memory of the host (an
+ * integrated GPU, as those of the embedded boards) and can map it, so
+ * that the kernels can read and write host buffers in place
+ */
+bool cuda_zero_copy_device();
+
+/*!
+ * \brief Registers [base, base + bytes) as host memory mapped for the
+ * device, e.g. a GNU Radio buffer, so that the kernels read the samples
+ * where the block in front wrote them. The registrations of a range are
+ * counted. false if the device cannot map it.
+ */
+bool cuda_map_host_range(void* base, size_t bytes);
+
+void cuda_unmap_host_range(void* base); //!< Undoes one cuda_map_host_range(base, ...)
+
+/*!
+ * \brief Device address of [host, host + bytes) if it lies in a range of
+ * cuda_map_host_range(), or NULL. range_base, if not NULL, gets the base of
+ * that range.
+ */
+GPU_Complex* cuda_mapped_device_pointer(const void* host, size_t bytes, const void** range_base = NULL);
+
+
 /*!
  * \brief Class that implements carrier wipe-off and correlators using NVIDIA CUDA GPU accelerators.
  */
@@ -132,6 +158,13 @@ public:
             std::complex<float>* sig_in
     );
 
+    /*!
+     * \brief Reads the next n_samples in place from sig_in if it lies in a
+     * range of cuda_map_host_range(), and returns true. Otherwise, or with a
+     * NULL sig_in, they are read from the sig_in of set_input_output_vectors().
+     */
+    bool set_input_vector(const std::complex<float>* sig_in, int n_samples);
+
     bool free_cuda();
     bool Carrier_wipeoff_multicorrelator_resampler_cuda(
             float rem_carrier_phase_in_rad,
@@ -148,6 +181,7 @@ private:
     GPU_Complex *d_sig_doppler_wiped;
     GPU_Complex *d_local_codes_in;
     GPU_Complex *d_corr_out;
+    GPU_Complex *d_sig_in_staging; // the sig_in of set_input_output_vectors
 
     //
     std::complex<float> *d_sig_in_cpu;
@@ -167,4 +201,110 @@ private:
 };
 
 
+/*!
+ * \brief Position of one Correlator_Job in the device buffers of cuda_multicorrelator_batch
+ */
+struct GPU_Correlator_Job
+{
+    int sig_offset;  // first sample in the packed input
+    int signal_length_samples;
+    float rem_carrier_phase_in_rad;
+    float phase_step_rad;
+    float rem_code_phase_chips;
+    float code_phase_step_chips;
+    int code_offset; // first chip in the packed local codes
+    int code_length_chips;
+    int taps_offset; // first tap in the packed shifts and outputs
+    int n_correlators;
+};
+
+
+/*!
+ * \brief Class that implements carrier wipe-off and correlators for a batch
+ * of tracking channels in one NVIDIA CUDA kernel launch.
+ *
+ * The channels read the same output buffer of the signal conditioner, so
+ * the union of their code periods is packed once into pinned host memory
+ * and uploaded with a single asynchronous copy, together with the NCO
+ * commands, the local codes and the taps of all the jobs. Then one kernel
+ * correlates every tap of every job, wiping off the carrier and resampling
+ * the code on the fly, and the outputs of the whole batch are downloaded
+ * with a single copy. The stream is synchronized once per batch, and the
+ * NCOs and the loop filters stay on the host.
+ *
+ * In zero copy mode (Cuda_Correlator_Batcher::set_zero_copy), on a device
+ * that shares the memory of the host, there are no copies: the staging
+ * buffers are mapped for the kernel, and if all the jobs read a range of
+ * cuda_map_host_range() the kernel reads their samples there, unpacked.
+ */
+class cuda_multicorrelator_batch
+{
+public:
+    cuda_multicorrelator_batch();
+    ~cuda_multicorrelator_batch();
+    bool init_cuda();
+    bool Carrier_wipeoff_multicorrelator_resampler_cuda(const Correlator_Job* jobs, int n_jobs);
+    bool free_cuda();
+
+private:
+    cuda_multicorrelator_batch(const cuda_multicorrelator_batch&);
+    cuda_multicorrelator_batch& operator=(const cuda_multicorrelator_batch&);
+
+    bool reserve(int n_samples, int n_chips, int n_taps, int n_jobs);
+
+    // pinned host staging buffers
+    std::complex<float>* h_sig_in;
+    std::complex<float>* h_local_codes_in;
+    float* h_shifts_chips;
+    GPU_Correlator_Job* h_jobs;
+    std::complex<float>* h_corr_out;
+
+    // device buffers
+    GPU_Complex* d_sig_in;
+    GPU_Complex* d_local_codes_in;
+    float* d_shifts_chips;
+    GPU_Correlator_Job* d_jobs;
+    GPU_Complex* d_corr_out;
+
+    int d_max_samples;
+    int d_max_chips;
+    int d_max_taps;
+    int d_max_jobs;
+
+    int d_device;
+    cudaStream_t d_stream;
+    bool d_initialized;
+    bool d_zero_copy; // the staging buffers are mapped, and the device buffers alias them
+};
+
+
+/*!
+ * \brief Gathers the correlations of the GPU tracking channels into batches
+ * for cuda_multicorrelator_batch.
+ *
+ * It works as Correlator_Batcher: the first channel to submit a job opens
+ * a batch and waits for the other channels, or for wait_us microseconds,
+ * and then it runs the batch on the GPU while the others wait for their
+ * outputs. All the functions are thread-safe.
+ */
+class Cuda_Correlator_Batcher
+{
+public:
+    /*!
+     * \brief Changes by count the number of channels that submit a job every code period
+     */
+    static void add_channels(int count);
+
+    /*!
+     * \brief Correlates job in the next batch. Returns when job.corr_out holds the outputs
+     */
+    static bool correlate(const Correlator_Job& job, unsigned int wait_us);
+
+    /*!
+     * \brief Runs the next batches without copies if the device shares the memory of the host
+     */
+    static void set_zero_copy(bool zero_copy);
+};
+
+
 #endif /* GNSS_SDR_CUDA_MULTICORRELATOR_H_ */
@@ -0,0 +1,175 @@
+/*!
+ * \file fine_pull_in.cc
+ * \brief Refinement of the Doppler and code phase of an acquisition before
+ * the tracking loops are closed
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "fine_pull_in.h"
+#include <algorithm>
+#include <cmath>
+
+// bins of the spectrum per code period of the window
+const int PULL_IN_ZERO_PADDING = 8;
+// power of the spectrum peak over its mean for the estimates to be used
+const float PULL_IN_MIN_PEAK_TO_MEAN = 8.0;
+
+
+Fine_Pull_In::Fine_Pull_In()
+{
+    configure(0, 0.001, 0.5);
+}
+
+
+void Fine_Pull_In::configure(int periods, double period_s, float spacing_chips)
+{
+    d_periods = std::max(periods, 0);
+    d_bins = PULL_IN_ZERO_PADDING * d_periods;
+    d_period_s = period_s;
+    d_spacing_chips = spacing_chips;
+    d_twiddles.resize(d_bins * d_periods);
+    for (int m = 0; m < d_bins; m++)
+        {
+            // bins from -1/(2 period_s) to 1/(2 period_s)
+            for (int k = 0; k < d_periods; k++)
+                {
+                    double phase = -2.0 * M_PI * static_cast<double>((m - d_bins / 2) * k) / static_cast<double>(d_bins);
+                    d_twiddles[m * d_periods + k] = std::complex<float>(std::cos(phase), std::sin(phase));
+                }
+        }
+    d_prompts.reserve(d_periods);
+    d_spectrum.resize(d_bins);
+    reset();
+}
+
+
+void Fine_Pull_In::reset()
+{
+    d_prompts.clear();
+    d_abs_early = 0.0;
+    d_abs_prompt = 0.0;
+    d_abs_late = 0.0;
+    d_active = enabled();
+    d_reliable = false;
+    d_doppler_error_hz = 0.0;
+    d_code_error_chips = 0.0;
+}
+
+
+bool Fine_Pull_In::add(const std::complex<float>& early, const std::complex<float>& prompt, const std::complex<float>& late)
+{
+    if (!d_active)
+        {
+            return false;
+        }
+    d_prompts.push_back(prompt);
+    d_abs_early += std::abs(early);
+    d_abs_prompt += std::abs(prompt);
+    d_abs_late += std::abs(late);
+    if (static_cast<int>(d_prompts.size()) < d_periods)
+        {
+            return false;
+        }
+    estimate();
+    d_active = false;
+    return true;
+}
+
+
+void Fine_Pull_In::estimate()
+{
+    // The window may hold one navigation bit transition: each bin keeps the
+    // largest power over the periods where the sign of the prompts may flip,
+    // from the partial sums of its transform
+    float energy = 0.0;
+    for (int k = 0; k < d_periods; k++)
+        {
+            energy += std::norm(d_prompts[k]);
+        }
+    int peak_bin = 0;
+    int peak_flip = 0;
+    float peak_power = 0.0;
+    for (int m = 0; m < d_bins; m++)
+        {
+            const std::complex<float>* twiddles = &d_twiddles[m * d_periods];
+            std::complex<float> total(0.0, 0.0);
+            for (int k = 0; k < d_periods; k++)
+                {
+                    total += d_prompts[k] * twiddles[k];
+                }
+            std::complex<float> head(0.0, 0.0);
+            for (int flip = 0; flip < d_periods; flip++)
+                {
+                    // the sign flips before period flip, none for flip 0
+                    float power = std::norm(total - 2.0f * head);
+                    if (power > peak_power)
+                        {
+                            peak_power = power;
+                            peak_bin = m;
+                            peak_flip = flip;
+                        }
+                    head += d_prompts[flip] * twiddles[flip];
+                }
+        }
+    if (energy <= 0.0 or peak_power < PULL_IN_MIN_PEAK_TO_MEAN * energy)
+        {
+            return;
+        }
+
+    // spectrum of the peak hypothesis, around the peak
+    for (int m = peak_bin - 1; m <= peak_bin + 1; m++)
+        {
+            int bin = (m + d_bins) % d_bins;
+            const std::complex<float>* twiddles = &d_twiddles[bin * d_periods];
+            std::complex<float> sum(0.0, 0.0);
+            for (int k = 0; k < d_periods; k++)
+                {
+                    sum += (k < peak_flip ? -1.0f : 1.0f) * d_prompts[k] * twiddles[k];
+                }
+            d_spectrum[bin] = std::abs(sum);
+        }
+    float left = d_spectrum[(peak_bin + d_bins - 1) % d_bins];
+    float center = d_spectrum[peak_bin];
+    float right = d_spectrum[(peak_bin + 1) % d_bins];
+    double offset_bins = 0.0;
+    float curvature = left - 2.0 * center + right;
+    if (curvature < 0.0)
+        {
+            offset_bins = std::min(std::max(0.5 * (left - right) / curvature, -0.5), 0.5);
+        }
+    d_doppler_error_hz = (static_cast<double>(peak_bin - d_bins / 2) + offset_bins) / (static_cast<double>(d_bins) * d_period_s);
+
+    // triangle through the accumulated taps, the peak is between Early and Late
+    double floor_tap = std::min(d_abs_early, d_abs_late);
+    if (d_abs_prompt > floor_tap)
+        {
+            d_code_error_chips = d_spacing_chips * (d_abs_early - d_abs_late) / (2.0 * (d_abs_prompt - floor_tap));
+            d_code_error_chips = std::min(std::max(d_code_error_chips, -static_cast<double>(d_spacing_chips)), static_cast<double>(d_spacing_chips));
+        }
+    d_reliable = true;
+}
@@ -0,0 +1,109 @@
+/*!
+ * \file fine_pull_in.h
+ * \brief Refinement of the Doppler and code phase of an acquisition before
+ * the tracking loops are closed
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_FINE_PULL_IN_H_
+#define GNSS_SDR_FINE_PULL_IN_H_
+
+#include <complex>
+#include <vector>
+
+/*!
+ * \brief Refines the Doppler and the code phase of an acquisition from the
+ * first code periods of a tracking channel, before its loops are closed.
+ *
+ * The channel correlates the periods with the NCOs of the acquisition.
+ * The Doppler error is the frequency of the rotation of their prompts:
+ * their spectrum is evaluated on a zero padded grid over the span of one
+ * code period, and the peak is interpolated with a parabola. The code
+ * phase error is interpolated from the triangle of the accumulated
+ * Early, Prompt and Late magnitudes, in the sign of the DLL
+ * discriminators. A window with a navigation bit transition still gives
+ * the Doppler, with a broader peak. When the spectrum peak is not clearly
+ * above its mean the estimates are 0, and the loops pull in as before.
+ */
+class Fine_Pull_In
+{
+public:
+    Fine_Pull_In();
+
+    /*!
+     * \param periods code periods to collect, 0 disables the refinement
+     * \param period_s length of a code period [s]
+     * \param spacing_chips early-late spacing of the taps [chips]
+     */
+    void configure(int periods, double period_s, float spacing_chips);
+
+    bool enabled() const { return d_periods > 0; }
+
+    //! Starts collecting a new acquisition
+    void reset();
+
+    //! Whether the channel is still collecting code periods
+    bool active() const { return d_active; }
+
+    /*!
+     * \brief Adds the Early, Prompt and Late outputs of a code period
+     * \return true if it was the last period of the window, and the estimates are ready
+     */
+    bool add(const std::complex<float>& early, const std::complex<float>& prompt, const std::complex<float>& late);
+
+    //! Frequency to add to the carrier NCO of the acquisition [Hz]
+    double doppler_error_hz() const { return d_doppler_error_hz; }
+
+    //! Code phase error, as a DLL discriminator would report it [chips]
+    double code_error_chips() const { return d_code_error_chips; }
+
+    //! Whether the spectrum peak was clear enough for the estimates
+    bool reliable() const { return d_reliable; }
+
+    int periods() const { return d_periods; }
+    int bins() const { return d_bins; }
+
+private:
+    void estimate();
+
+    int d_periods;
+    int d_bins;
+    double d_period_s;
+    float d_spacing_chips;
+    std::vector<std::complex<float>> d_twiddles; // d_bins x d_periods
+    std::vector<std::complex<float>> d_prompts;
+    std::vector<float> d_spectrum;
+    double d_abs_early;
+    double d_abs_prompt;
+    double d_abs_late;
+    bool d_active;
+    bool d_reliable;
+    double d_doppler_error_hz;
+    double d_code_error_chips;
+};
+
+#endif
@@ -48,6 +48,7 @@
 
 #include "lock_detectors.h"
 #include <cmath>
+#include <volk_gnsssdr/volk_gnsssdr.h>
 
 /*
  * Signal-to-Noise (SNR) (\f$\rho\f$) estimator using the Signal-to-Noise Variance (SNV) estimator:
@@ -110,3 +111,32 @@ float carrier_lock_detector(gr_complex* Prompt_buffer, int length)
     NBD = tmp_sum_I*tmp_sum_I - tmp_sum_Q*tmp_sum_Q;
     return NBD/NBP;
 }
+
+
+void cn0_and_carrier_lock(const gr_complex* Prompt_buffer, int length, long fs_in, double code_length,
+        float* cn0_db_hz, float* carrier_lock_test)
+{
+    // sum of |I|, sum of |P|^2, sum of I and sum of Q
+    float stats[4];
+    volk_gnsssdr_32fc_lock_statistics_32f(stats, Prompt_buffer, length);
+
+    double Psig = static_cast<double>(stats[0]) / static_cast<double>(length);
+    Psig = Psig * Psig;
+    double Ptot = static_cast<double>(stats[1]) / static_cast<double>(length);
+    double SNR = Psig / (Ptot - Psig);
+    *cn0_db_hz = static_cast<float>(10 * log10(SNR) + 10 * log10(static_cast<double>(fs_in) / 2) - 10 * log10(code_length));
+
+    float NBP = stats[2] * stats[2] + stats[3] * stats[3];
+    float NBD = stats[2] * stats[2] - stats[3] * stats[3];
+    *carrier_lock_test = NBD / NBP;
+}
+
+
+void cn0_and_carrier_lock_batch(const gr_complex* const* Prompt_buffers, int n_channels, int length, long fs_in,
+        const double* code_length, float* cn0_db_hz, float* carrier_lock_test)
+{
+    for (int k = 0; k < n_channels; k++)
+        {
+            cn0_and_carrier_lock(Prompt_buffers[k], length, fs_in, code_length[k], &cn0_db_hz[k], &carrier_lock_test[k]);
+        }
+}
@@ -92,4 +92,23 @@ float cn0_svn_estimator(gr_complex* Prompt_buffer, int length, long fs_in, doubl
  */
 float carrier_lock_detector(gr_complex* Prompt_buffer, int length);
 
+
+/*! \brief CN0_SNV estimate and carrier lock test of a buffer of prompt
+ * correlator outputs, in a single pass of the volk_gnsssdr_32fc_lock_statistics_32f kernel
+ *
+ * The results are those of cn0_svn_estimator and carrier_lock_detector,
+ * with the sums accumulated in single precision.
+ */
+void cn0_and_carrier_lock(const gr_complex* Prompt_buffer, int length, long fs_in, double code_length,
+        float* cn0_db_hz, float* carrier_lock_test);
+
+
+/*! \brief cn0_and_carrier_lock of the prompt buffers of n_channels channels
+ *
+ * Prompt_buffers[k], code_length[k], cn0_db_hz[k] and carrier_lock_test[k]
+ * belong to channel k, and all the buffers hold length prompt outputs.
+ */
+void cn0_and_carrier_lock_batch(const gr_complex* const* Prompt_buffers, int n_channels, int length, long fs_in,
+        const double* code_length, float* cn0_db_hz, float* carrier_lock_test);
+
 #endif
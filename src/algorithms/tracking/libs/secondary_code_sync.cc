@@ -0,0 +1,107 @@
+/*!
+ * \file secondary_code_sync.cc
+ * \brief Synchronization of a tracking loop with the secondary code of a
+ * pilot component
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "secondary_code_sync.h"
+
+
+Secondary_Code_Sync::Secondary_Code_Sync()
+{
+    reset();
+}
+
+
+Secondary_Code_Sync::Secondary_Code_Sync(const std::string& code)
+{
+    for (unsigned int i = 0; i < code.size(); i++)
+        {
+            d_code.push_back(code.at(i) == '0' ? 1 : -1);
+        }
+    d_signs.assign(d_code.size(), 0);
+    reset();
+}
+
+
+void Secondary_Code_Sync::reset()
+{
+    d_n_signs = 0;
+    d_next = 0;
+    d_locked = false;
+    d_polarity = 1;
+    d_chip = 0;
+}
+
+
+bool Secondary_Code_Sync::add(const std::complex<float>& prompt)
+{
+    unsigned int length = d_code.size();
+    if (d_locked or length == 0)
+        {
+            return false;
+        }
+    d_signs[d_next] = prompt.real() > 0 ? 1 : -1;
+    d_next = (d_next + 1) % length;
+    if (d_n_signs < length)
+        {
+            d_n_signs++;
+            if (d_n_signs < length) return false;
+        }
+
+    // d_next is now the oldest sign; the shift is the chip of that period
+    for (unsigned int shift = 0; shift < length; shift++)
+        {
+            int polarity = d_signs[d_next] * d_code[shift];
+            unsigned int j = 1;
+            while (j < length and d_signs[(d_next + j) % length] == polarity * d_code[(shift + j) % length])
+                {
+                    j++;
+                }
+            if (j == length)
+                {
+                    d_locked = true;
+                    d_polarity = polarity;
+                    d_chip = shift; // the next period starts the code again after a whole one
+                    return true;
+                }
+        }
+    return false;
+}
+
+
+float Secondary_Code_Sync::next_sign()
+{
+    if (!d_locked)
+        {
+            return 1.0;
+        }
+    float sign = static_cast<float>(d_code[d_chip]);
+    d_chip = (d_chip + 1) % d_code.size();
+    return sign;
+}
@@ -0,0 +1,90 @@
+/*!
+ * \file secondary_code_sync.h
+ * \brief Synchronization of a tracking loop with the secondary code of a
+ * pilot component
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_SECONDARY_CODE_SYNC_H_
+#define GNSS_SDR_SECONDARY_CODE_SYNC_H_
+
+#include <complex>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Finds the secondary code chip of each primary code period of a
+ * pilot, from the signs of its prompt outputs.
+ *
+ * Until it is locked, the prompts are added once per code period, and the
+ * signs of the last code length of them are searched for every shift of the
+ * code. It locks when all of them match one shift, which a tracked pilot
+ * does within one secondary code period, and noise almost never does. The
+ * polarity tells whether they matched the code or its inverse, that is,
+ * whether the carrier phase is half a cycle off. Once locked, next_sign()
+ * gives the chip of each code period to strip from its correlator outputs.
+ */
+class Secondary_Code_Sync
+{
+public:
+    Secondary_Code_Sync();
+
+    /*!
+     * \param code secondary code chips, '0' for +1 and '1' for -1
+     */
+    explicit Secondary_Code_Sync(const std::string& code);
+
+    void reset();
+
+    /*!
+     * \brief Adds the prompt of the code period that has just been correlated
+     * \return true if the code has just been found
+     */
+    bool add(const std::complex<float>& prompt);
+
+    /*!
+     * \brief Chip of the secondary code of the code period to be correlated
+     * next, +1 or -1, and moves on to the following one
+     */
+    float next_sign();
+
+    bool locked() const { return d_locked; }
+    int polarity() const { return d_polarity; }
+    unsigned int chip() const { return d_chip; }
+    unsigned int length() const { return d_code.size(); }
+
+private:
+    std::vector<int> d_code;
+    std::vector<int> d_signs;  // circular, d_next is the oldest once full
+    unsigned int d_n_signs;
+    unsigned int d_next;
+    bool d_locked;
+    int d_polarity;
+    unsigned int d_chip;
+};
+
+#endif
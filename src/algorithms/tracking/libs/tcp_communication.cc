@@ -32,12 +32,16 @@
 #include "tcp_packet_data.h"
 #include "tcp_communication.h"
 #include <iostream>
+#include <stdexcept>
 #include <string>
 
 
 
 tcp_communication::tcp_communication() : tcp_socket_(io_service_)
-{}
+{
+    pending_packet_ = false;
+    pending_control_id_ = 0;
+}
 
 
 tcp_communication::~tcp_communication()
@@ -146,10 +150,65 @@ void tcp_communication::send_receive_tcp_packet_gps_l1_ca(boost::array<float, NU
 }
 
 
+bool tcp_communication::send_receive_tcp_packet_galileo_e1_pipelined(boost::array<float, NUM_TX_VARIABLES_GALILEO_E1> buf, tcp_packet_data *tcp_data_)
+{
+    return send_receive_tcp_packet_pipelined(buf.data(), buf.size(), tcp_data_);
+}
+
+
+bool tcp_communication::send_receive_tcp_packet_gps_l1_ca_pipelined(boost::array<float, NUM_TX_VARIABLES_GPS_L1_CA> buf, tcp_packet_data *tcp_data_)
+{
+    return send_receive_tcp_packet_pipelined(buf.data(), buf.size(), tcp_data_);
+}
+
+
+bool tcp_communication::send_receive_tcp_packet_pipelined(const float* buf, size_t num_variables, tcp_packet_data *tcp_data_)
+{
+    int controlc = 0;
+    bool received = false;
+    boost::array<float, NUM_RX_VARIABLES> readbuf;
+
+    try
+    {
+            // Send this packet first, so that the external process computes its answer
+            // while the channel correlates the next code period
+            boost::asio::write(tcp_socket_, boost::asio::buffer(buf, num_variables * sizeof(float)));
+
+            if (pending_packet_)
+                {
+                    // Read the whole answer to the previous packet
+                    boost::asio::read(tcp_socket_, boost::asio::buffer(readbuf));
+
+                    //! Control. The GNSS-SDR program ends if an error in a TCP packet is detected.
+                    if (pending_control_id_ != readbuf.data()[0])
+                        {
+                            throw std::runtime_error("Packet error!");
+                        }
+
+                    // Recover the variables received
+                    tcp_data_->proc_pack_code_error = readbuf.data()[1];
+                    tcp_data_->proc_pack_carr_error = readbuf.data()[2];
+                    tcp_data_->proc_pack_carrier_doppler_hz = readbuf.data()[3];
+                    received = true;
+                }
+            pending_control_id_ = buf[0];
+            pending_packet_ = true;
+    }
+
+    catch(std::exception& e)
+    {
+            std::cerr << "Exception: " << e.what() << ". Please press Ctrl+C to end the program." << std::endl;
+            std::cin >> controlc;
+    }
+    return received;
+}
+
+
 void tcp_communication::close_tcp_connection(size_t d_port_)
 {
     // Close the TCP connection
     tcp_socket_.close();
+    pending_packet_ = false;
     std::cout << "Socket closed on port " << d_port_ << std::endl;
     return;
 }
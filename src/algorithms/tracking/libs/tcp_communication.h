@@ -52,11 +52,27 @@ public:
     int listen_tcp_connection(size_t d_port_, size_t d_port_ch0_);
     void send_receive_tcp_packet_galileo_e1(boost::array<float, NUM_TX_VARIABLES_GALILEO_E1> buf, tcp_packet_data *tcp_data_);
     void send_receive_tcp_packet_gps_l1_ca(boost::array<float, NUM_TX_VARIABLES_GPS_L1_CA> buf, tcp_packet_data *tcp_data_);
+
+    /*!
+     * \brief Pipelined exchange, that tolerates one epoch of latency of the external loop filter
+     *
+     * Sends buf without waiting for its answer, and then reads the answer
+     * to the packet sent in the previous call, which the external process
+     * has been computing meanwhile. tcp_data_ is only written when that
+     * answer was read, so this returns false on the first call after the
+     * connection is opened.
+     */
+    bool send_receive_tcp_packet_galileo_e1_pipelined(boost::array<float, NUM_TX_VARIABLES_GALILEO_E1> buf, tcp_packet_data *tcp_data_);
+    bool send_receive_tcp_packet_gps_l1_ca_pipelined(boost::array<float, NUM_TX_VARIABLES_GPS_L1_CA> buf, tcp_packet_data *tcp_data_);
     void close_tcp_connection(size_t d_port_);
 
 private:
+    bool send_receive_tcp_packet_pipelined(const float* buf, size_t num_variables, tcp_packet_data *tcp_data_);
+
     boost::asio::io_service io_service_;
     boost::asio::ip::tcp::socket tcp_socket_;
+    bool pending_packet_;
+    float pending_control_id_;
 };
 
 #endif
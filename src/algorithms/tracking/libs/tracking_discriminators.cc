@@ -46,12 +46,12 @@
  * \f$I_{PS2},Q_{PS2}\f$ are the inphase and quadrature prompt correlator outputs respectively at sample time \f$t_2\f$. The output is in [radians/second].
  */
 
-double fll_four_quadrant_atan(gr_complex prompt_s1, gr_complex prompt_s2, double t1, double t2)
+float fll_four_quadrant_atan(gr_complex prompt_s1, gr_complex prompt_s2, double t1, double t2)
 {
-    double cross, dot;
+    float cross, dot;
     dot   = prompt_s1.real()*prompt_s2.real() + prompt_s1.imag()*prompt_s2.imag();
     cross = prompt_s1.real()*prompt_s2.imag() - prompt_s2.real()*prompt_s1.imag();
-    return atan2(cross, dot) / (t2-t1);
+    return std::atan2(cross, dot) / static_cast<float>(t2-t1);
 }
 
 
@@ -62,9 +62,9 @@ double fll_four_quadrant_atan(gr_complex prompt_s1, gr_complex prompt_s2, double
  * \f}
  * where \f$I_{PS1},Q_{PS1}\f$ are the inphase and quadrature prompt correlator outputs respectively. The output is in [radians].
  */
-double pll_four_quadrant_atan(gr_complex prompt_s1)
+float pll_four_quadrant_atan(gr_complex prompt_s1)
 {
-    return atan2(prompt_s1.imag(), prompt_s1.real());
+    return std::atan2(prompt_s1.imag(), prompt_s1.real());
 }
 
 
@@ -75,11 +75,11 @@ double pll_four_quadrant_atan(gr_complex prompt_s1)
  * \f}
  * where \f$I_{PS1},Q_{PS1}\f$ are the inphase and quadrature prompt correlator outputs respectively. The output is in [radians].
  */
-double pll_cloop_two_quadrant_atan(gr_complex prompt_s1)
+float pll_cloop_two_quadrant_atan(gr_complex prompt_s1)
 {
-    if (prompt_s1.real() != 0.0)
+    if (prompt_s1.real() != 0.0f)
         {
-            return atan(prompt_s1.imag() / prompt_s1.real());
+            return std::atan(prompt_s1.imag() / prompt_s1.real());
         }
     else
         {
@@ -98,16 +98,16 @@ double pll_cloop_two_quadrant_atan(gr_complex prompt_s1)
  */
 float dll_nc_e_minus_l_normalized(gr_complex early_s1, gr_complex late_s1)
 {
-    double P_early, P_late;
+    float P_early, P_late;
     P_early = std::abs(early_s1);
     P_late  = std::abs(late_s1);
-    if( P_early + P_late == 0.0 )
+    if( P_early + P_late == 0.0f )
         {
-            return 0.0;
+            return 0.0f;
         }
     else
         {
-            return 0.5 * (P_early - P_late) / ((P_early + P_late));
+            return 0.5f * (P_early - P_late) / ((P_early + P_late));
         }
 }
 
@@ -133,14 +133,14 @@ float all(gr_complex early_s1, gr_complex late_s1, gr_complex prompt_s1, float l
  * where \f$E=\sqrt{I_{VE}^2+Q_{VE}^2+I_{E}^2+Q_{E}^2}\f$ and
  * \f$L=\sqrt{I_{VL}^2+Q_{VL}^2+I_{L}^2+Q_{L}^2}\f$ . The output is in [chips].
  */
-double dll_nc_vemlp_normalized(gr_complex very_early_s1, gr_complex early_s1, gr_complex late_s1, gr_complex very_late_s1)
+float dll_nc_vemlp_normalized(gr_complex very_early_s1, gr_complex early_s1, gr_complex late_s1, gr_complex very_late_s1)
 {
-    double P_early, P_late;
+    float P_early, P_late;
     P_early = std::sqrt(std::norm(very_early_s1) + std::norm(early_s1));
     P_late  = std::sqrt(std::norm(very_late_s1) + std::norm(late_s1));
-    if( P_early + P_late == 0.0 )
+    if( P_early + P_late == 0.0f )
         {
-            return 0.0;
+            return 0.0f;
         }
     else
         {
@@ -40,6 +40,12 @@
 
 #include <gnuradio/gr_complex.h>
 
+/*
+ * The discriminators take the single precision correlator outputs and
+ * compute in single precision: their errors are far below the noise of
+ * the correlations. The NCOs keep their phases in double precision.
+ */
+
 /*! brief FLL four quadrant arctan discriminator
  *
  * FLL four quadrant arctan discriminator:
@@ -50,7 +56,7 @@
  * \f$I_{PS1},Q_{PS1}\f$ are the inphase and quadrature prompt correlator outputs respectively at sample time \f$t_1\f$, and
  * \f$I_{PS2},Q_{PS2}\f$ are the inphase and quadrature prompt correlator outputs respectively at sample time \f$t_2\f$. The output is in [radians/second].
  */
-double fll_four_quadrant_atan(gr_complex prompt_s1, gr_complex prompt_s2, double t1, double t2);
+float fll_four_quadrant_atan(gr_complex prompt_s1, gr_complex prompt_s2, double t1, double t2);
 
 
 /*! \brief PLL four quadrant arctan discriminator
@@ -61,7 +67,7 @@ double fll_four_quadrant_atan(gr_complex prompt_s1, gr_complex prompt_s2, double
  * \f}
  * where \f$I_{PS1},Q_{PS1}\f$ are the inphase and quadrature prompt correlator outputs respectively. The output is in [radians].
  */
-double pll_four_quadrant_atan(gr_complex prompt_s1);
+float pll_four_quadrant_atan(gr_complex prompt_s1);
 
 
 /*! \brief PLL Costas loop two quadrant arctan discriminator
@@ -72,7 +78,7 @@ double pll_four_quadrant_atan(gr_complex prompt_s1);
  * \f}
  * where \f$I_{PS1},Q_{PS1}\f$ are the inphase and quadrature prompt correlator outputs respectively. The output is in [radians].
  */
-double pll_cloop_two_quadrant_atan(gr_complex prompt_s1);
+float pll_cloop_two_quadrant_atan(gr_complex prompt_s1);
 
 
 /*! \brief DLL Noncoherent Early minus Late envelope normalized discriminator
@@ -104,7 +110,7 @@ float MD(gr_complex early_s1, gr_complex late_s1, gr_complex prompt_s1);
  * where \f$E=\sqrt{I_{VE}^2+Q_{VE}^2+I_{E}^2+Q_{E}^2}\f$ and
  * \f$L=\sqrt{I_{VL}^2+Q_{VL}^2+I_{L}^2+Q_{L}^2}\f$ . The output is in [chips].
  */
-double dll_nc_vemlp_normalized(gr_complex very_early_s1, gr_complex early_s1, gr_complex late_s1, gr_complex very_late_s1);
+float dll_nc_vemlp_normalized(gr_complex very_early_s1, gr_complex early_s1, gr_complex late_s1, gr_complex very_late_s1);
 
 
 #endif
@@ -0,0 +1,72 @@
+/*!
+ * \file tracking_dump_writer.cc
+ * \brief Binary record of the tracking dump files and the Dump_Writer
+ * that stores them
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "tracking_dump_writer.h"
+#include <algorithm>
+
+
+Dump_Schema tracking_dump_schema()
+{
+    Dump_Schema schema("tracking");
+    schema.add<float>("abs_E")
+          .add<float>("abs_P")
+          .add<float>("abs_L")
+          .add<float>("prompt_I")
+          .add<float>("prompt_Q")
+          .add<unsigned long long>("PRN_start_sample")
+          .add<double>("acc_carrier_phase_rad")
+          .add<double>("carrier_doppler_hz")
+          .add<double>("code_freq_chips")
+          .add<double>("carr_error_hz")
+          .add<double>("carr_nco_hz")
+          .add<double>("code_error_chips")
+          .add<double>("code_nco_chips")
+          .add<double>("CN0_SNV_dB_Hz")
+          .add<double>("carrier_lock_test")
+          .add<double>("rem_code_phase_samples")
+          .add<double>("next_PRN_start_sample")
+          .add<float>("delta")
+          .add<float>("RT")
+          .add<float>("ELP")
+          .add<float>("MD");
+    return schema;
+}
+
+
+Tracking_Dump_Writer::Tracking_Dump_Writer(unsigned int records_per_buffer) :
+        d_writer(std::max(records_per_buffer, 1u) * sizeof(Tracking_Dump_Record))
+{}
+
+
+bool Tracking_Dump_Writer::open(const std::string& filename)
+{
+    return d_writer.open(filename, tracking_dump_schema());
+}
@@ -0,0 +1,135 @@
+/*!
+ * \file tracking_dump_writer.h
+ * \brief Binary record of the tracking dump files and the Dump_Writer
+ * that stores them
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_TRACKING_DUMP_WRITER_H_
+#define GNSS_SDR_TRACKING_DUMP_WRITER_H_
+
+#include <string>
+#include "dump_writer.h"
+
+#pragma pack(push, 1)
+/*!
+ * \brief One integration period of a tracking channel, as stored in the
+ * tracking dump files (track_chN.dat).
+ *
+ * The file is a dump header (see dump_schema.h) followed by these records,
+ * with no padding, in the byte order of the host (little endian on the
+ * supported platforms). Each record is 132 bytes:
+ *
+ * | offset | type    | field                                          |
+ * |--------|---------|------------------------------------------------|
+ * |      0 | float32 | abs_E, abs_P, abs_L: correlator magnitudes     |
+ * |     12 | float32 | prompt_I, prompt_Q                             |
+ * |     20 | uint64  | PRN_start_sample: sample counter of the period |
+ * |     28 | float64 | acc_carrier_phase_rad                          |
+ * |     36 | float64 | carrier_doppler_hz                             |
+ * |     44 | float64 | code_freq_chips [chips/s]                      |
+ * |     52 | float64 | carr_error_hz: PLL discriminator output        |
+ * |     60 | float64 | carr_nco_hz: carrier NCO command               |
+ * |     68 | float64 | code_error_chips: DLL discriminator output     |
+ * |     76 | float64 | code_nco_chips: filtered DLL command           |
+ * |     84 | float64 | CN0_SNV_dB_Hz                                  |
+ * |     92 | float64 | carrier_lock_test                              |
+ * |    100 | float64 | rem_code_phase_samples                         |
+ * |    108 | float64 | next_PRN_start_sample                          |
+ * |    116 | float32 | delta, RT, ELP, MD: vestigial signal metrics   |
+ *
+ * This is the layout the GPS L1 C/A DLL/PLL tracking has always written,
+ * described by tracking_dump_schema(). The whole file can be mapped at
+ * once, see src/utils/matlab/libs/read_dump.m
+ */
+struct Tracking_Dump_Record
+{
+    float abs_E;
+    float abs_P;
+    float abs_L;
+    float prompt_I;
+    float prompt_Q;
+    unsigned long long PRN_start_sample;
+    double acc_carrier_phase_rad;
+    double carrier_doppler_hz;
+    double code_freq_chips;
+    double carr_error_hz;
+    double carr_nco_hz;
+    double code_error_chips;
+    double code_nco_chips;
+    double CN0_SNV_dB_Hz;
+    double carrier_lock_test;
+    double rem_code_phase_samples;
+    double next_PRN_start_sample;
+    float delta;
+    float RT;
+    float ELP;
+    float MD;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(Tracking_Dump_Record) == 132, "the tracking dump record layout has changed");
+
+
+/*!
+ * \brief Fields of Tracking_Dump_Record
+ */
+Dump_Schema tracking_dump_schema();
+
+
+/*!
+ * \brief Writes the tracking dump records of one channel through a
+ * Dump_Writer, which buffers records_per_buffer of them.
+ */
+class Tracking_Dump_Writer
+{
+public:
+    explicit Tracking_Dump_Writer(unsigned int records_per_buffer = 1000);
+
+    /*!
+     * \brief Creates (or truncates) filename and writes its header
+     * \return false if the file could not be opened.
+     */
+    bool open(const std::string& filename);
+
+    bool is_open() const { return d_writer.is_open(); }
+
+    void write(const Tracking_Dump_Record& record)
+    {
+        d_writer.write(&record);
+    }
+
+    /*!
+     * \brief Writes the pending records and closes the file
+     */
+    void close() { d_writer.close(); }
+
+private:
+    Dump_Writer d_writer;
+};
+
+#endif
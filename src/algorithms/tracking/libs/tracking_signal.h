@@ -0,0 +1,178 @@
+/*!
+ * \file tracking_signal.h
+ * \brief Compile-time description of the signals tracked by the DLL/PLL
+ * blocks, and the code and carrier NCO arithmetic they share
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_TRACKING_SIGNAL_H_
+#define GNSS_SDR_TRACKING_SIGNAL_H_
+
+#include <cmath>
+#include "GPS_L1_CA.h"
+#include "GPS_L2C.h"
+#include "Galileo_E1.h"
+#include "Galileo_E5a.h"
+
+/*!
+ * \brief Traits of a tracked signal.
+ *
+ * Each struct gives the constants of one signal as inline functions, so
+ * that Tracking_Nco and the tap loops are compiled for it:
+ * - code_rate_hz(), code_length_chips(), code_period_s(): primary code
+ * - carrier_freq_hz(), two_pi(): carrier, and 2 Pi as in the ICD
+ * - resampler_units_per_chip(): units of the code phase passed to the
+ *   multicorrelator (2 for the half chips of the BOC(1,1) replica)
+ * - n_taps, prompt_tap: symmetric correlator taps, spaced by the
+ *   early-late spacing of the block, with the prompt in the middle
+ * - periods_per_symbol, secondary_code_length: code periods of a
+ *   navigation symbol, and chips of the secondary code of the tracked
+ *   component (1 if none)
+ */
+struct Gps_L1_Ca_Signal
+{
+    static double code_rate_hz() { return GPS_L1_CA_CODE_RATE_HZ; }
+    static double code_length_chips() { return GPS_L1_CA_CODE_LENGTH_CHIPS; }
+    static double code_period_s() { return GPS_L1_CA_CODE_PERIOD; }
+    static double carrier_freq_hz() { return GPS_L1_FREQ_HZ; }
+    static double two_pi() { return GPS_TWO_PI; }
+    static double resampler_units_per_chip() { return 1.0; }
+    enum { n_taps = 3, prompt_tap = 1, periods_per_symbol = 20, secondary_code_length = 1 };
+};
+
+struct Gps_L2_M_Signal
+{
+    static double code_rate_hz() { return GPS_L2_M_CODE_RATE_HZ; }
+    static double code_length_chips() { return GPS_L2_M_CODE_LENGTH_CHIPS; }
+    static double code_period_s() { return GPS_L2_M_PERIOD; }
+    static double carrier_freq_hz() { return GPS_L2_FREQ_HZ; }
+    static double two_pi() { return GPS_L2_TWO_PI; }
+    static double resampler_units_per_chip() { return 1.0; }
+    enum { n_taps = 3, prompt_tap = 1, periods_per_symbol = 1, secondary_code_length = 1 };
+};
+
+struct Galileo_E1_Signal
+{
+    static double code_rate_hz() { return Galileo_E1_CODE_CHIP_RATE_HZ; }
+    static double code_length_chips() { return Galileo_E1_B_CODE_LENGTH_CHIPS; }
+    static double code_period_s() { return Galileo_E1_CODE_PERIOD; }
+    static double carrier_freq_hz() { return Galileo_E1_FREQ_HZ; }
+    static double two_pi() { return GALILEO_TWO_PI; }
+    static double resampler_units_per_chip() { return 2.0; }
+    enum { n_taps = 5, prompt_tap = 2, periods_per_symbol = 1, secondary_code_length = 1 };
+};
+
+struct Galileo_E5a_Signal
+{
+    static double code_rate_hz() { return Galileo_E5a_CODE_CHIP_RATE_HZ; }
+    static double code_length_chips() { return Galileo_E5a_CODE_LENGTH_CHIPS; }
+    static double code_period_s() { return GALILEO_E5a_CODE_PERIOD; }
+    static double carrier_freq_hz() { return Galileo_E5a_FREQ_HZ; }
+    static double two_pi() { return GALILEO_TWO_PI; }
+    static double resampler_units_per_chip() { return 1.0; }
+    enum { n_taps = 3, prompt_tap = 1, periods_per_symbol = 1, secondary_code_length = Galileo_E5a_Q_SECONDARY_CODE_LENGTH };
+};
+
+
+/*!
+ * \brief Code and carrier NCO updates of a DLL/PLL tracking block for
+ * the Signal traits above.
+ *
+ * The blocks keep their NCO state; these are the per code period
+ * computations, written once with the signal constants known at compile
+ * time.
+ */
+template <class Signal>
+class Tracking_Nco
+{
+public:
+    //! Offsets of the correlator taps from the prompt [chips]
+    static void tap_shifts(float spacing_chips, float* shifts_chips)
+    {
+        for (int n = 0; n < Signal::n_taps; n++)
+            {
+                shifts_chips[n] = static_cast<float>(n - Signal::prompt_tap) * spacing_chips;
+            }
+    }
+
+    //! Code frequency of the carrier Doppler [chips/s]
+    static double code_freq_chips(double carrier_doppler_hz)
+    {
+        return Signal::code_rate_hz() + ((carrier_doppler_hz * Signal::code_rate_hz()) / Signal::carrier_freq_hz());
+    }
+
+    //! Code phase correction of the filtered DLL output over a code period [s]
+    static double code_error_secs(double code_error_filt_chips)
+    {
+        return (Signal::code_period_s() * code_error_filt_chips) / Signal::code_rate_hz();
+    }
+
+    //! Carrier phase advance over a code period [rad]
+    static double period_phase_rad(double freq_hz)
+    {
+        return Signal::two_pi() * freq_hz * Signal::code_period_s();
+    }
+
+    //! Remnant carrier phase after advancing by phase_rad
+    static double wrap_phase_rad(double phase_rad)
+    {
+        return std::fmod(phase_rad, Signal::two_pi());
+    }
+
+    /*!
+     * \brief Samples from the start of this code period to the start of
+     * the next one, before rounding
+     */
+    static double next_period_samples(double code_freq_chips, double rem_code_phase_samples,
+            double code_error_secs, long fs_in)
+    {
+        double T_chip_seconds = 1.0 / code_freq_chips;
+        double T_prn_seconds = T_chip_seconds * Signal::code_length_chips();
+        double T_prn_samples = T_prn_seconds * static_cast<double>(fs_in);
+        return T_prn_samples + rem_code_phase_samples + code_error_secs * static_cast<double>(fs_in);
+    }
+
+    //! Carrier NCO phase increment per sample [rad/sample]
+    static double carrier_phase_step_rad(double carrier_doppler_hz, long fs_in)
+    {
+        return Signal::two_pi() * carrier_doppler_hz / static_cast<double>(fs_in);
+    }
+
+    //! Code resampler phase increment per sample [resampler units/sample]
+    static double code_phase_step(double code_freq_chips, long fs_in)
+    {
+        return Signal::resampler_units_per_chip() * code_freq_chips / static_cast<double>(fs_in);
+    }
+
+    //! Remnant code phase of the remnant samples [resampler units]
+    static double rem_code_phase(double rem_code_phase_samples, double code_freq_chips, long fs_in)
+    {
+        return rem_code_phase_samples * code_phase_step(code_freq_chips, fs_in);
+    }
+};
+
+#endif
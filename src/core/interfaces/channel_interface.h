@@ -62,6 +62,7 @@ public:
     virtual void set_state(unsigned int) = 0;
     virtual unsigned int get_state() = 0;
     virtual unsigned int get_uid() = 0;
+    virtual double cn0_db_hz() = 0; //!< Of the tracking, 0 if not tracking
 };
 
 #endif /* GNSS_SDR_CHANNEL_INTERFACE_H_ */
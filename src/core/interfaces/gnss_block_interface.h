@@ -41,6 +41,8 @@
 #include <string>
 #include <gnuradio/top_block.h>
 
+class ConfigurationInterface;
+
 /*!
  * \brief This abstract class represents an interface to GNSS blocks.
  *
@@ -75,6 +77,15 @@ public:
         if (RF_channel == 0){};  // avoid unused param warning
         return nullptr; // added to support raw array access (non pure virtual to allow left unimplemented)= 0;
     }
+
+    /*!
+     * \brief Applies the parameters of the block that can change while the
+     * flowgraph runs (non pure virtual: most blocks have none)
+     */
+    virtual void reconfigure(ConfigurationInterface* configuration)
+    {
+        if (configuration == nullptr){}; // avoid unused param warning
+    }
 };
 
 #endif /*GNSS_SDR_GNSS_BLOCK_INTERFACE_H_*/
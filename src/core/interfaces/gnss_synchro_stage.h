@@ -0,0 +1,83 @@
+/*!
+ * \file gnss_synchro_stage.h
+ * \brief Interface of a block that can run inline in the block in front of it,
+ * which then feeds it one Gnss_Synchro at a time
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_GNSS_SYNCHRO_STAGE_H_
+#define GNSS_SDR_GNSS_SYNCHRO_STAGE_H_
+
+#include <boost/shared_ptr.hpp>
+#include <gnuradio/basic_block.h>
+#include "gnss_synchro.h"
+
+/*!
+ * \brief A block of Gnss_Synchro in, Gnss_Synchro out (a telemetry decoder)
+ * that can also be run by the block in front of it, in the same call to
+ * general_work, instead of through a GNU Radio buffer and a thread of its own.
+ *
+ * The host block calls push_epoch() for each of its outputs, in order, and
+ * outputs what the stage returns instead. The stage then publishes its
+ * messages on the ports of the host, which take the place of its own.
+ */
+class Gnss_Synchro_Stage
+{
+public:
+    virtual ~Gnss_Synchro_Stage() {}
+
+    /*!
+     * \brief Registers the message output ports of the stage on host, and
+     * publishes its messages there from now on
+     */
+    virtual void attach_to(gr::basic_block* host) = 0;
+
+    /*!
+     * \brief Processes the next epoch and writes the outputs that it
+     * completes to out, at most one. out may be the storage of epoch.
+     */
+    virtual int push_epoch(const Gnss_Synchro& epoch, Gnss_Synchro* out) = 0;
+};
+
+
+/*!
+ * \brief A block that can run a Gnss_Synchro_Stage on its outputs (a
+ * tracking block)
+ */
+class Gnss_Synchro_Stage_Host
+{
+public:
+    virtual ~Gnss_Synchro_Stage_Host() {}
+
+    /*!
+     * \brief Runs stage on the outputs, which are then those of the stage.
+     * An empty pointer gives back the outputs of the host.
+     */
+    virtual void set_synchro_stage(boost::shared_ptr<Gnss_Synchro_Stage> stage) = 0;
+};
+
+#endif
@@ -61,6 +61,15 @@ public:
     virtual void stop_tracking() = 0;
     virtual void set_gnss_synchro(Gnss_Synchro* gnss_synchro) = 0;
     virtual void set_channel(unsigned int channel) = 0;
+
+    /*!
+     * \brief Last C/N0 estimate of the tracked signal [dB-Hz], 0 if not
+     * tracking or not estimated (non pure virtual: not all the blocks do)
+     */
+    virtual double cn0_db_hz()
+    {
+        return 0.0;
+    }
 };
 
 #endif /* GNSS_SDR_TRACKING_INTERFACE_H_ */
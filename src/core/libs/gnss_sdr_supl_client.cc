@@ -33,8 +33,16 @@
 
 #include "gnss_sdr_supl_client.h"
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
 #include <utility>
 
+// First bytes of an assistance snapshot, and version of its layout
+#define ASSISTANCE_SNAPSHOT_MAGIC "GNSSASNP"
+#define ASSISTANCE_SNAPSHOT_VERSION 1
+
 gnss_sdr_supl_client::gnss_sdr_supl_client()
 {
     mcc = 0;
@@ -585,3 +593,79 @@ bool gnss_sdr_supl_client::save_ref_location_map_xml(const std::string file_name
             return false;
         }
 }
+
+
+bool gnss_sdr_supl_client::load_assistance_snapshot(const std::string file_name, double* age_s)
+{
+    try
+    {
+            std::ifstream ifs(file_name.c_str(), std::ifstream::binary | std::ifstream::in);
+            char magic[8];
+            uint32_t version = 0;
+            ifs.read(magic, sizeof(magic));
+            ifs.read(reinterpret_cast<char*>(&version), sizeof(version));
+            if (!ifs || std::memcmp(magic, ASSISTANCE_SNAPSHOT_MAGIC, sizeof(magic)) != 0 || version != ASSISTANCE_SNAPSHOT_VERSION)
+                {
+                    LOG(INFO) << "No assistance snapshot of version " << ASSISTANCE_SNAPSHOT_VERSION << " in " << file_name;
+                    return false;
+                }
+            boost::archive::binary_iarchive archive(ifs);
+            int64_t saved_time = 0;
+            std::map<int, Gps_Ephemeris> eph_map;
+            Gps_Utc_Model utc;
+            Gps_Iono iono;
+            Gps_Ref_Time ref_time;
+            Gps_Ref_Location ref_loc;
+            archive >> saved_time >> eph_map >> utc >> iono >> ref_time >> ref_loc;
+            this->gps_ephemeris_map.swap(eph_map);
+            this->gps_utc = utc;
+            this->gps_iono = iono;
+            this->gps_time = ref_time;
+            this->gps_ref_loc = ref_loc;
+            if (age_s)
+                {
+                    *age_s = std::difftime(std::time(0), static_cast<std::time_t>(saved_time));
+                }
+            LOG(INFO) << "Loaded assistance snapshot with " << this->gps_ephemeris_map.size() << " satellites";
+    }
+    catch (std::exception& e)
+    {
+            LOG(WARNING) << e.what() << "File: " << file_name;
+            return false;
+    }
+    return true;
+}
+
+bool gnss_sdr_supl_client::save_assistance_snapshot(const std::string file_name) const
+{
+    // written next to the file and renamed over it
+    std::string tmp_file_name = file_name + ".tmp";
+    try
+    {
+            std::ofstream ofs(tmp_file_name.c_str(), std::ofstream::binary | std::ofstream::trunc | std::ofstream::out);
+            ofs.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+            uint32_t version = ASSISTANCE_SNAPSHOT_VERSION;
+            ofs.write(ASSISTANCE_SNAPSHOT_MAGIC, 8);
+            ofs.write(reinterpret_cast<const char*>(&version), sizeof(version));
+            {
+                boost::archive::binary_oarchive archive(ofs);
+                int64_t saved_time = static_cast<int64_t>(std::time(0));
+                archive << saved_time << this->gps_ephemeris_map << this->gps_utc << this->gps_iono << this->gps_time << this->gps_ref_loc;
+            }
+            ofs.close();
+    }
+    catch (std::exception& e)
+    {
+            LOG(WARNING) << e.what() << "File: " << tmp_file_name;
+            std::remove(tmp_file_name.c_str());
+            return false;
+    }
+    if (std::rename(tmp_file_name.c_str(), file_name.c_str()) != 0)
+        {
+            LOG(WARNING) << "Cannot replace assistance snapshot " << file_name;
+            std::remove(tmp_file_name.c_str());
+            return false;
+        }
+    LOG(INFO) << "Saved assistance snapshot with " << this->gps_ephemeris_map.size() << " satellites";
+    return true;
+}
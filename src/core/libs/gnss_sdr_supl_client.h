@@ -40,6 +40,8 @@
 #include <string>
 #include <boost/archive/xml_oarchive.hpp>
 #include <boost/archive/xml_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
 #include <boost/serialization/map.hpp>
 #include <glog/logging.h>
 extern "C" {
@@ -161,6 +163,21 @@ public:
     bool save_ref_location_map_xml(std::string file_name,
                                    std::map<int, Gps_Ref_Location> ref_location_map);
 
+    /*!
+     * \brief Read the assistance snapshot written by save_assistance_snapshot:
+     * ephemeris map, utc model, iono, ref time and ref location at once.
+     * \param age_s - if not null, seconds since the snapshot was written
+     * \return false if the file is missing, or of another format version
+     */
+    bool load_assistance_snapshot(const std::string file_name, double* age_s = 0);
+
+    /*!
+     * \brief Save the ephemeris map, utc model, iono, ref time and ref
+     * location to a binary snapshot, much faster to load than the XML files.
+     * The file is replaced at once: a reader never sees half a snapshot.
+     */
+    bool save_assistance_snapshot(const std::string file_name) const;
+
     /*
      * Prints SUPL data to std::cout. Use it for debug purposes only.
      */
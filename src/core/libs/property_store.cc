@@ -0,0 +1,252 @@
+/*!
+ * \file property_store.cc
+ * \brief Implementation of a parsed store of configuration properties
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "property_store.h"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+
+namespace
+{
+// the same conversions as StringConverter, telling when they fail
+template<typename T> bool parse(const std::string& text, T& result)
+{
+    std::stringstream stream(text);
+    stream >> result;
+    return !stream.fail();
+}
+
+
+bool parse(const std::string& text, bool& result)
+{
+    if (text.compare("true") == 0)
+        {
+            result = true;
+            return true;
+        }
+    if (text.compare("false") == 0)
+        {
+            result = false;
+            return true;
+        }
+    return false;
+}
+
+
+unsigned int edit_distance(const std::string& a, const std::string& b)
+{
+    std::vector<unsigned int> row(b.size() + 1);
+    for (unsigned int j = 0; j <= b.size(); j++)
+        {
+            row[j] = j;
+        }
+    for (unsigned int i = 1; i <= a.size(); i++)
+        {
+            unsigned int diagonal = row[0];
+            row[0] = i;
+            for (unsigned int j = 1; j <= b.size(); j++)
+                {
+                    unsigned int above = row[j];
+                    row[j] = std::min(std::min(row[j] + 1, row[j - 1] + 1), diagonal + (a[i - 1] == b[j - 1] ? 0 : 1));
+                    diagonal = above;
+                }
+        }
+    return row[b.size()];
+}
+}
+
+
+PropertyStore::PropertyStore(bool ignore_case) : ignore_case_(ignore_case)
+{}
+
+
+PropertyStore::~PropertyStore()
+{}
+
+
+std::string PropertyStore::key(const std::string& name) const
+{
+    if (!ignore_case_)
+        {
+            return name;
+        }
+    std::string lower(name);
+    for (unsigned int i = 0; i < lower.length(); i++)
+        {
+            lower[i] = tolower(lower[i]);
+        }
+    return lower;
+}
+
+
+void PropertyStore::set(const std::string& name, const std::string& value)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Value& stored = values_[key(name)];
+    stored = Value();
+    stored.text = value;
+    stored.read = false;
+}
+
+
+bool PropertyStore::is_present(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return values_.count(key(name)) > 0;
+}
+
+
+PropertyStore::Value* PropertyStore::find(const std::string& name)
+{
+    std::string k = key(name);
+    std::unordered_map<std::string, Value>::iterator it = values_.find(k);
+    if (it == values_.end())
+        {
+            missing_.insert(k);
+            return 0;
+        }
+    it->second.read = true;
+    return &it->second;
+}
+
+
+std::string PropertyStore::get(const std::string& name, const std::string& default_value)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Value* value = find(name);
+    return value ? value->text : default_value;
+}
+
+
+template<typename T> T PropertyStore::get(const std::string& name, T default_value, Conversion<T> Value::*conversion)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Value* value = find(name);
+    if (!value)
+        {
+            return default_value;
+        }
+    Conversion<T>& converted = value->*conversion;
+    if (converted.state == Conversion<T>::UNKNOWN)
+        {
+            converted.state = parse(value->text, converted.value) ? Conversion<T>::VALID : Conversion<T>::INVALID;
+        }
+    return converted.state == Conversion<T>::VALID ? converted.value : default_value;
+}
+
+
+bool PropertyStore::get(const std::string& name, bool default_value)
+{
+    return get(name, default_value, &Value::as_bool);
+}
+
+
+long PropertyStore::get(const std::string& name, long default_value)
+{
+    return get(name, default_value, &Value::as_long);
+}
+
+
+int PropertyStore::get(const std::string& name, int default_value)
+{
+    return get(name, default_value, &Value::as_int);
+}
+
+
+unsigned int PropertyStore::get(const std::string& name, unsigned int default_value)
+{
+    return get(name, default_value, &Value::as_unsigned_int);
+}
+
+
+unsigned short PropertyStore::get(const std::string& name, unsigned short default_value)
+{
+    return get(name, default_value, &Value::as_unsigned_short);
+}
+
+
+float PropertyStore::get(const std::string& name, float default_value)
+{
+    return get(name, default_value, &Value::as_float);
+}
+
+
+double PropertyStore::get(const std::string& name, double default_value)
+{
+    return get(name, default_value, &Value::as_double);
+}
+
+
+void PropertyStore::mark_read(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unordered_map<std::string, Value>::iterator it = values_.find(key(name));
+    if (it != values_.end())
+        {
+            it->second.read = true;
+        }
+}
+
+
+std::vector<std::string> PropertyStore::unread() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> names;
+    for (std::unordered_map<std::string, Value>::const_iterator it = values_.begin(); it != values_.end(); ++it)
+        {
+            if (!it->second.read)
+                {
+                    names.push_back(it->first);
+                }
+        }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+
+std::string PropertyStore::closest_missing(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string k = key(name);
+    std::string closest;
+    unsigned int closest_distance = 3;
+    for (std::unordered_set<std::string>::const_iterator it = missing_.begin(); it != missing_.end(); ++it)
+        {
+            unsigned int distance = edit_distance(k, *it);
+            if (distance < closest_distance || (distance == closest_distance && *it < closest))
+                {
+                    closest = *it;
+                    closest_distance = distance;
+                }
+        }
+    return closest;
+}
@@ -0,0 +1,110 @@
+/*!
+ * \file property_store.h
+ * \brief Interface of a parsed store of configuration properties
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_PROPERTY_STORE_H_
+#define GNSS_SDR_PROPERTY_STORE_H_
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*!
+ * \brief Configuration properties parsed once and kept in a hash table.
+ *
+ * Each value is converted to a type the first time it is read as that
+ * type, and the conversion (or its failure, which gives the default) is
+ * kept for the next reads. The names read are recorded, so that the
+ * properties never read (usually misspelled) can be reported, together
+ * with the closest name the receiver asked for and did not find.
+ * All the functions are thread-safe.
+ */
+class PropertyStore
+{
+public:
+    //! With ignore_case, the names are compared in lower case, as in the INI files
+    PropertyStore(bool ignore_case);
+    virtual ~PropertyStore();
+
+    void set(const std::string& name, const std::string& value);
+    bool is_present(const std::string& name) const;
+
+    std::string get(const std::string& name, const std::string& default_value);
+    bool get(const std::string& name, bool default_value);
+    long get(const std::string& name, long default_value);
+    int get(const std::string& name, int default_value);
+    unsigned int get(const std::string& name, unsigned int default_value);
+    unsigned short get(const std::string& name, unsigned short default_value);
+    float get(const std::string& name, float default_value);
+    double get(const std::string& name, double default_value);
+
+    //! Counts a property as read, e.g. when its value is overridden
+    void mark_read(const std::string& name);
+
+    //! Names of the properties never read, sorted
+    std::vector<std::string> unread() const;
+
+    //! Name the receiver asked for and did not find closest to name (at most 2 edits), or empty
+    std::string closest_missing(const std::string& name) const;
+
+private:
+    template<typename T> struct Conversion
+    {
+        Conversion() : state(UNKNOWN), value() {}
+        enum { UNKNOWN, VALID, INVALID } state;
+        T value;
+    };
+
+    struct Value
+    {
+        std::string text;
+        bool read;
+        Conversion<bool> as_bool;
+        Conversion<long> as_long;
+        Conversion<int> as_int;
+        Conversion<unsigned int> as_unsigned_int;
+        Conversion<unsigned short> as_unsigned_short;
+        Conversion<float> as_float;
+        Conversion<double> as_double;
+    };
+
+    std::string key(const std::string& name) const;
+    Value* find(const std::string& name); // records the read, with the mutex locked
+    template<typename T> T get(const std::string& name, T default_value, Conversion<T> Value::*conversion);
+
+    bool ignore_case_;
+    std::unordered_map<std::string, Value> values_;
+    std::unordered_set<std::string> missing_; // names asked for and not found
+    mutable std::mutex mutex_;
+};
+
+#endif /*GNSS_SDR_PROPERTY_STORE_H_*/
@@ -0,0 +1,234 @@
+/*!
+ * \file batch_replay.cc
+ * \brief Processes a capture file faster than real time, as overlapping
+ * segments run by parallel receivers, and merges their PVT logs
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "batch_replay.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+#include <boost/thread/thread.hpp>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include "control_thread.h"
+#include "file_configuration.h"
+#include "pvt_log.h"
+
+using google::LogMessage;
+
+DEFINE_int32(batch_segments, 0, "If greater than 0, process the signal file in this number of parallel segments and exit");
+DEFINE_double(batch_warm_up_s, 40.0, "Seconds each batch segment starts before the previous one ends, to lock the signals");
+DEFINE_int32(batch_parallel, 0, "Batch segments processed at the same time (0: one per core)");
+DEFINE_string(batch_output_dir, "./batch", "Directory of the batch segment outputs and of the merged PVT log");
+
+DECLARE_string(config_file);
+DECLARE_string(log_dir);
+DECLARE_string(signal_source);
+
+
+std::vector<Batch_Segment> batch_segments(double duration_s, unsigned int n_segments, double warm_up_s)
+{
+    std::vector<Batch_Segment> segments;
+    if (n_segments == 0 || duration_s <= 0.0)
+        {
+            return segments;
+        }
+    double length = duration_s / static_cast<double>(n_segments);
+    for (unsigned int n = 0; n < n_segments; n++)
+        {
+            Batch_Segment segment;
+            segment.seconds_to_skip = std::max(0.0, n * length - warm_up_s);
+            segment.seconds = (n + 1) * length - segment.seconds_to_skip;
+            segments.push_back(segment);
+        }
+    return segments;
+}
+
+
+double capture_duration_s(ConfigurationInterface* configuration, const std::string& signal_filename, double& items_per_second)
+{
+    namespace fs = boost::filesystem;
+    std::string item_type = configuration->property("SignalSource.item_type", std::string("short"));
+    std::map<std::string, unsigned int> item_sizes = {{"gr_complex", 8}, {"float", 4}, {"short", 2}, {"ishort", 2}, {"byte", 1}, {"ibyte", 1}};
+    unsigned int item_size = item_sizes.count(item_type) ? item_sizes[item_type] : 8;
+    bool is_complex = (item_type == "ishort" || item_type == "ibyte");
+    double sampling_frequency = configuration->property("SignalSource.sampling_frequency", 0.0);
+    items_per_second = sampling_frequency * (is_complex ? 2.0 : 1.0);
+    long header_items = configuration->property("SignalSource.header_size", 0);
+    boost::system::error_code ec;
+    double file_items = static_cast<double>(fs::file_size(signal_filename, ec) / item_size) - header_items;
+    if (ec || items_per_second <= 0.0 || file_items <= 0.0)
+        {
+            return 0.0;
+        }
+    // leave out the last 2 ms, as File_Signal_Source does
+    return file_items / items_per_second - 0.002;
+}
+
+
+namespace
+{
+    // Runs one segment in the child process, it never returns
+    void run_segment(const Batch_Segment & segment, const std::string & directory, const std::string & signal_filename, double items_per_second)
+    {
+        int status = 1;
+        try
+        {
+                if (chdir(directory.c_str()) != 0 || !std::freopen("gnss-sdr.out", "w", stdout))
+                    {
+                        std::_Exit(status);
+                    }
+                FLAGS_log_dir = directory + "/";
+                std::shared_ptr<FileConfiguration> configuration = std::make_shared<FileConfiguration>(FLAGS_config_file);
+                std::stringstream seconds_to_skip;
+                seconds_to_skip.precision(17);
+                seconds_to_skip << segment.seconds_to_skip;
+                configuration->set_property("SignalSource.filename", signal_filename);
+                configuration->set_property("SignalSource.seconds_to_skip", seconds_to_skip.str());
+                configuration->set_property("SignalSource.samples", std::to_string(static_cast<unsigned long long>(std::ceil(segment.seconds * items_per_second))));
+                configuration->set_property("SignalSource.repeat", "false");
+                configuration->set_property("SignalSource.enable_throttle_control", "false");
+                configuration->set_property("PVT.pvt_log_filename", directory + "/PVT_log.dat");
+                // the segments run at once: nothing may be shared between them
+                configuration->set_property("PVT.flag_nmea_tty_port", "false");
+                configuration->set_property("PVT.flag_rtcm_server", "false");
+                configuration->set_property("PVT.flag_rtcm_tty_port", "false");
+                configuration->set_property("PVT.telemetry_address", "");
+                std::unique_ptr<ControlThread> control_thread(new ControlThread(configuration));
+                control_thread->run();
+                status = 0;
+        }
+        catch (const std::exception & e)
+        {
+                std::cerr << "Batch segment in " << directory << " failed: " << e.what() << std::endl;
+        }
+        std::cout << std::flush;
+        std::_Exit(status);
+    }
+}
+
+
+int run_batch_replay()
+{
+    namespace fs = boost::filesystem;
+    std::string config_file = fs::absolute(FLAGS_config_file).string();
+    FLAGS_config_file = config_file;
+    FileConfiguration configuration(config_file);
+    if (configuration.property("SignalSource.implementation", std::string("")) != "File_Signal_Source")
+        {
+            std::cout << "Batch mode needs SignalSource.implementation=File_Signal_Source" << std::endl;
+            return 1;
+        }
+    std::string signal_filename = configuration.property("SignalSource.filename", std::string("./example_capture.dat"));
+    if (FLAGS_signal_source.compare("-") != 0) signal_filename = FLAGS_signal_source;
+    signal_filename = fs::absolute(signal_filename).string();
+
+    double items_per_second = 0.0;
+    double duration_s = capture_duration_s(&configuration, signal_filename, items_per_second);
+    if (duration_s <= 0.0)
+        {
+            std::cout << "Unable to find the length of " << signal_filename << std::endl;
+            return 1;
+        }
+    boost::system::error_code ec;
+
+    std::vector<Batch_Segment> segments = batch_segments(duration_s, FLAGS_batch_segments, FLAGS_batch_warm_up_s);
+    unsigned int parallel = FLAGS_batch_parallel > 0 ? FLAGS_batch_parallel : std::max(1u, boost::thread::hardware_concurrency());
+    fs::path output_dir = fs::absolute(FLAGS_batch_output_dir);
+    std::cout << "Batch processing " << duration_s << " [s] of " << signal_filename << " in " << segments.size()
+              << " segments, " << parallel << " at a time" << std::endl;
+
+    std::vector<std::string> directories;
+    std::map<pid_t, unsigned int> running;
+    unsigned int failed = 0;
+    for (unsigned int n = 0; n < segments.size() || !running.empty(); )
+        {
+            if (n < segments.size() && running.size() < parallel)
+                {
+                    fs::path directory = output_dir / ("segment_" + std::to_string(n));
+                    fs::create_directories(directory, ec);
+                    directories.push_back(directory.string());
+                    std::cout << std::flush;
+                    pid_t pid = fork();
+                    if (pid == 0)
+                        {
+                            run_segment(segments.at(n), directory.string(), signal_filename, items_per_second);
+                        }
+                    if (pid == -1)
+                        {
+                            LOG(WARNING) << "Unable to start batch segment " << n;
+                            failed++;
+                        }
+                    else
+                        {
+                            running[pid] = n;
+                            LOG(INFO) << "Batch segment " << n << " from " << segments.at(n).seconds_to_skip << " [s] started, pid " << pid;
+                        }
+                    n++;
+                    continue;
+                }
+            int status;
+            pid_t pid = wait(&status);
+            if (pid == -1)
+                {
+                    break;
+                }
+            if (running.count(pid))
+                {
+                    bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+                    std::cout << "Batch segment " << running[pid] << (ok ? " done" : " failed") << std::endl;
+                    if (!ok) failed++;
+                    running.erase(pid);
+                }
+        }
+
+    std::vector<std::string> logs;
+    for (unsigned int n = 0; n < directories.size(); n++)
+        {
+            logs.push_back(directories.at(n) + "/PVT_log.dat");
+        }
+    std::string merged_log = (output_dir / "PVT_log.dat").string();
+    int n_solutions = pvt_log_merge(logs, merged_log);
+    if (n_solutions < 0)
+        {
+            return 1;
+        }
+    pvt_log_to_text(merged_log, (output_dir / "PVT.kml").string(), (output_dir / "PVT.geojson").string(), (output_dir / "PVT.nmea").string());
+    std::cout << n_solutions << " PVT solutions merged into " << merged_log << std::endl;
+    return failed == 0 ? 0 : 1;
+}
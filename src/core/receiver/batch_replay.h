@@ -0,0 +1,77 @@
+/*!
+ * \file batch_replay.h
+ * \brief Processes a capture file faster than real time, as overlapping
+ * segments run by parallel receivers, and merges their PVT logs
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_BATCH_REPLAY_H_
+#define GNSS_SDR_BATCH_REPLAY_H_
+
+#include <string>
+#include <vector>
+
+class ConfigurationInterface;
+
+/*!
+ * \brief Part of the capture processed by one receiver. The first
+ * warm_up_s seconds give acquisition and tracking time to lock, and repeat
+ * the end of the previous segment.
+ */
+struct Batch_Segment
+{
+    double seconds_to_skip; //!< Start in the file, warm-up included [s]
+    double seconds;         //!< Length, warm-up included [s]
+};
+
+/*!
+ * \brief Splits duration_s seconds of signal into n_segments of the same
+ * length, each one starting warm_up_s before the previous one ends.
+ */
+std::vector<Batch_Segment> batch_segments(double duration_s, unsigned int n_segments, double warm_up_s);
+
+/*!
+ * \brief Seconds of signal in signal_filename, as File_Signal_Source reads
+ * it with the SignalSource.* values of configuration, and the items it
+ * reads per second. Returns 0 if the length can not be found.
+ */
+double capture_duration_s(ConfigurationInterface* configuration, const std::string& signal_filename, double& items_per_second);
+
+/*!
+ * \brief Runs the receiver of FLAGS_config_file on FLAGS_batch_segments
+ * segments of its File_Signal_Source, FLAGS_batch_parallel at a time.
+ *
+ * Every segment is a child process with its own flowgraph, working in
+ * FLAGS_batch_output_dir/segment_N, where it keeps all its outputs. Their
+ * PVT logs are merged by receiver time into FLAGS_batch_output_dir/PVT_log.dat,
+ * from which PVT.kml, PVT.geojson and PVT.nmea are written.
+ * \return 0 if every segment ended and the logs were merged, 1 otherwise.
+ */
+int run_batch_replay();
+
+#endif
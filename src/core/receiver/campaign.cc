@@ -0,0 +1,243 @@
+/*!
+ * \file campaign.cc
+ * \brief Manifest and summaries of a campaign of batch replays (campaign-runner)
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "campaign.h"
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <boost/filesystem.hpp>
+#include "pvt_log.h"
+
+
+namespace
+{
+    std::vector<std::string> split_list(const std::string & list, char separator)
+    {
+        std::vector<std::string> items;
+        std::stringstream list_stream(list);
+        std::string item;
+        while (std::getline(list_stream, item, separator))
+            {
+                if (!item.empty()) items.push_back(item);
+            }
+        return items;
+    }
+}
+
+
+bool campaign_expand_overrides(const std::string& overrides, std::vector<Campaign_Overrides>& combinations)
+{
+    std::vector<std::string> keys;
+    std::vector<std::vector<std::string> > values;
+    std::vector<std::string> parameters = split_list(overrides == "-" ? std::string("") : overrides, ';');
+    for (unsigned int i = 0; i < parameters.size(); i++)
+        {
+            std::string::size_type equal = parameters[i].find('=');
+            if (equal == std::string::npos || equal == 0 || split_list(parameters[i].substr(equal + 1), ',').empty())
+                {
+                    return false;
+                }
+            keys.push_back(parameters[i].substr(0, equal));
+            values.push_back(split_list(parameters[i].substr(equal + 1), ','));
+        }
+    std::vector<unsigned int> index(keys.size(), 0);
+    while (true)
+        {
+            Campaign_Overrides combination;
+            for (unsigned int i = 0; i < keys.size(); i++)
+                {
+                    combination.push_back(std::make_pair(keys[i], values[i][index[i]]));
+                }
+            combinations.push_back(combination);
+            unsigned int i = 0;
+            for (; i < keys.size(); i++)
+                {
+                    if (++index[i] < values[i].size()) break;
+                    index[i] = 0;
+                }
+            if (i == keys.size()) break;
+        }
+    return true;
+}
+
+
+std::string campaign_overrides_string(const Campaign_Overrides& overrides)
+{
+    std::string text;
+    for (unsigned int i = 0; i < overrides.size(); i++)
+        {
+            text += (i ? ";" : "") + overrides[i].first + "=" + overrides[i].second;
+        }
+    return text.empty() ? std::string("-") : text;
+}
+
+
+bool campaign_read_manifest(const std::string& filename, std::vector<Campaign_Job>& jobs, std::string& error)
+{
+    namespace fs = boost::filesystem;
+    std::ifstream manifest(filename.c_str());
+    if (!manifest)
+        {
+            error = "Unable to open " + filename;
+            return false;
+        }
+    std::string line;
+    unsigned int line_number = 0;
+    while (std::getline(manifest, line))
+        {
+            line_number++;
+            std::string::size_type comment = line.find('#');
+            std::stringstream fields(line.substr(0, comment));
+            std::string scenario, capture, config_file, onset, overrides("-"), extra;
+            if (!(fields >> scenario))
+                {
+                    continue;
+                }
+            std::vector<Campaign_Overrides> combinations;
+            if (!(fields >> capture >> config_file >> onset) || (fields >> overrides && fields >> extra)
+                    || !campaign_expand_overrides(overrides, combinations))
+                {
+                    error = "Line " + std::to_string(line_number) + " of " + filename + " is not \"scenario capture config_file onset_rx_time [overrides]\"";
+                    return false;
+                }
+            double onset_rx_time = -1.0;
+            if (onset != "-")
+                {
+                    std::stringstream onset_stream(onset);
+                    if (!(onset_stream >> onset_rx_time) || onset_rx_time < 0.0)
+                        {
+                            error = "Line " + std::to_string(line_number) + " of " + filename + ": the onset is not a receiver time of week";
+                            return false;
+                        }
+                }
+            for (unsigned int i = 0; i < combinations.size(); i++)
+                {
+                    Campaign_Job job;
+                    job.id = jobs.size();
+                    job.scenario = scenario;
+                    job.capture = fs::absolute(capture).string();
+                    job.config_file = fs::absolute(config_file).string();
+                    job.onset_rx_time = onset_rx_time;
+                    job.overrides = combinations[i];
+                    jobs.push_back(job);
+                }
+        }
+    return true;
+}
+
+
+bool campaign_read_pvt_log(const std::string& log_filename, double onset_rx_time, Campaign_Job_Result& result)
+{
+    Pvt_Log_Reader reader;
+    if (!reader.open(log_filename))
+        {
+            return false;
+        }
+    result.solutions = 0;
+    result.alarms = 0;
+    result.false_alarms = 0;
+    result.first_alarm_rx_time = -1.0;
+    result.detection_latency_s = -1.0;
+    const Pvt_Log_Record_Header* record;
+    while ((record = reader.next()) != 0)
+        {
+            if (Pvt_Log_Reader::as<Pvt_Log_Solution>(record, PVT_LOG_SOLUTION))
+                {
+                    result.solutions++;
+                }
+            const Pvt_Log_Alarm* alarm = Pvt_Log_Reader::as<Pvt_Log_Alarm>(record, PVT_LOG_ALARM);
+            if (alarm == 0)
+                {
+                    continue;
+                }
+            if (result.alarms == 0)
+                {
+                    result.first_alarm_rx_time = alarm->rx_time;
+                }
+            result.alarms++;
+            if (onset_rx_time < 0.0 || alarm->rx_time < onset_rx_time)
+                {
+                    result.false_alarms++;
+                }
+            else if (result.detection_latency_s < 0.0)
+                {
+                    result.detection_latency_s = alarm->rx_time - onset_rx_time;
+                }
+        }
+    return true;
+}
+
+
+std::vector<Campaign_Scenario_Summary> campaign_summaries(const std::vector<Campaign_Job>& jobs, const std::vector<Campaign_Job_Result>& results)
+{
+    std::vector<Campaign_Scenario_Summary> summaries;
+    std::map<std::string, unsigned int> index;
+    std::vector<double> latency_sums;
+    for (unsigned int n = 0; n < jobs.size() && n < results.size(); n++)
+        {
+            if (!index.count(jobs[n].scenario))
+                {
+                    index[jobs[n].scenario] = summaries.size();
+                    Campaign_Scenario_Summary summary = {jobs[n].scenario, 0, 0, 0, 0, 0, -1.0, -1.0, 0.0, 0.0, 0.0};
+                    summaries.push_back(summary);
+                    latency_sums.push_back(0.0);
+                }
+            unsigned int i = index[jobs[n].scenario];
+            Campaign_Scenario_Summary& summary = summaries[i];
+            const Campaign_Job_Result& result = results[n];
+            summary.jobs++;
+            if (!result.done)
+                {
+                    summary.failed++;
+                    continue;
+                }
+            summary.capture_s += result.capture_s;
+            summary.wall_s += result.wall_s;
+            summary.cpu_s += result.cpu_s;
+            summary.false_alarms += result.false_alarms;
+            if (jobs[n].onset_rx_time < 0.0)
+                {
+                    continue;
+                }
+            summary.attacks++;
+            if (result.detection_latency_s >= 0.0)
+                {
+                    summary.detected++;
+                    latency_sums[i] += result.detection_latency_s;
+                    summary.mean_latency_s = latency_sums[i] / summary.detected;
+                    if (result.detection_latency_s > summary.max_latency_s)
+                        {
+                            summary.max_latency_s = result.detection_latency_s;
+                        }
+                }
+        }
+    return summaries;
+}
@@ -0,0 +1,128 @@
+/*!
+ * \file campaign.h
+ * \brief Manifest and summaries of a campaign of batch replays (campaign-runner)
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_CAMPAIGN_H_
+#define GNSS_SDR_CAMPAIGN_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef std::vector<std::pair<std::string, std::string> > Campaign_Overrides;
+
+/*!
+ * \brief One run of the receiver in batch mode: a capture, a configuration
+ * and the values that replace some of the configuration
+ */
+struct Campaign_Job
+{
+    unsigned int id;
+    std::string scenario;
+    std::string capture;
+    std::string config_file;
+    double onset_rx_time;         //!< Receiver time of week the attack starts at [s], negative if there is no attack
+    Campaign_Overrides overrides;
+};
+
+/*!
+ * \brief What a job gave, from its PVT log and its process
+ */
+struct Campaign_Job_Result
+{
+    bool done;                    //!< The receiver ended and its PVT log was read
+    double capture_s;             //!< Seconds of signal in the capture
+    double wall_s;                //!< Elapsed time of the job on its node
+    double cpu_s;                 //!< CPU time of the receiver and of its batch segments
+    unsigned int solutions;
+    unsigned int alarms;
+    unsigned int false_alarms;    //!< Alarms raised before the onset, or all of them without an attack
+    double first_alarm_rx_time;   //!< Negative if no alarm was raised
+    double detection_latency_s;   //!< From the onset to the first later alarm, negative if not detected
+    Campaign_Job_Result() : done(false), capture_s(0.0), wall_s(0.0), cpu_s(0.0), solutions(0), alarms(0),
+            false_alarms(0), first_alarm_rx_time(-1.0), detection_latency_s(-1.0) {}
+};
+
+/*!
+ * \brief The jobs of a scenario, summed up
+ */
+struct Campaign_Scenario_Summary
+{
+    std::string scenario;
+    unsigned int jobs;
+    unsigned int failed;
+    unsigned int attacks;         //!< Jobs with an onset
+    unsigned int detected;        //!< Jobs with an onset and an alarm after it
+    unsigned int false_alarms;
+    double mean_latency_s;        //!< Of the detected jobs, negative if none
+    double max_latency_s;
+    double capture_s;
+    double wall_s;
+    double cpu_s;
+};
+
+/*!
+ * \brief Reads a campaign manifest. Every line that is not empty or a
+ * comment (#) is
+ *
+ *     scenario capture config_file onset_rx_time [overrides]
+ *
+ * separated by blanks, where onset_rx_time is - if the capture has no
+ * attack, and overrides is Key=value;Key=value (- for none). A key with
+ * several values, as Spoofing.A=a1,a2, gives a job for every
+ * combination of them. The capture and configuration paths are made
+ * absolute.
+ * \return false with the line in error if the manifest can not be read
+ */
+bool campaign_read_manifest(const std::string& filename, std::vector<Campaign_Job>& jobs, std::string& error);
+
+/*!
+ * \brief Every combination of the values of "A=a1,a2;B=b1,b2", false if a key has no values
+ */
+bool campaign_expand_overrides(const std::string& overrides, std::vector<Campaign_Overrides>& combinations);
+
+/*!
+ * \brief The overrides as Key=value;Key=value, - if there are none
+ */
+std::string campaign_overrides_string(const Campaign_Overrides& overrides);
+
+/*!
+ * \brief Fills the solutions, alarms and detection latency of result
+ * from the PVT log of a job
+ * \return false if the log can not be read
+ */
+bool campaign_read_pvt_log(const std::string& log_filename, double onset_rx_time, Campaign_Job_Result& result);
+
+/*!
+ * \brief Sums up the results of the jobs of every scenario, in the order of the manifest
+ */
+std::vector<Campaign_Scenario_Summary> campaign_summaries(const std::vector<Campaign_Job>& jobs, const std::vector<Campaign_Job_Result>& results);
+
+#endif
@@ -0,0 +1,71 @@
+/*!
+ * \file channel_event.h
+ * \brief Events published by the acquisition and tracking blocks to
+ * the channel state machine
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_CHANNEL_EVENT_H_
+#define GNSS_SDR_CHANNEL_EVENT_H_
+
+#include <pmt/pmt.h>
+
+/*!
+ * \brief Event of the "events" message port of the acquisition and
+ * tracking blocks, carried as a pmt long
+ */
+enum Channel_Event
+{
+    CHANNEL_EVENT_POSITIVE_ACQUISITION = 1,
+    CHANNEL_EVENT_NEGATIVE_ACQUISITION = 2,
+    CHANNEL_EVENT_LOSS_OF_LOCK = 3,
+    CHANNEL_EVENT_STOP_TRACKING = 4,
+    CHANNEL_EVENT_CHECKED = 5         //!< The APT checks of the auxiliary peak tracked passed
+};
+
+const int CHANNEL_EVENT_COUNT = 6; //!< Events are numbered from 1
+
+/*!
+ * \brief Payload of an event.
+ *
+ * The payloads are built once and shared by every block, as pmts are
+ * immutable, so that publishing an event copies a reference instead of
+ * allocating a new pmt. Receivers still read them with pmt::to_long.
+ */
+inline const pmt::pmt_t& channel_event_pmt(Channel_Event event)
+{
+    static const pmt::pmt_t payloads[CHANNEL_EVENT_COUNT] = {
+            pmt::from_long(0),
+            pmt::from_long(CHANNEL_EVENT_POSITIVE_ACQUISITION),
+            pmt::from_long(CHANNEL_EVENT_NEGATIVE_ACQUISITION),
+            pmt::from_long(CHANNEL_EVENT_LOSS_OF_LOCK),
+            pmt::from_long(CHANNEL_EVENT_STOP_TRACKING),
+            pmt::from_long(CHANNEL_EVENT_CHECKED) };
+    return payloads[event];
+}
+
+#endif
@@ -34,8 +34,11 @@
 #ifndef GNSS_SDR_CONCURRENT_MAP_H
 #define GNSS_SDR_CONCURRENT_MAP_H
 
+#include <functional>
 #include <map>
+#include <memory>
 #include <utility>
+#include <vector>
 #include <boost/thread/mutex.hpp>
 
 template<typename Data>
@@ -44,14 +47,37 @@ template<typename Data>
 /*!
  * \brief This class implements a thread-safe std::map
  *
+ * Watchers are called with the key and the data of every write() and
+ * add(), in the writing thread, once the map has been updated and
+ * unlocked.
  */
 class concurrent_map
 {
     typedef typename std::map<int,Data>::iterator Data_iterator; // iterator is scope dependent
+public:
+    typedef std::function<void(int, Data const&)> Watcher;
 private:
     std::map<int,Data> the_map;
     boost::mutex the_mutex;
+    std::shared_ptr<const std::vector<Watcher>> the_watchers; // replaced, never modified
+
+    void notify(std::shared_ptr<const std::vector<Watcher>> const& watchers, int key, Data const& data)
+    {
+        for (typename std::vector<Watcher>::const_iterator it = watchers->begin(); it != watchers->end(); ++it)
+            {
+                (*it)(key, data);
+            }
+    }
 public:
+    void watch(Watcher watcher)
+    {
+        boost::mutex::scoped_lock lock(the_mutex);
+        std::shared_ptr<std::vector<Watcher>> watchers = the_watchers ?
+                std::make_shared<std::vector<Watcher>>(*the_watchers) : std::make_shared<std::vector<Watcher>>();
+        watchers->push_back(watcher);
+        the_watchers = watchers;
+    }
+
     void write(int key, Data const& data)
     {
         boost::mutex::scoped_lock lock(the_mutex);
@@ -65,14 +91,18 @@ public:
             {
                 the_map.insert(std::pair<int, Data>(key, data)); // insert SILENTLY fails if the item already exists in the map!
             }
+        std::shared_ptr<const std::vector<Watcher>> watchers = the_watchers;
         lock.unlock();
+        if (watchers) notify(watchers, key, data);
     }
 
     void add(int key, Data const& data)
     {
         boost::mutex::scoped_lock lock(the_mutex);
         the_map[key] = data;
+        std::shared_ptr<const std::vector<Watcher>> watchers = the_watchers;
         lock.unlock();
+        if (watchers) notify(watchers, key, data);
     }
 
     void remove(int key)
@@ -0,0 +1,324 @@
+/*!
+ * \file concurrent_ring_queue.h
+ * \brief Interface of lock-free, fixed-capacity queues with batch draining
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_CONCURRENT_RING_QUEUE_H
+#define GNSS_SDR_CONCURRENT_RING_QUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <boost/thread.hpp>
+
+/*!
+ * \brief Sleeping consumer of a lock-free queue.
+ *
+ * The producers only take the lock when the consumer is waiting, so a
+ * queue whose consumer polls never locks. The consumer registers itself
+ * under the lock before checking the queue a last time, and a producer
+ * that sees it after its push notifies it under the same lock, so the
+ * wakeup is not lost.
+ */
+class concurrent_ring_waiter
+{
+private:
+    std::atomic<int> the_sleepers;
+    boost::mutex the_mutex;
+    boost::condition_variable the_condition_variable;
+public:
+    concurrent_ring_waiter() : the_sleepers(0)
+    {}
+
+    //! Called by the producers after each push
+    void notify()
+    {
+        // orders the push before the load, against the consumer's
+        // registration before its last check
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(the_sleepers.load(std::memory_order_relaxed) > 0)
+            {
+                boost::mutex::scoped_lock lock(the_mutex);
+                the_condition_variable.notify_one();
+            }
+    }
+
+    //! Waits up to timeout for ready() to be true
+    template<typename Ready>
+    void wait(Ready ready, boost::posix_time::time_duration const& timeout)
+    {
+        boost::mutex::scoped_lock lock(the_mutex);
+        the_sleepers.fetch_add(1, std::memory_order_seq_cst);
+        if(!ready())
+            {
+                the_condition_variable.timed_wait(lock, timeout);
+            }
+        the_sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+};
+
+
+/*!
+ * \brief Single-producer, single-consumer queue of fixed capacity
+ *
+ * A ring of a power of two elements, allocated once, with one index for
+ * each side. push() and try_pop() move the elements and take two atomic
+ * loads and a store; when the queue is full, push() drops the new element
+ * and counts it. The consumer takes all the queued elements at once with
+ * pop_all() or wait_and_pop_all().
+ */
+template<typename Data>
+class concurrent_spsc_queue
+{
+private:
+    std::unique_ptr<Data[]> the_ring;
+    size_t the_mask;
+    std::atomic<size_t> the_head; // next element to pop, written by the consumer
+    std::atomic<size_t> the_tail; // next element to push, written by the producer
+    std::atomic<unsigned long> the_dropped;
+    concurrent_ring_waiter the_waiter;
+public:
+    concurrent_spsc_queue(size_t capacity = 1024) : the_head(0), the_tail(0), the_dropped(0)
+    {
+        size_t size = 1;
+        while(size < capacity) size <<= 1;
+        the_ring.reset(new Data[size]);
+        the_mask = size - 1;
+    }
+
+    /*!
+     * \brief Returns false, and drops data, if the queue is full
+     */
+    bool push(Data data)
+    {
+        size_t tail = the_tail.load(std::memory_order_relaxed);
+        if(tail - the_head.load(std::memory_order_acquire) > the_mask)
+            {
+                the_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        the_ring[tail & the_mask] = std::move(data);
+        the_tail.store(tail + 1, std::memory_order_release);
+        the_waiter.notify();
+        return true;
+    }
+
+    bool empty() const
+    {
+        return the_head.load(std::memory_order_relaxed) == the_tail.load(std::memory_order_acquire);
+    }
+
+    bool try_pop(Data& popped_value)
+    {
+        size_t head = the_head.load(std::memory_order_relaxed);
+        if(head == the_tail.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+        popped_value = std::move(the_ring[head & the_mask]);
+        the_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*!
+     * \brief Appends all the queued elements to batch, returns how many
+     */
+    size_t pop_all(std::vector<Data>& batch)
+    {
+        size_t head = the_head.load(std::memory_order_relaxed);
+        size_t tail = the_tail.load(std::memory_order_acquire);
+        for(size_t i = head; i != tail; i++)
+            {
+                batch.push_back(std::move(the_ring[i & the_mask]));
+            }
+        the_head.store(tail, std::memory_order_release);
+        return tail - head;
+    }
+
+    /*!
+     * \brief Like pop_all, but waits up to timeout for the queue to be non-empty
+     */
+    size_t wait_and_pop_all(std::vector<Data>& batch, boost::posix_time::time_duration const& timeout)
+    {
+        if(empty())
+            {
+                the_waiter.wait([this]() { return !empty(); }, timeout);
+            }
+        return pop_all(batch);
+    }
+
+    /*!
+     * \brief Number of elements dropped because the queue was full
+     */
+    unsigned long dropped() const
+    {
+        return the_dropped.load(std::memory_order_relaxed);
+    }
+};
+
+
+/*!
+ * \brief Multiple-producer, single-consumer queue of fixed capacity
+ *
+ * Like concurrent_spsc_queue, but any number of threads can push. Each
+ * element of the ring carries a sequence number: a producer claims an
+ * element with a compare-and-swap on the tail, moves the data in and
+ * publishes it through its sequence, so the consumer never sees an element
+ * that is still being written. Only one thread may pop at a time.
+ */
+template<typename Data>
+class concurrent_mpsc_queue
+{
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        Data data;
+    };
+    std::unique_ptr<Cell[]> the_ring;
+    size_t the_mask;
+    std::atomic<size_t> the_head; // next element to pop, written by the consumer
+    std::atomic<size_t> the_tail; // next element to claim, shared by the producers
+    std::atomic<unsigned long> the_dropped;
+    concurrent_ring_waiter the_waiter;
+public:
+    concurrent_mpsc_queue(size_t capacity = 1024) : the_head(0), the_tail(0), the_dropped(0)
+    {
+        size_t size = 1;
+        while(size < capacity) size <<= 1;
+        the_ring.reset(new Cell[size]);
+        the_mask = size - 1;
+        for(size_t i = 0; i < size; i++)
+            {
+                the_ring[i].sequence.store(i, std::memory_order_relaxed);
+            }
+    }
+
+    /*!
+     * \brief Returns false, and drops data, if the queue is full
+     */
+    bool push(Data data)
+    {
+        size_t tail = the_tail.load(std::memory_order_relaxed);
+        Cell* cell;
+        while(true)
+            {
+                cell = &the_ring[tail & the_mask];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                long diff = static_cast<long>(sequence) - static_cast<long>(tail);
+                if(diff == 0)
+                    {
+                        if(the_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+                            {
+                                break;
+                            }
+                    }
+                else if(diff < 0)
+                    {
+                        // the consumer has not freed this element yet
+                        the_dropped.fetch_add(1, std::memory_order_relaxed);
+                        return false;
+                    }
+                else
+                    {
+                        tail = the_tail.load(std::memory_order_relaxed);
+                    }
+            }
+        cell->data = std::move(data);
+        cell->sequence.store(tail + 1, std::memory_order_release);
+        the_waiter.notify();
+        return true;
+    }
+
+    bool empty() const
+    {
+        size_t head = the_head.load(std::memory_order_relaxed);
+        return the_ring[head & the_mask].sequence.load(std::memory_order_acquire) != head + 1;
+    }
+
+    bool try_pop(Data& popped_value)
+    {
+        size_t head = the_head.load(std::memory_order_relaxed);
+        Cell& cell = the_ring[head & the_mask];
+        if(cell.sequence.load(std::memory_order_acquire) != head + 1)
+            {
+                return false;
+            }
+        popped_value = std::move(cell.data);
+        cell.sequence.store(head + the_mask + 1, std::memory_order_release);
+        the_head.store(head + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /*!
+     * \brief Appends all the queued elements to batch, returns how many
+     *
+     * It stops at the first element still being written by its producer.
+     */
+    size_t pop_all(std::vector<Data>& batch)
+    {
+        size_t n = 0;
+        size_t head = the_head.load(std::memory_order_relaxed);
+        while(true)
+            {
+                Cell& cell = the_ring[head & the_mask];
+                if(cell.sequence.load(std::memory_order_acquire) != head + 1)
+                    {
+                        break;
+                    }
+                batch.push_back(std::move(cell.data));
+                cell.sequence.store(head + the_mask + 1, std::memory_order_release);
+                head++;
+                n++;
+            }
+        the_head.store(head, std::memory_order_relaxed);
+        return n;
+    }
+
+    /*!
+     * \brief Like pop_all, but waits up to timeout for the queue to be non-empty
+     */
+    size_t wait_and_pop_all(std::vector<Data>& batch, boost::posix_time::time_duration const& timeout)
+    {
+        if(empty())
+            {
+                the_waiter.wait([this]() { return !empty(); }, timeout);
+            }
+        return pop_all(batch);
+    }
+
+    /*!
+     * \brief Number of elements dropped because the queue was full
+     */
+    unsigned long dropped() const
+    {
+        return the_dropped.load(std::memory_order_relaxed);
+    }
+};
+#endif
@@ -0,0 +1,143 @@
+/*!
+ * \file concurrent_snapshot_map.h
+ * \brief Interface of a read-mostly, versioned thread-safe std::map
+ * \authors <ul>
+ *         <li> Javier Arribas, 2011. jarribas(at)cttc.es
+ *         <li> Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *          </ul>
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_CONCURRENT_SNAPSHOT_MAP_H
+#define GNSS_SDR_CONCURRENT_SNAPSHOT_MAP_H
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <boost/thread/mutex.hpp>
+
+template<typename Data>
+
+
+/*!
+ * \brief This class implements a thread-safe std::map optimized for
+ * many concurrent readers and few writers.
+ *
+ * It offers the same interface as concurrent_map, plus get_snapshot(),
+ * which returns a reference-counted, immutable view of the whole map
+ * without copying it. Writers are serialized by a mutex, build the new
+ * version of the map aside and publish it with an atomic pointer swap
+ * (RCU-style), so readers never block writers nor each other. A snapshot
+ * stays valid, and unchanged, for as long as the reader holds it.
+ */
+class concurrent_snapshot_map
+{
+public:
+    typedef std::map<int,Data> Data_map;
+    typedef std::shared_ptr<const Data_map> Snapshot;
+
+    concurrent_snapshot_map() : the_snapshot(std::make_shared<const Data_map>())
+    {}
+
+    void write(int key, Data const& data)
+    {
+        boost::mutex::scoped_lock lock(the_mutex);
+        std::shared_ptr<Data_map> next = std::make_shared<Data_map>(*current());
+        (*next)[key] = data; // update or insert
+        publish(next);
+        lock.unlock();
+    }
+
+    void add(int key, Data const& data)
+    {
+        write(key, data);
+    }
+
+    void remove(int key)
+    {
+        boost::mutex::scoped_lock lock(the_mutex);
+        Snapshot now = current();
+        if (now->find(key) == now->end())
+            {
+                // nothing to do, do not publish a new version
+                lock.unlock();
+                return;
+            }
+        std::shared_ptr<Data_map> next = std::make_shared<Data_map>(*now);
+        next->erase(key);
+        publish(next);
+        lock.unlock();
+    }
+
+    /*!
+     * \brief Returns an immutable view of the current version of the map.
+     */
+    Snapshot get_snapshot() const
+    {
+        return current();
+    }
+
+    std::map<int,Data> get_map_copy() const
+    {
+        return *current();
+    }
+
+    size_t size() const
+    {
+        return current()->size();
+    }
+
+    bool read(int key, Data& p_data) const
+    {
+        Snapshot now = current();
+        typename Data_map::const_iterator data_iter = now->find(key);
+        if (data_iter != now->end())
+            {
+                p_data = data_iter->second;
+                return true;
+            }
+        else
+            {
+                return false;
+            }
+    }
+
+private:
+    Snapshot current() const
+    {
+        return std::atomic_load(&the_snapshot);
+    }
+
+    void publish(std::shared_ptr<Data_map> const& next)
+    {
+        std::atomic_store(&the_snapshot, Snapshot(next));
+    }
+
+    Snapshot the_snapshot;
+    boost::mutex the_mutex;
+};
+
+#endif
@@ -0,0 +1,239 @@
+/*!
+ * \file concurrent_subframe_map.h
+ * \brief Interface of a thread-safe subframe store indexed by channel uid,
+ * satellite PRN and subframe id
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_CONCURRENT_SUBFRAME_MAP_H
+#define GNSS_SDR_CONCURRENT_SUBFRAME_MAP_H
+
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
+#include <boost/thread/mutex.hpp>
+#include "spoofing_subframe.h"
+
+typedef std::shared_ptr<const Subframe> Subframe_ptr;
+
+/*!
+ * \brief Last subframes of all the peaks (channels) tracking one satellite.
+ *
+ * earliest and latest point to the subframes with the smallest and the
+ * largest reception timestamp, and are kept up to date on every update.
+ */
+struct Prn_subframes
+{
+    std::map<int, Subframe_ptr> channels; // uid -> last subframe
+    Subframe_ptr earliest;
+    Subframe_ptr latest;
+};
+
+/*!
+ * \brief One immutable version of the subframe store.
+ */
+struct Subframe_index
+{
+    std::map<int, Subframe_ptr> by_uid;
+    std::map<unsigned int, Prn_subframes> by_prn;
+    std::map<unsigned int, std::set<int> > by_subframe_id; // subframe id -> uids
+};
+
+
+/*!
+ * \brief This class implements a thread-safe store of the last subframe
+ * received by each channel.
+ *
+ * Besides the lookup by channel uid offered by concurrent_map, it keeps a
+ * secondary index by satellite PRN (with the earliest and latest reception
+ * time of each satellite) and by subframe id, so that the APT checks only
+ * visit the channels of one satellite. Like concurrent_snapshot_map, readers
+ * get an immutable, reference-counted snapshot and writers publish a new
+ * version with an atomic pointer swap. Subframes are shared between
+ * versions, so publishing does not copy the subframe payloads.
+ */
+class concurrent_subframe_map
+{
+public:
+    typedef std::shared_ptr<const Subframe_index> Snapshot;
+
+    concurrent_subframe_map() : the_snapshot(std::make_shared<const Subframe_index>())
+    {}
+
+    void write(int key, Subframe const& data)
+    {
+        boost::mutex::scoped_lock lock(the_mutex);
+        std::shared_ptr<Subframe_index> next = std::make_shared<Subframe_index>(*current());
+        erase(*next, key);
+        Subframe_ptr subframe = std::make_shared<const Subframe>(data);
+        next->by_uid[key] = subframe;
+        next->by_subframe_id[data.subframe_id].insert(key);
+        Prn_subframes& prn = next->by_prn[data.PRN];
+        prn.channels[key] = subframe;
+        if (!prn.earliest || subframe->timestamp < prn.earliest->timestamp)
+            {
+                prn.earliest = subframe;
+            }
+        if (!prn.latest || subframe->timestamp > prn.latest->timestamp)
+            {
+                prn.latest = subframe;
+            }
+        publish(next);
+        lock.unlock();
+    }
+
+    void add(int key, Subframe const& data)
+    {
+        write(key, data);
+    }
+
+    void remove(int key)
+    {
+        boost::mutex::scoped_lock lock(the_mutex);
+        Snapshot now = current();
+        if (now->by_uid.find(key) == now->by_uid.end())
+            {
+                // nothing to do, do not publish a new version
+                lock.unlock();
+                return;
+            }
+        std::shared_ptr<Subframe_index> next = std::make_shared<Subframe_index>(*now);
+        erase(*next, key);
+        publish(next);
+        lock.unlock();
+    }
+
+    /*!
+     * \brief Returns an immutable view of the current version of the store.
+     */
+    Snapshot get_snapshot() const
+    {
+        return current();
+    }
+
+    std::map<int,Subframe> get_map_copy() const
+    {
+        Snapshot now = current();
+        std::map<int,Subframe> map_aux;
+        for (std::map<int, Subframe_ptr>::const_iterator it = now->by_uid.begin(); it != now->by_uid.end(); ++it)
+            {
+                map_aux[it->first] = *it->second;
+            }
+        return map_aux;
+    }
+
+    size_t size() const
+    {
+        return current()->by_uid.size();
+    }
+
+    bool read(int key, Subframe& p_data) const
+    {
+        Snapshot now = current();
+        std::map<int, Subframe_ptr>::const_iterator data_iter = now->by_uid.find(key);
+        if (data_iter != now->by_uid.end())
+            {
+                p_data = *data_iter->second;
+                return true;
+            }
+        else
+            {
+                return false;
+            }
+    }
+
+private:
+    /*
+     * Removes the subframe of channel key from all the indexes of index.
+     * Only the channels of the affected satellite are visited.
+     */
+    static void erase(Subframe_index& index, int key)
+    {
+        std::map<int, Subframe_ptr>::iterator uid_iter = index.by_uid.find(key);
+        if (uid_iter == index.by_uid.end())
+            {
+                return;
+            }
+        Subframe_ptr old = uid_iter->second;
+        index.by_uid.erase(uid_iter);
+
+        std::map<unsigned int, std::set<int> >::iterator id_iter = index.by_subframe_id.find(old->subframe_id);
+        if (id_iter != index.by_subframe_id.end())
+            {
+                id_iter->second.erase(key);
+                if (id_iter->second.empty())
+                    {
+                        index.by_subframe_id.erase(id_iter);
+                    }
+            }
+
+        std::map<unsigned int, Prn_subframes>::iterator prn_iter = index.by_prn.find(old->PRN);
+        if (prn_iter == index.by_prn.end())
+            {
+                return;
+            }
+        Prn_subframes& prn = prn_iter->second;
+        prn.channels.erase(key);
+        if (prn.channels.empty())
+            {
+                index.by_prn.erase(prn_iter);
+                return;
+            }
+        if (prn.earliest == old || prn.latest == old)
+            {
+                prn.earliest.reset();
+                prn.latest.reset();
+                for (std::map<int, Subframe_ptr>::const_iterator it = prn.channels.begin(); it != prn.channels.end(); ++it)
+                    {
+                        if (!prn.earliest || it->second->timestamp < prn.earliest->timestamp)
+                            {
+                                prn.earliest = it->second;
+                            }
+                        if (!prn.latest || it->second->timestamp > prn.latest->timestamp)
+                            {
+                                prn.latest = it->second;
+                            }
+                    }
+            }
+    }
+
+    Snapshot current() const
+    {
+        return std::atomic_load(&the_snapshot);
+    }
+
+    void publish(std::shared_ptr<Subframe_index> const& next)
+    {
+        std::atomic_store(&the_snapshot, Snapshot(next));
+    }
+
+    Snapshot the_snapshot;
+    boost::mutex the_mutex;
+};
+
+#endif
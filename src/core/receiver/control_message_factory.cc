@@ -29,6 +29,7 @@
  */
 
 #include "control_message_factory.h"
+#include <chrono>
 #include <glog/logging.h>
 
 
@@ -49,7 +50,7 @@ boost::shared_ptr<gr::message> ControlMessageFactory::GetQueueMessage(unsigned i
     std::shared_ptr<ControlMessage> control_message = std::make_shared<ControlMessage>();
     control_message->who = who;
     control_message->what = what;
-    boost::shared_ptr<gr::message> queue_message = gr::message::make(0, 0, 0, sizeof(ControlMessage));
+    boost::shared_ptr<gr::message> queue_message = gr::message::make(0, Timestamp(), 0, sizeof(ControlMessage));
     memcpy(queue_message->msg(), control_message.get(), sizeof(ControlMessage));
     return queue_message;
 }
@@ -75,3 +76,7 @@ std::shared_ptr<std::vector<std::shared_ptr<ControlMessage>>>  ControlMessageFac
 }
 
 
+double ControlMessageFactory::Timestamp()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -58,8 +58,15 @@ public:
     //! Virtual destructor
     virtual ~ControlMessageFactory();
 
+    /*!
+     * \brief Makes the queue message of one control message. Its arg1 is the
+     * Timestamp() of the creation, for the latency of the control plane.
+     */
     boost::shared_ptr<gr::message> GetQueueMessage(unsigned int who, unsigned int what);
     std::shared_ptr<std::vector<std::shared_ptr<ControlMessage>>> GetControlMessages(gr::message::sptr queue_message);
+
+    //! Steady clock time [s], shared by all the threads
+    static double Timestamp();
 };
 
 #endif /*GNSS_SDR_CONTROL_MESSAGE_FACTORY_H_*/
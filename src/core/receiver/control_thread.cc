@@ -33,10 +33,18 @@
  */
 
 #include "control_thread.h"
+#include <sys/stat.h>
 #include <unistd.h>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
 #include <iostream>
 #include <map>
+#include <set>
 #include <string>
+#include <csignal>
+#include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/chrono.hpp>
 #include <gnuradio/message.h>
@@ -53,26 +61,48 @@
 #include "concurrent_queue.h"
 #include "concurrent_map.h"
 #include "gnss_flowgraph.h"
+#include "gps_ref_location.h"
+#include "gps_ref_time.h"
+#include "navigation_data_bus.h"
+#include "receiver_state.h"
 #include "file_configuration.h"
 #include "control_message_factory.h"
+#include "dump_writer.h"
+#include "flight_recorder.h"
+#include "thread_placement.h"
+#include "trace_log.h"
+#include "allocation_guard.h"
 
-extern concurrent_map<Gps_Acq_Assist> global_gps_acq_assist_map;
-extern concurrent_queue<Gps_Acq_Assist> global_gps_acq_assist_queue;
+// 1980-01-06 00:00:00 UTC
+#define CONTROL_THREAD_GPS_EPOCH_UNIX_S 315964800.0
+// GPS - UTC since 2015-07-01, only used by the visibility without assistance
+#define CONTROL_THREAD_GPS_UTC_LEAP_S 17.0
 
 using google::LogMessage;
 
 DEFINE_string(config_file, std::string(GNSSSDR_INSTALL_DIR "/share/gnss-sdr/conf/default.conf"),
         "File containing the configuration parameters");
 
-ControlThread::ControlThread()
+ControlThread::ControlThread() :
+        keyboard_(io_service_),
+        signals_(io_service_),
+        visibility_timer_(io_service_),
+        rinex_nav_timer_(io_service_),
+        realtime_margin_timer_(io_service_)
 {
     configuration_ = std::make_shared<FileConfiguration>(FLAGS_config_file);
+    config_file_ = FLAGS_config_file;
     delete_configuration_ = false;
     init();
 }
 
 
-ControlThread::ControlThread(std::shared_ptr<ConfigurationInterface> configuration)
+ControlThread::ControlThread(std::shared_ptr<ConfigurationInterface> configuration) :
+        keyboard_(io_service_),
+        signals_(io_service_),
+        visibility_timer_(io_service_),
+        rinex_nav_timer_(io_service_),
+        realtime_margin_timer_(io_service_)
 {
     configuration_ = configuration;
     delete_configuration_ = false;
@@ -85,6 +115,30 @@ ControlThread::~ControlThread()
 {
     // save navigation data to files
    // if (save_assistance_to_XML() == true) {}
+    stop_async_log();
+}
+
+
+void ControlThread::set_trace_levels()
+{
+    for (int module = 0; module < TRACE_MODULES; module++)
+        {
+            Trace_Module trace_module = static_cast<Trace_Module>(module);
+            set_trace_log_level(trace_module, configuration_->property(std::string("Receiver.trace_") + trace_module_name(trace_module), 0));
+        }
+}
+
+
+void ControlThread::set_allocation_guard()
+{
+    std::string hot = configuration_->property("Receiver.allocation_guard_hot", std::string(""));
+    if (!hot.empty() && !allocation_guard_compiled())
+        {
+            LOG(WARNING) << "Receiver.allocation_guard_hot needs a build with ENABLE_ALLOCATION_GUARD=ON, the allocations are not counted";
+        }
+    set_allocation_guard_hot(hot);
+    set_allocation_guard_warmup_calls(configuration_->property("Receiver.allocation_guard_warmup_calls", 1000));
+    set_allocation_guard_abort(configuration_->property("Receiver.allocation_guard_abort", false));
 }
 
 
@@ -94,8 +148,7 @@ ControlThread::~ControlThread()
  * This is the main loop that reads and process the control messages
  * 1- Connect the GNSS receiver flowgraph
  * 2- Start the GNSS receiver flowgraph
- *    while (flowgraph_->running() && !stop)_{
- * 3- Read control messages and process them }
+ * 3- Handle the control events in the io_service until stop_
  */
 void ControlThread::run()
 {
@@ -110,8 +163,16 @@ void ControlThread::run()
             LOG(ERROR) << "Unable to connect flowgraph";
             return;
         }
-    // Start the flowgraph
+    // Start the flowgraph, its block threads are placed by the flowgraph and not pinned with the control
+    if (!control_cpus_.empty())
+        {
+            set_current_thread_affinity(unplaced_cpus_);
+        }
     flowgraph_->start();
+    if (!control_cpus_.empty())
+        {
+            set_current_thread_affinity(control_cpus_);
+        }
     if (flowgraph_->running())
         {
             LOG(INFO) << "Flowgraph started";
@@ -122,29 +183,73 @@ void ControlThread::run()
             return;
         }
 
+    io_service_.reset();
+    // run() returns only when stopped, even while no event is pending
+    boost::asio::io_service::work work(io_service_);
+
     //launch GNSS assistance process AFTER the flowgraph is running because the GNURadio asynchronous queues must be already running to transport msgs
     assist_GNSS();
-    // start the keyboard_listener thread
-    keyboard_thread_ = boost::thread(&ControlThread::keyboard_listener, this);
+    if (rinex_nav_)
+        {
+            poll_rinex_nav();
+        }
+    if (visibility_enabled_)
+        {
+            update_visibility();
+        }
+    if (realtime_margin_monitor_)
+        {
+            check_realtime_margin();
+        }
+    start_keyboard_listener();
+    signals_.add(SIGINT);
+    signals_.add(SIGTERM);
+    signals_.add(SIGHUP);
+    signals_.async_wait(boost::bind(&ControlThread::signal_received, this, _1, _2));
+    control_queue_thread_ = boost::thread(&ControlThread::read_control_messages, this);
+    // without a port nor a period it only logs the counters at the stop
+    metrics_exporter_ = std::make_shared<Metrics_Exporter>(io_service_,
+            configuration_->property("Receiver.metrics_address", std::string("127.0.0.1")),
+            configuration_->property("Receiver.metrics_port", static_cast<unsigned short>(0)),
+            configuration_->property("Receiver.metrics_dump_s", 0.0));
+    metrics_exporter_->start();
+    // the blocks, the assistance and the control have read their configuration by now
+    report_unread_properties();
 
-    // Main loop to read and process the control messages
-    while (flowgraph_->running() && !stop_)
+    // Main loop to handle the control events
+    if (!stop_)
         {
-            //TODO re-enable the blocking read messages functions and fork the process
-            read_control_messages();
-            if (control_messages_ != 0) process_control_messages();
+            io_service_.run();
         }
     std::cout << "Stopping GNSS-SDR, please wait!" << std::endl;
     flowgraph_->stop();
     stop_ = true;
 
-    //Join keyboard thread
-#ifdef OLD_BOOST
-    keyboard_thread_.timed_join(boost::posix_time::seconds(1));
-#endif
-#ifndef OLD_BOOST
-    keyboard_thread_.try_join_until(boost::chrono::steady_clock::now() + boost::chrono::milliseconds(1000));
-#endif
+    // wake the control queue thread up; the messages it still posts are dropped
+    control_queue_->handle(control_message_factory_->GetQueueMessage(200, 0));
+    control_queue_thread_.join();
+    boost::system::error_code error;
+    keyboard_.close(error);
+    signals_.clear(error);
+    visibility_timer_.cancel(error);
+    rinex_nav_timer_.cancel(error);
+    realtime_margin_timer_.cancel(error);
+    metrics_exporter_->stop();
+    if (block_metrics_enabled())
+        {
+            LOG(INFO) << metrics_exporter_->dump();
+        }
+
+    const char* event_names[EVENT_KINDS] = {"control messages", "acquisition assistance", "keys", "signals", "timers"};
+    for (int kind = 0; kind < EVENT_KINDS; kind++)
+        {
+            if (event_latency_[kind].events > 0)
+                {
+                    LOG(INFO) << "Control plane handled " << event_latency_[kind].events << " " << event_names[kind]
+                              << ", latency mean " << event_latency_[kind].mean_s() * 1e6
+                              << " us, max " << event_latency_[kind].max_s * 1e6 << " us";
+                }
+        }
 
     LOG(INFO) << "Flowgraph stopped";
 }
@@ -164,8 +269,106 @@ void ControlThread::set_control_queue(boost::shared_ptr<gr::msg_queue> control_q
 /*
  * Returns true if reading was successful
  */
+bool ControlThread::read_assistance_from_snapshot()
+{
+    std::string snapshot_filename = configuration_->property("GNSS-SDR.SUPL_gps_assistance_snapshot", assistance_default_snapshot_filename);
+    std::string eph_xml_filename = configuration_->property("GNSS-SDR.SUPL_gps_ephemeris_xml", eph_default_xml_filename);
+    struct stat snapshot_status;
+    struct stat xml_status;
+    if (snapshot_filename.empty() || stat(snapshot_filename.c_str(), &snapshot_status) != 0)
+        {
+            return false;
+        }
+    if (stat(eph_xml_filename.c_str(), &xml_status) == 0 && xml_status.st_mtime > snapshot_status.st_mtime)
+        {
+            // edited or exported after the snapshot: the XML files win
+            LOG(INFO) << "SUPL: " << eph_xml_filename << " is newer than " << snapshot_filename;
+            return false;
+        }
+    double age_s = 0.0;
+    if (supl_client_ephemeris_.load_assistance_snapshot(snapshot_filename, &age_s) == false || supl_client_ephemeris_.gps_ephemeris_map.empty())
+        {
+            return false;
+        }
+    std::cout << "SUPL: Read GPS assistance snapshot " << snapshot_filename << ", written " << age_s << " s ago" << std::endl;
+    std::map<int,Gps_Ephemeris>::iterator gps_eph_iter;
+    for(gps_eph_iter = supl_client_ephemeris_.gps_ephemeris_map.begin();
+            gps_eph_iter != supl_client_ephemeris_.gps_ephemeris_map.end();
+            gps_eph_iter++)
+        {
+            std::shared_ptr<const Gps_Ephemeris> tmp_obj = std::make_shared<const Gps_Ephemeris>(gps_eph_iter->second);
+            flowgraph_->send_telemetry_msg(pmt::make_any(tmp_obj));
+        }
+    // Only use {utc, iono, ref time, ref location} if SUPL is enabled, as with the XML files
+    if (configuration_->property("GNSS-SDR.SUPL_gps_enabled", false) == true)
+        {
+            supl_client_acquisition_.gps_utc = supl_client_ephemeris_.gps_utc;
+            supl_client_acquisition_.gps_iono = supl_client_ephemeris_.gps_iono;
+            supl_client_acquisition_.gps_time = supl_client_ephemeris_.gps_time;
+            supl_client_acquisition_.gps_ref_loc = supl_client_ephemeris_.gps_ref_loc;
+            if (supl_client_acquisition_.gps_utc.valid == true)
+                {
+                    std::shared_ptr<Gps_Utc_Model> tmp_obj = std::make_shared<Gps_Utc_Model>(supl_client_acquisition_.gps_utc);
+                    flowgraph_->send_telemetry_msg(pmt::make_any(tmp_obj));
+                }
+            if (supl_client_acquisition_.gps_iono.valid == true)
+                {
+                    std::shared_ptr<Gps_Iono> tmp_obj = std::make_shared<Gps_Iono>(supl_client_acquisition_.gps_iono);
+                    flowgraph_->send_telemetry_msg(pmt::make_any(tmp_obj));
+                }
+            if (supl_client_acquisition_.gps_time.valid == true)
+                {
+                    std::shared_ptr<Gps_Ref_Time> tmp_obj = std::make_shared<Gps_Ref_Time>(supl_client_acquisition_.gps_time);
+                    flowgraph_->send_telemetry_msg(pmt::make_any(tmp_obj));
+                }
+            if (supl_client_acquisition_.gps_ref_loc.valid == true)
+                {
+                    std::shared_ptr<Gps_Ref_Location> tmp_obj = std::make_shared<Gps_Ref_Location>(supl_client_acquisition_.gps_ref_loc);
+                    flowgraph_->send_telemetry_msg(pmt::make_any(tmp_obj));
+                }
+        }
+    return true;
+}
+
+
+void ControlThread::save_assistance_snapshot()
+{
+    std::string snapshot_filename = configuration_->property("GNSS-SDR.SUPL_gps_assistance_snapshot", assistance_default_snapshot_filename);
+    if (snapshot_filename.empty() || supl_client_ephemeris_.gps_ephemeris_map.empty())
+        {
+            return;
+        }
+    // the SUPL requests leave utc and iono in one client, ref time and location in the other
+    if (supl_client_ephemeris_.gps_utc.valid == false)
+        {
+            supl_client_ephemeris_.gps_utc = supl_client_acquisition_.gps_utc;
+        }
+    if (supl_client_ephemeris_.gps_iono.valid == false)
+        {
+            supl_client_ephemeris_.gps_iono = supl_client_acquisition_.gps_iono;
+        }
+    if (supl_client_acquisition_.gps_time.valid == true)
+        {
+            supl_client_ephemeris_.gps_time = supl_client_acquisition_.gps_time;
+        }
+    if (supl_client_acquisition_.gps_ref_loc.valid == true)
+        {
+            supl_client_ephemeris_.gps_ref_loc = supl_client_acquisition_.gps_ref_loc;
+        }
+    if (supl_client_ephemeris_.save_assistance_snapshot(snapshot_filename) == false)
+        {
+            LOG(WARNING) << "SUPL: Failed to save the assistance snapshot " << snapshot_filename;
+        }
+}
+
+
 bool ControlThread::read_assistance_from_XML()
 {
+    // the binary snapshot of a previous run loads in a fraction of the time of the XML files
+    if (read_assistance_from_snapshot())
+        {
+            return true;
+        }
     // return variable (true == succeeded)
     bool ret = false;
     // getting names from the config file, if available
@@ -184,7 +387,7 @@ bool ControlThread::read_assistance_from_XML()
                     gps_eph_iter++)
                 {
                     std::cout << "SUPL: Read XML Ephemeris for GPS SV " << gps_eph_iter->first << std::endl;
-                    std::shared_ptr<Gps_Ephemeris> tmp_obj = std::make_shared<Gps_Ephemeris>(gps_eph_iter->second);
+                    std::shared_ptr<const Gps_Ephemeris> tmp_obj = std::make_shared<const Gps_Ephemeris>(gps_eph_iter->second);
                     flowgraph_->send_telemetry_msg(pmt::make_any(tmp_obj));
                 }
             ret = true;
@@ -247,6 +450,11 @@ bool ControlThread::read_assistance_from_XML()
                 }
         }
 
+    if (ret)
+        {
+            // next time, the snapshot
+            save_assistance_snapshot();
+        }
     return ret;
 }
 
@@ -312,7 +520,7 @@ void ControlThread::assist_GNSS()
                                     gps_eph_iter++)
                                 {
                                     std::cout << "SUPL: Received Ephemeris for GPS SV " << gps_eph_iter->first << std::endl;
-                                    std::shared_ptr<Gps_Ephemeris> tmp_obj = std::make_shared<Gps_Ephemeris>(gps_eph_iter->second);
+                                    std::shared_ptr<const Gps_Ephemeris> tmp_obj = std::make_shared<const Gps_Ephemeris>(gps_eph_iter->second);
                                     flowgraph_->send_telemetry_msg(pmt::make_any(tmp_obj));
                                 }
                             //Save ephemeris to XML file
@@ -379,13 +587,17 @@ void ControlThread::assist_GNSS()
                     if (error == 0)
                         {
                             std::map<int, Gps_Acq_Assist>::iterator gps_acq_iter;
+                            std::set<unsigned int> assisted_prns;
                             for(gps_acq_iter = supl_client_acquisition_.gps_acq_map.begin();
                                     gps_acq_iter != supl_client_acquisition_.gps_acq_map.end();
                                     gps_acq_iter++)
                                 {
                                     std::cout << "SUPL: Received Acquisition assistance for GPS SV " << gps_acq_iter->first << std::endl;
-                                    global_gps_acq_assist_map.write(gps_acq_iter->second.i_satellite_PRN, gps_acq_iter->second);
+                                    flowgraph_->state()->gps_acq_assist_map.write(gps_acq_iter->second.i_satellite_PRN, gps_acq_iter->second);
+                                    assisted_prns.insert(gps_acq_iter->first);
                                 }
+                            // the assisted satellites are in view: search them first
+                            flowgraph_->prioritize_satellites("GPS", assisted_prns);
                             if (supl_client_acquisition_.gps_ref_loc.valid == true)
                                 {
                                     std::cout << "SUPL: Received Ref Location (Acquisition Assistance)" << std::endl;
@@ -405,6 +617,7 @@ void ControlThread::assist_GNSS()
                             std::cout << "Please check internet connection and SUPL server configuration" << error << std::endl;
                             std::cout << "Disabling SUPL assistance.." << std::endl;
                         }
+                    save_assistance_snapshot();
                 }
         }
 }
@@ -414,6 +627,14 @@ void ControlThread::init()
 {
     // Instantiates a control queue, a GNSS flowgraph, and a control message factory
     control_queue_ = gr::msg_queue::make(0);
+    // pinned before the flowgraph is made, so that the threads started by its blocks
+    // (the RTCM server) and by run() inherit Receiver.control_cpus
+    control_cpus_ = parse_cpu_list(configuration_->property("Receiver.control_cpus", std::string("")));
+    unplaced_cpus_ = current_thread_affinity();
+    if (!control_cpus_.empty() && !set_current_thread_affinity(control_cpus_))
+        {
+            control_cpus_.clear();
+        }
     flowgraph_ = std::make_shared<GNSSFlowgraph>(configuration_, control_queue_);
     control_message_factory_ = std::make_shared<ControlMessageFactory>();
     stop_ = false;
@@ -423,42 +644,294 @@ void ControlThread::init()
     supl_mns = 0;
     supl_lac = 0;
     supl_ci = 0;
+
+    visibility_enabled_ = configuration_->property("Receiver.visibility_enabled", true);
+    visibility_prune_ = configuration_->property("Receiver.visibility_prune", false);
+    visibility_refresh_s_ = configuration_->property("Receiver.visibility_refresh_s", 300.0);
+    visibility_predictor_.set_elevation_mask(configuration_->property("Receiver.visibility_mask_deg", 5.0));
+    visibility_xml_read_ = false;
+    set_block_metrics_enabled(configuration_->property("Receiver.metrics_enabled", false));
+    set_trace_levels();
+    set_allocation_guard();
+    if (configuration_->property("Receiver.async_log", false))
+        {
+            start_async_log(configuration_->property("Receiver.async_log_kb", 4096));
+        }
+    set_dump_direct_io(configuration_->property("Receiver.dump_direct_io", false));
+
+    std::string rinex_nav_path = configuration_->property("GNSS-SDR.RINEX_nav_assistance", std::string(""));
+    if (!rinex_nav_path.empty())
+        {
+            rinex_nav_ = std::make_shared<Rinex_Nav_Source>(rinex_nav_path);
+        }
+    rinex_nav_poll_s_ = configuration_->property("GNSS-SDR.RINEX_nav_poll_s", 60.0);
+
+    double max_lag_ms = configuration_->property("Receiver.overload_max_lag_ms", 0.0);
+    if (max_lag_ms > 0.0)
+        {
+            realtime_margin_monitor_ = std::make_shared<Realtime_Margin_Monitor>(configuration_->property("GNSS-SDR.internal_fs_hz", 4.0e6),
+                    max_lag_ms / 1000.0, configuration_->property("Receiver.overload_recover_lag_ms", max_lag_ms / 4.0) / 1000.0,
+                    configuration_->property("Receiver.overload_hold_s", 5.0));
+        }
+    realtime_margin_check_s_ = configuration_->property("Receiver.overload_check_ms", 500.0) / 1000.0;
 }
 
 
-void ControlThread::read_control_messages()
+void ControlThread::update_visibility()
 {
-    DLOG(INFO) << "Reading control messages from queue";
-    boost::shared_ptr<gr::message> queue_message = control_queue_->delete_head();
-    if (queue_message != 0)
+    visibility_timer_.expires_from_now(boost::posix_time::milliseconds(static_cast<long long>(visibility_refresh_s_ * 1000.0)));
+    visibility_timer_.async_wait(boost::bind(&ControlThread::visibility_timer_expired, this, _1));
+
+    // orbits: the assistance, then what the telemetry decoded since
+    if (!visibility_xml_read_)
         {
-            control_messages_ = control_message_factory_->GetControlMessages(queue_message);
+            // without SUPL, the files saved by a previous run
+            visibility_xml_read_ = true;
+            if (supl_client_ephemeris_.gps_ephemeris_map.empty() && !supl_client_ephemeris_.load_assistance_snapshot(configuration_->property("GNSS-SDR.SUPL_gps_assistance_snapshot", assistance_default_snapshot_filename)))
+                {
+                    supl_client_ephemeris_.load_ephemeris_xml(configuration_->property("GNSS-SDR.SUPL_gps_ephemeris_xml", eph_default_xml_filename));
+                }
+            if (!supl_client_acquisition_.gps_ref_loc.valid)
+                {
+                    supl_client_acquisition_.load_ref_location_xml(configuration_->property("GNSS-SDR.SUPL_gps_ref_location_xml", ref_location_default_xml_filename));
+                }
+        }
+    std::map<int, Gps_Almanac>::const_iterator alm_iter;
+    for (alm_iter = supl_client_ephemeris_.gps_almanac_map.begin(); alm_iter != supl_client_ephemeris_.gps_almanac_map.end(); alm_iter++)
+        {
+            visibility_predictor_.set_almanac(alm_iter->second);
+        }
+    std::map<int, Gps_Ephemeris>::const_iterator eph_iter;
+    for (eph_iter = supl_client_ephemeris_.gps_ephemeris_map.begin(); eph_iter != supl_client_ephemeris_.gps_ephemeris_map.end(); eph_iter++)
+        {
+            visibility_predictor_.set_ephemeris(eph_iter->second);
+        }
+    navigation_data_bus::Ephemeris_Snapshot decoded = flowgraph_->state()->navigation_data.get_ephemeris_snapshot();
+    for (std::map<int, Gps_Ephemeris_Record>::const_iterator it = decoded->begin(); it != decoded->end(); ++it)
+        {
+            visibility_predictor_.set_ephemeris(*it->second.ephemeris);
+        }
+
+    // position: the last fix, the assistance, or the configuration
+    Gps_Ref_Location location;
+    if (flowgraph_->state()->gps_ref_location_map.read(0, location) && location.valid)
+        {
+            visibility_predictor_.set_position(location.lat, location.lon, 0.0);
+        }
+    else if (supl_client_acquisition_.gps_ref_loc.valid)
+        {
+            visibility_predictor_.set_position(supl_client_acquisition_.gps_ref_loc.lat, supl_client_acquisition_.gps_ref_loc.lon, 0.0);
+        }
+    else if (configuration_->property("GNSS-SDR.init_latitude_deg", 1000.0) < 1000.0)
+        {
+            visibility_predictor_.set_position(configuration_->property("GNSS-SDR.init_latitude_deg", 0.0),
+                    configuration_->property("GNSS-SDR.init_longitude_deg", 0.0),
+                    configuration_->property("GNSS-SDR.init_altitude_m", 0.0));
+        }
+    if (!visibility_predictor_.has_position() || visibility_predictor_.orbits() == 0)
+        {
+            DLOG(INFO) << "No position or no orbits yet to predict the satellites in view";
+            return;
+        }
+
+    // time: of the last fix or of the assistance, carried on by the system clock, or the system clock alone
+    double now_s = static_cast<double>(std::time(0));
+    double tow_s;
+    Gps_Ref_Time ref_time;
+    if (flowgraph_->state()->gps_ref_time_map.read(0, ref_time) && ref_time.valid)
+        {
+            tow_s = ref_time.d_TOW + (now_s - ref_time.d_tv_sec);
+        }
+    else if (supl_client_acquisition_.gps_time.valid)
+        {
+            tow_s = supl_client_acquisition_.gps_time.d_TOW + (now_s - supl_client_acquisition_.gps_time.d_tv_sec);
         }
     else
         {
-            control_messages_->clear();
+            tow_s = now_s - CONTROL_THREAD_GPS_EPOCH_UNIX_S + CONTROL_THREAD_GPS_UTC_LEAP_S;
+        }
+    tow_s = std::fmod(tow_s, 604800.0);
+    if (tow_s < 0.0)
+        {
+            tow_s += 604800.0;
+        }
+
+    std::set<unsigned int> visible;
+    std::set<unsigned int> hidden;
+    visibility_predictor_.predict(tow_s, visibility_refresh_s_, visible, hidden);
+    // nothing in view means a wrong time or position: never stop searching then
+    flowgraph_->update_visibility("GPS", visible, hidden, visibility_prune_ && !visible.empty());
+}
+
+
+void ControlThread::visibility_timer_expired(const boost::system::error_code& error)
+{
+    if (error || stop_)
+        {
+            // cancelled at the stop
+            return;
+        }
+    boost::posix_time::time_duration late = boost::asio::deadline_timer::traits_type::now() - visibility_timer_.expires_at();
+    event_latency_[TIMER_EVENT].add(late.total_microseconds() * 1e-6);
+    update_visibility();
+}
+
+
+void ControlThread::poll_rinex_nav()
+{
+    rinex_nav_timer_.expires_from_now(boost::posix_time::milliseconds(static_cast<long long>(rinex_nav_poll_s_ * 1000.0)));
+    rinex_nav_timer_.async_wait(boost::bind(&ControlThread::rinex_nav_timer_expired, this, _1));
+
+    bool read = rinex_nav_->poll();
+    // the ephemeris in force change with the time, not only with the files
+    double now_gps_s = static_cast<double>(std::time(0)) - CONTROL_THREAD_GPS_EPOCH_UNIX_S + CONTROL_THREAD_GPS_UTC_LEAP_S;
+    unsigned int sent = 0;
+    for (unsigned int PRN = 1; PRN <= 32; PRN++)
+        {
+            Gps_Ephemeris ephemeris;
+            if (!rinex_nav_->get_ephemeris_at(PRN, now_gps_s, ephemeris))
+                {
+                    continue;
+                }
+            std::map<unsigned int, double>::const_iterator last = rinex_nav_sent_toe_.find(PRN);
+            if (last != rinex_nav_sent_toe_.end() && last->second == ephemeris.d_Toe)
+                {
+                    continue;
+                }
+            rinex_nav_sent_toe_[PRN] = ephemeris.d_Toe;
+            supl_client_ephemeris_.gps_ephemeris_map[PRN] = ephemeris;
+            std::shared_ptr<const Gps_Ephemeris> tmp_obj = std::make_shared<const Gps_Ephemeris>(ephemeris);
+            flowgraph_->send_telemetry_msg(pmt::make_any(tmp_obj));
+            sent++;
+        }
+    if (sent > 0)
+        {
+            std::cout << "RINEX: " << sent << " GPS ephemeris from " << rinex_nav_->path() << std::endl;
+        }
+    if (!read)
+        {
+            return;
+        }
+    Gps_Iono iono;
+    if (rinex_nav_->get_iono(iono))
+        {
+            std::shared_ptr<Gps_Iono> tmp_obj = std::make_shared<Gps_Iono>(iono);
+            flowgraph_->send_telemetry_msg(pmt::make_any(tmp_obj));
+        }
+    Gps_Utc_Model utc;
+    if (rinex_nav_->get_utc(utc))
+        {
+            std::shared_ptr<Gps_Utc_Model> tmp_obj = std::make_shared<Gps_Utc_Model>(utc);
+            flowgraph_->send_telemetry_msg(pmt::make_any(tmp_obj));
+        }
+}
+
+
+void ControlThread::rinex_nav_timer_expired(const boost::system::error_code& error)
+{
+    if (error || stop_)
+        {
+            // cancelled at the stop
+            return;
+        }
+    boost::posix_time::time_duration late = boost::asio::deadline_timer::traits_type::now() - rinex_nav_timer_.expires_at();
+    event_latency_[TIMER_EVENT].add(late.total_microseconds() * 1e-6);
+    poll_rinex_nav();
+}
+
+
+void ControlThread::report_unread_properties()
+{
+    std::shared_ptr<FileConfiguration> file_configuration = std::dynamic_pointer_cast<FileConfiguration>(configuration_);
+    if (!file_configuration)
+        {
+            return;
+        }
+    std::vector<std::string> unread = file_configuration->unread_properties();
+    for (unsigned int i = 0; i < unread.size(); i++)
+        {
+            std::string closest = file_configuration->closest_missing_property(unread.at(i));
+            if (closest.empty())
+                {
+                    LOG(WARNING) << "Property " << unread.at(i) << " of " << config_file_ << " is not used by this receiver";
+                }
+            else
+                {
+                    LOG(WARNING) << "Property " << unread.at(i) << " of " << config_file_ << " is not used by this receiver, did you mean "
+                                 << closest << "?";
+                }
+        }
+}
+
+
+void ControlThread::check_realtime_margin()
+{
+    realtime_margin_timer_.expires_from_now(boost::posix_time::milliseconds(static_cast<long long>(realtime_margin_check_s_ * 1000.0)));
+    realtime_margin_timer_.async_wait(boost::bind(&ControlThread::realtime_margin_timer_expired, this, _1));
+
+    Realtime_Margin_Monitor::Level previous_level = realtime_margin_monitor_->level();
+    double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (realtime_margin_monitor_->update(wall_s, flowgraph_->samples_read()))
+        {
+            LOG(WARNING) << "Real-time lag " << realtime_margin_monitor_->lag_s() * 1000.0 << " ms, margin "
+                         << realtime_margin_monitor_->margin() * 100.0 << " %: from "
+                         << Realtime_Margin_Monitor::level_name(previous_level) << " to "
+                         << Realtime_Margin_Monitor::level_name(realtime_margin_monitor_->level());
+            flowgraph_->set_shedding_level(realtime_margin_monitor_->level());
+        }
+}
+
+
+void ControlThread::realtime_margin_timer_expired(const boost::system::error_code& error)
+{
+    if (error || stop_)
+        {
+            // cancelled at the stop
+            return;
+        }
+    boost::posix_time::time_duration late = boost::asio::deadline_timer::traits_type::now() - realtime_margin_timer_.expires_at();
+    event_latency_[TIMER_EVENT].add(late.total_microseconds() * 1e-6);
+    check_realtime_margin();
+}
+
+
+void ControlThread::read_control_messages()
+{
+    while (!stop_)
+        {
+            boost::shared_ptr<gr::message> queue_message = control_queue_->delete_head();
+            if (stop_) break;
+            double queued_s = queue_message->arg1();
+            if (queued_s <= 0.0)
+                {
+                    // not made by the ControlMessageFactory: from now on
+                    queued_s = ControlMessageFactory::Timestamp();
+                }
+            io_service_.post(boost::bind(&ControlThread::process_control_messages, this, queue_message, queued_s));
         }
 }
 
 
 // Apply the corresponding control actions
 // TODO:  May be it is better to move the apply_action state machine to the control_thread
-void ControlThread::process_control_messages()
+void ControlThread::process_control_messages(boost::shared_ptr<gr::message> queue_message, double queued_s)
 {
-    for (unsigned int i = 0; i < control_messages_->size(); i++)
+    if (stop_) return;
+    event_latency_[CONTROL_MESSAGE_EVENT].add(ControlMessageFactory::Timestamp() - queued_s);
+    std::shared_ptr<std::vector<std::shared_ptr<ControlMessage>>> control_messages = control_message_factory_->GetControlMessages(queue_message);
+    for (unsigned int i = 0; i < control_messages->size(); i++)
         {
             if (stop_) break;
-            if (control_messages_->at(i)->who == 200)
+            if (control_messages->at(i)->who == 200)
                 {
-                    apply_action(control_messages_->at(i)->what);
+                    apply_action(control_messages->at(i)->what);
                 }
             else
                 {
-                    flowgraph_->apply_action(control_messages_->at(i)->who, control_messages_->at(i)->what);
+                    flowgraph_->apply_action(control_messages->at(i)->who, control_messages->at(i)->what);
                 }
             processed_control_messages_++;
         }
-    control_messages_->clear();
     DLOG(INFO) << "Processed all control messages";
 }
 
@@ -470,6 +943,17 @@ void ControlThread::apply_action(unsigned int what)
     case 0:
         DLOG(INFO) << "Received action STOP";
         stop_ = true;
+        io_service_.stop();
+        applied_actions_++;
+        break;
+    case 1:
+        DLOG(INFO) << "Received action RECORD";
+        flight_recorder_trigger_all("control message");
+        applied_actions_++;
+        break;
+    case 2:
+        DLOG(INFO) << "Received action RECONFIGURE";
+        reconfigure();
         applied_actions_++;
         break;
     default:
@@ -479,55 +963,136 @@ void ControlThread::apply_action(unsigned int what)
 }
 
 
-void ControlThread::gps_acq_assist_data_collector()
+void ControlThread::post_acq_assist(const Gps_Acq_Assist& gps_acq)
+{
+    io_service_.post(boost::bind(&ControlThread::apply_acq_assist, this, gps_acq, ControlMessageFactory::Timestamp()));
+}
+
+
+void ControlThread::apply_acq_assist(const Gps_Acq_Assist& gps_acq, double posted_s)
 {
-    // ############ 1.bis READ EPHEMERIS/UTC_MODE/IONO QUEUE ####################
-    Gps_Acq_Assist gps_acq;
+    event_latency_[ACQ_ASSIST_EVENT].add(ControlMessageFactory::Timestamp() - posted_s);
+    if (gps_acq.i_satellite_PRN == 0) return;
+
+    // DEBUG MESSAGE
+    std::cout << "Acquisition assistance record has arrived from SAT ID "
+              << gps_acq.i_satellite_PRN
+              << " with Doppler "
+              << gps_acq.d_Doppler0
+              << " [Hz] "<< std::endl;
+    // insert new acq record to the global ephemeris map
     Gps_Acq_Assist gps_acq_old;
-    while(stop_ == false)
-        {
-            global_gps_acq_assist_queue.wait_and_pop(gps_acq);
-            if(gps_acq.i_satellite_PRN == 0) break;
-
-            // DEBUG MESSAGE
-            std::cout << "Acquisition assistance record has arrived from SAT ID "
-                      << gps_acq.i_satellite_PRN
-                      << " with Doppler "
-                      << gps_acq.d_Doppler0
-                      << " [Hz] "<< std::endl;
-            // insert new acq record to the global ephemeris map
-            if (global_gps_acq_assist_map.read(gps_acq.i_satellite_PRN,gps_acq_old))
+    if (flowgraph_->state()->gps_acq_assist_map.read(gps_acq.i_satellite_PRN,gps_acq_old))
+        {
+            std::cout << "Acquisition assistance record updated" << std::endl;
+            flowgraph_->state()->gps_acq_assist_map.write(gps_acq.i_satellite_PRN, gps_acq);
+        }
+    else
+        {
+            // insert new acq record
+            LOG(INFO) << "New acq assist record inserted";
+            flowgraph_->state()->gps_acq_assist_map.write(gps_acq.i_satellite_PRN, gps_acq);
+            std::set<unsigned int> assisted_prn;
+            assisted_prn.insert(gps_acq.i_satellite_PRN);
+            flowgraph_->prioritize_satellites("GPS", assisted_prn);
+        }
+}
+
+
+void ControlThread::start_keyboard_listener()
+{
+    boost::system::error_code error;
+    // a descriptor of its own: closing it leaves stdin open
+    int fd = ::dup(STDIN_FILENO);
+    if (fd >= 0)
+        {
+            keyboard_.assign(fd, error);
+        }
+    if (fd < 0 || error)
+        {
+            // e.g. stdin redirected from a regular file, which cannot be waited on
+            LOG(INFO) << "The keyboard is not read: " << error.message();
+            if (fd >= 0) ::close(fd);
+            return;
+        }
+    keyboard_.async_read_some(boost::asio::buffer(keys_), boost::bind(&ControlThread::keyboard_listener, this, _1, _2));
+}
+
+
+void ControlThread::keyboard_listener(const boost::system::error_code& error, std::size_t bytes)
+{
+    if (error || stop_)
+        {
+            // end of file, or closed at the stop
+            return;
+        }
+    for (std::size_t n = 0; n < bytes && !stop_; n++)
+        {
+            if (keys_[n] == 'q')
                 {
-                    std::cout << "Acquisition assistance record updated" << std::endl;
-                    global_gps_acq_assist_map.write(gps_acq.i_satellite_PRN, gps_acq);
+                    event_latency_[KEYBOARD_EVENT].add(0.0);
+                    std::cout << "Quit keystroke order received, stopping GNSS-SDR !!" << std::endl;
+                    apply_action(0);
                 }
-            else
+            else if (keys_[n] == 'r')
                 {
-                    // insert new acq record
-                    LOG(INFO) << "New acq assist record inserted";
-                    global_gps_acq_assist_map.write(gps_acq.i_satellite_PRN, gps_acq);
+                    event_latency_[KEYBOARD_EVENT].add(0.0);
+                    std::cout << "Record keystroke order received, storing the samples of the flight recorders" << std::endl;
+                    apply_action(1);
                 }
         }
+    if (!stop_)
+        {
+            keyboard_.async_read_some(boost::asio::buffer(keys_), boost::bind(&ControlThread::keyboard_listener, this, _1, _2));
+        }
 }
 
 
-void ControlThread::keyboard_listener()
+void ControlThread::signal_received(const boost::system::error_code& error, int signal_number)
 {
-    bool read_keys = true;
-    char c = '0';
-    while(read_keys && !stop_)
+    if (error)
         {
-            std::cin.get(c);
-            if (c == 'q')
-                {
-                    std::cout << "Quit keystroke order received, stopping GNSS-SDR !!" << std::endl;
-                    std::unique_ptr<ControlMessageFactory> cmf(new ControlMessageFactory());
-                    if (control_queue_ != gr::msg_queue::sptr())
-                        {
-                            control_queue_->handle(cmf->GetQueueMessage(200, 0));
-                        }
-                    read_keys = false;
-                }
-            usleep(500000);
+            return;
+        }
+    event_latency_[SIGNAL_EVENT].add(0.0);
+    if (signal_number == SIGHUP)
+        {
+            std::cout << "SIGHUP received, reading the configuration again" << std::endl;
+            apply_action(2);
+            signals_.async_wait(boost::bind(&ControlThread::signal_received, this, _1, _2));
+            return;
+        }
+    std::cout << "Signal " << signal_number << " received, stopping GNSS-SDR !!" << std::endl;
+    apply_action(0);
+}
+
+
+void ControlThread::reconfigure()
+{
+    if (config_file_.empty())
+        {
+            LOG(WARNING) << "The configuration was not read from a file, it cannot be read again";
+            return;
+        }
+    std::ifstream config_file(config_file_.c_str());
+    if (!config_file.is_open())
+        {
+            LOG(WARNING) << "Unable to open configuration file " << config_file_ << ", the receiver keeps its configuration";
+            return;
+        }
+    config_file.close();
+    configuration_ = std::make_shared<FileConfiguration>(config_file_);
+    flowgraph_->reconfigure(configuration_);
+    set_block_metrics_enabled(configuration_->property("Receiver.metrics_enabled", false));
+    set_trace_levels();
+    set_allocation_guard();
+
+    visibility_prune_ = configuration_->property("Receiver.visibility_prune", false);
+    visibility_refresh_s_ = configuration_->property("Receiver.visibility_refresh_s", 300.0);
+    visibility_predictor_.set_elevation_mask(configuration_->property("Receiver.visibility_mask_deg", 5.0));
+    if (visibility_enabled_)
+        {
+            update_visibility();
         }
+    LOG(INFO) << "Configuration " << config_file_ << " applied";
 }
@@ -35,22 +35,61 @@
 #ifndef GNSS_SDR_CONTROL_THREAD_H_
 #define GNSS_SDR_CONTROL_THREAD_H_
 
+#include <map>
 #include <memory>
+#include <string>
 #include <vector>
+#include <boost/asio.hpp>
 #include <boost/thread.hpp>
 #include <gnuradio/msg_queue.h>
 #include "control_message_factory.h"
 #include "gnss_sdr_supl_client.h"
+#include "gnss_visibility_predictor.h"
+#include "gps_acq_assist.h"
+#include "metrics_exporter.h"
+#include "realtime_margin_monitor.h"
+#include "rinex_nav_source.h"
 
 class GNSSFlowgraph;
 class ConfigurationInterface;
 
 
+/*!
+ * \brief Number of events of one kind handled by the control plane, and
+ * how long they waited for it [s]
+ */
+struct Control_Event_Latency
+{
+    unsigned int events;
+    double total_s;
+    double max_s;
+
+    Control_Event_Latency() : events(0), total_s(0.0), max_s(0.0) {}
+
+    void add(double latency_s)
+    {
+        events++;
+        total_s += latency_s;
+        if (latency_s > max_s) max_s = latency_s;
+    }
+
+    double mean_s() const { return events > 0 ? total_s / events : 0.0; }
+};
+
+
 /*!
  * \brief This class represents the main thread of the application, so the name is ControlThread.
  * This is the GNSS Receiver Control Plane: it connects the flowgraph, starts running it,
  * and while it does not stop, reads the control messages generated by the blocks,
  * processes them, and applies the corresponding actions.
+ *
+ * All the events of the control plane are handled in the order they arrive
+ * by one boost::asio::io_service running in the thread that calls run():
+ * the control messages of the channels, the acquisition assistance, the
+ * keyboard, SIGINT/SIGTERM, SIGHUP (the configuration is read again), the
+ * refresh of the satellite visibility and the check of the real-time margin.
+ * Only the gr::msg_queue, which can just be waited on, needs a thread of
+ * its own, that blocks on it and posts each message to the loop.
  */
 class ControlThread
 {
@@ -78,9 +117,7 @@ public:
      *
      *  - Start the GNSS receiver flowgraph;
      *
-     *  while (flowgraph_->running() && !stop_){
-     *
-     *  - Read control messages and process them; }
+     *  - Handle the control events until a STOP action, 'q' or SIGINT/SIGTERM.
      */
     void run();
 
@@ -102,6 +139,28 @@ public:
         return applied_actions_;
     }
 
+    //! Kinds of events of the control plane
+    enum Event_Kind
+    {
+        CONTROL_MESSAGE_EVENT, //!< from the message creation (ControlMessageFactory)
+        ACQ_ASSIST_EVENT,      //!< from post_acq_assist()
+        KEYBOARD_EVENT,        //!< counted only
+        SIGNAL_EVENT,          //!< counted only
+        TIMER_EVENT,           //!< from the expiry of the timer
+        EVENT_KINDS
+    };
+
+    const Control_Event_Latency& event_latency(Event_Kind kind) const
+    {
+        return event_latency_[kind];
+    }
+
+    /*!
+     * \brief Stores an acquisition assistance record from the control
+     * plane. It can be called from any thread.
+     */
+    void post_acq_assist(const Gps_Acq_Assist& gps_acq);
+
     /*!
      * \brief Instantiates a flowgraph
      *
@@ -129,38 +188,109 @@ private:
     // Read {ephemeris, iono, utc, ref loc, ref time} assistance from a local XML file previously recorded
     bool read_assistance_from_XML();
 
+    // Read the same assistance from the binary snapshot, unless the ephemeris XML file is newer
+    bool read_assistance_from_snapshot();
+
+    // Save the assistance received or read from XML to the binary snapshot
+    void save_assistance_snapshot();
+
     // Save {ephemeris, iono, utc, ref loc, ref time} assistance to a local XML file
     //bool save_assistance_to_XML();
 
+    // Body of the thread that blocks on the control queue and posts its messages to the loop
     void read_control_messages();
 
-    void process_control_messages();
+    void process_control_messages(boost::shared_ptr<gr::message> queue_message, double queued_s);
 
-    /*
-     * Blocking function that reads the GPS assistance queue
-     */
-    void gps_acq_assist_data_collector();
+    void apply_acq_assist(const Gps_Acq_Assist& gps_acq, double posted_s);
     
     /*
      * Read initial GNSS assistance from SUPL server or local XML files
      */
     void assist_GNSS();
-    
-    
+
+    /*
+     * Predicts the GPS satellites in view from the almanac, the ephemeris
+     * and the last position, and reorders the acquisition accordingly
+     * (Receiver.visibility_* in the configuration)
+     */
+    void update_visibility();
+    void visibility_timer_expired(const boost::system::error_code& error);
+
+    /*
+     * Reads the RINEX navigation files of GNSS-SDR.RINEX_nav_assistance as
+     * they change, and sends the ephemeris in force, the iono and the UTC
+     * model to the receiver, as the SUPL assistance does
+     */
+    void poll_rinex_nav();
+    void rinex_nav_timer_expired(const boost::system::error_code& error);
+
+    /*
+     * Compares the samples read by the channels with the wall clock, and
+     * makes the flowgraph shed load while the receiver falls behind the
+     * signal (Receiver.overload_* in the configuration)
+     */
+    void check_realtime_margin();
+    void realtime_margin_timer_expired(const boost::system::error_code& error);
+
+    /*
+     * Warns about the properties of the configuration file that no block
+     * read, with the closest property that was looked for and not found
+     */
+    void report_unread_properties();
+
+    void start_keyboard_listener();
+    void keyboard_listener(const boost::system::error_code& error, std::size_t bytes);
+    void signal_received(const boost::system::error_code& error, int signal_number);
+
+    /*
+     * Reads the configuration file again and applies what can change while
+     * the receiver runs (action 2 or SIGHUP), see GNSSFlowgraph::reconfigure
+     */
+    void reconfigure();
+
+    // Verbosity of the trace logs of each module (Receiver.trace_<module>)
+    void set_trace_levels();
+    void set_allocation_guard();
+
     void apply_action(unsigned int what);
     std::shared_ptr<GNSSFlowgraph> flowgraph_;
     std::shared_ptr<ConfigurationInterface> configuration_;
+    std::string config_file_; // empty if the configuration was given
     boost::shared_ptr<gr::msg_queue> control_queue_;
     std::shared_ptr<ControlMessageFactory> control_message_factory_;
-    std::shared_ptr<std::vector<std::shared_ptr<ControlMessage>>> control_messages_;
     bool stop_;
     bool delete_configuration_;
     unsigned int processed_control_messages_;
     unsigned int applied_actions_;
-    boost::thread keyboard_thread_;
-    boost::thread gps_acq_assist_data_collector_thread_;
-    
-    void keyboard_listener();
+
+    boost::asio::io_service io_service_;
+    boost::asio::posix::stream_descriptor keyboard_;
+    char keys_[16];
+    boost::asio::signal_set signals_;
+    boost::asio::deadline_timer visibility_timer_;
+    boost::thread control_queue_thread_;
+    Control_Event_Latency event_latency_[EVENT_KINDS];
+    std::shared_ptr<Metrics_Exporter> metrics_exporter_; // made by run()
+
+    Gnss_Visibility_Predictor visibility_predictor_;
+    bool visibility_enabled_;
+    bool visibility_prune_;   // hidden satellites are not searched at all
+    double visibility_refresh_s_;
+    bool visibility_xml_read_;
+
+    std::shared_ptr<Rinex_Nav_Source> rinex_nav_; // if GNSS-SDR.RINEX_nav_assistance is set
+    boost::asio::deadline_timer rinex_nav_timer_;
+    double rinex_nav_poll_s_;
+    std::map<unsigned int, double> rinex_nav_sent_toe_; // PRN -> Toe of the ephemeris sent
+
+    std::shared_ptr<Realtime_Margin_Monitor> realtime_margin_monitor_; // if Receiver.overload_max_lag_ms is set
+    boost::asio::deadline_timer realtime_margin_timer_;
+    double realtime_margin_check_s_;
+
+    std::vector<int> control_cpus_; // Receiver.control_cpus, where the control and helper threads run
+    std::vector<int> unplaced_cpus_; // affinity of the thread before it was pinned
+
 
     // default filename for assistance data
     const std::string eph_default_xml_filename = "./gps_ephemeris.xml";
@@ -168,6 +298,7 @@ private:
     const std::string iono_default_xml_filename = "./gps_iono.xml";
     const std::string ref_time_default_xml_filename = "./gps_ref_time.xml";
     const std::string ref_location_default_xml_filename = "./gps_ref_location.xml";
+    const std::string assistance_default_snapshot_filename = "./gps_assistance.snap";
 };
 
 #endif /*GNSS_SDR_CONTROL_THREAD_H_*/
@@ -0,0 +1,187 @@
+/*!
+ * \file epoch_arena.h
+ * \brief Monotonic buffer for the temporaries of an epoch, and the allocator
+ * of the containers built on it
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_EPOCH_ARENA_H_
+#define GNSS_SDR_EPOCH_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <new>
+#include <vector>
+
+/*!
+ * \brief Monotonic buffer for the temporaries of one epoch of a block.
+ *
+ * allocate() hands out consecutive pieces of one buffer and nothing is freed
+ * until reset(), which the block calls at the start of each epoch. When an
+ * epoch needs more than the buffer, the rest comes from the heap and the
+ * buffer grows at the next reset() to what that epoch used, so in steady
+ * state an epoch makes no heap allocation at all.
+ *
+ * An arena belongs to the thread of its block; it is not thread-safe.
+ */
+class Epoch_Arena
+{
+public:
+    explicit Epoch_Arena(std::size_t capacity = 16384) :
+        d_buffer(new char[capacity]),
+        d_capacity(capacity),
+        d_used(0),
+        d_overflow_bytes(0),
+        d_overflows(0)
+    {}
+
+    void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+    {
+        std::uintptr_t base = reinterpret_cast<std::uintptr_t>(d_buffer.get());
+        std::uintptr_t start = (base + d_used + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+        if (start + bytes <= base + d_capacity)
+            {
+                d_used = start + bytes - base;
+                return reinterpret_cast<void*>(start);
+            }
+        // overflow, freed at the next reset()
+        d_overflow_bytes += bytes + alignment;
+        d_overflows++;
+        d_extra.push_back(std::unique_ptr<char[]>(new char[bytes + alignment]));
+        std::uintptr_t extra = reinterpret_cast<std::uintptr_t>(d_extra.back().get());
+        return reinterpret_cast<void*>((extra + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1));
+    }
+
+    //! Uninitialized room for n objects of type T
+    template <typename T>
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+    /*!
+     * \brief Forgets everything allocated since the last reset(). Nothing
+     * allocated before may be used any more.
+     */
+    void reset()
+    {
+        if (d_overflow_bytes > 0)
+            {
+                d_capacity = d_used + d_overflow_bytes;
+                d_capacity += d_capacity / 2;
+                d_buffer.reset(new char[d_capacity]);
+                d_extra.clear();
+                d_overflow_bytes = 0;
+            }
+        d_used = 0;
+    }
+
+    std::size_t capacity() const { return d_capacity; }
+    std::size_t used() const { return d_used + d_overflow_bytes; }
+    //! Allocations that did not fit in the buffer, since the construction
+    unsigned long int overflows() const { return d_overflows; }
+
+private:
+    Epoch_Arena(const Epoch_Arena&);
+    Epoch_Arena& operator=(const Epoch_Arena&);
+
+    std::unique_ptr<char[]> d_buffer;
+    std::size_t d_capacity;
+    std::size_t d_used;
+    std::size_t d_overflow_bytes;
+    std::vector<std::unique_ptr<char[]> > d_extra;
+    unsigned long int d_overflows;
+};
+
+
+/*!
+ * \brief Allocator of the standard containers on an Epoch_Arena, or on the
+ * heap without one.
+ *
+ * A container on an arena frees nothing, and must not outlive the epoch.
+ * A copy of it is made on the heap, so that what the checks keep beyond the
+ * epoch, like the deferred inputs of the spoofing detector, stays valid.
+ */
+template <typename T>
+class Arena_Allocator
+{
+public:
+    typedef T value_type;
+
+    Arena_Allocator() : d_arena(0) {}
+    explicit Arena_Allocator(Epoch_Arena* arena) : d_arena(arena) {}
+    template <typename U>
+    Arena_Allocator(const Arena_Allocator<U>& other) : d_arena(other.arena()) {}
+
+    T* allocate(std::size_t n)
+    {
+        if (d_arena)
+            {
+                return d_arena->allocate<T>(n);
+            }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t)
+    {
+        if (!d_arena)
+            {
+                ::operator delete(p);
+            }
+    }
+
+    Arena_Allocator select_on_container_copy_construction() const
+    {
+        return Arena_Allocator();
+    }
+
+    Epoch_Arena* arena() const { return d_arena; }
+
+private:
+    Epoch_Arena* d_arena;
+};
+
+template <typename T, typename U>
+bool operator==(const Arena_Allocator<T>& a, const Arena_Allocator<U>& b)
+{
+    return a.arena() == b.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const Arena_Allocator<T>& a, const Arena_Allocator<U>& b)
+{
+    return a.arena() != b.arena();
+}
+
+
+//! Channels of an epoch, as the PVT hands them to the spoofing detector
+typedef std::list<unsigned int, Arena_Allocator<unsigned int> > Channel_List;
+
+#endif
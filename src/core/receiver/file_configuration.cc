@@ -36,8 +36,9 @@
 #include "file_configuration.h"
 #include <string>
 #include <glog/logging.h>
-#include "INIReader.h"
-#include "string_converter.h"
+#include <strings.h>
+#include "ini.h"
+#include "property_store.h"
 #include "in_memory_configuration.h"
 
 using google::LogMessage;
@@ -70,7 +71,7 @@ std::string FileConfiguration::property(std::string property_name, std::string d
         }
     else
         {
-            return ini_reader_->Get("GNSS-SDR", property_name, default_value);
+            return store_->get(property_name, default_value);
         }
 }
 
@@ -83,8 +84,7 @@ bool FileConfiguration::property(std::string property_name, bool default_value)
         }
     else
         {
-            std::string empty = "";
-            return converter_->convert(property(property_name, empty), default_value);
+            return store_->get(property_name, default_value);
         }
 }
 
@@ -97,8 +97,7 @@ long FileConfiguration::property(std::string property_name, long default_value)
         }
     else
         {
-            std::string empty = "";
-            return converter_->convert(property(property_name, empty), default_value);
+            return store_->get(property_name, default_value);
         }
 }
 
@@ -112,8 +111,7 @@ int FileConfiguration::property(std::string property_name, int default_value)
         }
     else
         {
-            std::string empty = "";
-            return converter_->convert(property(property_name, empty), default_value);
+            return store_->get(property_name, default_value);
         }
 }
 
@@ -127,8 +125,7 @@ unsigned int FileConfiguration::property(std::string property_name, unsigned int
         }
     else
         {
-            std::string empty = "";
-            return converter_->convert(property(property_name, empty), default_value);
+            return store_->get(property_name, default_value);
         }
 }
 
@@ -142,8 +139,7 @@ unsigned short FileConfiguration::property(std::string property_name, unsigned s
         }
     else
         {
-            std::string empty = "";
-            return converter_->convert(property(property_name, empty), default_value);
+            return store_->get(property_name, default_value);
         }
 }
 
@@ -157,8 +153,7 @@ float FileConfiguration::property(std::string property_name, float default_value
         }
     else
         {
-            std::string empty = "";
-            return converter_->convert(property(property_name, empty), default_value);
+            return store_->get(property_name, default_value);
         }
 }
 
@@ -171,8 +166,7 @@ double FileConfiguration::property(std::string property_name, double default_val
         }
     else
         {
-            std::string empty = "";
-            return converter_->convert(property(property_name, empty), default_value);
+            return store_->get(property_name, default_value);
         }
 }
 
@@ -181,16 +175,39 @@ double FileConfiguration::property(std::string property_name, double default_val
 void FileConfiguration::set_property(std::string property_name, std::string value)
 {
     overrided_->set_property(property_name, value);
+    store_->mark_read(property_name); // the value of the file is not used
 }
 
 
 
+std::vector<std::string> FileConfiguration::unread_properties() const
+{
+    return store_->unread();
+}
+
+
+std::string FileConfiguration::closest_missing_property(std::string property_name) const
+{
+    return store_->closest_missing(property_name);
+}
+
+
+int FileConfiguration::value_handler(void* user, const char* section, const char* name, const char* value)
+{
+    // only the GNSS-SDR section is read, the last value of a property wins
+    if (strcasecmp(section, "GNSS-SDR") == 0)
+        {
+            static_cast<PropertyStore*>(user)->set(name, value);
+        }
+    return 1;
+}
+
+
 void FileConfiguration::init()
 {
-    std::unique_ptr<StringConverter> converter_(new StringConverter);
     overrided_ = std::make_shared<InMemoryConfiguration>();
-    ini_reader_ = std::make_shared<INIReader>(filename_);
-    error_ = ini_reader_->ParseError();
+    store_.reset(new PropertyStore(true));
+    error_ = ini_parse(filename_.c_str(), value_handler, store_.get());
     if(error_ == 0)
         {
             DLOG(INFO) << "Configuration file " << filename_ << " opened with no errors";
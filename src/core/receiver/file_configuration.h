@@ -40,9 +40,9 @@
 #include "configuration_interface.h"
 #include <memory>
 #include <string>
+#include <vector>
 
-class INIReader;
-class StringConverter;
+class PropertyStore;
 class InMemoryConfiguration;
 
 /*!
@@ -53,6 +53,8 @@ class InMemoryConfiguration;
  * for the values of the parameters.
  * The file is in the INI format, containing sections and pairs of names and values.
  * For more information about the INI format, see http://en.wikipedia.org/wiki/INI_file
+ * The file is parsed once into a PropertyStore, which keeps the values
+ * converted to each type they are read as, and which properties were read.
  */
 class FileConfiguration : public ConfigurationInterface
 {
@@ -70,12 +72,18 @@ public:
     float property(std::string property_name, float default_value);
     double property(std::string property_name, double default_value);
     void set_property(std::string property_name, std::string value);
+
+    //! Properties of the file never read so far, sorted
+    std::vector<std::string> unread_properties() const;
+
+    //! Property the receiver looked for and did not find closest to property_name, or empty
+    std::string closest_missing_property(std::string property_name) const;
 private:
     void init();
+    static int value_handler(void* user, const char* section, const char* name, const char* value);
     std::string filename_;
-    std::shared_ptr<INIReader> ini_reader_;
+    std::unique_ptr<PropertyStore> store_;
     std::shared_ptr<InMemoryConfiguration> overrided_;
-    std::unique_ptr<StringConverter> converter_;
     int error_;
 };
 
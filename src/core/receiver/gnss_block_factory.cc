@@ -42,18 +42,28 @@
 #include <string>
 #include <sstream>
 #include <iostream>
+#include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
 #include <glog/logging.h>
 #include "configuration_interface.h"
 #include "gnss_block_interface.h"
+#include "acquisition_interface.h"
+#include "tracking_interface.h"
+#include "telemetry_decoder_interface.h"
+#include "pvt_interface.h"
 #include "pass_through.h"
 #include "file_signal_source.h"
+#include "chunked_capture_signal_source.h"
+#include "shared_ring_signal_source.h"
+#include "iq_stream_signal_source.h"
 #include "nsr_file_signal_source.h"
 #include "two_bit_cpx_file_signal_source.h"
 #include "spir_file_signal_source.h"
 #include "rtl_tcp_signal_source.h"
 #include "two_bit_packed_file_signal_source.h"
 #include "channel.h"
+#include "acquisition_thread_pool.h"
+#include "receiver_state.h"
 
 #include "signal_conditioner.h"
 #include "array_signal_conditioner.h"
@@ -66,11 +76,13 @@
 #include "direct_resampler_conditioner.h"
 #include "fir_filter.h"
 #include "freq_xlating_fir_filter.h"
+#include "fused_xlating_fir_filter.h"
 #include "beamformer_filter.h"
 #include "gps_l1_ca_pcps_acquisition.h"
 #include "gps_l2_m_pcps_acquisition.h"
 #include "gps_l1_ca_pcps_sd_acquisition.h"
 #include "gps_l1_ca_pcps_multithread_acquisition.h"
+#include "gps_l1_ca_pcps_server_acquisition.h"
 #include "gps_l1_ca_pcps_tong_acquisition.h"
 #include "gps_l1_ca_pcps_assisted_acquisition.h"
 #include "gps_l1_ca_pcps_acquisition_fine_doppler.h"
@@ -127,6 +139,7 @@
 #endif
 
 #if CUDA_GPU_ACCEL
+#include "gps_l1_ca_pcps_cuda_acquisition.h"
 #include "gps_l1_ca_dll_pll_tracking_gpu.h"
 #endif
 
@@ -134,6 +147,76 @@
 using google::LogMessage;
 
 
+namespace
+{
+template <class Block>
+std::unique_ptr<GNSSBlockInterface> make_block(const GNSSBlockFactory::Block_Args& args)
+{
+    return std::unique_ptr<GNSSBlockInterface>(new Block(args.configuration, args.role, args.in_streams, args.out_streams));
+}
+
+
+template <class Block>
+std::unique_ptr<GNSSBlockInterface> make_source(const GNSSBlockFactory::Block_Args& args)
+{
+    return std::unique_ptr<GNSSBlockInterface>(new Block(args.configuration, args.role, args.in_streams, args.out_streams, args.queue));
+}
+
+
+// A source that cannot open its file ends the program
+template <class Block>
+std::unique_ptr<GNSSBlockInterface> make_file_source(const GNSSBlockFactory::Block_Args& args)
+{
+    try
+    {
+            return make_source<Block>(args);
+    }
+    catch (const std::exception &e)
+    {
+            std::cout << "GNSS-SDR program ended." << std::endl;
+            exit(1);
+    }
+}
+
+
+template <class Block>
+std::unique_ptr<GNSSBlockInterface> make_spoofing_block(const GNSSBlockFactory::Block_Args& args)
+{
+    return std::unique_ptr<GNSSBlockInterface>(new Block(args.configuration, args.role, args.in_streams, args.out_streams,
+            args.spoofing_detector));
+}
+
+
+// The block of a channel or of the PVT, if the implementation is one
+template <class Interface>
+std::unique_ptr<Interface> block_cast(std::unique_ptr<GNSSBlockInterface> block, const std::string& role,
+        const std::string& implementation)
+{
+    Interface* typed = dynamic_cast<Interface*>(block.get());
+    if (!typed)
+        {
+            if (block)
+                {
+                    LOG(ERROR) << role << "." << implementation << ": Undefined implementation for block";
+                }
+            return std::unique_ptr<Interface>();
+        }
+    block.release();
+    return std::unique_ptr<Interface>(typed);
+}
+
+
+// One task of the parallel initialization of the channel acquisitions
+void init_channel_acquisition(const std::vector<Channel*>* channels, std::shared_ptr<Receiver_State> state,
+        unsigned int task, Acquisition_Scratch& scratch __attribute__((unused)))
+{
+    // the windows and hints of the acquisition keep the tables of the receiver being built
+    Receiver_State_Scope state_scope(state);
+    channels->at(task)->init_acquisition();
+}
+}
+
+
 GNSSBlockFactory::GNSSBlockFactory()
 {}
 
@@ -618,17 +701,41 @@ std::unique_ptr<std::vector<std::unique_ptr<GNSSBlockInterface>>> GNSSBlockFacto
                 channel_absolute_id++;
            }
 
+    // The blocks are built one at a time above (GNU Radio numbers them with a global counter), but the
+    // Doppler grids and code FFTs of their acquisitions, most of the startup time with many channels,
+    // are built in the acquisition thread pool, sharing the plan and grid caches
+    std::vector<Channel*> acquisitions;
+    for (unsigned int i = 0; i < total_channels; i++)
+        {
+            Channel* channel = dynamic_cast<Channel*>(channels->at(i).get());
+            if (channel)
+                {
+                    acquisitions.push_back(channel);
+                }
+        }
+    if (configuration->property("GNSS-SDR.parallel_channel_init", true))
+        {
+            Acquisition_Thread_Pool::instance().parallel_for(acquisitions.size(),
+                    boost::bind(&init_channel_acquisition, &acquisitions, Receiver_State::current(), _1, _2));
+        }
+    else
+        {
+            for (unsigned int i = 0; i < acquisitions.size(); i++)
+                {
+                    acquisitions.at(i)->init_acquisition();
+                }
+        }
+    LOG(INFO) << "Acquisition of " << acquisitions.size() << " channels initialized";
+
     return channels;
 }
 
 /*
  * Returns the block with the required configuration and implementation
  *
- * PLEASE ADD YOUR NEW BLOCK HERE!!
- *
- * IMPORTANT NOTE: Acquisition, Tracking and telemetry blocks are only included here for testing purposes.
- * To be included in a channel they must be also be included in GetAcqBlock(), GetTrkBlock() and GetTlmBlock()
- * (see below)
+ * The implementation is looked up in the registry of the factory. To add a
+ * new block, register it in builtin_blocks() below, or out of the tree with
+ * a Block_Registrar
  */
 std::unique_ptr<GNSSBlockInterface> GNSSBlockFactory::GetBlock(
         std::shared_ptr<ConfigurationInterface> configuration,
@@ -637,565 +744,35 @@ std::unique_ptr<GNSSBlockInterface> GNSSBlockFactory::GetBlock(
         unsigned int out_streams, boost::shared_ptr<gr::msg_queue> queue)
 {
     std::unique_ptr<GNSSBlockInterface> block;
-
-    //PASS THROUGH ----------------------------------------------------------------
-    if (implementation.compare("Pass_Through") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new Pass_Through(configuration.get(), role, in_streams, out_streams));
-            block = std::move(block_);
-        }
-
-    // SIGNAL SOURCES -------------------------------------------------------------
-    else if (implementation.compare("File_Signal_Source") == 0)
-        {
-            try
-            {
-                    std::unique_ptr<GNSSBlockInterface> block_(new FileSignalSource(configuration.get(), role, in_streams,
-                            out_streams, queue));
-                    block = std::move(block_);
-            }
-
-            catch (const std::exception &e)
-            {
-                    std::cout << "GNSS-SDR program ended." << std::endl;
-                    exit(1);
-            }
-        }
-    else if (implementation.compare("Nsr_File_Signal_Source") == 0)
-        {
-            try
-            {
-                    std::unique_ptr<GNSSBlockInterface> block_(new NsrFileSignalSource(configuration.get(), role, in_streams,
-                            out_streams, queue));
-                    block = std::move(block_);
-
-            }
-            catch (const std::exception &e)
-            {
-                    std::cout << "GNSS-SDR program ended." << std::endl;
-                    exit(1);
-            }
-        }
-#if MODERN_GNURADIO
-    else if (implementation.compare("Two_Bit_Cpx_File_Signal_Source") == 0)
-        {
-            try
-            {
-                    std::unique_ptr<GNSSBlockInterface> block_(new TwoBitCpxFileSignalSource(configuration.get(), role, in_streams,
-                            out_streams, queue));
-                    block = std::move(block_);
-
-            }
-            catch (const std::exception &e)
-            {
-                    std::cout << "GNSS-SDR program ended." << std::endl;
-                    exit(1);
-            }
-        }
-    else if(implementation.compare("Two_Bit_Packed_File_Signal_Source") == 0 )
-        {
-            try
-            {
-                std::unique_ptr<GNSSBlockInterface> block_(new TwoBitPackedFileSignalSource(configuration.get(), role, in_streams,
-                            out_streams, queue));
-                block = std::move(block_);
-            }
-            catch(const std::exception &e)
-            {
-                std::cout << "GNSS-SDR program ended." << std::endl;
-                exit(1);
-            }
-        }
-#endif
-    else if (implementation.compare("Spir_File_Signal_Source") == 0)
-        {
-            try
-            {
-                    std::unique_ptr<GNSSBlockInterface> block_(new SpirFileSignalSource(configuration.get(), role, in_streams,
-                            out_streams, queue));
-                    block = std::move(block_);
-
-            }
-            catch (const std::exception &e)
-            {
-                    std::cout << "GNSS-SDR program ended." << std::endl;
-                    exit(1);
-            }
-        }
-    else if (implementation.compare("RtlTcp_Signal_Source") == 0)
-        {
-            try
-            {
-                    std::unique_ptr<GNSSBlockInterface> block_(new RtlTcpSignalSource(configuration.get(), role, in_streams,
-                            out_streams, queue));
-                    block = std::move(block_);
-
-            }
-            catch (const std::exception &e)
-            {
-                    std::cout << "GNSS-SDR program ended." << std::endl;
-                    exit(1);
-            }
-        }
-#if UHD_DRIVER
-    else if (implementation.compare("UHD_Signal_Source") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new UhdSignalSource(configuration.get(), role, in_streams,
-                    out_streams, queue));
-            block = std::move(block_);
-        }
-#endif
-#if GN3S_DRIVER
-    else if (implementation.compare("GN3S_Signal_Source") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new Gn3sSignalSource(configuration.get(), role, in_streams,
-                    out_streams, queue));
-            block = std::move(block_);
-        }
-#endif
-
-#if RAW_ARRAY_DRIVER
-    else if (implementation.compare("Raw_Array_Signal_Source") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new RawArraySignalSource(configuration.get(), role, in_streams,
-                    out_streams, queue));
-            block = std::move(block_);
-        }
-#endif
-
-#if OSMOSDR_DRIVER
-    else if (implementation.compare("Osmosdr_Signal_Source") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new OsmosdrSignalSource(configuration.get(), role, in_streams,
-                    out_streams, queue));
-            block = std::move(block_);
-        }
-#endif
-
-#if FLEXIBAND_DRIVER
-    else if (implementation.compare("Flexiband_Signal_Source") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new FlexibandSignalSource(configuration.get(), role, in_streams,
-                    out_streams, queue));
-            block = std::move(block_);
-        }
-#endif
-
-    // DATA TYPE ADAPTER -----------------------------------------------------------
-    else if (implementation.compare("Byte_To_Short") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface>block_(new ByteToShort(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Ibyte_To_Cbyte") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface>block_(new IbyteToCbyte(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Ibyte_To_Cshort") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface>block_(new IbyteToCshort(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Ibyte_To_Complex") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface>block_(new IbyteToComplex(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Ishort_To_Cshort") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface>block_(new IshortToCshort(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Ishort_To_Complex") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface>block_(new IshortToComplex(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-
-    // INPUT FILTER ----------------------------------------------------------------
-    else if (implementation.compare("Fir_Filter") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new FirFilter(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Freq_Xlating_Fir_Filter") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new FreqXlatingFirFilter(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Beamformer_Filter") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new BeamformerFilter(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-
-    // RESAMPLER -------------------------------------------------------------------
-    else if (implementation.compare("Direct_Resampler") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new DirectResamplerConditioner(configuration.get(), role,
-                    in_streams, out_streams));
-            block = std::move(block_);
-        }
-
-    // ACQUISITION BLOCKS ---------------------------------------------------------
-    else if (implementation.compare("GPS_L1_CA_PCPS_Acquisition") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GpsL1CaPcpsAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L1_CA_PCPS_SD_Acquisition") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GpsL1CaPcpsSdAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L1_CA_PCPS_Assisted_Acquisition") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GpsL1CaPcpsAssistedAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L1_CA_PCPS_Tong_Acquisition") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GpsL1CaPcpsTongAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L1_CA_PCPS_Multithread_Acquisition") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GpsL1CaPcpsMultithreadAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-
-#if OPENCL_BLOCKS
-    else if (implementation.compare("GPS_L1_CA_PCPS_OpenCl_Acquisition") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GpsL1CaPcpsOpenClAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-#endif
-
-    else if (implementation.compare("GPS_L1_CA_PCPS_Acquisition_Fine_Doppler") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GpsL1CaPcpsAcquisitionFineDoppler(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L1_CA_PCPS_QuickSync_Acquisition") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_( new GpsL1CaPcpsQuickSyncAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E1_PCPS_Ambiguous_Acquisition") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GalileoE1PcpsAmbiguousAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E1_PCPS_8ms_Ambiguous_Acquisition") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GalileoE1Pcps8msAmbiguousAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E1_PCPS_Tong_Ambiguous_Acquisition") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GalileoE1PcpsTongAmbiguousAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E1_PCPS_CCCWSR_Ambiguous_Acquisition") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GalileoE1PcpsCccwsrAmbiguousAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E5a_Noncoherent_IQ_Acquisition_CAF") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GalileoE5aNoncoherentIQAcquisitionCaf(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E1_PCPS_QuickSync_Ambiguous_Acquisition") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_( new GalileoE1PcpsQuickSyncAmbiguousAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-
-
-
-
-    // TRACKING BLOCKS -------------------------------------------------------------
-    else if (implementation.compare("GPS_L1_CA_DLL_PLL_Tracking") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GpsL1CaDllPllTracking(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L1_CA_DLL_PLL_C_Aid_Tracking") == 0)
-        {
-            std::unique_ptr<TrackingInterface> block_(new GpsL1CaDllPllCAidTracking(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L1_CA_TCP_CONNECTOR_Tracking") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GpsL1CaTcpConnectorTracking(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L2_M_DLL_PLL_Tracking") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GpsL2MDllPllTracking(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-#if CUDA_GPU_ACCEL
-    else if (implementation.compare("GPS_L1_CA_DLL_PLL_Tracking_GPU") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GpsL1CaDllPllTrackingGPU(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-#endif
-    else if (implementation.compare("Galileo_E1_DLL_PLL_VEML_Tracking") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GalileoE1DllPllVemlTracking(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E1_TCP_CONNECTOR_Tracking") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GalileoE1TcpConnectorTracking(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E5a_DLL_PLL_Tracking") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GalileoE5aDllPllTracking(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-
-    // TELEMETRY DECODERS ----------------------------------------------------------
-    else if (implementation.compare("GPS_L1_CA_Telemetry_Decoder") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GpsL1CaTelemetryDecoder(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L1_CA_SD_Telemetry_Decoder") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GpsL1CaSdTelemetryDecoder(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E1B_Telemetry_Decoder") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GalileoE1BTelemetryDecoder(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("SBAS_L1_Telemetry_Decoder") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new SbasL1TelemetryDecoder(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E5a_Telemetry_Decoder") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GalileoE5aTelemetryDecoder(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-
-    // OBSERVABLES -----------------------------------------------------------------
-    else if (implementation.compare("GPS_L1_CA_Observables") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GpsL1CaObservables(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-
-    else if (implementation.compare("Galileo_E1B_Observables") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GalileoE1Observables(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Hybrid_Observables") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new HybridObservables(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    // PVT -------------------------------------------------------------------------
-    else if (implementation.compare("GPS_L1_CA_PVT") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GpsL1CaPvt(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L1_CA_SD_PVT") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GpsL1CaSdPvt(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GALILEO_E1_PVT") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new GalileoE1Pvt(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Hybrid_PVT") == 0)
-        {
-            std::unique_ptr<GNSSBlockInterface> block_(new HybridPvt(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
+    Block_Maker maker = find_maker(implementation);
+    if (maker)
+        {
+            Block_Args args;
+            args.configuration = configuration.get();
+            args.role = role;
+            args.in_streams = in_streams;
+            args.out_streams = out_streams;
+            args.queue = queue;
+            args.spoofing_detector = spoofing_detector_;
+            block = maker(args);
         }
     else
         {
             // Log fatal. This causes execution to stop.
             LOG(ERROR) << role << "." << implementation << ": Undefined implementation for block";
         }
-    return std::move(block);
+    return block;
 }
 
 
 
-/*
- *
- * PLEASE ADD YOUR NEW BLOCK HERE!!
- *
- * Not very elegant, Acq, Trk and Tlm blocks must be added here, too.
- * To be improved!
- */
-
 std::unique_ptr<AcquisitionInterface> GNSSBlockFactory::GetAcqBlock(
         std::shared_ptr<ConfigurationInterface> configuration,
         std::string role,
         std::string implementation, unsigned int in_streams,
         unsigned int out_streams)
 {
-    std::unique_ptr<AcquisitionInterface> block;
-    // ACQUISITION BLOCKS ---------------------------------------------------------
-    if (implementation.compare("GPS_L1_CA_PCPS_Acquisition") == 0)
-        {
-            std::unique_ptr<AcquisitionInterface> block_(new GpsL1CaPcpsAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L1_CA_PCPS_SD_Acquisition") == 0)
-        {
-            std::unique_ptr<AcquisitionInterface> block_(new GpsL1CaPcpsSdAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L1_CA_PCPS_Assisted_Acquisition") == 0)
-        {
-            std::unique_ptr<AcquisitionInterface> block_(new GpsL1CaPcpsAssistedAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L1_CA_PCPS_Tong_Acquisition") == 0)
-        {
-            std::unique_ptr<AcquisitionInterface> block_(new GpsL1CaPcpsTongAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L1_CA_PCPS_Multithread_Acquisition") == 0)
-        {
-            std::unique_ptr<AcquisitionInterface> block_(new GpsL1CaPcpsMultithreadAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-
-#if OPENCL_BLOCKS
-    else if (implementation.compare("GPS_L1_CA_PCPS_OpenCl_Acquisition") == 0)
-        {
-            std::unique_ptr<AcquisitionInterface> block_(new GpsL1CaPcpsOpenClAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-#endif
-
-    else if (implementation.compare("GPS_L1_CA_PCPS_Acquisition_Fine_Doppler") == 0)
-        {
-            std::unique_ptr<AcquisitionInterface> block_(new GpsL1CaPcpsAcquisitionFineDoppler(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L1_CA_PCPS_QuickSync_Acquisition") == 0)
-        {
-            std::unique_ptr<AcquisitionInterface> block_( new GpsL1CaPcpsQuickSyncAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L2_M_PCPS_Acquisition") == 0)
-        {
-            std::unique_ptr<AcquisitionInterface> block_(new GpsL2MPcpsAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E1_PCPS_Ambiguous_Acquisition") == 0)
-        {
-            std::unique_ptr<AcquisitionInterface> block_(new GalileoE1PcpsAmbiguousAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E1_PCPS_8ms_Ambiguous_Acquisition") == 0)
-        {
-            std::unique_ptr<AcquisitionInterface> block_(new GalileoE1Pcps8msAmbiguousAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E1_PCPS_Tong_Ambiguous_Acquisition") == 0)
-        {
-            std::unique_ptr<AcquisitionInterface> block_(new GalileoE1PcpsTongAmbiguousAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E1_PCPS_CCCWSR_Ambiguous_Acquisition") == 0)
-        {
-            std::unique_ptr<AcquisitionInterface> block_(new GalileoE1PcpsCccwsrAmbiguousAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-
-    else if (implementation.compare("Galileo_E1_PCPS_QuickSync_Ambiguous_Acquisition") == 0)
-        {
-            std::unique_ptr<AcquisitionInterface> block_( new GalileoE1PcpsQuickSyncAmbiguousAcquisition(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E5a_Noncoherent_IQ_Acquisition_CAF") == 0)
-        {
-            std::unique_ptr<AcquisitionInterface> block_(new GalileoE5aNoncoherentIQAcquisitionCaf(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else
-        {
-            // Log fatal. This causes execution to stop.
-            LOG(ERROR) << role << "." << implementation << ": Undefined implementation for block";
-        }
-    return std::move(block);
+    return block_cast<AcquisitionInterface>(GetBlock(configuration, role, implementation, in_streams, out_streams), role, implementation);
 }
 
 
@@ -1205,65 +782,7 @@ std::unique_ptr<TrackingInterface> GNSSBlockFactory::GetTrkBlock(
         std::string implementation, unsigned int in_streams,
         unsigned int out_streams)
 {
-    std::unique_ptr<TrackingInterface> block;
-
-    // TRACKING BLOCKS -------------------------------------------------------------
-    if (implementation.compare("GPS_L1_CA_DLL_PLL_Tracking") == 0)
-        {
-            std::unique_ptr<TrackingInterface> block_(new GpsL1CaDllPllTracking(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L1_CA_DLL_PLL_C_Aid_Tracking") == 0)
-        {
-            std::unique_ptr<TrackingInterface> block_(new GpsL1CaDllPllCAidTracking(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L1_CA_TCP_CONNECTOR_Tracking") == 0)
-        {
-            std::unique_ptr<TrackingInterface> block_(new GpsL1CaTcpConnectorTracking(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E1_DLL_PLL_VEML_Tracking") == 0)
-        {
-            std::unique_ptr<TrackingInterface> block_(new GalileoE1DllPllVemlTracking(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E1_TCP_CONNECTOR_Tracking") == 0)
-        {
-            std::unique_ptr<TrackingInterface> block_(new GalileoE1TcpConnectorTracking(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E5a_DLL_PLL_Tracking") == 0)
-        {
-            std::unique_ptr<TrackingInterface> block_(new GalileoE5aDllPllTracking(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L2_M_DLL_PLL_Tracking") == 0)
-        {
-            std::unique_ptr<TrackingInterface> block_(new GpsL2MDllPllTracking(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-#if CUDA_GPU_ACCEL
-    else if (implementation.compare("GPS_L1_CA_DLL_PLL_Tracking_GPU") == 0)
-        {
-            std::unique_ptr<TrackingInterface> block_(new GpsL1CaDllPllTrackingGPU(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-#endif
-    else
-        {
-            // Log fatal. This causes execution to stop.
-            LOG(ERROR) << role << "." << implementation << ": Undefined implementation for block";
-        }
-    return std::move(block);
+    return block_cast<TrackingInterface>(GetBlock(configuration, role, implementation, in_streams, out_streams), role, implementation);
 }
 
 
@@ -1273,89 +792,179 @@ std::unique_ptr<TelemetryDecoderInterface> GNSSBlockFactory::GetTlmBlock(
         std::string implementation, unsigned int in_streams,
         unsigned int out_streams)
 {
-    std::unique_ptr<TelemetryDecoderInterface> block;
-    
-    // TELEMETRY DECODERS ----------------------------------------------------------
-    if (implementation.compare("GPS_L1_CA_Telemetry_Decoder") == 0)
-        {
-            std::unique_ptr<TelemetryDecoderInterface> block_(new GpsL1CaTelemetryDecoder(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L1_CA_SD_Telemetry_Decoder") == 0)
-        {
-            std::unique_ptr<TelemetryDecoderInterface> block_(new GpsL1CaSdTelemetryDecoder(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E1B_Telemetry_Decoder") == 0)
-        {
-            std::unique_ptr<TelemetryDecoderInterface> block_(new GalileoE1BTelemetryDecoder(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("SBAS_L1_Telemetry_Decoder") == 0)
-        {
-            std::unique_ptr<TelemetryDecoderInterface> block_(new SbasL1TelemetryDecoder(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Galileo_E5a_Telemetry_Decoder") == 0)
-        {
-            std::unique_ptr<TelemetryDecoderInterface> block_(new GalileoE5aTelemetryDecoder(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L2_M_Telemetry_Decoder") == 0)
-        {
-            std::unique_ptr<TelemetryDecoderInterface> block_(new GpsL2MTelemetryDecoder(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else
-        {
-            // Log fatal. This causes execution to stop.
-            LOG(ERROR) << role << "." << implementation << ": Undefined implementation for block";
-        }
-    return std::move(block);
+    return block_cast<TelemetryDecoderInterface>(GetBlock(configuration, role, implementation, in_streams, out_streams), role, implementation);
 }
 
+
 std::unique_ptr<PvtInterface> GNSSBlockFactory::GetPVTBlock(
         std::shared_ptr<ConfigurationInterface> configuration,
         std::string role,
         std::string implementation, unsigned int in_streams,
         unsigned int out_streams)
 {
-    std::unique_ptr<PvtInterface> block;
-    // PVT -------------------------------------------------------------------------
-    if (implementation.compare("GPS_L1_CA_PVT") == 0)
-        {
-            std::unique_ptr<PvtInterface> block_(new GpsL1CaPvt(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GPS_L1_CA_SD_PVT") == 0)
-        {
-            std::unique_ptr<PvtInterface> block_(new GpsL1CaSdPvt(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("GALILEO_E1_PVT") == 0)
-        {
-            std::unique_ptr<PvtInterface> block_(new GalileoE1Pvt(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
-        }
-    else if (implementation.compare("Hybrid_PVT") == 0)
+    return block_cast<PvtInterface>(GetBlock(configuration, role, implementation, in_streams, out_streams), role, implementation);
+}
+
+
+
+bool GNSSBlockFactory::register_block(const std::string& implementation, Block_Maker maker)
+{
+    boost::mutex::scoped_lock lock(registry_mutex());
+    bool inserted = registry().insert(std::make_pair(implementation, maker)).second;
+    if (!inserted)
         {
-            std::unique_ptr<PvtInterface> block_(new HybridPvt(configuration.get(), role, in_streams,
-                    out_streams));
-            block = std::move(block_);
+            LOG(WARNING) << implementation << ": implementation already registered, the first one is kept";
         }
-    else
+    return inserted;
+}
+
+
+bool GNSSBlockFactory::is_registered(const std::string& implementation)
+{
+    return static_cast<bool>(find_maker(implementation));
+}
+
+
+GNSSBlockFactory::Block_Maker GNSSBlockFactory::find_maker(const std::string& implementation)
+{
+    boost::mutex::scoped_lock lock(registry_mutex());
+    std::unordered_map<std::string, Block_Maker>::const_iterator it = registry().find(implementation);
+    if (it == registry().end())
         {
-            // Log fatal. This causes execution to stop.
-            LOG(ERROR) << role << "." << implementation << ": Undefined implementation for block";
+            return Block_Maker();
         }
-    return std::move(block);
+    return it->second;
+}
+
+
+boost::mutex& GNSSBlockFactory::registry_mutex()
+{
+    static boost::mutex mutex;
+    return mutex;
+}
+
+
+std::unordered_map<std::string, GNSSBlockFactory::Block_Maker>& GNSSBlockFactory::registry()
+{
+    // Built on first use, so that the Block_Registrar of other translation
+    // units may register blocks during the static initialization
+    static std::unordered_map<std::string, Block_Maker> blocks = builtin_blocks();
+    return blocks;
+}
+
+
+/*
+ * The blocks of the tree are registered here and not by Block_Registrar
+ * objects next to them: the linker drops the objects of a static library
+ * that nothing references.
+ *
+ * PLEASE ADD YOUR NEW BLOCK HERE!!
+ */
+std::unordered_map<std::string, GNSSBlockFactory::Block_Maker> GNSSBlockFactory::builtin_blocks()
+{
+    std::unordered_map<std::string, Block_Maker> blocks;
+
+    //PASS THROUGH ----------------------------------------------------------------
+    blocks["Pass_Through"] = make_block<Pass_Through>;
+
+    // SIGNAL SOURCES -------------------------------------------------------------
+    blocks["File_Signal_Source"] = make_file_source<FileSignalSource>;
+    blocks["Chunked_Capture_Signal_Source"] = make_file_source<ChunkedCaptureSignalSource>;
+    blocks["Shared_Ring_Signal_Source"] = make_file_source<SharedRingSignalSource>;
+    blocks["Iq_Stream_Signal_Source"] = make_file_source<IqStreamSignalSource>;
+    blocks["Nsr_File_Signal_Source"] = make_file_source<NsrFileSignalSource>;
+#if MODERN_GNURADIO
+    blocks["Two_Bit_Cpx_File_Signal_Source"] = make_file_source<TwoBitCpxFileSignalSource>;
+    blocks["Two_Bit_Packed_File_Signal_Source"] = make_file_source<TwoBitPackedFileSignalSource>;
+#endif
+    blocks["Spir_File_Signal_Source"] = make_file_source<SpirFileSignalSource>;
+    blocks["RtlTcp_Signal_Source"] = make_file_source<RtlTcpSignalSource>;
+#if UHD_DRIVER
+    blocks["UHD_Signal_Source"] = make_source<UhdSignalSource>;
+#endif
+#if GN3S_DRIVER
+    blocks["GN3S_Signal_Source"] = make_source<Gn3sSignalSource>;
+#endif
+#if RAW_ARRAY_DRIVER
+    blocks["Raw_Array_Signal_Source"] = make_source<RawArraySignalSource>;
+#endif
+#if OSMOSDR_DRIVER
+    blocks["Osmosdr_Signal_Source"] = make_source<OsmosdrSignalSource>;
+#endif
+#if FLEXIBAND_DRIVER
+    blocks["Flexiband_Signal_Source"] = make_source<FlexibandSignalSource>;
+#endif
+
+    // DATA TYPE ADAPTER -----------------------------------------------------------
+    blocks["Byte_To_Short"] = make_block<ByteToShort>;
+    blocks["Ibyte_To_Cbyte"] = make_block<IbyteToCbyte>;
+    blocks["Ibyte_To_Cshort"] = make_block<IbyteToCshort>;
+    blocks["Ibyte_To_Complex"] = make_block<IbyteToComplex>;
+    blocks["Ishort_To_Cshort"] = make_block<IshortToCshort>;
+    blocks["Ishort_To_Complex"] = make_block<IshortToComplex>;
+
+    // INPUT FILTER ----------------------------------------------------------------
+    blocks["Fir_Filter"] = make_block<FirFilter>;
+    blocks["Freq_Xlating_Fir_Filter"] = make_block<FreqXlatingFirFilter>;
+    blocks["Fused_Xlating_Fir_Filter"] = make_block<FusedXlatingFirFilter>;
+    blocks["Beamformer_Filter"] = make_block<BeamformerFilter>;
+
+    // RESAMPLER -------------------------------------------------------------------
+    blocks["Direct_Resampler"] = make_block<DirectResamplerConditioner>;
+
+    // ACQUISITION BLOCKS ---------------------------------------------------------
+    blocks["GPS_L1_CA_PCPS_Acquisition"] = make_block<GpsL1CaPcpsAcquisition>;
+    blocks["GPS_L1_CA_PCPS_SD_Acquisition"] = make_block<GpsL1CaPcpsSdAcquisition>;
+    blocks["GPS_L1_CA_PCPS_Assisted_Acquisition"] = make_block<GpsL1CaPcpsAssistedAcquisition>;
+    blocks["GPS_L1_CA_PCPS_Tong_Acquisition"] = make_block<GpsL1CaPcpsTongAcquisition>;
+    blocks["GPS_L1_CA_PCPS_Multithread_Acquisition"] = make_block<GpsL1CaPcpsMultithreadAcquisition>;
+    blocks["GPS_L1_CA_PCPS_Server_Acquisition"] = make_block<GpsL1CaPcpsServerAcquisition>;
+#if OPENCL_BLOCKS
+    blocks["GPS_L1_CA_PCPS_OpenCl_Acquisition"] = make_block<GpsL1CaPcpsOpenClAcquisition>;
+#endif
+#if CUDA_GPU_ACCEL
+    blocks["GPS_L1_CA_PCPS_CUDA_Acquisition"] = make_block<GpsL1CaPcpsCudaAcquisition>;
+#endif
+    blocks["GPS_L1_CA_PCPS_Acquisition_Fine_Doppler"] = make_block<GpsL1CaPcpsAcquisitionFineDoppler>;
+    blocks["GPS_L1_CA_PCPS_QuickSync_Acquisition"] = make_block<GpsL1CaPcpsQuickSyncAcquisition>;
+    blocks["GPS_L2_M_PCPS_Acquisition"] = make_block<GpsL2MPcpsAcquisition>;
+    blocks["Galileo_E1_PCPS_Ambiguous_Acquisition"] = make_block<GalileoE1PcpsAmbiguousAcquisition>;
+    blocks["Galileo_E1_PCPS_8ms_Ambiguous_Acquisition"] = make_block<GalileoE1Pcps8msAmbiguousAcquisition>;
+    blocks["Galileo_E1_PCPS_Tong_Ambiguous_Acquisition"] = make_block<GalileoE1PcpsTongAmbiguousAcquisition>;
+    blocks["Galileo_E1_PCPS_CCCWSR_Ambiguous_Acquisition"] = make_block<GalileoE1PcpsCccwsrAmbiguousAcquisition>;
+    blocks["Galileo_E1_PCPS_QuickSync_Ambiguous_Acquisition"] = make_block<GalileoE1PcpsQuickSyncAmbiguousAcquisition>;
+    blocks["Galileo_E5a_Noncoherent_IQ_Acquisition_CAF"] = make_block<GalileoE5aNoncoherentIQAcquisitionCaf>;
+
+    // TRACKING BLOCKS -------------------------------------------------------------
+    blocks["GPS_L1_CA_DLL_PLL_Tracking"] = make_block<GpsL1CaDllPllTracking>;
+    blocks["GPS_L1_CA_DLL_PLL_C_Aid_Tracking"] = make_block<GpsL1CaDllPllCAidTracking>;
+    blocks["GPS_L1_CA_TCP_CONNECTOR_Tracking"] = make_block<GpsL1CaTcpConnectorTracking>;
+    blocks["GPS_L2_M_DLL_PLL_Tracking"] = make_block<GpsL2MDllPllTracking>;
+#if CUDA_GPU_ACCEL
+    blocks["GPS_L1_CA_DLL_PLL_Tracking_GPU"] = make_block<GpsL1CaDllPllTrackingGPU>;
+#endif
+    blocks["Galileo_E1_DLL_PLL_VEML_Tracking"] = make_block<GalileoE1DllPllVemlTracking>;
+    blocks["Galileo_E1_TCP_CONNECTOR_Tracking"] = make_block<GalileoE1TcpConnectorTracking>;
+    blocks["Galileo_E5a_DLL_PLL_Tracking"] = make_block<GalileoE5aDllPllTracking>;
+
+    // TELEMETRY DECODERS ----------------------------------------------------------
+    blocks["GPS_L1_CA_Telemetry_Decoder"] = make_block<GpsL1CaTelemetryDecoder>;
+    blocks["GPS_L1_CA_SD_Telemetry_Decoder"] = make_spoofing_block<GpsL1CaSdTelemetryDecoder>;
+    blocks["GPS_L2_M_Telemetry_Decoder"] = make_block<GpsL2MTelemetryDecoder>;
+    blocks["Galileo_E1B_Telemetry_Decoder"] = make_spoofing_block<GalileoE1BTelemetryDecoder>;
+    blocks["SBAS_L1_Telemetry_Decoder"] = make_block<SbasL1TelemetryDecoder>;
+    blocks["Galileo_E5a_Telemetry_Decoder"] = make_block<GalileoE5aTelemetryDecoder>;
+
+    // OBSERVABLES -----------------------------------------------------------------
+    blocks["GPS_L1_CA_Observables"] = make_block<GpsL1CaObservables>;
+    blocks["Galileo_E1B_Observables"] = make_block<GalileoE1Observables>;
+    blocks["Hybrid_Observables"] = make_block<HybridObservables>;
+
+    // PVT -------------------------------------------------------------------------
+    blocks["GPS_L1_CA_PVT"] = make_block<GpsL1CaPvt>;
+    blocks["GPS_L1_CA_SD_PVT"] = make_spoofing_block<GpsL1CaSdPvt>;
+    blocks["GALILEO_E1_PVT"] = make_block<GalileoE1Pvt>;
+    blocks["Hybrid_PVT"] = make_block<HybridPvt>;
+
+    return blocks;
 }
@@ -41,9 +41,12 @@
 #ifndef GNSS_SDR_BLOCK_FACTORY_H_
 #define GNSS_SDR_BLOCK_FACTORY_H_
 
+#include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
+#include <boost/thread/mutex.hpp>
 #include <gnuradio/msg_queue.h>
 
 class ConfigurationInterface;
@@ -52,13 +55,40 @@ class AcquisitionInterface;
 class TrackingInterface;
 class TelemetryDecoderInterface;
 class PvtInterface;
+class Spoofing_Detector;
 
 /*!
  * \brief Class that produces all kinds of GNSS blocks
+ *
+ * The blocks are built by the makers registered under the name of their
+ * implementation, the value of the <role>.implementation property.
  */
 class GNSSBlockFactory
 {
 public:
+    /*!
+     * \brief Arguments of the constructor of a block
+     */
+    struct Block_Args
+    {
+        ConfigurationInterface* configuration;
+        std::string role;
+        unsigned int in_streams;
+        unsigned int out_streams;
+        boost::shared_ptr<gr::msg_queue> queue;                //!< For the signal sources
+        std::shared_ptr<Spoofing_Detector> spoofing_detector; //!< For the blocks that feed the spoofing detector
+    };
+
+    typedef std::function<std::unique_ptr<GNSSBlockInterface>(const Block_Args&)> Block_Maker;
+
+    /*!
+     * \brief Registers the maker of an implementation
+     * \return false if the implementation was already registered, which keeps its first maker
+     */
+    static bool register_block(const std::string& implementation, Block_Maker maker);
+
+    static bool is_registered(const std::string& implementation);
+
     GNSSBlockFactory();
     virtual ~GNSSBlockFactory();
     std::unique_ptr<GNSSBlockInterface> GetSignalSource(std::shared_ptr<ConfigurationInterface> configuration,
@@ -82,8 +112,21 @@ public:
             unsigned int in_streams, unsigned int out_streams,
             boost::shared_ptr<gr::msg_queue> queue = nullptr);
 
+    /*
+     * \brief Sets the spoofing detector shared by all the blocks created afterwards
+     */
+    void set_spoofing_detector(std::shared_ptr<Spoofing_Detector> spoofing_detector)
+    {
+        spoofing_detector_ = spoofing_detector;
+    }
 
 private:
+    static Block_Maker find_maker(const std::string& implementation);
+    static boost::mutex& registry_mutex();
+    static std::unordered_map<std::string, Block_Maker>& registry();
+    static std::unordered_map<std::string, Block_Maker> builtin_blocks();
+
+    std::shared_ptr<Spoofing_Detector> spoofing_detector_;
 
     std::unique_ptr<GNSSBlockInterface> GetChannel_1C(std::shared_ptr<ConfigurationInterface> configuration,
             std::string acq, std::string trk, std::string tlm, int channel,
@@ -126,5 +169,21 @@ private:
             unsigned int out_streams);
 };
 
+
+/*!
+ * \brief Registers a block built out of the tree, during the static
+ * initialization of the program or when its library is loaded:
+ *
+ * static Block_Registrar my_block_registrar("My_Block", make_my_block);
+ */
+class Block_Registrar
+{
+public:
+    Block_Registrar(const std::string& implementation, GNSSBlockFactory::Block_Maker maker)
+    {
+        GNSSBlockFactory::register_block(implementation, maker);
+    }
+};
+
 #endif /*GNSS_SDR_BLOCK_FACTORY_H_*/
 
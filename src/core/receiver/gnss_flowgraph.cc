@@ -40,36 +40,40 @@
 
 #include <memory>
 #include <algorithm>
+#include <cmath>
 #include <exception>
 #include <iostream>
 #include <set>
 #include <boost/lexical_cast.hpp>
 #include <boost/tokenizer.hpp>
 #include <glog/logging.h>
+#include <gnuradio/block.h>
+#include <gnuradio/block_detail.h>
+#include <gnuradio/buffer.h>
 #include "configuration_interface.h"
 #include "gnss_block_interface.h"
 #include "channel_interface.h"
 #include "gnss_block_factory.h"
-#include "concurrent_map.h"
+#include "receiver_state.h"
+#include "spoofing_detector.h"
+#include "channel.h"
+#include "signal_conditioner.h"
+#include "thread_placement.h"
+#include "acquisition_thread_pool.h"
+#include "telemetry_decode_pool.h"
+#include "fft_plan_cache.h"
+#include "source_aligner.h"
+#include "realtime_margin_monitor.h"
+#include "block_metrics.h"
+#include "sample_history_sink.h"
+#include "buffer_allocator.h"
+#include "static_limits.h"
+#include "latency_trace_probe.h"
 
 #define GNSS_SDR_ARRAY_SIGNAL_CONDITIONER_CHANNELS 8
 
 using google::LogMessage;
-struct Subframe{
-    std::string subframe;
-    int id;
-    double timestamp;
-};
-extern concurrent_map<Subframe> global_subframe_map;
-
-struct GPS_time_t{
-    int week;
-    double TOW;
-    int subframe_id;
-};
-
-extern concurrent_map<GPS_time_t> global_gps_time;
-extern concurrent_map<std::map<unsigned int, unsigned int>> global_subframe_check;
+
 
 GNSSFlowgraph::GNSSFlowgraph(std::shared_ptr<ConfigurationInterface> configuration,
         boost::shared_ptr<gr::msg_queue> queue)
@@ -78,6 +82,7 @@ GNSSFlowgraph::GNSSFlowgraph(std::shared_ptr<ConfigurationInterface> configurati
     running_ = false;
     configuration_ = configuration;
     queue_ = queue;
+    state_ = std::make_shared<Receiver_State>();
     init();
 }
 
@@ -117,8 +122,15 @@ void GNSSFlowgraph::stop()
     //            LOG(INFO) << "Channel " << i << " in state " << channels_state_[i];
     //        }
     //    LOG(INFO) << "Threads finished. Return to main program.";
+    report_buffers();
     top_block_->stop();
     running_ = false;
+    if (!latency_trace_file_.empty())
+        {
+            Latency_Trace::stop();
+            Latency_Trace::log_summary();
+            Latency_Trace::write_chrome_trace(latency_trace_file_);
+        }
 }
 
 
@@ -134,6 +146,8 @@ void GNSSFlowgraph::connect()
             LOG(WARNING) << "flowgraph already connected";
             return;
         }
+    // the blocks built while connecting keep the tables of this receiver
+    Receiver_State_Scope state_scope(state_);
 
     for (int i = 0; i < sources_count_; i++)
         {
@@ -208,7 +222,11 @@ void GNSSFlowgraph::connect()
     }
 
     DLOG(INFO) << "blocks connected internally";
-    // Signal Source (i) >  Signal conditioner (i) >
+    // Signal Source (i) > [Source aligner] > Signal conditioner (i) >
+    if (configuration_->property("Receiver.align_sources", false) && (sig_conditioner_.size() > 1))
+        {
+            create_source_aligner();
+        }
     int RF_Channels = 0;
     int signal_conditioner_ID = 0;
 
@@ -246,7 +264,7 @@ void GNSSFlowgraph::connect()
                                         {
 
                                             LOG(INFO) << "connecting sig_source_ " << i << " stream " << j << " to conditioner " << j;
-                                            top_block_->connect(sig_source_.at(i)->get_right_block(), j, sig_conditioner_.at(signal_conditioner_ID)->get_left_block(), 0);
+                                            connect_source_stream(sig_source_.at(i)->get_right_block(), j, signal_conditioner_ID);
 
                                         }
                                     else
@@ -255,13 +273,13 @@ void GNSSFlowgraph::connect()
                                                 {
                                                     // RF_channel 0 backward compatibility with single channel sources
                                                     LOG(INFO)  <<  "connecting sig_source_ " << i << " stream " << 0 << " to conditioner " << j;
-                                                    top_block_->connect(sig_source_.at(i)->get_right_block(), 0, sig_conditioner_.at(signal_conditioner_ID)->get_left_block(), 0);
+                                                    connect_source_stream(sig_source_.at(i)->get_right_block(), 0, signal_conditioner_ID);
                                                 }
                                             else
                                                 {
                                                     // Multiple channel sources using multiple output blocks of single channel (requires RF_channel selector in call)
                                                     LOG(INFO) << "connecting sig_source_ " << i << " stream " << j << " to conditioner " << j;
-                                                    top_block_->connect(sig_source_.at(i)->get_right_block(j), 0, sig_conditioner_.at(signal_conditioner_ID)->get_left_block(), 0);
+                                                    connect_source_stream(sig_source_.at(i)->get_right_block(j), 0, signal_conditioner_ID);
                                                 }
                                         }
 
@@ -279,6 +297,34 @@ void GNSSFlowgraph::connect()
         }
     DLOG(INFO) << "Signal source connected to signal conditioner";
 
+    // Signal conditioner (i) >> sample history (i)
+    for (unsigned int i = 0; i < history_sinks_.size(); i++)
+        {
+            try
+            {
+                    top_block_->connect(sig_conditioner_.at(i)->get_right_block(), 0, history_sinks_.at(i), 0);
+            }
+            catch (std::exception& e)
+            {
+                    LOG(WARNING) << "Can't connect signal conditioner " << i << " to its sample history (gr_complex samples only)";
+                    LOG(ERROR) << e.what();
+                    top_block_->disconnect_all();
+                    return;
+            }
+        }
+
+    // Signal conditioner (i) >> latency trace probe
+    if (!latency_trace_file_.empty())
+        {
+            for (unsigned int i = 0; i < sig_conditioner_.size(); i++)
+                {
+                    gr::basic_block_sptr conditioner = sig_conditioner_.at(i)->get_right_block();
+                    latency_probes_.push_back(make_latency_trace_probe(conditioner->output_signature()->sizeof_stream_item(0),
+                            LATENCY_CONDITIONER, i, 1.0));
+                    top_block_->connect(conditioner, 0, latency_probes_.back(), 0);
+                }
+        }
+
     // Signal conditioner (selected_signal_source) >> channels (i) (dependent of their associated SignalSource_ID)
     int selected_signal_conditioner_ID;
     for (unsigned int i = 0; i < channels_count_; i++)
@@ -286,8 +332,16 @@ void GNSSFlowgraph::connect()
             selected_signal_conditioner_ID = configuration_->property("Channel" + boost::lexical_cast<std::string>(i) + ".RF_channel_ID", 0);
             try
             {
-                    top_block_->connect(sig_conditioner_.at(selected_signal_conditioner_ID)->get_right_block(), 0,
-                            channels_.at(i)->get_left_block(), 0);
+                    std::shared_ptr<Channel> channel = std::dynamic_pointer_cast<Channel>(channels_.at(i));
+                    if (channel)
+                        {
+                            channel->connect_input(top_block_, sig_conditioner_.at(selected_signal_conditioner_ID)->get_right_block(), 0);
+                        }
+                    else
+                        {
+                            top_block_->connect(sig_conditioner_.at(selected_signal_conditioner_ID)->get_right_block(), 0,
+                                    channels_.at(i)->get_left_block(), 0);
+                        }
             }
             catch (std::exception& e)
             {
@@ -299,6 +353,30 @@ void GNSSFlowgraph::connect()
 
             DLOG(INFO) << "signal conditioner " << selected_signal_conditioner_ID << " connected to channel " << i;
 
+            // Raw array source >> tracking (i), the elements for the angle of arrival
+            std::shared_ptr<Channel> array_channel = std::dynamic_pointer_cast<Channel>(channels_.at(i));
+            if (array_channel && selected_signal_conditioner_ID < sources_count_
+                    && sig_source_.at(selected_signal_conditioner_ID)->implementation().compare("Raw_Array_Signal_Source") == 0
+                    && configuration_->property(array_channel->tracking()->role() + ".aoa_decimation", 0) > 0)
+                {
+                    try
+                    {
+                            for (int j = 0; j < GNSS_SDR_ARRAY_SIGNAL_CONDITIONER_CHANNELS; j++)
+                                {
+                                    top_block_->connect(sig_source_.at(selected_signal_conditioner_ID)->get_right_block(), j,
+                                            array_channel->tracking()->get_left_block(), 1 + j);
+                                }
+                    }
+                    catch (std::exception& e)
+                    {
+                            LOG(WARNING) << "Can't connect the array elements to the tracking of channel " << i;
+                            LOG(ERROR) << e.what();
+                            top_block_->disconnect_all();
+                            return;
+                    }
+                    DLOG(INFO) << "array elements connected to the tracking of channel " << i;
+                }
+
             // Signal Source > Signal conditioner >> Channels >> Observables
             try
             {
@@ -313,23 +391,16 @@ void GNSSFlowgraph::connect()
                     return;
             }
 
-            std::string gnss_signal = channels_.at(i)->get_signal().get_signal_str(); // use channel's implicit signal!
-            while (gnss_signal.compare(available_GNSS_signals_.front().get_signal_str()) != 0 )
+            // use channel's implicit signal!
+            if (assign_next_signal(i))
                 {
-                    available_GNSS_signals_.push_back(available_GNSS_signals_.front());
-                    available_GNSS_signals_.pop_front();
+                    LOG(INFO) << "Channel " << i << " assigned to " << channels_.at(i)->get_signal();
+                    AssignACQState(channels_.at(i)->get_signal().get_satellite().get_PRN(), i);
                 }
-            channels_.at(i)->set_signal(available_GNSS_signals_.front());
-
-            LOG(INFO) << "Channel " << i << " assigned to " << available_GNSS_signals_.front();
-            AssignACQState(available_GNSS_signals_.front().get_satellite().get_PRN(), i);
-            available_GNSS_signals_.pop_front();
 
             if (channels_state_[i] == 1)
                 {
                     channels_.at(i)->start_acquisition();
-                    available_GNSS_signals_.pop_front();
-                    LOG(INFO) << "Channel " << i << " assigned to " << available_GNSS_signals_.front();
                     LOG(INFO) << "Channel " << i << " connected to observables and ready for acquisition";
                 }
             else
@@ -357,12 +428,252 @@ void GNSSFlowgraph::connect()
             return;
     }
 
+    set_buffer_policy();
+    set_thread_policy();
     connected_ = true;
-    LOG(INFO) << "Flowgraph connected";
+    unsigned int elided_blocks = 0;
+    for (unsigned int i = 0; i < sig_conditioner_.size(); i++)
+        {
+            std::shared_ptr<SignalConditioner> conditioner = std::dynamic_pointer_cast<SignalConditioner>(sig_conditioner_.at(i));
+            if (conditioner)
+                {
+                    elided_blocks += conditioner->elided_stages();
+                }
+        }
+    for (unsigned int i = 0; i < channels_count_; i++)
+        {
+            std::shared_ptr<Channel> channel = std::dynamic_pointer_cast<Channel>(channels_.at(i));
+            if (channel && channel->pass_through_elided())
+                {
+                    elided_blocks++;
+                }
+        }
+    LOG(INFO) << "Flowgraph connected, " << elided_blocks << " Pass_Through blocks left out";
     top_block_->dump();
 }
 
 
+void GNSSFlowgraph::size_buffer(const std::string& name, gr::basic_block_sptr block, double items_per_ms,
+        const std::vector<int>& processor_affinity)
+{
+    gr::block_sptr gr_block = boost::dynamic_pointer_cast<gr::block>(block);
+    if (!gr_block)
+        {
+            return; // a hierarchical block, its inner blocks keep the defaults
+        }
+    double latency_ms = configuration_->property("Receiver.buffer_latency_ms", 0.0);
+    if (latency_ms > 0.0)
+        {
+            // GNU Radio raises the size again to twice what the readers of the buffer
+            // need in one call (decimation, output multiple and history), so it stays safe
+            long items = std::max(1L, static_cast<long>(std::ceil(latency_ms * items_per_ms)));
+            gr_block->set_max_output_buffer(items);
+        }
+    if (!processor_affinity.empty())
+        {
+            // the pages of a buffer are allocated where its writer first touches them
+            gr_block->set_processor_affinity(processor_affinity);
+        }
+    sized_blocks_.push_back(std::make_pair(name, gr_block));
+}
+
+
+void GNSSFlowgraph::set_buffer_policy()
+{
+    sized_blocks_.clear();
+    int signal_conditioner_ID = 0;
+    for (int i = 0; i < sources_count_; i++)
+        {
+            const std::string role = sig_source_.at(i)->role();
+            std::vector<int> processor_affinity = parse_cpu_list(configuration_->property(role + ".processor_affinity", std::string("")));
+            double source_fs = configuration_->property(role + ".sampling_frequency", 4.0e6);
+            size_buffer(role, sig_source_.at(i)->get_right_block(), source_fs / 1000.0, processor_affinity);
+
+            // the conditioners of a front-end run next to it
+            int RF_Channels = configuration_->property(role + ".RF_channels", 1);
+            double internal_fs = configuration_->property("GNSS-SDR.internal_fs_hz", source_fs);
+            for (int j = 0; (j < RF_Channels) && (signal_conditioner_ID < static_cast<int>(sig_conditioner_.size())); j++)
+                {
+                    size_buffer(sig_conditioner_.at(signal_conditioner_ID)->role(), sig_conditioner_.at(signal_conditioner_ID)->get_right_block(),
+                            internal_fs / 1000.0, processor_affinity);
+                    signal_conditioner_ID++;
+                }
+        }
+    if (source_aligner_)
+        {
+            size_buffer("Source aligner", source_aligner_, configuration_->property("GNSS-SDR.internal_fs_hz", 4.0e6) / 1000.0, std::vector<int>());
+        }
+    // one Gnss_Synchro per channel and code period, at most one per ms
+    for (unsigned int i = 0; i < channels_count_; i++)
+        {
+            size_buffer("Channel" + boost::lexical_cast<std::string>(i), channels_.at(i)->get_right_block(), 1.0, std::vector<int>());
+        }
+    size_buffer("Observables", observables_->get_right_block(), 1.0, std::vector<int>());
+}
+
+
+void GNSSFlowgraph::set_thread_policy()
+{
+    // the source and its conditioners are placed by SignalSourceN.processor_affinity
+    int source_priority = configuration_->property("Receiver.source_thread_priority", 0);
+    if (source_priority > 0)
+        {
+            int signal_conditioner_ID = 0;
+            for (int i = 0; i < sources_count_; i++)
+                {
+                    place_block(sig_source_.at(i)->get_right_block(), std::vector<int>(), source_priority);
+                    int RF_Channels = configuration_->property(sig_source_.at(i)->role() + ".RF_channels", 1);
+                    for (int j = 0; (j < RF_Channels) && (signal_conditioner_ID < static_cast<int>(sig_conditioner_.size())); j++)
+                        {
+                            place_block(sig_conditioner_.at(signal_conditioner_ID)->get_right_block(), std::vector<int>(), source_priority);
+                            signal_conditioner_ID++;
+                        }
+                }
+            LOG(INFO) << "Source threads at priority " << source_priority;
+        }
+
+    // the channels are grouped on the tracking CPUs, their acquisitions go elsewhere
+    std::vector<int> tracking_cpus = parse_cpu_list(configuration_->property("Receiver.tracking_cpus", std::string("")));
+    std::vector<int> acquisition_cpus = parse_cpu_list(configuration_->property("Receiver.acquisition_cpus", std::string("")));
+    int tracking_priority = configuration_->property("Receiver.tracking_thread_priority", 0);
+    unsigned int per_cpu = 1;
+    if (!tracking_cpus.empty())
+        {
+            per_cpu = (channels_count_ + tracking_cpus.size() - 1) / tracking_cpus.size();
+            per_cpu = configuration_->property("Receiver.tracking_channels_per_cpu", std::max(per_cpu, 1U));
+            per_cpu = std::max(per_cpu, 1U);
+        }
+    for (unsigned int i = 0; i < channels_count_; i++)
+        {
+            std::shared_ptr<Channel> channel = std::dynamic_pointer_cast<Channel>(channels_.at(i));
+            if (!channel)
+                {
+                    continue;
+                }
+            std::vector<int> cpus;
+            if (!tracking_cpus.empty())
+                {
+                    cpus.push_back(tracking_cpus.at((i / per_cpu) % tracking_cpus.size()));
+                }
+            if (!cpus.empty() || tracking_priority > 0)
+                {
+                    place_block(channel->get_left_block(), cpus, tracking_priority);
+                    place_block(channel->tracking()->get_left_block(), cpus, tracking_priority);
+                    place_block(channel->telemetry()->get_right_block(), cpus, tracking_priority);
+                    LOG(INFO) << "Channel " << i << " tracks on CPU " << (cpus.empty() ? -1 : cpus.front())
+                              << " at priority " << tracking_priority;
+                }
+            if (!acquisition_cpus.empty())
+                {
+                    place_block(channel->acquisition()->get_left_block(), acquisition_cpus, 0);
+                    place_block(channel->acquisition()->get_right_block(), acquisition_cpus, 0);
+                }
+        }
+
+    std::vector<int> pvt_cpus = parse_cpu_list(configuration_->property("Receiver.pvt_cpus", std::string("")));
+    if (!pvt_cpus.empty())
+        {
+            place_block(observables_->get_right_block(), pvt_cpus, 0);
+            place_block(pvt_->get_right_block(), pvt_cpus, 0);
+        }
+}
+
+
+void GNSSFlowgraph::report_buffers()
+{
+    long total_bytes = 0;
+    for (unsigned int i = 0; i < sized_blocks_.size(); i++)
+        {
+            gr::block_sptr block = sized_blocks_.at(i).second;
+            if (!block->detail())
+                {
+                    continue; // not started
+                }
+            for (int port = 0; port < block->detail()->noutputs(); port++)
+                {
+                    gr::buffer_sptr buffer = block->detail()->output(port);
+                    const long bytes = static_cast<long>(buffer->bufsize()) * block->output_signature()->sizeof_stream_item(port);
+                    total_bytes += bytes;
+                    // the occupancy needs GNU Radio built with ENABLE_PERFORMANCE_COUNTERS, and [PerfCounters] on
+                    LOG(INFO) << "Buffer of " << sized_blocks_.at(i).first << " port " << port << ": " << buffer->bufsize()
+                              << " items, " << bytes / 1024 << " kB, " << 100.0 * block->pc_output_buffers_full_avg(port)
+                              << " % full on average";
+                }
+        }
+    LOG(INFO) << "Sample and observable buffers: " << total_bytes / 1024 << " kB";
+    Buffer_Allocator::log_usage();
+}
+
+
+void GNSSFlowgraph::create_source_aligner()
+{
+    std::vector<size_t> item_sizes;
+    std::vector<double> sample_rates_hz;
+    std::vector<long long> offset_samples;
+    for (int i = 0; i < sources_count_; i++)
+        {
+            const std::string role = sig_source_.at(i)->role();
+            if (sig_source_.at(i)->implementation().compare("Raw_Array_Signal_Source") == 0)
+                {
+                    LOG(WARNING) << "Receiver.align_sources does not apply to the array mode, sources not aligned";
+                    return;
+                }
+            const int RF_Channels = configuration_->property(role + ".RF_channels", 1);
+            for (int j = 0; j < RF_Channels; j++)
+                {
+                    // the channels of one front-end are sampled together, with the same offset
+                    item_sizes.push_back(sig_conditioner_.at(item_sizes.size())->get_left_block()->input_signature()->sizeof_stream_item(0));
+                    sample_rates_hz.push_back(configuration_->property(role + ".sampling_frequency", 4.0e6));
+                    offset_samples.push_back(configuration_->property(role + ".alignment_offset_samples", 0));
+                }
+        }
+    bool use_rx_time = configuration_->property("Receiver.alignment_use_rx_time", true);
+    double max_latency_s = configuration_->property("Receiver.alignment_max_latency_ms", 1000.0) / 1000.0;
+    double max_skew_s = configuration_->property("Receiver.alignment_max_skew_ms", 1000.0) / 1000.0;
+    source_aligner_ = make_source_aligner(item_sizes, sample_rates_hz, offset_samples, use_rx_time, max_latency_s, max_skew_s);
+    LOG(INFO) << "Aligning " << item_sizes.size() << " source streams"
+              << (use_rx_time ? " with their rx_time tags" : " with the configured offsets");
+}
+
+
+void GNSSFlowgraph::connect_source_stream(gr::basic_block_sptr source, int port, int signal_conditioner_ID)
+{
+    if (source_aligner_)
+        {
+            top_block_->connect(source, port, source_aligner_, signal_conditioner_ID);
+            top_block_->connect(source_aligner_, signal_conditioner_ID, sig_conditioner_.at(signal_conditioner_ID)->get_left_block(), 0);
+        }
+    else
+        {
+            top_block_->connect(source, port, sig_conditioner_.at(signal_conditioner_ID)->get_left_block(), 0);
+        }
+    if (!latency_trace_file_.empty())
+        {
+            // the sample counters of the trace are at the internal sampling frequency
+            double fs_in = configuration_->property("GNSS-SDR.internal_fs_hz", 2048000);
+            latency_probes_.push_back(make_latency_trace_probe(source->output_signature()->sizeof_stream_item(port),
+                    LATENCY_SOURCE, signal_conditioner_ID, fs_in / source_sampling_frequency(signal_conditioner_ID)));
+            top_block_->connect(source, port, latency_probes_.back(), 0);
+        }
+}
+
+
+double GNSSFlowgraph::source_sampling_frequency(int signal_conditioner_ID)
+{
+    int first_conditioner_ID = 0;
+    for (int i = 0; i < sources_count_; i++)
+        {
+            const std::string role = sig_source_.at(i)->role();
+            first_conditioner_ID += configuration_->property(role + ".RF_channels", 1);
+            if (signal_conditioner_ID < first_conditioner_ID)
+                {
+                    return configuration_->property(role + ".sampling_frequency", 4.0e6);
+                }
+        }
+    return configuration_->property("GNSS-SDR.internal_fs_hz", 4.0e6);
+}
+
+
 void GNSSFlowgraph::wait()
 {
     if (!running_)
@@ -387,25 +698,368 @@ bool GNSSFlowgraph::send_telemetry_msg(pmt::pmt_t msg)
 // Assigns which peak a channel should acquire
 void GNSSFlowgraph::AssignACQState(int PRN, unsigned int who)
 {
-    DLOG(INFO) << "assign peak ";
-    DLOG(INFO) << "nr acq peak " << nr_acquired_peaks.at(PRN);
-    if(nr_acquired_peaks.at(PRN) < nr_acq )
+    DLOG(INFO) << "nr acq peak " << signal_scheduler_.acquired_peaks(PRN);
+    //find highest peak that is not being tracked.
+    int peak = signal_scheduler_.assign_peak(PRN, who);
+    std::multiset<unsigned int>::iterator granted = apt_granted_.find(PRN);
+    if (granted != apt_granted_.end())
+        {
+            apt_granted_.erase(granted);
+        }
+    if (peak > 0)
         {
-            //find highest peak that is not being tracked.
-            nr_acquired_peaks.at(PRN) += 1;
-            int peak = next_peak.at(PRN);
-            if(peak > 5)
-                peak = 1;
-            next_peak.at(PRN) = peak+1;
             channels_.at(who)->set_peak(peak);
-            channel_to_peak[who] = peak;
+            if (peak > 1)
+                {
+                    aux_busy_start_s_[who] = channel_busy_s(who);
+                }
         }
     else
         {
             DLOG(INFO) <<  "Satellite "<< PRN << " should not be acquired again";
-            DLOG(INFO) << nr_acquired_peaks.at(PRN); 
+        }
+}
+
+
+// Gives the channel the next signal of its type waiting in the scheduler
+bool GNSSFlowgraph::assign_next_signal(unsigned int who)
+{
+    Gnss_Signal signal;
+    if (!signal_scheduler_.next(who, channels_.at(who)->get_signal().get_signal_str(), signal))
+        {
+            LOG(WARNING) << "No " << channels_.at(who)->get_signal().get_signal_str() << " signal left for channel " << who;
+            return false;
+        }
+    channels_.at(who)->set_signal(signal);
+    return true;
+}
 
+
+// Starts the acquisition on the first channel in standby that has a signal to search
+bool GNSSFlowgraph::start_standby_channel()
+{
+    if (signal_scheduler_.empty() || acq_channels_count_ >= max_acq_channels_)
+        {
+            return false;
+        }
+    for (unsigned int i = 0; i < channels_count_; i++)
+        {
+            if (channels_state_[i] == 0 && shed_channels_.count(i) == 0 && !signal_scheduler_.empty(channels_.at(i)->get_signal().get_signal_str()))
+                {
+                    channels_state_[i] = 1;
+                    assign_next_signal(i);
+                    if (spoofing_detection)
+                        {
+                            AssignACQState(channels_.at(i)->get_signal().get_satellite().get_PRN(), i);
+                        }
+                    acq_channels_count_++;
+                    channels_.at(i)->start_acquisition();
+                    return true;
+                }
+            DLOG(INFO) << "Channel " << i << " in state " << channels_state_[i];
         }
+    return false;
+}
+
+
+void GNSSFlowgraph::prioritize_satellites(const std::string& system, const std::set<unsigned int>& prns)
+{
+    signal_scheduler_.prioritize(system, prns);
+    LOG(INFO) << prns.size() << " " << system << " satellites searched first";
+}
+
+
+void GNSSFlowgraph::update_visibility(const std::string& system, const std::set<unsigned int>& visible,
+        const std::set<unsigned int>& hidden, bool park_hidden)
+{
+    signal_scheduler_.set_visibility(system, visible, hidden, park_hidden);
+    LOG(INFO) << system << " satellites predicted in view: " << visible.size() << ", below the horizon: " << hidden.size()
+              << (park_hidden ? " (not searched)" : " (searched last)");
+    // the channels left in standby by the parked satellites
+    while (start_standby_channel())
+        {}
+}
+
+void GNSSFlowgraph::reconfigure(std::shared_ptr<ConfigurationInterface> configuration)
+{
+    if (!running_)
+        {
+            LOG(WARNING) << "Only a running flowgraph is reconfigured";
+            return;
+        }
+    configuration_ = configuration;
+    for (unsigned int i = 0; i < channels_count_; i++)
+        {
+            channels_.at(i)->reconfigure(configuration_.get());
+        }
+    if (spoofing_detector_)
+        {
+            spoofing_detector_->reconfigure(configuration_.get());
+        }
+    // peaks searched for each satellite, from its next search on
+    nr_acq = configuration_->property("Spoofing.APT_ch_per_sat", 2);
+    signal_scheduler_.set_peaks_per_satellite(peaks_per_satellite());
+    apt_max_aux_channels_ = configuration_->property("Spoofing.APT_max_aux_channels", 0);
+    if (spoofing_detection)
+        {
+            grant_waiting_aux();
+        }
+
+    // the channels above the new limit finish their acquisition, the ones below it start now
+    max_acq_channels_ = std::min(configuration_->property("Channels.in_acquisition", channels_count_), channels_count_);
+    while (start_standby_channel())
+        {}
+    LOG(INFO) << "Flowgraph reconfigured: " << max_acq_channels_ << " channels in acquisition, "
+              << nr_acq << " peaks per satellite";
+}
+
+
+unsigned long long GNSSFlowgraph::samples_read()
+{
+    bool found = false;
+    unsigned long long samples = 0;
+    for (unsigned int i = 0; i < channels_count_; i++)
+        {
+            gr::block_sptr block = boost::dynamic_pointer_cast<gr::block>(channels_.at(i)->get_left_block());
+            if (!block || !block->detail())
+                {
+                    continue; // not started
+                }
+            unsigned long long read = block->nitems_read(0);
+            if (!found || read < samples)
+                {
+                    samples = read;
+                    found = true;
+                }
+        }
+    return samples;
+}
+
+
+int GNSSFlowgraph::peaks_per_satellite() const
+{
+    return shedding_level_ >= Realtime_Margin_Monitor::APT_PAUSED ? 1 : nr_acq;
+}
+
+
+void GNSSFlowgraph::set_shedding_level(int level)
+{
+    if (!running_ || level == shedding_level_)
+        {
+            return;
+        }
+    const int previous_level = shedding_level_;
+    shedding_level_ = level;
+
+    // 1. the auxiliary peaks of APT
+    if (spoofing_detection)
+        {
+            signal_scheduler_.set_peaks_per_satellite(peaks_per_satellite());
+            if (level >= Realtime_Margin_Monitor::APT_PAUSED && previous_level < Realtime_Margin_Monitor::APT_PAUSED)
+                {
+                    for (unsigned int i = 0; i < channels_count_; i++)
+                        {
+                            if (channels_state_[i] == 2 && signal_scheduler_.channel_peak(i) > 1)
+                                {
+                                    shed_channel(i, Realtime_Margin_Monitor::APT_PAUSED);
+                                }
+                        }
+                }
+        }
+
+    // 2. the PPE checks
+    if (spoofing_detector_)
+        {
+            spoofing_detector_->set_PPE_decimation(level >= Realtime_Margin_Monitor::PPE_DECIMATED ?
+                    configuration_->property("Receiver.overload_ppe_decimation", 10) : 1);
+        }
+
+    // 3. the channels of lowest C/N0
+    if (level >= Realtime_Margin_Monitor::CHANNELS_DROPPED && previous_level < Realtime_Margin_Monitor::CHANNELS_DROPPED)
+        {
+            std::vector<std::pair<double, unsigned int>> tracking;
+            for (unsigned int i = 0; i < channels_count_; i++)
+                {
+                    if (channels_state_[i] == 2 && shed_channels_.count(i) == 0)
+                        {
+                            tracking.push_back(std::make_pair(channels_.at(i)->cn0_db_hz(), i));
+                        }
+                }
+            std::sort(tracking.begin(), tracking.end());
+            unsigned int drop = configuration_->property("Receiver.overload_drop_channels", std::max(channels_count_ / 4, 1u));
+            for (unsigned int i = 0; i < std::min(drop, static_cast<unsigned int>(tracking.size())); i++)
+                {
+                    shed_channel(tracking.at(i).second, Realtime_Margin_Monitor::CHANNELS_DROPPED);
+                }
+        }
+
+    // the channels stopped by a level left search again
+    std::map<unsigned int, int>::iterator it = shed_channels_.begin();
+    while (it != shed_channels_.end())
+        {
+            if (it->second > level)
+                {
+                    LOG(INFO) << "Channel " << it->first << " leaves the standby, the load is shed up to level " << level;
+                    shed_channels_.erase(it++);
+                }
+            else
+                {
+                    ++it;
+                }
+        }
+    while (start_standby_channel())
+        {}
+}
+
+
+void GNSSFlowgraph::shed_channel(unsigned int who, int level)
+{
+    int PRN = channels_.at(who)->get_signal().get_satellite().get_PRN();
+    LOG(WARNING) << "Channel " << who << " stops tracking satellite " << PRN << " (CN0 " << channels_.at(who)->cn0_db_hz()
+                 << " dB-Hz) to shed load";
+    channels_.at(who)->stop_tracking();
+    // as for a loss of lock, without searching another signal
+    channels_.at(who)->set_state(2);
+    if (spoofing_detection)
+        {
+            unsigned int uid = channels_.at(who)->get_uid();
+            state_->subframe_map.remove(uid);
+            state_->gps_time.remove(uid);
+            state_->subframe_check.remove(uid);
+            end_aux_busy(who);
+            signal_scheduler_.release_peak(PRN);
+            channels_.at(who)->set_peak(0);
+        }
+    signal_scheduler_.push_back(channels_.at(who)->get_signal());
+    channels_state_[who] = 0;
+    shed_channels_[who] = level;
+}
+
+
+double GNSSFlowgraph::channel_busy_s(unsigned int who) const
+{
+    const std::string instance = "ch" + std::to_string(who);
+    unsigned long long busy_ns = 0;
+    std::vector<std::shared_ptr<Block_Metrics> > metrics = block_metrics_registered();
+    for (unsigned int i = 0; i < metrics.size(); i++)
+        {
+            if (metrics.at(i)->instance() == instance && (metrics.at(i)->block() == "tracking" || metrics.at(i)->block() == "telemetry"))
+                {
+                    busy_ns += metrics.at(i)->snapshot().busy_ns;
+                }
+        }
+    return busy_ns * 1e-9;
+}
+
+
+double GNSSFlowgraph::apt_aux_busy_s() const
+{
+    double busy_s = apt_aux_busy_s_;
+    for (std::map<unsigned int, double>::const_iterator it = aux_busy_start_s_.begin(); it != aux_busy_start_s_.end(); ++it)
+        {
+            busy_s += channel_busy_s(it->first) - it->second;
+        }
+    return busy_s;
+}
+
+
+void GNSSFlowgraph::end_aux_busy(unsigned int who)
+{
+    std::map<unsigned int, double>::iterator it = aux_busy_start_s_.find(who);
+    if (it != aux_busy_start_s_.end())
+        {
+            apt_aux_busy_s_ += channel_busy_s(who) - it->second;
+            aux_busy_start_s_.erase(it);
+        }
+}
+
+
+unsigned int GNSSFlowgraph::aux_channels_used() const
+{
+    unsigned int used = apt_granted_.size();
+    for (unsigned int i = 0; i < channels_count_; i++)
+        {
+            if (channels_state_[i] != 0 && signal_scheduler_.channel_peak(i) > 1)
+                {
+                    used++;
+                }
+        }
+    return used;
+}
+
+
+void GNSSFlowgraph::request_aux_peak(const Gnss_Signal& signal, bool first)
+{
+    const unsigned int PRN = signal.get_satellite().get_PRN();
+    bool spoofed = false;
+    if (state_->spoofing_status.read(PRN, spoofed) && spoofed)
+        {
+            apt_alarmed_.insert(PRN);
+        }
+    if (apt_max_aux_channels_ == 0 || (apt_waiting_.empty() && aux_channels_used() < apt_max_aux_channels_))
+        {
+            apt_granted_.insert(PRN);
+            if (first)
+                {
+                    signal_scheduler_.push_front(signal);
+                }
+            else
+                {
+                    signal_scheduler_.push_back(signal);
+                }
+            return;
+        }
+    if (std::find(apt_waiting_.begin(), apt_waiting_.end(), signal) != apt_waiting_.end())
+        {
+            return;
+        }
+    DLOG(INFO) << "Auxiliary peak of satellite " << PRN << " waits for a channel, " << apt_waiting_.size() << " before it";
+    if (apt_alarmed_.count(PRN))
+        {
+            apt_waiting_.push_front(signal);
+        }
+    else
+        {
+            apt_waiting_.push_back(signal);
+        }
+}
+
+
+void GNSSFlowgraph::grant_waiting_aux()
+{
+    while (!apt_waiting_.empty() && peaks_per_satellite() > 1
+            && (apt_max_aux_channels_ == 0 || aux_channels_used() < apt_max_aux_channels_))
+        {
+            Gnss_Signal signal = apt_waiting_.front();
+            apt_waiting_.pop_front();
+            const unsigned int PRN = signal.get_satellite().get_PRN();
+            // only while the satellite is still tracked on fewer peaks than searched
+            const int peaks = signal_scheduler_.acquired_peaks(PRN);
+            if (peaks > 0 && peaks + static_cast<int>(signal_scheduler_.count(signal)) < peaks_per_satellite())
+                {
+                    apt_granted_.insert(PRN);
+                    signal_scheduler_.push_back(signal);
+                }
+        }
+    while (start_standby_channel())
+        {}
+}
+
+
+void GNSSFlowgraph::release_aux_channel(unsigned int who)
+{
+    const unsigned int uid = channels_.at(who)->get_uid();
+    state_->subframe_map.remove(uid);
+    state_->gps_time.remove(uid);
+    state_->subframe_check.remove(uid);
+    std::map<unsigned int, double>::const_iterator it = aux_busy_start_s_.find(who);
+    if (it != aux_busy_start_s_.end())
+        {
+            LOG(INFO) << "Channel " << who << " spent " << channel_busy_s(who) - it->second << " s on its auxiliary peak";
+        }
+    end_aux_busy(who);
+    signal_scheduler_.release_peak(channels_.at(who)->get_signal().get_satellite().get_PRN());
+    channels_.at(who)->set_peak(0);
 }
 
 /*
@@ -417,6 +1071,11 @@ void GNSSFlowgraph::AssignACQState(int PRN, unsigned int who)
 void GNSSFlowgraph::apply_action(unsigned int who, unsigned int what)
 {
     DLOG(INFO) << "received " << what << " from " << who;
+    if (shed_channels_.count(who))
+        {
+            DLOG(INFO) << "Channel " << who << " is in standby to shed load, event " << what << " ignored";
+            return;
+        }
 
     int PRN, lost_PRN, acq_PRN, nr_acq_peaks, peak;
     int inactive;
@@ -426,8 +1085,7 @@ void GNSSFlowgraph::apply_action(unsigned int who, unsigned int what)
     
     if(spoofing_detection)
     {
-        peak = channel_to_peak.find(who)->second;
-        std::deque<int> acq_peaks; 
+        peak = signal_scheduler_.channel_peak(who);
     }
 
     switch (what)
@@ -439,33 +1097,34 @@ void GNSSFlowgraph::apply_action(unsigned int who, unsigned int what)
       
         if(spoofing_detection)
             {
-                next_peak.at(PRN) = 1; 
-                nr_acquired_peaks.at(lost_PRN) -= 1;
+                signal_scheduler_.set_next_peak(PRN, 1);
+                end_aux_busy(who);
+                signal_scheduler_.release_peak(lost_PRN);
                 channels_.at(who)->set_peak(0);
 
                 //remove cannel from spoofing detection queues
                 uid = channels_.at(who)->get_uid();
-                global_subframe_map.remove(uid);
-                global_subframe_check.remove(uid);
-                global_gps_time.remove(uid);
+                state_->subframe_map.remove(uid);
+                state_->subframe_check.remove(uid);
+                state_->gps_time.remove(uid);
             }
 
-        available_GNSS_signals_.push_back(channels_.at(who)->get_signal());
-        //TODO: Optimize the channel and signal matching!
-        while ( channels_.at(who)->get_signal().get_signal_str().compare(available_GNSS_signals_.front().get_signal_str()) != 0 )
+        signal_scheduler_.push_back(channels_.at(who)->get_signal());
+        if (!assign_next_signal(who))
             {
-                available_GNSS_signals_.push_back(available_GNSS_signals_.front());
-                available_GNSS_signals_.pop_front();
+                // only parked satellites are left: wait in standby for one to rise
+                channels_state_[who] = 0;
+                acq_channels_count_--;
+                break;
             }
 
-        PRN = available_GNSS_signals_.front().get_satellite().get_PRN();
+        PRN = channels_.at(who)->get_signal().get_satellite().get_PRN();
         if(spoofing_detection)
             {
                 AssignACQState(PRN, who);
+                grant_waiting_aux();
             }
 
-        channels_.at(who)->set_signal(available_GNSS_signals_.front());
-        available_GNSS_signals_.pop_front();
         usleep(100);
         channels_.at(who)->start_acquisition();
         break;
@@ -477,62 +1136,30 @@ void GNSSFlowgraph::apply_action(unsigned int who, unsigned int what)
         channels_state_[who] = 2;
         acq_channels_count_--;
 
-        DLOG(INFO) << "peak " << channel_to_peak.at(who);
+        DLOG(INFO) << "peak " << signal_scheduler_.channel_peak(who);
 
         if(spoofing_detection){
-            next_peak.at(PRN) = peak+1; 
-            nr_acq_peaks = nr_acquired_peaks.at(acq_PRN);
+            signal_scheduler_.set_next_peak(PRN, peak+1);
+            nr_acq_peaks = signal_scheduler_.acquired_peaks(acq_PRN);
             acquire_sat_again = false;
-            inactive = std::count(available_GNSS_signals_.begin(), available_GNSS_signals_.end(), channels_.at(who)->get_signal());  //number of availble instances of the sat
-            if(nr_acq_peaks+inactive < nr_acq )
+            inactive = signal_scheduler_.count(channels_.at(who)->get_signal());  //number of availble instances of the sat
+            if(nr_acq_peaks+inactive < peaks_per_satellite())
             {
                 DLOG(INFO) << "pushing back sat " << acq_PRN << " ch " << who << " nr acq peaks " << nr_acq_peaks;  
-                available_GNSS_signals_.push_back(channels_.at(who)->get_signal());
+                // first in line: the next free channel acquires the next peak from the
+                // peak list of this search, instead of searching again later
+                request_aux_peak(channels_.at(who)->get_signal(), true);
                 acquire_sat_again = true;
             }   
         }
 
 
 
-        if (!available_GNSS_signals_.empty() && acq_channels_count_ < max_acq_channels_)
-        {
-            for (unsigned int i = 0; i < channels_count_; i++)
+        if(spoofing_detection)
             {
-                if (channels_state_[i] == 0)
-                {
-                    channels_state_[i] = 1;
-                    while (channels_.at(i)->get_signal().get_signal_str().compare(available_GNSS_signals_.front().get_signal_str()) != 0 )
-                    {
-                        available_GNSS_signals_.push_back(available_GNSS_signals_.front());
-                        available_GNSS_signals_.pop_front();
-                    }
-                    channels_.at(i)->set_signal(available_GNSS_signals_.front());
-                    available_GNSS_signals_.pop_front();
-                    acq_channels_count_++;
-
-                    if(spoofing_detection){
-                        //unnecessary just so acq of lower peaks happens faster
-                        DLOG(INFO) << "assign same satellite again? " << acquire_sat_again << " " << i;
-                        /*
-                           if(acquire_sat_again)
-                           {
-                           acquire_sat_again = false;
-                           DLOG(INFO) << "assign same satellite again?";
-                           PRN = channels_.at(i)->get_signal().get_satellite().get_PRN(); 
-                           nr_acquired_peaks.at(PRN) -= 1;
-                           acquired_peaks.at(PRN).push_front(channel_to_peak.at(i));
-                           channels_.at(i)->set_signal(channels_.at(who)->get_signal());
-                           DLOG(INFO) << "PRN " << PRN << " channel: " << channels_.at(i);
-                           AssignACQState(PRN, i);
-                           }
-                         */
-                    }
-                    channels_.at(i)->start_acquisition();
-                    break;
-                }
-                DLOG(INFO) << "Channel " << i << " in state " << channels_state_[i];
+                DLOG(INFO) << "assign same satellite again? " << acquire_sat_again;
             }
-        }
+        start_standby_channel();
 
         for (unsigned int i = 0; i < channels_count_; i++)
         {
@@ -550,57 +1177,75 @@ void GNSSFlowgraph::apply_action(unsigned int who, unsigned int what)
         if(spoofing_detection)
         {
             uid = channels_.at(who)->get_uid();
-            global_subframe_map.remove(uid);
-            global_gps_time.remove(uid);
-            global_subframe_check.remove(uid);
+            state_->subframe_map.remove(uid);
+            state_->gps_time.remove(uid);
+            state_->subframe_check.remove(uid);
 
-            nr_acquired_peaks.at(PRN) -= 1;
+            end_aux_busy(who);
+            signal_scheduler_.release_peak(PRN);
             channels_.at(who)->set_peak(0);
-
-            //remove cannel from spoofing detection queues
-            uid = channels_.at(who)->get_uid();
-            global_subframe_map.remove(uid);
-            global_gps_time.remove(uid);
         }
 
-        DLOG(INFO) << "pushing back " << PRN << " acq_nr " << nr_acquired_peaks.at(PRN);
-        available_GNSS_signals_.push_back(channels_.at(who)->get_signal());
-
-        while (channels_.at(who)->get_signal().get_satellite().get_system() != available_GNSS_signals_.front().get_satellite().get_system())
+        DLOG(INFO) << "pushing back " << PRN << " acq_nr " << signal_scheduler_.acquired_peaks(PRN);
+        if (spoofing_detection && peak > 1 && signal_scheduler_.acquired_peaks(PRN) > 0)
+        {
+            // an auxiliary peak of a satellite still tracked, searched within the budget
+            request_aux_peak(channels_.at(who)->get_signal(), false);
+        }
+        else
+        {
+            signal_scheduler_.push_back(channels_.at(who)->get_signal());
+        }
+        if (!assign_next_signal(who))
         {
-            available_GNSS_signals_.push_back(available_GNSS_signals_.front());
-            available_GNSS_signals_.pop_front();
+            // only parked satellites are left: wait in standby for one to rise
+            channels_state_[who] = 0;
+            break;
         }
 
-        PRN = available_GNSS_signals_.front().get_satellite().get_PRN();
+        PRN = channels_.at(who)->get_signal().get_satellite().get_PRN();
         if(spoofing_detection)
         {
             AssignACQState(PRN, who);
+            grant_waiting_aux();
         }
 
-        channels_.at(who)->set_signal(available_GNSS_signals_.front());
-        available_GNSS_signals_.pop_front();
         usleep(100);
         channels_.at(who)->start_acquisition();
 
         break;
     case 4:
-        LOG(INFO) << "No spoofing detected, restart acqusition on auxiliary channel: " << who << "  sat " << channels_.at(who)->get_signal().get_satellite().get_PRN(); 
-        //only do it for channels that have received ephemeris
-        if(channels_state_[who] != 2)
-            break;       
-        /*    std::cout << "No spoofing detected, restart acqusition on auxiliary channel: " << who << "  sat " << channels_.at(who)->get_signal().get_satellite().get_PRN()
-              << " acquired peak " << peak << std::endl; 
-         */
-        PRN = channels_.at(who)->get_signal().get_satellite().get_PRN(); 
-        AssignACQState(PRN, who);
-        channels_.at(who)->stop_tracking();        
-
+        // the subframe times of the peak agree with the other peaks of the satellite:
+        // the channel is released, and the satellite is checked again once the others had their turn
+        LOG(INFO) << "Channel " << who << " CHECKED satellite " << channels_.at(who)->get_signal().get_satellite() << ", peak " << signal_scheduler_.channel_peak(who);
+        channels_.at(who)->set_state(2);
+        if(spoofing_detection)
+        {
+            release_aux_channel(who);
+            request_aux_peak(channels_.at(who)->get_signal(), false);
+        }
+        else
+        {
+            signal_scheduler_.push_back(channels_.at(who)->get_signal());
+        }
+        if (!assign_next_signal(who))
+        {
+            channels_state_[who] = 0;
+            break;
+        }
+        PRN = channels_.at(who)->get_signal().get_satellite().get_PRN();
+        if(spoofing_detection)
+        {
+            AssignACQState(PRN, who);
+            grant_waiting_aux();
+        }
+        usleep(100);
+        channels_.at(who)->start_acquisition();
         break;
     default:
         break;
     }
-    DLOG(INFO) << "Number of available signals: " << available_GNSS_signals_.size();
+    DLOG(INFO) << "Number of available signals: " << signal_scheduler_.size();
 }
 
 
@@ -627,7 +1272,34 @@ void GNSSFlowgraph::init()
     /*
      * Instantiates the receiver blocks
      */
+    Receiver_State_Scope state_scope(state_);
     std::unique_ptr<GNSSBlockFactory> block_factory_(new GNSSBlockFactory());
+    spoofing_detector_ = std::make_shared<Spoofing_Detector>(configuration_.get());
+    block_factory_->set_spoofing_detector(spoofing_detector_);
+
+    // Threads shared by the acquisition blocks for their Doppler searches, set before any block runs.
+    // The default leaves most of the cores to the tracking channels.
+    Acquisition_Thread_Pool::set_num_threads(configuration_->property("GNSS-SDR.acquisition_threads",
+            Acquisition_Thread_Pool::default_num_threads()));
+
+    // Threads shared by the telemetry decoders to decode the subframes, set before any block runs
+    Telemetry_Decode_Pool::set_num_threads(configuration_->property("GNSS-SDR.telemetry_threads",
+            Telemetry_Decode_Pool::default_num_threads()));
+
+    // FFTW wisdom of a previous run, so that the acquisition blocks plan their FFTs faster
+    Fft_Plan_Cache::set_wisdom_file(configuration_->property("GNSS-SDR.fftw_wisdom_file", std::string("")));
+
+    // pages and NUMA node of the acquisition grids, tracking replicas and sample histories, set before any is allocated
+    Buffer_Allocator::set_default_hints(Buffer_Allocator::Hints(
+            Buffer_Allocator::page_mode(configuration_->property("GNSS-SDR.huge_pages", std::string("off"))),
+            configuration_->property("GNSS-SDR.numa_node", -1)));
+
+    // a build with ENABLE_STATIC_LIMITS=ON runs only the configurations within its limits, from an arena reserved now
+    if (!Static_Limits::check(configuration_.get()) || !Buffer_Allocator::reserve())
+        {
+            std::cout << "The configuration does not fit the limits of this build (see the log). GNSS-SDR program ended." << std::endl;
+            exit(1);
+        }
 
     // 1. read the number of RF front-ends available (one file_source per RF front-end)
     sources_count_ = configuration_->property("Receiver.sources_count", 1);
@@ -676,6 +1348,30 @@ void GNSSFlowgraph::init()
         }
     }
 
+    // Tracepoints from the sources to the PVT and the spoofing alarms, before any block runs
+    latency_trace_file_ = configuration_->property("Receiver.latency_trace_file", std::string(""));
+    latency_probes_.clear();
+    if (!latency_trace_file_.empty())
+        {
+            Latency_Trace::start(configuration_->property("Receiver.latency_trace_events", 1 << 18));
+        }
+
+    // The last samples of every signal conditioner, which the acquisition blocks read instead
+    // of copying the stream into vectors. They are created before the channels look them up.
+    Sample_History::clear();
+    history_sinks_.clear();
+    double sample_history_ms = configuration_->property("GNSS-SDR.sample_history_ms", 0.0);
+    if (sample_history_ms > 0.0)
+        {
+            long fs_in = configuration_->property("GNSS-SDR.internal_fs_hz", 2048000);
+            unsigned int capacity = static_cast<unsigned int>(std::ceil(sample_history_ms * fs_in / 1000.0));
+            for (unsigned int i = 0; i < sig_conditioner_.size(); i++)
+                {
+                    history_sinks_.push_back(make_sample_history_sink(Sample_History::create(i, capacity)));
+                }
+            LOG(INFO) << "Sample history of " << capacity << " samples per signal conditioner";
+        }
+
     observables_ = block_factory_->GetObservables(configuration_);
     pvt_ = block_factory_->GetPVT(configuration_);
 
@@ -697,12 +1393,18 @@ void GNSSFlowgraph::init()
 
     spoofing_detection = configuration_->property("Spoofing.APT", false);
     nr_acq = configuration_->property("Spoofing.APT_ch_per_sat", 2);
+    apt_max_aux_channels_ = configuration_->property("Spoofing.APT_max_aux_channels", 0);
+    apt_aux_busy_s_ = 0.0;
+    shedding_level_ = Realtime_Margin_Monitor::NO_SHEDDING;
 
-    // fill the available_GNSS_signals_ queue with the satellites ID's to be searched by the acquisition
+    // fill the signal scheduler queues with the satellites ID's to be searched by the acquisition
     set_signals_list();
     set_channels_state();
     applied_actions_ = 0;
 
+    // saved now that all the channels have planned their FFTs, in case the receiver does not exit cleanly
+    Fft_Plan_Cache::save_wisdom();
+
     DLOG(INFO) << "Blocks instantiated. " << channels_count_ << " channels.";
 }
 
@@ -712,6 +1414,8 @@ void GNSSFlowgraph::set_signals_list()
     /*
      * Sets a sequential list of GNSS satellites
      */
+    signal_scheduler_.clear();
+    signal_scheduler_.set_peaks_per_satellite(nr_acq);
     std::set<unsigned int>::iterator available_gnss_prn_iter;
 
     /*
@@ -805,11 +1509,8 @@ void GNSSFlowgraph::set_signals_list()
                     available_gnss_prn_iter != available_gps_prn.end();
                     available_gnss_prn_iter++)
                 {
-                    available_GNSS_signals_.push_back(Gnss_Signal(Gnss_Satellite(std::string("GPS"),
+                    signal_scheduler_.push_back(Gnss_Signal(Gnss_Satellite(std::string("GPS"),
                                     *available_gnss_prn_iter), std::string("1C")));
-
-                    next_peak[*available_gnss_prn_iter] = 1;
-                    nr_acquired_peaks[*available_gnss_prn_iter] = 0;
                 }
 
             if(spoofing_detection)
@@ -821,7 +1522,7 @@ void GNSSFlowgraph::set_signals_list()
                                 available_gnss_prn_iter != available_gps_prn.end();
                                 available_gnss_prn_iter++)
                             {
-                                available_GNSS_signals_.push_back(Gnss_Signal(Gnss_Satellite(std::string("GPS"),
+                                signal_scheduler_.push_back(Gnss_Signal(Gnss_Satellite(std::string("GPS"),
                                         *available_gnss_prn_iter), std::string("1C")));
                             }
                     }
@@ -837,7 +1538,7 @@ void GNSSFlowgraph::set_signals_list()
                     available_gnss_prn_iter != available_gps_prn.end();
                     available_gnss_prn_iter++)
                 {
-                    available_GNSS_signals_.push_back(Gnss_Signal(Gnss_Satellite(std::string("GPS"),
+                    signal_scheduler_.push_back(Gnss_Signal(Gnss_Satellite(std::string("GPS"),
                             *available_gnss_prn_iter), std::string("2S")));
                 }
         }
@@ -851,7 +1552,7 @@ void GNSSFlowgraph::set_signals_list()
                     available_gnss_prn_iter != available_sbas_prn.end();
                     available_gnss_prn_iter++)
                 {
-                    available_GNSS_signals_.push_back(Gnss_Signal(Gnss_Satellite(std::string("SBAS"),
+                    signal_scheduler_.push_back(Gnss_Signal(Gnss_Satellite(std::string("SBAS"),
                             *available_gnss_prn_iter), std::string("1C")));
 
                 }
@@ -867,7 +1568,7 @@ void GNSSFlowgraph::set_signals_list()
                     available_gnss_prn_iter != available_galileo_prn.end();
                     available_gnss_prn_iter++)
                 {
-                    available_GNSS_signals_.push_back(Gnss_Signal(Gnss_Satellite(std::string("Galileo"),
+                    signal_scheduler_.push_back(Gnss_Signal(Gnss_Satellite(std::string("Galileo"),
                             *available_gnss_prn_iter), std::string("1B")));
                 }
         }
@@ -881,15 +1582,13 @@ void GNSSFlowgraph::set_signals_list()
                     available_gnss_prn_iter != available_galileo_prn.end();
                     available_gnss_prn_iter++)
                 {
-                    available_GNSS_signals_.push_back(Gnss_Signal(Gnss_Satellite(std::string("Galileo"),
+                    signal_scheduler_.push_back(Gnss_Signal(Gnss_Satellite(std::string("Galileo"),
                             *available_gnss_prn_iter), std::string("5X")));
                 }
         }
     /*
      * Ordering the list of signals from configuration file
      */
-    std::list<Gnss_Signal>::iterator gnss_it = available_GNSS_signals_.begin();
-
     // Pre-assignation if not defined at ChannelX.signal=1C ...? In what order?
 
     for (unsigned int i = 0; i < total_channels; i++)
@@ -900,26 +1599,14 @@ void GNSSFlowgraph::set_signals_list()
             if((gnss_signal.compare("1B") == 0) or (gnss_signal.compare("5X") == 0) ) gnss_system = "Galileo";
             unsigned int sat = configuration_->property("Channel" + boost::lexical_cast<std::string>(i) + ".satellite", 0);
             LOG(INFO) << "Channel " << i <<  " system " << gnss_system << ", signal " << gnss_signal <<", sat "<<sat;
-            if (sat == 0) // 0 = not PRN in configuration file
+            if (sat != 0) // 0 = not PRN in configuration file
                 {
-                    gnss_it++;
-                }
-            else
-                {
-                    Gnss_Signal signal_value = Gnss_Signal(Gnss_Satellite(gnss_system, sat), gnss_signal);
-                    available_GNSS_signals_.remove(signal_value);
-                    available_GNSS_signals_.insert(gnss_it, signal_value);
-                    AssignACQState(gnss_it->get_satellite().get_PRN(), i);
+                    // the peak is assigned by connect(), when the channel takes the signal
+                    signal_scheduler_.reserve(i, Gnss_Signal(Gnss_Satellite(gnss_system, sat), gnss_signal));
                 }
         }
 
-    //    **** FOR DEBUGGING THE LIST OF GNSS SIGNALS ****
-    //    std::list<Gnss_Signal>::iterator available_gnss_list_iter;
-    //    for (available_gnss_list_iter = available_GNSS_signals_.begin(); available_gnss_list_iter
-    //    != available_GNSS_signals_.end(); available_gnss_list_iter++)
-    //        {
-    //            std::cout << *available_gnss_list_iter << std::endl;
-    //        }
+    DLOG(INFO) << signal_scheduler_.size() << " signals to be searched";
 }
 
 
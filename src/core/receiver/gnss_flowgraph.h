@@ -39,21 +39,28 @@
 #ifndef GNSS_SDR_GNSS_FLOWGRAPH_H_
 #define GNSS_SDR_GNSS_FLOWGRAPH_H_
 
+#include <deque>
 #include <list>
+#include <map>
 #include <memory>
 #include <queue>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 #include <gnuradio/top_block.h>
 #include <gnuradio/msg_queue.h>
 #include "GPS_L1_CA.h"
 #include "gnss_signal.h"
+#include "gnss_signal_scheduler.h"
 #include "pvt_interface.h"
 
 class GNSSBlockInterface;
 class ChannelInterface;
 class ConfigurationInterface;
 class GNSSBlockFactory;
+class Spoofing_Detector;
+class Receiver_State;
 //class PvtInterface;
 
 /*! \brief This class represents a GNSS flowgraph.
@@ -113,6 +120,15 @@ public:
         return running_;
     }
 
+    /*!
+     * \brief Tables shared by the blocks of this receiver, bound while its
+     * blocks are built and connected (see Receiver_State)
+     */
+    std::shared_ptr<Receiver_State> state() const
+    {
+        return state_;
+    }
+
     /*!
      * \brief Sends a GNURadio asyncronous message from telemetry to PVT
      *
@@ -120,6 +136,57 @@ public:
      */
     bool send_telemetry_msg(pmt::pmt_t msg);
 
+    /*!
+     * \brief The signals of these satellites are searched before the others,
+     * e.g. those given by the acquisition assistance
+     */
+    void prioritize_satellites(const std::string& system, const std::set<unsigned int>& prns);
+
+    /*!
+     * \brief Satellites predicted in view are searched first, and those
+     * below the horizon last, or not at all if park_hidden is set
+     */
+    void update_visibility(const std::string& system, const std::set<unsigned int>& visible,
+            const std::set<unsigned int>& hidden, bool park_hidden);
+
+    /*!
+     * \brief Applies the parameters that can change without a restart: the
+     * loop bandwidths of the tracking, the thresholds of the spoofing
+     * detector, the APT peaks per satellite and auxiliary channels, and
+     * Channels.in_acquisition.
+     * The number of channels is fixed by the observables and the PVT.
+     */
+    void reconfigure(std::shared_ptr<ConfigurationInterface> configuration);
+
+    /*!
+     * \brief Samples read by the slowest channel since the start, at
+     * GNSS-SDR.internal_fs_hz
+     */
+    unsigned long long samples_read();
+
+    /*!
+     * \brief Sheds the work of the receiver up to level, or gives it back,
+     * see Realtime_Margin_Monitor::Level: the channels tracking an APT
+     * auxiliary peak stop and no more are searched, the PPE checks run on
+     * one in Receiver.overload_ppe_decimation epochs, and the
+     * Receiver.overload_drop_channels tracking channels of lowest C/N0 stop.
+     * The stopped channels wait in standby until the level falls again.
+     */
+    void set_shedding_level(int level);
+    int shedding_level() const { return shedding_level_; }
+
+    /*!
+     * \brief Time spent by the tracking and the telemetry decoder of the
+     * channel [s], counted only while the block metrics are enabled
+     */
+    double channel_busy_s(unsigned int who) const;
+
+    /*!
+     * \brief Part of the time of all the channels [s] spent on the APT
+     * auxiliary peaks, counted only while the block metrics are enabled
+     */
+    double apt_aux_busy_s() const;
+
     void AssignACQState(int PRN, unsigned int who);
     bool spoofing_detection;
     bool use_first_arriving_signal; 
@@ -128,8 +195,26 @@ public:
 private:
     void init(); // Populates the SV PRN list available for acquisition and tracking
     void set_signals_list();
+    bool assign_next_signal(unsigned int who); // false if no signal of the channel's type is waiting
+    bool start_standby_channel(); // false if no channel in standby can start an acquisition
     void set_channels_state(); // Initializes the channels state (start acquisition or keep standby)
                                // using the configuration parameters (number of channels and max channels in acquisition)
+    void create_source_aligner(); // One stream per signal conditioner, see Receiver.align_sources
+    void connect_source_stream(gr::basic_block_sptr source, int port, int signal_conditioner_ID);
+    double source_sampling_frequency(int signal_conditioner_ID);
+    void set_buffer_policy(); // Receiver.buffer_latency_ms and SignalSourceN.processor_affinity
+    void size_buffer(const std::string& name, gr::basic_block_sptr block, double items_per_ms,
+            const std::vector<int>& processor_affinity);
+    void set_thread_policy(); // Receiver.tracking_cpus, acquisition_cpus, pvt_cpus and the thread priorities
+    void report_buffers(); // size and average occupancy of the buffers, to the log
+    void shed_channel(unsigned int who, int level); // stops its tracking and leaves it in standby
+    int peaks_per_satellite() const; // nr_acq, or 1 while APT is paused
+    // APT auxiliary channels, at most Spoofing.APT_max_aux_channels of them (0 for no limit)
+    void request_aux_peak(const Gnss_Signal& signal, bool first); // searched now if the budget allows, else queued
+    void grant_waiting_aux(); // the queued requests that fit in the budget
+    void release_aux_channel(unsigned int who); // its peak passed the checks of the spoofing detector
+    void end_aux_busy(unsigned int who); // adds the time spent on its auxiliary peak to apt_aux_busy_s_
+    unsigned int aux_channels_used() const;
     bool connected_;
     bool running_;
     int sources_count_;
@@ -143,21 +228,33 @@ private:
 
     std::vector<std::shared_ptr<GNSSBlockInterface>> sig_source_;
     std::vector<std::shared_ptr<GNSSBlockInterface>> sig_conditioner_;
+    gr::basic_block_sptr source_aligner_; // between the sources and the conditioners, if enabled
+    std::vector<gr::basic_block_sptr> history_sinks_; // keep the Sample_History of each conditioner, if enabled
+    std::vector<gr::basic_block_sptr> latency_probes_; // of the sources and the conditioners, if Receiver.latency_trace_file is set
+    std::string latency_trace_file_;
+    std::vector<std::pair<std::string, gr::block_sptr>> sized_blocks_;
 
     std::shared_ptr<GNSSBlockInterface> observables_;
     //std::shared_ptr<GNSSBlockInterface> pvt_;
     std::shared_ptr<PvtInterface> pvt_;
+    std::shared_ptr<Spoofing_Detector> spoofing_detector_; // shared by the PVT and all the telemetry decoders
+    std::shared_ptr<Receiver_State> state_;
 
     std::vector<std::shared_ptr<ChannelInterface>> channels_;
     gr::top_block_sptr top_block_;
     boost::shared_ptr<gr::msg_queue> queue_;
-    std::list<Gnss_Signal> available_GNSS_signals_;
+    Gnss_Signal_Scheduler signal_scheduler_;            // signals to be searched, and the peaks of SPREE
     std::vector<unsigned int> channels_state_;
-    std::map<int, int> nr_acquired_peaks;                   // keeps track of how many channels are acquiring each satellite
-    std::map<int, int> next_peak;
-    std::map<int, int> channel_to_peak;                     // keeps track of which channel track which peak 
     std::map<int, int> acquired_state;                  //keeps track of which channel is acq based on the 2nd highest 
     std::map<int, unsigned int> PVT_to_channel;                 //which the channels signal is used in the PVT calculation 
+    int shedding_level_;
+    std::map<unsigned int, int> shed_channels_;         // channels in standby to shed load, and the level that stopped them
+    unsigned int apt_max_aux_channels_;
+    std::deque<Gnss_Signal> apt_waiting_;               // auxiliary peaks waiting for the budget, alarmed satellites first
+    std::multiset<unsigned int> apt_granted_;           // PRNs of the auxiliary peaks queued for a channel
+    std::set<unsigned int> apt_alarmed_;                // PRNs that raised a spoofing alarm
+    std::map<unsigned int, double> aux_busy_start_s_;   // busy time of the channel when it took its auxiliary peak
+    double apt_aux_busy_s_;
 };
 
 #endif /*GNSS_SDR_GNSS_FLOWGRAPH_H_*/
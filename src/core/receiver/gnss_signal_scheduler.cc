@@ -0,0 +1,338 @@
+/*!
+ * \file gnss_signal_scheduler.cc
+ * \brief Queues of the GNSS signals waiting for a channel, and the peak
+ * bookkeeping of the spoofing detection (SPREE)
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "gnss_signal_scheduler.h"
+#include <algorithm>
+
+// SPREE acquires the peaks 1 to 5 of each satellite, see pcps_sd_acquisition_cc
+#define GNSS_SIGNAL_SCHEDULER_MAX_PEAK 5
+
+Gnss_Signal_Scheduler::Gnss_Signal_Scheduler() :
+        d_size(0),
+        d_parked(0),
+        d_peaks_per_satellite(2)
+{}
+
+
+void Gnss_Signal_Scheduler::clear()
+{
+    d_queues.clear();
+    d_counts.clear();
+    d_levels.clear();
+    d_reserved.clear();
+    d_size = 0;
+    d_parked = 0;
+    d_acquired_peaks.clear();
+    d_next_peak.clear();
+    d_channel_peak.clear();
+}
+
+
+unsigned int Gnss_Signal_Scheduler::type_key(const std::string& signal_str)
+{
+    unsigned int key = 0;
+    for (unsigned int i = 0; i < 2 && i < signal_str.size(); i++)
+        {
+            key = (key << 8) | static_cast<unsigned char>(signal_str[i]);
+        }
+    return key;
+}
+
+
+unsigned long long Gnss_Signal_Scheduler::system_key(const std::string& system)
+{
+    // the first two letters tell the systems apart: "GP", "GL", "SB", "Ga", "Be"
+    return type_key(system);
+}
+
+
+unsigned long long Gnss_Signal_Scheduler::signal_key(const Gnss_Signal& signal)
+{
+    // system, PRN and signal type: G07 1C, E07 1B and G07 2S are different keys
+    Gnss_Satellite satellite = signal.get_satellite();
+    return satellite_key(system_key(satellite.get_system()), satellite.get_PRN()) | type_key(signal.get_signal_str());
+}
+
+
+int Gnss_Signal_Scheduler::level(const Gnss_Signal& signal) const
+{
+    if (d_levels.empty())
+        {
+            return NORMAL;
+        }
+    // the level holds for every signal of the satellite
+    Gnss_Satellite satellite = signal.get_satellite();
+    std::unordered_map<unsigned long long, int>::const_iterator it = d_levels.find(satellite_key(system_key(satellite.get_system()), satellite.get_PRN()));
+    return it == d_levels.end() ? static_cast<int>(NORMAL) : it->second;
+}
+
+
+void Gnss_Signal_Scheduler::queue(const Gnss_Signal& signal, int level, bool front)
+{
+    std::deque<Gnss_Signal>& queue = d_queues[type_key(signal.get_signal_str())].levels[level];
+    if (front)
+        {
+            queue.push_front(signal);
+        }
+    else
+        {
+            queue.push_back(signal);
+        }
+    if (level == PARKED)
+        {
+            d_parked++;
+        }
+    else
+        {
+            d_size++;
+        }
+}
+
+
+void Gnss_Signal_Scheduler::push_back(const Gnss_Signal& signal)
+{
+    queue(signal, level(signal), false);
+    d_counts[signal_key(signal)]++;
+}
+
+
+void Gnss_Signal_Scheduler::push_front(const Gnss_Signal& signal)
+{
+    // first in line, whatever the level of the satellite
+    queue(signal, PRIORITY, true);
+    d_counts[signal_key(signal)]++;
+}
+
+
+bool Gnss_Signal_Scheduler::next(unsigned int channel, const std::string& signal_str, Gnss_Signal& signal)
+{
+    std::map<unsigned int, Gnss_Signal>::iterator reserved = d_reserved.find(channel);
+    if (reserved != d_reserved.end())
+        {
+            bool same_type = reserved->second.get_signal_str() == signal_str;
+            if (same_type)
+                {
+                    signal = reserved->second;
+                }
+            // only for the first assignment of the channel
+            d_reserved.erase(reserved);
+            if (same_type)
+                {
+                    return true;
+                }
+        }
+    std::map<unsigned int, Ready_Queue>::iterator queue_it = d_queues.find(type_key(signal_str));
+    if (queue_it == d_queues.end())
+        {
+            return false;
+        }
+    for (int level = PRIORITY; level < PARKED; level++)
+        {
+            std::deque<Gnss_Signal>& queue = queue_it->second.levels[level];
+            if (!queue.empty())
+                {
+                    signal = queue.front();
+                    queue.pop_front();
+                    d_counts[signal_key(signal)]--;
+                    d_size--;
+                    return true;
+                }
+        }
+    return false;
+}
+
+
+bool Gnss_Signal_Scheduler::take(const Gnss_Signal& signal)
+{
+    std::map<unsigned int, Ready_Queue>::iterator queue_it = d_queues.find(type_key(signal.get_signal_str()));
+    if (queue_it == d_queues.end() || count(signal) == 0)
+        {
+            return false;
+        }
+    for (int level = PRIORITY; level < LEVELS; level++)
+        {
+            std::deque<Gnss_Signal>& queue = queue_it->second.levels[level];
+            std::deque<Gnss_Signal>::iterator it = std::find(queue.begin(), queue.end(), signal);
+            if (it != queue.end())
+                {
+                    queue.erase(it);
+                    d_counts[signal_key(signal)]--;
+                    if (level == PARKED)
+                        {
+                            d_parked--;
+                        }
+                    else
+                        {
+                            d_size--;
+                        }
+                    return true;
+                }
+        }
+    return false;
+}
+
+
+void Gnss_Signal_Scheduler::reserve(unsigned int channel, const Gnss_Signal& signal)
+{
+    std::map<unsigned int, Gnss_Signal>::iterator reserved = d_reserved.find(channel);
+    if (reserved != d_reserved.end())
+        {
+            push_front(reserved->second);
+            d_reserved.erase(reserved);
+        }
+    // a satellite left out by <system>.prns is reserved all the same
+    take(signal);
+    d_reserved.insert(std::make_pair(channel, signal));
+}
+
+
+void Gnss_Signal_Scheduler::requeue()
+{
+    d_size = 0;
+    d_parked = 0;
+    for (std::map<unsigned int, Ready_Queue>::iterator queue_it = d_queues.begin(); queue_it != d_queues.end(); ++queue_it)
+        {
+            Ready_Queue old_queue;
+            for (int level = PRIORITY; level < LEVELS; level++)
+                {
+                    old_queue.levels[level].swap(queue_it->second.levels[level]);
+                }
+            for (int level = PRIORITY; level < LEVELS; level++)
+                {
+                    std::deque<Gnss_Signal>& queue = old_queue.levels[level];
+                    for (std::deque<Gnss_Signal>::iterator it = queue.begin(); it != queue.end(); ++it)
+                        {
+                            this->queue(*it, this->level(*it), false);
+                        }
+                }
+        }
+}
+
+
+void Gnss_Signal_Scheduler::prioritize(const std::string& system, const std::set<unsigned int>& prns)
+{
+    for (std::set<unsigned int>::const_iterator prn = prns.begin(); prn != prns.end(); ++prn)
+        {
+            d_levels[satellite_key(system_key(system), *prn)] = PRIORITY;
+        }
+    requeue();
+}
+
+
+void Gnss_Signal_Scheduler::set_visibility(const std::string& system, const std::set<unsigned int>& visible,
+        const std::set<unsigned int>& hidden, bool park_hidden)
+{
+    for (std::set<unsigned int>::const_iterator prn = visible.begin(); prn != visible.end(); ++prn)
+        {
+            d_levels[satellite_key(system_key(system), *prn)] = PRIORITY;
+        }
+    for (std::set<unsigned int>::const_iterator prn = hidden.begin(); prn != hidden.end(); ++prn)
+        {
+            d_levels[satellite_key(system_key(system), *prn)] = park_hidden ? PARKED : DEFERRED;
+        }
+    requeue();
+}
+
+
+unsigned int Gnss_Signal_Scheduler::count(const Gnss_Signal& signal) const
+{
+    std::unordered_map<unsigned long long, unsigned int>::const_iterator it = d_counts.find(signal_key(signal));
+    return it == d_counts.end() ? 0 : it->second;
+}
+
+
+bool Gnss_Signal_Scheduler::empty(const std::string& signal_str) const
+{
+    std::map<unsigned int, Ready_Queue>::const_iterator queue_it = d_queues.find(type_key(signal_str));
+    if (queue_it == d_queues.end())
+        {
+            return true;
+        }
+    for (int level = PRIORITY; level < PARKED; level++)
+        {
+            if (!queue_it->second.levels[level].empty())
+                {
+                    return false;
+                }
+        }
+    return true;
+}
+
+
+int Gnss_Signal_Scheduler::assign_peak(unsigned int PRN, unsigned int channel)
+{
+    int& acquired = d_acquired_peaks[PRN];
+    if (acquired >= d_peaks_per_satellite)
+        {
+            return 0;
+        }
+    acquired++;
+    int& next_peak = d_next_peak[PRN];
+    int peak = next_peak;
+    if (peak < 1 || peak > GNSS_SIGNAL_SCHEDULER_MAX_PEAK)
+        {
+            peak = 1;
+        }
+    next_peak = peak + 1;
+    d_channel_peak[channel] = peak;
+    return peak;
+}
+
+
+void Gnss_Signal_Scheduler::release_peak(unsigned int PRN)
+{
+    std::map<unsigned int, int>::iterator it = d_acquired_peaks.find(PRN);
+    if (it != d_acquired_peaks.end() && it->second > 0)
+        {
+            it->second--;
+        }
+}
+
+
+void Gnss_Signal_Scheduler::set_next_peak(unsigned int PRN, int peak)
+{
+    d_next_peak[PRN] = peak;
+}
+
+
+int Gnss_Signal_Scheduler::acquired_peaks(unsigned int PRN) const
+{
+    std::map<unsigned int, int>::const_iterator it = d_acquired_peaks.find(PRN);
+    return it == d_acquired_peaks.end() ? 0 : it->second;
+}
+
+
+int Gnss_Signal_Scheduler::channel_peak(unsigned int channel) const
+{
+    std::map<unsigned int, int>::const_iterator it = d_channel_peak.find(channel);
+    return it == d_channel_peak.end() ? 0 : it->second;
+}
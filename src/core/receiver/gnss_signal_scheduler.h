@@ -0,0 +1,153 @@
+/*!
+ * \file gnss_signal_scheduler.h
+ * \brief Queues of the GNSS signals waiting for a channel, and the peak
+ * bookkeeping of the spoofing detection (SPREE)
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_GNSS_SIGNAL_SCHEDULER_H_
+#define GNSS_SDR_GNSS_SIGNAL_SCHEDULER_H_
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include "gnss_signal.h"
+
+/*!
+ * \brief Signals waiting to be searched, with one ready queue per signal
+ * type ("1C", "2S", "1B", "5X").
+ *
+ * A channel only takes signals of its own type, so next() pops the front of
+ * that queue: a channel is assigned in O(1), without rotating the signals
+ * of the other types or comparing strings. Each queue has four levels, by
+ * satellite: the ones given by prioritize() (assisted, or visible according
+ * to the almanac) are taken first, then those with no prediction, then the
+ * ones below the horizon. Parked satellites (below the horizon, when the
+ * receiver prunes them) are kept but never given to a channel. A signal can
+ * be queued more than once (SPREE tracks each satellite on several
+ * channels), and count() tells how many instances are waiting, also in O(1).
+ *
+ * The peak bookkeeping of SPREE lives here too: each satellite is tracked
+ * on up to peaks_per_satellite channels, each one on a different
+ * correlation peak of the acquisition (1 to GNSS_SIGNAL_SCHEDULER_MAX_PEAK,
+ * then wrapping). The satellites are told apart by PRN only, as the
+ * detection only runs on GPS L1 C/A.
+ */
+class Gnss_Signal_Scheduler
+{
+public:
+    Gnss_Signal_Scheduler();
+
+    void clear();
+
+    void push_back(const Gnss_Signal& signal);  //!< Queues the signal after the others of its level
+    void push_front(const Gnss_Signal& signal); //!< Queues the signal first in line of its type
+
+    /*!
+     * \brief Takes the next signal for a channel of the signal type
+     * signal_str, or the one reserved for the channel, if any
+     * \return false if no signal of that type is waiting
+     */
+    bool next(unsigned int channel, const std::string& signal_str, Gnss_Signal& signal);
+
+    /*!
+     * \brief Takes a queued instance of signal out of the queues and keeps
+     * it for the next call to next() on the channel
+     * (ChannelN.satellite in the configuration)
+     */
+    void reserve(unsigned int channel, const Gnss_Signal& signal);
+
+    //! Signals of the system with these PRNs go first, from now on
+    void prioritize(const std::string& system, const std::set<unsigned int>& prns);
+
+    /*!
+     * \brief Visible satellites go first, hidden ones after those with no
+     * prediction, or are parked if park_hidden is set. The queued signals
+     * move to their new level, keeping their order: O(n), once in a while.
+     */
+    void set_visibility(const std::string& system, const std::set<unsigned int>& visible,
+            const std::set<unsigned int>& hidden, bool park_hidden);
+
+    unsigned int count(const Gnss_Signal& signal) const; //!< Queued instances of the signal, parked included
+    unsigned int size() const { return d_size; }     //!< Signals that a channel can take
+    unsigned int parked() const { return d_parked; }
+    bool empty() const { return d_size == 0; }
+    bool empty(const std::string& signal_str) const;
+
+    // SPREE peak bookkeeping
+    void set_peaks_per_satellite(int peaks) { d_peaks_per_satellite = peaks; }
+    /*!
+     * \brief Gives the channel the next peak of the satellite to acquire
+     * \return the peak, or 0 if the satellite is already tracked on
+     * peaks_per_satellite channels
+     */
+    int assign_peak(unsigned int PRN, unsigned int channel);
+    void release_peak(unsigned int PRN);                    //!< A channel of the satellite lost it
+    void set_next_peak(unsigned int PRN, int peak);         //!< The next channel acquires this peak
+    int acquired_peaks(unsigned int PRN) const;             //!< Channels with a peak of the satellite
+    int channel_peak(unsigned int channel) const;           //!< Peak assigned to the channel, 0 if none
+
+private:
+    enum Level
+    {
+        PRIORITY = 0,
+        NORMAL = 1,
+        DEFERRED = 2,
+        PARKED = 3,
+        LEVELS = 4
+    };
+
+    struct Ready_Queue
+    {
+        std::deque<Gnss_Signal> levels[LEVELS];
+    };
+
+    static unsigned int type_key(const std::string& signal_str);
+    static unsigned long long system_key(const std::string& system);
+    static unsigned long long satellite_key(unsigned long long system, unsigned int PRN) { return (system << 32) | (static_cast<unsigned long long>(PRN) << 16); }
+    static unsigned long long signal_key(const Gnss_Signal& signal);
+    int level(const Gnss_Signal& signal) const;
+    void queue(const Gnss_Signal& signal, int level, bool front);
+    bool take(const Gnss_Signal& signal);
+    void requeue(); // moves every queued signal to the level of its satellite
+
+    std::map<unsigned int, Ready_Queue> d_queues;             // by type_key, a handful of types
+    std::unordered_map<unsigned long long, unsigned int> d_counts; // by signal_key
+    std::unordered_map<unsigned long long, int> d_levels;          // by satellite_key, NORMAL if absent
+    std::map<unsigned int, Gnss_Signal> d_reserved;           // by channel
+    unsigned int d_size;
+    unsigned int d_parked;
+
+    int d_peaks_per_satellite;
+    std::map<unsigned int, int> d_acquired_peaks;   // by PRN
+    std::map<unsigned int, int> d_next_peak;        // by PRN
+    std::map<unsigned int, int> d_channel_peak;     // by channel
+};
+
+#endif
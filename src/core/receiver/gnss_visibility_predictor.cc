@@ -0,0 +1,167 @@
+/*!
+ * \file gnss_visibility_predictor.cc
+ * \brief Elevation of the GPS satellites from their almanac or ephemeris
+ * and an approximate receiver position
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "gnss_visibility_predictor.h"
+#include <cmath>
+#include "GPS_L1_CA.h"
+
+// WGS 84 ellipsoid
+#define GNSS_VISIBILITY_PREDICTOR_WGS84_A 6378137.0
+#define GNSS_VISIBILITY_PREDICTOR_WGS84_E2 6.69437999014e-3
+// reference inclination of the almanac, IS-GPS-200E 20.3.3.5.2.1 [semi-circles]
+#define GNSS_VISIBILITY_PREDICTOR_ALMANAC_I0 0.30
+
+
+Gnss_Visibility_Predictor::Gnss_Visibility_Predictor(double elevation_mask_deg) :
+        d_elevation_mask_deg(elevation_mask_deg),
+        d_has_position(false)
+{
+    for (unsigned int i = 0; i < 3; i++)
+        {
+            d_rx_ecef[i] = 0.0;
+            d_east[i] = 0.0;
+            d_north[i] = 0.0;
+            d_up[i] = 0.0;
+        }
+}
+
+
+void Gnss_Visibility_Predictor::set_almanac(const Gps_Almanac& almanac)
+{
+    std::map<unsigned int, Orbit>::iterator it = d_orbits.find(almanac.i_satellite_PRN);
+    if (it != d_orbits.end() && it->second.from_ephemeris)
+        {
+            return;
+        }
+    if (almanac.d_sqrt_A <= 0.0 || almanac.i_SV_health != 0)
+        {
+            return;
+        }
+    // the almanac angles are in semi-circles, the ephemeris ones in radians
+    Orbit orbit;
+    orbit.ephemeris.i_satellite_PRN = almanac.i_satellite_PRN;
+    orbit.ephemeris.d_sqrt_A = almanac.d_sqrt_A;
+    orbit.ephemeris.d_e_eccentricity = almanac.d_e_eccentricity;
+    orbit.ephemeris.d_M_0 = almanac.d_M_0 * GPS_PI;
+    orbit.ephemeris.d_OMEGA0 = almanac.d_OMEGA0 * GPS_PI;
+    orbit.ephemeris.d_OMEGA = almanac.d_OMEGA * GPS_PI;
+    orbit.ephemeris.d_OMEGA_DOT = almanac.d_OMEGA_DOT * GPS_PI;
+    orbit.ephemeris.d_i_0 = (GNSS_VISIBILITY_PREDICTOR_ALMANAC_I0 + almanac.d_Delta_i) * GPS_PI;
+    orbit.ephemeris.d_Toe = almanac.d_Toa;
+    orbit.from_ephemeris = false;
+    d_orbits[almanac.i_satellite_PRN] = orbit;
+}
+
+
+void Gnss_Visibility_Predictor::set_ephemeris(const Gps_Ephemeris& ephemeris)
+{
+    if (ephemeris.d_sqrt_A <= 0.0)
+        {
+            return;
+        }
+    Orbit orbit;
+    orbit.ephemeris = ephemeris;
+    orbit.from_ephemeris = true;
+    d_orbits[ephemeris.i_satellite_PRN] = orbit;
+}
+
+
+void Gnss_Visibility_Predictor::set_position(double latitude_deg, double longitude_deg, double height_m)
+{
+    double lat = latitude_deg * GPS_PI / 180.0;
+    double lon = longitude_deg * GPS_PI / 180.0;
+    double N = GNSS_VISIBILITY_PREDICTOR_WGS84_A / std::sqrt(1.0 - GNSS_VISIBILITY_PREDICTOR_WGS84_E2 * std::sin(lat) * std::sin(lat));
+    d_rx_ecef[0] = (N + height_m) * std::cos(lat) * std::cos(lon);
+    d_rx_ecef[1] = (N + height_m) * std::cos(lat) * std::sin(lon);
+    d_rx_ecef[2] = (N * (1.0 - GNSS_VISIBILITY_PREDICTOR_WGS84_E2) + height_m) * std::sin(lat);
+
+    d_east[0] = -std::sin(lon);
+    d_east[1] = std::cos(lon);
+    d_east[2] = 0.0;
+    d_north[0] = -std::sin(lat) * std::cos(lon);
+    d_north[1] = -std::sin(lat) * std::sin(lon);
+    d_north[2] = std::cos(lat);
+    d_up[0] = std::cos(lat) * std::cos(lon);
+    d_up[1] = std::cos(lat) * std::sin(lon);
+    d_up[2] = std::sin(lat);
+    d_has_position = true;
+}
+
+
+bool Gnss_Visibility_Predictor::elevation(unsigned int PRN, double gps_tow_s, double& elevation_deg)
+{
+    std::map<unsigned int, Orbit>::iterator it = d_orbits.find(PRN);
+    if (!d_has_position || it == d_orbits.end())
+        {
+            return false;
+        }
+    Gps_Ephemeris& ephemeris = it->second.ephemeris;
+    ephemeris.satellitePosition(gps_tow_s);
+    double los[3] = { ephemeris.d_satpos_X - d_rx_ecef[0],
+                      ephemeris.d_satpos_Y - d_rx_ecef[1],
+                      ephemeris.d_satpos_Z - d_rx_ecef[2] };
+    double up = los[0] * d_up[0] + los[1] * d_up[1] + los[2] * d_up[2];
+    double range = std::sqrt(los[0] * los[0] + los[1] * los[1] + los[2] * los[2]);
+    if (range <= 0.0)
+        {
+            return false;
+        }
+    elevation_deg = std::asin(up / range) * 180.0 / GPS_PI;
+    return true;
+}
+
+
+void Gnss_Visibility_Predictor::predict(double gps_tow_s, double lookahead_s, std::set<unsigned int>& visible, std::set<unsigned int>& hidden)
+{
+    visible.clear();
+    hidden.clear();
+    if (!d_has_position)
+        {
+            return;
+        }
+    // the future instant wraps at the end of the week inside satellitePosition
+    for (std::map<unsigned int, Orbit>::iterator it = d_orbits.begin(); it != d_orbits.end(); ++it)
+        {
+            double now_deg = 0.0;
+            double later_deg = 0.0;
+            elevation(it->first, gps_tow_s, now_deg);
+            elevation(it->first, gps_tow_s + lookahead_s, later_deg);
+            if (now_deg >= d_elevation_mask_deg || later_deg >= d_elevation_mask_deg)
+                {
+                    visible.insert(it->first);
+                }
+            else
+                {
+                    hidden.insert(it->first);
+                }
+        }
+}
@@ -0,0 +1,93 @@
+/*!
+ * \file gnss_visibility_predictor.h
+ * \brief Elevation of the GPS satellites from their almanac or ephemeris
+ * and an approximate receiver position
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_GNSS_VISIBILITY_PREDICTOR_H_
+#define GNSS_SDR_GNSS_VISIBILITY_PREDICTOR_H_
+
+#include <map>
+#include <set>
+#include "gps_almanac.h"
+#include "gps_ephemeris.h"
+
+/*!
+ * \brief Predicts which GPS satellites are above the horizon, so that the
+ * acquisition searches them first and leaves those below it.
+ *
+ * The orbits come from the almanac (SUPL) or from an ephemeris (SUPL, the
+ * XML files, or decoded by the telemetry). An ephemeris replaces the almanac
+ * of the satellite. The almanac is propagated as an ephemeris without the
+ * harmonic corrections, which is accurate to a few kilometres, far below
+ * what matters for an elevation mask. The position only needs to be known
+ * within some hundreds of kilometres.
+ */
+class Gnss_Visibility_Predictor
+{
+public:
+    explicit Gnss_Visibility_Predictor(double elevation_mask_deg = 5.0);
+
+    void set_almanac(const Gps_Almanac& almanac);
+    void set_ephemeris(const Gps_Ephemeris& ephemeris);
+    void set_position(double latitude_deg, double longitude_deg, double height_m);
+    void set_elevation_mask(double elevation_mask_deg) { d_elevation_mask_deg = elevation_mask_deg; }
+
+    bool has_position() const { return d_has_position; }
+    unsigned int orbits() const { return d_orbits.size(); } //!< Satellites with an almanac or an ephemeris
+
+    /*!
+     * \brief Elevation [deg] of the satellite at the GPS time of week gps_tow_s
+     * \return false if its orbit is unknown, or the position is not set
+     */
+    bool elevation(unsigned int PRN, double gps_tow_s, double& elevation_deg);
+
+    /*!
+     * \brief Sorts the satellites with a known orbit: visible if above the
+     * mask at gps_tow_s or at gps_tow_s + lookahead_s (about to rise),
+     * hidden otherwise. Satellites with no orbit are in neither set.
+     */
+    void predict(double gps_tow_s, double lookahead_s, std::set<unsigned int>& visible, std::set<unsigned int>& hidden);
+
+private:
+    struct Orbit
+    {
+        Gps_Ephemeris ephemeris;
+        bool from_ephemeris;
+    };
+
+    double d_elevation_mask_deg;
+    bool d_has_position;
+    double d_rx_ecef[3];
+    double d_east[3];
+    double d_north[3];
+    double d_up[3];
+    std::map<unsigned int, Orbit> d_orbits;
+};
+
+#endif
@@ -32,89 +32,75 @@
 
 #include "in_memory_configuration.h"
 #include <memory>
-#include <utility>
-#include "string_converter.h"
+#include "property_store.h"
 
-InMemoryConfiguration::InMemoryConfiguration()
+InMemoryConfiguration::InMemoryConfiguration() : properties_(new PropertyStore(false))
 {}
 
 
 InMemoryConfiguration::~InMemoryConfiguration()
-{
-    properties_.clear();
-}
+{}
 
 
 std::string InMemoryConfiguration::property(std::string property_name, std::string default_value)
 {
-    std::map<std::string, std::string>::iterator iter = properties_.find(property_name);
-    if(iter != properties_.end())
-        {
-            return iter->second;
-        }
-    else
-        {
-            return default_value;
-        }
+    return properties_->get(property_name, default_value);
 }
 
 
 bool InMemoryConfiguration::property(std::string property_name, bool default_value)
 {
-    std::string empty = "";
-    return converter_->convert(property(property_name, empty), default_value);
+    return properties_->get(property_name, default_value);
 }
 
 
 long InMemoryConfiguration::property(std::string property_name, long default_value)
 {
-    std::string empty = "";
-    return converter_->convert(property(property_name, empty), default_value);
+    return properties_->get(property_name, default_value);
 }
 
 
 int InMemoryConfiguration::property(std::string property_name, int default_value)
 {
-    std::string empty = "";
-    return converter_->convert(property(property_name, empty), default_value);
+    return properties_->get(property_name, default_value);
 }
 
 
 unsigned int InMemoryConfiguration::property(std::string property_name, unsigned int default_value)
 {
-    std::string empty = "";
-    return converter_->convert(property(property_name, empty), default_value);
+    return properties_->get(property_name, default_value);
 }
 
 
 unsigned short InMemoryConfiguration::property(std::string property_name, unsigned short default_value)
 {
-    std::string empty = "";
-    return converter_->convert(property(property_name, empty), default_value);
+    return properties_->get(property_name, default_value);
 }
 
 
 float InMemoryConfiguration::property(std::string property_name, float default_value)
 {
-    std::string empty = "";
-    return converter_->convert(property(property_name, empty), default_value);
+    return properties_->get(property_name, default_value);
 }
 
 
 double InMemoryConfiguration::property(std::string property_name, double default_value)
 {
-    std::string empty = "";
-    return converter_->convert(property(property_name, empty), default_value);
+    return properties_->get(property_name, default_value);
 }
 
 
 void InMemoryConfiguration::set_property(std::string property_name, std::string value)
 {
-    properties_.insert(std::make_pair(property_name, value));
+    // the first value of a property is kept
+    if(!properties_->is_present(property_name))
+        {
+            properties_->set(property_name, value);
+        }
 }
 
 
 bool InMemoryConfiguration::is_present(std::string property_name)
 {
-    return (properties_.find(property_name) != properties_.end());
+    return properties_->is_present(property_name);
 }
@@ -36,12 +36,11 @@
 #ifndef GNSS_SDR_IN_MEMORY_CONFIGURATION_H_
 #define GNSS_SDR_IN_MEMORY_CONFIGURATION_H_
 
-#include <map>
 #include <memory>
 #include <string>
 #include "configuration_interface.h"
 
-class StringConverter;
+class PropertyStore;
 
 /*!
  * \brief  This class is an implementation of the interface ConfigurationInterface.
@@ -65,8 +64,7 @@ public:
     void set_property(std::string property_name, std::string value);
     bool is_present(std::string property_name);
 private:
-    std::map<std::string, std::string> properties_;
-    std::unique_ptr<StringConverter> converter_;
+    std::unique_ptr<PropertyStore> properties_;
 };
 
 #endif /*GNSS_SDR_IN_MEMORY_CONFIGURATION_H_*/
@@ -0,0 +1,99 @@
+/*!
+ * \file message_pool.h
+ * \brief Preallocated payloads of the navigation data messages
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_MESSAGE_POOL_H_
+#define GNSS_SDR_MESSAGE_POOL_H_
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/*!
+ * \brief Fixed set of payload slots that a block fills and hands out as
+ * std::shared_ptr, instead of allocating a new payload for each message.
+ *
+ * A slot is free again once every copy of its pointer handed out has been
+ * released, which for a message is when the receiving block has handled
+ * it. acquire() moves the value into a free slot; when all of them are in
+ * flight it falls back to a new allocation, so a slow receiver never loses
+ * a message. The pointers are published through pmt::make_any as before,
+ * so the receivers cast them to the same std::shared_ptr<T> types.
+ *
+ * A pool belongs to one producer thread; the receivers only release the
+ * pointers.
+ */
+template <class T>
+class Message_Pool
+{
+public:
+    explicit Message_Pool(unsigned int n_slots = 4)
+    {
+        for (unsigned int i = 0; i < n_slots; i++)
+            {
+                d_slots.push_back(std::make_shared<T>());
+            }
+        d_next = 0;
+        d_misses = 0;
+    }
+
+    /*!
+     * \brief Moves value into a free slot, and returns the slot
+     */
+    std::shared_ptr<T> acquire(T&& value)
+    {
+        for (unsigned int i = 0; i < d_slots.size(); i++)
+            {
+                std::shared_ptr<T>& slot = d_slots[(d_next + i) % d_slots.size()];
+                if (slot.use_count() == 1)
+                    {
+                        // the last receiver is done with the previous payload
+                        std::atomic_thread_fence(std::memory_order_acquire);
+                        *slot = std::move(value);
+                        d_next = (d_next + i + 1) % d_slots.size();
+                        return slot;
+                    }
+            }
+        d_misses++;
+        return std::make_shared<T>(std::move(value));
+    }
+
+    unsigned int size() const { return d_slots.size(); }
+
+    //! Payloads allocated because every slot was in flight
+    unsigned long int misses() const { return d_misses; }
+
+private:
+    std::vector<std::shared_ptr<T>> d_slots;
+    unsigned int d_next;
+    unsigned long int d_misses;
+};
+
+#endif
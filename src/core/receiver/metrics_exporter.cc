@@ -0,0 +1,219 @@
+/*!
+ * \file metrics_exporter.cc
+ * \brief Periodic dump of the block metrics to the log, and an HTTP
+ * endpoint that serves them in the Prometheus text format
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "metrics_exporter.h"
+#include <cstring>
+#include <sstream>
+#include <vector>
+#include <boost/bind.hpp>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+
+namespace
+{
+/*
+ * One HTTP exchange: the request is read once and ignored, whatever the
+ * path, and the connection is closed after the answer
+ */
+class Metrics_Connection : public std::enable_shared_from_this<Metrics_Connection>
+{
+public:
+    explicit Metrics_Connection(std::shared_ptr<boost::asio::ip::tcp::socket> socket) : d_socket(socket) {}
+
+    void start()
+    {
+        d_socket->async_read_some(boost::asio::buffer(d_request),
+                boost::bind(&Metrics_Connection::request_read, shared_from_this(), _1, _2));
+    }
+
+private:
+    void request_read(const boost::system::error_code& error, std::size_t bytes)
+    {
+        if (error || bytes == 0) return;
+        std::string body = block_metrics_prometheus_text();
+        std::ostringstream response;
+        response << "HTTP/1.0 200 OK\r\n"
+                 << "Content-Type: text/plain; version=0.0.4\r\n"
+                 << "Content-Length: " << body.size() << "\r\n"
+                 << "Connection: close\r\n\r\n"
+                 << body;
+        d_response = response.str();
+        boost::asio::async_write(*d_socket, boost::asio::buffer(d_response),
+                boost::bind(&Metrics_Connection::response_written, shared_from_this(), _1));
+    }
+
+    void response_written(const boost::system::error_code& error)
+    {
+        if (error) return;
+        boost::system::error_code ignored;
+        d_socket->shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored);
+    }
+
+    std::shared_ptr<boost::asio::ip::tcp::socket> d_socket;
+    char d_request[1024];
+    std::string d_response;
+};
+}
+
+
+Metrics_Exporter::Metrics_Exporter(boost::asio::io_service& io_service, const std::string& address, unsigned short port, double dump_s) :
+        d_io_service(io_service),
+        d_address(address),
+        d_port(port),
+        d_dump_s(dump_s),
+        d_acceptor(io_service),
+        d_dump_timer(io_service),
+        d_last_dump(std::chrono::steady_clock::now())
+{}
+
+
+bool Metrics_Exporter::start()
+{
+    schedule_dump();
+    if (d_port == 0)
+        {
+            return true;
+        }
+    try
+    {
+            boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address::from_string(d_address), d_port);
+            d_acceptor.open(endpoint.protocol());
+            d_acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+            d_acceptor.bind(endpoint);
+            d_acceptor.listen();
+    }
+    catch (const boost::system::system_error& e)
+    {
+            LOG(WARNING) << "Unable to serve the metrics on " << d_address << ":" << d_port << ": " << e.what();
+            boost::system::error_code ignored;
+            d_acceptor.close(ignored);
+            return false;
+    }
+    LOG(INFO) << "Metrics served on http://" << d_address << ":" << d_port << "/metrics";
+    accept();
+    return true;
+}
+
+
+void Metrics_Exporter::stop()
+{
+    boost::system::error_code ignored;
+    d_acceptor.close(ignored);
+    d_dump_timer.cancel(ignored);
+}
+
+
+void Metrics_Exporter::accept()
+{
+    std::shared_ptr<boost::asio::ip::tcp::socket> socket = std::make_shared<boost::asio::ip::tcp::socket>(d_io_service);
+    d_acceptor.async_accept(*socket, boost::bind(&Metrics_Exporter::accepted, this, socket, _1));
+}
+
+
+void Metrics_Exporter::accepted(std::shared_ptr<boost::asio::ip::tcp::socket> socket, const boost::system::error_code& error)
+{
+    if (error == boost::asio::error::operation_aborted || !d_acceptor.is_open())
+        {
+            return; // stopped
+        }
+    if (!error)
+        {
+            std::make_shared<Metrics_Connection>(socket)->start();
+        }
+    accept();
+}
+
+
+void Metrics_Exporter::schedule_dump()
+{
+    if (d_dump_s <= 0.0)
+        {
+            return;
+        }
+    d_dump_timer.expires_from_now(boost::posix_time::milliseconds(static_cast<long long>(d_dump_s * 1000.0)));
+    d_dump_timer.async_wait(boost::bind(&Metrics_Exporter::dump_timer_expired, this, _1));
+}
+
+
+void Metrics_Exporter::dump_timer_expired(const boost::system::error_code& error)
+{
+    if (error)
+        {
+            return; // cancelled at the stop
+        }
+    LOG(INFO) << dump();
+    schedule_dump();
+}
+
+
+std::string Metrics_Exporter::dump()
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double elapsed_s = std::chrono::duration<double>(now - d_last_dump).count();
+    d_last_dump = now;
+
+    std::vector<std::shared_ptr<Block_Metrics> > metrics = block_metrics_registered();
+    std::ostringstream text;
+    text.precision(4);
+    text << "Block metrics of the last " << elapsed_s << " s:";
+    for (unsigned int i = 0; i < metrics.size(); i++)
+        {
+            const std::string name = metrics[i]->block() + " " + metrics[i]->instance();
+            Block_Metrics::Snapshot snapshot = metrics[i]->snapshot();
+            Block_Metrics::Snapshot last;
+            std::memset(&last, 0, sizeof(last));
+            std::map<std::string, Block_Metrics::Snapshot>::iterator it = d_last_snapshots.find(name);
+            if (it != d_last_snapshots.end())
+                {
+                    last = it->second;
+                }
+            d_last_snapshots[name] = snapshot;
+            unsigned long long calls = snapshot.calls - last.calls;
+            if (calls == 0)
+                {
+                    continue;
+                }
+            text << "\n  " << name << ": " << calls << " calls, "
+                 << (snapshot.busy_ns - last.busy_ns) * 1e-3 / calls << " us mean, "
+                 << snapshot.max_ns * 1e-3 << " us longest so far, "
+                 << (elapsed_s > 0.0 ? (snapshot.items - last.items) / elapsed_s : 0.0) << " items/s, "
+                 << static_cast<double>(snapshot.input_items - last.input_items) / calls << " items waiting, "
+                 << 100.0 * (snapshot.busy_ns - last.busy_ns) * 1e-9 / elapsed_s << " % busy";
+            if (allocation_guard_compiled())
+                {
+                    text << ", " << snapshot.allocations - last.allocations << " allocations ("
+                         << snapshot.allocated_bytes - last.allocated_bytes << " bytes)";
+                }
+        }
+    return text.str();
+}
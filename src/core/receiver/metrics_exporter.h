@@ -0,0 +1,79 @@
+/*!
+ * \file metrics_exporter.h
+ * \brief Periodic dump of the block metrics to the log, and an HTTP
+ * endpoint that serves them in the Prometheus text format
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_METRICS_EXPORTER_H_
+#define GNSS_SDR_METRICS_EXPORTER_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <boost/asio.hpp>
+#include "block_metrics.h"
+
+/*!
+ * \brief Exports the Block_Metrics of the receiver from the io_service of
+ * the control thread, so it needs no thread of its own.
+ *
+ * Every dump_s seconds it logs, for each block, the calls, their mean and
+ * longest duration, the items consumed per second and the mean input
+ * waiting since the previous dump. If port is not 0 it answers any HTTP
+ * request on address:port with all the counters, e.g. for a Prometheus
+ * scrape job.
+ */
+class Metrics_Exporter
+{
+public:
+    Metrics_Exporter(boost::asio::io_service& io_service, const std::string& address, unsigned short port, double dump_s);
+
+    //! false if the endpoint could not be opened; the dump runs anyway
+    bool start();
+    void stop();
+
+    //! The dump done every dump_s
+    std::string dump();
+
+private:
+    void accept();
+    void accepted(std::shared_ptr<boost::asio::ip::tcp::socket> socket, const boost::system::error_code& error);
+    void schedule_dump();
+    void dump_timer_expired(const boost::system::error_code& error);
+
+    boost::asio::io_service& d_io_service;
+    std::string d_address;
+    unsigned short d_port;
+    double d_dump_s;
+    boost::asio::ip::tcp::acceptor d_acceptor;
+    boost::asio::deadline_timer d_dump_timer;
+    std::map<std::string, Block_Metrics::Snapshot> d_last_snapshots; // of the previous dump
+    std::chrono::steady_clock::time_point d_last_dump;
+};
+
+#endif
@@ -0,0 +1,133 @@
+/*!
+ * \file navigation_data_bus.h
+ * \brief Versioned GPS ephemeris records shared by the telemetry decoders
+ * and the navigation data consumers
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_NAVIGATION_DATA_BUS_H_
+#define GNSS_SDR_NAVIGATION_DATA_BUS_H_
+
+#include <memory>
+#include <boost/thread/mutex.hpp>
+#include "concurrent_snapshot_map.h"
+#include "gps_ephemeris.h"
+
+/*!
+ * \brief One issue of the GPS ephemeris decoded by a channel
+ */
+struct Gps_Ephemeris_Record
+{
+    std::shared_ptr<const Gps_Ephemeris> ephemeris; //!< Immutable, shared by every consumer
+    unsigned int version;  //!< 1 for the first issue published under the key, incremented at every new issue
+    double timestamp;      //!< Receiver time of the publication [ms]
+};
+
+
+/*!
+ * \brief Carries the decoded GPS ephemeris from the telemetry decoders to
+ * the PVT, the spoofing detector and the RINEX/RTCM printers.
+ *
+ * A telemetry decoder publishes the ephemeris of every subframe 3 it
+ * decodes, but the bus only stores a new record, and only reports a
+ * change, when the issue of data (IODC and both IODEs), the reference time
+ * or the week differ from the record already stored under the key. The
+ * decoders forward the shared record to the PVT message port only then,
+ * so the PVT copies an ephemeris when the satellite uploads a new one,
+ * not every 30 seconds per channel.
+ *
+ * Consumers that want the current records without waiting for a message
+ * take a snapshot, which is never copied nor modified.
+ */
+class navigation_data_bus
+{
+public:
+    typedef concurrent_snapshot_map<Gps_Ephemeris_Record>::Snapshot Ephemeris_Snapshot;
+
+    /*!
+     * \brief True if a and b are the same issue of the ephemeris
+     */
+    static bool same_issue(const Gps_Ephemeris& a, const Gps_Ephemeris& b)
+    {
+        return a.d_IODC == b.d_IODC
+                && a.d_IODE_SF2 == b.d_IODE_SF2
+                && a.d_IODE_SF3 == b.d_IODE_SF3
+                && a.d_Toe == b.d_Toe
+                && a.i_GPS_week == b.i_GPS_week;
+    }
+
+    /*!
+     * \brief Publishes eph under key (the channel uid, or the PRN).
+     * \return true if eph is a new issue. In both cases record is set to
+     * the record stored under key.
+     */
+    bool publish_ephemeris(int key, const Gps_Ephemeris& eph, double time_ms, Gps_Ephemeris_Record& record)
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        unsigned int version = 0;
+        if (d_ephemeris.read(key, record))
+            {
+                if (same_issue(*record.ephemeris, eph))
+                    {
+                        return false;
+                    }
+                version = record.version;
+            }
+        record.ephemeris = std::make_shared<const Gps_Ephemeris>(eph);
+        record.version = version + 1;
+        record.timestamp = time_ms;
+        d_ephemeris.write(key, record);
+        return true;
+    }
+
+    bool read_ephemeris(int key, Gps_Ephemeris_Record& record) const
+    {
+        return d_ephemeris.read(key, record);
+    }
+
+    Ephemeris_Snapshot get_ephemeris_snapshot() const
+    {
+        return d_ephemeris.get_snapshot();
+    }
+
+    /*!
+     * \brief Forgets the record of a channel that stopped tracking, so its
+     * next ephemeris is published as new
+     */
+    void remove(int key)
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_ephemeris.remove(key);
+    }
+
+private:
+    concurrent_snapshot_map<Gps_Ephemeris_Record> d_ephemeris;
+    boost::mutex d_mutex;
+};
+
+#endif
@@ -0,0 +1,138 @@
+/*!
+ * \file realtime_margin_monitor.cc
+ * \brief Real-time margin of the receiver, and the levels of work it sheds
+ * when it falls behind the signal
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "realtime_margin_monitor.h"
+
+
+Realtime_Margin_Monitor::Realtime_Margin_Monitor(double fs_hz, double max_lag_s, double recover_lag_s, double hold_s) :
+        d_fs_hz(fs_hz),
+        d_max_lag_s(max_lag_s),
+        d_recover_lag_s(recover_lag_s),
+        d_hold_s(hold_s),
+        d_started(false),
+        d_anchor_wall_s(0.0),
+        d_anchor_samples(0),
+        d_last_wall_s(0.0),
+        d_last_samples(0),
+        d_lag_s(0.0),
+        d_margin(0.0),
+        d_level(NO_SHEDDING),
+        d_change_wall_s(0.0),
+        d_change_lag_s(0.0),
+        d_recovered_wall_s(-1.0)
+{}
+
+
+bool Realtime_Margin_Monitor::update(double wall_s, unsigned long long samples)
+{
+    if (!d_started)
+        {
+            d_started = true;
+            d_anchor_wall_s = wall_s;
+            d_anchor_samples = samples;
+            d_last_wall_s = wall_s;
+            d_last_samples = samples;
+            d_change_wall_s = wall_s;
+            return false;
+        }
+
+    if (wall_s > d_last_wall_s)
+        {
+            d_margin = static_cast<double>(samples - d_last_samples) / d_fs_hz / (wall_s - d_last_wall_s) - 1.0;
+        }
+    d_last_wall_s = wall_s;
+    d_last_samples = samples;
+
+    d_lag_s = (wall_s - d_anchor_wall_s) - static_cast<double>(samples - d_anchor_samples) / d_fs_hz;
+    if (d_lag_s < 0.0)
+        {
+            // ahead of the wall clock: the signal cannot arrive faster than real time, or it comes from a file
+            d_anchor_wall_s = wall_s;
+            d_anchor_samples = samples;
+            d_lag_s = 0.0;
+        }
+
+    if (d_lag_s < d_recover_lag_s)
+        {
+            if (d_recovered_wall_s < 0.0)
+                {
+                    d_recovered_wall_s = wall_s;
+                }
+        }
+    else
+        {
+            d_recovered_wall_s = -1.0;
+        }
+
+    if (wall_s - d_change_wall_s < d_hold_s)
+        {
+            return false; // the last change has not had its effect yet
+        }
+    if (d_lag_s > d_max_lag_s && d_lag_s >= d_change_lag_s && d_level + 1 < LEVELS)
+        {
+            change_level(static_cast<Level>(d_level + 1), wall_s);
+            return true;
+        }
+    if (d_level > NO_SHEDDING && d_recovered_wall_s >= 0.0 && wall_s - d_recovered_wall_s >= d_hold_s)
+        {
+            change_level(static_cast<Level>(d_level - 1), wall_s);
+            d_recovered_wall_s = wall_s; // each step down waits as long
+            return true;
+        }
+    return false;
+}
+
+
+void Realtime_Margin_Monitor::change_level(Level level, double wall_s)
+{
+    d_level = level;
+    d_change_wall_s = wall_s;
+    d_change_lag_s = d_lag_s;
+}
+
+
+const char* Realtime_Margin_Monitor::level_name(Level level)
+{
+    switch (level)
+    {
+    case NO_SHEDDING:
+        return "no shedding";
+    case APT_PAUSED:
+        return "APT auxiliary peaks paused";
+    case PPE_DECIMATED:
+        return "PPE checks decimated";
+    case CHANNELS_DROPPED:
+        return "lowest C/N0 channels dropped";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,96 @@
+/*!
+ * \file realtime_margin_monitor.h
+ * \brief Real-time margin of the receiver, and the levels of work it sheds
+ * when it falls behind the signal
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_REALTIME_MARGIN_MONITOR_H_
+#define GNSS_SDR_REALTIME_MARGIN_MONITOR_H_
+
+/*!
+ * \brief Compares the samples read by the slowest channel with the wall
+ * clock, and chooses how much work the receiver sheds to keep up.
+ *
+ * The lag is the wall time elapsed minus the signal time read, counted
+ * from the last moment the receiver was not behind: a file source read
+ * faster than real time has no lag. A live source that is not kept up
+ * with fills the buffers, then overflows, and the lag grows either way.
+ *
+ * While the lag is above max_lag_s, and has not decreased since the last
+ * change, the level rises by one every hold_s. Once it stays below
+ * recover_lag_s for hold_s, the level falls by one.
+ */
+class Realtime_Margin_Monitor
+{
+public:
+    enum Level
+    {
+        NO_SHEDDING,      //!< all the work is done
+        APT_PAUSED,       //!< the auxiliary peaks of APT are neither tracked nor searched
+        PPE_DECIMATED,    //!< and the PPE checks run on fewer epochs
+        CHANNELS_DROPPED, //!< and the channels of lowest C/N0 are stopped
+        LEVELS
+    };
+
+    Realtime_Margin_Monitor(double fs_hz, double max_lag_s, double recover_lag_s, double hold_s);
+
+    /*!
+     * \brief Takes the samples read by the slowest channel at wall_s [s]
+     * \return true if the level changed
+     */
+    bool update(double wall_s, unsigned long long samples);
+
+    Level level() const { return d_level; }
+    double lag_s() const { return d_lag_s; }
+    double margin() const { return d_margin; } //!< signal time read per wall time since the previous update, minus 1
+
+    static const char* level_name(Level level);
+
+private:
+    void change_level(Level level, double wall_s);
+
+    double d_fs_hz;
+    double d_max_lag_s;
+    double d_recover_lag_s;
+    double d_hold_s;
+
+    bool d_started;
+    double d_anchor_wall_s; // the last time the receiver was not behind
+    unsigned long long d_anchor_samples;
+    double d_last_wall_s;
+    unsigned long long d_last_samples;
+    double d_lag_s;
+    double d_margin;
+
+    Level d_level;
+    double d_change_wall_s;
+    double d_change_lag_s;
+    double d_recovered_wall_s; // since when the lag is below recover_lag_s, negative if it is not
+};
+
+#endif
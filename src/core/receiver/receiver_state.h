@@ -0,0 +1,182 @@
+/*!
+ * \file receiver_state.h
+ * \brief Tables shared by the blocks of one receiver
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_RECEIVER_STATE_H_
+#define GNSS_SDR_RECEIVER_STATE_H_
+
+#include <map>
+#include <memory>
+#include <boost/thread/tss.hpp>
+#include "acquired_peaks.h"
+#include "aoa_metrics.h"
+#include "concurrent_map.h"
+#include "concurrent_ring_queue.h"
+#include "concurrent_snapshot_map.h"
+#include "concurrent_subframe_map.h"
+#include "correlator_taps.h"
+#include "ephemeris_history.h"
+#include "gnss_synchro.h"
+#include "gps_acq_assist.h"
+#include "gps_ephemeris.h"
+#include "gps_ref_location.h"
+#include "gps_ref_time.h"
+#include "navigation_data_bus.h"
+#include "spectrum_metrics.h"
+#include "spoofing_message.h"
+#include "sqm_metrics.h"
+#include "vector_tracking_aid.h"
+
+/*!
+ * \brief GPS week and time of week of the last subframe of a channel, with
+ * its timestamp [ms] and the id of the subframe.
+ */
+struct GPS_time_t
+{
+    int week;
+    double TOW;
+    double timestamp;
+    int subframe_id;
+};
+
+
+/*!
+ * \brief Tables shared by the blocks of one receiver.
+ *
+ * Each GNSSFlowgraph owns one, and binds it to the thread that builds its
+ * blocks with a Receiver_State_Scope. The blocks, detectors and helpers
+ * that use these tables keep the state of current() from their
+ * construction, so several receivers can run in one process, each on its
+ * own tables. Code that runs outside of any scope, like the unit tests or
+ * the offline utilities, shares a default state for the whole process.
+ *
+ * Each table keeps its own lock or snapshot, as before. The maps can be
+ * watched with concurrent_map::watch().
+ */
+class Receiver_State : public std::enable_shared_from_this<Receiver_State>
+{
+public:
+    //! Acquisition assistance from SUPL, by PRN
+    concurrent_map<Gps_Acq_Assist> gps_acq_assist_map;
+    //! Last in-lock state of the tracking channels, by reacquisition_key()
+    concurrent_map<Gnss_Synchro> gps_reacquisition_map;
+    //! Auxiliary peaks of the last full search of the SD acquisition, by PRN
+    concurrent_map<Acquired_Peaks> auxiliary_peaks_map;
+    //! Last correlator taps of the tracking channels, by channel
+    concurrent_map<Correlator_Taps> correlator_taps_map;
+    //! Signal quality metrics of the tracking channels, by channel
+    concurrent_map<Sqm_Metrics> sqm_map;
+    //! Angle of arrival metrics of the tracking channels, by channel
+    concurrent_map<Aoa_Metrics> aoa_map;
+    //! Power and spectrum of the signal conditioners, by conditioner
+    concurrent_map<Spectrum_Metrics> spectrum_map;
+    //! Carrier Doppler predicted by the PVT solution, by PRN
+    concurrent_snapshot_map<Vector_Tracking_Aid> vector_tracking_map;
+    //! Ephemeris decoded by the telemetry decoders
+    navigation_data_bus navigation_data;
+    //! Last PVT fix and its time, key 0, read by the prediction of the satellites in view
+    concurrent_map<Gps_Ref_Location> gps_ref_location_map;
+    concurrent_map<Gps_Ref_Time> gps_ref_time_map;
+
+    // spoofing detection
+    //! Last GPS time of each channel, by subframe uid
+    concurrent_snapshot_map<GPS_time_t> gps_time;
+    //! Last ephemeris of each satellite, by PRN and issue of data
+    Ephemeris_History ephemeris_history;
+    //! Last GPS week (key 0), TOW (1) and its timestamp (2) of the receiver
+    concurrent_map<double> last_gps_time;
+    //! Satellites for which spoofing has been detected, by PRN
+    concurrent_map<bool> spoofing_status;
+    //! Undecoded subframes of the channels, by subframe uid
+    concurrent_subframe_map subframe_map;
+    concurrent_map<std::map<unsigned int, unsigned int>> subframe_check;
+    //! Alarms of the spoofing detector, drained by the Spoofing_Report_Writer
+    concurrent_mpsc_queue<Spoofing_Message> spoofing_queue;
+
+    /*!
+     * \brief State bound to the calling thread by a Receiver_State_Scope,
+     * or the default state of the process
+     */
+    static std::shared_ptr<Receiver_State> current()
+    {
+        Receiver_State* bound = bound_state().get();
+        if (bound)
+            {
+                return bound->shared_from_this();
+            }
+        return default_state();
+    }
+
+    //! State of the code that runs outside of any Receiver_State_Scope
+    static std::shared_ptr<Receiver_State> default_state()
+    {
+        static std::shared_ptr<Receiver_State> state = std::make_shared<Receiver_State>();
+        return state;
+    }
+
+private:
+    friend class Receiver_State_Scope;
+
+    static void no_cleanup(Receiver_State*) {}
+
+    static boost::thread_specific_ptr<Receiver_State>& bound_state()
+    {
+        static boost::thread_specific_ptr<Receiver_State> bound(no_cleanup);
+        return bound;
+    }
+};
+
+
+/*!
+ * \brief Binds a Receiver_State to the calling thread for its lifetime, so
+ * that the blocks built in the meantime keep it. Scopes nest.
+ */
+class Receiver_State_Scope
+{
+public:
+    explicit Receiver_State_Scope(std::shared_ptr<Receiver_State> state) : d_state(state)
+    {
+        d_previous = Receiver_State::bound_state().get();
+        Receiver_State::bound_state().reset(d_state.get());
+    }
+
+    ~Receiver_State_Scope()
+    {
+        Receiver_State::bound_state().reset(d_previous);
+    }
+
+private:
+    Receiver_State_Scope(const Receiver_State_Scope&);
+    Receiver_State_Scope& operator=(const Receiver_State_Scope&);
+
+    std::shared_ptr<Receiver_State> d_state;
+    Receiver_State* d_previous;
+};
+
+#endif
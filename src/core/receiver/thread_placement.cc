@@ -0,0 +1,141 @@
+/*!
+ * \file thread_placement.cc
+ * \brief Placement of the threads of the receiver on the CPUs
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "thread_placement.h"
+#include <pthread.h>
+#include <sched.h>
+#include <boost/lexical_cast.hpp>
+#include <boost/tokenizer.hpp>
+#include <glog/logging.h>
+#include <gnuradio/block.h>
+
+using google::LogMessage;
+
+
+std::vector<int> parse_cpu_list(const std::string& cpus)
+{
+    std::vector<int> list;
+    boost::char_separator<char> separator(", ");
+    boost::tokenizer<boost::char_separator<char>> tokens(cpus, separator);
+    try
+    {
+            for (boost::tokenizer<boost::char_separator<char>>::iterator it = tokens.begin(); it != tokens.end(); ++it)
+                {
+                    std::string::size_type dash = it->find('-');
+                    if (dash == std::string::npos)
+                        {
+                            list.push_back(boost::lexical_cast<int>(*it));
+                            continue;
+                        }
+                    int first = boost::lexical_cast<int>(it->substr(0, dash));
+                    int last = boost::lexical_cast<int>(it->substr(dash + 1));
+                    for (int cpu = first; cpu <= last; cpu++)
+                        {
+                            list.push_back(cpu);
+                        }
+                }
+    }
+    catch (const boost::bad_lexical_cast& e)
+    {
+            LOG(WARNING) << "Invalid list of CPUs \"" << cpus << "\", the threads are not placed";
+            list.clear();
+    }
+    for (unsigned int i = 0; i < list.size(); i++)
+        {
+            if (list.at(i) < 0 || list.at(i) >= CPU_SETSIZE)
+                {
+                    LOG(WARNING) << "Invalid CPU " << list.at(i) << " in \"" << cpus << "\", the threads are not placed";
+                    list.clear();
+                }
+        }
+    return list;
+}
+
+
+bool set_current_thread_affinity(const std::vector<int>& cpus)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned int i = 0; i < cpus.size(); i++)
+        {
+            CPU_SET(cpus.at(i), &set);
+        }
+    int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (error != 0)
+        {
+            LOG(WARNING) << "Unable to set the CPU affinity of the thread, error " << error;
+            return false;
+        }
+    return true;
+}
+
+
+std::vector<int> current_thread_affinity()
+{
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0)
+        {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+                {
+                    if (CPU_ISSET(cpu, &set))
+                        {
+                            cpus.push_back(cpu);
+                        }
+                }
+        }
+    return cpus;
+}
+
+
+bool place_block(gr::basic_block_sptr block, const std::vector<int>& cpus, int priority)
+{
+    gr::block_sptr gr_block = boost::dynamic_pointer_cast<gr::block>(block);
+    if (!gr_block)
+        {
+            return false;
+        }
+    if (!cpus.empty())
+        {
+            gr_block->set_processor_affinity(cpus);
+        }
+    if (priority > 0)
+        {
+#if GNURADIO_THREAD_PRIORITY
+            // SCHED_FIFO, which needs CAP_SYS_NICE or an rtprio limit, or GNU Radio logs the failure
+            gr_block->set_thread_priority(priority);
+#else
+            LOG(WARNING) << "This GNU Radio version does not set the priority of the block threads";
+#endif
+        }
+    return true;
+}
@@ -0,0 +1,64 @@
+/*!
+ * \file thread_placement.h
+ * \brief Placement of the threads of the receiver on the CPUs
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_THREAD_PLACEMENT_H_
+#define GNSS_SDR_THREAD_PLACEMENT_H_
+
+#include <string>
+#include <vector>
+#include <gnuradio/basic_block.h>
+
+/*!
+ * \brief CPUs of a list such as "0,2,4-7". An empty list, or an invalid
+ * one (which is logged), gives no CPU: the thread is not placed.
+ */
+std::vector<int> parse_cpu_list(const std::string& cpus);
+
+/*!
+ * \brief Pins the calling thread to the CPUs. The threads it creates
+ * afterwards start on them too.
+ * \return false if the CPUs are not valid for the process
+ */
+bool set_current_thread_affinity(const std::vector<int>& cpus);
+
+/*!
+ * \brief The CPUs the calling thread may run on
+ */
+std::vector<int> current_thread_affinity();
+
+/*!
+ * \brief Runs the thread of the block on the CPUs, if any, and with the
+ * SCHED_FIFO priority, if not 0. Both apply when the flowgraph starts.
+ * Hierarchical blocks are left as they are.
+ * \return false if it is not a gr::block
+ */
+bool place_block(gr::basic_block_sptr block, const std::vector<int>& cpus, int priority);
+
+#endif
@@ -84,6 +84,7 @@ const int GPS_SUBFRAME_BITS = 300;                  //!< Number of bits per subf
 const int GPS_SUBFRAME_SECONDS = 6;                 //!< Subframe duration [seconds]
 const int GPS_SUBFRAME_MS = 6000;                 //!< Subframe duration [seconds]
 const int GPS_WORD_BITS = 30;                       //!< Number of bits per word in the NAV message [bits]
+const int GPS_SUBFRAME_WORDS = 10;                  //!< Number of words per subframe in the NAV message
 
 // GPS NAVIGATION MESSAGE STRUCTURE
 // NAVIGATION MESSAGE FIELDS POSITIONS (from IS-GPS-200E Appendix II)
@@ -0,0 +1,61 @@
+/*!
+ * \file acquired_peaks.h
+ * \brief Ranked correlation peaks of an acquisition search
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_ACQUIRED_PEAKS_H_
+#define GNSS_SDR_ACQUIRED_PEAKS_H_
+
+#include <vector>
+
+/*!
+ * \brief One correlation peak of the acquisition search grid.
+ */
+struct Acq_Peak
+{
+    int code_phase;
+    int doppler;
+    float mag;
+};
+
+
+/*!
+ * \brief Ranked peak list of one full search of a satellite.
+ *
+ * The SD acquisition keeps the one of the last full search of each
+ * satellite in the auxiliary_peaks_map of the Receiver_State.
+ */
+struct Acquired_Peaks
+{
+    unsigned long int block_start;  //!< Sample stamp of the first searched sample [samples]
+    unsigned long int sample_stamp; //!< Acq_samplestamp_samples of the search [samples]
+    float input_power;              //!< Noise floor the peak magnitudes compare to
+    std::vector<Acq_Peak> peaks;    //!< Distinct peaks, strongest first
+};
+
+#endif
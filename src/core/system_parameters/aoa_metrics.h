@@ -0,0 +1,62 @@
+/*!
+ * \file aoa_metrics.h
+ * \brief Spatial signature of the signal of a tracking channel across the
+ * elements of an antenna array, kept aside from Gnss_Synchro
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_AOA_METRICS_H_
+#define GNSS_SDR_AOA_METRICS_H_
+
+#include <complex>
+
+//! Most antenna elements a channel correlates
+#define AOA_MAX_ELEMENTS 8
+
+/*!
+ * \brief Spatial signature of a satellite seen by an antenna array.
+ *
+ * A tracking channel fed with the streams of the array elements correlates
+ * its Prompt on each of them once every few code periods. Aoa_Monitor
+ * averages the phase and amplitude of each element relative to the first
+ * one and publishes them in Receiver_State::aoa_map, keyed by channel, once per
+ * average. steering is normalized to unit norm, with the first element
+ * real and positive, so that two satellites that arrive from the same
+ * direction have the same steering whatever their carrier phase. A reader
+ * checks PRN in case the channel has been reassigned since.
+ */
+struct Aoa_Metrics
+{
+    unsigned int PRN;                 //!< Satellite tracked when the metrics were stored
+    unsigned long int sample_counter; //!< Sample counter at the start of the last code period averaged
+    unsigned int n_elements;
+    std::complex<float> steering[AOA_MAX_ELEMENTS];
+    float coherence;                  //!< 1 if the phase differences held over the average, lower with noise
+};
+
+#endif
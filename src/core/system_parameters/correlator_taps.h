@@ -0,0 +1,58 @@
+/*!
+ * \file correlator_taps.h
+ * \brief Latest Early, Prompt and Late correlator outputs of a tracking
+ * channel, kept aside from Gnss_Synchro
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_CORRELATOR_TAPS_H_
+#define GNSS_SDR_CORRELATOR_TAPS_H_
+
+#include <gnuradio/gr_complex.h>
+
+/*!
+ * \brief Correlator outputs of the last integration period of a channel.
+ *
+ * Gnss_Synchro is copied through every buffer of the flowgraph, so it only
+ * carries what tracking, telemetry, observables and PVT all use. The
+ * tracking blocks publish these taps in Receiver_State::correlator_taps_map, keyed
+ * by channel, for the few consumers that need them (the PPE spoofing
+ * check, see Spoofing_Detector::PPE_moving_var). A reader gets the latest
+ * period of the channel, and checks PRN in case the channel has been
+ * reassigned since.
+ */
+struct Correlator_Taps
+{
+    unsigned int PRN;                 //!< Satellite tracked when the taps were stored
+    unsigned long int sample_counter; //!< Sample counter at the start of the integration period
+    gr_complex Early;
+    gr_complex Prompt;
+    gr_complex Late;
+};
+
+#endif
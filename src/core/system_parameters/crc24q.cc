@@ -0,0 +1,108 @@
+/*!
+ * \file crc24q.cc
+ * \brief Slice-by-8 implementation of the CRC-24Q
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "crc24q.h"
+#include <cstdint>
+
+
+namespace
+{
+/*
+ * entry[0] is the usual bytewise table, and entry[k][i] is the CRC of byte i
+ * followed by k zero bytes. The CRCs are kept in the 24 most significant
+ * bits of the 32 bit words, so that four message bytes are xored into the
+ * register at once.
+ */
+struct Crc24q_Tables
+{
+    uint32_t entry[8][256];
+    Crc24q_Tables()
+    {
+        for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t crc = i << 24;
+                for (int b = 0; b < 8; b++)
+                    {
+                        crc = (crc & 0x80000000) ? (crc << 1) ^ 0x864CFB00 : crc << 1;
+                    }
+                entry[0][i] = crc;
+            }
+        for (int k = 1; k < 8; k++)
+            {
+                for (uint32_t i = 0; i < 256; i++)
+                    {
+                        uint32_t crc = entry[k - 1][i];
+                        entry[k][i] = (crc << 8) ^ entry[0][crc >> 24];
+                    }
+            }
+    }
+};
+
+const Crc24q_Tables tables;
+
+inline uint32_t load_be32(const unsigned char* p)
+{
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+}
+
+
+void Crc24q::process_bytes(const unsigned char* data, std::size_t n_bytes)
+{
+    const uint32_t (*t)[256] = tables.entry;
+    uint32_t crc = d_crc << 8;
+    for (; n_bytes >= 8; n_bytes -= 8, data += 8)
+        {
+            uint32_t a = crc ^ load_be32(data);
+            uint32_t b = load_be32(data + 4);
+            crc = t[7][a >> 24] ^ t[6][(a >> 16) & 0xFF] ^ t[5][(a >> 8) & 0xFF] ^ t[4][a & 0xFF]
+                ^ t[3][b >> 24] ^ t[2][(b >> 16) & 0xFF] ^ t[1][(b >> 8) & 0xFF] ^ t[0][b & 0xFF];
+        }
+    for (; n_bytes > 0; n_bytes--, data++)
+        {
+            crc = (crc << 8) ^ t[0][(crc >> 24) ^ *data];
+        }
+    d_crc = crc >> 8;
+}
+
+
+void Crc24q::process_bits(unsigned long long value, unsigned int n_bits)
+{
+    while (n_bits > 0)
+        {
+            n_bits--;
+            unsigned int feedback = ((d_crc >> 23) ^ static_cast<unsigned int>(value >> n_bits)) & 1;
+            d_crc = (d_crc << 1) & 0xFFFFFF;
+            if (feedback)
+                {
+                    d_crc ^= 0x864CFB;
+                }
+        }
+}
@@ -0,0 +1,113 @@
+/*!
+ * \file crc24q.h
+ * \brief Qualcomm CRC-24Q of the Galileo I/NAV and F/NAV pages, the GPS CNAV
+ * and SBAS messages and the RTCM 3 frames
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_CRC24Q_H_
+#define GNSS_SDR_CRC24Q_H_
+
+#include <bitset>
+#include <cstddef>
+
+/*!
+ * \brief Incremental CRC-24Q (polynomial 0x1864CFB, zero initial value and
+ * no reflection), over packed bytes and bit fields, most significant bit
+ * first
+ *
+ * Bytes are processed eight at a time with eight 256-entry tables
+ * (slice-by-8), so checking a navigation page costs a few dozen table
+ * lookups. A frame whose length is not a multiple of eight bits starts with
+ * process_bits() for its leading bits, which is the same as padding it with
+ * zeros in front. The CRC of a message followed by its parity is zero.
+ */
+class Crc24q
+{
+public:
+    Crc24q() : d_crc(0) {}
+
+    void reset() { d_crc = 0; }
+
+    void process_bytes(const unsigned char* data, std::size_t n_bytes);
+
+    /*!
+     * \brief Processes the n_bits (up to 64) least significant bits of value
+     */
+    void process_bits(unsigned long long value, unsigned int n_bits);
+
+    /*!
+     * \brief Processes a whole bitset, bit N - 1 first
+     */
+    template<std::size_t N>
+    void process_bits(const std::bitset<N>& bits)
+    {
+        const std::size_t head = N % 8;
+        unsigned long long value = 0;
+        for (std::size_t i = 0; i < head; i++)
+            {
+                value = (value << 1) | bits[N - 1 - i];
+            }
+        process_bits(value, head);
+        unsigned char bytes[N / 8 + 1];
+        for (std::size_t k = 0; k < N / 8; k++)
+            {
+                std::size_t msb = N - 1 - head - 8 * k;
+                unsigned char byte = 0;
+                for (std::size_t i = 0; i < 8; i++)
+                    {
+                        byte = (byte << 1) | bits[msb - i];
+                    }
+                bytes[k] = byte;
+            }
+        process_bytes(bytes, N / 8);
+    }
+
+    unsigned int checksum() const { return d_crc; }
+
+private:
+    unsigned int d_crc;
+};
+
+
+inline unsigned int crc24q(const unsigned char* data, std::size_t n_bytes)
+{
+    Crc24q crc;
+    crc.process_bytes(data, n_bytes);
+    return crc.checksum();
+}
+
+
+template<std::size_t N>
+unsigned int crc24q(const std::bitset<N>& bits)
+{
+    Crc24q crc;
+    crc.process_bits(bits);
+    return crc.checksum();
+}
+
+#endif
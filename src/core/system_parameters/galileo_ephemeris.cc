@@ -87,6 +87,10 @@ Galileo_Ephemeris::Galileo_Ephemeris()
     d_satvel_Z = 0.0;
 
     i_satellite_PRN = 0;
+
+    d_kepler_M = 0.0;
+    d_kepler_E = 0.0;
+    d_kepler_valid = false;
 }
 
 
@@ -137,6 +141,45 @@ double Galileo_Ephemeris::sv_clock_drift(double transmitTime)
 }
 
 
+double Galileo_Ephemeris::eccentric_anomaly(double M)
+{
+    // Solve Kepler's equation M = E - e sin(E) by Newton iterations. Between
+    // two calls (the clock correction and the orbit of the same epoch, or two
+    // consecutive epochs) M only moves by the mean motion times the time
+    // step, so the previous solution, advanced to first order, usually
+    // converges in a single step.
+    double E;
+    double dE;
+    if (d_kepler_valid)
+        {
+            double dM = M - d_kepler_M;
+            if (dM > GALILEO_PI) dM -= 2.0 * GALILEO_PI;
+            if (dM < -GALILEO_PI) dM += 2.0 * GALILEO_PI;
+            // keep E next to M, also when M wraps around 2pi
+            double e_cos_E = e_1 * cos(d_kepler_E);
+            E = M + (d_kepler_E - d_kepler_M) + dM * e_cos_E / (1.0 - e_cos_E);
+        }
+    else
+        {
+            E = M;
+        }
+    for (int ii = 1; ii < 20; ii++)
+        {
+            dE = (E - e_1 * sin(E) - M) / (1.0 - e_1 * cos(E));
+            E -= dE;
+            if (fabs(dE) < 1e-12)
+                {
+                    //Necessary precision is reached, exit from the loop
+                    break;
+                }
+        }
+    d_kepler_M = M;
+    d_kepler_E = E;
+    d_kepler_valid = true;
+    return E;
+}
+
+
 // compute the relativistic correction term
 double Galileo_Ephemeris::sv_clock_relativistic_term(double transmitTime) // Satellite Time Correction Algorithm, ICD 5.1.4
 {
@@ -145,8 +188,6 @@ double Galileo_Ephemeris::sv_clock_relativistic_term(double transmitTime) // Sat
     double n;
     double n0;
     double E;
-    double E_old;
-    double dE;
     double M;
 
     // Restore semi-major axis
@@ -167,21 +208,8 @@ double Galileo_Ephemeris::sv_clock_relativistic_term(double transmitTime) // Sat
     // Reduce mean anomaly to between 0 and 2pi
     M = fmod((M + 2*GALILEO_PI), (2*GALILEO_PI));
 
-    // Initial guess of eccentric anomaly
-    E = M;
-
-    // --- Iteratively compute eccentric anomaly ----------------------------
-    for (int ii = 1; ii < 20; ii++)
-        {
-            E_old   = E;
-            E       = M + e_1 * sin(E);
-            dE      = fmod(E - E_old, 2*GALILEO_PI);
-            if (fabs(dE) < 1e-12)
-                {
-                    //Necessary precision is reached, exit from the loop
-                    break;
-                }
-        }
+    // Eccentric anomaly, warm-started from the previous evaluation
+    E = eccentric_anomaly(M);
 
     // Compute relativistic correction term
     Galileo_dtr = GALILEO_F * e_1* A_1 * sin(E);
@@ -199,8 +227,6 @@ void Galileo_Ephemeris::satellitePosition(double transmitTime)
     double n0;   // Computed mean motion
     double M;    // Mean anomaly
     double E;    // Eccentric Anomaly (to be solved by iteration)
-    double E_old;
-    double dE;
     double nu;   // True anomaly
     double phi;  // Argument of Latitude
     double u;    // Correct argument of latitude
@@ -228,21 +254,8 @@ void Galileo_Ephemeris::satellitePosition(double transmitTime)
     // Reduce mean anomaly to between 0 and 2pi
     M = fmod((M + 2* GALILEO_PI), (2* GALILEO_PI));
 
-    // Initial guess of eccentric anomaly
-    E = M;
-
-    // --- Iteratively compute eccentric anomaly ----------------------------
-    for (int ii = 1; ii<20; ii++)
-        {
-            E_old   = E;
-            E       = M + e_1 * sin(E);
-            dE      = fmod(E - E_old, 2*GALILEO_PI);
-            if (fabs(dE) < 1e-12)
-                {
-                    //Necessary precision is reached, exit from the loop
-                    break;
-                }
-        }
+    // Eccentric anomaly, warm-started from the previous evaluation
+    E = eccentric_anomaly(M);
 
     // Compute the true anomaly
 
@@ -141,6 +141,17 @@ public:
         archive & make_nvp("af1_4", af1_4);
         archive & make_nvp("af2_4", af2_4);
     }
+
+private:
+    /*
+     * Eccentric anomaly [rad] for the mean anomaly M [rad], warm-started
+     * from the solution of the previous call
+     */
+    double eccentric_anomaly(double M);
+
+    double d_kepler_M;     // mean anomaly of the last eccentric_anomaly() call [rad]
+    double d_kepler_E;     // its eccentric anomaly [rad]
+    bool d_kepler_valid;
 };
 
 #endif
@@ -35,14 +35,11 @@
  */
 
 #include "galileo_fnav_message.h"
-#include <boost/crc.hpp>      // for boost::crc_basic, boost::crc_optimal
-#include <boost/dynamic_bitset.hpp>
 #include <glog/logging.h>
 #include <iostream>
+#include "crc24q.h"
 
 
-typedef boost::crc_optimal<24, 0x1864CFBu, 0x0, 0x0, false, false> CRC_Galileo_FNAV_type;
-
 void Galileo_Fnav_Message::reset()
 {
     flag_CRC_test = false;
@@ -211,40 +208,17 @@ void Galileo_Fnav_Message::split_page(std::string page_string)
 }
 
 
-bool Galileo_Fnav_Message::_CRC_test(std::bitset<GALILEO_FNAV_DATA_FRAME_BITS> bits, boost::uint32_t checksum)
+bool Galileo_Fnav_Message::_CRC_test(const std::bitset<GALILEO_FNAV_DATA_FRAME_BITS>& bits, boost::uint32_t checksum)
 {
-    CRC_Galileo_FNAV_type CRC_Galileo;
-
-    boost::uint32_t crc_computed;
-    // Galileo FNAV frame for CRC is not an integer multiple of bytes
-    // it needs to be filled with zeroes at the start of the frame.
-    // This operation is done in the transformation from bits to bytes
-    // using boost::dynamic_bitset.
-    // ToDo: Use boost::dynamic_bitset for all the bitset operations in this class
-
-    boost::dynamic_bitset<unsigned char> frame_bits(std::string(bits.to_string()));
-
-    std::vector<unsigned char> bytes;
-    boost::to_block_range(frame_bits, std::back_inserter(bytes));
-    std::reverse(bytes.begin(), bytes.end());
-
-    CRC_Galileo.process_bytes( bytes.data(), GALILEO_FNAV_DATA_FRAME_BYTES );
-
-    crc_computed = CRC_Galileo.checksum();
-    if (checksum == crc_computed)
-        {
-            return true;
-        }
-    else
-        {
-            return false;
-        }
+    // the leading bits that do not complete a byte are processed first,
+    // which is the same as padding the frame with zeros in front
+    return crc24q(bits) == checksum;
 }
 
 
 void Galileo_Fnav_Message::decode_page(std::string data)
 {
-    std::bitset<GALILEO_FNAV_DATA_FRAME_BITS> data_bits(data);
+    const Navigation_Message_Bits<GALILEO_FNAV_DATA_FRAME_BITS> data_bits(data);
     page_type = read_navigation_unsigned(data_bits, FNAV_PAGE_TYPE_bit);
     switch(page_type)
     {
@@ -409,8 +383,8 @@ void Galileo_Fnav_Message::decode_page(std::string data)
          * flag will be set to false and the data won't be recorded.*/
         std::string omega0_2 = data.substr(10, 12);
         std::string Omega0 = omega0_1 + omega0_2;
-        std::bitset<GALILEO_FNAV_DATA_FRAME_BITS> omega_bits(Omega0);
-        const std::vector<std::pair<int, int>> om_bit({{0, 12}});
+        const Navigation_Message_Bits<GALILEO_FNAV_DATA_FRAME_BITS> omega_bits(Omega0);
+        const std::vector<std::pair<int, int>> om_bit({{GALILEO_FNAV_DATA_FRAME_BITS - 15, 16}});
         FNAV_Omega0_2_6 = static_cast<double>(read_navigation_signed(omega_bits, om_bit));
         FNAV_Omega0_2_6 *= FNAV_Omega0_5_LSB;
         //
@@ -450,85 +424,18 @@ void Galileo_Fnav_Message::decode_page(std::string data)
 }
 
 
-unsigned long int Galileo_Fnav_Message::read_navigation_unsigned(std::bitset<GALILEO_FNAV_DATA_FRAME_BITS> bits, const std::vector<std::pair<int,int>> parameter)
+unsigned long int Galileo_Fnav_Message::read_navigation_unsigned(const Navigation_Message_Bits<GALILEO_FNAV_DATA_FRAME_BITS>& bits, const std::vector<std::pair<int,int>>& parameter)
 {
-    unsigned long int value = 0;
-    int num_of_slices = parameter.size();
-    for (int i=0; i<num_of_slices; i++)
-        {
-            for (int j=0; j<parameter[i].second; j++)
-                {
-                    value <<= 1; //shift left
-                    if (bits[GALILEO_FNAV_DATA_FRAME_BITS - parameter[i].first - j] == 1)
-                        {
-                            value += 1; // insert the bit
-                        }
-                }
-        }
-    return value;
+    return bits.read_unsigned(parameter);
 }
 
 
 
 
 
-signed long int Galileo_Fnav_Message::read_navigation_signed(std::bitset<GALILEO_FNAV_DATA_FRAME_BITS> bits, const std::vector<std::pair<int,int>> parameter)
+signed long int Galileo_Fnav_Message::read_navigation_signed(const Navigation_Message_Bits<GALILEO_FNAV_DATA_FRAME_BITS>& bits, const std::vector<std::pair<int,int>>& parameter)
 {
-    signed long int value = 0;
-    int num_of_slices = parameter.size();
-    // Discriminate between 64 bits and 32 bits compiler
-    int long_int_size_bytes = sizeof(signed long int);
-    if (long_int_size_bytes == 8) // if a long int takes 8 bytes, we are in a 64 bits system
-        {
-            // read the MSB and perform the sign extension
-            if (bits[GALILEO_FNAV_DATA_FRAME_BITS - parameter[0].first] == 1)
-                {
-                    value ^= 0xFFFFFFFFFFFFFFFF; //64 bits variable
-                }
-            else
-                {
-                    value &= 0;
-                }
-
-            for (int i=0; i<num_of_slices; i++)
-                {
-                    for (int j=0; j<parameter[i].second; j++)
-                        {
-                            value <<= 1; //shift left
-                            value &= 0xFFFFFFFFFFFFFFFE; //reset the corresponding bit (for the 64 bits variable)
-                            if (bits[GALILEO_FNAV_DATA_FRAME_BITS - parameter[i].first - j] == 1)
-                                {
-                                    value += 1; // insert the bit
-                                }
-                        }
-                }
-        }
-    else  // we assume we are in a 32 bits system
-        {
-            // read the MSB and perform the sign extension
-            if (bits[GALILEO_FNAV_DATA_FRAME_BITS - parameter[0].first] == 1)
-                {
-                    value ^= 0xFFFFFFFF;
-                }
-            else
-                {
-                    value &= 0;
-                }
-
-            for (int i=0; i<num_of_slices; i++)
-                {
-                    for (int j=0; j<parameter[i].second; j++)
-                        {
-                            value <<= 1; //shift left
-                            value &= 0xFFFFFFFE; //reset the corresponding bit
-                            if (bits[GALILEO_FNAV_DATA_FRAME_BITS - parameter[i].first - j] == 1)
-                                {
-                                    value += 1; // insert the bit
-                                }
-                        }
-                }
-        }
-    return value;
+    return bits.read_signed(parameter);
 }
 
 
@@ -48,6 +48,7 @@
 #include "galileo_almanac.h"
 #include "galileo_utc_model.h"
 #include "Galileo_E5a.h"
+#include "navigation_message_bits.h"
 
 /*!
  * \brief This class handles the Galileo F/NAV Data message, as described in the
@@ -212,10 +213,10 @@ public:
 
 
 private:
-    bool _CRC_test(std::bitset<GALILEO_FNAV_DATA_FRAME_BITS> bits,boost::uint32_t checksum);
+    bool _CRC_test(const std::bitset<GALILEO_FNAV_DATA_FRAME_BITS>& bits, boost::uint32_t checksum);
     void decode_page(std::string data);
-    unsigned long int read_navigation_unsigned(std::bitset<GALILEO_FNAV_DATA_FRAME_BITS> bits, const std::vector<std::pair<int,int>> parameter);
-    signed long int read_navigation_signed(std::bitset<GALILEO_FNAV_DATA_FRAME_BITS> bits, const std::vector<std::pair<int,int>> parameter);
+    unsigned long int read_navigation_unsigned(const Navigation_Message_Bits<GALILEO_FNAV_DATA_FRAME_BITS>& bits, const std::vector<std::pair<int,int>>& parameter);
+    signed long int read_navigation_signed(const Navigation_Message_Bits<GALILEO_FNAV_DATA_FRAME_BITS>& bits, const std::vector<std::pair<int,int>>& parameter);
 
     std::string omega0_1;
     //std::string omega0_2;
@@ -31,13 +31,9 @@
  */
 
 #include "galileo_navigation_message.h"
-#include <boost/crc.hpp>      // for boost::crc_basic, boost::crc_optimal
-#include <boost/dynamic_bitset.hpp>
 #include <glog/logging.h>
 #include <iostream>
-
-
-typedef boost::crc_optimal<24, 0x1864CFBu, 0x0, 0x0, false, false> CRC_Galileo_INAV_type;
+#include "crc24q.h"
 
 
 void Galileo_Navigation_Message::reset()
@@ -228,149 +224,37 @@ Galileo_Navigation_Message::Galileo_Navigation_Message()
 }
 
 
-bool Galileo_Navigation_Message::CRC_test(std::bitset<GALILEO_DATA_FRAME_BITS> bits,boost::uint32_t checksum)
+bool Galileo_Navigation_Message::CRC_test(const std::bitset<GALILEO_DATA_FRAME_BITS>& bits, boost::uint32_t checksum)
 {
-    CRC_Galileo_INAV_type CRC_Galileo;
-
-    boost::uint32_t crc_computed;
-    // Galileo INAV frame for CRC is not an integer multiple of bytes
-    // it needs to be filled with zeroes at the start of the frame.
-    // This operation is done in the transformation from bits to bytes
-    // using boost::dynamic_bitset.
-    // ToDo: Use boost::dynamic_bitset for all the bitset operations in this class
-
-    boost::dynamic_bitset<unsigned char> frame_bits(std::string(bits.to_string()));
-
-    std::vector<unsigned char> bytes;
-    boost::to_block_range(frame_bits, std::back_inserter(bytes));
-    std::reverse(bytes.begin(),bytes.end());
-
-    CRC_Galileo.process_bytes( bytes.data(), GALILEO_DATA_FRAME_BYTES );
-
-    crc_computed = CRC_Galileo.checksum();
-    if (checksum == crc_computed)
-        {
-            return true;
-        }
-    else
-        {
-            return false;
-        }
+    // the leading bits that do not complete a byte are processed first,
+    // which is the same as padding the frame with zeros in front
+    return crc24q(bits) == checksum;
 }
 
 
-unsigned long int Galileo_Navigation_Message::read_navigation_unsigned(std::bitset<GALILEO_DATA_JK_BITS> bits, const std::vector<std::pair<int,int> > parameter)
+unsigned long int Galileo_Navigation_Message::read_navigation_unsigned(const Navigation_Message_Bits<GALILEO_DATA_JK_BITS>& bits, const std::vector<std::pair<int,int>>& parameter)
 {
-    unsigned long int value = 0;
-    int num_of_slices = parameter.size();
-    for (int i = 0; i < num_of_slices; i++)
-        {
-            for (int j = 0; j < parameter[i].second; j++)
-                {
-                    value <<= 1; //shift left
-                    if (bits[GALILEO_DATA_JK_BITS - parameter[i].first - j] == 1)
-                        {
-                            value += 1; // insert the bit
-                        }
-                }
-        }
-    return value;
+    return bits.read_unsigned(parameter);
 }
 
 
 
-unsigned long int Galileo_Navigation_Message::read_page_type_unsigned(std::bitset<GALILEO_PAGE_TYPE_BITS> bits, const std::vector<std::pair<int,int> > parameter)
+unsigned long int Galileo_Navigation_Message::read_page_type_unsigned(const Navigation_Message_Bits<GALILEO_PAGE_TYPE_BITS>& bits, const std::vector<std::pair<int,int>>& parameter)
 {
-    unsigned long int value = 0;
-    int num_of_slices = parameter.size();
-    for (int i = 0; i < num_of_slices; i++)
-        {
-            for (int j = 0; j < parameter[i].second; j++)
-                {
-                    value <<= 1; //shift left
-                    if (bits[GALILEO_PAGE_TYPE_BITS - parameter[i].first - j] == 1)
-                        {
-                            value += 1; // insert the bit
-                        }
-                }
-        }
-    return value;
+    return bits.read_unsigned(parameter);
 }
 
 
 
-signed long int Galileo_Navigation_Message::read_navigation_signed(std::bitset<GALILEO_DATA_JK_BITS> bits, const std::vector<std::pair<int,int> > parameter)
+signed long int Galileo_Navigation_Message::read_navigation_signed(const Navigation_Message_Bits<GALILEO_DATA_JK_BITS>& bits, const std::vector<std::pair<int,int>>& parameter)
 {
-    signed long int value = 0;
-    int num_of_slices = parameter.size();
-    // Discriminate between 64 bits and 32 bits compiler
-    int long_int_size_bytes = sizeof(signed long int);
-    if (long_int_size_bytes == 8) // if a long int takes 8 bytes, we are in a 64 bits system
-        {
-            // read the MSB and perform the sign extension
-            if (bits[GALILEO_DATA_JK_BITS - parameter[0].first] == 1)
-                {
-                    value ^= 0xFFFFFFFFFFFFFFFF; //64 bits variable
-                }
-            else
-                {
-                    value &= 0;
-                }
-
-            for (int i = 0; i < num_of_slices; i++)
-                {
-                    for (int j = 0; j < parameter[i].second; j++)
-                        {
-                            value <<= 1; //shift left
-                            value &= 0xFFFFFFFFFFFFFFFE; //reset the corresponding bit (for the 64 bits variable)
-                            if (bits[GALILEO_DATA_JK_BITS - parameter[i].first - j] == 1)
-                                {
-                                    value += 1; // insert the bit
-                                }
-                        }
-                }
-        }
-    else  // we assume we are in a 32 bits system
-        {
-            // read the MSB and perform the sign extension
-            if (bits[GALILEO_DATA_JK_BITS - parameter[0].first] == 1)
-                {
-                    value ^= 0xFFFFFFFF;
-                }
-            else
-                {
-                    value &= 0;
-                }
-
-            for (int i = 0; i < num_of_slices; i++)
-                {
-                    for (int j = 0; j < parameter[i].second; j++)
-                        {
-                            value <<= 1; //shift left
-                            value &= 0xFFFFFFFE; //reset the corresponding bit
-                            if (bits[GALILEO_DATA_JK_BITS - parameter[i].first - j] == 1)
-                                {
-                                    value += 1; // insert the bit
-                                }
-                        }
-                }
-        }
-    return value;
+    return bits.read_signed(parameter);
 }
 
 
-bool Galileo_Navigation_Message::read_navigation_bool(std::bitset<GALILEO_DATA_JK_BITS> bits, const std::vector<std::pair<int,int> > parameter)
+bool Galileo_Navigation_Message::read_navigation_bool(const Navigation_Message_Bits<GALILEO_DATA_JK_BITS>& bits, const std::vector<std::pair<int,int>>& parameter)
 {
-    bool value;
-    if (bits[GALILEO_DATA_JK_BITS - parameter[0].first] == 1)
-        {
-            value = true;
-        }
-    else
-        {
-            value = false;
-        }
-    return value;
+    return bits.read_bool(parameter);
 }
 
 
@@ -416,11 +300,7 @@ void Galileo_Navigation_Message::split_page(std::string page_string, int flag_ev
                     std::string Tail_odd = page_INAV.substr (228,6);
 
                     //************ CRC checksum control *******/
-                    std::stringstream TLM_word_for_CRC_stream;
-                    TLM_word_for_CRC_stream << page_INAV;
-                    std::string TLM_word_for_CRC;
-                    TLM_word_for_CRC = TLM_word_for_CRC_stream.str().substr(0, GALILEO_DATA_FRAME_BITS);
-                    std::bitset<GALILEO_DATA_FRAME_BITS> TLM_word_for_CRC_bits(TLM_word_for_CRC);
+                    std::bitset<GALILEO_DATA_FRAME_BITS> TLM_word_for_CRC_bits(page_INAV, 0, GALILEO_DATA_FRAME_BITS);
                     std::bitset<24> checksum(CRC_data);
 
                     //if (Tail_odd.compare(correct_tail) != 0)
@@ -432,10 +312,11 @@ void Galileo_Navigation_Message::split_page(std::string page_string, int flag_ev
                             flag_CRC_test = true;
                             // CRC correct: Decode word
                             std::string page_number_bits = Data_k.substr (0,6);
-                            std::bitset<GALILEO_PAGE_TYPE_BITS> page_type_bits (page_number_bits); // from string to bitset
+                            const Navigation_Message_Bits<GALILEO_PAGE_TYPE_BITS> page_type_bits(page_number_bits);
                             Page_type = static_cast<int>(read_page_type_unsigned(page_type_bits, type));
                             Page_type_time_stamp = Page_type;
                             std::string Data_jk_ephemeris = Data_k + Data_j;
+                            word_jk = Data_jk_ephemeris;
                             page_jk_decoder(Data_jk_ephemeris.c_str());
                         }
                     else
@@ -689,7 +570,7 @@ int Galileo_Navigation_Message::page_jk_decoder(const char *data_jk)
     int page_number = 0;
 
     std::string data_jk_string = data_jk;
-    std::bitset<GALILEO_DATA_JK_BITS> data_jk_bits (data_jk_string);
+    const Navigation_Message_Bits<GALILEO_DATA_JK_BITS> data_jk_bits(data_jk_string);
     //DLOG(INFO) << "Data_jk_bits (bitset)  "<< endl << data_jk_bits << endl;
 
     page_number = static_cast<int>(read_navigation_unsigned(data_jk_bits, PAGE_TYPE_bit));
@@ -44,6 +44,7 @@
 #include "galileo_almanac.h"
 #include "galileo_utc_model.h"
 #include "Galileo_E1.h"
+#include "navigation_message_bits.h"
 
 /*!
  * \brief This class handles the Galileo I/NAV Data message, as described in the
@@ -53,16 +54,17 @@
 class Galileo_Navigation_Message
 {
 private:
-    bool CRC_test(std::bitset<GALILEO_DATA_FRAME_BITS> bits, boost::uint32_t checksum);
-    bool read_navigation_bool(std::bitset<GALILEO_DATA_JK_BITS> bits, const std::vector<std::pair<int,int> > parameter);
+    bool CRC_test(const std::bitset<GALILEO_DATA_FRAME_BITS>& bits, boost::uint32_t checksum);
+    bool read_navigation_bool(const Navigation_Message_Bits<GALILEO_DATA_JK_BITS>& bits, const std::vector<std::pair<int,int>>& parameter);
     //void print_galileo_word_bytes(unsigned int GPS_word);
-    unsigned long int read_navigation_unsigned(std::bitset<GALILEO_DATA_JK_BITS> bits, const std::vector< std::pair<int,int> > parameter);
-    unsigned long int read_page_type_unsigned(std::bitset<GALILEO_PAGE_TYPE_BITS> bits, const std::vector< std::pair<int,int> > parameter);
-    signed long int read_navigation_signed(std::bitset<GALILEO_DATA_JK_BITS> bits, const std::vector<std::pair<int,int> > parameter);
+    unsigned long int read_navigation_unsigned(const Navigation_Message_Bits<GALILEO_DATA_JK_BITS>& bits, const std::vector<std::pair<int,int>>& parameter);
+    unsigned long int read_page_type_unsigned(const Navigation_Message_Bits<GALILEO_PAGE_TYPE_BITS>& bits, const std::vector<std::pair<int,int>>& parameter);
+    signed long int read_navigation_signed(const Navigation_Message_Bits<GALILEO_DATA_JK_BITS>& bits, const std::vector<std::pair<int,int>>& parameter);
 public:
     int Page_type_time_stamp;
     int flag_even_word;
     std::string page_Even;
+    std::string word_jk;      //!< Data bits (Data_k + Data_j) of the last word that passed the CRC
     bool flag_CRC_test;
     bool flag_all_ephemeris;  //!< Flag indicating that all words containing ephemeris have been received
     bool flag_ephemeris_1;    //!< Flag indicating that ephemeris 1/4 (word 1) have been received
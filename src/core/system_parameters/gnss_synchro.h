@@ -40,6 +40,10 @@
 /*!
  * \brief This is the class that contains the information that is shared
  * by the processing blocks.
+ *
+ * It is copied through every buffer of the flowgraph, so keep it to the
+ * fields the processing chain needs. The correlator taps are published
+ * aside, see Correlator_Taps.
  */
 class  Gnss_Synchro
 {
@@ -54,21 +58,17 @@ public:
     double Acq_doppler_hz;                     //!< Set by Acquisition processing block
     unsigned long int Acq_samplestamp_samples; //!< Set by Acquisition processing block
     bool Flag_valid_acquisition; //!< Set by Acquisition processing block
-    //Tracking
-    double Prompt_I;                //!< Set by Tracking processing block
-    double Prompt_Q;                //!< Set by Tracking processing block
-    double Early_I;                //!< Set by Tracking processing block
-    double Early_Q;                //!< Set by Tracking processing block
-    double Late_I;                //!< Set by Tracking processing block
-    double Late_Q;                //!< Set by Tracking processing block
-    double CN0_dB_hz;               //!< Set by Tracking processing block
+    //Tracking: the correlator outputs and the CN0 in single precision, the NCO phases in double
+    float Prompt_I;                 //!< Set by Tracking processing block
+    float Prompt_Q;                 //!< Set by Tracking processing block
+    float CN0_dB_hz;                //!< Set by Tracking processing block
+    int correlation_length_ms;      //!< Set by Tracking processing block
     double Carrier_Doppler_hz;      //!< Set by Tracking processing block
     double Carrier_phase_rads;      //!< Set by Tracking processing block
     double Code_phase_secs;         //!< Set by Tracking processing block
     double Tracking_timestamp_secs; //!< Set by Tracking processing block
 
     bool Flag_valid_symbol_output; //!< Set by Tracking processing block
-    int correlation_length_ms; //!< Set by Tracking processing block
 
     //Telemetry Decoder
     double Prn_timestamp_ms;             //!< Set by Telemetry Decoder processing block
@@ -88,19 +88,31 @@ public:
     //spoofing detection
     unsigned int peak;
     unsigned int uid;
-    
-    //vestigial
-    float delta;
-    float RT;
-    float Extra_RT;
-    float ELP;
-    float MD;
-    gr_complex* Early;
-    gr_complex* Prompt;
-    gr_complex* Late;
-    
-    unsigned long int sample_counter;
+
+    unsigned long int sample_counter; //!< Set by Tracking processing block
 };
 
+
+/*!
+ * \brief True for the output of a channel that tracks no satellite, a
+ * zeroed Gnss_Synchro (PRN 0). Idle tracking blocks emit these in bulk, and
+ * the blocks downstream pass them on without processing them.
+ */
+inline bool dormant_synchro(const Gnss_Synchro& synchro)
+{
+    return synchro.PRN == 0;
+}
+
+
+/*!
+ * \brief Key of the last in-lock tracking state of a satellite peak in
+ * Receiver_State::gps_reacquisition_map. Peaks 0 (no SPREE) and 1 are both the
+ * strongest one.
+ */
+inline int reacquisition_key(unsigned int PRN, unsigned int peak)
+{
+    return 10 * PRN + (peak > 1 ? peak : 1);
+}
+
 #endif
 
@@ -42,6 +42,7 @@
 #include "gps_cnav_ephemeris.h"
 #include "gps_cnav_iono.h"
 #include "gps_cnav_utc_model.h"
+#include "navigation_message_bits.h"
 //TODO: Create GPS CNAV almanac
 //#include "gps_almanac.h"
 
@@ -55,9 +56,9 @@
 class Gps_CNAV_Navigation_Message
 {
 private:
-    unsigned long int read_navigation_unsigned(std::bitset<GPS_L2_CNAV_DATA_PAGE_BITS> bits, const std::vector<std::pair<int,int>> parameter);
-    signed long int read_navigation_signed(std::bitset<GPS_L2_CNAV_DATA_PAGE_BITS> bits, const std::vector<std::pair<int,int>> parameter);
-    bool read_navigation_bool(std::bitset<GPS_L2_CNAV_DATA_PAGE_BITS> bits, const std::vector<std::pair<int,int>> parameter);
+    unsigned long int read_navigation_unsigned(const Navigation_Message_Bits<GPS_L2_CNAV_DATA_PAGE_BITS>& bits, const std::vector<std::pair<int,int>>& parameter);
+    signed long int read_navigation_signed(const Navigation_Message_Bits<GPS_L2_CNAV_DATA_PAGE_BITS>& bits, const std::vector<std::pair<int,int>>& parameter);
+    bool read_navigation_bool(const Navigation_Message_Bits<GPS_L2_CNAV_DATA_PAGE_BITS>& bits, const std::vector<std::pair<int,int>>& parameter);
     void print_gps_word_bytes(unsigned int GPS_word);
 
     Gps_CNAV_Ephemeris ephemeris_record;
@@ -96,6 +96,9 @@ Gps_Ephemeris::Gps_Ephemeris()
     d_satvel_X = 0.0;
     d_satvel_Y = 0.0;
     d_satvel_Z = 0.0;
+    d_kepler_M = 0.0;
+    d_kepler_E = 0.0;
+    d_kepler_valid = false;
 }
 
 
@@ -116,6 +119,45 @@ double Gps_Ephemeris::check_t(double time)
 }
 
 
+double Gps_Ephemeris::eccentric_anomaly(double M)
+{
+    // Solve Kepler's equation M = E - e sin(E) by Newton iterations. Between
+    // two calls (the clock correction and the orbit of the same epoch, or two
+    // consecutive epochs) M only moves by the mean motion times the time
+    // step, so the previous solution, advanced to first order, usually
+    // converges in a single step.
+    double E;
+    double dE;
+    if (d_kepler_valid)
+        {
+            double dM = M - d_kepler_M;
+            if (dM > GPS_PI) dM -= 2.0 * GPS_PI;
+            if (dM < -GPS_PI) dM += 2.0 * GPS_PI;
+            // keep E next to M, also when M wraps around 2pi
+            double e_cos_E = d_e_eccentricity * cos(d_kepler_E);
+            E = M + (d_kepler_E - d_kepler_M) + dM * e_cos_E / (1.0 - e_cos_E);
+        }
+    else
+        {
+            E = M;
+        }
+    for (int ii = 1; ii < 20; ii++)
+        {
+            dE = (E - d_e_eccentricity * sin(E) - M) / (1.0 - d_e_eccentricity * cos(E));
+            E -= dE;
+            if (fabs(dE) < 1e-12)
+                {
+                    //Necessary precision is reached, exit from the loop
+                    break;
+                }
+        }
+    d_kepler_M = M;
+    d_kepler_E = E;
+    d_kepler_valid = true;
+    return E;
+}
+
+
 // 20.3.3.3.3.1 User Algorithm for SV Clock Correction.
 double Gps_Ephemeris::sv_clock_drift(double transmitTime)
 {
@@ -134,8 +176,6 @@ double Gps_Ephemeris::sv_clock_relativistic_term(double transmitTime)
     double n;
     double n0;
     double E;
-    double E_old;
-    double dE;
     double M;
 
     // Restore semi-major axis
@@ -154,21 +194,8 @@ double Gps_Ephemeris::sv_clock_relativistic_term(double transmitTime)
     // Reduce mean anomaly to between 0 and 2pi
     M = fmod((M + 2.0 * GPS_PI), (2.0 * GPS_PI));
 
-    // Initial guess of eccentric anomaly
-    E = M;
-
-    // --- Iteratively compute eccentric anomaly ----------------------------
-    for (int ii = 1; ii < 20; ii++)
-        {
-            E_old   = E;
-            E       = M + d_e_eccentricity * sin(E);
-            dE      = fmod(E - E_old, 2.0 * GPS_PI);
-            if (fabs(dE) < 1e-12)
-                {
-                    //Necessary precision is reached, exit from the loop
-                    break;
-                }
-        }
+    // Eccentric anomaly, warm-started from the previous evaluation
+    E = eccentric_anomaly(M);
 
     // Compute relativistic correction term
     d_dtr = F * d_e_eccentricity * d_sqrt_A * sin(E);
@@ -184,8 +211,6 @@ void Gps_Ephemeris::satellitePosition(double transmitTime)
     double n0;
     double M;
     double E;
-    double E_old;
-    double dE;
     double nu;
     double phi;
     double u;
@@ -213,21 +238,8 @@ void Gps_Ephemeris::satellitePosition(double transmitTime)
     // Reduce mean anomaly to between 0 and 2pi
     M = fmod((M + 2*GPS_PI), (2*GPS_PI));
 
-    // Initial guess of eccentric anomaly
-    E = M;
-
-    // --- Iteratively compute eccentric anomaly ----------------------------
-    for (int ii = 1; ii<20; ii++)
-        {
-            E_old   = E;
-            E       = M + d_e_eccentricity * sin(E);
-            dE      = fmod(E - E_old, 2*GPS_PI);
-            if (fabs(dE) < 1e-12)
-                {
-                    //Necessary precision is reached, exit from the loop
-                    break;
-                }
-        }
+    // Eccentric anomaly, warm-started from the previous evaluation
+    E = eccentric_anomaly(M);
 
     // Compute the true anomaly
     double tmp_Y = sqrt(1.0 - d_e_eccentricity * d_e_eccentricity) * sin(E);
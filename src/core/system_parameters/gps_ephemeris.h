@@ -37,6 +37,7 @@
 #include <string>
 #include "boost/assign.hpp"
 #include <boost/serialization/nvp.hpp>
+#include "gps_subframe_words.h"
 
 
 
@@ -56,6 +57,16 @@ private:
      * \param[out] -  corrected time, in seconds
      */
     double check_t(double time);
+
+    /*
+     * Eccentric anomaly [rad] for the mean anomaly M [rad], warm-started
+     * from the solution of the previous call
+     */
+    double eccentric_anomaly(double M);
+
+    double d_kepler_M;     // mean anomaly of the last eccentric_anomaly() call [rad]
+    double d_kepler_E;     // its eccentric anomaly [rad]
+    bool d_kepler_valid;
 public:
     unsigned int uid;  // unique id since we are acq/trk more than one instance of the same sat
     double timestamp;        // when was the ephemeris last updated 
@@ -131,8 +142,8 @@ public:
     std::map<int,std::string> satelliteBlock; //!< Map that stores to which block the PRN belongs http://www.navcen.uscg.gov/?Do=constellationStatus
 
 
-    //subframes bit strings for spoofing detection (comparison)
-    std::string subframe1, subframe2, subframe3, subframe4, subframe5;
+    //subframes 1 to 5, bit-packed, for spoofing detection (comparison)
+    Gps_Subframe_Words subframes[5];
 
     template<class Archive>
 
@@ -0,0 +1,306 @@
+/*!
+ * \file gps_lnav_encoder.cc
+ * \brief Encoder of the GPS L1 C/A navigation message (LNAV)
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "gps_lnav_encoder.h"
+#include <cmath>
+#include "GPS_L1_CA.h"
+
+namespace
+{
+const unsigned int seconds_per_week = 604800;
+
+// Data bits (1-24) of each parity equation, IS-GPS-200 Table 20-XIV
+const int parity_equations[6][16] = {
+        {1, 2, 3, 5, 6, 10, 11, 12, 13, 14, 17, 18, 20, 23, 0},
+        {2, 3, 4, 6, 7, 11, 12, 13, 14, 15, 18, 19, 21, 24, 0},
+        {1, 3, 4, 5, 7, 8, 12, 13, 14, 15, 16, 19, 20, 22, 0},
+        {2, 4, 5, 6, 8, 9, 13, 14, 15, 16, 17, 20, 21, 23, 0},
+        {1, 3, 5, 6, 7, 9, 10, 14, 15, 16, 17, 18, 21, 22, 24},
+        {3, 5, 6, 8, 9, 10, 11, 13, 15, 19, 22, 23, 24, 0}};
+
+uint32_t parity_mask(int equation)
+{
+    uint32_t mask = 0;
+    for (int i = 0; i < 16 && parity_equations[equation][i] != 0; i++)
+        {
+            mask |= 1u << (24 - parity_equations[equation][i]);
+        }
+    return mask;
+}
+
+bool odd_bits(uint32_t x)
+{
+    x ^= x >> 16;
+    x ^= x >> 8;
+    x ^= x >> 4;
+    x ^= x >> 2;
+    x ^= x >> 1;
+    return x & 1;
+}
+}
+
+
+Gps_Lnav_Encoder::Gps_Lnav_Encoder() :
+        d_page_18(false),
+        d_tow_s(0),
+        d_tow_jump_s(0),
+        d_subframe_tow_s(0),
+        d_bit(0),
+        d_last_d30(false)
+{}
+
+
+void Gps_Lnav_Encoder::set_iono(const Gps_Iono& iono)
+{
+    d_iono = iono;
+    d_page_18 = true;
+}
+
+
+void Gps_Lnav_Encoder::set_utc_model(const Gps_Utc_Model& utc_model)
+{
+    d_utc_model = utc_model;
+    d_page_18 = true;
+}
+
+
+void Gps_Lnav_Encoder::start(double tow_s)
+{
+    d_tow_s = (static_cast<unsigned int>(std::floor(tow_s / 6.0)) * 6) % seconds_per_week;
+    d_bit = 0;
+    d_last_d30 = false;
+}
+
+
+void Gps_Lnav_Encoder::jump_tow(int seconds)
+{
+    d_tow_jump_s += static_cast<int>(std::floor(seconds / 6.0 + 0.5)) * 6;
+}
+
+
+unsigned int Gps_Lnav_Encoder::transmitted_tow(unsigned int tow_s) const
+{
+    int tow = (static_cast<int>(tow_s) + d_tow_jump_s) % static_cast<int>(seconds_per_week);
+    return static_cast<unsigned int>(tow < 0 ? tow + seconds_per_week : tow);
+}
+
+
+int Gps_Lnav_Encoder::next_bit()
+{
+    if (d_bit == 0)
+        {
+            d_subframe_tow_s = transmitted_tow(d_tow_s);
+            d_subframe = encode_subframe(d_subframe_tow_s);
+        }
+    int word = d_bit / GPS_WORD_BITS;
+    int position = d_bit % GPS_WORD_BITS;
+    bool bit = (d_subframe.words[word] >> (GPS_WORD_BITS - 1 - position)) & 1;
+    bool previous_d30 = word == 0 ? d_last_d30 : (d_subframe.words[word - 1] & 1);
+    if (position < 24 && previous_d30)
+        {
+            bit = !bit;
+        }
+    d_bit++;
+    if (d_bit == GPS_SUBFRAME_BITS)
+        {
+            d_last_d30 = d_subframe.words[9] & 1;
+            d_bit = 0;
+            d_tow_s = (d_tow_s + 6) % seconds_per_week;
+        }
+    return bit ? 1 : -1;
+}
+
+
+uint32_t Gps_Lnav_Encoder::parity(uint32_t data, bool d29, bool d30)
+{
+    static const uint32_t masks[6] = {parity_mask(0), parity_mask(1), parity_mask(2), parity_mask(3), parity_mask(4), parity_mask(5)};
+    // D25 to D30 also depend on bit 29 or 30 of the previous word
+    static const bool uses_d30[6] = {false, true, false, true, true, false};
+    uint32_t bits = 0;
+    for (int i = 0; i < 6; i++)
+        {
+            bool p = odd_bits(data & masks[i]) != (uses_d30[i] ? d30 : d29);
+            bits = (bits << 1) | (p ? 1 : 0);
+        }
+    return bits;
+}
+
+
+void Gps_Lnav_Encoder::write_unsigned(Gps_Subframe_Words& subframe, const std::vector<std::pair<int,int> >& parameter, uint64_t value)
+{
+    int remaining = 0;
+    for (unsigned int i = 0; i < parameter.size(); i++)
+        {
+            remaining += parameter[i].second;
+        }
+    for (unsigned int i = 0; i < parameter.size(); i++)
+        {
+            remaining -= parameter[i].second;
+            for (int k = 0; k < parameter[i].second; k++)
+                {
+                    int n = parameter[i].first + k - 1;
+                    uint32_t mask = 1u << (GPS_WORD_BITS - 1 - n % GPS_WORD_BITS);
+                    if ((value >> (remaining + parameter[i].second - 1 - k)) & 1)
+                        {
+                            subframe.words[n / GPS_WORD_BITS] |= mask;
+                        }
+                    else
+                        {
+                            subframe.words[n / GPS_WORD_BITS] &= ~mask;
+                        }
+                }
+        }
+}
+
+
+void Gps_Lnav_Encoder::write_signed(Gps_Subframe_Words& subframe, const std::vector<std::pair<int,int> >& parameter, double value, double lsb)
+{
+    // two's complement, the bits above the field are dropped
+    write_unsigned(subframe, parameter, static_cast<uint64_t>(std::llround(value / lsb)));
+}
+
+
+void Gps_Lnav_Encoder::write_unsigned(Gps_Subframe_Words& subframe, const std::vector<std::pair<int,int> >& parameter, double value, double lsb)
+{
+    long long n = std::llround(value / lsb);
+    write_unsigned(subframe, parameter, static_cast<uint64_t>(n < 0 ? 0 : n));
+}
+
+
+Gps_Subframe_Words Gps_Lnav_Encoder::encode_subframe(unsigned int tow_s) const
+{
+    const Gps_Ephemeris& eph = d_ephemeris;
+    unsigned int subframe_id = (tow_s / 6) % 5 + 1;
+    Gps_Subframe_Words subframe;
+
+    // TLM and HOW. The TOW count is the one of the next subframe.
+    write_unsigned(subframe, {{1, 8}}, static_cast<uint64_t>(0x8B));
+    write_unsigned(subframe, INTEGRITY_STATUS_FLAG, static_cast<uint64_t>(eph.b_integrity_status_flag));
+    write_unsigned(subframe, TOW, static_cast<uint64_t>(((tow_s + 6) % seconds_per_week) / 6));
+    write_unsigned(subframe, ALERT_FLAG, static_cast<uint64_t>(eph.b_alert_flag));
+    write_unsigned(subframe, ANTI_SPOOFING_FLAG, static_cast<uint64_t>(eph.b_antispoofing_flag));
+    write_unsigned(subframe, SUBFRAME_ID, static_cast<uint64_t>(subframe_id));
+
+    switch (subframe_id)
+    {
+    case 1:
+        write_unsigned(subframe, GPS_WEEK, static_cast<uint64_t>(eph.i_GPS_week % 1024));
+        write_unsigned(subframe, CA_OR_P_ON_L2, static_cast<uint64_t>(eph.i_code_on_L2));
+        write_unsigned(subframe, SV_ACCURACY, static_cast<uint64_t>(eph.i_SV_accuracy));
+        write_unsigned(subframe, SV_HEALTH, static_cast<uint64_t>(eph.i_SV_health));
+        write_unsigned(subframe, L2_P_DATA_FLAG, static_cast<uint64_t>(eph.b_L2_P_data_flag));
+        write_signed(subframe, T_GD, eph.d_TGD, T_GD_LSB);
+        write_unsigned(subframe, IODC, eph.d_IODC, 1.0);
+        write_unsigned(subframe, T_OC, eph.d_Toc, T_OC_LSB);
+        write_signed(subframe, A_F2, eph.d_A_f2, A_F2_LSB);
+        write_signed(subframe, A_F1, eph.d_A_f1, A_F1_LSB);
+        write_signed(subframe, A_F0, eph.d_A_f0, A_F0_LSB);
+        break;
+    case 2:
+        write_unsigned(subframe, IODE_SF2, eph.d_IODE_SF2, 1.0);
+        write_signed(subframe, C_RS, eph.d_Crs, C_RS_LSB);
+        write_signed(subframe, DELTA_N, eph.d_Delta_n, DELTA_N_LSB);
+        write_signed(subframe, M_0, eph.d_M_0, M_0_LSB);
+        write_signed(subframe, C_UC, eph.d_Cuc, C_UC_LSB);
+        write_unsigned(subframe, E, eph.d_e_eccentricity, E_LSB);
+        write_signed(subframe, C_US, eph.d_Cus, C_US_LSB);
+        write_unsigned(subframe, SQRT_A, eph.d_sqrt_A, SQRT_A_LSB);
+        write_unsigned(subframe, T_OE, eph.d_Toe, T_OE_LSB);
+        break;
+    case 3:
+        write_signed(subframe, C_IC, eph.d_Cic, C_IC_LSB);
+        write_signed(subframe, OMEGA_0, eph.d_OMEGA0, OMEGA_0_LSB);
+        write_signed(subframe, C_IS, eph.d_Cis, C_IS_LSB);
+        write_signed(subframe, I_0, eph.d_i_0, I_0_LSB);
+        write_signed(subframe, C_RC, eph.d_Crc, C_RC_LSB);
+        write_signed(subframe, OMEGA, eph.d_OMEGA, OMEGA_LSB);
+        write_signed(subframe, OMEGA_DOT, eph.d_OMEGA_DOT, OMEGA_DOT_LSB);
+        write_unsigned(subframe, IODE_SF3, eph.d_IODE_SF3, 1.0);
+        write_signed(subframe, I_DOT, eph.d_IDOT, I_DOT_LSB);
+        break;
+    case 4:
+        write_unsigned(subframe, SV_DATA_ID, static_cast<uint64_t>(1));
+        if (d_page_18)
+            {
+                write_unsigned(subframe, SV_PAGE, static_cast<uint64_t>(56));
+                write_signed(subframe, ALPHA_0, d_iono.d_alpha0, ALPHA_0_LSB);
+                write_signed(subframe, ALPHA_1, d_iono.d_alpha1, ALPHA_1_LSB);
+                write_signed(subframe, ALPHA_2, d_iono.d_alpha2, ALPHA_2_LSB);
+                write_signed(subframe, ALPHA_3, d_iono.d_alpha3, ALPHA_3_LSB);
+                write_signed(subframe, BETA_0, d_iono.d_beta0, BETA_0_LSB);
+                write_signed(subframe, BETA_1, d_iono.d_beta1, BETA_1_LSB);
+                write_signed(subframe, BETA_2, d_iono.d_beta2, BETA_2_LSB);
+                write_signed(subframe, BETA_3, d_iono.d_beta3, BETA_3_LSB);
+                write_signed(subframe, A_1, d_utc_model.d_A1, A_1_LSB);
+                write_signed(subframe, A_0, d_utc_model.d_A0, A_0_LSB);
+                write_unsigned(subframe, T_OT, d_utc_model.d_t_OT, T_OT_LSB);
+                write_unsigned(subframe, WN_T, static_cast<uint64_t>(d_utc_model.i_WN_T % 256));
+                write_signed(subframe, DELTAT_LS, d_utc_model.d_DeltaT_LS, DELTAT_LS_LSB);
+                write_unsigned(subframe, WN_LSF, static_cast<uint64_t>(d_utc_model.i_WN_LSF % 256));
+                write_unsigned(subframe, DN, static_cast<uint64_t>(d_utc_model.i_DN));
+                write_signed(subframe, DELTAT_LSF, d_utc_model.d_DeltaT_LSF, DELTAT_LSF_LSB);
+            }
+        else
+            {
+                write_unsigned(subframe, SV_PAGE, static_cast<uint64_t>(57));  // page 12, reserved
+            }
+        break;
+    case 5:
+        // page 25: almanac reference and health of PRN 1 to 24, all healthy
+        write_unsigned(subframe, SV_DATA_ID, static_cast<uint64_t>(1));
+        write_unsigned(subframe, SV_PAGE, static_cast<uint64_t>(51));
+        write_unsigned(subframe, T_OA_25, eph.d_Toe, T_OA_LSB);
+        write_unsigned(subframe, WN_A, static_cast<uint64_t>(eph.i_GPS_week % 256));
+        break;
+    }
+
+    // parity; bits 23 and 24 of words 2 and 10 are solved so that their
+    // last parity bits are 0, and the next word is not inverted
+    bool d29 = false;
+    bool d30 = false;
+    for (int i = 0; i < 10; i++)
+        {
+            uint32_t data = (subframe.words[i] >> 6) & 0xFFFFFF;
+            uint32_t p = parity(data, d29, d30);
+            if (i == 1 || i == 9)
+                {
+                    for (uint32_t t = 0; t < 4 && (p & 3) != 0; t++)
+                        {
+                            data = (data & ~3u) | t;
+                            p = parity(data, d29, d30);
+                        }
+                }
+            subframe.words[i] = (data << 6) | p;
+            d29 = (p >> 1) & 1;
+            d30 = p & 1;
+        }
+    return subframe;
+}
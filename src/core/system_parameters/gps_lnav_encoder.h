@@ -0,0 +1,122 @@
+/*!
+ * \file gps_lnav_encoder.h
+ * \brief Encoder of the GPS L1 C/A navigation message (LNAV)
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_GPS_LNAV_ENCODER_H_
+#define GNSS_SDR_GPS_LNAV_ENCODER_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "gps_ephemeris.h"
+#include "gps_iono.h"
+#include "gps_subframe_words.h"
+#include "gps_utc_model.h"
+
+/*!
+ * \brief Encodes the GPS L1 C/A navigation message of a satellite, with
+ * the field tables and scale factors of GPS_L1_CA.h: a subframe encoded
+ * here is decoded by Gps_Navigation_Message::subframe_decoder into the
+ * same values, rounded to their LSB.
+ *
+ * Subframes 1 to 3 carry the ephemeris. Subframe 4 is always page 18
+ * (ionosphere and UTC) once they are set, and subframe 5 page 25 (health,
+ * all healthy), so that a receiver gets them within one frame. The
+ * AODO and fit interval flag are not encoded, GPS_L1_CA.h reads them from
+ * the bits of Toe.
+ *
+ * The bit stream (next_bit()) is generated one subframe ahead, so that a
+ * change of the ephemeris or of the TOW is transmitted from the next
+ * subframe on, as a spoofer editing the message would.
+ */
+class Gps_Lnav_Encoder
+{
+public:
+    Gps_Lnav_Encoder();
+
+    void set_ephemeris(const Gps_Ephemeris& ephemeris) { d_ephemeris = ephemeris; }
+    const Gps_Ephemeris& ephemeris() const { return d_ephemeris; }
+    void set_iono(const Gps_Iono& iono);
+    void set_utc_model(const Gps_Utc_Model& utc_model);
+
+    /*!
+     * \brief Starts the bit stream with the subframe transmitted at time
+     * of week tow_s, rounded down to a multiple of 6 s
+     */
+    void start(double tow_s);
+
+    /*!
+     * \brief Adds seconds, rounded to a multiple of 6, to the TOW
+     * transmitted in the next subframes
+     */
+    void jump_tow(int seconds);
+
+    /*!
+     * \brief Next bit of the stream, +1 or -1, with the data bits of each
+     * word inverted after a word that ends with a 1, as transmitted
+     */
+    int next_bit();
+
+    //! Time of week transmitted in the current subframe [s]
+    unsigned int tow_s() const { return d_bit == 0 ? transmitted_tow(d_tow_s) : d_subframe_tow_s; }
+
+    /*!
+     * \brief Subframe transmitted at time of week tow_s (a multiple of 6),
+     * as the telemetry decoder stores it: data bits not inverted, parity in
+     * the 6 LSBs. Its subframe ID is (tow_s / 6) % 5 + 1.
+     */
+    Gps_Subframe_Words encode_subframe(unsigned int tow_s) const;
+
+    /*!
+     * \brief Parity bits of the 24 data bits of a word (bits 1-24 in the
+     * MSBs of data), after a word that ended with bits d29 and d30
+     * (IS-GPS-200 Table 20-XIV)
+     */
+    static uint32_t parity(uint32_t data, bool d29, bool d30);
+
+private:
+    unsigned int transmitted_tow(unsigned int tow_s) const;
+    static void write_unsigned(Gps_Subframe_Words& subframe, const std::vector<std::pair<int,int> >& parameter, uint64_t value);
+    static void write_signed(Gps_Subframe_Words& subframe, const std::vector<std::pair<int,int> >& parameter, double value, double lsb);
+    static void write_unsigned(Gps_Subframe_Words& subframe, const std::vector<std::pair<int,int> >& parameter, double value, double lsb);
+
+    Gps_Ephemeris d_ephemeris;
+    Gps_Iono d_iono;
+    Gps_Utc_Model d_utc_model;
+    bool d_page_18;
+    unsigned int d_tow_s;    // of the subframe being transmitted, without the jumps
+    int d_tow_jump_s;
+    Gps_Subframe_Words d_subframe;
+    unsigned int d_subframe_tow_s;  // transmitted in d_subframe
+    int d_bit;               // next bit of d_subframe, 0 to 299
+    bool d_last_d30;         // bit 30 of the previous word
+};
+
+#endif
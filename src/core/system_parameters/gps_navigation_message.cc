@@ -37,7 +37,6 @@ m * \file gps_navigation_message.cc
 #include <cmath>
 #include <iostream>
 #include <gnss_satellite.h>
-#include <sstream>
 
 void Gps_Navigation_Message::reset()
 {
@@ -151,6 +150,10 @@ void Gps_Navigation_Message::reset()
     d_satvel_X = 0;
     d_satvel_Y = 0;
     d_satvel_Z = 0;
+    for (int i = 0; i < 5; i++)
+        {
+            subframes[i].clear();
+        }
 
     auto gnss_sat = Gnss_Satellite();
     std::string _system ("GPS");
@@ -178,98 +181,21 @@ void Gps_Navigation_Message::print_gps_word_bytes(unsigned int GPS_word)
 
 
 
-bool Gps_Navigation_Message::read_navigation_bool(std::bitset<GPS_SUBFRAME_BITS> bits, const std::vector<std::pair<int,int>> parameter)
+bool Gps_Navigation_Message::read_navigation_bool(const Navigation_Message_Bits<GPS_SUBFRAME_BITS>& bits, const std::vector<std::pair<int,int>>& parameter)
 {
-    bool value;
-
-    if (bits[GPS_SUBFRAME_BITS - parameter[0].first] == 1)
-        {
-            value = true;
-        }
-    else
-        {
-            value = false;
-        }
-    return value;
+    return bits.read_bool(parameter);
 }
 
 
-unsigned long int Gps_Navigation_Message::read_navigation_unsigned(std::bitset<GPS_SUBFRAME_BITS> bits, const std::vector<std::pair<int,int>> parameter)
+unsigned long int Gps_Navigation_Message::read_navigation_unsigned(const Navigation_Message_Bits<GPS_SUBFRAME_BITS>& bits, const std::vector<std::pair<int,int>>& parameter)
 {
-    unsigned long int value = 0;
-    int num_of_slices = parameter.size();
-    for (int i = 0; i < num_of_slices; i++)
-        {
-            for (int j = 0; j < parameter[i].second; j++)
-                {
-                    value <<= 1; //shift left
-                    if (bits[GPS_SUBFRAME_BITS - parameter[i].first - j] == 1)
-                        {
-                            value += 1; // insert the bit
-                        }
-                }
-        }
-    return value;
+    return bits.read_unsigned(parameter);
 }
 
 
-signed long int Gps_Navigation_Message::read_navigation_signed(std::bitset<GPS_SUBFRAME_BITS> bits, const std::vector<std::pair<int,int>> parameter)
+signed long int Gps_Navigation_Message::read_navigation_signed(const Navigation_Message_Bits<GPS_SUBFRAME_BITS>& bits, const std::vector<std::pair<int,int>>& parameter)
 {
-    signed long int value = 0;
-    int num_of_slices = parameter.size();
-    // Discriminate between 64 bits and 32 bits compiler
-    int long_int_size_bytes = sizeof(signed long int);
-    if (long_int_size_bytes == 8) // if a long int takes 8 bytes, we are in a 64 bits system
-        {
-            // read the MSB and perform the sign extension
-            if (bits[GPS_SUBFRAME_BITS - parameter[0].first] == 1)
-                {
-                    value ^= 0xFFFFFFFFFFFFFFFF; //64 bits variable
-                }
-            else
-                {
-                    value &= 0;
-                }
-
-            for (int i = 0; i < num_of_slices; i++)
-                {
-                    for (int j = 0; j < parameter[i].second; j++)
-                        {
-                            value <<= 1; //shift left
-                            value &= 0xFFFFFFFFFFFFFFFE; //reset the corresponding bit (for the 64 bits variable)
-                            if (bits[GPS_SUBFRAME_BITS - parameter[i].first - j] == 1)
-                                {
-                                    value += 1; // insert the bit
-                                }
-                        }
-                }
-        }
-    else  // we assume we are in a 32 bits system
-        {
-            // read the MSB and perform the sign extension
-            if (bits[GPS_SUBFRAME_BITS - parameter[0].first] == 1)
-                {
-                    value ^= 0xFFFFFFFF;
-                }
-            else
-                {
-                    value &= 0;
-                }
-
-            for (int i = 0; i < num_of_slices; i++)
-                {
-                    for (int j = 0; j < parameter[i].second; j++)
-                        {
-                            value <<= 1; //shift left
-                            value &= 0xFFFFFFFE; //reset the corresponding bit
-                            if (bits[GPS_SUBFRAME_BITS - parameter[i].first - j] == 1)
-                                {
-                                    value += 1; // insert the bit
-                                }
-                        }
-                }
-        }
-    return value;
+    return bits.read_signed(parameter);
 }
 
 
@@ -416,57 +342,45 @@ unsigned int Gps_Navigation_Message::get_uid()
     return uid;
 }
 
-std::string Gps_Navigation_Message::get_subframe(int subframe_ID)
+Gps_Subframe_Words Gps_Navigation_Message::get_subframe(int subframe_ID)
 {
-    switch (subframe_ID)
-    {
-    case 1:
-        return subframe1;
-        break;
-    case 2:
-        return subframe2;
-        break;
-    case 3:
-        return subframe3;
-        break;
-    case 4:
-        return subframe4;
-        break;
-    case 5:
-        return subframe5;
-        break;
-    }
-    return 0;
+    if (subframe_ID >= 1 && subframe_ID <= 5)
+        {
+            return subframes[subframe_ID - 1];
+        }
+    return Gps_Subframe_Words();
 }
 
 int Gps_Navigation_Message::subframe_decoder(char *subframe)
 {
-    int subframe_ID = 0;
+    unsigned int words[GPS_SUBFRAME_WORDS];
+    memcpy(words, subframe, sizeof(char) * GPS_SUBFRAME_LENGTH);
+    return subframe_decoder(words);
+}
 
-    //double tmp_TOW;
 
-    unsigned int gps_word;
+int Gps_Navigation_Message::subframe_decoder(const unsigned int *words)
+{
+    int subframe_ID = 0;
 
-    // UNPACK BYTES TO BITS AND REMOVE THE CRC REDUNDANCE
-    std::bitset<GPS_SUBFRAME_BITS> subframe_bits;
-    std::bitset<GPS_WORD_BITS + 2> word_bits;
-    for (int i = 0; i < 10; i++)
+    // REMOVE THE CRC REDUNDANCE AND PACK THE WORDS
+    std::bitset<GPS_SUBFRAME_BITS> subframe_bitset;
+    Gps_Subframe_Words subframe_words;
+    for (int i = 0; i < GPS_SUBFRAME_WORDS; i++)
         {
-            memcpy(&gps_word, &subframe[i * 4], sizeof(char) * 4);
-            word_bits = std::bitset<(GPS_WORD_BITS + 2) > (gps_word);
-            for (int j = 0; j < GPS_WORD_BITS; j++)
-                {
-                    subframe_bits[GPS_WORD_BITS * (9 - i) + j] = word_bits[j];
-                }
+            subframe_words.words[i] = words[i] & 0x3FFFFFFF;
+            subframe_bitset <<= GPS_WORD_BITS;
+            subframe_bitset |= std::bitset<GPS_SUBFRAME_BITS>(subframe_words.words[i]);
         }
-    
-    std::string subframe_string = subframe_bits.to_string<char,std::string::traits_type,std::string::allocator_type>();
-    //std::cout << subframe_string << std::endl;
+    const Navigation_Message_Bits<GPS_SUBFRAME_BITS> subframe_bits(subframe_bitset);
 
     subframe_ID = static_cast<int>(read_navigation_unsigned(subframe_bits, SUBFRAME_ID));
+    if (subframe_ID >= 1 && subframe_ID <= 5)
+        {
+            // kept for the spoofing detection (comparison)
+            subframes[subframe_ID - 1] = subframe_words;
+        }
 
-    std::stringstream os;
-    os.precision(15);
 
     // Decode all 5 sub-frames
     switch (subframe_ID)
@@ -504,24 +418,6 @@ int Gps_Navigation_Message::subframe_decoder(char *subframe)
         d_A_f2 = static_cast<double>(read_navigation_signed(subframe_bits, A_F2));
         d_A_f2 = d_A_f2 * A_F2_LSB;
 
-        os << " " << d_TOW;
-        os << " " << b_integrity_status_flag;
-        os << " " << b_alert_flag; 
-        os << " " << b_antispoofing_flag;
-        os << " " << i_GPS_week; 
-        os << " " << i_SV_accuracy;
-        os << " " << i_SV_health;
-        os << " " << b_L2_P_data_flag;
-        os << " " << i_code_on_L2; 
-        os << " " << d_TGD; 
-        os << " " << d_TGD; 
-        os << " " << d_IODC; 
-        os << " " << d_Toc; 
-        os << " " << d_A_f0; 
-        os << " " << d_A_f1; 
-        os << " " << d_A_f2;
-        subframe1 = os.str(); 
-        //std::cout << "subframe 1: " << os.str() <<std::endl;
 
         break;
 
@@ -554,23 +450,6 @@ int Gps_Navigation_Message::subframe_decoder(char *subframe)
         i_AODO = i_AODO * AODO_LSB;
 
 
-        os << " " << d_TOW;
-        os << " " << b_integrity_status_flag;
-        os << " " << b_alert_flag; 
-        os << " " << b_antispoofing_flag;
-        os << " " << d_IODE_SF2; 
-        os << " " << d_Crs;
-        os << " " << d_Delta_n; 
-        os << " " << d_M_0; 
-        os << " " << d_Cuc; 
-        os << " " << d_e_eccentricity; 
-        os << " " << d_Cus; 
-        os << " " << d_sqrt_A; 
-        os << " " << d_Toe; 
-        os << " " << b_fit_interval_flag; 
-        os << " " << i_AODO; 
-        subframe2 = os.str(); 
-        //std::cout << "subframe 2: " << os.str() <<std::endl;
 
         break;
 
@@ -599,21 +478,6 @@ int Gps_Navigation_Message::subframe_decoder(char *subframe)
         d_IDOT = static_cast<double>(read_navigation_signed(subframe_bits, I_DOT));
         d_IDOT = d_IDOT * I_DOT_LSB;
 
-        os << " " << d_TOW; 
-        os << " " << b_integrity_status_flag; 
-        os << " " << b_alert_flag; 
-        os << " " << b_antispoofing_flag; 
-        os << " " << d_Cic; 
-        os << " " << d_OMEGA0;
-        os << " " << d_Cis; 
-        os << " " << d_i_0; 
-        os << " " << d_Crc; 
-        os << " " << d_OMEGA; 
-        os << " " << d_OMEGA_DOT; 
-        os << " " << d_IODE_SF3; 
-        os << " " << d_IDOT; 
-        subframe3 = os.str(); 
-        //std::cout << "subframe 3: " << os.str() <<std::endl;
 
         break;
 
@@ -634,12 +498,6 @@ int Gps_Navigation_Message::subframe_decoder(char *subframe)
                 if(SV_data_ID){}
             }
 
-        os << " " << d_TOW; 
-        os << " " << b_integrity_status_flag; 
-        os << " " << b_alert_flag; 
-        os << " " << b_antispoofing_flag; 
-        os << " " << SV_data_ID; 
-        os << " " << SV_page; 
 
         if (SV_page == 52) // Page 13 (from Table 20-V. Data IDs and SV IDs in Subframes 4 and 5, IS-GPS-200H, page 110)
             {
@@ -679,22 +537,6 @@ int Gps_Navigation_Message::subframe_decoder(char *subframe)
                 flag_iono_valid = true;
                 flag_utc_model_valid = true;
 
-                os << " " << d_alpha0; 
-                os << " " << d_alpha1; 
-                os << " " << d_alpha2; 
-                os << " " << d_alpha3; 
-                os << " " << d_beta0; 
-                os << " " << d_beta1; 
-                os << " " << d_beta2; 
-                os << " " << d_beta3; 
-                os << " " << d_A1; 
-                os << " " << d_A0; 
-                os << " " << d_t_OT; 
-                os << " " << i_WN_T; 
-                os << " " << d_DeltaT_LS; 
-                os << " " << i_WN_LSF; 
-                os << " " << i_DN; 
-                os << " " << d_DeltaT_LSF; 
             }
         if (SV_page == 57)
             {
@@ -753,23 +595,9 @@ int Gps_Navigation_Message::subframe_decoder(char *subframe)
                 almanac.d_A_f1 = a_f1 * almanac_A_F1_LSB; 
                 almanac_map[almanac_page_to_PRN.at( SV_page )] = almanac;
 
-                os << " " << d_Toa; 
-                os << " " << almanac.d_Delta_i; 
-                os << " " << almanac.d_M_0; 
-                os << " " << almanac.d_e_eccentricity; 
-                os.precision(6);
-                os << " " << almanac.d_sqrt_A; 
-                os.precision(15);
-                os << " " << almanac.d_OMEGA0; 
-                os << " " << almanac.d_OMEGA; 
-                os << " " << almanac.d_OMEGA_DOT; 
-                os << " " << almanac.d_A_f0; 
-                os << " " << almanac.d_A_f1; 
             }
 
 
-        subframe4 = os.str(); 
-        //std::cout << "subframe 4: " << os.str() <<std::endl;
 
         break;
 
@@ -785,12 +613,6 @@ int Gps_Navigation_Message::subframe_decoder(char *subframe)
         SV_data_ID_5 = static_cast<int>(read_navigation_unsigned(subframe_bits, SV_DATA_ID));
         SV_page_5 = static_cast<int>(read_navigation_unsigned(subframe_bits, SV_PAGE));
 
-        os << " " << d_TOW; 
-        os << " " << b_integrity_status_flag; 
-        os << " " << b_alert_flag; 
-        os << " " << b_antispoofing_flag; 
-        os << " " << SV_data_ID_5; 
-        os << " " << SV_page_5; 
 
         if (SV_page_5 < 25 && SV_page_5 != 0)
             {
@@ -831,16 +653,6 @@ int Gps_Navigation_Message::subframe_decoder(char *subframe)
                 almanac.d_A_f1 = a_f1 * almanac_A_F1_LSB; 
                 almanac_map[SV_page] = almanac;
 
-                os << " " << d_Toa; 
-                os << " " << almanac.d_Delta_i; 
-                os << " " << almanac.d_M_0; 
-                os << " " << almanac.d_e_eccentricity; 
-                os << " " << almanac.d_sqrt_A; 
-                os << " " << almanac.d_OMEGA0; 
-                os << " " << almanac.d_OMEGA; 
-                os << " " << almanac.d_OMEGA_DOT; 
-                os << " " << almanac.d_A_f0; 
-                os << " " << almanac.d_A_f1; 
             }
 
         if (SV_page_5 == 51) // Page 25 (from Table 20-V. Data IDs and SV IDs in Subframes 4 and 5, IS-GPS-200H, page 110)
@@ -848,8 +660,6 @@ int Gps_Navigation_Message::subframe_decoder(char *subframe)
                 d_Toa = static_cast<double>(read_navigation_unsigned(subframe_bits, T_OA));
                 d_Toa = d_Toa * T_OA_LSB;
                 i_WN_A = static_cast<int>(read_navigation_unsigned(subframe_bits, WN_A));
-                os << " " << d_Toa; 
-                os << " " << i_WN_A; 
 
                 almanacHealth[1] = static_cast<int>(read_navigation_unsigned(subframe_bits, HEALTH_SV1));
                 almanacHealth[2] = static_cast<int>(read_navigation_unsigned(subframe_bits, HEALTH_SV2));
@@ -876,7 +686,6 @@ int Gps_Navigation_Message::subframe_decoder(char *subframe)
                 almanacHealth[23] = static_cast<int>(read_navigation_unsigned(subframe_bits, HEALTH_SV23));
                 almanacHealth[24] = static_cast<int>(read_navigation_unsigned(subframe_bits, HEALTH_SV24));
             }
-        subframe5 = os.str(); 
         break;
 
     default:
@@ -1005,11 +814,10 @@ Gps_Ephemeris Gps_Navigation_Message::get_ephemeris()
     ephemeris.d_satvel_X = d_satvel_X;
     ephemeris.d_satvel_Y = d_satvel_Y;
     ephemeris.d_satvel_Z = d_satvel_Z;
-    ephemeris.subframe1 = subframe1;
-    ephemeris.subframe2 = subframe2;
-    ephemeris.subframe3 = subframe3;
-    ephemeris.subframe4 = subframe4;
-    ephemeris.subframe5 = subframe5;
+    for (int i = 0; i < 5; i++)
+        {
+            ephemeris.subframes[i] = subframes[i];
+        }
 
     return ephemeris;
 }
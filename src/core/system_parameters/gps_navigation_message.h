@@ -46,6 +46,8 @@
 #include "gps_iono.h"
 #include "gps_almanac.h"
 #include "gps_utc_model.h"
+#include "gps_subframe_words.h"
+#include "navigation_message_bits.h"
 
 
 
@@ -57,9 +59,9 @@
 class Gps_Navigation_Message
 {
 private:
-    unsigned long int read_navigation_unsigned(std::bitset<GPS_SUBFRAME_BITS> bits, const std::vector<std::pair<int,int>> parameter);
-    signed long int read_navigation_signed(std::bitset<GPS_SUBFRAME_BITS> bits, const std::vector<std::pair<int,int>> parameter);
-    bool read_navigation_bool(std::bitset<GPS_SUBFRAME_BITS> bits, const std::vector<std::pair<int,int>> parameter);
+    unsigned long int read_navigation_unsigned(const Navigation_Message_Bits<GPS_SUBFRAME_BITS>& bits, const std::vector<std::pair<int,int>>& parameter);
+    signed long int read_navigation_signed(const Navigation_Message_Bits<GPS_SUBFRAME_BITS>& bits, const std::vector<std::pair<int,int>>& parameter);
+    bool read_navigation_bool(const Navigation_Message_Bits<GPS_SUBFRAME_BITS>& bits, const std::vector<std::pair<int,int>>& parameter);
     void print_gps_word_bytes(unsigned int GPS_word);
     /*
      * Accounts for the beginning or end of week crossover
@@ -196,12 +198,8 @@ public:
     double d_satvel_Y;    //!< Earth-fixed velocity coordinate y of the satellite [m]
     double d_satvel_Z;    //!< Earth-fixed velocity coordinate z of the satellite [m]
 
-    //subframes bit strings for spoofing detection (comparison)
-    std::string subframe1 = "";
-    std::string subframe2 = "";
-    std::string subframe3 = "";
-    std::string subframe4 = "";
-    std::string subframe5 = "";
+    //subframes 1 to 5, bit-packed, for spoofing detection (comparison)
+    Gps_Subframe_Words subframes[5];
 
     // public functions
     void reset();
@@ -230,9 +228,15 @@ public:
      * \brief Decodes the GPS NAV message
      */
     int subframe_decoder(char *subframe);
+
+    /*!
+     * \brief Decodes the GPS NAV message from its ten words, in their low
+     * 30 bits, MSB first
+     */
+    int subframe_decoder(const unsigned int *words);
     
     //for spoofing
-    std::string get_subframe(int subframe_ID);
+    Gps_Subframe_Words get_subframe(int subframe_ID);
     double get_TOW();
     int get_week();
     unsigned int get_uid();
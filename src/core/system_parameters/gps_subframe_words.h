@@ -0,0 +1,183 @@
+/*!
+ * \file gps_subframe_words.h
+ * \brief Bit-packed GPS NAV subframe, as kept for the spoofing detection
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_GPS_SUBFRAME_WORDS_H_
+#define GNSS_SDR_GPS_SUBFRAME_WORDS_H_
+
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+/*!
+ * \brief The ten 30-bit words of a decoded GPS L1 C/A subframe.
+ *
+ * words[0] is the TLM word and words[1] the HOW. Bit n of the subframe
+ * (1..300, as numbered in IS-GPS-200 and in GPS_L1_CA.h) is bit
+ * 30 - ((n - 1) % 30) - 1 of words[(n - 1) / 30], so each word holds its
+ * bits in transmission order, MSB first, in the low 30 bits.
+ *
+ * A whole subframe is 40 bytes and two subframes are compared with ten
+ * word operations, instead of formatting and comparing the decoded values
+ * as text.
+ */
+struct Gps_Subframe_Words
+{
+    uint32_t words[10];
+
+    Gps_Subframe_Words()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        for (int i = 0; i < 10; i++)
+            {
+                words[i] = 0;
+            }
+    }
+
+    /*!
+     * \brief True until a subframe has been stored. Every decoded subframe
+     * starts with the preamble, so its TLM word is never zero.
+     */
+    bool empty() const
+    {
+        return words[0] == 0;
+    }
+
+    /*!
+     * \brief Subframe ID of the HOW (bits 50-52)
+     */
+    unsigned int subframe_id() const
+    {
+        return (words[1] >> 8) & 0x7;
+    }
+
+    /*!
+     * \brief Truncated TOW count of the HOW (bits 31-47), in units of 6 s,
+     * the time of the start of the next subframe
+     */
+    unsigned int tow_count() const
+    {
+        return (words[1] >> 13) & 0x1FFFF;
+    }
+
+    /*!
+     * \brief Week number (bits 61-70) of a subframe 1
+     */
+    unsigned int week() const
+    {
+        return (words[2] >> 20) & 0x3FF;
+    }
+
+    /*!
+     * \brief Page (SV ID, bits 63-68) of a subframe 4 or 5
+     */
+    unsigned int sv_page() const
+    {
+        return (words[2] >> 22) & 0x3F;
+    }
+
+    /*!
+     * \brief Bits of word i that carry navigation data worth comparing.
+     *
+     * The TLM word, the parity bits and the two parity solving bits of
+     * words 2 and 10 are left out. In subframes 4 and 5, which are compared
+     * between different satellites, the alert and anti-spoofing flags of
+     * the HOW are left out too, and only the pages that the receiver
+     * decodes (ionosphere and UTC, almanacs, health) are compared beyond
+     * their header: the others hold reserved or satellite specific data.
+     */
+    uint32_t data_mask(int i) const
+    {
+        const uint32_t data_bits = 0x3FFFFFC0;  // bits 1-24 of the word
+        const uint32_t solving_bits = 0x000000C0;  // bits 23-24
+        const uint32_t flag_bits = 0x00001800;  // bits 18-19 of the HOW
+        unsigned int subframe_id = (words[1] >> 8) & 0x7;
+        bool compare_data = subframe_id < 4;
+        if (subframe_id == 4)
+            {
+                unsigned int page = sv_page();
+                compare_data = (page >= 25 && page <= 32) || page == 56 || page == 63;
+            }
+        if (subframe_id == 5)
+            {
+                unsigned int page = sv_page();
+                compare_data = (page >= 1 && page <= 24) || page == 51;
+            }
+        switch (i)
+        {
+        case 0:
+            return 0;
+        case 1:
+            return data_bits & ~solving_bits & (subframe_id < 4 ? ~0u : ~flag_bits);
+        case 2:
+            return compare_data ? data_bits : 0x3FC00000; // data ID and SV ID
+        case 9:
+            return compare_data ? data_bits & ~solving_bits : 0;
+        default:
+            return compare_data ? data_bits : 0;
+        }
+    }
+
+    /*!
+     * \brief True if both subframes carry the same navigation data, see data_mask()
+     */
+    bool same_data(const Gps_Subframe_Words& other) const
+    {
+        for (int i = 0; i < 10; i++)
+            {
+                if ((words[i] ^ other.words[i]) & data_mask(i))
+                    {
+                        return false;
+                    }
+            }
+        return true;
+    }
+
+    /*!
+     * \brief The ten words in hexadecimal, for the logs
+     */
+    std::string to_string() const
+    {
+        std::stringstream s;
+        s << std::hex << std::setfill('0');
+        for (int i = 0; i < 10; i++)
+            {
+                s << (i ? " " : "") << std::setw(8) << words[i];
+            }
+        return s.str();
+    }
+};
+
+#endif
@@ -0,0 +1,147 @@
+/*!
+ * \file navigation_message_bits.h
+ * \brief Word-level field extraction shared by the navigation message decoders
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_NAVIGATION_MESSAGE_BITS_H_
+#define GNSS_SDR_NAVIGATION_MESSAGE_BITS_H_
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*!
+ * \brief A navigation message page or subframe of N bits, packed in 64-bit
+ * words for reading its fields.
+ *
+ * Fields are described as in GPS_L1_CA.h, GPS_L2C.h, Galileo_E1.h and
+ * Galileo_E5a.h: a list of (first bit, length) slices, with the bits
+ * numbered from 1 in transmission order. The bits of a std::bitset<N> built
+ * from the message are in the opposite order (bit 1 is bits[N - 1]), and
+ * that order is kept here so the existing field tables apply unchanged.
+ *
+ * Each slice is read with one or two shifts and a mask instead of bit by
+ * bit, and the page is packed once per decoding instead of being copied,
+ * together with the field descriptor, at every field read.
+ */
+template<std::size_t N>
+class Navigation_Message_Bits
+{
+public:
+    explicit Navigation_Message_Bits(const std::bitset<N>& bits)
+    {
+        const std::bitset<N> low_word(0xFFFFFFFFFFFFFFFFULL);
+        std::bitset<N> rest = bits;
+        for (int k = 0; k < WORDS; k++)
+            {
+                d_words[k] = (rest & low_word).to_ullong();
+                rest >>= 64;
+            }
+    }
+
+    /*!
+     * \brief Packs a string of '0' and '1' characters, first bit first.
+     * As with std::bitset, a shorter string fills the last bits.
+     */
+    explicit Navigation_Message_Bits(const std::string& bits)
+    {
+        for (int k = 0; k < WORDS; k++)
+            {
+                d_words[k] = 0;
+            }
+        std::size_t length = bits.size() < N ? bits.size() : N;
+        for (std::size_t i = 0; i < length; i++)
+            {
+                if (bits[length - 1 - i] == '1')
+                    {
+                        d_words[i / 64] |= 1ULL << (i % 64);
+                    }
+            }
+    }
+
+    /*!
+     * \brief Bits first .. first + length - 1 (at most 64) as an unsigned value
+     */
+    uint64_t field(int first, int length) const
+    {
+        int lsb = static_cast<int>(N) - first - length + 1;
+        int k = lsb / 64;
+        int offset = lsb % 64;
+        uint64_t value = d_words[k] >> offset;
+        if (offset + length > 64)
+            {
+                value |= d_words[k + 1] << (64 - offset);
+            }
+        return length < 64 ? value & ((1ULL << length) - 1) : value;
+    }
+
+    unsigned long int read_unsigned(const std::vector<std::pair<int,int>>& parameter) const
+    {
+        uint64_t value = 0;
+        for (std::size_t i = 0; i < parameter.size(); i++)
+            {
+                value = (value << parameter[i].second) | field(parameter[i].first, parameter[i].second);
+            }
+        return static_cast<unsigned long int>(value);
+    }
+
+    /*!
+     * \brief Two's complement value of the concatenated slices
+     */
+    signed long int read_signed(const std::vector<std::pair<int,int>>& parameter) const
+    {
+        uint64_t value = 0;
+        int length = 0;
+        for (std::size_t i = 0; i < parameter.size(); i++)
+            {
+                value = (value << parameter[i].second) | field(parameter[i].first, parameter[i].second);
+                length += parameter[i].second;
+            }
+        if (length < 64 && ((value >> (length - 1)) & 1))
+            {
+                value |= ~0ULL << length; // sign extension
+            }
+        return static_cast<signed long int>(static_cast<int64_t>(value));
+    }
+
+    bool read_bool(const std::vector<std::pair<int,int>>& parameter) const
+    {
+        return field(parameter[0].first, 1) != 0;
+    }
+
+private:
+    // one spare word, so that field() can always read the word above
+    static const int WORDS = (N + 63) / 64 + 1;
+    uint64_t d_words[WORDS];
+};
+
+#endif
@@ -36,23 +36,26 @@
 #include <sstream>    // for std::stringstream
 #include <thread>
 #include <boost/algorithm/string.hpp>  // for to_upper_copy
-#include <boost/crc.hpp>
 #include <boost/date_time/gregorian/gregorian.hpp>
 #include <boost/dynamic_bitset.hpp>
 #include <glog/logging.h>
 #include "Galileo_E1.h"
+#include "crc24q.h"
+#include "rtcm_bits.h"
 
 using google::LogMessage;
 
 
-Rtcm::Rtcm(unsigned short port)
+Rtcm::Rtcm(unsigned short port, unsigned int server_threads, const std::string & ntrip_mountpoint)
 {
     RTCM_port = port;
+    Rtcm::server_threads = std::max(server_threads, 1u);
+    Rtcm::ntrip_mountpoint = ntrip_mountpoint;
     preamble = std::bitset<8>("11010011");
     reserved_field = std::bitset<6>("000000");
     rtcm_message_queue = std::make_shared< concurrent_queue<std::string> >();
     boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::tcp::v4(), RTCM_port);
-    servers.emplace_back(io_service, endpoint);
+    servers.emplace_back(io_service, endpoint, ntrip_mountpoint);
     server_is_running = false;
 }
 
@@ -80,9 +83,12 @@ void Rtcm::run_server()
             std::thread tq([&]{ std::make_shared<Queue_Reader>(io_service, rtcm_message_queue, RTCM_port)->do_read_queue(); });
             tq.detach();
 
-            std::thread t([&]{ io_service.run(); });
+            for(unsigned int i = 0; i < server_threads; i++)
+                {
+                    std::thread t([&]{ io_service.run(); });
+                    t.detach();
+                }
             server_is_running = true;
-            t.detach();
     }
     catch (std::exception& e)
     {
@@ -129,140 +135,97 @@ bool Rtcm::is_server_running() const
 std::string Rtcm::add_CRC (const std::string & message_without_crc) const
 {
     // ******  Computes Qualcomm CRC-24Q ******
-    boost::crc_optimal<24, 0x1864CFBu, 0x0, 0x0, false, false> CRC_RTCM;
-    // 1) Converts the string to a vector of unsigned char:
-    boost::dynamic_bitset<unsigned char> frame_bits(message_without_crc);
-    std::vector<unsigned char> bytes;
-    boost::to_block_range(frame_bits, std::back_inserter(bytes));
-    std::reverse(bytes.begin(), bytes.end());
-
-    // 2) Computes CRC
-    CRC_RTCM.process_bytes(bytes.data(), bytes.size());
-    std::bitset<24> crc_frame = std::bitset<24>(CRC_RTCM.checksum());
-
-    // 3) Builds the complete message
-    std::string complete_message = message_without_crc + crc_frame.to_string();
-    return bin_to_binary_data(complete_message);
+    Rtcm_Bit_Writer frame;
+    frame.put_bin(message_without_crc);
+    frame.put(crc24q(frame.data(), frame.size_bytes()), 24);
+    return std::string(reinterpret_cast<const char*>(frame.data()), frame.size_bytes());
 }
 
 
 bool Rtcm::check_CRC(const std::string & message) const
 {
-    boost::crc_optimal<24, 0x1864CFBu, 0x0, 0x0, false, false> CRC_RTCM_CHECK;
-    // Convert message to binary
-    std::string message_bin = Rtcm::binary_data_to_bin(message);
-    // Check CRC
-    std::string crc = message_bin.substr(message_bin.length() - 24, 24);
-    std::bitset<24> read_crc =  std::bitset<24>(crc);
-    std::string msg_without_crc = message_bin.substr(0, message_bin.length() - 24);
-
-    boost::dynamic_bitset<unsigned char> frame_bits(msg_without_crc);
-    std::vector<unsigned char> bytes;
-    boost::to_block_range(frame_bits, std::back_inserter(bytes));
-    std::reverse(bytes.begin(), bytes.end());
-
-    CRC_RTCM_CHECK.process_bytes(bytes.data(), bytes.size());
-    std::bitset<24> computed_crc = std::bitset<24>(CRC_RTCM_CHECK.checksum());
-    if(read_crc == computed_crc)
-        {
-            return true;
-        }
-    else
+    if(message.length() < 3)
         {
             return false;
         }
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(message.data());
+    std::size_t n_bytes = message.length() - 3;
+    Rtcm_Bit_Reader parity(bytes + n_bytes, 3);
+    unsigned int read_crc = static_cast<unsigned int>(parity.get(24));
+    return read_crc == crc24q(bytes, n_bytes);
 }
 
 
 std::string Rtcm::bin_to_binary_data(const std::string& s) const
 {
-    std::string s_aux;
-    int remainder = static_cast<int>(std::fmod(s.length(), 8));
-    unsigned char c[s.length()];
-    unsigned int k = 0;
+    // the leading bits that do not complete a byte form the first one
+    Rtcm_Bit_Writer bytes;
+    unsigned int remainder = s.length() % 8;
     if (remainder != 0)
         {
-            s_aux.assign(s, 0 , remainder);
-            boost::dynamic_bitset<> rembits(s_aux);
-            unsigned long int n = rembits.to_ulong();
-            c[0] = static_cast<unsigned char>(n);
-            k++;
-        }
-
-    unsigned int start = std::max(remainder, 0);
-    for(unsigned int i = start; i < s.length() - 1; i = i + 8)
-        {
-            s_aux.assign(s, i, 4);
-            std::bitset<4> bs(s_aux);
-            unsigned n = bs.to_ulong();
-            s_aux.assign(s, i + 4 , 4);
-            std::bitset<4> bs2(s_aux);
-            unsigned n2 = bs2.to_ulong();
-            c[k] = static_cast<unsigned char>(n * 16) + static_cast<unsigned char>(n2);
-            k++;
+            bytes.put(0, 8 - remainder);
         }
-
-    std::string ret(c, c + k / sizeof(c[0]));
-    return ret;
+    bytes.put_bin(s);
+    return std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size_bytes());
 }
 
 
 std::string Rtcm::binary_data_to_bin(const std::string& s) const
 {
-    std::string s_aux;
-    std::stringstream ss;
-
+    std::string s_aux(8 * s.length(), '0');
     for(unsigned int i = 0; i < s.length(); i++)
         {
-            unsigned char val = static_cast<unsigned char>(s.at(i));
-            std::bitset<8> bs(val);
-            ss << bs;
+            unsigned char val = static_cast<unsigned char>(s[i]);
+            for(unsigned int k = 0; k < 8; k++)
+                {
+                    if(val & (0x80 >> k))
+                        {
+                            s_aux[8 * i + k] = '1';
+                        }
+                }
         }
-
-    s_aux = ss.str();
     return s_aux;
 }
 
 
 std::string Rtcm::bin_to_hex(const std::string& s) const
 {
+    // the leading bits that do not complete a nibble form the first symbol
+    static const char hex_symbols[] = "0123456789ABCDEF";
     std::string s_aux;
-    std::stringstream ss;
-    int remainder = static_cast<int>(std::fmod(s.length(), 4));
-
-    if (remainder != 0)
-        {
-            s_aux.assign(s, 0 , remainder);
-            boost::dynamic_bitset<> rembits(s_aux);
-            unsigned n = rembits.to_ulong();
-            ss << std::hex << n;
-        }
-
-    unsigned int start = std::max(remainder, 0);
-    for(unsigned int i = start; i < s.length() - 1; i = i + 4)
+    s_aux.reserve(s.length() / 4 + 1);
+    unsigned int remainder = s.length() % 4;
+    unsigned int nibble = 0;
+    unsigned int n_bits = (remainder == 0) ? 0 : 4 - remainder;
+    for(unsigned int i = 0; i < s.length(); i++)
         {
-            s_aux.assign(s, i, 4);
-            std::bitset<4> bs(s_aux);
-            unsigned n = bs.to_ulong();
-            ss << std::hex << n;
+            nibble = (nibble << 1) | (s[i] == '1');
+            if(++n_bits == 4)
+                {
+                    s_aux += hex_symbols[nibble];
+                    nibble = 0;
+                    n_bits = 0;
+                }
         }
-    return boost::to_upper_copy(ss.str());
+    return s_aux;
 }
 
 
 std::string Rtcm::hex_to_bin(const std::string& s) const
 {
     std::string s_aux;
-    s_aux.clear();
-    std::stringstream ss;
-    ss << s;
-    std::string s_lower = boost::to_upper_copy(ss.str());
+    s_aux.reserve(4 * s.length());
     for(unsigned int i = 0; i < s.length(); i++)
         {
-            unsigned long int n;
-            std::istringstream(s_lower.substr(i,1)) >> std::hex >> n;
-            std::bitset<4> bs(n);
-            s_aux += bs.to_string();
+            char c = s[i];
+            unsigned int n = 0;
+            if(c >= '0' && c <= '9') n = c - '0';
+            else if(c >= 'A' && c <= 'F') n = c - 'A' + 10;
+            else if(c >= 'a' && c <= 'f') n = c - 'a' + 10;
+            for(int k = 3; k >= 0; k--)
+                {
+                    s_aux += ((n >> k) & 1) ? '1' : '0';
+                }
         }
     return s_aux;
 }
@@ -362,17 +325,26 @@ long int Rtcm::hex_to_int(const std::string& s) const
 
 std::string Rtcm::build_message(const std::string & data) const
 {
-    unsigned int msg_length_bits = data.length();
-    unsigned int msg_length_bytes = std::ceil(static_cast<float>(msg_length_bits) / 8.0);
-    std::bitset<10> message_length = std::bitset<10>(msg_length_bytes);
-    unsigned int zeros_to_fill = 8 * msg_length_bytes -  msg_length_bits;
-    std::string b(zeros_to_fill, '0');
-    std::string msg_content = data + b;
-    std::string msg_without_crc = preamble.to_string() +
-            reserved_field.to_string() +
-            message_length.to_string() +
-            msg_content;
-    return Rtcm::add_CRC(msg_without_crc);
+    Rtcm_Bit_Writer message;
+    message.put_bin(data);
+    return build_message(message);
+}
+
+
+std::string Rtcm::build_message(const Rtcm_Bit_Writer & data) const
+{
+    unsigned int msg_length_bytes = data.size_bytes(); // the last byte is padded with zeros
+    Rtcm_Bit_Writer & frame = d_frame;
+    frame.clear();
+    frame.put(preamble);
+    frame.put(reserved_field);
+    frame.put(msg_length_bytes, 10);
+    for(unsigned int i = 0; i < msg_length_bytes; i++)
+        {
+            frame.put(data.data()[i], 8);
+        }
+    frame.put(crc24q(frame.data(), frame.size_bytes()), 24);
+    return std::string(reinterpret_cast<const char*>(frame.data()), frame.size_bytes());
 }
 
 
@@ -395,7 +367,6 @@ std::bitset<64> Rtcm::get_MT1001_4_header(unsigned int msg_number, double obs_ti
         unsigned int ref_id, unsigned int smooth_int, bool sync_flag, bool divergence_free)
 {
     unsigned int reference_station_id = ref_id; // Max: 4095
-    const std::map<int, Gnss_Synchro> pseudoranges_ = pseudoranges;
     bool synchronous_GNSS_flag = sync_flag;
     bool divergence_free_smoothing_indicator = divergence_free;
     unsigned int smoothing_interval = smooth_int;
@@ -403,7 +374,7 @@ std::bitset<64> Rtcm::get_MT1001_4_header(unsigned int msg_number, double obs_ti
     Rtcm::set_DF003(reference_station_id);
     Rtcm::set_DF004(obs_time);
     Rtcm::set_DF005(synchronous_GNSS_flag);
-    Rtcm::set_DF006(pseudoranges_);
+    Rtcm::set_DF006(pseudoranges);
     Rtcm::set_DF007(divergence_free_smoothing_indicator);
     Rtcm::set_DF008(smoothing_interval);
 
@@ -464,17 +435,18 @@ std::string Rtcm::print_MT1001(const Gps_Ephemeris & gps_eph, double obs_time, c
         }
 
     std::bitset<64> header = Rtcm::get_MT1001_4_header(1001, obs_time, pseudorangesL1, ref_id, smooth_int, sync_flag, divergence_free);
-    std::string data = header.to_string();
+    d_data.clear();
+    d_data.put(header);
 
     for(pseudoranges_iter = pseudorangesL1.begin();
             pseudoranges_iter != pseudorangesL1.end();
             pseudoranges_iter++)
         {
             std::bitset<58> content = Rtcm::get_MT1001_sat_content(gps_eph, obs_time, pseudoranges_iter->second);
-            data += content.to_string();
+            d_data.put(content);
         }
 
-    std::string msg = build_message(data);
+    std::string msg = build_message(d_data);
     if(server_is_running)
         {
             rtcm_message_queue->push(msg);
@@ -514,17 +486,18 @@ std::string Rtcm::print_MT1002(const Gps_Ephemeris & gps_eph, double obs_time, c
         }
 
     std::bitset<64> header = Rtcm::get_MT1001_4_header(1002, obs_time, pseudorangesL1, ref_id, smooth_int, sync_flag, divergence_free);
-    std::string data = header.to_string();
+    d_data.clear();
+    d_data.put(header);
 
     for(pseudoranges_iter = pseudorangesL1.begin();
             pseudoranges_iter != pseudorangesL1.end();
             pseudoranges_iter++)
         {
             std::bitset<74> content = Rtcm::get_MT1002_sat_content(gps_eph, obs_time, pseudoranges_iter->second);
-            data += content.to_string();
+            d_data.put(content);
         }
 
-    std::string msg = build_message(data);
+    std::string msg = build_message(d_data);
     if(server_is_running)
         {
             rtcm_message_queue->push(msg);
@@ -541,6 +514,8 @@ std::bitset<74> Rtcm::get_MT1002_sat_content(const Gps_Ephemeris & eph, double o
     Rtcm::set_DF011(gnss_synchro);
     Rtcm::set_DF012(gnss_synchro);
     Rtcm::set_DF013(eph, obs_time, gnss_synchro);
+    Rtcm::set_DF014(gnss_synchro);
+    Rtcm::set_DF015(gnss_synchro);
 
     std::string content = DF009.to_string() +
             DF010.to_string() +
@@ -618,17 +593,18 @@ std::string Rtcm::print_MT1003(const Gps_Ephemeris & ephL1, const Gps_CNAV_Ephem
         }
 
     std::bitset<64> header = Rtcm::get_MT1001_4_header(1003, obs_time, pseudorangesL1_with_L2, ref_id, smooth_int, sync_flag, divergence_free);
-    std::string data = header.to_string();
+    d_data.clear();
+    d_data.put(header);
 
     for(common_pseudoranges_iter = common_pseudoranges.begin();
             common_pseudoranges_iter != common_pseudoranges.end();
             common_pseudoranges_iter++)
         {
             std::bitset<101> content = Rtcm::get_MT1003_sat_content(ephL1, ephL2, obs_time, common_pseudoranges_iter->first, common_pseudoranges_iter->second);
-            data += content.to_string();
+            d_data.put(content);
         }
 
-    std::string msg = build_message(data);
+    std::string msg = build_message(d_data);
     if(server_is_running)
         {
             rtcm_message_queue->push(msg);
@@ -728,17 +704,18 @@ std::string Rtcm::print_MT1004(const Gps_Ephemeris & ephL1, const Gps_CNAV_Ephem
         }
 
     std::bitset<64> header = Rtcm::get_MT1001_4_header(1004, obs_time, pseudorangesL1_with_L2, ref_id, smooth_int, sync_flag, divergence_free);
-    std::string data = header.to_string();
+    d_data.clear();
+    d_data.put(header);
 
     for(common_pseudoranges_iter = common_pseudoranges.begin();
             common_pseudoranges_iter != common_pseudoranges.end();
             common_pseudoranges_iter++)
         {
             std::bitset<125> content = Rtcm::get_MT1004_sat_content(ephL1, ephL2, obs_time, common_pseudoranges_iter->first, common_pseudoranges_iter->second);
-            data += content.to_string();
+            d_data.put(content);
         }
 
-    std::string msg = build_message(data);
+    std::string msg = build_message(d_data);
     if(server_is_running)
         {
             rtcm_message_queue->push(msg);
@@ -860,21 +837,22 @@ std::string Rtcm::print_MT1005( unsigned int ref_id, double ecef_x, double ecef_
     DF364 = std::bitset<2>(quarter_cycle_indicator);
     Rtcm::set_DF027(ecef_z);
 
-    std::string data = DF002.to_string() +
-            DF003.to_string() +
-            DF021.to_string() +
-            DF022.to_string() +
-            DF023.to_string() +
-            DF024.to_string() +
-            DF141.to_string() +
-            DF025.to_string() +
-            DF142.to_string() +
-            DF001_.to_string() +
-            DF026.to_string() +
-            DF364.to_string() +
-            DF027.to_string() ;
-
-    std::string msg = build_message(data);
+    d_data.clear();
+    d_data.put(DF002);
+    d_data.put(DF003);
+    d_data.put(DF021);
+    d_data.put(DF022);
+    d_data.put(DF023);
+    d_data.put(DF024);
+    d_data.put(DF141);
+    d_data.put(DF025);
+    d_data.put(DF142);
+    d_data.put(DF001_);
+    d_data.put(DF026);
+    d_data.put(DF364);
+    d_data.put(DF027);
+
+    std::string msg = build_message(d_data);
     if(server_is_running)
         {
             rtcm_message_queue->push(msg);
@@ -885,22 +863,20 @@ std::string Rtcm::print_MT1005( unsigned int ref_id, double ecef_x, double ecef_
 
 int Rtcm::read_MT1005(const std::string & message, unsigned int & ref_id, double & ecef_x, double & ecef_y, double & ecef_z, bool & gps, bool & glonass, bool & galileo)
 {
-    // Convert message to binary
-    std::string message_bin = Rtcm::binary_data_to_bin(message);
-
     if(!Rtcm::check_CRC(message) )
         {
             LOG(WARNING) << " Bad CRC detected in RTCM message MT1005";
             return 1;
         }
 
+    Rtcm_Bit_Reader bits(reinterpret_cast<const unsigned char*>(message.data()), message.length());
+
     // Check than the message number is correct
     unsigned int preamble_length = 8;
     unsigned int reserved_field_length = 6;
-    unsigned int index = preamble_length + reserved_field_length;
+    bits.skip(preamble_length + reserved_field_length);
 
-    unsigned int read_message_length = static_cast<unsigned int>(Rtcm::bin_to_uint(message_bin.substr(index, 10)));
-    index += 10;
+    unsigned int read_message_length = static_cast<unsigned int>(bits.get(10));
     if (read_message_length != 19)
         {
             LOG(WARNING) << " Message MT1005 with wrong length (19 bytes expected, " << read_message_length << " received)";
@@ -909,8 +885,7 @@ int Rtcm::read_MT1005(const std::string & message, unsigned int & ref_id, double
 
     unsigned int msg_number = 1005;
     Rtcm::set_DF002(msg_number);
-    std::bitset<12> read_msg_number(message_bin.substr(index, 12));
-    index += 12;
+    std::bitset<12> read_msg_number(bits.get(12));
 
     if (DF002 != read_msg_number)
         {
@@ -918,33 +893,24 @@ int Rtcm::read_MT1005(const std::string & message, unsigned int & ref_id, double
             return 1;
         }
 
+    ref_id = static_cast<unsigned int>(bits.get(12));
 
-    ref_id = Rtcm::bin_to_uint(message_bin.substr(index, 12));
-    index += 12;
-
-    index += 6; // ITRF year
-    gps = static_cast<bool>(Rtcm::bin_to_uint(message_bin.substr(index, 1)));
-    index += 1;
-
-    glonass = static_cast<bool>(Rtcm::bin_to_uint(message_bin.substr(index, 1)));
-    index += 1;
+    bits.skip(6); // ITRF year
+    gps = static_cast<bool>(bits.get(1));
+    glonass = static_cast<bool>(bits.get(1));
+    galileo = static_cast<bool>(bits.get(1));
 
-    galileo = static_cast<bool>(Rtcm::bin_to_uint(message_bin.substr(index, 1)));
-    index += 1;
+    bits.skip(1); // ref_station_indicator
 
-    index += 1; // ref_station_indicator
+    ecef_x = static_cast<double>(bits.get_signed(38)) / 10000.0;
 
-    ecef_x = Rtcm::bin_to_double(message_bin.substr(index, 38)) / 10000.0;
-    index += 38;
+    bits.skip(1); // single rx oscillator
+    bits.skip(1); // reserved
 
-    index += 1; // single rx oscillator
-    index += 1; // reserved
+    ecef_y = static_cast<double>(bits.get_signed(38)) / 10000.0;
 
-    ecef_y = Rtcm::bin_to_double(message_bin.substr(index, 38)) / 10000.0;
-    index += 38;
-
-    index += 2; // quarter cycle indicator
-    ecef_z = Rtcm::bin_to_double(message_bin.substr(index, 38)) / 10000.0;
+    bits.skip(2); // quarter cycle indicator
+    ecef_z = static_cast<double>(bits.get_signed(38)) / 10000.0;
 
     return 0;
 }
@@ -1111,46 +1077,45 @@ std::string Rtcm::print_MT1019(const Gps_Ephemeris & gps_eph)
     Rtcm::set_DF103(gps_eph);
     Rtcm::set_DF137(gps_eph);
 
-    std::string data;
-    data.clear();
-    data = DF002.to_string() +
-            DF009.to_string() +
-            DF076.to_string() +
-            DF077.to_string() +
-            DF078.to_string() +
-            DF079.to_string() +
-            DF071.to_string() +
-            DF081.to_string() +
-            DF082.to_string() +
-            DF083.to_string() +
-            DF084.to_string() +
-            DF085.to_string() +
-            DF086.to_string() +
-            DF087.to_string() +
-            DF088.to_string() +
-            DF089.to_string() +
-            DF090.to_string() +
-            DF091.to_string() +
-            DF092.to_string() +
-            DF093.to_string() +
-            DF094.to_string() +
-            DF095.to_string() +
-            DF096.to_string() +
-            DF097.to_string() +
-            DF098.to_string() +
-            DF099.to_string() +
-            DF100.to_string() +
-            DF101.to_string() +
-            DF102.to_string() +
-            DF103.to_string() +
-            DF137.to_string();
-
-    if (data.length() != 488)
-        {
-            LOG(WARNING) << "Bad-formatted RTCM MT1019 (488 bits expected, found " <<  data.length() << ")";
-        }
-
-    std::string msg = build_message(data);
+    d_data.clear();
+    d_data.put(DF002);
+    d_data.put(DF009);
+    d_data.put(DF076);
+    d_data.put(DF077);
+    d_data.put(DF078);
+    d_data.put(DF079);
+    d_data.put(DF071);
+    d_data.put(DF081);
+    d_data.put(DF082);
+    d_data.put(DF083);
+    d_data.put(DF084);
+    d_data.put(DF085);
+    d_data.put(DF086);
+    d_data.put(DF087);
+    d_data.put(DF088);
+    d_data.put(DF089);
+    d_data.put(DF090);
+    d_data.put(DF091);
+    d_data.put(DF092);
+    d_data.put(DF093);
+    d_data.put(DF094);
+    d_data.put(DF095);
+    d_data.put(DF096);
+    d_data.put(DF097);
+    d_data.put(DF098);
+    d_data.put(DF099);
+    d_data.put(DF100);
+    d_data.put(DF101);
+    d_data.put(DF102);
+    d_data.put(DF103);
+    d_data.put(DF137);
+
+    if (d_data.size_bits() != 488)
+        {
+            LOG(WARNING) << "Bad-formatted RTCM MT1019 (488 bits expected, found " <<  d_data.size_bits() << ")";
+        }
+
+    std::string msg = build_message(d_data);
     if(server_is_running)
         {
             rtcm_message_queue->push(msg);
@@ -1395,44 +1360,43 @@ std::string Rtcm::print_MT1045(const Galileo_Ephemeris & gal_eph)
     unsigned int seven_zero = 0;
     std::bitset<7> DF001_ = std::bitset<7>(seven_zero);
 
-    std::string data;
-    data.clear();
-    data = DF002.to_string() +
-            DF252.to_string() +
-            DF289.to_string() +
-            DF290.to_string() +
-            DF291.to_string() +
-            DF292.to_string() +
-            DF293.to_string() +
-            DF294.to_string() +
-            DF295.to_string() +
-            DF296.to_string() +
-            DF297.to_string() +
-            DF298.to_string() +
-            DF299.to_string() +
-            DF300.to_string() +
-            DF301.to_string() +
-            DF302.to_string() +
-            DF303.to_string() +
-            DF304.to_string() +
-            DF305.to_string() +
-            DF306.to_string() +
-            DF307.to_string() +
-            DF308.to_string() +
-            DF309.to_string() +
-            DF310.to_string() +
-            DF311.to_string() +
-            DF312.to_string() +
-            DF314.to_string() +
-            DF315.to_string() +
-            DF001_.to_string();
-
-    if (data.length() != 496)
-        {
-            LOG(WARNING) << "Bad-formatted RTCM MT1045 (496 bits expected, found " <<  data.length() << ")";
-        }
-
-    std::string msg = build_message(data);
+    d_data.clear();
+    d_data.put(DF002);
+    d_data.put(DF252);
+    d_data.put(DF289);
+    d_data.put(DF290);
+    d_data.put(DF291);
+    d_data.put(DF292);
+    d_data.put(DF293);
+    d_data.put(DF294);
+    d_data.put(DF295);
+    d_data.put(DF296);
+    d_data.put(DF297);
+    d_data.put(DF298);
+    d_data.put(DF299);
+    d_data.put(DF300);
+    d_data.put(DF301);
+    d_data.put(DF302);
+    d_data.put(DF303);
+    d_data.put(DF304);
+    d_data.put(DF305);
+    d_data.put(DF306);
+    d_data.put(DF307);
+    d_data.put(DF308);
+    d_data.put(DF309);
+    d_data.put(DF310);
+    d_data.put(DF311);
+    d_data.put(DF312);
+    d_data.put(DF314);
+    d_data.put(DF315);
+    d_data.put(DF001_);
+
+    if (d_data.size_bits() != 496)
+        {
+            LOG(WARNING) << "Bad-formatted RTCM MT1045 (496 bits expected, found " <<  d_data.size_bits() << ")";
+        }
+
+    std::string msg = build_message(d_data);
     if(server_is_running)
         {
             rtcm_message_queue->push(msg);
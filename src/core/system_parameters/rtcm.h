@@ -37,6 +37,7 @@
 #include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <thread>
@@ -49,6 +50,7 @@
 #include "galileo_fnav_message.h"
 #include "gps_navigation_message.h"
 #include "gps_cnav_navigation_message.h"
+#include "rtcm_bits.h"
 
 
 /*!
@@ -83,7 +85,13 @@
 class Rtcm
 {
 public:
-    Rtcm(unsigned short port = 2101); //<! Default constructor that sets TCP port of the RTCM message server and RTCM Station ID. 2101 is the standard RTCM port according to the Internet Assigned Numbers Authority (IANA). See https://www.iana.org/assignments/service-names-port-numbers/service-names-port-numbers.xml
+    /*!
+     * \brief Default constructor that sets TCP port of the RTCM message server and RTCM Station ID. 2101 is the standard RTCM port according to the Internet Assigned Numbers Authority (IANA). See https://www.iana.org/assignments/service-names-port-numbers/service-names-port-numbers.xml
+     *
+     * server_threads is the number of threads serving the clients. If ntrip_mountpoint is not empty,
+     * the server acts as a NTRIP caster of that mountpoint instead of sending the messages to every connected client.
+     */
+    Rtcm(unsigned short port = 2101, unsigned int server_threads = 1, const std::string & ntrip_mountpoint = "");
     ~Rtcm();
 
     /*!
@@ -347,6 +355,8 @@ private:
     // Classes for TCP communication
     //
     unsigned short RTCM_port;
+    unsigned int server_threads;
+    std::string ntrip_mountpoint;
     //unsigned short RTCM_Station_ID;
     class Rtcm_Message
     {
@@ -437,58 +447,101 @@ private:
     {
     public:
         virtual ~Rtcm_Listener() {}
-        virtual void deliver(const Rtcm_Message & msg) = 0;
+        virtual void deliver(const std::shared_ptr<const Rtcm_Message> & msg) = 0;
     };
 
 
+    /*!
+     * \brief Set of the connected clients. Each frame is stored once and its
+     * clients share it, so the cost of a delivery does not grow with the message size.
+     */
     class Rtcm_Listener_Room
     {
     public:
         void join(std::shared_ptr<Rtcm_Listener> participant)
         {
-            participants_.insert(participant);
-            for (auto msg: recent_msgs_)
+            std::deque<std::shared_ptr<const Rtcm_Message> > recent;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                participants_.insert(participant);
+                recent = recent_msgs_;
+            }
+            for (auto msg: recent)
                 participant->deliver(msg);
         }
 
         void leave(std::shared_ptr<Rtcm_Listener> participant)
         {
+            std::lock_guard<std::mutex> lock(mutex_);
             participants_.erase(participant);
         }
 
         void deliver(const Rtcm_Message & msg)
         {
-            recent_msgs_.push_back(msg);
-            while (recent_msgs_.size() > max_recent_msgs)
-                recent_msgs_.pop_front();
-
-            for (auto participant: participants_)
-                participant->deliver(msg);
+            std::shared_ptr<const Rtcm_Message> frame = std::make_shared<const Rtcm_Message>(msg);
+            std::set<std::shared_ptr<Rtcm_Listener> > participants;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                recent_msgs_.push_back(frame);
+                while (recent_msgs_.size() > max_recent_msgs)
+                    recent_msgs_.pop_front();
+                participants = participants_;
+            }
+
+            for (auto participant: participants)
+                participant->deliver(frame);
         }
 
     private:
         std::set<std::shared_ptr<Rtcm_Listener> > participants_;
         enum { max_recent_msgs = 1 };
-        std::deque<Rtcm_Message> recent_msgs_;
+        std::deque<std::shared_ptr<const Rtcm_Message> > recent_msgs_;
+        std::mutex mutex_;
     };
 
 
+    /*!
+     * \brief Connection with one client. The handlers of a session run in its
+     * strand, so the io_service can be run by several threads.
+     *
+     * If ntrip_mountpoint is not empty the session behaves as a NTRIP 1.0 caster:
+     * the client receives data only after requesting the mountpoint
+     * ("GET /mountpoint"), and any other request is answered with the sourcetable.
+     */
     class Rtcm_Session
             : public Rtcm_Listener,
               public std::enable_shared_from_this<Rtcm_Session>
     {
     public:
-        Rtcm_Session(boost::asio::ip::tcp::socket socket, Rtcm_Listener_Room & room) : socket_(std::move(socket)), room_(room)   { }
+        Rtcm_Session(boost::asio::io_service& io_service, boost::asio::ip::tcp::socket socket, Rtcm_Listener_Room & room, const std::string & ntrip_mountpoint) : socket_(std::move(socket)), strand_(io_service), room_(room), ntrip_mountpoint_(ntrip_mountpoint) { }
 
         void start()
         {
-            room_.join(shared_from_this());
+            if (ntrip_mountpoint_.empty())
+                {
+                    room_.join(shared_from_this());
+                }
             do_read_message_header();
         }
 
-        void deliver(const Rtcm_Message & msg)
+        void deliver(const std::shared_ptr<const Rtcm_Message> & msg)
+        {
+            auto self(shared_from_this());
+            strand_.post([this, self, msg]()
+                    {
+                queue_message(msg);
+                    });
+        }
+
+    private:
+        void queue_message(const std::shared_ptr<const Rtcm_Message> & msg)
         {
             bool write_in_progress = !write_msgs_.empty();
+            if (write_msgs_.size() >= max_queued_msgs)
+                {
+                    // The client does not keep up: drop the oldest frame that is not being written
+                    write_msgs_.erase(write_msgs_.begin() + 1);
+                }
             write_msgs_.push_back(msg);
             if (!write_in_progress)
                 {
@@ -496,18 +549,22 @@ private:
                 }
         }
 
-    private:
         void do_read_message_header()
         {
             auto self(shared_from_this());
             boost::asio::async_read(socket_,
                     boost::asio::buffer(read_msg_.data(), Rtcm_Message::header_length),
-                    [this, self](boost::system::error_code ec, std::size_t /*length*/)
+                    strand_.wrap([this, self](boost::system::error_code ec, std::size_t /*length*/)
                     {
                 if (!ec && read_msg_.decode_header())
                     {
                         do_read_message_body();
                     }
+                else if(!ec && !joined_ntrip_ && !ntrip_mountpoint_.empty() && std::string(read_msg_.data(), 4).compare("GET ") == 0)
+                    {
+                        ntrip_request_ = std::string(read_msg_.data(), Rtcm_Message::header_length);
+                        do_read_ntrip_request();
+                    }
                 else if(!ec && !read_msg_.decode_header())
                     {
                         client_says += read_msg_.data();
@@ -529,7 +586,7 @@ private:
                         std::cout << "Closing connection with client from " << socket_.remote_endpoint().address() << std::endl;
                         room_.leave(shared_from_this());
                     }
-                    });
+                    }));
         }
 
         void do_read_message_body()
@@ -537,7 +594,7 @@ private:
             auto self(shared_from_this());
             boost::asio::async_read(socket_,
                     boost::asio::buffer(read_msg_.body(), read_msg_.body_length()),
-                    [this, self](boost::system::error_code ec, std::size_t /*length*/)
+                    strand_.wrap([this, self](boost::system::error_code ec, std::size_t /*length*/)
                     {
                 if (!ec)
                     {
@@ -552,15 +609,73 @@ private:
                         std::cout << "Closing connection with client from " << socket_.remote_endpoint().address() << std::endl;
                         room_.leave(shared_from_this());
                     }
-                    });
+                    }));
+        }
+
+        void do_read_ntrip_request()
+        {
+            auto self(shared_from_this());
+            boost::asio::async_read_until(socket_, ntrip_buffer_, "\r\n\r\n",
+                    strand_.wrap([this, self](boost::system::error_code ec, std::size_t /*length*/)
+                    {
+                if (!ec)
+                    {
+                        std::istream request_stream(&ntrip_buffer_);
+                        std::string request_line;
+                        std::getline(request_stream, request_line);
+                        ntrip_request_ += request_line;
+                        ntrip_buffer_.consume(ntrip_buffer_.size());
+                        answer_ntrip_request();
+                    }
+                else
+                    {
+                        std::cout << "Closing connection with client from " << socket_.remote_endpoint().address() << std::endl;
+                    }
+                    }));
+        }
+
+        void answer_ntrip_request()
+        {
+            // Request line: GET /mountpoint HTTP/1.0
+            std::size_t start = ntrip_request_.find('/');
+            std::size_t end = ntrip_request_.find(' ', 4);
+            std::string mountpoint;
+            if (start != std::string::npos && end != std::string::npos && start < end)
+                {
+                    mountpoint = ntrip_request_.substr(start + 1, end - start - 1);
+                }
+            if (mountpoint.compare(ntrip_mountpoint_) == 0)
+                {
+                    std::cout << "NTRIP client from " << socket_.remote_endpoint().address() << " requests mountpoint " << mountpoint << std::endl;
+                    queue_message(make_message("ICY 200 OK\r\n\r\n"));
+                    joined_ntrip_ = true;
+                    room_.join(shared_from_this());
+                    do_read_message_header();
+                }
+            else
+                {
+                    std::string sourcetable = "STR;" + ntrip_mountpoint_ + ";" + ntrip_mountpoint_ + ";RTCM 3.2;;2;GPS+GAL;;;0.00;0.00;0;0;GNSS-SDR;none;N;N;0;\r\nENDSOURCETABLE\r\n";
+                    std::string response = "SOURCETABLE 200 OK\r\nServer: GNSS-SDR\r\nContent-Type: text/plain\r\nContent-Length: " + std::to_string(sourcetable.length()) + "\r\n\r\n" + sourcetable;
+                    close_after_write_ = true;
+                    queue_message(make_message(response));
+                }
+        }
+
+        static std::shared_ptr<const Rtcm_Message> make_message(const std::string & text)
+        {
+            std::shared_ptr<Rtcm_Message> msg = std::make_shared<Rtcm_Message>();
+            msg->body_length(text.length());
+            std::memcpy(msg->body(), text.c_str(), msg->body_length());
+            msg->encode_header();
+            return msg;
         }
 
         void do_write()
         {
             auto self(shared_from_this());
             boost::asio::async_write(socket_,
-                    boost::asio::buffer(write_msgs_.front().body(),
-                            write_msgs_.front().body_length()), [this, self](boost::system::error_code ec, std::size_t /*length*/)
+                    boost::asio::buffer(write_msgs_.front()->body(),
+                            write_msgs_.front()->body_length()), strand_.wrap([this, self](boost::system::error_code ec, std::size_t /*length*/)
                             {
                 if(!ec)
                     {
@@ -569,20 +684,33 @@ private:
                             {
                                 do_write();
                             }
+                        else if(close_after_write_)
+                            {
+                                boost::system::error_code ignored_ec;
+                                socket_.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored_ec);
+                                socket_.close(ignored_ec);
+                            }
                     }
                 else
                     {
                         std::cout << "Closing connection with client from " << socket_.remote_endpoint().address() << std::endl;
                         room_.leave(shared_from_this());
                     }
-                            });
+                            }));
         }
 
         boost::asio::ip::tcp::socket socket_;
+        boost::asio::io_service::strand strand_;
         Rtcm_Listener_Room & room_;
         Rtcm_Message read_msg_;
-        std::deque<Rtcm_Message> write_msgs_;
+        enum { max_queued_msgs = 64 };
+        std::deque<std::shared_ptr<const Rtcm_Message> > write_msgs_;
         std::string client_says;
+        std::string ntrip_mountpoint_;
+        std::string ntrip_request_;
+        boost::asio::streambuf ntrip_buffer_;
+        bool joined_ntrip_ = false;
+        bool close_after_write_ = false;
     };
 
 
@@ -592,19 +720,19 @@ private:
     public:
         Tcp_Internal_Client(boost::asio::io_service& io_service,
                 boost::asio::ip::tcp::resolver::iterator endpoint_iterator)
-    : io_service_(io_service), socket_(io_service)
+    : io_service_(io_service), socket_(io_service), strand_(io_service)
     {
             do_connect(endpoint_iterator);
     }
 
         void close()
         {
-            io_service_.post([this]() { socket_.close(); });
+            strand_.post([this]() { socket_.close(); });
         }
 
         void write(const Rtcm_Message & msg)
         {
-            io_service_.post(
+            strand_.post(
                     [this, msg]()
                     {
                 bool write_in_progress = !write_msgs_.empty();
@@ -637,7 +765,7 @@ private:
         {
             boost::asio::async_read(socket_,
                     boost::asio::buffer(read_msg_.data(), 1029),
-                    [this](boost::system::error_code ec, std::size_t /*length*/)
+                    strand_.wrap([this](boost::system::error_code ec, std::size_t /*length*/)
                     {
                 if (!ec )
                     {
@@ -648,7 +776,7 @@ private:
                         std::cout << "Error in client" << std::endl;
                         socket_.close();
                     }
-                    });
+                    }));
         }
 
         void do_write()
@@ -656,7 +784,7 @@ private:
 
             boost::asio::async_write(socket_,
                     boost::asio::buffer(write_msgs_.front().data(), write_msgs_.front().length()),
-                    [this](boost::system::error_code ec, std::size_t /*length*/)
+                    strand_.wrap([this](boost::system::error_code ec, std::size_t /*length*/)
                     {
                 if (!ec)
                     {
@@ -670,11 +798,12 @@ private:
                     {
                         socket_.close();
                     }
-                    });
+                    }));
         }
 
         boost::asio::io_service& io_service_;
         boost::asio::ip::tcp::socket socket_;
+        boost::asio::io_service::strand strand_;
         Rtcm_Message read_msg_;
         std::deque<Rtcm_Message> write_msgs_;
     };
@@ -716,8 +845,8 @@ private:
     class Tcp_Server
     {
     public:
-        Tcp_Server(boost::asio::io_service& io_service, const boost::asio::ip::tcp::endpoint& endpoint)
-    : io_service_(io_service), acceptor_(io_service), socket_(io_service)
+        Tcp_Server(boost::asio::io_service& io_service, const boost::asio::ip::tcp::endpoint& endpoint, const std::string & ntrip_mountpoint)
+    : io_service_(io_service), acceptor_(io_service), socket_(io_service), ntrip_mountpoint_(ntrip_mountpoint)
     {
             acceptor_.open(endpoint.protocol());
             acceptor_.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
@@ -749,7 +878,7 @@ private:
                                 std::cout << "Starting RTCM TCP server session..." << std::endl;
                                 std::cout << "Serving client from " << socket_.remote_endpoint().address() << std::endl;
                             }
-                        std::make_shared<Rtcm_Session>(std::move(socket_), room_)->start();
+                        std::make_shared<Rtcm_Session>(io_service_, std::move(socket_), room_, ntrip_mountpoint_)->start();
                     }
                 else
                     {
@@ -763,6 +892,7 @@ private:
         boost::asio::ip::tcp::acceptor acceptor_;
         boost::asio::ip::tcp::socket socket_;
         Rtcm_Listener_Room room_;
+        std::string ntrip_mountpoint_;
         bool first_client = true;
     };
 
@@ -782,6 +912,9 @@ private:
     std::bitset<6> reserved_field;
     std::string add_CRC(const std::string & m) const;
     std::string build_message(const std::string & data) const; // adds 0s to complete a byte and adds the CRC
+    std::string build_message(const Rtcm_Bit_Writer & data) const; // frames packed data, padded to a byte, and adds the CRC
+    mutable Rtcm_Bit_Writer d_frame; // reused by build_message()
+    Rtcm_Bit_Writer d_data;          // message contents, reused by the print_MTxxxx functions
 
     //
     // Data Fields
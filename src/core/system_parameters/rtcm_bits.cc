@@ -0,0 +1,107 @@
+/*!
+ * \file rtcm_bits.cc
+ * \brief Packed bit writer and reader of the RTCM 3 transport layer
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "rtcm_bits.h"
+
+
+void Rtcm_Bit_Writer::put(unsigned long long value, unsigned int n_bits)
+{
+    while (n_bits > 0)
+        {
+            unsigned int used = d_bits % 8;
+            if (used == 0)
+                {
+                    d_bytes.resize(d_bits / 8 + 1, 0);
+                }
+            unsigned int n_free = 8 - used;
+            unsigned int n_take = (n_bits < n_free) ? n_bits : n_free;
+            unsigned int chunk = static_cast<unsigned int>(value >> (n_bits - n_take)) & ((1u << n_take) - 1u);
+            d_bytes.back() |= static_cast<unsigned char>(chunk << (n_free - n_take));
+            d_bits += n_take;
+            n_bits -= n_take;
+        }
+}
+
+
+void Rtcm_Bit_Writer::put_bin(const std::string& symbols)
+{
+    // in 32 bit chunks, so most of the work is done a word at a time
+    unsigned long long word = 0;
+    unsigned int n_word = 0;
+    for (std::string::const_iterator it = symbols.begin(); it != symbols.end(); ++it)
+        {
+            word = (word << 1) | static_cast<unsigned long long>(*it == '1');
+            if (++n_word == 32)
+                {
+                    put(word, 32);
+                    word = 0;
+                    n_word = 0;
+                }
+        }
+    if (n_word > 0)
+        {
+            put(word, n_word);
+        }
+}
+
+
+unsigned long long Rtcm_Bit_Reader::get(unsigned int n_bits)
+{
+    unsigned long long value = 0;
+    if (d_position + n_bits > d_bits)
+        {
+            d_overrun = true;
+            d_position += n_bits;
+            return 0;
+        }
+    while (n_bits > 0)
+        {
+            unsigned int used = d_position % 8;
+            unsigned int n_left = 8 - used;
+            unsigned int n_take = (n_bits < n_left) ? n_bits : n_left;
+            unsigned int byte = d_data[d_position / 8];
+            value = (value << n_take) | ((byte >> (n_left - n_take)) & ((1u << n_take) - 1u));
+            d_position += n_take;
+            n_bits -= n_take;
+        }
+    return value;
+}
+
+
+long long Rtcm_Bit_Reader::get_signed(unsigned int n_bits)
+{
+    unsigned long long value = get(n_bits);
+    if (n_bits > 0 && n_bits < 64 && (value >> (n_bits - 1)) & 1ULL)
+        {
+            value |= ~0ULL << n_bits; // sign extension
+        }
+    return static_cast<long long>(value);
+}
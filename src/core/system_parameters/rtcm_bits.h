@@ -0,0 +1,142 @@
+/*!
+ * \file rtcm_bits.h
+ * \brief Packed bit writer and reader of the RTCM 3 transport layer
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_RTCM_BITS_H_
+#define GNSS_SDR_RTCM_BITS_H_
+
+#include <bitset>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Appends bit fields, most significant bit first, to a byte buffer
+ *
+ * The data fields of the RTCM messages are written straight into the bytes
+ * that go on the wire, without an intermediate string of '0' and '1'
+ * symbols. The buffer keeps its memory when cleared, so a long lived writer
+ * does not allocate once it has seen the largest message.
+ */
+class Rtcm_Bit_Writer
+{
+public:
+    Rtcm_Bit_Writer() : d_bits(0) {}
+
+    void clear()
+    {
+        d_bytes.clear();
+        d_bits = 0;
+    }
+
+    /*!
+     * \brief Appends the n_bits (up to 64) least significant bits of value
+     */
+    void put(unsigned long long value, unsigned int n_bits);
+
+    /*!
+     * \brief Appends a data field, most significant bit first
+     */
+    template<std::size_t N>
+    void put(const std::bitset<N>& field)
+    {
+        if (N <= 64)
+            {
+                put(field.to_ullong(), N);
+                return;
+            }
+        const std::bitset<N> mask(0xFFFFFFFFULL);
+        std::size_t n = N;
+        while (n > 0)
+            {
+                std::size_t n_chunk = (n % 32 == 0) ? 32 : n % 32;
+                put(((field >> (n - n_chunk)) & mask).to_ullong(), n_chunk);
+                n -= n_chunk;
+            }
+    }
+
+    /*!
+     * \brief Appends a string of '0' and '1' symbols
+     */
+    void put_bin(const std::string& symbols);
+
+    /*!
+     * \brief Appends zeros up to the next byte boundary
+     */
+    void pad_to_byte()
+    {
+        d_bits = 8 * d_bytes.size();
+    }
+
+    std::size_t size_bits() const { return d_bits; }
+    std::size_t size_bytes() const { return d_bytes.size(); }
+    const unsigned char* data() const { return d_bytes.empty() ? 0 : &d_bytes[0]; }
+
+private:
+    std::vector<unsigned char> d_bytes;
+    std::size_t d_bits;
+};
+
+
+/*!
+ * \brief Reads bit fields, most significant bit first, from a byte buffer
+ *
+ * Reading past the end of the buffer returns zeros and sets overrun().
+ */
+class Rtcm_Bit_Reader
+{
+public:
+    Rtcm_Bit_Reader(const unsigned char* data, std::size_t n_bytes) :
+        d_data(data), d_bits(8 * n_bytes), d_position(0), d_overrun(false) {}
+
+    /*!
+     * \brief Reads an unsigned field of n_bits (up to 64)
+     */
+    unsigned long long get(unsigned int n_bits);
+
+    /*!
+     * \brief Reads a two's complement field of n_bits (up to 64)
+     */
+    long long get_signed(unsigned int n_bits);
+
+    void skip(unsigned int n_bits) { d_position += n_bits; }
+
+    std::size_t position() const { return d_position; }
+    std::size_t remaining_bits() const { return d_position < d_bits ? d_bits - d_position : 0; }
+    bool overrun() const { return d_overrun; }
+
+private:
+    const unsigned char* d_data;
+    std::size_t d_bits;
+    std::size_t d_position;
+    bool d_overrun;
+};
+
+#endif
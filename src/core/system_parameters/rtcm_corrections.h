@@ -0,0 +1,97 @@
+/*!
+ * \file rtcm_corrections.h
+ * \brief Differential corrections decoded from the RTCM 3 messages of a
+ * reference station
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_RTCM_CORRECTIONS_H_
+#define GNSS_SDR_RTCM_CORRECTIONS_H_
+
+/*!
+ * \brief Code observation of one satellite at a reference station
+ */
+struct Rtcm_Observation
+{
+    unsigned int prn;
+    double pseudorange_m;    //!< Pseudorange [m], modulo one light millisecond if !ambiguity_known
+    bool ambiguity_known;    //!< False if the message (MT1001, MT1003, MSM1-3) leaves out the integer milliseconds
+    double phaserange_m;     //!< Phaserange minus pseudorange [m], 0 if the message has none
+    double cn0_db_hz;        //!< 0 if the message has none
+    unsigned int lock_indicator;
+};
+
+
+/*!
+ * \brief Observations of one GNSS at a reference station in one epoch
+ * (message types 1001-1004 and MSM1-7), in fixed storage so that they can
+ * be copied from thread to thread without allocations
+ */
+struct Rtcm_Observation_Epoch
+{
+    enum { max_observations = 64 };
+
+    char system;              //!< 'G' or 'E'
+    unsigned int message_type;
+    unsigned int station_id;
+    double tow_s;             //!< Epoch time, in the time of week of the system [s]
+    unsigned int count;       //!< Number of valid entries of observations
+    Rtcm_Observation observations[max_observations];
+};
+
+
+/*!
+ * \brief Antenna reference point of a reference station (message types 1005 and 1006)
+ */
+struct Rtcm_Reference_Station
+{
+    unsigned int station_id;
+    double ecef_x_m;
+    double ecef_y_m;
+    double ecef_z_m;
+    double antenna_height_m; //!< 0 for message type 1005
+};
+
+
+/*!
+ * \brief What Rtcm_Decoder found in one message
+ */
+struct Rtcm_Corrections
+{
+    enum Content
+    {
+        NONE,        //!< A message type without corrections
+        OBSERVATIONS,
+        STATION
+    };
+
+    Content content;
+    Rtcm_Observation_Epoch epoch;     //!< If content is OBSERVATIONS
+    Rtcm_Reference_Station station;   //!< If content is STATION
+};
+
+#endif
@@ -0,0 +1,435 @@
+/*!
+ * \file rtcm_decoder.cc
+ * \brief In place framing and decoding of the RTCM 3 messages that carry
+ * the observations and the position of a reference station
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "rtcm_decoder.h"
+#include <cstring>
+#include "GPS_L1_CA.h"
+#include "crc24q.h"
+#include "rtcm_bits.h"
+
+namespace
+{
+const unsigned char RTCM_PREAMBLE = 0xD3;
+const double LIGHT_MS_M = GPS_C_m_s * 1e-3; // one light millisecond [m]
+
+// Start of the data of a frame and its length in bytes
+const unsigned char* frame_data(const unsigned char* frame, std::size_t & n_bytes)
+{
+    n_bytes = ((static_cast<std::size_t>(frame[1]) & 0x03) << 8) | frame[2];
+    return frame + 3;
+}
+
+// L1 C/A code of GPS (1C), and any E1 signal of Galileo (1C, 1A, 1B, 1X, 1Z):
+// the signal IDs of the MSM signal mask
+bool l1_signal(char system, unsigned int signal_id)
+{
+    if (system == 'G')
+        {
+            return signal_id == 2;
+        }
+    return signal_id >= 2 and signal_id <= 6;
+}
+}
+
+
+Rtcm_Decoder::Rtcm_Decoder()
+{
+    d_frames = 0;
+    d_crc_errors = 0;
+}
+
+
+Rtcm_Decoder::Frame_Status Rtcm_Decoder::frame(const unsigned char* data, std::size_t n_bytes, std::size_t & frame_bytes)
+{
+    frame_bytes = 0;
+    if (n_bytes == 0)
+        {
+            return NEED_MORE;
+        }
+    if (data[0] != RTCM_PREAMBLE)
+        {
+            const void* next = std::memchr(data, RTCM_PREAMBLE, n_bytes);
+            frame_bytes = next ? static_cast<const unsigned char*>(next) - data : n_bytes;
+            return SKIP;
+        }
+    if (n_bytes < 3)
+        {
+            return NEED_MORE;
+        }
+    if ((data[1] & 0xFC) != 0)
+        {
+            // the reserved bits are zero: this preamble is part of the data
+            frame_bytes = 1;
+            return SKIP;
+        }
+    std::size_t message_bytes;
+    frame_data(data, message_bytes);
+    const std::size_t length = 3 + message_bytes + 3;
+    if (n_bytes < length)
+        {
+            return NEED_MORE;
+        }
+    const unsigned int crc = (static_cast<unsigned int>(data[length - 3]) << 16)
+            | (static_cast<unsigned int>(data[length - 2]) << 8)
+            | data[length - 1];
+    if (crc24q(data, length - 3) != crc)
+        {
+            d_crc_errors++;
+            frame_bytes = 1;
+            return SKIP;
+        }
+    d_frames++;
+    frame_bytes = length;
+    return FRAME;
+}
+
+
+unsigned int Rtcm_Decoder::message_type(const unsigned char* frame, std::size_t frame_bytes)
+{
+    if (frame_bytes < 8)
+        {
+            return 0;
+        }
+    return (static_cast<unsigned int>(frame[3]) << 4) | (frame[4] >> 4);
+}
+
+
+bool Rtcm_Decoder::decode(const unsigned char* frame, std::size_t frame_bytes, Rtcm_Corrections & corrections)
+{
+    corrections.content = Rtcm_Corrections::NONE;
+    const unsigned int type = message_type(frame, frame_bytes);
+    bool ok = true;
+    if (type >= 1001 and type <= 1004)
+        {
+            ok = decode_legacy(type, frame, frame_bytes, corrections.epoch);
+            corrections.content = Rtcm_Corrections::OBSERVATIONS;
+        }
+    else if ((type >= 1071 and type <= 1077 and type != 1072) or (type >= 1091 and type <= 1097 and type != 1092))
+        {
+            // MSM2 has phaseranges only
+            ok = decode_msm(type, frame, frame_bytes, corrections.epoch);
+            corrections.content = Rtcm_Corrections::OBSERVATIONS;
+        }
+    else if (type == 1005 or type == 1006)
+        {
+            ok = decode_station(type, frame, frame_bytes, corrections.station);
+            corrections.content = Rtcm_Corrections::STATION;
+        }
+    if (!ok)
+        {
+            corrections.content = Rtcm_Corrections::NONE;
+        }
+    return ok;
+}
+
+
+bool Rtcm_Decoder::decode_legacy(unsigned int type, const unsigned char* frame, std::size_t frame_bytes, Rtcm_Observation_Epoch & epoch)
+{
+    std::size_t n_bytes;
+    Rtcm_Bit_Reader bits(frame_data(frame, n_bytes), n_bytes);
+    if (frame_bytes < n_bytes + 6)
+        {
+            return false;
+        }
+
+    // header: DF002 to DF008
+    epoch.system = 'G';
+    epoch.message_type = static_cast<unsigned int>(bits.get(12));
+    epoch.station_id = static_cast<unsigned int>(bits.get(12));
+    epoch.tow_s = static_cast<double>(bits.get(30)) * 1e-3;
+    bits.skip(1); // synchronous GNSS flag
+    const unsigned int n_sat = static_cast<unsigned int>(bits.get(5));
+    bits.skip(1 + 3); // smoothing
+    epoch.count = 0;
+
+    const bool extended = (type == 1002 or type == 1004);
+    const bool l2 = (type == 1003 or type == 1004);
+    for (unsigned int i = 0; i < n_sat; i++)
+        {
+            Rtcm_Observation & obs = epoch.observations[epoch.count];
+            obs.prn = static_cast<unsigned int>(bits.get(6));        // DF009
+            bits.skip(1);                                             // DF010, code indicator
+            const double pseudorange_m = static_cast<double>(bits.get(24)) * 0.02; // DF011
+            const long long phase = bits.get_signed(20);              // DF012
+            obs.lock_indicator = static_cast<unsigned int>(bits.get(7)); // DF013
+            obs.ambiguity_known = extended;
+            obs.pseudorange_m = pseudorange_m;
+            obs.cn0_db_hz = 0.0;
+            if (extended)
+                {
+                    obs.pseudorange_m += static_cast<double>(bits.get(8)) * LIGHT_MS_M; // DF014
+                    obs.cn0_db_hz = static_cast<double>(bits.get(8)) * 0.25; // DF015
+                }
+            obs.phaserange_m = phase == -524288 ? 0.0 : static_cast<double>(phase) * 0.0005;
+            if (l2)
+                {
+                    bits.skip(2 + 14 + 20 + 7); // DF016 to DF019
+                    if (extended)
+                        {
+                            bits.skip(8); // DF020
+                        }
+                }
+            if (obs.prn >= 1 and obs.prn <= 32)
+                {
+                    epoch.count++;
+                }
+        }
+    return !bits.overrun();
+}
+
+
+bool Rtcm_Decoder::decode_msm(unsigned int type, const unsigned char* frame, std::size_t frame_bytes, Rtcm_Observation_Epoch & epoch)
+{
+    std::size_t n_bytes;
+    Rtcm_Bit_Reader bits(frame_data(frame, n_bytes), n_bytes);
+    if (frame_bytes < n_bytes + 6)
+        {
+            return false;
+        }
+    const unsigned int msm = type % 10;
+
+    // header
+    epoch.system = type < 1090 ? 'G' : 'E';
+    epoch.message_type = static_cast<unsigned int>(bits.get(12));
+    epoch.station_id = static_cast<unsigned int>(bits.get(12));
+    epoch.tow_s = static_cast<double>(bits.get(30)) * 1e-3;
+    bits.skip(1 + 3 + 7 + 2 + 2 + 1 + 3); // DF393, DF409, reserved, DF411, DF412, DF417, DF418
+    epoch.count = 0;
+
+    unsigned int prn[Rtcm_Observation_Epoch::max_observations];
+    unsigned int n_sat = 0;
+    const unsigned long long satellite_mask = bits.get(64); // DF394
+    for (unsigned int i = 0; i < 64; i++)
+        {
+            if (satellite_mask & (1ULL << (63 - i)))
+                {
+                    prn[n_sat++] = i + 1;
+                }
+        }
+    unsigned int signal_id[32];
+    unsigned int n_sig = 0;
+    const unsigned long long signal_mask = bits.get(32); // DF395
+    for (unsigned int i = 0; i < 32; i++)
+        {
+            if (signal_mask & (1ULL << (31 - i)))
+                {
+                    signal_id[n_sig++] = i + 1;
+                }
+        }
+    if (n_sat * n_sig > 64)
+        {
+            return false;
+        }
+
+    // DF396: the cells of each satellite, and which of them is the L1 / E1 code
+    int cell_satellite[64];
+    bool cell_l1[64];
+    unsigned int n_cell = 0;
+    for (unsigned int s = 0; s < n_sat; s++)
+        {
+            for (unsigned int k = 0; k < n_sig; k++)
+                {
+                    if (bits.get(1))
+                        {
+                            cell_satellite[n_cell] = s;
+                            cell_l1[n_cell] = l1_signal(epoch.system, signal_id[k]);
+                            n_cell++;
+                        }
+                }
+        }
+
+    // satellite data, one field of all the satellites after the other
+    double rough_ms[64];
+    bool rough_valid[64];
+    const bool integer_ms = (msm >= 4);
+    for (unsigned int s = 0; s < n_sat; s++)
+        {
+            rough_ms[s] = 0.0;
+            rough_valid[s] = true;
+            if (integer_ms)
+                {
+                    const unsigned int int_ms = static_cast<unsigned int>(bits.get(8)); // DF397
+                    rough_valid[s] = (int_ms != 255);
+                    rough_ms[s] = static_cast<double>(int_ms);
+                }
+        }
+    if (msm == 5 or msm == 7)
+        {
+            bits.skip(4 * n_sat); // extended satellite information
+        }
+    for (unsigned int s = 0; s < n_sat; s++)
+        {
+            rough_ms[s] += static_cast<double>(bits.get(10)) / 1024.0; // DF398
+        }
+    if (msm == 5 or msm == 7)
+        {
+            bits.skip(14 * n_sat); // DF399
+        }
+
+    // signal data, one field of all the cells after the other
+    const bool code = (msm != 2);
+    const bool phase = (msm != 1);
+    const bool high_resolution = (msm >= 6);
+    const double code_lsb = high_resolution ? TWO_N29 : TWO_N24;
+    const double phase_lsb = high_resolution ? TWO_N31 : TWO_N29;
+    const long long code_invalid = high_resolution ? -524288 : -16384;
+    const long long phase_invalid = high_resolution ? -8388608 : -2097152;
+    long long fine_code[64];
+    long long fine_phase[64];
+    unsigned int lock[64];
+    double cnr[64];
+    for (unsigned int c = 0; c < n_cell; c++)
+        {
+            fine_code[c] = code ? bits.get_signed(high_resolution ? 20 : 15) : code_invalid; // DF400 / DF405
+        }
+    for (unsigned int c = 0; c < n_cell; c++)
+        {
+            fine_phase[c] = phase ? bits.get_signed(high_resolution ? 24 : 22) : phase_invalid; // DF401 / DF406
+        }
+    for (unsigned int c = 0; c < n_cell; c++)
+        {
+            lock[c] = phase ? static_cast<unsigned int>(bits.get(high_resolution ? 10 : 4)) : 0; // DF402 / DF407
+        }
+    if (phase)
+        {
+            bits.skip(n_cell); // DF420, half-cycle ambiguity
+        }
+    for (unsigned int c = 0; c < n_cell; c++)
+        {
+            cnr[c] = 0.0;
+            if (msm >= 4)
+                {
+                    cnr[c] = high_resolution ? static_cast<double>(bits.get(10)) * 0.0625 // DF408
+                                             : static_cast<double>(bits.get(6));          // DF403
+                }
+        }
+    if (msm == 5 or msm == 7)
+        {
+            bits.skip(15 * n_cell); // DF404
+        }
+    if (bits.overrun())
+        {
+            return false;
+        }
+
+    bool used[64] = {false};
+    for (unsigned int c = 0; c < n_cell; c++)
+        {
+            const int s = cell_satellite[c];
+            if (!cell_l1[c] or used[s] or !rough_valid[s] or fine_code[c] == code_invalid)
+                {
+                    continue;
+                }
+            used[s] = true;
+            Rtcm_Observation & obs = epoch.observations[epoch.count++];
+            obs.prn = prn[s];
+            obs.pseudorange_m = (rough_ms[s] + static_cast<double>(fine_code[c]) * code_lsb) * LIGHT_MS_M;
+            obs.ambiguity_known = integer_ms;
+            obs.phaserange_m = fine_phase[c] == phase_invalid ? 0.0
+                    : (static_cast<double>(fine_phase[c]) * phase_lsb - static_cast<double>(fine_code[c]) * code_lsb) * LIGHT_MS_M;
+            obs.cn0_db_hz = cnr[c];
+            obs.lock_indicator = lock[c];
+        }
+    return true;
+}
+
+
+bool Rtcm_Decoder::decode_station(unsigned int type, const unsigned char* frame, std::size_t frame_bytes, Rtcm_Reference_Station & station)
+{
+    std::size_t n_bytes;
+    Rtcm_Bit_Reader bits(frame_data(frame, n_bytes), n_bytes);
+    if (frame_bytes < n_bytes + 6)
+        {
+            return false;
+        }
+    bits.skip(12); // DF002
+    station.station_id = static_cast<unsigned int>(bits.get(12));
+    bits.skip(6 + 3 + 1); // ITRF year, GNSS indicators, reference station indicator
+    station.ecef_x_m = static_cast<double>(bits.get_signed(38)) * 1e-4;
+    bits.skip(1 + 1); // single receiver oscillator, reserved
+    station.ecef_y_m = static_cast<double>(bits.get_signed(38)) * 1e-4;
+    bits.skip(2); // quarter cycle indicator
+    station.ecef_z_m = static_cast<double>(bits.get_signed(38)) * 1e-4;
+    station.antenna_height_m = 0.0;
+    if (type == 1006)
+        {
+            station.antenna_height_m = static_cast<double>(bits.get(16)) * 1e-4;
+        }
+    return !bits.overrun();
+}
+
+
+bool Rtcm_Decoder::read_ephemeris(const unsigned char* frame, std::size_t frame_bytes, Gps_Ephemeris & gps_eph)
+{
+    if (message_type(frame, frame_bytes) != 1019)
+        {
+            return false;
+        }
+    std::size_t n_bytes;
+    Rtcm_Bit_Reader bits(frame_data(frame, n_bytes), n_bytes);
+    if (frame_bytes < n_bytes + 6)
+        {
+            return false;
+        }
+    bits.skip(12); // DF002
+    gps_eph.i_satellite_PRN = static_cast<unsigned int>(bits.get(6));
+    gps_eph.i_GPS_week = static_cast<int>(bits.get(10));
+    gps_eph.i_SV_accuracy = static_cast<int>(bits.get(4));
+    gps_eph.i_code_on_L2 = static_cast<int>(bits.get(2));
+    gps_eph.d_IDOT = static_cast<double>(bits.get_signed(14)) * I_DOT_LSB;
+    gps_eph.d_IODE_SF2 = static_cast<double>(bits.get(8));
+    gps_eph.d_IODE_SF3 = gps_eph.d_IODE_SF2;
+    gps_eph.d_Toc = static_cast<double>(bits.get(16)) * T_OC_LSB;
+    gps_eph.d_A_f2 = static_cast<double>(bits.get_signed(8)) * A_F2_LSB;
+    gps_eph.d_A_f1 = static_cast<double>(bits.get_signed(16)) * A_F1_LSB;
+    gps_eph.d_A_f0 = static_cast<double>(bits.get_signed(22)) * A_F0_LSB;
+    gps_eph.d_IODC = static_cast<double>(bits.get(10));
+    gps_eph.d_Crs = static_cast<double>(bits.get_signed(16)) * C_RS_LSB;
+    gps_eph.d_Delta_n = static_cast<double>(bits.get_signed(16)) * DELTA_N_LSB;
+    gps_eph.d_M_0 = static_cast<double>(bits.get_signed(32)) * M_0_LSB;
+    gps_eph.d_Cuc = static_cast<double>(bits.get_signed(16)) * C_UC_LSB;
+    gps_eph.d_e_eccentricity = static_cast<double>(bits.get(32)) * E_LSB;
+    gps_eph.d_Cus = static_cast<double>(bits.get_signed(16)) * C_US_LSB;
+    gps_eph.d_sqrt_A = static_cast<double>(bits.get(32)) * SQRT_A_LSB;
+    gps_eph.d_Toe = static_cast<double>(bits.get(16)) * T_OE_LSB;
+    gps_eph.d_Cic = static_cast<double>(bits.get_signed(16)) * C_IC_LSB;
+    gps_eph.d_OMEGA0 = static_cast<double>(bits.get_signed(32)) * OMEGA_0_LSB;
+    gps_eph.d_Cis = static_cast<double>(bits.get_signed(16)) * C_IS_LSB;
+    gps_eph.d_i_0 = static_cast<double>(bits.get_signed(32)) * I_0_LSB;
+    gps_eph.d_Crc = static_cast<double>(bits.get_signed(16)) * C_RC_LSB;
+    gps_eph.d_OMEGA = static_cast<double>(bits.get_signed(32)) * OMEGA_LSB;
+    gps_eph.d_OMEGA_DOT = static_cast<double>(bits.get_signed(24)) * OMEGA_DOT_LSB;
+    gps_eph.d_TGD = static_cast<double>(bits.get_signed(8)) * T_GD_LSB;
+    gps_eph.i_SV_health = static_cast<int>(bits.get(6));
+    gps_eph.b_L2_P_data_flag = static_cast<bool>(bits.get(1));
+    gps_eph.b_fit_interval_flag = static_cast<bool>(bits.get(1));
+    return !bits.overrun();
+}
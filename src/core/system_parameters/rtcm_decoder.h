@@ -0,0 +1,100 @@
+/*!
+ * \file rtcm_decoder.h
+ * \brief In place framing and decoding of the RTCM 3 messages that carry
+ * the observations and the position of a reference station
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_RTCM_DECODER_H_
+#define GNSS_SDR_RTCM_DECODER_H_
+
+#include <cstddef>
+#include "gps_ephemeris.h"
+#include "rtcm_corrections.h"
+
+/*!
+ * \brief Frames and decodes RTCM 3 messages where they are, in the receive
+ * buffer of the connection, with Rtcm_Bit_Reader instead of strings of '0'
+ * and '1' symbols
+ *
+ * The observations of message types 1001-1004 and of the GPS (1071-1077) and
+ * Galileo (1091-1097) MSM1-7 go into a Rtcm_Observation_Epoch, keeping the L1 / E1
+ * code of each satellite, and the positions of message types 1005 and 1006
+ * into a Rtcm_Reference_Station. The other message types are framed and
+ * skipped.
+ */
+class Rtcm_Decoder
+{
+public:
+    enum Frame_Status
+    {
+        FRAME,     //!< A message with a good CRC starts at data
+        NEED_MORE, //!< data holds the start of a message that is not complete yet
+        SKIP       //!< No message starts at data
+    };
+
+    static const std::size_t max_frame_bytes = 3 + 1023 + 3; //!< Header, longest message and CRC
+
+    Rtcm_Decoder();
+
+    /*!
+     * \brief Looks for a message at the start of the n_bytes of data
+     *
+     * \param[out] frame_bytes  Length of the whole frame for FRAME, number
+     * of bytes to drop before the next candidate preamble for SKIP
+     */
+    Frame_Status frame(const unsigned char* data, std::size_t n_bytes, std::size_t & frame_bytes);
+
+    /*!
+     * \brief Message type (DF002) of a frame that frame() accepted
+     */
+    static unsigned int message_type(const unsigned char* frame, std::size_t frame_bytes);
+
+    /*!
+     * \brief Decodes a frame that frame() accepted. Returns false if its
+     * content is inconsistent with its message type.
+     */
+    bool decode(const unsigned char* frame, std::size_t frame_bytes, Rtcm_Corrections & corrections);
+
+    /*!
+     * \brief Decodes a message type 1019 (GPS ephemeris) that frame() accepted
+     */
+    static bool read_ephemeris(const unsigned char* frame, std::size_t frame_bytes, Gps_Ephemeris & gps_eph);
+
+    unsigned long int frames() const { return d_frames; }         //!< Messages with a good CRC
+    unsigned long int crc_errors() const { return d_crc_errors; } //!< Candidate frames with a bad CRC
+
+private:
+    bool decode_legacy(unsigned int type, const unsigned char* frame, std::size_t frame_bytes, Rtcm_Observation_Epoch & epoch);
+    bool decode_msm(unsigned int type, const unsigned char* frame, std::size_t frame_bytes, Rtcm_Observation_Epoch & epoch);
+    bool decode_station(unsigned int type, const unsigned char* frame, std::size_t frame_bytes, Rtcm_Reference_Station & station);
+
+    unsigned long int d_frames;
+    unsigned long int d_crc_errors;
+};
+
+#endif
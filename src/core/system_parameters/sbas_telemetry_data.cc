@@ -47,6 +47,36 @@
 
 
 
+void Sbas_Frame::clear()
+{
+    std::memset(d_bytes, 0, BYTES);
+    d_size = 0;
+}
+
+
+void Sbas_Frame::push_back(int bit)
+{
+    for (unsigned int i = 0; i < BYTES - 1; i++)
+        {
+            d_bytes[i] = (d_bytes[i] << 1) | (d_bytes[i + 1] >> 7);
+        }
+    // the padding shifts into the last bit of the frame, which takes the new bit
+    d_bytes[BYTES - 1] = (d_bytes[BYTES - 1] << 1) | (bit ? 0x40 : 0x00);
+    if (d_size < BITS) d_size++;
+}
+
+
+void Sbas_Frame::invert()
+{
+    for (unsigned int i = 0; i < BYTES - 1; i++)
+        {
+            d_bytes[i] = ~d_bytes[i];
+        }
+    d_bytes[BYTES - 1] ^= 0xC0;
+}
+
+
+
 Sbas_Telemetry_Data::Sbas_Telemetry_Data()
 {
     fp_trace = nullptr; // file pointer of trace
@@ -78,6 +108,12 @@ int Sbas_Telemetry_Data::update(Sbas_Raw_Msg sbas_raw_msg)
     // express the rx time in terms of GPS time
     sbas_raw_msg.relate(mt12_time_ref);
 
+    if (!sbas_raw_msg.crc_ok())
+        {
+            VLOG(FLOW) << "<<T>> CRC error in message from PRN" << sbas_raw_msg.get_prn();
+            return -1;
+        }
+
     int mt = sbas_raw_msg.get_msg_type();
     // update internal state
     if(mt == 12) parsing_result = decode_mt12(sbas_raw_msg);
@@ -86,17 +122,12 @@ int Sbas_Telemetry_Data::update(Sbas_Raw_Msg sbas_raw_msg)
         {
             // use RTKLIB to parse the message -> updates d_nav structure
             sbsmsg_t sbas_raw_msg_rtklib;
-            std::vector<unsigned char> msg_bytes = sbas_raw_msg.get_msg();
             // cast raw message to RTKLIB raw message struct
             sbas_raw_msg_rtklib.prn = sbas_raw_msg.get_prn();
             //sbas_raw_msg_rtklib.tow = sbas_raw_msg.get_tow();
             //sbas_raw_msg_rtklib.week = sbas_raw_msg.get_week();
             sbas_raw_msg_rtklib.sample_stamp = sbas_raw_msg.get_sample_stamp();
-            for (std::vector<unsigned char>::const_iterator it = msg_bytes.begin(); it != msg_bytes.end() - 3; ++it)
-                {
-                    int i = it - msg_bytes.begin();
-                    sbas_raw_msg_rtklib.msg[i] = *it;
-                }
+            std::memcpy(sbas_raw_msg_rtklib.msg, sbas_raw_msg.data(), Sbas_Frame::BYTES - 3);
             parsing_result = sbsupdatecorr(&sbas_raw_msg_rtklib, &d_nav);
             VLOG(FLOW) << "<<T>> RTKLIB parsing result: " << parsing_result;
         }
@@ -138,7 +169,7 @@ int getbits(const unsigned char *buff, int pos, int len);
 int Sbas_Telemetry_Data::decode_mt12(Sbas_Raw_Msg sbas_raw_msg)
 {
     const double rx_delay = 38000.0/300000.0; // estimated sbas signal geosat to ground signal travel time
-    unsigned char * msg = sbas_raw_msg.get_msg().data();
+    const unsigned char * msg = sbas_raw_msg.data();
     uint32_t gps_tow = getbitu(msg, 121, 20);
     uint32_t gps_week = getbitu(msg, 141, 10) + 1024; // consider last gps time week overflow
     double gps_tow_rx = double(gps_tow) + rx_delay;
@@ -40,6 +40,7 @@
 #include <vector>
 #include "boost/assign.hpp"
 #include "concurrent_queue.h"
+#include "crc24q.h"
 #include "sbas_time.h"
 
 
@@ -50,6 +51,51 @@ struct Long_Term_Correction;
 class Sbas_Ephemeris;
 
 
+/*!
+ * \brief The last 250 bits of an SBAS bit stream, packed most significant
+ * bit first in 32 bytes with 6 bits of zero padding at the back
+ *
+ * This is the byte layout of Sbas_Raw_Msg. Since the CRC-24Q of the frame
+ * has a zero initial value, the padding does not change it, and the
+ * remainder over the 32 bytes is zero for a valid frame. One table lookup
+ * per byte makes the check cheap enough for every candidate offset.
+ */
+class Sbas_Frame
+{
+public:
+    static const unsigned int BITS = 250;
+    static const unsigned int BYTES = 32;
+
+    Sbas_Frame() { clear(); }
+    void clear();
+
+    /*!
+     * \brief Shifts a bit in at the back. Once the frame is full, the first
+     * bit falls out at the front.
+     */
+    void push_back(int bit);
+
+    unsigned int size() const { return d_size; }
+    bool full() const { return d_size == BITS; }
+
+    //! First 8 bits, one of the three rotating preambles for a frame
+    unsigned char preamble() const { return d_bytes[0]; }
+
+    //! Inverts the 250 bits, for a PLL locked with the opposite sign
+    void invert();
+
+    //! The CRC-24Q remainder over the frame and its parity is zero
+    bool crc_ok() const { return crc24q(d_bytes, BYTES) == 0; }
+
+    const unsigned char* data() const { return d_bytes; }
+    std::vector<unsigned char> bytes() const { return std::vector<unsigned char>(d_bytes, d_bytes + BYTES); }
+
+private:
+    unsigned char d_bytes[BYTES];
+    unsigned int d_size;
+};
+
+
 /*!
  * \brief Represents a raw SBAS message of 250cbits + 6 bits padding
  *  (8b preamble + 6b message type + 212b data + 24b CRC + 6b zero padding)
@@ -77,11 +123,17 @@ public:
     }
     int get_crc()
     {
-        unsigned char crc_last_byte = (d_msg[30] << 2) && (d_msg[31] >> 6);
-        unsigned char crc_middle_byte = (d_msg[29] << 2) && (d_msg[30] >> 6);
-        unsigned char crc_first_byte = (d_msg[28] << 2) && (d_msg[29] >> 6);
-        return ((unsigned int)(crc_first_byte) << 16) && ((unsigned int)(crc_middle_byte) << 8) && crc_last_byte;
+        unsigned char crc_last_byte = (d_msg[30] << 2) | (d_msg[31] >> 6);
+        unsigned char crc_middle_byte = (d_msg[29] << 2) | (d_msg[30] >> 6);
+        unsigned char crc_first_byte = (d_msg[28] << 2) | (d_msg[29] >> 6);
+        return ((unsigned int)(crc_first_byte) << 16) | ((unsigned int)(crc_middle_byte) << 8) | crc_last_byte;
+    }
+    //! The message has all its 32 bytes and a zero CRC-24Q remainder
+    bool crc_ok() const
+    {
+        return d_msg.size() == Sbas_Frame::BYTES and crc24q(&d_msg[0], d_msg.size()) == 0;
     }
+    const unsigned char* data() const { return d_msg.empty() ? 0 : &d_msg[0]; }
 private:
     Sbas_Time rx_time;
     int i_prn;                        /* SBAS satellite PRN number */
@@ -0,0 +1,57 @@
+/*!
+ * \file spectrum_metrics.h
+ * \brief Power and coarse spectrum of the samples of a signal conditioner
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_SPECTRUM_METRICS_H_
+#define GNSS_SDR_SPECTRUM_METRICS_H_
+
+/*!
+ * \brief Input power and spectrum of a signal conditioner, against their
+ * noise floor.
+ *
+ * The spectrum_monitor_sink of a conditioner publishes them in
+ * Receiver_State::spectrum_map, keyed by conditioner, once per report of
+ * its Spectrum_Monitor. A jammer or the takeover of a spoofer shows as a
+ * rise of the power over the floor, or as a change of the shape of the
+ * spectrum, well before the tracking loops or the navigation message do.
+ */
+struct Spectrum_Metrics
+{
+    unsigned long int sample_counter; //!< Samples monitored at the end of the report
+    float power_db;                   //!< Mean power of the report [dB], relative to full scale
+    float floor_db;                   //!< Noise floor, the slow mean of the power [dB]
+    float floor_sigma_db;             //!< Standard deviation of the power around the floor [dB]
+    float deviation_db;               //!< Largest change of a bin of the normalized spectrum from its mean [dB]
+    float flatness;                   //!< Geometric over arithmetic mean of the spectrum, 1 for white noise
+    bool anomaly;                     //!< The power rise or the deviation is over the threshold
+    unsigned int onsets;              //!< Anomalies started so far
+};
+
+#endif
@@ -30,7 +30,8 @@
 #ifndef GNSS_SDR_SPOOFING_MESSAGE_H_
 #define GNSS_SDR_SPOOFING_MESSAGE_H_
 
-#include "spoofing_message.h"
+#include <set>
+#include <string>
 
 /*!
  * \brief This is the class that contains the information that is shared
@@ -43,6 +44,7 @@ public:
     std::set<unsigned int> satellites;
     std::string description;
     std::string spoofing_report;
+    unsigned int suppressed = 0; //!< Alarms with the same case and satellites dropped since the previous one
 };
 
 #endif
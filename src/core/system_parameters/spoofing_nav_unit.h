@@ -0,0 +1,94 @@
+/*!
+ * \file spoofing_nav_unit.h
+ * \brief Navigation message unit of any constellation, for the spoofing detector
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_SPOOFING_NAV_UNIT_H_
+#define GNSS_SDR_SPOOFING_NAV_UNIT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "gps_subframe_words.h"
+
+/*!
+ * \brief A unit of navigation message decoded by a channel: a GPS L1 C/A
+ * subframe or a Galileo E1B I/NAV word.
+ *
+ * The checks that only need the timing of the units, or that compare the
+ * bits that all the satellites of a constellation broadcast alike, take
+ * this instead of the decoded message, so that they work for every
+ * constellation. TOW and time_ms are the d_TOW_hybrid_at_current_symbol
+ * and the tracking timestamp of the same symbol, as used by the
+ * observables, so the units of all the constellations share one time base.
+ */
+struct Spoofing_Nav_Unit
+{
+    char system;            //!< 'G' for GPS, 'E' for Galileo
+    unsigned int PRN;
+    unsigned int uid;       //!< of the tracked peak, 0 if the acquisition does not set it
+    int unit_id;            //!< GPS subframe id, Galileo word type
+    int week;               //!< week number of the constellation, 0 if not known yet
+    double TOW;             //!< GPS time of week of the symbol at time_ms [s]
+    double time_ms;         //!< receiver time of that symbol [ms]
+    std::vector<uint8_t> payload; //!< bits of the unit, see set_words() and set_bits()
+
+    /*!
+     * \brief Stores the ten words of a GPS subframe, four bytes each, most
+     * significant byte first
+     */
+    void set_words(const Gps_Subframe_Words& subframe)
+    {
+        payload.resize(40);
+        for (int i = 0; i < 10; i++)
+            {
+                for (int j = 0; j < 4; j++)
+                    {
+                        payload[4 * i + j] = (subframe.words[i] >> (24 - 8 * j)) & 0xFF;
+                    }
+            }
+    }
+
+    /*!
+     * \brief Packs a string of '0' and '1' characters into payload, most
+     * significant bit first, as the data bits of a Galileo word
+     */
+    void set_bits(const std::string& bits)
+    {
+        payload.assign((bits.size() + 7) / 8, 0);
+        for (std::size_t i = 0; i < bits.size(); i++)
+            {
+                if (bits[i] == '1')
+                    {
+                        payload[i / 8] |= 0x80 >> (i % 8);
+                    }
+            }
+    }
+};
+
+#endif
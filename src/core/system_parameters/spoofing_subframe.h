@@ -0,0 +1,48 @@
+/*!
+ * \file spoofing_subframe.h
+ * \brief Navigation subframe record shared by the spoofing detection checks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_SPOOFING_SUBFRAME_H_
+#define GNSS_SDR_SPOOFING_SUBFRAME_H_
+
+#include "gps_subframe_words.h"
+
+/*!
+ * \brief Last subframe decoded by a tracked peak (channel), identified by uid.
+ */
+struct Subframe{
+    Gps_Subframe_Words subframe;
+    unsigned int subframe_id;
+    unsigned int PRN;
+    double timestamp;
+    unsigned int toa;
+    unsigned int uid;
+};
+
+#endif
@@ -0,0 +1,63 @@
+/*!
+ * \file sqm_metrics.h
+ * \brief Signal quality monitoring metrics of a tracking channel, kept
+ * aside from Gnss_Synchro
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_SQM_METRICS_H_
+#define GNSS_SDR_SQM_METRICS_H_
+
+//! Most pairs of extra correlator taps a channel monitors
+#define SQM_MAX_PAIRS 4
+
+/*!
+ * \brief Correlation peak distortion metrics of a channel.
+ *
+ * A tracking channel with signal quality monitoring correlates, besides
+ * Early, Prompt and Late, a pair of taps at -d and +d chips from Prompt for
+ * each monitored spacing d. Sqm_Monitor averages them over a few code
+ * periods and publishes these metrics in Receiver_State::sqm_map, keyed by channel,
+ * once per average. For an undistorted peak, ratio is 1 - d and delta and
+ * asymmetry are 0. A reader checks PRN in case the channel has been
+ * reassigned since.
+ */
+struct Sqm_Metrics
+{
+    unsigned int PRN;                 //!< Satellite tracked when the metrics were stored
+    unsigned long int sample_counter; //!< Sample counter at the start of the last code period averaged
+    unsigned int n_pairs;
+    float spacing_chips[SQM_MAX_PAIRS];
+    float ratio[SQM_MAX_PAIRS];      //!< (E + L) / 2P of each pair
+    float delta[SQM_MAX_PAIRS];      //!< (E - L) / 2P of each pair
+    float asymmetry[SQM_MAX_PAIRS];  //!< (|E| - |L|) / (|E| + |L|) of each pair
+    float ratio_var[SQM_MAX_PAIRS];  //!< Variance of ratio over the last metrics of the window
+    float delta_var[SQM_MAX_PAIRS];  //!< Variance of delta over the last metrics of the window
+};
+
+#endif
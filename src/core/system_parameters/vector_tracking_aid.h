@@ -0,0 +1,51 @@
+/*!
+ * \file vector_tracking_aid.h
+ * \brief Carrier Doppler prediction that the PVT solution shares with the
+ * tracking channels
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_VECTOR_TRACKING_AID_H_
+#define GNSS_SDR_VECTOR_TRACKING_AID_H_
+
+/*!
+ * \brief Carrier Doppler of a satellite as predicted from the receiver
+ * velocity and clock drift of the last PVT solution.
+ *
+ * The PVT block publishes one of these per GPS PRN in
+ * Receiver_State::vector_tracking_map after every valid fix. A tracking channel
+ * whose own loops have lost the signal can coast on it, instead of
+ * dropping the satellite (see Tracking_1C.vector_tracking).
+ */
+struct Vector_Tracking_Aid
+{
+    double Tracking_timestamp_secs;  //!< Receiver time of the prediction, in the time scale of Gnss_Synchro::Tracking_timestamp_secs [s]
+    double Carrier_Doppler_hz;       //!< Predicted carrier Doppler at Tracking_timestamp_secs [Hz]
+    double Carrier_Doppler_rate_hz_s; //!< Change of the prediction since the previous fix [Hz/s]
+};
+
+#endif
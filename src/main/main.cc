@@ -49,13 +49,20 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <gnuradio/msg_queue.h>
+#include "batch_replay.h"
 #include "control_thread.h"
-#include "concurrent_queue.h"
+#include "concurrent_ring_queue.h"
 #include "concurrent_map.h"
 #include "concurrent_map_str.h"
+#include "concurrent_snapshot_map.h"
+#include "navigation_data_bus.h"
+#include "concurrent_subframe_map.h"
+#include "gnss_synchro.h"
 #include "gps_ephemeris.h"
 #include "gps_cnav_ephemeris.h"
 #include "gps_almanac.h"
+#include "gps_ref_location.h"
+#include "gps_ref_time.h"
 #include "gps_iono.h"
 #include "gps_cnav_iono.h"
 #include "gps_utc_model.h"
@@ -69,6 +76,10 @@
 #include "sbas_ephemeris.h"
 #include "sbas_time.h"
 #include "spoofing_message.h"
+#include "vector_tracking_aid.h"
+#include "correlator_taps.h"
+#include "sqm_metrics.h"
+#include "aoa_metrics.h"
 
 #if CUDA_GPU_ACCEL
     // For the CUDA runtime routines (prefixed with "cuda_")
@@ -78,46 +89,10 @@
 using google::LogMessage;
 
 DECLARE_string(log_dir);
+DECLARE_int32(batch_segments);
 
-/*
-* Concurrent queues that communicates the Telemetry Decoder
-* to the Observables modules
-*/
-
-// For GPS NAVIGATION (L1)
-concurrent_queue<Gps_Acq_Assist> global_gps_acq_assist_queue;
-concurrent_map<Gps_Acq_Assist> global_gps_acq_assist_map;
-//For spoofing detection
-struct GPS_time_t{
-    int week;
-    double TOW;
-    double timestamp;    
-    int subframe_id;
-};
-
-struct sEph{
-    Gps_Ephemeris ephemeris;
-    double time;
-    bool changed;
-};
-
-concurrent_map<GPS_time_t> global_gps_time;
-concurrent_map<sEph> global_sEph_map;
-concurrent_map<double> global_last_gps_time;
-concurrent_map<bool> global_spoofing_status;  //spoofing has been detected for the satellite
-
-struct Subframe{
-    std::string subframe;
-    unsigned int subframe_id;
-    unsigned int PRN;
-    double timestamp;
-    unsigned int toa;
-    unsigned int uid;
-};
-
-concurrent_map<Subframe> global_subframe_map;
-concurrent_map<std::map<unsigned int, unsigned int>> global_subframe_check;
-concurrent_queue<Spoofing_Message> global_spoofing_queue;
+// The tables shared by the blocks of the receiver are kept by its
+// flowgraph, see Receiver_State
 
 int main(int argc, char** argv)
 {
@@ -180,6 +155,14 @@ int main(int argc, char** argv)
                     std::cout << "Logging with be done at " << FLAGS_log_dir << std::endl;
                 }
         }
+    if (FLAGS_batch_segments > 0)
+        {
+            // every segment runs its own control thread, in a child process
+            int batch_result = run_batch_replay();
+            google::ShutDownCommandLineFlags();
+            std::cout << "GNSS-SDR program ended." << std::endl;
+            return batch_result;
+        }
     std::unique_ptr<ControlThread> control_thread(new ControlThread());
 
     // record startup time
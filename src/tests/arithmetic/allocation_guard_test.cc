@@ -0,0 +1,100 @@
+/*!
+ * \file allocation_guard_test.cc
+ * \brief Tests of the allocation counts of the block metrics
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "allocation_guard.h"
+#include "block_metrics.h"
+
+
+TEST(AllocationGuardTest, HotBlocksList)
+{
+    set_allocation_guard_hot(" tracking,telemetry ,, spoofing_check");
+    EXPECT_TRUE(allocation_guard_hot("tracking"));
+    EXPECT_TRUE(allocation_guard_hot("telemetry"));
+    EXPECT_TRUE(allocation_guard_hot("spoofing_check"));
+    EXPECT_FALSE(allocation_guard_hot("pvt"));
+    EXPECT_FALSE(allocation_guard_hot(""));
+    set_allocation_guard_hot("");
+    EXPECT_FALSE(allocation_guard_hot("tracking"));
+}
+
+
+TEST(AllocationGuardTest, CallsCountTheirAllocations)
+{
+    std::shared_ptr<Block_Metrics> metrics = make_block_metrics("test", "allocations");
+    set_block_metrics_enabled(true);
+    {
+        Block_Metrics_Scope scope(metrics.get(), 1);
+        std::vector<double> buffer(1000);
+        buffer[0] = 1.0;
+    }
+    {
+        Block_Metrics_Scope scope(metrics.get(), 1);
+    }
+    set_block_metrics_enabled(false);
+    Block_Metrics::Snapshot snapshot = metrics->snapshot();
+    EXPECT_EQ(2u, snapshot.calls);
+    if (allocation_guard_compiled())
+        {
+            EXPECT_EQ(1u, snapshot.allocations);
+            EXPECT_EQ(1000 * sizeof(double), snapshot.allocated_bytes);
+            std::string text = block_metrics_prometheus_text();
+            EXPECT_NE(std::string::npos, text.find("gnss_sdr_block_allocations_total{block=\"test\",instance=\"allocations\"} 1\n"));
+        }
+    else
+        {
+            EXPECT_EQ(0u, snapshot.allocations);
+            EXPECT_EQ(0u, snapshot.allocated_bytes);
+        }
+}
+
+
+TEST(AllocationGuardTest, HotBlockMayAllocateWhileWarmingUp)
+{
+    std::shared_ptr<Block_Metrics> metrics = make_block_metrics("test_hot", "warmup");
+    set_allocation_guard_hot("test_hot");
+    set_allocation_guard_warmup_calls(1);
+    set_allocation_guard_abort(true);
+    // the first call is in the warm-up, so it does not abort
+    metrics->add_call(std::chrono::microseconds(1), 1, 1);
+    metrics->add_allocations(3, 24);
+    metrics->add_call(std::chrono::microseconds(1), 1, 1);
+    metrics->add_allocations(0, 0);
+    Block_Metrics::Snapshot snapshot = metrics->snapshot();
+    EXPECT_EQ(3u, snapshot.allocations);
+    EXPECT_EQ(24u, snapshot.allocated_bytes);
+    set_allocation_guard_abort(false);
+    set_allocation_guard_warmup_calls(1000);
+    set_allocation_guard_hot("");
+}
@@ -0,0 +1,164 @@
+/*!
+ * \file aoa_monitor_test.cc
+ * \brief  This file implements tests for the angle of arrival estimator
+ * of a tracking channel and the AoA check of the spoofing detector
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cmath>
+#include <list>
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+#include "aoa_monitor.h"
+#include "aoa_metrics.h"
+#include "GPS_L1_CA.h"
+#include "concurrent_ring_queue.h"
+#include "receiver_state.h"
+#include "concurrent_map.h"
+#include "gnss_synchro.h"
+#include "in_memory_configuration.h"
+#include "spoofing_detector.h"
+#include "spoofing_message.h"
+
+
+namespace
+{
+// Prompt of the elements of a uniform linear array, half a wavelength apart
+void plane_wave(double angle_rad, double carrier_phase_rad, unsigned int n_elements, gr_complex* prompts)
+{
+    for (unsigned int k = 0; k < n_elements; k++)
+        {
+            double phase = carrier_phase_rad + GPS_PI * k * std::sin(angle_rad);
+            prompts[k] = gr_complex(100.0 * std::cos(phase), 100.0 * std::sin(phase));
+        }
+}
+
+Aoa_Metrics steering_of(unsigned int PRN, double angle_rad)
+{
+    Aoa_Monitor aoa(1, 4);
+    aoa.reset(PRN);
+    gr_complex prompts[AOA_MAX_ELEMENTS];
+    for (int period = 0; period < 4; period++)
+        {
+            plane_wave(angle_rad, 0.7 * period, 4, prompts);
+            aoa.add(prompts, 4, 1000 + period);
+        }
+    return aoa.metrics();
+}
+}
+
+
+TEST(AoaMonitorTest, Decimation)
+{
+    Aoa_Monitor disabled;
+    EXPECT_FALSE(disabled.enabled());
+    EXPECT_FALSE(disabled.next_period());
+
+    Aoa_Monitor aoa(5, 10);
+    EXPECT_TRUE(aoa.enabled());
+    int correlated = 0;
+    for (int period = 0; period < 20; period++)
+        {
+            if (aoa.next_period()) correlated++;
+        }
+    EXPECT_EQ(4, correlated);
+}
+
+
+TEST(AoaMonitorTest, Steering)
+{
+    Aoa_Monitor aoa(1, 4);
+    aoa.reset(5);
+    gr_complex prompts[AOA_MAX_ELEMENTS];
+    // the carrier phase and the data bit change from one period to the next
+    for (int period = 0; period < 3; period++)
+        {
+            plane_wave(0.5, 1.3 * period + (period == 1 ? GPS_PI : 0.0), 4, prompts);
+            EXPECT_FALSE(aoa.add(prompts, 4, 1000 + period));
+        }
+    plane_wave(0.5, 2.0, 4, prompts);
+    ASSERT_TRUE(aoa.add(prompts, 4, 1003));
+
+    const Aoa_Metrics& metrics = aoa.metrics();
+    EXPECT_EQ(5u, metrics.PRN);
+    EXPECT_EQ(1003u, metrics.sample_counter);
+    ASSERT_EQ(4u, metrics.n_elements);
+    EXPECT_NEAR(1.0, metrics.coherence, 1e-4);
+    EXPECT_NEAR(0.5, metrics.steering[0].real(), 1e-4);
+    EXPECT_NEAR(0.0, metrics.steering[0].imag(), 1e-4);
+    for (unsigned int k = 0; k < 4; k++)
+        {
+            EXPECT_NEAR(0.5, std::abs(metrics.steering[k]), 1e-4);
+            double expected = std::remainder(GPS_PI * k * std::sin(0.5), 2.0 * GPS_PI);
+            EXPECT_NEAR(expected, std::arg(metrics.steering[k]), 1e-3);
+        }
+    EXPECT_EQ(gr_complex(0.0, 0.0), metrics.steering[4]);
+}
+
+
+TEST(AoaMonitorTest, SameDirection)
+{
+    Spoofing_Message msg;
+    std::shared_ptr<Receiver_State> state = std::make_shared<Receiver_State>();
+    Receiver_State_Scope state_scope(state);
+
+    std::shared_ptr<InMemoryConfiguration> config = std::make_shared<InMemoryConfiguration>();
+    config->set_property("Spoofing.AoA", "true");
+    config->set_property("Spoofing.AoA_min_satellites", "3");
+    Spoofing_Detector detector(config.get());
+
+    std::vector<Gnss_Synchro> synchros(4);
+    std::vector<Gnss_Synchro*> in(4);
+    Channel_List channels;
+    for (unsigned int ch = 0; ch < 4; ch++)
+        {
+            synchros[ch].Channel_ID = ch;
+            synchros[ch].PRN = ch + 1;
+            in[ch] = &synchros[ch];
+            channels.push_back(ch);
+        }
+
+    // the satellites arrive from their own directions
+    state->aoa_map.write(0, steering_of(1, -0.9));
+    state->aoa_map.write(1, steering_of(2, -0.3));
+    state->aoa_map.write(2, steering_of(3, 0.3));
+    state->aoa_map.write(3, steering_of(4, 0.9));
+    detector.check_AoA(channels, in.data(), 2000);
+    EXPECT_FALSE(state->spoofing_queue.try_pop(msg));
+
+    // three of them from the direction of the spoofer
+    state->aoa_map.write(1, steering_of(2, 0.9));
+    state->aoa_map.write(2, steering_of(3, 0.9));
+    detector.check_AoA(channels, in.data(), 3000);
+    ASSERT_TRUE(state->spoofing_queue.try_pop(msg));
+    EXPECT_EQ(11, msg.spoofing_case);
+    ASSERT_EQ(3u, msg.satellites.size());
+    EXPECT_EQ(0u, msg.satellites.count(1));
+    EXPECT_FALSE(state->spoofing_queue.try_pop(msg));
+}
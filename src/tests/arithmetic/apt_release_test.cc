@@ -0,0 +1,89 @@
+/*!
+ * \file apt_release_test.cc
+ * \brief Tests of the release of the peaks whose APT check is complete
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <memory>
+#include <gtest/gtest.h>
+#include "gps_navigation_message.h"
+#include "receiver_state.h"
+#include "in_memory_configuration.h"
+#include "spoofing_detector.h"
+
+
+namespace
+{
+void new_apt_subframe(Spoofing_Detector& detector, unsigned int uid, int subframe_ID, double time)
+{
+    Gps_Navigation_Message nav;
+    nav.uid = uid;
+    detector.New_subframe(subframe_ID, 5, nav, time);
+}
+}
+
+
+TEST(AptReleaseTest, ReleasedOnceOnCommonSubframe)
+{
+    std::shared_ptr<Receiver_State> state = std::make_shared<Receiver_State>();
+    Receiver_State_Scope state_scope(state);
+    std::shared_ptr<InMemoryConfiguration> config = std::make_shared<InMemoryConfiguration>();
+    Spoofing_Detector detector(config.get());
+
+    // two peaks of PRN 5 on different subframes
+    new_apt_subframe(detector, 1, 1, 6000.0);
+    new_apt_subframe(detector, 2, 2, 12001.0);
+    EXPECT_FALSE(detector.APT_release(5, 2));
+
+    // both on subframe 2: the peak with the higher uid is released, once
+    new_apt_subframe(detector, 1, 2, 12000.0);
+    EXPECT_FALSE(detector.APT_release(5, 1));
+    EXPECT_TRUE(detector.APT_release(5, 2));
+    EXPECT_FALSE(detector.APT_release(5, 2));
+
+    // not while an alarm is active for the satellite
+    state->spoofing_status.add(5, 1);
+    new_apt_subframe(detector, 1, 3, 18000.0);
+    new_apt_subframe(detector, 2, 3, 18001.0);
+    EXPECT_FALSE(detector.APT_release(5, 2));
+
+    // nor when it was decided before the alarm
+    state->spoofing_status.remove(5);
+    new_apt_subframe(detector, 2, 4, 24001.0);
+    new_apt_subframe(detector, 1, 4, 24000.0);
+    state->spoofing_status.add(5, 1);
+    EXPECT_FALSE(detector.APT_release(5, 2));
+
+    // and a peak that stops being tracked forgets its release
+    state->spoofing_status.remove(5);
+    new_apt_subframe(detector, 2, 5, 30001.0);
+    new_apt_subframe(detector, 1, 5, 30000.0);
+    detector.forget_APT_release(2);
+    EXPECT_FALSE(detector.APT_release(5, 2));
+}
@@ -0,0 +1,84 @@
+/*!
+ * \file assistance_snapshot_test.cc
+ * \brief  This file implements tests for the binary snapshot of the GPS assistance data
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <gtest/gtest.h>
+#include "gnss_sdr_supl_client.h"
+
+
+TEST(AssistanceSnapshotTest, RoundTrip)
+{
+    std::string filename = "./assistance_snapshot_test.snap";
+    gnss_sdr_supl_client saved;
+    Gps_Ephemeris ephemeris;
+    ephemeris.i_satellite_PRN = 7;
+    ephemeris.d_TOW = 345600.0;
+    ephemeris.d_sqrt_A = 5153.71;
+    saved.gps_ephemeris_map[7] = ephemeris;
+    saved.gps_utc.valid = true;
+    saved.gps_utc.d_A0 = 1.5e-9;
+    saved.gps_ref_loc.valid = true;
+    saved.gps_ref_loc.lat = 41.275;
+    ASSERT_TRUE(saved.save_assistance_snapshot(filename));
+
+    gnss_sdr_supl_client loaded;
+    double age_s = -1.0;
+    ASSERT_TRUE(loaded.load_assistance_snapshot(filename, &age_s));
+    ASSERT_EQ(1u, loaded.gps_ephemeris_map.size());
+    EXPECT_EQ(7u, loaded.gps_ephemeris_map[7].i_satellite_PRN);
+    EXPECT_DOUBLE_EQ(5153.71, loaded.gps_ephemeris_map[7].d_sqrt_A);
+    EXPECT_TRUE(loaded.gps_utc.valid);
+    EXPECT_DOUBLE_EQ(1.5e-9, loaded.gps_utc.d_A0);
+    EXPECT_DOUBLE_EQ(41.275, loaded.gps_ref_loc.lat);
+    EXPECT_GE(age_s, 0.0);
+    EXPECT_LT(age_s, 60.0);
+    std::remove(filename.c_str());
+}
+
+
+TEST(AssistanceSnapshotTest, RejectsOtherFiles)
+{
+    std::string filename = "./assistance_snapshot_test.xml";
+    {
+        std::ofstream xml(filename.c_str());
+        xml << "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\" ?>\n";
+    }
+    gnss_sdr_supl_client client;
+    Gps_Ephemeris ephemeris;
+    client.gps_ephemeris_map[3] = ephemeris;
+    EXPECT_FALSE(client.load_assistance_snapshot(filename));
+    EXPECT_FALSE(client.load_assistance_snapshot("./no_such_assistance_snapshot.snap"));
+    // a failed load leaves the data as it was
+    EXPECT_EQ(1u, client.gps_ephemeris_map.size());
+    std::remove(filename.c_str());
+}
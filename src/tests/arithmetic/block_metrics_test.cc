@@ -0,0 +1,85 @@
+/*!
+ * \file block_metrics_test.cc
+ * \brief  This file implements tests for the block metrics
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include "block_metrics.h"
+
+
+TEST(BlockMetricsTest, CallsAreCountedOnlyWhenEnabled)
+{
+    std::shared_ptr<Block_Metrics> metrics = make_block_metrics("test", "disabled");
+    set_block_metrics_enabled(false);
+    {
+        Block_Metrics_Scope scope(metrics.get(), 100);
+        scope.set_items(10);
+    }
+    EXPECT_EQ(0u, metrics->snapshot().calls);
+
+    set_block_metrics_enabled(true);
+    {
+        Block_Metrics_Scope scope(metrics.get(), 100);
+        scope.set_items(10);
+    }
+    set_block_metrics_enabled(false);
+    Block_Metrics::Snapshot snapshot = metrics->snapshot();
+    EXPECT_EQ(1u, snapshot.calls);
+    EXPECT_EQ(10u, snapshot.items);
+    EXPECT_EQ(100u, snapshot.input_items);
+    EXPECT_EQ(snapshot.busy_ns, snapshot.max_ns);
+}
+
+
+TEST(BlockMetricsTest, HistogramOfPowersOfTwoMicroseconds)
+{
+    std::shared_ptr<Block_Metrics> metrics = make_block_metrics("test", "histogram");
+    metrics->add_call(std::chrono::nanoseconds(500), 1, 1);        // below 1 us
+    metrics->add_call(std::chrono::microseconds(3), 1, 1);         // [2, 4) us
+    metrics->add_call(std::chrono::microseconds(3), 1, 1);
+    metrics->add_call(std::chrono::seconds(5), 1, 1);              // the last bucket
+    Block_Metrics::Snapshot snapshot = metrics->snapshot();
+    EXPECT_EQ(1u, snapshot.buckets[0]);
+    EXPECT_EQ(2u, snapshot.buckets[2]);
+    EXPECT_EQ(1u, snapshot.buckets[Block_Metrics::BUCKETS - 1]);
+    EXPECT_EQ(5000000000ULL, snapshot.max_ns);
+
+    std::string text = block_metrics_prometheus_text();
+    EXPECT_NE(std::string::npos, text.find("gnss_sdr_block_calls_total{block=\"test\",instance=\"histogram\"} 4\n"));
+    // the buckets are cumulative
+    EXPECT_NE(std::string::npos, text.find("gnss_sdr_block_call_seconds_bucket{block=\"test\",instance=\"histogram\",le=\"4e-06\"} 3\n"));
+    EXPECT_NE(std::string::npos, text.find("gnss_sdr_block_call_seconds_bucket{block=\"test\",instance=\"histogram\",le=\"+Inf\"} 4\n"));
+
+    metrics.reset();
+    text = block_metrics_prometheus_text();
+    EXPECT_EQ(std::string::npos, text.find("instance=\"histogram\""));
+}
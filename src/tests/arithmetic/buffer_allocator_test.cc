@@ -0,0 +1,124 @@
+/*!
+ * \file buffer_allocator_test.cc
+ * \brief  This file implements tests for the allocator of the signal processing buffers
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <cstdint>
+#include <cstring>
+#include <gtest/gtest.h>
+#include "buffer_allocator.h"
+#include "static_limits.h"
+
+
+TEST(BufferAllocatorTest, AlignmentAndUsage)
+{
+    char* a = static_cast<char*>(Buffer_Allocator::allocate(1000, "test_usage"));
+    char* b = static_cast<char*>(Buffer_Allocator::allocate(24, "test_usage"));
+    ASSERT_TRUE(a != 0);
+    ASSERT_TRUE(b != 0);
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(a) % Buffer_Allocator::alignment);
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(b) % Buffer_Allocator::alignment);
+    std::memset(a, 1, 1000);
+    std::memset(b, 2, 24);
+
+    Buffer_Allocator::Usage usage = Buffer_Allocator::usage()["test_usage"];
+    EXPECT_EQ(2u, usage.buffers);
+    EXPECT_EQ(1024u, usage.bytes);
+    EXPECT_EQ(0u, usage.huge_page_bytes);
+
+    Buffer_Allocator::release(a);
+    usage = Buffer_Allocator::usage()["test_usage"];
+    EXPECT_EQ(1u, usage.buffers);
+    EXPECT_EQ(24u, usage.bytes);
+    EXPECT_EQ(1024u, usage.peak_bytes);
+    Buffer_Allocator::release(b);
+    Buffer_Allocator::release(0);
+    EXPECT_EQ(0u, Buffer_Allocator::usage()["test_usage"].bytes);
+}
+
+
+TEST(BufferAllocatorTest, HugePagesAndNumaNode)
+{
+    // whether the kernel grants them or not, the buffers must be usable
+    const size_t size = 3 * 1024 * 1024;
+    Buffer_Allocator::Page_Mode modes[] = {Buffer_Allocator::Transparent_Huge_Pages, Buffer_Allocator::Explicit_Huge_Pages};
+    for (unsigned int i = 0; i < 2; i++)
+        {
+            char* buffer = static_cast<char*>(Buffer_Allocator::allocate(size, "test_huge", Buffer_Allocator::Hints(modes[i], 0)));
+            ASSERT_TRUE(buffer != 0);
+            EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(buffer) % Buffer_Allocator::alignment);
+            std::memset(buffer, 3, size);
+            EXPECT_EQ(3, buffer[size - 1]);
+            Buffer_Allocator::Usage usage = Buffer_Allocator::usage()["test_huge"];
+            EXPECT_EQ(size, usage.bytes);
+            EXPECT_TRUE(usage.huge_page_bytes == 0 || usage.huge_page_bytes >= size);
+            Buffer_Allocator::release(buffer);
+            EXPECT_EQ(0u, Buffer_Allocator::usage()["test_huge"].huge_page_bytes);
+        }
+
+    // small buffers stay on the default pages
+    void* small = Buffer_Allocator::allocate(4096, "test_huge", Buffer_Allocator::Hints(Buffer_Allocator::Transparent_Huge_Pages));
+    EXPECT_EQ(0u, Buffer_Allocator::usage()["test_huge"].huge_page_bytes);
+    Buffer_Allocator::release(small);
+}
+
+
+TEST(BufferAllocatorTest, PageModeNames)
+{
+    EXPECT_EQ(Buffer_Allocator::Default_Pages, Buffer_Allocator::page_mode("off"));
+    EXPECT_EQ(Buffer_Allocator::Transparent_Huge_Pages, Buffer_Allocator::page_mode("transparent"));
+    EXPECT_EQ(Buffer_Allocator::Explicit_Huge_Pages, Buffer_Allocator::page_mode("explicit"));
+}
+
+
+#if defined(GNSS_SDR_STATIC_LIMITS)
+TEST(BufferAllocatorTest, ArenaReusesReleasedBlocks)
+{
+    ASSERT_TRUE(Buffer_Allocator::reserve());
+    void* a = Buffer_Allocator::allocate(100000, "test_arena");
+    void* b = Buffer_Allocator::allocate(300000, "test_arena");
+    ASSERT_TRUE(a != 0);
+    ASSERT_TRUE(b != 0);
+    Buffer_Allocator::release(a);
+    Buffer_Allocator::release(b);
+
+    // the smallest released block that fits
+    void* c = Buffer_Allocator::allocate(90000, "test_arena");
+    void* d = Buffer_Allocator::allocate(200000, "test_arena");
+    EXPECT_EQ(a, c);
+    EXPECT_EQ(b, d);
+    Buffer_Allocator::release(c);
+    Buffer_Allocator::release(d);
+
+    EXPECT_TRUE(Buffer_Allocator::allocate(Static_Limits::arena_bytes(), "test_arena") == 0);
+    EXPECT_EQ(0u, Buffer_Allocator::usage()["test_arena"].buffers);
+}
+#endif
@@ -0,0 +1,133 @@
+/*!
+ * \file coarse_time_pvt_test.cc
+ * \brief  This file implements tests for the coarse time position fix
+ * from the code phases of a snapshot
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cmath>
+#include <map>
+#include <armadillo>
+#include <gtest/gtest.h>
+#include "coarse_time_pvt.h"
+#include "GPS_L1_CA.h"
+#include "gps_ephemeris.h"
+
+
+namespace
+{
+// Circular orbits spread over six planes
+Gps_Ephemeris test_ephemeris(unsigned int PRN, double toe)
+{
+    Gps_Ephemeris eph;
+    eph.i_satellite_PRN = PRN;
+    eph.d_sqrt_A = 5153.7;
+    eph.d_e_eccentricity = 0.0;
+    eph.d_i_0 = 0.96;
+    eph.d_OMEGA0 = (PRN % 6) * GPS_PI / 3.0;
+    eph.d_M_0 = PRN * 1.7;
+    eph.d_Toe = toe;
+    eph.d_Toc = toe;
+    eph.d_A_f0 = 1e-5 * (static_cast<double>(PRN) - 16.0);
+    return eph;
+}
+
+// Pseudorange of eph at rx_pos and GPS time t, without the receiver clock, as Coarse_Time_Pvt models it
+double true_pseudorange(Ls_Pvt & pvt, Gps_Ephemeris & eph, const arma::vec & rx_pos, double t, double & elevation_deg)
+{
+    double traveltime = 0.072;
+    arma::vec sat(3);
+    arma::vec rot_sat;
+    for (int i = 0; i < 10; i++)
+        {
+            eph.satellitePosition(t - traveltime);
+            sat(0) = eph.d_satpos_X;
+            sat(1) = eph.d_satpos_Y;
+            sat(2) = eph.d_satpos_Z;
+            rot_sat = pvt.rotateSatellite(traveltime, sat);
+            traveltime = arma::norm(rot_sat - rx_pos, 2) / GPS_C_m_s;
+        }
+    double az, distance, dphi, dlambda, h;
+    double trop = 0.0;
+    pvt.topocent(&az, &elevation_deg, &distance, rx_pos, rot_sat - rx_pos);
+    pvt.togeod(&dphi, &dlambda, &h, 6378137.0, 298.257223563, rx_pos(0), rx_pos(1), rx_pos(2));
+    pvt.tropo(&trop, sin(elevation_deg * GPS_PI / 180.0), h / 1000.0, 1013.0, 293.0, 50.0, 0.0, 0.0, 0.0);
+    return traveltime * GPS_C_m_s + trop - eph.sv_clock_drift(t - traveltime) * GPS_C_m_s;
+}
+}
+
+
+TEST(CoarseTimePvtTest, SnapshotFix)
+{
+    const double tow = 345600.0;
+    const double clock_bias_m = 12345.6;
+    arma::vec rx_pos = {4765000.0, 180000.0, 4219000.0};
+
+    Coarse_Time_Pvt pvt;
+    std::map<int, double> code_phases_s;
+    for (unsigned int PRN = 1; PRN <= 32; PRN++)
+        {
+            Gps_Ephemeris eph = test_ephemeris(PRN, tow - 1800.0);
+            double elevation_deg = 0.0;
+            double pseudorange = true_pseudorange(pvt, eph, rx_pos, tow, elevation_deg) + clock_bias_m;
+            if (elevation_deg > 5.0)
+                {
+                    pvt.gps_ephemeris_map[PRN] = eph;
+                    code_phases_s[PRN] = std::fmod(pseudorange / GPS_C_m_s, GPS_L1_CA_CODE_PERIOD);
+                }
+        }
+    ASSERT_GE(code_phases_s.size(), 5u);
+
+    // the time is 2.5 s off, and the position some 60 km
+    arma::vec approx_pos = rx_pos + arma::vec({40000.0, -30000.0, 30000.0});
+    ASSERT_TRUE(pvt.get_PVT(code_phases_s, tow + 2.5, approx_pos));
+    EXPECT_EQ(static_cast<int>(code_phases_s.size()), pvt.d_valid_observations);
+    EXPECT_NEAR(-2.5, pvt.d_time_error_s, 1e-4);
+    EXPECT_NEAR(tow, pvt.d_GPS_time_s, 1e-4);
+    EXPECT_NEAR(rx_pos(0), pvt.d_x_m, 1.0);
+    EXPECT_NEAR(rx_pos(1), pvt.d_y_m, 1.0);
+    EXPECT_NEAR(rx_pos(2), pvt.d_z_m, 1.0);
+}
+
+
+TEST(CoarseTimePvtTest, TooFewSatellites)
+{
+    Coarse_Time_Pvt pvt;
+    std::map<int, double> code_phases_s;
+    for (unsigned int PRN = 1; PRN <= 3; PRN++)
+        {
+            pvt.gps_ephemeris_map[PRN] = test_ephemeris(PRN, 0.0);
+            code_phases_s[PRN] = 1e-4 * PRN;
+        }
+    // no ephemeris for the fourth one
+    code_phases_s[4] = 4e-4;
+    arma::vec approx_pos = {6378137.0, 0.0, 0.0};
+    EXPECT_FALSE(pvt.get_PVT(code_phases_s, 1000.0, approx_pos));
+    EXPECT_EQ(3, pvt.d_valid_observations);
+    EXPECT_FALSE(pvt.b_valid_position);
+}
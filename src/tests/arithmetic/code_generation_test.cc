@@ -30,10 +30,14 @@
  */
 
 
+#include <algorithm>
 #include <complex>
 #include <ctime>
+#include <vector>
 #include "gps_sdr_signal_processing.h"
 #include "gnss_signal_processing.h"
+#include "galileo_e1_signal_processing.h"
+#include "code_bank.h"
 
 
 
@@ -180,3 +184,52 @@ TEST(ComplexCarrier_Test, CodeGeneration)
     delete[] _dest2;*/
 
 }
+
+
+TEST(CodeBank_Test, SameAsGenerators)
+{
+    Code_Bank::clear();
+    unsigned long int misses = Code_Bank::misses();
+    std::vector<std::complex<float> > expected(8000);
+    std::vector<std::complex<float> > banked(8000);
+
+    gps_l1_ca_code_gen_complex(expected.data(), 7, 4);
+    Code_Bank::gps_l1_ca_code_gen_complex(banked.data(), 7, 4);
+    EXPECT_TRUE(std::equal(expected.begin(), expected.begin() + 1023, banked.begin()));
+    EXPECT_EQ(1023u, Code_Bank::gps_l1_ca(7, 0, 4)->size());
+
+    gps_l1_ca_code_gen_complex_sampled(expected.data(), 7, 8000000, 0);
+    Code_Bank::gps_l1_ca_code_gen_complex_sampled(banked.data(), 7, 8000000, 0);
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), banked.begin()));
+    EXPECT_EQ(8000u, Code_Bank::gps_l1_ca(7, 8000000, 0)->size());
+    EXPECT_EQ(misses + 2, Code_Bank::misses());
+
+    // 2 samples per chip, as in the E1 trackers
+    char signal[3] = "1B";
+    std::vector<std::complex<float> > e1_expected(8184);
+    galileo_e1_code_gen_complex_sampled(e1_expected.data(), signal, false, 11, 2046000, 0);
+    Code_Bank::Replica e1 = Code_Bank::galileo_e1(signal, false, 11, 2046000, 0, false);
+    ASSERT_EQ(8184u, e1->size());
+    EXPECT_TRUE(std::equal(e1_expected.begin(), e1_expected.end(), e1->begin()));
+}
+
+
+TEST(CodeBank_Test, SharedAndTrimmed)
+{
+    Code_Bank::clear();
+    Code_Bank::Replica first = Code_Bank::gps_l1_ca(3, 4000000, 0);
+    unsigned long int hits = Code_Bank::hits();
+    EXPECT_EQ(first.get(), Code_Bank::gps_l1_ca(3, 4000000, 0).get());
+    EXPECT_EQ(hits + 1, Code_Bank::hits());
+    EXPECT_NE(first.get(), Code_Bank::gps_l1_ca(3, 2000000, 0).get());
+    EXPECT_EQ(6000u * sizeof(std::complex<float>), Code_Bank::bytes());
+
+    // the least recently used replica goes first, and stays valid for its holders
+    unsigned long int max_bytes = Code_Bank::max_bytes();
+    Code_Bank::set_max_bytes(5000 * sizeof(std::complex<float>));
+    EXPECT_EQ(2000u * sizeof(std::complex<float>), Code_Bank::bytes());
+    EXPECT_EQ(4000u, first->size());
+    EXPECT_NE(first.get(), Code_Bank::gps_l1_ca(3, 4000000, 0).get());
+    Code_Bank::set_max_bytes(max_bytes);
+    Code_Bank::clear();
+}
@@ -0,0 +1,107 @@
+/*!
+ * \file concurrent_ring_queue_test.cc
+ * \brief  This file implements tests for the lock-free queues of fixed capacity
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <memory>
+#include <vector>
+#include <boost/thread.hpp>
+#include <gtest/gtest.h>
+#include "concurrent_ring_queue.h"
+
+
+TEST(ConcurrentRingQueueTest, SingleProducer)
+{
+    concurrent_spsc_queue<std::unique_ptr<int>> queue(3);
+    EXPECT_TRUE(queue.empty());
+    // the capacity is rounded up to 4
+    for (int i = 0; i < 5; i++)
+        {
+            EXPECT_EQ(i < 4, queue.push(std::unique_ptr<int>(new int(i))));
+        }
+    EXPECT_EQ(1u, queue.dropped());
+    std::unique_ptr<int> value;
+    ASSERT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(0, *value);
+    EXPECT_TRUE(queue.push(std::unique_ptr<int>(new int(4))));
+
+    std::vector<std::unique_ptr<int>> batch;
+    EXPECT_EQ(4u, queue.pop_all(batch));
+    ASSERT_EQ(4u, batch.size());
+    for (int i = 0; i < 4; i++)
+        {
+            EXPECT_EQ(i + 1, *batch[i]);
+        }
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.try_pop(value));
+}
+
+
+TEST(ConcurrentRingQueueTest, MultipleProducers)
+{
+    const int producers = 4;
+    const int items = 20000;
+    concurrent_mpsc_queue<int> queue(256);
+    boost::thread_group threads;
+    for (int p = 0; p < producers; p++)
+        {
+            threads.create_thread([&queue, p, items]()
+                {
+                    for (int i = 0; i < items; i++)
+                        {
+                            // the consumer keeps up, a full queue is retried
+                            while (!queue.push(p * items + i))
+                                {
+                                    boost::this_thread::yield();
+                                }
+                        }
+                });
+        }
+
+    std::vector<int> last(producers, -1);
+    std::vector<int> batch;
+    int received = 0;
+    while (received < producers * items)
+        {
+            batch.clear();
+            received += queue.wait_and_pop_all(batch, boost::posix_time::milliseconds(100));
+            for (unsigned int n = 0; n < batch.size(); n++)
+                {
+                    // each producer's items arrive in order, once
+                    int p = batch[n] / items;
+                    EXPECT_EQ(last[p] + 1, batch[n] % items);
+                    last[p] = batch[n] % items;
+                }
+        }
+    threads.join_all();
+    EXPECT_EQ(producers * items, received);
+    EXPECT_TRUE(queue.empty());
+    int value;
+    EXPECT_FALSE(queue.try_pop(value));
+}
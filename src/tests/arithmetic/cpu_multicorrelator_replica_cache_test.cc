@@ -0,0 +1,132 @@
+/*!
+ * \file cpu_multicorrelator_replica_cache_test.cc
+ * \brief  This file implements tests for the resampled replica cache of cpu_multicorrelator
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <gtest/gtest.h>
+#include "cpu_multicorrelator.h"
+
+namespace
+{
+const int replica_test_code_length = 1023;
+const int replica_test_signal_length = 4000;
+
+class ReplicaCacheTest: public ::testing::Test
+{
+protected:
+    ReplicaCacheTest() : code(replica_test_code_length), signal(replica_test_signal_length)
+    {
+        unsigned int state = 7;
+        for (int i = 0; i < replica_test_code_length; i++)
+            {
+                state = state * 1103515245 + 12345;
+                code[i] = std::complex<float>((state >> 16) & 1 ? 1.0 : -1.0, 0.0);
+            }
+        for (int n = 0; n < replica_test_signal_length; n++)
+            {
+                int chip = (static_cast<int>(std::floor(n * 0.2557 - 0.3)) + replica_test_code_length) % replica_test_code_length;
+                signal[n] = code[chip];
+            }
+        shifts[0] = -0.5;
+        shifts[1] = 0.0;
+        shifts[2] = 0.5;
+    }
+
+    void correlate(cpu_multicorrelator& correlator, float rem_code_phase_chips, float code_phase_step_chips, std::complex<float>* out)
+    {
+        correlator.set_input_output_vectors(out, &signal[0]);
+        correlator.Carrier_wipeoff_multicorrelator_resampler(0.0, 0.0, rem_code_phase_chips, code_phase_step_chips, replica_test_signal_length);
+    }
+
+    std::vector<std::complex<float> > code;
+    std::vector<std::complex<float> > signal;
+    float shifts[3];
+};
+}
+
+
+TEST_F(ReplicaCacheTest, ReusesReplicasWithinTheTolerance)
+{
+    cpu_multicorrelator exact;
+    exact.init(replica_test_signal_length, 3);
+    exact.set_local_code_and_taps(replica_test_code_length, &code[0], shifts);
+    cpu_multicorrelator cached;
+    cached.init(replica_test_signal_length, 3);
+    cached.set_local_code_and_taps(replica_test_code_length, &code[0], shifts);
+    cached.set_replica_cache(4, 0.01);
+
+    std::complex<float> exact_out[3];
+    std::complex<float> cached_out[3];
+    for (int k = 0; k < 10; k++)
+        {
+            // a steady code NCO with a tiny jitter stays in the same cell
+            float step = 0.2557 + 1e-9 * k;
+            correlate(exact, 0.3, step, exact_out);
+            correlate(cached, 0.3, step, cached_out);
+            for (int n = 0; n < 3; n++)
+                {
+                    // 0.01 chips off the 3 sample per chip correlation is well below 1 %
+                    EXPECT_NEAR(exact_out[n].real(), cached_out[n].real(), 0.01 * replica_test_signal_length);
+                    EXPECT_NEAR(exact_out[n].imag(), cached_out[n].imag(), 0.01 * replica_test_signal_length);
+                }
+        }
+    EXPECT_GT(std::abs(cached_out[1]), 0.9 * replica_test_signal_length);
+    EXPECT_EQ(1u, cached.replica_cache_misses());
+    EXPECT_EQ(9u, cached.replica_cache_hits());
+    exact.free();
+    cached.free();
+}
+
+
+TEST_F(ReplicaCacheTest, RecyclesTheLeastRecentlyUsedSet)
+{
+    cpu_multicorrelator cached;
+    cached.init(replica_test_signal_length, 3);
+    cached.set_local_code_and_taps(replica_test_code_length, &code[0], shifts);
+    cached.set_replica_cache(2, 0.01);
+    std::complex<float> out[3];
+
+    correlate(cached, 0.1, 0.2557, out); // miss A
+    correlate(cached, 0.2, 0.2557, out); // miss B
+    correlate(cached, 0.1, 0.2557, out); // hit A, B is now the oldest
+    correlate(cached, 0.3, 0.2557, out); // miss C recycles B
+    correlate(cached, 0.1, 0.2557, out); // hit A
+    correlate(cached, 0.2, 0.2557, out); // miss B again
+    EXPECT_EQ(2u, cached.replica_cache_hits());
+    EXPECT_EQ(4u, cached.replica_cache_misses());
+
+    // a new local code empties the cache
+    cached.set_local_code_and_taps(replica_test_code_length, &code[0], shifts);
+    correlate(cached, 0.1, 0.2557, out);
+    EXPECT_EQ(5u, cached.replica_cache_misses());
+    cached.free();
+}
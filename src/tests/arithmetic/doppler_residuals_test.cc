@@ -0,0 +1,143 @@
+/*!
+ * \file doppler_residuals_test.cc
+ * \brief  This file implements tests for the carrier Doppler residuals of
+ * the PVT and their check in the spoofing detector
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <armadillo>
+#include <gtest/gtest.h>
+#include "concurrent_ring_queue.h"
+#include "receiver_state.h"
+#include "GPS_L1_CA.h"
+#include "in_memory_configuration.h"
+#include "ls_pvt.h"
+#include "spoofing_detector.h"
+#include "spoofing_message.h"
+
+namespace
+{
+// Doppler of the satellites seen by a receiver at rx_pos with rx_vel = [VX, VY, VZ, drift]
+arma::vec predicted_doppler_hz(const arma::mat& satpos, const arma::mat& satvel, const arma::vec& rx_pos, const arma::vec& rx_vel)
+{
+    double lambda = GPS_C_m_s / GPS_L1_FREQ_HZ;
+    arma::vec doppler(satpos.n_cols);
+    for (unsigned int i = 0; i < satpos.n_cols; i++)
+        {
+            arma::vec los = satpos.col(i) - rx_pos;
+            los /= arma::norm(los, 2);
+            doppler(i) = -(arma::dot(los, satvel.col(i) - rx_vel.subvec(0, 2)) + rx_vel(3)) / lambda;
+        }
+    return doppler;
+}
+}
+
+
+TEST(DopplerResidualsTest, MovingReceiver)
+{
+    arma::mat satpos = {{20e6, 15e6, 10e6, 22e6, 0.0},
+                        {5e6, -12e6, 14e6, 0.0, 0.0},
+                        {14e6, 16e6, 20e6, -3e6, 0.0}};
+    arma::mat satvel = {{-1200.0, 800.0, 2500.0, -300.0, 0.0},
+                        {2900.0, -1500.0, 400.0, 3100.0, 0.0},
+                        {300.0, 2100.0, -1800.0, 900.0, 0.0}};
+    arma::vec rx_pos = {6378137.0, 0.0, 0.0};
+    arma::vec rx_vel = {10.0, -20.0, 5.0, 150.0};
+    arma::vec doppler = predicted_doppler_hz(satpos, satvel, rx_pos, rx_vel);
+    // the third satellite is 12 m/s off, the last one has no ephemeris
+    doppler(2) -= 12.0 / (GPS_C_m_s / GPS_L1_FREQ_HZ);
+    arma::mat w = arma::eye(5, 5);
+    w(4, 4) = 0.0;
+
+    Ls_Pvt pvt;
+    arma::vec residuals = pvt.dopplerResiduals(satpos, satvel, rx_pos, doppler, w, rx_vel, false);
+    ASSERT_EQ(5u, residuals.n_elem);
+    EXPECT_NEAR(0.0, residuals(0), 1e-6);
+    EXPECT_NEAR(0.0, residuals(1), 1e-6);
+    EXPECT_NEAR(12.0, residuals(2), 1e-6);
+    EXPECT_NEAR(0.0, residuals(3), 1e-6);
+    EXPECT_EQ(0.0, residuals(4));
+}
+
+
+TEST(DopplerResidualsTest, StaticReceiver)
+{
+    arma::mat satpos = {{20e6, 15e6, 10e6},
+                        {5e6, -12e6, 14e6},
+                        {14e6, 16e6, 20e6}};
+    arma::mat satvel = {{-1200.0, 800.0, 2500.0},
+                        {2900.0, -1500.0, 400.0},
+                        {300.0, 2100.0, -1800.0}};
+    arma::vec rx_pos = {6378137.0, 0.0, 0.0};
+    arma::vec rx_vel = {0.0, 0.0, 0.0, -75.0};
+    arma::vec doppler = predicted_doppler_hz(satpos, satvel, rx_pos, rx_vel);
+
+    // the drift is fitted, so the velocity and drift passed in do not matter
+    Ls_Pvt pvt;
+    arma::vec wrong_vel = {100.0, 100.0, 100.0, 0.0};
+    arma::vec residuals = pvt.dopplerResiduals(satpos, satvel, rx_pos, doppler, arma::eye(3, 3), wrong_vel, true);
+    ASSERT_EQ(3u, residuals.n_elem);
+    for (unsigned int i = 0; i < 3; i++)
+        {
+            EXPECT_NEAR(0.0, residuals(i), 1e-6);
+        }
+}
+
+
+TEST(DopplerResidualsTest, DetectorAlarm)
+{
+    Spoofing_Message msg;
+    std::shared_ptr<Receiver_State> state = std::make_shared<Receiver_State>();
+    Receiver_State_Scope state_scope(state);
+
+    std::shared_ptr<InMemoryConfiguration> config = std::make_shared<InMemoryConfiguration>();
+    config->set_property("Spoofing.Doppler", "true");
+    config->set_property("Spoofing.Doppler_window", "5");
+    config->set_property("Spoofing.Doppler_max_mps", "5");
+    Spoofing_Detector detector(config.get());
+
+    std::vector<unsigned int> prn = {3, 7, 0};
+    std::vector<double> residuals = {0.5, 12.0, 40.0};
+    for (int i = 0; i < 4; i++)
+        {
+            detector.check_doppler(prn, residuals, 1000.0 * i);
+        }
+    // no alarm until the window is full
+    EXPECT_FALSE(state->spoofing_queue.try_pop(msg));
+
+    detector.check_doppler(prn, residuals, 4000.0);
+    ASSERT_TRUE(state->spoofing_queue.try_pop(msg));
+    EXPECT_EQ(8, msg.spoofing_case);
+    ASSERT_EQ(1u, msg.satellites.size());
+    EXPECT_EQ(7u, *msg.satellites.begin());
+    EXPECT_FALSE(state->spoofing_queue.try_pop(msg));
+}
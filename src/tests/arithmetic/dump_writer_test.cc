@@ -0,0 +1,134 @@
+/*!
+ * \file dump_writer_test.cc
+ * \brief  This file implements tests for the dump writer and reader
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <gtest/gtest.h>
+#include "dump_reader.h"
+#include "dump_writer.h"
+
+
+TEST(DumpWriterTest, PutValuesReadBackThroughTheSchema)
+{
+    std::string filename = "./dump_writer_test.dat";
+    Dump_Schema schema("test");
+    schema.add<double>("TOW_s").add<float>("prompt", 3).add<unsigned long long>("sample_counter");
+    ASSERT_EQ(28u, schema.record_bytes());
+
+    const unsigned int n_records = 10007; // wraps the ring many times
+    {
+        Dump_Writer writer(4096);
+        ASSERT_TRUE(writer.open(filename, schema));
+        for (unsigned int n = 0; n < n_records; n++)
+            {
+                writer.put(0.001 * n);
+                for (int i = 0; i < 3; i++)
+                    {
+                        writer.put(static_cast<float>(i - n));
+                    }
+                writer.put(4000ULL * n);
+            }
+        EXPECT_EQ(n_records, writer.records());
+        writer.close();
+    }
+
+    Dump_Reader reader;
+    ASSERT_TRUE(reader.open(filename));
+    EXPECT_EQ("test", reader.schema().name());
+    ASSERT_EQ(3u, reader.schema().fields().size());
+    EXPECT_EQ(3u, reader.schema().fields()[1].count);
+    ASSERT_EQ(n_records, reader.num_records());
+    for (unsigned int n = 0; n < n_records; n++)
+        {
+            ASSERT_EQ(0.001 * n, reader.get<double>(n, 0));
+            ASSERT_EQ(static_cast<float>(2 - n), reader.get<float>(n, 1, 2));
+            ASSERT_EQ(4000ULL * n, reader.get<unsigned long long>(n, 2));
+            ASSERT_EQ(4000.0 * n, reader.value(n, 2));
+        }
+    reader.close();
+    std::remove(filename.c_str());
+}
+
+
+TEST(DumpWriterTest, RecordsStartAtAnAlignedOffset)
+{
+    Dump_Schema schema("aligned");
+    schema.add<int>("value");
+    std::string header = schema.header();
+    EXPECT_EQ(0u, header.size() % DUMP_HEADER_ALIGNMENT);
+
+    Dump_Schema parsed;
+    size_t header_bytes = 0;
+    ASSERT_TRUE(Dump_Schema::parse(header.data(), header.size(), parsed, header_bytes));
+    EXPECT_EQ(header.size(), header_bytes);
+    EXPECT_EQ(DUMP_INT32, parsed.fields()[0].type);
+    EXPECT_FALSE(Dump_Schema::parse("not a dump", 10, parsed, header_bytes));
+}
+
+
+TEST(DumpWriterTest, ValueOfTheWrongTypeDropsItsRecord)
+{
+    std::string filename = "./dump_writer_mismatch_test.dat";
+    Dump_Schema schema("mismatch");
+    schema.add<double>("a").add<double>("b");
+    {
+        Dump_Writer writer;
+        ASSERT_TRUE(writer.open(filename, schema));
+        writer.put(1.0);
+        writer.put(2.0);
+        writer.put(3.0f); // float for a double
+        writer.put(4.0);
+        writer.put(5.0);
+        writer.put(6.0);
+        writer.close();
+    }
+    Dump_Reader reader;
+    ASSERT_TRUE(reader.open(filename));
+    ASSERT_EQ(2u, reader.num_records());
+    EXPECT_EQ(1.0, reader.get<double>(0, 0));
+    EXPECT_EQ(6.0, reader.get<double>(1, 1));
+    reader.close();
+    std::remove(filename.c_str());
+}
+
+
+TEST(DumpWriterTest, OpenFailsWithoutThrowing)
+{
+    Dump_Writer writer;
+    EXPECT_FALSE(writer.open("./no_such_directory/dump.dat", Dump_Schema("none")));
+    EXPECT_FALSE(writer.is_open());
+    writer.put(1.0);
+    writer.close();
+    Dump_Reader reader;
+    EXPECT_FALSE(reader.open("./no_such_directory/dump.dat"));
+}
@@ -0,0 +1,202 @@
+/*!
+ * \file ephemeris_history_test.cc
+ * \brief Tests of the ephemeris history of the receiver and of the NAVI
+ * ephemeris checks that use it
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <map>
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+#include "ephemeris_history.h"
+#include "gps_ephemeris.h"
+#include "gps_navigation_message.h"
+#include "in_memory_configuration.h"
+#include "receiver_state.h"
+#include "spoofing_detector.h"
+#include "spoofing_message.h"
+
+
+namespace
+{
+Gps_Ephemeris history_test_ephemeris(unsigned int PRN, double toe, int IODE)
+{
+    Gps_Ephemeris eph = Gps_Ephemeris();
+    eph.i_satellite_PRN = PRN;
+    eph.d_Toe = toe;
+    eph.d_Toc = toe;
+    eph.d_IODE_SF2 = IODE;
+    eph.d_IODE_SF3 = IODE;
+    eph.d_IODC = IODE;
+    eph.d_sqrt_A = 5153.6;
+    eph.d_M_0 = 0.5 + toe * 1e-6;
+    eph.d_TOW = toe - 7200.0;
+    return eph;
+}
+}
+
+
+TEST(EphemerisHistoryTest, StoresEachIssueOnce)
+{
+    Ephemeris_History history(4);
+    Gps_Ephemeris first = history_test_ephemeris(5, 7200.0, 1);
+    EXPECT_TRUE(history.store(5, first, 1000.0));
+
+    // the same ephemeris in a later subframe 3
+    Gps_Ephemeris repeated = first;
+    repeated.d_TOW += 30.0;
+    EXPECT_EQ(Ephemeris_History::hash(first), Ephemeris_History::hash(repeated));
+    EXPECT_FALSE(history.store(5, repeated, 31000.0));
+    EXPECT_EQ(1u, history.stored_count());
+
+    sEph latest;
+    ASSERT_TRUE(history.latest(5, latest));
+    EXPECT_EQ(1000.0, latest.time);
+    EXPECT_FALSE(latest.changed);
+    EXPECT_EQ(first.d_M_0, latest.ephemeris.d_M_0);
+    EXPECT_EQ(first.d_TOW, latest.ephemeris.d_TOW);
+    EXPECT_EQ(1.0, latest.ephemeris.d_IODE_SF3);
+    EXPECT_EQ(5u, latest.ephemeris.i_satellite_PRN);
+
+    Gps_Ephemeris second = history_test_ephemeris(5, 14400.0, 2);
+    EXPECT_NE(Ephemeris_History::hash(first), Ephemeris_History::hash(second));
+    EXPECT_TRUE(history.store(5, second, 7200e3));
+    ASSERT_TRUE(history.latest(5, latest));
+    EXPECT_TRUE(latest.changed);
+    EXPECT_EQ(14400.0, latest.ephemeris.d_Toe);
+
+    sEph found;
+    ASSERT_TRUE(history.find_issue(5, 7200.0, 1, found));
+    EXPECT_EQ(1000.0, found.time);
+    EXPECT_FALSE(history.find_issue(5, 7200.0, 2, found));
+    EXPECT_FALSE(history.find_issue(6, 7200.0, 1, found));
+    ASSERT_TRUE(history.find_same(5, repeated, found));
+    EXPECT_EQ(7200.0, found.ephemeris.d_Toe);
+    repeated.d_M_0 += 1e-9;
+    EXPECT_FALSE(history.find_same(5, repeated, found));
+
+    // a revert to the first one is stored again
+    EXPECT_TRUE(history.store(5, first, 7300e3));
+    EXPECT_EQ(3u, history.records(5).size());
+    ASSERT_TRUE(history.find_issue(5, 7200.0, 1, found));
+    EXPECT_EQ(7300e3, found.time);
+}
+
+
+TEST(EphemerisHistoryTest, ForgetsOverwrittenRecords)
+{
+    Ephemeris_History history(4);
+    for (int n = 0; n < 6; n++)
+        {
+            EXPECT_TRUE(history.store(9, history_test_ephemeris(9, 7200.0 * n, n), 7200e3 * n));
+        }
+    std::vector<sEph> records = history.records(9);
+    ASSERT_EQ(4u, records.size());
+    for (unsigned int r = 0; r < records.size(); r++)
+        {
+            EXPECT_EQ(7200.0 * (r + 2), records[r].ephemeris.d_Toe);
+            EXPECT_EQ(r + 2.0, records[r].ephemeris.d_IODE_SF2);
+        }
+    sEph found;
+    EXPECT_FALSE(history.find_issue(9, 7200.0, 1, found));
+    EXPECT_FALSE(history.find_same(9, history_test_ephemeris(9, 7200.0, 1), found));
+    EXPECT_TRUE(history.find_issue(9, 14400.0, 2, found));
+    EXPECT_TRUE(history.find_same(9, history_test_ephemeris(9, 14400.0, 2), found));
+}
+
+
+TEST(EphemerisHistoryTest, LatestSince)
+{
+    Ephemeris_History history;
+    unsigned long int stored = 0;
+    EXPECT_TRUE(history.latest_since(stored).empty());
+    history.store(3, history_test_ephemeris(3, 7200.0, 1), 0.0);
+    history.store(4, history_test_ephemeris(4, 7200.0, 1), 0.0);
+    history.store(3, history_test_ephemeris(3, 14400.0, 2), 0.0);
+    std::map<int, Gps_Ephemeris> ephemeris = history.latest_since(stored);
+    ASSERT_EQ(2u, ephemeris.size());
+    EXPECT_EQ(14400.0, ephemeris[3].d_Toe);
+    EXPECT_EQ(3u, stored);
+    EXPECT_TRUE(history.latest_since(stored).empty());
+
+    history.store(4, history_test_ephemeris(4, 7200.0, 1), 0.0);
+    history.store(4, history_test_ephemeris(4, 14400.0, 2), 0.0);
+    ephemeris = history.latest_since(stored);
+    ASSERT_EQ(1u, ephemeris.size());
+    EXPECT_EQ(2.0, ephemeris[4].d_IODE_SF2);
+}
+
+
+TEST(EphemerisHistoryTest, NaviRepeatedIssue)
+{
+    Spoofing_Message msg;
+    std::shared_ptr<Receiver_State> state = std::make_shared<Receiver_State>();
+    Receiver_State_Scope state_scope(state);
+    std::shared_ptr<InMemoryConfiguration> config = std::make_shared<InMemoryConfiguration>();
+    config->set_property("Spoofing.NAVI_exp_eph", "true");
+    config->set_property("Spoofing.alarm_min_interval_ms", "0");
+    Spoofing_Detector detector(config.get());
+
+    Gps_Navigation_Message nav;
+    nav.d_TOW_SF1 = 6.0;
+    nav.d_TOW_SF2 = 12.0;
+    nav.d_TOW_SF3 = 18.0;
+    nav.d_TOW = 18.0;
+    nav.i_GPS_week = 1850;
+    nav.d_sqrt_A = 5153.6;
+    nav.d_Toe = 7200.0;
+    nav.d_IODE_SF2 = nav.d_IODE_SF3 = nav.d_IODC = 1;
+    detector.New_subframe(3, 5, nav, 1000.0);
+    nav.d_TOW += 30.0;
+    detector.New_subframe(3, 5, nav, 31000.0);
+    // a new issue, two hours later
+    nav.d_Toe = 14400.0;
+    nav.d_IODE_SF2 = nav.d_IODE_SF3 = nav.d_IODC = 2;
+    detector.New_subframe(3, 5, nav, 7201e3);
+    EXPECT_FALSE(state->spoofing_queue.try_pop(msg));
+    EXPECT_EQ(2u, state->ephemeris_history.records(5).size());
+
+    // the same issue with other data
+    nav.d_M_0 = 0.1;
+    detector.New_subframe(3, 5, nav, 7231e3);
+    ASSERT_TRUE(state->spoofing_queue.try_pop(msg));
+    EXPECT_EQ(5, msg.spoofing_case);
+    EXPECT_EQ("The Ephemeris has changed without a new issue of data", msg.description);
+    EXPECT_FALSE(state->spoofing_queue.try_pop(msg));
+
+    // back to the first issue
+    nav.d_M_0 = 0.0;
+    nav.d_Toe = 7200.0;
+    nav.d_IODE_SF2 = nav.d_IODE_SF3 = nav.d_IODC = 1;
+    detector.New_subframe(3, 5, nav, 7261e3);
+    ASSERT_TRUE(state->spoofing_queue.try_pop(msg));
+    EXPECT_EQ("The Ephemeris has reverted to an earlier issue of data", msg.description);
+    EXPECT_FALSE(state->spoofing_queue.try_pop(msg));
+}
@@ -0,0 +1,108 @@
+/*!
+ * \file epoch_arena_test.cc
+ * \brief  This file implements tests for the per-epoch arena and its allocator
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <gtest/gtest.h>
+#include "epoch_arena.h"
+
+
+TEST(EpochArenaTest, ReuseAfterReset)
+{
+    Epoch_Arena arena(1024);
+    double* a = arena.allocate<double>(10);
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(a) % alignof(double));
+    EXPECT_LE(10 * sizeof(double), arena.used());
+    arena.reset();
+    EXPECT_EQ(0u, arena.used());
+    EXPECT_EQ(a, arena.allocate<double>(10));
+    EXPECT_EQ(0u, arena.overflows());
+}
+
+
+TEST(EpochArenaTest, GrowAfterOverflow)
+{
+    Epoch_Arena arena(64);
+    for (int epoch = 0; epoch < 3; epoch++)
+        {
+            arena.reset();
+            Channel_List channels((Arena_Allocator<unsigned int>(&arena)));
+            for (unsigned int ch = 0; ch < 12; ch++)
+                {
+                    channels.push_back(ch);
+                }
+            channels.remove(3);
+            EXPECT_EQ(11u, channels.size());
+            EXPECT_EQ(11u, channels.back());
+        }
+    // only the first epoch overflows, the buffer fits the next ones
+    EXPECT_LT(0u, arena.overflows());
+    unsigned long int overflows = arena.overflows();
+    arena.reset();
+    std::map<unsigned int, unsigned int, std::less<unsigned int>, Arena_Allocator<std::pair<const unsigned int, unsigned int> > >
+            peaks((std::less<unsigned int>()), Arena_Allocator<std::pair<const unsigned int, unsigned int> >(&arena));
+    for (unsigned int prn = 1; prn <= 8; prn++)
+        {
+            peaks[prn] = prn;
+        }
+    EXPECT_EQ(overflows, arena.overflows());
+    EXPECT_LT(64u, arena.capacity());
+}
+
+
+TEST(EpochArenaTest, CopiesOnHeap)
+{
+    Epoch_Arena arena;
+    Channel_List copy;
+    Channel_List assigned;
+    {
+        Channel_List channels((Arena_Allocator<unsigned int>(&arena)));
+        channels.push_back(4);
+        channels.push_back(7);
+        Channel_List copied(channels);
+        EXPECT_EQ(0, copied.get_allocator().arena());
+        copy.swap(copied);
+        assigned = channels;
+        EXPECT_EQ(0, assigned.get_allocator().arena());
+    }
+
+    // the copies outlive the epoch
+    arena.reset();
+    Channel_List other((Arena_Allocator<unsigned int>(&arena)));
+    other.push_back(1);
+    other.push_back(2);
+    ASSERT_EQ(2u, copy.size());
+    EXPECT_EQ(4u, copy.front());
+    EXPECT_EQ(7u, copy.back());
+    EXPECT_EQ(7u, assigned.back());
+}
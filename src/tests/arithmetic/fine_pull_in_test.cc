@@ -0,0 +1,105 @@
+/*!
+ * \file fine_pull_in_test.cc
+ * \brief  This file implements tests for the refinement of the acquisition
+ * Doppler and code phase before the tracking loops are closed
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cmath>
+#include <complex>
+#include <gtest/gtest.h>
+#include "fine_pull_in.h"
+
+namespace
+{
+// Early, Prompt and Late of a code period, for a triangle correlation
+// and a replica error_chips late, rotating at doppler_error_hz
+void correlate_period(int period, double doppler_error_hz, double error_chips, float bit,
+        std::complex<float>* taps)
+{
+    double phase = 2.0 * M_PI * doppler_error_hz * 0.001 * period + 0.4;
+    std::complex<float> rotation(std::cos(phase), std::sin(phase));
+    for (int n = 0; n < 3; n++)
+        {
+            double offset = static_cast<double>(n - 1) * 0.5 + error_chips;
+            taps[n] = bit * static_cast<float>(100.0 * std::max(1.0 - std::abs(offset), 0.0)) * rotation;
+        }
+}
+}
+
+
+TEST(FinePullInTest, DopplerAndCodePhase)
+{
+    Fine_Pull_In pull_in;
+    EXPECT_FALSE(pull_in.enabled());
+    EXPECT_FALSE(pull_in.active());
+    pull_in.configure(20, 0.001, 0.5);
+    ASSERT_TRUE(pull_in.active());
+    std::complex<float> taps[3];
+    for (int period = 0; period < 20; period++)
+        {
+            // the navigation bit changes at the 8th period
+            correlate_period(period, 183.0, 0.2, period < 7 ? 1.0 : -1.0, taps);
+            EXPECT_EQ(period == 19, pull_in.add(taps[0], taps[1], taps[2]));
+        }
+    EXPECT_FALSE(pull_in.active());
+    ASSERT_TRUE(pull_in.reliable());
+    EXPECT_NEAR(183.0, pull_in.doppler_error_hz(), 5.0);
+    // Early is larger than Late, as in the DLL discriminators
+    EXPECT_NEAR(0.2, pull_in.code_error_chips(), 1e-3);
+
+    pull_in.reset();
+    for (int period = 0; period < 20; period++)
+        {
+            correlate_period(period, -240.0, -0.1, 1.0, taps);
+            pull_in.add(taps[0], taps[1], taps[2]);
+        }
+    ASSERT_TRUE(pull_in.reliable());
+    EXPECT_NEAR(-240.0, pull_in.doppler_error_hz(), 5.0);
+    EXPECT_NEAR(-0.1, pull_in.code_error_chips(), 1e-3);
+}
+
+
+TEST(FinePullInTest, NoEstimateWithoutPeak)
+{
+    Fine_Pull_In pull_in;
+    pull_in.configure(20, 0.001, 0.5);
+    // a prompt that jumps around the circle has no clear frequency
+    std::complex<float> taps[3];
+    for (int period = 0; period < 20; period++)
+        {
+            double phase = 2.0 * (period * period % 7);
+            taps[1] = std::complex<float>(std::cos(phase), std::sin(phase));
+            taps[0] = taps[2] = 0.5f * taps[1];
+            pull_in.add(taps[0], taps[1], taps[2]);
+        }
+    EXPECT_FALSE(pull_in.active());
+    EXPECT_FALSE(pull_in.reliable());
+    EXPECT_EQ(0.0, pull_in.doppler_error_hz());
+    EXPECT_EQ(0.0, pull_in.code_error_chips());
+}
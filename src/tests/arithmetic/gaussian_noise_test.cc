@@ -0,0 +1,98 @@
+/*!
+ * \file gaussian_noise_test.cc
+ * \brief  This file implements tests for the Ziggurat noise generator
+ * of the signal generator
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cmath>
+#include <vector>
+#include <gtest/gtest.h>
+#include "gaussian_noise.h"
+
+
+TEST(GaussianNoiseTest, HasTheMomentsAndTailsOfTheNormal)
+{
+    Gaussian_Noise noise(7);
+    const unsigned int n = 4000000;
+    double sum = 0.0, sum2 = 0.0, sum4 = 0.0;
+    unsigned int beyond_2 = 0;
+    unsigned int beyond_3 = 0;
+    for (unsigned int i = 0; i < n; i++)
+        {
+            const double x = noise.gauss();
+            sum += x;
+            sum2 += x * x;
+            sum4 += x * x * x * x;
+            beyond_2 += std::fabs(x) > 2.0 ? 1 : 0;
+            beyond_3 += std::fabs(x) > 3.0 ? 1 : 0;
+        }
+    // five standard errors of each estimate
+    EXPECT_NEAR(0.0, sum / n, 5.0 * std::sqrt(1.0 / n));
+    EXPECT_NEAR(1.0, sum2 / n, 5.0 * std::sqrt(2.0 / n));
+    EXPECT_NEAR(3.0, sum4 / n, 5.0 * std::sqrt(96.0 / n));
+    EXPECT_NEAR(0.0455003, static_cast<double>(beyond_2) / n, 5.0 * std::sqrt(0.0455003 / n));
+    EXPECT_NEAR(0.0026998, static_cast<double>(beyond_3) / n, 5.0 * std::sqrt(0.0026998 / n));
+}
+
+
+TEST(GaussianNoiseTest, AddsIndependentComplexNoise)
+{
+    Gaussian_Noise noise;
+    const unsigned int n = 1000000;
+    std::vector<gr_complex> samples(n, gr_complex(1.0, -1.0));
+    noise.add_complex(&samples[0], n, 0.5);
+    double mean_re = 0.0, mean_im = 0.0, var_re = 0.0, var_im = 0.0, cov = 0.0;
+    for (unsigned int i = 0; i < n; i++)
+        {
+            const double re = samples[i].real() - 1.0;
+            const double im = samples[i].imag() + 1.0;
+            mean_re += re;
+            mean_im += im;
+            var_re += re * re;
+            var_im += im * im;
+            cov += re * im;
+        }
+    EXPECT_NEAR(0.0, mean_re / n, 0.005);
+    EXPECT_NEAR(0.0, mean_im / n, 0.005);
+    EXPECT_NEAR(0.25, var_re / n, 0.005);
+    EXPECT_NEAR(0.25, var_im / n, 0.005);
+    EXPECT_NEAR(0.0, cov / n, 0.005);
+}
+
+
+TEST(GaussianNoiseTest, SameSeedSameSequence)
+{
+    Gaussian_Noise first(42);
+    Gaussian_Noise second(41);
+    second.seed(42);
+    for (unsigned int i = 0; i < 1000; i++)
+        {
+            ASSERT_EQ(first.gauss(), second.gauss());
+        }
+}
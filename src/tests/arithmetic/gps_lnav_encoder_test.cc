@@ -0,0 +1,212 @@
+/*!
+ * \file gps_lnav_encoder_test.cc
+ * \brief  This file implements tests for the GPS LNAV encoder
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cmath>
+#include <cstring>
+#include <gtest/gtest.h>
+#include "gps_lnav_encoder.h"
+#include "gps_navigation_message.h"
+
+
+namespace
+{
+// The parity check of gps_l1_ca_telemetry_decoder_cc: bits 31 and 30 hold
+// bits 29 and 30 of the previous word, the data bits are not inverted
+bool decoder_parity_check(unsigned int gpsword)
+{
+    #define ROTL(X, N) ((X << N) ^ (X >> (32 - N)))
+    unsigned int d1 = gpsword & 0xFBFFBF00;
+    unsigned int d2 = ROTL(gpsword, 1) & 0x07FFBF01;
+    unsigned int d3 = ROTL(gpsword, 2) & 0xFC0F8100;
+    unsigned int d4 = ROTL(gpsword, 3) & 0xF81FFE02;
+    unsigned int d5 = ROTL(gpsword, 4) & 0xFC00000E;
+    unsigned int d6 = ROTL(gpsword, 5) & 0x07F00001;
+    unsigned int d7 = ROTL(gpsword, 6) & 0x00003000;
+    unsigned int t = d1 ^ d2 ^ d3 ^ d4 ^ d5 ^ d6 ^ d7;
+    unsigned int parity = t ^ ROTL(t, 6) ^ ROTL(t, 12) ^ ROTL(t, 18) ^ ROTL(t, 24);
+    #undef ROTL
+    return (parity & 0x3F) == (gpsword & 0x3F);
+}
+
+
+Gps_Ephemeris test_ephemeris()
+{
+    Gps_Ephemeris eph;
+    eph.i_satellite_PRN = 7;
+    eph.i_GPS_week = 1873;
+    eph.i_code_on_L2 = 1;
+    eph.i_SV_accuracy = 2;
+    eph.i_SV_health = 0;
+    eph.b_L2_P_data_flag = false;
+    eph.d_TGD = -1.117587089539e-08;
+    eph.d_IODC = 77;
+    eph.d_IODE_SF2 = 77;
+    eph.d_IODE_SF3 = 77;
+    eph.d_Toc = 352800;
+    eph.d_Toe = 352800;
+    eph.d_A_f0 = 1.543695107102e-04;
+    eph.d_A_f1 = -2.273736754432e-12;
+    eph.d_A_f2 = 0.0;
+    eph.d_Crs = -4.587500000000e+01;
+    eph.d_Delta_n = 4.587691700636e-09;
+    eph.d_M_0 = -2.346593624512;
+    eph.d_Cuc = -2.389401197433e-06;
+    eph.d_e_eccentricity = 1.160842052195e-02;
+    eph.d_Cus = 6.781518459320e-06;
+    eph.d_sqrt_A = 5.153665531158e+03;
+    eph.d_Cic = 1.117587089539e-07;
+    eph.d_OMEGA0 = 2.614396134872;
+    eph.d_Cis = -6.332993507385e-08;
+    eph.d_i_0 = 9.565436226917e-01;
+    eph.d_Crc = 2.488125000000e+02;
+    eph.d_OMEGA = -2.191431428826;
+    eph.d_OMEGA_DOT = -8.115694626034e-09;
+    eph.d_IDOT = 3.107272283720e-10;
+    return eph;
+}
+}
+
+
+TEST(GpsLnavEncoderTest, ParityOfEveryWord)
+{
+    Gps_Lnav_Encoder encoder;
+    encoder.set_ephemeris(test_ephemeris());
+    for (unsigned int tow = 352800; tow < 352800 + 30; tow += 6)
+        {
+            Gps_Subframe_Words subframe = encoder.encode_subframe(tow);
+            unsigned int previous = 0;  // word 10 of the previous subframe ends with 00
+            for (int i = 0; i < 10; i++)
+                {
+                    EXPECT_TRUE(decoder_parity_check(subframe.words[i] | ((previous & 3) << 30))) << "word " << i + 1;
+                    previous = subframe.words[i];
+                }
+            EXPECT_EQ(0u, subframe.words[1] & 3);
+            EXPECT_EQ(0u, subframe.words[9] & 3);
+            EXPECT_EQ(0x8Bu, subframe.words[0] >> 22);
+        }
+}
+
+
+TEST(GpsLnavEncoderTest, DecodedByTheNavigationMessage)
+{
+    Gps_Ephemeris eph = test_ephemeris();
+    Gps_Iono iono;
+    iono.d_alpha0 = 1.676380634308e-08;
+    iono.d_beta0 = 1.105920000000e+05;
+    Gps_Utc_Model utc;
+    utc.d_A0 = 1.862645149231e-09;
+    utc.d_t_OT = 405504;
+    utc.i_WN_T = 1873;
+    utc.d_DeltaT_LS = 17;
+    Gps_Lnav_Encoder encoder;
+    encoder.set_ephemeris(eph);
+    encoder.set_iono(iono);
+    encoder.set_utc_model(utc);
+
+    Gps_Navigation_Message nav;
+    nav.i_satellite_PRN = 7;
+    for (unsigned int tow = 352800; tow < 352800 + 30; tow += 6)
+        {
+            Gps_Subframe_Words subframe = encoder.encode_subframe(tow);
+            char bytes[40];
+            std::memcpy(bytes, subframe.words, sizeof(bytes));
+            EXPECT_EQ(static_cast<int>((tow / 6) % 5 + 1), nav.subframe_decoder(bytes));
+            EXPECT_EQ(tow, nav.d_TOW);
+        }
+    ASSERT_TRUE(nav.satellite_validation());
+    Gps_Ephemeris decoded = nav.get_ephemeris();
+    EXPECT_EQ(eph.i_GPS_week % 1024, decoded.i_GPS_week);
+    EXPECT_EQ(eph.i_SV_accuracy, decoded.i_SV_accuracy);
+    EXPECT_EQ(eph.d_IODC, decoded.d_IODC);
+    EXPECT_EQ(eph.d_Toe, decoded.d_Toe);
+    EXPECT_EQ(eph.d_Toc, decoded.d_Toc);
+    EXPECT_NEAR(eph.d_TGD, decoded.d_TGD, T_GD_LSB);
+    EXPECT_NEAR(eph.d_A_f0, decoded.d_A_f0, A_F0_LSB);
+    EXPECT_NEAR(eph.d_A_f1, decoded.d_A_f1, A_F1_LSB);
+    EXPECT_NEAR(eph.d_Crs, decoded.d_Crs, C_RS_LSB);
+    EXPECT_NEAR(eph.d_M_0, decoded.d_M_0, M_0_LSB);
+    EXPECT_NEAR(eph.d_e_eccentricity, decoded.d_e_eccentricity, E_LSB);
+    EXPECT_NEAR(eph.d_sqrt_A, decoded.d_sqrt_A, SQRT_A_LSB);
+    EXPECT_NEAR(eph.d_OMEGA0, decoded.d_OMEGA0, OMEGA_0_LSB);
+    EXPECT_NEAR(eph.d_i_0, decoded.d_i_0, I_0_LSB);
+    EXPECT_NEAR(eph.d_OMEGA, decoded.d_OMEGA, OMEGA_LSB);
+    EXPECT_NEAR(eph.d_OMEGA_DOT, decoded.d_OMEGA_DOT, OMEGA_DOT_LSB);
+    EXPECT_NEAR(eph.d_IDOT, decoded.d_IDOT, I_DOT_LSB);
+    EXPECT_NEAR(eph.d_Cis, decoded.d_Cis, C_IS_LSB);
+
+    ASSERT_TRUE(nav.flag_iono_valid);
+    EXPECT_NEAR(iono.d_alpha0, nav.get_iono().d_alpha0, ALPHA_0_LSB);
+    EXPECT_NEAR(iono.d_beta0, nav.get_iono().d_beta0, BETA_0_LSB);
+    EXPECT_NEAR(utc.d_A0, nav.get_utc_model().d_A0, A_0_LSB);
+    EXPECT_EQ(utc.d_t_OT, nav.get_utc_model().d_t_OT);
+    EXPECT_EQ(utc.i_WN_T % 256, nav.get_utc_model().i_WN_T);
+    EXPECT_EQ(utc.d_DeltaT_LS, nav.get_utc_model().d_DeltaT_LS);
+}
+
+
+TEST(GpsLnavEncoderTest, BitStreamAndTowJump)
+{
+    Gps_Lnav_Encoder encoder;
+    encoder.set_ephemeris(test_ephemeris());
+    encoder.start(352803.0);
+    EXPECT_EQ(352800u, encoder.tow_s());
+
+    // undo the inversion of the data bits, as the telemetry decoder does
+    bool previous_d30 = false;
+    for (unsigned int tow = 352800; tow < 352800 + 12; tow += 6)
+        {
+            Gps_Subframe_Words expected = encoder.encode_subframe(tow);
+            for (int i = 0; i < 10; i++)
+                {
+                    unsigned int word = 0;
+                    for (int b = 0; b < 30; b++)
+                        {
+                            word = (word << 1) | (encoder.next_bit() > 0 ? 1 : 0);
+                        }
+                    if (previous_d30)
+                        {
+                            word ^= 0x3FFFFFC0;
+                        }
+                    EXPECT_EQ(expected.words[i], word) << "TOW " << tow << " word " << i + 1;
+                    previous_d30 = word & 1;
+                }
+        }
+
+    // a jump is transmitted from the next subframe
+    encoder.next_bit();
+    encoder.jump_tow(3600);
+    EXPECT_EQ(352812u, encoder.tow_s());
+    for (int b = 1; b < 300; b++)
+        {
+            encoder.next_bit();
+        }
+    EXPECT_EQ(352818u + 3600u, encoder.tow_s());
+}
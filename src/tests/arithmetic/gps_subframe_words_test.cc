@@ -0,0 +1,122 @@
+/*!
+ * \file gps_subframe_words_test.cc
+ * \brief  This file implements tests for the bit-packed GPS NAV subframes
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include "gps_subframe_words.h"
+
+
+namespace
+{
+// Sets bits [first, first + length) of the subframe, numbered as in GPS_L1_CA.h
+void set_field(Gps_Subframe_Words& subframe, int first, int length, unsigned int value)
+{
+    for (int n = first; n < first + length; n++)
+        {
+            int word = (n - 1) / 30;
+            int bit = 29 - (n - 1) % 30;
+            unsigned int b = (value >> (first + length - 1 - n)) & 1;
+            subframe.words[word] = (subframe.words[word] & ~(1u << bit)) | (b << bit);
+        }
+}
+
+
+Gps_Subframe_Words make_subframe(unsigned int subframe_id, unsigned int page)
+{
+    Gps_Subframe_Words subframe;
+    set_field(subframe, 1, 8, 0x8B);   // preamble
+    set_field(subframe, 31, 17, 12345); // TOW
+    set_field(subframe, 50, 3, subframe_id);
+    set_field(subframe, 61, 2, 1);     // data ID
+    set_field(subframe, 63, 6, page);
+    for (int n = 69; n < 300; n += 7)
+        {
+            set_field(subframe, n, 1, 1);
+        }
+    return subframe;
+}
+}
+
+
+TEST(GpsSubframeWordsTest, FieldsAndEmpty)
+{
+    Gps_Subframe_Words subframe;
+    EXPECT_TRUE(subframe.empty());
+    subframe = make_subframe(4, 56);
+    EXPECT_FALSE(subframe.empty());
+    EXPECT_EQ(56u, subframe.sv_page());
+    EXPECT_EQ(0x8Bu, subframe.words[0] >> 22);
+    EXPECT_EQ(89u, subframe.to_string().size());
+    subframe.clear();
+    EXPECT_TRUE(subframe.empty());
+}
+
+
+TEST(GpsSubframeWordsTest, ComparesOnlyTheNavigationData)
+{
+    Gps_Subframe_Words a = make_subframe(1, 0);
+    Gps_Subframe_Words b = a;
+    EXPECT_TRUE(a.same_data(b));
+
+    set_field(b, 9, 14, 0x1234); // TLM message
+    set_field(b, 25, 6, 0x3F);   // parity
+    set_field(b, 293, 2, 3);     // parity solving bits
+    EXPECT_TRUE(a.same_data(b));
+
+    set_field(b, 48, 1, 1);      // alert flag
+    EXPECT_FALSE(a.same_data(b));
+
+    b = a;
+    set_field(b, 202, 1, 0);
+    EXPECT_FALSE(a.same_data(b));
+    set_field(b, 202, 1, 1);
+    set_field(b, 31, 17, 12346);
+    EXPECT_FALSE(a.same_data(b));
+}
+
+
+TEST(GpsSubframeWordsTest, AlmanacPagesAcrossSatellites)
+{
+    // the flags of the HOW belong to the transmitting satellite
+    Gps_Subframe_Words a = make_subframe(5, 3);
+    Gps_Subframe_Words b = a;
+    set_field(b, 48, 2, 3);
+    EXPECT_TRUE(a.same_data(b));
+    set_field(b, 153, 1, 0);
+    EXPECT_FALSE(a.same_data(b));
+
+    // reserved pages are compared by their header only
+    a = make_subframe(4, 57);
+    b = a;
+    set_field(b, 153, 1, 0);
+    EXPECT_TRUE(a.same_data(b));
+    set_field(b, 63, 6, 58);
+    EXPECT_FALSE(a.same_data(b));
+}
@@ -0,0 +1,106 @@
+/*!
+ * \file latency_trace_test.cc
+ * \brief  This file implements tests for the sample-to-solution latency trace
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "latency_trace.h"
+
+
+TEST(LatencyTraceTest, LatencyFromTheSource)
+{
+    Latency_Trace::start(64);
+    Latency_Trace::record(LATENCY_SOURCE, 0, 1000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    LATENCY_TRACE(LATENCY_TRACKING, 2, 500);
+    Latency_Trace::record_alarm(3);
+    // no source event has delivered this sample yet
+    LATENCY_TRACE(LATENCY_TRACKING, 2, 1500);
+    Latency_Trace::stop();
+    LATENCY_TRACE(LATENCY_TRACKING, 2, 600);
+
+    std::vector<double> latencies;
+    Latency_Trace::latencies_s(LATENCY_TRACKING, latencies);
+    ASSERT_EQ(1u, latencies.size());
+    EXPECT_GE(latencies[0], 0.02);
+    EXPECT_LT(latencies[0], 1.0);
+
+    // the alarm refers to the newest sample processed when it was raised
+    Latency_Trace::latencies_s(LATENCY_SPOOFING_ALARM, latencies);
+    ASSERT_EQ(1u, latencies.size());
+    EXPECT_GE(latencies[0], 0.02);
+}
+
+
+TEST(LatencyTraceTest, RingKeepsTheLatestEvents)
+{
+    Latency_Trace::start(5); // rounded up to 8
+    for (unsigned int i = 1; i <= 20; i++)
+        {
+            Latency_Trace::record(LATENCY_SOURCE, 0, 100 * i);
+            Latency_Trace::record(LATENCY_PVT, -1, 100 * i - 50);
+        }
+    Latency_Trace::stop();
+    std::vector<double> latencies;
+    Latency_Trace::latencies_s(LATENCY_PVT, latencies);
+    // the oldest PVT event left has no source event before it in the ring
+    EXPECT_EQ(3u, latencies.size());
+}
+
+
+TEST(LatencyTraceTest, ChromeTrace)
+{
+    Latency_Trace::start(16);
+    Latency_Trace::record(LATENCY_SOURCE, 0, 4000);
+    Latency_Trace::record(LATENCY_ACQUISITION, 1, 4000);
+    Latency_Trace::record(LATENCY_OBSERVABLES, -1, 3000);
+    Latency_Trace::stop();
+    std::string filename = "./latency_trace_test.json";
+    ASSERT_TRUE(Latency_Trace::write_chrome_trace(filename));
+    std::ifstream file(filename.c_str());
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string json = contents.str();
+    EXPECT_EQ(0u, json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    EXPECT_NE(std::string::npos, json.find("\"args\":{\"name\":\"observables -1\"}"));
+    // the sample of the acquisition arrives after the last source event
+    EXPECT_NE(std::string::npos, json.find("\"name\":\"acquisition\",\"cat\":\"latency\",\"pid\":1,\"tid\":2002,\"ph\":\"i\""));
+    EXPECT_NE(std::string::npos, json.find("\"name\":\"observables\",\"cat\":\"latency\",\"pid\":1,\"tid\":5000,\"ph\":\"X\""));
+    EXPECT_EQ("]}", json.substr(json.size() - 3, 2));
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,199 @@
+/*!
+ * \file lnav_word_framer_test.cc
+ * \brief  This file implements tests for the framing of the GPS L1 C/A navigation words
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include "gnss_synchro.h"
+#include "gps_l1_ca_subframe_fsm.h"
+#include "gps_lnav_encoder.h"
+#include "lnav_word_framer.h"
+
+namespace
+{
+// the parity check the GPS L1 C/A telemetry decoders used before
+bool lnav_word_framer_reference_parity(unsigned int gpsword)
+{
+    #define ROTL(X, N) ((X << N) ^ (X >> (32 - N)))
+    unsigned int d1 = gpsword & 0xFBFFBF00;
+    unsigned int d2 = ROTL(gpsword, 1) & 0x07FFBF01;
+    unsigned int d3 = ROTL(gpsword, 2) & 0xFC0F8100;
+    unsigned int d4 = ROTL(gpsword, 3) & 0xF81FFE02;
+    unsigned int d5 = ROTL(gpsword, 4) & 0xFC00000E;
+    unsigned int d6 = ROTL(gpsword, 5) & 0x07F00001;
+    unsigned int d7 = ROTL(gpsword, 6) & 0x00003000;
+    unsigned int t = d1 ^ d2 ^ d3 ^ d4 ^ d5 ^ d6 ^ d7;
+    unsigned int parity = t ^ ROTL(t, 6) ^ ROTL(t, 12) ^ ROTL(t, 18) ^ ROTL(t, 24);
+    #undef ROTL
+    return (parity & 0x3F) == (gpsword & 0x3F);
+}
+}
+
+
+TEST(Lnav_Word_Framer_Test, ParityMatchesTheShiftAndXorCheck)
+{
+    std::srand(13);
+    for (int i = 0; i < 100000; i++)
+        {
+            unsigned int word = (static_cast<unsigned int>(std::rand()) << 16) ^ static_cast<unsigned int>(std::rand());
+            if (i % 2 == 0)
+                {
+                    // half of them with their right parity
+                    word = (word & 0xFFFFFFC0) | Gps_Lnav_Encoder::parity(word << 2 & 0xFFFFFF00, word & 0x80000000, word & 0x40000000);
+                }
+            ASSERT_EQ(lnav_word_framer_reference_parity(word), Lnav_Word_Framer::parity_check(word)) << std::hex << word;
+        }
+}
+
+
+TEST(Lnav_Word_Framer_Test, FramesTheTransmittedWords)
+{
+    Gps_Ephemeris eph;
+    eph.i_satellite_PRN = 3;
+    eph.i_GPS_week = 1873;
+    eph.d_Toe = 352800;
+    eph.d_Toc = 352800;
+    eph.d_sqrt_A = 5153.7;
+    eph.d_e_eccentricity = 0.01;
+    Gps_Lnav_Encoder encoder;
+    encoder.set_ephemeris(eph);
+    encoder.start(352800.0);
+
+    Lnav_Word_Framer framer;
+    Gnss_Synchro symbol = Gnss_Synchro();
+    symbol.Flag_valid_symbol_output = true;
+    symbol.correlation_length_ms = 1;
+    for (unsigned int tow = 352800; tow < 352800 + 12; tow += 6)
+        {
+            Gps_Subframe_Words expected = encoder.encode_subframe(tow);
+            for (int i = 0; i < 10; i++)
+                {
+                    bool word_completed = false;
+                    for (int b = 0; b < 30; b++)
+                        {
+                            int bit = encoder.next_bit();
+                            for (int ms = 0; ms < 20; ms++)
+                                {
+                                    ASSERT_FALSE(word_completed);
+                                    symbol.Prompt_I = 1000.0 * bit;
+                                    word_completed = framer.push_symbol(symbol);
+                                }
+                        }
+                    ASSERT_TRUE(word_completed);
+                    EXPECT_TRUE(framer.parity_ok()) << "TOW " << tow << " word " << i + 1;
+                    EXPECT_EQ(expected.words[i], framer.word() & 0x3FFFFFFF) << "TOW " << tow << " word " << i + 1;
+                }
+        }
+
+    unsigned int word = framer.word();
+    EXPECT_FALSE(Lnav_Word_Framer::parity_check(word ^ 0x00100000));
+    // the same word transmitted after a D30 of 1 has its data bits inverted
+    unsigned int inverted = (word & 0x3FFFFFFF) ^ 0x3FFFFFC0;
+    EXPECT_EQ((word & 0x3FFFFFFF) | 0x40000000, Lnav_Word_Framer::restore_polarity(inverted, 0x1));
+}
+
+
+TEST(Lnav_Word_Framer_Test, SyncBitsRestartsTheWord)
+{
+    Lnav_Word_Framer framer;
+    for (int b = 0; b < 17; b++)
+        {
+            EXPECT_FALSE(framer.push_bit(true));
+        }
+    framer.sync_bits();
+    for (int b = 0; b < 29; b++)
+        {
+            EXPECT_FALSE(framer.push_bit(b % 3 == 0));
+        }
+    EXPECT_TRUE(framer.push_bit(false));
+    unsigned int expected = 0;
+    for (int b = 0; b < 30; b++)
+        {
+            expected = (expected << 1) | ((b < 29 && b % 3 == 0) ? 1 : 0);
+        }
+    // the previous word was empty, so D29 and D30 are 0 and nothing is inverted
+    EXPECT_EQ(expected, framer.word());
+}
+
+
+TEST(Lnav_Word_Framer_Test, SubframeFsmAssemblesTheWords)
+{
+    Gps_Ephemeris eph;
+    eph.i_satellite_PRN = 3;
+    eph.i_GPS_week = 1873;
+    eph.d_Toe = 352800;
+    eph.d_Toc = 352800;
+    eph.d_sqrt_A = 5153.7;
+    Gps_Lnav_Encoder encoder;
+    encoder.set_ephemeris(eph);
+    encoder.start(352800.0);
+
+    Lnav_Word_Framer framer;
+    GpsL1CaSubframeFsm fsm;
+    fsm.i_satellite_PRN = 3;
+    for (unsigned int tow = 352800; tow < 352800 + 18; tow += 6)
+        {
+            bool second = tow == 352806;
+            fsm.Event_gps_word_preamble();
+            for (int i = 0; i < 10; i++)
+                {
+                    for (int b = 0; b < 30; b++)
+                        {
+                            framer.push_bit(encoder.next_bit() > 0);
+                        }
+                    EXPECT_FALSE(fsm.d_flag_new_subframe) << "TOW " << tow << " word " << i + 1;
+                    if (second && i == 3)
+                        {
+                            // a word with a parity error drops the subframe
+                            fsm.Event_gps_word_invalid();
+                        }
+                    else
+                        {
+                            fsm.Event_gps_word(framer);
+                        }
+                    if (tow == 352800 && i < 9)
+                        {
+                            // a preamble in the middle of the subframe is ignored
+                            fsm.Event_gps_word_preamble();
+                        }
+                }
+            if (second)
+                {
+                    EXPECT_FALSE(fsm.d_flag_new_subframe);
+                    continue;
+                }
+            ASSERT_TRUE(fsm.d_flag_new_subframe) << "TOW " << tow;
+            EXPECT_EQ(static_cast<int>((tow / 6) % 5 + 1), fsm.d_subframe_ID);
+            EXPECT_EQ(tow, fsm.d_nav.d_TOW);
+            fsm.clear_flag_new_subframe();
+        }
+}
@@ -0,0 +1,66 @@
+/*!
+ * \file lock_detectors_test.cc
+ * \brief  This file implements tests for the CN0 estimator and the carrier lock detector
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <gtest/gtest.h>
+#include "lock_detectors.h"
+
+
+TEST(LockDetectorsTest, SinglePassMatchesTheEstimators)
+{
+    const int length = 20;
+    const long fs_in = 4000000;
+    const double code_length = 1023.0;
+    std::vector<std::vector<gr_complex> > buffers(3, std::vector<gr_complex>(length));
+    for (int n = 0; n < length; n++)
+        {
+            // bits on the in-phase arm with a small phase error and noise
+            float bit = (n / 7) % 2 ? -1.0 : 1.0;
+            buffers[0][n] = gr_complex(4000.0 * bit + 150.0 * std::sin(1.3 * n), 300.0 + 200.0 * std::cos(0.7 * n));
+            buffers[1][n] = gr_complex(900.0 * bit + 400.0 * std::sin(2.1 * n), 100.0 - 350.0 * std::cos(0.4 * n));
+            buffers[2][n] = gr_complex(500.0 * std::sin(0.9 * n), 500.0 * std::cos(1.7 * n));
+        }
+
+    const gr_complex* prompts[3] = {&buffers[0][0], &buffers[1][0], &buffers[2][0]};
+    const double code_lengths[3] = {code_length, code_length, 20 * code_length};
+    float cn0[3];
+    float lock[3];
+    cn0_and_carrier_lock_batch(prompts, 3, length, fs_in, code_lengths, cn0, lock);
+    for (int k = 0; k < 3; k++)
+        {
+            EXPECT_NEAR(cn0_svn_estimator(&buffers[k][0], length, fs_in, code_lengths[k]), cn0[k], 1e-3) << "channel " << k;
+            EXPECT_NEAR(carrier_lock_detector(&buffers[k][0], length), lock[k], 1e-4) << "channel " << k;
+        }
+    EXPECT_GT(lock[0], 0.85);
+    EXPECT_GT(cn0[0], cn0[1]);
+}
@@ -0,0 +1,81 @@
+/*!
+ * \file message_pool_test.cc
+ * \brief  This file implements tests for the preallocated payloads of the
+ * navigation data messages and of the channel events
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <memory>
+#include <gtest/gtest.h>
+#include "channel_event.h"
+#include "gps_iono.h"
+#include "message_pool.h"
+
+
+TEST(MessagePoolTest, ReusesReleasedSlots)
+{
+    Message_Pool<Gps_Iono> pool(2);
+    Gps_Iono iono;
+    iono.d_alpha0 = 1.0;
+    std::shared_ptr<Gps_Iono> first = pool.acquire(std::move(iono));
+    EXPECT_EQ(1.0, first->d_alpha0);
+    Gps_Iono* first_slot = first.get();
+
+    // the receiver still holds the first payload
+    iono.d_alpha0 = 2.0;
+    std::shared_ptr<Gps_Iono> second = pool.acquire(std::move(iono));
+    EXPECT_NE(first_slot, second.get());
+    EXPECT_EQ(1.0, first->d_alpha0);
+    EXPECT_EQ(2.0, second->d_alpha0);
+
+    // every slot is in flight, the payload is allocated
+    iono.d_alpha0 = 3.0;
+    std::shared_ptr<Gps_Iono> third = pool.acquire(std::move(iono));
+    EXPECT_EQ(3.0, third->d_alpha0);
+    EXPECT_EQ(1u, pool.misses());
+
+    // the first payload has been handled
+    first.reset();
+    iono.d_alpha0 = 4.0;
+    std::shared_ptr<Gps_Iono> fourth = pool.acquire(std::move(iono));
+    EXPECT_EQ(first_slot, fourth.get());
+    EXPECT_EQ(4.0, fourth->d_alpha0);
+    EXPECT_EQ(2.0, second->d_alpha0);
+    EXPECT_EQ(1u, pool.misses());
+}
+
+
+TEST(MessagePoolTest, ChannelEvents)
+{
+    // the same payload is published every time
+    EXPECT_TRUE(pmt::eq(channel_event_pmt(CHANNEL_EVENT_LOSS_OF_LOCK), channel_event_pmt(CHANNEL_EVENT_LOSS_OF_LOCK)));
+    EXPECT_EQ(CHANNEL_EVENT_POSITIVE_ACQUISITION, pmt::to_long(channel_event_pmt(CHANNEL_EVENT_POSITIVE_ACQUISITION)));
+    EXPECT_EQ(CHANNEL_EVENT_NEGATIVE_ACQUISITION, pmt::to_long(channel_event_pmt(CHANNEL_EVENT_NEGATIVE_ACQUISITION)));
+    EXPECT_EQ(CHANNEL_EVENT_LOSS_OF_LOCK, pmt::to_long(channel_event_pmt(CHANNEL_EVENT_LOSS_OF_LOCK)));
+    EXPECT_EQ(CHANNEL_EVENT_STOP_TRACKING, pmt::to_long(channel_event_pmt(CHANNEL_EVENT_STOP_TRACKING)));
+}
@@ -0,0 +1,199 @@
+/*!
+ * \file multicorrelator_batch_test.cc
+ * \brief  This file implements tests for the batched multiTAP correlator
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <gtest/gtest.h>
+#include "cpu_multicorrelator.h"
+#include "cpu_multicorrelator_batch.h"
+#if CUDA_BLOCKS_TEST
+#include "cuda_multicorrelator.h"
+#endif
+
+namespace
+{
+const int batch_test_code_length = 1023;
+const int batch_test_signal_length = 12000;
+const int batch_test_jobs = 3;
+
+class MulticorrelatorBatchTest: public ::testing::Test
+{
+public:
+    void correlate_in_batcher(int j)
+    {
+        Correlator_Batcher::correlate(jobs[j], 1000000);
+    }
+
+protected:
+    MulticorrelatorBatchTest() : code(batch_test_code_length), signal(batch_test_signal_length)
+    {
+        unsigned int state = 1;
+        for (int i = 0; i < batch_test_code_length; i++)
+            {
+                state = state * 1103515245 + 12345;
+                code[i] = std::complex<float>((state >> 16) & 1 ? 1.0 : -1.0, 0.0);
+            }
+        for (int n = 0; n < batch_test_signal_length; n++)
+            {
+                int chip = static_cast<int>(std::floor(n * 0.2557)) % batch_test_code_length;
+                signal[n] = code[chip] * std::exp(std::complex<float>(0, 0.0123 * n)) + std::complex<float>(0.1 * std::sin(0.7 * n), 0);
+            }
+        shifts[0] = -0.5;
+        shifts[1] = 0.0;
+        shifts[2] = 0.5;
+        // code periods of different length and NCO commands, not aligned with each other
+        const unsigned long int stamps[batch_test_jobs] = {0, 1500, 7000};
+        const int lengths[batch_test_jobs] = {4000, 3999, 4001};
+        for (int j = 0; j < batch_test_jobs; j++)
+            {
+                Correlator_Job& job = jobs[j];
+                job.sig_in = &signal[stamps[j]];
+                job.sample_stamp = stamps[j] + 100000;
+                job.signal_length_samples = lengths[j];
+                job.rem_carrier_phase_in_rad = 0.3 * j;
+                job.phase_step_rad = 0.0123 + 0.0001 * j;
+                job.rem_code_phase_chips = 0.1 * j;
+                job.code_phase_step_chips = 0.2557;
+                job.local_code_in = &code[0];
+                job.code_length_chips = batch_test_code_length;
+                job.shifts_chips = shifts;
+                job.n_correlators = 3;
+                job.corr_out = batch_outs[j];
+                job.prn_group = 0;
+                job.group_phase_step_rad = 0.0;
+            }
+    }
+
+    void compute_reference()
+    {
+        cpu_multicorrelator correlator;
+        correlator.init(5000, 3);
+        for (int j = 0; j < batch_test_jobs; j++)
+            {
+                correlator.set_local_code_and_taps(batch_test_code_length, &code[0], shifts);
+                correlator.set_input_output_vectors(reference_outs[j], jobs[j].sig_in);
+                correlator.Carrier_wipeoff_multicorrelator_resampler(jobs[j].rem_carrier_phase_in_rad, jobs[j].phase_step_rad,
+                        jobs[j].rem_code_phase_chips, jobs[j].code_phase_step_chips, jobs[j].signal_length_samples);
+            }
+        correlator.free();
+    }
+
+    void check_outputs(double tolerance = 0.5)
+    {
+        for (int j = 0; j < batch_test_jobs; j++)
+            {
+                for (int n = 0; n < 3; n++)
+                    {
+                        EXPECT_NEAR(reference_outs[j][n].real(), batch_outs[j][n].real(), tolerance) << "job " << j << " tap " << n;
+                        EXPECT_NEAR(reference_outs[j][n].imag(), batch_outs[j][n].imag(), tolerance) << "job " << j << " tap " << n;
+                    }
+            }
+    }
+
+    std::vector<std::complex<float> > code;
+    std::vector<std::complex<float> > signal;
+    float shifts[3];
+    Correlator_Job jobs[batch_test_jobs];
+    std::complex<float> reference_outs[batch_test_jobs][3];
+    std::complex<float> batch_outs[batch_test_jobs][3];
+};
+}
+
+
+TEST_F(MulticorrelatorBatchTest, MatchesCpuMulticorrelator)
+{
+    compute_reference();
+    // the prompt of the first channel is aligned with the signal
+    EXPECT_GT(std::abs(reference_outs[0][1]), 3000.0);
+
+    cpu_multicorrelator_batch correlator;
+    ASSERT_TRUE(correlator.init(3));
+    ASSERT_TRUE(correlator.Carrier_wipeoff_multicorrelator_resampler(jobs, batch_test_jobs));
+    check_outputs();
+    correlator.free();
+}
+
+
+TEST_F(MulticorrelatorBatchTest, BatcherCorrelatesAllChannels)
+{
+    compute_reference();
+    Correlator_Batcher::add_channels(batch_test_jobs);
+    boost::thread_group channels;
+    for (int j = 0; j < batch_test_jobs; j++)
+        {
+            channels.create_thread(boost::bind(&MulticorrelatorBatchTest::correlate_in_batcher, this, j));
+        }
+    channels.join_all();
+    Correlator_Batcher::add_channels(-batch_test_jobs);
+    check_outputs();
+}
+
+
+TEST_F(MulticorrelatorBatchTest, SharesTheWipeoffOfAPrnGroup)
+{
+    compute_reference();
+    // the first two channels track the same PRN, at close carrier Doppler
+    for (int j = 0; j < 2; j++)
+        {
+            jobs[j].prn_group = 5;
+            jobs[j].group_phase_step_rad = 0.0005;
+        }
+    EXPECT_EQ(6, cpu_multicorrelator_batch::tap_set_size(jobs, batch_test_jobs));
+
+    cpu_multicorrelator_batch correlator;
+    ASSERT_TRUE(correlator.init(6));
+    ASSERT_TRUE(correlator.Carrier_wipeoff_multicorrelator_resampler(jobs, batch_test_jobs));
+    // the residual carrier of the second channel within each tile costs a little of correlation
+    check_outputs(0.002 * std::abs(reference_outs[0][1]));
+    correlator.free();
+
+    // too far in Doppler to share it
+    jobs[1].group_phase_step_rad = 0.00005;
+    EXPECT_EQ(3, cpu_multicorrelator_batch::tap_set_size(jobs, batch_test_jobs));
+}
+
+
+#if CUDA_BLOCKS_TEST
+TEST_F(MulticorrelatorBatchTest, CudaBatchMatchesCpuMulticorrelator)
+{
+    compute_reference();
+
+    cuda_multicorrelator_batch correlator;
+    ASSERT_TRUE(correlator.init_cuda());
+    ASSERT_TRUE(correlator.Carrier_wipeoff_multicorrelator_resampler_cuda(jobs, batch_test_jobs));
+    // the GPU accumulates in another order, and a sample may fall on the other side of a chip edge
+    check_outputs(0.002 * std::abs(reference_outs[0][1]));
+    correlator.free_cuda();
+}
+#endif
@@ -0,0 +1,110 @@
+/*!
+ * \file nav_data_fields_test.cc
+ * \brief  This file implements tests for the field tables used to compare
+ * GPS navigation data
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include "in_memory_configuration.h"
+#include "nav_data_fields.h"
+
+
+TEST(NavDataFieldsTest, TablesFitTheMask)
+{
+    EXPECT_LE(gps_ephemeris_fields().size(), 64u);
+    EXPECT_LE(gps_almanac_fields().size(), 64u);
+    EXPECT_LE(gps_iono_fields().size(), 64u);
+    EXPECT_LE(gps_utc_fields().size(), 64u);
+}
+
+
+TEST(NavDataFieldsTest, EphemerisDifferences)
+{
+    const std::vector<Nav_Field<Gps_Ephemeris> >& fields = gps_ephemeris_fields();
+    Gps_Ephemeris a;
+    a.i_peak = 0;
+    Gps_Ephemeris b = a;
+    EXPECT_EQ(0u, nav_fields_differ(fields, a, b));
+
+    b.d_TOW = a.d_TOW + 6.0;
+    b.i_GPS_week = a.i_GPS_week + 1;
+    b.b_alert_flag = !a.b_alert_flag;
+    Nav_Field_Mask TOW = nav_field_bit(fields, "d_TOW");
+    Nav_Field_Mask week = nav_field_bit(fields, "i_GPS_week");
+    Nav_Field_Mask alert = nav_field_bit(fields, "b_alert_flag");
+    ASSERT_NE(0u, TOW);
+    EXPECT_EQ(TOW | week | alert, nav_fields_differ(fields, a, b));
+    EXPECT_EQ(week | alert, nav_fields_differ(fields, a, b, ~TOW));
+    EXPECT_EQ(0u, nav_field_bit(fields, "d_IODE_SF2"));
+
+    std::string report = nav_fields_report(fields, week, a, b);
+    EXPECT_EQ(0u, report.find("i_GPS_week not the same: "));
+    EXPECT_EQ(std::string::npos, report.find("d_TOW"));
+}
+
+
+TEST(NavDataFieldsTest, EphemerisThresholds)
+{
+    const std::vector<Nav_Field<Gps_Ephemeris> >& fields = gps_ephemeris_fields();
+    std::shared_ptr<InMemoryConfiguration> config = std::make_shared<InMemoryConfiguration>();
+    config->set_property("Spoofing.Crs", "10.0");
+    std::vector<double> thresholds = nav_field_thresholds(fields, config.get());
+    Nav_Field_Mask Crs = nav_field_bit(fields, "d_Crs");
+    Nav_Field_Mask M_0 = nav_field_bit(fields, "d_M_0");
+    Nav_Field_Mask TOW = nav_field_bit(fields, "d_TOW");
+
+    Gps_Ephemeris a;
+    a.i_peak = 0;
+    Gps_Ephemeris b = a;
+    b.d_Crs = a.d_Crs - 10.5;  // above the configured threshold
+    b.d_M_0 = a.d_M_0 + 5.0;   // below the default one, 5.9478
+    b.d_TOW = a.d_TOW + 1e6;   // not checked
+    EXPECT_EQ(Crs, nav_fields_exceed(fields, thresholds, a, b));
+
+    b.d_M_0 = a.d_M_0 + 6.0;
+    EXPECT_EQ(Crs | M_0, nav_fields_exceed(fields, thresholds, a, b));
+    EXPECT_EQ(0u, nav_fields_exceed(fields, thresholds, a, a));
+    EXPECT_NE(0u, nav_fields_differ(fields, a, b) & TOW);
+}
+
+
+TEST(NavDataFieldsTest, IonoAndUtcDifferences)
+{
+    Gps_Iono iono_a;
+    Gps_Iono iono_b = iono_a;
+    iono_b.d_beta3 = iono_a.d_beta3 + 1.0;
+    EXPECT_EQ(nav_field_bit(gps_iono_fields(), "d_beta3"), nav_fields_differ(gps_iono_fields(), iono_a, iono_b));
+
+    Gps_Utc_Model utc_a;
+    Gps_Utc_Model utc_b = utc_a;
+    utc_b.i_DN = utc_a.i_DN + 1;
+    EXPECT_EQ(nav_field_bit(gps_utc_fields(), "i_DN"), nav_fields_differ(gps_utc_fields(), utc_a, utc_b));
+}
@@ -0,0 +1,76 @@
+/*!
+ * \file navigation_data_bus_test.cc
+ * \brief  This file implements tests for the navigation data bus
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include "navigation_data_bus.h"
+
+
+TEST(NavigationDataBusTest, PublishesOnlyNewIssues)
+{
+    navigation_data_bus bus;
+    Gps_Ephemeris eph;
+    eph.i_satellite_PRN = 7;
+    eph.d_IODC = 12;
+    eph.d_IODE_SF2 = 12;
+    eph.d_IODE_SF3 = 12;
+    eph.d_Toe = 7200;
+    eph.i_GPS_week = 1850;
+
+    Gps_Ephemeris_Record record;
+    ASSERT_TRUE(bus.publish_ephemeris(3, eph, 1000.0, record));
+    EXPECT_EQ(1u, record.version);
+    std::shared_ptr<const Gps_Ephemeris> first = record.ephemeris;
+
+    // the same issue, decoded again 30 s later
+    eph.d_TOW = 30;
+    EXPECT_FALSE(bus.publish_ephemeris(3, eph, 31000.0, record));
+    EXPECT_EQ(first, record.ephemeris);
+    EXPECT_EQ(1000.0, record.timestamp);
+
+    // a snapshot is not affected by later publications
+    navigation_data_bus::Ephemeris_Snapshot snapshot = bus.get_ephemeris_snapshot();
+    eph.d_IODE_SF2 = 13;
+    eph.d_IODE_SF3 = 13;
+    eph.d_IODC = 13;
+    ASSERT_TRUE(bus.publish_ephemeris(3, eph, 7201000.0, record));
+    EXPECT_EQ(2u, record.version);
+    EXPECT_EQ(12, snapshot->at(3).ephemeris->d_IODC);
+    EXPECT_EQ(13, bus.get_ephemeris_snapshot()->at(3).ephemeris->d_IODC);
+
+    // other keys are independent
+    EXPECT_TRUE(bus.publish_ephemeris(4, eph, 7201000.0, record));
+    EXPECT_EQ(1u, record.version);
+
+    bus.remove(3);
+    EXPECT_FALSE(bus.read_ephemeris(3, record));
+    EXPECT_TRUE(bus.publish_ephemeris(3, eph, 7300000.0, record));
+    EXPECT_EQ(1u, record.version);
+}
@@ -0,0 +1,108 @@
+/*!
+ * \file navigation_message_bits_test.cc
+ * \brief  This file implements tests for the navigation message field extraction
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <bitset>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include "navigation_message_bits.h"
+#include "GPS_L1_CA.h"
+#include "Galileo_E5a.h"
+
+
+namespace
+{
+// bit by bit reading, as the navigation message classes used to do it
+template<std::size_t N>
+long long reference_read(const std::bitset<N>& bits, const std::vector<std::pair<int,int>>& parameter, bool is_signed)
+{
+    long long value = (is_signed && bits[N - parameter[0].first]) ? -1 : 0;
+    for (std::size_t i = 0; i < parameter.size(); i++)
+        {
+            for (int j = 0; j < parameter[i].second; j++)
+                {
+                    value = (value << 1) | static_cast<long long>(bits[N - parameter[i].first - j]);
+                }
+        }
+    return value;
+}
+}
+
+
+TEST(NavigationMessageBitsTest, MatchesBitByBitReading)
+{
+    std::mt19937 generator(1234);
+    std::bernoulli_distribution coin(0.5);
+    const std::vector<std::vector<std::pair<int,int>>> gps_fields = {{{1, 8}}, TOW, SUBFRAME_ID, ALERT_FLAG,
+            GPS_WEEK, T_GD, IODC, A_F0, A_F2, M_0, E, SQRT_A, OMEGA_0, I_0, OMEGA, OMEGA_DOT, {{1, 64}}, {{237, 64}}};
+    const std::vector<std::vector<std::pair<int,int>>> fnav_fields = {FNAV_PAGE_TYPE_bit, FNAV_Omega0_1_5_bit, {{150, 64}}};
+    for (int trial = 0; trial < 200; trial++)
+        {
+            std::string text;
+            std::bitset<GPS_SUBFRAME_BITS> gps_bits;
+            std::bitset<GALILEO_FNAV_DATA_FRAME_BITS> fnav_bits;
+            for (int n = 0; n < GPS_SUBFRAME_BITS; n++)
+                {
+                    gps_bits[n] = coin(generator);
+                }
+            for (int n = 0; n < GALILEO_FNAV_DATA_FRAME_BITS; n++)
+                {
+                    text += coin(generator) ? '1' : '0';
+                }
+            fnav_bits = std::bitset<GALILEO_FNAV_DATA_FRAME_BITS>(text);
+
+            const Navigation_Message_Bits<GPS_SUBFRAME_BITS> gps(gps_bits);
+            for (const auto& field : gps_fields)
+                {
+                    ASSERT_EQ(reference_read(gps_bits, field, true), static_cast<long long>(gps.read_signed(field)));
+                    ASSERT_EQ(reference_read(gps_bits, field, false), static_cast<long long>(gps.read_unsigned(field)));
+                    ASSERT_EQ(gps_bits[GPS_SUBFRAME_BITS - field[0].first] == 1, gps.read_bool(field));
+                }
+            const Navigation_Message_Bits<GALILEO_FNAV_DATA_FRAME_BITS> fnav(text);
+            for (const auto& field : fnav_fields)
+                {
+                    ASSERT_EQ(reference_read(fnav_bits, field, true), static_cast<long long>(fnav.read_signed(field)));
+                    ASSERT_EQ(reference_read(fnav_bits, field, false), static_cast<long long>(fnav.read_unsigned(field)));
+                }
+        }
+}
+
+
+TEST(NavigationMessageBitsTest, ShortStringFillsTheLastBits)
+{
+    const Navigation_Message_Bits<GALILEO_FNAV_DATA_FRAME_BITS> bits(std::string("1000000000000011"));
+    const std::vector<std::pair<int,int>> last_bits({{GALILEO_FNAV_DATA_FRAME_BITS - 15, 16}});
+    EXPECT_EQ(0x8003u, bits.read_unsigned(last_bits));
+    EXPECT_EQ(-32765, bits.read_signed(last_bits));
+    EXPECT_EQ(0u, bits.read_unsigned({{1, 64}}));
+}
@@ -0,0 +1,98 @@
+/*!
+ * \file observables_extrapolation_test.cc
+ * \brief  This file implements tests for the low latency observables
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <cstring>
+#include <vector>
+#include <gtest/gtest.h>
+#include "GPS_L1_CA.h"
+#include "observables_extrapolation.h"
+
+
+static Gnss_Synchro extrapolation_channel(double tow_s, double prn_timestamp_ms, double doppler_hz)
+{
+    Gnss_Synchro synchro;
+    std::memset(&synchro, 0, sizeof(synchro));
+    synchro.d_TOW_at_current_symbol = tow_s;
+    synchro.Prn_timestamp_ms = prn_timestamp_ms;
+    synchro.Carrier_Doppler_hz = doppler_hz;
+    synchro.Flag_valid_word = true;
+    return synchro;
+}
+
+
+TEST(ObservablesExtrapolationTest, MatchesTheAlignedPseudoranges)
+{
+    // without Doppler, the pseudoranges are those of the common reception time algorithm
+    Gnss_Synchro synchro[3];
+    synchro[0] = extrapolation_channel(100.0, 1000.0, 0.0);
+    synchro[1] = extrapolation_channel(99.930, 1000.4, 0.0);
+    synchro[2] = extrapolation_channel(99.925, 999.8, 0.0); // not valid
+    std::vector<unsigned int> channels;
+    channels.push_back(0);
+    channels.push_back(1);
+    extrapolate_observables(synchro, channels, &Gnss_Synchro::d_TOW_at_current_symbol, GPS_STARTOFFSET_ms);
+
+    double traveltime_ms = (100.0 - 99.930) * 1000.0 + (1000.4 - 1000.0) + GPS_STARTOFFSET_ms;
+    EXPECT_NEAR(traveltime_ms * GPS_C_m_ms, synchro[1].Pseudorange_m, 1e-3);
+    EXPECT_NEAR(GPS_STARTOFFSET_ms * GPS_C_m_ms, synchro[0].Pseudorange_m, 1e-3);
+    EXPECT_TRUE(synchro[0].Flag_valid_pseudorange);
+    EXPECT_TRUE(synchro[1].Flag_valid_pseudorange);
+    EXPECT_FALSE(synchro[2].Flag_valid_pseudorange);
+
+    // both refer to the newest PRN start, 0.4 ms after the one of channel 0
+    EXPECT_DOUBLE_EQ(1000.4, synchro[0].Prn_timestamp_ms);
+    EXPECT_NEAR(100.0004 + GPS_STARTOFFSET_ms / 1000.0, synchro[0].d_TOW_at_current_symbol, 1e-9);
+    EXPECT_DOUBLE_EQ(synchro[0].d_TOW_at_current_symbol, synchro[1].d_TOW_at_current_symbol);
+}
+
+
+TEST(ObservablesExtrapolationTest, CodeAndCarrierRates)
+{
+    const double doppler_hz = 4000.0;
+    const double delta_s = 0.0007;
+    Gnss_Synchro synchro[2];
+    synchro[0] = extrapolation_channel(200.0, 5000.0, doppler_hz);
+    synchro[0].Carrier_phase_rads = 10.0;
+    synchro[1] = extrapolation_channel(199.9300001, 5000.0 + delta_s * 1000.0, 0.0);
+    std::vector<unsigned int> channels;
+    channels.push_back(0);
+    channels.push_back(1);
+    extrapolate_observables(synchro, channels, &Gnss_Synchro::d_TOW_at_current_symbol, 0.0);
+
+    EXPECT_NEAR(10.0 - GPS_TWO_PI * doppler_hz * delta_s, synchro[0].Carrier_phase_rads, 1e-9);
+    EXPECT_DOUBLE_EQ(doppler_hz, synchro[0].Carrier_Doppler_hz);
+    // the code of channel 0 runs faster than nominal by doppler / L1
+    double tow_0 = 200.0 + delta_s * (1.0 + doppler_hz / GPS_L1_FREQ_HZ);
+    EXPECT_NEAR((tow_0 - 199.9300001) * GPS_C_m_s, synchro[1].Pseudorange_m, 1e-4);
+    EXPECT_NEAR(0.0, synchro[0].Pseudorange_m, 1e-9);
+}
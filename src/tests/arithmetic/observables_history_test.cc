@@ -0,0 +1,124 @@
+/*!
+ * \file observables_history_test.cc
+ * \brief  This file implements tests for the ring buffer observables history
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cmath>
+#include <vector>
+#include <gtest/gtest.h>
+#include "observables_history.h"
+
+
+// straight least squares line through (t, y), evaluated at t_eval
+static double reference_fit(const std::vector<double>& t, const std::vector<double>& y, double t_eval)
+{
+    double n = t.size();
+    double mean_t = 0.0;
+    double mean_y = 0.0;
+    for (unsigned int i = 0; i < t.size(); i++)
+        {
+            mean_t += t[i] / n;
+            mean_y += y[i] / n;
+        }
+    double s_ty = 0.0;
+    double s_tt = 0.0;
+    for (unsigned int i = 0; i < t.size(); i++)
+        {
+            s_ty += (t[i] - mean_t) * (y[i] - mean_y);
+            s_tt += (t[i] - mean_t) * (t[i] - mean_t);
+        }
+    double slope = s_ty / s_tt;
+    return mean_y + slope * (t_eval - mean_t);
+}
+
+
+TEST(ObservablesHistoryTest, KeepsTheLastDepthSamples)
+{
+    Observables_History history(2, 4);
+    EXPECT_EQ(0u, history.size(0));
+    for (unsigned int n = 0; n < 6; n++)
+        {
+            history.push_back(1, 100.0 + n, 0.0, 0.0);
+        }
+    EXPECT_EQ(0u, history.size(0));
+    EXPECT_EQ(4u, history.size(1));
+    EXPECT_TRUE(history.full(1));
+    EXPECT_EQ(105.0, history.newest_tow_s(1));
+    history.clear(1);
+    EXPECT_EQ(0u, history.size(1));
+    EXPECT_FALSE(history.full(1));
+}
+
+
+TEST(ObservablesHistoryTest, LinearFitMatchesLeastSquares)
+{
+    const unsigned int depth = 100;
+    Observables_History history(3, depth);
+    std::vector<double> tow;
+    std::vector<double> phase;
+    std::vector<double> doppler;
+    // feed more than one ring, so the window wraps around
+    for (unsigned int n = 0; n < 3 * depth / 2; n++)
+        {
+            double t = 518400.0 + 0.001 * n;
+            double p = 2.0e5 + 6283.0 * 0.001 * n + 0.3 * std::sin(0.7 * n);
+            double d = 1000.0 + 2.5 * 0.001 * n + 0.1 * std::cos(1.3 * n);
+            history.push_back(2, t, p, d);
+            tow.push_back(t);
+            phase.push_back(p);
+            doppler.push_back(d);
+        }
+    ASSERT_TRUE(history.full(2));
+
+    std::vector<double> t_window(tow.end() - depth, tow.end());
+    std::vector<double> p_window(phase.end() - depth, phase.end());
+    std::vector<double> d_window(doppler.end() - depth, doppler.end());
+    double delta_s = -0.0004;
+    double fit_phase;
+    double fit_doppler;
+    history.linear_fit(2, delta_s, fit_phase, fit_doppler);
+    EXPECT_NEAR(reference_fit(t_window, p_window, tow.back() + delta_s), fit_phase, 1e-6);
+    EXPECT_NEAR(reference_fit(t_window, d_window, tow.back() + delta_s), fit_doppler, 1e-8);
+}
+
+
+TEST(ObservablesHistoryTest, LinearFitIsExactOnALine)
+{
+    Observables_History history(1, 10);
+    for (unsigned int n = 0; n < 7; n++)
+        {
+            history.push_back(0, 10.0 + 0.02 * n, 3.0 - 5.0 * 0.02 * n, 4.0 + 0.02 * n);
+        }
+    double fit_phase;
+    double fit_doppler;
+    history.linear_fit(0, 0.01, fit_phase, fit_doppler);
+    EXPECT_NEAR(3.0 - 5.0 * 0.13, fit_phase, 1e-9);
+    EXPECT_NEAR(4.0 + 0.13, fit_doppler, 1e-9);
+}
@@ -0,0 +1,101 @@
+/*!
+ * \file preamble_correlator_test.cc
+ * \brief  This file implements tests for the sliding preamble correlation
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cstdlib>
+#include <vector>
+#include <gtest/gtest.h>
+#include "gnss_synchro.h"
+#include "preamble_correlator.h"
+
+namespace
+{
+// the loop of the GPS L1 C/A telemetry decoders
+int preamble_correlator_test_reference(const Gnss_Synchro* in, const std::vector<int>& preamble)
+{
+    int corr_value = 0;
+    for (unsigned int i = 0; i < preamble.size(); i++)
+        {
+            if (in[i].Flag_valid_symbol_output == true)
+                {
+                    corr_value += (in[i].Prompt_I < 0 ? -1 : 1) * preamble[i] * in[i].correlation_length_ms;
+                }
+            if (corr_value >= static_cast<int>(preamble.size())) break;
+        }
+    return corr_value;
+}
+}
+
+
+TEST(PreambleCorrelatorTest, MatchesTheSymbolLoop)
+{
+    std::srand(1);
+    const unsigned int length = 160; // GPS_CA_PREAMBLE_LENGTH_SYMBOLS
+    std::vector<int> preamble(length);
+    for (unsigned int i = 0; i < length; i++)
+        {
+            preamble[i] = (std::rand() & 1) ? 1 : -1;
+        }
+
+    // random symbols with the preamble, its inverse, some invalid and some 20 ms symbols
+    const unsigned int n_symbols = 6000;
+    std::vector<Gnss_Synchro> symbols(n_symbols);
+    for (unsigned int n = 0; n < n_symbols; n++)
+        {
+            symbols[n].Prompt_I = (std::rand() & 1) ? 1.0 : -1.0;
+            symbols[n].Flag_valid_symbol_output = n < 5000 or n % 7 != 0;
+            symbols[n].correlation_length_ms = (n > 5500 and n % 11 == 0) ? 20 : 1;
+            symbols[n].Tracking_timestamp_secs = 0.001 * n;
+        }
+    for (unsigned int i = 0; i < length; i++)
+        {
+            symbols[1000 + i].Prompt_I = preamble[i];
+            symbols[3000 + i].Prompt_I = -preamble[i];
+        }
+
+    Preamble_Correlator correlator(&preamble[0], length);
+    int matches = 0;
+    for (unsigned int n = 0; n + length <= n_symbols; n++)
+        {
+            if (n == 2000)
+                {
+                    n += 17; // the window jumps, the history is read again
+                }
+            int corr_value = correlator.correlate(&symbols[n]);
+            ASSERT_EQ(preamble_correlator_test_reference(&symbols[n], preamble), corr_value) << "at symbol " << n;
+            if (n < 5000 and std::abs(corr_value) == static_cast<int>(length))
+                {
+                    // the 20 ms symbols can also add up to length
+                    matches++;
+                }
+        }
+    EXPECT_EQ(2, matches);
+}
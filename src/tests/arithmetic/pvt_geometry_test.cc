@@ -0,0 +1,173 @@
+/*!
+ * \file pvt_geometry_test.cc
+ * \brief  This file implements tests for the coordinate conversions and
+ * atmospheric delays of the PVT
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cmath>
+#include <vector>
+#include <armadillo>
+#include <gtest/gtest.h>
+#include "GPS_L1_CA.h"
+#include "gps_iono.h"
+#include "pvt_geometry.h"
+#include "pvt_solution.h"
+
+
+TEST(PvtGeometryTest, GeodeticRoundTripMatchesTogeod)
+{
+    std::vector<double> lat, lon, h;
+    for (double b = -89.5; b < 90.0; b += 11.0)
+        {
+            for (double l = -175.0; l < 180.0; l += 25.0)
+                {
+                    const double heights[] = {-120.0, 0.0, 2500.0, 20200e3};
+                    for (int k = 0; k < 4; k++)
+                        {
+                            lat.push_back(b);
+                            lon.push_back(l);
+                            h.push_back(heights[k]);
+                        }
+                }
+        }
+    const unsigned int n = lat.size();
+    std::vector<double> x(n), y(n), z(n), lat2(n), lon2(n), h2(n);
+    geodetic_to_ecef(lat.data(), lon.data(), h.data(), x.data(), y.data(), z.data(), n);
+    ecef_to_geodetic(x.data(), y.data(), z.data(), lat2.data(), lon2.data(), h2.data(), n);
+
+    Pvt_Solution solution;
+    for (unsigned int i = 0; i < n; i++)
+        {
+            EXPECT_NEAR(lat.at(i), lat2.at(i), 1e-9);
+            EXPECT_NEAR(lon.at(i), lon2.at(i), 1e-9);
+            EXPECT_NEAR(h.at(i), h2.at(i), 1e-3);
+            double dphi, dlambda, height;
+            solution.togeod(&dphi, &dlambda, &height, 6378137.0, 298.257223563, x.at(i), y.at(i), z.at(i));
+            EXPECT_NEAR(dphi, lat2.at(i), 1e-8);
+            EXPECT_NEAR(std::remainder(dlambda - lon2.at(i), 360.0), 0.0, 1e-8);
+            EXPECT_NEAR(height, h2.at(i), 1e-3);
+        }
+}
+
+
+TEST(PvtGeometryTest, AzimuthElevationOfTheLocalAxes)
+{
+    const double lat = 64.1, lon = -21.9, height = 40.0;
+    double x, y, z;
+    geodetic_to_ecef(&lat, &lon, &height, &x, &y, &z, 1);
+    const Local_Frame frame(x, y, z);
+    EXPECT_NEAR(lat, frame.latitude_d, 1e-9);
+    EXPECT_NEAR(lon, frame.longitude_d, 1e-9);
+    EXPECT_NEAR(height, frame.height_m, 1e-3);
+
+    // a point 1 km north, east, up and south-west of the receiver
+    const double targets[4][3] = {{lat + 0.01, lon, height}, {lat, lon + 0.02, height}, {lat, lon, height + 1000.0}, {lat - 0.01, lon - 0.02, height}};
+    double dx[4], dy[4], dz[4];
+    for (int i = 0; i < 4; i++)
+        {
+            geodetic_to_ecef(&targets[i][0], &targets[i][1], &targets[i][2], &dx[i], &dy[i], &dz[i], 1);
+            dx[i] -= x;
+            dy[i] -= y;
+            dz[i] -= z;
+        }
+    double az[4], el[4], range[4];
+    frame.azimuth_elevation(dx, dy, dz, az, el, range, 4);
+    EXPECT_NEAR(0.0, std::remainder(az[0], 360.0), 1e-3);
+    EXPECT_NEAR(0.0, el[0], 0.1);
+    EXPECT_NEAR(90.0, az[1], 0.1);
+    EXPECT_NEAR(90.0, el[2], 1e-6);
+    EXPECT_NEAR(1000.0, range[2], 1e-6);
+    EXPECT_GT(az[3], 180.0);
+    EXPECT_LT(az[3], 270.0);
+}
+
+
+TEST(PvtGeometryTest, TropoModelReproducesHopfield)
+{
+    // values of the former Pvt_Solution::tropo()
+    EXPECT_NEAR(2.4209238107328166, Tropo_Model(0.0).delay_m(1.0), 1e-9);
+    EXPECT_NEAR(12.639757697421008, Tropo_Model(0.5).delay_m(std::sin(10.0 * GPS_PI / 180.0)), 1e-8);
+    EXPECT_NEAR(19.34032272184826, Tropo_Model(1.2, 900.0, 280.0, 70.0, 0.3, 0.2, 0.1).delay_m(std::sin(5.0 * GPS_PI / 180.0)), 1e-8);
+
+    const Tropo_Model model(0.3);
+    std::vector<double> sin_el, delays(90);
+    for (int e = 0; e < 90; e++)
+        {
+            sin_el.push_back(std::sin(e * GPS_PI / 180.0));
+        }
+    model.delays_m(sin_el.data(), delays.data(), 90);
+    Pvt_Solution solution;
+    for (int e = 0; e < 90; e++)
+        {
+            double trop;
+            solution.tropo(&trop, sin_el.at(e), 0.3, 1013.0, 293.0, 50.0, 0.0, 0.0, 0.0);
+            EXPECT_EQ(trop, delays.at(e));
+            if (e > 0)
+                {
+                    EXPECT_LT(delays.at(e), delays.at(e - 1));
+                }
+        }
+}
+
+
+TEST(PvtGeometryTest, KlobucharDayAndNight)
+{
+    Gps_Iono iono;
+    iono.d_alpha0 = 1e-8;
+    iono.d_alpha1 = 0.0;
+    iono.d_alpha2 = 0.0;
+    iono.d_alpha3 = 0.0;
+    iono.d_beta0 = 86400.0;
+    iono.d_beta1 = 0.0;
+    iono.d_beta2 = 0.0;
+    iono.d_beta3 = 0.0;
+    const double obliquity = 1.0 + 16.0 * std::pow(0.53 - 0.5, 3);
+    double az = 0.0, el = 90.0, delay;
+
+    // 14:00 local time at longitude 0, the peak of the day
+    klobuchar_delays_m(iono, 10.0, 0.0, &az, &el, 50400.0, &delay, 1);
+    EXPECT_NEAR(obliquity * (5e-9 + 1e-8) * GPS_C_m_s, delay, 1e-6);
+
+    // night: the 5 ns floor
+    klobuchar_delays_m(iono, 10.0, 0.0, &az, &el, 7200.0, &delay, 1);
+    EXPECT_NEAR(obliquity * 5e-9 * GPS_C_m_s, delay, 1e-6);
+
+    // the local time follows the longitude: 14:00 at 90 deg east is 08:00 UTC
+    klobuchar_delays_m(iono, 10.0, 90.0, &az, &el, 28800.0, &delay, 1);
+    EXPECT_NEAR(obliquity * (5e-9 + 1e-8) * GPS_C_m_s, delay, 1e-6);
+
+    // lower satellites cross more ionosphere
+    const double azimuths[3] = {0.0, 120.0, 240.0};
+    const double elevations[3] = {60.0, 30.0, 10.0};
+    double delays[3];
+    klobuchar_delays_m(iono, 10.0, 0.0, azimuths, elevations, 50400.0, delays, 3);
+    EXPECT_LT(delay, delays[0]);
+    EXPECT_LT(delays[0], delays[1]);
+    EXPECT_LT(delays[1], delays[2]);
+}
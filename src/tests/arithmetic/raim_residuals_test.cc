@@ -0,0 +1,184 @@
+/*!
+ * \file raim_residuals_test.cc
+ * \brief  This file implements tests for the leave-one-out solutions of the
+ * least squares fix and their residual check in the spoofing detector
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <armadillo>
+#include <gtest/gtest.h>
+#include "concurrent_ring_queue.h"
+#include "receiver_state.h"
+#include "GPS_L1_CA.h"
+#include "in_memory_configuration.h"
+#include "ls_pvt.h"
+#include "pvt_geometry.h"
+#include "spoofing_detector.h"
+#include "spoofing_message.h"
+
+namespace
+{
+const unsigned int raim_test_satellites = 8;
+
+// Receiver on the equator, satellites 20000 km away in all directions of the sky
+arma::vec raim_test_rx_pos()
+{
+    return arma::vec({6378137.0, 0.0, 0.0});
+}
+
+arma::mat raim_test_satpos()
+{
+    const double elevation_d[raim_test_satellites] = {80.0, 50.0, 35.0, 25.0, 60.0, 20.0, 40.0, 30.0};
+    const double azimuth_d[raim_test_satellites] = {0.0, 45.0, 100.0, 170.0, 220.0, 270.0, 315.0, 135.0};
+    arma::vec rx_pos = raim_test_rx_pos();
+    arma::mat satpos(3, raim_test_satellites);
+    for (unsigned int i = 0; i < raim_test_satellites; i++)
+        {
+            double el = elevation_d[i] * GPS_PI / 180.0;
+            double az = azimuth_d[i] * GPS_PI / 180.0;
+            // up is +X, east +Y and north +Z here
+            satpos(0, i) = rx_pos(0) + 20e6 * std::sin(el);
+            satpos(1, i) = rx_pos(1) + 20e6 * std::cos(el) * std::sin(az);
+            satpos(2, i) = rx_pos(2) + 20e6 * std::cos(el) * std::cos(az);
+        }
+    return satpos;
+}
+
+// Pseudoranges at rx_pos with clock_m, as Ls_Pvt::leastSquarePos() models them
+arma::vec raim_test_pseudoranges(const arma::mat& satpos, const arma::vec& rx_pos, double clock_m)
+{
+    const unsigned int n = satpos.n_cols;
+    std::vector<double> dx(n), dy(n), dz(n), az(n), el(n), range(n), sin_el(n), trop(n);
+    for (unsigned int i = 0; i < n; i++)
+        {
+            double traveltime = arma::norm(satpos.col(i) - rx_pos, 2) / GPS_C_m_s;
+            double c = std::cos(OMEGA_EARTH_DOT * traveltime);
+            double s = std::sin(OMEGA_EARTH_DOT * traveltime);
+            dx[i] = c * satpos(0, i) + s * satpos(1, i) - rx_pos(0);
+            dy[i] = -s * satpos(0, i) + c * satpos(1, i) - rx_pos(1);
+            dz[i] = satpos(2, i) - rx_pos(2);
+        }
+    Local_Frame frame(rx_pos(0), rx_pos(1), rx_pos(2));
+    frame.azimuth_elevation(&dx[0], &dy[0], &dz[0], &az[0], &el[0], &range[0], n);
+    for (unsigned int i = 0; i < n; i++)
+        {
+            sin_el[i] = std::sin(el[i] * GPS_PI / 180.0);
+        }
+    Tropo_Model(frame.height_m / 1000.0).delays_m(&sin_el[0], &trop[0], n);
+    arma::vec obs(n);
+    for (unsigned int i = 0; i < n; i++)
+        {
+            obs(i) = std::sqrt(dx[i] * dx[i] + dy[i] * dy[i] + dz[i] * dz[i]) + clock_m + trop[i];
+        }
+    return obs;
+}
+
+// less than a meter of noise on each pseudorange
+arma::vec raim_test_noise()
+{
+    return arma::vec({0.8, -0.5, 0.3, -0.9, 0.6, -0.2, 0.4, -0.7});
+}
+}
+
+
+TEST(RaimResidualsTest, LeaveOneOutMatchesTheSubsetFixes)
+{
+    arma::mat satpos = raim_test_satpos();
+    arma::vec obs = raim_test_pseudoranges(satpos, raim_test_rx_pos(), 150.0) + raim_test_noise();
+    const unsigned int n = satpos.n_cols;
+
+    Ls_Pvt pvt;
+    pvt.leastSquarePos(satpos, obs, arma::eye(n, n));
+    ASSERT_EQ(n, pvt.d_raim_subset_ssr.n_elem);
+    ASSERT_EQ(n, pvt.d_raim_subset_pos.n_cols);
+    EXPECT_GT(pvt.d_raim_ssr, 0.0);
+
+    for (unsigned int i = 0; i < n; i++)
+        {
+            // the fix without observation i, solved again from scratch
+            arma::mat subset_satpos = satpos;
+            subset_satpos.shed_col(i);
+            arma::vec subset_obs = obs;
+            subset_obs.shed_row(i);
+            Ls_Pvt subset_pvt;
+            arma::vec subset_pos = subset_pvt.leastSquarePos(subset_satpos, subset_obs, arma::eye(n - 1, n - 1));
+            ASSERT_EQ(n - 1, subset_pvt.d_raim_subset_ssr.n_elem) << "without observation " << i;
+
+            EXPECT_NEAR(subset_pvt.d_raim_ssr, pvt.d_raim_subset_ssr(i), 1e-3 * subset_pvt.d_raim_ssr + 1e-6) << "without observation " << i;
+            for (unsigned int r = 0; r < 4; r++)
+                {
+                    EXPECT_NEAR(subset_pos(r), pvt.d_raim_subset_pos(r, i), 1e-2) << "without observation " << i << ", coordinate " << r;
+                }
+        }
+}
+
+
+TEST(RaimResidualsTest, DetectorAlarmExcludesTheBiasedPseudorange)
+{
+    Spoofing_Message msg;
+    std::shared_ptr<Receiver_State> state = std::make_shared<Receiver_State>();
+    Receiver_State_Scope state_scope(state);
+
+    std::shared_ptr<InMemoryConfiguration> config = std::make_shared<InMemoryConfiguration>();
+    config->set_property("Spoofing.RAIM", "true");
+    config->set_property("Spoofing.RAIM_sigma_m", "3");
+    config->set_property("Spoofing.RAIM_pfa", "1e-5");
+    Spoofing_Detector detector(config.get());
+
+    std::vector<unsigned int> prn = {3, 7, 12, 15, 19, 22, 26, 31};
+    arma::mat satpos = raim_test_satpos();
+    arma::vec obs = raim_test_pseudoranges(satpos, raim_test_rx_pos(), 150.0) + raim_test_noise();
+    const int n = satpos.n_cols;
+
+    // the noise alone is consistent
+    Ls_Pvt pvt;
+    pvt.leastSquarePos(satpos, obs, arma::eye(n, n));
+    detector.check_residuals(prn, n, pvt.d_raim_ssr, arma::conv_to<std::vector<double> >::from(pvt.d_raim_subset_ssr), 1000.0);
+    EXPECT_FALSE(state->spoofing_queue.try_pop(msg));
+
+    // PRN 12 is 150 m off
+    obs(2) += 150.0;
+    Ls_Pvt biased_pvt;
+    biased_pvt.leastSquarePos(satpos, obs, arma::eye(n, n));
+    detector.check_residuals(prn, n, biased_pvt.d_raim_ssr, arma::conv_to<std::vector<double> >::from(biased_pvt.d_raim_subset_ssr), 2000.0);
+    ASSERT_TRUE(state->spoofing_queue.try_pop(msg));
+    EXPECT_EQ(7, msg.spoofing_case);
+    ASSERT_EQ(1u, msg.satellites.size());
+    EXPECT_EQ(12u, *msg.satellites.begin());
+    EXPECT_FALSE(state->spoofing_queue.try_pop(msg));
+
+    // without it, the fix is the unbiased one
+    for (unsigned int r = 0; r < 3; r++)
+        {
+            EXPECT_NEAR(raim_test_rx_pos()(r), biased_pvt.d_raim_subset_pos(r, 2), 10.0);
+        }
+}
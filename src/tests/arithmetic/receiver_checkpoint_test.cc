@@ -0,0 +1,157 @@
+/*!
+ * \file receiver_checkpoint_test.cc
+ * \brief  This file implements tests for the checkpoints of the receiver
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include "concurrent_map.h"
+#include "in_memory_configuration.h"
+#include "receiver_checkpoint.h"
+#include "receiver_state.h"
+#include "spoofing_detector.h"
+
+
+
+TEST(ReceiverCheckpointTest, Buffer)
+{
+    Checkpoint_Buffer buffer;
+    buffer.put(static_cast<int32_t>(-3));
+    buffer.put(2.5);
+    Checkpoint_Buffer read(buffer.data());
+    int32_t i;
+    double x;
+    ASSERT_TRUE(read.get(i));
+    ASSERT_TRUE(read.get(x));
+    EXPECT_EQ(-3, i);
+    EXPECT_EQ(2.5, x);
+    EXPECT_FALSE(read.get(x));
+}
+
+
+TEST(ReceiverCheckpointTest, NewestCheckpoint)
+{
+    std::string filename = "./receiver_checkpoint_test.dat";
+    std::remove(filename.c_str());
+    std::string payload;
+    double wall_time_s;
+    {
+        Receiver_Checkpoint checkpoint(filename, 64);
+        ASSERT_TRUE(checkpoint.is_open());
+        EXPECT_FALSE(checkpoint.load(payload, wall_time_s));
+        EXPECT_TRUE(checkpoint.save("first", 1.0));
+        EXPECT_TRUE(checkpoint.save("second", 2.0));
+        EXPECT_TRUE(checkpoint.save("third", 3.0));
+        EXPECT_FALSE(checkpoint.save(std::string(65, 'x'), 4.0));
+    }
+    // the slot size of an existing file is kept
+    Receiver_Checkpoint checkpoint(filename, 1024);
+    EXPECT_EQ(64u, checkpoint.capacity());
+    ASSERT_TRUE(checkpoint.load(payload, wall_time_s));
+    EXPECT_EQ("third", payload);
+    EXPECT_EQ(3.0, wall_time_s);
+    std::remove(filename.c_str());
+}
+
+
+TEST(ReceiverCheckpointTest, TornCheckpoint)
+{
+    std::string filename = "./receiver_checkpoint_test.dat";
+    std::remove(filename.c_str());
+    {
+        Receiver_Checkpoint checkpoint(filename, 64);
+        ASSERT_TRUE(checkpoint.save("first", 1.0));
+        ASSERT_TRUE(checkpoint.save("second", 2.0));
+    }
+    // corrupt the payload of the newest one; checkpoint n is in slot n % 2
+    FILE* file = std::fopen(filename.c_str(), "r+b");
+    ASSERT_TRUE(file != 0);
+    std::fseek(file, 16 + 24, SEEK_SET);
+    std::fputc('S', file);
+    std::fclose(file);
+
+    Receiver_Checkpoint checkpoint(filename, 64);
+    std::string payload;
+    double wall_time_s;
+    ASSERT_TRUE(checkpoint.load(payload, wall_time_s));
+    EXPECT_EQ("first", payload);
+    // and the next one replaces the broken one
+    ASSERT_TRUE(checkpoint.save("third", 3.0));
+    ASSERT_TRUE(checkpoint.load(payload, wall_time_s));
+    EXPECT_EQ("third", payload);
+    std::remove(filename.c_str());
+}
+
+
+TEST(ReceiverCheckpointTest, DetectorRestart)
+{
+    std::string filename = "./receiver_checkpoint_test.dat";
+    std::remove(filename.c_str());
+    std::shared_ptr<InMemoryConfiguration> configuration = std::make_shared<InMemoryConfiguration>();
+    configuration->set_property("Spoofing.checkpoint_filename", filename);
+
+    Gps_Ephemeris eph;
+    eph.i_satellite_PRN = 11;
+    eph.d_sqrt_A = 5153.7;
+    eph.i_GPS_week = 1850;
+    eph.d_IODE_SF2 = 40;
+    eph.d_IODE_SF3 = 40;
+    {
+        std::shared_ptr<Receiver_State> state = std::make_shared<Receiver_State>();
+        Receiver_State_Scope state_scope(state);
+        state->ephemeris_history.store(11, eph, 50000.0);
+        eph.d_IODE_SF2 = 41;
+        eph.d_IODE_SF3 = 41;
+        state->ephemeris_history.store(11, eph, 60000.0);
+        Spoofing_Detector detector(configuration.get());
+        Channel_List channels;
+        detector.new_epoch(channels, 0, 90000);
+    }
+
+    // the restarted detector has the ephemeris history, at the time of the last run
+    std::shared_ptr<Receiver_State> state = std::make_shared<Receiver_State>();
+    Receiver_State_Scope state_scope(state);
+    Spoofing_Detector detector(configuration.get());
+    ASSERT_EQ(2u, state->ephemeris_history.records(11).size());
+    sEph restored;
+    ASSERT_TRUE(state->ephemeris_history.latest(11, restored));
+    EXPECT_EQ(5153.7, restored.ephemeris.d_sqrt_A);
+    EXPECT_EQ(1850, restored.ephemeris.i_GPS_week);
+    EXPECT_EQ(11u, restored.ephemeris.i_satellite_PRN);
+    EXPECT_EQ(41.0, restored.ephemeris.d_IODE_SF3);
+    EXPECT_TRUE(restored.changed);
+    EXPECT_LE(restored.time, 60000.0 - 90000.0);
+    EXPECT_GT(restored.time, 60000.0 - 90000.0 - 60e3);
+    ASSERT_TRUE(state->ephemeris_history.find_issue(11, 0.0, 40, restored));
+    EXPECT_LE(restored.time, 50000.0 - 90000.0);
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,99 @@
+/*!
+ * \file receiver_state_test.cc
+ * \brief  This file implements tests for the tables shared by the blocks of a receiver
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <memory>
+#include <vector>
+#include <boost/thread.hpp>
+#include <gtest/gtest.h>
+#include "receiver_state.h"
+
+
+TEST(ReceiverStateTest, Scopes)
+{
+    std::shared_ptr<Receiver_State> outside = Receiver_State::current();
+    EXPECT_EQ(Receiver_State::default_state(), outside);
+
+    std::shared_ptr<Receiver_State> first = std::make_shared<Receiver_State>();
+    std::shared_ptr<Receiver_State> second = std::make_shared<Receiver_State>();
+    {
+        Receiver_State_Scope first_scope(first);
+        EXPECT_EQ(first, Receiver_State::current());
+        {
+            Receiver_State_Scope second_scope(second);
+            EXPECT_EQ(second, Receiver_State::current());
+        }
+        EXPECT_EQ(first, Receiver_State::current());
+
+        // the binding is per thread
+        std::shared_ptr<Receiver_State> other_thread;
+        boost::thread thread([&]() { other_thread = Receiver_State::current(); });
+        thread.join();
+        EXPECT_EQ(outside, other_thread);
+    }
+    EXPECT_EQ(outside, Receiver_State::current());
+}
+
+
+TEST(ReceiverStateTest, IndependentReceivers)
+{
+    Receiver_State first;
+    Receiver_State second;
+    first.aoa_map.write(3, Aoa_Metrics());
+    first.spoofing_queue.push(Spoofing_Message());
+    Aoa_Metrics metrics;
+    Spoofing_Message msg;
+    EXPECT_TRUE(first.aoa_map.read(3, metrics));
+    EXPECT_FALSE(second.aoa_map.read(3, metrics));
+    EXPECT_FALSE(second.spoofing_queue.try_pop(msg));
+    EXPECT_TRUE(first.spoofing_queue.try_pop(msg));
+}
+
+
+TEST(ReceiverStateTest, Watch)
+{
+    Receiver_State state;
+    std::vector<int> keys;
+    std::vector<double> values;
+    state.last_gps_time.watch([&](int key, const double& value)
+            {
+                keys.push_back(key);
+                values.push_back(value);
+            });
+    state.last_gps_time.write(0, 1850.0);
+    state.last_gps_time.add(1, 302400.0);
+    state.last_gps_time.remove(0);
+    ASSERT_EQ(2u, keys.size());
+    EXPECT_EQ(0, keys[0]);
+    EXPECT_EQ(1850.0, values[0]);
+    EXPECT_EQ(1, keys[1]);
+    EXPECT_EQ(302400.0, values[1]);
+}
@@ -0,0 +1,182 @@
+/*!
+ * \file rinex_nav_reader_test.cc
+ * \brief Tests of the RINEX navigation file reader
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <gtest/gtest.h>
+#include "rinex_nav_reader.h"
+#include "rinex_nav_source.h"
+
+namespace
+{
+const char* rinex2_nav[] = {
+        "     2.10           N: GPS NAV DATA                         RINEX VERSION / TYPE",
+        "    0.1118D-07  0.2235D-07 -0.1192D-06 -0.1192D-06          ION ALPHA",
+        "    0.1167D+06  0.1638D+06 -0.6554D+05 -0.5243D+06          ION BETA",
+        "     .186264514923D-08  .888178419700D-14   233472     1829 DELTA-UTC: A0,A1,T,W",
+        "    17                                                      LEAP SECONDS",
+        "                                                            END OF HEADER",
+        " 5 15  1 27  2  0  0.0  .150000000000D-03 -.227373675440D-11  .000000000000D+00",
+        "     .450000000000D+02 -.500312500000D+02  .450000000000D-08  .123456789012D+01",
+        "    -.250000000000D-05  .123456789012D-01  .750000000000D-05  .515365432109D+04",
+        "     .180000000000D+06  .110000000000D-06 -.123456789010D+01 -.220000000000D-07",
+        "     .961234567891D+00  .210500000000D+03  .567890123400D+00 -.810000000000D-08",
+        "     .310000000000D-09  .100000000000D+01  .182900000000D+04  .000000000000D+00",
+        "     .200000000000D+01  .000000000000D+00 -.110000000000D-07  .450000000000D+02",
+        "     .172800000000D+06  .400000000000D+01",
+};
+
+const char* rinex3_nav[] = {
+        "     3.02           N: GNSS NAV DATA    M: Mixed            RINEX VERSION / TYPE",
+        "GPSA   1.1180D-08  2.2350D-08 -1.1920D-07 -1.1920D-07       IONOSPHERIC CORR",
+        "GPSB   1.1670D+05  1.6380D+05 -6.5540D+04 -5.2430D+05       IONOSPHERIC CORR",
+        "GPUT  1.8626451492D-09 8.881784197D-15 233472 1829          TIME SYSTEM CORR",
+        "    17    17  1851     7                                    LEAP SECONDS",
+        "                                                            END OF HEADER",
+        "R03 2015 01 27 01 45 00  .100000000000D-04  .000000000000D+00  .200000000000D+04",
+        "      .100000000000D+01  .200000000000D+01  .300000000000D+01  .400000000000D+01",
+        "      .100000000000D+01  .200000000000D+01  .300000000000D+01  .400000000000D+01",
+        "      .100000000000D+01  .200000000000D+01  .300000000000D+01  .400000000000D+01",
+        "G05 2015 01 27 02 00 00  .150000000000D-03 -.227373675440D-11  .000000000000D+00",
+        "      .450000000000D+02 -.500312500000D+02  .450000000000D-08  .123456789012D+01",
+        "     -.250000000000D-05  .123456789012D-01  .750000000000D-05  .515365432109D+04",
+        "      .180000000000D+06  .110000000000D-06 -.123456789010D+01 -.220000000000D-07",
+        "      .961234567891D+00  .210500000000D+03  .567890123400D+00 -.810000000000D-08",
+        "      .310000000000D-09  .100000000000D+01  .182900000000D+04  .000000000000D+00",
+        "      .200000000000D+01  .000000000000D+00 -.110000000000D-07  .450000000000D+02",
+        "      .172800000000D+06  .400000000000D+01",
+};
+
+void expect_prn5_record(const Rinex_Gps_Record& record)
+{
+    const Gps_Ephemeris& e = record.ephemeris;
+    EXPECT_EQ(5u, e.i_satellite_PRN);
+    EXPECT_EQ(1829, record.week);
+    EXPECT_EQ(1829 % 1024, e.i_GPS_week);
+    EXPECT_DOUBLE_EQ(180000.0, e.d_Toc);   // Tuesday 02:00
+    EXPECT_DOUBLE_EQ(180000.0, e.d_Toe);
+    EXPECT_DOUBLE_EQ(1829 * 604800.0 + 180000.0, record.toe_gps_s());
+    EXPECT_DOUBLE_EQ(1.5e-4, e.d_A_f0);
+    EXPECT_DOUBLE_EQ(-2.27373675440e-12, e.d_A_f1);
+    EXPECT_DOUBLE_EQ(45.0, e.d_IODE_SF2);
+    EXPECT_DOUBLE_EQ(-50.03125, e.d_Crs);
+    EXPECT_DOUBLE_EQ(1.23456789012, e.d_M_0);
+    EXPECT_DOUBLE_EQ(0.0123456789012, e.d_e_eccentricity);
+    EXPECT_DOUBLE_EQ(5153.65432109, e.d_sqrt_A);
+    EXPECT_DOUBLE_EQ(-1.2345678901, e.d_OMEGA0);
+    EXPECT_DOUBLE_EQ(0.961234567891, e.d_i_0);
+    EXPECT_DOUBLE_EQ(-8.1e-9, e.d_OMEGA_DOT);
+    EXPECT_DOUBLE_EQ(3.1e-10, e.d_IDOT);
+    EXPECT_EQ(1, e.i_code_on_L2);
+    EXPECT_EQ(0, e.i_SV_accuracy);        // 2 m
+    EXPECT_EQ(0, e.i_SV_health);
+    EXPECT_DOUBLE_EQ(-1.1e-8, e.d_TGD);
+    EXPECT_DOUBLE_EQ(45.0, e.d_IODC);
+    EXPECT_DOUBLE_EQ(172800.0, e.d_TOW);
+    EXPECT_FALSE(e.b_fit_interval_flag);
+}
+}
+
+
+TEST(RinexNavReaderTest, Version2)
+{
+    Rinex_Nav_Reader reader;
+    for (unsigned int i = 0; i < sizeof(rinex2_nav) / sizeof(rinex2_nav[0]); i++)
+        {
+            reader.add_line(rinex2_nav[i], std::strlen(rinex2_nav[i]));
+        }
+    EXPECT_TRUE(reader.is_navigation());
+    EXPECT_DOUBLE_EQ(2.1, reader.version());
+    ASSERT_EQ(1u, reader.records().size());
+    expect_prn5_record(reader.records()[0]);
+    EXPECT_TRUE(reader.iono().valid);
+    EXPECT_DOUBLE_EQ(0.1118e-7, reader.iono().d_alpha0);
+    EXPECT_DOUBLE_EQ(-0.5243e6, reader.iono().d_beta3);
+    EXPECT_TRUE(reader.utc().valid);
+    EXPECT_DOUBLE_EQ(1.86264514923e-9, reader.utc().d_A0);
+    EXPECT_DOUBLE_EQ(233472.0, reader.utc().d_t_OT);
+    EXPECT_EQ(1829 % 256, reader.utc().i_WN_T);
+    EXPECT_DOUBLE_EQ(17.0, reader.utc().d_DeltaT_LS);
+}
+
+
+TEST(RinexNavReaderTest, Version3SkipsOtherSystems)
+{
+    Rinex_Nav_Reader reader;
+    for (unsigned int i = 0; i < sizeof(rinex3_nav) / sizeof(rinex3_nav[0]); i++)
+        {
+            reader.add_line(rinex3_nav[i], std::strlen(rinex3_nav[i]));
+        }
+    EXPECT_TRUE(reader.is_navigation());
+    ASSERT_EQ(1u, reader.records().size());
+    expect_prn5_record(reader.records()[0]);
+    EXPECT_TRUE(reader.iono().valid);
+    EXPECT_DOUBLE_EQ(1.638e5, reader.iono().d_beta1);
+    EXPECT_DOUBLE_EQ(8.881784197e-15, reader.utc().d_A1);
+    EXPECT_EQ(1851 % 256, reader.utc().i_WN_LSF);
+    EXPECT_EQ(7, reader.utc().i_DN);
+}
+
+
+TEST(RinexNavReaderTest, Source)
+{
+    std::string filename = "./rinex_nav_reader_test.15n";
+    {
+        std::ofstream file(filename.c_str());
+        for (unsigned int i = 0; i < sizeof(rinex2_nav) / sizeof(rinex2_nav[0]); i++)
+            {
+                file << rinex2_nav[i] << "\r\n";
+            }
+    }
+    Rinex_Nav_Source source(filename);
+    std::vector<unsigned int> updated;
+    ASSERT_TRUE(source.poll(&updated));
+    ASSERT_EQ(1u, updated.size());
+    EXPECT_EQ(5u, updated[0]);
+    // nothing changed since
+    EXPECT_FALSE(source.poll());
+
+    Gps_Ephemeris ephemeris;
+    EXPECT_TRUE(source.get_ephemeris(5, 180000.0, 45.0, ephemeris));
+    EXPECT_DOUBLE_EQ(5153.65432109, ephemeris.d_sqrt_A);
+    EXPECT_FALSE(source.get_ephemeris(5, 187200.0, 45.0, ephemeris));
+    EXPECT_FALSE(source.get_ephemeris(6, 180000.0, 45.0, ephemeris));
+    EXPECT_TRUE(source.get_ephemeris_at(5, 1830 * 604800.0, ephemeris));
+    EXPECT_DOUBLE_EQ(180000.0, ephemeris.d_Toe);
+    Gps_Iono iono;
+    EXPECT_TRUE(source.get_iono(iono));
+
+    Rinex_Nav_Reader reader;
+    EXPECT_FALSE(reader.read_file("./no_such_rinex_nav_file.15n"));
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,199 @@
+/*!
+ * \file rolling_statistics_test.cc
+ * \brief  This file implements tests for the moving-window statistics
+ * used by the spoofing detector
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <map>
+#include <vector>
+#include <gtest/gtest.h>
+#include "rolling_statistics.h"
+
+
+TEST(RollingStatisticsTest, MatchesTwoPassOverWindow)
+{
+    unsigned int window_size = 50;
+    Rolling_Statistics stats(window_size);
+    std::deque<double> window;
+
+    EXPECT_EQ(0.0, stats.var());
+    for (unsigned int i = 0; i < 10 * window_size; i++)
+        {
+            double x = 40.0 + 3.0 * std::sin(0.1 * i) + 0.01 * (i % 7);
+            stats.push_back(x);
+            window.push_back(x);
+            if (window.size() > window_size)
+                {
+                    window.pop_front();
+                }
+
+            double mean = 0.0;
+            for (std::deque<double>::iterator it = window.begin(); it != window.end(); ++it)
+                {
+                    mean += *it;
+                }
+            mean /= window.size();
+            double var = 0.0;
+            for (std::deque<double>::iterator it = window.begin(); it != window.end(); ++it)
+                {
+                    var += (*it - mean) * (*it - mean);
+                }
+            var /= window.size();
+
+            ASSERT_EQ(window.size(), stats.size());
+            ASSERT_NEAR(mean, stats.mean(), 1e-9);
+            ASSERT_NEAR(var, stats.var(), 1e-9);
+        }
+    EXPECT_TRUE(stats.full());
+
+    stats.clear();
+    EXPECT_EQ(0u, stats.size());
+    EXPECT_EQ(0.0, stats.mean());
+}
+
+
+TEST(RollingStatisticsTest, CovarianceMatchesTwoPassOverWindow)
+{
+    unsigned int window_size = 30;
+    Rolling_Covariance cov(window_size);
+    std::deque<std::pair<double, double> > window;
+
+    for (unsigned int i = 0; i < 10 * window_size; i++)
+        {
+            double x = 45.0 + std::cos(0.2 * i);
+            double y = 38.0 + 2.0 * std::cos(0.2 * i + 0.5) + 0.1 * (i % 3);
+            cov.push_back(x, y);
+            window.push_back(std::make_pair(x, y));
+            if (window.size() > window_size)
+                {
+                    window.pop_front();
+                }
+
+            double mean_x = 0.0, mean_y = 0.0;
+            for (unsigned int j = 0; j < window.size(); j++)
+                {
+                    mean_x += window[j].first;
+                    mean_y += window[j].second;
+                }
+            mean_x /= window.size();
+            mean_y /= window.size();
+            double c = 0.0, var_x = 0.0, var_y = 0.0;
+            for (unsigned int j = 0; j < window.size(); j++)
+                {
+                    c += (window[j].first - mean_x) * (window[j].second - mean_y);
+                    var_x += (window[j].first - mean_x) * (window[j].first - mean_x);
+                    var_y += (window[j].second - mean_y) * (window[j].second - mean_y);
+                }
+
+            ASSERT_NEAR(c / window.size(), cov.cov(), 1e-9);
+            ASSERT_NEAR(var_x / window.size(), cov.var_x(), 1e-9);
+            ASSERT_NEAR(var_y / window.size(), cov.var_y(), 1e-9);
+        }
+}
+
+
+TEST(RollingStatisticsTest, CorrelationMatrixMatchesPairWindows)
+{
+    unsigned int window_size = 20;
+    Rolling_Correlation_Matrix matrix(window_size);
+    // the windows of each pair, from the epoch where both signals are present
+    std::map<std::pair<unsigned int, unsigned int>, Rolling_Covariance> pairs;
+
+    for (unsigned int i = 0; i < 10 * window_size; i++)
+        {
+            // signal 3 joins late, signal 5 drops out for a while and comes back
+            std::map<unsigned int, double> samples;
+            samples[1] = 45.0 + std::cos(0.2 * i);
+            samples[2] = 38.0 + 2.0 * std::cos(0.2 * i + 0.5) + 0.1 * (i % 3);
+            if (i >= 7) samples[3] = 41.0 + std::sin(0.05 * i * i);
+            if (i < 50 or i >= 90) samples[5] = 30.0 + 0.5 * (i % 4);
+            matrix.push_back(samples);
+
+            for (std::map<std::pair<unsigned int, unsigned int>, Rolling_Covariance>::iterator it = pairs.begin(); it != pairs.end(); )
+                {
+                    if (!samples.count(it->first.first) or !samples.count(it->first.second))
+                        pairs.erase(it++);
+                    else
+                        ++it;
+                }
+            for (std::map<unsigned int, double>::iterator a = samples.begin(); a != samples.end(); ++a)
+                {
+                    std::map<unsigned int, double>::iterator b = a;
+                    for (++b; b != samples.end(); ++b)
+                        {
+                            std::pair<unsigned int, unsigned int> key(a->first, b->first);
+                            if (!pairs.count(key)) pairs[key] = Rolling_Covariance(window_size);
+                            pairs[key].push_back(a->second, b->second);
+                        }
+                }
+
+            unsigned int compared = 0;
+            for (unsigned int a = 0; a < matrix.slots(); a++)
+                {
+                    for (unsigned int b = a + 1; b < matrix.slots(); b++)
+                        {
+                            if (!matrix.active(a) or !matrix.active(b)) continue;
+                            std::pair<unsigned int, unsigned int> key(std::min(matrix.id(a), matrix.id(b)), std::max(matrix.id(a), matrix.id(b)));
+                            ASSERT_EQ(1u, pairs.count(key));
+                            const Rolling_Covariance& ab = pairs[key];
+                            bool swapped = matrix.id(a) != key.first;
+                            ASSERT_EQ(ab.size(), matrix.size(a, b));
+                            ASSERT_EQ(ab.full(), matrix.full(a, b));
+                            ASSERT_NEAR(ab.cov(), matrix.cov(a, b), 1e-9);
+                            ASSERT_NEAR(swapped ? ab.var_y() : ab.var_x(), matrix.var(a, b), 1e-9);
+                            ASSERT_NEAR(swapped ? ab.var_x() : ab.var_y(), matrix.var(b, a), 1e-9);
+                            compared++;
+                        }
+                }
+            ASSERT_EQ(pairs.size(), compared);
+        }
+
+    // a signal restored with the window of an earlier run
+    std::vector<double> window = matrix.samples(1);
+    ASSERT_EQ(window_size, window.size());
+    EXPECT_NEAR(45.0 + std::cos(0.2 * (10 * window_size - 1)), window.back(), 1e-9);
+    matrix.insert(7, window);
+    unsigned int restored = matrix.slots();
+    for (unsigned int a = 0; a < matrix.slots(); a++)
+        {
+            if (matrix.active(a) and matrix.id(a) == 7) restored = a;
+        }
+    ASSERT_LT(restored, matrix.slots());
+    for (unsigned int a = 0; a < matrix.slots(); a++)
+        {
+            if (matrix.active(a) and matrix.id(a) == 1)
+                {
+                    EXPECT_TRUE(matrix.full(a, restored));
+                    EXPECT_NEAR(matrix.var(a, restored), matrix.cov(a, restored), 1e-9);
+                }
+        }
+}
@@ -0,0 +1,86 @@
+/*!
+ * \file secondary_code_sync_test.cc
+ * \brief  This file implements tests for the synchronization with the
+ * secondary code of a pilot
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <complex>
+#include <gtest/gtest.h>
+#include "Galileo_E1.h"
+#include "secondary_code_sync.h"
+
+
+TEST(SecondaryCodeSyncTest, FindsTheChip)
+{
+    Secondary_Code_Sync sync(Galileo_E1_C_SECONDARY_CODE);
+    ASSERT_EQ(25u, sync.length());
+    // the tracking starts on chip 7, with the carrier half a cycle off
+    unsigned int chip = 7;
+    bool found = false;
+    int periods = 0;
+    while (!found)
+        {
+            float sign = Galileo_E1_C_SECONDARY_CODE.at(chip) == '0' ? -1.0 : 1.0;
+            found = sync.add(std::complex<float>(sign * 100.0, 20.0));
+            chip = (chip + 1) % 25;
+            periods++;
+        }
+    EXPECT_EQ(25, periods);
+    EXPECT_TRUE(sync.locked());
+    EXPECT_EQ(-1, sync.polarity());
+    EXPECT_EQ(chip, sync.chip());
+    for (int k = 0; k < 30; k++)
+        {
+            EXPECT_EQ(Galileo_E1_C_SECONDARY_CODE.at(chip) == '0' ? 1.0 : -1.0, sync.next_sign());
+            chip = (chip + 1) % 25;
+        }
+}
+
+
+TEST(SecondaryCodeSyncTest, NoLockOnWrongSigns)
+{
+    Secondary_Code_Sync sync(Galileo_E1_C_SECONDARY_CODE);
+    // a constant sign is no shift of the code
+    for (int k = 0; k < 100; k++)
+        {
+            EXPECT_FALSE(sync.add(std::complex<float>(1.0, 0.0)));
+        }
+    EXPECT_FALSE(sync.locked());
+    EXPECT_FLOAT_EQ(1.0, sync.next_sign());
+
+    // one wrong sign in the last 25 periods
+    for (unsigned int chip = 0; chip < 25; chip++)
+        {
+            float sign = Galileo_E1_C_SECONDARY_CODE.at(chip) == '0' ? 1.0 : -1.0;
+            if (chip == 12) sign = -sign;
+            EXPECT_FALSE(sync.add(std::complex<float>(sign, 0.0)));
+        }
+    sync.reset();
+    EXPECT_FALSE(sync.locked());
+}
@@ -0,0 +1,118 @@
+/*!
+ * \file spectrum_monitor_test.cc
+ * \brief Tests of the Spectrum_Monitor class
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include "spectrum_monitor.h"
+
+
+namespace
+{
+// 64 ksps, so each 1 ms period is one 64 point block, reported every 10 ms
+const double FS_HZ = 64000.0;
+
+void add_noise(Spectrum_Monitor& monitor, std::mt19937& generator, float sigma, double tone_amplitude,
+        unsigned int reports, bool& anomaly)
+{
+    std::normal_distribution<float> noise(0.0, sigma);
+    std::vector<gr_complex> samples(640);
+    anomaly = false;
+    for (unsigned int r = 0; r < reports; r++)
+        {
+            for (unsigned int i = 0; i < samples.size(); i++)
+                {
+                    // the tone sits in a bin, 8 kHz
+                    double phase = 2.0 * M_PI * 8000.0 * i / FS_HZ;
+                    samples[i] = gr_complex(noise(generator) + tone_amplitude * std::cos(phase),
+                            noise(generator) + tone_amplitude * std::sin(phase));
+                }
+            ASSERT_TRUE(monitor.add(samples.data(), samples.size()));
+            anomaly = anomaly || monitor.metrics().anomaly;
+        }
+}
+}
+
+
+TEST(SpectrumMonitorTest, NoAnomalyOnSteadyNoise)
+{
+    Spectrum_Monitor monitor(FS_HZ, 64, 1.0, 10, 0.5);
+    std::mt19937 generator(1);
+    bool anomaly;
+    add_noise(monitor, generator, 0.1, 0.0, 200, anomaly);
+    EXPECT_FALSE(anomaly);
+    EXPECT_EQ(0u, monitor.metrics().onsets);
+    EXPECT_EQ(200u * 640u, monitor.metrics().sample_counter);
+    // 2 sigma^2 = 0.02, -17 dB
+    EXPECT_NEAR(-17.0, monitor.metrics().floor_db, 0.3);
+    EXPECT_LT(monitor.metrics().floor_sigma_db, 0.5);
+    EXPECT_GT(monitor.metrics().flatness, 0.5);
+}
+
+
+TEST(SpectrumMonitorTest, PowerRiseIsAnAnomaly)
+{
+    Spectrum_Monitor monitor(FS_HZ, 64, 1.0, 10, 0.5);
+    monitor.set_thresholds(3.0, 100.0);
+    std::mt19937 generator(2);
+    bool anomaly;
+    add_noise(monitor, generator, 0.1, 0.0, 100, anomaly);
+    EXPECT_FALSE(anomaly);
+
+    // 6 dB more
+    add_noise(monitor, generator, 0.2, 0.0, 10, anomaly);
+    EXPECT_TRUE(anomaly);
+    EXPECT_EQ(1u, monitor.metrics().onsets);
+    EXPECT_NEAR(6.0, monitor.metrics().power_db - monitor.metrics().floor_db, 1.0);
+
+    // the floor did not follow the jammer
+    add_noise(monitor, generator, 0.1, 0.0, 10, anomaly);
+    EXPECT_FALSE(monitor.metrics().anomaly);
+    EXPECT_NEAR(-17.0, monitor.metrics().floor_db, 0.3);
+}
+
+
+TEST(SpectrumMonitorTest, ToneIsASpectrumDeviation)
+{
+    Spectrum_Monitor monitor(FS_HZ, 64, 1.0, 10, 0.5);
+    monitor.set_thresholds(100.0, 6.0);
+    std::mt19937 generator(3);
+    bool anomaly;
+    add_noise(monitor, generator, 0.1, 0.0, 100, anomaly);
+    EXPECT_FALSE(anomaly);
+
+    // a tone at a quarter of the power of the noise
+    add_noise(monitor, generator, 0.1, std::sqrt(0.005), 10, anomaly);
+    EXPECT_TRUE(anomaly);
+    EXPECT_GT(monitor.metrics().deviation_db, 6.0);
+    EXPECT_LT(monitor.metrics().flatness, 0.9);
+}
@@ -0,0 +1,116 @@
+/*!
+ * \file spoofing_check_scheduler_test.cc
+ * \brief  This file implements tests for the scheduler of the checks of
+ * the spoofing detector
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <boost/thread/thread.hpp>
+#include <gtest/gtest.h>
+#include "spoofing_check_scheduler.h"
+
+
+TEST(SpoofingCheckSchedulerTest, MinInterval)
+{
+    Spoofing_Check_Scheduler scheduler;
+    int check = scheduler.add_check("interval", Spoofing_Check_Scheduler::INLINE, 10.0, 0.0);
+    EXPECT_TRUE(scheduler.admit(check, 0.0));
+    EXPECT_FALSE(scheduler.admit(check, 5.0));
+    EXPECT_TRUE(scheduler.admit(check, 10.0));
+    EXPECT_FALSE(scheduler.admit(check, 19.0));
+    EXPECT_TRUE(scheduler.admit(check, 25.0));
+    std::vector<Spoofing_Check_Scheduler::Check_Stats> stats = scheduler.stats();
+    ASSERT_EQ(1u, stats.size());
+    EXPECT_EQ("interval", stats[0].name);
+    EXPECT_EQ(2u, stats[0].skipped_rate);
+}
+
+
+TEST(SpoofingCheckSchedulerTest, Budget)
+{
+    Spoofing_Check_Scheduler scheduler;
+    int check = scheduler.add_check("budget", Spoofing_Check_Scheduler::INLINE, 0.0, 100.0);
+    int runs = 0;
+    ASSERT_TRUE(scheduler.admit(check, 0.0));
+    scheduler.dispatch(check, [&]() { runs++; std::this_thread::sleep_for(std::chrono::milliseconds(1)); });
+    EXPECT_EQ(1, runs);
+
+    // a run costs at least ten times the budget, so at most one in ten inputs is admitted
+    std::vector<Spoofing_Check_Scheduler::Check_Stats> stats = scheduler.stats();
+    EXPECT_GE(stats[0].decimation, 10u);
+    int admitted = 0;
+    for (unsigned int i = 1; i < stats[0].decimation; i++)
+        {
+            if (scheduler.admit(check, i)) admitted++;
+        }
+    EXPECT_EQ(0, admitted);
+    EXPECT_TRUE(scheduler.admit(check, stats[0].decimation));
+    EXPECT_EQ(stats[0].decimation - 1, scheduler.stats()[0].skipped_budget);
+}
+
+
+TEST(SpoofingCheckSchedulerTest, Deferred)
+{
+    Spoofing_Check_Scheduler scheduler;
+    int check = scheduler.add_check("deferred", Spoofing_Check_Scheduler::DEFERRED, 0.0, 0.0);
+    EXPECT_FALSE(scheduler.is_inline(check));
+    std::atomic<int> runs(0);
+    std::atomic<bool> other_thread(true);
+    boost::thread::id caller = boost::this_thread::get_id();
+    for (int i = 0; i < 10; i++)
+        {
+            ASSERT_TRUE(scheduler.admit(check, i));
+            scheduler.dispatch(check, [&]() { runs++; if (boost::this_thread::get_id() == caller) other_thread = false; });
+        }
+    scheduler.flush();
+    EXPECT_EQ(10, runs.load());
+    EXPECT_TRUE(other_thread.load());
+    EXPECT_EQ(10u, scheduler.stats()[0].runs);
+}
+
+
+TEST(SpoofingCheckSchedulerTest, Batched)
+{
+    // the batch interval does not end during the test, only flush() runs the batch
+    Spoofing_Check_Scheduler scheduler(2, 1e7);
+    int check = scheduler.add_check("batched", Spoofing_Check_Scheduler::BATCHED, 0.0, 0.0);
+    std::atomic<int> runs(0);
+    for (int i = 0; i < 3; i++)
+        {
+            scheduler.dispatch(check, [&]() { runs++; });
+        }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(0, runs.load());
+    scheduler.flush();
+    EXPECT_EQ(2, runs.load());
+    EXPECT_EQ(1u, scheduler.stats()[0].dropped);
+}
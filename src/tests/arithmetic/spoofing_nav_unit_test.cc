@@ -0,0 +1,148 @@
+/*!
+ * \file spoofing_nav_unit_test.cc
+ * \brief  This file implements tests for the navigation message units of
+ * all the constellations and their checks in the spoofing detector
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include "concurrent_ring_queue.h"
+#include "receiver_state.h"
+#include "in_memory_configuration.h"
+#include "spoofing_detector.h"
+#include "spoofing_message.h"
+#include "spoofing_nav_unit.h"
+
+
+namespace
+{
+Spoofing_Nav_Unit make_unit(char system, unsigned int PRN, int unit_id, double TOW, double time_ms)
+{
+    Spoofing_Nav_Unit unit;
+    unit.system = system;
+    unit.PRN = PRN;
+    unit.uid = PRN;
+    unit.unit_id = unit_id;
+    unit.week = 0;
+    unit.TOW = TOW;
+    unit.time_ms = time_ms;
+    return unit;
+}
+}
+
+
+TEST(SpoofingNavUnitTest, Payload)
+{
+    Spoofing_Nav_Unit unit;
+    unit.set_bits("1010000000000001");
+    ASSERT_EQ(2u, unit.payload.size());
+    EXPECT_EQ(0xA0, unit.payload[0]);
+    EXPECT_EQ(0x01, unit.payload[1]);
+    unit.set_bits("111");
+    ASSERT_EQ(1u, unit.payload.size());
+    EXPECT_EQ(0xE0, unit.payload[0]);
+
+    Gps_Subframe_Words subframe;
+    subframe.words[0] = 0x22C00000;
+    subframe.words[9] = 0x3FFFFFFF;
+    unit.set_words(subframe);
+    ASSERT_EQ(40u, unit.payload.size());
+    EXPECT_EQ(0x22, unit.payload[0]);
+    EXPECT_EQ(0xC0, unit.payload[1]);
+    EXPECT_EQ(0x3F, unit.payload[36]);
+    EXPECT_EQ(0xFF, unit.payload[39]);
+}
+
+
+TEST(SpoofingNavUnitTest, HybridTimeBase)
+{
+    Spoofing_Message msg;
+    std::shared_ptr<Receiver_State> state = std::make_shared<Receiver_State>();
+    Receiver_State_Scope state_scope(state);
+
+    std::shared_ptr<InMemoryConfiguration> config = std::make_shared<InMemoryConfiguration>();
+    config->set_property("Spoofing.NAVI_inter_satellite", "true");
+    config->set_property("Spoofing.NAVI_time_max_discrepancy_ms", "50");
+    Spoofing_Detector detector(config.get());
+
+    // a clock offset of 1000 s and travel times of 67 to 86 ms
+    detector.check_nav_unit(make_unit('G', 3, 1, 300.0, 1300067.0));
+    detector.check_nav_unit(make_unit('G', 7, 1, 300.0, 1300075.0));
+    detector.check_nav_unit(make_unit('E', 11, 0, 302.0, 1302080.0));
+    detector.check_nav_unit(make_unit('E', 12, 0, 302.0, 1302086.0));
+    detector.check_nav_unit(make_unit('G', 9, 2, 306.0, 1306070.0));
+    EXPECT_FALSE(state->spoofing_queue.try_pop(msg));
+
+    // a Galileo satellite one second late, seen against both constellations
+    detector.check_nav_unit(make_unit('E', 19, 0, 304.0, 1305078.0));
+    ASSERT_TRUE(state->spoofing_queue.try_pop(msg));
+    EXPECT_EQ(4, msg.spoofing_case);
+    ASSERT_EQ(1u, msg.satellites.size());
+    EXPECT_EQ(19u, *msg.satellites.begin());
+    EXPECT_FALSE(state->spoofing_queue.try_pop(msg));
+}
+
+
+TEST(SpoofingNavUnitTest, GalileoCommonWords)
+{
+    Spoofing_Message msg;
+    std::shared_ptr<Receiver_State> state = std::make_shared<Receiver_State>();
+    Receiver_State_Scope state_scope(state);
+
+    std::shared_ptr<InMemoryConfiguration> config = std::make_shared<InMemoryConfiguration>();
+    config->set_property("Spoofing.NAVI_inter_satellite", "true");
+    Spoofing_Detector detector(config.get());
+
+    // word 6: the UTC parameters in bits 7-104, the TOW in bits 106-125
+    std::string word(128, '0');
+    word.replace(0, 6, "000110");
+    word[20] = '1';
+    for (unsigned int PRN = 1; PRN <= 3; PRN++)
+        {
+            Spoofing_Nav_Unit unit = make_unit('E', PRN, 6, 100.0, 100070.0 + PRN);
+            std::string bits = word;
+            bits[110 + PRN] = '1';  // the TOW is not compared
+            unit.set_bits(bits);
+            detector.check_nav_unit(unit);
+        }
+    EXPECT_FALSE(state->spoofing_queue.try_pop(msg));
+
+    Spoofing_Nav_Unit unit = make_unit('E', 4, 6, 100.0, 100074.0);
+    std::string bits = word;
+    bits[40] = '1';
+    unit.set_bits(bits);
+    detector.check_nav_unit(unit);
+    ASSERT_TRUE(state->spoofing_queue.try_pop(msg));
+    EXPECT_EQ(2, msg.spoofing_case);
+    ASSERT_EQ(1u, msg.satellites.size());
+    EXPECT_EQ(4u, *msg.satellites.begin());
+    EXPECT_FALSE(state->spoofing_queue.try_pop(msg));
+}
@@ -0,0 +1,166 @@
+/*!
+ * \file spoofing_peers_test.cc
+ * \brief  This file implements tests for the exchange of summaries between
+ * receivers and the collaborative checks of the spoofing detector
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <gtest/gtest.h>
+#include "concurrent_ring_queue.h"
+#include "receiver_state.h"
+#include "in_memory_configuration.h"
+#include "spoofing_detector.h"
+#include "spoofing_message.h"
+#include "spoofing_peers.h"
+
+namespace
+{
+Spoofing_Peer_Satellite peer_satellite(unsigned int PRN, double CN0_dB_hz, int TOW, double subframe_offset_ms)
+{
+    Spoofing_Peer_Satellite satellite = Spoofing_Peer_Satellite();
+    satellite.PRN = PRN;
+    satellite.CN0_dB_hz = CN0_dB_hz;
+    satellite.subframe_TOW = TOW;
+    satellite.subframe_offset_ms = subframe_offset_ms;
+    return satellite;
+}
+}
+
+
+TEST(SpoofingPeersTest, Datagram)
+{
+    Spoofing_Peer_Summary summary;
+    summary.receiver_id = 17;
+    summary.sequence = 3;
+    summary.satellites.push_back(peer_satellite(5, 45.5, 1000, -70.25));
+    summary.satellites.push_back(peer_satellite(12, 38.0, -1, 0.0));
+    summary.satellites[1].alarm_cases = 1 << 8;
+    std::vector<char> datagram = Spoofing_Peer_Link::encode(summary);
+    EXPECT_EQ(sizeof(Spoofing_Peer_Header) + 2 * sizeof(Spoofing_Peer_Satellite), datagram.size());
+
+    Spoofing_Peer_Summary decoded;
+    ASSERT_TRUE(Spoofing_Peer_Link::decode(datagram.data(), datagram.size(), decoded));
+    EXPECT_EQ(17u, decoded.receiver_id);
+    EXPECT_EQ(3u, decoded.sequence);
+    ASSERT_EQ(2u, decoded.satellites.size());
+    EXPECT_EQ(5, decoded.satellites[0].PRN);
+    EXPECT_FLOAT_EQ(45.5, decoded.satellites[0].CN0_dB_hz);
+    EXPECT_EQ(1000, decoded.satellites[0].subframe_TOW);
+    EXPECT_DOUBLE_EQ(-70.25, decoded.satellites[0].subframe_offset_ms);
+    EXPECT_EQ(1 << 8, decoded.satellites[1].alarm_cases);
+
+    EXPECT_FALSE(Spoofing_Peer_Link::decode(datagram.data(), datagram.size() - 1, decoded));
+    datagram[0] = 'X';
+    EXPECT_FALSE(Spoofing_Peer_Link::decode(datagram.data(), datagram.size(), decoded));
+}
+
+
+TEST(SpoofingPeersTest, Exchange)
+{
+    Spoofing_Peer_Link a(1, 100.0);
+    Spoofing_Peer_Link b(2, 100.0);
+    boost::mutex mutex;
+    std::vector<Spoofing_Peer_Summary> at_a;
+    std::vector<Spoofing_Peer_Summary> at_b;
+    ASSERT_TRUE(a.open("127.0.0.1", 47382, 47381, [&](const Spoofing_Peer_Summary&, const Spoofing_Peer_Summary& peer) {
+        boost::mutex::scoped_lock lock(mutex);
+        at_a.push_back(peer);
+    }));
+    ASSERT_TRUE(b.open("127.0.0.1", 47381, 47382, [&](const Spoofing_Peer_Summary&, const Spoofing_Peer_Summary& peer) {
+        boost::mutex::scoped_lock lock(mutex);
+        at_b.push_back(peer);
+    }));
+    a.update_CN0(7, 44.0);
+    a.update_subframe(7, 600, 80.0);
+    b.update_CN0(9, 40.0);
+    b.update_alarm(9, 3);
+    for (int i = 0; i < 50; i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            boost::mutex::scoped_lock lock(mutex);
+            if (!at_a.empty() && !at_b.empty()) break;
+        }
+    a.close();
+    b.close();
+
+    ASSERT_FALSE(at_a.empty());
+    ASSERT_FALSE(at_b.empty());
+    EXPECT_EQ(2u, at_a[0].receiver_id);
+    ASSERT_EQ(1u, at_a[0].satellites.size());
+    EXPECT_EQ(9, at_a[0].satellites[0].PRN);
+    EXPECT_EQ(1 << 3, at_a[0].satellites[0].alarm_cases);
+    EXPECT_EQ(1u, at_b[0].receiver_id);
+    ASSERT_EQ(1u, at_b[0].satellites.size());
+    EXPECT_EQ(600, at_b[0].satellites[0].subframe_TOW);
+    EXPECT_DOUBLE_EQ(80.0 - 600e3, at_b[0].satellites[0].subframe_offset_ms);
+}
+
+
+TEST(SpoofingPeersTest, CollaborativeChecks)
+{
+    Spoofing_Message msg;
+    std::shared_ptr<Receiver_State> state = std::make_shared<Receiver_State>();
+    Receiver_State_Scope state_scope(state);
+
+    std::shared_ptr<InMemoryConfiguration> config = std::make_shared<InMemoryConfiguration>();
+    config->set_property("Spoofing.peers_window", "3");
+    Spoofing_Detector detector(config.get());
+
+    // the CN0 of every satellite is 3 dB lower at the peer, and PRN 8 arrives 4 ms late here
+    Spoofing_Peer_Summary local;
+    local.receiver_id = 1;
+    Spoofing_Peer_Summary peer;
+    peer.receiver_id = 2;
+    unsigned int prns[5] = {3, 8, 14, 22, 30};
+    for (int i = 0; i < 5; i++)
+        {
+            double CN0 = 40.0 + 2.0 * i;
+            double offset = -70.0 - i;
+            local.satellites.push_back(peer_satellite(prns[i], CN0, 1200, 5000.0 + offset + (prns[i] == 8 ? 4.0 : 0.0)));
+            peer.satellites.push_back(peer_satellite(prns[i], CN0 - 3.0, 1200, -20.0 + offset));
+        }
+    detector.check_peer(local, peer);
+    detector.check_peer(local, peer);
+    // the timing alarm comes at once, the CN0 one once the windows are full
+    ASSERT_TRUE(state->spoofing_queue.try_pop(msg));
+    EXPECT_EQ(9, msg.spoofing_case);
+    ASSERT_EQ(1u, msg.satellites.size());
+    EXPECT_EQ(8u, *msg.satellites.begin());
+    EXPECT_FALSE(state->spoofing_queue.try_pop(msg));
+
+    detector.check_peer(local, peer);
+    ASSERT_TRUE(state->spoofing_queue.try_pop(msg));
+    EXPECT_EQ(9, msg.spoofing_case);
+    EXPECT_EQ(5u, msg.satellites.size());
+}
@@ -0,0 +1,109 @@
+/*!
+ * \file spoofing_replay_test.cc
+ * \brief  This file implements tests for the recording and replay of the
+ * inputs of the spoofing detector
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include "concurrent_map.h"
+#include "correlator_taps.h"
+#include "in_memory_configuration.h"
+#include "receiver_state.h"
+#include "spoofing_detector.h"
+#include "spoofing_replay.h"
+
+
+TEST(SpoofingReplayTest, RoundTrip)
+{
+    std::string filename = "./spoofing_replay_test.dat";
+    Gnss_Synchro synchros[2] = {Gnss_Synchro(), Gnss_Synchro()};
+    synchros[1].Channel_ID = 1;
+    synchros[1].PRN = 5;
+    synchros[1].CN0_dB_hz = 42.0;
+    Gnss_Synchro* in[2] = {&synchros[0], &synchros[1]};
+    Correlator_Taps taps = {5, 1000, gr_complex(1.0, 0.0), gr_complex(2.0, 0.0), gr_complex(1.0, 0.0)};
+    {
+        // the receiver that records
+        std::shared_ptr<Receiver_State> state = std::make_shared<Receiver_State>();
+        Receiver_State_Scope state_scope(state);
+        state->correlator_taps_map.write(1, taps);
+        Spoofing_Replay_Writer writer(filename, 2e6);
+        ASSERT_TRUE(writer.is_open());
+        writer.write_epoch(Channel_List(1, 1), in, 2000);
+        writer.write_position(60.0, 25.0, 30.0, 3000.0);
+        writer.write_satpos(5, 1.0, 1.0, 2.0, 3.0);
+        writer.write_release(5010);
+    }
+
+    std::shared_ptr<Receiver_State> state = std::make_shared<Receiver_State>();
+    Receiver_State_Scope state_scope(state);
+    std::shared_ptr<InMemoryConfiguration> config = std::make_shared<InMemoryConfiguration>();
+    Spoofing_Detector detector(config.get());
+    Spoofing_Replay_Player player(filename);
+    ASSERT_TRUE(player.is_open());
+    EXPECT_DOUBLE_EQ(2e6, player.fs_in());
+
+    ASSERT_TRUE(player.play_next(detector));
+    EXPECT_DOUBLE_EQ(2.0, player.time_s());
+    Correlator_Taps replayed;
+    ASSERT_TRUE(state->correlator_taps_map.read(1, replayed));
+    EXPECT_EQ(5u, replayed.PRN);
+    EXPECT_EQ(gr_complex(2.0, 0.0), replayed.Prompt);
+
+    ASSERT_TRUE(player.play_next(detector));
+    EXPECT_DOUBLE_EQ(3.0, player.time_s());
+    // the records without a time of their own keep the last one
+    ASSERT_TRUE(player.play_next(detector));
+    EXPECT_DOUBLE_EQ(3.0, player.time_s());
+    ASSERT_TRUE(player.play_next(detector));
+    EXPECT_FALSE(player.play_next(detector));
+    EXPECT_EQ(4u, player.records());
+    std::remove(filename.c_str());
+}
+
+
+TEST(SpoofingReplayTest, NotARecording)
+{
+    std::string filename = "./spoofing_replay_test_bad.dat";
+    {
+        std::ofstream file(filename.c_str());
+        file << "not a recording";
+    }
+    Spoofing_Replay_Player player(filename);
+    EXPECT_FALSE(player.is_open());
+    std::shared_ptr<InMemoryConfiguration> config = std::make_shared<InMemoryConfiguration>();
+    Spoofing_Detector detector(config.get());
+    EXPECT_FALSE(player.play_next(detector));
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,114 @@
+/*!
+ * \file spoofing_satpos_test.cc
+ * \brief This file implements tests for the validation of the satellite
+ * positions of each ephemeris in the spoofing detector
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <map>
+#include <memory>
+#include <gtest/gtest.h>
+#include "concurrent_ring_queue.h"
+#include "gps_ephemeris.h"
+#include "receiver_state.h"
+#include "in_memory_configuration.h"
+#include "spoofing_detector.h"
+#include "spoofing_message.h"
+
+
+namespace
+{
+Gps_Ephemeris satpos_test_ephemeris(unsigned int PRN, int IODE)
+{
+    Gps_Ephemeris eph = Gps_Ephemeris();
+    eph.i_satellite_PRN = PRN;
+    eph.d_IODE_SF2 = IODE;
+    eph.d_sqrt_A = 5153.6;
+    eph.d_e_eccentricity = 0.01;
+    eph.d_i_0 = 0.96;
+    eph.d_Toe = 100800.0;
+    eph.d_Toc = 100800.0;
+    return eph;
+}
+}
+
+
+TEST(SpoofingSatposTest, ValidatesEachEphemerisOnce)
+{
+    Spoofing_Message msg;
+    std::shared_ptr<Receiver_State> state = std::make_shared<Receiver_State>();
+    Receiver_State_Scope state_scope(state);
+
+    std::shared_ptr<InMemoryConfiguration> config = std::make_shared<InMemoryConfiguration>();
+    config->set_property("Spoofing.satpos_detection", "true");
+    config->set_property("Spoofing.satpos_max_jump_m", "1000");
+    config->set_property("Spoofing.alarm_min_interval_ms", "0");
+    Spoofing_Detector detector(config.get());
+
+    std::map<int, Gps_Ephemeris> ephemerides;
+    ephemerides[3] = satpos_test_ephemeris(3, 10);
+    ephemerides[7] = satpos_test_ephemeris(7, 20);
+    ephemerides[7].d_OMEGA0 = 2.0;
+    EXPECT_EQ(0, detector.check_ephemeris_satpos(ephemerides, 101000.0, 1000.0));
+    EXPECT_EQ(0, detector.check_ephemeris_satpos(ephemerides, 101001.0, 2000.0));
+    EXPECT_FALSE(state->spoofing_queue.try_pop(msg));
+
+    // an update of the orbit that keeps the satellite where it was
+    ephemerides[3].d_IODE_SF2 = 11;
+    ephemerides[3].d_M_0 += 1e-9;
+    EXPECT_EQ(0, detector.check_ephemeris_satpos(ephemerides, 101002.0, 3000.0));
+    EXPECT_FALSE(state->spoofing_queue.try_pop(msg));
+
+    // one that moves it hundreds of kilometers
+    ephemerides[3].d_IODE_SF2 = 12;
+    ephemerides[3].d_M_0 += 0.01;
+    EXPECT_EQ(1, detector.check_ephemeris_satpos(ephemerides, 101003.0, 4000.0));
+    ASSERT_TRUE(state->spoofing_queue.try_pop(msg));
+    EXPECT_EQ(5, msg.spoofing_case);
+    ASSERT_EQ(1u, msg.satellites.size());
+    EXPECT_EQ(3u, *msg.satellites.begin());
+
+    // the result is kept until the ephemeris changes
+    EXPECT_EQ(1, detector.check_ephemeris_satpos(ephemerides, 101004.0, 5000.0));
+    ASSERT_TRUE(state->spoofing_queue.try_pop(msg));
+    EXPECT_EQ(3u, *msg.satellites.begin());
+
+    // the next one is compared with the last valid ephemeris
+    ephemerides[3].d_IODE_SF2 = 13;
+    ephemerides[3].d_M_0 -= 0.01;
+    EXPECT_EQ(0, detector.check_ephemeris_satpos(ephemerides, 101005.0, 6000.0));
+
+    // not a GPS orbit
+    ephemerides[7].d_IODE_SF2 = 21;
+    ephemerides[7].d_sqrt_A = 0.0;
+    EXPECT_EQ(1, detector.check_ephemeris_satpos(ephemerides, 101006.0, 7000.0));
+    ASSERT_TRUE(state->spoofing_queue.try_pop(msg));
+    EXPECT_EQ(7u, *msg.satellites.begin());
+    EXPECT_FALSE(state->spoofing_queue.try_pop(msg));
+}
@@ -0,0 +1,89 @@
+/*!
+ * \file sqm_monitor_test.cc
+ * \brief  This file implements tests for the signal quality monitoring
+ * accumulator of a tracking channel
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <vector>
+#include <gtest/gtest.h>
+#include "sqm_monitor.h"
+
+
+TEST(SqmMonitorTest, Shifts)
+{
+    Sqm_Monitor disabled;
+    EXPECT_FALSE(disabled.enabled());
+    EXPECT_EQ(0u, disabled.n_taps());
+
+    Sqm_Monitor sqm({0.1, 0.25}, 4, 10);
+    ASSERT_EQ(4u, sqm.n_taps());
+    float shifts[4];
+    sqm.shifts(shifts);
+    EXPECT_FLOAT_EQ(-0.1, shifts[0]);
+    EXPECT_FLOAT_EQ(0.1, shifts[1]);
+    EXPECT_FLOAT_EQ(-0.25, shifts[2]);
+    EXPECT_FLOAT_EQ(0.25, shifts[3]);
+}
+
+
+TEST(SqmMonitorTest, UndistortedPeak)
+{
+    Sqm_Monitor sqm({0.1, 0.25}, 4, 10);
+    sqm.reset(7);
+    // triangular correlation peak, with a bit transition in the middle of the average
+    for (int period = 0; period < 4; period++)
+        {
+            float bit = period < 2 ? 1.0 : -1.0;
+            gr_complex prompt(bit * 100.0, bit * 3.0);
+            gr_complex taps[4] = {bit * gr_complex(90.0, 2.7), bit * gr_complex(90.0, 2.7),
+                                  bit * gr_complex(75.0, 2.25), bit * gr_complex(75.0, 2.25)};
+            EXPECT_EQ(period == 3, sqm.add(prompt, taps, 1000 * period));
+        }
+    const Sqm_Metrics& m = sqm.metrics();
+    EXPECT_EQ(7u, m.PRN);
+    EXPECT_EQ(3000u, m.sample_counter);
+    EXPECT_NEAR(0.9, m.ratio[0], 1e-5);
+    EXPECT_NEAR(0.75, m.ratio[1], 1e-5);
+    EXPECT_NEAR(0.0, m.delta[0], 1e-5);
+    EXPECT_NEAR(0.0, m.asymmetry[1], 1e-5);
+}
+
+
+TEST(SqmMonitorTest, DistortedPeak)
+{
+    Sqm_Monitor sqm({0.5}, 1, 10);
+    sqm.reset(3);
+    gr_complex prompt(100.0, 0.0);
+    gr_complex taps[2] = {gr_complex(40.0, 0.0), gr_complex(60.0, 0.0)};
+    EXPECT_TRUE(sqm.add(prompt, taps, 0));
+    const Sqm_Metrics& m = sqm.metrics();
+    EXPECT_NEAR(0.5, m.ratio[0], 1e-5);
+    EXPECT_NEAR(-0.1, m.delta[0], 1e-5);
+    EXPECT_NEAR(-0.2, m.asymmetry[0], 1e-5);
+}
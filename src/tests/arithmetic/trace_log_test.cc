@@ -0,0 +1,160 @@
+/*!
+ * \file trace_log_test.cc
+ * \brief  This file implements tests for the trace logs and the asynchronous log writer
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <atomic>
+#include <string>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <gtest/gtest.h>
+#include "trace_log.h"
+
+
+namespace
+{
+// Keeps what is written to it, and can hold the writes until released
+class Recording_Logger : public google::base::Logger
+{
+public:
+    Recording_Logger() : flushes(0), held(false), writing(false) {}
+
+    void Write(bool force_flush __attribute__((unused)), time_t timestamp __attribute__((unused)), const char* message, int message_len)
+    {
+        writing = true;
+        while (held)
+            {
+                boost::this_thread::yield();
+            }
+        boost::mutex::scoped_lock lock(mutex);
+        text.append(message, message_len);
+    }
+    void Flush() { flushes++; }
+    google::uint32 LogSize() { return 0; }
+
+    std::string written()
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        return text;
+    }
+
+    std::atomic<int> flushes;
+    std::atomic<bool> held;
+    std::atomic<bool> writing;
+
+private:
+    boost::mutex mutex;
+    std::string text;
+};
+
+int evaluated = 0;
+
+int evaluate()
+{
+    return ++evaluated;
+}
+}
+
+
+TEST(TraceLogTest, Levels)
+{
+    evaluated = 0;
+    EXPECT_FALSE(trace_log_on(TRACE_PVT, 1));
+    TRACE_LOG(TRACE_PVT, 1) << evaluate();
+    EXPECT_EQ(0, evaluated);
+
+    set_trace_log_level(TRACE_PVT, 1);
+    EXPECT_TRUE(trace_log_on(TRACE_PVT, 1));
+    EXPECT_FALSE(trace_log_on(TRACE_PVT, 2));
+    EXPECT_FALSE(trace_log_on(TRACE_SPOOFING, 1));
+    TRACE_LOG(TRACE_PVT, 2) << evaluate();
+#ifndef GNSS_SDR_STRIP_TRACE_LOG
+    EXPECT_EQ(0, evaluated);
+    TRACE_LOG(TRACE_PVT, 1) << evaluate();
+    EXPECT_EQ(1, evaluated);
+#endif
+    set_trace_log_level(TRACE_PVT, 0);
+    EXPECT_STREQ("spoofing", trace_module_name(TRACE_SPOOFING));
+}
+
+
+TEST(TraceLogTest, AsyncWriter)
+{
+    Recording_Logger recording;
+    {
+        Async_Log_Writer writer(&recording, 1024);
+        writer.Write(false, 0, "first\n", 6);
+        writer.Write(false, 0, "second\n", 7);
+        writer.Flush();
+        EXPECT_EQ("first\nsecond\n", recording.written());
+        EXPECT_LE(1, recording.flushes.load());
+        writer.Write(false, 0, "third\n", 6);
+    }
+    // the messages left are written when the writer stops
+    EXPECT_EQ("first\nsecond\nthird\n", recording.written());
+}
+
+
+TEST(TraceLogTest, DropWhenFull)
+{
+    Recording_Logger recording;
+    recording.held = true;
+    Async_Log_Writer writer(&recording, 16);
+    writer.Write(false, 0, "0123456789\n", 11);
+    while (!recording.writing)
+        {
+            boost::this_thread::yield();
+        }
+    // the thread holds the first message, the buffer the next one
+    writer.Write(false, 0, "abcdefghij\n", 11);
+    writer.Write(false, 0, "dropped\n", 8);
+    EXPECT_EQ(1u, writer.dropped());
+    recording.held = false;
+    writer.Flush();
+    EXPECT_EQ("0123456789\nabcdefghij\n", recording.written());
+}
+
+
+TEST(TraceLogTest, StartStop)
+{
+    google::base::Logger* original = google::base::GetLogger(google::GLOG_INFO);
+    Recording_Logger recording;
+    google::base::SetLogger(google::GLOG_INFO, &recording);
+
+    start_async_log(64);
+    google::base::Logger* async = google::base::GetLogger(google::GLOG_INFO);
+    EXPECT_NE(&recording, async);
+    async->Write(false, 0, "message\n", 8);
+    stop_async_log();
+    EXPECT_EQ(&recording, google::base::GetLogger(google::GLOG_INFO));
+    EXPECT_EQ("message\n", recording.written());
+
+    google::base::SetLogger(google::GLOG_INFO, original);
+}
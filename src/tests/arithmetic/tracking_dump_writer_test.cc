@@ -0,0 +1,105 @@
+/*!
+ * \file tracking_dump_writer_test.cc
+ * \brief  This file implements tests for the buffered tracking dump writer
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <gtest/gtest.h>
+#include "dump_reader.h"
+#include "tracking_dump_writer.h"
+
+
+TEST(TrackingDumpWriterTest, WritesEveryRecordInOrder)
+{
+    std::string filename = "./tracking_dump_writer_test.dat";
+    const unsigned int n_records = 2503; // not a multiple of the buffer size
+    {
+        Tracking_Dump_Writer writer(100);
+        ASSERT_TRUE(writer.open(filename));
+        EXPECT_TRUE(writer.is_open());
+        for (unsigned int n = 0; n < n_records; n++)
+            {
+                Tracking_Dump_Record record;
+                std::memset(&record, 0, sizeof(record));
+                record.abs_P = static_cast<float>(n);
+                record.PRN_start_sample = 4000ULL * n;
+                record.CN0_SNV_dB_Hz = 0.5 * n;
+                record.MD = -static_cast<float>(n);
+                writer.write(record);
+            }
+        writer.close();
+        EXPECT_FALSE(writer.is_open());
+    }
+
+    Dump_Reader reader;
+    ASSERT_TRUE(reader.open(filename));
+    ASSERT_EQ(n_records, reader.num_records());
+    ASSERT_EQ(sizeof(Tracking_Dump_Record), reader.schema().record_bytes());
+    for (unsigned int n = 0; n < n_records; n++)
+        {
+            Tracking_Dump_Record record;
+            std::memcpy(&record, reader.record(n), sizeof(record));
+            ASSERT_EQ(static_cast<float>(n), record.abs_P);
+            ASSERT_EQ(4000ULL * n, record.PRN_start_sample);
+            ASSERT_EQ(0.5 * n, record.CN0_SNV_dB_Hz);
+            ASSERT_EQ(-static_cast<float>(n), record.MD);
+        }
+    reader.close();
+    std::remove(filename.c_str());
+}
+
+
+TEST(TrackingDumpWriterTest, RecordKeepsTheDumpLayout)
+{
+    // byte offsets read by the MATLAB tracking dump readers
+    Tracking_Dump_Record record;
+    const char* base = reinterpret_cast<const char*>(&record);
+    EXPECT_EQ(20, reinterpret_cast<const char*>(&record.PRN_start_sample) - base);
+    EXPECT_EQ(28, reinterpret_cast<const char*>(&record.acc_carrier_phase_rad) - base);
+    EXPECT_EQ(108, reinterpret_cast<const char*>(&record.next_PRN_start_sample) - base);
+    EXPECT_EQ(116, reinterpret_cast<const char*>(&record.delta) - base);
+    EXPECT_EQ(132u, sizeof(Tracking_Dump_Record));
+
+    // and the schema in the header of the files
+    Dump_Schema schema = tracking_dump_schema();
+    EXPECT_EQ(sizeof(Tracking_Dump_Record), schema.record_bytes());
+    EXPECT_EQ(20u, schema.fields()[schema.find("PRN_start_sample")].offset);
+    EXPECT_EQ(116u, schema.fields()[schema.find("delta")].offset);
+}
+
+
+TEST(TrackingDumpWriterTest, OpenFailsWithoutThrowing)
+{
+    Tracking_Dump_Writer writer;
+    EXPECT_FALSE(writer.open("./no_such_directory/track_ch0.dat"));
+    EXPECT_FALSE(writer.is_open());
+    writer.close();
+}
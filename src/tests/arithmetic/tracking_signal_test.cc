@@ -0,0 +1,85 @@
+/*!
+ * \file tracking_signal_test.cc
+ * \brief  This file implements tests for the signal traits and the NCO
+ * updates of the DLL/PLL tracking blocks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include "tracking_signal.h"
+
+
+TEST(TrackingSignalTest, TapShifts)
+{
+    float shifts[Galileo_E1_Signal::n_taps];
+    Tracking_Nco<Galileo_E1_Signal>::tap_shifts(0.5, shifts);
+    EXPECT_FLOAT_EQ(-1.0, shifts[0]);
+    EXPECT_FLOAT_EQ(-0.5, shifts[1]);
+    EXPECT_FLOAT_EQ(0.0, shifts[Galileo_E1_Signal::prompt_tap]);
+    EXPECT_FLOAT_EQ(0.5, shifts[3]);
+    EXPECT_FLOAT_EQ(1.0, shifts[4]);
+
+    float epl[Gps_L1_Ca_Signal::n_taps];
+    Tracking_Nco<Gps_L1_Ca_Signal>::tap_shifts(0.5, epl);
+    EXPECT_FLOAT_EQ(-0.5, epl[0]);
+    EXPECT_FLOAT_EQ(0.0, epl[Gps_L1_Ca_Signal::prompt_tap]);
+    EXPECT_FLOAT_EQ(0.5, epl[2]);
+}
+
+
+TEST(TrackingSignalTest, CodePeriod)
+{
+    typedef Tracking_Nco<Gps_L1_Ca_Signal> L1_Ca_Nco;
+    long fs_in = 4000000;
+    EXPECT_DOUBLE_EQ(GPS_L1_CA_CODE_RATE_HZ, L1_Ca_Nco::code_freq_chips(0.0));
+    // the code Doppler is the carrier Doppler scaled by the chip rate
+    EXPECT_NEAR(GPS_L1_CA_CODE_RATE_HZ + 1.0, L1_Ca_Nco::code_freq_chips(1540.0), 1e-9);
+
+    // a period at the nominal rate, plus the remnant and the DLL correction
+    EXPECT_NEAR(4000.0, L1_Ca_Nco::next_period_samples(GPS_L1_CA_CODE_RATE_HZ, 0.0, 0.0, fs_in), 1e-9);
+    EXPECT_NEAR(4000.25 + 2.0, L1_Ca_Nco::next_period_samples(GPS_L1_CA_CODE_RATE_HZ, 0.25, 0.5e-6, fs_in), 1e-9);
+    EXPECT_NEAR(1e-3 * 0.5 / GPS_L1_CA_CODE_RATE_HZ, L1_Ca_Nco::code_error_secs(0.5), 1e-18);
+
+    // the E1 replica is resampled in half chips
+    typedef Tracking_Nco<Galileo_E1_Signal> E1_Nco;
+    EXPECT_DOUBLE_EQ(2.0 * Galileo_E1_CODE_CHIP_RATE_HZ / fs_in, E1_Nco::code_phase_step(Galileo_E1_CODE_CHIP_RATE_HZ, fs_in));
+    EXPECT_DOUBLE_EQ(0.5 * E1_Nco::code_phase_step(Galileo_E1_CODE_CHIP_RATE_HZ, fs_in),
+            E1_Nco::rem_code_phase(0.5, Galileo_E1_CODE_CHIP_RATE_HZ, fs_in));
+    EXPECT_NEAR(16000.0, E1_Nco::next_period_samples(Galileo_E1_CODE_CHIP_RATE_HZ, 0.0, 0.0, fs_in), 1e-9);
+}
+
+
+TEST(TrackingSignalTest, CarrierPhase)
+{
+    typedef Tracking_Nco<Gps_L2_M_Signal> L2_M_Nco;
+    // 25 Hz over a 20 ms code period is half a cycle
+    EXPECT_NEAR(GPS_PI, L2_M_Nco::period_phase_rad(25.0), 1e-9);
+    EXPECT_NEAR(1.0, L2_M_Nco::wrap_phase_rad(1.0 + 2.0 * L2_M_Nco::period_phase_rad(50.0)), 1e-9);
+    EXPECT_NEAR(GPS_TWO_PI * 1000.0 / 4e6, L2_M_Nco::carrier_phase_step_rad(1000.0, 4000000), 1e-15);
+    EXPECT_EQ(100, Galileo_E5a_Signal::secondary_code_length);
+}
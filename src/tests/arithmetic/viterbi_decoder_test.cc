@@ -0,0 +1,214 @@
+/*!
+ * \file viterbi_decoder_test.cc
+ * \brief  This file implements tests and a benchmark for the Viterbi decoder
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <sys/time.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <gtest/gtest.h>
+#include "galileo_fec_decoder.h"
+#include "viterbi_decoder.h"
+
+DEFINE_int32(viterbi_decoder_test_iterations, 1000, "Number of blocks decoded by the Viterbi decoder benchmark");
+
+namespace
+{
+// K=7 rate 1/2 code of Galileo E1B, E5a and SBAS
+const int viterbi_test_KK = 7;
+const int viterbi_test_nn = 2;
+const int viterbi_test_g[2] = {121, 91};
+
+// encodes bits followed by the zero tail, into LLRs of the given amplitude plus noise
+std::vector<double> viterbi_test_encode(const std::vector<int>& bits, double amplitude, double noise)
+{
+    std::vector<double> symbols;
+    int state = 0;
+    for (unsigned int n = 0; n < bits.size() + viterbi_test_KK - 1; n++)
+        {
+            int input = n < bits.size() ? bits[n] : 0;
+            int word = (input << (viterbi_test_KK - 1)) ^ state;
+            for (int i = 0; i < viterbi_test_nn; i++)
+                {
+                    int parity = __builtin_parity(word & viterbi_test_g[i]);
+                    double uniform = static_cast<double>(std::rand()) / RAND_MAX - 0.5;
+                    symbols.push_back((parity ? amplitude : -amplitude) + noise * uniform);
+                }
+            state = word >> 1;
+        }
+    return symbols;
+}
+}
+
+
+TEST(ViterbiDecoderTest, DecodesBlocks)
+{
+    std::srand(1);
+    Viterbi_Decoder decoder(viterbi_test_g, viterbi_test_KK, viterbi_test_nn);
+    const int LL = 240; // a Galileo E1B page
+    std::vector<int> bits(LL);
+    std::vector<int> decoded(LL);
+    for (int block = 0; block < 20; block++)
+        {
+            for (int n = 0; n < LL; n++)
+                {
+                    bits[n] = std::rand() & 1;
+                }
+            std::vector<double> symbols = viterbi_test_encode(bits, 1.0, 2.0);
+            decoder.decode_block(&symbols[0], &decoded[0], LL);
+            ASSERT_EQ(bits, decoded);
+        }
+}
+
+
+TEST(ViterbiDecoderTest, DecodesContinuously)
+{
+    std::srand(2);
+    Viterbi_Decoder decoder(viterbi_test_g, viterbi_test_KK, viterbi_test_nn);
+    const int traceback_depth = 35;
+    const int nbits_requested = 10;
+    const int n_bits = 2000;
+    std::vector<int> bits(n_bits);
+    for (int n = 0; n < n_bits; n++)
+        {
+            bits[n] = std::rand() & 1;
+        }
+    std::vector<double> symbols = viterbi_test_encode(bits, 5.0, 2.0);
+
+    std::vector<int> decoded;
+    std::vector<int> output(nbits_requested + traceback_depth);
+    for (int n = 0; n + nbits_requested <= n_bits; n += nbits_requested)
+        {
+            int nbits_decoded = 0;
+            decoder.decode_continuous(&symbols[viterbi_test_nn * n], traceback_depth, &output[0], nbits_requested, nbits_decoded);
+            decoded.insert(decoded.end(), output.begin(), output.begin() + std::max(nbits_decoded, 0));
+        }
+    // the newest traceback_depth bits stay in the trellis
+    ASSERT_EQ(static_cast<unsigned int>(n_bits - traceback_depth), decoded.size());
+    for (unsigned int n = 0; n < decoded.size(); n++)
+        {
+            ASSERT_EQ(bits[n], decoded[n]);
+        }
+}
+
+
+TEST(ViterbiDecoderTest, BlockBenchmark)
+{
+    std::srand(3);
+    Viterbi_Decoder decoder(viterbi_test_g, viterbi_test_KK, viterbi_test_nn);
+    const int LL = 240;
+    std::vector<int> bits(LL);
+    for (int n = 0; n < LL; n++)
+        {
+            bits[n] = std::rand() & 1;
+        }
+    std::vector<double> symbols = viterbi_test_encode(bits, 1.0, 2.0);
+    std::vector<int> decoded(LL);
+
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    long long int begin = tv.tv_sec * 1000000 + tv.tv_usec;
+    for (int i = 0; i < FLAGS_viterbi_decoder_test_iterations; i++)
+        {
+            decoder.decode_block(&symbols[0], &decoded[0], LL);
+        }
+    gettimeofday(&tv, NULL);
+    long long int end = tv.tv_sec * 1000000 + tv.tv_usec;
+    std::cout << "Viterbi decoding of " << FLAGS_viterbi_decoder_test_iterations << " blocks of " << LL
+              << " bits (K=7, rate 1/2) finished in " << (end - begin) << " microseconds" << std::endl;
+    ASSERT_LE(0, end - begin);
+    ASSERT_EQ(bits, decoded);
+}
+
+
+TEST(ViterbiDecoderTest, DeinterleavesGalileoPages)
+{
+    // F/NAV page (8 x 61) and a block without SSE2 path (3 x 7)
+    const int shapes[2][2] = {{8, 61}, {3, 7}};
+    for (int s = 0; s < 2; s++)
+        {
+            int rows = shapes[s][0];
+            int cols = shapes[s][1];
+            std::vector<float> in(rows * cols);
+            for (int n = 0; n < rows * cols; n++)
+                {
+                    in[n] = static_cast<float>(n + 1);
+                }
+            std::vector<float> out(rows * cols);
+            Galileo_Fec_Decoder::deinterleave(rows, cols, &in[0], &out[0]);
+            for (int r = 0; r < rows; r++)
+                {
+                    for (int c = 0; c < cols; c++)
+                        {
+                            int n = c * rows + r;
+                            ASSERT_EQ((n % 2) ? -in[r * cols + c] : in[r * cols + c], out[n]);
+                        }
+                }
+        }
+}
+
+
+TEST(ViterbiDecoderTest, DecodesGalileoPages)
+{
+    std::srand(4);
+    // I/NAV page part: 114 bits and the zero tail, interleaved in 8 x 30 symbols
+    const int rows = 8;
+    const int cols = 30;
+    Galileo_Fec_Decoder decoder(rows, cols);
+    ASSERT_EQ(rows * cols, decoder.symbols());
+    const int LL = rows * cols / viterbi_test_nn - (viterbi_test_KK - 1);
+    std::vector<int> bits(LL);
+    for (int page = 0; page < 10; page++)
+        {
+            for (int n = 0; n < LL; n++)
+                {
+                    bits[n] = std::rand() & 1;
+                }
+            std::vector<double> coded = viterbi_test_encode(bits, 1.0, 2.0);
+            // NOT gate of G2, then the block interleaver
+            std::vector<float> symbols(rows * cols);
+            for (int r = 0; r < rows; r++)
+                {
+                    for (int c = 0; c < cols; c++)
+                        {
+                            int n = c * rows + r;
+                            symbols[r * cols + c] = static_cast<float>((n % 2) ? -coded[n] : coded[n]);
+                        }
+                }
+            std::vector<int> decoded(rows * cols / viterbi_test_nn, -1);
+            decoder.decode(&symbols[0], &decoded[0]);
+            ASSERT_EQ(bits, std::vector<int>(decoded.begin(), decoded.begin() + LL));
+            for (int n = LL; n < rows * cols / viterbi_test_nn; n++)
+                {
+                    ASSERT_EQ(0, decoded[n]);
+                }
+        }
+}
@@ -0,0 +1,453 @@
+/*!
+ * \file hot_path_benchmark.cc
+ * \brief Benchmark of the per-epoch costs of the receiver stages
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * Times one acquisition dwell of each PCPS search, one tracking epoch for
+ * each number of correlator taps, the Viterbi decoding of Galileo pages,
+ * one least squares PVT epoch and each per-epoch spoofing check, for every
+ * sample rate and number of channels given by the flags. The results are
+ * printed, and written as JSON to --hot_path_json if it is set, to compare
+ * builds and machines.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <armadillo>
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+#include <gnuradio/fft/fft.h>
+#include <volk/volk.h>
+#include "acquisition_cache.h"
+#include "concurrent_map.h"
+#include "correlator_taps.h"
+#include "cpu_multicorrelator.h"
+#include "frequency_domain_doppler.h"
+#include "gnss_synchro.h"
+#include "gps_sdr_signal_processing.h"
+#include "in_memory_configuration.h"
+#include "ls_pvt.h"
+#include "narrow_code_search.h"
+#include "spoofing_detector.h"
+#include "viterbi_decoder.h"
+
+DEFINE_string(hot_path_sample_rates, "2048000,4096000,8192000", "Comma separated sample rates of the benchmark [Hz]");
+DEFINE_string(hot_path_channels, "4,8,12", "Comma separated numbers of channels of the benchmark");
+DEFINE_string(hot_path_taps, "3,5,7", "Comma separated numbers of correlator taps of the tracking benchmark");
+DEFINE_int32(hot_path_iterations, 20, "Timed repetitions of each stage");
+DEFINE_string(hot_path_json, "", "If set, file the benchmark results are written to as JSON");
+
+namespace
+{
+struct Hot_Path_Result
+{
+    std::string stage;
+    std::string variant;
+    long fs_in;          // 0 if the stage does not depend on it
+    unsigned int channels;
+    unsigned int taps;   // 0 if the stage has no correlator taps
+    unsigned int iterations;
+    double mean_us;
+    double min_us;
+};
+
+std::vector<Hot_Path_Result> hot_path_results;
+
+
+std::vector<long> hot_path_parse_list(const std::string& list)
+{
+    std::vector<long> values;
+    std::stringstream list_stream(list);
+    std::string value;
+    while (std::getline(list_stream, value, ','))
+        {
+            long v = std::atol(value.c_str());
+            if (v > 0) values.push_back(v);
+        }
+    return values;
+}
+
+
+// Runs body once untimed, then FLAGS_hot_path_iterations times, and records the times
+template<typename Body>
+void hot_path_time(const std::string& stage, const std::string& variant, long fs_in,
+        unsigned int channels, unsigned int taps, Body body)
+{
+    body();
+    unsigned int iterations = std::max(FLAGS_hot_path_iterations, 1);
+    double total_us = 0.0;
+    double min_us = std::numeric_limits<double>::max();
+    for (unsigned int i = 0; i < iterations; i++)
+        {
+            std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+            body();
+            std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+            double us = std::chrono::duration<double, std::micro>(end - begin).count();
+            total_us += us;
+            min_us = std::min(min_us, us);
+        }
+    Hot_Path_Result result = {stage, variant, fs_in, channels, taps, iterations, total_us / iterations, min_us};
+    hot_path_results.push_back(result);
+    std::cout << stage << " " << variant << " fs_in=" << fs_in << " channels=" << channels
+              << " taps=" << taps << ": mean " << result.mean_us << " us, min " << min_us << " us" << std::endl;
+}
+
+
+class HotPathBenchmarkEnvironment: public ::testing::Environment
+{
+public:
+    void TearDown()
+    {
+        if (FLAGS_hot_path_json.empty()) return;
+        std::ofstream json_file(FLAGS_hot_path_json.c_str());
+        json_file << "{" << std::endl;
+        json_file << " \"results\": [" << std::endl;
+        for (unsigned int i = 0; i < hot_path_results.size(); i++)
+            {
+                const Hot_Path_Result& result = hot_path_results[i];
+                json_file << "  {" << std::endl;
+                json_file << "   \"stage\": \"" << result.stage << "\"," << std::endl;
+                json_file << "   \"variant\": \"" << result.variant << "\"," << std::endl;
+                json_file << "   \"fs_in\": " << result.fs_in << "," << std::endl;
+                json_file << "   \"channels\": " << result.channels << "," << std::endl;
+                json_file << "   \"taps\": " << result.taps << "," << std::endl;
+                json_file << "   \"iterations\": " << result.iterations << "," << std::endl;
+                json_file << "   \"mean_us\": " << result.mean_us << "," << std::endl;
+                json_file << "   \"min_us\": " << result.min_us << std::endl;
+                json_file << "  }" << (i + 1 < hot_path_results.size() ? "," : "") << std::endl;
+            }
+        json_file << " ]" << std::endl;
+        json_file << "}" << std::endl;
+    }
+};
+
+::testing::Environment* const hot_path_environment = ::testing::AddGlobalTestEnvironment(new HotPathBenchmarkEnvironment);
+
+
+// length samples of GPS L1 C/A PRN 1 with a code delay and a Doppler shift, plus noise
+std::vector<gr_complex> hot_path_signal(long fs_in, unsigned int length)
+{
+    unsigned int period = fs_in / 1000;
+    std::vector<gr_complex> code(period);
+    gps_l1_ca_code_gen_complex_sampled(&code[0], 1, fs_in, 0);
+    std::vector<gr_complex> signal(length);
+    std::srand(1);
+    for (unsigned int n = 0; n < length; n++)
+        {
+            double phase = 2.0 * M_PI * 1750.0 * n / static_cast<double>(fs_in);
+            gr_complex noise(static_cast<float>(std::rand()) / RAND_MAX - 0.5, static_cast<float>(std::rand()) / RAND_MAX - 0.5);
+            signal[n] = code[(n + period - period / 3) % period] * gr_complex(std::cos(phase), std::sin(phase)) + 4.0f * noise;
+        }
+    return signal;
+}
+}
+
+
+TEST(HotPathBenchmark, AcquisitionDwell)
+{
+    const unsigned int doppler_max = 5000;
+    const unsigned int doppler_step = 500;
+    const unsigned int num_doppler_bins = 2 * doppler_max / doppler_step + 1;
+    std::vector<long> rates = hot_path_parse_list(FLAGS_hot_path_sample_rates);
+    std::vector<long> channel_counts = hot_path_parse_list(FLAGS_hot_path_channels);
+    for (unsigned int r = 0; r < rates.size(); r++)
+        {
+            long fs_in = rates[r];
+            unsigned int fft_size = fs_in / 1000;
+            std::vector<gr_complex> in = hot_path_signal(fs_in, fft_size);
+            std::vector<float> magnitude(fft_size);
+            gr::fft::fft_complex fft(fft_size, true);
+            gr::fft::fft_complex ifft(fft_size, false);
+            std::shared_ptr<const Doppler_Wipeoff_Grid> grid = Acquisition_Cache::doppler_wipeoff_grid(fs_in, 0,
+                    doppler_max, doppler_step, num_doppler_bins, fft_size);
+            Frequency_Domain_Doppler fd_doppler(fs_in, 0, doppler_max, doppler_step, num_doppler_bins, fft_size);
+
+            // every channel searches its own satellite in the same dwell
+            unsigned int max_channels = *std::max_element(channel_counts.begin(), channel_counts.end());
+            std::vector<std::shared_ptr<const Code_Fft> > code_ffts;
+            std::vector<std::shared_ptr<Narrow_Code_Search> > narrow_searches;
+            std::vector<gr_complex> code(fft_size);
+            for (unsigned int ch = 0; ch < max_channels; ch++)
+                {
+                    unsigned int PRN = ch % 32 + 1;
+                    gps_l1_ca_code_gen_complex_sampled(fft.get_inbuf(), PRN, fs_in, 0);
+                    std::copy(fft.get_inbuf(), fft.get_inbuf() + fft_size, code.begin());
+                    code_ffts.push_back(Acquisition_Cache::code_fft('G', "1C", PRN, &fft));
+                    narrow_searches.push_back(std::make_shared<Narrow_Code_Search>(fs_in, fft_size));
+                    narrow_searches.back()->set_local_code(&code[0]);
+                }
+            // a window of +-2 chips, as in a reacquisition
+            unsigned int narrow_lags = 2 * static_cast<unsigned int>(std::ceil(2.0 * fs_in / 1.023e6)) + 1;
+
+            for (unsigned int c = 0; c < channel_counts.size(); c++)
+                {
+                    unsigned int channels = channel_counts[c];
+                    float max_magnitude = 0.0;
+                    hot_path_time("acquisition_dwell", "pcps", fs_in, channels, 0, [&]()
+                            {
+                                for (unsigned int ch = 0; ch < channels; ch++)
+                                    {
+                                        for (unsigned int b = 0; b < num_doppler_bins; b++)
+                                            {
+                                                volk_32fc_x2_multiply_32fc(fft.get_inbuf(), &in[0], grid->wipeoffs()[b], fft_size);
+                                                fft.execute();
+                                                volk_32fc_x2_multiply_32fc(ifft.get_inbuf(), fft.get_outbuf(), code_ffts[ch]->get(), fft_size);
+                                                ifft.execute();
+                                                volk_32fc_magnitude_squared_32f(&magnitude[0], ifft.get_outbuf(), fft_size);
+                                                max_magnitude = std::max(max_magnitude, *std::max_element(magnitude.begin(), magnitude.end()));
+                                            }
+                                    }
+                            });
+                    hot_path_time("acquisition_dwell", "frequency_domain_doppler", fs_in, channels, 0, [&]()
+                            {
+                                fd_doppler.set_input(&in[0], &fft);
+                                for (unsigned int ch = 0; ch < channels; ch++)
+                                    {
+                                        for (unsigned int b = 0; b < num_doppler_bins; b++)
+                                            {
+                                                fd_doppler.multiply_code(b, code_ffts[ch]->get(), ifft.get_inbuf());
+                                                ifft.execute();
+                                                volk_32fc_magnitude_squared_32f(&magnitude[0], ifft.get_outbuf(), fft_size);
+                                                max_magnitude = std::max(max_magnitude, *std::max_element(magnitude.begin(), magnitude.end()));
+                                            }
+                                    }
+                            });
+                    hot_path_time("acquisition_dwell", "narrow_code_search", fs_in, channels, 0, [&]()
+                            {
+                                for (unsigned int ch = 0; ch < channels; ch++)
+                                    {
+                                        narrow_searches[ch]->set_input(&in[0]);
+                                        for (unsigned int b = 0; b < num_doppler_bins; b++)
+                                            {
+                                                double doppler = -static_cast<double>(doppler_max) + doppler_step * b;
+                                                narrow_searches[ch]->search(doppler, fft_size / 3, narrow_lags, &magnitude[0]);
+                                                max_magnitude = std::max(max_magnitude, *std::max_element(&magnitude[fft_size / 3], &magnitude[fft_size / 3] + narrow_lags));
+                                            }
+                                    }
+                            });
+                    EXPECT_LT(0.0, max_magnitude);
+                }
+        }
+}
+
+
+TEST(HotPathBenchmark, TrackingEpoch)
+{
+    std::vector<long> rates = hot_path_parse_list(FLAGS_hot_path_sample_rates);
+    std::vector<long> channel_counts = hot_path_parse_list(FLAGS_hot_path_channels);
+    std::vector<long> tap_counts = hot_path_parse_list(FLAGS_hot_path_taps);
+    unsigned int max_channels = *std::max_element(channel_counts.begin(), channel_counts.end());
+    std::vector<gr_complex*> codes(max_channels);
+    for (unsigned int ch = 0; ch < max_channels; ch++)
+        {
+            codes[ch] = static_cast<gr_complex*>(volk_malloc(1023 * sizeof(gr_complex), volk_get_alignment()));
+            gps_l1_ca_code_gen_complex(codes[ch], ch % 32 + 1, 0);
+        }
+    for (unsigned int r = 0; r < rates.size(); r++)
+        {
+            long fs_in = rates[r];
+            int length = fs_in / 1000;
+            std::vector<gr_complex> in = hot_path_signal(fs_in, 2 * length);
+            float code_phase_step_chips = 1.023e6 / static_cast<float>(fs_in);
+            float phase_step_rad = 2.0 * M_PI * 1750.0 / static_cast<float>(fs_in);
+            for (unsigned int t = 0; t < tap_counts.size(); t++)
+                {
+                    int taps = tap_counts[t];
+                    // equally spaced by half a chip around the prompt
+                    std::vector<float> shifts(taps);
+                    for (int i = 0; i < taps; i++)
+                        {
+                            shifts[i] = 0.5 * (i - taps / 2);
+                        }
+                    std::vector<std::shared_ptr<cpu_multicorrelator> > correlators(max_channels);
+                    std::vector<gr_complex> corr_out(max_channels * taps);
+                    for (unsigned int ch = 0; ch < max_channels; ch++)
+                        {
+                            correlators[ch] = std::make_shared<cpu_multicorrelator>();
+                            correlators[ch]->init(2 * length, taps);
+                            correlators[ch]->set_local_code_and_taps(1023, codes[ch], &shifts[0]);
+                            correlators[ch]->set_input_output_vectors(&corr_out[ch * taps], &in[0]);
+                        }
+                    for (unsigned int c = 0; c < channel_counts.size(); c++)
+                        {
+                            unsigned int channels = channel_counts[c];
+                            hot_path_time("tracking_epoch", "cpu_multicorrelator", fs_in, channels, taps, [&]()
+                                    {
+                                        for (unsigned int ch = 0; ch < channels; ch++)
+                                            {
+                                                correlators[ch]->Carrier_wipeoff_multicorrelator_resampler(0.1 * ch, phase_step_rad,
+                                                        0.01 * ch, code_phase_step_chips, length);
+                                            }
+                                    });
+                        }
+                }
+        }
+    for (unsigned int ch = 0; ch < max_channels; ch++)
+        {
+            volk_free(codes[ch]);
+        }
+}
+
+
+TEST(HotPathBenchmark, ViterbiGalileoPage)
+{
+    // K=7 rate 1/2 code of the Galileo E1B pages, 240 bits each
+    const int g[2] = {121, 91};
+    const int LL = 240;
+    Viterbi_Decoder decoder(g, 7, 2);
+    std::vector<double> symbols(2 * (LL + 6));
+    std::srand(2);
+    for (unsigned int i = 0; i < symbols.size(); i++)
+        {
+            symbols[i] = (std::rand() & 1 ? 1.0 : -1.0) + static_cast<double>(std::rand()) / RAND_MAX - 0.5;
+        }
+    std::vector<int> decoded(LL);
+    std::vector<long> channel_counts = hot_path_parse_list(FLAGS_hot_path_channels);
+    for (unsigned int c = 0; c < channel_counts.size(); c++)
+        {
+            unsigned int channels = channel_counts[c];
+            hot_path_time("viterbi", "galileo_e1b_page", 0, channels, 0, [&]()
+                    {
+                        for (unsigned int ch = 0; ch < channels; ch++)
+                            {
+                                decoder.decode_block(&symbols[0], &decoded[0], LL);
+                            }
+                    });
+        }
+}
+
+
+TEST(HotPathBenchmark, LeastSquaresPvtEpoch)
+{
+    const double earth_radius_m = 6378137.0;
+    const double orbit_radius_m = 26560e3;
+    arma::vec rx_pos(3);
+    rx_pos(0) = earth_radius_m * std::cos(0.72) * std::cos(0.03);
+    rx_pos(1) = earth_radius_m * std::cos(0.72) * std::sin(0.03);
+    rx_pos(2) = earth_radius_m * std::sin(0.72);
+    std::vector<long> channel_counts = hot_path_parse_list(FLAGS_hot_path_channels);
+    for (unsigned int c = 0; c < channel_counts.size(); c++)
+        {
+            unsigned int channels = channel_counts[c];
+            arma::mat satpos = arma::zeros(3, channels);
+            arma::vec obs = arma::zeros(channels);
+            arma::mat W = arma::eye(channels, channels);
+            // satellites spread over the sky above the receiver
+            for (unsigned int i = 0; i < channels; i++)
+                {
+                    double lat = 0.72 + 0.6 * std::sin(2.0 * M_PI * i / channels);
+                    double lon = 0.03 + 0.6 * std::cos(2.0 * M_PI * i / channels);
+                    satpos(0, i) = orbit_radius_m * std::cos(lat) * std::cos(lon);
+                    satpos(1, i) = orbit_radius_m * std::cos(lat) * std::sin(lon);
+                    satpos(2, i) = orbit_radius_m * std::sin(lat);
+                    obs(i) = arma::norm(satpos.col(i) - rx_pos) + 1234.5;
+                }
+            Ls_Pvt ls_pvt;
+            arma::vec pos;
+            hot_path_time("pvt_epoch", "least_squares", 0, channels, 0, [&]()
+                    {
+                        pos = ls_pvt.leastSquarePos(satpos, obs, W);
+                    });
+            EXPECT_EQ(4u, pos.n_elem);
+        }
+}
+
+
+TEST(HotPathBenchmark, SpoofingChecks)
+{
+    std::shared_ptr<InMemoryConfiguration> config = std::make_shared<InMemoryConfiguration>();
+    config->set_property("Spoofing.PPE", "true");
+    config->set_property("Spoofing.RAIM", "true");
+    Spoofing_Detector detector(config.get());
+
+    std::vector<long> channel_counts = hot_path_parse_list(FLAGS_hot_path_channels);
+    unsigned int max_channels = *std::max_element(channel_counts.begin(), channel_counts.end());
+    std::vector<Gnss_Synchro> synchros(max_channels);
+    std::vector<Gnss_Synchro*> in(max_channels);
+    for (unsigned int ch = 0; ch < max_channels; ch++)
+        {
+            synchros[ch].Channel_ID = ch;
+            synchros[ch].PRN = ch + 1;
+            synchros[ch].CN0_dB_hz = 40.0 + ch % 5;
+            in[ch] = &synchros[ch];
+            Correlator_Taps taps;
+            taps.PRN = ch + 1;
+            taps.sample_counter = 0;
+            taps.Early = gr_complex(0.5, 0.01);
+            taps.Prompt = gr_complex(1.0, 0.02);
+            taps.Late = gr_complex(0.49, 0.01);
+            detector.state()->correlator_taps_map.write(ch, taps);
+        }
+    int sample_counter = 0;
+    for (unsigned int c = 0; c < channel_counts.size(); c++)
+        {
+            unsigned int channels = channel_counts[c];
+            Channel_List channel_list;
+            std::vector<unsigned int> prn;
+            for (unsigned int ch = 0; ch < channels; ch++)
+                {
+                    channel_list.push_back(ch);
+                    prn.push_back(ch + 1);
+                }
+            // consistent residuals: the check runs to the chi-square test
+            std::vector<double> subset_ssr(channels, 10.0);
+            hot_path_time("spoofing_check", "PPE_moving_var", 0, channels, 0, [&]()
+                    {
+                        detector.PPE_moving_var(channel_list, &in[0], sample_counter++);
+                    });
+            hot_path_time("spoofing_check", "check_SNR", 0, channels, 0, [&]()
+                    {
+                        detector.check_SNR(channel_list, &in[0], sample_counter++);
+                    });
+            hot_path_time("spoofing_check", "check_residuals", 0, channels, 0, [&]()
+                    {
+                        detector.check_residuals(prn, channels, 12.0, subset_ssr, sample_counter++);
+                    });
+            hot_path_time("spoofing_check", "check_satpos", 0, channels, 0, [&]()
+                    {
+                        for (unsigned int ch = 0; ch < channels; ch++)
+                            {
+                                detector.check_satpos(ch + 1, sample_counter, 0.0, 0.0, 0.0);
+                            }
+                    });
+        }
+    for (unsigned int ch = 0; ch < max_channels; ch++)
+        {
+            detector.state()->correlator_taps_map.remove(ch);
+        }
+}
@@ -0,0 +1,583 @@
+/*!
+ * \file receiver_benchmark.cc
+ * \brief Throughput benchmark of the whole receiver
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * Runs the receiver, unthrottled, on the signal samples of the tests and
+ * on a synthetic GPS L1 C/A signal, for every number of channels and set
+ * of spoofing checks given by the flags. Each run is a child process, as
+ * in the batch replay, so that it starts from a clean state and its peak
+ * memory is its own. For each run it reports the samples processed per
+ * second and the real-time factor, the CPU time of the process and of each
+ * stage (from the block metrics), the peak resident memory and the time to
+ * the first fix. The results are printed and written to
+ * --benchmark_output_dir/results.json.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+#include <boost/thread/thread.hpp>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gnuradio/top_block.h>
+#include <gnuradio/msg_queue.h>
+#include <gnuradio/blocks/head.h>
+#include <gnuradio/blocks/file_sink.h>
+#include "block_metrics.h"
+#include "control_thread.h"
+#include "concurrent_queue.h"
+#include "concurrent_ring_queue.h"
+#include "concurrent_map.h"
+#include "concurrent_snapshot_map.h"
+#include "concurrent_subframe_map.h"
+#include "navigation_data_bus.h"
+#include "file_configuration.h"
+#include "in_memory_configuration.h"
+#include "fir_filter.h"
+#include "gen_signal_source.h"
+#include "gnss_block_factory.h"
+#include "gnss_sdr_valve.h"
+#include "pvt_log.h"
+#include "signal_generator.h"
+#include "gnss_synchro.h"
+#include "gps_ephemeris.h"
+#include "gps_acq_assist.h"
+#include "gps_ref_location.h"
+#include "gps_ref_time.h"
+#include "spoofing_message.h"
+#include "vector_tracking_aid.h"
+#include "correlator_taps.h"
+#include "sqm_metrics.h"
+#include "aoa_metrics.h"
+
+DEFINE_string(benchmark_config, "", "Receiver configuration to benchmark, a GPS L1 C/A receiver with the spoofing detection blocks if empty");
+DEFINE_string(benchmark_samples_dir, TEST_PATH "signal_samples", "Directory of the gr_complex signal files at 4 Msps to benchmark, none if empty");
+DEFINE_int32(benchmark_synthetic_satellites, 6, "Satellites of the synthetic GPS L1 C/A signal, 0 for no synthetic signal");
+DEFINE_double(benchmark_seconds, 2.0, "Seconds of signal processed by every run, the files are repeated as needed");
+DEFINE_string(benchmark_channels, "4,8", "Comma separated numbers of GPS L1 C/A channels of the runs");
+DEFINE_string(benchmark_spoofing, "off,APT,PPE,APT+PPE", "Comma separated spoofing checks of the runs");
+DEFINE_string(benchmark_scenarios, "", "Comma separated configurations of synthetic spoofing scenarios, generated while the receiver runs");
+DEFINE_string(benchmark_scenario_checks, "APT,PPE,NAVI_TOW,NAVI_inter_satellite,SQM,Doppler,RAIM", "Comma separated Spoofing.* checks, each enabled alone in a run of every scenario");
+DEFINE_string(benchmark_output_dir, "./receiver_benchmark", "Directory of the outputs of every run and of results.json");
+
+DECLARE_string(log_dir);
+
+namespace
+{
+    const double benchmark_fs_hz = 4e6;
+
+    struct Benchmark_Run
+    {
+        std::string input;    // name of the signal
+        std::string filename;
+        unsigned int channels;
+        std::string spoofing; // as in --benchmark_spoofing, or the check of a scenario
+        bool scenario;        // filename is the configuration of a scenario
+    };
+
+    std::vector<std::string> split_list(const std::string & list)
+    {
+        std::vector<std::string> items;
+        std::stringstream list_stream(list);
+        std::string item;
+        while (std::getline(list_stream, item, ','))
+            {
+                if (!item.empty()) items.push_back(item);
+            }
+        return items;
+    }
+
+    typedef std::vector<std::pair<std::string, std::string> > Property_List;
+
+    // A GPS L1 C/A receiver with the spoofing detection blocks
+    const Property_List & receiver_properties()
+    {
+        static const Property_List properties = {
+            {"Channels.in_acquisition", "1"},
+            {"Channels_1B.count", "0"},
+            {"Acquisition_1C.implementation", "GPS_L1_CA_PCPS_SD_Acquisition"},
+            {"Acquisition_1C.item_type", "gr_complex"},
+            {"Acquisition_1C.threshold", "0.005"},
+            {"Acquisition_1C.doppler_max", "10000"},
+            {"Acquisition_1C.doppler_step", "500"},
+            {"Acquisition_1C.max_dwells", "5"},
+            {"Tracking_1C.implementation", "GPS_L1_CA_DLL_PLL_Tracking"},
+            {"Tracking_1C.item_type", "gr_complex"},
+            {"Tracking_1C.pll_bw_hz", "45.0"},
+            {"Tracking_1C.dll_bw_hz", "3.0"},
+            {"TelemetryDecoder_1C.implementation", "GPS_L1_CA_SD_Telemetry_Decoder"},
+            {"Observables.implementation", "GPS_L1_CA_Observables"},
+            {"PVT.implementation", "GPS_L1_CA_SD_PVT"},
+            {"PVT.output_rate_ms", "10"},
+            {"PVT.display_rate_ms", "500"},
+            {"Spoofing.NAVI_TOW", "true"},
+            {"Spoofing.NAVI_inter_satellite", "true"}
+        };
+        return properties;
+    }
+
+    // The filter of the synthetic signals, of a band of 0.97 of the sampling frequency
+    const Property_List & generator_filter_properties()
+    {
+        static const Property_List properties = {
+            {"InputFilter.implementation", "Fir_Filter"},
+            {"InputFilter.input_item_type", "gr_complex"},
+            {"InputFilter.output_item_type", "gr_complex"},
+            {"InputFilter.taps_item_type", "float"},
+            {"InputFilter.number_of_taps", "11"},
+            {"InputFilter.number_of_bands", "2"},
+            {"InputFilter.band1_begin", "0.0"},
+            {"InputFilter.band1_end", "0.97"},
+            {"InputFilter.band2_begin", "0.98"},
+            {"InputFilter.band2_end", "1.0"},
+            {"InputFilter.ampl1_begin", "1.0"},
+            {"InputFilter.ampl1_end", "1.0"},
+            {"InputFilter.ampl2_begin", "0.0"},
+            {"InputFilter.ampl2_end", "0.0"},
+            {"InputFilter.band1_error", "1.0"},
+            {"InputFilter.band2_error", "1.0"},
+            {"InputFilter.filter_type", "bandpass"},
+            {"InputFilter.grid_density", "16"}
+        };
+        return properties;
+    }
+
+    // Sets the properties that configuration does not have
+    void set_missing_properties(ConfigurationInterface* configuration, const Property_List & properties)
+    {
+        for (unsigned int i = 0; i < properties.size(); i++)
+            {
+                if (configuration->property(properties[i].first, std::string("")).empty())
+                    {
+                        configuration->set_property(properties[i].first, properties[i].second);
+                    }
+            }
+    }
+
+    std::shared_ptr<ConfigurationInterface> base_configuration()
+    {
+        if (!FLAGS_benchmark_config.empty())
+            {
+                return std::make_shared<FileConfiguration>(FLAGS_benchmark_config);
+            }
+        std::shared_ptr<InMemoryConfiguration> config = std::make_shared<InMemoryConfiguration>();
+        set_missing_properties(config.get(), receiver_properties());
+        return config;
+    }
+
+
+    /*
+     * The synthetic signal of a scenario, generated while the receiver runs
+     * and stopped after <role>.samples samples. The generator reads the
+     * SignalSource.* properties, and its filter the InputFilter.* ones.
+     */
+    class Scenario_Signal_Source : public GNSSBlockInterface
+    {
+    public:
+        explicit Scenario_Signal_Source(const GNSSBlockFactory::Block_Args & args) :
+            role_(args.role),
+            source_(new SignalGenerator(args.configuration, args.role, 0, 1, args.queue),
+                    new FirFilter(args.configuration, "InputFilter", 1, 1), args.role, args.queue)
+        {
+            unsigned long long samples = args.configuration->property(args.role + ".samples", 0L);
+            valve_ = gnss_sdr_make_valve(sizeof(gr_complex), samples, args.queue);
+        }
+
+        std::string role() { return role_; }
+        std::string implementation() { return "Signal_Generator"; }
+        size_t item_size() { return sizeof(gr_complex); }
+
+        void connect(gr::top_block_sptr top_block)
+        {
+            source_.connect(top_block);
+            top_block->connect(source_.get_right_block(), 0, valve_, 0);
+        }
+
+        void disconnect(gr::top_block_sptr top_block)
+        {
+            top_block->disconnect(source_.get_right_block(), 0, valve_, 0);
+            source_.disconnect(top_block);
+        }
+
+        gr::basic_block_sptr get_left_block() { return gr::basic_block_sptr(); }
+        gr::basic_block_sptr get_right_block() { return valve_; }
+
+    private:
+        std::string role_;
+        GenSignalSource source_;
+        boost::shared_ptr<gr::block> valve_;
+    };
+
+    Block_Registrar scenario_source_registrar("Signal_Generator", [](const GNSSBlockFactory::Block_Args & args)
+            {
+                return std::unique_ptr<GNSSBlockInterface>(new Scenario_Signal_Source(args));
+            });
+
+    // Writes one second of a synthetic GPS L1 C/A signal at benchmark_fs_hz, with noise and data bits
+    bool generate_synthetic_signal(const std::string & filename)
+    {
+        std::shared_ptr<InMemoryConfiguration> config = std::make_shared<InMemoryConfiguration>();
+        config->set_property("SignalSource.fs_hz", std::to_string(static_cast<long>(benchmark_fs_hz)));
+        config->set_property("SignalSource.item_type", "gr_complex");
+        config->set_property("SignalSource.num_satellites", std::to_string(FLAGS_benchmark_synthetic_satellites));
+        for (int i = 0; i < FLAGS_benchmark_synthetic_satellites; i++)
+            {
+                std::string sat = std::to_string(i);
+                config->set_property("SignalSource.system_" + sat, "G");
+                config->set_property("SignalSource.PRN_" + sat, std::to_string(1 + 3 * i));
+                config->set_property("SignalSource.CN0_dB_" + sat, std::to_string(42 + i % 5));
+                config->set_property("SignalSource.doppler_Hz_" + sat, std::to_string(-3000 + 1100 * i));
+                config->set_property("SignalSource.delay_chips_" + sat, std::to_string((150 * i) % 1023));
+            }
+        config->set_property("SignalSource.noise_flag", "true");
+        config->set_property("SignalSource.data_flag", "true");
+        config->set_property("SignalSource.BW_BB", "0.97");
+        set_missing_properties(config.get(), generator_filter_properties());
+        try
+        {
+                gr::msg_queue::sptr queue = gr::msg_queue::make(0);
+                gr::top_block_sptr top_block = gr::make_top_block("Synthetic signal");
+                SignalGenerator* signal_generator = new SignalGenerator(config.get(), "SignalSource", 0, 1, queue);
+                FirFilter* filter = new FirFilter(config.get(), "InputFilter", 1, 1);
+                std::shared_ptr<GenSignalSource> signal_source = std::make_shared<GenSignalSource>(signal_generator, filter, "SignalSource", queue);
+                gr::blocks::head::sptr head = gr::blocks::head::make(sizeof(gr_complex), static_cast<unsigned long long>(benchmark_fs_hz));
+                gr::blocks::file_sink::sptr sink = gr::blocks::file_sink::make(sizeof(gr_complex), filename.c_str());
+                signal_source->connect(top_block);
+                top_block->connect(signal_source->get_right_block(), 0, head, 0);
+                top_block->connect(head, 0, sink, 0);
+                top_block->run();
+                sink->close();
+        }
+        catch (const std::exception & e)
+        {
+                std::cerr << "Unable to generate the synthetic signal: " << e.what() << std::endl;
+                return false;
+        }
+        return true;
+    }
+
+    /*
+     * First alarm of each spoofing case in a PVT log, and its latency from
+     * the start of the attack: the receiver time of the alarm less the time
+     * of week of the first sample of the scenario and the attack start.
+     * Alarms raised before the first observable have no receiver time, and
+     * a latency of -1.
+     */
+    std::string alarm_latencies_json(const std::string & log_filename, double nav_tow_s, double attack_s)
+    {
+        std::map<int, double> first_latency_s;
+        std::map<int, unsigned int> alarms;
+        Pvt_Log_Reader reader;
+        if (reader.open(log_filename))
+            {
+                while (const Pvt_Log_Record_Header* record = reader.next())
+                    {
+                        if (const Pvt_Log_Alarm* alarm = Pvt_Log_Reader::as<Pvt_Log_Alarm>(record, PVT_LOG_ALARM))
+                            {
+                                if (alarms[alarm->spoofing_case]++ == 0)
+                                    {
+                                        first_latency_s[alarm->spoofing_case] = alarm->rx_time > 0.0 ? alarm->rx_time - nav_tow_s - attack_s : -1.0;
+                                    }
+                            }
+                    }
+            }
+        std::stringstream json;
+        json << "[";
+        for (std::map<int, unsigned int>::const_iterator it = alarms.begin(); it != alarms.end(); ++it)
+            {
+                json << (it == alarms.begin() ? "" : ",") << std::endl << "    {\"spoofing_case\": " << it->first
+                     << ", \"alarms\": " << it->second << ", \"first_latency_s\": " << first_latency_s[it->first] << "}";
+            }
+        json << (alarms.empty() ? "]" : "\n   ]");
+        return json.str();
+    }
+
+    double cpu_seconds(const struct rusage & usage)
+    {
+        return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+    }
+
+    // Runs the receiver in the child process and writes directory/result.json, it never returns
+    void run_benchmark(const Benchmark_Run & run, const std::string & directory)
+    {
+        int status = 1;
+        try
+        {
+                if (chdir(directory.c_str()) != 0 || !std::freopen("gnss-sdr.out", "w", stdout))
+                    {
+                        std::_Exit(status);
+                    }
+                FLAGS_log_dir = directory + "/";
+                unsigned long long samples = static_cast<unsigned long long>(std::ceil(FLAGS_benchmark_seconds * benchmark_fs_hz));
+                std::shared_ptr<ConfigurationInterface> configuration;
+                if (run.scenario)
+                    {
+                        // the receiver of the scenario, completed by the default one, with one check enabled
+                        configuration = std::make_shared<FileConfiguration>(run.filename);
+                        samples = static_cast<unsigned long long>(std::ceil(configuration->property("Scenario.seconds", FLAGS_benchmark_seconds) * benchmark_fs_hz));
+                        set_missing_properties(configuration.get(), receiver_properties());
+                        set_missing_properties(configuration.get(), generator_filter_properties());
+                        configuration->set_property("SignalSource.implementation", "Signal_Generator");
+                        configuration->set_property("SignalSource.item_type", "gr_complex");
+                        configuration->set_property("SignalSource.fs_hz", std::to_string(static_cast<long>(benchmark_fs_hz)));
+                        configuration->set_property("SignalSource.samples", std::to_string(samples));
+                        std::vector<std::string> checks = split_list(FLAGS_benchmark_scenario_checks);
+                        for (unsigned int i = 0; i < checks.size(); i++)
+                            {
+                                configuration->set_property("Spoofing." + checks[i], checks[i] == run.spoofing ? "true" : "false");
+                            }
+                    }
+                else
+                    {
+                        configuration = base_configuration();
+                        configuration->set_property("SignalSource.implementation", "File_Signal_Source");
+                        configuration->set_property("SignalSource.filename", run.filename);
+                        configuration->set_property("SignalSource.item_type", "gr_complex");
+                        configuration->set_property("SignalSource.sampling_frequency", std::to_string(static_cast<long>(benchmark_fs_hz)));
+                        configuration->set_property("SignalSource.samples", std::to_string(samples));
+                        configuration->set_property("SignalSource.seconds_to_skip", "0");
+                        configuration->set_property("SignalSource.repeat", "true");
+                        configuration->set_property("SignalSource.enable_throttle_control", "false");
+                        configuration->set_property("Spoofing.APT", run.spoofing.find("APT") != std::string::npos ? "true" : "false");
+                        configuration->set_property("Spoofing.PPE", run.spoofing.find("PPE") != std::string::npos ? "true" : "false");
+                    }
+                configuration->set_property("GNSS-SDR.internal_fs_hz", std::to_string(static_cast<long>(benchmark_fs_hz)));
+                configuration->set_property("SignalConditioner.implementation", "Pass_Through");
+                configuration->set_property("SignalConditioner.item_type", "gr_complex");
+                configuration->set_property("Channels_1C.count", std::to_string(run.channels));
+                configuration->set_property("Receiver.metrics_enabled", "true");
+                configuration->set_property("PVT.pvt_log_filename", directory + "/PVT_log.dat");
+                configuration->set_property("PVT.flag_nmea_tty_port", "false");
+                configuration->set_property("PVT.flag_rtcm_server", "false");
+                configuration->set_property("PVT.flag_rtcm_tty_port", "false");
+                configuration->set_property("PVT.telemetry_address", "");
+
+                std::atomic<double> ttff_s(-1.0);
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                std::unique_ptr<ControlThread> control_thread(new ControlThread(configuration));
+                // the PVT blocks publish every fix in the tables of the receiver, for the visibility prediction
+                control_thread->flowgraph()->state()->gps_ref_location_map.watch([&](int, const Gps_Ref_Location& fix)
+                        {
+                            double none = -1.0;
+                            if (fix.valid)
+                                {
+                                    ttff_s.compare_exchange_strong(none, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+                                }
+                        });
+                control_thread->run();
+                double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                struct rusage usage;
+                getrusage(RUSAGE_SELF, &usage);
+                // the busy time of the calls of each kind of block, all channels together
+                std::map<std::string, double> stage_s;
+                std::vector<std::shared_ptr<Block_Metrics> > metrics = block_metrics_registered();
+                for (unsigned int i = 0; i < metrics.size(); i++)
+                    {
+                        stage_s[metrics[i]->block()] += metrics[i]->snapshot().busy_ns * 1e-9;
+                    }
+                control_thread.reset();  // closes the PVT log
+
+                std::ofstream result((directory + "/result.json").c_str());
+                result << "  {" << std::endl;
+                result << "   \"input\": \"" << run.input << "\"," << std::endl;
+                result << "   \"channels\": " << run.channels << "," << std::endl;
+                result << "   \"spoofing\": \"" << run.spoofing << "\"," << std::endl;
+                result << "   \"samples\": " << samples << "," << std::endl;
+                result << "   \"wall_s\": " << wall_s << "," << std::endl;
+                result << "   \"samples_per_s\": " << samples / wall_s << "," << std::endl;
+                result << "   \"realtime_factor\": " << samples / benchmark_fs_hz / wall_s << "," << std::endl;
+                result << "   \"cpu_s\": " << cpu_seconds(usage) << "," << std::endl;
+                result << "   \"peak_rss_kb\": " << usage.ru_maxrss << "," << std::endl;
+                result << "   \"ttff_s\": " << ttff_s.load() << "," << std::endl;
+                if (run.scenario)
+                    {
+                        result << "   \"attack_start_s\": " << configuration->property("Scenario.attack_start_s", 0.0) << "," << std::endl;
+                        result << "   \"alarms\": " << alarm_latencies_json(directory + "/PVT_log.dat",
+                                configuration->property("SignalSource.nav_tow_s", 352800.0),
+                                configuration->property("Scenario.attack_start_s", 0.0)) << "," << std::endl;
+                    }
+                result << "   \"stage_busy_s\": {";
+                for (std::map<std::string, double>::const_iterator it = stage_s.begin(); it != stage_s.end(); ++it)
+                    {
+                        result << (it == stage_s.begin() ? "" : ",") << std::endl << "    \"" << it->first << "\": " << it->second;
+                    }
+                result << std::endl << "   }" << std::endl;
+                result << "  }";
+                result.close();
+                status = result ? 0 : 1;
+        }
+        catch (const std::exception & e)
+        {
+                std::cerr << "Benchmark run in " << directory << " failed: " << e.what() << std::endl;
+        }
+        std::cout << std::flush;
+        std::_Exit(status);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    namespace fs = boost::filesystem;
+    google::ParseCommandLineFlags(&argc, &argv, true);
+    google::InitGoogleLogging(argv[0]);
+
+    fs::path output_dir = fs::absolute(FLAGS_benchmark_output_dir);
+    boost::system::error_code ec;
+    fs::create_directories(output_dir, ec);
+    if (!FLAGS_benchmark_config.empty())
+        {
+            FLAGS_benchmark_config = fs::absolute(FLAGS_benchmark_config).string();
+        }
+
+    std::vector<std::pair<std::string, std::string> > inputs;
+    if (!FLAGS_benchmark_samples_dir.empty() && fs::is_directory(FLAGS_benchmark_samples_dir, ec))
+        {
+            for (fs::directory_iterator it(FLAGS_benchmark_samples_dir); it != fs::directory_iterator(); ++it)
+                {
+                    if (it->path().extension() == ".dat")
+                        {
+                            inputs.push_back(std::make_pair(it->path().stem().string(), fs::absolute(it->path()).string()));
+                        }
+                }
+            std::sort(inputs.begin(), inputs.end());
+        }
+    if (FLAGS_benchmark_synthetic_satellites > 0)
+        {
+            std::string filename = (output_dir / "synthetic_gps_l1_ca.dat").string();
+            if (generate_synthetic_signal(filename))
+                {
+                    inputs.push_back(std::make_pair(std::string("synthetic_gps_l1_ca"), filename));
+                }
+        }
+
+    std::vector<Benchmark_Run> runs;
+    std::vector<std::string> channels = split_list(FLAGS_benchmark_channels);
+    std::vector<std::string> spoofing = split_list(FLAGS_benchmark_spoofing);
+    for (unsigned int i = 0; i < inputs.size(); i++)
+        {
+            for (unsigned int c = 0; c < channels.size(); c++)
+                {
+                    for (unsigned int s = 0; s < spoofing.size(); s++)
+                        {
+                            Benchmark_Run run;
+                            run.input = inputs[i].first;
+                            run.filename = inputs[i].second;
+                            run.channels = std::atoi(channels[c].c_str());
+                            run.spoofing = spoofing[s];
+                            run.scenario = false;
+                            runs.push_back(run);
+                        }
+                }
+        }
+    // every scenario without checks, and with each check alone: its CPU time
+    // is the difference with the run without checks
+    std::vector<std::string> scenarios = split_list(FLAGS_benchmark_scenarios);
+    std::vector<std::string> scenario_checks = split_list(FLAGS_benchmark_scenario_checks);
+    scenario_checks.insert(scenario_checks.begin(), "off");
+    for (unsigned int i = 0; i < scenarios.size(); i++)
+        {
+            for (unsigned int c = 0; c < channels.size(); c++)
+                {
+                    for (unsigned int s = 0; s < scenario_checks.size(); s++)
+                        {
+                            Benchmark_Run run;
+                            run.input = fs::path(scenarios[i]).stem().string();
+                            run.filename = fs::absolute(scenarios[i]).string();
+                            run.channels = std::atoi(channels[c].c_str());
+                            run.spoofing = scenario_checks[s];
+                            run.scenario = true;
+                            runs.push_back(run);
+                        }
+                }
+        }
+    if (runs.empty())
+        {
+            std::cout << "Nothing to benchmark" << std::endl;
+            return 1;
+        }
+
+    // one run at a time, so that they do not compete for the cores
+    std::vector<std::string> results;
+    unsigned int failed = 0;
+    for (unsigned int n = 0; n < runs.size(); n++)
+        {
+            fs::path directory = output_dir / ("run_" + std::to_string(n));
+            fs::create_directories(directory, ec);
+            fs::remove(directory / "result.json", ec);
+            std::cout << std::flush;
+            pid_t pid = fork();
+            if (pid == 0)
+                {
+                    run_benchmark(runs[n], directory.string());
+                }
+            int status = 1;
+            if (pid == -1 || waitpid(pid, &status, 0) == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                {
+                    std::cout << "Run " << n << " (" << runs[n].input << ", " << runs[n].channels << " channels, spoofing "
+                              << runs[n].spoofing << ") failed" << std::endl;
+                    failed++;
+                    continue;
+                }
+            std::ifstream result_file((directory / "result.json").string().c_str());
+            std::stringstream result;
+            result << result_file.rdbuf();
+            results.push_back(result.str());
+            std::cout << "Run " << n << ": " << runs[n].input << ", " << runs[n].channels << " channels, spoofing "
+                      << runs[n].spoofing << " done, see " << (directory / "result.json").string() << std::endl;
+        }
+
+    std::ofstream json_file((output_dir / "results.json").string().c_str());
+    json_file << "{" << std::endl;
+    json_file << " \"benchmark_seconds\": " << FLAGS_benchmark_seconds << "," << std::endl;
+    json_file << " \"runs\": [" << std::endl;
+    for (unsigned int i = 0; i < results.size(); i++)
+        {
+            json_file << results[i] << (i + 1 < results.size() ? "," : "") << std::endl;
+        }
+    json_file << " ]" << std::endl;
+    json_file << "}" << std::endl;
+    std::cout << results.size() << " runs written to " << (output_dir / "results.json").string() << std::endl;
+    google::ShutDownCommandLineFlags();
+    return failed == 0 ? 0 : 1;
+}
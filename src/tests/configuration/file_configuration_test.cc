@@ -30,8 +30,10 @@
  */
 
 
+#include <algorithm>
 #include <string>
 #include <iostream>
+#include <vector>
 #include "file_configuration.h"
 
 
@@ -71,3 +73,30 @@ TEST(File_Configuration_Test, PropertyDoesNotExist)
     std::string value = configuration->property("whatever.whatever", default_value);
     EXPECT_STREQ("default_value", value.c_str());
 }
+
+
+
+TEST(File_Configuration_Test, TypedPropertiesAndUnreadOnes)
+{
+    std::string path = std::string(TEST_PATH);
+    std::string filename = path + "data/config_file_sample.txt";
+    std::unique_ptr<FileConfiguration> configuration(new FileConfiguration(filename));
+    // the names are case-insensitive, the conversions are kept
+    EXPECT_EQ(4, configuration->property("signalsource.ITEM_SIZE", 0));
+    EXPECT_EQ(4, configuration->property("SignalSource.item_size", 0));
+    EXPECT_DOUBLE_EQ(4.0, configuration->property("SignalSource.item_size", 0.0));
+    EXPECT_FALSE(configuration->property("SignalSource.repeat", true));
+    EXPECT_EQ(7, configuration->property("SignalSource.implementation", 7));
+    configuration->set_property("SignalSource.filename", "other.dat");
+    EXPECT_STREQ("other.dat", configuration->property("SignalSource.filename", std::string("")).c_str());
+
+    // Foo.param1 is never read, the receiver looked for Foo.param2
+    EXPECT_EQ(0, configuration->property("Foo.param2", 0));
+    std::vector<std::string> unread = configuration->unread_properties();
+    EXPECT_TRUE(std::is_sorted(unread.begin(), unread.end()));
+    EXPECT_TRUE(std::find(unread.begin(), unread.end(), "foo.param1") != unread.end());
+    EXPECT_STREQ("foo.param2", configuration->closest_missing_property("Foo.param1").c_str());
+    EXPECT_STREQ("", configuration->closest_missing_property("channel1.implementation").c_str());
+    EXPECT_TRUE(std::find(unread.begin(), unread.end(), "signalsource.filename") == unread.end());
+    EXPECT_TRUE(std::find(unread.begin(), unread.end(), "signalsource.item_size") == unread.end());
+}
@@ -0,0 +1,56 @@
+/*!
+ * \file batch_replay_test.cc
+ * \brief  This file implements tests for the segments of the batch replay
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <vector>
+#include <gtest/gtest.h>
+#include "batch_replay.h"
+
+
+TEST(BatchReplayTest, SegmentsOverlapByTheWarmUp)
+{
+    std::vector<Batch_Segment> segments = batch_segments(300.0, 3, 40.0);
+    ASSERT_EQ(3u, segments.size());
+    EXPECT_DOUBLE_EQ(0.0, segments[0].seconds_to_skip);
+    EXPECT_DOUBLE_EQ(100.0, segments[0].seconds);
+    EXPECT_DOUBLE_EQ(60.0, segments[1].seconds_to_skip);
+    EXPECT_DOUBLE_EQ(140.0, segments[1].seconds);
+    EXPECT_DOUBLE_EQ(160.0, segments[2].seconds_to_skip);
+    EXPECT_DOUBLE_EQ(300.0, segments[2].seconds_to_skip + segments[2].seconds);
+
+    // a warm-up longer than the segments starts them at the beginning of the file
+    segments = batch_segments(30.0, 3, 40.0);
+    EXPECT_DOUBLE_EQ(0.0, segments[2].seconds_to_skip);
+    EXPECT_DOUBLE_EQ(30.0, segments[2].seconds);
+
+    EXPECT_TRUE(batch_segments(300.0, 0, 40.0).empty());
+}
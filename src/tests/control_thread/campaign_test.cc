@@ -0,0 +1,164 @@
+/*!
+ * \file campaign_test.cc
+ * \brief Tests of the manifest and the summaries of campaign-runner
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "campaign.h"
+#include "pvt_log.h"
+
+
+TEST(CampaignTest, ManifestExpandsTheOverrides)
+{
+    std::string filename = "./campaign_test_manifest.txt";
+    {
+        std::ofstream manifest(filename.c_str());
+        manifest << "# scenario capture config onset overrides" << std::endl
+                 << "clean /data/static.dat /conf/static.conf -" << std::endl
+                 << std::endl
+                 << "drag_off /data/drag.dat /conf/drag.conf 345600.5 Spoofing.A=1,2;Spoofing.B=x,y,z  # sweep" << std::endl;
+    }
+    std::vector<Campaign_Job> jobs;
+    std::string error;
+    ASSERT_TRUE(campaign_read_manifest(filename, jobs, error)) << error;
+    ASSERT_EQ(7u, jobs.size());
+    EXPECT_EQ("clean", jobs[0].scenario);
+    EXPECT_EQ("/data/static.dat", jobs[0].capture);
+    EXPECT_LT(jobs[0].onset_rx_time, 0.0);
+    EXPECT_TRUE(jobs[0].overrides.empty());
+    EXPECT_EQ("-", campaign_overrides_string(jobs[0].overrides));
+    EXPECT_EQ(6u, jobs[6].id);
+    EXPECT_EQ("drag_off", jobs[6].scenario);
+    EXPECT_DOUBLE_EQ(345600.5, jobs[6].onset_rx_time);
+    EXPECT_EQ("Spoofing.A=1;Spoofing.B=x", campaign_overrides_string(jobs[1].overrides));
+    EXPECT_EQ("Spoofing.A=2;Spoofing.B=z", campaign_overrides_string(jobs[6].overrides));
+
+    // the string of the overrides of a job gives back that job alone
+    std::vector<Campaign_Overrides> combinations;
+    ASSERT_TRUE(campaign_expand_overrides(campaign_overrides_string(jobs[4].overrides), combinations));
+    ASSERT_EQ(1u, combinations.size());
+    EXPECT_EQ(jobs[4].overrides, combinations[0]);
+
+    {
+        std::ofstream manifest(filename.c_str());
+        manifest << "drag_off /data/drag.dat /conf/drag.conf soon" << std::endl;
+    }
+    jobs.clear();
+    EXPECT_FALSE(campaign_read_manifest(filename, jobs, error));
+    EXPECT_FALSE(campaign_expand_overrides("Spoofing.A=", combinations));
+    std::remove(filename.c_str());
+}
+
+
+TEST(CampaignTest, DetectionLatencyFromThePvtLog)
+{
+    std::string filename = "./campaign_test_pvt_log.dat";
+    {
+        std::ofstream log(filename.c_str(), std::ios::binary);
+        Pvt_Log_File_Header header = {{'G', 'S', 'P', 'L'}, PVT_LOG_VERSION, sizeof(Pvt_Log_Record_Header)};
+        log.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        double alarm_times[] = {99.0, 104.0, 110.0};
+        unsigned int next_alarm = 0;
+        for (unsigned int n = 0; n < 20; n++)
+            {
+                Pvt_Log_Solution solution;
+                std::memset(&solution, 0, sizeof(solution));
+                solution.header.type = PVT_LOG_SOLUTION;
+                solution.header.length = sizeof(solution);
+                solution.rx_time = 95.0 + n;
+                log.write(reinterpret_cast<const char*>(&solution), sizeof(solution));
+                if (next_alarm < 3 && alarm_times[next_alarm] == solution.rx_time)
+                    {
+                        Pvt_Log_Alarm alarm;
+                        std::memset(&alarm, 0, sizeof(alarm));
+                        alarm.header.type = PVT_LOG_ALARM;
+                        alarm.header.length = sizeof(alarm);
+                        alarm.rx_time = alarm_times[next_alarm++];
+                        log.write(reinterpret_cast<const char*>(&alarm), sizeof(alarm));
+                    }
+            }
+    }
+    Campaign_Job_Result result;
+    ASSERT_TRUE(campaign_read_pvt_log(filename, 100.0, result));
+    EXPECT_EQ(20u, result.solutions);
+    EXPECT_EQ(3u, result.alarms);
+    EXPECT_EQ(1u, result.false_alarms);
+    EXPECT_DOUBLE_EQ(99.0, result.first_alarm_rx_time);
+    EXPECT_DOUBLE_EQ(4.0, result.detection_latency_s);
+
+    // without an attack every alarm is a false one
+    ASSERT_TRUE(campaign_read_pvt_log(filename, -1.0, result));
+    EXPECT_EQ(3u, result.false_alarms);
+    EXPECT_LT(result.detection_latency_s, 0.0);
+
+    EXPECT_FALSE(campaign_read_pvt_log("./no_such_campaign_log.dat", 100.0, result));
+    std::remove(filename.c_str());
+}
+
+
+TEST(CampaignTest, SummariesByScenario)
+{
+    std::vector<Campaign_Job> jobs(4);
+    std::vector<Campaign_Job_Result> results(4);
+    const char* scenarios[] = {"drag_off", "clean", "drag_off", "drag_off"};
+    double latencies[] = {2.0, -1.0, 6.0, -1.0};
+    for (unsigned int n = 0; n < 4; n++)
+        {
+            jobs[n].id = n;
+            jobs[n].scenario = scenarios[n];
+            jobs[n].onset_rx_time = n == 1 ? -1.0 : 100.0;
+            results[n].done = n != 3;
+            results[n].capture_s = 300.0;
+            results[n].wall_s = 30.0;
+            results[n].cpu_s = 200.0;
+            results[n].false_alarms = n == 1 ? 1 : 0;
+            results[n].detection_latency_s = latencies[n];
+        }
+    std::vector<Campaign_Scenario_Summary> summaries = campaign_summaries(jobs, results);
+    ASSERT_EQ(2u, summaries.size());
+    EXPECT_EQ("drag_off", summaries[0].scenario);
+    EXPECT_EQ(3u, summaries[0].jobs);
+    EXPECT_EQ(1u, summaries[0].failed);
+    EXPECT_EQ(2u, summaries[0].attacks);
+    EXPECT_EQ(2u, summaries[0].detected);
+    EXPECT_DOUBLE_EQ(4.0, summaries[0].mean_latency_s);
+    EXPECT_DOUBLE_EQ(6.0, summaries[0].max_latency_s);
+    EXPECT_DOUBLE_EQ(400.0, summaries[0].cpu_s);
+    EXPECT_EQ("clean", summaries[1].scenario);
+    EXPECT_EQ(0u, summaries[1].attacks);
+    EXPECT_EQ(1u, summaries[1].false_alarms);
+    EXPECT_LT(summaries[1].mean_latency_s, 0.0);
+}
@@ -106,6 +106,9 @@ TEST(Control_Thread_Test, InstantiateRunControlMessages)
     unsigned int expected1 = 1;
     EXPECT_EQ(expected3, control_thread->processed_control_messages());
     EXPECT_EQ(expected1, control_thread->applied_actions());
+    // one queue message each, timed from its creation
+    EXPECT_EQ(expected3, control_thread->event_latency(ControlThread::CONTROL_MESSAGE_EVENT).events);
+    EXPECT_GE(control_thread->event_latency(ControlThread::CONTROL_MESSAGE_EVENT).max_s, 0.0);
 }
 
 
@@ -0,0 +1,139 @@
+/*!
+ * \file gnss_visibility_predictor_test.cc
+ * \brief  This file implements tests for the prediction of the visible satellites
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cmath>
+#include <set>
+#include <gtest/gtest.h>
+#include "GPS_L1_CA.h"
+#include "gnss_visibility_predictor.h"
+
+
+static Gps_Almanac visibility_test_almanac(unsigned int PRN, double M_0)
+{
+    // a nominal GPS orbit, angles in semi-circles
+    Gps_Almanac almanac;
+    almanac.i_satellite_PRN = PRN;
+    almanac.d_sqrt_A = 5153.6;
+    almanac.d_e_eccentricity = 0.005;
+    almanac.d_Delta_i = 0.0069;
+    almanac.d_OMEGA0 = -0.36;
+    almanac.d_OMEGA = 0.21;
+    almanac.d_OMEGA_DOT = -2.6e-9;
+    almanac.d_M_0 = M_0;
+    almanac.d_Toa = 405504.0;
+    return almanac;
+}
+
+
+TEST(GnssVisibilityPredictorTest, SatelliteOverheadIsVisible)
+{
+    const double tow = 410000.0;
+    Gps_Almanac almanac = visibility_test_almanac(3, 0.4);
+
+    // the point under the satellite, and its antipode
+    Gnss_Visibility_Predictor probe;
+    probe.set_almanac(almanac);
+    Gps_Ephemeris ephemeris;
+    ephemeris.d_sqrt_A = almanac.d_sqrt_A;
+    ephemeris.d_e_eccentricity = almanac.d_e_eccentricity;
+    ephemeris.d_M_0 = almanac.d_M_0 * GPS_PI;
+    ephemeris.d_OMEGA0 = almanac.d_OMEGA0 * GPS_PI;
+    ephemeris.d_OMEGA = almanac.d_OMEGA * GPS_PI;
+    ephemeris.d_OMEGA_DOT = almanac.d_OMEGA_DOT * GPS_PI;
+    ephemeris.d_i_0 = (0.30 + almanac.d_Delta_i) * GPS_PI;
+    ephemeris.d_Toe = almanac.d_Toa;
+    ephemeris.satellitePosition(tow);
+    double x = ephemeris.d_satpos_X;
+    double y = ephemeris.d_satpos_Y;
+    double z = ephemeris.d_satpos_Z;
+    double lat_deg = std::atan2(z, std::sqrt(x * x + y * y)) * 180.0 / GPS_PI;
+    double lon_deg = std::atan2(y, x) * 180.0 / GPS_PI;
+
+    Gnss_Visibility_Predictor predictor(10.0);
+    double elevation_deg = 0.0;
+    EXPECT_FALSE(predictor.elevation(3, tow, elevation_deg));
+    predictor.set_almanac(almanac);
+    predictor.set_almanac(visibility_test_almanac(7, 0.4));
+    EXPECT_FALSE(predictor.elevation(3, tow, elevation_deg));
+    predictor.set_position(lat_deg, lon_deg, 0.0);
+    ASSERT_TRUE(predictor.elevation(3, tow, elevation_deg));
+    // geocentric and geodetic latitudes differ by a fraction of a degree
+    EXPECT_GT(elevation_deg, 88.0);
+
+    std::set<unsigned int> visible;
+    std::set<unsigned int> hidden;
+    predictor.predict(tow, 0.0, visible, hidden);
+    EXPECT_EQ(1u, visible.count(3));
+    EXPECT_EQ(1u, visible.count(7));
+    EXPECT_EQ(0u, visible.count(5));
+    EXPECT_EQ(0u, hidden.count(5));
+
+    predictor.set_position(-lat_deg, lon_deg + 180.0, 0.0);
+    ASSERT_TRUE(predictor.elevation(3, tow, elevation_deg));
+    EXPECT_LT(elevation_deg, -60.0);
+    predictor.predict(tow, 0.0, visible, hidden);
+    EXPECT_EQ(1u, hidden.count(3));
+}
+
+
+TEST(GnssVisibilityPredictorTest, EphemerisReplacesAlmanac)
+{
+    const double tow = 410000.0;
+    Gnss_Visibility_Predictor predictor(5.0);
+    predictor.set_position(41.27, 1.99, 100.0);
+    predictor.set_almanac(visibility_test_almanac(9, 0.4));
+    double almanac_deg = 0.0;
+    ASSERT_TRUE(predictor.elevation(9, tow, almanac_deg));
+
+    // half an orbit later along the same plane
+    Gps_Ephemeris ephemeris;
+    ephemeris.i_satellite_PRN = 9;
+    ephemeris.d_sqrt_A = 5153.6;
+    ephemeris.d_e_eccentricity = 0.005;
+    ephemeris.d_M_0 = (0.4 + 1.0) * GPS_PI;
+    ephemeris.d_OMEGA0 = -0.36 * GPS_PI;
+    ephemeris.d_OMEGA = 0.21 * GPS_PI;
+    ephemeris.d_OMEGA_DOT = -2.6e-9 * GPS_PI;
+    ephemeris.d_i_0 = 0.3069 * GPS_PI;
+    ephemeris.d_Toe = 405504.0;
+    predictor.set_ephemeris(ephemeris);
+    double ephemeris_deg = 0.0;
+    ASSERT_TRUE(predictor.elevation(9, tow, ephemeris_deg));
+    EXPECT_GT(std::abs(ephemeris_deg - almanac_deg), 1.0);
+
+    // a later almanac does not replace the ephemeris
+    predictor.set_almanac(visibility_test_almanac(9, 0.4));
+    double again_deg = 0.0;
+    ASSERT_TRUE(predictor.elevation(9, tow, again_deg));
+    EXPECT_DOUBLE_EQ(ephemeris_deg, again_deg);
+    EXPECT_EQ(1u, predictor.orbits());
+}
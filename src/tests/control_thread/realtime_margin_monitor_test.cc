@@ -0,0 +1,94 @@
+/*!
+ * \file realtime_margin_monitor_test.cc
+ * \brief  This file implements tests for the real-time margin monitor
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <gtest/gtest.h>
+#include "realtime_margin_monitor.h"
+
+
+TEST(RealtimeMarginMonitorTest, FasterThanRealTimeHasNoLag)
+{
+    Realtime_Margin_Monitor monitor(1e6, 0.1, 0.025, 1.0);
+    for (int t = 0; t <= 10; t++)
+        {
+            // a file source read at twice the sampling rate
+            EXPECT_FALSE(monitor.update(t, 2000000ULL * t));
+            EXPECT_DOUBLE_EQ(0.0, monitor.lag_s());
+        }
+    EXPECT_DOUBLE_EQ(1.0, monitor.margin());
+    EXPECT_EQ(Realtime_Margin_Monitor::NO_SHEDDING, monitor.level());
+}
+
+
+TEST(RealtimeMarginMonitorTest, ShedsOneLevelPerHoldAndRecovers)
+{
+    Realtime_Margin_Monitor monitor(1e6, 0.1, 0.025, 1.0);
+    monitor.update(0.0, 0);
+    // half the sampling rate: the lag grows by 0.5 s every second
+    EXPECT_FALSE(monitor.update(0.5, 250000));
+    EXPECT_EQ(Realtime_Margin_Monitor::NO_SHEDDING, monitor.level());
+    EXPECT_TRUE(monitor.update(1.0, 500000));
+    EXPECT_EQ(Realtime_Margin_Monitor::APT_PAUSED, monitor.level());
+    EXPECT_DOUBLE_EQ(0.5, monitor.lag_s());
+    EXPECT_DOUBLE_EQ(-0.5, monitor.margin());
+    EXPECT_FALSE(monitor.update(1.5, 750000));
+    EXPECT_TRUE(monitor.update(2.0, 1000000));
+    EXPECT_EQ(Realtime_Margin_Monitor::PPE_DECIMATED, monitor.level());
+    EXPECT_TRUE(monitor.update(3.0, 1500000));
+    EXPECT_EQ(Realtime_Margin_Monitor::CHANNELS_DROPPED, monitor.level());
+    EXPECT_FALSE(monitor.update(4.0, 2000000));
+    EXPECT_EQ(Realtime_Margin_Monitor::CHANNELS_DROPPED, monitor.level());
+
+    // three times the sampling rate: the backlog is gone at 5 s
+    EXPECT_FALSE(monitor.update(5.0, 5000000));
+    EXPECT_DOUBLE_EQ(0.0, monitor.lag_s());
+    EXPECT_TRUE(monitor.update(6.0, 8000000));
+    EXPECT_EQ(Realtime_Margin_Monitor::PPE_DECIMATED, monitor.level());
+    EXPECT_FALSE(monitor.update(6.5, 9500000));
+    EXPECT_TRUE(monitor.update(7.0, 11000000));
+    EXPECT_EQ(Realtime_Margin_Monitor::APT_PAUSED, monitor.level());
+    EXPECT_TRUE(monitor.update(8.0, 14000000));
+    EXPECT_EQ(Realtime_Margin_Monitor::NO_SHEDDING, monitor.level());
+}
+
+
+TEST(RealtimeMarginMonitorTest, NoMoreSheddingWhileTheLagDecreases)
+{
+    Realtime_Margin_Monitor monitor(1e6, 0.1, 0.025, 1.0);
+    monitor.update(0.0, 0);
+    EXPECT_TRUE(monitor.update(1.0, 500000));
+    EXPECT_EQ(Realtime_Margin_Monitor::APT_PAUSED, monitor.level());
+    // 1.2 times the sampling rate: still behind, but catching up
+    EXPECT_FALSE(monitor.update(2.0, 1700000));
+    EXPECT_NEAR(0.3, monitor.lag_s(), 1e-9);
+    EXPECT_FALSE(monitor.update(3.0, 2900000));
+    EXPECT_EQ(Realtime_Margin_Monitor::APT_PAUSED, monitor.level());
+}
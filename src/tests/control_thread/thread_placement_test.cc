@@ -0,0 +1,65 @@
+/*!
+ * \file thread_placement_test.cc
+ * \brief  This file implements tests for the placement of the threads on the CPUs
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <vector>
+#include <gtest/gtest.h>
+#include "thread_placement.h"
+
+
+TEST(ThreadPlacementTest, ParsesListsAndRanges)
+{
+    std::vector<int> expected = {0, 2, 4, 5, 6, 7};
+    EXPECT_EQ(expected, parse_cpu_list("0,2,4-7"));
+    EXPECT_EQ(expected, parse_cpu_list("0, 2 4-7"));
+    EXPECT_TRUE(parse_cpu_list("").empty());
+}
+
+
+TEST(ThreadPlacementTest, InvalidListsPlaceNothing)
+{
+    EXPECT_TRUE(parse_cpu_list("0,a").empty());
+    EXPECT_TRUE(parse_cpu_list("3-").empty());
+    EXPECT_TRUE(parse_cpu_list("-1").empty());
+    EXPECT_TRUE(parse_cpu_list("100000").empty());
+}
+
+
+TEST(ThreadPlacementTest, PinsTheCurrentThread)
+{
+    std::vector<int> original = current_thread_affinity();
+    ASSERT_FALSE(original.empty());
+    std::vector<int> first(1, original.front());
+    EXPECT_TRUE(set_current_thread_affinity(first));
+    EXPECT_EQ(first, current_thread_affinity());
+    EXPECT_TRUE(set_current_thread_affinity(original));
+    EXPECT_EQ(original, current_thread_affinity());
+}
@@ -0,0 +1,207 @@
+/*!
+ * \file gnss_signal_scheduler_test.cc
+ * \brief  This file implements tests for the queues of the GNSS signal scheduler
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <set>
+#include <string>
+#include <gtest/gtest.h>
+#include "gnss_signal_scheduler.h"
+
+
+TEST(GnssSignalSchedulerTest, ChannelsTakeSignalsOfTheirType)
+{
+    Gnss_Signal_Scheduler scheduler;
+    for (unsigned int prn = 1; prn <= 32; prn++)
+        {
+            scheduler.push_back(Gnss_Signal(Gnss_Satellite("GPS", prn), "1C"));
+        }
+    for (unsigned int prn = 1; prn <= 36; prn++)
+        {
+            scheduler.push_back(Gnss_Signal(Gnss_Satellite("Galileo", prn), "1B"));
+        }
+    EXPECT_EQ(68u, scheduler.size());
+
+    Gnss_Signal signal;
+    ASSERT_TRUE(scheduler.next(0, "1B", signal));
+    EXPECT_EQ("Galileo", signal.get_satellite().get_system());
+    EXPECT_EQ(1u, signal.get_satellite().get_PRN());
+    ASSERT_TRUE(scheduler.next(1, "1C", signal));
+    EXPECT_EQ("GPS", signal.get_satellite().get_system());
+    EXPECT_EQ(1u, signal.get_satellite().get_PRN());
+    EXPECT_FALSE(scheduler.next(2, "5X", signal));
+
+    // a failed signal goes back at the end of its queue
+    scheduler.push_back(signal);
+    for (unsigned int prn = 2; prn <= 32; prn++)
+        {
+            ASSERT_TRUE(scheduler.next(1, "1C", signal));
+            EXPECT_EQ(prn, signal.get_satellite().get_PRN());
+        }
+    ASSERT_TRUE(scheduler.next(1, "1C", signal));
+    EXPECT_EQ(1u, signal.get_satellite().get_PRN());
+    EXPECT_TRUE(scheduler.empty("1C"));
+    EXPECT_EQ(35u, scheduler.size());
+}
+
+
+TEST(GnssSignalSchedulerTest, CountsInstancesOfEachSignal)
+{
+    Gnss_Signal_Scheduler scheduler;
+    Gnss_Signal gps_7(Gnss_Satellite("GPS", 7), "1C");
+    Gnss_Signal galileo_7(Gnss_Satellite("Galileo", 7), "1B");
+    scheduler.push_back(gps_7);
+    scheduler.push_back(gps_7);
+    scheduler.push_front(gps_7);
+    scheduler.push_back(galileo_7);
+    EXPECT_EQ(3u, scheduler.count(gps_7));
+    EXPECT_EQ(1u, scheduler.count(galileo_7));
+    EXPECT_EQ(0u, scheduler.count(Gnss_Signal(Gnss_Satellite("GPS", 7), "2S")));
+
+    Gnss_Signal signal;
+    ASSERT_TRUE(scheduler.next(0, "1C", signal));
+    EXPECT_EQ(2u, scheduler.count(gps_7));
+}
+
+
+TEST(GnssSignalSchedulerTest, PrioritizedSatellitesGoFirst)
+{
+    Gnss_Signal_Scheduler scheduler;
+    for (unsigned int prn = 1; prn <= 10; prn++)
+        {
+            scheduler.push_back(Gnss_Signal(Gnss_Satellite("GPS", prn), "1C"));
+        }
+    std::set<unsigned int> visible = { 9, 4 };
+    scheduler.prioritize("GPS", visible);
+    Gnss_Signal signal;
+    ASSERT_TRUE(scheduler.next(0, "1C", signal));
+    EXPECT_EQ(4u, signal.get_satellite().get_PRN());
+    ASSERT_TRUE(scheduler.next(0, "1C", signal));
+    EXPECT_EQ(9u, signal.get_satellite().get_PRN());
+    ASSERT_TRUE(scheduler.next(0, "1C", signal));
+    EXPECT_EQ(1u, signal.get_satellite().get_PRN());
+
+    // a prioritized satellite that failed is still searched before the others
+    scheduler.push_back(Gnss_Signal(Gnss_Satellite("GPS", 9), "1C"));
+    ASSERT_TRUE(scheduler.next(0, "1C", signal));
+    EXPECT_EQ(9u, signal.get_satellite().get_PRN());
+    // the priority is per system
+    scheduler.push_back(Gnss_Signal(Gnss_Satellite("Galileo", 4), "1B"));
+    scheduler.push_back(Gnss_Signal(Gnss_Satellite("Galileo", 9), "1B"));
+    ASSERT_TRUE(scheduler.next(0, "1B", signal));
+    EXPECT_EQ(4u, signal.get_satellite().get_PRN());
+}
+
+
+TEST(GnssSignalSchedulerTest, ReservedSignalGoesToItsChannel)
+{
+    Gnss_Signal_Scheduler scheduler;
+    for (unsigned int prn = 1; prn <= 5; prn++)
+        {
+            scheduler.push_back(Gnss_Signal(Gnss_Satellite("GPS", prn), "1C"));
+        }
+    scheduler.reserve(3, Gnss_Signal(Gnss_Satellite("GPS", 5), "1C"));
+    EXPECT_EQ(4u, scheduler.size());
+    Gnss_Signal signal;
+    ASSERT_TRUE(scheduler.next(0, "1C", signal));
+    EXPECT_EQ(1u, signal.get_satellite().get_PRN());
+    ASSERT_TRUE(scheduler.next(3, "1C", signal));
+    EXPECT_EQ(5u, signal.get_satellite().get_PRN());
+    // only the first time
+    ASSERT_TRUE(scheduler.next(3, "1C", signal));
+    EXPECT_EQ(2u, signal.get_satellite().get_PRN());
+}
+
+
+TEST(GnssSignalSchedulerTest, PeaksPerSatellite)
+{
+    Gnss_Signal_Scheduler scheduler;
+    scheduler.set_peaks_per_satellite(2);
+    EXPECT_EQ(1, scheduler.assign_peak(7, 0));
+    EXPECT_EQ(2, scheduler.assign_peak(7, 1));
+    EXPECT_EQ(0, scheduler.assign_peak(7, 2));
+    EXPECT_EQ(2, scheduler.acquired_peaks(7));
+    EXPECT_EQ(2, scheduler.channel_peak(1));
+    EXPECT_EQ(0, scheduler.channel_peak(2));
+
+    scheduler.release_peak(7);
+    EXPECT_EQ(3, scheduler.assign_peak(7, 2));
+    scheduler.release_peak(7);
+    scheduler.set_next_peak(7, 5);
+    EXPECT_EQ(5, scheduler.assign_peak(7, 2));
+    scheduler.release_peak(7);
+    // back to the highest peak after the last one
+    EXPECT_EQ(1, scheduler.assign_peak(7, 2));
+
+    scheduler.release_peak(8);
+    EXPECT_EQ(0, scheduler.acquired_peaks(8));
+}
+
+
+TEST(GnssSignalSchedulerTest, HiddenSatellitesGoLastOrAreParked)
+{
+    Gnss_Signal_Scheduler scheduler;
+    for (unsigned int prn = 1; prn <= 6; prn++)
+        {
+            scheduler.push_back(Gnss_Signal(Gnss_Satellite("GPS", prn), "1C"));
+        }
+    std::set<unsigned int> visible = { 5 };
+    std::set<unsigned int> hidden = { 1, 2 };
+    scheduler.set_visibility("GPS", visible, hidden, false);
+    unsigned int expected[] = { 5, 3, 4, 6, 1, 2 };
+    Gnss_Signal signal;
+    for (unsigned int i = 0; i < 6; i++)
+        {
+            ASSERT_TRUE(scheduler.next(0, "1C", signal));
+            EXPECT_EQ(expected[i], signal.get_satellite().get_PRN());
+        }
+    for (unsigned int prn = 1; prn <= 6; prn++)
+        {
+            scheduler.push_back(Gnss_Signal(Gnss_Satellite("GPS", prn), "1C"));
+        }
+
+    scheduler.set_visibility("GPS", visible, hidden, true);
+    EXPECT_EQ(4u, scheduler.size());
+    EXPECT_EQ(2u, scheduler.parked());
+    EXPECT_EQ(1u, scheduler.count(Gnss_Signal(Gnss_Satellite("GPS", 1), "1C")));
+    for (unsigned int i = 0; i < 4; i++)
+        {
+            ASSERT_TRUE(scheduler.next(0, "1C", signal));
+            EXPECT_NE(1u, signal.get_satellite().get_PRN());
+            EXPECT_NE(2u, signal.get_satellite().get_PRN());
+        }
+    EXPECT_FALSE(scheduler.next(0, "1C", signal));
+    EXPECT_TRUE(scheduler.empty("1C"));
+
+    // satellite 1 rose
+    scheduler.set_visibility("GPS", std::set<unsigned int>({ 1 }), std::set<unsigned int>(), true);
+    ASSERT_TRUE(scheduler.next(0, "1C", signal));
+    EXPECT_EQ(1u, signal.get_satellite().get_PRN());
+}
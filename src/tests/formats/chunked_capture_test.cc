@@ -0,0 +1,120 @@
+/*!
+ * \file chunked_capture_test.cc
+ * \brief  This file implements tests for the chunked capture files
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "chunked_capture.h"
+
+
+TEST(ChunkedCaptureTest, EncodesAndDecodesEveryKindOfChunk)
+{
+    std::srand(1);
+    std::vector<std::vector<short> > chunks(4, std::vector<short>(10000));
+    for (unsigned int n = 0; n < 10000; n++)
+        {
+            chunks[0][n] = static_cast<short>(2 * (std::rand() % 4) - 3);                  // 2-bit quantizer: table
+            chunks[1][n] = static_cast<short>(std::rand() % 1000 + 2000);                 // narrow range: packed
+            chunks[2][n] = static_cast<short>(std::rand() % 41 + std::rand() % 41 - 40);  // noise: rice
+            chunks[3][n] = static_cast<short>(std::rand() % 65536 - 32768);               // full scale: raw
+        }
+    chunks[2][5000] = -32768; // escaped by the rice code
+    for (unsigned int k = 0; k < chunks.size(); k++)
+        {
+            std::vector<unsigned char> encoded;
+            chunked_capture_encode(&chunks[k][0], chunks[k].size(), 2, encoded);
+            EXPECT_LE(encoded.size(), 8 + 2 * chunks[k].size());
+            std::vector<short> decoded(chunks[k].size());
+            ASSERT_TRUE(chunked_capture_decode(&encoded[0], encoded.size(), 2, decoded.size(), &decoded[0]));
+            EXPECT_EQ(chunks[k], decoded) << "chunk kind " << k;
+            // a truncated chunk is detected
+            EXPECT_FALSE(chunked_capture_decode(&encoded[0], encoded.size() / 2, 2, decoded.size(), &decoded[0]));
+        }
+}
+
+
+TEST(ChunkedCaptureTest, SeeksToAnyValue)
+{
+    std::string filename = "./chunked_capture_test.ccap";
+    std::vector<signed char> values(100003);
+    for (unsigned int n = 0; n < values.size(); n++)
+        {
+            values[n] = static_cast<signed char>(2 * (std::rand() % 2) - 1);
+        }
+    Chunked_Capture_Writer writer;
+    ASSERT_TRUE(writer.open(filename, 1, true, 4e6, 4096));
+    ASSERT_TRUE(writer.write(&values[0], 1000));
+    ASSERT_TRUE(writer.write(&values[1000], values.size() - 1000));
+    ASSERT_TRUE(writer.close());
+    // 1 bit per value
+    EXPECT_LT(writer.file_bytes(), values.size() / 7);
+
+    Chunked_Capture_Reader reader;
+    ASSERT_TRUE(reader.open(filename));
+    EXPECT_EQ(1u, reader.header().value_bytes);
+    EXPECT_EQ("ibyte", chunked_capture_item_type(reader.header()));
+    EXPECT_EQ(4e6, reader.header().sampling_frequency);
+    EXPECT_EQ(values.size(), reader.header().total_values);
+    ASSERT_EQ(25u, reader.header().chunks);
+    EXPECT_EQ(100003u - 24 * 4096, reader.chunk_values(24));
+
+    std::vector<unsigned char> encoded;
+    std::vector<signed char> decoded(4096);
+    const unsigned long long chunks[] = {24, 0, 13};
+    for (unsigned int i = 0; i < 3; i++)
+        {
+            ASSERT_TRUE(reader.decode_chunk(chunks[i], encoded, &decoded[0]));
+            for (unsigned int n = 0; n < reader.chunk_values(chunks[i]); n++)
+                {
+                    ASSERT_EQ(values[chunks[i] * 4096 + n], decoded[n]);
+                }
+        }
+    EXPECT_FALSE(reader.decode_chunk(25, encoded, &decoded[0]));
+    reader.close();
+    std::remove(filename.c_str());
+}
+
+
+TEST(ChunkedCaptureTest, RejectsOtherFiles)
+{
+    std::string filename = "./chunked_capture_test.dat";
+    std::vector<char> raw(1000, 1);
+    FILE* file = std::fopen(filename.c_str(), "wb");
+    ASSERT_TRUE(file != 0);
+    std::fwrite(&raw[0], 1, raw.size(), file);
+    std::fclose(file);
+    Chunked_Capture_Reader reader;
+    EXPECT_FALSE(reader.open(filename));
+    EXPECT_FALSE(reader.open("./no_such_file.ccap"));
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,114 @@
+/*!
+ * \file crc24q_test.cc
+ * \brief Tests of the slice-by-8 CRC-24Q
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <bitset>
+#include <cstdlib>
+#include <vector>
+#include <boost/crc.hpp>
+#include <gtest/gtest.h>
+#include "crc24q.h"
+
+
+TEST(Crc24qTest, MatchesBoostCrc)
+{
+    typedef boost::crc_optimal<24, 0x1864CFBu, 0x0, 0x0, false, false> boost_crc24q;
+    std::vector<unsigned char> data(300);
+    for (unsigned int i = 0; i < data.size(); i++)
+        {
+            data[i] = static_cast<unsigned char>(std::rand());
+        }
+    // lengths on both sides of the eight byte blocks
+    for (unsigned int n = 0; n < data.size(); n += 7)
+        {
+            boost_crc24q reference;
+            reference.process_bytes(data.data(), n);
+            EXPECT_EQ(reference.checksum(), crc24q(data.data(), n)) << n << " bytes";
+        }
+}
+
+
+TEST(Crc24qTest, Incremental)
+{
+    std::vector<unsigned char> data(61);
+    for (unsigned int i = 0; i < data.size(); i++)
+        {
+            data[i] = static_cast<unsigned char>(std::rand());
+        }
+    unsigned int one_shot = crc24q(data.data(), data.size());
+    for (unsigned int split = 0; split <= data.size(); split += 5)
+        {
+            Crc24q crc;
+            crc.process_bytes(data.data(), split);
+            crc.process_bytes(data.data() + split, data.size() - split);
+            EXPECT_EQ(one_shot, crc.checksum());
+        }
+    Crc24q crc;
+    crc.process_bytes(data.data(), 9);
+    crc.process_bits((static_cast<unsigned long long>(data[9]) << 16) | (data[10] << 8) | data[11], 24);
+    for (unsigned int i = 12; i < data.size(); i++)
+        {
+            crc.process_bits(data[i] >> 3, 5);
+            crc.process_bits(data[i], 3);
+        }
+    EXPECT_EQ(one_shot, crc.checksum());
+    crc.reset();
+    EXPECT_EQ(0u, crc.checksum());
+}
+
+
+TEST(Crc24qTest, GalileoPage)
+{
+    // the 196 bits of an I/NAV page are padded with four zeros in front
+    std::bitset<196> page;
+    for (unsigned int i = 0; i < page.size(); i++)
+        {
+            page[i] = std::rand() & 1;
+        }
+    unsigned char bytes[25] = { };
+    for (unsigned int i = 0; i < page.size(); i++)
+        {
+            bytes[(i + 4) / 8] |= page[195 - i] << (7 - (i + 4) % 8);
+        }
+    unsigned int crc = crc24q(page);
+    EXPECT_EQ(crc24q(bytes, sizeof(bytes)), crc);
+
+    // and the page followed by its CRC checks to zero
+    std::bitset<220> page_and_crc;
+    for (unsigned int i = 0; i < 196; i++)
+        {
+            page_and_crc[i + 24] = page[i];
+        }
+    for (unsigned int i = 0; i < 24; i++)
+        {
+            page_and_crc[i] = (crc >> i) & 1;
+        }
+    EXPECT_EQ(0u, crc24q(page_and_crc));
+}
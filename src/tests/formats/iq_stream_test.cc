@@ -0,0 +1,172 @@
+/*!
+ * \file iq_stream_test.cc
+ * \brief  This file implements tests for the I/Q streams of remote front ends
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cstdlib>
+#include <vector>
+#include <gtest/gtest.h>
+#include "iq_stream.h"
+
+
+TEST(IqStreamTest, EncodesAndDecodesEveryWidth)
+{
+    std::srand(1);
+    const unsigned int samples = 1000;
+    std::vector<float> values(2 * samples);
+    for (unsigned int n = 0; n < values.size(); n++)
+        {
+            values[n] = static_cast<float>(std::rand() % 2001 - 1000) / 100.0f;
+        }
+    const unsigned int widths[] = {2, 4, 8, 16};
+    for (unsigned int w = 0; w < 4; w++)
+        {
+            for (int compress = 0; compress < 2; compress++)
+                {
+                    unsigned int bits = widths[w];
+                    std::vector<short> levels(values.size());
+                    iq_stream_quantize(&values[0], values.size(), iq_stream_scale(bits, 5.77f), bits, &levels[0]);
+                    Iq_Stream_Header header;
+                    header.bits = bits;
+                    header.compressed = compress != 0;
+                    header.sequence = 7;
+                    header.first_sample = 7000;
+                    header.samples = samples;
+                    header.timestamp_ns = 1234567890123LL;
+                    header.gain_db = 3.5f;
+                    std::vector<unsigned char> block;
+                    iq_stream_encode(header, &levels[0], block);
+                    EXPECT_LE(block.size(), iq_stream_header_bytes + 2 * samples * bits / 8);
+
+                    Iq_Stream_Header read;
+                    ASSERT_TRUE(iq_stream_read_header(&block[0], read)) << bits << " bits";
+                    EXPECT_EQ(bits, read.bits);
+                    EXPECT_EQ(7u, read.sequence);
+                    EXPECT_EQ(7000u, read.first_sample);
+                    EXPECT_EQ(samples, read.samples);
+                    EXPECT_EQ(1234567890123LL, read.timestamp_ns);
+                    EXPECT_FLOAT_EQ(3.5f, read.gain_db);
+                    EXPECT_EQ(block.size() - iq_stream_header_bytes, read.payload_bytes);
+
+                    std::vector<char> decoded(values.size() * iq_stream_value_bytes(bits));
+                    ASSERT_TRUE(iq_stream_decode(read, &block[iq_stream_header_bytes], &decoded[0]));
+                    for (unsigned int n = 0; n < values.size(); n++)
+                        {
+                            int value = bits == 16 ? reinterpret_cast<short*>(&decoded[0])[n] : static_cast<signed char>(decoded[n]);
+                            ASSERT_EQ(levels[n], value) << bits << " bits, value " << n;
+                        }
+                }
+        }
+}
+
+
+TEST(IqStreamTest, QuantizesToTheMidRiseLevels)
+{
+    const float values[] = {0.1f, -0.1f, 2.5f, -2.5f, 100.0f, -100.0f};
+    short levels[6];
+    iq_stream_quantize(values, 6, 1.0f, 2, levels);
+    const short expected_2bit[] = {1, -1, 3, -3, 3, -3};
+    for (unsigned int n = 0; n < 6; n++)
+        {
+            EXPECT_EQ(expected_2bit[n], levels[n]);
+        }
+    iq_stream_quantize(values, 6, 1.0f, 8, levels);
+    const short expected_8bit[] = {0, 0, 3, -3, 100, -100};
+    for (unsigned int n = 0; n < 6; n++)
+        {
+            EXPECT_EQ(expected_8bit[n], levels[n]);
+        }
+    // a corrupted header is rejected
+    std::vector<short> zeros(8, 1);
+    Iq_Stream_Header header = Iq_Stream_Header();
+    header.bits = 2;
+    header.samples = 4;
+    std::vector<unsigned char> block;
+    iq_stream_encode(header, &zeros[0], block);
+    Iq_Stream_Header read;
+    EXPECT_TRUE(iq_stream_read_header(&block[0], read));
+    block[5] = 3;
+    EXPECT_FALSE(iq_stream_read_header(&block[0], read));
+}
+
+
+TEST(IqStreamTest, JitterBufferReordersAndFillsGaps)
+{
+    Iq_Jitter_Buffer buffer(300);
+    std::vector<unsigned char> block;
+    Iq_Stream_Header header = Iq_Stream_Header();
+    header.bits = 8;
+    header.samples = 100;
+    unsigned long long gap = 0;
+
+    // blocks 1, 0, 3, 4: block 2 is lost
+    const unsigned int order[] = {1, 0, 3, 4};
+    for (unsigned int k = 0; k < 4; k++)
+        {
+            header.sequence = order[k];
+            header.first_sample = 100 * order[k];
+            block.assign(1, static_cast<unsigned char>(order[k]));
+            EXPECT_TRUE(buffer.push(header, block));
+            if (k < 2)
+                {
+                    // the buffer is still filling
+                    EXPECT_FALSE(buffer.pop(header, block, gap));
+                }
+        }
+    EXPECT_EQ(400u, buffer.buffered_samples());
+
+    ASSERT_TRUE(buffer.pop(header, block, gap));
+    EXPECT_EQ(0u, gap);
+    EXPECT_EQ(0u, header.first_sample);
+    EXPECT_EQ(0, block[0]);
+    ASSERT_TRUE(buffer.pop(header, block, gap));
+    EXPECT_EQ(100u, header.first_sample);
+    EXPECT_EQ(1, block[0]);
+    // 200 samples buffered, less than the depth: block 2 may still come
+    EXPECT_FALSE(buffer.pop(header, block, gap));
+
+    header.sequence = 5;
+    header.first_sample = 500;
+    block.assign(1, 5);
+    EXPECT_TRUE(buffer.push(header, block));
+    ASSERT_TRUE(buffer.pop(header, block, gap));
+    EXPECT_EQ(100u, gap);
+    EXPECT_TRUE(block.empty());
+    EXPECT_EQ(100u, buffer.lost_samples());
+    ASSERT_TRUE(buffer.pop(header, block, gap));
+    EXPECT_EQ(300u, header.first_sample);
+    EXPECT_EQ(400u, buffer.next_sample());
+
+    // block 2 arrives too late
+    header.sequence = 2;
+    header.first_sample = 200;
+    block.assign(1, 2);
+    EXPECT_FALSE(buffer.push(header, block));
+    EXPECT_EQ(1u, buffer.late_blocks());
+}
@@ -0,0 +1,190 @@
+/*!
+ * \file pvt_log_test.cc
+ * \brief  This file implements tests for the binary PVT log writer and reader
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "pvt_log.h"
+#include "pvt_solution.h"
+
+
+TEST(PvtLogTest, ReadsBackTheRecordsInOrder)
+{
+    std::string filename = "./pvt_log_test.dat";
+    const unsigned int n_epochs = 500;
+    {
+        Pvt_Log_Writer writer(1000); // not a multiple of the record sizes
+        ASSERT_TRUE(writer.open(filename));
+        Pvt_Solution solution;
+        std::map<int, Gnss_Synchro> observables;
+        Gnss_Synchro synchro;
+        synchro.System = 'G';
+        synchro.Signal[0] = '1'; synchro.Signal[1] = 'C'; synchro.Signal[2] = '\0';
+        for (unsigned int n = 0; n < n_epochs; n++)
+            {
+                solution.d_latitude_d = 41.0 + 1e-6 * n;
+                solution.d_longitude_d = 2.0;
+                solution.d_height_m = 100.0 + n;
+                solution.d_position_UTC_time = boost::posix_time::ptime(boost::gregorian::date(2015, 9, 1), boost::posix_time::milliseconds(100 * n));
+                solution.b_valid_position = true;
+                solution.d_valid_observations = 5;
+                writer.write_solution(solution, 0.1 * n);
+                observables.clear();
+                for (unsigned int prn = 1; prn < 4; prn++)
+                    {
+                        synchro.PRN = prn;
+                        synchro.Pseudorange_m = 2e7 + n + prn;
+                        observables[prn] = synchro;
+                    }
+                writer.write_observables(observables, 0.1 * n);
+            }
+        Spoofing_Message msg;
+        msg.spoofing_case = 7;
+        msg.satellites.insert(3);
+        msg.description = "RAIM";
+        writer.write_alarm(msg);
+        writer.close();
+    }
+
+    Pvt_Log_Reader reader;
+    ASSERT_TRUE(reader.open(filename));
+    unsigned int n_solutions = 0;
+    unsigned int n_observables = 0;
+    unsigned int n_alarms = 0;
+    const Pvt_Log_Record_Header* record;
+    while ((record = reader.next()) != 0)
+        {
+            const Pvt_Log_Solution* fix = Pvt_Log_Reader::as<Pvt_Log_Solution>(record, PVT_LOG_SOLUTION);
+            const Pvt_Log_Observable* obs = Pvt_Log_Reader::as<Pvt_Log_Observable>(record, PVT_LOG_OBSERVABLE);
+            const Pvt_Log_Alarm* alarm = Pvt_Log_Reader::as<Pvt_Log_Alarm>(record, PVT_LOG_ALARM);
+            if (fix != 0)
+                {
+                    ASSERT_EQ(100.0 + n_solutions, fix->height_m);
+                    ASSERT_EQ(1, fix->valid_position);
+                    ASSERT_EQ(1441065600000000LL + 100000LL * n_solutions, fix->utc_time_us);
+                    n_solutions++;
+                }
+            if (obs != 0)
+                {
+                    // three satellites per epoch, after the solution of the epoch
+                    ASSERT_EQ(n_observables % 3 + 1, obs->PRN);
+                    ASSERT_EQ('G', obs->system);
+                    ASSERT_EQ(2e7 + (n_solutions - 1) + obs->PRN, obs->pseudorange_m);
+                    n_observables++;
+                }
+            if (alarm != 0)
+                {
+                    EXPECT_EQ(7, alarm->spoofing_case);
+                    EXPECT_EQ(1u, alarm->n_satellites);
+                    EXPECT_EQ(3u, alarm->satellites[0]);
+                    EXPECT_EQ(std::string("RAIM"), std::string(alarm->description));
+                    EXPECT_DOUBLE_EQ(0.1 * (n_epochs - 1), alarm->rx_time);
+                    n_alarms++;
+                }
+        }
+    EXPECT_EQ(n_epochs, n_solutions);
+    EXPECT_EQ(3 * n_epochs, n_observables);
+    EXPECT_EQ(1u, n_alarms);
+    std::remove(filename.c_str());
+}
+
+
+TEST(PvtLogTest, StopsAtATruncatedRecord)
+{
+    std::string filename = "./pvt_log_truncated_test.dat";
+    {
+        Pvt_Log_Writer writer;
+        ASSERT_TRUE(writer.open(filename));
+        Spoofing_Message msg;
+        msg.spoofing_case = 1;
+        writer.write_alarm(msg);
+        writer.write_alarm(msg);
+        writer.close();
+    }
+    {
+        // cut the second record, as if the receiver had been killed while writing it
+        std::ifstream in(filename.c_str(), std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        std::ofstream out(filename.c_str(), std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), contents.size() - 10);
+    }
+    Pvt_Log_Reader reader;
+    ASSERT_TRUE(reader.open(filename));
+    EXPECT_TRUE(Pvt_Log_Reader::as<Pvt_Log_Alarm>(reader.next(), PVT_LOG_ALARM) != 0);
+    EXPECT_TRUE(reader.next() == 0);
+    std::remove(filename.c_str());
+
+    EXPECT_FALSE(reader.open("./no_such_pvt_log.dat"));
+}
+
+
+TEST(PvtLogTest, MergesOverlappingSegments)
+{
+    // two segments: 0 to 10 s, and 6 s to 20 s, whose first 4 s are the warm-up overlap
+    std::vector<std::string> segments = {"./pvt_log_segment_0.dat", "./pvt_log_segment_1.dat"};
+    double start[2] = {0.0, 6.0};
+    double end[2] = {10.0, 20.0};
+    Pvt_Solution solution;
+    for (unsigned int s = 0; s < 2; s++)
+        {
+            Pvt_Log_Writer writer;
+            ASSERT_TRUE(writer.open(segments[s]));
+            for (double rx_time = start[s]; rx_time < end[s]; rx_time += 1.0)
+                {
+                    solution.d_height_m = 100.0 * s;
+                    writer.write_solution(solution, rx_time);
+                }
+            writer.close();
+        }
+    std::string filename = "./pvt_log_merged_test.dat";
+    EXPECT_EQ(20, pvt_log_merge(segments, filename));
+
+    Pvt_Log_Reader reader;
+    ASSERT_TRUE(reader.open(filename));
+    double rx_time = 0.0;
+    const Pvt_Log_Solution* fix;
+    while ((fix = Pvt_Log_Reader::as<Pvt_Log_Solution>(reader.next(), PVT_LOG_SOLUTION)) != 0)
+        {
+            EXPECT_EQ(rx_time, fix->rx_time);
+            EXPECT_EQ(rx_time < 10.0 ? 0.0 : 100.0, fix->height_m);
+            rx_time += 1.0;
+        }
+    EXPECT_EQ(20.0, rx_time);
+    std::remove(filename.c_str());
+    std::remove(segments[0].c_str());
+    std::remove(segments[1].c_str());
+}
@@ -0,0 +1,120 @@
+/*!
+ * \file pvt_telemetry_test.cc
+ * \brief  This file implements tests for the UDP telemetry of the PVT block
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <cstring>
+#include <map>
+#include <vector>
+#include <boost/asio.hpp>
+#include <gtest/gtest.h>
+#include "pvt_solution.h"
+#include "pvt_telemetry.h"
+
+
+TEST(PvtTelemetryTest, SendsTheDecimatedEpochsAndTheAlarms)
+{
+    boost::asio::io_service io_service;
+    boost::asio::ip::udp::socket listener(io_service, boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    unsigned short port = listener.local_endpoint().port();
+
+    Pvt_Telemetry_Publisher publisher;
+    ASSERT_TRUE(publisher.open("127.0.0.1", port, 2));
+    Pvt_Solution solution;
+    solution.d_latitude_d = 41.0;
+    solution.b_valid_position = true;
+    std::map<int, Gnss_Synchro> observables;
+    Gnss_Synchro synchro;
+    std::memset(&synchro, 0, sizeof(synchro));
+    synchro.System = 'G';
+    for (unsigned int uid = 0; uid < 40; uid++) // more channels than fit in a datagram
+        {
+            synchro.PRN = 1 + uid % 4;
+            synchro.peak = 1 + uid / 4;
+            synchro.uid = uid;
+            synchro.CN0_dB_hz = 40.0 + uid;
+            observables[uid] = synchro;
+        }
+    for (unsigned int n = 0; n < 3; n++)
+        {
+            publisher.publish_epoch(solution, observables, 0.5 * n);
+        }
+    Spoofing_Message msg;
+    msg.spoofing_case = 2;
+    msg.satellites.insert(4);
+    msg.description = "APT";
+    publisher.publish_alarm(msg);
+    EXPECT_EQ(0u, publisher.dropped_datagrams());
+
+    std::vector<char> datagram(65536);
+    unsigned int solutions = 0;
+    unsigned int channels = 0;
+    unsigned int alarms = 0;
+    for (uint32_t sequence = 0; sequence < 5; sequence++)
+        {
+            std::size_t bytes = listener.receive(boost::asio::buffer(datagram));
+            ASSERT_GE(bytes, sizeof(Pvt_Telemetry_Header));
+            ASSERT_LE(bytes, 1472u);
+            const Pvt_Telemetry_Header* header = reinterpret_cast<const Pvt_Telemetry_Header*>(&datagram[0]);
+            EXPECT_EQ(0, std::memcmp(header->magic, "GSPT", 4));
+            EXPECT_EQ(sequence, header->sequence);
+            std::size_t offset = sizeof(Pvt_Telemetry_Header);
+            while (offset < bytes)
+                {
+                    const Pvt_Log_Record_Header* record = reinterpret_cast<const Pvt_Log_Record_Header*>(&datagram[offset]);
+                    if (const Pvt_Log_Solution* s = Pvt_Log_Reader::as<Pvt_Log_Solution>(record, PVT_LOG_SOLUTION))
+                        {
+                            EXPECT_EQ(solutions, s->rx_time); // epochs 0 and 2
+                            EXPECT_EQ(41.0, s->latitude_d);
+                            solutions++;
+                        }
+                    else if (const Pvt_Log_Channel* c = Pvt_Log_Reader::as<Pvt_Log_Channel>(record, PVT_LOG_CHANNEL))
+                        {
+                            EXPECT_EQ(channels % 40, c->uid);
+                            EXPECT_EQ(1 + c->uid / 4, c->peak);
+                            EXPECT_EQ(40.0 + c->uid, c->CN0_dB_hz);
+                            channels++;
+                        }
+                    else if (const Pvt_Log_Alarm* a = Pvt_Log_Reader::as<Pvt_Log_Alarm>(record, PVT_LOG_ALARM))
+                        {
+                            EXPECT_EQ(2, a->spoofing_case);
+                            EXPECT_EQ(1.0, a->rx_time);
+                            EXPECT_STREQ("APT", a->description);
+                            alarms++;
+                        }
+                    offset += record->length;
+                }
+            EXPECT_EQ(bytes, offset);
+        }
+    EXPECT_EQ(2u, solutions);
+    EXPECT_EQ(80u, channels);
+    EXPECT_EQ(1u, alarms);
+}
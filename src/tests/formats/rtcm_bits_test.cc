@@ -0,0 +1,96 @@
+/*!
+ * \file rtcm_bits_test.cc
+ * \brief  This file implements tests for the packed RTCM bit writer, reader and CRC-24Q
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <bitset>
+#include <string>
+#include <gtest/gtest.h>
+#include "crc24q.h"
+#include "rtcm_bits.h"
+
+
+TEST(RtcmBitsTest, WriterPacksMostSignificantBitFirst)
+{
+    Rtcm_Bit_Writer writer;
+    writer.put(0xD3, 8);
+    writer.put(0, 6);
+    writer.put(19, 10);
+    writer.put(std::bitset<3>("101"));
+    EXPECT_EQ(27u, writer.size_bits());
+    writer.pad_to_byte();
+    ASSERT_EQ(4u, writer.size_bytes());
+    EXPECT_EQ(0xD3, writer.data()[0]);
+    EXPECT_EQ(0x00, writer.data()[1]);
+    EXPECT_EQ(0x13, writer.data()[2]);
+    EXPECT_EQ(0xA0, writer.data()[3]);
+
+    // bitsets longer than 64 bits, and strings of symbols, give the same bytes
+    std::bitset<101> field;
+    for (unsigned int i = 0; i < 101; i += 3)
+        {
+            field[i] = true;
+        }
+    Rtcm_Bit_Writer from_bitset;
+    from_bitset.put(field);
+    Rtcm_Bit_Writer from_symbols;
+    from_symbols.put_bin(field.to_string());
+    ASSERT_EQ(from_symbols.size_bytes(), from_bitset.size_bytes());
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(from_symbols.data()), from_symbols.size_bytes()),
+              std::string(reinterpret_cast<const char*>(from_bitset.data()), from_bitset.size_bytes()));
+}
+
+
+TEST(RtcmBitsTest, ReaderReturnsTheWrittenFields)
+{
+    Rtcm_Bit_Writer writer;
+    writer.put(1005, 12);
+    writer.put(1, 1);
+    writer.put(static_cast<unsigned long long>(-11147045999LL), 38);
+    writer.put(0x123456789ULL, 40);
+    Rtcm_Bit_Reader reader(writer.data(), writer.size_bytes());
+    EXPECT_EQ(1005u, reader.get(12));
+    EXPECT_EQ(1u, reader.get(1));
+    EXPECT_EQ(-11147045999LL, reader.get_signed(38));
+    EXPECT_EQ(0x123456789ULL, reader.get(40));
+    EXPECT_FALSE(reader.overrun());
+    reader.get(16);
+    EXPECT_TRUE(reader.overrun());
+}
+
+
+TEST(RtcmBitsTest, Crc24q)
+{
+    // MT1005 example frame of RTCM 10403.2, its parity is in the last three bytes
+    const unsigned char frame[] = {0xD3, 0x00, 0x13, 0x3E, 0xD7, 0xD3, 0x02, 0x02, 0x98, 0x0E, 0xDE, 0xEF,
+            0x34, 0xB4, 0xBD, 0x62, 0xAC, 0x09, 0x41, 0x98, 0x6F, 0x33, 0x36, 0x0B, 0x98};
+    EXPECT_EQ(0x360B98u, crc24q(frame, sizeof(frame) - 3));
+    // and the CRC of a frame that includes its parity is zero
+    EXPECT_EQ(0u, crc24q(frame, sizeof(frame)));
+}
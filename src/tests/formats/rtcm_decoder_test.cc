@@ -0,0 +1,275 @@
+/*!
+ * \file rtcm_decoder_test.cc
+ * \brief This file implements tests for the in place RTCM decoder and the
+ * differential corrections computed from it
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include "dgps_corrections.h"
+#include "rtcm.h"
+#include "rtcm_decoder.h"
+
+
+namespace
+{
+const unsigned char* bytes(const std::string & message)
+{
+    return reinterpret_cast<const unsigned char*>(message.data());
+}
+
+Gnss_Synchro rtcm_decoder_synchro(char system, const char* signal, unsigned int prn, double pseudorange_m, double cn0_db_hz)
+{
+    Gnss_Synchro synchro = Gnss_Synchro();
+    synchro.System = system;
+    std::memcpy(synchro.Signal, signal, 3);
+    synchro.PRN = prn;
+    synchro.Pseudorange_m = pseudorange_m;
+    synchro.CN0_dB_hz = cn0_db_hz;
+    return synchro;
+}
+}
+
+
+TEST(Rtcm_Decoder_Test, FramesAStreamInPlace)
+{
+    auto rtcm = std::make_shared<Rtcm>();
+    std::string mt1005 = rtcm->print_MT1005(1234, 4789032.6423, 176595.0436, 4195013.3344, true, false, true, false, false, 0);
+    // garbage, a preamble inside it, a frame with a bad CRC, two good frames and half of another
+    std::string bad = mt1005;
+    bad[bad.length() - 1] ^= 0x01;
+    std::string stream = std::string("abc\xD3\xFF", 5) + bad + mt1005 + mt1005 + mt1005.substr(0, 10);
+
+    Rtcm_Decoder decoder;
+    std::size_t position = 0;
+    int frames = 0;
+    while (position < stream.length())
+        {
+            std::size_t frame_bytes;
+            Rtcm_Decoder::Frame_Status status = decoder.frame(bytes(stream) + position, stream.length() - position, frame_bytes);
+            if (status == Rtcm_Decoder::NEED_MORE)
+                {
+                    break;
+                }
+            if (status == Rtcm_Decoder::FRAME)
+                {
+                    EXPECT_EQ(mt1005.length(), frame_bytes);
+                    EXPECT_EQ(1005u, Rtcm_Decoder::message_type(bytes(stream) + position, frame_bytes));
+                    frames++;
+                }
+            position += frame_bytes;
+        }
+    EXPECT_EQ(2, frames);
+    EXPECT_EQ(stream.length() - 10, position);
+    EXPECT_EQ(1u, decoder.crc_errors());
+}
+
+
+TEST(Rtcm_Decoder_Test, DecodesTheStationPosition)
+{
+    auto rtcm = std::make_shared<Rtcm>();
+    std::string mt1006 = rtcm->print_MT1006(2003, 1114104.5999, -4850729.7108, 3975521.4643, true, false, false, false, false, 0, 1.234);
+    Rtcm_Decoder decoder;
+    std::size_t frame_bytes;
+    ASSERT_EQ(Rtcm_Decoder::FRAME, decoder.frame(bytes(mt1006), mt1006.length(), frame_bytes));
+    Rtcm_Corrections corrections;
+    ASSERT_TRUE(decoder.decode(bytes(mt1006), frame_bytes, corrections));
+    EXPECT_EQ(Rtcm_Corrections::STATION, corrections.content);
+    EXPECT_EQ(2003u, corrections.station.station_id);
+    EXPECT_NEAR(1114104.5999, corrections.station.ecef_x_m, 1e-4);
+    EXPECT_NEAR(-4850729.7108, corrections.station.ecef_y_m, 1e-4);
+    EXPECT_NEAR(3975521.4643, corrections.station.ecef_z_m, 1e-4);
+    EXPECT_NEAR(1.234, corrections.station.antenna_height_m, 1e-4);
+}
+
+
+TEST(Rtcm_Decoder_Test, DecodesMT1002)
+{
+    auto rtcm = std::make_shared<Rtcm>();
+    std::map<int, Gnss_Synchro> pseudoranges;
+    pseudoranges[1] = rtcm_decoder_synchro('G', "1C", 2, 20000123.45, 45.25);
+    pseudoranges[2] = rtcm_decoder_synchro('G', "1C", 17, 24123456.78, 38.5);
+    std::string mt1002 = rtcm->print_MT1002(Gps_Ephemeris(), 25.0, pseudoranges, 1234);
+
+    Rtcm_Decoder decoder;
+    std::size_t frame_bytes;
+    ASSERT_EQ(Rtcm_Decoder::FRAME, decoder.frame(bytes(mt1002), mt1002.length(), frame_bytes));
+    Rtcm_Corrections corrections;
+    ASSERT_TRUE(decoder.decode(bytes(mt1002), frame_bytes, corrections));
+    ASSERT_EQ(Rtcm_Corrections::OBSERVATIONS, corrections.content);
+    EXPECT_EQ('G', corrections.epoch.system);
+    EXPECT_EQ(1002u, corrections.epoch.message_type);
+    EXPECT_EQ(1234u, corrections.epoch.station_id);
+    EXPECT_DOUBLE_EQ(25.0, corrections.epoch.tow_s);
+    ASSERT_EQ(2u, corrections.epoch.count);
+    EXPECT_EQ(2u, corrections.epoch.observations[0].prn);
+    EXPECT_TRUE(corrections.epoch.observations[0].ambiguity_known);
+    EXPECT_NEAR(20000123.45, corrections.epoch.observations[0].pseudorange_m, 0.01);
+    EXPECT_DOUBLE_EQ(45.25, corrections.epoch.observations[0].cn0_db_hz);
+    EXPECT_EQ(17u, corrections.epoch.observations[1].prn);
+    EXPECT_NEAR(24123456.78, corrections.epoch.observations[1].pseudorange_m, 0.01);
+}
+
+
+TEST(Rtcm_Decoder_Test, DecodesTheL1CodeOfTheMsm)
+{
+    auto rtcm = std::make_shared<Rtcm>();
+    std::map<int, Gnss_Synchro> pseudoranges;
+    pseudoranges[1] = rtcm_decoder_synchro('G', "1C", 4, 20001010.0, 44.0);
+    pseudoranges[2] = rtcm_decoder_synchro('G', "2S", 4, 20001013.0, 40.0);
+    pseudoranges[3] = rtcm_decoder_synchro('G', "1C", 32, 24002020.0, 41.0);
+    Gps_Ephemeris gps_eph = Gps_Ephemeris();
+    gps_eph.i_satellite_PRN = 4;
+
+    Rtcm_Decoder decoder;
+    Rtcm_Corrections corrections;
+    std::size_t frame_bytes;
+    std::string msm4 = rtcm->print_MSM_4(gps_eph, {}, {}, 25.0, pseudoranges, 1234, 0, 0, 0, false, false);
+    ASSERT_EQ(Rtcm_Decoder::FRAME, decoder.frame(bytes(msm4), msm4.length(), frame_bytes));
+    ASSERT_TRUE(decoder.decode(bytes(msm4), frame_bytes, corrections));
+    ASSERT_EQ(Rtcm_Corrections::OBSERVATIONS, corrections.content);
+    EXPECT_EQ(1074u, corrections.epoch.message_type);
+    ASSERT_EQ(2u, corrections.epoch.count);
+    EXPECT_EQ(4u, corrections.epoch.observations[0].prn);
+    EXPECT_TRUE(corrections.epoch.observations[0].ambiguity_known);
+    EXPECT_NEAR(20001010.0, corrections.epoch.observations[0].pseudorange_m, 0.01);
+    EXPECT_DOUBLE_EQ(44.0, corrections.epoch.observations[0].cn0_db_hz);
+    EXPECT_EQ(32u, corrections.epoch.observations[1].prn);
+    EXPECT_NEAR(24002020.0, corrections.epoch.observations[1].pseudorange_m, 0.01);
+
+    // MSM1 leaves out the whole milliseconds
+    std::string msm1 = rtcm->print_MSM_1(gps_eph, {}, {}, 25.0, pseudoranges, 1234, 0, 0, 0, false, false);
+    ASSERT_EQ(Rtcm_Decoder::FRAME, decoder.frame(bytes(msm1), msm1.length(), frame_bytes));
+    ASSERT_TRUE(decoder.decode(bytes(msm1), frame_bytes, corrections));
+    ASSERT_EQ(2u, corrections.epoch.count);
+    EXPECT_FALSE(corrections.epoch.observations[0].ambiguity_known);
+    const double light_ms_m = GPS_C_m_s * 1e-3;
+    double fraction_m = std::fmod(corrections.epoch.observations[0].pseudorange_m - 20001010.0, light_ms_m);
+    EXPECT_NEAR(0.0, std::fabs(fraction_m) < light_ms_m / 2.0 ? fraction_m : light_ms_m - std::fabs(fraction_m), 0.01);
+
+    // the high resolution pseudoranges of Galileo
+    std::map<int, Gnss_Synchro> galileo;
+    galileo[1] = rtcm_decoder_synchro('E', "1B", 11, 23456789.012, 42.5);
+    Galileo_Ephemeris gal_eph = Galileo_Ephemeris();
+    gal_eph.i_satellite_PRN = 11;
+    std::string msm7 = rtcm->print_MSM_7({}, {}, gal_eph, 25.0, galileo, 1234, 0, 0, 0, false, false);
+    ASSERT_EQ(Rtcm_Decoder::FRAME, decoder.frame(bytes(msm7), msm7.length(), frame_bytes));
+    ASSERT_TRUE(decoder.decode(bytes(msm7), frame_bytes, corrections));
+    EXPECT_EQ('E', corrections.epoch.system);
+    EXPECT_EQ(1097u, corrections.epoch.message_type);
+    ASSERT_EQ(1u, corrections.epoch.count);
+    EXPECT_EQ(11u, corrections.epoch.observations[0].prn);
+    EXPECT_NEAR(23456789.012, corrections.epoch.observations[0].pseudorange_m, 0.001);
+}
+
+
+TEST(Rtcm_Decoder_Test, ReadsTheEphemeris)
+{
+    auto rtcm = std::make_shared<Rtcm>();
+    Gps_Ephemeris gps_eph = Gps_Ephemeris();
+    gps_eph.i_satellite_PRN = 3;
+    gps_eph.d_IODC = 4;
+    gps_eph.d_e_eccentricity = 2.0 * E_LSB;
+    gps_eph.d_sqrt_A = 5153.6;
+    gps_eph.d_M_0 = -1.5;
+    gps_eph.b_fit_interval_flag = true;
+    std::string mt1019 = rtcm->print_MT1019(gps_eph);
+
+    Gps_Ephemeris expected = Gps_Ephemeris();
+    ASSERT_EQ(0, rtcm->read_MT1019(mt1019, expected));
+    Gps_Ephemeris read = Gps_Ephemeris();
+    ASSERT_TRUE(Rtcm_Decoder::read_ephemeris(bytes(mt1019), mt1019.length(), read));
+    EXPECT_EQ(expected.i_satellite_PRN, read.i_satellite_PRN);
+    EXPECT_DOUBLE_EQ(expected.d_IODC, read.d_IODC);
+    EXPECT_DOUBLE_EQ(expected.d_e_eccentricity, read.d_e_eccentricity);
+    EXPECT_DOUBLE_EQ(expected.d_sqrt_A, read.d_sqrt_A);
+    EXPECT_DOUBLE_EQ(expected.d_M_0, read.d_M_0);
+    EXPECT_EQ(expected.b_fit_interval_flag, read.b_fit_interval_flag);
+}
+
+
+TEST(Rtcm_Decoder_Test, CorrectionsDoNotNeedTheWholeMilliseconds)
+{
+    Gps_Ephemeris eph = Gps_Ephemeris();
+    eph.i_satellite_PRN = 5;
+    eph.d_sqrt_A = 5153.6;
+    eph.d_e_eccentricity = 0.01;
+    eph.d_i_0 = 0.96;
+    eph.d_Toe = 0.0;
+    eph.d_Toc = 0.0;
+    eph.d_A_f0 = 1e-5;
+
+    Rtcm_Corrections station;
+    station.content = Rtcm_Corrections::STATION;
+    station.station = Rtcm_Reference_Station();
+    station.station.station_id = 7;
+    station.station.ecef_x_m = 4789032.6423;
+    station.station.ecef_y_m = 176595.0436;
+    station.station.ecef_z_m = 4195013.3344;
+
+    Rtcm_Corrections observations;
+    observations.content = Rtcm_Corrections::OBSERVATIONS;
+    observations.epoch.system = 'G';
+    observations.epoch.message_type = 1002;
+    observations.epoch.station_id = 7;
+    observations.epoch.tow_s = 100.0;
+    observations.epoch.count = 1;
+    Rtcm_Observation & obs = observations.epoch.observations[0];
+    obs.prn = 5;
+    obs.pseudorange_m = 21234567.891;
+    obs.ambiguity_known = true;
+
+    Dgps_Corrections dgps;
+    dgps.set_max_age(5.0);
+    dgps.update(station);
+    dgps.update(observations);
+    double known_m = 0.0;
+    ASSERT_TRUE(dgps.correction('G', 5, eph, 101.0, known_m));
+    // a pseudorange of the same whole milliseconds as the geometric range
+    obs.pseudorange_m += known_m - 3.0;
+    dgps.update(observations);
+    ASSERT_TRUE(dgps.correction('G', 5, eph, 101.0, known_m));
+    EXPECT_NEAR(3.0, known_m, 10.0);
+
+    obs.pseudorange_m = std::fmod(obs.pseudorange_m, GPS_C_m_s * 1e-3);
+    obs.ambiguity_known = false;
+    dgps.update(observations);
+    double unknown_m = 0.0;
+    ASSERT_TRUE(dgps.correction('G', 5, eph, 101.0, unknown_m));
+    EXPECT_NEAR(known_m, unknown_m, 1e-6);
+
+    double correction_m;
+    EXPECT_FALSE(dgps.correction('G', 6, eph, 101.0, correction_m));
+    EXPECT_FALSE(dgps.correction('E', 5, eph, 101.0, correction_m));
+    EXPECT_FALSE(dgps.correction('G', 5, eph, 106.0, correction_m));
+}
@@ -597,5 +597,29 @@ TEST(Rtcm_Test, InstantiateServerWithoutClosing)
 }
 
 
+TEST(Rtcm_Test, NtripCasterAnswersTheMountpoint)
+{
+    unsigned short port = 2102;
+    auto rtcm = std::make_shared<Rtcm>(port, 2, "GNSSSDR");
+    rtcm->run_server();
 
+    boost::asio::io_service io_service;
+    boost::asio::ip::tcp::socket socket(io_service);
+    boost::system::error_code ec;
+    socket.connect(boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), port), ec);
+    ASSERT_FALSE(ec);
+    std::string request("GET /GNSSSDR HTTP/1.0\r\nUser-Agent: NTRIP GNSS-SDR test\r\n\r\n");
+    boost::asio::write(socket, boost::asio::buffer(request), ec);
+    ASSERT_FALSE(ec);
+    boost::asio::streambuf response;
+    boost::asio::read_until(socket, response, "\r\n\r\n", ec);
+    ASSERT_FALSE(ec);
+    std::istream response_stream(&response);
+    std::string status_line;
+    std::getline(response_stream, status_line);
+    EXPECT_EQ(0, status_line.compare("ICY 200 OK\r"));
+
+    socket.close();
+    rtcm->stop_server();
+}
 
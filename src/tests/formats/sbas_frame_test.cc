@@ -0,0 +1,104 @@
+/*!
+ * \file sbas_frame_test.cc
+ * \brief  This file implements tests for the packed SBAS frames and their CRC-24Q
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cstdlib>
+#include <vector>
+#include <gtest/gtest.h>
+#include "crc24q.h"
+#include "sbas_telemetry_data.h"
+
+namespace
+{
+// 226 bits of a message with preamble 0x9A, followed by their CRC-24Q
+std::vector<int> sbas_test_message(unsigned int* crc)
+{
+    std::vector<int> bits(226);
+    for (unsigned int i = 0; i < bits.size(); i++)
+        {
+            bits[i] = i < 8 ? (0x9A >> (7 - i)) & 1 : std::rand() & 1;
+        }
+    // with 6 zeros in front, the 226 bits fill 29 bytes
+    unsigned char bytes[29] = { };
+    for (unsigned int i = 0; i < bits.size(); i++)
+        {
+            bytes[(i + 6) / 8] |= bits[i] << (7 - (i + 6) % 8);
+        }
+    *crc = crc24q(bytes, sizeof(bytes));
+    for (int k = 23; k >= 0; k--)
+        {
+            bits.push_back((*crc >> k) & 1);
+        }
+    return bits;
+}
+}
+
+
+TEST(SbasFrameTest, SlidesAndChecksTheCrc)
+{
+    std::srand(5);
+    unsigned int crc = 0;
+    std::vector<int> bits = sbas_test_message(&crc);
+    Sbas_Frame frame;
+    // bits of the previous message fall out at the front
+    for (int i = 0; i < 7; i++)
+        {
+            frame.push_back(1);
+        }
+    for (unsigned int i = 0; i < bits.size(); i++)
+        {
+            EXPECT_FALSE(frame.full() and frame.crc_ok());
+            frame.push_back(bits[i]);
+        }
+    ASSERT_TRUE(frame.full());
+    EXPECT_EQ(0x9A, frame.preamble());
+    EXPECT_TRUE(frame.crc_ok());
+    EXPECT_EQ(0, frame.data()[31] & 0x3F);
+
+    Sbas_Raw_Msg msg(0.0, 120, frame.bytes());
+    EXPECT_TRUE(msg.crc_ok());
+    EXPECT_EQ(static_cast<int>(crc), msg.get_crc());
+    EXPECT_EQ(static_cast<int>((frame.data()[1] >> 2)), msg.get_msg_type());
+
+    // a PLL locked with the opposite sign
+    frame.invert();
+    EXPECT_EQ(0x65, frame.preamble());
+    EXPECT_FALSE(frame.crc_ok());
+    EXPECT_EQ(0, frame.data()[31] & 0x3F);
+    frame.invert();
+    EXPECT_TRUE(frame.crc_ok());
+
+    // shifted by one bit
+    frame.push_back(bits[0]);
+    EXPECT_FALSE(frame.crc_ok());
+    Sbas_Raw_Msg corrupted(0.0, 120, frame.bytes());
+    EXPECT_FALSE(corrupted.crc_ok());
+}
@@ -0,0 +1,113 @@
+/*!
+ * \file shared_sample_ring_test.cc
+ * \brief  This file implements tests for the shared sample rings
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include "shared_sample_ring.h"
+
+
+TEST(SharedSampleRingTest, ReceiverReadsAcrossTheEndOfTheRing)
+{
+    std::string filename = "./shared_sample_ring_test.ring";
+    Shared_Sample_Ring publisher(filename, 4, 1000, "cshort", 4e6);
+    ASSERT_TRUE(publisher.is_open());
+    unsigned long long capacity = publisher.capacity();
+    EXPECT_GE(capacity, 1000);
+    EXPECT_EQ(0, capacity & (capacity - 1));
+
+    Shared_Sample_Ring receiver(filename);
+    ASSERT_TRUE(receiver.is_open());
+    EXPECT_EQ(4, receiver.item_size());
+    EXPECT_EQ(capacity, receiver.capacity());
+    EXPECT_EQ("cshort", receiver.item_type());
+    EXPECT_DOUBLE_EQ(4e6, receiver.sampling_frequency());
+    EXPECT_EQ(0, receiver.written());
+    EXPECT_TRUE(receiver.window(0, 1) == nullptr);
+
+    // the second write wraps around the end of the ring
+    std::vector<int> items(capacity + capacity / 2);
+    for (unsigned int n = 0; n < items.size(); n++)
+        {
+            items[n] = n;
+        }
+    publisher.write(&items[0], capacity - 10);
+    publisher.write(&items[capacity - 10], 100);
+    EXPECT_EQ(capacity + 90, receiver.written());
+    EXPECT_GT(receiver.write_time_ns(), 0);
+    EXPECT_LE(receiver.start_time_ns(), receiver.write_time_ns());
+
+    const int* window = static_cast<const int*>(receiver.window(capacity - 50, 120));
+    ASSERT_TRUE(window != nullptr);
+    for (unsigned int n = 0; n < 120; n++)
+        {
+            ASSERT_EQ(static_cast<int>(capacity - 50 + n), window[n]);
+        }
+    EXPECT_TRUE(receiver.intact(capacity - 50));
+    EXPECT_FALSE(receiver.closed());
+    publisher.close();
+    EXPECT_TRUE(receiver.closed());
+}
+
+
+TEST(SharedSampleRingTest, DetectsOverwrittenWindows)
+{
+    std::string filename = "./shared_sample_ring_test.ring";
+    std::vector<short> items;
+    {
+        Shared_Sample_Ring publisher(filename, 2, 0, "short", 2e6);
+        ASSERT_TRUE(publisher.is_open());
+        Shared_Sample_Ring receiver(filename);
+        ASSERT_TRUE(receiver.is_open());
+        unsigned long long capacity = publisher.capacity();
+        items.resize(capacity);
+        publisher.write(&items[0], capacity);
+
+        // every item is still there, then the next write reuses the slots of the oldest ones
+        ASSERT_TRUE(receiver.window(0, capacity) != nullptr);
+        publisher.write(&items[0], 10);
+        EXPECT_FALSE(receiver.intact(0));
+        EXPECT_TRUE(receiver.window(0, 1) == nullptr);
+        EXPECT_TRUE(receiver.intact(10));
+        EXPECT_TRUE(receiver.window(10, capacity) != nullptr);
+        EXPECT_TRUE(receiver.window(10, capacity + 1) == nullptr);
+    }
+    // the publisher removes its file
+    EXPECT_NE(0, access(filename.c_str(), F_OK));
+    Shared_Sample_Ring gone(filename);
+    EXPECT_FALSE(gone.is_open());
+
+    // the items must be a power of two bytes long
+    Shared_Sample_Ring odd(filename, 3, 1000, "byte", 2e6);
+    EXPECT_FALSE(odd.is_open());
+}
@@ -0,0 +1,124 @@
+/*!
+ * \file track_file_writer_test.cc
+ * \brief  This file implements tests for the streaming writer of the KML
+ * and GeoJSON tracks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include "geojson_printer.h"
+#include "pvt_solution.h"
+#include "track_file_writer.h"
+
+
+namespace
+{
+std::string read_track_file(const std::string& filename)
+{
+    std::ifstream file(filename.c_str(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+}
+
+
+TEST(TrackFileWriterTest, FileIsCompleteAfterEachWrite)
+{
+    std::string filename = "./track_file_writer_test.txt";
+    Track_File_Writer writer;
+    writer.set_flush_policy(10, 1000.0);
+    ASSERT_TRUE(writer.open(filename, "[", "]\n", ","));
+    EXPECT_EQ("[]\n", read_track_file(filename));
+
+    writer.append("1234"); // less than a chunk: not written yet
+    EXPECT_EQ("[]\n", read_track_file(filename));
+    writer.append("5678");
+    writer.append("9");
+    EXPECT_EQ("[1234,5678,9]\n", read_track_file(filename));
+
+    writer.append("10");
+    EXPECT_TRUE(writer.flush());
+    EXPECT_EQ("[1234,5678,9,10]\n", read_track_file(filename));
+    EXPECT_EQ(4U, writer.records());
+
+    writer.append("11");
+    writer.close();
+    EXPECT_EQ("[1234,5678,9,10,11]\n", read_track_file(filename));
+    std::remove(filename.c_str());
+}
+
+
+TEST(TrackFileWriterTest, FlushPeriod)
+{
+    std::string filename = "./track_file_writer_test.txt";
+    Track_File_Writer writer;
+    writer.set_flush_policy(1 << 20, 0.0); // every record
+    ASSERT_TRUE(writer.open(filename, "<", ">", ";"));
+    writer.append("a");
+    EXPECT_EQ("<a>", read_track_file(filename));
+    writer.append("b");
+    EXPECT_EQ("<a;b>", read_track_file(filename));
+    writer.close();
+    std::remove(filename.c_str());
+}
+
+
+TEST(TrackFileWriterTest, GeoJsonDecimation)
+{
+    std::string basename = "./track_file_writer_test";
+    std::shared_ptr<Pvt_Solution> solution = std::make_shared<Pvt_Solution>();
+    solution->d_latitude_d = 41.0;
+    solution->d_longitude_d = 2.0;
+    solution->d_height_m = 100.0;
+    {
+        GeoJSON_Printer printer;
+        ASSERT_TRUE(printer.set_headers(basename, false));
+        printer.set_streaming(2, 0.0, 0.0);
+        for (int n = 0; n < 5; n++)
+            {
+                EXPECT_TRUE(printer.print_position(solution, false));
+            }
+        // still open, and already a complete document with the positions 0, 2 and 4
+        std::string contents = read_track_file(basename + ".geojson");
+        const std::string point = "[2.00000000000000, 41.00000000000000, 100.00000000000000]";
+        size_t points = 0;
+        for (size_t at = contents.find(point); at != std::string::npos; at = contents.find(point, at + 1))
+            {
+                points++;
+            }
+        EXPECT_EQ(3U, points);
+        EXPECT_NE(std::string::npos, contents.find(point + ",\n       " + point));
+        EXPECT_EQ("]\n   }\n}\n", contents.substr(contents.size() - 9));
+    }
+    std::remove((basename + ".geojson").c_str());
+}
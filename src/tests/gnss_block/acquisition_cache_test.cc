@@ -0,0 +1,161 @@
+/*!
+ * \file acquisition_cache_test.cc
+ * \brief  This file implements tests for the Doppler wipeoff grid and code
+ * FFT caches shared by the acquisition blocks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <gtest/gtest.h>
+#include <gnuradio/fft/fft.h>
+#include "acquisition_cache.h"
+#include "gps_sdr_signal_processing.h"
+
+
+TEST(AcquisitionCacheTest, DopplerGridIsShared)
+{
+    long fs_in = 4000000;
+    unsigned int length = 4000;
+    std::shared_ptr<const Doppler_Wipeoff_Grid> a = Acquisition_Cache::doppler_wipeoff_grid(fs_in, 0, 5000, 500, 20, length);
+    std::shared_ptr<const Doppler_Wipeoff_Grid> b = Acquisition_Cache::doppler_wipeoff_grid(fs_in, 0, 5000, 500, 20, length);
+    std::shared_ptr<const Doppler_Wipeoff_Grid> c = Acquisition_Cache::doppler_wipeoff_grid(fs_in, 0, 5000, 250, 40, length);
+
+    EXPECT_EQ(a.get(), b.get());
+    EXPECT_NE(a.get(), c.get());
+    ASSERT_EQ(20u, a->num_doppler_bins());
+    ASSERT_EQ(length, a->length());
+
+    // bin 0 is the carrier at -doppler_max, wiped off with the conjugate
+    double phase_step = 2.0 * M_PI * -5000.0 / static_cast<double>(fs_in);
+    for (unsigned int i = 0; i < 100; i++)
+        {
+            EXPECT_NEAR(std::cos(phase_step * i), a->wipeoffs()[0][i].real(), 1e-3);
+            EXPECT_NEAR(-std::sin(phase_step * i), a->wipeoffs()[0][i].imag(), 1e-3);
+        }
+}
+
+
+TEST(AcquisitionCacheTest, CodeFftIsSharedPerReplica)
+{
+    long fs_in = 4000000;
+    unsigned int fft_size = 4000;
+    std::vector<gr_complex> code(fft_size);
+    gr::fft::fft_complex fft(fft_size, true);
+
+    gps_l1_ca_code_gen_complex_sampled(&code[0], 1, fs_in, 0);
+    std::copy(code.begin(), code.end(), fft.get_inbuf());
+    std::shared_ptr<const Code_Fft> a = Acquisition_Cache::code_fft('G', "1C", 1, &fft);
+    ASSERT_EQ(fft_size, a->fft_size());
+
+    std::copy(code.begin(), code.end(), fft.get_inbuf());
+    std::shared_ptr<const Code_Fft> b = Acquisition_Cache::code_fft('G', "1C", 1, &fft);
+    EXPECT_EQ(a.get(), b.get());
+
+    // same key, different replica: must not be shared
+    std::fill_n(fft.get_inbuf(), fft_size / 2, gr_complex(0.0, 0.0));
+    std::copy(code.begin(), code.begin() + fft_size / 2, fft.get_inbuf() + fft_size / 2);
+    std::shared_ptr<const Code_Fft> c = Acquisition_Cache::code_fft('G', "1C", 1, &fft);
+    EXPECT_NE(a.get(), c.get());
+
+    // the cached FFT is the conjugate of the FFT of the replica
+    std::copy(code.begin(), code.end(), fft.get_inbuf());
+    fft.execute();
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            ASSERT_NEAR(std::conj(fft.get_outbuf()[i]).real(), a->get()[i].real(), 1e-3);
+            ASSERT_NEAR(std::conj(fft.get_outbuf()[i]).imag(), a->get()[i].imag(), 1e-3);
+        }
+}
+
+
+TEST(AcquisitionCacheTest, InputFftBatchIsSharedPerDwell)
+{
+    long fs_in = 4000000;
+    unsigned int length = 4000;
+    std::shared_ptr<const Doppler_Wipeoff_Grid> grid = Acquisition_Cache::doppler_wipeoff_grid(fs_in, 0, 1000, 500, 5, length);
+    std::vector<gr_complex> in(length);
+    gps_l1_ca_code_gen_complex_sampled(&in[0], 7, fs_in, 0);
+    gr::fft::fft_complex fft(length, true);
+
+    std::shared_ptr<const Input_Fft_Batch> a = Acquisition_Cache::input_fft_batch(grid, 4000, &in[0], &fft);
+    std::shared_ptr<const Input_Fft_Batch> b = Acquisition_Cache::input_fft_batch(grid, 4000, &in[0], &fft);
+    std::shared_ptr<const Input_Fft_Batch> c = Acquisition_Cache::input_fft_batch(grid, 8000, &in[0], &fft);
+    EXPECT_EQ(a.get(), b.get());
+    EXPECT_NE(a.get(), c.get());
+
+    for (unsigned int doppler_index = 0; doppler_index < grid->num_doppler_bins(); doppler_index++)
+        {
+            for (unsigned int i = 0; i < length; i++)
+                {
+                    fft.get_inbuf()[i] = in[i] * grid->wipeoffs()[doppler_index][i];
+                }
+            fft.execute();
+            for (unsigned int i = 0; i < length; i++)
+                {
+                    ASSERT_NEAR(fft.get_outbuf()[i].real(), a->get(doppler_index)[i].real(), 1e-2);
+                    ASSERT_NEAR(fft.get_outbuf()[i].imag(), a->get(doppler_index)[i].imag(), 1e-2);
+                }
+        }
+}
+
+
+TEST(AcquisitionCacheTest, InputFftBatchFoldsOntoSmallerFfts)
+{
+    long fs_in = 4000000;
+    unsigned int length = 16000;
+    unsigned int fft_size = 1000; // the QuickSync blocks fold 16 times with a folding factor of 4
+    std::shared_ptr<const Doppler_Wipeoff_Grid> grid = Acquisition_Cache::doppler_wipeoff_grid(fs_in, 0, 1000, 500, 5, length);
+    std::vector<gr_complex> in(length);
+    for (unsigned int i = 0; i < length; i += 4000)
+        {
+            gps_l1_ca_code_gen_complex_sampled(&in[i], 7, fs_in, 0);
+        }
+    gr::fft::fft_complex fft(length, true);
+    gr::fft::fft_complex folded_fft(fft_size, true);
+
+    std::shared_ptr<const Input_Fft_Batch> a = Acquisition_Cache::input_fft_batch(grid, 4000, &in[0], &fft);
+    std::shared_ptr<const Input_Fft_Batch> b = Acquisition_Cache::input_fft_batch(grid, 4000, &in[0], &folded_fft);
+    EXPECT_NE(a.get(), b.get());
+
+    for (unsigned int doppler_index = 0; doppler_index < grid->num_doppler_bins(); doppler_index++)
+        {
+            std::fill_n(folded_fft.get_inbuf(), fft_size, gr_complex(0.0, 0.0));
+            for (unsigned int i = 0; i < length; i++)
+                {
+                    folded_fft.get_inbuf()[i % fft_size] += in[i] * grid->wipeoffs()[doppler_index][i];
+                }
+            folded_fft.execute();
+            for (unsigned int i = 0; i < fft_size; i++)
+                {
+                    ASSERT_NEAR(folded_fft.get_outbuf()[i].real(), b->get(doppler_index)[i].real(), 1e-1);
+                    ASSERT_NEAR(folded_fft.get_outbuf()[i].imag(), b->get(doppler_index)[i].imag(), 1e-1);
+                }
+        }
+}
@@ -0,0 +1,201 @@
+/*!
+ * \file acquisition_server_test.cc
+ * \brief  This file implements tests for the shared memory link of the
+ * acquisition server and for the searches of the server
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include "acquisition_server.h"
+#include "acquisition_server_link.h"
+#include "gps_sdr_signal_processing.h"
+
+
+namespace
+{
+std::string server_test_filename()
+{
+    return "/tmp/gnss-sdr-acquisition-test-" + std::to_string(getpid());
+}
+
+Acquisition_Server_Request server_test_request(unsigned int PRN, unsigned long int sample_stamp)
+{
+    Acquisition_Server_Request request;
+    std::memset(&request, 0, sizeof(request));
+    request.sample_stamp = sample_stamp;
+    request.fs_in = 4000000;
+    request.freq = 0;
+    request.doppler_max = 5000;
+    request.doppler_step = 500;
+    request.num_doppler_bins = 20;
+    request.fft_size = 4000;
+    request.PRN = PRN;
+    request.system = 'G';
+    std::memcpy(request.signal, "1C", 3);
+    return request;
+}
+
+// 1 ms of the code of PRN, delayed by delay samples, at doppler_hz
+std::vector<gr_complex> server_test_signal(unsigned int PRN, unsigned int delay, double doppler_hz)
+{
+    std::vector<gr_complex> code(4000);
+    gps_l1_ca_code_gen_complex_sampled(&code[0], PRN, 4000000, 0);
+    std::vector<gr_complex> signal(4000);
+    for (unsigned int n = 0; n < 4000; n++)
+        {
+            double phase = 2.0 * M_PI * doppler_hz * n / 4000000.0;
+            signal[n] = code[(n + 4000 - delay) % 4000] * gr_complex(std::cos(phase), std::sin(phase));
+        }
+    return signal;
+}
+
+unsigned int best_line(const std::vector<Doppler_Line_Max>& lines)
+{
+    unsigned int best = 0;
+    for (unsigned int doppler_index = 1; doppler_index < lines.size(); doppler_index++)
+        {
+            if (lines[best].mag < lines[doppler_index].mag) best = doppler_index;
+        }
+    return best;
+}
+}
+
+
+TEST(AcquisitionServerTest, SlotLifecycle)
+{
+    std::string filename = server_test_filename();
+    EXPECT_FALSE(Acquisition_Server_Link(filename).is_open());
+
+    Acquisition_Server_Link server(filename, 2, 4000, 20);
+    ASSERT_TRUE(server.is_open());
+    Acquisition_Server_Link receiver(filename);
+    ASSERT_TRUE(receiver.is_open());
+    EXPECT_EQ(2u, receiver.num_slots());
+    EXPECT_EQ(4000u, receiver.max_samples());
+    EXPECT_EQ(20u, receiver.max_doppler_bins());
+
+    std::vector<gr_complex> samples(4000, gr_complex(1.0, 0.0));
+    std::vector<gr_complex> code(4000, gr_complex(0.0, 1.0));
+    Acquisition_Server_Request request = server_test_request(3, 8000);
+    int slot = receiver.submit(request, &samples[0], &code[0]);
+    ASSERT_EQ(0, slot);
+    EXPECT_EQ(1, receiver.submit(request, &samples[0], &code[0]));
+    EXPECT_EQ(-1, receiver.submit(request, &samples[0], &code[0])); // all busy
+    receiver.cancel(1);
+
+    // a request that does not fit
+    Acquisition_Server_Request too_long = server_test_request(3, 8000);
+    too_long.fft_size = 8000;
+    EXPECT_EQ(-1, receiver.submit(too_long, &samples[0], &code[0]));
+
+    std::vector<Doppler_Line_Max> lines(20);
+    EXPECT_FALSE(receiver.poll(slot, &lines[0]));
+    ASSERT_EQ(static_cast<unsigned int>(ACQ_SLOT_SUBMITTED), server.state(slot));
+    EXPECT_EQ(static_cast<unsigned int>(ACQ_SLOT_FREE), server.state(1));
+    ASSERT_TRUE(server.take(slot));
+    EXPECT_FALSE(server.take(slot));
+    EXPECT_EQ(8000u, server.request(slot).sample_stamp);
+    EXPECT_EQ(3u, server.request(slot).PRN);
+    EXPECT_EQ(gr_complex(1.0, 0.0), server.samples(slot)[3999]);
+    EXPECT_EQ(gr_complex(0.0, 1.0), server.code(slot)[3999]);
+    for (unsigned int doppler_index = 0; doppler_index < 20; doppler_index++)
+        {
+            server.lines(slot)[doppler_index].mag = doppler_index;
+            server.lines(slot)[doppler_index].index = 7;
+        }
+    EXPECT_FALSE(receiver.poll(slot, &lines[0]));
+    server.complete(slot);
+    ASSERT_TRUE(receiver.poll(slot, &lines[0]));
+    EXPECT_EQ(19u, best_line(lines));
+    EXPECT_EQ(7u, lines[19].index);
+    EXPECT_EQ(static_cast<unsigned int>(ACQ_SLOT_FREE), server.state(slot));
+
+    // cancelled while searching: freed by the server
+    slot = receiver.submit(request, &samples[0], &code[0]);
+    ASSERT_TRUE(server.take(slot));
+    receiver.cancel(slot);
+    EXPECT_EQ(static_cast<unsigned int>(ACQ_SLOT_CANCELLED), server.state(slot));
+    server.complete(slot);
+    EXPECT_EQ(static_cast<unsigned int>(ACQ_SLOT_FREE), server.state(slot));
+    EXPECT_EQ(0u, server.reclaim());
+}
+
+
+TEST(AcquisitionServerTest, BatchOfTwoReceivers)
+{
+    std::string filename = server_test_filename();
+    std::shared_ptr<Acquisition_Server_Link> link = std::make_shared<Acquisition_Server_Link>(filename, 8, 4000, 20);
+    ASSERT_TRUE(link->is_open());
+    Acquisition_Server server(link, false, 32);
+    EXPECT_EQ(0u, server.run_once(0, 0));
+
+    Acquisition_Server_Link receiver_a(filename);
+    Acquisition_Server_Link receiver_b(filename);
+    std::vector<gr_complex> code_7(4000);
+    std::vector<gr_complex> code_9(4000);
+    gps_l1_ca_code_gen_complex_sampled(&code_7[0], 7, 4000000, 0);
+    gps_l1_ca_code_gen_complex_sampled(&code_9[0], 9, 4000000, 0);
+    std::vector<gr_complex> signal_a = server_test_signal(7, 1000, 1000.0);
+    std::vector<gr_complex> signal_b = server_test_signal(7, 2500, -2000.0);
+
+    // two channels of receiver a search the same dwell, for PRN 7 and 9
+    int a7 = receiver_a.submit(server_test_request(7, 4000), &signal_a[0], &code_7[0]);
+    int a9 = receiver_a.submit(server_test_request(9, 4000), &signal_a[0], &code_9[0]);
+    int b7 = receiver_b.submit(server_test_request(7, 12000), &signal_b[0], &code_7[0]);
+    ASSERT_GE(a7, 0);
+    ASSERT_GE(a9, 0);
+    ASSERT_GE(b7, 0);
+
+    EXPECT_EQ(3u, server.run_once(100000, 0));
+    EXPECT_EQ(3u, server.searches());
+    EXPECT_EQ(2u, server.dwells());
+    EXPECT_EQ(1u, server.batches());
+
+    std::vector<Doppler_Line_Max> lines_a7(20);
+    std::vector<Doppler_Line_Max> lines_a9(20);
+    std::vector<Doppler_Line_Max> lines_b7(20);
+    ASSERT_TRUE(receiver_a.poll(a7, &lines_a7[0]));
+    ASSERT_TRUE(receiver_a.poll(a9, &lines_a9[0]));
+    ASSERT_TRUE(receiver_b.poll(b7, &lines_b7[0]));
+
+    // bin i is at -5000 + 500 i Hz
+    EXPECT_EQ(12u, best_line(lines_a7));
+    EXPECT_EQ(1000u, lines_a7[12].index);
+    EXPECT_EQ(6u, best_line(lines_b7));
+    EXPECT_EQ(2500u, lines_b7[6].index);
+    // the power of a line is the sum of its squared magnitudes, so the peak is a small part of it
+    EXPECT_GT(lines_a7[12].power, lines_a7[12].mag);
+    EXPECT_GT(lines_a7[12].mag, 10.0 * lines_a9[best_line(lines_a9)].mag);
+}
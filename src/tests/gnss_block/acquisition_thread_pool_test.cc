@@ -0,0 +1,74 @@
+/*!
+ * \file acquisition_thread_pool_test.cc
+ * \brief Tests of the thread pool shared by the acquisition blocks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <algorithm>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+#include <gtest/gtest.h>
+#include "acquisition_thread_pool.h"
+
+namespace
+{
+void count_task(unsigned int task, Acquisition_Scratch& scratch, std::vector<int>* runs, boost::mutex* mutex)
+{
+    // every thread gets its own plan, usable at the same time as the others
+    gr::fft::fft_complex* ifft = scratch.ifft(64);
+    std::fill_n(ifft->get_inbuf(), 64, gr_complex(1.0, 0.0));
+    ifft->execute();
+    boost::mutex::scoped_lock lock(*mutex);
+    (*runs)[task]++;
+}
+}
+
+
+TEST(AcquisitionThreadPoolTest, ParallelForRunsEveryTaskOnce)
+{
+    unsigned int count = 200;
+    std::vector<int> runs(count, 0);
+    boost::mutex mutex;
+    Acquisition_Thread_Pool::instance().parallel_for(count, boost::bind(&count_task, _1, _2, &runs, &mutex));
+    for (unsigned int i = 0; i < count; i++)
+        {
+            EXPECT_EQ(1, runs[i]) << "task " << i;
+        }
+}
+
+
+TEST(AcquisitionThreadPoolTest, ScratchIsPerThread)
+{
+    Acquisition_Scratch& scratch = Acquisition_Thread_Pool::scratch();
+    EXPECT_EQ(&scratch, &Acquisition_Thread_Pool::scratch());
+    EXPECT_EQ(scratch.ifft(128), scratch.ifft(128));
+    EXPECT_NE(scratch.ifft(128), scratch.ifft(256));
+    float* magnitude = scratch.magnitude(1000);
+    magnitude[999] = 1.0;
+    EXPECT_EQ(1.0, scratch.magnitude(10)[999]);
+}
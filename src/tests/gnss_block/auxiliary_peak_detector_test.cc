@@ -0,0 +1,142 @@
+/*!
+ * \file auxiliary_peak_detector_test.cc
+ * \brief Tests of the search of the auxiliary peaks of the SD acquisition
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <vector>
+#include <gtest/gtest.h>
+#include "auxiliary_peak_detector.h"
+
+
+TEST(AuxiliaryPeakDetectorTest, SelectsTheNthPeak)
+{
+    std::vector<float> line(64, 1.0);
+    line[10] = 18.0;
+    line[30] = 10.0;
+    line[50] = 14.0;
+    // below the threshold
+    line[20] = 3.0;
+
+    Auxiliary_Peak_Detector detector;
+    detector.add_doppler_line(&line[0], line.size(), 4.0, 500, 64, 2.0);
+    EXPECT_EQ(3u, detector.size());
+
+    Acq_Peak peak;
+    ASSERT_TRUE(detector.get_peak(1, 250, peak));
+    EXPECT_EQ(10, peak.code_phase);
+    EXPECT_EQ(500, peak.doppler);
+    EXPECT_FLOAT_EQ(9.0, peak.mag);
+    ASSERT_TRUE(detector.get_peak(2, 250, peak));
+    EXPECT_EQ(50, peak.code_phase);
+    EXPECT_FLOAT_EQ(7.0, peak.mag);
+    ASSERT_TRUE(detector.get_peak(3, 250, peak));
+    EXPECT_EQ(30, peak.code_phase);
+    EXPECT_FALSE(detector.get_peak(4, 250, peak));
+    EXPECT_FALSE(detector.get_peak(0, 250, peak));
+
+    // only the samples of the window are searched, and the index wraps into a code phase
+    detector.clear();
+    detector.add_doppler_line(&line[0], line.size(), 40, 64, 4.0, 500, 32, 1.0);
+    ASSERT_EQ(1u, detector.size());
+    ASSERT_TRUE(detector.get_peak(1, 250, peak));
+    EXPECT_EQ(50 - 32, peak.code_phase);
+}
+
+
+TEST(AuxiliaryPeakDetectorTest, KeepsPeaksOfTheSameMagnitude)
+{
+    std::vector<float> line(64, 1.0);
+    line[10] = 5.0;
+    line[40] = 5.0;
+    // a flat top is a single peak
+    line[20] = 6.0;
+    line[21] = 6.0;
+
+    Auxiliary_Peak_Detector detector;
+    detector.add_doppler_line(&line[0], line.size(), 2.0, 0, 64, 1.0);
+    EXPECT_EQ(3u, detector.size());
+
+    std::vector<Acq_Peak> peaks;
+    detector.get_peaks(3, 250, peaks);
+    ASSERT_EQ(3u, peaks.size());
+    EXPECT_EQ(20, peaks[0].code_phase);
+    // the two equal peaks are both kept, in any order
+    EXPECT_FLOAT_EQ(5.0, peaks[1].mag);
+    EXPECT_FLOAT_EQ(5.0, peaks[2].mag);
+    EXPECT_EQ(50, peaks[1].code_phase + peaks[2].code_phase);
+    EXPECT_NE(peaks[1].code_phase, peaks[2].code_phase);
+
+    Acq_Peak peak;
+    EXPECT_TRUE(detector.get_peak(3, 250, peak));
+    EXPECT_FALSE(detector.get_peak(4, 250, peak));
+}
+
+
+TEST(AuxiliaryPeakDetectorTest, MergesNeighbouringPeaks)
+{
+    const unsigned int doppler_step = 500;
+    std::vector<float> line_0(64, 1.0);
+    std::vector<float> line_500(64, 1.0);
+    std::vector<float> line_1000(64, 1.0);
+    line_0[20] = 9.0;
+    line_0[40] = 6.0;
+    // one Doppler step and no code phase away from the strongest peak
+    line_500[20] = 8.0;
+    // one step and one sample away from the peak at 40
+    line_500[41] = 5.0;
+    // two samples away
+    line_500[43] = 4.0;
+    // two steps away from the strongest peak, but one from the merged one
+    line_1000[21] = 7.0;
+
+    Auxiliary_Peak_Detector detector;
+    Auxiliary_Peak_Detector other;
+    detector.add_doppler_line(&line_0[0], line_0.size(), 2.0, 0, 64, 1.0);
+    other.add_doppler_line(&line_500[0], line_500.size(), 2.0, doppler_step, 64, 1.0);
+    other.add_doppler_line(&line_1000[0], line_1000.size(), 2.0, 2 * doppler_step, 64, 1.0);
+    detector.add_peaks(other);
+    EXPECT_EQ(6u, detector.size());
+
+    // the peaks are merged into the stronger ones already selected only
+    std::vector<Acq_Peak> peaks;
+    detector.get_peaks(10, doppler_step, peaks);
+    ASSERT_EQ(4u, peaks.size());
+    EXPECT_EQ(20, peaks[0].code_phase);
+    EXPECT_EQ(0, peaks[0].doppler);
+    EXPECT_EQ(21, peaks[1].code_phase);
+    EXPECT_EQ(1000, peaks[1].doppler);
+    EXPECT_EQ(40, peaks[2].code_phase);
+    EXPECT_EQ(0, peaks[2].doppler);
+    EXPECT_EQ(43, peaks[3].code_phase);
+    EXPECT_EQ(500, peaks[3].doppler);
+
+    Acq_Peak peak;
+    ASSERT_TRUE(detector.get_peak(2, doppler_step, peak));
+    EXPECT_EQ(21, peak.code_phase);
+    EXPECT_FALSE(detector.get_peak(5, doppler_step, peak));
+}
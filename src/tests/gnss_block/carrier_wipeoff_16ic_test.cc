@@ -0,0 +1,82 @@
+/*!
+ * \file carrier_wipeoff_16ic_test.cc
+ * \brief Tests of the carrier wipeoff of the cshort acquisition blocks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <gtest/gtest.h>
+#include "carrier_wipeoff_16ic.h"
+#include "GPS_L1_CA.h"
+
+
+TEST(CarrierWipeoff16icTest, WipesOffTheCarrierOfTheBin)
+{
+    const long fs_in = 4000000;
+    const long freq = 100000;
+    const unsigned int length = 4000;
+    // bins from -1000 Hz to 1000 Hz in 500 Hz steps
+    Carrier_Wipeoff_16ic wipeoff(fs_in, freq, 1000, 500, 5, length);
+
+    // a carrier at freq + 500 Hz, its largest component is 1000
+    std::vector<lv_16sc_t> in(length);
+    for (unsigned int n = 0; n < length; n++)
+        {
+            double phase = GPS_TWO_PI * (freq + 500) * n / fs_in;
+            in[n] = lv_16sc_t(static_cast<short>(std::round(1000.0 * std::cos(phase))), static_cast<short>(std::round(1000.0 * std::sin(phase))));
+        }
+
+    // scaled by 4, up to 4000
+    float power = wipeoff.set_input(&in[0]);
+    EXPECT_NEAR(4000.0 * 4000.0, power, 0.01 * 4000.0 * 4000.0);
+
+    std::vector<gr_complex> out(length);
+    wipeoff.wipeoff(3, &out[0]);
+    for (unsigned int n = 0; n < length; n++)
+        {
+            EXPECT_NEAR(4000.0, out[n].real(), 20.0);
+            EXPECT_NEAR(0.0, out[n].imag(), 20.0);
+        }
+}
+
+
+TEST(CarrierWipeoff16icTest, LargeSamplesDoNotOverflow)
+{
+    const unsigned int length = 1000;
+    Carrier_Wipeoff_16ic wipeoff(4000000, 0, 1000, 500, 5, length);
+    std::vector<lv_16sc_t> in(length, lv_16sc_t(32000, -32000));
+    wipeoff.set_input(&in[0]);
+    std::vector<gr_complex> out(length);
+    wipeoff.wipeoff(0, &out[0]);
+    for (unsigned int n = 0; n < length; n++)
+        {
+            // halved, then rotated
+            EXPECT_NEAR(16000.0 * std::sqrt(2.0), std::abs(out[n]), 10.0);
+        }
+}
@@ -0,0 +1,138 @@
+/*!
+ * \file channel_fsm_test.cc
+ * \brief  This file implements tests for the state machine of the channels
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <gnuradio/msg_queue.h>
+#include "channel_fsm.h"
+#include "control_message_factory.h"
+
+
+TEST(ChannelFsmTest, FollowsTheTransitionTable)
+{
+    gr::msg_queue::sptr queue = gr::msg_queue::make(0);
+    ChannelFsm fsm;
+    fsm.set_channel(3);
+    fsm.set_queue(queue);
+    EXPECT_EQ(ChannelFsm::IDLE, fsm.state());
+
+    fsm.Event_valid_acquisition(); // ignored while idle
+    EXPECT_EQ(ChannelFsm::IDLE, fsm.state());
+    fsm.Event_start_acquisition();
+    EXPECT_EQ(ChannelFsm::ACQUIRING, fsm.state());
+    fsm.Event_failed_acquisition_repeat();
+    EXPECT_EQ(ChannelFsm::ACQUIRING, fsm.state());
+    fsm.Event_valid_acquisition();
+    EXPECT_EQ(ChannelFsm::TRACKING, fsm.state());
+    fsm.Event_failed_tracking_standby();
+    EXPECT_EQ(ChannelFsm::IDLE, fsm.state());
+    fsm.Event_start_acquisition();
+    fsm.Event_failed_acquisition_no_repeat();
+    EXPECT_EQ(ChannelFsm::WAITING, fsm.state());
+
+    // tracking started, tracking stopped, satellite requested
+    std::vector<unsigned int> expected = {1, 2, 0};
+    ControlMessageFactory factory;
+    ASSERT_EQ(expected.size(), queue->count());
+    for (unsigned int i = 0; i < expected.size(); i++)
+        {
+            std::shared_ptr<std::vector<std::shared_ptr<ControlMessage>>> messages = factory.GetControlMessages(queue->delete_head());
+            ASSERT_EQ(1U, messages->size());
+            EXPECT_EQ(3U, messages->at(0)->who);
+            EXPECT_EQ(expected.at(i), messages->at(0)->what);
+        }
+}
+
+
+TEST(ChannelFsmTest, TerminateLeavesTracking)
+{
+    gr::msg_queue::sptr queue = gr::msg_queue::make(0);
+    ChannelFsm fsm;
+    fsm.set_queue(queue);
+    fsm.Event_start_acquisition();
+    fsm.Event_valid_acquisition();
+    fsm.terminate();
+    fsm.Event_start_acquisition();
+    EXPECT_EQ(ChannelFsm::TRACKING, fsm.state());
+    EXPECT_EQ(2U, queue->count()); // tracking started and stopped
+}
+
+
+TEST(ChannelFsmTest, CheckedReleasesTheChannel)
+{
+    gr::msg_queue::sptr queue = gr::msg_queue::make(0);
+    ChannelFsm fsm;
+    fsm.set_queue(queue);
+    fsm.Event_checked(); // ignored unless tracking
+    EXPECT_EQ(ChannelFsm::IDLE, fsm.state());
+    fsm.Event_start_acquisition();
+    fsm.Event_valid_acquisition();
+    fsm.Event_checked();
+    EXPECT_EQ(ChannelFsm::RELEASED, fsm.state());
+    fsm.Event_start_acquisition();
+    EXPECT_EQ(ChannelFsm::ACQUIRING, fsm.state());
+
+    // tracking started, channel released
+    ControlMessageFactory factory;
+    ASSERT_EQ(2U, queue->count());
+    queue->delete_head();
+    std::shared_ptr<std::vector<std::shared_ptr<ControlMessage>>> messages = factory.GetControlMessages(queue->delete_head());
+    ASSERT_EQ(1U, messages->size());
+    EXPECT_EQ(4U, messages->at(0)->what);
+}
+
+
+TEST(ChannelFsmTest, EventsFromSeveralThreads)
+{
+    ChannelFsm fsm;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+        {
+            threads.push_back(std::thread([&fsm]()
+                    {
+                        for (int i = 0; i < 10000; i++)
+                            {
+                                fsm.Event_start_acquisition();
+                                fsm.Event_valid_acquisition();
+                                fsm.Event_stop_tracking();
+                            }
+                    }));
+        }
+    for (unsigned int t = 0; t < threads.size(); t++)
+        {
+            threads.at(t).join();
+        }
+    // every event is processed, the last ones leave a valid state
+    EXPECT_NE(ChannelFsm::IDLE, fsm.state());
+    EXPECT_NE(ChannelFsm::WAITING, fsm.state());
+}
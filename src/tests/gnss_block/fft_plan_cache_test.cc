@@ -0,0 +1,56 @@
+/*!
+ * \file fft_plan_cache_test.cc
+ * \brief Tests of the FFT plan cache shared by the acquisition blocks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include <gnuradio/fft/fft.h>
+#include "fft_plan_cache.h"
+
+
+TEST(FftPlanCacheTest, ReleasedPlansAreReused)
+{
+    gr::fft::fft_complex* forward = Fft_Plan_Cache::acquire(4000, true);
+    gr::fft::fft_complex* inverse = Fft_Plan_Cache::acquire(4000, false);
+    ASSERT_NE(forward, inverse);
+    EXPECT_EQ(4000, forward->inbuf_length());
+
+    // a plan in use is never handed out twice
+    gr::fft::fft_complex* other = Fft_Plan_Cache::acquire(4000, true);
+    EXPECT_NE(forward, other);
+
+    Fft_Plan_Cache::release(forward);
+    EXPECT_EQ(forward, Fft_Plan_Cache::acquire(4000, true));
+    gr::fft::fft_complex* shorter = Fft_Plan_Cache::acquire(2000, true);
+    EXPECT_NE(forward, shorter);
+
+    Fft_Plan_Cache::release(shorter);
+    Fft_Plan_Cache::release(forward);
+    Fft_Plan_Cache::release(inverse);
+    Fft_Plan_Cache::release(other);
+}
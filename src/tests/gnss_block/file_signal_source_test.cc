@@ -69,3 +69,23 @@ TEST(FileSignalSource, InstantiateFileNotExists)
 
     EXPECT_THROW({auto uptr = std::make_shared<FileSignalSource>(config.get(), "Test", 1, 1, queue);}, std::exception);
 }
+
+TEST(FileSignalSource, InstantiateWithMmap)
+{
+    boost::shared_ptr<gr::msg_queue> queue = gr::msg_queue::make(0);
+    std::shared_ptr<InMemoryConfiguration> config = std::make_shared<InMemoryConfiguration>();
+
+    config->set_property("Test.samples", "0");
+    config->set_property("Test.sampling_frequency", "0");
+    std::string path = std::string(TEST_PATH);
+    std::string filename = path + "signal_samples/GPS_L1_CA_ID_1_Fs_4Msps_2ms.dat";
+    config->set_property("Test.filename", filename);
+    config->set_property("Test.item_type", "gr_complex");
+    config->set_property("Test.use_mmap", "true");
+
+    std::unique_ptr<FileSignalSource> signal_source(new FileSignalSource(config.get(), "Test", 1, 1, queue));
+    EXPECT_TRUE(signal_source->get_right_block() != 0);
+
+    config->set_property("Test.filename", "./signal_samples/i_dont_exist.dat");
+    EXPECT_THROW({auto uptr = std::make_shared<FileSignalSource>(config.get(), "Test", 1, 1, queue);}, std::exception);
+}
@@ -0,0 +1,111 @@
+/*!
+ * \file frequency_domain_doppler_test.cc
+ * \brief  This file implements tests for the frequency domain Doppler search
+ * of the PCPS acquisition blocks
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cmath>
+#include <vector>
+#include <gtest/gtest.h>
+#include <gnuradio/fft/fft.h>
+#include "acquisition_cache.h"
+#include "frequency_domain_doppler.h"
+#include "gps_sdr_signal_processing.h"
+
+
+TEST(FrequencyDomainDopplerTest, MatchesTimeDomainWipeoff)
+{
+    long fs_in = 4000000;
+    long freq = 1200;
+    unsigned int fft_size = 4000; // 1 kHz FFT bins
+    unsigned int doppler_max = 5000;
+    unsigned int doppler_step = 250;
+    unsigned int num_doppler_bins = 40;
+
+    std::vector<gr_complex> code(fft_size);
+    std::vector<gr_complex> in(fft_size);
+    gps_l1_ca_code_gen_complex_sampled(&code[0], 10, fs_in, 0);
+    double carrier_hz = freq + 3250.0;
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            double phase = 2.0 * M_PI * carrier_hz * i / static_cast<double>(fs_in);
+            in[i] = code[(i + fft_size - 1234) % fft_size] * gr_complex(std::cos(phase), std::sin(phase));
+        }
+
+    gr::fft::fft_complex fft(fft_size, true);
+    gr::fft::fft_complex ifft(fft_size, false);
+    std::copy(code.begin(), code.end(), fft.get_inbuf());
+    std::shared_ptr<const Code_Fft> fft_code = Acquisition_Cache::code_fft('G', "1C", 10, &fft);
+    std::shared_ptr<const Doppler_Wipeoff_Grid> grid = Acquisition_Cache::doppler_wipeoff_grid(fs_in, freq, doppler_max, doppler_step, num_doppler_bins, fft_size);
+
+    Frequency_Domain_Doppler fd_doppler(fs_in, freq, doppler_max, doppler_step, num_doppler_bins, fft_size);
+    EXPECT_EQ(4u, fd_doppler.num_input_ffts());
+    fd_doppler.set_input(&in[0], &fft);
+
+    std::vector<float> fd_magnitude(fft_size);
+    // relative to the correlation peak, fft_size^2 squared
+    float tolerance = 1e-3 * std::pow(static_cast<float>(fft_size), 4);
+    float max_magnitude = 0.0;
+    unsigned int max_doppler_index = 0;
+    unsigned int max_code_phase = 0;
+    for (unsigned int doppler_index = 0; doppler_index < num_doppler_bins; doppler_index++)
+        {
+            fd_doppler.multiply_code(doppler_index, fft_code->get(), ifft.get_inbuf());
+            ifft.execute();
+            for (unsigned int i = 0; i < fft_size; i++)
+                {
+                    fd_magnitude[i] = std::norm(ifft.get_outbuf()[i]);
+                }
+
+            // time domain reference
+            for (unsigned int i = 0; i < fft_size; i++)
+                {
+                    fft.get_inbuf()[i] = in[i] * grid->wipeoffs()[doppler_index][i];
+                }
+            fft.execute();
+            for (unsigned int i = 0; i < fft_size; i++)
+                {
+                    ifft.get_inbuf()[i] = fft.get_outbuf()[i] * fft_code->get()[i];
+                }
+            ifft.execute();
+            for (unsigned int i = 0; i < fft_size; i++)
+                {
+                    float magnitude = std::norm(ifft.get_outbuf()[i]);
+                    ASSERT_NEAR(magnitude, fd_magnitude[i], tolerance);
+                    if (magnitude > max_magnitude)
+                        {
+                            max_magnitude = magnitude;
+                            max_doppler_index = doppler_index;
+                            max_code_phase = i;
+                        }
+                }
+        }
+    EXPECT_EQ(33u, max_doppler_index); // -5000 + 33 * 250 = 3250 Hz
+    EXPECT_EQ(1234u, max_code_phase);
+}
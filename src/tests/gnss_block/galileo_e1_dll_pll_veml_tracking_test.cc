@@ -34,7 +34,6 @@
 #include <ctime>
 #include <iostream>
 #include <gnuradio/top_block.h>
-#include <gnuradio/blocks/file_source.h>
 #include <gnuradio/analog/sig_source_waveform.h>
 #include <gnuradio/analog/sig_source_c.h>
 #include <gnuradio/msg_queue.h>
@@ -47,6 +46,7 @@
 #include "gnss_sdr_valve.h"
 #include "gnss_synchro.h"
 #include "galileo_e1_dll_pll_veml_tracking.h"
+#include "signal_samples.h"
 
 
 class GalileoE1DllPllVemlTrackingInternalTest: public ::testing::Test
@@ -193,10 +193,7 @@ TEST_F(GalileoE1DllPllVemlTrackingInternalTest, ValidationOfResults)
     }) << "Failure connecting tracking to the top_block." << std::endl;
 
     ASSERT_NO_THROW( {
-        std::string path = std::string(TEST_PATH);
-        std::string file = path + "signal_samples/GSoC_CTTC_capture_2012_07_26_4Msps_4ms.dat";
-        const char * file_name = file.c_str();
-        gr::blocks::file_source::sptr file_source = gr::blocks::file_source::make(sizeof(gr_complex),file_name,false);
+        boost::shared_ptr<Signal_Samples_Source> file_source = signal_samples_source_make("signal_samples/GSoC_CTTC_capture_2012_07_26_4Msps_4ms.dat");
         gr::blocks::skiphead::sptr skip_head = gr::blocks::skiphead::make(sizeof(gr_complex), skiphead_sps);
         boost::shared_ptr<gr::block> valve = gnss_sdr_make_valve(sizeof(gr_complex), num_samples, queue);
         gr::blocks::null_sink::sptr sink = gr::blocks::null_sink::make(sizeof(Gnss_Synchro));
@@ -49,6 +49,7 @@
 #include "fir_filter.h"
 #include "gen_signal_source.h"
 #include "gnss_sdr_valve.h"
+#include "test_time_limits.h"
 
 // ######## GNURADIO BLOCK MESSAGE RECEVER #########
 class GalileoE1PcpsCccwsrAmbiguousAcquisitionTest_msg_rx;
@@ -637,11 +638,13 @@ TEST_F(GalileoE1PcpsCccwsrAmbiguousAcquisitionTest, ValidationOfResultsProbabili
             {
                 std::cout << "Estimated probability of detection = " << Pd << std::endl;
                 std::cout << "Estimated probability of false alarm (satellite present) = " << Pfa_p << std::endl;
+                EXPECT_LE(mean_acq_time_us, test_time_limit_us(TEST_MAX_ACQ_MS_GALILEO_E1)) << "Acquisition slower than " << TEST_MAX_ACQ_MS_GALILEO_E1 << " ms";
                 std::cout << "Mean acq time = " << mean_acq_time_us << " microseconds." << std::endl;
             }
             else if (i == 1)
             {
                 std::cout << "Probability of false alarm (satellite absent) = " << Pfa_a << std::endl;
+                EXPECT_LE(mean_acq_time_us, test_time_limit_us(TEST_MAX_ACQ_MS_GALILEO_E1)) << "Acquisition slower than " << TEST_MAX_ACQ_MS_GALILEO_E1 << " ms";
                 std::cout << "Mean acq time = " << mean_acq_time_us << " microseconds." << std::endl;
             }
             ch_thread.join();
@@ -51,6 +51,7 @@
 #include "gen_signal_source.h"
 #include "gnss_sdr_valve.h"
 #include "galileo_e1_pcps_quicksync_ambiguous_acquisition.h"
+#include "test_time_limits.h"
 
 DEFINE_double(e1_value_threshold, 0.3, "Value of the threshold for the acquisition");
 DEFINE_int32(e1_value_CN0_dB_0, 50, "Value for the CN0_dB_0 in channel 0");
@@ -852,6 +853,7 @@ TEST_F(GalileoE1PcpsQuickSyncAmbiguousAcquisitionGSoC2014Test, ValidationOfResul
                     std::cout << "Estimated probability of detection = " << Pd << std::endl;
                     std::cout << "Estimated probability of false alarm (satellite present) = " << Pfa_p << std::endl;
                     std::cout << "Estimated probability of miss detection (satellite present) = " << Pmd << std::endl;
+                    EXPECT_LE(mean_acq_time_us, test_time_limit_us(TEST_MAX_ACQ_MS_GALILEO_E1)) << "Acquisition slower than " << TEST_MAX_ACQ_MS_GALILEO_E1 << " ms";
                     std::cout << "Mean acq time = " << mean_acq_time_us << " microseconds." << std::endl;
 
                     if(dump_test_results)
@@ -872,6 +874,7 @@ TEST_F(GalileoE1PcpsQuickSyncAmbiguousAcquisitionGSoC2014Test, ValidationOfResul
             else if (i == 1)
                 {
                     std::cout << "Estimated probability of false alarm (satellite absent) = " << Pfa_a << std::endl;
+                    EXPECT_LE(mean_acq_time_us, test_time_limit_us(TEST_MAX_ACQ_MS_GALILEO_E1)) << "Acquisition slower than " << TEST_MAX_ACQ_MS_GALILEO_E1 << " ms";
                     std::cout << "Mean acq time = " << mean_acq_time_us << " microseconds." << std::endl;
 
                     if(dump_test_results)
@@ -45,6 +45,7 @@
 #include "pvt_interface.h"
 #include "gnss_block_factory.h"
 #include "channel.h"
+#include "pass_through.h"
 
 TEST(GNSS_Block_Factory_Test, InstantiateFileSignalSource)
 {
@@ -69,7 +70,7 @@ TEST(GNSS_Block_Factory_Test, InstantiateWrongSignalSource)
     configuration->set_property("SignalSource.implementation", "Pepito");
     gr::msg_queue::sptr queue = gr::msg_queue::make(0);
     // Example of a factory as a unique_ptr
-    std::unique_ptr<GNSSBlockFactory> factory;
+    std::unique_ptr<GNSSBlockFactory> factory(new GNSSBlockFactory());
     // Example of a block as a unique_ptr
     std::unique_ptr<GNSSBlockInterface> signal_source = factory->GetSignalSource(configuration, queue);
     EXPECT_EQ(nullptr, signal_source);
@@ -80,7 +81,7 @@ TEST(GNSS_Block_Factory_Test, InstantiateSignalConditioner)
 {
     std::shared_ptr<InMemoryConfiguration> configuration = std::make_shared<InMemoryConfiguration>();
     configuration->set_property("SignalConditioner.implementation", "Signal_Conditioner");
-    std::unique_ptr<GNSSBlockFactory> factory;
+    std::unique_ptr<GNSSBlockFactory> factory(new GNSSBlockFactory());
     std::unique_ptr<GNSSBlockInterface> signal_conditioner = factory->GetSignalConditioner(configuration);
     EXPECT_STREQ("SignalConditioner", signal_conditioner->role().c_str());
     EXPECT_STREQ("Signal_Conditioner", signal_conditioner->implementation().c_str());
@@ -113,7 +114,7 @@ TEST(GNSS_Block_Factory_Test, InstantiateFIRFilter)
     configuration->set_property("InputFilter.filter_type", "bandpass");
     configuration->set_property("InputFilter.grid_density", "16");
 
-    std::unique_ptr<GNSSBlockFactory> factory;
+    std::unique_ptr<GNSSBlockFactory> factory(new GNSSBlockFactory());
     std::unique_ptr<GNSSBlockInterface> input_filter = factory->GetBlock(configuration, "InputFilter", "Fir_Filter", 1, 1);
 
     EXPECT_STREQ("InputFilter", input_filter->role().c_str());
@@ -148,7 +149,7 @@ TEST(GNSS_Block_Factory_Test, InstantiateFreqXlatingFIRFilter)
 
     configuration->set_property("InputFilter.sampling_frequency","4000000");
     configuration->set_property("InputFilter.IF","34000");
-    std::unique_ptr<GNSSBlockFactory> factory;
+    std::unique_ptr<GNSSBlockFactory> factory(new GNSSBlockFactory());
     std::unique_ptr<GNSSBlockInterface> input_filter = factory->GetBlock(configuration, "InputFilter", "Freq_Xlating_Fir_Filter", 1, 1);
 
     EXPECT_STREQ("InputFilter", input_filter->role().c_str());
@@ -159,7 +160,7 @@ TEST(GNSS_Block_Factory_Test, InstantiateDirectResampler)
 {
     std::shared_ptr<InMemoryConfiguration> configuration = std::make_shared<InMemoryConfiguration>();
     configuration->set_property("Resampler.implementation", "Direct_Resampler");
-    std::unique_ptr<GNSSBlockFactory> factory;
+    std::unique_ptr<GNSSBlockFactory> factory(new GNSSBlockFactory());
     std::unique_ptr<GNSSBlockInterface> resampler = factory->GetBlock(configuration, "Resampler", "Direct_Resampler", 1, 1);
     EXPECT_STREQ("Resampler", resampler->role().c_str());
     EXPECT_STREQ("Direct_Resampler", resampler->implementation().c_str());
@@ -169,7 +170,7 @@ TEST(GNSS_Block_Factory_Test, InstantiateGpsL1CaPcpsAcquisition)
 {
     std::shared_ptr<InMemoryConfiguration> configuration = std::make_shared<InMemoryConfiguration>();
     configuration->set_property("Acquisition.implementation", "GPS_L1_CA_PCPS_Acquisition");
-    std::unique_ptr<GNSSBlockFactory> factory;
+    std::unique_ptr<GNSSBlockFactory> factory(new GNSSBlockFactory());
     std::shared_ptr<GNSSBlockInterface> acq_ = factory->GetBlock(configuration, "Acquisition", "GPS_L1_CA_PCPS_Acquisition", 1, 1);
     std::shared_ptr<AcquisitionInterface> acquisition = std::dynamic_pointer_cast<AcquisitionInterface>(acq_);
     EXPECT_STREQ("Acquisition", acquisition->role().c_str());
@@ -204,7 +205,7 @@ TEST(GNSS_Block_Factory_Test, InstantiateGalileoE1PcpsAmbiguousAcquisition)
 {
     std::shared_ptr<InMemoryConfiguration> configuration = std::make_shared<InMemoryConfiguration>();
     configuration->set_property("Acquisition.implementation", "Galileo_E1_PCPS_Ambiguous_Acquisition");
-    std::unique_ptr<GNSSBlockFactory> factory;
+    std::unique_ptr<GNSSBlockFactory> factory(new GNSSBlockFactory());
     std::shared_ptr<GNSSBlockInterface> acq_ = factory->GetBlock(configuration, "Acquisition", "Galileo_E1_PCPS_Ambiguous_Acquisition", 1, 1);
     std::shared_ptr<AcquisitionInterface> acquisition = std::dynamic_pointer_cast<AcquisitionInterface>(acq_);
     EXPECT_STREQ("Acquisition", acquisition->role().c_str());
@@ -216,7 +217,7 @@ TEST(GNSS_Block_Factory_Test, InstantiateGpsL1CaDllPllCAidTracking)
 {
     std::shared_ptr<InMemoryConfiguration> configuration = std::make_shared<InMemoryConfiguration>();
     configuration->set_property("Tracking.implementation", "GPS_L1_CA_DLL_PLL_C_Aid_Tracking");
-    std::unique_ptr<GNSSBlockFactory> factory;
+    std::unique_ptr<GNSSBlockFactory> factory(new GNSSBlockFactory());
     std::shared_ptr<GNSSBlockInterface> trk_ = factory->GetBlock(configuration, "Tracking", "GPS_L1_CA_DLL_PLL_C_Aid_Tracking", 1, 1);
     std::shared_ptr<TrackingInterface> tracking = std::dynamic_pointer_cast<TrackingInterface>(trk_);
     EXPECT_STREQ("Tracking", tracking->role().c_str());
@@ -228,7 +229,7 @@ TEST(GNSS_Block_Factory_Test, InstantiateGpsL1CaDllPllTracking)
 {
     std::shared_ptr<InMemoryConfiguration> configuration = std::make_shared<InMemoryConfiguration>();
     configuration->set_property("Tracking.implementation", "GPS_L1_CA_DLL_PLL_Tracking");
-    std::unique_ptr<GNSSBlockFactory> factory;
+    std::unique_ptr<GNSSBlockFactory> factory(new GNSSBlockFactory());
     std::shared_ptr<GNSSBlockInterface> trk_ = factory->GetBlock(configuration, "Tracking", "GPS_L1_CA_DLL_PLL_Tracking", 1, 1);
     std::shared_ptr<TrackingInterface> tracking = std::dynamic_pointer_cast<TrackingInterface>(trk_);
     EXPECT_STREQ("Tracking", tracking->role().c_str());
@@ -240,7 +241,7 @@ TEST(GNSS_Block_Factory_Test, InstantiateGpsL1CaTcpConnectorTracking)
 {
     std::shared_ptr<InMemoryConfiguration> configuration = std::make_shared<InMemoryConfiguration>();
     configuration->set_property("Tracking.implementation", "GPS_L1_CA_TCP_CONNECTOR_Tracking");
-    std::unique_ptr<GNSSBlockFactory> factory;
+    std::unique_ptr<GNSSBlockFactory> factory(new GNSSBlockFactory());
     std::shared_ptr<GNSSBlockInterface> trk_ = factory->GetBlock(configuration, "Tracking", "GPS_L1_CA_TCP_CONNECTOR_Tracking", 1, 1);
     std::shared_ptr<TrackingInterface> tracking = std::dynamic_pointer_cast<TrackingInterface>(trk_);
     EXPECT_STREQ("Tracking", tracking->role().c_str());
@@ -252,7 +253,7 @@ TEST(GNSS_Block_Factory_Test, InstantiateGalileoE1DllPllVemlTracking)
 {
     std::shared_ptr<InMemoryConfiguration> configuration = std::make_shared<InMemoryConfiguration>();
     configuration->set_property("Tracking.implementation", "Galileo_E1_DLL_PLL_VEML_Tracking");
-    std::unique_ptr<GNSSBlockFactory> factory;
+    std::unique_ptr<GNSSBlockFactory> factory(new GNSSBlockFactory());
     std::shared_ptr<GNSSBlockInterface> trk_ = factory->GetBlock(configuration, "Tracking", "Galileo_E1_DLL_PLL_VEML_Tracking", 1, 1);
     std::shared_ptr<TrackingInterface> tracking = std::dynamic_pointer_cast<TrackingInterface>(trk_);
     EXPECT_STREQ("Tracking", tracking->role().c_str());
@@ -264,7 +265,7 @@ TEST(GNSS_Block_Factory_Test, InstantiateGpsL1CaTelemetryDecoder)
 {
     std::shared_ptr<InMemoryConfiguration> configuration = std::make_shared<InMemoryConfiguration>();
     configuration->set_property("TelemetryDecoder.implementation", "GPS_L1_CA_Telemetry_Decoder");
-    std::unique_ptr<GNSSBlockFactory> factory;
+    std::unique_ptr<GNSSBlockFactory> factory(new GNSSBlockFactory());
     std::shared_ptr<GNSSBlockInterface> telemetry_decoder = factory->GetBlock(configuration, "TelemetryDecoder", "GPS_L1_CA_Telemetry_Decoder", 1, 1);
     EXPECT_STREQ("TelemetryDecoder", telemetry_decoder->role().c_str());
     EXPECT_STREQ("GPS_L1_CA_Telemetry_Decoder", telemetry_decoder->implementation().c_str());
@@ -283,7 +284,7 @@ TEST(GNSS_Block_Factory_Test, InstantiateChannels)
     configuration->set_property("Acquisition_1C.implementation", "GPS_L1_CA_PCPS_Acquisition");
     configuration->set_property("Channel1.item_type", "gr_complex");
     gr::msg_queue::sptr queue = gr::msg_queue::make(0);
-    std::unique_ptr<GNSSBlockFactory> factory;
+    std::unique_ptr<GNSSBlockFactory> factory(new GNSSBlockFactory());
     std::unique_ptr<std::vector<std::unique_ptr<GNSSBlockInterface>>> channels = std::move(factory->GetChannels(configuration, queue));
     EXPECT_EQ((unsigned int) 2, channels->size());
     channels->erase(channels->begin(), channels->end());
@@ -294,7 +295,7 @@ TEST(GNSS_Block_Factory_Test, InstantiateObservables)
 {
     std::shared_ptr<InMemoryConfiguration> configuration = std::make_shared<InMemoryConfiguration>();
     configuration->set_property("Observables.implementation", "Pass_Through");
-    std::unique_ptr<GNSSBlockFactory> factory;
+    std::unique_ptr<GNSSBlockFactory> factory(new GNSSBlockFactory());
     auto observables = factory->GetObservables(configuration);
     EXPECT_STREQ("Observables", observables->role().c_str());
     EXPECT_STREQ("Pass_Through", observables->implementation().c_str());
@@ -305,7 +306,7 @@ TEST(GNSS_Block_Factory_Test, InstantiateGpsL1CaObservables)
 {
     std::shared_ptr<InMemoryConfiguration> configuration = std::make_shared<InMemoryConfiguration>();
     configuration->set_property("Observables.implementation", "GPS_L1_CA_Observables");
-    std::unique_ptr<GNSSBlockFactory> factory;
+    std::unique_ptr<GNSSBlockFactory> factory(new GNSSBlockFactory());
     std::unique_ptr<GNSSBlockInterface> observables = factory->GetObservables(configuration);
     EXPECT_STREQ("Observables", observables->role().c_str());
     EXPECT_STREQ("GPS_L1_CA_Observables", observables->implementation().c_str());
@@ -318,7 +319,7 @@ TEST(GNSS_Block_Factory_Test, InstantiatePvt)
 {
     std::shared_ptr<InMemoryConfiguration> configuration = std::make_shared<InMemoryConfiguration>();
     configuration->set_property("PVT.implementation", "Pass_Through");
-    std::unique_ptr<GNSSBlockFactory> factory;
+    std::unique_ptr<GNSSBlockFactory> factory(new GNSSBlockFactory());
     auto pvt_ = factory->GetPVT(configuration);
     EXPECT_STREQ("PVT", pvt_->role().c_str());
     EXPECT_STREQ("Pass_Through", pvt_->implementation().c_str());
@@ -329,7 +330,7 @@ TEST(GNSS_Block_Factory_Test, InstantiateGpsL1CaPvt)
 {
     std::shared_ptr<InMemoryConfiguration> configuration = std::make_shared<InMemoryConfiguration>();
     configuration->set_property("PVT.implementation", "GPS_L1_CA_PVT");
-    std::unique_ptr<GNSSBlockFactory> factory;
+    std::unique_ptr<GNSSBlockFactory> factory(new GNSSBlockFactory());
     std::shared_ptr<GNSSBlockInterface> pvt_ = factory->GetPVT(configuration);
     std::shared_ptr<PvtInterface> pvt = std::dynamic_pointer_cast<PvtInterface>(pvt_);
     EXPECT_STREQ("PVT", pvt->role().c_str());
@@ -341,9 +342,35 @@ TEST(GNSS_Block_Factory_Test, InstantiateWrongPvt)
 {
     std::shared_ptr<InMemoryConfiguration> configuration = std::make_shared<InMemoryConfiguration>();
     configuration->set_property("PVT.implementation", "Pepito");
-    std::unique_ptr<GNSSBlockFactory> factory;
+    std::unique_ptr<GNSSBlockFactory> factory(new GNSSBlockFactory());
     std::shared_ptr<GNSSBlockInterface> pvt_ = factory->GetPVT(configuration);
     std::shared_ptr<PvtInterface> pvt = std::dynamic_pointer_cast<PvtInterface>(pvt_);
     EXPECT_EQ(nullptr, pvt);
 }
 
+
+
+namespace
+{
+std::unique_ptr<GNSSBlockInterface> make_test_block(const GNSSBlockFactory::Block_Args& args)
+{
+    return std::unique_ptr<GNSSBlockInterface>(new Pass_Through(args.configuration, args.role, args.in_streams, args.out_streams));
+}
+}
+
+
+TEST(GNSS_Block_Factory_Test, InstantiateRegisteredBlock)
+{
+    std::shared_ptr<InMemoryConfiguration> configuration = std::make_shared<InMemoryConfiguration>();
+    configuration->set_property("Test.item_type", "gr_complex");
+    std::unique_ptr<GNSSBlockFactory> factory(new GNSSBlockFactory());
+    EXPECT_EQ(nullptr, factory->GetBlock(configuration, "Test", "Test_Block", 1, 1));
+
+    EXPECT_TRUE(GNSSBlockFactory::register_block("Test_Block", make_test_block));
+    EXPECT_FALSE(GNSSBlockFactory::register_block("Test_Block", make_test_block));
+    EXPECT_FALSE(GNSSBlockFactory::register_block("Pass_Through", make_test_block));
+    std::unique_ptr<GNSSBlockInterface> block = factory->GetBlock(configuration, "Test", "Test_Block", 1, 1);
+    ASSERT_NE(nullptr, block);
+    EXPECT_STREQ("Test", block->role().c_str());
+    EXPECT_STREQ("Pass_Through", block->implementation().c_str());
+}
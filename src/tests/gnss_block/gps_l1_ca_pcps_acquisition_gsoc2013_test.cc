@@ -52,6 +52,7 @@
 #include "gnss_sdr_valve.h"
 #include "boost/shared_ptr.hpp"
 #include "pass_through.h"
+#include "test_time_limits.h"
 
 
 // ######## GNURADIO BLOCK MESSAGE RECEVER #########
@@ -627,10 +628,12 @@ TEST_F(GpsL1CaPcpsAcquisitionGSoC2013Test, ValidationOfResultsProbabilities)
             {
                 std::cout << "Estimated probability of detection = " << Pd << std::endl;
                 std::cout << "Estimated probability of false alarm (satellite present) = " << Pfa_p << std::endl;
+                EXPECT_LE(mean_acq_time_us, test_time_limit_us(TEST_MAX_ACQ_MS_GPS_L1_CA)) << "Acquisition slower than " << TEST_MAX_ACQ_MS_GPS_L1_CA << " ms";
                 std::cout << "Mean acq time = " << mean_acq_time_us << " microseconds." << std::endl;           }
             else if (i == 1)
             {
                 std::cout << "Estimated probability of false alarm (satellite absent) = " << Pfa_a << std::endl;
+                EXPECT_LE(mean_acq_time_us, test_time_limit_us(TEST_MAX_ACQ_MS_GPS_L1_CA)) << "Acquisition slower than " << TEST_MAX_ACQ_MS_GPS_L1_CA << " ms";
                 std::cout << "Mean acq time = " << mean_acq_time_us << " microseconds." << std::endl;
             }
 #ifdef OLD_BOOST
@@ -38,7 +38,6 @@
 #include <boost/chrono.hpp>
 #include <boost/make_shared.hpp>
 #include <gnuradio/top_block.h>
-#include <gnuradio/blocks/file_source.h>
 #include <gnuradio/analog/sig_source_waveform.h>
 #include <gnuradio/analog/sig_source_c.h>
 #include <gnuradio/msg_queue.h>
@@ -50,6 +49,8 @@
 #include "gnss_sdr_valve.h"
 #include "gnss_synchro.h"
 #include "gps_l1_ca_pcps_acquisition.h"
+#include "signal_samples.h"
+#include "test_time_limits.h"
 
 
 // ######## GNURADIO BLOCK MESSAGE RECEVER #########
@@ -233,11 +234,7 @@ TEST_F(GpsL1CaPcpsAcquisitionTest, ValidationOfResults)
     }) << "Failure connecting acquisition to the top_block." << std::endl;
 
     ASSERT_NO_THROW( {
-        std::string path = std::string(TEST_PATH);
-        //std::string file = path + "signal_samples/GSoC_CTTC_capture_2012_07_26_4Msps_4ms.dat";
-        std::string file = path + "signal_samples/GPS_L1_CA_ID_1_Fs_4Msps_2ms.dat";
-        const char * file_name = file.c_str();
-        gr::blocks::file_source::sptr file_source = gr::blocks::file_source::make(sizeof(gr_complex), file_name, false);
+        boost::shared_ptr<Signal_Samples_Source> file_source = signal_samples_source_make("signal_samples/GPS_L1_CA_ID_1_Fs_4Msps_2ms.dat");
         top_block->connect(file_source, 0, acquisition->get_left_block(), 0);
         top_block->msg_connect(acquisition->get_right_block(), pmt::mp("events"), msg_rx, pmt::mp("events"));
     }) << "Failure connecting the blocks of acquisition test." << std::endl;
@@ -257,6 +254,7 @@ TEST_F(GpsL1CaPcpsAcquisitionTest, ValidationOfResults)
 
     unsigned long int nsamples = gnss_synchro.Acq_samplestamp_samples;
     std::cout <<  "Acquired " << nsamples << " samples in " << (end - begin) << " microseconds" << std::endl;
+    EXPECT_LE(end - begin, test_time_limit_us(TEST_MAX_ACQ_MS_GPS_L1_CA)) << "Acquisition slower than " << TEST_MAX_ACQ_MS_GPS_L1_CA << " ms";
 
     ASSERT_EQ(1, msg_rx->rx_message) << "Acquisition failure. Expected message: 1=ACQ SUCCESS.";
 
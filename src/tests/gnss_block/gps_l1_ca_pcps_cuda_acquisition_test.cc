@@ -0,0 +1,225 @@
+/*!
+ * \file gps_l1_ca_pcps_cuda_acquisition_test.cc
+ * \brief  This file implements tests of the batched CUDA PCPS acquisition
+ * against the CPU PCPS acquisition
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include <gnuradio/fft/fft.h>
+#include <gnuradio/top_block.h>
+#include <gtest/gtest.h>
+#include "cuda_acquisition.h"
+#include "gnss_synchro.h"
+#include "GPS_L1_CA.h"
+#include "gps_l1_ca_pcps_acquisition.h"
+#include "gps_l1_ca_pcps_cuda_acquisition.h"
+#include "gps_sdr_signal_processing.h"
+#include "in_memory_configuration.h"
+#include "signal_samples.h"
+
+
+namespace
+{
+// conjugated FFT of the sampled code, as the acquisition blocks keep it
+std::vector<gr_complex> cuda_acquisition_test_code_fft(unsigned int PRN, int fs_in, int fft_size)
+{
+    gr::fft::fft_complex fft(fft_size, true);
+    gps_l1_ca_code_gen_complex_sampled(fft.get_inbuf(), PRN, fs_in, 0);
+    fft.execute();
+    std::vector<gr_complex> code_fft(fft_size);
+    for (int n = 0; n < fft_size; n++)
+        {
+            code_fft[n] = std::conj(fft.get_outbuf()[n]);
+        }
+    return code_fft;
+}
+
+
+// one Doppler line of the CPU PCPS search: wipeoff, FFT, product with the code FFT, inverse FFT
+Cuda_Line_Max cuda_acquisition_test_cpu_line(const std::vector<gr_complex>& in, const std::vector<gr_complex>& code_fft,
+        double cycles_per_sample, std::vector<float>& magnitude)
+{
+    int fft_size = in.size();
+    gr::fft::fft_complex fft(fft_size, true);
+    gr::fft::fft_complex ifft(fft_size, false);
+    for (int n = 0; n < fft_size; n++)
+        {
+            double cycles = cycles_per_sample * n;
+            double phase = 2.0 * GPS_PI * (cycles - std::floor(cycles));
+            fft.get_inbuf()[n] = in[n] * gr_complex(std::cos(phase), -std::sin(phase));
+        }
+    fft.execute();
+    for (int n = 0; n < fft_size; n++)
+        {
+            ifft.get_inbuf()[n] = fft.get_outbuf()[n] * code_fft[n];
+        }
+    ifft.execute();
+    Cuda_Line_Max line;
+    line.mag = -1.0;
+    line.index = 0;
+    line.power = 0.0;
+    magnitude.resize(fft_size);
+    for (int n = 0; n < fft_size; n++)
+        {
+            magnitude[n] = std::norm(ifft.get_outbuf()[n]);
+            line.power += magnitude[n];
+            if (magnitude[n] > line.mag)
+                {
+                    line.mag = magnitude[n];
+                    line.index = n;
+                }
+        }
+    return line;
+}
+}
+
+
+TEST(CudaAcquisitionTest, LineMaximaMatchTheCpuSearch)
+{
+    const int fs_in = 4000000;
+    const int fft_size = 4000;
+    const int doppler_max = 5000;
+    const int doppler_step = 500;
+    const int num_doppler_bins = 2 * doppler_max / doppler_step;
+    const int delay_samples = 524;
+    const double doppler_hz = 1500.0;
+
+    // PRN 1, delayed and shifted, in noise
+    std::srand(1);
+    std::vector<gr_complex> code(fft_size);
+    gps_l1_ca_code_gen_complex_sampled(&code[0], 1, fs_in, 0);
+    std::vector<gr_complex> in(fft_size);
+    for (int n = 0; n < fft_size; n++)
+        {
+            double phase = 2.0 * GPS_PI * doppler_hz * n / fs_in;
+            gr_complex noise(std::rand() / static_cast<float>(RAND_MAX) - 0.5, std::rand() / static_cast<float>(RAND_MAX) - 0.5);
+            in[n] = code[(n + fft_size - delay_samples) % fft_size] * gr_complex(std::cos(phase), std::sin(phase)) + noise;
+        }
+
+    // PRN 1 and a code that is not in the signal, in one batch
+    std::vector<gr_complex> code_fft_1 = cuda_acquisition_test_code_fft(1, fs_in, fft_size);
+    std::vector<gr_complex> code_fft_7 = cuda_acquisition_test_code_fft(7, fs_in, fft_size);
+    const gr_complex* code_ffts[2] = {&code_fft_1[0], &code_fft_7[0]};
+    std::vector<double> cycles_per_sample(num_doppler_bins);
+    for (int doppler_index = 0; doppler_index < num_doppler_bins; doppler_index++)
+        {
+            cycles_per_sample[doppler_index] = static_cast<double>(-doppler_max + doppler_step * doppler_index) / static_cast<double>(fs_in);
+        }
+
+    cuda_acquisition gpu;
+    ASSERT_TRUE(gpu.init_cuda(fft_size, num_doppler_bins, 2, &cycles_per_sample[0]));
+    std::vector<Cuda_Line_Max> lines(2 * num_doppler_bins);
+    ASSERT_TRUE(gpu.search(&in[0], code_ffts, 2, &lines[0]));
+
+    std::vector<float> magnitude;
+    for (int code_index = 0; code_index < 2; code_index++)
+        {
+            const std::vector<gr_complex>& code_fft = code_index == 0 ? code_fft_1 : code_fft_7;
+            for (int doppler_index = 0; doppler_index < num_doppler_bins; doppler_index++)
+                {
+                    Cuda_Line_Max expected = cuda_acquisition_test_cpu_line(in, code_fft, cycles_per_sample[doppler_index], magnitude);
+                    const Cuda_Line_Max& line = lines[code_index * num_doppler_bins + doppler_index];
+                    EXPECT_NEAR(expected.mag, line.mag, 1e-3 * expected.mag) << "code " << code_index << ", Doppler bin " << doppler_index;
+                    EXPECT_NEAR(expected.power, line.power, 1e-3 * expected.power) << "code " << code_index << ", Doppler bin " << doppler_index;
+                    // in the noise the rounding may pick another sample of (almost) the same magnitude
+                    ASSERT_GE(line.index, 0);
+                    ASSERT_LT(line.index, fft_size);
+                    EXPECT_NEAR(expected.mag, magnitude[line.index], 1e-3 * expected.mag) << "code " << code_index << ", Doppler bin " << doppler_index;
+                }
+        }
+
+    // the peak of PRN 1 is at its delay and Doppler
+    int best = 0;
+    for (int doppler_index = 1; doppler_index < num_doppler_bins; doppler_index++)
+        {
+            if (lines[doppler_index].mag > lines[best].mag)
+                {
+                    best = doppler_index;
+                }
+        }
+    EXPECT_EQ(delay_samples, lines[best].index);
+    EXPECT_EQ(doppler_hz, -doppler_max + doppler_step * best);
+    EXPECT_TRUE(gpu.free_cuda());
+}
+
+
+TEST(CudaAcquisitionTest, BlockMatchesTheCpuBlock)
+{
+    std::shared_ptr<InMemoryConfiguration> config = std::make_shared<InMemoryConfiguration>();
+    config->set_property("GNSS-SDR.internal_fs_hz", "4000000");
+    config->set_property("Acquisition.item_type", "gr_complex");
+    config->set_property("Acquisition.if", "0");
+    config->set_property("Acquisition.coherent_integration_time_ms", "1");
+    config->set_property("Acquisition.dump", "false");
+    config->set_property("Acquisition.use_CFAR_algorithm", "false");
+    config->set_property("Acquisition.threshold", "0.001");
+    config->set_property("Acquisition.repeat_satellite", "false");
+    config->set_property("Acquisition.pfa", "0.0");
+
+    // the same search of the same samples on the CPU and on the GPU
+    Gnss_Synchro gnss_synchro[2];
+    for (int i = 0; i < 2; i++)
+        {
+            gnss_synchro[i] = Gnss_Synchro();
+            gnss_synchro[i].Channel_ID = i;
+            gnss_synchro[i].System = 'G';
+            std::string signal = "1C";
+            signal.copy(gnss_synchro[i].Signal, 2, 0);
+            gnss_synchro[i].PRN = 1;
+        }
+    std::vector<std::shared_ptr<AcquisitionInterface> > acquisitions;
+    acquisitions.push_back(std::make_shared<GpsL1CaPcpsAcquisition>(config.get(), "Acquisition", 1, 1));
+    acquisitions.push_back(std::make_shared<GpsL1CaPcpsCudaAcquisition>(config.get(), "Acquisition", 1, 1));
+
+    for (int i = 0; i < 2; i++)
+        {
+            gr::top_block_sptr top_block = gr::make_top_block("CUDA acquisition test");
+            acquisitions[i]->set_channel(i);
+            acquisitions[i]->set_gnss_synchro(&gnss_synchro[i]);
+            acquisitions[i]->set_threshold(0.1);
+            acquisitions[i]->set_doppler_max(10000);
+            acquisitions[i]->set_doppler_step(250);
+            acquisitions[i]->connect(top_block);
+            boost::shared_ptr<Signal_Samples_Source> file_source = signal_samples_source_make("signal_samples/GPS_L1_CA_ID_1_Fs_4Msps_2ms.dat");
+            top_block->connect(file_source, 0, acquisitions[i]->get_left_block(), 0);
+            acquisitions[i]->set_state(1);
+            acquisitions[i]->init();
+            top_block->run();
+        }
+
+    EXPECT_EQ(gnss_synchro[0].Acq_samplestamp_samples, gnss_synchro[1].Acq_samplestamp_samples);
+    EXPECT_EQ(gnss_synchro[0].Acq_delay_samples, gnss_synchro[1].Acq_delay_samples);
+    EXPECT_EQ(gnss_synchro[0].Acq_doppler_hz, gnss_synchro[1].Acq_doppler_hz);
+}
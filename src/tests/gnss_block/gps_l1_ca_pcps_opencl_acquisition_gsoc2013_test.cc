@@ -50,6 +50,7 @@
 #include "fir_filter.h"
 #include "gen_signal_source.h"
 #include "gnss_sdr_valve.h"
+#include "test_time_limits.h"
 
 // ######## GNURADIO BLOCK MESSAGE RECEVER #########
 class GpsL1CaPcpsOpenClAcquisitionGSoC2013Test_msg_rx;
@@ -605,11 +606,13 @@ TEST_F(GpsL1CaPcpsOpenClAcquisitionGSoC2013Test, ValidationOfResultsProbabilitie
             {
                 std::cout << "Estimated probability of detection = " << Pd << std::endl;
                 std::cout << "Estimated probability of false alarm (satellite present) = " << Pfa_p << std::endl;
+                EXPECT_LE(mean_acq_time_us, test_time_limit_us(TEST_MAX_ACQ_MS_GPS_L1_CA)) << "Acquisition slower than " << TEST_MAX_ACQ_MS_GPS_L1_CA << " ms";
                 std::cout << "Mean acq time = " << mean_acq_time_us << " microseconds." << std::endl;
             }
             else if (i == 1)
             {
                 std::cout << "Estimated probability of false alarm (satellite absent) = " << Pfa_a << std::endl;
+                EXPECT_LE(mean_acq_time_us, test_time_limit_us(TEST_MAX_ACQ_MS_GPS_L1_CA)) << "Acquisition slower than " << TEST_MAX_ACQ_MS_GPS_L1_CA << " ms";
                 std::cout << "Mean acq time = " << mean_acq_time_us << " microseconds." << std::endl;
             }
         }
@@ -51,6 +51,7 @@
 #include "signal_generator.h"
 #include "signal_generator_c.h"
 #include "gps_l1_ca_pcps_quicksync_acquisition.h"
+#include "test_time_limits.h"
 
 DEFINE_double(value_threshold, 1, "Value of the threshold for the acquisition");
 DEFINE_int32(value_CN0_dB_0, 44, "Value for the CN0_dB_0 in channel 0");
@@ -842,6 +843,7 @@ TEST_F(GpsL1CaPcpsQuickSyncAcquisitionGSoC2014Test, ValidationOfResultsProbabili
                     std::cout << "Estimated probability of detection = " << Pd << std::endl;
                     std::cout << "Estimated probability of false alarm (satellite present) = " << Pfa_p << std::endl;
                     std::cout << "Estimated probability of miss detection (satellite present) = " << Pmd << std::endl;
+                    EXPECT_LE(mean_acq_time_us, test_time_limit_us(TEST_MAX_ACQ_MS_GPS_L1_CA)) << "Acquisition slower than " << TEST_MAX_ACQ_MS_GPS_L1_CA << " ms";
                     std::cout << "Mean acq time = " << mean_acq_time_us << " microseconds." << std::endl;
 
                     if(dump_test_results)
@@ -860,6 +862,7 @@ TEST_F(GpsL1CaPcpsQuickSyncAcquisitionGSoC2014Test, ValidationOfResultsProbabili
             else if (i == 1)
                 {
                     std::cout << "Estimated probability of false alarm (satellite absent) = " << Pfa_a << std::endl;
+                    EXPECT_LE(mean_acq_time_us, test_time_limit_us(TEST_MAX_ACQ_MS_GPS_L1_CA)) << "Acquisition slower than " << TEST_MAX_ACQ_MS_GPS_L1_CA << " ms";
                     std::cout << "Mean acq time = " << mean_acq_time_us << " microseconds." << std::endl;
 
                     if(dump_test_results)
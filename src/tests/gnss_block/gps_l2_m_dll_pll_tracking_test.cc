@@ -34,7 +34,6 @@
 #include <ctime>
 #include <iostream>
 #include <gnuradio/top_block.h>
-#include <gnuradio/blocks/file_source.h>
 #include <gnuradio/analog/sig_source_waveform.h>
 #include <gnuradio/analog/sig_source_c.h>
 #include <gnuradio/msg_queue.h>
@@ -48,6 +47,7 @@
 #include "gnss_sdr_valve.h"
 #include "gnss_synchro.h"
 #include "gps_l2_m_dll_pll_tracking.h"
+#include "signal_samples.h"
 
 
 // ######## GNURADIO BLOCK MESSAGE RECEVER #########
@@ -180,10 +180,7 @@ TEST_F(GpsL2MDllPllTrackingTest, ValidationOfResults)
 
     ASSERT_NO_THROW( {
         //gr::analog::sig_source_c::sptr source = gr::analog::sig_source_c::make(fs_in, gr::analog::GR_SIN_WAVE, 1000, 1, gr_complex(0));
-        std::string path = std::string(TEST_PATH);
-        std::string file =  path + "/data/gps_l2c_m_prn7_5msps.dat";
-        const char * file_name = file.c_str();
-        gr::blocks::file_source::sptr file_source = gr::blocks::file_source::make(sizeof(gr_complex), file_name, false);
+        boost::shared_ptr<Signal_Samples_Source> file_source = signal_samples_source_make("data/gps_l2c_m_prn7_5msps.dat");
         boost::shared_ptr<gr::block> valve = gnss_sdr_make_valve(sizeof(gr_complex), nsamples, queue);
         gr::blocks::null_sink::sptr sink = gr::blocks::null_sink::make(sizeof(Gnss_Synchro));
         top_block->connect(file_source, 0, valve, 0);
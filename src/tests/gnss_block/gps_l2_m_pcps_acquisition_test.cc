@@ -39,7 +39,6 @@
 #include <boost/chrono.hpp>
 #include <boost/make_shared.hpp>
 #include <gnuradio/top_block.h>
-#include <gnuradio/blocks/file_source.h>
 #include <gnuradio/analog/sig_source_waveform.h>
 #include <gnuradio/analog/sig_source_c.h>
 #include <gnuradio/blocks/interleaved_short_to_complex.h>
@@ -54,6 +53,8 @@
 #include "gnss_synchro.h"
 #include "gps_l2_m_pcps_acquisition.h"
 #include "GPS_L2C.h"
+#include "signal_samples.h"
+#include "test_time_limits.h"
 
 
 // ######## GNURADIO BLOCK MESSAGE RECEVER #########
@@ -239,12 +240,7 @@ TEST_F(GpsL2MPcpsAcquisitionTest, ValidationOfResults)
     }) << "Failure connecting acquisition to the top_block." << std::endl;
 
     ASSERT_NO_THROW( {
-        std::string path = std::string(TEST_PATH);
-        //std::string file = path + "signal_samples/GSoC_CTTC_capture_2012_07_26_4Msps_4ms.dat";
-        std::string file = path + "/data/gps_l2c_m_prn7_5msps.dat";
-        //std::string file = "/datalogger/signals/Fraunhofer/L125_III1b_210s_L2_resampled.bin";
-        const char * file_name = file.c_str();
-        gr::blocks::file_source::sptr file_source = gr::blocks::file_source::make(sizeof(gr_complex), file_name, false);
+        boost::shared_ptr<Signal_Samples_Source> file_source = signal_samples_source_make("data/gps_l2c_m_prn7_5msps.dat");
         //gr::blocks::interleaved_short_to_complex::sptr gr_interleaved_short_to_complex_ = gr::blocks::interleaved_short_to_complex::make();
         //gr::blocks::char_to_short::sptr gr_char_to_short_ = gr::blocks::char_to_short::make();
         boost::shared_ptr<gr::block> valve = gnss_sdr_make_valve(sizeof(gr_complex), nsamples, queue);
@@ -271,6 +267,7 @@ TEST_F(GpsL2MPcpsAcquisitionTest, ValidationOfResults)
 
     //unsigned long int Acq_samplestamp_samples = gnss_synchro.Acq_samplestamp_samples;
     std::cout <<  "Acquisition process runtime duration: " << (end - begin) << " microseconds" << std::endl;
+    EXPECT_LE(end - begin, test_time_limit_us(TEST_MAX_ACQ_MS_GPS_L2_M)) << "Acquisition slower than " << TEST_MAX_ACQ_MS_GPS_L2_M << " ms";
 
     std::cout <<  "gnss_synchro.Acq_doppler_hz = " << gnss_synchro.Acq_doppler_hz << " Hz" << std::endl;
     std::cout <<  "gnss_synchro.Acq_delay_samples = " << gnss_synchro.Acq_delay_samples << " Samples" << std::endl;
@@ -0,0 +1,113 @@
+/*!
+ * \file reacquisition_window_test.cc
+ * \brief Tests of the narrow search window used to reacquire lost satellites
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <vector>
+#include <gtest/gtest.h>
+#include "reacquisition_window.h"
+
+
+TEST(ReacquisitionWindowTest, CentersOnTheHint)
+{
+    // 4 Msps, 1 ms codes, grid from -10 kHz to 10 kHz in 500 Hz steps
+    Reacquisition_Window window(4000000, 4000, 1575.42e6, 10000, 500, 41, 500, 8);
+    Reacquisition_Hint hint;
+    hint.doppler_hz = 1200.0;
+    hint.code_start = 100123;
+    ASSERT_TRUE(window.center(hint, 100000));
+    // 1000, 1500 Hz
+    EXPECT_EQ(22u, window.first_doppler_index());
+    EXPECT_EQ(2u, window.num_doppler_bins());
+    EXPECT_EQ(123u, window.code_phase());
+
+    // a code period later, the code Doppler has moved the code start back a fraction of a sample
+    hint.code_start = 100000 - 3 * 4000 + 1;
+    ASSERT_TRUE(window.center(hint, 100000));
+    EXPECT_EQ(1u, window.code_phase());
+
+    hint.doppler_hz = 20000.0;
+    EXPECT_FALSE(window.center(hint, 100000));
+}
+
+
+TEST(ReacquisitionWindowTest, SearchesOnlyTheCodeWindow)
+{
+    Reacquisition_Window window(4000000, 4000, 1575.42e6, 10000, 500, 41, 500, 8);
+    Reacquisition_Hint hint;
+    hint.doppler_hz = 0.0;
+    hint.code_start = 3998;
+    ASSERT_TRUE(window.center(hint, 0));
+
+    std::vector<float> magnitude(4000, 1.0);
+    magnitude[2000] = 100.0; // out of the window
+    magnitude[3] = 10.0;     // in the window, wrapped around the code period
+    EXPECT_EQ(3u, window.index_max(&magnitude[0], magnitude.size()));
+}
+
+
+TEST(ReacquisitionWindowTest, RepeatsTheWindowOverTheCodeAmbiguity)
+{
+    // 4 Msps GPS L2 CM search (20 ms codes) with the hint of the L1 C/A tracking
+    Reacquisition_Window window(4000000, 80000, 1227.6e6, 5000, 25, 401, 100, 8);
+    window.set_code_ambiguity(4000);
+    Reacquisition_Hint hint;
+    hint.doppler_hz = 0.0;
+    hint.code_start = 1000123;
+    ASSERT_TRUE(window.center(hint, 1000000));
+    EXPECT_EQ(9u, window.num_doppler_bins()); // -100 to 100 Hz, instead of the 401 of the grid
+
+    // the CM code starts in an unknown C/A code period
+    std::vector<float> magnitude(80000, 1.0);
+    magnitude[40000] = 100.0;          // out of the window
+    magnitude[13 * 4000 + 125] = 10.0; // in the window, 13 C/A code periods later
+    EXPECT_EQ(13u * 4000u + 125u, window.index_max(&magnitude[0], magnitude.size()));
+}
+
+
+TEST(ReacquisitionWindowTest, ClearsTheCodePhasesOutOfTheWindow)
+{
+    Reacquisition_Window window(4000000, 4000, 1575.42e6, 10000, 500, 41, 500, 8);
+    Reacquisition_Hint hint;
+    hint.doppler_hz = 0.0;
+    hint.code_start = 3998;
+    ASSERT_TRUE(window.center(hint, 0));
+
+    std::vector<float> magnitude(4000, 1.0);
+    window.clear_outside(&magnitude[0], magnitude.size());
+    float in_window = 0.0;
+    for (unsigned int i = 0; i < magnitude.size(); i++)
+        {
+            in_window += magnitude[i];
+        }
+    EXPECT_EQ(17.0, in_window); // 3990 to 4006, wrapped around the code period
+    EXPECT_EQ(1.0, magnitude[3990]);
+    EXPECT_EQ(1.0, magnitude[6]);
+    EXPECT_EQ(0.0, magnitude[7]);
+    EXPECT_EQ(0.0, magnitude[3989]);
+}
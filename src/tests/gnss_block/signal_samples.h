@@ -0,0 +1,154 @@
+/*!
+ * \file signal_samples.h
+ * \brief Signal sample files of the tests, mapped once per process
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_TESTS_SIGNAL_SAMPLES_H_
+#define GNSS_SDR_TESTS_SIGNAL_SAMPLES_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_block.h>
+
+/*!
+ * \brief A gr_complex file of src/tests, mapped read only
+ * the first time a test asks for it and shared by all the tests of the
+ * process, whatever their thread. The mapping lasts until the exit.
+ */
+class Signal_Samples
+{
+public:
+    /*!
+     * \brief The samples of the file TEST_PATH name, such as
+     * "signal_samples/GPS_L1_CA_ID_1_Fs_4Msps_2ms.dat", none if it cannot
+     * be mapped
+     */
+    static std::shared_ptr<const Signal_Samples> get(const std::string& name)
+    {
+        static std::mutex mutex;
+        static std::map<std::string, std::shared_ptr<const Signal_Samples> > files;
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<const Signal_Samples>& samples = files[name];
+        if (!samples)
+            {
+                samples.reset(new Signal_Samples(std::string(TEST_PATH) + name));
+            }
+        return samples;
+    }
+
+    ~Signal_Samples()
+    {
+        if (d_map != 0)
+            {
+                munmap(d_map, d_bytes);
+            }
+    }
+
+    const gr_complex* data() const { return static_cast<const gr_complex*>(d_map); }
+    size_t size() const { return d_bytes / sizeof(gr_complex); }
+
+private:
+    explicit Signal_Samples(const std::string& filename) : d_map(0), d_bytes(0)
+    {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        struct stat status;
+        if (fd < 0)
+            {
+                return;
+            }
+        if (fstat(fd, &status) == 0 && status.st_size > 0)
+            {
+                void* map = mmap(0, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (map != MAP_FAILED)
+                    {
+                        d_map = map;
+                        d_bytes = status.st_size;
+                    }
+            }
+        ::close(fd);
+    }
+
+    Signal_Samples(const Signal_Samples&);
+    Signal_Samples& operator=(const Signal_Samples&);
+
+    void* d_map;
+    size_t d_bytes;
+};
+
+
+/*!
+ * \brief Source block of the samples of a Signal_Samples file, played once,
+ * in place of a gr::blocks::file_source: the file is neither opened nor
+ * read again by each test.
+ */
+class Signal_Samples_Source : public gr::sync_block
+{
+public:
+    explicit Signal_Samples_Source(std::shared_ptr<const Signal_Samples> samples) :
+        gr::sync_block("signal_samples_source",
+                gr::io_signature::make(0, 0, 0),
+                gr::io_signature::make(1, 1, sizeof(gr_complex))),
+        d_samples(samples),
+        d_next(0)
+    {}
+
+    int work(int noutput_items, gr_vector_const_void_star& input_items, gr_vector_void_star& output_items)
+    {
+        size_t items = std::min(static_cast<size_t>(noutput_items), d_samples->size() - d_next);
+        if (items == 0)
+            {
+                return WORK_DONE;
+            }
+        std::memcpy(output_items[0], d_samples->data() + d_next, items * sizeof(gr_complex));
+        d_next += items;
+        return static_cast<int>(items);
+    }
+
+private:
+    std::shared_ptr<const Signal_Samples> d_samples;
+    size_t d_next;
+};
+
+
+inline boost::shared_ptr<Signal_Samples_Source> signal_samples_source_make(const std::string& name)
+{
+    return boost::shared_ptr<Signal_Samples_Source>(new Signal_Samples_Source(Signal_Samples::get(name)));
+}
+
+#endif
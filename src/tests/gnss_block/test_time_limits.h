@@ -0,0 +1,63 @@
+/*!
+ * \file test_time_limits.h
+ * \brief Longest times of the timed steps of the block tests
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#ifndef GNSS_SDR_TESTS_TEST_TIME_LIMITS_H_
+#define GNSS_SDR_TESTS_TEST_TIME_LIMITS_H_
+
+#include <cstdlib>
+#include <limits>
+
+/*
+ * Longest mean time of one acquisition in the acquisition tests, in ms,
+ * in a Release build. They are well above the times of a desktop CPU, so
+ * that only a real slowdown of the blocks fails.
+ */
+#define TEST_MAX_ACQ_MS_GPS_L1_CA 100.0     // 1 ms of code, searched over +/- 10 kHz
+#define TEST_MAX_ACQ_MS_GALILEO_E1 500.0    // 4 ms (or 8 ms) of code
+#define TEST_MAX_ACQ_MS_GPS_L2_M 10000.0    // 20 ms of code, in 10 Hz steps
+
+/*!
+ * \brief A limit of max_ms in us, scaled by the environment variable
+ * GNSS_SDR_TEST_TIME_SCALE (set by CMake for Debug and Coverage builds,
+ * or by hand on a slow machine). A scale of 0 lifts the limits.
+ */
+inline double test_time_limit_us(double max_ms)
+{
+    const char* scale = std::getenv("GNSS_SDR_TEST_TIME_SCALE");
+    double factor = scale != 0 ? std::atof(scale) : 1.0;
+    if (factor <= 0.0)
+        {
+            return std::numeric_limits<double>::max();
+        }
+    return max_ms * 1000.0 * factor;
+}
+
+#endif
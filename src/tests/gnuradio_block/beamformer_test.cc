@@ -0,0 +1,164 @@
+/*!
+ * \file beamformer_test.cc
+ * \brief  This file implements tests for the beamformer block
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <vector>
+#include <gtest/gtest.h>
+#include <gnuradio/top_block.h>
+#include <gnuradio/blocks/vector_source_c.h>
+#include <gnuradio/blocks/vector_sink_c.h>
+#include "beamformer.h"
+
+
+static gr_complex beamformer_test_noise()
+{
+    return gr_complex(std::rand() / static_cast<float>(RAND_MAX) - 0.5, std::rand() / static_cast<float>(RAND_MAX) - 0.5);
+}
+
+
+static std::vector<gr_complex> beamformer_test_run(beamformer_sptr beamformer,
+        const std::vector<std::vector<gr_complex> >& channels)
+{
+    gr::top_block_sptr top_block = gr::make_top_block("beamformer_test");
+    gr::blocks::vector_sink_c::sptr sink = gr::blocks::vector_sink_c::make();
+    for (unsigned int k = 0; k < channels.size(); k++)
+        {
+            top_block->connect(gr::blocks::vector_source_c::make(channels[k]), 0, beamformer, k);
+        }
+    top_block->connect(beamformer, 0, sink, 0);
+    top_block->run();
+    return sink->data();
+}
+
+
+TEST(Beamformer_Test, FixedWeightsSumTheChannels)
+{
+    std::srand(1);
+    std::vector<std::vector<gr_complex> > channels(8, std::vector<gr_complex>(10000));
+    for (unsigned int k = 0; k < channels.size(); k++)
+        {
+            for (unsigned int n = 0; n < channels[k].size(); n++)
+                {
+                    channels[k][n] = beamformer_test_noise();
+                }
+        }
+
+    std::vector<gr_complex> result = beamformer_test_run(make_beamformer(), channels);
+    ASSERT_EQ(channels[0].size(), result.size());
+    for (unsigned int n = 0; n < result.size(); n++)
+        {
+            gr_complex expected(0, 0);
+            for (unsigned int k = 0; k < channels.size(); k++)
+                {
+                    expected += channels[k][n];
+                }
+            ASSERT_NEAR(expected.real(), result[n].real(), 1e-4) << "at output " << n;
+            ASSERT_NEAR(expected.imag(), result[n].imag(), 1e-4) << "at output " << n;
+        }
+}
+
+
+TEST(Beamformer_Test, FilteredChunksMatchTheFilteredChannels)
+{
+    std::srand(3);
+    std::vector<std::vector<gr_complex> > channels(8, std::vector<gr_complex>(50000));
+    for (unsigned int k = 0; k < channels.size(); k++)
+        {
+            for (unsigned int n = 0; n < channels[k].size(); n++)
+                {
+                    channels[k][n] = beamformer_test_noise();
+                }
+        }
+    std::vector<float> taps = { 0.1, -0.2, 0.5, 1.0, 0.5, -0.2, 0.1 };
+
+    beamformer_sptr beamformer = make_beamformer(BEAMFORMER_GR_COMPLEX, false, 0, 0, 1, 1, 0.0, taps, 3);
+    EXPECT_EQ(3u, beamformer->num_threads());
+    std::vector<gr_complex> result = beamformer_test_run(beamformer, channels);
+    ASSERT_EQ(channels[0].size(), result.size());
+    for (unsigned int n = 0; n < result.size(); n++)
+        {
+            // each channel filtered on its own, starting from zeros, then summed
+            gr_complex expected(0, 0);
+            for (unsigned int k = 0; k < channels.size(); k++)
+                {
+                    for (unsigned int t = 0; t < taps.size() && t <= n; t++)
+                        {
+                            expected += taps[t] * channels[k][n - t];
+                        }
+                }
+            ASSERT_NEAR(expected.real(), result[n].real(), 1e-4) << "at output " << n;
+            ASSERT_NEAR(expected.imag(), result[n].imag(), 1e-4) << "at output " << n;
+        }
+}
+
+
+TEST(Beamformer_Test, AdaptiveWeightsNullAnInterferer)
+{
+    // a wideband interferer 40 dB above the noise, with a phase step of 0.7 rad between elements
+    std::srand(2);
+    std::vector<std::vector<gr_complex> > channels(8, std::vector<gr_complex>(200000));
+    double noise_power = 0.0;
+    for (unsigned int n = 0; n < channels[0].size(); n++)
+        {
+            gr_complex jammer = 100.0f * beamformer_test_noise();
+            for (unsigned int k = 0; k < channels.size(); k++)
+                {
+                    gr_complex noise = beamformer_test_noise();
+                    channels[k][n] = noise + jammer * std::polar(1.0f, 0.7f * k);
+                    noise_power += std::norm(noise);
+                }
+        }
+    noise_power /= channels.size() * channels[0].size();
+
+    beamformer_sptr beamformer = make_beamformer(BEAMFORMER_GR_COMPLEX, true, 0, 50000, 4, 4096, 0.001);
+    std::vector<gr_complex> result = beamformer_test_run(beamformer, channels);
+    ASSERT_EQ(channels[0].size(), result.size());
+
+    // the weights of the reference channel stay at one
+    std::vector<gr_complex> weights = beamformer->weights();
+    EXPECT_NEAR(1.0, weights[0].real(), 1e-4);
+    EXPECT_NEAR(0.0, weights[0].imag(), 1e-4);
+
+    // after the first estimation, the output is close to the noise floor
+    double input_power = 0.0;
+    double output_power = 0.0;
+    for (unsigned int n = result.size() / 2; n < result.size(); n++)
+        {
+            input_power += std::norm(channels[0][n]);
+            output_power += std::norm(result[n]);
+        }
+    EXPECT_GT(input_power, 1000.0 * output_power);
+    EXPECT_LT(output_power / (result.size() / 2), 3.0 * noise_power);
+}
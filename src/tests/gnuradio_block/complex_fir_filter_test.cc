@@ -0,0 +1,129 @@
+/*!
+ * \file complex_fir_filter_test.cc
+ * \brief  This file implements tests for the complex FIR filter block
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <cstdlib>
+#include <vector>
+#include <gtest/gtest.h>
+#include <gnuradio/top_block.h>
+#include <gnuradio/blocks/vector_source_c.h>
+#include <gnuradio/blocks/vector_source_s.h>
+#include <gnuradio/blocks/vector_sink_c.h>
+#include <gnuradio/blocks/interleaved_short_to_complex.h>
+#include <gnuradio/filter/fir_filter_ccf.h>
+#include "complex_fir_filter.h"
+
+
+static std::vector<float> complex_fir_filter_test_taps()
+{
+    std::vector<float> taps;
+    for (unsigned int i = 0; i < 63; i++)
+        {
+            taps.push_back(0.02 * ((i * 7) % 11) - 0.1);
+        }
+    return taps;
+}
+
+
+TEST(Complex_Fir_Filter_Test, FftMatchesDirectForm)
+{
+    std::vector<float> taps = complex_fir_filter_test_taps();
+    std::vector<gr_complex> samples(50000);
+    std::srand(1);
+    for (unsigned int i = 0; i < samples.size(); i++)
+        {
+            samples[i] = gr_complex(std::rand() % 200 - 100, std::rand() % 200 - 100);
+        }
+
+    gr::top_block_sptr top_block = gr::make_top_block("complex_fir_filter_test");
+    gr::blocks::vector_source_c::sptr source = gr::blocks::vector_source_c::make(samples);
+    gr::filter::fir_filter_ccf::sptr direct = gr::filter::fir_filter_ccf::make(1, taps);
+    complex_fir_filter_sptr fft = make_complex_fir_filter(COMPLEX_FIR_GR_COMPLEX, COMPLEX_FIR_GR_COMPLEX, taps, 48);
+    gr::blocks::vector_sink_c::sptr direct_sink = gr::blocks::vector_sink_c::make();
+    gr::blocks::vector_sink_c::sptr fft_sink = gr::blocks::vector_sink_c::make();
+    top_block->connect(source, 0, direct, 0);
+    top_block->connect(direct, 0, direct_sink, 0);
+    top_block->connect(source, 0, fft, 0);
+    top_block->connect(fft, 0, fft_sink, 0);
+    top_block->run();
+
+    EXPECT_TRUE(fft->uses_fft());
+    std::vector<gr_complex> expected = direct_sink->data();
+    std::vector<gr_complex> result = fft_sink->data();
+    // the FFT path outputs whole blocks only
+    ASSERT_LE(result.size(), expected.size());
+    ASSERT_GT(result.size(), 49000u);
+    for (unsigned int i = 0; i < result.size(); i++)
+        {
+            ASSERT_NEAR(expected[i].real(), result[i].real(), 0.01) << "at output " << i;
+            ASSERT_NEAR(expected[i].imag(), result[i].imag(), 0.01) << "at output " << i;
+        }
+}
+
+
+TEST(Complex_Fir_Filter_Test, FiltersCshortAsComplex)
+{
+    std::vector<float> taps = complex_fir_filter_test_taps();
+    std::vector<short> samples(2 * 20000);
+    std::srand(2);
+    for (unsigned int i = 0; i < samples.size(); i++)
+        {
+            samples[i] = std::rand() % 2000 - 1000;
+        }
+
+    // vector_source_s with vlen 2 gives one cshort item per I/Q pair
+    gr::top_block_sptr top_block = gr::make_top_block("complex_fir_filter_test");
+    gr::blocks::vector_source_s::sptr source = gr::blocks::vector_source_s::make(samples, false, 2);
+    gr::blocks::vector_source_s::sptr chain_source = gr::blocks::vector_source_s::make(samples);
+    gr::blocks::interleaved_short_to_complex::sptr to_complex = gr::blocks::interleaved_short_to_complex::make();
+    gr::filter::fir_filter_ccf::sptr direct = gr::filter::fir_filter_ccf::make(1, taps);
+    complex_fir_filter_sptr filter = make_complex_fir_filter(COMPLEX_FIR_CSHORT, COMPLEX_FIR_GR_COMPLEX, taps, 0);
+    gr::blocks::vector_sink_c::sptr direct_sink = gr::blocks::vector_sink_c::make();
+    gr::blocks::vector_sink_c::sptr sink = gr::blocks::vector_sink_c::make();
+    top_block->connect(chain_source, 0, to_complex, 0);
+    top_block->connect(to_complex, 0, direct, 0);
+    top_block->connect(direct, 0, direct_sink, 0);
+    top_block->connect(source, 0, filter, 0);
+    top_block->connect(filter, 0, sink, 0);
+    top_block->run();
+
+    EXPECT_FALSE(filter->uses_fft());
+    std::vector<gr_complex> expected = direct_sink->data();
+    std::vector<gr_complex> result = sink->data();
+    ASSERT_EQ(expected.size(), result.size());
+    for (unsigned int i = 0; i < result.size(); i++)
+        {
+            ASSERT_NEAR(expected[i].real(), result[i].real(), 0.01) << "at output " << i;
+            ASSERT_NEAR(expected[i].imag(), result[i].imag(), 0.01) << "at output " << i;
+        }
+}
@@ -0,0 +1,84 @@
+/*!
+ * \file flight_recorder_test.cc
+ * \brief  This file implements tests for the flight recorder block
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <gnuradio/top_block.h>
+#include <gnuradio/blocks/vector_source_c.h>
+#include "flight_recorder.h"
+
+
+TEST(Flight_Recorder_Test, StoresTheSamplesAfterTheTrigger)
+{
+    std::vector<gr_complex> input(300000);
+    for (unsigned int n = 0; n < input.size(); n++)
+        {
+            input[n] = gr_complex(static_cast<float>(n), -static_cast<float>(n));
+        }
+    std::string filename = "./flight_recorder_test";
+    {
+        gr::top_block_sptr top_block = gr::make_top_block("flight_recorder_test");
+        flight_recorder_sptr recorder = make_flight_recorder(sizeof(gr_complex), 1e6, 0.05, 0.1, filename);
+        top_block->connect(gr::blocks::vector_source_c::make(input), 0, recorder, 0);
+        // taken at the first item, so there are no samples before the trigger
+        flight_recorder_trigger_all("test");
+        top_block->run();
+        EXPECT_EQ(input.size(), recorder->items());
+        // the destructor waits for the capture to be stored
+    }
+
+    std::ifstream file((filename + "_0.dat").c_str(), std::ios::in | std::ios::binary);
+    ASSERT_TRUE(file.is_open());
+    std::vector<gr_complex> capture(input.size());
+    file.read(reinterpret_cast<char*>(&capture[0]), capture.size() * sizeof(gr_complex));
+    ASSERT_EQ(static_cast<std::streamsize>(100000 * sizeof(gr_complex)), file.gcount());
+    file.close();
+    for (unsigned int n = 0; n < 100000; n++)
+        {
+            ASSERT_EQ(input[n], capture[n]);
+        }
+
+    std::ifstream description((filename + "_0.txt").c_str());
+    std::string line;
+    ASSERT_TRUE(std::getline(description, line));
+    EXPECT_EQ("reason: test", line);
+    ASSERT_TRUE(std::getline(description, line));
+    EXPECT_EQ("trigger_item: 0", line);
+    description.close();
+    std::remove((filename + "_0.dat").c_str());
+    std::remove((filename + "_0.txt").c_str());
+}
@@ -0,0 +1,126 @@
+/*!
+ * \file gps_l1_ca_telemetry_decoder_dormant_test.cc
+ * \brief  This file implements tests for the GPS L1 C/A telemetry decoder
+ * on a mix of dormant and tracked epochs
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <gtest/gtest.h>
+#include <gnuradio/top_block.h>
+#include <gnuradio/blocks/vector_source_b.h>
+#include <gnuradio/blocks/vector_sink_b.h>
+#include "GPS_L1_CA.h"
+#include "gnss_satellite.h"
+#include "gnss_synchro.h"
+#include "gps_l1_ca_telemetry_decoder_cc.h"
+
+
+TEST(Gps_L1_Ca_Telemetry_Decoder_Dormant_Test, DecimatesAndKeepsThePreamblesAcrossADormantRun)
+{
+    std::srand(1);
+    unsigned short int preamble_bits[GPS_CA_PREAMBLE_LENGTH_BITS] = GPS_PREAMBLE;
+    std::vector<int> preamble;
+    for (int i = 0; i < GPS_CA_PREAMBLE_LENGTH_BITS; i++)
+        {
+            for (int j = 0; j < GPS_CA_TELEMETRY_SYMBOLS_PER_BIT; j++)
+                {
+                    preamble.push_back(preamble_bits[i] == 1 ? 1 : -1);
+                }
+        }
+
+    // tracked, then dormant (PRN 0) and tracked again. The second preamble
+    // starts at the first tracked epoch after the dormant run, one subframe
+    // after the first one, so that it confirms the frame sync.
+    const unsigned int dormant_begin = 1000;
+    const unsigned int dormant_end = 6203;
+    const unsigned int first_preamble = dormant_end - GPS_SUBFRAME_MS;
+    const unsigned int n_epochs = 7400;
+    const int decimation = 4;
+    std::vector<Gnss_Synchro> epochs(n_epochs);
+    for (unsigned int n = 0; n < n_epochs; n++)
+        {
+            std::memset(&epochs[n], 0, sizeof(Gnss_Synchro));
+            epochs[n].System = 'G';
+            epochs[n].Tracking_timestamp_secs = 0.001 * n;
+            if (n < dormant_begin or n >= dormant_end)
+                {
+                    epochs[n].PRN = 1;
+                    epochs[n].Prompt_I = (std::rand() & 1) ? 1.0 : -1.0;
+                    epochs[n].correlation_length_ms = 1;
+                    epochs[n].Flag_valid_symbol_output = true;
+                }
+        }
+    for (unsigned int i = 0; i < preamble.size(); i++)
+        {
+            epochs[first_preamble + i].Prompt_I = preamble[i];
+            epochs[dormant_end + i].Prompt_I = preamble[i];
+        }
+
+    std::vector<unsigned char> input(n_epochs * sizeof(Gnss_Synchro));
+    std::memcpy(&input[0], &epochs[0], input.size());
+    gr::top_block_sptr top_block = gr::make_top_block("gps_l1_ca_telemetry_decoder_dormant_test");
+    gr::blocks::vector_source_b::sptr source = gr::blocks::vector_source_b::make(input, false, sizeof(Gnss_Synchro));
+    gps_l1_ca_telemetry_decoder_cc_sptr decoder = gps_l1_ca_make_telemetry_decoder_cc(Gnss_Satellite("GPS", 1), false);
+    decoder->set_decimation(decimation);
+    gr::blocks::vector_sink_b::sptr sink = gr::blocks::vector_sink_b::make(sizeof(Gnss_Synchro));
+    top_block->connect(source, 0, decoder, 0);
+    top_block->connect(decoder, 0, sink, 0);
+    top_block->run();
+
+    // every epoch that has the preamble length of epochs after it is
+    // decoded, dormant or not, and one in decimation of them is output
+    std::vector<unsigned char> output_bytes = sink->data();
+    ASSERT_EQ(0u, output_bytes.size() % sizeof(Gnss_Synchro));
+    std::vector<Gnss_Synchro> output(output_bytes.size() / sizeof(Gnss_Synchro));
+    if (!output.empty())
+        {
+            std::memcpy(&output[0], &output_bytes[0], output_bytes.size());
+        }
+    const unsigned int decoded = n_epochs - GPS_CA_PREAMBLE_LENGTH_SYMBOLS + 1;
+    ASSERT_EQ(decoded / decimation, output.size());
+
+    unsigned int preambles = 0;
+    for (unsigned int k = 0; k < output.size(); k++)
+        {
+            const Gnss_Synchro& expected = epochs[(k + 1) * decimation - 1];
+            ASSERT_EQ(expected.PRN, output[k].PRN) << "at output " << k;
+            ASSERT_DOUBLE_EQ(expected.Tracking_timestamp_secs, output[k].Tracking_timestamp_secs) << "at output " << k;
+            if (output[k].Flag_preamble)
+                {
+                    EXPECT_DOUBLE_EQ(0.001 * dormant_end, output[k].Tracking_timestamp_secs);
+                    preambles++;
+                }
+        }
+    // the history of the correlator, cleared on the dormant epochs, does not
+    // hide the preamble that follows them
+    EXPECT_EQ(1u, preambles);
+}
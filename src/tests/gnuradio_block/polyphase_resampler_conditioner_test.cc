@@ -0,0 +1,76 @@
+/*!
+ * \file polyphase_resampler_conditioner_test.cc
+ * \brief  This file implements tests for the polyphase resampler conditioner
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <gtest/gtest.h>
+#include <gnuradio/top_block.h>
+#include <gnuradio/blocks/vector_source_c.h>
+#include <gnuradio/blocks/vector_sink_c.h>
+#include "polyphase_resampler_conditioner.h"
+
+
+TEST(Polyphase_Resampler_Conditioner_Test, InterpolatesATone)
+{
+    const double fs_in = 4000000.0;
+    const double fs_out = 2500000.0;
+    const double tone_hz = 150000.0;
+    const unsigned int taps_per_phase = 16;
+    const unsigned int nsamples = 200000;
+    std::vector<gr_complex> samples(nsamples);
+    for (unsigned int n = 0; n < nsamples; n++)
+        {
+            samples[n] = std::polar(1.0f, static_cast<float>(2.0 * M_PI * tone_hz * n / fs_in));
+        }
+
+    gr::top_block_sptr top_block = gr::make_top_block("polyphase_resampler_conditioner_test");
+    gr::blocks::vector_source_c::sptr source = gr::blocks::vector_source_c::make(samples);
+    polyphase_resampler_conditioner_sptr resampler = polyphase_resampler_make_conditioner(POLYPHASE_RESAMPLER_GR_COMPLEX, fs_in, fs_out, taps_per_phase);
+    gr::blocks::vector_sink_c::sptr sink = gr::blocks::vector_sink_c::make();
+    top_block->connect(source, 0, resampler, 0);
+    top_block->connect(resampler, 0, sink, 0);
+    top_block->run();
+
+    std::vector<gr_complex> resampled = sink->data();
+    EXPECT_NEAR(nsamples * fs_out / fs_in, resampled.size(), taps_per_phase);
+    // output n is the tone at input instant n * fs_in / fs_out, delayed by taps_per_phase / 2 - 1
+    const double delay = taps_per_phase / 2.0 - 1.0;
+    for (unsigned int n = taps_per_phase; n < resampled.size(); n++)
+        {
+            const double t = n * fs_in / fs_out + delay;
+            const std::complex<float> expected = std::polar(1.0f, static_cast<float>(2.0 * M_PI * tone_hz * t / fs_in));
+            ASSERT_NEAR(0.0, std::abs(resampled[n] - expected), 0.01) << "at output " << n;
+        }
+}
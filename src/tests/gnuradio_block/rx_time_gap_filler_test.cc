@@ -0,0 +1,101 @@
+/*!
+ * \file rx_time_gap_filler_test.cc
+ * \brief  This file implements tests for the rx_time gap filler block
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include <vector>
+#include <gtest/gtest.h>
+#include <gnuradio/top_block.h>
+#include <gnuradio/blocks/vector_source_c.h>
+#include <gnuradio/blocks/vector_sink_c.h>
+#include <gnuradio/tags.h>
+#include <pmt/pmt.h>
+#include "rx_time_gap_filler.h"
+
+
+static gr::tag_t rx_time_gap_filler_test_tag(unsigned long long offset, unsigned long long secs, double frac_secs)
+{
+    gr::tag_t tag;
+    tag.offset = offset;
+    tag.key = pmt::string_to_symbol("rx_time");
+    tag.value = pmt::make_tuple(pmt::from_uint64(secs), pmt::from_double(frac_secs));
+    tag.srcid = pmt::PMT_F;
+    return tag;
+}
+
+
+TEST(Rx_Time_Gap_Filler_Test, InsertsTheMissingSamples)
+{
+    const double fs = 1e6;
+    std::vector<gr_complex> input(3000);
+    for (unsigned int n = 0; n < input.size(); n++)
+        {
+            input[n] = gr_complex(1.0 + n, 0.0);
+        }
+    std::vector<gr::tag_t> tags;
+    tags.push_back(rx_time_gap_filler_test_tag(0, 10, 0.5));
+    // 500 samples lost by the front-end before input item 1000
+    tags.push_back(rx_time_gap_filler_test_tag(1000, 10, 0.5 + 1500 / fs));
+    // no loss before input item 2000
+    tags.push_back(rx_time_gap_filler_test_tag(2000, 10, 0.5 + 2500 / fs));
+
+    gr::top_block_sptr top_block = gr::make_top_block("rx_time_gap_filler_test");
+    gr::blocks::vector_source_c::sptr source = gr::blocks::vector_source_c::make(input, false, 1, tags);
+    rx_time_gap_filler_sptr filler = make_rx_time_gap_filler(sizeof(gr_complex), fs);
+    gr::blocks::vector_sink_c::sptr sink = gr::blocks::vector_sink_c::make();
+    top_block->connect(source, 0, filler, 0);
+    top_block->connect(filler, 0, sink, 0);
+    top_block->run();
+
+    std::vector<gr_complex> output = sink->data();
+    ASSERT_EQ(input.size() + 500, output.size());
+    for (unsigned int n = 0; n < output.size(); n++)
+        {
+            gr_complex expected(0.0, 0.0);
+            if (n < 1000)
+                {
+                    expected = input[n];
+                }
+            else if (n >= 1500)
+                {
+                    expected = input[n - 500];
+                }
+            ASSERT_EQ(expected, output[n]) << "at output item " << n;
+        }
+    EXPECT_EQ(1u, filler->gaps());
+    EXPECT_EQ(500u, filler->inserted_samples());
+
+    std::vector<gr::tag_t> output_tags = sink->tags();
+    ASSERT_EQ(3u, output_tags.size());
+    EXPECT_EQ(0u, output_tags[0].offset);
+    EXPECT_EQ(1500u, output_tags[1].offset);
+    EXPECT_EQ(2500u, output_tags[2].offset);
+}
@@ -0,0 +1,116 @@
+/*!
+ * \file sample_history_test.cc
+ * \brief  This file implements tests for the sample history and its sink block
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <vector>
+#include <gtest/gtest.h>
+#include <gnuradio/top_block.h>
+#include <gnuradio/blocks/vector_source_c.h>
+#include "sample_history.h"
+#include "sample_history_sink.h"
+
+
+namespace
+{
+std::vector<gr_complex> ramp(unsigned int start, unsigned int count)
+{
+    std::vector<gr_complex> samples(count);
+    for (unsigned int n = 0; n < count; n++)
+        {
+            samples[n] = gr_complex(static_cast<float>(start + n), 0.0);
+        }
+    return samples;
+}
+}
+
+
+TEST(Sample_History_Test, WindowsAreContiguousAcrossTheWrap)
+{
+    Sample_History history(100);
+    std::vector<gr_complex> samples = ramp(0, 70);
+    history.write(samples.data(), 70);
+    EXPECT_EQ(70u, history.written());
+    EXPECT_EQ(nullptr, history.window(60, 20)); // not written yet
+
+    samples = ramp(70, 70);
+    history.write(samples.data(), 70);
+    EXPECT_EQ(nullptr, history.window(30, 20)); // overwritten
+    const gr_complex* window = history.window(80, 60);
+    ASSERT_NE(nullptr, window);
+    for (unsigned int n = 0; n < 60; n++)
+        {
+            ASSERT_EQ(80.0f + n, window[n].real());
+        }
+    EXPECT_TRUE(history.intact(80));
+
+    samples = ramp(140, 50);
+    history.write(samples.data(), 50);
+    EXPECT_FALSE(history.intact(80));
+    EXPECT_TRUE(history.intact(90));
+}
+
+
+TEST(Sample_History_Test, WritesLongerThanTheRingKeepTheLastSamples)
+{
+    Sample_History history(64);
+    std::vector<gr_complex> samples = ramp(0, 1000);
+    history.write(samples.data(), 1000);
+    EXPECT_EQ(1000u, history.written());
+    const gr_complex* window = history.window(1000 - 64, 64);
+    ASSERT_NE(nullptr, window);
+    EXPECT_EQ(936.0f, window[0].real());
+    EXPECT_EQ(999.0f, window[63].real());
+    EXPECT_EQ(nullptr, history.window(900, 64));
+}
+
+
+TEST(Sample_History_Test, SinkKeepsTheConditionedStream)
+{
+    std::shared_ptr<Sample_History> history = Sample_History::create(0, 4096);
+    EXPECT_EQ(history, Sample_History::find(0));
+    EXPECT_FALSE(Sample_History::find(1));
+
+    std::vector<gr_complex> input = ramp(0, 10000);
+    gr::top_block_sptr top_block = gr::make_top_block("sample_history_test");
+    top_block->connect(gr::blocks::vector_source_c::make(input), 0, make_sample_history_sink(history), 0);
+    top_block->run();
+
+    ASSERT_EQ(input.size(), history->written());
+    const gr_complex* window = history->window(input.size() - 4096, 4096);
+    ASSERT_NE(nullptr, window);
+    for (unsigned int n = 0; n < 4096; n++)
+        {
+            ASSERT_EQ(input[input.size() - 4096 + n], window[n]);
+        }
+    Sample_History::clear();
+    EXPECT_FALSE(Sample_History::find(0));
+}
@@ -0,0 +1,151 @@
+/*!
+ * \file source_aligner_test.cc
+ * \brief  This file implements tests for the source aligner block
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include <algorithm>
+#include <vector>
+#include <gtest/gtest.h>
+#include <gnuradio/top_block.h>
+#include <gnuradio/blocks/vector_source_c.h>
+#include <gnuradio/blocks/vector_sink_c.h>
+#include <gnuradio/tags.h>
+#include <pmt/pmt.h>
+#include "source_aligner.h"
+
+
+static gr::tag_t source_aligner_test_tag(unsigned long long offset, unsigned long long secs, double frac_secs)
+{
+    gr::tag_t tag;
+    tag.offset = offset;
+    tag.key = pmt::string_to_symbol("rx_time");
+    tag.value = pmt::make_tuple(pmt::from_uint64(secs), pmt::from_double(frac_secs));
+    tag.srcid = pmt::PMT_F;
+    return tag;
+}
+
+
+TEST(Source_Aligner_Test, DropsTheConfiguredOffsets)
+{
+    std::vector<gr_complex> input(5000);
+    for (unsigned int n = 0; n < input.size(); n++)
+        {
+            input[n] = gr_complex(static_cast<float>(n), 0.0);
+        }
+    std::vector<size_t> item_sizes(2, sizeof(gr_complex));
+    std::vector<double> sample_rates_hz(2, 1e6);
+    std::vector<long long> offset_samples;
+    offset_samples.push_back(0);
+    offset_samples.push_back(100); // the second front-end started 100 samples earlier
+
+    gr::top_block_sptr top_block = gr::make_top_block("source_aligner_test");
+    source_aligner_sptr aligner = make_source_aligner(item_sizes, sample_rates_hz, offset_samples, false, 1.0, 0.001);
+    std::vector<gr::blocks::vector_sink_c::sptr> sinks;
+    for (unsigned int i = 0; i < 2; i++)
+        {
+            sinks.push_back(gr::blocks::vector_sink_c::make());
+            top_block->connect(gr::blocks::vector_source_c::make(input), 0, aligner, i);
+            top_block->connect(aligner, i, sinks.at(i), 0);
+        }
+    top_block->run();
+
+    EXPECT_TRUE(aligner->aligned());
+    EXPECT_EQ(0u, aligner->dropped_samples(0));
+    EXPECT_EQ(100u, aligner->dropped_samples(1));
+    std::vector<gr_complex> first = sinks.at(0)->data();
+    std::vector<gr_complex> second = sinks.at(1)->data();
+    // the flowgraph ends with the shorter stream
+    ASSERT_LT(4000u, std::min(first.size(), second.size()));
+    for (unsigned int n = 0; n < std::min(first.size(), second.size()); n++)
+        {
+            ASSERT_EQ(input[n], first[n]) << "at output item " << n;
+            ASSERT_EQ(input[n + 100], second[n]) << "at output item " << n;
+        }
+}
+
+
+TEST(Source_Aligner_Test, AlignsTheRxTimeOfTheStreams)
+{
+    const double fs = 1e6;
+    // the real part is the sampling time in sample periods since 10.5 s, the imaginary part marks the samples
+    std::vector<gr_complex> first_input(40000);
+    std::vector<gr_complex> second_input(40000);
+    for (unsigned int n = 0; n < first_input.size(); n++)
+        {
+            first_input[n] = gr_complex(static_cast<float>(n), 1.0);
+            // 300 samples earlier, and 50 samples lost before item 15000
+            second_input[n] = gr_complex(static_cast<float>(n < 15000 ? n - 300.0 : n - 250.0), 1.0);
+        }
+    std::vector<gr::tag_t> first_tags;
+    first_tags.push_back(source_aligner_test_tag(0, 10, 0.5));
+    std::vector<gr::tag_t> second_tags;
+    second_tags.push_back(source_aligner_test_tag(0, 10, 0.5 - 300 / fs));
+    second_tags.push_back(source_aligner_test_tag(15000, 10, 0.5 + 14750 / fs));
+
+    std::vector<size_t> item_sizes(2, sizeof(gr_complex));
+    std::vector<double> sample_rates_hz(2, fs);
+    std::vector<long long> offset_samples(2, 0);
+    gr::top_block_sptr top_block = gr::make_top_block("source_aligner_test");
+    source_aligner_sptr aligner = make_source_aligner(item_sizes, sample_rates_hz, offset_samples, true, 1.0, 0.001);
+    gr::blocks::vector_sink_c::sptr first_sink = gr::blocks::vector_sink_c::make();
+    gr::blocks::vector_sink_c::sptr second_sink = gr::blocks::vector_sink_c::make();
+    top_block->connect(gr::blocks::vector_source_c::make(first_input, false, 1, first_tags), 0, aligner, 0);
+    top_block->connect(gr::blocks::vector_source_c::make(second_input, false, 1, second_tags), 0, aligner, 1);
+    top_block->connect(aligner, 0, first_sink, 0);
+    top_block->connect(aligner, 1, second_sink, 0);
+    top_block->run();
+
+    ASSERT_TRUE(aligner->aligned());
+    EXPECT_EQ(50u, aligner->inserted_samples(1));
+    std::vector<gr_complex> first = first_sink->data();
+    std::vector<gr_complex> second = second_sink->data();
+    ASSERT_LT(20000u, first.size());
+    ASSERT_LT(20000u, second.size());
+    const float start = first[0].real();
+    unsigned int zeros = 0;
+    for (unsigned int n = 0; n < 20000; n++)
+        {
+            ASSERT_EQ(gr_complex(start + n, 1.0), first[n]) << "at output item " << n;
+            if (second[n] == gr_complex(0.0, 0.0))
+                {
+                    zeros++;
+                    continue;
+                }
+            ASSERT_EQ(first[n], second[n]) << "at output item " << n;
+        }
+    EXPECT_EQ(50u, zeros);
+
+    // both streams start with the common time
+    std::vector<gr::tag_t> tags = second_sink->tags();
+    ASSERT_EQ(1u, tags.size());
+    EXPECT_EQ(0u, tags[0].offset);
+    EXPECT_NEAR(0.5 + start / fs, pmt::to_double(pmt::tuple_ref(tags[0].value, 1)), 1e-9);
+}
@@ -0,0 +1,91 @@
+/*!
+ * \file xlating_fir_decimator_test.cc
+ * \brief  This file implements tests for the fused xlating FIR decimator
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <cstdlib>
+#include <vector>
+#include <gtest/gtest.h>
+#include <gnuradio/top_block.h>
+#include <gnuradio/blocks/vector_source_s.h>
+#include <gnuradio/blocks/vector_sink_c.h>
+#include <gnuradio/blocks/interleaved_short_to_complex.h>
+#include <gnuradio/filter/freq_xlating_fir_filter_ccf.h>
+#include "xlating_fir_decimator.h"
+
+
+TEST(Xlating_Fir_Decimator_Test, MatchesTheBlockChain)
+{
+    const unsigned int decimation = 3;
+    const double intermediate_freq = 125000.0;
+    const double sampling_freq = 4000000.0;
+    std::vector<float> taps;
+    for (unsigned int i = 0; i < 31; i++)
+        {
+            taps.push_back(0.1 * (i % 7) - 0.2);
+        }
+    std::vector<short> samples(2 * 30000);
+    std::srand(1);
+    for (unsigned int i = 0; i < samples.size(); i++)
+        {
+            samples[i] = std::rand() % 200 - 100;
+        }
+
+    // ishort -> gr_complex -> freq_xlating_fir_filter_ccf
+    gr::top_block_sptr top_block = gr::make_top_block("xlating_fir_decimator_test");
+    gr::blocks::vector_source_s::sptr source = gr::blocks::vector_source_s::make(samples);
+    gr::blocks::interleaved_short_to_complex::sptr to_complex = gr::blocks::interleaved_short_to_complex::make();
+    gr::filter::freq_xlating_fir_filter_ccf::sptr filter = gr::filter::freq_xlating_fir_filter_ccf::make(decimation, taps, intermediate_freq, sampling_freq);
+    gr::blocks::vector_sink_c::sptr chain_sink = gr::blocks::vector_sink_c::make();
+    top_block->connect(source, 0, to_complex, 0);
+    top_block->connect(to_complex, 0, filter, 0);
+    top_block->connect(filter, 0, chain_sink, 0);
+
+    // the same, in one block
+    gr::blocks::vector_source_s::sptr fused_source = gr::blocks::vector_source_s::make(samples);
+    xlating_fir_decimator_sptr fused = make_xlating_fir_decimator(XLATING_FIR_INT16, 2, decimation, taps, intermediate_freq, sampling_freq);
+    gr::blocks::vector_sink_c::sptr fused_sink = gr::blocks::vector_sink_c::make();
+    top_block->connect(fused_source, 0, fused, 0);
+    top_block->connect(fused, 0, fused_sink, 0);
+
+    top_block->run();
+
+    std::vector<gr_complex> expected = chain_sink->data();
+    std::vector<gr_complex> result = fused_sink->data();
+    ASSERT_EQ(expected.size(), result.size());
+    ASSERT_GT(result.size(), 9000u);
+    for (unsigned int i = 0; i < result.size(); i++)
+        {
+            ASSERT_NEAR(expected[i].real(), result[i].real(), 0.05) << "at output " << i;
+            ASSERT_NEAR(expected[i].imag(), result[i].imag(), 0.05) << "at output " << i;
+        }
+}
@@ -39,8 +39,11 @@
 #include <gtest/gtest.h>
 #include <gnuradio/msg_queue.h>
 #include "concurrent_queue.h"
+#include "concurrent_ring_queue.h"
 #include "concurrent_map.h"
+#include "concurrent_snapshot_map.h"
 #include "gps_navigation_message.h"
+#include "gnss_synchro.h"
 #include "gps_ephemeris.h"
 #include "gps_cnav_ephemeris.h"
 #include "gps_cnav_iono.h"
@@ -52,10 +55,10 @@
 #include "sbas_telemetry_data.h"
 #include "sbas_ephemeris.h"
 #include "sbas_satellite_correction.h"
-
-concurrent_queue<Gps_Acq_Assist> global_gps_acq_assist_queue;
-
-concurrent_map<Gps_Acq_Assist> global_gps_acq_assist_map;
+#include "vector_tracking_aid.h"
+#include "correlator_taps.h"
+#include "sqm_metrics.h"
+#include "aoa_metrics.h"
 
 
 int main(int argc, char **argv)
@@ -41,14 +41,21 @@
 #include <gnuradio/msg_queue.h>
 #include <gtest/gtest.h>
 #include "concurrent_queue.h"
+#include "concurrent_ring_queue.h"
 #include "concurrent_map.h"
 #include "concurrent_map_str.h"
+#include "concurrent_snapshot_map.h"
+#include "navigation_data_bus.h"
+#include "concurrent_subframe_map.h"
 #include "control_thread.h"
 #include "gps_navigation_message.h"
 
+#include "gnss_synchro.h"
 #include "gps_ephemeris.h"
 #include "gps_cnav_ephemeris.h"
 #include "gps_almanac.h"
+#include "gps_ref_location.h"
+#include "gps_ref_time.h"
 #include "gps_iono.h"
 #include "gps_cnav_iono.h"
 #include "gps_utc_model.h"
@@ -62,9 +69,13 @@
 #include "sbas_telemetry_data.h"
 #include "sbas_ionospheric_correction.h"
 #include "sbas_satellite_correction.h"
+#include "vector_tracking_aid.h"
+#include "correlator_taps.h"
+#include "sqm_metrics.h"
+#include "aoa_metrics.h"
 #include "sbas_time.h"
 #include "spoofing_message.h"
-
+#include "spoofing_detector.h" // sEph
 
 
 using google::LogMessage;
@@ -77,19 +88,89 @@ DECLARE_string(log_dir);
 #include "arithmetic/multiply_test.cc"
 #include "arithmetic/code_generation_test.cc"
 #include "arithmetic/tracking_loop_filter_test.cc"
+#include "arithmetic/tracking_signal_test.cc"
+#include "arithmetic/secondary_code_sync_test.cc"
+#include "arithmetic/fine_pull_in_test.cc"
+#include "arithmetic/multicorrelator_batch_test.cc"
+#include "arithmetic/cpu_multicorrelator_replica_cache_test.cc"
+#include "arithmetic/lock_detectors_test.cc"
+#include "arithmetic/tracking_dump_writer_test.cc"
+#include "arithmetic/dump_writer_test.cc"
+#include "arithmetic/block_metrics_test.cc"
+#include "arithmetic/allocation_guard_test.cc"
 #include "arithmetic/fft_length_test.cc"
+#include "arithmetic/rolling_statistics_test.cc"
+#include "arithmetic/nav_data_fields_test.cc"
+#include "arithmetic/sqm_monitor_test.cc"
+#include "arithmetic/spoofing_replay_test.cc"
+#include "arithmetic/spoofing_check_scheduler_test.cc"
+#include "arithmetic/receiver_checkpoint_test.cc"
+#include "arithmetic/assistance_snapshot_test.cc"
+#include "arithmetic/rinex_nav_reader_test.cc"
+#include "arithmetic/doppler_residuals_test.cc"
+#include "arithmetic/raim_residuals_test.cc"
+#include "arithmetic/coarse_time_pvt_test.cc"
+#include "arithmetic/pvt_geometry_test.cc"
+#include "arithmetic/spoofing_peers_test.cc"
+#include "arithmetic/spoofing_nav_unit_test.cc"
+#include "arithmetic/spoofing_satpos_test.cc"
+#include "arithmetic/ephemeris_history_test.cc"
+#include "arithmetic/apt_release_test.cc"
+#include "arithmetic/aoa_monitor_test.cc"
+#include "arithmetic/spectrum_monitor_test.cc"
+#include "arithmetic/gaussian_noise_test.cc"
+#include "arithmetic/viterbi_decoder_test.cc"
+#include "arithmetic/preamble_correlator_test.cc"
+#include "arithmetic/lnav_word_framer_test.cc"
+#include "arithmetic/buffer_allocator_test.cc"
+#include "arithmetic/latency_trace_test.cc"
+#include "arithmetic/gps_subframe_words_test.cc"
+#include "arithmetic/gps_lnav_encoder_test.cc"
+#include "arithmetic/navigation_message_bits_test.cc"
+#include "arithmetic/navigation_data_bus_test.cc"
+#include "arithmetic/message_pool_test.cc"
+#include "arithmetic/concurrent_ring_queue_test.cc"
+#include "arithmetic/receiver_state_test.cc"
+#include "arithmetic/epoch_arena_test.cc"
+#include "arithmetic/trace_log_test.cc"
+#include "arithmetic/observables_history_test.cc"
+#include "arithmetic/observables_extrapolation_test.cc"
 #include "configuration/file_configuration_test.cc"
 #include "configuration/in_memory_configuration_test.cc"
 #include "control_thread/control_message_factory_test.cc"
 #include "control_thread/control_thread_test.cc"
+#include "control_thread/batch_replay_test.cc"
+#include "control_thread/campaign_test.cc"
+#include "control_thread/gnss_visibility_predictor_test.cc"
+#include "control_thread/realtime_margin_monitor_test.cc"
+#include "control_thread/thread_placement_test.cc"
 #include "flowgraph/pass_through_test.cc"
 #include "flowgraph/gnss_flowgraph_test.cc"
+#include "flowgraph/gnss_signal_scheduler_test.cc"
 #include "formats/string_converter_test.cc"
 #include "formats/rtcm_test.cc"
+#include "formats/rtcm_bits_test.cc"
+#include "formats/rtcm_decoder_test.cc"
+#include "formats/crc24q_test.cc"
+#include "formats/sbas_frame_test.cc"
+#include "formats/pvt_log_test.cc"
+#include "formats/pvt_telemetry_test.cc"
+#include "formats/track_file_writer_test.cc"
+#include "formats/chunked_capture_test.cc"
+#include "formats/shared_sample_ring_test.cc"
+#include "formats/iq_stream_test.cc"
 #include "gnss_block/gnss_block_factory_test.cc"
 #include "gnss_block/rtcm_printer_test.cc"
 #include "gnss_block/file_signal_source_test.cc"
 #include "gnss_block/fir_filter_test.cc"
+#include "gnss_block/acquisition_cache_test.cc"
+#include "gnss_block/frequency_domain_doppler_test.cc"
+#include "gnss_block/acquisition_thread_pool_test.cc"
+#include "gnss_block/acquisition_server_test.cc"
+#include "gnss_block/fft_plan_cache_test.cc"
+#include "gnss_block/reacquisition_window_test.cc"
+#include "gnss_block/auxiliary_peak_detector_test.cc"
+#include "gnss_block/carrier_wipeoff_16ic_test.cc"
 #include "gnss_block/gps_l1_ca_pcps_acquisition_test.cc"
 #include "gnss_block/gps_l2_m_pcps_acquisition_test.cc"
 #include "gnss_block/gps_l1_ca_pcps_acquisition_gsoc2013_test.cc"
@@ -97,6 +178,9 @@ DECLARE_string(log_dir);
 #if OPENCL_BLOCKS_TEST
 #include "gnss_block/gps_l1_ca_pcps_opencl_acquisition_gsoc2013_test.cc"
 #endif
+#if CUDA_BLOCKS_TEST
+#include "gnss_block/gps_l1_ca_pcps_cuda_acquisition_test.cc"
+#endif
 #include "gnss_block/gps_l1_ca_pcps_quicksync_acquisition_gsoc2014_test.cc"
 #include "gnss_block/gps_l1_ca_pcps_tong_acquisition_gsoc2013_test.cc"
 #include "gnss_block/galileo_e1_pcps_ambiguous_acquisition_test.cc"
@@ -109,47 +193,19 @@ DECLARE_string(log_dir);
 #include "gnss_block/galileo_e1_dll_pll_veml_tracking_test.cc"
 #include "gnuradio_block/gnss_sdr_valve_test.cc"
 #include "gnuradio_block/direct_resampler_conditioner_cc_test.cc"
+#include "gnuradio_block/polyphase_resampler_conditioner_test.cc"
+#include "gnuradio_block/xlating_fir_decimator_test.cc"
+#include "gnuradio_block/complex_fir_filter_test.cc"
+#include "gnuradio_block/beamformer_test.cc"
+#include "gnuradio_block/rx_time_gap_filler_test.cc"
+#include "gnuradio_block/flight_recorder_test.cc"
+#include "gnuradio_block/sample_history_test.cc"
+#include "gnuradio_block/source_aligner_test.cc"
+#include "gnuradio_block/gps_l1_ca_telemetry_decoder_dormant_test.cc"
 #include "gnss_block/galileo_e5a_pcps_acquisition_gsoc2014_gensource_test.cc"
 #include "gnss_block/galileo_e5a_tracking_test.cc"
 #include "gnss_block/gps_l2_m_dll_pll_tracking_test.cc"
-
-
-// For GPS NAVIGATION (L1)
-
-concurrent_queue<Gps_Acq_Assist> global_gps_acq_assist_queue;
-concurrent_map<Gps_Acq_Assist> global_gps_acq_assist_map;
-
-//For spoofing detection
-struct GPS_time_t{
-    int week;
-    double TOW;
-    double timestamp;    
-    int subframe_id;
-};
-
-struct sEph{
-    Gps_Ephemeris ephemeris;
-    double time;
-    bool changed;
-};
-
-concurrent_map<GPS_time_t> global_gps_time;
-concurrent_map<sEph> global_sEph_map;
-concurrent_map<double> global_last_gps_time;
-concurrent_map<bool> global_spoofing_status;  //spoofing has been detected for the satellite
-
-struct Subframe{
-    std::string subframe;
-    unsigned int subframe_id;
-    unsigned int PRN;
-    double timestamp;
-    unsigned int toa;
-    unsigned int uid;
-};
-
-concurrent_map<Subframe> global_subframe_map;
-concurrent_map<std::map<unsigned int, unsigned int>> global_subframe_check;
-concurrent_queue<Spoofing_Message> global_spoofing_queue;
+#include "gnss_block/channel_fsm_test.cc"
 
 
 int main(int argc, char **argv)
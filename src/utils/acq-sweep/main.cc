@@ -0,0 +1,499 @@
+/*!
+ * \file main.cc
+ * \brief Main file of acq-sweep, which measures the detection rate, the
+ * false alarms and the CPU cost of acquisition settings on a capture
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * A few hundred milliseconds of the capture are read once through the
+ * signal source and conditioner of --config_file. Then every combination
+ * of the implementations and parameter values given by the flags searches
+ * every PRN of its system in them, each combination in a child process,
+ * --parallel at a time. A detection of a PRN of --visible_prns counts as
+ * a detection, any other as a false alarm.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+#include <boost/thread/thread.hpp>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gnuradio/top_block.h>
+#include <gnuradio/msg_queue.h>
+#include <gnuradio/blocks/file_sink.h>
+#include <gnuradio/blocks/file_source.h>
+#include <gnuradio/blocks/head.h>
+#include <gnuradio/blocks/skiphead.h>
+#include "acquisition_interface.h"
+#include "concurrent_queue.h"
+#include "concurrent_ring_queue.h"
+#include "concurrent_map.h"
+#include "concurrent_snapshot_map.h"
+#include "concurrent_subframe_map.h"
+#include "navigation_data_bus.h"
+#include "file_configuration.h"
+#include "gnss_block_factory.h"
+#include "gnss_synchro.h"
+#include "gps_ephemeris.h"
+#include "gps_acq_assist.h"
+#include "gps_ref_location.h"
+#include "gps_ref_time.h"
+#include "spoofing_message.h"
+#include "vector_tracking_aid.h"
+#include "correlator_taps.h"
+#include "sqm_metrics.h"
+#include "aoa_metrics.h"
+
+using google::LogMessage;
+
+DEFINE_string(config_file, "", "Configuration of the signal source and conditioner of the capture, and of the acquisition (role Acquisition) the values of the sweep are applied to");
+DEFINE_string(implementations, "GPS_L1_CA_PCPS_Acquisition", "Comma separated acquisition implementations");
+DEFINE_string(pfa, "0.01,0.001,0.0001", "Comma separated values of Acquisition.pfa");
+DEFINE_string(doppler_step, "250,500", "Comma separated values of Acquisition.doppler_step [Hz]");
+DEFINE_string(coherent_integration_time_ms, "1,2", "Comma separated values of Acquisition.coherent_integration_time_ms");
+DEFINE_string(max_dwells, "1,2", "Comma separated values of Acquisition.max_dwells");
+DEFINE_string(bit_transition_flag, "false", "Comma separated values of Acquisition.bit_transition_flag");
+DEFINE_string(visible_prns, "", "Comma separated PRNs present in the capture. If empty, the PRNs detected by at least half of the settings");
+DEFINE_int32(capture_ms, 200, "Milliseconds of the capture searched by every setting");
+DEFINE_double(skip_s, 0.0, "Seconds of the capture skipped before them");
+DEFINE_int32(parallel, 0, "Settings searched at the same time (0: one per core)");
+DEFINE_string(output_dir, "./acq_sweep", "Directory of the samples searched, of the outputs of every setting and of results.csv");
+
+DECLARE_string(log_dir);
+
+// ######## GNURADIO BLOCK MESSAGE RECEVER #########
+class AcqSweep_msg_rx;
+
+typedef boost::shared_ptr<AcqSweep_msg_rx> AcqSweep_msg_rx_sptr;
+
+AcqSweep_msg_rx_sptr AcqSweep_msg_rx_make(concurrent_queue<int>& queue);
+
+
+class AcqSweep_msg_rx : public gr::block
+{
+private:
+    friend AcqSweep_msg_rx_sptr AcqSweep_msg_rx_make(concurrent_queue<int>& queue);
+    void msg_handler_events(pmt::pmt_t msg);
+    AcqSweep_msg_rx(concurrent_queue<int>& queue);
+    concurrent_queue<int>& channel_internal_queue;
+};
+
+
+AcqSweep_msg_rx_sptr AcqSweep_msg_rx_make(concurrent_queue<int>& queue)
+{
+    return AcqSweep_msg_rx_sptr(new AcqSweep_msg_rx(queue));
+}
+
+
+void AcqSweep_msg_rx::msg_handler_events(pmt::pmt_t msg)
+{
+    try
+    {
+            channel_internal_queue.push(pmt::to_long(msg));
+    }
+    catch(boost::bad_any_cast& e)
+    {
+            LOG(WARNING) << "msg_handler_telemetry Bad any cast!";
+    }
+}
+
+
+AcqSweep_msg_rx::AcqSweep_msg_rx(concurrent_queue<int>& queue) :
+    gr::block("AcqSweep_msg_rx", gr::io_signature::make(0, 0, 0), gr::io_signature::make(0, 0, 0)),
+    channel_internal_queue(queue)
+{
+    this->message_port_register_in(pmt::mp("events"));
+    this->set_msg_handler(pmt::mp("events"), boost::bind(&AcqSweep_msg_rx::msg_handler_events, this, _1));
+}
+
+// ###########################################################
+
+
+namespace
+{
+    struct Sweep_Setting
+    {
+        std::string implementation;
+        std::string pfa;
+        std::string doppler_step;
+        std::string coherent_integration_time_ms;
+        std::string max_dwells;
+        std::string bit_transition_flag;
+    };
+
+    std::vector<std::string> split_list(const std::string & list)
+    {
+        std::vector<std::string> items;
+        std::stringstream list_stream(list);
+        std::string item;
+        while (std::getline(list_stream, item, ','))
+            {
+                if (!item.empty()) items.push_back(item);
+            }
+        return items;
+    }
+
+    // System, signal and number of PRNs searched by an implementation
+    void implementation_signal(const std::string & implementation, char & system, std::string & signal, unsigned int & prns)
+    {
+        system = 'G';
+        signal = "1C";
+        prns = 32;
+        if (implementation.find("Galileo_E1") == 0)
+            {
+                system = 'E';
+                signal = "1B";
+                prns = 36;
+            }
+        else if (implementation.find("Galileo_E5a") == 0)
+            {
+                system = 'E';
+                signal = "5X";
+                prns = 36;
+            }
+        else if (implementation.find("GPS_L2") == 0)
+            {
+                signal = "2S";
+            }
+    }
+
+    // Writes capture_ms of the output of the signal conditioner to filename
+    bool read_capture(std::shared_ptr<ConfigurationInterface> configuration, const std::string & filename)
+    {
+        GNSSBlockFactory block_factory;
+        boost::shared_ptr<gr::msg_queue> queue = gr::msg_queue::make(0);
+        gr::top_block_sptr top_block = gr::make_top_block("Acquisition sweep capture");
+        long fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
+        try
+        {
+                std::shared_ptr<GNSSBlockInterface> source = block_factory.GetSignalSource(configuration, queue);
+                std::shared_ptr<GNSSBlockInterface> conditioner = block_factory.GetSignalConditioner(configuration);
+                gr::block_sptr skiphead = gr::blocks::skiphead::make(sizeof(gr_complex), static_cast<unsigned long long>(FLAGS_skip_s * fs_in));
+                gr::block_sptr head = gr::blocks::head::make(sizeof(gr_complex), static_cast<unsigned long long>(FLAGS_capture_ms) * fs_in / 1000);
+                gr::block_sptr sink = gr::blocks::file_sink::make(sizeof(gr_complex), filename.c_str());
+                source->connect(top_block);
+                conditioner->connect(top_block);
+                top_block->connect(source->get_right_block(), 0, conditioner->get_left_block(), 0);
+                top_block->connect(conditioner->get_right_block(), 0, skiphead, 0);
+                top_block->connect(skiphead, 0, head, 0);
+                top_block->connect(head, 0, sink, 0);
+                top_block->run();
+        }
+        catch(const std::exception & e)
+        {
+                std::cout << "Failure reading the capture: " << e.what() << std::endl;
+                return false;
+        }
+        return true;
+    }
+
+    /*
+     * Searches every PRN with one setting in the child process and writes
+     * "cpu_s searches PRN PRN ..." (the PRNs detected) to directory/result.txt.
+     * It never returns.
+     */
+    void run_setting(const Sweep_Setting & setting, const std::string & directory, const std::string & capture)
+    {
+        int status = 1;
+        try
+        {
+                if (chdir(directory.c_str()) != 0 || !std::freopen("acq-sweep.out", "w", stdout))
+                    {
+                        std::_Exit(status);
+                    }
+                FLAGS_log_dir = directory + "/";
+                std::shared_ptr<ConfigurationInterface> configuration = std::make_shared<FileConfiguration>(FLAGS_config_file);
+                configuration->set_property("Acquisition.implementation", setting.implementation);
+                configuration->set_property("Acquisition.item_type", "gr_complex");
+                configuration->set_property("Acquisition.pfa", setting.pfa);
+                configuration->set_property("Acquisition.doppler_step", setting.doppler_step);
+                configuration->set_property("Acquisition.coherent_integration_time_ms", setting.coherent_integration_time_ms);
+                configuration->set_property("Acquisition.max_dwells", setting.max_dwells);
+                configuration->set_property("Acquisition.bit_transition_flag", setting.bit_transition_flag);
+                configuration->set_property("Acquisition.dump", "false");
+
+                char system;
+                std::string signal;
+                unsigned int prns;
+                implementation_signal(setting.implementation, system, signal, prns);
+                Gnss_Synchro gnss_synchro = Gnss_Synchro();
+                gnss_synchro.Channel_ID = 0;
+                gnss_synchro.System = system;
+                signal.copy(gnss_synchro.Signal, 2, 0);
+
+                GNSSBlockFactory block_factory;
+                std::unique_ptr<GNSSBlockInterface> block = block_factory.GetBlock(configuration, "Acquisition", setting.implementation, 1, 0);
+                AcquisitionInterface* acquisition = dynamic_cast<AcquisitionInterface*>(block.get());
+                if (!acquisition)
+                    {
+                        std::cerr << setting.implementation << " is not an acquisition implementation" << std::endl;
+                        std::_Exit(status);
+                    }
+                gr::top_block_sptr top_block = gr::make_top_block("Acquisition sweep");
+                gr::blocks::file_source::sptr source = gr::blocks::file_source::make(sizeof(gr_complex), capture.c_str());
+                concurrent_queue<int> events;
+                AcqSweep_msg_rx_sptr msg_rx = AcqSweep_msg_rx_make(events);
+                acquisition->set_channel(0);
+                acquisition->set_gnss_synchro(&gnss_synchro);
+                acquisition->set_threshold(configuration->property("Acquisition.threshold", 0.0));
+                acquisition->set_doppler_max(configuration->property("Acquisition.doppler_max", 10000));
+                acquisition->set_doppler_step(std::atoi(setting.doppler_step.c_str()));
+                acquisition->connect(top_block);
+                top_block->connect(source, 0, acquisition->get_left_block(), 0);
+                top_block->msg_connect(acquisition->get_right_block(), pmt::mp("events"), msg_rx, pmt::mp("events"));
+
+                struct rusage usage;
+                getrusage(RUSAGE_SELF, &usage);
+                double cpu_start_s = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+                std::vector<unsigned int> detected;
+                for (unsigned int PRN = 1; PRN <= prns; PRN++)
+                    {
+                        gnss_synchro.PRN = PRN;
+                        acquisition->set_gnss_synchro(&gnss_synchro);
+                        acquisition->init();
+                        acquisition->reset();
+                        source->seek(0, SEEK_SET);
+                        top_block->run();
+                        // the decision is sent once, the message handler may still be on its way
+                        int message = 0;
+                        for (int wait = 0; wait < 100 && !events.try_pop(message); wait++)
+                            {
+                                boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+                            }
+                        if (message == 1)
+                            {
+                                detected.push_back(PRN);
+                            }
+                        while (events.try_pop(message)) {}
+                    }
+                getrusage(RUSAGE_SELF, &usage);
+                double cpu_s = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6 - cpu_start_s;
+
+                std::ofstream result((directory + "/result.txt").c_str());
+                result << cpu_s << " " << prns;
+                for (unsigned int i = 0; i < detected.size(); i++)
+                    {
+                        result << " " << detected[i];
+                    }
+                result << std::endl;
+                result.close();
+                status = result ? 0 : 1;
+        }
+        catch (const std::exception & e)
+        {
+                std::cerr << "Setting in " << directory << " failed: " << e.what() << std::endl;
+        }
+        std::cout << std::flush;
+        std::_Exit(status);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    namespace fs = boost::filesystem;
+    const std::string intro_help(
+            std::string("\nAcquisition sensitivity and cost sweep of GNSS-SDR over a capture\n")
+    +
+    "Copyright (C) 2010-2015 (see AUTHORS file for a list of contributors)\n"
+    +
+    "This program comes with ABSOLUTELY NO WARRANTY;\n"
+    +
+    "See COPYING file to see a copy of the General Public License\n \n");
+    google::SetUsageMessage(intro_help);
+    google::ParseCommandLineFlags(&argc, &argv, true);
+    google::InitGoogleLogging(argv[0]);
+
+    if (FLAGS_config_file.empty())
+        {
+            std::cout << "Please give the configuration of the capture with --config_file" << std::endl;
+            return 1;
+        }
+    FLAGS_config_file = fs::absolute(FLAGS_config_file).string();
+    fs::path output_dir = fs::absolute(FLAGS_output_dir);
+    boost::system::error_code ec;
+    fs::create_directories(output_dir, ec);
+
+    std::string capture = (output_dir / "capture.dat").string();
+    std::shared_ptr<ConfigurationInterface> configuration = std::make_shared<FileConfiguration>(FLAGS_config_file);
+    if (!read_capture(configuration, capture))
+        {
+            return 1;
+        }
+
+    std::vector<Sweep_Setting> settings;
+    std::vector<std::string> implementations = split_list(FLAGS_implementations);
+    std::vector<std::string> pfas = split_list(FLAGS_pfa);
+    std::vector<std::string> doppler_steps = split_list(FLAGS_doppler_step);
+    std::vector<std::string> coherent_times = split_list(FLAGS_coherent_integration_time_ms);
+    std::vector<std::string> dwells = split_list(FLAGS_max_dwells);
+    std::vector<std::string> bit_transitions = split_list(FLAGS_bit_transition_flag);
+    for (unsigned int i = 0; i < implementations.size(); i++)
+        for (unsigned int p = 0; p < pfas.size(); p++)
+            for (unsigned int d = 0; d < doppler_steps.size(); d++)
+                for (unsigned int c = 0; c < coherent_times.size(); c++)
+                    for (unsigned int w = 0; w < dwells.size(); w++)
+                        for (unsigned int b = 0; b < bit_transitions.size(); b++)
+                            {
+                                Sweep_Setting setting = {implementations[i], pfas[p], doppler_steps[d], coherent_times[c], dwells[w], bit_transitions[b]};
+                                settings.push_back(setting);
+                            }
+
+    unsigned int parallel = FLAGS_parallel > 0 ? FLAGS_parallel : std::max(1u, boost::thread::hardware_concurrency());
+    std::cout << "Searching " << FLAGS_capture_ms << " ms of the capture with " << settings.size()
+              << " settings, " << parallel << " at a time" << std::endl;
+    std::map<pid_t, unsigned int> running;
+    std::vector<bool> done(settings.size(), false);
+    for (unsigned int n = 0; n < settings.size() || !running.empty(); )
+        {
+            if (n < settings.size() && running.size() < parallel)
+                {
+                    fs::path directory = output_dir / ("setting_" + std::to_string(n));
+                    fs::create_directories(directory, ec);
+                    fs::remove(directory / "result.txt", ec);
+                    std::cout << std::flush;
+                    pid_t pid = fork();
+                    if (pid == 0)
+                        {
+                            run_setting(settings[n], directory.string(), capture);
+                        }
+                    if (pid == -1)
+                        {
+                            LOG(WARNING) << "Unable to start the search of setting " << n;
+                        }
+                    else
+                        {
+                            running[pid] = n;
+                        }
+                    n++;
+                    continue;
+                }
+            int status;
+            pid_t pid = wait(&status);
+            if (pid == -1)
+                {
+                    break;
+                }
+            if (running.count(pid))
+                {
+                    done[running[pid]] = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+                    running.erase(pid);
+                }
+        }
+
+    // read the results back
+    std::vector<double> cpu_s(settings.size(), 0.0);
+    std::vector<unsigned int> searches(settings.size(), 0);
+    std::vector<std::set<unsigned int> > detected(settings.size());
+    std::map<unsigned int, unsigned int> detections_of_prn;
+    unsigned int n_done = 0;
+    for (unsigned int n = 0; n < settings.size(); n++)
+        {
+            if (!done[n]) continue;
+            std::ifstream result((output_dir / ("setting_" + std::to_string(n)) / "result.txt").string().c_str());
+            unsigned int PRN;
+            if (!(result >> cpu_s[n] >> searches[n]))
+                {
+                    done[n] = false;
+                    continue;
+                }
+            while (result >> PRN)
+                {
+                    detected[n].insert(PRN);
+                    detections_of_prn[PRN]++;
+                }
+            n_done++;
+        }
+
+    std::set<unsigned int> visible;
+    std::vector<std::string> visible_prns = split_list(FLAGS_visible_prns);
+    for (unsigned int i = 0; i < visible_prns.size(); i++)
+        {
+            visible.insert(std::atoi(visible_prns[i].c_str()));
+        }
+    if (visible_prns.empty())
+        {
+            for (std::map<unsigned int, unsigned int>::const_iterator it = detections_of_prn.begin(); it != detections_of_prn.end(); ++it)
+                {
+                    if (2 * it->second >= n_done) visible.insert(it->first);
+                }
+        }
+    std::cout << "Visible PRNs:";
+    for (std::set<unsigned int>::const_iterator it = visible.begin(); it != visible.end(); ++it)
+        {
+            std::cout << " " << *it;
+        }
+    std::cout << std::endl;
+
+    std::string results_filename = (output_dir / "results.csv").string();
+    std::ofstream results(results_filename.c_str());
+    results << "implementation,pfa,doppler_step,coherent_integration_time_ms,max_dwells,bit_transition_flag,"
+            << "detections,detection_rate,false_alarms,false_alarm_rate,cpu_s,cpu_ms_per_search" << std::endl;
+    for (unsigned int n = 0; n < settings.size(); n++)
+        {
+            const Sweep_Setting& s = settings[n];
+            std::stringstream line;
+            line << s.implementation << "," << s.pfa << "," << s.doppler_step << "," << s.coherent_integration_time_ms << ","
+                 << s.max_dwells << "," << s.bit_transition_flag << ",";
+            if (!done[n])
+                {
+                    line << ",,,,,";
+                    std::cout << "Setting " << n << " failed" << std::endl;
+                }
+            else
+                {
+                    unsigned int detections = 0;
+                    for (std::set<unsigned int>::const_iterator it = detected[n].begin(); it != detected[n].end(); ++it)
+                        {
+                            if (visible.count(*it)) detections++;
+                        }
+                    unsigned int false_alarms = detected[n].size() - detections;
+                    unsigned int absent = searches[n] > visible.size() ? searches[n] - visible.size() : 0;
+                    line << detections << "," << (visible.empty() ? 0.0 : static_cast<double>(detections) / visible.size()) << ","
+                         << false_alarms << "," << (absent == 0 ? 0.0 : static_cast<double>(false_alarms) / absent) << ","
+                         << cpu_s[n] << "," << (searches[n] == 0 ? 0.0 : 1e3 * cpu_s[n] / searches[n]);
+                }
+            results << line.str() << std::endl;
+            std::cout << line.str() << std::endl;
+        }
+    std::cout << "Results written to " << results_filename << std::endl;
+    google::ShutDownCommandLineFlags();
+    return n_done == settings.size() ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+/*!
+ * \file main.cc
+ * \brief Main file of acquisition-server, which searches the acquisition
+ * dwells of all the receivers of a machine in shared batches
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * Receivers whose acquisition is GPS_L1_CA_PCPS_Server_Acquisition submit
+ * their dwells through the file --filename, usually in /dev/shm. The
+ * server takes all the dwells submitted within --batch_wait_us of each
+ * other as one batch, so the Doppler grids and code FFTs are built once
+ * for all the receivers, and searches it on --threads threads or, with
+ * --cuda, on the GPU.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <csignal>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include "acquisition_server.h"
+#include "acquisition_server_link.h"
+#include "acquisition_thread_pool.h"
+
+using google::LogMessage;
+
+DEFINE_string(filename, "/dev/shm/gnss-sdr-acquisition", "File shared with the receivers (Acquisition.server_filename)");
+DEFINE_int32(slots, 64, "Searches that can be submitted at the same time, by all the receivers");
+DEFINE_int32(max_samples, 65536, "Longest dwell of a search [samples]");
+DEFINE_int32(max_doppler_bins, 256, "Largest Doppler grid of a search");
+DEFINE_int32(threads, -1, "Threads of the searches, a quarter of the hardware threads if negative");
+DEFINE_int32(batch_wait_us, 500, "Time that a batch waits for the searches of the other receivers [us]");
+DEFINE_bool(cuda, false, "Search on the GPU, if the server was built with CUDA");
+DEFINE_int32(max_batch_codes, 32, "Codes of a dwell searched in one GPU batch");
+DEFINE_int32(stats_interval_s, 60, "Interval between two logs of the number of searches [s], 0 for none");
+
+namespace
+{
+volatile std::sig_atomic_t stop_requested = 0;
+
+void request_stop(int signal_number __attribute__((unused)))
+{
+    stop_requested = 1;
+}
+}
+
+
+int main(int argc, char** argv)
+{
+    const std::string intro_help(
+            std::string("\nAcquisition server of GNSS-SDR, shared by the receivers of this machine\n")
+    +
+    "Copyright (C) 2010-2015 (see AUTHORS file for a list of contributors)\n"
+    +
+    "This program comes with ABSOLUTELY NO WARRANTY;\n"
+    +
+    "See COPYING file to see a copy of the General Public License\n \n");
+    google::SetUsageMessage(intro_help);
+    google::ParseCommandLineFlags(&argc, &argv, true);
+    google::InitGoogleLogging(argv[0]);
+
+    if (FLAGS_slots <= 0 || FLAGS_max_samples <= 0 || FLAGS_max_doppler_bins <= 0)
+        {
+            std::cout << "--slots, --max_samples and --max_doppler_bins must be positive" << std::endl;
+            return 1;
+        }
+    Acquisition_Thread_Pool::set_num_threads(FLAGS_threads < 0 ? Acquisition_Thread_Pool::default_num_threads() : FLAGS_threads);
+
+    std::shared_ptr<Acquisition_Server_Link> link = std::make_shared<Acquisition_Server_Link>(FLAGS_filename,
+            FLAGS_slots, FLAGS_max_samples, FLAGS_max_doppler_bins);
+    if (!link->is_open())
+        {
+            std::cout << "Unable to create " << FLAGS_filename << std::endl;
+            return 1;
+        }
+    Acquisition_Server server(link, FLAGS_cuda, FLAGS_max_batch_codes);
+
+    // the file is removed on the way out, so that the receivers do not submit to a server that is gone
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+    std::cout << "Acquisition server listening on " << FLAGS_filename << " with "
+              << Acquisition_Thread_Pool::instance().num_threads() << " threads" << std::endl;
+
+    time_t last_stats = time(0);
+    while (!stop_requested)
+        {
+            server.run_once(100000, FLAGS_batch_wait_us);
+            if (FLAGS_stats_interval_s > 0 && time(0) - last_stats >= FLAGS_stats_interval_s)
+                {
+                    last_stats = time(0);
+                    LOG(INFO) << server.searches() << " searches of " << server.dwells() << " dwells in "
+                              << server.batches() << " batches";
+                    if (server.batches() > 0)
+                        {
+                            std::cout << server.searches() << " searches in " << server.batches() << " batches, "
+                                      << static_cast<double>(server.searches()) / static_cast<double>(server.batches())
+                                      << " per batch" << std::endl;
+                        }
+                }
+        }
+    std::cout << "Acquisition server stopped after " << server.searches() << " searches" << std::endl;
+    return 0;
+}
@@ -0,0 +1,515 @@
+/*!
+ * \file main.cc
+ * \brief Main file of campaign-runner, which runs gnss-sdr in batch mode
+ * over the captures and configurations of a manifest, on several nodes
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * Every line of the --manifest (see campaign_read_manifest()) gives a
+ * scenario, a capture, a configuration, the receiver time the attack
+ * starts at and the values that replace some of the configuration, with
+ * a job for every combination of them. The jobs are run --jobs_per_node
+ * at a time on each of the --nodes: on this machine for localhost, and
+ * through --remote_shell for the others, which must see the captures and
+ * configurations at the same paths (e.g. on a shared file system).
+ *
+ * On its node, a job runs campaign-runner --job, which processes the
+ * capture with gnss-sdr --batch_segments faster than real time and
+ * writes its CPU time and its merged PVT log (solutions, observables and
+ * spoofing alarms) to the standard output, as a Campaign_Stream_Header
+ * followed by the log. The runner keeps each log in job_N/PVT_log.dat of
+ * --output_dir and writes the detection latency, alarms and CPU time of
+ * every job to jobs.csv and of every scenario to scenarios.csv.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include "batch_replay.h"
+#include "campaign.h"
+#include "file_configuration.h"
+
+using google::LogMessage;
+
+DEFINE_string(manifest, "", "Jobs of the campaign, one \"scenario capture config_file onset_rx_time [overrides]\" per line");
+DEFINE_string(output_dir, "./campaign", "Directory of the PVT log of every job and of jobs.csv and scenarios.csv");
+DEFINE_string(nodes, "localhost", "Nodes that run the jobs, separated by commas. localhost is this machine, the others are reached with --remote_shell");
+DEFINE_int32(jobs_per_node, 1, "Jobs run at the same time on each node");
+DEFINE_string(remote_shell, "ssh", "Command that runs a command on a node, as remote_shell node command");
+DEFINE_string(remote_runner, "campaign-runner", "campaign-runner on the remote nodes");
+DEFINE_string(gnss_sdr, "gnss-sdr", "gnss-sdr on the nodes");
+DEFINE_string(work_dir, "/tmp/gnss-sdr-campaign", "Directory of the jobs on the nodes, removed once their PVT log is sent, or kept if they fail");
+DEFINE_bool(job, false, "Runs one job on this node and writes its result to the standard output (used by the runner on the nodes)");
+DEFINE_int32(job_id, 0, "Number of the job of --job");
+DEFINE_string(job_capture, "", "Capture of --job");
+DEFINE_string(job_config_file, "", "Configuration of --job");
+DEFINE_string(job_overrides, "-", "Values that replace those of --job_config_file, as Key=value;Key=value");
+
+// of gnss-sdr, for every job (0 segments: one per core of the node)
+DECLARE_int32(batch_segments);
+DECLARE_double(batch_warm_up_s);
+DECLARE_string(log_dir);
+
+#define CAMPAIGN_STREAM_VERSION 1
+
+#pragma pack(push, 1)
+/*!
+ * \brief What campaign-runner --job writes before the PVT log of the job,
+ * in the byte order of the node
+ */
+struct Campaign_Stream_Header
+{
+    char magic[4];      // "GSCR"
+    uint16_t version;
+    uint16_t header_bytes;
+    int32_t status;     // exit status of gnss-sdr
+    uint32_t reserved;
+    double capture_s;
+    double wall_s;
+    double cpu_s;
+    uint64_t log_bytes;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(Campaign_Stream_Header) == 48, "the campaign stream header layout has changed");
+
+
+namespace
+{
+    double wall_time_s()
+    {
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        return tv.tv_sec + tv.tv_usec * 1e-6;
+    }
+
+    // The argument as one word of a shell command
+    std::string shell_quote(const std::string & argument)
+    {
+        std::string quoted("'");
+        for (unsigned int i = 0; i < argument.size(); i++)
+            {
+                quoted += argument[i] == '\'' ? std::string("'\\''") : std::string(1, argument[i]);
+            }
+        return quoted + "'";
+    }
+
+    std::vector<char*> argv_of(std::vector<std::string> & arguments)
+    {
+        std::vector<char*> argv;
+        for (unsigned int i = 0; i < arguments.size(); i++)
+            {
+                argv.push_back(&arguments[i][0]);
+            }
+        argv.push_back(0);
+        return argv;
+    }
+
+    /*
+     * Runs the job of the --job_* flags on this node, see the file comment.
+     * The standard output carries only the stream.
+     */
+    int run_job()
+    {
+        namespace fs = boost::filesystem;
+        Campaign_Stream_Header header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, "GSCR", 4);
+        header.version = CAMPAIGN_STREAM_VERSION;
+        header.header_bytes = sizeof(header);
+        header.status = 1;
+
+        fs::path directory = fs::absolute(FLAGS_work_dir) / ("job_" + std::to_string(FLAGS_job_id) + "_" + std::to_string(getpid()));
+        boost::system::error_code ec;
+        fs::create_directories(directory, ec);
+        // the configuration of the manifest, with the overrides after it so that they replace its values
+        std::vector<Campaign_Overrides> overrides;
+        std::string job_config_file = (directory / "job.conf").string();
+        std::ifstream config(FLAGS_job_config_file.c_str());
+        std::ofstream job_config(job_config_file.c_str());
+        if (!config || !job_config || !campaign_expand_overrides(FLAGS_job_overrides, overrides) || overrides.size() != 1)
+            {
+                std::cerr << "Unable to write the configuration of job " << FLAGS_job_id << " from " << FLAGS_job_config_file << std::endl;
+                std::fwrite(&header, sizeof(header), 1, stdout);
+                return 1;
+            }
+        job_config << config.rdbuf() << std::endl << "; campaign-runner overrides" << std::endl;
+        for (unsigned int i = 0; i < overrides[0].size(); i++)
+            {
+                job_config << overrides[0][i].first << "=" << overrides[0][i].second << std::endl;
+            }
+        job_config.close();
+
+        FileConfiguration configuration(job_config_file);
+        double items_per_second;
+        header.capture_s = capture_duration_s(&configuration, FLAGS_job_capture, items_per_second);
+        unsigned int segments = FLAGS_batch_segments > 0 ? FLAGS_batch_segments : std::max(1u, boost::thread::hardware_concurrency());
+        std::string log_filename = (directory / "batch" / "PVT_log.dat").string();
+        std::vector<std::string> arguments;
+        arguments.push_back(FLAGS_gnss_sdr);
+        arguments.push_back("--config_file=" + job_config_file);
+        arguments.push_back("--signal_source=" + FLAGS_job_capture);
+        arguments.push_back("--batch_segments=" + std::to_string(segments));
+        arguments.push_back("--batch_warm_up_s=" + std::to_string(FLAGS_batch_warm_up_s));
+        arguments.push_back("--batch_output_dir=" + (directory / "batch").string());
+        arguments.push_back("--log_dir=" + directory.string());
+        std::vector<char*> argv = argv_of(arguments);
+        std::string output_filename = (directory / "gnss-sdr.out").string();
+
+        double start_s = wall_time_s();
+        std::fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0)
+            {
+                if (chdir(directory.string().c_str()) != 0 || !std::freopen(output_filename.c_str(), "w", stdout))
+                    {
+                        std::_Exit(127);
+                    }
+                execvp(argv[0], &argv[0]);
+                std::_Exit(127);
+            }
+        int status = 0;
+        if (pid == -1 || waitpid(pid, &status, 0) != pid)
+            {
+                std::cerr << "Unable to run " << FLAGS_gnss_sdr << " for job " << FLAGS_job_id << std::endl;
+                status = 1;
+            }
+        else
+            {
+                status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+            }
+        header.wall_s = wall_time_s() - start_s;
+        // gnss-sdr and its batch segments, all of them waited for
+        struct rusage usage;
+        getrusage(RUSAGE_CHILDREN, &usage);
+        header.cpu_s = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+        header.status = status;
+
+        std::ifstream log(log_filename.c_str(), std::ios::binary);
+        std::vector<char> log_bytes;
+        if (log)
+            {
+                log_bytes.assign(std::istreambuf_iterator<char>(log), std::istreambuf_iterator<char>());
+            }
+        header.log_bytes = log_bytes.size();
+        bool sent = std::fwrite(&header, sizeof(header), 1, stdout) == 1
+                && (log_bytes.empty() || std::fwrite(&log_bytes[0], log_bytes.size(), 1, stdout) == 1)
+                && std::fflush(stdout) == 0;
+        if (status == 0 && sent)
+            {
+                fs::remove_all(directory, ec);
+            }
+        else
+            {
+                std::cerr << "Job " << FLAGS_job_id << " failed, its outputs are kept in " << directory.string() << std::endl;
+            }
+        return sent ? status : 1;
+    }
+
+
+    /*
+     * Runs job on node and keeps its PVT log in directory
+     */
+    Campaign_Job_Result run_on_node(const Campaign_Job & job, const std::string & node, const std::string & runner, const boost::filesystem::path & directory)
+    {
+        Campaign_Job_Result result;
+        std::vector<std::string> job_arguments;
+        job_arguments.push_back("--job");
+        job_arguments.push_back("--job_id=" + std::to_string(job.id));
+        job_arguments.push_back("--job_capture=" + job.capture);
+        job_arguments.push_back("--job_config_file=" + job.config_file);
+        job_arguments.push_back("--job_overrides=" + campaign_overrides_string(job.overrides));
+        job_arguments.push_back("--batch_segments=" + std::to_string(FLAGS_batch_segments));
+        job_arguments.push_back("--batch_warm_up_s=" + std::to_string(FLAGS_batch_warm_up_s));
+        job_arguments.push_back("--gnss_sdr=" + FLAGS_gnss_sdr);
+        job_arguments.push_back("--work_dir=" + FLAGS_work_dir);
+        std::vector<std::string> arguments;
+        if (node == "localhost")
+            {
+                arguments.push_back(runner);
+                arguments.insert(arguments.end(), job_arguments.begin(), job_arguments.end());
+            }
+        else
+            {
+                // the remote shell joins its arguments into one command line
+                std::string command = shell_quote(FLAGS_remote_runner);
+                for (unsigned int i = 0; i < job_arguments.size(); i++)
+                    {
+                        command += " " + shell_quote(job_arguments[i]);
+                    }
+                arguments.push_back(FLAGS_remote_shell);
+                arguments.push_back(node);
+                arguments.push_back(command);
+            }
+        // built before fork(), the child of a threaded process only calls async-signal-safe functions
+        std::vector<char*> argv = argv_of(arguments);
+        std::string errors_filename = (directory / "job.err").string();
+        int stream[2];
+        if (pipe2(stream, O_CLOEXEC) != 0)
+            {
+                return result;
+            }
+        pid_t pid = fork();
+        if (pid == 0)
+            {
+                int errors = open(errors_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                if (dup2(stream[1], 1) == -1 || errors == -1 || dup2(errors, 2) == -1)
+                    {
+                        _exit(127);
+                    }
+                execvp(argv[0], &argv[0]);
+                _exit(127);
+            }
+        close(stream[1]);
+        if (pid == -1)
+            {
+                close(stream[0]);
+                return result;
+            }
+
+        FILE* in = fdopen(stream[0], "rb");
+        Campaign_Stream_Header header;
+        bool received = std::fread(&header, sizeof(header), 1, in) == 1 && std::memcmp(header.magic, "GSCR", 4) == 0
+                && header.version == CAMPAIGN_STREAM_VERSION && header.header_bytes == sizeof(header);
+        std::string log_filename = (directory / "PVT_log.dat").string();
+        if (received)
+            {
+                std::ofstream log(log_filename.c_str(), std::ios::binary | std::ios::trunc);
+                std::vector<char> buffer(65536);
+                uint64_t left = header.log_bytes;
+                while (left > 0 && log)
+                    {
+                        size_t n = std::fread(&buffer[0], 1, std::min<uint64_t>(left, buffer.size()), in);
+                        if (n == 0)
+                            {
+                                break;
+                            }
+                        log.write(&buffer[0], n);
+                        left -= n;
+                    }
+                received = left == 0 && log.good();
+            }
+        std::fclose(in);
+        int status;
+        bool ended = waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+
+        if (received)
+            {
+                result.capture_s = header.capture_s;
+                result.wall_s = header.wall_s;
+                result.cpu_s = header.cpu_s;
+            }
+        result.done = received && ended && header.status == 0 && campaign_read_pvt_log(log_filename, job.onset_rx_time, result);
+        return result;
+    }
+
+
+    class Campaign_Scheduler
+    {
+    public:
+        Campaign_Scheduler(const std::vector<Campaign_Job> & jobs, const std::string & runner, const boost::filesystem::path & output_dir) :
+            d_jobs(jobs), d_results(jobs.size()), d_next(0), d_runner(runner), d_output_dir(output_dir) {}
+
+        // Takes the next job until there are none left
+        void run_node(const std::string & node)
+        {
+            while (true)
+                {
+                    unsigned int n;
+                    {
+                        boost::mutex::scoped_lock lock(d_mutex);
+                        if (d_next == d_jobs.size()) return;
+                        n = d_next++;
+                        std::cout << "Job " << n << " (" << d_jobs[n].scenario << ") started on " << node << std::endl;
+                    }
+                    boost::filesystem::path directory = d_output_dir / ("job_" + std::to_string(n));
+                    boost::system::error_code ec;
+                    boost::filesystem::create_directories(directory, ec);
+                    Campaign_Job_Result result = run_on_node(d_jobs[n], node, d_runner, directory);
+                    boost::mutex::scoped_lock lock(d_mutex);
+                    d_results[n] = result;
+                    std::cout << "Job " << n << (result.done ? " done" : " failed (see job_" + std::to_string(n) + "/job.err)")
+                              << " on " << node << std::endl;
+                }
+        }
+
+        const std::vector<Campaign_Job_Result> & results() const { return d_results; }
+
+    private:
+        const std::vector<Campaign_Job> & d_jobs;
+        std::vector<Campaign_Job_Result> d_results;
+        unsigned int d_next;
+        std::string d_runner;
+        boost::filesystem::path d_output_dir;
+        boost::mutex d_mutex;
+    };
+
+
+    void write_jobs(const std::string & filename, const std::vector<Campaign_Job> & jobs, const std::vector<Campaign_Job_Result> & results)
+    {
+        std::ofstream file(filename.c_str());
+        file << "job,scenario,capture,config_file,overrides,onset_rx_time,done,capture_s,wall_s,cpu_s,times_real_time,"
+             << "solutions,alarms,false_alarms,first_alarm_rx_time,detection_latency_s" << std::endl;
+        for (unsigned int n = 0; n < jobs.size(); n++)
+            {
+                const Campaign_Job_Result & result = results[n];
+                file << n << "," << jobs[n].scenario << "," << jobs[n].capture << "," << jobs[n].config_file << ",\""
+                     << campaign_overrides_string(jobs[n].overrides) << "\",";
+                if (jobs[n].onset_rx_time >= 0.0) file << jobs[n].onset_rx_time;
+                file << "," << (result.done ? 1 : 0);
+                if (!result.done)
+                    {
+                        file << ",,,,,,,,," << std::endl;
+                        continue;
+                    }
+                file << "," << result.capture_s << "," << result.wall_s << "," << result.cpu_s << ","
+                     << (result.wall_s > 0.0 ? result.capture_s / result.wall_s : 0.0) << "," << result.solutions << ","
+                     << result.alarms << "," << result.false_alarms << ",";
+                if (result.first_alarm_rx_time >= 0.0) file << result.first_alarm_rx_time;
+                file << ",";
+                if (result.detection_latency_s >= 0.0) file << result.detection_latency_s;
+                file << std::endl;
+            }
+    }
+
+
+    void write_scenarios(const std::string & filename, const std::vector<Campaign_Scenario_Summary> & summaries)
+    {
+        std::ofstream file(filename.c_str());
+        std::string columns("scenario,jobs,failed,attacks,detected,false_alarms,mean_latency_s,max_latency_s,capture_s,wall_s,cpu_s,times_real_time");
+        file << columns << std::endl;
+        std::cout << columns << std::endl;
+        for (unsigned int i = 0; i < summaries.size(); i++)
+            {
+                const Campaign_Scenario_Summary & s = summaries[i];
+                std::stringstream line;
+                line << s.scenario << "," << s.jobs << "," << s.failed << "," << s.attacks << "," << s.detected << "," << s.false_alarms << ",";
+                if (s.detected > 0) line << s.mean_latency_s << "," << s.max_latency_s;
+                else line << ",";
+                line << "," << s.capture_s << "," << s.wall_s << "," << s.cpu_s << "," << (s.wall_s > 0.0 ? s.capture_s / s.wall_s : 0.0);
+                file << line.str() << std::endl;
+                std::cout << line.str() << std::endl;
+            }
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    namespace fs = boost::filesystem;
+    const std::string intro_help(
+            std::string("\nRuns GNSS-SDR in batch mode over the captures and configurations of a campaign, on several nodes\n")
+    +
+    "Copyright (C) 2010-2015 (see AUTHORS file for a list of contributors)\n"
+    +
+    "This program comes with ABSOLUTELY NO WARRANTY;\n"
+    +
+    "See COPYING file to see a copy of the General Public License\n \n");
+    google::SetUsageMessage(intro_help);
+    google::ParseCommandLineFlags(&argc, &argv, true);
+    google::InitGoogleLogging(argv[0]);
+
+    if (FLAGS_job)
+        {
+            int status = run_job();
+            google::ShutDownCommandLineFlags();
+            return status;
+        }
+
+    if (FLAGS_manifest.empty())
+        {
+            std::cout << "Please give the jobs of the campaign with --manifest" << std::endl;
+            return 1;
+        }
+    std::vector<Campaign_Job> jobs;
+    std::string error;
+    if (!campaign_read_manifest(FLAGS_manifest, jobs, error))
+        {
+            std::cout << error << std::endl;
+            return 1;
+        }
+    std::vector<std::string> nodes;
+    std::stringstream nodes_stream(FLAGS_nodes);
+    std::string node;
+    while (std::getline(nodes_stream, node, ','))
+        {
+            if (!node.empty()) nodes.push_back(node);
+        }
+    if (jobs.empty() || nodes.empty())
+        {
+            std::cout << "No jobs in " << FLAGS_manifest << " or no --nodes" << std::endl;
+            return 1;
+        }
+    // the local jobs run this same executable
+    std::string runner = fs::read_symlink("/proc/self/exe").string();
+    fs::path output_dir = fs::absolute(FLAGS_output_dir);
+    boost::system::error_code ec;
+    fs::create_directories(output_dir, ec);
+
+    unsigned int jobs_per_node = std::max(1, FLAGS_jobs_per_node);
+    std::cout << "Running " << jobs.size() << " jobs on " << nodes.size() << " nodes, " << jobs_per_node << " at a time on each one" << std::endl;
+    Campaign_Scheduler scheduler(jobs, runner, output_dir);
+    boost::thread_group slots;
+    for (unsigned int i = 0; i < nodes.size(); i++)
+        {
+            for (unsigned int j = 0; j < jobs_per_node; j++)
+                {
+                    slots.create_thread(boost::bind(&Campaign_Scheduler::run_node, &scheduler, nodes[i]));
+                }
+        }
+    slots.join_all();
+
+    const std::vector<Campaign_Job_Result> & results = scheduler.results();
+    write_jobs((output_dir / "jobs.csv").string(), jobs, results);
+    std::vector<Campaign_Scenario_Summary> summaries = campaign_summaries(jobs, results);
+    write_scenarios((output_dir / "scenarios.csv").string(), summaries);
+    unsigned int failed = 0;
+    for (unsigned int i = 0; i < summaries.size(); i++)
+        {
+            failed += summaries[i].failed;
+        }
+    std::cout << "Results written to " << (output_dir / "scenarios.csv").string() << " and jobs.csv, the PVT log of each job to job_N/PVT_log.dat" << std::endl;
+    google::ShutDownCommandLineFlags();
+    return failed == 0 ? 0 : 1;
+}
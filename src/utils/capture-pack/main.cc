@@ -0,0 +1,169 @@
+/*!
+ * \file main.cc
+ * \brief Main file of capture-pack, which converts raw captures to
+ * chunked capture files and back
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef CAPTURE_PACK_VERSION
+#define CAPTURE_PACK_VERSION "0.0.1"
+#endif
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <gflags/gflags.h>
+#include "chunked_capture.h"
+
+DEFINE_string(input, "", "Raw capture to pack, or chunked capture to unpack");
+DEFINE_string(output, "", "File to write");
+DEFINE_string(item_type, "ishort", "Item type of the raw capture: byte, ibyte, short or ishort");
+DEFINE_double(sampling_frequency, 0.0, "Sampling frequency of the raw capture [samples/s], stored in the chunked capture");
+DEFINE_int32(chunk_values, 1048576, "Values per chunk: smaller chunks are reached faster, larger ones compress a bit better");
+DEFINE_bool(unpack, false, "Write the raw capture held in the chunked capture --input");
+
+
+int pack()
+{
+    unsigned int value_bytes;
+    bool is_complex;
+    if (FLAGS_item_type.compare("byte") == 0 || FLAGS_item_type.compare("ibyte") == 0)
+        {
+            value_bytes = 1;
+        }
+    else if (FLAGS_item_type.compare("short") == 0 || FLAGS_item_type.compare("ishort") == 0)
+        {
+            value_bytes = 2;
+        }
+    else
+        {
+            std::cerr << "Unsupported --item_type " << FLAGS_item_type << std::endl;
+            return 1;
+        }
+    is_complex = (FLAGS_item_type[0] == 'i');
+    if (FLAGS_sampling_frequency <= 0.0 || FLAGS_chunk_values <= 0)
+        {
+            std::cerr << "--sampling_frequency and --chunk_values must be positive" << std::endl;
+            return 1;
+        }
+
+    FILE* input = std::fopen(FLAGS_input.c_str(), "rb");
+    if (!input)
+        {
+            std::cerr << "Unable to open " << FLAGS_input << std::endl;
+            return 1;
+        }
+    Chunked_Capture_Writer writer;
+    if (!writer.open(FLAGS_output, value_bytes, is_complex, FLAGS_sampling_frequency, FLAGS_chunk_values))
+        {
+            std::cerr << "Unable to create " << FLAGS_output << std::endl;
+            std::fclose(input);
+            return 1;
+        }
+    std::vector<char> buffer(static_cast<size_t>(FLAGS_chunk_values) * value_bytes);
+    size_t values;
+    bool ok = true;
+    while (ok && (values = std::fread(&buffer[0], value_bytes, FLAGS_chunk_values, input)) > 0)
+        {
+            ok = writer.write(&buffer[0], values);
+        }
+    std::fclose(input);
+    ok = writer.close() && ok;
+    if (!ok)
+        {
+            std::cerr << "Error writing " << FLAGS_output << std::endl;
+            return 1;
+        }
+    unsigned long long raw_bytes = writer.total_values() * value_bytes;
+    std::cout << FLAGS_output << ": " << writer.total_values() << " " << FLAGS_item_type << " values, "
+              << raw_bytes << " -> " << writer.file_bytes() << " bytes (x"
+              << static_cast<double>(raw_bytes) / static_cast<double>(writer.file_bytes()) << ")" << std::endl;
+    return 0;
+}
+
+
+int unpack()
+{
+    Chunked_Capture_Reader reader;
+    if (!reader.open(FLAGS_input))
+        {
+            std::cerr << FLAGS_input << " is not a readable chunked capture file" << std::endl;
+            return 1;
+        }
+    const Chunked_Capture_Header& header = reader.header();
+    FILE* output = std::fopen(FLAGS_output.c_str(), "wb");
+    if (!output)
+        {
+            std::cerr << "Unable to create " << FLAGS_output << std::endl;
+            return 1;
+        }
+    std::vector<unsigned char> encoded;
+    std::vector<char> values(static_cast<size_t>(header.chunk_values) * header.value_bytes);
+    for (unsigned long long chunk = 0; chunk < header.chunks; chunk++)
+        {
+            unsigned int n = reader.chunk_values(chunk);
+            if (!reader.decode_chunk(chunk, encoded, &values[0])
+                    || std::fwrite(&values[0], header.value_bytes, n, output) != n)
+                {
+                    std::cerr << "Error unpacking chunk " << chunk << " of " << FLAGS_input << std::endl;
+                    std::fclose(output);
+                    return 1;
+                }
+        }
+    std::fclose(output);
+    std::cout << FLAGS_output << ": " << header.total_values << " " << chunked_capture_item_type(header)
+              << " values at " << header.sampling_frequency << " samples/s" << std::endl;
+    return 0;
+}
+
+
+int main(int argc, char** argv)
+{
+    const std::string intro_help(
+            std::string("\n Converts raw captures to losslessly compressed chunked captures, read by the Chunked_Capture_Signal_Source, and back\n")
+    +
+    "Copyright (C) 2010-2015 (see AUTHORS file for a list of contributors)\n"
+    +
+    "This program comes with ABSOLUTELY NO WARRANTY;\n"
+    +
+    "See COPYING file to see a copy of the General Public License\n \n");
+
+    google::SetUsageMessage(intro_help);
+    google::SetVersionString(CAPTURE_PACK_VERSION);
+    google::ParseCommandLineFlags(&argc, &argv, true);
+
+    if (FLAGS_input.empty() || FLAGS_output.empty())
+        {
+            std::cerr << "Usage: capture-pack --input=capture.dat --output=capture.ccap --item_type=ishort --sampling_frequency=4000000" << std::endl
+                      << "       capture-pack --unpack --input=capture.ccap --output=capture.dat" << std::endl;
+            return 1;
+        }
+    int result = FLAGS_unpack ? unpack() : pack();
+    google::ShutDownCommandLineFlags();
+    return result;
+}
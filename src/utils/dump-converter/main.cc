@@ -0,0 +1,211 @@
+/*!
+ * \file main.cc
+ * \brief Main file of dump-converter, which writes the binary dump files
+ * of the blocks as HDF5 or CSV files
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef DUMP_CONVERTER_VERSION
+#define DUMP_CONVERTER_VERSION "0.0.1"
+#endif
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <gflags/gflags.h>
+#include "dump_reader.h"
+#ifdef DUMP_CONVERTER_HDF5
+#include <hdf5.h>
+#endif
+
+DEFINE_string(input, "", "Dump file written by a block of the receiver");
+DEFINE_string(output, "", "File to write");
+DEFINE_string(format, "csv", "Format of --output: csv, or hdf5 where dump-converter was built with HDF5");
+
+
+int write_csv(const Dump_Reader& reader)
+{
+    std::ofstream output(FLAGS_output.c_str());
+    if (!output)
+        {
+            std::cerr << "Unable to open " << FLAGS_output << std::endl;
+            return 1;
+        }
+    const std::vector<Dump_Field>& fields = reader.schema().fields();
+    std::string separator;
+    for (unsigned int f = 0; f < fields.size(); f++)
+        {
+            for (unsigned int e = 0; e < fields[f].count; e++)
+                {
+                    output << separator << fields[f].name;
+                    if (fields[f].count > 1)
+                        {
+                            output << "[" << e << "]";
+                        }
+                    separator = ",";
+                }
+        }
+    output << "\n" << std::setprecision(17);
+    for (unsigned long long n = 0; n < reader.num_records(); n++)
+        {
+            separator.clear();
+            for (unsigned int f = 0; f < fields.size(); f++)
+                {
+                    for (unsigned int e = 0; e < fields[f].count; e++)
+                        {
+                            output << separator << reader.value(n, f, e);
+                            separator = ",";
+                        }
+                }
+            output << "\n";
+        }
+    return output ? 0 : 1;
+}
+
+
+#ifdef DUMP_CONVERTER_HDF5
+hid_t hdf5_type(Dump_Field_Type type)
+{
+    switch (type)
+    {
+    case DUMP_INT8: return H5T_NATIVE_INT8;
+    case DUMP_UINT8: return H5T_NATIVE_UINT8;
+    case DUMP_INT16: return H5T_NATIVE_INT16;
+    case DUMP_UINT16: return H5T_NATIVE_UINT16;
+    case DUMP_INT32: return H5T_NATIVE_INT32;
+    case DUMP_UINT32: return H5T_NATIVE_UINT32;
+    case DUMP_INT64: return H5T_NATIVE_INT64;
+    case DUMP_UINT64: return H5T_NATIVE_UINT64;
+    case DUMP_FLOAT32: return H5T_NATIVE_FLOAT;
+    case DUMP_FLOAT64: return H5T_NATIVE_DOUBLE;
+    }
+    return H5T_NATIVE_DOUBLE;
+}
+
+
+/*!
+ * \brief One dataset per field, of num_records rows of count values,
+ * and the name of the schema as an attribute of the file
+ */
+int write_hdf5(const Dump_Reader& reader)
+{
+    hid_t file = H5Fcreate(FLAGS_output.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    if (file < 0)
+        {
+            std::cerr << "Unable to open " << FLAGS_output << std::endl;
+            return 1;
+        }
+    int result = 0;
+    hid_t scalar = H5Screate(H5S_SCALAR);
+    hid_t string_type = H5Tcopy(H5T_C_S1);
+    H5Tset_size(string_type, reader.schema().name().size() + 1);
+    hid_t attribute = H5Acreate2(file, "schema", string_type, scalar, H5P_DEFAULT, H5P_DEFAULT);
+    H5Awrite(attribute, string_type, reader.schema().name().c_str());
+    H5Aclose(attribute);
+    H5Tclose(string_type);
+    H5Sclose(scalar);
+
+    const std::vector<Dump_Field>& fields = reader.schema().fields();
+    for (unsigned int f = 0; f < fields.size() && result == 0; f++)
+        {
+            const size_t field_bytes = fields[f].count * dump_field_type_bytes(fields[f].type);
+            std::vector<char> column(reader.num_records() * field_bytes + 1);
+            for (unsigned long long n = 0; n < reader.num_records(); n++)
+                {
+                    std::memcpy(&column[n * field_bytes], reader.record(n) + fields[f].offset, field_bytes);
+                }
+            hsize_t dimensions[2] = { reader.num_records(), fields[f].count };
+            hid_t space = H5Screate_simple(2, dimensions, 0);
+            hid_t dataset = H5Dcreate2(file, fields[f].name.c_str(), hdf5_type(fields[f].type), space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+            if (dataset < 0 || H5Dwrite(dataset, hdf5_type(fields[f].type), H5S_ALL, H5S_ALL, H5P_DEFAULT, &column[0]) < 0)
+                {
+                    std::cerr << "Unable to write field " << fields[f].name << " to " << FLAGS_output << std::endl;
+                    result = 1;
+                }
+            if (dataset >= 0)
+                {
+                    H5Dclose(dataset);
+                }
+            H5Sclose(space);
+        }
+    H5Fclose(file);
+    return result;
+}
+#endif
+
+
+int main(int argc, char** argv)
+{
+    const std::string intro_help(
+            std::string("\n Writes the binary dump files of the receiver blocks as HDF5 or CSV files\n")
+    +
+    "Copyright (C) 2010-2015 (see AUTHORS file for a list of contributors)\n"
+    +
+    "This program comes with ABSOLUTELY NO WARRANTY;\n"
+    +
+    "See COPYING file to see a copy of the General Public License\n \n");
+
+    google::SetUsageMessage(intro_help);
+    google::SetVersionString(DUMP_CONVERTER_VERSION);
+    google::ParseCommandLineFlags(&argc, &argv, true);
+
+    if (FLAGS_input.empty() || FLAGS_output.empty())
+        {
+            std::cerr << "Usage: dump-converter --input=tracking_ch_0.dat --output=tracking_ch_0.csv [--format=csv|hdf5]" << std::endl;
+            return 1;
+        }
+    Dump_Reader reader;
+    if (!reader.open(FLAGS_input))
+        {
+            std::cerr << "Unable to read " << FLAGS_input << ": not a dump file with a header" << std::endl;
+            return 1;
+        }
+    std::cout << FLAGS_input << ": " << reader.schema().name() << ", " << reader.num_records() << " records" << std::endl;
+
+    int result = 1;
+    if (FLAGS_format.compare("csv") == 0)
+        {
+            result = write_csv(reader);
+        }
+    else if (FLAGS_format.compare("hdf5") == 0)
+        {
+#ifdef DUMP_CONVERTER_HDF5
+            result = write_hdf5(reader);
+#else
+            std::cerr << "dump-converter was built without HDF5, use --format=csv" << std::endl;
+#endif
+        }
+    else
+        {
+            std::cerr << "Unsupported --format " << FLAGS_format << std::endl;
+        }
+    google::ShutDownCommandLineFlags();
+    return result;
+}
@@ -48,12 +48,12 @@
 #include "gps_cnav_iono.h"
 #include "gps_utc_model.h"
 #include "gnss_sdr_supl_client.h"
+#include "receiver_state.h"
 
 extern concurrent_map<Gps_Ephemeris> global_gps_ephemeris_map;
 extern concurrent_map<Gps_Iono> global_gps_iono_map;
 extern concurrent_map<Gps_Utc_Model> global_gps_utc_model_map;
 extern concurrent_map<Gps_Almanac> global_gps_almanac_map;
-extern concurrent_map<Gps_Acq_Assist> global_gps_acq_assist_map;
 
 FrontEndCal::FrontEndCal()
 {}
@@ -222,7 +222,7 @@ int FrontEndCal::Get_SUPL_Assist()
                                     LOG(INFO) << "SUPL: Received Acquisition assistance for GPS SV " << gps_acq_iter->first;
                                     std::cout << "SUPL: Received Acquisition assistance for GPS SV " << gps_acq_iter->first << std::endl;
                                     LOG(INFO) << "New acq assist record inserted";
-                                    global_gps_acq_assist_map.write(gps_acq_iter->second.i_satellite_PRN, gps_acq_iter->second);
+                                    Receiver_State::current()->gps_acq_assist_map.write(gps_acq_iter->second.i_satellite_PRN, gps_acq_iter->second);
                                 }
                         }
                     else
@@ -415,3 +415,22 @@ void FrontEndCal::GPS_L1_front_end_model_E4000(double f_bb_true_Hz, double f_bb_
 }
 
 
+double FrontEndCal::GPS_L1_front_end_offset_E4000(double f_osc_err_ppm)
+{
+    const double f_osc_n = 28.8e6;
+    //PLL registers settings (according to E4000 datasheet)
+    const double N = 109.0;
+    const double Y = 65536.0;
+    const double X = 26487.0;
+    const double R = 2.0;
+
+    double f_rf_pll = (f_osc_n * (N + X / Y)) /R;
+    double f_bb_err_pll = GPS_L1_FREQ_HZ - f_rf_pll;
+
+    // a positive oscillator error lowers the measured frequencies, see GPS_L1_front_end_model_E4000
+    double f_osc_err_hz = f_osc_err_ppm * (f_osc_n / 1e6);
+    double f_rf_err = -f_osc_err_hz * (N + X / Y) / R;
+    return f_rf_err + f_bb_err_pll;
+}
+
+
@@ -134,6 +134,13 @@ public:
      */
     void GPS_L1_front_end_model_E4000(double f_bb_true_Hz,double f_bb_meas_Hz,double fs_nominal_hz, double *estimated_fs_Hz, double *estimated_f_if_Hz, double *f_osc_err_ppm );
 
+    /*!
+     * \brief Inverse of GPS_L1_front_end_model_E4000: offset [Hz] of the
+     * measured baseband frequencies of the satellites with respect to the
+     * ideal ones, for a reference oscillator error f_osc_err_ppm
+     */
+    double GPS_L1_front_end_offset_E4000(double f_osc_err_ppm);
+
     FrontEndCal();
     ~FrontEndCal();
 };
@@ -32,8 +32,11 @@
 #define FRONT_END_CAL_VERSION "0.0.1"
 #endif
 
+#include <algorithm>
+#include <cmath>
 #include <ctime>
 #include <exception>
+#include <fstream>
 #include <memory>
 #include <queue>
 #include <vector>
@@ -50,9 +53,19 @@
 #include <gnuradio/blocks/head.h>
 #include <gnuradio/blocks/file_source.h>
 #include <gnuradio/blocks/file_sink.h>
+#include <volk/volk.h>
+#include "concurrent_queue.h"
+#include "concurrent_ring_queue.h"
 #include "concurrent_map.h"
+#include "concurrent_snapshot_map.h"
+#include "navigation_data_bus.h"
+#include "concurrent_subframe_map.h"
 #include "file_configuration.h"
 #include "gps_l1_ca_pcps_acquisition_fine_doppler.h"
+#include "acquisition_cache.h"
+#include "acquisition_thread_pool.h"
+#include "code_bank.h"
+#include "GPS_L1_CA.h"
 #include "gnss_signal.h"
 #include "gnss_synchro.h"
 #include "gnss_block_factory.h"
@@ -60,6 +73,8 @@
 #include "gps_ephemeris.h"
 #include "gps_cnav_ephemeris.h"
 #include "gps_almanac.h"
+#include "gps_ref_location.h"
+#include "gps_ref_time.h"
 #include "gps_iono.h"
 #include "gps_cnav_iono.h"
 #include "gps_utc_model.h"
@@ -74,6 +89,10 @@
 #include "sbas_time.h"
 #include "gnss_sdr_supl_client.h"
 #include "spoofing_message.h"
+#include "vector_tracking_aid.h"
+#include "correlator_taps.h"
+#include "sqm_metrics.h"
+#include "aoa_metrics.h"
 
 
 #include "front_end_cal.h"
@@ -89,11 +108,15 @@ std::string s3_ = s1_ + s2_;
 DEFINE_string(config_file, s3_,
         "Path to the file containing the configuration parameters");
 
+DEFINE_bool(parallel, false, "Searches all the satellites at the same time in the capture loaded in memory, updating the estimation as they are found");
+DEFINE_int32(threads, 0, "Threads of the parallel search (0: one per hardware thread)");
+DEFINE_double(ppm, 0.0, "Known reference oscillator error [ppm]: the parallel search is centered at the frequency it predicts");
+DEFINE_int32(ppm_doppler_max, 6000, "Doppler searched [Hz] around the frequency predicted with -ppm");
+
 concurrent_map<Gps_Ephemeris> global_gps_ephemeris_map;
 concurrent_map<Gps_Iono> global_gps_iono_map;
 concurrent_map<Gps_Utc_Model> global_gps_utc_model_map;
 concurrent_map<Gps_Almanac> global_gps_almanac_map;
-concurrent_map<Gps_Acq_Assist> global_gps_acq_assist_map;
 
 bool stop;
 concurrent_queue<int> channel_internal_queue;
@@ -157,37 +180,6 @@ FrontEndCal_msg_rx::~FrontEndCal_msg_rx()
 {}
 
 // ###########################################################
-//For spoofing detection
-struct GPS_time_t{
-    int week;
-    double TOW;
-    double timestamp;    
-    int subframe_id;
-};
-
-struct sEph{
-    Gps_Ephemeris ephemeris;
-    double time;
-    bool changed;
-};
-
-concurrent_map<GPS_time_t> global_gps_time;
-concurrent_map<sEph> global_sEph_map;
-concurrent_map<double> global_last_gps_time;
-concurrent_map<bool> global_spoofing_status;  //spoofing has been detected for the satellite
-
-struct Subframe{
-    std::string subframe;
-    unsigned int subframe_id;
-    unsigned int PRN;
-    double timestamp;
-    unsigned int toa;
-    unsigned int uid;
-};
-
-concurrent_map<Subframe> global_subframe_map;
-concurrent_map<std::map<unsigned int, unsigned int>> global_subframe_check;
-concurrent_queue<Spoofing_Message> global_spoofing_queue;
 
 void wait_message()
 {
@@ -282,6 +274,252 @@ bool front_end_capture(std::shared_ptr<ConfigurationInterface> configuration)
 }
 
 
+// ######## PARALLEL SEARCH #########
+
+/*
+ * The parallel search runs the algorithm of pcps_acquisition_fine_doppler_cc
+ * for all the PRNs at the same time, on the capture loaded in memory instead
+ * of through one flowgraph run per PRN. Each PRN is a job of the
+ * Acquisition_Thread_Pool, and the jobs get the FFTs of the capture wiped
+ * off with the Doppler grid from the Acquisition_Cache, so each dwell is
+ * transformed once for all the PRNs.
+ */
+struct Parallel_Search_Result
+{
+    unsigned int PRN;
+    bool detected;
+    double doppler_hz;
+    float test_statistics;
+};
+
+
+struct Parallel_Search
+{
+    std::vector<gr_complex> capture;
+    long fs_in;
+    long freq;                   // IF of the samples [Hz]
+    int samples_per_code;
+    unsigned int fft_size;
+    unsigned int max_dwells;
+    long doppler_center;         // Doppler at the center of the grid [Hz]
+    unsigned int doppler_max;    // half the span of the grid [Hz]
+    unsigned int doppler_step;
+    float threshold;
+    std::shared_ptr<const Doppler_Wipeoff_Grid> grid;
+    concurrent_queue<Parallel_Search_Result> results;
+};
+
+
+void parallel_search_prn(std::shared_ptr<Parallel_Search> search_ptr, unsigned int PRN)
+{
+    Parallel_Search& search = *search_ptr;
+    Acquisition_Scratch& scratch = Acquisition_Thread_Pool::scratch();
+    unsigned int fft_size = search.fft_size;
+    unsigned int num_doppler_bins = search.grid->num_doppler_bins();
+    gr::fft::fft_complex* fft = scratch.fft(fft_size);
+    gr::fft::fft_complex* ifft = scratch.ifft(fft_size);
+    float* magnitude = scratch.magnitude(2 * fft_size);
+
+    // local code replica, one code period per ms of the block
+    Code_Bank::Replica code = Code_Bank::gps_l1_ca(PRN, search.fs_in, 0);
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            fft->get_inbuf()[i] = (*code)[i % search.samples_per_code];
+        }
+    std::shared_ptr<const Code_Fft> code_fft = Acquisition_Cache::code_fft('G', "1C", PRN, fft);
+
+    // 1- Accumulate the grid of max_dwells blocks non-coherently
+    std::vector<float> grid_data(num_doppler_bins * fft_size, 0.0);
+    for (unsigned int dwell = 0; dwell < search.max_dwells; dwell++)
+        {
+            unsigned long int sample_stamp = dwell * fft_size;
+            std::shared_ptr<const Input_Fft_Batch> input_ffts = Acquisition_Cache::input_fft_batch(search.grid,
+                    sample_stamp, &search.capture[sample_stamp], fft);
+            for (unsigned int doppler_index = 0; doppler_index < num_doppler_bins; doppler_index++)
+                {
+                    float* line = &grid_data[doppler_index * fft_size];
+                    volk_32fc_x2_multiply_32fc(ifft->get_inbuf(), input_ffts->get(doppler_index), code_fft->get(), fft_size);
+                    ifft->execute();
+                    volk_32fc_magnitude_squared_32f(magnitude, ifft->get_outbuf(), fft_size);
+                    volk_32f_x2_add_32f(line, line, magnitude, fft_size);
+                }
+        }
+
+    // 2- Search the maximum and compute the test statistics
+    float magt = 0.0;
+    unsigned int code_phase = 0;
+    unsigned int index_doppler = 0;
+    for (unsigned int doppler_index = 0; doppler_index < num_doppler_bins; doppler_index++)
+        {
+            const float* line = &grid_data[doppler_index * fft_size];
+            unsigned int indext = std::max_element(line, line + fft_size) - line;
+            if (line[indext] > magt)
+                {
+                    magt = line[indext];
+                    code_phase = indext % search.samples_per_code;
+                    index_doppler = doppler_index;
+                }
+        }
+    const gr_complex* next_block = &search.capture[search.max_dwells * fft_size];
+    float input_power = 0.0;
+    volk_32fc_magnitude_squared_32f(magnitude, next_block, fft_size);
+    volk_32f_accumulator_s32f(&input_power, magnitude, fft_size);
+    input_power /= static_cast<float>(fft_size);
+    float fft_normalization_factor = static_cast<float>(fft_size) * static_cast<float>(fft_size);
+    magt = magt / (fft_normalization_factor * fft_normalization_factor);
+
+    Parallel_Search_Result result;
+    result.PRN = PRN;
+    result.test_statistics = magt / (input_power * std::sqrt(search.max_dwells));
+    result.detected = result.test_statistics > search.threshold;
+    result.doppler_hz = search.doppler_center - static_cast<long>(search.doppler_max) + static_cast<long>(search.doppler_step * index_doppler);
+
+    // 3- Refine the Doppler with a zero padded FFT of the next block wiped off with the aligned code
+    if (result.detected)
+        {
+            unsigned int fft_size_extended = 2 * fft_size;
+            gr::fft::fft_complex* fft_extended = scratch.fft(fft_size_extended);
+            memset(fft_extended->get_inbuf(), 0, fft_size_extended * sizeof(gr_complex));
+            for (unsigned int i = 0; i < fft_size; i++)
+                {
+                    gr_complex chip = (*code)[(i + search.samples_per_code - code_phase) % search.samples_per_code];
+                    fft_extended->get_inbuf()[i] = next_block[i] * chip;
+                }
+            fft_extended->execute();
+            volk_32fc_magnitude_squared_32f(magnitude, fft_extended->get_outbuf(), fft_size_extended);
+            unsigned int indext = std::max_element(magnitude, magnitude + fft_size_extended) - magnitude;
+            int bin = indext < fft_size_extended / 2 ? static_cast<int>(indext) : static_cast<int>(indext) - static_cast<int>(fft_size_extended);
+            double fine_doppler_hz = static_cast<double>(bin) * static_cast<double>(search.fs_in) / static_cast<double>(fft_size_extended) - search.freq;
+            if (std::abs(fine_doppler_hz - result.doppler_hz) < 1000)
+                {
+                    result.doppler_hz = fine_doppler_hz;
+                }
+        }
+    search.results.push(result);
+}
+
+
+/*
+ * Searches PRNs 1 to 32 in tmp_capture.dat and updates the front-end
+ * estimation with each satellite as soon as it is found. With -ppm, the
+ * grid is centered at the baseband frequency that the E4000 model
+ * predicts for that oscillator error, and only spans -ppm_doppler_max.
+ */
+void parallel_search(std::shared_ptr<ConfigurationInterface> configuration, FrontEndCal& front_end_cal,
+        std::map<int,double>& doppler_measurements_map)
+{
+    // the jobs hold the search until they are done with it
+    std::shared_ptr<Parallel_Search> search_ptr = std::make_shared<Parallel_Search>();
+    Parallel_Search& search = *search_ptr;
+    search.fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
+    search.freq = configuration->property("Acquisition.if", 0);
+    search.samples_per_code = round(search.fs_in / (GPS_L1_CA_CODE_RATE_HZ / GPS_L1_CA_CODE_LENGTH_CHIPS));
+    search.fft_size = search.samples_per_code * configuration->property("Acquisition.coherent_integration_time_ms", 1);
+    search.max_dwells = configuration->property("Acquisition.max_dwells", 1);
+    search.threshold = configuration->property("Acquisition.threshold", 0.0);
+    search.doppler_step = configuration->property("Acquisition.doppler_step", 250);
+    int doppler_max = configuration->property("Acquisition.doppler_max", 10000);
+    int doppler_min = configuration->property("Acquisition.doppler_min", -10000);
+    search.doppler_center = (doppler_max + doppler_min) / 2;
+    search.doppler_max = std::abs(doppler_max - doppler_min) / 2;
+    if (!google::GetCommandLineFlagInfoOrDie("ppm").is_default)
+        {
+            search.doppler_center = round(front_end_cal.GPS_L1_front_end_offset_E4000(FLAGS_ppm));
+            search.doppler_max = FLAGS_ppm_doppler_max;
+            std::cout << "Searching around " << search.doppler_center << " [Hz], as predicted for "
+                      << FLAGS_ppm << " [ppm]" << std::endl;
+        }
+    unsigned int num_doppler_bins = 2 * search.doppler_max / search.doppler_step + 1;
+
+    // the whole capture in memory
+    std::ifstream capture_file("tmp_capture.dat", std::ios::binary | std::ios::ate);
+    if (!capture_file.is_open())
+        {
+            std::cout << "Unable to open tmp_capture.dat" << std::endl;
+            return;
+        }
+    search.capture.resize(capture_file.tellg() / sizeof(gr_complex));
+    capture_file.seekg(0, std::ios::beg);
+    capture_file.read(reinterpret_cast<char*>(search.capture.data()), search.capture.size() * sizeof(gr_complex));
+    // the dwells and the block of the fine Doppler estimation
+    unsigned int num_blocks = search.capture.size() / search.fft_size;
+    if (num_blocks < 2)
+        {
+            std::cout << "The capture is too short for the parallel search" << std::endl;
+            return;
+        }
+    if (search.max_dwells + 1 > num_blocks)
+        {
+            search.max_dwells = num_blocks - 1;
+            std::cout << "The capture only holds " << search.max_dwells << " dwells" << std::endl;
+        }
+
+    search.grid = Acquisition_Cache::doppler_wipeoff_grid(search.fs_in, search.freq + search.doppler_center,
+            search.doppler_max, search.doppler_step, num_doppler_bins, search.fft_size);
+
+    Acquisition_Thread_Pool::set_num_threads(FLAGS_threads > 0 ? FLAGS_threads : boost::thread::hardware_concurrency());
+    Acquisition_Thread_Pool& pool = Acquisition_Thread_Pool::instance();
+    for (unsigned int PRN = 1; PRN < 33; PRN++)
+        {
+            pool.submit(boost::bind(&parallel_search_prn, search_ptr, PRN));
+        }
+
+    double current_TOW = 0;
+    if (global_gps_ephemeris_map.size() > 0)
+        {
+            current_TOW = global_gps_ephemeris_map.get_map_copy().begin()->second.d_TOW;
+        }
+    double lat_deg = configuration->property("GNSS-SDR.init_latitude_deg", 41.0);
+    double lon_deg = configuration->property("GNSS-SDR.init_longitude_deg", 2.0);
+    double altitude_m = configuration->property("GNSS-SDR.init_altitude_m", 100);
+
+    std::cout << "Searching for GPS Satellites in L1 band..." << std::endl;
+    double sum_f_if_Hz = 0;
+    double sum_osc_err_ppm = 0;
+    int n_elements = 0;
+    for (unsigned int n = 0; n < 32; n++)
+        {
+            Parallel_Search_Result result;
+            search.results.wait_and_pop(result);
+            if (!result.detected)
+                {
+                    continue;
+                }
+            doppler_measurements_map.insert(std::pair<int,double>(result.PRN, result.doppler_hz));
+            std::cout << std::setiosflags(std::ios::fixed) << std::setprecision(2)
+                      << "  PRN " << result.PRN << " Doppler " << result.doppler_hz << " [Hz]";
+            if (global_gps_ephemeris_map.size() > 0)
+                {
+                    try
+                    {
+                            double doppler_estimated_hz = front_end_cal.estimate_doppler_from_eph(result.PRN, current_TOW, lat_deg, lon_deg, altitude_m);
+                            double estimated_fs_Hz, estimated_f_if_Hz, f_osc_err_ppm;
+                            front_end_cal.GPS_L1_front_end_model_E4000(doppler_estimated_hz, result.doppler_hz, search.fs_in, &estimated_fs_Hz, &estimated_f_if_Hz, &f_osc_err_ppm);
+                            sum_f_if_Hz += estimated_f_if_Hz;
+                            sum_osc_err_ppm += f_osc_err_ppm;
+                            n_elements++;
+                            std::cout << ", predicted " << doppler_estimated_hz << " [Hz]. Estimation with "
+                                      << n_elements << " satellites: IF bias " << sum_f_if_Hz / n_elements
+                                      << " [Hz], oscillator error " << sum_osc_err_ppm / n_elements << " [ppm]";
+                    }
+                    catch(const std::logic_error & e)
+                    {
+                            std::cout << " (logic error: " << e.what() << ")";
+                    }
+                    catch(const boost::lock_error & e)
+                    {
+                            std::cout << " (exception caught while reading ephemeris)";
+                    }
+                    catch(int ex)
+                    {
+                            std::cout << " (Eph not found)";
+                    }
+                }
+            std::cout << std::endl;
+        }
+}
+
+
 static time_t utc_time(int week, long tow) {
     time_t t;
 
@@ -381,118 +619,127 @@ int main(int argc, char** argv)
             std::cout << "Exception caught while capturing samples (too few args)" << std::endl;
     }
 
-    // 4. Setup GNU Radio flowgraph (file_source -> Acquisition_10m)
-    gr::top_block_sptr top_block;
-    top_block = gr::make_top_block("Acquisition test");
-
-    // Satellite signal definition
-    gnss_synchro = new Gnss_Synchro();
-    gnss_synchro->Channel_ID = 0;
-    gnss_synchro->System = 'G';
-    std::string signal = "1C";
-    signal.copy(gnss_synchro->Signal, 2, 0);
-    gnss_synchro->PRN = 1;
-
-    long fs_in_ = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
+    std::map<int,double> doppler_measurements_map;
 
-    GNSSBlockFactory block_factory;
-    acquisition = new GpsL1CaPcpsAcquisitionFineDoppler(configuration.get(), "Acquisition", 1, 1);
+    // record startup time
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    long long int begin = tv.tv_sec * 1000000 + tv.tv_usec;
 
-    acquisition->set_channel(1);
-    acquisition->set_gnss_synchro(gnss_synchro);
-    acquisition->set_threshold(configuration->property("Acquisition.threshold", 0.0));
-    acquisition->set_doppler_max(configuration->property("Acquisition.doppler_max", 10000));
-    acquisition->set_doppler_step(configuration->property("Acquisition.doppler_step", 250));
+    if (FLAGS_parallel)
+        {
+            // 4-5. Search all the satellites at once in the capture loaded in memory
+            parallel_search(configuration, front_end_cal, doppler_measurements_map);
+        }
+    else
+        {
+            // 4. Setup GNU Radio flowgraph (file_source -> Acquisition_10m)
+            gr::top_block_sptr top_block;
+            top_block = gr::make_top_block("Acquisition test");
 
-    gr::block_sptr source;
-    source = gr::blocks::file_source::make(sizeof(gr_complex), "tmp_capture.dat");
+            // Satellite signal definition
+            gnss_synchro = new Gnss_Synchro();
+            gnss_synchro->Channel_ID = 0;
+            gnss_synchro->System = 'G';
+            std::string signal = "1C";
+            signal.copy(gnss_synchro->Signal, 2, 0);
+            gnss_synchro->PRN = 1;
 
-    boost::shared_ptr<FrontEndCal_msg_rx> msg_rx = FrontEndCal_msg_rx_make();
+            long fs_in_ = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
 
-    //gr_basic_block_sptr head = gr_make_head(sizeof(gr_complex), nsamples);
-    //gr_head_sptr head_sptr = boost::dynamic_pointer_cast<gr_head>(head);
-    //head_sptr->set_length(nsamples);
-    //head_sptr->reset();
+            GNSSBlockFactory block_factory;
+            acquisition = new GpsL1CaPcpsAcquisitionFineDoppler(configuration.get(), "Acquisition", 1, 1);
 
-    try
-    {
-            acquisition->connect(top_block);
-            top_block->connect(source, 0, acquisition->get_left_block(), 0);
-            top_block->msg_connect(acquisition->get_right_block(), pmt::mp("events"), msg_rx,pmt::mp("events"));
-    }
-    catch(const std::exception & e)
-    {
-            std::cout << "Failure connecting the GNU Radio blocks: " << e.what() << std::endl;
-    }
-
-    // 5. Run the flowgraph
-    // Get visible GPS satellites (positive acquisitions with Doppler measurements)
-    // Compute Doppler estimations
-
-    //todo: Fix the front-end cal to support new channel internal message system (no more external queues)
-    std::map<int,double> doppler_measurements_map;
-    std::map<int,double> cn0_measurements_map;
+            acquisition->set_channel(1);
+            acquisition->set_gnss_synchro(gnss_synchro);
+            acquisition->set_threshold(configuration->property("Acquisition.threshold", 0.0));
+            acquisition->set_doppler_max(configuration->property("Acquisition.doppler_max", 10000));
+            acquisition->set_doppler_step(configuration->property("Acquisition.doppler_step", 250));
 
-    boost::thread ch_thread;
+            gr::block_sptr source;
+            source = gr::blocks::file_source::make(sizeof(gr_complex), "tmp_capture.dat");
 
-    // record startup time
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    long long int begin = tv.tv_sec * 1000000 + tv.tv_usec;
+            boost::shared_ptr<FrontEndCal_msg_rx> msg_rx = FrontEndCal_msg_rx_make();
 
-    bool start_msg = true;
+            //gr_basic_block_sptr head = gr_make_head(sizeof(gr_complex), nsamples);
+            //gr_head_sptr head_sptr = boost::dynamic_pointer_cast<gr_head>(head);
+            //head_sptr->set_length(nsamples);
+            //head_sptr->reset();
 
-    for (unsigned int PRN=1; PRN<33; PRN++)
-        {
-            gnss_synchro->PRN = PRN;
-            acquisition->set_gnss_synchro(gnss_synchro);
-            acquisition->init();
-            acquisition->reset();
-            stop = false;
             try
             {
-                    ch_thread = boost::thread(wait_message);
+                    acquisition->connect(top_block);
+                    top_block->connect(source, 0, acquisition->get_left_block(), 0);
+                    top_block->msg_connect(acquisition->get_right_block(), pmt::mp("events"), msg_rx,pmt::mp("events"));
             }
-            catch(const boost::thread_resource_error & e)
+            catch(const std::exception & e)
             {
-                    LOG(INFO) << "Exception caught (thread resource error)";
+                    std::cout << "Failure connecting the GNU Radio blocks: " << e.what() << std::endl;
             }
-            top_block->run();
-            if (start_msg == true)
-                {
-                    std::cout << "Searching for GPS Satellites in L1 band..." << std::endl;
-                    std::cout << "[";
-                    start_msg = false;
-                }
-            if (gnss_sync_vector.size()>0)
+
+            // 5. Run the flowgraph
+            // Get visible GPS satellites (positive acquisitions with Doppler measurements)
+            // Compute Doppler estimations
+
+            //todo: Fix the front-end cal to support new channel internal message system (no more external queues)
+            std::map<int,double> cn0_measurements_map;
+
+            boost::thread ch_thread;
+
+            bool start_msg = true;
+
+            for (unsigned int PRN=1; PRN<33; PRN++)
                 {
-                    std::cout << " " << PRN << " ";
-                    double doppler_measurement_hz = 0;
-                    for (std::vector<Gnss_Synchro>::iterator it = gnss_sync_vector.begin() ; it != gnss_sync_vector.end(); ++it)
+                    gnss_synchro->PRN = PRN;
+                    acquisition->set_gnss_synchro(gnss_synchro);
+                    acquisition->init();
+                    acquisition->reset();
+                    stop = false;
+                    try
+                    {
+                            ch_thread = boost::thread(wait_message);
+                    }
+                    catch(const boost::thread_resource_error & e)
+                    {
+                            LOG(INFO) << "Exception caught (thread resource error)";
+                    }
+                    top_block->run();
+                    if (start_msg == true)
                         {
-                            doppler_measurement_hz += (*it).Acq_doppler_hz;
+                            std::cout << "Searching for GPS Satellites in L1 band..." << std::endl;
+                            std::cout << "[";
+                            start_msg = false;
                         }
-                    doppler_measurement_hz = doppler_measurement_hz/gnss_sync_vector.size();
-                    doppler_measurements_map.insert(std::pair<int,double>(PRN, doppler_measurement_hz));
-                }
-            else
-                {
-                    std::cout << " . ";
+                    if (gnss_sync_vector.size()>0)
+                        {
+                            std::cout << " " << PRN << " ";
+                            double doppler_measurement_hz = 0;
+                            for (std::vector<Gnss_Synchro>::iterator it = gnss_sync_vector.begin() ; it != gnss_sync_vector.end(); ++it)
+                                {
+                                    doppler_measurement_hz += (*it).Acq_doppler_hz;
+                                }
+                            doppler_measurement_hz = doppler_measurement_hz/gnss_sync_vector.size();
+                            doppler_measurements_map.insert(std::pair<int,double>(PRN, doppler_measurement_hz));
+                        }
+                    else
+                        {
+                            std::cout << " . ";
+                        }
+                    channel_internal_queue.push(3);
+                    try
+                    {
+                            ch_thread.join();
+                    }
+                    catch(const boost::thread_resource_error & e)
+                    {
+                            LOG(INFO) << "Exception caught while joining threads.";
+                    }
+                    gnss_sync_vector.clear();
+                    boost::dynamic_pointer_cast<gr::blocks::file_source>(source)->seek(0, 0);
+                    std::cout.flush();
                 }
-            channel_internal_queue.push(3);
-            try
-            {
-                    ch_thread.join();
-            }
-            catch(const boost::thread_resource_error & e)
-            {
-                    LOG(INFO) << "Exception caught while joining threads.";
-            }
-            gnss_sync_vector.clear();
-            boost::dynamic_pointer_cast<gr::blocks::file_source>(source)->seek(0, 0);
-            std::cout.flush();
+            std::cout << "]" << std::endl;
         }
-    std::cout << "]" << std::endl;
 
     // report the elapsed time
     gettimeofday(&tv, NULL);
@@ -0,0 +1,140 @@
+/*!
+ * \file main.cc
+ * \brief Main file of iq-streamer, which streams the samples of a front end
+ * to a remote receiver
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * The signal source of --config_file (role SignalSource), whose output
+ * must be gr_complex or cshort samples, is quantized to --bits bits per
+ * I or Q value, optionally compressed (--compress, 8 and 16 bits), and
+ * sent in blocks of --block_samples samples (see Iq_Stream_Header). With
+ * --protocol=tcp the streamer listens on --address:--port for the
+ * receiver to connect; with --protocol=udp it sends the blocks to
+ * --address:--port. The receiver reads them with an
+ * Iq_Stream_Signal_Source.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <csignal>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <boost/thread/thread.hpp>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gnuradio/msg_queue.h>
+#include <gnuradio/top_block.h>
+#include "file_configuration.h"
+#include "gnss_block_factory.h"
+#include "iq_stream_sink.h"
+
+using google::LogMessage;
+
+DEFINE_string(config_file, "", "Configuration of the signal source (role SignalSource) of the front end");
+DEFINE_string(protocol, "tcp", "tcp: wait for the receiver to connect, udp: send to the receiver");
+DEFINE_string(address, "0.0.0.0", "Address to listen on (tcp) or of the receiver (udp)");
+DEFINE_int32(port, 1235, "Port to listen on (tcp) or of the receiver (udp)");
+DEFINE_int32(bits, 8, "Bits per I or Q value: 2, 4, 8 or 16");
+DEFINE_bool(compress, false, "Lossless compression of the 8 and 16 bit values");
+DEFINE_int32(block_samples, 4096, "Samples per block");
+DEFINE_int32(stats_interval_s, 60, "Interval between two logs of the number of blocks sent [s], 0 for none");
+
+namespace
+{
+volatile std::sig_atomic_t stop_requested = 0;
+
+void request_stop(int signal_number __attribute__((unused)))
+{
+    stop_requested = 1;
+}
+}
+
+
+int main(int argc, char** argv)
+{
+    const std::string intro_help(
+            std::string("\nI/Q streamer of GNSS-SDR, to process the samples of a front end on a remote receiver\n")
+    +
+    "Copyright (C) 2010-2015 (see AUTHORS file for a list of contributors)\n"
+    +
+    "This program comes with ABSOLUTELY NO WARRANTY;\n"
+    +
+    "See COPYING file to see a copy of the General Public License\n \n");
+    google::SetUsageMessage(intro_help);
+    google::ParseCommandLineFlags(&argc, &argv, true);
+    google::InitGoogleLogging(argv[0]);
+
+    if (FLAGS_config_file.empty() || FLAGS_port <= 0 || FLAGS_port > 65535 || FLAGS_block_samples <= 0)
+        {
+            std::cout << "--config_file is required, --port and --block_samples must be valid" << std::endl;
+            return 1;
+        }
+    std::shared_ptr<ConfigurationInterface> configuration = std::make_shared<FileConfiguration>(FLAGS_config_file);
+    double fs = configuration->property("SignalSource.sampling_frequency", 2048000.0);
+
+    GNSSBlockFactory block_factory;
+    boost::shared_ptr<gr::msg_queue> queue = gr::msg_queue::make(0);
+    gr::top_block_sptr top_block = gr::make_top_block("I/Q streamer");
+    std::shared_ptr<GNSSBlockInterface> source;
+    iq_stream_sink_sptr sink;
+    try
+    {
+            source = block_factory.GetSignalSource(configuration, queue);
+            sink = make_iq_stream_sink(FLAGS_protocol, FLAGS_address, FLAGS_port, source->item_size(),
+                    FLAGS_bits, FLAGS_compress, FLAGS_block_samples, fs);
+            source->connect(top_block);
+            top_block->connect(source->get_right_block(), 0, sink, 0);
+    }
+    catch(const std::exception & e)
+    {
+            std::cout << "Failure connecting the signal source: " << e.what() << std::endl;
+            return 1;
+    }
+
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+    top_block->start();
+    std::cout << "I/Q streamer sending " << FLAGS_bits << " bit samples at " << fs << " samples/s over "
+              << FLAGS_protocol << " " << FLAGS_address << ":" << FLAGS_port << std::endl;
+
+    int elapsed_s = 0;
+    // a message in the queue is the end of the samples of the source
+    for (int ticks = 1; !stop_requested && queue->count() == 0; ticks++)
+        {
+            boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+            if (ticks % 10 == 0 && FLAGS_stats_interval_s > 0 && ++elapsed_s % FLAGS_stats_interval_s == 0)
+                {
+                    LOG(INFO) << sink->sent_blocks() << " blocks sent, " << sink->dropped_blocks() << " dropped";
+                }
+        }
+    top_block->stop();
+    top_block->wait();
+    std::cout << "I/Q streamer stopped after " << sink->sent_blocks() << " blocks, "
+              << sink->dropped_blocks() << " dropped" << std::endl;
+    return 0;
+}
@@ -30,166 +30,32 @@ function [GNSS_tracking] = gps_l1_ca_dll_pll_read_tracking_dump (filename, count
 
   %% usage: gps_l1_ca_dll_pll_read_tracking_dump (filename, [count])
   %%
-  %% open GNSS-SDR tracking binary log file .dat and return the contents
+  %% open GNSS-SDR tracking binary log file .dat and return the contents,
+  %% one member per field of its header (see read_dump.m). The fields are
+  %% also given the names of the previous readers, by position, for the
+  %% plotting scripts: [VE,] E, P, L, prompt_I, prompt_Q, PRN_start_sample,
+  %% acc_carrier_phase_rad, carrier_doppler_hz, code_freq_hz, carr_error,
+  %% carr_nco, code_error, code_nco, CN0_SNV_dB_Hz, carrier_lock_test, var1,
+  %% var2 [, delta, RT, ELP, MD]. The dumps of every tracking block are
+  %% read the same way.
   %%
 
-  m = nargchk (1,2,nargin);
-  num_float_vars=15;
-  num_double_vars=0;
-  num_int_vars=1;
-  double_size_bytes=8;
-  float_size_bytes=4;
-  int_size_bytes=4;
-  skip_bytes_each_read=float_size_bytes*num_float_vars+double_size_bytes*num_double_vars + int_size_bytes*num_int_vars;
-  bytes_shift=0;
-  if (m)
-    usage (m);
-  end
-
   if (nargin < 2)
     count = Inf;
   end
-    %loops_counter = fread (f, count, 'uint32',4*12);
-  f = fopen (filename, 'rb');
-  if (f < 0)
-  else
-    v0 = fread (f, count, 'int',skip_bytes_each_read);
-        bytes_shift=bytes_shift+int_size_bytes;
-    fseek(f,bytes_shift,'bof'); % move to next interleaved float
-    v1 = fread (f, count, 'float',skip_bytes_each_read);
-        bytes_shift=bytes_shift+float_size_bytes;
-    fseek(f,bytes_shift,'bof'); % move to next interleaved float
-    v2 = fread (f, count, 'float',skip_bytes_each_read);
-        bytes_shift=bytes_shift+float_size_bytes;
-    fseek(f,bytes_shift,'bof'); % move to next interleaved float
-    v3 = fread (f, count, 'float',skip_bytes_each_read);
-        bytes_shift=bytes_shift+float_size_bytes;
-    fseek(f,bytes_shift,'bof'); % move to next interleaved float
-    v4 = fread (f, count, 'float',skip_bytes_each_read);
-        bytes_shift=bytes_shift+float_size_bytes;
-    fseek(f,bytes_shift,'bof'); % move to next interleaved float
-    v5 = fread (f, count, 'float',skip_bytes_each_read);
-        bytes_shift=bytes_shift+float_size_bytes;
-    fseek(f,bytes_shift,'bof'); % move to next interleaved float
-    %v6 = fread (f, count, '%uint32',skip_bytes_each_read);
-        %bytes_shift=bytes_shift+float_size_bytes;
-        %fseek(f,bytes_shift,'bof'); % move to next interleaved float
-    v7 = fread (f, count, 'float',skip_bytes_each_read);
-        bytes_shift=bytes_shift+float_size_bytes;
-    fseek(f,bytes_shift,'bof'); % move to next interleaved float
-    v8 = fread (f, count, 'float',skip_bytes_each_read);
-        bytes_shift=bytes_shift+float_size_bytes;
-    fseek(f,bytes_shift,'bof'); % move to next interleaved float
-    v9 = fread (f, count, 'float',skip_bytes_each_read);
-        bytes_shift=bytes_shift+float_size_bytes;
-    fseek(f,bytes_shift,'bof'); % move to next interleaved float
-    v10 = fread (f, count, 'float',skip_bytes_each_read);
-        bytes_shift=bytes_shift+float_size_bytes;
-    fseek(f,bytes_shift,'bof'); % move to next interleaved float
-    v11 = fread (f, count, 'float',skip_bytes_each_read);
-        bytes_shift=bytes_shift+float_size_bytes;
-    fseek(f,bytes_shift,'bof'); % move to next interleaved float
-    v12 = fread (f, count, 'float',skip_bytes_each_read);
-        bytes_shift=bytes_shift+float_size_bytes;
-    fseek(f,bytes_shift,'bof'); % move to next interleaved float
-    v13 = fread (f, count, 'float',skip_bytes_each_read);
-        bytes_shift=bytes_shift+float_size_bytes;
-    fseek(f,bytes_shift,'bof'); % move to next interleaved float
-    v14 = fread (f, count, 'float',skip_bytes_each_read);
-        bytes_shift=bytes_shift+float_size_bytes;
-    fseek(f,bytes_shift,'bof'); % move to next interleaved float
-    v15 = fread (f, count, 'float',skip_bytes_each_read);
-            bytes_shift=bytes_shift+float_size_bytes;
-    fseek(f,bytes_shift,'bof'); % move to next interleaved float
-    v16 = fread (f, count, 'float',skip_bytes_each_read);
-            bytes_shift=bytes_shift+float_size_bytes;
-  %  fseek(f,bytes_shift,'bof'); % move to next interleaved float
-  %  v17 = fread (f, count, 'float64',skip_bytes_each_read-double_size_bytes);
-
-    fclose (f);
-    
-    %%%%%%%% output vars %%%%%%%%
-    
-% 				// EPR
-% 				d_dump_file.write((char*)&tmp_E, sizeof(float));
-% 				d_dump_file.write((char*)&tmp_P, sizeof(float));
-% 				d_dump_file.write((char*)&tmp_L, sizeof(float));
-% 				// PROMPT I and Q (to analyze navigation symbols)
-% 				d_dump_file.write((char*)&prompt_I, sizeof(float));
-% 				d_dump_file.write((char*)&prompt_Q, sizeof(float));
-% 				// PRN start sample stamp
-% 				//tmp_float=(float)d_sample_counter;
-% 				d_dump_file.write((char*)&d_sample_counter, sizeof(unsigned long int));
-% 				// accumulated carrier phase
-% 				d_dump_file.write((char*)&d_acc_carrier_phase_rad, sizeof(float));
-% 
-% 				// carrier and code frequency
-% 				d_dump_file.write((char*)&d_carrier_doppler_hz, sizeof(float));
-% 				d_dump_file.write((char*)&d_code_freq_hz, sizeof(float));
-% 
-% 				//PLL commands
-% 				d_dump_file.write((char*)&carr_error, sizeof(float));
-% 				d_dump_file.write((char*)&carr_nco, sizeof(float));
-% 
-% 				//DLL commands
-% 				d_dump_file.write((char*)&code_error, sizeof(float));
-% 				d_dump_file.write((char*)&code_nco, sizeof(float));
-% 
-% 				// CN0 and carrier lock test
-% 				d_dump_file.write((char*)&d_CN0_SNV_dB_Hz, sizeof(float));
-% 				d_dump_file.write((char*)&d_carrier_lock_test, sizeof(float));
-% 
-% 				// AUX vars (for debug purposes)
-% 				tmp_float=0;
-% 				d_dump_file.write((char*)&tmp_float, sizeof(float));
-% 				d_dump_file.write((char*)&d_sample_counter_seconds, sizeof(double));
-                
-%    E=v1;
-%    P=v2;
-%    L=v3;
-%    prompt_I=v4;
-%    prompt_Q=v5;
-%    PRN_start_sample=v6;
-%    acc_carrier_phase_rad=v7;
-%    carrier_doppler_hz=v8;
-%    code_freq_hz=v9;
-%    carr_error=v10;
-%    carr_nco=v11;
-%    code_error=v12;
-%    code_nco=v13;
-%    CN0_SNV_dB_Hz=v14;
-%    carrier_lock_test=v15;
-%    var1=v16;
-%    var2=v17;
-%    var3=v18;
-    
-%    GNSS_tracking.E=E;
-%    GNSS_tracking.P=P;
-%    GNSS_tracking.L=L;
-%    GNSS_tracking.prompt_I=prompt_I;
-%    GNSS_tracking.prompt_Q=prompt_Q;
-%    GNSS_tracking.PRN_start_sample=PRN_start_sample;
-%    GNSS_tracking.acc_carrier_phase_rad=acc_carrier_phase_rad;
-%    GNSS_tracking.carrier_doppler_hz=carrier_doppler_hz;
-%    GNSS_tracking.code_freq_hz=code_freq_hz;
-%    GNSS_tracking.carr_error=carr_error;
-%    GNSS_tracking.carr_nco=carr_nco;
-%    GNSS_tracking.code_error=code_error;
-%    GNSS_tracking.code_nco=code_nco;
-%    GNSS_tracking.CN0_SNV_dB_Hz=CN0_SNV_dB_Hz;
-%    GNSS_tracking.carrier_lock_test=carrier_lock_test;
-%    GNSS_tracking.var1=var1;
-%    GNSS_tracking.var2=var2;
-%    GNSS_tracking.var3=var3;
-
-    delta = v18;
-    RT = v19;
-    ELP = v20;
-    MD = v21;
-    
-    GNSS_tracking.delta=delta;
-    GNSS_tracking.RT=RT;
-    GNSS_tracking.ELP=ELP;
-    GNSS_tracking.MD=MD;
+  [GNSS_tracking, schema] = read_dump (filename, count);
+  if (isempty (GNSS_tracking))
+    return;
+  end
+  names = {'E', 'P', 'L', 'prompt_I', 'prompt_Q', 'PRN_start_sample', ...
+      'acc_carrier_phase_rad', 'carrier_doppler_hz', 'code_freq_hz', ...
+      'carr_error', 'carr_nco', 'code_error', 'code_nco', ...
+      'CN0_SNV_dB_Hz', 'carrier_lock_test', 'var1', 'var2', ...
+      'delta', 'RT', 'ELP', 'MD'};
+  if (strcmp (schema.fields(1).name, 'abs_VE'))
+    names = [{'VE'}, names(1:3), {'VL'}, names(4:end)];
+  end
+  for n = 1:min (numel (names), numel (schema.fields))
+    GNSS_tracking.(names{n}) = GNSS_tracking.(schema.fields(n).name);
   end
-  
+end
@@ -0,0 +1,42 @@
+% /*!
+%  * \file gps_l1_ca_dll_pll_read_tracking_dump_mmap.m
+%  * \brief Map a GNSS-SDR GPS L1 C/A tracking dump binary file into MATLAB.
+%  * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+%  * -------------------------------------------------------------------------
+%  *
+%  * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+%  *
+%  * GNSS-SDR is a software defined Global Navigation
+%  *          Satellite Systems receiver
+%  *
+%  * This file is part of GNSS-SDR.
+%  *
+%  * GNSS-SDR is free software: you can redistribute it and/or modify
+%  * it under the terms of the GNU General Public License as published by
+%  * the Free Software Foundation, either version 3 of the License, or
+%  * at your option) any later version.
+%  *
+%  * GNSS-SDR is distributed in the hope that it will be useful,
+%  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+%  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%  * GNU General Public License for more details.
+%  *
+%  * You should have received a copy of the GNU General Public License
+%  * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+%  *
+%  * -------------------------------------------------------------------------
+%  */
+function [GNSS_tracking] = gps_l1_ca_dll_pll_read_tracking_dump_mmap (filename, count)
+
+  %% usage: gps_l1_ca_dll_pll_read_tracking_dump_mmap (filename, [count])
+  %%
+  %% read GNSS-SDR tracking binary log file .dat and return the contents.
+  %% read_dump reads all the records in one pass, this is
+  %% gps_l1_ca_dll_pll_read_tracking_dump.
+  %%
+
+  if (nargin < 2)
+    count = Inf;
+  end
+  GNSS_tracking = gps_l1_ca_dll_pll_read_tracking_dump (filename, count);
+end
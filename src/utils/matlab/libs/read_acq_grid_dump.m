@@ -0,0 +1,72 @@
+% /*!
+%  * \file read_acq_grid_dump.m
+%  * \brief Read a GNSS-SDR acquisition grid dump file.
+%  * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+%  * -------------------------------------------------------------------------
+%  *
+%  * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+%  *
+%  * GNSS-SDR is a software defined Global Navigation
+%  *          Satellite Systems receiver
+%  *
+%  * This file is part of GNSS-SDR.
+%  *
+%  * GNSS-SDR is free software: you can redistribute it and/or modify
+%  * it under the terms of the GNU General Public License as published by
+%  * the Free Software Foundation, either version 3 of the License, or
+%  * at your option) any later version.
+%  *
+%  * GNSS-SDR is distributed in the hope that it will be useful,
+%  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+%  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%  * GNU General Public License for more details.
+%  *
+%  * You should have received a copy of the GNU General Public License
+%  * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+%  *
+%  * -------------------------------------------------------------------------
+%  */
+function [grid, header] = read_acq_grid_dump (filename)
+
+  %% usage: [grid, header] = read_acq_grid_dump (filename)
+  %%
+  %% read one search grid written by an acquisition block with dump=true.
+  %% The file is an Acquisition_Grid_Header
+  %% (src/algorithms/acquisition/gnuradio_blocks/acquisition_grid_dump.h),
+  %% little endian, followed by the float32 squared magnitudes of the
+  %% grid. grid has one row per Doppler line and one column per code
+  %% phase; header.doppler_hz holds the Doppler of each row.
+  %%
+
+  grid = [];
+  header = [];
+  f = fopen (filename, 'rb', 'ieee-le');
+  if (f < 0)
+    disp 'File not found';
+    return;
+  end
+
+  magic = fread (f, [1 8], 'char=>char');
+  if (~strcmp (magic, 'GSACQGRD'))
+    fclose (f);
+    disp 'Not an acquisition grid dump';
+    return;
+  end
+  header.version = fread (f, 1, 'uint32');
+  header.header_bytes = fread (f, 1, 'uint32');
+  header.sample_stamp = fread (f, 1, 'uint64');
+  header.fs_in = fread (f, 1, 'int64');
+  header.doppler_min_hz = fread (f, 1, 'int32');
+  header.doppler_step_hz = fread (f, 1, 'uint32');
+  header.num_doppler_bins = fread (f, 1, 'uint32');
+  header.line_length = fread (f, 1, 'uint32');
+  header.PRN = fread (f, 1, 'uint32');
+  header.channel = fread (f, 1, 'uint32');
+  header.system = fread (f, 1, 'char=>char');
+  header.signal = deblank (fread (f, [1 3], 'char=>char'));
+  header.lines_searched = fread (f, 1, 'uint32');
+  header.doppler_hz = header.doppler_min_hz + (0:header.num_doppler_bins - 1) * header.doppler_step_hz;
+
+  fseek (f, header.header_bytes, 'bof');
+  grid = fread (f, [header.line_length header.num_doppler_bins], 'single')';
+  fclose (f);
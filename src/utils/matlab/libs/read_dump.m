@@ -0,0 +1,93 @@
+% /*!
+%  * \file read_dump.m
+%  * \brief Read a GNSS-SDR block dump file, described by its own header.
+%  * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+%  * -------------------------------------------------------------------------
+%  *
+%  * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+%  *
+%  * GNSS-SDR is a software defined Global Navigation
+%  *          Satellite Systems receiver
+%  *
+%  * This file is part of GNSS-SDR.
+%  *
+%  * GNSS-SDR is free software: you can redistribute it and/or modify
+%  * it under the terms of the GNU General Public License as published by
+%  * the Free Software Foundation, either version 3 of the License, or
+%  * at your option) any later version.
+%  *
+%  * GNSS-SDR is distributed in the hope that it will be useful,
+%  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+%  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%  * GNU General Public License for more details.
+%  *
+%  * You should have received a copy of the GNU General Public License
+%  * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+%  *
+%  * -------------------------------------------------------------------------
+%  */
+function [dump, schema] = read_dump (filename, count)
+
+  %% usage: [dump, schema] = read_dump (filename, [count])
+  %%
+  %% read a dump file written by a block of GNSS-SDR with dump=true. The
+  %% file starts with a text header that lists the fields of its records
+  %% (see src/algorithms/libs/dump_schema.h), then the records, packed,
+  %% little endian. dump has one member per field, with one row per record
+  %% and one column per value of the field. schema.name is the name of the
+  %% block, schema.fields the fields in the order of the record.
+  %%
+
+  if (nargin < 2)
+    count = Inf;
+  end
+  dump = [];
+  schema = [];
+
+  f = fopen (filename, 'rb', 'ieee-le');
+  if (f < 0)
+    disp 'File not found';
+    return;
+  end
+  if (~strcmp (fgetl (f), 'GNSS-SDR dump 1'))
+    fclose (f);
+    disp 'Not a GNSS-SDR dump file with a header';
+    return;
+  end
+  schema.fields = struct ('name', {}, 'type', {}, 'count', {}, 'offset', {});
+  line = fgetl (f);
+  while (ischar (line) && ~strcmp (line, 'end'))
+    words = strsplit (strtrim (line), ' ');
+    switch (words{1})
+      case 'header_bytes'
+        header_bytes = str2double (words{2});
+      case 'name'
+        schema.name = words{2};
+      case 'record_bytes'
+        record_bytes = str2double (words{2});
+      case 'field'
+        schema.fields(end + 1) = struct ('name', words{2}, 'type', words{3}, ...
+            'count', str2double (words{4}), 'offset', str2double (words{5}));
+    end
+    line = fgetl (f);
+  end
+
+  % whole records only: the last one of a file that was not closed may be cut
+  fseek (f, 0, 'eof');
+  num_records = floor ((ftell (f) - header_bytes) / record_bytes);
+  num_records = min (num_records, count);
+  fseek (f, header_bytes, 'bof');
+  records = fread (f, [record_bytes num_records], 'uint8=>uint8');
+  fclose (f);
+
+  types = struct ('int8', 'int8', 'uint8', 'uint8', 'int16', 'int16', 'uint16', 'uint16', ...
+      'int32', 'int32', 'uint32', 'uint32', 'int64', 'int64', 'uint64', 'uint64', ...
+      'float32', 'single', 'float64', 'double');
+  for n = 1:numel (schema.fields)
+    field = schema.fields(n);
+    matlab_type = types.(field.type);
+    bytes = numel (typecast (zeros (1, 1, matlab_type), 'uint8'));
+    values = typecast (reshape (records(field.offset + 1:field.offset + field.count * bytes, :), 1, []), matlab_type);
+    dump.(field.name) = double (reshape (values, field.count, num_records)');
+  end
+end
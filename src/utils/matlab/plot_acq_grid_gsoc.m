@@ -33,35 +33,21 @@
 %  * -------------------------------------------------------------------------
 %  */ 
 
-function plot_acq_grid_gsoc(sat)
+function plot_acq_grid_gsoc(sat, search)
 
-file=['test_statistics_E_1C_sat_' num2str(sat) '_doppler_0.dat'];
+% grid of the given search of the satellite, as named by Acquisition_Grid_Dump
+if (nargin < 2)
+    search = 0;
+end
+file=['test_statistics_E_1C_sat_' num2str(sat) '_ch_0_' num2str(search) '.dat'];
 
-sampling_freq_Hz=4E6
-Doppler_max_Hz = 9875
-Doppler_min_Hz = -10000
-Doppler_step_Hz = 125
+[acq_grid, header] = read_acq_grid_dump(file);
 
+sampling_freq_Hz = header.fs_in
+Doppler_step_Hz = header.doppler_step_hz
+Doppler_axes = header.doppler_hz;
 
-% read files
-
-x=read_complex_binary (file);
-
-l_y=length(x);
-
-Doppler_axes=Doppler_min_Hz:Doppler_step_Hz:Doppler_max_Hz;
-
-l_x=length(Doppler_axes);
-
-acq_grid = zeros(l_x,l_y);
-
-index=0;
-
-for k=Doppler_min_Hz:Doppler_step_Hz:Doppler_max_Hz
-    index=index+1;
-    filename=['test_statistics_E_1C_sat_' num2str(sat) '_doppler_' num2str(k) '.dat'];
-    acq_grid(index,:)=abs(read_complex_binary (filename));
- end
+l_y = header.line_length;
 
 maximum_correlation_peak = max(max(acq_grid))
 
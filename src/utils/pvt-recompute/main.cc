@@ -0,0 +1,264 @@
+/*!
+ * \file main.cc
+ * \brief Main file of pvt-recompute, which solves again the positions of a PVT
+ * log from its observables and a RINEX navigation file, in parallel
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef PVT_RECOMPUTE_VERSION
+#define PVT_RECOMPUTE_VERSION "0.0.1"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include "gnss_synchro.h"
+#include "gps_l1_ca_ls_pvt.h"
+#include "pvt_log.h"
+#include "rinex_nav_reader.h"
+
+using google::LogMessage;
+
+DEFINE_string(pvt_log, "", "PVT log (PVT.pvt_log_filename) with the observables of the fixes");
+DEFINE_string(rinex_nav, "", "RINEX GPS navigation file of the period of the log");
+DEFINE_string(output, "", "PVT log to write, with the new solutions and the observables");
+DEFINE_string(kml, "", "If not empty, KML track of the new solutions");
+DEFINE_string(geojson, "", "If not empty, GeoJSON track of the new solutions");
+DEFINE_string(nmea, "", "If not empty, NMEA sentences of the new solutions");
+DEFINE_int32(threads, 0, "Threads solving the epochs, 0 for one per core");
+DEFINE_bool(iono_correction, false, "Correct the pseudoranges with the ionospheric model of the navigation file");
+
+
+namespace
+{
+    // the observables of a fix
+    struct Epoch
+    {
+        double rx_time;
+        std::vector<Pvt_Log_Observable> observables;
+        bool valid;
+        Pvt_Log_Solution solution;
+    };
+
+    /*
+     * Ephemeris of each PRN, from which each epoch takes the one with the
+     * Toe nearest to it
+     */
+    class Ephemeris_Selector
+    {
+    public:
+        explicit Ephemeris_Selector(const std::vector<Rinex_Gps_Record>& records)
+        {
+            for (unsigned int i = 0; i < records.size(); i++)
+                {
+                    d_ephemeris[records[i].ephemeris.i_satellite_PRN].push_back(records[i].ephemeris);
+                }
+        }
+
+        const Gps_Ephemeris* nearest(unsigned int prn, double tow) const
+        {
+            std::map<unsigned int, std::vector<Gps_Ephemeris> >::const_iterator it = d_ephemeris.find(prn);
+            if (it == d_ephemeris.end())
+                {
+                    return 0;
+                }
+            const Gps_Ephemeris* best = 0;
+            double best_dt = 0.0;
+            for (unsigned int i = 0; i < it->second.size(); i++)
+                {
+                    double dt = std::fabs(std::remainder(tow - it->second[i].d_Toe, 604800.0));
+                    if (best == 0 || dt < best_dt)
+                        {
+                            best = &it->second[i];
+                            best_dt = dt;
+                        }
+                }
+            return best;
+        }
+
+    private:
+        std::map<unsigned int, std::vector<Gps_Ephemeris> > d_ephemeris;
+    };
+
+
+    std::vector<Epoch> read_epochs(Pvt_Log_Reader& reader)
+    {
+        std::vector<Epoch> epochs;
+        const Pvt_Log_Record_Header* record;
+        while ((record = reader.next()) != 0)
+            {
+                const Pvt_Log_Observable* observable = Pvt_Log_Reader::as<Pvt_Log_Observable>(record, PVT_LOG_OBSERVABLE);
+                if (observable == 0 || observable->system != 'G')
+                    {
+                        continue;
+                    }
+                if (epochs.empty() || epochs.back().rx_time != observable->rx_time)
+                    {
+                        epochs.push_back(Epoch());
+                        epochs.back().rx_time = observable->rx_time;
+                        epochs.back().valid = false;
+                    }
+                epochs.back().observables.push_back(*observable);
+            }
+        return epochs;
+    }
+
+
+    /*
+     * Solves epochs [begin, end) in order with a receiver of its own. The
+     * first fixes of each chunk start from scratch, as at a cold start.
+     */
+    void solve_epochs(std::vector<Epoch>& epochs, size_t begin, size_t end, const Ephemeris_Selector& selector, const Gps_Iono& iono)
+    {
+        gps_l1_ca_ls_pvt pvt(PVT_MAX_CHANNELS, "", false);
+        pvt.gps_iono = iono;
+        pvt.set_iono_correction(FLAGS_iono_correction);
+        std::map<int, Gnss_Synchro> pseudoranges;
+        for (size_t e = begin; e < end; e++)
+            {
+                Epoch& epoch = epochs[e];
+                pseudoranges.clear();
+                pvt.gps_ephemeris_map.clear();
+                for (unsigned int i = 0; i < epoch.observables.size() && pseudoranges.size() < PVT_MAX_CHANNELS; i++)
+                    {
+                        const Pvt_Log_Observable& observable = epoch.observables[i];
+                        const Gps_Ephemeris* ephemeris = selector.nearest(observable.PRN, epoch.rx_time);
+                        if (ephemeris == 0)
+                            {
+                                continue;
+                            }
+                        Gnss_Synchro synchro = Gnss_Synchro();
+                        synchro.System = observable.system;
+                        std::copy(observable.signal, observable.signal + 3, synchro.Signal);
+                        synchro.PRN = observable.PRN;
+                        synchro.Pseudorange_m = observable.pseudorange_m;
+                        synchro.Carrier_phase_rads = observable.carrier_phase_rads;
+                        synchro.Carrier_Doppler_hz = observable.carrier_doppler_hz;
+                        synchro.CN0_dB_hz = observable.CN0_dB_hz;
+                        synchro.Tracking_timestamp_secs = epoch.rx_time;
+                        synchro.Flag_valid_pseudorange = true;
+                        pseudoranges[observable.PRN] = synchro;
+                        pvt.gps_ephemeris_map[observable.PRN] = *ephemeris;
+                    }
+                if (!pseudoranges.empty() && pvt.get_PVT(pseudoranges, epoch.rx_time, false))
+                    {
+                        pvt_log_solution_record(pvt, epoch.rx_time, epoch.solution);
+                        epoch.valid = true;
+                    }
+            }
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    const std::string intro_help(
+            std::string("\n Solves again the GPS positions of a PVT log from its observables and a RINEX navigation file\n")
+    +
+    "Copyright (C) 2010-2015 (see AUTHORS file for a list of contributors)\n"
+    +
+    "This program comes with ABSOLUTELY NO WARRANTY;\n"
+    +
+    "See COPYING file to see a copy of the General Public License\n \n");
+
+    google::SetUsageMessage(intro_help);
+    google::SetVersionString(PVT_RECOMPUTE_VERSION);
+    google::ParseCommandLineFlags(&argc, &argv, true);
+    google::InitGoogleLogging(argv[0]);
+
+    if (FLAGS_pvt_log.empty() || FLAGS_rinex_nav.empty() || FLAGS_output.empty())
+        {
+            std::cerr << "Usage: pvt-recompute --pvt_log=pvt.log --rinex_nav=brdc.nav --output=recomputed.log [--threads=N] [--kml=track.kml]" << std::endl;
+            return 1;
+        }
+    Pvt_Log_Reader reader;
+    if (!reader.open(FLAGS_pvt_log))
+        {
+            std::cerr << "Unable to read " << FLAGS_pvt_log << ": not a PVT log" << std::endl;
+            return 1;
+        }
+    Rinex_Nav_Reader navigation;
+    if (!navigation.read_file(FLAGS_rinex_nav))
+        {
+            std::cerr << "Unable to read " << FLAGS_rinex_nav << ": not a GPS navigation file" << std::endl;
+            return 1;
+        }
+    std::vector<Epoch> epochs = read_epochs(reader);
+    const Ephemeris_Selector selector(navigation.records());
+
+    size_t threads = FLAGS_threads > 0 ? FLAGS_threads : std::max(1U, boost::thread::hardware_concurrency());
+    threads = std::max<size_t>(1, std::min(threads, epochs.size()));
+    std::cout << FLAGS_pvt_log << ": " << epochs.size() << " epochs, " << navigation.records().size()
+              << " ephemeris, " << threads << " threads" << std::endl;
+
+    // contiguous chunks, so that each receiver sees its epochs in order
+    boost::thread_group group;
+    const size_t chunk = (epochs.size() + threads - 1) / std::max<size_t>(1, threads);
+    for (size_t begin = 0; begin < epochs.size(); begin += chunk)
+        {
+            size_t end = std::min(epochs.size(), begin + chunk);
+            group.create_thread(boost::bind(&solve_epochs, boost::ref(epochs), begin, end, boost::cref(selector), boost::cref(navigation.iono())));
+        }
+    group.join_all();
+
+    Pvt_Log_Writer writer;
+    if (!writer.open(FLAGS_output))
+        {
+            std::cerr << "Unable to open " << FLAGS_output << std::endl;
+            return 1;
+        }
+    unsigned int solutions = 0;
+    for (size_t e = 0; e < epochs.size(); e++)
+        {
+            if (!epochs[e].valid)
+                {
+                    continue;
+                }
+            writer.write_record(epochs[e].solution.header);
+            for (unsigned int i = 0; i < epochs[e].observables.size(); i++)
+                {
+                    writer.write_record(epochs[e].observables[i].header);
+                }
+            solutions++;
+        }
+    writer.close();
+    std::cout << FLAGS_output << ": " << solutions << " solutions" << std::endl;
+
+    if (!FLAGS_kml.empty() || !FLAGS_geojson.empty() || !FLAGS_nmea.empty())
+        {
+            pvt_log_to_text(FLAGS_output, FLAGS_kml, FLAGS_geojson, FLAGS_nmea);
+        }
+    google::ShutDownCommandLineFlags();
+    return 0;
+}
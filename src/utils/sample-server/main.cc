@@ -0,0 +1,142 @@
+/*!
+ * \file main.cc
+ * \brief Main file of sample-server, which owns a front end and publishes
+ * its samples to all the receivers of a machine
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * The signal source of --config_file (role SignalSource, usually a
+ * UHD_Signal_Source, Osmosdr_Signal_Source or Flexiband_Signal_Source)
+ * writes its samples into a Shared_Sample_Ring in the file
+ * --ring_filename, usually in /dev/shm, that holds the last --ring_ms of
+ * them. The receivers attach to it with a Shared_Ring_Signal_Source and
+ * read the samples from the ring, with no copy through the server.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <csignal>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <boost/thread/thread.hpp>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gnuradio/msg_queue.h>
+#include <gnuradio/top_block.h>
+#include "file_configuration.h"
+#include "gnss_block_factory.h"
+#include "shared_ring_sink.h"
+#include "shared_sample_ring.h"
+
+using google::LogMessage;
+
+DEFINE_string(config_file, "", "Configuration of the signal source (role SignalSource) of the front end");
+DEFINE_string(ring_filename, "/dev/shm/gnss-sdr-samples", "File shared with the receivers (SignalSource.ring_filename)");
+DEFINE_int32(ring_ms, 1000, "Samples kept in the ring for the receivers that fall behind [ms]");
+DEFINE_int32(stats_interval_s, 60, "Interval between two logs of the number of samples published [s], 0 for none");
+
+namespace
+{
+volatile std::sig_atomic_t stop_requested = 0;
+
+void request_stop(int signal_number __attribute__((unused)))
+{
+    stop_requested = 1;
+}
+}
+
+
+int main(int argc, char** argv)
+{
+    const std::string intro_help(
+            std::string("\nSample server of GNSS-SDR, shared by the receivers of this machine\n")
+    +
+    "Copyright (C) 2010-2015 (see AUTHORS file for a list of contributors)\n"
+    +
+    "This program comes with ABSOLUTELY NO WARRANTY;\n"
+    +
+    "See COPYING file to see a copy of the General Public License\n \n");
+    google::SetUsageMessage(intro_help);
+    google::ParseCommandLineFlags(&argc, &argv, true);
+    google::InitGoogleLogging(argv[0]);
+
+    if (FLAGS_config_file.empty() || FLAGS_ring_ms <= 0)
+        {
+            std::cout << "--config_file is required and --ring_ms must be positive" << std::endl;
+            return 1;
+        }
+    std::shared_ptr<ConfigurationInterface> configuration = std::make_shared<FileConfiguration>(FLAGS_config_file);
+    std::string item_type = configuration->property("SignalSource.item_type", std::string("gr_complex"));
+    double fs = configuration->property("SignalSource.sampling_frequency", 2048000.0);
+
+    GNSSBlockFactory block_factory;
+    boost::shared_ptr<gr::msg_queue> queue = gr::msg_queue::make(0);
+    gr::top_block_sptr top_block = gr::make_top_block("Sample server");
+    std::shared_ptr<GNSSBlockInterface> source;
+    std::shared_ptr<Shared_Sample_Ring> ring;
+    try
+    {
+            source = block_factory.GetSignalSource(configuration, queue);
+            unsigned long long capacity = static_cast<unsigned long long>(fs * FLAGS_ring_ms / 1000.0);
+            ring = std::make_shared<Shared_Sample_Ring>(FLAGS_ring_filename, source->item_size(), capacity, item_type, fs);
+            if (!ring->is_open())
+                {
+                    std::cout << "Unable to create " << FLAGS_ring_filename << std::endl;
+                    return 1;
+                }
+            source->connect(top_block);
+            top_block->connect(source->get_right_block(), 0, make_shared_ring_sink(ring), 0);
+    }
+    catch(const std::exception & e)
+    {
+            std::cout << "Failure connecting the signal source: " << e.what() << std::endl;
+            return 1;
+    }
+
+    // the ring is closed and its file removed on the way out, so that the receivers stop
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+    top_block->start();
+    std::cout << "Sample server publishing " << item_type << " samples at " << fs << " samples/s in "
+              << FLAGS_ring_filename << " (" << ring->capacity() << " samples)" << std::endl;
+
+    int elapsed_s = 0;
+    // a message in the queue is the end of the samples of the source
+    for (int ticks = 1; !stop_requested && queue->count() == 0; ticks++)
+        {
+            boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+            if (ticks % 10 == 0 && FLAGS_stats_interval_s > 0 && ++elapsed_s % FLAGS_stats_interval_s == 0)
+                {
+                    LOG(INFO) << ring->written() << " samples published";
+                }
+        }
+    top_block->stop();
+    top_block->wait();
+    ring->close();
+    std::cout << "Sample server stopped after " << ring->written() << " samples" << std::endl;
+    return 0;
+}
@@ -0,0 +1,389 @@
+/*!
+ * \file main.cc
+ * \brief Main file of snapshot-pvt, which computes a GPS L1 C/A position
+ * fix from a few tens of milliseconds of samples, without tracking
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * The snapshot is read once through the signal source and conditioner of
+ * --config_file. The GPS ephemeris come from the SUPL server, or from the
+ * XML files of a previous run (GNSS-SDR.SUPL_read_gps_assistance_xml), and
+ * only the satellites they predict above --elevation_mask_deg are searched
+ * by the acquisition of role Acquisition. Their code phases are then solved
+ * by Coarse_Time_Pvt, which also corrects the approximate time of the
+ * snapshot, so that a site can wake up, capture, fix and sleep again.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gnuradio/top_block.h>
+#include <gnuradio/msg_queue.h>
+#include <gnuradio/blocks/file_sink.h>
+#include <gnuradio/blocks/file_source.h>
+#include <gnuradio/blocks/head.h>
+#include <gnuradio/blocks/skiphead.h>
+#include "acquisition_interface.h"
+#include "coarse_time_pvt.h"
+#include "concurrent_queue.h"
+#include "file_configuration.h"
+#include "gnss_block_factory.h"
+#include "gnss_sdr_supl_client.h"
+#include "gnss_synchro.h"
+#include "GPS_L1_CA.h"
+
+using google::LogMessage;
+
+DEFINE_string(config_file, "", "Configuration of the signal source and conditioner, of the acquisition (role Acquisition) and of the SUPL assistance (GNSS-SDR.SUPL_*)");
+DEFINE_int32(snapshot_ms, 40, "Milliseconds of samples of the snapshot");
+DEFINE_double(skip_s, 0.0, "Seconds of the signal skipped before the snapshot");
+DEFINE_string(snapshot_filename, "./snapshot.dat", "File where the samples of the snapshot are kept for the acquisition");
+DEFINE_double(tow, -1.0, "Approximate GPS time of week of the snapshot [s]. If negative, the SUPL reference time, or else the system clock, at the capture");
+DEFINE_int32(leap_seconds, 18, "GPS - UTC leap seconds, for the time of the system clock [s]");
+DEFINE_double(elevation_mask_deg, 5.0, "Satellites predicted below this elevation are not searched [deg]");
+
+// ######## GNURADIO BLOCK MESSAGE RECEVER #########
+class SnapshotPvt_msg_rx;
+
+typedef boost::shared_ptr<SnapshotPvt_msg_rx> SnapshotPvt_msg_rx_sptr;
+
+SnapshotPvt_msg_rx_sptr SnapshotPvt_msg_rx_make(concurrent_queue<int>& queue);
+
+
+class SnapshotPvt_msg_rx : public gr::block
+{
+private:
+    friend SnapshotPvt_msg_rx_sptr SnapshotPvt_msg_rx_make(concurrent_queue<int>& queue);
+    void msg_handler_events(pmt::pmt_t msg);
+    SnapshotPvt_msg_rx(concurrent_queue<int>& queue);
+    concurrent_queue<int>& channel_internal_queue;
+};
+
+
+SnapshotPvt_msg_rx_sptr SnapshotPvt_msg_rx_make(concurrent_queue<int>& queue)
+{
+    return SnapshotPvt_msg_rx_sptr(new SnapshotPvt_msg_rx(queue));
+}
+
+
+void SnapshotPvt_msg_rx::msg_handler_events(pmt::pmt_t msg)
+{
+    try
+    {
+            channel_internal_queue.push(pmt::to_long(msg));
+    }
+    catch(boost::bad_any_cast& e)
+    {
+            LOG(WARNING) << "msg_handler_telemetry Bad any cast!";
+    }
+}
+
+
+SnapshotPvt_msg_rx::SnapshotPvt_msg_rx(concurrent_queue<int>& queue) :
+    gr::block("SnapshotPvt_msg_rx", gr::io_signature::make(0, 0, 0), gr::io_signature::make(0, 0, 0)),
+    channel_internal_queue(queue)
+{
+    this->message_port_register_in(pmt::mp("events"));
+    this->set_msg_handler(pmt::mp("events"), boost::bind(&SnapshotPvt_msg_rx::msg_handler_events, this, _1));
+}
+
+// ###########################################################
+
+
+namespace
+{
+    const double GPS_UNIX_EPOCH_S = 315964800.0; // 6 January 1980 in Unix time [s]
+
+    double cpu_time_s()
+    {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+    }
+
+    // WGS84 geodetic coordinates [deg], [deg], [m] to ECEF [m]
+    arma::vec geodetic_to_ecef(double lat_deg, double lon_deg, double height_m)
+    {
+        const double a = 6378137.0;
+        const double f = 1.0 / 298.257223563;
+        const double e2 = f * (2.0 - f);
+        double phi = lat_deg * GPS_PI / 180.0;
+        double lambda = lon_deg * GPS_PI / 180.0;
+        double N = a / std::sqrt(1.0 - e2 * std::sin(phi) * std::sin(phi));
+        arma::vec ecef(3);
+        ecef(0) = (N + height_m) * std::cos(phi) * std::cos(lambda);
+        ecef(1) = (N + height_m) * std::cos(phi) * std::sin(lambda);
+        ecef(2) = (N * (1.0 - e2) + height_m) * std::sin(phi);
+        return ecef;
+    }
+
+    /*
+     * Reads the ephemeris, and the reference time and location if available,
+     * from the XML files or from the SUPL server, as the receiver does
+     */
+    bool get_assistance(std::shared_ptr<ConfigurationInterface> configuration, gnss_sdr_supl_client & supl_client)
+    {
+        if (configuration->property("GNSS-SDR.SUPL_read_gps_assistance_xml", false))
+            {
+                std::string eph_xml_filename = configuration->property("GNSS-SDR.SUPL_gps_ephemeris_xml", std::string("./gps_ephemeris.xml"));
+                std::cout << "SUPL: Try read GPS ephemeris from XML file " << eph_xml_filename << std::endl;
+                if (!supl_client.load_ephemeris_xml(eph_xml_filename))
+                    {
+                        return false;
+                    }
+                supl_client.load_ref_time_xml(configuration->property("GNSS-SDR.SUPL_gps_ref_time_xml", std::string("./gps_ref_time.xml")));
+                supl_client.load_ref_location_xml(configuration->property("GNSS-SDR.SUPL_gps_ref_location_xml", std::string("./gps_ref_location.xml")));
+                return !supl_client.gps_ephemeris_map.empty();
+            }
+
+        supl_client.server_name = configuration->property("GNSS-SDR.SUPL_gps_ephemeris_server", std::string("supl.nokia.com"));
+        supl_client.server_port = configuration->property("GNSS-SDR.SUPL_gps_ephemeris_port", 7275);
+        int supl_mcc = configuration->property("GNSS-SDR.SUPL_MCC", 244);
+        int supl_mns = configuration->property("GNSS-SDR.SUPL_MNS", 5);
+        int supl_lac = 0x59e2;
+        int supl_ci = 0x31b0;
+        try
+        {
+                supl_lac = boost::lexical_cast<int>(configuration->property("GNSS-SDR.SUPL_LAC", std::string("0x59e2")));
+                supl_ci = boost::lexical_cast<int>(configuration->property("GNSS-SDR.SUPL_CI", std::string("0x31b0")));
+        }
+        catch(boost::bad_lexical_cast &)
+        {}
+        std::cout << "SUPL: Try to read GPS ephemeris from SUPL server..." << std::endl;
+        supl_client.request = 1;
+        int error = supl_client.get_assistance(supl_mcc, supl_mns, supl_lac, supl_ci);
+        if (error != 0)
+            {
+                std::cout << "ERROR: SUPL client for Ephemeris returned " << error << std::endl;
+                return false;
+            }
+        // the reference time and location come with the almanac
+        supl_client.request = 0;
+        supl_client.get_assistance(supl_mcc, supl_mns, supl_lac, supl_ci);
+        return !supl_client.gps_ephemeris_map.empty();
+    }
+
+    // Writes snapshot_ms of the output of the signal conditioner to filename
+    bool capture_snapshot(std::shared_ptr<ConfigurationInterface> configuration, const std::string & filename)
+    {
+        GNSSBlockFactory block_factory;
+        boost::shared_ptr<gr::msg_queue> queue = gr::msg_queue::make(0);
+        gr::top_block_sptr top_block = gr::make_top_block("Snapshot capture");
+        long fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
+        try
+        {
+                std::shared_ptr<GNSSBlockInterface> source = block_factory.GetSignalSource(configuration, queue);
+                std::shared_ptr<GNSSBlockInterface> conditioner = block_factory.GetSignalConditioner(configuration);
+                gr::block_sptr skiphead = gr::blocks::skiphead::make(sizeof(gr_complex), static_cast<unsigned long long>(FLAGS_skip_s * fs_in));
+                gr::block_sptr head = gr::blocks::head::make(sizeof(gr_complex), static_cast<unsigned long long>(FLAGS_snapshot_ms) * fs_in / 1000);
+                gr::block_sptr sink = gr::blocks::file_sink::make(sizeof(gr_complex), filename.c_str());
+                source->connect(top_block);
+                conditioner->connect(top_block);
+                top_block->connect(source->get_right_block(), 0, conditioner->get_left_block(), 0);
+                top_block->connect(conditioner->get_right_block(), 0, skiphead, 0);
+                top_block->connect(skiphead, 0, head, 0);
+                top_block->connect(head, 0, sink, 0);
+                top_block->run();
+        }
+        catch(const std::exception & e)
+        {
+                std::cout << "Failure capturing the snapshot: " << e.what() << std::endl;
+                return false;
+        }
+        return true;
+    }
+
+    /*
+     * Searches the PRNs in the snapshot and returns, for those found, the
+     * receiver time of the start of a code period modulo 1 ms [s]
+     */
+    std::map<int, double> search_snapshot(std::shared_ptr<ConfigurationInterface> configuration, const std::vector<unsigned int> & prns)
+    {
+        std::map<int, double> code_phases_s;
+        long fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
+        std::string implementation = configuration->property("Acquisition.implementation", std::string("GPS_L1_CA_PCPS_Acquisition"));
+        configuration->set_property("Acquisition.item_type", "gr_complex");
+        configuration->set_property("Acquisition.dump", "false");
+
+        Gnss_Synchro gnss_synchro = Gnss_Synchro();
+        gnss_synchro.Channel_ID = 0;
+        gnss_synchro.System = 'G';
+        std::string("1C").copy(gnss_synchro.Signal, 2, 0);
+
+        GNSSBlockFactory block_factory;
+        std::unique_ptr<GNSSBlockInterface> block = block_factory.GetBlock(configuration, "Acquisition", implementation, 1, 0);
+        AcquisitionInterface* acquisition = dynamic_cast<AcquisitionInterface*>(block.get());
+        if (!acquisition)
+            {
+                std::cout << implementation << " is not an acquisition implementation" << std::endl;
+                return code_phases_s;
+            }
+        gr::top_block_sptr top_block = gr::make_top_block("Snapshot acquisition");
+        gr::blocks::file_source::sptr source = gr::blocks::file_source::make(sizeof(gr_complex), FLAGS_snapshot_filename.c_str());
+        concurrent_queue<int> events;
+        SnapshotPvt_msg_rx_sptr msg_rx = SnapshotPvt_msg_rx_make(events);
+        acquisition->set_channel(0);
+        acquisition->set_gnss_synchro(&gnss_synchro);
+        acquisition->set_threshold(configuration->property("Acquisition.threshold", 0.0));
+        acquisition->set_doppler_max(configuration->property("Acquisition.doppler_max", 10000));
+        acquisition->set_doppler_step(configuration->property("Acquisition.doppler_step", 500));
+        acquisition->connect(top_block);
+        top_block->connect(source, 0, acquisition->get_left_block(), 0);
+        top_block->msg_connect(acquisition->get_right_block(), pmt::mp("events"), msg_rx, pmt::mp("events"));
+
+        for (unsigned int i = 0; i < prns.size(); i++)
+            {
+                gnss_synchro.PRN = prns[i];
+                acquisition->set_gnss_synchro(&gnss_synchro);
+                acquisition->init();
+                acquisition->reset();
+                source->seek(0, SEEK_SET);
+                top_block->run();
+                // the decision is sent once, the message handler may still be on its way
+                int message = 0;
+                for (int wait = 0; wait < 100 && !events.try_pop(message); wait++)
+                    {
+                        boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+                    }
+                if (message == 1)
+                    {
+                        // the searched blocks are whole code periods of the snapshot, so modulo
+                        // 1 ms the code phase in the block is that from the start of the snapshot
+                        double arrival_s = gnss_synchro.Acq_delay_samples / static_cast<double>(fs_in);
+                        code_phases_s[prns[i]] = std::fmod(arrival_s, GPS_L1_CA_CODE_PERIOD);
+                        std::cout << "PRN " << prns[i] << ": Doppler " << gnss_synchro.Acq_doppler_hz << " [Hz], code phase "
+                                  << gnss_synchro.Acq_delay_samples << " [samples]" << std::endl;
+                    }
+                while (events.try_pop(message)) {}
+            }
+        return code_phases_s;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    const std::string intro_help(
+            std::string("\nSnapshot GPS L1 C/A position fix of GNSS-SDR, without tracking\n")
+    +
+    "Copyright (C) 2010-2015 (see AUTHORS file for a list of contributors)\n"
+    +
+    "This program comes with ABSOLUTELY NO WARRANTY;\n"
+    +
+    "See COPYING file to see a copy of the General Public License\n \n");
+    google::SetUsageMessage(intro_help);
+    google::ParseCommandLineFlags(&argc, &argv, true);
+    google::InitGoogleLogging(argv[0]);
+
+    if (FLAGS_config_file.empty())
+        {
+            std::cout << "Please give the configuration of the snapshot with --config_file" << std::endl;
+            return 1;
+        }
+    std::shared_ptr<ConfigurationInterface> configuration = std::make_shared<FileConfiguration>(FLAGS_config_file);
+    double cpu_start_s = cpu_time_s();
+
+    // 1. Assistance, and the approximate time and position of the snapshot
+    gnss_sdr_supl_client supl_client;
+    if (!get_assistance(configuration, supl_client))
+        {
+            std::cout << "Unable to get the GPS ephemeris assistance" << std::endl;
+            return 1;
+        }
+    time_t capture_time = std::time(0);
+    double tow = FLAGS_tow;
+    if (tow < 0.0 && supl_client.gps_time.valid)
+        {
+            tow = std::fmod(supl_client.gps_time.d_TOW + (static_cast<double>(capture_time) - supl_client.gps_time.d_tv_sec), 604800.0);
+        }
+    else if (tow < 0.0)
+        {
+            tow = std::fmod(static_cast<double>(capture_time) - GPS_UNIX_EPOCH_S + FLAGS_leap_seconds, 604800.0);
+        }
+    arma::vec approx_pos;
+    if (supl_client.gps_ref_loc.valid)
+        {
+            approx_pos = geodetic_to_ecef(supl_client.gps_ref_loc.lat, supl_client.gps_ref_loc.lon, 0.0);
+        }
+    else
+        {
+            approx_pos = geodetic_to_ecef(configuration->property("GNSS-SDR.init_latitude_deg", 41.0),
+                    configuration->property("GNSS-SDR.init_longitude_deg", 2.0),
+                    configuration->property("GNSS-SDR.init_altitude_m", 100.0));
+        }
+
+    Coarse_Time_Pvt pvt;
+    pvt.gps_ephemeris_map = supl_client.gps_ephemeris_map;
+    std::vector<unsigned int> visible;
+    for (std::map<int, Gps_Ephemeris>::iterator it = pvt.gps_ephemeris_map.begin(); it != pvt.gps_ephemeris_map.end(); ++it)
+        {
+            it->second.satellitePosition(tow);
+            arma::vec satpos(3);
+            satpos(0) = it->second.d_satpos_X;
+            satpos(1) = it->second.d_satpos_Y;
+            satpos(2) = it->second.d_satpos_Z;
+            double az, el, distance;
+            pvt.topocent(&az, &el, &distance, approx_pos, satpos - approx_pos);
+            if (el >= FLAGS_elevation_mask_deg)
+                {
+                    visible.push_back(it->first);
+                }
+        }
+    std::cout << visible.size() << " of the " << pvt.gps_ephemeris_map.size() << " satellites with ephemeris are predicted in view" << std::endl;
+
+    // 2. Snapshot and acquisition
+    if (!capture_snapshot(configuration, FLAGS_snapshot_filename))
+        {
+            return 1;
+        }
+    std::map<int, double> code_phases_s = search_snapshot(configuration, visible);
+
+    // 3. Coarse time fix
+    if (!pvt.get_PVT(code_phases_s, tow, approx_pos))
+        {
+            std::cout << "No fix with the " << code_phases_s.size() << " satellites found" << std::endl;
+            return 1;
+        }
+    std::cout << std::setprecision(9) << "Position: Lat = " << pvt.d_latitude_d << " [deg], Long = " << pvt.d_longitude_d
+              << " [deg], Height = " << std::setprecision(6) << pvt.d_height_m << " [m], with " << pvt.d_valid_observations
+              << " satellites, HDOP = " << pvt.d_HDOP << std::endl;
+    std::cout << std::setprecision(12) << "GPS time of week: " << pvt.d_GPS_time_s << " [s] (approximate time corrected by "
+              << std::setprecision(6) << pvt.d_time_error_s << " [s])" << std::endl;
+    std::cout << "CPU time of the fix: " << cpu_time_s() - cpu_start_s << " [s]" << std::endl;
+    google::ShutDownCommandLineFlags();
+    return 0;
+}
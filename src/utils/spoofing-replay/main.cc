@@ -0,0 +1,368 @@
+/*!
+ * \file main.cc
+ * \brief Main file of spoofing-replay, which runs the spoofing detector
+ * offline over the inputs recorded during a run of the receiver
+ * \author Hildur Olafsdottir, 2015. ohildur(at)gmail.com
+ *
+ * A receiver run with Spoofing.replay_filename set records what its
+ * spoofing detector is given: the channel epochs with their correlator
+ * taps and SQM metrics, the undecoded subframes and the position fixes.
+ * Every combination of the Spoofing.* values of --sweep feeds them to a
+ * new detector, each combination in a child process, --parallel at a
+ * time. The alarms of each combination are written to
+ * setting_N/alarms.csv, with the receiver time they were raised at, and
+ * a summary of all of them to results.csv.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2015  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+#include <boost/thread/thread.hpp>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include "concurrent_ring_queue.h"
+#include "concurrent_map.h"
+#include "concurrent_snapshot_map.h"
+#include "concurrent_subframe_map.h"
+#include "navigation_data_bus.h"
+#include "file_configuration.h"
+#include "in_memory_configuration.h"
+#include "gnss_synchro.h"
+#include "gps_ephemeris.h"
+#include "gps_acq_assist.h"
+#include "gps_ref_location.h"
+#include "gps_ref_time.h"
+#include "spoofing_detector.h"
+#include "spoofing_message.h"
+#include "spoofing_replay.h"
+#include "vector_tracking_aid.h"
+#include "correlator_taps.h"
+#include "sqm_metrics.h"
+#include "aoa_metrics.h"
+
+using google::LogMessage;
+
+DEFINE_string(recording, "", "Inputs of the spoofing detector recorded by a run with Spoofing.replay_filename");
+DEFINE_string(config_file, "", "Configuration of the recorded run, for the Spoofing.* values the sweep does not change. If empty, the defaults");
+DEFINE_string(sweep, "", "Values of the sweep, as Spoofing.A=a1,a2;Spoofing.B=b1,b2. Every combination is replayed");
+DEFINE_int32(parallel, 0, "Combinations replayed at the same time (0: one per core)");
+DEFINE_string(output_dir, "./spoofing_replay", "Directory of the alarms of every combination and of results.csv");
+
+DECLARE_string(log_dir);
+
+namespace
+{
+    typedef std::vector<std::pair<std::string, std::string> > Replay_Setting;
+
+    struct Replay_Result
+    {
+        unsigned long int records;
+        double duration_s;
+        double cpu_s;
+        unsigned int alarms;
+        double first_alarm_s;
+    };
+
+    std::vector<std::string> split_list(const std::string & list, char separator)
+    {
+        std::vector<std::string> items;
+        std::stringstream list_stream(list);
+        std::string item;
+        while (std::getline(list_stream, item, separator))
+            {
+                if (!item.empty()) items.push_back(item);
+            }
+        return items;
+    }
+
+    // Every combination of the values of "A=a1,a2;B=b1,b2"
+    bool parse_sweep(const std::string & sweep, std::vector<Replay_Setting> & settings)
+    {
+        std::vector<std::string> keys;
+        std::vector<std::vector<std::string> > values;
+        std::vector<std::string> parameters = split_list(sweep, ';');
+        for (unsigned int i = 0; i < parameters.size(); i++)
+            {
+                std::string::size_type equal = parameters[i].find('=');
+                if (equal == std::string::npos || split_list(parameters[i].substr(equal + 1), ',').empty())
+                    {
+                        std::cout << "No values of " << parameters[i] << " in --sweep" << std::endl;
+                        return false;
+                    }
+                keys.push_back(parameters[i].substr(0, equal));
+                values.push_back(split_list(parameters[i].substr(equal + 1), ','));
+            }
+        std::vector<unsigned int> index(keys.size(), 0);
+        while (true)
+            {
+                Replay_Setting setting;
+                for (unsigned int i = 0; i < keys.size(); i++)
+                    {
+                        setting.push_back(std::make_pair(keys[i], values[i][index[i]]));
+                    }
+                settings.push_back(setting);
+                unsigned int i = 0;
+                for (; i < keys.size(); i++)
+                    {
+                        if (++index[i] < values[i].size()) break;
+                        index[i] = 0;
+                    }
+                if (i == keys.size()) break;
+            }
+        return true;
+    }
+
+    double cpu_time_s()
+    {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+    }
+
+    /*
+     * Replays the recording with one setting in the child process, writes
+     * the alarms to directory/alarms.csv and "records duration_s cpu_s
+     * alarms first_alarm_s" to directory/result.txt. It never returns.
+     */
+    void run_setting(const Replay_Setting & setting, const std::string & directory)
+    {
+        int status = 1;
+        try
+        {
+                if (chdir(directory.c_str()) != 0 || !std::freopen("spoofing-replay.out", "w", stdout))
+                    {
+                        std::_Exit(status);
+                    }
+                FLAGS_log_dir = directory + "/";
+                Spoofing_Replay_Player player(FLAGS_recording);
+                if (!player.is_open())
+                    {
+                        std::_Exit(status);
+                    }
+                std::shared_ptr<ConfigurationInterface> configuration;
+                if (FLAGS_config_file.empty())
+                    {
+                        configuration = std::make_shared<InMemoryConfiguration>();
+                    }
+                else
+                    {
+                        configuration = std::make_shared<FileConfiguration>(FLAGS_config_file);
+                    }
+                configuration->set_property("GNSS-SDR.internal_fs_hz", std::to_string(static_cast<long>(player.fs_in())));
+                // every alarm is listed, unless the sweep sets the interval
+                configuration->set_property("Spoofing.alarm_min_interval_ms", "0");
+                for (unsigned int i = 0; i < setting.size(); i++)
+                    {
+                        configuration->set_property(setting[i].first, setting[i].second);
+                    }
+                // nothing is recorded nor checkpointed again, and the assistance data of the run is not in the recording
+                configuration->set_property("Spoofing.replay_filename", "");
+                configuration->set_property("Spoofing.checkpoint_filename", "");
+                configuration->set_property("Spoofing.NAVI_external", "false");
+
+                Spoofing_Detector detector(configuration.get());
+                std::ofstream alarms((directory + "/alarms.csv").c_str());
+                alarms << "time_s,case,satellites,suppressed,description" << std::endl;
+                Replay_Result result = {0, 0.0, 0.0, 0, -1.0};
+                double cpu_start_s = cpu_time_s();
+                double first_time_s = -1.0;
+                Spoofing_Message msg;
+                bool playing = true;
+                while (playing)
+                    {
+                        playing = player.play_next(detector);
+                        if (playing && first_time_s < 0.0) first_time_s = player.time_s();
+                        // the checks that do not run inline catch up with the last records
+                        if (!playing) detector.flush_checks();
+                        while (detector.state()->spoofing_queue.try_pop(msg))
+                            {
+                                std::string satellites;
+                                for (std::set<unsigned int>::const_iterator it = msg.satellites.begin(); it != msg.satellites.end(); ++it)
+                                    {
+                                        satellites += (satellites.empty() ? "" : " ") + std::to_string(*it);
+                                    }
+                                std::replace(msg.description.begin(), msg.description.end(), '"', '\'');
+                                std::replace(msg.description.begin(), msg.description.end(), '\n', ' ');
+                                alarms << player.time_s() << "," << msg.spoofing_case << "," << satellites << ","
+                                       << msg.suppressed << ",\"" << msg.description << "\"" << std::endl;
+                                if (result.alarms == 0) result.first_alarm_s = player.time_s();
+                                result.alarms++;
+                            }
+                    }
+                result.cpu_s = cpu_time_s() - cpu_start_s;
+                result.records = player.records();
+                result.duration_s = first_time_s < 0.0 ? 0.0 : player.time_s() - first_time_s;
+                alarms.close();
+
+                std::ofstream result_file((directory + "/result.txt").c_str());
+                result_file << result.records << " " << result.duration_s << " " << result.cpu_s << " "
+                            << result.alarms << " " << result.first_alarm_s << std::endl;
+                result_file.close();
+                status = (alarms && result_file) ? 0 : 1;
+        }
+        catch (const std::exception & e)
+        {
+                std::cerr << "Setting in " << directory << " failed: " << e.what() << std::endl;
+        }
+        std::cout << std::flush;
+        std::_Exit(status);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    namespace fs = boost::filesystem;
+    const std::string intro_help(
+            std::string("\nOffline replay of the spoofing detector of GNSS-SDR over a recorded run\n")
+    +
+    "Copyright (C) 2010-2015 (see AUTHORS file for a list of contributors)\n"
+    +
+    "This program comes with ABSOLUTELY NO WARRANTY;\n"
+    +
+    "See COPYING file to see a copy of the General Public License\n \n");
+    google::SetUsageMessage(intro_help);
+    google::ParseCommandLineFlags(&argc, &argv, true);
+    google::InitGoogleLogging(argv[0]);
+
+    if (FLAGS_recording.empty())
+        {
+            std::cout << "Please give the recorded run with --recording" << std::endl;
+            return 1;
+        }
+    FLAGS_recording = fs::absolute(FLAGS_recording).string();
+    if (!FLAGS_config_file.empty())
+        {
+            FLAGS_config_file = fs::absolute(FLAGS_config_file).string();
+        }
+    if (!Spoofing_Replay_Player(FLAGS_recording).is_open())
+        {
+            std::cout << FLAGS_recording << " is not a recording of the spoofing detector" << std::endl;
+            return 1;
+        }
+    std::vector<Replay_Setting> settings;
+    if (!parse_sweep(FLAGS_sweep, settings))
+        {
+            return 1;
+        }
+    fs::path output_dir = fs::absolute(FLAGS_output_dir);
+    boost::system::error_code ec;
+    fs::create_directories(output_dir, ec);
+
+    unsigned int parallel = FLAGS_parallel > 0 ? FLAGS_parallel : std::max(1u, boost::thread::hardware_concurrency());
+    std::cout << "Replaying " << FLAGS_recording << " with " << settings.size()
+              << " settings, " << parallel << " at a time" << std::endl;
+    std::map<pid_t, unsigned int> running;
+    std::vector<bool> done(settings.size(), false);
+    for (unsigned int n = 0; n < settings.size() || !running.empty(); )
+        {
+            if (n < settings.size() && running.size() < parallel)
+                {
+                    fs::path directory = output_dir / ("setting_" + std::to_string(n));
+                    fs::create_directories(directory, ec);
+                    fs::remove(directory / "result.txt", ec);
+                    std::cout << std::flush;
+                    pid_t pid = fork();
+                    if (pid == 0)
+                        {
+                            run_setting(settings[n], directory.string());
+                        }
+                    if (pid == -1)
+                        {
+                            LOG(WARNING) << "Unable to start the replay of setting " << n;
+                        }
+                    else
+                        {
+                            running[pid] = n;
+                        }
+                    n++;
+                    continue;
+                }
+            int status;
+            pid_t pid = wait(&status);
+            if (pid == -1)
+                {
+                    break;
+                }
+            if (running.count(pid))
+                {
+                    done[running[pid]] = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+                    running.erase(pid);
+                }
+        }
+
+    std::string results_filename = (output_dir / "results.csv").string();
+    std::ofstream results(results_filename.c_str());
+    results << "setting";
+    for (unsigned int i = 0; i < settings[0].size(); i++)
+        {
+            results << "," << settings[0][i].first;
+        }
+    results << ",records,duration_s,cpu_s,times_real_time,alarms,first_alarm_s" << std::endl;
+    unsigned int n_done = 0;
+    for (unsigned int n = 0; n < settings.size(); n++)
+        {
+            std::stringstream line;
+            line << n;
+            for (unsigned int i = 0; i < settings[n].size(); i++)
+                {
+                    line << "," << settings[n][i].second;
+                }
+            Replay_Result result;
+            std::ifstream result_file((output_dir / ("setting_" + std::to_string(n)) / "result.txt").string().c_str());
+            if (!done[n] || !(result_file >> result.records >> result.duration_s >> result.cpu_s >> result.alarms >> result.first_alarm_s))
+                {
+                    line << ",,,,,,";
+                    std::cout << "Setting " << n << " failed" << std::endl;
+                }
+            else
+                {
+                    line << "," << result.records << "," << result.duration_s << "," << result.cpu_s << ","
+                         << (result.cpu_s > 0.0 ? result.duration_s / result.cpu_s : 0.0) << "," << result.alarms << ",";
+                    if (result.alarms > 0) line << result.first_alarm_s;
+                    n_done++;
+                }
+            results << line.str() << std::endl;
+            std::cout << line.str() << std::endl;
+        }
+    std::cout << "Results written to " << results_filename << ", the alarms of each setting to setting_N/alarms.csv" << std::endl;
+    google::ShutDownCommandLineFlags();
+    return n_done == settings.size() ? 0 : 1;
+}